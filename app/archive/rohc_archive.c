@@ -0,0 +1,1915 @@
+/*
+ * Copyright 2026 Didier Barvaux
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/**
+ * @file   rohc_archive.c
+ * @brief  Store PCAP captures as ROHC-compressed archives and restore them
+ * @author Didier Barvaux <didier@barvaux.org>
+ *
+ * The archive stores the packets of one PCAP capture in chunks of
+ * consecutive packets. The IP headers of the packets are compressed with
+ * ROHC, one new ROHC compressor being used for every chunk, so every chunk
+ * starts with the IR packets that establish its contexts and may be restored
+ * on its own. An index of the chunks at the end of the archive allows to
+ * seek in the archive and to restore the chunks in parallel.
+ *
+ * The archive is lossless: the packets that cannot be compressed (non-IP or
+ * truncated packets for example) are stored verbatim, and the packets that
+ * the ROHC decompressor would not restore exactly are stored verbatim after
+ * their ROHC packet, so that the decompressor stays synchronized.
+ *
+ * All integers of the archive are in network byte order. The archive is
+ * made of:
+ *  - a 48-byte file header:
+ *      magic "ROHCARCH" (8 bytes), version (32 bits), PCAP link type
+ *      (32 bits), flags (32 bits), max number of ROHC contexts (32 bits),
+ *      snapshot length (32 bits), number of packets per chunk (32 bits),
+ *      offset of the index (64 bits), number of chunks (64 bits)
+ *  - the chunks, one record per packet:
+ *      type and flags (1 byte), timestamp delta with the previous record of
+ *      the chunk (zigzag varint) or seconds and fraction of second (varints)
+ *      if the fraction is out of range, then according to the type:
+ *       - raw: captured length (varint), truncated length (varint), frame
+ *       - ROHC: link header length and link header if not the same as the
+ *         previous record of the chunk, ROHC packet length (varint), ROHC
+ *         packet, trailer length (varint), trailer after the IP packet
+ *       - ROHC + verbatim: ROHC packet length (varint), ROHC packet,
+ *         captured length (varint), frame
+ *  - the index, 32 bytes per chunk:
+ *      offset (64 bits), length (64 bits), timestamp of the first packet
+ *      (64 bits), number of packets (32 bits), reserved (32 bits)
+ */
+
+#include "config.h" /* for HAVE_*_H */
+
+/* system includes */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#if HAVE_WINSOCK2_H == 1
+#  include <winsock2.h> /* for ntohs() on Windows */
+#endif
+#if HAVE_ARPA_INET_H == 1
+#  include <arpa/inet.h> /* for ntohs() on Linux */
+#endif
+#include <assert.h>
+#include <stdarg.h>
+#include <errno.h>
+#include <pthread.h>
+#if HAVE_SYS_MMAN_H == 1
+#  include <sys/mman.h> /* for mmap(2) */
+#  include <sys/stat.h>
+#  include <fcntl.h>
+#  include <unistd.h>
+#endif
+
+/* includes for network headers */
+#include <protocols/ipv4.h>
+#include <protocols/ipv6.h>
+
+/* include for the PCAP library */
+#if HAVE_PCAP_PCAP_H == 1
+#  include <pcap/pcap.h>
+#elif HAVE_PCAP_H == 1
+#  include <pcap.h>
+#else
+#  error "pcap.h header not found, did you specified --enable-app-archive \
+for ./configure ? If yes, check configure output and config.log"
+#endif
+
+/* ROHC includes */
+#include <rohc.h>
+#include <rohc_comp.h>
+#include <rohc_decomp.h>
+
+
+/** The magic bytes at the beginning of every archive */
+#define ARCH_MAGIC  "ROHCARCH"
+
+/** The version of the archive format */
+#define ARCH_VERSION  1U
+
+/** The length (in bytes) of the file header of the archive */
+#define ARCH_FILE_HDR_LEN  48U
+
+/** The length (in bytes) of one entry of the chunk index */
+#define ARCH_INDEX_ENTRY_LEN  32U
+
+/** The offset of the index offset in the file header */
+#define ARCH_INDEX_OFFSET_POS  32U
+
+/** The flag of the file header for timestamps in nanoseconds */
+#define ARCH_FLAG_NSEC       (1U << 0)
+/** The flag of the file header for large CIDs */
+#define ARCH_FLAG_LARGE_CID  (1U << 1)
+
+/** The default number of packets in one chunk */
+#define ARCH_CHUNK_PKTS_DEFAULT  4096U
+
+/** The max length (in bytes) of one ROHC packet */
+#define ARCH_ROHC_MAX_LEN  (0xffffU + 1024U)
+
+/** The max length (in bytes) of one uncompressed IP packet */
+#define ARCH_IP_MAX_LEN  0xffffU
+
+/** The max number of threads that restore chunks */
+#define ARCH_THREADS_MAX  64U
+
+/** The length of the Linux Cooked Sockets header */
+#define LINUX_COOKED_HDR_LEN  16U
+
+/** The length (in bytes) of the Ethernet header */
+#define ETHER_HDR_LEN  14U
+
+/** The length of the PCAP file header */
+#define PCAP_FILE_HDR_LEN  24U
+
+/** The length of the PCAP record header */
+#define PCAP_RECORD_HDR_LEN  16U
+
+/** The PCAP link type for raw IP packets (may differ from DLT_RAW) */
+#define PCAP_LINKTYPE_RAW  101U
+
+
+/** The types of records in the chunks */
+typedef enum
+{
+	ARCH_REC_RAW       = 0, /**< The frame is stored verbatim */
+	ARCH_REC_ROHC      = 1, /**< The IP packet is stored as one ROHC packet */
+	ARCH_REC_ROHC_VERB = 2, /**< The ROHC packet is followed by the frame */
+} arch_rec_type_t;
+
+/** The mask of the record type in the first byte of one record */
+#define ARCH_REC_TYPE_MASK  0x03U
+/** The flag of one record whose link header is the one of the previous
+ *  ROHC record of the chunk */
+#define ARCH_REC_SAME_LINK  0x04U
+/** The flag of one record whose timestamp is stored as is (seconds and
+ *  fraction of second) because its fraction of second is out of range */
+#define ARCH_REC_RAW_TS     0x08U
+
+
+/** The parameters of the ROHC compressors and decompressors */
+struct arch_params
+{
+	rohc_cid_type_t cid_type;  /**< The type of CIDs */
+	size_t max_contexts;       /**< The max number of contexts */
+	int link_type;             /**< The PCAP link type (DLT value) */
+};
+
+
+/** The archive being written */
+struct arch_writer
+{
+	FILE *file;              /**< The archive file */
+	uint64_t offset;         /**< The current offset in the archive file */
+	bool is_error;           /**< Whether one write failed */
+	uint8_t *index;          /**< The index of the chunks */
+	uint64_t chunks_nr;      /**< The number of chunks in the index */
+	uint64_t chunks_max;     /**< The number of chunks the index may hold */
+};
+
+
+/** The statistics of one archive being written */
+struct arch_stats
+{
+	unsigned long pkts_nr[ARCH_REC_ROHC_VERB + 1]; /**< The packets per type */
+	unsigned long long uncomp_bytes;  /**< The captured bytes */
+	unsigned long long arch_bytes;    /**< The bytes of the archive */
+};
+
+
+/** The archive being read */
+struct arch_reader
+{
+	const uint8_t *data;     /**< The mapped archive file */
+	size_t len;              /**< The length of the archive file */
+	int link_type;           /**< The PCAP link type (DLT value) */
+	uint32_t pcap_link_type; /**< The PCAP link type (LINKTYPE value) */
+	uint32_t flags;          /**< The flags of the file header */
+	struct arch_params params; /**< The parameters of the decompressors */
+	uint32_t snaplen;        /**< The snapshot length of the capture */
+	uint32_t chunk_pkts;     /**< The number of packets per chunk */
+	const uint8_t *index;    /**< The index of the chunks */
+	uint64_t chunks_nr;      /**< The number of chunks */
+};
+
+
+/** One chunk restored as PCAP records */
+struct arch_chunk_out
+{
+	uint8_t *data;           /**< The PCAP records of the chunk */
+	size_t len;              /**< The length of the PCAP records */
+	size_t max_len;          /**< The allocated length */
+	bool is_done;            /**< Whether the chunk was restored */
+	bool is_ok;              /**< Whether the chunk was successfully restored */
+};
+
+
+/** The state shared by the threads that restore chunks */
+struct arch_unpack
+{
+	const struct arch_reader *reader; /**< The archive */
+	uint64_t first_chunk;    /**< The first chunk to restore */
+	uint64_t chunks_nr;      /**< The number of chunks to restore */
+	size_t threads_nr;       /**< The number of threads */
+	struct arch_chunk_out *chunks; /**< The restored chunks */
+	uint64_t next_chunk;     /**< The next chunk to restore */
+	uint64_t written_nr;     /**< The number of chunks written in output */
+	pthread_mutex_t lock;    /**< The lock on the shared state */
+	pthread_cond_t cond;     /**< Signaled when one chunk is restored or
+	                              written */
+};
+
+
+/* prototypes of private functions */
+static void usage(void);
+static bool arch_pack(const char *const src_filename,
+                      const char *const dst_filename,
+                      const struct arch_params *const params,
+                      const size_t chunk_pkts)
+	__attribute__((warn_unused_result, nonnull(1, 2, 3)));
+static bool arch_unpack(const char *const src_filename,
+                        const char *const dst_filename,
+                        const size_t threads_nr,
+                        const uint64_t first_chunk,
+                        const uint64_t chunks_nr)
+	__attribute__((warn_unused_result, nonnull(1, 2)));
+static bool arch_list(const char *const filename)
+	__attribute__((warn_unused_result, nonnull(1)));
+
+/* writing archives */
+static bool arch_create_rohc(const struct arch_params *const params,
+                             struct rohc_comp **const comp,
+                             struct rohc_decomp **const decomp)
+	__attribute__((warn_unused_result, nonnull(1, 2, 3)));
+static void arch_write(struct arch_writer *const writer,
+                       const void *const data,
+                       const size_t len)
+	__attribute__((nonnull(1)));
+static void arch_write_varint(struct arch_writer *const writer,
+                              const uint64_t value)
+	__attribute__((nonnull(1)));
+static bool arch_index_add(struct arch_writer *const writer,
+                           const uint64_t offset,
+                           const uint64_t len,
+                           const uint64_t first_ts,
+                           const uint32_t pkts_nr)
+	__attribute__((warn_unused_result, nonnull(1)));
+static size_t arch_get_link_len(const int link_type,
+                                const uint8_t *const frame,
+                                const size_t frame_len)
+	__attribute__((warn_unused_result, nonnull(2)));
+static bool arch_get_ip_len(const uint8_t *const ip,
+                            const size_t max_len,
+                            size_t *const ip_len)
+	__attribute__((warn_unused_result, nonnull(1, 3)));
+
+/* reading archives */
+static bool arch_open(struct arch_reader *const reader,
+                      const char *const filename)
+	__attribute__((warn_unused_result, nonnull(1, 2)));
+static void arch_close(struct arch_reader *const reader)
+	__attribute__((nonnull(1)));
+static bool arch_read_varint(const uint8_t **const data,
+                             const uint8_t *const end,
+                             uint64_t *const value)
+	__attribute__((warn_unused_result, nonnull(1, 2, 3)));
+static void * arch_unpack_thread(void *const arg)
+	__attribute__((nonnull(1)));
+static bool arch_unpack_chunk(const struct arch_reader *const reader,
+                              const uint64_t chunk_id,
+                              struct arch_chunk_out *const out)
+	__attribute__((warn_unused_result, nonnull(1, 3)));
+static bool arch_decompress(struct rohc_decomp *const decomp,
+                            const uint8_t *const rohc_data,
+                            const size_t rohc_len,
+                            const struct rohc_ts arrival_time,
+                            uint8_t *const ip_data,
+                            size_t *const ip_len)
+	__attribute__((nonnull(1, 2, 5, 6)));
+static uint8_t * arch_out_reserve(struct arch_chunk_out *const out,
+                                  const size_t len)
+	__attribute__((warn_unused_result, nonnull(1)));
+
+/* byte order */
+static void arch_put32(uint8_t *const data, const uint32_t value)
+	__attribute__((nonnull(1)));
+static void arch_put64(uint8_t *const data, const uint64_t value)
+	__attribute__((nonnull(1)));
+static uint32_t arch_get32(const uint8_t *const data)
+	__attribute__((warn_unused_result, nonnull(1)));
+static uint64_t arch_get64(const uint8_t *const data)
+	__attribute__((warn_unused_result, nonnull(1)));
+
+static void print_rohc_traces(void *const priv_ctxt,
+                              const rohc_trace_level_t level,
+                              const rohc_trace_entity_t entity,
+                              const int profile,
+                              const char *const format,
+                              ...)
+	__attribute__((format(printf, 5, 6), nonnull(5)));
+
+static int gen_random_num(const struct rohc_comp *const comp,
+                          void *const user_context)
+	__attribute__((nonnull(1)));
+
+
+/** Whether the application runs in verbose mode or not */
+static int is_verbose;
+
+
+/**
+ * @brief Main function for the ROHC archive program
+ *
+ * @param argc The number of program arguments
+ * @param argv The program arguments
+ * @return     The unix return code:
+ *              \li 0 in case of success,
+ *              \li 1 in case of failure
+ */
+int main(int argc, char *argv[])
+{
+	struct arch_params params = {
+		.cid_type = ROHC_LARGE_CID,
+		.max_contexts = ROHC_LARGE_CID_MAX + 1,
+		.link_type = DLT_RAW,
+	};
+	char *cid_type = NULL;
+	int max_contexts = -1;
+	int chunk_pkts = ARCH_CHUNK_PKTS_DEFAULT;
+	int threads_nr = 1;
+	long long first_chunk = 0;
+	long long chunks_nr = -1;
+	int is_failure = 1;
+	int args_used;
+
+	/* set to quiet mode by default */
+	is_verbose = 0;
+
+	/* parse program arguments, print the help message in case of failure */
+	if(argc <= 1)
+	{
+		usage();
+		goto error;
+	}
+
+	for(argc--, argv++; argc > 0; argc -= args_used, argv += args_used)
+	{
+		args_used = 1;
+
+		if(!strcmp(*argv, "-v") || !strcmp(*argv, "--version"))
+		{
+			/* print version */
+			printf("rohc_archive version %s\n", rohc_version());
+			goto error;
+		}
+		else if(!strcmp(*argv, "-h") || !strcmp(*argv, "--help"))
+		{
+			/* print help */
+			usage();
+			goto error;
+		}
+		else if(!strcmp(*argv, "--verbose"))
+		{
+			/* enable verbose mode */
+			is_verbose = 1;
+		}
+		else if(argc < 2)
+		{
+			/* all the other options and commands take at least one argument */
+			break;
+		}
+		else if(!strcmp(*argv, "--cid-type"))
+		{
+			/* get the type of CID to use within the ROHC library */
+			cid_type = argv[1];
+			args_used++;
+		}
+		else if(!strcmp(*argv, "--max-contexts"))
+		{
+			/* get the maximum number of contexts per chunk */
+			max_contexts = atoi(argv[1]);
+			args_used++;
+		}
+		else if(!strcmp(*argv, "--chunk-packets"))
+		{
+			/* get the number of packets per chunk */
+			chunk_pkts = atoi(argv[1]);
+			if(chunk_pkts <= 0)
+			{
+				fprintf(stderr, "the number of packets per chunk should be "
+				        "positive\n");
+				goto error;
+			}
+			args_used++;
+		}
+		else if(!strcmp(*argv, "--threads"))
+		{
+			/* get the number of threads that restore chunks */
+			threads_nr = atoi(argv[1]);
+			if(threads_nr <= 0 || ((unsigned int) threads_nr) > ARCH_THREADS_MAX)
+			{
+				fprintf(stderr, "the number of threads should be between 1 and "
+				        "%u\n", ARCH_THREADS_MAX);
+				goto error;
+			}
+			args_used++;
+		}
+		else if(!strcmp(*argv, "--first-chunk"))
+		{
+			/* get the first chunk to restore */
+			first_chunk = atoll(argv[1]);
+			if(first_chunk < 0)
+			{
+				fprintf(stderr, "the first chunk should be positive or zero\n");
+				goto error;
+			}
+			args_used++;
+		}
+		else if(!strcmp(*argv, "--chunks"))
+		{
+			/* get the number of chunks to restore */
+			chunks_nr = atoll(argv[1]);
+			if(chunks_nr < 0)
+			{
+				fprintf(stderr, "the number of chunks should be positive or "
+				        "zero\n");
+				goto error;
+			}
+			args_used++;
+		}
+		else if(!strcmp(*argv, "list"))
+		{
+			/* print the index of the archive */
+			if(argc != 2)
+			{
+				usage();
+				goto error;
+			}
+			is_failure = !arch_list(argv[1]);
+			goto error;
+		}
+		else if(!strcmp(*argv, "pack") || !strcmp(*argv, "unpack"))
+		{
+			const bool do_pack = !strcmp(*argv, "pack");
+
+			if(argc != 3)
+			{
+				usage();
+				goto error;
+			}
+
+			if(do_pack)
+			{
+				/* check CID type */
+				if(cid_type == NULL || !strcmp(cid_type, "largecid"))
+				{
+					params.cid_type = ROHC_LARGE_CID;
+					params.max_contexts = ROHC_LARGE_CID_MAX + 1;
+				}
+				else if(!strcmp(cid_type, "smallcid"))
+				{
+					params.cid_type = ROHC_SMALL_CID;
+					params.max_contexts = ROHC_SMALL_CID_MAX + 1;
+				}
+				else
+				{
+					fprintf(stderr, "invalid CID type '%s', only 'smallcid' and "
+					        "'largecid' expected\n", cid_type);
+					goto error;
+				}
+				if(max_contexts > 0)
+				{
+					if(((size_t) max_contexts) > params.max_contexts)
+					{
+						fprintf(stderr, "the maximum number of ROHC contexts should "
+						        "be between 1 and %zu\n", params.max_contexts);
+						goto error;
+					}
+					params.max_contexts = max_contexts;
+				}
+
+				is_failure = !arch_pack(argv[1], argv[2], &params, chunk_pkts);
+			}
+			else
+			{
+				is_failure = !arch_unpack(argv[1], argv[2], threads_nr,
+				                          first_chunk, chunks_nr < 0 ?
+				                          UINT64_MAX : (uint64_t) chunks_nr);
+			}
+			goto error;
+		}
+		else
+		{
+			/* do not accept any unknown option */
+			break;
+		}
+	}
+
+	/* no command or invalid option */
+	usage();
+
+error:
+	return is_failure;
+}
+
+
+/**
+ * @brief Print usage of the archive application
+ */
+static void usage(void)
+{
+	printf("Store PCAP captures as ROHC-compressed archives and restore them\n"
+	       "\n"
+	       "Every chunk of the archive starts with the IR packets of its ROHC\n"
+	       "contexts, so the chunks may be restored independently.\n"
+	       "\n"
+	       "Usage: rohc_archive [General options]\n"
+	       "   or: rohc_archive [Pack options] pack CAPTURE ARCHIVE\n"
+	       "   or: rohc_archive [Unpack options] unpack ARCHIVE CAPTURE\n"
+	       "   or: rohc_archive list ARCHIVE\n"
+	       "\n"
+	       "Options:\n"
+	       "General options:\n"
+	       "  -h, --help              Print this usage and exit\n"
+	       "  -v, --version           Print the application version and exit\n"
+	       "      --verbose           Print the traces of the ROHC library\n"
+	       "Pack options:\n"
+	       "      --cid-type TYPE     The type of CID to use among 'smallcid'\n"
+	       "                          and 'largecid' (default: largecid)\n"
+	       "      --max-contexts NUM  The maximum number of ROHC contexts to\n"
+	       "                          simultaneously use in one chunk\n"
+	       "      --chunk-packets NUM The number of packets per chunk\n"
+	       "                          (default: %u)\n"
+	       "Unpack options:\n"
+	       "      --threads NUM       The number of threads that restore\n"
+	       "                          chunks in parallel (default: 1)\n"
+	       "      --first-chunk NUM   The first chunk to restore (default: 0)\n"
+	       "      --chunks NUM        The number of chunks to restore\n"
+	       "                          (default: all)\n"
+	       "\n"
+	       "Examples:\n"
+	       "  rohc_archive pack capture.pcap capture.rohca\n"
+	       "  rohc_archive --threads 8 unpack capture.rohca capture.pcap\n"
+	       "  rohc_archive --first-chunk 100 --chunks 2 unpack capture.rohca "
+	       "part.pcap\n"
+	       "\n"
+	       "Report bugs to <" PACKAGE_BUGREPORT ">.\n",
+	       ARCH_CHUNK_PKTS_DEFAULT);
+}
+
+
+/**
+ * @brief Store the given PCAP capture as a ROHC-compressed archive
+ *
+ * @param src_filename  The name of the PCAP capture to store
+ * @param dst_filename  The name of the archive to create
+ * @param params        The parameters of the ROHC compressors
+ * @param chunk_pkts    The number of packets per chunk
+ * @return              true if the archive was created, false otherwise
+ */
+static bool arch_pack(const char *const src_filename,
+                      const char *const dst_filename,
+                      const struct arch_params *const params,
+                      const size_t chunk_pkts)
+{
+	char errbuf[PCAP_ERRBUF_SIZE];
+	struct arch_writer writer;
+	struct arch_stats stats;
+	struct arch_params chunk_params = *params;
+	uint8_t file_hdr[ARCH_FILE_HDR_LEN];
+	struct rohc_comp *comp = NULL;
+	struct rohc_decomp *decomp = NULL;
+	uint8_t rohc_buffer[ARCH_ROHC_MAX_LEN];
+	uint8_t ip_buffer[ARCH_IP_MAX_LEN];
+	uint8_t prev_link[LINUX_COOKED_HDR_LEN];
+	size_t prev_link_len = 0;
+	bool is_prev_link = false;
+	uint64_t chunk_offset = 0;
+	uint64_t chunk_first_ts = 0;
+	uint32_t chunk_pkts_nr = 0;
+	uint64_t prev_ts = 0;
+	uint32_t flags = 0;
+	uint64_t ts_unit = 1000000;
+	const uint8_t *frame;
+	struct pcap_pkthdr header;
+	pcap_t *handle;
+	int link_type;
+	bool is_ok = false;
+
+	memset(&writer, 0, sizeof(struct arch_writer));
+	memset(&stats, 0, sizeof(struct arch_stats));
+
+	/* open the source capture, with timestamps in nanoseconds if the PCAP
+	 * library supports them */
+#ifdef PCAP_TSTAMP_PRECISION_NANO
+	handle = pcap_open_offline_with_tstamp_precision(src_filename,
+	                                                 PCAP_TSTAMP_PRECISION_NANO,
+	                                                 errbuf);
+	flags |= ARCH_FLAG_NSEC;
+	ts_unit = 1000000000;
+#else
+	handle = pcap_open_offline(src_filename, errbuf);
+#endif
+	if(handle == NULL)
+	{
+		fprintf(stderr, "failed to open the source pcap file '%s': %s\n",
+		        src_filename, errbuf);
+		goto error;
+	}
+	link_type = pcap_datalink(handle);
+	chunk_params.link_type = link_type;
+	if(params->cid_type == ROHC_LARGE_CID)
+	{
+		flags |= ARCH_FLAG_LARGE_CID;
+	}
+
+	/* create the archive, the file header is completed once all packets are
+	 * stored */
+	writer.file = fopen(dst_filename, "wb");
+	if(writer.file == NULL)
+	{
+		fprintf(stderr, "failed to create the archive '%s': %s\n",
+		        dst_filename, strerror(errno));
+		goto close_input;
+	}
+	memset(file_hdr, 0, ARCH_FILE_HDR_LEN);
+	arch_write(&writer, file_hdr, ARCH_FILE_HDR_LEN);
+
+	/* store every packet of the capture */
+	while((frame = pcap_next(handle, &header)) != NULL)
+	{
+		const uint64_t ts = ((uint64_t) header.ts.tv_sec) * ts_unit +
+		                    ((uint64_t) header.ts.tv_usec);
+		const struct rohc_ts arrival_time = {
+			.sec = header.ts.tv_sec,
+			.nsec = header.ts.tv_usec * (1000000000 / ts_unit),
+		};
+		struct rohc_buf rohc_packet =
+			rohc_buf_init_empty(rohc_buffer, ARCH_ROHC_MAX_LEN);
+		arch_rec_type_t rec_type = ARCH_REC_RAW;
+		size_t link_len = 0;
+		size_t ip_len = 0;
+		uint8_t rec_first_byte;
+
+		/* start a new chunk with new ROHC contexts if the current one is full */
+		if(comp == NULL || chunk_pkts_nr >= chunk_pkts)
+		{
+			if(comp != NULL)
+			{
+				rohc_comp_free(comp);
+				rohc_decomp_free(decomp);
+				if(!arch_index_add(&writer, chunk_offset,
+				                   writer.offset - chunk_offset, chunk_first_ts,
+				                   chunk_pkts_nr))
+				{
+					comp = NULL;
+					goto close_output;
+				}
+			}
+			if(!arch_create_rohc(&chunk_params, &comp, &decomp))
+			{
+				goto close_output;
+			}
+			chunk_offset = writer.offset;
+			chunk_first_ts = ts;
+			chunk_pkts_nr = 0;
+			is_prev_link = false;
+			prev_ts = 0;
+		}
+
+		/* only complete IP packets may be compressed */
+		if(header.caplen == header.len)
+		{
+			link_len = arch_get_link_len(link_type, frame, header.caplen);
+			if(link_len > 0 || link_type == DLT_RAW)
+			{
+				if(arch_get_ip_len(frame + link_len, header.caplen - link_len,
+				                   &ip_len))
+				{
+					rec_type = ARCH_REC_ROHC;
+				}
+			}
+		}
+
+		/* compress the IP packet, then check that the ROHC packet is restored
+		 * exactly by a decompressor in the same state as the one that will
+		 * restore the archive */
+		if(rec_type == ARCH_REC_ROHC)
+		{
+			struct rohc_buf uncomp_packet =
+				rohc_buf_init_full((uint8_t *) frame + link_len, ip_len,
+				                   arrival_time);
+			struct rohc_buf restored_packet =
+				rohc_buf_init_empty(ip_buffer, ARCH_IP_MAX_LEN);
+
+			if(rohc_compress4(comp, uncomp_packet, &rohc_packet) != ROHC_STATUS_OK)
+			{
+				rec_type = ARCH_REC_RAW;
+			}
+			else
+			{
+				rohc_packet.time = arrival_time;
+				if(rohc_decompress3(decomp, rohc_packet, &restored_packet,
+				                    NULL, NULL) != ROHC_STATUS_OK ||
+				   restored_packet.len != ip_len ||
+				   memcmp(rohc_buf_data(restored_packet), frame + link_len,
+				          ip_len) != 0)
+				{
+					rec_type = ARCH_REC_ROHC_VERB;
+				}
+			}
+		}
+
+		/* write the record */
+		rec_first_byte = rec_type;
+		if(rec_type == ARCH_REC_ROHC && is_prev_link &&
+		   link_len == prev_link_len &&
+		   memcmp(frame, prev_link, link_len) == 0)
+		{
+			rec_first_byte |= ARCH_REC_SAME_LINK;
+		}
+		if(((uint32_t) header.ts.tv_usec) >= ts_unit)
+		{
+			rec_first_byte |= ARCH_REC_RAW_TS;
+		}
+		arch_write(&writer, &rec_first_byte, 1);
+		if((rec_first_byte & ARCH_REC_RAW_TS) != 0)
+		{
+			arch_write_varint(&writer, (uint32_t) header.ts.tv_sec);
+			arch_write_varint(&writer, (uint32_t) header.ts.tv_usec);
+		}
+		else
+		{
+			/* zigzag-encoded delta with the previous timestamp */
+			const int64_t ts_delta = (int64_t) (ts - prev_ts);
+			arch_write_varint(&writer, (((uint64_t) ts_delta) << 1) ^
+			                           ((uint64_t) (ts_delta >> 63)));
+			prev_ts = ts;
+		}
+		if(rec_type == ARCH_REC_ROHC)
+		{
+			const size_t trailer_len = header.caplen - link_len - ip_len;
+
+			if((rec_first_byte & ARCH_REC_SAME_LINK) == 0)
+			{
+				arch_write_varint(&writer, link_len);
+				arch_write(&writer, frame, link_len);
+				assert(link_len <= sizeof(prev_link));
+				memcpy(prev_link, frame, link_len);
+				prev_link_len = link_len;
+				is_prev_link = true;
+			}
+			arch_write_varint(&writer, rohc_packet.len);
+			arch_write(&writer, rohc_buf_data(rohc_packet), rohc_packet.len);
+			arch_write_varint(&writer, trailer_len);
+			arch_write(&writer, frame + link_len + ip_len, trailer_len);
+		}
+		else
+		{
+			if(rec_type == ARCH_REC_ROHC_VERB)
+			{
+				arch_write_varint(&writer, rohc_packet.len);
+				arch_write(&writer, rohc_buf_data(rohc_packet), rohc_packet.len);
+				arch_write_varint(&writer, header.caplen);
+			}
+			else
+			{
+				arch_write_varint(&writer, header.caplen);
+				arch_write_varint(&writer, header.len - header.caplen);
+			}
+			arch_write(&writer, frame, header.caplen);
+		}
+		if(writer.is_error)
+		{
+			goto free_rohc;
+		}
+
+		stats.pkts_nr[rec_type]++;
+		stats.uncomp_bytes += header.caplen;
+		chunk_pkts_nr++;
+	}
+
+	/* close the last chunk */
+	if(comp != NULL &&
+	   !arch_index_add(&writer, chunk_offset, writer.offset - chunk_offset,
+	                   chunk_first_ts, chunk_pkts_nr))
+	{
+		goto free_rohc;
+	}
+
+	/* write the index, then complete the file header */
+	memcpy(file_hdr, ARCH_MAGIC, 8);
+	arch_put32(file_hdr + 8, ARCH_VERSION);
+	arch_put32(file_hdr + 12, link_type == DLT_RAW ? PCAP_LINKTYPE_RAW :
+	                          ((uint32_t) link_type));
+	arch_put32(file_hdr + 16, flags);
+	arch_put32(file_hdr + 20, params->max_contexts);
+	arch_put32(file_hdr + 24, pcap_snapshot(handle));
+	arch_put32(file_hdr + 28, chunk_pkts);
+	arch_put64(file_hdr + ARCH_INDEX_OFFSET_POS, writer.offset);
+	arch_put64(file_hdr + 40, writer.chunks_nr);
+	arch_write(&writer, writer.index, writer.chunks_nr * ARCH_INDEX_ENTRY_LEN);
+	stats.arch_bytes = writer.offset;
+	if(fseek(writer.file, 0, SEEK_SET) != 0)
+	{
+		fprintf(stderr, "failed to rewind the archive: %s\n", strerror(errno));
+		goto free_rohc;
+	}
+	arch_write(&writer, file_hdr, ARCH_FILE_HDR_LEN);
+	if(writer.is_error)
+	{
+		goto free_rohc;
+	}
+
+	printf("%lu packets stored in %llu chunks: %lu ROHC, %lu ROHC with "
+	       "verbatim copy, %lu verbatim\n",
+	       stats.pkts_nr[ARCH_REC_RAW] + stats.pkts_nr[ARCH_REC_ROHC] +
+	       stats.pkts_nr[ARCH_REC_ROHC_VERB],
+	       (unsigned long long) writer.chunks_nr,
+	       stats.pkts_nr[ARCH_REC_ROHC], stats.pkts_nr[ARCH_REC_ROHC_VERB],
+	       stats.pkts_nr[ARCH_REC_RAW]);
+	printf("%llu captured bytes stored in a %llu-byte archive\n",
+	       stats.uncomp_bytes, stats.arch_bytes);
+	is_ok = true;
+
+free_rohc:
+	if(comp != NULL)
+	{
+		rohc_comp_free(comp);
+		rohc_decomp_free(decomp);
+	}
+close_output:
+	if(fclose(writer.file) != 0)
+	{
+		fprintf(stderr, "failed to write the archive: %s\n", strerror(errno));
+		is_ok = false;
+	}
+	free(writer.index);
+close_input:
+	pcap_close(handle);
+error:
+	return is_ok;
+}
+
+
+/**
+ * @brief Restore the PCAP capture stored in the given archive
+ *
+ * The chunks are restored in parallel by the given number of threads, and
+ * written in order in the PCAP capture.
+ *
+ * @param src_filename  The name of the archive to read
+ * @param dst_filename  The name of the PCAP capture to create
+ * @param threads_nr    The number of threads that restore chunks
+ * @param first_chunk   The first chunk to restore
+ * @param chunks_nr     The max number of chunks to restore
+ * @return              true if the capture was restored, false otherwise
+ */
+static bool arch_unpack(const char *const src_filename,
+                        const char *const dst_filename,
+                        const size_t threads_nr,
+                        const uint64_t first_chunk,
+                        const uint64_t chunks_nr)
+{
+	struct arch_reader reader;
+	struct arch_unpack unpack;
+	pthread_t threads[ARCH_THREADS_MAX];
+	size_t threads_started = 0;
+	uint8_t pcap_hdr[PCAP_FILE_HDR_LEN];
+	uint32_t pcap_magic;
+	uint16_t pcap_version[2] = { 2, 4 };
+	uint32_t pcap_values[4];
+	FILE *output;
+	uint64_t i;
+	bool is_ok = false;
+
+	if(!arch_open(&reader, src_filename))
+	{
+		goto error;
+	}
+	if(first_chunk > reader.chunks_nr)
+	{
+		fprintf(stderr, "archive '%s' only contains %llu chunks\n", src_filename,
+		        (unsigned long long) reader.chunks_nr);
+		goto close_input;
+	}
+
+	/* create the PCAP capture with the native byte order */
+	output = fopen(dst_filename, "wb");
+	if(output == NULL)
+	{
+		fprintf(stderr, "failed to create the pcap file '%s': %s\n",
+		        dst_filename, strerror(errno));
+		goto close_input;
+	}
+	pcap_magic = ((reader.flags & ARCH_FLAG_NSEC) != 0 ? 0xa1b23c4d : 0xa1b2c3d4);
+	pcap_values[0] = 0; /* thiszone */
+	pcap_values[1] = 0; /* sigfigs */
+	pcap_values[2] = reader.snaplen;
+	pcap_values[3] = reader.pcap_link_type;
+	memcpy(pcap_hdr, &pcap_magic, sizeof(uint32_t));
+	memcpy(pcap_hdr + 4, pcap_version, sizeof(pcap_version));
+	memcpy(pcap_hdr + 8, pcap_values, sizeof(pcap_values));
+	if(fwrite(pcap_hdr, PCAP_FILE_HDR_LEN, 1, output) != 1)
+	{
+		fprintf(stderr, "failed to write the pcap file: %s\n", strerror(errno));
+		goto close_output;
+	}
+
+	/* restore the chunks in parallel, then write them in order */
+	memset(&unpack, 0, sizeof(struct arch_unpack));
+	unpack.reader = &reader;
+	unpack.first_chunk = first_chunk;
+	unpack.chunks_nr = reader.chunks_nr - first_chunk;
+	if(unpack.chunks_nr > chunks_nr)
+	{
+		unpack.chunks_nr = chunks_nr;
+	}
+	unpack.threads_nr = threads_nr;
+	unpack.chunks = calloc(unpack.chunks_nr + 1, sizeof(struct arch_chunk_out));
+	if(unpack.chunks == NULL)
+	{
+		fprintf(stderr, "failed to allocate memory for %llu chunks\n",
+		        (unsigned long long) unpack.chunks_nr);
+		goto close_output;
+	}
+	pthread_mutex_init(&unpack.lock, NULL);
+	pthread_cond_init(&unpack.cond, NULL);
+	for(threads_started = 0; threads_started < threads_nr; threads_started++)
+	{
+		if(pthread_create(&threads[threads_started], NULL, arch_unpack_thread,
+		                  &unpack) != 0)
+		{
+			fprintf(stderr, "failed to create thread #%zu\n", threads_started + 1);
+			break;
+		}
+	}
+	is_ok = (threads_started > 0);
+
+	for(i = 0; is_ok && i < unpack.chunks_nr; i++)
+	{
+		struct arch_chunk_out *const chunk = &unpack.chunks[i];
+
+		pthread_mutex_lock(&unpack.lock);
+		while(!chunk->is_done)
+		{
+			pthread_cond_wait(&unpack.cond, &unpack.lock);
+		}
+		pthread_mutex_unlock(&unpack.lock);
+
+		if(!chunk->is_ok)
+		{
+			fprintf(stderr, "failed to restore chunk #%llu\n",
+			        (unsigned long long) (first_chunk + i));
+			is_ok = false;
+		}
+		else if(chunk->len > 0 && fwrite(chunk->data, chunk->len, 1, output) != 1)
+		{
+			fprintf(stderr, "failed to write the pcap file: %s\n",
+			        strerror(errno));
+			is_ok = false;
+		}
+		free(chunk->data);
+		chunk->data = NULL;
+
+		/* let the threads restore the next chunks */
+		pthread_mutex_lock(&unpack.lock);
+		unpack.written_nr = i + 1;
+		if(!is_ok)
+		{
+			/* stop restoring chunks */
+			unpack.next_chunk = unpack.chunks_nr;
+		}
+		pthread_cond_broadcast(&unpack.cond);
+		pthread_mutex_unlock(&unpack.lock);
+	}
+
+	for(i = 0; i < threads_started; i++)
+	{
+		pthread_join(threads[i], NULL);
+	}
+	for(i = 0; i < unpack.chunks_nr; i++)
+	{
+		free(unpack.chunks[i].data);
+	}
+	pthread_cond_destroy(&unpack.cond);
+	pthread_mutex_destroy(&unpack.lock);
+	free(unpack.chunks);
+
+close_output:
+	if(fclose(output) != 0)
+	{
+		fprintf(stderr, "failed to write the pcap file: %s\n", strerror(errno));
+		is_ok = false;
+	}
+close_input:
+	arch_close(&reader);
+error:
+	return is_ok;
+}
+
+
+/**
+ * @brief Print the index of the given archive
+ *
+ * @param filename  The name of the archive
+ * @return          true if the index was printed, false otherwise
+ */
+static bool arch_list(const char *const filename)
+{
+	struct arch_reader reader;
+	uint64_t i;
+
+	if(!arch_open(&reader, filename))
+	{
+		goto error;
+	}
+
+	printf("link type %u, %s timestamps, %s CIDs, %u contexts, "
+	       "%u packets per chunk, %llu chunks\n", reader.pcap_link_type,
+	       (reader.flags & ARCH_FLAG_NSEC) != 0 ? "ns" : "us",
+	       reader.params.cid_type == ROHC_LARGE_CID ? "large" : "small",
+	       (unsigned int) reader.params.max_contexts, reader.chunk_pkts,
+	       (unsigned long long) reader.chunks_nr);
+	printf("CHUNK\tOFFSET\tLENGTH\tPACKETS\tFIRST TIMESTAMP\n");
+	for(i = 0; i < reader.chunks_nr; i++)
+	{
+		const uint8_t *const entry = reader.index + i * ARCH_INDEX_ENTRY_LEN;
+
+		printf("%llu\t%llu\t%llu\t%u\t%llu\n", (unsigned long long) i,
+		       (unsigned long long) arch_get64(entry),
+		       (unsigned long long) arch_get64(entry + 8),
+		       arch_get32(entry + 24),
+		       (unsigned long long) arch_get64(entry + 16));
+	}
+
+	arch_close(&reader);
+	return true;
+
+error:
+	return false;
+}
+
+
+/**
+ * @brief Create the ROHC compressor and decompressor for one chunk
+ *
+ * @param params       The parameters of the compressor and decompressor
+ * @param[out] comp    The created compressor
+ * @param[out] decomp  The created decompressor
+ * @return             true if both were created, false otherwise
+ */
+static bool arch_create_rohc(const struct arch_params *const params,
+                             struct rohc_comp **const comp,
+                             struct rohc_decomp **const decomp)
+{
+	*comp = rohc_comp_new2(params->cid_type, params->max_contexts - 1,
+	                       gen_random_num, NULL);
+	if(*comp == NULL)
+	{
+		fprintf(stderr, "failed to create the ROHC compressor\n");
+		goto error;
+	}
+	if(!rohc_comp_set_traces_cb2(*comp, print_rohc_traces, NULL))
+	{
+		fprintf(stderr, "failed to set the callback for traces on "
+		        "compressor\n");
+		goto free_comp;
+	}
+	if(!rohc_comp_enable_profiles(*comp, ROHC_PROFILE_UNCOMPRESSED,
+	                              ROHC_PROFILE_UDP, ROHC_PROFILE_IP,
+	                              ROHC_PROFILE_UDPLITE, ROHC_PROFILE_RTP,
+	                              ROHC_PROFILE_ESP, ROHC_PROFILE_TCP, -1))
+	{
+		fprintf(stderr, "failed to enable the compression profiles\n");
+		goto free_comp;
+	}
+
+	*decomp = rohc_decomp_new2(params->cid_type, params->max_contexts - 1,
+	                           ROHC_U_MODE);
+	if(*decomp == NULL)
+	{
+		fprintf(stderr, "failed to create the ROHC decompressor\n");
+		goto free_comp;
+	}
+	if(!rohc_decomp_set_traces_cb2(*decomp, print_rohc_traces, NULL))
+	{
+		fprintf(stderr, "failed to set the callback for traces on "
+		        "decompressor\n");
+		goto free_decomp;
+	}
+	if(!rohc_decomp_enable_profiles(*decomp, ROHC_PROFILE_UNCOMPRESSED,
+	                                ROHC_PROFILE_UDP, ROHC_PROFILE_IP,
+	                                ROHC_PROFILE_UDPLITE, ROHC_PROFILE_RTP,
+	                                ROHC_PROFILE_ESP, ROHC_PROFILE_TCP, -1))
+	{
+		fprintf(stderr, "failed to enable the decompression profiles\n");
+		goto free_decomp;
+	}
+
+	return true;
+
+free_decomp:
+	rohc_decomp_free(*decomp);
+free_comp:
+	rohc_comp_free(*comp);
+error:
+	return false;
+}
+
+
+/**
+ * @brief Write data in the archive
+ *
+ * @param writer  The archive being written
+ * @param data    The data to write
+ * @param len     The length (in bytes) of the data
+ */
+static void arch_write(struct arch_writer *const writer,
+                       const void *const data,
+                       const size_t len)
+{
+	if(len > 0 && !writer->is_error)
+	{
+		if(fwrite(data, len, 1, writer->file) != 1)
+		{
+			fprintf(stderr, "failed to write the archive: %s\n", strerror(errno));
+			writer->is_error = true;
+		}
+		writer->offset += len;
+	}
+}
+
+
+/**
+ * @brief Write an integer in the archive, 7 bits per byte
+ *
+ * @param writer  The archive being written
+ * @param value   The integer to write
+ */
+static void arch_write_varint(struct arch_writer *const writer,
+                              const uint64_t value)
+{
+	uint8_t bytes[10];
+	uint64_t remain = value;
+	size_t len = 0;
+
+	while(remain >= 0x80)
+	{
+		bytes[len] = 0x80 | (remain & 0x7f);
+		remain >>= 7;
+		len++;
+	}
+	bytes[len] = remain;
+	len++;
+
+	arch_write(writer, bytes, len);
+}
+
+
+/**
+ * @brief Add one chunk to the index of the archive
+ *
+ * @param writer    The archive being written
+ * @param offset    The offset of the chunk in the archive
+ * @param len       The length of the chunk
+ * @param first_ts  The timestamp of the first packet of the chunk
+ * @param pkts_nr   The number of packets in the chunk
+ * @return          true if the chunk was added, false otherwise
+ */
+static bool arch_index_add(struct arch_writer *const writer,
+                           const uint64_t offset,
+                           const uint64_t len,
+                           const uint64_t first_ts,
+                           const uint32_t pkts_nr)
+{
+	uint8_t *entry;
+
+	if(writer->chunks_nr >= writer->chunks_max)
+	{
+		const uint64_t new_max = (writer->chunks_max == 0 ? 64 :
+		                          writer->chunks_max * 2);
+		uint8_t *const new_index =
+			realloc(writer->index, new_max * ARCH_INDEX_ENTRY_LEN);
+		if(new_index == NULL)
+		{
+			fprintf(stderr, "failed to allocate memory for the index of %llu "
+			        "chunks\n", (unsigned long long) new_max);
+			goto error;
+		}
+		writer->index = new_index;
+		writer->chunks_max = new_max;
+	}
+
+	entry = writer->index + writer->chunks_nr * ARCH_INDEX_ENTRY_LEN;
+	arch_put64(entry, offset);
+	arch_put64(entry + 8, len);
+	arch_put64(entry + 16, first_ts);
+	arch_put32(entry + 24, pkts_nr);
+	arch_put32(entry + 28, 0);
+	writer->chunks_nr++;
+
+	return true;
+
+error:
+	return false;
+}
+
+
+/**
+ * @brief Get the length of the link layer header of an IP frame
+ *
+ * @param link_type  The PCAP link type (DLT value)
+ * @param frame      The captured frame
+ * @param frame_len  The length (in bytes) of the captured frame
+ * @return           The length of the link layer header if the frame carries
+ *                   an IP packet, 0 otherwise
+ */
+static size_t arch_get_link_len(const int link_type,
+                                const uint8_t *const frame,
+                                const size_t frame_len)
+{
+	size_t link_len;
+	uint16_t protocol;
+
+	if(link_type == DLT_EN10MB)
+	{
+		link_len = ETHER_HDR_LEN;
+	}
+	else if(link_type == DLT_LINUX_SLL)
+	{
+		link_len = LINUX_COOKED_HDR_LEN;
+	}
+	else
+	{
+		/* raw IP packets or unsupported link layer */
+		goto not_ip;
+	}
+	if(frame_len <= link_len)
+	{
+		goto not_ip;
+	}
+
+	/* the protocol type ends both the Ethernet and Linux Cooked headers */
+	memcpy(&protocol, frame + link_len - sizeof(uint16_t), sizeof(uint16_t));
+	if(ntohs(protocol) != 0x0800 && ntohs(protocol) != 0x86dd)
+	{
+		goto not_ip;
+	}
+
+	return link_len;
+
+not_ip:
+	return 0;
+}
+
+
+/**
+ * @brief Get the length of an IP packet from its header
+ *
+ * @param ip           The IP packet, maybe followed by some padding
+ * @param max_len      The length (in bytes) of the IP packet and padding
+ * @param[out] ip_len  The length of the IP packet
+ * @return             true if the IP packet is complete, false otherwise
+ */
+static bool arch_get_ip_len(const uint8_t *const ip,
+                            const size_t max_len,
+                            size_t *const ip_len)
+{
+	if(max_len < 1)
+	{
+		goto error;
+	}
+
+	if((ip[0] >> 4) == 4 && max_len >= sizeof(struct ipv4_hdr))
+	{
+		const struct ipv4_hdr *const ipv4 = (struct ipv4_hdr *) ip;
+		*ip_len = ntohs(ipv4->tot_len);
+	}
+	else if((ip[0] >> 4) == 6 && max_len >= sizeof(struct ipv6_hdr))
+	{
+		const struct ipv6_hdr *const ipv6 = (struct ipv6_hdr *) ip;
+		*ip_len = sizeof(struct ipv6_hdr) + ntohs(ipv6->plen);
+	}
+	else
+	{
+		goto error;
+	}
+
+	return (*ip_len > 0 && *ip_len <= max_len);
+
+error:
+	return false;
+}
+
+
+/**
+ * @brief Map the given archive in memory and check its file header and index
+ *
+ * @param[out] reader  The mapped archive
+ * @param filename     The name of the archive
+ * @return             true if the archive was mapped, false otherwise
+ */
+static bool arch_open(struct arch_reader *const reader,
+                      const char *const filename)
+{
+#if HAVE_SYS_MMAN_H == 1
+	struct stat file_stat;
+	uint64_t index_offset;
+	void *data;
+	int fd;
+
+	memset(reader, 0, sizeof(struct arch_reader));
+
+	fd = open(filename, O_RDONLY);
+	if(fd < 0)
+	{
+		fprintf(stderr, "failed to open the archive '%s': %s\n", filename,
+		        strerror(errno));
+		goto error;
+	}
+	if(fstat(fd, &file_stat) != 0)
+	{
+		fprintf(stderr, "failed to get the size of the archive '%s': %s\n",
+		        filename, strerror(errno));
+		goto close_file;
+	}
+	if(file_stat.st_size < ARCH_FILE_HDR_LEN)
+	{
+		fprintf(stderr, "archive '%s' is too short\n", filename);
+		goto close_file;
+	}
+
+	/* map the whole file, the mapping remains once the file is closed */
+	data = mmap(NULL, file_stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	if(data == MAP_FAILED)
+	{
+		fprintf(stderr, "failed to map the archive '%s': %s\n", filename,
+		        strerror(errno));
+		goto close_file;
+	}
+	close(fd);
+	reader->data = data;
+	reader->len = file_stat.st_size;
+
+	/* parse the file header */
+	if(memcmp(reader->data, ARCH_MAGIC, 8) != 0 ||
+	   arch_get32(reader->data + 8) != ARCH_VERSION)
+	{
+		fprintf(stderr, "file '%s' is not a ROHC archive of version %u\n",
+		        filename, ARCH_VERSION);
+		goto unmap_file;
+	}
+	reader->pcap_link_type = arch_get32(reader->data + 12);
+	reader->link_type = (reader->pcap_link_type == PCAP_LINKTYPE_RAW ?
+	                     DLT_RAW : ((int) reader->pcap_link_type));
+	reader->flags = arch_get32(reader->data + 16);
+	reader->params.cid_type = ((reader->flags & ARCH_FLAG_LARGE_CID) != 0 ?
+	                           ROHC_LARGE_CID : ROHC_SMALL_CID);
+	reader->params.max_contexts = arch_get32(reader->data + 20);
+	reader->params.link_type = reader->link_type;
+	reader->snaplen = arch_get32(reader->data + 24);
+	reader->chunk_pkts = arch_get32(reader->data + 28);
+	index_offset = arch_get64(reader->data + ARCH_INDEX_OFFSET_POS);
+	reader->chunks_nr = arch_get64(reader->data + 40);
+	if(reader->params.max_contexts < 1 ||
+	   reader->params.max_contexts > (ROHC_LARGE_CID_MAX + 1) ||
+	   (reader->params.cid_type == ROHC_SMALL_CID &&
+	    reader->params.max_contexts > (ROHC_SMALL_CID_MAX + 1)))
+	{
+		fprintf(stderr, "archive '%s' is malformed: %zu contexts\n", filename,
+		        reader->params.max_contexts);
+		goto unmap_file;
+	}
+
+	/* check the index */
+	if(index_offset < ARCH_FILE_HDR_LEN || index_offset > reader->len ||
+	   reader->chunks_nr > ((reader->len - index_offset) / ARCH_INDEX_ENTRY_LEN))
+	{
+		fprintf(stderr, "archive '%s' is malformed: bad index\n", filename);
+		goto unmap_file;
+	}
+	reader->index = reader->data + index_offset;
+	madvise(data, reader->len, MADV_WILLNEED);
+
+	return true;
+
+unmap_file:
+	munmap((void *) reader->data, reader->len);
+	return false;
+close_file:
+	close(fd);
+error:
+	return false;
+#else
+	(void) reader;
+	fprintf(stderr, "memory-mapped archives are not supported on this "
+	        "platform, cannot read '%s'\n", filename);
+	return false;
+#endif
+}
+
+
+/**
+ * @brief Unmap the given archive
+ *
+ * @param reader  The mapped archive
+ */
+static void arch_close(struct arch_reader *const reader)
+{
+#if HAVE_SYS_MMAN_H == 1
+	munmap((void *) reader->data, reader->len);
+#else
+	(void) reader;
+#endif
+}
+
+
+/**
+ * @brief Read an integer from the archive, 7 bits per byte
+ *
+ * @param[in,out] data  The data to read the integer from, advanced beyond it
+ * @param end           The end of the data
+ * @param[out] value    The integer
+ * @return              true if the integer was read, false if malformed
+ */
+static bool arch_read_varint(const uint8_t **const data,
+                             const uint8_t *const end,
+                             uint64_t *const value)
+{
+	unsigned int shift = 0;
+
+	*value = 0;
+	while(*data < end && shift < 64)
+	{
+		const uint8_t byte = **data;
+		(*data)++;
+		*value |= ((uint64_t) (byte & 0x7f)) << shift;
+		if((byte & 0x80) == 0)
+		{
+			return true;
+		}
+		shift += 7;
+	}
+
+	return false;
+}
+
+
+/**
+ * @brief Restore chunks of the archive until all of them are restored
+ *
+ * One thread does not run too far ahead of the chunks written in the PCAP
+ * capture, so that the memory used by the restored chunks remains bounded.
+ *
+ * @param arg  The state shared by the threads that restore chunks
+ * @return     Always NULL
+ */
+static void * arch_unpack_thread(void *const arg)
+{
+	struct arch_unpack *const unpack = arg;
+
+	pthread_mutex_lock(&unpack->lock);
+	while(unpack->next_chunk < unpack->chunks_nr)
+	{
+		const uint64_t chunk_nr = unpack->next_chunk;
+		struct arch_chunk_out *const chunk = &unpack->chunks[chunk_nr];
+		bool is_ok;
+
+		if(chunk_nr >= (unpack->written_nr + unpack->threads_nr * 2))
+		{
+			pthread_cond_wait(&unpack->cond, &unpack->lock);
+			continue;
+		}
+		unpack->next_chunk++;
+		pthread_mutex_unlock(&unpack->lock);
+
+		is_ok = arch_unpack_chunk(unpack->reader, unpack->first_chunk + chunk_nr,
+		                          chunk);
+
+		pthread_mutex_lock(&unpack->lock);
+		chunk->is_ok = is_ok;
+		chunk->is_done = true;
+		pthread_cond_broadcast(&unpack->cond);
+	}
+	pthread_mutex_unlock(&unpack->lock);
+
+	return NULL;
+}
+
+
+/**
+ * @brief Restore one chunk of the archive as PCAP records
+ *
+ * @param reader    The archive
+ * @param chunk_id  The index of the chunk to restore
+ * @param out       The restored PCAP records
+ * @return          true if the chunk was restored, false otherwise
+ */
+static bool arch_unpack_chunk(const struct arch_reader *const reader,
+                              const uint64_t chunk_id,
+                              struct arch_chunk_out *const out)
+{
+	const uint8_t *const entry = reader->index + chunk_id * ARCH_INDEX_ENTRY_LEN;
+	const uint64_t chunk_offset = arch_get64(entry);
+	const uint64_t chunk_len = arch_get64(entry + 8);
+	const uint32_t pkts_nr = arch_get32(entry + 24);
+	const uint64_t ts_unit =
+		((reader->flags & ARCH_FLAG_NSEC) != 0 ? 1000000000 : 1000000);
+	struct rohc_comp *comp;
+	struct rohc_decomp *decomp;
+	const uint8_t *data;
+	const uint8_t *end;
+	const uint8_t *rohc_data;
+	const uint8_t *link_hdr = NULL;
+	uint64_t link_len = 0;
+	uint64_t ts = 0;
+	uint32_t i;
+	bool is_ok = false;
+
+	/* the chunk shall be between the file header and the index */
+	if(chunk_offset < ARCH_FILE_HDR_LEN ||
+	   chunk_offset > (uint64_t) (reader->index - reader->data) ||
+	   chunk_len > ((uint64_t) (reader->index - reader->data) - chunk_offset))
+	{
+		fprintf(stderr, "chunk #%llu is out of the archive\n",
+		        (unsigned long long) chunk_id);
+		goto error;
+	}
+	data = reader->data + chunk_offset;
+	end = data + chunk_len;
+
+	/* the chunk is decompressed with a new decompressor, as it was compressed
+	 * with a new compressor */
+	if(!arch_create_rohc(&reader->params, &comp, &decomp))
+	{
+		goto error;
+	}
+	rohc_comp_free(comp);
+
+	for(i = 0; i < pkts_nr; i++)
+	{
+		uint32_t pcap_rec[PCAP_RECORD_HDR_LEN / sizeof(uint32_t)];
+		uint64_t ts_value;
+		uint64_t rohc_len = 0;
+		uint64_t caplen;
+		uint64_t len;
+		uint8_t rec_type;
+		uint8_t *rec;
+
+		if(data >= end)
+		{
+			goto malformed;
+		}
+		rec_type = *data;
+		data++;
+		if(!arch_read_varint(&data, end, &ts_value))
+		{
+			goto malformed;
+		}
+		if((rec_type & ARCH_REC_RAW_TS) != 0)
+		{
+			pcap_rec[0] = ts_value;
+			if(!arch_read_varint(&data, end, &ts_value))
+			{
+				goto malformed;
+			}
+			pcap_rec[1] = ts_value;
+		}
+		else
+		{
+			/* zigzag-encoded delta with the previous timestamp */
+			ts += (ts_value >> 1) ^ (~(ts_value & 1) + 1);
+			pcap_rec[0] = ts / ts_unit;
+			pcap_rec[1] = ts % ts_unit;
+		}
+
+		if((rec_type & ARCH_REC_TYPE_MASK) == ARCH_REC_ROHC)
+		{
+			const struct rohc_ts arrival_time = {
+				.sec = pcap_rec[0],
+				.nsec = pcap_rec[1] * (1000000000 / ts_unit),
+			};
+			uint64_t trailer_len;
+			size_t ip_len;
+
+			/* the link header, maybe the one of the previous record */
+			if((rec_type & ARCH_REC_SAME_LINK) == 0)
+			{
+				if(!arch_read_varint(&data, end, &link_len) ||
+				   link_len > (uint64_t) (end - data))
+				{
+					goto malformed;
+				}
+				link_hdr = data;
+				data += link_len;
+			}
+			else if(link_hdr == NULL)
+			{
+				goto malformed;
+			}
+
+			/* the ROHC packet */
+			if(!arch_read_varint(&data, end, &rohc_len) ||
+			   rohc_len > (uint64_t) (end - data))
+			{
+				goto malformed;
+			}
+			rohc_data = data;
+			data += rohc_len;
+			if(!arch_read_varint(&data, end, &trailer_len) ||
+			   trailer_len > (uint64_t) (end - data))
+			{
+				goto malformed;
+			}
+
+			/* decompress the IP packet right after the link header */
+			rec = arch_out_reserve(out, PCAP_RECORD_HDR_LEN + link_len +
+			                       ARCH_IP_MAX_LEN + trailer_len);
+			if(rec == NULL)
+			{
+				goto free_decomp;
+			}
+			memcpy(rec + PCAP_RECORD_HDR_LEN, link_hdr, link_len);
+			if(!arch_decompress(decomp, rohc_data, rohc_len, arrival_time,
+			                    rec + PCAP_RECORD_HDR_LEN + link_len, &ip_len))
+			{
+				fprintf(stderr, "chunk #%llu: failed to decompress packet #%u\n",
+				        (unsigned long long) chunk_id, i + 1);
+				goto free_decomp;
+			}
+			memcpy(rec + PCAP_RECORD_HDR_LEN + link_len + ip_len, data,
+			       trailer_len);
+			data += trailer_len;
+			caplen = link_len + ip_len + trailer_len;
+			len = caplen;
+		}
+		else if((rec_type & ARCH_REC_TYPE_MASK) == ARCH_REC_ROHC_VERB ||
+		        (rec_type & ARCH_REC_TYPE_MASK) == ARCH_REC_RAW)
+		{
+			uint64_t truncated_len = 0;
+
+			if((rec_type & ARCH_REC_TYPE_MASK) == ARCH_REC_ROHC_VERB)
+			{
+				const struct rohc_ts arrival_time = {
+					.sec = pcap_rec[0],
+					.nsec = pcap_rec[1] * (1000000000 / ts_unit),
+				};
+				uint8_t ip_buffer[ARCH_IP_MAX_LEN];
+				size_t ip_len;
+
+				/* the decompressor gets the ROHC packet to stay in the same
+				 * state as when the archive was written, even if it cannot
+				 * restore the packet exactly */
+				if(!arch_read_varint(&data, end, &rohc_len) ||
+				   rohc_len > (uint64_t) (end - data))
+				{
+					goto malformed;
+				}
+				(void) arch_decompress(decomp, data, rohc_len, arrival_time,
+				                       ip_buffer, &ip_len);
+				data += rohc_len;
+
+				if(!arch_read_varint(&data, end, &caplen))
+				{
+					goto malformed;
+				}
+			}
+			else if(!arch_read_varint(&data, end, &caplen) ||
+			        !arch_read_varint(&data, end, &truncated_len))
+			{
+				goto malformed;
+			}
+			if(caplen > (uint64_t) (end - data) || truncated_len > UINT32_MAX)
+			{
+				goto malformed;
+			}
+			rec = arch_out_reserve(out, PCAP_RECORD_HDR_LEN + caplen);
+			if(rec == NULL)
+			{
+				goto free_decomp;
+			}
+			memcpy(rec + PCAP_RECORD_HDR_LEN, data, caplen);
+			data += caplen;
+			len = caplen + truncated_len;
+		}
+		else
+		{
+			goto malformed;
+		}
+
+		pcap_rec[2] = caplen;
+		pcap_rec[3] = len;
+		memcpy(rec, pcap_rec, PCAP_RECORD_HDR_LEN);
+		out->len += PCAP_RECORD_HDR_LEN + caplen;
+	}
+	if(data != end)
+	{
+		goto malformed;
+	}
+	is_ok = true;
+
+free_decomp:
+	rohc_decomp_free(decomp);
+error:
+	return is_ok;
+
+malformed:
+	fprintf(stderr, "chunk #%llu is malformed\n", (unsigned long long) chunk_id);
+	goto free_decomp;
+}
+
+
+/**
+ * @brief Decompress one ROHC packet of the archive
+ *
+ * @param decomp        The ROHC decompressor of the chunk
+ * @param rohc_data     The ROHC packet
+ * @param rohc_len      The length (in bytes) of the ROHC packet
+ * @param arrival_time  The timestamp of the packet
+ * @param ip_data       The buffer for the IP packet, at least
+ *                      \ref ARCH_IP_MAX_LEN bytes long
+ * @param[out] ip_len   The length of the IP packet
+ * @return              true if the IP packet was decompressed,
+ *                      false otherwise
+ */
+static bool arch_decompress(struct rohc_decomp *const decomp,
+                            const uint8_t *const rohc_data,
+                            const size_t rohc_len,
+                            const struct rohc_ts arrival_time,
+                            uint8_t *const ip_data,
+                            size_t *const ip_len)
+{
+	const struct rohc_buf rohc_packet =
+		rohc_buf_init_full((uint8_t *) rohc_data, rohc_len, arrival_time);
+	struct rohc_buf ip_packet = rohc_buf_init_empty(ip_data, ARCH_IP_MAX_LEN);
+
+	if(rohc_decompress3(decomp, rohc_packet, &ip_packet, NULL,
+	                    NULL) != ROHC_STATUS_OK)
+	{
+		goto error;
+	}
+	*ip_len = ip_packet.len;
+
+	return true;
+
+error:
+	return false;
+}
+
+
+/**
+ * @brief Reserve room at the end of one restored chunk
+ *
+ * @param out  The restored chunk
+ * @param len  The length (in bytes) to reserve
+ * @return     The reserved room, NULL if memory is missing
+ */
+static uint8_t * arch_out_reserve(struct arch_chunk_out *const out,
+                                  const size_t len)
+{
+	if((out->max_len - out->len) < len)
+	{
+		size_t new_max_len = (out->max_len == 0 ? (1024U * 1024U) : out->max_len);
+		uint8_t *new_data;
+
+		while((new_max_len - out->len) < len)
+		{
+			new_max_len *= 2;
+		}
+		new_data = realloc(out->data, new_max_len);
+		if(new_data == NULL)
+		{
+			fprintf(stderr, "failed to allocate %zu bytes for one chunk\n",
+			        new_max_len);
+			return NULL;
+		}
+		out->data = new_data;
+		out->max_len = new_max_len;
+	}
+
+	return out->data + out->len;
+}
+
+
+/**
+ * @brief Write a 32-bit integer in network byte order
+ *
+ * @param data   The bytes to write the integer in
+ * @param value  The integer
+ */
+static void arch_put32(uint8_t *const data, const uint32_t value)
+{
+	data[0] = (value >> 24) & 0xff;
+	data[1] = (value >> 16) & 0xff;
+	data[2] = (value >> 8) & 0xff;
+	data[3] = value & 0xff;
+}
+
+
+/**
+ * @brief Write a 64-bit integer in network byte order
+ *
+ * @param data   The bytes to write the integer in
+ * @param value  The integer
+ */
+static void arch_put64(uint8_t *const data, const uint64_t value)
+{
+	arch_put32(data, value >> 32);
+	arch_put32(data + 4, value & 0xffffffff);
+}
+
+
+/**
+ * @brief Read a 32-bit integer in network byte order
+ *
+ * @param data  The bytes to read the integer from
+ * @return      The integer
+ */
+static uint32_t arch_get32(const uint8_t *const data)
+{
+	return (((uint32_t) data[0]) << 24) | (((uint32_t) data[1]) << 16) |
+	       (((uint32_t) data[2]) << 8) | ((uint32_t) data[3]);
+}
+
+
+/**
+ * @brief Read a 64-bit integer in network byte order
+ *
+ * @param data  The bytes to read the integer from
+ * @return      The integer
+ */
+static uint64_t arch_get64(const uint8_t *const data)
+{
+	return (((uint64_t) arch_get32(data)) << 32) | arch_get32(data + 4);
+}
+
+
+/**
+ * @brief Callback to print traces of the ROHC library
+ *
+ * @param priv_ctxt  An optional private context, may be NULL
+ * @param level      The priority level of the trace
+ * @param entity     The entity that emitted the trace among:
+ *                    \li ROHC_TRACE_COMP
+ *                    \li ROHC_TRACE_DECOMP
+ * @param profile    The ID of the ROHC compression/decompression profile
+ *                   the trace is related to
+ * @param format     The format string of the trace
+ */
+static void print_rohc_traces(void *const priv_ctxt __attribute__((unused)),
+                              const rohc_trace_level_t level,
+                              const rohc_trace_entity_t entity __attribute__((unused)),
+                              const int profile __attribute__((unused)),
+                              const char *const format,
+                              ...)
+{
+	if(is_verbose)
+	{
+		const char *level_descrs[] =
+		{
+			[ROHC_TRACE_DEBUG]   = "DEBUG",
+			[ROHC_TRACE_INFO]    = "INFO",
+			[ROHC_TRACE_WARNING] = "WARNING",
+			[ROHC_TRACE_ERROR]   = "ERROR"
+		};
+		va_list args;
+		fprintf(stdout, "[%s] ", level_descrs[level]);
+		va_start(args, format);
+		vfprintf(stdout, format, args);
+		va_end(args);
+	}
+}
+
+
+/**
+ * @brief Generate a random number
+ *
+ * @param comp          The ROHC compressor
+ * @param user_context  Should always be NULL
+ * @return              A random number
+ */
+static int gen_random_num(const struct rohc_comp *const comp,
+                          void *const user_context)
+{
+	assert(comp != NULL);
+	assert(user_context == NULL);
+	return rand();
+}
@@ -44,8 +44,12 @@
 /* includes for network headers */
 #include <ip.h> /* for IPv4 checksum */
 #include <protocols/ipv4.h>
+#include <protocols/ipv6.h>
 #include <protocols/udp.h>
 #include <protocols/rtp.h>
+#include <protocols/tcp.h>
+#include <protocols/esp.h>
+#include <protocols/ip_numbers.h>
 
 /* include for the PCAP library */
 #if HAVE_PCAP_PCAP_H == 1
@@ -66,6 +70,125 @@ for ./configure ? If yes, check configure output and config.log"
 /** The length (in bytes) of the Ethernet header */
 #define ETHER_HDR_LEN  14
 
+/** The max length (in bytes) of the generated IP packets */
+#define GEN_PACKET_MAX_LEN  2048U
+
+/** The max length (in bytes) of the payloads of the generated packets */
+#define GEN_PAYLOAD_MAX_LEN  1500U
+
+/** The max number of concurrent flows in mixed workloads */
+#define GEN_FLOWS_MAX  1000000U
+
+/** The UDP destination port of the RTP flows */
+#define GEN_RTP_PORT  1234U
+
+
+/** The types of flows in mixed workloads */
+typedef enum
+{
+	GEN_FLOW_RTP = 0,  /**< IP/UDP/RTP flows (voice) */
+	GEN_FLOW_UDP = 1,  /**< IP/UDP flows */
+	GEN_FLOW_TCP = 2,  /**< IP/TCP flows with options */
+	GEN_FLOW_ESP = 3,  /**< IP/ESP flows */
+	GEN_FLOW_UDPLITE = 4,  /**< IP/UDP-Lite flows with full checksum coverage */
+	GEN_FLOW_MAX = 5,  /**< The number of types of flows */
+} gen_flow_type_t;
+
+
+/** The distributions of the payload sizes in mixed workloads */
+typedef enum
+{
+	GEN_SIZES_FIXED   = 0,  /**< All payloads have the same size */
+	GEN_SIZES_UNIFORM = 1,  /**< Payload sizes are uniformly distributed */
+	GEN_SIZES_IMIX    = 2,  /**< IP sizes follow the simple IMIX 7:4:1 */
+} gen_sizes_t;
+
+
+/** The parameters of the generated workload */
+struct gen_workload
+{
+	/** The number of concurrent flows, 0 for the single RTP stream */
+	size_t flows_nr;
+	/** The relative weights of the types of flows */
+	unsigned int weights[GEN_FLOW_MAX];
+	/** The probability that one packet is the last one of its flow */
+	double churn;
+	/** The probability that one packet is lost */
+	double loss;
+	/** The probability that one packet is delayed after the next one */
+	double reorder;
+	/** The probability that one flow runs over IPv6 */
+	double ipv6;
+	/** The probability that one IPv6 flow carries extension headers */
+	double ipv6_ext;
+	/** The distribution of the payload sizes */
+	gen_sizes_t sizes;
+	/** The min payload size for the fixed and uniform distributions */
+	size_t size_min;
+	/** The max payload size for the uniform distribution */
+	size_t size_max;
+	/** The seed of the random generator */
+	uint32_t seed;
+};
+
+
+/** One flow of a mixed workload */
+struct gen_flow
+{
+	gen_flow_type_t type;   /**< The type of flow */
+	bool is_ipv6;           /**< Whether the flow runs over IPv6 or IPv4 */
+	size_t ext_nr;          /**< The number of IPv6 extension headers */
+	uint8_t saddr[16];      /**< The source address */
+	uint8_t daddr[16];      /**< The destination address */
+	uint32_t flow_label;    /**< The IPv6 Flow Label */
+	uint16_t ip_id;         /**< The next IPv4 Identification */
+	uint16_t sport;         /**< The UDP, UDP-Lite or TCP source port */
+	uint16_t dport;         /**< The UDP, UDP-Lite or TCP destination port */
+	unsigned long pkts_nr;  /**< The number of packets already generated */
+
+	/* RTP flows */
+	uint8_t rtp_pt;         /**< The RTP Payload Type */
+	uint16_t rtp_sn;        /**< The next RTP Sequence Number */
+	uint32_t rtp_ts;        /**< The next RTP TimeStamp */
+	uint32_t rtp_ts_stride; /**< The RTP TS increment between packets */
+	uint32_t rtp_ssrc;      /**< The RTP SSRC */
+	size_t rtp_payload_len; /**< The length of the voice frames */
+
+	/* TCP flows */
+	uint32_t tcp_seq;       /**< The next TCP sequence number */
+	uint32_t tcp_ack;       /**< The next TCP acknowledgement number */
+	uint32_t tcp_ts;        /**< The next TCP timestamp */
+	uint32_t tcp_ts_echo;   /**< The next TCP timestamp echo reply */
+	uint16_t tcp_window;    /**< The TCP window */
+	uint8_t tcp_ws;         /**< The TCP window scale */
+
+	/* ESP flows */
+	uint32_t esp_spi;       /**< The ESP SPI */
+	uint32_t esp_sn;        /**< The next ESP sequence number */
+};
+
+
+/** The state of the generator of mixed workloads */
+struct gen_state
+{
+	const struct gen_workload *workload; /**< The parameters of the workload */
+	uint32_t rand_state;                 /**< The state of the random generator */
+	struct gen_flow *flows;              /**< The concurrent flows */
+	unsigned long flows_created[GEN_FLOW_MAX]; /**< The flows created per type */
+};
+
+
+/** The output of the generator with packet loss and reordering */
+struct gen_output
+{
+	pcap_dumper_t *dumper;       /**< The PCAP dump to write packets in */
+	uint8_t held[ETHER_HDR_LEN + GEN_PACKET_MAX_LEN * 2]; /**< The delayed packet */
+	size_t held_len;             /**< The length of the delayed packet, 0 if none */
+	unsigned long written_nr;    /**< The number of written packets */
+	unsigned long lost_nr;       /**< The number of lost packets */
+	unsigned long reordered_nr;  /**< The number of reordered packets */
+};
+
 
 /* prototypes of private functions */
 static void usage(void);
@@ -74,7 +197,48 @@ static bool build_stream(const char *const filename,
                          const unsigned long max_packets,
                          const int use_large_cid,
                          const size_t wlsb_width,
-                         const size_t max_contexts)
+                         const size_t max_contexts,
+                         const struct gen_workload *const workload)
+	__attribute__((warn_unused_result, nonnull(1, 2, 7)));
+
+static void build_rtp_packet(struct rohc_buf *const packet,
+                             const unsigned long counter)
+	__attribute__((nonnull(1)));
+
+static uint32_t gen_rand(struct gen_state *const gen)
+	__attribute__((warn_unused_result, nonnull(1)));
+static bool gen_rand_prob(struct gen_state *const gen, const double prob)
+	__attribute__((warn_unused_result, nonnull(1)));
+static void gen_flow_init(struct gen_state *const gen,
+                          struct gen_flow *const flow)
+	__attribute__((nonnull(1, 2)));
+static size_t gen_payload_len(struct gen_state *const gen,
+                              const size_t hdrs_len)
+	__attribute__((warn_unused_result, nonnull(1)));
+static size_t gen_build_packet(struct gen_state *const gen,
+                               struct gen_flow *const flow,
+                               const bool is_last,
+                               uint8_t *const data)
+	__attribute__((warn_unused_result, nonnull(1, 2, 4)));
+static uint16_t gen_l4_csum(const struct gen_flow *const flow,
+                            const uint8_t protocol,
+                            const uint8_t *const l4,
+                            const size_t l4_len)
+	__attribute__((warn_unused_result, nonnull(1, 3)));
+static void gen_write_packet(struct gen_state *const gen,
+                             struct gen_output *const output,
+                             const uint8_t *const data,
+                             const size_t len)
+	__attribute__((nonnull(1, 2, 3)));
+static void gen_dump_packet(struct gen_output *const output,
+                            const uint8_t *const data,
+                            const size_t len)
+	__attribute__((nonnull(1, 2)));
+
+static bool parse_percent(const char *const arg, double *const prob)
+	__attribute__((warn_unused_result, nonnull(1, 2)));
+static bool parse_sizes(const char *const arg,
+                        struct gen_workload *const workload)
 	__attribute__((warn_unused_result, nonnull(1, 2)));
 
 static void print_rohc_traces(void *const priv_ctxt,
@@ -119,6 +283,25 @@ int main(int argc, char *argv[])
 	char *cid_type = NULL;
 	int max_contexts = ROHC_SMALL_CID_MAX + 1;
 	int wlsb_width = 4;
+	struct gen_workload workload = {
+		.flows_nr = 0,
+		.weights = {
+			[GEN_FLOW_RTP] = 40,
+			[GEN_FLOW_UDP] = 20,
+			[GEN_FLOW_TCP] = 30,
+			[GEN_FLOW_ESP] = 10,
+			[GEN_FLOW_UDPLITE] = 0,
+		},
+		.churn = 0.001,
+		.loss = 0.0,
+		.reorder = 0.0,
+		.ipv6 = 0.3,
+		.ipv6_ext = 0.2,
+		.sizes = GEN_SIZES_IMIX,
+		.size_min = 0,
+		.size_max = 0,
+		.seed = 0x2545f491U,
+	};
 	int is_failure = 1;
 	int use_large_cid;
 	int args_used;
@@ -172,6 +355,106 @@ int main(int argc, char *argv[])
 			wlsb_width = atoi(argv[1]);
 			args_used++;
 		}
+		else if(!strcmp(*argv, "--flows"))
+		{
+			/* get the number of concurrent flows of the mixed workload */
+			const int flows_nr = atoi(argv[1]);
+			if(flows_nr < 1 || (unsigned int) flows_nr > GEN_FLOWS_MAX)
+			{
+				fprintf(stderr, "the number of flows should be between 1 and "
+				        "%u\n", GEN_FLOWS_MAX);
+				goto error;
+			}
+			workload.flows_nr = flows_nr;
+			args_used++;
+		}
+		else if(!strcmp(*argv, "--mix"))
+		{
+			/* get the weights of the RTP, UDP, TCP, ESP and UDP-Lite flows, the
+			 * UDP-Lite weight being optional */
+			unsigned int *const w = workload.weights;
+			char extra;
+			int ret;
+			w[GEN_FLOW_UDPLITE] = 0;
+			ret = sscanf(argv[1], "%u,%u,%u,%u,%u%c", &w[GEN_FLOW_RTP],
+			             &w[GEN_FLOW_UDP], &w[GEN_FLOW_TCP], &w[GEN_FLOW_ESP],
+			             &w[GEN_FLOW_UDPLITE], &extra);
+			if((ret != 4 && ret != 5) ||
+			   (w[GEN_FLOW_RTP] + w[GEN_FLOW_UDP] + w[GEN_FLOW_TCP] +
+			    w[GEN_FLOW_ESP] + w[GEN_FLOW_UDPLITE]) == 0)
+			{
+				fprintf(stderr, "invalid flow mix '%s': 4 or 5 weights "
+				        "RTP,UDP,TCP,ESP[,UDPLITE] expected, at least one "
+				        "non-zero\n", argv[1]);
+				goto error;
+			}
+			args_used++;
+		}
+		else if(!strcmp(*argv, "--churn"))
+		{
+			/* get the percentage of packets that end their flow */
+			if(!parse_percent(argv[1], &workload.churn))
+			{
+				goto error;
+			}
+			args_used++;
+		}
+		else if(!strcmp(*argv, "--loss"))
+		{
+			/* get the percentage of lost packets */
+			if(!parse_percent(argv[1], &workload.loss))
+			{
+				goto error;
+			}
+			args_used++;
+		}
+		else if(!strcmp(*argv, "--reorder"))
+		{
+			/* get the percentage of reordered packets */
+			if(!parse_percent(argv[1], &workload.reorder))
+			{
+				goto error;
+			}
+			args_used++;
+		}
+		else if(!strcmp(*argv, "--ipv6"))
+		{
+			/* get the percentage of IPv6 flows */
+			if(!parse_percent(argv[1], &workload.ipv6))
+			{
+				goto error;
+			}
+			args_used++;
+		}
+		else if(!strcmp(*argv, "--ipv6-ext"))
+		{
+			/* get the percentage of IPv6 flows with extension headers */
+			if(!parse_percent(argv[1], &workload.ipv6_ext))
+			{
+				goto error;
+			}
+			args_used++;
+		}
+		else if(!strcmp(*argv, "--sizes"))
+		{
+			/* get the distribution of the payload sizes */
+			if(!parse_sizes(argv[1], &workload))
+			{
+				goto error;
+			}
+			args_used++;
+		}
+		else if(!strcmp(*argv, "--seed"))
+		{
+			/* get the seed of the random generator */
+			workload.seed = strtoul(argv[1], NULL, 0);
+			if(workload.seed == 0)
+			{
+				fprintf(stderr, "the seed shall not be zero\n");
+				goto error;
+			}
+			args_used++;
+		}
 		else if(stream_type == NULL)
 		{
 			/* get the type of the stream to perform */
@@ -273,7 +556,7 @@ int main(int argc, char *argv[])
 
 	/* test ROHC compression/decompression with the packets from the file */
 	if(!build_stream(filename, stream_type, max_packets,
-	                 use_large_cid, wlsb_width, max_contexts))
+	                 use_large_cid, wlsb_width, max_contexts, &workload))
 	{
 		fprintf(stderr, "failed to build stream\n");
 		goto error;
@@ -307,6 +590,28 @@ static void usage(void)
 	       "      --max-contexts NUM  The maximum number of ROHC contexts to\n"
 	       "                          simultaneously use during the test\n"
 	       "      --wlsb-width NUM    The width of the WLSB window to use\n"
+	       "Stream options:\n"
+	       "      --flows NUM         Generate a mixed workload of NUM concurrent\n"
+	       "                          RTP, UDP, TCP, ESP and UDP-Lite flows\n"
+	       "                          instead of one RTP stream\n"
+	       "      --mix R,U,T,E[,L]   The relative weights of the RTP, UDP, TCP,\n"
+	       "                          ESP and UDP-Lite flows\n"
+	       "                          (default: 40,20,30,10,0)\n"
+	       "      --churn PERCENT     The percentage of packets that end their\n"
+	       "                          flow, the flow being replaced by a new one\n"
+	       "                          (default: 0.1)\n"
+	       "      --ipv6 PERCENT      The percentage of IPv6 flows (default: 30)\n"
+	       "      --ipv6-ext PERCENT  The percentage of IPv6 flows with Hop-by-Hop\n"
+	       "                          and Destination Options extension headers\n"
+	       "                          (default: 20)\n"
+	       "      --sizes DIST        The distribution of the UDP, TCP and ESP\n"
+	       "                          payload sizes among 'imix', 'fixed:LEN'\n"
+	       "                          and 'uniform:MIN:MAX' (default: imix)\n"
+	       "      --seed NUM          The seed of the random generator\n"
+	       "      --loss PERCENT      The percentage of packets that are lost\n"
+	       "                          (default: 0)\n"
+	       "      --reorder PERCENT   The percentage of packets that are delayed\n"
+	       "                          after the next one (default: 0)\n"
 	       "Mandatory parameters:\n"
 	       "  MAX                     The number of packets to generate\n"
 	       "  OUTPUT                  The name of the output file with the\n"
@@ -318,6 +623,13 @@ static void usage(void)
 	       "  rohc_gen_stream comp 500 rohc.pcap    Generate 500 RTP packets,\n"
 	       "                                        compress them, then store\n"
 	       "                                        them in file rohc.pcap\n"
+	       "  rohc_gen_stream --cid-type largecid --max-contexts 1024 \\\n"
+	       "    --flows 5000 --loss 1 comp 100000 mix.pcap\n"
+	       "                                        Generate 100000 packets of\n"
+	       "                                        5000 flows, compress them\n"
+	       "                                        with 1024 contexts, lose 1%%\n"
+	       "                                        of them, then store the\n"
+	       "                                        others in file mix.pcap\n"
 	       "\n"
 	       "Report bugs to <" PACKAGE_BUGREPORT ">.\n");
 }
@@ -332,6 +644,7 @@ static void usage(void)
  * @param use_large_cid  Whether the compressor shall use large CIDs
  * @param max_contexts   The maximum number of ROHC contexts to use
  * @param wlsb_width     The width of the WLSB window to use
+ * @param workload       The parameters of the generated workload
  * @return               true in case of success,
  *                       false in case of failure
  */
@@ -340,7 +653,8 @@ static bool build_stream(const char *const filename,
                          const unsigned long max_packets,
                          const int use_large_cid,
                          const size_t wlsb_width,
-                         const size_t max_contexts)
+                         const size_t max_contexts,
+                         const struct gen_workload *const workload)
 {
 	const rohc_cid_type_t cid_type =
 		(use_large_cid ? ROHC_LARGE_CID : ROHC_SMALL_CID);
@@ -348,26 +662,59 @@ static bool build_stream(const char *const filename,
 	rohc_status_t status;
 
 	pcap_t *pcap;
-	pcap_dumper_t *dumper;
+	static struct gen_output output;
+	struct gen_state gen = {
+		.workload = workload,
+		.rand_state = workload->seed,
+		.flows = NULL,
+		.flows_created = { 0 },
+	};
 
 	unsigned long counter;
 
 	struct rohc_comp *comp = NULL;
 
-	printf("generate %lu %s packets in '%s'...\n", max_packets, stream_type,
-	       filename);
+	if(workload->flows_nr == 0)
+	{
+		printf("generate %lu %s packets in '%s'...\n", max_packets, stream_type,
+		       filename);
+	}
+	else
+	{
+		printf("generate %lu %s packets of %zu concurrent flows in '%s'...\n",
+		       max_packets, stream_type, workload->flows_nr, filename);
+	}
+
+	/* create the flows of the mixed workload */
+	if(workload->flows_nr > 0)
+	{
+		size_t i;
+
+		gen.flows = calloc(workload->flows_nr, sizeof(struct gen_flow));
+		if(gen.flows == NULL)
+		{
+			fprintf(stderr, "failed to allocate memory for %zu flows\n",
+			        workload->flows_nr);
+			goto error;
+		}
+		for(i = 0; i < workload->flows_nr; i++)
+		{
+			gen_flow_init(&gen, &(gen.flows[i]));
+		}
+	}
 
 	/* create a PCAP context for output */
 	pcap = pcap_open_dead(DLT_EN10MB, 0 /* infinite snaplen */);
 	if(pcap == NULL)
 	{
 		fprintf(stderr, "failed to create a pcap context\n");
-		goto error;
+		goto free_flows;
 	}
 
 	/* open the PCAP dump file */
-	dumper = pcap_dump_open(pcap, filename);
-	if(dumper == NULL)
+	memset(&output, 0, sizeof(struct gen_output));
+	output.dumper = pcap_dump_open(pcap, filename);
+	if(output.dumper == NULL)
 	{
 		fprintf(stderr, "failed to open dump file\n");
 		goto close_pcap;
@@ -419,25 +766,15 @@ static bool build_stream(const char *const filename,
 	/* build the stream, and save it in the PCAP dump */
 	for(counter = 1; counter <= max_packets; counter++)
 	{
-		const size_t payload_len = 20;
-		const size_t packet_len = sizeof(struct ipv4_hdr) +
-		                          sizeof(struct udphdr) +
-		                          sizeof(struct rtphdr) +
-		                          payload_len;
-		uint8_t buffer[ETHER_HDR_LEN + packet_len];
+		uint8_t buffer[ETHER_HDR_LEN + GEN_PACKET_MAX_LEN];
 		struct rohc_buf packet =
-			rohc_buf_init_empty(buffer, ETHER_HDR_LEN + packet_len);
+			rohc_buf_init_empty(buffer, ETHER_HDR_LEN + GEN_PACKET_MAX_LEN);
 
-		const size_t rohc_max_len = packet_len * 2;
-		uint8_t output[ETHER_HDR_LEN + rohc_max_len];
+		uint8_t output_buf[ETHER_HDR_LEN + GEN_PACKET_MAX_LEN * 2];
 		struct rohc_buf rohc_packet =
-			rohc_buf_init_empty(output, ETHER_HDR_LEN + rohc_max_len);
+			rohc_buf_init_empty(output_buf, ETHER_HDR_LEN + GEN_PACKET_MAX_LEN * 2);
 
-		struct pcap_pkthdr header = { .ts = { .tv_sec = 0, .tv_usec = 0 } };
-		struct ipv4_hdr *ipv4;
-		struct udphdr *udp;
-		struct rtphdr *rtp;
-		size_t i;
+		uint16_t ethertype;
 
 		/* skip the Ethernet header, it will be written later */
 		packet.len += ETHER_HDR_LEN;
@@ -445,55 +782,28 @@ static bool build_stream(const char *const filename,
 		rohc_packet.len += ETHER_HDR_LEN;
 		rohc_buf_pull(&rohc_packet, ETHER_HDR_LEN);
 
-		/* build IPv4 header */
-		packet.len += sizeof(struct ipv4_hdr);
-		ipv4 = (struct ipv4_hdr *) rohc_buf_data(packet);
-		ipv4->version = 4;
-		ipv4->ihl = 5;
-		ipv4->tos = 0;
-		ipv4->tot_len = htons(packet.len);
-		ipv4->id = htons(42 + counter);
-		ipv4->frag_off = 0;
-		ipv4->ttl = 64;
-		ipv4->protocol = IPPROTO_UDP;
-		ipv4->check = 0;
-		ipv4->saddr = htonl(0xc0a80001);
-		ipv4->daddr = htonl(0xc0a80002);
-		ipv4->check = ip_fast_csum((uint8_t *) ipv4, ipv4->ihl);
-		rohc_buf_pull(&packet, sizeof(struct ipv4_hdr));
-
-		/* build UDP header */
-		packet.len += sizeof(struct udphdr);
-		udp = (struct udphdr *) rohc_buf_data(packet);
-		udp->source = htons(1234);
-		udp->dest = htons(1234);
-		udp->len = htons(packet.len);
-		udp->check = 0; /* UDP checksum disabled */
-		rohc_buf_pull(&packet, sizeof(struct udphdr));
-
-		/* build RTP header */
-		packet.len += sizeof(struct rtphdr);
-		rtp = (struct rtphdr *) rohc_buf_data(packet);
-		rtp->version = 2;
-		rtp->padding = 0;
-		rtp->extension = 0;
-		rtp->cc = 0;
-		rtp->m = 0;
-		rtp->pt = 0x72; /* speex */
-		rtp->sn = htons(counter);
-		rtp->timestamp = htonl(500000 + counter * 160);
-		rtp->ssrc = htonl(0x42424242);
-		rohc_buf_pull(&packet, sizeof(struct rtphdr));
-
-		/* build RTP payload */
-		for(i = 0; i < payload_len; i++)
-		{
-			rohc_buf_byte_at(packet, i) = i % 0xff;
-		}
-		packet.len += payload_len;
-		rohc_buf_pull(&packet, payload_len);
-
-		rohc_buf_push(&packet, packet_len);
+		if(workload->flows_nr == 0)
+		{
+			/* build the next packet of the single RTP stream */
+			build_rtp_packet(&packet, counter);
+			ethertype = 0x8000;
+		}
+		else
+		{
+			/* build the next packet of one random flow, replace the flow by
+			 * a new one if the packet is its last one */
+			struct gen_flow *const flow =
+				&(gen.flows[gen_rand(&gen) % workload->flows_nr]);
+			const bool is_last = gen_rand_prob(&gen, workload->churn);
+
+			packet.len = gen_build_packet(&gen, flow, is_last,
+			                              rohc_buf_data(packet));
+			ethertype = (flow->is_ipv6 ? 0x86dd : 0x0800);
+			if(is_last)
+			{
+				gen_flow_init(&gen, flow);
+			}
+		}
 
 		if(strcmp(stream_type, "comp") == 0)
 		{
@@ -514,25 +824,39 @@ static bool build_stream(const char *const filename,
 				(ROHC_ETHERTYPE >> 8) & 0xff;
 
 			/* write the packet in the PCAP dump */
-			header.caplen = rohc_packet.len;
-			header.len = rohc_packet.len;
-			pcap_dump((u_char *) dumper, &header, rohc_buf_data(rohc_packet));
+			gen_write_packet(&gen, &output, rohc_buf_data(rohc_packet),
+			                 rohc_packet.len);
 		}
 		else
 		{
 			/* build Linux cooked header */
 			rohc_buf_push(&packet, ETHER_HDR_LEN);
 			memset(rohc_buf_data(packet), 0, ETHER_HDR_LEN);
-			rohc_buf_byte_at(packet, ETHER_HDR_LEN - 2) = 0x80;
-			rohc_buf_byte_at(packet, ETHER_HDR_LEN - 1) = 0x00;
+			rohc_buf_byte_at(packet, ETHER_HDR_LEN - 2) = (ethertype >> 8) & 0xff;
+			rohc_buf_byte_at(packet, ETHER_HDR_LEN - 1) = ethertype & 0xff;
 
 			/* write the packet in the PCAP dump */
-			header.caplen = packet.len;
-			header.len = packet.len;
-			pcap_dump((u_char *) dumper, &header, rohc_buf_data(packet));
+			gen_write_packet(&gen, &output, rohc_buf_data(packet), packet.len);
 		}
 	}
 
+	/* write the last packet if it was delayed */
+	if(output.held_len > 0)
+	{
+		gen_dump_packet(&output, output.held, output.held_len);
+		output.held_len = 0;
+	}
+
+	printf("%lu packets written, %lu lost, %lu reordered\n", output.written_nr,
+	       output.lost_nr, output.reordered_nr);
+	if(workload->flows_nr > 0)
+	{
+		printf("%lu RTP flows, %lu UDP flows, %lu TCP flows, %lu ESP flows, "
+		       "%lu UDP-Lite flows\n", gen.flows_created[GEN_FLOW_RTP],
+		       gen.flows_created[GEN_FLOW_UDP], gen.flows_created[GEN_FLOW_TCP],
+		       gen.flows_created[GEN_FLOW_ESP], gen.flows_created[GEN_FLOW_UDPLITE]);
+	}
+
 	is_success = true;
 
 destroy_comp:
@@ -541,14 +865,704 @@ destroy_comp:
 		rohc_comp_free(comp);
 	}
 close_dumper:
-	pcap_dump_close(dumper);
+	pcap_dump_close(output.dumper);
 close_pcap:
 	pcap_close(pcap);
+free_flows:
+	free(gen.flows);
 error:
 	return is_success;
 }
 
 
+/**
+ * @brief Build the next packet of the single IPv4/UDP/RTP stream
+ *
+ * @param packet   The buffer to build the packet in
+ * @param counter  The number of the packet in the stream, starting at 1
+ */
+static void build_rtp_packet(struct rohc_buf *const packet,
+                             const unsigned long counter)
+{
+	const size_t payload_len = 20;
+	const size_t packet_len = sizeof(struct ipv4_hdr) +
+	                          sizeof(struct udphdr) +
+	                          sizeof(struct rtphdr) +
+	                          payload_len;
+	struct ipv4_hdr *ipv4;
+	struct udphdr *udp;
+	struct rtphdr *rtp;
+	size_t i;
+
+	/* build IPv4 header */
+	packet->len += sizeof(struct ipv4_hdr);
+	ipv4 = (struct ipv4_hdr *) rohc_buf_data(*packet);
+	ipv4->version = 4;
+	ipv4->ihl = 5;
+	ipv4->tos = 0;
+	ipv4->tot_len = htons(packet->len);
+	ipv4->id = htons(42 + counter);
+	ipv4->frag_off = 0;
+	ipv4->ttl = 64;
+	ipv4->protocol = IPPROTO_UDP;
+	ipv4->check = 0;
+	ipv4->saddr = htonl(0xc0a80001);
+	ipv4->daddr = htonl(0xc0a80002);
+	ipv4->check = ip_fast_csum((uint8_t *) ipv4, ipv4->ihl);
+	rohc_buf_pull(packet, sizeof(struct ipv4_hdr));
+
+	/* build UDP header */
+	packet->len += sizeof(struct udphdr);
+	udp = (struct udphdr *) rohc_buf_data(*packet);
+	udp->source = htons(GEN_RTP_PORT);
+	udp->dest = htons(GEN_RTP_PORT);
+	udp->len = htons(packet->len);
+	udp->check = 0; /* UDP checksum disabled */
+	rohc_buf_pull(packet, sizeof(struct udphdr));
+
+	/* build RTP header */
+	packet->len += sizeof(struct rtphdr);
+	rtp = (struct rtphdr *) rohc_buf_data(*packet);
+	rtp->version = 2;
+	rtp->padding = 0;
+	rtp->extension = 0;
+	rtp->cc = 0;
+	rtp->m = 0;
+	rtp->pt = 0x72; /* speex */
+	rtp->sn = htons(counter);
+	rtp->timestamp = htonl(500000 + counter * 160);
+	rtp->ssrc = htonl(0x42424242);
+	rohc_buf_pull(packet, sizeof(struct rtphdr));
+
+	/* build RTP payload */
+	for(i = 0; i < payload_len; i++)
+	{
+		rohc_buf_byte_at(*packet, i) = i % 0xff;
+	}
+	packet->len += payload_len;
+	rohc_buf_pull(packet, payload_len);
+
+	rohc_buf_push(packet, packet_len);
+}
+
+
+/**
+ * @brief Get a pseudo-random number (xorshift32)
+ *
+ * @param gen  The state of the generator
+ * @return     The pseudo-random number
+ */
+static uint32_t gen_rand(struct gen_state *const gen)
+{
+	gen->rand_state ^= gen->rand_state << 13;
+	gen->rand_state ^= gen->rand_state >> 17;
+	gen->rand_state ^= gen->rand_state << 5;
+	return gen->rand_state;
+}
+
+
+/**
+ * @brief Draw a random event with the given probability
+ *
+ * @param gen   The state of the generator
+ * @param prob  The probability of the event, in [0, 1]
+ * @return      true if the event occurs, false otherwise
+ */
+static bool gen_rand_prob(struct gen_state *const gen, const double prob)
+{
+	return (prob > 0.0 && (gen_rand(gen) / 4294967296.0) < prob);
+}
+
+
+/**
+ * @brief Create a new flow of the mixed workload
+ *
+ * The type of flow is drawn according to the weights of the workload. The
+ * addresses, ports and initial values of the sequence numbers are random.
+ *
+ * @param gen   The state of the generator
+ * @param flow  The flow to initialize
+ */
+static void gen_flow_init(struct gen_state *const gen,
+                          struct gen_flow *const flow)
+{
+	const struct gen_workload *const workload = gen->workload;
+	const unsigned int weights_sum =
+		workload->weights[GEN_FLOW_RTP] + workload->weights[GEN_FLOW_UDP] +
+		workload->weights[GEN_FLOW_TCP] + workload->weights[GEN_FLOW_ESP] +
+		workload->weights[GEN_FLOW_UDPLITE];
+	unsigned int weight = gen_rand(gen) % weights_sum;
+	size_t i;
+
+	memset(flow, 0, sizeof(struct gen_flow));
+
+	/* choose the type of flow */
+	for(flow->type = GEN_FLOW_RTP;
+	    weight >= workload->weights[flow->type];
+	    flow->type++)
+	{
+		weight -= workload->weights[flow->type];
+	}
+	gen->flows_created[flow->type]++;
+
+	/* choose the IP version, the extension headers and the addresses:
+	 * 10.0.0.0/8 for IPv4, 2001:db8::/32 for IPv6 */
+	flow->is_ipv6 = gen_rand_prob(gen, workload->ipv6);
+	if(flow->is_ipv6)
+	{
+		if(gen_rand_prob(gen, workload->ipv6_ext))
+		{
+			flow->ext_nr = 1 + gen_rand(gen) % 2;
+		}
+		flow->saddr[0] = 0x20;
+		flow->saddr[1] = 0x01;
+		flow->saddr[2] = 0x0d;
+		flow->saddr[3] = 0xb8;
+		memcpy(flow->daddr, flow->saddr, 4);
+		for(i = 4; i < 16; i++)
+		{
+			flow->saddr[i] = gen_rand(gen) & 0xff;
+			flow->daddr[i] = gen_rand(gen) & 0xff;
+		}
+		flow->flow_label = (gen_rand(gen) % 2) ? gen_rand(gen) & IPV6_FLOW_MASK : 0;
+	}
+	else
+	{
+		flow->saddr[0] = 10;
+		flow->daddr[0] = 10;
+		for(i = 1; i < 4; i++)
+		{
+			flow->saddr[i] = gen_rand(gen) & 0xff;
+			flow->daddr[i] = gen_rand(gen) & 0xff;
+		}
+		flow->ip_id = gen_rand(gen) & 0xffff;
+	}
+
+	/* choose the ports, the RTP destination port is the one detected by the
+	 * RTP callback of the compressor */
+	flow->sport = 1024 + gen_rand(gen) % (65536 - 1024);
+	do
+	{
+		flow->dport = 1024 + gen_rand(gen) % (65536 - 1024);
+	}
+	while(flow->dport == GEN_RTP_PORT);
+
+	switch(flow->type)
+	{
+		case GEN_FLOW_RTP:
+		{
+			/* voice codecs: G.711 20 ms, G.729 20 ms, AMR-WB 20 ms, speex 30 ms */
+			static const struct
+			{
+				uint8_t pt;
+				size_t payload_len;
+				uint32_t ts_stride;
+			} codecs[] = {
+				{ 0, 160, 160 }, { 18, 20, 160 }, { 0x61, 33, 320 }, { 0x72, 28, 240 },
+			};
+			const size_t codec = gen_rand(gen) % (sizeof(codecs) / sizeof(codecs[0]));
+
+			flow->dport = GEN_RTP_PORT;
+			flow->rtp_pt = codecs[codec].pt;
+			flow->rtp_payload_len = codecs[codec].payload_len;
+			flow->rtp_ts_stride = codecs[codec].ts_stride;
+			flow->rtp_sn = gen_rand(gen) & 0xffff;
+			flow->rtp_ts = gen_rand(gen);
+			flow->rtp_ssrc = gen_rand(gen);
+			break;
+		}
+		case GEN_FLOW_TCP:
+			flow->tcp_seq = gen_rand(gen);
+			flow->tcp_ack = gen_rand(gen);
+			flow->tcp_ts = gen_rand(gen);
+			flow->tcp_ts_echo = gen_rand(gen);
+			flow->tcp_ws = gen_rand(gen) % 15;
+			flow->tcp_window = 8192 + gen_rand(gen) % (65535 - 8192);
+			break;
+		case GEN_FLOW_ESP:
+			flow->esp_spi = 256 + gen_rand(gen) % (0xffffffffU - 256);
+			flow->esp_sn = 1;
+			break;
+		case GEN_FLOW_UDP:
+		case GEN_FLOW_UDPLITE:
+		case GEN_FLOW_MAX:
+		default:
+			break;
+	}
+}
+
+
+/**
+ * @brief Draw the length of the payload of one UDP, TCP or ESP packet
+ *
+ * @param gen       The state of the generator
+ * @param hdrs_len  The length of the headers of the packet
+ * @return          The length of the payload
+ */
+static size_t gen_payload_len(struct gen_state *const gen,
+                              const size_t hdrs_len)
+{
+	const struct gen_workload *const workload = gen->workload;
+	size_t payload_len;
+
+	switch(workload->sizes)
+	{
+		case GEN_SIZES_FIXED:
+			payload_len = workload->size_min;
+			break;
+		case GEN_SIZES_UNIFORM:
+			payload_len = workload->size_min +
+				gen_rand(gen) % (workload->size_max - workload->size_min + 1);
+			break;
+		case GEN_SIZES_IMIX:
+		default:
+		{
+			/* simple IMIX: 7 packets of 40 bytes, 4 of 576 bytes, 1 of 1500 */
+			const unsigned int r = gen_rand(gen) % 12;
+			const size_t ip_len = (r < 7 ? 40 : (r < 11 ? 576 : 1500));
+			payload_len = (ip_len > hdrs_len ? ip_len - hdrs_len : 0);
+			break;
+		}
+	}
+
+	return payload_len;
+}
+
+
+/**
+ * @brief Build the next packet of one flow of the mixed workload
+ *
+ * TCP flows start with a SYN segment with the MSS, SACK Permitted, TS and WS
+ * options, then carry the NOP/NOP/TS options, and a SACK option with 1 to 3
+ * blocks in 5% of the segments. Their last segment has the FIN flag set.
+ *
+ * @param gen      The state of the generator
+ * @param flow     The flow to build the next packet of
+ * @param is_last  Whether the packet is the last one of the flow
+ * @param data     The buffer to build the packet in, at least
+ *                 \ref GEN_PACKET_MAX_LEN long
+ * @return         The length of the built packet
+ */
+static size_t gen_build_packet(struct gen_state *const gen,
+                               struct gen_flow *const flow,
+                               const bool is_last,
+                               uint8_t *const data)
+{
+	const uint8_t l4_protos[GEN_FLOW_MAX] = {
+		[GEN_FLOW_RTP] = ROHC_IPPROTO_UDP,
+		[GEN_FLOW_UDP] = ROHC_IPPROTO_UDP,
+		[GEN_FLOW_TCP] = ROHC_IPPROTO_TCP,
+		[GEN_FLOW_ESP] = ROHC_IPPROTO_ESP,
+		[GEN_FLOW_UDPLITE] = ROHC_IPPROTO_UDPLITE,
+	};
+	const uint8_t l4_proto = l4_protos[flow->type];
+	size_t ip_hdrs_len;
+	size_t l4_hdr_len;
+	size_t payload_len;
+	uint8_t *l4;
+	size_t i;
+
+	/* build the IP header and its extension headers, lengths and checksum
+	 * are set once the packet is complete */
+	if(flow->is_ipv6)
+	{
+		struct ipv6_hdr *const ipv6 = (struct ipv6_hdr *) data;
+		const uint8_t ext_protos[2] = { ROHC_IPPROTO_HOPOPTS, ROHC_IPPROTO_DSTOPTS };
+
+		ipv6->version_tc_flow = htonl((6U << 28) | flow->flow_label);
+		ipv6->nh = (flow->ext_nr > 0 ? ext_protos[0] : l4_proto);
+		ipv6->hl = 64;
+		memcpy(ipv6->saddr.u8, flow->saddr, 16);
+		memcpy(ipv6->daddr.u8, flow->daddr, 16);
+		ip_hdrs_len = sizeof(struct ipv6_hdr);
+
+		/* 8-byte extension headers padded with one PadN option */
+		for(i = 0; i < flow->ext_nr; i++)
+		{
+			uint8_t *const ext = data + ip_hdrs_len;
+			ext[0] = (i + 1 < flow->ext_nr ? ext_protos[i + 1] : l4_proto);
+			ext[1] = 0;
+			ext[2] = 1;
+			ext[3] = 4;
+			memset(ext + 4, 0, 4);
+			ip_hdrs_len += 8;
+		}
+	}
+	else
+	{
+		struct ipv4_hdr *const ipv4 = (struct ipv4_hdr *) data;
+
+		ipv4->version = 4;
+		ipv4->ihl = 5;
+		ipv4->tos = 0;
+		ipv4->id = htons(flow->ip_id);
+		ipv4->frag_off = (flow->type == GEN_FLOW_TCP ? htons(IPV4_DF) : 0);
+		ipv4->ttl = 64;
+		ipv4->protocol = l4_proto;
+		ipv4->check = 0;
+		memcpy(&ipv4->saddr, flow->saddr, 4);
+		memcpy(&ipv4->daddr, flow->daddr, 4);
+		ip_hdrs_len = sizeof(struct ipv4_hdr);
+		flow->ip_id++;
+	}
+	l4 = data + ip_hdrs_len;
+
+	/* build the transport header and the payload */
+	switch(flow->type)
+	{
+		case GEN_FLOW_RTP:
+		{
+			struct rtphdr *const rtp = (struct rtphdr *) (l4 + sizeof(struct udphdr));
+
+			rtp->version = 2;
+			rtp->padding = 0;
+			rtp->extension = 0;
+			rtp->cc = 0;
+			rtp->m = (flow->pkts_nr == 0);
+			rtp->pt = flow->rtp_pt;
+			rtp->sn = htons(flow->rtp_sn);
+			rtp->timestamp = htonl(flow->rtp_ts);
+			rtp->ssrc = htonl(flow->rtp_ssrc);
+			flow->rtp_sn++;
+			flow->rtp_ts += flow->rtp_ts_stride;
+
+			l4_hdr_len = sizeof(struct udphdr) + sizeof(struct rtphdr);
+			payload_len = flow->rtp_payload_len;
+			break;
+		}
+		case GEN_FLOW_UDP:
+		case GEN_FLOW_UDPLITE:
+			l4_hdr_len = sizeof(struct udphdr);
+			payload_len = gen_payload_len(gen, ip_hdrs_len + l4_hdr_len);
+			break;
+		case GEN_FLOW_TCP:
+		{
+			struct tcphdr *const tcp = (struct tcphdr *) l4;
+			uint8_t *opts = tcp->options;
+			struct tcp_option_timestamp ts;
+
+			memset(tcp, 0, sizeof(struct tcphdr));
+			tcp->src_port = htons(flow->sport);
+			tcp->dst_port = htons(flow->dport);
+			tcp->seq_num = htonl(flow->tcp_seq);
+			tcp->window = htons(flow->tcp_window);
+
+			ts.ts = htonl(flow->tcp_ts);
+			ts.ts_reply = htonl(flow->tcp_ts_echo);
+			if(flow->pkts_nr == 0)
+			{
+				/* SYN with MSS, SACK Permitted, TS, NOP and WS options */
+				tcp->rsf_flags = RSF_SYN_ONLY;
+				opts[0] = TCP_OPT_MSS;
+				opts[1] = TCP_OLEN_MSS;
+				opts[2] = (1460 >> 8) & 0xff;
+				opts[3] = 1460 & 0xff;
+				opts[4] = TCP_OPT_SACK_PERM;
+				opts[5] = TCP_OLEN_SACK_PERM;
+				opts[6] = TCP_OPT_TS;
+				opts[7] = TCP_OLEN_TS;
+				ts.ts_reply = 0;
+				memcpy(opts + 8, &ts, sizeof(struct tcp_option_timestamp));
+				opts[16] = TCP_OPT_NOP;
+				opts[17] = TCP_OPT_WS;
+				opts[18] = TCP_OLEN_WS;
+				opts[19] = flow->tcp_ws;
+				opts += 20;
+				payload_len = 0;
+				flow->tcp_seq++;
+			}
+			else
+			{
+				/* ACK with NOP, NOP and TS options, sometimes with a SACK option */
+				tcp->ack_flag = 1;
+				tcp->ack_num = htonl(flow->tcp_ack);
+				opts[0] = TCP_OPT_NOP;
+				opts[1] = TCP_OPT_NOP;
+				opts[2] = TCP_OPT_TS;
+				opts[3] = TCP_OLEN_TS;
+				memcpy(opts + 4, &ts, sizeof(struct tcp_option_timestamp));
+				opts += 12;
+				if((gen_rand(gen) % 100) < 5)
+				{
+					const size_t blocks_nr = 1 + gen_rand(gen) % 3;
+					uint32_t edge = flow->tcp_ack + 1460 * (1 + gen_rand(gen) % 4);
+					size_t block;
+
+					opts[0] = TCP_OPT_NOP;
+					opts[1] = TCP_OPT_NOP;
+					opts[2] = TCP_OPT_SACK;
+					opts[3] = 2 + blocks_nr * sizeof(sack_block_t);
+					opts += 4;
+					for(block = 0; block < blocks_nr; block++)
+					{
+						sack_block_t sack_block;
+						const uint32_t len = 1460 * (1 + gen_rand(gen) % 8);
+
+						sack_block.block_start = htonl(edge);
+						sack_block.block_end = htonl(edge + len);
+						memcpy(opts, &sack_block, sizeof(sack_block_t));
+						opts += sizeof(sack_block_t);
+						edge += len + 1460 * (1 + gen_rand(gen) % 4);
+					}
+				}
+				if(is_last)
+				{
+					tcp->rsf_flags = RSF_FIN_ONLY;
+				}
+				else
+				{
+					tcp->psh_flag = (gen_rand(gen) % 4 == 0);
+				}
+				payload_len = gen_payload_len(gen, ip_hdrs_len + (opts - l4));
+				flow->tcp_seq += payload_len + (is_last ? 1 : 0);
+				flow->tcp_ack += (gen_rand(gen) % 2) * 1460;
+			}
+			flow->tcp_ts += gen_rand(gen) % 4;
+			flow->tcp_ts_echo += gen_rand(gen) % 4;
+			l4_hdr_len = opts - l4;
+			tcp->data_offset = l4_hdr_len / 4;
+			break;
+		}
+		case GEN_FLOW_ESP:
+		case GEN_FLOW_MAX:
+		default:
+		{
+			struct esphdr *const esp = (struct esphdr *) l4;
+
+			esp->spi = htonl(flow->esp_spi);
+			esp->sn = htonl(flow->esp_sn);
+			flow->esp_sn++;
+
+			l4_hdr_len = sizeof(struct esphdr);
+			payload_len = gen_payload_len(gen, ip_hdrs_len + l4_hdr_len);
+			break;
+		}
+	}
+	if(payload_len > GEN_PAYLOAD_MAX_LEN)
+	{
+		payload_len = GEN_PAYLOAD_MAX_LEN;
+	}
+
+	/* the payload is random: encrypted for ESP, compressed media for others */
+	for(i = 0; i < payload_len; i++)
+	{
+		l4[l4_hdr_len + i] = gen_rand(gen) & 0xff;
+	}
+
+	/* set the UDP length and the UDP or TCP checksum, the UDP-Lite checksum
+	 * coverage is the whole packet so it matches the UDP length */
+	if(l4_proto == ROHC_IPPROTO_UDP || l4_proto == ROHC_IPPROTO_UDPLITE)
+	{
+		struct udphdr *const udp = (struct udphdr *) l4;
+		uint16_t check;
+
+		udp->source = htons(flow->sport);
+		udp->dest = htons(flow->dport);
+		udp->len = htons(l4_hdr_len + payload_len);
+		udp->check = 0;
+		check = gen_l4_csum(flow, l4_proto, l4, l4_hdr_len + payload_len);
+		udp->check = htons(check == 0 ? 0xffff : check);
+	}
+	else if(l4_proto == ROHC_IPPROTO_TCP)
+	{
+		struct tcphdr *const tcp = (struct tcphdr *) l4;
+		tcp->checksum = htons(gen_l4_csum(flow, l4_proto, l4,
+		                                  l4_hdr_len + payload_len));
+	}
+
+	/* set the IP lengths and the IPv4 checksum */
+	if(flow->is_ipv6)
+	{
+		struct ipv6_hdr *const ipv6 = (struct ipv6_hdr *) data;
+		ipv6->plen = htons(ip_hdrs_len - sizeof(struct ipv6_hdr) +
+		                   l4_hdr_len + payload_len);
+	}
+	else
+	{
+		struct ipv4_hdr *const ipv4 = (struct ipv4_hdr *) data;
+		ipv4->tot_len = htons(ip_hdrs_len + l4_hdr_len + payload_len);
+		ipv4->check = ip_fast_csum((uint8_t *) ipv4, ipv4->ihl);
+	}
+
+	flow->pkts_nr++;
+
+	return (ip_hdrs_len + l4_hdr_len + payload_len);
+}
+
+
+/**
+ * @brief Compute the UDP, UDP-Lite or TCP checksum of one packet of the given flow
+ *
+ * @param flow      The flow the packet belongs to
+ * @param protocol  The transport protocol
+ * @param l4        The transport header and payload, checksum set to zero
+ * @param l4_len    The length of the transport header and payload
+ * @return          The checksum in host byte order
+ */
+static uint16_t gen_l4_csum(const struct gen_flow *const flow,
+                            const uint8_t protocol,
+                            const uint8_t *const l4,
+                            const size_t l4_len)
+{
+	const size_t addr_len = (flow->is_ipv6 ? 16 : 4);
+	uint32_t sum = 0;
+	size_t i;
+
+	/* pseudo-header */
+	for(i = 0; i < addr_len; i += 2)
+	{
+		sum += (flow->saddr[i] << 8) | flow->saddr[i + 1];
+		sum += (flow->daddr[i] << 8) | flow->daddr[i + 1];
+	}
+	sum += protocol;
+	sum += l4_len;
+
+	/* transport header and payload */
+	for(i = 0; i + 1 < l4_len; i += 2)
+	{
+		sum += (l4[i] << 8) | l4[i + 1];
+	}
+	if(i < l4_len)
+	{
+		sum += l4[i] << 8;
+	}
+
+	while((sum >> 16) != 0)
+	{
+		sum = (sum & 0xffff) + (sum >> 16);
+	}
+
+	return (~sum) & 0xffff;
+}
+
+
+/**
+ * @brief Write one packet in the PCAP dump, simulating loss and reordering
+ *
+ * A reordered packet is held back and written after the next packet.
+ *
+ * @param gen     The state of the generator
+ * @param output  The output of the generator
+ * @param data    The packet to write, including its link layer header
+ * @param len     The length of the packet
+ */
+static void gen_write_packet(struct gen_state *const gen,
+                             struct gen_output *const output,
+                             const uint8_t *const data,
+                             const size_t len)
+{
+	if(gen_rand_prob(gen, gen->workload->loss))
+	{
+		output->lost_nr++;
+	}
+	else if(output->held_len > 0)
+	{
+		gen_dump_packet(output, data, len);
+		gen_dump_packet(output, output->held, output->held_len);
+		output->held_len = 0;
+	}
+	else if(len <= sizeof(output->held) &&
+	        gen_rand_prob(gen, gen->workload->reorder))
+	{
+		memcpy(output->held, data, len);
+		output->held_len = len;
+		output->reordered_nr++;
+	}
+	else
+	{
+		gen_dump_packet(output, data, len);
+	}
+}
+
+
+/**
+ * @brief Write one packet in the PCAP dump
+ *
+ * @param output  The output of the generator
+ * @param data    The packet to write, including its link layer header
+ * @param len     The length of the packet
+ */
+static void gen_dump_packet(struct gen_output *const output,
+                            const uint8_t *const data,
+                            const size_t len)
+{
+	struct pcap_pkthdr header = { .ts = { .tv_sec = 0, .tv_usec = 0 } };
+
+	header.caplen = len;
+	header.len = len;
+	pcap_dump((u_char *) output->dumper, &header, data);
+	output->written_nr++;
+}
+
+
+/**
+ * @brief Parse a percentage given on the command line
+ *
+ * @param arg   The command line argument
+ * @param prob  OUT: The probability in [0, 1]
+ * @return      true if the percentage is valid, false otherwise
+ */
+static bool parse_percent(const char *const arg, double *const prob)
+{
+	char *end;
+	const double percent = strtod(arg, &end);
+
+	if(end == arg || (*end) != '\0' || percent < 0.0 || percent > 100.0)
+	{
+		fprintf(stderr, "invalid percentage '%s': should be between 0 and "
+		        "100\n", arg);
+		return false;
+	}
+	*prob = percent / 100.0;
+
+	return true;
+}
+
+
+/**
+ * @brief Parse the distribution of payload sizes given on the command line
+ *
+ * @param arg       The command line argument: imix, fixed:LEN or
+ *                  uniform:MIN:MAX
+ * @param workload  OUT: The workload to set the distribution of
+ * @return          true if the distribution is valid, false otherwise
+ */
+static bool parse_sizes(const char *const arg,
+                        struct gen_workload *const workload)
+{
+	unsigned int min;
+	unsigned int max;
+	char extra;
+
+	if(!strcmp(arg, "imix"))
+	{
+		workload->sizes = GEN_SIZES_IMIX;
+	}
+	else if(sscanf(arg, "fixed:%u%c", &min, &extra) == 1 &&
+	        min <= GEN_PAYLOAD_MAX_LEN)
+	{
+		workload->sizes = GEN_SIZES_FIXED;
+		workload->size_min = min;
+	}
+	else if(sscanf(arg, "uniform:%u:%u%c", &min, &max, &extra) == 2 &&
+	        min <= max && max <= GEN_PAYLOAD_MAX_LEN)
+	{
+		workload->sizes = GEN_SIZES_UNIFORM;
+		workload->size_min = min;
+		workload->size_max = max;
+	}
+	else
+	{
+		fprintf(stderr, "invalid size distribution '%s': 'imix', 'fixed:LEN' "
+		        "or 'uniform:MIN:MAX' expected with lengths up to %u bytes\n",
+		        arg, GEN_PAYLOAD_MAX_LEN);
+		return false;
+	}
+
+	return true;
+}
+
+
 /**
  * @brief Callback to print traces of the ROHC library
  *
@@ -618,7 +1632,7 @@ static bool rohc_comp_rtp_cb(const unsigned char *const ip __attribute__((unused
                              void *const rtp_private __attribute__((unused)))
 {
 	const size_t default_rtp_ports_nr = 1;
-	unsigned int default_rtp_ports[] = { 1234 };
+	unsigned int default_rtp_ports[] = { GEN_RTP_PORT };
 	uint16_t udp_dport;
 	bool is_rtp = false;
 	size_t i;
@@ -0,0 +1,94 @@
+#!/bin/sh
+#
+# Copyright 2016 Didier Barvaux
+#
+# This library is free software; you can redistribute it and/or
+# modify it under the terms of the GNU Lesser General Public
+# License as published by the Free Software Foundation; either
+# version 2.1 of the License, or (at your option) any later version.
+#
+# This library is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+# Lesser General Public License for more details.
+#
+# You should have received a copy of the GNU Lesser General Public
+# License along with this library; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+#
+
+#
+# file:        rohc_test_memory.sh
+# description: Measure the memory used by the compressor and the decompressor
+#              for every profile, over IPv4, IPv6 and IPv6 with extension
+#              headers.
+# authors:     Didier Barvaux <didier@barvaux.org>
+#
+# For every profile and IP version, rohc_gen_stream generates a capture with
+# the given number of flows, then rohc_test_memory measures the memory used
+# by the compressor and the decompressor to handle them with one context per
+# flow. One line is printed per profile, IP version and side.
+#
+
+BASEDIR=$( dirname "$0" )
+GEN_BIN="${BASEDIR}/rohc_gen_stream"
+TEST_BIN="${BASEDIR}/rohc_test_memory"
+
+usage()
+{
+	echo "rohc_test_memory.sh [nr-contexts [nr-packets-per-context]]"
+}
+
+
+for bin in "${GEN_BIN}" "${TEST_BIN}" ; do
+	if [ ! -x "${bin}" ] ; then
+		echo "${bin} executable not found or not executable" >&2
+		exit 1
+	fi
+done
+
+contexts_nr="$1"
+packets_nr="$2"
+test -z "${contexts_nr}" && contexts_nr=100
+test -z "${packets_nr}" && packets_nr=20
+if [ "${contexts_nr}" -lt 1 ] 2>/dev/null || \
+   [ "${contexts_nr}" -gt 16384 ] 2>/dev/null || \
+   [ "${packets_nr}" -lt 2 ] 2>/dev/null ; then
+	usage
+	exit 1
+fi
+if [ "${contexts_nr}" -le 16 ] ; then
+	cid_type="smallcid"
+else
+	cid_type="largecid"
+fi
+
+capture=$( mktemp ) || exit 1
+trap 'rm -f "${capture}"' EXIT INT TERM
+
+echo "profile	IP	side	contexts	instance bytes	instance allocations	bytes per context	allocations per context	peak bytes	steady bytes	steady allocations	leaked bytes"
+
+# the weights of the RTP, UDP, TCP, ESP and UDP-Lite flows of rohc_gen_stream
+for profile in rtp:1,0,0,0,0 udp:0,1,0,0,0 tcp:0,0,1,0,0 esp:0,0,0,1,0 \
+               udplite:0,0,0,0,1 ; do
+	name="${profile%%:*}"
+	mix="${profile#*:}"
+
+	for ip in ipv4:0:0 ipv6:100:0 ipv6-ext:100:100 ; do
+		ip_name=$( echo "${ip}" | cut -d: -f1 )
+		ipv6=$( echo "${ip}" | cut -d: -f2 )
+		ipv6_ext=$( echo "${ip}" | cut -d: -f3 )
+
+		if ! ${GEN_BIN} --flows ${contexts_nr} --mix ${mix} --churn 0 \
+		        --ipv6 ${ipv6} --ipv6-ext ${ipv6_ext} --sizes fixed:100 \
+		        uncomp $(( contexts_nr * packets_nr )) "${capture}" \
+		        >/dev/null ; then
+			echo "${name}	${ip_name}	failed to generate the capture" >&2
+			continue
+		fi
+
+		${TEST_BIN} --max-contexts ${contexts_nr} ${cid_type} "${capture}" | \
+			grep -v '	side	' | \
+			sed -e "s/^MEMORY/${name}	${ip_name}/"
+	done
+done
@@ -0,0 +1,895 @@
+/*
+ * Copyright 2016 Didier Barvaux
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/**
+ * @file    test_memory.c
+ * @brief   ROHC memory footprint program
+ * @author  Didier Barvaux <didier@barvaux.org>
+ *
+ * Introduction
+ * ------------
+ *
+ * The program takes a flow of IP packets as input (in the PCAP format) and
+ * measures the memory used by the ROHC compressor and decompressor that
+ * handle them.
+ *
+ * Details
+ * -------
+ *
+ * The program plugs its own allocator in the library with
+ * rohc_set_allocator(): every block allocated or freed by the library is
+ * accounted either to the compressor or to the decompressor, depending on the
+ * one that is running. The memory used by the program itself (the capture
+ * loaded in memory for example) is not accounted.
+ *
+ * The compressor and the decompressor are created, then every packet of the
+ * capture is compressed, and the ROHC packet decompressed right away. The
+ * first half of the capture is the warm-up: the contexts are created and
+ * reach their steady state. The allocations during the second half of the
+ * capture are the ones that happen in the steady state.
+ *
+ * The flows of packets for one given profile may be generated with the
+ * rohc_gen_stream tool, see the rohc_test_memory.sh script.
+ *
+ * Output
+ * ------
+ *
+ * The program outputs one 'MEMORY' line for the compressor and one for the
+ * decompressor with the following tab-separated fields, the first line names
+ * them:
+ *  - keyword 'MEMORY'
+ *  - side ('comp' or 'decomp')
+ *  - number of contexts used at the end of the capture
+ *  - bytes used by the instance once created (contexts not used yet)
+ *  - number of allocations to create the instance
+ *  - average bytes used per context
+ *  - average number of allocations per context
+ *  - peak bytes used during the capture
+ *  - bytes used at the end of the capture (steady state)
+ *  - number of allocations during the steady state
+ *  - bytes not freed once the instance is destroyed
+ *
+ * The bytes are the sizes requested by the library, so they include neither
+ * the rounding nor the bookkeeping of the system allocator.
+ */
+
+#include "config.h" /* for HAVE_*_H and PACKAGE_BUGREPORT */
+
+/* system includes */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+#if HAVE_WINSOCK2_H == 1
+#  include <winsock2.h> /* for ntohs() on Windows */
+#endif
+#if HAVE_ARPA_INET_H == 1
+#  include <arpa/inet.h> /* for ntohs() on Linux */
+#endif
+
+/* include for the PCAP library */
+#if HAVE_PCAP_PCAP_H == 1
+#  include <pcap/pcap.h>
+#elif HAVE_PCAP_H == 1
+#  include <pcap.h>
+#else
+#  error "pcap.h header not found, did you specified --enable-rohc-tests \
+for ./configure ? If yes, check configure output and config.log"
+#endif
+
+/* includes for network headers */
+#include <protocols/ipv4.h>
+#include <protocols/ipv6.h>
+
+/* ROHC includes */
+#include <rohc/rohc.h>
+#include <rohc/rohc_comp.h>
+#include <rohc/rohc_decomp.h>
+
+
+/** The header in front of every allocated block that records its size,
+ *  large enough to keep the blocks aligned for any type */
+#define MEM_HDR_LEN  16U
+
+/** The maximal size for the ROHC packets */
+#define MAX_ROHC_SIZE  (5 * 1024)
+
+/** The length of the Linux Cooked Sockets header */
+#define LINUX_COOKED_HDR_LEN  16U
+
+/** The length (in bytes) of the Ethernet header */
+#define ETHER_HDR_LEN  14U
+
+/** The minimum Ethernet length (in bytes) */
+#define ETHER_FRAME_MIN_LEN  60U
+
+/** The UDP destination port of the RTP flows generated by rohc_gen_stream */
+#define MEM_RTP_PORT  1234U
+
+
+/** The memory used by the compressor or the decompressor */
+struct mem_counters
+{
+	size_t live_bytes;        /**< The bytes currently allocated */
+	size_t peak_bytes;        /**< The max bytes ever allocated at once */
+	unsigned long allocs_nr;  /**< The number of allocations */
+	unsigned long frees_nr;   /**< The number of deallocations */
+};
+
+
+/** One IP packet of the capture loaded in memory */
+struct mem_packet
+{
+	unsigned char *data;  /**< The IP packet, link layer removed */
+	size_t len;           /**< The length of the IP packet */
+};
+
+
+/** The memory footprint of the compressor or the decompressor */
+struct mem_footprint
+{
+	size_t contexts_nr;          /**< The contexts used at the end */
+	struct mem_counters inst;    /**< Once the instance is created */
+	struct mem_counters warm;    /**< Once the warm-up is over */
+	struct mem_counters end;     /**< At the end of the capture */
+	size_t leaked_bytes;         /**< Not freed with the instance */
+};
+
+
+/* prototypes of private functions */
+static void usage(void);
+static void * mem_malloc(const size_t size, void *const priv_ctxt)
+	__attribute__((warn_unused_result));
+static void mem_free(void *const ptr, void *const priv_ctxt);
+static bool mem_load_capture(const char *const filename,
+                             struct mem_packet **const packets,
+                             size_t *const packets_nr);
+static void mem_free_capture(struct mem_packet *const packets,
+                             const size_t packets_nr);
+static int test_memory(const char *const filename,
+                       const rohc_cid_type_t cid_type,
+                       const size_t wlsb_width,
+                       const size_t max_contexts,
+                       const bool no_steady_allocs);
+static void mem_footprint_print(const char *const side,
+                                const struct mem_footprint *const footprint);
+static int gen_false_random_num(const struct rohc_comp *const comp,
+                                void *const user_context)
+	__attribute__((warn_unused_result));
+static bool rohc_comp_rtp_cb(const unsigned char *const ip,
+                             const unsigned char *const udp,
+                             const unsigned char *const payload,
+                             const unsigned int payload_size,
+                             void *const rtp_private)
+	__attribute__((warn_unused_result));
+
+
+/** The counters the allocations are accounted to, NULL not to account them */
+static struct mem_counters *mem_counters_cur = NULL;
+
+
+/**
+ * @brief Allocate memory for the library and account it
+ *
+ * @param size       The number of bytes to allocate
+ * @param priv_ctxt  Unused, the allocation is accounted to the counters of
+ *                   the compressor or decompressor that is running
+ * @return           The allocated memory, NULL in case of failure
+ */
+static void * mem_malloc(const size_t size,
+                         void *const priv_ctxt __attribute__((unused)))
+{
+	unsigned char *const block = malloc(MEM_HDR_LEN + size);
+
+	if(block == NULL)
+	{
+		return NULL;
+	}
+	memcpy(block, &size, sizeof(size_t));
+
+	if(mem_counters_cur != NULL)
+	{
+		mem_counters_cur->live_bytes += size;
+		if(mem_counters_cur->live_bytes > mem_counters_cur->peak_bytes)
+		{
+			mem_counters_cur->peak_bytes = mem_counters_cur->live_bytes;
+		}
+		mem_counters_cur->allocs_nr++;
+	}
+
+	return block + MEM_HDR_LEN;
+}
+
+
+/**
+ * @brief Free memory for the library and account it
+ *
+ * @param ptr        The memory to free
+ * @param priv_ctxt  Unused, the deallocation is accounted to the counters of
+ *                   the compressor or decompressor that is running
+ */
+static void mem_free(void *const ptr,
+                     void *const priv_ctxt __attribute__((unused)))
+{
+	unsigned char *const block = ((unsigned char *) ptr) - MEM_HDR_LEN;
+	size_t size;
+
+	memcpy(&size, block, sizeof(size_t));
+
+	if(mem_counters_cur != NULL)
+	{
+		/* do not underflow if a block allocated while no counters were
+		 * active is freed */
+		if(size > mem_counters_cur->live_bytes)
+		{
+			mem_counters_cur->live_bytes = 0;
+		}
+		else
+		{
+			mem_counters_cur->live_bytes -= size;
+		}
+		mem_counters_cur->frees_nr++;
+	}
+
+	free(block);
+}
+
+
+/**
+ * @brief Main function for the ROHC memory footprint program
+ *
+ * @param argc The number of program arguments
+ * @param argv The program arguments
+ * @return     The unix return code:
+ *              \li 0 in case of success,
+ *              \li 1 in case of failure
+ */
+int main(int argc, char *argv[])
+{
+	int max_contexts = ROHC_SMALL_CID_MAX + 1;
+	char *cid_type_name = NULL;
+	int wlsb_width = 4;
+	bool no_steady_allocs = false; /* allocations in steady state are fine */
+	char *filename = NULL; /* the name of the PCAP capture used as input */
+	rohc_cid_type_t cid_type;
+	int status = 1;
+
+	/* parse program arguments, print the help message in case of failure */
+	if(argc <= 1)
+	{
+		usage();
+		goto error;
+	}
+
+	for(argc--, argv++; argc > 0; argc--, argv++)
+	{
+		if(!strcmp(*argv, "-v") || !strcmp(*argv, "--version"))
+		{
+			/* print version */
+			printf("rohc_test_memory version %s\n", rohc_version());
+			goto error;
+		}
+		else if(!strcmp(*argv, "-h") || !strcmp(*argv, "--help"))
+		{
+			/* print help */
+			usage();
+			goto error;
+		}
+		else if(!strcmp(*argv, "--max-contexts"))
+		{
+			/* get the maximum number of contexts the test should use */
+			if(argc <= 1)
+			{
+				fprintf(stderr, "option --max-contexts takes one argument\n\n");
+				usage();
+				goto error;
+			}
+			max_contexts = atoi(argv[1]);
+			argc--;
+			argv++;
+		}
+		else if(!strcmp(*argv, "--wlsb-width"))
+		{
+			/* get the width of the WLSB window the test should use */
+			if(argc <= 1)
+			{
+				fprintf(stderr, "option --wlsb-width takes one argument\n\n");
+				usage();
+				goto error;
+			}
+			wlsb_width = atoi(argv[1]);
+			argc--;
+			argv++;
+		}
+		else if(!strcmp(*argv, "--no-steady-allocs"))
+		{
+			/* fail if the library allocates memory in the steady state */
+			no_steady_allocs = true;
+		}
+		else if(cid_type_name == NULL)
+		{
+			/* get the type of CID to use within the ROHC library */
+			cid_type_name = argv[0];
+		}
+		else if(filename == NULL)
+		{
+			/* get the name of the file that contains the IP packets
+			   to compress */
+			filename = argv[0];
+		}
+		else
+		{
+			/* do not accept more than one filename without option name */
+			usage();
+			goto error;
+		}
+	}
+
+	/* the CID type and source filename are mandatory */
+	if(cid_type_name == NULL || filename == NULL)
+	{
+		usage();
+		goto error;
+	}
+
+	/* check WLSB width */
+	if(wlsb_width <= 0 || (wlsb_width & (wlsb_width - 1)) != 0)
+	{
+		fprintf(stderr, "invalid WLSB width %d: should be a positive power of "
+		        "two\n", wlsb_width);
+		goto error;
+	}
+
+	/* check CID type */
+	if(!strcmp(cid_type_name, "smallcid"))
+	{
+		cid_type = ROHC_SMALL_CID;
+
+		/* the maximum number of ROHC contexts should be valid */
+		if(max_contexts < 1 || (size_t) max_contexts > (ROHC_SMALL_CID_MAX + 1))
+		{
+			fprintf(stderr, "the maximum number of ROHC contexts should be "
+			        "between 1 and %u\n\n", ROHC_SMALL_CID_MAX + 1);
+			usage();
+			goto error;
+		}
+	}
+	else if(!strcmp(cid_type_name, "largecid"))
+	{
+		cid_type = ROHC_LARGE_CID;
+
+		/* the maximum number of ROHC contexts should be valid */
+		if(max_contexts < 1 || (size_t) max_contexts > (ROHC_LARGE_CID_MAX + 1))
+		{
+			fprintf(stderr, "the maximum number of ROHC contexts should be "
+			        "between 1 and %u\n\n", ROHC_LARGE_CID_MAX + 1);
+			usage();
+			goto error;
+		}
+	}
+	else
+	{
+		fprintf(stderr, "invalid CID type '%s', only 'smallcid' and 'largecid' "
+		        "expected\n", cid_type_name);
+		usage();
+		goto error;
+	}
+
+	/* account all the memory of the library */
+	if(!rohc_set_allocator(mem_malloc, mem_free, NULL))
+	{
+		fprintf(stderr, "failed to set the memory allocator of the library\n");
+		goto error;
+	}
+
+	status = test_memory(filename, cid_type, wlsb_width, max_contexts,
+	                     no_steady_allocs);
+	if(status != 0)
+	{
+		fprintf(stderr, "memory test failed, see above error(s)\n");
+	}
+
+error:
+	return status;
+}
+
+
+/**
+ * @brief Print usage of the memory footprint application
+ */
+static void usage(void)
+{
+	printf("The ROHC memory footprint tool measures the memory used by the\n"
+	       "compressor and the decompressor for one flow of packets\n"
+	       "\n"
+	       "The rohc_test_memory tool compresses the IP packets of the flow,\n"
+	       "then decompresses the ROHC packets. The allocations of the library\n"
+	       "are accounted to the compressor or to the decompressor. The first\n"
+	       "half of the flow is the warm-up, the second half is the steady\n"
+	       "state. One 'MEMORY' line is printed for the compressor and one\n"
+	       "for the decompressor with the following tab-separated fields:\n"
+	       "  * keyword 'MEMORY'\n"
+	       "  * side ('comp' or 'decomp')\n"
+	       "  * number of contexts used\n"
+	       "  * bytes used by the instance once created\n"
+	       "  * number of allocations to create the instance\n"
+	       "  * average bytes used per context\n"
+	       "  * average number of allocations per context\n"
+	       "  * peak bytes used\n"
+	       "  * bytes used at the end of the flow (steady state)\n"
+	       "  * number of allocations during the steady state\n"
+	       "  * bytes not freed once the instance is destroyed\n"
+	       "\n"
+	       "Usage: rohc_test_memory [OPTIONS] CID_TYPE FLOW\n"
+	       "\n"
+	       "Options:\n"
+	       "  -v, --version           Print version information and exit\n"
+	       "  -h, --help              Print this usage and exit\n"
+	       "      --max-contexts NUM  The maximum number of ROHC contexts to\n"
+	       "                          simultaneously use during the test\n"
+	       "      --wlsb-width NUM    The width of the WLSB window to use\n"
+	       "      --no-steady-allocs  Fail if the library allocates memory\n"
+	       "                          during the steady state\n"
+	       "\n"
+	       "With:\n"
+	       "  CID_TYPE                The type of CID to use among 'smallcid'\n"
+	       "                          and 'largecid'\n"
+	       "  FLOW                    The flow of Ethernet frames to compress\n"
+	       "                          (in PCAP format)\n"
+	       "\n"
+	       "Examples:\n"
+	       "  rohc_gen_stream --flows 100 --mix 0,0,1,0 --churn 0 uncomp 2000 tcp.pcap\n"
+	       "  rohc_test_memory --max-contexts 100 largecid tcp.pcap\n"
+	       "                          Measure the memory for 100 TCP contexts\n"
+	       "\n"
+	       "Report bugs to <" PACKAGE_BUGREPORT ">.\n");
+}
+
+
+/**
+ * @brief Load all the IP packets of a capture in memory
+ *
+ * The link layer and the Ethernet padding are removed.
+ *
+ * @param filename          The name of the PCAP file
+ * @param[out] packets      The packets, to free with \ref mem_free_capture
+ * @param[out] packets_nr   The number of packets
+ * @return                  true if the capture was loaded, false otherwise
+ */
+static bool mem_load_capture(const char *const filename,
+                             struct mem_packet **const packets,
+                             size_t *const packets_nr)
+{
+	pcap_t *handle;
+	char errbuf[PCAP_ERRBUF_SIZE];
+	int link_layer_type;
+	struct pcap_pkthdr header;
+	unsigned char *packet;
+	size_t packets_max = 0;
+	size_t link_len;
+
+	*packets = NULL;
+	*packets_nr = 0;
+
+	/* open the PCAP file that contains the stream */
+	handle = pcap_open_offline(filename, errbuf);
+	if(handle == NULL)
+	{
+		fprintf(stderr, "failed to open the pcap file: %s\n", errbuf);
+		goto error;
+	}
+
+	/* link layer in the capture must be Ethernet */
+	link_layer_type = pcap_datalink(handle);
+	if(link_layer_type == DLT_EN10MB)
+	{
+		link_len = ETHER_HDR_LEN;
+	}
+	else if(link_layer_type == DLT_LINUX_SLL)
+	{
+		link_len = LINUX_COOKED_HDR_LEN;
+	}
+	else if(link_layer_type == DLT_RAW)
+	{
+		link_len = 0;
+	}
+	else
+	{
+		fprintf(stderr, "link layer type %d not supported in capture "
+		        "(supported = %d, %d, %d)\n", link_layer_type,
+		        DLT_EN10MB, DLT_LINUX_SLL, DLT_RAW);
+		goto close_input;
+	}
+
+	while((packet = (unsigned char *) pcap_next(handle, &header)) != NULL)
+	{
+		struct mem_packet *new_packet;
+		size_t ip_len;
+
+		if(header.len <= link_len || header.len != header.caplen)
+		{
+			fprintf(stderr, "packet %zu: bad PCAP packet (len = %u, "
+			        "caplen = %u)\n", (*packets_nr) + 1, header.len,
+			        header.caplen);
+			goto free_packets;
+		}
+		ip_len = header.caplen - link_len;
+
+		/* remove the padding after the IP packet in the Ethernet payload */
+		if(link_len == ETHER_HDR_LEN && header.len == ETHER_FRAME_MIN_LEN)
+		{
+			const unsigned char *const ip = packet + link_len;
+			size_t tot_len = ip_len;
+
+			if(((ip[0] >> 4) & 0x0f) == 4 && ip_len >= sizeof(struct ipv4_hdr))
+			{
+				tot_len = ntohs(((const struct ipv4_hdr *) ip)->tot_len);
+			}
+			else if(((ip[0] >> 4) & 0x0f) == 6 && ip_len >= sizeof(struct ipv6_hdr))
+			{
+				tot_len = sizeof(struct ipv6_hdr) +
+				          ntohs(((const struct ipv6_hdr *) ip)->plen);
+			}
+			if(tot_len < ip_len)
+			{
+				ip_len = tot_len;
+			}
+		}
+
+		/* grow the array of packets by powers of two */
+		if((*packets_nr) == packets_max)
+		{
+			const size_t new_max = (packets_max > 0 ? packets_max * 2 : 1024);
+			struct mem_packet *const new_packets =
+				realloc(*packets, new_max * sizeof(struct mem_packet));
+			if(new_packets == NULL)
+			{
+				fprintf(stderr, "failed to allocate memory for %zu packets\n",
+				        new_max);
+				goto free_packets;
+			}
+			*packets = new_packets;
+			packets_max = new_max;
+		}
+
+		new_packet = &((*packets)[*packets_nr]);
+		new_packet->data = malloc(ip_len);
+		if(new_packet->data == NULL)
+		{
+			fprintf(stderr, "packet %zu: failed to allocate memory for %zu "
+			        "bytes\n", (*packets_nr) + 1, ip_len);
+			goto free_packets;
+		}
+		memcpy(new_packet->data, packet + link_len, ip_len);
+		new_packet->len = ip_len;
+		(*packets_nr)++;
+	}
+
+	pcap_close(handle);
+	return true;
+
+free_packets:
+	mem_free_capture(*packets, *packets_nr);
+	*packets = NULL;
+	*packets_nr = 0;
+close_input:
+	pcap_close(handle);
+error:
+	return false;
+}
+
+
+/**
+ * @brief Free the packets of the capture loaded in memory
+ *
+ * @param packets     The packets
+ * @param packets_nr  The number of packets
+ */
+static void mem_free_capture(struct mem_packet *const packets,
+                             const size_t packets_nr)
+{
+	size_t i;
+
+	for(i = 0; i < packets_nr; i++)
+	{
+		free(packets[i].data);
+	}
+	free(packets);
+}
+
+
+/**
+ * @brief Measure the memory used by the compressor and the decompressor
+ *        for one flow of IP packets
+ *
+ * @param filename          The name of the PCAP file that contains the IP
+ *                          packets
+ * @param cid_type          The type of CIDs the (de)compressor shall use
+ * @param wlsb_width        The width of the WLSB window to use
+ * @param max_contexts      The maximum number of ROHC contexts to use
+ * @param no_steady_allocs  Whether to fail if the library allocates memory
+ *                          during the steady state
+ * @return                  0 in case of success, 1 otherwise
+ */
+static int test_memory(const char *const filename,
+                       const rohc_cid_type_t cid_type,
+                       const size_t wlsb_width,
+                       const size_t max_contexts,
+                       const bool no_steady_allocs)
+{
+	const struct rohc_ts arrival_time = { .sec = 0, .nsec = 0 };
+	struct mem_counters comp_counters;
+	struct mem_counters decomp_counters;
+	struct mem_footprint comp_footprint;
+	struct mem_footprint decomp_footprint;
+	rohc_comp_general_info_t comp_info;
+	rohc_decomp_general_info_t decomp_info;
+	struct rohc_comp *comp = NULL;
+	struct rohc_decomp *decomp = NULL;
+	struct mem_packet *packets;
+	size_t packets_nr;
+	unsigned long decomp_failures_nr = 0;
+	size_t i;
+	int is_failure = 1;
+
+	assert(max_contexts > 0);
+
+	memset(&comp_counters, 0, sizeof(struct mem_counters));
+	memset(&decomp_counters, 0, sizeof(struct mem_counters));
+	memset(&comp_footprint, 0, sizeof(struct mem_footprint));
+	memset(&decomp_footprint, 0, sizeof(struct mem_footprint));
+
+	/* load the whole capture in memory before any memory is accounted */
+	if(!mem_load_capture(filename, &packets, &packets_nr))
+	{
+		goto error;
+	}
+	if(packets_nr == 0)
+	{
+		fprintf(stderr, "no packet in capture '%s'\n", filename);
+		goto free_capture;
+	}
+
+	/* create the ROHC compressor, enable all the profiles */
+	mem_counters_cur = &comp_counters;
+	comp = rohc_comp_new2(cid_type, max_contexts - 1, gen_false_random_num, NULL);
+	if(comp == NULL)
+	{
+		mem_counters_cur = NULL;
+		fprintf(stderr, "cannot create the ROHC compressor\n");
+		goto free_capture;
+	}
+	if(!rohc_comp_enable_profiles(comp, ROHC_PROFILE_UNCOMPRESSED,
+	                              ROHC_PROFILE_RTP, ROHC_PROFILE_UDP,
+	                              ROHC_PROFILE_IP, ROHC_PROFILE_UDPLITE,
+	                              ROHC_PROFILE_ESP, ROHC_PROFILE_TCP, -1) ||
+	   !rohc_comp_set_wlsb_window_width(comp, wlsb_width) ||
+	   !rohc_comp_set_rtp_detection_cb(comp, rohc_comp_rtp_cb, NULL))
+	{
+		mem_counters_cur = NULL;
+		fprintf(stderr, "failed to configure the ROHC compressor\n");
+		goto free_compressor;
+	}
+	comp_footprint.inst = comp_counters;
+
+	/* create the ROHC decompressor, enable all the profiles */
+	mem_counters_cur = &decomp_counters;
+	decomp = rohc_decomp_new2(cid_type, max_contexts - 1, ROHC_U_MODE);
+	if(decomp == NULL)
+	{
+		mem_counters_cur = NULL;
+		fprintf(stderr, "cannot create the ROHC decompressor\n");
+		goto free_compressor;
+	}
+	if(!rohc_decomp_enable_profiles(decomp, ROHC_PROFILE_UNCOMPRESSED,
+	                                ROHC_PROFILE_RTP, ROHC_PROFILE_UDP,
+	                                ROHC_PROFILE_IP, ROHC_PROFILE_UDPLITE,
+	                                ROHC_PROFILE_ESP, ROHC_PROFILE_TCP, -1))
+	{
+		mem_counters_cur = NULL;
+		fprintf(stderr, "failed to enable the decompression profiles\n");
+		goto free_decompressor;
+	}
+	decomp_footprint.inst = decomp_counters;
+	mem_counters_cur = NULL;
+
+	/* compress every packet, then decompress it right away */
+	for(i = 0; i < packets_nr; i++)
+	{
+		struct rohc_buf ip_packet =
+			rohc_buf_init_full(packets[i].data, packets[i].len, arrival_time);
+		uint8_t rohc_buffer[MAX_ROHC_SIZE];
+		struct rohc_buf rohc_packet =
+			rohc_buf_init_empty(rohc_buffer, MAX_ROHC_SIZE);
+		uint8_t decomp_buffer[MAX_ROHC_SIZE];
+		struct rohc_buf decomp_packet =
+			rohc_buf_init_empty(decomp_buffer, MAX_ROHC_SIZE);
+		rohc_status_t status;
+
+		/* the warm-up is over at the middle of the capture */
+		if(i == (packets_nr / 2))
+		{
+			comp_footprint.warm = comp_counters;
+			decomp_footprint.warm = decomp_counters;
+		}
+
+		mem_counters_cur = &comp_counters;
+		status = rohc_compress4(comp, ip_packet, &rohc_packet);
+		mem_counters_cur = NULL;
+		if(status != ROHC_STATUS_OK)
+		{
+			fprintf(stderr, "packet %zu: compression failed\n", i + 1);
+			goto free_decompressor;
+		}
+
+		mem_counters_cur = &decomp_counters;
+		status = rohc_decompress3(decomp, rohc_packet, &decomp_packet, NULL, NULL);
+		mem_counters_cur = NULL;
+		if(status != ROHC_STATUS_OK)
+		{
+			/* the decompressor keeps its memory, so go on with the capture */
+			decomp_failures_nr++;
+		}
+	}
+	if(decomp_failures_nr > 0)
+	{
+		fprintf(stderr, "%lu packets failed to be decompressed\n",
+		        decomp_failures_nr);
+	}
+	comp_footprint.end = comp_counters;
+	decomp_footprint.end = decomp_counters;
+
+	/* the number of contexts used by the compressor and the decompressor */
+	memset(&comp_info, 0, sizeof(rohc_comp_general_info_t));
+	comp_info.version_major = 0;
+	comp_info.version_minor = 0;
+	memset(&decomp_info, 0, sizeof(rohc_decomp_general_info_t));
+	decomp_info.version_major = 0;
+	decomp_info.version_minor = 0;
+	if(!rohc_comp_get_general_info(comp, &comp_info) ||
+	   !rohc_decomp_get_general_info(decomp, &decomp_info))
+	{
+		fprintf(stderr, "failed to get the number of contexts\n");
+		goto free_decompressor;
+	}
+	comp_footprint.contexts_nr = comp_info.contexts_nr;
+	decomp_footprint.contexts_nr = decomp_info.contexts_nr;
+
+	/* the memory not freed with the instances */
+	mem_counters_cur = &decomp_counters;
+	rohc_decomp_free(decomp);
+	decomp = NULL;
+	decomp_footprint.leaked_bytes = decomp_counters.live_bytes;
+	mem_counters_cur = &comp_counters;
+	rohc_comp_free(comp);
+	comp = NULL;
+	comp_footprint.leaked_bytes = comp_counters.live_bytes;
+	mem_counters_cur = NULL;
+
+	printf("MEMORY\tside\tcontexts\tinstance bytes\tinstance allocations\t"
+	       "bytes per context\tallocations per context\tpeak bytes\t"
+	       "steady bytes\tsteady allocations\tleaked bytes\n");
+	mem_footprint_print("comp", &comp_footprint);
+	mem_footprint_print("decomp", &decomp_footprint);
+
+	if(no_steady_allocs &&
+	   (comp_footprint.end.allocs_nr != comp_footprint.warm.allocs_nr ||
+	    decomp_footprint.end.allocs_nr != decomp_footprint.warm.allocs_nr))
+	{
+		fprintf(stderr, "the library allocated memory during the steady "
+		        "state\n");
+		goto free_decompressor;
+	}
+
+	/* everything went fine */
+	is_failure = 0;
+
+free_decompressor:
+	mem_counters_cur = &decomp_counters;
+	if(decomp != NULL)
+	{
+		rohc_decomp_free(decomp);
+	}
+free_compressor:
+	mem_counters_cur = &comp_counters;
+	if(comp != NULL)
+	{
+		rohc_comp_free(comp);
+	}
+	mem_counters_cur = NULL;
+free_capture:
+	mem_free_capture(packets, packets_nr);
+error:
+	return is_failure;
+}
+
+
+/**
+ * @brief Print the memory footprint of the compressor or the decompressor
+ *
+ * @param side       The side: 'comp' or 'decomp'
+ * @param footprint  The memory footprint to print
+ */
+static void mem_footprint_print(const char *const side,
+                                const struct mem_footprint *const footprint)
+{
+	const size_t ctxts_bytes =
+		footprint->end.live_bytes - footprint->inst.live_bytes;
+	const unsigned long ctxts_allocs =
+		footprint->end.allocs_nr - footprint->inst.allocs_nr;
+	const double contexts_nr =
+		(footprint->contexts_nr > 0 ? footprint->contexts_nr : 1);
+
+	printf("MEMORY\t%s\t%zu\t%zu\t%lu\t%.1f\t%.1f\t%zu\t%zu\t%lu\t%zu\n",
+	       side, footprint->contexts_nr, footprint->inst.live_bytes,
+	       footprint->inst.allocs_nr, ctxts_bytes / contexts_nr,
+	       ctxts_allocs / contexts_nr, footprint->end.peak_bytes,
+	       footprint->end.live_bytes,
+	       footprint->end.allocs_nr - footprint->warm.allocs_nr,
+	       footprint->leaked_bytes);
+}
+
+
+/**
+ * @brief Generate a false random number for testing the ROHC library
+ *
+ * @param comp          The ROHC compressor
+ * @param user_context  Should always be NULL
+ * @return              Always 0
+ */
+static int gen_false_random_num(const struct rohc_comp *const comp,
+                                void *const user_context)
+{
+	assert(comp != NULL);
+	assert(user_context == NULL);
+	return 0;
+}
+
+
+/**
+ * @brief The RTP detection callback
+ *
+ * The RTP flows are the UDP flows towards the port used by rohc_gen_stream.
+ *
+ * @param ip           The innermost IP packet
+ * @param udp          The UDP header of the packet
+ * @param payload      The UDP payload of the packet
+ * @param payload_size The size of the UDP payload (in bytes)
+ * @param rtp_private  An optional private context, may be NULL
+ * @return             true if the packet is an RTP packet, false otherwise
+ */
+static bool rohc_comp_rtp_cb(const unsigned char *const ip __attribute__((unused)),
+                             const unsigned char *const udp,
+                             const unsigned char *const payload __attribute__((unused)),
+                             const unsigned int payload_size __attribute__((unused)),
+                             void *const rtp_private __attribute__((unused)))
+{
+	uint16_t udp_dport;
+
+	if(udp == NULL)
+	{
+		return false;
+	}
+
+	/* get the UDP destination port */
+	memcpy(&udp_dport, udp + 2, sizeof(uint16_t));
+
+	return (ntohs(udp_dport) == MEM_RTP_PORT);
+}
+
@@ -54,13 +54,141 @@
  * ------
  *
  * The program outputs the time elapsed for (de)compression all packets, the
- * number of (de)compressed packets and the average elapsed time per packet.
+ * number of (de)compressed packets and the throughput.
+ *
+ * The whole capture is loaded in one contiguous buffer before the timer
+ * starts, so that neither libpcap nor the file I/O are measured. With the
+ * --repeat option, the packets are (de)compressed several times in a row
+ * with the same (de)compressor to measure longer runs.
+ *
+ * Scaling
+ * -------
+ *
+ * With the --threads option, the program shards the flows of packets across several threads and runs them at the
+ * same time. Every thread is pinned to one CPU core and uses its own
+ * (de)compressor. The flows are identified by their IP addresses and ports
+ * for compression, and by their CID for decompression. The program first
+ * runs the test with one single thread as reference, then with all the
+ * threads. It outputs the throughput of every thread, the aggregate
+ * throughput and the scaling efficiency, ie. the aggregate throughput
+ * divided by the number of threads times the throughput of the reference.
+ *
+ * Latency
+ * -------
+ *
+ * With the --latency option, the program records the duration of every call
+ * to rohc_compress4() or rohc_decompress3() in one histogram with a relative
+ * precision of about 3 %. The histograms are split by class of packets (IR
+ * or CO) and by packet type. The program outputs the 50th, 99th and 99.9th
+ * percentiles and the maximum of every histogram as text, JSON or CSV.
+ *
+ * Hardware counters
+ * -----------------
+ *
+ * With the --perf-counters option, the program counts the CPU cycles, the
+ * instructions, the cache misses, the branch misses and the dTLB misses
+ * with the perf_event interface of Linux around the (de)compression loop.
+ * Only the user-space events of the (de)compression threads are counted.
+ * The program outputs the counters, the instructions per cycle (IPC) and
+ * the number of events per packet.
+ *
+ * Breakdown
+ * ---------
+ *
+ * With the --breakdown option, the program reports where the
+ * (de)compression time is spent. It requires a library built with the
+ * --enable-rohc-timings configure option: the library then measures the
+ * duration of every phase of the (de)compression of every packet with the
+ * fastest clock available (the TSC on x86, nanoseconds otherwise), and
+ * sums the durations per profile. The phases are the parsing of the packet,
+ * the context lookup, the encoding or decoding of the header, the CRC, the
+ * copy of the payload and the handling of feedback. For every profile that
+ * handled packets, the program outputs one table with the total duration of
+ * every phase (in ticks), its share of the total, its average duration per
+ * packet and a bar proportional to the share.
+ *
+ * NUMA placement
+ * --------------
+ *
+ * With the --numa-node option, all the memory of the (de)compressors is
+ * allocated on the given NUMA node, whatever the node of the CPU cores that
+ * run them. Run the program bound to the CPU cores of one node, for example
+ * with numactl --cpunodebind, then compare the throughput with the memory
+ * on the same node and on a remote node.
+ *
+ * Round trip
+ * ----------
+ *
+ * With the 'roundtrip' action, the program measures the latency that ROHC
+ * adds end to end: every packet of the capture is compressed, the ROHC
+ * packet is decompressed right away, and the feedback built by the
+ * decompressor is delivered back to the compressor. The test is run in 3
+ * configurations with a new compressor and decompressor every time:
+ *  - U: the decompressor targets the U-mode, there is no feedback channel,
+ *  - O: the decompressor targets the O-mode and rate-limits its feedback,
+ *  - R: the library does not implement the R-mode, so the R-like
+ *    configuration is the O-mode without rate limits: the decompressor
+ *    acknowledges every packet it may acknowledge and sends a NACK after
+ *    the first CRC failure.
+ *
+ * With the --loss option, a given rate of the ROHC packets is dropped
+ * between the compressor and the decompressor. The same packets are lost
+ * in every configuration. The feedback channel does not lose packets.
+ *
+ * For every configuration, the program outputs one line starting with the
+ * ROUNDTRIP keyword followed by tab-separated fields, the first line naming
+ * the fields: the configuration, the number of packets, of lost packets,
+ * of decompression failures, of feedbacks and of feedback bytes, and the
+ * mean latency of the round trips (in ns). It then outputs the percentiles
+ * of the latencies of the packets that were decompressed as for --latency
+ * (as text by default). The test fails if one packet fails to be compressed
+ * or if one packet fails to be decompressed while no packet is lost.
+ *
+ * Soak test
+ * ---------
+ *
+ * With the 'soak' action, the program compresses packets and decompresses
+ * the resulting ROHC packets for a given duration (see --duration) to reveal
+ * the problems that only show after hours: counters that overflow, memory
+ * that grows or fragments, and contexts that are recycled at a full CID
+ * space. The packets are either the ones of a capture, for example produced
+ * by rohc_gen_stream, or synthetic IPv4/UDP flows:
+ *  - the capture is processed again and again, the source addresses of its
+ *    packets being changed at every pass so that new flows keep coming,
+ *  - there are as many synthetic flows at a time as contexts (see
+ *    --max-contexts), and every flow is replaced by a new one after a given
+ *    number of packets (see --flow-packets).
+ *
+ * Every few seconds (see --sample), the program outputs one line starting
+ * with the SOAK keyword followed by tab-separated fields, the first line
+ * naming the fields:
+ *  - the elapsed time (in seconds), or 'all' for the last line that sums up
+ *    the whole test,
+ *  - the number of packets compressed then decompressed since the start,
+ *  - the throughput since the previous sample (in packets per second),
+ *  - the resident memory of the program (in KB, 0 if unknown),
+ *  - the number of contexts of the compressor and of the decompressor,
+ *  - the rates of contexts created and recycled by the compressor, and
+ *    destroyed by the decompressor since the previous sample (per second),
+ *  - the number of compression and decompression failures since the start.
+ *
+ * The test fails if one packet fails to be (de)compressed, or if the
+ * packet counters of the library do not match the ones of the program.
  */
 
+#define _GNU_SOURCE /* for pthread_setaffinity_np() */
 #include "config.h" /* for HAVE_*_H */
 
 /* system includes */
 #include <unistd.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <sched.h>
+#if HAVE_LINUX_PERF_EVENT_H == 1
+#  include <linux/perf_event.h>
+#  include <sys/syscall.h>
+#  include <sys/ioctl.h>
+#endif
 #if HAVE_WINSOCK2_H == 1
 #  include <winsock2.h> /* for ntohs() on Windows */
 #endif
@@ -71,6 +199,7 @@
 #include <errno.h>
 #include <stdarg.h>
 #include <stdint.h>
+#include <inttypes.h>
 #include <string.h>
 #include <assert.h>
 
@@ -85,8 +214,11 @@ for ./configure ? If yes, check configure output and config.log"
 #endif
 
 /* includes for network headers */
+#include <protocols/ip_numbers.h>
 #include <protocols/ipv4.h>
 #include <protocols/ipv6.h>
+#include <protocols/udp.h>
+#include <ip.h> /* for IPv4 checksum */
 
 /* ROHC includes */
 #include <rohc/rohc.h>
@@ -109,6 +241,217 @@ for ./configure ? If yes, check configure output and config.log"
 /** The minimum Ethernet length (in bytes) */
 #define ETHER_FRAME_MIN_LEN  60U
 
+/** The maximum number of threads for the scaling test */
+#define PERF_THREADS_MAX  256U
+
+/** The default duration of the soak test (in seconds) */
+#define PERF_SOAK_DURATION_DEFAULT  60
+
+/** The default period between two samples of the soak test (in seconds) */
+#define PERF_SOAK_SAMPLE_DEFAULT  10
+
+/** The default number of packets of one synthetic flow of the soak test */
+#define PERF_SOAK_FLOW_PACKETS_DEFAULT  100
+
+/** The number of packets of the soak test between two reads of the clock */
+#define PERF_SOAK_CLOCK_PACKETS  256U
+
+/** The length of the UDP payload of the synthetic flows of the soak test */
+#define PERF_SOAK_PAYLOAD_LEN  100U
+
+/** The width of the bars of the breakdown of the (de)compression phases */
+#define PERF_BREAKDOWN_BAR_WIDTH  40U
+
+/** The seed of the simulated losses of the round-trip test, the same for
+ *  every mode so that the same packets are lost */
+#define PERF_ROUNDTRIP_LOSS_SEED  0x2545f491U
+
+/** The number of bits of sub-buckets per power of two in latency histograms */
+#define PERF_LATENCY_SUB_BITS  5U
+
+/** The number of sub-buckets per power of two in latency histograms */
+#define PERF_LATENCY_SUBS_NR  (1U << PERF_LATENCY_SUB_BITS)
+
+/** The number of powers of two covered by latency histograms (in ns) */
+#define PERF_LATENCY_POWERS_NR  40U
+
+/** The number of buckets in latency histograms */
+#define PERF_LATENCY_BUCKETS_NR \
+	((PERF_LATENCY_POWERS_NR - PERF_LATENCY_SUB_BITS + 1) * PERF_LATENCY_SUBS_NR)
+
+
+/** The output formats of latencies */
+typedef enum
+{
+	PERF_LATENCY_NONE = 0, /**< Do not record latencies */
+	PERF_LATENCY_TEXT,     /**< Output latencies as human-readable text */
+	PERF_LATENCY_JSON,     /**< Output latencies as JSON */
+	PERF_LATENCY_CSV,      /**< Output latencies as CSV */
+} perf_latency_format_t;
+
+
+/** The configurations of the round-trip test */
+typedef enum
+{
+	PERF_ROUNDTRIP_U = 0,  /**< U-mode, no feedback channel */
+	PERF_ROUNDTRIP_O,      /**< O-mode, rate-limited feedback */
+	PERF_ROUNDTRIP_R,      /**< O-mode with feedback for every packet */
+	PERF_ROUNDTRIP_MAX,    /**< The number of configurations */
+} perf_roundtrip_mode_t;
+
+
+/**
+ * @brief One histogram of latencies
+ *
+ * The values lower than \ref PERF_LATENCY_SUBS_NR have one bucket each. Every
+ * following power of two is split in \ref PERF_LATENCY_SUBS_NR buckets of
+ * equal width.
+ */
+struct perf_latency_histo
+{
+	uint64_t count;                                /**< The number of values */
+	uint64_t max;                                  /**< The largest value */
+	uint64_t buckets[PERF_LATENCY_BUCKETS_NR];     /**< The buckets */
+};
+
+
+/** The hardware performance counters */
+typedef enum
+{
+	PERF_COUNTER_CYCLES = 0,     /**< The CPU cycles */
+	PERF_COUNTER_INSTRUCTIONS,   /**< The instructions */
+	PERF_COUNTER_CACHE_MISSES,   /**< The last-level cache misses */
+	PERF_COUNTER_BRANCH_MISSES,  /**< The mispredicted branches */
+	PERF_COUNTER_DTLB_MISSES,    /**< The data TLB read misses */
+	PERF_COUNTER_MAX,            /**< The number of counters */
+} perf_counter_t;
+
+
+/** The values of the hardware performance counters */
+struct perf_counters
+{
+	int fds[PERF_COUNTER_MAX];            /**< The perf_event descriptors,
+	                                           -1 if not opened */
+	bool is_supported[PERF_COUNTER_MAX];  /**< Whether the counters were opened */
+	uint64_t values[PERF_COUNTER_MAX];    /**< The values of the counters */
+};
+
+
+/** The latencies of the (de)compression calls */
+struct perf_latency
+{
+	struct perf_latency_histo all;                 /**< All the packets */
+	struct perf_latency_histo ir;                  /**< The IR and IR-DYN packets */
+	struct perf_latency_histo co;                  /**< The other packets */
+	struct perf_latency_histo types[ROHC_PACKET_MAX]; /**< Per packet type */
+};
+
+
+/** One packet of the capture loaded in memory */
+struct perf_packet
+{
+	unsigned long num;           /**< The number of the packet in the capture */
+	struct pcap_pkthdr header;   /**< The PCAP header of the packet */
+	unsigned char *data;         /**< The packet (link layer included), in the
+	                                  buffer of all the packets */
+	uint32_t flow_hash;          /**< The hash of the flow of the packet */
+};
+
+
+/** The parameters of one scaling test */
+struct perf_test
+{
+	bool is_comp;                   /**< Compression or decompression test */
+	bool is_verbose;                /**< Whether traces are printed or not */
+	rohc_cid_type_t cid_type;       /**< The type of CIDs to use */
+	size_t wlsb_width;              /**< The width of the WLSB window */
+	size_t max_contexts;            /**< The maximum number of contexts */
+	perf_latency_format_t latency_format; /**< How to output latencies */
+	bool with_counters;             /**< Whether to read hardware counters */
+	size_t repeat_nr;               /**< The times the packets are processed */
+	int numa_node;                  /**< The NUMA node of the memory of the
+	                                     (de)compressors */
+
+	struct perf_packet *packets;    /**< The packets of the capture */
+	size_t packets_nr;              /**< The number of packets */
+	unsigned char *packets_data;    /**< The contiguous buffer of packets */
+	size_t link_len;                /**< The length of the link layer header */
+};
+
+
+/** The gate that starts all the threads of the scaling test at once */
+struct perf_start
+{
+	pthread_mutex_t lock;           /**< The lock that protects the gate */
+	pthread_cond_t cond;            /**< Signal the changes of the gate */
+	size_t ready_nr;                /**< The number of threads ready */
+	bool is_open;                   /**< Whether the threads may start */
+	bool is_aborted;                /**< Whether the threads shall stop */
+};
+
+
+/** The flows processed by one thread of the scaling test */
+struct perf_thread
+{
+	const struct perf_test *test;   /**< The parameters of the test */
+	struct perf_start *start_gate;  /**< Start all threads at the same time */
+	pthread_t thread;               /**< The thread itself */
+	size_t id;                      /**< The ID of the thread */
+	int cpu;                        /**< The CPU core the thread is pinned to,
+	                                     -1 if not pinned */
+
+	const struct perf_packet **packets; /**< The packets of the thread */
+	size_t packets_nr;                  /**< The number of packets */
+
+	struct timespec start;          /**< The time the thread started */
+	struct timespec end;            /**< The time the thread stopped */
+	struct perf_latency *latency;   /**< The latencies, NULL if not recorded */
+	struct perf_counters counters;  /**< The hardware counters */
+	int status;                     /**< 0 in case of success, 1 otherwise */
+};
+
+
+/** One synthetic flow of the soak test */
+struct perf_soak_flow
+{
+	uint32_t id;                    /**< The unique ID of the flow */
+	size_t packets_nr;              /**< The number of packets sent so far */
+};
+
+
+/** The counters of the soak test at one sample */
+struct perf_soak_sample
+{
+	uint64_t time;                  /**< The time of the sample (in ns) */
+	uint64_t packets_nr;            /**< The number of packets */
+	uint64_t comp_created_nr;       /**< The contexts created by compressor */
+	uint64_t comp_recycled_nr;      /**< The contexts recycled by compressor */
+	uint64_t decomp_destroyed_nr;   /**< The contexts destroyed by
+	                                     decompressor */
+};
+
+
+/** The state of the soak test */
+struct perf_soak
+{
+	bool is_synthetic;              /**< Synthetic flows or capture */
+	struct perf_test capture;       /**< The capture, if not synthetic */
+	size_t capture_pos;             /**< The next packet of the capture */
+	uint32_t capture_pass;          /**< The number of complete passes */
+
+	struct perf_soak_flow *flows;   /**< The synthetic flows */
+	size_t flows_nr;                /**< The number of synthetic flows */
+	size_t flow_packets;            /**< The packets of one synthetic flow */
+	size_t next_flow;               /**< The flow of the next packet */
+	uint32_t next_flow_id;          /**< The ID of the next new flow */
+
+	uint64_t packets_nr;            /**< The packets (de)compressed so far */
+	uint64_t comp_failures_nr;      /**< The compression failures */
+	uint64_t decomp_failures_nr;    /**< The decompression failures */
+	uint64_t decomp_destroyed_nr;   /**< The contexts destroyed by the
+	                                     decompressor */
+};
+
 
 static void usage(void);
 
@@ -117,24 +460,190 @@ static int test_compression_perfs(const bool is_verbose,
                                   const rohc_cid_type_t cid_type,
                                   const size_t wlsb_width,
                                   const size_t max_contexts,
+                                  const size_t repeat_nr,
+                                  const perf_latency_format_t latency_format,
+                                  const bool with_counters,
+                                  const bool with_breakdown,
+                                  const int numa_node,
                                   unsigned long *packet_count);
 static int time_compress_packet(struct rohc_comp *comp,
                                 unsigned long num_packet,
                                 struct pcap_pkthdr header,
                                 unsigned char *packet,
-                                size_t link_len);
+                                size_t link_len,
+                                struct perf_latency *const latency);
 
 static int test_decompression_perfs(const bool is_verbose,
                                     char *filename,
                                     const rohc_cid_type_t cid_type,
                                     const size_t max_contexts,
+                                    const size_t repeat_nr,
+                                    const perf_latency_format_t latency_format,
+                                    const bool with_counters,
+                                    const bool with_breakdown,
+                                    const int numa_node,
                                     unsigned long *packet_count);
 static int time_decompress_packet(struct rohc_decomp *decomp,
                                   unsigned long num_packet,
                                   struct pcap_pkthdr header,
                                   unsigned char *packet,
                                   size_t link_len,
-                                  const struct rohc_ts arrival_time);
+                                  const struct rohc_ts arrival_time,
+                                  struct perf_latency *const latency);
+
+static int test_perfs_threads(const bool is_comp,
+                              const bool is_verbose,
+                              char *filename,
+                              const rohc_cid_type_t cid_type,
+                              const size_t wlsb_width,
+                              const size_t max_contexts,
+                              const size_t threads_nr,
+                              const size_t repeat_nr,
+                              const perf_latency_format_t latency_format,
+                              const bool with_counters,
+                              const int numa_node,
+                              unsigned long *packet_count);
+
+static int test_roundtrip(const bool is_verbose,
+                          char *filename,
+                          const rohc_cid_type_t cid_type,
+                          const size_t wlsb_width,
+                          const size_t max_contexts,
+                          const double loss_rate,
+                          const perf_latency_format_t latency_format,
+                          unsigned long *packet_count);
+static bool perf_roundtrip_run(const bool is_verbose,
+                               const struct perf_test *const test,
+                               const size_t wlsb_width,
+                               const size_t max_contexts,
+                               const perf_roundtrip_mode_t mode,
+                               const double loss_rate,
+                               const perf_latency_format_t latency_format,
+                               unsigned long *const packet_count)
+	__attribute__((warn_unused_result, nonnull(2, 8)));
+static size_t perf_capture_ip_len(const struct perf_packet *const packet,
+                                  const size_t link_len)
+	__attribute__((warn_unused_result, nonnull(1)));
+static bool perf_is_lost(uint32_t *const state, const double loss_rate)
+	__attribute__((warn_unused_result, nonnull(1)));
+
+static int test_soak(const bool is_verbose,
+                     char *filename,
+                     const rohc_cid_type_t cid_type,
+                     const size_t wlsb_width,
+                     const size_t max_contexts,
+                     const uint64_t duration,
+                     const uint64_t sample_period,
+                     const size_t flow_packets,
+                     unsigned long *packet_count);
+static size_t perf_soak_next_packet(struct perf_soak *const soak,
+                                    uint8_t *const buf,
+                                    const size_t buf_max)
+	__attribute__((warn_unused_result, nonnull(1, 2)));
+static size_t perf_soak_synthetic_packet(struct perf_soak *const soak,
+                                         uint8_t *const buf)
+	__attribute__((warn_unused_result, nonnull(1, 2)));
+static size_t perf_soak_capture_packet(struct perf_soak *const soak,
+                                       uint8_t *const buf,
+                                       const size_t buf_max)
+	__attribute__((warn_unused_result, nonnull(1, 2)));
+static bool perf_soak_sample(const struct perf_soak *const soak,
+                             const struct rohc_comp *const comp,
+                             const struct rohc_decomp *const decomp,
+                             const uint64_t start_time,
+                             const struct perf_soak_sample *const prev,
+                             struct perf_soak_sample *const sample,
+                             const bool is_summary)
+	__attribute__((warn_unused_result, nonnull(1, 2, 3, 5, 6)));
+static unsigned long perf_soak_rss_kb(void)
+	__attribute__((warn_unused_result));
+static void perf_soak_decomp_event(void *const priv_ctxt,
+                                   const rohc_decomp_event_info_t *const info)
+	__attribute__((nonnull(1, 2)));
+
+static bool perf_load_capture(struct perf_test *const test,
+                              char *filename)
+	__attribute__((warn_unused_result, nonnull(1, 2)));
+static void perf_free_capture(struct perf_test *const test)
+	__attribute__((nonnull(1)));
+static uint32_t perf_ip_flow_hash(const unsigned char *const data,
+                                  const size_t len)
+	__attribute__((warn_unused_result, nonnull(1)));
+static uint32_t perf_rohc_flow_hash(const unsigned char *const data,
+                                    const size_t len,
+                                    const rohc_cid_type_t cid_type)
+	__attribute__((warn_unused_result, nonnull(1)));
+static bool perf_run_threads(const struct perf_test *const test,
+                             const size_t threads_nr,
+                             const bool print_details,
+                             double *const mpps)
+	__attribute__((warn_unused_result, nonnull(1, 4)));
+static void * perf_thread_run(void *const arg)
+	__attribute__((nonnull(1)));
+static double perf_elapsed(const struct timespec *const start,
+                           const struct timespec *const end)
+	__attribute__((warn_unused_result, nonnull(1, 2)));
+
+static uint64_t perf_now_ns(void)
+	__attribute__((warn_unused_result));
+static void perf_latency_add(struct perf_latency *const latency,
+                             const rohc_packet_t packet_type,
+                             const uint64_t duration)
+	__attribute__((nonnull(1)));
+static void perf_latency_merge(struct perf_latency *const latency,
+                               const struct perf_latency *const other)
+	__attribute__((nonnull(1, 2)));
+static uint64_t perf_latency_percentile(const struct perf_latency_histo *const histo,
+                                        const double percentile)
+	__attribute__((warn_unused_result, nonnull(1)));
+static void perf_latency_print(const struct perf_latency *const latency,
+                               const perf_latency_format_t format,
+                               const char *const action,
+                               const size_t threads_nr)
+	__attribute__((nonnull(1)));
+
+static void perf_counters_init(struct perf_counters *const counters)
+	__attribute__((nonnull(1)));
+static bool perf_counters_open(struct perf_counters *const counters)
+	__attribute__((warn_unused_result, nonnull(1)));
+static void perf_counters_start(const struct perf_counters *const counters)
+	__attribute__((nonnull(1)));
+static void perf_counters_stop(struct perf_counters *const counters)
+	__attribute__((nonnull(1)));
+static void perf_counters_close(struct perf_counters *const counters)
+	__attribute__((nonnull(1)));
+static void perf_counters_merge(struct perf_counters *const counters,
+                                const struct perf_counters *const other)
+	__attribute__((nonnull(1, 2)));
+static void perf_counters_print(const struct perf_counters *const counters,
+                                const bool is_comp,
+                                const size_t threads_nr,
+                                const unsigned long packets_nr)
+	__attribute__((nonnull(1)));
+
+static bool perf_breakdown_print_comp(const struct rohc_comp *const comp)
+	__attribute__((warn_unused_result, nonnull(1)));
+static bool perf_breakdown_print_decomp(const struct rohc_decomp *const decomp)
+	__attribute__((warn_unused_result, nonnull(1)));
+static void perf_breakdown_print(const bool is_comp,
+                                 const rohc_profile_t profile,
+                                 const char *const names[],
+                                 const rohc_timings_histo_t histos[],
+                                 const size_t phases_nr)
+	__attribute__((nonnull(3, 4)));
+
+static struct rohc_comp * create_compressor(const bool *const is_verbose,
+                                            const rohc_cid_type_t cid_type,
+                                            const size_t wlsb_width,
+                                            const size_t max_contexts,
+                                            const int numa_node)
+	__attribute__((warn_unused_result, nonnull(1)));
+static struct rohc_decomp * create_decompressor(const bool *const is_verbose,
+                                                const rohc_cid_type_t cid_type,
+                                                const size_t max_contexts,
+                                                const rohc_mode_t mode,
+                                                const int numa_node)
+	__attribute__((warn_unused_result, nonnull(1)));
 
 static void print_rohc_traces(void *const is_verbose__,
                               const rohc_trace_level_t level,
@@ -170,6 +679,17 @@ int main(int argc, char *argv[])
 	int max_contexts = ROHC_SMALL_CID_MAX + 1;
 	char *cid_type_name = NULL;
 	int wlsb_width = 4;
+	int threads_nr = 0; /* no scaling test by default */
+	int repeat_nr = 1; /* process the capture once by default */
+	perf_latency_format_t latency_format = PERF_LATENCY_NONE;
+	bool with_counters = false; /* no hardware counters by default */
+	bool with_breakdown = false; /* no breakdown of the phases by default */
+	int soak_duration = PERF_SOAK_DURATION_DEFAULT;
+	int soak_sample = PERF_SOAK_SAMPLE_DEFAULT;
+	int soak_flow_packets = PERF_SOAK_FLOW_PACKETS_DEFAULT;
+	double loss_percent = 0.0; /* no loss in the round-trip test by default */
+	int numa_node = ROHC_NUMA_NODE_ANY; /* default memory placement */
+	unsigned long cpu_features = ROHC_CPU_FEATURE_ALL; /* all CPU features */
 	char *test_type = NULL; /* the name of the test to perform */
 	char *filename = NULL; /* the name of the PCAP capture used as input */
 	rohc_cid_type_t cid_type;
@@ -218,6 +738,136 @@ int main(int argc, char *argv[])
 			argv++;
 			argc--;
 		}
+		else if(!strcmp(*argv, "--latency"))
+		{
+			/* record latencies and get the format to output them */
+			if(argc <= 1)
+			{
+				usage();
+				goto error;
+			}
+			if(!strcmp(argv[1], "text"))
+			{
+				latency_format = PERF_LATENCY_TEXT;
+			}
+			else if(!strcmp(argv[1], "json"))
+			{
+				latency_format = PERF_LATENCY_JSON;
+			}
+			else if(!strcmp(argv[1], "csv"))
+			{
+				latency_format = PERF_LATENCY_CSV;
+			}
+			else
+			{
+				fprintf(stderr, "invalid latency format '%s', only 'text', "
+				        "'json' and 'csv' expected\n", argv[1]);
+				goto error;
+			}
+			argv++;
+			argc--;
+		}
+		else if(!strcmp(*argv, "--perf-counters"))
+		{
+			/* read the hardware performance counters */
+			with_counters = true;
+		}
+		else if(!strcmp(*argv, "--breakdown"))
+		{
+			/* report the durations of the phases per profile */
+			with_breakdown = true;
+		}
+		else if(!strcmp(*argv, "--threads"))
+		{
+			/* get the number of threads for the scaling test */
+			threads_nr = atoi(argv[1]);
+			argv++;
+			argc--;
+		}
+		else if(!strcmp(*argv, "--repeat"))
+		{
+			/* get the number of times the capture shall be processed */
+			if(argc <= 1)
+			{
+				usage();
+				goto error;
+			}
+			repeat_nr = atoi(argv[1]);
+			argv++;
+			argc--;
+		}
+		else if(!strcmp(*argv, "--duration"))
+		{
+			/* get the duration of the soak test */
+			if(argc <= 1)
+			{
+				usage();
+				goto error;
+			}
+			soak_duration = atoi(argv[1]);
+			argv++;
+			argc--;
+		}
+		else if(!strcmp(*argv, "--sample"))
+		{
+			/* get the period between two samples of the soak test */
+			if(argc <= 1)
+			{
+				usage();
+				goto error;
+			}
+			soak_sample = atoi(argv[1]);
+			argv++;
+			argc--;
+		}
+		else if(!strcmp(*argv, "--loss"))
+		{
+			/* get the rate of lost packets of the round-trip test */
+			if(argc <= 1)
+			{
+				usage();
+				goto error;
+			}
+			loss_percent = atof(argv[1]);
+			argv++;
+			argc--;
+		}
+		else if(!strcmp(*argv, "--numa-node"))
+		{
+			/* get the NUMA node of the memory of the (de)compressors */
+			if(argc <= 1)
+			{
+				usage();
+				goto error;
+			}
+			numa_node = atoi(argv[1]);
+			argv++;
+			argc--;
+		}
+		else if(!strcmp(*argv, "--cpu-features"))
+		{
+			/* get the mask of the CPU features the library may use */
+			if(argc <= 1)
+			{
+				usage();
+				goto error;
+			}
+			cpu_features = strtoul(argv[1], NULL, 0);
+			argv++;
+			argc--;
+		}
+		else if(!strcmp(*argv, "--flow-packets"))
+		{
+			/* get the number of packets of the synthetic flows */
+			if(argc <= 1)
+			{
+				usage();
+				goto error;
+			}
+			soak_flow_packets = atoi(argv[1]);
+			argv++;
+			argc--;
+		}
 		else if(test_type == 0)
 		{
 			/* get the name of the test */
@@ -257,6 +907,59 @@ int main(int argc, char *argv[])
 		goto error;
 	}
 
+	/* check the number of threads */
+	if(threads_nr < 0 || (size_t) threads_nr > PERF_THREADS_MAX)
+	{
+		fprintf(stderr, "invalid number of threads %d: should be between 1 "
+		        "and %u\n", threads_nr, PERF_THREADS_MAX);
+		goto error;
+	}
+
+	/* check the number of repetitions */
+	if(repeat_nr <= 0)
+	{
+		fprintf(stderr, "invalid number of repetitions %d: should be "
+		        "positive\n", repeat_nr);
+		goto error;
+	}
+
+	/* check the parameters of the soak test */
+	if(soak_duration <= 0 || soak_sample <= 0 || soak_flow_packets <= 0)
+	{
+		fprintf(stderr, "invalid soak test parameters: the duration, the "
+		        "sample period and the packets per flow should be positive\n");
+		goto error;
+	}
+
+	/* check the NUMA node */
+	if(numa_node < ROHC_NUMA_NODE_ANY)
+	{
+		fprintf(stderr, "invalid NUMA node %d: should be positive or %d for "
+		        "the default placement\n", numa_node, ROHC_NUMA_NODE_ANY);
+		goto error;
+	}
+
+	/* check the rate of lost packets of the round-trip test */
+	if(loss_percent < 0 || loss_percent >= 100)
+	{
+		fprintf(stderr, "invalid loss rate %f%%: should be in [0, 100[\n",
+		        loss_percent);
+		goto error;
+	}
+
+	/* restrict the CPU features, and print the variants of the computations
+	 * selected for the CPU so that the results can be reproduced */
+	if(cpu_features > ROHC_CPU_FEATURE_ALL ||
+	   !rohc_cpu_set_features((rohc_cpu_features_t) cpu_features))
+	{
+		fprintf(stderr, "invalid CPU features 0x%lx: should be a mask of the "
+		        "features 0x%x\n", cpu_features, ROHC_CPU_FEATURE_ALL);
+		goto error;
+	}
+	fprintf(stderr, "CPU features: 0x%x (CRC FCS-32: %s)\n",
+	        rohc_cpu_get_features(),
+	        rohc_cpu_get_variant(ROHC_CPU_KERNEL_FCS32));
+
 	/* check CID type */
 	if(!strcmp(cid_type_name, "smallcid"))
 	{
@@ -292,17 +995,76 @@ int main(int argc, char *argv[])
 		goto error;
 	}
 
-	if(strcmp(test_type, "comp") == 0)
+	if(strcmp(test_type, "soak") == 0)
+	{
+		/* the soak test compresses and decompresses in one single thread */
+		if(threads_nr > 0 || repeat_nr != 1 ||
+		   latency_format != PERF_LATENCY_NONE || with_counters ||
+		   with_breakdown || numa_node != ROHC_NUMA_NODE_ANY)
+		{
+			fprintf(stderr, "--threads, --repeat, --latency, --perf-counters, "
+			        "--breakdown and --numa-node are not supported by the soak "
+			        "test\n");
+			goto error;
+		}
+
+		/* run the soak test with synthetic flows or the capture */
+		ret = test_soak(is_verbose,
+		                (strcmp(filename, "synthetic") == 0 ? NULL : filename),
+		                cid_type, wlsb_width, max_contexts,
+		                ((uint64_t) soak_duration) * 1000000000U,
+		                ((uint64_t) soak_sample) * 1000000000U,
+		                soak_flow_packets, &packet_count);
+	}
+	else if(strcmp(test_type, "roundtrip") == 0)
+	{
+		/* the round-trip test runs in one single thread */
+		if(threads_nr > 0 || repeat_nr != 1 || with_counters ||
+		   with_breakdown || numa_node != ROHC_NUMA_NODE_ANY)
+		{
+			fprintf(stderr, "--threads, --repeat, --perf-counters, --breakdown "
+			        "and --numa-node are not supported by the round-trip "
+			        "test\n");
+			goto error;
+		}
+
+		/* run the round-trip test in every configuration */
+		ret = test_roundtrip(is_verbose, filename, cid_type, wlsb_width,
+		                     max_contexts, loss_percent / 100,
+		                     (latency_format == PERF_LATENCY_NONE ?
+		                      PERF_LATENCY_TEXT : latency_format),
+		                     &packet_count);
+	}
+	else if(threads_nr > 0 &&
+	        (strcmp(test_type, "comp") == 0 || strcmp(test_type, "decomp") == 0))
+	{
+		/* test ROHC (de)compression with the flows from the capture sharded
+		 * across several threads */
+		if(with_breakdown)
+		{
+			fprintf(stderr, "--breakdown is not supported with --threads\n");
+			goto error;
+		}
+		ret = test_perfs_threads(strcmp(test_type, "comp") == 0, is_verbose,
+		                         filename, cid_type, wlsb_width, max_contexts,
+		                         threads_nr, repeat_nr, latency_format,
+		                         with_counters, numa_node, &packet_count);
+	}
+	else if(strcmp(test_type, "comp") == 0)
 	{
 		/* test ROHC compression with the packets from the capture */
 		ret = test_compression_perfs(is_verbose, filename, cid_type, wlsb_width,
-		                             max_contexts, &packet_count);
+		                             max_contexts, repeat_nr, latency_format,
+		                             with_counters, with_breakdown, numa_node,
+		                             &packet_count);
 	}
 	else if(strcmp(test_type, "decomp") == 0)
 	{
 		/* test ROHC decompression with the packets from the capture */
 		ret = test_decompression_perfs(is_verbose, filename, cid_type,
-		                               max_contexts, &packet_count);
+		                               max_contexts, repeat_nr, latency_format,
+		                               with_counters, with_breakdown, numa_node,
+		                               &packet_count);
 	}
 	else
 	{
@@ -318,8 +1080,19 @@ int main(int argc, char *argv[])
 	}
 
 	/* print performance statistics */
-	fprintf(stderr, "%scompression: %lu packets\n",
-	        (strcmp(test_type, "comp") == 0 ? "" : "de"), packet_count);
+	if(strcmp(test_type, "soak") == 0)
+	{
+		fprintf(stderr, "soak: %lu packets\n", packet_count);
+	}
+	else if(strcmp(test_type, "roundtrip") == 0)
+	{
+		fprintf(stderr, "roundtrip: %lu packets\n", packet_count);
+	}
+	else
+	{
+		fprintf(stderr, "%scompression: %lu packets\n",
+		        (strcmp(test_type, "comp") == 0 ? "" : "de"), packet_count);
+	}
 
 	/* everything went fine */
 	status = 0;
@@ -342,12 +1115,15 @@ static void usage(void)
 		"\n"
 		"Options:\n"
 		"Mandatory parameters:\n"
-		"  ACTION            Run a compression test with 'comp' or a\n"
-		"                    decompression test with 'decomp'\n"
+		"  ACTION            Run a compression test with 'comp', a\n"
+		"                    decompression test with 'decomp', a\n"
+		"                    long-running test of both with 'soak', or\n"
+		"                    a latency test of both with 'roundtrip'\n"
 		"  CID_TYPE          Run a small CID test with 'smallcid' or a\n"
 		"                    large CID test with 'largecid'\n"
 		"  FLOW              A flow of Ethernet frames to (de)compress\n"
-		"                    (in PCAP format)\n"
+		"                    (in PCAP format), or 'synthetic' for\n"
+		"                    synthetic UDP flows with the soak test\n"
 		"General options:\n"
 		"  -h, --help              Print application usage and exit\n"
 		"  -v, --version           Print version information and exit\n"
@@ -356,12 +1132,50 @@ static void usage(void)
 		"      --wlsb-width NUM    The width of the WLSB window to use\n"
 		"      --max-contexts NUM  The maximum number of ROHC contexts to\n"
 		"                          simultaneously use during the test\n"
+		"      --threads NUM       Shard the flows across NUM threads pinned\n"
+		"                          to CPU cores and report the scaling\n"
+		"                          efficiency\n"
+		"      --repeat NUM        (De)compress the packets of the capture\n"
+		"                          NUM times in a row (default: 1)\n"
+		"      --latency FORMAT    Report the percentiles of the latency of\n"
+		"                          (de)compression calls as 'text', 'json'\n"
+		"                          or 'csv'\n"
+		"      --perf-counters     Report the CPU cycles, instructions, cache\n"
+		"                          misses, branch misses and dTLB misses\n"
+		"                          (Linux only)\n"
+		"      --breakdown         Report the share of every phase of the\n"
+		"                          (de)compression per profile (library built\n"
+		"                          with --enable-rohc-timings only)\n"
+		"      --duration SEC      The duration of the soak test\n"
+		"                          (default: %d)\n"
+		"      --sample SEC        The period between two samples of the\n"
+		"                          soak test (default: %d)\n"
+		"      --flow-packets NUM  The number of packets of every synthetic\n"
+		"                          flow of the soak test (default: %d)\n"
+		"      --loss PERCENT      The rate of ROHC packets lost in the\n"
+		"                          round-trip test (default: 0)\n"
+		"      --numa-node NODE    Allocate the memory of the\n"
+		"                          (de)compressors on the given NUMA node\n"
+		"                          (Linux only)\n"
+		"      --cpu-features MASK Restrict the CPU features the library\n"
+		"                          may use, 0 for the generic computations\n"
+		"                          (default: all)\n"
 		"\n"
 		"Examples:\n"
 		"  rohc_test_performance comp smallcid voip.pcap     test compression performances with small CIDs on the given VoIP stream\n"
 		"  rohc_test_performance decomp largecid a.pcap      test decompression performances with large CIDs on the given stream\n"
+		"  rohc_test_performance --threads 4 comp largecid a.pcap   test how compression scales on 4 CPU cores\n"
+		"  rohc_test_performance --repeat 100 comp smallcid voip.pcap   compress the given VoIP stream 100 times\n"
+		"  rohc_test_performance --latency json comp smallcid voip.pcap   report compression latencies as JSON\n"
+		"  rohc_test_performance --breakdown decomp smallcid voip.rohc.pcap   report where the decompression time is spent per profile\n"
+		"  rohc_test_performance --duration 3600 soak largecid synthetic   run synthetic flows through the library for one hour\n"
+		"  rohc_test_performance --loss 1 roundtrip smallcid voip.pcap   compare the round-trip latencies of the modes with 1%% of losses\n"
+		"  numactl --cpunodebind 0 rohc_test_performance --numa-node 1 comp largecid a.pcap   measure compression with remote memory\n"
+		"  rohc_test_performance --cpu-features 0 decomp smallcid a.rohc.pcap   measure decompression without the special CPU instructions\n"
 		"\n"
-		"Report bugs to <" PACKAGE_BUGREPORT ">.\n");
+		"Report bugs to <" PACKAGE_BUGREPORT ">.\n",
+		PERF_SOAK_DURATION_DEFAULT, PERF_SOAK_SAMPLE_DEFAULT,
+		PERF_SOAK_FLOW_PACKETS_DEFAULT);
 }
 
 
@@ -372,134 +1186,153 @@ static void usage(void)
  * @param is_verbose    Whether the test is run in verbose mode or not
  * @param filename      The name of the PCAP file that contains the IP packets
  * @param cid_type      The type of CIDs the compressor shall use
- * @param wlsb_width    The width of the WLSB window to use
- * @param max_contexts  The maximum number of ROHC contexts to use
- * @param packet_count  OUT: the number of compressed packets, undefined if
- *                      compression failed
- * @return              0 in case of success, 1 otherwise
+ * @param wlsb_width      The width of the WLSB window to use
+ * @param max_contexts    The maximum number of ROHC contexts to use
+ * @param repeat_nr       The number of times the packets are compressed
+ * @param latency_format  How to output latencies, PERF_LATENCY_NONE not to
+ *                        record them
+ * @param with_counters   Whether to read the hardware performance counters
+ * @param with_breakdown  Whether to report the durations of the phases per
+ *                        profile
+ * @param numa_node       The NUMA node of the memory of the compressor,
+ *                        ROHC_NUMA_NODE_ANY for the default placement
+ * @param packet_count    OUT: the number of compressed packets, undefined if
+ *                        compression failed
+ * @return                0 in case of success, 1 otherwise
  */
 static int test_compression_perfs(const bool is_verbose,
                                   char *filename,
                                   const rohc_cid_type_t cid_type,
                                   const size_t wlsb_width,
                                   const size_t max_contexts,
+                                  const size_t repeat_nr,
+                                  const perf_latency_format_t latency_format,
+                                  const bool with_counters,
+                                  const bool with_breakdown,
+                                  const int numa_node,
                                   unsigned long *packet_count)
 {
-	pcap_t *handle;
-	char errbuf[PCAP_ERRBUF_SIZE];
-	int link_layer_type;
-	size_t link_len;
-	struct pcap_pkthdr header;
-	unsigned char *packet;
+	struct perf_latency *latency = NULL;
+	struct perf_counters counters;
+	struct perf_test test;
+	struct timespec start;
+	struct timespec end;
+	double elapsed;
 	struct rohc_comp *comp;
 	int is_failure = 1;
+	size_t round;
+	size_t i;
 	int ret;
 
 	assert(max_contexts > 0);
+	assert(repeat_nr > 0);
 
-	/* open the PCAP file that contains the stream */
-	handle = pcap_open_offline(filename, errbuf);
-	if(handle == NULL)
+	/* load the whole capture in memory, so that reading it is not measured */
+	test.is_comp = true;
+	test.cid_type = cid_type;
+	if(!perf_load_capture(&test, filename))
 	{
-		fprintf(stderr, "failed to open the pcap file: %s\n", errbuf);
 		goto exit;
 	}
 
-	/* link layer in the capture must be Ethernet */
-	link_layer_type = pcap_datalink(handle);
-	if(link_layer_type != DLT_EN10MB &&
-	   link_layer_type != DLT_LINUX_SLL &&
-	   link_layer_type != DLT_RAW)
-	{
-		fprintf(stderr, "link layer type %d not supported in capture "
-		        "(supported = %d, %d, %d)\n", link_layer_type,
-		        DLT_EN10MB, DLT_LINUX_SLL, DLT_RAW);
-		goto close_input;
-	}
-
-	if(link_layer_type == DLT_EN10MB)
-	{
-		link_len = ETHER_HDR_LEN;
-	}
-	else if(link_layer_type == DLT_LINUX_SLL)
-	{
-		link_len = LINUX_COOKED_HDR_LEN;
-	}
-	else /* DLT_RAW */
-	{
-		link_len = 0;
-	}
-
 	/* create ROHC compressor */
-	comp = rohc_comp_new2(cid_type, max_contexts - 1, gen_false_random_num, NULL);
+	comp = create_compressor(&is_verbose, cid_type, wlsb_width, max_contexts,
+	                         numa_node);
 	if(comp == NULL)
 	{
-		fprintf(stderr, "cannot create the ROHC compressor\n");
-		goto close_input;
-	}
-
-	/* set the callback for traces */
-	if(!rohc_comp_set_traces_cb2(comp, print_rohc_traces, (void *) &is_verbose))
-	{
-		fprintf(stderr, "failed to set the callback for traces\n");
-		goto free_compresssor;
+		goto free_capture;
 	}
 
-	/* activate all the compression profiles */
-	if(!rohc_comp_enable_profiles(comp, ROHC_PROFILE_UNCOMPRESSED,
-	                              ROHC_PROFILE_RTP, ROHC_PROFILE_UDP,
-	                              ROHC_PROFILE_IP, ROHC_PROFILE_UDPLITE,
-	                              ROHC_PROFILE_ESP, ROHC_PROFILE_TCP, -1))
+	/* measure the durations of the compression phases if requested */
+	if(with_breakdown &&
+	   !rohc_comp_set_features(comp, ROHC_COMP_FEATURE_TIMINGS))
 	{
-		fprintf(stderr, "failed to enable the compression profiles\n");
+		fprintf(stderr, "failed to enable the timings of the compressor: "
+		        "was the library built with --enable-rohc-timings?\n");
 		goto free_compresssor;
 	}
 
-	/* set the WLSB window width on compressor */
-	if(!rohc_comp_set_wlsb_window_width(comp, wlsb_width))
+	/* create the histograms of latencies if requested */
+	if(latency_format != PERF_LATENCY_NONE)
 	{
-		fprintf(stderr, "failed to set the WLSB window width on compressor\n");
-		goto free_compresssor;
+		latency = calloc(1, sizeof(struct perf_latency));
+		if(latency == NULL)
+		{
+			fprintf(stderr, "failed to allocate memory for latencies\n");
+			goto free_compresssor;
+		}
 	}
 
-	/* set UDP ports dedicated to RTP traffic */
-	if(!rohc_comp_set_rtp_detection_cb(comp, rohc_comp_rtp_cb, NULL))
+	/* open the hardware counters if requested */
+	if(with_counters && !perf_counters_open(&counters))
 	{
-		fprintf(stderr, "failed to set the RTP detection callback on compressor\n");
 		goto free_compresssor;
 	}
 
 	fflush(stderr);
 
 	/* for each packet in the dump */
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	if(with_counters)
+	{
+		perf_counters_start(&counters);
+	}
 	*packet_count = 0;
-	while((packet = (unsigned char *) pcap_next(handle, &header)) != NULL)
+	for(round = 0; round < repeat_nr; round++)
 	{
-		(*packet_count)++;
-		if((*packet_count) != 0 && ((*packet_count) % 100000) == 0)
+		for(i = 0; i < test.packets_nr; i++)
 		{
-			fprintf(stderr, "compression: packet #%lu\r", *packet_count);
-			fflush(stderr);
-		}
+			const struct perf_packet *const packet = &(test.packets[i]);
 
-		/* compress the IP packet */
-		ret = time_compress_packet(comp, *packet_count,
-		                           header, packet, link_len);
-		if(ret != 0)
-		{
-			fprintf(stderr, "packet %lu: performance test failed\n",
-			        *packet_count);
-			goto free_compresssor;
+			(*packet_count)++;
+
+			/* compress the IP packet */
+			ret = time_compress_packet(comp, packet->num, packet->header,
+			                           packet->data, test.link_len, latency);
+			if(ret != 0)
+			{
+				fprintf(stderr, "packet %lu: performance test failed\n",
+				        packet->num);
+				goto close_counters;
+			}
 		}
 	}
+	if(with_counters)
+	{
+		perf_counters_stop(&counters);
+	}
+	clock_gettime(CLOCK_MONOTONIC, &end);
 
-	/* everything went fine */
-	is_failure = 0;
-
-free_compresssor:
-	rohc_comp_free(comp);
-close_input:
-	pcap_close(handle);
+	elapsed = perf_elapsed(&start, &end);
+	printf("compression: %lu packets in %.6f s, %.3f Mpps\n", *packet_count,
+	       elapsed, (elapsed > 0 ? (*packet_count) / elapsed / 1e6 : 0.0));
+	fflush(stdout);
+	if(with_counters)
+	{
+		perf_counters_print(&counters, true, 1, *packet_count);
+	}
+	if(latency != NULL)
+	{
+		perf_latency_print(latency, latency_format, "compression", 1);
+	}
+	if(with_breakdown && !perf_breakdown_print_comp(comp))
+	{
+		goto close_counters;
+	}
+
+	/* everything went fine */
+	is_failure = 0;
+
+close_counters:
+	if(with_counters)
+	{
+		perf_counters_close(&counters);
+	}
+free_compresssor:
+	free(latency);
+	rohc_comp_free(comp);
+free_capture:
+	perf_free_capture(&test);
 exit:
 	return is_failure;
 }
@@ -515,13 +1348,15 @@ exit:
  * @param header        The PCAP header for the packet
  * @param packet        The packet to compress (link layer included)
  * @param link_len      The length of the link layer header before IP data
+ * @param latency       The latencies to update, NULL not to record them
  * @return              0 if compression is successful, 1 otherwise
  */
 static int time_compress_packet(struct rohc_comp *comp,
                                 unsigned long num_packet,
                                 struct pcap_pkthdr header,
                                 unsigned char *packet,
-                                size_t link_len)
+                                size_t link_len,
+                                struct perf_latency *const latency)
 {
 	/* the buffer that will contain the initial uncompressed packet */
 	const struct rohc_ts arrival_time = { .sec = 0, .nsec = 0 };
@@ -535,6 +1370,7 @@ static int time_compress_packet(struct rohc_comp *comp,
 
 	int is_failure = 1;
 	rohc_status_t status;
+	uint64_t duration = 0;
 
 	/* check Ethernet frame length */
 	if(header.len <= link_len || header.len != header.caplen)
@@ -587,13 +1423,39 @@ static int time_compress_packet(struct rohc_comp *comp,
 	}
 
 	/* compress the packet */
-	status = rohc_compress4(comp, ip_packet, &rohc_packet);
+	if(latency == NULL)
+	{
+		status = rohc_compress4(comp, ip_packet, &rohc_packet);
+	}
+	else
+	{
+		const uint64_t start = perf_now_ns();
+		status = rohc_compress4(comp, ip_packet, &rohc_packet);
+		duration = perf_now_ns() - start;
+	}
 	if(status != ROHC_STATUS_OK)
 	{
 		fprintf(stderr, "packet %lu: compression failed\n", num_packet);
 		goto error;
 	}
 
+	/* record the latency of the call with the type of the ROHC packet */
+	if(latency != NULL)
+	{
+		rohc_comp_last_packet_info2_t info;
+
+		memset(&info, 0, sizeof(rohc_comp_last_packet_info2_t));
+		info.version_major = 0;
+		info.version_minor = 0;
+		if(!rohc_comp_get_last_packet_info2(comp, &info))
+		{
+			fprintf(stderr, "packet %lu: failed to get the type of the ROHC "
+			        "packet\n", num_packet);
+			goto error;
+		}
+		perf_latency_add(latency, info.packet_type, duration);
+	}
+
 	/* everything went fine */
 	is_failure = 0;
 
@@ -608,120 +1470,154 @@ error:
  *
  * @param is_verbose    Whether the test is run in verbose mode or not
  * @param filename      The name of the PCAP file that contains the ROHC packets
- * @param cid_type      The type of CIDs the decompressor shall use
- * @param max_contexts  The maximum number of ROHC contexts to use
- * @param packet_count  OUT: the number of decompressed packets, undefined if
- *                      decompression failed
- * @return              0 in case of success, 1 otherwise
+ * @param cid_type        The type of CIDs the decompressor shall use
+ * @param max_contexts    The maximum number of ROHC contexts to use
+ * @param repeat_nr       The number of times the packets are decompressed
+ * @param latency_format  How to output latencies, PERF_LATENCY_NONE not to
+ *                        record them
+ * @param with_counters   Whether to read the hardware performance counters
+ * @param with_breakdown  Whether to report the durations of the phases per
+ *                        profile
+ * @param numa_node       The NUMA node of the memory of the decompressor,
+ *                        ROHC_NUMA_NODE_ANY for the default placement
+ * @param packet_count    OUT: the number of decompressed packets, undefined
+ *                        if decompression failed
+ * @return                0 in case of success, 1 otherwise
  */
 static int test_decompression_perfs(const bool is_verbose,
                                     char *filename,
                                     const rohc_cid_type_t cid_type,
                                     const size_t max_contexts,
+                                    const size_t repeat_nr,
+                                    const perf_latency_format_t latency_format,
+                                    const bool with_counters,
+                                    const bool with_breakdown,
+                                    const int numa_node,
                                     unsigned long *packet_count)
 {
 	const struct rohc_ts arrival_time = { .sec = 0, .nsec = 0 };
-	pcap_t *handle;
-	char errbuf[PCAP_ERRBUF_SIZE];
-	int link_layer_type;
-	size_t link_len;
-	struct pcap_pkthdr header;
-	unsigned char *packet;
+	struct perf_latency *latency = NULL;
+	struct perf_counters counters;
+	struct perf_test test;
+	struct timespec start;
+	struct timespec end;
+	double elapsed;
 	struct rohc_decomp *decomp;
 	int is_failure = 1;
+	size_t round;
+	size_t i;
 	int ret;
 
 	assert(max_contexts > 0);
+	assert(repeat_nr > 0);
 
-	/* open the PCAP file that contains the stream */
-	handle = pcap_open_offline(filename, errbuf);
-	if(handle == NULL)
+	/* load the whole capture in memory, so that reading it is not measured */
+	test.is_comp = false;
+	test.cid_type = cid_type;
+	if(!perf_load_capture(&test, filename))
 	{
-		fprintf(stderr, "failed to open the pcap file: %s\n", errbuf);
 		goto exit;
 	}
 
-	/* link layer in the capture must be Ethernet */
-	link_layer_type = pcap_datalink(handle);
-	if(link_layer_type != DLT_EN10MB &&
-	   link_layer_type != DLT_LINUX_SLL &&
-	   link_layer_type != DLT_RAW)
-	{
-		fprintf(stderr, "link layer type %d not supported in capture "
-		        "(supported = %d, %d, %d)\n", link_layer_type,
-		        DLT_EN10MB, DLT_LINUX_SLL, DLT_RAW);
-		goto close_input;
-	}
-
-	if(link_layer_type == DLT_EN10MB)
-	{
-		link_len = ETHER_HDR_LEN;
-	}
-	else if(link_layer_type == DLT_LINUX_SLL)
-	{
-		link_len = LINUX_COOKED_HDR_LEN;
-	}
-	else /* DLT_RAW */
-	{
-		link_len = 0;
-	}
-
 	/* create ROHC decompressor */
-	decomp = rohc_decomp_new2(cid_type, max_contexts - 1, ROHC_U_MODE);
+	decomp = create_decompressor(&is_verbose, cid_type, max_contexts,
+	                             ROHC_U_MODE, numa_node);
 	if(decomp == NULL)
 	{
-		fprintf(stderr, "cannot create the ROHC decompressor\n");
-		goto close_input;
+		goto free_capture;
 	}
 
-	/* set trace callback for decompressor in verbose mode */
-	if(!rohc_decomp_set_traces_cb2(decomp, print_rohc_traces, (void *) &is_verbose))
+	/* measure the durations of the decompression phases if requested */
+	if(with_breakdown &&
+	   !rohc_decomp_set_features(decomp, ROHC_DECOMP_FEATURE_TIMINGS))
 	{
-		fprintf(stderr, "cannot set trace callback for decompressor\n");
+		fprintf(stderr, "failed to enable the timings of the decompressor: "
+		        "was the library built with --enable-rohc-timings?\n");
 		goto free_decompressor;
 	}
 
-	/* activate all the decompression profiles */
-	if(!rohc_decomp_enable_profiles(decomp, ROHC_PROFILE_UNCOMPRESSED,
-	                                ROHC_PROFILE_RTP, ROHC_PROFILE_UDP,
-	                                ROHC_PROFILE_IP, ROHC_PROFILE_UDPLITE,
-	                                ROHC_PROFILE_ESP, ROHC_PROFILE_TCP, -1))
+	/* create the histograms of latencies if requested */
+	if(latency_format != PERF_LATENCY_NONE)
+	{
+		latency = calloc(1, sizeof(struct perf_latency));
+		if(latency == NULL)
+		{
+			fprintf(stderr, "failed to allocate memory for latencies\n");
+			goto free_decompressor;
+		}
+	}
+
+	/* open the hardware counters if requested */
+	if(with_counters && !perf_counters_open(&counters))
 	{
-		fprintf(stderr, "failed to enable the decompression profiles\n");
 		goto free_decompressor;
 	}
 
 	fflush(stderr);
 
 	/* for each packet in the dump */
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	if(with_counters)
+	{
+		perf_counters_start(&counters);
+	}
 	*packet_count = 0;
-	while((packet = (unsigned char *) pcap_next(handle, &header)) != NULL)
+	for(round = 0; round < repeat_nr; round++)
 	{
-		(*packet_count)++;
-		if((*packet_count) != 0 && ((*packet_count) % 100000) == 0)
+		for(i = 0; i < test.packets_nr; i++)
 		{
-			fprintf(stderr, "decompression: packet #%lu\r", *packet_count);
-			fflush(stderr);
-		}
+			const struct perf_packet *const packet = &(test.packets[i]);
 
-		/* decompress the ROHC packet */
-		ret = time_decompress_packet(decomp, *packet_count,
-		                             header, packet, link_len, arrival_time);
-		if(ret != 0)
-		{
-			fprintf(stderr, "packet %lu: performance test failed\n",
-			        *packet_count);
-			goto free_decompressor;
+			(*packet_count)++;
+
+			/* decompress the ROHC packet */
+			ret = time_decompress_packet(decomp, packet->num, packet->header,
+			                             packet->data, test.link_len,
+			                             arrival_time, latency);
+			if(ret != 0)
+			{
+				fprintf(stderr, "packet %lu: performance test failed\n",
+				        packet->num);
+				goto close_counters;
+			}
 		}
 	}
+	if(with_counters)
+	{
+		perf_counters_stop(&counters);
+	}
+	clock_gettime(CLOCK_MONOTONIC, &end);
+
+	elapsed = perf_elapsed(&start, &end);
+	printf("decompression: %lu packets in %.6f s, %.3f Mpps\n", *packet_count,
+	       elapsed, (elapsed > 0 ? (*packet_count) / elapsed / 1e6 : 0.0));
+	fflush(stdout);
+	if(with_counters)
+	{
+		perf_counters_print(&counters, false, 1, *packet_count);
+	}
+	if(latency != NULL)
+	{
+		perf_latency_print(latency, latency_format, "decompression", 1);
+	}
+	if(with_breakdown && !perf_breakdown_print_decomp(decomp))
+	{
+		goto close_counters;
+	}
 
 	/* everything went fine */
 	is_failure = 0;
 
+close_counters:
+	if(with_counters)
+	{
+		perf_counters_close(&counters);
+	}
 free_decompressor:
+	free(latency);
 	rohc_decomp_free(decomp);
-close_input:
-	pcap_close(handle);
+free_capture:
+	perf_free_capture(&test);
 exit:
 	return is_failure;
 }
@@ -737,6 +1633,8 @@ exit:
  * @param header        The PCAP header for the packet
  * @param packet        The packet to decompress (link layer included)
  * @param link_len      The length of the link layer header before ROHC data
+ * @param arrival_time  The time at which the ROHC packet was received
+ * @param latency       The latencies to update, NULL not to record them
  * @return              0 if decompression is successful, 1 otherwise
  */
 static int time_decompress_packet(struct rohc_decomp *decomp,
@@ -744,7 +1642,8 @@ static int time_decompress_packet(struct rohc_decomp *decomp,
                                   struct pcap_pkthdr header,
                                   unsigned char *packet,
                                   size_t link_len,
-                                  const struct rohc_ts arrival_time)
+                                  const struct rohc_ts arrival_time,
+                                  struct perf_latency *const latency)
 {
 	/* the buffer that will contain the compressed ROHC packet */
 	struct rohc_buf rohc_packet =
@@ -756,6 +1655,7 @@ static int time_decompress_packet(struct rohc_decomp *decomp,
 
 	int is_failure = 1;
 	rohc_status_t status;
+	uint64_t duration = 0;
 
 	/* check Ethernet frame length */
 	if(header.len <= link_len || header.len != header.caplen)
@@ -769,13 +1669,39 @@ static int time_decompress_packet(struct rohc_decomp *decomp,
 	rohc_buf_pull(&rohc_packet, link_len);
 
 	/* decompress the packet */
-	status = rohc_decompress3(decomp, rohc_packet, &ip_packet, NULL, NULL);
+	if(latency == NULL)
+	{
+		status = rohc_decompress3(decomp, rohc_packet, &ip_packet, NULL, NULL);
+	}
+	else
+	{
+		const uint64_t start = perf_now_ns();
+		status = rohc_decompress3(decomp, rohc_packet, &ip_packet, NULL, NULL);
+		duration = perf_now_ns() - start;
+	}
 	if(status != ROHC_STATUS_OK)
 	{
 		fprintf(stderr, "packet %lu: decompression failed\n", num_packet);
 		goto error;
 	}
 
+	/* record the latency of the call with the type of the ROHC packet */
+	if(latency != NULL)
+	{
+		rohc_decomp_last_packet_info_t info;
+
+		memset(&info, 0, sizeof(rohc_decomp_last_packet_info_t));
+		info.version_major = 0;
+		info.version_minor = 1;
+		if(!rohc_decomp_get_last_packet_info(decomp, &info))
+		{
+			fprintf(stderr, "packet %lu: failed to get the type of the ROHC "
+			        "packet\n", num_packet);
+			goto error;
+		}
+		perf_latency_add(latency, info.packet_type, duration);
+	}
+
 	/* everything went fine */
 	is_failure = 0;
 
@@ -784,6 +1710,2387 @@ error:
 }
 
 
+/**
+ * @brief Create one ROHC compressor for the performance tests
+ *
+ * @param is_verbose    Whether the test is run in verbose mode or not
+ * @param cid_type      The type of CIDs the compressor shall use
+ * @param wlsb_width    The width of the WLSB window to use
+ * @param max_contexts  The maximum number of ROHC contexts to use
+ * @param numa_node     The NUMA node of the memory of the compressor,
+ *                      ROHC_NUMA_NODE_ANY for the default placement
+ * @return              The new compressor, NULL in case of failure
+ */
+static struct rohc_comp * create_compressor(const bool *const is_verbose,
+                                            const rohc_cid_type_t cid_type,
+                                            const size_t wlsb_width,
+                                            const size_t max_contexts,
+                                            const int numa_node)
+{
+	const struct rohc_comp_attr attr = {
+		.cid_type = cid_type,
+		.max_cid = max_contexts - 1,
+		.rand_cb = gen_false_random_num,
+		.rand_priv = NULL,
+		.numa_node = numa_node,
+	};
+	struct rohc_comp *comp;
+
+	assert(max_contexts > 0);
+
+	/* create ROHC compressor */
+	comp = rohc_comp_new3(&attr);
+	if(comp == NULL)
+	{
+		fprintf(stderr, "cannot create the ROHC compressor\n");
+		goto error;
+	}
+
+	/* set the callback for traces */
+	if(!rohc_comp_set_traces_cb2(comp, print_rohc_traces, (void *) is_verbose))
+	{
+		fprintf(stderr, "failed to set the callback for traces\n");
+		goto free_compresssor;
+	}
+
+	/* activate all the compression profiles */
+	if(!rohc_comp_enable_profiles(comp, ROHC_PROFILE_UNCOMPRESSED,
+	                              ROHC_PROFILE_RTP, ROHC_PROFILE_UDP,
+	                              ROHC_PROFILE_IP, ROHC_PROFILE_UDPLITE,
+	                              ROHC_PROFILE_ESP, ROHC_PROFILE_TCP, -1))
+	{
+		fprintf(stderr, "failed to enable the compression profiles\n");
+		goto free_compresssor;
+	}
+
+	/* set the WLSB window width on compressor */
+	if(!rohc_comp_set_wlsb_window_width(comp, wlsb_width))
+	{
+		fprintf(stderr, "failed to set the WLSB window width on compressor\n");
+		goto free_compresssor;
+	}
+
+	/* set UDP ports dedicated to RTP traffic */
+	if(!rohc_comp_set_rtp_detection_cb(comp, rohc_comp_rtp_cb, NULL))
+	{
+		fprintf(stderr, "failed to set the RTP detection callback on compressor\n");
+		goto free_compresssor;
+	}
+
+	return comp;
+
+free_compresssor:
+	rohc_comp_free(comp);
+error:
+	return NULL;
+}
+
+
+/**
+ * @brief Create one ROHC decompressor for the performance tests
+ *
+ * @param is_verbose    Whether the test is run in verbose mode or not
+ * @param cid_type      The type of CIDs the decompressor shall use
+ * @param max_contexts  The maximum number of ROHC contexts to use
+ * @param mode          The operational mode the decompressor shall target
+ * @param numa_node     The NUMA node of the memory of the decompressor,
+ *                      ROHC_NUMA_NODE_ANY for the default placement
+ * @return              The new decompressor, NULL in case of failure
+ */
+static struct rohc_decomp * create_decompressor(const bool *const is_verbose,
+                                                const rohc_cid_type_t cid_type,
+                                                const size_t max_contexts,
+                                                const rohc_mode_t mode,
+                                                const int numa_node)
+{
+	const struct rohc_decomp_attr attr = {
+		.cid_type = cid_type,
+		.max_cid = max_contexts - 1,
+		.mode = mode,
+		.numa_node = numa_node,
+	};
+	struct rohc_decomp *decomp;
+
+	assert(max_contexts > 0);
+
+	/* create ROHC decompressor */
+	decomp = rohc_decomp_new3(&attr);
+	if(decomp == NULL)
+	{
+		fprintf(stderr, "cannot create the ROHC decompressor\n");
+		goto error;
+	}
+
+	/* set trace callback for decompressor in verbose mode */
+	if(!rohc_decomp_set_traces_cb2(decomp, print_rohc_traces, (void *) is_verbose))
+	{
+		fprintf(stderr, "cannot set trace callback for decompressor\n");
+		goto free_decompressor;
+	}
+
+	/* activate all the decompression profiles */
+	if(!rohc_decomp_enable_profiles(decomp, ROHC_PROFILE_UNCOMPRESSED,
+	                                ROHC_PROFILE_RTP, ROHC_PROFILE_UDP,
+	                                ROHC_PROFILE_IP, ROHC_PROFILE_UDPLITE,
+	                                ROHC_PROFILE_ESP, ROHC_PROFILE_TCP, -1))
+	{
+		fprintf(stderr, "failed to enable the decompression profiles\n");
+		goto free_decompressor;
+	}
+
+	return decomp;
+
+free_decompressor:
+	rohc_decomp_free(decomp);
+error:
+	return NULL;
+}
+
+
+/**
+ * @brief Test how the ROHC library scales with the number of threads
+ *
+ * The flows of the capture are sharded across the threads. The test is run
+ * once with one single thread as reference, then with all the threads.
+ *
+ * @param is_comp         Whether to test compression or decompression
+ * @param is_verbose      Whether the test is run in verbose mode or not
+ * @param filename        The name of the PCAP file that contains the packets
+ * @param cid_type        The type of CIDs the (de)compressors shall use
+ * @param wlsb_width      The width of the WLSB window to use
+ * @param max_contexts    The maximum number of ROHC contexts to use
+ * @param threads_nr      The number of threads to use
+ * @param repeat_nr       The number of times the packets are (de)compressed
+ * @param latency_format  How to output latencies, PERF_LATENCY_NONE not to
+ *                        record them
+ * @param with_counters   Whether to read the hardware performance counters
+ * @param numa_node       The NUMA node of the memory of the (de)compressors,
+ *                        ROHC_NUMA_NODE_ANY for the default placement
+ * @param packet_count    OUT: the number of (de)compressed packets with all
+ *                        the threads, undefined if (de)compression failed
+ * @return                0 in case of success, 1 otherwise
+ */
+static int test_perfs_threads(const bool is_comp,
+                              const bool is_verbose,
+                              char *filename,
+                              const rohc_cid_type_t cid_type,
+                              const size_t wlsb_width,
+                              const size_t max_contexts,
+                              const size_t threads_nr,
+                              const size_t repeat_nr,
+                              const perf_latency_format_t latency_format,
+                              const bool with_counters,
+                              const int numa_node,
+                              unsigned long *packet_count)
+{
+	struct perf_test test;
+	double ref_mpps;
+	double mpps;
+	int is_failure = 1;
+
+	assert(max_contexts > 0);
+	assert(threads_nr > 0);
+
+	test.is_comp = is_comp;
+	test.is_verbose = is_verbose;
+	test.cid_type = cid_type;
+	test.wlsb_width = wlsb_width;
+	test.max_contexts = max_contexts;
+	test.latency_format = latency_format;
+	test.with_counters = with_counters;
+	test.numa_node = numa_node;
+	test.repeat_nr = repeat_nr;
+
+	/* load the whole capture in memory, so that the threads do not compete
+	 * for reading it */
+	if(!perf_load_capture(&test, filename))
+	{
+		goto exit;
+	}
+
+	/* the reference with one single thread, latencies and counters are
+	 * recorded but reported only for the run with all the threads */
+	if(!perf_run_threads(&test, 1, (threads_nr == 1), &ref_mpps))
+	{
+		goto free_capture;
+	}
+
+	/* the flows sharded across all the threads */
+	if(threads_nr == 1)
+	{
+		mpps = ref_mpps;
+	}
+	else if(!perf_run_threads(&test, threads_nr, true, &mpps))
+	{
+		goto free_capture;
+	}
+
+	printf("scaling efficiency with %zu threads: %.1f %%\n", threads_nr,
+	       (ref_mpps > 0 ? (mpps * 100.0) / (threads_nr * ref_mpps) : 0.0));
+	fflush(stdout);
+
+	*packet_count = test.packets_nr * repeat_nr;
+
+	/* everything went fine */
+	is_failure = 0;
+
+free_capture:
+	perf_free_capture(&test);
+exit:
+	return is_failure;
+}
+
+
+/**
+ * @brief Run the round-trip test in every configuration
+ *
+ * See the header of the file for the configurations and the output.
+ *
+ * @param is_verbose      Whether the test is run in verbose mode or not
+ * @param filename        The name of the PCAP file that contains the IP
+ *                        packets
+ * @param cid_type        The type of CIDs the (de)compressor shall use
+ * @param wlsb_width      The width of the WLSB window to use
+ * @param max_contexts    The maximum number of ROHC contexts to use
+ * @param loss_rate       The probability that one ROHC packet is lost
+ * @param latency_format  How to output latencies
+ * @param packet_count    OUT: the number of packets compressed in all the
+ *                        configurations, undefined if the test failed
+ * @return                0 in case of success, 1 otherwise
+ */
+static int test_roundtrip(const bool is_verbose,
+                          char *filename,
+                          const rohc_cid_type_t cid_type,
+                          const size_t wlsb_width,
+                          const size_t max_contexts,
+                          const double loss_rate,
+                          const perf_latency_format_t latency_format,
+                          unsigned long *packet_count)
+{
+	struct perf_test test;
+	int is_failure = 1;
+	int mode;
+
+	assert(max_contexts > 0);
+	assert(loss_rate >= 0 && loss_rate < 1);
+	assert(latency_format != PERF_LATENCY_NONE);
+
+	/* load the whole capture in memory, so that reading it is not measured */
+	test.is_comp = true;
+	test.cid_type = cid_type;
+	if(!perf_load_capture(&test, filename))
+	{
+		goto exit;
+	}
+
+	printf("ROUNDTRIP\tmode\tpackets\tlost\tdecomp_failures\tfeedbacks\t"
+	       "feedback_bytes\tmean_ns\n");
+	fflush(stdout);
+
+	*packet_count = 0;
+	for(mode = 0; mode < PERF_ROUNDTRIP_MAX; mode++)
+	{
+		if(!perf_roundtrip_run(is_verbose, &test, wlsb_width, max_contexts,
+		                       mode, loss_rate, latency_format, packet_count))
+		{
+			goto free_capture;
+		}
+	}
+
+	/* everything went fine */
+	is_failure = 0;
+
+free_capture:
+	perf_free_capture(&test);
+exit:
+	return is_failure;
+}
+
+
+/**
+ * @brief Run the round-trip test in one configuration
+ *
+ * Every packet of the capture is compressed, then the ROHC packet is
+ * decompressed right away unless it is lost, and the feedback built by the
+ * decompressor is delivered to the compressor. The latency of the whole
+ * round trip is recorded for the packets that are not lost.
+ *
+ * @param is_verbose      Whether the test is run in verbose mode or not
+ * @param test            The test with the capture loaded in memory
+ * @param wlsb_width      The width of the WLSB window to use
+ * @param max_contexts    The maximum number of ROHC contexts to use
+ * @param mode            The configuration of the (de)compressor
+ * @param loss_rate       The probability that one ROHC packet is lost
+ * @param latency_format  How to output latencies
+ * @param packet_count    IN/OUT: the number of compressed packets
+ * @return                true if the test succeeded, false otherwise
+ */
+static bool perf_roundtrip_run(const bool is_verbose,
+                               const struct perf_test *const test,
+                               const size_t wlsb_width,
+                               const size_t max_contexts,
+                               const perf_roundtrip_mode_t mode,
+                               const double loss_rate,
+                               const perf_latency_format_t latency_format,
+                               unsigned long *const packet_count)
+{
+	const char *const names[PERF_ROUNDTRIP_MAX] = {
+		[PERF_ROUNDTRIP_U] = "roundtrip-U",
+		[PERF_ROUNDTRIP_O] = "roundtrip-O",
+		[PERF_ROUNDTRIP_R] = "roundtrip-R",
+	};
+	const struct rohc_ts arrival_time = { .sec = 0, .nsec = 0 };
+	uint8_t rohc_buffer[MAX_ROHC_SIZE];
+	uint8_t decomp_buffer[MAX_ROHC_SIZE];
+	uint8_t feedback_buffer[MAX_ROHC_SIZE];
+	uint32_t loss_state = PERF_ROUNDTRIP_LOSS_SEED;
+	struct perf_latency *latency;
+	struct rohc_decomp *decomp;
+	struct rohc_comp *comp;
+	uint64_t packets_nr = 0;
+	uint64_t lost_nr = 0;
+	uint64_t failures_nr = 0;
+	uint64_t feedbacks_nr = 0;
+	uint64_t feedback_bytes = 0;
+	uint64_t total_ns = 0;
+	bool is_success = false;
+	size_t i;
+
+	latency = calloc(1, sizeof(struct perf_latency));
+	if(latency == NULL)
+	{
+		fprintf(stderr, "failed to allocate memory for latencies\n");
+		goto error;
+	}
+
+	/* create the ROHC compressor and the decompressor in the configuration:
+	 * the library does not implement the R-mode, the R-like configuration
+	 * is an O-mode decompressor that acknowledges every packet it may
+	 * acknowledge and that sends NACKs after the first CRC failure */
+	comp = create_compressor(&is_verbose, test->cid_type, wlsb_width,
+	                         max_contexts, ROHC_NUMA_NODE_ANY);
+	if(comp == NULL)
+	{
+		goto free_latency;
+	}
+	decomp = create_decompressor(&is_verbose, test->cid_type, max_contexts,
+	                             (mode == PERF_ROUNDTRIP_U ?
+	                              ROHC_U_MODE : ROHC_O_MODE),
+	                             ROHC_NUMA_NODE_ANY);
+	if(decomp == NULL)
+	{
+		goto free_compressor;
+	}
+	if(mode == PERF_ROUNDTRIP_R &&
+	   !rohc_decomp_set_rate_limits(decomp, 2, 1, 1, 1, 1, 1))
+	{
+		fprintf(stderr, "failed to disable the rate limits of the feedback\n");
+		goto free_decompressor;
+	}
+
+	for(i = 0; i < test->packets_nr; i++)
+	{
+		const struct perf_packet *const packet = &(test->packets[i]);
+		const size_t ip_len = perf_capture_ip_len(packet, test->link_len);
+		const struct rohc_buf ip_packet =
+			rohc_buf_init_full(packet->data + test->link_len, ip_len,
+			                   arrival_time);
+		struct rohc_buf rohc_packet =
+			rohc_buf_init_empty(rohc_buffer, MAX_ROHC_SIZE);
+		struct rohc_buf decomp_packet =
+			rohc_buf_init_empty(decomp_buffer, MAX_ROHC_SIZE);
+		struct rohc_buf feedback_send =
+			rohc_buf_init_empty(feedback_buffer, MAX_ROHC_SIZE);
+		rohc_comp_last_packet_info2_t info;
+		rohc_status_t status;
+		uint64_t duration;
+		uint64_t start;
+
+		if(ip_len == 0)
+		{
+			continue;
+		}
+		packets_nr++;
+		(*packet_count)++;
+
+		/* compress the packet */
+		start = perf_now_ns();
+		if(rohc_compress4(comp, ip_packet, &rohc_packet) != ROHC_STATUS_OK)
+		{
+			fprintf(stderr, "packet %lu: compression failed\n", packet->num);
+			goto free_decompressor;
+		}
+
+		/* the packet is lost on the way to the decompressor */
+		if(perf_is_lost(&loss_state, loss_rate))
+		{
+			lost_nr++;
+			continue;
+		}
+
+		/* decompress the packet, then loop the feedback back */
+		status = rohc_decompress3(decomp, rohc_packet, &decomp_packet, NULL,
+		                          (mode == PERF_ROUNDTRIP_U ?
+		                           NULL : &feedback_send));
+		if(status != ROHC_STATUS_OK)
+		{
+			failures_nr++;
+		}
+		if(feedback_send.len > 0)
+		{
+			feedbacks_nr++;
+			feedback_bytes += feedback_send.len;
+			if(!rohc_comp_deliver_feedback2(comp, feedback_send))
+			{
+				fprintf(stderr, "packet %lu: failed to deliver the feedback to "
+				        "the compressor\n", packet->num);
+				goto free_decompressor;
+			}
+		}
+		duration = perf_now_ns() - start;
+
+		/* record the latency of the packets that were decompressed */
+		if(status == ROHC_STATUS_OK)
+		{
+			memset(&info, 0, sizeof(rohc_comp_last_packet_info2_t));
+			info.version_major = 0;
+			info.version_minor = 0;
+			if(!rohc_comp_get_last_packet_info2(comp, &info))
+			{
+				fprintf(stderr, "packet %lu: failed to get the type of the ROHC "
+				        "packet\n", packet->num);
+				goto free_decompressor;
+			}
+			perf_latency_add(latency, info.packet_type, duration);
+			total_ns += duration;
+		}
+	}
+
+	/* no packet shall fail to be decompressed if none is lost */
+	if(lost_nr == 0 && failures_nr > 0)
+	{
+		fprintf(stderr, "%s: %" PRIu64 " packets failed to be decompressed "
+		        "without any loss\n", names[mode], failures_nr);
+		goto free_decompressor;
+	}
+
+	printf("ROUNDTRIP\t%s\t%" PRIu64 "\t%" PRIu64 "\t%" PRIu64 "\t%" PRIu64
+	       "\t%" PRIu64 "\t%.1f\n", names[mode], packets_nr, lost_nr,
+	       failures_nr, feedbacks_nr, feedback_bytes,
+	       (latency->all.count > 0 ?
+	        ((double) total_ns) / latency->all.count : 0.0));
+	perf_latency_print(latency, latency_format, names[mode], 1);
+
+	is_success = true;
+
+free_decompressor:
+	rohc_decomp_free(decomp);
+free_compressor:
+	rohc_comp_free(comp);
+free_latency:
+	free(latency);
+error:
+	return is_success;
+}
+
+
+/**
+ * @brief Get the length of the IP packet of one packet of the capture
+ *
+ * The Ethernet padding after the IP packet is not part of the IP packet.
+ *
+ * @param packet    The packet of the capture
+ * @param link_len  The length of the link layer header before IP data
+ * @return          The length of the IP packet, 0 if the packet is not a
+ *                  valid IPv4 or IPv6 packet
+ */
+static size_t perf_capture_ip_len(const struct perf_packet *const packet,
+                                  const size_t link_len)
+{
+	const uint8_t *const ip = packet->data + link_len;
+	size_t ip_len;
+	size_t len;
+
+	if(packet->header.caplen <= link_len)
+	{
+		return 0;
+	}
+	ip_len = packet->header.caplen - link_len;
+
+	if(ip_len >= sizeof(struct ipv4_hdr) && (ip[0] >> 4) == 4)
+	{
+		len = ntohs(((const struct ipv4_hdr *) ip)->tot_len);
+		if(len < sizeof(struct ipv4_hdr))
+		{
+			return 0;
+		}
+	}
+	else if(ip_len >= sizeof(struct ipv6_hdr) && (ip[0] >> 4) == 6)
+	{
+		len = sizeof(struct ipv6_hdr) +
+		      ntohs(((const struct ipv6_hdr *) ip)->plen);
+	}
+	else
+	{
+		return 0;
+	}
+
+	return (len > ip_len ? 0 : len);
+}
+
+
+/**
+ * @brief Decide whether one packet is lost
+ *
+ * The losses are drawn with a xorshift generator, so that the same packets
+ * are lost from one run to another.
+ *
+ * @param state      The state of the generator
+ * @param loss_rate  The probability that the packet is lost
+ * @return           true if the packet is lost, false otherwise
+ */
+static bool perf_is_lost(uint32_t *const state, const double loss_rate)
+{
+	uint32_t x = *state;
+
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	*state = x;
+
+	return (x < loss_rate * UINT32_MAX);
+}
+
+
+/**
+ * @brief Run the soak test
+ *
+ * The packets are compressed, then the ROHC packets are decompressed right
+ * away by a decompressor with the same parameters. The state of the
+ * (de)compressor and the resident memory of the program are sampled
+ * periodically, see the header of the file for the output.
+ *
+ * @param is_verbose     Whether the test is run in verbose mode or not
+ * @param filename       The name of the PCAP file that contains the IP
+ *                       packets, NULL for synthetic flows
+ * @param cid_type       The type of CIDs the (de)compressor shall use
+ * @param wlsb_width     The width of the WLSB window to use
+ * @param max_contexts   The maximum number of ROHC contexts to use
+ * @param duration       The duration of the test (in ns)
+ * @param sample_period  The period between two samples (in ns)
+ * @param flow_packets   The number of packets of every synthetic flow
+ * @param packet_count   OUT: the number of packets compressed then
+ *                       decompressed, undefined if the test failed
+ * @return               0 in case of success, 1 otherwise
+ */
+static int test_soak(const bool is_verbose,
+                     char *filename,
+                     const rohc_cid_type_t cid_type,
+                     const size_t wlsb_width,
+                     const size_t max_contexts,
+                     const uint64_t duration,
+                     const uint64_t sample_period,
+                     const size_t flow_packets,
+                     unsigned long *packet_count)
+{
+	const struct rohc_ts arrival_time = { .sec = 0, .nsec = 0 };
+	struct perf_soak_sample prev_sample;
+	struct perf_soak_sample first_sample;
+	struct perf_soak_sample sample;
+	struct rohc_decomp *decomp;
+	struct rohc_comp *comp;
+	struct perf_soak soak;
+	uint8_t ip_buffer[MAX_ROHC_SIZE];
+	uint8_t rohc_buffer[MAX_ROHC_SIZE];
+	uint8_t decomp_buffer[MAX_ROHC_SIZE];
+	uint64_t start_time;
+	uint64_t next_sample;
+	uint64_t now;
+	int is_failure = 1;
+	size_t i;
+
+	assert(max_contexts > 0);
+	assert(duration > 0);
+	assert(sample_period > 0);
+	assert(flow_packets > 0);
+
+	memset(&soak, 0, sizeof(struct perf_soak));
+	soak.is_synthetic = (filename == NULL);
+	if(soak.is_synthetic)
+	{
+		/* as many flows at a time as contexts, their ends are spread over
+		 * the lifetime of one flow, so that new flows keep coming at a full
+		 * CID space */
+		soak.flows_nr = max_contexts;
+		soak.flow_packets = flow_packets;
+		soak.flows = malloc(soak.flows_nr * sizeof(struct perf_soak_flow));
+		if(soak.flows == NULL)
+		{
+			fprintf(stderr, "failed to allocate memory for %zu flows\n",
+			        soak.flows_nr);
+			goto exit;
+		}
+		for(i = 0; i < soak.flows_nr; i++)
+		{
+			soak.flows[i].id = soak.next_flow_id;
+			soak.flows[i].packets_nr = (i * flow_packets) / soak.flows_nr;
+			soak.next_flow_id++;
+		}
+	}
+	else
+	{
+		/* load the whole capture in memory, so that it is read only once */
+		soak.capture.is_comp = true;
+		if(!perf_load_capture(&soak.capture, filename))
+		{
+			goto exit;
+		}
+		if(perf_soak_next_packet(&soak, ip_buffer, MAX_ROHC_SIZE) == 0)
+		{
+			fprintf(stderr, "no IP packet found in the capture\n");
+			goto free_packets;
+		}
+		soak.capture_pos = 0;
+		soak.capture_pass = 0;
+	}
+
+	/* create the ROHC compressor and decompressor */
+	comp = create_compressor(&is_verbose, cid_type, wlsb_width, max_contexts,
+	                         ROHC_NUMA_NODE_ANY);
+	if(comp == NULL)
+	{
+		goto free_packets;
+	}
+	decomp = create_decompressor(&is_verbose, cid_type, max_contexts,
+	                             ROHC_U_MODE, ROHC_NUMA_NODE_ANY);
+	if(decomp == NULL)
+	{
+		goto free_compressor;
+	}
+	if(!rohc_decomp_set_event_cb(decomp, perf_soak_decomp_event, &soak))
+	{
+		fprintf(stderr, "failed to set the callback for decompression "
+		        "events\n");
+		goto free_decompressor;
+	}
+
+	printf("SOAK\telapsed_s\tpackets\tpps\trss_kb\tcomp_ctxts\tdecomp_ctxts\t"
+	       "comp_created_per_s\tcomp_recycled_per_s\tdecomp_destroyed_per_s\t"
+	       "comp_failures\tdecomp_failures\n");
+	fflush(stdout);
+
+	start_time = perf_now_ns();
+	memset(&prev_sample, 0, sizeof(struct perf_soak_sample));
+	prev_sample.time = start_time;
+	first_sample = prev_sample;
+	next_sample = start_time + sample_period;
+	now = start_time;
+
+	while((now - start_time) < duration)
+	{
+		/* read the clock once in a while only, so that it is not measured */
+		for(i = 0; i < PERF_SOAK_CLOCK_PACKETS; i++)
+		{
+			const size_t ip_len =
+				perf_soak_next_packet(&soak, ip_buffer, MAX_ROHC_SIZE);
+			const struct rohc_buf ip_packet =
+				rohc_buf_init_full(ip_buffer, ip_len, arrival_time);
+			struct rohc_buf rohc_packet =
+				rohc_buf_init_empty(rohc_buffer, MAX_ROHC_SIZE);
+			struct rohc_buf decomp_packet =
+				rohc_buf_init_empty(decomp_buffer, MAX_ROHC_SIZE);
+
+			soak.packets_nr++;
+
+			if(rohc_compress4(comp, ip_packet, &rohc_packet) != ROHC_STATUS_OK)
+			{
+				soak.comp_failures_nr++;
+				continue;
+			}
+			if(rohc_decompress3(decomp, rohc_packet, &decomp_packet,
+			                    NULL, NULL) != ROHC_STATUS_OK)
+			{
+				soak.decomp_failures_nr++;
+			}
+		}
+
+		now = perf_now_ns();
+		if(now >= next_sample)
+		{
+			if(!perf_soak_sample(&soak, comp, decomp, start_time, &prev_sample,
+			                     &sample, false))
+			{
+				goto free_decompressor;
+			}
+			prev_sample = sample;
+			next_sample += sample_period;
+		}
+	}
+
+	/* sum up the whole test */
+	if(!perf_soak_sample(&soak, comp, decomp, start_time, &first_sample,
+	                     &sample, true))
+	{
+		goto free_decompressor;
+	}
+
+	*packet_count = soak.packets_nr;
+	if(soak.comp_failures_nr > 0 || soak.decomp_failures_nr > 0)
+	{
+		fprintf(stderr, "%" PRIu64 " compression and %" PRIu64 " "
+		        "decompression failures during the soak test\n",
+		        soak.comp_failures_nr, soak.decomp_failures_nr);
+		goto free_decompressor;
+	}
+
+	/* everything went fine */
+	is_failure = 0;
+
+free_decompressor:
+	rohc_decomp_free(decomp);
+free_compressor:
+	rohc_comp_free(comp);
+free_packets:
+	if(soak.is_synthetic)
+	{
+		free(soak.flows);
+	}
+	else
+	{
+		perf_free_capture(&soak.capture);
+	}
+exit:
+	return is_failure;
+}
+
+
+/**
+ * @brief Build the next IP packet of the soak test
+ *
+ * @param soak     The soak test
+ * @param buf      The buffer to build the IP packet in
+ * @param buf_max  The size of the buffer
+ * @return         The length of the IP packet, 0 if the capture contains no
+ *                 IP packet
+ */
+static size_t perf_soak_next_packet(struct perf_soak *const soak,
+                                    uint8_t *const buf,
+                                    const size_t buf_max)
+{
+	if(soak->is_synthetic)
+	{
+		return perf_soak_synthetic_packet(soak, buf);
+	}
+	return perf_soak_capture_packet(soak, buf, buf_max);
+}
+
+
+/**
+ * @brief Build the next packet of the synthetic flows of the soak test
+ *
+ * The flows are served in turn. Every flow is an IPv4/UDP flow whose source
+ * address and port are derived from its unique ID. Once a flow sent all its
+ * packets, it is replaced by a new flow.
+ *
+ * @param soak  The soak test
+ * @param buf   The buffer to build the IP packet in
+ * @return      The length of the IP packet
+ */
+static size_t perf_soak_synthetic_packet(struct perf_soak *const soak,
+                                         uint8_t *const buf)
+{
+	struct perf_soak_flow *const flow = &(soak->flows[soak->next_flow]);
+	const size_t len = sizeof(struct ipv4_hdr) + sizeof(struct udphdr) +
+	                   PERF_SOAK_PAYLOAD_LEN;
+	struct ipv4_hdr *const ipv4 = (struct ipv4_hdr *) buf;
+	struct udphdr *const udp = (struct udphdr *) (buf + sizeof(struct ipv4_hdr));
+	uint8_t *const payload = buf + sizeof(struct ipv4_hdr) +
+	                         sizeof(struct udphdr);
+
+	/* replace the flow by a new one once it sent all its packets */
+	if(flow->packets_nr >= soak->flow_packets)
+	{
+		flow->id = soak->next_flow_id;
+		flow->packets_nr = 0;
+		soak->next_flow_id++;
+	}
+
+	ipv4->version = 4;
+	ipv4->ihl = 5;
+	ipv4->tos = 0;
+	ipv4->tot_len = htons(len);
+	ipv4->id = htons(flow->packets_nr);
+	ipv4->frag_off = 0;
+	ipv4->ttl = 64;
+	ipv4->protocol = ROHC_IPPROTO_UDP;
+	ipv4->check = 0;
+	ipv4->saddr = htonl(0x0a000000 | (flow->id & 0x00ffffff));
+	ipv4->daddr = htonl(0xc0a80001);
+	ipv4->check = ip_fast_csum((uint8_t *) ipv4, ipv4->ihl);
+
+	udp->source = htons(10000 + (flow->id >> 24));
+	udp->dest = htons(20000);
+	udp->len = htons(len - sizeof(struct ipv4_hdr));
+	udp->check = 0; /* UDP checksum disabled */
+
+	memset(payload, flow->packets_nr & 0xff, PERF_SOAK_PAYLOAD_LEN);
+
+	flow->packets_nr++;
+	soak->next_flow = (soak->next_flow + 1) % soak->flows_nr;
+
+	return len;
+}
+
+
+/**
+ * @brief Copy the next IP packet of the capture for the soak test
+ *
+ * The source address of the packet is changed with the number of the pass
+ * on the capture, so that every pass brings new flows. The packets that are
+ * not IPv4 or IPv6 ones are skipped.
+ *
+ * @param soak     The soak test
+ * @param buf      The buffer to copy the IP packet in
+ * @param buf_max  The size of the buffer
+ * @return         The length of the IP packet, 0 if the capture contains no
+ *                 IP packet
+ */
+static size_t perf_soak_capture_packet(struct perf_soak *const soak,
+                                       uint8_t *const buf,
+                                       const size_t buf_max)
+{
+	const size_t link_len = soak->capture.link_len;
+	size_t tries_nr;
+
+	for(tries_nr = 0; tries_nr < soak->capture.packets_nr; tries_nr++)
+	{
+		const struct perf_packet *const packet =
+			&(soak->capture.packets[soak->capture_pos]);
+		const uint8_t *const ip = packet->data + link_len;
+		const uint32_t pass = soak->capture_pass;
+		size_t ip_len;
+		size_t len = 0;
+
+		soak->capture_pos++;
+		if(soak->capture_pos >= soak->capture.packets_nr)
+		{
+			soak->capture_pos = 0;
+			soak->capture_pass++;
+		}
+
+		if(packet->header.caplen <= link_len)
+		{
+			continue;
+		}
+		ip_len = packet->header.caplen - link_len;
+
+		/* ignore the Ethernet padding, change the source address */
+		if(ip_len >= sizeof(struct ipv4_hdr) && (ip[0] >> 4) == 4)
+		{
+			struct ipv4_hdr *const ipv4 = (struct ipv4_hdr *) buf;
+
+			len = ntohs(((const struct ipv4_hdr *) ip)->tot_len);
+			if(len < sizeof(struct ipv4_hdr) || len > ip_len || len > buf_max)
+			{
+				continue;
+			}
+			memcpy(buf, ip, len);
+			ipv4->saddr ^= htonl(pass << 8);
+			ipv4->check = 0;
+			ipv4->check = ip_fast_csum(buf, ipv4->ihl);
+		}
+		else if(ip_len >= sizeof(struct ipv6_hdr) && (ip[0] >> 4) == 6)
+		{
+			struct ipv6_hdr *const ipv6 = (struct ipv6_hdr *) buf;
+
+			len = sizeof(struct ipv6_hdr) +
+			      ntohs(((const struct ipv6_hdr *) ip)->plen);
+			if(len > ip_len || len > buf_max)
+			{
+				continue;
+			}
+			memcpy(buf, ip, len);
+			ipv6->saddr.u32[2] ^= htonl(pass);
+		}
+		else
+		{
+			continue;
+		}
+
+		return len;
+	}
+
+	return 0;
+}
+
+
+/**
+ * @brief Sample the state of the soak test and print it
+ *
+ * The packet counters of the library are checked against the ones of the
+ * program, so that a counter that overflows is detected.
+ *
+ * @param soak        The soak test
+ * @param comp        The ROHC compressor
+ * @param decomp      The ROHC decompressor
+ * @param start_time  The time the test started (in ns)
+ * @param prev        The previous sample, the rates are computed since it
+ * @param sample      OUT: the new sample
+ * @param is_summary  Whether the sample sums up the whole test
+ * @return            true if the sample was printed,
+ *                    false if the counters of the library are wrong
+ */
+static bool perf_soak_sample(const struct perf_soak *const soak,
+                             const struct rohc_comp *const comp,
+                             const struct rohc_decomp *const decomp,
+                             const uint64_t start_time,
+                             const struct perf_soak_sample *const prev,
+                             struct perf_soak_sample *const sample,
+                             const bool is_summary)
+{
+	rohc_comp_general_info_t comp_info;
+	rohc_decomp_general_info_t decomp_info;
+	double period;
+
+	memset(&comp_info, 0, sizeof(rohc_comp_general_info_t));
+	comp_info.version_major = 0;
+	comp_info.version_minor = 3;
+	memset(&decomp_info, 0, sizeof(rohc_decomp_general_info_t));
+	decomp_info.version_major = 0;
+	decomp_info.version_minor = 2;
+	if(!rohc_comp_get_general_info(comp, &comp_info) ||
+	   !rohc_decomp_get_general_info(decomp, &decomp_info))
+	{
+		fprintf(stderr, "failed to get the state of the (de)compressor\n");
+		goto error;
+	}
+
+	/* every packet was given to the compressor, the packets that failed to
+	 * be compressed were not given to the decompressor */
+	if(comp_info.packets_nr64 != soak->packets_nr ||
+	   decomp_info.packets_nr64 != (soak->packets_nr - soak->comp_failures_nr))
+	{
+		fprintf(stderr, "packet counters of the library are wrong after "
+		        "%" PRIu64 " packets: %" PRIu64 " compressed and %" PRIu64
+		        " decompressed\n", soak->packets_nr, comp_info.packets_nr64,
+		        decomp_info.packets_nr64);
+		goto error;
+	}
+
+	sample->time = perf_now_ns();
+	sample->packets_nr = soak->packets_nr;
+	sample->comp_created_nr = comp_info.ctxts_misses_nr;
+	sample->comp_recycled_nr = comp_info.ctxts_recycled_nr;
+	sample->decomp_destroyed_nr = soak->decomp_destroyed_nr;
+	period = (sample->time - prev->time) / 1e9;
+	if(period <= 0)
+	{
+		period = 1e-9;
+	}
+
+	if(is_summary)
+	{
+		printf("SOAK\tall");
+	}
+	else
+	{
+		printf("SOAK\t%.0f", (sample->time - start_time) / 1e9);
+	}
+	printf("\t%" PRIu64 "\t%.0f\t%lu\t%zu\t%zu\t%.1f\t%.1f\t%.1f\t%" PRIu64
+	       "\t%" PRIu64 "\n", sample->packets_nr,
+	       (sample->packets_nr - prev->packets_nr) / period,
+	       perf_soak_rss_kb(), comp_info.contexts_nr, decomp_info.contexts_nr,
+	       (sample->comp_created_nr - prev->comp_created_nr) / period,
+	       (sample->comp_recycled_nr - prev->comp_recycled_nr) / period,
+	       (sample->decomp_destroyed_nr - prev->decomp_destroyed_nr) / period,
+	       soak->comp_failures_nr, soak->decomp_failures_nr);
+	fflush(stdout);
+
+	return true;
+
+error:
+	return false;
+}
+
+
+/**
+ * @brief Get the resident memory of the program
+ *
+ * @return  The resident memory (in KB), 0 if unknown
+ */
+static unsigned long perf_soak_rss_kb(void)
+{
+	unsigned long rss_kb = 0;
+#if defined(__linux__)
+	unsigned long size;
+	unsigned long resident;
+	FILE *statm;
+
+	statm = fopen("/proc/self/statm", "r");
+	if(statm != NULL)
+	{
+		if(fscanf(statm, "%lu %lu", &size, &resident) == 2)
+		{
+			rss_kb = resident * (sysconf(_SC_PAGESIZE) / 1024);
+		}
+		fclose(statm);
+	}
+#endif
+	return rss_kb;
+}
+
+
+/**
+ * @brief Count the contexts destroyed by the decompressor of the soak test
+ *
+ * @param priv_ctxt  The soak test
+ * @param info       The description of the event
+ */
+static void perf_soak_decomp_event(void *const priv_ctxt,
+                                   const rohc_decomp_event_info_t *const info)
+{
+	struct perf_soak *const soak = priv_ctxt;
+
+	if(info->event == ROHC_DECOMP_EVENT_CTXT_DESTROY)
+	{
+		soak->decomp_destroyed_nr++;
+	}
+}
+
+
+/**
+ * @brief Load all the packets of the given capture in memory
+ *
+ * The packets are copied in one contiguous buffer, in the order of the
+ * capture: the capture is read twice, once to size the buffer, once to fill
+ * it. The hash of the flow of every packet is computed once for all.
+ *
+ * @param test      The test to load the packets for
+ * @param filename  The name of the PCAP file that contains the packets
+ * @return          true if the capture was loaded, false otherwise
+ */
+static bool perf_load_capture(struct perf_test *const test,
+                              char *filename)
+{
+	pcap_t *handle;
+	char errbuf[PCAP_ERRBUF_SIZE];
+	int link_layer_type;
+	struct pcap_pkthdr header;
+	unsigned char *packet;
+	size_t packets_max = 0;
+	size_t data_len = 0;
+	size_t data_max = 0;
+
+	test->packets = NULL;
+	test->packets_nr = 0;
+	test->packets_data = NULL;
+
+	/* open the PCAP file that contains the stream */
+	handle = pcap_open_offline(filename, errbuf);
+	if(handle == NULL)
+	{
+		fprintf(stderr, "failed to open the pcap file: %s\n", errbuf);
+		goto error;
+	}
+
+	/* link layer in the capture must be Ethernet */
+	link_layer_type = pcap_datalink(handle);
+	if(link_layer_type == DLT_EN10MB)
+	{
+		test->link_len = ETHER_HDR_LEN;
+	}
+	else if(link_layer_type == DLT_LINUX_SLL)
+	{
+		test->link_len = LINUX_COOKED_HDR_LEN;
+	}
+	else if(link_layer_type == DLT_RAW)
+	{
+		test->link_len = 0;
+	}
+	else
+	{
+		fprintf(stderr, "link layer type %d not supported in capture "
+		        "(supported = %d, %d, %d)\n", link_layer_type,
+		        DLT_EN10MB, DLT_LINUX_SLL, DLT_RAW);
+		goto close_input;
+	}
+
+	/* count the packets and their bytes */
+	while(pcap_next(handle, &header) != NULL)
+	{
+		packets_max++;
+		data_max += header.caplen;
+	}
+	pcap_close(handle);
+
+	test->packets = malloc((packets_max > 0 ? packets_max : 1) *
+	                       sizeof(struct perf_packet));
+	test->packets_data = malloc(data_max > 0 ? data_max : 1);
+	if(test->packets == NULL || test->packets_data == NULL)
+	{
+		fprintf(stderr, "failed to allocate memory for %zu packets of %zu "
+		        "bytes\n", packets_max, data_max);
+		goto free_packets;
+	}
+
+	/* read the capture again to copy every packet of the dump */
+	handle = pcap_open_offline(filename, errbuf);
+	if(handle == NULL)
+	{
+		fprintf(stderr, "failed to open the pcap file: %s\n", errbuf);
+		goto free_packets;
+	}
+	while(test->packets_nr < packets_max &&
+	      (packet = (unsigned char *) pcap_next(handle, &header)) != NULL)
+	{
+		struct perf_packet *const new_packet = &(test->packets[test->packets_nr]);
+
+		if(header.caplen > (data_max - data_len))
+		{
+			fprintf(stderr, "packet %zu: capture changed while loaded\n",
+			        test->packets_nr + 1);
+			goto close_packets;
+		}
+		new_packet->num = test->packets_nr + 1;
+		new_packet->header = header;
+		new_packet->data = test->packets_data + data_len;
+		memcpy(new_packet->data, packet, header.caplen);
+		data_len += header.caplen;
+
+		/* identify the flow of the packet */
+		if(header.caplen <= test->link_len)
+		{
+			new_packet->flow_hash = 0;
+		}
+		else if(test->is_comp)
+		{
+			new_packet->flow_hash =
+				perf_ip_flow_hash(packet + test->link_len,
+				                  header.caplen - test->link_len);
+		}
+		else
+		{
+			new_packet->flow_hash =
+				perf_rohc_flow_hash(packet + test->link_len,
+				                    header.caplen - test->link_len,
+				                    test->cid_type);
+		}
+
+		test->packets_nr++;
+	}
+
+	pcap_close(handle);
+	return true;
+
+close_packets:
+	pcap_close(handle);
+free_packets:
+	perf_free_capture(test);
+error:
+	return false;
+close_input:
+	pcap_close(handle);
+	return false;
+}
+
+
+/**
+ * @brief Free the packets of the capture loaded in memory
+ *
+ * @param test  The test to free the packets for
+ */
+static void perf_free_capture(struct perf_test *const test)
+{
+	free(test->packets_data);
+	test->packets_data = NULL;
+	free(test->packets);
+	test->packets = NULL;
+	test->packets_nr = 0;
+}
+
+
+/**
+ * @brief Update a FNV-1a hash with some bytes
+ *
+ * @param hash  The hash to update
+ * @param data  The bytes to hash
+ * @param len   The number of bytes to hash
+ * @return      The updated hash
+ */
+static uint32_t perf_hash_bytes(uint32_t hash,
+                                const unsigned char *const data,
+                                const size_t len)
+{
+	size_t i;
+
+	for(i = 0; i < len; i++)
+	{
+		hash ^= data[i];
+		hash *= 16777619U;
+	}
+
+	return hash;
+}
+
+
+/**
+ * @brief Compute the hash of the flow of one uncompressed packet
+ *
+ * The flow is identified by the addresses and protocol of the outer IP
+ * header, and by the ports for TCP, UDP and UDP-Lite.
+ *
+ * @param data  The IP packet
+ * @param len   The length of the IP packet
+ * @return      The hash of the flow of the packet
+ */
+static uint32_t perf_ip_flow_hash(const unsigned char *const data,
+                                  const size_t len)
+{
+	const uint8_t ip_version = (data[0] >> 4) & 0x0f;
+	uint32_t hash = 2166136261U;
+	size_t ports_offset = 0;
+	uint8_t protocol;
+
+	if(ip_version == 4 && len >= sizeof(struct ipv4_hdr))
+	{
+		const struct ipv4_hdr *const ip = (struct ipv4_hdr *) data;
+
+		hash = perf_hash_bytes(hash, (unsigned char *) &ip->saddr,
+		                       sizeof(uint32_t) * 2);
+		protocol = ip->protocol;
+		if((ntohs(ip->frag_off) & (IPV4_MF | IPV4_OFFMASK)) == 0)
+		{
+			ports_offset = ip->ihl * sizeof(uint32_t);
+		}
+	}
+	else if(ip_version == 6 && len >= sizeof(struct ipv6_hdr))
+	{
+		const struct ipv6_hdr *const ip = (struct ipv6_hdr *) data;
+
+		hash = perf_hash_bytes(hash, (unsigned char *) &ip->saddr,
+		                       sizeof(struct ipv6_addr) * 2);
+		protocol = ip->nh;
+		ports_offset = sizeof(struct ipv6_hdr);
+	}
+	else
+	{
+		/* not an IP packet, put it in the first flow */
+		return 0;
+	}
+	hash = perf_hash_bytes(hash, &protocol, sizeof(uint8_t));
+
+	/* the ports of TCP, UDP and UDP-Lite are the first 4 bytes */
+	if((protocol == ROHC_IPPROTO_TCP || protocol == ROHC_IPPROTO_UDP ||
+	    protocol == ROHC_IPPROTO_UDPLITE) &&
+	   ports_offset > 0 && (ports_offset + 4) <= len)
+	{
+		hash = perf_hash_bytes(hash, data + ports_offset, 4);
+	}
+
+	/* mix the bits, so that the low bits used to select the thread depend
+	 * on all the fields */
+	hash ^= hash >> 16;
+	hash *= 0x85ebca6bU;
+	hash ^= hash >> 13;
+	hash *= 0xc2b2ae35U;
+	hash ^= hash >> 16;
+
+	return hash;
+}
+
+
+/**
+ * @brief Compute the hash of the flow of one ROHC packet
+ *
+ * The flow is identified by the CID of the ROHC packet.
+ *
+ * @param data      The ROHC packet
+ * @param len       The length of the ROHC packet
+ * @param cid_type  The type of CIDs used by the ROHC packet
+ * @return          The CID of the ROHC packet
+ */
+static uint32_t perf_rohc_flow_hash(const unsigned char *const data,
+                                    const size_t len,
+                                    const rohc_cid_type_t cid_type)
+{
+	size_t offset = 0;
+	uint32_t cid = 0;
+
+	/* skip padding */
+	while(offset < len && data[offset] == 0xe0)
+	{
+		offset++;
+	}
+
+	if(cid_type == ROHC_SMALL_CID)
+	{
+		/* small CID: optional Add-CID octet */
+		if(offset < len && (data[offset] & 0xf0) == 0xe0)
+		{
+			cid = data[offset] & 0x0f;
+		}
+	}
+	else if((offset + 1) < len)
+	{
+		/* large CID: 1 or 2 SDVL-encoded octets after the first octet */
+		const uint8_t cid_byte = data[offset + 1];
+
+		if((cid_byte & 0x80) == 0)
+		{
+			cid = cid_byte & 0x7f;
+		}
+		else if((cid_byte & 0xc0) == 0x80 && (offset + 2) < len)
+		{
+			cid = ((cid_byte & 0x3f) << 8) | data[offset + 2];
+		}
+	}
+
+	return cid;
+}
+
+
+/**
+ * @brief Run one scaling test with the given number of threads
+ *
+ * @param test           The parameters of the test
+ * @param threads_nr     The number of threads to shard the flows across
+ * @param print_details  Whether to print the latencies and counters if
+ *                       recorded
+ * @param mpps           OUT: the aggregate throughput (in Mpps)
+ * @return               true if the test succeeded, false otherwise
+ */
+static bool perf_run_threads(const struct perf_test *const test,
+                             const size_t threads_nr,
+                             const bool print_details,
+                             double *const mpps)
+{
+	const char *const action = (test->is_comp ? "compression" : "decompression");
+	struct perf_thread threads[PERF_THREADS_MAX];
+	const struct perf_packet **shards;
+	struct perf_start start_gate;
+	size_t threads_started;
+	struct timespec start;
+	struct timespec end;
+	double elapsed;
+	bool is_success = false;
+	size_t i;
+
+	assert(threads_nr > 0);
+	assert(threads_nr <= PERF_THREADS_MAX);
+
+	/* shard the flows of packets across the threads */
+	shards = malloc(test->packets_nr * sizeof(struct perf_packet *));
+	if(shards == NULL && test->packets_nr > 0)
+	{
+		fprintf(stderr, "failed to allocate memory for %zu packets\n",
+		        test->packets_nr);
+		goto error;
+	}
+	for(i = 0; i < threads_nr; i++)
+	{
+		threads[i].test = test;
+		threads[i].start_gate = &start_gate;
+		threads[i].id = i;
+		threads[i].cpu = -1;
+		threads[i].packets_nr = 0;
+		threads[i].latency = NULL;
+		perf_counters_init(&(threads[i].counters));
+		threads[i].status = 1;
+	}
+
+	/* one set of histograms of latencies per thread if requested */
+	if(test->latency_format != PERF_LATENCY_NONE)
+	{
+		for(i = 0; i < threads_nr; i++)
+		{
+			threads[i].latency = calloc(1, sizeof(struct perf_latency));
+			if(threads[i].latency == NULL)
+			{
+				fprintf(stderr, "failed to allocate memory for latencies\n");
+				goto free_latencies;
+			}
+		}
+	}
+	for(i = 0; i < test->packets_nr; i++)
+	{
+		threads[test->packets[i].flow_hash % threads_nr].packets_nr++;
+	}
+	threads[0].packets = shards;
+	for(i = 1; i < threads_nr; i++)
+	{
+		threads[i].packets = threads[i - 1].packets + threads[i - 1].packets_nr;
+	}
+	for(i = 0; i < threads_nr; i++)
+	{
+		threads[i].packets_nr = 0;
+	}
+	for(i = 0; i < test->packets_nr; i++)
+	{
+		struct perf_thread *const thread =
+			&(threads[test->packets[i].flow_hash % threads_nr]);
+		thread->packets[thread->packets_nr] = &(test->packets[i]);
+		thread->packets_nr++;
+	}
+
+	/* create all the threads, they wait for the gate to open */
+	pthread_mutex_init(&start_gate.lock, NULL);
+	pthread_cond_init(&start_gate.cond, NULL);
+	start_gate.ready_nr = 0;
+	start_gate.is_open = false;
+	start_gate.is_aborted = false;
+	for(threads_started = 0; threads_started < threads_nr; threads_started++)
+	{
+		if(pthread_create(&(threads[threads_started].thread), NULL,
+		                  perf_thread_run, &(threads[threads_started])) != 0)
+		{
+			fprintf(stderr, "failed to create thread #%zu\n", threads_started + 1);
+			start_gate.is_aborted = true;
+			break;
+		}
+	}
+
+	/* open the gate once all the threads are ready */
+	pthread_mutex_lock(&start_gate.lock);
+	while(!start_gate.is_aborted && start_gate.ready_nr < threads_nr)
+	{
+		pthread_cond_wait(&start_gate.cond, &start_gate.lock);
+	}
+	start_gate.is_open = true;
+	pthread_cond_broadcast(&start_gate.cond);
+	pthread_mutex_unlock(&start_gate.lock);
+
+	/* wait for all the threads to complete */
+	for(i = 0; i < threads_started; i++)
+	{
+		pthread_join(threads[i].thread, NULL);
+	}
+	pthread_cond_destroy(&start_gate.cond);
+	pthread_mutex_destroy(&start_gate.lock);
+	if(start_gate.is_aborted)
+	{
+		goto free_latencies;
+	}
+
+	/* report the throughput of every thread */
+	for(i = 0; i < threads_nr; i++)
+	{
+		if(threads[i].status != 0)
+		{
+			fprintf(stderr, "thread #%zu: performance test failed\n", i + 1);
+			goto free_latencies;
+		}
+	}
+	printf("%s with %zu thread(s):\n", action, threads_nr);
+	for(i = 0; i < threads_nr; i++)
+	{
+		const size_t packets_nr = threads[i].packets_nr * test->repeat_nr;
+
+		elapsed = perf_elapsed(&(threads[i].start), &(threads[i].end));
+		printf("  thread #%zu (CPU %d): %zu packets in %.6f s, %.3f Mpps\n",
+		       i + 1, threads[i].cpu, packets_nr, elapsed,
+		       (elapsed > 0 ? packets_nr / elapsed / 1e6 : 0.0));
+	}
+
+	/* the aggregate throughput from the first start to the last stop */
+	start = threads[0].start;
+	end = threads[0].end;
+	for(i = 1; i < threads_nr; i++)
+	{
+		if(perf_elapsed(&(threads[i].start), &start) > 0)
+		{
+			start = threads[i].start;
+		}
+		if(perf_elapsed(&end, &(threads[i].end)) > 0)
+		{
+			end = threads[i].end;
+		}
+	}
+	elapsed = perf_elapsed(&start, &end);
+	*mpps = (elapsed > 0 ? test->packets_nr * test->repeat_nr / elapsed / 1e6 : 0.0);
+	printf("  aggregate: %zu packets in %.6f s, %.3f Mpps\n",
+	       test->packets_nr * test->repeat_nr, elapsed, *mpps);
+	fflush(stdout);
+
+	/* the counters of all the threads together */
+	if(print_details && test->with_counters)
+	{
+		for(i = 1; i < threads_nr; i++)
+		{
+			perf_counters_merge(&(threads[0].counters), &(threads[i].counters));
+		}
+		perf_counters_print(&(threads[0].counters), test->is_comp, threads_nr,
+		                    test->packets_nr * test->repeat_nr);
+	}
+
+	/* the latencies of all the threads together */
+	if(print_details && test->latency_format != PERF_LATENCY_NONE)
+	{
+		for(i = 1; i < threads_nr; i++)
+		{
+			perf_latency_merge(threads[0].latency, threads[i].latency);
+		}
+		perf_latency_print(threads[0].latency, test->latency_format,
+		                   (test->is_comp ? "compression" : "decompression"),
+		                   threads_nr);
+	}
+
+	is_success = true;
+
+free_latencies:
+	for(i = 0; i < threads_nr; i++)
+	{
+		free(threads[i].latency);
+	}
+	free(shards);
+error:
+	return is_success;
+}
+
+
+/**
+ * @brief Process the flows of one thread of the scaling test
+ *
+ * @param arg  The thread to run
+ * @return     Always NULL, see the status of the thread
+ */
+static void * perf_thread_run(void *const arg)
+{
+	const struct rohc_ts arrival_time = { .sec = 0, .nsec = 0 };
+	struct perf_thread *const thread = (struct perf_thread *) arg;
+	const struct perf_test *const test = thread->test;
+	struct rohc_comp *comp = NULL;
+	struct rohc_decomp *decomp = NULL;
+	struct perf_start *const start_gate = thread->start_gate;
+	bool is_ready;
+	size_t round;
+	size_t i;
+
+#if HAVE_PTHREAD_SETAFFINITY_NP == 1
+	/* pin the thread to one CPU core */
+	{
+		const long cpus_nr = sysconf(_SC_NPROCESSORS_ONLN);
+		const int cpu = (cpus_nr > 0 ? (int) (thread->id % cpus_nr) : 0);
+		cpu_set_t cpus;
+
+		CPU_ZERO(&cpus);
+		CPU_SET(cpu, &cpus);
+		if(pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpus) != 0)
+		{
+			fprintf(stderr, "thread #%zu: failed to pin thread to CPU %d\n",
+			        thread->id + 1, cpu);
+		}
+		else
+		{
+			thread->cpu = cpu;
+		}
+	}
+#endif
+
+	/* create the (de)compressor once pinned, so that its memory is local
+	 * to the CPU core */
+	if(test->is_comp)
+	{
+		comp = create_compressor(&test->is_verbose, test->cid_type,
+		                         test->wlsb_width, test->max_contexts,
+		                         test->numa_node);
+		is_ready = (comp != NULL);
+	}
+	else
+	{
+		decomp = create_decompressor(&test->is_verbose, test->cid_type,
+		                             test->max_contexts, ROHC_U_MODE,
+		                             test->numa_node);
+		is_ready = (decomp != NULL);
+	}
+
+	/* open the hardware counters of the thread if requested */
+	if(is_ready && test->with_counters && !perf_counters_open(&thread->counters))
+	{
+		is_ready = false;
+	}
+
+	/* all the threads start at the same time */
+	pthread_mutex_lock(&start_gate->lock);
+	start_gate->ready_nr++;
+	pthread_cond_broadcast(&start_gate->cond);
+	while(!start_gate->is_open)
+	{
+		pthread_cond_wait(&start_gate->cond, &start_gate->lock);
+	}
+	is_ready = (is_ready && !start_gate->is_aborted);
+	pthread_mutex_unlock(&start_gate->lock);
+	if(!is_ready)
+	{
+		goto close_counters;
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &thread->start);
+	if(test->with_counters)
+	{
+		perf_counters_start(&thread->counters);
+	}
+	for(round = 0; round < test->repeat_nr; round++)
+	{
+		for(i = 0; i < thread->packets_nr; i++)
+		{
+			const struct perf_packet *const packet = thread->packets[i];
+			int ret;
+
+			if(test->is_comp)
+			{
+				ret = time_compress_packet(comp, packet->num, packet->header,
+				                           packet->data, test->link_len,
+				                           thread->latency);
+			}
+			else
+			{
+				ret = time_decompress_packet(decomp, packet->num, packet->header,
+				                             packet->data, test->link_len,
+				                             arrival_time, thread->latency);
+			}
+			if(ret != 0)
+			{
+				fprintf(stderr, "packet %lu: performance test failed\n",
+				        packet->num);
+				goto close_counters;
+			}
+		}
+	}
+	if(test->with_counters)
+	{
+		perf_counters_stop(&thread->counters);
+	}
+	clock_gettime(CLOCK_MONOTONIC, &thread->end);
+
+	/* everything went fine */
+	thread->status = 0;
+
+close_counters:
+	if(test->with_counters)
+	{
+		perf_counters_close(&thread->counters);
+	}
+	if(comp != NULL)
+	{
+		rohc_comp_free(comp);
+	}
+	if(decomp != NULL)
+	{
+		rohc_decomp_free(decomp);
+	}
+	return NULL;
+}
+
+
+/**
+ * @brief Compute the time elapsed between two timestamps
+ *
+ * @param start  The first timestamp
+ * @param end    The second timestamp
+ * @return       The elapsed time (in seconds), negative if the second
+ *               timestamp is before the first one
+ */
+static double perf_elapsed(const struct timespec *const start,
+                           const struct timespec *const end)
+{
+	return (end->tv_sec - start->tv_sec) +
+	       (end->tv_nsec - start->tv_nsec) / 1e9;
+}
+
+
+
+/**
+ * @brief Read the monotonic clock
+ *
+ * @return  The current time (in nanoseconds)
+ */
+static uint64_t perf_now_ns(void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return ((uint64_t) now.tv_sec) * 1000000000U + now.tv_nsec;
+}
+
+
+/**
+ * @brief Get the bucket of a latency histogram for one value
+ *
+ * @param value  The value
+ * @return       The index of the bucket
+ */
+static size_t perf_latency_bucket(const uint64_t value)
+{
+	size_t power;
+
+	if(value < PERF_LATENCY_SUBS_NR)
+	{
+		return value;
+	}
+
+	power = 63 - __builtin_clzll(value);
+	if(power >= PERF_LATENCY_POWERS_NR)
+	{
+		return PERF_LATENCY_BUCKETS_NR - 1;
+	}
+
+	return (power - PERF_LATENCY_SUB_BITS + 1) * PERF_LATENCY_SUBS_NR +
+	       ((value >> (power - PERF_LATENCY_SUB_BITS)) - PERF_LATENCY_SUBS_NR);
+}
+
+
+/**
+ * @brief Get the largest value of one bucket of a latency histogram
+ *
+ * @param bucket  The index of the bucket
+ * @return        The largest value that belongs to the bucket
+ */
+static uint64_t perf_latency_bucket_max(const size_t bucket)
+{
+	size_t power;
+	uint64_t sub;
+
+	if(bucket < PERF_LATENCY_SUBS_NR)
+	{
+		return bucket;
+	}
+
+	power = bucket / PERF_LATENCY_SUBS_NR + PERF_LATENCY_SUB_BITS - 1;
+	sub = bucket % PERF_LATENCY_SUBS_NR + PERF_LATENCY_SUBS_NR;
+
+	return ((sub + 1) << (power - PERF_LATENCY_SUB_BITS)) - 1;
+}
+
+
+/**
+ * @brief Add one value to a latency histogram
+ *
+ * @param histo  The histogram to update
+ * @param value  The value to add
+ */
+static void perf_latency_histo_add(struct perf_latency_histo *const histo,
+                                   const uint64_t value)
+{
+	histo->count++;
+	if(value > histo->max)
+	{
+		histo->max = value;
+	}
+	histo->buckets[perf_latency_bucket(value)]++;
+}
+
+
+/**
+ * @brief Add the latency of one (de)compression call
+ *
+ * @param latency      The latencies to update
+ * @param packet_type  The type of the ROHC packet
+ * @param duration     The duration of the call (in nanoseconds)
+ */
+static void perf_latency_add(struct perf_latency *const latency,
+                             const rohc_packet_t packet_type,
+                             const uint64_t duration)
+{
+	perf_latency_histo_add(&latency->all, duration);
+	if(packet_type == ROHC_PACKET_IR || packet_type == ROHC_PACKET_IR_DYN)
+	{
+		perf_latency_histo_add(&latency->ir, duration);
+	}
+	else
+	{
+		perf_latency_histo_add(&latency->co, duration);
+	}
+	if(packet_type < ROHC_PACKET_MAX)
+	{
+		perf_latency_histo_add(&latency->types[packet_type], duration);
+	}
+}
+
+
+/**
+ * @brief Merge one latency histogram into another one
+ *
+ * @param histo  The histogram to update
+ * @param other  The histogram to merge
+ */
+static void perf_latency_histo_merge(struct perf_latency_histo *const histo,
+                                     const struct perf_latency_histo *const other)
+{
+	size_t i;
+
+	histo->count += other->count;
+	if(other->max > histo->max)
+	{
+		histo->max = other->max;
+	}
+	for(i = 0; i < PERF_LATENCY_BUCKETS_NR; i++)
+	{
+		histo->buckets[i] += other->buckets[i];
+	}
+}
+
+
+/**
+ * @brief Merge the latencies of one thread into the latencies of another one
+ *
+ * @param latency  The latencies to update
+ * @param other    The latencies to merge
+ */
+static void perf_latency_merge(struct perf_latency *const latency,
+                               const struct perf_latency *const other)
+{
+	size_t i;
+
+	perf_latency_histo_merge(&latency->all, &other->all);
+	perf_latency_histo_merge(&latency->ir, &other->ir);
+	perf_latency_histo_merge(&latency->co, &other->co);
+	for(i = 0; i < ROHC_PACKET_MAX; i++)
+	{
+		perf_latency_histo_merge(&latency->types[i], &other->types[i]);
+	}
+}
+
+
+/**
+ * @brief Get one percentile of a latency histogram
+ *
+ * @param histo       The histogram
+ * @param percentile  The percentile to get, between 0 and 100
+ * @return            The value of the percentile
+ */
+static uint64_t perf_latency_percentile(const struct perf_latency_histo *const histo,
+                                        const double percentile)
+{
+	uint64_t rank = (uint64_t) ((histo->count * percentile) / 100.0 + 0.5);
+	uint64_t seen = 0;
+	size_t i;
+
+	if(rank == 0)
+	{
+		rank = 1;
+	}
+	for(i = 0; i < PERF_LATENCY_BUCKETS_NR; i++)
+	{
+		seen += histo->buckets[i];
+		if(seen >= rank)
+		{
+			const uint64_t value = perf_latency_bucket_max(i);
+			return (value < histo->max ? value : histo->max);
+		}
+	}
+
+	return histo->max;
+}
+
+
+/**
+ * @brief Print the percentiles of one latency histogram
+ *
+ * @param histo    The histogram
+ * @param format   The output format
+ * @param action   The action that was timed: compression or decompression
+ * @param group    The group of the histogram: all, class or packet_type
+ * @param name     The name of the histogram in the group
+ * @param is_first Whether the histogram is the first one printed
+ */
+static void perf_latency_print_histo(const struct perf_latency_histo *const histo,
+                                     const perf_latency_format_t format,
+                                     const char *const action,
+                                     const char *const group,
+                                     const char *const name,
+                                     const bool is_first)
+{
+	const unsigned long p50 = perf_latency_percentile(histo, 50.0);
+	const unsigned long p99 = perf_latency_percentile(histo, 99.0);
+	const unsigned long p999 = perf_latency_percentile(histo, 99.9);
+	const unsigned long max = histo->max;
+	const unsigned long count = histo->count;
+
+	switch(format)
+	{
+		case PERF_LATENCY_TEXT:
+			printf("  %-12s %-20s %10lu %10lu %10lu %10lu %10lu\n", group, name,
+			       count, p50, p99, p999, max);
+			break;
+		case PERF_LATENCY_JSON:
+			printf("%s    { \"group\": \"%s\", \"name\": \"%s\", \"count\": %lu, "
+			       "\"p50\": %lu, \"p99\": %lu, \"p99.9\": %lu, \"max\": %lu }",
+			       (is_first ? "" : ",\n"), group, name, count, p50, p99, p999,
+			       max);
+			break;
+		case PERF_LATENCY_CSV:
+			printf("%s,%s,%s,%lu,%lu,%lu,%lu,%lu\n", action, group, name, count,
+			       p50, p99, p999, max);
+			break;
+		case PERF_LATENCY_NONE:
+		default:
+			break;
+	}
+}
+
+
+/**
+ * @brief Print the percentiles of the latencies of (de)compression calls
+ *
+ * The histograms without any value are skipped, except the one for all the
+ * packets.
+ *
+ * @param latency     The latencies
+ * @param format      The output format
+ * @param action      The name of the timed action
+ * @param threads_nr  The number of threads that recorded the latencies
+ */
+static void perf_latency_print(const struct perf_latency *const latency,
+                               const perf_latency_format_t format,
+                               const char *const action,
+                               const size_t threads_nr)
+{
+	size_t i;
+
+	switch(format)
+	{
+		case PERF_LATENCY_TEXT:
+			printf("%s latencies with %zu thread(s) (in ns):\n", action, threads_nr);
+			printf("  %-12s %-20s %10s %10s %10s %10s %10s\n", "group", "name",
+			       "count", "p50", "p99", "p99.9", "max");
+			break;
+		case PERF_LATENCY_JSON:
+			printf("{\n  \"action\": \"%s\",\n  \"threads\": %zu,\n"
+			       "  \"unit\": \"ns\",\n  \"latencies\": [\n", action, threads_nr);
+			break;
+		case PERF_LATENCY_CSV:
+			printf("action,group,name,count,p50_ns,p99_ns,p99.9_ns,max_ns\n");
+			break;
+		case PERF_LATENCY_NONE:
+		default:
+			return;
+	}
+
+	perf_latency_print_histo(&latency->all, format, action, "all", "all", true);
+	if(latency->ir.count > 0)
+	{
+		perf_latency_print_histo(&latency->ir, format, action, "class", "IR", false);
+	}
+	if(latency->co.count > 0)
+	{
+		perf_latency_print_histo(&latency->co, format, action, "class", "CO", false);
+	}
+	for(i = 0; i < ROHC_PACKET_MAX; i++)
+	{
+		if(latency->types[i].count > 0)
+		{
+			perf_latency_print_histo(&latency->types[i], format, action,
+			                         "packet_type", rohc_get_packet_descr(i),
+			                         false);
+		}
+	}
+
+	if(format == PERF_LATENCY_JSON)
+	{
+		printf("\n  ]\n}\n");
+	}
+	fflush(stdout);
+}
+
+
+/**
+ * @brief Initialize the hardware performance counters as not opened
+ *
+ * @param counters  The counters to initialize
+ */
+static void perf_counters_init(struct perf_counters *const counters)
+{
+	size_t i;
+
+	for(i = 0; i < PERF_COUNTER_MAX; i++)
+	{
+		counters->fds[i] = -1;
+		counters->is_supported[i] = false;
+		counters->values[i] = 0;
+	}
+}
+
+
+/**
+ * @brief Open the hardware performance counters for the calling thread
+ *
+ * The counters that the CPU does not support are skipped. The counters are
+ * opened disabled, see \ref perf_counters_start.
+ *
+ * @param counters  The counters to open
+ * @return          true if at least one counter was opened, false otherwise
+ */
+static bool perf_counters_open(struct perf_counters *const counters)
+{
+#if HAVE_LINUX_PERF_EVENT_H == 1
+	const struct
+	{
+		uint32_t type;
+		uint64_t config;
+	} events[PERF_COUNTER_MAX] = {
+		[PERF_COUNTER_CYCLES] =
+			{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+		[PERF_COUNTER_INSTRUCTIONS] =
+			{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+		[PERF_COUNTER_CACHE_MISSES] =
+			{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+		[PERF_COUNTER_BRANCH_MISSES] =
+			{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+		[PERF_COUNTER_DTLB_MISSES] =
+			{ PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_DTLB |
+			                      (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+			                      (PERF_COUNT_HW_CACHE_RESULT_MISS << 16) },
+	};
+	size_t opened_nr = 0;
+	size_t i;
+
+	perf_counters_init(counters);
+
+	for(i = 0; i < PERF_COUNTER_MAX; i++)
+	{
+		struct perf_event_attr attr;
+
+		memset(&attr, 0, sizeof(struct perf_event_attr));
+		attr.size = sizeof(struct perf_event_attr);
+		attr.type = events[i].type;
+		attr.config = events[i].config;
+		attr.disabled = 1;
+		attr.exclude_kernel = 1;
+		attr.exclude_hv = 1;
+		attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED |
+		                   PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+		/* count the events of the calling thread on any CPU */
+		counters->fds[i] = syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+		if(counters->fds[i] >= 0)
+		{
+			counters->is_supported[i] = true;
+			opened_nr++;
+		}
+	}
+
+	if(opened_nr == 0)
+	{
+		fprintf(stderr, "failed to open the hardware performance counters: "
+		        "%s (see /proc/sys/kernel/perf_event_paranoid)\n",
+		        strerror(errno));
+		return false;
+	}
+
+	return true;
+#else
+	perf_counters_init(counters);
+	fprintf(stderr, "hardware performance counters are not supported on "
+	        "this platform\n");
+	return false;
+#endif
+}
+
+
+/**
+ * @brief Reset and start the hardware performance counters
+ *
+ * @param counters  The counters to start
+ */
+static void perf_counters_start(const struct perf_counters *const counters)
+{
+#if HAVE_LINUX_PERF_EVENT_H == 1
+	size_t i;
+
+	for(i = 0; i < PERF_COUNTER_MAX; i++)
+	{
+		if(counters->fds[i] >= 0)
+		{
+			ioctl(counters->fds[i], PERF_EVENT_IOC_RESET, 0);
+			ioctl(counters->fds[i], PERF_EVENT_IOC_ENABLE, 0);
+		}
+	}
+#else
+	(void) counters;
+#endif
+}
+
+
+/**
+ * @brief Stop and read the hardware performance counters
+ *
+ * The values are scaled if the kernel had to multiplex the counters.
+ *
+ * @param counters  The counters to stop
+ */
+static void perf_counters_stop(struct perf_counters *const counters)
+{
+#if HAVE_LINUX_PERF_EVENT_H == 1
+	size_t i;
+
+	for(i = 0; i < PERF_COUNTER_MAX; i++)
+	{
+		if(counters->fds[i] >= 0)
+		{
+			ioctl(counters->fds[i], PERF_EVENT_IOC_DISABLE, 0);
+		}
+	}
+	for(i = 0; i < PERF_COUNTER_MAX; i++)
+	{
+		/* value, time enabled, time running */
+		uint64_t data[3];
+
+		counters->values[i] = 0;
+		if(counters->fds[i] < 0 ||
+		   read(counters->fds[i], data, sizeof(data)) != sizeof(data))
+		{
+			continue;
+		}
+		if(data[2] > 0 && data[2] < data[1])
+		{
+			counters->values[i] = (uint64_t) (((double) data[0]) * data[1] / data[2]);
+		}
+		else
+		{
+			counters->values[i] = data[0];
+		}
+	}
+#else
+	(void) counters;
+#endif
+}
+
+
+/**
+ * @brief Close the hardware performance counters
+ *
+ * @param counters  The counters to close
+ */
+static void perf_counters_close(struct perf_counters *const counters)
+{
+	size_t i;
+
+	for(i = 0; i < PERF_COUNTER_MAX; i++)
+	{
+		if(counters->fds[i] >= 0)
+		{
+			close(counters->fds[i]);
+			counters->fds[i] = -1;
+		}
+	}
+}
+
+
+/**
+ * @brief Add the hardware counters of one thread to the ones of another thread
+ *
+ * A counter is kept only if it is supported by both threads.
+ *
+ * @param counters  The counters to update
+ * @param other     The counters to add
+ */
+static void perf_counters_merge(struct perf_counters *const counters,
+                                const struct perf_counters *const other)
+{
+	size_t i;
+
+	for(i = 0; i < PERF_COUNTER_MAX; i++)
+	{
+		if(!other->is_supported[i])
+		{
+			counters->is_supported[i] = false;
+		}
+		counters->values[i] += other->values[i];
+	}
+}
+
+
+/**
+ * @brief Print the hardware performance counters
+ *
+ * @param counters    The counters
+ * @param is_comp     Whether compression or decompression was measured
+ * @param threads_nr  The number of threads that were measured
+ * @param packets_nr  The number of packets (de)compressed by the threads
+ */
+static void perf_counters_print(const struct perf_counters *const counters,
+                                const bool is_comp,
+                                const size_t threads_nr,
+                                const unsigned long packets_nr)
+{
+	const char *const names[PERF_COUNTER_MAX] = {
+		[PERF_COUNTER_CYCLES]        = "cycles",
+		[PERF_COUNTER_INSTRUCTIONS]  = "instructions",
+		[PERF_COUNTER_CACHE_MISSES]  = "cache misses",
+		[PERF_COUNTER_BRANCH_MISSES] = "branch misses",
+		[PERF_COUNTER_DTLB_MISSES]   = "dTLB misses",
+	};
+	size_t i;
+
+	printf("%s hardware counters with %zu thread(s):\n",
+	       (is_comp ? "compression" : "decompression"), threads_nr);
+	for(i = 0; i < PERF_COUNTER_MAX; i++)
+	{
+		if(!counters->is_supported[i])
+		{
+			printf("  %-14s %16s\n", names[i], "not supported");
+		}
+		else
+		{
+			printf("  %-14s %16lu  (%.2f per packet)\n", names[i],
+			       (unsigned long) counters->values[i],
+			       (packets_nr > 0 ?
+			        ((double) counters->values[i]) / packets_nr : 0.0));
+		}
+	}
+	if(counters->is_supported[PERF_COUNTER_CYCLES] &&
+	   counters->is_supported[PERF_COUNTER_INSTRUCTIONS] &&
+	   counters->values[PERF_COUNTER_CYCLES] > 0)
+	{
+		printf("  %-14s %16.2f\n", "IPC",
+		       ((double) counters->values[PERF_COUNTER_INSTRUCTIONS]) /
+		       counters->values[PERF_COUNTER_CYCLES]);
+	}
+	fflush(stdout);
+}
+
+
+/**
+ * @brief Print the breakdown of the compression phases per profile
+ *
+ * @param comp  The compressor that measured the durations of the phases
+ * @return      true if the breakdown was printed, false otherwise
+ */
+static bool perf_breakdown_print_comp(const struct rohc_comp *const comp)
+{
+	const char *const names[ROHC_COMP_PHASE_MAX] = {
+		[ROHC_COMP_PHASE_PARSE]    = "parse",
+		[ROHC_COMP_PHASE_LOOKUP]   = "context lookup",
+		[ROHC_COMP_PHASE_ENCODE]   = "encode",
+		[ROHC_COMP_PHASE_CRC]      = "CRC",
+		[ROHC_COMP_PHASE_PAYLOAD]  = "payload",
+		[ROHC_COMP_PHASE_FEEDBACK] = "feedback",
+	};
+	rohc_timings_histo_t histos[ROHC_COMP_PHASE_MAX];
+	int profile;
+	int phase;
+
+	for(profile = 0; profile < ROHC_PROFILE_MAX; profile++)
+	{
+		for(phase = 0; phase < ROHC_COMP_PHASE_MAX; phase++)
+		{
+			if(!rohc_comp_get_profile_timings(comp, profile, phase,
+			                                  &histos[phase]))
+			{
+				fprintf(stderr, "failed to get the timings of the compression "
+				        "phase %d of profile 0x%04x\n", phase, profile);
+				goto error;
+			}
+		}
+		perf_breakdown_print(true, profile, names, histos, ROHC_COMP_PHASE_MAX);
+	}
+
+	return true;
+
+error:
+	return false;
+}
+
+
+/**
+ * @brief Print the breakdown of the decompression phases per profile
+ *
+ * @param decomp  The decompressor that measured the durations of the phases
+ * @return        true if the breakdown was printed, false otherwise
+ */
+static bool perf_breakdown_print_decomp(const struct rohc_decomp *const decomp)
+{
+	const char *const names[ROHC_DECOMP_PHASE_MAX] = {
+		[ROHC_DECOMP_PHASE_PARSE]    = "parse",
+		[ROHC_DECOMP_PHASE_LOOKUP]   = "context lookup",
+		[ROHC_DECOMP_PHASE_DECODE]   = "decode",
+		[ROHC_DECOMP_PHASE_CRC]      = "build + CRC",
+		[ROHC_DECOMP_PHASE_PAYLOAD]  = "payload",
+		[ROHC_DECOMP_PHASE_FEEDBACK] = "feedback",
+	};
+	rohc_timings_histo_t histos[ROHC_DECOMP_PHASE_MAX];
+	int profile;
+	int phase;
+
+	for(profile = 0; profile < ROHC_PROFILE_MAX; profile++)
+	{
+		for(phase = 0; phase < ROHC_DECOMP_PHASE_MAX; phase++)
+		{
+			if(!rohc_decomp_get_profile_timings(decomp, profile, phase,
+			                                    &histos[phase]))
+			{
+				fprintf(stderr, "failed to get the timings of the decompression "
+				        "phase %d of profile 0x%04x\n", phase, profile);
+				goto error;
+			}
+		}
+		perf_breakdown_print(false, profile, names, histos,
+		                     ROHC_DECOMP_PHASE_MAX);
+	}
+
+	return true;
+
+error:
+	return false;
+}
+
+
+/**
+ * @brief Print the breakdown of the (de)compression phases of one profile
+ *
+ * Nothing is printed if the profile handled no packet.
+ *
+ * @param is_comp    Whether the phases are compression phases or not
+ * @param profile    The profile the phases were measured for
+ * @param names      The names of the phases
+ * @param histos     The histograms of the durations of the phases
+ * @param phases_nr  The number of phases
+ */
+static void perf_breakdown_print(const bool is_comp,
+                                 const rohc_profile_t profile,
+                                 const char *const names[],
+                                 const rohc_timings_histo_t histos[],
+                                 const size_t phases_nr)
+{
+	/* the parsing phase is measured once per packet */
+	const uint64_t packets_nr = histos[0].count;
+	uint64_t total = 0;
+	size_t phase;
+
+	if(packets_nr == 0)
+	{
+		return;
+	}
+	for(phase = 0; phase < phases_nr; phase++)
+	{
+		total += histos[phase].total;
+	}
+
+	printf("%s breakdown of profile '%s' (0x%04x), %" PRIu64 " packets:\n",
+	       (is_comp ? "compression" : "decompression"),
+	       rohc_get_profile_descr(profile), profile, packets_nr);
+	printf("  %-14s %16s %7s %12s\n", "phase", "ticks", "share", "ticks/pkt");
+	for(phase = 0; phase < phases_nr; phase++)
+	{
+		const double share =
+			(total > 0 ? ((double) histos[phase].total) / total : 0.0);
+		const size_t bar_len =
+			(size_t) (share * PERF_BREAKDOWN_BAR_WIDTH + 0.5);
+		char bar[PERF_BREAKDOWN_BAR_WIDTH + 1];
+
+		memset(bar, '#', bar_len);
+		bar[bar_len] = '\0';
+		printf("  %-14s %16" PRIu64 " %6.1f%% %12.1f%s%s\n", names[phase],
+		       histos[phase].total, share * 100,
+		       ((double) histos[phase].total) / packets_nr,
+		       (bar_len > 0 ? "  " : ""), bar);
+	}
+	printf("  %-14s %16" PRIu64 " %6.1f%% %12.1f\n", "total", total, 100.0,
+	       ((double) total) / packets_nr);
+	fflush(stdout);
+}
+
+
 /**
  * @brief Print traces emitted by the ROHC library in verbose mode
  *
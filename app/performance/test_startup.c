@@ -0,0 +1,483 @@
+/*
+ * Copyright 2016 Didier Barvaux
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/**
+ * @file    test_startup.c
+ * @brief   ROHC instance startup time program
+ * @author  Didier Barvaux <didier@barvaux.org>
+ *
+ * Introduction
+ * ------------
+ *
+ * The program measures the time needed to create, configure and destroy
+ * ROHC compressors and decompressors, as done when radio bearers are set up
+ * and torn down.
+ *
+ * Details
+ * -------
+ *
+ * For every MAX_CID value, many compressors are created with
+ * rohc_comp_new2(), configured (all the profiles enabled and, if requested,
+ * some contexts reserved with rohc_comp_reserve_contexts()), then destroyed.
+ * Every step is timed separately over all the iterations. The same is done
+ * for the decompressors.
+ *
+ * The CID type is 'smallcid' if MAX_CID is 15 or less, 'largecid' otherwise.
+ *
+ * Output
+ * ------
+ *
+ * The program outputs one 'STARTUP' line per side and MAX_CID value with the
+ * following tab-separated fields, the first line names them:
+ *  - keyword 'STARTUP'
+ *  - side ('comp' or 'decomp')
+ *  - MAX_CID
+ *  - number of contexts reserved
+ *  - average time to create one instance (in microseconds)
+ *  - average time to configure one instance (in microseconds)
+ *  - average time to destroy one instance (in microseconds)
+ *  - average total time for one instance (in microseconds)
+ */
+
+#include "config.h" /* for PACKAGE_BUGREPORT */
+
+/* system includes */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+#include <time.h>
+
+/* ROHC includes */
+#include <rohc/rohc.h>
+#include <rohc/rohc_comp.h>
+#include <rohc/rohc_decomp.h>
+
+
+/** The default number of instances created for every MAX_CID value */
+#define STARTUP_ITERATIONS_DEFAULT  1000U
+
+/** The maximum number of MAX_CID values tested at once */
+#define STARTUP_MAX_CIDS_MAX  16U
+
+/** The MAX_CID values tested if none is given */
+static const size_t startup_max_cids_default[] = { 15, 255, 4095, 16383 };
+
+
+/** The time spent in the steps of the life of an instance */
+struct startup_times
+{
+	uint64_t create_ns;     /**< The time spent creating the instances */
+	uint64_t configure_ns;  /**< The time spent configuring the instances */
+	uint64_t destroy_ns;    /**< The time spent destroying the instances */
+};
+
+
+/* prototypes of private functions */
+static void usage(void);
+static bool test_startup_comp(const size_t max_cid,
+                              const size_t reserved_nr,
+                              const size_t iterations,
+                              struct startup_times *const times)
+	__attribute__((warn_unused_result, nonnull(4)));
+static bool test_startup_decomp(const size_t max_cid,
+                                const size_t reserved_nr,
+                                const size_t iterations,
+                                struct startup_times *const times)
+	__attribute__((warn_unused_result, nonnull(4)));
+static void startup_times_print(const char *const side,
+                                const size_t max_cid,
+                                const size_t reserved_nr,
+                                const size_t iterations,
+                                const struct startup_times *const times)
+	__attribute__((nonnull(1, 5)));
+static uint64_t startup_now_ns(void)
+	__attribute__((warn_unused_result));
+static int gen_false_random_num(const struct rohc_comp *const comp,
+                                void *const user_context)
+	__attribute__((warn_unused_result));
+
+
+/**
+ * @brief Main function for the ROHC startup time program
+ *
+ * @param argc The number of program arguments
+ * @param argv The program arguments
+ * @return     The unix return code:
+ *              \li 0 in case of success,
+ *              \li 1 in case of failure
+ */
+int main(int argc, char *argv[])
+{
+	size_t max_cids[STARTUP_MAX_CIDS_MAX];
+	size_t max_cids_nr = 0;
+	int iterations = STARTUP_ITERATIONS_DEFAULT;
+	int reserved_nr = 0;
+	size_t i;
+	int status = 1;
+
+	for(argc--, argv++; argc > 0; argc--, argv++)
+	{
+		if(!strcmp(*argv, "-v") || !strcmp(*argv, "--version"))
+		{
+			/* print version */
+			printf("rohc_test_startup version %s\n", rohc_version());
+			goto error;
+		}
+		else if(!strcmp(*argv, "-h") || !strcmp(*argv, "--help"))
+		{
+			/* print help */
+			usage();
+			goto error;
+		}
+		else if(!strcmp(*argv, "--iterations"))
+		{
+			/* get the number of instances to create for every MAX_CID */
+			if(argc <= 1)
+			{
+				fprintf(stderr, "option --iterations takes one argument\n\n");
+				usage();
+				goto error;
+			}
+			iterations = atoi(argv[1]);
+			argc--;
+			argv++;
+		}
+		else if(!strcmp(*argv, "--reserve"))
+		{
+			/* get the number of contexts to reserve in every instance */
+			if(argc <= 1)
+			{
+				fprintf(stderr, "option --reserve takes one argument\n\n");
+				usage();
+				goto error;
+			}
+			reserved_nr = atoi(argv[1]);
+			argc--;
+			argv++;
+		}
+		else if(max_cids_nr < STARTUP_MAX_CIDS_MAX)
+		{
+			/* get one more MAX_CID value to test */
+			const int max_cid = atoi(argv[0]);
+			if(max_cid < 0 || max_cid > (int) ROHC_LARGE_CID_MAX)
+			{
+				fprintf(stderr, "invalid MAX_CID '%s': it shall be in range "
+				        "[0, %d]\n\n", argv[0], (int) ROHC_LARGE_CID_MAX);
+				usage();
+				goto error;
+			}
+			max_cids[max_cids_nr] = max_cid;
+			max_cids_nr++;
+		}
+		else
+		{
+			fprintf(stderr, "too many MAX_CID values, %u at most\n\n",
+			        STARTUP_MAX_CIDS_MAX);
+			usage();
+			goto error;
+		}
+	}
+
+	if(iterations <= 0)
+	{
+		fprintf(stderr, "invalid number of iterations %d\n\n", iterations);
+		usage();
+		goto error;
+	}
+	if(reserved_nr < 0)
+	{
+		fprintf(stderr, "invalid number of contexts to reserve %d\n\n",
+		        reserved_nr);
+		usage();
+		goto error;
+	}
+	if(max_cids_nr == 0)
+	{
+		max_cids_nr = sizeof(startup_max_cids_default) / sizeof(size_t);
+		memcpy(max_cids, startup_max_cids_default,
+		       sizeof(startup_max_cids_default));
+	}
+
+	printf("STARTUP\tside\tmax_cid\treserved\tcreate (us)\tconfigure (us)\t"
+	       "destroy (us)\ttotal (us)\n");
+
+	for(i = 0; i < max_cids_nr; i++)
+	{
+		/* do not reserve more contexts than the instance may use */
+		const size_t contexts_nr =
+			((size_t) reserved_nr) > (max_cids[i] + 1) ?
+			(max_cids[i] + 1) : ((size_t) reserved_nr);
+		struct startup_times times;
+
+		if(!test_startup_comp(max_cids[i], contexts_nr, iterations, &times))
+		{
+			fprintf(stderr, "startup test failed for compressor with "
+			        "MAX_CID = %zu\n", max_cids[i]);
+			goto error;
+		}
+		startup_times_print("comp", max_cids[i], contexts_nr, iterations,
+		                    &times);
+
+		if(!test_startup_decomp(max_cids[i], contexts_nr, iterations, &times))
+		{
+			fprintf(stderr, "startup test failed for decompressor with "
+			        "MAX_CID = %zu\n", max_cids[i]);
+			goto error;
+		}
+		startup_times_print("decomp", max_cids[i], contexts_nr, iterations,
+		                    &times);
+	}
+
+	status = 0;
+
+error:
+	return status;
+}
+
+
+/**
+ * @brief Print usage of the startup time application
+ */
+static void usage(void)
+{
+	printf("The ROHC startup time tool measures the time needed to create,\n"
+	       "configure and destroy ROHC compressors and decompressors\n"
+	       "\n"
+	       "The rohc_test_startup tool creates many compressors with every\n"
+	       "MAX_CID value, enables all the profiles, then destroys them. The\n"
+	       "same is done with decompressors. The CID type is 'smallcid' if\n"
+	       "MAX_CID is 15 or less, 'largecid' otherwise. One 'STARTUP' line\n"
+	       "is printed per side and MAX_CID value with the following\n"
+	       "tab-separated fields:\n"
+	       "  * keyword 'STARTUP'\n"
+	       "  * side ('comp' or 'decomp')\n"
+	       "  * MAX_CID\n"
+	       "  * number of contexts reserved\n"
+	       "  * average time to create one instance (in microseconds)\n"
+	       "  * average time to configure one instance (in microseconds)\n"
+	       "  * average time to destroy one instance (in microseconds)\n"
+	       "  * average total time for one instance (in microseconds)\n"
+	       "\n"
+	       "Usage: rohc_test_startup [OPTIONS] [MAX_CID...]\n"
+	       "\n"
+	       "Options:\n"
+	       "  -v, --version           Print version information and exit\n"
+	       "  -h, --help              Print this usage and exit\n"
+	       "      --iterations NUM    The number of instances to create for\n"
+	       "                          every MAX_CID value (default: %u)\n"
+	       "      --reserve NUM       Reserve the memory of NUM contexts while\n"
+	       "                          configuring the instances (default: 0)\n"
+	       "\n"
+	       "With:\n"
+	       "  MAX_CID                 The largest CID the instances may use,\n"
+	       "                          15, 255, 4095 and 16383 if none is given\n"
+	       "\n"
+	       "Examples:\n"
+	       "  rohc_test_startup 16383\n"
+	       "                          Measure the startup time with large CIDs\n"
+	       "  rohc_test_startup --reserve 16384 16383\n"
+	       "                          Measure it with all the contexts reserved\n"
+	       "\n"
+	       "Report bugs to <" PACKAGE_BUGREPORT ">.\n",
+	       STARTUP_ITERATIONS_DEFAULT);
+}
+
+
+/**
+ * @brief Measure the time to create, configure and destroy compressors
+ *
+ * @param max_cid      The MAX_CID of the compressors
+ * @param reserved_nr  The number of contexts to reserve in every compressor
+ * @param iterations   The number of compressors to create
+ * @param[out] times   The time spent in every step for all the compressors
+ * @return             true if the test succeeded, false otherwise
+ */
+static bool test_startup_comp(const size_t max_cid,
+                              const size_t reserved_nr,
+                              const size_t iterations,
+                              struct startup_times *const times)
+{
+	const rohc_cid_type_t cid_type =
+		(max_cid <= ROHC_SMALL_CID_MAX ? ROHC_SMALL_CID : ROHC_LARGE_CID);
+	size_t i;
+
+	memset(times, 0, sizeof(struct startup_times));
+
+	for(i = 0; i < iterations; i++)
+	{
+		struct rohc_comp *comp;
+		uint64_t start;
+		uint64_t end;
+
+		start = startup_now_ns();
+		comp = rohc_comp_new2(cid_type, max_cid, gen_false_random_num, NULL);
+		end = startup_now_ns();
+		if(comp == NULL)
+		{
+			fprintf(stderr, "cannot create the ROHC compressor\n");
+			goto error;
+		}
+		times->create_ns += end - start;
+
+		start = startup_now_ns();
+		if(!rohc_comp_enable_profiles(comp, ROHC_PROFILE_UNCOMPRESSED,
+		                              ROHC_PROFILE_RTP, ROHC_PROFILE_UDP,
+		                              ROHC_PROFILE_IP, ROHC_PROFILE_UDPLITE,
+		                              ROHC_PROFILE_ESP, ROHC_PROFILE_TCP, -1) ||
+		   !rohc_comp_reserve_contexts(comp, reserved_nr))
+		{
+			fprintf(stderr, "failed to configure the ROHC compressor\n");
+			rohc_comp_free(comp);
+			goto error;
+		}
+		end = startup_now_ns();
+		times->configure_ns += end - start;
+
+		start = startup_now_ns();
+		rohc_comp_free(comp);
+		end = startup_now_ns();
+		times->destroy_ns += end - start;
+	}
+
+	return true;
+
+error:
+	return false;
+}
+
+
+/**
+ * @brief Measure the time to create, configure and destroy decompressors
+ *
+ * @param max_cid      The MAX_CID of the decompressors
+ * @param reserved_nr  The number of contexts to reserve in every decompressor
+ * @param iterations   The number of decompressors to create
+ * @param[out] times   The time spent in every step for all the decompressors
+ * @return             true if the test succeeded, false otherwise
+ */
+static bool test_startup_decomp(const size_t max_cid,
+                                const size_t reserved_nr,
+                                const size_t iterations,
+                                struct startup_times *const times)
+{
+	const rohc_cid_type_t cid_type =
+		(max_cid <= ROHC_SMALL_CID_MAX ? ROHC_SMALL_CID : ROHC_LARGE_CID);
+	size_t i;
+
+	memset(times, 0, sizeof(struct startup_times));
+
+	for(i = 0; i < iterations; i++)
+	{
+		struct rohc_decomp *decomp;
+		uint64_t start;
+		uint64_t end;
+
+		start = startup_now_ns();
+		decomp = rohc_decomp_new2(cid_type, max_cid, ROHC_U_MODE);
+		end = startup_now_ns();
+		if(decomp == NULL)
+		{
+			fprintf(stderr, "cannot create the ROHC decompressor\n");
+			goto error;
+		}
+		times->create_ns += end - start;
+
+		start = startup_now_ns();
+		if(!rohc_decomp_enable_profiles(decomp, ROHC_PROFILE_UNCOMPRESSED,
+		                                ROHC_PROFILE_RTP, ROHC_PROFILE_UDP,
+		                                ROHC_PROFILE_IP, ROHC_PROFILE_UDPLITE,
+		                                ROHC_PROFILE_ESP, ROHC_PROFILE_TCP, -1) ||
+		   !rohc_decomp_reserve_contexts(decomp, reserved_nr))
+		{
+			fprintf(stderr, "failed to configure the ROHC decompressor\n");
+			rohc_decomp_free(decomp);
+			goto error;
+		}
+		end = startup_now_ns();
+		times->configure_ns += end - start;
+
+		start = startup_now_ns();
+		rohc_decomp_free(decomp);
+		end = startup_now_ns();
+		times->destroy_ns += end - start;
+	}
+
+	return true;
+
+error:
+	return false;
+}
+
+
+/**
+ * @brief Print the average startup times of one side
+ *
+ * @param side         The side: 'comp' or 'decomp'
+ * @param max_cid      The MAX_CID of the instances
+ * @param reserved_nr  The number of contexts reserved in every instance
+ * @param iterations   The number of instances that were created
+ * @param times        The time spent in every step for all the instances
+ */
+static void startup_times_print(const char *const side,
+                                const size_t max_cid,
+                                const size_t reserved_nr,
+                                const size_t iterations,
+                                const struct startup_times *const times)
+{
+	const double create_us = times->create_ns / 1e3 / iterations;
+	const double configure_us = times->configure_ns / 1e3 / iterations;
+	const double destroy_us = times->destroy_ns / 1e3 / iterations;
+
+	printf("STARTUP\t%s\t%zu\t%zu\t%.2f\t%.2f\t%.2f\t%.2f\n", side, max_cid,
+	       reserved_nr, create_us, configure_us, destroy_us,
+	       create_us + configure_us + destroy_us);
+}
+
+
+/**
+ * @brief Read the monotonic clock
+ *
+ * @return  The current time (in nanoseconds)
+ */
+static uint64_t startup_now_ns(void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return ((uint64_t) now.tv_sec) * 1000000000U + now.tv_nsec;
+}
+
+
+/**
+ * @brief Generate a false random number for testing the ROHC library
+ *
+ * @param comp          The ROHC compressor
+ * @param user_context  Should always be NULL
+ * @return              Always 0
+ */
+static int gen_false_random_num(const struct rohc_comp *const comp,
+                                void *const user_context)
+{
+	assert(comp != NULL);
+	assert(user_context == NULL);
+	return 0;
+}
+
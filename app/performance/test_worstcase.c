@@ -0,0 +1,1347 @@
+/*
+ * Copyright 2016 Didier Barvaux
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/**
+ * @file    test_worstcase.c
+ * @brief   ROHC decompression worst-case latency program
+ * @author  Didier Barvaux <didier@barvaux.org>
+ *
+ * Introduction
+ * ------------
+ *
+ * The program feeds the ROHC decompressor with adversarial streams and
+ * reports the maximum time spent on one single packet, and the packet that
+ * caused it. A peer that sends crafted packets shall not be able to make
+ * the decompressor spend an unbounded time on one packet.
+ *
+ * Details
+ * -------
+ *
+ * The built-in streams are compressed by the ROHC compressor from generated
+ * IP packets, then altered if needed:
+ *  - 'ipv6-ext-list': IPv6/UDP packets with 4 extension headers up to 2 KB
+ *    long each, whose order, presence and content change at every packet so
+ *    that the lists are transmitted again and again;
+ *  - 'tcp-options': IPv4/TCP packets with 40 bytes of TCP options (up to 15
+ *    options, SACK blocks, generic options...) that change at every packet;
+ *  - 'crc-repair': IPv4/UDP/RTP packets, one out of five being damaged so
+ *    that its CRC check fails and the CRC repair is attempted;
+ *  - 'segments': IPv4/UDP packets as large as the MRRU, split in ROHC
+ *    segments of 128 bytes that the decompressor reassembles.
+ * The captures of ROHC packets given on the command line (the inputs of the
+ * robustness tests for example) are decompressed as they are.
+ *
+ * Every stream is decompressed several times by a new decompressor with CRC
+ * repair enabled. The time spent on every packet is the minimum over the
+ * runs, so that an interrupt or a preemption during one run does not hide
+ * the real worst case. The maximum of those per-packet times is reported.
+ *
+ * Output
+ * ------
+ *
+ * The program outputs one 'WORSTCASE' line per stream and one for all the
+ * streams with the following tab-separated fields, the first line names
+ * them:
+ *  - keyword 'WORSTCASE'
+ *  - name of the stream ('all' for all the streams)
+ *  - number of ROHC packets
+ *  - number of ROHC packets that failed to be decompressed
+ *  - average decompression time per packet (in nanoseconds)
+ *  - maximum decompression time for one packet (in nanoseconds)
+ *  - the slowest packet: its number in the stream, starting at 1, prefixed
+ *    with the name of the stream on the 'all' line
+ *  - length of the slowest packet (in bytes)
+ *  - decompression status of the slowest packet
+ */
+
+#include "config.h" /* for HAVE_*_H and PACKAGE_BUGREPORT */
+
+/* system includes */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+#include <time.h>
+#if HAVE_WINSOCK2_H == 1
+#  include <winsock2.h> /* for htons() on Windows */
+#endif
+#if HAVE_ARPA_INET_H == 1
+#  include <arpa/inet.h> /* for htons() on Linux */
+#endif
+
+/* include for the PCAP library */
+#if HAVE_PCAP_PCAP_H == 1
+#  include <pcap/pcap.h>
+#elif HAVE_PCAP_H == 1
+#  include <pcap.h>
+#else
+#  error "pcap.h header not found, did you specified --enable-rohc-tests \
+for ./configure ? If yes, check configure output and config.log"
+#endif
+
+/* includes for network headers */
+#include <ip.h> /* for IPv4 checksum */
+#include <protocols/ipv4.h>
+#include <protocols/ipv6.h>
+#include <protocols/udp.h>
+#include <protocols/rtp.h>
+#include <protocols/tcp.h>
+#include <protocols/ip_numbers.h>
+
+/* ROHC includes */
+#include <rohc/rohc.h>
+#include <rohc/rohc_comp.h>
+#include <rohc/rohc_decomp.h>
+
+
+/** The maximal length of the IP packets and of the ROHC packets */
+#define WC_PACKET_MAX_LEN  65535U
+
+/** The length of the ROHC segments of the 'segments' stream */
+#define WC_SEGMENT_LEN  128U
+
+/** The default number of IP packets of every built-in stream */
+#define WC_PACKETS_DEFAULT  1000U
+
+/** The default number of times every stream is decompressed */
+#define WC_RUNS_DEFAULT  5U
+
+/** The maximum number of captures given on the command line */
+#define WC_CAPTURES_MAX  64U
+
+/** The length of the Linux Cooked Sockets header */
+#define LINUX_COOKED_HDR_LEN  16U
+
+/** The length (in bytes) of the Ethernet header */
+#define ETHER_HDR_LEN  14U
+
+/** The UDP destination port of the RTP flow */
+#define WC_RTP_PORT  1234U
+
+
+/** One ROHC packet of a stream */
+struct wc_packet
+{
+	uint8_t *data;  /**< The ROHC packet */
+	size_t len;     /**< The length of the ROHC packet */
+};
+
+
+/** One stream of ROHC packets to decompress */
+struct wc_stream
+{
+	const char *name;            /**< The name of the stream */
+	struct wc_packet *packets;   /**< The ROHC packets */
+	size_t packets_nr;           /**< The number of ROHC packets */
+	size_t packets_max;          /**< The number of packets allocated */
+	rohc_cid_type_t cid_type;    /**< The CID type of the decompressor */
+	rohc_cid_t max_cid;          /**< The MAX_CID of the decompressor */
+	rohc_mode_t mode;            /**< The mode of the decompressor */
+};
+
+
+/** A built-in adversarial stream */
+struct wc_scenario
+{
+	const char *name;   /**< The name of the stream */
+	/** Build the given IP packet of the stream, return its length */
+	size_t (*build)(const size_t counter, uint8_t *const data);
+	size_t packets_max; /**< The max number of IP packets, 0 for no limit */
+	size_t mrru;        /**< The MRRU, 0 to disable segmentation */
+	size_t damage_rate; /**< Damage one packet out of N, 0 for none */
+};
+
+
+/** The decompression times of one stream */
+struct wc_result
+{
+	size_t packets_nr;            /**< The number of ROHC packets */
+	size_t failures_nr;           /**< The packets that failed */
+	uint64_t total_ns;            /**< The sum of the per-packet times */
+	uint64_t max_ns;              /**< The max time for one packet */
+	size_t worst_idx;             /**< The index of the slowest packet */
+	rohc_status_t worst_status;   /**< The status of the slowest packet */
+};
+
+
+/* prototypes of private functions */
+static void usage(void);
+static bool wc_gen_stream(const struct wc_scenario *const scenario,
+                          const size_t packets_nr,
+                          struct wc_stream *const stream)
+	__attribute__((warn_unused_result, nonnull(1, 3)));
+static size_t wc_build_ipv6_ext(const size_t counter, uint8_t *const data)
+	__attribute__((warn_unused_result, nonnull(2)));
+static size_t wc_build_tcp_opts(const size_t counter, uint8_t *const data)
+	__attribute__((warn_unused_result, nonnull(2)));
+static size_t wc_build_rtp(const size_t counter, uint8_t *const data)
+	__attribute__((warn_unused_result, nonnull(2)));
+static size_t wc_build_mrru(const size_t counter, uint8_t *const data)
+	__attribute__((warn_unused_result, nonnull(2)));
+static size_t wc_build_ipv4(uint8_t *const data,
+                            const uint8_t protocol,
+                            const size_t counter,
+                            const size_t l4_len)
+	__attribute__((warn_unused_result, nonnull(1)));
+static bool wc_load_capture(const char *const filename,
+                            struct wc_stream *const stream)
+	__attribute__((warn_unused_result, nonnull(1, 2)));
+static bool wc_stream_add(struct wc_stream *const stream,
+                          const uint8_t *const data,
+                          const size_t len)
+	__attribute__((warn_unused_result, nonnull(1, 2)));
+static void wc_stream_free(struct wc_stream *const stream)
+	__attribute__((nonnull(1)));
+static struct rohc_decomp * wc_decomp_new(const struct wc_stream *const stream)
+	__attribute__((warn_unused_result, nonnull(1)));
+static bool wc_decompress_stream(const struct wc_stream *const stream,
+                                 const size_t runs_nr,
+                                 struct wc_result *const result)
+	__attribute__((warn_unused_result, nonnull(1, 3)));
+static uint64_t wc_now_ns(void)
+	__attribute__((warn_unused_result));
+static int gen_false_random_num(const struct rohc_comp *const comp,
+                                void *const user_context)
+	__attribute__((warn_unused_result));
+static bool rohc_comp_rtp_cb(const unsigned char *const ip,
+                             const unsigned char *const udp,
+                             const unsigned char *const payload,
+                             const unsigned int payload_size,
+                             void *const rtp_private)
+	__attribute__((warn_unused_result));
+
+
+/** The built-in adversarial streams */
+static const struct wc_scenario wc_scenarios[] = {
+	{
+		.name = "ipv6-ext-list",
+		.build = wc_build_ipv6_ext,
+		.packets_max = 0,
+		.mrru = 0,
+		.damage_rate = 0,
+	},
+	{
+		.name = "tcp-options",
+		.build = wc_build_tcp_opts,
+		.packets_max = 0,
+		.mrru = 0,
+		.damage_rate = 0,
+	},
+	{
+		.name = "crc-repair",
+		.build = wc_build_rtp,
+		.packets_max = 0,
+		.mrru = 0,
+		.damage_rate = 5,
+	},
+	{
+		.name = "segments",
+		.build = wc_build_mrru,
+		.packets_max = 20,
+		.mrru = WC_PACKET_MAX_LEN,
+		.damage_rate = 0,
+	},
+};
+
+
+/** The buffer for the decompressed packets */
+static uint8_t wc_uncomp_buf[WC_PACKET_MAX_LEN * 2];
+
+
+/**
+ * @brief Main function for the ROHC worst-case latency program
+ *
+ * @param argc The number of program arguments
+ * @param argv The program arguments
+ * @return     The unix return code:
+ *              \li 0 in case of success,
+ *              \li 1 in case of failure or if the maximum time is exceeded
+ */
+int main(int argc, char *argv[])
+{
+	const size_t scenarios_nr = sizeof(wc_scenarios) / sizeof(struct wc_scenario);
+	const char *captures[WC_CAPTURES_MAX];
+	size_t captures_nr = 0;
+	rohc_cid_type_t cid_type = ROHC_SMALL_CID;
+	int packets_nr = WC_PACKETS_DEFAULT;
+	int runs_nr = WC_RUNS_DEFAULT;
+	unsigned long max_ns = 0; /* no maximum */
+	bool no_builtin = false;
+	struct wc_result all;
+	const char *all_worst_name = NULL;
+	size_t all_worst_len = 0;
+	size_t i;
+	int status = 1;
+
+	for(argc--, argv++; argc > 0; argc--, argv++)
+	{
+		if(!strcmp(*argv, "-v") || !strcmp(*argv, "--version"))
+		{
+			/* print version */
+			printf("rohc_test_worstcase version %s\n", rohc_version());
+			goto error;
+		}
+		else if(!strcmp(*argv, "-h") || !strcmp(*argv, "--help"))
+		{
+			/* print help */
+			usage();
+			goto error;
+		}
+		else if(!strcmp(*argv, "--packets"))
+		{
+			/* get the number of IP packets of the built-in streams */
+			if(argc <= 1)
+			{
+				fprintf(stderr, "option --packets takes one argument\n\n");
+				usage();
+				goto error;
+			}
+			packets_nr = atoi(argv[1]);
+			argc--;
+			argv++;
+		}
+		else if(!strcmp(*argv, "--runs"))
+		{
+			/* get the number of times every stream is decompressed */
+			if(argc <= 1)
+			{
+				fprintf(stderr, "option --runs takes one argument\n\n");
+				usage();
+				goto error;
+			}
+			runs_nr = atoi(argv[1]);
+			argc--;
+			argv++;
+		}
+		else if(!strcmp(*argv, "--max-ns"))
+		{
+			/* get the maximum time allowed for one packet */
+			if(argc <= 1)
+			{
+				fprintf(stderr, "option --max-ns takes one argument\n\n");
+				usage();
+				goto error;
+			}
+			max_ns = strtoul(argv[1], NULL, 10);
+			argc--;
+			argv++;
+		}
+		else if(!strcmp(*argv, "--cid-type"))
+		{
+			/* get the CID type of the decompressor for the captures */
+			if(argc <= 1)
+			{
+				fprintf(stderr, "option --cid-type takes one argument\n\n");
+				usage();
+				goto error;
+			}
+			if(!strcmp(argv[1], "smallcid"))
+			{
+				cid_type = ROHC_SMALL_CID;
+			}
+			else if(!strcmp(argv[1], "largecid"))
+			{
+				cid_type = ROHC_LARGE_CID;
+			}
+			else
+			{
+				fprintf(stderr, "invalid CID type '%s', only 'smallcid' and "
+				        "'largecid' expected\n\n", argv[1]);
+				usage();
+				goto error;
+			}
+			argc--;
+			argv++;
+		}
+		else if(!strcmp(*argv, "--no-builtin"))
+		{
+			/* decompress the captures only */
+			no_builtin = true;
+		}
+		else if(captures_nr < WC_CAPTURES_MAX)
+		{
+			/* get one more capture of ROHC packets */
+			captures[captures_nr] = argv[0];
+			captures_nr++;
+		}
+		else
+		{
+			fprintf(stderr, "too many captures, %u at most\n\n", WC_CAPTURES_MAX);
+			usage();
+			goto error;
+		}
+	}
+
+	if(packets_nr <= 0)
+	{
+		fprintf(stderr, "invalid number of packets %d\n\n", packets_nr);
+		usage();
+		goto error;
+	}
+	if(runs_nr <= 0)
+	{
+		fprintf(stderr, "invalid number of runs %d\n\n", runs_nr);
+		usage();
+		goto error;
+	}
+
+	printf("WORSTCASE\tstream\tpackets\tfailures\tavg (ns)\tmax (ns)\t"
+	       "worst packet\tworst length\tworst status\n");
+	memset(&all, 0, sizeof(struct wc_result));
+
+	for(i = 0; i < (no_builtin ? 0 : scenarios_nr) + captures_nr; i++)
+	{
+		struct wc_stream stream;
+		struct wc_result result;
+
+		/* build the built-in streams first, then load the captures */
+		if(!no_builtin && i < scenarios_nr)
+		{
+			if(!wc_gen_stream(&wc_scenarios[i], packets_nr, &stream))
+			{
+				fprintf(stderr, "failed to generate the '%s' stream\n",
+				        wc_scenarios[i].name);
+				goto error;
+			}
+		}
+		else
+		{
+			const size_t capture_idx = i - (no_builtin ? 0 : scenarios_nr);
+
+			memset(&stream, 0, sizeof(struct wc_stream));
+			stream.name = captures[capture_idx];
+			stream.cid_type = cid_type;
+			stream.max_cid = (cid_type == ROHC_SMALL_CID ?
+			                  ROHC_SMALL_CID_MAX : ROHC_LARGE_CID_MAX);
+			stream.mode = ROHC_O_MODE;
+			if(!wc_load_capture(captures[capture_idx], &stream))
+			{
+				fprintf(stderr, "failed to load the capture '%s'\n",
+				        captures[capture_idx]);
+				goto error;
+			}
+		}
+
+		if(!wc_decompress_stream(&stream, runs_nr, &result))
+		{
+			fprintf(stderr, "failed to decompress the '%s' stream\n",
+			        stream.name);
+			wc_stream_free(&stream);
+			goto error;
+		}
+
+		printf("WORSTCASE\t%s\t%zu\t%zu\t%.0f\t%llu\t%zu\t%zu\t%s\n",
+		       stream.name, result.packets_nr, result.failures_nr,
+		       result.packets_nr == 0 ? 0.0 :
+		       ((double) result.total_ns) / result.packets_nr,
+		       (unsigned long long) result.max_ns, result.worst_idx + 1,
+		       result.packets_nr == 0 ? 0 :
+		       stream.packets[result.worst_idx].len,
+		       rohc_strerror(result.worst_status));
+
+		all.packets_nr += result.packets_nr;
+		all.failures_nr += result.failures_nr;
+		all.total_ns += result.total_ns;
+		if(all_worst_name == NULL || result.max_ns > all.max_ns)
+		{
+			all.max_ns = result.max_ns;
+			all.worst_idx = result.worst_idx;
+			all.worst_status = result.worst_status;
+			all_worst_name = stream.name;
+			all_worst_len = (result.packets_nr == 0 ? 0 :
+			                 stream.packets[result.worst_idx].len);
+		}
+
+		wc_stream_free(&stream);
+	}
+
+	if(all_worst_name == NULL)
+	{
+		fprintf(stderr, "no stream to decompress\n\n");
+		usage();
+		goto error;
+	}
+	printf("WORSTCASE\tall\t%zu\t%zu\t%.0f\t%llu\t%s:%zu\t%zu\t%s\n",
+	       all.packets_nr, all.failures_nr,
+	       all.packets_nr == 0 ? 0.0 : ((double) all.total_ns) / all.packets_nr,
+	       (unsigned long long) all.max_ns, all_worst_name,
+	       all.worst_idx + 1, all_worst_len,
+	       rohc_strerror(all.worst_status));
+
+	if(max_ns > 0 && all.max_ns > max_ns)
+	{
+		fprintf(stderr, "packet #%zu of stream '%s' took %llu ns to "
+		        "decompress, more than the %lu ns allowed\n",
+		        all.worst_idx + 1, all_worst_name,
+		        (unsigned long long) all.max_ns, max_ns);
+		goto error;
+	}
+
+	status = 0;
+
+error:
+	return status;
+}
+
+
+/**
+ * @brief Print usage of the worst-case latency application
+ */
+static void usage(void)
+{
+	printf("The ROHC worst-case latency tool measures the maximum time the\n"
+	       "decompressor spends on one packet of adversarial streams\n"
+	       "\n"
+	       "The rohc_test_worstcase tool decompresses built-in streams with\n"
+	       "long IPv6 extension header lists, maximal TCP option lists,\n"
+	       "damaged packets that trigger the CRC repair and ROHC segments\n"
+	       "at MRRU, then the captures of ROHC packets given as arguments.\n"
+	       "Every stream is decompressed several times with CRC repair\n"
+	       "enabled, the time of every packet is the minimum over the runs.\n"
+	       "One 'WORSTCASE' line is printed per stream and one for all the\n"
+	       "streams with the following tab-separated fields:\n"
+	       "  * keyword 'WORSTCASE'\n"
+	       "  * name of the stream ('all' for all the streams)\n"
+	       "  * number of ROHC packets\n"
+	       "  * number of ROHC packets that failed to be decompressed\n"
+	       "  * average decompression time per packet (in nanoseconds)\n"
+	       "  * maximum decompression time for one packet (in nanoseconds)\n"
+	       "  * number of the slowest packet in its stream\n"
+	       "  * length of the slowest packet (in bytes)\n"
+	       "  * decompression status of the slowest packet\n"
+	       "\n"
+	       "Usage: rohc_test_worstcase [OPTIONS] [CAPTURE...]\n"
+	       "\n"
+	       "Options:\n"
+	       "  -v, --version           Print version information and exit\n"
+	       "  -h, --help              Print this usage and exit\n"
+	       "      --packets NUM       The number of IP packets of every\n"
+	       "                          built-in stream (default: %u)\n"
+	       "      --runs NUM          The number of times every stream is\n"
+	       "                          decompressed (default: %u)\n"
+	       "      --max-ns NUM        Fail if one packet takes more than NUM\n"
+	       "                          nanoseconds to decompress\n"
+	       "      --cid-type TYPE     The type of CID of the captures among\n"
+	       "                          'smallcid' and 'largecid'\n"
+	       "                          (default: smallcid)\n"
+	       "      --no-builtin        Do not decompress the built-in streams\n"
+	       "\n"
+	       "With:\n"
+	       "  CAPTURE                 A capture of ROHC packets (in PCAP\n"
+	       "                          format)\n"
+	       "\n"
+	       "Examples:\n"
+	       "  rohc_test_worstcase --max-ns 100000\n"
+	       "                          Check that no packet of the built-in\n"
+	       "                          streams takes more than 100 us\n"
+	       "  rohc_test_worstcase --no-builtin malformed/*.pcap\n"
+	       "                          Find the slowest packet of the captures\n"
+	       "\n"
+	       "Report bugs to <" PACKAGE_BUGREPORT ">.\n",
+	       WC_PACKETS_DEFAULT, WC_RUNS_DEFAULT);
+}
+
+
+/**
+ * @brief Generate one built-in stream of ROHC packets
+ *
+ * The IP packets are compressed by a compressor with small CIDs, then
+ * segmented and damaged as the scenario requires.
+ *
+ * @param scenario     The built-in stream to generate
+ * @param packets_nr   The number of IP packets to compress
+ * @param[out] stream  The ROHC packets, to free with \ref wc_stream_free
+ * @return             true if the stream was generated, false otherwise
+ */
+static bool wc_gen_stream(const struct wc_scenario *const scenario,
+                          const size_t packets_nr,
+                          struct wc_stream *const stream)
+{
+	const struct rohc_ts arrival_time = { .sec = 0, .nsec = 0 };
+	uint8_t *const ip_data = malloc(WC_PACKET_MAX_LEN);
+	uint8_t *const rohc_data = malloc(WC_PACKET_MAX_LEN);
+	struct rohc_comp *comp;
+	size_t counter;
+
+	memset(stream, 0, sizeof(struct wc_stream));
+	stream->name = scenario->name;
+	stream->cid_type = ROHC_SMALL_CID;
+	stream->max_cid = ROHC_SMALL_CID_MAX;
+	stream->mode = ROHC_U_MODE;
+
+	if(ip_data == NULL || rohc_data == NULL)
+	{
+		fprintf(stderr, "failed to allocate memory for the packets\n");
+		goto free_buffers;
+	}
+
+	comp = rohc_comp_new2(ROHC_SMALL_CID, ROHC_SMALL_CID_MAX,
+	                      gen_false_random_num, NULL);
+	if(comp == NULL)
+	{
+		fprintf(stderr, "cannot create the ROHC compressor\n");
+		goto free_buffers;
+	}
+	if(!rohc_comp_enable_profiles(comp, ROHC_PROFILE_UNCOMPRESSED,
+	                              ROHC_PROFILE_RTP, ROHC_PROFILE_UDP,
+	                              ROHC_PROFILE_IP, ROHC_PROFILE_UDPLITE,
+	                              ROHC_PROFILE_ESP, ROHC_PROFILE_TCP, -1) ||
+	   !rohc_comp_set_rtp_detection_cb(comp, rohc_comp_rtp_cb, NULL) ||
+	   !rohc_comp_set_mrru(comp, scenario->mrru))
+	{
+		fprintf(stderr, "failed to configure the ROHC compressor\n");
+		goto free_compressor;
+	}
+
+	for(counter = 0; counter < packets_nr; counter++)
+	{
+		struct rohc_buf ip_packet =
+			rohc_buf_init_full(ip_data, WC_PACKET_MAX_LEN, arrival_time);
+		struct rohc_buf rohc_packet =
+			rohc_buf_init_empty(rohc_data, WC_PACKET_MAX_LEN);
+		rohc_status_t status;
+
+		if(scenario->packets_max > 0 && counter >= scenario->packets_max)
+		{
+			break;
+		}
+
+		ip_packet.len = scenario->build(counter, ip_data);
+
+		/* the ROHC packets that do not fit in one segment are segmented */
+		if(scenario->mrru > 0)
+		{
+			rohc_packet.max_len = WC_SEGMENT_LEN;
+		}
+		status = rohc_compress4(comp, ip_packet, &rohc_packet);
+		if(status == ROHC_STATUS_SEGMENT)
+		{
+			do
+			{
+				struct rohc_buf segment =
+					rohc_buf_init_empty(rohc_data, WC_SEGMENT_LEN);
+
+				status = rohc_comp_get_segment2(comp, &segment);
+				if((status == ROHC_STATUS_SEGMENT || status == ROHC_STATUS_OK) &&
+				   !wc_stream_add(stream, rohc_buf_data(segment), segment.len))
+				{
+					goto free_stream;
+				}
+			}
+			while(status == ROHC_STATUS_SEGMENT);
+		}
+		else if(status == ROHC_STATUS_OK)
+		{
+			/* damage the UO packets, not the IR and IR-DYN packets */
+			if(scenario->damage_rate > 0 &&
+			   (counter % scenario->damage_rate) == (scenario->damage_rate - 1) &&
+			   rohc_buf_byte_at(rohc_packet, 0) < 0xe0)
+			{
+				rohc_buf_byte_at(rohc_packet, 0) ^= 0x01;
+			}
+			if(!wc_stream_add(stream, rohc_buf_data(rohc_packet),
+			                  rohc_packet.len))
+			{
+				goto free_stream;
+			}
+		}
+		if(status != ROHC_STATUS_OK)
+		{
+			fprintf(stderr, "failed to compress packet #%zu of the '%s' "
+			        "stream: %s\n", counter + 1, scenario->name,
+			        rohc_strerror(status));
+			goto free_stream;
+		}
+	}
+
+	rohc_comp_free(comp);
+	free(rohc_data);
+	free(ip_data);
+	return true;
+
+free_stream:
+	wc_stream_free(stream);
+free_compressor:
+	rohc_comp_free(comp);
+free_buffers:
+	free(rohc_data);
+	free(ip_data);
+	return false;
+}
+
+
+/**
+ * @brief Build one IPv6/UDP packet with long extension header lists
+ *
+ * The Hop-by-Hop, Destination, Routing and Destination extension headers
+ * are present or not, in different lengths up to 2 KB and with different
+ * contents depending on the packet counter.
+ *
+ * @param counter  The number of the packet in the stream
+ * @param data     The buffer to build the packet in
+ * @return         The length of the packet
+ */
+static size_t wc_build_ipv6_ext(const size_t counter, uint8_t *const data)
+{
+	const uint8_t ext_protos[4] = {
+		ROHC_IPPROTO_HOPOPTS, ROHC_IPPROTO_DSTOPTS,
+		ROHC_IPPROTO_ROUTING, ROHC_IPPROTO_DSTOPTS
+	};
+	struct ipv6_hdr *const ipv6 = (struct ipv6_hdr *) data;
+	uint8_t *next_proto = &ipv6->nh;
+	size_t len = sizeof(struct ipv6_hdr);
+	struct udphdr *udp;
+	size_t i;
+
+	ipv6->version_tc_flow = htonl((6U << 28) | 0x12345);
+	ipv6->hl = 64;
+	memset(ipv6->saddr.u8, 0x20, 16);
+	memset(ipv6->daddr.u8, 0x30, 16);
+
+	for(i = 0; i < 4; i++)
+	{
+		/* every extension header is absent in one packet out of (i + 2), and
+		 * its length changes at every packet */
+		const size_t ext_units = (counter * 37 + i * 101) % 256;
+		const size_t ext_len = (ext_units + 1) * 8;
+		uint8_t *const ext = data + len;
+
+		if(((counter + i) % (i + 2)) == 0)
+		{
+			continue;
+		}
+
+		*next_proto = ext_protos[i];
+		next_proto = &ext[0];
+		ext[1] = ext_units;
+		if(ext_protos[i] == ROHC_IPPROTO_ROUTING)
+		{
+			/* an unknown routing type without segment left is skipped */
+			ext[2] = 253;
+			ext[3] = 0;
+			memset(ext + 4, counter & 0xff, ext_len - 4);
+		}
+		else
+		{
+			/* one option that shall be skipped if unknown, plus PadN */
+			const size_t opt_len = (ext_len - 2 - 2 > 255 ? 255 : ext_len - 4);
+			ext[2] = 0x1e;
+			ext[3] = opt_len;
+			memset(ext + 4, counter & 0xff, opt_len);
+			if(ext_len - 4 - opt_len > 0)
+			{
+				uint8_t *const padn = ext + 4 + opt_len;
+				const size_t padn_len = ext_len - 4 - opt_len;
+				if(padn_len == 1)
+				{
+					padn[0] = 0; /* Pad1 */
+				}
+				else
+				{
+					padn[0] = 1;
+					padn[1] = padn_len - 2;
+					memset(padn + 2, 0, padn_len - 2);
+				}
+			}
+		}
+		len += ext_len;
+	}
+	*next_proto = ROHC_IPPROTO_UDP;
+
+	udp = (struct udphdr *) (data + len);
+	udp->source = htons(5000);
+	udp->dest = htons(5001);
+	udp->len = htons(sizeof(struct udphdr) + 20);
+	udp->check = htons(0x1234 + counter);
+	len += sizeof(struct udphdr);
+	memset(data + len, counter & 0xff, 20);
+	len += 20;
+
+	ipv6->plen = htons(len - sizeof(struct ipv6_hdr));
+
+	return len;
+}
+
+
+/**
+ * @brief Build one IPv4/TCP packet with a maximal list of TCP options
+ *
+ * The 40 bytes of TCP options change at every packet among 4 lists: NOPs,
+ * TS and SACK with 3 blocks; all the well-known options plus a generic one;
+ * 15 options ended by EOL; SACK with 4 blocks.
+ *
+ * @param counter  The number of the packet in the stream
+ * @param data     The buffer to build the packet in
+ * @return         The length of the packet
+ */
+static size_t wc_build_tcp_opts(const size_t counter, uint8_t *const data)
+{
+	struct tcphdr *const tcp = (struct tcphdr *) (data + sizeof(struct ipv4_hdr));
+	uint8_t *const opts = tcp->options;
+	const uint32_t seq = 1000 + counter * 1460;
+	struct tcp_option_timestamp ts;
+	size_t opts_len = 0;
+	size_t blocks_nr = 0;
+	size_t i;
+
+	memset(tcp, 0, sizeof(struct tcphdr));
+	tcp->src_port = htons(5000);
+	tcp->dst_port = htons(80);
+	tcp->seq_num = htonl(seq);
+	tcp->ack_num = htonl(0x10000 + counter * 7);
+	tcp->ack_flag = 1;
+	tcp->window = htons(65535 - counter);
+	tcp->checksum = htons(0x4321 + counter);
+
+	ts.ts = htonl(counter * 3);
+	ts.ts_reply = htonl(counter * 5);
+
+	switch(counter % 4)
+	{
+		case 0:
+			/* NOP, NOP, TS, NOP, NOP, SACK with 3 blocks */
+			opts[opts_len++] = TCP_OPT_NOP;
+			opts[opts_len++] = TCP_OPT_NOP;
+			opts[opts_len++] = TCP_OPT_TS;
+			opts[opts_len++] = TCP_OLEN_TS;
+			memcpy(opts + opts_len, &ts, sizeof(struct tcp_option_timestamp));
+			opts_len += sizeof(struct tcp_option_timestamp);
+			opts[opts_len++] = TCP_OPT_NOP;
+			opts[opts_len++] = TCP_OPT_NOP;
+			blocks_nr = 3;
+			break;
+		case 1:
+			/* MSS, WS, SACK Permitted, TS, NOP and one generic option */
+			opts[opts_len++] = TCP_OPT_MSS;
+			opts[opts_len++] = TCP_OLEN_MSS;
+			opts[opts_len++] = (1460 >> 8) & 0xff;
+			opts[opts_len++] = 1460 & 0xff;
+			opts[opts_len++] = TCP_OPT_WS;
+			opts[opts_len++] = TCP_OLEN_WS;
+			opts[opts_len++] = counter % 15;
+			opts[opts_len++] = TCP_OPT_SACK_PERM;
+			opts[opts_len++] = TCP_OLEN_SACK_PERM;
+			opts[opts_len++] = TCP_OPT_TS;
+			opts[opts_len++] = TCP_OLEN_TS;
+			memcpy(opts + opts_len, &ts, sizeof(struct tcp_option_timestamp));
+			opts_len += sizeof(struct tcp_option_timestamp);
+			opts[opts_len++] = TCP_OPT_NOP;
+			opts[opts_len++] = 253; /* experimental option */
+			opts[opts_len++] = 20;
+			memset(opts + opts_len, counter & 0xff, 18);
+			opts_len += 18;
+			break;
+		case 2:
+			/* 10 NOPs, WS, SACK Permitted, MSS, TS and EOL: 15 options */
+			for(i = 0; i < 10; i++)
+			{
+				opts[opts_len++] = TCP_OPT_NOP;
+			}
+			opts[opts_len++] = TCP_OPT_WS;
+			opts[opts_len++] = TCP_OLEN_WS;
+			opts[opts_len++] = counter % 15;
+			opts[opts_len++] = TCP_OPT_SACK_PERM;
+			opts[opts_len++] = TCP_OLEN_SACK_PERM;
+			opts[opts_len++] = TCP_OPT_MSS;
+			opts[opts_len++] = TCP_OLEN_MSS;
+			opts[opts_len++] = (counter >> 8) & 0xff;
+			opts[opts_len++] = counter & 0xff;
+			opts[opts_len++] = TCP_OPT_TS;
+			opts[opts_len++] = TCP_OLEN_TS;
+			memcpy(opts + opts_len, &ts, sizeof(struct tcp_option_timestamp));
+			opts_len += sizeof(struct tcp_option_timestamp);
+			opts[opts_len++] = TCP_OPT_EOL;
+			memset(opts + opts_len, 0, 40 - opts_len);
+			opts_len = 40;
+			break;
+		default:
+			/* NOP, NOP, SACK with 4 blocks, MSS */
+			opts[opts_len++] = TCP_OPT_NOP;
+			opts[opts_len++] = TCP_OPT_NOP;
+			blocks_nr = 4;
+			break;
+	}
+
+	if(blocks_nr > 0)
+	{
+		uint32_t edge = seq + 1460 * (1 + counter % 5);
+
+		opts[opts_len++] = TCP_OPT_SACK;
+		opts[opts_len++] = 2 + blocks_nr * sizeof(sack_block_t);
+		for(i = 0; i < blocks_nr; i++)
+		{
+			sack_block_t sack_block;
+			const uint32_t len = 1460 * (1 + (counter + i) % 7);
+
+			sack_block.block_start = htonl(edge);
+			sack_block.block_end = htonl(edge + len);
+			memcpy(opts + opts_len, &sack_block, sizeof(sack_block_t));
+			opts_len += sizeof(sack_block_t);
+			edge += len + 1460 * (1 + (counter * i) % 3);
+		}
+		if(opts_len < 40)
+		{
+			opts[opts_len++] = TCP_OPT_MSS;
+			opts[opts_len++] = TCP_OLEN_MSS;
+			opts[opts_len++] = (1460 >> 8) & 0xff;
+			opts[opts_len++] = 1460 & 0xff;
+		}
+	}
+	assert(opts_len == 40);
+	tcp->data_offset = (sizeof(struct tcphdr) + opts_len) / 4;
+
+	/* 100 bytes of payload */
+	memset(opts + opts_len, counter & 0xff, 100);
+
+	return wc_build_ipv4(data, ROHC_IPPROTO_TCP, counter,
+	                     sizeof(struct tcphdr) + opts_len + 100);
+}
+
+
+/**
+ * @brief Build one IPv4/UDP/RTP packet
+ *
+ * @param counter  The number of the packet in the stream
+ * @param data     The buffer to build the packet in
+ * @return         The length of the packet
+ */
+static size_t wc_build_rtp(const size_t counter, uint8_t *const data)
+{
+	struct udphdr *const udp = (struct udphdr *) (data + sizeof(struct ipv4_hdr));
+	struct rtphdr *const rtp = (struct rtphdr *) (udp + 1);
+	const size_t l4_len = sizeof(struct udphdr) + sizeof(struct rtphdr) + 20;
+
+	udp->source = htons(WC_RTP_PORT);
+	udp->dest = htons(WC_RTP_PORT);
+	udp->len = htons(l4_len);
+	udp->check = 0;
+
+	rtp->version = 2;
+	rtp->padding = 0;
+	rtp->extension = 0;
+	rtp->cc = 0;
+	rtp->m = 0;
+	rtp->pt = 96;
+	rtp->sn = htons(counter & 0xffff);
+	rtp->timestamp = htonl(counter * 160);
+	rtp->ssrc = htonl(0x11223344);
+	memset(rtp + 1, counter & 0xff, 20);
+
+	return wc_build_ipv4(data, ROHC_IPPROTO_UDP, counter, l4_len);
+}
+
+
+/**
+ * @brief Build one IPv4/UDP packet that fills the whole MRRU once compressed
+ *
+ * @param counter  The number of the packet in the stream
+ * @param data     The buffer to build the packet in
+ * @return         The length of the packet
+ */
+static size_t wc_build_mrru(const size_t counter, uint8_t *const data)
+{
+	struct udphdr *const udp = (struct udphdr *) (data + sizeof(struct ipv4_hdr));
+	/* keep room for the ROHC header and the CRC of the reassembled unit */
+	const size_t l4_len = 65535 - sizeof(struct ipv4_hdr) - 64;
+	size_t i;
+
+	udp->source = htons(5000);
+	udp->dest = htons(5001);
+	udp->len = htons(l4_len);
+	udp->check = htons(0x1234 + counter);
+	for(i = sizeof(struct udphdr); i < l4_len; i++)
+	{
+		((uint8_t *) udp)[i] = (i + counter) & 0xff;
+	}
+
+	return wc_build_ipv4(data, ROHC_IPPROTO_UDP, counter, l4_len);
+}
+
+
+/**
+ * @brief Build the IPv4 header in front of the given transport header
+ *
+ * @param data      The buffer to build the packet in
+ * @param protocol  The transport protocol
+ * @param counter   The number of the packet in the stream
+ * @param l4_len    The length of the transport header and payload
+ * @return          The length of the packet
+ */
+static size_t wc_build_ipv4(uint8_t *const data,
+                            const uint8_t protocol,
+                            const size_t counter,
+                            const size_t l4_len)
+{
+	struct ipv4_hdr *const ipv4 = (struct ipv4_hdr *) data;
+
+	ipv4->version = 4;
+	ipv4->ihl = 5;
+	ipv4->tos = 0;
+	ipv4->tot_len = htons(sizeof(struct ipv4_hdr) + l4_len);
+	ipv4->id = htons(counter & 0xffff);
+	ipv4->frag_off = htons(IPV4_DF);
+	ipv4->ttl = 64;
+	ipv4->protocol = protocol;
+	ipv4->check = 0;
+	ipv4->saddr = htonl(0xc0a80001);
+	ipv4->daddr = htonl(0xc0a80002);
+	ipv4->check = ip_fast_csum((uint8_t *) ipv4, ipv4->ihl);
+
+	return sizeof(struct ipv4_hdr) + l4_len;
+}
+
+
+/**
+ * @brief Load all the ROHC packets of a capture in memory
+ *
+ * @param filename  The name of the PCAP file
+ * @param stream    The stream to add the ROHC packets to
+ * @return          true if the capture was loaded, false otherwise
+ */
+static bool wc_load_capture(const char *const filename,
+                            struct wc_stream *const stream)
+{
+	char errbuf[PCAP_ERRBUF_SIZE];
+	struct pcap_pkthdr header;
+	unsigned char *packet;
+	int link_layer_type;
+	size_t link_len;
+	pcap_t *handle;
+
+	/* open the PCAP file that contains the stream */
+	handle = pcap_open_offline(filename, errbuf);
+	if(handle == NULL)
+	{
+		fprintf(stderr, "failed to open the pcap file: %s\n", errbuf);
+		goto error;
+	}
+
+	/* link layer in the capture must be Ethernet */
+	link_layer_type = pcap_datalink(handle);
+	if(link_layer_type == DLT_EN10MB)
+	{
+		link_len = ETHER_HDR_LEN;
+	}
+	else if(link_layer_type == DLT_LINUX_SLL)
+	{
+		link_len = LINUX_COOKED_HDR_LEN;
+	}
+	else if(link_layer_type == DLT_RAW)
+	{
+		link_len = 0;
+	}
+	else
+	{
+		fprintf(stderr, "link layer type %d not supported in capture "
+		        "(supported = %d, %d, %d)\n", link_layer_type,
+		        DLT_EN10MB, DLT_LINUX_SLL, DLT_RAW);
+		goto close_input;
+	}
+
+	while((packet = (unsigned char *) pcap_next(handle, &header)) != NULL)
+	{
+		/* empty ROHC packets are decompressed too */
+		if(header.len < link_len || header.len != header.caplen)
+		{
+			fprintf(stderr, "packet %zu: bad PCAP packet (len = %u, "
+			        "caplen = %u)\n", stream->packets_nr + 1, header.len,
+			        header.caplen);
+			goto free_packets;
+		}
+		if(!wc_stream_add(stream, packet + link_len, header.caplen - link_len))
+		{
+			goto free_packets;
+		}
+	}
+
+	pcap_close(handle);
+	return true;
+
+free_packets:
+	wc_stream_free(stream);
+close_input:
+	pcap_close(handle);
+error:
+	return false;
+}
+
+
+/**
+ * @brief Add one ROHC packet at the end of a stream
+ *
+ * @param stream  The stream to add the ROHC packet to
+ * @param data    The ROHC packet
+ * @param len     The length of the ROHC packet
+ * @return        true if the packet was added, false otherwise
+ */
+static bool wc_stream_add(struct wc_stream *const stream,
+                          const uint8_t *const data,
+                          const size_t len)
+{
+	struct wc_packet *new_packet;
+
+	/* grow the array of packets by powers of two */
+	if(stream->packets_nr == stream->packets_max)
+	{
+		const size_t new_max =
+			(stream->packets_max > 0 ? stream->packets_max * 2 : 1024);
+		struct wc_packet *const new_packets =
+			realloc(stream->packets, new_max * sizeof(struct wc_packet));
+		if(new_packets == NULL)
+		{
+			fprintf(stderr, "failed to allocate memory for %zu packets\n",
+			        new_max);
+			goto error;
+		}
+		stream->packets = new_packets;
+		stream->packets_max = new_max;
+	}
+
+	new_packet = &(stream->packets[stream->packets_nr]);
+	new_packet->data = malloc(len + 1); /* ROHC packet may be empty */
+	if(new_packet->data == NULL)
+	{
+		fprintf(stderr, "packet %zu: failed to allocate memory for %zu "
+		        "bytes\n", stream->packets_nr + 1, len);
+		goto error;
+	}
+	memcpy(new_packet->data, data, len);
+	new_packet->len = len;
+	stream->packets_nr++;
+
+	return true;
+
+error:
+	return false;
+}
+
+
+/**
+ * @brief Free the ROHC packets of a stream
+ *
+ * @param stream  The stream to free the ROHC packets of
+ */
+static void wc_stream_free(struct wc_stream *const stream)
+{
+	size_t i;
+
+	for(i = 0; i < stream->packets_nr; i++)
+	{
+		free(stream->packets[i].data);
+	}
+	free(stream->packets);
+	stream->packets = NULL;
+	stream->packets_nr = 0;
+	stream->packets_max = 0;
+}
+
+
+/**
+ * @brief Create the decompressor for one stream
+ *
+ * @param stream  The stream to decompress
+ * @return        The decompressor with all the profiles and the CRC repair
+ *                enabled, NULL in case of failure
+ */
+static struct rohc_decomp * wc_decomp_new(const struct wc_stream *const stream)
+{
+	struct rohc_decomp *decomp;
+
+	decomp = rohc_decomp_new2(stream->cid_type, stream->max_cid, stream->mode);
+	if(decomp == NULL)
+	{
+		fprintf(stderr, "cannot create the ROHC decompressor\n");
+		goto error;
+	}
+	if(!rohc_decomp_enable_profiles(decomp, ROHC_PROFILE_UNCOMPRESSED,
+	                                ROHC_PROFILE_RTP, ROHC_PROFILE_UDP,
+	                                ROHC_PROFILE_IP, ROHC_PROFILE_UDPLITE,
+	                                ROHC_PROFILE_ESP, ROHC_PROFILE_TCP, -1) ||
+	   !rohc_decomp_set_mrru(decomp, WC_PACKET_MAX_LEN) ||
+	   !rohc_decomp_set_features(decomp, ROHC_DECOMP_FEATURE_CRC_REPAIR))
+	{
+		fprintf(stderr, "failed to configure the ROHC decompressor\n");
+		goto free_decomp;
+	}
+
+	return decomp;
+
+free_decomp:
+	rohc_decomp_free(decomp);
+error:
+	return NULL;
+}
+
+
+/**
+ * @brief Decompress one stream several times and find its slowest packet
+ *
+ * @param stream       The stream to decompress
+ * @param runs_nr      The number of times the stream is decompressed
+ * @param[out] result  The decompression times of the stream
+ * @return             true if the stream was decompressed, false otherwise
+ */
+static bool wc_decompress_stream(const struct wc_stream *const stream,
+                                 const size_t runs_nr,
+                                 struct wc_result *const result)
+{
+	const struct rohc_ts arrival_time = { .sec = 0, .nsec = 0 };
+	rohc_status_t *statuses;
+	uint64_t *durations;
+	size_t run;
+	size_t i;
+
+	memset(result, 0, sizeof(struct wc_result));
+	result->packets_nr = stream->packets_nr;
+	result->worst_status = ROHC_STATUS_OK;
+
+	durations = malloc((stream->packets_nr + 1) * sizeof(uint64_t));
+	if(durations == NULL)
+	{
+		fprintf(stderr, "failed to allocate memory for %zu durations\n",
+		        stream->packets_nr);
+		goto error;
+	}
+	statuses = malloc((stream->packets_nr + 1) * sizeof(rohc_status_t));
+	if(statuses == NULL)
+	{
+		fprintf(stderr, "failed to allocate memory for %zu statuses\n",
+		        stream->packets_nr);
+		goto free_durations;
+	}
+	for(i = 0; i < stream->packets_nr; i++)
+	{
+		durations[i] = UINT64_MAX;
+	}
+
+	for(run = 0; run < runs_nr; run++)
+	{
+		struct rohc_decomp *const decomp = wc_decomp_new(stream);
+
+		if(decomp == NULL)
+		{
+			goto free_statuses;
+		}
+
+		for(i = 0; i < stream->packets_nr; i++)
+		{
+			const struct rohc_buf rohc_packet =
+				rohc_buf_init_full(stream->packets[i].data,
+				                   stream->packets[i].len, arrival_time);
+			struct rohc_buf uncomp_packet =
+				rohc_buf_init_empty(wc_uncomp_buf, sizeof(wc_uncomp_buf));
+			uint64_t start;
+			uint64_t end;
+
+			start = wc_now_ns();
+			statuses[i] = rohc_decompress3(decomp, rohc_packet, &uncomp_packet,
+			                               NULL, NULL);
+			end = wc_now_ns();
+
+			/* keep the fastest run of every packet, the slower runs were
+			 * disturbed by the system */
+			if((end - start) < durations[i])
+			{
+				durations[i] = end - start;
+			}
+		}
+
+		rohc_decomp_free(decomp);
+	}
+
+	/* the statuses are the same for every run */
+	for(i = 0; i < stream->packets_nr; i++)
+	{
+		result->total_ns += durations[i];
+		result->failures_nr += (statuses[i] != ROHC_STATUS_OK);
+		if(durations[i] > result->max_ns)
+		{
+			result->max_ns = durations[i];
+			result->worst_idx = i;
+			result->worst_status = statuses[i];
+		}
+	}
+
+	free(statuses);
+	free(durations);
+	return true;
+
+free_statuses:
+	free(statuses);
+free_durations:
+	free(durations);
+error:
+	return false;
+}
+
+
+/**
+ * @brief Read the monotonic clock
+ *
+ * @return  The current time (in nanoseconds)
+ */
+static uint64_t wc_now_ns(void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return ((uint64_t) now.tv_sec) * 1000000000U + now.tv_nsec;
+}
+
+
+/**
+ * @brief Generate a false random number for testing the ROHC library
+ *
+ * @param comp          The ROHC compressor
+ * @param user_context  Should always be NULL
+ * @return              Always 0
+ */
+static int gen_false_random_num(const struct rohc_comp *const comp,
+                                void *const user_context)
+{
+	assert(comp != NULL);
+	assert(user_context == NULL);
+	return 0;
+}
+
+
+/**
+ * @brief The RTP detection callback
+ *
+ * The RTP flows are the UDP flows towards the port of the 'crc-repair'
+ * stream.
+ *
+ * @param ip            The innermost IP packet
+ * @param udp           The UDP header of the packet
+ * @param payload       The UDP payload of the packet
+ * @param payload_size  The size of the UDP payload (in bytes)
+ * @param rtp_private   Unused
+ * @return              true if the packet is an RTP packet, false otherwise
+ */
+static bool rohc_comp_rtp_cb(const unsigned char *const ip __attribute__((unused)),
+                             const unsigned char *const udp,
+                             const unsigned char *const payload __attribute__((unused)),
+                             const unsigned int payload_size __attribute__((unused)),
+                             void *const rtp_private __attribute__((unused)))
+{
+	const struct udphdr *const udp_hdr = (const struct udphdr *) udp;
+	return (ntohs(udp_hdr->dest) == WC_RTP_PORT);
+}
+
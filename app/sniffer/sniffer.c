@@ -31,6 +31,22 @@
  *   the ROHC library with them. The packets are compressed, then decompressed,
  *   and finally compared with the original IP packets.
  *
+ * Multi-queue capture:
+ *   With the --workers option, the packets are captured with AF_PACKET
+ *   TPACKET_V3 ring buffers instead of libpcap. Every worker thread owns one
+ *   ring and one compressor/decompressor pair, the kernel dispatches the
+ *   packets to the workers by flow hash (packet fanout). All the packets of
+ *   one flow are thus handled by the same pair, and the workers run in
+ *   parallel on different CPUs.
+ *
+ *   With the --xdp option, the workers capture with AF_XDP sockets instead:
+ *   worker N reads the RX queue N of the network device, and the NIC spreads
+ *   the flows over its queues (RSS). The frames received in the UMEM of the
+ *   socket are compressed and decompressed in place, without any copy, so
+ *   that links of several tens of Gbps may be tested. The packets of the
+ *   captured queues are redirected to the sniffer and no longer reach the
+ *   network stack: capture on a dedicated port, eg. a mirror port.
+ *
  * Statistics:
  *   Some statistics are gathered during the tests. There are printed on the
  *   console. More stats should be added. A better way to export them remains to
@@ -39,9 +55,13 @@
  * Post-mortem bug analysis:
  *   The program stops (assertion) if compression/decompression/comparison
  *   fails. The last library traces are recorded and printed in case of error.
- *   The last packets are recorded in PCAP files, one per context. This is
- *   also a good idea to run the program with core enabled. Many elements are
- *   thus available to reproduce and fix the discovered problems.
+ *   The last packets of every context are kept in memory. Once a context
+ *   fails or corrects a CRC failure, its recent and next packets are recorded
+ *   in one PCAP file by a background writer, so that the capture never waits
+ *   for the disk. The last packets are also dumped in a PCAP file in case of
+ *   crash. This is also a good idea to run the program with core enabled.
+ *   Many elements are thus available to reproduce and fix the discovered
+ *   problems.
  */
 
 #include "config.h" /* for HAVE_*_H and PACKAGE_BUGREPORT */
@@ -66,7 +86,20 @@
 #include <sys/types.h>
 #include <fcntl.h>
 #include <limits.h>
+#include <pthread.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
 #include <linux/if.h>
+#include <linux/if_arp.h>
+#include <linux/if_ether.h>
+#include <linux/if_packet.h>
+#include <sys/time.h>
+#if HAVE_LIBXDP == 1
+#  include <linux/if_xdp.h>
+#  include <xdp/xsk.h>
+#endif
 
 /* include for the PCAP library */
 #if HAVE_PCAP_PCAP_H == 1
@@ -105,6 +138,43 @@ for ./configure ? If yes, check configure output and config.log"
 /** The minimum Ethernet length (in bytes) */
 #define ETHER_FRAME_MIN_LEN  60U
 
+/** The max number of worker threads */
+#define SNIFFER_WORKERS_MAX  64U
+
+/** The default number of blocks in the capture ring of one worker */
+#define SNIFFER_RING_BLOCKS_DEFAULT  64U
+
+/** The size (in bytes) of one block of the capture rings */
+#define SNIFFER_RING_BLOCK_SIZE  (1U << 20)
+
+/** The size (in bytes) of the frames of the capture rings */
+#define SNIFFER_RING_FRAME_SIZE  2048U
+
+/** The time (in ms) after which the kernel hands over a partial block */
+#define SNIFFER_RING_BLOCK_TIMEOUT  10U
+
+/** The time (in ms) a worker waits for a block before checking for stop */
+#define SNIFFER_RING_POLL_TIMEOUT  100
+
+#if HAVE_LIBXDP == 1
+
+/** The number of frames in the UMEM of one AF_XDP socket */
+#define SNIFFER_XDP_FRAMES_NR  4096U
+
+/** The max number of frames a worker handles at once from its AF_XDP socket */
+#define SNIFFER_XDP_BATCH_LEN  64U
+
+#endif
+
+/** The number of recent packets kept in memory by every capture thread */
+#define SNIFFER_HISTORY_LEN  1024U
+
+/** The number of packets the background PCAP writer may queue */
+#define SNIFFER_WRITER_QUEUE_LEN  4096U
+
+/** The CID of the history entries that hold no packet */
+#define SNIFFER_CID_NONE  ((size_t) -1)
+
 
 /** Some statistics collected by the sniffer */
 struct sniffer_stats_t
@@ -158,6 +228,123 @@ struct sniffer_stats_t
 };
 
 
+/** The results of the tests run with the sniffed packets */
+struct sniffer_results_t
+{
+	unsigned int nb_ok;            /**< The packets that passed the test */
+	unsigned int nb_bad;           /**< The malformed captured packets */
+	unsigned int nb_internal_err;  /**< The internal errors */
+	unsigned int err_comp;         /**< The compression failures */
+	unsigned int err_decomp;       /**< The decompression failures */
+	unsigned int nb_ref;           /**< The comparison failures */
+};
+
+
+/** One recent packet kept in memory by a capture thread */
+struct sniffer_history_entry_t
+{
+	size_t cid;                    /**< The context of the packet */
+	struct pcap_pkthdr header;     /**< The PCAP header of the packet */
+	uint8_t *data;                 /**< The packet (link layer included) */
+	size_t data_max;               /**< The length of the packet buffer */
+};
+
+
+/**
+ * @brief The recorder of the packets sniffed by one capture thread
+ *
+ * The history and the triggers are used by the capture thread only, the
+ * dumpers by the background writer only.
+ */
+struct sniffer_recorder_t
+{
+	struct sniffer_writer_t *writer;  /**< The background PCAP writer */
+	size_t max_contexts;           /**< The maximum number of contexts */
+	char dump_prefix[32];          /**< The prefix of the dump files */
+
+	/** The last packets, whatever their context */
+	struct sniffer_history_entry_t history[SNIFFER_HISTORY_LEN];
+	size_t history_next;           /**< The next history entry to fill */
+	/** Whether the packets shall be recorded, one per context plus one for
+	 *  the packets that cannot be compressed */
+	bool *is_triggered;
+	/** The number of corrected CRC failures, one per context */
+	unsigned long *crc_failures;
+
+	pcap_t *dump_handle;           /**< The PCAP handle for the dumps */
+	/** The PCAP dumpers, one per context plus one for the packets that cannot
+	 *  be compressed */
+	pcap_dumper_t **dumpers;
+};
+
+
+/** One packet queued for the background PCAP writer */
+struct sniffer_dump_entry_t
+{
+	struct sniffer_recorder_t *recorder;  /**< The recorder of the packet */
+	size_t cid;                    /**< The context of the packet */
+	unsigned long pkt_nr;          /**< The packet that triggered the record */
+	struct pcap_pkthdr header;     /**< The PCAP header of the packet */
+	uint8_t *data;                 /**< The packet, NULL to close the dumper */
+};
+
+
+/** The background writer of the PCAP dumps */
+struct sniffer_writer_t
+{
+	pthread_t thread;              /**< The writer thread */
+	pthread_mutex_t lock;          /**< The lock that protects the queue */
+	pthread_cond_t cond;           /**< Signaled when packets are queued */
+	pthread_cond_t written_cond;   /**< Signaled when packets are written */
+	bool do_stop;                  /**< Whether the writer shall stop */
+
+	/** The packets to write */
+	struct sniffer_dump_entry_t queue[SNIFFER_WRITER_QUEUE_LEN];
+	size_t queue_first;            /**< The first queued packet */
+	size_t queue_nr;               /**< The number of queued packets */
+	/** The packets being written, used by the writer thread only */
+	struct sniffer_dump_entry_t batch[SNIFFER_WRITER_QUEUE_LEN];
+
+	unsigned long pushed_nr;       /**< The packets queued since start */
+	unsigned long written_nr;      /**< The packets written since start */
+	unsigned long dropped_nr;      /**< The packets dropped for lack of room */
+};
+
+
+/** One worker thread of the multi-queue capture */
+struct sniffer_worker_t
+{
+	unsigned int id;               /**< The index of the worker */
+	pthread_t thread;              /**< The worker thread */
+
+	int sock;                      /**< The AF_PACKET socket */
+	struct tpacket_req3 ring_req;  /**< The geometry of the capture ring */
+	uint8_t *ring;                 /**< The capture ring mapped in memory */
+	size_t ring_len;               /**< The length of the capture ring */
+	size_t link_len;               /**< The length of the link layer header */
+
+#if HAVE_LIBXDP == 1
+	void *umem_area;               /**< The frames shared with the NIC */
+	struct xsk_umem *umem;         /**< The UMEM of the AF_XDP socket */
+	struct xsk_ring_prod fill_ring; /**< The frames given to the kernel */
+	struct xsk_ring_cons comp_ring; /**< The completion ring (unused) */
+	struct xsk_socket *xsk;        /**< The AF_XDP socket, NULL if unused */
+	struct xsk_ring_cons rx_ring;  /**< The frames received */
+#endif
+
+	struct rohc_comp *comp;        /**< The compressor of the worker */
+	struct rohc_decomp *decomp;    /**< The decompressor of the worker */
+	/** The feedback to piggyback on the next ROHC packet */
+	uint8_t feedback_send_buf[MAX_ROHC_SIZE];
+	struct rohc_buf feedback_send; /**< The feedback to piggyback */
+
+	struct sniffer_recorder_t *recorder; /**< The recorder of the worker */
+
+	struct sniffer_stats_t stats;  /**< The statistics of the worker */
+	struct sniffer_results_t results; /**< The results of the worker */
+};
+
+
 /* prototypes of private functions */
 
 static void usage(void);
@@ -169,16 +356,102 @@ static bool sniff(const rohc_cid_type_t cid_type,
                   const int enabled_profiles[],
                   const char *const device_name)
 	__attribute__((warn_unused_result, nonnull(4)));
+static bool sniff_workers(const rohc_cid_type_t cid_type,
+                          const size_t max_contexts,
+                          const int enabled_profiles[],
+                          const char *const device_name,
+                          const unsigned int workers_nr,
+                          const unsigned int ring_blocks_nr,
+                          const bool use_xdp)
+	__attribute__((warn_unused_result, nonnull(4)));
+static bool sniffer_create_rohc(const rohc_cid_type_t cid_type,
+                                const size_t max_contexts,
+                                const int enabled_profiles[],
+                                struct rohc_comp **const comp,
+                                struct rohc_decomp **const decomp)
+	__attribute__((warn_unused_result, nonnull(3, 4, 5)));
+static bool sniffer_worker_open(struct sniffer_worker_t *const worker,
+                                const int ifindex,
+                                const bool is_ether,
+                                const int fanout_id,
+                                const unsigned int ring_blocks_nr)
+	__attribute__((warn_unused_result, nonnull(1)));
+static void sniffer_worker_close(struct sniffer_worker_t *const worker)
+	__attribute__((nonnull(1)));
+static void * sniffer_worker_run(void *arg)
+	__attribute__((nonnull(1)));
+#if HAVE_LIBXDP == 1
+static bool sniffer_worker_open_xdp(struct sniffer_worker_t *const worker,
+                                    const char *const device_name)
+	__attribute__((warn_unused_result, nonnull(1, 2)));
+static void * sniffer_worker_run_xdp(void *arg)
+	__attribute__((nonnull(1)));
+#endif
+static unsigned long sniffer_stats_unit(const unsigned long long pre_bytes,
+                                        const unsigned long long post_bytes)
+	__attribute__((warn_unused_result, const));
+static void sniffer_stats_merge(struct sniffer_stats_t *const total,
+                                const struct sniffer_worker_t *const workers,
+                                const unsigned int workers_nr)
+	__attribute__((nonnull(1, 2)));
 static int compress_decompress(struct rohc_comp *comp,
                                struct rohc_decomp *decomp,
                                struct pcap_pkthdr header,
                                unsigned char *packet,
                                size_t link_len_src,
-                               pcap_t *handle,
-                               pcap_dumper_t *dumpers[],
+                               struct sniffer_recorder_t *const recorder,
                                struct rohc_buf *const feedback_send,
                                unsigned int *const cid,
                                struct sniffer_stats_t *stats);
+static bool sniffer_check_result(const int ret,
+                                 struct sniffer_results_t *const results,
+                                 struct sniffer_stats_t *const stats,
+                                 const unsigned int cid)
+	__attribute__((nonnull(2, 3)));
+
+
+static struct sniffer_recorder_t *
+	sniffer_recorder_new(struct sniffer_writer_t *const writer,
+	                     const size_t max_contexts,
+	                     const int link_type,
+	                     const char *const dump_prefix)
+	__attribute__((warn_unused_result, nonnull(1, 4)));
+static void sniffer_recorder_free(struct sniffer_recorder_t *const recorder)
+	__attribute__((nonnull(1)));
+static void sniffer_recorder_add(struct sniffer_recorder_t *const recorder,
+                                 const size_t cid,
+                                 const struct pcap_pkthdr header,
+                                 const unsigned char *const packet,
+                                 const unsigned long pkt_nr)
+	__attribute__((nonnull(1, 4)));
+static void sniffer_recorder_trigger(struct sniffer_recorder_t *const recorder,
+                                     const size_t cid,
+                                     const unsigned long pkt_nr)
+	__attribute__((nonnull(1)));
+static void sniffer_recorder_reset(struct sniffer_recorder_t *const recorder,
+                                   const size_t cid)
+	__attribute__((nonnull(1)));
+static void sniffer_recorder_dump_history(struct sniffer_recorder_t *const recorder)
+	__attribute__((nonnull(1)));
+
+static bool sniffer_writer_start(struct sniffer_writer_t *const writer)
+	__attribute__((warn_unused_result, nonnull(1)));
+static void sniffer_writer_stop(struct sniffer_writer_t *const writer)
+	__attribute__((nonnull(1)));
+static void sniffer_writer_push(struct sniffer_writer_t *const writer,
+                                struct sniffer_recorder_t *const recorder,
+                                const size_t cid,
+                                const unsigned long pkt_nr,
+                                const struct pcap_pkthdr header,
+                                const unsigned char *const packet)
+	__attribute__((nonnull(1, 2)));
+static void sniffer_writer_flush(struct sniffer_writer_t *const writer)
+	__attribute__((nonnull(1)));
+static void * sniffer_writer_run(void *arg)
+	__attribute__((nonnull(1)));
+static void sniffer_writer_write_batch(struct sniffer_dump_entry_t *const batch,
+                                       const size_t batch_nr)
+	__attribute__((nonnull(1)));
 
 static int compare_packets(const struct rohc_buf pkt1,
                            const struct rohc_buf pkt2)
@@ -225,8 +498,13 @@ static bool is_verbose;
 /** Whether the application prints stats at regular interval of time or not */
 static bool do_print_stat;
 
-/** The PCAP dumpers */
-static pcap_dumper_t *sniffer_dumpers[ROHC_LARGE_CID_MAX + 1] = { 0 };
+/** The background writer of the PCAP dumps */
+static struct sniffer_writer_t sniffer_writer;
+
+/** The recorders of all the capture threads, for post-mortem analysis */
+static struct sniffer_recorder_t *sniffer_recorders[SNIFFER_WORKERS_MAX];
+/** The number of recorders */
+static size_t sniffer_recorders_nr = 0;
 
 /** The maximum number of traces to keep */
 #define MAX_LAST_TRACES  5000
@@ -239,6 +517,8 @@ static char last_traces[MAX_LAST_TRACES][MAX_LAST_TRACES + 1];
 static int last_traces_first;
 /** The index of the last trace */
 static int last_traces_last;
+/** The lock that protects the ring buffer of traces from worker threads */
+static pthread_mutex_t last_traces_lock = PTHREAD_MUTEX_INITIALIZER;
 
 /** Whether to print traces on stderr or not */
 static bool do_print_stderr = true;
@@ -275,6 +555,9 @@ int main(int argc, char *argv[])
 	char *cid_type_name = NULL;
 	char *device_name = NULL;
 	int max_contexts = ROHC_SMALL_CID_MAX + 1;
+	int workers_nr = 0;
+	int ring_blocks_nr = SNIFFER_RING_BLOCKS_DEFAULT;
+	bool use_xdp = false;
 	rohc_cid_type_t cid_type;
 	int args_used;
 	int ret;
@@ -366,6 +649,23 @@ int main(int argc, char *argv[])
 			max_contexts = atoi(argv[1]);
 			args_used++;
 		}
+		else if(!strcmp(*argv, "-w") || !strcmp(*argv, "--workers"))
+		{
+			/* get the number of worker threads for multi-queue capture */
+			workers_nr = atoi(argv[1]);
+			args_used++;
+		}
+		else if(!strcmp(*argv, "--ring-blocks"))
+		{
+			/* get the number of 1 MiB blocks in the ring of every worker */
+			ring_blocks_nr = atoi(argv[1]);
+			args_used++;
+		}
+		else if(!strcmp(*argv, "--xdp"))
+		{
+			/* capture with AF_XDP sockets instead of AF_PACKET rings */
+			use_xdp = true;
+		}
 		else if(!strcmp(*argv, "--disable"))
 		{
 			/* disable the given ROHC profile */
@@ -457,6 +757,37 @@ int main(int argc, char *argv[])
 		goto error;
 	}
 
+	/* the multi-queue capture parameters should be valid */
+	if(workers_nr < 0 || (unsigned int) workers_nr > SNIFFER_WORKERS_MAX)
+	{
+		SNIFFER_LOG(LOG_WARNING, "the number of workers should not be greater "
+		            "than %u", SNIFFER_WORKERS_MAX);
+		usage();
+		goto error;
+	}
+	if(ring_blocks_nr < 1 || ring_blocks_nr > 4096)
+	{
+		SNIFFER_LOG(LOG_WARNING, "the number of ring blocks should be between "
+		            "1 and 4096");
+		usage();
+		goto error;
+	}
+	if(use_xdp && workers_nr == 0)
+	{
+		SNIFFER_LOG(LOG_WARNING, "option --xdp cannot be used without option "
+		            "--workers");
+		usage();
+		goto error;
+	}
+#if HAVE_LIBXDP != 1
+	if(use_xdp)
+	{
+		SNIFFER_LOG(LOG_WARNING, "option --xdp is not available, the sniffer "
+		            "was built without libxdp");
+		goto error;
+	}
+#endif
+
 	/* --pidfile cannot be used in foreground mode */
 	if(pidfilename != NULL && !is_daemon)
 	{
@@ -530,7 +861,15 @@ int main(int argc, char *argv[])
 	}
 
 	/* test ROHC compression/decompression with the packets from the file */
-	if(!sniff(cid_type, max_contexts, enabled_profiles, device_name))
+	if(workers_nr > 0)
+	{
+		if(!sniff_workers(cid_type, max_contexts, enabled_profiles, device_name,
+		                  workers_nr, ring_blocks_nr, use_xdp))
+		{
+			goto error;
+		}
+	}
+	else if(!sniff(cid_type, max_contexts, enabled_profiles, device_name))
 	{
 		goto error;
 	}
@@ -585,6 +924,17 @@ static void usage(void)
 	       "  -p, --pidfile FILE      Write daemon PID in the given file\n"
 	       "  -m, --max-contexts NUM  The maximum number of ROHC contexts to\n"
 	       "                          simultaneously use during the test\n"
+	       "  -w, --workers NUM       Capture with NUM worker threads that\n"
+	       "                          share the traffic by flow, each with its\n"
+	       "                          own AF_PACKET ring and ROHC compressor/\n"
+	       "                          decompressor pair (Linux only)\n"
+	       "      --ring-blocks NUM   The number of 1 MiB blocks in the ring\n"
+	       "                          of every worker (default: %u)\n"
+	       "      --xdp               Capture with AF_XDP sockets instead of\n"
+	       "                          AF_PACKET rings, worker N reads the RX\n"
+	       "                          queue N of DEVICE without copy; the\n"
+	       "                          packets no longer reach the network\n"
+	       "                          stack (Linux only, with --workers)\n"
 	       "      --disable PROFILE   A ROHC profile to disable\n"
 	       "                          (may be specified several times)\n"
 	       "      --verbose           Make the test more verbose\n"
@@ -596,8 +946,13 @@ static void usage(void)
 	       "  rohc_sniffer -m 450 largecid wlan0  compress traffic from\n"
 	       "                                      wlan0 with large CIDs, no\n"
 	       "                                      more than 450 streams\n"
+	       "  rohc_sniffer -w 8 largecid eth2     compress traffic from eth2\n"
+	       "                                      with 8 worker threads\n"
+	       "  rohc_sniffer -w 16 --xdp largecid eth3\n"
+	       "                                      compress traffic from the\n"
+	       "                                      16 RX queues of eth3\n"
 	       "\n"
-	       "Report bugs to <" PACKAGE_BUGREPORT ">.\n");
+	       "Report bugs to <" PACKAGE_BUGREPORT ">.\n", SNIFFER_RING_BLOCKS_DEFAULT);
 }
 
 
@@ -612,7 +967,7 @@ static void sniffer_interrupt(int signum)
 	SNIFFER_LOG(LOG_NOTICE, "signal %d catched", signum);
 	stop_program = true;
 
-	/* for SIGSEGV/SIGABRT, close the PCAP dumps, print the last debug traces,
+	/* for SIGSEGV/SIGABRT, dump the last packets, print the last debug traces,
 	 * then kill the program */
 	if(signum == SIGSEGV || signum == SIGABRT)
 	{
@@ -630,14 +985,10 @@ static void sniffer_interrupt(int signum)
 			            sniffer_stats.total_packets);
 		}
 
-		/* close PCAP dumpers */
-		for(j = 0; j <= ROHC_LARGE_CID_MAX; j++)
+		/* dump the last packets of every capture thread */
+		for(j = 0; j < sniffer_recorders_nr; j++)
 		{
-			if(sniffer_dumpers[j] != NULL)
-			{
-				SNIFFER_LOG(LOG_INFO, "close dump file for context with ID %zu", j);
-				pcap_dump_close(sniffer_dumpers[j]);
-			}
+			sniffer_recorder_dump_history(sniffer_recorders[j]);
 		}
 
 		/* print last debug traces */
@@ -901,21 +1252,16 @@ static bool sniff(const rohc_cid_type_t cid_type,
 
 	struct rohc_comp *comp;
 	struct rohc_decomp *decomp;
+	struct sniffer_recorder_t *recorder;
 
 	uint8_t feedback_send_buffer[MAX_ROHC_SIZE];
 	struct rohc_buf feedback_send =
 		rohc_buf_init_empty(feedback_send_buffer, MAX_ROHC_SIZE);
 
 	int ret;
-	unsigned int i;
 
 	/* statistics */
-	unsigned int nb_ok = 0;
-	unsigned int nb_bad = 0;
-	unsigned int nb_internal_err = 0;
-	unsigned int err_comp = 0;
-	unsigned int err_decomp = 0;
-	unsigned int nb_ref = 0;
+	struct sniffer_results_t results;
 
 	/* init status */
 	bool status = false;
@@ -956,89 +1302,31 @@ static bool sniff(const rohc_cid_type_t cid_type,
 		link_len_src = 0;
 	}
 
-	/* create the ROHC compressor */
-	comp = rohc_comp_new2(cid_type, max_contexts - 1, gen_false_random_num, NULL);
-	if(comp == NULL)
+	/* create the ROHC compressor and decompressor */
+	if(!sniffer_create_rohc(cid_type, max_contexts, enabled_profiles,
+	                        &comp, &decomp))
 	{
-		SNIFFER_LOG(LOG_WARNING, "failed to create the ROHC compressor");
 		goto close_input;
 	}
 
-	/* set the callback for traces on compressor */
-	if(!rohc_comp_set_traces_cb2(comp, print_rohc_traces, NULL))
-	{
-		SNIFFER_LOG(LOG_WARNING, "failed to set the trace callback for the "
-		            "compressor");
-		goto destroy_comp;
-	}
-
-	/* enable the compression profiles */
-	for(i = ROHC_PROFILE_UNCOMPRESSED; i <= ROHC_PROFILE_UDPLITE; i++)
-	{
-		if(enabled_profiles[i] == 1 && !rohc_comp_enable_profile(comp, i))
-		{
-			SNIFFER_LOG(LOG_WARNING, "failed to enable compression profile "
-			            "0x%04x", i);
-			goto destroy_comp;
-		}
-		else if(enabled_profiles[i] == 0 && !rohc_comp_disable_profile(comp, i))
-		{
-			SNIFFER_LOG(LOG_WARNING, "failed to disable compression profile "
-			            "0x%04x", i);
-			goto destroy_comp;
-		}
-	}
-
-	/* set the callback for RTP stream detection */
-	if(!rohc_comp_set_rtp_detection_cb(comp, rtp_detect_cb, NULL))
-	{
-		SNIFFER_LOG(LOG_WARNING, "failed to set the RTP stream detection "
-		            "callback for compressor");
-		goto destroy_comp;
-	}
-
-	/* create the decompressor (bi-directional mode) */
-	decomp = rohc_decomp_new2(cid_type, max_contexts - 1, ROHC_O_MODE);
-	if(decomp == NULL)
-	{
-		SNIFFER_LOG(LOG_WARNING, "failed to create the decompressor");
-		goto destroy_comp;
-	}
-
-	/* set the callback for traces on decompressor */
-	if(!rohc_decomp_set_traces_cb2(decomp, print_rohc_traces, NULL))
+	/* record the packets of the failing streams in PCAP files, one per
+	 * Context ID */
+	if(!sniffer_writer_start(&sniffer_writer))
 	{
-		SNIFFER_LOG(LOG_WARNING, "failed to set trace callback for "
-		            "decompressor");
-		goto destroy_decomp;
+		goto destroy_rohc;
 	}
-
-	/* enable the decompression profiles */
-	for(i = ROHC_PROFILE_UNCOMPRESSED; i <= ROHC_PROFILE_UDPLITE; i++)
+	recorder = sniffer_recorder_new(&sniffer_writer, max_contexts,
+	                                link_layer_type_src, "dump_stream");
+	if(recorder == NULL)
 	{
-		if(enabled_profiles[i] == 1 && !rohc_decomp_enable_profile(decomp, i))
-		{
-			SNIFFER_LOG(LOG_WARNING, "failed to enable decompression profile "
-			            "0x%04x", i);
-			goto destroy_decomp;
-		}
-		else if(enabled_profiles[i] == 0 &&
-		        !rohc_decomp_disable_profile(decomp, i))
-		{
-			SNIFFER_LOG(LOG_WARNING, "failed to disable decompression profile "
-			            "0x%04x", i);
-			goto destroy_decomp;
-		}
+		goto stop_writer;
 	}
 
-	/* reset the PCAP dumpers (used to save sniffed packets in several PCAP
-	 * files, one per Context ID) */
-	bzero(sniffer_dumpers, sizeof(pcap_dumper_t *) * max_contexts);
-
 	SNIFFER_LOG(LOG_INFO, "ROHC sniffer successfully started");
 	SNIFFER_LOG(LOG_INFO, "start processing captured packets");
 
 	/* for each sniffed packet */
+	memset(&results, 0, sizeof(struct sniffer_results_t));
 	sniffer_stats.total_packets = 0;
 	while(!stop_program)
 	{
@@ -1077,42 +1365,14 @@ static bool sniff(const rohc_cid_type_t cid_type,
 
 		/* compress & decompress from compressor to decompressor */
 		ret = compress_decompress(comp, decomp, header, packet,
-		                          link_len_src, handle, sniffer_dumpers,
-		                          &feedback_send, &cid, &sniffer_stats);
-		if(ret == -1)
-		{
-			err_comp++;
-		}
-		else if(ret == -2)
-		{
-			err_decomp++;
-		}
-		else if(ret == 0)
-		{
-			nb_ref++;
-		}
-		else if(ret == 1)
-		{
-			nb_ok++;
-		}
-		else if(ret == -3)
-		{
-			nb_bad++;
-			sniffer_stats.bad_packets++;
-		}
-		else
-		{
-			nb_internal_err++;
-		}
+		                          link_len_src, recorder, &feedback_send, &cid,
+		                          &sniffer_stats);
 
 		/* in case of problem (ignore bad packets), just die! */
-		if(ret != 1 && ret != -3)
+		if(!sniffer_check_result(ret, &results, &sniffer_stats, cid))
 		{
-			SNIFFER_LOG(LOG_WARNING, "packet #%lu, CID %u: stats OK, ERR(COMP), "
-			            "ERR(DECOMP), ERR(REF), ERR(BAD), ERR(INTERNAL)  =  "
-			            "%u  %u  %u  %u  %u  %u", sniffer_stats.total_packets,
-			            cid, nb_ok, err_comp, err_decomp, nb_ref, nb_bad,
-			            nb_internal_err);
+			/* write the packets of the failing stream before dying */
+			sniffer_writer_flush(&sniffer_writer);
 
 			/* last debug traces are recorded in SIGABRT handler */
 			assert(0);
@@ -1126,19 +1386,15 @@ static bool sniff(const rohc_cid_type_t cid_type,
 
 	status = true;
 
-	/* close PCAP dumpers */
-	for(i = 0; i < max_contexts; i++)
-	{
-		if(sniffer_dumpers[i] != NULL)
-		{
-			SNIFFER_LOG(LOG_INFO, "close dump file for context with ID %u", i);
-			pcap_dump_close(sniffer_dumpers[i]);
-		}
-	}
+	/* write the queued packets, then close PCAP dumpers */
+	sniffer_writer_stop(&sniffer_writer);
+	sniffer_recorder_free(recorder);
+	goto destroy_rohc;
 
-destroy_decomp:
+stop_writer:
+	sniffer_writer_stop(&sniffer_writer);
+destroy_rohc:
 	rohc_decomp_free(decomp);
-destroy_comp:
 	rohc_comp_free(comp);
 close_input:
 	pcap_close(handle);
@@ -1148,88 +1404,1527 @@ error:
 
 
 /**
- * @brief Compress and decompress one uncompressed IP packet with the given
- *        compressor and decompressor
+ * @brief Create the ROHC compressor/decompressor pair used for the tests
  *
- * @param comp           The compressor to use to compress the IP packet
- * @param decomp         The decompressor to use to decompress the IP packet
- * @param header         The PCAP header for the packet
- * @param packet         The packet to compress/decompress (link layer included)
- * @param link_len_src   The length of the link layer header before IP data
- * @param handle         The PCAP handler that sniffed the packet
- * @param dumpers        The PCAP dumpers, one per context
- * @param cid            OUT: the CID used for the last packet
- * @param stats          IN/OUT: The sniffer stats
- * @return               1 if the process is successful
- *                       0 if the decompressed packet doesn't match the
- *                         original one
- *                       -1 if an error occurs while compressing
- *                       -2 if an error occurs while decompressing
- *                       -3 if the link layer is not Ethernet
- *                       -4 if (de)compression info cannot be retrieved
+ * @param cid_type          The type of CIDs that the compressor shall use
+ * @param max_contexts      The maximum number of ROHC contexts to use
+ * @param enabled_profiles  The ROHC profiles to enable
+ * @param[out] comp         The new ROHC compressor
+ * @param[out] decomp       The new ROHC decompressor
+ * @return                  true if the pair was created, false otherwise
  */
-static int compress_decompress(struct rohc_comp *comp,
-                               struct rohc_decomp *decomp,
-                               struct pcap_pkthdr header,
-                               unsigned char *packet,
-                               size_t link_len_src,
-                               pcap_t *handle,
-                               pcap_dumper_t *dumpers[],
-                               struct rohc_buf *const feedback_send,
-                               unsigned int *const cid,
-                               struct sniffer_stats_t *stats)
+static bool sniffer_create_rohc(const rohc_cid_type_t cid_type,
+                                const size_t max_contexts,
+                                const int enabled_profiles[],
+                                struct rohc_comp **const comp,
+                                struct rohc_decomp **const decomp)
 {
-	const struct rohc_ts arrival_time = { .sec = 0, .nsec = 0 };
-	struct rohc_buf ip_packet =
-		rohc_buf_init_full(packet, header.caplen, arrival_time);
-
-	const size_t output_packet_max_len =
-		max(ETHER_HDR_LEN, LINUX_COOKED_HDR_LEN) + MAX_ROHC_SIZE;
-	uint8_t output_packet[output_packet_max_len];
-	struct rohc_buf rohc_packet =
-		rohc_buf_init_empty(output_packet, output_packet_max_len);
-
-	uint8_t decomp_buffer[MAX_ROHC_SIZE];
-	struct rohc_buf decomp_packet =
-		rohc_buf_init_empty(decomp_buffer, MAX_ROHC_SIZE);
-
-	uint8_t rcvd_feedback_buffer[MAX_ROHC_SIZE];
-	struct rohc_buf rcvd_feedback =
-		rohc_buf_init_empty(rcvd_feedback_buffer, MAX_ROHC_SIZE);
-
-	rohc_comp_last_packet_info2_t comp_last_packet_info;
-	rohc_decomp_last_packet_info_t decomp_last_packet_info;
-	unsigned long possible_unit;
-	rohc_status_t status;
-	int ret;
+	unsigned int i;
 
-	/* check Ethernet frame length */
-	if(header.len <= link_len_src || header.len != header.caplen)
+	/* create the ROHC compressor */
+	*comp = rohc_comp_new2(cid_type, max_contexts - 1, gen_false_random_num, NULL);
+	if((*comp) == NULL)
 	{
-		SNIFFER_LOG(LOG_WARNING, "bad PCAP packet (full len = %u, capture "
-		            "len = %u)", header.len, header.caplen);
-		ret = -3;
+		SNIFFER_LOG(LOG_WARNING, "failed to create the ROHC compressor");
 		goto error;
 	}
 
-	/* skip the link layer header */
-	rohc_buf_pull(&ip_packet, link_len_src);
-	rohc_packet.len += link_len_src;
-	rohc_buf_pull(&rohc_packet, link_len_src);
-
-	/* check for padding after the IP packet in the Ethernet payload */
-	if(link_len_src == ETHER_HDR_LEN && header.len == ETHER_FRAME_MIN_LEN)
+	/* set the callback for traces on compressor */
+	if(!rohc_comp_set_traces_cb2(*comp, print_rohc_traces, NULL))
 	{
-		int version;
-		uint16_t tot_len;
+		SNIFFER_LOG(LOG_WARNING, "failed to set the trace callback for the "
+		            "compressor");
+		goto destroy_comp;
+	}
 
-		version = (rohc_buf_byte(ip_packet) >> 4) & 0x0f;
-		if(version == 4)
+	/* enable the compression profiles */
+	for(i = ROHC_PROFILE_UNCOMPRESSED; i <= ROHC_PROFILE_UDPLITE; i++)
+	{
+		if(enabled_profiles[i] == 1 && !rohc_comp_enable_profile(*comp, i))
 		{
-			memcpy(&tot_len, rohc_buf_data_at(ip_packet, 2), sizeof(uint16_t));
-			tot_len = ntohs(tot_len);
+			SNIFFER_LOG(LOG_WARNING, "failed to enable compression profile "
+			            "0x%04x", i);
+			goto destroy_comp;
 		}
-		else
+		else if(enabled_profiles[i] == 0 && !rohc_comp_disable_profile(*comp, i))
+		{
+			SNIFFER_LOG(LOG_WARNING, "failed to disable compression profile "
+			            "0x%04x", i);
+			goto destroy_comp;
+		}
+	}
+
+	/* set the callback for RTP stream detection */
+	if(!rohc_comp_set_rtp_detection_cb(*comp, rtp_detect_cb, NULL))
+	{
+		SNIFFER_LOG(LOG_WARNING, "failed to set the RTP stream detection "
+		            "callback for compressor");
+		goto destroy_comp;
+	}
+
+	/* create the decompressor (bi-directional mode) */
+	*decomp = rohc_decomp_new2(cid_type, max_contexts - 1, ROHC_O_MODE);
+	if((*decomp) == NULL)
+	{
+		SNIFFER_LOG(LOG_WARNING, "failed to create the decompressor");
+		goto destroy_comp;
+	}
+
+	/* set the callback for traces on decompressor */
+	if(!rohc_decomp_set_traces_cb2(*decomp, print_rohc_traces, NULL))
+	{
+		SNIFFER_LOG(LOG_WARNING, "failed to set trace callback for "
+		            "decompressor");
+		goto destroy_decomp;
+	}
+
+	/* enable the decompression profiles */
+	for(i = ROHC_PROFILE_UNCOMPRESSED; i <= ROHC_PROFILE_UDPLITE; i++)
+	{
+		if(enabled_profiles[i] == 1 && !rohc_decomp_enable_profile(*decomp, i))
+		{
+			SNIFFER_LOG(LOG_WARNING, "failed to enable decompression profile "
+			            "0x%04x", i);
+			goto destroy_decomp;
+		}
+		else if(enabled_profiles[i] == 0 &&
+		        !rohc_decomp_disable_profile(*decomp, i))
+		{
+			SNIFFER_LOG(LOG_WARNING, "failed to disable decompression profile "
+			            "0x%04x", i);
+			goto destroy_decomp;
+		}
+	}
+
+
+	return true;
+
+destroy_decomp:
+	rohc_decomp_free(*decomp);
+destroy_comp:
+	rohc_comp_free(*comp);
+error:
+	return false;
+}
+
+
+/**
+ * @brief Record the result of the test of one sniffed packet
+ *
+ * @param ret      The result of \ref compress_decompress
+ * @param results  IN/OUT: The results of the tests
+ * @param stats    IN/OUT: The sniffer stats
+ * @param cid      The CID used for the packet
+ * @return         false if the test found a problem in the library,
+ *                 true otherwise (bad packets are ignored)
+ */
+static bool sniffer_check_result(const int ret,
+                                 struct sniffer_results_t *const results,
+                                 struct sniffer_stats_t *const stats,
+                                 const unsigned int cid)
+{
+	if(ret == -1)
+	{
+		results->err_comp++;
+	}
+	else if(ret == -2)
+	{
+		results->err_decomp++;
+	}
+	else if(ret == 0)
+	{
+		results->nb_ref++;
+	}
+	else if(ret == 1)
+	{
+		results->nb_ok++;
+	}
+	else if(ret == -3)
+	{
+		results->nb_bad++;
+		stats->bad_packets++;
+	}
+	else
+	{
+		results->nb_internal_err++;
+	}
+
+	if(ret != 1 && ret != -3)
+	{
+		SNIFFER_LOG(LOG_WARNING, "packet #%lu, CID %u: stats OK, ERR(COMP), "
+		            "ERR(DECOMP), ERR(REF), ERR(BAD), ERR(INTERNAL)  =  "
+		            "%u  %u  %u  %u  %u  %u", stats->total_packets,
+		            cid, results->nb_ok, results->err_comp, results->err_decomp,
+		            results->nb_ref, results->nb_bad, results->nb_internal_err);
+		return false;
+	}
+
+	return true;
+}
+
+
+/**
+ * @brief Test the ROHC library with sniffed traffic shared among several
+ *        worker threads
+ *
+ * Every worker captures packets from its own TPACKET_V3 ring. The rings are
+ * part of one fanout group: the kernel steers all the packets of one flow to
+ * the same worker, so that its compressor/decompressor pair sees the whole
+ * flow. The statistics of the workers are merged at regular interval of time
+ * for printing.
+ *
+ * With AF_XDP, every worker captures packets from the RX queue of the same
+ * index instead, and the NIC steers the flows to the queues.
+ *
+ * @param cid_type          The type of CIDs that the compressors shall use
+ * @param max_contexts      The maximum number of ROHC contexts per worker
+ * @param enabled_profiles  The ROHC profiles to enable
+ * @param device_name       The name of the network device
+ * @param workers_nr        The number of worker threads
+ * @param ring_blocks_nr    The number of blocks in the ring of every worker
+ * @param use_xdp           Whether to capture with AF_XDP sockets
+ * @return                  Whether the sniffer setup was OK
+ */
+static bool sniff_workers(const rohc_cid_type_t cid_type,
+                          const size_t max_contexts,
+                          const int enabled_profiles[],
+                          const char *const device_name,
+                          const unsigned int workers_nr,
+                          const unsigned int ring_blocks_nr,
+                          const bool use_xdp)
+{
+	const int fanout_id = getpid() & 0xffff;
+	void *(*worker_run)(void *) = sniffer_worker_run;
+	struct sniffer_worker_t *workers;
+	unsigned int workers_started = 0;
+	unsigned int workers_opened = 0;
+	struct ifreq ifr;
+	bool is_ether;
+	int ifindex;
+	int sock;
+	unsigned int i;
+	bool status = false;
+
+	/* get the index and the link type of the network device */
+	sock = socket(AF_PACKET, SOCK_RAW, htons(ETH_P_ALL));
+	if(sock < 0)
+	{
+		SNIFFER_LOG(LOG_WARNING, "failed to create AF_PACKET socket: %s (%d)",
+		            strerror(errno), errno);
+		goto error;
+	}
+	memset(&ifr, 0, sizeof(struct ifreq));
+	strncpy(ifr.ifr_name, device_name, IFNAMSIZ - 1);
+	if(ioctl(sock, SIOCGIFINDEX, &ifr) != 0)
+	{
+		SNIFFER_LOG(LOG_WARNING, "failed to get the index of network device "
+		            "'%s': %s (%d)", device_name, strerror(errno), errno);
+		close(sock);
+		goto error;
+	}
+	ifindex = ifr.ifr_ifindex;
+	if(ioctl(sock, SIOCGIFHWADDR, &ifr) != 0)
+	{
+		SNIFFER_LOG(LOG_WARNING, "failed to get the link type of network "
+		            "device '%s': %s (%d)", device_name, strerror(errno), errno);
+		close(sock);
+		goto error;
+	}
+	close(sock);
+	/* keep the Ethernet header of Ethernet-like devices, let the kernel
+	 * remove the link layer header of the other devices */
+	is_ether = (ifr.ifr_hwaddr.sa_family == ARPHRD_ETHER ||
+	            ifr.ifr_hwaddr.sa_family == ARPHRD_LOOPBACK);
+	if(use_xdp && ifr.ifr_hwaddr.sa_family != ARPHRD_ETHER)
+	{
+		SNIFFER_LOG(LOG_WARNING, "AF_XDP capture requires an Ethernet network "
+		            "device");
+		goto error;
+	}
+#if HAVE_LIBXDP == 1
+	if(use_xdp)
+	{
+		worker_run = sniffer_worker_run_xdp;
+	}
+#endif
+
+	workers = calloc(workers_nr, sizeof(struct sniffer_worker_t));
+	if(workers == NULL)
+	{
+		SNIFFER_LOG(LOG_WARNING, "failed to allocate memory for %u workers",
+		            workers_nr);
+		goto error;
+	}
+
+	/* all the workers share one background PCAP writer */
+	if(!sniffer_writer_start(&sniffer_writer))
+	{
+		goto free_workers;
+	}
+
+	/* open the capture ring and create the ROHC pair of every worker */
+	for(i = 0; i < workers_nr; i++)
+	{
+		struct sniffer_worker_t *const worker = &workers[i];
+		const struct rohc_buf feedback_send =
+			rohc_buf_init_empty(worker->feedback_send_buf, MAX_ROHC_SIZE);
+		char dump_prefix[32];
+		bool is_open;
+
+		worker->id = i;
+		worker->sock = -1;
+		worker->feedback_send = feedback_send;
+		worker->stats.comp_unit_size = 1;
+
+		snprintf(dump_prefix, sizeof(dump_prefix), "dump_worker%u_stream", i);
+		worker->recorder =
+			sniffer_recorder_new(&sniffer_writer, max_contexts,
+			                     is_ether ? DLT_EN10MB : DLT_RAW, dump_prefix);
+		if(worker->recorder == NULL)
+		{
+			goto close_workers;
+		}
+		if(!sniffer_create_rohc(cid_type, max_contexts, enabled_profiles,
+		                        &worker->comp, &worker->decomp))
+		{
+			sniffer_recorder_free(worker->recorder);
+			goto close_workers;
+		}
+#if HAVE_LIBXDP == 1
+		if(use_xdp)
+		{
+			is_open = sniffer_worker_open_xdp(worker, device_name);
+		}
+		else
+#endif
+		{
+			is_open = sniffer_worker_open(worker, ifindex, is_ether, fanout_id,
+			                              ring_blocks_nr);
+		}
+		if(!is_open)
+		{
+			rohc_decomp_free(worker->decomp);
+			rohc_comp_free(worker->comp);
+			sniffer_recorder_free(worker->recorder);
+			goto close_workers;
+		}
+		workers_opened++;
+	}
+
+	SNIFFER_LOG(LOG_INFO, "ROHC sniffer successfully started with %u workers",
+	            workers_nr);
+	SNIFFER_LOG(LOG_INFO, "start processing captured packets");
+
+	/* start the workers */
+	for(i = 0; i < workers_nr; i++)
+	{
+		const int ret = pthread_create(&workers[i].thread, NULL, worker_run,
+		                               &workers[i]);
+		if(ret != 0)
+		{
+			SNIFFER_LOG(LOG_WARNING, "failed to start worker #%u: %s (%d)", i,
+			            strerror(ret), ret);
+			stop_program = true;
+			break;
+		}
+		workers_started++;
+	}
+
+	/* merge the statistics of the workers until the program is stopped */
+	while(!stop_program)
+	{
+		struct sniffer_stats_t merged_stats;
+
+		sleep(1);
+
+		sniffer_stats_merge(&merged_stats, workers, workers_started);
+		sniffer_stats = merged_stats;
+		if(!is_daemon)
+		{
+			printf("\rpacket #%lu", sniffer_stats.total_packets);
+			fflush(stdout);
+
+			if(do_print_stat)
+			{
+				printf("\n\n");
+				fprintf(stderr, "================================================\n");
+				sniffer_print_stats(SIGUSR1);
+				fprintf(stderr, "================================================\n");
+				fprintf(stderr, "\n");
+				fflush(stderr);
+			}
+		}
+	}
+	SNIFFER_LOG(LOG_INFO, "program stopped by signal");
+
+	for(i = 0; i < workers_started; i++)
+	{
+		pthread_join(workers[i].thread, NULL);
+	}
+	sniffer_stats_merge(&sniffer_stats, workers, workers_started);
+
+	status = (workers_started == workers_nr);
+
+close_workers:
+	/* write the queued packets before the PCAP dumpers are closed */
+	sniffer_writer_stop(&sniffer_writer);
+	for(i = 0; i < workers_opened; i++)
+	{
+		sniffer_worker_close(&workers[i]);
+	}
+free_workers:
+	free(workers);
+error:
+	return status;
+}
+
+
+/**
+ * @brief Open the capture ring of one worker
+ *
+ * @param worker          The worker
+ * @param ifindex         The index of the network device to capture on
+ * @param is_ether        Whether the Ethernet header shall be captured
+ * @param fanout_id       The ID of the fanout group of all the workers
+ * @param ring_blocks_nr  The number of blocks in the ring
+ * @return                true if the ring is ready, false otherwise
+ */
+static bool sniffer_worker_open(struct sniffer_worker_t *const worker,
+                                const int ifindex,
+                                const bool is_ether,
+                                const int fanout_id,
+                                const unsigned int ring_blocks_nr)
+{
+	const int version = TPACKET_V3;
+	const int fanout = fanout_id |
+		((PACKET_FANOUT_HASH | PACKET_FANOUT_FLAG_DEFRAG) << 16);
+	struct sockaddr_ll addr;
+
+	worker->sock = socket(AF_PACKET, is_ether ? SOCK_RAW : SOCK_DGRAM,
+	                      htons(ETH_P_ALL));
+	if(worker->sock < 0)
+	{
+		SNIFFER_LOG(LOG_WARNING, "worker #%u: failed to create AF_PACKET "
+		            "socket: %s (%d)", worker->id, strerror(errno), errno);
+		goto error;
+	}
+	worker->link_len = (is_ether ? ETHER_HDR_LEN : 0);
+
+	if(setsockopt(worker->sock, SOL_PACKET, PACKET_VERSION, &version,
+	              sizeof(version)) != 0)
+	{
+		SNIFFER_LOG(LOG_WARNING, "worker #%u: TPACKET_V3 not supported: "
+		            "%s (%d)", worker->id, strerror(errno), errno);
+		goto close_sock;
+	}
+
+	/* the kernel fills whole blocks of packets, and hands over partial blocks
+	 * after a timeout on low traffic */
+	memset(&worker->ring_req, 0, sizeof(struct tpacket_req3));
+	worker->ring_req.tp_block_size = SNIFFER_RING_BLOCK_SIZE;
+	worker->ring_req.tp_block_nr = ring_blocks_nr;
+	worker->ring_req.tp_frame_size = SNIFFER_RING_FRAME_SIZE;
+	worker->ring_req.tp_frame_nr =
+		(SNIFFER_RING_BLOCK_SIZE / SNIFFER_RING_FRAME_SIZE) * ring_blocks_nr;
+	worker->ring_req.tp_retire_blk_tov = SNIFFER_RING_BLOCK_TIMEOUT;
+	if(setsockopt(worker->sock, SOL_PACKET, PACKET_RX_RING, &worker->ring_req,
+	              sizeof(struct tpacket_req3)) != 0)
+	{
+		SNIFFER_LOG(LOG_WARNING, "worker #%u: failed to create the %u-block "
+		            "capture ring: %s (%d)", worker->id, ring_blocks_nr,
+		            strerror(errno), errno);
+		goto close_sock;
+	}
+	worker->ring_len = ((size_t) worker->ring_req.tp_block_size) *
+	                   worker->ring_req.tp_block_nr;
+	worker->ring = mmap(NULL, worker->ring_len, PROT_READ | PROT_WRITE,
+	                    MAP_SHARED | MAP_LOCKED, worker->sock, 0);
+	if(worker->ring == MAP_FAILED)
+	{
+		SNIFFER_LOG(LOG_WARNING, "worker #%u: failed to map the capture "
+		            "ring: %s (%d)", worker->id, strerror(errno), errno);
+		goto close_sock;
+	}
+
+	memset(&addr, 0, sizeof(struct sockaddr_ll));
+	addr.sll_family = AF_PACKET;
+	addr.sll_protocol = htons(ETH_P_ALL);
+	addr.sll_ifindex = ifindex;
+	if(bind(worker->sock, (struct sockaddr *) &addr,
+	        sizeof(struct sockaddr_ll)) != 0)
+	{
+		SNIFFER_LOG(LOG_WARNING, "worker #%u: failed to bind to network "
+		            "device: %s (%d)", worker->id, strerror(errno), errno);
+		goto unmap_ring;
+	}
+
+	/* join the fanout group once bound */
+	if(setsockopt(worker->sock, SOL_PACKET, PACKET_FANOUT, &fanout,
+	              sizeof(fanout)) != 0)
+	{
+		SNIFFER_LOG(LOG_WARNING, "worker #%u: failed to join the fanout "
+		            "group: %s (%d)", worker->id, strerror(errno), errno);
+		goto unmap_ring;
+	}
+
+	return true;
+
+unmap_ring:
+	munmap(worker->ring, worker->ring_len);
+close_sock:
+	close(worker->sock);
+	worker->sock = -1;
+error:
+	return false;
+}
+
+
+/**
+ * @brief Close the capture ring of one worker and release its resources
+ *
+ * The background writer shall be stopped before.
+ *
+ * @param worker  The worker
+ */
+static void sniffer_worker_close(struct sniffer_worker_t *const worker)
+{
+	sniffer_recorder_free(worker->recorder);
+
+	rohc_decomp_free(worker->decomp);
+	rohc_comp_free(worker->comp);
+
+#if HAVE_LIBXDP == 1
+	if(worker->xsk != NULL)
+	{
+		xsk_socket__delete(worker->xsk);
+		xsk_umem__delete(worker->umem);
+		munmap(worker->umem_area,
+		       ((size_t) SNIFFER_XDP_FRAMES_NR) * XSK_UMEM__DEFAULT_FRAME_SIZE);
+	}
+	else
+#endif
+	{
+		munmap(worker->ring, worker->ring_len);
+		close(worker->sock);
+	}
+}
+
+
+/**
+ * @brief The main loop of one worker thread
+ *
+ * The worker walks the blocks of its ring in order: it tests the library
+ * with all the packets of one block once the kernel hands it over, then it
+ * gives the block back to the kernel.
+ *
+ * @param arg  The worker
+ * @return     Always NULL
+ */
+static void * sniffer_worker_run(void *arg)
+{
+	struct sniffer_worker_t *const worker = arg;
+	unsigned int block_index = 0;
+
+	while(!stop_program)
+	{
+		struct tpacket_block_desc *const block = (struct tpacket_block_desc *)
+			(worker->ring + ((size_t) block_index) * worker->ring_req.tp_block_size);
+		struct tpacket3_hdr *pkt_hdr;
+		uint32_t i;
+
+		/* wait for the kernel to hand over the block */
+		if((block->hdr.bh1.block_status & TP_STATUS_USER) == 0)
+		{
+			struct pollfd pfd =
+			{
+				.fd = worker->sock,
+				.events = POLLIN | POLLERR,
+				.revents = 0,
+			};
+			poll(&pfd, 1, SNIFFER_RING_POLL_TIMEOUT);
+			continue;
+		}
+		__sync_synchronize();
+
+		pkt_hdr = (struct tpacket3_hdr *)
+			(((uint8_t *) block) + block->hdr.bh1.offset_to_first_pkt);
+		for(i = 0; i < block->hdr.bh1.num_pkts && !stop_program; i++)
+		{
+			struct pcap_pkthdr header;
+			unsigned int cid = 0;
+			int ret;
+
+			header.ts.tv_sec = pkt_hdr->tp_sec;
+			header.ts.tv_usec = pkt_hdr->tp_nsec / 1000;
+			header.caplen = pkt_hdr->tp_snaplen;
+			header.len = pkt_hdr->tp_len;
+
+			worker->stats.total_packets++;
+
+			/* compress & decompress from compressor to decompressor */
+			ret = compress_decompress(worker->comp, worker->decomp, header,
+			                          ((uint8_t *) pkt_hdr) + pkt_hdr->tp_mac,
+			                          worker->link_len, worker->recorder,
+			                          &worker->feedback_send, &cid,
+			                          &worker->stats);
+
+			/* in case of problem (ignore bad packets), just die! */
+			if(!sniffer_check_result(ret, &worker->results, &worker->stats, cid))
+			{
+				SNIFFER_LOG(LOG_WARNING, "worker #%u failed", worker->id);
+
+				/* write the packets of the failing stream before dying */
+				sniffer_writer_flush(&sniffer_writer);
+
+				/* last debug traces are recorded in SIGABRT handler */
+				assert(0);
+			}
+
+			pkt_hdr = (struct tpacket3_hdr *)
+				(((uint8_t *) pkt_hdr) + pkt_hdr->tp_next_offset);
+		}
+
+		/* give the block back to the kernel */
+		__sync_synchronize();
+		block->hdr.bh1.block_status = TP_STATUS_KERNEL;
+		block_index = (block_index + 1) % worker->ring_req.tp_block_nr;
+	}
+
+	return NULL;
+}
+
+
+#if HAVE_LIBXDP == 1
+
+/**
+ * @brief Open the AF_XDP socket of one worker
+ *
+ * The socket is bound to the RX queue of the network device with the same
+ * index as the worker. Zero-copy mode is preferred, copy mode is used if the
+ * driver of the network device does not support it. libxdp loads the XDP
+ * program that redirects the packets of the queue to the socket.
+ *
+ * @param worker       The worker
+ * @param device_name  The name of the network device to capture on
+ * @return             true if the socket is ready, false otherwise
+ */
+static bool sniffer_worker_open_xdp(struct sniffer_worker_t *const worker,
+                                    const char *const device_name)
+{
+	const size_t umem_len =
+		((size_t) SNIFFER_XDP_FRAMES_NR) * XSK_UMEM__DEFAULT_FRAME_SIZE;
+	const struct xsk_umem_config umem_config =
+	{
+		/* all the frames fit in the fill ring, it never overflows */
+		.fill_size = SNIFFER_XDP_FRAMES_NR,
+		.comp_size = XSK_RING_CONS__DEFAULT_NUM_DESCS,
+		.frame_size = XSK_UMEM__DEFAULT_FRAME_SIZE,
+		.frame_headroom = XSK_UMEM__DEFAULT_FRAME_HEADROOM,
+		.flags = 0,
+	};
+	struct xsk_socket_config xsk_config;
+	uint32_t fill_idx;
+	uint32_t i;
+	int ret;
+
+	worker->link_len = ETHER_HDR_LEN;
+
+	worker->umem_area = mmap(NULL, umem_len, PROT_READ | PROT_WRITE,
+	                         MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
+	if(worker->umem_area == MAP_FAILED)
+	{
+		SNIFFER_LOG(LOG_WARNING, "worker #%u: failed to allocate the UMEM: "
+		            "%s (%d)", worker->id, strerror(errno), errno);
+		goto error;
+	}
+	ret = xsk_umem__create(&worker->umem, worker->umem_area, umem_len,
+	                       &worker->fill_ring, &worker->comp_ring, &umem_config);
+	if(ret != 0)
+	{
+		SNIFFER_LOG(LOG_WARNING, "worker #%u: failed to register the UMEM: "
+		            "%s (%d)", worker->id, strerror(-ret), -ret);
+		goto unmap_umem;
+	}
+
+	/* the sniffer only receives, no TX ring */
+	memset(&xsk_config, 0, sizeof(struct xsk_socket_config));
+	xsk_config.rx_size = XSK_RING_CONS__DEFAULT_NUM_DESCS;
+	xsk_config.tx_size = 0;
+	xsk_config.bind_flags = XDP_ZEROCOPY | XDP_USE_NEED_WAKEUP;
+	ret = xsk_socket__create(&worker->xsk, device_name, worker->id,
+	                         worker->umem, &worker->rx_ring, NULL, &xsk_config);
+	if(ret != 0)
+	{
+		SNIFFER_LOG(LOG_WARNING, "worker #%u: zero-copy AF_XDP not supported "
+		            "on queue %u: %s (%d), fallback to copy mode", worker->id,
+		            worker->id, strerror(-ret), -ret);
+		xsk_config.bind_flags = XDP_COPY | XDP_USE_NEED_WAKEUP;
+		ret = xsk_socket__create(&worker->xsk, device_name, worker->id,
+		                         worker->umem, &worker->rx_ring, NULL,
+		                         &xsk_config);
+		if(ret != 0)
+		{
+			SNIFFER_LOG(LOG_WARNING, "worker #%u: failed to create the AF_XDP "
+			            "socket on queue %u: %s (%d)", worker->id, worker->id,
+			            strerror(-ret), -ret);
+			worker->xsk = NULL;
+			goto delete_umem;
+		}
+	}
+
+	/* give all the frames to the kernel */
+	if(xsk_ring_prod__reserve(&worker->fill_ring, SNIFFER_XDP_FRAMES_NR,
+	                          &fill_idx) != SNIFFER_XDP_FRAMES_NR)
+	{
+		SNIFFER_LOG(LOG_WARNING, "worker #%u: failed to fill the UMEM fill "
+		            "ring", worker->id);
+		goto delete_xsk;
+	}
+	for(i = 0; i < SNIFFER_XDP_FRAMES_NR; i++)
+	{
+		*xsk_ring_prod__fill_addr(&worker->fill_ring, fill_idx + i) =
+			((uint64_t) i) * XSK_UMEM__DEFAULT_FRAME_SIZE;
+	}
+	xsk_ring_prod__submit(&worker->fill_ring, SNIFFER_XDP_FRAMES_NR);
+
+	return true;
+
+delete_xsk:
+	xsk_socket__delete(worker->xsk);
+	worker->xsk = NULL;
+delete_umem:
+	xsk_umem__delete(worker->umem);
+unmap_umem:
+	munmap(worker->umem_area, umem_len);
+error:
+	return false;
+}
+
+
+/**
+ * @brief The main loop of one worker thread that captures with AF_XDP
+ *
+ * The worker tests the library with the frames received in its UMEM: the
+ * ROHC buffers point to the frames, no packet is copied. The frames are
+ * given back to the kernel once tested.
+ *
+ * @param arg  The worker
+ * @return     Always NULL
+ */
+static void * sniffer_worker_run_xdp(void *arg)
+{
+	struct sniffer_worker_t *const worker = arg;
+
+	while(!stop_program)
+	{
+		struct timeval now;
+		uint32_t rx_idx;
+		uint32_t fill_idx;
+		uint32_t rcvd;
+		uint32_t i;
+
+		rcvd = xsk_ring_cons__peek(&worker->rx_ring, SNIFFER_XDP_BATCH_LEN,
+		                           &rx_idx);
+		if(rcvd == 0)
+		{
+			/* wait for frames, the poll also wakes up the driver if it ran
+			 * out of frames to fill */
+			struct pollfd pfd =
+			{
+				.fd = xsk_socket__fd(worker->xsk),
+				.events = POLLIN,
+				.revents = 0,
+			};
+			poll(&pfd, 1, SNIFFER_RING_POLL_TIMEOUT);
+			continue;
+		}
+
+		/* AF_XDP provides no timestamp, date the whole batch */
+		gettimeofday(&now, NULL);
+
+		for(i = 0; i < rcvd && !stop_program; i++)
+		{
+			const struct xdp_desc *const desc =
+				xsk_ring_cons__rx_desc(&worker->rx_ring, rx_idx + i);
+			struct pcap_pkthdr header;
+			unsigned int cid = 0;
+			int ret;
+
+			header.ts = now;
+			header.caplen = desc->len;
+			header.len = desc->len;
+
+			worker->stats.total_packets++;
+
+			/* compress & decompress the frame in place */
+			ret = compress_decompress(worker->comp, worker->decomp, header,
+			                          xsk_umem__get_data(worker->umem_area,
+			                                             desc->addr),
+			                          worker->link_len, worker->recorder,
+			                          &worker->feedback_send, &cid,
+			                          &worker->stats);
+
+			/* in case of problem (ignore bad packets), just die! */
+			if(!sniffer_check_result(ret, &worker->results, &worker->stats, cid))
+			{
+				SNIFFER_LOG(LOG_WARNING, "worker #%u failed", worker->id);
+
+				/* write the packets of the failing stream before dying */
+				sniffer_writer_flush(&sniffer_writer);
+
+				/* last debug traces are recorded in SIGABRT handler */
+				assert(0);
+			}
+		}
+
+		/* give the frames back to the kernel, the fill ring holds all the
+		 * frames of the UMEM so it always has room for them */
+		if(xsk_ring_prod__reserve(&worker->fill_ring, rcvd, &fill_idx) == rcvd)
+		{
+			for(i = 0; i < rcvd; i++)
+			{
+				const uint64_t addr =
+					xsk_ring_cons__rx_desc(&worker->rx_ring, rx_idx + i)->addr;
+				*xsk_ring_prod__fill_addr(&worker->fill_ring, fill_idx + i) =
+					addr & ~((uint64_t) XSK_UMEM__DEFAULT_FRAME_SIZE - 1);
+			}
+			xsk_ring_prod__submit(&worker->fill_ring, rcvd);
+		}
+		xsk_ring_cons__release(&worker->rx_ring, rcvd);
+	}
+
+	return NULL;
+}
+
+#endif /* HAVE_LIBXDP == 1 */
+
+
+/**
+ * @brief Get the unit of the compression statistics for the given volumes
+ *
+ * Bytes are counted in a larger unit once there are too many of them, as
+ * \ref compress_decompress does.
+ *
+ * @param pre_bytes   The number of bytes before compression
+ * @param post_bytes  The number of bytes after compression
+ * @return            The size of one unit
+ */
+static unsigned long sniffer_stats_unit(const unsigned long long pre_bytes,
+                                        const unsigned long long post_bytes)
+{
+	unsigned long unit = 1;
+
+	while(unit < (1000 * 1000 * 1000) &&
+	      (pre_bytes / unit) >= (100 * 1000) &&
+	      (post_bytes / unit) >= (100 * 1000))
+	{
+		unit *= 1000;
+	}
+
+	return unit;
+}
+
+
+/**
+ * @brief Merge the statistics of the workers
+ *
+ * The statistics of the workers are read while they run: the merged
+ * statistics are a snapshot that may lag behind by a few packets.
+ *
+ * @param[out] total    The merged statistics
+ * @param workers       The workers
+ * @param workers_nr    The number of workers
+ */
+static void sniffer_stats_merge(struct sniffer_stats_t *const total,
+                                const struct sniffer_worker_t *const workers,
+                                const unsigned int workers_nr)
+{
+	unsigned long long pre_bytes = 0;
+	unsigned long long post_bytes = 0;
+	unsigned int i;
+	size_t j;
+
+	memset(total, 0, sizeof(struct sniffer_stats_t));
+
+	for(i = 0; i < workers_nr; i++)
+	{
+		const struct sniffer_stats_t *const stats = &workers[i].stats;
+
+		pre_bytes += ((unsigned long long) stats->comp_pre_nr_units) *
+		             stats->comp_unit_size + stats->comp_pre_nr_bytes;
+		post_bytes += ((unsigned long long) stats->comp_post_nr_units) *
+		              stats->comp_unit_size + stats->comp_post_nr_bytes;
+		total->comp_pre_nr_hdr_bytes += stats->comp_pre_nr_hdr_bytes;
+		total->comp_post_nr_hdr_bytes += stats->comp_post_nr_hdr_bytes;
+
+		for(j = 0; j <= ROHC_PROFILE_UDPLITE; j++)
+		{
+			total->comp_nr_pkts_per_profile[j] += stats->comp_nr_pkts_per_profile[j];
+		}
+		for(j = 0; j <= ROHC_R_MODE; j++)
+		{
+			total->comp_nr_pkts_per_mode[j] += stats->comp_nr_pkts_per_mode[j];
+		}
+		for(j = 0; j <= ROHC_COMP_STATE_SO; j++)
+		{
+			total->comp_nr_pkts_per_state[j] += stats->comp_nr_pkts_per_state[j];
+		}
+		for(j = 0; j < ROHC_PACKET_MAX; j++)
+		{
+			total->comp_nr_pkts_per_pkt_type[j] += stats->comp_nr_pkts_per_pkt_type[j];
+		}
+		total->comp_nr_reused_cid += stats->comp_nr_reused_cid;
+
+		total->total_packets += stats->total_packets;
+		total->bad_packets += stats->bad_packets;
+
+		total->nr_lost_packets += stats->nr_lost_packets;
+		total->nr_loss_bursts += stats->nr_loss_bursts;
+		total->max_loss_burst_len = max(total->max_loss_burst_len,
+		                                stats->max_loss_burst_len);
+		if(stats->min_loss_burst_len != 0 &&
+		   (total->min_loss_burst_len == 0 ||
+		    stats->min_loss_burst_len < total->min_loss_burst_len))
+		{
+			total->min_loss_burst_len = stats->min_loss_burst_len;
+		}
+
+		total->nr_misordered_packets += stats->nr_misordered_packets;
+		total->nr_duplicated_packets += stats->nr_duplicated_packets;
+	}
+
+	/* count the volumes in the same unit for all the workers */
+	total->comp_unit_size = sniffer_stats_unit(pre_bytes, post_bytes);
+	if(total->comp_unit_size == 1)
+	{
+		total->comp_pre_nr_bytes = pre_bytes;
+		total->comp_post_nr_bytes = post_bytes;
+	}
+	else
+	{
+		total->comp_pre_nr_units = pre_bytes / total->comp_unit_size;
+		total->comp_pre_nr_bytes = pre_bytes % total->comp_unit_size;
+		total->comp_post_nr_units = post_bytes / total->comp_unit_size;
+		total->comp_post_nr_bytes = post_bytes % total->comp_unit_size;
+	}
+}
+
+
+/**
+ * @brief Create the recorder of the packets sniffed by one capture thread
+ *
+ * @param writer        The background writer of the PCAP dumps
+ * @param max_contexts  The maximum number of ROHC contexts
+ * @param link_type     The link layer type of the sniffed packets
+ * @param dump_prefix   The prefix of the names of the PCAP dump files
+ * @return              The new recorder, NULL in case of error
+ */
+static struct sniffer_recorder_t *
+	sniffer_recorder_new(struct sniffer_writer_t *const writer,
+	                     const size_t max_contexts,
+	                     const int link_type,
+	                     const char *const dump_prefix)
+{
+	struct sniffer_recorder_t *recorder;
+	size_t i;
+
+	if(sniffer_recorders_nr >= SNIFFER_WORKERS_MAX)
+	{
+		goto error;
+	}
+
+	recorder = calloc(1, sizeof(struct sniffer_recorder_t));
+	if(recorder == NULL)
+	{
+		goto error;
+	}
+	recorder->writer = writer;
+	recorder->max_contexts = max_contexts;
+	snprintf(recorder->dump_prefix, sizeof(recorder->dump_prefix), "%s",
+	         dump_prefix);
+	for(i = 0; i < SNIFFER_HISTORY_LEN; i++)
+	{
+		recorder->history[i].cid = SNIFFER_CID_NONE;
+	}
+
+	/* one more entry for the packets that cannot be compressed */
+	recorder->is_triggered = calloc(max_contexts + 1, sizeof(bool));
+	if(recorder->is_triggered == NULL)
+	{
+		goto free_recorder;
+	}
+	recorder->crc_failures = calloc(max_contexts, sizeof(unsigned long));
+	if(recorder->crc_failures == NULL)
+	{
+		goto free_triggered;
+	}
+	recorder->dumpers = calloc(max_contexts + 1, sizeof(pcap_dumper_t *));
+	if(recorder->dumpers == NULL)
+	{
+		goto free_crc_failures;
+	}
+	recorder->dump_handle = pcap_open_dead(link_type, DEV_MTU);
+	if(recorder->dump_handle == NULL)
+	{
+		goto free_dumpers;
+	}
+
+	/* record it for post-mortem analysis */
+	sniffer_recorders[sniffer_recorders_nr] = recorder;
+	sniffer_recorders_nr++;
+
+	return recorder;
+
+free_dumpers:
+	free(recorder->dumpers);
+free_crc_failures:
+	free(recorder->crc_failures);
+free_triggered:
+	free(recorder->is_triggered);
+free_recorder:
+	free(recorder);
+error:
+	SNIFFER_LOG(LOG_WARNING, "failed to create the packet recorder '%s'",
+	            dump_prefix);
+	return NULL;
+}
+
+
+/**
+ * @brief Destroy the recorder of the packets sniffed by one capture thread
+ *
+ * The background writer shall be stopped before.
+ *
+ * @param recorder  The recorder to destroy
+ */
+static void sniffer_recorder_free(struct sniffer_recorder_t *const recorder)
+{
+	size_t i;
+
+	for(i = 0; i < sniffer_recorders_nr; i++)
+	{
+		if(sniffer_recorders[i] == recorder)
+		{
+			sniffer_recorders_nr--;
+			sniffer_recorders[i] = sniffer_recorders[sniffer_recorders_nr];
+			break;
+		}
+	}
+
+	for(i = 0; i <= recorder->max_contexts; i++)
+	{
+		if(recorder->dumpers[i] != NULL)
+		{
+			SNIFFER_LOG(LOG_INFO, "close dump file '%s' for context with ID %zu",
+			            recorder->dump_prefix, i);
+			pcap_dump_close(recorder->dumpers[i]);
+		}
+	}
+	pcap_close(recorder->dump_handle);
+	free(recorder->dumpers);
+	free(recorder->crc_failures);
+	free(recorder->is_triggered);
+	for(i = 0; i < SNIFFER_HISTORY_LEN; i++)
+	{
+		free(recorder->history[i].data);
+	}
+	free(recorder);
+}
+
+
+/**
+ * @brief Record one sniffed packet of the given context
+ *
+ * The packet is kept in the history of the recent packets. It is also
+ * queued for writing if the context was triggered before.
+ *
+ * @param recorder  The recorder of the capture thread
+ * @param cid       The CID of the context that compressed the packet
+ * @param header    The PCAP header of the packet
+ * @param packet    The packet (link layer included)
+ * @param pkt_nr    The number of the packet
+ */
+static void sniffer_recorder_add(struct sniffer_recorder_t *const recorder,
+                                 const size_t cid,
+                                 const struct pcap_pkthdr header,
+                                 const unsigned char *const packet,
+                                 const unsigned long pkt_nr)
+{
+	struct sniffer_history_entry_t *const entry =
+		&recorder->history[recorder->history_next];
+
+	/* grow the buffer of the history entry if the packet does not fit */
+	if(entry->data_max < header.caplen)
+	{
+		uint8_t *const data = realloc(entry->data, header.caplen);
+		if(data == NULL)
+		{
+			entry->cid = SNIFFER_CID_NONE;
+			return;
+		}
+		entry->data = data;
+		entry->data_max = header.caplen;
+	}
+	memcpy(entry->data, packet, header.caplen);
+	entry->header = header;
+	entry->cid = cid;
+	recorder->history_next = (recorder->history_next + 1) % SNIFFER_HISTORY_LEN;
+
+	if(recorder->is_triggered[cid])
+	{
+		sniffer_writer_push(recorder->writer, recorder, cid, pkt_nr, header,
+		                    packet);
+	}
+}
+
+
+/**
+ * @brief Trigger the recording of the given context
+ *
+ * The recent packets of the context are queued for writing, and so will be
+ * the next ones until the context is re-used for another stream.
+ *
+ * @param recorder  The recorder of the capture thread
+ * @param cid       The CID of the context that triggered
+ * @param pkt_nr    The number of the packet that triggered
+ */
+static void sniffer_recorder_trigger(struct sniffer_recorder_t *const recorder,
+                                     const size_t cid,
+                                     const unsigned long pkt_nr)
+{
+	size_t i;
+
+	if(recorder->is_triggered[cid])
+	{
+		return;
+	}
+	recorder->is_triggered[cid] = true;
+	SNIFFER_LOG(LOG_INFO, "packet #%lu: record the packets of context with "
+	            "ID %zu in '%s' dump files", pkt_nr, cid, recorder->dump_prefix);
+
+	/* queue the recent packets of the context, oldest first */
+	for(i = 0; i < SNIFFER_HISTORY_LEN; i++)
+	{
+		const struct sniffer_history_entry_t *const entry =
+			&recorder->history[(recorder->history_next + i) % SNIFFER_HISTORY_LEN];
+
+		if(entry->cid == cid)
+		{
+			sniffer_writer_push(recorder->writer, recorder, cid, pkt_nr,
+			                    entry->header, entry->data);
+		}
+	}
+}
+
+
+/**
+ * @brief Forget the packets of the given context when it is re-used
+ *
+ * @param recorder  The recorder of the capture thread
+ * @param cid       The CID of the re-used context
+ */
+static void sniffer_recorder_reset(struct sniffer_recorder_t *const recorder,
+                                   const size_t cid)
+{
+	size_t i;
+
+	for(i = 0; i < SNIFFER_HISTORY_LEN; i++)
+	{
+		if(recorder->history[i].cid == cid)
+		{
+			recorder->history[i].cid = SNIFFER_CID_NONE;
+		}
+	}
+	recorder->crc_failures[cid] = 0;
+
+	/* the next stream goes to another dump file if it triggers too */
+	if(recorder->is_triggered[cid])
+	{
+		const struct pcap_pkthdr no_header = { .caplen = 0 };
+		recorder->is_triggered[cid] = false;
+		sniffer_writer_push(recorder->writer, recorder, cid, 0, no_header, NULL);
+	}
+}
+
+
+/**
+ * @brief Dump all the recent packets of one recorder after a crash
+ *
+ * Called from the handler of SIGSEGV/SIGABRT: the packets are written
+ * synchronously in one dump file.
+ *
+ * @param recorder  The recorder of the capture thread
+ */
+static void sniffer_recorder_dump_history(struct sniffer_recorder_t *const recorder)
+{
+	char dump_filename[1024];
+	pcap_dumper_t *dumper;
+	size_t i;
+
+	snprintf(dump_filename, 1024, "./%s_crash.pcap", recorder->dump_prefix);
+	dumper = pcap_dump_open(recorder->dump_handle, dump_filename);
+	if(dumper == NULL)
+	{
+		SNIFFER_LOG(LOG_WARNING, "failed to open dump file '%s'", dump_filename);
+		return;
+	}
+	for(i = 0; i < SNIFFER_HISTORY_LEN; i++)
+	{
+		const struct sniffer_history_entry_t *const entry =
+			&recorder->history[(recorder->history_next + i) % SNIFFER_HISTORY_LEN];
+
+		if(entry->cid != SNIFFER_CID_NONE)
+		{
+			pcap_dump((u_char *) dumper, &entry->header, entry->data);
+		}
+	}
+	pcap_dump_close(dumper);
+	SNIFFER_LOG(LOG_INFO, "last packets dumped in file '%s'", dump_filename);
+}
+
+
+/**
+ * @brief Start the background writer of the PCAP dumps
+ *
+ * @param writer  The writer to start
+ * @return        true if the writer thread runs, false otherwise
+ */
+static bool sniffer_writer_start(struct sniffer_writer_t *const writer)
+{
+	int ret;
+
+	memset(writer, 0, sizeof(struct sniffer_writer_t));
+	pthread_mutex_init(&writer->lock, NULL);
+	pthread_cond_init(&writer->cond, NULL);
+	pthread_cond_init(&writer->written_cond, NULL);
+
+	ret = pthread_create(&writer->thread, NULL, sniffer_writer_run, writer);
+	if(ret != 0)
+	{
+		SNIFFER_LOG(LOG_WARNING, "failed to start the PCAP writer: %s (%d)",
+		            strerror(ret), ret);
+		pthread_cond_destroy(&writer->written_cond);
+		pthread_cond_destroy(&writer->cond);
+		pthread_mutex_destroy(&writer->lock);
+		return false;
+	}
+
+	return true;
+}
+
+
+/**
+ * @brief Stop the background writer of the PCAP dumps
+ *
+ * The packets that are already queued are written before the writer stops.
+ *
+ * @param writer  The writer to stop
+ */
+static void sniffer_writer_stop(struct sniffer_writer_t *const writer)
+{
+	pthread_mutex_lock(&writer->lock);
+	writer->do_stop = true;
+	pthread_cond_signal(&writer->cond);
+	pthread_mutex_unlock(&writer->lock);
+	pthread_join(writer->thread, NULL);
+
+	if(writer->dropped_nr > 0)
+	{
+		SNIFFER_LOG(LOG_WARNING, "%lu packets were not dumped because the PCAP "
+		            "writer was overloaded", writer->dropped_nr);
+	}
+	pthread_cond_destroy(&writer->written_cond);
+	pthread_cond_destroy(&writer->cond);
+	pthread_mutex_destroy(&writer->lock);
+}
+
+
+/**
+ * @brief Queue one packet for the background writer
+ *
+ * The packet is copied. It is dropped if the queue is full, so that the
+ * capture threads never wait for the disk.
+ *
+ * @param writer    The writer
+ * @param recorder  The recorder the packet belongs to
+ * @param cid       The CID of the context of the packet
+ * @param pkt_nr    The number of the packet that triggered the recording
+ * @param header    The PCAP header of the packet
+ * @param packet    The packet (link layer included), NULL to close the dump
+ *                  file of the context
+ */
+static void sniffer_writer_push(struct sniffer_writer_t *const writer,
+                                struct sniffer_recorder_t *const recorder,
+                                const size_t cid,
+                                const unsigned long pkt_nr,
+                                const struct pcap_pkthdr header,
+                                const unsigned char *const packet)
+{
+	struct sniffer_dump_entry_t *entry;
+	uint8_t *data = NULL;
+
+	if(packet != NULL)
+	{
+		data = malloc(header.caplen);
+		if(data == NULL)
+		{
+			goto drop;
+		}
+		memcpy(data, packet, header.caplen);
+	}
+
+	pthread_mutex_lock(&writer->lock);
+	if(writer->queue_nr >= SNIFFER_WRITER_QUEUE_LEN)
+	{
+		pthread_mutex_unlock(&writer->lock);
+		free(data);
+		goto drop;
+	}
+	entry = &writer->queue[(writer->queue_first + writer->queue_nr) %
+	                       SNIFFER_WRITER_QUEUE_LEN];
+	entry->recorder = recorder;
+	entry->cid = cid;
+	entry->pkt_nr = pkt_nr;
+	entry->header = header;
+	entry->data = data;
+	writer->queue_nr++;
+	writer->pushed_nr++;
+	pthread_cond_signal(&writer->cond);
+	pthread_mutex_unlock(&writer->lock);
+	return;
+
+drop:
+	pthread_mutex_lock(&writer->lock);
+	writer->dropped_nr++;
+	pthread_mutex_unlock(&writer->lock);
+}
+
+
+/**
+ * @brief Wait for the background writer to write all the queued packets
+ *
+ * @param writer  The writer
+ */
+static void sniffer_writer_flush(struct sniffer_writer_t *const writer)
+{
+	unsigned long target_nr;
+
+	pthread_mutex_lock(&writer->lock);
+	target_nr = writer->pushed_nr;
+	while(writer->written_nr < target_nr)
+	{
+		pthread_cond_wait(&writer->written_cond, &writer->lock);
+	}
+	pthread_mutex_unlock(&writer->lock);
+}
+
+
+/**
+ * @brief The main loop of the background writer of the PCAP dumps
+ *
+ * The writer takes all the queued packets at once, then writes them without
+ * holding the lock, and flushes the dump files once per batch.
+ *
+ * @param arg  The writer
+ * @return     Always NULL
+ */
+static void * sniffer_writer_run(void *arg)
+{
+	struct sniffer_writer_t *const writer = arg;
+
+	pthread_mutex_lock(&writer->lock);
+	while(!writer->do_stop || writer->queue_nr > 0)
+	{
+		size_t batch_nr;
+		size_t i;
+
+		if(writer->queue_nr == 0)
+		{
+			pthread_cond_wait(&writer->cond, &writer->lock);
+			continue;
+		}
+
+		/* take the whole queue as one batch */
+		batch_nr = writer->queue_nr;
+		for(i = 0; i < batch_nr; i++)
+		{
+			writer->batch[i] =
+				writer->queue[(writer->queue_first + i) % SNIFFER_WRITER_QUEUE_LEN];
+		}
+		writer->queue_first = (writer->queue_first + batch_nr) % SNIFFER_WRITER_QUEUE_LEN;
+		writer->queue_nr = 0;
+		pthread_mutex_unlock(&writer->lock);
+
+		sniffer_writer_write_batch(writer->batch, batch_nr);
+
+		pthread_mutex_lock(&writer->lock);
+		writer->written_nr += batch_nr;
+		pthread_cond_broadcast(&writer->written_cond);
+	}
+	pthread_mutex_unlock(&writer->lock);
+
+	return NULL;
+}
+
+
+/**
+ * @brief Write one batch of packets in the PCAP dumps
+ *
+ * The dumpers of the recorders are used by the writer thread only.
+ *
+ * @param batch     The packets to write
+ * @param batch_nr  The number of packets to write
+ */
+static void sniffer_writer_write_batch(struct sniffer_dump_entry_t *const batch,
+                                       const size_t batch_nr)
+{
+	size_t i;
+
+	for(i = 0; i < batch_nr; i++)
+	{
+		struct sniffer_dump_entry_t *const entry = &batch[i];
+		pcap_dumper_t **const dumper = &entry->recorder->dumpers[entry->cid];
+
+		/* close the dump file of a context re-used for another stream */
+		if(entry->data == NULL)
+		{
+			if((*dumper) != NULL)
+			{
+				pcap_dump_close(*dumper);
+				*dumper = NULL;
+			}
+			continue;
+		}
+
+		/* open the dump file at the first packet of a triggered stream */
+		if((*dumper) == NULL)
+		{
+			char dump_filename[1024];
+
+			if(entry->cid == entry->recorder->max_contexts)
+			{
+				snprintf(dump_filename, 1024, "./%s_default.pcap",
+				         entry->recorder->dump_prefix);
+			}
+			else
+			{
+				snprintf(dump_filename, 1024, "./%s_cid_%zu_pkt_%lu.pcap",
+				         entry->recorder->dump_prefix, entry->cid, entry->pkt_nr);
+			}
+			*dumper = pcap_dump_open(entry->recorder->dump_handle, dump_filename);
+			if((*dumper) == NULL)
+			{
+				SNIFFER_LOG(LOG_WARNING, "failed to open new dump file '%s'",
+				            dump_filename);
+			}
+			else if(is_verbose)
+			{
+				SNIFFER_LOG(LOG_INFO, "dump packets in file '%s'", dump_filename);
+			}
+		}
+		if((*dumper) != NULL)
+		{
+			pcap_dump((u_char *) (*dumper), &entry->header, entry->data);
+		}
+		free(entry->data);
+	}
+
+	/* write the batch to disk */
+	for(i = 0; i < batch_nr; i++)
+	{
+		pcap_dumper_t *const dumper = batch[i].recorder->dumpers[batch[i].cid];
+
+		if(dumper != NULL && (i == 0 || batch[i - 1].recorder != batch[i].recorder ||
+		                      batch[i - 1].cid != batch[i].cid))
+		{
+			pcap_dump_flush(dumper);
+		}
+	}
+}
+
+
+/**
+ * @brief Compress and decompress one uncompressed IP packet with the given
+ *        compressor and decompressor
+ *
+ * @param comp           The compressor to use to compress the IP packet
+ * @param decomp         The decompressor to use to decompress the IP packet
+ * @param header         The PCAP header for the packet
+ * @param packet         The packet to compress/decompress (link layer included)
+ * @param link_len_src   The length of the link layer header before IP data
+ * @param recorder       The recorder of the packets of the capture thread
+ * @param feedback_send  IN/OUT: The feedback to piggyback
+ * @param cid            OUT: the CID used for the last packet
+ * @param stats          IN/OUT: The sniffer stats
+ * @return               1 if the process is successful
+ *                       0 if the decompressed packet doesn't match the
+ *                         original one
+ *                       -1 if an error occurs while compressing
+ *                       -2 if an error occurs while decompressing
+ *                       -3 if the link layer is not Ethernet
+ *                       -4 if (de)compression info cannot be retrieved
+ */
+static int compress_decompress(struct rohc_comp *comp,
+                               struct rohc_decomp *decomp,
+                               struct pcap_pkthdr header,
+                               unsigned char *packet,
+                               size_t link_len_src,
+                               struct sniffer_recorder_t *const recorder,
+                               struct rohc_buf *const feedback_send,
+                               unsigned int *const cid,
+                               struct sniffer_stats_t *stats)
+{
+	const struct rohc_ts arrival_time = { .sec = 0, .nsec = 0 };
+	struct rohc_buf ip_packet =
+		rohc_buf_init_full(packet, header.caplen, arrival_time);
+
+	const size_t output_packet_max_len =
+		max(ETHER_HDR_LEN, LINUX_COOKED_HDR_LEN) + MAX_ROHC_SIZE;
+	uint8_t output_packet[output_packet_max_len];
+	struct rohc_buf rohc_packet =
+		rohc_buf_init_empty(output_packet, output_packet_max_len);
+
+	uint8_t decomp_buffer[MAX_ROHC_SIZE];
+	struct rohc_buf decomp_packet =
+		rohc_buf_init_empty(decomp_buffer, MAX_ROHC_SIZE);
+
+	uint8_t rcvd_feedback_buffer[MAX_ROHC_SIZE];
+	struct rohc_buf rcvd_feedback =
+		rohc_buf_init_empty(rcvd_feedback_buffer, MAX_ROHC_SIZE);
+
+	rohc_comp_last_packet_info2_t comp_last_packet_info;
+	rohc_decomp_last_packet_info_t decomp_last_packet_info;
+	unsigned long possible_unit;
+	rohc_status_t status;
+	int ret;
+
+	/* check Ethernet frame length */
+	if(header.len <= link_len_src || header.len != header.caplen)
+	{
+		SNIFFER_LOG(LOG_WARNING, "bad PCAP packet (full len = %u, capture "
+		            "len = %u)", header.len, header.caplen);
+		ret = -3;
+		goto error;
+	}
+
+	/* skip the link layer header */
+	rohc_buf_pull(&ip_packet, link_len_src);
+	rohc_packet.len += link_len_src;
+	rohc_buf_pull(&rohc_packet, link_len_src);
+
+	/* check for padding after the IP packet in the Ethernet payload */
+	if(link_len_src == ETHER_HDR_LEN && header.len == ETHER_FRAME_MIN_LEN)
+	{
+		int version;
+		uint16_t tot_len;
+
+		version = (rohc_buf_byte(ip_packet) >> 4) & 0x0f;
+		if(version == 4)
+		{
+			memcpy(&tot_len, rohc_buf_data_at(ip_packet, 2), sizeof(uint16_t));
+			tot_len = ntohs(tot_len);
+		}
+		else
 		{
 			const size_t ipv6_header_len = 40;
 			memcpy(&tot_len, rohc_buf_data_at(ip_packet, 4), sizeof(uint16_t));
@@ -1265,29 +2960,14 @@ static int compress_decompress(struct rohc_comp *comp,
 	status = rohc_compress4(comp, ip_packet, &rohc_packet);
 	if(status != ROHC_STATUS_OK)
 	{
-		pcap_dumper_t *dumper;
-
 		SNIFFER_LOG(LOG_WARNING, "compression failed");
 		ret = -1;
-		rohc_buf_push(&ip_packet, link_len_src);
-
-		/* open the new dumper */
-		dumper = pcap_dump_open(handle, "./dump_stream_default.pcap");
-		if(dumper == NULL)
-		{
-			SNIFFER_LOG(LOG_WARNING, "failed to open new dump file '%s'",
-			            "./dump_stream_default.pcap");
-			assert(0);
-			goto error;
-		}
 
-		/* dump the IP packet */
-		SNIFFER_LOG(LOG_INFO, "dump packet in file '%s'",
-		            "./dump_stream_default.pcap");
-		pcap_dump((u_char *) dumper, &header, packet);
-
-		SNIFFER_LOG(LOG_INFO, "close dump file");
-		pcap_dump_close(dumper);
+		/* record the IP packet in the default dump file */
+		sniffer_recorder_trigger(recorder, recorder->max_contexts,
+		                         stats->total_packets);
+		sniffer_recorder_add(recorder, recorder->max_contexts, header, packet,
+		                     stats->total_packets);
 
 		goto error;
 	}
@@ -1366,47 +3046,15 @@ static int compress_decompress(struct rohc_comp *comp,
 		stats->comp_nr_reused_cid++;
 	}
 
-	/* open a new dumper if none exists or the stream changed */
+	/* forget the previous stream of the context if it was re-used */
 	if(comp_last_packet_info.is_context_init)
 	{
-		char dump_filename[1024];
-
-		snprintf(dump_filename, 1024, "./dump_stream_cid_%u.pcap",
-		         comp_last_packet_info.context_id);
-		/* TODO: check result */
-
-		/* close the previous dumper and remove its file if one was opened */
-		if(dumpers[comp_last_packet_info.context_id] != NULL)
-		{
-			if(is_verbose)
-			{
-				SNIFFER_LOG(LOG_INFO, "replace dump file '%s' for context with "
-				            "ID %u", dump_filename,
-				            comp_last_packet_info.context_id);
-			}
-			pcap_dump_close(dumpers[comp_last_packet_info.context_id]);
-			unlink(dump_filename);
-			/* TODO: check result */
-		}
-
-		/* open the new dumper */
-		dumpers[comp_last_packet_info.context_id] =
-			pcap_dump_open(handle, dump_filename);
-		if(dumpers[comp_last_packet_info.context_id] == NULL)
-		{
-			SNIFFER_LOG(LOG_WARNING, "failed to open new dump file '%s' for "
-			            "context with ID %u", dump_filename,
-			            comp_last_packet_info.context_id);
-			assert(0);
-			goto error;
-		}
+		sniffer_recorder_reset(recorder, comp_last_packet_info.context_id);
 	}
 
-	/* dump the IP packet */
-	rohc_buf_push(&ip_packet, link_len_src);
-	pcap_dump((u_char *) dumpers[comp_last_packet_info.context_id],
-	          &header, packet);
-	rohc_buf_pull(&ip_packet, link_len_src);
+	/* record the IP packet */
+	sniffer_recorder_add(recorder, comp_last_packet_info.context_id, header,
+	                     packet, stats->total_packets);
 
 	/* record the CID */
 	*cid = comp_last_packet_info.context_id;
@@ -1421,6 +3069,7 @@ static int compress_decompress(struct rohc_comp *comp,
 	if(status != ROHC_STATUS_OK)
 	{
 		SNIFFER_LOG(LOG_WARNING, "decompression failed");
+		sniffer_recorder_trigger(recorder, *cid, stats->total_packets);
 		ret = -2;
 		goto error;
 	}
@@ -1454,6 +3103,16 @@ static int compress_decompress(struct rohc_comp *comp,
 		stats->nr_duplicated_packets++;
 	}
 
+	/* record the stream if the decompressor had to repair a CRC failure */
+	if(decomp_last_packet_info.corrected_crc_failures >
+	   recorder->crc_failures[*cid])
+	{
+		SNIFFER_LOG(LOG_INFO, "packet #%lu: CRC failure corrected for context "
+		            "with ID %u", stats->total_packets, *cid);
+		sniffer_recorder_trigger(recorder, *cid, stats->total_packets);
+	}
+	recorder->crc_failures[*cid] = decomp_last_packet_info.corrected_crc_failures;
+
 	/* deliver any received feedback data to the associated compressor */
 	if(!rohc_comp_deliver_feedback2(comp, rcvd_feedback))
 	{
@@ -1466,6 +3125,7 @@ static int compress_decompress(struct rohc_comp *comp,
 	if(!compare_packets(ip_packet, decomp_packet))
 	{
 		SNIFFER_LOG(LOG_WARNING, "comparison with original packet failed");
+		sniffer_recorder_trigger(recorder, *cid, stats->total_packets);
 		ret = 0;
 	}
 	else
@@ -1730,6 +3390,7 @@ static void print_rohc_traces(void *const priv_ctxt __attribute__((unused)),
 		}
 	}
 
+	pthread_mutex_lock(&last_traces_lock);
 	if(last_traces_last == -1)
 	{
 		last_traces_last = 0;
@@ -1760,6 +3421,7 @@ static void print_rohc_traces(void *const priv_ctxt __attribute__((unused)),
 	{
 		last_traces_first = (last_traces_first + 1) % MAX_LAST_TRACES;
 	}
+	pthread_mutex_unlock(&last_traces_lock);
 }
 
 
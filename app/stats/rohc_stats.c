@@ -24,6 +24,19 @@
  *
  * The program takes a flow of IP packets as input (in the PCAP format) and
  * generate some ROHC compression statistics with them.
+ *
+ * By default, one line of statistics is printed for every packet, the
+ * rohc_stats.sh script aggregates them. With the --summary option, the
+ * statistics are aggregated by the program itself in constant memory: the
+ * compression ratio is printed at the end of every window of packets, and
+ * the per-profile, per-packet-type, per-state and per-CID summaries at the
+ * end of the capture. With the --mmap option, the capture is read through a memory
+ * mapping instead of libpcap.
+ *
+ * The --wlsb-width, --list-trans-nr and --seed options make it possible to
+ * study how the compression efficiency depends on the parameters of the
+ * compressor, and to compare the reports of different builds of the library
+ * on the same captures.
  */
 
 #include "config.h" /* for HAVE_*_H */
@@ -41,6 +54,13 @@
 #include <assert.h>
 #include <time.h> /* for time(2) */
 #include <stdarg.h>
+#include <errno.h>
+#if HAVE_SYS_MMAN_H == 1
+#  include <sys/mman.h> /* for mmap(2) */
+#  include <sys/stat.h>
+#  include <fcntl.h>
+#  include <unistd.h>
+#endif
 
 /* includes for network headers */
 #include <protocols/ipv4.h>
@@ -74,6 +94,69 @@ for ./configure ? If yes, check configure output and config.log"
 /** The minimum Ethernet length (in bytes) */
 #define ETHER_FRAME_MIN_LEN  60U
 
+/** The default number of packets in one window of the summary */
+#define STATS_WINDOW_LEN_DEFAULT  10000U
+
+/** The length of the PCAP file header */
+#define PCAP_FILE_HDR_LEN  24U
+
+/** The length of the PCAP record header */
+#define PCAP_RECORD_HDR_LEN  16U
+
+/** The PCAP link type for raw IP packets (may differ from DLT_RAW) */
+#define PCAP_LINKTYPE_RAW  101U
+
+/** The amount of the mapped capture released at once once read */
+#define PCAP_MMAP_RELEASE_LEN  (8U * 1024U * 1024U)
+
+/** The number of compression states, the unknown state included */
+#define STATS_COMP_STATES_NR  (ROHC_COMP_STATE_SO + 1)
+
+
+/** The cumulative compression statistics for a set of packets */
+struct stats_counters
+{
+	unsigned long packets_nr;            /**< The number of packets */
+	unsigned long long uncomp_bytes;     /**< The uncompressed bytes */
+	unsigned long long uncomp_hdr_bytes; /**< The uncompressed header bytes */
+	unsigned long long comp_bytes;       /**< The compressed bytes */
+	unsigned long long comp_hdr_bytes;   /**< The compressed header bytes */
+};
+
+
+/** The statistics aggregated by the program with the --summary option */
+struct stats_summary
+{
+	struct stats_counters total;         /**< All the packets */
+	struct stats_counters window;        /**< The packets of current window */
+	unsigned long window_len;            /**< The packets in one window */
+	unsigned long window_first;          /**< The first packet of the window */
+	/** The packets per profile */
+	struct stats_counters per_profile[ROHC_PROFILE_MAX];
+	/** The packets per packet type */
+	struct stats_counters per_pkt_type[ROHC_PACKET_MAX];
+	/** The packets per compression state */
+	struct stats_counters per_state[STATS_COMP_STATES_NR];
+	/** The packets per CID, one per context */
+	struct stats_counters *per_cid;
+	/** The number of streams compressed with every CID */
+	unsigned long *per_cid_streams_nr;
+	unsigned int max_contexts;           /**< The number of contexts */
+};
+
+
+/** A PCAP capture read through a memory mapping */
+struct pcap_mmap
+{
+	const uint8_t *data;   /**< The mapped capture */
+	size_t len;            /**< The length of the mapped capture */
+	size_t offset;         /**< The offset of the next record */
+	size_t released;       /**< The length of the capture already released */
+	bool is_swapped;       /**< Whether the capture is in the other byte order */
+	bool is_nsec;          /**< Whether timestamps are in nanoseconds */
+	int link_type;         /**< The link layer type of the capture */
+};
+
 
 /** Whether to run the tool in verbose mode or not */
 static bool is_verbose = false;
@@ -83,12 +166,53 @@ static bool is_verbose = false;
 static void usage(void);
 static int generate_comp_stats_all(const rohc_cid_type_t cid_type,
                                    const unsigned int max_contexts,
-                                   const char *filename);
+                                   const unsigned int wlsb_width,
+                                   const unsigned int list_trans_nr,
+                                   const unsigned int seed,
+                                   const char *filename,
+                                   const bool do_summary,
+                                   const unsigned long window_len,
+                                   const bool use_mmap);
 static int generate_comp_stats_one(struct rohc_comp *comp,
                                    const unsigned long num_packet,
                                    const struct pcap_pkthdr header,
                                    const unsigned char *packet,
-                                   const int link_len);
+                                   const int link_len,
+                                   struct stats_summary *const summary);
+
+static void stats_counters_add(struct stats_counters *const counters,
+                               const rohc_comp_last_packet_info2_t *const info)
+	__attribute__((nonnull(1, 2)));
+static void stats_summary_add(struct stats_summary *const summary,
+                              const unsigned long num_packet,
+                              const rohc_comp_last_packet_info2_t *const info)
+	__attribute__((nonnull(1, 3)));
+static void stats_summary_print_window(struct stats_summary *const summary,
+                                       const unsigned long last_packet)
+	__attribute__((nonnull(1)));
+static void stats_summary_print(const struct stats_summary *const summary)
+	__attribute__((nonnull(1)));
+static void stats_counters_print(const char *const keyword,
+                                 const unsigned int id,
+                                 const char *const descr,
+                                 const struct stats_counters *const counters,
+                                 const struct stats_counters *const total)
+	__attribute__((nonnull(1, 3, 4, 5)));
+
+static bool pcap_mmap_open(struct pcap_mmap *const capture,
+                           const char *const filename)
+	__attribute__((warn_unused_result, nonnull(1, 2)));
+static int pcap_mmap_next(struct pcap_mmap *const capture,
+                          struct pcap_pkthdr *const header,
+                          const unsigned char **const packet)
+	__attribute__((warn_unused_result, nonnull(1, 2, 3)));
+static void pcap_mmap_close(struct pcap_mmap *const capture)
+	__attribute__((nonnull(1)));
+#if HAVE_SYS_MMAN_H == 1
+static uint32_t pcap_mmap_get32(const struct pcap_mmap *const capture,
+                                const size_t offset)
+	__attribute__((warn_unused_result, nonnull(1)));
+#endif
 static void print_rohc_traces(void *const priv_ctxt,
                               const rohc_trace_level_t level,
                               const rohc_trace_entity_t entity,
@@ -125,6 +249,12 @@ int main(int argc, char *argv[])
 	int max_contexts = ROHC_SMALL_CID_MAX + 1;
 	size_t max_possible_contexts = ROHC_SMALL_CID_MAX + 1;
 	rohc_cid_type_t cid_type = ROHC_SMALL_CID;
+	bool do_summary = false;
+	int window_len = STATS_WINDOW_LEN_DEFAULT;
+	bool use_mmap = false;
+	int wlsb_width = 0; /* the default width of the library */
+	int list_trans_nr = 0; /* the default number of the library */
+	unsigned int seed = time(NULL);
 	int args_used;
 
 	/* parse program arguments, print the help message in case of failure */
@@ -161,6 +291,83 @@ int main(int argc, char *argv[])
 			max_contexts = atoi(argv[1]);
 			args_used++;
 		}
+		else if(!strcmp(*argv, "--wlsb-width"))
+		{
+			/* get the width of the WLSB window the test should use */
+			if(argc <= 1)
+			{
+				fprintf(stderr, "option --wlsb-width takes one argument\n\n");
+				usage();
+				goto error;
+			}
+			wlsb_width = atoi(argv[1]);
+			if(wlsb_width <= 0)
+			{
+				fprintf(stderr, "the width of the WLSB window should be "
+				        "positive\n\n");
+				usage();
+				goto error;
+			}
+			args_used++;
+		}
+		else if(!strcmp(*argv, "--list-trans-nr"))
+		{
+			/* get the number of transmissions of the compressed lists */
+			if(argc <= 1)
+			{
+				fprintf(stderr, "option --list-trans-nr takes one argument\n\n");
+				usage();
+				goto error;
+			}
+			list_trans_nr = atoi(argv[1]);
+			if(list_trans_nr <= 0)
+			{
+				fprintf(stderr, "the number of transmissions of the lists "
+				        "should be positive\n\n");
+				usage();
+				goto error;
+			}
+			args_used++;
+		}
+		else if(!strcmp(*argv, "--seed"))
+		{
+			/* get the seed of the random numbers */
+			if(argc <= 1)
+			{
+				fprintf(stderr, "option --seed takes one argument\n\n");
+				usage();
+				goto error;
+			}
+			seed = strtoul(argv[1], NULL, 10);
+			args_used++;
+		}
+		else if(!strcmp(*argv, "--summary"))
+		{
+			/* aggregate the statistics instead of printing them per packet */
+			do_summary = true;
+		}
+		else if(!strcmp(*argv, "--window"))
+		{
+			/* get the number of packets in one window of the summary */
+			if(argc <= 1)
+			{
+				fprintf(stderr, "option --window takes one argument\n\n");
+				usage();
+				goto error;
+			}
+			window_len = atoi(argv[1]);
+			args_used++;
+		}
+		else if(!strcmp(*argv, "--mmap"))
+		{
+			/* read the capture through a memory mapping */
+#if HAVE_SYS_MMAN_H == 1
+			use_mmap = true;
+#else
+			fprintf(stderr, "option --mmap is not supported on this platform\n");
+			goto error;
+#endif
+		}
 		else if(cid_type_name == NULL)
 		{
 			/* get the type of CID to use within the ROHC library */
@@ -214,6 +421,15 @@ int main(int argc, char *argv[])
 		goto error;
 	}
 
+	/* the windows of the summary shall contain at least one packet */
+	if(window_len < 1)
+	{
+		fprintf(stderr, "the number of packets in one window should be "
+		        "positive\n\n");
+		usage();
+		goto error;
+	}
+
 	/* the source filename is mandatory */
 	if(source_filename == NULL)
 	{
@@ -223,7 +439,9 @@ int main(int argc, char *argv[])
 	}
 
 	/* generate ROHC compression statistics with the packets from the file */
-	status = generate_comp_stats_all(cid_type, max_contexts, source_filename);
+	status = generate_comp_stats_all(cid_type, max_contexts, wlsb_width,
+	                                 list_trans_nr, seed, source_filename,
+	                                 do_summary, window_len, use_mmap);
 
 error:
 	return status;
@@ -255,6 +473,22 @@ static void usage(void)
 	       "The shell script rohc_stats.sh could be used to generate a HTML\n"
 	       "report.\n"
 	       "\n"
+	       "With the --summary option, the statistics are aggregated by the\n"
+	       "tool in constant memory. The following lines are printed with\n"
+	       "tab-separated fields, the first line of every kind names them:\n\n"
+	       "  * 'WINDOW' lines with the compression ratio for every window\n"
+	       "    of packets, while the capture is processed\n\n"
+	       "  * 'PROFILE', 'PACKET_TYPE', 'STATE' and 'CID' lines with the\n"
+	       "    packets, bytes and compression ratios per profile, per packet\n"
+	       "    type, per compression state and per CID, once the capture is\n"
+	       "    processed\n\n"
+	       "  * one 'TOTAL' line with the packets, bytes and compression\n"
+	       "    ratios for the whole capture\n\n"
+	       "The 'PROFILE', 'PACKET_TYPE', 'STATE', 'CID' and 'TOTAL' lines\n"
+	       "end with the header bytes saved by compression, the average\n"
+	       "compressed header size and the share of the packets of the\n"
+	       "capture.\n"
+	       "\n"
 	       "Usage: rohc_stats [OPTIONS] CID_TYPE FLOW\n"
 	       "\n"
 	       "Options:\n"
@@ -263,6 +497,19 @@ static void usage(void)
 	       "      --verbose           Be more verbose\n"
 	       "      --max-contexts NUM  The maximum number of ROHC contexts to\n"
 	       "                          simultaneously use during the test\n"
+	       "      --wlsb-width NUM    The width of the WLSB window to use\n"
+	       "      --list-trans-nr NUM The number of transmissions of the\n"
+	       "                          compressed lists before they are\n"
+	       "                          considered as known\n"
+	       "      --seed NUM          The seed of the random numbers, to\n"
+	       "                          compare reports of the same capture\n"
+	       "                          (default: the current time)\n"
+	       "      --summary           Aggregate the statistics instead of\n"
+	       "                          printing them for every packet\n"
+	       "      --window NUM        The number of packets in one window of\n"
+	       "                          the summary (default: %u)\n"
+	       "      --mmap              Read the capture through a memory\n"
+	       "                          mapping instead of libpcap\n"
 	       "\n"
 	       "With:\n"
 	       "  CID_TYPE                The type of CID to use among 'smallcid'\n"
@@ -273,8 +520,14 @@ static void usage(void)
 	       "Examples:\n"
 	       "  rohc_stats smallcid /tmp/rtp.pcap   Generate statistics\n"
 	       "  rohc_stats largecid ~/lan.pcap      Generate statistics\n"
+	       "  rohc_stats --summary --mmap largecid ~/day.pcap\n"
+	       "                                      Summarize a large capture\n"
+	       "  rohc_stats --summary --seed 1 --wlsb-width 64 smallcid a.pcap\n"
+	       "                                      Summarize the efficiency\n"
+	       "                                      with a wider window\n"
 	       "\n"
-	       "Report bugs to <" PACKAGE_BUGREPORT ">.\n");
+	       "Report bugs to <" PACKAGE_BUGREPORT ">.\n",
+	       STATS_WINDOW_LEN_DEFAULT);
 }
 
 
@@ -283,37 +536,66 @@ static void usage(void)
  *
  * @param cid_type       The type of CIDs the compressor shall use
  * @param max_contexts   The maximum number of ROHC contexts to use
+ * @param wlsb_width     The width of the WLSB window to use,
+ *                       0 for the default width of the library
+ * @param list_trans_nr  The number of transmissions of the compressed lists,
+ *                       0 for the default number of the library
+ * @param seed           The seed of the random numbers
  * @param filename       The name of the PCAP file that contains the IP packets
+ * @param do_summary     Whether to aggregate the statistics or print them
+ *                       for every packet
+ * @param window_len     The number of packets in one window of the summary
+ * @param use_mmap       Whether to read the PCAP file through a memory
+ *                       mapping instead of libpcap
  * @return               0 in case of success,
  *                       1 in case of failure
  */
 static int generate_comp_stats_all(const rohc_cid_type_t cid_type,
                                    const unsigned int max_contexts,
-                                   const char *filename)
+                                   const unsigned int wlsb_width,
+                                   const unsigned int list_trans_nr,
+                                   const unsigned int seed,
+                                   const char *filename,
+                                   const bool do_summary,
+                                   const unsigned long window_len,
+                                   const bool use_mmap)
 {
 	char errbuf[PCAP_ERRBUF_SIZE];
-	pcap_t *handle;
+	pcap_t *handle = NULL;
+	struct pcap_mmap capture;
 	int link_layer_type;
 	int link_len;
 
 	struct rohc_comp *comp;
+	struct stats_summary summary;
 
 	unsigned long num_packet;
 	struct pcap_pkthdr header;
-	unsigned char *packet;
+	const unsigned char *packet;
 
 	int is_failure = 1;
 
 	/* open the source PCAP file */
-	handle = pcap_open_offline(filename, errbuf);
-	if(handle == NULL)
+	if(use_mmap)
 	{
-		fprintf(stderr, "failed to open the source pcap file: %s\n", errbuf);
-		goto error;
+		if(!pcap_mmap_open(&capture, filename))
+		{
+			goto error;
+		}
+		link_layer_type = capture.link_type;
+	}
+	else
+	{
+		handle = pcap_open_offline(filename, errbuf);
+		if(handle == NULL)
+		{
+			fprintf(stderr, "failed to open the source pcap file: %s\n", errbuf);
+			goto error;
+		}
+		link_layer_type = pcap_datalink(handle);
 	}
 
 	/* link layer in the source PCAP file must be Ethernet */
-	link_layer_type = pcap_datalink(handle);
 	if(link_layer_type != DLT_EN10MB &&
 	   link_layer_type != DLT_LINUX_SLL &&
 	   link_layer_type != DLT_RAW)
@@ -339,7 +621,7 @@ static int generate_comp_stats_all(const rohc_cid_type_t cid_type,
 	}
 
 	/* initialize the random generator */
-	srand(time(NULL));
+	srand(seed);
 
 	/* create the ROHC compressor */
 	comp = rohc_comp_new2(cid_type, max_contexts - 1, gen_random_num, NULL);
@@ -367,52 +649,148 @@ static int generate_comp_stats_all(const rohc_cid_type_t cid_type,
 		goto destroy_comp;
 	}
 
+	/* set the WLSB window width */
+	if(wlsb_width > 0 && !rohc_comp_set_wlsb_window_width(comp, wlsb_width))
+	{
+		fprintf(stderr, "failed to set the WLSB window width\n");
+		goto destroy_comp;
+	}
+
+	/* set the number of transmissions of the compressed lists */
+	if(list_trans_nr > 0 && !rohc_comp_set_list_trans_nr(comp, list_trans_nr))
+	{
+		fprintf(stderr, "failed to set the number of transmissions of the "
+		        "compressed lists\n");
+		goto destroy_comp;
+	}
+
 	/* set UDP ports dedicated to RTP traffic */
 	if(!rohc_comp_set_rtp_detection_cb(comp, rohc_comp_rtp_cb, NULL))
 	{
 		goto destroy_comp;
 	}
 
-	/* output the statistics columns names */
-	printf("STAT\t"
-	       "\"packet number\"\t"
-	       "\"context mode\"\t"
-	       "\"context mode (string)\"\t"
-	       "\"context state\"\t"
-	       "\"context state (string)\"\t"
-	       "\"packet type\"\t"
-	       "\"packet type (string)\"\t"
-	       "\"uncompressed packet size (bytes)\"\t"
-	       "\"uncompressed header size (bytes)\"\t"
-	       "\"compressed packet size (bytes)\"\t"
-	       "\"compressed header size (bytes)\"\n");
+	if(do_summary)
+	{
+		/* the memory used by the summary only depends on the number of
+		 * contexts, not on the length of the capture */
+		memset(&summary, 0, sizeof(struct stats_summary));
+		summary.window_len = window_len;
+		summary.window_first = 1;
+		summary.max_contexts = max_contexts;
+		summary.per_cid = calloc(max_contexts, sizeof(struct stats_counters));
+		if(summary.per_cid == NULL)
+		{
+			fprintf(stderr, "failed to allocate memory for the per-CID "
+			        "statistics\n");
+			goto destroy_comp;
+		}
+		summary.per_cid_streams_nr = calloc(max_contexts, sizeof(unsigned long));
+		if(summary.per_cid_streams_nr == NULL)
+		{
+			fprintf(stderr, "failed to allocate memory for the per-CID "
+			        "statistics\n");
+			goto free_summary;
+		}
+
+		/* output the window columns names */
+		printf("WINDOW\t"
+		       "\"first packet\"\t"
+		       "\"last packet\"\t"
+		       "\"uncompressed size (bytes)\"\t"
+		       "\"compressed size (bytes)\"\t"
+		       "\"compression ratio (%%)\"\t"
+		       "\"uncompressed header size (bytes)\"\t"
+		       "\"compressed header size (bytes)\"\t"
+		       "\"header compression ratio (%%)\"\n");
+	}
+	else
+	{
+		/* output the statistics columns names */
+		printf("STAT\t"
+		       "\"packet number\"\t"
+		       "\"context mode\"\t"
+		       "\"context mode (string)\"\t"
+		       "\"context state\"\t"
+		       "\"context state (string)\"\t"
+		       "\"packet type\"\t"
+		       "\"packet type (string)\"\t"
+		       "\"uncompressed packet size (bytes)\"\t"
+		       "\"uncompressed header size (bytes)\"\t"
+		       "\"compressed packet size (bytes)\"\t"
+		       "\"compressed header size (bytes)\"\n");
+	}
 	fflush(stdout);
 
 	/* for each packet extracted from the PCAP file */
 	num_packet = 0;
-	while((packet = (unsigned char *) pcap_next(handle, &header)) != NULL)
+	while(1)
 	{
 		int ret;
 
+		if(use_mmap)
+		{
+			ret = pcap_mmap_next(&capture, &header, &packet);
+			if(ret < 0)
+			{
+				fprintf(stderr, "packet %lu: truncated PCAP record\n",
+				        num_packet + 1);
+				goto free_summary;
+			}
+			else if(ret == 0)
+			{
+				break;
+			}
+		}
+		else
+		{
+			packet = pcap_next(handle, &header);
+			if(packet == NULL)
+			{
+				break;
+			}
+		}
+
 		num_packet++;
 
 		/* compress the packet and generate statistics */
-		ret = generate_comp_stats_one(comp, num_packet, header, packet, link_len);
+		ret = generate_comp_stats_one(comp, num_packet, header, packet, link_len,
+		                              do_summary ? &summary : NULL);
 		if(ret != 0)
 		{
 			fprintf(stderr, "packet %lu: failed to compress or generate stats "
 			        "for packet\n", num_packet);
-			goto destroy_comp;
+			goto free_summary;
 		}
 	}
 
+	/* output the aggregated statistics */
+	if(do_summary)
+	{
+		stats_summary_print_window(&summary, num_packet);
+		stats_summary_print(&summary);
+	}
+
 	/* everything went fine */
 	is_failure = 0;
 
+free_summary:
+	if(do_summary)
+	{
+		free(summary.per_cid_streams_nr);
+		free(summary.per_cid);
+	}
 destroy_comp:
 	rohc_comp_free(comp);
 close_input:
-	pcap_close(handle);
+	if(use_mmap)
+	{
+		pcap_mmap_close(&capture);
+	}
+	else
+	{
+		pcap_close(handle);
+	}
 error:
 	return is_failure;
 }
@@ -427,6 +805,8 @@ error:
  * @param header      The PCAP header for the packet
  * @param packet      The packet to compress (link layer included)
  * @param link_len    The length of the link layer header before IP data
+ * @param summary     The statistics to aggregate the packet in,
+ *                    NULL to print the statistics of the packet
  * @return            0 in case of success,
  *                    1 in case of failure
  */
@@ -434,7 +814,8 @@ static int generate_comp_stats_one(struct rohc_comp *comp,
                                    const unsigned long num_packet,
                                    const struct pcap_pkthdr header,
                                    const unsigned char *packet,
-                                   const int link_len)
+                                   const int link_len,
+                                   struct stats_summary *const summary)
 {
 	struct rohc_ts arrival_time = { .sec = 0, .nsec = 0 };
 	struct rohc_buf ip_packet =
@@ -501,6 +882,13 @@ static int generate_comp_stats_one(struct rohc_comp *comp,
 		goto error;
 	}
 
+	/* aggregate the statistics about the last compressed packet */
+	if(summary != NULL)
+	{
+		stats_summary_add(summary, num_packet, &last_packet_info);
+		return 0;
+	}
+
 	/* output some statistics about the last compressed packet */
 	printf("STAT\t%lu\t%d\t%s\t%d\t%s\t%d\t%s\t%lu\t%lu\t%lu\t%lu\n",
 	       num_packet,
@@ -523,6 +911,397 @@ error:
 }
 
 
+/**
+ * @brief Add the last compressed packet to the given statistics
+ *
+ * @param counters  The statistics to update
+ * @param info      The information about the last compressed packet
+ */
+static void stats_counters_add(struct stats_counters *const counters,
+                               const rohc_comp_last_packet_info2_t *const info)
+{
+	counters->packets_nr++;
+	counters->uncomp_bytes += info->total_last_uncomp_size;
+	counters->uncomp_hdr_bytes += info->header_last_uncomp_size;
+	counters->comp_bytes += info->total_last_comp_size;
+	counters->comp_hdr_bytes += info->header_last_comp_size;
+}
+
+
+/**
+ * @brief Aggregate the last compressed packet in the summary
+ *
+ * The compression ratio of the current window is printed once the window
+ * is complete.
+ *
+ * @param summary     The summary to update
+ * @param num_packet  The number of the last compressed packet
+ * @param info        The information about the last compressed packet
+ */
+static void stats_summary_add(struct stats_summary *const summary,
+                              const unsigned long num_packet,
+                              const rohc_comp_last_packet_info2_t *const info)
+{
+	stats_counters_add(&summary->total, info);
+	stats_counters_add(&summary->window, info);
+	if(info->profile_id >= 0 && info->profile_id < ROHC_PROFILE_MAX)
+	{
+		stats_counters_add(&summary->per_profile[info->profile_id], info);
+	}
+	if(info->packet_type >= 0 && info->packet_type < ROHC_PACKET_MAX)
+	{
+		stats_counters_add(&summary->per_pkt_type[info->packet_type], info);
+	}
+	if(info->context_state >= 0 && info->context_state < STATS_COMP_STATES_NR)
+	{
+		stats_counters_add(&summary->per_state[info->context_state], info);
+	}
+	if(info->context_id < summary->max_contexts)
+	{
+		stats_counters_add(&summary->per_cid[info->context_id], info);
+		if(info->is_context_init)
+		{
+			summary->per_cid_streams_nr[info->context_id]++;
+		}
+	}
+
+	if(summary->window.packets_nr >= summary->window_len)
+	{
+		stats_summary_print_window(summary, num_packet);
+	}
+}
+
+
+/**
+ * @brief Print the compression ratio of the current window, then start
+ *        the next window
+ *
+ * @param summary      The summary
+ * @param last_packet  The number of the last packet of the window
+ */
+static void stats_summary_print_window(struct stats_summary *const summary,
+                                       const unsigned long last_packet)
+{
+	const struct stats_counters *const window = &summary->window;
+
+	if(window->packets_nr == 0)
+	{
+		return;
+	}
+
+	printf("WINDOW\t%lu\t%lu\t%llu\t%llu\t%.2f\t%llu\t%llu\t%.2f\n",
+	       summary->window_first, last_packet,
+	       window->uncomp_bytes, window->comp_bytes,
+	       window->uncomp_bytes == 0 ? 0.0 :
+	       window->comp_bytes * 100.0 / window->uncomp_bytes,
+	       window->uncomp_hdr_bytes, window->comp_hdr_bytes,
+	       window->uncomp_hdr_bytes == 0 ? 0.0 :
+	       window->comp_hdr_bytes * 100.0 / window->uncomp_hdr_bytes);
+	fflush(stdout);
+
+	memset(&summary->window, 0, sizeof(struct stats_counters));
+	summary->window_first = last_packet + 1;
+}
+
+
+/**
+ * @brief Print the statistics of one set of packets of the summary
+ *
+ * @param keyword   The keyword of the line
+ * @param id        The numeric ID of the set of packets
+ * @param descr     The description of the set of packets (no whitespace)
+ * @param counters  The statistics of the set of packets
+ * @param total     The statistics of all the packets
+ */
+static void stats_counters_print(const char *const keyword,
+                                 const unsigned int id,
+                                 const char *const descr,
+                                 const struct stats_counters *const counters,
+                                 const struct stats_counters *const total)
+{
+	printf("%s\t%u\t%s\t%lu\t%llu\t%llu\t%.2f\t%llu\t%llu\t%.2f\t"
+	       "%lld\t%.2f\t%.2f\n",
+	       keyword, id, descr, counters->packets_nr,
+	       counters->uncomp_bytes, counters->comp_bytes,
+	       counters->uncomp_bytes == 0 ? 0.0 :
+	       counters->comp_bytes * 100.0 / counters->uncomp_bytes,
+	       counters->uncomp_hdr_bytes, counters->comp_hdr_bytes,
+	       counters->uncomp_hdr_bytes == 0 ? 0.0 :
+	       counters->comp_hdr_bytes * 100.0 / counters->uncomp_hdr_bytes,
+	       ((long long) counters->uncomp_hdr_bytes) -
+	       ((long long) counters->comp_hdr_bytes),
+	       counters->packets_nr == 0 ? 0.0 :
+	       ((double) counters->comp_hdr_bytes) / counters->packets_nr,
+	       total->packets_nr == 0 ? 0.0 :
+	       counters->packets_nr * 100.0 / total->packets_nr);
+}
+
+
+/**
+ * @brief Print the per-profile, per-packet-type, per-state and per-CID
+ *        summaries
+ *
+ * Only the profiles, packet types, states and CIDs used by at least one
+ * packet are printed.
+ *
+ * @param summary  The summary
+ */
+static void stats_summary_print(const struct stats_summary *const summary)
+{
+	const char *const columns =
+		"\"packets\"\t"
+		"\"uncompressed size (bytes)\"\t"
+		"\"compressed size (bytes)\"\t"
+		"\"compression ratio (%)\"\t"
+		"\"uncompressed header size (bytes)\"\t"
+		"\"compressed header size (bytes)\"\t"
+		"\"header compression ratio (%)\"\t"
+		"\"saved header bytes\"\t"
+		"\"average compressed header size (bytes)\"\t"
+		"\"packets share (%)\"";
+	unsigned int i;
+
+	printf("PROFILE\t\"profile ID\"\t\"profile (string)\"\t%s\n", columns);
+	for(i = 0; i < ROHC_PROFILE_MAX; i++)
+	{
+		if(summary->per_profile[i].packets_nr > 0)
+		{
+			stats_counters_print("PROFILE", i, rohc_get_profile_descr(i),
+			                     &summary->per_profile[i], &summary->total);
+		}
+	}
+
+	printf("PACKET_TYPE\t\"packet type\"\t\"packet type (string)\"\t%s\n",
+	       columns);
+	for(i = 0; i < ROHC_PACKET_MAX; i++)
+	{
+		if(summary->per_pkt_type[i].packets_nr > 0)
+		{
+			stats_counters_print("PACKET_TYPE", i, rohc_get_packet_descr(i),
+			                     &summary->per_pkt_type[i], &summary->total);
+		}
+	}
+
+	printf("STATE\t\"context state\"\t\"context state (string)\"\t%s\n",
+	       columns);
+	for(i = 0; i < STATS_COMP_STATES_NR; i++)
+	{
+		if(summary->per_state[i].packets_nr > 0)
+		{
+			stats_counters_print("STATE", i, rohc_comp_get_state_descr(i),
+			                     &summary->per_state[i], &summary->total);
+		}
+	}
+
+	printf("CID\t\"context ID\"\t\"streams\"\t%s\n", columns);
+	for(i = 0; i < summary->max_contexts; i++)
+	{
+		if(summary->per_cid[i].packets_nr > 0)
+		{
+			char streams_nr[32];
+
+			snprintf(streams_nr, sizeof(streams_nr), "%lu",
+			         summary->per_cid_streams_nr[i]);
+			stats_counters_print("CID", i, streams_nr, &summary->per_cid[i],
+			                     &summary->total);
+		}
+	}
+
+	printf("TOTAL\t\"-\"\t\"-\"\t%s\n", columns);
+	stats_counters_print("TOTAL", 0, "all", &summary->total, &summary->total);
+	fflush(stdout);
+}
+
+
+#if HAVE_SYS_MMAN_H == 1
+
+/**
+ * @brief Get one 32-bit field of the mapped PCAP capture
+ *
+ * @param capture  The mapped PCAP capture
+ * @param offset   The offset of the field in the capture
+ * @return         The field in host byte order
+ */
+static uint32_t pcap_mmap_get32(const struct pcap_mmap *const capture,
+                                const size_t offset)
+{
+	uint32_t value;
+
+	memcpy(&value, capture->data + offset, sizeof(uint32_t));
+	if(capture->is_swapped)
+	{
+		value = ((value & 0x000000ffU) << 24) | ((value & 0x0000ff00U) << 8) |
+		        ((value & 0x00ff0000U) >> 8) | ((value & 0xff000000U) >> 24);
+	}
+
+	return value;
+}
+
+#endif /* HAVE_SYS_MMAN_H */
+
+
+/**
+ * @brief Open the given PCAP file and map it in memory
+ *
+ * Only the classic PCAP format is supported, not the pcapng format.
+ *
+ * @param[out] capture  The mapped PCAP capture
+ * @param filename      The name of the PCAP file
+ * @return              true if the PCAP file was mapped, false otherwise
+ */
+static bool pcap_mmap_open(struct pcap_mmap *const capture,
+                           const char *const filename)
+{
+#if HAVE_SYS_MMAN_H == 1
+	struct stat file_stat;
+	uint32_t magic;
+	uint32_t link_type;
+	void *data;
+	int fd;
+
+	memset(capture, 0, sizeof(struct pcap_mmap));
+
+	fd = open(filename, O_RDONLY);
+	if(fd < 0)
+	{
+		fprintf(stderr, "failed to open the source pcap file '%s': %s\n",
+		        filename, strerror(errno));
+		goto error;
+	}
+	if(fstat(fd, &file_stat) != 0)
+	{
+		fprintf(stderr, "failed to get the size of the source pcap file '%s': "
+		        "%s\n", filename, strerror(errno));
+		goto close_file;
+	}
+	if(file_stat.st_size < PCAP_FILE_HDR_LEN)
+	{
+		fprintf(stderr, "source pcap file '%s' is too short\n", filename);
+		goto close_file;
+	}
+
+	/* map the whole file, the mapping remains once the file is closed */
+	data = mmap(NULL, file_stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	if(data == MAP_FAILED)
+	{
+		fprintf(stderr, "failed to map the source pcap file '%s': %s\n",
+		        filename, strerror(errno));
+		goto close_file;
+	}
+	close(fd);
+	capture->data = data;
+	capture->len = file_stat.st_size;
+	capture->offset = PCAP_FILE_HDR_LEN;
+	madvise(data, capture->len, MADV_SEQUENTIAL);
+
+	/* parse the file header */
+	memcpy(&magic, capture->data, sizeof(uint32_t));
+	if(magic == 0xa1b2c3d4 || magic == 0xd4c3b2a1)
+	{
+		capture->is_nsec = false;
+	}
+	else if(magic == 0xa1b23c4d || magic == 0x4d3cb2a1)
+	{
+		capture->is_nsec = true;
+	}
+	else
+	{
+		fprintf(stderr, "source pcap file '%s' is not in the PCAP format\n",
+		        filename);
+		goto unmap_file;
+	}
+	capture->is_swapped = (magic == 0xd4c3b2a1 || magic == 0x4d3cb2a1);
+	link_type = pcap_mmap_get32(capture, 20) & 0x0fffffff;
+	capture->link_type =
+		(link_type == PCAP_LINKTYPE_RAW ? DLT_RAW : ((int) link_type));
+
+	return true;
+
+unmap_file:
+	munmap((void *) capture->data, capture->len);
+	return false;
+close_file:
+	close(fd);
+error:
+	return false;
+#else
+	fprintf(stderr, "memory-mapped captures are not supported on this "
+	        "platform\n");
+	return false;
+#endif
+}
+
+
+/**
+ * @brief Get the next packet of the mapped PCAP capture
+ *
+ * The packet is not copied, it points in the mapping. The part of the
+ * capture already read is released at regular intervals, so that the memory
+ * used by the program does not grow with the size of the capture.
+ *
+ * @param capture      The mapped PCAP capture
+ * @param[out] header  The PCAP header of the packet
+ * @param[out] packet  The packet
+ * @return             1 if a packet was read,
+ *                     0 at the end of the capture,
+ *                     -1 if the last record is truncated
+ */
+static int pcap_mmap_next(struct pcap_mmap *const capture,
+                          struct pcap_pkthdr *const header,
+                          const unsigned char **const packet)
+{
+#if HAVE_SYS_MMAN_H == 1
+	uint32_t ts_frac;
+
+	if(capture->offset == capture->len)
+	{
+		return 0;
+	}
+	if((capture->len - capture->offset) < PCAP_RECORD_HDR_LEN)
+	{
+		return -1;
+	}
+
+	header->ts.tv_sec = pcap_mmap_get32(capture, capture->offset);
+	ts_frac = pcap_mmap_get32(capture, capture->offset + 4);
+	header->ts.tv_usec = (capture->is_nsec ? (ts_frac / 1000) : ts_frac);
+	header->caplen = pcap_mmap_get32(capture, capture->offset + 8);
+	header->len = pcap_mmap_get32(capture, capture->offset + 12);
+	if((capture->len - capture->offset - PCAP_RECORD_HDR_LEN) < header->caplen)
+	{
+		return -1;
+	}
+	*packet = capture->data + capture->offset + PCAP_RECORD_HDR_LEN;
+	capture->offset += PCAP_RECORD_HDR_LEN + header->caplen;
+
+	/* release the pages that were read */
+	if((capture->offset - capture->released) >= (2 * PCAP_MMAP_RELEASE_LEN))
+	{
+		madvise((void *) (capture->data + capture->released),
+		        PCAP_MMAP_RELEASE_LEN, MADV_DONTNEED);
+		capture->released += PCAP_MMAP_RELEASE_LEN;
+	}
+
+	return 1;
+#else
+	return 0;
+#endif
+}
+
+
+/**
+ * @brief Unmap the given PCAP capture
+ *
+ * @param capture  The mapped PCAP capture
+ */
+static void pcap_mmap_close(struct pcap_mmap *const capture)
+{
+#if HAVE_SYS_MMAN_H == 1
+	munmap((void *) capture->data, capture->len);
+#endif
+}
+
+
 /**
  * @brief Callback to print traces of the ROHC library
  *
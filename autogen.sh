@@ -81,6 +81,7 @@ $( dirname $0 )/configure \
 	--enable-app-performance \
 	--enable-app-sniffer \
 	--enable-app-stats \
+	--enable-app-archive \
 	--enable-rohc-tests \
 	--enable-doc \
 	--enable-examples \
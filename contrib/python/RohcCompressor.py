@@ -34,6 +34,7 @@ from rohc import ROHC_SMALL_CID, ROHC_SMALL_CID_MAX, \
                  rohc_comp_new2, rohc_comp_set_traces_cb2, \
                  rohc_comp_enable_profile, rohc_comp_set_wlsb_window_width, \
                  rohc_comp_set_rtp_detection_cb, rohc_compress4, \
+                 rohc_compress_batch, \
                  rohc_comp_deliver_feedback2, rohc_get_profile_descr, \
                  gen_false_random_num, print_rohc_traces, rohc_comp_rtp_cb, \
                  rohc_ts, rohc_buf
@@ -140,6 +141,31 @@ class RohcCompressor(object):
 
         return (status, self._buf[:buf_comp.len])
 
+    def compress_batch(self, uncomp_pkts, extra_len=256):
+        """ Compress the given batch of uncompressed packets
+
+        The packets are not copied, and the GIL is released while they are
+        compressed: several threads may compress at the same time, with one
+        compressor each.
+
+        Keyword arguments:
+        uncomp_pkts -- the sequence of uncompressed packets, every packet is
+                       an object that supports the buffer protocol (bytes,
+                       bytearray, memoryview, 1-D numpy array of uint8...)
+        extra_len   -- the number of bytes a compressed packet may be larger
+                       than its uncompressed packet
+
+        Return the list of tuples (status, comp_pkt), one for every packet:
+        status   -- a value among ROHC_STATUS_*
+        comp_pkt -- the compressed packet (memoryview) or None wrt status
+        """
+
+        (out, results) = rohc_compress_batch(self.comp, uncomp_pkts, extra_len)
+        out_view = memoryview(out)
+        return [(status, out_view[offset:offset + length] \
+                         if status == ROHC_STATUS_OK else None) \
+                for (status, offset, length) in results]
+
     def deliver_feedback(self, feedback):
         """ Deliver the given feedback packet to the ROHC compressor
 
@@ -33,6 +33,7 @@ from rohc import ROHC_SMALL_CID, ROHC_SMALL_CID_MAX, \
                  ROHC_STATUS_OK, ROHC_STATUS_ERROR, \
                  rohc_decomp_new2, rohc_decomp_set_traces_cb2, \
                  rohc_decomp_enable_profile, rohc_decompress3, \
+                 rohc_decompress_batch, \
                  rohc_get_profile_descr, print_rohc_traces, \
                  rohc_ts, rohc_buf
 from struct import pack
@@ -149,3 +150,34 @@ class RohcDecompressor(object):
                 self._buf2[:buf_feedback_recv.len], \
                 self._buf3[:buf_feedback_to_send.len])
 
+    def decompress_batch(self, comp_pkts, extra_len=512):
+        """ Decompress the given batch of compressed ROHC packets
+
+        The packets are not copied, and the GIL is released while they are
+        decompressed: several threads may decompress at the same time, with
+        one decompressor each.
+
+        Keyword arguments:
+        comp_pkts -- the sequence of compressed ROHC packets, every packet is
+                     an object that supports the buffer protocol (bytes,
+                     bytearray, memoryview, 1-D numpy array of uint8...)
+        extra_len -- the number of bytes a decompressed packet may be larger
+                     than its ROHC packet
+
+        Return tuple:
+        results          -- the list of tuples (status, decomp_pkt), one for
+                            every packet: status is a value among
+                            ROHC_STATUS_*, decomp_pkt is the decompressed
+                            packet (memoryview) or None wrt status
+        feedback_recv    -- the feedback (bytes) received with the whole batch
+        feedback_to_send -- the feedback (bytes) to send with the associated
+                            compressor for the whole batch
+        """
+
+        (out, results, feedback_recv, feedback_to_send) = \
+            rohc_decompress_batch(self.decomp, comp_pkts, extra_len)
+        out_view = memoryview(out)
+        return ([(status, out_view[offset:offset + length] \
+                          if status == ROHC_STATUS_OK else None) \
+                 for (status, offset, length) in results], \
+                feedback_recv, feedback_to_send)
@@ -34,6 +34,7 @@
 
 #include "rohc_helpers2.h"
 #include "rohc_helpers.h"
+#include "rohc_batch.h"
 %}
 
 #define __attribute__(x)
@@ -102,6 +103,9 @@
 
 %include "rohc_helpers2.h"
 
+PyObject *rohc_compress_batch(struct rohc_comp *comp, PyObject *packets, size_t extra_len);
+PyObject *rohc_decompress_batch(struct rohc_decomp *decomp, PyObject *packets, size_t extra_len);
+
 %constant void print_rohc_traces(void *const, const rohc_trace_level_t, const rohc_trace_entity_t, const int, const char *const, ...);
 %constant int gen_false_random_num(const struct rohc_comp *const, void *const);
 %constant bool rohc_comp_rtp_cb(const unsigned char *const, const unsigned char *const, const unsigned char *const, const unsigned int, void *const rtp_private);
@@ -0,0 +1,341 @@
+/*
+ * Copyright 2016 Didier Barvaux
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/**
+ * @file    rohc_batch.h
+ * @brief   Batch compression and decompression for the python binding
+ * @author  Didier Barvaux <didier@barvaux.org>
+ *
+ * The packets of one batch are given as a sequence of objects that support
+ * the buffer protocol (bytes, bytearray, memoryview, numpy arrays...): their
+ * memory is given to the library as is, without any copy. All the resulting
+ * packets are written in one single bytearray, the python code slices it
+ * with memoryviews, without any copy either. The GIL is released while the
+ * library handles the batch, so that several python threads may compress or
+ * decompress at the same time, with one compressor or decompressor each.
+ */
+
+#ifndef ROHC_BATCH_H
+#define ROHC_BATCH_H
+
+#include <Python.h>
+
+
+/** The maximum length (in bytes) of the feedback of one batch */
+#define ROHC_BATCH_FEEDBACK_MAX_LEN  0xffffU
+
+
+/** The memory of the packets of one batch */
+struct rohc_batch
+{
+	size_t pkts_nr;          /**< The number of packets in the batch */
+	Py_buffer *views;        /**< The memory of the input packets */
+	size_t views_nr;         /**< The number of views acquired so far */
+	struct rohc_buf *ins;    /**< The input packets */
+	struct rohc_buf *outs;   /**< The output packets */
+	rohc_status_t *statuses; /**< The status of every packet */
+	PyObject *out;           /**< The bytearray of all the output packets */
+};
+
+
+/**
+ * @brief Release the memory of one batch
+ *
+ * @param batch  The batch to release
+ */
+static void rohc_batch_release(struct rohc_batch *const batch)
+{
+	size_t i;
+
+	for(i = 0; i < batch->views_nr; i++)
+	{
+		PyBuffer_Release(&batch->views[i]);
+	}
+	PyMem_Free(batch->views);
+	PyMem_Free(batch->ins);
+	PyMem_Free(batch->outs);
+	PyMem_Free(batch->statuses);
+	Py_XDECREF(batch->out);
+}
+
+
+/**
+ * @brief Acquire the memory of the packets of one batch
+ *
+ * The output packet of every input packet gets as much room as the input
+ * packet plus \e extra_len bytes in the bytearray of the batch.
+ *
+ * @param packets     The sequence of input packets
+ * @param extra_len   The length (in bytes) an output packet may be larger
+ *                    than its input packet
+ * @param[out] batch  The batch
+ * @return            true if the batch is ready,
+ *                    false if a python exception was raised
+ */
+static bool rohc_batch_acquire(PyObject *const packets,
+                               const size_t extra_len,
+                               struct rohc_batch *const batch)
+{
+	const struct rohc_ts ts = { .sec = 0, .nsec = 0 };
+	PyObject *seq;
+	uint8_t *out_data;
+	size_t out_len = 0;
+	size_t i;
+
+	memset(batch, 0, sizeof(struct rohc_batch));
+
+	seq = PySequence_Fast(packets, "packets shall be a sequence");
+	if(seq == NULL)
+	{
+		goto error;
+	}
+	batch->pkts_nr = (size_t) PySequence_Fast_GET_SIZE(seq);
+	batch->views = PyMem_Malloc(sizeof(Py_buffer) * (batch->pkts_nr + 1));
+	batch->ins = PyMem_Malloc(sizeof(struct rohc_buf) * (batch->pkts_nr + 1));
+	batch->outs = PyMem_Malloc(sizeof(struct rohc_buf) * (batch->pkts_nr + 1));
+	batch->statuses = PyMem_Malloc(sizeof(rohc_status_t) * (batch->pkts_nr + 1));
+	if(batch->views == NULL || batch->ins == NULL || batch->outs == NULL ||
+	   batch->statuses == NULL)
+	{
+		PyErr_NoMemory();
+		goto release_seq;
+	}
+
+	/* the memory of every input packet is used in place */
+	for(i = 0; i < batch->pkts_nr; i++)
+	{
+		PyObject *const packet = PySequence_Fast_GET_ITEM(seq, i);
+
+		if(PyObject_GetBuffer(packet, &batch->views[i], PyBUF_SIMPLE) != 0)
+		{
+			goto release_seq;
+		}
+		batch->views_nr++;
+		batch->ins[i] =
+			(struct rohc_buf) rohc_buf_init_full(batch->views[i].buf,
+			                                     (size_t) batch->views[i].len, ts);
+		out_len += (size_t) batch->views[i].len + extra_len;
+	}
+	Py_DECREF(seq);
+
+	/* all the output packets share one bytearray */
+	batch->out = PyByteArray_FromStringAndSize(NULL, (Py_ssize_t) out_len);
+	if(batch->out == NULL)
+	{
+		goto error;
+	}
+	out_data = (uint8_t *) PyByteArray_AS_STRING(batch->out);
+	for(i = 0; i < batch->pkts_nr; i++)
+	{
+		const size_t max_len = batch->ins[i].len + extra_len;
+
+		batch->outs[i] = (struct rohc_buf) rohc_buf_init_empty(out_data, max_len);
+		out_data += max_len;
+	}
+
+	return true;
+
+release_seq:
+	Py_DECREF(seq);
+error:
+	rohc_batch_release(batch);
+	return false;
+}
+
+
+/**
+ * @brief Build the result of one batch
+ *
+ * @param batch  The batch
+ * @return       The list of (status, offset, length) tuples, one for every
+ *               packet, the offset and length of the output packet within
+ *               the bytearray of the batch, NULL if a python exception was
+ *               raised
+ */
+static PyObject * rohc_batch_results(const struct rohc_batch *const batch)
+{
+	const uint8_t *const out_data =
+		(const uint8_t *) PyByteArray_AS_STRING(batch->out);
+	PyObject *results;
+	size_t i;
+
+	results = PyList_New((Py_ssize_t) batch->pkts_nr);
+	if(results == NULL)
+	{
+		return NULL;
+	}
+	for(i = 0; i < batch->pkts_nr; i++)
+	{
+		const size_t offset = rohc_buf_data(batch->outs[i]) - out_data;
+		PyObject *const result =
+			Py_BuildValue("(inn)", batch->statuses[i], (Py_ssize_t) offset,
+			              (Py_ssize_t) batch->outs[i].len);
+
+		if(result == NULL)
+		{
+			Py_DECREF(results);
+			return NULL;
+		}
+		PyList_SET_ITEM(results, (Py_ssize_t) i, result);
+	}
+
+	return results;
+}
+
+
+/**
+ * @brief Compress a batch of packets
+ *
+ * The GIL is released while the packets are compressed: the compressor shall
+ * not be used by another thread meanwhile.
+ *
+ * @param comp       The ROHC compressor
+ * @param packets    The sequence of uncompressed packets, every packet is an
+ *                   object that supports the buffer protocol
+ * @param extra_len  The length (in bytes) a ROHC packet may be larger than
+ *                   its uncompressed packet
+ * @return           The tuple (bytearray, results): the bytearray holds all
+ *                   the ROHC packets, results is the list of (status, offset,
+ *                   length) tuples of every packet, see \ref rohc_compress4
+ *                   for the status values. NULL if an exception was raised.
+ */
+PyObject * rohc_compress_batch(struct rohc_comp *const comp,
+                               PyObject *const packets,
+                               const size_t extra_len)
+{
+	struct rohc_batch batch;
+	PyObject *results;
+	PyObject *ret;
+	size_t handled_nr = 0;
+
+	if(!rohc_batch_acquire(packets, extra_len, &batch))
+	{
+		return NULL;
+	}
+
+	if(batch.pkts_nr > 0)
+	{
+		Py_BEGIN_ALLOW_THREADS
+		handled_nr = rohc_compress_burst(comp, batch.ins, batch.outs,
+		                                 batch.pkts_nr, batch.statuses);
+		Py_END_ALLOW_THREADS
+		if(handled_nr != batch.pkts_nr)
+		{
+			PyErr_SetString(PyExc_ValueError, "failed to compress the batch");
+			rohc_batch_release(&batch);
+			return NULL;
+		}
+	}
+
+	results = rohc_batch_results(&batch);
+	if(results == NULL)
+	{
+		rohc_batch_release(&batch);
+		return NULL;
+	}
+	ret = Py_BuildValue("(ON)", batch.out, results);
+	rohc_batch_release(&batch);
+
+	return ret;
+}
+
+
+/**
+ * @brief Decompress a batch of ROHC packets
+ *
+ * The GIL is released while the packets are decompressed: the decompressor
+ * shall not be used by another thread meanwhile.
+ *
+ * @param decomp     The ROHC decompressor
+ * @param packets    The sequence of ROHC packets, every packet is an object
+ *                   that supports the buffer protocol
+ * @param extra_len  The length (in bytes) a decompressed packet may be larger
+ *                   than its ROHC packet
+ * @return           The tuple (bytearray, results, feedback_recv,
+ *                   feedback_to_send): the bytearray holds all the
+ *                   decompressed packets, results is the list of (status,
+ *                   offset, length) tuples of every packet, see
+ *                   \ref rohc_decompress3 for the status values, and the
+ *                   feedbacks of the whole batch are bytes. NULL if an
+ *                   exception was raised.
+ */
+PyObject * rohc_decompress_batch(struct rohc_decomp *const decomp,
+                                 PyObject *const packets,
+                                 const size_t extra_len)
+{
+	uint8_t feedback_recv_data[ROHC_BATCH_FEEDBACK_MAX_LEN];
+	uint8_t feedback_send_data[ROHC_BATCH_FEEDBACK_MAX_LEN];
+	struct rohc_buf feedback_recv =
+		rohc_buf_init_empty(feedback_recv_data, ROHC_BATCH_FEEDBACK_MAX_LEN);
+	struct rohc_buf feedback_send =
+		rohc_buf_init_empty(feedback_send_data, ROHC_BATCH_FEEDBACK_MAX_LEN);
+	struct rohc_batch batch;
+	PyObject *feedback_recv_bytes;
+	PyObject *feedback_send_bytes;
+	PyObject *results;
+	PyObject *ret;
+	size_t handled_nr = 0;
+
+	if(!rohc_batch_acquire(packets, extra_len, &batch))
+	{
+		return NULL;
+	}
+
+	if(batch.pkts_nr > 0)
+	{
+		Py_BEGIN_ALLOW_THREADS
+		handled_nr = rohc_decompress_burst(decomp, batch.ins, batch.outs,
+		                                   batch.pkts_nr, &feedback_recv,
+		                                   &feedback_send, batch.statuses);
+		Py_END_ALLOW_THREADS
+		if(handled_nr != batch.pkts_nr)
+		{
+			PyErr_SetString(PyExc_ValueError, "failed to decompress the batch");
+			rohc_batch_release(&batch);
+			return NULL;
+		}
+	}
+
+	results = rohc_batch_results(&batch);
+	if(results == NULL)
+	{
+		rohc_batch_release(&batch);
+		return NULL;
+	}
+	feedback_recv_bytes =
+		PyBytes_FromStringAndSize((char *) rohc_buf_data(feedback_recv),
+		                          (Py_ssize_t) feedback_recv.len);
+	feedback_send_bytes =
+		PyBytes_FromStringAndSize((char *) rohc_buf_data(feedback_send),
+		                          (Py_ssize_t) feedback_send.len);
+	if(feedback_recv_bytes == NULL || feedback_send_bytes == NULL)
+	{
+		Py_XDECREF(feedback_recv_bytes);
+		Py_XDECREF(feedback_send_bytes);
+		Py_DECREF(results);
+		rohc_batch_release(&batch);
+		return NULL;
+	}
+	ret = Py_BuildValue("(ONNN)", batch.out, results, feedback_recv_bytes,
+	                    feedback_send_bytes);
+	rohc_batch_release(&batch);
+
+	return ret;
+}
+
+#endif /* ROHC_BATCH_H */
@@ -0,0 +1,614 @@
+/*
+ * Copyright 2026 Didier Barvaux
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/**
+ * @file   rohc.hpp
+ * @brief  Header-only C++ layer over the ROHC compressor and decompressor
+ * @author Didier Barvaux <didier@barvaux.org>
+ *
+ * The compressor and the decompressor are owned by move-only handles that
+ * free them when they go out of scope. The packets are given as std::span
+ * views that are mapped onto the struct rohc_buf of the C API without any
+ * copy, and the output views are shrunk to the bytes written by the library.
+ * No function allocates memory or throws exceptions: the status of every
+ * operation is returned, and its description is the static string of
+ * rohc_strerror().
+ *
+ * The burst functions are templates over the containers of the packets, so
+ * that they inline into the callers: arrays of struct rohc_buf are handed to
+ * the library as they are, other contiguous ranges of views are converted
+ * on the stack by chunks of \ref rohc::burst_chunk_nr packets.
+ *
+ * The functions of the C API that the handles do not wrap may be called on
+ * the pointers returned by their get() methods.
+ *
+ * C++20 is required.
+ */
+
+#ifndef ROHC_HPP
+#define ROHC_HPP
+
+#if !defined(__cplusplus) || __cplusplus < 202002L
+#  error "rohc.hpp requires C++20 or later"
+#endif
+
+#include <rohc/rohc.h>
+#include <rohc/rohc_buf.h>
+#include <rohc/rohc_comp.h>
+#include <rohc/rohc_decomp.h>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <ranges>
+#include <span>
+#include <type_traits>
+#include <utility>
+
+
+namespace rohc
+{
+
+/** A view on bytes written by the library, an output packet for example */
+using bytes = std::span<uint8_t>;
+
+/** A view on bytes read by the library, an input packet for example */
+using const_bytes = std::span<const uint8_t>;
+
+/** The number of packets that the burst functions convert at once */
+inline constexpr std::size_t burst_chunk_nr = 32;
+
+
+/**
+ * @brief Map a view on an input packet onto a network buffer
+ *
+ * @param data  The packet
+ * @param time  The arrival time of the packet
+ * @return      The network buffer full of the packet
+ */
+inline rohc_buf to_buf(const const_bytes data, const rohc_ts time = {}) noexcept
+{
+	/* the library never writes in the input packets */
+	return rohc_buf{ time, const_cast<uint8_t *>(data.data()), data.size(),
+	                 0, data.size() };
+}
+
+
+/**
+ * @brief Map a view on an output buffer onto an empty network buffer
+ *
+ * @param data  The output buffer
+ * @return      The empty network buffer
+ */
+inline rohc_buf to_empty_buf(const bytes data) noexcept
+{
+	return rohc_buf{ rohc_ts{ 0, 0 }, data.data(), data.size(), 0, 0 };
+}
+
+
+/**
+ * @brief Get a view on the bytes of a network buffer
+ *
+ * @param buf  The network buffer
+ * @return     The view on its bytes, from its offset
+ */
+inline bytes to_bytes(const rohc_buf &buf) noexcept
+{
+	return bytes(rohc_buf_data(buf), buf.len);
+}
+
+
+/** The result of the compression or decompression of one packet */
+struct result
+{
+	/** The status of the operation */
+	rohc_status_t status;
+	/** The bytes written in the output buffer */
+	bytes data;
+
+	/** Whether the operation succeeded */
+	explicit operator bool() const noexcept
+	{
+		return (status == ROHC_STATUS_OK);
+	}
+
+	/** The description of the status, a static string */
+	const char * what() const noexcept
+	{
+		return rohc_strerror(status);
+	}
+};
+
+
+namespace detail
+{
+
+/** Whether a range holds network buffers that may be given as they are */
+template<typename Range>
+inline constexpr bool holds_bufs =
+	std::is_same_v<std::ranges::range_value_t<Range>, rohc_buf>;
+
+
+/**
+ * @brief Hand a burst of packets over to the library by chunks
+ *
+ * @param packets    The input packets, views or containers of bytes
+ * @param outputs    The output buffers, views shrunk to the bytes written
+ * @param nr         The number of packets to handle
+ * @param time       The arrival time of the packets
+ * @param burst_fn   The function that handles one chunk of network buffers
+ * @return           The number of packets handled
+ */
+template<typename In, typename Out, typename BurstFn>
+inline std::size_t burst_by_chunks(const In &packets,
+                                   Out &outputs,
+                                   const std::size_t nr,
+                                   const rohc_ts time,
+                                   BurstFn &&burst_fn) noexcept
+{
+	static_assert(std::is_same_v<std::ranges::range_value_t<Out>, bytes>,
+	              "the output buffers shall be rohc::bytes views, so that "
+	              "they may be shrunk to the bytes written");
+	std::array<rohc_buf, burst_chunk_nr> in_bufs;
+	std::array<rohc_buf, burst_chunk_nr> out_bufs;
+	const auto in = std::ranges::begin(packets);
+	const auto out = std::ranges::begin(outputs);
+	std::size_t done = 0;
+
+	while(done < nr)
+	{
+		const std::size_t chunk_nr = std::min(nr - done, burst_chunk_nr);
+		std::size_t handled;
+
+		for(std::size_t i = 0; i < chunk_nr; i++)
+		{
+			in_bufs[i] = to_buf(const_bytes(in[done + i]), time);
+			out_bufs[i] = to_empty_buf(out[done + i]);
+		}
+		handled = burst_fn(in_bufs.data(), out_bufs.data(), chunk_nr, done);
+		for(std::size_t i = 0; i < handled; i++)
+		{
+			out[done + i] = to_bytes(out_bufs[i]);
+		}
+		done += handled;
+		if(handled < chunk_nr)
+		{
+			break;
+		}
+	}
+
+	return done;
+}
+
+}
+
+
+/** The move-only owner of one ROHC compressor */
+class compressor
+{
+public:
+	/**
+	 * @brief Create a ROHC compressor, see \ref rohc_comp_new2
+	 *
+	 * The handle is empty if the creation failed.
+	 */
+	compressor(const rohc_cid_type_t cid_type,
+	           const rohc_cid_t max_cid,
+	           const rohc_comp_random_cb_t rand_cb,
+	           void *const rand_priv = nullptr) noexcept
+		: comp_(rohc_comp_new2(cid_type, max_cid, rand_cb, rand_priv))
+	{
+	}
+
+	/** Take the ownership of a ROHC compressor created with the C API */
+	explicit compressor(rohc_comp *const comp) noexcept
+		: comp_(comp)
+	{
+	}
+
+	compressor(const compressor &) = delete;
+	compressor & operator=(const compressor &) = delete;
+
+	compressor(compressor &&other) noexcept
+		: comp_(std::exchange(other.comp_, nullptr))
+	{
+	}
+
+	compressor & operator=(compressor &&other) noexcept
+	{
+		if(this != &other)
+		{
+			reset(std::exchange(other.comp_, nullptr));
+		}
+		return *this;
+	}
+
+	~compressor()
+	{
+		reset();
+	}
+
+	/** Whether the handle owns a compressor */
+	explicit operator bool() const noexcept
+	{
+		return (comp_ != nullptr);
+	}
+
+	/** The compressor, for the functions of the C API */
+	rohc_comp * get() const noexcept
+	{
+		return comp_;
+	}
+
+	/** Give the ownership of the compressor back to the caller */
+	rohc_comp * release() noexcept
+	{
+		return std::exchange(comp_, nullptr);
+	}
+
+	/** Free the compressor, then take the ownership of the given one */
+	void reset(rohc_comp *const comp = nullptr) noexcept
+	{
+		if(comp_ != nullptr)
+		{
+			rohc_comp_free(comp_);
+		}
+		comp_ = comp;
+	}
+
+	/** Enable the given profiles, see \ref rohc_comp_enable_profile */
+	template<typename... Profiles>
+	bool enable_profiles(const Profiles... profiles) noexcept
+	{
+		return (rohc_comp_enable_profile(comp_, profiles) && ...);
+	}
+
+	/**
+	 * @brief Compress one packet, see \ref rohc_compress4
+	 *
+	 * @param packet  The uncompressed packet
+	 * @param out     The buffer for the ROHC packet
+	 * @param time    The arrival time of the packet
+	 * @return        The status and the ROHC packet within \e out
+	 */
+	result compress(const const_bytes packet,
+	                const bytes out,
+	                const rohc_ts time = {}) noexcept
+	{
+		rohc_buf rohc_packet = to_empty_buf(out);
+		const rohc_status_t status =
+			rohc_compress4(comp_, to_buf(packet, time), &rohc_packet);
+		return result{ status, to_bytes(rohc_packet) };
+	}
+
+	/**
+	 * @brief Compress one packet with a known context, see
+	 *        \ref rohc_compress_with_ctxt
+	 *
+	 * @param handle  The handle of the context of the flow of the packet
+	 * @param packet  The uncompressed packet
+	 * @param out     The buffer for the ROHC packet
+	 * @param time    The arrival time of the packet
+	 * @return        The status and the ROHC packet within \e out
+	 */
+	result compress(const rohc_comp_ctxt_handle_t handle,
+	                const const_bytes packet,
+	                const bytes out,
+	                const rohc_ts time = {}) noexcept
+	{
+		rohc_buf rohc_packet = to_empty_buf(out);
+		const rohc_status_t status =
+			rohc_compress_with_ctxt(comp_, handle, to_buf(packet, time),
+			                        &rohc_packet);
+		return result{ status, to_bytes(rohc_packet) };
+	}
+
+	/**
+	 * @brief The handle of the context of the last compressed packet, see
+	 *        \ref rohc_comp_get_last_ctxt_handle
+	 *
+	 * @return  The handle, ROHC_COMP_CTXT_HANDLE_NONE if not available
+	 */
+	rohc_comp_ctxt_handle_t last_ctxt_handle() const noexcept
+	{
+		rohc_comp_ctxt_handle_t handle;
+		if(!rohc_comp_get_last_ctxt_handle(comp_, &handle))
+		{
+			return ROHC_COMP_CTXT_HANDLE_NONE;
+		}
+		return handle;
+	}
+
+	/**
+	 * @brief Compress a burst of packets, see \ref rohc_compress_burst
+	 *
+	 * The packets and the ROHC packets are either network buffers given to
+	 * the library as they are, or views (or containers) of bytes for the
+	 * packets and \ref rohc::bytes views for the ROHC packets, shrunk to the
+	 * bytes written.
+	 *
+	 * @param packets       The uncompressed packets
+	 * @param rohc_packets  The buffers for the ROHC packets
+	 * @param statuses      The status of the compression of every packet
+	 * @param time          The arrival time of the packets given as views,
+	 *                      the network buffers carry their own
+	 * @return              The number of packets handled
+	 */
+	template<std::ranges::contiguous_range In, std::ranges::contiguous_range Out>
+	std::size_t compress_burst(const In &packets,
+	                           Out &&rohc_packets,
+	                           const std::span<rohc_status_t> statuses,
+	                           const rohc_ts time = {}) noexcept
+	{
+		const std::size_t nr =
+			std::min({ std::size_t(std::ranges::size(packets)),
+			           std::size_t(std::ranges::size(rohc_packets)),
+			           statuses.size() });
+
+		if constexpr(detail::holds_bufs<In> && detail::holds_bufs<Out>)
+		{
+			return rohc_compress_burst(comp_, std::ranges::data(packets),
+			                           std::ranges::data(rohc_packets), nr,
+			                           statuses.data());
+		}
+		else
+		{
+			return detail::burst_by_chunks(packets, rohc_packets, nr, time,
+				[this, statuses](const rohc_buf *const in, rohc_buf *const out,
+				                 const std::size_t chunk_nr,
+				                 const std::size_t done) noexcept
+				{
+					return rohc_compress_burst(comp_, in, out, chunk_nr,
+					                           statuses.data() + done);
+				});
+		}
+	}
+
+private:
+	rohc_comp *comp_;
+};
+
+
+/** The move-only owner of one ROHC decompressor */
+class decompressor
+{
+public:
+	/**
+	 * @brief Create a ROHC decompressor, see \ref rohc_decomp_new2
+	 *
+	 * The handle is empty if the creation failed.
+	 */
+	decompressor(const rohc_cid_type_t cid_type,
+	             const rohc_cid_t max_cid,
+	             const rohc_mode_t mode) noexcept
+		: decomp_(rohc_decomp_new2(cid_type, max_cid, mode))
+	{
+	}
+
+	/** Take the ownership of a ROHC decompressor created with the C API */
+	explicit decompressor(rohc_decomp *const decomp) noexcept
+		: decomp_(decomp)
+	{
+	}
+
+	decompressor(const decompressor &) = delete;
+	decompressor & operator=(const decompressor &) = delete;
+
+	decompressor(decompressor &&other) noexcept
+		: decomp_(std::exchange(other.decomp_, nullptr))
+	{
+	}
+
+	decompressor & operator=(decompressor &&other) noexcept
+	{
+		if(this != &other)
+		{
+			reset(std::exchange(other.decomp_, nullptr));
+		}
+		return *this;
+	}
+
+	~decompressor()
+	{
+		reset();
+	}
+
+	/** Whether the handle owns a decompressor */
+	explicit operator bool() const noexcept
+	{
+		return (decomp_ != nullptr);
+	}
+
+	/** The decompressor, for the functions of the C API */
+	rohc_decomp * get() const noexcept
+	{
+		return decomp_;
+	}
+
+	/** Give the ownership of the decompressor back to the caller */
+	rohc_decomp * release() noexcept
+	{
+		return std::exchange(decomp_, nullptr);
+	}
+
+	/** Free the decompressor, then take the ownership of the given one */
+	void reset(rohc_decomp *const decomp = nullptr) noexcept
+	{
+		if(decomp_ != nullptr)
+		{
+			rohc_decomp_free(decomp_);
+		}
+		decomp_ = decomp;
+	}
+
+	/** Enable the given profiles, see \ref rohc_decomp_enable_profile */
+	template<typename... Profiles>
+	bool enable_profiles(const Profiles... profiles) noexcept
+	{
+		return (rohc_decomp_enable_profile(decomp_, profiles) && ...);
+	}
+
+	/**
+	 * @brief Decompress one packet, see \ref rohc_decompress3
+	 *
+	 * @param packet              The ROHC packet
+	 * @param out                 The buffer for the uncompressed packet
+	 * @param[in,out] rcvd_feedback  The buffer for the feedback received for
+	 *                               the same-side compressor, shrunk to the
+	 *                               bytes written, nullptr to ignore it
+	 * @param[in,out] feedback_send  The buffer for the feedback to send to the
+	 *                               remote compressor, shrunk to the bytes
+	 *                               written, nullptr to send none
+	 * @param time                The arrival time of the packet
+	 * @return                    The status and the uncompressed packet
+	 *                            within \e out
+	 */
+	result decompress(const const_bytes packet,
+	                  const bytes out,
+	                  bytes *const rcvd_feedback = nullptr,
+	                  bytes *const feedback_send = nullptr,
+	                  const rohc_ts time = {}) noexcept
+	{
+		rohc_buf uncomp_packet = to_empty_buf(out);
+		rohc_buf rcvd_buf;
+		rohc_buf send_buf;
+		rohc_status_t status;
+
+		if(rcvd_feedback != nullptr)
+		{
+			rcvd_buf = to_empty_buf(*rcvd_feedback);
+		}
+		if(feedback_send != nullptr)
+		{
+			send_buf = to_empty_buf(*feedback_send);
+		}
+		status = rohc_decompress3(decomp_, to_buf(packet, time), &uncomp_packet,
+		                          rcvd_feedback != nullptr ? &rcvd_buf : nullptr,
+		                          feedback_send != nullptr ? &send_buf : nullptr);
+		if(rcvd_feedback != nullptr)
+		{
+			*rcvd_feedback = to_bytes(rcvd_buf);
+		}
+		if(feedback_send != nullptr)
+		{
+			*feedback_send = to_bytes(send_buf);
+		}
+		return result{ status, to_bytes(uncomp_packet) };
+	}
+
+	/**
+	 * @brief Decompress a burst of packets, see \ref rohc_decompress_burst
+	 *
+	 * The containers of the packets are handled as the ones of
+	 * \ref compressor::compress_burst.
+	 *
+	 * @param packets                The ROHC packets
+	 * @param uncomp_packets         The buffers for the uncompressed packets
+	 * @param statuses               The status of the decompression of
+	 *                               every packet
+	 * @param[in,out] rcvd_feedback  The buffer for the feedback received for
+	 *                               the same-side compressor, shrunk to the
+	 *                               bytes written, nullptr to ignore it
+	 * @param[in,out] feedback_send  The buffer for the feedback to send to the
+	 *                               remote compressor, shrunk to the bytes
+	 *                               written, nullptr to send none
+	 * @param time                   The arrival time of the packets given as
+	 *                               views, the network buffers carry their own
+	 * @return                       The number of packets handled
+	 */
+	template<std::ranges::contiguous_range In, std::ranges::contiguous_range Out>
+	std::size_t decompress_burst(const In &packets,
+	                             Out &&uncomp_packets,
+	                             const std::span<rohc_status_t> statuses,
+	                             bytes *const rcvd_feedback = nullptr,
+	                             bytes *const feedback_send = nullptr,
+	                             const rohc_ts time = {}) noexcept
+	{
+		const std::size_t nr =
+			std::min({ std::size_t(std::ranges::size(packets)),
+			           std::size_t(std::ranges::size(uncomp_packets)),
+			           statuses.size() });
+		std::size_t rcvd_len = 0;
+		std::size_t send_len = 0;
+		std::size_t handled;
+
+		/* the library appends the feedback of a burst to empty buffers, so
+		 * the feedback of every chunk is appended to the one of the previous
+		 * chunks */
+		const auto burst_fn =
+			[this, statuses, rcvd_feedback, feedback_send, &rcvd_len, &send_len]
+			(const rohc_buf *const in, rohc_buf *const out,
+			 const std::size_t chunk_nr, const std::size_t done) noexcept
+			{
+				rohc_buf rcvd_buf;
+				rohc_buf send_buf;
+				std::size_t chunk_handled;
+
+				if(rcvd_feedback != nullptr)
+				{
+					rcvd_buf = to_empty_buf(rcvd_feedback->subspan(rcvd_len));
+				}
+				if(feedback_send != nullptr)
+				{
+					send_buf = to_empty_buf(feedback_send->subspan(send_len));
+				}
+				chunk_handled =
+					rohc_decompress_burst(decomp_, in, out, chunk_nr,
+					                      rcvd_feedback != nullptr ? &rcvd_buf : nullptr,
+					                      feedback_send != nullptr ? &send_buf : nullptr,
+					                      statuses.data() + done);
+				if(rcvd_feedback != nullptr)
+				{
+					rcvd_len += rcvd_buf.len;
+				}
+				if(feedback_send != nullptr)
+				{
+					send_len += send_buf.len;
+				}
+				return chunk_handled;
+			};
+
+		if constexpr(detail::holds_bufs<In> && detail::holds_bufs<Out>)
+		{
+			handled = burst_fn(std::ranges::data(packets),
+			                   std::ranges::data(uncomp_packets), nr, 0);
+		}
+		else
+		{
+			handled = detail::burst_by_chunks(packets, uncomp_packets, nr, time,
+			                                  burst_fn);
+		}
+		if(rcvd_feedback != nullptr)
+		{
+			*rcvd_feedback = rcvd_feedback->first(rcvd_len);
+		}
+		if(feedback_send != nullptr)
+		{
+			*feedback_send = feedback_send->first(send_len);
+		}
+		return handled;
+	}
+
+private:
+	rohc_decomp *decomp_;
+};
+
+}
+
+#endif
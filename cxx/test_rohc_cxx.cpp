@@ -0,0 +1,313 @@
+/*
+ * Copyright 2026 Didier Barvaux
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/**
+ * @file    test_rohc_cxx.cpp
+ * @brief   Test the header-only C++ layer over the ROHC library
+ * @author  Didier Barvaux <didier@barvaux.org>
+ *
+ * The compressor and decompressor handles are instantiated and moved, then
+ * IPv4/UDP packets are compressed and decompressed one by one and by bursts,
+ * with ranges of network buffers and with ranges of std::span views. The
+ * decompressed packets shall be the original ones, byte for byte.
+ */
+
+#include "rohc.hpp"
+
+#include <array>
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <utility>
+
+
+/** Print trace on stdout only in verbose mode */
+#define trace(is_verbose, format, ...) \
+	do { \
+		if(is_verbose) { \
+			printf(format, ##__VA_ARGS__); \
+		} \
+	} while(0)
+
+/** Improved assert() */
+#define CHECK(condition) \
+	do { \
+		trace(verbose, "test '%s'\n", #condition); \
+		fflush(stdout); \
+		assert(condition); \
+	} while(0)
+
+
+/** The number of packets per burst, more than one chunk of the C++ layer */
+static constexpr std::size_t test_burst_nr = rohc::burst_chunk_nr + 8;
+
+/** The length of the IPv4/UDP packets of the test */
+static constexpr std::size_t test_pkt_len = 20 + 8 + 32;
+
+/** The max length of the ROHC packets of the test */
+static constexpr std::size_t test_rohc_max_len = test_pkt_len * 2;
+
+/** The packets of one burst */
+using test_pkts = std::array<std::array<uint8_t, test_pkt_len>, test_burst_nr>;
+
+/** The ROHC packets of one burst */
+using test_rohc_pkts =
+	std::array<std::array<uint8_t, test_rohc_max_len>, test_burst_nr>;
+
+
+static int random_cb(const struct rohc_comp *const comp,
+                     void *const user_context)
+	__attribute__((warn_unused_result));
+
+static void gen_udp_packet(const uint16_t ip_id,
+                           std::array<uint8_t, test_pkt_len> &pkt);
+
+
+/**
+ * @brief Test the header-only C++ layer over the ROHC library
+ *
+ * @param argc  The number of command line arguments
+ * @param argv  The command line arguments
+ * @return      0 if test succeeds, non-zero if test fails
+ */
+int main(int argc, char *argv[])
+{
+	bool verbose; /* whether to run in verbose mode or not */
+	uint16_t ip_id = 0;
+	int is_failure = 1; /* test fails by default */
+
+	/* do we run in verbose mode ? */
+	if(argc == 1)
+	{
+		/* no argument, run in silent mode */
+		verbose = false;
+	}
+	else if(argc == 2 && strcmp(argv[1], "verbose") == 0)
+	{
+		/* run in verbose mode */
+		verbose = true;
+	}
+	else
+	{
+		/* invalid usage */
+		printf("test the header-only C++ layer over the ROHC library\n");
+		printf("usage: %s [verbose]\n", argv[0]);
+		goto error;
+	}
+
+	{
+		/* the handles own the compressor and the decompressor, and move
+		 * them to other handles */
+		rohc::compressor first_comp(ROHC_SMALL_CID, ROHC_SMALL_CID_MAX,
+		                            random_cb);
+		rohc::decompressor first_decomp(ROHC_SMALL_CID, ROHC_SMALL_CID_MAX,
+		                                ROHC_O_MODE);
+		CHECK(first_comp);
+		CHECK(first_decomp);
+		rohc::compressor comp(std::move(first_comp));
+		rohc::decompressor decomp(ROHC_SMALL_CID, 0, ROHC_O_MODE);
+		decomp = std::move(first_decomp);
+		CHECK(!first_comp);
+		CHECK(!first_decomp);
+		CHECK(comp);
+		CHECK(decomp);
+
+		CHECK(comp.enable_profiles(ROHC_PROFILE_UNCOMPRESSED, ROHC_PROFILE_IP,
+		                           ROHC_PROFILE_UDP));
+		CHECK(decomp.enable_profiles(ROHC_PROFILE_UNCOMPRESSED, ROHC_PROFILE_IP,
+		                             ROHC_PROFILE_UDP));
+
+		/* one packet with views */
+		{
+			std::array<uint8_t, test_pkt_len> pkt;
+			std::array<uint8_t, test_rohc_max_len> rohc_pkt;
+			std::array<uint8_t, test_pkt_len> uncomp_pkt;
+
+			gen_udp_packet(ip_id++, pkt);
+			const rohc::result comp_res = comp.compress(pkt, rohc_pkt);
+			CHECK(comp_res);
+			CHECK(comp_res.status == ROHC_STATUS_OK);
+			CHECK(comp_res.data.data() == rohc_pkt.data());
+			CHECK(comp_res.data.size() > 0);
+			const rohc::result decomp_res =
+				decomp.decompress(comp_res.data, uncomp_pkt);
+			CHECK(decomp_res);
+			CHECK(decomp_res.data.size() == pkt.size());
+			CHECK(memcmp(decomp_res.data.data(), pkt.data(), pkt.size()) == 0);
+
+			/* the failures are described by the library */
+			const rohc::result err_res =
+				decomp.decompress(comp_res.data, rohc::bytes(uncomp_pkt).first(1));
+			CHECK(!err_res);
+			CHECK(strcmp(err_res.what(), rohc_strerror(err_res.status)) == 0);
+		}
+
+		/* bursts with ranges of network buffers */
+		{
+			static test_pkts pkts;
+			static test_rohc_pkts rohc_pkts_data;
+			static test_pkts uncomp_pkts_data;
+			std::array<rohc_buf, test_burst_nr> uncomp_bufs;
+			std::array<rohc_buf, test_burst_nr> rohc_bufs;
+			std::array<rohc_buf, test_burst_nr> decomp_bufs;
+			std::array<rohc_status_t, test_burst_nr> statuses;
+
+			for(std::size_t i = 0; i < test_burst_nr; i++)
+			{
+				gen_udp_packet(ip_id++, pkts[i]);
+				uncomp_bufs[i] = rohc::to_buf(pkts[i]);
+				rohc_bufs[i] = rohc::to_empty_buf(rohc_pkts_data[i]);
+				decomp_bufs[i] = rohc::to_empty_buf(uncomp_pkts_data[i]);
+			}
+
+			CHECK(comp.compress_burst(uncomp_bufs, rohc_bufs,
+			                          statuses) == test_burst_nr);
+			for(std::size_t i = 0; i < test_burst_nr; i++)
+			{
+				CHECK(statuses[i] == ROHC_STATUS_OK);
+				CHECK(rohc_bufs[i].len > 0);
+			}
+			CHECK(decomp.decompress_burst(rohc_bufs, decomp_bufs,
+			                              statuses) == test_burst_nr);
+			for(std::size_t i = 0; i < test_burst_nr; i++)
+			{
+				CHECK(statuses[i] == ROHC_STATUS_OK);
+				CHECK(decomp_bufs[i].len == test_pkt_len);
+				CHECK(memcmp(rohc_buf_data(decomp_bufs[i]), pkts[i].data(),
+				             test_pkt_len) == 0);
+			}
+		}
+
+		/* bursts with ranges of views, converted by chunks */
+		{
+			static test_pkts pkts;
+			static test_rohc_pkts rohc_pkts_data;
+			static test_pkts uncomp_pkts_data;
+			std::array<rohc::const_bytes, test_burst_nr> uncomp_views;
+			std::array<rohc::bytes, test_burst_nr> rohc_views;
+			std::array<rohc::bytes, test_burst_nr> decomp_views;
+			std::array<rohc_status_t, test_burst_nr> statuses;
+
+			for(std::size_t i = 0; i < test_burst_nr; i++)
+			{
+				gen_udp_packet(ip_id++, pkts[i]);
+				uncomp_views[i] = pkts[i];
+				rohc_views[i] = rohc_pkts_data[i];
+				decomp_views[i] = uncomp_pkts_data[i];
+			}
+
+			CHECK(comp.compress_burst(uncomp_views, rohc_views,
+			                          statuses) == test_burst_nr);
+			for(std::size_t i = 0; i < test_burst_nr; i++)
+			{
+				CHECK(statuses[i] == ROHC_STATUS_OK);
+				/* the views are shrunk to the bytes written */
+				CHECK(rohc_views[i].data() == rohc_pkts_data[i].data());
+				CHECK(rohc_views[i].size() > 0);
+				CHECK(rohc_views[i].size() < test_pkt_len);
+			}
+			CHECK(decomp.decompress_burst(rohc_views, decomp_views,
+			                              statuses) == test_burst_nr);
+			for(std::size_t i = 0; i < test_burst_nr; i++)
+			{
+				CHECK(statuses[i] == ROHC_STATUS_OK);
+				CHECK(decomp_views[i].size() == test_pkt_len);
+				CHECK(memcmp(decomp_views[i].data(), pkts[i].data(),
+				             test_pkt_len) == 0);
+			}
+		}
+	}
+
+	trace(verbose, "all tests are successful\n");
+
+	/* test succeeds */
+	is_failure = 0;
+
+error:
+	return is_failure;
+}
+
+
+/**
+ * @brief Generate a false random number for testing the ROHC library
+ *
+ * @param comp          The ROHC compressor
+ * @param user_context  Should always be NULL
+ * @return              Always 0
+ */
+static int random_cb(const struct rohc_comp *const comp,
+                     void *const user_context)
+{
+	(void) comp;
+	(void) user_context;
+	return 0;
+}
+
+
+/**
+ * @brief Generate one IPv4/UDP packet of the flow of the test
+ *
+ * @param ip_id  The IPv4 ID of the packet
+ * @param pkt    OUT: The generated packet
+ */
+static void gen_udp_packet(const uint16_t ip_id,
+                           std::array<uint8_t, test_pkt_len> &pkt)
+{
+	uint32_t sum = 0;
+
+	pkt.fill(0);
+
+	/* IPv4 header */
+	pkt[0] = 0x45;
+	pkt[2] = (test_pkt_len >> 8) & 0xff;
+	pkt[3] = test_pkt_len & 0xff;
+	pkt[4] = (ip_id >> 8) & 0xff;
+	pkt[5] = ip_id & 0xff;
+	pkt[8] = 64;
+	pkt[9] = 17; /* UDP */
+	pkt[12] = 192;
+	pkt[13] = 168;
+	pkt[15] = 1;
+	pkt[16] = 192;
+	pkt[17] = 168;
+	pkt[19] = 2;
+	for(std::size_t i = 0; i < 20; i += 2)
+	{
+		sum += (pkt[i] << 8) | pkt[i + 1];
+	}
+	while((sum >> 16) != 0)
+	{
+		sum = (sum & 0xffff) + (sum >> 16);
+	}
+	pkt[10] = (~sum >> 8) & 0xff;
+	pkt[11] = ~sum & 0xff;
+
+	/* UDP header without checksum */
+	pkt[20] = 0x12;
+	pkt[21] = 0x34;
+	pkt[22] = 0x56;
+	pkt[23] = 0x78;
+	pkt[24] = ((test_pkt_len - 20) >> 8) & 0xff;
+	pkt[25] = (test_pkt_len - 20) & 0xff;
+
+	/* payload */
+	for(std::size_t i = 28; i < test_pkt_len; i++)
+	{
+		pkt[i] = (ip_id + i) & 0xff;
+	}
+}
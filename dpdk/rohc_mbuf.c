@@ -0,0 +1,420 @@
+/*
+ * Copyright 2016 Didier Barvaux
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/**
+ * @file   rohc_mbuf.c
+ * @brief  Compress/decompress DPDK rte_mbufs in place
+ * @author Didier Barvaux <didier@barvaux.org>
+ */
+
+#include "rohc_mbuf.h"
+
+#include <rte_mbuf.h>
+#include <rte_prefetch.h>
+
+#include <errno.h>
+#include <string.h>
+
+
+/** The offloads that the NIC would apply on the uncompressed headers */
+#ifdef RTE_MBUF_F_TX_OFFLOAD_MASK
+#  define ROHC_MBUF_TX_OFFLOAD_MASK  RTE_MBUF_F_TX_OFFLOAD_MASK
+#else
+#  define ROHC_MBUF_TX_OFFLOAD_MASK  PKT_TX_OFFLOAD_MASK
+#endif
+
+
+static bool rohc_mbuf_is_writable(const struct rte_mbuf *const mbuf)
+	__attribute__((warn_unused_result, nonnull(1)));
+
+static void rohc_mbuf_replace_hdrs(struct rte_mbuf *const mbuf,
+                                   const uint16_t old_len,
+                                   const uint16_t new_len)
+	__attribute__((nonnull(1)));
+
+static void rohc_mbuf_swap(struct rte_mbuf **const mbufs,
+                           const uint16_t i,
+                           const uint16_t j)
+	__attribute__((nonnull(1)));
+
+
+/**
+ * @brief Whether the headers of the given rte_mbuf may be overwritten
+ *
+ * The first segment shall hold its own data and not be shared with other
+ * rte_mbufs, eg. clones.
+ *
+ * @param mbuf  The rte_mbuf
+ * @return      true if the first segment may be overwritten, false otherwise
+ */
+static bool rohc_mbuf_is_writable(const struct rte_mbuf *const mbuf)
+{
+	return (RTE_MBUF_DIRECT(mbuf) && rte_mbuf_refcnt_read(mbuf) == 1);
+}
+
+
+/**
+ * @brief Replace the first bytes of the rte_mbuf by the new headers
+ *
+ * The new headers were built at the very beginning of the headroom of the
+ * first segment, they fit in the headroom once the old bytes are removed.
+ *
+ * @param mbuf     The rte_mbuf
+ * @param old_len  The number of bytes to remove at the start of the data
+ * @param new_len  The length of the new headers at the start of the buffer
+ */
+static void rohc_mbuf_replace_hdrs(struct rte_mbuf *const mbuf,
+                                   const uint16_t old_len,
+                                   const uint16_t new_len)
+{
+	uint8_t *const buf = mbuf->buf_addr;
+
+	mbuf->data_off = mbuf->data_off + old_len - new_len;
+	mbuf->data_len = mbuf->data_len - old_len + new_len;
+	mbuf->pkt_len = mbuf->pkt_len - old_len + new_len;
+	memmove(buf + mbuf->data_off, buf, new_len);
+}
+
+
+/**
+ * @brief Swap two rte_mbufs of one burst
+ *
+ * @param mbufs  The rte_mbufs of the burst
+ * @param i      The index of the first rte_mbuf
+ * @param j      The index of the second rte_mbuf
+ */
+static void rohc_mbuf_swap(struct rte_mbuf **const mbufs,
+                           const uint16_t i,
+                           const uint16_t j)
+{
+	struct rte_mbuf *const mbuf = mbufs[i];
+
+	mbufs[i] = mbufs[j];
+	mbufs[j] = mbuf;
+}
+
+
+/**
+ * @brief Compress the packet of the given rte_mbuf in place
+ *
+ * The uncompressed headers at the start of the rte_mbuf are replaced by the
+ * ROHC header, the payload is not copied. The ROHC header is built in the
+ * headroom of the first segment, see \ref rohc_compress_inplace: if the
+ * headroom is too small for the ROHC header, the packet is compressed with
+ * the Uncompressed profile if possible.
+ *
+ * The compressor parses the whole IP packet, so multi-segment rte_mbufs are
+ * linearized first: the tailroom of the first segment shall be large enough
+ * for the other segments. The TX offloads shall not be requested, as the
+ * compressor transmits the checksums as they are.
+ *
+ * The caller is responsible for serializing the calls on the same
+ * compressor.
+ *
+ * @param comp          The ROHC compressor
+ * @param mbuf          The rte_mbuf with the IP packet to compress
+ * @param arrival_time  The time at which the packet was received
+ * @return              0 if the rte_mbuf contains the ROHC packet,
+ *                      -EINVAL if the rte_mbuf is shared or requests TX
+ *                      offloads,
+ *                      -ENOMEM if the rte_mbuf cannot be linearized,
+ *                      -EIO if the compression failed
+ *
+ * @ingroup rohc_comp
+ */
+int rohc_mbuf_compress(struct rohc_comp *const comp,
+                       struct rte_mbuf *const mbuf,
+                       const struct rohc_ts arrival_time)
+{
+	struct rohc_buf packet;
+
+	if(!rohc_mbuf_is_writable(mbuf) ||
+	   (mbuf->ol_flags & ROHC_MBUF_TX_OFFLOAD_MASK) != 0)
+	{
+		return -EINVAL;
+	}
+	if(!rte_pktmbuf_is_contiguous(mbuf) && rte_pktmbuf_linearize(mbuf) != 0)
+	{
+		return -ENOMEM;
+	}
+
+	/* the headroom of the segment is the room for the ROHC header */
+	packet.time = arrival_time;
+	packet.data = mbuf->buf_addr;
+	packet.max_len = mbuf->data_off + mbuf->data_len;
+	packet.offset = mbuf->data_off;
+	packet.len = mbuf->data_len;
+
+	if(rohc_compress_inplace(comp, &packet) != ROHC_STATUS_OK)
+	{
+		return -EIO;
+	}
+
+	mbuf->data_off = packet.offset;
+	mbuf->data_len = packet.len;
+	mbuf->pkt_len = packet.len;
+	mbuf->packet_type = RTE_PTYPE_UNKNOWN;
+
+	return 0;
+}
+
+
+/**
+ * @brief Decompress the ROHC packet of the given rte_mbuf in place
+ *
+ * The ROHC header at the start of the rte_mbuf is replaced by the
+ * uncompressed headers, the payload is not copied and may stay in the
+ * chained segments of the rte_mbuf. The ROHC header shall fit in the first
+ * segment. The uncompressed headers are built in the headroom of the first
+ * segment, that shall be large enough for them.
+ *
+ * The caller is responsible for serializing the calls on the same
+ * decompressor.
+ *
+ * @param decomp              The ROHC decompressor
+ * @param mbuf                The rte_mbuf with the ROHC packet to decompress
+ * @param arrival_time        The time at which the packet was received
+ * @param[out] rcvd_feedback  The feedback received from the remote peer,
+ *                            see \ref rohc_decompress3
+ * @param[out] feedback_send  The feedback to be transmitted to the remote
+ *                            compressor, see \ref rohc_decompress3
+ * @return                    0 if the rte_mbuf contains the IP packet,
+ *                            -ENODATA if the ROHC packet contained feedback
+ *                            only, the rte_mbuf is left unchanged,
+ *                            -EINVAL if the rte_mbuf is shared,
+ *                            -ENOSPC if the headroom is too small for the
+ *                            uncompressed headers,
+ *                            -EBADMSG if the ROHC packet is malformed or
+ *                            its CRC is wrong,
+ *                            -ENOENT if no context matches the packet,
+ *                            -EIO if the decompression failed
+ *
+ * @ingroup rohc_decomp
+ */
+int rohc_mbuf_decompress(struct rohc_decomp *const decomp,
+                         struct rte_mbuf *const mbuf,
+                         const struct rohc_ts arrival_time,
+                         struct rohc_buf *const rcvd_feedback,
+                         struct rohc_buf *const feedback_send)
+{
+	struct rohc_buf rohc_packet;
+	struct rohc_buf uncomp_hdrs;
+	struct rohc_buf payload;
+	const uint32_t payload_tail_len = mbuf->pkt_len - mbuf->data_len;
+	uint16_t consumed_len;
+	rohc_status_t status;
+
+	if(!rohc_mbuf_is_writable(mbuf))
+	{
+		return -EINVAL;
+	}
+
+	/* the chained segments are the end of the payload */
+	rohc_packet.time = arrival_time;
+	rohc_packet.data = rte_pktmbuf_mtod(mbuf, uint8_t *);
+	rohc_packet.max_len = mbuf->data_len;
+	rohc_packet.offset = 0;
+	rohc_packet.len = mbuf->data_len;
+
+	/* build the uncompressed headers in the headroom */
+	uncomp_hdrs.time = arrival_time;
+	uncomp_hdrs.data = mbuf->buf_addr;
+	uncomp_hdrs.max_len = rte_pktmbuf_headroom(mbuf);
+	uncomp_hdrs.offset = 0;
+	uncomp_hdrs.len = 0;
+
+	status = rohc_decompress_iov(decomp, rohc_packet, payload_tail_len,
+	                             &uncomp_hdrs, &payload, rcvd_feedback,
+	                             feedback_send);
+	switch(status)
+	{
+		case ROHC_STATUS_OK:
+			break;
+		case ROHC_STATUS_OUTPUT_TOO_SMALL:
+			return -ENOSPC;
+		case ROHC_STATUS_MALFORMED:
+		case ROHC_STATUS_BAD_CRC:
+			return -EBADMSG;
+		case ROHC_STATUS_NO_CONTEXT:
+			return -ENOENT;
+		default:
+			return -EIO;
+	}
+
+	/* feedback-only packet, the packets of the Uncompressed profile have no
+	 * uncompressed headers but a payload */
+	if(uncomp_hdrs.len == 0 && payload.len == 0 && payload_tail_len == 0)
+	{
+		return -ENODATA;
+	}
+
+	/* the payload is the end of the ROHC packet */
+	consumed_len = rohc_buf_data(payload) - rohc_packet.data;
+	if(consumed_len + payload.len != mbuf->data_len)
+	{
+		return -EIO;
+	}
+	rohc_mbuf_replace_hdrs(mbuf, consumed_len, uncomp_hdrs.len);
+
+	/* the rte_mbuf now contains one IPv4 or IPv6 packet */
+	mbuf->packet_type =
+		((rte_pktmbuf_mtod(mbuf, uint8_t *)[0] >> 4) == 6 ?
+		 RTE_PTYPE_L3_IPV6_EXT_UNKNOWN : RTE_PTYPE_L3_IPV4_EXT_UNKNOWN);
+
+	return 0;
+}
+
+
+/**
+ * @brief Compress a burst of rte_mbufs in place
+ *
+ * Compress every rte_mbuf of the burst as \ref rohc_mbuf_compress does, eg.
+ * right before rte_eth_tx_burst(). The data of the next rte_mbuf is
+ * prefetched while the current one is compressed.
+ *
+ * The rte_mbufs are reordered: the compressed ones are moved at the start
+ * of the array in their original order, the ones that failed to be
+ * compressed are moved after them. The failed rte_mbufs are left untouched
+ * or partially overwritten, they are still owned by the caller.
+ *
+ * @param comp          The ROHC compressor
+ * @param mbufs         The rte_mbufs with the IP packets to compress
+ * @param mbufs_nr      The number of rte_mbufs in the burst
+ * @param arrival_time  The time at which the packets were received
+ * @return              The number of compressed rte_mbufs at the start of
+ *                      the array
+ *
+ * @ingroup rohc_comp
+ */
+uint16_t rohc_mbuf_compress_burst(struct rohc_comp *const comp,
+                                  struct rte_mbuf **const mbufs,
+                                  const uint16_t mbufs_nr,
+                                  const struct rohc_ts arrival_time)
+{
+	uint16_t compressed_nr = 0;
+	uint16_t i;
+
+	for(i = 0; i < mbufs_nr; i++)
+	{
+		if((i + 1) < mbufs_nr)
+		{
+			rte_prefetch0(rte_pktmbuf_mtod(mbufs[i + 1], void *));
+		}
+		if(rohc_mbuf_compress(comp, mbufs[i], arrival_time) == 0)
+		{
+			rohc_mbuf_swap(mbufs, compressed_nr, i);
+			compressed_nr++;
+		}
+	}
+
+	return compressed_nr;
+}
+
+
+/**
+ * @brief Decompress a burst of rte_mbufs in place
+ *
+ * Decompress every rte_mbuf of the burst as \ref rohc_mbuf_decompress does,
+ * eg. right after rte_eth_rx_burst(). The data of the next rte_mbuf is
+ * prefetched while the current one is decompressed.
+ *
+ * The rte_mbufs are reordered: the ones that now contain an IP packet are
+ * moved at the start of the array in their original order, the other ones
+ * (feedback-only ROHC packets and failures) are moved after them. The other
+ * rte_mbufs are still owned by the caller, that usually frees them.
+ *
+ * The feedback received for the same-side associated compressor and the
+ * feedback to be transmitted to the remote compressor are aggregated for the
+ * whole burst, as \ref rohc_decompress_burst does.
+ *
+ * @param decomp              The ROHC decompressor
+ * @param mbufs               The rte_mbufs with the ROHC packets to
+ *                            decompress
+ * @param mbufs_nr            The number of rte_mbufs in the burst
+ * @param arrival_time        The time at which the packets were received
+ * @param[out] rcvd_feedback  The feedback received from the remote peer for
+ *                            the same-side associated ROHC compressor, may
+ *                            be NULL to ignore the received feedback data
+ * @param[out] feedback_send  The feedback to be transmitted to the remote
+ *                            compressor, may be NULL to disable the
+ *                            generation of feedback
+ * @return                    The number of rte_mbufs with an IP packet at
+ *                            the start of the array
+ *
+ * @ingroup rohc_decomp
+ */
+uint16_t rohc_mbuf_decompress_burst(struct rohc_decomp *const decomp,
+                                    struct rte_mbuf **const mbufs,
+                                    const uint16_t mbufs_nr,
+                                    const struct rohc_ts arrival_time,
+                                    struct rohc_buf *const rcvd_feedback,
+                                    struct rohc_buf *const feedback_send)
+{
+	uint16_t decompressed_nr = 0;
+	uint16_t i;
+
+	for(i = 0; i < mbufs_nr; i++)
+	{
+		struct rohc_buf rcvd_feedback_pkt;
+		struct rohc_buf feedback_send_pkt;
+		struct rohc_buf *rcvd_feedback_ptr = NULL;
+		struct rohc_buf *feedback_send_ptr = NULL;
+		int ret;
+
+		if((i + 1) < mbufs_nr)
+		{
+			rte_prefetch0(rte_pktmbuf_mtod(mbufs[i + 1], void *));
+		}
+
+		/* the feedback items of the packet are appended to the ones of the
+		 * previous packets of the burst */
+		if(rcvd_feedback != NULL)
+		{
+			rcvd_feedback_pkt = *rcvd_feedback;
+			rohc_buf_pull(&rcvd_feedback_pkt, rcvd_feedback->len);
+			rcvd_feedback_ptr = &rcvd_feedback_pkt;
+		}
+		if(feedback_send != NULL)
+		{
+			feedback_send_pkt = *feedback_send;
+			rohc_buf_pull(&feedback_send_pkt, feedback_send->len);
+			feedback_send_ptr = &feedback_send_pkt;
+		}
+
+		ret = rohc_mbuf_decompress(decomp, mbufs[i], arrival_time,
+		                           rcvd_feedback_ptr, feedback_send_ptr);
+
+		if(rcvd_feedback != NULL)
+		{
+			rcvd_feedback->len += rcvd_feedback_pkt.len;
+		}
+		if(feedback_send != NULL)
+		{
+			feedback_send->len += feedback_send_pkt.len;
+		}
+
+		if(ret == 0)
+		{
+			rohc_mbuf_swap(mbufs, decompressed_nr, i);
+			decompressed_nr++;
+		}
+	}
+
+	return decompressed_nr;
+}
+
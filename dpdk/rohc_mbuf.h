@@ -0,0 +1,94 @@
+/*
+ * Copyright 2016 Didier Barvaux
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/**
+ * @file   rohc_mbuf.h
+ * @brief  Compress/decompress DPDK rte_mbufs in place
+ * @author Didier Barvaux <didier@barvaux.org>
+ *
+ * The helpers replace the headers of the packet stored in one rte_mbuf by
+ * their compressed/decompressed version: the new headers are built in the
+ * headroom of the first segment, then moved in front of the payload. The
+ * payload is never copied, and it may stay in the chained segments of the
+ * rte_mbuf on the decompression side.
+ *
+ * The burst helpers take the arrays of rte_mbufs returned by
+ * rte_eth_rx_burst() or given to rte_eth_tx_burst() as they are.
+ */
+
+#ifndef ROHC_MBUF_H
+#define ROHC_MBUF_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <rohc/rohc.h>
+#include <rohc/rohc_buf.h>
+#include <rohc/rohc_comp.h>
+#include <rohc/rohc_decomp.h>
+
+#include <rte_mbuf.h>
+
+#include <stdint.h>
+
+
+/** Macro that handles DLL export declarations gracefully */
+#ifdef DLL_EXPORT /* passed by autotools on command line */
+#  define ROHC_EXPORT __declspec(dllexport)
+#else
+#  define ROHC_EXPORT
+#endif
+
+
+int ROHC_EXPORT rohc_mbuf_compress(struct rohc_comp *const comp,
+                                   struct rte_mbuf *const mbuf,
+                                   const struct rohc_ts arrival_time)
+	__attribute__((warn_unused_result, nonnull(1, 2)));
+
+int ROHC_EXPORT rohc_mbuf_decompress(struct rohc_decomp *const decomp,
+                                     struct rte_mbuf *const mbuf,
+                                     const struct rohc_ts arrival_time,
+                                     struct rohc_buf *const rcvd_feedback,
+                                     struct rohc_buf *const feedback_send)
+	__attribute__((warn_unused_result, nonnull(1, 2)));
+
+uint16_t ROHC_EXPORT rohc_mbuf_compress_burst(struct rohc_comp *const comp,
+                                              struct rte_mbuf **const mbufs,
+                                              const uint16_t mbufs_nr,
+                                              const struct rohc_ts arrival_time)
+	__attribute__((warn_unused_result, nonnull(1, 2)));
+
+uint16_t ROHC_EXPORT rohc_mbuf_decompress_burst(struct rohc_decomp *const decomp,
+                                                struct rte_mbuf **const mbufs,
+                                                const uint16_t mbufs_nr,
+                                                const struct rohc_ts arrival_time,
+                                                struct rohc_buf *const rcvd_feedback,
+                                                struct rohc_buf *const feedback_send)
+	__attribute__((warn_unused_result, nonnull(1, 2)));
+
+
+#undef ROHC_EXPORT /* do not pollute outside this header */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ROHC_MBUF_H */
+
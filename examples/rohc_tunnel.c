@@ -0,0 +1,1177 @@
+/*
+ * Copyright 2016 Didier Barvaux
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/**
+ * @file     rohc_tunnel.c
+ * @brief    A ROHC tunnel over UDP that batches its I/O with io_uring
+ * @author   Didier Barvaux <didier@barvaux.org>
+ *
+ * The program creates one multi-queue TUN interface, and runs one worker per
+ * CPU core. Every worker owns:
+ *  - one queue of the TUN interface,
+ *  - one UDP socket connected to the matching worker of the remote tunnel
+ *    endpoint: the worker number N uses the UDP port PORT + N on both sides,
+ *  - one ROHC compressor and one ROHC decompressor, so that the workers
+ *    never share any ROHC state,
+ *  - one io_uring.
+ *
+ * The IP packets read from the TUN queue are compressed by bursts with
+ * \ref rohc_compress_burst, then sent on the UDP socket. The ROHC packets
+ * received on the UDP socket are decompressed by bursts with
+ * \ref rohc_decompress_burst, then written on the TUN queue. The feedback
+ * received from the remote decompressor is delivered to the compressor of
+ * the worker, the feedback for the remote compressor is sent in
+ * feedback-only ROHC packets.
+ *
+ * The io_uring is used this way:
+ *  - the TUN queue is read in buffers registered with the ring: a fixed
+ *    number of reads are always in flight, one read is re-armed once the
+ *    ROHC packet built from the previous one was sent,
+ *  - the UDP socket is read with one multishot receive request that picks
+ *    its buffers in a ring of provided buffers,
+ *  - the uncompressed packets are written on the TUN queue from buffers
+ *    registered with the ring.
+ * The requests are submitted and their completions are reaped in batches:
+ * one system call per loop for all the I/O of the worker.
+ *
+ * The feedback-only ROHC packets are rare (only the O-mode requires them),
+ * they are sent with a plain non-blocking system call.
+ *
+ * The ROHC header cannot be built in the headroom of the buffers of a burst
+ * (\ref rohc_compress_inplace handles one packet at a time), so the
+ * compressed packets are built in separate buffers.
+ *
+ * The program requires liburing 2.4 or later and Linux 5.19 or later.
+ *
+ * Setup the tunnel between hosts A (192.0.2.1) and B (192.0.2.2), then
+ * route traffic through the tun0 interface on both hosts:
+ * \code
+   A# rohc_tunnel tun0 192.0.2.1 192.0.2.2 5000
+   A# ip link set tun0 up && ip addr add 10.0.0.1/24 dev tun0
+   B# rohc_tunnel tun0 192.0.2.2 192.0.2.1 5000
+   B# ip link set tun0 up && ip addr add 10.0.0.2/24 dev tun0
+   \endcode
+ */
+
+/**
+ * @example rohc_tunnel.c
+ *
+ * How to compress the IP packets of a TUN interface into a UDP tunnel, and
+ * to decompress the ROHC packets received from the tunnel, by bursts with
+ * one io_uring per CPU core.
+ */
+
+#ifndef _GNU_SOURCE
+#  define _GNU_SOURCE /* for pthread_setaffinity_np() */
+#endif
+
+/* system includes */
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <signal.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <net/if.h>
+#include <linux/if_tun.h>
+#include <liburing.h>
+
+/* includes required to use the ROHC library */
+#include <rohc/rohc.h>
+#include <rohc/rohc_comp.h>
+#include <rohc/rohc_decomp.h>
+
+
+/** The size (in bytes) of the packet buffers */
+#define TUNNEL_BUF_SIZE  2048U
+
+/** The number of TUN reads in flight, and the size of the bursts of IP
+ *  packets to compress */
+#define TUNNEL_BATCH  32U
+
+/** The number of provided buffers for the UDP receptions, and of buffers for
+ *  the uncompressed packets (shall be a power of 2) */
+#define TUNNEL_RX_BUFS  256U
+
+/** The number of entries of the submission queue of every io_uring */
+#define TUNNEL_RING_ENTRIES  512U
+
+/** The group of the provided buffers for the UDP receptions */
+#define TUNNEL_BGID  0U
+
+/** The largest CID of the ROHC compressors and decompressors */
+#define TUNNEL_MAX_CID  1023U
+
+/** The period (in ms) at which the workers check whether they shall stop */
+#define TUNNEL_STOP_PERIOD_MS  100U
+
+/** The largest number of workers */
+#define TUNNEL_WORKERS_MAX  256U
+
+
+/** The operations that the I/O requests of one worker perform */
+typedef enum
+{
+	TUNNEL_OP_TUN_READ  = 1,  /**< Read one IP packet from the TUN queue */
+	TUNNEL_OP_UDP_SEND  = 2,  /**< Send one ROHC packet on the socket */
+	TUNNEL_OP_UDP_RECV  = 3,  /**< Receive ROHC packets from the socket */
+	TUNNEL_OP_TUN_WRITE = 4,  /**< Write one IP packet on the TUN queue */
+} tunnel_op_t;
+
+
+/** The counters of one worker */
+struct tunnel_stats
+{
+	uint64_t comp_packets;      /**< The number of compressed packets */
+	uint64_t comp_failures;     /**< The number of compression failures */
+	uint64_t decomp_packets;    /**< The number of decompressed packets */
+	uint64_t decomp_failures;   /**< The number of decompression failures */
+	uint64_t decomp_drops;      /**< The packets dropped for lack of buffers */
+	uint64_t feedbacks_rcvd;    /**< The number of feedbacks received */
+	uint64_t feedbacks_sent;    /**< The number of feedbacks sent */
+};
+
+
+/** One worker of the tunnel, bound to one CPU core */
+struct tunnel_worker
+{
+	unsigned int id;              /**< The number of the worker */
+	pthread_t thread;             /**< The thread of the worker */
+	const char *tun_name;         /**< The name of the TUN interface */
+	const char *local_addr;       /**< The local address of the tunnel */
+	const char *remote_addr;      /**< The remote address of the tunnel */
+	unsigned int port;            /**< The UDP port of the first worker */
+
+	int tun_fd;                   /**< The TUN queue of the worker */
+	int sock;                     /**< The UDP socket of the worker */
+	struct io_uring ring;         /**< The io_uring of the worker */
+	struct io_uring_buf_ring *rx_ring;  /**< The ring of provided buffers */
+
+	uint8_t *tx_in;               /**< The IP packets read from TUN */
+	uint8_t *tx_out;              /**< The ROHC packets to send */
+	uint8_t *rx_in;               /**< The ROHC packets received */
+	uint8_t *rx_out;              /**< The IP packets to write on TUN */
+	unsigned int rx_out_free[TUNNEL_RX_BUFS];  /**< The free rx_out slots */
+	size_t rx_out_free_nr;        /**< The number of free rx_out slots */
+
+	struct rohc_comp *comp;       /**< The ROHC compressor of the worker */
+	struct rohc_decomp *decomp;   /**< The ROHC decompressor of the worker */
+
+	struct tunnel_stats stats;    /**< The counters of the worker */
+	bool is_failure;              /**< Whether the worker failed */
+};
+
+
+static void usage(void);
+
+static void * tunnel_worker_run(void *arg);
+static bool tunnel_worker_init(struct tunnel_worker *const worker)
+	__attribute__((warn_unused_result, nonnull(1)));
+static void tunnel_worker_release(struct tunnel_worker *const worker)
+	__attribute__((nonnull(1)));
+static bool tunnel_worker_loop(struct tunnel_worker *const worker)
+	__attribute__((warn_unused_result, nonnull(1)));
+
+static int tunnel_open_tun(const char *const name)
+	__attribute__((warn_unused_result, nonnull(1)));
+static int tunnel_open_udp(const char *const local_addr,
+                           const char *const remote_addr,
+                           const unsigned int port)
+	__attribute__((warn_unused_result, nonnull(1, 2)));
+
+static struct io_uring_sqe * tunnel_get_sqe(struct tunnel_worker *const worker)
+	__attribute__((warn_unused_result, nonnull(1)));
+static void tunnel_arm_tun_read(struct tunnel_worker *const worker,
+                                const unsigned int slot)
+	__attribute__((nonnull(1)));
+static void tunnel_arm_udp_recv(struct tunnel_worker *const worker)
+	__attribute__((nonnull(1)));
+static void tunnel_recycle_rx_buf(struct tunnel_worker *const worker,
+                                  const unsigned int bid)
+	__attribute__((nonnull(1)));
+
+static void tunnel_compress_burst(struct tunnel_worker *const worker,
+                                  const unsigned int *const slots,
+                                  const size_t *const lens,
+                                  const size_t nr)
+	__attribute__((nonnull(1, 2, 3)));
+static void tunnel_decompress_burst(struct tunnel_worker *const worker,
+                                    const unsigned int *const bids,
+                                    const size_t *const lens,
+                                    const size_t nr)
+	__attribute__((nonnull(1, 2, 3)));
+
+static struct rohc_comp * tunnel_create_compressor(void)
+	__attribute__((warn_unused_result));
+static struct rohc_decomp * tunnel_create_decompressor(void)
+	__attribute__((warn_unused_result));
+static int tunnel_gen_random_num(const struct rohc_comp *const comp,
+                                 void *const user_context)
+	__attribute__((warn_unused_result));
+static struct rohc_ts tunnel_now(void)
+	__attribute__((warn_unused_result));
+
+
+/** Whether the workers shall stop */
+static volatile sig_atomic_t tunnel_stop = 0;
+
+
+/**
+ * @brief The main entry point for the ROHC tunnel
+ *
+ * @param argc  The number of arguments given to the program
+ * @param argv  The table of arguments given to the program
+ * @return      0 in case of success, 1 otherwise
+ */
+int main(int argc, char **argv)
+{
+	struct tunnel_worker *workers;
+	long cores_nr = sysconf(_SC_NPROCESSORS_ONLN);
+	sigset_t signals;
+	int signal_nr;
+	int is_failure = 1;
+	unsigned int i;
+	int ret;
+
+	/* parse options */
+	for(argc--, argv++; argc > 0 && (*argv)[0] == '-'; argc--, argv++)
+	{
+		if(!strcmp(*argv, "-h") || !strcmp(*argv, "--help"))
+		{
+			usage();
+			goto error;
+		}
+		else if(!strcmp(*argv, "-c") || !strcmp(*argv, "--cores"))
+		{
+			if(argc <= 1)
+			{
+				usage();
+				goto error;
+			}
+			cores_nr = atol(argv[1]);
+			argc--;
+			argv++;
+		}
+		else
+		{
+			fprintf(stderr, "unknown option '%s'\n", *argv);
+			usage();
+			goto error;
+		}
+	}
+	if(argc != 4)
+	{
+		usage();
+		goto error;
+	}
+	if(cores_nr <= 0 || cores_nr > TUNNEL_WORKERS_MAX)
+	{
+		fprintf(stderr, "invalid number of cores %ld: should be in range "
+		        "[1, %u]\n", cores_nr, TUNNEL_WORKERS_MAX);
+		goto error;
+	}
+	if(atoi(argv[3]) <= 0 || (atoi(argv[3]) + cores_nr) > 65536)
+	{
+		fprintf(stderr, "invalid UDP port '%s'\n", argv[3]);
+		goto error;
+	}
+
+	workers = calloc(cores_nr, sizeof(struct tunnel_worker));
+	if(workers == NULL)
+	{
+		fprintf(stderr, "failed to allocate memory for %ld workers\n", cores_nr);
+		goto error;
+	}
+
+	/* the workers inherit the signal mask: only the main thread handles the
+	 * signals that stop the tunnel */
+	sigemptyset(&signals);
+	sigaddset(&signals, SIGINT);
+	sigaddset(&signals, SIGTERM);
+	pthread_sigmask(SIG_BLOCK, &signals, NULL);
+
+	/* start one worker per core */
+	for(i = 0; i < cores_nr; i++)
+	{
+		workers[i].id = i;
+		workers[i].tun_name = argv[0];
+		workers[i].local_addr = argv[1];
+		workers[i].remote_addr = argv[2];
+		workers[i].port = atoi(argv[3]);
+		ret = pthread_create(&workers[i].thread, NULL, tunnel_worker_run,
+		                     &workers[i]);
+		if(ret != 0)
+		{
+			fprintf(stderr, "failed to create worker #%u: %s (%d)\n", i,
+			        strerror(ret), ret);
+			tunnel_stop = 1;
+			break;
+		}
+	}
+	printf("tunnel %s: %u workers started, press Ctrl+C to stop\n", argv[0], i);
+
+	/* wait for the end of the tunnel */
+	if(i == cores_nr)
+	{
+		sigwait(&signals, &signal_nr);
+		tunnel_stop = 1;
+	}
+
+	/* wait for the workers, then print their counters */
+	is_failure = (i != cores_nr);
+	printf("worker\tcomp_packets\tcomp_failures\tdecomp_packets\t"
+	       "decomp_failures\tdecomp_drops\tfeedbacks_rcvd\tfeedbacks_sent\n");
+	while(i > 0)
+	{
+		const struct tunnel_stats *stats;
+
+		i--;
+		pthread_join(workers[i].thread, NULL);
+		stats = &workers[i].stats;
+		is_failure |= workers[i].is_failure;
+		printf("%u\t%" PRIu64 "\t%" PRIu64 "\t%" PRIu64 "\t%" PRIu64 "\t%" PRIu64
+		       "\t%" PRIu64 "\t%" PRIu64 "\n", i, stats->comp_packets,
+		       stats->comp_failures, stats->decomp_packets,
+		       stats->decomp_failures, stats->decomp_drops,
+		       stats->feedbacks_rcvd, stats->feedbacks_sent);
+	}
+
+	free(workers);
+error:
+	return is_failure;
+}
+
+
+/**
+ * @brief Print usage of the tunnel
+ */
+static void usage(void)
+{
+	printf("The ROHC tunnel over UDP with io_uring\n"
+	       "\n"
+	       "usage: rohc_tunnel [OPTIONS] TUN_NAME LOCAL_ADDR REMOTE_ADDR PORT\n"
+	       "\n"
+	       "  TUN_NAME     The name of the multi-queue TUN interface to create\n"
+	       "  LOCAL_ADDR   The local IP address of the tunnel\n"
+	       "  REMOTE_ADDR  The IP address of the remote end of the tunnel\n"
+	       "  PORT         The UDP port of the first worker, the next\n"
+	       "               workers use the next ports\n"
+	       "\n"
+	       "options:\n"
+	       "  -c, --cores NUM  The number of workers, one per core (default:\n"
+	       "                   the number of online cores)\n"
+	       "  -h, --help       Print this usage and exit\n");
+}
+
+
+/**
+ * @brief Run one worker of the tunnel
+ *
+ * @param arg  The worker
+ * @return     NULL
+ */
+static void * tunnel_worker_run(void *arg)
+{
+	struct tunnel_worker *const worker = arg;
+	cpu_set_t cpus;
+
+	/* bind the worker to its core */
+	CPU_ZERO(&cpus);
+	CPU_SET(worker->id, &cpus);
+	if(pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpus) != 0)
+	{
+		fprintf(stderr, "worker #%u: failed to bind to CPU %u\n", worker->id,
+		        worker->id);
+	}
+
+	/* the io_uring is created by the thread that submits the requests */
+	if(!tunnel_worker_init(worker))
+	{
+		worker->is_failure = true;
+		goto error;
+	}
+	if(!tunnel_worker_loop(worker))
+	{
+		worker->is_failure = true;
+	}
+	tunnel_worker_release(worker);
+
+error:
+	return NULL;
+}
+
+
+/**
+ * @brief Create the resources of one worker
+ *
+ * @param worker  The worker
+ * @return        true if the worker is ready, false otherwise
+ */
+static bool tunnel_worker_init(struct tunnel_worker *const worker)
+{
+	struct iovec iovs[TUNNEL_BATCH + TUNNEL_RX_BUFS];
+	unsigned int i;
+	int ret;
+
+	worker->tun_fd = -1;
+	worker->sock = -1;
+
+	/* the ROHC compressor and decompressor of the worker */
+	worker->comp = tunnel_create_compressor();
+	if(worker->comp == NULL)
+	{
+		fprintf(stderr, "worker #%u: failed to create the ROHC compressor\n",
+		        worker->id);
+		goto error;
+	}
+	worker->decomp = tunnel_create_decompressor();
+	if(worker->decomp == NULL)
+	{
+		fprintf(stderr, "worker #%u: failed to create the ROHC decompressor\n",
+		        worker->id);
+		goto free_comp;
+	}
+
+	/* the packet buffers */
+	worker->tx_in = malloc(TUNNEL_BATCH * TUNNEL_BUF_SIZE);
+	worker->tx_out = malloc(TUNNEL_BATCH * TUNNEL_BUF_SIZE);
+	worker->rx_in = malloc(TUNNEL_RX_BUFS * TUNNEL_BUF_SIZE);
+	worker->rx_out = malloc(TUNNEL_RX_BUFS * TUNNEL_BUF_SIZE);
+	if(worker->tx_in == NULL || worker->tx_out == NULL ||
+	   worker->rx_in == NULL || worker->rx_out == NULL)
+	{
+		fprintf(stderr, "worker #%u: failed to allocate the packet buffers\n",
+		        worker->id);
+		goto free_bufs;
+	}
+	for(i = 0; i < TUNNEL_RX_BUFS; i++)
+	{
+		worker->rx_out_free[i] = TUNNEL_RX_BUFS - 1 - i;
+	}
+	worker->rx_out_free_nr = TUNNEL_RX_BUFS;
+
+	/* the TUN queue and the UDP socket */
+	worker->tun_fd = tunnel_open_tun(worker->tun_name);
+	if(worker->tun_fd < 0)
+	{
+		goto free_bufs;
+	}
+	worker->sock = tunnel_open_udp(worker->local_addr, worker->remote_addr,
+	                               worker->port + worker->id);
+	if(worker->sock < 0)
+	{
+		goto close_tun;
+	}
+
+	/* the io_uring, with the TUN read buffers and the TUN write buffers
+	 * registered, and a ring of provided buffers for the UDP receptions */
+	ret = io_uring_queue_init(TUNNEL_RING_ENTRIES, &worker->ring, 0);
+	if(ret < 0)
+	{
+		fprintf(stderr, "worker #%u: failed to create the io_uring: %s (%d)\n",
+		        worker->id, strerror(-ret), -ret);
+		goto close_sock;
+	}
+	for(i = 0; i < TUNNEL_BATCH; i++)
+	{
+		iovs[i].iov_base = worker->tx_in + i * TUNNEL_BUF_SIZE;
+		iovs[i].iov_len = TUNNEL_BUF_SIZE;
+	}
+	for(i = 0; i < TUNNEL_RX_BUFS; i++)
+	{
+		iovs[TUNNEL_BATCH + i].iov_base = worker->rx_out + i * TUNNEL_BUF_SIZE;
+		iovs[TUNNEL_BATCH + i].iov_len = TUNNEL_BUF_SIZE;
+	}
+	ret = io_uring_register_buffers(&worker->ring, iovs,
+	                                TUNNEL_BATCH + TUNNEL_RX_BUFS);
+	if(ret < 0)
+	{
+		fprintf(stderr, "worker #%u: failed to register the buffers: %s (%d)\n",
+		        worker->id, strerror(-ret), -ret);
+		goto exit_ring;
+	}
+	worker->rx_ring = io_uring_setup_buf_ring(&worker->ring, TUNNEL_RX_BUFS,
+	                                          TUNNEL_BGID, 0, &ret);
+	if(worker->rx_ring == NULL)
+	{
+		fprintf(stderr, "worker #%u: failed to create the ring of provided "
+		        "buffers: %s (%d)\n", worker->id, strerror(-ret), -ret);
+		goto exit_ring;
+	}
+	for(i = 0; i < TUNNEL_RX_BUFS; i++)
+	{
+		io_uring_buf_ring_add(worker->rx_ring,
+		                      worker->rx_in + i * TUNNEL_BUF_SIZE,
+		                      TUNNEL_BUF_SIZE, i,
+		                      io_uring_buf_ring_mask(TUNNEL_RX_BUFS), i);
+	}
+	io_uring_buf_ring_advance(worker->rx_ring, TUNNEL_RX_BUFS);
+
+	/* arm the first requests */
+	for(i = 0; i < TUNNEL_BATCH; i++)
+	{
+		tunnel_arm_tun_read(worker, i);
+	}
+	tunnel_arm_udp_recv(worker);
+
+	return true;
+
+exit_ring:
+	io_uring_queue_exit(&worker->ring);
+close_sock:
+	close(worker->sock);
+close_tun:
+	close(worker->tun_fd);
+free_bufs:
+	free(worker->rx_out);
+	free(worker->rx_in);
+	free(worker->tx_out);
+	free(worker->tx_in);
+	rohc_decomp_free(worker->decomp);
+free_comp:
+	rohc_comp_free(worker->comp);
+error:
+	return false;
+}
+
+
+/**
+ * @brief Release the resources of one worker
+ *
+ * @param worker  The worker
+ */
+static void tunnel_worker_release(struct tunnel_worker *const worker)
+{
+	io_uring_free_buf_ring(&worker->ring, worker->rx_ring, TUNNEL_RX_BUFS,
+	                       TUNNEL_BGID);
+	io_uring_queue_exit(&worker->ring);
+	close(worker->sock);
+	close(worker->tun_fd);
+	free(worker->rx_out);
+	free(worker->rx_in);
+	free(worker->tx_out);
+	free(worker->tx_in);
+	rohc_decomp_free(worker->decomp);
+	rohc_comp_free(worker->comp);
+}
+
+
+/**
+ * @brief Handle the I/O of one worker until the tunnel stops
+ *
+ * Every loop submits the new requests, waits for at least one completion,
+ * reaps all the available completions, then compresses the IP packets read
+ * from the TUN queue and decompresses the ROHC packets received from the
+ * UDP socket by bursts.
+ *
+ * @param worker  The worker
+ * @return        true if the tunnel stopped, false if an error occurred
+ */
+static bool tunnel_worker_loop(struct tunnel_worker *const worker)
+{
+	struct __kernel_timespec timeout = {
+		.tv_sec = 0,
+		.tv_nsec = TUNNEL_STOP_PERIOD_MS * 1000000L,
+	};
+	unsigned int tx_slots[TUNNEL_BATCH];
+	size_t tx_lens[TUNNEL_BATCH];
+	unsigned int rx_bids[TUNNEL_RX_BUFS];
+	size_t rx_lens[TUNNEL_RX_BUFS];
+
+	while(!tunnel_stop)
+	{
+		struct io_uring_cqe *cqe;
+		unsigned int cqes_nr = 0;
+		unsigned int head;
+		size_t tx_nr = 0;
+		size_t rx_nr = 0;
+		int ret;
+
+		ret = io_uring_submit_and_wait_timeout(&worker->ring, &cqe, 1, &timeout,
+		                                       NULL);
+		if(ret < 0 && ret != -ETIME && ret != -EINTR)
+		{
+			fprintf(stderr, "worker #%u: failed to wait for I/O: %s (%d)\n",
+			        worker->id, strerror(-ret), -ret);
+			goto error;
+		}
+
+		io_uring_for_each_cqe(&worker->ring, head, cqe)
+		{
+			const tunnel_op_t op = io_uring_cqe_get_data64(cqe) >> 32;
+			const unsigned int slot = io_uring_cqe_get_data64(cqe) & 0xffffffff;
+
+			switch(op)
+			{
+				case TUNNEL_OP_TUN_READ:
+					if(cqe->res > 0)
+					{
+						tx_slots[tx_nr] = slot;
+						tx_lens[tx_nr] = cqe->res;
+						tx_nr++;
+					}
+					else
+					{
+						tunnel_arm_tun_read(worker, slot);
+					}
+					break;
+				case TUNNEL_OP_UDP_SEND:
+					/* the ROHC packet was sent, read the next IP packet */
+					if(cqe->res < 0)
+					{
+						worker->stats.comp_failures++;
+					}
+					tunnel_arm_tun_read(worker, slot);
+					break;
+				case TUNNEL_OP_UDP_RECV:
+					if(cqe->flags & IORING_CQE_F_BUFFER)
+					{
+						const unsigned int bid = cqe->flags >> IORING_CQE_BUFFER_SHIFT;
+
+						if(cqe->res > 0 && rx_nr < TUNNEL_RX_BUFS)
+						{
+							rx_bids[rx_nr] = bid;
+							rx_lens[rx_nr] = cqe->res;
+							rx_nr++;
+						}
+						else
+						{
+							tunnel_recycle_rx_buf(worker, bid);
+						}
+					}
+					/* the multishot receive stops when no buffer is available */
+					if(!(cqe->flags & IORING_CQE_F_MORE))
+					{
+						tunnel_arm_udp_recv(worker);
+					}
+					break;
+				case TUNNEL_OP_TUN_WRITE:
+					/* the IP packet was written, its buffer is free again */
+					worker->rx_out_free[worker->rx_out_free_nr] = slot;
+					worker->rx_out_free_nr++;
+					break;
+				default:
+					fprintf(stderr, "worker #%u: unexpected I/O completion %d\n",
+					        worker->id, op);
+					goto error;
+			}
+			cqes_nr++;
+		}
+		io_uring_cq_advance(&worker->ring, cqes_nr);
+
+		if(tx_nr > 0)
+		{
+			tunnel_compress_burst(worker, tx_slots, tx_lens, tx_nr);
+		}
+		if(rx_nr > 0)
+		{
+			tunnel_decompress_burst(worker, rx_bids, rx_lens, rx_nr);
+		}
+	}
+
+	return true;
+
+error:
+	return false;
+}
+
+
+/**
+ * @brief Open one queue of the multi-queue TUN interface
+ *
+ * The interface is created by the first worker, the other workers attach
+ * new queues to it.
+ *
+ * @param name  The name of the TUN interface
+ * @return      The file descriptor of the queue, -1 in case of error
+ */
+static int tunnel_open_tun(const char *const name)
+{
+	struct ifreq ifr;
+	int fd;
+
+	fd = open("/dev/net/tun", O_RDWR);
+	if(fd < 0)
+	{
+		fprintf(stderr, "failed to open /dev/net/tun: %s (%d)\n",
+		        strerror(errno), errno);
+		goto error;
+	}
+
+	memset(&ifr, 0, sizeof(struct ifreq));
+	ifr.ifr_flags = IFF_TUN | IFF_NO_PI | IFF_MULTI_QUEUE;
+	strncpy(ifr.ifr_name, name, IFNAMSIZ - 1);
+	if(ioctl(fd, TUNSETIFF, &ifr) < 0)
+	{
+		fprintf(stderr, "failed to attach to TUN interface %s: %s (%d)\n",
+		        name, strerror(errno), errno);
+		goto close_fd;
+	}
+
+	return fd;
+
+close_fd:
+	close(fd);
+error:
+	return -1;
+}
+
+
+/**
+ * @brief Open the UDP socket of one worker
+ *
+ * @param local_addr   The local IP address
+ * @param remote_addr  The remote IP address
+ * @param port         The UDP port of the worker, the same on both ends
+ * @return             The connected socket, -1 in case of error
+ */
+static int tunnel_open_udp(const char *const local_addr,
+                           const char *const remote_addr,
+                           const unsigned int port)
+{
+	const struct addrinfo hints = {
+		.ai_family = AF_UNSPEC,
+		.ai_socktype = SOCK_DGRAM,
+		.ai_flags = AI_NUMERICHOST | AI_NUMERICSERV,
+	};
+	struct addrinfo *local;
+	struct addrinfo *remote;
+	char port_str[6];
+	int sock = -1;
+	int ret;
+
+	snprintf(port_str, sizeof(port_str), "%u", port);
+	ret = getaddrinfo(local_addr, port_str, &hints, &local);
+	if(ret != 0)
+	{
+		fprintf(stderr, "invalid local address '%s': %s\n", local_addr,
+		        gai_strerror(ret));
+		goto error;
+	}
+	ret = getaddrinfo(remote_addr, port_str, &hints, &remote);
+	if(ret != 0)
+	{
+		fprintf(stderr, "invalid remote address '%s': %s\n", remote_addr,
+		        gai_strerror(ret));
+		goto free_local;
+	}
+	if(local->ai_family != remote->ai_family)
+	{
+		fprintf(stderr, "local and remote addresses are not of the same "
+		        "family\n");
+		goto free_remote;
+	}
+
+	sock = socket(local->ai_family, SOCK_DGRAM, 0);
+	if(sock < 0)
+	{
+		fprintf(stderr, "failed to create UDP socket: %s (%d)\n",
+		        strerror(errno), errno);
+		goto free_remote;
+	}
+	if(bind(sock, local->ai_addr, local->ai_addrlen) != 0 ||
+	   connect(sock, remote->ai_addr, remote->ai_addrlen) != 0)
+	{
+		fprintf(stderr, "failed to bind/connect UDP socket on port %u: %s "
+		        "(%d)\n", port, strerror(errno), errno);
+		close(sock);
+		sock = -1;
+	}
+
+free_remote:
+	freeaddrinfo(remote);
+free_local:
+	freeaddrinfo(local);
+error:
+	return sock;
+}
+
+
+/**
+ * @brief Get one free submission queue entry
+ *
+ * The pending requests are submitted if the submission queue is full.
+ *
+ * @param worker  The worker
+ * @return        The submission queue entry
+ */
+static struct io_uring_sqe * tunnel_get_sqe(struct tunnel_worker *const worker)
+{
+	struct io_uring_sqe *sqe;
+
+	sqe = io_uring_get_sqe(&worker->ring);
+	while(sqe == NULL)
+	{
+		io_uring_submit(&worker->ring);
+		sqe = io_uring_get_sqe(&worker->ring);
+	}
+
+	return sqe;
+}
+
+
+/**
+ * @brief Read the next IP packet from the TUN queue in the given slot
+ *
+ * @param worker  The worker
+ * @param slot    The slot of the registered buffer to read into
+ */
+static void tunnel_arm_tun_read(struct tunnel_worker *const worker,
+                                const unsigned int slot)
+{
+	struct io_uring_sqe *const sqe = tunnel_get_sqe(worker);
+
+	io_uring_prep_read_fixed(sqe, worker->tun_fd,
+	                         worker->tx_in + slot * TUNNEL_BUF_SIZE,
+	                         TUNNEL_BUF_SIZE, 0, slot);
+	io_uring_sqe_set_data64(sqe, ((uint64_t) TUNNEL_OP_TUN_READ << 32) | slot);
+}
+
+
+/**
+ * @brief Receive the next ROHC packets from the UDP socket
+ *
+ * @param worker  The worker
+ */
+static void tunnel_arm_udp_recv(struct tunnel_worker *const worker)
+{
+	struct io_uring_sqe *const sqe = tunnel_get_sqe(worker);
+
+	io_uring_prep_recv_multishot(sqe, worker->sock, NULL, 0, 0);
+	sqe->flags |= IOSQE_BUFFER_SELECT;
+	sqe->buf_group = TUNNEL_BGID;
+	io_uring_sqe_set_data64(sqe, (uint64_t) TUNNEL_OP_UDP_RECV << 32);
+}
+
+
+/**
+ * @brief Give one buffer back to the ring of provided buffers
+ *
+ * @param worker  The worker
+ * @param bid     The ID of the buffer
+ */
+static void tunnel_recycle_rx_buf(struct tunnel_worker *const worker,
+                                  const unsigned int bid)
+{
+	io_uring_buf_ring_add(worker->rx_ring, worker->rx_in + bid * TUNNEL_BUF_SIZE,
+	                      TUNNEL_BUF_SIZE, bid,
+	                      io_uring_buf_ring_mask(TUNNEL_RX_BUFS), 0);
+	io_uring_buf_ring_advance(worker->rx_ring, 1);
+}
+
+
+/**
+ * @brief Compress a burst of IP packets read from the TUN queue
+ *
+ * The ROHC packets are sent on the UDP socket, the TUN reads are re-armed
+ * once they are sent. The TUN reads of the packets that failed to be
+ * compressed are re-armed at once.
+ *
+ * @param worker  The worker
+ * @param slots   The slots of the IP packets
+ * @param lens    The lengths of the IP packets
+ * @param nr      The number of IP packets
+ */
+static void tunnel_compress_burst(struct tunnel_worker *const worker,
+                                  const unsigned int *const slots,
+                                  const size_t *const lens,
+                                  const size_t nr)
+{
+	const struct rohc_ts arrival_time = tunnel_now();
+	struct rohc_buf ip_packets[TUNNEL_BATCH];
+	struct rohc_buf rohc_packets[TUNNEL_BATCH];
+	rohc_status_t statuses[TUNNEL_BATCH];
+	size_t handled_nr;
+	size_t i;
+
+	for(i = 0; i < nr; i++)
+	{
+		ip_packets[i] = (struct rohc_buf)
+			rohc_buf_init_full(worker->tx_in + slots[i] * TUNNEL_BUF_SIZE,
+			                   lens[i], arrival_time);
+		rohc_packets[i] = (struct rohc_buf)
+			rohc_buf_init_empty(worker->tx_out + slots[i] * TUNNEL_BUF_SIZE,
+			                    TUNNEL_BUF_SIZE);
+	}
+
+	/* the burst stops early only if one packet requires ROHC segmentation,
+	 * that the tunnel does not enable */
+	handled_nr = rohc_compress_burst(worker->comp, ip_packets, rohc_packets, nr,
+	                                 statuses);
+
+	for(i = 0; i < nr; i++)
+	{
+		if(i < handled_nr && statuses[i] == ROHC_STATUS_OK)
+		{
+			struct io_uring_sqe *const sqe = tunnel_get_sqe(worker);
+
+			io_uring_prep_send(sqe, worker->sock, rohc_buf_data(rohc_packets[i]),
+			                   rohc_packets[i].len, 0);
+			io_uring_sqe_set_data64(sqe, ((uint64_t) TUNNEL_OP_UDP_SEND << 32) |
+			                        slots[i]);
+			worker->stats.comp_packets++;
+		}
+		else
+		{
+			worker->stats.comp_failures++;
+			tunnel_arm_tun_read(worker, slots[i]);
+		}
+	}
+}
+
+
+/**
+ * @brief Decompress a burst of ROHC packets received from the UDP socket
+ *
+ * The IP packets are written on the TUN queue. The received buffers are
+ * given back to the ring of provided buffers at once. The feedback received
+ * from the remote decompressor is delivered to the compressor of the worker,
+ * the feedback for the remote compressor is sent at once.
+ *
+ * @param worker  The worker
+ * @param bids    The IDs of the buffers of the ROHC packets
+ * @param lens    The lengths of the ROHC packets
+ * @param nr      The number of ROHC packets
+ */
+static void tunnel_decompress_burst(struct tunnel_worker *const worker,
+                                    const unsigned int *const bids,
+                                    const size_t *const lens,
+                                    const size_t nr)
+{
+	const struct rohc_ts arrival_time = tunnel_now();
+	struct rohc_buf rohc_packets[TUNNEL_BATCH];
+	struct rohc_buf ip_packets[TUNNEL_BATCH];
+	rohc_status_t statuses[TUNNEL_BATCH];
+	unsigned int in_bids[TUNNEL_BATCH];
+	unsigned int out_slots[TUNNEL_BATCH];
+	uint8_t rcvd_feedback_buf[TUNNEL_BUF_SIZE];
+	uint8_t feedback_send_buf[TUNNEL_BUF_SIZE];
+	size_t first;
+
+	for(first = 0; first < nr; first += TUNNEL_BATCH)
+	{
+		struct rohc_buf rcvd_feedback =
+			rohc_buf_init_empty(rcvd_feedback_buf, TUNNEL_BUF_SIZE);
+		struct rohc_buf feedback_send =
+			rohc_buf_init_empty(feedback_send_buf, TUNNEL_BUF_SIZE);
+		size_t burst_nr = 0;
+		size_t i;
+
+		/* one free buffer is required for every uncompressed packet */
+		for(i = first; i < nr && i < (first + TUNNEL_BATCH); i++)
+		{
+			if(worker->rx_out_free_nr == 0)
+			{
+				worker->stats.decomp_drops++;
+				tunnel_recycle_rx_buf(worker, bids[i]);
+				continue;
+			}
+			worker->rx_out_free_nr--;
+			in_bids[burst_nr] = bids[i];
+			out_slots[burst_nr] = worker->rx_out_free[worker->rx_out_free_nr];
+			rohc_packets[burst_nr] = (struct rohc_buf)
+				rohc_buf_init_full(worker->rx_in + bids[i] * TUNNEL_BUF_SIZE,
+				                   lens[i], arrival_time);
+			ip_packets[burst_nr] = (struct rohc_buf)
+				rohc_buf_init_empty(worker->rx_out +
+				                    out_slots[burst_nr] * TUNNEL_BUF_SIZE,
+				                    TUNNEL_BUF_SIZE);
+			burst_nr++;
+		}
+		if(burst_nr == 0)
+		{
+			continue;
+		}
+
+		if(rohc_decompress_burst(worker->decomp, rohc_packets, ip_packets,
+		                         burst_nr, &rcvd_feedback, &feedback_send,
+		                         statuses) != burst_nr)
+		{
+			for(i = 0; i < burst_nr; i++)
+			{
+				statuses[i] = ROHC_STATUS_ERROR;
+			}
+		}
+
+		/* the ROHC packets were copied, give their buffers back */
+		for(i = 0; i < burst_nr; i++)
+		{
+			tunnel_recycle_rx_buf(worker, in_bids[i]);
+		}
+
+		/* write the IP packets on the TUN queue */
+		for(i = 0; i < burst_nr; i++)
+		{
+			if(statuses[i] == ROHC_STATUS_OK && ip_packets[i].len > 0)
+			{
+				struct io_uring_sqe *const sqe = tunnel_get_sqe(worker);
+
+				io_uring_prep_write_fixed(sqe, worker->tun_fd,
+				                          rohc_buf_data(ip_packets[i]),
+				                          ip_packets[i].len, 0,
+				                          TUNNEL_BATCH + out_slots[i]);
+				io_uring_sqe_set_data64(sqe,
+				                        ((uint64_t) TUNNEL_OP_TUN_WRITE << 32) |
+				                        out_slots[i]);
+				worker->stats.decomp_packets++;
+			}
+			else
+			{
+				if(statuses[i] != ROHC_STATUS_OK)
+				{
+					worker->stats.decomp_failures++;
+				}
+				worker->rx_out_free[worker->rx_out_free_nr] = out_slots[i];
+				worker->rx_out_free_nr++;
+			}
+		}
+
+		/* the feedback for the local compressor */
+		if(rcvd_feedback.len > 0)
+		{
+			worker->stats.feedbacks_rcvd++;
+			if(!rohc_comp_deliver_feedback2(worker->comp, rcvd_feedback))
+			{
+				fprintf(stderr, "worker #%u: failed to deliver feedback to the "
+				        "compressor\n", worker->id);
+			}
+		}
+
+		/* the feedback for the remote compressor, in a feedback-only packet */
+		if(feedback_send.len > 0)
+		{
+			if(send(worker->sock, rohc_buf_data(feedback_send), feedback_send.len,
+			        MSG_DONTWAIT) == (ssize_t) feedback_send.len)
+			{
+				worker->stats.feedbacks_sent++;
+			}
+		}
+	}
+}
+
+
+/**
+ * @brief Create the ROHC compressor of one worker
+ *
+ * @return  The ROHC compressor, NULL in case of error
+ */
+static struct rohc_comp * tunnel_create_compressor(void)
+{
+	struct rohc_comp *comp;
+
+	comp = rohc_comp_new2(ROHC_LARGE_CID, TUNNEL_MAX_CID,
+	                      tunnel_gen_random_num, NULL);
+	if(comp == NULL)
+	{
+		goto error;
+	}
+	if(!rohc_comp_enable_profiles(comp, ROHC_PROFILE_UNCOMPRESSED,
+	                              ROHC_PROFILE_RTP, ROHC_PROFILE_UDP,
+	                              ROHC_PROFILE_ESP, ROHC_PROFILE_IP,
+	                              ROHC_PROFILE_UDPLITE, ROHC_PROFILE_TCP, -1))
+	{
+		goto free_comp;
+	}
+
+	return comp;
+
+free_comp:
+	rohc_comp_free(comp);
+error:
+	return NULL;
+}
+
+
+/**
+ * @brief Create the ROHC decompressor of one worker
+ *
+ * The decompressor works in O-mode, so that the remote compressor benefits
+ * from the feedback channel of the tunnel.
+ *
+ * @return  The ROHC decompressor, NULL in case of error
+ */
+static struct rohc_decomp * tunnel_create_decompressor(void)
+{
+	struct rohc_decomp *decomp;
+
+	decomp = rohc_decomp_new2(ROHC_LARGE_CID, TUNNEL_MAX_CID, ROHC_O_MODE);
+	if(decomp == NULL)
+	{
+		goto error;
+	}
+	if(!rohc_decomp_enable_profiles(decomp, ROHC_PROFILE_UNCOMPRESSED,
+	                                ROHC_PROFILE_RTP, ROHC_PROFILE_UDP,
+	                                ROHC_PROFILE_ESP, ROHC_PROFILE_IP,
+	                                ROHC_PROFILE_UDPLITE, ROHC_PROFILE_TCP, -1))
+	{
+		goto free_decomp;
+	}
+
+	return decomp;
+
+free_decomp:
+	rohc_decomp_free(decomp);
+error:
+	return NULL;
+}
+
+
+/**
+ * @brief Generate a random number for the ROHC compressors
+ *
+ * @param comp          The ROHC compressor
+ * @param user_context  Should always be NULL
+ * @return              A random number
+ */
+static int tunnel_gen_random_num(const struct rohc_comp *const comp,
+                                 void *const user_context)
+{
+	return rand();
+}
+
+
+/**
+ * @brief Get the current time for the ROHC library
+ *
+ * @return  The current monotonic time
+ */
+static struct rohc_ts tunnel_now(void)
+{
+	struct rohc_ts now = { .sec = 0, .nsec = 0 };
+	struct timespec ts;
+
+	if(clock_gettime(CLOCK_MONOTONIC, &ts) == 0)
+	{
+		now.sec = ts.tv_sec;
+		now.nsec = ts.tv_nsec;
+	}
+
+	return now;
+}
+
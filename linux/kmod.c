@@ -52,6 +52,10 @@ EXPORT_SYMBOL_GPL(rohc_get_profile_descr);
 EXPORT_SYMBOL_GPL(rohc_get_packet_descr);
 EXPORT_SYMBOL_GPL(rohc_get_ext_descr);
 EXPORT_SYMBOL_GPL(rohc_get_packet_type);
+EXPORT_SYMBOL_GPL(rohc_set_allocator);
+EXPORT_SYMBOL_GPL(rohc_cpu_get_features);
+EXPORT_SYMBOL_GPL(rohc_cpu_set_features);
+EXPORT_SYMBOL_GPL(rohc_cpu_get_variant);
 
 EXPORT_SYMBOL_GPL(rohc_buf_is_malformed);
 EXPORT_SYMBOL_GPL(rohc_buf_is_empty);
@@ -72,20 +76,44 @@ EXPORT_SYMBOL_GPL(rohc_buf_reset);
 
 /* general */
 EXPORT_SYMBOL_GPL(rohc_comp_new2);
+EXPORT_SYMBOL_GPL(rohc_comp_new3);
 EXPORT_SYMBOL_GPL(rohc_comp_free);
 EXPORT_SYMBOL_GPL(rohc_compress4);
+EXPORT_SYMBOL_GPL(rohc_compress_iov);
+EXPORT_SYMBOL_GPL(rohc_compress_inplace);
+EXPORT_SYMBOL_GPL(rohc_compress_with_ctxt);
+EXPORT_SYMBOL_GPL(rohc_compress_gso);
+EXPORT_SYMBOL_GPL(rohc_compress_burst);
+EXPORT_SYMBOL_GPL(rohc_compress_burst2);
+EXPORT_SYMBOL_GPL(rohc_compress_burst_arena);
 EXPORT_SYMBOL_GPL(rohc_comp_force_contexts_reinit);
+EXPORT_SYMBOL_GPL(rohc_comp_force_contexts_reinit_paced);
 
 /* segment */
 EXPORT_SYMBOL_GPL(rohc_comp_get_segment2);
+EXPORT_SYMBOL_GPL(rohc_comp_get_segments);
+EXPORT_SYMBOL_GPL(rohc_comp_segment_iov);
 
 /* feedback */
 EXPORT_SYMBOL_GPL(rohc_comp_deliver_feedback2);
+EXPORT_SYMBOL_GPL(rohc_comp_deliver_feedback_burst);
+EXPORT_SYMBOL_GPL(rohc_comp_enqueue_feedback);
+EXPORT_SYMBOL_GPL(rohc_comp_export_contexts);
+EXPORT_SYMBOL_GPL(rohc_comp_import_contexts);
+EXPORT_SYMBOL_GPL(rohc_comp_export_changes);
+EXPORT_SYMBOL_GPL(rohc_comp_import_changes);
+EXPORT_SYMBOL_GPL(rohc_comp_migrate_context);
+EXPORT_SYMBOL_GPL(rohc_comp_prewarm_context);
 
 /* statistics */
 EXPORT_SYMBOL_GPL(rohc_comp_get_state_descr);
 EXPORT_SYMBOL_GPL(rohc_comp_get_general_info);
+EXPORT_SYMBOL_GPL(rohc_comp_get_last_ctxt_handle);
 EXPORT_SYMBOL_GPL(rohc_comp_get_last_packet_info2);
+EXPORT_SYMBOL_GPL(rohc_comp_get_ctxts_stats);
+EXPORT_SYMBOL_GPL(rohc_comp_get_timings);
+EXPORT_SYMBOL_GPL(rohc_comp_get_profile_timings);
+EXPORT_SYMBOL_GPL(rohc_comp_get_pkt_log);
 
 /* configuration */
 EXPORT_SYMBOL_GPL(rohc_comp_profile_enabled);
@@ -96,14 +124,67 @@ EXPORT_SYMBOL_GPL(rohc_comp_disable_profiles);
 EXPORT_SYMBOL_GPL(rohc_comp_set_mrru);
 EXPORT_SYMBOL_GPL(rohc_comp_get_mrru);
 EXPORT_SYMBOL_GPL(rohc_comp_get_max_cid);
+EXPORT_SYMBOL_GPL(rohc_comp_set_cid_range);
 EXPORT_SYMBOL_GPL(rohc_comp_get_cid_type);
 EXPORT_SYMBOL_GPL(rohc_comp_set_wlsb_window_width);
+EXPORT_SYMBOL_GPL(rohc_comp_set_reorder_ratio);
 EXPORT_SYMBOL_GPL(rohc_comp_set_periodic_refreshes);
+EXPORT_SYMBOL_GPL(rohc_comp_set_periodic_refreshes_time);
+EXPORT_SYMBOL_GPL(rohc_comp_set_periodic_refreshes_rate);
+EXPORT_SYMBOL_GPL(rohc_comp_set_ctxts_recycling);
+EXPORT_SYMBOL_GPL(rohc_comp_set_admission);
+EXPORT_SYMBOL_GPL(rohc_comp_set_pkt_log);
+EXPORT_SYMBOL_GPL(rohc_comp_set_memory_budget);
+EXPORT_SYMBOL_GPL(rohc_comp_set_huge_pages);
+EXPORT_SYMBOL_GPL(rohc_comp_reserve_contexts);
 EXPORT_SYMBOL_GPL(rohc_comp_set_traces_cb2);
+EXPORT_SYMBOL_GPL(rohc_comp_set_trace_level);
+EXPORT_SYMBOL_GPL(rohc_comp_set_trace_sampling);
+EXPORT_SYMBOL_GPL(rohc_comp_set_trace_cids);
 EXPORT_SYMBOL_GPL(rohc_comp_set_features);
+EXPORT_SYMBOL_GPL(rohc_comp_maintenance);
 
 /* RTP-specific configuration */
 EXPORT_SYMBOL_GPL(rohc_comp_set_rtp_detection_cb);
+EXPORT_SYMBOL_GPL(rohc_comp_add_rtp_port);
+EXPORT_SYMBOL_GPL(rohc_comp_remove_rtp_port);
+EXPORT_SYMBOL_GPL(rohc_comp_reset_rtp_ports);
+EXPORT_SYMBOL_GPL(rohc_comp_set_rtp_payload_type);
+EXPORT_SYMBOL_GPL(rohc_comp_set_event_cb);
+
+/* groups of compressors */
+EXPORT_SYMBOL_GPL(rohc_comp_group_new);
+EXPORT_SYMBOL_GPL(rohc_comp_group_free);
+EXPORT_SYMBOL_GPL(rohc_comp_group_get_shard);
+EXPORT_SYMBOL_GPL(rohc_comp_group_enqueue);
+EXPORT_SYMBOL_GPL(rohc_comp_group_dequeue);
+EXPORT_SYMBOL_GPL(rohc_comp_group_deliver_feedback);
+
+/* pipelines of compression stages */
+EXPORT_SYMBOL_GPL(rohc_comp_pipeline_new);
+EXPORT_SYMBOL_GPL(rohc_comp_pipeline_free);
+EXPORT_SYMBOL_GPL(rohc_comp_pipeline_parse);
+EXPORT_SYMBOL_GPL(rohc_comp_pipeline_encode);
+EXPORT_SYMBOL_GPL(rohc_comp_pipeline_output);
+
+EXPORT_SYMBOL_GPL(rohc_couple_new);
+EXPORT_SYMBOL_GPL(rohc_couple_free);
+EXPORT_SYMBOL_GPL(rohc_couple_compress);
+EXPORT_SYMBOL_GPL(rohc_couple_decompress);
+EXPORT_SYMBOL_GPL(rohc_couple_flush_feedback);
+
+EXPORT_SYMBOL_GPL(rohc_channels_new);
+EXPORT_SYMBOL_GPL(rohc_channels_free);
+EXPORT_SYMBOL_GPL(rohc_channels_add);
+EXPORT_SYMBOL_GPL(rohc_channels_remove);
+EXPORT_SYMBOL_GPL(rohc_channels_notify);
+EXPORT_SYMBOL_GPL(rohc_channels_next);
+EXPORT_SYMBOL_GPL(rohc_channels_done);
+EXPORT_SYMBOL_GPL(rohc_channels_exec_new);
+EXPORT_SYMBOL_GPL(rohc_channels_exec_free);
+EXPORT_SYMBOL_GPL(rohc_channels_exec_submit);
+EXPORT_SYMBOL_GPL(rohc_channels_exec_run);
+EXPORT_SYMBOL_GPL(rohc_channels_exec_collect);
 
 
 /*
@@ -112,14 +193,28 @@ EXPORT_SYMBOL_GPL(rohc_comp_set_rtp_detection_cb);
 
 /* general */
 EXPORT_SYMBOL_GPL(rohc_decomp_new2);
+EXPORT_SYMBOL_GPL(rohc_decomp_new3);
 EXPORT_SYMBOL_GPL(rohc_decomp_free);
 EXPORT_SYMBOL_GPL(rohc_decompress3);
+EXPORT_SYMBOL_GPL(rohc_decompress_burst);
+EXPORT_SYMBOL_GPL(rohc_decompress_gro);
+EXPORT_SYMBOL_GPL(rohc_decompress_segments);
+EXPORT_SYMBOL_GPL(rohc_decompress_iov);
+EXPORT_SYMBOL_GPL(rohc_decompress_fb_views);
+EXPORT_SYMBOL_GPL(rohc_decomp_parse_feedback_only);
+EXPORT_SYMBOL_GPL(rohc_decomp_prewarm_context);
+EXPORT_SYMBOL_GPL(rohc_decomp_demux);
+EXPORT_SYMBOL_GPL(rohc_decomp_demux_burst);
 
 /* statistics */
 EXPORT_SYMBOL_GPL(rohc_decomp_get_state_descr);
 EXPORT_SYMBOL_GPL(rohc_decomp_get_general_info);
 EXPORT_SYMBOL_GPL(rohc_decomp_get_context_info);
 EXPORT_SYMBOL_GPL(rohc_decomp_get_last_packet_info);
+EXPORT_SYMBOL_GPL(rohc_decomp_get_ctxts_stats);
+EXPORT_SYMBOL_GPL(rohc_decomp_get_timings);
+EXPORT_SYMBOL_GPL(rohc_decomp_get_profile_timings);
+EXPORT_SYMBOL_GPL(rohc_decomp_get_pkt_log);
 
 /* configuration */
 EXPORT_SYMBOL_GPL(rohc_decomp_profile_enabled);
@@ -135,6 +230,37 @@ EXPORT_SYMBOL_GPL(rohc_decomp_set_rate_limits);
 EXPORT_SYMBOL_GPL(rohc_decomp_get_rate_limits);
 EXPORT_SYMBOL_GPL(rohc_decomp_set_prtt);
 EXPORT_SYMBOL_GPL(rohc_decomp_get_prtt);
+EXPORT_SYMBOL_GPL(rohc_decomp_set_memory_budget);
+EXPORT_SYMBOL_GPL(rohc_decomp_set_huge_pages);
+EXPORT_SYMBOL_GPL(rohc_decomp_reserve_contexts);
+EXPORT_SYMBOL_GPL(rohc_decomp_set_dense_contexts);
+EXPORT_SYMBOL_GPL(rohc_decomp_set_ctxts_idle_timeout);
+EXPORT_SYMBOL_GPL(rohc_decomp_reclaim_idle_contexts);
+EXPORT_SYMBOL_GPL(rohc_decomp_maintenance);
+EXPORT_SYMBOL_GPL(rohc_decomp_set_crc_repair_budget);
+EXPORT_SYMBOL_GPL(rohc_decomp_get_crc_repair_budget);
+EXPORT_SYMBOL_GPL(rohc_decomp_set_reorder_window);
+EXPORT_SYMBOL_GPL(rohc_decomp_get_reorder_window);
+EXPORT_SYMBOL_GPL(rohc_decomp_set_mode_policy);
+EXPORT_SYMBOL_GPL(rohc_decomp_get_mode_policy);
+EXPORT_SYMBOL_GPL(rohc_decomp_set_feedback_coalescing);
+EXPORT_SYMBOL_GPL(rohc_decomp_get_feedback_coalescing);
+EXPORT_SYMBOL_GPL(rohc_decomp_flush_feedbacks);
+EXPORT_SYMBOL_GPL(rohc_decomp_set_feedback_ring);
 EXPORT_SYMBOL_GPL(rohc_decomp_set_traces_cb2);
+EXPORT_SYMBOL_GPL(rohc_decomp_set_trace_level);
+EXPORT_SYMBOL_GPL(rohc_decomp_set_trace_sampling);
+EXPORT_SYMBOL_GPL(rohc_decomp_set_trace_cids);
 EXPORT_SYMBOL_GPL(rohc_decomp_set_features);
+EXPORT_SYMBOL_GPL(rohc_decomp_set_event_cb);
+EXPORT_SYMBOL_GPL(rohc_decomp_set_pkt_log);
+
+/* groups of decompressors */
+EXPORT_SYMBOL_GPL(rohc_decomp_group_new);
+EXPORT_SYMBOL_GPL(rohc_decomp_group_free);
+EXPORT_SYMBOL_GPL(rohc_decomp_group_get_shard);
+EXPORT_SYMBOL_GPL(rohc_decomp_group_enqueue);
+EXPORT_SYMBOL_GPL(rohc_decomp_group_decompress);
+EXPORT_SYMBOL_GPL(rohc_decomp_group_output);
+EXPORT_SYMBOL_GPL(rohc_decomp_group_get_general_info);
 
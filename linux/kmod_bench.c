@@ -0,0 +1,962 @@
+/*
+ * Copyright 2016 Didier Barvaux
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/**
+ * @file   kmod_bench.c
+ * @brief  A module for the Linux kernel to measure the ROHC throughput
+ * @author Didier Barvaux <didier@barvaux.org>
+ *
+ * The module compresses then decompresses a set of IP packets in a tight
+ * loop on one or more CPUs, and reports the time spent per packet. The
+ * results may be compared with the ones of the rohc_test_performance tool
+ * for the same packets in userspace.
+ *
+ * The module is driven through the files of the rohc_bench/ directory of
+ * debugfs:
+ *  \li packets: every write() appends one IP packet to the set, opening the
+ *      file with O_TRUNC empties the set first
+ *  \li packets_nr: the number of packets in the set (read-only)
+ *  \li iterations: how many times every CPU (de)compresses the whole set
+ *  \li cpus: the number of CPUs to run the benchmark on
+ *  \li run: any write() runs the benchmark, it returns once it is over
+ *  \li results: the results of the last benchmark
+ *
+ * The set initially holds \ref ROHC_BENCH_DEFAULT_PKTS_NR packets of an
+ * IPv4/UDP/RTP flow with the addresses, ports and RTP fields of the one
+ * generated by rohc_gen_stream.
+ *
+ * Example:
+ *   # cd /sys/kernel/debug/rohc_bench/
+ *   # echo 10000 > iterations
+ *   # echo 4 > cpus
+ *   # echo 1 > run
+ *   # cat results
+ *
+ * Every line of the results starts with the BENCH keyword followed by
+ * tab-separated fields. The first line names the fields. One line is
+ * printed for every CPU, and a last line for all CPUs together:
+ *  \li the CPU the benchmark ran on, or 'all'
+ *  \li the number of packets compressed then decompressed
+ *  \li the number of compression failures
+ *  \li the number of decompression failures
+ *  \li the average compression time (nanoseconds per packet)
+ *  \li the average decompression time (nanoseconds per packet)
+ */
+
+#include <linux/module.h>
+#include <linux/slab.h>
+#include <linux/vmalloc.h>
+#include <linux/uaccess.h>
+#include <linux/debugfs.h>
+#include <linux/seq_file.h>
+#include <linux/mutex.h>
+#include <linux/kthread.h>
+#include <linux/completion.h>
+#include <linux/cpumask.h>
+#include <linux/timekeeping.h>
+#include <linux/math64.h>
+#include <linux/ip.h>
+#include <linux/udp.h>
+#include <net/checksum.h>
+
+#include "config.h"
+#include "rohc.h"
+#include "rohc_comp.h"
+#include "rohc_decomp.h"
+
+
+/** The max number of packets in the set */
+#define ROHC_BENCH_PKTS_MAX  4096U
+
+/** The max length of one IP packet of the set */
+#define ROHC_BENCH_PKT_MAX_LEN  65535U
+
+/** The room for the ROHC header bigger than the uncompressed headers */
+#define ROHC_BENCH_ROHC_OVERHEAD  512U
+
+/** The max number of CPUs the benchmark may run on */
+#define ROHC_BENCH_CPUS_MAX  64U
+
+/** The number of packets in the default set */
+#define ROHC_BENCH_DEFAULT_PKTS_NR  100U
+
+/** The UDP port of the RTP flow of the default set */
+#define ROHC_BENCH_RTP_PORT  1234U
+
+/** The length of the RTP payload of the default set */
+#define ROHC_BENCH_RTP_PAYLOAD_LEN  20U
+
+
+/** Custom pr_info() macro for the module */
+#define rohc_info(format, ...) \
+	pr_info("[%s] " format, THIS_MODULE->name, ##__VA_ARGS__)
+
+/** Custom pr_err() macro for the module */
+#define rohc_err(format, ...) \
+	pr_err("[%s] " format, THIS_MODULE->name, ##__VA_ARGS__)
+
+
+/** One IP packet of the set */
+struct rohc_bench_pkt
+{
+	size_t len;          /**< The length of the IP packet */
+	size_t rohc_offset;  /**< Where its ROHC packet starts in the ROHC buffer */
+	u8 data[];           /**< The IP packet */
+};
+
+
+/** The results of the benchmark on one CPU */
+struct rohc_bench_result
+{
+	unsigned int cpu;             /**< The CPU the benchmark ran on */
+	u64 packets;                  /**< The number of (de)compressed packets */
+	u64 comp_ns;                  /**< The time spent compressing (in ns) */
+	u64 decomp_ns;                /**< The time spent decompressing (in ns) */
+	unsigned long comp_errors;    /**< The number of compression failures */
+	unsigned long decomp_errors;  /**< The number of decompression failures */
+};
+
+
+/** The benchmark thread of one CPU */
+struct rohc_bench_thread
+{
+	struct task_struct *task;         /**< The kernel thread */
+	struct completion done;           /**< Completed once the thread is over */
+	size_t rohc_len;                  /**< The length of the ROHC buffer */
+	u8 *rohc_pkts;                    /**< The ROHC packets of the set */
+	size_t *rohc_lens;                /**< Their lengths, 0 if not compressed */
+	u8 *ip_pkt;                       /**< The decompressed IP packet */
+	int ret;                          /**< 0 if the benchmark ran */
+	struct rohc_bench_result result;  /**< The results of the benchmark */
+};
+
+
+/** The state of the module */
+static struct
+{
+	struct mutex lock;      /**< Protects the packets, the parameters and the
+	                             results */
+	struct dentry *dir;     /**< The directory in debugfs */
+	struct rohc_bench_pkt *pkts[ROHC_BENCH_PKTS_MAX]; /**< The packet set */
+	u32 pkts_nr;            /**< The number of packets in the set */
+	u32 iterations;         /**< How many times the set is (de)compressed */
+	u32 cpus_nr;            /**< The number of CPUs to run on */
+	struct rohc_bench_result results[ROHC_BENCH_CPUS_MAX]; /**< The results */
+	unsigned int results_nr;  /**< The number of results */
+} rohc_bench;
+
+
+static int rohc_bench_run(void);
+static int rohc_bench_thread_run(void *const arg)
+	__attribute__((nonnull(1)));
+static int rohc_bench_thread_init(struct rohc_comp **const comp,
+                                  struct rohc_decomp **const decomp)
+	__attribute__((warn_unused_result, nonnull(1, 2)));
+static void rohc_bench_thread_wait_stop(void);
+
+static bool rohc_bench_add_rtp_packet(const unsigned int counter)
+	__attribute__((warn_unused_result));
+static void rohc_bench_free_pkts(void);
+
+static int gen_false_random_num(const struct rohc_comp *const comp,
+                                void *const user_context)
+	__attribute__((nonnull(1)));
+static bool rohc_bench_rtp_cb(const unsigned char *const ip,
+                              const unsigned char *const udp,
+                              const unsigned char *const payload,
+                              const unsigned int payload_size,
+                              void *const rtp_private)
+	__attribute__((warn_unused_result));
+
+static void rohc_bench_print_ns(struct seq_file *const s, const u64 ns,
+                                const u64 packets)
+	__attribute__((nonnull(1)));
+
+
+/**
+ * @brief Run the benchmark on the configured number of CPUs
+ *
+ * One kernel thread is bound to each of the first online CPUs. All the
+ * threads are created before any of them is started, so that they run at
+ * the same time. The caller shall hold the lock of the module.
+ *
+ * @return  0 if the benchmark ran, a negative error code otherwise
+ */
+static int rohc_bench_run(void)
+{
+	struct rohc_bench_thread *threads;
+	unsigned int threads_nr = 0;
+	size_t rohc_len = 0;
+	unsigned int cpu;
+	unsigned int i;
+	int ret;
+
+	if(rohc_bench.pkts_nr == 0 || rohc_bench.iterations == 0 ||
+	   rohc_bench.cpus_nr == 0)
+	{
+		return -EINVAL;
+	}
+	if(rohc_bench.cpus_nr > min(num_online_cpus(), ROHC_BENCH_CPUS_MAX))
+	{
+		return -ERANGE;
+	}
+
+	/* every packet gets its own ROHC buffer, so that the ROHC packets of one
+	 * pass may be decompressed after the whole set was compressed */
+	for(i = 0; i < rohc_bench.pkts_nr; i++)
+	{
+		rohc_bench.pkts[i]->rohc_offset = rohc_len;
+		rohc_len += rohc_bench.pkts[i]->len + ROHC_BENCH_ROHC_OVERHEAD;
+	}
+
+	threads = kcalloc(rohc_bench.cpus_nr, sizeof(struct rohc_bench_thread),
+	                  GFP_KERNEL);
+	if(threads == NULL)
+	{
+		return -ENOMEM;
+	}
+
+	for_each_online_cpu(cpu)
+	{
+		struct rohc_bench_thread *thread;
+
+		if(threads_nr >= rohc_bench.cpus_nr)
+		{
+			break;
+		}
+		thread = &threads[threads_nr];
+
+		init_completion(&thread->done);
+		thread->result.cpu = cpu;
+		thread->rohc_len = rohc_len;
+		thread->rohc_pkts = vmalloc_node(rohc_len, cpu_to_node(cpu));
+		thread->rohc_lens = kcalloc_node(rohc_bench.pkts_nr, sizeof(size_t),
+		                                 GFP_KERNEL, cpu_to_node(cpu));
+		thread->ip_pkt = vmalloc_node(ROHC_BENCH_PKT_MAX_LEN +
+		                              ROHC_BENCH_ROHC_OVERHEAD,
+		                              cpu_to_node(cpu));
+		if(thread->rohc_pkts == NULL || thread->rohc_lens == NULL ||
+		   thread->ip_pkt == NULL)
+		{
+			ret = -ENOMEM;
+			goto free_threads;
+		}
+
+		thread->task = kthread_create_on_node(rohc_bench_thread_run, thread,
+		                                      cpu_to_node(cpu),
+		                                      "rohc_bench/%u", cpu);
+		if(IS_ERR(thread->task))
+		{
+			ret = PTR_ERR(thread->task);
+			thread->task = NULL;
+			goto free_threads;
+		}
+		kthread_bind(thread->task, cpu);
+		threads_nr++;
+	}
+	if(threads_nr != rohc_bench.cpus_nr)
+	{
+		/* a CPU went offline in the meantime */
+		ret = -ERANGE;
+		goto free_threads;
+	}
+
+	rohc_info("run %u iterations of %u packets on %u CPUs\n",
+	          rohc_bench.iterations, rohc_bench.pkts_nr, threads_nr);
+
+	/* start all the threads, then wait for all of them */
+	for(i = 0; i < threads_nr; i++)
+	{
+		wake_up_process(threads[i].task);
+	}
+	ret = 0;
+	for(i = 0; i < threads_nr; i++)
+	{
+		wait_for_completion(&threads[i].done);
+		if(threads[i].ret != 0)
+		{
+			ret = threads[i].ret;
+		}
+	}
+
+	if(ret == 0)
+	{
+		for(i = 0; i < threads_nr; i++)
+		{
+			rohc_bench.results[i] = threads[i].result;
+		}
+		rohc_bench.results_nr = threads_nr;
+	}
+
+free_threads:
+	/* the threads that were never woken up stop without running */
+	for(i = 0; i < rohc_bench.cpus_nr; i++)
+	{
+		if(threads[i].task != NULL)
+		{
+			kthread_stop(threads[i].task);
+		}
+		vfree(threads[i].ip_pkt);
+		kfree(threads[i].rohc_lens);
+		vfree(threads[i].rohc_pkts);
+	}
+	kfree(threads);
+	return ret;
+}
+
+
+/**
+ * @brief The benchmark thread of one CPU
+ *
+ * The thread creates its own compressor and decompressor, then compresses
+ * the whole set and decompresses the resulting ROHC packets as many times as
+ * requested. The compression and decompression passes are timed separately.
+ *
+ * @param arg  The benchmark thread
+ * @return     Always 0
+ */
+static int rohc_bench_thread_run(void *const arg)
+{
+	struct rohc_bench_thread *const thread = arg;
+	struct rohc_bench_result *const result = &thread->result;
+	const struct rohc_ts arrival_time = { .sec = 0, .nsec = 0 };
+	struct rohc_decomp *decomp;
+	struct rohc_comp *comp;
+	u32 iter;
+	u32 i;
+
+	thread->ret = rohc_bench_thread_init(&comp, &decomp);
+	if(thread->ret != 0)
+	{
+		goto complete;
+	}
+
+	for(iter = 0; iter < rohc_bench.iterations; iter++)
+	{
+		u64 start;
+		u64 middle;
+		u64 end;
+
+		/* compress the whole set */
+		start = ktime_get_ns();
+		for(i = 0; i < rohc_bench.pkts_nr; i++)
+		{
+			struct rohc_bench_pkt *const pkt = rohc_bench.pkts[i];
+			const struct rohc_buf ip_packet =
+				rohc_buf_init_full(pkt->data, pkt->len, arrival_time);
+			struct rohc_buf rohc_packet =
+				rohc_buf_init_empty(thread->rohc_pkts + pkt->rohc_offset,
+				                    pkt->len + ROHC_BENCH_ROHC_OVERHEAD);
+
+			if(rohc_compress4(comp, ip_packet, &rohc_packet) != ROHC_STATUS_OK)
+			{
+				result->comp_errors++;
+				thread->rohc_lens[i] = 0;
+			}
+			else
+			{
+				thread->rohc_lens[i] = rohc_packet.len;
+			}
+		}
+		middle = ktime_get_ns();
+
+		/* decompress the ROHC packets of the whole set */
+		for(i = 0; i < rohc_bench.pkts_nr; i++)
+		{
+			const struct rohc_buf rohc_packet =
+				rohc_buf_init_full(thread->rohc_pkts +
+				                   rohc_bench.pkts[i]->rohc_offset,
+				                   thread->rohc_lens[i], arrival_time);
+			struct rohc_buf ip_packet =
+				rohc_buf_init_empty(thread->ip_pkt, ROHC_BENCH_PKT_MAX_LEN +
+				                    ROHC_BENCH_ROHC_OVERHEAD);
+
+			if(thread->rohc_lens[i] == 0)
+			{
+				continue;
+			}
+			if(rohc_decompress3(decomp, rohc_packet, &ip_packet,
+			                    NULL, NULL) != ROHC_STATUS_OK)
+			{
+				result->decomp_errors++;
+			}
+		}
+		end = ktime_get_ns();
+
+		result->comp_ns += middle - start;
+		result->decomp_ns += end - middle;
+		result->packets += rohc_bench.pkts_nr;
+
+		/* the benchmark may last long, let the other tasks of the CPU run */
+		cond_resched();
+	}
+
+	rohc_decomp_free(decomp);
+	rohc_comp_free(comp);
+
+complete:
+	complete(&thread->done);
+	rohc_bench_thread_wait_stop();
+	return 0;
+}
+
+
+/**
+ * @brief Create the compressor and the decompressor of one benchmark thread
+ *
+ * The instances are configured as the ones of rohc_test_performance: small
+ * CIDs, all the profiles and the RTP ports of the library tests.
+ *
+ * @param[out] comp    The created compressor
+ * @param[out] decomp  The created decompressor
+ * @return             0 if the instances were created, -ENOMEM otherwise
+ */
+static int rohc_bench_thread_init(struct rohc_comp **const comp,
+                                  struct rohc_decomp **const decomp)
+{
+	*comp = rohc_comp_new2(ROHC_SMALL_CID, ROHC_SMALL_CID_MAX,
+	                       gen_false_random_num, NULL);
+	if((*comp) == NULL)
+	{
+		rohc_err("failed to create the ROHC compressor\n");
+		goto error;
+	}
+	if(!rohc_comp_enable_profiles(*comp, ROHC_PROFILE_UNCOMPRESSED,
+	                              ROHC_PROFILE_RTP, ROHC_PROFILE_UDP,
+	                              ROHC_PROFILE_ESP, ROHC_PROFILE_IP,
+	                              ROHC_PROFILE_TCP, ROHC_PROFILE_UDPLITE, -1))
+	{
+		rohc_err("failed to enable the compression profiles\n");
+		goto free_comp;
+	}
+	if(!rohc_comp_set_rtp_detection_cb(*comp, rohc_bench_rtp_cb, NULL))
+	{
+		rohc_err("failed to set the RTP detection callback\n");
+		goto free_comp;
+	}
+
+	*decomp = rohc_decomp_new2(ROHC_SMALL_CID, ROHC_SMALL_CID_MAX, ROHC_U_MODE);
+	if((*decomp) == NULL)
+	{
+		rohc_err("failed to create the ROHC decompressor\n");
+		goto free_comp;
+	}
+	if(!rohc_decomp_enable_profiles(*decomp, ROHC_PROFILE_UNCOMPRESSED,
+	                                ROHC_PROFILE_RTP, ROHC_PROFILE_UDP,
+	                                ROHC_PROFILE_ESP, ROHC_PROFILE_IP,
+	                                ROHC_PROFILE_TCP, ROHC_PROFILE_UDPLITE, -1))
+	{
+		rohc_err("failed to enable the decompression profiles\n");
+		goto free_decomp;
+	}
+
+	return 0;
+
+free_decomp:
+	rohc_decomp_free(*decomp);
+free_comp:
+	rohc_comp_free(*comp);
+error:
+	return -ENOMEM;
+}
+
+
+/**
+ * @brief Wait for the benchmark runner to stop the current thread
+ *
+ * The thread shall not exit by itself: the runner frees it with
+ * kthread_stop() once all the threads completed.
+ */
+static void rohc_bench_thread_wait_stop(void)
+{
+	set_current_state(TASK_INTERRUPTIBLE);
+	while(!kthread_should_stop())
+	{
+		schedule();
+		set_current_state(TASK_INTERRUPTIBLE);
+	}
+	__set_current_state(TASK_RUNNING);
+}
+
+
+/**
+ * @brief Append one packet of the default RTP flow to the set
+ *
+ * The IPv4/UDP/RTP packet uses the fields of the RTP stream of
+ * rohc_gen_stream: speex payload type, 20 bytes of payload, 160 timestamp
+ * units between packets and no UDP checksum.
+ *
+ * @param counter  The index of the packet in the flow, starting at 1
+ * @return         true if the packet was added, false otherwise
+ */
+static bool rohc_bench_add_rtp_packet(const unsigned int counter)
+{
+	const size_t rtp_hdr_len = 12;
+	const size_t len = sizeof(struct iphdr) + sizeof(struct udphdr) +
+	                   rtp_hdr_len + ROHC_BENCH_RTP_PAYLOAD_LEN;
+	struct rohc_bench_pkt *pkt;
+	struct udphdr *udp;
+	struct iphdr *ip;
+	__be16 rtp_sn;
+	__be32 rtp_ts;
+	__be32 rtp_ssrc;
+	u8 *rtp;
+	size_t i;
+
+	if(rohc_bench.pkts_nr >= ROHC_BENCH_PKTS_MAX)
+	{
+		goto error;
+	}
+	pkt = kzalloc(sizeof(struct rohc_bench_pkt) + len, GFP_KERNEL);
+	if(pkt == NULL)
+	{
+		goto error;
+	}
+	pkt->len = len;
+
+	/* IPv4 header */
+	ip = (struct iphdr *) pkt->data;
+	ip->version = 4;
+	ip->ihl = 5;
+	ip->tos = 0;
+	ip->tot_len = htons(len);
+	ip->id = htons(42 + counter);
+	ip->frag_off = 0;
+	ip->ttl = 64;
+	ip->protocol = IPPROTO_UDP;
+	ip->saddr = htonl(0xc0a80001);
+	ip->daddr = htonl(0xc0a80002);
+	ip->check = 0;
+	ip->check = ip_fast_csum((u8 *) ip, ip->ihl);
+
+	/* UDP header, checksum disabled */
+	udp = (struct udphdr *) (pkt->data + sizeof(struct iphdr));
+	udp->source = htons(ROHC_BENCH_RTP_PORT);
+	udp->dest = htons(ROHC_BENCH_RTP_PORT);
+	udp->len = htons(len - sizeof(struct iphdr));
+	udp->check = 0;
+
+	/* RTP header: version 2, speex payload type */
+	rtp = pkt->data + sizeof(struct iphdr) + sizeof(struct udphdr);
+	rtp[0] = 0x80;
+	rtp[1] = 0x72;
+	rtp_sn = htons(counter);
+	memcpy(rtp + 2, &rtp_sn, sizeof(__be16));
+	rtp_ts = htonl(500000 + counter * 160);
+	memcpy(rtp + 4, &rtp_ts, sizeof(__be32));
+	rtp_ssrc = htonl(0x42424242);
+	memcpy(rtp + 8, &rtp_ssrc, sizeof(__be32));
+
+	/* RTP payload */
+	for(i = 0; i < ROHC_BENCH_RTP_PAYLOAD_LEN; i++)
+	{
+		rtp[rtp_hdr_len + i] = i % 0xff;
+	}
+
+	rohc_bench.pkts[rohc_bench.pkts_nr] = pkt;
+	rohc_bench.pkts_nr++;
+
+	return true;
+
+error:
+	return false;
+}
+
+
+/**
+ * @brief Empty the packet set
+ */
+static void rohc_bench_free_pkts(void)
+{
+	u32 i;
+
+	for(i = 0; i < rohc_bench.pkts_nr; i++)
+	{
+		kfree(rohc_bench.pkts[i]);
+		rohc_bench.pkts[i] = NULL;
+	}
+	rohc_bench.pkts_nr = 0;
+}
+
+
+/**
+ * @brief Generate a false random number for testing the ROHC library
+ *
+ * @param comp          The ROHC compressor
+ * @param user_context  Should always be NULL
+ * @return              Always 0
+ */
+static int gen_false_random_num(const struct rohc_comp *const comp
+                                	__attribute__((unused)),
+                                void *const user_context
+                                	__attribute__((unused)))
+{
+	return 0;
+}
+
+
+/**
+ * @brief The RTP detection callback
+ *
+ * The UDP ports are the ones of the kmod_test module and of the library
+ * tests.
+ *
+ * @param ip            The innermost IP packet
+ * @param udp           The UDP header of the packet
+ * @param payload       The UDP payload of the packet
+ * @param payload_size  The size of the UDP payload (in bytes)
+ * @param rtp_private   An optional private context, may be NULL
+ * @return              true if the packet is an RTP packet, false otherwise
+ */
+static bool rohc_bench_rtp_cb(const unsigned char *const ip
+                              	__attribute__((unused)),
+                              const unsigned char *const udp,
+                              const unsigned char *const payload
+                              	__attribute__((unused)),
+                              const unsigned int payload_size
+                              	__attribute__((unused)),
+                              void *const rtp_private __attribute__((unused)))
+{
+	const u16 rtp_ports[] = { 1234, 36780, 33238, 5020, 5002, 5006 };
+	__be16 udp_dport;
+	size_t i;
+
+	if(udp == NULL)
+	{
+		return false;
+	}
+	memcpy(&udp_dport, udp + 2, sizeof(__be16));
+
+	for(i = 0; i < ARRAY_SIZE(rtp_ports); i++)
+	{
+		if(ntohs(udp_dport) == rtp_ports[i])
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+
+/*
+ * The debugfs files
+ */
+
+
+/**
+ * @brief Open the packets file, empty the set if O_TRUNC is given
+ *
+ * @param inode  The inode of the file
+ * @param file   The opened file
+ * @return       0 if the file was opened, a negative error code otherwise
+ */
+static int rohc_bench_packets_open(struct inode *const inode,
+                                   struct file *const file)
+{
+	if((file->f_mode & FMODE_WRITE) && (file->f_flags & O_TRUNC))
+	{
+		if(mutex_lock_interruptible(&rohc_bench.lock) != 0)
+		{
+			return -ERESTARTSYS;
+		}
+		rohc_bench_free_pkts();
+		mutex_unlock(&rohc_bench.lock);
+	}
+	return nonseekable_open(inode, file);
+}
+
+
+/**
+ * @brief Append the written IP packet to the set
+ *
+ * @param file   The packets file
+ * @param buf    The IP packet
+ * @param len    The length of the IP packet
+ * @param ppos   The position in the file, unused
+ * @return       The length of the IP packet if it was added,
+ *               a negative error code otherwise
+ */
+static ssize_t rohc_bench_packets_write(struct file *const file,
+                                        const char __user *const buf,
+                                        const size_t len,
+                                        loff_t *const ppos)
+{
+	struct rohc_bench_pkt *pkt;
+	ssize_t ret;
+
+	if(len == 0 || len > ROHC_BENCH_PKT_MAX_LEN)
+	{
+		return -EINVAL;
+	}
+
+	pkt = kmalloc(sizeof(struct rohc_bench_pkt) + len, GFP_KERNEL);
+	if(pkt == NULL)
+	{
+		return -ENOMEM;
+	}
+	pkt->len = len;
+	pkt->rohc_offset = 0;
+	if(copy_from_user(pkt->data, buf, len) != 0)
+	{
+		ret = -EFAULT;
+		goto free_pkt;
+	}
+
+	if(mutex_lock_interruptible(&rohc_bench.lock) != 0)
+	{
+		ret = -ERESTARTSYS;
+		goto free_pkt;
+	}
+	if(rohc_bench.pkts_nr >= ROHC_BENCH_PKTS_MAX)
+	{
+		mutex_unlock(&rohc_bench.lock);
+		ret = -ENOSPC;
+		goto free_pkt;
+	}
+	rohc_bench.pkts[rohc_bench.pkts_nr] = pkt;
+	rohc_bench.pkts_nr++;
+	mutex_unlock(&rohc_bench.lock);
+
+	return len;
+
+free_pkt:
+	kfree(pkt);
+	return ret;
+}
+
+
+/** The operations of the packets file */
+static const struct file_operations rohc_bench_packets_fops = {
+	.owner = THIS_MODULE,
+	.open = rohc_bench_packets_open,
+	.write = rohc_bench_packets_write,
+};
+
+
+/**
+ * @brief Run the benchmark when the run file is written
+ *
+ * @param file   The run file
+ * @param buf    The written data, ignored
+ * @param len    The length of the written data
+ * @param ppos   The position in the file, unused
+ * @return       The length of the written data if the benchmark ran,
+ *               a negative error code otherwise
+ */
+static ssize_t rohc_bench_run_write(struct file *const file,
+                                    const char __user *const buf,
+                                    const size_t len,
+                                    loff_t *const ppos)
+{
+	int ret;
+
+	if(mutex_lock_interruptible(&rohc_bench.lock) != 0)
+	{
+		return -ERESTARTSYS;
+	}
+	ret = rohc_bench_run();
+	mutex_unlock(&rohc_bench.lock);
+
+	return (ret != 0 ? ret : (ssize_t) len);
+}
+
+
+/** The operations of the run file */
+static const struct file_operations rohc_bench_run_fops = {
+	.owner = THIS_MODULE,
+	.open = nonseekable_open,
+	.write = rohc_bench_run_write,
+};
+
+
+/**
+ * @brief Print the results of the last benchmark
+ *
+ * @param s       The results file
+ * @param unused  Unused
+ * @return        0 if the results were printed, a negative error code
+ *                otherwise
+ */
+static int rohc_bench_results_show(struct seq_file *const s,
+                                   void *const unused)
+{
+	struct rohc_bench_result all = { .packets = 0 };
+	unsigned int i;
+
+	if(mutex_lock_interruptible(&rohc_bench.lock) != 0)
+	{
+		return -ERESTARTSYS;
+	}
+
+	seq_puts(s, "BENCH\tcpu\tpackets\tcomp_errors\tdecomp_errors\t"
+	         "comp_ns_per_pkt\tdecomp_ns_per_pkt\n");
+	for(i = 0; i < rohc_bench.results_nr; i++)
+	{
+		const struct rohc_bench_result *const result = &rohc_bench.results[i];
+
+		seq_printf(s, "BENCH\t%u\t%llu\t%lu\t%lu\t", result->cpu,
+		           result->packets, result->comp_errors, result->decomp_errors);
+		rohc_bench_print_ns(s, result->comp_ns, result->packets);
+		seq_putc(s, '\t');
+		rohc_bench_print_ns(s, result->decomp_ns, result->packets);
+		seq_putc(s, '\n');
+
+		all.packets += result->packets;
+		all.comp_ns += result->comp_ns;
+		all.decomp_ns += result->decomp_ns;
+		all.comp_errors += result->comp_errors;
+		all.decomp_errors += result->decomp_errors;
+	}
+	if(rohc_bench.results_nr > 0)
+	{
+		seq_printf(s, "BENCH\tall\t%llu\t%lu\t%lu\t", all.packets,
+		           all.comp_errors, all.decomp_errors);
+		rohc_bench_print_ns(s, all.comp_ns, all.packets);
+		seq_putc(s, '\t');
+		rohc_bench_print_ns(s, all.decomp_ns, all.packets);
+		seq_putc(s, '\n');
+	}
+
+	mutex_unlock(&rohc_bench.lock);
+	return 0;
+}
+
+
+/**
+ * @brief Print a time per packet in nanoseconds with 3 decimals
+ *
+ * @param s        The results file
+ * @param ns       The total time (in nanoseconds)
+ * @param packets  The number of packets
+ */
+static void rohc_bench_print_ns(struct seq_file *const s, const u64 ns,
+                                const u64 packets)
+{
+	u64 milli_ns = 0;
+	u32 decimals;
+
+	if(packets > 0)
+	{
+		milli_ns = div64_u64(ns * 1000, packets);
+	}
+	milli_ns = div_u64_rem(milli_ns, 1000, &decimals);
+	seq_printf(s, "%llu.%03u", milli_ns, decimals);
+}
+
+
+/**
+ * @brief Open the results file
+ *
+ * @param inode  The inode of the file
+ * @param file   The opened file
+ * @return       0 if the file was opened, a negative error code otherwise
+ */
+static int rohc_bench_results_open(struct inode *const inode,
+                                   struct file *const file)
+{
+	return single_open(file, rohc_bench_results_show, NULL);
+}
+
+
+/** The operations of the results file */
+static const struct file_operations rohc_bench_results_fops = {
+	.owner = THIS_MODULE,
+	.open = rohc_bench_results_open,
+	.read = seq_read,
+	.llseek = seq_lseek,
+	.release = single_release,
+};
+
+
+/**
+ * @brief The entry point of the kernel module
+ *
+ * @return  0 if the module was loaded, a negative error code otherwise
+ */
+static int __init rohc_bench_init(void)
+{
+	unsigned int i;
+	int ret;
+
+	mutex_init(&rohc_bench.lock);
+	rohc_bench.pkts_nr = 0;
+	rohc_bench.iterations = 1000;
+	rohc_bench.cpus_nr = 1;
+	rohc_bench.results_nr = 0;
+
+	/* the default packet set */
+	for(i = 1; i <= ROHC_BENCH_DEFAULT_PKTS_NR; i++)
+	{
+		if(!rohc_bench_add_rtp_packet(i))
+		{
+			ret = -ENOMEM;
+			goto free_pkts;
+		}
+	}
+
+	rohc_bench.dir = debugfs_create_dir("rohc_bench", NULL);
+	if(IS_ERR_OR_NULL(rohc_bench.dir))
+	{
+		rohc_err("failed to create the rohc_bench directory in debugfs\n");
+		ret = -ENODEV;
+		goto free_pkts;
+	}
+	debugfs_create_file("packets", 0200, rohc_bench.dir, NULL,
+	                    &rohc_bench_packets_fops);
+	debugfs_create_u32("packets_nr", 0400, rohc_bench.dir,
+	                   &rohc_bench.pkts_nr);
+	debugfs_create_u32("iterations", 0600, rohc_bench.dir,
+	                   &rohc_bench.iterations);
+	debugfs_create_u32("cpus", 0600, rohc_bench.dir, &rohc_bench.cpus_nr);
+	debugfs_create_file("run", 0200, rohc_bench.dir, NULL,
+	                    &rohc_bench_run_fops);
+	debugfs_create_file("results", 0400, rohc_bench.dir, NULL,
+	                    &rohc_bench_results_fops);
+
+	rohc_info("ROHC benchmark module loaded, %u packets in the default set\n",
+	          rohc_bench.pkts_nr);
+
+	return 0;
+
+free_pkts:
+	rohc_bench_free_pkts();
+	return ret;
+}
+
+
+/**
+ * @brief The exit point of the kernel module
+ */
+static void __exit rohc_bench_exit(void)
+{
+	/* no benchmark may run once the files are removed */
+	debugfs_remove_recursive(rohc_bench.dir);
+	rohc_bench_free_pkts();
+	rohc_info("ROHC benchmark module unloaded\n");
+}
+
+
+MODULE_VERSION(PACKAGE_VERSION PACKAGE_REVNO);
+MODULE_LICENSE("GPL");
+MODULE_AUTHOR("Didier Barvaux");
+MODULE_DESCRIPTION("Module for measuring the throughput of " PACKAGE_NAME " "
+	PACKAGE_VERSION PACKAGE_REVNO " (" PACKAGE_URL ")");
+
+module_init(rohc_bench_init);
+module_exit(rohc_bench_exit);
@@ -0,0 +1,188 @@
+/*
+ * Copyright 2016 Didier Barvaux
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/**
+ * @file   kmod_ctxt_pool.c
+ * @brief  Preallocated memory pool for the contexts in the Linux kernel
+ * @author Didier Barvaux <didier@barvaux.org>
+ *
+ * The memory blocks of the compression and decompression contexts are
+ * allocated when the contexts are created, that is on the datapath, often
+ * in softirq context. A mempool of blocks preallocated at module load serves
+ * them, so that context creation does not depend on GFP_ATOMIC allocations
+ * that may fail under memory pressure.
+ *
+ * The pool is sized by the ctxt_pool_blocks and ctxt_block_size module
+ * parameters. Blocks larger than ctxt_block_size, and all the blocks when
+ * the pool is disabled, are allocated with kmalloc().
+ */
+
+#include <linux/module.h>
+#include <linux/moduleparam.h>
+#include <linux/mempool.h>
+#include <linux/vmalloc.h>
+#include <linux/slab.h>
+#include <linux/gfp.h>
+
+#include "rohc_ctxt_pool.h"
+
+
+/** The number of context blocks preallocated at module load, 0 disables
+ *  the pool */
+static unsigned int ctxt_pool_blocks = 0;
+module_param(ctxt_pool_blocks, uint, 0444);
+MODULE_PARM_DESC(ctxt_pool_blocks,
+                 "Number of context memory blocks preallocated at module load "
+                 "(0 to allocate context memory on demand)");
+
+/** The size (in bytes) of one preallocated context block */
+static unsigned int ctxt_block_size = 256 * 1024;
+module_param(ctxt_block_size, uint, 0444);
+MODULE_PARM_DESC(ctxt_block_size,
+                 "Size in bytes of one preallocated context memory block");
+
+
+/** The pool of preallocated context blocks, NULL if disabled */
+static mempool_t *rohc_ctxt_mempool = NULL;
+
+
+/**
+ * @brief Allocate one element of the mempool
+ *
+ * The blocks are too large for kmalloc(), they are allocated with vmalloc()
+ * at module load. Once the pool is created, the mempool refills itself with
+ * the freed blocks only: no block is allocated in atomic context.
+ *
+ * @param gfp_mask  The allocation flags
+ * @param pool_data The size of one block
+ * @return          The new block, NULL if the allocation shall not sleep
+ */
+static void * rohc_ctxt_mempool_alloc(gfp_t gfp_mask, void *pool_data)
+{
+	const size_t size = (size_t) pool_data;
+
+	if(!gfpflags_allow_blocking(gfp_mask))
+	{
+		return NULL;
+	}
+
+	return vmalloc(size);
+}
+
+
+/**
+ * @brief Free one element of the mempool
+ *
+ * @param element   The block to free
+ * @param pool_data The size of one block
+ */
+static void rohc_ctxt_mempool_free(void *element, void *pool_data)
+{
+	vfree(element);
+}
+
+
+/**
+ * @brief Allocate one context block on demand
+ *
+ * Called by the ROHC library when a context is created, possibly in
+ * softirq context.
+ *
+ * @param size  The size of the block
+ * @return      The block, NULL if the pool is exhausted or in case of
+ *              memory allocation failure
+ */
+void * rohc_ctxt_block_alloc(const size_t size)
+{
+	if(rohc_ctxt_mempool != NULL && size <= ctxt_block_size)
+	{
+		return mempool_alloc(rohc_ctxt_mempool, GFP_ATOMIC);
+	}
+
+	return kmalloc(size, GFP_ATOMIC);
+}
+
+
+/**
+ * @brief Free one context block
+ *
+ * @param block  The block got from \ref rohc_ctxt_block_alloc
+ * @param size   The size of the block
+ */
+void rohc_ctxt_block_free(void *const block, const size_t size)
+{
+	if(rohc_ctxt_mempool != NULL && size <= ctxt_block_size)
+	{
+		mempool_free(block, rohc_ctxt_mempool);
+	}
+	else
+	{
+		kfree(block);
+	}
+}
+
+
+/**
+ * @brief Preallocate the pool of context blocks at module load
+ *
+ * @return  0 if the pool was created or is disabled,
+ *          -ENOMEM if the blocks cannot be allocated
+ */
+static int __init rohc_ctxt_pool_init_module(void)
+{
+	if(ctxt_pool_blocks == 0 || ctxt_block_size == 0)
+	{
+		return 0;
+	}
+
+	rohc_ctxt_mempool = mempool_create(ctxt_pool_blocks,
+	                                   rohc_ctxt_mempool_alloc,
+	                                   rohc_ctxt_mempool_free,
+	                                   (void *) (size_t) ctxt_block_size);
+	if(rohc_ctxt_mempool == NULL)
+	{
+		pr_err("rohc: failed to preallocate %u context blocks of %u bytes\n",
+		       ctxt_pool_blocks, ctxt_block_size);
+		return -ENOMEM;
+	}
+	pr_info("rohc: %u context blocks of %u bytes preallocated\n",
+	        ctxt_pool_blocks, ctxt_block_size);
+
+	return 0;
+}
+
+
+/**
+ * @brief Release the pool of context blocks at module unload
+ *
+ * All the compressors and decompressors were destroyed by the modules that
+ * use the ROHC module, so all the blocks are back in the pool.
+ */
+static void __exit rohc_ctxt_pool_exit_module(void)
+{
+	if(rohc_ctxt_mempool != NULL)
+	{
+		mempool_destroy(rohc_ctxt_mempool);
+		rohc_ctxt_mempool = NULL;
+	}
+}
+
+
+module_init(rohc_ctxt_pool_init_module);
+module_exit(rohc_ctxt_pool_exit_module);
+
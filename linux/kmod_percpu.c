@@ -0,0 +1,542 @@
+/*
+ * Copyright 2016 Didier Barvaux
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/**
+ * @file   kmod_percpu.c
+ * @brief  Groups of ROHC compressors/decompressors for the Linux kernel
+ * @author Didier Barvaux <didier@barvaux.org>
+ */
+
+#include <linux/module.h>
+#include <linux/slab.h>
+#include <linux/spinlock.h>
+#include <linux/cache.h>
+#include <linux/cpumask.h>
+
+#include "rohc_percpu.h"
+
+
+/** The max number of instances in one group */
+#define ROHC_PERCPU_INSTANCES_MAX  4096U
+
+
+/** One compressor of a group and its lock */
+struct rohc_percpu_comp_slot
+{
+	spinlock_t lock;         /**< The lock that protects the compressor */
+	struct rohc_comp *comp;  /**< The compressor */
+} ____cacheline_aligned_in_smp;
+
+
+/** A group of ROHC compressors */
+struct rohc_percpu_comp
+{
+	unsigned int instances_nr;  /**< The number of compressors */
+	struct rohc_percpu_comp_slot slots[]; /**< The compressors */
+};
+
+
+/** One decompressor of a group and its lock */
+struct rohc_percpu_decomp_slot
+{
+	spinlock_t lock;             /**< The lock that protects the decompressor */
+	struct rohc_decomp *decomp;  /**< The decompressor */
+} ____cacheline_aligned_in_smp;
+
+
+/** A group of ROHC decompressors */
+struct rohc_percpu_decomp
+{
+	unsigned int instances_nr;  /**< The number of decompressors */
+	struct rohc_percpu_decomp_slot slots[]; /**< The decompressors */
+};
+
+
+static unsigned int rohc_percpu_get_instances_nr(const unsigned int instances_nr)
+	__attribute__((warn_unused_result));
+static unsigned int rohc_percpu_scale(const u32 flow_hash,
+                                      const unsigned int instances_nr)
+	__attribute__((warn_unused_result));
+
+
+/*
+ * Groups of compressors
+ */
+
+
+/**
+ * @brief Create a group of ROHC compressors
+ *
+ * All the compressors of the group are created with the same parameters.
+ * They may be configured one by one with \ref rohc_percpu_comp_get before
+ * the group is used on the datapath.
+ *
+ * Shall be called from process context.
+ *
+ * @param instances_nr  The number of compressors in the group, 0 for one
+ *                      compressor per possible CPU
+ * @param cid_type      The type of CID of every compressor
+ * @param max_cid       The max CID of every compressor
+ * @param rand_cb       The random callback of every compressor
+ * @param rand_priv     The private context of the random callback
+ * @return              The new group of compressors if successful,
+ *                      NULL in case of failure
+ */
+struct rohc_percpu_comp * rohc_percpu_comp_new(const unsigned int instances_nr,
+                                               const rohc_cid_type_t cid_type,
+                                               const rohc_cid_t max_cid,
+                                               const rohc_comp_random_cb_t rand_cb,
+                                               void *const rand_priv)
+{
+	const unsigned int nr = rohc_percpu_get_instances_nr(instances_nr);
+	struct rohc_percpu_comp *comps;
+	unsigned int i;
+
+	if(nr == 0)
+	{
+		goto error;
+	}
+
+	comps = kzalloc(sizeof(struct rohc_percpu_comp) +
+	                nr * sizeof(struct rohc_percpu_comp_slot), GFP_KERNEL);
+	if(comps == NULL)
+	{
+		goto error;
+	}
+	comps->instances_nr = nr;
+
+	for(i = 0; i < nr; i++)
+	{
+		spin_lock_init(&comps->slots[i].lock);
+		comps->slots[i].comp = rohc_comp_new2(cid_type, max_cid, rand_cb, rand_priv);
+		if(comps->slots[i].comp == NULL)
+		{
+			goto free_comps;
+		}
+	}
+
+	return comps;
+
+free_comps:
+	rohc_percpu_comp_free(comps);
+error:
+	return NULL;
+}
+
+
+/**
+ * @brief Destroy a group of ROHC compressors
+ *
+ * Shall be called from process context, once the datapath does not use
+ * the group anymore.
+ *
+ * @param comps  The group of compressors to destroy, may be NULL
+ */
+void rohc_percpu_comp_free(struct rohc_percpu_comp *const comps)
+{
+	unsigned int i;
+
+	if(comps == NULL)
+	{
+		return;
+	}
+
+	for(i = 0; i < comps->instances_nr; i++)
+	{
+		if(comps->slots[i].comp != NULL)
+		{
+			rohc_comp_free(comps->slots[i].comp);
+		}
+	}
+	kfree(comps);
+}
+
+
+/**
+ * @brief Get the number of compressors in the group
+ *
+ * @param comps  The group of compressors
+ * @return       The number of compressors
+ */
+unsigned int rohc_percpu_comp_get_nr(const struct rohc_percpu_comp *const comps)
+{
+	return comps->instances_nr;
+}
+
+
+/**
+ * @brief Get one compressor of the group to configure it
+ *
+ * The compressor is returned without its lock: it shall not be used while
+ * the group is in use on the datapath.
+ *
+ * @param comps  The group of compressors
+ * @param index  The index of the compressor in the group
+ * @return       The compressor, NULL if the index is out of the group
+ */
+struct rohc_comp * rohc_percpu_comp_get(struct rohc_percpu_comp *const comps,
+                                        const unsigned int index)
+{
+	if(index >= comps->instances_nr)
+	{
+		return NULL;
+	}
+	return comps->slots[index].comp;
+}
+
+
+/**
+ * @brief Select the compressor of the group for the given flow
+ *
+ * All the packets with the same flow hash (eg. skb_get_hash()) are steered
+ * to the same compressor. Callers that steer packets by RX queue or by CPU
+ * may use the queue or CPU index directly instead.
+ *
+ * @param comps      The group of compressors
+ * @param flow_hash  The hash of the flow of the packet
+ * @return           The index of the compressor in the group
+ */
+unsigned int rohc_percpu_comp_select(const struct rohc_percpu_comp *const comps,
+                                     const u32 flow_hash)
+{
+	return rohc_percpu_scale(flow_hash, comps->instances_nr);
+}
+
+
+/**
+ * @brief Compress one packet with one compressor of the group
+ *
+ * May be called from process or softirq context. Only the compressor at
+ * the given index is locked, so packets steered to different compressors
+ * are compressed in parallel.
+ *
+ * @param comps          The group of compressors
+ * @param index          The index of the compressor, see
+ *                       \ref rohc_percpu_comp_select
+ * @param uncomp_packet  The uncompressed packet to compress
+ * @param rohc_packet    The resulting compressed ROHC packet
+ * @return               The result of \ref rohc_compress4,
+ *                       ROHC_STATUS_ERROR if the index is out of the group
+ */
+rohc_status_t rohc_percpu_compress(struct rohc_percpu_comp *const comps,
+                                   const unsigned int index,
+                                   const struct rohc_buf uncomp_packet,
+                                   struct rohc_buf *const rohc_packet)
+{
+	struct rohc_percpu_comp_slot *slot;
+	rohc_status_t status;
+
+	if(index >= comps->instances_nr)
+	{
+		return ROHC_STATUS_ERROR;
+	}
+	slot = &comps->slots[index];
+
+	spin_lock_bh(&slot->lock);
+	status = rohc_compress4(slot->comp, uncomp_packet, rohc_packet);
+	spin_unlock_bh(&slot->lock);
+
+	return status;
+}
+
+
+/**
+ * @brief Deliver one feedback to one compressor of the group
+ *
+ * The feedback shall be delivered to the compressor of the same index as
+ * the decompressor that received it.
+ *
+ * The feedback is enqueued without taking the lock of the compressor, it is
+ * handled with the next packet compressed. It is delivered under the lock
+ * only if the queue of the compressor is full.
+ *
+ * @param comps     The group of compressors
+ * @param index     The index of the compressor
+ * @param feedback  The feedback data to deliver
+ * @return          true if the feedback was enqueued, the result of
+ *                  \ref rohc_comp_deliver_feedback2 otherwise,
+ *                  false if the index is out of the group
+ */
+bool rohc_percpu_comp_deliver_feedback(struct rohc_percpu_comp *const comps,
+                                       const unsigned int index,
+                                       const struct rohc_buf feedback)
+{
+	struct rohc_percpu_comp_slot *slot;
+	bool is_ok;
+
+	if(index >= comps->instances_nr)
+	{
+		return false;
+	}
+	slot = &comps->slots[index];
+
+	if(rohc_comp_enqueue_feedback(slot->comp, feedback))
+	{
+		return true;
+	}
+
+	spin_lock_bh(&slot->lock);
+	is_ok = rohc_comp_deliver_feedback2(slot->comp, feedback);
+	spin_unlock_bh(&slot->lock);
+
+	return is_ok;
+}
+
+
+/*
+ * Groups of decompressors
+ */
+
+
+/**
+ * @brief Create a group of ROHC decompressors
+ *
+ * All the decompressors of the group are created with the same parameters.
+ * They may be configured one by one with \ref rohc_percpu_decomp_get before
+ * the group is used on the datapath.
+ *
+ * Shall be called from process context.
+ *
+ * @param instances_nr  The number of decompressors in the group, 0 for one
+ *                      decompressor per possible CPU
+ * @param cid_type      The type of CID of every decompressor
+ * @param max_cid       The max CID of every decompressor
+ * @param mode          The operational mode of every decompressor
+ * @return              The new group of decompressors if successful,
+ *                      NULL in case of failure
+ */
+struct rohc_percpu_decomp * rohc_percpu_decomp_new(const unsigned int instances_nr,
+                                                   const rohc_cid_type_t cid_type,
+                                                   const rohc_cid_t max_cid,
+                                                   const rohc_mode_t mode)
+{
+	const unsigned int nr = rohc_percpu_get_instances_nr(instances_nr);
+	struct rohc_percpu_decomp *decomps;
+	unsigned int i;
+
+	if(nr == 0)
+	{
+		goto error;
+	}
+
+	decomps = kzalloc(sizeof(struct rohc_percpu_decomp) +
+	                  nr * sizeof(struct rohc_percpu_decomp_slot), GFP_KERNEL);
+	if(decomps == NULL)
+	{
+		goto error;
+	}
+	decomps->instances_nr = nr;
+
+	for(i = 0; i < nr; i++)
+	{
+		spin_lock_init(&decomps->slots[i].lock);
+		decomps->slots[i].decomp = rohc_decomp_new2(cid_type, max_cid, mode);
+		if(decomps->slots[i].decomp == NULL)
+		{
+			goto free_decomps;
+		}
+	}
+
+	return decomps;
+
+free_decomps:
+	rohc_percpu_decomp_free(decomps);
+error:
+	return NULL;
+}
+
+
+/**
+ * @brief Destroy a group of ROHC decompressors
+ *
+ * Shall be called from process context, once the datapath does not use
+ * the group anymore.
+ *
+ * @param decomps  The group of decompressors to destroy, may be NULL
+ */
+void rohc_percpu_decomp_free(struct rohc_percpu_decomp *const decomps)
+{
+	unsigned int i;
+
+	if(decomps == NULL)
+	{
+		return;
+	}
+
+	for(i = 0; i < decomps->instances_nr; i++)
+	{
+		if(decomps->slots[i].decomp != NULL)
+		{
+			rohc_decomp_free(decomps->slots[i].decomp);
+		}
+	}
+	kfree(decomps);
+}
+
+
+/**
+ * @brief Get the number of decompressors in the group
+ *
+ * @param decomps  The group of decompressors
+ * @return         The number of decompressors
+ */
+unsigned int rohc_percpu_decomp_get_nr(const struct rohc_percpu_decomp *const decomps)
+{
+	return decomps->instances_nr;
+}
+
+
+/**
+ * @brief Get one decompressor of the group to configure it
+ *
+ * The decompressor is returned without its lock: it shall not be used
+ * while the group is in use on the datapath.
+ *
+ * @param decomps  The group of decompressors
+ * @param index    The index of the decompressor in the group
+ * @return         The decompressor, NULL if the index is out of the group
+ */
+struct rohc_decomp * rohc_percpu_decomp_get(struct rohc_percpu_decomp *const decomps,
+                                            const unsigned int index)
+{
+	if(index >= decomps->instances_nr)
+	{
+		return NULL;
+	}
+	return decomps->slots[index].decomp;
+}
+
+
+/**
+ * @brief Select the decompressor of the group for the given channel hash
+ *
+ * The hash shall identify the ROHC channel, not the compressed flows: the
+ * packets of one channel shall always be decompressed by the same
+ * decompressor.
+ *
+ * @param decomps    The group of decompressors
+ * @param flow_hash  The hash of the ROHC channel of the packet
+ * @return           The index of the decompressor in the group
+ */
+unsigned int rohc_percpu_decomp_select(const struct rohc_percpu_decomp *const decomps,
+                                       const u32 flow_hash)
+{
+	return rohc_percpu_scale(flow_hash, decomps->instances_nr);
+}
+
+
+/**
+ * @brief Decompress one packet with one decompressor of the group
+ *
+ * May be called from process or softirq context. Only the decompressor at
+ * the given index is locked, so packets of different channels are
+ * decompressed in parallel.
+ *
+ * @param decomps        The group of decompressors
+ * @param index          The index of the decompressor
+ * @param rohc_packet    The compressed ROHC packet to decompress
+ * @param uncomp_packet  The resulting uncompressed packet
+ * @param rcvd_feedback  The feedback received for the compressor of the
+ *                       same index, may be NULL
+ * @param feedback_send  The feedback to send to the remote compressor,
+ *                       may be NULL
+ * @return               The result of \ref rohc_decompress3,
+ *                       ROHC_STATUS_ERROR if the index is out of the group
+ */
+rohc_status_t rohc_percpu_decompress(struct rohc_percpu_decomp *const decomps,
+                                     const unsigned int index,
+                                     const struct rohc_buf rohc_packet,
+                                     struct rohc_buf *const uncomp_packet,
+                                     struct rohc_buf *const rcvd_feedback,
+                                     struct rohc_buf *const feedback_send)
+{
+	struct rohc_percpu_decomp_slot *slot;
+	rohc_status_t status;
+
+	if(index >= decomps->instances_nr)
+	{
+		return ROHC_STATUS_ERROR;
+	}
+	slot = &decomps->slots[index];
+
+	spin_lock_bh(&slot->lock);
+	status = rohc_decompress3(slot->decomp, rohc_packet, uncomp_packet,
+	                          rcvd_feedback, feedback_send);
+	spin_unlock_bh(&slot->lock);
+
+	return status;
+}
+
+
+/*
+ * Private functions
+ */
+
+
+/**
+ * @brief Get the number of instances to create in a group
+ *
+ * @param instances_nr  The number of instances requested, 0 for one instance
+ *                      per possible CPU
+ * @return              The number of instances to create,
+ *                      0 if the requested number is too large
+ */
+static unsigned int rohc_percpu_get_instances_nr(const unsigned int instances_nr)
+{
+	const unsigned int nr = (instances_nr == 0 ? nr_cpu_ids : instances_nr);
+
+	if(nr > ROHC_PERCPU_INSTANCES_MAX)
+	{
+		return 0;
+	}
+	return nr;
+}
+
+
+/**
+ * @brief Map one 32-bit hash to one index in [0, instances_nr)
+ *
+ * Uses the high bits of the hash, like reciprocal_scale(), so that hashes
+ * whose low bits are correlated are spread evenly.
+ *
+ * @param flow_hash     The hash to map
+ * @param instances_nr  The number of instances
+ * @return              The index of the instance
+ */
+static unsigned int rohc_percpu_scale(const u32 flow_hash,
+                                      const unsigned int instances_nr)
+{
+	return (unsigned int) (((u64) flow_hash * instances_nr) >> 32);
+}
+
+
+EXPORT_SYMBOL_GPL(rohc_percpu_comp_new);
+EXPORT_SYMBOL_GPL(rohc_percpu_comp_free);
+EXPORT_SYMBOL_GPL(rohc_percpu_comp_get_nr);
+EXPORT_SYMBOL_GPL(rohc_percpu_comp_get);
+EXPORT_SYMBOL_GPL(rohc_percpu_comp_select);
+EXPORT_SYMBOL_GPL(rohc_percpu_compress);
+EXPORT_SYMBOL_GPL(rohc_percpu_comp_deliver_feedback);
+
+EXPORT_SYMBOL_GPL(rohc_percpu_decomp_new);
+EXPORT_SYMBOL_GPL(rohc_percpu_decomp_free);
+EXPORT_SYMBOL_GPL(rohc_percpu_decomp_get_nr);
+EXPORT_SYMBOL_GPL(rohc_percpu_decomp_get);
+EXPORT_SYMBOL_GPL(rohc_percpu_decomp_select);
+EXPORT_SYMBOL_GPL(rohc_percpu_decompress);
+
@@ -0,0 +1,275 @@
+/*
+ * Copyright 2016 Didier Barvaux
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/**
+ * @file   kmod_skb.c
+ * @brief  Compress/decompress Linux sk_buffs in place
+ * @author Didier Barvaux <didier@barvaux.org>
+ */
+
+#include <linux/module.h>
+#include <linux/skbuff.h>
+#include <linux/if_ether.h>
+#include <linux/ktime.h>
+#include <linux/errno.h>
+
+#include "rohc_skb.h"
+
+
+/**
+ * @brief Get the arrival time of the given sk_buff
+ *
+ * @param skb  The sk_buff
+ * @return     The arrival time of the sk_buff if it was timestamped,
+ *             the current time otherwise
+ */
+static struct rohc_ts rohc_skb_get_time(const struct sk_buff *const skb)
+{
+	const struct timespec64 ts =
+		ktime_to_timespec64(skb->tstamp ? skb->tstamp : ktime_get_real());
+	const struct rohc_ts time = {
+		.sec = ts.tv_sec,
+		.nsec = ts.tv_nsec,
+	};
+
+	return time;
+}
+
+
+/**
+ * @brief Replace the first bytes of the sk_buff by the new headers
+ *
+ * The new headers were built at the very beginning of the headroom of the
+ * sk_buff, they fit in the headroom once the old bytes are removed.
+ *
+ * @param skb       The sk_buff
+ * @param old_len   The number of bytes to remove at the start of the data
+ * @param new_len   The length of the new headers at the start of the head
+ */
+static void rohc_skb_replace_hdrs(struct sk_buff *const skb,
+                                  const unsigned int old_len,
+                                  const unsigned int new_len)
+{
+	__skb_pull(skb, old_len);
+	__skb_push(skb, new_len);
+	memmove(skb->data, skb->head, new_len);
+}
+
+
+/**
+ * @brief Compress the packet of the given sk_buff in place
+ *
+ * The uncompressed headers at the start of the sk_buff are replaced by the
+ * ROHC header, the payload is not copied. The ROHC header is built in the
+ * headroom of the sk_buff, that is expanded if shorter than
+ * \ref ROHC_SKB_COMP_HEADROOM bytes.
+ *
+ * The compressor parses the whole IP packet, so paged sk_buffs are
+ * linearized first. GSO sk_buffs shall be segmented by the caller. Partial
+ * checksums are completed, as the compressor transmits their final value.
+ *
+ * May be called from process or softirq context. The caller is responsible
+ * for serializing the calls on the same compressor.
+ *
+ * @param comp  The ROHC compressor
+ * @param skb   The sk_buff with the IP packet to compress
+ * @return      0 if the sk_buff contains the ROHC packet,
+ *              -EINVAL if the sk_buff is a GSO one,
+ *              -ENOMEM if the sk_buff cannot be made writable,
+ *              -ENOSPC if the headroom is too small for the ROHC header,
+ *              -EIO if the compression failed
+ */
+int rohc_skb_compress(struct rohc_comp *const comp, struct sk_buff *const skb)
+{
+	struct rohc_buf uncomp_packet;
+	struct rohc_buf rohc_hdr;
+	struct rohc_buf payload;
+	unsigned int consumed_len;
+	rohc_status_t status;
+	int ret;
+
+	if(skb_is_gso(skb))
+	{
+		return -EINVAL;
+	}
+	if(skb->ip_summed == CHECKSUM_PARTIAL)
+	{
+		ret = skb_checksum_help(skb);
+		if(ret != 0)
+		{
+			return ret;
+		}
+	}
+	if(skb_linearize(skb) != 0)
+	{
+		return -ENOMEM;
+	}
+	/* the headers are overwritten in place, make them private */
+	if(skb_cow_head(skb, ROHC_SKB_COMP_HEADROOM) != 0)
+	{
+		return -ENOMEM;
+	}
+
+	uncomp_packet.time = rohc_skb_get_time(skb);
+	uncomp_packet.data = skb->data;
+	uncomp_packet.max_len = skb->len;
+	uncomp_packet.offset = 0;
+	uncomp_packet.len = skb->len;
+
+	/* build the ROHC header in the headroom */
+	rohc_hdr.time = uncomp_packet.time;
+	rohc_hdr.data = skb->head;
+	rohc_hdr.max_len = skb_headroom(skb);
+	rohc_hdr.offset = 0;
+	rohc_hdr.len = 0;
+
+	status = rohc_compress_iov(comp, uncomp_packet, &rohc_hdr, &payload);
+	if(status == ROHC_STATUS_OUTPUT_TOO_SMALL)
+	{
+		return -ENOSPC;
+	}
+	else if(status != ROHC_STATUS_OK)
+	{
+		return -EIO;
+	}
+
+	/* the payload is the end of the uncompressed packet */
+	consumed_len = rohc_buf_data(payload) - skb->data;
+	if(WARN_ON_ONCE(consumed_len + payload.len != skb->len))
+	{
+		return -EIO;
+	}
+	rohc_skb_replace_hdrs(skb, consumed_len, rohc_hdr.len);
+
+	return 0;
+}
+
+
+/**
+ * @brief Decompress the ROHC packet of the given sk_buff in place
+ *
+ * The ROHC header at the start of the sk_buff is replaced by the
+ * uncompressed headers, the payload is not copied and may stay in the paged
+ * fragments of the sk_buff. The first \ref ROHC_SKB_DECOMP_PULL_LEN bytes of
+ * the ROHC packet are pulled in the linear part of the sk_buff, the ROHC
+ * header shall fit in them. The uncompressed headers are built in the
+ * headroom of the sk_buff, that is expanded if shorter than
+ * \ref ROHC_SKB_DECOMP_HEADROOM bytes.
+ *
+ * An empty sk_buff is returned for feedback-only ROHC packets.
+ *
+ * May be called from process or softirq context. The caller is responsible
+ * for serializing the calls on the same decompressor.
+ *
+ * @param decomp              The ROHC decompressor
+ * @param skb                 The sk_buff with the ROHC packet to decompress
+ * @param[out] rcvd_feedback  The feedback received from the remote peer,
+ *                            see \ref rohc_decompress3
+ * @param[out] feedback_send  The feedback to be transmitted to the remote
+ *                            compressor, see \ref rohc_decompress3
+ * @return                    0 if the sk_buff contains the IP packet (or
+ *                            nothing for feedback-only packets),
+ *                            -ENOMEM if the sk_buff cannot be made writable,
+ *                            -ENOSPC if the headroom is too small for the
+ *                            uncompressed headers,
+ *                            -EBADMSG if the ROHC packet is malformed or
+ *                            its CRC is wrong,
+ *                            -ENOENT if no context matches the packet,
+ *                            -EIO if the decompression failed
+ */
+int rohc_skb_decompress(struct rohc_decomp *const decomp,
+                        struct sk_buff *const skb,
+                        struct rohc_buf *const rcvd_feedback,
+                        struct rohc_buf *const feedback_send)
+{
+	struct rohc_buf rohc_packet;
+	struct rohc_buf uncomp_hdrs;
+	struct rohc_buf payload;
+	unsigned int consumed_len;
+	rohc_status_t status;
+
+	if(!pskb_may_pull(skb, min_t(unsigned int, skb->len, ROHC_SKB_DECOMP_PULL_LEN)))
+	{
+		return -ENOMEM;
+	}
+	/* the ROHC header is overwritten in place, make it private */
+	if(skb_cow_head(skb, ROHC_SKB_DECOMP_HEADROOM) != 0)
+	{
+		return -ENOMEM;
+	}
+
+	/* the paged fragments are the end of the payload */
+	rohc_packet.time = rohc_skb_get_time(skb);
+	rohc_packet.data = skb->data;
+	rohc_packet.max_len = skb_headlen(skb);
+	rohc_packet.offset = 0;
+	rohc_packet.len = skb_headlen(skb);
+
+	/* build the uncompressed headers in the headroom */
+	uncomp_hdrs.time = rohc_packet.time;
+	uncomp_hdrs.data = skb->head;
+	uncomp_hdrs.max_len = skb_headroom(skb);
+	uncomp_hdrs.offset = 0;
+	uncomp_hdrs.len = 0;
+
+	status = rohc_decompress_iov(decomp, rohc_packet, skb->data_len,
+	                             &uncomp_hdrs, &payload, rcvd_feedback,
+	                             feedback_send);
+	switch(status)
+	{
+		case ROHC_STATUS_OK:
+			break;
+		case ROHC_STATUS_OUTPUT_TOO_SMALL:
+			return -ENOSPC;
+		case ROHC_STATUS_MALFORMED:
+		case ROHC_STATUS_BAD_CRC:
+			return -EBADMSG;
+		case ROHC_STATUS_NO_CONTEXT:
+			return -ENOENT;
+		default:
+			return -EIO;
+	}
+
+	/* feedback-only packet, the packets of the Uncompressed profile have no
+	 * uncompressed headers but a payload */
+	if(uncomp_hdrs.len == 0 && payload.len == 0 && skb->data_len == 0)
+	{
+		return pskb_trim(skb, 0);
+	}
+
+	/* the payload is the end of the ROHC packet */
+	consumed_len = rohc_buf_data(payload) - skb->data;
+	if(WARN_ON_ONCE(consumed_len + payload.len != skb_headlen(skb)))
+	{
+		return -EIO;
+	}
+	rohc_skb_replace_hdrs(skb, consumed_len, uncomp_hdrs.len);
+
+	/* the sk_buff now contains one IPv4 or IPv6 packet, its checksum
+	 * status from the ROHC channel is meaningless */
+	skb_reset_network_header(skb);
+	skb->protocol = ((skb->data[0] >> 4) == 6 ? htons(ETH_P_IPV6) : htons(ETH_P_IP));
+	skb->ip_summed = CHECKSUM_NONE;
+
+	return 0;
+}
+
+
+EXPORT_SYMBOL_GPL(rohc_skb_compress);
+EXPORT_SYMBOL_GPL(rohc_skb_decompress);
+
@@ -0,0 +1,122 @@
+/*
+ * Copyright 2016 Didier Barvaux
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/**
+ * @file   rohc_percpu.h
+ * @brief  Groups of ROHC compressors/decompressors for the Linux kernel
+ * @author Didier Barvaux <didier@barvaux.org>
+ *
+ * A group holds one ROHC compressor (or decompressor) per CPU, or per RX
+ * queue, each one protected by its own lock. Packets are steered to one
+ * instance of the group by their flow hash, so that all the packets of one
+ * flow are handled by the same instance whatever the CPU that receives
+ * them. Softirq processing on several CPUs thus runs in parallel on
+ * different instances instead of contending on one shared instance.
+ *
+ * Every instance is a distinct ROHC channel with its own CID space: the
+ * caller shall transmit the packets of one instance on one channel (one
+ * tunnel, one UDP port...) and decompress them with the decompressor of
+ * the same index on the remote side.
+ */
+
+#ifndef ROHC_KMOD_PERCPU_H
+#define ROHC_KMOD_PERCPU_H
+
+#include <linux/types.h>
+
+#include "rohc.h"
+#include "rohc_comp.h"
+#include "rohc_decomp.h"
+
+
+/** A group of ROHC compressors */
+struct rohc_percpu_comp;
+
+/** A group of ROHC decompressors */
+struct rohc_percpu_decomp;
+
+
+/*
+ * Groups of compressors
+ */
+
+struct rohc_percpu_comp * rohc_percpu_comp_new(const unsigned int instances_nr,
+                                               const rohc_cid_type_t cid_type,
+                                               const rohc_cid_t max_cid,
+                                               const rohc_comp_random_cb_t rand_cb,
+                                               void *const rand_priv)
+	__attribute__((warn_unused_result));
+
+void rohc_percpu_comp_free(struct rohc_percpu_comp *const comps);
+
+unsigned int rohc_percpu_comp_get_nr(const struct rohc_percpu_comp *const comps)
+	__attribute__((warn_unused_result, nonnull(1)));
+
+struct rohc_comp * rohc_percpu_comp_get(struct rohc_percpu_comp *const comps,
+                                        const unsigned int index)
+	__attribute__((warn_unused_result, nonnull(1)));
+
+unsigned int rohc_percpu_comp_select(const struct rohc_percpu_comp *const comps,
+                                     const u32 flow_hash)
+	__attribute__((warn_unused_result, nonnull(1)));
+
+rohc_status_t rohc_percpu_compress(struct rohc_percpu_comp *const comps,
+                                   const unsigned int index,
+                                   const struct rohc_buf uncomp_packet,
+                                   struct rohc_buf *const rohc_packet)
+	__attribute__((warn_unused_result, nonnull(1, 4)));
+
+bool rohc_percpu_comp_deliver_feedback(struct rohc_percpu_comp *const comps,
+                                       const unsigned int index,
+                                       const struct rohc_buf feedback)
+	__attribute__((warn_unused_result, nonnull(1)));
+
+
+/*
+ * Groups of decompressors
+ */
+
+struct rohc_percpu_decomp * rohc_percpu_decomp_new(const unsigned int instances_nr,
+                                                   const rohc_cid_type_t cid_type,
+                                                   const rohc_cid_t max_cid,
+                                                   const rohc_mode_t mode)
+	__attribute__((warn_unused_result));
+
+void rohc_percpu_decomp_free(struct rohc_percpu_decomp *const decomps);
+
+unsigned int rohc_percpu_decomp_get_nr(const struct rohc_percpu_decomp *const decomps)
+	__attribute__((warn_unused_result, nonnull(1)));
+
+struct rohc_decomp * rohc_percpu_decomp_get(struct rohc_percpu_decomp *const decomps,
+                                            const unsigned int index)
+	__attribute__((warn_unused_result, nonnull(1)));
+
+unsigned int rohc_percpu_decomp_select(const struct rohc_percpu_decomp *const decomps,
+                                       const u32 flow_hash)
+	__attribute__((warn_unused_result, nonnull(1)));
+
+rohc_status_t rohc_percpu_decompress(struct rohc_percpu_decomp *const decomps,
+                                     const unsigned int index,
+                                     const struct rohc_buf rohc_packet,
+                                     struct rohc_buf *const uncomp_packet,
+                                     struct rohc_buf *const rcvd_feedback,
+                                     struct rohc_buf *const feedback_send)
+	__attribute__((warn_unused_result, nonnull(1, 4)));
+
+#endif /* ROHC_KMOD_PERCPU_H */
+
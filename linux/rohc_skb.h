@@ -0,0 +1,62 @@
+/*
+ * Copyright 2016 Didier Barvaux
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/**
+ * @file   rohc_skb.h
+ * @brief  Compress/decompress Linux sk_buffs in place
+ * @author Didier Barvaux <didier@barvaux.org>
+ *
+ * The helpers replace the headers of the packet stored in one sk_buff by
+ * their compressed/decompressed version: the new headers are built in the
+ * headroom of the sk_buff, then moved in front of the payload. The payload
+ * is never copied, and it may stay in the paged fragments of the sk_buff on
+ * the decompression side.
+ */
+
+#ifndef ROHC_KMOD_SKB_H
+#define ROHC_KMOD_SKB_H
+
+#include <linux/skbuff.h>
+
+#include "rohc.h"
+#include "rohc_comp.h"
+#include "rohc_decomp.h"
+
+
+/** The headroom reserved for building the ROHC header */
+#define ROHC_SKB_COMP_HEADROOM    128U
+
+/** The headroom reserved for building the uncompressed headers */
+#define ROHC_SKB_DECOMP_HEADROOM  256U
+
+/** The length of the ROHC packet that is pulled in the linear part of the
+ *  sk_buff before decompression, the ROHC header shall fit in it */
+#define ROHC_SKB_DECOMP_PULL_LEN  512U
+
+
+int rohc_skb_compress(struct rohc_comp *const comp, struct sk_buff *const skb)
+	__attribute__((warn_unused_result, nonnull(1, 2)));
+
+int rohc_skb_decompress(struct rohc_decomp *const decomp,
+                        struct sk_buff *const skb,
+                        struct rohc_buf *const rcvd_feedback,
+                        struct rohc_buf *const feedback_send)
+	__attribute__((warn_unused_result, nonnull(1, 2)));
+
+#endif /* ROHC_KMOD_SKB_H */
+
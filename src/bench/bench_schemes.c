@@ -0,0 +1,1064 @@
+/*
+ * Copyright 2016 Didier Barvaux
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/**
+ * @file    bench_schemes.c
+ * @brief   Micro-benchmarks of the encoding schemes
+ * @author  Didier Barvaux <didier@barvaux.org>
+ *
+ * Every benchmark calls one hot primitive of the library in a loop, with
+ * input values drawn once for all from a distribution close to the one seen
+ * on real traffic: sequence numbers that increase by one with a few losses,
+ * RTP timestamps that increase by one voice frame, TCP sequence numbers that
+ * increase by one segment, small values for SDVL, header-sized buffers for
+ * CRCs, and so on. The random generator is seeded with a fixed value, so
+ * that two runs of the benchmarks use the same values.
+ *
+ * Usage: bench_schemes [ITERATIONS [NAME]]
+ *
+ * The program prints the time per call and the number of calls per second
+ * for every benchmark, or only for the benchmarks whose name starts with
+ * NAME.
+ */
+
+#include "comp_wlsb.h"
+#include "decomp_wlsb.h"
+#include "interval.h"
+#include "sdvl.h"
+#include "crc.h"
+#include "rohc_utils.h"
+#include "rfc4996.h"
+#include "tcp_sack.h"
+#include "tcp_ts.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+
+
+/** The default number of calls for every benchmark */
+#define BENCH_ITERATIONS_DEFAULT  10000000UL
+
+/** The number of input values drawn for every benchmark (power of 2) */
+#define BENCH_VALUES_NR  4096U
+
+/** The mask to loop over the input values */
+#define BENCH_VALUES_MASK  (BENCH_VALUES_NR - 1)
+
+/** The max length of the buffers used as input of CRC benchmarks */
+#define BENCH_CRC_LEN_MAX  60U
+
+/** The max number of SACK blocks in one TCP SACK option */
+#define BENCH_SACK_BLOCKS_MAX  4U
+
+
+/** The input values shared by all the benchmarks */
+struct bench_values
+{
+	/** 16-bit sequence numbers: +1 with a few losses */
+	uint16_t sn16[BENCH_VALUES_NR];
+	/** 32-bit RTP timestamps: +160 with a few silences */
+	uint32_t rtp_ts[BENCH_VALUES_NR];
+	/** 32-bit TCP sequence numbers: +1 segment of variable length */
+	uint32_t tcp_seq[BENCH_VALUES_NR];
+	/** 32-bit TCP timestamps: +1 ms with some jitter */
+	uint32_t tcp_ts[BENCH_VALUES_NR];
+	/** Values for SDVL: mostly small, sometimes large */
+	uint32_t sdvl[BENCH_VALUES_NR];
+
+	/** Header-sized buffers to compute CRCs on */
+	uint8_t crc_data[BENCH_VALUES_NR][BENCH_CRC_LEN_MAX];
+	/** The lengths of the buffers to compute CRCs on */
+	size_t crc_lens[BENCH_VALUES_NR];
+
+	/** The SACK blocks of TCP SACK options, in network byte order */
+	sack_block_t sack_blocks[BENCH_VALUES_NR][BENCH_SACK_BLOCKS_MAX];
+	/** The number of SACK blocks in every TCP SACK option */
+	size_t sack_blocks_nr[BENCH_VALUES_NR];
+};
+
+
+/** One micro-benchmark */
+struct bench
+{
+	/** The name of the benchmark */
+	const char *name;
+	/** Run the benchmark, return a value that depends on all the calls */
+	uint64_t (*run)(const struct bench_values *const values,
+	                const unsigned long iterations);
+};
+
+
+static void bench_init_values(struct bench_values *const values)
+	__attribute__((nonnull(1)));
+static uint32_t bench_rand(void)
+	__attribute__((warn_unused_result));
+static double bench_now(void)
+	__attribute__((warn_unused_result));
+
+static uint64_t bench_c_add_wlsb(const struct bench_values *const values,
+                                 const unsigned long iterations)
+	__attribute__((nonnull(1)));
+static uint64_t bench_wlsb_get_k_16bits(const struct bench_values *const values,
+                                        const unsigned long iterations)
+	__attribute__((nonnull(1)));
+static uint64_t bench_wlsb_get_kp_32bits(const struct bench_values *const values,
+                                         const unsigned long iterations)
+	__attribute__((nonnull(1)));
+static uint64_t bench_wlsb_ack(const struct bench_values *const values,
+                               const unsigned long iterations)
+	__attribute__((nonnull(1)));
+static uint64_t bench_rohc_f_16bits(const struct bench_values *const values,
+                                    const unsigned long iterations)
+	__attribute__((nonnull(1)));
+static uint64_t bench_rohc_f_32bits(const struct bench_values *const values,
+                                    const unsigned long iterations)
+	__attribute__((nonnull(1)));
+static uint64_t bench_sdvl_encode(const struct bench_values *const values,
+                                  const unsigned long iterations)
+	__attribute__((nonnull(1)));
+static uint64_t bench_sdvl_decode(const struct bench_values *const values,
+                                  const unsigned long iterations)
+	__attribute__((nonnull(1)));
+static uint64_t bench_sdvl_encode_ref(const struct bench_values *const values,
+                                      const unsigned long iterations)
+	__attribute__((nonnull(1)));
+static uint64_t bench_sdvl_decode_ref(const struct bench_values *const values,
+                                      const unsigned long iterations)
+	__attribute__((nonnull(1)));
+static bool bench_ref_sdvl_encode_full(uint8_t *const sdvl_bytes,
+                                       const size_t sdvl_bytes_max_nr,
+                                       size_t *const sdvl_bytes_nr,
+                                       const uint32_t value)
+	__attribute__((warn_unused_result, nonnull(1, 3), noinline));
+static size_t bench_ref_sdvl_decode(const uint8_t *const data,
+                                    const size_t length,
+                                    uint32_t *const value,
+                                    size_t *const bits_nr)
+	__attribute__((warn_unused_result, nonnull(1, 3, 4), noinline));
+static uint64_t bench_crc3(const struct bench_values *const values,
+                           const unsigned long iterations)
+	__attribute__((nonnull(1)));
+static uint64_t bench_crc7(const struct bench_values *const values,
+                           const unsigned long iterations)
+	__attribute__((nonnull(1)));
+static uint64_t bench_crc8(const struct bench_values *const values,
+                           const unsigned long iterations)
+	__attribute__((nonnull(1)));
+static uint64_t bench_tcp_opt_sack_code(const struct bench_values *const values,
+                                        const unsigned long iterations)
+	__attribute__((nonnull(1)));
+static uint64_t bench_tcp_ts_lsb_code(const struct bench_values *const values,
+                                      const unsigned long iterations)
+	__attribute__((nonnull(1)));
+static uint64_t bench_variable_length_32_enc(const struct bench_values *const values,
+                                             const unsigned long iterations)
+	__attribute__((nonnull(1)));
+static uint64_t bench_rohc_lsb_decode(const struct bench_values *const values,
+                                      const unsigned long iterations)
+	__attribute__((nonnull(1)));
+
+
+/** All the micro-benchmarks */
+static const struct bench benches[] = {
+	{ "c_add_wlsb",             bench_c_add_wlsb },
+	{ "wlsb_get_k_16bits",      bench_wlsb_get_k_16bits },
+	{ "wlsb_get_kp_32bits",     bench_wlsb_get_kp_32bits },
+	{ "wlsb_ack",               bench_wlsb_ack },
+	{ "rohc_f_16bits",          bench_rohc_f_16bits },
+	{ "rohc_f_32bits",          bench_rohc_f_32bits },
+	{ "sdvl_encode",            bench_sdvl_encode },
+	{ "sdvl_decode",            bench_sdvl_decode },
+	{ "sdvl_encode_ref",        bench_sdvl_encode_ref },
+	{ "sdvl_decode_ref",        bench_sdvl_decode_ref },
+	{ "crc_calculate_3",        bench_crc3 },
+	{ "crc_calculate_7",        bench_crc7 },
+	{ "crc_calculate_8",        bench_crc8 },
+	{ "c_tcp_opt_sack_code",    bench_tcp_opt_sack_code },
+	{ "c_tcp_ts_lsb_code",      bench_tcp_ts_lsb_code },
+	{ "variable_length_32_enc", bench_variable_length_32_enc },
+	{ "rohc_lsb_decode",        bench_rohc_lsb_decode },
+};
+
+
+/** The state of the random generator, fixed seed for reproducible runs */
+static uint32_t bench_rand_state = 0x2545f491U;
+
+
+/**
+ * @brief Run the micro-benchmarks of the encoding schemes
+ *
+ * @param argc  The number of command line arguments
+ * @param argv  The command line arguments
+ * @return      0 if the benchmarks ran, 1 otherwise
+ */
+int main(int argc, char *argv[])
+{
+	const size_t benches_nr = sizeof(benches) / sizeof(struct bench);
+	unsigned long iterations = BENCH_ITERATIONS_DEFAULT;
+	const char *filter = NULL;
+	struct bench_values *values;
+	uint64_t checksum = 0;
+	size_t i;
+
+	/* parse the optional arguments */
+	if(argc > 3)
+	{
+		fprintf(stderr, "usage: %s [ITERATIONS [NAME]]\n", argv[0]);
+		goto error;
+	}
+	if(argc >= 2)
+	{
+		char *end;
+
+		iterations = strtoul(argv[1], &end, 10);
+		if(iterations == 0 || (*end) != '\0')
+		{
+			fprintf(stderr, "invalid number of iterations '%s'\n", argv[1]);
+			goto error;
+		}
+	}
+	if(argc == 3)
+	{
+		filter = argv[2];
+	}
+
+	/* draw the input values once for all the benchmarks */
+	values = malloc(sizeof(struct bench_values));
+	if(values == NULL)
+	{
+		fprintf(stderr, "failed to allocate memory for input values\n");
+		goto error;
+	}
+	bench_init_values(values);
+
+	printf("%-24s %12s %10s %10s\n", "benchmark", "calls", "ns/call",
+	       "Mcalls/s");
+	for(i = 0; i < benches_nr; i++)
+	{
+		double start;
+		double elapsed;
+
+		if(filter != NULL &&
+		   strncmp(benches[i].name, filter, strlen(filter)) != 0)
+		{
+			continue;
+		}
+
+		start = bench_now();
+		checksum += benches[i].run(values, iterations);
+		elapsed = bench_now() - start;
+
+		printf("%-24s %12lu %10.2f %10.2f\n", benches[i].name, iterations,
+		       elapsed * 1e9 / iterations, iterations / elapsed / 1e6);
+		fflush(stdout);
+	}
+
+	/* print the checksum, so that the compiler cannot drop the calls */
+	printf("checksum: 0x%08lx\n", (unsigned long) (checksum & 0xffffffffUL));
+
+	free(values);
+	return 0;
+
+error:
+	return 1;
+}
+
+
+/**
+ * @brief Get a pseudo-random number (xorshift32)
+ *
+ * @return  The pseudo-random number
+ */
+static uint32_t bench_rand(void)
+{
+	bench_rand_state ^= bench_rand_state << 13;
+	bench_rand_state ^= bench_rand_state >> 17;
+	bench_rand_state ^= bench_rand_state << 5;
+	return bench_rand_state;
+}
+
+
+/**
+ * @brief Read the monotonic clock
+ *
+ * @return  The current time (in seconds)
+ */
+static double bench_now(void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+
+/**
+ * @brief Draw the input values of the benchmarks
+ *
+ * @param values  The input values to draw
+ */
+static void bench_init_values(struct bench_values *const values)
+{
+	uint16_t sn16 = bench_rand();
+	uint32_t rtp_ts = bench_rand();
+	uint32_t tcp_seq = bench_rand();
+	uint32_t tcp_ts = bench_rand();
+	size_t i;
+
+	for(i = 0; i < BENCH_VALUES_NR; i++)
+	{
+		const uint32_t r = bench_rand();
+		size_t j;
+
+		/* SN: +1, but 2 % of losses of up to 8 packets */
+		sn16 += 1 + ((r % 100) < 2 ? (r >> 8) % 8 : 0);
+		values->sn16[i] = sn16;
+
+		/* RTP TS: one 20-ms frame at 8 kHz, but 1 % of silences */
+		rtp_ts += 160 * (1 + ((r % 100) < 1 ? (r >> 8) % 50 : 0));
+		values->rtp_ts[i] = rtp_ts;
+
+		/* TCP seq: mostly full-sized segments, some small ones */
+		tcp_seq += ((r % 100) < 80 ? 1448 : (r >> 8) % 536);
+		values->tcp_seq[i] = tcp_seq;
+
+		/* TCP TS: 1 kHz clock, 0 to 3 ms between segments */
+		tcp_ts += (r >> 12) % 4;
+		values->tcp_ts[i] = tcp_ts;
+
+		/* SDVL: 70 % on 7 bits, 20 % on 14 bits, 8 % on 21 bits, 2 % on
+		 * 29 bits */
+		if((r % 100) < 70)
+		{
+			values->sdvl[i] = (r >> 8) & 0x7f;
+		}
+		else if((r % 100) < 90)
+		{
+			values->sdvl[i] = (r >> 8) & 0x3fff;
+		}
+		else if((r % 100) < 98)
+		{
+			values->sdvl[i] = (r >> 8) & 0x1fffff;
+		}
+		else
+		{
+			values->sdvl[i] = bench_rand() & 0x1fffffff;
+		}
+
+		/* CRC: the headers of IPv4/UDP/RTP (40 bytes), IPv6/UDP/RTP
+		 * (60 bytes) or IPv4/TCP (20..60 bytes) */
+		switch(r % 3)
+		{
+			case 0:
+				values->crc_lens[i] = 40;
+				break;
+			case 1:
+				values->crc_lens[i] = 60;
+				break;
+			default:
+				values->crc_lens[i] = 20 + ((r >> 8) % 41);
+				break;
+		}
+		for(j = 0; j < BENCH_CRC_LEN_MAX; j++)
+		{
+			values->crc_data[i][j] = bench_rand() & 0xff;
+		}
+
+		/* SACK: 1 to 4 blocks after the ACK, one or a few segments each */
+		values->sack_blocks_nr[i] = 1 + (r >> 16) % BENCH_SACK_BLOCKS_MAX;
+		{
+			uint32_t edge = tcp_seq + 1448 * (1 + (r >> 20) % 4);
+
+			for(j = 0; j < values->sack_blocks_nr[i]; j++)
+			{
+				const uint32_t len = 1448 * (1 + bench_rand() % 8);
+
+				values->sack_blocks[i][j].block_start = rohc_hton32(edge);
+				values->sack_blocks[i][j].block_end = rohc_hton32(edge + len);
+				edge += len + 1448 * (1 + bench_rand() % 4);
+			}
+		}
+	}
+}
+
+
+/**
+ * @brief Benchmark \ref c_add_wlsb with SNs in a window of 4 values
+ *
+ * @param values      The input values
+ * @param iterations  The number of calls
+ * @return            A value that depends on all the calls
+ */
+static uint64_t bench_c_add_wlsb(const struct bench_values *const values,
+                                 const unsigned long iterations)
+{
+	struct c_wlsb wlsb;
+	unsigned long i;
+
+	c_init_wlsb(&wlsb, 16, 4, ROHC_LSB_SHIFT_SN);
+	for(i = 0; i < iterations; i++)
+	{
+		const uint16_t sn = values->sn16[i & BENCH_VALUES_MASK];
+		c_add_wlsb(&wlsb, sn, sn);
+	}
+
+	return wlsb.window_values[wlsb.oldest];
+}
+
+
+/**
+ * @brief Benchmark \ref wlsb_get_k_16bits with SNs in a window of 4 values
+ *
+ * @param values      The input values
+ * @param iterations  The number of calls
+ * @return            A value that depends on all the calls
+ */
+static uint64_t bench_wlsb_get_k_16bits(const struct bench_values *const values,
+                                        const unsigned long iterations)
+{
+	struct c_wlsb wlsb;
+	uint64_t sum = 0;
+	unsigned long i;
+	size_t j;
+
+	/* fill the window with the first values */
+	c_init_wlsb(&wlsb, 16, 4, ROHC_LSB_SHIFT_SN);
+	for(j = 0; j < 4; j++)
+	{
+		c_add_wlsb(&wlsb, values->sn16[j], values->sn16[j]);
+	}
+
+	/* encode the next values against that window */
+	for(i = 0; i < iterations; i++)
+	{
+		sum += wlsb_get_k_16bits(&wlsb, values->sn16[(i + 4) & BENCH_VALUES_MASK]);
+	}
+
+	return sum;
+}
+
+
+/**
+ * @brief Benchmark \ref wlsb_get_kp_32bits with RTP TS in a window of
+ *        4 values
+ *
+ * @param values      The input values
+ * @param iterations  The number of calls
+ * @return            A value that depends on all the calls
+ */
+static uint64_t bench_wlsb_get_kp_32bits(const struct bench_values *const values,
+                                         const unsigned long iterations)
+{
+	struct c_wlsb wlsb;
+	uint64_t sum = 0;
+	unsigned long i;
+	size_t j;
+
+	/* fill the window with the first values */
+	c_init_wlsb(&wlsb, 32, 4, ROHC_LSB_SHIFT_RTP_TS);
+	for(j = 0; j < 4; j++)
+	{
+		c_add_wlsb(&wlsb, j, values->rtp_ts[j]);
+	}
+
+	/* encode the next values against that window */
+	for(i = 0; i < iterations; i++)
+	{
+		sum += wlsb_get_kp_32bits(&wlsb, values->rtp_ts[(i + 4) & BENCH_VALUES_MASK],
+		                          ROHC_LSB_SHIFT_RTP_TS);
+	}
+
+	return sum;
+}
+
+
+/**
+ * @brief Benchmark \ref wlsb_ack with ACKs lagging 32 SNs behind in a window
+ *        of 64 values
+ *
+ * @param values      The input values
+ * @param iterations  The number of calls
+ * @return            A value that depends on all the calls
+ */
+static uint64_t bench_wlsb_ack(const struct bench_values *const values,
+                               const unsigned long iterations)
+{
+	const uint16_t ack_lag = 32;
+	struct c_wlsb wlsb;
+	uint64_t sum = 0;
+	unsigned long i;
+	uint16_t sn;
+
+	/* fill the window with the first values */
+	c_init_wlsb(&wlsb, 16, ROHC_WLSB_WIDTH_MAX, ROHC_LSB_SHIFT_SN);
+	for(sn = 0; sn < ROHC_WLSB_WIDTH_MAX; sn++)
+	{
+		c_add_wlsb(&wlsb, sn, values->sn16[sn]);
+	}
+
+	/* add one value and acknowledge an older one with 8 SN bits */
+	for(i = 0; i < iterations; i++, sn++)
+	{
+		c_add_wlsb(&wlsb, sn, values->sn16[sn & BENCH_VALUES_MASK]);
+		sum += wlsb_ack(&wlsb, (uint16_t) (sn - ack_lag) & 0xff, 8, false);
+	}
+
+	return sum;
+}
+
+
+/**
+ * @brief Benchmark \ref rohc_f_16bits with SNs and usual numbers of bits
+ *
+ * @param values      The input values
+ * @param iterations  The number of calls
+ * @return            A value that depends on all the calls
+ */
+static uint64_t bench_rohc_f_16bits(const struct bench_values *const values,
+                                    const unsigned long iterations)
+{
+	uint64_t sum = 0;
+	unsigned long i;
+
+	for(i = 0; i < iterations; i++)
+	{
+		const struct rohc_interval16 interval =
+			rohc_f_16bits(values->sn16[i & BENCH_VALUES_MASK], 4 + (i & 7),
+			              ROHC_LSB_SHIFT_SN);
+		sum += interval.min + interval.max;
+	}
+
+	return sum;
+}
+
+
+/**
+ * @brief Benchmark \ref rohc_f_32bits with TCP seq and usual numbers of bits
+ *
+ * @param values      The input values
+ * @param iterations  The number of calls
+ * @return            A value that depends on all the calls
+ */
+static uint64_t bench_rohc_f_32bits(const struct bench_values *const values,
+                                    const unsigned long iterations)
+{
+	uint64_t sum = 0;
+	unsigned long i;
+
+	for(i = 0; i < iterations; i++)
+	{
+		const struct rohc_interval32 interval =
+			rohc_f_32bits(values->tcp_seq[i & BENCH_VALUES_MASK], 8 + (i & 15),
+			              ROHC_LSB_SHIFT_TCP_SN);
+		sum += interval.min + interval.max;
+	}
+
+	return sum;
+}
+
+
+/**
+ * @brief Benchmark \ref sdvl_encode_full with mostly small values
+ *
+ * @param values      The input values
+ * @param iterations  The number of calls
+ * @return            A value that depends on all the calls
+ */
+static uint64_t bench_sdvl_encode(const struct bench_values *const values,
+                                  const unsigned long iterations)
+{
+	uint8_t buf[4];
+	uint64_t sum = 0;
+	unsigned long i;
+
+	for(i = 0; i < iterations; i++)
+	{
+		size_t len = 0;
+
+		if(sdvl_encode_full(buf, sizeof(buf), &len,
+		                    values->sdvl[i & BENCH_VALUES_MASK]))
+		{
+			sum += len + buf[0];
+		}
+	}
+
+	return sum;
+}
+
+
+/**
+ * @brief Benchmark \ref sdvl_decode with mostly small values
+ *
+ * @param values      The input values
+ * @param iterations  The number of calls
+ * @return            A value that depends on all the calls
+ */
+static uint64_t bench_sdvl_decode(const struct bench_values *const values,
+                                  const unsigned long iterations)
+{
+	static uint8_t encoded[BENCH_VALUES_NR][4];
+	static size_t encoded_lens[BENCH_VALUES_NR];
+	uint64_t sum = 0;
+	unsigned long i;
+	size_t j;
+
+	/* encode all the values first */
+	for(j = 0; j < BENCH_VALUES_NR; j++)
+	{
+		encoded_lens[j] = 0;
+		if(!sdvl_encode_full(encoded[j], 4, &(encoded_lens[j]), values->sdvl[j]))
+		{
+			encoded_lens[j] = 0;
+		}
+	}
+
+	for(i = 0; i < iterations; i++)
+	{
+		const size_t idx = i & BENCH_VALUES_MASK;
+		uint32_t value;
+		size_t bits_nr;
+
+		sum += sdvl_decode(encoded[idx], encoded_lens[idx], &value, &bits_nr);
+		sum += value;
+	}
+
+	return sum;
+}
+
+
+/**
+ * @brief Benchmark the reference SDVL encoding with mostly small values
+ *
+ * Same as \ref bench_sdvl_encode, but with \ref bench_ref_sdvl_encode_full
+ * to compare the library with the straightforward encoding.
+ *
+ * @param values      The input values
+ * @param iterations  The number of calls
+ * @return            A value that depends on all the calls
+ */
+static uint64_t bench_sdvl_encode_ref(const struct bench_values *const values,
+                                      const unsigned long iterations)
+{
+	uint8_t buf[4];
+	uint64_t sum = 0;
+	unsigned long i;
+
+	for(i = 0; i < iterations; i++)
+	{
+		size_t len = 0;
+
+		if(bench_ref_sdvl_encode_full(buf, sizeof(buf), &len,
+		                              values->sdvl[i & BENCH_VALUES_MASK]))
+		{
+			sum += len + buf[0];
+		}
+	}
+
+	return sum;
+}
+
+
+/**
+ * @brief Benchmark the reference SDVL decoding with mostly small values
+ *
+ * Same as \ref bench_sdvl_decode, but with \ref bench_ref_sdvl_decode
+ * to compare the library with the straightforward decoding.
+ *
+ * @param values      The input values
+ * @param iterations  The number of calls
+ * @return            A value that depends on all the calls
+ */
+static uint64_t bench_sdvl_decode_ref(const struct bench_values *const values,
+                                      const unsigned long iterations)
+{
+	static uint8_t encoded[BENCH_VALUES_NR][4];
+	static size_t encoded_lens[BENCH_VALUES_NR];
+	uint64_t sum = 0;
+	unsigned long i;
+	size_t j;
+
+	/* encode all the values first */
+	for(j = 0; j < BENCH_VALUES_NR; j++)
+	{
+		encoded_lens[j] = 0;
+		if(!sdvl_encode_full(encoded[j], 4, &(encoded_lens[j]), values->sdvl[j]))
+		{
+			encoded_lens[j] = 0;
+		}
+	}
+
+	for(i = 0; i < iterations; i++)
+	{
+		const size_t idx = i & BENCH_VALUES_MASK;
+		uint32_t value = 0;
+		size_t bits_nr;
+
+		sum += bench_ref_sdvl_decode(encoded[idx], encoded_lens[idx], &value,
+		                             &bits_nr);
+		sum += value;
+	}
+
+	return sum;
+}
+
+
+/**
+ * @brief The reference SDVL encoding, one comparison and one shift per byte
+ *
+ * This is the straightforward implementation of 4.5.6 in the RFC 3095 that
+ * the library used before the table-driven one, kept to compare both. It is
+ * not inlined in the benchmark loop, as the library functions are not.
+ *
+ * @param sdvl_bytes         OUT: The SDVL-encoded bytes
+ * @param sdvl_bytes_max_nr  The maximum available free bytes for SDVL
+ * @param sdvl_bytes_nr      OUT: The number of SDVL bytes written
+ * @param value              The value to encode
+ * @return                   true if SDVL encoding is successful,
+ *                           false in case of failure
+ */
+static bool bench_ref_sdvl_encode_full(uint8_t *const sdvl_bytes,
+                                       const size_t sdvl_bytes_max_nr,
+                                       size_t *const sdvl_bytes_nr,
+                                       const uint32_t value)
+{
+	if(value <= 0x7f)
+	{
+		*sdvl_bytes_nr = 1;
+	}
+	else if(value <= 0x3fff)
+	{
+		*sdvl_bytes_nr = 2;
+	}
+	else if(value <= 0x1fffff)
+	{
+		*sdvl_bytes_nr = 3;
+	}
+	else if(value <= 0x1fffffff)
+	{
+		*sdvl_bytes_nr = 4;
+	}
+	else
+	{
+		return false;
+	}
+	if(sdvl_bytes_max_nr < (*sdvl_bytes_nr))
+	{
+		return false;
+	}
+
+	if((*sdvl_bytes_nr) == 1)
+	{
+		sdvl_bytes[0] = value & 0x7f;
+	}
+	else if((*sdvl_bytes_nr) == 2)
+	{
+		sdvl_bytes[0] = ((2 << 6) | ((value >> 8) & 0x3f)) & 0xff;
+		sdvl_bytes[1] = value & 0xff;
+	}
+	else if((*sdvl_bytes_nr) == 3)
+	{
+		sdvl_bytes[0] = ((6 << 5) | ((value >> 16) & 0x1f)) & 0xff;
+		sdvl_bytes[1] = (value >> 8) & 0xff;
+		sdvl_bytes[2] = value & 0xff;
+	}
+	else
+	{
+		sdvl_bytes[0] = ((7 << 5) | ((value >> 24) & 0x1f)) & 0xff;
+		sdvl_bytes[1] = (value >> 16) & 0xff;
+		sdvl_bytes[2] = (value >> 8) & 0xff;
+		sdvl_bytes[3] = value & 0xff;
+	}
+
+	return true;
+}
+
+
+/**
+ * @brief The reference SDVL decoding, one comparison and one shift per byte
+ *
+ * See \ref bench_ref_sdvl_encode_full for details.
+ *
+ * @param data     The SDVL data to decode
+ * @param length   The maximum data length available (in bytes)
+ * @param value    OUT: The decoded value
+ * @param bits_nr  OUT: The number of useful bits
+ * @return         The number of bytes used by the SDVL field (value between
+ *                 1 and 4), 0 in case of problem
+ */
+static size_t bench_ref_sdvl_decode(const uint8_t *const data,
+                                    const size_t length,
+                                    uint32_t *const value,
+                                    size_t *const bits_nr)
+{
+	if(length < 1)
+	{
+		return 0;
+	}
+
+	if((data[0] & 0x80) == 0)
+	{
+		*value = data[0] & 0x7f;
+		*bits_nr = 7;
+		return 1;
+	}
+	else if((data[0] & 0xc0) == 0x80)
+	{
+		if(length < 2)
+		{
+			return 0;
+		}
+		*value = ((data[0] & 0x3f) << 8) | data[1];
+		*bits_nr = 14;
+		return 2;
+	}
+	else if((data[0] & 0xe0) == 0xc0)
+	{
+		if(length < 3)
+		{
+			return 0;
+		}
+		*value = ((data[0] & 0x1f) << 16) | (data[1] << 8) | data[2];
+		*bits_nr = 21;
+		return 3;
+	}
+	else
+	{
+		if(length < 4)
+		{
+			return 0;
+		}
+		*value = ((uint32_t) (data[0] & 0x1f) << 24) | (data[1] << 16) |
+		         (data[2] << 8) | data[3];
+		*bits_nr = 29;
+		return 4;
+	}
+}
+
+
+/**
+ * @brief Benchmark \ref crc_calculate with the given CRC type on headers
+ *
+ * @param values      The input values
+ * @param iterations  The number of calls
+ * @param crc_type    The type of CRC to compute
+ * @param crc_init    The initial value of the CRC
+ * @return            A value that depends on all the calls
+ */
+static uint64_t bench_crc(const struct bench_values *const values,
+                          const unsigned long iterations,
+                          const rohc_crc_type_t crc_type,
+                          const uint8_t crc_init)
+{
+	uint64_t sum = 0;
+	unsigned long i;
+
+	for(i = 0; i < iterations; i++)
+	{
+		const size_t idx = i & BENCH_VALUES_MASK;
+		sum += crc_calculate(crc_type, values->crc_data[idx],
+		                     values->crc_lens[idx], crc_init);
+	}
+
+	return sum;
+}
+
+
+/**
+ * @brief Benchmark \ref crc_calculate with CRC-3 on headers
+ *
+ * @param values      The input values
+ * @param iterations  The number of calls
+ * @return            A value that depends on all the calls
+ */
+static uint64_t bench_crc3(const struct bench_values *const values,
+                           const unsigned long iterations)
+{
+	return bench_crc(values, iterations, ROHC_CRC_TYPE_3, CRC_INIT_3);
+}
+
+
+/**
+ * @brief Benchmark \ref crc_calculate with CRC-7 on headers
+ *
+ * @param values      The input values
+ * @param iterations  The number of calls
+ * @return            A value that depends on all the calls
+ */
+static uint64_t bench_crc7(const struct bench_values *const values,
+                           const unsigned long iterations)
+{
+	return bench_crc(values, iterations, ROHC_CRC_TYPE_7, CRC_INIT_7);
+}
+
+
+/**
+ * @brief Benchmark \ref crc_calculate with CRC-8 on headers
+ *
+ * @param values      The input values
+ * @param iterations  The number of calls
+ * @return            A value that depends on all the calls
+ */
+static uint64_t bench_crc8(const struct bench_values *const values,
+                           const unsigned long iterations)
+{
+	return bench_crc(values, iterations, ROHC_CRC_TYPE_8, CRC_INIT_8);
+}
+
+
+/**
+ * @brief Benchmark \ref c_tcp_opt_sack_code with 1 to 4 SACK blocks
+ *
+ * The SACK blocks are encoded one by one with c_tcp_sack_code_block.
+ *
+ * @param values      The input values
+ * @param iterations  The number of calls
+ * @return            A value that depends on all the calls
+ */
+static uint64_t bench_tcp_opt_sack_code(const struct bench_values *const values,
+                                        const unsigned long iterations)
+{
+	struct rohc_comp comp = { .trace_callback = NULL };
+	struct rohc_comp_profile profile = { .id = ROHC_PROFILE_TCP };
+	struct rohc_comp_ctxt context = { .compressor = &comp, .profile = &profile };
+	uint8_t rohc_data[1 + BENCH_SACK_BLOCKS_MAX * 8];
+	uint64_t sum = 0;
+	unsigned long i;
+
+	for(i = 0; i < iterations; i++)
+	{
+		const size_t idx = i & BENCH_VALUES_MASK;
+		const uint8_t length = values->sack_blocks_nr[idx] * sizeof(sack_block_t);
+
+		sum += c_tcp_opt_sack_code(&context, values->tcp_seq[idx],
+		                           values->sack_blocks[idx], length, false,
+		                           rohc_data, sizeof(rohc_data));
+	}
+
+	return sum;
+}
+
+
+/**
+ * @brief Benchmark \ref c_tcp_ts_lsb_code with TCP TS and usual numbers of
+ *        bits
+ *
+ * @param values      The input values
+ * @param iterations  The number of calls
+ * @return            A value that depends on all the calls
+ */
+static uint64_t bench_tcp_ts_lsb_code(const struct bench_values *const values,
+                                      const unsigned long iterations)
+{
+	struct rohc_comp comp = { .trace_callback = NULL };
+	struct rohc_comp_profile profile = { .id = ROHC_PROFILE_TCP };
+	struct rohc_comp_ctxt context = { .compressor = &comp, .profile = &profile };
+	uint8_t rohc_data[4];
+	uint64_t sum = 0;
+	unsigned long i;
+
+	for(i = 0; i < iterations; i++)
+	{
+		const size_t idx = i & BENCH_VALUES_MASK;
+		const uint32_t ts = values->tcp_ts[idx];
+		const uint32_t delta = ts - values->tcp_ts[(idx - 1) & BENCH_VALUES_MASK];
+		const size_t nr_bits = (delta == 0 ? 0 : 32 - __builtin_clz(delta));
+		size_t rohc_len;
+
+		if(c_tcp_ts_lsb_code(&context, ts, nr_bits, nr_bits, nr_bits,
+		                     rohc_data, sizeof(rohc_data), &rohc_len))
+		{
+			sum += rohc_len + rohc_data[0];
+		}
+	}
+
+	return sum;
+}
+
+
+/**
+ * @brief Benchmark \ref variable_length_32_enc with TCP seq
+ *
+ * @param values      The input values
+ * @param iterations  The number of calls
+ * @return            A value that depends on all the calls
+ */
+static uint64_t bench_variable_length_32_enc(const struct bench_values *const values,
+                                             const unsigned long iterations)
+{
+	uint8_t rohc_data[4];
+	uint64_t sum = 0;
+	unsigned long i;
+
+	for(i = 0; i < iterations; i++)
+	{
+		const size_t idx = i & BENCH_VALUES_MASK;
+		const uint32_t old_value = values->tcp_seq[(idx - 1) & BENCH_VALUES_MASK];
+		const uint32_t new_value = values->tcp_seq[idx];
+		const uint32_t delta = new_value - old_value;
+		const size_t nr_bits = (delta == 0 ? 0 : 32 - __builtin_clz(delta));
+		int indicator;
+
+		sum += variable_length_32_enc(old_value, new_value, nr_bits, nr_bits,
+		                              rohc_data, sizeof(rohc_data), &indicator);
+		sum += indicator;
+	}
+
+	return sum;
+}
+
+
+/**
+ * @brief Benchmark \ref rohc_lsb_decode with SNs and usual numbers of bits
+ *
+ * The reference value follows the decoded SNs like in decompression
+ * contexts.
+ *
+ * @param values      The input values
+ * @param iterations  The number of calls
+ * @return            A value that depends on all the calls
+ */
+static uint64_t bench_rohc_lsb_decode(const struct bench_values *const values,
+                                      const unsigned long iterations)
+{
+	struct rohc_lsb_decode lsb;
+	uint64_t sum = 0;
+	unsigned long i;
+
+	rohc_lsb_init(&lsb, 16);
+	rohc_lsb_set_ref(&lsb, values->sn16[0], false);
+	for(i = 1; i < iterations; i++)
+	{
+		const uint16_t sn = values->sn16[i & BENCH_VALUES_MASK];
+		const size_t k = ((i & 3) == 0 ? 8 : 4);
+		uint32_t decoded;
+
+		if(rohc_lsb_decode(&lsb, ROHC_LSB_REF_0, 0, sn & ((1U << k) - 1), k,
+		                   ROHC_LSB_SHIFT_SN, &decoded))
+		{
+			sum += decoded;
+		}
+		rohc_lsb_set_ref(&lsb, sn, false);
+	}
+
+	return sum;
+}
+
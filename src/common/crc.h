@@ -33,6 +33,7 @@
 #define ROHC_COMMON_CRC_H
 
 #include "ip.h"
+#include "rohc_cpu.h"
 
 #ifdef __KERNEL__
 #  include <linux/types.h>
@@ -62,85 +63,130 @@ typedef enum
 } rohc_crc_type_t;
 
 
+/** The max length of the CRC-STATIC fields of one IP header (IPv6) */
+#define ROHC_CRC_STATIC_IP_FIELDS_MAX  38U
+
+/**
+ * @brief The CRC-STATIC computed on the IP headers of one context
+ *
+ * The static fields of the IP headers do not change during the lifetime of
+ * most flows. The part of the CRC-STATIC that covers them is cached once for
+ * every CRC type, and reused as long as the static fields of the IP headers
+ * do not change.
+ *
+ * The IPv6 extension headers are covered by the cache too if the context
+ * tracks their lists: the context gives the generation of every list, that
+ * changes whenever the extension headers of the list change.
+ */
+struct rohc_crc_static_cache
+{
+	/** The static fields of the outer and inner IP headers the CRCs were
+	 *  computed on */
+	uint8_t ip_fields[ROHC_CRC_STATIC_IP_FIELDS_MAX * 2];
+	/** The length of the static fields of the IP headers */
+	size_t ip_fields_len;
+	/** The cached CRC-3, CRC-7 and CRC-8 */
+	uint8_t crcs[3];
+	/** The initial values the cached CRC-3, CRC-7 and CRC-8 were computed from */
+	uint8_t crc_inits[3];
+	/** Whether the CRC-3, CRC-7 and CRC-8 are cached or not */
+	bool is_cached[3];
+	/** The generations of the IPv6 extension headers of the outer and inner
+	 *  IP headers the CRCs were computed on, 0 for no extension header */
+	size_t ip_exts_gens[2];
+	/** The generations of the lists of IPv6 extension headers of the outer
+	 *  and inner IP headers of the current packet, set by the context before
+	 *  every computation, 0 if the context does not track them */
+	size_t exts_gens[2];
+};
+
+
 /*
  * Function prototypes.
  */
 
-bool rohc_crc_init_table(uint8_t *const table,
-                         const rohc_crc_type_t crc_type)
-	__attribute__((nonnull(1), warn_unused_result));
-
 uint8_t crc_calculate(const rohc_crc_type_t crc_type,
                       const uint8_t *const data,
                       const size_t length,
-                      const uint8_t init_val,
-                      const uint8_t *const crc_table)
-	__attribute__((nonnull(2, 5), warn_unused_result));
+                      const uint8_t init_val)
+	__attribute__((nonnull(2), warn_unused_result));
 
 uint32_t crc_calc_fcs32(const uint8_t *const data,
                         const size_t length,
                         const uint32_t init_val)
 	__attribute__((nonnull(1), warn_unused_result, pure));
+uint32_t crc_calc_fcs32_generic(const uint8_t *const data,
+                                const size_t length,
+                                const uint32_t init_val)
+	__attribute__((nonnull(1), warn_unused_result, pure));
+#ifdef ROHC_CPU_X86
+uint32_t crc_calc_fcs32_pclmul(const uint8_t *const data,
+                               const size_t length,
+                               const uint32_t init_val)
+	__attribute__((nonnull(1), warn_unused_result, pure));
+#endif
 
 uint8_t compute_crc_static(const uint8_t *const outer_ip,
                            const uint8_t *const inner_ip,
                            const uint8_t *const next_header,
                            const rohc_crc_type_t crc_type,
                            const uint8_t init_val,
-                           const uint8_t *const crc_table)
-	__attribute__((nonnull(1, 6), warn_unused_result));
+                           struct rohc_crc_static_cache *const cache)
+	__attribute__((nonnull(1), warn_unused_result));
 uint8_t compute_crc_dynamic(const uint8_t *const outer_ip,
                             const uint8_t *const inner_ip,
                             const uint8_t *const next_header,
                             const rohc_crc_type_t crc_type,
-                            const uint8_t init_val,
-                            const uint8_t *const crc_table)
-	__attribute__((nonnull(1, 6), warn_unused_result));
+                            const uint8_t init_val)
+	__attribute__((nonnull(1), warn_unused_result));
 
 uint8_t udp_compute_crc_static(const uint8_t *const outer_ip,
                                const uint8_t *const inner_ip,
                                const uint8_t *const next_header,
                                const rohc_crc_type_t crc_type,
                                const uint8_t init_val,
-                               const uint8_t *const crc_table)
-	__attribute__((nonnull(1, 3, 6), warn_unused_result));
+                               struct rohc_crc_static_cache *const cache)
+	__attribute__((nonnull(1, 3), warn_unused_result));
 uint8_t udp_compute_crc_dynamic(const uint8_t *const outer_ip,
                                 const uint8_t *const inner_ip,
                                 const uint8_t *const next_header,
                                 const rohc_crc_type_t crc_type,
-                                const uint8_t init_val,
-                                const uint8_t *const crc_table)
-	__attribute__((nonnull(1, 3, 6), warn_unused_result));
+                                const uint8_t init_val)
+	__attribute__((nonnull(1, 3), warn_unused_result));
 
 uint8_t esp_compute_crc_static(const uint8_t *const outer_ip,
                                const uint8_t *const inner_ip,
                                const uint8_t *const next_header,
                                const rohc_crc_type_t crc_type,
                                const uint8_t init_val,
-                               const uint8_t *const crc_table)
-	__attribute__((nonnull(1, 3, 6), warn_unused_result));
+                               struct rohc_crc_static_cache *const cache)
+	__attribute__((nonnull(1, 3), warn_unused_result));
 uint8_t esp_compute_crc_dynamic(const uint8_t *const outer_ip,
                                 const uint8_t *const inner_ip,
                                 const uint8_t *const next_header,
                                 const rohc_crc_type_t crc_type,
-                                const uint8_t init_val,
-                                const uint8_t *const crc_table)
-	__attribute__((nonnull(1, 3, 6), warn_unused_result));
+                                const uint8_t init_val)
+	__attribute__((nonnull(1, 3), warn_unused_result));
 
 uint8_t rtp_compute_crc_static(const uint8_t *const outer_ip,
                                const uint8_t *const inner_ip,
                                const uint8_t *const next_header,
                                const rohc_crc_type_t crc_type,
                                const uint8_t init_val,
-                               const uint8_t *const crc_table)
-	__attribute__((nonnull(1, 3, 6), warn_unused_result));
+                               struct rohc_crc_static_cache *const cache)
+	__attribute__((nonnull(1, 3), warn_unused_result));
 uint8_t rtp_compute_crc_dynamic(const uint8_t *const outer_ip,
                                 const uint8_t *const inner_ip,
                                 const uint8_t *const next_header,
                                 const rohc_crc_type_t crc_type,
-                                const uint8_t init_val,
-                                const uint8_t *const crc_table)
-	__attribute__((nonnull(1, 3, 6), warn_unused_result));
+                                const uint8_t init_val)
+	__attribute__((nonnull(1, 3), warn_unused_result));
+
+uint8_t rfc5225_compute_ctrl_crc3(const uint8_t reorder_ratio,
+                                 const uint16_t msn,
+                                 const uint8_t *const ip_id_behaviors,
+                                 const size_t ip_id_behaviors_nr)
+	__attribute__((warn_unused_result));
 
 #endif
 
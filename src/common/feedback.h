@@ -113,6 +113,25 @@ struct rohc_feedback_2_rfc6846
 } __attribute__((packed));
 
 
+static inline bool rohc_feedback_is_rfc6846(const rohc_profile_t profile_id)
+	__attribute__((warn_unused_result, const));
+
+
+/**
+ * @brief Whether the FEEDBACK-2 of one profile uses the RFC6846 format
+ *
+ * The ROHCv2 profiles use the FEEDBACK-2 format of the TCP profile
+ * (RFC5225 §6.9.1): no mode bits, 14 bits of MSN and a mandatory CRC.
+ *
+ * @param profile_id  The ID of the profile
+ * @return            true if the RFC6846 format is used, false otherwise
+ */
+static inline bool rohc_feedback_is_rfc6846(const rohc_profile_t profile_id)
+{
+	return (profile_id == ROHC_PROFILE_TCP || (profile_id & 0xff00) == 0x0100);
+}
+
+
 /** The characteristics of one ROHC feedback option */
 struct rohc_feedback_opt_charac
 {
@@ -125,7 +144,7 @@ struct rohc_feedback_opt_charac
 		ROHC_FEEDBACK_OPT_CRC_SUGGESTED,
 		ROHC_FEEDBACK_OPT_CRC_NOT_REQUIRED,
 	} crc_req;
-	size_t max_occurs[ROHC_PROFILE_MAX];
+	uint8_t max_occurs[ROHC_PROFILE_MAX];
 };
 
 
@@ -163,6 +182,10 @@ static const struct rohc_feedback_opt_charac
 			[ROHC_PROFILE_TCP]          = 0, /* RFC6846 §8.3.2 */
 			[ROHC_PROFILE_UDPLITE_RTP]  = ROHC_FEEDBACK_OPT_MAX_OCCURS, /* same as RTP */
 			[ROHC_PROFILE_UDPLITE]      = ROHC_FEEDBACK_OPT_MAX_OCCURS, /* same as UDP */
+			[ROHCv2_PROFILE_IP_UDP_RTP] = 0, /* same as TCP (RFC5225 §6.9.2) */
+			[ROHCv2_PROFILE_IP_UDP]     = 0, /* same as TCP (RFC5225 §6.9.2) */
+			[ROHCv2_PROFILE_IP_ESP]     = 0, /* same as TCP (RFC5225 §6.9.2) */
+			[ROHCv2_PROFILE_IP]         = 0, /* same as TCP (RFC5225 §6.9.2) */
 		}
 	},
 	[ROHC_FEEDBACK_OPT_REJECT] = {
@@ -181,6 +204,10 @@ static const struct rohc_feedback_opt_charac
 			[ROHC_PROFILE_TCP]          = 1, /* RFC6846 §8.3.2.1 */
 			[ROHC_PROFILE_UDPLITE_RTP]  = ROHC_FEEDBACK_OPT_MAX_OCCURS, /* same as RTP */
 			[ROHC_PROFILE_UDPLITE]      = ROHC_FEEDBACK_OPT_MAX_OCCURS, /* same as UDP */
+			[ROHCv2_PROFILE_IP_UDP_RTP] = 1, /* same as TCP (RFC5225 §6.9.2) */
+			[ROHCv2_PROFILE_IP_UDP]     = 1, /* same as TCP (RFC5225 §6.9.2) */
+			[ROHCv2_PROFILE_IP_ESP]     = 1, /* same as TCP (RFC5225 §6.9.2) */
+			[ROHCv2_PROFILE_IP]         = 1, /* same as TCP (RFC5225 §6.9.2) */
 		}
 	},
 	[ROHC_FEEDBACK_OPT_SN_NOT_VALID] = {
@@ -199,6 +226,10 @@ static const struct rohc_feedback_opt_charac
 			[ROHC_PROFILE_TCP]          = 1, /* RFC6846 §8.3.2.2 */
 			[ROHC_PROFILE_UDPLITE_RTP]  = ROHC_FEEDBACK_OPT_MAX_OCCURS, /* same as RTP */
 			[ROHC_PROFILE_UDPLITE]      = ROHC_FEEDBACK_OPT_MAX_OCCURS, /* same as UDP */
+			[ROHCv2_PROFILE_IP_UDP_RTP] = 1, /* same as TCP (RFC5225 §6.9.2) */
+			[ROHCv2_PROFILE_IP_UDP]     = 1, /* same as TCP (RFC5225 §6.9.2) */
+			[ROHCv2_PROFILE_IP_ESP]     = 1, /* same as TCP (RFC5225 §6.9.2) */
+			[ROHCv2_PROFILE_IP]         = 1, /* same as TCP (RFC5225 §6.9.2) */
 		}
 	},
 	[ROHC_FEEDBACK_OPT_SN] = {
@@ -217,6 +248,10 @@ static const struct rohc_feedback_opt_charac
 			[ROHC_PROFILE_TCP]          = 1, /* RFC6846 §8.3.2.3 */
 			[ROHC_PROFILE_UDPLITE_RTP]  = 1, /* same as RTP */
 			[ROHC_PROFILE_UDPLITE]      = 1, /* same as UDP */
+			[ROHCv2_PROFILE_IP_UDP_RTP] = 1, /* same as TCP (RFC5225 §6.9.2) */
+			[ROHCv2_PROFILE_IP_UDP]     = 1, /* same as TCP (RFC5225 §6.9.2) */
+			[ROHCv2_PROFILE_IP_ESP]     = 1, /* same as TCP (RFC5225 §6.9.2) */
+			[ROHCv2_PROFILE_IP]         = 1, /* same as TCP (RFC5225 §6.9.2) */
 		}
 	},
 	[ROHC_FEEDBACK_OPT_CLOCK] = {
@@ -235,6 +270,10 @@ static const struct rohc_feedback_opt_charac
 			[ROHC_PROFILE_TCP]          = 0, /* RFC6846 §8.3.2 */
 			[ROHC_PROFILE_UDPLITE_RTP]  = ROHC_FEEDBACK_OPT_MAX_OCCURS, /* same as RTP */
 			[ROHC_PROFILE_UDPLITE]      = 0, /* same as UDP */
+			[ROHCv2_PROFILE_IP_UDP_RTP] = 0, /* same as TCP (RFC5225 §6.9.2) */
+			[ROHCv2_PROFILE_IP_UDP]     = 0, /* same as TCP (RFC5225 §6.9.2) */
+			[ROHCv2_PROFILE_IP_ESP]     = 0, /* same as TCP (RFC5225 §6.9.2) */
+			[ROHCv2_PROFILE_IP]         = 0, /* same as TCP (RFC5225 §6.9.2) */
 		}
 	},
 	[ROHC_FEEDBACK_OPT_JITTER] = {
@@ -253,6 +292,10 @@ static const struct rohc_feedback_opt_charac
 			[ROHC_PROFILE_TCP]          = 0, /* RFC6846 §8.3.2 */
 			[ROHC_PROFILE_UDPLITE_RTP]  = ROHC_FEEDBACK_OPT_MAX_OCCURS, /* same as RTP */
 			[ROHC_PROFILE_UDPLITE]      = 0, /* same as UDP */
+			[ROHCv2_PROFILE_IP_UDP_RTP] = 0, /* same as TCP (RFC5225 §6.9.2) */
+			[ROHCv2_PROFILE_IP_UDP]     = 0, /* same as TCP (RFC5225 §6.9.2) */
+			[ROHCv2_PROFILE_IP_ESP]     = 0, /* same as TCP (RFC5225 §6.9.2) */
+			[ROHCv2_PROFILE_IP]         = 0, /* same as TCP (RFC5225 §6.9.2) */
 		}
 	},
 	[ROHC_FEEDBACK_OPT_LOSS] = {
@@ -271,6 +314,10 @@ static const struct rohc_feedback_opt_charac
 			[ROHC_PROFILE_TCP]          = 0, /* RFC6846 §8.3.2 */
 			[ROHC_PROFILE_UDPLITE_RTP]  = ROHC_FEEDBACK_OPT_MAX_OCCURS, /* same as RTP */
 			[ROHC_PROFILE_UDPLITE]      = ROHC_FEEDBACK_OPT_MAX_OCCURS, /* same as UDP */
+			[ROHCv2_PROFILE_IP_UDP_RTP] = 0, /* same as TCP (RFC5225 §6.9.2) */
+			[ROHCv2_PROFILE_IP_UDP]     = 0, /* same as TCP (RFC5225 §6.9.2) */
+			[ROHCv2_PROFILE_IP_ESP]     = 0, /* same as TCP (RFC5225 §6.9.2) */
+			[ROHCv2_PROFILE_IP]         = 0, /* same as TCP (RFC5225 §6.9.2) */
 		}
 	},
 	[ROHC_FEEDBACK_OPT_CV_REQUEST] = {
@@ -289,6 +336,10 @@ static const struct rohc_feedback_opt_charac
 			[ROHC_PROFILE_TCP]          = 0, /* RFC6846 §8.3.2 */
 			[ROHC_PROFILE_UDPLITE_RTP]  = 0, /* same as RTP */
 			[ROHC_PROFILE_UDPLITE]      = 0, /* same as UDP */
+			[ROHCv2_PROFILE_IP_UDP_RTP] = 0, /* same as TCP (RFC5225 §6.9.2) */
+			[ROHCv2_PROFILE_IP_UDP]     = 0, /* same as TCP (RFC5225 §6.9.2) */
+			[ROHCv2_PROFILE_IP_ESP]     = 0, /* same as TCP (RFC5225 §6.9.2) */
+			[ROHCv2_PROFILE_IP]         = 0, /* same as TCP (RFC5225 §6.9.2) */
 		}
 	},
 	[ROHC_FEEDBACK_OPT_CONTEXT_MEMORY] = {
@@ -307,6 +358,10 @@ static const struct rohc_feedback_opt_charac
 			[ROHC_PROFILE_TCP]          = 1, /* RFC6846 §8.3.2.4 */
 			[ROHC_PROFILE_UDPLITE_RTP]  = ROHC_FEEDBACK_OPT_MAX_OCCURS, /* RFC4019 §5.7 */
 			[ROHC_PROFILE_UDPLITE]      = ROHC_FEEDBACK_OPT_MAX_OCCURS, /* RFC4019 §5.7 */
+			[ROHCv2_PROFILE_IP_UDP_RTP] = 1, /* same as TCP (RFC5225 §6.9.2) */
+			[ROHCv2_PROFILE_IP_UDP]     = 1, /* same as TCP (RFC5225 §6.9.2) */
+			[ROHCv2_PROFILE_IP_ESP]     = 1, /* same as TCP (RFC5225 §6.9.2) */
+			[ROHCv2_PROFILE_IP]         = 1, /* same as TCP (RFC5225 §6.9.2) */
 		}
 	},
 	[ROHC_FEEDBACK_OPT_UNKNOWN_10] = {
@@ -28,6 +28,11 @@
 #include <stdlib.h>
 #include <stdint.h>
 #include <assert.h>
+#ifdef __KERNEL__
+#  include <linux/types.h>
+#else
+#  include <stdbool.h>
+#endif
 
 
 /**
@@ -45,14 +50,23 @@ typedef enum
 #define ROHC_LSB_SHIFT_TCP_TS_1B  ROHC_LSB_SHIFT_SN /**< real value for TCP TS */
 #define ROHC_LSB_SHIFT_TCP_TS_2B  ROHC_LSB_SHIFT_SN /**< real value for TCP TS */
 	ROHC_LSB_SHIFT_IP_ID      =  0,      /**< real value for IP-ID */
+	ROHC_LSB_SHIFT_REORDER_NONE = 1,     /**< real value for ROHCv2 MSN */
 	ROHC_LSB_SHIFT_TCP_TTL    =  3,      /**< real value for TCP TTL/HL */
 #define ROHC_LSB_SHIFT_TCP_ACK_SCALED  ROHC_LSB_SHIFT_TCP_TTL
+/** real value for ROHCv2 IP-ID offset */
+#define ROHC_LSB_SHIFT_RFC5225_IP_ID  ROHC_LSB_SHIFT_TCP_TTL
 	ROHC_LSB_SHIFT_TCP_SN     =  4,      /**< real value for TCP MSN */
 	ROHC_LSB_SHIFT_TCP_SEQ_SCALED =  7,      /**< real value for TCP seq/ack scaled */
 	ROHC_LSB_SHIFT_RTP_TS     =  100,    /**< need to compute real value for RTP TS */
 	ROHC_LSB_SHIFT_RTP_SN     =  101,    /**< need to compute real value for RTP SN */
 	ROHC_LSB_SHIFT_ESP_SN     =  102,    /**< need to compute real value for ESP SN */
 	ROHC_LSB_SHIFT_VAR        =  103,    /**< real value is variable */
+	/** need to compute real value for ROHCv2 MSN */
+	ROHC_LSB_SHIFT_REORDER_QUARTER = 104,
+	/** need to compute real value for ROHCv2 MSN */
+	ROHC_LSB_SHIFT_REORDER_HALF = 105,
+	/** need to compute real value for ROHCv2 MSN */
+	ROHC_LSB_SHIFT_REORDER_THREEQUARTERS = 106,
 	ROHC_LSB_SHIFT_TCP_WINDOW = 16383,   /**< real value for TCP window */
 	ROHC_LSB_SHIFT_TCP_TS_3B  = 0x00040000, /**< real value for TCP TS */
 	ROHC_LSB_SHIFT_TCP_TS_4B  = 0x04000000, /**< real value for TCP TS */
@@ -130,20 +144,26 @@ static inline int32_t rohc_interval_compute_p(const size_t k,
                                               const rohc_lsb_shift_t p)
 	__attribute__((warn_unused_result, const));
 
-struct rohc_interval8 rohc_f_8bits(const uint8_t v_ref,
-                                   const size_t k,
-                                   const rohc_lsb_shift_t p)
-	__attribute__((warn_unused_result));
+static inline rohc_lsb_shift_t rohc_interval_get_rfc5225_msn_p(const int reorder_ratio)
+	__attribute__((warn_unused_result, const));
+
+static inline bool rohc_interval_is_p_const(const rohc_lsb_shift_t p)
+	__attribute__((warn_unused_result, const));
+
+static inline struct rohc_interval8 rohc_f_8bits(const uint8_t v_ref,
+                                                 const size_t k,
+                                                 const rohc_lsb_shift_t p)
+	__attribute__((warn_unused_result, const));
 
-struct rohc_interval16 rohc_f_16bits(const uint16_t v_ref,
-                                     const size_t k,
-                                     const rohc_lsb_shift_t p)
-	__attribute__((warn_unused_result));
+static inline struct rohc_interval16 rohc_f_16bits(const uint16_t v_ref,
+                                                   const size_t k,
+                                                   const rohc_lsb_shift_t p)
+	__attribute__((warn_unused_result, const));
 
-struct rohc_interval32 rohc_f_32bits(const uint32_t v_ref,
-                                     const size_t k,
-                                     const rohc_lsb_shift_t p)
-	__attribute__((warn_unused_result));
+static inline struct rohc_interval32 rohc_f_32bits(const uint32_t v_ref,
+                                                   const size_t k,
+                                                   const rohc_lsb_shift_t p)
+	__attribute__((warn_unused_result, const));
 
 
 /**
@@ -190,6 +210,17 @@ static inline int32_t rohc_interval_compute_p(const size_t k,
 		}
 		break;
 
+		/* special computations for ROHCv2 MSN encoding (RFC5225 §6.6.8) */
+		case ROHC_LSB_SHIFT_REORDER_QUARTER:
+			computed_p = ((1 << k) / 4) - 1;
+			break;
+		case ROHC_LSB_SHIFT_REORDER_HALF:
+			computed_p = ((1 << k) / 2) - 1;
+			break;
+		case ROHC_LSB_SHIFT_REORDER_THREEQUARTERS:
+			computed_p = (((1 << k) * 3) / 4) - 1;
+			break;
+
 		case ROHC_LSB_SHIFT_VAR:
 			assert(0); /* should not happen */
 			computed_p = p;
@@ -197,6 +228,7 @@ static inline int32_t rohc_interval_compute_p(const size_t k,
 
 		case ROHC_LSB_SHIFT_SN:
 		case ROHC_LSB_SHIFT_IP_ID:
+		case ROHC_LSB_SHIFT_REORDER_NONE:
 		case ROHC_LSB_SHIFT_TCP_TTL:
 		case ROHC_LSB_SHIFT_TCP_SN:
 		case ROHC_LSB_SHIFT_TCP_SEQ_SCALED:
@@ -212,5 +244,144 @@ static inline int32_t rohc_interval_compute_p(const size_t k,
 	return computed_p;
 }
 
+
+/**
+ * @brief Whether the shift parameter p is the same whatever the value of k
+ *
+ * If p does not depend on k, all the intervals f(v_ref, k) start at the same
+ * value v_ref - p and only grow with k: the minimal k for one value is then
+ * given by the number of bits of its distance to v_ref - p.
+ *
+ * @param p  The shift parameter
+ * @return   true if p does not depend on k, false otherwise
+ */
+static inline bool rohc_interval_is_p_const(const rohc_lsb_shift_t p)
+{
+	return (p != ROHC_LSB_SHIFT_RTP_TS &&
+	        p != ROHC_LSB_SHIFT_RTP_SN &&
+	        p != ROHC_LSB_SHIFT_ESP_SN &&
+	        p != ROHC_LSB_SHIFT_REORDER_QUARTER &&
+	        p != ROHC_LSB_SHIFT_REORDER_HALF &&
+	        p != ROHC_LSB_SHIFT_REORDER_THREEQUARTERS);
+}
+
+
+/**
+ * @brief Get the shift parameter p of the MSN of the ROHCv2 profiles
+ *
+ * The more reordering the channel is configured for, the more values before
+ * the reference the interpretation interval of the MSN covers
+ * (RFC5225 §6.6.8).
+ *
+ * @param reorder_ratio  The 2-bit reorder_ratio field of the context
+ * @return               The shift parameter for the MSN
+ */
+static inline rohc_lsb_shift_t rohc_interval_get_rfc5225_msn_p(const int reorder_ratio)
+{
+	switch(reorder_ratio & 0x3)
+	{
+		case 0:
+			return ROHC_LSB_SHIFT_REORDER_NONE;
+		case 1:
+			return ROHC_LSB_SHIFT_REORDER_QUARTER;
+		case 2:
+			return ROHC_LSB_SHIFT_REORDER_HALF;
+		case 3:
+		default:
+			return ROHC_LSB_SHIFT_REORDER_THREEQUARTERS;
+	}
+}
+
+
+/**
+ * @brief The f function as defined in LSB encoding for 8-bit fields
+ *
+ * Find out the interval [v_ref - p, v_ref + (2^k - 1) - p] for a given k.
+ * See 4.5.1 in the RFC 3095 for details.
+ *
+ * As stated RFC, the values to be encoded have a finite range and the
+ * interpretation interval can straddle the wraparound boundary. So, the min
+ * value may be greater than the max value!
+ *
+ * @param v_ref The reference value
+ * @param k     The number of least significant bits of the value that are
+ *              transmitted
+ * @param p     The shift parameter (may be negative)
+ * @return      The computed interval
+ */
+static inline struct rohc_interval8 rohc_f_8bits(const uint8_t v_ref,
+                                                 const size_t k,
+                                                 const rohc_lsb_shift_t p)
+{
+	struct rohc_interval8 interval8;
+
+	/* do not accept more bits than the field may contain */
+	assert(k <= 8);
+
+	/* computed in 8 bits, so wraparound is handled by the truncation */
+	interval8.min = v_ref - rohc_interval_compute_p(k, p);
+	interval8.max = interval8.min + ((1U << k) - 1);
+
+	return interval8;
+}
+
+
+/**
+ * @brief The f function as defined in LSB encoding for 16-bit fields
+ *
+ * See \ref rohc_f_8bits for details.
+ *
+ * @param v_ref The reference value
+ * @param k     The number of least significant bits of the value that are
+ *              transmitted
+ * @param p     The shift parameter (may be negative)
+ * @return      The computed interval
+ */
+static inline struct rohc_interval16 rohc_f_16bits(const uint16_t v_ref,
+                                                   const size_t k,
+                                                   const rohc_lsb_shift_t p)
+{
+	struct rohc_interval16 interval16;
+
+	/* do not accept more bits than the field may contain */
+	assert(k <= 16);
+
+	/* computed in 16 bits, so wraparound is handled by the truncation */
+	interval16.min = v_ref - rohc_interval_compute_p(k, p);
+	interval16.max = interval16.min + ((1U << k) - 1);
+
+	return interval16;
+}
+
+
+/**
+ * @brief The f function as defined in LSB encoding for 32-bit fields
+ *
+ * See \ref rohc_f_8bits for details.
+ *
+ * @param v_ref The reference value
+ * @param k     The number of least significant bits of the value that are
+ *              transmitted
+ * @param p     The shift parameter (may be negative)
+ * @return      The computed interval
+ */
+static inline struct rohc_interval32 rohc_f_32bits(const uint32_t v_ref,
+                                                   const size_t k,
+                                                   const rohc_lsb_shift_t p)
+{
+	struct rohc_interval32 interval32;
+
+	/* accept at most 32 bits */
+	assert(k <= 32);
+
+	/* the interval width 2^k - 1 is computed in 64 bits to accept k = 32,
+	 * straddling the wraparound boundaries is handled without additional
+	 * operation */
+	interval32.min = v_ref - rohc_interval_compute_p(k, p);
+	interval32.max = interval32.min + (uint32_t) ((UINT64_C(1) << k) - 1);
+
+	return interval32;
+}
+
 #endif
 
@@ -38,14 +38,15 @@
 #include <assert.h>
 
 
-static bool ip_find_next_layer(const struct ip_packet *const ip,
+static bool ip_find_next_layer(struct ip_packet *const ip,
                                struct net_hdr *const nh,
                                struct net_hdr *const nl)
 	__attribute__((warn_unused_result, nonnull(1, 2, 3)));
 
-static bool ext_get_next_layer(const struct net_hdr *const nh,
+static bool ext_get_next_layer(struct ip_packet *const ip,
+                               const struct net_hdr *const nh,
                                struct net_hdr *const nl)
-	__attribute__((warn_unused_result, nonnull(1, 2)));
+	__attribute__((warn_unused_result, nonnull(1, 2, 3)));
 
 static bool ext_get_next_header(const uint8_t *const ext,
                                 const size_t ext_len,
@@ -170,6 +171,8 @@ malformed:
 	ip->nl.proto = 0;
 	ip->nl.data = NULL;
 	ip->nl.len = 0;
+	ip->exts_nr = 0;
+	ip->exts_len = 0;
 	return 1;
 
 unknown:
@@ -184,6 +187,8 @@ unknown:
 	ip->nl.proto = 0;
 	ip->nl.data = NULL;
 	ip->nl.len = 0;
+	ip->exts_nr = 0;
+	ip->exts_len = 0;
 	return 1;
 
 error:
@@ -280,8 +285,6 @@ uint8_t * ip_get_next_layer(const struct ip_packet *const ip)
 uint8_t * ip_get_next_ext_from_ip(const struct ip_packet *const ip,
                                   uint8_t *const type)
 {
-	uint8_t *next_header;
-
 	/* function does not handle non-IPv4/IPv6 packets */
 	assert(ip->version != IP_UNKNOWN);
 
@@ -290,18 +293,15 @@ uint8_t * ip_get_next_ext_from_ip(const struct ip_packet *const ip,
 		return NULL;
 	}
 
-	/* get the next header data in the IP packet */
-	next_header = ip_get_next_header(ip, type);
-
-	if(rohc_is_ipv6_opt(*type))
-	{
-		/* known extension headers */
-		return next_header;
-	}
-	else
+	/* the extensions were found when the packet was created */
+	*type = ip->nh.proto;
+	if(ip->exts_nr == 0)
 	{
 		return NULL;
 	}
+	assert(ip->exts[0].type == (*type));
+
+	return (((uint8_t *) ip->data) + ip->exts[0].offset);
 }
 
 
@@ -362,19 +362,8 @@ unsigned short ip_get_extension_size(const uint8_t *const ext)
  */
 unsigned short ip_get_total_extension_size(const struct ip_packet *const ip)
 {
-	uint8_t *ext;
-	uint8_t next_hdr_type;
-	unsigned short total_ext_size = 0;
-
-	/* TODO: not very performant */
-	ext = ip_get_next_ext_from_ip(ip, &next_hdr_type);
-	while(ext != NULL)
-	{
-		total_ext_size += ip_get_extension_size(ext);
-		ext = ip_get_next_ext_from_ext(ext, &next_hdr_type);
-	}
-
-	return total_ext_size;
+	/* the extensions were found when the packet was created */
+	return ip->exts_len;
 }
 
 
@@ -985,7 +974,7 @@ const struct ipv6_addr * ipv6_get_daddr(const struct ip_packet *const ip)
  * @return         true if all extensions are well-formed,
  *                 false otherwise
  */
-static bool ip_find_next_layer(const struct ip_packet *const ip,
+static bool ip_find_next_layer(struct ip_packet *const ip,
                                struct net_hdr *const nh,
                                struct net_hdr *const nl)
 {
@@ -1009,6 +998,8 @@ static bool ip_find_next_layer(const struct ip_packet *const ip,
 		nl->proto = nh->proto;
 		nl->data = nh->data;
 		nl->len = nh->len;
+		ip->exts_nr = 0;
+		ip->exts_len = 0;
 	}
 	else if(ip->version == IPV6)
 	{
@@ -1023,7 +1014,7 @@ static bool ip_find_next_layer(const struct ip_packet *const ip,
 		nh->len = ip->size - sizeof(struct ipv6_hdr);
 
 		/* find next layer after IPv6 extension headers */
-		if(!ext_get_next_layer(nh, nl))
+		if(!ext_get_next_layer(ip, nh, nl))
 		{
 			goto error;
 		}
@@ -1043,62 +1034,70 @@ error:
 /**
  * @brief Find the next layer transported by an IP extension
  *
+ * The extension headers are recorded in the IP packet on the way, so that
+ * the other functions that handle them do not walk the chain again.
+ *
+ * @param ip       The IP packet that contains the extensions
  * @param nh       The first IP extension
  * @param[out] nl  The next layer
  * @return         true if all extensions are well-formed,
  *                 false otherwise
  */
-static bool ext_get_next_layer(const struct net_hdr *const nh,
+static bool ext_get_next_layer(struct ip_packet *const ip,
+                               const struct net_hdr *const nh,
                                struct net_hdr *const nl)
 {
-	uint8_t ext_types_count[ROHC_IPPROTO_MAX + 1] = { 0 };
-	unsigned int ext_type;
 	size_t remain_len = nh->len;
-	size_t ext_nr = 0;
 
 	nl->proto = nh->proto;
 	nl->data = nh->data;
 	nl->len = nh->len;
+	ip->exts_nr = 0;
 
 	/* parse packet until all extension headers are parsed */
 	while(rohc_is_ipv6_opt(nl->proto))
 	{
-		if(ext_types_count[nl->proto] >= 255)
+		struct ip_ext *const ext = &(ip->exts[ip->exts_nr]);
+		size_t same_type_nr = 0;
+		size_t i;
+
+		/* RFC 2460 §4.1 reads:
+		 *   Each extension header should occur at most once, except for the Destination
+		 *   Options header which should occur at most twice (once before a Routing
+		 *   header and once before the upper-layer header).
+		 * so a well-formed packet never contains more than IP_EXTS_MAX
+		 * extension headers */
+		for(i = 0; i < ip->exts_nr; i++)
+		{
+			same_type_nr += (ip->exts[i].type == nl->proto);
+		}
+		if(same_type_nr >= (nl->proto == ROHC_IPPROTO_DSTOPTS ? 2 : 1))
 		{
 			return false;
 		}
-		ext_types_count[nl->proto]++;
-		ext_nr++;
+		assert(ip->exts_nr < IP_EXTS_MAX);
 
 		/* RFC 2460 §4 reads:
 		 *   The Hop-by-Hop Options header, when present, must immediately follow
 		 *   the IPv6 header. */
-		if(nl->proto == ROHC_IPPROTO_HOPOPTS && ext_nr != 1)
+		if(nl->proto == ROHC_IPPROTO_HOPOPTS && ip->exts_nr != 0)
 		{
 			return false;
 		}
 
 		/* parse extension header */
+		ext->type = nl->proto;
+		ext->offset = nl->data - ip->data;
 		if(!ext_get_next_header(nl->data, remain_len, nl))
 		{
 			return false;
 		}
+		ext->len = nl->len;
 		remain_len -= nl->len;
+		ip->exts_nr++;
 	}
 	nl->len = remain_len;
-
-	/* RFC 2460 §4.1 reads:
-	 *   Each extension header should occur at most once, except for the Destination
-	 *   Options header which should occur at most twice (once before a Routing
-	 *   header and once before the upper-layer header). */
-	for(ext_type = 0; ext_type <= ROHC_IPPROTO_MAX; ext_type++)
-	{
-		if((ext_type == ROHC_IPPROTO_DSTOPTS && ext_types_count[ext_type] > 2) ||
-		   (ext_type != ROHC_IPPROTO_DSTOPTS && ext_types_count[ext_type] > 1))
-		{
-			return false;
-		}
-	}
+	ip->exts_len = nh->len - remain_len;
 
 	return true;
 }
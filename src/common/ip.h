@@ -29,6 +29,7 @@
 
 #include "protocols/ipv4.h"
 #include "protocols/ipv6.h"
+#include "rohc_csum.h"
 
 #include <stdlib.h>
 #include <stdint.h>
@@ -74,6 +75,25 @@ struct net_hdr
 };
 
 
+/**
+ * @brief The max number of IPv6 extension headers in one IP packet
+ *
+ * Every type of extension header occurs at most once, except for the
+ * Destination Options header that occurs at most twice (RFC 2460 §4.1): the
+ * IPv6 packets with more extension headers are malformed.
+ */
+#define IP_EXTS_MAX  10U
+
+
+/** One IPv6 extension header of an IP packet */
+struct ip_ext
+{
+	uint8_t type;     /**< The type of the extension header */
+	uint16_t offset;  /**< The offset of the extension header in the packet */
+	uint16_t len;     /**< The length of the extension header (in bytes) */
+};
+
+
 /**
  * @brief Defines an IP-agnostic packet that can handle
  *        an IPv4 or IPv6 packet
@@ -100,6 +120,12 @@ struct ip_packet
 
 	struct net_hdr nh;  /**< The next header (extension headers included) */
 	struct net_hdr nl;  /**< The next layer (extension headers excluded) */
+
+	/** The IPv6 extension headers, found once for all when the packet is
+	 *  created, in the order of the packet */
+	struct ip_ext exts[IP_EXTS_MAX];
+	uint8_t exts_nr;   /**< The number of IPv6 extension headers */
+	size_t exts_len;   /**< The length of all the IPv6 extension headers */
 };
 
 
@@ -124,160 +150,24 @@ static inline uint16_t swab16(const uint16_t value)
 }
 
 
-#if defined(__i386__) || defined(__x86_64__)
-
-static inline uint16_t ip_fast_csum(const uint8_t *iph,
+static inline uint16_t ip_fast_csum(const uint8_t *const iph,
                                     const size_t ihl)
 	__attribute__((nonnull(1), warn_unused_result, pure));
 
 /**
- * @brief This is a version of ip_compute_csum() optimized for IP headers,
- *        which always checksum on 4 octet boundaries.
- *
- * @author Jorge Cwik <jorge@laser.satlink.net>, adapted for linux by
- *         Arnt Gulbrandsen.
+ * @brief Compute the checksum of one IPv4 header
  *
  * @param iph The IPv4 header
- * @param ihl The length of the IPv4 header
+ * @param ihl The length of the IPv4 header (in 32-bit words)
  * @return    The IPv4 checksum
  */
-static inline uint16_t ip_fast_csum(const uint8_t *iph,
-                                    const size_t ihl)
-{
-	uint32_t __ihl = ihl;
-	uint32_t sum;
-
-	__asm__ __volatile__(
-	   " \n\
-       movl (%1), %0      \n\
-       subl $4, %2		\n\
-       jbe 2f		\n\
-       addl 4(%1), %0	\n\
-       adcl 8(%1), %0	\n\
-       adcl 12(%1), %0	\n\
-1:     adcl 16(%1), %0	\n\
-       lea 4(%1), %1	\n\
-       decl %2		\n\
-       jne 1b		\n\
-       adcl $0, %0		\n\
-       movl %0, %2		\n\
-       shrl $16, %0	\n\
-       addw %w2, %w0	\n\
-       adcl $0, %0		\n\
-       notl %0		\n\
-2:     \n\
-       "
-	   /* Since the input registers which are loaded with iph and ihl
-	      are modified, we must also specify them as outputs, or gcc
-	      will assume they contain their original values. */
-		: "=r" (sum), "=r" (iph), "=r" (__ihl)
-		: "1" (iph), "2" (__ihl)
-		: "memory");
-
-	return (uint16_t) (sum & 0xffff);
-}
-
-
-#else
-
-static inline uint16_t from32to16(const uint32_t x)
-	__attribute__((warn_unused_result, const));
-
-static inline uint16_t from32to16(const uint32_t x)
-{
-	uint32_t y;
-	/* add up 16-bit and 16-bit for 16+c bit */
-	y = (x & 0xffff) + (x >> 16);
-	/* add up carry.. */
-	y = (y & 0xffff) + (y >> 16);
-	return y;
-}
-
-static inline uint16_t ip_fast_csum(const uint8_t *const iph,
-                                    const size_t ihl)
-	__attribute__((nonnull(1), warn_unused_result, pure));
-
-/**
- *  This is a version of ip_compute_csum() optimized for IP headers,
- *  which always checksum on 4 octet boundaries.
- */
 static inline uint16_t ip_fast_csum(const uint8_t *const iph,
                                     const size_t ihl)
 {
-	const uint8_t *buff = iph;
-	size_t len = ihl * 4;
-	bool odd;
-	size_t count;
-	uint32_t result = 0;
-
-	if(len == 0)
-	{
-		goto out;
-	}
-	odd = 1 & (uintptr_t) buff;
-	if(odd)
-	{
-#ifdef __LITTLE_ENDIAN
-		result = *buff;
-#else
-		result += (*buff << 8);
-#endif
-		len--;
-		buff++;
-	}
-	count = len >> 1; /* nr of 16-bit words.. */
-	if(count)
-	{
-		if(2 & (uintptr_t) buff)
-		{
-			result += *(uint16_t *) buff;
-			count--;
-			len -= 2;
-			buff += 2;
-		}
-		count >>= 1; /* nr of 32-bit words.. */
-		if(count)
-		{
-			uint32_t carry = 0;
-			do
-			{
-				uint32_t word = *(uint32_t *) buff;
-				count--;
-				buff += sizeof(uint32_t);
-				result += carry;
-				result += word;
-				carry = (word > result);
-			}
-			while(count);
-			result += carry;
-			result = (result & 0xffff) + (result >> 16);
-		}
-		if(len & 2)
-		{
-			result += *(uint16_t *) buff;
-			buff += 2;
-		}
-	}
-	if(len & 1)
-	{
-#ifdef __LITTLE_ENDIAN
-		result += *buff;
-#else
-		result += (*buff << 8);
-#endif
-	}
-	result = from32to16(result);
-	if(odd)
-	{
-		result = ((result >> 8) & 0xff) | ((result & 0xff) << 8);
-	}
-out:
-	return ~result;
+	return (uint16_t) ~rohc_csum_sum(iph, ihl * sizeof(uint32_t));
 }
 
 
-#endif /* !__i386__ && !__x86_64__ */
-
 #else /* !__KERNEL__ */
 #  include <asm/checksum.h>
 #endif /* __KERNEL__ */
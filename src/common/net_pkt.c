@@ -26,16 +26,41 @@
 #include "net_pkt.h"
 
 #include "protocols/ip_numbers.h"
+#include "protocols/udp.h"
+#include "protocols/tcp.h"
+#include "protocols/esp.h"
 #include "rohc_traces_internal.h"
 
 
+static rohc_ctxt_key_t net_pkt_key_ip(rohc_ctxt_key_t key,
+                                      const struct ip_packet *const ip)
+	__attribute__((warn_unused_result, nonnull(2)));
+static rohc_ctxt_key_t net_pkt_key_ip_addrs(rohc_ctxt_key_t key,
+                                            const struct ip_packet *const ip)
+	__attribute__((warn_unused_result, nonnull(2)));
+static rohc_ctxt_key_t net_pkt_key_ip_pair(rohc_ctxt_key_t key,
+                                           const struct ip_packet *const ip)
+	__attribute__((warn_unused_result, nonnull(2)));
+static bool net_pkt_fprint_ip(struct net_pkt_fprint *const fprint,
+                              const struct ip_packet *const ip)
+	__attribute__((warn_unused_result, nonnull(1, 2)));
+static void net_pkt_parse_hdrs(struct net_pkt *const packet)
+	__attribute__((nonnull(1)));
+
+
 /**
  * @brief Parse a network packet
  *
  * @param[out] packet    The parsed packet
  * @param data           The data to parse
+ * @param key_seed       The seed for the hash key of the packet
+ * @param classify       Whether to build the key and the fingerprint of the
+ *                       flow, see \ref net_pkt_classify
  * @param trace_cb       The function to call for printing traces
  * @param trace_cb_priv  An optional private context, may be NULL
+ * @param trace_level    The minimum level of the traces to print
+ * @param trace_pkt_level The minimum level of the traces for the current
+ *                        packet, NULL if not sampled
  * @param trace_entity   The entity that emits the traces
  * @return               true if the packet was successfully parsed,
  *                       false if a problem occurred (a malformed packet is
@@ -43,18 +68,29 @@
  */
 bool net_pkt_parse(struct net_pkt *const packet,
                    const struct rohc_buf data,
+                   const rohc_ctxt_key_t key_seed,
+                   const bool classify,
                    rohc_trace_callback2_t trace_cb,
                    void *const trace_cb_priv,
+                   const rohc_trace_level_t trace_level,
+                   const rohc_trace_level_t *const trace_pkt_level,
                    rohc_trace_entity_t trace_entity)
 {
 	packet->data = rohc_buf_data(data);
 	packet->len = data.len;
 	packet->ip_hdr_nr = 0;
 	packet->key = 0;
+	packet->outer_key = 0;
+	packet->fprint.len = 0;
+	packet->is_classified = false;
+	packet->hdrs_nr = 0;
+	packet->ip_csums_verified = false;
 
 	/* traces */
 	packet->trace_callback = trace_cb;
 	packet->trace_callback_priv = trace_cb_priv;
+	packet->trace_level = trace_level;
+	packet->trace_pkt_level = trace_pkt_level;
 
 	/* create the outer IP packet from raw data */
 	if(!ip_create(&packet->outer_ip, rohc_buf_data(data), data.len))
@@ -81,26 +117,6 @@ bool net_pkt_parse(struct net_pkt *const packet,
 		}
 	}
 
-	/* build the hash key for the packet */
-	if(ip_get_version(&packet->outer_ip) == IPV4)
-	{
-		packet->key ^= ipv4_get_saddr(&packet->outer_ip);
-		packet->key ^= ipv4_get_daddr(&packet->outer_ip);
-	}
-	else if(ip_get_version(&packet->outer_ip) == IPV6)
-	{
-		const struct ipv6_addr *const saddr = ipv6_get_saddr(&packet->outer_ip);
-		const struct ipv6_addr *const daddr = ipv6_get_daddr(&packet->outer_ip);
-		packet->key ^= saddr->u32[0];
-		packet->key ^= saddr->u32[1];
-		packet->key ^= saddr->u32[2];
-		packet->key ^= saddr->u32[3];
-		packet->key ^= daddr->u32[0];
-		packet->key ^= daddr->u32[1];
-		packet->key ^= daddr->u32[2];
-		packet->key ^= daddr->u32[3];
-	}
-
 	/* get the transport protocol */
 	packet->transport = &packet->outer_ip.nl;
 
@@ -136,6 +152,32 @@ bool net_pkt_parse(struct net_pkt *const packet,
 		packet->transport = &packet->inner_ip.nl;
 	}
 
+	/* the IP payload begins after the innermost IP header and its extension
+	 * headers, the length of the transport header depends on the profile */
+	packet->ip_payload_offset = 0;
+	if(packet->outer_ip.version == IPV4 || packet->outer_ip.version == IPV6)
+	{
+		packet->ip_payload_offset += ip_get_hdrlen(&packet->outer_ip) +
+		                             ip_get_total_extension_size(&packet->outer_ip);
+		if(packet->ip_hdr_nr > 1 &&
+		   (packet->inner_ip.version == IPV4 || packet->inner_ip.version == IPV6))
+		{
+			packet->ip_payload_offset += ip_get_hdrlen(&packet->inner_ip) +
+			                             ip_get_total_extension_size(&packet->inner_ip);
+		}
+	}
+
+	/* record the offsets of all the headers for the compression profiles */
+	net_pkt_parse_hdrs(packet);
+	rohc_debug(packet, trace_entity, ROHC_PROFILE_GENERAL,
+	           "%zu headers recorded in packet descriptor", packet->hdrs_nr);
+
+	/* build the key and the fingerprint of the flow if requested */
+	if(classify)
+	{
+		net_pkt_classify(packet, key_seed);
+	}
+
 	return true;
 
 error:
@@ -144,30 +186,374 @@ error:
 
 
 /**
- * @brief Get the offset of the IP payload in the given packet
+ * @brief Build the key and the fingerprint of the flow of a parsed packet
  *
- * The payload begins after the innermost IP header (and its extension headers).
+ * The key and the fingerprint are only required to find the context of the
+ * packet, so they may be built later than the packet is parsed, or never if
+ * the context of the packet is already known.
  *
- * @param packet  The packet to get the payload offset for
- * @return        The payload offset (in bytes)
+ * @param[in,out] packet  The parsed packet
+ * @param key_seed        The seed for the hash key of the packet
  */
-size_t net_pkt_get_payload_offset(const struct net_pkt *const packet)
+void net_pkt_classify(struct net_pkt *const packet,
+                      const rohc_ctxt_key_t key_seed)
 {
-	size_t payload_offset;
+	/* build the hash key for the packet: source and destination addresses
+	 * are hashed in order, so both directions of one flow get different
+	 * keys */
+	packet->key = net_pkt_key_mix(key_seed, packet->ip_hdr_nr);
+	packet->key = net_pkt_key_ip(packet->key, &packet->outer_ip);
+	if(packet->ip_hdr_nr > 1)
+	{
+		packet->key = net_pkt_key_ip(packet->key, &packet->inner_ip);
+	}
+	packet->key = net_pkt_key_mix(packet->key, packet->transport->proto);
+	packet->key = net_pkt_key_final(packet->key);
+	packet->outer_key = net_pkt_key_ip_pair(key_seed, &packet->outer_ip);
+	packet->outer_key = net_pkt_key_final(packet->outer_key);
 
-	/* outer IP header (and its extension headers) if any */
-	payload_offset = ip_get_hdrlen(&packet->outer_ip) +
-	                 ip_get_total_extension_size(&packet->outer_ip);
+	/* build the flow fingerprint from the same fields, in the same order:
+	 * number of IP headers, IP headers, then transport protocol */
+	memset(&packet->fprint, 0, sizeof(struct net_pkt_fprint));
+	packet->fprint.data[packet->fprint.len++] = packet->ip_hdr_nr;
+	if(!net_pkt_fprint_ip(&packet->fprint, &packet->outer_ip) ||
+	   (packet->ip_hdr_nr > 1 &&
+	    !net_pkt_fprint_ip(&packet->fprint, &packet->inner_ip)) ||
+	   packet->fprint.len >= NET_PKT_FPRINT_MAX_LEN)
+	{
+		/* the IP headers do not fit in the fingerprint */
+		memset(&packet->fprint, 0, sizeof(struct net_pkt_fprint));
+	}
+	else
+	{
+		packet->fprint.data[packet->fprint.len++] = packet->transport->proto;
+	}
 
-	/* inner IP header (and its extension headers) if any */
-	if(packet->ip_hdr_nr > 1)
+	packet->is_classified = true;
+}
+
+
+/**
+ * @brief Mix the fields of one IP header into the given packet key
+ *
+ * @param key  The current packet key
+ * @param ip   The IP header to get the version, addresses and Flow Label from
+ * @return     The new packet key
+ */
+static rohc_ctxt_key_t net_pkt_key_ip(rohc_ctxt_key_t key,
+                                      const struct ip_packet *const ip)
+{
+	key = net_pkt_key_ip_addrs(key, ip);
+	if(ip_get_version(ip) == IPV6)
 	{
-		payload_offset += ip_get_hdrlen(&packet->inner_ip) +
-		                  ip_get_total_extension_size(&packet->inner_ip);
+		key = net_pkt_key_mix(key, ip_get_flow_label(ip));
 	}
 
-	/* the length of the transport header depends on the compression profile */
+	return key;
+}
+
+
+/**
+ * @brief Mix the version and addresses of one IP header into the given key
+ *
+ * @param key  The current packet key
+ * @param ip   The IP header to get the version and addresses from
+ * @return     The new packet key
+ */
+static rohc_ctxt_key_t net_pkt_key_ip_addrs(rohc_ctxt_key_t key,
+                                            const struct ip_packet *const ip)
+{
+	const ip_version version = ip_get_version(ip);
 
-	return payload_offset;
+	/* malformed or unknown IP headers do not change the key, so that all the
+	 * data that is not IP shares one context as it always did */
+	if(version == IPV4)
+	{
+		key = net_pkt_key_mix(key, version);
+		key = net_pkt_key_mix(key, ipv4_get_saddr(ip));
+		key = net_pkt_key_mix(key, ipv4_get_daddr(ip));
+	}
+	else if(version == IPV6)
+	{
+		const struct ipv6_addr *const saddr = ipv6_get_saddr(ip);
+		const struct ipv6_addr *const daddr = ipv6_get_daddr(ip);
+		size_t i;
+
+		key = net_pkt_key_mix(key, version);
+		for(i = 0; i < 4; i++)
+		{
+			key = net_pkt_key_mix(key, saddr->u32[i]);
+		}
+		for(i = 0; i < 4; i++)
+		{
+			key = net_pkt_key_mix(key, daddr->u32[i]);
+		}
+	}
+
+	return key;
+}
+
+
+/**
+ * @brief Mix the version and the pair of addresses of one IP header into the
+ *        given key
+ *
+ * The source and destination addresses are combined before they are mixed
+ * into the key, so both directions of one flow get the same key.
+ *
+ * @param key  The current packet key
+ * @param ip   The IP header to get the version and addresses from
+ * @return     The new packet key
+ */
+static rohc_ctxt_key_t net_pkt_key_ip_pair(rohc_ctxt_key_t key,
+                                           const struct ip_packet *const ip)
+{
+	const ip_version version = ip_get_version(ip);
+
+	if(version == IPV4)
+	{
+		key = net_pkt_key_mix(key, version);
+		key = net_pkt_key_mix(key, ipv4_get_saddr(ip) ^ ipv4_get_daddr(ip));
+	}
+	else if(version == IPV6)
+	{
+		const struct ipv6_addr *const saddr = ipv6_get_saddr(ip);
+		const struct ipv6_addr *const daddr = ipv6_get_daddr(ip);
+		size_t i;
+
+		key = net_pkt_key_mix(key, version);
+		for(i = 0; i < 4; i++)
+		{
+			key = net_pkt_key_mix(key, saddr->u32[i] ^ daddr->u32[i]);
+		}
+	}
+
+	return key;
 }
 
+
+/**
+ * @brief Append the fields of one IP header to the given flow fingerprint
+ *
+ * @param fprint  The flow fingerprint to append the fields to
+ * @param ip      The IP header to get the version, addresses and Flow Label from
+ * @return        true if the fields were appended,
+ *                false if the IP header is not IPv4 nor IPv6, or if the
+ *                fields do not fit in the fingerprint
+ */
+static bool net_pkt_fprint_ip(struct net_pkt_fprint *const fprint,
+                              const struct ip_packet *const ip)
+{
+	const ip_version version = ip_get_version(ip);
+
+	if(version == IPV4)
+	{
+		const uint32_t saddr = ipv4_get_saddr(ip);
+		const uint32_t daddr = ipv4_get_daddr(ip);
+
+		if((fprint->len + 1 + sizeof(uint32_t) * 2) > NET_PKT_FPRINT_MAX_LEN)
+		{
+			goto error;
+		}
+		fprint->data[fprint->len++] = version;
+		memcpy(fprint->data + fprint->len, &saddr, sizeof(uint32_t));
+		fprint->len += sizeof(uint32_t);
+		memcpy(fprint->data + fprint->len, &daddr, sizeof(uint32_t));
+		fprint->len += sizeof(uint32_t);
+	}
+	else if(version == IPV6)
+	{
+		const uint32_t flow_label = ip_get_flow_label(ip);
+
+		if((fprint->len + 1 + sizeof(struct ipv6_addr) * 2 +
+		    sizeof(uint32_t)) > NET_PKT_FPRINT_MAX_LEN)
+		{
+			goto error;
+		}
+		fprint->data[fprint->len++] = version;
+		memcpy(fprint->data + fprint->len, ipv6_get_saddr(ip),
+		       sizeof(struct ipv6_addr));
+		fprint->len += sizeof(struct ipv6_addr);
+		memcpy(fprint->data + fprint->len, ipv6_get_daddr(ip),
+		       sizeof(struct ipv6_addr));
+		fprint->len += sizeof(struct ipv6_addr);
+		memcpy(fprint->data + fprint->len, &flow_label, sizeof(uint32_t));
+		fprint->len += sizeof(uint32_t);
+	}
+	else
+	{
+		goto error;
+	}
+
+	return true;
+
+error:
+	return false;
+}
+
+
+/**
+ * @brief Record the offsets and lengths of the headers of the given packet
+ *
+ * The IP headers with their IPv6 extension headers (Hop-by-Hop, Routing and
+ * Destination options only) are recorded from the outermost to the innermost,
+ * then the transport header. The transport header is recorded only if it is
+ * complete (TCP options included); its length is 0 if the protocol is not
+ * known. The recording stops at the first header that is truncated, that is
+ * not supported, that follows an IPv4 fragment, or that does not fit in the
+ * descriptor.
+ *
+ * @param packet  The packet to record the headers for
+ */
+static void net_pkt_parse_hdrs(struct net_pkt *const packet)
+{
+	size_t offset = 0;
+	uint8_t proto;
+	bool is_ipv6 = false;
+
+	packet->hdrs_nr = 0;
+
+	/* the type of the outermost header is given by the IP version */
+	if(packet->len < 1 || packet->len > 0xffff)
+	{
+		return;
+	}
+	else if((packet->data[0] >> 4) == IPV4)
+	{
+		proto = ROHC_IPPROTO_IPIP;
+	}
+	else if((packet->data[0] >> 4) == IPV6)
+	{
+		proto = ROHC_IPPROTO_IPV6;
+	}
+	else
+	{
+		return;
+	}
+
+	while(packet->hdrs_nr < NET_PKT_HDRS_MAX)
+	{
+		struct net_pkt_hdr *const hdr = &(packet->hdrs[packet->hdrs_nr]);
+		const uint8_t *const hdr_data = packet->data + offset;
+		const size_t remain_len = packet->len - offset;
+		uint8_t next_proto;
+		bool is_last = false;
+		size_t hdr_len;
+
+		if(rohc_is_tunneling(proto))
+		{
+			/* IPv4 or IPv6 header, whatever the protocol that announced it */
+			if(remain_len < 1)
+			{
+				break;
+			}
+			else if((hdr_data[0] >> 4) == IPV4)
+			{
+				const struct ipv4_hdr *const ipv4 = (struct ipv4_hdr *) hdr_data;
+
+				if(remain_len < sizeof(struct ipv4_hdr))
+				{
+					break;
+				}
+				hdr_len = ipv4->ihl * sizeof(uint32_t);
+				if(hdr_len < sizeof(struct ipv4_hdr) || hdr_len > remain_len)
+				{
+					break;
+				}
+				proto = ROHC_IPPROTO_IPIP;
+				next_proto = ipv4->protocol;
+				is_ipv6 = false;
+				is_last = ipv4_is_fragment(ipv4);
+			}
+			else if((hdr_data[0] >> 4) == IPV6)
+			{
+				const struct ipv6_hdr *const ipv6 = (struct ipv6_hdr *) hdr_data;
+
+				if(remain_len < sizeof(struct ipv6_hdr))
+				{
+					break;
+				}
+				hdr_len = sizeof(struct ipv6_hdr);
+				proto = ROHC_IPPROTO_IPV6;
+				next_proto = ipv6->nh;
+				is_ipv6 = true;
+			}
+			else
+			{
+				break;
+			}
+		}
+		else if(is_ipv6 &&
+		        (proto == ROHC_IPPROTO_HOPOPTS ||
+		         proto == ROHC_IPPROTO_ROUTING ||
+		         proto == ROHC_IPPROTO_DSTOPTS))
+		{
+			/* IPv6 extension header with the generic format */
+			const struct ipv6_opt *const ipv6_opt = (struct ipv6_opt *) hdr_data;
+
+			if(remain_len < 2)
+			{
+				break;
+			}
+			hdr_len = ipv6_opt_get_length(ipv6_opt);
+			if(hdr_len > remain_len)
+			{
+				break;
+			}
+			next_proto = ipv6_opt->next_header;
+		}
+		else if(is_ipv6 && rohc_is_ipv6_opt(proto))
+		{
+			/* other IPv6 extension headers are not supported */
+			break;
+		}
+		else
+		{
+			/* transport header */
+			if(proto == ROHC_IPPROTO_TCP)
+			{
+				const struct tcphdr *const tcp = (struct tcphdr *) hdr_data;
+
+				if(remain_len < sizeof(struct tcphdr))
+				{
+					break;
+				}
+				hdr_len = tcp->data_offset * sizeof(uint32_t);
+				if(hdr_len < sizeof(struct tcphdr) || hdr_len > remain_len)
+				{
+					break;
+				}
+			}
+			else if(proto == ROHC_IPPROTO_UDP || proto == ROHC_IPPROTO_UDPLITE)
+			{
+				hdr_len = sizeof(struct udphdr);
+			}
+			else if(proto == ROHC_IPPROTO_ESP)
+			{
+				hdr_len = sizeof(struct esphdr);
+			}
+			else
+			{
+				hdr_len = 0;
+			}
+			if(hdr_len > remain_len)
+			{
+				break;
+			}
+			next_proto = proto;
+			is_last = true;
+		}
+
+		hdr->offset = offset;
+		hdr->len = hdr_len;
+		hdr->proto = proto;
+		packet->hdrs_nr++;
+
+		if(is_last)
+		{
+			break;
+		}
+		offset += hdr_len;
+		proto = next_proto;
+	}
+}
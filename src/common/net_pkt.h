@@ -32,7 +32,60 @@
 
 
 /** The key to help identify (not quaranted unique) a compression context */
-typedef uint32_t rohc_ctxt_key_t;
+typedef uint64_t rohc_ctxt_key_t;
+
+
+/**
+ * @brief The maximum length (in bytes) of the flow fingerprint of a packet
+ *
+ * Large enough for one IPv6 header, for two IPv4 headers, or for one IPv4
+ * header and one IPv6 header.
+ */
+#define NET_PKT_FPRINT_MAX_LEN  48U
+
+
+/**
+ * @brief The flow fingerprint of one packet
+ *
+ * The fingerprint holds the fields of the IP headers that are hashed in the
+ * key of the packet: number of IP headers, IP versions, source and
+ * destination addresses, IPv6 Flow Labels and transport protocol. The unused
+ * bytes are zeroed, so two fingerprints are compared with one memcmp().
+ *
+ * The fingerprint is empty if the packet is not IPv4 nor IPv6, or if its IP
+ * headers do not fit in \ref NET_PKT_FPRINT_MAX_LEN bytes.
+ */
+struct net_pkt_fprint
+{
+	uint8_t len;  /**< The length of the fingerprint, 0 if empty */
+	uint8_t data[NET_PKT_FPRINT_MAX_LEN]; /**< The fingerprint bytes */
+};
+
+
+/**
+ * @brief The maximum number of headers recorded in the descriptor of a
+ *        network packet
+ *
+ * Large enough for the IP headers, the IPv6 extension headers and the
+ * transport header of any packet the TCP profile accepts in practice.
+ */
+#define NET_PKT_HDRS_MAX  24U
+
+
+/**
+ * @brief One header recorded in the descriptor of a network packet
+ *
+ * The type of the header is the IP protocol number that announces it:
+ * ROHC_IPPROTO_IPIP for IPv4 headers, ROHC_IPPROTO_IPV6 for IPv6 headers,
+ * the extension type for IPv6 extension headers, and the transport protocol
+ * for the last header.
+ */
+struct net_pkt_hdr
+{
+	uint16_t offset;  /**< The offset (in bytes) of the header in the packet */
+	uint16_t len;     /**< The length (in bytes) of the header, 0 if unknown */
+	uint8_t proto;    /**< The type of the header */
+};
 
 
 /** One network packet */
@@ -46,25 +99,146 @@ struct net_pkt
 	struct ip_packet inner_ip;   /**< The inner IP header if any */
 
 	struct net_hdr *transport;   /**< The transport layer of the packet if any */
-
-	rohc_ctxt_key_t key;         /**< The hash key of the packet */
+	/** The offset (in bytes) of the IP payload, computed once while the
+	 *  packet is parsed */
+	size_t ip_payload_offset;
+
+	/** The headers of the packet, recorded once while the packet is parsed:
+	 *  all the IP headers with their IPv6 extension headers, then the
+	 *  transport header. The recording stops at the first header that is
+	 *  truncated or that is not supported, so the last one is the transport
+	 *  header only if the whole chain was parsed. */
+	struct net_pkt_hdr hdrs[NET_PKT_HDRS_MAX];
+	size_t hdrs_nr;              /**< The number of recorded headers */
+
+	/** The seeded hash of the IP headers of the packet: IP versions, source
+	 *  and destination addresses, IPv6 Flow Labels and transport protocol */
+	rohc_ctxt_key_t key;
+	/** The seeded hash of the pair of source and destination addresses of the
+	 *  outermost IP header only, the same in both directions of the flow */
+	rohc_ctxt_key_t outer_key;
+	/** The flow fingerprint of the packet, built along the key */
+	struct net_pkt_fprint fprint;
+	/** Whether the key and the fingerprint were built, see
+	 *  \ref net_pkt_classify */
+	bool is_classified;
+
+	/** Whether the checksums of the IPv4 headers were already verified, see
+	 *  \ref ROHC_COMP_PKT_IP_CSUM_VERIFIED */
+	bool ip_csums_verified;
 
 	/** The callback function used to manage traces */
 	rohc_trace_callback2_t trace_callback;
 	/** The private context of the callback function used to manage traces */
 	void *trace_callback_priv;
+	/** The minimum level of the traces given to the callback function */
+	rohc_trace_level_t trace_level;
+	/** The minimum level of the traces for the current packet, chosen by
+	 *  the trace sampling of the owner, NULL if not sampled */
+	const rohc_trace_level_t *trace_pkt_level;
 };
 
 
 bool net_pkt_parse(struct net_pkt *const packet,
                    const struct rohc_buf data,
+                   const rohc_ctxt_key_t key_seed,
+                   const bool classify,
                    rohc_trace_callback2_t trace_cb,
                    void *const trace_cb_priv,
+                   const rohc_trace_level_t trace_level,
+                   const rohc_trace_level_t *const trace_pkt_level,
                    rohc_trace_entity_t trace_entity)
 	__attribute__((warn_unused_result, nonnull(1)));
 
-size_t net_pkt_get_payload_offset(const struct net_pkt *const packet)
-	__attribute__((warn_unused_result, nonnull(1)));
+void net_pkt_classify(struct net_pkt *const packet,
+                      const rohc_ctxt_key_t key_seed)
+	__attribute__((nonnull(1)));
+
+static inline rohc_ctxt_key_t net_pkt_key_mix(const rohc_ctxt_key_t key,
+                                              const uint32_t word)
+	__attribute__((warn_unused_result, const));
+static inline rohc_ctxt_key_t net_pkt_key_final(const rohc_ctxt_key_t key)
+	__attribute__((warn_unused_result, const));
+static inline bool net_pkt_fprint_cmp(const struct net_pkt_fprint *const fprint1,
+                                      const struct net_pkt_fprint *const fprint2,
+                                      bool *const are_equal)
+	__attribute__((warn_unused_result, nonnull(1, 2, 3)));
+static inline size_t net_pkt_get_payload_offset(const struct net_pkt *const packet)
+	__attribute__((warn_unused_result, nonnull(1), pure));
+
+
+/**
+ * @brief Mix a 32-bit word into the given packet key
+ *
+ * @param key   The current packet key
+ * @param word  The 32-bit word to mix into the key
+ * @return      The new packet key
+ */
+static inline rohc_ctxt_key_t net_pkt_key_mix(const rohc_ctxt_key_t key,
+                                              const uint32_t word)
+{
+	rohc_ctxt_key_t new_key = (key ^ word) * 0x9e3779b97f4a7c15ULL;
+	return new_key ^ (new_key >> 29);
+}
+
+
+/**
+ * @brief Finalize a packet key so that all its bits depend on all the words
+ *        mixed into it
+ *
+ * @param key  The packet key to finalize
+ * @return     The finalized packet key
+ */
+static inline rohc_ctxt_key_t net_pkt_key_final(const rohc_ctxt_key_t key)
+{
+	rohc_ctxt_key_t new_key = key;
+	new_key ^= new_key >> 33;
+	new_key *= 0xff51afd7ed558ccdULL;
+	new_key ^= new_key >> 33;
+	new_key *= 0xc4ceb9fe1a85ec53ULL;
+	new_key ^= new_key >> 33;
+	return new_key;
+}
+
+
+/**
+ * @brief Compare two flow fingerprints
+ *
+ * Two fingerprints of different lengths never describe the same flow, so
+ * the comparison is conclusive as soon as one of them is not empty.
+ *
+ * @param fprint1         The first fingerprint to compare
+ * @param fprint2         The second fingerprint to compare
+ * @param[out] are_equal  Whether the fingerprints are equal or not
+ * @return                true if the comparison is conclusive,
+ *                        false if both fingerprints are empty
+ */
+static inline bool net_pkt_fprint_cmp(const struct net_pkt_fprint *const fprint1,
+                                      const struct net_pkt_fprint *const fprint2,
+                                      bool *const are_equal)
+{
+	if(fprint1->len == 0 && fprint2->len == 0)
+	{
+		return false;
+	}
+	*are_equal = (memcmp(fprint1, fprint2, sizeof(struct net_pkt_fprint)) == 0);
+	return true;
+}
+
+
+/**
+ * @brief Get the offset of the IP payload in the given packet
+ *
+ * The payload begins after the innermost IP header (and its extension headers).
+ * The offset is computed once while the packet is parsed.
+ *
+ * @param packet  The packet to get the payload offset for
+ * @return        The payload offset (in bytes)
+ */
+static inline size_t net_pkt_get_payload_offset(const struct net_pkt *const packet)
+{
+	return packet->ip_payload_offset;
+}
 
 #endif
 
@@ -0,0 +1,119 @@
+/*
+ * Copyright 2016 Didier Barvaux
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/**
+ * @file   rfc5225.h
+ * @brief  The definitions shared by the ROHCv2 profiles (RFC 5225)
+ * @author Didier Barvaux <didier@barvaux.org>
+ */
+
+#ifndef ROHC_PROTOCOLS_RFC5225_H
+#define ROHC_PROTOCOLS_RFC5225_H
+
+#include <stdint.h>
+
+
+/**
+ * @brief The maximum number of IP headers supported by the ROHCv2 IP-only
+ *        profile
+ *
+ * RFC 5225 accepts any number of IP headers, but two are enough for the
+ * IP-in-IP tunnels met in practice.
+ */
+#define ROHC_RFC5225_MAX_IP_HDRS  2U
+
+
+/*
+ * The discriminators of the packet formats (RFC5225 §6.8.2.4)
+ */
+
+/** The discriminator of the IR packet */
+#define ROHC_RFC5225_IR_DISC           0xfdU
+/** The discriminator of the co_common packet */
+#define ROHC_RFC5225_CO_COMMON_DISC    0xfaU
+/** The 1-bit discriminator '0' of the pt_0_crc3 packet */
+#define ROHC_RFC5225_PT_0_CRC3_DISC    0x00U
+/** The mask of the discriminator of the pt_0_crc3 packet */
+#define ROHC_RFC5225_PT_0_CRC3_MASK    0x80U
+/** The 3-bit discriminator '100' of the pt_0_crc7 packet */
+#define ROHC_RFC5225_PT_0_CRC7_DISC    0x80U
+/** The mask of the discriminator of the pt_0_crc7 packet */
+#define ROHC_RFC5225_PT_0_CRC7_MASK    0xe0U
+/** The 4-bit discriminator '1010' of the pt_1_seq_id packet */
+#define ROHC_RFC5225_PT_1_SEQ_ID_DISC  0xa0U
+/** The mask of the discriminator of the pt_1_seq_id packet */
+#define ROHC_RFC5225_PT_1_SEQ_ID_MASK  0xf0U
+/** The 3-bit discriminator '110' of the pt_2_seq_id packet */
+#define ROHC_RFC5225_PT_2_SEQ_ID_DISC  0xc0U
+/** The mask of the discriminator of the pt_2_seq_id packet */
+#define ROHC_RFC5225_PT_2_SEQ_ID_MASK  0xe0U
+
+
+/*
+ * The discriminators of the packet formats of the RTP profile: the pt_0_crc7,
+ * pt_1_seq_id and pt_2_seq_id packets get one more discriminator bit than
+ * in the other profiles to make room for the pt_1_rnd and pt_2_rnd packets.
+ * The pt_0_crc3 and co_common packets keep their discriminators.
+ */
+
+/** The 4-bit discriminator '1000' of the pt_0_crc7 packet of the RTP profile */
+#define ROHC_RFC5225_RTP_PT_0_CRC7_DISC    0x80U
+/** The 4-bit discriminator '1001' of the pt_1_seq_id packet of the RTP profile */
+#define ROHC_RFC5225_RTP_PT_1_SEQ_ID_DISC  0x90U
+/** The 3-bit discriminator '101' of the pt_1_rnd packet of the RTP profile */
+#define ROHC_RFC5225_RTP_PT_1_RND_DISC     0xa0U
+/** The mask of the discriminator of the pt_1_rnd packet of the RTP profile */
+#define ROHC_RFC5225_RTP_PT_1_RND_MASK     0xe0U
+/** The 4-bit discriminator '1100' of the pt_2_rnd packet of the RTP profile */
+#define ROHC_RFC5225_RTP_PT_2_RND_DISC     0xc0U
+/** The 4-bit discriminator '1101' of the pt_2_seq_id packet of the RTP profile */
+#define ROHC_RFC5225_RTP_PT_2_SEQ_ID_DISC  0xd0U
+/** The mask of the 4-bit discriminators of the RTP profile */
+#define ROHC_RFC5225_RTP_4BIT_DISC_MASK    0xf0U
+
+
+/** How the co_common packet of the RTP profile transmits the RTP Timestamp */
+typedef enum
+{
+	/** TS not transmitted, the scaled TS is deduced from the MSN */
+	ROHC_RFC5225_RTP_TS_DEDUCED = 0,
+	/** The 8 LSB of the scaled TS are transmitted */
+	ROHC_RFC5225_RTP_TS_SCALED  = 1,
+	/** The whole 32-bit TS is transmitted */
+	ROHC_RFC5225_RTP_TS_FULL    = 2,
+} rohc_rfc5225_rtp_ts_ind_t;
+
+
+/** The behaviors of the IPv4 Identification field (RFC5225 §6.3.3) */
+typedef enum
+{
+	ROHC_RFC5225_IP_ID_SEQ      = 0, /**< IP-ID increases */
+	ROHC_RFC5225_IP_ID_SEQ_SWAP = 1, /**< IP-ID increases in little endian */
+	ROHC_RFC5225_IP_ID_RAND     = 2, /**< IP-ID is random */
+	ROHC_RFC5225_IP_ID_ZERO     = 3, /**< IP-ID is constant zero */
+} rohc_rfc5225_ip_id_behavior_t;
+
+
+/** The length (in bytes) of the IPv4 static part */
+#define ROHC_RFC5225_IPV4_STATIC_LEN   10U
+/** The length (in bytes) of the IPv6 static part with a Flow Label */
+#define ROHC_RFC5225_IPV6_STATIC_LEN   36U
+/** The length (in bytes) of the IPv6 static part without Flow Label */
+#define ROHC_RFC5225_IPV6_STATIC_LEN_NO_FL  34U
+
+#endif
@@ -35,6 +35,7 @@ extern "C"
 #include <stdlib.h>
 #ifndef __KERNEL__
 #  include <inttypes.h>
+#  include <stdbool.h>
 #endif
 
 
@@ -150,6 +151,17 @@ typedef enum
 #define ROHC_SMALL_CID_MAX  15U
 
 
+/**
+ * @brief The NUMA node value that lets the system place the memory
+ *
+ * @ingroup rohc
+ *
+ * @see rohc_comp_new3
+ * @see rohc_decomp_new3
+ */
+#define ROHC_NUMA_NODE_ANY  (-1)
+
+
 /**
  * @brief The different types of Context IDs (CID)
  *
@@ -231,11 +243,155 @@ typedef enum
 	/** The ROHC UDP-Lite profile (RFC 4019, section 7) */
 	ROHC_PROFILE_UDPLITE      = 0x0008,
 
-	ROHC_PROFILE_MAX          = 0x0009,
+	/** The ROHCv2 IP/UDP/RTP profile (RFC 5225, section 6) */
+	ROHCv2_PROFILE_IP_UDP_RTP = 0x0101,
+	/** The ROHCv2 IP/UDP profile (RFC 5225, section 6) */
+	ROHCv2_PROFILE_IP_UDP     = 0x0102,
+	/** The ROHCv2 IP/ESP profile (RFC 5225, section 6) */
+	ROHCv2_PROFILE_IP_ESP     = 0x0103,
+	/** The ROHCv2 IP-only profile (RFC 5225, section 6) */
+	ROHCv2_PROFILE_IP         = 0x0104,
+
+	ROHC_PROFILE_MAX          = 0x0105,
 
 } rohc_profile_t;
 
 
+/** The number of buckets of one histogram of timings */
+#define ROHC_TIMINGS_BUCKETS_NR  32U
+
+
+/**
+ * @brief The histogram of the durations of one processing phase
+ *
+ * The durations are measured in ticks of the fastest clock available: CPU
+ * cycles on x86 hosts and in the Linux kernel, nanoseconds otherwise.
+ * The bucket 0 counts the zero durations, the bucket n counts the durations
+ * in the range [2^(n-1), 2^n[ ticks, and the last bucket also counts all the
+ * longer durations.
+ *
+ * @ingroup rohc
+ *
+ * @see rohc_comp_get_timings
+ * @see rohc_decomp_get_timings
+ */
+typedef struct
+{
+	/** The number of durations measured */
+	uint64_t count;
+	/** The sum of the durations measured (in ticks) */
+	uint64_t total;
+	/** The number of durations measured in each bucket */
+	uint64_t buckets[ROHC_TIMINGS_BUCKETS_NR];
+} rohc_timings_histo_t;
+
+
+/**
+ * @brief One record of the log of the last packets
+ *
+ * The records are written by the compressor or the decompressor for every
+ * packet once the log is enabled, see \ref rohc_comp_set_pkt_log and
+ * \ref rohc_decomp_set_pkt_log. One record is 16-byte long.
+ *
+ * @ingroup rohc
+ *
+ * @see rohc_comp_get_pkt_log
+ * @see rohc_decomp_get_pkt_log
+ */
+typedef struct
+{
+	/** The number of the packet in the compressor or the decompressor (the
+	 *  32 least significant bits only) */
+	uint32_t packet_nr;
+	/** The Sequence Number (SN) or Master Sequence Number (MSN) of the
+	 *  packet, 0 if unknown */
+	uint32_t sn;
+	/** The Context ID (CID) of the packet, 0xffff if unknown */
+	uint16_t cid;
+	/** The profile of the context, see \ref rohc_profile_t, 0xffff if
+	 *  unknown */
+	uint16_t profile_id;
+	/** The type of the ROHC packet, see \ref rohc_packet_t */
+	uint8_t packet_type;
+	/** The number of SN bits that W-LSB encoding required (compressor only,
+	 *  0 if unknown) */
+	uint8_t sn_bits_nr;
+	/** The status of the compression or decompression of the packet, see
+	 *  \ref rohc_status_t: \ref ROHC_STATUS_BAD_CRC reports a packet that
+	 *  failed the CRC check */
+	uint8_t status;
+	/** Unused, always 0 */
+	uint8_t reserved;
+} rohc_pkt_log_record_t;
+
+
+
+/**
+ * @brief The CPU features the library may use to speed up its computations
+ *
+ * The features are combined in a mask: the features of the mask that the CPU
+ * supports are used.
+ *
+ * @ingroup rohc
+ *
+ * @see rohc_cpu_get_features
+ * @see rohc_cpu_set_features
+ */
+typedef enum
+{
+	/** No special feature, the generic computations are used */
+	ROHC_CPU_FEATURE_NONE   = 0,
+	/** The carry-less multiplication of the x86 CPUs (PCLMULQDQ) */
+	ROHC_CPU_FEATURE_PCLMUL = (1 << 0),
+	/** All the features the library knows about */
+	ROHC_CPU_FEATURE_ALL    = ROHC_CPU_FEATURE_PCLMUL,
+
+} rohc_cpu_features_t;
+
+
+/**
+ * @brief The computations of the library that have several variants
+ *
+ * @ingroup rohc
+ *
+ * @see rohc_cpu_get_variant
+ */
+typedef enum
+{
+	/** The CRC FCS-32 of the reassembled ROHC segments */
+	ROHC_CPU_KERNEL_FCS32 = 0,
+
+} rohc_cpu_kernel_t;
+
+
+/**
+ * @brief The prototype of the function that allocates memory for the library
+ *
+ * @param size       The number of bytes to allocate
+ * @param priv_ctxt  The private context given to \ref rohc_set_allocator
+ * @return           The allocated memory, suitably aligned for any type,
+ *                   NULL in case of failure
+ *
+ * @ingroup rohc
+ *
+ * @see rohc_set_allocator
+ */
+typedef void * (*rohc_malloc_t)(const size_t size, void *const priv_ctxt);
+
+
+/**
+ * @brief The prototype of the function that frees memory for the library
+ *
+ * @param ptr        The memory to free, never NULL
+ * @param priv_ctxt  The private context given to \ref rohc_set_allocator
+ *
+ * @ingroup rohc
+ *
+ * @see rohc_set_allocator
+ */
+typedef void (*rohc_free_t)(void *const ptr, void *const priv_ctxt);
+
+
 
 /*
  * Prototypes of public functions
@@ -253,6 +409,20 @@ const char * ROHC_EXPORT rohc_get_mode_descr(const rohc_mode_t mode)
 const char * ROHC_EXPORT rohc_get_profile_descr(const rohc_profile_t profile)
 	__attribute__((warn_unused_result, const));
 
+bool ROHC_EXPORT rohc_set_allocator(const rohc_malloc_t malloc_cb,
+                                    const rohc_free_t free_cb,
+                                    void *const priv_ctxt)
+	__attribute__((warn_unused_result));
+
+rohc_cpu_features_t ROHC_EXPORT rohc_cpu_get_features(void)
+	__attribute__((warn_unused_result));
+
+bool ROHC_EXPORT rohc_cpu_set_features(const rohc_cpu_features_t features)
+	__attribute__((warn_unused_result));
+
+const char * ROHC_EXPORT rohc_cpu_get_variant(const rohc_cpu_kernel_t kernel)
+	__attribute__((warn_unused_result));
+
 
 
 #undef ROHC_EXPORT /* do not pollute outside this header */
@@ -0,0 +1,162 @@
+/*
+ * Copyright 2016 Didier Barvaux
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/**
+ * @file   common/rohc_alloc.c
+ * @brief  The memory allocator of the library
+ * @author Didier Barvaux <didier@barvaux.org>
+ */
+
+#include "rohc_alloc.h"
+#include "rohc.h"
+
+#ifdef __KERNEL__
+#  include <linux/types.h>
+#  include <linux/string.h>
+#else
+#  include <stdbool.h>
+#  include <string.h>
+#endif
+
+
+/** The allocator plugged by the application, none by default */
+static struct
+{
+	rohc_malloc_t malloc_cb;  /**< Allocate memory, NULL for malloc(3) */
+	rohc_free_t free_cb;      /**< Free memory, NULL for free(3) */
+	void *priv_ctxt;          /**< The private context of the allocator */
+} rohc_allocator = {
+	.malloc_cb = NULL,
+	.free_cb = NULL,
+	.priv_ctxt = NULL,
+};
+
+
+/**
+ * @brief Set the functions that allocate and free the memory of the library
+ *
+ * All the memory the library allocates for the compressors, the
+ * decompressors and their contexts is allocated and freed with the given
+ * functions. The application may use them to plug its own memory pool, or to
+ * count the allocations.
+ *
+ * The allocator is shared by all the compressors and decompressors. It shall
+ * be set before the first compressor or decompressor is created, and it shall
+ * not be changed while one of them exists: the memory shall be freed by the
+ * allocator that allocated it. The allocator may be called from several
+ * threads at once if compressors or decompressors are used in several
+ * threads.
+ *
+ * @param malloc_cb  The function that allocates memory, NULL to restore the
+ *                   default malloc(3)
+ * @param free_cb    The function that frees memory, NULL to restore the
+ *                   default free(3)
+ * @param priv_ctxt  The private context given to the functions, may be NULL
+ * @return           true if the allocator was set,
+ *                   false if only one of the functions is NULL
+ *
+ * @ingroup rohc
+ */
+bool rohc_set_allocator(const rohc_malloc_t malloc_cb,
+                        const rohc_free_t free_cb,
+                        void *const priv_ctxt)
+{
+	/* both functions or none */
+	if((malloc_cb == NULL) != (free_cb == NULL))
+	{
+		goto error;
+	}
+
+	rohc_allocator.malloc_cb = malloc_cb;
+	rohc_allocator.free_cb = free_cb;
+	rohc_allocator.priv_ctxt = (malloc_cb == NULL ? NULL : priv_ctxt);
+
+	return true;
+
+error:
+	return false;
+}
+
+
+/**
+ * @brief Allocate memory
+ *
+ * @param size  The number of bytes to allocate
+ * @return      The allocated memory, NULL in case of failure
+ */
+void * rohc_malloc(const size_t size)
+{
+	if(rohc_allocator.malloc_cb == NULL)
+	{
+		return malloc(size);
+	}
+	return rohc_allocator.malloc_cb(size, rohc_allocator.priv_ctxt);
+}
+
+
+/**
+ * @brief Allocate zeroed memory for an array
+ *
+ * @param nmemb  The number of elements of the array
+ * @param size   The size of one element (in bytes)
+ * @return       The allocated memory, NULL in case of failure or if the size
+ *               of the array overflows
+ */
+void * rohc_calloc(const size_t nmemb, const size_t size)
+{
+	void *ptr;
+
+	if(rohc_allocator.malloc_cb == NULL)
+	{
+		return calloc(nmemb, size);
+	}
+
+	if(size != 0 && ((nmemb * size) / size) != nmemb)
+	{
+		return NULL;
+	}
+	ptr = rohc_allocator.malloc_cb(nmemb * size, rohc_allocator.priv_ctxt);
+	if(ptr != NULL)
+	{
+		memset(ptr, 0, nmemb * size);
+	}
+	return ptr;
+}
+
+
+/**
+ * @brief Free memory allocated by \ref rohc_malloc or \ref rohc_calloc
+ *
+ * @param ptr  The memory to free, may be NULL
+ */
+void rohc_free(void *const ptr)
+{
+	if(ptr == NULL)
+	{
+		return;
+	}
+	if(rohc_allocator.free_cb == NULL)
+	{
+		free(ptr);
+	}
+	else
+	{
+		rohc_allocator.free_cb(ptr, rohc_allocator.priv_ctxt);
+	}
+}
+
@@ -0,0 +1,48 @@
+/*
+ * Copyright 2016 Didier Barvaux
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/**
+ * @file   common/rohc_alloc.h
+ * @brief  The memory allocator of the library
+ * @author Didier Barvaux <didier@barvaux.org>
+ *
+ * All the memory of the library is allocated and freed through the functions
+ * below, so that the application may plug its own allocator with
+ * \ref rohc_set_allocator.
+ */
+
+#ifndef ROHC_COMMON_ALLOC_H
+#define ROHC_COMMON_ALLOC_H
+
+#include <stdlib.h>
+
+
+/*
+ * Public function prototypes:
+ */
+
+void * rohc_malloc(const size_t size)
+	__attribute__((warn_unused_result, malloc));
+
+void * rohc_calloc(const size_t nmemb, const size_t size)
+	__attribute__((warn_unused_result, malloc));
+
+void rohc_free(void *const ptr);
+
+#endif
+
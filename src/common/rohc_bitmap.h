@@ -0,0 +1,146 @@
+/*
+ * Copyright 2016 Didier Barvaux
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/**
+ * @file   common/rohc_bitmap.h
+ * @brief  Bitmaps of CIDs to walk the contexts in use only
+ * @author Didier Barvaux <didier@barvaux.org>
+ *
+ * One bit per CID tells whether the context is in use. Walking the contexts
+ * in use skips 64 unused CIDs at once, so tearing down or re-initializing
+ * a few contexts among 16384 CIDs does not cost a full scan of the array
+ * of contexts.
+ *
+ * The bitmap is updated by the thread that compresses or decompresses
+ * packets only, but it may be walked at the same time by one monitoring
+ * thread: the words are thus loaded and stored atomically. The monitoring
+ * thread shall check that every context it finds is still in use.
+ */
+
+#ifndef ROHC_COMMON_BITMAP_H
+#define ROHC_COMMON_BITMAP_H
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stddef.h>
+#ifdef __KERNEL__
+#  include <linux/types.h>
+#else
+#  include <stdbool.h>
+#endif
+
+
+/** The number of bits in one word of a bitmap */
+#define ROHC_BITMAP_WORD_BITS  64U
+
+/** The number of words in a bitmap of the given number of bits */
+#define ROHC_BITMAP_WORDS_NR(bits_nr) \
+	(((bits_nr) + ROHC_BITMAP_WORD_BITS - 1) / ROHC_BITMAP_WORD_BITS)
+
+
+/**
+ * @brief Set one bit of a bitmap
+ *
+ * @param bitmap  The bitmap
+ * @param bit     The bit to set
+ */
+static inline void rohc_bitmap_set(uint64_t *const bitmap, const size_t bit)
+{
+	uint64_t *const word = &bitmap[bit / ROHC_BITMAP_WORD_BITS];
+	const uint64_t value = __atomic_load_n(word, __ATOMIC_RELAXED);
+
+	__atomic_store_n(word, value | (1ULL << (bit % ROHC_BITMAP_WORD_BITS)),
+	                 __ATOMIC_RELAXED);
+}
+
+
+/**
+ * @brief Clear one bit of a bitmap
+ *
+ * @param bitmap  The bitmap
+ * @param bit     The bit to clear
+ */
+static inline void rohc_bitmap_clear(uint64_t *const bitmap, const size_t bit)
+{
+	uint64_t *const word = &bitmap[bit / ROHC_BITMAP_WORD_BITS];
+	const uint64_t value = __atomic_load_n(word, __ATOMIC_RELAXED);
+
+	__atomic_store_n(word, value & ~(1ULL << (bit % ROHC_BITMAP_WORD_BITS)),
+	                 __ATOMIC_RELAXED);
+}
+
+
+/**
+ * @brief Whether one bit of a bitmap is set
+ *
+ * @param bitmap  The bitmap
+ * @param bit     The bit to test
+ * @return        true if the bit is set, false otherwise
+ */
+static inline bool rohc_bitmap_test(const uint64_t *const bitmap,
+                                    const size_t bit)
+{
+	const uint64_t word =
+		__atomic_load_n(&bitmap[bit / ROHC_BITMAP_WORD_BITS], __ATOMIC_RELAXED);
+
+	return ((word >> (bit % ROHC_BITMAP_WORD_BITS)) & 1) != 0;
+}
+
+
+/**
+ * @brief Find the first bit set in a bitmap, starting from the given bit
+ *
+ * @param bitmap   The bitmap
+ * @param bits_nr  The number of bits in the bitmap
+ * @param from     The first bit to check
+ * @return         The first bit set at or after \e from,
+ *                 \e bits_nr if there is none
+ */
+static inline size_t rohc_bitmap_next(const uint64_t *const bitmap,
+                                      const size_t bits_nr,
+                                      const size_t from)
+{
+	const size_t words_nr = ROHC_BITMAP_WORDS_NR(bits_nr);
+	size_t word_idx = from / ROHC_BITMAP_WORD_BITS;
+	uint64_t word;
+
+	if(from >= bits_nr)
+	{
+		return bits_nr;
+	}
+
+	/* ignore the bits before the first bit to check */
+	word = __atomic_load_n(&bitmap[word_idx], __ATOMIC_RELAXED);
+	word &= ~0ULL << (from % ROHC_BITMAP_WORD_BITS);
+
+	/* skip the empty words */
+	while(word == 0)
+	{
+		word_idx++;
+		if(word_idx >= words_nr)
+		{
+			return bits_nr;
+		}
+		word = __atomic_load_n(&bitmap[word_idx], __ATOMIC_RELAXED);
+	}
+
+	return (word_idx * ROHC_BITMAP_WORD_BITS + __builtin_ctzll(word));
+}
+
+#endif
+
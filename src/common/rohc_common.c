@@ -165,6 +165,14 @@ const char * rohc_get_profile_descr(const rohc_profile_t profile)
 			return "IP/UDP-Lite/RTP";
 		case ROHC_PROFILE_UDPLITE:
 			return "IP/UDP-Lite";
+		case ROHCv2_PROFILE_IP_UDP_RTP:
+			return "IP/UDP/RTP (v2)";
+		case ROHCv2_PROFILE_IP_UDP:
+			return "IP/UDP (v2)";
+		case ROHCv2_PROFILE_IP_ESP:
+			return "IP/ESP (v2)";
+		case ROHCv2_PROFILE_IP:
+			return "IP-only (v2)";
 		case ROHC_PROFILE_MAX:
 		default:
 			return "no description";
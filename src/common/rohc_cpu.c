@@ -0,0 +1,212 @@
+/*
+ * Copyright 2016 Didier Barvaux
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/**
+ * @file   common/rohc_cpu.c
+ * @brief  Detection of the CPU features and selection of the computations
+ * @author Didier Barvaux <didier@barvaux.org>
+ */
+
+#include "rohc_cpu.h"
+#include "rohc.h"
+#include "crc.h"
+
+#ifdef __KERNEL__
+#  include <linux/types.h>
+#  include <linux/crc32.h>
+#else
+#  include <stdbool.h>
+#endif
+
+
+#ifdef __KERNEL__
+
+static uint32_t rohc_cpu_fcs32_linux(const uint8_t *const data,
+                                     const size_t length,
+                                     const uint32_t init_val)
+	__attribute__((nonnull(1), warn_unused_result, pure));
+
+#else
+
+static void rohc_cpu_init(void)
+	__attribute__((constructor));
+
+#endif
+
+static void rohc_cpu_select(void);
+
+
+/** The CPU features detected when the library was loaded */
+static rohc_cpu_features_t rohc_cpu_detected = ROHC_CPU_FEATURE_NONE;
+
+/** The CPU features allowed by the application, all by default */
+static rohc_cpu_features_t rohc_cpu_allowed = ROHC_CPU_FEATURE_ALL;
+
+/** The variants of the computations selected for the CPU */
+struct rohc_cpu_kernels rohc_cpu_kernels =
+{
+#ifdef __KERNEL__
+	.fcs32 = rohc_cpu_fcs32_linux,
+	.fcs32_name = "linux",
+#else
+	.fcs32 = crc_calc_fcs32_generic,
+	.fcs32_name = "generic",
+#endif
+};
+
+
+/**
+ * @brief Get the CPU features the library uses
+ *
+ * The features used are the features that the CPU supports and that the
+ * application did not disable with \ref rohc_cpu_set_features. No feature is
+ * used in the Linux kernel, the library relies on the helpers of the kernel
+ * there.
+ *
+ * @return  The mask of the CPU features the library uses
+ *
+ * @ingroup rohc
+ */
+rohc_cpu_features_t rohc_cpu_get_features(void)
+{
+	return (rohc_cpu_detected & rohc_cpu_allowed);
+}
+
+
+/**
+ * @brief Restrict the CPU features the library may use
+ *
+ * The features of the CPU are detected when the library is loaded, and all
+ * of them are used by default. The application may restrict them, eg. to
+ * measure the speed of the generic computations on a CPU that supports
+ * special instructions. Enabling a feature that the CPU does not support has
+ * no effect.
+ *
+ * The features are shared by all the compressors and decompressors. They
+ * shall be restricted before the first compressor or decompressor is
+ * created, or while none of them is in use.
+ *
+ * @param features  The mask of the CPU features the library may use,
+ *                  \ref ROHC_CPU_FEATURE_ALL to restore the default,
+ *                  \ref ROHC_CPU_FEATURE_NONE for the generic computations
+ * @return          true if the features were restricted,
+ *                  false if the mask contains unknown features
+ *
+ * @ingroup rohc
+ */
+bool rohc_cpu_set_features(const rohc_cpu_features_t features)
+{
+	if((features & ~ROHC_CPU_FEATURE_ALL) != 0)
+	{
+		goto error;
+	}
+
+	rohc_cpu_allowed = features;
+	rohc_cpu_select();
+
+	return true;
+
+error:
+	return false;
+}
+
+
+/**
+ * @brief Get the name of the variant selected for one computation
+ *
+ * The name is meant to be printed along with benchmark results, so that they
+ * can be reproduced.
+ *
+ * @param kernel  The computation
+ * @return        The name of the variant selected for the computation,
+ *                "no description" if the computation is unknown
+ *
+ * @ingroup rohc
+ */
+const char * rohc_cpu_get_variant(const rohc_cpu_kernel_t kernel)
+{
+	switch(kernel)
+	{
+		case ROHC_CPU_KERNEL_FCS32:
+			return rohc_cpu_kernels.fcs32_name;
+		default:
+			return "no description";
+	}
+}
+
+
+#ifdef __KERNEL__
+
+/**
+ * @brief Compute the CRC FCS-32 with the helper of the Linux kernel
+ *
+ * The kernel uses the special instructions of the CPU if they are available.
+ *
+ * @param data      The data to compute the CRC for
+ * @param length    The size of the data
+ * @param init_val  The initial value of the CRC
+ * @return          The 32-bit CRC
+ */
+static uint32_t rohc_cpu_fcs32_linux(const uint8_t *const data,
+                                     const size_t length,
+                                     const uint32_t init_val)
+{
+	return crc32_le(init_val, data, length);
+}
+
+#else
+
+/**
+ * @brief Detect the features of the CPU when the library is loaded
+ */
+static void rohc_cpu_init(void)
+{
+#ifdef ROHC_CPU_X86
+	__builtin_cpu_init();
+	if(__builtin_cpu_supports("sse2") && __builtin_cpu_supports("pclmul"))
+	{
+		rohc_cpu_detected |= ROHC_CPU_FEATURE_PCLMUL;
+	}
+#endif
+
+	rohc_cpu_select();
+}
+
+#endif
+
+
+/**
+ * @brief Select the best variant of every computation for the CPU features
+ */
+static void rohc_cpu_select(void)
+{
+#ifdef ROHC_CPU_X86
+	const rohc_cpu_features_t features = rohc_cpu_get_features();
+
+	if((features & ROHC_CPU_FEATURE_PCLMUL) != 0)
+	{
+		rohc_cpu_kernels.fcs32 = crc_calc_fcs32_pclmul;
+		rohc_cpu_kernels.fcs32_name = "pclmul";
+	}
+	else
+	{
+		rohc_cpu_kernels.fcs32 = crc_calc_fcs32_generic;
+		rohc_cpu_kernels.fcs32_name = "generic";
+	}
+#endif
+}
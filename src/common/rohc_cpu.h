@@ -0,0 +1,67 @@
+/*
+ * Copyright 2016 Didier Barvaux
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/**
+ * @file   common/rohc_cpu.h
+ * @brief  Detection of the CPU features and selection of the computations
+ * @author Didier Barvaux <didier@barvaux.org>
+ *
+ * Some computations of the library have several variants: one generic
+ * variant that runs everywhere, and variants that use special instructions
+ * of some CPUs. The features of the CPU are detected once when the library
+ * is loaded, and the best variant of every computation is then recorded in
+ * one table shared by all the compressors and decompressors. The features
+ * may be restricted with \ref rohc_cpu_set_features, eg. to compare the
+ * variants.
+ *
+ * In the Linux kernel, the library relies on the helpers of the kernel that
+ * already select the best instructions for the CPU, and no feature is
+ * detected.
+ */
+
+#ifndef ROHC_COMMON_CPU_H
+#define ROHC_COMMON_CPU_H
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stddef.h>
+
+
+/** Whether the variants for the x86 CPUs are built */
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__) && \
+    !defined(__KERNEL__)
+#  define ROHC_CPU_X86  1
+#endif
+
+
+/** The variants of the computations selected for the CPU */
+struct rohc_cpu_kernels
+{
+	/** Compute the CRC FCS-32, see \ref crc_calc_fcs32 */
+	uint32_t (*fcs32)(const uint8_t *const data,
+	                  const size_t length,
+	                  const uint32_t init_val);
+	/** The name of the variant of the CRC FCS-32 */
+	const char *fcs32_name;
+};
+
+
+/** The variants of the computations selected for the CPU */
+extern struct rohc_cpu_kernels rohc_cpu_kernels;
+
+#endif
@@ -0,0 +1,213 @@
+/*
+ * Copyright 2016 Didier Barvaux
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/**
+ * @file   common/rohc_csum.h
+ * @brief  Incremental update of the Internet checksum
+ * @author Didier Barvaux <didier@barvaux.org>
+ *
+ * When a few 16-bit words of a header change, its Internet checksum is
+ * updated from its previous value as described by RFC 1624, equation 3:
+ *   HC' = ~(~HC + ~m + m')
+ * The one's complement sum is independent of the byte order, so the words
+ * are handled as they are stored in the header (network byte order), and
+ * the updated checksum may be written as is in the header.
+ *
+ * RFC 1624 shows that the updated checksum is the one that a full
+ * computation of the checksum gives, the 0x0000 and 0xffff values of the
+ * checksum are never mixed up.
+ */
+
+#ifndef ROHC_COMMON_CSUM_H
+#define ROHC_COMMON_CSUM_H
+
+#include <stdlib.h>
+#include <stdint.h>
+#ifdef __KERNEL__
+#  include <linux/types.h>
+#  include <linux/string.h>
+#else
+#  include <string.h>
+#endif
+
+
+/**
+ * @brief Fold a 32-bit one's complement sum into 16 bits
+ *
+ * @param sum  The 32-bit sum of 16-bit words
+ * @return     The 16-bit one's complement sum
+ */
+static inline uint16_t rohc_csum_fold(const uint32_t sum)
+{
+	uint32_t folded = sum;
+
+	folded = (folded & 0xffff) + (folded >> 16);
+	folded = (folded & 0xffff) + (folded >> 16);
+
+	return (uint16_t) folded;
+}
+
+
+/**
+ * @brief Compute the one's complement sum of some bytes
+ *
+ * The sum is independent of the byte order and of the alignment of the
+ * bytes: it is the sum of the 16-bit words as they are stored in memory, and
+ * it may be written as is in a header once complemented.
+ *
+ * Outside the kernel, 16 bytes are summed at once with the generic vector
+ * extensions of the compiler, that are built with the SIMD instructions that
+ * the target always provides (SSE2 on x86_64, NEON on aarch64...), without
+ * any runtime dispatch: every lane counts its own carries instead of
+ * propagating them.
+ *
+ * @param data  The bytes to sum
+ * @param len   The number of bytes, an odd last byte is padded with zero
+ * @return      The 16-bit one's complement sum of the bytes
+ */
+static inline uint16_t rohc_csum_sum(const uint8_t *const data,
+                                     const size_t len)
+{
+	uint64_t sum = 0;
+	size_t i = 0;
+
+#ifndef __KERNEL__
+	typedef uint32_t rohc_csum_vec_t __attribute__((vector_size(16)));
+	rohc_csum_vec_t words_sum = { 0, 0, 0, 0 };
+	rohc_csum_vec_t carries_nr = { 0, 0, 0, 0 };
+
+	for(i = 0; (len - i) >= sizeof(rohc_csum_vec_t);
+	    i += sizeof(rohc_csum_vec_t))
+	{
+		rohc_csum_vec_t words;
+		memcpy(&words, data + i, sizeof(rohc_csum_vec_t));
+		words_sum += words;
+		/* a lane that wrapped around is smaller than the word added to it,
+		 * the comparison gives -1 for such a lane */
+		carries_nr -= (rohc_csum_vec_t) (words_sum < words);
+	}
+	sum = ((uint64_t) words_sum[0]) + words_sum[1] + words_sum[2] + words_sum[3];
+	sum += (((uint64_t) carries_nr[0]) + carries_nr[1] + carries_nr[2] +
+	        carries_nr[3]) << 32;
+#endif
+
+	for( ; (i + sizeof(uint32_t)) <= len; i += sizeof(uint32_t))
+	{
+		uint32_t word;
+		memcpy(&word, data + i, sizeof(uint32_t));
+		sum += word;
+	}
+	if((len - i) >= sizeof(uint16_t))
+	{
+		uint16_t word;
+		memcpy(&word, data + i, sizeof(uint16_t));
+		sum += word;
+		i += sizeof(uint16_t);
+	}
+	if(i < len)
+	{
+		uint16_t word = 0;
+		memcpy(&word, data + i, 1);
+		sum += word;
+	}
+
+	/* fold the 64-bit sum into 32 bits, then into 16 bits */
+	sum = (sum & 0xffffffff) + (sum >> 32);
+	sum = (sum & 0xffffffff) + (sum >> 32);
+
+	return rohc_csum_fold((uint32_t) sum);
+}
+
+
+/**
+ * @brief Update a checksum when one 16-bit word changes
+ *
+ * @param csum      The checksum before the change
+ * @param old_word  The old value of the word
+ * @param new_word  The new value of the word
+ * @return          The checksum after the change
+ */
+static inline uint16_t rohc_csum_replace16(const uint16_t csum,
+                                           const uint16_t old_word,
+                                           const uint16_t new_word)
+{
+	const uint32_t sum = ((uint16_t) ~csum) + ((uint16_t) ~old_word) + new_word;
+
+	return (uint16_t) ~rohc_csum_fold(sum);
+}
+
+
+/**
+ * @brief Update a checksum when one 32-bit word changes
+ *
+ * @param csum      The checksum before the change
+ * @param old_word  The old value of the word
+ * @param new_word  The new value of the word
+ * @return          The checksum after the change
+ */
+static inline uint16_t rohc_csum_replace32(const uint16_t csum,
+                                           const uint32_t old_word,
+                                           const uint32_t new_word)
+{
+	const uint32_t sum = ((uint16_t) ~csum) +
+	                     ((uint16_t) ~(old_word >> 16)) + (new_word >> 16) +
+	                     ((uint16_t) ~(old_word & 0xffff)) + (new_word & 0xffff);
+
+	return (uint16_t) ~rohc_csum_fold(sum);
+}
+
+
+/**
+ * @brief Update a checksum from the old and new versions of some bytes
+ *
+ * Only the 16-bit words that differ between the two versions contribute to
+ * the update. The bytes shall start on a 16-bit boundary of the checksummed
+ * data.
+ *
+ * @param csum      The checksum of the data with the old bytes
+ * @param old_data  The old bytes
+ * @param new_data  The new bytes
+ * @param len       The number of bytes, shall be even
+ * @return          The checksum of the data with the new bytes
+ */
+static inline uint16_t rohc_csum_replace(const uint16_t csum,
+                                         const uint8_t *const old_data,
+                                         const uint8_t *const new_data,
+                                         const size_t len)
+{
+	uint32_t sum = (uint16_t) ~csum;
+	size_t i;
+
+	for(i = 0; (i + 1) < len; i += sizeof(uint16_t))
+	{
+		uint16_t old_word;
+		uint16_t new_word;
+
+		memcpy(&old_word, old_data + i, sizeof(uint16_t));
+		memcpy(&new_word, new_data + i, sizeof(uint16_t));
+		if(old_word != new_word)
+		{
+			sum += ((uint16_t) ~old_word) + new_word;
+		}
+	}
+
+	return (uint16_t) ~rohc_csum_fold(sum);
+}
+
+#endif /* ROHC_COMMON_CSUM_H */
+
@@ -0,0 +1,593 @@
+/*
+ * Copyright 2016 Didier Barvaux
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/**
+ * @file   common/rohc_ctxt_pool.c
+ * @brief  Pool of memory blocks for the profile-specific parts of contexts
+ * @author Didier Barvaux <didier@barvaux.org>
+ */
+
+#include "rohc_ctxt_pool.h"
+#include "rohc_alloc.h"
+#include "rohc_huge_pages.h"
+#include "rohc_numa.h"
+#include "rohc.h"
+
+#ifndef __KERNEL__
+#  include <string.h>
+#endif
+#include <assert.h>
+
+
+/**
+ * @brief The header in front of every block, that records its size
+ *
+ * The header is as large as four times the alignment of the parts carved
+ * from the block, so that the first part is aligned too.
+ */
+union rohc_ctxt_block_hdr
+{
+	struct
+	{
+		size_t size;                       /**< The size of the block */
+		union rohc_ctxt_block_hdr *next;  /**< The next free block */
+		bool carved;  /**< Whether the block was carved from the memory budget
+		                   or from a slab, or allocated on its own */
+	} info;
+	uint8_t align[ROHC_CTXT_ARENA_ALIGN * 4];  /**< Padding for alignment */
+};
+
+
+/** The header in front of every slab */
+union rohc_ctxt_slab_hdr
+{
+	struct
+	{
+		size_t len;                       /**< The length of the slab */
+		union rohc_ctxt_slab_hdr *next;  /**< The slab mapped before */
+	} info;
+	uint8_t align[ROHC_CTXT_ARENA_ALIGN * 4];  /**< Padding for alignment */
+};
+
+
+static uint8_t * rohc_ctxt_area_alloc(const bool huge_pages,
+                                      const int numa_node,
+                                      const size_t len,
+                                      bool *const is_huge)
+	__attribute__((warn_unused_result, nonnull(4)));
+static void rohc_ctxt_area_free(const bool huge_pages,
+                                const int numa_node,
+                                void *const mem,
+                                const size_t len);
+static union rohc_ctxt_block_hdr *
+	rohc_ctxt_pool_carve_slab(struct rohc_ctxt_pool *const pool,
+	                          const size_t block_len)
+	__attribute__((warn_unused_result, nonnull(1)));
+
+#ifndef __KERNEL__
+
+/**
+ * @brief Allocate one block on demand
+ *
+ * @param size  The size of the block
+ * @return      The block, NULL in case of memory allocation failure
+ */
+static void * rohc_ctxt_block_alloc(const size_t size)
+{
+	return rohc_malloc(size);
+}
+
+
+/**
+ * @brief Free one block allocated on demand
+ *
+ * @param block  The block got from \ref rohc_ctxt_block_alloc
+ * @param size   The size of the block
+ */
+static void rohc_ctxt_block_free(void *const block,
+                                 const size_t size __attribute__((unused)))
+{
+	rohc_free(block);
+}
+
+#endif
+
+
+/**
+ * @brief Initialize an empty pool of memory blocks, without memory budget
+ *
+ * @param pool  The pool to initialize
+ */
+void rohc_ctxt_pool_init(struct rohc_ctxt_pool *const pool)
+{
+	pool->free_blocks = NULL;
+	pool->allocated_nr = 0;
+	pool->budget_mem = NULL;
+	pool->budget_len = 0;
+	pool->budget_used = 0;
+	pool->huge_pages = false;
+	pool->slabs = NULL;
+	pool->slab_used = 0;
+	pool->huge_areas_nr = 0;
+	pool->numa_node = ROHC_NUMA_NODE_ANY;
+}
+
+
+/**
+ * @brief Free all the memory blocks kept in a pool and its memory budget
+ *
+ * The blocks in use shall be given back to the pool before. The pool keeps
+ * using huge pages and its NUMA node if it did.
+ *
+ * @param pool  The pool to empty
+ */
+void rohc_ctxt_pool_free(struct rohc_ctxt_pool *const pool)
+{
+	const bool huge_pages = pool->huge_pages;
+	const int numa_node = pool->numa_node;
+	union rohc_ctxt_block_hdr *hdr = pool->free_blocks;
+	union rohc_ctxt_slab_hdr *slab = pool->slabs;
+
+	while(hdr != NULL)
+	{
+		union rohc_ctxt_block_hdr *const next = hdr->info.next;
+
+		if(!hdr->info.carved)
+		{
+			rohc_ctxt_block_free(hdr, sizeof(union rohc_ctxt_block_hdr) +
+			                     hdr->info.size);
+		}
+		hdr = next;
+	}
+	while(slab != NULL)
+	{
+		union rohc_ctxt_slab_hdr *const next = slab->info.next;
+
+		rohc_ctxt_area_free(huge_pages, numa_node, slab, slab->info.len);
+		slab = next;
+	}
+	rohc_ctxt_area_free(huge_pages, numa_node, pool->budget_mem,
+	                    pool->budget_len);
+	rohc_ctxt_pool_init(pool);
+	pool->huge_pages = huge_pages;
+	pool->numa_node = numa_node;
+}
+
+
+/**
+ * @brief Set the memory budget of a pool
+ *
+ * The memory area of the budget is preallocated once, then all the blocks are
+ * carved from it: no block is allocated on demand any more, and the blocks
+ * that do not fit in the budget are refused. A budget of 0 restores the
+ * allocation of the blocks on demand.
+ *
+ * The memory area of the budget is backed by huge pages if the pool uses
+ * them, see \ref rohc_ctxt_pool_set_huge_pages, and bound to the NUMA node
+ * of the pool if any, see \ref rohc_ctxt_pool_set_numa_node.
+ *
+ * The free blocks kept in the pool are released. No block shall be in use.
+ *
+ * @param pool    The pool
+ * @param budget  The size (in bytes) of the memory budget, 0 for no budget
+ * @return        true if the budget was set, false if the memory area
+ *                cannot be allocated
+ */
+bool rohc_ctxt_pool_set_budget(struct rohc_ctxt_pool *const pool,
+                               const size_t budget)
+{
+	uint8_t *budget_mem = NULL;
+	bool is_huge = false;
+
+	if(budget > 0)
+	{
+		budget_mem = rohc_ctxt_area_alloc(pool->huge_pages, pool->numa_node,
+		                                  budget, &is_huge);
+		if(budget_mem == NULL)
+		{
+			goto error;
+		}
+	}
+
+	rohc_ctxt_pool_free(pool);
+	pool->budget_mem = budget_mem;
+	pool->budget_len = budget;
+	if(is_huge)
+	{
+		pool->huge_areas_nr++;
+	}
+
+	return true;
+
+error:
+	return false;
+}
+
+
+/**
+ * @brief Enable or disable the huge pages for the memory of a pool
+ *
+ * With huge pages, the memory area of the budget is mapped with huge pages.
+ * Without memory budget, the blocks are carved from slabs of huge pages
+ * mapped on demand: the first slab is mapped at once. The blocks carved from
+ * the slabs are never freed before the pool is freed, they are kept for
+ * reuse.
+ *
+ * The free blocks kept in the pool are released, the memory budget is kept
+ * but moved to the new memory. No block shall be in use.
+ *
+ * @param pool     The pool
+ * @param enabled  Whether to use huge pages or not
+ * @return         true if huge pages were enabled or disabled, false if the
+ *                 memory cannot be mapped, the pool then keeps its memory
+ *                 budget and does not use huge pages
+ */
+bool rohc_ctxt_pool_set_huge_pages(struct rohc_ctxt_pool *const pool,
+                                   const bool enabled)
+{
+	const size_t budget = pool->budget_len;
+	uint8_t *budget_mem = NULL;
+	bool is_huge = false;
+
+	if(enabled == pool->huge_pages)
+	{
+		return true;
+	}
+
+	if(budget > 0)
+	{
+		budget_mem = rohc_ctxt_area_alloc(enabled, pool->numa_node, budget,
+		                                  &is_huge);
+		if(budget_mem == NULL)
+		{
+			goto error;
+		}
+	}
+
+	rohc_ctxt_pool_free(pool);
+	pool->huge_pages = enabled;
+	pool->budget_mem = budget_mem;
+	pool->budget_len = budget;
+	if(is_huge)
+	{
+		pool->huge_areas_nr++;
+	}
+
+	/* without budget, map the first slab at once */
+	if(enabled && budget == 0)
+	{
+		union rohc_ctxt_block_hdr *const hdr =
+			rohc_ctxt_pool_carve_slab(pool, sizeof(union rohc_ctxt_block_hdr));
+
+		if(hdr == NULL)
+		{
+			pool->huge_pages = false;
+			goto error;
+		}
+		/* the slab is left untouched */
+		pool->slab_used -= sizeof(union rohc_ctxt_block_hdr);
+	}
+
+	return true;
+
+error:
+	return false;
+}
+
+
+/**
+ * @brief Bind the memory of a pool to one NUMA node
+ *
+ * The memory area of the budget and the slabs the blocks are carved from are
+ * then bound to the node. Without memory budget, the blocks are carved from
+ * slabs mapped on demand instead of being allocated one by one. The node
+ * shall be set before the pool holds any memory: the node is checked when
+ * the first memory area is mapped.
+ *
+ * @param pool  The empty pool
+ * @param node  The NUMA node, ROHC_NUMA_NODE_ANY for the default placement
+ */
+void rohc_ctxt_pool_set_numa_node(struct rohc_ctxt_pool *const pool,
+                                  const int node)
+{
+	assert(pool->free_blocks == NULL);
+	assert(pool->budget_mem == NULL);
+	assert(pool->slabs == NULL);
+	pool->numa_node = node;
+}
+
+
+/**
+ * @brief Allocate one zeroed memory area in the same memory as a pool
+ *
+ * The area is backed by huge pages if the pool uses them, and bound to the
+ * NUMA node of the pool if any. It shall be freed with
+ * \ref rohc_ctxt_pool_free_area before the pool changes its memory.
+ *
+ * @param pool  The pool
+ * @param len   The length (in bytes) of the area
+ * @return      The memory area, NULL in case of failure
+ */
+void * rohc_ctxt_pool_alloc_area(const struct rohc_ctxt_pool *const pool,
+                                 const size_t len)
+{
+	bool is_huge;
+
+	return rohc_ctxt_area_alloc(pool->huge_pages, pool->numa_node, len,
+	                            &is_huge);
+}
+
+
+/**
+ * @brief Free one memory area allocated by \ref rohc_ctxt_pool_alloc_area
+ *
+ * @param pool  The pool given to \ref rohc_ctxt_pool_alloc_area
+ * @param mem   The memory area, may be NULL
+ * @param len   The length (in bytes) of the area
+ */
+void rohc_ctxt_pool_free_area(const struct rohc_ctxt_pool *const pool,
+                              void *const mem,
+                              const size_t len)
+{
+	rohc_ctxt_area_free(pool->huge_pages, pool->numa_node, mem, len);
+}
+
+
+/**
+ * @brief Get one zeroed memory block from a pool
+ *
+ * The smallest free block large enough is reused if the pool holds one.
+ * Otherwise, a new block is carved from the memory budget if the pool has
+ * one, or allocated if it has none. The parts of the context shall then be
+ * carved from the block with \ref rohc_ctxt_arena_alloc.
+ *
+ * @param pool        The pool to get the block from
+ * @param size        The size of the block, see \ref rohc_ctxt_arena_size
+ * @param[out] arena  The bump arena to carve the parts of the context from,
+ *                    NULL if the block is used as a whole
+ * @return            The block, NULL if the budget is exhausted or in case
+ *                    of memory allocation failure
+ */
+void * rohc_ctxt_pool_get(struct rohc_ctxt_pool *const pool,
+                          const size_t size,
+                          struct rohc_ctxt_arena *const arena)
+{
+	const size_t aligned_size = rohc_ctxt_arena_size(size);
+	union rohc_ctxt_block_hdr **best_link = NULL;
+	union rohc_ctxt_block_hdr **link;
+	union rohc_ctxt_block_hdr *hdr;
+
+	/* reuse the smallest free block large enough if any */
+	for(link = (union rohc_ctxt_block_hdr **) &pool->free_blocks;
+	    (*link) != NULL; link = &(*link)->info.next)
+	{
+		if((*link)->info.size >= aligned_size &&
+		   (best_link == NULL || (*link)->info.size < (*best_link)->info.size))
+		{
+			best_link = link;
+		}
+	}
+	if(best_link != NULL)
+	{
+		hdr = *best_link;
+		*best_link = hdr->info.next;
+		if(!hdr->info.carved)
+		{
+			pool->allocated_nr--;
+		}
+	}
+	else if(pool->budget_mem != NULL)
+	{
+		/* carve a new block from the memory budget */
+		if((sizeof(union rohc_ctxt_block_hdr) + aligned_size) >
+		   (pool->budget_len - pool->budget_used))
+		{
+			goto error;
+		}
+		hdr = (union rohc_ctxt_block_hdr *) (pool->budget_mem + pool->budget_used);
+		pool->budget_used += sizeof(union rohc_ctxt_block_hdr) + aligned_size;
+		hdr->info.size = aligned_size;
+		hdr->info.carved = true;
+	}
+	else if(rohc_ctxt_pool_has_slabs(pool))
+	{
+		/* carve a new block from the slabs */
+		hdr = rohc_ctxt_pool_carve_slab(pool, aligned_size +
+		                                sizeof(union rohc_ctxt_block_hdr));
+		if(hdr == NULL)
+		{
+			goto error;
+		}
+		hdr->info.size = aligned_size;
+		hdr->info.carved = true;
+	}
+	else
+	{
+		hdr = rohc_ctxt_block_alloc(sizeof(union rohc_ctxt_block_hdr) +
+		                            aligned_size);
+		if(hdr == NULL)
+		{
+			goto error;
+		}
+		hdr->info.size = aligned_size;
+		hdr->info.carved = false;
+	}
+	assert(hdr->info.size >= aligned_size);
+	memset(hdr + 1, 0, size);
+
+	if(arena != NULL)
+	{
+		arena->next = (uint8_t *) (hdr + 1);
+		arena->len = aligned_size;
+	}
+
+	return (hdr + 1);
+
+error:
+	return NULL;
+}
+
+
+/**
+ * @brief Give a memory block back to a pool
+ *
+ * The block is kept for reuse if it was carved from the memory budget or
+ * from a slab, or if the pool does not hold too many free blocks, it is
+ * freed otherwise.
+ *
+ * @param pool   The pool to give the block back to
+ * @param block  The block got from \ref rohc_ctxt_pool_get, may be NULL
+ */
+void rohc_ctxt_pool_put(struct rohc_ctxt_pool *const pool,
+                        void *const block)
+{
+	union rohc_ctxt_block_hdr *hdr;
+
+	if(block == NULL)
+	{
+		return;
+	}
+	hdr = ((union rohc_ctxt_block_hdr *) block) - 1;
+
+	if(hdr->info.carved)
+	{
+		hdr->info.next = pool->free_blocks;
+		pool->free_blocks = hdr;
+	}
+	else if(pool->allocated_nr < ROHC_CTXT_POOL_MAX)
+	{
+		hdr->info.next = pool->free_blocks;
+		pool->free_blocks = hdr;
+		pool->allocated_nr++;
+	}
+	else
+	{
+		rohc_ctxt_block_free(hdr, sizeof(union rohc_ctxt_block_hdr) +
+		                     hdr->info.size);
+	}
+}
+
+
+/**
+ * @brief Allocate one zeroed memory area of the pool
+ *
+ * @param huge_pages    Whether to back the area with huge pages or not
+ * @param numa_node     The NUMA node to bind the area to,
+ *                      ROHC_NUMA_NODE_ANY if none
+ * @param len           The length (in bytes) of the area
+ * @param[out] is_huge  Whether the area is backed by explicit huge pages
+ * @return              The memory area, NULL in case of failure
+ */
+static uint8_t * rohc_ctxt_area_alloc(const bool huge_pages,
+                                      const int numa_node,
+                                      const size_t len,
+                                      bool *const is_huge)
+{
+	uint8_t *mem;
+
+	*is_huge = false;
+	if(huge_pages)
+	{
+		mem = rohc_huge_alloc(len, is_huge);
+		if(mem != NULL && !rohc_numa_bind(mem, rohc_huge_len(len), numa_node))
+		{
+			rohc_huge_free(mem, len);
+			*is_huge = false;
+			mem = NULL;
+		}
+	}
+	else
+	{
+		mem = rohc_numa_alloc(len, numa_node);
+	}
+
+	return mem;
+}
+
+
+/**
+ * @brief Free one memory area of the pool
+ *
+ * @param huge_pages  Whether the area is backed by huge pages or not
+ * @param numa_node   The NUMA node the area is bound to,
+ *                    ROHC_NUMA_NODE_ANY if none
+ * @param mem         The memory area, may be NULL
+ * @param len         The length (in bytes) of the area
+ */
+static void rohc_ctxt_area_free(const bool huge_pages,
+                                const int numa_node,
+                                void *const mem,
+                                const size_t len)
+{
+	if(huge_pages)
+	{
+		rohc_huge_free(mem, len);
+	}
+	else
+	{
+		rohc_numa_free(mem, len, numa_node);
+	}
+}
+
+
+/**
+ * @brief Carve one block from the slabs of the pool
+ *
+ * A new slab is mapped if the last one has not enough room left: the end of
+ * the last slab is then lost.
+ *
+ * @param pool       The pool
+ * @param block_len  The length (in bytes) of the block, header included
+ * @return           The block, NULL if no slab can be mapped
+ */
+static union rohc_ctxt_block_hdr *
+	rohc_ctxt_pool_carve_slab(struct rohc_ctxt_pool *const pool,
+	                          const size_t block_len)
+{
+	union rohc_ctxt_slab_hdr *slab = pool->slabs;
+	union rohc_ctxt_block_hdr *hdr;
+
+	if(slab == NULL || block_len > (slab->info.len - pool->slab_used))
+	{
+		const size_t slab_len =
+			rohc_huge_len(sizeof(union rohc_ctxt_slab_hdr) + block_len);
+		bool is_huge;
+
+		slab = (union rohc_ctxt_slab_hdr *)
+			rohc_ctxt_area_alloc(pool->huge_pages, pool->numa_node, slab_len,
+			                     &is_huge);
+		if(slab == NULL)
+		{
+			return NULL;
+		}
+		if(is_huge)
+		{
+			pool->huge_areas_nr++;
+		}
+		slab->info.len = slab_len;
+		slab->info.next = pool->slabs;
+		pool->slabs = slab;
+		pool->slab_used = sizeof(union rohc_ctxt_slab_hdr);
+	}
+
+	hdr = (union rohc_ctxt_block_hdr *) (((uint8_t *) slab) + pool->slab_used);
+	pool->slab_used += block_len;
+
+	return hdr;
+}
+
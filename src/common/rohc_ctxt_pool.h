@@ -0,0 +1,236 @@
+/*
+ * Copyright 2016 Didier Barvaux
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/**
+ * @file   common/rohc_ctxt_pool.h
+ * @brief  Pool of memory blocks for the profile-specific parts of contexts
+ * @author Didier Barvaux <didier@barvaux.org>
+ *
+ * The profile-specific parts of one compression or decompression context
+ * are carved from one single memory block with a bump arena. The blocks of
+ * the destroyed contexts are kept in a pool owned by the compressor or the
+ * decompressor, so that they are reused when new contexts are created.
+ *
+ * The blocks may also be carved from a few large memory areas backed by huge
+ * pages, see \ref rohc_ctxt_pool_set_huge_pages, to reduce the TLB misses
+ * when many contexts are used, or bound to one NUMA node, see
+ * \ref rohc_ctxt_pool_set_numa_node.
+ */
+
+#ifndef ROHC_COMMON_CTXT_POOL_H
+#define ROHC_COMMON_CTXT_POOL_H
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stddef.h>
+#ifdef __KERNEL__
+#  include <linux/types.h>
+#else
+#  include <stdbool.h>
+#endif
+
+
+/** The max number of free allocated blocks kept in one pool for reuse */
+#define ROHC_CTXT_POOL_MAX  16U
+
+/** The alignment of the parts carved from one block */
+#define ROHC_CTXT_ARENA_ALIGN  8U
+
+/** The size a part takes in a bump arena, usable in constant expressions */
+#define ROHC_CTXT_ARENA_SIZE(size) \
+	(((size) + ROHC_CTXT_ARENA_ALIGN - 1) & ~((size_t) ROHC_CTXT_ARENA_ALIGN - 1))
+
+
+/**
+ * @brief The pool of memory blocks for contexts
+ *
+ * Without memory budget, the blocks are allocated on demand and a few of the
+ * freed blocks are kept for reuse. With a memory budget, all the blocks are
+ * carved from one memory area preallocated once, and no block is allocated
+ * on demand.
+ *
+ * With huge pages, the memory area of the budget is backed by huge pages.
+ * Without memory budget, the blocks are carved from slabs of huge pages
+ * mapped on demand instead of being allocated one by one.
+ *
+ * With a NUMA node, the memory area of the budget and the slabs are bound to
+ * the node. Without memory budget, the blocks are carved from slabs mapped
+ * on demand, like with huge pages.
+ */
+struct rohc_ctxt_pool
+{
+	/** The list of the free blocks available for reuse */
+	void *free_blocks;
+	/** The number of free allocated blocks in the list */
+	size_t allocated_nr;
+
+	/** The memory area preallocated for the memory budget, NULL if none */
+	uint8_t *budget_mem;
+	/** The size (in bytes) of the memory budget */
+	size_t budget_len;
+	/** The number of bytes of the memory budget already carved */
+	size_t budget_used;
+
+	/** Whether the memory is backed by huge pages or not */
+	bool huge_pages;
+	/** The list of the slabs of huge pages mapped for the blocks */
+	void *slabs;
+	/** The number of bytes of the last slab already carved */
+	size_t slab_used;
+	/** The number of memory areas backed by explicit huge pages, the other
+	 *  areas are backed by transparent huge pages */
+	size_t huge_areas_nr;
+
+	/** The NUMA node the memory is bound to, ROHC_NUMA_NODE_ANY if none */
+	int numa_node;
+};
+
+
+/** The bump arena to carve the parts of one context from one block */
+struct rohc_ctxt_arena
+{
+	uint8_t *next;  /**< The beginning of the memory not carved yet */
+	size_t len;     /**< The length of the memory not carved yet */
+};
+
+
+/*
+ * Public function prototypes:
+ */
+
+void rohc_ctxt_pool_init(struct rohc_ctxt_pool *const pool)
+	__attribute__((nonnull(1)));
+
+void rohc_ctxt_pool_free(struct rohc_ctxt_pool *const pool)
+	__attribute__((nonnull(1)));
+
+bool rohc_ctxt_pool_set_budget(struct rohc_ctxt_pool *const pool,
+                               const size_t budget)
+	__attribute__((warn_unused_result, nonnull(1)));
+
+bool rohc_ctxt_pool_set_huge_pages(struct rohc_ctxt_pool *const pool,
+                                   const bool enabled)
+	__attribute__((warn_unused_result, nonnull(1)));
+
+void rohc_ctxt_pool_set_numa_node(struct rohc_ctxt_pool *const pool,
+                                  const int node)
+	__attribute__((nonnull(1)));
+
+void * rohc_ctxt_pool_alloc_area(const struct rohc_ctxt_pool *const pool,
+                                 const size_t len)
+	__attribute__((warn_unused_result, nonnull(1)));
+
+void rohc_ctxt_pool_free_area(const struct rohc_ctxt_pool *const pool,
+                              void *const mem,
+                              const size_t len)
+	__attribute__((nonnull(1)));
+
+void * rohc_ctxt_pool_get(struct rohc_ctxt_pool *const pool,
+                          const size_t size,
+                          struct rohc_ctxt_arena *const arena)
+	__attribute__((warn_unused_result, nonnull(1)));
+
+void rohc_ctxt_pool_put(struct rohc_ctxt_pool *const pool,
+                        void *const block)
+	__attribute__((nonnull(1)));
+
+#ifdef __KERNEL__
+
+/* in the Linux kernel, the on-demand blocks are provided by the kernel
+ * module from its preallocated memory pool, see linux/kmod_ctxt_pool.c */
+
+void * rohc_ctxt_block_alloc(const size_t size)
+	__attribute__((warn_unused_result));
+
+void rohc_ctxt_block_free(void *const block, const size_t size);
+
+#endif
+
+
+/**
+ * @brief Does the pool carve its blocks from slabs when it has no budget?
+ *
+ * @param pool  The pool
+ * @return      true if the pool uses huge pages or is bound to a NUMA node,
+ *              false otherwise
+ */
+static inline bool
+	rohc_ctxt_pool_has_slabs(const struct rohc_ctxt_pool *const pool)
+{
+	return (pool->huge_pages || pool->numa_node >= 0);
+}
+
+
+/**
+ * @brief Does the pool carve its blocks from its own memory areas?
+ *
+ * The blocks of such a pool cannot be given back to another pool, since the
+ * memory areas they are carved from are freed with their pool.
+ *
+ * @param pool  The pool
+ * @return      true if the pool has a memory budget, uses huge pages or is
+ *              bound to a NUMA node, false if its blocks are allocated one
+ *              by one
+ */
+static inline bool
+	rohc_ctxt_pool_owns_mem(const struct rohc_ctxt_pool *const pool)
+{
+	return (pool->budget_mem != NULL || rohc_ctxt_pool_has_slabs(pool));
+}
+
+
+/**
+ * @brief Get the size a part takes in a bump arena
+ *
+ * @param size  The size of the part
+ * @return      The size of the part once aligned
+ */
+static inline size_t rohc_ctxt_arena_size(const size_t size)
+{
+	return ROHC_CTXT_ARENA_SIZE(size);
+}
+
+
+/**
+ * @brief Carve one part from a bump arena
+ *
+ * The arena shall be large enough: the size of the block is computed with
+ * \ref rohc_ctxt_arena_size for all the parts of the context.
+ *
+ * @param arena  The bump arena
+ * @param size   The size of the part
+ * @return       The part, already zeroed
+ */
+static inline void * rohc_ctxt_arena_alloc(struct rohc_ctxt_arena *const arena,
+                                           const size_t size)
+{
+	const size_t aligned_size = rohc_ctxt_arena_size(size);
+	void *const part = arena->next;
+
+	if(aligned_size > arena->len)
+	{
+		return NULL;
+	}
+	arena->next += aligned_size;
+	arena->len -= aligned_size;
+
+	return part;
+}
+
+#endif
+
@@ -0,0 +1,161 @@
+/*
+ * Copyright 2016 Didier Barvaux
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+/**
+ * @file   common/rohc_cursor.h
+ * @brief  Read cursor on the bytes of one ROHC packet
+ * @author Didier Barvaux <didier@barvaux.org>
+ *
+ * The parsers check once that the packet is large enough for all the fields
+ * of one packet format, then read the fields one after the other with the
+ * cursor: the reads do not check the remaining length again, they only
+ * assert it. The cursor also counts the bytes read, that is the length of the
+ * ROHC header parsed so far.
+ */
+
+#ifndef ROHC_COMMON_CURSOR_H
+#define ROHC_COMMON_CURSOR_H
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <assert.h>
+#ifdef __KERNEL__
+#  include <linux/types.h>
+#else
+#  include <stdbool.h>
+#endif
+
+
+/** A read cursor on the bytes of one ROHC packet */
+struct rohc_cursor
+{
+	const uint8_t *start;  /**< The first byte of the data */
+	const uint8_t *data;   /**< The next byte to read */
+	size_t len;            /**< The number of bytes left to read */
+};
+
+
+/**
+ * @brief Initialize a read cursor on the given data
+ *
+ * @param cursor  The cursor to initialize
+ * @param data    The data to read
+ * @param len     The length of the data to read
+ */
+static inline void rohc_cursor_init(struct rohc_cursor *const cursor,
+                                    const uint8_t *const data,
+                                    const size_t len)
+{
+	cursor->start = data;
+	cursor->data = data;
+	cursor->len = len;
+}
+
+
+/**
+ * @brief Whether the given number of bytes are left to read or not
+ *
+ * This is the check to perform once for all the fields of one packet
+ * format before reading them.
+ *
+ * @param cursor  The cursor
+ * @param len     The number of bytes to read
+ * @return        true if there are enough bytes left, false otherwise
+ */
+static inline bool rohc_cursor_has(const struct rohc_cursor *const cursor,
+                                   const size_t len)
+{
+	return (cursor->len >= len);
+}
+
+
+/**
+ * @brief Get the number of bytes already read
+ *
+ * @param cursor  The cursor
+ * @return        The number of bytes read since the cursor was initialized
+ */
+static inline size_t rohc_cursor_offset(const struct rohc_cursor *const cursor)
+{
+	return (cursor->data - cursor->start);
+}
+
+
+/**
+ * @brief Skip the given number of bytes
+ *
+ * @param cursor  The cursor
+ * @param len     The number of bytes to skip, they shall be available
+ */
+static inline void rohc_cursor_skip(struct rohc_cursor *const cursor,
+                                    const size_t len)
+{
+	assert(cursor->len >= len);
+	cursor->data += len;
+	cursor->len -= len;
+}
+
+
+/**
+ * @brief Read the next byte without moving the cursor
+ *
+ * @param cursor  The cursor, one byte shall be available
+ * @return        The next byte
+ */
+static inline uint8_t rohc_cursor_peek8(const struct rohc_cursor *const cursor)
+{
+	assert(cursor->len >= 1);
+	return cursor->data[0];
+}
+
+
+/**
+ * @brief Read the next byte
+ *
+ * @param cursor  The cursor, one byte shall be available
+ * @return        The byte read
+ */
+static inline uint8_t rohc_cursor_get8(struct rohc_cursor *const cursor)
+{
+	const uint8_t value = rohc_cursor_peek8(cursor);
+	rohc_cursor_skip(cursor, 1);
+	return value;
+}
+
+
+/**
+ * @brief Read the next 16-bit field in network byte order
+ *
+ * @param cursor  The cursor, two bytes shall be available
+ * @return        The field read, in host byte order
+ */
+static inline uint16_t rohc_cursor_get16(struct rohc_cursor *const cursor)
+{
+	uint16_t value;
+
+	assert(cursor->len >= 2);
+	value = (((uint16_t) cursor->data[0]) << 8) | cursor->data[1];
+	rohc_cursor_skip(cursor, 2);
+
+	return value;
+}
+
+#endif
+
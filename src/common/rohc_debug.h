@@ -30,7 +30,7 @@
  * Includes
  */
 
-#include <stdlib.h> /* for free(3) */
+#include "rohc_alloc.h" /* for rohc_free() */
 
 
 /*
@@ -40,7 +40,7 @@
 /** Free a pointer plus set it to NULL to avoid hidden bugs */
 #define zfree(pointer) \
 	do { \
-		free(pointer); \
+		rohc_free(pointer); \
 		pointer = NULL; \
 	} while(0)
 
@@ -0,0 +1,123 @@
+/*
+ * Copyright 2016 Didier Barvaux
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/**
+ * @file   common/rohc_huge_pages.c
+ * @brief  Memory areas backed by huge pages
+ * @author Didier Barvaux <didier@barvaux.org>
+ */
+
+#include "rohc_huge_pages.h"
+
+#ifndef __KERNEL__
+#  include "config.h" /* for HAVE_SYS_MMAN_H */
+#  include <stdint.h>
+#  if HAVE_SYS_MMAN_H == 1
+#    include <sys/mman.h>
+#  endif
+#endif
+
+
+/**
+ * @brief Map one zeroed memory area backed by huge pages
+ *
+ * The area is first mapped with explicit huge pages (MAP_HUGETLB). If the
+ * system has not enough of them reserved, the area is mapped with normal
+ * pages and the kernel is advised to back it with transparent huge pages.
+ * The area is aligned on a huge page.
+ *
+ * Huge pages are not available in the Linux kernel nor on the systems
+ * without mmap(2): no area is mapped there.
+ *
+ * @param len           The length (in bytes) of the area, rounded up to a
+ *                      whole number of huge pages, see \ref rohc_huge_len
+ * @param[out] is_huge  Whether the area is backed by explicit huge pages
+ *                      (true) or by transparent huge pages (false)
+ * @return              The memory area, NULL if it cannot be mapped
+ */
+void * rohc_huge_alloc(const size_t len, bool *const is_huge)
+{
+#if !defined(__KERNEL__) && HAVE_SYS_MMAN_H == 1
+	const size_t map_len = rohc_huge_len(len);
+	uint8_t *mem;
+	size_t offset;
+
+	*is_huge = false;
+	if(len == 0)
+	{
+		goto error;
+	}
+
+#ifdef MAP_HUGETLB
+	mem = mmap(NULL, map_len, PROT_READ | PROT_WRITE,
+	           MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+	if(mem != MAP_FAILED)
+	{
+		*is_huge = true;
+		return mem;
+	}
+#endif
+
+	/* map one more huge page to align the area on a huge page, so that the
+	 * kernel may back all of it with transparent huge pages, then give the
+	 * unaligned head and tail back */
+	mem = mmap(NULL, map_len + ROHC_HUGE_PAGE_LEN, PROT_READ | PROT_WRITE,
+	           MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if(mem == MAP_FAILED)
+	{
+		goto error;
+	}
+	offset = (ROHC_HUGE_PAGE_LEN - ((uintptr_t) mem % ROHC_HUGE_PAGE_LEN)) %
+	         ROHC_HUGE_PAGE_LEN;
+	if(offset > 0)
+	{
+		munmap(mem, offset);
+	}
+	munmap(mem + offset + map_len, ROHC_HUGE_PAGE_LEN - offset);
+	mem += offset;
+#ifdef MADV_HUGEPAGE
+	madvise(mem, map_len, MADV_HUGEPAGE);
+#endif
+
+	return mem;
+
+error:
+	return NULL;
+#else
+	*is_huge = false;
+	return NULL;
+#endif
+}
+
+
+/**
+ * @brief Unmap one memory area mapped by \ref rohc_huge_alloc
+ *
+ * @param mem  The memory area, may be NULL
+ * @param len  The length (in bytes) given to \ref rohc_huge_alloc
+ */
+void rohc_huge_free(void *const mem, const size_t len)
+{
+#if !defined(__KERNEL__) && HAVE_SYS_MMAN_H == 1
+	if(mem != NULL)
+	{
+		munmap(mem, rohc_huge_len(len));
+	}
+#endif
+}
+
@@ -0,0 +1,69 @@
+/*
+ * Copyright 2016 Didier Barvaux
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/**
+ * @file   common/rohc_huge_pages.h
+ * @brief  Memory areas backed by huge pages
+ * @author Didier Barvaux <didier@barvaux.org>
+ *
+ * The memory of the contexts is spread over many pages when MAX_CID is large:
+ * the TLB misses slow the datapath down. The memory areas below are mapped
+ * with 2 MiB huge pages if the system has some reserved, or with transparent
+ * huge pages otherwise. They are mapped directly, without the allocator
+ * plugged by the application with \ref rohc_set_allocator.
+ */
+
+#ifndef ROHC_COMMON_HUGE_PAGES_H
+#define ROHC_COMMON_HUGE_PAGES_H
+
+#include <stdlib.h>
+#ifdef __KERNEL__
+#  include <linux/types.h>
+#else
+#  include <stdbool.h>
+#endif
+
+
+/** The length (in bytes) of one huge page */
+#define ROHC_HUGE_PAGE_LEN  (2U * 1024U * 1024U)
+
+
+/*
+ * Public function prototypes:
+ */
+
+void * rohc_huge_alloc(const size_t len, bool *const is_huge)
+	__attribute__((warn_unused_result, nonnull(2)));
+
+void rohc_huge_free(void *const mem, const size_t len);
+
+
+/**
+ * @brief Get the length of the memory area mapped for the given length
+ *
+ * @param len  The length (in bytes) of the memory area
+ * @return     The length rounded up to a whole number of huge pages
+ */
+static inline size_t rohc_huge_len(const size_t len)
+{
+	return ((len + ROHC_HUGE_PAGE_LEN - 1) &
+	        ~((size_t) ROHC_HUGE_PAGE_LEN - 1));
+}
+
+#endif
+
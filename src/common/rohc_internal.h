@@ -118,6 +118,20 @@
 #include "rohc.h"
 
 
+/**
+ * @brief The statistics counters of the compression and decompression contexts
+ *
+ * The counters are 32-bit wide in compact mode to reduce the memory footprint
+ * of deployments with many contexts, they are as wide as the platform words
+ * otherwise.
+ */
+#ifdef ROHC_COMPACT_CONTEXTS
+typedef uint32_t rohc_ctxt_counter_t;
+#else
+typedef size_t rohc_ctxt_counter_t;
+#endif
+
+
 /**
  * @brief ROHC medium (CID characteristics)
  */
@@ -24,6 +24,7 @@
  */
 
 #include "rohc_list.h"
+#include "rohc_alloc.h"
 
 #include <stdlib.h>
 #ifndef __KERNEL__
@@ -128,11 +129,30 @@ void rohc_list_item_reset(struct rohc_list_item *const list_item)
 	list_item->known = false;
 	list_item->counter = 0;
 
-	/* no data yet */
+	/* no data yet, but keep the memory allocated for the data */
 	list_item->length = 0;
 }
 
 
+/**
+ * @brief Free the memory allocated for the data of the given list item
+ *
+ * @param list_item  The item to free the data of
+ */
+void rohc_list_item_free(struct rohc_list_item *const list_item)
+{
+	assert(list_item != NULL);
+
+	rohc_list_item_reset(list_item);
+	if(list_item->data != NULL)
+	{
+		rohc_free(list_item->data);
+		list_item->data = NULL;
+	}
+	list_item->data_size = 0;
+}
+
+
 /**
  * @brief Update the content of the given compressed item if it changed
  *
@@ -193,11 +213,26 @@ static bool rohc_list_item_update(struct rohc_list_item *const list_item,
 
 	rohc_list_item_reset(list_item);
 
-	/* record new data for the item */
+	/* record new data for the item, the memory for the data is allocated
+	 * when the item is first used, and grows with the item if needed */
 	if(item_len > ROHC_LIST_ITEM_DATA_MAX)
 	{
 		return false;
 	}
+	if(item_len > list_item->data_size)
+	{
+		uint8_t *const new_data = rohc_malloc(item_len);
+		if(new_data == NULL)
+		{
+			return false;
+		}
+		if(list_item->data != NULL)
+		{
+			rohc_free(list_item->data);
+		}
+		list_item->data = new_data;
+		list_item->data_size = item_len;
+	}
 	memcpy(list_item->data, item_data, item_len);
 	list_item->length = item_len;
 	list_item->type = item_type;
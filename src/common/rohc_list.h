@@ -97,8 +97,10 @@ struct rohc_list_item
 
 	/** The length of the item data (in bytes) */
 	size_t length;
-	/** The item data */
-	uint8_t data[ROHC_LIST_ITEM_DATA_MAX];
+	/** The item data, allocated on demand, NULL if none was recorded yet */
+	uint8_t *data;
+	/** The size (in bytes) of the memory allocated for the item data */
+	size_t data_size;
 };
 
 
@@ -129,6 +131,9 @@ bool rohc_list_supersede(const struct rohc_list *const large,
 void rohc_list_item_reset(struct rohc_list_item *const list_item)
 	__attribute__((nonnull(1)));
 
+void rohc_list_item_free(struct rohc_list_item *const list_item)
+	__attribute__((nonnull(1)));
+
 int rohc_list_item_update_if_changed(rohc_list_item_cmp cmp_item,
                                      struct rohc_list_item *const list_item,
                                      const uint8_t item_type,
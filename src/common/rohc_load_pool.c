@@ -0,0 +1,300 @@
+/*
+ * Copyright 2016 Didier Barvaux
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/**
+ * @file   common/rohc_load_pool.c
+ * @brief  Pool of size-classed slots for small variable-length payloads
+ * @author Didier Barvaux <didier@barvaux.org>
+ */
+
+#include "rohc_load_pool.h"
+#include "rohc_alloc.h"
+
+#ifndef __KERNEL__
+#  include <string.h>
+#endif
+#include <assert.h>
+
+
+/** The end of the list of free slots */
+#define ROHC_LOAD_POOL_FREE_END  UINT32_MAX
+
+/** The max number of slabs of one class, so that references fit 32 bits */
+#define ROHC_LOAD_POOL_SLABS_MAX \
+	((UINT32_MAX - 1) / ROHC_LOAD_POOL_CLASSES_NR / ROHC_LOAD_POOL_SLAB_SLOTS)
+
+
+/** The lengths of the slots of the size classes */
+static const size_t rohc_load_pool_slot_lens[ROHC_LOAD_POOL_CLASSES_NR] =
+{
+	8, 16, 40, ROHC_LOAD_POOL_MAX_LEN
+};
+
+
+static uint8_t * rohc_load_pool_slot(const struct rohc_load_pool_class *const slots,
+                                     const uint32_t slot)
+	__attribute__((warn_unused_result, nonnull(1), pure));
+
+
+/**
+ * @brief Initialize an empty pool of payloads
+ *
+ * @param pool  The pool of payloads to initialize
+ */
+void rohc_load_pool_init(struct rohc_load_pool *const pool)
+{
+	size_t i;
+
+	for(i = 0; i < ROHC_LOAD_POOL_CLASSES_NR; i++)
+	{
+		struct rohc_load_pool_class *const slots = &pool->classes[i];
+
+		slots->slot_len = rohc_load_pool_slot_lens[i];
+		slots->slabs = NULL;
+		slots->slabs_nr = 0;
+		slots->slabs_max = 0;
+		slots->free_first = ROHC_LOAD_POOL_FREE_END;
+		slots->free_nr = 0;
+	}
+}
+
+
+/**
+ * @brief Free the slabs of the given pool of payloads
+ *
+ * All the references on the payloads of the pool become invalid.
+ *
+ * @param pool  The pool of payloads to free
+ */
+void rohc_load_pool_free(struct rohc_load_pool *const pool)
+{
+	size_t i;
+
+	for(i = 0; i < ROHC_LOAD_POOL_CLASSES_NR; i++)
+	{
+		struct rohc_load_pool_class *const slots = &pool->classes[i];
+		size_t j;
+
+		for(j = 0; j < slots->slabs_nr; j++)
+		{
+			rohc_free(slots->slabs[j]);
+		}
+		rohc_free(slots->slabs);
+	}
+	rohc_load_pool_init(pool);
+}
+
+
+/**
+ * @brief Get the size class of the slots for a payload of the given length
+ *
+ * @param len  The length of the payload, 1 to \ref ROHC_LOAD_POOL_MAX_LEN
+ * @return     The size class of the payload
+ */
+size_t rohc_load_pool_class(const size_t len)
+{
+	size_t class_id = 0;
+
+	assert(len > 0);
+	assert(len <= ROHC_LOAD_POOL_MAX_LEN);
+
+	while(rohc_load_pool_slot_lens[class_id] < len)
+	{
+		class_id++;
+	}
+
+	return class_id;
+}
+
+
+/**
+ * @brief Make sure that enough slots of one size class are free
+ *
+ * The slots are not taken: they stay free until they are used by the next
+ * calls to \ref rohc_load_pool_store, which then never fail.
+ *
+ * @param pool      The pool of payloads
+ * @param class_id  The size class, see \ref rohc_load_pool_class
+ * @param slots_nr  The number of slots that shall be free
+ * @return          true if enough slots are free, false if not enough memory
+ *                  is available
+ */
+bool rohc_load_pool_reserve(struct rohc_load_pool *const pool,
+                            const size_t class_id,
+                            const size_t slots_nr)
+{
+	struct rohc_load_pool_class *const slots = &pool->classes[class_id];
+
+	assert(class_id < ROHC_LOAD_POOL_CLASSES_NR);
+
+	while(slots->free_nr < slots_nr)
+	{
+		uint32_t slot;
+		uint8_t *slab;
+		size_t i;
+
+		if(slots->slabs_nr >= ROHC_LOAD_POOL_SLABS_MAX)
+		{
+			goto error;
+		}
+
+		/* enlarge the array of slabs if full */
+		if(slots->slabs_nr == slots->slabs_max)
+		{
+			const size_t slabs_max =
+				(slots->slabs_max == 0 ? 4 : slots->slabs_max * 2);
+			uint8_t **const slabs = rohc_malloc(slabs_max * sizeof(uint8_t *));
+
+			if(slabs == NULL)
+			{
+				goto error;
+			}
+			if(slots->slabs_nr > 0)
+			{
+				memcpy(slabs, slots->slabs, slots->slabs_nr * sizeof(uint8_t *));
+			}
+			rohc_free(slots->slabs);
+			slots->slabs = slabs;
+			slots->slabs_max = slabs_max;
+		}
+
+		/* carve the slots from one new slab, the first slot of the slab is the
+		 * first free slot after the loop */
+		slab = rohc_malloc(ROHC_LOAD_POOL_SLAB_SLOTS * slots->slot_len);
+		if(slab == NULL)
+		{
+			goto error;
+		}
+		slots->slabs[slots->slabs_nr] = slab;
+		slot = slots->slabs_nr * ROHC_LOAD_POOL_SLAB_SLOTS;
+		slots->slabs_nr++;
+		for(i = ROHC_LOAD_POOL_SLAB_SLOTS; i > 0; i--)
+		{
+			memcpy(slab + (i - 1) * slots->slot_len, &slots->free_first,
+			       sizeof(uint32_t));
+			slots->free_first = slot + i - 1;
+		}
+		slots->free_nr += ROHC_LOAD_POOL_SLAB_SLOTS;
+	}
+
+	return true;
+
+error:
+	return false;
+}
+
+
+/**
+ * @brief Store a payload in the pool in place of the payload of a reference
+ *
+ * The slot of the reference is reused if the new payload belongs to the same
+ * size class, otherwise it is released and a free slot is taken: one slot of
+ * the size class of the new payload shall have been reserved with
+ * \ref rohc_load_pool_reserve.
+ *
+ * @param pool      The pool of payloads
+ * @param[in,out] ref  The reference on the current payload, or
+ *                     \ref ROHC_LOAD_REF_NONE, updated with the reference
+ *                     on the new payload
+ * @param load      The new payload
+ * @param len       The length of the new payload, up to
+ *                  \ref ROHC_LOAD_POOL_MAX_LEN
+ */
+void rohc_load_pool_store(struct rohc_load_pool *const pool,
+                          rohc_load_ref_t *const ref,
+                          const uint8_t *const load,
+                          const size_t len)
+{
+	/* the payloads of 0 byte take no slot */
+	if(len == 0)
+	{
+		rohc_load_pool_put(pool, *ref);
+		*ref = ROHC_LOAD_REF_NONE;
+	}
+	else
+	{
+		const size_t class_id = rohc_load_pool_class(len);
+		struct rohc_load_pool_class *const slots = &pool->classes[class_id];
+		uint32_t slot;
+		uint8_t *mem;
+
+		/* reuse the slot of the current payload if the size class is the same */
+		if(*ref != ROHC_LOAD_REF_NONE &&
+		   ((*ref - 1) % ROHC_LOAD_POOL_CLASSES_NR) == class_id)
+		{
+			slot = (*ref - 1) / ROHC_LOAD_POOL_CLASSES_NR;
+			mem = rohc_load_pool_slot(slots, slot);
+		}
+		else
+		{
+			rohc_load_pool_put(pool, *ref);
+
+			/* take the first free slot */
+			assert(slots->free_nr > 0);
+			slot = slots->free_first;
+			mem = rohc_load_pool_slot(slots, slot);
+			memcpy(&slots->free_first, mem, sizeof(uint32_t));
+			slots->free_nr--;
+			*ref = slot * ROHC_LOAD_POOL_CLASSES_NR + class_id + 1;
+		}
+
+		if(mem != load)
+		{
+			memcpy(mem, load, len);
+		}
+	}
+}
+
+
+/**
+ * @brief Release the slot of a payload stored in the pool
+ *
+ * @param pool  The pool of payloads
+ * @param ref   The reference on the payload, nothing is done for
+ *              \ref ROHC_LOAD_REF_NONE
+ */
+void rohc_load_pool_put(struct rohc_load_pool *const pool,
+                        const rohc_load_ref_t ref)
+{
+	if(ref != ROHC_LOAD_REF_NONE)
+	{
+		struct rohc_load_pool_class *const slots =
+			&pool->classes[(ref - 1) % ROHC_LOAD_POOL_CLASSES_NR];
+		const uint32_t slot = (ref - 1) / ROHC_LOAD_POOL_CLASSES_NR;
+
+		memcpy(rohc_load_pool_slot(slots, slot), &slots->free_first,
+		       sizeof(uint32_t));
+		slots->free_first = slot;
+		slots->free_nr++;
+	}
+}
+
+
+/**
+ * @brief Get the memory of one slot of one size class
+ *
+ * @param slots  The size class
+ * @param slot   The index of the slot in the size class
+ * @return       The memory of the slot
+ */
+static uint8_t * rohc_load_pool_slot(const struct rohc_load_pool_class *const slots,
+                                     const uint32_t slot)
+{
+	return slots->slabs[slot / ROHC_LOAD_POOL_SLAB_SLOTS] +
+	       (slot % ROHC_LOAD_POOL_SLAB_SLOTS) * slots->slot_len;
+}
@@ -0,0 +1,136 @@
+/*
+ * Copyright 2016 Didier Barvaux
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/**
+ * @file   common/rohc_load_pool.h
+ * @brief  Pool of size-classed slots for small variable-length payloads
+ * @author Didier Barvaux <didier@barvaux.org>
+ *
+ * The contexts that remember payloads of variable lengths, eg. the TCP
+ * generic options, do not embed a buffer large enough for the longest
+ * payload. They store the payloads in slots of one pool shared by all the
+ * contexts of the compressor or decompressor, and keep a reference on the
+ * slot only. The slots are grouped in a few size classes, and carved from
+ * slabs that are never moved, so that a payload stays at the same place
+ * until its slot is released.
+ */
+
+#ifndef ROHC_COMMON_LOAD_POOL_H
+#define ROHC_COMMON_LOAD_POOL_H
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stddef.h>
+#ifdef __KERNEL__
+#  include <linux/types.h>
+#else
+#  include <stdbool.h>
+#endif
+
+
+/** The number of size classes of the slots */
+#define ROHC_LOAD_POOL_CLASSES_NR  4U
+
+/** The max length of one payload stored in the pool */
+#define ROHC_LOAD_POOL_MAX_LEN  128U
+
+/** The number of slots carved from one slab */
+#define ROHC_LOAD_POOL_SLAB_SLOTS  64U
+
+/** The reference on one payload stored in the pool */
+typedef uint32_t rohc_load_ref_t;
+
+/** The reference on no payload, the payloads of 0 byte are not stored */
+#define ROHC_LOAD_REF_NONE  ((rohc_load_ref_t) 0)
+
+
+/** The slots of one size class */
+struct rohc_load_pool_class
+{
+	/** The length of one slot */
+	size_t slot_len;
+	/** The slabs the slots are carved from */
+	uint8_t **slabs;
+	/** The number of slabs */
+	size_t slabs_nr;
+	/** The max number of slabs before the array of slabs is enlarged */
+	size_t slabs_max;
+	/** The first free slot, the next free slot is written in the slot */
+	uint32_t free_first;
+	/** The number of free slots */
+	size_t free_nr;
+};
+
+
+/** The pool of slots for payloads */
+struct rohc_load_pool
+{
+	/** The size classes, from the smallest slots to the largest ones */
+	struct rohc_load_pool_class classes[ROHC_LOAD_POOL_CLASSES_NR];
+};
+
+
+/*
+ * Public function prototypes:
+ */
+
+void rohc_load_pool_init(struct rohc_load_pool *const pool)
+	__attribute__((nonnull(1)));
+
+void rohc_load_pool_free(struct rohc_load_pool *const pool)
+	__attribute__((nonnull(1)));
+
+size_t rohc_load_pool_class(const size_t len)
+	__attribute__((warn_unused_result, pure));
+
+bool rohc_load_pool_reserve(struct rohc_load_pool *const pool,
+                            const size_t class_id,
+                            const size_t slots_nr)
+	__attribute__((warn_unused_result, nonnull(1)));
+
+void rohc_load_pool_store(struct rohc_load_pool *const pool,
+                          rohc_load_ref_t *const ref,
+                          const uint8_t *const load,
+                          const size_t len)
+	__attribute__((nonnull(1, 2)));
+
+void rohc_load_pool_put(struct rohc_load_pool *const pool,
+                        const rohc_load_ref_t ref)
+	__attribute__((nonnull(1)));
+
+
+/**
+ * @brief Get the payload stored in the pool for the given reference
+ *
+ * @param pool  The pool of payloads
+ * @param ref   The reference on the payload, not \ref ROHC_LOAD_REF_NONE
+ * @return      The payload, valid until its slot is released
+ */
+static inline const uint8_t *
+	rohc_load_pool_get(const struct rohc_load_pool *const pool,
+	                   const rohc_load_ref_t ref)
+{
+	const size_t class_id = (ref - 1) % ROHC_LOAD_POOL_CLASSES_NR;
+	const size_t slot = (ref - 1) / ROHC_LOAD_POOL_CLASSES_NR;
+	const struct rohc_load_pool_class *const slots = &pool->classes[class_id];
+
+	return slots->slabs[slot / ROHC_LOAD_POOL_SLAB_SLOTS] +
+	       (slot % ROHC_LOAD_POOL_SLAB_SLOTS) * slots->slot_len;
+}
+
+#endif
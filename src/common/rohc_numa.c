@@ -0,0 +1,171 @@
+/*
+ * Copyright 2016 Didier Barvaux
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/**
+ * @file   common/rohc_numa.c
+ * @brief  Memory areas placed on one NUMA node
+ * @author Didier Barvaux <didier@barvaux.org>
+ */
+
+#include "rohc_numa.h"
+#include "rohc.h"
+#include "rohc_alloc.h"
+
+#ifndef __KERNEL__
+#  include "config.h" /* for HAVE_SYS_MMAN_H */
+#  include <stdint.h>
+#  include <limits.h>
+#  if HAVE_SYS_MMAN_H == 1
+#    include <sys/mman.h>
+#  endif
+#  ifdef __linux__
+#    include <unistd.h>
+#    include <sys/syscall.h>
+#  endif
+#endif
+
+#if !defined(__KERNEL__) && HAVE_SYS_MMAN_H == 1 && defined(SYS_mbind)
+#  define ROHC_NUMA_SUPPORTED 1
+#else
+#  define ROHC_NUMA_SUPPORTED 0
+#endif
+
+/** The memory policy that prefers one node, see mbind(2) */
+#define ROHC_MPOL_PREFERRED  1
+
+#if ROHC_NUMA_SUPPORTED == 1
+/** The number of bits in one word of the mask of NUMA nodes */
+#  define ROHC_NUMA_WORD_BITS  (sizeof(unsigned long) * CHAR_BIT)
+#endif
+
+
+/**
+ * @brief Bind one memory area to one NUMA node
+ *
+ * The pages of the area that are not allocated yet will be allocated on the
+ * given node, or on another node if the given one has no free memory left.
+ * The area shall be aligned on a page.
+ *
+ * NUMA nodes are not available in the Linux kernel nor on the systems without
+ * mmap(2) and mbind(2): no area can be bound there.
+ *
+ * @param mem   The memory area, aligned on a page
+ * @param len   The length (in bytes) of the memory area
+ * @param node  The NUMA node, \ref ROHC_NUMA_NODE_ANY to keep the default
+ *              placement
+ * @return      true if the area is bound to the node, false if the node does
+ *              not exist or if NUMA nodes are not supported
+ */
+bool rohc_numa_bind(void *const mem, const size_t len, const int node)
+{
+#if ROHC_NUMA_SUPPORTED == 1
+	unsigned long nodes_mask[ROHC_NUMA_NODES_MAX / ROHC_NUMA_WORD_BITS] = { 0 };
+#endif
+
+	if(node == ROHC_NUMA_NODE_ANY)
+	{
+		return true;
+	}
+#if ROHC_NUMA_SUPPORTED == 1
+	if(node < 0 || ((unsigned int) node) >= ROHC_NUMA_NODES_MAX)
+	{
+		return false;
+	}
+	nodes_mask[node / ROHC_NUMA_WORD_BITS] |=
+		1UL << (node % ROHC_NUMA_WORD_BITS);
+
+	/* the kernel ignores the last bit of the mask */
+	return (syscall(SYS_mbind, mem, len, ROHC_MPOL_PREFERRED, nodes_mask,
+	                ROHC_NUMA_NODES_MAX + 1, 0) == 0);
+#else
+	(void) mem;
+	(void) len;
+	return false;
+#endif
+}
+
+
+/**
+ * @brief Allocate one zeroed memory area on one NUMA node
+ *
+ * The area is mapped directly and bound to the node if a NUMA node is given,
+ * it is allocated with the allocator of the library otherwise.
+ *
+ * @param len   The length (in bytes) of the memory area
+ * @param node  The NUMA node, \ref ROHC_NUMA_NODE_ANY for the default
+ *              placement
+ * @return      The memory area, NULL if it cannot be allocated or bound to
+ *              the node
+ */
+void * rohc_numa_alloc(const size_t len, const int node)
+{
+#if ROHC_NUMA_SUPPORTED == 1
+	void *mem;
+#endif
+
+	if(node == ROHC_NUMA_NODE_ANY)
+	{
+		return rohc_calloc(1, len);
+	}
+#if ROHC_NUMA_SUPPORTED == 1
+	if(len == 0)
+	{
+		return NULL;
+	}
+	mem = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS,
+	           -1, 0);
+	if(mem == MAP_FAILED)
+	{
+		return NULL;
+	}
+	if(!rohc_numa_bind(mem, len, node))
+	{
+		munmap(mem, len);
+		return NULL;
+	}
+
+	return mem;
+#else
+	return NULL;
+#endif
+}
+
+
+/**
+ * @brief Free one memory area allocated by \ref rohc_numa_alloc
+ *
+ * @param mem   The memory area, may be NULL
+ * @param len   The length (in bytes) given to \ref rohc_numa_alloc
+ * @param node  The NUMA node given to \ref rohc_numa_alloc
+ */
+void rohc_numa_free(void *const mem, const size_t len, const int node)
+{
+	if(node == ROHC_NUMA_NODE_ANY)
+	{
+		rohc_free(mem);
+	}
+#if ROHC_NUMA_SUPPORTED == 1
+	else if(mem != NULL)
+	{
+		munmap(mem, len);
+	}
+#else
+	(void) len;
+#endif
+}
+
@@ -0,0 +1,60 @@
+/*
+ * Copyright 2016 Didier Barvaux
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/**
+ * @file   common/rohc_numa.h
+ * @brief  Memory areas placed on one NUMA node
+ * @author Didier Barvaux <didier@barvaux.org>
+ *
+ * The compressors and decompressors are often created by one control thread
+ * but driven by worker threads running on another NUMA node: every access to
+ * the contexts then pays the latency of the remote memory. The memory areas
+ * below are mapped directly and bound to the NUMA node of the workers, the
+ * kernel then allocates their pages on that node. No NUMA library is needed,
+ * the mbind(2) system call is used.
+ */
+
+#ifndef ROHC_COMMON_NUMA_H
+#define ROHC_COMMON_NUMA_H
+
+#include <stdlib.h>
+#ifdef __KERNEL__
+#  include <linux/types.h>
+#else
+#  include <stdbool.h>
+#endif
+
+
+/** The max number of NUMA nodes the memory areas may be bound to */
+#define ROHC_NUMA_NODES_MAX  1024U
+
+
+/*
+ * Public function prototypes:
+ */
+
+bool rohc_numa_bind(void *const mem, const size_t len, const int node)
+	__attribute__((warn_unused_result));
+
+void * rohc_numa_alloc(const size_t len, const int node)
+	__attribute__((warn_unused_result));
+
+void rohc_numa_free(void *const mem, const size_t len, const int node);
+
+#endif
+
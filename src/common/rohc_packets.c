@@ -117,6 +117,21 @@ const char * rohc_get_packet_descr(const rohc_packet_t packet_type)
 		case ROHC_PACKET_TCP_SEQ_8:
 			return "TCP/seq_8";
 
+		case ROHC_PACKET_PT_0_CRC3:
+			return "ROHCv2/pt_0_crc3";
+		case ROHC_PACKET_PT_0_CRC7:
+			return "ROHCv2/pt_0_crc7";
+		case ROHC_PACKET_PT_1_SEQ_ID:
+			return "ROHCv2/pt_1_seq_id";
+		case ROHC_PACKET_PT_2_SEQ_ID:
+			return "ROHCv2/pt_2_seq_id";
+		case ROHC_PACKET_CO_COMMON:
+			return "ROHCv2/co_common";
+		case ROHC_PACKET_PT_1_RND:
+			return "ROHCv2/pt_1_rnd";
+		case ROHC_PACKET_PT_2_RND:
+			return "ROHCv2/pt_2_rnd";
+
 		case ROHC_PACKET_UNKNOWN:
 		case ROHC_PACKET_MAX:
 		default:
@@ -287,6 +302,34 @@ rohc_packet_t rohc_get_packet_type(const char *const packet_id)
 	{
 		return ROHC_PACKET_TCP_SEQ_8;
 	}
+	else if(strcmp(packet_id, "rohcv2-pt-0-crc3") == 0)
+	{
+		return ROHC_PACKET_PT_0_CRC3;
+	}
+	else if(strcmp(packet_id, "rohcv2-pt-0-crc7") == 0)
+	{
+		return ROHC_PACKET_PT_0_CRC7;
+	}
+	else if(strcmp(packet_id, "rohcv2-pt-1-seq-id") == 0)
+	{
+		return ROHC_PACKET_PT_1_SEQ_ID;
+	}
+	else if(strcmp(packet_id, "rohcv2-pt-2-seq-id") == 0)
+	{
+		return ROHC_PACKET_PT_2_SEQ_ID;
+	}
+	else if(strcmp(packet_id, "rohcv2-co-common") == 0)
+	{
+		return ROHC_PACKET_CO_COMMON;
+	}
+	else if(strcmp(packet_id, "rohcv2-pt-1-rnd") == 0)
+	{
+		return ROHC_PACKET_PT_1_RND;
+	}
+	else if(strcmp(packet_id, "rohcv2-pt-2-rnd") == 0)
+	{
+		return ROHC_PACKET_PT_2_RND;
+	}
 	else
 	{
 		return ROHC_PACKET_UNKNOWN;
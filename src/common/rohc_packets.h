@@ -93,6 +93,15 @@ typedef enum
 	ROHC_PACKET_TCP_SEQ_7     = 30, /**< TCP seq_7 packet */
 	ROHC_PACKET_TCP_SEQ_8     = 31, /**< TCP seq_8 packet */
 
+	/* packets for ROHCv2 profiles */
+	ROHC_PACKET_PT_0_CRC3     = 32, /**< ROHCv2 pt_0_crc3 packet */
+	ROHC_PACKET_PT_0_CRC7     = 33, /**< ROHCv2 pt_0_crc7 packet */
+	ROHC_PACKET_PT_1_SEQ_ID   = 34, /**< ROHCv2 pt_1_seq_id packet */
+	ROHC_PACKET_PT_2_SEQ_ID   = 35, /**< ROHCv2 pt_2_seq_id packet */
+	ROHC_PACKET_CO_COMMON     = 36, /**< ROHCv2 co_common packet */
+	ROHC_PACKET_PT_1_RND      = 37, /**< ROHCv2 pt_1_rnd packet (RTP profile) */
+	ROHC_PACKET_PT_2_RND      = 38, /**< ROHCv2 pt_2_rnd packet (RTP profile) */
+
 	ROHC_PACKET_MAX                 /**< The number of packet types */
 } rohc_packet_t;
 
@@ -0,0 +1,139 @@
+/*
+ * Copyright 2016 Didier Barvaux
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/**
+ * @file   common/rohc_pkt_log.c
+ * @brief  Log of the last packets handled by one compressor or decompressor
+ * @author Didier Barvaux <didier@barvaux.org>
+ */
+
+#include "rohc_pkt_log.h"
+#include "rohc_alloc.h"
+
+
+/**
+ * @brief Initialize a disabled log of packets
+ *
+ * @param log  The log of packets to initialize
+ */
+void rohc_pkt_log_init(struct rohc_pkt_log *const log)
+{
+	log->records = NULL;
+	log->mask = 0;
+	log->next = 0;
+}
+
+
+/**
+ * @brief Free the records of the given log of packets
+ *
+ * @param log  The log of packets to free
+ */
+void rohc_pkt_log_free(struct rohc_pkt_log *const log)
+{
+	rohc_free(log->records);
+	rohc_pkt_log_init(log);
+}
+
+
+/**
+ * @brief Enable, resize or disable the given log of packets
+ *
+ * The records already written are dropped.
+ *
+ * @param log         The log of packets
+ * @param records_nr  The number of records of the log, a power of 2, or 0 to
+ *                    disable the log
+ * @return            true if the log was enabled, resized or disabled,
+ *                    false if the number of records is not a power of 2 or
+ *                    in case of memory allocation failure
+ */
+bool rohc_pkt_log_set_size(struct rohc_pkt_log *const log,
+                           const size_t records_nr)
+{
+	rohc_pkt_log_record_t *records;
+
+	if(records_nr == 0)
+	{
+		rohc_pkt_log_free(log);
+		goto skip;
+	}
+	if((records_nr & (records_nr - 1)) != 0)
+	{
+		goto error;
+	}
+
+	records = rohc_calloc(records_nr, sizeof(rohc_pkt_log_record_t));
+	if(records == NULL)
+	{
+		goto error;
+	}
+	rohc_pkt_log_free(log);
+	log->records = records;
+	log->mask = records_nr - 1;
+
+skip:
+	return true;
+
+error:
+	return false;
+}
+
+
+/**
+ * @brief Copy the last records of the given log of packets, oldest first
+ *
+ * @param log              The log of packets
+ * @param[out] records     The array where to copy the records
+ * @param records_max      The max number of records in the array
+ * @param[out] records_nr  The number of records copied in the array
+ */
+void rohc_pkt_log_copy(const struct rohc_pkt_log *const log,
+                       rohc_pkt_log_record_t *const records,
+                       const size_t records_max,
+                       size_t *const records_nr)
+{
+	size_t nr;
+	size_t pos;
+	size_t i;
+
+	if(!rohc_pkt_log_enabled(log))
+	{
+		*records_nr = 0;
+		return;
+	}
+
+	/* the newest records that fit in both the log and the array */
+	nr = log->next;
+	if(nr > (log->mask + 1))
+	{
+		nr = log->mask + 1;
+	}
+	if(nr > records_max)
+	{
+		nr = records_max;
+	}
+
+	pos = log->next - nr;
+	for(i = 0; i < nr; i++)
+	{
+		records[i] = log->records[(pos + i) & log->mask];
+	}
+	*records_nr = nr;
+}
+
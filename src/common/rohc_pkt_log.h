@@ -0,0 +1,109 @@
+/*
+ * Copyright 2016 Didier Barvaux
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/**
+ * @file   common/rohc_pkt_log.h
+ * @brief  Log of the last packets handled by one compressor or decompressor
+ * @author Didier Barvaux <didier@barvaux.org>
+ *
+ * The log is a ring of fixed-size binary records: recording one packet is a
+ * few stores in the next record, the oldest records are overwritten. The log
+ * is much cheaper than the traces, so it may be left enabled to understand
+ * what happened to the last packets once a problem is detected.
+ */
+
+#ifndef ROHC_COMMON_PKT_LOG_H
+#define ROHC_COMMON_PKT_LOG_H
+
+#include "rohc.h"
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stddef.h>
+#ifdef __KERNEL__
+#  include <linux/types.h>
+#else
+#  include <stdbool.h>
+#endif
+
+
+/** The log of the last packets */
+struct rohc_pkt_log
+{
+	/** The ring of records, NULL if the log is disabled */
+	rohc_pkt_log_record_t *records;
+	/** The number of records minus one, the number of records is a power
+	 *  of 2 */
+	size_t mask;
+	/** The number of records ever written, the next record to write is at
+	 *  index (next & mask) */
+	size_t next;
+};
+
+
+/*
+ * Public function prototypes:
+ */
+
+void rohc_pkt_log_init(struct rohc_pkt_log *const log)
+	__attribute__((nonnull(1)));
+
+void rohc_pkt_log_free(struct rohc_pkt_log *const log)
+	__attribute__((nonnull(1)));
+
+bool rohc_pkt_log_set_size(struct rohc_pkt_log *const log,
+                           const size_t records_nr)
+	__attribute__((warn_unused_result, nonnull(1)));
+
+void rohc_pkt_log_copy(const struct rohc_pkt_log *const log,
+                       rohc_pkt_log_record_t *const records,
+                       const size_t records_max,
+                       size_t *const records_nr)
+	__attribute__((nonnull(1, 2, 4)));
+
+
+/**
+ * @brief Whether the given log of packets is enabled or not
+ *
+ * @param log  The log of packets
+ * @return     true if packets shall be recorded, false otherwise
+ */
+static inline bool rohc_pkt_log_enabled(const struct rohc_pkt_log *const log)
+{
+	return (log->records != NULL);
+}
+
+
+/**
+ * @brief Get the next record of the log to write, overwriting the oldest one
+ *
+ * The log shall be enabled.
+ *
+ * @param log  The log of packets
+ * @return     The record to fill
+ */
+static inline rohc_pkt_log_record_t *
+	rohc_pkt_log_next(struct rohc_pkt_log *const log)
+{
+	rohc_pkt_log_record_t *const record = &log->records[log->next & log->mask];
+	log->next++;
+	return record;
+}
+
+#endif
+
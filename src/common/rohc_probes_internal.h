@@ -0,0 +1,85 @@
+/*
+ * Copyright 2016 Didier Barvaux
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/**
+ * @file   common/rohc_probes_internal.h
+ * @brief  Static probes (USDT) on the processing paths of packets
+ * @author Didier Barvaux <didier@barvaux.org>
+ *
+ * The probes are built only if the library was built with the
+ * --enable-rohc-probes option of the configure script, they are then
+ * available to SystemTap, bpftrace or perf under the 'rohc' provider. An
+ * inactive probe costs one no-op instruction. Otherwise, the probes and the
+ * computation of their arguments are removed at build time. The probes are
+ * never built in the Linux kernel module.
+ *
+ * The probes of the compressor:
+ *  \li comp_start(comp, uncomp_len): rohc_compress4() starts,
+ *  \li comp_done(comp, status, rohc_len): rohc_compress4() returns,
+ *  \li comp_packet(cid, profile, packet_type, uncomp_hdr_len, rohc_hdr_len):
+ *      a packet was compressed, whatever the function of the API,
+ *  \li comp_ctxt_create(cid, profile): a context was created,
+ *  \li comp_ctxt_recycle(cid, profile): a context is recycled for another
+ *      flow,
+ *  \li comp_feedback(cid, profile, feedback_type, feedback_len): a feedback
+ *      was delivered to a context.
+ *
+ * The probes of the decompressor:
+ *  \li decomp_start(decomp, rohc_len): rohc_decompress3() starts,
+ *  \li decomp_done(decomp, status, uncomp_len): rohc_decompress3() returns,
+ *  \li decomp_packet(cid, profile, packet_type, rohc_len, uncomp_len): a
+ *      packet was decompressed, whatever the function of the API,
+ *  \li decomp_ctxt_create(cid, profile): a context was created,
+ *  \li decomp_crc_failure(cid, profile, packet_type): a packet was dropped
+ *      because of a CRC failure,
+ *  \li decomp_crc_repair(cid, profile, algo): a repair of the context is
+ *      attempted after a CRC failure,
+ *  \li decomp_crc_repaired(cid, profile, algo): the repair was confirmed by
+ *      the following packets.
+ */
+
+#ifndef ROHC_COMMON_PROBES_INTERNAL_H
+#define ROHC_COMMON_PROBES_INTERNAL_H
+
+#if defined(ROHC_PROBES) && !defined(__KERNEL__)
+
+#include <sys/sdt.h>
+
+#define ROHC_PROBE2(name, a1, a2) \
+	DTRACE_PROBE2(rohc, name, a1, a2)
+#define ROHC_PROBE3(name, a1, a2, a3) \
+	DTRACE_PROBE3(rohc, name, a1, a2, a3)
+#define ROHC_PROBE4(name, a1, a2, a3, a4) \
+	DTRACE_PROBE4(rohc, name, a1, a2, a3, a4)
+#define ROHC_PROBE5(name, a1, a2, a3, a4, a5) \
+	DTRACE_PROBE5(rohc, name, a1, a2, a3, a4, a5)
+
+#else
+
+#define ROHC_PROBE2(name, a1, a2) \
+	do { } while(0)
+#define ROHC_PROBE3(name, a1, a2, a3) \
+	do { } while(0)
+#define ROHC_PROBE4(name, a1, a2, a3, a4) \
+	do { } while(0)
+#define ROHC_PROBE5(name, a1, a2, a3, a4, a5) \
+	do { } while(0)
+
+#endif
+
+#endif
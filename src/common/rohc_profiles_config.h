@@ -0,0 +1,124 @@
+/*
+ * Copyright 2016 Didier Barvaux
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/**
+ * @file   common/rohc_profiles_config.h
+ * @brief  The set of ROHC profiles built in the library
+ * @author Didier Barvaux <didier@barvaux.org>
+ *
+ * All the profiles are built by default. The configure option
+ * --enable-rohc-profiles=LIST (or the ROHC_PROFILES variable of the Linux
+ * kernel module) defines one ROHC_WITHOUT_PROFILE_xxx macro for every
+ * profile left out: the profile is then absent from the profile tables of
+ * the compressor and decompressor, and its sources are not built at all.
+ * The Uncompressed profile is always built.
+ */
+
+#ifndef ROHC_COMMON_PROFILES_CONFIG_H
+#define ROHC_COMMON_PROFILES_CONFIG_H
+
+/** Whether the ROHCv1 IP-only profile is built */
+#ifdef ROHC_WITHOUT_PROFILE_IP
+#  define ROHC_PROFILE_IP_BUILT       0U
+#else
+#  define ROHC_PROFILE_IP_BUILT       1U
+#endif
+
+/** Whether the ROHCv1 IP/UDP profile is built */
+#ifdef ROHC_WITHOUT_PROFILE_UDP
+#  define ROHC_PROFILE_UDP_BUILT      0U
+#else
+#  define ROHC_PROFILE_UDP_BUILT      1U
+#endif
+
+/** Whether the ROHCv1 IP/UDP/RTP profile is built */
+#ifdef ROHC_WITHOUT_PROFILE_RTP
+#  define ROHC_PROFILE_RTP_BUILT      0U
+#else
+#  define ROHC_PROFILE_RTP_BUILT      1U
+#endif
+
+/** Whether the ROHCv1 IP/ESP profile is built */
+#ifdef ROHC_WITHOUT_PROFILE_ESP
+#  define ROHC_PROFILE_ESP_BUILT      0U
+#else
+#  define ROHC_PROFILE_ESP_BUILT      1U
+#endif
+
+/** Whether the ROHCv1 IP/UDP-Lite profile is built */
+#ifdef ROHC_WITHOUT_PROFILE_UDPLITE
+#  define ROHC_PROFILE_UDPLITE_BUILT  0U
+#else
+#  define ROHC_PROFILE_UDPLITE_BUILT  1U
+#endif
+
+/** Whether the ROHCv1 IP/TCP profile is built */
+#ifdef ROHC_WITHOUT_PROFILE_TCP
+#  define ROHC_PROFILE_TCP_BUILT      0U
+#else
+#  define ROHC_PROFILE_TCP_BUILT      1U
+#endif
+
+/** Whether the ROHCv2 IP/UDP/RTP profile is built */
+#ifdef ROHC_WITHOUT_PROFILE_V2RTP
+#  define ROHCv2_PROFILE_IP_UDP_RTP_BUILT 0U
+#else
+#  define ROHCv2_PROFILE_IP_UDP_RTP_BUILT 1U
+#endif
+
+/** Whether the ROHCv2 IP/UDP profile is built */
+#ifdef ROHC_WITHOUT_PROFILE_V2UDP
+#  define ROHCv2_PROFILE_IP_UDP_BUILT 0U
+#else
+#  define ROHCv2_PROFILE_IP_UDP_BUILT 1U
+#endif
+
+/** Whether the ROHCv2 IP/ESP profile is built */
+#ifdef ROHC_WITHOUT_PROFILE_V2ESP
+#  define ROHCv2_PROFILE_IP_ESP_BUILT 0U
+#else
+#  define ROHCv2_PROFILE_IP_ESP_BUILT 1U
+#endif
+
+/** Whether the ROHCv2 IP-only profile is built */
+#ifdef ROHC_WITHOUT_PROFILE_V2IP
+#  define ROHCv2_PROFILE_IP_BUILT     0U
+#else
+#  define ROHCv2_PROFILE_IP_BUILT     1U
+#endif
+
+/** The number of profiles built, the Uncompressed profile included */
+#define ROHC_PROFILES_BUILT_NR \
+	(1U + ROHC_PROFILE_IP_BUILT + ROHC_PROFILE_UDP_BUILT + \
+	 ROHC_PROFILE_RTP_BUILT + ROHC_PROFILE_ESP_BUILT + \
+	 ROHC_PROFILE_UDPLITE_BUILT + ROHC_PROFILE_TCP_BUILT + \
+	 ROHCv2_PROFILE_IP_UDP_RTP_BUILT + ROHCv2_PROFILE_IP_UDP_BUILT + \
+	 ROHCv2_PROFILE_IP_ESP_BUILT + \
+	 ROHCv2_PROFILE_IP_BUILT)
+
+/**
+ * @brief The location of one profile in a table of the profiles built
+ *
+ * @param built  Whether the profile is built or not
+ * @param idx    The location of the profile if built
+ * @param none   The location that stands for the profiles not built
+ */
+#define ROHC_PROFILE_LOC(built, idx, none) \
+	((built) ? (idx) : (none))
+
+#endif
@@ -0,0 +1,140 @@
+/*
+ * Copyright 2016 Didier Barvaux
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/**
+ * @file   common/rohc_seqcount.h
+ * @brief  Sequence counters to read statistics without lock
+ * @author Didier Barvaux <didier@barvaux.org>
+ *
+ * The statistics of the contexts are updated by the thread that compresses
+ * or decompresses packets, and they may be read at the same time by one
+ * monitoring thread. The writer makes the sequence counter odd while it
+ * updates the statistics, the reader copies the statistics and retries if
+ * the sequence counter changed meanwhile. The writer never waits for the
+ * reader.
+ */
+
+#ifndef ROHC_COMMON_SEQCOUNT_H
+#define ROHC_COMMON_SEQCOUNT_H
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stddef.h>
+#ifdef __KERNEL__
+#  include <linux/types.h>
+#else
+#  include <stdbool.h>
+#endif
+
+
+/** The length (in bytes) of one cache line */
+#define ROHC_CACHE_LINE_LEN  64U
+
+
+/** The sequence counter of a group of statistics */
+typedef uint32_t rohc_seqcount_t;
+
+
+/**
+ * @brief Align a memory area on the next cache line
+ *
+ * The memory area shall have been allocated with \ref ROHC_CACHE_LINE_LEN
+ * more bytes than required.
+ *
+ * @param mem  The memory area
+ * @return     The beginning of the first cache line within the memory area
+ */
+static inline void * rohc_cache_line_align(void *const mem)
+{
+	const uintptr_t addr = (uintptr_t) mem;
+	const uintptr_t mask = ROHC_CACHE_LINE_LEN - 1;
+
+	return (void *) ((addr + mask) & ~mask);
+}
+
+
+/**
+ * @brief Start updating the statistics protected by a sequence counter
+ *
+ * Only one writer is allowed at a time.
+ *
+ * @param seq  The sequence counter of the statistics
+ */
+static inline void rohc_seqcount_write_begin(rohc_seqcount_t *const seq)
+{
+	const rohc_seqcount_t value = __atomic_load_n(seq, __ATOMIC_RELAXED);
+
+	__atomic_store_n(seq, value + 1, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+
+/**
+ * @brief Stop updating the statistics protected by a sequence counter
+ *
+ * @param seq  The sequence counter of the statistics
+ */
+static inline void rohc_seqcount_write_end(rohc_seqcount_t *const seq)
+{
+	const rohc_seqcount_t value = __atomic_load_n(seq, __ATOMIC_RELAXED);
+
+	__atomic_store_n(seq, value + 1, __ATOMIC_RELEASE);
+}
+
+
+/**
+ * @brief Start reading the statistics protected by a sequence counter
+ *
+ * Wait for the writer to complete its update if one is in progress.
+ *
+ * @param seq  The sequence counter of the statistics
+ * @return     The value of the sequence counter to give to
+ *             \ref rohc_seqcount_read_retry
+ */
+static inline rohc_seqcount_t
+	rohc_seqcount_read_begin(const rohc_seqcount_t *const seq)
+{
+	rohc_seqcount_t value;
+
+	do
+	{
+		value = __atomic_load_n(seq, __ATOMIC_ACQUIRE);
+	}
+	while((value & 1) != 0);
+
+	return value;
+}
+
+
+/**
+ * @brief Whether the statistics read shall be read again
+ *
+ * @param seq    The sequence counter of the statistics
+ * @param start  The value returned by \ref rohc_seqcount_read_begin
+ * @return       true if the statistics were updated meanwhile,
+ *               false if the statistics read are consistent
+ */
+static inline bool rohc_seqcount_read_retry(const rohc_seqcount_t *const seq,
+                                            const rohc_seqcount_t start)
+{
+	__atomic_thread_fence(__ATOMIC_ACQUIRE);
+	return (__atomic_load_n(seq, __ATOMIC_RELAXED) != start);
+}
+
+#endif
+
@@ -0,0 +1,104 @@
+/*
+ * Copyright 2016 Didier Barvaux
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/**
+ * @file   common/rohc_timings_internal.h
+ * @brief  Histograms of the durations of the processing phases
+ * @author Didier Barvaux <didier@barvaux.org>
+ *
+ * The durations are recorded only if the library was built with the
+ * --enable-rohc-timings option of the configure script and if the timings
+ * feature is enabled on the compressor or decompressor. Otherwise, the
+ * clock is never read and the recording code is optimized out.
+ */
+
+#ifndef ROHC_COMMON_TIMINGS_INTERNAL_H
+#define ROHC_COMMON_TIMINGS_INTERNAL_H
+
+#include "rohc.h"
+
+#include <stdint.h>
+#ifdef __KERNEL__
+#  include <linux/timex.h>
+#elif !defined(__i386__) && !defined(__x86_64__)
+#  include <time.h>
+#endif
+
+
+/** Whether the library was built with support for timings */
+#ifdef ROHC_TIMINGS
+#  define ROHC_TIMINGS_BUILT  1
+#else
+#  define ROHC_TIMINGS_BUILT  0
+#endif
+
+
+/** A duration or a timestamp in ticks */
+typedef uint64_t rohc_ticks_t;
+
+
+/**
+ * @brief Read the fastest clock available
+ *
+ * @return  The current time in ticks
+ */
+static inline rohc_ticks_t rohc_ticks_now(void)
+{
+#if defined(__KERNEL__)
+	return get_cycles();
+#elif defined(__i386__) || defined(__x86_64__)
+	return __builtin_ia32_rdtsc();
+#else
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return ((uint64_t) now.tv_sec) * 1000000000U + now.tv_nsec;
+#endif
+}
+
+
+/**
+ * @brief Add one duration to a histogram of timings
+ *
+ * @param histo  The histogram to update
+ * @param ticks  The duration to add (in ticks)
+ */
+static inline void rohc_timings_histo_add(rohc_timings_histo_t *const histo,
+                                          const rohc_ticks_t ticks)
+{
+	size_t bucket;
+
+	if(ticks == 0)
+	{
+		bucket = 0;
+	}
+	else
+	{
+		bucket = 64 - __builtin_clzll(ticks);
+		if(bucket >= ROHC_TIMINGS_BUCKETS_NR)
+		{
+			bucket = ROHC_TIMINGS_BUCKETS_NR - 1;
+		}
+	}
+	histo->count++;
+	histo->total += ticks;
+	histo->buckets[bucket]++;
+}
+
+#endif
+
@@ -44,6 +44,17 @@ extern "C"
 #define ROHC_PROFILE_GENERAL       0xffff
 
 
+/**
+ * @brief The maximal number of CIDs that the traces may be restricted to
+ *
+ * @ingroup rohc
+ *
+ * @see rohc_comp_set_trace_cids
+ * @see rohc_decomp_set_trace_cids
+ */
+#define ROHC_TRACE_CIDS_MAX        16U
+
+
 /**
  * @brief The different levels of the traces
  *
@@ -50,8 +50,9 @@ void rohc_dump_packet(const rohc_trace_callback2_t trace_cb,
                       const char *const descr,
                       const struct rohc_buf packet)
 {
-	/* leave early if no trace callback was defined */
-	if(trace_cb == NULL)
+	/* leave early if no trace callback was defined or if the traces of the
+	 * given level are not built */
+	if(trace_cb == NULL || !rohc_trace_level_enabled(trace_level))
 	{
 		return;
 	}
@@ -82,8 +83,9 @@ void rohc_dump_buf(const rohc_trace_callback2_t trace_cb,
                    const uint8_t *const packet,
                    const size_t length)
 {
-	/* leave early if no trace callback was defined */
-	if(trace_cb == NULL)
+	/* leave early if no trace callback was defined or if the traces of the
+	 * given level are not built */
+	if(trace_cb == NULL || !rohc_trace_level_enabled(trace_level))
 	{
 		return;
 	}
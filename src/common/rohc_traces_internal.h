@@ -31,30 +31,65 @@
 #define ROHC_TRACES_INTERNAL_H
 
 #include "rohc_traces.h"
+#include "rohc.h"
 #include <rohc/rohc_buf.h>
 
 #include <stdlib.h>
 #include <assert.h>
 
 
+/**
+ * @brief Whether the traces of the given level are built in the library
+ *
+ * The traces below the level ROHC_TRACE_LEVEL_MIN set at build time (see the
+ * --enable-rohc-trace-level configure option) are removed by the compiler
+ * along with their format strings and arguments. All traces are built if
+ * ROHC_TRACE_LEVEL_MIN is not set.
+ */
+#ifdef ROHC_TRACE_LEVEL_MIN
+#  define rohc_trace_level_enabled(level) \
+	((level) >= ROHC_TRACE_LEVEL_MIN)
+#else
+#  define rohc_trace_level_enabled(level) \
+	(1)
+#endif
+
 /** Print information depending on the debug level (internal usage) */
 #define __rohc_print(trace_cb, trace_cb_priv, \
                      level, entity, profile, format, ...) \
 	do { \
-		if(trace_cb != NULL) { \
+		if(rohc_trace_level_enabled(level) && trace_cb != NULL) { \
 			trace_cb(trace_cb_priv, level, entity, profile, \
 			         "[%s:%d %s()] " format "\n", \
 			         __FILE__, __LINE__, __FUNCTION__, ##__VA_ARGS__); \
 		} \
 	} while(0)
 
+/**
+ * @brief Whether the traces of the given level are given to the callback
+ *
+ * The traces below the level set at build time or below the level set with
+ * rohc_comp_set_trace_level() or rohc_decomp_set_trace_level() are skipped,
+ * so are all the traces if no callback was set. The traces below the level
+ * that the trace sampling chose for the current packet (if the entity
+ * follows one) are skipped too.
+ */
+#define rohc_trace_is_enabled(entity_struct, level) \
+	(rohc_trace_level_enabled(level) && \
+	 (entity_struct)->trace_callback != NULL && \
+	 (level) >= (entity_struct)->trace_level && \
+	 ((entity_struct)->trace_pkt_level == NULL || \
+	  (level) >= *((entity_struct)->trace_pkt_level)))
+
 /** Print information depending on the debug level */
 #define rohc_print(entity_struct, level, entity, profile, format, ...) \
 	do { \
-		__rohc_print((entity_struct)->trace_callback, \
-		             (entity_struct)->trace_callback_priv, \
-		             level, entity, profile, \
-		             format, ##__VA_ARGS__); \
+		if(rohc_trace_is_enabled(entity_struct, level)) { \
+			__rohc_print((entity_struct)->trace_callback, \
+			             (entity_struct)->trace_callback_priv, \
+			             level, entity, profile, \
+			             format, ##__VA_ARGS__); \
+		} \
 	} while(0)
 
 /** Print debug messages prefixed with the function name */
@@ -98,6 +133,75 @@
 	} while(0)
 
 
+/**
+ * @brief The sampling of the traces of one compressor or decompressor
+ *
+ * @see rohc_comp_set_trace_sampling
+ * @see rohc_comp_set_trace_cids
+ */
+struct rohc_trace_sampling
+{
+	/** Trace 1 packet every N packets, 0 or 1 to trace every packet */
+	size_t one_in_n;
+	/** Trace the warnings and errors only */
+	bool errors_only;
+	/** The number of CIDs the traces are restricted to, 0 for all CIDs */
+	size_t cids_nr;
+	/** The CIDs the traces are restricted to */
+	rohc_cid_t cids[ROHC_TRACE_CIDS_MAX];
+};
+
+
+/**
+ * @brief Compute the minimum level of the traces for one packet
+ *
+ * The packet is traced or not depending on its number and on its CID, so
+ * that the traces of the packets that are not sampled are skipped before
+ * any of their arguments is formatted.
+ *
+ * @param sampling     The sampling of the traces
+ * @param trace_level  The minimum level of the traces set by the user
+ * @param pkt_nr       The number of the packet, starting at 0
+ * @param cid_known    Whether the CID of the packet is already known or not
+ * @param cid          The CID of the packet if known
+ * @return             The minimum level of the traces for the packet,
+ *                     ROHC_TRACE_LEVEL_MAX if the packet is not traced
+ */
+static inline rohc_trace_level_t
+	rohc_trace_sample(const struct rohc_trace_sampling *const sampling,
+	                  const rohc_trace_level_t trace_level,
+	                  const uint64_t pkt_nr,
+	                  const bool cid_known,
+	                  const rohc_cid_t cid)
+{
+	if(sampling->one_in_n > 1 && (pkt_nr % sampling->one_in_n) != 0)
+	{
+		return ROHC_TRACE_LEVEL_MAX;
+	}
+	if(sampling->cids_nr > 0)
+	{
+		size_t i;
+
+		if(!cid_known)
+		{
+			return ROHC_TRACE_LEVEL_MAX;
+		}
+		for(i = 0; i < sampling->cids_nr && sampling->cids[i] != cid; i++)
+		{
+		}
+		if(i == sampling->cids_nr)
+		{
+			return ROHC_TRACE_LEVEL_MAX;
+		}
+	}
+	if(sampling->errors_only && trace_level < ROHC_TRACE_WARNING)
+	{
+		return ROHC_TRACE_WARNING;
+	}
+	return trace_level;
+}
+
+
 void rohc_dump_packet(const rohc_trace_callback2_t trace_cb,
                       void *const trace_cb_priv,
                       const rohc_trace_entity_t trace_entity,
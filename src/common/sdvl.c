@@ -25,7 +25,6 @@
  */
 
 #include "sdvl.h"
-#include "rohc_bit_ops.h"
 
 #include <assert.h>
 
@@ -44,6 +43,43 @@ typedef enum
 } rohc_sdvl_max_value_t;
 
 
+/** One form of SDVL field */
+struct rohc_sdvl_form
+{
+	uint32_t prefix;  /**< The discriminator bits, aligned on the field */
+	uint32_t mask;    /**< The mask of the value bits in the field */
+	size_t bits_nr;   /**< The number of value bits in the field */
+};
+
+
+/** The 1, 2, 3 and 4-byte SDVL forms, indexed by their length minus one */
+static const struct rohc_sdvl_form rohc_sdvl_forms[4] =
+{
+	{ 0x00000000U, ROHC_SDVL_MAX_VALUE_IN_1_BYTE, ROHC_SDVL_MAX_BITS_IN_1_BYTE },
+	{ 0x00008000U, ROHC_SDVL_MAX_VALUE_IN_2_BYTES, ROHC_SDVL_MAX_BITS_IN_2_BYTES },
+	{ 0x00c00000U, ROHC_SDVL_MAX_VALUE_IN_3_BYTES, ROHC_SDVL_MAX_BITS_IN_3_BYTES },
+	{ 0xe0000000U, ROHC_SDVL_MAX_VALUE_IN_4_BYTES, ROHC_SDVL_MAX_BITS_IN_4_BYTES },
+};
+
+
+/** The length minus one of one SDVL field, indexed by its 3 first bits */
+static const uint8_t rohc_sdvl_form_by_prefix[8] = { 0, 0, 0, 0, 1, 1, 2, 3 };
+
+
+/*
+ * Private function prototypes:
+ */
+
+static inline void rohc_sdvl_write(uint8_t *const sdvl_bytes,
+                                   const uint32_t value,
+                                   const size_t form_idx)
+	__attribute__((nonnull(1)));
+
+static inline size_t rohc_sdvl_byte_pos(const size_t byte_idx,
+                                        const size_t form_idx)
+	__attribute__((warn_unused_result, const));
+
+
 /**
  * @brief Can the given value be encoded with SDVL?
  *
@@ -129,36 +165,17 @@ size_t sdvl_get_min_len(const size_t nr_min_required,
  * See 4.5.6 in the RFC 3095 for details about SDVL encoding.
  *
  * @param value  The value to encode
- * @return       The size needed to represent the SDVL-encoded value
+ * @return       The size needed to represent the SDVL-encoded value, 5 if
+ *               the value is too large for SDVL-encoding
  */
 size_t sdvl_get_encoded_len(const uint32_t value)
 {
-	size_t size;
-
-	/* find the length for SDVL-encoding */
-	if(value <= ROHC_SDVL_MAX_VALUE_IN_1_BYTE)
-	{
-		size = 1;
-	}
-	else if(value <= ROHC_SDVL_MAX_VALUE_IN_2_BYTES)
-	{
-		size = 2;
-	}
-	else if(value <= ROHC_SDVL_MAX_VALUE_IN_3_BYTES)
-	{
-		size = 3;
-	}
-	else if(value <= ROHC_SDVL_MAX_VALUE_IN_4_BYTES)
-	{
-		size = 4;
-	}
-	else
-	{
-		/* value is too large for SDVL-encoding */
-		size = 5;
-	}
-
-	return size;
+	/* one more byte for every limit exceeded, without any branch */
+	return (1 +
+	        (value > ROHC_SDVL_MAX_VALUE_IN_1_BYTE) +
+	        (value > ROHC_SDVL_MAX_VALUE_IN_2_BYTES) +
+	        (value > ROHC_SDVL_MAX_VALUE_IN_3_BYTES) +
+	        (value > ROHC_SDVL_MAX_VALUE_IN_4_BYTES));
 }
 
 
@@ -183,70 +200,30 @@ bool sdvl_encode(uint8_t *const sdvl_bytes,
                  const uint32_t value,
                  const size_t bits_nr)
 {
+	size_t form_idx;
+
 	/* encoding 0 bit is an error */
 	assert(bits_nr > 0);
 
-	/* encode the value according to the number of available bits */
-	if(bits_nr <= ROHC_SDVL_MAX_BITS_IN_1_BYTE)
-	{
-		*sdvl_bytes_nr = 1;
-		if(sdvl_bytes_max_nr < (*sdvl_bytes_nr))
-		{
-			/* number of bytes needed is too large for buffer */
-			goto error;
-		}
-
-		/* bit pattern 0 */
-		sdvl_bytes[0] = value & 0x7f;
-	}
-	else if(bits_nr <= ROHC_SDVL_MAX_BITS_IN_2_BYTES)
+	if(bits_nr > ROHC_SDVL_MAX_BITS_IN_4_BYTES)
 	{
-		*sdvl_bytes_nr = 2;
-		if(sdvl_bytes_max_nr < (*sdvl_bytes_nr))
-		{
-			/* number of bytes needed is too large for buffer */
-			goto error;
-		}
-
-		/* 2 = bit pattern 10 */
-		sdvl_bytes[0] = ((2 << 6) | ((value >> 8) & 0x3f)) & 0xff;
-		sdvl_bytes[1] = value & 0xff;
+		/* number of bytes needed is too large (value must be < 2^29) */
+		goto error;
 	}
-	else if(bits_nr <= ROHC_SDVL_MAX_BITS_IN_3_BYTES)
-	{
-		*sdvl_bytes_nr = 3;
-		if(sdvl_bytes_max_nr < (*sdvl_bytes_nr))
-		{
-			/* number of bytes needed is too large for buffer */
-			goto error;
-		}
 
-		/* 6 = bit pattern 110 */
-		sdvl_bytes[0] = ((6 << 5) | ((value >> 16) & 0x1f)) & 0xff;
-		sdvl_bytes[1] = (value >> 8) & 0xff;
-		sdvl_bytes[2] = value & 0xff;
-	}
-	else if(bits_nr <= ROHC_SDVL_MAX_BITS_IN_4_BYTES)
+	/* the form is given by the number of limits exceeded */
+	form_idx = (bits_nr > ROHC_SDVL_MAX_BITS_IN_1_BYTE) +
+	           (bits_nr > ROHC_SDVL_MAX_BITS_IN_2_BYTES) +
+	           (bits_nr > ROHC_SDVL_MAX_BITS_IN_3_BYTES);
+	*sdvl_bytes_nr = form_idx + 1;
+	if(sdvl_bytes_max_nr < (*sdvl_bytes_nr))
 	{
-		*sdvl_bytes_nr = 4;
-		if(sdvl_bytes_max_nr < (*sdvl_bytes_nr))
-		{
-			/* number of bytes needed is too large for buffer */
-			goto error;
-		}
-
-		/* 7 = bit pattern 111 */
-		sdvl_bytes[0] = ((7 << 5) | ((value >> 24) & 0x1f)) & 0xff;
-		sdvl_bytes[1] = (value >> 16) & 0xff;
-		sdvl_bytes[2] = (value >> 8) & 0xff;
-		sdvl_bytes[3] = value & 0xff;
-	}
-	else
-	{
-		/* number of bytes needed is too large (value must be < 2^29) */
+		/* number of bytes needed is too large for buffer */
 		goto error;
 	}
 
+	rohc_sdvl_write(sdvl_bytes, value, form_idx);
+
 	return true;
 
 error:
@@ -273,33 +250,23 @@ bool sdvl_encode_full(uint8_t *const sdvl_bytes,
                       size_t *const sdvl_bytes_nr,
                       const uint32_t value)
 {
-	size_t bits_nr;
+	const size_t form_idx = sdvl_get_encoded_len(value) - 1;
 
-	/* find the number of bits for SDVL-encoding */
-	if(value <= ROHC_SDVL_MAX_VALUE_IN_1_BYTE)
-	{
-		bits_nr = ROHC_SDVL_MAX_BITS_IN_1_BYTE;
-	}
-	else if(value <= ROHC_SDVL_MAX_VALUE_IN_2_BYTES)
-	{
-		bits_nr = ROHC_SDVL_MAX_BITS_IN_2_BYTES;
-	}
-	else if(value <= ROHC_SDVL_MAX_VALUE_IN_3_BYTES)
-	{
-		bits_nr = ROHC_SDVL_MAX_BITS_IN_3_BYTES;
-	}
-	else if(value <= ROHC_SDVL_MAX_VALUE_IN_4_BYTES)
+	if(form_idx > 3)
 	{
-		bits_nr = ROHC_SDVL_MAX_BITS_IN_4_BYTES;
+		/* value is too large for SDVL-encoding */
+		goto error;
 	}
-	else
+	*sdvl_bytes_nr = form_idx + 1;
+	if(sdvl_bytes_max_nr < (*sdvl_bytes_nr))
 	{
-		/* value is too large for SDVL-encoding */
+		/* number of bytes needed is too large for buffer */
 		goto error;
 	}
 
-	return sdvl_encode(sdvl_bytes, sdvl_bytes_max_nr, sdvl_bytes_nr,
-	                   value, bits_nr);
+	rohc_sdvl_write(sdvl_bytes, value, form_idx);
+
+	return true;
 
 error:
 	return false;
@@ -323,7 +290,9 @@ size_t sdvl_decode(const uint8_t *const data,
                    uint32_t *const value,
                    size_t *const bits_nr)
 {
-	size_t sdvl_len;
+	const struct rohc_sdvl_form *form;
+	size_t form_idx;
+	uint32_t field;
 
 	if(length < 1)
 	{
@@ -331,54 +300,77 @@ size_t sdvl_decode(const uint8_t *const data,
 		goto error;
 	}
 
-	if(!GET_BIT_7(data)) /* bit == 0 */
-	{
-		*value = GET_BIT_0_6(data);
-		*bits_nr = ROHC_SDVL_MAX_BITS_IN_1_BYTE;
-		sdvl_len = 1;
-	}
-	else if(GET_BIT_6_7(data) == (0x8 >> 2)) /* bits == 0b10 */
-	{
-		if(length < 2)
-		{
-			/* packet too small to decode SDVL field */
-			goto error;
-		}
-		*value = (GET_BIT_0_5(data) << 8 | GET_BIT_0_7(data + 1));
-		*bits_nr = ROHC_SDVL_MAX_BITS_IN_2_BYTES;
-		sdvl_len = 2;
-	}
-	else if(GET_BIT_5_7(data) == (0xc >> 1)) /* bits == 0b110 */
+	/* the 3 first bits give the form of the field */
+	form_idx = rohc_sdvl_form_by_prefix[data[0] >> 5];
+	form = &(rohc_sdvl_forms[form_idx]);
+	if(length <= form_idx)
 	{
-		if(length < 3)
-		{
-			/* packet too small to decode SDVL field */
-			goto error;
-		}
-		*value = (GET_BIT_0_4(data) << 16 |
-		          GET_BIT_0_7(data + 1) << 8 |
-		          GET_BIT_0_7(data + 2));
-		*bits_nr = ROHC_SDVL_MAX_BITS_IN_3_BYTES;
-		sdvl_len = 3;
-	}
-	else /* bits == 0b111 */
-	{
-		if(length < 4)
-		{
-			/* packet too small to decode SDVL field */
-			goto error;
-		}
-		*value = (GET_BIT_0_4(data) << 24 |
-		          GET_BIT_0_7(data + 1) << 16 |
-		          GET_BIT_0_7(data + 2) << 8 |
-		          GET_BIT_0_7(data + 3));
-		*bits_nr = ROHC_SDVL_MAX_BITS_IN_4_BYTES;
-		sdvl_len = 4;
+		/* packet too small to decode SDVL field */
+		goto error;
 	}
 
-	return sdvl_len;
+	/* read the whole field at once without any branch: the bytes after the
+	 * field are read from its last byte (the packet may end with the field),
+	 * then they are shifted out */
+	field = (((uint32_t) data[0]) << 24) |
+	        (((uint32_t) data[rohc_sdvl_byte_pos(1, form_idx)]) << 16) |
+	        (((uint32_t) data[rohc_sdvl_byte_pos(2, form_idx)]) << 8) |
+	        ((uint32_t) data[rohc_sdvl_byte_pos(3, form_idx)]);
+	field >>= (3 - form_idx) * 8;
+
+	*value = field & form->mask;
+	*bits_nr = form->bits_nr;
+
+	return (form_idx + 1);
 
 error:
 	return 0;
 }
 
+
+/**
+ * @brief Write one SDVL field in the given form
+ *
+ * The whole field is built at once, aligned on the first byte, then written
+ * in network byte order without any branch: the callers do not always reserve
+ * 4 bytes, so the bytes are written from the last one to the first one and the
+ * ones after the field are redirected to its last byte that is written last
+ * with the right value.
+ *
+ * @param sdvl_bytes  OUT: The SDVL-encoded bytes, large enough for the form
+ * @param value       The value to encode
+ * @param form_idx    The length minus one of the SDVL field
+ */
+static inline void rohc_sdvl_write(uint8_t *const sdvl_bytes,
+                                   const uint32_t value,
+                                   const size_t form_idx)
+{
+	const struct rohc_sdvl_form *const form = &(rohc_sdvl_forms[form_idx]);
+	const uint32_t field =
+		(form->prefix | (value & form->mask)) << ((3 - form_idx) * 8);
+
+	sdvl_bytes[rohc_sdvl_byte_pos(3, form_idx)] = field & 0xff;
+	sdvl_bytes[rohc_sdvl_byte_pos(2, form_idx)] = (field >> 8) & 0xff;
+	sdvl_bytes[rohc_sdvl_byte_pos(1, form_idx)] = (field >> 16) & 0xff;
+	sdvl_bytes[0] = (field >> 24) & 0xff;
+}
+
+
+/**
+ * @brief Get the position of one byte of a 4-byte SDVL field in a shorter one
+ *
+ * The bytes of the 4-byte field that are out of the shorter field are mapped
+ * onto the last byte of the shorter field, so that all the bytes of the
+ * field may be read or written without any branch and without overflowing
+ * the field.
+ *
+ * @param byte_idx  The index of the byte in the 4-byte field
+ * @param form_idx  The length minus one of the SDVL field
+ * @return          The position of the byte in the SDVL field
+ */
+static inline size_t rohc_sdvl_byte_pos(const size_t byte_idx,
+                                        const size_t form_idx)
+{
+	return (byte_idx <= form_idx ? byte_idx : form_idx);
+}
+
@@ -89,5 +89,36 @@ size_t sdvl_decode(const uint8_t *const data,
                    size_t *const bits_nr)
 	__attribute__((warn_unused_result, nonnull(1, 3, 4)));
 
+
+/**
+ * @brief Decode a SDVL-encoded large CID
+ *
+ * Large CIDs are SDVL-encoded on 1 or 2 bytes only (RFC 3095 §5.1.3), so the
+ * two forms are decoded directly, the longer forms are rejected.
+ *
+ * @param data        The SDVL data to decode
+ * @param length      The maximum data length available (in bytes)
+ * @param[out] value  The decoded large CID
+ * @return            The number of bytes used by the large CID (1 or 2),
+ *                    0 if the large CID is malformed
+ */
+static inline size_t sdvl_decode_large_cid(const uint8_t *const data,
+                                           const size_t length,
+                                           uint32_t *const value)
+{
+	if(length >= 1 && (data[0] & 0x80) == 0)
+	{
+		*value = data[0];
+		return 1;
+	}
+	else if(length >= 2 && (data[0] & 0xc0) == 0x80)
+	{
+		*value = ((data[0] & 0x3f) << 8) | data[1];
+		return 2;
+	}
+
+	return 0;
+}
+
 #endif
 
@@ -0,0 +1,174 @@
+/*
+ * Copyright 2016 Didier Barvaux
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/**
+ * @file    bench_crc.c
+ * @brief   Measure the speed of the CRC computations
+ * @author  Didier Barvaux <didier@barvaux.org>
+ *
+ * The CRC-3, CRC-7 and CRC-8 computed by the library with the slicing-by-4
+ * tables are compared with a byte-serial computation that uses one single
+ * 256-byte table. The program is built by 'make check' but is not run by it,
+ * run it by hand with an optional number of iterations.
+ */
+
+#include "crc.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+
+
+/** The default number of times every computation is repeated */
+#define BENCH_CRC_ITERATIONS  2000000UL
+
+
+/**
+ * @brief Compute the CRC-3, CRC-7 or CRC-8 one byte at a time
+ *
+ * @param mask       The mask of the bits of the CRC
+ * @param data       The data to compute the CRC for
+ * @param length     The size of the data
+ * @param init_val   The initial value of the CRC
+ * @param crc_table  The 256-byte table for the CRC type
+ * @return           The CRC
+ */
+static uint8_t bench_crc_bytewise(const uint8_t mask,
+                                  const uint8_t *const data,
+                                  const size_t length,
+                                  const uint8_t init_val,
+                                  const uint8_t *const crc_table)
+{
+	uint8_t crc = init_val & mask;
+	size_t i;
+
+	for(i = 0; i < length; i++)
+	{
+		crc = crc_table[data[i] ^ crc];
+	}
+
+	return crc;
+}
+
+
+/**
+ * @brief Measure the speed of the CRC computations
+ *
+ * @param argc  The number of command line arguments
+ * @param argv  The command line arguments
+ * @return      0 if the measures succeed, non-zero otherwise
+ */
+int main(int argc, char *argv[])
+{
+	const struct
+	{
+		const char *name;
+		rohc_crc_type_t type;
+		uint8_t init_val;
+		uint8_t polynom;
+		uint8_t mask;
+	} crcs[] = {
+		{ "CRC-3", ROHC_CRC_TYPE_3, CRC_INIT_3, 0x06, 0x07 },
+		{ "CRC-7", ROHC_CRC_TYPE_7, CRC_INIT_7, 0x79, 0x7f },
+		{ "CRC-8", ROHC_CRC_TYPE_8, CRC_INIT_8, 0xe0, 0xff },
+	};
+	const size_t lengths[] = { 4, 8, 20, 40, 60 };
+	unsigned long iterations_nr = BENCH_CRC_ITERATIONS;
+	volatile uint8_t sink = 0;
+	uint8_t data[64];
+	size_t crc_idx;
+	size_t i;
+	int is_failure = 1;
+
+	if(argc == 2)
+	{
+		iterations_nr = strtoul(argv[1], NULL, 10);
+	}
+	if(argc > 2 || iterations_nr == 0)
+	{
+		printf("measure the speed of the CRC computations\n");
+		printf("usage: %s [iterations]\n", argv[0]);
+		goto error;
+	}
+
+	for(i = 0; i < sizeof(data); i++)
+	{
+		data[i] = (uint8_t) (i * 0x3b);
+	}
+
+	printf("%-6s %6s %14s %14s %8s\n", "CRC", "bytes", "bytewise (ns)",
+	       "sliced (ns)", "speedup");
+
+	for(crc_idx = 0; crc_idx < (sizeof(crcs) / sizeof(crcs[0])); crc_idx++)
+	{
+		uint8_t crc_table[256];
+		size_t len_idx;
+
+		/* build the 256-byte table for the byte-serial computation */
+		for(i = 0; i < 256; i++)
+		{
+			uint8_t crc = i;
+			size_t j;
+
+			for(j = 0; j < 8; j++)
+			{
+				crc = (crc >> 1) ^ ((crc & 1) ? crcs[crc_idx].polynom : 0U);
+			}
+			crc_table[i] = crc;
+		}
+
+		for(len_idx = 0; len_idx < (sizeof(lengths) / sizeof(lengths[0]));
+		    len_idx++)
+		{
+			const size_t len = lengths[len_idx];
+			double bytewise_ns;
+			double sliced_ns;
+			clock_t start;
+			unsigned long n;
+
+			start = clock();
+			for(n = 0; n < iterations_nr; n++)
+			{
+				sink ^= bench_crc_bytewise(crcs[crc_idx].mask, data, len,
+				                           crcs[crc_idx].init_val ^ sink, crc_table);
+			}
+			bytewise_ns = ((double) (clock() - start)) * 1e9 /
+			              ((double) CLOCKS_PER_SEC) / ((double) iterations_nr);
+
+			start = clock();
+			for(n = 0; n < iterations_nr; n++)
+			{
+				sink ^= crc_calculate(crcs[crc_idx].type, data, len,
+				                      crcs[crc_idx].init_val ^ sink);
+			}
+			sliced_ns = ((double) (clock() - start)) * 1e9 /
+			            ((double) CLOCKS_PER_SEC) / ((double) iterations_nr);
+
+			printf("%-6s %6zu %14.2f %14.2f %7.2fx\n", crcs[crc_idx].name, len,
+			       bytewise_ns, sliced_ns,
+			       (sliced_ns > 0 ? bytewise_ns / sliced_ns : 0));
+		}
+	}
+
+	is_failure = 0;
+
+error:
+	return is_failure;
+}
@@ -147,6 +147,37 @@ int main(int argc, char *argv[])
 		CHECK(strcmp(rohc_get_profile_descr(ROHC_PROFILE_UDPLITE), "") != 0);
 		CHECK(strcmp(rohc_get_profile_descr(ROHC_PROFILE_UDPLITE), unknown) != 0);
 		CHECK(strcmp(rohc_get_profile_descr(ROHC_PROFILE_UDPLITE + 1), unknown) == 0);
+		CHECK(strcmp(rohc_get_profile_descr(ROHCv2_PROFILE_IP_UDP_RTP), "") != 0);
+		CHECK(strcmp(rohc_get_profile_descr(ROHCv2_PROFILE_IP_UDP_RTP), unknown) != 0);
+		CHECK(strcmp(rohc_get_profile_descr(ROHCv2_PROFILE_IP_UDP), "") != 0);
+		CHECK(strcmp(rohc_get_profile_descr(ROHCv2_PROFILE_IP_UDP), unknown) != 0);
+		CHECK(strcmp(rohc_get_profile_descr(ROHCv2_PROFILE_IP_ESP), "") != 0);
+		CHECK(strcmp(rohc_get_profile_descr(ROHCv2_PROFILE_IP_ESP), unknown) != 0);
+		CHECK(strcmp(rohc_get_profile_descr(ROHCv2_PROFILE_IP), "") != 0);
+		CHECK(strcmp(rohc_get_profile_descr(ROHCv2_PROFILE_IP), unknown) != 0);
+		CHECK(strcmp(rohc_get_profile_descr(ROHCv2_PROFILE_IP + 1), unknown) == 0);
+	}
+
+	/* rohc_cpu_set_features(), rohc_cpu_get_features() and
+	 * rohc_cpu_get_variant() */
+	{
+		const char unknown[] = "no description";
+		const rohc_cpu_features_t detected = rohc_cpu_get_features();
+
+		CHECK((detected & ~ROHC_CPU_FEATURE_ALL) == 0);
+		CHECK(strcmp(rohc_cpu_get_variant(ROHC_CPU_KERNEL_FCS32), "") != 0);
+		CHECK(strcmp(rohc_cpu_get_variant(ROHC_CPU_KERNEL_FCS32), unknown) != 0);
+		CHECK(strcmp(rohc_cpu_get_variant(ROHC_CPU_KERNEL_FCS32 + 1), unknown) == 0);
+
+		CHECK(rohc_cpu_set_features(ROHC_CPU_FEATURE_ALL + 1) == false);
+		CHECK(rohc_cpu_get_features() == detected);
+
+		CHECK(rohc_cpu_set_features(ROHC_CPU_FEATURE_NONE) == true);
+		CHECK(rohc_cpu_get_features() == ROHC_CPU_FEATURE_NONE);
+		CHECK(strcmp(rohc_cpu_get_variant(ROHC_CPU_KERNEL_FCS32), "generic") == 0);
+
+		CHECK(rohc_cpu_set_features(ROHC_CPU_FEATURE_ALL) == true);
+		CHECK(rohc_cpu_get_features() == detected);
 	}
 
 	/* rohc_get_packet_descr() */
@@ -219,7 +250,22 @@ int main(int argc, char *argv[])
 		CHECK(strcmp(rohc_get_packet_descr(ROHC_PACKET_TCP_SEQ_8), "") != 0);
 		CHECK(strcmp(rohc_get_packet_descr(ROHC_PACKET_TCP_SEQ_8), unknown) != 0);
 
-		CHECK(strcmp(rohc_get_packet_descr(ROHC_PACKET_TCP_SEQ_8 + 1), unknown) == 0);
+		CHECK(strcmp(rohc_get_packet_descr(ROHC_PACKET_PT_0_CRC3), "") != 0);
+		CHECK(strcmp(rohc_get_packet_descr(ROHC_PACKET_PT_0_CRC3), unknown) != 0);
+		CHECK(strcmp(rohc_get_packet_descr(ROHC_PACKET_PT_0_CRC7), "") != 0);
+		CHECK(strcmp(rohc_get_packet_descr(ROHC_PACKET_PT_0_CRC7), unknown) != 0);
+		CHECK(strcmp(rohc_get_packet_descr(ROHC_PACKET_PT_1_SEQ_ID), "") != 0);
+		CHECK(strcmp(rohc_get_packet_descr(ROHC_PACKET_PT_1_SEQ_ID), unknown) != 0);
+		CHECK(strcmp(rohc_get_packet_descr(ROHC_PACKET_PT_2_SEQ_ID), "") != 0);
+		CHECK(strcmp(rohc_get_packet_descr(ROHC_PACKET_PT_2_SEQ_ID), unknown) != 0);
+		CHECK(strcmp(rohc_get_packet_descr(ROHC_PACKET_CO_COMMON), "") != 0);
+		CHECK(strcmp(rohc_get_packet_descr(ROHC_PACKET_CO_COMMON), unknown) != 0);
+		CHECK(strcmp(rohc_get_packet_descr(ROHC_PACKET_PT_1_RND), "") != 0);
+		CHECK(strcmp(rohc_get_packet_descr(ROHC_PACKET_PT_1_RND), unknown) != 0);
+		CHECK(strcmp(rohc_get_packet_descr(ROHC_PACKET_PT_2_RND), "") != 0);
+		CHECK(strcmp(rohc_get_packet_descr(ROHC_PACKET_PT_2_RND), unknown) != 0);
+
+		CHECK(strcmp(rohc_get_packet_descr(ROHC_PACKET_PT_2_RND + 1), unknown) == 0);
 		CHECK(strcmp(rohc_get_packet_descr(ROHC_PACKET_UNKNOWN), unknown) == 0);
 	}
 
@@ -256,6 +302,10 @@ int main(int argc, char *argv[])
 			"tcp-rnd-5", "tcp-rnd-6", "tcp-rnd-7", "tcp-rnd-8",
 			"tcp-seq-1", "tcp-seq-2", "tcp-seq-3", "tcp-seq-4",
 			"tcp-seq-5", "tcp-seq-6", "tcp-seq-7", "tcp-seq-8",
+			"rohcv2-pt-0-crc3", "rohcv2-pt-0-crc7",
+			"rohcv2-pt-1-seq-id", "rohcv2-pt-2-seq-id",
+			"rohcv2-co-common",
+			"rohcv2-pt-1-rnd", "rohcv2-pt-2-rnd",
 		};
 		rohc_packet_t packet_type;
 
@@ -0,0 +1,251 @@
+/*
+ * Copyright 2016 Didier Barvaux
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/**
+ * @file    test_crc.c
+ * @brief   Test the CRC computations
+ * @author  Didier Barvaux <didier@barvaux.org>
+ */
+
+#include "crc.h"
+#include "rohc.h"
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <assert.h>
+
+
+/** Print trace on stdout only in verbose mode */
+#define trace(is_verbose, format, ...) \
+	do { \
+		if(is_verbose) { \
+			printf(format, ##__VA_ARGS__); \
+		} \
+	} while(0)
+
+/** Improved assert() */
+#define CHECK(condition) \
+	do { \
+		trace(verbose, "test '%s'\n", #condition); \
+		fflush(stdout); \
+		assert(condition); \
+	} while(0)
+
+
+/**
+ * @brief Compute the CRC FCS-32 bit per bit
+ *
+ * @param data      The data to compute the CRC for
+ * @param length    The size of the data
+ * @param init_val  The initial value of the CRC
+ * @return          The 32-bit CRC
+ */
+static uint32_t test_crc_fcs32_bitwise(const uint8_t *const data,
+                                       const size_t length,
+                                       const uint32_t init_val)
+{
+	uint32_t crc = init_val;
+	size_t i;
+
+	for(i = 0; i < length; i++)
+	{
+		size_t j;
+
+		crc ^= data[i];
+		for(j = 0; j < 8; j++)
+		{
+			crc = (crc >> 1) ^ ((crc & 1) ? 0xedb88320U : 0U);
+		}
+	}
+
+	return crc;
+}
+
+
+/**
+ * @brief Compute the CRC-3, CRC-7 or CRC-8 bit per bit
+ *
+ * @param polynom   The reversed polynom of the CRC
+ * @param mask      The mask of the bits of the CRC
+ * @param data      The data to compute the CRC for
+ * @param length    The size of the data
+ * @param init_val  The initial value of the CRC
+ * @return          The CRC
+ */
+static uint8_t test_crc_bitwise(const uint8_t polynom,
+                                const uint8_t mask,
+                                const uint8_t *const data,
+                                const size_t length,
+                                const uint8_t init_val)
+{
+	uint8_t crc = init_val & mask;
+	size_t i;
+
+	for(i = 0; i < length; i++)
+	{
+		size_t j;
+
+		crc ^= data[i];
+		for(j = 0; j < 8; j++)
+		{
+			crc = (crc >> 1) ^ ((crc & 1) ? polynom : 0U);
+		}
+	}
+
+	return crc;
+}
+
+
+/**
+ * @brief Test the CRC computations
+ *
+ * @param argc  The number of command line arguments
+ * @param argv  The command line arguments
+ * @return      0 if test succeeds, non-zero if test fails
+ */
+int main(int argc, char *argv[])
+{
+	bool verbose; /* whether to run in verbose mode or not */
+	int is_failure = 1; /* test fails by default */
+
+	/* do we run in verbose mode ? */
+	if(argc == 1)
+	{
+		/* no argument, run in silent mode */
+		verbose = false;
+	}
+	else if(argc == 2 && strcmp(argv[1], "verbose") == 0)
+	{
+		/* run in verbose mode */
+		verbose = true;
+	}
+	else
+	{
+		/* invalid usage */
+		printf("test the CRC computations\n");
+		printf("usage: %s [verbose]\n", argv[0]);
+		goto error;
+	}
+
+	/* crc_calc_fcs32() with the check value of CRC-32 */
+	{
+		const uint8_t check[] = "123456789";
+		CHECK(crc_calc_fcs32(check, 9, CRC_INIT_FCS32) == ~0xcbf43926U);
+		CHECK(crc_calc_fcs32(check, 0, CRC_INIT_FCS32) == CRC_INIT_FCS32);
+	}
+
+	/* crc_calc_fcs32() against the bitwise computation, for all lengths
+	 * around the 8-byte slices and the 16-byte and 64-byte folds, for all
+	 * alignments, with the best variant for the CPU then with the generic
+	 * variant */
+	{
+		const rohc_cpu_features_t features[] =
+			{ ROHC_CPU_FEATURE_ALL, ROHC_CPU_FEATURE_NONE };
+		uint8_t data[256 + 16];
+		size_t feat_idx;
+		size_t i;
+
+		for(i = 0; i < sizeof(data); i++)
+		{
+			data[i] = (uint8_t) ((i * 0x9d) ^ (i >> 3));
+		}
+
+		for(feat_idx = 0; feat_idx < (sizeof(features) / sizeof(features[0]));
+		    feat_idx++)
+		{
+			size_t offset;
+
+			CHECK(rohc_cpu_set_features(features[feat_idx]));
+			trace(verbose, "CRC FCS-32 variant '%s'\n",
+			      rohc_cpu_get_variant(ROHC_CPU_KERNEL_FCS32));
+
+			for(offset = 0; offset < 16; offset++)
+			{
+				size_t len;
+
+				for(len = 0; len <= 256; len++)
+				{
+					const uint32_t init_vals[] = { CRC_INIT_FCS32, 0U, 0x12345678U };
+					size_t j;
+
+					for(j = 0; j < (sizeof(init_vals) / sizeof(init_vals[0])); j++)
+					{
+						CHECK(crc_calc_fcs32(data + offset, len, init_vals[j]) ==
+						      test_crc_fcs32_bitwise(data + offset, len, init_vals[j]));
+					}
+				}
+			}
+		}
+		CHECK(rohc_cpu_set_features(ROHC_CPU_FEATURE_ALL));
+	}
+
+	/* crc_calculate() against the bitwise computation, for all lengths
+	 * around the 4-byte slices, for all alignments and all initial values */
+	{
+		const struct
+		{
+			rohc_crc_type_t type;
+			uint8_t polynom;
+			uint8_t mask;
+		} crcs[] = {
+			{ ROHC_CRC_TYPE_3, 0x06, 0x07 },
+			{ ROHC_CRC_TYPE_7, 0x79, 0x7f },
+			{ ROHC_CRC_TYPE_8, 0xe0, 0xff },
+		};
+		uint8_t data[64 + 4];
+		size_t crc_idx;
+		size_t i;
+
+		for(i = 0; i < sizeof(data); i++)
+		{
+			data[i] = (uint8_t) ((i * 0x3b) ^ (i >> 2));
+		}
+
+		for(crc_idx = 0; crc_idx < (sizeof(crcs) / sizeof(crcs[0])); crc_idx++)
+		{
+			size_t offset;
+
+			for(offset = 0; offset < 4; offset++)
+			{
+				size_t len;
+
+				for(len = 0; len <= 64; len++)
+				{
+					unsigned int init_val;
+
+					for(init_val = 0; init_val <= 0xff; init_val++)
+					{
+						CHECK(crc_calculate(crcs[crc_idx].type, data + offset, len,
+						                    init_val) ==
+						      test_crc_bitwise(crcs[crc_idx].polynom,
+						                       crcs[crc_idx].mask, data + offset,
+						                       len, init_val));
+					}
+				}
+			}
+		}
+	}
+
+	/* test succeeds */
+	trace(verbose, "all tests are successful\n");
+	is_failure = 0;
+
+error:
+	return is_failure;
+}
@@ -0,0 +1,236 @@
+/*
+ * Copyright 2016 Didier Barvaux
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/**
+ * @file    test_csum.c
+ * @brief   Test the incremental update of the Internet checksum
+ * @author  Didier Barvaux <didier@barvaux.org>
+ */
+
+#include "rohc_csum.h"
+#include "ip.h"
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stddef.h>
+#include <assert.h>
+#include <arpa/inet.h>
+
+
+/** Print trace on stdout only in verbose mode */
+#define trace(is_verbose, format, ...) \
+	do { \
+		if(is_verbose) { \
+			printf(format, ##__VA_ARGS__); \
+		} \
+	} while(0)
+
+/** Improved assert() */
+#define CHECK(condition) \
+	do { \
+		trace(verbose, "test '%s'\n", #condition); \
+		fflush(stdout); \
+		assert(condition); \
+	} while(0)
+
+
+/**
+ * @brief Compute the full checksum of one IPv4 header
+ *
+ * @param ipv4  The IPv4 header
+ * @return      The checksum of the header with a zero checksum field
+ */
+static uint16_t test_csum_full(const struct ipv4_hdr *const ipv4)
+{
+	struct ipv4_hdr hdr;
+
+	memcpy(&hdr, ipv4, sizeof(struct ipv4_hdr));
+	hdr.check = 0;
+
+	return ip_fast_csum((uint8_t *) &hdr, hdr.ihl);
+}
+
+
+/**
+ * @brief Compute the one's complement sum of some bytes, one byte at a time
+ *
+ * @param data  The bytes to sum
+ * @param len   The number of bytes
+ * @return      The sum in network byte order, as \ref rohc_csum_sum
+ */
+static uint16_t test_csum_sum_ref(const uint8_t *const data, const size_t len)
+{
+	uint32_t sum = 0;
+	uint16_t sum_nbo;
+	size_t i;
+
+	for(i = 0; i < len; i++)
+	{
+		sum += ((i % 2) == 0 ? (data[i] << 8) : data[i]);
+	}
+	sum = rohc_csum_fold(sum);
+	sum_nbo = htons(sum);
+
+	return sum_nbo;
+}
+
+
+/**
+ * @brief Test the incremental update of the Internet checksum
+ *
+ * @param argc  The number of command line arguments
+ * @param argv  The command line arguments
+ * @return      0 if test succeeds, non-zero if test fails
+ */
+int main(int argc, char *argv[])
+{
+	const uint8_t ref_hdr[] = {
+		0x45, 0x00, 0x00, 0x54, 0x12, 0x34, 0x40, 0x00, 0x40, 0x01, 0x00, 0x00,
+		0xc0, 0xa8, 0x01, 0x01, 0xc0, 0xa8, 0x01, 0x02
+	};
+	struct ipv4_hdr old_ipv4;
+	struct ipv4_hdr new_ipv4;
+	uint16_t old_csum;
+	bool verbose; /* whether to run in verbose mode or not */
+	int is_failure = 1; /* test fails by default */
+	uint32_t i;
+
+	/* do we run in verbose mode ? */
+	if(argc == 1)
+	{
+		/* no argument, run in silent mode */
+		verbose = false;
+	}
+	else if(argc == 2 && strcmp(argv[1], "verbose") == 0)
+	{
+		/* run in verbose mode */
+		verbose = true;
+	}
+	else
+	{
+		/* invalid usage */
+		printf("test the incremental update of the Internet checksum\n");
+		printf("usage: %s [verbose]\n", argv[0]);
+		goto error;
+	}
+
+	/* rohc_csum_sum() on every length and alignment of small data, so that
+	 * all the code paths are used, then on one large all-ones packet */
+	{
+		uint8_t data[1500 + 3];
+		size_t len;
+		size_t off;
+
+		for(i = 0; i < sizeof(data); i++)
+		{
+			data[i] = (i * 37 + 11) & 0xff;
+		}
+		for(len = 0; len <= 100; len++)
+		{
+			for(off = 0; off < 4; off++)
+			{
+				const uint16_t ref_sum = test_csum_sum_ref(data + off, len);
+				const uint16_t sum = rohc_csum_sum(data + off, len);
+				/* 0x0000 and 0xffff are the same one's complement value */
+				CHECK(sum == ref_sum || (sum == 0xffff && ref_sum == 0x0000) ||
+				      (sum == 0x0000 && ref_sum == 0xffff));
+			}
+		}
+		memset(data, 0xff, sizeof(data));
+		CHECK(rohc_csum_sum(data, 1500) == 0xffff);
+	}
+
+	memcpy(&old_ipv4, ref_hdr, sizeof(struct ipv4_hdr));
+	old_csum = test_csum_full(&old_ipv4);
+
+	/* rohc_csum_fold() */
+	CHECK(rohc_csum_fold(0x00000000) == 0x0000);
+	CHECK(rohc_csum_fold(0x0000ffff) == 0xffff);
+	CHECK(rohc_csum_fold(0x00010000) == 0x0001);
+	CHECK(rohc_csum_fold(0x0001ffff) == 0x0001);
+	CHECK(rohc_csum_fold(0xffffffff) == 0xffff);
+
+	/* rohc_csum_replace16() on every possible value of the IP-ID */
+	for(i = 0; i <= 0xffff; i++)
+	{
+		memcpy(&new_ipv4, &old_ipv4, sizeof(struct ipv4_hdr));
+		new_ipv4.id = (uint16_t) i;
+		if(rohc_csum_replace16(old_csum, old_ipv4.id, new_ipv4.id) !=
+		   test_csum_full(&new_ipv4))
+		{
+			CHECK(rohc_csum_replace16(old_csum, old_ipv4.id, new_ipv4.id) ==
+			      test_csum_full(&new_ipv4));
+		}
+	}
+
+	/* rohc_csum_replace16() that makes the sum wrap to zero */
+	memcpy(&new_ipv4, &old_ipv4, sizeof(struct ipv4_hdr));
+	new_ipv4.id = 0;
+	new_ipv4.id = test_csum_full(&new_ipv4);
+	CHECK(test_csum_full(&new_ipv4) == 0x0000);
+	CHECK(rohc_csum_replace16(old_csum, old_ipv4.id, new_ipv4.id) == 0x0000);
+
+	/* rohc_csum_replace32() on the source address */
+	for(i = 0; i < 0x10000; i++)
+	{
+		const uint32_t saddr = (i << 16) | (i * 7919U);
+
+		memcpy(&new_ipv4, &old_ipv4, sizeof(struct ipv4_hdr));
+		new_ipv4.saddr = saddr;
+		if(rohc_csum_replace32(old_csum, old_ipv4.saddr, new_ipv4.saddr) !=
+		   test_csum_full(&new_ipv4))
+		{
+			CHECK(rohc_csum_replace32(old_csum, old_ipv4.saddr, new_ipv4.saddr) ==
+			      test_csum_full(&new_ipv4));
+		}
+	}
+
+	/* rohc_csum_replace() on the first bytes of the header */
+	for(i = 0; i < 0x10000; i++)
+	{
+		memcpy(&new_ipv4, &old_ipv4, sizeof(struct ipv4_hdr));
+		new_ipv4.tos = (uint8_t) (i & 0xff);
+		new_ipv4.tot_len = rohc_hton16(20 + i);
+		new_ipv4.id = rohc_hton16(i * 3);
+		new_ipv4.df = (i & 1);
+		new_ipv4.ttl = (uint8_t) (i >> 8);
+		if(rohc_csum_replace(old_csum, (uint8_t *) &old_ipv4, (uint8_t *) &new_ipv4,
+		                     offsetof(struct ipv4_hdr, check)) !=
+		   test_csum_full(&new_ipv4))
+		{
+			CHECK(rohc_csum_replace(old_csum, (uint8_t *) &old_ipv4,
+			                        (uint8_t *) &new_ipv4,
+			                        offsetof(struct ipv4_hdr, check)) ==
+			      test_csum_full(&new_ipv4));
+		}
+	}
+
+	/* rohc_csum_replace() without any change */
+	CHECK(rohc_csum_replace(old_csum, (uint8_t *) &old_ipv4, (uint8_t *) &old_ipv4,
+	                        sizeof(struct ipv4_hdr)) == old_csum);
+
+	trace(verbose, "all tests are successful\n");
+
+	/* test succeeds */
+	is_failure = 0;
+
+error:
+	return is_failure;
+}
+
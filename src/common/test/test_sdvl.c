@@ -207,7 +207,7 @@ int main(int argc, char *argv[])
 			for(i = 0; i < values_nr; i++)
 			{
 				const uint32_t value = (values[i] == 32 ? UINT32_MAX : ((1U << values[i]) - 1U));
-				uint8_t sdvl_bytes[sdvl_bytes_max_nr];
+				uint8_t sdvl_bytes[4]; /* the longest SDVL field */
 				size_t sdvl_bytes_nr;
 				uint32_t decoded_value;
 				size_t useful_bits_nr;
@@ -238,11 +238,24 @@ int main(int argc, char *argv[])
 							CHECK(useful_bits_nr == exp_bits[i]);
 						}
 					}
+
+					/* sdvl_decode_large_cid(): 1-byte and 2-byte forms only */
+					for(size_t j = 0; j <= sdvl_bytes_nr; j++)
+					{
+						const size_t exp_result =
+							((j < sdvl_bytes_nr || exp_bytes[i] > 2) ? 0 : exp_bytes[i]);
+						CHECK(sdvl_decode_large_cid(sdvl_bytes, j,
+						                            &decoded_value) == exp_result);
+						if(exp_result > 0)
+						{
+							CHECK(decoded_value == value);
+						}
+					}
 				}
 
 				/* sdvl_encode() */
 				{
-					uint8_t sdvl_bytes2[sdvl_bytes_max_nr];
+					uint8_t sdvl_bytes2[4]; /* the longest SDVL field */
 					size_t sdvl_bytes2_nr;
 					CHECK(sdvl_encode(sdvl_bytes2, sdvl_bytes_max_nr, &sdvl_bytes2_nr,
 					                  value, exp_bits[i]) == exp_status);
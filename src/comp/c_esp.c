@@ -90,6 +90,9 @@ static uint32_t c_esp_get_next_sn(const struct rohc_comp_ctxt *const context,
                                   const struct net_pkt *const uncomp_pkt)
 	__attribute__((warn_unused_result, nonnull(1, 2)));
 
+static bool esp_is_next_header_steady(const struct rohc_comp_ctxt *const context)
+	__attribute__((warn_unused_result, nonnull(1), const));
+
 static size_t esp_code_static_esp_part(const struct rohc_comp_ctxt *const context,
                                        const uint8_t *const next_header,
                                        uint8_t *const dest,
@@ -130,7 +133,8 @@ static bool c_esp_create(struct rohc_comp_ctxt *const context,
 	assert(packet != NULL);
 
 	/* create and initialize the generic part of the profile context */
-	if(!rohc_comp_rfc3095_create(context, ROHC_LSB_SHIFT_ESP_SN, packet))
+	if(!rohc_comp_rfc3095_create(context, ROHC_LSB_SHIFT_ESP_SN,
+	                             sizeof(struct sc_esp_context), packet))
 	{
 		rohc_comp_warn(context, "generic context creation failed");
 		goto quit;
@@ -147,15 +151,9 @@ static bool c_esp_create(struct rohc_comp_ctxt *const context,
 	rohc_comp_debug(context, "initialize context(SN) = hdr(SN) of first "
 	                "packet = %u", rfc3095_ctxt->sn);
 
-	/* create the ESP part of the profile context */
-	esp_context = malloc(sizeof(struct sc_esp_context));
-	if(esp_context == NULL)
-	{
-		rohc_error(context->compressor, ROHC_TRACE_COMP, context->profile->id,
-		           "no memory for the ESP part of the profile context");
-		goto clean;
-	}
-	rfc3095_ctxt->specific = esp_context;
+	/* the ESP part of the profile context was allocated along with the
+	 * generic part */
+	esp_context = (struct sc_esp_context *) rfc3095_ctxt->specific;
 
 	/* initialize the ESP part of the profile context */
 	memcpy(&(esp_context->old_esp), esp, sizeof(struct esphdr));
@@ -164,6 +162,7 @@ static bool c_esp_create(struct rohc_comp_ctxt *const context,
 	rfc3095_ctxt->next_header_len = sizeof(struct esphdr);
 	rfc3095_ctxt->encode_uncomp_fields = NULL;
 	rfc3095_ctxt->decide_state = rohc_comp_rfc3095_decide_state;
+	rfc3095_ctxt->is_next_header_steady = esp_is_next_header_steady;
 	rfc3095_ctxt->decide_FO_packet = c_ip_decide_FO_packet;
 	rfc3095_ctxt->decide_SO_packet = c_ip_decide_SO_packet;
 	rfc3095_ctxt->decide_extension = decide_extension;
@@ -179,8 +178,6 @@ static bool c_esp_create(struct rohc_comp_ctxt *const context,
 
 	return true;
 
-clean:
-	rohc_comp_rfc3095_destroy(context);
 quit:
 	return false;
 }
@@ -356,6 +353,21 @@ quit:
 }
 
 
+/**
+ * @brief Whether the ESP header only moved along its steady pattern
+ *
+ * The SPI is the same for all the packets of the context, and the ESP SN is
+ * the SN of the profile: the ESP header never changes the state.
+ *
+ * @param context  The compression context
+ * @return         Always true
+ */
+static bool esp_is_next_header_steady(const struct rohc_comp_ctxt *const context __attribute__((unused)))
+{
+	return true;
+}
+
+
 /**
  * @brief Determine the SN value for the next packet
  *
@@ -463,5 +475,7 @@ const struct rohc_comp_profile c_esp_profile =
 	.encode         = c_esp_encode,
 	.reinit_context = rohc_comp_reinit_context,
 	.feedback       = rohc_comp_rfc3095_feedback,
+	.get_msn        = rohc_comp_rfc3095_get_msn,
+	.set_next_msn   = rohc_comp_rfc3095_set_next_msn,
 };
 
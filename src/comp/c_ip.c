@@ -65,7 +65,7 @@ static bool rohc_ip_ctxt_create(struct rohc_comp_ctxt *const context,
 	struct rohc_comp_rfc3095_ctxt *rfc3095_ctxt;
 
 	/* call the generic function for all IP-based profiles */
-	if(!rohc_comp_rfc3095_create(context, ROHC_LSB_SHIFT_SN, packet))
+	if(!rohc_comp_rfc3095_create(context, ROHC_LSB_SHIFT_SN, 0, packet))
 	{
 		rohc_comp_warn(context, "generic context creation failed");
 		goto error;
@@ -104,6 +104,10 @@ error:
  *    the context
  *  - the transport protocol must match the one in the context
  *
+ * All those fields are part of the flow fingerprint of the packet, so the
+ * field-by-field comparison is only required for the packets whose IP headers
+ * do not fit in a fingerprint (two IPv6 headers).
+ *
  * This function is one of the functions that must exist in one profile for the
  * framework to work.
  *
@@ -123,6 +127,13 @@ bool c_ip_check_context(const struct rohc_comp_ctxt *const context,
 	bool same_dest;
 	bool same_src2;
 	bool same_dest2;
+	bool same_fprint;
+
+	/* compare the flow fingerprints first */
+	if(net_pkt_fprint_cmp(&packet->fprint, &context->fprint, &same_fprint))
+	{
+		return same_fprint;
+	}
 
 	rfc3095_ctxt = (struct rohc_comp_rfc3095_ctxt *) context->specific;
 	outer_ip_flags = &rfc3095_ctxt->outer_ip_flags;
@@ -515,5 +526,7 @@ const struct rohc_comp_profile c_ip_profile =
 	.encode         = rohc_comp_rfc3095_encode,
 	.reinit_context = rohc_comp_reinit_context,
 	.feedback       = rohc_comp_rfc3095_feedback,
+	.get_msn        = rohc_comp_rfc3095_get_msn,
+	.set_next_msn   = rohc_comp_rfc3095_set_next_msn,
 };
 
@@ -0,0 +1,403 @@
+/*
+ * Copyright 2026 Didier Barvaux
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/**
+ * @file   c_rfc5225_esp.c
+ * @brief  ROHC compression context for the ROHCv2 IP/ESP profile
+ * @author Didier Barvaux <didier@barvaux.org>
+ *
+ * The profile compresses the IP headers as the ROHCv2 IP-only profile does,
+ * and the ESP header that follows them (RFC5225 §6.8.2.7). The MSN is the
+ * 16 LSB of the ESP Sequence Number, so that the ESP Sequence Number is
+ * never transmitted in the CO packets.
+ */
+
+#include "rohc_comp_rfc5225.h"
+#include "rohc_traces_internal.h"
+#include "rohc_utils.h"
+#include "protocols/ip_numbers.h"
+#include "protocols/esp.h"
+
+#ifndef __KERNEL__
+#  include <string.h>
+#endif
+
+
+/*
+ * Private structures and types
+ */
+
+/**
+ * @brief The ESP part of the ROHCv2 IP/ESP compression context
+ *
+ * This object must be used with the generic part of the compression
+ * context rohc_comp_rfc5225_ctxt.
+ *
+ * @see rohc_comp_rfc5225_ctxt
+ */
+struct c_rfc5225_esp_ctxt
+{
+	uint32_t spi;  /**< The ESP SPI (network byte order) */
+	uint32_t sn;   /**< The last ESP Sequence Number (host byte order) */
+};
+
+
+/*
+ * Prototypes of private functions
+ */
+
+static bool c_rfc5225_esp_create(struct rohc_comp_ctxt *const context,
+                                 const struct net_pkt *const packet)
+	__attribute__((warn_unused_result, nonnull(1, 2)));
+
+static bool c_rfc5225_esp_check_profile(const struct rohc_comp *const comp,
+                                        const struct net_pkt *const packet)
+	__attribute__((warn_unused_result, nonnull(1, 2)));
+
+static bool c_rfc5225_esp_check_context(const struct rohc_comp_ctxt *const context,
+                                        const struct net_pkt *const packet)
+	__attribute__((warn_unused_result, nonnull(1, 2)));
+
+static uint16_t c_rfc5225_esp_get_next_msn(const struct rohc_comp_ctxt *const context,
+                                           const uint8_t *const next_header)
+	__attribute__((warn_unused_result, nonnull(1, 2), pure));
+
+static void c_rfc5225_esp_detect_changes(struct rohc_comp_ctxt *const context,
+                                         const uint8_t *const next_header)
+	__attribute__((nonnull(1, 2)));
+
+static int c_rfc5225_esp_code_static(const struct rohc_comp_ctxt *const context,
+                                     const uint8_t *const next_header,
+                                     uint8_t *const rohc_data,
+                                     const size_t rohc_max_len)
+	__attribute__((warn_unused_result, nonnull(1, 2, 3)));
+
+static int c_rfc5225_esp_code_dyn(const struct rohc_comp_ctxt *const context,
+                                  const uint8_t *const next_header,
+                                  uint8_t *const rohc_data,
+                                  const size_t rohc_max_len)
+	__attribute__((warn_unused_result, nonnull(1, 2, 3)));
+
+static size_t c_rfc5225_esp_code_irreg(const struct rohc_comp_ctxt *const context,
+                                       const uint8_t *const next_header,
+                                       uint8_t *const rohc_data)
+	__attribute__((warn_unused_result, nonnull(1, 2, 3), const));
+
+static void c_rfc5225_esp_update_ctxt(struct rohc_comp_ctxt *const context,
+                                      const uint8_t *const next_header,
+                                      const rohc_packet_t packet_type)
+	__attribute__((nonnull(1, 2)));
+
+
+/*
+ * Definitions of functions
+ */
+
+
+/**
+ * @brief Create a new ROHCv2 IP/ESP context and initialize it thanks to
+ *        the given IP/ESP packet
+ *
+ * @param context  The compression context
+ * @param packet   The IP/ESP packet given to initialize the new context
+ * @return         true if successful, false otherwise
+ */
+static bool c_rfc5225_esp_create(struct rohc_comp_ctxt *const context,
+                                 const struct net_pkt *const packet)
+{
+	const struct esphdr *const esp = (struct esphdr *) packet->transport->data;
+	struct rohc_comp_rfc5225_ctxt *rfc5225_ctxt;
+	struct c_rfc5225_esp_ctxt *esp_ctxt;
+
+	if(!rohc_comp_rfc5225_create(context, sizeof(struct c_rfc5225_esp_ctxt),
+	                             packet))
+	{
+		goto error;
+	}
+	rfc5225_ctxt = context->specific;
+	esp_ctxt = rfc5225_ctxt->specific;
+
+	esp_ctxt->spi = esp->spi;
+	esp_ctxt->sn = rohc_ntoh32(esp->sn);
+
+	rfc5225_ctxt->next_header_len = sizeof(struct esphdr);
+	rfc5225_ctxt->get_next_msn = c_rfc5225_esp_get_next_msn;
+	rfc5225_ctxt->detect_next_hdr_changes = c_rfc5225_esp_detect_changes;
+	rfc5225_ctxt->code_static_next_hdr = c_rfc5225_esp_code_static;
+	rfc5225_ctxt->code_dyn_next_hdr = c_rfc5225_esp_code_dyn;
+	rfc5225_ctxt->code_irreg_next_hdr = c_rfc5225_esp_code_irreg;
+	rfc5225_ctxt->update_next_hdr_ctxt = c_rfc5225_esp_update_ctxt;
+
+	return true;
+
+error:
+	return false;
+}
+
+
+/**
+ * @brief Check if the given packet corresponds to the ROHCv2 IP/ESP profile
+ *
+ * Conditions are:
+ *  \li the IP headers are accepted by the ROHCv2 profiles,
+ *  \li the transport protocol is ESP,
+ *  \li the IP payload is large enough for the ESP header.
+ *
+ * @see rohc_comp_rfc5225_check_profile
+ *
+ * @param comp    The ROHC compressor
+ * @param packet  The packet to check
+ * @return        Whether the IP packet corresponds to the profile:
+ *                  \li true if the IP packet corresponds to the profile,
+ *                  \li false if the IP packet does not correspond to
+ *                      the profile
+ */
+static bool c_rfc5225_esp_check_profile(const struct rohc_comp *const comp,
+                                        const struct net_pkt *const packet)
+{
+	if(!rohc_comp_rfc5225_check_profile(comp, packet))
+	{
+		goto bad_profile;
+	}
+
+	/* check that the transport protocol is ESP */
+	if(packet->transport->data == NULL ||
+	   packet->transport->proto != ROHC_IPPROTO_ESP ||
+	   packet->transport->len < sizeof(struct esphdr))
+	{
+		goto bad_profile;
+	}
+
+	return true;
+
+bad_profile:
+	return false;
+}
+
+
+/**
+ * @brief Check if the IP/ESP packet belongs to the ROHCv2 IP/ESP context
+ *
+ * Conditions are:
+ *  - the IP headers belong to the context, see
+ *    \ref rohc_comp_rfc5225_check_context,
+ *  - the ESP SPI must be the same as in context.
+ *
+ * @param context  The compression context
+ * @param packet   The IP/ESP packet to check
+ * @return         true if the IP/ESP packet belongs to the context,
+ *                 false if it does not belong to the context
+ */
+static bool c_rfc5225_esp_check_context(const struct rohc_comp_ctxt *const context,
+                                        const struct net_pkt *const packet)
+{
+	const struct rohc_comp_rfc5225_ctxt *const rfc5225_ctxt =
+		context->specific;
+	const struct c_rfc5225_esp_ctxt *const esp_ctxt = rfc5225_ctxt->specific;
+	const struct esphdr *const esp = (struct esphdr *) packet->transport->data;
+
+	if(!rohc_comp_rfc5225_check_context(context, packet))
+	{
+		goto bad_context;
+	}
+
+	if(esp->spi != esp_ctxt->spi)
+	{
+		rohc_comp_debug(context, "  not same ESP SPI");
+		goto bad_context;
+	}
+
+	return true;
+
+bad_context:
+	return false;
+}
+
+
+/**
+ * @brief Get the MSN of the packet, ie. the 16 LSB of its ESP Sequence Number
+ *
+ * @param context      The compression context
+ * @param next_header  The ESP header
+ * @return             The MSN of the packet
+ */
+static uint16_t c_rfc5225_esp_get_next_msn(const struct rohc_comp_ctxt *const context __attribute__((unused)),
+                                           const uint8_t *const next_header)
+{
+	const struct esphdr *const esp = (struct esphdr *) next_header;
+
+	return rohc_ntoh32(esp->sn) & 0xffff;
+}
+
+
+/**
+ * @brief Detect the changes of the ESP header
+ *
+ * The decompressor rebuilds the ESP Sequence Number from the MSN and the
+ * previous ESP Sequence Number: the IR packet shall transmit the ESP
+ * Sequence Numbers that jump too far for the 16-bit MSN.
+ *
+ * @param context      The compression context
+ * @param next_header  The ESP header
+ */
+static void c_rfc5225_esp_detect_changes(struct rohc_comp_ctxt *const context,
+                                         const uint8_t *const next_header)
+{
+	struct rohc_comp_rfc5225_ctxt *const rfc5225_ctxt = context->specific;
+	const struct c_rfc5225_esp_ctxt *const esp_ctxt = rfc5225_ctxt->specific;
+	const struct esphdr *const esp = (struct esphdr *) next_header;
+	const uint32_t sn_delta = rohc_ntoh32(esp->sn) - esp_ctxt->sn;
+
+	/* the decompressor accepts the deltas in range [-32768, 32767] */
+	if((uint32_t) (sn_delta + 0x8000U) > 0xffffU)
+	{
+		rohc_comp_debug(context, "ESP Sequence Number jumped from 0x%08x to "
+		                "0x%08x", esp_ctxt->sn, rohc_ntoh32(esp->sn));
+		rfc5225_ctxt->tmp.ir_needed = true;
+	}
+}
+
+
+/**
+ * @brief Code the static part of the ESP header (RFC5225 §6.8.2.7)
+ *
+ * @param context       The compression context
+ * @param next_header   The ESP header
+ * @param rohc_data     OUT: The ROHC packet
+ * @param rohc_max_len  The maximum length of the ROHC packet
+ * @return              The length of the static part if successful,
+ *                      -1 otherwise
+ */
+static int c_rfc5225_esp_code_static(const struct rohc_comp_ctxt *const context,
+                                     const uint8_t *const next_header,
+                                     uint8_t *const rohc_data,
+                                     const size_t rohc_max_len)
+{
+	const struct esphdr *const esp = (struct esphdr *) next_header;
+
+	if(rohc_max_len < sizeof(uint32_t))
+	{
+		rohc_comp_warn(context, "ROHC buffer too small for the ESP static part: "
+		               "4 bytes required, but only %zu bytes available",
+		               rohc_max_len);
+		goto error;
+	}
+	memcpy(rohc_data, &esp->spi, sizeof(uint32_t));
+
+	return sizeof(uint32_t);
+
+error:
+	return -1;
+}
+
+
+/**
+ * @brief Code the dynamic part of the ESP header (RFC5225 §6.8.2.7)
+ *
+ * The dynamic part carries the whole ESP Sequence Number, whose 16 LSB are
+ * the MSN, and the reordering ratio.
+ *
+ * @param context       The compression context
+ * @param next_header   The ESP header
+ * @param rohc_data     OUT: The ROHC packet
+ * @param rohc_max_len  The maximum length of the ROHC packet
+ * @return              The length of the dynamic part if successful,
+ *                      -1 otherwise
+ */
+static int c_rfc5225_esp_code_dyn(const struct rohc_comp_ctxt *const context,
+                                  const uint8_t *const next_header,
+                                  uint8_t *const rohc_data,
+                                  const size_t rohc_max_len)
+{
+	const struct rohc_comp_rfc5225_ctxt *const rfc5225_ctxt =
+		context->specific;
+	const struct esphdr *const esp = (struct esphdr *) next_header;
+
+	if(rohc_max_len < 5)
+	{
+		rohc_comp_warn(context, "ROHC buffer too small for the ESP dynamic "
+		               "part: 5 bytes required, but only %zu bytes available",
+		               rohc_max_len);
+		goto error;
+	}
+	memcpy(rohc_data, &esp->sn, sizeof(uint32_t));
+	rohc_data[4] = rfc5225_ctxt->reorder_ratio & 0x03;
+
+	return 5;
+
+error:
+	return -1;
+}
+
+
+/**
+ * @brief Code the irregular part of the ESP header (RFC5225 §6.8.2.7)
+ *
+ * The ESP header has no irregular part.
+ *
+ * @param context      The compression context
+ * @param next_header  The ESP header
+ * @param rohc_data    OUT: The irregular part
+ * @return             The length of the irregular part, always 0
+ */
+static size_t c_rfc5225_esp_code_irreg(const struct rohc_comp_ctxt *const context __attribute__((unused)),
+                                       const uint8_t *const next_header __attribute__((unused)),
+                                       uint8_t *const rohc_data __attribute__((unused)))
+{
+	return 0;
+}
+
+
+/**
+ * @brief Update the context with the ESP header that was just compressed
+ *
+ * @param context      The compression context
+ * @param next_header  The ESP header
+ * @param packet_type  The type of the ROHC packet that was built
+ */
+static void c_rfc5225_esp_update_ctxt(struct rohc_comp_ctxt *const context,
+                                      const uint8_t *const next_header,
+                                      const rohc_packet_t packet_type __attribute__((unused)))
+{
+	struct rohc_comp_rfc5225_ctxt *const rfc5225_ctxt = context->specific;
+	struct c_rfc5225_esp_ctxt *const esp_ctxt = rfc5225_ctxt->specific;
+	const struct esphdr *const esp = (struct esphdr *) next_header;
+
+	esp_ctxt->sn = rohc_ntoh32(esp->sn);
+}
+
+
+/**
+ * @brief Define the compression part of the ROHCv2 IP/ESP profile as
+ *        described in the RFC 5225
+ */
+const struct rohc_comp_profile c_rfc5225_esp_profile =
+{
+	.id             = ROHCv2_PROFILE_IP_ESP, /* profile ID (RFC5225) */
+	.protocol       = ROHC_IPPROTO_ESP,      /* IP protocol */
+	.create         = c_rfc5225_esp_create,  /* profile handlers */
+	.destroy        = rohc_comp_rfc5225_destroy,
+	.check_profile  = c_rfc5225_esp_check_profile,
+	.check_context  = c_rfc5225_esp_check_context,
+	.encode         = rohc_comp_rfc5225_encode,
+	.reinit_context = rohc_comp_reinit_context,
+	.feedback       = rohc_comp_rfc5225_feedback,
+	.get_msn        = rohc_comp_rfc5225_get_msn,
+	.set_next_msn   = rohc_comp_rfc5225_set_next_msn,
+};
+
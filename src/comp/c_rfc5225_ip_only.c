@@ -0,0 +1,82 @@
+/*
+ * Copyright 2016 Didier Barvaux
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/**
+ * @file   c_rfc5225_ip_only.c
+ * @brief  ROHC compression context for the ROHCv2 IP-only profile
+ * @author Didier Barvaux <didier@barvaux.org>
+ *
+ * The profile compresses up to \ref ROHC_RFC5225_MAX_IP_HDRS IPv4 or IPv6
+ * headers without IP options nor IPv6 extension headers, everything that
+ * follows the IP headers is sent as payload (RFC5225 §6.8.2.4).
+ */
+
+#include "rohc_comp_rfc5225.h"
+
+
+/*
+ * Prototypes of private functions
+ */
+
+static bool c_rfc5225_ip_only_create(struct rohc_comp_ctxt *const context,
+                                     const struct net_pkt *const packet)
+	__attribute__((warn_unused_result, nonnull(1, 2)));
+
+
+/*
+ * Definitions of functions
+ */
+
+
+/**
+ * @brief Create a new ROHCv2 IP-only context and initialize it thanks to
+ *        the given IP packet
+ *
+ * The IP-only profile has no specific part: the generic ROHCv2 context
+ * handles all the IP headers.
+ *
+ * @param context  The compression context
+ * @param packet   The IP packet given to initialize the new context
+ * @return         true if successful, false otherwise
+ */
+static bool c_rfc5225_ip_only_create(struct rohc_comp_ctxt *const context,
+                                     const struct net_pkt *const packet)
+{
+	return rohc_comp_rfc5225_create(context, 0, packet);
+}
+
+
+/**
+ * @brief Define the compression part of the ROHCv2 IP-only profile as
+ *        described in the RFC 5225
+ */
+const struct rohc_comp_profile c_rfc5225_ip_only_profile =
+{
+	.id             = ROHCv2_PROFILE_IP, /* profile ID (RFC5225) */
+	.protocol       = 0,                 /* any IP protocol */
+	.create         = c_rfc5225_ip_only_create,  /* profile handlers */
+	.destroy        = rohc_comp_rfc5225_destroy,
+	.check_profile  = rohc_comp_rfc5225_check_profile,
+	.check_context  = rohc_comp_rfc5225_check_context,
+	.encode         = rohc_comp_rfc5225_encode,
+	.reinit_context = rohc_comp_reinit_context,
+	.feedback       = rohc_comp_rfc5225_feedback,
+	.get_msn        = rohc_comp_rfc5225_get_msn,
+	.set_next_msn   = rohc_comp_rfc5225_set_next_msn,
+};
+
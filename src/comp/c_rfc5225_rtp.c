@@ -0,0 +1,1006 @@
+/*
+ * Copyright 2026 Didier Barvaux
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/**
+ * @file   c_rfc5225_rtp.c
+ * @brief  ROHC compression context for the ROHCv2 IP/UDP/RTP profile
+ * @author Didier Barvaux <didier@barvaux.org>
+ *
+ * The profile compresses the IP headers as the ROHCv2 IP-only profile does,
+ * and the UDP and RTP headers that follow them. The RTP Sequence Number is
+ * the MSN. The RTP Timestamp is scaled by its stride: the scaled TS is
+ * deduced from the MSN as long as its offset from the MSN is the same in the
+ * whole W-LSB window, and transmitted as LSB otherwise.
+ *
+ * The pt_1_rnd and pt_2_rnd packets transmit the LSB of the scaled TS and
+ * the RTP Marker. The pt_0_crc3, pt_0_crc7, pt_1_seq_id and pt_2_seq_id
+ * packets imply a deduced TS and a zero Marker. The co_common packet
+ * transmits the other RTP fields after the fields of the IP headers.
+ *
+ * The RTP headers with CSRC items are not compressed by the profile.
+ */
+
+#include "rohc_comp_rfc5225.h"
+#include "rohc_traces_internal.h"
+#include "rohc_utils.h"
+#include "protocols/ip_numbers.h"
+#include "protocols/udp.h"
+#include "protocols/rtp.h"
+
+#ifndef __KERNEL__
+#  include <string.h>
+#endif
+#include <assert.h>
+
+
+/*
+ * Private structures and types
+ */
+
+/** The temporary variables computed for one RTP header */
+struct c_rfc5225_rtp_tmp
+{
+	uint32_t ts;              /**< The RTP Timestamp (host byte order) */
+	bool marker;              /**< The RTP Marker bit */
+	uint32_t ts_scaled;       /**< The scaled TS, if the TS stride is known */
+	uint32_t ts_scaled_offset;/**< The offset of the scaled TS from the MSN */
+	size_t ts_scaled_k;       /**< The number of bits required for the scaled TS */
+	bool is_ts_deducible;     /**< Whether the TS is deduced from the MSN */
+};
+
+
+/**
+ * @brief The UDP/RTP part of the ROHCv2 IP/UDP/RTP compression context
+ *
+ * This object must be used with the generic part of the compression
+ * context rohc_comp_rfc5225_ctxt.
+ *
+ * @see rohc_comp_rfc5225_ctxt
+ */
+struct c_rfc5225_rtp_ctxt
+{
+	uint16_t sport;         /**< The UDP source port (network byte order) */
+	uint16_t dport;         /**< The UDP destination port (network byte order) */
+	bool is_checksum_used;  /**< Whether the UDP checksum is non-zero */
+
+	uint32_t ssrc;          /**< The RTP SSRC (network byte order) */
+	uint8_t pt;             /**< The RTP Payload Type */
+	uint8_t padding;        /**< The RTP Padding bit */
+	uint8_t extension;      /**< The RTP Extension bit */
+	uint16_t msn;           /**< The MSN of the last packet */
+	uint32_t ts;            /**< The RTP Timestamp of the last packet */
+
+	/** The stride of the RTP Timestamp, 0 if not known */
+	uint32_t ts_stride;
+	/** The offset of the RTP Timestamp, ie. TS modulo the stride */
+	uint32_t ts_offset;
+	/** The TS delta that might become the new stride */
+	uint32_t ts_stride_candidate;
+	/** The number of consecutive packets with the candidate TS delta */
+	size_t ts_stride_candidate_nr;
+
+	/** The W-LSB window of the scaled TS */
+	struct c_wlsb ts_scaled_wlsb;
+	/** The W-LSB window of the offset of the scaled TS from the MSN */
+	struct c_wlsb ts_scaled_offset_wlsb;
+
+	/** The number of co_common or IR packets sent since the Payload Type, the
+	 *  Padding or Extension bit, the TS stride or the TS offset changed */
+	size_t rtp_change_count;
+
+	/** The temporary variables computed for the current packet */
+	struct c_rfc5225_rtp_tmp tmp;
+};
+
+
+/*
+ * Prototypes of private functions
+ */
+
+static bool c_rfc5225_rtp_create(struct rohc_comp_ctxt *const context,
+                                 const struct net_pkt *const packet)
+	__attribute__((warn_unused_result, nonnull(1, 2)));
+
+static bool c_rfc5225_rtp_check_profile(const struct rohc_comp *const comp,
+                                        const struct net_pkt *const packet)
+	__attribute__((warn_unused_result, nonnull(1, 2)));
+
+static bool c_rfc5225_rtp_is_on_rtp_port(const struct rohc_comp *const comp,
+                                         const struct udphdr *const udp,
+                                         const struct rtphdr *const rtp)
+	__attribute__((warn_unused_result, nonnull(1, 2, 3), pure));
+
+static bool c_rfc5225_rtp_check_context(const struct rohc_comp_ctxt *const context,
+                                        const struct net_pkt *const packet)
+	__attribute__((warn_unused_result, nonnull(1, 2)));
+
+static uint16_t c_rfc5225_rtp_get_next_msn(const struct rohc_comp_ctxt *const context,
+                                           const uint8_t *const next_header)
+	__attribute__((warn_unused_result, nonnull(1, 2)));
+
+static void c_rfc5225_rtp_detect_changes(struct rohc_comp_ctxt *const context,
+                                         const uint8_t *const next_header)
+	__attribute__((nonnull(1, 2)));
+
+static void c_rfc5225_rtp_detect_ts_changes(struct rohc_comp_ctxt *const context)
+	__attribute__((nonnull(1)));
+
+static rohc_packet_t c_rfc5225_rtp_decide_FO_SO_pkt(const struct rohc_comp_ctxt *const context,
+                                                    const bool crc7_only)
+	__attribute__((warn_unused_result, nonnull(1)));
+
+static int c_rfc5225_rtp_code_static(const struct rohc_comp_ctxt *const context,
+                                     const uint8_t *const next_header,
+                                     uint8_t *const rohc_data,
+                                     const size_t rohc_max_len)
+	__attribute__((warn_unused_result, nonnull(1, 2, 3)));
+
+static int c_rfc5225_rtp_code_dyn(const struct rohc_comp_ctxt *const context,
+                                  const uint8_t *const next_header,
+                                  uint8_t *const rohc_data,
+                                  const size_t rohc_max_len)
+	__attribute__((warn_unused_result, nonnull(1, 2, 3)));
+
+static size_t c_rfc5225_rtp_code_CO_base(const struct rohc_comp_ctxt *const context,
+                                         const struct net_pkt *const uncomp_pkt,
+                                         const rohc_packet_t packet_type,
+                                         const uint8_t crc,
+                                         uint8_t *const hdr)
+	__attribute__((warn_unused_result, nonnull(1, 2, 5)));
+
+static size_t c_rfc5225_rtp_build_co_common_rtp(const struct rohc_comp_ctxt *const context,
+                                                const struct rtphdr *const rtp,
+                                                uint8_t *const hdr)
+	__attribute__((warn_unused_result, nonnull(1, 2, 3)));
+
+static size_t c_rfc5225_rtp_code_irreg(const struct rohc_comp_ctxt *const context,
+                                       const uint8_t *const next_header,
+                                       uint8_t *const rohc_data)
+	__attribute__((warn_unused_result, nonnull(1, 2, 3)));
+
+static void c_rfc5225_rtp_update_ctxt(struct rohc_comp_ctxt *const context,
+                                      const uint8_t *const next_header,
+                                      const rohc_packet_t packet_type)
+	__attribute__((nonnull(1, 2)));
+
+
+/*
+ * Definitions of functions
+ */
+
+
+/**
+ * @brief Create a new ROHCv2 IP/UDP/RTP context and initialize it thanks to
+ *        the given IP/UDP/RTP packet
+ *
+ * @param context  The compression context
+ * @param packet   The IP/UDP/RTP packet given to initialize the new context
+ * @return         true if successful, false otherwise
+ */
+static bool c_rfc5225_rtp_create(struct rohc_comp_ctxt *const context,
+                                 const struct net_pkt *const packet)
+{
+	const struct rohc_comp *const comp = context->compressor;
+	const struct udphdr *const udp = (struct udphdr *) packet->transport->data;
+	const struct rtphdr *const rtp = (struct rtphdr *) (udp + 1);
+	struct rohc_comp_rfc5225_ctxt *rfc5225_ctxt;
+	struct c_rfc5225_rtp_ctxt *rtp_ctxt;
+
+	if(!rohc_comp_rfc5225_create(context, sizeof(struct c_rfc5225_rtp_ctxt),
+	                             packet))
+	{
+		goto error;
+	}
+	rfc5225_ctxt = context->specific;
+	rtp_ctxt = rfc5225_ctxt->specific;
+
+	rtp_ctxt->sport = udp->source;
+	rtp_ctxt->dport = udp->dest;
+	rtp_ctxt->is_checksum_used = !!(udp->check != 0);
+
+	rtp_ctxt->ssrc = rtp->ssrc;
+	rtp_ctxt->pt = rtp->pt;
+	rtp_ctxt->padding = rtp->padding;
+	rtp_ctxt->extension = rtp->extension;
+	rtp_ctxt->msn = (rohc_ntoh16(rtp->sn) - 1) & 0xffff;
+	rtp_ctxt->ts = rohc_ntoh32(rtp->timestamp);
+
+	/* the TS stride is learned from the first packets */
+	rtp_ctxt->ts_stride = 0;
+	rtp_ctxt->ts_offset = 0;
+	rtp_ctxt->ts_stride_candidate = 0;
+	rtp_ctxt->ts_stride_candidate_nr = 0;
+	c_init_wlsb(&rtp_ctxt->ts_scaled_wlsb, 32, comp->wlsb_window_width,
+	            rohc_interval_get_rfc5225_msn_p(rfc5225_ctxt->reorder_ratio));
+	c_init_wlsb(&rtp_ctxt->ts_scaled_offset_wlsb, 32, comp->wlsb_window_width,
+	            ROHC_LSB_SHIFT_IP_ID);
+
+	/* no change to repeat yet */
+	rtp_ctxt->rtp_change_count = MAX_FO_COUNT;
+
+	rfc5225_ctxt->next_header_len = sizeof(struct udphdr) + sizeof(struct rtphdr);
+	rfc5225_ctxt->get_next_msn = c_rfc5225_rtp_get_next_msn;
+	rfc5225_ctxt->detect_next_hdr_changes = c_rfc5225_rtp_detect_changes;
+	rfc5225_ctxt->decide_FO_SO_pkt = c_rfc5225_rtp_decide_FO_SO_pkt;
+	rfc5225_ctxt->code_static_next_hdr = c_rfc5225_rtp_code_static;
+	rfc5225_ctxt->code_dyn_next_hdr = c_rfc5225_rtp_code_dyn;
+	rfc5225_ctxt->code_CO_base = c_rfc5225_rtp_code_CO_base;
+	rfc5225_ctxt->code_irreg_next_hdr = c_rfc5225_rtp_code_irreg;
+	rfc5225_ctxt->update_next_hdr_ctxt = c_rfc5225_rtp_update_ctxt;
+
+	return true;
+
+error:
+	return false;
+}
+
+
+/**
+ * @brief Check if the given packet corresponds to the ROHCv2 IP/UDP/RTP
+ *        profile
+ *
+ * Conditions are:
+ *  \li the IP headers are accepted by the ROHCv2 profiles,
+ *  \li the transport protocol is UDP,
+ *  \li the UDP Length field and the IP payload match,
+ *  \li the UDP payload is large enough for the RTP header,
+ *  \li the UDP packet is detected as a RTP packet, either on the RTP ports
+ *      or by the RTP detection callback,
+ *  \li the RTP version is 2 and the RTP header has no CSRC item.
+ *
+ * @see rohc_comp_rfc5225_check_profile
+ *
+ * @param comp    The ROHC compressor
+ * @param packet  The packet to check
+ * @return        Whether the IP packet corresponds to the profile:
+ *                  \li true if the IP packet corresponds to the profile,
+ *                  \li false if the IP packet does not correspond to
+ *                      the profile
+ */
+static bool c_rfc5225_rtp_check_profile(const struct rohc_comp *const comp,
+                                        const struct net_pkt *const packet)
+{
+	const struct udphdr *udp;
+	const uint8_t *udp_payload;
+	size_t udp_payload_len;
+	const struct rtphdr *rtp;
+
+	if(!rohc_comp_rfc5225_check_profile(comp, packet))
+	{
+		goto bad_profile;
+	}
+
+	/* check that the transport protocol is UDP */
+	if(packet->transport->data == NULL ||
+	   packet->transport->proto != ROHC_IPPROTO_UDP ||
+	   packet->transport->len < (sizeof(struct udphdr) + sizeof(struct rtphdr)))
+	{
+		goto bad_profile;
+	}
+
+	/* the UDP Length is not transmitted, it shall match the IP payload */
+	udp = (const struct udphdr *) packet->transport->data;
+	if(packet->transport->len != rohc_ntoh16(udp->len))
+	{
+		goto bad_profile;
+	}
+	udp_payload = (const uint8_t *) (udp + 1);
+	udp_payload_len = packet->transport->len - sizeof(struct udphdr);
+	rtp = (const struct rtphdr *) udp_payload;
+
+	/* check if the IP/UDP packet is a RTP packet */
+	if(c_rfc5225_rtp_is_on_rtp_port(comp, udp, rtp))
+	{
+		rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		           "RTP packet detected on the RTP ports");
+	}
+	else if(comp->rtp_callback != NULL)
+	{
+		const struct ip_packet *const innermost_ip_hdr =
+			(packet->ip_hdr_nr == 1 ? &packet->outer_ip : &packet->inner_ip);
+
+		if(!comp->rtp_callback(innermost_ip_hdr->data, (uint8_t *) udp,
+		                       udp_payload, udp_payload_len, comp->rtp_private))
+		{
+			goto bad_profile;
+		}
+		rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		           "RTP packet detected by the RTP callback");
+	}
+	else
+	{
+		goto bad_profile;
+	}
+
+	/* the RTP version is not transmitted, and the CSRC list is not
+	 * supported by the profile */
+	if(rtp->version != 2 || rtp->cc != 0)
+	{
+		rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		           "RTP version %u or %u CSRC items not supported",
+		           rtp->version, rtp->cc);
+		goto bad_profile;
+	}
+
+	return true;
+
+bad_profile:
+	return false;
+}
+
+
+/**
+ * @brief Whether the UDP packet is a RTP packet on the RTP ports
+ *
+ * One of the UDP ports is dedicated to RTP streams, and the UDP payload
+ * looks like a RTP header with version 2 and an accepted Payload Type.
+ *
+ * @param comp  The ROHC compressor
+ * @param udp   The UDP header
+ * @param rtp   The RTP header candidate, at least 12-byte long
+ * @return      true if the UDP packet is a RTP packet, false otherwise
+ */
+static bool c_rfc5225_rtp_is_on_rtp_port(const struct rohc_comp *const comp,
+                                         const struct udphdr *const udp,
+                                         const struct rtphdr *const rtp)
+{
+	if(comp->rtp_ports_nr == 0)
+	{
+		return false;
+	}
+	if(!rohc_bitmap_test(comp->rtp_ports, rohc_ntoh16(udp->source)) &&
+	   !rohc_bitmap_test(comp->rtp_ports, rohc_ntoh16(udp->dest)))
+	{
+		return false;
+	}
+
+	return (rtp->version == 2 && rohc_bitmap_test(comp->rtp_pts, rtp->pt));
+}
+
+
+/**
+ * @brief Check if the IP/UDP/RTP packet belongs to the ROHCv2 IP/UDP/RTP
+ *        context
+ *
+ * Conditions are:
+ *  - the IP headers belong to the context, see
+ *    \ref rohc_comp_rfc5225_check_context,
+ *  - the UDP ports must be the same as in context,
+ *  - the RTP SSRC must be the same as in context,
+ *  - the RTP version must be 2 and the RTP header shall have no CSRC item.
+ *
+ * @param context  The compression context
+ * @param packet   The IP/UDP/RTP packet to check
+ * @return         true if the IP/UDP/RTP packet belongs to the context,
+ *                 false if it does not belong to the context
+ */
+static bool c_rfc5225_rtp_check_context(const struct rohc_comp_ctxt *const context,
+                                        const struct net_pkt *const packet)
+{
+	const struct rohc_comp_rfc5225_ctxt *const rfc5225_ctxt =
+		context->specific;
+	const struct c_rfc5225_rtp_ctxt *const rtp_ctxt = rfc5225_ctxt->specific;
+	const struct udphdr *const udp = (struct udphdr *) packet->transport->data;
+	const struct rtphdr *const rtp = (struct rtphdr *) (udp + 1);
+
+	/* check the RTP SSRC first: the RTP streams multiplexed between the
+	 * same IP addresses and UDP ports differ by their SSRC only */
+	if(rtp->ssrc != rtp_ctxt->ssrc)
+	{
+		rohc_comp_debug(context, "  not same RTP SSRC");
+		goto bad_context;
+	}
+
+	if(!rohc_comp_rfc5225_check_context(context, packet))
+	{
+		goto bad_context;
+	}
+
+	if(udp->source != rtp_ctxt->sport || udp->dest != rtp_ctxt->dport)
+	{
+		rohc_comp_debug(context, "  not same UDP ports");
+		goto bad_context;
+	}
+
+	if(rtp->version != 2 || rtp->cc != 0)
+	{
+		rohc_comp_debug(context, "  RTP version or CSRC items not supported");
+		goto bad_context;
+	}
+
+	return true;
+
+bad_context:
+	return false;
+}
+
+
+/**
+ * @brief Get the MSN of the packet: the RTP Sequence Number
+ *
+ * @param context      The compression context
+ * @param next_header  The UDP header followed by the RTP header
+ * @return             The MSN of the packet
+ */
+static uint16_t c_rfc5225_rtp_get_next_msn(const struct rohc_comp_ctxt *const context __attribute__((unused)),
+                                           const uint8_t *const next_header)
+{
+	const struct rtphdr *const rtp =
+		(struct rtphdr *) (next_header + sizeof(struct udphdr));
+
+	return rohc_ntoh16(rtp->sn);
+}
+
+
+/**
+ * @brief Detect the changes of the UDP and RTP headers
+ *
+ * Whether the UDP checksum is used or not is transmitted in the IR packet
+ * only. The changes of the Payload Type, of the Padding and Extension bits,
+ * and of the TS stride or offset are repeated in several co_common packets.
+ *
+ * @param context      The compression context
+ * @param next_header  The UDP header followed by the RTP header
+ */
+static void c_rfc5225_rtp_detect_changes(struct rohc_comp_ctxt *const context,
+                                         const uint8_t *const next_header)
+{
+	struct rohc_comp_rfc5225_ctxt *const rfc5225_ctxt = context->specific;
+	struct c_rfc5225_rtp_ctxt *const rtp_ctxt = rfc5225_ctxt->specific;
+	const struct udphdr *const udp = (struct udphdr *) next_header;
+	const struct rtphdr *const rtp = (struct rtphdr *) (udp + 1);
+
+	if((udp->check != 0) != rtp_ctxt->is_checksum_used)
+	{
+		rohc_comp_debug(context, "UDP checksum is now %s",
+		                udp->check != 0 ? "used" : "unused");
+		rfc5225_ctxt->tmp.ir_needed = true;
+	}
+
+	if(rtp->pt != rtp_ctxt->pt || rtp->padding != rtp_ctxt->padding ||
+	   rtp->extension != rtp_ctxt->extension)
+	{
+		rohc_comp_debug(context, "RTP Payload Type, Padding or Extension "
+		                "changed");
+		rtp_ctxt->rtp_change_count = 0;
+	}
+
+	rtp_ctxt->tmp.ts = rohc_ntoh32(rtp->timestamp);
+	rtp_ctxt->tmp.marker = !!(rtp->m != 0);
+	c_rfc5225_rtp_detect_ts_changes(context);
+}
+
+
+/**
+ * @brief Detect the changes of the RTP Timestamp
+ *
+ * The TS delta between two consecutive packets becomes the new TS stride
+ * once it was seen in \ref ROHC_INIT_TS_STRIDE_MIN consecutive packets, or
+ * at once if no stride is known yet. The TS offset is the TS modulo the
+ * stride. The W-LSB windows of the scaled TS are reset when the stride or
+ * the offset changes.
+ *
+ * @param context  The compression context
+ */
+static void c_rfc5225_rtp_detect_ts_changes(struct rohc_comp_ctxt *const context)
+{
+	struct rohc_comp_rfc5225_ctxt *const rfc5225_ctxt = context->specific;
+	struct c_rfc5225_rtp_ctxt *const rtp_ctxt = rfc5225_ctxt->specific;
+	struct c_rfc5225_rtp_tmp *const tmp = &rtp_ctxt->tmp;
+	const uint16_t msn_delta = (rfc5225_ctxt->msn - rtp_ctxt->msn) & 0xffff;
+	const uint32_t ts_delta = tmp->ts - rtp_ctxt->ts;
+	bool is_new_stride = false;
+
+	/* learn the TS stride from the packets with consecutive MSN */
+	if(msn_delta == 1 && ts_delta != 0 && ts_delta <= 0x7fffffff &&
+	   ts_delta != rtp_ctxt->ts_stride)
+	{
+		if(ts_delta == rtp_ctxt->ts_stride_candidate)
+		{
+			rtp_ctxt->ts_stride_candidate_nr++;
+		}
+		else
+		{
+			rtp_ctxt->ts_stride_candidate = ts_delta;
+			rtp_ctxt->ts_stride_candidate_nr = 1;
+		}
+		if(rtp_ctxt->ts_stride == 0 ||
+		   rtp_ctxt->ts_stride_candidate_nr >= ROHC_INIT_TS_STRIDE_MIN)
+		{
+			rohc_comp_debug(context, "TS stride changed from %u to %u",
+			                rtp_ctxt->ts_stride, ts_delta);
+			rtp_ctxt->ts_stride = ts_delta;
+			rtp_ctxt->ts_stride_candidate_nr = 0;
+			is_new_stride = true;
+		}
+	}
+	else if(msn_delta == 1 && ts_delta == rtp_ctxt->ts_stride)
+	{
+		rtp_ctxt->ts_stride_candidate_nr = 0;
+	}
+
+	if(rtp_ctxt->ts_stride == 0)
+	{
+		/* no stride: the TS is transmitted in full when it changes */
+		if(tmp->ts != rtp_ctxt->ts)
+		{
+			rohc_comp_debug(context, "unscaled TS changed");
+			rtp_ctxt->rtp_change_count = 0;
+		}
+		tmp->ts_scaled = 0;
+		tmp->ts_scaled_offset = 0;
+		tmp->ts_scaled_k = 32;
+		tmp->is_ts_deducible = !!(tmp->ts == rtp_ctxt->ts);
+	}
+	else
+	{
+		if(is_new_stride || (tmp->ts % rtp_ctxt->ts_stride) != rtp_ctxt->ts_offset)
+		{
+			rtp_ctxt->ts_offset = tmp->ts % rtp_ctxt->ts_stride;
+			rohc_comp_debug(context, "TS offset is now %u", rtp_ctxt->ts_offset);
+			c_init_wlsb(&rtp_ctxt->ts_scaled_wlsb, 32,
+			            context->compressor->wlsb_window_width,
+			            rohc_interval_get_rfc5225_msn_p(rfc5225_ctxt->reorder_ratio));
+			c_init_wlsb(&rtp_ctxt->ts_scaled_offset_wlsb, 32,
+			            context->compressor->wlsb_window_width,
+			            ROHC_LSB_SHIFT_IP_ID);
+			rtp_ctxt->rtp_change_count = 0;
+		}
+		tmp->ts_scaled = tmp->ts / rtp_ctxt->ts_stride;
+		tmp->ts_scaled_offset = tmp->ts_scaled - rfc5225_ctxt->msn;
+		tmp->ts_scaled_k =
+			wlsb_get_k_32bits(&rtp_ctxt->ts_scaled_wlsb, tmp->ts_scaled);
+		tmp->is_ts_deducible =
+			!!(wlsb_get_kp_32bits(&rtp_ctxt->ts_scaled_offset_wlsb,
+			                      tmp->ts_scaled_offset, ROHC_LSB_SHIFT_IP_ID) == 0);
+	}
+	rohc_comp_debug(context, "TS = %u, stride = %u, offset = %u, scaled TS = "
+	                "%u (%zu bits required, %s)", tmp->ts, rtp_ctxt->ts_stride,
+	                rtp_ctxt->ts_offset, tmp->ts_scaled, tmp->ts_scaled_k,
+	                tmp->is_ts_deducible ? "deducible" : "not deducible");
+}
+
+
+/**
+ * @brief Decide which packet to send in the FO or SO state
+ *
+ * The packets without TS bits are used as long as the TS is deduced from
+ * the MSN and the RTP Marker is not set. The pt_1_rnd and pt_2_rnd packets
+ * transmit the LSB of the scaled TS and the Marker otherwise.
+ *
+ * @param context    The compression context
+ * @param crc7_only  Whether only the packets protected by a 7-bit CRC are
+ *                   allowed (FO state) or not (SO state)
+ * @return           The packet type
+ */
+static rohc_packet_t c_rfc5225_rtp_decide_FO_SO_pkt(const struct rohc_comp_ctxt *const context,
+                                                    const bool crc7_only)
+{
+	const struct rohc_comp_rfc5225_ctxt *const rfc5225_ctxt =
+		context->specific;
+	const struct c_rfc5225_rtp_ctxt *const rtp_ctxt = rfc5225_ctxt->specific;
+	const struct rohc_comp_rfc5225_tmp *const tmp = &rfc5225_ctxt->tmp;
+	const size_t innermost_pos = rfc5225_ctxt->ip_ctxts_nr - 1;
+	const bool is_ip_id_seq =
+		!!(rfc5225_ctxt->ip_ctxts[innermost_pos].version == IPV4 &&
+		   (tmp->ip_id_behaviors[innermost_pos] == ROHC_RFC5225_IP_ID_SEQ ||
+		    tmp->ip_id_behaviors[innermost_pos] == ROHC_RFC5225_IP_ID_SEQ_SWAP));
+	rohc_packet_t packet_type;
+
+	if(rfc5225_ctxt->innermost_change_count < MAX_FO_COUNT ||
+	   rfc5225_ctxt->outer_change_count < MAX_FO_COUNT ||
+	   rtp_ctxt->rtp_change_count < MAX_FO_COUNT)
+	{
+		/* the changes of the IP and RTP headers are repeated several times */
+		packet_type = ROHC_PACKET_CO_COMMON;
+	}
+	else if(rtp_ctxt->tmp.is_ts_deducible && !rtp_ctxt->tmp.marker)
+	{
+		if(is_ip_id_seq && !tmp->is_ip_id_offset_const)
+		{
+			/* sequential IP-ID with a new offset */
+			if(!crc7_only && tmp->ip_id_offset_k <= 4 && tmp->msn_k <= 5)
+			{
+				packet_type = ROHC_PACKET_PT_1_SEQ_ID;
+			}
+			else if(tmp->ip_id_offset_k <= 5 && tmp->msn_k <= 8)
+			{
+				packet_type = ROHC_PACKET_PT_2_SEQ_ID;
+			}
+			else
+			{
+				packet_type = ROHC_PACKET_CO_COMMON;
+			}
+		}
+		else if(!crc7_only && tmp->msn_k <= 4)
+		{
+			packet_type = ROHC_PACKET_PT_0_CRC3;
+		}
+		else if(tmp->msn_k <= 5)
+		{
+			packet_type = ROHC_PACKET_PT_0_CRC7;
+		}
+		else if(is_ip_id_seq && tmp->ip_id_offset_k <= 5 && tmp->msn_k <= 8)
+		{
+			packet_type = ROHC_PACKET_PT_2_SEQ_ID;
+		}
+		else
+		{
+			packet_type = ROHC_PACKET_CO_COMMON;
+		}
+	}
+	else if(rtp_ctxt->ts_stride != 0 && rtp_ctxt->tmp.ts_scaled_k <= 5 &&
+	        (!is_ip_id_seq || tmp->is_ip_id_offset_const))
+	{
+		/* new scaled TS or RTP Marker set */
+		if(!crc7_only && tmp->msn_k <= 4)
+		{
+			packet_type = ROHC_PACKET_PT_1_RND;
+		}
+		else if(tmp->msn_k <= 7)
+		{
+			packet_type = ROHC_PACKET_PT_2_RND;
+		}
+		else
+		{
+			packet_type = ROHC_PACKET_CO_COMMON;
+		}
+	}
+	else
+	{
+		packet_type = ROHC_PACKET_CO_COMMON;
+	}
+
+	/* all the CO packets transmit 8 MSN bits at most */
+	if(tmp->msn_k > 8)
+	{
+		packet_type = ROHC_PACKET_IR;
+	}
+
+	return packet_type;
+}
+
+
+/**
+ * @brief Code the static part of the UDP and RTP headers
+ *
+ * The static part carries the UDP ports and the RTP SSRC.
+ *
+ * @param context       The compression context
+ * @param next_header   The UDP header followed by the RTP header
+ * @param rohc_data     OUT: The ROHC packet
+ * @param rohc_max_len  The maximum length of the ROHC packet
+ * @return              The length of the static part if successful,
+ *                      -1 otherwise
+ */
+static int c_rfc5225_rtp_code_static(const struct rohc_comp_ctxt *const context,
+                                     const uint8_t *const next_header,
+                                     uint8_t *const rohc_data,
+                                     const size_t rohc_max_len)
+{
+	const struct udphdr *const udp = (struct udphdr *) next_header;
+	const struct rtphdr *const rtp = (struct rtphdr *) (udp + 1);
+
+	if(rohc_max_len < 8)
+	{
+		rohc_comp_warn(context, "ROHC buffer too small for the UDP/RTP static "
+		               "part: 8 bytes required, but only %zu bytes available",
+		               rohc_max_len);
+		goto error;
+	}
+	memcpy(rohc_data, &udp->source, sizeof(uint16_t));
+	memcpy(rohc_data + 2, &udp->dest, sizeof(uint16_t));
+	memcpy(rohc_data + 4, &rtp->ssrc, sizeof(uint32_t));
+
+	return 8;
+
+error:
+	return -1;
+}
+
+
+/**
+ * @brief Code the dynamic part of the UDP and RTP headers
+ *
+ * The dynamic part carries the UDP checksum, the MSN, the reordering ratio,
+ * the Marker, Padding and Extension bits, the Payload Type, the TS and the
+ * TS stride.
+ *
+ * @param context       The compression context
+ * @param next_header   The UDP header followed by the RTP header
+ * @param rohc_data     OUT: The ROHC packet
+ * @param rohc_max_len  The maximum length of the ROHC packet
+ * @return              The length of the dynamic part if successful,
+ *                      -1 otherwise
+ */
+static int c_rfc5225_rtp_code_dyn(const struct rohc_comp_ctxt *const context,
+                                  const uint8_t *const next_header,
+                                  uint8_t *const rohc_data,
+                                  const size_t rohc_max_len)
+{
+	const struct rohc_comp_rfc5225_ctxt *const rfc5225_ctxt =
+		context->specific;
+	const struct c_rfc5225_rtp_ctxt *const rtp_ctxt = rfc5225_ctxt->specific;
+	const struct udphdr *const udp = (struct udphdr *) next_header;
+	const struct rtphdr *const rtp = (struct rtphdr *) (udp + 1);
+	const uint32_t ts_stride = rohc_hton32(rtp_ctxt->ts_stride);
+
+	if(rohc_max_len < 15)
+	{
+		rohc_comp_warn(context, "ROHC buffer too small for the UDP/RTP dynamic "
+		               "part: 15 bytes required, but only %zu bytes available",
+		               rohc_max_len);
+		goto error;
+	}
+	memcpy(rohc_data, &udp->check, sizeof(uint16_t));
+	rohc_data[2] = (rfc5225_ctxt->msn >> 8) & 0xff;
+	rohc_data[3] = rfc5225_ctxt->msn & 0xff;
+	rohc_data[4] = rfc5225_ctxt->reorder_ratio & 0x03;
+	rohc_data[5] = (rtp->m << 7) | (rtp->padding << 6) | (rtp->extension << 5);
+	rohc_data[6] = rtp->pt & 0x7f;
+	memcpy(rohc_data + 7, &rtp->timestamp, sizeof(uint32_t));
+	memcpy(rohc_data + 11, &ts_stride, sizeof(uint32_t));
+
+	return 15;
+
+error:
+	return -1;
+}
+
+
+/**
+ * @brief Code the base header of one CO packet of the IP/UDP/RTP profile
+ *
+ * @param context      The compression context
+ * @param uncomp_pkt   The uncompressed packet to encode
+ * @param packet_type  The type of CO packet to code
+ * @param crc          The CRC over the uncompressed headers
+ * @param hdr          OUT: The base header
+ * @return             The length of the base header
+ */
+static size_t c_rfc5225_rtp_code_CO_base(const struct rohc_comp_ctxt *const context,
+                                         const struct net_pkt *const uncomp_pkt,
+                                         const rohc_packet_t packet_type,
+                                         const uint8_t crc,
+                                         uint8_t *const hdr)
+{
+	struct rohc_comp_rfc5225_ctxt *const rfc5225_ctxt = context->specific;
+	const struct c_rfc5225_rtp_ctxt *const rtp_ctxt = rfc5225_ctxt->specific;
+	const struct rtphdr *const rtp =
+		(struct rtphdr *) (uncomp_pkt->transport->data + sizeof(struct udphdr));
+	const uint16_t msn = rfc5225_ctxt->msn;
+	const uint16_t ip_id_offset = rfc5225_ctxt->tmp.ip_id_offset;
+	const uint32_t ts_scaled = rtp_ctxt->tmp.ts_scaled;
+	const uint8_t marker = (rtp_ctxt->tmp.marker ? 1 : 0);
+	size_t hdr_len;
+
+	switch(packet_type)
+	{
+		case ROHC_PACKET_PT_0_CRC3:
+			hdr[0] = ROHC_RFC5225_PT_0_CRC3_DISC | ((msn & 0x0f) << 3) | crc;
+			hdr_len = 1;
+			rfc5225_ctxt->tmp.msn_bits_nr = 4;
+			break;
+		case ROHC_PACKET_PT_0_CRC7:
+			hdr[0] = ROHC_RFC5225_RTP_PT_0_CRC7_DISC | ((msn >> 1) & 0x0f);
+			hdr[1] = ((msn & 0x01) << 7) | crc;
+			hdr_len = 2;
+			rfc5225_ctxt->tmp.msn_bits_nr = 5;
+			break;
+		case ROHC_PACKET_PT_1_SEQ_ID:
+			hdr[0] = ROHC_RFC5225_RTP_PT_1_SEQ_ID_DISC | (ip_id_offset & 0x0f);
+			hdr[1] = (crc << 5) | (msn & 0x1f);
+			hdr_len = 2;
+			rfc5225_ctxt->tmp.msn_bits_nr = 5;
+			break;
+		case ROHC_PACKET_PT_1_RND:
+			hdr[0] = ROHC_RFC5225_RTP_PT_1_RND_DISC | (marker << 4) | (msn & 0x0f);
+			hdr[1] = ((ts_scaled & 0x1f) << 3) | crc;
+			hdr_len = 2;
+			rfc5225_ctxt->tmp.msn_bits_nr = 4;
+			break;
+		case ROHC_PACKET_PT_2_RND:
+			hdr[0] = ROHC_RFC5225_RTP_PT_2_RND_DISC | ((msn >> 3) & 0x0f);
+			hdr[1] = ((msn & 0x07) << 5) | (ts_scaled & 0x1f);
+			hdr[2] = (marker << 7) | crc;
+			hdr_len = 3;
+			rfc5225_ctxt->tmp.msn_bits_nr = 7;
+			break;
+		case ROHC_PACKET_PT_2_SEQ_ID:
+			hdr[0] = ROHC_RFC5225_RTP_PT_2_SEQ_ID_DISC | ((ip_id_offset >> 1) & 0x0f);
+			hdr[1] = ((ip_id_offset & 0x01) << 7) | crc;
+			hdr[2] = msn & 0xff;
+			hdr_len = 3;
+			rfc5225_ctxt->tmp.msn_bits_nr = 8;
+			break;
+		case ROHC_PACKET_CO_COMMON:
+		default:
+			assert(packet_type == ROHC_PACKET_CO_COMMON);
+			hdr_len = rohc_comp_rfc5225_build_co_common(context, uncomp_pkt, crc, hdr);
+			hdr_len += c_rfc5225_rtp_build_co_common_rtp(context, rtp, hdr + hdr_len);
+			rfc5225_ctxt->tmp.msn_bits_nr = 8;
+			break;
+	}
+
+	return hdr_len;
+}
+
+
+/**
+ * @brief Build the RTP fields of the co_common header
+ *
+ * The first byte holds the Marker, the TS indicator, the stride and Payload
+ * Type indicators, and the Padding and Extension bits. It is followed by
+ * the TS (8 LSB of the scaled TS or the whole TS), by the TS stride and by
+ * the Payload Type if their indicators are set. While the RTP changes are
+ * repeated, the TS, the stride and the Payload Type are all transmitted.
+ *
+ * @param context  The compression context
+ * @param rtp      The RTP header
+ * @param hdr      OUT: The RTP fields of the co_common header
+ * @return         The length of the RTP fields
+ */
+static size_t c_rfc5225_rtp_build_co_common_rtp(const struct rohc_comp_ctxt *const context,
+                                                const struct rtphdr *const rtp,
+                                                uint8_t *const hdr)
+{
+	const struct rohc_comp_rfc5225_ctxt *const rfc5225_ctxt =
+		context->specific;
+	const struct c_rfc5225_rtp_ctxt *const rtp_ctxt = rfc5225_ctxt->specific;
+	const bool is_rtp_changed = !!(rtp_ctxt->rtp_change_count < MAX_FO_COUNT);
+	rohc_rfc5225_rtp_ts_ind_t ts_ind;
+	size_t hdr_len = 0;
+
+	if(is_rtp_changed)
+	{
+		ts_ind = ROHC_RFC5225_RTP_TS_FULL;
+	}
+	else if(rtp_ctxt->tmp.is_ts_deducible)
+	{
+		ts_ind = ROHC_RFC5225_RTP_TS_DEDUCED;
+	}
+	else if(rtp_ctxt->ts_stride != 0 && rtp_ctxt->tmp.ts_scaled_k <= 8)
+	{
+		ts_ind = ROHC_RFC5225_RTP_TS_SCALED;
+	}
+	else
+	{
+		ts_ind = ROHC_RFC5225_RTP_TS_FULL;
+	}
+	rohc_comp_debug(context, "co_common: TS indicator %d, RTP changes %s",
+	                ts_ind, is_rtp_changed ? "repeated" : "not repeated");
+
+	hdr[hdr_len++] = ((rtp_ctxt->tmp.marker ? 1 : 0) << 7) |
+	                 ((ts_ind & 0x03) << 5) |
+	                 ((is_rtp_changed ? 1 : 0) << 4) |
+	                 ((is_rtp_changed ? 1 : 0) << 3) |
+	                 (rtp->padding << 2) |
+	                 (rtp->extension << 1);
+	if(ts_ind == ROHC_RFC5225_RTP_TS_SCALED)
+	{
+		hdr[hdr_len++] = rtp_ctxt->tmp.ts_scaled & 0xff;
+	}
+	else if(ts_ind == ROHC_RFC5225_RTP_TS_FULL)
+	{
+		memcpy(hdr + hdr_len, &rtp->timestamp, sizeof(uint32_t));
+		hdr_len += sizeof(uint32_t);
+	}
+	if(is_rtp_changed)
+	{
+		const uint32_t ts_stride = rohc_hton32(rtp_ctxt->ts_stride);
+
+		memcpy(hdr + hdr_len, &ts_stride, sizeof(uint32_t));
+		hdr_len += sizeof(uint32_t);
+		hdr[hdr_len++] = rtp->pt & 0x7f;
+	}
+
+	return hdr_len;
+}
+
+
+/**
+ * @brief Code the irregular part of the UDP and RTP headers
+ *
+ * The UDP checksum is transmitted if it is used.
+ *
+ * @param context      The compression context
+ * @param next_header  The UDP header followed by the RTP header
+ * @param rohc_data    OUT: The irregular part
+ * @return             The length of the irregular part
+ */
+static size_t c_rfc5225_rtp_code_irreg(const struct rohc_comp_ctxt *const context,
+                                       const uint8_t *const next_header,
+                                       uint8_t *const rohc_data)
+{
+	const struct rohc_comp_rfc5225_ctxt *const rfc5225_ctxt =
+		context->specific;
+	const struct c_rfc5225_rtp_ctxt *const rtp_ctxt = rfc5225_ctxt->specific;
+	const struct udphdr *const udp = (struct udphdr *) next_header;
+
+	if(!rtp_ctxt->is_checksum_used)
+	{
+		return 0;
+	}
+	memcpy(rohc_data, &udp->check, sizeof(uint16_t));
+
+	return sizeof(uint16_t);
+}
+
+
+/**
+ * @brief Update the context with the UDP and RTP headers that were just
+ *        compressed
+ *
+ * @param context      The compression context
+ * @param next_header  The UDP header followed by the RTP header
+ * @param packet_type  The type of the ROHC packet that was built
+ */
+static void c_rfc5225_rtp_update_ctxt(struct rohc_comp_ctxt *const context,
+                                      const uint8_t *const next_header,
+                                      const rohc_packet_t packet_type)
+{
+	struct rohc_comp_rfc5225_ctxt *const rfc5225_ctxt = context->specific;
+	struct c_rfc5225_rtp_ctxt *const rtp_ctxt = rfc5225_ctxt->specific;
+	const struct udphdr *const udp = (struct udphdr *) next_header;
+	const struct rtphdr *const rtp = (struct rtphdr *) (udp + 1);
+
+	if(packet_type == ROHC_PACKET_IR)
+	{
+		rtp_ctxt->is_checksum_used = !!(udp->check != 0);
+	}
+
+	/* the RTP changes were transmitted once more */
+	if((packet_type == ROHC_PACKET_IR || packet_type == ROHC_PACKET_CO_COMMON) &&
+	   rtp_ctxt->rtp_change_count < MAX_FO_COUNT)
+	{
+		rtp_ctxt->rtp_change_count++;
+	}
+
+	rtp_ctxt->pt = rtp->pt;
+	rtp_ctxt->padding = rtp->padding;
+	rtp_ctxt->extension = rtp->extension;
+	rtp_ctxt->msn = rfc5225_ctxt->msn;
+	rtp_ctxt->ts = rtp_ctxt->tmp.ts;
+	if(rtp_ctxt->ts_stride != 0)
+	{
+		c_add_wlsb(&rtp_ctxt->ts_scaled_wlsb, rfc5225_ctxt->msn,
+		           rtp_ctxt->tmp.ts_scaled);
+		c_add_wlsb(&rtp_ctxt->ts_scaled_offset_wlsb, rfc5225_ctxt->msn,
+		           rtp_ctxt->tmp.ts_scaled_offset);
+	}
+}
+
+
+/**
+ * @brief Define the compression part of the ROHCv2 IP/UDP/RTP profile as
+ *        described in the RFC 5225
+ */
+const struct rohc_comp_profile c_rfc5225_rtp_profile =
+{
+	.id             = ROHCv2_PROFILE_IP_UDP_RTP, /* profile ID (RFC5225) */
+	.protocol       = ROHC_IPPROTO_UDP,          /* IP protocol */
+	.create         = c_rfc5225_rtp_create,      /* profile handlers */
+	.destroy        = rohc_comp_rfc5225_destroy,
+	.check_profile  = c_rfc5225_rtp_check_profile,
+	.check_context  = c_rfc5225_rtp_check_context,
+	.encode         = rohc_comp_rfc5225_encode,
+	.reinit_context = rohc_comp_reinit_context,
+	.feedback       = rohc_comp_rfc5225_feedback,
+	.get_msn        = rohc_comp_rfc5225_get_msn,
+	.set_next_msn   = rohc_comp_rfc5225_set_next_msn,
+};
@@ -0,0 +1,406 @@
+/*
+ * Copyright 2026 Didier Barvaux
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/**
+ * @file   c_rfc5225_udp.c
+ * @brief  ROHC compression context for the ROHCv2 IP/UDP profile
+ * @author Didier Barvaux <didier@barvaux.org>
+ *
+ * The profile compresses the IP headers as the ROHCv2 IP-only profile does,
+ * and the UDP header that follows them (RFC5225 §6.8.2.5). The UDP Length is
+ * inferred from the IP headers, the UDP checksum is sent in every packet
+ * unless it is zero.
+ */
+
+#include "rohc_comp_rfc5225.h"
+#include "rohc_traces_internal.h"
+#include "rohc_utils.h"
+#include "protocols/ip_numbers.h"
+#include "protocols/udp.h"
+
+#ifndef __KERNEL__
+#  include <string.h>
+#endif
+
+
+/*
+ * Private structures and types
+ */
+
+/**
+ * @brief The UDP part of the ROHCv2 IP/UDP compression context
+ *
+ * This object must be used with the generic part of the compression
+ * context rohc_comp_rfc5225_ctxt.
+ *
+ * @see rohc_comp_rfc5225_ctxt
+ */
+struct c_rfc5225_udp_ctxt
+{
+	uint16_t sport;         /**< The UDP source port (network byte order) */
+	uint16_t dport;         /**< The UDP destination port (network byte order) */
+	bool is_checksum_used;  /**< Whether the UDP checksum is non-zero */
+};
+
+
+/*
+ * Prototypes of private functions
+ */
+
+static bool c_rfc5225_udp_create(struct rohc_comp_ctxt *const context,
+                                 const struct net_pkt *const packet)
+	__attribute__((warn_unused_result, nonnull(1, 2)));
+
+static bool c_rfc5225_udp_check_profile(const struct rohc_comp *const comp,
+                                        const struct net_pkt *const packet)
+	__attribute__((warn_unused_result, nonnull(1, 2)));
+
+static bool c_rfc5225_udp_check_context(const struct rohc_comp_ctxt *const context,
+                                        const struct net_pkt *const packet)
+	__attribute__((warn_unused_result, nonnull(1, 2)));
+
+static void c_rfc5225_udp_detect_changes(struct rohc_comp_ctxt *const context,
+                                         const uint8_t *const next_header)
+	__attribute__((nonnull(1, 2)));
+
+static int c_rfc5225_udp_code_static(const struct rohc_comp_ctxt *const context,
+                                     const uint8_t *const next_header,
+                                     uint8_t *const rohc_data,
+                                     const size_t rohc_max_len)
+	__attribute__((warn_unused_result, nonnull(1, 2, 3)));
+
+static int c_rfc5225_udp_code_dyn(const struct rohc_comp_ctxt *const context,
+                                  const uint8_t *const next_header,
+                                  uint8_t *const rohc_data,
+                                  const size_t rohc_max_len)
+	__attribute__((warn_unused_result, nonnull(1, 2, 3)));
+
+static size_t c_rfc5225_udp_code_irreg(const struct rohc_comp_ctxt *const context,
+                                       const uint8_t *const next_header,
+                                       uint8_t *const rohc_data)
+	__attribute__((warn_unused_result, nonnull(1, 2, 3)));
+
+static void c_rfc5225_udp_update_ctxt(struct rohc_comp_ctxt *const context,
+                                      const uint8_t *const next_header,
+                                      const rohc_packet_t packet_type)
+	__attribute__((nonnull(1, 2)));
+
+
+/*
+ * Definitions of functions
+ */
+
+
+/**
+ * @brief Create a new ROHCv2 IP/UDP context and initialize it thanks to
+ *        the given IP/UDP packet
+ *
+ * @param context  The compression context
+ * @param packet   The IP/UDP packet given to initialize the new context
+ * @return         true if successful, false otherwise
+ */
+static bool c_rfc5225_udp_create(struct rohc_comp_ctxt *const context,
+                                 const struct net_pkt *const packet)
+{
+	const struct udphdr *const udp = (struct udphdr *) packet->transport->data;
+	struct rohc_comp_rfc5225_ctxt *rfc5225_ctxt;
+	struct c_rfc5225_udp_ctxt *udp_ctxt;
+
+	if(!rohc_comp_rfc5225_create(context, sizeof(struct c_rfc5225_udp_ctxt),
+	                             packet))
+	{
+		goto error;
+	}
+	rfc5225_ctxt = context->specific;
+	udp_ctxt = rfc5225_ctxt->specific;
+
+	udp_ctxt->sport = udp->source;
+	udp_ctxt->dport = udp->dest;
+	udp_ctxt->is_checksum_used = !!(udp->check != 0);
+
+	rfc5225_ctxt->next_header_len = sizeof(struct udphdr);
+	rfc5225_ctxt->detect_next_hdr_changes = c_rfc5225_udp_detect_changes;
+	rfc5225_ctxt->code_static_next_hdr = c_rfc5225_udp_code_static;
+	rfc5225_ctxt->code_dyn_next_hdr = c_rfc5225_udp_code_dyn;
+	rfc5225_ctxt->code_irreg_next_hdr = c_rfc5225_udp_code_irreg;
+	rfc5225_ctxt->update_next_hdr_ctxt = c_rfc5225_udp_update_ctxt;
+
+	return true;
+
+error:
+	return false;
+}
+
+
+/**
+ * @brief Check if the given packet corresponds to the ROHCv2 IP/UDP profile
+ *
+ * Conditions are:
+ *  \li the IP headers are accepted by the ROHCv2 profiles,
+ *  \li the transport protocol is UDP,
+ *  \li the IP payload is large enough for the UDP header,
+ *  \li the UDP Length field and the IP payload match.
+ *
+ * @see rohc_comp_rfc5225_check_profile
+ *
+ * @param comp    The ROHC compressor
+ * @param packet  The packet to check
+ * @return        Whether the IP packet corresponds to the profile:
+ *                  \li true if the IP packet corresponds to the profile,
+ *                  \li false if the IP packet does not correspond to
+ *                      the profile
+ */
+static bool c_rfc5225_udp_check_profile(const struct rohc_comp *const comp,
+                                        const struct net_pkt *const packet)
+{
+	const struct udphdr *udp;
+
+	if(!rohc_comp_rfc5225_check_profile(comp, packet))
+	{
+		goto bad_profile;
+	}
+
+	/* check that the transport protocol is UDP */
+	if(packet->transport->data == NULL ||
+	   packet->transport->proto != ROHC_IPPROTO_UDP ||
+	   packet->transport->len < sizeof(struct udphdr))
+	{
+		goto bad_profile;
+	}
+
+	/* the UDP Length is not transmitted, it shall match the IP payload */
+	udp = (const struct udphdr *) packet->transport->data;
+	if(packet->transport->len != rohc_ntoh16(udp->len))
+	{
+		goto bad_profile;
+	}
+
+	return true;
+
+bad_profile:
+	return false;
+}
+
+
+/**
+ * @brief Check if the IP/UDP packet belongs to the ROHCv2 IP/UDP context
+ *
+ * Conditions are:
+ *  - the IP headers belong to the context, see
+ *    \ref rohc_comp_rfc5225_check_context,
+ *  - the UDP ports must be the same as in context.
+ *
+ * @param context  The compression context
+ * @param packet   The IP/UDP packet to check
+ * @return         true if the IP/UDP packet belongs to the context,
+ *                 false if it does not belong to the context
+ */
+static bool c_rfc5225_udp_check_context(const struct rohc_comp_ctxt *const context,
+                                        const struct net_pkt *const packet)
+{
+	const struct rohc_comp_rfc5225_ctxt *const rfc5225_ctxt =
+		context->specific;
+	const struct c_rfc5225_udp_ctxt *const udp_ctxt = rfc5225_ctxt->specific;
+	const struct udphdr *const udp = (struct udphdr *) packet->transport->data;
+
+	if(!rohc_comp_rfc5225_check_context(context, packet))
+	{
+		goto bad_context;
+	}
+
+	if(udp->source != udp_ctxt->sport || udp->dest != udp_ctxt->dport)
+	{
+		rohc_comp_debug(context, "  not same UDP ports");
+		goto bad_context;
+	}
+
+	return true;
+
+bad_context:
+	return false;
+}
+
+
+/**
+ * @brief Detect the changes of the UDP header
+ *
+ * Whether the UDP checksum is used or not is transmitted in the IR packet
+ * only.
+ *
+ * @param context      The compression context
+ * @param next_header  The UDP header
+ */
+static void c_rfc5225_udp_detect_changes(struct rohc_comp_ctxt *const context,
+                                         const uint8_t *const next_header)
+{
+	struct rohc_comp_rfc5225_ctxt *const rfc5225_ctxt = context->specific;
+	const struct c_rfc5225_udp_ctxt *const udp_ctxt = rfc5225_ctxt->specific;
+	const struct udphdr *const udp = (struct udphdr *) next_header;
+
+	if((udp->check != 0) != udp_ctxt->is_checksum_used)
+	{
+		rohc_comp_debug(context, "UDP checksum is now %s",
+		                udp->check != 0 ? "used" : "unused");
+		rfc5225_ctxt->tmp.ir_needed = true;
+	}
+}
+
+
+/**
+ * @brief Code the static part of the UDP header (RFC5225 §6.8.2.5)
+ *
+ * @param context       The compression context
+ * @param next_header   The UDP header
+ * @param rohc_data     OUT: The ROHC packet
+ * @param rohc_max_len  The maximum length of the ROHC packet
+ * @return              The length of the static part if successful,
+ *                      -1 otherwise
+ */
+static int c_rfc5225_udp_code_static(const struct rohc_comp_ctxt *const context,
+                                     const uint8_t *const next_header,
+                                     uint8_t *const rohc_data,
+                                     const size_t rohc_max_len)
+{
+	const struct udphdr *const udp = (struct udphdr *) next_header;
+
+	if(rohc_max_len < 4)
+	{
+		rohc_comp_warn(context, "ROHC buffer too small for the UDP static part: "
+		               "4 bytes required, but only %zu bytes available",
+		               rohc_max_len);
+		goto error;
+	}
+	memcpy(rohc_data, &udp->source, sizeof(uint16_t));
+	memcpy(rohc_data + 2, &udp->dest, sizeof(uint16_t));
+
+	return 4;
+
+error:
+	return -1;
+}
+
+
+/**
+ * @brief Code the dynamic part of the UDP header (RFC5225 §6.8.2.5)
+ *
+ * The dynamic part carries the UDP checksum, the MSN and the reordering
+ * ratio.
+ *
+ * @param context       The compression context
+ * @param next_header   The UDP header
+ * @param rohc_data     OUT: The ROHC packet
+ * @param rohc_max_len  The maximum length of the ROHC packet
+ * @return              The length of the dynamic part if successful,
+ *                      -1 otherwise
+ */
+static int c_rfc5225_udp_code_dyn(const struct rohc_comp_ctxt *const context,
+                                  const uint8_t *const next_header,
+                                  uint8_t *const rohc_data,
+                                  const size_t rohc_max_len)
+{
+	const struct rohc_comp_rfc5225_ctxt *const rfc5225_ctxt =
+		context->specific;
+	const struct udphdr *const udp = (struct udphdr *) next_header;
+
+	if(rohc_max_len < 5)
+	{
+		rohc_comp_warn(context, "ROHC buffer too small for the UDP dynamic "
+		               "part: 5 bytes required, but only %zu bytes available",
+		               rohc_max_len);
+		goto error;
+	}
+	memcpy(rohc_data, &udp->check, sizeof(uint16_t));
+	rohc_data[2] = (rfc5225_ctxt->msn >> 8) & 0xff;
+	rohc_data[3] = rfc5225_ctxt->msn & 0xff;
+	rohc_data[4] = rfc5225_ctxt->reorder_ratio & 0x03;
+
+	return 5;
+
+error:
+	return -1;
+}
+
+
+/**
+ * @brief Code the irregular part of the UDP header (RFC5225 §6.8.2.5)
+ *
+ * @param context      The compression context
+ * @param next_header  The UDP header
+ * @param rohc_data    OUT: The irregular part
+ * @return             The length of the irregular part
+ */
+static size_t c_rfc5225_udp_code_irreg(const struct rohc_comp_ctxt *const context,
+                                       const uint8_t *const next_header,
+                                       uint8_t *const rohc_data)
+{
+	const struct rohc_comp_rfc5225_ctxt *const rfc5225_ctxt =
+		context->specific;
+	const struct c_rfc5225_udp_ctxt *const udp_ctxt = rfc5225_ctxt->specific;
+	const struct udphdr *const udp = (struct udphdr *) next_header;
+
+	if(!udp_ctxt->is_checksum_used)
+	{
+		return 0;
+	}
+	memcpy(rohc_data, &udp->check, sizeof(uint16_t));
+
+	return sizeof(uint16_t);
+}
+
+
+/**
+ * @brief Update the context with the UDP header that was just compressed
+ *
+ * @param context      The compression context
+ * @param next_header  The UDP header
+ * @param packet_type  The type of the ROHC packet that was built
+ */
+static void c_rfc5225_udp_update_ctxt(struct rohc_comp_ctxt *const context,
+                                      const uint8_t *const next_header,
+                                      const rohc_packet_t packet_type)
+{
+	struct rohc_comp_rfc5225_ctxt *const rfc5225_ctxt = context->specific;
+	struct c_rfc5225_udp_ctxt *const udp_ctxt = rfc5225_ctxt->specific;
+	const struct udphdr *const udp = (struct udphdr *) next_header;
+
+	if(packet_type == ROHC_PACKET_IR)
+	{
+		udp_ctxt->is_checksum_used = !!(udp->check != 0);
+	}
+}
+
+
+/**
+ * @brief Define the compression part of the ROHCv2 IP/UDP profile as
+ *        described in the RFC 5225
+ */
+const struct rohc_comp_profile c_rfc5225_udp_profile =
+{
+	.id             = ROHCv2_PROFILE_IP_UDP, /* profile ID (RFC5225) */
+	.protocol       = ROHC_IPPROTO_UDP,      /* IP protocol */
+	.create         = c_rfc5225_udp_create,  /* profile handlers */
+	.destroy        = rohc_comp_rfc5225_destroy,
+	.check_profile  = c_rfc5225_udp_check_profile,
+	.check_context  = c_rfc5225_udp_check_context,
+	.encode         = rohc_comp_rfc5225_encode,
+	.reinit_context = rohc_comp_reinit_context,
+	.feedback       = rohc_comp_rfc5225_feedback,
+	.get_msn        = rohc_comp_rfc5225_get_msn,
+	.set_next_msn   = rohc_comp_rfc5225_set_next_msn,
+};
+
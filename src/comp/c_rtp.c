@@ -54,13 +54,16 @@
 static bool c_rtp_create(struct rohc_comp_ctxt *const context,
                          const struct net_pkt *const packet)
 	__attribute__((warn_unused_result, nonnull(1, 2)));
-static void c_rtp_destroy(struct rohc_comp_ctxt *const context)
-	__attribute__((nonnull(1)));
 
 static bool c_rtp_check_profile(const struct rohc_comp *const comp,
                                 const struct net_pkt *const packet)
 	__attribute__((warn_unused_result, nonnull(1, 2)));
 
+static bool c_rtp_is_on_rtp_port(const struct rohc_comp *const comp,
+                                 const struct udphdr *const udp,
+                                 const struct rtphdr *const rtp)
+	__attribute__((warn_unused_result, nonnull(1, 2, 3), pure));
+
 static bool c_rtp_check_context(const struct rohc_comp_ctxt *const context,
                                 const struct net_pkt *const packet)
 	__attribute__((warn_unused_result, nonnull(1, 2), pure));
@@ -74,6 +77,8 @@ static int c_rtp_encode(struct rohc_comp_ctxt *const context,
 	__attribute__((warn_unused_result, nonnull(1, 2, 3, 5, 6)));
 
 static void rtp_decide_state(struct rohc_comp_ctxt *const context);
+static bool rtp_is_next_header_steady(const struct rohc_comp_ctxt *const context)
+	__attribute__((warn_unused_result, nonnull(1)));
 
 static rohc_packet_t c_rtp_decide_FO_packet(const struct rohc_comp_ctxt *context);
 static rohc_packet_t c_rtp_decide_SO_packet(const struct rohc_comp_ctxt *context);
@@ -128,7 +133,8 @@ static bool c_rtp_create(struct rohc_comp_ctxt *const context,
 	assert(context->profile != NULL);
 
 	/* create and initialize the generic part of the profile context */
-	if(!rohc_comp_rfc3095_create(context, ROHC_LSB_SHIFT_RTP_SN, packet))
+	if(!rohc_comp_rfc3095_create(context, ROHC_LSB_SHIFT_RTP_SN,
+	                             sizeof(struct sc_rtp_context), packet))
 	{
 		rohc_comp_warn(context, "generic context creation failed");
 		goto quit;
@@ -147,15 +153,9 @@ static bool c_rtp_create(struct rohc_comp_ctxt *const context,
 	rohc_comp_debug(context, "initialize context(SN) = hdr(SN) of first "
 	                "packet = %u", rfc3095_ctxt->sn);
 
-	/* create the RTP part of the profile context */
-	rtp_context = malloc(sizeof(struct sc_rtp_context));
-	if(rtp_context == NULL)
-	{
-		rohc_error(context->compressor, ROHC_TRACE_COMP, context->profile->id,
-		           "no memory for the RTP part of the profile context");
-		goto clean;
-	}
-	rfc3095_ctxt->specific = rtp_context;
+	/* the RTP part of the profile context was allocated along with the
+	 * generic part */
+	rtp_context = (struct sc_rtp_context *) rfc3095_ctxt->specific;
 
 	/* initialize the RTP part of the profile context */
 	rtp_context->udp_checksum_change_count = 0;
@@ -168,7 +168,9 @@ static bool c_rtp_create(struct rohc_comp_ctxt *const context,
 	if(!c_create_sc(&rtp_context->ts_sc,
 	                context->compressor->wlsb_window_width,
 	                context->compressor->trace_callback,
-	                context->compressor->trace_callback_priv))
+	                context->compressor->trace_callback_priv,
+	                context->compressor->trace_level,
+	                context->compressor->trace_pkt_level))
 	{
 		rohc_comp_warn(context, "cannot create scaled RTP Timestamp encoding");
 		goto clean;
@@ -190,6 +192,7 @@ static bool c_rtp_create(struct rohc_comp_ctxt *const context,
 	rfc3095_ctxt->next_header_len = sizeof(struct udphdr) + sizeof(struct rtphdr);
 	rfc3095_ctxt->encode_uncomp_fields = rtp_encode_uncomp_fields;
 	rfc3095_ctxt->decide_state = rtp_decide_state;
+	rfc3095_ctxt->is_next_header_steady = rtp_is_next_header_steady;
 	rfc3095_ctxt->decide_FO_packet = c_rtp_decide_FO_packet;
 	rfc3095_ctxt->decide_SO_packet = c_rtp_decide_SO_packet;
 	rfc3095_ctxt->decide_extension = c_rtp_decide_extension;
@@ -212,30 +215,6 @@ quit:
 }
 
 
-/**
- * @brief Destroy the RTP context.
- *
- * This function is one of the functions that must exist in one profile for the
- * framework to work.
- *
- * @param context The RTP compression context to destroy
- */
-static void c_rtp_destroy(struct rohc_comp_ctxt *const context)
-{
-	struct rohc_comp_rfc3095_ctxt *rfc3095_ctxt;
-	struct sc_rtp_context *rtp_context;
-
-	assert(context != NULL);
-	assert(context->specific != NULL);
-	rfc3095_ctxt = (struct rohc_comp_rfc3095_ctxt *) context->specific;
-	assert(rfc3095_ctxt->specific != NULL);
-	rtp_context = (struct sc_rtp_context *) rfc3095_ctxt->specific;
-
-	c_destroy_sc(&rtp_context->ts_sc);
-	rohc_comp_rfc3095_destroy(context);
-}
-
-
 /**
  * @brief Check if the given packet corresponds to the RTP profile
  *
@@ -250,8 +229,10 @@ static void c_rtp_destroy(struct rohc_comp_ctxt *const context)
  *  \li the inner IP payload is at least 8-byte long for UDP header
  *  \li the UDP Length field and the UDP payload match
  *  \li the UDP payload is at least 12-byte long for RTP header
- *  \li the UDP ports are in the list of RTP ports or the user-defined RTP
- *      callback function detected one RTP packet
+ *  \li one of the UDP ports is in the list of RTP ports and the UDP payload
+ *      looks like a RTP header with an accepted Payload Type, or the
+ *      user-defined RTP callback function detected one RTP packet
+ *  \li the RTP header does not contain any CSRC item
  *
  * @see c_udp_check_profile
  *
@@ -271,6 +252,7 @@ static bool c_rtp_check_profile(const struct rohc_comp *const comp,
 	const struct udphdr *udp_header;
 	const uint8_t *udp_payload;
 	unsigned int udp_payload_size;
+	const struct rtphdr *rtp;
 	bool udp_check;
 
 	/* check that:
@@ -299,11 +281,17 @@ static bool c_rtp_check_profile(const struct rohc_comp *const comp,
 		goto bad_profile;
 	}
 
+	rtp = (const struct rtphdr *) udp_payload;
+
 	/* check if the IP/UDP packet is a RTP packet */
-	if(comp->rtp_callback != NULL)
+	if(c_rtp_is_on_rtp_port(comp, udp_header, rtp))
+	{
+		/* the built-in detection does not call the application */
+		rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		           "RTP packet detected on the RTP ports");
+	}
+	else if(comp->rtp_callback != NULL)
 	{
-		const struct rtphdr *rtp;
-
 		/* check if the IP/UDP packet is a RTP packet with the user callback
 		   dedicated to RTP stream detection: if the RTP callback returns 1,
 		   consider that the packet matches the RTP profile */
@@ -332,22 +320,21 @@ static bool c_rtp_check_profile(const struct rohc_comp *const comp,
 
 		rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
 		           "RTP packet detected by the RTP callback");
-
-		/* RTP packets with one or more CSRC items cannot be compressed by the
-		 * RTP profile for the moment */
-		rtp = (struct rtphdr *) udp_payload;
-		if(rtp->cc != 0)
-		{
-			rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-			           "compression of CSRC items is not supported yet by RTP profile");
-			goto bad_profile;
-		}
 	}
 	else
 	{
-		/* no callback for advanced RTP stream detection and no UDP
-		   destination port reserved for RTP traffic, so the IP/UDP packet will
-		   be compressed with another profile (the IP/UDP one probably) */
+		/* not on the UDP ports reserved for RTP traffic and no callback for
+		   advanced RTP stream detection, so the IP/UDP packet will be
+		   compressed with another profile (the IP/UDP one probably) */
+		goto bad_profile;
+	}
+
+	/* RTP packets with one or more CSRC items cannot be compressed by the
+	 * RTP profile for the moment */
+	if(rtp->cc != 0)
+	{
+		rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		           "compression of CSRC items is not supported yet by RTP profile");
 		goto bad_profile;
 	}
 
@@ -358,6 +345,36 @@ bad_profile:
 }
 
 
+/**
+ * @brief Whether the UDP packet is a RTP packet on the RTP ports
+ *
+ * The built-in detection of RTP streams: one of the UDP ports is dedicated to
+ * RTP streams, and the UDP payload looks like a RTP header with version 2 and
+ * an accepted Payload Type.
+ *
+ * @param comp  The ROHC compressor
+ * @param udp   The UDP header
+ * @param rtp   The RTP header candidate, at least 12-byte long
+ * @return      true if the UDP packet is a RTP packet, false otherwise
+ */
+static bool c_rtp_is_on_rtp_port(const struct rohc_comp *const comp,
+                                 const struct udphdr *const udp,
+                                 const struct rtphdr *const rtp)
+{
+	if(comp->rtp_ports_nr == 0)
+	{
+		return false;
+	}
+	if(!rohc_bitmap_test(comp->rtp_ports, rohc_ntoh16(udp->source)) &&
+	   !rohc_bitmap_test(comp->rtp_ports, rohc_ntoh16(udp->dest)))
+	{
+		return false;
+	}
+
+	return (rtp->version == 2 && rohc_bitmap_test(comp->rtp_pts, rtp->pt));
+}
+
+
 /**
  * @brief Check if the IP/UDP/RTP packet belongs to the context
  *
@@ -398,15 +415,16 @@ static bool c_rtp_check_context(const struct rohc_comp_ctxt *const context,
 	const struct rtphdr *const rtp = (struct rtphdr *) (udp + 1);
 	bool udp_check;
 
-	/* check IP and UDP headers */
-	udp_check = c_udp_check_context(context, packet);
-	if(!udp_check)
+	/* check the RTP SSRC field first: the RTP streams multiplexed between the
+	 * same IP addresses and UDP ports differ by their SSRC only */
+	if(rtp_context->old_rtp.ssrc != rtp->ssrc)
 	{
 		goto bad_context;
 	}
 
-	/* check the RTP SSRC field */
-	if(rtp_context->old_rtp.ssrc != rtp->ssrc)
+	/* check IP and UDP headers */
+	udp_check = c_udp_check_context(context, packet);
+	if(!udp_check)
 	{
 		goto bad_context;
 	}
@@ -937,12 +955,35 @@ static void rtp_decide_state(struct rohc_comp_ctxt *const context)
 	if(context->state == ROHC_COMP_STATE_IR &&
 	   rtp_context->ts_sc.state > INIT_STRIDE)
 	{
-		rtp_context->ts_sc.state = INIT_STRIDE;
-		rtp_context->ts_sc.nr_init_stride_packets = 0;
+		c_ts_sc_reinit_stride(&rtp_context->ts_sc);
 	}
 }
 
 
+/**
+ * @brief Whether the UDP/RTP headers only moved along their steady pattern
+ *
+ * The UDP/RTP fields were already compared against the context, none of them
+ * shall have changed in the current or in the last few packets. TS shall be
+ * sent scaled.
+ *
+ * @param context  The compression context
+ * @return         true if the UDP/RTP headers did not change the state,
+ *                 false otherwise
+ */
+static bool rtp_is_next_header_steady(const struct rohc_comp_ctxt *const context)
+{
+	const struct rohc_comp_rfc3095_ctxt *const rfc3095_ctxt =
+		(struct rohc_comp_rfc3095_ctxt *) context->specific;
+	const struct sc_rtp_context *const rtp_context =
+		(struct sc_rtp_context *) rfc3095_ctxt->specific;
+
+	return (rtp_context->tmp.send_rtp_dynamic == 0 &&
+	        !rtp_context->tmp.is_marker_bit_set &&
+	        rtp_context->ts_sc.state == SEND_SCALED);
+}
+
+
 /**
  * @brief Determine the SN value for the next packet
  *
@@ -1026,9 +1067,9 @@ static bool rtp_encode_uncomp_fields(struct rohc_comp_ctxt *const context,
 		               &rtp_context->tmp.nr_ts_bits_less_equal_than_2,
 		               &rtp_context->tmp.nr_ts_bits_more_than_2);
 
-		/* save the new unscaled and TS_SCALED values */
+		/* save the new TS_SCALED value, the unscaled value is computed back
+		 * from it when leaving state SEND_SCALED */
 		assert(rfc3095_ctxt->sn <= 0xffff);
-		add_unscaled(&rtp_context->ts_sc, rfc3095_ctxt->sn);
 		add_scaled(&rtp_context->ts_sc, rfc3095_ctxt->sn);
 		rohc_comp_debug(context, "TS_SCALED = %u on %zu/2 bits or %zu/32 bits",
 		                rtp_context->tmp.ts_send,
@@ -1479,11 +1520,13 @@ const struct rohc_comp_profile c_rtp_profile =
 	.id             = ROHC_PROFILE_RTP, /* profile ID */
 	.protocol       = ROHC_IPPROTO_UDP, /* IP protocol */
 	.create         = c_rtp_create,     /* profile handlers */
-	.destroy        = c_rtp_destroy,
+	.destroy        = rohc_comp_rfc3095_destroy,
 	.check_profile  = c_rtp_check_profile,
 	.check_context  = c_rtp_check_context,
 	.encode         = c_rtp_encode,
 	.reinit_context = rohc_comp_reinit_context,
 	.feedback       = rohc_comp_rfc3095_feedback,
+	.get_msn        = rohc_comp_rfc3095_get_msn,
+	.set_next_msn   = rohc_comp_rfc3095_set_next_msn,
 };
 
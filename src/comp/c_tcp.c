@@ -55,10 +55,143 @@
 #include "config.h" /* for WORDS_BIGENDIAN */
 
 
+/** The max length of the static chain cached in every TCP context, enough
+ *  for two IPv6 headers with a few extension headers */
+#define TCP_STATIC_CHAIN_CACHE_MAX_LEN  128U
+
 #define TRACE_GOTO_CHOICE \
 	rohc_comp_debug(context, "Compressed format choice LINE %d", __LINE__ )
 
 
+/*
+ * The fields that may change from one packet to another, they are recorded
+ * in one bitmask so that the packet decision tests several of them at once
+ */
+
+/** The static part of at least one IPv6 extension header changed */
+#define TCP_FIELD_IPV6_EXTS_STATIC  (1U << 0)
+/** The dynamic part of at least one IPv6 extension header changed */
+#define TCP_FIELD_IPV6_EXTS_DYN     (1U << 1)
+/** At least one outer IPv4 TTL or IPv6 Hop Limit changed */
+#define TCP_FIELD_OUTER_TTL_HOPL    (1U << 2)
+/** The behavior of the innermost IP-ID changed */
+#define TCP_FIELD_IP_ID_BEHAVIOR    (1U << 3)
+/** The DF flag of the innermost IPv4 header changed */
+#define TCP_FIELD_IP_DF             (1U << 4)
+/** The DSCP of the innermost IP header changed */
+#define TCP_FIELD_DSCP              (1U << 5)
+/** The innermost IPv4 TTL or IPv6 Hop Limit changed recently */
+#define TCP_FIELD_TTL_HOPL          (1U << 6)
+/** The ecn_used flag changed recently */
+#define TCP_FIELD_ECN_USED          (1U << 7)
+/** The TCP ACK flag changed */
+#define TCP_FIELD_ACK_FLAG          (1U << 8)
+/** The TCP URG flag is set */
+#define TCP_FIELD_URG_FLAG_SET      (1U << 9)
+/** The TCP URG flag changed */
+#define TCP_FIELD_URG_FLAG          (1U << 10)
+/** The TCP Urgent Pointer changed */
+#define TCP_FIELD_URG_PTR           (1U << 11)
+/** The TCP ACK stride is not static yet */
+#define TCP_FIELD_ACK_STRIDE        (1U << 12)
+/** The TCP window changed recently */
+#define TCP_FIELD_WINDOW            (1U << 13)
+/** The TCP sequence number changed */
+#define TCP_FIELD_SEQ_NUM           (1U << 14)
+/** The TCP ACK number changed */
+#define TCP_FIELD_ACK_NUM           (1U << 15)
+
+/** The changes that only the co_common packet can transmit */
+#define TCP_FIELDS_CO_COMMON \
+	(TCP_FIELD_OUTER_TTL_HOPL | TCP_FIELD_IP_ID_BEHAVIOR | TCP_FIELD_IP_DF | \
+	 TCP_FIELD_DSCP | TCP_FIELD_ACK_FLAG | TCP_FIELD_URG_FLAG_SET | \
+	 TCP_FIELD_URG_FLAG | TCP_FIELD_URG_PTR | TCP_FIELD_ACK_STRIDE)
+/** The changes that require a packet with a 7-bit CRC */
+#define TCP_FIELDS_CRC7 \
+	(TCP_FIELD_TTL_HOPL | TCP_FIELD_ECN_USED)
+
+
+/*
+ * The decision tables for the seq_X and rnd_X compressed formats: every
+ * format is one bit, the bits are ordered by preference so that the lowest
+ * bit set among the allowed and possible formats is the chosen one
+ */
+
+#define TCP_CO_SEQ_2          (1U << 0)
+#define TCP_CO_SEQ_1          (1U << 1)
+#define TCP_CO_SEQ_4          (1U << 2)
+#define TCP_CO_SEQ_3          (1U << 3)
+#define TCP_CO_SEQ_6          (1U << 4)
+#define TCP_CO_SEQ_5          (1U << 5)
+#define TCP_CO_SEQ_7          (1U << 6)
+#define TCP_CO_SEQ_8          (1U << 7)
+/** seq_8 without the check of the innermost TTL/Hop Limit */
+#define TCP_CO_SEQ_8_ANY_TTL  (1U << 8)
+#define TCP_CO_RND_2          (1U << 9)
+#define TCP_CO_RND_4          (1U << 10)
+#define TCP_CO_RND_3          (1U << 11)
+#define TCP_CO_RND_1          (1U << 12)
+#define TCP_CO_RND_6          (1U << 13)
+#define TCP_CO_RND_5          (1U << 14)
+#define TCP_CO_RND_7          (1U << 15)
+#define TCP_CO_RND_8          (1U << 16)
+
+/** The formats with a 7-bit CRC (co_common is always possible) */
+#define TCP_CO_CRC7_FORMATS \
+	(TCP_CO_SEQ_8 | TCP_CO_SEQ_8_ANY_TTL | TCP_CO_RND_8)
+
+/** The packet types of the formats, indexed by bit position */
+static const rohc_packet_t tcp_co_format_types[] =
+{
+	ROHC_PACKET_TCP_SEQ_2, ROHC_PACKET_TCP_SEQ_1,
+	ROHC_PACKET_TCP_SEQ_4, ROHC_PACKET_TCP_SEQ_3,
+	ROHC_PACKET_TCP_SEQ_6, ROHC_PACKET_TCP_SEQ_5,
+	ROHC_PACKET_TCP_SEQ_7, ROHC_PACKET_TCP_SEQ_8, ROHC_PACKET_TCP_SEQ_8,
+	ROHC_PACKET_TCP_RND_2, ROHC_PACKET_TCP_RND_4,
+	ROHC_PACKET_TCP_RND_3, ROHC_PACKET_TCP_RND_1,
+	ROHC_PACKET_TCP_RND_6, ROHC_PACKET_TCP_RND_5,
+	ROHC_PACKET_TCP_RND_7, ROHC_PACKET_TCP_RND_8,
+};
+
+/** The kinds of changes that select one row of the decision tables */
+typedef enum
+{
+	/** The RSF flags are set or the structure of the TCP options changed */
+	TCP_CO_CHANGES_LIST    = 0,
+	/** The TCP window changed */
+	TCP_CO_CHANGES_WINDOW  = 1,
+	/** The ACK number did not change (or is not used) */
+	TCP_CO_CHANGES_SEQ     = 2,
+	/** The sequence number did not change */
+	TCP_CO_CHANGES_ACK     = 3,
+	/** The sequence and ACK numbers changed (any change for rnd_X) */
+	TCP_CO_CHANGES_SEQ_ACK = 4,
+	TCP_CO_CHANGES_MAX
+} tcp_co_changes_t;
+
+/** The seq_X formats allowed for every kind of changes */
+static const uint32_t tcp_co_seq_formats[TCP_CO_CHANGES_MAX] =
+{
+	[TCP_CO_CHANGES_LIST]    = TCP_CO_SEQ_8,
+	[TCP_CO_CHANGES_WINDOW]  = TCP_CO_SEQ_7,
+	[TCP_CO_CHANGES_SEQ]     = TCP_CO_SEQ_2 | TCP_CO_SEQ_1 | TCP_CO_SEQ_8_ANY_TTL,
+	[TCP_CO_CHANGES_ACK]     = TCP_CO_SEQ_4 | TCP_CO_SEQ_3 | TCP_CO_SEQ_8_ANY_TTL,
+	[TCP_CO_CHANGES_SEQ_ACK] = TCP_CO_SEQ_6 | TCP_CO_SEQ_5 | TCP_CO_SEQ_8,
+};
+
+/** The rnd_X formats allowed for every kind of changes */
+static const uint32_t tcp_co_rnd_formats[TCP_CO_CHANGES_MAX] =
+{
+	[TCP_CO_CHANGES_LIST]    = TCP_CO_RND_8,
+	[TCP_CO_CHANGES_WINDOW]  = TCP_CO_RND_7,
+	[TCP_CO_CHANGES_SEQ]     = 0, /* not used for rnd_X */
+	[TCP_CO_CHANGES_ACK]     = 0, /* not used for rnd_X */
+	[TCP_CO_CHANGES_SEQ_ACK] = TCP_CO_RND_2 | TCP_CO_RND_4 | TCP_CO_RND_3 |
+	                           TCP_CO_RND_1 | TCP_CO_RND_6 | TCP_CO_RND_5 |
+	                           TCP_CO_RND_8,
+};
+
+
 /**
  * @brief Define the TCP-specific temporary variables in the profile
  *        compression context.
@@ -70,12 +203,10 @@
  */
 struct tcp_tmp_variables
 {
-	/** Whether at least one of the static part of the IPv6 extensions changed
-	 * in the current packet */
-	bool is_ipv6_exts_list_static_changed;
-	/** Whether at least one of the dynamic part of the IPv6 extensions changed
-	 * in the current packet */
-	bool is_ipv6_exts_list_dyn_changed;
+	/** The fields that changed in the current packet, a combination of the
+	 *  TCP_FIELD_* flags */
+	uint32_t changed_fields;
+
 	/** The new number of IP extensions headers (for every IP header) */
 	size_t ip_exts_nr[ROHC_TCP_MAX_IP_HDRS];
 
@@ -85,13 +216,9 @@ struct tcp_tmp_variables
 	/** The minimal number of bits required to encode the MSN value */
 	size_t nr_msn_bits;
 
-	/** Whether the TCP window changed or not */
-	size_t tcp_window_changed;
 	/** The minimal number of bits required to encode the TCP window */
 	size_t nr_window_bits_16383;
 
-	/** Whether the TCP sequence number changed or not */
-	bool tcp_seq_num_changed;
 	/** The minimal number of bits required to encode the TCP sequence number
 	 *  with p = 65535 */
 	size_t nr_seq_bits_65535;
@@ -111,8 +238,6 @@ struct tcp_tmp_variables
 	 *  number */
 	size_t nr_seq_scaled_bits;
 
-	/** Whether the ACK number changed or not */
-	bool tcp_ack_num_changed;
 	/** The minimal number of bits required to encode the TCP ACK number
 	 *  with p = 65535 */
 	size_t nr_ack_bits_65535;
@@ -134,8 +259,6 @@ struct tcp_tmp_variables
 
 	/** The IP-ID / SN delta (with bits swapped if necessary) */
 	uint16_t ip_id_delta;
-	/** Whether the behavior of the IP-ID field changed with current packet */
-	bool ip_id_behavior_changed;
 	/** The minimal number of bits required to encode the innermost IP-ID value
 	 *  with p = 3 */
 	size_t nr_ip_id_bits_3;
@@ -146,27 +269,15 @@ struct tcp_tmp_variables
 	/* innermost IPv4 TTL or IPv6 Hop Limit */
 	uint8_t ttl_hopl;
 	size_t nr_ttl_hopl_bits;
-	bool ttl_hopl_changed;
 	/* outer IPv4 TTLs or IPv6 Hop Limits */
 	int ttl_irreg_chain_flag;
-	bool outer_ip_ttl_changed;
-
-	bool ip_df_changed;
-	bool dscp_changed;
-
-	bool tcp_ack_flag_changed;
-	bool tcp_urg_flag_present;
-	bool tcp_urg_flag_changed;
-
-	/** Whether the ecn_used flag changed or not */
-	bool ecn_used_changed;
 };
 
 
 /**
  * @brief Define the IPv6 generic option context.
  */
-typedef struct __attribute__((packed)) ipv6_generic_option_context
+typedef struct ipv6_generic_option_context
 {
 	size_t option_length;
 	uint8_t next_header;
@@ -178,7 +289,7 @@ typedef struct __attribute__((packed)) ipv6_generic_option_context
 /**
  * @brief Define the common IP header context to IPv4 and IPv6.
  */
-typedef struct __attribute__((packed)) ipvx_context
+typedef struct ipvx_context
 {
 	uint8_t version:4;
 	uint8_t unused:4;
@@ -199,7 +310,7 @@ typedef struct __attribute__((packed)) ipvx_context
 /**
  * @brief Define the IPv4 header context.
  */
-typedef struct __attribute__((packed)) ipv4_context
+typedef struct ipv4_context
 {
 	uint8_t version:4;
 	uint8_t df:1;
@@ -235,7 +346,7 @@ typedef union
 /**
  * @brief Define the IPv6 header context.
  */
-typedef struct __attribute__((packed)) ipv6_context
+typedef struct ipv6_context
 {
 	uint8_t version:4;
 	uint8_t unused:4;
@@ -295,19 +406,19 @@ struct sc_tcp_context
 	uint32_t tcp_last_seq_num;
 
 	uint16_t msn;               /**< The Master Sequence Number (MSN) */
-	struct c_wlsb *msn_wlsb;    /**< The W-LSB decoding context for MSN */
+	struct c_wlsb msn_wlsb;    /**< The W-LSB decoding context for MSN */
 
-	struct c_wlsb *ttl_hopl_wlsb;
+	struct c_wlsb ttl_hopl_wlsb;
 	size_t ttl_hopl_change_count;
 
-	struct c_wlsb *ip_id_wlsb;
+	struct c_wlsb ip_id_wlsb;
 
 // lsb(15, 16383)
-	struct c_wlsb *window_wlsb; /**< The W-LSB decoding context for TCP window */
+	struct c_wlsb window_wlsb; /**< The W-LSB decoding context for TCP window */
 
 	uint32_t seq_num;
-	struct c_wlsb *seq_wlsb;
-	struct c_wlsb *seq_scaled_wlsb;
+	struct c_wlsb seq_wlsb;
+	struct c_wlsb seq_scaled_wlsb;
 
 	uint32_t seq_num_scaled;
 	uint32_t seq_num_residue;
@@ -315,8 +426,8 @@ struct sc_tcp_context
 	size_t seq_num_scaling_nr;
 
 	uint32_t ack_num;
-	struct c_wlsb *ack_wlsb;
-	struct c_wlsb *ack_scaled_wlsb;
+	struct c_wlsb ack_wlsb;
+	struct c_wlsb ack_scaled_wlsb;
 
 	size_t ack_deltas_next;
 	uint16_t ack_deltas_width[20];
@@ -337,6 +448,14 @@ struct sc_tcp_context
 
 	size_t ip_contexts_nr;
 	ip_context_t ip_contexts[ROHC_TCP_MAX_IP_HDRS];
+
+	/** The static chain of the last IR packet, reused by the next IR packets
+	 *  as long as the static part of the IPv6 extension headers does not
+	 *  change (the other static fields are the same for all the packets of
+	 *  the context) */
+	uint8_t static_chain[TCP_STATIC_CHAIN_CACHE_MAX_LEN];
+	/** The length of the cached static chain, 0 if not cached */
+	size_t static_chain_len;
 };
 
 
@@ -344,6 +463,14 @@ struct sc_tcp_context
  * Private function prototypes.
  */
 
+static inline bool tcp_is_field_changed(const struct sc_tcp_context *const tcp_context,
+                                        const uint32_t fields)
+	__attribute__((warn_unused_result, nonnull(1), pure));
+static inline void tcp_field_set_changed(struct sc_tcp_context *const tcp_context,
+                                         const uint32_t field,
+                                         const bool is_changed)
+	__attribute__((nonnull(1)));
+
 static bool c_tcp_create(struct rohc_comp_ctxt *const context,
                          const struct net_pkt *const packet)
 	__attribute__((warn_unused_result, nonnull(1, 2)));
@@ -369,27 +496,28 @@ static int c_tcp_encode(struct rohc_comp_ctxt *const context,
 
 static uint16_t c_tcp_get_next_msn(const struct rohc_comp_ctxt *const context)
 	__attribute__((warn_unused_result, nonnull(1)));
+static uint32_t c_tcp_get_msn(const struct rohc_comp_ctxt *const context)
+	__attribute__((warn_unused_result, nonnull(1)));
+static void c_tcp_set_next_msn(struct rohc_comp_ctxt *const context,
+                               const uint32_t msn)
+	__attribute__((nonnull(1)));
 
 static bool rohc_comp_tcp_are_ipv6_exts_acceptable(const struct rohc_comp *const comp,
-                                                   uint8_t *const next_proto,
-                                                   const uint8_t *const exts,
-                                                   const size_t max_exts_len,
-                                                   size_t *const exts_len)
-	__attribute__((warn_unused_result, nonnull(1, 2, 3, 5)));
+                                                   const struct net_pkt *const packet,
+                                                   size_t *const hdr_pos)
+	__attribute__((warn_unused_result, nonnull(1, 2, 3)));
 
 static bool tcp_detect_changes(struct rohc_comp_ctxt *const context,
                                const struct net_pkt *const uncomp_pkt,
                                ip_context_t **const ip_inner_context,
                                const struct tcphdr **const tcp)
 	__attribute__((warn_unused_result, nonnull(1, 2, 3, 4)));
-static bool tcp_detect_changes_ipv6_exts(struct rohc_comp_ctxt *const context,
+static void tcp_detect_changes_ipv6_exts(struct rohc_comp_ctxt *const context,
                                          ip_context_t *const ip_context,
-                                         uint8_t *const protocol,
-                                         const uint8_t *const exts,
-                                         const size_t max_exts_len,
-                                         size_t *const exts_nr,
-                                         size_t *const exts_len)
-	__attribute__((warn_unused_result, nonnull(1, 2, 3, 4, 6, 7)));
+                                         const struct net_pkt *const uncomp_pkt,
+                                         size_t *const hdr_pos,
+                                         size_t *const exts_nr)
+	__attribute__((nonnull(1, 2, 3, 4, 5)));
 
 static void tcp_decide_state(struct rohc_comp_ctxt *const context)
 	__attribute__((nonnull(1)));
@@ -404,6 +532,14 @@ static bool tcp_encode_uncomp_ip_fields(struct rohc_comp_ctxt *const context,
 static bool tcp_encode_uncomp_tcp_fields(struct rohc_comp_ctxt *const context,
                                          const struct tcphdr *const tcp)
 	__attribute__((warn_unused_result, nonnull(1, 2)));
+static void tcp_encode_uncomp_ts_field(const struct rohc_comp_ctxt *const context,
+                                       const struct c_wlsb *const wlsb,
+                                       const uint32_t ts,
+                                       const char *const descr,
+                                       size_t *const nr_bits_minus_1,
+                                       size_t *const nr_bits_0x40000,
+                                       size_t *const nr_bits_0x4000000)
+	__attribute__((nonnull(1, 2, 4, 5, 6, 7)));
 
 static rohc_packet_t tcp_decide_packet(struct rohc_comp_ctxt *const context,
                                        const ip_context_t *const ip_inner_context,
@@ -430,6 +566,9 @@ static rohc_packet_t tcp_decide_FO_SO_packet_rnd(const struct rohc_comp_ctxt *co
                                                  const struct tcphdr *const tcp,
                                                  const bool crc7_at_least)
 	__attribute__((warn_unused_result, nonnull(1, 2)));
+static inline rohc_packet_t tcp_co_decide_format(const uint32_t allowed,
+                                                 const uint32_t possible)
+	__attribute__((warn_unused_result, const));
 
 /* static chain */
 static int tcp_code_static_part(struct rohc_comp_ctxt *const context,
@@ -743,7 +882,8 @@ static int c_tcp_build_co_common(const struct rohc_comp_ctxt *const context,
  * Misc functions
  */
 
-static tcp_ip_id_behavior_t tcp_detect_ip_id_behavior(const uint16_t last_ip_id,
+static tcp_ip_id_behavior_t tcp_detect_ip_id_behavior(const tcp_ip_id_behavior_t last_behavior,
+                                                      const uint16_t last_ip_id,
                                                       const uint16_t new_ip_id)
 	__attribute__((warn_unused_result, const));
 
@@ -812,114 +952,84 @@ static bool c_tcp_create(struct rohc_comp_ctxt *const context,
 {
 	const struct rohc_comp *const comp = context->compressor;
 	struct sc_tcp_context *tcp_context;
-	const uint8_t *remain_data = packet->outer_ip.data;
-	size_t remain_len = packet->outer_ip.size;
 	const struct tcphdr *tcp;
-	uint8_t proto;
+	size_t hdr_pos;
 	size_t i;
 
-	/* create the TCP part of the profile context */
-	tcp_context = malloc(sizeof(struct sc_tcp_context));
+	/* create the TCP part of the profile context from one memory block of
+	 * the pool of the compressor */
+	tcp_context = rohc_ctxt_pool_get(context->compressor->cur_ctxt_pool,
+	                                 sizeof(struct sc_tcp_context), NULL);
 	if(tcp_context == NULL)
 	{
 		rohc_error(context->compressor, ROHC_TRACE_COMP, context->profile->id,
 		           "no memory for the TCP part of the profile context");
 		goto error;
 	}
-	memset(tcp_context, 0, sizeof(struct sc_tcp_context));
 	context->specific = tcp_context;
+	tcp_context->static_chain_len = 0;
 
-	/* create contexts for IP headers and their extensions */
+	/* create contexts for IP headers and their extensions, the descriptor of
+	 * the packet was already checked while checking the profile */
 	tcp_context->ip_contexts_nr = 0;
-	do
+	hdr_pos = 0;
+	while(rohc_is_tunneling(packet->hdrs[hdr_pos].proto))
 	{
-		const struct ip_hdr *const ip = (struct ip_hdr *) remain_data;
+		const uint8_t *const ip_data = packet->data + packet->hdrs[hdr_pos].offset;
+		const struct ip_hdr *const ip = (struct ip_hdr *) ip_data;
 		ip_context_t *const ip_context =
 			&(tcp_context->ip_contexts[tcp_context->ip_contexts_nr]);
 
+		assert(tcp_context->ip_contexts_nr < ROHC_TCP_MAX_IP_HDRS);
+
 		/* retrieve IP version */
-		assert(remain_len >= sizeof(struct ip_hdr));
 		rohc_comp_debug(context, "found IPv%d", ip->version);
 		ip_context->version = ip->version;
 		ip_context->ctxt.vx.version = ip->version;
 
-		switch(ip->version)
+		if(ip->version == IPV4)
 		{
-			case IPV4:
-			{
-				const struct ipv4_hdr *const ipv4 = (struct ipv4_hdr *) remain_data;
-
-				assert(remain_len >= sizeof(struct ipv4_hdr));
-				proto = ipv4->protocol;
-
-				ip_context->ctxt.v4.last_ip_id = rohc_ntoh16(ipv4->id);
-				rohc_comp_debug(context, "IP-ID 0x%04x", ip_context->ctxt.v4.last_ip_id);
-				ip_context->ctxt.v4.last_ip_id_behavior = IP_ID_BEHAVIOR_SEQ;
-				ip_context->ctxt.v4.ip_id_behavior = IP_ID_BEHAVIOR_SEQ;
-				ip_context->ctxt.v4.protocol = proto;
-				ip_context->ctxt.v4.dscp = ipv4->dscp;
-				ip_context->ctxt.v4.df = ipv4->df;
-				ip_context->ctxt.v4.ttl_hopl = ipv4->ttl;
-				ip_context->ctxt.v4.src_addr = ipv4->saddr;
-				ip_context->ctxt.v4.dst_addr = ipv4->daddr;
-
-				remain_data += sizeof(struct ipv4_hdr);
-				remain_len -= sizeof(struct ipv4_hdr);
-				break;
-			}
-			case IPV6:
-			{
-				const struct ipv6_hdr *const ipv6 = (struct ipv6_hdr *) remain_data;
-
-				assert(remain_len >= sizeof(struct ipv6_hdr));
-				proto = ipv6->nh;
-
-				ip_context->ctxt.v6.ip_id_behavior = IP_ID_BEHAVIOR_RAND;
-				ip_context->ctxt.v6.dscp = remain_data[1];
-				ip_context->ctxt.v6.ttl_hopl = ipv6->hl;
-				ip_context->ctxt.v6.flow_label = ipv6_get_flow_label(ipv6);
-				memcpy(ip_context->ctxt.v6.src_addr, &ipv6->saddr,
-				       sizeof(struct ipv6_addr));
-				memcpy(ip_context->ctxt.v6.dest_addr, &ipv6->daddr,
-				       sizeof(struct ipv6_addr));
-
-				remain_data += sizeof(struct ipv6_hdr);
-				remain_len -= sizeof(struct ipv6_hdr);
-
-				rohc_comp_debug(context, "parse IPv6 extension headers");
-				while(rohc_is_ipv6_opt(proto))
-				{
-					const struct ipv6_opt *const ipv6_opt = (struct ipv6_opt *) remain_data;
-					size_t opt_len;
-					assert(remain_len >= sizeof(struct ipv6_opt));
-					opt_len = ipv6_opt_get_length(ipv6_opt);
-					rohc_comp_debug(context, "  IPv6 extension header is %zu-byte long",
-					                opt_len);
-					remain_data += opt_len;
-					remain_len -= opt_len;
-					proto = ipv6_opt->next_header;
-				}
-				ip_context->ctxt.v6.next_header = proto;
-				break;
-			}
-			default:
+			const struct ipv4_hdr *const ipv4 = (struct ipv4_hdr *) ip_data;
+
+			ip_context->ctxt.v4.last_ip_id = rohc_ntoh16(ipv4->id);
+			rohc_comp_debug(context, "IP-ID 0x%04x", ip_context->ctxt.v4.last_ip_id);
+			ip_context->ctxt.v4.last_ip_id_behavior = IP_ID_BEHAVIOR_SEQ;
+			ip_context->ctxt.v4.ip_id_behavior = IP_ID_BEHAVIOR_SEQ;
+			ip_context->ctxt.v4.protocol = ipv4->protocol;
+			ip_context->ctxt.v4.dscp = ipv4->dscp;
+			ip_context->ctxt.v4.df = ipv4->df;
+			ip_context->ctxt.v4.ttl_hopl = ipv4->ttl;
+			ip_context->ctxt.v4.src_addr = ipv4->saddr;
+			ip_context->ctxt.v4.dst_addr = ipv4->daddr;
+			hdr_pos++;
+		}
+		else
+		{
+			const struct ipv6_hdr *const ipv6 = (struct ipv6_hdr *) ip_data;
+
+			assert(ip->version == IPV6);
+			ip_context->ctxt.v6.ip_id_behavior = IP_ID_BEHAVIOR_RAND;
+			ip_context->ctxt.v6.dscp = ip_data[1];
+			ip_context->ctxt.v6.ttl_hopl = ipv6->hl;
+			ip_context->ctxt.v6.flow_label = ipv6_get_flow_label(ipv6);
+			memcpy(ip_context->ctxt.v6.src_addr, &ipv6->saddr,
+			       sizeof(struct ipv6_addr));
+			memcpy(ip_context->ctxt.v6.dest_addr, &ipv6->daddr,
+			       sizeof(struct ipv6_addr));
+			hdr_pos++;
+
+			/* skip the IPv6 extension headers */
+			while(rohc_is_ipv6_opt(packet->hdrs[hdr_pos].proto))
 			{
-				goto free_context;
+				rohc_comp_debug(context, "  IPv6 extension header is %u-byte long",
+				                packet->hdrs[hdr_pos].len);
+				hdr_pos++;
 			}
+			ip_context->ctxt.v6.next_header = packet->hdrs[hdr_pos].proto;
 		}
 
 		tcp_context->ip_contexts_nr++;
 	}
-	while(rohc_is_tunneling(proto) && tcp_context->ip_contexts_nr < ROHC_TCP_MAX_IP_HDRS);
-
-	/* profile cannot handle the packet if it bypasses internal limit of IP headers */
-	if(rohc_is_tunneling(proto))
-	{
-		rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-		           "too many IP headers for TCP profile (%u headers max)",
-		           ROHC_TCP_MAX_IP_HDRS);
-		goto free_context;
-	}
 
 	/* create context for TCP header */
 	tcp_context->tcp_seq_num_change_count = 0;
@@ -931,87 +1041,37 @@ static bool c_tcp_create(struct rohc_comp_ctxt *const context,
 	tcp_context->tcp_last_seq_num = -1;
 
 	/* TCP header begins just after the IP headers */
-	assert(remain_len >= sizeof(struct tcphdr));
-	tcp = (struct tcphdr *) remain_data;
+	assert(packet->hdrs[hdr_pos].proto == ROHC_IPPROTO_TCP);
+	tcp = (struct tcphdr *) (packet->data + packet->hdrs[hdr_pos].offset);
 	memcpy(&(tcp_context->old_tcphdr), tcp, sizeof(struct tcphdr));
 
 	/* MSN */
-	tcp_context->msn_wlsb =
-		c_create_wlsb(16, comp->wlsb_window_width, ROHC_LSB_SHIFT_TCP_SN);
-	if(tcp_context->msn_wlsb == NULL)
-	{
-		rohc_error(context->compressor, ROHC_TRACE_COMP, context->profile->id,
-		           "failed to create W-LSB context for MSN");
-		goto free_context;
-	}
+	c_init_wlsb(&tcp_context->msn_wlsb, 16, comp->wlsb_window_width,
+	            ROHC_LSB_SHIFT_TCP_SN);
 
 	/* IP-ID offset */
-	tcp_context->ip_id_wlsb =
-		c_create_wlsb(16, comp->wlsb_window_width, ROHC_LSB_SHIFT_VAR);
-	if(tcp_context->ip_id_wlsb == NULL)
-	{
-		rohc_error(context->compressor, ROHC_TRACE_COMP, context->profile->id,
-		           "failed to create W-LSB context for IP-ID offset");
-		goto free_wlsb_msn;
-	}
+	c_init_wlsb(&tcp_context->ip_id_wlsb, 16, comp->wlsb_window_width,
+	            ROHC_LSB_SHIFT_VAR);
 
 	/* innermost IPv4 TTL or IPv6 Hop Limit */
-	tcp_context->ttl_hopl_wlsb =
-		c_create_wlsb(8, comp->wlsb_window_width, ROHC_LSB_SHIFT_TCP_TTL);
-	if(tcp_context->ttl_hopl_wlsb == NULL)
-	{
-		rohc_error(context->compressor, ROHC_TRACE_COMP, context->profile->id,
-		           "failed to create W-LSB context for innermost IPv4 TTL or "
-		           "IPv6 Hop Limit");
-		goto free_wlsb_ip_id;
-	}
+	c_init_wlsb(&tcp_context->ttl_hopl_wlsb, 8, comp->wlsb_window_width,
+	            ROHC_LSB_SHIFT_TCP_TTL);
 
 	/* TCP window */
-	tcp_context->window_wlsb =
-		c_create_wlsb(16, comp->wlsb_window_width, ROHC_LSB_SHIFT_TCP_WINDOW);
-	if(tcp_context->window_wlsb == NULL)
-	{
-		rohc_error(context->compressor, ROHC_TRACE_COMP, context->profile->id,
-		           "failed to create W-LSB context for TCP window");
-		goto free_wlsb_ttl_hopl;
-	}
+	c_init_wlsb(&tcp_context->window_wlsb, 16, comp->wlsb_window_width,
+	            ROHC_LSB_SHIFT_TCP_WINDOW);
 
 	/* TCP sequence number */
 	tcp_context->seq_num = rohc_ntoh32(tcp->seq_num);
-	tcp_context->seq_wlsb =
-		c_create_wlsb(32, comp->wlsb_window_width, ROHC_LSB_SHIFT_VAR);
-	if(tcp_context->seq_wlsb == NULL)
-	{
-		rohc_error(context->compressor, ROHC_TRACE_COMP, context->profile->id,
-		           "failed to create W-LSB context for TCP sequence number");
-		goto free_wlsb_window;
-	}
-	tcp_context->seq_scaled_wlsb = c_create_wlsb(32, 4, 7);
-	if(tcp_context->seq_scaled_wlsb == NULL)
-	{
-		rohc_error(context->compressor, ROHC_TRACE_COMP, context->profile->id,
-		           "failed to create W-LSB context for TCP scaled sequence "
-		           "number");
-		goto free_wlsb_seq;
-	}
+	c_init_wlsb(&tcp_context->seq_wlsb, 32, comp->wlsb_window_width,
+	            ROHC_LSB_SHIFT_VAR);
+	c_init_wlsb(&tcp_context->seq_scaled_wlsb, 32, 4, 7);
 
 	/* TCP acknowledgment (ACK) number */
 	tcp_context->ack_num = rohc_ntoh32(tcp->ack_num);
-	tcp_context->ack_wlsb =
-		c_create_wlsb(32, comp->wlsb_window_width, ROHC_LSB_SHIFT_VAR);
-	if(tcp_context->ack_wlsb == NULL)
-	{
-		rohc_error(context->compressor, ROHC_TRACE_COMP, context->profile->id,
-		           "failed to create W-LSB context for TCP ACK number");
-		goto free_wlsb_seq_scaled;
-	}
-	tcp_context->ack_scaled_wlsb = c_create_wlsb(32, 4, 3);
-	if(tcp_context->ack_scaled_wlsb == NULL)
-	{
-		rohc_error(context->compressor, ROHC_TRACE_COMP, context->profile->id,
-		           "failed to create W-LSB context for TCP scaled ACK number");
-		goto free_wlsb_ack;
-	}
+	c_init_wlsb(&tcp_context->ack_wlsb, 32, comp->wlsb_window_width,
+	            ROHC_LSB_SHIFT_VAR);
+	c_init_wlsb(&tcp_context->ack_scaled_wlsb, 32, 4, 3);
 
 	/* init the Master Sequence Number to a random value */
 	tcp_context->msn = comp->random_cb(comp, comp->random_cb_ctxt) & 0xffff;
@@ -1027,52 +1087,19 @@ static bool c_tcp_create(struct rohc_comp_ctxt *const context,
 	{
 		tcp_context->tcp_opts.list[i].used = false;
 	}
+	tcp_context->tcp_opts.is_layout_cached = false;
 
 	/* no TCP option Timestamp received yet */
 	tcp_context->tcp_opts.is_timestamp_init = false;
 	/* TCP option Timestamp (request) */
-	tcp_context->tcp_opts.ts_req_wlsb =
-		c_create_wlsb(32, comp->wlsb_window_width, ROHC_LSB_SHIFT_VAR);
-	if(tcp_context->tcp_opts.ts_req_wlsb == NULL)
-	{
-		rohc_error(context->compressor, ROHC_TRACE_COMP, context->profile->id,
-		           "failed to create W-LSB context for TCP option Timestamp "
-		           "request");
-		goto free_wlsb_ack_scaled;
-	}
+	c_init_wlsb(&tcp_context->tcp_opts.ts_req_wlsb, 32, comp->wlsb_window_width,
+	            ROHC_LSB_SHIFT_VAR);
 	/* TCP option Timestamp (reply) */
-	tcp_context->tcp_opts.ts_reply_wlsb =
-		c_create_wlsb(32, comp->wlsb_window_width, ROHC_LSB_SHIFT_VAR);
-	if(tcp_context->tcp_opts.ts_reply_wlsb == NULL)
-	{
-		rohc_error(context->compressor, ROHC_TRACE_COMP, context->profile->id,
-		           "failed to create W-LSB context for TCP option Timestamp "
-		           "reply");
-		goto free_wlsb_opt_ts_req;
-	}
+	c_init_wlsb(&tcp_context->tcp_opts.ts_reply_wlsb, 32, comp->wlsb_window_width,
+	            ROHC_LSB_SHIFT_VAR);
 
 	return true;
 
-free_wlsb_opt_ts_req:
-	c_destroy_wlsb(tcp_context->tcp_opts.ts_req_wlsb);
-free_wlsb_ack_scaled:
-	c_destroy_wlsb(tcp_context->ack_scaled_wlsb);
-free_wlsb_ack:
-	c_destroy_wlsb(tcp_context->ack_wlsb);
-free_wlsb_seq_scaled:
-	c_destroy_wlsb(tcp_context->seq_scaled_wlsb);
-free_wlsb_seq:
-	c_destroy_wlsb(tcp_context->seq_wlsb);
-free_wlsb_window:
-	c_destroy_wlsb(tcp_context->window_wlsb);
-free_wlsb_ttl_hopl:
-	c_destroy_wlsb(tcp_context->ttl_hopl_wlsb);
-free_wlsb_ip_id:
-	c_destroy_wlsb(tcp_context->ip_id_wlsb);
-free_wlsb_msn:
-	c_destroy_wlsb(tcp_context->msn_wlsb);
-free_context:
-	free(tcp_context);
 error:
 	return false;
 }
@@ -1087,17 +1114,7 @@ static void c_tcp_destroy(struct rohc_comp_ctxt *const context)
 {
 	struct sc_tcp_context *const tcp_context = context->specific;
 
-	c_destroy_wlsb(tcp_context->tcp_opts.ts_reply_wlsb);
-	c_destroy_wlsb(tcp_context->tcp_opts.ts_req_wlsb);
-	c_destroy_wlsb(tcp_context->ack_scaled_wlsb);
-	c_destroy_wlsb(tcp_context->ack_wlsb);
-	c_destroy_wlsb(tcp_context->seq_scaled_wlsb);
-	c_destroy_wlsb(tcp_context->seq_wlsb);
-	c_destroy_wlsb(tcp_context->window_wlsb);
-	c_destroy_wlsb(tcp_context->ip_id_wlsb);
-	c_destroy_wlsb(tcp_context->ttl_hopl_wlsb);
-	c_destroy_wlsb(tcp_context->msn_wlsb);
-	free(tcp_context);
+	rohc_ctxt_pool_put(context->compressor->cur_ctxt_pool, tcp_context);
 }
 
 
@@ -1126,52 +1143,54 @@ static void c_tcp_destroy(struct rohc_comp_ctxt *const context)
 static bool c_tcp_check_profile(const struct rohc_comp *const comp,
                                 const struct net_pkt *const packet)
 {
-	/* TODO: should avoid code duplication by using net_pkt as
-	 * rohc_comp_rfc3095_check_profile() does */
-	const uint8_t *remain_data;
-	size_t remain_len;
-	size_t ip_hdrs_nr;
-	uint8_t next_proto;
+	const struct net_pkt_hdr *tcp_hdr;
 	const struct tcphdr *tcp_header;
+	size_t ip_hdrs_nr;
+	size_t hdr_pos;
 
 	assert(comp != NULL);
 	assert(packet != NULL);
 
-	remain_data = packet->outer_ip.data;
-	remain_len = packet->outer_ip.size;
+	/* the descriptor of the packet ends with the TCP header only if all the
+	 * IP headers, their extension headers and the TCP header with its options
+	 * were parsed successfully */
+	if(packet->hdrs_nr == 0 ||
+	   packet->hdrs[packet->hdrs_nr - 1].proto != ROHC_IPPROTO_TCP)
+	{
+		rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		           "transport protocol is not TCP, or one header is truncated, "
+		           "not supported or is an IP fragment");
+		goto bad_profile;
+	}
+	tcp_hdr = &(packet->hdrs[packet->hdrs_nr - 1]);
 
-	/* check that the the versions of IP headers are 4 or 6 and that IP headers
-	 * are not IP fragments */
+	/* check the lengths of the IP headers and that they are not IP fragments */
 	ip_hdrs_nr = 0;
-	do
+	hdr_pos = 0;
+	while(hdr_pos < (packet->hdrs_nr - 1))
 	{
-		const struct ip_hdr *const ip = (struct ip_hdr *) remain_data;
+		const struct net_pkt_hdr *const ip_hdr = &(packet->hdrs[hdr_pos]);
+		const uint8_t *const ip_data = packet->data + ip_hdr->offset;
+		const size_t remain_len = packet->len - ip_hdr->offset;
 
-		/* check minimal length for IP version */
-		if(remain_len < sizeof(struct ip_hdr))
+		/* profile cannot handle the packet if it bypasses internal limit of IP headers */
+		if(ip_hdrs_nr >= ROHC_TCP_MAX_IP_HDRS)
 		{
 			rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-			           "failed to determine the version of IP header #%zu",
-			           ip_hdrs_nr + 1);
+			           "too many IP headers for TCP profile (%u headers max)",
+			           ROHC_TCP_MAX_IP_HDRS);
 			goto bad_profile;
 		}
 
-		if(ip->version == IPV4)
+		if(ip_hdr->proto == ROHC_IPPROTO_IPIP)
 		{
-			const struct ipv4_hdr *const ipv4 = (struct ipv4_hdr *) remain_data;
+			const struct ipv4_hdr *const ipv4 = (struct ipv4_hdr *) ip_data;
 			const size_t ipv4_min_words_nr = sizeof(struct ipv4_hdr) / sizeof(uint32_t);
 
 			rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL, "found IPv4");
-			if(remain_len < sizeof(struct ipv4_hdr))
-			{
-				rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-				           "uncompressed packet too short for IP header #%zu",
-				           ip_hdrs_nr + 1);
-				goto bad_profile;
-			}
 
 			/* IPv4 options are not supported by the TCP profile */
-			if(ipv4->ihl != ipv4_min_words_nr)
+			if(ip_hdr->len != sizeof(struct ipv4_hdr))
 			{
 				rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
 				           "IP packet #%zu is not supported by the profile: "
@@ -1199,7 +1218,8 @@ static bool c_tcp_check_profile(const struct rohc_comp *const comp,
 
 			/* check if the checksum of the IPv4 header is correct */
 			if((comp->features & ROHC_COMP_FEATURE_NO_IP_CHECKSUMS) == 0 &&
-			   ip_fast_csum(remain_data, ipv4_min_words_nr) != 0)
+			   !packet->ip_csums_verified &&
+			   ip_fast_csum(ip_data, ipv4_min_words_nr) != 0)
 			{
 				rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
 				           "IP packet #%zu is not correct (bad checksum)",
@@ -1207,102 +1227,44 @@ static bool c_tcp_check_profile(const struct rohc_comp *const comp,
 				goto bad_profile;
 			}
 
-			next_proto = ipv4->protocol;
-			remain_data += sizeof(struct ipv4_hdr);
-			remain_len -= sizeof(struct ipv4_hdr);
+			hdr_pos++;
 		}
-		else if(ip->version == IPV6)
+		else
 		{
-			const struct ipv6_hdr *const ipv6 = (struct ipv6_hdr *) remain_data;
-			size_t ipv6_exts_len;
+			const struct ipv6_hdr *const ipv6 = (struct ipv6_hdr *) ip_data;
 
+			assert(ip_hdr->proto == ROHC_IPPROTO_IPV6);
 			rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL, "found IPv6");
-			if(remain_len < sizeof(struct ipv6_hdr))
-			{
-				rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-				           "uncompressed packet too short for IP header #%zu",
-				           ip_hdrs_nr + 1);
-				goto bad_profile;
-			}
-			next_proto = ipv6->nh;
-			remain_data += sizeof(struct ipv6_hdr);
-			remain_len -= sizeof(struct ipv6_hdr);
 
 			/* payload length shall be correct */
-			if(rohc_ntoh16(ipv6->plen) != remain_len)
+			if(rohc_ntoh16(ipv6->plen) != (remain_len - sizeof(struct ipv6_hdr)))
 			{
 				rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
 				           "IP packet #%zu is not supported by the profile: payload "
 				           "length is %u while it shall be %zu", ip_hdrs_nr + 1,
-				           rohc_ntoh16(ipv6->plen), remain_len);
+				           rohc_ntoh16(ipv6->plen), remain_len - sizeof(struct ipv6_hdr));
 				goto bad_profile;
 			}
+			hdr_pos++;
 
-			/* reject packets with malformed IPv6 extension headers or IPv6
-			 * extension headers that are not compatible with the TCP profile */
-			if(!rohc_comp_tcp_are_ipv6_exts_acceptable(comp, &next_proto,
-			                                           remain_data, remain_len,
-			                                           &ipv6_exts_len))
+			/* reject packets with IPv6 extension headers that are not compatible
+			 * with the TCP profile */
+			if(!rohc_comp_tcp_are_ipv6_exts_acceptable(comp, packet, &hdr_pos))
 			{
 				rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
 				           "IP packet #%zu is not supported by the profile: "
-				           "malformed or incompatible IPv6 extension headers "
-				           "detected", ip_hdrs_nr + 1);
+				           "incompatible IPv6 extension headers detected",
+				           ip_hdrs_nr + 1);
 				goto bad_profile;
 			}
-			remain_data += ipv6_exts_len;
-			remain_len -= ipv6_exts_len;
-		}
-		else
-		{
-			rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-			           "unsupported version %u for header #%zu",
-			           ip->version, ip_hdrs_nr + 1);
-			goto bad_profile;
 		}
 		ip_hdrs_nr++;
 	}
-	while(rohc_is_tunneling(next_proto) && ip_hdrs_nr < ROHC_TCP_MAX_IP_HDRS);
-
-	/* profile cannot handle the packet if it bypasses internal limit of IP headers */
-	if(rohc_is_tunneling(next_proto))
-	{
-		rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-		           "too many IP headers for TCP profile (%u headers max)",
-		           ROHC_TCP_MAX_IP_HDRS);
-		goto bad_profile;
-	}
-
-	/* check that the transport protocol is TCP */
-	if(next_proto != ROHC_IPPROTO_TCP)
-	{
-		rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-		           "transport protocol is not TCP");
-		goto bad_profile;
-	}
-
-	/* innermost IP payload shall be large enough for TCP header */
-	if(remain_len < sizeof(struct tcphdr))
-	{
-		rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-		           "innermost IP payload too small for minimal TCP header");
-		goto bad_profile;
-	}
 
-	/* retrieve the TCP header */
-	tcp_header = (const struct tcphdr *) remain_data;
-	if(tcp_header->data_offset < 5)
-	{
-		rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-		           "TCP data offset too small for minimal TCP header");
-		goto bad_profile;
-	}
-	if(remain_len < (tcp_header->data_offset * sizeof(uint32_t)))
-	{
-		rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-		           "TCP data too small for full TCP header with options");
-		goto bad_profile;
-	}
+	/* retrieve the TCP header, the descriptor already checked that the data
+	 * offset is large enough for the minimal TCP header and that the TCP
+	 * options are not truncated */
+	tcp_header = (const struct tcphdr *) (packet->data + tcp_hdr->offset);
 
 	/* reject packets with malformed TCP options or TCP options that are not
 	 * compatible with the TCP profile */
@@ -1324,123 +1286,72 @@ bad_profile:
 /**
  * @brief Whether IPv6 extension headers are acceptable for TCP profile or not
  *
- * TCP options are acceptable if:
- *  - the last IPv6 extension header is not truncated,
+ * IPv6 extension headers are acceptable if:
  *  - no more than \e ROHC_TCP_MAX_IP_EXT_HDRS extension headers are present,
+ *  - the Hop-by-Hop extension header, if any, is the first one,
  *  - each extension header is present only once (except Destination that may
  *    occur twice).
  *
- * @param comp                The ROHC compressor
- * @param[in,out] next_proto  in: the protocol type of the first extension header
- *                            out: the protocol type of the transport header
- * @param exts                The beginning of the IPv6 extension headers
- * @param max_exts_len        The maximum length (in bytes) of the extension headers
- * @param[out] exts_len       The length (in bytes) of the IPv6 extension headers
- * @return                    true if the IPv6 extension headers are acceptable,
- *                            false if they are not
+ * The packet descriptor already checked that the extension headers are not
+ * truncated and that they are of a supported type.
+ *
+ * @param comp             The ROHC compressor
+ * @param packet           The packet to check
+ * @param[in,out] hdr_pos  in: the position of the first extension header in
+ *                             the packet descriptor
+ *                         out: the position of the header that follows the
+ *                              extension headers
+ * @return                 true if the IPv6 extension headers are acceptable,
+ *                         false if they are not
  *
  * @see ROHC_TCP_MAX_IP_EXT_HDRS
  */
 static bool rohc_comp_tcp_are_ipv6_exts_acceptable(const struct rohc_comp *const comp,
-                                                   uint8_t *const next_proto,
-                                                   const uint8_t *const exts,
-                                                   const size_t max_exts_len,
-                                                   size_t *const exts_len)
+                                                   const struct net_pkt *const packet,
+                                                   size_t *const hdr_pos)
 {
 	uint8_t ipv6_ext_types_count[ROHC_IPPROTO_MAX + 1] = { 0 };
-	const uint8_t *remain_data = exts;
-	size_t remain_len = max_exts_len;
 	size_t ipv6_ext_nr;
 
-	(*exts_len) = 0;
-
 	ipv6_ext_nr = 0;
-	while(rohc_is_ipv6_opt(*next_proto) && ipv6_ext_nr < ROHC_TCP_MAX_IP_EXT_HDRS)
+	while((*hdr_pos) < packet->hdrs_nr &&
+	      rohc_is_ipv6_opt(packet->hdrs[*hdr_pos].proto))
 	{
-		size_t ext_len;
+		const struct net_pkt_hdr *const ext = &(packet->hdrs[*hdr_pos]);
 
 		rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-		           "  found extension header #%zu of type %u",
-		           ipv6_ext_nr + 1, *next_proto);
+		           "  found extension header #%zu of type %u (%u bytes)",
+		           ipv6_ext_nr + 1, ext->proto, ext->len);
 
-		switch(*next_proto)
+		/* profile cannot handle the packet if it bypasses internal limit of
+		 * IPv6 extension headers */
+		if(ipv6_ext_nr >= ROHC_TCP_MAX_IP_EXT_HDRS)
 		{
-			case ROHC_IPPROTO_HOPOPTS: /* IPv6 Hop-by-Hop options */
-			case ROHC_IPPROTO_ROUTING: /* IPv6 routing header */
-			case ROHC_IPPROTO_DSTOPTS: /* IPv6 destination options */
-			{
-				const struct ipv6_opt *const ipv6_opt =
-					(struct ipv6_opt *) remain_data;
-
-				if(remain_len < (sizeof(ipv6_opt) - 1))
-				{
-					rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-					           "packet too short for IPv6 extension header");
-					goto bad_exts;
-				}
-
-				ext_len = ipv6_opt_get_length(ipv6_opt);
-				if(remain_len < ext_len)
-				{
-					rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-					           "packet too short for IPv6 extension header");
-					goto bad_exts;
-				}
-				(*next_proto) = ipv6_opt->next_header;
-
-				/* RFC 2460 §4 reads:
-				 *   The Hop-by-Hop Options header, when present, must
-				 *   immediately follow the IPv6 header.
-				 *   [...]
-				 *   The same action [ie. reject packet] should be taken if a
-				 *   node encounters a Next Header value of zero in any header other
-				 *   than an IPv6 header. */
-				if((*next_proto) == ROHC_IPPROTO_HOPOPTS && ipv6_ext_nr != 0)
-				{
-					rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-					           "malformed IPv6 header: the Hop-By-Hop extension "
-					           "header should be the very first extension header, "
-					           "not the #%zu one", ipv6_ext_nr + 1);
-					goto bad_exts;
-				}
-				break;
-			}
-			// case ROHC_IPPROTO_ESP : ???
-			case ROHC_IPPROTO_GRE:  /* TODO: GRE not yet supported */
-			case ROHC_IPPROTO_MINE: /* TODO: MINE not yet supported */
-			case ROHC_IPPROTO_AH:   /* TODO: AH not yet supported */
-			default:
-			{
-				rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-				           "malformed IPv6 header: unsupported IPv6 extension "
-				           "header %u detected", *next_proto);
-				goto bad_exts;
-			}
+			rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+			           "IP header got too many IPv6 extension headers for TCP "
+			           "profile (%u headers max)", ROHC_TCP_MAX_IP_EXT_HDRS);
+			goto bad_exts;
 		}
-		rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-		           "  extension header is %zu-byte long", ext_len);
-		remain_data += ext_len;
-		remain_len -= ext_len;
 
-		ipv6_ext_nr++;
-		(*exts_len) += ext_len;
-		if(ipv6_ext_types_count[*next_proto] >= 255)
+		/* RFC 2460 §4 reads:
+		 *   The Hop-by-Hop Options header, when present, must
+		 *   immediately follow the IPv6 header.
+		 *   [...]
+		 *   The same action [ie. reject packet] should be taken if a
+		 *   node encounters a Next Header value of zero in any header other
+		 *   than an IPv6 header. */
+		if(ext->proto == ROHC_IPPROTO_HOPOPTS && ipv6_ext_nr != 0)
 		{
 			rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-			           "too many IPv6 extension header of type 0x%02x", *next_proto);
+			           "malformed IPv6 header: the Hop-By-Hop extension "
+			           "header should be the very first extension header, "
+			           "not the #%zu one", ipv6_ext_nr + 1);
 			goto bad_exts;
 		}
-		ipv6_ext_types_count[*next_proto]++;
-	}
 
-	/* profile cannot handle the packet if it bypasses internal limit of
-	 * IPv6 extension headers */
-	if(ipv6_ext_nr > ROHC_TCP_MAX_IP_EXT_HDRS)
-	{
-		rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-		           "IP header got too many IPv6 extension headers for TCP profile "
-		           "(%u headers max)", ROHC_TCP_MAX_IP_EXT_HDRS);
-		goto bad_exts;
+		ipv6_ext_types_count[ext->proto]++;
+		ipv6_ext_nr++;
+		(*hdr_pos)++;
 	}
 
 	/* RFC 2460 §4.1 reads:
@@ -1493,6 +1404,10 @@ bad_exts:
  *  - IPv6 only: the Flow Label of the two IP headers must match the ones the
  *    context
  *
+ * The flow fingerprint of the packet covers the IP headers, so they are only
+ * compared one by one if they do not fit in a fingerprint or if there are more
+ * than two of them.
+ *
  * This function is one of the functions that must exist in one profile for the
  * framework to work.
  *
@@ -1508,24 +1423,46 @@ static bool c_tcp_check_context(const struct rohc_comp_ctxt *const context,
                                 const struct net_pkt *const packet)
 {
 	struct sc_tcp_context *const tcp_context = context->specific;
-	const uint8_t *remain_data = packet->outer_ip.data;
-	size_t remain_len = packet->outer_ip.size;
+	const struct net_pkt_hdr *const tcp_hdr = &(packet->hdrs[packet->hdrs_nr - 1]);
 	size_t ip_hdr_pos;
-	uint8_t next_proto = ROHC_IPPROTO_IPIP;
+	size_t hdr_pos;
 	const struct tcphdr *tcp;
 	bool is_tcp_same;
+	bool same_fprint;
+
+	/* the descriptor of the packet was checked while checking the profile */
+	assert(packet->hdrs_nr > 0);
+	assert(tcp_hdr->proto == ROHC_IPPROTO_TCP);
 
-	/* parse the IP headers (lengths already checked while checking profile) */
+	/* compare the flow fingerprints first, they cover all the IP headers
+	 * unless the innermost one in the fingerprint is followed by another */
+	if(net_pkt_fprint_cmp(&packet->fprint, &context->fprint, &same_fprint))
+	{
+		if(!same_fprint)
+		{
+			rohc_comp_debug(context, "  not same flow fingerprint");
+			goto bad_context;
+		}
+		if(!rohc_is_tunneling(packet->transport->proto))
+		{
+			rohc_comp_debug(context, "  same flow fingerprint");
+			goto check_tcp;
+		}
+	}
+
+	/* compare the IP headers one by one */
+	hdr_pos = 0;
 	for(ip_hdr_pos = 0;
-	    ip_hdr_pos < tcp_context->ip_contexts_nr && rohc_is_tunneling(next_proto);
+	    ip_hdr_pos < tcp_context->ip_contexts_nr &&
+	    rohc_is_tunneling(packet->hdrs[hdr_pos].proto);
 	    ip_hdr_pos++)
 	{
-		const struct ip_hdr *const ip = (struct ip_hdr *) remain_data;
+		const uint8_t *const ip_data = packet->data + packet->hdrs[hdr_pos].offset;
+		const struct ip_hdr *const ip = (struct ip_hdr *) ip_data;
 		const ip_context_t *const ip_context = &(tcp_context->ip_contexts[ip_hdr_pos]);
-		size_t ip_ext_pos;
+		uint8_t next_proto;
 
 		/* retrieve IP version */
-		assert(remain_len >= sizeof(struct ip_hdr));
 		rohc_comp_debug(context, "found IPv%d", ip->version);
 		if(ip->version != ip_context->version)
 		{
@@ -1535,9 +1472,7 @@ static bool c_tcp_check_context(const struct rohc_comp_ctxt *const context,
 
 		if(ip->version == IPV4)
 		{
-			const struct ipv4_hdr *const ipv4 = (struct ipv4_hdr *) remain_data;
-
-			assert(remain_len >= sizeof(struct ipv4_hdr));
+			const struct ipv4_hdr *const ipv4 = (struct ipv4_hdr *) ip_data;
 
 			/* check source and destination addresses */
 			if(ipv4->saddr != ip_context->ctxt.v4.src_addr ||
@@ -1556,16 +1491,13 @@ static bool c_tcp_check_context(const struct rohc_comp_ctxt *const context,
 				goto bad_context;
 			}
 			rohc_comp_debug(context, "  IPv4 same protocol %d", next_proto);
-
-			/* skip IPv4 header */
-			remain_data += sizeof(struct ipv4_hdr);
-			remain_len -= sizeof(struct ipv4_hdr);
+			hdr_pos++;
 		}
-		else if(ip->version == IPV6)
+		else
 		{
-			const struct ipv6_hdr *const ipv6 = (struct ipv6_hdr *) remain_data;
+			const struct ipv6_hdr *const ipv6 = (struct ipv6_hdr *) ip_data;
 
-			assert(remain_len >= sizeof(struct ipv6_hdr));
+			assert(ip->version == IPV6);
 
 			/* check source and destination addresses */
 			if(memcmp(&ipv6->saddr, ip_context->ctxt.v6.src_addr,
@@ -1585,23 +1517,14 @@ static bool c_tcp_check_context(const struct rohc_comp_ctxt *const context,
 				goto bad_context;
 			}
 			rohc_comp_debug(context, "  same IPv6 flow label");
-
-			/* skip IPv6 base header */
-			remain_data += sizeof(struct ipv6_hdr);
-			remain_len -= sizeof(struct ipv6_hdr);
+			hdr_pos++;
 
 			/* find transport header/protocol, skip any IPv6 extension headers */
-			next_proto = ipv6->nh;
-			for(ip_ext_pos = 0; rohc_is_ipv6_opt(next_proto); ip_ext_pos++)
+			while(rohc_is_ipv6_opt(packet->hdrs[hdr_pos].proto))
 			{
-				const struct ipv6_opt *const ipv6_opt = (struct ipv6_opt *) remain_data;
-				size_t opt_len;
-				assert(remain_len >= sizeof(struct ipv6_opt));
-				opt_len = ipv6_opt_get_length(ipv6_opt);
-				remain_data += opt_len;
-				remain_len -= opt_len;
-				next_proto = ipv6_opt->next_header;
+				hdr_pos++;
 			}
+			next_proto = packet->hdrs[hdr_pos].proto;
 
 			/* check transport header protocol */
 			if(next_proto != ip_context->ctxt.v6.next_header)
@@ -1611,13 +1534,6 @@ static bool c_tcp_check_context(const struct rohc_comp_ctxt *const context,
 			}
 			rohc_comp_debug(context, "  IPv6 same protocol %u", next_proto);
 		}
-		else
-		{
-			rohc_comp_warn(context, "unsupported version %u for header #%zu",
-			               ip->version, ip_hdr_pos + 1);
-			assert(0);
-			goto bad_context;
-		}
 	}
 
 	if(ip_hdr_pos < tcp_context->ip_contexts_nr)
@@ -1626,14 +1542,14 @@ static bool c_tcp_check_context(const struct rohc_comp_ctxt *const context,
 		goto bad_context;
 	}
 
-	if(rohc_is_tunneling(next_proto))
+	if(rohc_is_tunneling(packet->hdrs[hdr_pos].proto))
 	{
 		rohc_comp_debug(context, "  more IP headers than context");
 		goto bad_context;
 	}
 
-	assert(remain_len >= sizeof(struct tcphdr));
-	tcp = (struct tcphdr *) remain_data;
+check_tcp:
+	tcp = (struct tcphdr *) (packet->data + tcp_hdr->offset);
 	is_tcp_same = tcp_context->old_tcphdr.src_port == tcp->src_port &&
 	              tcp_context->old_tcphdr.dst_port == tcp->dst_port;
 	rohc_comp_debug(context, "  TCP %ssame Source and Destination ports",
@@ -1678,7 +1594,7 @@ static int c_tcp_encode(struct rohc_comp_ctxt *const context,
                         size_t *const payload_offset)
 {
 	struct sc_tcp_context *const tcp_context = context->specific;
-	ip_context_t *ip_inner_context;
+	ip_context_t *ip_inner_context = NULL;
 	const struct tcphdr *tcp;
 	int counter;
 	size_t i;
@@ -1824,14 +1740,14 @@ static int code_IR_packet(struct rohc_comp_ctxt *const context,
 	size_t first_position;
 	size_t crc_position;
 	size_t rohc_hdr_len = 0;
+	rohc_ticks_t crc_ticks;
 	int ret;
 
 	/* parts 1 and 3:
 	 *  - part 2 will be placed at 'first_position'
 	 *  - part 4 will start at 'counter'
 	 */
-	ret = code_cid_values(context->compressor->medium.cid_type,
-	                      context->cid, rohc_remain_data, rohc_remain_len,
+	ret = code_cid_values(&context->cid_code, rohc_remain_data, rohc_remain_len,
 	                      &first_position);
 	if(ret < 1)
 	{
@@ -1919,9 +1835,10 @@ static int code_IR_packet(struct rohc_comp_ctxt *const context,
 	                   rohc_pkt, rohc_hdr_len);
 
 	/* IR(-DYN) header was successfully built, compute the CRC */
+	crc_ticks = rohc_comp_ticks(context->compressor);
 	rohc_pkt[crc_position] = crc_calculate(ROHC_CRC_TYPE_8, rohc_pkt,
-	                                       rohc_hdr_len, CRC_INIT_8,
-	                                       context->compressor->crc_table_8);
+	                                       rohc_hdr_len, CRC_INIT_8);
+	rohc_comp_crc_ticks_add(context->compressor, crc_ticks);
 	rohc_comp_debug(context, "CRC (header length = %zu, crc = 0x%x)",
 	                rohc_hdr_len, rohc_pkt[crc_position]);
 
@@ -1961,6 +1878,22 @@ static int tcp_code_static_part(struct rohc_comp_ctxt *const context,
 	size_t ip_hdr_pos;
 	int ret;
 
+	/* reuse the static chain of the previous IR packet if possible */
+	if(tcp_context->static_chain_len > 0)
+	{
+		if(rohc_pkt_max_len < tcp_context->static_chain_len)
+		{
+			rohc_comp_warn(context, "ROHC buffer too small for the static chain: "
+			               "%zu bytes required, but only %zu bytes available",
+			               tcp_context->static_chain_len, rohc_pkt_max_len);
+			goto error;
+		}
+		memcpy(rohc_pkt, tcp_context->static_chain, tcp_context->static_chain_len);
+		rohc_comp_debug(context, "reuse the %zu-byte static chain of the previous "
+		                "IR packet", tcp_context->static_chain_len);
+		return tcp_context->static_chain_len;
+	}
+
 	/* add IP parts of static chain */
 	for(ip_hdr_pos = 0; ip_hdr_pos < tcp_context->ip_contexts_nr; ip_hdr_pos++)
 	{
@@ -2065,6 +1998,13 @@ static int tcp_code_static_part(struct rohc_comp_ctxt *const context,
 		rohc_remain_len -= ret;
 	}
 
+	/* cache the static chain for the next IR packets */
+	if((rohc_pkt_max_len - rohc_remain_len) <= TCP_STATIC_CHAIN_CACHE_MAX_LEN)
+	{
+		tcp_context->static_chain_len = rohc_pkt_max_len - rohc_remain_len;
+		memcpy(tcp_context->static_chain, rohc_pkt, tcp_context->static_chain_len);
+	}
+
 	return (rohc_pkt_max_len - rohc_remain_len);
 
 error:
@@ -3427,12 +3367,29 @@ static int code_CO_packet(struct rohc_comp_ctxt *const context,
 	uint8_t save_first_byte;
 	size_t payload_size = 0;
 	uint8_t ip_inner_ecn = 0;
+	rohc_crc_type_t crc_type;
 	uint8_t crc_computed;
+	rohc_ticks_t crc_ticks;
 	size_t ip_hdr_pos;
 	int ret;
 
 	rohc_comp_debug(context, "code CO packet (CID = %zu)", context->cid);
 
+	/* the CRC on uncompressed headers is accumulated header by header while
+	 * the headers are parsed, instead of reading them once more afterwards */
+	if(packet_type == ROHC_PACKET_TCP_SEQ_8 ||
+	   packet_type == ROHC_PACKET_TCP_RND_8 ||
+	   packet_type == ROHC_PACKET_TCP_CO_COMMON)
+	{
+		crc_type = ROHC_CRC_TYPE_7;
+		crc_computed = CRC_INIT_7;
+	}
+	else
+	{
+		crc_type = ROHC_CRC_TYPE_3;
+		crc_computed = CRC_INIT_3;
+	}
+
 	/* parse the IP headers and their extension headers */
 	rohc_comp_debug(context, "parse the %zu-byte IP packet", remain_len);
 	assert(tcp_context->ip_contexts_nr > 0);
@@ -3506,6 +3463,13 @@ static int code_CO_packet(struct rohc_comp_ctxt *const context,
 			assert(0);
 			goto error;
 		}
+
+		/* the IP header and its extension headers were just read */
+		crc_ticks = rohc_comp_ticks(context->compressor);
+		crc_computed = crc_calculate(crc_type, (const uint8_t *) ip_hdr,
+		                             remain_data - ((const uint8_t *) ip_hdr),
+		                             crc_computed);
+		rohc_comp_crc_ticks_add(context->compressor, crc_ticks);
 	}
 
 	/* parse the TCP header */
@@ -3522,32 +3486,22 @@ static int code_CO_packet(struct rohc_comp_ctxt *const context,
 		*payload_offset = ((uint8_t *) tcp) + tcp_data_offset - ip->data;
 		rohc_comp_debug(context, "payload offset = %zu", *payload_offset);
 		rohc_comp_debug(context, "payload size = %zu", payload_size);
-	}
 
-	/* we have just identified the IP and TCP headers (options included), so
-	 * let's compute the CRC on uncompressed headers */
-	if(packet_type == ROHC_PACKET_TCP_SEQ_8 ||
-	   packet_type == ROHC_PACKET_TCP_RND_8 ||
-	   packet_type == ROHC_PACKET_TCP_CO_COMMON)
-	{
-		crc_computed = crc_calculate(ROHC_CRC_TYPE_7, ip->data, *payload_offset,
-		                             CRC_INIT_7, context->compressor->crc_table_7);
-		rohc_comp_debug(context, "CRC-7 on %zu-byte uncompressed header = 0x%x",
-		                *payload_offset, crc_computed);
-	}
-	else
-	{
-		crc_computed = crc_calculate(ROHC_CRC_TYPE_3, ip->data, *payload_offset,
-		                             CRC_INIT_3, context->compressor->crc_table_3);
-		rohc_comp_debug(context, "CRC-3 on %zu-byte uncompressed header = 0x%x",
-		                *payload_offset, crc_computed);
+		/* the TCP header (options included) ends the CRC on uncompressed
+		 * headers */
+		crc_ticks = rohc_comp_ticks(context->compressor);
+		crc_computed = crc_calculate(crc_type, (const uint8_t *) tcp,
+		                             tcp_data_offset, crc_computed);
+		rohc_comp_crc_ticks_add(context->compressor, crc_ticks);
 	}
+	rohc_comp_debug(context, "CRC-%d on %zu-byte uncompressed header = 0x%x",
+	                crc_type, *payload_offset, crc_computed);
 
 	/* write Add-CID or large CID bytes: 'pos_1st_byte' indicates the location
 	 * where first header byte shall be written, 'pos_2nd_byte' indicates the
 	 * location where the next header bytes shall be written */
-	ret = code_cid_values(context->compressor->medium.cid_type, context->cid,
-	                      rohc_remain_data, rohc_remain_len, &pos_1st_byte);
+	ret = code_cid_values(&context->cid_code, rohc_remain_data, rohc_remain_len,
+	                      &pos_1st_byte);
 	if(ret < 1)
 	{
 		rohc_comp_warn(context, "failed to encode %s CID %zu: maybe the "
@@ -4839,6 +4793,11 @@ static int c_tcp_build_co_common(const struct rohc_comp_ctxt *const context,
 	                             tcp_context->tmp.nr_seq_bits_63,
 	                             tcp_context->tmp.nr_seq_bits_16383,
 	                             co_common_opt, rohc_remain_len, &indicator);
+	if(ret < 0)
+	{
+		rohc_comp_warn(context, "failed to encode variable_length_32(seq_number)");
+		goto error;
+	}
 	co_common->seq_indicator = indicator;
 	encoded_seq_len = ret;
 	co_common_opt += encoded_seq_len;
@@ -4854,6 +4813,11 @@ static int c_tcp_build_co_common(const struct rohc_comp_ctxt *const context,
 	                             tcp_context->tmp.nr_ack_bits_63,
 	                             tcp_context->tmp.nr_ack_bits_16383,
 	                             co_common_opt, rohc_remain_len, &indicator);
+	if(ret < 0)
+	{
+		rohc_comp_warn(context, "failed to encode variable_length_32(ack_number)");
+		goto error;
+	}
 	co_common->ack_indicator = indicator;
 	encoded_ack_len = ret;
 	co_common_opt += encoded_ack_len;
@@ -4886,7 +4850,7 @@ static int c_tcp_build_co_common(const struct rohc_comp_ctxt *const context,
 	}
 
 	/* window */
-	ret = c_static_or_irreg16(tcp->window, !tcp_context->tmp.tcp_window_changed,
+	ret = c_static_or_irreg16(tcp->window, !tcp_is_field_changed(tcp_context, TCP_FIELD_WINDOW),
 	                          co_common_opt, rohc_remain_len, &indicator);
 	if(ret < 0)
 	{
@@ -5115,123 +5079,83 @@ static bool tcp_detect_changes(struct rohc_comp_ctxt *const context,
                                const struct tcphdr **const tcp)
 {
 	struct sc_tcp_context *const tcp_context = context->specific;
-	const uint8_t *remain_data = uncomp_pkt->outer_ip.data;
-	size_t remain_len = uncomp_pkt->outer_ip.size;
+	const struct net_pkt_hdr *const tcp_hdr =
+		&(uncomp_pkt->hdrs[uncomp_pkt->hdrs_nr - 1]);
 
 	const uint8_t *inner_ip_hdr = NULL;
 	ip_version inner_ip_version = IP_UNKNOWN;
 
 	size_t ip_hdrs_nr;
+	size_t hdr_pos;
 	size_t hdrs_len;
-	uint8_t protocol;
 	size_t opts_len;
 	bool pkt_outer_dscp_changed;
 	bool last_pkt_outer_dscp_changed;
 	uint8_t pkt_ecn_vals;
 
-	/* no IPv6 extension got its static or dynamic parts changed at the beginning */
-	tcp_context->tmp.is_ipv6_exts_list_static_changed = false;
-	tcp_context->tmp.is_ipv6_exts_list_dyn_changed = false;
+	/* the descriptor of the packet was checked while checking the profile */
+	assert(uncomp_pkt->hdrs_nr > 0);
+	assert(tcp_hdr->proto == ROHC_IPPROTO_TCP);
+
+	/* no field changed at the beginning */
+	tcp_context->tmp.changed_fields = 0;
 
-	hdrs_len = 0;
 	pkt_outer_dscp_changed = 0;
 	last_pkt_outer_dscp_changed = false;
 	pkt_ecn_vals = 0;
 	ip_hdrs_nr = 0;
-	do
+	hdr_pos = 0;
+	while(rohc_is_tunneling(uncomp_pkt->hdrs[hdr_pos].proto))
 	{
-		const struct ip_hdr *const ip = (struct ip_hdr *) remain_data;
+		const uint8_t *const ip_data =
+			uncomp_pkt->data + uncomp_pkt->hdrs[hdr_pos].offset;
+		const struct ip_hdr *const ip = (struct ip_hdr *) ip_data;
 		ip_context_t *const ip_context = &(tcp_context->ip_contexts[ip_hdrs_nr]);
 
-		assert(remain_len >= sizeof(struct ip_hdr));
 		rohc_comp_debug(context, "found IPv%d header #%zu",
 		                ip->version, ip_hdrs_nr + 1);
 
 		pkt_outer_dscp_changed =
 			!!(pkt_outer_dscp_changed || last_pkt_outer_dscp_changed);
-		inner_ip_hdr = remain_data;
+		inner_ip_hdr = ip_data;
 		inner_ip_version = ip->version;
 		*ip_inner_ctxt = ip_context;
 
 		if(ip->version == IPV4)
 		{
-			const struct ipv4_hdr *const ipv4 = (struct ipv4_hdr *) remain_data;
+			const struct ipv4_hdr *const ipv4 = (struct ipv4_hdr *) ip_data;
 
-			if(remain_len < sizeof(struct ipv4_hdr))
-			{
-				rohc_comp_warn(context, "not enough data for IPv4 header #%zu",
-				               ip_hdrs_nr + 1);
-				goto error;
-			}
-
-			protocol = ipv4->protocol;
 			last_pkt_outer_dscp_changed = !!(ipv4->dscp != ip_context->ctxt.vx.dscp);
 			pkt_ecn_vals |= ipv4->ecn;
-
-			remain_data += sizeof(struct ipv4_hdr);
-			remain_len -= sizeof(struct ipv4_hdr);
-			hdrs_len += sizeof(struct ipv4_hdr);
+			hdr_pos++;
 		}
-		else if(ip->version == IPV6)
+		else
 		{
-			const struct ipv6_hdr *const ipv6 = (struct ipv6_hdr *) remain_data;
 			uint8_t dscp;
 			size_t exts_nr;
-			size_t exts_len;
 
-			if(remain_len < sizeof(struct ipv6_hdr))
-			{
-				rohc_comp_warn(context, "not enough data for IPv6 header #%zu",
-				               ip_hdrs_nr + 1);
-				goto error;
-			}
+			assert(ip->version == IPV6);
 
-			protocol = ipv6->nh;
-			dscp = (remain_data[1] >> 2) & 0x3f;
+			dscp = (ip_data[1] >> 2) & 0x3f;
 			last_pkt_outer_dscp_changed = !!(dscp != ip_context->ctxt.vx.dscp);
-			pkt_ecn_vals |= remain_data[1] & 0x3;
+			pkt_ecn_vals |= ip_data[1] & 0x3;
+			hdr_pos++;
 
-			remain_data += sizeof(struct ipv6_hdr);
-			remain_len -= sizeof(struct ipv6_hdr);
-			hdrs_len += sizeof(struct ipv6_hdr);
-
-			if(!tcp_detect_changes_ipv6_exts(context, ip_context, &protocol,
-			                                 remain_data, remain_len,
-			                                 &exts_nr, &exts_len))
-			{
-				rohc_comp_warn(context, "failed to detect changes in IPv6 extension headers");
-				goto error;
-			}
-			remain_data += exts_len;
-			remain_len -= exts_len;
+			tcp_detect_changes_ipv6_exts(context, ip_context, uncomp_pkt,
+			                             &hdr_pos, &exts_nr);
 			tcp_context->tmp.ip_exts_nr[ip_hdrs_nr] = exts_nr;
-			hdrs_len += exts_len;
-		}
-		else
-		{
-			rohc_comp_warn(context, "unknown IP header with version %u", ip->version);
-			goto error;
 		}
 		rohc_comp_debug(context, "  DSCP did%s change",
 		                last_pkt_outer_dscp_changed ? "" : "n't");
 
 		ip_hdrs_nr++;
 	}
-	while(protocol != ROHC_IPPROTO_TCP && hdrs_len < uncomp_pkt->outer_ip.size);
+	assert(ip_hdrs_nr == tcp_context->ip_contexts_nr);
 
 	/* next header is the TCP header */
-	if(remain_len < sizeof(struct tcphdr))
-	{
-		rohc_comp_warn(context, "not enough data for TCP header");
-		goto error;
-	}
-	*tcp = (struct tcphdr *) remain_data;
+	assert(hdr_pos == (uncomp_pkt->hdrs_nr - 1));
+	*tcp = (struct tcphdr *) (uncomp_pkt->data + tcp_hdr->offset);
 	pkt_ecn_vals |= (*tcp)->ecn_flags;
-#ifndef __clang_analyzer__ /* silent warning about dead in/decrement */
-	remain_data += sizeof(struct tcphdr);
-	remain_len -= sizeof(struct tcphdr);
-#endif
-	hdrs_len += sizeof(struct tcphdr);
 
 	/* parse TCP options for changes */
 	if(!tcp_detect_options_changes(context, *tcp, &tcp_context->tcp_opts, &opts_len))
@@ -5242,11 +5166,7 @@ static bool tcp_detect_changes(struct rohc_comp_ctxt *const context,
 	}
 	rohc_comp_debug(context, "%zu bytes of TCP options successfully parsed",
 	                opts_len);
-#ifndef __clang_analyzer__ /* silent warning about dead in/decrement */
-	remain_data += opts_len;
-	remain_len -= opts_len;
-#endif
-	hdrs_len += opts_len;
+	hdrs_len = tcp_hdr->offset + sizeof(struct tcphdr) + opts_len;
 
 	/* what value for ecn_used? */
 	tcp_detect_ecn_used_behavior(context, pkt_ecn_vals, pkt_outer_dscp_changed,
@@ -5271,7 +5191,8 @@ static bool tcp_detect_changes(struct rohc_comp_ctxt *const context,
 		else
 		{
 			(*ip_inner_ctxt)->ctxt.v4.ip_id_behavior =
-				tcp_detect_ip_id_behavior((*ip_inner_ctxt)->ctxt.v4.last_ip_id, ip_id);
+				tcp_detect_ip_id_behavior((*ip_inner_ctxt)->ctxt.v4.ip_id_behavior,
+				                          (*ip_inner_ctxt)->ctxt.v4.last_ip_id, ip_id);
 		}
 		rohc_comp_debug(context, "IP-ID now behaves as %s",
 		                tcp_ip_id_behavior_get_descr((*ip_inner_ctxt)->ctxt.v4.ip_id_behavior));
@@ -5297,58 +5218,41 @@ error:
 /**
  * @brief Detect changes about IPv6 extension headers between packet and context
  *
- * @param context           The compression context to compare
- * @param ip_context        The specific IP compression context
- * @param[in,out] protocol  in: the protocol type of the first extension header
- *                          out: the protocol type of the transport header
- * @param exts              The beginning of the IPv6 extension headers
- * @param max_exts_len      The maximum length (in bytes) of the extension headers
- * @param[out] exts_nr      The number of IPv6 extension headers
- * @param[out] exts_len     The length (in bytes) of the IPv6 extension headers
- * @return                  true if changes were successfully detected,
- *                          false if a problem occurred
+ * @param context          The compression context to compare
+ * @param ip_context       The specific IP compression context
+ * @param uncomp_pkt       The uncompressed packet to compare
+ * @param[in,out] hdr_pos  in: the position of the first extension header in
+ *                             the packet descriptor
+ *                         out: the position of the header that follows the
+ *                              extension headers
+ * @param[out] exts_nr     The number of IPv6 extension headers
  */
-static bool tcp_detect_changes_ipv6_exts(struct rohc_comp_ctxt *const context,
+static void tcp_detect_changes_ipv6_exts(struct rohc_comp_ctxt *const context,
                                          ip_context_t *const ip_context,
-                                         uint8_t *const protocol,
-                                         const uint8_t *const exts,
-                                         const size_t max_exts_len,
-                                         size_t *const exts_nr,
-                                         size_t *const exts_len)
+                                         const struct net_pkt *const uncomp_pkt,
+                                         size_t *const hdr_pos,
+                                         size_t *const exts_nr)
 {
 	struct sc_tcp_context *const tcp_context = context->specific;
-	const uint8_t *remain_data = exts;
-	size_t remain_len = max_exts_len;
 	size_t ext_pos;
 
 	(*exts_nr) = 0;
-	(*exts_len) = 0;
 
-	for(ext_pos = 0;
-	    rohc_is_ipv6_opt(*protocol) && ext_pos < ROHC_TCP_MAX_IP_EXT_HDRS;
-	    ext_pos++)
+	for(ext_pos = 0; rohc_is_ipv6_opt(uncomp_pkt->hdrs[*hdr_pos].proto); ext_pos++)
 	{
+		const struct net_pkt_hdr *const ext_hdr = &(uncomp_pkt->hdrs[*hdr_pos]);
+		const uint8_t protocol = ext_hdr->proto;
+		const struct ipv6_opt *const ext =
+			(struct ipv6_opt *) (uncomp_pkt->data + ext_hdr->offset);
+		const size_t ext_len = ext_hdr->len;
 		ip_option_context_t *const opt_ctxt = &(ip_context->opts[ext_pos]);
-		const struct ipv6_opt *const ext = (struct ipv6_opt *) remain_data;
-		size_t ext_len;
 
-		rohc_comp_debug(context, "  found IP extension header %u", *protocol);
-
-		if(remain_len < (sizeof(struct ipv6_opt) - 1))
-		{
-			rohc_comp_warn(context, "malformed IPv6 extension header: remaining "
-			               "data too small for minimal IPv6 header");
-			goto error;
-		}
-		ext_len = ipv6_opt_get_length(ext);
-		if(remain_len < ext_len)
-		{
-			rohc_comp_warn(context, "malformed IPv6 extension header: remaining "
-			               "data too small for IPv6 header");
-			goto error;
-		}
+		/* the descriptor and the number of extension headers were already
+		 * checked while checking the profile */
+		assert(ext_pos < ROHC_TCP_MAX_IP_EXT_HDRS);
+		rohc_comp_debug(context, "  found IP extension header %u", protocol);
 
-		switch(*protocol)
+		switch(protocol)
 		{
 			case ROHC_IPPROTO_HOPOPTS: /* IPv6 Hop-by-Hop option */
 			case ROHC_IPPROTO_ROUTING: /* IPv6 routing header */
@@ -5360,8 +5264,8 @@ static bool tcp_detect_changes_ipv6_exts(struct rohc_comp_ctxt *const context,
 				if(context->num_sent_packets == 0 ||
 				   ext_pos >= ip_context->opts_nr)
 				{
-					rohc_comp_debug(context, "  IPv6 option %u is new", *protocol);
-					tcp_context->tmp.is_ipv6_exts_list_static_changed = true;
+					rohc_comp_debug(context, "  IPv6 option %u is new", protocol);
+					tcp_context->tmp.changed_fields |= TCP_FIELD_IPV6_EXTS_STATIC;
 
 					/* record option in context */
 					/* TODO: should not update context there */
@@ -5372,9 +5276,9 @@ static bool tcp_detect_changes_ipv6_exts(struct rohc_comp_ctxt *const context,
 				else if(ext_len != opt_ctxt->generic.option_length)
 				{
 					rohc_comp_debug(context, "  IPv6 option %u changed of length "
-					                "(%zu -> %zu bytes)", *protocol,
+					                "(%zu -> %zu bytes)", protocol,
 					                opt_ctxt->generic.option_length, ext_len);
-					tcp_context->tmp.is_ipv6_exts_list_static_changed = true;
+					tcp_context->tmp.changed_fields |= TCP_FIELD_IPV6_EXTS_STATIC;
 
 					/* record option in context */
 					/* TODO: should not update context there */
@@ -5384,14 +5288,14 @@ static bool tcp_detect_changes_ipv6_exts(struct rohc_comp_ctxt *const context,
 				else if(memcmp(ext->value, opt_ctxt->generic.data, ext_len - 2) != 0)
 				{
 					rohc_comp_debug(context, "  IPv6 option %u changed of content",
-					                *protocol);
-					if((*protocol) == ROHC_IPPROTO_ROUTING)
+					                protocol);
+					if(protocol == ROHC_IPPROTO_ROUTING)
 					{
-						tcp_context->tmp.is_ipv6_exts_list_static_changed = true;
+						tcp_context->tmp.changed_fields |= TCP_FIELD_IPV6_EXTS_STATIC;
 					}
 					else
 					{
-						tcp_context->tmp.is_ipv6_exts_list_dyn_changed = true;
+						tcp_context->tmp.changed_fields |= TCP_FIELD_IPV6_EXTS_DYN;
 					}
 
 					/* record option in context */
@@ -5402,7 +5306,14 @@ static bool tcp_detect_changes_ipv6_exts(struct rohc_comp_ctxt *const context,
 				else
 				{
 					rohc_comp_debug(context, "  IPv6 option %u did not change",
-					                *protocol);
+					                protocol);
+				}
+
+				/* the cached static chain holds the Next Header field of the option */
+				if(ext->next_header != opt_ctxt->generic.next_header)
+				{
+					opt_ctxt->generic.next_header = ext->next_header;
+					tcp_context->static_chain_len = 0;
 				}
 				break;
 			case ROHC_IPPROTO_GRE:  /* TODO: GRE not yet supported */
@@ -5412,15 +5323,9 @@ static bool tcp_detect_changes_ipv6_exts(struct rohc_comp_ctxt *const context,
 				assert(0);
 				break;
 		}
-		(*protocol) = ext->next_header;
-
-		remain_data += ext_len;
-		remain_len -= ext_len;
-
+		(*hdr_pos)++;
 		(*exts_nr)++;
-		(*exts_len) += ext_len;
 	}
-	assert(!rohc_is_ipv6_opt(*protocol));
 	assert((*exts_nr) <= ROHC_TCP_MAX_IP_EXT_HDRS);
 
 	/* more or less IP extension headers than previous packet? */
@@ -5428,21 +5333,22 @@ static bool tcp_detect_changes_ipv6_exts(struct rohc_comp_ctxt *const context,
 	{
 		rohc_comp_debug(context, "  less IP extension headers (%zu) than "
 		                "context (%zu)", *exts_nr, ip_context->opts_nr);
-		tcp_context->tmp.is_ipv6_exts_list_static_changed = true;
+		tcp_context->tmp.changed_fields |= TCP_FIELD_IPV6_EXTS_STATIC;
 	}
 	else if((*exts_nr) > ip_context->opts_nr)
 	{
 		rohc_comp_debug(context, "  more IP extension headers (%zu+) than "
 		                "context (%zu)", *exts_nr, ip_context->opts_nr);
-		tcp_context->tmp.is_ipv6_exts_list_static_changed = true;
+		tcp_context->tmp.changed_fields |= TCP_FIELD_IPV6_EXTS_STATIC;
 	}
 
-	if(tcp_context->tmp.is_ipv6_exts_list_static_changed)
+	if(tcp_is_field_changed(tcp_context, TCP_FIELD_IPV6_EXTS_STATIC))
 	{
 		rohc_comp_debug(context, "  IPv6 extension headers changed too much, static "
 		                "chain is required");
+		tcp_context->static_chain_len = 0;
 	}
-	else if(tcp_context->tmp.is_ipv6_exts_list_dyn_changed)
+	else if(tcp_is_field_changed(tcp_context, TCP_FIELD_IPV6_EXTS_DYN))
 	{
 		rohc_comp_debug(context, "  IPv6 extension headers changed too much, dynamic "
 		                "chain is required");
@@ -5452,11 +5358,6 @@ static bool tcp_detect_changes_ipv6_exts(struct rohc_comp_ctxt *const context,
 		rohc_comp_debug(context, "  IPv6 extension headers did not change too much, "
 		                "neither static nor dynamic chain is required");
 	}
-
-	return true;
-
-error:
-	return false;
 }
 
 
@@ -5476,6 +5377,39 @@ static uint16_t c_tcp_get_next_msn(const struct rohc_comp_ctxt *const context)
 }
 
 
+/**
+ * @brief Get the MSN of the last packet compressed with the given context
+ *
+ * @param context  The compression context
+ * @return         The MSN of the last compressed packet
+ */
+static uint32_t c_tcp_get_msn(const struct rohc_comp_ctxt *const context)
+{
+	const struct sc_tcp_context *const tcp_context = context->specific;
+
+	return tcp_context->msn;
+}
+
+
+/**
+ * @brief Make the next packet compressed with the given context get the
+ *        given MSN
+ *
+ * The MSN is the one that precedes the given MSN according to
+ * \ref c_tcp_get_next_msn.
+ *
+ * @param context  The compression context
+ * @param msn      The MSN of the next compressed packet
+ */
+static void c_tcp_set_next_msn(struct rohc_comp_ctxt *const context,
+                               const uint32_t msn)
+{
+	struct sc_tcp_context *const tcp_context = context->specific;
+
+	tcp_context->msn = ((msn & 0xffff) + 0xffff - 1) % 0xffff;
+}
+
+
 /**
  * @brief Decide the state that should be used for the next packet.
  *
@@ -5497,13 +5431,13 @@ static void tcp_decide_state(struct rohc_comp_ctxt *const context)
 		{
 			rohc_comp_debug(context, "no enough packets transmitted in IR state "
 			                "for the moment (%zu/%d), so stay in IR state",
-			                context->ir_count, MAX_IR_COUNT);
+			                (size_t) context->ir_count, MAX_IR_COUNT);
 			next_state = ROHC_COMP_STATE_IR;
 		}
 		else
 		{
 			rohc_comp_debug(context, "enough packets transmitted in IR state (%zu/%u), "
-			                "go to SO state", context->ir_count, MAX_IR_COUNT);
+			                "go to SO state", (size_t) context->ir_count, MAX_IR_COUNT);
 			next_state = ROHC_COMP_STATE_SO;
 		}
 	}
@@ -5513,13 +5447,13 @@ static void tcp_decide_state(struct rohc_comp_ctxt *const context)
 		{
 			rohc_comp_debug(context, "no enough packets transmitted in FO state "
 			                "for the moment (%zu/%u), so stay in FO state",
-			                context->fo_count, MAX_FO_COUNT);
+			                (size_t) context->fo_count, MAX_FO_COUNT);
 			next_state = ROHC_COMP_STATE_FO;
 		}
 		else
 		{
 			rohc_comp_debug(context, "enough packets transmitted in FO state (%zu/%u), "
-			                "go to SO state", context->fo_count, MAX_FO_COUNT);
+			                "go to SO state", (size_t) context->fo_count, MAX_FO_COUNT);
 			next_state = ROHC_COMP_STATE_SO;
 		}
 	}
@@ -5564,12 +5498,13 @@ static bool tcp_encode_uncomp_fields(struct rohc_comp_ctxt *const context,
 
 	/* how many bits are required to encode the new SN ? */
 	tcp_context->tmp.nr_msn_bits =
-		wlsb_get_k_16bits(tcp_context->msn_wlsb, tcp_context->msn);
+		wlsb_get_k_16bits(&tcp_context->msn_wlsb, tcp_context->msn);
 	rohc_comp_debug(context, "%zu bits are required to encode new MSN 0x%04x",
 	                tcp_context->tmp.nr_msn_bits, tcp_context->msn);
+	context->sn_bits_nr = tcp_context->tmp.nr_msn_bits;
 	/* add the new MSN to the W-LSB encoding object */
 	/* TODO: move this after successful packet compression */
-	c_add_wlsb(tcp_context->msn_wlsb, tcp_context->msn, tcp_context->msn);
+	c_add_wlsb(&tcp_context->msn_wlsb, tcp_context->msn, tcp_context->msn);
 
 	if(!tcp_encode_uncomp_ip_fields(context, uncomp_pkt))
 	{
@@ -5710,10 +5645,11 @@ static bool tcp_encode_uncomp_ip_fields(struct rohc_comp_ctxt *const context,
 		}
 	}
 
-	tcp_context->tmp.outer_ip_ttl_changed =
-		(tcp_context->tmp.ttl_irreg_chain_flag != 0);
+	tcp_field_set_changed(tcp_context, TCP_FIELD_OUTER_TTL_HOPL,
+	                      tcp_context->tmp.ttl_irreg_chain_flag != 0);
 	tcp_field_descr_change(context, "one or more outer TTL values",
-	                       tcp_context->tmp.outer_ip_ttl_changed, 0);
+	                       tcp_is_field_changed(tcp_context, TCP_FIELD_OUTER_TTL_HOPL),
+	                       0);
 
 	if(inner_ip_version == IPV4)
 	{
@@ -5721,10 +5657,12 @@ static bool tcp_encode_uncomp_ip_fields(struct rohc_comp_ctxt *const context,
 		const uint16_t ip_id = rohc_ntoh16(inner_ipv4->id);
 
 		/* does IP-ID behavior changed? */
-		tcp_context->tmp.ip_id_behavior_changed =
-			(inner_ip_ctxt->ctxt.v4.last_ip_id_behavior != inner_ip_ctxt->ctxt.v4.ip_id_behavior);
+		tcp_field_set_changed(tcp_context, TCP_FIELD_IP_ID_BEHAVIOR,
+		                      inner_ip_ctxt->ctxt.v4.last_ip_id_behavior !=
+		                      inner_ip_ctxt->ctxt.v4.ip_id_behavior);
 		tcp_field_descr_change(context, "IP-ID behavior",
-		                       tcp_context->tmp.ip_id_behavior_changed, 0);
+		                       tcp_is_field_changed(tcp_context, TCP_FIELD_IP_ID_BEHAVIOR),
+		                       0);
 
 		/* compute the new IP-ID / SN delta */
 		if(inner_ip_ctxt->ctxt.v4.ip_id_behavior == IP_ID_BEHAVIOR_SEQ)
@@ -5760,14 +5698,14 @@ static bool tcp_encode_uncomp_ip_fields(struct rohc_comp_ctxt *const context,
 		{
 			/* send only required bits in FO or SO states */
 			tcp_context->tmp.nr_ip_id_bits_3 =
-				wlsb_get_kp_16bits(tcp_context->ip_id_wlsb,
+				wlsb_get_kp_16bits(&tcp_context->ip_id_wlsb,
 				                   tcp_context->tmp.ip_id_delta, 3);
 			rohc_comp_debug(context, "%zu bits are required to encode new innermost "
 			                "IP-ID delta 0x%04x with p = 3",
 			                tcp_context->tmp.nr_ip_id_bits_3,
 			                tcp_context->tmp.ip_id_delta);
 			tcp_context->tmp.nr_ip_id_bits_1 =
-				wlsb_get_kp_16bits(tcp_context->ip_id_wlsb,
+				wlsb_get_kp_16bits(&tcp_context->ip_id_wlsb,
 				                   tcp_context->tmp.ip_id_delta, 1);
 			rohc_comp_debug(context, "%zu bits are required to encode new innermost "
 			                "IP-ID delta 0x%04x with p = 1",
@@ -5776,16 +5714,18 @@ static bool tcp_encode_uncomp_ip_fields(struct rohc_comp_ctxt *const context,
 		}
 		/* add the new IP-ID / SN delta to the W-LSB encoding object */
 		/* TODO: move this after successful packet compression */
-		c_add_wlsb(tcp_context->ip_id_wlsb, tcp_context->msn,
+		c_add_wlsb(&tcp_context->ip_id_wlsb, tcp_context->msn,
 		           tcp_context->tmp.ip_id_delta);
 
-		tcp_context->tmp.ip_df_changed =
-			!!(inner_ipv4->df != inner_ip_ctxt->ctxt.v4.df);
-		tcp_field_descr_change(context, "DF", tcp_context->tmp.ip_df_changed, 0);
+		tcp_field_set_changed(tcp_context, TCP_FIELD_IP_DF,
+		                      inner_ipv4->df != inner_ip_ctxt->ctxt.v4.df);
+		tcp_field_descr_change(context, "DF",
+		                       tcp_is_field_changed(tcp_context, TCP_FIELD_IP_DF), 0);
 
-		tcp_context->tmp.dscp_changed =
-			!!(inner_ipv4->dscp != inner_ip_ctxt->ctxt.v4.dscp);
-		tcp_field_descr_change(context, "DSCP", tcp_context->tmp.dscp_changed, 0);
+		tcp_field_set_changed(tcp_context, TCP_FIELD_DSCP,
+		                      inner_ipv4->dscp != inner_ip_ctxt->ctxt.v4.dscp);
+		tcp_field_descr_change(context, "DSCP",
+		                       tcp_is_field_changed(tcp_context, TCP_FIELD_DSCP), 0);
 
 		tcp_context->tmp.ttl_hopl = inner_ipv4->ttl;
 	}
@@ -5795,15 +5735,17 @@ static bool tcp_encode_uncomp_ip_fields(struct rohc_comp_ctxt *const context,
 
 		/* no IP-ID for IPv6 */
 		tcp_context->tmp.ip_id_delta = 0;
-		tcp_context->tmp.ip_id_behavior_changed = false;
 		tcp_context->tmp.nr_ip_id_bits_3 = 0;
 		tcp_context->tmp.nr_ip_id_bits_1 = 0;
 
-		tcp_context->tmp.ip_df_changed = false; /* no DF for IPv6 */
+		/* no IP-ID behavior nor DF for IPv6 */
+		tcp_field_set_changed(tcp_context, TCP_FIELD_IP_ID_BEHAVIOR, false);
+		tcp_field_set_changed(tcp_context, TCP_FIELD_IP_DF, false);
 
-		tcp_context->tmp.dscp_changed =
-			!!(ipv6_get_dscp(inner_ipv6) != inner_ip_ctxt->ctxt.v6.dscp);
-		tcp_field_descr_change(context, "DSCP", tcp_context->tmp.dscp_changed, 0);
+		tcp_field_set_changed(tcp_context, TCP_FIELD_DSCP,
+		                      ipv6_get_dscp(inner_ipv6) != inner_ip_ctxt->ctxt.v6.dscp);
+		tcp_field_descr_change(context, "DSCP",
+		                       tcp_is_field_changed(tcp_context, TCP_FIELD_DSCP), 0);
 
 		tcp_context->tmp.ttl_hopl = inner_ipv6->hl;
 	}
@@ -5811,27 +5753,27 @@ static bool tcp_encode_uncomp_ip_fields(struct rohc_comp_ctxt *const context,
 	/* encode innermost IPv4 TTL or IPv6 Hop Limit */
 	if(tcp_context->tmp.ttl_hopl != inner_ip_ctxt->ctxt.vx.ttl_hopl)
 	{
-		tcp_context->tmp.ttl_hopl_changed = true;
+		tcp_field_set_changed(tcp_context, TCP_FIELD_TTL_HOPL, true);
 		tcp_context->ttl_hopl_change_count = 0;
 	}
 	else if(tcp_context->ttl_hopl_change_count < MAX_FO_COUNT)
 	{
-		tcp_context->tmp.ttl_hopl_changed = true;
+		tcp_field_set_changed(tcp_context, TCP_FIELD_TTL_HOPL, true);
 		tcp_context->ttl_hopl_change_count++;
 	}
 	else
 	{
-		tcp_context->tmp.ttl_hopl_changed = false;
+		tcp_field_set_changed(tcp_context, TCP_FIELD_TTL_HOPL, false);
 	}
 	tcp_context->tmp.nr_ttl_hopl_bits =
-		wlsb_get_k_8bits(tcp_context->ttl_hopl_wlsb, tcp_context->tmp.ttl_hopl);
+		wlsb_get_k_8bits(&tcp_context->ttl_hopl_wlsb, tcp_context->tmp.ttl_hopl);
 	rohc_comp_debug(context, "%zu bits are required to encode new innermost "
 	                "TTL/Hop Limit 0x%02x with p = 3",
 	                tcp_context->tmp.nr_ttl_hopl_bits,
 	                tcp_context->tmp.ttl_hopl);
 	/* add the new TTL/Hop Limit to the W-LSB encoding object */
 	/* TODO: move this after successful packet compression */
-	c_add_wlsb(tcp_context->ttl_hopl_wlsb, tcp_context->msn,
+	c_add_wlsb(&tcp_context->ttl_hopl_wlsb, tcp_context->msn,
 	           tcp_context->tmp.ttl_hopl);
 
 	return true;
@@ -5872,19 +5814,21 @@ static bool tcp_encode_uncomp_tcp_fields(struct rohc_comp_ctxt *const context,
 	                rohc_ntoh16(tcp->window), rohc_ntoh16(tcp->checksum),
 	                rohc_ntoh16(tcp->urg_ptr));
 
-	tcp_context->tmp.tcp_ack_flag_changed =
-		(tcp->ack_flag != tcp_context->old_tcphdr.ack_flag);
+	tcp_field_set_changed(tcp_context, TCP_FIELD_ACK_FLAG,
+	                      tcp->ack_flag != tcp_context->old_tcphdr.ack_flag);
 	tcp_field_descr_change(context, "ACK flag",
-	                       tcp_context->tmp.tcp_ack_flag_changed, 0);
-	tcp_context->tmp.tcp_urg_flag_present = (tcp->urg_flag != 0);
+	                       tcp_is_field_changed(tcp_context, TCP_FIELD_ACK_FLAG), 0);
+	tcp_field_set_changed(tcp_context, TCP_FIELD_URG_FLAG_SET, tcp->urg_flag != 0);
 	tcp_field_descr_present(context, "URG flag",
-	                        tcp_context->tmp.tcp_urg_flag_present);
-	tcp_context->tmp.tcp_urg_flag_changed =
-		(tcp->urg_flag != tcp_context->old_tcphdr.urg_flag);
+	                        tcp_is_field_changed(tcp_context, TCP_FIELD_URG_FLAG_SET));
+	tcp_field_set_changed(tcp_context, TCP_FIELD_URG_FLAG,
+	                      tcp->urg_flag != tcp_context->old_tcphdr.urg_flag);
 	tcp_field_descr_change(context, "URG flag",
-	                       tcp_context->tmp.tcp_urg_flag_changed, 0);
+	                       tcp_is_field_changed(tcp_context, TCP_FIELD_URG_FLAG), 0);
+	tcp_field_set_changed(tcp_context, TCP_FIELD_URG_PTR,
+	                      tcp->urg_ptr != tcp_context->old_tcphdr.urg_ptr);
 	tcp_field_descr_change(context, "ECN flag",
-	                       tcp_context->tmp.ecn_used_changed,
+	                       tcp_is_field_changed(tcp_context, TCP_FIELD_ECN_USED),
 	                       tcp_context->ecn_used_change_count);
 	if(tcp->rsf_flags != 0)
 	{
@@ -5894,28 +5838,29 @@ static bool tcp_encode_uncomp_tcp_fields(struct rohc_comp_ctxt *const context,
 	/* how many bits are required to encode the new TCP window? */
 	if(tcp->window != tcp_context->old_tcphdr.window)
 	{
-		tcp_context->tmp.tcp_window_changed = true;
+		tcp_field_set_changed(tcp_context, TCP_FIELD_WINDOW, true);
 		tcp_context->tcp_window_change_count = 0;
 	}
 	else if(tcp_context->tcp_window_change_count < MAX_FO_COUNT)
 	{
-		tcp_context->tmp.tcp_window_changed = true;
+		tcp_field_set_changed(tcp_context, TCP_FIELD_WINDOW, true);
 		tcp_context->tcp_window_change_count++;
 	}
 	else
 	{
-		tcp_context->tmp.tcp_window_changed = false;
+		tcp_field_set_changed(tcp_context, TCP_FIELD_WINDOW, false);
 	}
-	tcp_field_descr_change(context, "TCP window", tcp_context->tmp.tcp_window_changed,
+	tcp_field_descr_change(context, "TCP window",
+	                       tcp_is_field_changed(tcp_context, TCP_FIELD_WINDOW),
 	                       tcp_context->tcp_window_change_count);
 	tcp_context->tmp.nr_window_bits_16383 =
-		wlsb_get_kp_16bits(tcp_context->window_wlsb, rohc_ntoh16(tcp->window),
+		wlsb_get_kp_16bits(&tcp_context->window_wlsb, rohc_ntoh16(tcp->window),
 		                   ROHC_LSB_SHIFT_TCP_WINDOW);
 	rohc_comp_debug(context, "%zu bits are required to encode new TCP window "
 	                "0x%04x with p = %d", tcp_context->tmp.nr_window_bits_16383,
 	                rohc_ntoh16(tcp->window), ROHC_LSB_SHIFT_TCP_WINDOW);
 	/* TODO: move this after successful packet compression */
-	c_add_wlsb(tcp_context->window_wlsb, tcp_context->msn, rohc_ntoh16(tcp->window));
+	c_add_wlsb(&tcp_context->window_wlsb, tcp_context->msn, rohc_ntoh16(tcp->window));
 
 	/* compute new scaled TCP sequence number */
 	{
@@ -6032,30 +5977,30 @@ static bool tcp_encode_uncomp_tcp_fields(struct rohc_comp_ctxt *const context,
 	}
 
 	/* how many bits are required to encode the new sequence number? */
-	tcp_context->tmp.tcp_seq_num_changed =
-		(tcp->seq_num != tcp_context->old_tcphdr.seq_num);
+	tcp_field_set_changed(tcp_context, TCP_FIELD_SEQ_NUM,
+	                      tcp->seq_num != tcp_context->old_tcphdr.seq_num);
 	tcp_context->tmp.nr_seq_bits_65535 =
-		wlsb_get_kp_32bits(tcp_context->seq_wlsb, seq_num_hbo, 65535);
+		wlsb_get_kp_32bits(&tcp_context->seq_wlsb, seq_num_hbo, 65535);
 	rohc_comp_debug(context, "%zd bits are required to encode new sequence "
 	                "number 0x%08x with p = 65535",
 	                tcp_context->tmp.nr_seq_bits_65535, seq_num_hbo);
 	tcp_context->tmp.nr_seq_bits_32767 =
-		wlsb_get_kp_32bits(tcp_context->seq_wlsb, seq_num_hbo, 32767);
+		wlsb_get_kp_32bits(&tcp_context->seq_wlsb, seq_num_hbo, 32767);
 	rohc_comp_debug(context, "%zd bits are required to encode new sequence "
 	                "number 0x%08x with p = 32767",
 	                tcp_context->tmp.nr_seq_bits_32767, seq_num_hbo);
 	tcp_context->tmp.nr_seq_bits_16383 =
-		wlsb_get_kp_32bits(tcp_context->seq_wlsb, seq_num_hbo, 16383);
+		wlsb_get_kp_32bits(&tcp_context->seq_wlsb, seq_num_hbo, 16383);
 	rohc_comp_debug(context, "%zd bits are required to encode new sequence "
 	                "number 0x%08x with p = 16383",
 	                tcp_context->tmp.nr_seq_bits_16383, seq_num_hbo);
 	tcp_context->tmp.nr_seq_bits_8191 =
-		wlsb_get_kp_32bits(tcp_context->seq_wlsb, seq_num_hbo, 8191);
+		wlsb_get_kp_32bits(&tcp_context->seq_wlsb, seq_num_hbo, 8191);
 	rohc_comp_debug(context, "%zd bits are required to encode new sequence "
 	                "number 0x%08x with p = 8191",
 	                tcp_context->tmp.nr_seq_bits_8191, seq_num_hbo);
 	tcp_context->tmp.nr_seq_bits_63 =
-		wlsb_get_kp_32bits(tcp_context->seq_wlsb, seq_num_hbo, 63);
+		wlsb_get_kp_32bits(&tcp_context->seq_wlsb, seq_num_hbo, 63);
 	rohc_comp_debug(context, "%zd bits are required to encode new sequence "
 	                "number 0x%08x with p = 63",
 	                tcp_context->tmp.nr_seq_bits_63, seq_num_hbo);
@@ -6067,45 +6012,45 @@ static bool tcp_encode_uncomp_tcp_fields(struct rohc_comp_ctxt *const context,
 	else
 	{
 		tcp_context->tmp.nr_seq_scaled_bits =
-			wlsb_get_k_32bits(tcp_context->seq_scaled_wlsb, tcp_context->seq_num_scaled);
+			wlsb_get_k_32bits(&tcp_context->seq_scaled_wlsb, tcp_context->seq_num_scaled);
 		rohc_comp_debug(context, "%zu bits are required to encode new scaled "
 		                "sequence number 0x%08x", tcp_context->tmp.nr_seq_scaled_bits,
 		                tcp_context->seq_num_scaled);
 	}
 	/* TODO: move this after successful packet compression */
-	c_add_wlsb(tcp_context->seq_wlsb, tcp_context->msn, seq_num_hbo);
+	c_add_wlsb(&tcp_context->seq_wlsb, tcp_context->msn, seq_num_hbo);
 	if(tcp_context->seq_num_factor != 0)
 	{
 		/* TODO: move this after successful packet compression */
-		c_add_wlsb(tcp_context->seq_scaled_wlsb, tcp_context->msn,
+		c_add_wlsb(&tcp_context->seq_scaled_wlsb, tcp_context->msn,
 		           tcp_context->seq_num_scaled);
 	}
 
 	/* how many bits are required to encode the new ACK number? */
-	tcp_context->tmp.tcp_ack_num_changed =
-		(tcp->ack_num != tcp_context->old_tcphdr.ack_num);
+	tcp_field_set_changed(tcp_context, TCP_FIELD_ACK_NUM,
+	                      tcp->ack_num != tcp_context->old_tcphdr.ack_num);
 	tcp_context->tmp.nr_ack_bits_65535 =
-		wlsb_get_kp_32bits(tcp_context->ack_wlsb, ack_num_hbo, 65535);
+		wlsb_get_kp_32bits(&tcp_context->ack_wlsb, ack_num_hbo, 65535);
 	rohc_comp_debug(context, "%zd bits are required to encode new ACK "
 	                "number 0x%08x with p = 65535",
 	                tcp_context->tmp.nr_ack_bits_65535, ack_num_hbo);
 	tcp_context->tmp.nr_ack_bits_32767 =
-		wlsb_get_kp_32bits(tcp_context->ack_wlsb, ack_num_hbo, 32767);
+		wlsb_get_kp_32bits(&tcp_context->ack_wlsb, ack_num_hbo, 32767);
 	rohc_comp_debug(context, "%zd bits are required to encode new ACK "
 	                "number 0x%08x with p = 32767",
 	                tcp_context->tmp.nr_ack_bits_32767, ack_num_hbo);
 	tcp_context->tmp.nr_ack_bits_16383 =
-		wlsb_get_kp_32bits(tcp_context->ack_wlsb, ack_num_hbo, 16383);
+		wlsb_get_kp_32bits(&tcp_context->ack_wlsb, ack_num_hbo, 16383);
 	rohc_comp_debug(context, "%zd bits are required to encode new ACK "
 	                "number 0x%08x with p = 16383",
 	                tcp_context->tmp.nr_ack_bits_16383, ack_num_hbo);
 	tcp_context->tmp.nr_ack_bits_8191 =
-		wlsb_get_kp_32bits(tcp_context->ack_wlsb, ack_num_hbo, 8191);
+		wlsb_get_kp_32bits(&tcp_context->ack_wlsb, ack_num_hbo, 8191);
 	rohc_comp_debug(context, "%zd bits are required to encode new ACK "
 	                "number 0x%08x with p = 8191",
 	                tcp_context->tmp.nr_ack_bits_8191, ack_num_hbo);
 	tcp_context->tmp.nr_ack_bits_63 =
-		wlsb_get_kp_32bits(tcp_context->ack_wlsb, ack_num_hbo, 63);
+		wlsb_get_kp_32bits(&tcp_context->ack_wlsb, ack_num_hbo, 63);
 	rohc_comp_debug(context, "%zd bits are required to encode new ACK "
 	                "number 0x%08x with p = 63",
 	                tcp_context->tmp.nr_ack_bits_63, ack_num_hbo);
@@ -6117,19 +6062,22 @@ static bool tcp_encode_uncomp_tcp_fields(struct rohc_comp_ctxt *const context,
 	else
 	{
 		tcp_context->tmp.nr_ack_scaled_bits =
-			wlsb_get_k_32bits(tcp_context->ack_scaled_wlsb, tcp_context->ack_num_scaled);
+			wlsb_get_k_32bits(&tcp_context->ack_scaled_wlsb, tcp_context->ack_num_scaled);
 		rohc_comp_debug(context, "%zu bits are required to encode new scaled "
 		                "ACK number 0x%08x", tcp_context->tmp.nr_ack_scaled_bits,
 		                tcp_context->ack_num_scaled);
 	}
 	/* TODO: move this after successful packet compression */
-	c_add_wlsb(tcp_context->ack_wlsb, tcp_context->msn, ack_num_hbo);
+	c_add_wlsb(&tcp_context->ack_wlsb, tcp_context->msn, ack_num_hbo);
 	if(tcp_context->ack_stride != 0)
 	{
 		/* TODO: move this after successful packet compression */
-		c_add_wlsb(tcp_context->ack_scaled_wlsb, tcp_context->msn,
+		c_add_wlsb(&tcp_context->ack_scaled_wlsb, tcp_context->msn,
 		           tcp_context->ack_num_scaled);
 	}
+	tcp_field_set_changed(tcp_context, TCP_FIELD_ACK_STRIDE,
+	                      !tcp_is_ack_stride_static(tcp_context->ack_stride,
+	                                                tcp_context->ack_num_scaling_nr));
 
 	/* how many bits are required to encode the new timestamp echo request and
 	 * timestamp echo reply? */
@@ -6161,78 +6109,82 @@ static bool tcp_encode_uncomp_tcp_fields(struct rohc_comp_ctxt *const context,
 	else
 	{
 		/* send only required bits in FO or SO states */
-
-		/* how many bits are required to encode the timestamp echo request
-		 * with p = -1 ? */
-		tcp_context->tcp_opts.tmp.nr_opt_ts_req_bits_minus_1 =
-			wlsb_get_kp_32bits(tcp_context->tcp_opts.ts_req_wlsb,
-			                   tcp_context->tcp_opts.tmp.ts_req,
-			                   ROHC_LSB_SHIFT_TCP_TS_1B);
-		rohc_comp_debug(context, "%zu bits are required to encode new "
-		                "timestamp echo request 0x%08x with p = %d",
-		                tcp_context->tcp_opts.tmp.nr_opt_ts_req_bits_minus_1,
-		                tcp_context->tcp_opts.tmp.ts_req, ROHC_LSB_SHIFT_TCP_TS_1B);
-
-		/* how many bits are required to encode the timestamp echo request
-		 * with p = 0x40000 ? */
-		tcp_context->tcp_opts.tmp.nr_opt_ts_req_bits_0x40000 =
-			wlsb_get_kp_32bits(tcp_context->tcp_opts.ts_req_wlsb,
-			                   tcp_context->tcp_opts.tmp.ts_req,
-			                   ROHC_LSB_SHIFT_TCP_TS_3B);
-		rohc_comp_debug(context, "%zu bits are required to encode new "
-		                "timestamp echo request 0x%08x with p = 0x%x",
-		                tcp_context->tcp_opts.tmp.nr_opt_ts_req_bits_0x40000,
-		                tcp_context->tcp_opts.tmp.ts_req, ROHC_LSB_SHIFT_TCP_TS_3B);
-
-		/* how many bits are required to encode the timestamp echo reply
-		 * with p = 0x4000000 ? */
-		tcp_context->tcp_opts.tmp.nr_opt_ts_req_bits_0x4000000 =
-			wlsb_get_kp_32bits(tcp_context->tcp_opts.ts_req_wlsb,
-			                   tcp_context->tcp_opts.tmp.ts_req,
-			                   ROHC_LSB_SHIFT_TCP_TS_4B);
-		rohc_comp_debug(context, "%zu bits are required to encode new "
-		                "timestamp echo request 0x%08x with p = 0x%x",
-		                tcp_context->tcp_opts.tmp.nr_opt_ts_req_bits_0x4000000,
-		                tcp_context->tcp_opts.tmp.ts_req, ROHC_LSB_SHIFT_TCP_TS_4B);
-
-		/* how many bits are required to encode the timestamp echo reply
-		 * with p = -1 ? */
-		tcp_context->tcp_opts.tmp.nr_opt_ts_reply_bits_minus_1 =
-			wlsb_get_kp_32bits(tcp_context->tcp_opts.ts_reply_wlsb,
-			                   tcp_context->tcp_opts.tmp.ts_reply,
-			                   ROHC_LSB_SHIFT_TCP_TS_1B);
-		rohc_comp_debug(context, "%zu bits are required to encode new "
-		                "timestamp echo reply 0x%08x with p = %d",
-		                tcp_context->tcp_opts.tmp.nr_opt_ts_reply_bits_minus_1,
-		                tcp_context->tcp_opts.tmp.ts_reply, ROHC_LSB_SHIFT_TCP_TS_1B);
-
-		/* how many bits are required to encode the timestamp echo reply
-		 * with p = 0x40000 ? */
-		tcp_context->tcp_opts.tmp.nr_opt_ts_reply_bits_0x40000 =
-			wlsb_get_kp_32bits(tcp_context->tcp_opts.ts_reply_wlsb,
-			                   tcp_context->tcp_opts.tmp.ts_reply,
-			                   ROHC_LSB_SHIFT_TCP_TS_3B);
-		rohc_comp_debug(context, "%zu bits are required to encode new "
-		                "timestamp echo reply 0x%08x with p = 0x%x",
-		                tcp_context->tcp_opts.tmp.nr_opt_ts_reply_bits_0x40000,
-		                tcp_context->tcp_opts.tmp.ts_reply, ROHC_LSB_SHIFT_TCP_TS_3B);
-
-		/* how many bits are required to encode the timestamp echo reply
-		 * with p = 0x4000000 ? */
-		tcp_context->tcp_opts.tmp.nr_opt_ts_reply_bits_0x4000000 =
-			wlsb_get_kp_32bits(tcp_context->tcp_opts.ts_reply_wlsb,
-			                   tcp_context->tcp_opts.tmp.ts_reply,
-			                   ROHC_LSB_SHIFT_TCP_TS_4B);
-		rohc_comp_debug(context, "%zu bits are required to encode new "
-		                "timestamp echo reply 0x%08x with p = 0x%x",
-		                tcp_context->tcp_opts.tmp.nr_opt_ts_reply_bits_0x4000000,
-		                tcp_context->tcp_opts.tmp.ts_reply, ROHC_LSB_SHIFT_TCP_TS_4B);
+		tcp_encode_uncomp_ts_field(context, &tcp_context->tcp_opts.ts_req_wlsb,
+		                           tcp_context->tcp_opts.tmp.ts_req, "request",
+		                           &tcp_context->tcp_opts.tmp.nr_opt_ts_req_bits_minus_1,
+		                           &tcp_context->tcp_opts.tmp.nr_opt_ts_req_bits_0x40000,
+		                           &tcp_context->tcp_opts.tmp.nr_opt_ts_req_bits_0x4000000);
+		tcp_encode_uncomp_ts_field(context, &tcp_context->tcp_opts.ts_reply_wlsb,
+		                           tcp_context->tcp_opts.tmp.ts_reply, "reply",
+		                           &tcp_context->tcp_opts.tmp.nr_opt_ts_reply_bits_minus_1,
+		                           &tcp_context->tcp_opts.tmp.nr_opt_ts_reply_bits_0x40000,
+		                           &tcp_context->tcp_opts.tmp.nr_opt_ts_reply_bits_0x4000000);
 	}
 
 	return true;
 }
 
 
+/**
+ * @brief Determine the number of bits required to encode one timestamp of the
+ *        TCP TS option
+ *
+ * The ts_lsb() encoding uses the smallest of its 1-byte, 2-byte, 3-byte or
+ * 4-byte forms that fits, every form with its own shift parameter p. The
+ * forms are tested from the smallest one and the W-LSB queries stop as soon
+ * as one form fits: the remaining numbers of bits are set to 0 since they
+ * are never used. The timestamps of a steady flow fit in the 1-byte or
+ * 2-byte forms, so only one W-LSB query is usually required.
+ *
+ * @param context                 The compression context
+ * @param wlsb                    The W-LSB object of the timestamp
+ * @param ts                      The timestamp to encode
+ * @param descr                   The description of the timestamp for traces
+ * @param[out] nr_bits_minus_1    The number of bits required with p = -1
+ * @param[out] nr_bits_0x40000    The number of bits required with p = 0x40000
+ * @param[out] nr_bits_0x4000000  The number of bits required with
+ *                                p = 0x4000000
+ */
+static void tcp_encode_uncomp_ts_field(const struct rohc_comp_ctxt *const context,
+                                       const struct c_wlsb *const wlsb,
+                                       const uint32_t ts,
+                                       const char *const descr,
+                                       size_t *const nr_bits_minus_1,
+                                       size_t *const nr_bits_0x40000,
+                                       size_t *const nr_bits_0x4000000)
+{
+	*nr_bits_0x40000 = 0;
+	*nr_bits_0x4000000 = 0;
+
+	/* how many bits are required to encode the timestamp with p = -1 ? */
+	*nr_bits_minus_1 = wlsb_get_kp_32bits(wlsb, ts, ROHC_LSB_SHIFT_TCP_TS_1B);
+	rohc_comp_debug(context, "%zu bits are required to encode new "
+	                "timestamp echo %s 0x%08x with p = %d", *nr_bits_minus_1,
+	                descr, ts, ROHC_LSB_SHIFT_TCP_TS_1B);
+	if((*nr_bits_minus_1) <= ROHC_SDVL_MAX_BITS_IN_2_BYTES)
+	{
+		return;
+	}
+
+	/* how many bits are required to encode the timestamp with p = 0x40000 ? */
+	*nr_bits_0x40000 = wlsb_get_kp_32bits(wlsb, ts, ROHC_LSB_SHIFT_TCP_TS_3B);
+	rohc_comp_debug(context, "%zu bits are required to encode new "
+	                "timestamp echo %s 0x%08x with p = 0x%x", *nr_bits_0x40000,
+	                descr, ts, ROHC_LSB_SHIFT_TCP_TS_3B);
+	if((*nr_bits_0x40000) <= ROHC_SDVL_MAX_BITS_IN_3_BYTES)
+	{
+		return;
+	}
+
+	/* how many bits are required to encode the timestamp with
+	 * p = 0x4000000 ? */
+	*nr_bits_0x4000000 = wlsb_get_kp_32bits(wlsb, ts, ROHC_LSB_SHIFT_TCP_TS_4B);
+	rohc_comp_debug(context, "%zu bits are required to encode new "
+	                "timestamp echo %s 0x%08x with p = 0x%x", *nr_bits_0x4000000,
+	                descr, ts, ROHC_LSB_SHIFT_TCP_TS_4B);
+}
+
+
 /**
  * @brief Decide which packet to send when in the different states.
  *
@@ -6343,13 +6295,13 @@ static rohc_packet_t tcp_decide_FO_SO_packet(const struct rohc_comp_ctxt *const
 	struct sc_tcp_context *const tcp_context = context->specific;
 	rohc_packet_t packet_type;
 
-	if(tcp_context->tmp.is_ipv6_exts_list_static_changed)
+	if(tcp_is_field_changed(tcp_context, TCP_FIELD_IPV6_EXTS_STATIC))
 	{
 		rohc_comp_debug(context, "force packet IR because at least one IPv6 option "
 		                "changed its static part");
 		packet_type = ROHC_PACKET_IR;
 	}
-	else if(tcp_context->tmp.is_ipv6_exts_list_dyn_changed)
+	else if(tcp_is_field_changed(tcp_context, TCP_FIELD_IPV6_EXTS_DYN))
 	{
 		rohc_comp_debug(context, "force packet IR-DYN because at least one IPv6 option "
 		                "changed its dynamic part");
@@ -6378,22 +6330,12 @@ static rohc_packet_t tcp_decide_FO_SO_packet(const struct rohc_comp_ctxt *const
 		                "not compressible");
 		packet_type = ROHC_PACKET_IR_DYN;
 	}
-	else if(tcp_context->tmp.outer_ip_ttl_changed ||
-	        tcp_context->tmp.ip_id_behavior_changed ||
-	        tcp_context->tmp.ip_df_changed ||
-	        tcp_context->tmp.dscp_changed ||
-	        tcp_context->tmp.tcp_ack_flag_changed ||
-	        tcp_context->tmp.tcp_urg_flag_present ||
-	        tcp_context->tmp.tcp_urg_flag_changed ||
-	        tcp_context->old_tcphdr.urg_ptr != tcp->urg_ptr ||
-	        !tcp_is_ack_stride_static(tcp_context->ack_stride,
-	                                  tcp_context->ack_num_scaling_nr))
+	else if(tcp_is_field_changed(tcp_context, TCP_FIELDS_CO_COMMON))
 	{
 		TRACE_GOTO_CHOICE;
 		packet_type = ROHC_PACKET_TCP_CO_COMMON;
 	}
-	else if(tcp_context->tmp.ecn_used_changed ||
-	        tcp_context->tmp.ttl_hopl_changed)
+	else if(tcp_is_field_changed(tcp_context, TCP_FIELDS_CRC7))
 	{
 		/* use compressed header with a 7-bit CRC (rnd_8, seq_8 or common):
 		 *  - use common if too many LSB of sequence number are required
@@ -6405,7 +6347,7 @@ static rohc_packet_t tcp_decide_FO_SO_packet(const struct rohc_comp_ctxt *const
 		   tcp_context->tmp.nr_seq_bits_8191 <= 14 &&
 		   tcp_context->tmp.nr_ack_bits_8191 <= 15 &&
 		   tcp_context->tmp.nr_ttl_hopl_bits <= 3 &&
-		   !tcp_context->tmp.tcp_window_changed)
+		   !tcp_is_field_changed(tcp_context, TCP_FIELD_WINDOW))
 		{
 			/* IP_ID_BEHAVIOR_SEQ or IP_ID_BEHAVIOR_SEQ_SWAP */
 			TRACE_GOTO_CHOICE;
@@ -6415,7 +6357,7 @@ static rohc_packet_t tcp_decide_FO_SO_packet(const struct rohc_comp_ctxt *const
 		        tcp_context->tmp.nr_seq_bits_65535 <= 16 &&
 		        tcp_context->tmp.nr_ack_bits_16383 <= 16 &&
 		        tcp_context->tmp.nr_ttl_hopl_bits <= 3 &&
-		        !tcp_context->tmp.tcp_window_changed)
+		        !tcp_is_field_changed(tcp_context, TCP_FIELD_WINDOW))
 		{
 			TRACE_GOTO_CHOICE;
 			packet_type = ROHC_PACKET_TCP_RND_8;
@@ -6460,6 +6402,10 @@ error:
 /**
  * @brief Decide which seq packet to send when in FO or SO state.
  *
+ * The kind of changes of the packet selects one row of the decision table
+ * \ref tcp_co_seq_formats. The first format of the row that is able to
+ * transmit the packet is chosen, co_common is the fallback.
+ *
  * @param context           The compression context
  * @param tcp               The TCP header to compress
  * @param crc7_at_least     Whether packet types with CRC strictly smaller
@@ -6472,162 +6418,98 @@ static rohc_packet_t tcp_decide_FO_SO_packet_seq(const struct rohc_comp_ctxt *co
                                                  const struct tcphdr *const tcp,
                                                  const bool crc7_at_least)
 {
-	struct sc_tcp_context *const tcp_context = context->specific;
+	const struct sc_tcp_context *const tcp_context = context->specific;
+	const struct tcp_tmp_variables *const tmp = &tcp_context->tmp;
+	const bool ip_id_3_in_4 = (tmp->nr_ip_id_bits_3 <= 4);
+	const bool seq_8_fits = (ip_id_3_in_4 &&
+	                         tmp->nr_seq_bits_8191 <= 14 &&
+	                         tmp->nr_ack_bits_8191 <= 15);
+	const bool seq_scaled_fits =
+		(tcp_context->seq_num_scaling_nr >= ROHC_INIT_TS_STRIDE_MIN &&
+		 tmp->nr_seq_scaled_bits <= 4);
+	tcp_co_changes_t changes;
+	uint32_t formats = 0;
 	rohc_packet_t packet_type;
 
+	/* what kind of changes? */
 	if(tcp->rsf_flags != 0 ||
 	   tcp_context->tcp_opts.tmp.do_list_struct_changed ||
 	   tcp_context->tcp_opts.tmp.do_list_static_changed)
 	{
-		/* seq_8 or co_common
-		 *
-		 * seq_8 can be used if:
-		 *  - TCP window didn't change,
-		 *  - at most 14 LSB of the TCP sequence number are required,
-		 *  - at most 15 LSB of the TCP ACK number are required,
-		 *  - at most 4 LSBs of IP-ID must be transmitted
-		 * otherwise use co_common packet */
-		if(tcp_context->tmp.nr_ip_id_bits_3 <= 4 &&
-		   tcp_context->tmp.nr_seq_bits_8191 <= 14 &&
-		   tcp_context->tmp.nr_ack_bits_8191 <= 15 &&
-		   tcp_context->tmp.nr_ttl_hopl_bits <= 3 &&
-		   !tcp_context->tmp.tcp_window_changed)
-		{
-			/* seq_8 is possible */
-			TRACE_GOTO_CHOICE;
-			packet_type = ROHC_PACKET_TCP_SEQ_8;
-		}
-		else
-		{
-			TRACE_GOTO_CHOICE;
-			packet_type = ROHC_PACKET_TCP_CO_COMMON;
-		}
+		changes = TCP_CO_CHANGES_LIST;
 	}
-	else if(tcp_context->tmp.tcp_window_changed)
+	else if(tcp_is_field_changed(tcp_context, TCP_FIELD_WINDOW))
 	{
-		/* seq_7 or co_common */
-		if(!crc7_at_least &&
-		   tcp_context->tmp.nr_window_bits_16383 <= 15 &&
-		   tcp_context->tmp.nr_ip_id_bits_3 <= 5 &&
-		   tcp_context->tmp.nr_ack_bits_32767 <= 16 &&
-		   !tcp_context->tmp.tcp_seq_num_changed)
-		{
-			/* seq_7 is possible */
-			TRACE_GOTO_CHOICE;
-			packet_type = ROHC_PACKET_TCP_SEQ_7;
-		}
-		else
-		{
-			/* rnd_7 is not possible, rnd_8 neither so fallback on co_common */
-			TRACE_GOTO_CHOICE;
-			packet_type = ROHC_PACKET_TCP_CO_COMMON;
-		}
+		changes = TCP_CO_CHANGES_WINDOW;
 	}
-	else if(tcp->ack_flag == 0 || !tcp_context->tmp.tcp_ack_num_changed)
+	else if(tcp->ack_flag == 0 || !tcp_is_field_changed(tcp_context, TCP_FIELD_ACK_NUM))
 	{
-		/* seq_2, seq_1 or co_common */
-		if(!crc7_at_least &&
-		   tcp_context->tmp.nr_ip_id_bits_3 <= 7 &&
-		   tcp_context->seq_num_scaling_nr >= ROHC_INIT_TS_STRIDE_MIN &&
-		   tcp_context->tmp.nr_seq_scaled_bits <= 4)
-		{
-			/* seq_2 is possible */
-			TRACE_GOTO_CHOICE;
-			assert(tcp_context->tmp.payload_len > 0);
-			packet_type = ROHC_PACKET_TCP_SEQ_2;
-		}
-		else if(!crc7_at_least &&
-		        tcp_context->tmp.nr_ip_id_bits_3 <= 4 &&
-		        tcp_context->tmp.nr_seq_bits_32767 <= 16)
-		{
-			/* seq_1 is possible */
-			TRACE_GOTO_CHOICE;
-			packet_type = ROHC_PACKET_TCP_SEQ_1;
-		}
-		else if(tcp_context->tmp.nr_ip_id_bits_3 <= 4 &&
-		        true /* TODO: no more than 3 bits of TTL */ &&
-		        tcp_context->tmp.nr_ack_bits_8191 <= 15 &&
-		        tcp_context->tmp.nr_seq_bits_8191 <= 14)
-		{
-			TRACE_GOTO_CHOICE;
-			packet_type = ROHC_PACKET_TCP_SEQ_8;
-		}
-		else
-		{
-			TRACE_GOTO_CHOICE;
-			packet_type = ROHC_PACKET_TCP_CO_COMMON;
-		}
+		changes = TCP_CO_CHANGES_SEQ;
 	}
-	else if(!tcp_context->tmp.tcp_seq_num_changed)
+	else if(!tcp_is_field_changed(tcp_context, TCP_FIELD_SEQ_NUM))
 	{
-		/* seq_4, seq_3, or co_common */
-		if(!crc7_at_least &&
-		   tcp_context->tmp.nr_ip_id_bits_1 <= 3 &&
-		   tcp_is_ack_scaled_possible(tcp_context->ack_stride,
-		                              tcp_context->ack_num_scaling_nr) &&
-		   tcp_context->tmp.nr_ack_scaled_bits <= 4)
-		{
-			TRACE_GOTO_CHOICE;
-			packet_type = ROHC_PACKET_TCP_SEQ_4;
-		}
-		else if(!crc7_at_least &&
-		        tcp_context->tmp.nr_ip_id_bits_3 <= 4 &&
-		        tcp_context->tmp.nr_ack_bits_16383 <= 16)
-		{
-			TRACE_GOTO_CHOICE;
-			packet_type = ROHC_PACKET_TCP_SEQ_3;
-		}
-		else if(tcp_context->tmp.nr_ip_id_bits_3 <= 4 &&
-		        true /* TODO: no more than 3 bits of TTL */ &&
-		        tcp_context->tmp.nr_ack_bits_8191 <= 15 &&
-		        tcp_context->tmp.nr_seq_bits_8191 <= 14)
-		{
-			TRACE_GOTO_CHOICE;
-			packet_type = ROHC_PACKET_TCP_SEQ_8;
-		}
-		else
-		{
-			TRACE_GOTO_CHOICE;
-			packet_type = ROHC_PACKET_TCP_CO_COMMON;
-		}
+		changes = TCP_CO_CHANGES_ACK;
 	}
 	else
 	{
-		/* sequence and acknowledgment numbers changed:
-		 * seq_6, seq_5, seq_8 or co_common */
-		if(!crc7_at_least &&
-		   tcp_context->tmp.nr_ip_id_bits_3 <= 4 &&
-		   tcp_context->seq_num_scaling_nr >= ROHC_INIT_TS_STRIDE_MIN &&
-		   tcp_context->tmp.nr_seq_scaled_bits <= 4 &&
-		   tcp_context->tmp.nr_ack_bits_16383 <= 16)
-		{
-			TRACE_GOTO_CHOICE;
-			assert(tcp_context->tmp.payload_len > 0);
-			packet_type = ROHC_PACKET_TCP_SEQ_6;
-		}
-		else if(!crc7_at_least &&
-		        tcp_context->tmp.nr_ip_id_bits_3 <= 4 &&
-		        tcp_context->tmp.nr_ack_bits_16383 <= 16 &&
-		        tcp_context->tmp.nr_seq_bits_32767 <= 16)
+		changes = TCP_CO_CHANGES_SEQ_ACK;
+	}
+
+	/* which formats are able to transmit the packet? */
+	if(tmp->nr_ip_id_bits_3 <= 7 && seq_scaled_fits)
+	{
+		formats |= TCP_CO_SEQ_2;
+	}
+	if(ip_id_3_in_4 && tmp->nr_seq_bits_32767 <= 16)
+	{
+		formats |= TCP_CO_SEQ_1;
+	}
+	if(tmp->nr_ip_id_bits_1 <= 3 &&
+	   tcp_is_ack_scaled_possible(tcp_context->ack_stride,
+	                              tcp_context->ack_num_scaling_nr) &&
+	   tmp->nr_ack_scaled_bits <= 4)
+	{
+		formats |= TCP_CO_SEQ_4;
+	}
+	if(ip_id_3_in_4 && tmp->nr_ack_bits_16383 <= 16)
+	{
+		formats |= TCP_CO_SEQ_3;
+		if(seq_scaled_fits)
 		{
-			TRACE_GOTO_CHOICE;
-			packet_type = ROHC_PACKET_TCP_SEQ_5;
+			formats |= TCP_CO_SEQ_6;
 		}
-		else if(tcp_context->tmp.nr_ip_id_bits_3 <= 4 &&
-		        tcp_context->tmp.nr_seq_bits_8191 <= 14 &&
-		        tcp_context->tmp.nr_ack_bits_8191 <= 15 &&
-		        tcp_context->tmp.nr_ttl_hopl_bits <= 3 &&
-		        !tcp_context->tmp.tcp_window_changed)
+		if(tmp->nr_seq_bits_32767 <= 16)
 		{
-			TRACE_GOTO_CHOICE;
-			packet_type = ROHC_PACKET_TCP_SEQ_8;
+			formats |= TCP_CO_SEQ_5;
 		}
-		else
+	}
+	if(tmp->nr_window_bits_16383 <= 15 &&
+	   tmp->nr_ip_id_bits_3 <= 5 &&
+	   tmp->nr_ack_bits_32767 <= 16 &&
+	   !tcp_is_field_changed(tcp_context, TCP_FIELD_SEQ_NUM))
+	{
+		formats |= TCP_CO_SEQ_7;
+	}
+	if(seq_8_fits)
+	{
+		/* TODO: no more than 3 bits of TTL for all the changes */
+		formats |= TCP_CO_SEQ_8_ANY_TTL;
+		if(tmp->nr_ttl_hopl_bits <= 3 &&
+		   !tcp_is_field_changed(tcp_context, TCP_FIELD_WINDOW))
 		{
-			TRACE_GOTO_CHOICE;
-			packet_type = ROHC_PACKET_TCP_CO_COMMON;
+			formats |= TCP_CO_SEQ_8;
 		}
 	}
+	if(crc7_at_least)
+	{
+		formats &= TCP_CO_CRC7_FORMATS;
+	}
+
+	packet_type = tcp_co_decide_format(tcp_co_seq_formats[changes], formats);
+	rohc_comp_debug(context, "changes %d, possible formats 0x%04x -> %s",
+	                changes, formats, rohc_get_packet_descr(packet_type));
+	assert(packet_type != ROHC_PACKET_TCP_SEQ_2 || tmp->payload_len > 0);
+	assert(packet_type != ROHC_PACKET_TCP_SEQ_6 || tmp->payload_len > 0);
 
 	/* IP-ID is sequential, so only co_common and seq_X packets are allowed */
 	assert(packet_type == ROHC_PACKET_TCP_CO_COMMON ||
@@ -6641,6 +6523,10 @@ static rohc_packet_t tcp_decide_FO_SO_packet_seq(const struct rohc_comp_ctxt *co
 /**
  * @brief Decide which rnd packet to send when in FO or SO state.
  *
+ * The kind of changes of the packet selects one row of the decision table
+ * \ref tcp_co_rnd_formats. The first format of the row that is able to
+ * transmit the packet is chosen, co_common is the fallback.
+ *
  * @param context           The compression context
  * @param tcp               The TCP header to compress
  * @param crc7_at_least     Whether packet types with CRC strictly smaller
@@ -6653,136 +6539,83 @@ static rohc_packet_t tcp_decide_FO_SO_packet_rnd(const struct rohc_comp_ctxt *co
                                                  const struct tcphdr *const tcp,
                                                  const bool crc7_at_least)
 {
-	struct sc_tcp_context *const tcp_context = context->specific;
+	const struct sc_tcp_context *const tcp_context = context->specific;
+	const struct tcp_tmp_variables *const tmp = &tcp_context->tmp;
+	const bool is_seq_changed = tcp_is_field_changed(tcp_context, TCP_FIELD_SEQ_NUM);
+	const bool is_ack_changed = tcp_is_field_changed(tcp_context, TCP_FIELD_ACK_NUM);
+	const bool seq_scaled_fits =
+		(tcp_context->seq_num_scaling_nr >= ROHC_INIT_TS_STRIDE_MIN &&
+		 tmp->nr_seq_scaled_bits <= 4);
+	tcp_co_changes_t changes;
+	uint32_t formats = 0;
 	rohc_packet_t packet_type;
 
+	/* what kind of changes? */
 	if(tcp->rsf_flags != 0 ||
 	   tcp_context->tcp_opts.tmp.do_list_struct_changed ||
 	   tcp_context->tcp_opts.tmp.do_list_static_changed)
 	{
-		if(!tcp_context->tmp.tcp_window_changed &&
-		   tcp_context->tmp.nr_seq_bits_65535 <= 16 &&
-		   tcp_context->tmp.nr_ack_bits_16383 <= 16)
-		{
-			TRACE_GOTO_CHOICE;
-			packet_type = ROHC_PACKET_TCP_RND_8;
-		}
-		else
-		{
-			TRACE_GOTO_CHOICE;
-			packet_type = ROHC_PACKET_TCP_CO_COMMON;
-		}
+		changes = TCP_CO_CHANGES_LIST;
 	}
-	else /* unchanged structure of the list of TCP options */
+	else if(tcp_is_field_changed(tcp_context, TCP_FIELD_WINDOW))
 	{
-		if(tcp->rsf_flags != 0)
-		{
-			if(!tcp_context->tmp.tcp_window_changed &&
-			   tcp_context->tmp.nr_ack_bits_16383 <= 16 &&
-			   tcp_context->tmp.nr_seq_bits_65535 <= 16)
-			{
-				TRACE_GOTO_CHOICE;
-				packet_type = ROHC_PACKET_TCP_RND_8;
-			}
-			else
-			{
-				TRACE_GOTO_CHOICE;
-				packet_type = ROHC_PACKET_TCP_CO_COMMON;
-			}
-		}
-		else if(tcp_context->tmp.tcp_window_changed)
-		{
-			if(!crc7_at_least &&
-			   !tcp_context->tmp.tcp_seq_num_changed &&
-			   tcp_context->tmp.nr_ack_bits_65535 <= 18)
-			{
-				/* rnd_7 is possible */
-				TRACE_GOTO_CHOICE;
-				packet_type = ROHC_PACKET_TCP_RND_7;
-			}
-			else
-			{
-				/* rnd_7 is not possible, rnd_8 neither so fallback on co_common */
-				TRACE_GOTO_CHOICE;
-				packet_type = ROHC_PACKET_TCP_CO_COMMON;
-			}
-		}
-		else if(!crc7_at_least &&
-		        !tcp_context->tmp.tcp_ack_num_changed &&
-		        tcp_context->tmp.payload_len > 0 &&
-		        tcp_context->seq_num_scaling_nr >= ROHC_INIT_TS_STRIDE_MIN &&
-		        tcp_context->tmp.nr_seq_scaled_bits <= 4)
-		{
-			/* rnd_2 is possible */
-			assert(tcp_context->tmp.payload_len > 0);
-			TRACE_GOTO_CHOICE;
-			packet_type = ROHC_PACKET_TCP_RND_2;
-		}
-		else if(!crc7_at_least &&
-		        tcp->ack_flag != 0 &&
-		        tcp_is_ack_scaled_possible(tcp_context->ack_stride,
-		                                   tcp_context->ack_num_scaling_nr) &&
-		        tcp_context->tmp.nr_ack_scaled_bits <= 4 &&
-		        !tcp_context->tmp.tcp_seq_num_changed)
-		{
-			/* rnd_4 is possible */
-			TRACE_GOTO_CHOICE;
-			packet_type = ROHC_PACKET_TCP_RND_4;
-		}
-		else if(!crc7_at_least &&
-		        tcp->ack_flag != 0 &&
-		        !tcp_context->tmp.tcp_seq_num_changed &&
-		        tcp_context->tmp.nr_ack_bits_8191 <= 15)
-		{
-			/* rnd_3 is possible */
-			TRACE_GOTO_CHOICE;
-			packet_type = ROHC_PACKET_TCP_RND_3;
-		}
-		else if(!crc7_at_least &&
-		        tcp_context->tmp.nr_seq_bits_65535 <= 18 &&
-		        !tcp_context->tmp.tcp_ack_num_changed)
-		{
-			/* rnd_1 is possible */
-			TRACE_GOTO_CHOICE;
-			packet_type = ROHC_PACKET_TCP_RND_1;
-		}
-		else if(!crc7_at_least &&
-		        tcp->ack_flag != 0 &&
-		        tcp_context->seq_num_scaling_nr >= ROHC_INIT_TS_STRIDE_MIN &&
-		        tcp_context->tmp.nr_seq_scaled_bits <= 4 &&
-		        tcp_context->tmp.nr_ack_bits_16383 <= 16)
+		changes = TCP_CO_CHANGES_WINDOW;
+	}
+	else
+	{
+		changes = TCP_CO_CHANGES_SEQ_ACK;
+	}
+
+	/* which formats are able to transmit the packet? */
+	if(!is_ack_changed && tmp->payload_len > 0 && seq_scaled_fits)
+	{
+		formats |= TCP_CO_RND_2;
+	}
+	if(!is_ack_changed && tmp->nr_seq_bits_65535 <= 18)
+	{
+		formats |= TCP_CO_RND_1;
+	}
+	if(!is_seq_changed && tmp->nr_ack_bits_65535 <= 18)
+	{
+		formats |= TCP_CO_RND_7;
+	}
+	if(tcp->ack_flag != 0)
+	{
+		if(!is_seq_changed &&
+		   tcp_is_ack_scaled_possible(tcp_context->ack_stride,
+		                              tcp_context->ack_num_scaling_nr) &&
+		   tmp->nr_ack_scaled_bits <= 4)
 		{
-			/* ACK number present */
-			/* rnd_6 is possible */
-			assert(tcp_context->tmp.payload_len > 0);
-			TRACE_GOTO_CHOICE;
-			packet_type = ROHC_PACKET_TCP_RND_6;
+			formats |= TCP_CO_RND_4;
 		}
-		else if(!crc7_at_least &&
-		        tcp->ack_flag != 0 &&
-		        tcp_context->tmp.nr_seq_bits_8191 <= 14 &&
-		        tcp_context->tmp.nr_ack_bits_8191 <= 15)
+		if(!is_seq_changed && tmp->nr_ack_bits_8191 <= 15)
 		{
-			/* ACK number present */
-			/* rnd_5 is possible */
-			TRACE_GOTO_CHOICE;
-			packet_type = ROHC_PACKET_TCP_RND_5;
+			formats |= TCP_CO_RND_3;
 		}
-		else if(/* !tcp_context->tmp.tcp_window_changed && */
-		        tcp_context->tmp.nr_ack_bits_16383 <= 16 &&
-		        tcp_context->tmp.nr_seq_bits_65535 <= 16)
+		if(seq_scaled_fits && tmp->nr_ack_bits_16383 <= 16)
 		{
-			/* fallback on rnd_8 */
-			TRACE_GOTO_CHOICE;
-			packet_type = ROHC_PACKET_TCP_RND_8;
+			formats |= TCP_CO_RND_6;
 		}
-		else
+		if(tmp->nr_seq_bits_8191 <= 14 && tmp->nr_ack_bits_8191 <= 15)
 		{
-			/* rnd_8 is not possible, fallback on co_common */
-			TRACE_GOTO_CHOICE;
-			packet_type = ROHC_PACKET_TCP_CO_COMMON;
+			formats |= TCP_CO_RND_5;
 		}
-	} /* end of case 'unchanged structure of the list of TCP options' */
+	}
+	if(!tcp_is_field_changed(tcp_context, TCP_FIELD_WINDOW) &&
+	   tmp->nr_seq_bits_65535 <= 16 &&
+	   tmp->nr_ack_bits_16383 <= 16)
+	{
+		formats |= TCP_CO_RND_8;
+	}
+	if(crc7_at_least)
+	{
+		formats &= TCP_CO_CRC7_FORMATS;
+	}
+
+	packet_type = tcp_co_decide_format(tcp_co_rnd_formats[changes], formats);
+	rohc_comp_debug(context, "changes %d, possible formats 0x%04x -> %s",
+	                changes, formats, rohc_get_packet_descr(packet_type));
+	assert(packet_type != ROHC_PACKET_TCP_RND_6 || tmp->payload_len > 0);
 
 	/* IP-ID is NOT sequential, so only co_common and rnd_X packets are allowed */
 	assert(packet_type == ROHC_PACKET_TCP_CO_COMMON ||
@@ -6793,41 +6626,63 @@ static rohc_packet_t tcp_decide_FO_SO_packet_rnd(const struct rohc_comp_ctxt *co
 }
 
 
+/**
+ * @brief Choose the preferred compressed format among the possible ones
+ *
+ * @param allowed   The formats allowed for the kind of changes of the packet
+ * @param possible  The formats that are able to transmit the packet
+ * @return          The preferred format, co_common if none is possible
+ */
+static inline rohc_packet_t tcp_co_decide_format(const uint32_t allowed,
+                                                 const uint32_t possible)
+{
+	const uint32_t formats = allowed & possible;
+
+	if(formats == 0)
+	{
+		return ROHC_PACKET_TCP_CO_COMMON;
+	}
+	return tcp_co_format_types[__builtin_ctz(formats)];
+}
+
+
 /**
  * @brief Detect the behavior of the IPv4 Identification field
  *
- * @param last_ip_id  The IP-ID value of the previous packet (in HBO)
- * @param new_ip_id   The IP-ID value of the current packet (in HBO)
- * @return            The IP-ID behavior among: IP_ID_BEHAVIOR_SEQ,
- *                    IP_ID_BEHAVIOR_SEQ_SWAP, IP_ID_BEHAVIOR_ZERO, or
- *                    IP_ID_BEHAVIOR_RAND
+ * @param last_behavior  The IP-ID behavior of the previous packet
+ * @param last_ip_id     The IP-ID value of the previous packet (in HBO)
+ * @param new_ip_id      The IP-ID value of the current packet (in HBO)
+ * @return               The IP-ID behavior among: IP_ID_BEHAVIOR_SEQ,
+ *                       IP_ID_BEHAVIOR_SEQ_SWAP, IP_ID_BEHAVIOR_ZERO, or
+ *                       IP_ID_BEHAVIOR_RAND
  */
-static tcp_ip_id_behavior_t tcp_detect_ip_id_behavior(const uint16_t last_ip_id,
+static tcp_ip_id_behavior_t tcp_detect_ip_id_behavior(const tcp_ip_id_behavior_t last_behavior,
+                                                      const uint16_t last_ip_id,
                                                       const uint16_t new_ip_id)
 {
 	tcp_ip_id_behavior_t behavior;
 
-	if(is_ip_id_increasing(last_ip_id, new_ip_id))
-	{
-		behavior = IP_ID_BEHAVIOR_SEQ;
-	}
-	else
+	switch(rohc_ip_id_classify((last_behavior == IP_ID_BEHAVIOR_SEQ ?
+	                            ROHC_IP_ID_SEQ : ROHC_IP_ID_RAND),
+	                           last_ip_id, new_ip_id))
 	{
-		const uint16_t swapped_last_ip_id = swab16(last_ip_id);
-		const uint16_t swapped_new_ip_id = swab16(new_ip_id);
-
-		if(is_ip_id_increasing(swapped_last_ip_id, swapped_new_ip_id))
-		{
+		case ROHC_IP_ID_SEQ:
+			behavior = IP_ID_BEHAVIOR_SEQ;
+			break;
+		case ROHC_IP_ID_SEQ_SWAP:
 			behavior = IP_ID_BEHAVIOR_SEQ_SWAP;
-		}
-		else if(new_ip_id == 0)
-		{
+			break;
+		case ROHC_IP_ID_ZERO:
 			behavior = IP_ID_BEHAVIOR_ZERO;
-		}
-		else
-		{
+			break;
+		case ROHC_IP_ID_CONST:
+			/* a constant IP-ID is not a behavior of the TCP profile */
+			behavior = (new_ip_id == 0 ? IP_ID_BEHAVIOR_ZERO : IP_ID_BEHAVIOR_RAND);
+			break;
+		case ROHC_IP_ID_RAND:
+		default:
 			behavior = IP_ID_BEHAVIOR_RAND;
-		}
+			break;
 	}
 
 	return behavior;
@@ -6887,13 +6742,13 @@ static void tcp_detect_ecn_used_behavior(struct rohc_comp_ctxt *const context,
 			                "context does, wait for %zu more packets without ECN "
 			                "before changing the context ecn_used parameter",
 			                MAX_FO_COUNT - tcp_context->ecn_used_zero_count);
-			tcp_context->tmp.ecn_used_changed = false;
+			tcp_field_set_changed(tcp_context, TCP_FIELD_ECN_USED, false);
 			tcp_context->ecn_used_zero_count++;
 		}
 		else
 		{
 			rohc_comp_debug(context, "ECN: behavior changed");
-			tcp_context->tmp.ecn_used_changed = true;
+			tcp_field_set_changed(tcp_context, TCP_FIELD_ECN_USED, true);
 			tcp_context->ecn_used =
 				!!(pkt_ecn_vals != 0 || tcp_res_flag_changed || pkt_outer_dscp_changed);
 			tcp_context->ecn_used_change_count = 0;
@@ -6904,14 +6759,14 @@ static void tcp_detect_ecn_used_behavior(struct rohc_comp_ctxt *const context,
 	{
 		rohc_comp_debug(context, "ECN: behavior didn't change but changed a few "
 		                "packet before");
-		tcp_context->tmp.ecn_used_changed = true;
+		tcp_field_set_changed(tcp_context, TCP_FIELD_ECN_USED, true);
 		tcp_context->ecn_used_change_count++;
 		tcp_context->ecn_used_zero_count = 0;
 	}
 	else
 	{
 		rohc_comp_debug(context, "ECN: behavior didn't change");
-		tcp_context->tmp.ecn_used_changed = false;
+		tcp_field_set_changed(tcp_context, TCP_FIELD_ECN_USED, false);
 		tcp_context->ecn_used_zero_count = 0;
 	}
 	rohc_comp_debug(context, "ECN: context does%s use ECN",
@@ -6919,6 +6774,43 @@ static void tcp_detect_ecn_used_behavior(struct rohc_comp_ctxt *const context,
 }
 
 
+/**
+ * @brief Whether at least one of the given fields changed in the current packet
+ *
+ * @param tcp_context  The specific TCP context
+ * @param fields       The TCP_FIELD_* flags of the fields to test
+ * @return             true if at least one of the fields changed,
+ *                     false otherwise
+ */
+static inline bool tcp_is_field_changed(const struct sc_tcp_context *const tcp_context,
+                                        const uint32_t fields)
+{
+	return ((tcp_context->tmp.changed_fields & fields) != 0);
+}
+
+
+/**
+ * @brief Record whether one field changed in the current packet or not
+ *
+ * @param tcp_context  The specific TCP context
+ * @param field        The TCP_FIELD_* flag of the field
+ * @param is_changed   Whether the field changed or not
+ */
+static inline void tcp_field_set_changed(struct sc_tcp_context *const tcp_context,
+                                         const uint32_t field,
+                                         const bool is_changed)
+{
+	if(is_changed)
+	{
+		tcp_context->tmp.changed_fields |= field;
+	}
+	else
+	{
+		tcp_context->tmp.changed_fields &= ~field;
+	}
+}
+
+
 /**
  * @brief Print a debug trace for the field change
  *
@@ -7223,43 +7115,66 @@ static void c_tcp_feedback_ack(struct rohc_comp_ctxt *const context,
 	 * is established, positive ACKs may remove older values from the windows */
 	if(!sn_not_valid)
 	{
+		const bool is_width_variable =
+			!!(context->compressor->features & ROHC_COMP_FEATURE_WLSB_VARIABLE_WIDTH);
+		uint32_t acked_sn;
 		size_t acked_nr;
 
+		/* all the windows share the MSNs of their entries: look for the
+		 * acknowledged MSN once, then ack all the windows with the full MSN */
+		if(!wlsb_get_acked_sn(&tcp_context->msn_wlsb, sn_bits, sn_bits_nr,
+		                      &acked_sn))
+		{
+			rohc_comp_debug(context, "FEEDBACK-2: positive ACK for an unknown "
+			                "SN, no value removed from the W-LSB windows");
+			return;
+		}
+
 		/* ack TTL or Hop Limit */
-		acked_nr = wlsb_ack(tcp_context->ttl_hopl_wlsb, sn_bits, sn_bits_nr);
+		acked_nr = wlsb_ack(&tcp_context->ttl_hopl_wlsb, acked_sn, 32,
+		                    is_width_variable);
 		rohc_comp_debug(context, "FEEDBACK-2: positive ACK removed %zu values "
 		                "from TTL or Hop Limit W-LSB", acked_nr);
 		/* ack innermost IP-ID */
-		acked_nr = wlsb_ack(tcp_context->ip_id_wlsb, sn_bits, sn_bits_nr);
+		acked_nr = wlsb_ack(&tcp_context->ip_id_wlsb, acked_sn, 32,
+		                    is_width_variable);
 		rohc_comp_debug(context, "FEEDBACK-2: positive ACK removed %zu values "
 		                "from innermost IP-ID W-LSB", acked_nr);
 		/* ack TCP window */
-		acked_nr = wlsb_ack(tcp_context->window_wlsb, sn_bits, sn_bits_nr);
+		acked_nr = wlsb_ack(&tcp_context->window_wlsb, acked_sn, 32,
+		                    is_width_variable);
 		rohc_comp_debug(context, "FEEDBACK-2: positive ACK removed %zu values "
 		                "from TCP window W-LSB", acked_nr);
 		/* ack TCP (scaled) sequence number */
-		acked_nr = wlsb_ack(tcp_context->seq_wlsb, sn_bits, sn_bits_nr);
+		acked_nr = wlsb_ack(&tcp_context->seq_wlsb, acked_sn, 32,
+		                    is_width_variable);
 		rohc_comp_debug(context, "FEEDBACK-2: positive ACK removed %zu values "
 		                "from TCP sequence number W-LSB", acked_nr);
-		acked_nr = wlsb_ack(tcp_context->seq_scaled_wlsb, sn_bits, sn_bits_nr);
+		acked_nr = wlsb_ack(&tcp_context->seq_scaled_wlsb, acked_sn, 32,
+		                    is_width_variable);
 		rohc_comp_debug(context, "FEEDBACK-2: positive ACK removed %zu values "
 		                "from TCP scaled sequence number W-LSB", acked_nr);
 		/* ack TCP (scaled) acknowledgment number */
-		acked_nr = wlsb_ack(tcp_context->ack_wlsb, sn_bits, sn_bits_nr);
+		acked_nr = wlsb_ack(&tcp_context->ack_wlsb, acked_sn, 32,
+		                    is_width_variable);
 		rohc_comp_debug(context, "FEEDBACK-2: positive ACK removed %zu values "
 		                "from TCP acknowledgment number W-LSB", acked_nr);
-		acked_nr = wlsb_ack(tcp_context->ack_scaled_wlsb, sn_bits, sn_bits_nr);
+		acked_nr = wlsb_ack(&tcp_context->ack_scaled_wlsb, acked_sn, 32,
+		                    is_width_variable);
 		rohc_comp_debug(context, "FEEDBACK-2: positive ACK removed %zu values "
 		                "from TCP scaled acknowledgment number W-LSB", acked_nr);
 		/* ack TCP TS option */
-		acked_nr = wlsb_ack(tcp_context->tcp_opts.ts_req_wlsb, sn_bits, sn_bits_nr);
+		acked_nr = wlsb_ack(&tcp_context->tcp_opts.ts_req_wlsb, acked_sn, 32,
+		                    is_width_variable);
 		rohc_comp_debug(context, "FEEDBACK-2: positive ACK removed %zu values "
 		                "from TCP TS request W-LSB", acked_nr);
-		acked_nr = wlsb_ack(tcp_context->tcp_opts.ts_reply_wlsb, sn_bits, sn_bits_nr);
+		acked_nr = wlsb_ack(&tcp_context->tcp_opts.ts_reply_wlsb, acked_sn, 32,
+		                    is_width_variable);
 		rohc_comp_debug(context, "FEEDBACK-2: positive ACK removed %zu values "
 		                "from TCP TS reply W-LSB", acked_nr);
 		/* ack SN */
-		acked_nr = wlsb_ack(tcp_context->msn_wlsb, sn_bits, sn_bits_nr);
+		acked_nr = wlsb_ack(&tcp_context->msn_wlsb, acked_sn, 32,
+		                    is_width_variable);
 		rohc_comp_debug(context, "FEEDBACK-2: positive ACK removed %zu values "
 		                "from SN W-LSB", acked_nr);
 	}
@@ -7281,5 +7196,7 @@ const struct rohc_comp_profile c_tcp_profile =
 	.encode         = c_tcp_encode,
 	.reinit_context = rohc_comp_reinit_context,
 	.feedback       = c_tcp_feedback,
+	.get_msn        = c_tcp_get_msn,
+	.set_next_msn   = c_tcp_set_next_msn,
 };
 
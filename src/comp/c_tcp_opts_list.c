@@ -65,6 +65,11 @@ static bool c_tcp_opt_get_type_len(const uint8_t *const opts_data,
                                    uint8_t *const opt_len)
 	__attribute__((warn_unused_result, nonnull(1, 3, 4)));
 
+static bool c_tcp_opts_is_layout_unchanged(const struct c_tcp_opts_ctxt *const opts_ctxt,
+                                           const uint8_t *const opts,
+                                           const size_t opts_len)
+	__attribute__((warn_unused_result, nonnull(1, 2), pure));
+
 static bool c_tcp_opt_changed(const struct c_tcp_opts_ctxt *const opts_ctxt,
                               const uint8_t opt_idx,
                               const uint8_t *const pkt_opt,
@@ -511,105 +516,165 @@ bool tcp_detect_options_changes(struct rohc_comp_ctxt *const context,
 		}
 	}
 
-	for(opt_pos = 0, opts_offset = 0;
-	    opt_pos < ROHC_TCP_OPTS_MAX && opts_offset < (*opts_len);
-	    opt_pos++, opts_offset += opt_len)
+	if(c_tcp_opts_is_layout_unchanged(opts_ctxt, opts, *opts_len))
 	{
-		uint8_t opt_type;
-
-		/* get type and length of the next TCP option */
-		if(!c_tcp_opt_get_type_len(opts + opts_offset, (*opts_len) - opts_offset,
-		                           &opt_type, &opt_len))
-		{
-			rohc_comp_warn(context, "malformed TCP header: failed to parse "
-			               "option #%zu", opt_pos + 1);
-			goto error;
-		}
-		rohc_comp_debug(context, "  TCP option %u found", opt_type);
-		rohc_comp_debug(context, "    option is %u-byte long", opt_len);
-
-		if(opt_type == TCP_OPT_TS)
+		/* same kinds and lengths at the very same locations as in previous
+		 * packet: re-use the indexes of the previous packet and only parse the
+		 * values that may change from one packet to another */
+		rohc_comp_debug(context, "  same layout of TCP options as in previous "
+		                "packet");
+		for(opt_pos = 0, opts_offset = 0; opt_pos < opts_ctxt->structure_nr;
+		    opt_pos++, opts_offset += opt_len)
 		{
-			memcpy(&opts_ctxt->tmp.ts_req, opts + opts_offset + 2, sizeof(uint32_t));
-			opts_ctxt->tmp.ts_req = rohc_ntoh32(opts_ctxt->tmp.ts_req);
-			memcpy(&opts_ctxt->tmp.ts_reply, opts + opts_offset + 6, sizeof(uint32_t));
-			opts_ctxt->tmp.ts_reply = rohc_ntoh32(opts_ctxt->tmp.ts_reply);
-			opts_ctxt->tmp.opt_ts_present = true;
-		}
+			const uint8_t opt_type = opts_ctxt->structure[opt_pos];
 
-		/* determine the index of the TCP option */
-		opt_idx = c_tcp_get_opt_index(context, opts_ctxt, opt_type, indexes_in_use);
-		indexes_in_use[opt_idx] = true;
+			opt_len = opts_ctxt->layout_lens[opt_pos];
+			opt_idx = opts_ctxt->layout_indexes[opt_pos];
 
-		/* the EOL, MSS, and WS options are 'static options': they cannot be
-		 * transmitted in irregular chain if their value changed, so the compressor
-		 * needs to detect such changes and to select a packet type that can
-		 * transmit their changes, ie. IR, IR-DYN, co_common, rnd_8 or seq_8 */
-		if(opt_type == TCP_OPT_EOL || opt_type == TCP_OPT_MSS || opt_type == TCP_OPT_WS)
-		{
-			if(opts_ctxt->list[opt_idx].used &&
-			   c_tcp_opt_changed(opts_ctxt, opt_idx, opts + opts_offset, opt_len))
+			if(opt_type == TCP_OPT_TS)
 			{
-				rohc_comp_debug(context, "    static option changed of value");
+				memcpy(&opts_ctxt->tmp.ts_req, opts + opts_offset + 2, sizeof(uint32_t));
+				opts_ctxt->tmp.ts_req = rohc_ntoh32(opts_ctxt->tmp.ts_req);
+				memcpy(&opts_ctxt->tmp.ts_reply, opts + opts_offset + 6, sizeof(uint32_t));
+				opts_ctxt->tmp.ts_reply = rohc_ntoh32(opts_ctxt->tmp.ts_reply);
+				opts_ctxt->tmp.opt_ts_present = true;
+			}
+			else if((opt_type == TCP_OPT_EOL || opt_type == TCP_OPT_MSS ||
+			         opt_type == TCP_OPT_WS) &&
+			        c_tcp_opt_changed(opts_ctxt, opt_idx, opts + opts_offset, opt_len))
+			{
+				rohc_comp_debug(context, "    static option '%s' (%u) changed of "
+				                "value", tcp_opt_get_descr(opt_type), opt_type);
 				opts_ctxt->tmp.do_list_static_changed = true;
 			}
-		}
 
-		/* was the option already used? */
-		if(opts_ctxt->list[opt_idx].used)
-		{
-			rohc_comp_debug(context, "    option '%s' (%u) will use same "
-			                "index %u as in previous packet",
-			                tcp_opt_get_descr(opt_type), opt_type, opt_idx);
 			/* option was grown old with all the others, make it grow young again */
+			assert(opts_ctxt->list[opt_idx].used);
 			if(opts_ctxt->list[opt_idx].age > 0)
 			{
 				opts_ctxt->list[opt_idx].age--;
 			}
+			opts_ctxt->tmp.position2index[opt_pos] = opt_idx;
+			if(opt_idx > opts_ctxt->tmp.idx_max)
+			{
+				opts_ctxt->tmp.idx_max = opt_idx;
+			}
 		}
-		else
-		{
-			/* now index is used by this option */
-			opts_ctxt->list[opt_idx].used = true;
-			opts_ctxt->list[opt_idx].type = opt_type;
-			opts_ctxt->list[opt_idx].nr_trans = 0;
-			opts_ctxt->list[opt_idx].age = 0;
-			rohc_comp_debug(context, "    option '%s' (%u) will use new index %u",
-			                tcp_opt_get_descr(opt_type), opt_type, opt_idx);
-		}
-		opts_ctxt->tmp.position2index[opt_pos] = opt_idx;
-		opts_ctxt->tmp.nr++;
-		if(opt_idx > opts_ctxt->tmp.idx_max)
-		{
-			opts_ctxt->tmp.idx_max = opt_idx;
-		}
+		opts_ctxt->tmp.nr = opts_ctxt->structure_nr;
+		opts_nr = opts_ctxt->structure_nr;
+	}
+	else
+	{
+		/* the layout of the previous packet cannot be trusted anymore until the
+		 * new one is successfully parsed */
+		opts_ctxt->is_layout_cached = false;
 
-		/* was the TCP option present at the very same location in previous
-		 * packet? */
-		if(opt_pos >= opts_ctxt->structure_nr ||
-		   opts_ctxt->structure[opt_pos] != opt_type)
+		for(opt_pos = 0, opts_offset = 0;
+		    opt_pos < ROHC_TCP_OPTS_MAX && opts_offset < (*opts_len);
+		    opt_pos++, opts_offset += opt_len)
 		{
-			rohc_comp_debug(context, "    option was not present at the very "
-			                "same location in previous packet");
-			opts_ctxt->tmp.do_list_struct_changed = true;
+			uint8_t opt_type;
+
+			/* get type and length of the next TCP option */
+			if(!c_tcp_opt_get_type_len(opts + opts_offset, (*opts_len) - opts_offset,
+			                           &opt_type, &opt_len))
+			{
+				rohc_comp_warn(context, "malformed TCP header: failed to parse "
+				               "option #%zu", opt_pos + 1);
+				goto error;
+			}
+			rohc_comp_debug(context, "  TCP option %u found", opt_type);
+			rohc_comp_debug(context, "    option is %u-byte long", opt_len);
+
+			if(opt_type == TCP_OPT_TS)
+			{
+				memcpy(&opts_ctxt->tmp.ts_req, opts + opts_offset + 2, sizeof(uint32_t));
+				opts_ctxt->tmp.ts_req = rohc_ntoh32(opts_ctxt->tmp.ts_req);
+				memcpy(&opts_ctxt->tmp.ts_reply, opts + opts_offset + 6, sizeof(uint32_t));
+				opts_ctxt->tmp.ts_reply = rohc_ntoh32(opts_ctxt->tmp.ts_reply);
+				opts_ctxt->tmp.opt_ts_present = true;
+			}
+
+			/* determine the index of the TCP option */
+			opt_idx = c_tcp_get_opt_index(context, opts_ctxt, opt_type, indexes_in_use);
+			indexes_in_use[opt_idx] = true;
+
+			/* the EOL, MSS, and WS options are 'static options': they cannot be
+			 * transmitted in irregular chain if their value changed, so the compressor
+			 * needs to detect such changes and to select a packet type that can
+			 * transmit their changes, ie. IR, IR-DYN, co_common, rnd_8 or seq_8 */
+			if(opt_type == TCP_OPT_EOL || opt_type == TCP_OPT_MSS || opt_type == TCP_OPT_WS)
+			{
+				if(opts_ctxt->list[opt_idx].used &&
+				   c_tcp_opt_changed(opts_ctxt, opt_idx, opts + opts_offset, opt_len))
+				{
+					rohc_comp_debug(context, "    static option changed of value");
+					opts_ctxt->tmp.do_list_static_changed = true;
+				}
+			}
+
+			/* was the option already used? */
+			if(opts_ctxt->list[opt_idx].used)
+			{
+				rohc_comp_debug(context, "    option '%s' (%u) will use same "
+				                "index %u as in previous packet",
+				                tcp_opt_get_descr(opt_type), opt_type, opt_idx);
+				/* option was grown old with all the others, make it grow young again */
+				if(opts_ctxt->list[opt_idx].age > 0)
+				{
+					opts_ctxt->list[opt_idx].age--;
+				}
+			}
+			else
+			{
+				/* now index is used by this option */
+				opts_ctxt->list[opt_idx].used = true;
+				opts_ctxt->list[opt_idx].type = opt_type;
+				opts_ctxt->list[opt_idx].nr_trans = 0;
+				opts_ctxt->list[opt_idx].age = 0;
+				rohc_comp_debug(context, "    option '%s' (%u) will use new index %u",
+				                tcp_opt_get_descr(opt_type), opt_type, opt_idx);
+			}
+			opts_ctxt->tmp.position2index[opt_pos] = opt_idx;
+			opts_ctxt->tmp.nr++;
+			if(opt_idx > opts_ctxt->tmp.idx_max)
+			{
+				opts_ctxt->tmp.idx_max = opt_idx;
+			}
+
+			/* was the TCP option present at the very same location in previous
+			 * packet? */
+			if(opt_pos >= opts_ctxt->structure_nr ||
+			   opts_ctxt->structure[opt_pos] != opt_type)
+			{
+				rohc_comp_debug(context, "    option was not present at the very "
+				                "same location in previous packet");
+				opts_ctxt->tmp.do_list_struct_changed = true;
+			}
+			else
+			{
+				rohc_comp_debug(context, "    option was at the very same location "
+				                "in previous packet");
+			}
+
+			/* record the structure of the current list TCP options in context */
+			opts_ctxt->structure[opt_pos] = opt_type;
+			opts_ctxt->layout_lens[opt_pos] = opt_len;
+			opts_ctxt->layout_indexes[opt_pos] = opt_idx;
 		}
-		else
+		if(opt_pos >= ROHC_TCP_OPTS_MAX && opts_offset != (*opts_len))
 		{
-			rohc_comp_debug(context, "    option was at the very same location "
-			                "in previous packet");
+			rohc_comp_warn(context, "unexpected TCP header: too many TCP options: "
+			               "%zu options found in packet but only %u options "
+			               "possible", opt_pos, ROHC_TCP_OPTS_MAX);
+			goto error;
 		}
+		opts_nr = opt_pos;
 
-		/* record the structure of the current list TCP options in context */
-		opts_ctxt->structure[opt_pos] = opt_type;
-	}
-	if(opt_pos >= ROHC_TCP_OPTS_MAX && opts_offset != (*opts_len))
-	{
-		rohc_comp_warn(context, "unexpected TCP header: too many TCP options: "
-		               "%zu options found in packet but only %u options "
-		               "possible", opt_pos, ROHC_TCP_OPTS_MAX);
-		goto error;
+		/* remember the layout of the TCP options for the next packet */
+		opts_ctxt->is_layout_cached = true;
+		opts_ctxt->layout_opts_len = (*opts_len);
 	}
-	opts_nr = opt_pos;
 
 	/* fewer options than in previous packet? */
 	for(opt_pos = opts_nr; opt_pos < opts_ctxt->structure_nr; opt_pos++)
@@ -681,6 +746,52 @@ error:
 }
 
 
+/**
+ * @brief Whether the TCP options got the same layout as in previous packet
+ *
+ * The layout is the same if the TCP options have the same total length, and
+ * if every TCP option has the same kind and the same length at the very same
+ * location as in previous packet.
+ *
+ * @param opts_ctxt  The compression context for TCP options
+ * @param opts       The TCP options of the packet to compress
+ * @param opts_len   The length (in bytes) of the TCP options
+ * @return           true if the layout is unchanged, false otherwise
+ */
+static bool c_tcp_opts_is_layout_unchanged(const struct c_tcp_opts_ctxt *const opts_ctxt,
+                                           const uint8_t *const opts,
+                                           const size_t opts_len)
+{
+	size_t opts_offset = 0;
+	size_t opt_pos;
+
+	if(!opts_ctxt->is_layout_cached || opts_len != opts_ctxt->layout_opts_len)
+	{
+		return false;
+	}
+
+	for(opt_pos = 0; opt_pos < opts_ctxt->structure_nr; opt_pos++)
+	{
+		const uint8_t opt_type = opts_ctxt->structure[opt_pos];
+
+		if(opts[opts_offset] != opt_type)
+		{
+			return false;
+		}
+		/* EOL spans the end of the options, NOP is one byte long, the length of
+		 * the other options is given by their 2nd byte */
+		if(opt_type != TCP_OPT_EOL && opt_type != TCP_OPT_NOP &&
+		   opts[opts_offset + 1] != opts_ctxt->layout_lens[opt_pos])
+		{
+			return false;
+		}
+		opts_offset += opts_ctxt->layout_lens[opt_pos];
+	}
+
+	return true;
+}
+
+
 /**
  * @brief Build the list of TCP options items
  *
@@ -838,8 +949,8 @@ int c_tcp_code_tcp_opts_list_item(const struct rohc_comp_ctxt *const context,
 			const struct tcp_option_timestamp *const opt_ts =
 				(struct tcp_option_timestamp *) (options + 2);
 			opts_ctxt->is_timestamp_init = true;
-			c_add_wlsb(opts_ctxt->ts_req_wlsb, msn, rohc_ntoh32(opt_ts->ts));
-			c_add_wlsb(opts_ctxt->ts_reply_wlsb, msn, rohc_ntoh32(opt_ts->ts_reply));
+			c_add_wlsb(&opts_ctxt->ts_req_wlsb, msn, rohc_ntoh32(opt_ts->ts));
+			c_add_wlsb(&opts_ctxt->ts_reply_wlsb, msn, rohc_ntoh32(opt_ts->ts_reply));
 		}
 	}
 	if(opt_pos >= ROHC_TCP_OPTS_MAX && i != 0)
@@ -976,8 +1087,8 @@ int c_tcp_code_tcp_opts_irreg(const struct rohc_comp_ctxt *const context,
 			/* TODO: move at the very end of compression to avoid altering
 			 *       context in case of compression failure */
 			opts_ctxt->is_timestamp_init = true;
-			c_add_wlsb(opts_ctxt->ts_req_wlsb, msn, rohc_ntoh32(opt_ts->ts));
-			c_add_wlsb(opts_ctxt->ts_reply_wlsb, msn, rohc_ntoh32(opt_ts->ts_reply));
+			c_add_wlsb(&opts_ctxt->ts_req_wlsb, msn, rohc_ntoh32(opt_ts->ts));
+			c_add_wlsb(&opts_ctxt->ts_reply_wlsb, msn, rohc_ntoh32(opt_ts->ts_reply));
 		}
 		else if(opt_type == TCP_OPT_SACK)
 		{
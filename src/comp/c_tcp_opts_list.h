@@ -31,6 +31,7 @@
 
 #include "rohc_comp_internals.h"
 #include "protocols/tcp.h"
+#include "schemes/comp_wlsb.h"
 
 #include <stdint.h>
 #include <stddef.h>
@@ -118,9 +119,18 @@ struct c_tcp_opts_ctxt
 	uint8_t structure[ROHC_TCP_OPTS_MAX];
 	struct c_tcp_opt_ctxt list[MAX_TCP_OPTION_INDEX + 1];
 
+	/** Whether the layout of the TCP options of the previous packet is known */
+	bool is_layout_cached;
+	/** The length (in bytes) of the TCP options of the previous packet */
+	size_t layout_opts_len;
+	/** The length of every TCP option of the previous packet */
+	uint8_t layout_lens[ROHC_TCP_OPTS_MAX];
+	/** The index of every TCP option of the previous packet */
+	uint8_t layout_indexes[ROHC_TCP_OPTS_MAX];
+
 	bool is_timestamp_init;
-	struct c_wlsb *ts_req_wlsb;
-	struct c_wlsb *ts_reply_wlsb;
+	struct c_wlsb ts_req_wlsb;
+	struct c_wlsb ts_reply_wlsb;
 
 	/** The temporary part of the context, shall be reset between 2 packets */
 	struct c_tcp_opts_ctxt_tmp tmp;
@@ -128,7 +128,8 @@ static bool c_udp_create(struct rohc_comp_ctxt *const context,
 	const struct udphdr *udp;
 
 	/* create and initialize the generic part of the profile context */
-	if(!rohc_comp_rfc3095_create(context, ROHC_LSB_SHIFT_SN, packet))
+	if(!rohc_comp_rfc3095_create(context, ROHC_LSB_SHIFT_SN,
+	                             sizeof(struct sc_udp_context), packet))
 	{
 		rohc_comp_warn(context, "generic context creation failed");
 		goto quit;
@@ -145,15 +146,9 @@ static bool c_udp_create(struct rohc_comp_ctxt *const context,
 	assert(packet->transport->data != NULL);
 	udp = (struct udphdr *) packet->transport->data;
 
-	/* create the UDP part of the profile context */
-	udp_context = malloc(sizeof(struct sc_udp_context));
-	if(udp_context == NULL)
-	{
-		rohc_error(context->compressor, ROHC_TRACE_COMP, context->profile->id,
-		           "no memory for the UDP part of the profile context");
-		goto clean;
-	}
-	rfc3095_ctxt->specific = udp_context;
+	/* the UDP part of the profile context was allocated along with the
+	 * generic part */
+	udp_context = (struct sc_udp_context *) rfc3095_ctxt->specific;
 
 	/* initialize the UDP part of the profile context */
 	udp_context->udp_checksum_change_count = 0;
@@ -180,8 +175,6 @@ static bool c_udp_create(struct rohc_comp_ctxt *const context,
 
 	return true;
 
-clean:
-	rohc_comp_rfc3095_destroy(context);
 quit:
 	return false;
 }
@@ -586,5 +579,7 @@ const struct rohc_comp_profile c_udp_profile =
 	.encode         = c_udp_encode,
 	.reinit_context = rohc_comp_reinit_context,
 	.feedback       = rohc_comp_rfc3095_feedback,
+	.get_msn        = rohc_comp_rfc3095_get_msn,
+	.set_next_msn   = rohc_comp_rfc3095_set_next_msn,
 };
 
@@ -176,7 +176,8 @@ static bool c_udp_lite_create(struct rohc_comp_ctxt *const context,
 	const struct udphdr *udp_lite;
 
 	/* create and initialize the generic part of the profile context */
-	if(!rohc_comp_rfc3095_create(context, ROHC_LSB_SHIFT_SN, packet))
+	if(!rohc_comp_rfc3095_create(context, ROHC_LSB_SHIFT_SN,
+	                             sizeof(struct sc_udp_lite_context), packet))
 	{
 		rohc_comp_warn(context, "generic context creation failed");
 		goto quit;
@@ -193,15 +194,9 @@ static bool c_udp_lite_create(struct rohc_comp_ctxt *const context,
 	assert(packet->transport->data != NULL);
 	udp_lite = (struct udphdr *) packet->transport->data;
 
-	/* create the UDP-Lite part of the profile context */
-	udp_lite_context = malloc(sizeof(struct sc_udp_lite_context));
-	if(udp_lite_context == NULL)
-	{
-		rohc_error(context->compressor, ROHC_TRACE_COMP, context->profile->id,
-		           "no memory for the UDP-Lite part of the profile context");
-		goto clean;
-	}
-	rfc3095_ctxt->specific = udp_lite_context;
+	/* the UDP-Lite part of the profile context was allocated along with the
+	 * generic part */
+	udp_lite_context = (struct sc_udp_lite_context *) rfc3095_ctxt->specific;
 
 	/* initialize the UDP-Lite part of the profile context */
 	udp_lite_context->cfp = 0;
@@ -235,8 +230,6 @@ static bool c_udp_lite_create(struct rohc_comp_ctxt *const context,
 
 	return true;
 
-clean:
-	rohc_comp_rfc3095_destroy(context);
 quit:
 	return false;
 }
@@ -620,7 +613,7 @@ static void udp_lite_init_cc(struct rohc_comp_ctxt *const context,
 
 	rohc_comp_debug(context, "CFP = %d, CFI = %d (ir_count = %zu)",
 	                udp_lite_context->cfp, udp_lite_context->cfi,
-	                context->ir_count);
+	                (size_t) context->ir_count);
 
 	udp_lite_context->cfp =
 		(rohc_ntoh16(udp_lite->len) != packet_length) || udp_lite_context->cfp;
@@ -662,6 +655,28 @@ static bool udp_lite_send_cce_packet(const struct rohc_comp_ctxt *const context,
 	assert(rfc3095_ctxt->specific != NULL);
 	udp_lite_context = (struct sc_udp_lite_context *) rfc3095_ctxt->specific;
 
+	/* fast path for the most common case: the checksum coverage is inferred
+	 * from the UDP-Lite length, the decompressor already knows it and no CCE
+	 * packet remains to be repeated, so only the counters change */
+	if(udp_lite_context->cfp == 0 && udp_lite_context->cfi == 1 &&
+	   udp_lite_context->sent_cce_only_count == 0 &&
+	   udp_lite_context->sent_cce_off_count >= MAX_IR_COUNT &&
+	   udp_lite_context->sent_cce_on_count >= MAX_IR_COUNT &&
+	   rohc_ntoh16(udp_lite->len) == udp_lite_context->tmp.udp_size)
+	{
+		if(udp_lite_context->old_udp_lite.len == udp_lite->len)
+		{
+			udp_lite_context->coverage_equal_count++;
+		}
+		else
+		{
+			udp_lite_context->coverage_equal_count = 0;
+		}
+		udp_lite_context->coverage_inferred_count++;
+		udp_lite_context->tmp_coverage = udp_lite->len;
+		return false;
+	}
+
 	rohc_comp_debug(context, "CFP = %d, CFI = %d", udp_lite_context->cfp,
 	                udp_lite_context->cfi);
 
@@ -837,5 +852,7 @@ const struct rohc_comp_profile c_udp_lite_profile =
 	.encode         = c_udp_lite_encode,
 	.reinit_context = rohc_comp_reinit_context,
 	.feedback       = rohc_comp_rfc3095_feedback,
+	.get_msn        = rohc_comp_rfc3095_get_msn,
+	.set_next_msn   = rohc_comp_rfc3095_set_next_msn,
 };
 
@@ -460,6 +460,7 @@ static int uncompressed_code_IR_packet(const struct rohc_comp_ctxt *context,
                                        const size_t rohc_pkt_max_len,
                                        size_t *const payload_offset)
 {
+	rohc_ticks_t crc_ticks;
 	size_t counter;
 	size_t first_position;
 	int ret;
@@ -470,8 +471,8 @@ static int uncompressed_code_IR_packet(const struct rohc_comp_ctxt *context,
 	 *  - part 2 will be placed at 'first_position'
 	 *  - part 4 will start at 'counter'
 	 */
-	ret = code_cid_values(context->compressor->medium.cid_type, context->cid,
-	                      rohc_pkt, rohc_pkt_max_len, &first_position);
+	ret = code_cid_values(&context->cid_code, rohc_pkt, rohc_pkt_max_len,
+	                      &first_position);
 	if(ret < 1)
 	{
 		rohc_comp_warn(context, "failed to encode %s CID %zu: maybe the "
@@ -504,9 +505,10 @@ static int uncompressed_code_IR_packet(const struct rohc_comp_ctxt *context,
 
 	/* part 5 */
 	rohc_pkt[counter] = 0;
+	crc_ticks = rohc_comp_ticks(context->compressor);
 	rohc_pkt[counter] = crc_calculate(ROHC_CRC_TYPE_8, rohc_pkt, counter,
-	                                  CRC_INIT_8,
-	                                  context->compressor->crc_table_8);
+	                                  CRC_INIT_8);
+	rohc_comp_crc_ticks_add(context->compressor, crc_ticks);
 	rohc_comp_debug(context, "CRC on %zu bytes = 0x%02x", counter,
 	                rohc_pkt[counter]);
 	counter++;
@@ -570,8 +572,8 @@ static int uncompressed_code_normal_packet(const struct rohc_comp_ctxt *context,
 	 *  - part 2 will be placed at 'first_position'
 	 *  - part 4 will start at 'counter'
 	 */
-	ret = code_cid_values(context->compressor->medium.cid_type, context->cid,
-	                      rohc_pkt, rohc_pkt_max_len, &first_position);
+	ret = code_cid_values(&context->cid_code, rohc_pkt, rohc_pkt_max_len,
+	                      &first_position);
 	if(ret < 1)
 	{
 		rohc_comp_warn(context, "failed to encode %s CID %zu: maybe the "
@@ -614,5 +616,7 @@ const struct rohc_comp_profile c_uncompressed_profile =
 	.encode         = c_uncompressed_encode,
 	.reinit_context = c_uncompressed_reinit_context,
 	.feedback       = uncomp_feedback,
+	.get_msn        = NULL,
+	.set_next_msn   = NULL,
 };
 
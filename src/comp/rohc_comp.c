@@ -50,11 +50,17 @@
 #include "sdvl.h"
 #include "rohc_add_cid.h"
 #include "rohc_bit_ops.h"
+#include "rohc_bitmap.h"
 #include "ip.h"
 #include "crc.h"
 #include "protocols/udp.h"
+#include "protocols/rtp.h"
 #include "protocols/ip_numbers.h"
 #include "feedback_parse.h"
+#include "schemes/comp_wlsb.h"
+#include "rohc_alloc.h"
+#include "rohc_numa.h"
+#include "rohc_probes_internal.h"
 
 #include "config.h" /* for PACKAGE_(NAME|URL|VERSION) */
 
@@ -71,45 +77,246 @@
 #include <stdarg.h>
 
 
-extern const struct rohc_comp_profile c_rtp_profile,
-                                      c_udp_profile,
-                                      c_udp_lite_profile,
-                                      c_esp_profile,
-                                      c_tcp_profile,
-                                      c_ip_profile,
-                                      c_uncompressed_profile;
+/** The magic number at the beginning of the snapshots of contexts */
+#define ROHC_COMP_SNAPSHOT_MAGIC    "RCTX"
+/** The magic number at the beginning of the change logs of contexts */
+#define ROHC_COMP_CHANGES_MAGIC     "RCTC"
+/** The version of the format of the snapshots of contexts */
+#define ROHC_COMP_SNAPSHOT_VERSION  1U
+/** The length of the header of the snapshots and change logs of contexts */
+#define ROHC_COMP_SNAPSHOT_HDR_LEN  12U
+/** The length of the fixed part of one context in the snapshots and change
+ *  logs, the CID excluded */
+#define ROHC_COMP_SNAPSHOT_CTXT_LEN  12U
+/** The number of times the headers of one snapshot are compressed again
+ *  when the context is imported */
+#define ROHC_COMP_SNAPSHOT_WARMUP_NR  (MAX_IR_COUNT + MAX_FO_COUNT)
+
+
+#if ROHC_PROFILE_RTP_BUILT
+extern const struct rohc_comp_profile c_rtp_profile;
+#endif
+#if ROHC_PROFILE_UDP_BUILT
+extern const struct rohc_comp_profile c_udp_profile;
+#endif
+#if ROHC_PROFILE_UDPLITE_BUILT
+extern const struct rohc_comp_profile c_udp_lite_profile;
+#endif
+#if ROHC_PROFILE_ESP_BUILT
+extern const struct rohc_comp_profile c_esp_profile;
+#endif
+#if ROHC_PROFILE_TCP_BUILT
+extern const struct rohc_comp_profile c_tcp_profile;
+#endif
+#if ROHCv2_PROFILE_IP_UDP_RTP_BUILT
+extern const struct rohc_comp_profile c_rfc5225_rtp_profile;
+#endif
+#if ROHCv2_PROFILE_IP_UDP_BUILT
+extern const struct rohc_comp_profile c_rfc5225_udp_profile;
+#endif
+#if ROHCv2_PROFILE_IP_ESP_BUILT
+extern const struct rohc_comp_profile c_rfc5225_esp_profile;
+#endif
+#if ROHCv2_PROFILE_IP_BUILT
+extern const struct rohc_comp_profile c_rfc5225_ip_only_profile;
+#endif
+#if ROHC_PROFILE_IP_BUILT
+extern const struct rohc_comp_profile c_ip_profile;
+#endif
+extern const struct rohc_comp_profile c_uncompressed_profile;
 
 /**
  * @brief The compression parts of the ROHC profiles.
  *
  * The order of profiles declaration is important: they are evaluated in that
  * order. The RTP profile shall be declared before the UDP one for example.
+ *
+ * The profiles left out of the build (see rohc_profiles_config.h) are not
+ * declared at all, so that the classification of packets only runs the
+ * checks of the profiles that the library provides.
  */
 static const struct rohc_comp_profile *const rohc_comp_profiles[C_NUM_PROFILES] =
 {
+#if ROHC_PROFILE_RTP_BUILT
 	&c_rtp_profile,
+#endif
+#if ROHC_PROFILE_UDP_BUILT
 	&c_udp_profile,  /* must be declared after RTP profile */
+#endif
+#if ROHC_PROFILE_UDPLITE_BUILT
 	&c_udp_lite_profile,
+#endif
+#if ROHC_PROFILE_ESP_BUILT
 	&c_esp_profile,
+#endif
+#if ROHC_PROFILE_TCP_BUILT
 	&c_tcp_profile,
+#endif
+#if ROHCv2_PROFILE_IP_UDP_RTP_BUILT
+	&c_rfc5225_rtp_profile,
+#endif
+#if ROHCv2_PROFILE_IP_UDP_BUILT
+	&c_rfc5225_udp_profile,  /* must be declared after the ROHCv2 RTP profile */
+#endif
+#if ROHCv2_PROFILE_IP_ESP_BUILT
+	&c_rfc5225_esp_profile,
+#endif
+#if ROHCv2_PROFILE_IP_BUILT
+	&c_rfc5225_ip_only_profile,  /* must be declared after the other ROHCv2 profiles */
+#endif
+#if ROHC_PROFILE_IP_BUILT
 	&c_ip_profile,  /* must be declared after all IP-based profiles */
+#endif
 	&c_uncompressed_profile, /* must be declared last */
 };
 
 
+/* the locations of the profiles in \ref rohc_comp_profiles */
+#define C_PROFILE_IDX_RTP      0U
+#define C_PROFILE_IDX_UDP      (C_PROFILE_IDX_RTP + ROHC_PROFILE_RTP_BUILT)
+#define C_PROFILE_IDX_UDPLITE  (C_PROFILE_IDX_UDP + ROHC_PROFILE_UDP_BUILT)
+#define C_PROFILE_IDX_ESP      (C_PROFILE_IDX_UDPLITE + ROHC_PROFILE_UDPLITE_BUILT)
+#define C_PROFILE_IDX_TCP      (C_PROFILE_IDX_ESP + ROHC_PROFILE_ESP_BUILT)
+#define C_PROFILE_IDX_V2RTP    (C_PROFILE_IDX_TCP + ROHC_PROFILE_TCP_BUILT)
+#define C_PROFILE_IDX_V2UDP    (C_PROFILE_IDX_V2RTP + ROHCv2_PROFILE_IP_UDP_RTP_BUILT)
+#define C_PROFILE_IDX_V2ESP    (C_PROFILE_IDX_V2UDP + ROHCv2_PROFILE_IP_UDP_BUILT)
+#define C_PROFILE_IDX_V2IP     (C_PROFILE_IDX_V2ESP + ROHCv2_PROFILE_IP_ESP_BUILT)
+#define C_PROFILE_IDX_IP       (C_PROFILE_IDX_V2IP + ROHCv2_PROFILE_IP_BUILT)
+#define C_PROFILE_IDX_UNCOMP   (C_PROFILE_IDX_IP + ROHC_PROFILE_IP_BUILT)
+
+/**
+ * @brief The locations of the profiles in \ref rohc_comp_profiles, indexed
+ *        by ROHC version then by the 8 LSB of the profile ID
+ *
+ * C_NUM_PROFILES stands for the profiles that the library does not
+ * implement or that were left out of the build.
+ */
+static const uint8_t rohc_comp_profiles_idx[2][ROHC_PROFILE_UDPLITE + 1] =
+{
+	/* ROHCv1 profiles */
+	{
+		[ROHC_PROFILE_UNCOMPRESSED] = C_PROFILE_IDX_UNCOMP,
+		[ROHC_PROFILE_RTP]          =
+			ROHC_PROFILE_LOC(ROHC_PROFILE_RTP_BUILT, C_PROFILE_IDX_RTP,
+			                 C_NUM_PROFILES),
+		[ROHC_PROFILE_UDP]          =
+			ROHC_PROFILE_LOC(ROHC_PROFILE_UDP_BUILT, C_PROFILE_IDX_UDP,
+			                 C_NUM_PROFILES),
+		[ROHC_PROFILE_ESP]          =
+			ROHC_PROFILE_LOC(ROHC_PROFILE_ESP_BUILT, C_PROFILE_IDX_ESP,
+			                 C_NUM_PROFILES),
+		[ROHC_PROFILE_IP]           =
+			ROHC_PROFILE_LOC(ROHC_PROFILE_IP_BUILT, C_PROFILE_IDX_IP,
+			                 C_NUM_PROFILES),
+		[ROHC_PROFILE_RTP_LLA]      = C_NUM_PROFILES,
+		[ROHC_PROFILE_TCP]          =
+			ROHC_PROFILE_LOC(ROHC_PROFILE_TCP_BUILT, C_PROFILE_IDX_TCP,
+			                 C_NUM_PROFILES),
+		[ROHC_PROFILE_UDPLITE_RTP]  = C_NUM_PROFILES,
+		[ROHC_PROFILE_UDPLITE]      =
+			ROHC_PROFILE_LOC(ROHC_PROFILE_UDPLITE_BUILT, C_PROFILE_IDX_UDPLITE,
+			                 C_NUM_PROFILES),
+	},
+	/* ROHCv2 profiles */
+	{
+		[0x00]                      = C_NUM_PROFILES,
+		[ROHCv2_PROFILE_IP_UDP_RTP & 0xff] =
+			ROHC_PROFILE_LOC(ROHCv2_PROFILE_IP_UDP_RTP_BUILT, C_PROFILE_IDX_V2RTP,
+			                 C_NUM_PROFILES),
+		[ROHCv2_PROFILE_IP_UDP & 0xff] =
+			ROHC_PROFILE_LOC(ROHCv2_PROFILE_IP_UDP_BUILT, C_PROFILE_IDX_V2UDP,
+			                 C_NUM_PROFILES),
+		[ROHCv2_PROFILE_IP_ESP & 0xff] =
+			ROHC_PROFILE_LOC(ROHCv2_PROFILE_IP_ESP_BUILT, C_PROFILE_IDX_V2ESP,
+			                 C_NUM_PROFILES),
+		[ROHCv2_PROFILE_IP & 0xff]  =
+			ROHC_PROFILE_LOC(ROHCv2_PROFILE_IP_BUILT, C_PROFILE_IDX_V2IP,
+			                 C_NUM_PROFILES),
+		[0x05]                      = C_NUM_PROFILES,
+		[0x06]                      = C_NUM_PROFILES,
+		[0x07]                      = C_NUM_PROFILES,
+		[0x08]                      = C_NUM_PROFILES,
+	},
+};
+
+
 /*
  * Prototypes of private functions related to ROHC compression profiles
  */
 
+static size_t rohc_comp_profile_idx(const rohc_profile_t profile_id)
+	__attribute__((warn_unused_result, const));
+
 static const struct rohc_comp_profile *
 	rohc_get_profile_from_id(const struct rohc_comp *comp,
 	                         const rohc_profile_t profile_id)
 	__attribute__((warn_unused_result, nonnull(1)));
 
 static const struct rohc_comp_profile *
-	c_get_profile_from_packet(const struct rohc_comp *const comp,
+	c_get_profile_from_packet(struct rohc_comp *const comp,
 	                          const struct net_pkt *const packet)
 	__attribute__((warn_unused_result, nonnull(1, 2)));
+static void c_classif_cache_flush(struct rohc_comp *const comp)
+	__attribute__((nonnull(1)));
+
+static void c_notify_ctxt_event(const struct rohc_comp_ctxt *const context,
+                                const rohc_comp_event_t event,
+                                const rohc_comp_state_t old_state,
+                                const rohc_mode_t old_mode)
+	__attribute__((nonnull(1)));
+
+
+/*
+ * Prototypes of private functions related to the compression of packets
+ */
+
+static void c_trace_sample(struct rohc_comp *const comp,
+                           const bool cid_known,
+                           const rohc_cid_t cid)
+	__attribute__((nonnull(1)));
+static bool c_check_bufs(const struct rohc_comp *const comp,
+                         const struct rohc_buf uncomp_packet,
+                         const struct rohc_buf *const rohc_packet)
+	__attribute__((nonnull(1), warn_unused_result));
+static bool c_parse_packet(const struct rohc_comp *const comp,
+                           const struct rohc_buf uncomp_packet,
+                           const bool classify,
+                           struct net_pkt *const ip_pkt)
+	__attribute__((nonnull(1, 4), warn_unused_result));
+static rohc_status_t c_compress_in_ctxt(struct rohc_comp *const comp,
+                                        struct rohc_comp_ctxt *const context,
+                                        const struct net_pkt *const packet,
+                                        const struct rohc_buf uncomp_packet,
+                                        struct rohc_buf *const rohc_packet,
+                                        struct rohc_buf *const payload)
+	__attribute__((nonnull(1, 2, 3, 5), warn_unused_result));
+static void c_save_snapshot(struct rohc_comp *const comp,
+                            const struct rohc_comp_ctxt *const context,
+                            const struct rohc_buf uncomp_packet,
+                            const size_t hdrs_len)
+	__attribute__((nonnull(1, 2)));
+static void c_log_packet(struct rohc_comp *const comp,
+                         const struct rohc_comp_ctxt *const context,
+                         const rohc_packet_t packet_type,
+                         const rohc_status_t status)
+	__attribute__((nonnull(1, 2)));
+static size_t c_compress_burst(struct rohc_comp *const comp,
+                               const struct rohc_buf *const uncomp_packets,
+                               const int *const pkt_flags,
+                               const size_t packets_nr,
+                               struct rohc_buf *const rohc_packets,
+                               struct rohc_buf *const arena,
+                               rohc_comp_burst_desc_t *const descs,
+                               rohc_status_t *const statuses)
+	__attribute__((nonnull(1, 2, 8), warn_unused_result));
+static bool c_prepare_packet(struct rohc_comp *const comp,
+                             const struct rohc_buf uncomp_packet,
+                             const int pkt_flags,
+                             const struct rohc_buf *const rohc_packet,
+                             struct net_pkt *const ip_pkt,
+                             const struct rohc_comp_profile **const profile,
+                             rohc_ctxt_key_t *const flow_hash)
+	__attribute__((nonnull(1, 4, 5, 6, 7), warn_unused_result));
 
 
 /*
@@ -118,8 +325,34 @@ static const struct rohc_comp_profile *
 
 static bool c_create_contexts(struct rohc_comp *const comp)
 	__attribute__((nonnull(1)));
+static bool c_alloc_ctxts_chunk(struct rohc_comp *const comp,
+                                const size_t chunk_idx)
+	__attribute__((nonnull(1), warn_unused_result));
+static bool c_alloc_ctxts_chunks(struct rohc_comp *const comp,
+                                 const rohc_cid_t cid_first,
+                                 const rohc_cid_t cid_last)
+	__attribute__((nonnull(1), warn_unused_result));
+static bool c_grow_index(struct rohc_comp *const comp, const size_t ctxts_nr)
+	__attribute__((nonnull(1), warn_unused_result));
+static struct rohc_comp_ctxt *
+	c_ctxt_at(const struct rohc_comp *const comp, const rohc_cid_t cid)
+	__attribute__((nonnull(1), warn_unused_result, pure));
+static struct rohc_comp_ctxt_stats *
+	c_ctxt_stats_at(const struct rohc_comp *const comp, const rohc_cid_t cid)
+	__attribute__((nonnull(1), warn_unused_result, pure));
+static void c_chain_unused_contexts(struct rohc_comp *const comp)
+	__attribute__((nonnull(1)));
+static bool c_peek_unused_context(struct rohc_comp *const comp,
+                                  struct rohc_comp_ctxt **const context)
+	__attribute__((nonnull(1, 2), warn_unused_result));
+static void c_take_unused_context(struct rohc_comp *const comp,
+                                  struct rohc_comp_ctxt *const context)
+	__attribute__((nonnull(1, 2)));
 static void c_destroy_contexts(struct rohc_comp *const comp)
 	__attribute__((nonnull(1)));
+static rohc_cid_t c_next_used_cid(const struct rohc_comp *const comp,
+                                  const rohc_cid_t from)
+	__attribute__((warn_unused_result, nonnull(1)));
 
 static struct rohc_comp_ctxt *
 	c_create_context(struct rohc_comp *const comp,
@@ -127,15 +360,152 @@ static struct rohc_comp_ctxt *
 	                 const struct net_pkt *const packet,
 	                 const struct rohc_ts arrival_time)
 	__attribute__((nonnull(1, 2, 3), warn_unused_result));
+static bool c_init_context(struct rohc_comp *const comp,
+                           struct rohc_comp_ctxt *const context,
+                           const struct rohc_comp_profile *const profile,
+                           const struct net_pkt *const packet,
+                           const struct rohc_ts arrival_time)
+	__attribute__((nonnull(1, 2, 3, 4), warn_unused_result));
+static bool c_import_context(struct rohc_comp *const comp,
+                             const rohc_cid_t cid,
+                             const rohc_profile_t profile_id,
+                             const rohc_mode_t mode,
+                             const rohc_comp_state_t state,
+                             const uint32_t *const msn,
+                             const uint8_t *const record_hdrs,
+                             const size_t hdrs_len,
+                             const size_t pkt_len,
+                             uint8_t *const pkt_mem)
+	__attribute__((nonnull(1, 7, 10), warn_unused_result));
+static bool c_snapshot_write_hdr(const struct rohc_comp *const comp,
+                                 struct rohc_buf *const buf,
+                                 const char *const magic)
+	__attribute__((nonnull(1, 3), warn_unused_result));
+static void c_snapshot_write_ctxts_nr(struct rohc_buf *const buf,
+                                      const size_t hdr_offset,
+                                      const uint32_t ctxts_nr)
+	__attribute__((nonnull(1)));
+static bool c_snapshot_parse_hdr(const struct rohc_comp *const comp,
+                                 struct rohc_buf *const remain_data,
+                                 const char *const magic,
+                                 uint32_t *const ctxts_nr)
+	__attribute__((nonnull(1, 2, 3, 4), warn_unused_result));
+static bool c_snapshot_is_ctxt_saved(const struct rohc_comp *const comp,
+                                     const rohc_cid_t cid)
+	__attribute__((nonnull(1), warn_unused_result, pure));
+static bool c_snapshot_write_ctxt(const struct rohc_comp *const comp,
+                                  const rohc_cid_t cid,
+                                  struct rohc_buf *const buf)
+	__attribute__((nonnull(1, 3), warn_unused_result));
+static bool c_snapshot_read_ctxt(struct rohc_comp *const comp,
+                                 const rohc_cid_t cid,
+                                 struct rohc_buf *const remain_data,
+                                 uint8_t *const pkt_mem)
+	__attribute__((nonnull(1, 3, 4), warn_unused_result));
 static struct rohc_comp_ctxt *
 	rohc_comp_find_ctxt(struct rohc_comp *const comp,
 	                    const struct net_pkt *const packet,
 	                    const int profile_id_hint,
 	                    const struct rohc_ts arrival_time)
 	__attribute__((nonnull(1, 2), warn_unused_result));
+static struct rohc_comp_ctxt *
+	c_find_ctxt_for_flow(struct rohc_comp *const comp,
+	                     const struct rohc_comp_profile *const profile,
+	                     const struct net_pkt *const packet,
+	                     const rohc_ctxt_key_t flow_hash,
+	                     const struct rohc_ts arrival_time)
+	__attribute__((nonnull(1, 2, 3), warn_unused_result));
 static struct rohc_comp_ctxt *
 	c_get_context(struct rohc_comp *const comp, const rohc_cid_t cid)
 	__attribute__((nonnull(1), warn_unused_result));
+static void c_destroy_context(struct rohc_comp *const comp,
+                              struct rohc_comp_ctxt *const context)
+	__attribute__((nonnull(1, 2)));
+static void c_reset_ctxt_stats(struct rohc_comp *const comp,
+                               const struct rohc_comp_ctxt *const context)
+	__attribute__((nonnull(1, 2)));
+static void c_arm_refresh_timer(struct rohc_comp_ctxt *const context,
+                                struct rohc_comp_timer *const timer,
+                                const uint64_t timeout)
+	__attribute__((nonnull(1, 2)));
+static bool c_reinit_is_allowed(struct rohc_comp *const comp,
+                                const uint64_t now)
+	__attribute__((nonnull(1), warn_unused_result));
+static void c_credit_refill(struct rohc_comp_credit *const credit,
+                            const uint64_t now)
+	__attribute__((nonnull(1)));
+static bool c_credit_is_available(const struct rohc_comp_credit *const credit)
+	__attribute__((nonnull(1), warn_unused_result, pure));
+
+static void c_timings_set_pending(struct rohc_comp *const comp,
+                                  const rohc_ticks_t parse_ticks,
+                                  const rohc_ticks_t lookup_ticks)
+	__attribute__((nonnull(1)));
+static void c_timings_clear_pending(struct rohc_comp *const comp)
+	__attribute__((nonnull(1)));
+static void c_timings_reset_crc(struct rohc_comp *const comp)
+	__attribute__((nonnull(1)));
+static void c_timings_record(struct rohc_comp *const comp,
+                             const rohc_profile_t profile,
+                             const rohc_packet_t packet_type,
+                             const rohc_ticks_t encode_ticks,
+                             const rohc_ticks_t payload_ticks)
+	__attribute__((nonnull(1)));
+static void c_timings_record_feedback(struct rohc_comp *const comp,
+                                      const rohc_profile_t profile,
+                                      const rohc_ticks_t feedback_ticks)
+	__attribute__((nonnull(1)));
+
+static rohc_ctxt_key_t
+	c_get_ctxt_key(const struct rohc_comp_profile *const profile,
+	               const struct net_pkt *const packet)
+	__attribute__((nonnull(1, 2), warn_unused_result, pure));
+static rohc_ctxt_key_t
+	c_get_flow_hash(const struct rohc_comp_profile *const profile,
+	                const struct net_pkt *const packet)
+	__attribute__((nonnull(1, 2), warn_unused_result, pure));
+static uint32_t c_get_ip_layout(const struct net_pkt *const packet)
+	__attribute__((nonnull(1), warn_unused_result, pure));
+static void c_index_context(struct rohc_comp *const comp,
+                            const struct rohc_comp_ctxt *const context)
+	__attribute__((nonnull(1, 2)));
+static void c_unindex_context(struct rohc_comp *const comp,
+                              const struct rohc_comp_ctxt *const context)
+	__attribute__((nonnull(1, 2)));
+static struct rohc_comp_ctxt *
+	c_mru_find(struct rohc_comp *const comp,
+	           const struct rohc_comp_profile *const profile,
+	           const struct net_pkt *const packet,
+	           const rohc_ctxt_key_t key,
+	           const rohc_ctxt_key_t flow_hash)
+	__attribute__((nonnull(1, 2, 3), warn_unused_result));
+static void c_mru_promote(struct rohc_comp *const comp,
+                          const struct rohc_comp_ctxt *const context)
+	__attribute__((nonnull(1, 2)));
+static void c_mru_forget(struct rohc_comp *const comp, const rohc_cid_t cid)
+	__attribute__((nonnull(1)));
+
+static void c_recycle_list_add(struct rohc_comp *const comp,
+                               struct rohc_comp_ctxt *const context)
+	__attribute__((nonnull(1, 2)));
+static void c_recycle_list_touch(struct rohc_comp *const comp,
+                                 struct rohc_comp_ctxt *const context)
+	__attribute__((nonnull(1, 2)));
+static void c_recycle_list_remove(struct rohc_comp *const comp,
+                                  struct rohc_comp_ctxt *const context)
+	__attribute__((nonnull(1, 2)));
+static void c_probation_add(struct rohc_comp *const comp,
+                            struct rohc_comp_ctxt *const context)
+	__attribute__((nonnull(1, 2)));
+static void c_probation_unlink(struct rohc_comp *const comp,
+                               struct rohc_comp_ctxt *const context)
+	__attribute__((nonnull(1, 2)));
+static void c_probation_admit(struct rohc_comp *const comp,
+                              struct rohc_comp_ctxt *const context)
+	__attribute__((nonnull(1, 2)));
+static struct rohc_comp_ctxt *
+	c_recycle_victim(const struct rohc_comp *const comp)
+	__attribute__((nonnull(1), warn_unused_result));
 
 
 /*
@@ -146,6 +516,17 @@ static bool __rohc_comp_deliver_feedback(struct rohc_comp *const comp,
                                          const uint8_t *const packet,
                                          const size_t size)
 	__attribute__((warn_unused_result, nonnull(1, 2)));
+static bool c_deliver_feedback_to_ctxt(struct rohc_comp *const comp,
+                                       const rohc_cid_t cid,
+                                       const size_t cid_len,
+                                       const uint8_t *const packet,
+                                       const size_t size)
+	__attribute__((warn_unused_result, nonnull(1, 4)));
+static size_t c_feedback_burst_dedup(struct rohc_comp_feedback_item *const items,
+                                     const size_t items_nr)
+	__attribute__((warn_unused_result, nonnull(1)));
+static void c_deliver_queued_feedbacks(struct rohc_comp *const comp)
+	__attribute__((nonnull(1)));
 
 static bool rohc_comp_feedback_parse_cid(const struct rohc_comp *const comp,
                                          const uint8_t *const feedback,
@@ -226,12 +607,54 @@ static bool rohc_comp_feedback_check_opts(const struct rohc_comp_ctxt *const con
  * @see rohc_comp_set_mrru
  * @see rohc_comp_set_wlsb_window_width
  * @see rohc_comp_set_periodic_refreshes
+ * @see rohc_comp_set_periodic_refreshes_time
  * @see rohc_comp_set_rtp_detection_cb
  */
 struct rohc_comp * rohc_comp_new2(const rohc_cid_type_t cid_type,
                                   const rohc_cid_t max_cid,
                                   const rohc_comp_random_cb_t rand_cb,
                                   void *const rand_priv)
+{
+	const struct rohc_comp_attr attr = {
+		.cid_type = cid_type,
+		.max_cid = max_cid,
+		.rand_cb = rand_cb,
+		.rand_priv = rand_priv,
+		.numa_node = ROHC_NUMA_NODE_ANY,
+	};
+
+	return rohc_comp_new3(&attr);
+}
+
+
+/**
+ * @brief Create a new ROHC compressor with the given attributes
+ *
+ * Create a new ROHC compressor like \ref rohc_comp_new2 does, with the
+ * attributes given in one structure.
+ *
+ * The NUMA node attribute places all the memory of the compressor on one
+ * NUMA node: the compressor itself, its contexts, the memory budget and the
+ * RRU buffer. The compressor is often created by one control thread, but
+ * driven by one worker thread that runs on another NUMA node: the worker
+ * then accesses its contexts without paying the latency of the remote
+ * memory. The kernel falls back on another node if the given node has no
+ * free memory left. NUMA nodes are not supported in the Linux kernel module.
+ *
+ * A compressor placed on a NUMA node owns the memory of its contexts, so it
+ * cannot be added to a set of channels, see \ref rohc_channels_add.
+ *
+ * @param attr  The attributes of the new compressor
+ * @return      The created compressor if successful,
+ *              NULL if creation failed, if the NUMA node does not exist or
+ *              if NUMA nodes are not supported
+ *
+ * @ingroup rohc_comp
+ *
+ * @see rohc_comp_new2
+ * @see rohc_comp_free
+ */
+struct rohc_comp * rohc_comp_new3(const struct rohc_comp_attr *const attr)
 {
 	const size_t wlsb_width = 4; /* default window width for W-LSB encoding */
 	struct rohc_comp *comp;
@@ -239,18 +662,22 @@ struct rohc_comp * rohc_comp_new2(const rohc_cid_type_t cid_type,
 	size_t i;
 
 	/* check input parameters */
-	if(cid_type == ROHC_SMALL_CID)
+	if(attr == NULL)
+	{
+		goto error;
+	}
+	if(attr->cid_type == ROHC_SMALL_CID)
 	{
 		/* use small CIDs in range [0, ROHC_SMALL_CID_MAX] */
-		if(max_cid > ROHC_SMALL_CID_MAX)
+		if(attr->max_cid > ROHC_SMALL_CID_MAX)
 		{
 			goto error;
 		}
 	}
-	else if(cid_type == ROHC_LARGE_CID)
+	else if(attr->cid_type == ROHC_LARGE_CID)
 	{
 		/* use large CIDs in range [0, ROHC_LARGE_CID_MAX] */
-		if(max_cid > ROHC_LARGE_CID_MAX)
+		if(attr->max_cid > ROHC_LARGE_CID_MAX)
 		{
 			goto error;
 		}
@@ -260,30 +687,61 @@ struct rohc_comp * rohc_comp_new2(const rohc_cid_type_t cid_type,
 		/* unexpected CID type */
 		goto error;
 	}
-	if(rand_cb == NULL)
+	if(attr->rand_cb == NULL)
 	{
 		return NULL;
 	}
+	if(attr->numa_node < ROHC_NUMA_NODE_ANY)
+	{
+		goto error;
+	}
 
-	/* allocate memory for the ROHC compressor */
-	comp = malloc(sizeof(struct rohc_comp));
+	/* allocate memory for the ROHC compressor on the NUMA node */
+	comp = rohc_numa_alloc(sizeof(struct rohc_comp), attr->numa_node);
 	if(comp == NULL)
 	{
 		goto error;
 	}
-	memset(comp, 0, sizeof(struct rohc_comp));
 
-	comp->medium.cid_type = cid_type;
-	comp->medium.max_cid = max_cid;
+	comp->medium.cid_type = attr->cid_type;
+	comp->medium.max_cid = attr->max_cid;
+	comp->cid_first = 0;
+	comp->cid_last = attr->max_cid;
 	comp->mrru = 0; /* no segmentation by default */
-	comp->random_cb = rand_cb;
-	comp->random_cb_ctxt = rand_priv;
+	comp->trace_level = ROHC_TRACE_DEBUG; /* all traces by default */
+	comp->trace_sampling.one_in_n = 0; /* every packet by default */
+	comp->trace_sampling.errors_only = false;
+	comp->trace_sampling.cids_nr = 0;
+	comp->trace_sampled_level = ROHC_TRACE_DEBUG;
+	comp->trace_pkt_level = &comp->trace_sampled_level;
+	comp->numa_node = attr->numa_node;
+	rohc_ctxt_pool_init(&comp->ctxt_pool);
+	rohc_ctxt_pool_set_numa_node(&comp->ctxt_pool, comp->numa_node);
+	rohc_ctxt_pool_init(&comp->ctxts_chunks_pool);
+	rohc_ctxt_pool_set_numa_node(&comp->ctxts_chunks_pool,
+	                             comp->numa_node);
+	comp->cur_ctxt_pool = &comp->ctxt_pool;
+	rohc_pkt_log_init(&comp->pkt_log);
+	comp->random_cb = attr->rand_cb;
+	comp->random_cb_ctxt = attr->rand_priv;
+
+	/* no UDP port is dedicated to RTP streams by default, but all the RTP
+	 * Payload Types are accepted on the ports that are */
+	comp->rtp_ports = NULL;
+	comp->rtp_ports_nr = 0;
+	memset(comp->rtp_pts, 0xff, sizeof(comp->rtp_pts));
+
+	/* seed the hash keys of packets with the memory location of the
+	 * compressor: the random callback is not used here not to change the
+	 * random values that the profiles get */
+	comp->key_seed = net_pkt_key_final((uintptr_t) comp);
 
 	/* all compression profiles are disabled by default */
 	for(i = 0; i < C_NUM_PROFILES; i++)
 	{
 		comp->enabled_profiles[i] = false;
 	}
+	c_classif_cache_flush(comp);
 
 	/* reset statistics */
 	comp->num_packets = 0;
@@ -297,8 +755,10 @@ struct rohc_comp * rohc_comp_new2(const rohc_cid_type_t cid_type,
 	{
 		goto destroy_comp;
 	}
+	comp->reorder_ratio = ROHC_REORDERING_QUARTER;
 
-	/* set the default timeouts for periodic refreshes of contexts */
+	/* set the default timeouts for periodic refreshes of contexts, the
+	 * time-based refreshes are disabled by default */
 	is_fine = rohc_comp_set_periodic_refreshes(comp,
 	                                           CHANGE_TO_IR_COUNT,
 	                                           CHANGE_TO_FO_COUNT);
@@ -306,6 +766,10 @@ struct rohc_comp * rohc_comp_new2(const rohc_cid_type_t cid_type,
 	{
 		goto destroy_comp;
 	}
+	comp->periodic_refreshes_ir_timeout_time = 0;
+	comp->periodic_refreshes_fo_timeout_time = 0;
+	rohc_comp_wheel_init(&comp->refresh_wheel);
+	rohc_comp_feedback_queue_init(&comp->feedback_queue);
 
 	/* set the default number of uncompressed transmissions for list
 	 * compression */
@@ -315,18 +779,8 @@ struct rohc_comp * rohc_comp_new2(const rohc_cid_type_t cid_type,
 		goto destroy_comp;
 	}
 
-	/* init the tables for fast CRC computation */
-	is_fine = rohc_crc_init_table(comp->crc_table_3, ROHC_CRC_TYPE_3);
-	if(is_fine != true)
-	{
-		goto destroy_comp;
-	}
-	is_fine = rohc_crc_init_table(comp->crc_table_7, ROHC_CRC_TYPE_7);
-	if(is_fine != true)
-	{
-		goto destroy_comp;
-	}
-	is_fine = rohc_crc_init_table(comp->crc_table_8, ROHC_CRC_TYPE_8);
+	/* recycle the least recently used context by default */
+	is_fine = rohc_comp_set_ctxts_recycling(comp, ROHC_COMP_RECYCLE_LRU);
 	if(is_fine != true)
 	{
 		goto destroy_comp;
@@ -341,7 +795,7 @@ struct rohc_comp * rohc_comp_new2(const rohc_cid_type_t cid_type,
 	return comp;
 
 destroy_comp:
-	zfree(comp);
+	rohc_numa_free(comp, sizeof(struct rohc_comp), attr->numa_node);
 error:
 	return NULL;
 }
@@ -380,8 +834,25 @@ void rohc_comp_free(struct rohc_comp *const comp)
 		/* free memory used by contexts */
 		c_destroy_contexts(comp);
 
+		/* free the memory blocks kept for the contexts */
+		rohc_ctxt_pool_free(&comp->ctxt_pool);
+		rohc_ctxt_pool_free(&comp->ctxts_chunks_pool);
+
+		/* free the headers saved for the snapshots of the contexts */
+		rohc_free(comp->ctxts_snapshots);
+		rohc_free(comp->ctxts_dirty);
+
+		/* free the log of the last packets */
+		rohc_pkt_log_free(&comp->pkt_log);
+
+		/* free the UDP ports dedicated to RTP streams */
+		rohc_free(comp->rtp_ports);
+
+		/* free the RRU buffer */
+		rohc_numa_free(comp->rru, comp->mrru, comp->numa_node);
+
 		/* free the compressor */
-		free(comp);
+		rohc_numa_free(comp, sizeof(struct rohc_comp), comp->numa_node);
 	}
 }
 
@@ -459,6 +930,180 @@ error:
 }
 
 
+/**
+ * @brief Set the minimum level of the traces of the compressor
+ *
+ * Set the minimum level of the traces that the compressor gives to the
+ * callback set with \ref rohc_comp_set_traces_cb2. The traces below the
+ * given level are skipped before their arguments are formatted, the packet
+ * dumps of lower levels are skipped entirely.
+ *
+ * All traces are given to the callback by default.
+ *
+ * The traces removed at build time (see the --enable-rohc-trace-level
+ * configure option) are never given to the callback, whatever the level
+ * set with this function.
+ *
+ * @warning The level can not be modified after library initialization
+ *
+ * @param comp   The ROHC compressor
+ * @param level  The minimum level of the traces to give to the callback
+ * @return       true on success, false otherwise
+ *
+ * @ingroup rohc_comp
+ *
+ * @see rohc_comp_set_traces_cb2
+ */
+bool rohc_comp_set_trace_level(struct rohc_comp *const comp,
+                               const rohc_trace_level_t level)
+{
+	/* check compressor validity */
+	if(comp == NULL)
+	{
+		goto error;
+	}
+
+	/* check the trace level */
+	if(level >= ROHC_TRACE_LEVEL_MAX)
+	{
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		             "unexpected trace level %d", level);
+		goto error;
+	}
+
+	/* refuse to set a new trace level if compressor is in use */
+	if(comp->num_packets > 0)
+	{
+		rohc_error(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL, "unable to "
+		           "modify the trace level after initialization");
+		goto error;
+	}
+
+	comp->trace_level = level;
+	comp->trace_sampled_level = level;
+
+	return true;
+
+error:
+	return false;
+}
+
+
+/**
+ * @brief Trace one packet every N packets only
+ *
+ * Restrict the traces of the compressor to one packet every \e one_in_n
+ * packets, or to the warnings and errors only, so that the traces may be
+ * enabled on a loaded system without collapsing the throughput. The traces
+ * of the packets that are not sampled are skipped before their arguments
+ * are formatted, and so are their packet dumps.
+ *
+ * The warnings and errors are mostly emitted by the packets that end in
+ * error, \e errors_only thus traces the failing packets without the debug
+ * traces of all the other packets.
+ *
+ * Every packet is traced by default. Unlike the trace level, the sampling
+ * may be changed at any time, but not while packets are being processed by
+ * another thread.
+ *
+ * @param comp         The ROHC compressor
+ * @param one_in_n     Trace 1 packet every \e one_in_n packets, 0 or 1 to
+ *                     trace every packet
+ * @param errors_only  Whether to trace the warnings and errors only
+ * @return             true on success, false otherwise
+ *
+ * @ingroup rohc_comp
+ *
+ * @see rohc_comp_set_trace_cids
+ * @see rohc_comp_set_trace_level
+ */
+bool rohc_comp_set_trace_sampling(struct rohc_comp *const comp,
+                                  const size_t one_in_n,
+                                  const bool errors_only)
+{
+	if(comp == NULL)
+	{
+		goto error;
+	}
+
+	comp->trace_sampling.one_in_n = one_in_n;
+	comp->trace_sampling.errors_only = errors_only;
+
+	return true;
+
+error:
+	return false;
+}
+
+
+/**
+ * @brief Trace the packets of the given CIDs only
+ *
+ * Restrict the traces of the compressor to the packets of the given CIDs, so
+ * that the flows under investigation may be traced on a loaded system
+ * without collapsing the throughput. The traces of the other packets, and
+ * the traces emitted before the CID of a packet is known, are skipped before
+ * their arguments are formatted.
+ *
+ * The packets of all CIDs are traced by default. Unlike the trace level, the
+ * CIDs may be changed at any time, but not while packets are being processed
+ * by another thread.
+ *
+ * @param comp     The ROHC compressor
+ * @param cids     The CIDs to trace, at most \ref ROHC_TRACE_CIDS_MAX
+ * @param cids_nr  The number of CIDs, 0 to trace the packets of all CIDs
+ * @return         true on success, false otherwise
+ *
+ * @ingroup rohc_comp
+ *
+ * @see rohc_comp_set_trace_sampling
+ */
+bool rohc_comp_set_trace_cids(struct rohc_comp *const comp,
+                              const rohc_cid_t *const cids,
+                              const size_t cids_nr)
+{
+	size_t i;
+
+	if(comp == NULL)
+	{
+		goto error;
+	}
+	if(cids_nr > ROHC_TRACE_CIDS_MAX)
+	{
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		             "unable to trace more than %u CIDs", ROHC_TRACE_CIDS_MAX);
+		goto error;
+	}
+	if(cids_nr > 0 && cids == NULL)
+	{
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		             "no CID given");
+		goto error;
+	}
+	for(i = 0; i < cids_nr; i++)
+	{
+		if(cids[i] > comp->medium.max_cid)
+		{
+			rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+			             "unable to trace CID %zu: MAX_CID is %zu", cids[i],
+			             comp->medium.max_cid);
+			goto error;
+		}
+	}
+
+	for(i = 0; i < cids_nr; i++)
+	{
+		comp->trace_sampling.cids[i] = cids[i];
+	}
+	comp->trace_sampling.cids_nr = cids_nr;
+
+	return true;
+
+error:
+	return false;
+}
+
+
 /**
  * @brief Compress the given uncompressed packet into a ROHC packet
  *
@@ -531,65 +1176,31 @@ rohc_status_t rohc_compress4(struct rohc_comp *const comp,
 {
 	struct net_pkt ip_pkt;
 	struct rohc_comp_ctxt *c;
-	rohc_packet_t packet_type;
-	int rohc_hdr_size;
-	size_t payload_size;
-	size_t payload_offset;
-
-	rohc_status_t status = ROHC_STATUS_ERROR; /* error status by default */
+	rohc_ticks_t ticks[3];
+	rohc_status_t status;
 
 	/* check inputs validity */
 	if(comp == NULL)
 	{
 		goto error;
 	}
-	if(rohc_buf_is_malformed(uncomp_packet))
-	{
-		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-		             "given uncomp_packet is malformed");
-		goto error;
-	}
-	if(rohc_buf_is_empty(uncomp_packet))
-	{
-		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-		             "given uncomp_packet is empty");
-		goto error;
-	}
-	if(rohc_packet == NULL)
-	{
-		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-		             "given rohc_packet is NULL");
-		goto error;
-	}
-	if(rohc_buf_is_malformed(*rohc_packet))
-	{
-		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-		             "given rohc_packet is malformed");
-		goto error;
-	}
-	if(!rohc_buf_is_empty(*rohc_packet))
+	c_trace_sample(comp, false, 0);
+	if(!c_check_bufs(comp, uncomp_packet, rohc_packet))
 	{
-		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-		             "given rohc_packet is not empty");
 		goto error;
 	}
+	ROHC_PROBE2(comp_start, comp, uncomp_packet.len);
 
-	/* print uncompressed bytes */
-	if((comp->features & ROHC_COMP_FEATURE_DUMP_PACKETS) != 0)
-	{
-		rohc_dump_packet(comp->trace_callback, comp->trace_callback_priv,
-		                 ROHC_TRACE_COMP, ROHC_TRACE_DEBUG,
-		                 "uncompressed data, max 100 bytes", uncomp_packet);
-	}
+	/* handle the feedback received by other threads meanwhile */
+	c_deliver_queued_feedbacks(comp);
 
 	/* parse the uncompressed packet */
-	if(!net_pkt_parse(&ip_pkt, uncomp_packet, comp->trace_callback,
-	                  comp->trace_callback_priv, ROHC_TRACE_COMP))
+	ticks[0] = rohc_comp_ticks(comp);
+	if(!c_parse_packet(comp, uncomp_packet, true, &ip_pkt))
 	{
-		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-		             "failed to parse uncompressed packet");
-		goto error;
+		goto error_probe;
 	}
+	ticks[1] = rohc_comp_ticks(comp);
 
 	/* find the best context for the packet */
 	c = rohc_comp_find_ctxt(comp, &ip_pkt, -1, uncomp_packet.time);
@@ -598,334 +1209,188 @@ rohc_status_t rohc_compress4(struct rohc_comp *const comp,
 		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
 		             "failed to find a matching context or to create a new "
 		             "context");
-		goto error;
+		goto error_probe;
 	}
+	ticks[2] = rohc_comp_ticks(comp);
 
-	/* create the ROHC packet: */
-	rohc_packet->len = 0;
+	if(rohc_comp_timings_enabled(comp))
+	{
+		c_timings_set_pending(comp, ticks[1] - ticks[0], ticks[2] - ticks[1]);
+	}
+	status = c_compress_in_ctxt(comp, c, &ip_pkt, uncomp_packet, rohc_packet,
+	                            NULL);
+	if(rohc_comp_timings_enabled(comp))
+	{
+		c_timings_clear_pending(comp);
+	}
+	ROHC_PROBE3(comp_done, comp, status, rohc_packet->len);
 
-	/* use profile to compress packet */
-	rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-	           "compress the packet #%d", comp->num_packets + 1);
-	rohc_hdr_size =
-		c->profile->encode(c, &ip_pkt, rohc_buf_data(*rohc_packet),
-		                   rohc_buf_avail_len(*rohc_packet),
-		                   &packet_type, &payload_offset);
-	if(rohc_hdr_size < 0)
-	{
-		/* error while compressing, use the Uncompressed profile */
-		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-		             "error while compressing with the profile, using "
-		             "uncompressed profile");
-
-		/* free context if it was just created */
-		if(c->num_sent_packets <= 1)
-		{
-			c->profile->destroy(c);
-			c->used = 0;
-			assert(comp->num_contexts_used > 0);
-			comp->num_contexts_used--;
-		}
-
-		/* find the best context for the Uncompressed profile */
-		c = rohc_comp_find_ctxt(comp, &ip_pkt, ROHC_PROFILE_UNCOMPRESSED,
-		                        uncomp_packet.time);
-		if(c == NULL)
-		{
-			rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-			             "failed to find a matching Uncompressed context or to "
-			             "create a new Uncompressed context");
-			goto error;
-		}
-
-		/* use the Uncompressed profile to compress the packet */
-		rohc_hdr_size =
-			c->profile->encode(c, &ip_pkt, rohc_buf_data(*rohc_packet),
-			                   rohc_buf_avail_len(*rohc_packet),
-			                   &packet_type, &payload_offset);
-		if(rohc_hdr_size < 0)
-		{
-			rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-			             "error while compressing with uncompressed profile, "
-			             "giving up");
-			goto error_free_new_context;
-		}
-	}
-	rohc_packet->len += rohc_hdr_size;
-
-	/* the payload starts after the header, skip it */
-	rohc_buf_pull(rohc_packet, rohc_hdr_size);
-	payload_size = ip_pkt.len - payload_offset;
-
-	/* is packet too large for output buffer? */
-	if(payload_size > rohc_buf_avail_len(*rohc_packet))
-	{
-		const size_t max_rohc_buf_len =
-			rohc_buf_avail_len(*rohc_packet) + rohc_hdr_size;
-		uint32_t rru_crc;
-
-		/* resulting ROHC packet too large, segmentation may be a solution */
-		rohc_info(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-		          "%s ROHC packet is too large for the given output buffer, "
-		          "try to segment it (input size = %zd, maximum output "
-		          "size = %zd, required output size = %d + %zd = %zd, "
-		          "MRRU = %zd)", rohc_get_packet_descr(packet_type),
-		          uncomp_packet.len, max_rohc_buf_len, rohc_hdr_size,
-		          payload_size, rohc_hdr_size + payload_size, comp->mrru);
-
-		/* in order to be segmented, a ROHC packet shall be <= MRRU
-		 * (remember that MRRU includes the CRC length) */
-		if((payload_size + CRC_FCS32_LEN) > comp->mrru)
-		{
-			rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-			             "%s ROHC packet cannot be segmented: too large (%d + "
-			             "%zu + %u = %zu bytes) for MRRU (%zu bytes)",
-			             rohc_get_packet_descr(packet_type), rohc_hdr_size,
-			             payload_size, CRC_FCS32_LEN, rohc_hdr_size +
-			             payload_size + CRC_FCS32_LEN, comp->mrru);
-			goto error_free_new_context;
-		}
-		rohc_info(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-		          "%s ROHC packet can be segmented (MRRU = %zd)",
-		          rohc_get_packet_descr(packet_type), comp->mrru);
-
-		/* store the whole ROHC packet in compressor (headers and payload only,
-		 * not feedbacks, feedbacks will be transmitted with the first segment
-		 * when rohc_comp_get_segment2() is called) */
-		if(comp->rru_len != 0)
-		{
-			/* warn users about previous, not yet retrieved RRU */
-			rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-			             "erase the existing %zd-byte RRU that was not "
-			             "retrieved yet (call rohc_comp_get_segment2() to add "
-			             "support for ROHC segments in your application)",
-			             comp->rru_len);
-		}
-		comp->rru_len = 0;
-		comp->rru_off = 0;
-		/* ROHC header */
-		rohc_buf_push(rohc_packet, rohc_hdr_size);
-		memcpy(comp->rru + comp->rru_off, rohc_buf_data(*rohc_packet),
-		       rohc_hdr_size);
-		comp->rru_len += rohc_hdr_size;
-		/* ROHC payload */
-		memcpy(comp->rru + comp->rru_off + comp->rru_len,
-		       rohc_buf_data_at(uncomp_packet, payload_offset), payload_size);
-		comp->rru_len += payload_size;
-		/* compute FCS-32 CRC over header and payload (optional feedbacks and
-		   the CRC field itself are excluded) */
-		rru_crc = crc_calc_fcs32(comp->rru + comp->rru_off, comp->rru_len,
-		                         CRC_INIT_FCS32);
-		memcpy(comp->rru + comp->rru_off + comp->rru_len, &rru_crc,
-		       CRC_FCS32_LEN);
-		comp->rru_len += CRC_FCS32_LEN;
-		rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-		           "RRU 32-bit FCS CRC = 0x%08x", rohc_ntoh32(rru_crc));
-		/* computed RRU must be <= MRRU */
-		assert(comp->rru_len <= comp->mrru);
-
-		/* reset the length of the ROHC packet: it shall be 0 for users */
-		rohc_packet->len = 0;
-
-		/* report to users that segmentation is possible */
-		status = ROHC_STATUS_SEGMENT;
-	}
-	else
-	{
-		/* copy full payload after ROHC header */
-		rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-		           "copy full %zd-byte payload", payload_size);
-		rohc_buf_append(rohc_packet,
-		                rohc_buf_data_at(uncomp_packet, payload_offset),
-		                payload_size);
-
-		/* unhide the ROHC header */
-		rohc_buf_push(rohc_packet, rohc_hdr_size);
-		rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-		           "ROHC size = %zd bytes (header = %d, payload = %zu), output "
-		           "buffer size = %zu", rohc_packet->len, rohc_hdr_size,
-		           payload_size, rohc_buf_avail_len(*rohc_packet));
-
-		/* report to user that compression was successful */
-		status = ROHC_STATUS_OK;
-	}
-
-	/* update some statistics:
-	 *  - compressor statistics
-	 *  - context statistics (global + last packet + last 16 packets) */
-	comp->num_packets++;
-	comp->total_uncompressed_size += uncomp_packet.len;
-	comp->total_compressed_size += rohc_packet->len;
-	comp->last_context = c;
-
-	c->packet_type = packet_type;
-
-	c->total_uncompressed_size += uncomp_packet.len;
-	c->total_compressed_size += rohc_packet->len;
-	c->header_uncompressed_size += payload_offset;
-	c->header_compressed_size += rohc_hdr_size;
-	c->num_sent_packets++;
-
-	c->total_last_uncompressed_size = uncomp_packet.len;
-	c->total_last_compressed_size = rohc_packet->len;
-	c->header_last_uncompressed_size = payload_offset;
-	c->header_last_compressed_size = rohc_hdr_size;
-
-	/* compression is successful */
 	return status;
 
-error_free_new_context:
-	/* free context if it was just created */
-	if(c->num_sent_packets <= 1)
-	{
-		c->profile->destroy(c);
-		c->used = 0;
-		assert(comp->num_contexts_used > 0);
-		comp->num_contexts_used--;
-	}
+error_probe:
+	ROHC_PROBE3(comp_done, comp, ROHC_STATUS_ERROR, 0);
 error:
 	return ROHC_STATUS_ERROR;
 }
 
 
 /**
- * @brief Get the next ROHC segment if any
+ * @brief Compress the given uncompressed packet into a ROHC header and a
+ *        reference to the payload
  *
- * Get the next ROHC segment if any.
+ * Compress the given uncompressed packet as \ref rohc_compress4 does, but
+ * without copying the payload: only the ROHC header is written in the output
+ * buffer \e rohc_hdr, and \e payload is set to the part of the uncompressed
+ * packet that follows the compressed headers. The ROHC packet is the ROHC
+ * header followed by the payload, so that the network layer may transmit
+ * them with one gather list without any copy.
  *
- * To get all the segments of one ROHC packet, call this function until
- * \ref ROHC_STATUS_OK or \ref ROHC_STATUS_ERROR is returned.
+ * The payload references the memory of \e uncomp_packet: it is valid as long
+ * as the uncompressed packet is.
  *
- * @param comp          The ROHC compressor
- * @param[out] segment  The buffer where to store the ROHC segment
- * @return              Possible return values:
- *                       \li \ref ROHC_STATUS_SEGMENT if a ROHC segment is
- *                           returned and more segments are available,
- *                       \li \ref ROHC_STATUS_OK if a ROHC segment is returned
- *                           and no more ROHC segment is available
+ * ROHC segmentation is not available: the output buffer shall be large enough
+ * for the ROHC header only.
+ *
+ * @param comp           The ROHC compressor
+ * @param uncomp_packet  The uncompressed packet to compress
+ * @param[out] rohc_hdr  The resulting ROHC header
+ * @param[out] payload   The payload of the ROHC packet, within the memory of
+ *                       the uncompressed packet
+ * @return               Possible return values:
+ *                       \li \ref ROHC_STATUS_OK if a ROHC header and a
+ *                           payload are returned
+ *                       \li \ref ROHC_STATUS_OUTPUT_TOO_SMALL if the output
+ *                           buffer is too small for the ROHC header
  *                       \li \ref ROHC_STATUS_ERROR if an error occurred
  *
  * @ingroup rohc_comp
  *
- * \par Example:
- * \snippet test_segment.c define ROHC compressor
- * \code
-        ...
-        // compress the IP packet with a small ROHC buffer
-\endcode
- * \snippet test_segment.c segment ROHC packet #1
- * \snippet test_segment.c segment ROHC packet #2
- * \code
-                        ...
-                        // decompress the ROHC segment here, the function
-                        // rohc_decompress3 shall return ROHC_STATUS_OK
-                        // and no decompressed packet
-                        ...
-\endcode
- * \snippet test_segment.c segment ROHC packet #3
- * \code
-                // decompress the final ROHC segment here, the function
-                // rohc_decompress4 shall return ROHC_STATUS_OK
-\endcode
- * \snippet test_segment.c segment ROHC packet #4
- * \code
-                // handle compression error here
-                ...
-\endcode
- *
- * @see rohc_comp_get_mrru
- * @see rohc_comp_set_mrru
  * @see rohc_compress4
  */
-rohc_status_t rohc_comp_get_segment2(struct rohc_comp *const comp,
-                                     struct rohc_buf *const segment)
-
+rohc_status_t rohc_compress_iov(struct rohc_comp *const comp,
+                                const struct rohc_buf uncomp_packet,
+                                struct rohc_buf *const rohc_hdr,
+                                struct rohc_buf *const payload)
 {
-	const size_t segment_type_len = 1; /* segment type byte */
-	size_t max_data_len;
-	rohc_status_t status;
+	struct net_pkt ip_pkt;
+	struct rohc_comp_ctxt *c;
 
-	/* check input parameters */
+	/* check inputs validity */
 	if(comp == NULL)
 	{
 		goto error;
 	}
-	if(segment == NULL)
+	c_trace_sample(comp, false, 0);
+	if(payload == NULL)
 	{
 		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-		             "given segment cannot be NULL");
+		             "given payload is NULL");
 		goto error;
 	}
-	if(rohc_buf_is_malformed(*segment))
+	if(!c_check_bufs(comp, uncomp_packet, rohc_hdr))
 	{
-		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-		             "given segment is malformed");
 		goto error;
 	}
-	if(!rohc_buf_is_empty(*segment))
+
+	/* handle the feedback received by other threads meanwhile */
+	c_deliver_queued_feedbacks(comp);
+
+	/* parse the uncompressed packet */
+	if(!c_parse_packet(comp, uncomp_packet, true, &ip_pkt))
+	{
+		goto error;
+	}
+
+	/* find the best context for the packet */
+	c = rohc_comp_find_ctxt(comp, &ip_pkt, -1, uncomp_packet.time);
+	if(c == NULL)
 	{
 		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-		             "given segment is not empty");
+		             "failed to find a matching context or to create a new "
+		             "context");
 		goto error;
 	}
 
-	/* no segment yet */
-	segment->len = 0;
+	return c_compress_in_ctxt(comp, c, &ip_pkt, uncomp_packet, rohc_hdr,
+	                          payload);
 
-	/* abort if no RRU is available in the compressor */
-	if(comp->rru_len == 0)
+error:
+	return ROHC_STATUS_ERROR;
+}
+
+
+/**
+ * @brief Compress the given uncompressed packet in place
+ *
+ * Compress the given uncompressed packet as \ref rohc_compress4 does, but
+ * within its own buffer: the ROHC header replaces the uncompressed headers
+ * and the payload is never moved. On success, the offset and the length of
+ * \e packet are adjusted to the resulting ROHC packet, that is the ROHC header
+ * immediately followed by the payload.
+ *
+ * The ROHC header is built in the headroom of the buffer (the bytes before
+ * the offset of \e packet), then moved over the end of the uncompressed
+ * headers. The headroom shall thus be large enough for the largest ROHC
+ * header that the flow may require, IR packets being the largest ones. If the
+ * headroom is too small, the packet is compressed with the Uncompressed
+ * profile if possible, or the compression fails.
+ *
+ * ROHC segmentation is not available.
+ *
+ * If compression fails, the uncompressed headers may be overwritten.
+ *
+ * @param comp            The ROHC compressor
+ * @param[in,out] packet  The uncompressed packet to compress, with headroom,
+ *                        the resulting ROHC packet on success
+ * @return                Possible return values:
+ *                        \li \ref ROHC_STATUS_OK if the packet was compressed
+ *                        \li \ref ROHC_STATUS_ERROR if an error occurred
+ *
+ * @ingroup rohc_comp
+ *
+ * @see rohc_compress4
+ * @see rohc_compress_iov
+ */
+rohc_status_t rohc_compress_inplace(struct rohc_comp *const comp,
+                                    struct rohc_buf *const packet)
+{
+	struct rohc_buf rohc_hdr;
+	struct rohc_buf payload;
+	rohc_status_t status;
+
+	/* check inputs validity */
+	if(comp == NULL)
+	{
+		goto error;
+	}
+	if(packet == NULL)
 	{
 		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-		             "no RRU available in given compressor");
+		             "given packet is NULL");
 		goto error;
 	}
 
-	/* abort is the given output buffer is too small for RRU */
-	if(rohc_buf_avail_len(*segment) <= segment_type_len)
+	/* build the ROHC header in the headroom of the buffer */
+	rohc_hdr.time = packet->time;
+	rohc_hdr.data = packet->data;
+	rohc_hdr.max_len = packet->offset;
+	rohc_hdr.offset = 0;
+	rohc_hdr.len = 0;
+	status = rohc_compress_iov(comp, *packet, &rohc_hdr, &payload);
+	if(status != ROHC_STATUS_OK)
 	{
-		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-		             "output buffer is too small for RRU, more than %zd bytes "
-		             "are required", segment_type_len);
 		goto error;
 	}
+	assert(rohc_hdr.len <= payload.offset);
 
-	/* how many bytes of ROHC packet can we put in that new segment? */
-	max_data_len = rohc_min(rohc_buf_avail_len(*segment) - segment_type_len,
-	                        comp->rru_len);
-	assert(max_data_len > 0);
-	rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-	           "copy %zd bytes of the remaining %zd bytes of ROHC packet and "
-	           "CRC in the segment", max_data_len, comp->rru_len);
-
-	/* set segment type with F bit set only for last segment */
-	rohc_buf_byte_at(*segment, 0) = 0xfe | (max_data_len == comp->rru_len);
-	segment->len++;
-	rohc_buf_pull(segment, 1);
-
-	/* copy remaining ROHC data (CRC included) */
-	rohc_buf_append(segment, comp->rru + comp->rru_off, max_data_len);
-	rohc_buf_pull(segment, max_data_len);
-	comp->rru_off += max_data_len;
-	comp->rru_len -= max_data_len;
-
-	/* set status wrt to (non-)final segment */
-	if(comp->rru_len == 0)
-	{
-		/* final segment, no more segment available */
-		status = ROHC_STATUS_OK;
-		/* reset context for next RRU */
-		comp->rru_off = 0;
-	}
-	else
-	{
-		/* non-final segment, more segments to available */
-		status = ROHC_STATUS_SEGMENT;
-	}
-
-	/* shift backward the RRU data, header and the feedback data */
-	rohc_buf_push(segment, max_data_len + 1);
+	/* move the ROHC header just before the payload, the uncompressed headers
+	 * are not needed anymore */
+	memmove(rohc_buf_data(payload) - rohc_hdr.len, rohc_buf_data(rohc_hdr),
+	        rohc_hdr.len);
+	packet->offset = payload.offset - rohc_hdr.len;
+	packet->len = rohc_hdr.len + payload.len;
 
-	return status;
+	return ROHC_STATUS_OK;
 
 error:
 	return ROHC_STATUS_ERROR;
@@ -933,426 +1398,552 @@ error:
 
 
 /**
- * @brief Force the compressor to re-initialize all its contexts
- *
- * Make all contexts restart their initialization with decompressor, ie. they
- * go in the lowest compression state. This function can be used once the
- * ROHC channel is established again after an interruption.
- *
- * The function implements the CONTEXT_REINITIALIZATION signal described by
- * RFC 3095 at §6.3.1 as:
- * \verbatim
-   CONTEXT_REINITIALIZATION -- signal
-   This parameter triggers a reinitialization of the entire context at
-   the decompressor, both the static and the dynamic part.  The
-   compressor MUST, when CONTEXT_REINITIALIZATION is triggered, back off
-   to the IR state and fully reinitialize the context by sending IR
-   packets with both the static and dynamic chains covering the entire
-   uncompressed headers until it is reasonably confident that the
-   decompressor contexts are reinitialized.  The context
-   reinitialization MUST be done for all contexts at the compressor.
-   This parameter may for instance be used to do context relocation at,
-   e.g., a cellular handover that results in a change of compression
-   point in the radio access network.
-\endverbatim
+ * @brief Compress the given uncompressed packet with a known context
+ *
+ * Compress the given uncompressed packet as \ref rohc_compress4 does, but
+ * with the context designated by \e handle: the packet is not classified,
+ * no profile is selected for it and no context is searched for it. Only the
+ * validity of the handle is checked, then whether the profile of the context
+ * accepts the packet and whether the packet has the same number and versions
+ * of IP headers as the context. The handle of the context of a flow is
+ * retrieved with \ref rohc_comp_get_last_ctxt_handle once the first packet
+ * of the flow was compressed by \ref rohc_compress4.
+ *
+ * The caller is responsible for giving the packets of one flow only with the
+ * same handle, as applications that already know the flow of their packets
+ * (tunnels for example) do. If the handle got stale because the context was
+ * destroyed or given to another flow, \ref ROHC_STATUS_NO_CONTEXT is
+ * returned: the packet shall then be compressed again with
+ * \ref rohc_compress4 and the handle of the new context retrieved.
  *
- * @param comp  The ROHC compressor
- * @return      true in case of success, false otherwise
+ * @param comp              The ROHC compressor
+ * @param handle            The handle of the context to compress the packet
+ *                          with
+ * @param uncomp_packet     The uncompressed packet to compress
+ * @param[out] rohc_packet  The resulting compressed ROHC packet
+ * @return                  Possible return values:
+ *                          \li the values returned by \ref rohc_compress4
+ *                          \li \ref ROHC_STATUS_NO_CONTEXT if the handle is
+ *                              stale or does not match the packet
  *
  * @ingroup rohc_comp
+ *
+ * @see rohc_comp_get_last_ctxt_handle
+ * @see rohc_compress4
  */
-bool rohc_comp_force_contexts_reinit(struct rohc_comp *const comp)
+rohc_status_t rohc_compress_with_ctxt(struct rohc_comp *const comp,
+                                      const rohc_comp_ctxt_handle_t handle,
+                                      const struct rohc_buf uncomp_packet,
+                                      struct rohc_buf *const rohc_packet)
 {
-	rohc_cid_t i;
+	const rohc_cid_t cid = (rohc_cid_t) (handle & 0xffffffffU);
+	const uint32_t gen = (uint32_t) (handle >> 32);
+	const struct rohc_comp_profile *profile;
+	struct net_pkt ip_pkt;
+	struct rohc_comp_ctxt *c;
+	rohc_ticks_t ticks[3];
+	rohc_status_t status;
 
+	/* check inputs validity */
 	if(comp == NULL)
 	{
 		goto error;
 	}
-
-	rohc_info(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-	          "force re-initialization for all %zu contexts",
-	          comp->num_contexts_used);
-
-	for(i = 0; i <= comp->medium.max_cid; i++)
+	c_trace_sample(comp, false, 0);
+	if(!c_check_bufs(comp, uncomp_packet, rohc_packet))
 	{
-		if(comp->contexts[i].used)
-		{
-			if(!comp->contexts[i].profile->reinit_context(&(comp->contexts[i])))
-			{
-				rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-				             "failed to force re-initialization for CID %zu", i);
-				goto error;
-			}
-		}
+		goto error;
 	}
 
-	return true;
-
-error:
-	return false;
-}
-
+	/* handle the feedback received by other threads meanwhile, it may
+	 * destroy contexts */
+	c_deliver_queued_feedbacks(comp);
 
-/**
- * @brief Set the window width for the W-LSB encoding scheme
- *
- * Set the window width for the Window-based Least Significant Bits (W-LSB)
- * encoding. See section 4.5.2 of RFC 3095 for more details about the encoding
- * scheme.
- *
- * The width of the W-LSB window is set to 4 by default.
- *
- * @warning The value must be a power of 2
- *
- * @warning The value can not be modified after library initialization
- *
- * @param comp   The ROHC compressor
- * @param width  The width of the W-LSB sliding window
- * @return       true in case of success, false in case of failure
- *
- * @ingroup rohc_comp
- */
-bool rohc_comp_set_wlsb_window_width(struct rohc_comp *const comp,
-                                     const size_t width)
-{
-	/* we need a valid compressor and a positive non-zero window width */
-	if(comp == NULL)
+	/* the context shall still be the one of the handle */
+	ticks[0] = rohc_comp_ticks(comp);
+	c = c_get_context(comp, cid);
+	if(c == NULL || c->gen != gen)
 	{
-		return false;
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		             "handle of context with CID %zu and generation %u is "
+		             "stale", cid, gen);
+		goto no_context;
 	}
-	if(width == 0)
+	profile = c->profile;
+
+	/* parse the uncompressed packet, the key and the fingerprint of its flow
+	 * are not needed */
+	if(!c_parse_packet(comp, uncomp_packet, false, &ip_pkt))
 	{
-		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL, "failed to "
-		             "set width of W-LSB sliding window to %zd: window width "
-		             "must be a non-null positive integer", width);
-		return false;
+		goto error;
 	}
 
-	/* window width must be a power of 2 */
-	if((width & (width - 1)) != 0)
+	/* the profile of the context shall be able to parse the packet: only the
+	 * Uncompressed profile accepts non-IP packets and IPv4 fragments, and the
+	 * other profiles shall accept the packet as if it was classified. The
+	 * packet shall also have the same IP headers as the context: the profiles
+	 * rely on that once the context is found, the fields of the headers are
+	 * then compared while they are encoded */
+	if(profile->id != ROHC_PROFILE_UNCOMPRESSED &&
+	   (ip_pkt.outer_ip.version == IP_UNKNOWN ||
+	    (ip_pkt.outer_ip.version == IPV4 && ip_is_fragment(&ip_pkt.outer_ip)) ||
+	    (profile->protocol != 0 &&
+	     profile->protocol != ip_pkt.transport->proto) ||
+	    !profile->check_profile(comp, &ip_pkt) ||
+	    c_get_ip_layout(&ip_pkt) != c->ip_layout))
 	{
-		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL, "failed to "
-		             "set width of W-LSB sliding window to %zd: window width "
-		             "must be a power of 2", width);
-		return false;
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		             "packet does not match the profile '%s' (0x%04x) of the "
+		             "context with CID %zu", rohc_get_profile_descr(profile->id),
+		             profile->id, c->cid);
+		goto no_context;
 	}
+	ticks[1] = rohc_comp_ticks(comp);
 
-	/* refuse to set a value if compressor is in use */
-	if(comp->num_packets > 0)
+	/* the context is used, as if it was found for the packet */
+	c->latest_used = uncomp_packet.time.sec;
+	c_recycle_list_touch(comp, c);
+	c_mru_promote(comp, c);
+	ticks[2] = rohc_comp_ticks(comp);
+
+	if(rohc_comp_timings_enabled(comp))
 	{
-		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL, "unable to "
-		             "modify the W-LSB window width after initialization");
-		return false;
+		c_timings_set_pending(comp, ticks[1] - ticks[0], ticks[2] - ticks[1]);
+	}
+	status = c_compress_in_ctxt(comp, c, &ip_pkt, uncomp_packet, rohc_packet,
+	                            NULL);
+	if(rohc_comp_timings_enabled(comp))
+	{
+		c_timings_clear_pending(comp);
 	}
 
-	comp->wlsb_window_width = width;
-
-	rohc_info(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-	          "width of W-LSB sliding window set to %zd", width);
+	return status;
 
-	return true;
+no_context:
+	return ROHC_STATUS_NO_CONTEXT;
+error:
+	return ROHC_STATUS_ERROR;
 }
 
 
 /**
- * @brief Set the timeout values for IR and FO periodic refreshes
+ * @brief Compress a burst of uncompressed packets into ROHC packets
+ *
+ * Compress the given uncompressed packets into ROHC packets, as successive
+ * calls to \ref rohc_compress4 would do, but with less overhead per packet:
+ *  \li the compressor is checked once for the whole burst,
+ *  \li the next packet is parsed and classified, and the index of contexts
+ *      is prefetched for it, before the current packet is compressed,
+ *  \li the context of the previous packet is tried first, so that the
+ *      successive packets of one flow do not search the index of contexts.
+ *
+ * The status of the compression of every packet is stored in the array
+ * \e statuses, see \ref rohc_compress4 for the possible values. The
+ * compression of one packet may fail without stopping the compression of
+ * the next packets.
+ *
+ * The compression of the burst stops after the first packet that requires
+ * ROHC segmentation (\ref ROHC_STATUS_SEGMENT): retrieve its segments with
+ * \ref rohc_comp_get_segment2 before compressing the remaining packets.
+ *
+ * @param comp                The ROHC compressor
+ * @param uncomp_packets      The uncompressed packets to compress
+ * @param[out] rohc_packets   The resulting compressed ROHC packets, one empty
+ *                            buffer for every uncompressed packet
+ * @param packets_nr          The number of packets in the burst
+ * @param[out] statuses       The status of the compression of every packet
+ * @return                    The number of packets of the burst that were
+ *                            handled (with success or not), 0 if the
+ *                            parameters are invalid
  *
- * Set the timeout values for IR and FO periodic refreshes. The IR timeout
- * shall be greater than the FO timeout. Both timeouts are expressed in
- * number of compressed packets.
- *
- * The IR timeout is set to \ref CHANGE_TO_IR_COUNT by default.
- * The FO timeout is set to \ref CHANGE_TO_FO_COUNT by default.
- *
- * @warning The values can not be modified after library initialization
+ * @ingroup rohc_comp
  *
- * @param comp        The ROHC compressor
- * @param ir_timeout  The number of packets to compress before going back
- *                    to IR state to force a context refresh
- * @param fo_timeout  The number of packets to compress before going back
- *                    to FO state to force a context refresh
- * @return            true in case of success, false in case of failure
+ * @see rohc_compress4
+ * @see rohc_compress_burst2
+ * @see rohc_comp_get_segment2
+ */
+size_t rohc_compress_burst(struct rohc_comp *const comp,
+                           const struct rohc_buf *const uncomp_packets,
+                           struct rohc_buf *const rohc_packets,
+                           const size_t packets_nr,
+                           rohc_status_t *const statuses)
+{
+	return rohc_compress_burst2(comp, uncomp_packets, NULL, rohc_packets,
+	                            packets_nr, statuses);
+}
+
+
+/**
+ * @brief Compress a burst of uncompressed packets with per-packet hints
+ *
+ * Compress the given uncompressed packets as \ref rohc_compress_burst does,
+ * with one set of hints for every packet. The hints usually come from the
+ * metadata that the network interface attached to the packet on reception,
+ * see \ref rohc_comp_pkt_flags_t. For example, the IPv4 header checksums of
+ * the packets flagged with \ref ROHC_COMP_PKT_IP_CSUM_VERIFIED are not
+ * verified again, while the ones of the other packets of the burst are.
+ *
+ * @param comp                The ROHC compressor
+ * @param uncomp_packets      The uncompressed packets to compress
+ * @param pkt_flags           The hints about every uncompressed packet, a
+ *                            combination of \ref rohc_comp_pkt_flags_t;
+ *                            NULL if there is no hint for any packet
+ * @param[out] rohc_packets   The resulting compressed ROHC packets, one empty
+ *                            buffer for every uncompressed packet
+ * @param packets_nr          The number of packets in the burst
+ * @param[out] statuses       The status of the compression of every packet
+ * @return                    The number of packets of the burst that were
+ *                            handled (with success or not), 0 if the
+ *                            parameters are invalid
  *
  * @ingroup rohc_comp
+ *
+ * @see rohc_compress_burst
  */
-bool rohc_comp_set_periodic_refreshes(struct rohc_comp *const comp,
-                                      const size_t ir_timeout,
-                                      const size_t fo_timeout)
+size_t rohc_compress_burst2(struct rohc_comp *const comp,
+                            const struct rohc_buf *const uncomp_packets,
+                            const int *const pkt_flags,
+                            struct rohc_buf *const rohc_packets,
+                            const size_t packets_nr,
+                            rohc_status_t *const statuses)
 {
-	/* we need a valid compressor, positive non-zero timeouts,
-	 * and IR timeout > FO timeout */
+	/* check inputs validity */
 	if(comp == NULL)
 	{
-		return false;
+		goto error;
 	}
-	if(ir_timeout == 0 || fo_timeout == 0 || ir_timeout <= fo_timeout)
+	if(uncomp_packets == NULL || rohc_packets == NULL || statuses == NULL)
 	{
-		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL, "invalid "
-		             "timeouts for context periodic refreshes (IR timeout = %zd, "
-		             "FO timeout = %zd)", ir_timeout, fo_timeout);
-		return false;
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		             "given arrays of packets or statuses are NULL");
+		goto error;
 	}
-
-	/* refuse to set values if compressor is in use */
-	if(comp->num_packets > 0)
+	if(packets_nr == 0)
 	{
-		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-		             "unable to modify the timeouts for periodic refreshes "
-		             "after initialization");
-		return false;
+		goto error;
 	}
 
-	comp->periodic_refreshes_ir_timeout = ir_timeout;
-	comp->periodic_refreshes_fo_timeout = fo_timeout;
-
-	rohc_info(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL, "IR timeout for "
-	          "context periodic refreshes set to %zd", ir_timeout);
-	rohc_info(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL, "FO timeout for "
-	          "context periodic refreshes set to %zd", fo_timeout);
+	return c_compress_burst(comp, uncomp_packets, pkt_flags, packets_nr,
+	                        rohc_packets, NULL, NULL, statuses);
 
-	return true;
+error:
+	return 0;
 }
 
 
 /**
- * @brief Set the number of uncompressed transmissions for list compression
- *
- * Set the number of transmissions required for list compression. This matches
- * the L parameter described in RFC 3095 and 4815. The compressor sends the
- * list items uncompressed L times before compressing them. The compressor
- * also sends the list structure L times before compressing it out.
- *
- * The L parameter is set to \ref ROHC_LIST_DEFAULT_L by default.
+ * @brief Compress a burst of uncompressed packets into one arena
+ *
+ * Compress the given uncompressed packets as \ref rohc_compress_burst2 does,
+ * but write the ROHC headers of the whole burst back-to-back in one arena
+ * provided by the caller instead of one output buffer per packet. The
+ * payloads are not copied: as with \ref rohc_compress_iov, the payload of
+ * every ROHC packet remains in its uncompressed packet. One small
+ * descriptor per packet gives the location of its ROHC header in the arena
+ * and of its payload in the uncompressed packet, so that the transmit
+ * descriptors of the burst are gathered from a few cache lines.
+ *
+ * The ROHC headers are appended to the data of the arena, whose length grows
+ * accordingly: the arena may be shared by several bursts, and it shall be
+ * emptied by the caller once the ROHC packets are transmitted. The offsets
+ * of the descriptors are relative to the beginning of the data of the arena.
+ *
+ * The compression of the burst stops before the first packet for which the
+ * arena has less free room than the length of the uncompressed packet plus
+ * \ref ROHC_COMP_ARENA_EXTRA_LEN bytes: transmit the ROHC packets, empty the
+ * arena, then compress the remaining packets.
+ *
+ * The descriptor of one packet is set only if its status is
+ * \ref ROHC_STATUS_OK. ROHC segmentation is not available.
  *
- * @warning The value can not be modified after library initialization
- *
- * @param comp           The ROHC compressor
- * @param list_trans_nr  The number of times the list items or the list itself
- *                       are sent uncompressed before being sent compressed
- * @return               true if the new value is accepted,
- *                       false if the value is rejected
+ * @param comp             The ROHC compressor
+ * @param uncomp_packets   The uncompressed packets to compress
+ * @param pkt_flags        The hints about every uncompressed packet, a
+ *                         combination of \ref rohc_comp_pkt_flags_t;
+ *                         NULL if there is no hint for any packet
+ * @param packets_nr       The number of packets in the burst
+ * @param[in,out] arena    The arena where the ROHC headers are appended
+ * @param[out] descs       The descriptors of the ROHC packets, one for every
+ *                         uncompressed packet
+ * @param[out] statuses    The status of the compression of every packet
+ * @return                 The number of packets of the burst that were
+ *                         handled (with success or not), 0 if the parameters
+ *                         are invalid or if the arena is full
  *
  * @ingroup rohc_comp
+ *
+ * @see rohc_compress_burst2
+ * @see rohc_compress_iov
  */
-bool rohc_comp_set_list_trans_nr(struct rohc_comp *const comp,
-                                 const size_t list_trans_nr)
+size_t rohc_compress_burst_arena(struct rohc_comp *const comp,
+                                 const struct rohc_buf *const uncomp_packets,
+                                 const int *const pkt_flags,
+                                 const size_t packets_nr,
+                                 struct rohc_buf *const arena,
+                                 rohc_comp_burst_desc_t *const descs,
+                                 rohc_status_t *const statuses)
 {
-	/* we need a valid compressor and a positive non-zero value for L */
+	/* check inputs validity */
 	if(comp == NULL)
 	{
-		return false;
+		goto error;
 	}
-	if(list_trans_nr == 0)
+	if(uncomp_packets == NULL || descs == NULL || statuses == NULL)
 	{
-		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL, "invalid "
-		             "value for uncompressed transmissions of list compression "
-		             "(%zu)", list_trans_nr);
-		return false;
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		             "given arrays of packets, descriptors or statuses are "
+		             "NULL");
+		goto error;
 	}
-
-	/* refuse to set values if compressor is in use */
-	if(comp->num_packets > 0)
+	if(arena == NULL || rohc_buf_is_malformed(*arena))
 	{
 		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-		             "unable to modify the value for uncompressed transmissions"
-		             " of list compression after initialization");
-		return false;
+		             "given arena is NULL or malformed");
+		goto error;
+	}
+	if(packets_nr == 0)
+	{
+		goto error;
 	}
 
-	comp->list_trans_nr = list_trans_nr;
-
-	rohc_info(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL, "uncompressed "
-	          "transmissions of list compression set to %zu", list_trans_nr);
+	return c_compress_burst(comp, uncomp_packets, pkt_flags, packets_nr,
+	                        NULL, arena, descs, statuses);
 
-	return true;
+error:
+	return 0;
 }
 
 
 /**
- * @brief Set the RTP detection callback function
- *
- * Set or replace the callback function that the ROHC library will call to
- * detect RTP streams among other UDP streams.
+ * @brief Get the next ROHC segment if any
  *
- * The function is called once per UDP packet to compress, with the IP and
- * UDP headers and the UDP payload. If the callback function returns true, the
- * RTP profile is used for compression, otherwise the IP/UDP profile is used
- * instead.
+ * Get the next ROHC segment if any.
  *
- * Special value NULL may be used to disable the detection of RTP streams with
- * the callback method. The detection will then be based on a list of UDP
- * ports dedicated for RTP streams.
+ * To get all the segments of one ROHC packet, call this function until
+ * \ref ROHC_STATUS_OK or \ref ROHC_STATUS_ERROR is returned.
  *
- * @param comp        The ROHC compressor
- * @param callback    The callback function used to detect RTP packets
- *                    The callback is deactivated if NULL is given as parameter
- * @param rtp_private A pointer to an external memory area
- *                    provided and used by the callback user
- * @return            true on success, false otherwise
+ * @param comp         The ROHC compressor
+ * @param[out] segment  The buffer where to store the ROHC segment
+ * @return              Possible return values:
+ *                       \li \ref ROHC_STATUS_SEGMENT if a ROHC segment is
+ *                           returned and more segments are available,
+ *                       \li \ref ROHC_STATUS_OK if a ROHC segment is returned
+ *                           and no more ROHC segment is available
+ *                       \li \ref ROHC_STATUS_ERROR if an error occurred
  *
  * @ingroup rohc_comp
  *
  * \par Example:
- * \snippet rtp_detection.c define RTP detection callback
+ * \snippet test_segment.c define ROHC compressor
  * \code
         ...
+        // compress the IP packet with a small ROHC buffer
 \endcode
- * \snippet simple_rohc_program.c define ROHC compressor
+ * \snippet test_segment.c segment ROHC packet #1
+ * \snippet test_segment.c segment ROHC packet #2
  * \code
-        ...
+                        ...
+                        // decompress the ROHC segment here, the function
+                        // rohc_decompress3 shall return ROHC_STATUS_OK
+                        // and no decompressed packet
+                        ...
 \endcode
- * \snippet simple_rohc_program.c create ROHC compressor
+ * \snippet test_segment.c segment ROHC packet #3
  * \code
-        ...
+                // decompress the final ROHC segment here, the function
+                // rohc_decompress4 shall return ROHC_STATUS_OK
 \endcode
- * \snippet rtp_detection.c set RTP detection callback
+ * \snippet test_segment.c segment ROHC packet #4
  * \code
-        ...
+                // handle compression error here
+                ...
 \endcode
- * \snippet simple_rohc_program.c destroy ROHC compressor
  *
- * @see rohc_rtp_detection_callback_t
- * @see rohc_comp_add_rtp_port
- * @see rohc_comp_remove_rtp_port
- * @see rohc_comp_reset_rtp_ports
+ * @see rohc_comp_get_mrru
+ * @see rohc_comp_set_mrru
+ * @see rohc_compress4
  */
-bool rohc_comp_set_rtp_detection_cb(struct rohc_comp *const comp,
-                                    rohc_rtp_detection_callback_t callback,
-                                    void *const rtp_private)
-{
-	/* sanity check on compressor */
-	if(comp == NULL)
-	{
-		return false;
-	}
-
-	/* set RTP detection callback */
-	comp->rtp_callback = callback;
-	comp->rtp_private = rtp_private;
-
-	return true;
-}
-
+rohc_status_t rohc_comp_get_segment2(struct rohc_comp *const comp,
+                                     struct rohc_buf *const segment)
 
-/**
- * @brief Is the given compression profile enabled for a compressor?
- *
- * Is the given compression profile enabled or disabled for a compressor?
- *
- * @param comp     The ROHC compressor
- * @param profile  The profile to ask status for
- * @return         Possible return values:
- *                  \li true if the profile exists and is enabled,
- *                  \li false if the compressor is not valid, the profile
- *                      does not exist, or the profile is disabled
- *
- * @ingroup rohc_comp
- *
- * @see rohc_comp_enable_profile
- * @see rohc_comp_enable_profiles
- * @see rohc_comp_disable_profile
- * @see rohc_comp_disable_profiles
- */
-bool rohc_comp_profile_enabled(const struct rohc_comp *const comp,
-                               const rohc_profile_t profile)
 {
-	size_t i;
+	const size_t segment_type_len = 1; /* segment type byte */
+	size_t max_data_len;
+	rohc_status_t status;
 
+	/* check input parameters */
 	if(comp == NULL)
 	{
 		goto error;
 	}
+	if(segment == NULL)
+	{
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		             "given segment cannot be NULL");
+		goto error;
+	}
+	if(rohc_buf_is_malformed(*segment))
+	{
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		             "given segment is malformed");
+		goto error;
+	}
+	if(!rohc_buf_is_empty(*segment))
+	{
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		             "given segment is not empty");
+		goto error;
+	}
 
-	/* search the profile location */
-	for(i = 0; i < C_NUM_PROFILES; i++)
+	/* no segment yet */
+	segment->len = 0;
+
+	/* abort if no RRU is available in the compressor */
+	if(comp->rru_len == 0)
 	{
-		if(rohc_comp_profiles[i]->id == profile)
-		{
-			/* found */
-			break;
-		}
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		             "no RRU available in given compressor");
+		goto error;
 	}
 
-	if(i == C_NUM_PROFILES)
+	/* abort is the given output buffer is too small for RRU */
+	if(rohc_buf_avail_len(*segment) <= segment_type_len)
 	{
 		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-		             "unknown ROHC compression profile (ID = %d)", profile);
+		             "output buffer is too small for RRU, more than %zd bytes "
+		             "are required", segment_type_len);
 		goto error;
 	}
 
-	/* return profile status */
-	return comp->enabled_profiles[i];
+	/* how many bytes of ROHC packet can we put in that new segment? */
+	max_data_len = rohc_min(rohc_buf_avail_len(*segment) - segment_type_len,
+	                        comp->rru_len);
+	assert(max_data_len > 0);
+	rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+	           "copy %zd bytes of the remaining %zd bytes of ROHC packet and "
+	           "CRC in the segment", max_data_len, comp->rru_len);
+
+	/* set segment type with F bit set only for last segment */
+	rohc_buf_byte_at(*segment, 0) = 0xfe | (max_data_len == comp->rru_len);
+	segment->len++;
+	rohc_buf_pull(segment, 1);
+
+	/* copy remaining ROHC data (CRC included) */
+	rohc_buf_append(segment, comp->rru + comp->rru_off, max_data_len);
+	rohc_buf_pull(segment, max_data_len);
+	comp->rru_off += max_data_len;
+	comp->rru_len -= max_data_len;
+
+	/* set status wrt to (non-)final segment */
+	if(comp->rru_len == 0)
+	{
+		/* final segment, no more segment available */
+		status = ROHC_STATUS_OK;
+		/* reset context for next RRU */
+		comp->rru_off = 0;
+	}
+	else
+	{
+		/* non-final segment, more segments to available */
+		status = ROHC_STATUS_SEGMENT;
+	}
+
+	/* shift backward the RRU data, header and the feedback data */
+	rohc_buf_push(segment, max_data_len + 1);
+
+	return status;
 
 error:
-	return false;
+	return ROHC_STATUS_ERROR;
 }
 
 
 /**
- * @brief Enable a compression profile for a compressor
- *
- * Enable a compression profiles for a compressor.
+ * @brief Get all the ROHC segments of the current RRU at once
  *
- * The ROHC compressor does not use the compression profiles that are not
- * enabled. Thus not enabling a profile might affect compression performances.
- * Compression will fail if no profile at all is enabled.
+ * Get all the ROHC segments of the Reconstructed Reception Unit (RRU) that
+ * \ref rohc_compress4 stored in the compressor, as successive calls to
+ * \ref rohc_comp_get_segment2 would do. One ROHC segment is stored in every
+ * given buffer, as many bytes as the buffer can hold.
  *
- * If the profile is already enabled, nothing is performed and success is
- * reported.
+ * No segment is retrieved if the given buffers cannot hold the whole RRU.
  *
- * @param comp     The ROHC compressor
- * @param profile  The profile to enable
- * @return         true if the profile exists,
- *                 false if the profile does not exist
+ * @param comp              The ROHC compressor
+ * @param[out] segments     The buffers where to store the ROHC segments, all
+ *                          of them empty
+ * @param segments_max      The number of buffers in \e segments
+ * @param[out] segments_nr  The number of ROHC segments that were stored
+ * @return                  true if all the segments of the RRU were stored,
+ *                          false otherwise
  *
  * @ingroup rohc_comp
  *
- * \par Example:
- * \snippet simple_rohc_program.c define ROHC compressor
- * \code
-        ...
-\endcode
- * \snippet simple_rohc_program.c enable ROHC compression profile
- * \code
-        ...
-\endcode
- *
- * @see rohc_comp_enable_profiles
- * @see rohc_comp_disable_profile
- * @see rohc_comp_disable_profiles
+ * @see rohc_comp_get_segment2
+ * @see rohc_compress4
  */
-bool rohc_comp_enable_profile(struct rohc_comp *const comp,
-                              const rohc_profile_t profile)
+bool rohc_comp_get_segments(struct rohc_comp *const comp,
+                            struct rohc_buf *const segments,
+                            const size_t segments_max,
+                            size_t *const segments_nr)
 {
+	size_t remain_len;
 	size_t i;
 
+	/* check input parameters */
 	if(comp == NULL)
 	{
 		goto error;
 	}
+	if(segments == NULL || segments_nr == NULL)
+	{
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		             "given segments or segments_nr cannot be NULL");
+		goto error;
+	}
+	if(comp->rru_len == 0)
+	{
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		             "no RRU available in given compressor");
+		goto error;
+	}
 
-	/* search the profile location */
-	for(i = 0; i < C_NUM_PROFILES; i++)
+	/* check that the buffers can hold the whole RRU before retrieving any
+	 * segment */
+	remain_len = comp->rru_len;
+	for(i = 0; i < segments_max && remain_len > 0; i++)
 	{
-		if(rohc_comp_profiles[i]->id == profile)
+		if(rohc_buf_is_malformed(segments[i]) ||
+		   !rohc_buf_is_empty(segments[i]) ||
+		   rohc_buf_avail_len(segments[i]) <= 1)
 		{
-			/* found */
-			break;
+			rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+			             "given segment #%zu is malformed, not empty or too "
+			             "small", i + 1);
+			goto error;
 		}
+		remain_len -= rohc_min(rohc_buf_avail_len(segments[i]) - 1, remain_len);
 	}
-
-	if(i == C_NUM_PROFILES)
+	if(remain_len > 0)
 	{
 		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-		             "unknown ROHC compression profile (ID = %d)", profile);
+		             "the %zu given segments are too few for the %zu-byte RRU",
+		             segments_max, comp->rru_len);
 		goto error;
 	}
 
-	/* mark the profile as enabled */
-	comp->enabled_profiles[i] = true;
-	rohc_info(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-	          "ROHC compression profile (ID = %d) enabled", profile);
+	/* retrieve all the segments */
+	*segments_nr = 0;
+	do
+	{
+		const rohc_status_t status =
+			rohc_comp_get_segment2(comp, &segments[*segments_nr]);
+		if(status == ROHC_STATUS_ERROR)
+		{
+			goto error;
+		}
+		(*segments_nr)++;
+	}
+	while(comp->rru_len > 0);
 
 	return true;
 
@@ -1362,59 +1953,133 @@ error:
 
 
 /**
- * @brief Disable a compression profile for a compressor
+ * @brief Describe the ROHC segments of one ROHC packet without copying it
  *
- * Disable a compression profile for a compressor.
+ * Split the ROHC packet made of the given ROHC header and payload, as
+ * returned by \ref rohc_compress_iov, into ROHC segments. The segments are
+ * described by references to the ROHC header, to the payload and to the
+ * FCS-32 CRC of the Reconstructed Reception Unit (RRU) kept in the
+ * compressor: no data is copied, the network layer may transmit every
+ * segment with one gather list.
  *
- * The ROHC compressor does not use the compression profiles that were
- * disabled. Thus disabling a profile might affect compression performances.
- * Compression will fail if no profile at all is enabled.
+ * The references are valid as long as the ROHC header and the payload are,
+ * and until the next call to the function.
  *
- * If the profile is already disabled, nothing is performed and success is
- * reported.
+ * The ROHC packet and its CRC shall not exceed the MRRU configured with
+ * \ref rohc_comp_set_mrru.
  *
- * @param comp     The ROHC compressor
- * @param profile  The profile to disable
- * @return         true if the profile exists,
- *                 false if the profile does not exist
+ * @param comp              The ROHC compressor
+ * @param rohc_hdr          The ROHC header of the ROHC packet
+ * @param payload           The payload of the ROHC packet
+ * @param segment_max_len   The maximum length (in bytes) of one segment,
+ *                          segment type byte included
+ * @param[out] segments     The descriptions of the segments
+ * @param segments_max      The number of descriptions in \e segments
+ * @param[out] segments_nr  The number of segments of the ROHC packet
+ * @return                  true if the segments were described,
+ *                          false otherwise
  *
  * @ingroup rohc_comp
  *
- * @see rohc_comp_enable_profile
- * @see rohc_comp_enable_profiles
- * @see rohc_comp_disable_profiles
+ * @see rohc_compress_iov
+ * @see rohc_comp_set_mrru
  */
-bool rohc_comp_disable_profile(struct rohc_comp *const comp,
-                               const rohc_profile_t profile)
+bool rohc_comp_segment_iov(struct rohc_comp *const comp,
+                           const struct rohc_buf rohc_hdr,
+                           const struct rohc_buf payload,
+                           const size_t segment_max_len,
+                           rohc_comp_segment_t *const segments,
+                           const size_t segments_max,
+                           size_t *const segments_nr)
 {
-	size_t i;
+	const size_t rru_len = rohc_hdr.len + payload.len + CRC_FCS32_LEN;
+	size_t seg_data_max_len;
+	size_t rru_off;
+	uint32_t rru_crc;
 
+	/* check input parameters */
 	if(comp == NULL)
 	{
 		goto error;
 	}
-
-	/* search the profile location */
-	for(i = 0; i < C_NUM_PROFILES; i++)
+	if(segments == NULL || segments_nr == NULL)
 	{
-		if(rohc_comp_profiles[i]->id == profile)
-		{
-			/* found */
-			break;
-		}
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		             "given segments or segments_nr cannot be NULL");
+		goto error;
 	}
-
-	if(i == C_NUM_PROFILES)
+	if(rohc_buf_is_malformed(rohc_hdr) || rohc_buf_is_empty(rohc_hdr) ||
+	   rohc_buf_is_malformed(payload))
 	{
 		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-		             "unknown ROHC compression profile (ID = %d)", profile);
+		             "given ROHC header or payload is malformed");
+		goto error;
+	}
+	if(segment_max_len <= 1)
+	{
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		             "segments of %zu bytes are too small", segment_max_len);
 		goto error;
 	}
 
-	/* mark the profile as disabled */
-	comp->enabled_profiles[i] = false;
-	rohc_info(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-	          "ROHC compression profile (ID = %d) disabled", profile);
+	/* in order to be segmented, a ROHC packet shall be <= MRRU
+	 * (remember that MRRU includes the CRC length) */
+	if(rru_len > comp->mrru)
+	{
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		             "ROHC packet cannot be segmented: too large (%zu + %zu + "
+		             "%u = %zu bytes) for MRRU (%zu bytes)", rohc_hdr.len,
+		             payload.len, CRC_FCS32_LEN, rru_len, comp->mrru);
+		goto error;
+	}
+	seg_data_max_len = segment_max_len - 1;
+	if(((rru_len + seg_data_max_len - 1) / seg_data_max_len) > segments_max)
+	{
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		             "the %zu given segments are too few for the %zu-byte RRU",
+		             segments_max, rru_len);
+		goto error;
+	}
+
+	/* compute FCS-32 CRC over header and payload */
+	rru_crc = crc_calc_fcs32(rohc_buf_data(rohc_hdr), rohc_hdr.len,
+	                         CRC_INIT_FCS32);
+	rru_crc = crc_calc_fcs32(rohc_buf_data(payload), payload.len, rru_crc);
+	memcpy(comp->rru_iov_crc, &rru_crc, CRC_FCS32_LEN);
+	rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+	           "RRU 32-bit FCS CRC = 0x%08x", rohc_ntoh32(rru_crc));
+
+	/* describe the segments: every segment carries the next bytes of the
+	 * ROHC header, then of the payload, then of the CRC */
+	*segments_nr = 0;
+	for(rru_off = 0; rru_off < rru_len; rru_off += seg_data_max_len)
+	{
+		rohc_comp_segment_t *const seg = &segments[*segments_nr];
+		const size_t seg_end = rohc_min(rru_off + seg_data_max_len, rru_len);
+		const size_t hdr_end = rohc_hdr.len;
+		const size_t payload_end = hdr_end + payload.len;
+		size_t beg;
+
+		seg->type = 0xfe | (seg_end == rru_len);
+
+		beg = rohc_min(rru_off, hdr_end);
+		seg->rohc_hdr = rohc_buf_data(rohc_hdr) + beg;
+		seg->rohc_hdr_len = rohc_min(seg_end, hdr_end) - beg;
+
+		beg = rohc_max(rohc_min(rru_off, payload_end), hdr_end);
+		seg->payload = rohc_buf_data(payload) + (beg - hdr_end);
+		seg->payload_len = rohc_max(rohc_min(seg_end, payload_end), hdr_end) - beg;
+
+		beg = rohc_max(rru_off, payload_end);
+		seg->crc = comp->rru_iov_crc + (beg - payload_end);
+		seg->crc_len = rohc_max(seg_end, payload_end) - beg;
+
+		assert((seg->rohc_hdr_len + seg->payload_len + seg->crc_len) ==
+		       (seg_end - rru_off));
+		(*segments_nr)++;
+	}
+	rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+	           "%zu-byte RRU described in %zu segments", rru_len, *segments_nr);
 
 	return true;
 
@@ -1424,67 +2089,65 @@ error:
 
 
 /**
- * @brief Enable several compression profiles for a compressor
- *
- * Enable several compression profiles for a compressor. The list of profiles
- * to enable shall stop with -1.
+ * @brief Force the compressor to re-initialize all its contexts
  *
- * The ROHC compressor does not use the compression profiles that are not
- * enabled. Thus not enabling a profile might affect compression performances.
- * Compression will fail if no profile at all is enabled.
+ * Make all contexts restart their initialization with decompressor, ie. they
+ * go in the lowest compression state. This function can be used once the
+ * ROHC channel is established again after an interruption.
  *
- * If one or more of the profiles are already enabled, nothing is performed
- * and success is reported.
+ * The function implements the CONTEXT_REINITIALIZATION signal described by
+ * RFC 3095 at §6.3.1 as:
+ * \verbatim
+   CONTEXT_REINITIALIZATION -- signal
+   This parameter triggers a reinitialization of the entire context at
+   the decompressor, both the static and the dynamic part.  The
+   compressor MUST, when CONTEXT_REINITIALIZATION is triggered, back off
+   to the IR state and fully reinitialize the context by sending IR
+   packets with both the static and dynamic chains covering the entire
+   uncompressed headers until it is reasonably confident that the
+   decompressor contexts are reinitialized.  The context
+   reinitialization MUST be done for all contexts at the compressor.
+   This parameter may for instance be used to do context relocation at,
+   e.g., a cellular handover that results in a change of compression
+   point in the radio access network.
+\endverbatim
  *
  * @param comp  The ROHC compressor
- * @param ...   The sequence of compression profiles to enable, the sequence
- *              shall be terminated by -1
- * @return      true if all of the profiles exist,
- *              false if at least one of the profiles does not exist
+ * @return      true in case of success, false otherwise
  *
  * @ingroup rohc_comp
- *
- * \par Example:
- * \snippet simple_rohc_program.c define ROHC compressor
- * \code
-        ...
-\endcode
- * \snippet simple_rohc_program.c enable ROHC compression profiles
- * \code
-        ...
-\endcode
- *
- * @see rohc_comp_enable_profile
- * @see rohc_comp_disable_profile
- * @see rohc_comp_disable_profiles
  */
-bool rohc_comp_enable_profiles(struct rohc_comp *const comp,
-                               ...)
+bool rohc_comp_force_contexts_reinit(struct rohc_comp *const comp)
 {
-	va_list profiles;
-	int profile_id;
-	size_t err_nr = 0;
-	bool is_ok;
+	rohc_cid_t i;
 
 	if(comp == NULL)
 	{
 		goto error;
 	}
 
-	va_start(profiles, comp);
+	rohc_info(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+	          "force re-initialization for all %zu contexts",
+	          comp->num_contexts_used);
 
-	while((profile_id = va_arg(profiles, int)) >= 0)
+	/* no context waits for a paced re-initialization anymore */
+	comp->reinit.pending_nr = 0;
+
+	for(i = c_next_used_cid(comp, 0); i <= comp->medium.max_cid;
+	    i = c_next_used_cid(comp, i + 1))
 	{
-		is_ok = rohc_comp_enable_profile(comp, profile_id);
-		if(!is_ok)
+		struct rohc_comp_ctxt *const context = c_ctxt_at(comp, i);
+
+		context->reinit_pending = false;
+		if(!context->profile->reinit_context(context))
 		{
-			err_nr++;
+			rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+			             "failed to force re-initialization for CID %zu", i);
+			goto error;
 		}
 	}
 
-	va_end(profiles);
-
-	return (err_nr == 0);
+	return true;
 
 error:
 	return false;
@@ -1492,57 +2155,74 @@ error:
 
 
 /**
- * @brief Disable several compression profiles for a compressor
- *
- * Disable several compression profiles for a compressor. The list of profiles
- * to disable shall stop with -1.
+ * @brief Force the compressor to re-initialize all its contexts, at a pace
+ *        compatible with the channel
+ *
+ * Same as \ref rohc_comp_force_contexts_reinit, but the contexts are not
+ * re-initialized all at once: every context is re-initialized with the next
+ * packet of its flow, as long as the given pace allows it. The flows that
+ * send packets first, that is the most active ones, are thus re-initialized
+ * first. The other flows go on with their current contexts meanwhile.
+ *
+ * The pace is given as a duration, a rate of IR bytes or both:
+ *  - with a duration, the contexts are re-initialized at a constant pace
+ *    over the duration, and all the contexts left are re-initialized with
+ *    their next packet once the duration is elapsed,
+ *  - with a rate of IR bytes, a context is re-initialized only once the
+ *    ROHC headers of the previous re-initializations are paid for.
+ *
+ * The pace relies on the arrival times of the packets given to
+ * \ref rohc_compress4, the pace starts with the first packet compressed
+ * after the call. The progress is available through the reinit_pending_nr
+ * and reinit_total_nr fields of \ref rohc_comp_get_general_info.
  *
- * The ROHC compressor does not use the compression profiles that were
- * disabled. Thus disabling a profile might affect compression performances.
- * Compression will fail if no profile at all is enabled.
- *
- * If one or more of the profiles are already disabled, nothing is performed
- * and success is reported.
- *
- * @param comp  The ROHC compressor
- * @param ...   The sequence of compression profiles to disable, the sequence
- *              shall be terminated by -1
- * @return      true if all of the profiles exist,
- *              false if at least one of the profiles does not exist
+ * @param comp        The ROHC compressor
+ * @param duration    The maximal duration of the re-initialization
+ *                    (in milliseconds), 0 for no limit in time
+ * @param bytes_rate  The maximal number of bytes of ROHC headers per second
+ *                    for the re-initialized contexts, 0 for no limit in
+ *                    bytes
+ * @return            true in case of success, false otherwise
  *
  * @ingroup rohc_comp
  *
- * @see rohc_comp_enable_profile
- * @see rohc_comp_enable_profiles
- * @see rohc_comp_disable_profile
+ * @see rohc_comp_force_contexts_reinit
  */
-bool rohc_comp_disable_profiles(struct rohc_comp *const comp,
-                                ...)
+bool rohc_comp_force_contexts_reinit_paced(struct rohc_comp *const comp,
+                                           const uint64_t duration,
+                                           const size_t bytes_rate)
 {
-	va_list profiles;
-	int profile_id;
-	size_t err_nr = 0;
-	bool is_ok;
+	rohc_cid_t i;
 
 	if(comp == NULL)
 	{
 		goto error;
 	}
 
-	va_start(profiles, comp);
-
-	while((profile_id = va_arg(profiles, int)) >= 0)
+	/* without pace, re-initialize all the contexts at once */
+	if(duration == 0 && bytes_rate == 0)
 	{
-		is_ok = rohc_comp_disable_profile(comp, profile_id);
-		if(!is_ok)
-		{
-			err_nr++;
-		}
+		return rohc_comp_force_contexts_reinit(comp);
 	}
 
-	va_end(profiles);
+	rohc_info(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+	          "force paced re-initialization for all %zu contexts (duration = "
+	          "%" PRIu64 " ms, rate = %zu bytes/s)", comp->num_contexts_used,
+	          duration, bytes_rate);
 
-	return (err_nr == 0);
+	for(i = c_next_used_cid(comp, 0); i <= comp->medium.max_cid;
+	    i = c_next_used_cid(comp, i + 1))
+	{
+		c_ctxt_at(comp, i)->reinit_pending = true;
+	}
+	comp->reinit.pending_nr = comp->num_contexts_used;
+	comp->reinit.total_nr = comp->num_contexts_used;
+	comp->reinit.duration = duration;
+	comp->reinit.is_started = false;
+	comp->reinit.credit.bytes_rate = bytes_rate;
+	comp->reinit.credit.bytes = 0;
+
+	return true;
 
 error:
 	return false;
@@ -1550,575 +2230,530 @@ error:
 
 
 /**
- * @brief Set the Maximum Reconstructed Reception Unit (MRRU).
+ * @brief Set the window width for the W-LSB encoding scheme
  *
- * Set the Maximum Reconstructed Reception Unit (MRRU).
+ * Set the window width for the Window-based Least Significant Bits (W-LSB)
+ * encoding. See section 4.5.2 of RFC 3095 for more details about the encoding
+ * scheme.
  *
- * The MRRU is the largest cumulative length (in bytes) of the ROHC segments
- * that are parts of the same ROHC packet. In short, the ROHC decompressor
- * does not expect to reassemble ROHC segments whose total length is larger
- * than MRRU. So, the ROHC compressor shall not segment ROHC packets greater
- * than the MRRU.
+ * The width of the W-LSB window is set to 4 by default.
  *
- * The MRRU value must be in range [0 ; \ref ROHC_MAX_MRRU]. Remember that the
- * MRRU includes the 32-bit CRC that protects it.
- * If set to 0, segmentation is disabled as no segment headers are allowed
- * on the channel. No segment will be generated.
+ * @warning The value must be a power of 2, and at most 64
  *
- * If segmentation is enabled and used by the compressor, the function
- * \ref rohc_comp_get_segment2 can be used to retrieve ROHC segments.
+ * @warning The value can not be modified after library initialization
  *
- * @param comp  The ROHC compressor
- * @param mrru  The new MRRU value (in bytes)
- * @return      true if the MRRU was successfully set, false otherwise
+ * @param comp   The ROHC compressor
+ * @param width  The width of the W-LSB sliding window
+ * @return       true in case of success, false in case of failure
  *
  * @ingroup rohc_comp
- *
- * \par Example:
- * \snippet test_segment.c define ROHC compressor
- * \code
-        size_t mrru = 500;
-        ...
-\endcode
- * \snippet test_segment.c set compressor MRRU
- * \code
-        ...
-\endcode
- *
- * @see rohc_comp_get_mrru
- * @see rohc_comp_get_segment2
- * @see rohc_decomp_set_mrru
  */
-bool rohc_comp_set_mrru(struct rohc_comp *const comp,
-                        const size_t mrru)
+bool rohc_comp_set_wlsb_window_width(struct rohc_comp *const comp,
+                                     const size_t width)
 {
-	/* compressor must be valid */
+	/* we need a valid compressor and a positive non-zero window width */
 	if(comp == NULL)
 	{
-		/* cannot print a trace without a valid compressor */
-		goto error;
+		return false;
+	}
+	if(width == 0)
+	{
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL, "failed to "
+		             "set width of W-LSB sliding window to %zd: window width "
+		             "must be a non-null positive integer", width);
+		return false;
 	}
 
-	/* new MRRU value must be in range [0, ROHC_MAX_MRRU] */
-	if(mrru > ROHC_MAX_MRRU)
+	/* window width must be a power of 2 */
+	if((width & (width - 1)) != 0)
 	{
-		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-		             "unexpected MRRU value: must be in range [0, %d]",
-		             ROHC_MAX_MRRU);
-		goto error;
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL, "failed to "
+		             "set width of W-LSB sliding window to %zd: window width "
+		             "must be a power of 2", width);
+		return false;
+	}
+	if(width > ROHC_WLSB_WIDTH_MAX)
+	{
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL, "failed to "
+		             "set width of W-LSB sliding window to %zd: window width "
+		             "must not be greater than %u", width, ROHC_WLSB_WIDTH_MAX);
+		return false;
 	}
 
-	/* set new MRRU */
-	comp->mrru = mrru;
-	rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-	           "MRRU is now set to %zd", comp->mrru);
+	/* refuse to set a value if compressor is in use */
+	if(comp->num_packets > 0)
+	{
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL, "unable to "
+		             "modify the W-LSB window width after initialization");
+		return false;
+	}
 
-	return true;
+	comp->wlsb_window_width = width;
 
-error:
-	return false;
+	rohc_info(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+	          "width of W-LSB sliding window set to %zd", width);
+
+	return true;
 }
 
 
 /**
- * @brief Get the Maximum Reconstructed Reception Unit (MRRU).
- *
- * Get the current Maximum Reconstructed Reception Unit (MRRU).
- *
- * The MRRU is the largest cumulative length (in bytes) of the ROHC segments
- * that are parts of the same ROHC packet. In short, the ROHC decompressor
- * does not expect to reassemble ROHC segments whose total length is larger
- * than MRRU. So, the ROHC compressor shall not segment ROHC packets greater
- * than the MRRU.
+ * @brief Set the reordering that the ROHCv2 profiles shall tolerate
  *
- * The MRRU value must be in range [0 ; \ref ROHC_MAX_MRRU]. Remember that the
- * MRRU includes the 32-bit CRC that protects it.
- * If MRRU value is 0, segmentation is disabled.
+ * The ROHCv2 profiles (RFC 5225) transmit the reordering ratio in their
+ * packets, so the decompressor needs no configuration. The new ratio is
+ * used by the contexts created from now on. See \ref rohc_reordering_offset_t
+ * for the available ratios.
  *
- * If segmentation is enabled and used by the compressor, the function
- * \ref rohc_comp_get_segment2 can be used to retrieve ROHC segments.
+ * The reordering ratio is set to \ref ROHC_REORDERING_QUARTER by default.
  *
- * @param comp       The ROHC compressor
- * @param[out] mrru  The current MRRU value (in bytes)
- * @return           true if MRRU was successfully retrieved, false otherwise
+ * @param comp           The ROHC compressor
+ * @param reorder_ratio  The reordering ratio
+ * @return               true in case of success, false in case of failure
  *
  * @ingroup rohc_comp
- *
- * \par Example:
- * \snippet test_segment.c define ROHC compressor
- * \code
-        size_t mrru;
-        ...
-\endcode
- * \snippet test_non_regression.c get compressor MRRU
- * \code
-        printf("the current MMRU at compressor is %zu bytes\n", mrru);
-        ...
-\endcode
- *
- * @see rohc_comp_set_mrru
- * @see rohc_comp_get_segment2
- * @see rohc_decomp_set_mrru
- * @see rohc_decomp_get_mrru
  */
-bool rohc_comp_get_mrru(const struct rohc_comp *const comp,
-                        size_t *const mrru)
+bool rohc_comp_set_reorder_ratio(struct rohc_comp *const comp,
+                                 const rohc_reordering_offset_t reorder_ratio)
 {
-	if(comp == NULL || mrru == NULL)
+	if(comp == NULL)
 	{
-		goto error;
+		return false;
+	}
+	if(reorder_ratio != ROHC_REORDERING_NONE &&
+	   reorder_ratio != ROHC_REORDERING_QUARTER &&
+	   reorder_ratio != ROHC_REORDERING_HALF &&
+	   reorder_ratio != ROHC_REORDERING_THREEQUARTERS)
+	{
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL, "failed to "
+		             "set reordering ratio to %d: unknown ratio", reorder_ratio);
+		return false;
 	}
 
-	*mrru = comp->mrru;
-	return true;
+	comp->reorder_ratio = reorder_ratio;
 
-error:
-	return false;
+	rohc_info(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+	          "reordering ratio set to %d", reorder_ratio);
+
+	return true;
 }
 
 
 /**
- * @brief Get the maximal CID value the compressor uses
+ * @brief Set the timeout values for IR and FO periodic refreshes
  *
- * Get the maximal CID value the compressor uses, ie. the \e MAX_CID parameter
- * defined in RFC 3095.
+ * Set the timeout values for IR and FO periodic refreshes. The IR timeout
+ * shall be greater than the FO timeout. Both timeouts are expressed in
+ * number of compressed packets.
  *
- * @param comp          The ROHC compressor
- * @param[out] max_cid  The current maximal CID value
- * @return              true if MAX_CID was successfully retrieved,
- *                      false otherwise
+ * The IR timeout is set to \ref CHANGE_TO_IR_COUNT by default.
+ * The FO timeout is set to \ref CHANGE_TO_FO_COUNT by default.
+ *
+ * @warning The values can not be modified after library initialization
+ *
+ * @param comp        The ROHC compressor
+ * @param ir_timeout  The number of packets to compress before going back
+ *                    to IR state to force a context refresh
+ * @param fo_timeout  The number of packets to compress before going back
+ *                    to FO state to force a context refresh
+ * @return            true in case of success, false in case of failure
  *
  * @ingroup rohc_comp
+ *
+ * @see rohc_comp_set_periodic_refreshes_time
  */
-bool rohc_comp_get_max_cid(const struct rohc_comp *const comp,
-                           size_t *const max_cid)
+bool rohc_comp_set_periodic_refreshes(struct rohc_comp *const comp,
+                                      const size_t ir_timeout,
+                                      const size_t fo_timeout)
 {
-	if(comp == NULL || max_cid == NULL)
+	/* we need a valid compressor, positive non-zero timeouts,
+	 * and IR timeout > FO timeout */
+	if(comp == NULL)
 	{
-		goto error;
+		return false;
+	}
+	if(ir_timeout == 0 || fo_timeout == 0 || ir_timeout <= fo_timeout)
+	{
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL, "invalid "
+		             "timeouts for context periodic refreshes (IR timeout = %zd, "
+		             "FO timeout = %zd)", ir_timeout, fo_timeout);
+		return false;
 	}
 
-	*max_cid = comp->medium.max_cid;
-	return true;
+	/* refuse to set values if compressor is in use */
+	if(comp->num_packets > 0)
+	{
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		             "unable to modify the timeouts for periodic refreshes "
+		             "after initialization");
+		return false;
+	}
 
-error:
-	return false;
+	comp->periodic_refreshes_ir_timeout = ir_timeout;
+	comp->periodic_refreshes_fo_timeout = fo_timeout;
+
+	rohc_info(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL, "IR timeout for "
+	          "context periodic refreshes set to %zd", ir_timeout);
+	rohc_info(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL, "FO timeout for "
+	          "context periodic refreshes set to %zd", fo_timeout);
+
+	return true;
 }
 
 
 /**
- * @brief Get the CID type that the compressor uses
+ * @brief Set the timeout values for IR and FO time-based periodic refreshes
  *
- * Get the CID type that the compressor currently uses.
+ * Set the timeout values for IR and FO periodic refreshes based on the
+ * arrival times of the uncompressed packets (see the \e time member of
+ * \ref rohc_buf). The IR timeout shall be greater than the FO timeout. Both
+ * timeouts are expressed in milliseconds.
  *
- * @param comp           The ROHC compressor
- * @param[out] cid_type  The current CID type among \ref ROHC_SMALL_CID and
- *                       \ref ROHC_LARGE_CID
- * @return               true if the CID type was successfully retrieved,
- *                       false otherwise
+ * A context goes back to FO state once it stayed in SO state for the FO
+ * timeout, and to IR state once it stayed in FO or SO states for the IR
+ * timeout. The refreshes happen on the first packet of the context after the
+ * timeout. The timeouts of every context are shortened by up to one eighth
+ * depending on its CID, so that the contexts created together do not send
+ * their refreshes together.
+ *
+ * The time-based refreshes add to the refreshes based on the number of
+ * packets set by \ref rohc_comp_set_periodic_refreshes: the first timeout
+ * reached triggers the refresh. The time-based refreshes are disabled by
+ * default. Set both timeouts to 0 to disable them.
+ *
+ * @warning The values can not be modified after library initialization
+ *
+ * @param comp        The ROHC compressor
+ * @param ir_timeout  The duration (in milliseconds) before going back to IR
+ *                    state to force a context refresh
+ * @param fo_timeout  The duration (in milliseconds) before going back to FO
+ *                    state to force a context refresh
+ * @return            true in case of success, false in case of failure
  *
  * @ingroup rohc_comp
+ *
+ * @see rohc_comp_set_periodic_refreshes
  */
-bool rohc_comp_get_cid_type(const struct rohc_comp *const comp,
-                            rohc_cid_type_t *const cid_type)
+bool rohc_comp_set_periodic_refreshes_time(struct rohc_comp *const comp,
+                                           const uint64_t ir_timeout,
+                                           const uint64_t fo_timeout)
 {
-	if(comp == NULL || cid_type == NULL)
+	/* we need a valid compressor, positive non-zero timeouts,
+	 * and IR timeout > FO timeout, or both timeouts disabled */
+	if(comp == NULL)
 	{
-		goto error;
+		return false;
+	}
+	if((ir_timeout != 0 || fo_timeout != 0) &&
+	   (ir_timeout == 0 || fo_timeout == 0 || ir_timeout <= fo_timeout))
+	{
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL, "invalid "
+		             "time-based timeouts for context periodic refreshes (IR "
+		             "timeout = %" PRIu64 " ms, FO timeout = %" PRIu64 " ms)",
+		             ir_timeout, fo_timeout);
+		return false;
 	}
 
-	*cid_type = comp->medium.cid_type;
-	return true;
+	/* refuse to set values if compressor is in use */
+	if(comp->num_packets > 0)
+	{
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		             "unable to modify the time-based timeouts for periodic "
+		             "refreshes after initialization");
+		return false;
+	}
 
-error:
-	return false;
+	comp->periodic_refreshes_ir_timeout_time = ir_timeout;
+	comp->periodic_refreshes_fo_timeout_time = fo_timeout;
+
+	rohc_info(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL, "IR timeout for "
+	          "context time-based periodic refreshes set to %" PRIu64 " ms",
+	          ir_timeout);
+	rohc_info(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL, "FO timeout for "
+	          "context time-based periodic refreshes set to %" PRIu64 " ms",
+	          fo_timeout);
+
+	return true;
 }
 
 
 /**
- * @brief Enable/disable features for ROHC compressor
- *
- * Enable/disable features for ROHC compressor. Features control whether
- * mechanisms defined as optional by RFCs are enabled or not.
+ * @brief Set the bandwidth allowed for the periodic refreshes
  *
- * Available features are listed by \ref rohc_comp_features_t. They may be
- * combined by XOR'ing them together.
+ * Limit the number of bytes per second that the periodic refreshes of all
+ * the contexts may add. A refresh is allowed once the ROHC headers of the
+ * previous refreshes are paid for, otherwise it is postponed to one next
+ * packet of the context. The cost of one refresh is estimated as the ROHC
+ * header of its first packet times the minimal number of packets sent in
+ * the IR or FO state. The refreshes are thus spread over time instead of
+ * adding sudden overhead when many contexts reach their timeouts together.
  *
- * @warning Changing the feature set while library is used is not supported
+ * The bandwidth relies on the arrival times of the uncompressed packets (see
+ * the \e time member of \ref rohc_buf). The bandwidth is not limited by
+ * default. Set it to 0 to remove the limit.
  *
- * @param comp      The ROHC compressor
- * @param features  The feature set to enable/disable
- * @return          true if the feature set was successfully enabled/disabled,
- *                  false if a problem occurred
+ * @param comp        The ROHC compressor
+ * @param bytes_rate  The number of bytes per second allowed for the ROHC
+ *                    headers of the periodic refreshes, 0 for no limit
+ * @return            true in case of success, false in case of failure
  *
  * @ingroup rohc_comp
  *
- * @see rohc_comp_features_t
+ * @see rohc_comp_set_periodic_refreshes
+ * @see rohc_comp_set_periodic_refreshes_time
  */
-bool rohc_comp_set_features(struct rohc_comp *const comp,
-                            const rohc_comp_features_t features)
+bool rohc_comp_set_periodic_refreshes_rate(struct rohc_comp *const comp,
+                                           const size_t bytes_rate)
 {
-	const rohc_comp_features_t all_features =
-		ROHC_COMP_FEATURE_NO_IP_CHECKSUMS |
-		ROHC_COMP_FEATURE_DUMP_PACKETS;
-
-	/* compressor must be valid */
 	if(comp == NULL)
 	{
-		/* cannot print a trace without a valid compressor */
-		goto error;
+		return false;
 	}
 
-	/* reject unsupported features */
-	if((features & all_features) != features)
-	{
-		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-		             "feature set 0x%x is not supported (supported features "
-		             "set is 0x%x)", features, all_features);
-		goto error;
-	}
+	comp->refreshes_credit.bytes_rate = bytes_rate;
+	comp->refreshes_credit.bytes = 0;
 
-	/* record new feature set */
-	comp->features = features;
+	rohc_info(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL, "bandwidth for "
+	          "context periodic refreshes set to %zu bytes/s", bytes_rate);
 
 	return true;
-
-error:
-	return false;
 }
 
 
 /**
- * @brief Deliver a feedback packet to the compressor
+ * @brief Set the number of uncompressed transmissions for list compression
  *
- * When feedback is received by the decompressor, this function is called and
- * delivers the feedback to the right profile/context of the compressor.
+ * Set the number of transmissions required for list compression. This matches
+ * the L parameter described in RFC 3095 and 4815. The compressor sends the
+ * list items uncompressed L times before compressing them. The compressor
+ * also sends the list structure L times before compressing it out.
  *
- * @param comp   The ROHC compressor
- * @param packet The feedback data
- * @param size   The length of the feedback packet
- * @return       true if the feedback was successfully taken into account,
- *               false if the feedback could not be taken into account
+ * The L parameter is set to \ref ROHC_LIST_DEFAULT_L by default.
+ *
+ * @warning The value can not be modified after library initialization
+ *
+ * @param comp           The ROHC compressor
+ * @param list_trans_nr  The number of times the list items or the list itself
+ *                       are sent uncompressed before being sent compressed
+ * @return               true if the new value is accepted,
+ *                       false if the value is rejected
+ *
+ * @ingroup rohc_comp
  */
-static bool __rohc_comp_deliver_feedback(struct rohc_comp *const comp,
-                                         const uint8_t *const packet,
-                                         const size_t size)
+bool rohc_comp_set_list_trans_nr(struct rohc_comp *const comp,
+                                 const size_t list_trans_nr)
 {
-	struct rohc_comp_ctxt *context;
-	const uint8_t *remain_data = packet;
-	size_t remain_len = size;
-	enum rohc_feedback_type feedback_type;
-	rohc_cid_t cid;
-	size_t cid_len;
-
-	rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-	           "deliver %zu byte(s) of feedback to the right context", size);
-
-	/* extract the CID from feedback */
-	if(!rohc_comp_feedback_parse_cid(comp, remain_data, remain_len, &cid, &cid_len))
+	/* we need a valid compressor and a positive non-zero value for L */
+	if(comp == NULL)
 	{
-		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-		             "failed to deliver feedback: failed to extract CID from "
-		             "feedback");
-		goto error;
+		return false;
 	}
-	remain_data += cid_len;
-	remain_len -= cid_len;
-
-	/* find context */
-	context = c_get_context(comp, cid);
-	if(context == NULL)
+	if(list_trans_nr == 0)
 	{
-		/* context was not found */
-		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-		             "failed to deliver feedback: context with CID = %zu not found",
-		             cid);
-		goto error;
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL, "invalid "
+		             "value for uncompressed transmissions of list compression "
+		             "(%zu)", list_trans_nr);
+		return false;
 	}
-	assert(context->cid == cid);
-	assert(context->used == 1);
 
-	/* FEEDBACK-1 or FEEDBACK-2 ? */
-	if(remain_len == 0)
+	/* refuse to set values if compressor is in use */
+	if(comp->num_packets > 0)
 	{
 		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-		             "failed to deliver feedback: empty feedback data");
-		goto error;
-	}
-	else if(remain_len == 1)
-	{
-		feedback_type = ROHC_FEEDBACK_1;
-	}
-	else
-	{
-		feedback_type = ROHC_FEEDBACK_2;
+		             "unable to modify the value for uncompressed transmissions"
+		             " of list compression after initialization");
+		return false;
 	}
 
-	/* deliver feedback to profile with the context */
-	if(!context->profile->feedback(context, feedback_type, packet, size,
-	                               remain_data, remain_len))
-	{
-		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-		             "failed to deliver feedback: failed to handle FEEDBACK-%d",
-		             feedback_type);
-		goto error;
-	}
+	comp->list_trans_nr = list_trans_nr;
 
-	/* everything went fine */
-	rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-	           "FEEDBACK-%d data successfully handled", feedback_type);
+	rohc_info(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL, "uncompressed "
+	          "transmissions of list compression set to %zu", list_trans_nr);
 
 	return true;
-
-error:
-	return false;
 }
 
 
 /**
- * @brief Deliver a feedback packet to the compressor
+ * @brief Set the policy for recycling compression contexts
  *
- * When feedback data is received by a decompressor, this function may be
- * called to deliver the feedback data to the corresponding profile/context
- * on the same-side associated compressor.
+ * When a packet of a new flow is compressed while all the CIDs are in use,
+ * the ROHC compressor recycles one of its contexts for the new flow. The
+ * policy defines which context is recycled:
+ *  \li \ref ROHC_COMP_RECYCLE_LRU recycles the least recently used context,
+ *  \li \ref ROHC_COMP_RECYCLE_LFU recycles the least frequently used context,
+ *  \li \ref ROHC_COMP_RECYCLE_OLDEST recycles the context created first,
+ *  \li \ref ROHC_COMP_RECYCLE_SLRU recycles the least recently used context
+ *      among the contexts used only once, then among the contexts used
+ *      several times: the latter are protected against bursts of new flows,
+ *      up to 80% of the CIDs.
  *
- * @param comp      The ROHC compressor
- * @param feedback  The feedback data
- * @return          true if the feedback was successfully taken into account,
- *                  false if the feedback could not be taken into account
+ * The numbers of packets that found their context, of packets that required
+ * a new context, and of recycled contexts are given by
+ * \ref rohc_comp_get_general_info to compare the policies.
+ *
+ * Whatever the policy, finding an unused CID or the context to recycle does
+ * not depend on the number of contexts.
+ *
+ * The policy is set to \ref ROHC_COMP_RECYCLE_LRU by default.
+ *
+ * @warning The policy can not be modified after library initialization
+ *
+ * @param comp    The ROHC compressor
+ * @param policy  The policy for recycling contexts
+ * @return        true if the new policy is accepted,
+ *                false if the policy is rejected
  *
  * @ingroup rohc_comp
+ *
+ * @see rohc_comp_recycle_t
  */
-bool rohc_comp_deliver_feedback2(struct rohc_comp *const comp,
-                                 const struct rohc_buf feedback)
+bool rohc_comp_set_ctxts_recycling(struct rohc_comp *const comp,
+                                   const rohc_comp_recycle_t policy)
 {
-	struct rohc_buf remain_data = feedback;
-	size_t feedbacks_nr = 0;
-	size_t nr_failures = 0;
-
-	/* sanity checks */
+	/* we need a valid compressor and a known policy */
 	if(comp == NULL)
 	{
-		goto error;
+		return false;
 	}
-	if(rohc_buf_is_malformed(remain_data))
+	if(policy != ROHC_COMP_RECYCLE_LRU &&
+	   policy != ROHC_COMP_RECYCLE_LFU &&
+	   policy != ROHC_COMP_RECYCLE_OLDEST &&
+	   policy != ROHC_COMP_RECYCLE_SLRU)
 	{
-		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-		             "failed to deliver feedback: feedback is malformed");
-		goto error;
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL, "unknown "
+		             "policy for recycling contexts (%d)", policy);
+		return false;
 	}
 
-	rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-	           "deliver %zu byte(s) of feedback to the right context",
-	           remain_data.len);
-
-	/* there is nothing for compressor if feedback contains no byte at all */
-	if(rohc_buf_is_empty(remain_data))
+	/* refuse to set values if compressor is in use */
+	if(comp->num_packets > 0)
 	{
-		goto ignore;
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		             "unable to modify the policy for recycling contexts "
+		             "after initialization");
+		return false;
 	}
 
-	/* parse as much feedback data as possible */
-	while(remain_data.len > 0 &&
-	      rohc_packet_is_feedback(rohc_buf_byte(remain_data)))
-	{
-		size_t feedback_hdr_len;
-		size_t feedback_data_len;
-		size_t feedback_len;
-
-		feedbacks_nr++;
-
-		if(!rohc_feedback_get_size(remain_data, &feedback_hdr_len,
-		                           &feedback_data_len))
-		{
-			rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-			             "failed to parse a feedback item");
-			goto error;
-		}
-		feedback_len = feedback_hdr_len + feedback_data_len;
-		rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-		           "feedback found (header = %zu bytes, data = %zu bytes)",
-		           feedback_hdr_len, feedback_data_len);
-
-		/* reject feedback item if it doesn't fit in the available data */
-		if(feedback_len > remain_data.len)
-		{
-			rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-			             "the %zu-byte feedback is too large for the %zu-byte "
-			             "remaining ROHC data", feedback_len, remain_data.len);
-			goto error;
-		}
-
-		/* skip the feedback header */
-		rohc_buf_pull(&remain_data, feedback_hdr_len);
-
-		/* deliver the feedback data to the compressor */
-		if(!__rohc_comp_deliver_feedback(comp, rohc_buf_data(remain_data),
-		                                 feedback_data_len))
-		{
-			rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-			             "failed to deliver feedback item #%zu", feedbacks_nr);
-			nr_failures++;
-		}
-
-		/* skip the feedback data */
-		rohc_buf_pull(&remain_data, feedback_data_len);
-	}
+	comp->recycle_policy = policy;
 
-	return (nr_failures == 0);
+	rohc_info(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL, "policy for "
+	          "recycling contexts set to %d", policy);
 
-ignore:
 	return true;
-
-error:
-	return false;
 }
 
 
 /**
- * @brief Get some information about the last compressed packet
+ * @brief Set the admission control of new compression contexts
  *
- * Get some information about the last compressed packet.
+ * When a packet of a new flow is compressed while all the CIDs are in use,
+ * the ROHC compressor recycles one of its contexts for the new flow, see
+ * \ref rohc_comp_set_ctxts_recycling. Bursts of short-lived flows (port
+ * scans, DNS requests...) may then recycle the contexts of long-lived flows,
+ * that start over in IR state.
  *
- * To use the function, call it with a pointer on a pre-allocated
- * \ref rohc_comp_last_packet_info2_t structure with the \e version_major and
- * \e version_minor fields set to one of the following supported versions:
- *  - Major 0, minor 0
+ * With the admission control, the new contexts are on probation until they
+ * compressed \e packets_nr packets. The contexts on probation may recycle
+ * up to \e probation_max of the other contexts. Once they are
+ * \e probation_max, the contexts on probation only recycle each other, the
+ * least recently used one first. The contexts of the Uncompressed profile
+ * are cheap to rebuild, they stay on probation.
  *
- * See the \ref rohc_comp_last_packet_info2_t structure for details about
- * fields that are supported in the above versions.
+ * The contexts that leave probation are handled by the recycling policy
+ * as new contexts.
  *
- * @param comp          The ROHC compressor to get information from
- * @param[in,out] info  The structure where information will be stored
- * @return              true in case of success, false otherwise
+ * The admission control is disabled by default.
+ *
+ * @warning The admission control can not be modified after library
+ *          initialization
+ *
+ * @param comp           The ROHC compressor
+ * @param packets_nr     The number of packets a new context shall compress
+ *                       before it leaves probation, 0 to disable the
+ *                       admission control
+ * @param probation_max  The number of contexts on probation that may recycle
+ *                       the other contexts
+ * @return               true if the admission control is accepted,
+ *                       false if it is rejected
  *
  * @ingroup rohc_comp
  *
- * @see rohc_comp_last_packet_info2_t
+ * @see rohc_comp_set_ctxts_recycling
  */
-bool rohc_comp_get_last_packet_info2(const struct rohc_comp *const comp,
-                                     rohc_comp_last_packet_info2_t *const info)
+bool rohc_comp_set_admission(struct rohc_comp *const comp,
+                             const size_t packets_nr,
+                             const size_t probation_max)
 {
 	if(comp == NULL)
 	{
-		goto error;
-	}
-
-	if(comp->last_context == NULL)
-	{
-		rohc_error(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-		           "last context found in compressor is not valid");
-		goto error;
+		return false;
 	}
 
-	if(info == NULL)
+	/* refuse to set values if compressor is in use */
+	if(comp->num_packets > 0)
 	{
-		rohc_error(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-		           "structure for last packet information is not valid");
-		goto error;
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		             "unable to modify the admission control after "
+		             "initialization");
+		return false;
 	}
 
-	/* check compatibility version */
-	if(info->version_major == 0)
-	{
-		/* base fields for major version 0 */
-		info->context_id = comp->last_context->cid;
-		info->is_context_init = (comp->last_context->num_sent_packets == 1);
-		info->context_mode = comp->last_context->mode;
-		info->context_state = comp->last_context->state;
-		info->context_used = (comp->last_context->used ? true : false);
-		info->profile_id = comp->last_context->profile->id;
-		info->packet_type = comp->last_context->packet_type;
-		info->total_last_uncomp_size = comp->last_context->total_last_uncompressed_size;
-		info->header_last_uncomp_size = comp->last_context->header_last_uncompressed_size;
-		info->total_last_comp_size = comp->last_context->total_last_compressed_size;
-		info->header_last_comp_size = comp->last_context->header_last_compressed_size;
+	comp->admission_pkts_nr = packets_nr;
+	comp->probation_max = probation_max;
 
-		/* new fields added by minor versions */
-		if(info->version_minor > 0)
-		{
-			rohc_error(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-			           "unsupported minor version (%u) of the structure for "
-			           "last packet information", info->version_minor);
-			goto error;
-		}
-	}
-	else
-	{
-		rohc_error(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-		           "unsupported major version (%u) of the structure for last "
-		           "packet information", info->version_major);
-		goto error;
-	}
+	rohc_info(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL, "admission of "
+	          "contexts after %zu packets, up to %zu contexts on probation",
+	          packets_nr, probation_max);
 
 	return true;
-
-error:
-	return false;
 }
 
 
 /**
- * @brief Get some general information about the compressor
- *
- * Get some general information about the compressor.
+ * @brief Enable, resize or disable the log of the last compressed packets
  *
- * To use the function, call it with a pointer on a pre-allocated
- * \ref rohc_comp_general_info_t structure with the \e version_major and
- * \e version_minor fields set to one of the following supported versions:
- *  - Major 0, minor 0
+ * Once enabled, the compressor writes one compact binary record for every
+ * packet it compresses in a context: the CID, the profile, the ROHC packet
+ * type, the SN or MSN, the number of SN bits that W-LSB encoding required
+ * and the compression status. The log is a ring of \e records_nr records:
+ * the oldest records are overwritten by the newest ones. Writing one record
+ * costs a few stores, so the log may be left enabled when the traces are
+ * not, and retrieved with \ref rohc_comp_get_pkt_log once a problem is
+ * detected.
  *
- * See the \ref rohc_comp_general_info_t structure for details about fields
- * that are supported in the above versions.
+ * The records already in the log are dropped. The log is disabled by
+ * default.
  *
- * @param comp          The ROHC compressor to get information from
- * @param[in,out] info  The structure where information will be stored
- * @return              true in case of success, false otherwise
+ * @param comp        The ROHC compressor
+ * @param records_nr  The number of records of the log, a power of 2, or 0 to
+ *                    disable the log
+ * @return            true if the log was enabled, resized or disabled,
+ *                    false if the number of records is not a power of 2 or
+ *                    if an error occurs
  *
  * @ingroup rohc_comp
  *
- * @see rohc_comp_general_info_t
+ * @see rohc_comp_get_pkt_log
  */
-bool rohc_comp_get_general_info(const struct rohc_comp *const comp,
-                                rohc_comp_general_info_t *const info)
+bool rohc_comp_set_pkt_log(struct rohc_comp *const comp,
+                           const size_t records_nr)
 {
 	if(comp == NULL)
 	{
 		goto error;
 	}
 
-	if(info == NULL)
+	if(!rohc_pkt_log_set_size(&comp->pkt_log, records_nr))
 	{
-		rohc_error(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-		           "structure for general information is not valid");
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		             "failed to set a log of %zu packets: the number of "
+		             "records shall be a power of 2", records_nr);
 		goto error;
 	}
 
-	/* check compatibility version */
-	if(info->version_major == 0)
-	{
-		/* base fields for major version 0 */
-		info->contexts_nr = comp->num_contexts_used;
-		info->packets_nr = comp->num_packets;
-		info->uncomp_bytes_nr = comp->total_uncompressed_size;
-		info->comp_bytes_nr = comp->total_compressed_size;
-
-		/* new fields added by minor versions */
-		if(info->version_minor > 0)
-		{
-			rohc_error(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-			           "unsupported minor version (%u) of the structure for "
-			           "general information", info->version_minor);
-			goto error;
-		}
-	}
-	else
-	{
-		rohc_error(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-		           "unsupported major version (%u) of the structure for "
-		           "general information", info->version_major);
-		goto error;
-	}
+	rohc_info(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+	          "log of the last %zu packets", records_nr);
 
 	return true;
 
@@ -2128,413 +2763,474 @@ error:
 
 
 /**
- * @brief Give a description for the given ROHC compression context state
+ * @brief Set the RTP detection callback function
  *
- * Give a description for the given ROHC compression context state.
+ * Set or replace the callback function that the ROHC library will call to
+ * detect RTP streams among other UDP streams.
  *
- * The descriptions are not part of the API. They may change between
- * releases without any warning. Do NOT use them for other means that
- * providing to users a textual description of compression context states
- * used by the library. If unsure, ask on the mailing list.
+ * The function is called once per UDP packet to compress, with the IP and
+ * UDP headers and the UDP payload. If the callback function returns true, the
+ * RTP profile is used for compression, otherwise the IP/UDP profile is used
+ * instead.
  *
- * @param state  The compression context state to get a description for
- * @return       A string that describes the given compression context state
+ * The callback is only called for the UDP packets that the built-in detection
+ * did not classify as RTP, see \ref rohc_comp_add_rtp_port. Special value NULL
+ * may be used to disable the detection of RTP streams with the callback
+ * method. The detection will then be based on the list of UDP ports dedicated
+ * for RTP streams only.
+ *
+ * @param comp        The ROHC compressor
+ * @param callback    The callback function used to detect RTP packets
+ *                    The callback is deactivated if NULL is given as parameter
+ * @param rtp_private A pointer to an external memory area
+ *                    provided and used by the callback user
+ * @return            true on success, false otherwise
  *
  * @ingroup rohc_comp
+ *
+ * \par Example:
+ * \snippet rtp_detection.c define RTP detection callback
+ * \code
+        ...
+\endcode
+ * \snippet simple_rohc_program.c define ROHC compressor
+ * \code
+        ...
+\endcode
+ * \snippet simple_rohc_program.c create ROHC compressor
+ * \code
+        ...
+\endcode
+ * \snippet rtp_detection.c set RTP detection callback
+ * \code
+        ...
+\endcode
+ * \snippet simple_rohc_program.c destroy ROHC compressor
+ *
+ * @see rohc_rtp_detection_callback_t
+ * @see rohc_comp_add_rtp_port
+ * @see rohc_comp_remove_rtp_port
+ * @see rohc_comp_reset_rtp_ports
+ * @see rohc_comp_set_rtp_payload_type
  */
-const char * rohc_comp_get_state_descr(const rohc_comp_state_t state)
+bool rohc_comp_set_rtp_detection_cb(struct rohc_comp *const comp,
+                                    rohc_rtp_detection_callback_t callback,
+                                    void *const rtp_private)
 {
-	switch(state)
+	/* sanity check on compressor */
+	if(comp == NULL)
 	{
-		case ROHC_COMP_STATE_IR:
-			return "IR";
-		case ROHC_COMP_STATE_FO:
-			return "FO";
-		case ROHC_COMP_STATE_SO:
-			return "SO";
-		case ROHC_COMP_STATE_UNKNOWN:
-		default:
-			return "no description";
+		return false;
 	}
-}
 
+	/* set RTP detection callback */
+	comp->rtp_callback = callback;
+	comp->rtp_private = rtp_private;
+
+	/* RTP streams might now be detected differently */
+	c_classif_cache_flush(comp);
 
-/*
- * Definitions of private functions
- */
+	return true;
+}
 
 
 /**
- * @brief Find out a ROHC profile given a profile ID
+ * @brief Add a UDP port to the list of UDP ports dedicated to RTP streams
  *
- * @param comp       The ROHC compressor
- * @param profile_id The ID of the ROHC profile to find out
- * @return           The ROHC profile if found, NULL otherwise
+ * The UDP packets sent from or to one of the dedicated UDP ports are
+ * compressed with the RTP profile if their UDP payload looks like a RTP
+ * header: RTP version 2 and a Payload Type accepted with
+ * \ref rohc_comp_set_rtp_payload_type (all by default).
+ *
+ * The built-in detection does not call any function of the application, it
+ * is tried before the RTP detection callback: the callback is only called
+ * for the UDP packets that the built-in detection did not classify as RTP.
+ *
+ * No UDP port is dedicated to RTP streams by default.
+ *
+ * @param comp  The ROHC compressor
+ * @param port  The UDP port to add in the list (in host byte order)
+ * @return      true on success, false otherwise
+ *
+ * @ingroup rohc_comp
+ *
+ * @see rohc_comp_remove_rtp_port
+ * @see rohc_comp_reset_rtp_ports
+ * @see rohc_comp_set_rtp_payload_type
+ * @see rohc_comp_set_rtp_detection_cb
  */
-static const struct rohc_comp_profile *
-	rohc_get_profile_from_id(const struct rohc_comp *comp,
-	                         const rohc_profile_t profile_id)
+bool rohc_comp_add_rtp_port(struct rohc_comp *const comp,
+                            const uint16_t port)
 {
-	size_t i;
+	if(comp == NULL)
+	{
+		goto error;
+	}
 
-	/* test all compression profiles */
-	for(i = 0; i < C_NUM_PROFILES; i++)
+	/* the bitmap of the UDP ports is allocated with the first port */
+	if(comp->rtp_ports == NULL)
 	{
-		/* if the profile IDs match and the profile is enabled */
-		if(rohc_comp_profiles[i]->id == profile_id && comp->enabled_profiles[i])
+		comp->rtp_ports =
+			rohc_calloc(ROHC_BITMAP_WORDS_NR(ROHC_COMP_RTP_PORTS_NR),
+			            sizeof(uint64_t));
+		if(comp->rtp_ports == NULL)
 		{
-			return rohc_comp_profiles[i];
+			rohc_error(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+			           "failed to allocate memory for the list of RTP ports");
+			goto error;
 		}
 	}
 
-	return NULL;
+	if(!rohc_bitmap_test(comp->rtp_ports, port))
+	{
+		rohc_bitmap_set(comp->rtp_ports, port);
+		comp->rtp_ports_nr++;
+
+		/* RTP streams might now be detected differently */
+		c_classif_cache_flush(comp);
+	}
+
+	rohc_info(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+	          "UDP port %u dedicated to RTP streams (%zu ports)", port,
+	          comp->rtp_ports_nr);
+
+	return true;
+
+error:
+	return false;
 }
 
 
 /**
- * @brief Find out a ROHC profile given an IP protocol ID
+ * @brief Remove a UDP port from the list of UDP ports dedicated to RTP streams
  *
- * @param comp    The ROHC compressor
- * @param packet  The packet to find a compression profile for
- * @return        The ROHC profile if found, NULL otherwise
+ * @param comp  The ROHC compressor
+ * @param port  The UDP port to remove from the list (in host byte order)
+ * @return      true on success, false if the port was not in the list
+ *
+ * @ingroup rohc_comp
+ *
+ * @see rohc_comp_add_rtp_port
+ * @see rohc_comp_reset_rtp_ports
  */
-static const struct rohc_comp_profile *
-	c_get_profile_from_packet(const struct rohc_comp *const comp,
-	                          const struct net_pkt *const packet)
+bool rohc_comp_remove_rtp_port(struct rohc_comp *const comp,
+                               const uint16_t port)
 {
-	size_t i;
-
-	rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-	           "try to find the best profile for packet with transport "
-	           "protocol %u", packet->transport->proto);
-
-	/* test all compression profiles */
-	for(i = 0; i < C_NUM_PROFILES; i++)
+	if(comp == NULL || comp->rtp_ports == NULL ||
+	   !rohc_bitmap_test(comp->rtp_ports, port))
 	{
-		bool check_profile;
+		goto error;
+	}
 
-		/* skip profile if the profile is not enabled */
-		if(!comp->enabled_profiles[i])
-		{
-			rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-			           "skip disabled profile '%s' (0x%04x)",
-			           rohc_get_profile_descr(rohc_comp_profiles[i]->id),
-			           rohc_comp_profiles[i]->id);
-			continue;
-		}
+	rohc_bitmap_clear(comp->rtp_ports, port);
+	assert(comp->rtp_ports_nr > 0);
+	comp->rtp_ports_nr--;
 
-		/* does the profile accept the packet? */
-		check_profile = rohc_comp_profiles[i]->check_profile(comp, packet);
-		if(!check_profile)
-		{
-			rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-			           "skip profile '%s' (0x%04x) because it does not match "
-			           "packet",rohc_get_profile_descr(rohc_comp_profiles[i]->id),
-			           rohc_comp_profiles[i]->id);
-			continue;
-		}
+	/* RTP streams might now be detected differently */
+	c_classif_cache_flush(comp);
 
-		/* the packet is compatible with the profile, let's go with it! */
-		return rohc_comp_profiles[i];
-	}
+	rohc_info(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+	          "UDP port %u no longer dedicated to RTP streams (%zu ports)",
+	          port, comp->rtp_ports_nr);
 
-	return NULL;
+	return true;
+
+error:
+	return false;
 }
 
 
 /**
- * @brief Create a compression context
+ * @brief Remove all the UDP ports dedicated to RTP streams
  *
- * @param comp          The ROHC compressor
- * @param profile       The profile to associate the context with
- * @param packet        The packet to create a compression context for
- * @param arrival_time  The time at which packet was received (0 if unknown,
- *                      or to disable time-related features in ROHC protocol)
- * @return              The compression context if successful, NULL otherwise
+ * @param comp  The ROHC compressor
+ * @return      true on success, false otherwise
+ *
+ * @ingroup rohc_comp
+ *
+ * @see rohc_comp_add_rtp_port
+ * @see rohc_comp_remove_rtp_port
  */
-static struct rohc_comp_ctxt *
-	c_create_context(struct rohc_comp *const comp,
-	                 const struct rohc_comp_profile *const profile,
-	                 const struct net_pkt *const packet,
-	                 const struct rohc_ts arrival_time)
+bool rohc_comp_reset_rtp_ports(struct rohc_comp *const comp)
 {
-	struct rohc_comp_ctxt *c;
-	rohc_cid_t cid_to_use;
+	if(comp == NULL)
+	{
+		return false;
+	}
 
-	assert(comp != NULL);
-	assert(profile != NULL);
-	assert(packet != NULL);
+	if(comp->rtp_ports != NULL)
+	{
+		memset(comp->rtp_ports, 0,
+		       ROHC_BITMAP_WORDS_NR(ROHC_COMP_RTP_PORTS_NR) * sizeof(uint64_t));
+	}
+	comp->rtp_ports_nr = 0;
 
-	cid_to_use = 0;
+	/* RTP streams might now be detected differently */
+	c_classif_cache_flush(comp);
 
-	/* if all the contexts in the array are used:
-	 *   => recycle the oldest context to make room
-	 * if at least one context in the array is not used:
-	 *   => pick the first unused context
-	 */
-	if(comp->num_contexts_used > comp->medium.max_cid)
-	{
-		/* all the contexts in the array were used, recycle the oldest context
-		 * to make some room */
+	rohc_info(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+	          "no more UDP port dedicated to RTP streams");
 
-		uint64_t oldest;
-		rohc_cid_t i;
+	return true;
+}
 
-		/* find the oldest context */
-		oldest = 0xffffffff;
-		for(i = 0; i <= comp->medium.max_cid; i++)
-		{
-			if(comp->contexts[i].latest_used < oldest)
-			{
-				oldest = comp->contexts[i].latest_used;
-				cid_to_use = i;
-			}
-		}
 
-		/* destroy the oldest context before replacing it with a new one */
-		rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-		           "recycle oldest context (CID = %zu)", cid_to_use);
-		comp->contexts[cid_to_use].profile->destroy(&comp->contexts[cid_to_use]);
-		comp->contexts[cid_to_use].key = 0; /* reset context key */
-		comp->contexts[cid_to_use].used = 0;
-		assert(comp->num_contexts_used > 0);
-		comp->num_contexts_used--;
+/**
+ * @brief Accept or refuse one RTP Payload Type on the RTP ports
+ *
+ * The UDP packets sent from or to one of the UDP ports dedicated to RTP
+ * streams are compressed with the RTP profile only if the Payload Type of
+ * their RTP header is accepted. All the Payload Types are accepted by
+ * default. Refusing some of them is useful when other protocols share the
+ * UDP ports with RTP, eg. RTCP (Payload Types 72 to 76 with the marker bit).
+ *
+ * @param comp     The ROHC compressor
+ * @param pt        The RTP Payload Type in range [0, 127]
+ * @param accepted  Whether the RTP Payload Type is accepted or not
+ * @return          true on success, false otherwise
+ *
+ * @ingroup rohc_comp
+ *
+ * @see rohc_comp_add_rtp_port
+ */
+bool rohc_comp_set_rtp_payload_type(struct rohc_comp *const comp,
+                                    const uint8_t pt,
+                                    const bool accepted)
+{
+	if(comp == NULL || pt >= ROHC_COMP_RTP_PTS_NR)
+	{
+		return false;
+	}
+
+	if(accepted)
+	{
+		rohc_bitmap_set(comp->rtp_pts, pt);
 	}
 	else
 	{
-		/* there was at least one unused context in the array, pick the first
-		 * unused context in the context array */
-
-		rohc_cid_t i;
+		rohc_bitmap_clear(comp->rtp_pts, pt);
+	}
 
-		/* find the first unused context */
-		for(i = 0; i <= comp->medium.max_cid; i++)
-		{
-			if(comp->contexts[i].used == 0)
-			{
-				cid_to_use = i;
-				break;
-			}
-		}
+	/* RTP streams might now be detected differently */
+	c_classif_cache_flush(comp);
 
-		rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-		           "take the first unused context (CID = %zu)", cid_to_use);
-	}
+	return true;
+}
 
-	/* initialize the previously found context */
-	c = &comp->contexts[cid_to_use];
 
-	c->ir_count = 0;
-	c->fo_count = 0;
-	c->so_count = 0;
-	c->go_back_fo_count = 0;
-	c->go_back_ir_count = 0;
+/**
+ * @brief Set the callback for the events of the lifecycle of the contexts
+ *
+ * The callback is called when one compression context is created, recycled,
+ * or changes of state or mode, see \ref rohc_comp_event_t. It is called only
+ * when the events happen: the packets that change nothing do not pay for it,
+ * unlike the polling of \ref rohc_comp_get_last_packet_info2 after every
+ * packet.
+ *
+ * @param comp       The ROHC compressor
+ * @param callback   The callback for the events, NULL to disable it
+ * @param priv_ctxt  An optional private context given to the callback,
+ *                   may be NULL
+ * @return           true on success, false if the compressor is invalid
+ *
+ * @ingroup rohc_comp
+ *
+ * @see rohc_comp_event_callback_t
+ */
+bool rohc_comp_set_event_cb(struct rohc_comp *const comp,
+                            rohc_comp_event_callback_t callback,
+                            void *const priv_ctxt)
+{
+	if(comp == NULL)
+	{
+		return false;
+	}
 
-	c->total_uncompressed_size = 0;
-	c->total_compressed_size = 0;
-	c->header_uncompressed_size = 0;
-	c->header_compressed_size = 0;
+	comp->event_cb = callback;
+	comp->event_cb_priv = priv_ctxt;
 
-	c->total_last_uncompressed_size = 0;
-	c->total_last_compressed_size = 0;
-	c->header_last_uncompressed_size = 0;
-	c->header_last_compressed_size = 0;
+	return true;
+}
 
-	c->num_sent_packets = 0;
 
-	c->cid = cid_to_use;
-	c->profile = profile;
-	c->key = packet->key;
+/**
+ * @brief Is the given compression profile enabled for a compressor?
+ *
+ * Is the given compression profile enabled or disabled for a compressor?
+ *
+ * @param comp     The ROHC compressor
+ * @param profile  The profile to ask status for
+ * @return         Possible return values:
+ *                  \li true if the profile exists and is enabled,
+ *                  \li false if the compressor is not valid, the profile
+ *                      does not exist, or the profile is disabled
+ *
+ * @ingroup rohc_comp
+ *
+ * @see rohc_comp_enable_profile
+ * @see rohc_comp_enable_profiles
+ * @see rohc_comp_disable_profile
+ * @see rohc_comp_disable_profiles
+ */
+bool rohc_comp_profile_enabled(const struct rohc_comp *const comp,
+                               const rohc_profile_t profile)
+{
+	size_t i;
 
-	c->mode = ROHC_U_MODE;
-	c->state = ROHC_COMP_STATE_IR;
+	if(comp == NULL)
+	{
+		goto error;
+	}
 
-	c->compressor = comp;
+	/* search the profile location */
+	i = rohc_comp_profile_idx(profile);
 
-	/* create profile-specific context */
-	if(!profile->create(c, packet))
+	if(i == C_NUM_PROFILES)
 	{
-		return NULL;
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		             "unknown ROHC compression profile (ID = %d)", profile);
+		goto error;
 	}
 
-	/* if creation is successful, mark the context as used */
-	c->used = 1;
-	c->first_used = arrival_time.sec;
-	c->latest_used = arrival_time.sec;
-	assert(comp->num_contexts_used <= comp->medium.max_cid);
-	comp->num_contexts_used++;
+	/* return profile status */
+	return comp->enabled_profiles[i];
 
-	rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-	           "context (CID = %zu) created (num_used = %zu)",
-	           c->cid, comp->num_contexts_used);
-	return c;
+error:
+	return false;
 }
 
 
 /**
- * @brief Find a compression context given an IP packet
+ * @brief Enable a compression profile for a compressor
  *
- * @param comp             The ROHC compressor
- * @param packet           The packet to find a compression context for
- * @param profile_id_hint  If positive, indicate the profile to use
- * @param arrival_time     The time at which packet was received
- *                         (0 if unknown, or to disable time-related features
- *                          in the ROHC protocol)
- * @return                 The context if found or successfully created,
- *                         NULL if not found
+ * Enable a compression profiles for a compressor.
+ *
+ * The ROHC compressor does not use the compression profiles that are not
+ * enabled. Thus not enabling a profile might affect compression performances.
+ * Compression will fail if no profile at all is enabled.
+ *
+ * If the profile is already enabled, nothing is performed and success is
+ * reported.
+ *
+ * The ROHCv1 and ROHCv2 variants of one profile cannot be enabled at the
+ * same time: the IR packets carry the 8 LSB of the profile ID only, so the
+ * decompressor could not tell them apart.
+ *
+ * @param comp     The ROHC compressor
+ * @param profile  The profile to enable
+ * @return         true if the profile exists,
+ *                 false if the profile does not exist or if the other
+ *                 variant of the profile is already enabled
+ *
+ * @ingroup rohc_comp
+ *
+ * \par Example:
+ * \snippet simple_rohc_program.c define ROHC compressor
+ * \code
+        ...
+\endcode
+ * \snippet simple_rohc_program.c enable ROHC compression profile
+ * \code
+        ...
+\endcode
+ *
+ * @see rohc_comp_enable_profiles
+ * @see rohc_comp_disable_profile
+ * @see rohc_comp_disable_profiles
  */
-static struct rohc_comp_ctxt *
-	rohc_comp_find_ctxt(struct rohc_comp *const comp,
-	                    const struct net_pkt *const packet,
-	                    const int profile_id_hint,
-	                    const struct rohc_ts arrival_time)
+bool rohc_comp_enable_profile(struct rohc_comp *const comp,
+                              const rohc_profile_t profile)
 {
-	const struct rohc_comp_profile *profile;
-	struct rohc_comp_ctxt *context;
-	size_t num_used_ctxt_seen = 0;
-	rohc_cid_t i;
+	size_t other_i;
+	size_t i;
 
-	/* use the suggested profile if any, otherwise find the best profile for
-	 * the packet */
-	if(profile_id_hint < 0)
-	{
-		profile = c_get_profile_from_packet(comp, packet);
-	}
-	else
-	{
-		profile = rohc_get_profile_from_id(comp, profile_id_hint);
-	}
-	if(profile == NULL)
+	if(comp == NULL)
 	{
-		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-		             "no profile found for packet, giving up");
-		goto not_found;
+		goto error;
 	}
-	rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-	           "using profile '%s' (0x%04x)",
-	           rohc_get_profile_descr(profile->id), profile->id);
-
-	/* get the context using help from the profile we just found */
-	for(i = 0; i <= comp->medium.max_cid; i++)
-	{
-		context = &comp->contexts[i];
-
-		/* don't even look at unused contexts */
-		if(!context->used)
-		{
-			continue;
-		}
-		num_used_ctxt_seen++;
-
-		/* don't look at contexts with the wrong profile */
-		if(context->profile->id != profile->id)
-		{
-			continue;
-		}
-
-		/* don't look at contexts with the wrong key */
-		if(packet->key != context->key)
-		{
-			continue;
-		}
 
-		/* ask the profile whether the packet matches the context */
-		if(context->profile->check_context(context, packet))
-		{
-			rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-			           "using context CID = %zu", context->cid);
-			break;
-		}
+	/* search the profile location */
+	i = rohc_comp_profile_idx(profile);
 
-		/* if all used contexts were checked, no need go search further */
-		if(num_used_ctxt_seen >= comp->num_contexts_used)
-		{
-			rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-			           "no context was found");
-			context = NULL;
-			break;
-		}
-	}
-	if(context == NULL || i > comp->medium.max_cid)
-	{
-		/* context not found, create a new one */
-		rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-		           "no existing context found for packet, create a new one");
-		context = c_create_context(comp, profile, packet, arrival_time);
-		if(context == NULL)
-		{
-			rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-			             "failed to create a new context");
-			goto not_found;
-		}
-	}
-	else
+	if(i == C_NUM_PROFILES)
 	{
-		/* matching context found, update use timestamp */
-		context->latest_used = arrival_time.sec;
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		             "unknown ROHC compression profile (ID = %d)", profile);
+		goto error;
 	}
 
-	return context;
-
-not_found:
-	return NULL;
-}
-
-
-/**
- * @brief Find out a context given its CID
- *
- * @param comp The ROHC compressor
- * @param cid  The CID of the context to find
- * @return     The context with the given CID if found, NULL otherwise
- */
-static struct rohc_comp_ctxt *
-	c_get_context(struct rohc_comp *const comp, const rohc_cid_t cid)
-{
-	/* the CID must not be larger than the context array */
-	if(cid > comp->medium.max_cid)
+	/* the other ROHC version of the profile shall not be enabled */
+	other_i = rohc_comp_profile_idx(profile ^ 0x0100);
+	if(other_i < C_NUM_PROFILES && comp->enabled_profiles[other_i])
 	{
-		goto not_found;
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		             "ROHC compression profile (ID = %d) cannot be enabled "
+		             "along with profile (ID = %d)", profile, profile ^ 0x0100);
+		goto error;
 	}
 
-	/* the context with the given CID must be in use */
-	if(comp->contexts[cid].used == 0)
-	{
-		goto not_found;
-	}
+	/* mark the profile as enabled */
+	comp->enabled_profiles[i] = true;
+	c_classif_cache_flush(comp);
+	rohc_info(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+	          "ROHC compression profile (ID = %d) enabled", profile);
 
-	return &(comp->contexts[cid]);
+	return true;
 
-not_found:
-	return NULL;
+error:
+	return false;
 }
 
 
 /**
- * @brief Create the array of compression contexts
+ * @brief Disable a compression profile for a compressor
  *
- * @param comp The ROHC compressor
- * @return     true if the creation is successful, false otherwise
+ * Disable a compression profile for a compressor.
+ *
+ * The ROHC compressor does not use the compression profiles that were
+ * disabled. Thus disabling a profile might affect compression performances.
+ * Compression will fail if no profile at all is enabled.
+ *
+ * If the profile is already disabled, nothing is performed and success is
+ * reported.
+ *
+ * @param comp     The ROHC compressor
+ * @param profile  The profile to disable
+ * @return         true if the profile exists,
+ *                 false if the profile does not exist
+ *
+ * @ingroup rohc_comp
+ *
+ * @see rohc_comp_enable_profile
+ * @see rohc_comp_enable_profiles
+ * @see rohc_comp_disable_profiles
  */
-static bool c_create_contexts(struct rohc_comp *const comp)
+bool rohc_comp_disable_profile(struct rohc_comp *const comp,
+                               const rohc_profile_t profile)
 {
-	assert(comp->contexts == NULL);
+	size_t i;
 
-	comp->num_contexts_used = 0;
+	if(comp == NULL)
+	{
+		goto error;
+	}
 
-	rohc_info(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-	          "create enough room for %zu contexts (MAX_CID = %zu)",
-	          comp->medium.max_cid + 1, comp->medium.max_cid);
+	/* search the profile location */
+	i = rohc_comp_profile_idx(profile);
 
-	comp->contexts = calloc(comp->medium.max_cid + 1,
-	                        sizeof(struct rohc_comp_ctxt));
-	if(comp->contexts == NULL)
+	if(i == C_NUM_PROFILES)
 	{
-		rohc_error(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-		           "cannot allocate memory for contexts");
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		             "unknown ROHC compression profile (ID = %d)", profile);
 		goto error;
 	}
 
+	/* mark the profile as disabled */
+	comp->enabled_profiles[i] = false;
+	c_classif_cache_flush(comp);
+	rohc_info(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+	          "ROHC compression profile (ID = %d) disabled", profile);
+
 	return true;
 
 error:
@@ -2543,220 +3239,230 @@ error:
 
 
 /**
- * @brief Destroy all the compression contexts in the context array
+ * @brief Enable several compression profiles for a compressor
  *
- * The profile-specific contexts are also destroyed.
+ * Enable several compression profiles for a compressor. The list of profiles
+ * to enable shall stop with -1.
  *
- * @param comp The ROHC compressor
+ * The ROHC compressor does not use the compression profiles that are not
+ * enabled. Thus not enabling a profile might affect compression performances.
+ * Compression will fail if no profile at all is enabled.
+ *
+ * If one or more of the profiles are already enabled, nothing is performed
+ * and success is reported.
+ *
+ * @param comp  The ROHC compressor
+ * @param ...   The sequence of compression profiles to enable, the sequence
+ *              shall be terminated by -1
+ * @return      true if all of the profiles exist,
+ *              false if at least one of the profiles does not exist
+ *
+ * @ingroup rohc_comp
+ *
+ * \par Example:
+ * \snippet simple_rohc_program.c define ROHC compressor
+ * \code
+        ...
+\endcode
+ * \snippet simple_rohc_program.c enable ROHC compression profiles
+ * \code
+        ...
+\endcode
+ *
+ * @see rohc_comp_enable_profile
+ * @see rohc_comp_disable_profile
+ * @see rohc_comp_disable_profiles
  */
-static void c_destroy_contexts(struct rohc_comp *const comp)
+bool rohc_comp_enable_profiles(struct rohc_comp *const comp,
+                               ...)
 {
-	rohc_cid_t i;
-
-	assert(comp->contexts != NULL);
+	va_list profiles;
+	int profile_id;
+	size_t err_nr = 0;
+	bool is_ok;
 
-	for(i = 0; i <= comp->medium.max_cid; i++)
+	if(comp == NULL)
 	{
-		if(comp->contexts[i].used && comp->contexts[i].profile != NULL)
-		{
-			comp->contexts[i].profile->destroy(&comp->contexts[i]);
-		}
+		goto error;
+	}
 
-		if(comp->contexts[i].used)
+	va_start(profiles, comp);
+
+	while((profile_id = va_arg(profiles, int)) >= 0)
+	{
+		is_ok = rohc_comp_enable_profile(comp, profile_id);
+		if(!is_ok)
 		{
-			comp->contexts[i].used = 0;
-			assert(comp->num_contexts_used > 0);
-			comp->num_contexts_used--;
+			err_nr++;
 		}
 	}
-	assert(comp->num_contexts_used == 0);
 
-	free(comp->contexts);
-	comp->contexts = NULL;
+	va_end(profiles);
+
+	return (err_nr == 0);
+
+error:
+	return false;
 }
 
 
 /**
- * @brief Change the mode of the context.
+ * @brief Disable several compression profiles for a compressor
  *
- * @param context  The compression context
- * @param new_mode The new mode the context must enter in
- */
-void rohc_comp_change_mode(struct rohc_comp_ctxt *const context,
-                           const rohc_mode_t new_mode)
+ * Disable several compression profiles for a compressor. The list of profiles
+ * to disable shall stop with -1.
+ *
+ * The ROHC compressor does not use the compression profiles that were
+ * disabled. Thus disabling a profile might affect compression performances.
+ * Compression will fail if no profile at all is enabled.
+ *
+ * If one or more of the profiles are already disabled, nothing is performed
+ * and success is reported.
+ *
+ * @param comp  The ROHC compressor
+ * @param ...   The sequence of compression profiles to disable, the sequence
+ *              shall be terminated by -1
+ * @return      true if all of the profiles exist,
+ *              false if at least one of the profiles does not exist
+ *
+ * @ingroup rohc_comp
+ *
+ * @see rohc_comp_enable_profile
+ * @see rohc_comp_enable_profiles
+ * @see rohc_comp_disable_profile
+ */
+bool rohc_comp_disable_profiles(struct rohc_comp *const comp,
+                                ...)
 {
-	if(context->mode != new_mode)
-	{
-		/* TODO: R-mode is not yet supported */
-		if(new_mode == ROHC_R_MODE)
-		{
-			rohc_comp_warn(context, "ignore change to R-mode because R-mode is "
-			               "not supported yet");
-			return;
-		}
-		/* TODO: downward transition to U-mode is not yet supported */
-		if(new_mode == ROHC_U_MODE)
-		{
-			rohc_comp_warn(context, "ignore change to U-mode because such a "
-			               "transition is not supported yet");
-			return;
-		}
+	va_list profiles;
+	int profile_id;
+	size_t err_nr = 0;
+	bool is_ok;
 
-		/* change mode and go back to IR state */
-		rohc_info(context->compressor, ROHC_TRACE_COMP, context->profile->id,
-		          "CID %zu: change from mode %d to mode %d",
-		          context->cid, context->mode, new_mode);
-		context->mode = new_mode;
-		rohc_comp_change_state(context, ROHC_COMP_STATE_IR);
+	if(comp == NULL)
+	{
+		goto error;
 	}
-}
 
+	va_start(profiles, comp);
 
-/**
- * @brief Change the state of the context.
- *
- * @param context   The compression context
- * @param new_state The new state the context must enter in
- */
-void rohc_comp_change_state(struct rohc_comp_ctxt *const context,
-                            const rohc_comp_state_t new_state)
-{
-	if(new_state != context->state)
+	while((profile_id = va_arg(profiles, int)) >= 0)
 	{
-		rohc_info(context->compressor, ROHC_TRACE_COMP, context->profile->id,
-		          "CID %zu: change from state %d to state %d",
-		          context->cid, context->state, new_state);
+		is_ok = rohc_comp_disable_profile(comp, profile_id);
+		if(!is_ok)
+		{
+			err_nr++;
+		}
+	}
 
-		/* reset counters */
-		context->ir_count = 0;
-		context->fo_count = 0;
-		context->so_count = 0;
+	va_end(profiles);
 
-		/* change state */
-		context->state = new_state;
-	}
+	return (err_nr == 0);
+
+error:
+	return false;
 }
 
 
 /**
- * @brief Periodically change the context state after a certain number
- *        of packets.
+ * @brief Set the Maximum Reconstructed Reception Unit (MRRU).
  *
- * @param context The compression context
+ * Set the Maximum Reconstructed Reception Unit (MRRU).
+ *
+ * The MRRU is the largest cumulative length (in bytes) of the ROHC segments
+ * that are parts of the same ROHC packet. In short, the ROHC decompressor
+ * does not expect to reassemble ROHC segments whose total length is larger
+ * than MRRU. So, the ROHC compressor shall not segment ROHC packets greater
+ * than the MRRU.
+ *
+ * The MRRU value must be in range [0 ; \ref ROHC_MAX_MRRU]. Remember that the
+ * MRRU includes the 32-bit CRC that protects it.
+ * If set to 0, segmentation is disabled as no segment headers are allowed
+ * on the channel. No segment will be generated.
+ *
+ * If segmentation is enabled and used by the compressor, the function
+ * \ref rohc_comp_get_segment2 can be used to retrieve ROHC segments.
+ *
+ * The buffer that stores the RRU is MRRU bytes long. It is allocated when
+ * segmentation is enabled, and freed when segmentation is disabled. The MRRU
+ * cannot be reduced below the length of the RRU whose segments were not
+ * retrieved yet.
+ *
+ * @param comp  The ROHC compressor
+ * @param mrru  The new MRRU value (in bytes)
+ * @return      true if the MRRU was successfully set, false otherwise
+ *
+ * @ingroup rohc_comp
+ *
+ * \par Example:
+ * \snippet test_segment.c define ROHC compressor
+ * \code
+        size_t mrru = 500;
+        ...
+\endcode
+ * \snippet test_segment.c set compressor MRRU
+ * \code
+        ...
+\endcode
+ *
+ * @see rohc_comp_get_mrru
+ * @see rohc_comp_get_segment2
+ * @see rohc_decomp_set_mrru
  */
-void rohc_comp_periodic_down_transition(struct rohc_comp_ctxt *const context)
+bool rohc_comp_set_mrru(struct rohc_comp *const comp,
+                        const size_t mrru)
 {
-	rohc_debug(context->compressor, ROHC_TRACE_COMP, context->profile->id,
-	           "CID %zu: timeouts for periodic refreshes: FO = %zu / %zu, "
-	           "IR = %zu / %zu", context->cid, context->go_back_fo_count,
-	           context->compressor->periodic_refreshes_fo_timeout,
-	           context->go_back_ir_count,
-	           context->compressor->periodic_refreshes_ir_timeout);
-
-	if(context->go_back_fo_count >=
-	   context->compressor->periodic_refreshes_fo_timeout)
-	{
-		rohc_info(context->compressor, ROHC_TRACE_COMP, context->profile->id,
-		          "CID %zu: periodic change to FO state", context->cid);
-		context->go_back_fo_count = 0;
-		rohc_comp_change_state(context, ROHC_COMP_STATE_FO);
-	}
-	else if(context->go_back_ir_count >=
-	        context->compressor->periodic_refreshes_ir_timeout)
+	/* compressor must be valid */
+	if(comp == NULL)
 	{
-		rohc_info(context->compressor, ROHC_TRACE_COMP, context->profile->id,
-		          "CID %zu: periodic change to IR state", context->cid);
-		context->go_back_ir_count = 0;
-		rohc_comp_change_state(context, ROHC_COMP_STATE_IR);
+		/* cannot print a trace without a valid compressor */
+		goto error;
 	}
 
-	if(context->state == ROHC_COMP_STATE_SO)
-	{
-		context->go_back_fo_count++;
-	}
-	if(context->state == ROHC_COMP_STATE_SO ||
-	   context->state == ROHC_COMP_STATE_FO)
+	/* new MRRU value must be in range [0, ROHC_MAX_MRRU] */
+	if(mrru > ROHC_MAX_MRRU)
 	{
-		context->go_back_ir_count++;
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		             "unexpected MRRU value: must be in range [0, %d]",
+		             ROHC_MAX_MRRU);
+		goto error;
 	}
-}
 
-
-/**
- * @brief Re-initialize the given context
- *
- * Make the context restart its initialization with decompressor, ie. it goes
- * in the lowest compression state.
- *
- * @param context  The compression context to re-initialize
- * @return         true in case of success, false otherwise
- */
-bool rohc_comp_reinit_context(struct rohc_comp_ctxt *const context)
-{
-	assert(context != NULL);
-
-	/* go back to U-mode and IR state */
-	rohc_comp_change_mode(context, ROHC_U_MODE);
-	rohc_comp_change_state(context, ROHC_COMP_STATE_IR);
-
-	return true;
-}
-
-
-/**
- * @brief Parse ROHC feedback CID
- *
- * @param comp          The ROHC compressor
- * @param feedback      The ROHC feedback data to parse
- * @param feedback_len  The length of the ROHC feedback data
- * @param[out] cid      The CID of the ROHC feedback
- * @param[out] cid_len  The length of the CID of the ROHC feedback
- * @return              true if feedback CID was successfully parsed,
- *                      false if feedback CID is malformed
- */
-static bool rohc_comp_feedback_parse_cid(const struct rohc_comp *const comp,
-                                         const uint8_t *const feedback,
-                                         const size_t feedback_len,
-                                         rohc_cid_t *const cid,
-                                         size_t *const cid_len)
-{
-	/* decode CID */
-	if(comp->medium.cid_type == ROHC_LARGE_CID)
+	/* resize the RRU buffer, keep the segments not retrieved yet */
+	if(mrru != comp->mrru)
 	{
-		size_t large_cid_size;
-		size_t large_cid_bits_nr;
-		uint32_t large_cid;
+		uint8_t *new_rru = NULL;
 
-		/* decode SDVL-encoded large CID field */
-		large_cid_size = sdvl_decode(feedback, feedback_len, &large_cid,
-		                             &large_cid_bits_nr);
-		if(large_cid_size != 1 && large_cid_size != 2)
+		if(comp->rru_len > mrru)
 		{
 			rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-			             "failed to parse feedback: failed to decode SDVL-encoded "
-			             "large CID field");
+			             "failed to set MRRU to %zu bytes: the %zu-byte RRU was "
+			             "not retrieved yet", mrru, comp->rru_len);
 			goto error;
 		}
-		*cid = large_cid;
-		*cid_len = large_cid_size;
-	}
-	else
-	{
-		/* decode small CID if present */
-		*cid = rohc_add_cid_decode(feedback, feedback_len);
-		if((*cid) == UINT8_MAX)
-		{
-			*cid_len = 0;
-			*cid = 0;
-		}
-		else
+		if(mrru > 0)
 		{
-			*cid_len = 1;
+			new_rru = rohc_numa_alloc(mrru, comp->numa_node);
+			if(new_rru == NULL)
+			{
+				rohc_error(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+				           "no memory for the %zu-byte RRU", mrru);
+				goto error;
+			}
+			if(comp->rru_len > 0)
+			{
+				memcpy(new_rru, comp->rru + comp->rru_off, comp->rru_len);
+			}
 		}
+		rohc_numa_free(comp->rru, comp->mrru, comp->numa_node);
+		comp->rru = new_rru;
+		comp->rru_off = 0;
 	}
 
+	/* set new MRRU */
+	comp->mrru = mrru;
 	rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-	           "feedback CID = %zu", *cid);
+	           "MRRU is now set to %zd", comp->mrru);
 
 	return true;
 
@@ -2766,328 +3472,6034 @@ error:
 
 
 /**
- * @brief Parse FEEDBACK-2 options
+ * @brief Get the Maximum Reconstructed Reception Unit (MRRU).
  *
- * @param context            The ROHC decompression context
- * @param packet             The whole feedback packet with CID bits
- * @param packet_len         The length of the whole feedback packet with CID bits
- * @param feedback_data      The feedback data without the CID bits
- * @param feedback_data_len  The length of the feedback data without the CID bits
- * @param[out] opts_present  Whether options are present or not
- * @param[out] sn_bits       in: the SN bits collected in base header
- *                           out: the SN bits collected in base header and options
- * @param[out] sn_bits_nr    in: the number of SN bits collected in base header
- *                           out: the number of SN bits collected in base header
- *                                and options
- * @param crc_in_packet      The CRC of the feedback packet
- * @param crc_pos_from_end   The position of the CRC byte from the end of the
- *                           feedback packet
- * @return                   true if feedback options were successfully parsed,
- *                           false if feedback options were malformed or CRC is wrong
- */
-bool rohc_comp_feedback_parse_opts(const struct rohc_comp_ctxt *const context,
-                                   const uint8_t *const packet,
-                                   const size_t packet_len,
-                                   const uint8_t *const feedback_data,
-                                   const size_t feedback_data_len,
-                                   size_t opts_present[ROHC_FEEDBACK_OPT_MAX],
-                                   uint32_t *const sn_bits,
-                                   size_t *const sn_bits_nr,
+ * Get the current Maximum Reconstructed Reception Unit (MRRU).
+ *
+ * The MRRU is the largest cumulative length (in bytes) of the ROHC segments
+ * that are parts of the same ROHC packet. In short, the ROHC decompressor
+ * does not expect to reassemble ROHC segments whose total length is larger
+ * than MRRU. So, the ROHC compressor shall not segment ROHC packets greater
+ * than the MRRU.
+ *
+ * The MRRU value must be in range [0 ; \ref ROHC_MAX_MRRU]. Remember that the
+ * MRRU includes the 32-bit CRC that protects it.
+ * If MRRU value is 0, segmentation is disabled.
+ *
+ * If segmentation is enabled and used by the compressor, the function
+ * \ref rohc_comp_get_segment2 can be used to retrieve ROHC segments.
+ *
+ * @param comp       The ROHC compressor
+ * @param[out] mrru  The current MRRU value (in bytes)
+ * @return           true if MRRU was successfully retrieved, false otherwise
+ *
+ * @ingroup rohc_comp
+ *
+ * \par Example:
+ * \snippet test_segment.c define ROHC compressor
+ * \code
+        size_t mrru;
+        ...
+\endcode
+ * \snippet test_non_regression.c get compressor MRRU
+ * \code
+        printf("the current MMRU at compressor is %zu bytes\n", mrru);
+        ...
+\endcode
+ *
+ * @see rohc_comp_set_mrru
+ * @see rohc_comp_get_segment2
+ * @see rohc_decomp_set_mrru
+ * @see rohc_decomp_get_mrru
+ */
+bool rohc_comp_get_mrru(const struct rohc_comp *const comp,
+                        size_t *const mrru)
+{
+	if(comp == NULL || mrru == NULL)
+	{
+		goto error;
+	}
+
+	*mrru = comp->mrru;
+	return true;
+
+error:
+	return false;
+}
+
+/**
+ * @brief Set the memory budget for the contexts of the ROHC compressor
+ *
+ * Set the size (in bytes) of the memory budget that the ROHC compressor may use
+ * for its compression contexts. The memory budget is preallocated at once, then
+ * the memory of the contexts is taken from it: no memory is allocated any
+ * more when new compression contexts are created, and the creation of new
+ * contexts fails once the memory budget is exhausted. The memory of the
+ * destroyed contexts is reused for the new contexts.
+ *
+ * If the memory budget is 0, the memory of the contexts is allocated on
+ * demand. This is the default behaviour.
+ *
+ * The memory budget cannot be changed while compression contexts are in use.
+ *
+ * @param comp    The ROHC compressor
+ * @param budget  The size (in bytes) of the memory budget, 0 for no budget
+ * @return        true if the memory budget was successfully set,
+ *                false otherwise
+ *
+ * @ingroup rohc_comp
+ *
+ * @see rohc_decomp_set_memory_budget
+ */
+bool rohc_comp_set_memory_budget(struct rohc_comp *const comp,
+                                 const size_t budget)
+{
+	/* compressor must be valid */
+	if(comp == NULL)
+	{
+		/* cannot print a trace without a valid compressor */
+		goto error;
+	}
+
+	/* the memory of the contexts in use cannot be moved */
+	if(comp->num_contexts_used > 0)
+	{
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		             "failed to set the memory budget to %zu bytes: %zu "
+		             "contexts are in use", budget, comp->num_contexts_used);
+		goto error;
+	}
+
+	if(!rohc_ctxt_pool_set_budget(&comp->ctxt_pool, budget))
+	{
+		rohc_error(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		           "no memory for the %zu-byte memory budget", budget);
+		goto error;
+	}
+
+	/* no memory shall be allocated any more for new contexts, whatever their
+	 * CIDs */
+	if(budget > 0 && !c_alloc_ctxts_chunks(comp, 0, comp->medium.max_cid))
+	{
+		goto error;
+	}
+	rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+	           "memory budget is now set to %zu bytes", budget);
+
+	return true;
+
+error:
+	return false;
+}
+
+
+/**
+ * @brief Back the memory of the compression contexts with huge pages
+ *
+ * With many contexts, the contexts and their profile-specific parts spread
+ * over many memory pages, and the TLB misses slow the compression down. With
+ * huge pages, the chunks of contexts and the profile-specific parts of the
+ * contexts are carved from a few memory areas mapped with 2 MiB huge pages.
+ * Explicit huge pages (MAP_HUGETLB) are used if the system has enough of them
+ * reserved, transparent huge pages are used otherwise.
+ *
+ * The memory budget, see \ref rohc_comp_set_memory_budget, is mapped with
+ * huge pages too. Set the memory budget after enabling the huge pages, so
+ * that all the contexts are allocated from huge pages at once.
+ *
+ * The huge pages are mapped directly, not with the memory allocator of the
+ * application, see \ref rohc_set_allocator. They are not available in the
+ * Linux kernel nor on systems without mmap(2).
+ *
+ * Huge pages are disabled by default. They cannot be enabled or disabled
+ * once the memory of contexts was allocated, neither when a compressor is
+ * run by a manager of channels.
+ *
+ * @param comp     The ROHC compressor
+ * @param enabled  Whether to back the memory of contexts with huge pages
+ * @return         true if huge pages were successfully enabled or disabled,
+ *                 false otherwise
+ *
+ * @ingroup rohc_comp
+ *
+ * @see rohc_comp_set_memory_budget
+ * @see rohc_decomp_set_huge_pages
+ */
+bool rohc_comp_set_huge_pages(struct rohc_comp *const comp,
+                              const bool enabled)
+{
+	/* compressor must be valid */
+	if(comp == NULL)
+	{
+		/* cannot print a trace without a valid compressor */
+		goto error;
+	}
+
+	/* the memory of the contexts already allocated cannot be moved */
+	if(comp->ctxts_chunks_nr > 0)
+	{
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		             "failed to %s huge pages: the memory of %zu contexts "
+		             "is already allocated", enabled ? "enable" : "disable",
+		             comp->ctxts_chunks_nr * ROHC_COMP_CTXTS_CHUNK_LEN);
+		goto error;
+	}
+	if(comp->cur_ctxt_pool != &comp->ctxt_pool)
+	{
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		             "failed to %s huge pages: the compressor is run by a "
+		             "manager of channels", enabled ? "enable" : "disable");
+		goto error;
+	}
+
+	if(!rohc_ctxt_pool_set_huge_pages(&comp->ctxts_chunks_pool, enabled))
+	{
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		             "failed to map huge pages for the contexts");
+		goto error;
+	}
+	if(!rohc_ctxt_pool_set_huge_pages(&comp->ctxt_pool, enabled))
+	{
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		             "failed to map huge pages for the profile-specific parts "
+		             "of the contexts");
+		/* no chunk was carved yet, the pool may be reset */
+		rohc_ctxt_pool_free(&comp->ctxts_chunks_pool);
+		rohc_ctxt_pool_init(&comp->ctxts_chunks_pool);
+		rohc_ctxt_pool_set_numa_node(&comp->ctxts_chunks_pool,
+		                             comp->numa_node);
+		goto error;
+	}
+	rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+	           "huge pages are now %s for contexts (%zu memory areas backed "
+	           "by explicit huge pages)", enabled ? "enabled" : "disabled",
+	           comp->ctxts_chunks_pool.huge_areas_nr +
+	           comp->ctxt_pool.huge_areas_nr);
+
+	return true;
+
+error:
+	return false;
+}
+
+
+/**
+ * @brief Reserve the memory for the given number of compression contexts
+ *
+ * The compression contexts are allocated by chunks of consecutive CIDs when
+ * they are first needed, so that a compressor with a large MAX_CID is cheap
+ * to create, and its memory grows with the number of flows. The first
+ * packet of a flow may thus allocate memory for the contexts.
+ *
+ * Reserve the memory for the contexts of the given number of CIDs at the
+ * beginning of the CID range, ie. the first CIDs that the compressor gives
+ * to the new contexts, see \ref rohc_comp_set_cid_range. Once reserved,
+ * no memory is allocated for the contexts of these CIDs any more. Reserve
+ * all the CIDs of the range to get the behaviour of a compressor that
+ * allocates all its contexts at creation.
+ *
+ * The memory is kept until the compressor is destroyed.
+ *
+ * @param comp         The ROHC compressor
+ * @param contexts_nr  The number of contexts to reserve memory for, at most
+ *                     the number of CIDs in the CID range
+ * @return             true if the memory was reserved,
+ *                     false otherwise
+ *
+ * @ingroup rohc_comp
+ *
+ * @see rohc_comp_set_cid_range
+ * @see rohc_comp_set_memory_budget
+ * @see rohc_decomp_reserve_contexts
+ */
+bool rohc_comp_reserve_contexts(struct rohc_comp *const comp,
+                                const size_t contexts_nr)
+{
+	/* compressor must be valid */
+	if(comp == NULL)
+	{
+		/* cannot print a trace without a valid compressor */
+		goto error;
+	}
+
+	if(contexts_nr > (comp->cid_last - comp->cid_first + 1))
+	{
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		             "failed to reserve %zu contexts: only %zu CIDs in the "
+		             "CID range [%zu, %zu]", contexts_nr,
+		             comp->cid_last - comp->cid_first + 1, comp->cid_first,
+		             comp->cid_last);
+		goto error;
+	}
+
+	if(contexts_nr > 0 &&
+	   !c_alloc_ctxts_chunks(comp, comp->cid_first,
+	                         comp->cid_first + contexts_nr - 1))
+	{
+		goto error;
+	}
+	rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+	           "memory reserved for %zu contexts (%zu chunks of %u contexts "
+	           "allocated)", contexts_nr, comp->ctxts_chunks_nr,
+	           ROHC_COMP_CTXTS_CHUNK_LEN);
+
+	return true;
+
+error:
+	return false;
+}
+
+
+
+/**
+ * @brief Get the maximal CID value the compressor uses
+ *
+ * Get the maximal CID value the compressor uses, ie. the \e MAX_CID parameter
+ * defined in RFC 3095.
+ *
+ * @param comp         The ROHC compressor
+ * @param[out] max_cid  The current maximal CID value
+ * @return              true if MAX_CID was successfully retrieved,
+ *                      false otherwise
+ *
+ * @ingroup rohc_comp
+ */
+bool rohc_comp_get_max_cid(const struct rohc_comp *const comp,
+                           size_t *const max_cid)
+{
+	if(comp == NULL || max_cid == NULL)
+	{
+		goto error;
+	}
+
+	*max_cid = comp->medium.max_cid;
+	return true;
+
+error:
+	return false;
+}
+
+
+/**
+ * @brief Restrict the CIDs that the compressor assigns to new contexts
+ *
+ * By default, the compressor assigns all the CIDs from 0 to \e MAX_CID to
+ * the new contexts. Restricting the compressor to a sub-range of CIDs allows
+ * several compressors to share one ROHC channel: each compressor compresses
+ * its own flows with the CIDs of its sub-range, and the decompressor at the
+ * other end of the channel sees one coherent CID namespace. The CIDs are
+ * still encoded with respect to the \e MAX_CID of the channel.
+ *
+ * The CID range cannot be changed while compression contexts are in use.
+ *
+ * @param comp       The ROHC compressor
+ * @param first_cid  The first CID of the range
+ * @param last_cid   The last CID of the range, in [first_cid, MAX_CID]
+ * @return           true if the CID range was successfully set,
+ *                   false otherwise
+ *
+ * @ingroup rohc_comp
+ *
+ * @see rohc_comp_group_new
+ */
+bool rohc_comp_set_cid_range(struct rohc_comp *const comp,
+                             const size_t first_cid,
+                             const size_t last_cid)
+{
+	/* compressor must be valid */
+	if(comp == NULL)
+	{
+		/* cannot print a trace without a valid compressor */
+		goto error;
+	}
+
+	/* the range shall be a non-empty part of [0, MAX_CID] */
+	if(first_cid > last_cid || last_cid > comp->medium.max_cid)
+	{
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		             "failed to set the CID range to [%zu, %zu]: range shall "
+		             "be a non-empty part of [0, %zu]", first_cid, last_cid,
+		             comp->medium.max_cid);
+		goto error;
+	}
+
+	/* the contexts in use might be out of the new range */
+	if(comp->num_contexts_used > 0)
+	{
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		             "failed to set the CID range to [%zu, %zu]: %zu contexts "
+		             "are in use", first_cid, last_cid, comp->num_contexts_used);
+		goto error;
+	}
+
+	comp->cid_first = first_cid;
+	comp->cid_last = last_cid;
+	c_chain_unused_contexts(comp);
+	rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+	           "new contexts now get CIDs in range [%zu, %zu]", first_cid,
+	           last_cid);
+
+	return true;
+
+error:
+	return false;
+}
+
+
+/**
+ * @brief Get the CID type that the compressor uses
+ *
+ * Get the CID type that the compressor currently uses.
+ *
+ * @param comp           The ROHC compressor
+ * @param[out] cid_type  The current CID type among \ref ROHC_SMALL_CID and
+ *                       \ref ROHC_LARGE_CID
+ * @return               true if the CID type was successfully retrieved,
+ *                       false otherwise
+ *
+ * @ingroup rohc_comp
+ */
+bool rohc_comp_get_cid_type(const struct rohc_comp *const comp,
+                            rohc_cid_type_t *const cid_type)
+{
+	if(comp == NULL || cid_type == NULL)
+	{
+		goto error;
+	}
+
+	*cid_type = comp->medium.cid_type;
+	return true;
+
+error:
+	return false;
+}
+
+
+/**
+ * @brief Enable/disable features for ROHC compressor
+ *
+ * Enable/disable features for ROHC compressor. Features control whether
+ * mechanisms defined as optional by RFCs are enabled or not.
+ *
+ * Available features are listed by \ref rohc_comp_features_t. They may be
+ * combined by XOR'ing them together.
+ *
+ * With \ref ROHC_COMP_FEATURE_REALTIME, the worst-case cost of one packet is
+ * the parsing of its headers, one lookup in the index of contexts, the
+ * recycling of one context taken from the tail of the recycling list, and
+ * for every W-LSB encoded field two scans at most of a window as wide as the
+ * configured width. Reserve the contexts with \ref rohc_comp_reserve_contexts
+ * so that no memory is allocated when a new flow starts. The worst case may
+ * be measured with the histograms of \ref rohc_comp_get_timings.
+ *
+ * @warning Changing the feature set while library is used is not supported
+ *
+ * @param comp     The ROHC compressor
+ * @param features  The feature set to enable/disable
+ * @return          true if the feature set was successfully enabled/disabled,
+ *                  false if a problem occurred
+ *
+ * @ingroup rohc_comp
+ *
+ * @see rohc_comp_features_t
+ */
+bool rohc_comp_set_features(struct rohc_comp *const comp,
+                            const rohc_comp_features_t features)
+{
+	const rohc_comp_features_t all_features =
+		ROHC_COMP_FEATURE_NO_IP_CHECKSUMS |
+#ifdef ROHC_TIMINGS
+		ROHC_COMP_FEATURE_TIMINGS |
+#endif
+		ROHC_COMP_FEATURE_WLSB_VARIABLE_WIDTH |
+		ROHC_COMP_FEATURE_SNAPSHOTS |
+		ROHC_COMP_FEATURE_REALTIME |
+		ROHC_COMP_FEATURE_DUMP_PACKETS;
+
+	/* compressor must be valid */
+	if(comp == NULL)
+	{
+		/* cannot print a trace without a valid compressor */
+		goto error;
+	}
+
+	/* reject unsupported features */
+	if((features & all_features) != features)
+	{
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		             "feature set 0x%x is not supported (supported features "
+		             "set is 0x%x)", features, all_features);
+		goto error;
+	}
+
+	/* the real-time mode bounds the W-LSB windows to the configured width */
+	if((features & ROHC_COMP_FEATURE_REALTIME) != 0 &&
+	   (features & ROHC_COMP_FEATURE_WLSB_VARIABLE_WIDTH) != 0)
+	{
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		             "real-time mode is not compatible with variable-width "
+		             "W-LSB windows");
+		goto error;
+	}
+
+	/* save the headers of the contexts for their snapshots, or stop saving
+	 * them, the contexts are saved again with their next packet */
+	if((features & ROHC_COMP_FEATURE_SNAPSHOTS) != 0 &&
+	   comp->ctxts_snapshots == NULL)
+	{
+		comp->ctxts_snapshots = rohc_calloc(comp->medium.max_cid + 1,
+		                               sizeof(struct rohc_comp_ctxt_snapshot));
+		comp->ctxts_dirty = rohc_calloc((comp->medium.max_cid + 8) / 8,
+		                           sizeof(uint8_t));
+		if(comp->ctxts_snapshots == NULL || comp->ctxts_dirty == NULL)
+		{
+			rohc_error(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+			           "cannot allocate memory for the snapshots of contexts");
+			zfree(comp->ctxts_snapshots);
+			zfree(comp->ctxts_dirty);
+			goto error;
+		}
+	}
+	else if((features & ROHC_COMP_FEATURE_SNAPSHOTS) == 0)
+	{
+		zfree(comp->ctxts_snapshots);
+		zfree(comp->ctxts_dirty);
+	}
+
+	/* record new feature set */
+	comp->features = features;
+
+	return true;
+
+error:
+	return false;
+}
+
+
+/**
+ * @brief Do the work that the real-time mode removes from the datapath
+ *
+ * With the feature \ref ROHC_COMP_FEATURE_REALTIME, the compression of one
+ * packet does not move the timers of the time-based periodic refreshes
+ * forward, since moving them after a long silence may expire many timers:
+ * call this function periodically outside the datapath, for example from a
+ * low-priority thread that takes the same lock as the datapath. The timers
+ * are then armed against the time of the last call, so they may expire up
+ * to one period of calls early.
+ *
+ * Without the real-time mode, the datapath already does this work, but the
+ * function may be called too.
+ *
+ * @param comp  The ROHC compressor
+ * @param now   The current time
+ * @return      true if the maintenance was done,
+ *              false if the compressor is invalid
+ *
+ * @ingroup rohc_comp
+ *
+ * @see rohc_comp_set_features
+ * @see rohc_comp_set_periodic_refreshes_time
+ */
+bool rohc_comp_maintenance(struct rohc_comp *const comp,
+                           const struct rohc_ts now)
+{
+	const uint64_t now_ms = now.sec * 1000U + now.nsec / 1000000U;
+
+	/* compressor must be valid */
+	if(comp == NULL)
+	{
+		/* cannot print a trace without a valid compressor */
+		goto error;
+	}
+
+	/* move the timers of the time-based periodic refreshes forward */
+	if(comp->periodic_refreshes_ir_timeout_time > 0)
+	{
+		rohc_comp_wheel_advance(&comp->refresh_wheel, now_ms);
+	}
+	rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+	           "maintenance: timers moved forward to %" PRIu64 " ms", now_ms);
+
+	return true;
+
+error:
+	return false;
+}
+
+
+/**
+ * @brief Deliver a feedback packet to the compressor
+ *
+ * When feedback is received by the decompressor, this function is called and
+ * delivers the feedback to the right profile/context of the compressor.
+ *
+ * @param comp   The ROHC compressor
+ * @param packet The feedback data
+ * @param size   The length of the feedback packet
+ * @return       true if the feedback was successfully taken into account,
+ *               false if the feedback could not be taken into account
+ */
+static bool __rohc_comp_deliver_feedback(struct rohc_comp *const comp,
+                                         const uint8_t *const packet,
+                                         const size_t size)
+{
+	rohc_cid_t cid;
+	size_t cid_len;
+
+	rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+	           "deliver %zu byte(s) of feedback to the right context", size);
+
+	/* extract the CID from feedback */
+	if(!rohc_comp_feedback_parse_cid(comp, packet, size, &cid, &cid_len))
+	{
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		             "failed to deliver feedback: failed to extract CID from "
+		             "feedback");
+		goto error;
+	}
+
+	return c_deliver_feedback_to_ctxt(comp, cid, cid_len, packet, size);
+
+error:
+	return false;
+}
+
+
+/**
+ * @brief Deliver a feedback packet to the context with the given CID
+ *
+ * @param comp     The ROHC compressor
+ * @param cid      The CID parsed from the feedback
+ * @param cid_len  The length of the CID in the feedback
+ * @param packet   The feedback data, CID included
+ * @param size     The length of the feedback packet
+ * @return         true if the feedback was successfully taken into account,
+ *                 false if the feedback could not be taken into account
+ */
+static bool c_deliver_feedback_to_ctxt(struct rohc_comp *const comp,
+                                       const rohc_cid_t cid,
+                                       const size_t cid_len,
+                                       const uint8_t *const packet,
+                                       const size_t size)
+{
+	struct rohc_comp_ctxt *context;
+	const uint8_t *const remain_data = packet + cid_len;
+	const size_t remain_len = size - cid_len;
+	enum rohc_feedback_type feedback_type;
+	rohc_ticks_t feedback_ticks;
+
+	/* find context */
+	context = c_get_context(comp, cid);
+	if(context == NULL)
+	{
+		/* context was not found */
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		             "failed to deliver feedback: context with CID = %zu not found",
+		             cid);
+		goto error;
+	}
+	assert(context->cid == cid);
+	assert(context->used == 1);
+
+	/* FEEDBACK-1 or FEEDBACK-2 ? */
+	if(remain_len == 0)
+	{
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		             "failed to deliver feedback: empty feedback data");
+		goto error;
+	}
+	else if(remain_len == 1)
+	{
+		feedback_type = ROHC_FEEDBACK_1;
+	}
+	else
+	{
+		feedback_type = ROHC_FEEDBACK_2;
+	}
+
+	/* deliver feedback to profile with the context */
+	feedback_ticks = rohc_comp_ticks(comp);
+	if(!context->profile->feedback(context, feedback_type, packet, size,
+	                               remain_data, remain_len))
+	{
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		             "failed to deliver feedback: failed to handle FEEDBACK-%d",
+		             feedback_type);
+		goto error;
+	}
+	if(rohc_comp_timings_enabled(comp))
+	{
+		c_timings_record_feedback(comp, context->profile->id,
+		                          rohc_ticks_now() - feedback_ticks);
+	}
+	ROHC_PROBE4(comp_feedback, cid, context->profile->id, feedback_type,
+	            remain_len);
+
+	/* everything went fine */
+	rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+	           "FEEDBACK-%d data successfully handled", feedback_type);
+
+	return true;
+
+error:
+	return false;
+}
+
+
+/**
+ * @brief Deliver a feedback packet to the compressor
+ *
+ * When feedback data is received by a decompressor, this function may be
+ * called to deliver the feedback data to the corresponding profile/context
+ * on the same-side associated compressor.
+ *
+ * @param comp     The ROHC compressor
+ * @param feedback  The feedback data
+ * @return          true if the feedback was successfully taken into account,
+ *                  false if the feedback could not be taken into account
+ *
+ * @ingroup rohc_comp
+ */
+bool rohc_comp_deliver_feedback2(struct rohc_comp *const comp,
+                                 const struct rohc_buf feedback)
+{
+	struct rohc_buf remain_data = feedback;
+	size_t feedbacks_nr = 0;
+	size_t nr_failures = 0;
+
+	/* sanity checks */
+	if(comp == NULL)
+	{
+		goto error;
+	}
+	if(rohc_buf_is_malformed(remain_data))
+	{
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		             "failed to deliver feedback: feedback is malformed");
+		goto error;
+	}
+
+	/* the feedback enqueued by other threads is older */
+	c_deliver_queued_feedbacks(comp);
+
+	rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+	           "deliver %zu byte(s) of feedback to the right context",
+	           remain_data.len);
+
+	/* there is nothing for compressor if feedback contains no byte at all */
+	if(rohc_buf_is_empty(remain_data))
+	{
+		goto ignore;
+	}
+
+	/* parse as much feedback data as possible */
+	while(remain_data.len > 0 &&
+	      rohc_packet_is_feedback(rohc_buf_byte(remain_data)))
+	{
+		size_t feedback_hdr_len;
+		size_t feedback_data_len;
+		size_t feedback_len;
+
+		feedbacks_nr++;
+
+		if(!rohc_feedback_get_size(remain_data, &feedback_hdr_len,
+		                           &feedback_data_len))
+		{
+			rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+			             "failed to parse a feedback item");
+			goto error;
+		}
+		feedback_len = feedback_hdr_len + feedback_data_len;
+		rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		           "feedback found (header = %zu bytes, data = %zu bytes)",
+		           feedback_hdr_len, feedback_data_len);
+
+		/* reject feedback item if it doesn't fit in the available data */
+		if(feedback_len > remain_data.len)
+		{
+			rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+			             "the %zu-byte feedback is too large for the %zu-byte "
+			             "remaining ROHC data", feedback_len, remain_data.len);
+			goto error;
+		}
+
+		/* skip the feedback header */
+		rohc_buf_pull(&remain_data, feedback_hdr_len);
+
+		/* deliver the feedback data to the compressor */
+		if(!__rohc_comp_deliver_feedback(comp, rohc_buf_data(remain_data),
+		                                 feedback_data_len))
+		{
+			rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+			             "failed to deliver feedback item #%zu", feedbacks_nr);
+			nr_failures++;
+		}
+
+		/* skip the feedback data */
+		rohc_buf_pull(&remain_data, feedback_data_len);
+	}
+
+	return (nr_failures == 0);
+
+ignore:
+	return true;
+
+error:
+	return false;
+}
+
+
+/**
+ * @brief Deliver a burst of feedback packets to the compressor
+ *
+ * This function behaves as \ref rohc_comp_deliver_feedback2, but it is
+ * intended for buffers that contain many feedback items, such as the
+ * feedback received by a decompressor with \ref rohc_decompress3.
+ *
+ * The feedback items are parsed in one pass, by batches of 64 items. In
+ * every batch, a positive ACK is dropped if a more recent ACK for the same
+ * context follows: it would only acknowledge an older packet. A FEEDBACK-2
+ * ACK is kept if the more recent ACK is a FEEDBACK-1, since the latter does
+ * not carry the mode nor the options of the former. Negative ACKs are
+ * always delivered. The remaining feedback items are then delivered in
+ * order.
+ *
+ * @param comp     The ROHC compressor
+ * @param feedback  The feedback data
+ * @return          true if all the delivered feedback items were taken into
+ *                  account, false if one of them could not be taken into
+ *                  account or if the feedback data is malformed
+ *
+ * @ingroup rohc_comp
+ */
+bool rohc_comp_deliver_feedback_burst(struct rohc_comp *const comp,
+                                      const struct rohc_buf feedback)
+{
+	struct rohc_comp_feedback_item *items;
+	struct rohc_buf remain_data = feedback;
+	bool is_malformed = false;
+	size_t nr_failures = 0;
+
+	/* sanity checks */
+	if(comp == NULL)
+	{
+		goto error;
+	}
+	if(rohc_buf_is_malformed(remain_data))
+	{
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		             "failed to deliver feedback: feedback is malformed");
+		goto error;
+	}
+	items = comp->feedback_burst;
+
+	/* the feedback enqueued by other threads is older */
+	c_deliver_queued_feedbacks(comp);
+
+	rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+	           "deliver a burst of %zu byte(s) of feedback", remain_data.len);
+
+	while(!is_malformed && remain_data.len > 0 &&
+	      rohc_packet_is_feedback(rohc_buf_byte(remain_data)))
+	{
+		size_t items_nr = 0;
+		size_t dropped_nr;
+		size_t i;
+
+		/* parse one batch of feedback items */
+		while(items_nr < ROHC_COMP_FEEDBACK_BURST_MAX && remain_data.len > 0 &&
+		      rohc_packet_is_feedback(rohc_buf_byte(remain_data)))
+		{
+			struct rohc_comp_feedback_item *const item = &items[items_nr];
+			size_t feedback_hdr_len;
+			size_t feedback_data_len;
+
+			if(!rohc_feedback_get_size(remain_data, &feedback_hdr_len,
+			                           &feedback_data_len) ||
+			   (feedback_hdr_len + feedback_data_len) > remain_data.len)
+			{
+				rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+				             "failed to parse a feedback item");
+				is_malformed = true;
+				break;
+			}
+			rohc_buf_pull(&remain_data, feedback_hdr_len);
+			item->data = rohc_buf_data(remain_data);
+			item->len = feedback_data_len;
+			rohc_buf_pull(&remain_data, feedback_data_len);
+
+			if(!rohc_comp_feedback_parse_cid(comp, item->data, item->len,
+			                                 &item->cid, &item->cid_len) ||
+			   item->cid_len >= item->len)
+			{
+				rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+				             "failed to deliver feedback: malformed %zu-byte "
+				             "feedback item", item->len);
+				nr_failures++;
+				continue;
+			}
+			item->is_fb2 = ((item->len - item->cid_len) > 1);
+			item->is_ack =
+				(!item->is_fb2 ||
+				 ((item->data[item->cid_len] >> 6) & 0x03) == ROHC_FEEDBACK_ACK);
+			item->skip = false;
+			items_nr++;
+		}
+
+		/* apply only the most recent ACK per context */
+		dropped_nr = c_feedback_burst_dedup(items, items_nr);
+		rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		           "%zu feedback item(s) parsed, %zu older ACK(s) dropped",
+		           items_nr, dropped_nr);
+
+		for(i = 0; i < items_nr; i++)
+		{
+			if(items[i].skip)
+			{
+				continue;
+			}
+			if(!c_deliver_feedback_to_ctxt(comp, items[i].cid, items[i].cid_len,
+			                               items[i].data, items[i].len))
+			{
+				rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+				             "failed to deliver feedback for CID %zu",
+				             items[i].cid);
+				nr_failures++;
+			}
+		}
+	}
+
+	return (!is_malformed && nr_failures == 0);
+
+error:
+	return false;
+}
+
+
+/**
+ * @brief Mark the redundant ACKs of one batch of feedback items
+ *
+ * A positive ACK is redundant if a more recent ACK for the same context
+ * follows in the batch, unless the ACK is a FEEDBACK-2 and the more recent
+ * one a FEEDBACK-1.
+ *
+ * @param items     The batch of feedback items, oldest first
+ * @param items_nr  The number of feedback items in the batch
+ * @return          The number of feedback items marked as redundant
+ */
+static size_t c_feedback_burst_dedup(struct rohc_comp_feedback_item *const items,
+                                     const size_t items_nr)
+{
+	size_t dropped_nr = 0;
+	size_t i;
+
+	for(i = 0; i < items_nr; i++)
+	{
+		size_t j;
+
+		if(!items[i].is_ack)
+		{
+			continue;
+		}
+		for(j = i + 1; j < items_nr; j++)
+		{
+			if(items[j].cid == items[i].cid && items[j].is_ack &&
+			   (items[j].is_fb2 || !items[i].is_fb2))
+			{
+				items[i].skip = true;
+				dropped_nr++;
+				break;
+			}
+		}
+	}
+
+	return dropped_nr;
+}
+
+
+/**
+ * @brief Enqueue a feedback packet for the compressor from any thread
+ *
+ * The feedback shall be delivered with \ref rohc_comp_deliver_feedback2 by
+ * the thread that uses the compressor, since the feedback updates the
+ * compression contexts. When the feedback is received by another thread,
+ * this function may be called instead, even by several threads at the same
+ * time and while the compressor is used: the feedback items are copied in a
+ * lock-free queue of the compressor, and they are delivered at the beginning
+ * of the next call to \ref rohc_compress4, \ref rohc_compress_iov,
+ * \ref rohc_compress_inplace, \ref rohc_compress_burst or
+ * \ref rohc_comp_deliver_feedback2.
+ *
+ * The feedback items are all enqueued, or none of them. No trace is emitted
+ * since the traces callback belongs to the thread of the compressor.
+ *
+ * @param comp     The ROHC compressor
+ * @param feedback  The feedback data
+ * @return          true if the feedback was enqueued,
+ *                  false if the feedback is malformed or if the queue has
+ *                  not enough room for it
+ *
+ * @ingroup rohc_comp
+ *
+ * @see rohc_comp_deliver_feedback2
+ */
+bool rohc_comp_enqueue_feedback(struct rohc_comp *const comp,
+                                const struct rohc_buf feedback)
+{
+	struct rohc_buf remain_data = feedback;
+	size_t feedbacks_nr = 0;
+	size_t pos;
+	size_t i;
+
+	if(comp == NULL || rohc_buf_is_malformed(feedback))
+	{
+		goto error;
+	}
+
+	/* count the feedback items, all of them shall be well-formed */
+	while(remain_data.len > 0 &&
+	      rohc_packet_is_feedback(rohc_buf_byte(remain_data)))
+	{
+		size_t feedback_hdr_len;
+		size_t feedback_data_len;
+
+		if(!rohc_feedback_get_size(remain_data, &feedback_hdr_len,
+		                           &feedback_data_len) ||
+		   (feedback_hdr_len + feedback_data_len) > remain_data.len)
+		{
+			goto error;
+		}
+		rohc_buf_pull(&remain_data, feedback_hdr_len + feedback_data_len);
+		feedbacks_nr++;
+	}
+	if(feedbacks_nr == 0)
+	{
+		/* there is nothing for compressor */
+		goto ignore;
+	}
+
+	/* copy the feedback items in consecutive slots of the queue */
+	if(!rohc_comp_feedback_queue_reserve(&comp->feedback_queue, feedbacks_nr,
+	                                     &pos))
+	{
+		goto error;
+	}
+	remain_data = feedback;
+	for(i = 0; i < feedbacks_nr; i++)
+	{
+		size_t feedback_hdr_len = 0;
+		size_t feedback_data_len = 0;
+
+		if(!rohc_feedback_get_size(remain_data, &feedback_hdr_len,
+		                           &feedback_data_len))
+		{
+			assert(0); /* checked above */
+		}
+		rohc_buf_pull(&remain_data, feedback_hdr_len);
+		rohc_comp_feedback_queue_publish(&comp->feedback_queue, pos + i,
+		                                 rohc_buf_data(remain_data),
+		                                 feedback_data_len);
+		rohc_buf_pull(&remain_data, feedback_data_len);
+	}
+
+ignore:
+	return true;
+
+error:
+	return false;
+}
+
+
+/**
+ * @brief Deliver the feedback enqueued by other threads
+ *
+ * At most one turn of the queue is delivered, so that the other threads
+ * cannot keep the compressor busy with feedback.
+ *
+ * @param comp  The ROHC compressor
+ */
+static void c_deliver_queued_feedbacks(struct rohc_comp *const comp)
+{
+	uint8_t data[ROHC_COMP_FEEDBACK_QUEUE_DATA_MAX];
+	size_t len;
+	size_t i;
+
+	for(i = 0; i < ROHC_COMP_FEEDBACK_QUEUE_SLOTS &&
+	    rohc_comp_feedback_queue_pop(&comp->feedback_queue, data, &len); i++)
+	{
+		if(!__rohc_comp_deliver_feedback(comp, data, len))
+		{
+			rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+			             "failed to deliver enqueued feedback item");
+		}
+	}
+}
+
+
+/**
+ * @brief Export the compression contexts in a snapshot
+ *
+ * The snapshot allows another compressor, for example the one of a standby
+ * node, to go on compressing the flows of the given compressor without
+ * starting them over in IR state. Only the contexts that left the IR state
+ * and that compressed a packet since the \ref ROHC_COMP_FEATURE_SNAPSHOTS
+ * feature was enabled are exported: the other ones are initialized again
+ * after import as usual.
+ *
+ * The snapshot is appended to the given buffer. It shall be imported with
+ * \ref rohc_comp_import_contexts in a compressor with the same CID type and
+ * MAX_CID. The contexts are then kept up-to-date with the change logs of
+ * \ref rohc_comp_export_changes, the first change log starts with the
+ * contexts modified after the snapshot.
+ *
+ * @param comp           The ROHC compressor
+ * @param[out] snapshot  The buffer where to append the snapshot
+ * @return               true if the snapshot was successfully exported,
+ *                       false if the feature is disabled or the buffer
+ *                       is too small
+ *
+ * @ingroup rohc_comp
+ *
+ * @see rohc_comp_import_contexts
+ * @see rohc_comp_export_changes
+ */
+bool rohc_comp_export_contexts(struct rohc_comp *const comp,
+                               struct rohc_buf *const snapshot)
+{
+	const struct rohc_comp_ctxt *context;
+	uint32_t ctxts_nr = 0;
+	size_t hdr_offset;
+
+	if(comp == NULL)
+	{
+		goto error;
+	}
+	if(!c_snapshot_write_hdr(comp, snapshot, ROHC_COMP_SNAPSHOT_MAGIC))
+	{
+		goto error;
+	}
+	hdr_offset = snapshot->len - ROHC_COMP_SNAPSHOT_HDR_LEN;
+
+	/* the contexts, from the first one to be recycled to the last one, so
+	 * that the import rebuilds the same recycling order, the contexts on
+	 * probation first: they are admitted once imported */
+	for(context = (comp->ctxts_probation_tail != NULL ?
+	               comp->ctxts_probation_tail : comp->ctxts_recycle_tail);
+	    context != NULL;
+	    context = (context->recycle_prev == NULL && context->on_probation ?
+	               comp->ctxts_recycle_tail : context->recycle_prev))
+	{
+		uint8_t cid[2];
+
+		if(!c_snapshot_is_ctxt_saved(comp, context->cid))
+		{
+			rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+			           "context with CID %zu is not exported", context->cid);
+			continue;
+		}
+		if((rohc_buf_avail_len(*snapshot) - snapshot->len) < sizeof(cid))
+		{
+			goto too_small;
+		}
+		cid[0] = (context->cid >> 8) & 0xff;
+		cid[1] = context->cid & 0xff;
+		rohc_buf_append(snapshot, cid, sizeof(cid));
+		if(!c_snapshot_write_ctxt(comp, context->cid, snapshot))
+		{
+			goto too_small;
+		}
+		ctxts_nr++;
+	}
+	c_snapshot_write_ctxts_nr(snapshot, hdr_offset, ctxts_nr);
+
+	/* the snapshot contains all the changes */
+	memset(comp->ctxts_dirty, 0, (comp->medium.max_cid + 8) / 8);
+
+	rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+	           "%u context(s) exported in %zu bytes", ctxts_nr,
+	           snapshot->len - hdr_offset);
+	return true;
+
+too_small:
+	rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+	             "failed to export contexts: the %zu-byte buffer is too small",
+	             snapshot->max_len);
+	snapshot->len = hdr_offset;
+error:
+	return false;
+}
+
+
+/**
+ * @brief Import the compression contexts from a snapshot
+ *
+ * Every context of the snapshot is rebuilt from the headers of the last
+ * packet it compressed: the headers are compressed once again to fill the
+ * context, then the context is put back in the mode and state it was
+ * exported in, with the same Master Sequence Number. The next packets of
+ * the flows are thus compressed as if the compressor that exported the
+ * contexts went on.
+ *
+ * The compressor shall have the same CID type and MAX_CID as the one that
+ * exported the snapshot, and it shall have no context in use. The contexts
+ * that cannot be rebuilt, for example because their profile is not enabled,
+ * are skipped: their flows start over in IR state.
+ *
+ * @param comp     The ROHC compressor
+ * @param snapshot  The snapshot created by \ref rohc_comp_export_contexts
+ * @return          true if the snapshot was successfully imported,
+ *                  false if the snapshot is malformed or does not match
+ *                  the compressor
+ *
+ * @ingroup rohc_comp
+ *
+ * @see rohc_comp_export_contexts
+ */
+bool rohc_comp_import_contexts(struct rohc_comp *const comp,
+                               const struct rohc_buf snapshot)
+{
+	struct rohc_buf remain_data = snapshot;
+	uint8_t *pkt_mem = NULL;
+	uint32_t ctxts_nr;
+	uint32_t i;
+
+	if(comp == NULL)
+	{
+		goto error;
+	}
+	if(comp->num_contexts_used > 0)
+	{
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		             "failed to import contexts: %zu context(s) already in use",
+		             comp->num_contexts_used);
+		goto error;
+	}
+	if(!c_snapshot_parse_hdr(comp, &remain_data, ROHC_COMP_SNAPSHOT_MAGIC,
+	                         &ctxts_nr))
+	{
+		goto error;
+	}
+
+	pkt_mem = rohc_malloc(0xffff * 2);
+	if(pkt_mem == NULL)
+	{
+		rohc_error(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		           "failed to import contexts: no memory for packets");
+		goto error;
+	}
+
+	for(i = 0; i < ctxts_nr; i++)
+	{
+		rohc_cid_t cid;
+
+		if(remain_data.len < 2)
+		{
+			goto malformed;
+		}
+		cid = (rohc_buf_byte_at(remain_data, 0) << 8) |
+		      rohc_buf_byte_at(remain_data, 1);
+		rohc_buf_pull(&remain_data, 2);
+
+		if(!c_snapshot_read_ctxt(comp, cid, &remain_data, pkt_mem))
+		{
+			goto malformed;
+		}
+	}
+
+	c_chain_unused_contexts(comp);
+	rohc_free(pkt_mem);
+
+	rohc_info(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+	          "%zu context(s) imported", comp->num_contexts_used);
+	return true;
+
+malformed:
+	rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+	             "failed to import contexts: snapshot is malformed");
+	for(i = c_next_used_cid(comp, 0); i <= comp->medium.max_cid;
+	    i = c_next_used_cid(comp, i + 1))
+	{
+		c_destroy_context(comp, c_ctxt_at(comp, i));
+	}
+	c_chain_unused_contexts(comp);
+	rohc_free(pkt_mem);
+error:
+	return false;
+}
+
+
+/**
+ * @brief Export the compression contexts modified since the last export
+ *
+ * The change log is much smaller than a full snapshot when only a few flows
+ * are active, so it may be exported often to keep a standby compressor
+ * up-to-date. It contains the bitmap of the CIDs modified since the last
+ * call to \ref rohc_comp_export_changes or \ref rohc_comp_export_contexts,
+ * then one entry per modified CID in the CID order: either the context as
+ * in the snapshots, or an empty entry if the context was destroyed or went
+ * back to the IR state.
+ *
+ * The change log is appended to the given buffer. If the buffer is too
+ * small, nothing is exported and the modified contexts are kept for the
+ * next call.
+ *
+ * @param comp         The ROHC compressor
+ * @param[out] changes  The buffer where to append the change log
+ * @return              true if the change log was successfully exported,
+ *                      false if the feature is disabled or the buffer
+ *                      is too small
+ *
+ * @ingroup rohc_comp
+ *
+ * @see rohc_comp_import_changes
+ */
+bool rohc_comp_export_changes(struct rohc_comp *const comp,
+                              struct rohc_buf *const changes)
+{
+	const size_t bitmap_len = (comp != NULL ? (comp->medium.max_cid + 8) / 8 : 0);
+	uint32_t ctxts_nr = 0;
+	size_t hdr_offset;
+	size_t i;
+
+	if(comp == NULL)
+	{
+		goto error;
+	}
+	if(!c_snapshot_write_hdr(comp, changes, ROHC_COMP_CHANGES_MAGIC))
+	{
+		goto error;
+	}
+	hdr_offset = changes->len - ROHC_COMP_SNAPSHOT_HDR_LEN;
+
+	/* the bitmap of the modified CIDs */
+	if((rohc_buf_avail_len(*changes) - changes->len) < bitmap_len)
+	{
+		goto too_small;
+	}
+	rohc_buf_append(changes, comp->ctxts_dirty, bitmap_len);
+
+	/* the modified contexts, skip quickly the CIDs not modified */
+	for(i = 0; i < bitmap_len; i++)
+	{
+		size_t bit;
+
+		if(comp->ctxts_dirty[i] == 0)
+		{
+			continue;
+		}
+		for(bit = 0; bit < 8; bit++)
+		{
+			if((comp->ctxts_dirty[i] & (1 << bit)) != 0)
+			{
+				if(!c_snapshot_write_ctxt(comp, i * 8 + bit, changes))
+				{
+					goto too_small;
+				}
+				ctxts_nr++;
+			}
+		}
+	}
+	c_snapshot_write_ctxts_nr(changes, hdr_offset, ctxts_nr);
+
+	memset(comp->ctxts_dirty, 0, bitmap_len);
+
+	rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+	           "%u modified context(s) exported in %zu bytes", ctxts_nr,
+	           changes->len - hdr_offset);
+	return true;
+
+too_small:
+	rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+	             "failed to export changes: the %zu-byte buffer is too small",
+	             changes->max_len);
+	changes->len = hdr_offset;
+error:
+	return false;
+}
+
+
+/**
+ * @brief Apply a change log to the compression contexts
+ *
+ * The contexts of the change log replace the contexts with the same CIDs,
+ * the empty entries destroy them. The compressor shall have imported the
+ * snapshot and all the previous change logs of the same compressor, in
+ * order.
+ *
+ * @param comp     The ROHC compressor
+ * @param changes  The change log created by \ref rohc_comp_export_changes
+ * @return         true if the change log was successfully applied,
+ *                 false if the change log is malformed or does not match
+ *                 the compressor
+ *
+ * @ingroup rohc_comp
+ *
+ * @see rohc_comp_export_changes
+ */
+bool rohc_comp_import_changes(struct rohc_comp *const comp,
+                              const struct rohc_buf changes)
+{
+	const size_t bitmap_len = (comp != NULL ? (comp->medium.max_cid + 8) / 8 : 0);
+	struct rohc_buf remain_data = changes;
+	const uint8_t *bitmap;
+	uint8_t *pkt_mem = NULL;
+	uint32_t ctxts_nr;
+	uint32_t bits_nr = 0;
+	size_t i;
+
+	if(comp == NULL)
+	{
+		goto error;
+	}
+	if(!c_snapshot_parse_hdr(comp, &remain_data, ROHC_COMP_CHANGES_MAGIC,
+	                         &ctxts_nr))
+	{
+		goto error;
+	}
+	if(remain_data.len < bitmap_len)
+	{
+		goto malformed;
+	}
+	bitmap = rohc_buf_data(remain_data);
+	for(i = 0; i < bitmap_len; i++)
+	{
+		bits_nr += __builtin_popcount(bitmap[i]);
+	}
+	if(bits_nr != ctxts_nr ||
+	   (bitmap[bitmap_len - 1] >> ((comp->medium.max_cid + 1) % 8 == 0 ?
+	                               8 : (comp->medium.max_cid + 1) % 8)) != 0)
+	{
+		goto malformed;
+	}
+	rohc_buf_pull(&remain_data, bitmap_len);
+
+	pkt_mem = rohc_malloc(0xffff * 2);
+	if(pkt_mem == NULL)
+	{
+		rohc_error(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		           "failed to import changes: no memory for packets");
+		goto error;
+	}
+
+	for(i = 0; i < bitmap_len; i++)
+	{
+		size_t bit;
+
+		for(bit = 0; bit < 8; bit++)
+		{
+			if((bitmap[i] & (1 << bit)) != 0 &&
+			   !c_snapshot_read_ctxt(comp, i * 8 + bit, &remain_data, pkt_mem))
+			{
+				goto malformed;
+			}
+		}
+	}
+
+	c_chain_unused_contexts(comp);
+	rohc_free(pkt_mem);
+
+	rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+	           "%u modified context(s) imported", ctxts_nr);
+	return true;
+
+malformed:
+	/* the contexts already modified are kept, the next snapshot shall be
+	 * imported in a new compressor */
+	rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+	             "failed to import changes: change log is malformed");
+	c_chain_unused_contexts(comp);
+	rohc_free(pkt_mem);
+error:
+	return false;
+}
+
+
+/**
+ * @brief Move one compression context to another compressor
+ *
+ * The flow of the context goes on in the new compressor without starting
+ * over in IR state, for example when flows are rebalanced between several
+ * compressors that share the same ROHC channel with distinct CID ranges.
+ * The context is rebuilt in the new compressor from the headers of the last
+ * packet it compressed, as with \ref rohc_comp_import_contexts, then it is
+ * destroyed in the given compressor.
+ *
+ * The context keeps its CID if the CID is free and in the CID range of the
+ * new compressor. Otherwise the context takes the first free CID of the new
+ * compressor, and it goes back to IR state: the decompressor knows nothing
+ * about the new CID yet.
+ *
+ * The CID of the context of one flow is given by
+ * \ref rohc_comp_get_last_packet_info2 after one of its packets.
+ *
+ * @param comp         The ROHC compressor that owns the context, with the
+ *                      \ref ROHC_COMP_FEATURE_SNAPSHOTS feature enabled
+ * @param cid           The CID of the context to move
+ * @param new_comp      The ROHC compressor to move the context to, with the
+ *                      same CID type and the profile of the context enabled
+ * @param[out] new_cid  The CID of the context in the new compressor
+ * @return              true if the context was moved, false if the context
+ *                      cannot be moved and shall start over in the new
+ *                      compressor
+ *
+ * @ingroup rohc_comp
+ */
+bool rohc_comp_migrate_context(struct rohc_comp *const comp,
+                               const rohc_cid_t cid,
+                               struct rohc_comp *const new_comp,
+                               rohc_cid_t *const new_cid)
+{
+	const struct rohc_comp_ctxt_snapshot *saved;
+	const struct rohc_comp_ctxt *context;
+	struct rohc_comp_ctxt *unused;
+	uint8_t *pkt_mem = NULL;
+	rohc_cid_t cid_to_use;
+	uint32_t msn;
+
+	if(comp == NULL)
+	{
+		goto error;
+	}
+	if(new_comp == NULL || new_comp == comp || new_cid == NULL)
+	{
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		             "failed to migrate context: invalid parameters");
+		goto error;
+	}
+	if(cid > comp->medium.max_cid || !rohc_bitmap_test(comp->ctxts_used, cid))
+	{
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		             "failed to migrate context: no context with CID %zu", cid);
+		goto error;
+	}
+	if(comp->ctxts_snapshots == NULL || !c_snapshot_is_ctxt_saved(comp, cid))
+	{
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		             "failed to migrate context: context with CID %zu is not "
+		             "saved", cid);
+		goto error;
+	}
+	if(new_comp->medium.cid_type != comp->medium.cid_type)
+	{
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		             "failed to migrate context: CID types do not match");
+		goto error;
+	}
+	context = c_ctxt_at(comp, cid);
+	saved = &comp->ctxts_snapshots[cid];
+
+	/* keep the CID if possible, take the first free CID otherwise */
+	if(cid >= new_comp->cid_first && cid <= new_comp->cid_last &&
+	   !rohc_bitmap_test(new_comp->ctxts_used, cid))
+	{
+		cid_to_use = cid;
+	}
+	else if(!c_peek_unused_context(new_comp, &unused))
+	{
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		             "failed to migrate context: no memory for the contexts "
+		             "of the new compressor");
+		goto error;
+	}
+	else if(unused != NULL)
+	{
+		cid_to_use = unused->cid;
+	}
+	else
+	{
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		             "failed to migrate context: no free CID in the new "
+		             "compressor");
+		goto error;
+	}
+
+	pkt_mem = rohc_malloc(0xffff * 2);
+	if(pkt_mem == NULL)
+	{
+		rohc_error(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		           "failed to migrate context: no memory for packets");
+		goto error;
+	}
+	msn = (context->profile->get_msn != NULL ?
+	       context->profile->get_msn(context) : 0);
+	if(!c_import_context(new_comp, cid_to_use, context->profile->id,
+	                     context->mode, context->state, &msn, saved->hdrs,
+	                     saved->hdrs_len, saved->pkt_len, pkt_mem))
+	{
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		             "failed to migrate context: failed to rebuild context with "
+		             "CID %zu in the new compressor", cid);
+		c_chain_unused_contexts(new_comp);
+		goto free_mem;
+	}
+	c_chain_unused_contexts(new_comp);
+	rohc_free(pkt_mem);
+
+	/* the decompressor knows nothing about a new CID */
+	if(cid_to_use != cid &&
+	   !rohc_comp_reinit_context(c_ctxt_at(new_comp, cid_to_use)))
+	{
+		rohc_warning(new_comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		             "failed to force re-initialization for CID %zu",
+		             cid_to_use);
+	}
+
+	rohc_info(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+	          "context with CID %zu migrated to CID %zu of another compressor",
+	          cid, cid_to_use);
+	c_destroy_context(comp, c_ctxt_at(comp, cid));
+	*new_cid = cid_to_use;
+
+	return true;
+
+free_mem:
+	rohc_free(pkt_mem);
+error:
+	return false;
+}
+
+
+/**
+ * @brief Create one compression context from the template of a known flow
+ *
+ * The context of a known, long-lived flow is created before the first
+ * packet of the flow, for example at startup from an out-of-band
+ * configuration. The context is built from the template as if the template
+ * was compressed enough times to leave the IR state: the first packets of
+ * the flow are compressed right away.
+ *
+ * The decompressor shall know the context too: the IR packet that
+ * describes the context is returned for the decompressor, see
+ * \ref rohc_decomp_prewarm_context. The IR packet shall be delivered to the
+ * decompressor before the first packets of the flow, on the same channel or
+ * out of band.
+ *
+ * The context is created in Unidirectional mode, as a new context would be.
+ *
+ * @param comp         The ROHC compressor
+ * @param cid           The CID of the context, shall be free and in the CID
+ *                      range of the compressor
+ * @param profile_id    The profile of the context
+ * @param template_pkt  The template of the flow: one uncompressed packet of
+ *                      the flow
+ * @param[out] rohc_ir  The IR packet that describes the context, it is
+ *                      appended to the given buffer
+ * @return              true if the context was created, false otherwise
+ *
+ * @ingroup rohc_comp
+ */
+bool rohc_comp_prewarm_context(struct rohc_comp *const comp,
+                               const rohc_cid_t cid,
+                               const rohc_profile_t profile_id,
+                               const struct rohc_buf template_pkt,
+                               struct rohc_buf *const rohc_ir)
+{
+	struct rohc_comp_ctxt *context;
+	uint8_t *pkt_mem = NULL;
+	struct net_pkt ip_pkt;
+	rohc_packet_t packet_type;
+	size_t payload_offset;
+	size_t payload_len;
+	int ir_hdr_len;
+
+	if(comp == NULL)
+	{
+		goto error;
+	}
+	if(rohc_buf_is_malformed(template_pkt) || rohc_buf_is_empty(template_pkt) ||
+	   template_pkt.len > 0xffff ||
+	   rohc_ir == NULL || rohc_buf_is_malformed(*rohc_ir))
+	{
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		             "failed to prewarm context: invalid parameters");
+		goto error;
+	}
+	if(cid < comp->cid_first || cid > comp->cid_last ||
+	   rohc_bitmap_test(comp->ctxts_used, cid))
+	{
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		             "failed to prewarm context: CID %zu is not free or not in "
+		             "the CID range", cid);
+		goto error;
+	}
+
+	pkt_mem = rohc_malloc(0xffff * 2);
+	if(pkt_mem == NULL)
+	{
+		rohc_error(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		           "failed to prewarm context: no memory for packets");
+		goto error;
+	}
+	if(!c_import_context(comp, cid, profile_id, ROHC_U_MODE,
+	                     ROHC_COMP_STATE_SO, NULL, rohc_buf_data(template_pkt),
+	                     template_pkt.len, template_pkt.len, pkt_mem))
+	{
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		             "failed to prewarm context: failed to build context with "
+		             "CID %zu from template", cid);
+		c_chain_unused_contexts(comp);
+		goto free_mem;
+	}
+	c_chain_unused_contexts(comp);
+	rohc_free(pkt_mem);
+	context = c_ctxt_at(comp, cid);
+
+	/* describe the context for the decompressor with one IR packet that
+	 * carries the template */
+	if(!c_parse_packet(comp, template_pkt, true, &ip_pkt))
+	{
+		goto destroy_ctxt;
+	}
+	rohc_comp_change_state(context, ROHC_COMP_STATE_IR);
+	ir_hdr_len =
+		context->profile->encode(context, &ip_pkt,
+		                         rohc_buf_data_at(*rohc_ir, rohc_ir->len),
+		                         rohc_buf_avail_len(*rohc_ir) - rohc_ir->len,
+		                         &packet_type, &payload_offset);
+	rohc_comp_change_state(context, ROHC_COMP_STATE_SO);
+	if(ir_hdr_len < 0 || packet_type != ROHC_PACKET_IR)
+	{
+		rohc_comp_warn(context, "failed to prewarm context: failed to build "
+		               "the IR packet");
+		goto destroy_ctxt;
+	}
+	payload_len = template_pkt.len - payload_offset;
+	if((rohc_buf_avail_len(*rohc_ir) - rohc_ir->len) <
+	   (ir_hdr_len + payload_len))
+	{
+		rohc_comp_warn(context, "failed to prewarm context: the %zu-byte "
+		               "buffer is too small for the IR packet",
+		               rohc_ir->max_len);
+		goto destroy_ctxt;
+	}
+	rohc_ir->len += ir_hdr_len;
+	rohc_buf_append(rohc_ir, rohc_buf_data_at(template_pkt, payload_offset),
+	                payload_len);
+
+	if(comp->ctxts_snapshots != NULL)
+	{
+		c_save_snapshot(comp, context, template_pkt, payload_offset);
+	}
+
+	rohc_info(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+	          "context with CID %zu prewarmed with profile 0x%04x", cid,
+	          profile_id);
+	return true;
+
+destroy_ctxt:
+	c_destroy_context(comp, context);
+	c_chain_unused_contexts(comp);
+	goto error;
+free_mem:
+	rohc_free(pkt_mem);
+error:
+	return false;
+}
+
+
+/**
+ * @brief Get the handle of the context of the last compressed packet
+ *
+ * The handle may then be given to \ref rohc_compress_with_ctxt to compress
+ * the next packets of the same flow without looking for their context.
+ *
+ * @param comp         The ROHC compressor
+ * @param[out] handle  The handle of the context of the last compressed packet
+ * @return             true if the handle was successfully retrieved,
+ *                     false if no packet was compressed yet or if its context
+ *                     was destroyed since
+ *
+ * @ingroup rohc_comp
+ *
+ * @see rohc_compress_with_ctxt
+ */
+bool rohc_comp_get_last_ctxt_handle(const struct rohc_comp *const comp,
+                                    rohc_comp_ctxt_handle_t *const handle)
+{
+	if(comp == NULL)
+	{
+		goto error;
+	}
+
+	if(handle == NULL)
+	{
+		rohc_error(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		           "given handle is NULL");
+		goto error;
+	}
+
+	if(comp->last_context == NULL || !comp->last_context->used)
+	{
+		rohc_error(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		           "last context found in compressor is not valid");
+		goto error;
+	}
+
+	*handle = (((rohc_comp_ctxt_handle_t) comp->last_context->gen) << 32) |
+	          ((rohc_comp_ctxt_handle_t) comp->last_context->cid);
+
+	return true;
+
+error:
+	return false;
+}
+
+
+/**
+ * @brief Get some information about the last compressed packet
+ *
+ * Get some information about the last compressed packet.
+ *
+ * To use the function, call it with a pointer on a pre-allocated
+ * \ref rohc_comp_last_packet_info2_t structure with the \e version_major and
+ * \e version_minor fields set to one of the following supported versions:
+ *  - Major 0, minor 0
+ *
+ * See the \ref rohc_comp_last_packet_info2_t structure for details about
+ * fields that are supported in the above versions.
+ *
+ * @param comp         The ROHC compressor to get information from
+ * @param[in,out] info  The structure where information will be stored
+ * @return              true in case of success, false otherwise
+ *
+ * @ingroup rohc_comp
+ *
+ * @see rohc_comp_last_packet_info2_t
+ */
+bool rohc_comp_get_last_packet_info2(const struct rohc_comp *const comp,
+                                     rohc_comp_last_packet_info2_t *const info)
+{
+	const struct rohc_comp_ctxt_stats *stats;
+
+	if(comp == NULL)
+	{
+		goto error;
+	}
+
+	if(comp->last_context == NULL)
+	{
+		rohc_error(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		           "last context found in compressor is not valid");
+		goto error;
+	}
+
+	if(info == NULL)
+	{
+		rohc_error(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		           "structure for last packet information is not valid");
+		goto error;
+	}
+
+	stats = c_ctxt_stats_at(comp, comp->last_context->cid);
+
+	/* check compatibility version */
+	if(info->version_major == 0)
+	{
+		/* base fields for major version 0 */
+		info->context_id = comp->last_context->cid;
+		info->is_context_init = (comp->last_context->num_sent_packets == 1);
+		info->context_mode = comp->last_context->mode;
+		info->context_state = comp->last_context->state;
+		info->context_used = (comp->last_context->used ? true : false);
+		info->profile_id = comp->last_context->profile->id;
+		info->packet_type = stats->packet_type;
+		info->total_last_uncomp_size = stats->total_last_uncompressed_size;
+		info->header_last_uncomp_size = stats->header_last_uncompressed_size;
+		info->total_last_comp_size = stats->total_last_compressed_size;
+		info->header_last_comp_size = stats->header_last_compressed_size;
+
+		/* new fields added by minor versions */
+		if(info->version_minor > 0)
+		{
+			rohc_error(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+			           "unsupported minor version (%u) of the structure for "
+			           "last packet information", info->version_minor);
+			goto error;
+		}
+	}
+	else
+	{
+		rohc_error(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		           "unsupported major version (%u) of the structure for last "
+		           "packet information", info->version_major);
+		goto error;
+	}
+
+	return true;
+
+error:
+	return false;
+}
+
+
+/**
+ * @brief Get some general information about the compressor
+ *
+ * Get some general information about the compressor.
+ *
+ * To use the function, call it with a pointer on a pre-allocated
+ * \ref rohc_comp_general_info_t structure with the \e version_major and
+ * \e version_minor fields set to one of the following supported versions:
+ *  - Major 0, minor 0
+ *  - Major 0, minor 1
+ *  - Major 0, minor 2
+ *  - Major 0, minor 3
+ *
+ * See the \ref rohc_comp_general_info_t structure for details about fields
+ * that are supported in the above versions.
+ *
+ * @param comp         The ROHC compressor to get information from
+ * @param[in,out] info  The structure where information will be stored
+ * @return              true in case of success, false otherwise
+ *
+ * @ingroup rohc_comp
+ *
+ * @see rohc_comp_general_info_t
+ */
+bool rohc_comp_get_general_info(const struct rohc_comp *const comp,
+                                rohc_comp_general_info_t *const info)
+{
+	if(comp == NULL)
+	{
+		goto error;
+	}
+
+	if(info == NULL)
+	{
+		rohc_error(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		           "structure for general information is not valid");
+		goto error;
+	}
+
+	/* check compatibility version */
+	if(info->version_major == 0)
+	{
+		/* base fields for major version 0 */
+		info->contexts_nr = comp->num_contexts_used;
+		info->packets_nr = comp->num_packets;
+		info->uncomp_bytes_nr = comp->total_uncompressed_size;
+		info->comp_bytes_nr = comp->total_compressed_size;
+
+		/* new fields added by minor versions */
+		switch(info->version_minor)
+		{
+			case 0:
+				/* nothing to add */
+				break;
+			case 1:
+				/* new fields in 0.1 */
+				info->packets_nr64 = comp->num_packets;
+				info->uncomp_bytes_nr64 = comp->total_uncompressed_size;
+				info->comp_bytes_nr64 = comp->total_compressed_size;
+				break;
+			case 2:
+				/* new fields in 0.1 and 0.2 */
+				info->packets_nr64 = comp->num_packets;
+				info->uncomp_bytes_nr64 = comp->total_uncompressed_size;
+				info->comp_bytes_nr64 = comp->total_compressed_size;
+				info->reinit_pending_nr = comp->reinit.pending_nr;
+				info->reinit_total_nr = comp->reinit.total_nr;
+				break;
+			case 3:
+				/* new fields in 0.1, 0.2 and 0.3 */
+				info->packets_nr64 = comp->num_packets;
+				info->uncomp_bytes_nr64 = comp->total_uncompressed_size;
+				info->comp_bytes_nr64 = comp->total_compressed_size;
+				info->reinit_pending_nr = comp->reinit.pending_nr;
+				info->reinit_total_nr = comp->reinit.total_nr;
+				info->ctxts_hits_nr = comp->ctxts_hits_nr;
+				info->ctxts_misses_nr = comp->ctxts_misses_nr;
+				info->ctxts_recycled_nr = comp->ctxts_recycled_nr;
+				break;
+			case 4:
+				/* new fields in 0.1, 0.2, 0.3 and 0.4 */
+				info->packets_nr64 = comp->num_packets;
+				info->uncomp_bytes_nr64 = comp->total_uncompressed_size;
+				info->comp_bytes_nr64 = comp->total_compressed_size;
+				info->reinit_pending_nr = comp->reinit.pending_nr;
+				info->reinit_total_nr = comp->reinit.total_nr;
+				info->ctxts_hits_nr = comp->ctxts_hits_nr;
+				info->ctxts_misses_nr = comp->ctxts_misses_nr;
+				info->ctxts_recycled_nr = comp->ctxts_recycled_nr;
+				info->ctxts_mru_hits_nr = comp->ctxts_mru_hits_nr;
+				break;
+			default:
+				rohc_error(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+				           "unsupported minor version (%u) of the structure for "
+				           "general information", info->version_minor);
+				goto error;
+		}
+	}
+	else
+	{
+		rohc_error(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		           "unsupported major version (%u) of the structure for "
+		           "general information", info->version_major);
+		goto error;
+	}
+
+	return true;
+
+error:
+	return false;
+}
+
+
+/**
+ * @brief Get the statistics of all the compression contexts in use
+ *
+ * Copy the statistics of all the compression contexts in use into the given
+ * array, in the order of their Context IDs (CID).
+ *
+ * The function does not take any lock and does not emit any trace, so it may
+ * be called by one monitoring thread while another thread compresses packets
+ * with the compressor: the statistics of every context are consistent, but
+ * the contexts are not all copied at the same instant. The compressor shall
+ * not be destroyed during the call.
+ *
+ * @param comp           The ROHC compressor to get statistics from
+ * @param[out] stats     The array where to store the statistics
+ * @param stats_max      The max number of entries in the array
+ * @param[out] stats_nr  The number of entries written in the array
+ * @return               true if the statistics of all the contexts in use
+ *                       were copied,
+ *                       false if the array is too small or if an error occurs
+ *
+ * @ingroup rohc_comp
+ *
+ * @see rohc_comp_ctxt_stats_t
+ */
+bool rohc_comp_get_ctxts_stats(const struct rohc_comp *const comp,
+                               rohc_comp_ctxt_stats_t *const stats,
+                               const size_t stats_max,
+                               size_t *const stats_nr)
+{
+	rohc_cid_t cid;
+
+	if(comp == NULL || stats == NULL || stats_nr == NULL)
+	{
+		goto error;
+	}
+	*stats_nr = 0;
+
+	/* the contexts destroyed meanwhile are skipped below */
+	for(cid = c_next_used_cid(comp, 0); cid <= comp->medium.max_cid;
+	    cid = c_next_used_cid(comp, cid + 1))
+	{
+		/* the chunk of the context is published before the context is used */
+		const struct rohc_comp_ctxts_chunk *const chunk =
+			__atomic_load_n(&comp->ctxts_chunks[cid / ROHC_COMP_CTXTS_CHUNK_LEN],
+			                __ATOMIC_ACQUIRE);
+		const struct rohc_comp_ctxt_stats *ctxt_stats;
+		rohc_comp_ctxt_stats_t copy;
+		rohc_seqcount_t seq;
+		bool used;
+
+		if(chunk == NULL)
+		{
+			continue;
+		}
+		ctxt_stats = &chunk->stats[cid % ROHC_COMP_CTXTS_CHUNK_LEN];
+
+		do
+		{
+			seq = rohc_seqcount_read_begin(&ctxt_stats->seq);
+			used = ctxt_stats->used;
+			copy.cid = cid;
+			copy.profile_id = ctxt_stats->profile_id;
+			copy.mode = ctxt_stats->mode;
+			copy.state = ctxt_stats->state;
+			copy.packet_type = ctxt_stats->packet_type;
+			copy.packets_nr = ctxt_stats->packets_nr;
+			copy.uncomp_bytes_nr = ctxt_stats->total_uncompressed_size;
+			copy.comp_bytes_nr = ctxt_stats->total_compressed_size;
+			copy.uncomp_hdr_bytes_nr = ctxt_stats->header_uncompressed_size;
+			copy.comp_hdr_bytes_nr = ctxt_stats->header_compressed_size;
+		}
+		while(rohc_seqcount_read_retry(&ctxt_stats->seq, seq));
+
+		if(!used)
+		{
+			continue;
+		}
+		if((*stats_nr) >= stats_max)
+		{
+			goto error;
+		}
+		stats[*stats_nr] = copy;
+		(*stats_nr)++;
+	}
+
+	return true;
+
+error:
+	return false;
+}
+
+
+/**
+ * @brief Get the histogram of the durations of one compression phase
+ *
+ * Get the histogram of the durations of one phase of the compression of the
+ * packets of the given type. The durations are measured only if the library
+ * was built with the --enable-rohc-timings configure option and if the
+ * feature \ref ROHC_COMP_FEATURE_TIMINGS is enabled.
+ *
+ * @param comp         The ROHC compressor to get timings from
+ * @param packet_type  The type of ROHC packets to get timings for
+ * @param phase        The compression phase to get timings for
+ * @param[out] histo   The histogram of the durations
+ * @return             true if the histogram was copied,
+ *                     false if the library was built without timings (the
+ *                     histogram is then emptied) or if an error occurs
+ *
+ * @ingroup rohc_comp
+ *
+ * @see rohc_comp_set_features
+ */
+bool rohc_comp_get_timings(const struct rohc_comp *const comp,
+                           const rohc_packet_t packet_type,
+                           const rohc_comp_phase_t phase,
+                           rohc_timings_histo_t *const histo)
+{
+	if(comp == NULL)
+	{
+		goto error;
+	}
+	if(packet_type >= ROHC_PACKET_MAX || phase >= ROHC_COMP_PHASE_MAX)
+	{
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		             "packet type %d or compression phase %d is not valid",
+		             packet_type, phase);
+		goto error;
+	}
+	if(histo == NULL)
+	{
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		             "given histogram is NULL");
+		goto error;
+	}
+
+#ifdef ROHC_TIMINGS
+	*histo = comp->timings[packet_type][phase];
+	return true;
+#else
+	/* no duration was measured */
+	memset(histo, 0, sizeof(rohc_timings_histo_t));
+	rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+	             "library was built without support for timings");
+#endif
+
+error:
+	return false;
+}
+
+
+/**
+ * @brief Get the histogram of the durations of one compression phase per profile
+ *
+ * Get the histogram of the durations of one phase of the compression of the
+ * packets compressed by the contexts of the given profile. The durations are
+ * measured only if the library was built with the --enable-rohc-timings
+ * configure option and if the feature \ref ROHC_COMP_FEATURE_TIMINGS is
+ * enabled.
+ *
+ * The duration of the handling of the feedback items is recorded per profile
+ * only: \ref rohc_comp_get_timings always returns an empty histogram for
+ * the \ref ROHC_COMP_PHASE_FEEDBACK phase.
+ *
+ * @param comp        The ROHC compressor to get timings from
+ * @param profile     The profile to get timings for
+ * @param phase       The compression phase to get timings for
+ * @param[out] histo  The histogram of the durations
+ * @return            true if the histogram was copied,
+ *                    false if the library was built without timings (the
+ *                    histogram is then emptied) or if an error occurs
+ *
+ * @ingroup rohc_comp
+ *
+ * @see rohc_comp_set_features
+ */
+bool rohc_comp_get_profile_timings(const struct rohc_comp *const comp,
+                                   const rohc_profile_t profile,
+                                   const rohc_comp_phase_t phase,
+                                   rohc_timings_histo_t *const histo)
+{
+	if(comp == NULL)
+	{
+		goto error;
+	}
+	if(profile >= ROHC_PROFILE_MAX || phase >= ROHC_COMP_PHASE_MAX)
+	{
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		             "profile 0x%04x or compression phase %d is not valid",
+		             profile, phase);
+		goto error;
+	}
+	if(histo == NULL)
+	{
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		             "given histogram is NULL");
+		goto error;
+	}
+
+#ifdef ROHC_TIMINGS
+	{
+		/* the profiles the library does not implement never measure anything */
+		const size_t i = rohc_comp_profile_idx(profile);
+
+		if(i >= C_NUM_PROFILES)
+		{
+			memset(histo, 0, sizeof(rohc_timings_histo_t));
+		}
+		else
+		{
+			*histo = comp->timings_profiles[i][phase];
+		}
+	}
+	return true;
+#else
+	/* no duration was measured */
+	memset(histo, 0, sizeof(rohc_timings_histo_t));
+	rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+	             "library was built without support for timings");
+#endif
+
+error:
+	return false;
+}
+
+
+/**
+ * @brief Get the last records of the log of the compressed packets
+ *
+ * Copy the newest records of the log into the given array, oldest first.
+ * At most \e records_max records are copied, and no record is copied if the
+ * log is disabled.
+ *
+ * The function shall not be called while another thread compresses packets
+ * with the compressor.
+ *
+ * @param comp             The ROHC compressor
+ * @param[out] records     The array where to copy the records
+ * @param records_max      The max number of records in the array
+ * @param[out] records_nr  The number of records copied in the array
+ * @return                 true if the records were copied,
+ *                         false if an error occurs
+ *
+ * @ingroup rohc_comp
+ *
+ * @see rohc_comp_set_pkt_log
+ */
+bool rohc_comp_get_pkt_log(const struct rohc_comp *const comp,
+                           rohc_pkt_log_record_t *const records,
+                           const size_t records_max,
+                           size_t *const records_nr)
+{
+	if(comp == NULL || records == NULL || records_nr == NULL)
+	{
+		goto error;
+	}
+
+	rohc_pkt_log_copy(&comp->pkt_log, records, records_max, records_nr);
+
+	return true;
+
+error:
+	return false;
+}
+
+
+/**
+ * @brief Give a description for the given ROHC compression context state
+ *
+ * Give a description for the given ROHC compression context state.
+ *
+ * The descriptions are not part of the API. They may change between
+ * releases without any warning. Do NOT use them for other means that
+ * providing to users a textual description of compression context states
+ * used by the library. If unsure, ask on the mailing list.
+ *
+ * @param state  The compression context state to get a description for
+ * @return       A string that describes the given compression context state
+ *
+ * @ingroup rohc_comp
+ */
+const char * rohc_comp_get_state_descr(const rohc_comp_state_t state)
+{
+	switch(state)
+	{
+		case ROHC_COMP_STATE_IR:
+			return "IR";
+		case ROHC_COMP_STATE_FO:
+			return "FO";
+		case ROHC_COMP_STATE_SO:
+			return "SO";
+		case ROHC_COMP_STATE_UNKNOWN:
+		default:
+			return "no description";
+	}
+}
+
+
+/*
+ * Definitions of private functions
+ */
+
+
+/**
+ * @brief Find out a ROHC profile given a profile ID
+ *
+ * @param comp       The ROHC compressor
+ * @param profile_id The ID of the ROHC profile to find out
+ * @return           The ROHC profile if found, NULL otherwise
+ */
+static const struct rohc_comp_profile *
+	rohc_get_profile_from_id(const struct rohc_comp *comp,
+	                         const rohc_profile_t profile_id)
+{
+	const size_t i = rohc_comp_profile_idx(profile_id);
+
+	if(i >= C_NUM_PROFILES || !comp->enabled_profiles[i])
+	{
+		return NULL;
+	}
+
+	return rohc_comp_profiles[i];
+}
+
+
+/**
+ * @brief Find out the location of a ROHC profile given its profile ID
+ *
+ * @param profile_id  The ID of the ROHC profile to find out
+ * @return            The location of the profile in \ref rohc_comp_profiles,
+ *                    C_NUM_PROFILES if the profile is unknown
+ */
+static size_t rohc_comp_profile_idx(const rohc_profile_t profile_id)
+{
+	const unsigned int version = ((unsigned int) profile_id) >> 8;
+	const unsigned int octet = ((unsigned int) profile_id) & 0xff;
+
+	if(version > 1 || octet > ROHC_PROFILE_UDPLITE)
+	{
+		return C_NUM_PROFILES;
+	}
+	return rohc_comp_profiles_idx[version][octet];
+}
+
+
+/**
+ * @brief Find out a ROHC profile given an IP protocol ID
+ *
+ * @param comp    The ROHC compressor
+ * @param packet  The packet to find a compression profile for
+ * @return        The ROHC profile if found, NULL otherwise
+ */
+static const struct rohc_comp_profile *
+	c_get_profile_from_packet(struct rohc_comp *const comp,
+	                          const struct net_pkt *const packet)
+{
+	const struct net_hdr *const transport = packet->transport;
+	struct rohc_comp_classif *classif;
+	rohc_ctxt_key_t classif_hash = packet->key;
+	bool is_classif_final = true;
+	size_t i;
+
+	/* IPv4 fragments and non-IP packets are accepted by the Uncompressed
+	 * profile only: pass them through without trying the other profiles, and
+	 * without polluting the cache of classifications with their random
+	 * transport bytes */
+	if(comp->enabled_profiles[C_PROFILE_IDX_UNCOMP] &&
+	   (packet->outer_ip.version == IP_UNKNOWN ||
+	    (packet->outer_ip.version == IPV4 && ip_is_fragment(&packet->outer_ip))))
+	{
+		assert(rohc_comp_profiles[C_PROFILE_IDX_UNCOMP]->id ==
+		       ROHC_PROFILE_UNCOMPRESSED);
+		rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		           "IP fragment or non-IP packet, pass it through the "
+		           "Uncompressed profile");
+		return rohc_comp_profiles[C_PROFILE_IDX_UNCOMP];
+	}
+
+	/* the profile that was selected for the previous packets of the same
+	 * flow is tried first: the profiles before it are not tried again, so
+	 * the classification is made once per flow */
+	if(transport->data != NULL && transport->len >= sizeof(uint32_t))
+	{
+		uint32_t first_word;
+		memcpy(&first_word, transport->data, sizeof(uint32_t));
+		classif_hash = net_pkt_key_final(net_pkt_key_mix(classif_hash,
+		                                                 first_word));
+	}
+	classif = &comp->classif_cache[classif_hash &
+	                               (ROHC_COMP_CLASSIF_CACHE_SIZE - 1)];
+	if(classif->profile != NULL && classif->hash == classif_hash &&
+	   classif->profile->check_profile(comp, packet))
+	{
+		rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		           "profile '%s' (0x%04x) was already selected for the flow",
+		           rohc_get_profile_descr(classif->profile->id),
+		           classif->profile->id);
+		return classif->profile;
+	}
+
+	rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+	           "try to find the best profile for packet with transport "
+	           "protocol %u", transport->proto);
+
+	/* test all compression profiles */
+	for(i = 0; i < C_NUM_PROFILES; i++)
+	{
+		bool check_profile;
+
+		/* skip profile if the profile is not enabled */
+		if(!comp->enabled_profiles[i])
+		{
+			rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+			           "skip disabled profile '%s' (0x%04x)",
+			           rohc_get_profile_descr(rohc_comp_profiles[i]->id),
+			           rohc_comp_profiles[i]->id);
+			continue;
+		}
+
+		/* does the profile accept the packet? */
+		check_profile = rohc_comp_profiles[i]->check_profile(comp, packet);
+		if(!check_profile)
+		{
+			rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+			           "skip profile '%s' (0x%04x) because it does not match "
+			           "packet",rohc_get_profile_descr(rohc_comp_profiles[i]->id),
+			           rohc_comp_profiles[i]->id);
+			/* a profile that rejected the packet for another reason than its
+			 * transport protocol might accept the next packets of the flow */
+			if(rohc_comp_profiles[i]->protocol == 0 ||
+			   rohc_comp_profiles[i]->protocol == transport->proto)
+			{
+				is_classif_final = false;
+			}
+			continue;
+		}
+
+		/* the packet is compatible with the profile, let's go with it! Only
+		 * remember it for the flow if no profile with a higher priority may
+		 * accept the next packets of the flow */
+		if(is_classif_final)
+		{
+			classif->hash = classif_hash;
+			classif->profile = rohc_comp_profiles[i];
+		}
+		return rohc_comp_profiles[i];
+	}
+
+	return NULL;
+}
+
+
+/**
+ * @brief Forget all the profiles selected for the previous flows
+ *
+ * The cache of profile classifications shall be flushed every time the
+ * result of the classification may change, ie. when profiles are enabled
+ * or disabled, or when the RTP detection callback is changed.
+ *
+ * @param comp  The ROHC compressor
+ */
+static void c_classif_cache_flush(struct rohc_comp *const comp)
+{
+	size_t i;
+
+	for(i = 0; i < ROHC_COMP_CLASSIF_CACHE_SIZE; i++)
+	{
+		comp->classif_cache[i].hash = 0;
+		comp->classif_cache[i].profile = NULL;
+	}
+}
+
+
+/**
+ * @brief Create a compression context
+ *
+ * @param comp         The ROHC compressor
+ * @param profile       The profile to associate the context with
+ * @param packet        The packet to create a compression context for
+ * @param arrival_time  The time at which packet was received (0 if unknown,
+ *                      or to disable time-related features in ROHC protocol)
+ * @return              The compression context if successful, NULL otherwise
+ */
+static struct rohc_comp_ctxt *
+	c_create_context(struct rohc_comp *const comp,
+	                 const struct rohc_comp_profile *const profile,
+	                 const struct net_pkt *const packet,
+	                 const struct rohc_ts arrival_time)
+{
+	struct rohc_comp_ctxt *c;
+	rohc_cid_t cid_to_use;
+
+	assert(comp != NULL);
+	assert(profile != NULL);
+	assert(packet != NULL);
+
+	/* if all the contexts in the array are used:
+	 *   => recycle the context at the tail of the recycling list to make room
+	 * if at least one context in the array is not used:
+	 *   => pick the first unused context
+	 */
+	if(!c_peek_unused_context(comp, &c))
+	{
+		return NULL;
+	}
+	if(c == NULL)
+	{
+		/* all the contexts in the array were used, recycle the context that
+		 * the recycling policy and the admission control designate to make
+		 * some room */
+		struct rohc_comp_ctxt *const victim = c_recycle_victim(comp);
+
+		assert(comp->num_contexts_used > (comp->cid_last - comp->cid_first));
+		assert(victim != NULL);
+		rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		           "recycle %scontext (CID = %zu)",
+		           (victim->on_probation ? "probationary " : ""), victim->cid);
+		c_notify_ctxt_event(victim, ROHC_COMP_EVENT_CTXT_RECYCLE,
+		                    victim->state, victim->mode);
+		ROHC_PROBE2(comp_ctxt_recycle, victim->cid, victim->profile->id);
+		c_destroy_context(comp, victim);
+		assert(comp->ctxts_unused == victim);
+		c = victim;
+		comp->ctxts_recycled_nr++;
+	}
+	comp->ctxts_misses_nr++;
+
+	/* pick the first unused context */
+	assert(c->used == 0);
+	c_take_unused_context(comp, c);
+	cid_to_use = c->cid;
+	rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+	           "take the first unused context (CID = %zu)", cid_to_use);
+
+	/* initialize the previously found context */
+	if(!c_init_context(comp, c, profile, packet, arrival_time))
+	{
+		/* give the CID back to the unused contexts */
+		c->recycle_next = comp->ctxts_unused;
+		comp->ctxts_unused = c;
+		return NULL;
+	}
+	c_notify_ctxt_event(c, ROHC_COMP_EVENT_CTXT_CREATE, c->state, c->mode);
+
+	return c;
+}
+
+
+/**
+ * @brief Initialize an unused compression context for the given packet
+ *
+ * The context is not removed from the list of unused contexts, the caller
+ * is responsible for that.
+ *
+ * @param comp         The ROHC compressor
+ * @param context       The unused context to initialize
+ * @param profile       The profile to associate the context with
+ * @param packet        The packet to create a compression context for
+ * @param arrival_time  The time at which packet was received (0 if unknown,
+ *                      or to disable time-related features in ROHC protocol)
+ * @return              true if successful, false otherwise
+ */
+static bool c_init_context(struct rohc_comp *const comp,
+                           struct rohc_comp_ctxt *const context,
+                           const struct rohc_comp_profile *const profile,
+                           const struct net_pkt *const packet,
+                           const struct rohc_ts arrival_time)
+{
+	struct rohc_comp_ctxt *const c = context;
+
+	assert(c->used == 0);
+
+	c->ir_count = 0;
+	c->fo_count = 0;
+	c->so_count = 0;
+	c->go_back_fo_count = 0;
+	c->go_back_ir_count = 0;
+
+	c->num_sent_packets = 0;
+	c->reinit_pending = false;
+	c->sn_bits_nr = 0;
+
+	rohc_cid_code_init(&c->cid_code, comp->medium.cid_type, c->cid);
+	c->gen++;
+	if(c->gen == 0)
+	{
+		/* generation 0 is never used, see ROHC_COMP_CTXT_HANDLE_NONE */
+		c->gen++;
+	}
+	c->profile = profile;
+	c->key = c_get_ctxt_key(profile, packet);
+	c->flow_hash = c_get_flow_hash(profile, packet);
+	memcpy(&c->fprint, &packet->fprint, sizeof(struct net_pkt_fprint));
+	c->ip_layout = c_get_ip_layout(packet);
+
+	c->mode = ROHC_U_MODE;
+	c->state = ROHC_COMP_STATE_IR;
+
+	c->compressor = comp;
+
+	/* create profile-specific context */
+	if(!profile->create(c, packet))
+	{
+		return false;
+	}
+
+	/* if creation is successful, mark the context as used */
+	ROHC_PROBE2(comp_ctxt_create, c->cid, profile->id);
+	c->used = 1;
+	rohc_bitmap_set(comp->ctxts_used, c->cid);
+	c_reset_ctxt_stats(comp, c);
+	c->first_used = arrival_time.sec;
+	c->latest_used = arrival_time.sec;
+	assert(comp->num_contexts_used <= (comp->cid_last - comp->cid_first));
+	comp->num_contexts_used++;
+
+	/* make the context reachable by the packets of the same flow */
+	c_index_context(comp, c);
+	c_probation_add(comp, c);
+
+	rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+	           "context (CID = %zu) created (num_used = %zu)",
+	           c->cid, comp->num_contexts_used);
+	return true;
+}
+
+
+/**
+ * @brief Rebuild one compression context from its snapshot
+ *
+ * @param comp         The ROHC compressor
+ * @param cid          The CID of the context
+ * @param profile_id   The profile of the context
+ * @param mode         The mode the context was exported in
+ * @param state        The state the context was exported in
+ * @param msn          The Master Sequence Number of the last packet, NULL
+ *                     to keep the MSN chosen by the profile
+ * @param record_hdrs  The headers of the last packet
+ * @param hdrs_len     The length of the headers of the last packet
+ * @param pkt_len      The length of the last packet
+ * @param pkt_mem      The memory to rebuild the last packet and to compress
+ *                     it in (2 x 65535 bytes)
+ * @return             true if the context was rebuilt, false otherwise
+ */
+static bool c_import_context(struct rohc_comp *const comp,
+                             const rohc_cid_t cid,
+                             const rohc_profile_t profile_id,
+                             const rohc_mode_t mode,
+                             const rohc_comp_state_t state,
+                             const uint32_t *const msn,
+                             const uint8_t *const record_hdrs,
+                             const size_t hdrs_len,
+                             const size_t pkt_len,
+                             uint8_t *const pkt_mem)
+{
+	const struct rohc_ts time = { .sec = 0, .nsec = 0 };
+	const struct rohc_buf pkt = rohc_buf_init_full(pkt_mem, pkt_len, time);
+	struct rohc_comp_ctxt *context;
+	const struct rohc_comp_profile *profile;
+	struct net_pkt ip_pkt;
+	rohc_packet_t packet_type;
+	size_t payload_offset;
+	size_t i;
+
+	if(!c_alloc_ctxts_chunk(comp, cid / ROHC_COMP_CTXTS_CHUNK_LEN))
+	{
+		goto error;
+	}
+	context = c_ctxt_at(comp, cid);
+
+	/* rebuild the last packet, its payload is not needed */
+	memcpy(pkt_mem, record_hdrs, hdrs_len);
+	memset(pkt_mem + hdrs_len, 0, pkt_len - hdrs_len);
+	if(!c_parse_packet(comp, pkt, true, &ip_pkt))
+	{
+		goto error;
+	}
+
+	profile = rohc_get_profile_from_id(comp, profile_id);
+	if(profile == NULL || profile->id == ROHC_PROFILE_UNCOMPRESSED ||
+	   !profile->check_profile(comp, &ip_pkt))
+	{
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		             "profile 0x%04x is disabled or does not match the headers",
+		             profile_id);
+		goto error;
+	}
+
+	if(!c_init_context(comp, context, profile, &ip_pkt, time))
+	{
+		goto error;
+	}
+
+	/* compress the last packet again and again with the same MSN if any, until
+	 * the context considers that all the fields were transmitted enough times,
+	 * then resume in the mode and state of the exported context */
+	for(i = 0; i < ROHC_COMP_SNAPSHOT_WARMUP_NR; i++)
+	{
+		if(msn != NULL && profile->set_next_msn != NULL)
+		{
+			profile->set_next_msn(context, *msn);
+		}
+		if(profile->encode(context, &ip_pkt, pkt_mem + 0xffff, 0xffff,
+		                   &packet_type, &payload_offset) < 0)
+		{
+			rohc_comp_warn(context, "failed to compress the headers of the "
+			               "snapshot");
+			c_destroy_context(comp, context);
+			goto error;
+		}
+	}
+	rohc_comp_change_mode(context, mode);
+	rohc_comp_change_state(context, state);
+	context->num_sent_packets = ROHC_COMP_SNAPSHOT_WARMUP_NR;
+
+	/* the flow of the context already proved to be long-lived */
+	if(context->on_probation)
+	{
+		c_probation_admit(comp, context);
+	}
+
+	if(comp->ctxts_snapshots != NULL)
+	{
+		c_save_snapshot(comp, context, pkt, payload_offset);
+	}
+
+	rohc_comp_debug(context, "context imported in mode %d and state %d",
+	                context->mode, context->state);
+	return true;
+
+error:
+	return false;
+}
+
+
+/**
+ * @brief Append the header of a snapshot or of a change log
+ *
+ * The number of contexts is set to zero, it shall be written with
+ * \ref c_snapshot_write_ctxts_nr once known.
+ *
+ * @param comp    The ROHC compressor
+ * @param buf     The buffer where to append the header
+ * @param magic   The magic number of the snapshot or of the change log
+ * @return        true if the header was appended, false if the feature is
+ *                disabled or the buffer is too small
+ */
+static bool c_snapshot_write_hdr(const struct rohc_comp *const comp,
+                                 struct rohc_buf *const buf,
+                                 const char *const magic)
+{
+	uint8_t hdr[ROHC_COMP_SNAPSHOT_HDR_LEN];
+
+	if(buf == NULL || rohc_buf_is_malformed(*buf))
+	{
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		             "failed to export contexts: given buffer is malformed");
+		goto error;
+	}
+	if(comp->ctxts_snapshots == NULL)
+	{
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		             "failed to export contexts: feature SNAPSHOTS is not "
+		             "enabled");
+		goto error;
+	}
+	if((rohc_buf_avail_len(*buf) - buf->len) < ROHC_COMP_SNAPSHOT_HDR_LEN)
+	{
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		             "failed to export contexts: the %zu-byte buffer is too "
+		             "small", buf->max_len);
+		goto error;
+	}
+
+	memcpy(hdr, magic, 4);
+	hdr[4] = ROHC_COMP_SNAPSHOT_VERSION;
+	hdr[5] = comp->medium.cid_type;
+	hdr[6] = (comp->medium.max_cid >> 8) & 0xff;
+	hdr[7] = comp->medium.max_cid & 0xff;
+	memset(hdr + 8, 0, 4);
+	rohc_buf_append(buf, hdr, ROHC_COMP_SNAPSHOT_HDR_LEN);
+
+	return true;
+
+error:
+	return false;
+}
+
+
+/**
+ * @brief Write the number of contexts in the header of a snapshot or of a
+ *        change log
+ *
+ * @param buf         The buffer that contains the header
+ * @param hdr_offset  The offset of the header in the buffer
+ * @param ctxts_nr    The number of contexts
+ */
+static void c_snapshot_write_ctxts_nr(struct rohc_buf *const buf,
+                                      const size_t hdr_offset,
+                                      const uint32_t ctxts_nr)
+{
+	rohc_buf_byte_at(*buf, hdr_offset + 8) = (ctxts_nr >> 24) & 0xff;
+	rohc_buf_byte_at(*buf, hdr_offset + 9) = (ctxts_nr >> 16) & 0xff;
+	rohc_buf_byte_at(*buf, hdr_offset + 10) = (ctxts_nr >> 8) & 0xff;
+	rohc_buf_byte_at(*buf, hdr_offset + 11) = ctxts_nr & 0xff;
+}
+
+
+/**
+ * @brief Parse the header of a snapshot or of a change log
+ *
+ * @param comp           The ROHC compressor
+ * @param remain_data    The snapshot or the change log, the header is
+ *                       skipped if successfully parsed
+ * @param magic          The expected magic number
+ * @param[out] ctxts_nr  The number of contexts
+ * @return               true if the header matches the compressor,
+ *                       false otherwise
+ */
+static bool c_snapshot_parse_hdr(const struct rohc_comp *const comp,
+                                 struct rohc_buf *const remain_data,
+                                 const char *const magic,
+                                 uint32_t *const ctxts_nr)
+{
+	if(rohc_buf_is_malformed(*remain_data))
+	{
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		             "failed to import contexts: given buffer is malformed");
+		goto error;
+	}
+	if(remain_data->len < ROHC_COMP_SNAPSHOT_HDR_LEN ||
+	   memcmp(rohc_buf_data(*remain_data), magic, 4) != 0 ||
+	   rohc_buf_byte_at(*remain_data, 4) != ROHC_COMP_SNAPSHOT_VERSION)
+	{
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		             "failed to import contexts: unknown format");
+		goto error;
+	}
+	if(rohc_buf_byte_at(*remain_data, 5) != comp->medium.cid_type ||
+	   ((rohc_cid_t) ((rohc_buf_byte_at(*remain_data, 6) << 8) |
+	                  rohc_buf_byte_at(*remain_data, 7))) != comp->medium.max_cid)
+	{
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		             "failed to import contexts: CID type or MAX_CID does not "
+		             "match");
+		goto error;
+	}
+	*ctxts_nr = (rohc_buf_byte_at(*remain_data, 8) << 24) |
+	            (rohc_buf_byte_at(*remain_data, 9) << 16) |
+	            (rohc_buf_byte_at(*remain_data, 10) << 8) |
+	            rohc_buf_byte_at(*remain_data, 11);
+	rohc_buf_pull(remain_data, ROHC_COMP_SNAPSHOT_HDR_LEN);
+
+	return true;
+
+error:
+	return false;
+}
+
+
+/**
+ * @brief Whether the context with the given CID may be exported
+ *
+ * @param comp  The ROHC compressor
+ * @param cid   The CID of the context
+ * @return      true if the context is in use, out of the IR state and its
+ *              last headers are saved, false otherwise
+ */
+static bool c_snapshot_is_ctxt_saved(const struct rohc_comp *const comp,
+                                     const rohc_cid_t cid)
+{
+	return (rohc_bitmap_test(comp->ctxts_used, cid) &&
+	        c_ctxt_at(comp, cid)->state != ROHC_COMP_STATE_IR &&
+	        comp->ctxts_snapshots[cid].hdrs_len > 0);
+}
+
+
+/**
+ * @brief Append one context to a snapshot or to a change log
+ *
+ * An empty entry is appended if the context cannot be exported.
+ *
+ * @param comp  The ROHC compressor
+ * @param cid   The CID of the context
+ * @param buf   The buffer where to append the context
+ * @return      true if the context was appended, false if the buffer is
+ *              too small
+ */
+static bool c_snapshot_write_ctxt(const struct rohc_comp *const comp,
+                                  const rohc_cid_t cid,
+                                  struct rohc_buf *const buf)
+{
+	const struct rohc_comp_ctxt_snapshot *const saved =
+		&comp->ctxts_snapshots[cid];
+	uint8_t rec[ROHC_COMP_SNAPSHOT_CTXT_LEN] = { 0 };
+	size_t hdrs_len = 0;
+
+	if(c_snapshot_is_ctxt_saved(comp, cid))
+	{
+		const struct rohc_comp_ctxt *const context = c_ctxt_at(comp, cid);
+		const uint32_t msn =
+			(context->profile->get_msn != NULL ?
+			 context->profile->get_msn(context) : 0);
+
+		hdrs_len = saved->hdrs_len;
+		rec[0] = (context->profile->id >> 8) & 0xff;
+		rec[1] = context->profile->id & 0xff;
+		rec[2] = context->mode;
+		rec[3] = context->state;
+		rec[4] = (msn >> 24) & 0xff;
+		rec[5] = (msn >> 16) & 0xff;
+		rec[6] = (msn >> 8) & 0xff;
+		rec[7] = msn & 0xff;
+		rec[8] = (saved->pkt_len >> 8) & 0xff;
+		rec[9] = saved->pkt_len & 0xff;
+		rec[10] = (hdrs_len >> 8) & 0xff;
+		rec[11] = hdrs_len & 0xff;
+	}
+
+	if((rohc_buf_avail_len(*buf) - buf->len) <
+	   (ROHC_COMP_SNAPSHOT_CTXT_LEN + hdrs_len))
+	{
+		return false;
+	}
+	rohc_buf_append(buf, rec, ROHC_COMP_SNAPSHOT_CTXT_LEN);
+	rohc_buf_append(buf, saved->hdrs, hdrs_len);
+
+	return true;
+}
+
+
+/**
+ * @brief Read one context from a snapshot or from a change log
+ *
+ * The context in use with the same CID is destroyed first. The context
+ * is then rebuilt, unless the entry is empty. The list of unused contexts
+ * shall be rebuilt once all the contexts are read.
+ *
+ * @param comp         The ROHC compressor
+ * @param cid          The CID of the context
+ * @param remain_data  The snapshot or the change log, the context is
+ *                     skipped if successfully parsed
+ * @param pkt_mem      The memory to rebuild the last packet and to compress
+ *                     it in (2 x 65535 bytes)
+ * @return             true if the context was read, false if malformed
+ */
+static bool c_snapshot_read_ctxt(struct rohc_comp *const comp,
+                                 const rohc_cid_t cid,
+                                 struct rohc_buf *const remain_data,
+                                 uint8_t *const pkt_mem)
+{
+	rohc_profile_t profile_id;
+	rohc_mode_t mode;
+	rohc_comp_state_t state;
+	uint32_t msn;
+	size_t pkt_len;
+	size_t hdrs_len;
+
+	if(remain_data->len < ROHC_COMP_SNAPSHOT_CTXT_LEN || cid > comp->medium.max_cid)
+	{
+		goto malformed;
+	}
+	profile_id = (rohc_buf_byte_at(*remain_data, 0) << 8) |
+	             rohc_buf_byte_at(*remain_data, 1);
+	mode = rohc_buf_byte_at(*remain_data, 2);
+	state = rohc_buf_byte_at(*remain_data, 3);
+	msn = (rohc_buf_byte_at(*remain_data, 4) << 24) |
+	      (rohc_buf_byte_at(*remain_data, 5) << 16) |
+	      (rohc_buf_byte_at(*remain_data, 6) << 8) |
+	      rohc_buf_byte_at(*remain_data, 7);
+	pkt_len = (rohc_buf_byte_at(*remain_data, 8) << 8) |
+	          rohc_buf_byte_at(*remain_data, 9);
+	hdrs_len = (rohc_buf_byte_at(*remain_data, 10) << 8) |
+	           rohc_buf_byte_at(*remain_data, 11);
+	rohc_buf_pull(remain_data, ROHC_COMP_SNAPSHOT_CTXT_LEN);
+
+	if(hdrs_len > ROHC_COMP_SNAPSHOT_HDRS_MAX || hdrs_len > pkt_len ||
+	   hdrs_len > remain_data->len ||
+	   (hdrs_len > 0 &&
+	    ((mode != ROHC_U_MODE && mode != ROHC_O_MODE && mode != ROHC_R_MODE) ||
+	     (state != ROHC_COMP_STATE_FO && state != ROHC_COMP_STATE_SO))))
+	{
+		goto malformed;
+	}
+
+	/* the new context replaces the current one */
+	if(rohc_bitmap_test(comp->ctxts_used, cid))
+	{
+		c_destroy_context(comp, c_ctxt_at(comp, cid));
+	}
+
+	if(hdrs_len == 0)
+	{
+		rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		           "context with CID %zu removed", cid);
+	}
+	else if(cid < comp->cid_first || cid > comp->cid_last)
+	{
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		             "context with CID %zu is outside the CID range, skip it",
+		             cid);
+	}
+	else if(!c_import_context(comp, cid, profile_id, mode, state, &msn,
+	                          rohc_buf_data(*remain_data), hdrs_len, pkt_len,
+	                          pkt_mem))
+	{
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		             "failed to import context with CID %zu, its flow will "
+		             "start over", cid);
+	}
+	rohc_buf_pull(remain_data, hdrs_len);
+
+	return true;
+
+malformed:
+	return false;
+}
+
+
+/**
+ * @brief Find a compression context given an IP packet
+ *
+ * @param comp             The ROHC compressor
+ * @param packet           The packet to find a compression context for
+ * @param profile_id_hint  If positive, indicate the profile to use
+ * @param arrival_time     The time at which packet was received
+ *                         (0 if unknown, or to disable time-related features
+ *                          in the ROHC protocol)
+ * @return                 The context if found or successfully created,
+ *                         NULL if not found
+ */
+static struct rohc_comp_ctxt *
+	rohc_comp_find_ctxt(struct rohc_comp *const comp,
+	                    const struct net_pkt *const packet,
+	                    const int profile_id_hint,
+	                    const struct rohc_ts arrival_time)
+{
+	const struct rohc_comp_profile *profile;
+
+	/* use the suggested profile if any, otherwise find the best profile for
+	 * the packet */
+	if(profile_id_hint < 0)
+	{
+		profile = c_get_profile_from_packet(comp, packet);
+	}
+	else
+	{
+		profile = rohc_get_profile_from_id(comp, profile_id_hint);
+	}
+	if(profile == NULL)
+	{
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		             "no profile found for packet, giving up");
+		goto not_found;
+	}
+	rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+	           "using profile '%s' (0x%04x)",
+	           rohc_get_profile_descr(profile->id), profile->id);
+
+	/* get the context using help from the profile we just found */
+	return c_find_ctxt_for_flow(comp, profile, packet,
+	                            c_get_flow_hash(profile, packet), arrival_time);
+
+not_found:
+	return NULL;
+}
+
+
+/**
+ * @brief Find the compression context of a flow, create it if none is found
+ *
+ * Only the contexts indexed with the same flow hash are candidates, they are
+ * stored in the buckets that follow the home bucket of the hash until an
+ * empty bucket is found.
+ *
+ * @param comp         The ROHC compressor
+ * @param profile       The profile to compress the packet with
+ * @param packet        The packet to find a compression context for
+ * @param flow_hash     The flow hash of the packet for the profile
+ * @param arrival_time  The time at which packet was received
+ *                      (0 if unknown, or to disable time-related features
+ *                       in the ROHC protocol)
+ * @return              The context if found or successfully created,
+ *                      NULL if not found
+ */
+static struct rohc_comp_ctxt *
+	c_find_ctxt_for_flow(struct rohc_comp *const comp,
+	                     const struct rohc_comp_profile *const profile,
+	                     const struct net_pkt *const packet,
+	                     const rohc_ctxt_key_t flow_hash,
+	                     const struct rohc_ts arrival_time)
+{
+	const rohc_ctxt_key_t key = c_get_ctxt_key(profile, packet);
+	struct rohc_comp_ctxt *context;
+	size_t bucket;
+
+	/* the few flows seen lately are found without probing the index */
+	context = c_mru_find(comp, profile, packet, key, flow_hash);
+	if(context != NULL)
+	{
+		comp->ctxts_mru_hits_nr++;
+	}
+	for(bucket = flow_hash & comp->ctxts_index_mask;
+	    context == NULL &&
+	    comp->ctxts_index[bucket].cid != ROHC_COMP_CTXT_INDEX_EMPTY;
+	    bucket = (bucket + 1) & comp->ctxts_index_mask)
+	{
+		struct rohc_comp_ctxt *const candidate =
+			c_ctxt_at(comp, comp->ctxts_index[bucket].cid);
+
+		/* don't look at contexts with another flow hash or the wrong profile,
+		 * the index tells without reading the contexts */
+		if(comp->ctxts_index[bucket].hash != flow_hash ||
+		   comp->ctxts_index[bucket].profile_id != profile->id)
+		{
+			continue;
+		}
+		assert(candidate->used);
+		assert(candidate->profile->id == profile->id);
+
+		/* don't look at contexts with the wrong key */
+		if(key != candidate->key)
+		{
+			continue;
+		}
+
+		/* ask the profile whether the packet matches the context */
+		if(candidate->profile->check_context(candidate, packet))
+		{
+			rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+			           "using context CID = %zu", candidate->cid);
+			context = candidate;
+			break;
+		}
+	}
+	if(context == NULL)
+	{
+		/* context not found, create a new one */
+		rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		           "no existing context found for packet, create a new one");
+		context = c_create_context(comp, profile, packet, arrival_time);
+		if(context == NULL)
+		{
+			rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+			             "failed to create a new context");
+			goto not_found;
+		}
+	}
+	else
+	{
+		/* matching context found, update use timestamp and the position of
+		 * the context in the recycling list */
+		context->latest_used = arrival_time.sec;
+		c_recycle_list_touch(comp, context);
+	}
+	c_mru_promote(comp, context);
+
+	return context;
+
+not_found:
+	return NULL;
+}
+
+
+/**
+ * @brief Find out a context given its CID
+ *
+ * @param comp The ROHC compressor
+ * @param cid  The CID of the context to find
+ * @return     The context with the given CID if found, NULL otherwise
+ */
+static struct rohc_comp_ctxt *
+	c_get_context(struct rohc_comp *const comp, const rohc_cid_t cid)
+{
+	/* the CID must not be larger than the context array */
+	if(cid > comp->medium.max_cid)
+	{
+		goto not_found;
+	}
+
+	/* the context with the given CID must be in use */
+	if(!rohc_bitmap_test(comp->ctxts_used, cid))
+	{
+		goto not_found;
+	}
+
+	return c_ctxt_at(comp, cid);
+
+not_found:
+	return NULL;
+}
+
+
+/**
+ * @brief Destroy the given compression context
+ *
+ * The profile-specific part of the context is destroyed, the context is
+ * removed from the index of contexts, and its CID is made available for a
+ * new context.
+ *
+ * @param comp     The ROHC compressor
+ * @param context  The compression context to destroy
+ */
+static void c_destroy_context(struct rohc_comp *const comp,
+                              struct rohc_comp_ctxt *const context)
+{
+	struct rohc_comp_ctxt_stats *stats;
+
+	assert(context->used);
+
+	c_unindex_context(comp, context);
+	c_recycle_list_remove(comp, context);
+	rohc_comp_wheel_disarm(&comp->refresh_wheel, &context->go_back_fo_timer);
+	rohc_comp_wheel_disarm(&comp->refresh_wheel, &context->go_back_ir_timer);
+	context->profile->destroy(context);
+	context->key = 0; /* reset context key */
+	context->used = 0;
+	rohc_bitmap_clear(comp->ctxts_used, context->cid);
+	stats = c_ctxt_stats_at(comp, context->cid);
+	rohc_seqcount_write_begin(&stats->seq);
+	stats->used = false;
+	rohc_seqcount_write_end(&stats->seq);
+	assert(comp->num_contexts_used > 0);
+	comp->num_contexts_used--;
+	if(context->reinit_pending)
+	{
+		context->reinit_pending = false;
+		assert(comp->reinit.pending_nr > 0);
+		comp->reinit.pending_nr--;
+	}
+
+	/* the standby compressors shall destroy the context too */
+	if(comp->ctxts_snapshots != NULL)
+	{
+		comp->ctxts_snapshots[context->cid].hdrs_len = 0;
+		comp->ctxts_dirty[context->cid / 8] |= 1 << (context->cid % 8);
+	}
+
+	/* the CID of the destroyed context is the next one to be used */
+	context->recycle_next = comp->ctxts_unused;
+	comp->ctxts_unused = context;
+}
+
+
+/**
+ * @brief Reset the statistics of a new compression context
+ *
+ * @param comp     The ROHC compressor
+ * @param context  The compression context just created
+ */
+static void c_reset_ctxt_stats(struct rohc_comp *const comp,
+                               const struct rohc_comp_ctxt *const context)
+{
+	struct rohc_comp_ctxt_stats *const stats =
+		c_ctxt_stats_at(comp, context->cid);
+
+	rohc_seqcount_write_begin(&stats->seq);
+	stats->used = true;
+	stats->profile_id = context->profile->id;
+	stats->mode = context->mode;
+	stats->state = context->state;
+	stats->packet_type = ROHC_PACKET_UNKNOWN;
+	stats->packets_nr = 0;
+	stats->total_uncompressed_size = 0;
+	stats->total_compressed_size = 0;
+	stats->header_uncompressed_size = 0;
+	stats->header_compressed_size = 0;
+	stats->total_last_uncompressed_size = 0;
+	stats->total_last_compressed_size = 0;
+	stats->header_last_uncompressed_size = 0;
+	stats->header_last_compressed_size = 0;
+	rohc_seqcount_write_end(&stats->seq);
+}
+
+
+/**
+ * @brief Keep the durations of the first phases until the packet type is known
+ *
+ * @param comp         The ROHC compressor
+ * @param parse_ticks   The duration of the parsing phase
+ * @param lookup_ticks  The duration of the context lookup phase
+ */
+static void c_timings_set_pending(struct rohc_comp *const comp,
+                                  const rohc_ticks_t parse_ticks,
+                                  const rohc_ticks_t lookup_ticks)
+{
+#ifdef ROHC_TIMINGS
+	comp->timings_pending[ROHC_COMP_PHASE_PARSE] = parse_ticks;
+	comp->timings_pending[ROHC_COMP_PHASE_LOOKUP] = lookup_ticks;
+	comp->timings_are_pending = true;
+#else
+	(void) comp;
+	(void) parse_ticks;
+	(void) lookup_ticks;
+#endif
+}
+
+
+/**
+ * @brief Forget the durations of the first phases of the current packet
+ *
+ * @param comp  The ROHC compressor
+ */
+static void c_timings_clear_pending(struct rohc_comp *const comp)
+{
+#ifdef ROHC_TIMINGS
+	comp->timings_are_pending = false;
+#else
+	(void) comp;
+#endif
+}
+
+
+/**
+ * @brief Forget the duration of the CRC computations of the previous packet
+ *
+ * @param comp  The ROHC compressor
+ */
+static void c_timings_reset_crc(struct rohc_comp *const comp)
+{
+#ifdef ROHC_TIMINGS
+	comp->timings_crc = 0;
+#else
+	(void) comp;
+#endif
+}
+
+
+/**
+ * @brief Record the durations of the phases of one compressed packet
+ *
+ * The durations are recorded twice: once for the type of the ROHC packet,
+ * once for the profile of the context. The duration of the CRC computations
+ * accumulated during the encoding phase is recorded apart.
+ *
+ * @param comp           The ROHC compressor
+ * @param profile        The profile of the compression context
+ * @param packet_type    The type of the ROHC packet
+ * @param encode_ticks   The duration of the encoding phase, CRC included
+ * @param payload_ticks  The duration of the payload phase
+ */
+static void c_timings_record(struct rohc_comp *const comp,
+                             const rohc_profile_t profile,
+                             const rohc_packet_t packet_type,
+                             const rohc_ticks_t encode_ticks,
+                             const rohc_ticks_t payload_ticks)
+{
+#ifdef ROHC_TIMINGS
+	rohc_timings_histo_t *const histos_sets[2] = {
+		comp->timings[packet_type],
+		comp->timings_profiles[rohc_comp_profile_idx(profile)],
+	};
+	const rohc_ticks_t crc_ticks = rohc_min(comp->timings_crc, encode_ticks);
+	size_t i;
+
+	assert(packet_type < ROHC_PACKET_MAX);
+	assert(rohc_comp_profile_idx(profile) < C_NUM_PROFILES);
+	for(i = 0; i < 2; i++)
+	{
+		rohc_timings_histo_t *const histos = histos_sets[i];
+
+		if(comp->timings_are_pending)
+		{
+			rohc_timings_histo_add(&histos[ROHC_COMP_PHASE_PARSE],
+			                       comp->timings_pending[ROHC_COMP_PHASE_PARSE]);
+			rohc_timings_histo_add(&histos[ROHC_COMP_PHASE_LOOKUP],
+			                       comp->timings_pending[ROHC_COMP_PHASE_LOOKUP]);
+		}
+		rohc_timings_histo_add(&histos[ROHC_COMP_PHASE_ENCODE],
+		                       encode_ticks - crc_ticks);
+		rohc_timings_histo_add(&histos[ROHC_COMP_PHASE_CRC], crc_ticks);
+		rohc_timings_histo_add(&histos[ROHC_COMP_PHASE_PAYLOAD], payload_ticks);
+	}
+	comp->timings_are_pending = false;
+	comp->timings_crc = 0;
+#else
+	(void) comp;
+	(void) profile;
+	(void) packet_type;
+	(void) encode_ticks;
+	(void) payload_ticks;
+#endif
+}
+
+
+/**
+ * @brief Record the duration of the handling of one feedback item
+ *
+ * @param comp            The ROHC compressor
+ * @param profile         The profile of the context the feedback was for
+ * @param feedback_ticks  The duration of the handling of the feedback
+ */
+static void c_timings_record_feedback(struct rohc_comp *const comp,
+                                      const rohc_profile_t profile,
+                                      const rohc_ticks_t feedback_ticks)
+{
+#ifdef ROHC_TIMINGS
+	rohc_timings_histo_t *const histos =
+		comp->timings_profiles[rohc_comp_profile_idx(profile)];
+
+	assert(rohc_comp_profile_idx(profile) < C_NUM_PROFILES);
+	rohc_timings_histo_add(&histos[ROHC_COMP_PHASE_FEEDBACK], feedback_ticks);
+#else
+	(void) comp;
+	(void) profile;
+	(void) feedback_ticks;
+#endif
+}
+
+
+/**
+ * @brief Get the key of a packet for the contexts of a given profile
+ *
+ * The Uncompressed profile accepts all the packets with the same pair of
+ * outermost IP addresses in one context, whatever their direction, so its
+ * contexts are keyed on those addresses only. The other profiles use the key
+ * of the whole IP header chain.
+ *
+ * @param profile  The profile that is going to compress the packet
+ * @param packet   The packet to get the key for
+ * @return         The key of the packet for the contexts of the profile
+ */
+static rohc_ctxt_key_t
+	c_get_ctxt_key(const struct rohc_comp_profile *const profile,
+	               const struct net_pkt *const packet)
+{
+	if(profile->id == ROHC_PROFILE_UNCOMPRESSED)
+	{
+		return packet->outer_key;
+	}
+	return packet->key;
+}
+
+
+/**
+ * @brief Get the layout of the IP headers of a packet
+ *
+ * The layout tells the number of IP headers and their versions: one bit per
+ * IP header, 1 for IPv6 and 0 for IPv4, from the outermost header to the
+ * innermost one, after a leading 1 bit. The IPv6 extension headers are not
+ * part of it.
+ *
+ * @param packet  The packet to get the layout of the IP headers for
+ * @return        The layout of the IP headers of the packet
+ */
+static uint32_t c_get_ip_layout(const struct net_pkt *const packet)
+{
+	uint32_t layout = 1;
+	size_t i;
+
+	/* NET_PKT_HDRS_MAX headers at most, the layout cannot overflow */
+	assert(NET_PKT_HDRS_MAX < 32);
+
+	for(i = 0; i < packet->hdrs_nr; i++)
+	{
+		if(packet->hdrs[i].proto == ROHC_IPPROTO_IPIP)
+		{
+			layout <<= 1;
+		}
+		else if(packet->hdrs[i].proto == ROHC_IPPROTO_IPV6)
+		{
+			layout = (layout << 1) | 1;
+		}
+	}
+
+	return layout;
+}
+
+
+/**
+ * @brief Compute the hash of the flow tuple of a packet for a given profile
+ *
+ * The hash extends the key of the packet with the fields that the
+ * check_context() handler of the profile compares, so that all the packets
+ * that a context accepts get the same hash:
+ *  - the Uncompressed profile uses the key of the outermost IP addresses,
+ *  - the IP-only profiles use the packet key only (IP versions, addresses,
+ *    Flow Labels and transport protocol),
+ *  - the profiles dedicated to one transport protocol also hash the first
+ *    32-bit word of the transport header (UDP, UDP-Lite or TCP ports,
+ *    ESP SPI),
+ *  - the RTP profiles also hash the RTP SSRC.
+ *
+ * @param profile  The profile that is going to compress the packet
+ * @param packet   The packet to compute the flow hash for
+ * @return         The flow hash of the packet
+ */
+static rohc_ctxt_key_t
+	c_get_flow_hash(const struct rohc_comp_profile *const profile,
+	                const struct net_pkt *const packet)
+{
+	const struct net_hdr *const transport = packet->transport;
+	rohc_ctxt_key_t hash =
+		net_pkt_key_mix(c_get_ctxt_key(profile, packet), profile->id);
+
+	if(profile->protocol != 0 &&
+	   profile->protocol == transport->proto &&
+	   transport->data != NULL &&
+	   transport->len >= sizeof(uint32_t))
+	{
+		uint32_t first_word;
+		memcpy(&first_word, transport->data, sizeof(uint32_t));
+		hash = net_pkt_key_mix(hash, first_word);
+
+		if((profile->id == ROHC_PROFILE_RTP ||
+		    profile->id == ROHCv2_PROFILE_IP_UDP_RTP) &&
+		   transport->len >= (sizeof(struct udphdr) + sizeof(struct rtphdr)))
+		{
+			const struct rtphdr *const rtp =
+				(struct rtphdr *) (transport->data + sizeof(struct udphdr));
+			hash = net_pkt_key_mix(hash, rtp->ssrc);
+		}
+	}
+
+	/* final avalanche, the lowest bits of the hash select the bucket */
+	return net_pkt_key_final(hash);
+}
+
+
+/**
+ * @brief Add the given compression context to the index of contexts
+ *
+ * @param comp     The ROHC compressor
+ * @param context  The compression context to index
+ */
+static void c_index_context(struct rohc_comp *const comp,
+                            const struct rohc_comp_ctxt *const context)
+{
+	size_t bucket = context->flow_hash & comp->ctxts_index_mask;
+
+	/* the index is at least twice as large as the context array, so there is
+	 * always an empty bucket available */
+	while(comp->ctxts_index[bucket].cid != ROHC_COMP_CTXT_INDEX_EMPTY)
+	{
+		bucket = (bucket + 1) & comp->ctxts_index_mask;
+	}
+	comp->ctxts_index[bucket].hash = context->flow_hash;
+	comp->ctxts_index[bucket].cid = context->cid;
+	comp->ctxts_index[bucket].profile_id = context->profile->id;
+}
+
+
+/**
+ * @brief Remove the given compression context from the index of contexts
+ *
+ * The buckets that follow the removed one are shifted backward when needed,
+ * so that no probe sequence is broken and no tombstone is required.
+ *
+ * @param comp     The ROHC compressor
+ * @param context  The compression context to remove from the index
+ */
+static void c_unindex_context(struct rohc_comp *const comp,
+                              const struct rohc_comp_ctxt *const context)
+{
+	size_t hole = context->flow_hash & comp->ctxts_index_mask;
+	size_t bucket;
+
+	c_mru_forget(comp, context->cid);
+
+	/* find the bucket of the context */
+	while(comp->ctxts_index[hole].cid != context->cid)
+	{
+		assert(comp->ctxts_index[hole].cid != ROHC_COMP_CTXT_INDEX_EMPTY);
+		hole = (hole + 1) & comp->ctxts_index_mask;
+	}
+
+	/* fill the hole with the next buckets that are allowed to move there */
+	for(bucket = (hole + 1) & comp->ctxts_index_mask;
+	    comp->ctxts_index[bucket].cid != ROHC_COMP_CTXT_INDEX_EMPTY;
+	    bucket = (bucket + 1) & comp->ctxts_index_mask)
+	{
+		const size_t home = comp->ctxts_index[bucket].hash &
+		                    comp->ctxts_index_mask;
+
+		/* the entry may move to the hole only if its home bucket is not
+		 * located (cyclically) in ]hole, bucket] */
+		if(((bucket - home) & comp->ctxts_index_mask) >=
+		   ((bucket - hole) & comp->ctxts_index_mask))
+		{
+			comp->ctxts_index[hole] = comp->ctxts_index[bucket];
+			hole = bucket;
+		}
+	}
+	comp->ctxts_index[hole].cid = ROHC_COMP_CTXT_INDEX_EMPTY;
+}
+
+
+/**
+ * @brief Find the compression context of a flow in the cache of the most
+ *        recently used contexts
+ *
+ * The cache is fully associative: all its entries are compared with the
+ * flow hash and the profile, then the context of a matching entry is checked
+ * as thoroughly as with the index of contexts.
+ *
+ * @param comp       The ROHC compressor
+ * @param profile    The profile to compress the packet with
+ * @param packet     The packet to find a compression context for
+ * @param key        The context key of the packet for the profile
+ * @param flow_hash  The flow hash of the packet for the profile
+ * @return           The context if found in the cache, NULL otherwise
+ */
+static struct rohc_comp_ctxt *
+	c_mru_find(struct rohc_comp *const comp,
+	           const struct rohc_comp_profile *const profile,
+	           const struct net_pkt *const packet,
+	           const rohc_ctxt_key_t key,
+	           const rohc_ctxt_key_t flow_hash)
+{
+	size_t i;
+
+	for(i = 0; i < ROHC_COMP_CTXTS_MRU_NR; i++)
+	{
+		const struct rohc_comp_ctxt_bucket *const entry = &comp->ctxts_mru[i];
+		struct rohc_comp_ctxt *candidate;
+
+		if(entry->cid == ROHC_COMP_CTXT_INDEX_EMPTY ||
+		   entry->hash != flow_hash || entry->profile_id != profile->id)
+		{
+			continue;
+		}
+		candidate = c_ctxt_at(comp, entry->cid);
+		assert(candidate->used);
+		assert(candidate->profile->id == profile->id);
+
+		if(key == candidate->key &&
+		   candidate->profile->check_context(candidate, packet))
+		{
+			rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+			           "using recently used context CID = %zu", candidate->cid);
+			return candidate;
+		}
+	}
+
+	return NULL;
+}
+
+
+/**
+ * @brief Move the given compression context at the head of the cache of the
+ *        most recently used contexts
+ *
+ * The least recently used context leaves the cache if the given context was
+ * not cached yet.
+ *
+ * @param comp     The ROHC compressor
+ * @param context  The compression context just used
+ */
+static void c_mru_promote(struct rohc_comp *const comp,
+                          const struct rohc_comp_ctxt *const context)
+{
+	size_t i;
+
+	/* find the context in the cache or take the least recently used entry */
+	for(i = 0; i < (ROHC_COMP_CTXTS_MRU_NR - 1); i++)
+	{
+		if(comp->ctxts_mru[i].cid == context->cid)
+		{
+			break;
+		}
+	}
+
+	/* shift the more recent entries, then put the context at the head */
+	for(; i > 0; i--)
+	{
+		comp->ctxts_mru[i] = comp->ctxts_mru[i - 1];
+	}
+	comp->ctxts_mru[0].hash = context->flow_hash;
+	comp->ctxts_mru[0].cid = context->cid;
+	comp->ctxts_mru[0].profile_id = context->profile->id;
+}
+
+
+/**
+ * @brief Remove one context from the cache of the most recently used contexts
+ *
+ * @param comp  The ROHC compressor
+ * @param cid   The CID of the context that is destroyed
+ */
+static void c_mru_forget(struct rohc_comp *const comp, const rohc_cid_t cid)
+{
+	size_t i;
+
+	for(i = 0; i < ROHC_COMP_CTXTS_MRU_NR; i++)
+	{
+		if(comp->ctxts_mru[i].cid == cid)
+		{
+			comp->ctxts_mru[i].cid = ROHC_COMP_CTXT_INDEX_EMPTY;
+		}
+	}
+}
+
+
+/**
+ * @brief Unlink the given context from the list of contexts ordered for
+ *        recycling
+ *
+ * @param comp     The ROHC compressor
+ * @param context  The compression context to unlink
+ */
+static void c_recycle_list_unlink(struct rohc_comp *const comp,
+                                  struct rohc_comp_ctxt *const context)
+{
+	if(context->recycle_prev != NULL)
+	{
+		context->recycle_prev->recycle_next = context->recycle_next;
+	}
+	else
+	{
+		comp->ctxts_recycle_head = context->recycle_next;
+	}
+	if(context->recycle_next != NULL)
+	{
+		context->recycle_next->recycle_prev = context->recycle_prev;
+	}
+	else
+	{
+		comp->ctxts_recycle_tail = context->recycle_prev;
+	}
+	context->recycle_prev = NULL;
+	context->recycle_next = NULL;
+}
+
+
+/**
+ * @brief Link the given context in the list of contexts ordered for recycling
+ *
+ * @param comp     The ROHC compressor
+ * @param context  The compression context to link
+ * @param next     The context to link the given context before,
+ *                 NULL to link it at the tail of the list
+ */
+static void c_recycle_list_link_before(struct rohc_comp *const comp,
+                                       struct rohc_comp_ctxt *const context,
+                                       struct rohc_comp_ctxt *const next)
+{
+	context->recycle_next = next;
+	if(next != NULL)
+	{
+		context->recycle_prev = next->recycle_prev;
+		next->recycle_prev = context;
+	}
+	else
+	{
+		context->recycle_prev = comp->ctxts_recycle_tail;
+		comp->ctxts_recycle_tail = context;
+	}
+	if(context->recycle_prev != NULL)
+	{
+		context->recycle_prev->recycle_next = context;
+	}
+	else
+	{
+		comp->ctxts_recycle_head = context;
+	}
+}
+
+
+/**
+ * @brief Get an unused frequency group for the LFU recycling policy
+ *
+ * @param comp     The ROHC compressor
+ * @param uses_nr  The number of uses of the contexts of the group
+ * @param head     The first context of the group
+ * @return         The frequency group
+ */
+static struct rohc_comp_ctxt_freq *
+	c_recycle_freq_new(struct rohc_comp *const comp,
+	                   const size_t uses_nr,
+	                   struct rohc_comp_ctxt *const head)
+{
+	struct rohc_comp_ctxt_freq *const freq = comp->ctxts_freqs_unused;
+
+	/* there is one group per context at most */
+	assert(freq != NULL);
+	comp->ctxts_freqs_unused = freq->next_unused;
+	freq->next_unused = NULL;
+	freq->uses_nr = uses_nr;
+	freq->head = head;
+
+	return freq;
+}
+
+
+/**
+ * @brief Remove the given context from its frequency group
+ *
+ * The frequency group is released if the context was its only member.
+ *
+ * @param comp     The ROHC compressor
+ * @param context  The compression context to remove from its group
+ */
+static void c_recycle_freq_leave(struct rohc_comp *const comp,
+                                 struct rohc_comp_ctxt *const context)
+{
+	struct rohc_comp_ctxt_freq *const freq = context->freq;
+
+	if(freq->head == context)
+	{
+		if(context->recycle_next != NULL && context->recycle_next->freq == freq)
+		{
+			freq->head = context->recycle_next;
+		}
+		else
+		{
+			/* last context of the group, release the group */
+			freq->head = NULL;
+			freq->next_unused = comp->ctxts_freqs_unused;
+			comp->ctxts_freqs_unused = freq;
+		}
+	}
+	context->freq = NULL;
+}
+
+
+/**
+ * @brief Add a new context in the list of contexts ordered for recycling
+ *
+ * With the LRU and oldest-first policies, the new context is the one that
+ * shall be kept the longest. With the LFU policy, the new context is the
+ * most recently used one of the contexts used only once.
+ *
+ * @param comp     The ROHC compressor
+ * @param context  The new compression context
+ */
+static void c_recycle_list_add(struct rohc_comp *const comp,
+                               struct rohc_comp_ctxt *const context)
+{
+	if(comp->recycle_policy == ROHC_COMP_RECYCLE_LFU)
+	{
+		struct rohc_comp_ctxt_freq *const lowest =
+			(comp->ctxts_recycle_tail != NULL ?
+			 comp->ctxts_recycle_tail->freq : NULL);
+
+		if(lowest != NULL && lowest->uses_nr == 1)
+		{
+			c_recycle_list_link_before(comp, context, lowest->head);
+			lowest->head = context;
+			context->freq = lowest;
+		}
+		else
+		{
+			c_recycle_list_link_before(comp, context, NULL);
+			context->freq = c_recycle_freq_new(comp, 1, context);
+		}
+	}
+	else if(comp->recycle_policy == ROHC_COMP_RECYCLE_SLRU)
+	{
+		/* the new context is unprotected until it is used again */
+		c_recycle_list_link_before(comp, context, comp->ctxts_slru_unprotected);
+		comp->ctxts_slru_unprotected = context;
+	}
+	else
+	{
+		c_recycle_list_link_before(comp, context, comp->ctxts_recycle_head);
+	}
+}
+
+
+/**
+ * @brief Update the position of a context in the list of contexts ordered
+ *        for recycling after one more packet was compressed with it
+ *
+ * @param comp     The ROHC compressor
+ * @param context  The compression context that was used
+ */
+static void c_recycle_list_touch(struct rohc_comp *const comp,
+                                 struct rohc_comp_ctxt *const context)
+{
+	comp->ctxts_hits_nr++;
+
+	if(context->on_probation)
+	{
+		/* admit the context once its flow proved to be long-lived, the
+		 * Uncompressed contexts are cheap to rebuild and never admitted */
+		if(context->num_sent_packets >= comp->admission_pkts_nr &&
+		   context->profile->id != ROHC_PROFILE_UNCOMPRESSED)
+		{
+			c_probation_admit(comp, context);
+		}
+		else if(comp->ctxts_probation_head != context)
+		{
+			c_probation_unlink(comp, context);
+			context->recycle_prev = NULL;
+			context->recycle_next = comp->ctxts_probation_head;
+			comp->ctxts_probation_head->recycle_prev = context;
+			comp->ctxts_probation_head = context;
+		}
+	}
+	else if(comp->recycle_policy == ROHC_COMP_RECYCLE_LRU)
+	{
+		/* most recently used context is kept the longest */
+		if(comp->ctxts_recycle_head != context)
+		{
+			c_recycle_list_unlink(comp, context);
+			c_recycle_list_link_before(comp, context, comp->ctxts_recycle_head);
+		}
+	}
+	else if(comp->recycle_policy == ROHC_COMP_RECYCLE_LFU)
+	{
+		/* move the context to the head of the group of contexts used once
+		 * more than the current group, create that group if needed */
+		struct rohc_comp_ctxt_freq *const freq = context->freq;
+		struct rohc_comp_ctxt *const freq_head = freq->head;
+		struct rohc_comp_ctxt_freq *const higher =
+			(freq_head->recycle_prev != NULL ?
+			 freq_head->recycle_prev->freq : NULL);
+		const bool is_alone =
+			(freq_head == context &&
+			 (context->recycle_next == NULL ||
+			  context->recycle_next->freq != freq));
+
+		if(higher != NULL && higher->uses_nr == (freq->uses_nr + 1))
+		{
+			c_recycle_freq_leave(comp, context);
+			c_recycle_list_unlink(comp, context);
+			c_recycle_list_link_before(comp, context, higher->head);
+			higher->head = context;
+			context->freq = higher;
+		}
+		else if(is_alone)
+		{
+			/* the context stays in place, its group is updated */
+			freq->uses_nr++;
+		}
+		else
+		{
+			const size_t uses_nr = freq->uses_nr + 1;
+			c_recycle_freq_leave(comp, context);
+			if(freq_head != context)
+			{
+				c_recycle_list_unlink(comp, context);
+				c_recycle_list_link_before(comp, context, freq_head);
+			}
+			context->freq = c_recycle_freq_new(comp, uses_nr, context);
+		}
+	}
+	else if(comp->recycle_policy == ROHC_COMP_RECYCLE_SLRU)
+	{
+		const size_t protected_max =
+			(comp->cid_last - comp->cid_first + 1) *
+			ROHC_COMP_SLRU_PROTECTED_PERCENT / 100;
+
+		/* the context used again joins the protected segment, the most
+		 * recently used context is kept the longest */
+		if(!context->slru_protected)
+		{
+			if(comp->ctxts_slru_unprotected == context)
+			{
+				comp->ctxts_slru_unprotected = context->recycle_next;
+			}
+			context->slru_protected = true;
+			comp->slru_protected_nr++;
+		}
+		if(comp->ctxts_recycle_head != context)
+		{
+			c_recycle_list_unlink(comp, context);
+			c_recycle_list_link_before(comp, context, comp->ctxts_recycle_head);
+		}
+
+		/* the least recently used protected context goes back to the
+		 * unprotected segment if the protected segment is full */
+		if(comp->slru_protected_nr > protected_max)
+		{
+			struct rohc_comp_ctxt *const demoted =
+				(comp->ctxts_slru_unprotected != NULL ?
+				 comp->ctxts_slru_unprotected->recycle_prev :
+				 comp->ctxts_recycle_tail);
+
+			demoted->slru_protected = false;
+			comp->slru_protected_nr--;
+			comp->ctxts_slru_unprotected = demoted;
+		}
+	}
+	/* the oldest-first policy does not depend on the use of contexts */
+}
+
+
+/**
+ * @brief Remove a context from the list of contexts ordered for recycling
+ *
+ * @param comp     The ROHC compressor
+ * @param context  The compression context to remove
+ */
+static void c_recycle_list_remove(struct rohc_comp *const comp,
+                                  struct rohc_comp_ctxt *const context)
+{
+	if(context->on_probation)
+	{
+		c_probation_unlink(comp, context);
+		context->on_probation = false;
+		assert(comp->probation_nr > 0);
+		comp->probation_nr--;
+	}
+	else
+	{
+		if(context->freq != NULL)
+		{
+			c_recycle_freq_leave(comp, context);
+		}
+		if(comp->ctxts_slru_unprotected == context)
+		{
+			comp->ctxts_slru_unprotected = context->recycle_next;
+		}
+		if(context->slru_protected)
+		{
+			context->slru_protected = false;
+			assert(comp->slru_protected_nr > 0);
+			comp->slru_protected_nr--;
+		}
+		c_recycle_list_unlink(comp, context);
+	}
+}
+
+
+/**
+ * @brief Add a new context in the list of contexts on probation
+ *
+ * The new context is added in the list of contexts ordered for recycling
+ * instead if the admission control is disabled.
+ *
+ * @param comp     The ROHC compressor
+ * @param context  The new compression context
+ */
+static void c_probation_add(struct rohc_comp *const comp,
+                            struct rohc_comp_ctxt *const context)
+{
+	if(comp->admission_pkts_nr == 0)
+	{
+		c_recycle_list_add(comp, context);
+	}
+	else
+	{
+		context->recycle_prev = NULL;
+		context->recycle_next = comp->ctxts_probation_head;
+		if(comp->ctxts_probation_head != NULL)
+		{
+			comp->ctxts_probation_head->recycle_prev = context;
+		}
+		else
+		{
+			comp->ctxts_probation_tail = context;
+		}
+		comp->ctxts_probation_head = context;
+		context->on_probation = true;
+		comp->probation_nr++;
+	}
+}
+
+
+/**
+ * @brief Unlink the given context from the list of contexts on probation
+ *
+ * @param comp     The ROHC compressor
+ * @param context  The compression context to unlink
+ */
+static void c_probation_unlink(struct rohc_comp *const comp,
+                               struct rohc_comp_ctxt *const context)
+{
+	if(context->recycle_prev != NULL)
+	{
+		context->recycle_prev->recycle_next = context->recycle_next;
+	}
+	else
+	{
+		comp->ctxts_probation_head = context->recycle_next;
+	}
+	if(context->recycle_next != NULL)
+	{
+		context->recycle_next->recycle_prev = context->recycle_prev;
+	}
+	else
+	{
+		comp->ctxts_probation_tail = context->recycle_prev;
+	}
+	context->recycle_prev = NULL;
+	context->recycle_next = NULL;
+}
+
+
+/**
+ * @brief Admit a context on probation in the list of contexts ordered for
+ *        recycling
+ *
+ * @param comp     The ROHC compressor
+ * @param context  The compression context to admit
+ */
+static void c_probation_admit(struct rohc_comp *const comp,
+                              struct rohc_comp_ctxt *const context)
+{
+	c_probation_unlink(comp, context);
+	context->on_probation = false;
+	assert(comp->probation_nr > 0);
+	comp->probation_nr--;
+	c_recycle_list_add(comp, context);
+	rohc_comp_debug(context, "context admitted after %" PRIu64 " packets",
+	                context->num_sent_packets);
+}
+
+
+/**
+ * @brief Get the context to recycle when all the CIDs are in use
+ *
+ * The contexts on probation may replace admitted contexts until they are
+ * \e probation_max, then they replace each other: the least recently used
+ * context on probation is recycled. Short-lived flows cannot replace more
+ * than \e probation_max admitted contexts this way.
+ *
+ * @param comp  The ROHC compressor
+ * @return      The context to recycle
+ */
+static struct rohc_comp_ctxt *
+	c_recycle_victim(const struct rohc_comp *const comp)
+{
+	struct rohc_comp_ctxt *victim;
+
+	if(comp->ctxts_probation_tail != NULL &&
+	   (comp->probation_nr >= comp->probation_max ||
+	    comp->ctxts_recycle_tail == NULL))
+	{
+		victim = comp->ctxts_probation_tail;
+	}
+	else
+	{
+		victim = comp->ctxts_recycle_tail;
+	}
+
+	return victim;
+}
+
+
+/**
+ * @brief Create the array of compression contexts
+ *
+ * Only the table of the chunks of contexts is created, the chunks are
+ * allocated when their first context is needed, see \ref c_alloc_ctxts_chunk.
+ *
+ * @param comp The ROHC compressor
+ * @return     true if the creation is successful, false otherwise
+ */
+static bool c_create_contexts(struct rohc_comp *const comp)
+{
+	const size_t chunks_max =
+		comp->medium.max_cid / ROHC_COMP_CTXTS_CHUNK_LEN + 1;
+	size_t i;
+
+	assert(comp->ctxts_chunks == NULL);
+	assert(comp->ctxts_index == NULL);
+
+	comp->num_contexts_used = 0;
+
+	rohc_info(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+	          "create enough room for %zu contexts (MAX_CID = %zu)",
+	          comp->medium.max_cid + 1, comp->medium.max_cid);
+
+	comp->ctxts_chunks = rohc_calloc(chunks_max,
+	                                 sizeof(struct rohc_comp_ctxts_chunk *));
+	if(comp->ctxts_chunks == NULL)
+	{
+		rohc_error(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		           "cannot allocate memory for contexts");
+		goto error;
+	}
+	comp->ctxts_chunks_nr = 0;
+	comp->ctxts_used = rohc_calloc(ROHC_BITMAP_WORDS_NR(comp->medium.max_cid + 1),
+	                          sizeof(uint64_t));
+	if(comp->ctxts_used == NULL)
+	{
+		rohc_error(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		           "cannot allocate memory for the bitmap of contexts in use");
+		goto free_chunks;
+	}
+
+	/* the index of contexts is large enough for the first chunk, it grows
+	 * with the next chunks */
+	comp->ctxts_index_mask = 0;
+	if(!c_grow_index(comp, rohc_min(ROHC_COMP_CTXTS_CHUNK_LEN,
+	                                comp->medium.max_cid + 1)))
+	{
+		goto free_used;
+	}
+	for(i = 0; i < ROHC_COMP_CTXTS_MRU_NR; i++)
+	{
+		comp->ctxts_mru[i].hash = 0;
+		comp->ctxts_mru[i].cid = ROHC_COMP_CTXT_INDEX_EMPTY;
+		comp->ctxts_mru[i].profile_id = 0;
+	}
+
+	/* all the contexts and frequency groups are unused */
+	c_chain_unused_contexts(comp);
+	comp->ctxts_freqs_unused = NULL;
+	comp->ctxts_recycle_head = NULL;
+	comp->ctxts_recycle_tail = NULL;
+	comp->ctxts_probation_head = NULL;
+	comp->ctxts_probation_tail = NULL;
+	comp->probation_nr = 0;
+	comp->ctxts_slru_unprotected = NULL;
+	comp->slru_protected_nr = 0;
+
+	return true;
+
+free_used:
+	zfree(comp->ctxts_used);
+free_chunks:
+	zfree(comp->ctxts_chunks);
+error:
+	return false;
+}
+
+
+/**
+ * @brief Allocate the chunk of compression contexts with the given index
+ *
+ * The contexts of the chunk are unused, their frequency groups are given to
+ * the unused groups. The index of contexts grows if needed, so that it stays
+ * at least twice as large as the contexts allocated. Nothing is done if the
+ * chunk is already allocated.
+ *
+ * @param comp       The ROHC compressor
+ * @param chunk_idx  The index of the chunk, ie. the CIDs of the chunk divided
+ *                   by \ref ROHC_COMP_CTXTS_CHUNK_LEN
+ * @return           true if the chunk is allocated, false otherwise
+ */
+static bool c_alloc_ctxts_chunk(struct rohc_comp *const comp,
+                                const size_t chunk_idx)
+{
+	const rohc_cid_t cid_first = chunk_idx * ROHC_COMP_CTXTS_CHUNK_LEN;
+	struct rohc_comp_ctxts_chunk *chunk;
+	void *mem;
+	size_t i;
+
+	assert(cid_first <= comp->medium.max_cid);
+
+	if(comp->ctxts_chunks[chunk_idx] != NULL)
+	{
+		return true;
+	}
+
+	if(!c_grow_index(comp, rohc_min((comp->ctxts_chunks_nr + 1) *
+	                                ROHC_COMP_CTXTS_CHUNK_LEN,
+	                                comp->medium.max_cid + 1)))
+	{
+		goto error;
+	}
+
+	/* one more cache line to align the statistics on cache lines */
+	if(rohc_ctxt_pool_has_slabs(&comp->ctxts_chunks_pool))
+	{
+		mem = rohc_ctxt_pool_get(&comp->ctxts_chunks_pool,
+		                         sizeof(struct rohc_comp_ctxts_chunk) +
+		                         ROHC_CACHE_LINE_LEN, NULL);
+	}
+	else
+	{
+		mem = rohc_calloc(1, sizeof(struct rohc_comp_ctxts_chunk) +
+		                  ROHC_CACHE_LINE_LEN);
+	}
+	if(mem == NULL)
+	{
+		rohc_error(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		           "cannot allocate memory for the contexts with CIDs %zu "
+		           "to %zu", cid_first,
+		           cid_first + ROHC_COMP_CTXTS_CHUNK_LEN - 1);
+		goto error;
+	}
+	chunk = rohc_cache_line_align(mem);
+	chunk->mem = mem;
+	for(i = 0; i < ROHC_COMP_CTXTS_CHUNK_LEN; i++)
+	{
+		chunk->ctxts[i].cid = cid_first + i;
+		chunk->freqs[i].next_unused = comp->ctxts_freqs_unused;
+		comp->ctxts_freqs_unused = &chunk->freqs[i];
+	}
+
+	/* publish the chunk for rohc_comp_get_ctxts_stats() */
+	__atomic_store_n(&comp->ctxts_chunks[chunk_idx], chunk, __ATOMIC_RELEASE);
+	comp->ctxts_chunks_nr++;
+	rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+	           "contexts with CIDs %zu to %zu allocated (%zu chunks)",
+	           cid_first, cid_first + ROHC_COMP_CTXTS_CHUNK_LEN - 1,
+	           comp->ctxts_chunks_nr);
+
+	return true;
+
+error:
+	return false;
+}
+
+
+/**
+ * @brief Allocate the chunks of compression contexts for the given CIDs
+ *
+ * @param comp       The ROHC compressor
+ * @param cid_first  The first CID to allocate the context of
+ * @param cid_last   The last CID to allocate the context of
+ * @return           true if the chunks are allocated, false otherwise
+ */
+static bool c_alloc_ctxts_chunks(struct rohc_comp *const comp,
+                                 const rohc_cid_t cid_first,
+                                 const rohc_cid_t cid_last)
+{
+	size_t chunk_idx;
+
+	assert(cid_first <= cid_last);
+	assert(cid_last <= comp->medium.max_cid);
+
+	for(chunk_idx = cid_first / ROHC_COMP_CTXTS_CHUNK_LEN;
+	    chunk_idx <= cid_last / ROHC_COMP_CTXTS_CHUNK_LEN; chunk_idx++)
+	{
+		if(!c_alloc_ctxts_chunk(comp, chunk_idx))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
+/**
+ * @brief Grow the index of compression contexts for the given number of
+ *        contexts
+ *
+ * The index holds at least twice as many buckets as contexts to keep the
+ * probe sequences short. The contexts already indexed are moved to the new
+ * buckets. Nothing is done if the index is already large enough.
+ *
+ * @param comp     The ROHC compressor
+ * @param ctxts_nr  The number of contexts the index shall hold
+ * @return          true if the index is large enough, false otherwise
+ */
+static bool c_grow_index(struct rohc_comp *const comp, const size_t ctxts_nr)
+{
+	struct rohc_comp_ctxt_bucket *const old_index = comp->ctxts_index;
+	const size_t old_buckets_nr =
+		(old_index == NULL ? 0 : comp->ctxts_index_mask + 1);
+	struct rohc_comp_ctxt_bucket *index;
+	size_t buckets_nr;
+	size_t i;
+
+	for(buckets_nr = 1; buckets_nr < (ctxts_nr * 2); buckets_nr <<= 1)
+	{
+	}
+	if(buckets_nr <= old_buckets_nr)
+	{
+		return true;
+	}
+
+	index = rohc_malloc(buckets_nr * sizeof(struct rohc_comp_ctxt_bucket));
+	if(index == NULL)
+	{
+		rohc_error(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		           "cannot allocate memory for the index of contexts");
+		goto error;
+	}
+	for(i = 0; i < buckets_nr; i++)
+	{
+		index[i].hash = 0;
+		index[i].cid = ROHC_COMP_CTXT_INDEX_EMPTY;
+		index[i].profile_id = 0;
+	}
+
+	/* move the indexed contexts to their new buckets */
+	for(i = 0; i < old_buckets_nr; i++)
+	{
+		size_t bucket;
+
+		if(old_index[i].cid == ROHC_COMP_CTXT_INDEX_EMPTY)
+		{
+			continue;
+		}
+		for(bucket = old_index[i].hash & (buckets_nr - 1);
+		    index[bucket].cid != ROHC_COMP_CTXT_INDEX_EMPTY;
+		    bucket = (bucket + 1) & (buckets_nr - 1))
+		{
+		}
+		index[bucket] = old_index[i];
+	}
+
+	rohc_free(old_index);
+	comp->ctxts_index = index;
+	comp->ctxts_index_mask = buckets_nr - 1;
+
+	return true;
+
+error:
+	return false;
+}
+
+
+/**
+ * @brief Get the compression context with the given CID
+ *
+ * @param comp  The ROHC compressor
+ * @param cid   The CID of the context, its chunk shall be allocated
+ * @return      The compression context, in use or not
+ */
+static struct rohc_comp_ctxt *
+	c_ctxt_at(const struct rohc_comp *const comp, const rohc_cid_t cid)
+{
+	struct rohc_comp_ctxts_chunk *const chunk =
+		comp->ctxts_chunks[cid / ROHC_COMP_CTXTS_CHUNK_LEN];
+
+	assert(chunk != NULL);
+	return &chunk->ctxts[cid % ROHC_COMP_CTXTS_CHUNK_LEN];
+}
+
+
+/**
+ * @brief Get the statistics of the compression context with the given CID
+ *
+ * @param comp  The ROHC compressor
+ * @param cid   The CID of the context, its chunk shall be allocated
+ * @return      The statistics of the compression context
+ */
+static struct rohc_comp_ctxt_stats *
+	c_ctxt_stats_at(const struct rohc_comp *const comp, const rohc_cid_t cid)
+{
+	struct rohc_comp_ctxts_chunk *const chunk =
+		comp->ctxts_chunks[cid / ROHC_COMP_CTXTS_CHUNK_LEN];
+
+	assert(chunk != NULL);
+	return &chunk->stats[cid % ROHC_COMP_CTXTS_CHUNK_LEN];
+}
+
+
+/**
+ * @brief Chain the unused compression contexts of the CID range
+ *
+ * The contexts are handed out in the CID order, so that the first context to
+ * be used is the first unused CID of the range. The contexts in use are
+ * skipped. The CIDs of the range are walked lazily by
+ * \ref c_peek_unused_context, so that no chunk of contexts is allocated
+ * before it is needed.
+ *
+ * @param comp The ROHC compressor
+ */
+static void c_chain_unused_contexts(struct rohc_comp *const comp)
+{
+	assert(comp->cid_first <= comp->cid_last);
+	assert(comp->cid_last <= comp->medium.max_cid);
+
+	comp->ctxts_unused = NULL;
+	comp->ctxts_unused_next = comp->cid_first;
+}
+
+
+/**
+ * @brief Get the next unused compression context
+ *
+ * The contexts destroyed since the CID range was chained come first, the most
+ * recently destroyed one first. The unused CIDs of the range follow in the
+ * CID order, their chunks of contexts are allocated when needed. The context
+ * is not taken from the unused contexts, see \ref c_take_unused_context.
+ *
+ * @param comp         The ROHC compressor
+ * @param[out] context  The next unused context, NULL if all the contexts of
+ *                      the CID range are in use
+ * @return              true if successful,
+ *                      false if the chunk of the context cannot be allocated
+ */
+static bool c_peek_unused_context(struct rohc_comp *const comp,
+                                  struct rohc_comp_ctxt **const context)
+{
+	if(comp->ctxts_unused != NULL)
+	{
+		*context = comp->ctxts_unused;
+		return true;
+	}
+
+	/* no destroyed context is chained, so the unused contexts that the walk
+	 * finds are not chained */
+	while(comp->ctxts_unused_next <= comp->cid_last)
+	{
+		const rohc_cid_t cid = comp->ctxts_unused_next;
+
+		if(!rohc_bitmap_test(comp->ctxts_used, cid))
+		{
+			if(!c_alloc_ctxts_chunk(comp, cid / ROHC_COMP_CTXTS_CHUNK_LEN))
+			{
+				return false;
+			}
+			*context = c_ctxt_at(comp, cid);
+			return true;
+		}
+		comp->ctxts_unused_next++;
+	}
+
+	*context = NULL;
+	return true;
+}
+
+
+/**
+ * @brief Take the context given by \ref c_peek_unused_context from the
+ *        unused contexts
+ *
+ * @param comp     The ROHC compressor
+ * @param context  The unused context to take
+ */
+static void c_take_unused_context(struct rohc_comp *const comp,
+                                  struct rohc_comp_ctxt *const context)
+{
+	if(context == comp->ctxts_unused)
+	{
+		comp->ctxts_unused = context->recycle_next;
+		context->recycle_next = NULL;
+	}
+	else
+	{
+		assert(comp->ctxts_unused == NULL);
+		assert(context->cid == comp->ctxts_unused_next);
+		comp->ctxts_unused_next++;
+	}
+}
+
+
+/**
+ * @brief Get the CID of the next compression context in use
+ *
+ * @param comp  The ROHC compressor
+ * @param from  The first CID to check
+ * @return      The first CID in use at or after \e from,
+ *              MAX_CID + 1 if there is none
+ */
+static rohc_cid_t c_next_used_cid(const struct rohc_comp *const comp,
+                                  const rohc_cid_t from)
+{
+	return rohc_bitmap_next(comp->ctxts_used, comp->medium.max_cid + 1, from);
+}
+
+
+/**
+ * @brief Destroy all the compression contexts in the context array
+ *
+ * The profile-specific contexts are also destroyed.
+ *
+ * @param comp The ROHC compressor
+ */
+static void c_destroy_contexts(struct rohc_comp *const comp)
+{
+	const size_t chunks_max =
+		comp->medium.max_cid / ROHC_COMP_CTXTS_CHUNK_LEN + 1;
+	rohc_cid_t i;
+
+	assert(comp->ctxts_chunks != NULL);
+
+	for(i = c_next_used_cid(comp, 0); i <= comp->medium.max_cid;
+	    i = c_next_used_cid(comp, i + 1))
+	{
+		c_destroy_context(comp, c_ctxt_at(comp, i));
+	}
+	assert(comp->num_contexts_used == 0);
+	assert(comp->ctxts_recycle_head == NULL);
+	assert(comp->ctxts_recycle_tail == NULL);
+	assert(comp->probation_nr == 0);
+
+	rohc_free(comp->ctxts_index);
+	comp->ctxts_index = NULL;
+	rohc_free(comp->ctxts_used);
+	comp->ctxts_used = NULL;
+	for(i = 0; i < chunks_max; i++)
+	{
+		if(comp->ctxts_chunks[i] == NULL)
+		{
+			continue;
+		}
+		if(rohc_ctxt_pool_has_slabs(&comp->ctxts_chunks_pool))
+		{
+			rohc_ctxt_pool_put(&comp->ctxts_chunks_pool,
+			                   comp->ctxts_chunks[i]->mem);
+		}
+		else
+		{
+			rohc_free(comp->ctxts_chunks[i]->mem);
+		}
+	}
+	rohc_free(comp->ctxts_chunks);
+	comp->ctxts_chunks = NULL;
+	comp->ctxts_chunks_nr = 0;
+	comp->ctxts_unused = NULL;
+	comp->ctxts_freqs_unused = NULL;
+}
+
+
+/**
+ * @brief Change the mode of the context.
+ *
+ * @param context  The compression context
+ * @param new_mode The new mode the context must enter in
+ */
+void rohc_comp_change_mode(struct rohc_comp_ctxt *const context,
+                           const rohc_mode_t new_mode)
+{
+	if(context->mode != new_mode)
+	{
+		/* TODO: R-mode is not yet supported */
+		if(new_mode == ROHC_R_MODE)
+		{
+			rohc_comp_warn(context, "ignore change to R-mode because R-mode is "
+			               "not supported yet");
+			return;
+		}
+
+		/* change mode and go back to IR state: in U-mode, the context is then
+		 * kept in sync by the periodic refreshes only, as for a new context */
+		const rohc_mode_t old_mode = context->mode;
+
+		rohc_info(context->compressor, ROHC_TRACE_COMP, context->profile->id,
+		          "CID %zu: change from mode %d to mode %d",
+		          context->cid, context->mode, new_mode);
+		context->mode = new_mode;
+		rohc_comp_change_state(context, ROHC_COMP_STATE_IR);
+		c_notify_ctxt_event(context, ROHC_COMP_EVENT_MODE_CHANGE,
+		                    context->state, old_mode);
+	}
+}
+
+
+/**
+ * @brief Change the state of the context.
+ *
+ * @param context   The compression context
+ * @param new_state The new state the context must enter in
+ */
+void rohc_comp_change_state(struct rohc_comp_ctxt *const context,
+                            const rohc_comp_state_t new_state)
+{
+	if(new_state != context->state)
+	{
+		const rohc_comp_state_t old_state = context->state;
+
+		rohc_info(context->compressor, ROHC_TRACE_COMP, context->profile->id,
+		          "CID %zu: change from state %d to state %d",
+		          context->cid, context->state, new_state);
+
+		/* reset counters */
+		context->ir_count = 0;
+		context->fo_count = 0;
+		context->so_count = 0;
+
+		/* start the time-based periodic refreshes: the time spent in SO state
+		 * before the refresh to FO state, the time spent in FO and SO states
+		 * before the refresh to IR state */
+		if(context->compressor->periodic_refreshes_ir_timeout_time > 0)
+		{
+			if(new_state == ROHC_COMP_STATE_SO)
+			{
+				c_arm_refresh_timer(context, &context->go_back_fo_timer,
+				                    context->compressor->periodic_refreshes_fo_timeout_time);
+			}
+			if(context->state == ROHC_COMP_STATE_IR)
+			{
+				c_arm_refresh_timer(context, &context->go_back_ir_timer,
+				                    context->compressor->periodic_refreshes_ir_timeout_time);
+			}
+		}
+
+		/* change state */
+		context->state = new_state;
+		c_notify_ctxt_event(context, ROHC_COMP_EVENT_STATE_CHANGE, old_state,
+		                    context->mode);
+	}
+}
+
+
+/**
+ * @brief Call the callback of the user for one event of one context
+ *
+ * The state and the mode of the context after the event are the current
+ * state and mode of the context.
+ *
+ * @param context    The compression context
+ * @param event      The event
+ * @param old_state  The state of the context before the event
+ * @param old_mode   The mode of the context before the event
+ */
+static void c_notify_ctxt_event(const struct rohc_comp_ctxt *const context,
+                                const rohc_comp_event_t event,
+                                const rohc_comp_state_t old_state,
+                                const rohc_mode_t old_mode)
+{
+	const struct rohc_comp *const comp = context->compressor;
+	rohc_comp_event_info_t info;
+
+	if(comp->event_cb == NULL)
+	{
+		return;
+	}
+
+	info.event = event;
+	info.cid = context->cid;
+	info.profile_id = context->profile->id;
+	info.old_state = old_state;
+	info.new_state = context->state;
+	info.old_mode = old_mode;
+	info.new_mode = context->mode;
+	comp->event_cb(comp->event_cb_priv, &info);
+}
+
+
+/**
+ * @brief Arm one timer for the time-based periodic refreshes of a context
+ *
+ * The timeout is shortened by up to one eighth depending on the CID of the
+ * context, so that the contexts that changed state together do not send
+ * their refreshes together.
+ *
+ * @param context  The compression context
+ * @param timer    The timer of the context to arm
+ * @param timeout  The timeout (in milliseconds)
+ */
+static void c_arm_refresh_timer(struct rohc_comp_ctxt *const context,
+                                struct rohc_comp_timer *const timer,
+                                const uint64_t timeout)
+{
+	const uint32_t cid_hash = ((uint32_t) context->cid) * 2654435761U;
+	const uint64_t spread = ((timeout >> 3) * (cid_hash >> 24)) >> 8;
+
+	rohc_comp_wheel_arm(&context->compressor->refresh_wheel, timer,
+	                    timeout - spread);
+}
+
+
+/**
+ * @brief Whether the paced re-initialization allows one more context to be
+ *        re-initialized now
+ *
+ * @param comp  The ROHC compressor
+ * @param now   The arrival time of the current packet (in milliseconds)
+ * @return      true if one more context may be re-initialized,
+ *              false if the context shall wait for a next packet
+ */
+static bool c_reinit_is_allowed(struct rohc_comp *const comp,
+                                const uint64_t now)
+{
+	struct rohc_comp_reinit *const reinit = &comp->reinit;
+	const uint64_t elapsed = (now > reinit->start ? now - reinit->start : 0);
+
+	if(!reinit->is_started)
+	{
+		reinit->start = now;
+		reinit->credit.last_refill = now;
+		reinit->is_started = true;
+		return true;
+	}
+	c_credit_refill(&reinit->credit, now);
+
+	/* all the contexts left are re-initialized once the duration elapsed */
+	if(reinit->duration > 0 && elapsed >= reinit->duration)
+	{
+		return true;
+	}
+
+	/* the contexts are re-initialized at a constant pace over the duration */
+	if(reinit->duration > 0 &&
+	   ((uint64_t) (reinit->total_nr - reinit->pending_nr)) * reinit->duration >
+	   ((uint64_t) reinit->total_nr) * elapsed)
+	{
+		return false;
+	}
+
+	/* the ROHC headers of the previous re-initializations shall be paid for */
+	return c_credit_is_available(&reinit->credit);
+}
+
+
+/**
+ * @brief Refill the given credit of bytes up to the given time
+ *
+ * @param credit  The credit of bytes
+ * @param now     The current time (in milliseconds)
+ */
+static void c_credit_refill(struct rohc_comp_credit *const credit,
+                            const uint64_t now)
+{
+	if(credit->bytes_rate > 0 && now > credit->last_refill)
+	{
+		const uint64_t refill =
+			(now - credit->last_refill) * credit->bytes_rate / 1000U;
+
+		/* wait for at least one byte, not to lose the fractions of bytes */
+		if(refill > 0)
+		{
+			credit->bytes += refill;
+			if(credit->bytes > 0)
+			{
+				credit->bytes = 0;
+			}
+			credit->last_refill = now;
+		}
+	}
+}
+
+
+/**
+ * @brief Whether the previous expenses of the given credit are paid for
+ *
+ * @param credit  The credit of bytes
+ * @return        true if one more expense is allowed, false otherwise
+ */
+static bool c_credit_is_available(const struct rohc_comp_credit *const credit)
+{
+	return (credit->bytes_rate == 0 || credit->bytes >= 0);
+}
+
+
+/**
+ * @brief Periodically change the context state after a certain number
+ *        of packets.
+ *
+ * @param context The compression context
+ */
+void rohc_comp_periodic_down_transition(struct rohc_comp_ctxt *const context)
+{
+	struct rohc_comp *const comp = context->compressor;
+	const bool is_fo_refresh =
+		(context->go_back_fo_count >= comp->periodic_refreshes_fo_timeout ||
+		 (context->state == ROHC_COMP_STATE_SO &&
+		  context->go_back_fo_timer.is_expired));
+	const bool is_ir_refresh =
+		(context->go_back_ir_count >= comp->periodic_refreshes_ir_timeout ||
+		 (context->state != ROHC_COMP_STATE_IR &&
+		  context->go_back_ir_timer.is_expired));
+
+	rohc_debug(context->compressor, ROHC_TRACE_COMP, context->profile->id,
+	           "CID %zu: timeouts for periodic refreshes: FO = %zu / %zu, "
+	           "IR = %zu / %zu", context->cid, (size_t) context->go_back_fo_count,
+	           context->compressor->periodic_refreshes_fo_timeout,
+	           (size_t) context->go_back_ir_count,
+	           context->compressor->periodic_refreshes_ir_timeout);
+
+	if((is_fo_refresh || is_ir_refresh) &&
+	   !c_credit_is_available(&comp->refreshes_credit))
+	{
+		/* the refresh is postponed to one next packet of the context */
+		rohc_debug(comp, ROHC_TRACE_COMP, context->profile->id,
+		           "CID %zu: periodic refresh postponed, the bandwidth for "
+		           "refreshes is exhausted", context->cid);
+	}
+	else if(is_fo_refresh)
+	{
+		rohc_info(context->compressor, ROHC_TRACE_COMP, context->profile->id,
+		          "CID %zu: periodic change to FO state", context->cid);
+		context->go_back_fo_count = 0;
+		rohc_comp_change_state(context, ROHC_COMP_STATE_FO);
+		comp->refresh_packets_nr = MAX_FO_COUNT;
+	}
+	else if(is_ir_refresh)
+	{
+		rohc_info(context->compressor, ROHC_TRACE_COMP, context->profile->id,
+		          "CID %zu: periodic change to IR state", context->cid);
+		context->go_back_ir_count = 0;
+		rohc_comp_change_state(context, ROHC_COMP_STATE_IR);
+		comp->refresh_packets_nr = MAX_IR_COUNT;
+	}
+
+	if(context->state == ROHC_COMP_STATE_SO)
+	{
+		context->go_back_fo_count++;
+	}
+	if(context->state == ROHC_COMP_STATE_SO ||
+	   context->state == ROHC_COMP_STATE_FO)
+	{
+		context->go_back_ir_count++;
+	}
+}
+
+
+/**
+ * @brief Re-initialize the given context
+ *
+ * Make the context restart its initialization with decompressor, ie. it goes
+ * in the lowest compression state.
+ *
+ * @param context  The compression context to re-initialize
+ * @return         true in case of success, false otherwise
+ */
+bool rohc_comp_reinit_context(struct rohc_comp_ctxt *const context)
+{
+	assert(context != NULL);
+
+	/* go back to U-mode and IR state */
+	rohc_comp_change_mode(context, ROHC_U_MODE);
+	rohc_comp_change_state(context, ROHC_COMP_STATE_IR);
+
+	return true;
+}
+
+
+/**
+ * @brief Parse ROHC feedback CID
+ *
+ * @param comp         The ROHC compressor
+ * @param feedback      The ROHC feedback data to parse
+ * @param feedback_len  The length of the ROHC feedback data
+ * @param[out] cid      The CID of the ROHC feedback
+ * @param[out] cid_len  The length of the CID of the ROHC feedback
+ * @return              true if feedback CID was successfully parsed,
+ *                      false if feedback CID is malformed
+ */
+static bool rohc_comp_feedback_parse_cid(const struct rohc_comp *const comp,
+                                         const uint8_t *const feedback,
+                                         const size_t feedback_len,
+                                         rohc_cid_t *const cid,
+                                         size_t *const cid_len)
+{
+	/* decode CID */
+	if(comp->medium.cid_type == ROHC_LARGE_CID)
+	{
+		size_t large_cid_size;
+		uint32_t large_cid;
+
+		/* decode SDVL-encoded large CID field */
+		large_cid_size = sdvl_decode_large_cid(feedback, feedback_len, &large_cid);
+		if(large_cid_size == 0)
+		{
+			rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+			             "failed to parse feedback: failed to decode SDVL-encoded "
+			             "large CID field");
+			goto error;
+		}
+		*cid = large_cid;
+		*cid_len = large_cid_size;
+	}
+	else
+	{
+		/* decode small CID if present */
+		*cid = rohc_add_cid_decode(feedback, feedback_len);
+		if((*cid) == UINT8_MAX)
+		{
+			*cid_len = 0;
+			*cid = 0;
+		}
+		else
+		{
+			*cid_len = 1;
+		}
+	}
+
+	rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+	           "feedback CID = %zu", *cid);
+
+	return true;
+
+error:
+	return false;
+}
+
+
+/**
+ * @brief Parse FEEDBACK-2 options
+ *
+ * @param context            The ROHC decompression context
+ * @param packet             The whole feedback packet with CID bits
+ * @param packet_len         The length of the whole feedback packet with CID bits
+ * @param feedback_data      The feedback data without the CID bits
+ * @param feedback_data_len  The length of the feedback data without the CID bits
+ * @param[out] opts_present  Whether options are present or not
+ * @param[out] sn_bits       in: the SN bits collected in base header
+ *                           out: the SN bits collected in base header and options
+ * @param[out] sn_bits_nr    in: the number of SN bits collected in base header
+ *                           out: the number of SN bits collected in base header
+ *                                and options
+ * @param crc_in_packet      The CRC of the feedback packet
+ * @param crc_pos_from_end   The position of the CRC byte from the end of the
+ *                           feedback packet
+ * @return                   true if feedback options were successfully parsed,
+ *                           false if feedback options were malformed or CRC is wrong
+ */
+bool rohc_comp_feedback_parse_opts(const struct rohc_comp_ctxt *const context,
+                                   const uint8_t *const packet,
+                                   const size_t packet_len,
+                                   const uint8_t *const feedback_data,
+                                   const size_t feedback_data_len,
+                                   size_t opts_present[ROHC_FEEDBACK_OPT_MAX],
+                                   uint32_t *const sn_bits,
+                                   size_t *const sn_bits_nr,
                                    uint8_t crc_in_packet,
                                    size_t crc_pos_from_end)
 {
-	const uint8_t *remain_data = feedback_data;
-	size_t remain_len = feedback_data_len;
+	const uint8_t *remain_data = feedback_data;
+	size_t remain_len = feedback_data_len;
+
+	/* parse options */
+	while(remain_len > 0)
+	{
+		const uint8_t opt_type = (remain_data[0] >> 4) & 0x0f;
+		const uint8_t opt_len = (remain_data[0] & 0x0f) + 1;
+		const char *const opt_name = rohc_feedback_opt_charac[opt_type].name;
+		const size_t opt_unknown = rohc_feedback_opt_charac[opt_type].unknown;
+		const size_t opt_supported = rohc_feedback_opt_charac[opt_type].supported;
+		const size_t opt_exp_len = rohc_feedback_opt_charac[opt_type].expected_len;
+
+		rohc_comp_debug(context, "FEEDBACK-2: %s option (%u) found",
+		                opt_name, opt_type);
+
+		/* check min length */
+		if(remain_len < opt_len)
+		{
+			rohc_comp_warn(context, "malformed FEEDBACK-2: packet too short for "
+			               "%u-byte option %u, only %zu bytes remaning", opt_len,
+			               opt_type, remain_len);
+			goto error;
+		}
+
+		if(opt_unknown)
+		{
+			/* unknown options must be ignored (see RFC3095, §5.7.6.10) */
+			rohc_comp_warn(context, "FEEDBACK-2: %s option (%d) is not unknown, "
+			               "ignore it", opt_name, opt_type);
+		}
+		else if(!opt_supported)
+		{
+			/* unknown options must be ignored (see RFC3095, §5.7.6.10) */
+			rohc_comp_warn(context, "FEEDBACK-2: %s option (%d) is not supported "
+			               "yet, ignore it", opt_name, opt_type);
+		}
+		else if(opt_len != opt_exp_len) /* check real length against the expected one */
+		{
+			rohc_comp_warn(context, "malformed FEEDBACK-2: malformed %s option "
+			               "(%u) %u bytes advertised while %zu bytes expected",
+			               opt_name, opt_type, opt_len, opt_exp_len);
+			goto error;
+		}
+		else if(opt_type == ROHC_FEEDBACK_OPT_CRC)
+		{
+			if(opts_present[opt_type] == 0)
+			{
+				/* first CRC option */
+				crc_in_packet = remain_data[1];
+			}
+			else if(crc_in_packet != remain_data[1])
+			{
+				/* multiple CRC options are allowed, but they must be identical
+				 * (see RFC4815, §8.6) */
+				rohc_comp_warn(context, "malformed FEEDBACK-2: duplicate CRC option "
+				               "#%zu specifies a CRC value 0x%02x instead of CRC "
+				               "0x%02x specified in the first CRC option",
+				               opts_present[opt_type], remain_data[1], crc_in_packet);
+				goto error;
+			}
+			crc_pos_from_end = remain_len - 1; /* TODO: handle multiple CRC options */
+		}
+		else if(opt_type == ROHC_FEEDBACK_OPT_SN)
+		{
+			if(!rohc_comp_feedback_parse_opt_sn(context, remain_data, remain_len,
+			                                    sn_bits, sn_bits_nr))
+			{
+				rohc_comp_warn(context, "malformed FEEDBACK-2: malformed SN option");
+				goto error;
+			}
+		}
+
+		/* one more occurrence of the option */
+		opts_present[opt_type]++;
+
+		/* skip option */
+		remain_data += opt_len;
+		remain_len -= opt_len;
+	}
+
+	/* sanity checks:
+	 *  - some profiles do not support all options
+	 *  - some options cannot be specified multiple times
+	 *  - some options cannot be specified without CRC */
+	if(!rohc_comp_feedback_check_opts(context, opts_present))
+	{
+		rohc_comp_warn(context, "malformed FEEDBACK-2: malformed or unexpected options");
+		goto error;
+	}
+
+	/* check CRC if present in feedback */
+	if(opts_present[ROHC_FEEDBACK_OPT_CRC] > 0)
+	{
+		const size_t zeroed_crc_len = 1;
+		const uint8_t zeroed_crc = 0x00;
+		uint8_t crc_computed;
+
+		/* compute the CRC of the feedback packet (skip CRC byte) */
+		crc_computed = crc_calculate(ROHC_CRC_TYPE_8, packet,
+		                             packet_len - crc_pos_from_end, CRC_INIT_8);
+		crc_computed = crc_calculate(ROHC_CRC_TYPE_8, &zeroed_crc, zeroed_crc_len,
+		                             crc_computed);
+		crc_computed = crc_calculate(ROHC_CRC_TYPE_8, packet + packet_len -
+		                             crc_pos_from_end + 1, crc_pos_from_end - 1,
+		                             crc_computed);
+
+		/* ignore feedback in case of bad CRC */
+		if(crc_in_packet != crc_computed)
+		{
+			rohc_comp_warn(context, "CRC check failed: CRC computed on %zu bytes "
+			               "(0x%02x) does not match packet CRC (0x%02x)",
+			               packet_len, crc_computed, crc_in_packet);
+			goto error;
+		}
+	}
+
+	return true;
+
+error:
+	return false;
+}
+
+
+/**
+ * @brief Parse the FEEDBACK-2 SN option
+ *
+ * @param context            The ROHC decompression context
+ * @param feedback_data      The feedback data without the CID bits
+ * @param feedback_data_len  The length of the feedback data without the CID bits
+ * @param[out] sn_bits       in: the SN bits collected in base header
+ *                           out: the SN bits collected in base header and options
+ * @param[out] sn_bits_nr    in: the number of SN bits collected in base header
+ *                           out: the number of SN bits collected in base header
+ *                                and options
+ * @return                   true if feedback options were successfully parsed,
+ *                           false if feedback options were malformed or CRC is wrong
+ */
+static bool rohc_comp_feedback_parse_opt_sn(const struct rohc_comp_ctxt *const context,
+                                            const uint8_t *const feedback_data,
+                                            const size_t feedback_data_len,
+                                            uint32_t *const sn_bits,
+                                            size_t *const sn_bits_nr)
+{
+	const uint8_t *remain_data = feedback_data;
+
+	/* min length already checked in caller function */
+	assert(feedback_data_len >= 2);
+
+	if(rohc_feedback_is_rfc6846(context->profile->id))
+	{
+		if(((*sn_bits) & 0xffffc000) != 0)
+		{
+			rohc_comp_warn(context, "malformed FEEDBACK-2: more than 16 bits "
+			               "used for MSN of the TCP or ROHCv2 profiles");
+#ifndef ROHC_RFC_STRICT_DECOMPRESSOR
+			rohc_comp_warn(context, "malformed FEEDBACK-2: truncate the MSB "
+			               "of the unexpected SN value");
+			(*sn_bits) &= 0x00003fff;
+#else
+			goto error;
+#endif
+		}
+		(*sn_bits) = ((*sn_bits) << 2) + ((remain_data[1] >> 6) & 0x03);
+		(*sn_bits_nr) += 2;
+	}
+	else if(context->profile->id == ROHC_PROFILE_ESP)
+	{
+		if(((*sn_bits) & 0xff000000) != 0)
+		{
+			rohc_comp_warn(context, "malformed FEEDBACK-2: more than 32 bits "
+			               "used for SN of the ESP profile");
+#ifndef ROHC_RFC_STRICT_DECOMPRESSOR
+			rohc_comp_warn(context, "malformed FEEDBACK-2: truncate the MSB "
+			               "of the unexpected SN value");
+			(*sn_bits) &= 0x00ffffff;
+#else
+			goto error;
+#endif
+		}
+		(*sn_bits) = ((*sn_bits) << 8) + (remain_data[1] & 0xff);
+		(*sn_bits_nr) += 8;
+	}
+	else /* non-TCP and non-ESP profiles */
+	{
+		if(((*sn_bits) & 0xffffff00) != 0)
+		{
+			rohc_comp_warn(context, "malformed FEEDBACK-2: more than 16 bits "
+			               "used for SN of the non-ESP profile");
+#ifndef ROHC_RFC_STRICT_DECOMPRESSOR
+			rohc_comp_warn(context, "malformed FEEDBACK-2: truncate the MSB "
+			               "of the unexpected SN value");
+			(*sn_bits) &= 0x000000ff;
+#else
+			goto error;
+#endif
+		}
+		(*sn_bits) = ((*sn_bits) << 8) + (remain_data[1] & 0xff);
+		(*sn_bits_nr) += 8;
+	}
+
+	return true;
+
+#ifdef ROHC_RFC_STRICT_DECOMPRESSOR
+error:
+	return false;
+#endif
+}
+
+
+/**
+ * @brief Check FEEDBACK-2 options
+ *
+ * sanity checks:
+ *  - some profiles do not support all options
+ *  - some options cannot be specified multiple times
+ *  - some options cannot be specified without CRC
+ *
+ * @param context       The ROHC decompression context
+ * @param opts_present  Whether options are present or not
+ * @return              true if feedback options are valid,
+ *                      false if feedback options are not valid
+ */
+static bool rohc_comp_feedback_check_opts(const struct rohc_comp_ctxt *const context,
+                                          const size_t opts_present[ROHC_FEEDBACK_OPT_MAX])
+{
+	uint8_t opt_type;
+	assert(context->profile->id < ROHC_PROFILE_MAX);
+
+	for(opt_type = 0; opt_type < ROHC_FEEDBACK_OPT_MAX; opt_type++)
+	{
+		if(opts_present[opt_type] > 0 &&
+		   !rohc_feedback_opt_charac[opt_type].unknown &&
+		   rohc_feedback_opt_charac[opt_type].supported)
+		{
+			const size_t max_occurs =
+				rohc_feedback_opt_charac[opt_type].max_occurs[context->profile->id];
+
+			/* is the option supported by the current compression profile? */
+			if(max_occurs == 0)
+			{
+				rohc_comp_warn(context, "malformed FEEDBACK-2: %s option (%u) is "
+				               "not defined for the compression profile '%s' (%d)",
+				               rohc_feedback_opt_charac[opt_type].name, opt_type,
+				               rohc_get_profile_descr(context->profile->id),
+				               context->profile->id);
+#ifdef ROHC_RFC_STRICT_DECOMPRESSOR
+				goto error;
+#endif
+			}
+			/* warn about multiple options */
+			else if(opts_present[opt_type] > max_occurs)
+			{
+				rohc_comp_warn(context, "malformed FEEDBACK-2: %s option (%u) is "
+				               "specified %zu times while compression profile '%s' "
+				               "(%d) allows only %zu times",
+				               rohc_feedback_opt_charac[opt_type].name, opt_type,
+				               opts_present[opt_type],
+				               rohc_get_profile_descr(context->profile->id),
+				               context->profile->id, max_occurs);
+				goto error;
+			}
+
+			/* some options cannot be specified without CRC */
+			if(opts_present[ROHC_FEEDBACK_OPT_CRC] == 0)
+			{
+				switch(rohc_feedback_opt_charac[opt_type].crc_req)
+				{
+					case ROHC_FEEDBACK_OPT_CRC_REQUIRED:
+						rohc_comp_warn(context, "malformed FEEDBACK-2: %s option (%u) "
+						               "must be specified along with a CRC option",
+						               rohc_feedback_opt_charac[opt_type].name, opt_type);
+						goto error;
+					case ROHC_FEEDBACK_OPT_CRC_SUGGESTED:
+						rohc_comp_warn(context, "malformed FEEDBACK-2: %s option (%u) "
+						               "should be specified along with a CRC option",
+						               rohc_feedback_opt_charac[opt_type].name, opt_type);
+#ifdef ROHC_RFC_STRICT_DECOMPRESSOR
+						goto error;
+#else
+						break;
+#endif
+					case ROHC_FEEDBACK_OPT_CRC_NOT_REQUIRED:
+						break;
+					default:
+						assert(0);
+						goto error;
+				}
+			}
+		}
+	}
+
+	return true;
+
+error:
+	return false;
+}
+
+
+/**
+ * @brief Check the buffers given to compress one packet
+ *
+ * @param comp           The ROHC compressor
+ * @param uncomp_packet  The uncompressed packet to compress
+ * @param rohc_packet    The buffer for the compressed ROHC packet
+ * @return               true if buffers are valid, false otherwise
+ */
+static bool c_check_bufs(const struct rohc_comp *const comp,
+                         const struct rohc_buf uncomp_packet,
+                         const struct rohc_buf *const rohc_packet)
+{
+	if(rohc_buf_is_malformed(uncomp_packet))
+	{
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		             "given uncomp_packet is malformed");
+		return false;
+	}
+	if(rohc_buf_is_empty(uncomp_packet))
+	{
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		             "given uncomp_packet is empty");
+		return false;
+	}
+	if(rohc_packet == NULL)
+	{
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		             "given rohc_packet is NULL");
+		return false;
+	}
+	if(rohc_buf_is_malformed(*rohc_packet))
+	{
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		             "given rohc_packet is malformed");
+		return false;
+	}
+	if(!rohc_buf_is_empty(*rohc_packet))
+	{
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		             "given rohc_packet is not empty");
+		return false;
+	}
+
+	return true;
+}
+
+
+/**
+ * @brief Parse the given uncompressed packet
+ *
+ * @param comp           The ROHC compressor
+ * @param uncomp_packet  The uncompressed packet to parse
+ * @param classify       Whether to build the key and the fingerprint of the
+ *                       flow of the packet to find its context
+ * @param[out] ip_pkt    The parsed packet
+ * @return               true if the packet was successfully parsed,
+ *                       false otherwise
+ */
+static bool c_parse_packet(const struct rohc_comp *const comp,
+                           const struct rohc_buf uncomp_packet,
+                           const bool classify,
+                           struct net_pkt *const ip_pkt)
+{
+	/* print uncompressed bytes */
+	if(rohc_trace_is_enabled(comp, ROHC_TRACE_DEBUG) &&
+	   (comp->features & ROHC_COMP_FEATURE_DUMP_PACKETS) != 0)
+	{
+		rohc_dump_packet(comp->trace_callback, comp->trace_callback_priv,
+		                 ROHC_TRACE_COMP, ROHC_TRACE_DEBUG,
+		                 "uncompressed data, max 100 bytes", uncomp_packet);
+	}
+
+	/* parse the uncompressed packet */
+	if(!net_pkt_parse(ip_pkt, uncomp_packet, comp->key_seed, classify,
+	                  comp->trace_callback, comp->trace_callback_priv,
+	                  comp->trace_level, comp->trace_pkt_level,
+	                  ROHC_TRACE_COMP))
+	{
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		             "failed to parse uncompressed packet");
+		return false;
+	}
+
+	return true;
+}
+
+
+/**
+ * @brief Parse the given uncompressed packet, the first stage of the
+ *        compression pipeline
+ *
+ * The compressor is only read, so the packet may be parsed by another thread
+ * than the one that uses the compressor, as long as the configuration of the
+ * compressor is not changed meanwhile.
+ *
+ * @param comp           The ROHC compressor
+ * @param uncomp_packet  The uncompressed packet to parse
+ * @param[out] ip_pkt    The parsed packet
+ * @return               true if the packet was successfully parsed,
+ *                       false otherwise
+ */
+bool rohc_comp_parse_packet(const struct rohc_comp *const comp,
+                            const struct rohc_buf uncomp_packet,
+                            struct net_pkt *const ip_pkt)
+{
+	if(rohc_buf_is_malformed(uncomp_packet) || rohc_buf_is_empty(uncomp_packet))
+	{
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		             "given uncomp_packet is malformed or empty");
+		return false;
+	}
 
-	/* parse options */
-	while(remain_len > 0)
+	return c_parse_packet(comp, uncomp_packet, true, ip_pkt);
+}
+
+
+/**
+ * @brief Compress the given parsed packet into a ROHC header and a reference
+ *        to the payload, the second stage of the compression pipeline
+ *
+ * The packet is classified, its context is found or created, then its ROHC
+ * header is built as \ref rohc_compress_iov does. Only the thread that uses
+ * the compressor may call this function.
+ *
+ * @param comp           The ROHC compressor
+ * @param ip_pkt         The packet parsed by \ref rohc_comp_parse_packet
+ * @param uncomp_packet  The uncompressed packet to compress
+ * @param[out] rohc_hdr  The resulting ROHC header
+ * @param[out] payload   The payload of the ROHC packet, within the memory of
+ *                       the uncompressed packet
+ * @return               The compression status, see \ref rohc_compress_iov
+ */
+rohc_status_t rohc_comp_compress_parsed(struct rohc_comp *const comp,
+                                        const struct net_pkt *const ip_pkt,
+                                        const struct rohc_buf uncomp_packet,
+                                        struct rohc_buf *const rohc_hdr,
+                                        struct rohc_buf *const payload)
+{
+	struct rohc_comp_ctxt *c;
+
+	c_trace_sample(comp, false, 0);
+	if(!c_check_bufs(comp, uncomp_packet, rohc_hdr))
 	{
-		const uint8_t opt_type = (remain_data[0] >> 4) & 0x0f;
-		const uint8_t opt_len = (remain_data[0] & 0x0f) + 1;
-		const char *const opt_name = rohc_feedback_opt_charac[opt_type].name;
-		const size_t opt_unknown = rohc_feedback_opt_charac[opt_type].unknown;
-		const size_t opt_supported = rohc_feedback_opt_charac[opt_type].supported;
-		const size_t opt_exp_len = rohc_feedback_opt_charac[opt_type].expected_len;
+		goto error;
+	}
 
-		rohc_comp_debug(context, "FEEDBACK-2: %s option (%u) found",
-		                opt_name, opt_type);
+	/* handle the feedback received by other threads meanwhile */
+	c_deliver_queued_feedbacks(comp);
 
-		/* check min length */
-		if(remain_len < opt_len)
+	/* find the best context for the packet */
+	c = rohc_comp_find_ctxt(comp, ip_pkt, -1, uncomp_packet.time);
+	if(c == NULL)
+	{
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		             "failed to find a matching context or to create a new "
+		             "context");
+		goto error;
+	}
+
+	return c_compress_in_ctxt(comp, c, ip_pkt, uncomp_packet, rohc_hdr, payload);
+
+error:
+	return ROHC_STATUS_ERROR;
+}
+
+
+/**
+ * @brief Choose the minimum level of the traces for the current packet
+ *
+ * @param comp       The ROHC compressor
+ * @param cid_known  Whether the CID of the packet is already known or not
+ * @param cid        The CID of the packet if known
+ */
+static void c_trace_sample(struct rohc_comp *const comp,
+                           const bool cid_known,
+                           const rohc_cid_t cid)
+{
+	comp->trace_sampled_level =
+		rohc_trace_sample(&comp->trace_sampling, comp->trace_level,
+		                  comp->num_packets, cid_known, cid);
+}
+
+
+/**
+ * @brief Compress the given parsed packet with the given context
+ *
+ * If the profile of the context fails to compress the packet, the packet is
+ * compressed with the Uncompressed profile instead.
+ *
+ * @param comp              The ROHC compressor
+ * @param context           The compression context to compress the packet with
+ * @param packet            The parsed uncompressed packet
+ * @param uncomp_packet     The uncompressed packet to compress
+ * @param[out] rohc_packet  The resulting compressed ROHC packet, or the
+ *                          ROHC header only if \e payload is not NULL
+ * @param[out] payload      The payload of the ROHC packet within the
+ *                          uncompressed packet, NULL to copy the payload
+ *                          after the ROHC header in \e rohc_packet
+ * @return                  The compression status, see \ref rohc_compress4
+ */
+static rohc_status_t c_compress_in_ctxt(struct rohc_comp *const comp,
+                                        struct rohc_comp_ctxt *const context,
+                                        const struct net_pkt *const packet,
+                                        const struct rohc_buf uncomp_packet,
+                                        struct rohc_buf *const rohc_packet,
+                                        struct rohc_buf *const payload)
+{
+	struct rohc_comp_ctxt *c = context;
+	const struct net_pkt *ip_pkt = packet;
+	struct net_pkt classified_pkt;
+	rohc_packet_t packet_type = ROHC_PACKET_UNKNOWN;
+	struct rohc_comp_ctxt_stats *stats;
+	int rohc_hdr_size;
+	size_t payload_size;
+	size_t payload_offset;
+	size_t payload_ref_len = 0; /* payload referenced, not copied */
+	rohc_ticks_t ticks[3];
+	const uint64_t now = ((uint64_t) uncomp_packet.time.sec) * 1000U +
+	                     uncomp_packet.time.nsec / 1000000U;
+	bool is_reinit = false;
+
+	rohc_status_t status = ROHC_STATUS_ERROR; /* error status by default */
+
+	/* the CID of the packet is known now, sample its traces again */
+	c_trace_sample(comp, true, c->cid);
+
+	ticks[0] = rohc_comp_ticks(comp);
+	if(rohc_comp_timings_enabled(comp))
+	{
+		c_timings_reset_crc(comp);
+	}
+
+	/* move the timers of the time-based periodic refreshes forward, or in
+	 * rohc_comp_maintenance() only in real-time mode */
+	if(comp->periodic_refreshes_ir_timeout_time > 0 &&
+	   (comp->features & ROHC_COMP_FEATURE_REALTIME) == 0)
+	{
+		rohc_comp_wheel_advance(&comp->refresh_wheel, now);
+	}
+	c_credit_refill(&comp->refreshes_credit, now);
+	comp->refresh_packets_nr = 0;
+
+	/* re-initialize the context if the paced re-initialization allows it */
+	if(c->reinit_pending && c_reinit_is_allowed(comp, now))
+	{
+		rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		           "paced re-initialization of context with CID %zu (%zu "
+		           "context(s) left)", c->cid, comp->reinit.pending_nr - 1);
+		c->reinit_pending = false;
+		comp->reinit.pending_nr--;
+		if(!c->profile->reinit_context(c))
 		{
-			rohc_comp_warn(context, "malformed FEEDBACK-2: packet too short for "
-			               "%u-byte option %u, only %zu bytes remaning", opt_len,
-			               opt_type, remain_len);
-			goto error;
+			rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+			             "failed to force re-initialization for CID %zu", c->cid);
 		}
+		is_reinit = true;
+	}
 
-		if(opt_unknown)
+	/* create the ROHC packet: */
+	rohc_packet->len = 0;
+
+	/* use profile to compress packet */
+	rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+	           "compress the packet #%lu",
+	           (unsigned long) (comp->num_packets + 1));
+	rohc_hdr_size =
+		c->profile->encode(c, ip_pkt, rohc_buf_data(*rohc_packet),
+		                   rohc_buf_avail_len(*rohc_packet),
+		                   &packet_type, &payload_offset);
+	if(rohc_hdr_size < 0)
+	{
+		/* error while compressing, use the Uncompressed profile */
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		             "error while compressing with the profile, using "
+		             "uncompressed profile");
+
+		/* free context if it was just created */
+		if(c->num_sent_packets <= 1)
 		{
-			/* unknown options must be ignored (see RFC3095, §5.7.6.10) */
-			rohc_comp_warn(context, "FEEDBACK-2: %s option (%d) is not unknown, "
-			               "ignore it", opt_name, opt_type);
+			c_destroy_context(comp, c);
 		}
-		else if(!opt_supported)
+
+		/* find the best context for the Uncompressed profile, the packet
+		 * might have been compressed with a caller-supplied context without
+		 * being classified */
+		if(!ip_pkt->is_classified)
 		{
-			/* unknown options must be ignored (see RFC3095, §5.7.6.10) */
-			rohc_comp_warn(context, "FEEDBACK-2: %s option (%d) is not supported "
-			               "yet, ignore it", opt_name, opt_type);
+			classified_pkt = *ip_pkt;
+			net_pkt_classify(&classified_pkt, comp->key_seed);
+			ip_pkt = &classified_pkt;
 		}
-		else if(opt_len != opt_exp_len) /* check real length against the expected one */
+		c = rohc_comp_find_ctxt(comp, ip_pkt, ROHC_PROFILE_UNCOMPRESSED,
+		                        uncomp_packet.time);
+		if(c == NULL)
 		{
-			rohc_comp_warn(context, "malformed FEEDBACK-2: malformed %s option "
-			               "(%u) %u bytes advertised while %zu bytes expected",
-			               opt_name, opt_type, opt_len, opt_exp_len);
+			rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+			             "failed to find a matching Uncompressed context or to "
+			             "create a new Uncompressed context");
 			goto error;
 		}
-		else if(opt_type == ROHC_FEEDBACK_OPT_CRC)
+		c_trace_sample(comp, true, c->cid);
+
+		/* use the Uncompressed profile to compress the packet */
+		rohc_hdr_size =
+			c->profile->encode(c, ip_pkt, rohc_buf_data(*rohc_packet),
+			                   rohc_buf_avail_len(*rohc_packet),
+			                   &packet_type, &payload_offset);
+		if(rohc_hdr_size < 0)
 		{
-			if(opts_present[opt_type] == 0)
-			{
-				/* first CRC option */
-				crc_in_packet = remain_data[1];
-			}
-			else if(crc_in_packet != remain_data[1])
-			{
-				/* multiple CRC options are allowed, but they must be identical
-				 * (see RFC4815, §8.6) */
-				rohc_comp_warn(context, "malformed FEEDBACK-2: duplicate CRC option "
-				               "#%zu specifies a CRC value 0x%02x instead of CRC "
-				               "0x%02x specified in the first CRC option",
-				               opts_present[opt_type], remain_data[1], crc_in_packet);
-				goto error;
-			}
-			crc_pos_from_end = remain_len - 1; /* TODO: handle multiple CRC options */
+			rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+			             "error while compressing with uncompressed profile, "
+			             "giving up");
+			goto error_free_new_context;
 		}
-		else if(opt_type == ROHC_FEEDBACK_OPT_SN)
+	}
+	rohc_packet->len += rohc_hdr_size;
+	ticks[1] = rohc_comp_ticks(comp);
+
+	/* the ROHC headers of the re-initialized context are paid for, and the
+	 * ones of a periodic refresh too (estimated with the number of packets
+	 * the refresh lasts) */
+	if(is_reinit)
+	{
+		comp->reinit.credit.bytes -= rohc_hdr_size;
+	}
+	comp->refreshes_credit.bytes -= rohc_hdr_size * comp->refresh_packets_nr;
+
+	/* the payload starts after the header, skip it */
+	rohc_buf_pull(rohc_packet, rohc_hdr_size);
+	payload_size = ip_pkt->len - payload_offset;
+
+	if(payload != NULL)
+	{
+		/* the payload is not copied, reference it in the uncompressed packet */
+		*payload = uncomp_packet;
+		rohc_buf_pull(payload, payload_offset);
+		payload_ref_len = payload->len;
+
+		/* unhide the ROHC header */
+		rohc_buf_push(rohc_packet, rohc_hdr_size);
+		rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		           "ROHC size = %zu bytes (header = %d, payload = %zu "
+		           "referenced)", rohc_packet->len + payload->len,
+		           rohc_hdr_size, payload->len);
+
+		/* report to user that compression was successful */
+		status = ROHC_STATUS_OK;
+	}
+	else if(payload_size > rohc_buf_avail_len(*rohc_packet))
+	{
+		/* packet too large for output buffer */
+		const size_t max_rohc_buf_len =
+			rohc_buf_avail_len(*rohc_packet) + rohc_hdr_size;
+		uint32_t rru_crc;
+
+		/* resulting ROHC packet too large, segmentation may be a solution */
+		rohc_info(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		          "%s ROHC packet is too large for the given output buffer, "
+		          "try to segment it (input size = %zd, maximum output "
+		          "size = %zd, required output size = %d + %zd = %zd, "
+		          "MRRU = %zd)", rohc_get_packet_descr(packet_type),
+		          uncomp_packet.len, max_rohc_buf_len, rohc_hdr_size,
+		          payload_size, rohc_hdr_size + payload_size, comp->mrru);
+
+		/* in order to be segmented, a ROHC packet shall be <= MRRU
+		 * (remember that MRRU includes the CRC length) */
+		if((rohc_hdr_size + payload_size + CRC_FCS32_LEN) > comp->mrru)
 		{
-			if(!rohc_comp_feedback_parse_opt_sn(context, remain_data, remain_len,
-			                                    sn_bits, sn_bits_nr))
-			{
-				rohc_comp_warn(context, "malformed FEEDBACK-2: malformed SN option");
-				goto error;
-			}
+			rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+			             "%s ROHC packet cannot be segmented: too large (%d + "
+			             "%zu + %u = %zu bytes) for MRRU (%zu bytes)",
+			             rohc_get_packet_descr(packet_type), rohc_hdr_size,
+			             payload_size, CRC_FCS32_LEN, rohc_hdr_size +
+			             payload_size + CRC_FCS32_LEN, comp->mrru);
+			goto error_free_new_context;
 		}
+		rohc_info(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		          "%s ROHC packet can be segmented (MRRU = %zd)",
+		          rohc_get_packet_descr(packet_type), comp->mrru);
 
-		/* one more occurrence of the option */
-		opts_present[opt_type]++;
+		/* store the whole ROHC packet in compressor (headers and payload only,
+		 * not feedbacks, feedbacks will be transmitted with the first segment
+		 * when rohc_comp_get_segment2() is called) */
+		if(comp->rru_len != 0)
+		{
+			/* warn users about previous, not yet retrieved RRU */
+			rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+			             "erase the existing %zd-byte RRU that was not "
+			             "retrieved yet (call rohc_comp_get_segment2() to add "
+			             "support for ROHC segments in your application)",
+			             comp->rru_len);
+		}
+		comp->rru_len = 0;
+		comp->rru_off = 0;
+		/* ROHC header */
+		rohc_buf_push(rohc_packet, rohc_hdr_size);
+		memcpy(comp->rru + comp->rru_off, rohc_buf_data(*rohc_packet),
+		       rohc_hdr_size);
+		comp->rru_len += rohc_hdr_size;
+		/* ROHC payload */
+		memcpy(comp->rru + comp->rru_off + comp->rru_len,
+		       rohc_buf_data_at(uncomp_packet, payload_offset), payload_size);
+		comp->rru_len += payload_size;
+		/* compute FCS-32 CRC over header and payload (optional feedbacks and
+		   the CRC field itself are excluded) */
+		rru_crc = crc_calc_fcs32(comp->rru + comp->rru_off, comp->rru_len,
+		                         CRC_INIT_FCS32);
+		memcpy(comp->rru + comp->rru_off + comp->rru_len, &rru_crc,
+		       CRC_FCS32_LEN);
+		comp->rru_len += CRC_FCS32_LEN;
+		rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		           "RRU 32-bit FCS CRC = 0x%08x", rohc_ntoh32(rru_crc));
+		/* computed RRU must be <= MRRU */
+		assert(comp->rru_len <= comp->mrru);
+
+		/* reset the length of the ROHC packet: it shall be 0 for users */
+		rohc_packet->len = 0;
+
+		/* report to users that segmentation is possible */
+		status = ROHC_STATUS_SEGMENT;
+	}
+	else
+	{
+		/* copy full payload after ROHC header */
+		rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		           "copy full %zd-byte payload", payload_size);
+		rohc_buf_append(rohc_packet,
+		                rohc_buf_data_at(uncomp_packet, payload_offset),
+		                payload_size);
+
+		/* unhide the ROHC header */
+		rohc_buf_push(rohc_packet, rohc_hdr_size);
+		rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		           "ROHC size = %zd bytes (header = %d, payload = %zu), output "
+		           "buffer size = %zu", rohc_packet->len, rohc_hdr_size,
+		           payload_size, rohc_buf_avail_len(*rohc_packet));
+
+		/* report to user that compression was successful */
+		status = ROHC_STATUS_OK;
+	}
 
-		/* skip option */
-		remain_data += opt_len;
-		remain_len -= opt_len;
+	ticks[2] = rohc_comp_ticks(comp);
+	if(rohc_comp_timings_enabled(comp))
+	{
+		c_timings_record(comp, c->profile->id, packet_type,
+		                 ticks[1] - ticks[0], ticks[2] - ticks[1]);
 	}
+	ROHC_PROBE5(comp_packet, c->cid, c->profile->id, packet_type,
+	            payload_offset, rohc_hdr_size);
 
-	/* sanity checks:
-	 *  - some profiles do not support all options
-	 *  - some options cannot be specified multiple times
-	 *  - some options cannot be specified without CRC */
-	if(!rohc_comp_feedback_check_opts(context, opts_present))
+	/* save the headers of the last packet for rohc_comp_export_contexts() */
+	if(comp->ctxts_snapshots != NULL)
 	{
-		rohc_comp_warn(context, "malformed FEEDBACK-2: malformed or unexpected options");
-		goto error;
+		c_save_snapshot(comp, c, uncomp_packet, payload_offset);
 	}
 
-	/* check CRC if present in feedback */
-	if(opts_present[ROHC_FEEDBACK_OPT_CRC] > 0)
+	/* record the packet in the log of the last packets */
+	if(rohc_pkt_log_enabled(&comp->pkt_log))
 	{
-		const size_t zeroed_crc_len = 1;
-		const uint8_t zeroed_crc = 0x00;
-		uint8_t crc_computed;
+		c_log_packet(comp, c, packet_type, status);
+	}
 
-		/* compute the CRC of the feedback packet (skip CRC byte) */
-		crc_computed = crc_calculate(ROHC_CRC_TYPE_8, packet,
-		                             packet_len - crc_pos_from_end, CRC_INIT_8,
-		                             context->compressor->crc_table_8);
-		crc_computed = crc_calculate(ROHC_CRC_TYPE_8, &zeroed_crc, zeroed_crc_len,
-		                             crc_computed, context->compressor->crc_table_8);
-		crc_computed = crc_calculate(ROHC_CRC_TYPE_8, packet + packet_len -
-		                             crc_pos_from_end + 1, crc_pos_from_end - 1,
-		                             crc_computed, context->compressor->crc_table_8);
+	/* update some statistics:
+	 *  - compressor statistics
+	 *  - context statistics (global + last packet + last 16 packets) */
+	comp->num_packets++;
+	comp->total_uncompressed_size += uncomp_packet.len;
+	comp->total_compressed_size += rohc_packet->len + payload_ref_len;
+	comp->last_context = c;
 
-		/* ignore feedback in case of bad CRC */
-		if(crc_in_packet != crc_computed)
-		{
-			rohc_comp_warn(context, "CRC check failed: CRC computed on %zu bytes "
-			               "(0x%02x) does not match packet CRC (0x%02x)",
-			               packet_len, crc_computed, crc_in_packet);
-			goto error;
-		}
-	}
+	c->num_sent_packets++;
 
-	return true;
+	/* update the statistics of the context */
+	stats = c_ctxt_stats_at(comp, c->cid);
+	rohc_seqcount_write_begin(&stats->seq);
+	stats->mode = c->mode;
+	stats->state = c->state;
+	stats->packet_type = packet_type;
+	stats->packets_nr++;
+	stats->total_uncompressed_size += uncomp_packet.len;
+	stats->total_compressed_size += rohc_packet->len + payload_ref_len;
+	stats->header_uncompressed_size += payload_offset;
+	stats->header_compressed_size += rohc_hdr_size;
+	stats->total_last_uncompressed_size = uncomp_packet.len;
+	stats->total_last_compressed_size = rohc_packet->len + payload_ref_len;
+	stats->header_last_uncompressed_size = payload_offset;
+	stats->header_last_compressed_size = rohc_hdr_size;
+	rohc_seqcount_write_end(&stats->seq);
+
+	/* compression is successful */
+	return status;
 
+error_free_new_context:
+	if(rohc_pkt_log_enabled(&comp->pkt_log))
+	{
+		c_log_packet(comp, c, packet_type, ROHC_STATUS_ERROR);
+	}
+	/* free context if it was just created */
+	if(c->num_sent_packets <= 1)
+	{
+		c_destroy_context(comp, c);
+	}
 error:
-	return false;
+	return ROHC_STATUS_ERROR;
 }
 
 
 /**
- * @brief Parse the FEEDBACK-2 SN option
+ * @brief Save the headers of the packet compressed by the given context
  *
- * @param context            The ROHC decompression context
- * @param feedback_data      The feedback data without the CID bits
- * @param feedback_data_len  The length of the feedback data without the CID bits
- * @param[out] sn_bits       in: the SN bits collected in base header
- *                           out: the SN bits collected in base header and options
- * @param[out] sn_bits_nr    in: the number of SN bits collected in base header
- *                           out: the number of SN bits collected in base header
- *                                and options
- * @return                   true if feedback options were successfully parsed,
- *                           false if feedback options were malformed or CRC is wrong
+ * @param comp           The ROHC compressor
+ * @param context        The compression context
+ * @param uncomp_packet  The uncompressed packet
+ * @param hdrs_len       The length of the headers compressed by the context
  */
-static bool rohc_comp_feedback_parse_opt_sn(const struct rohc_comp_ctxt *const context,
-                                            const uint8_t *const feedback_data,
-                                            const size_t feedback_data_len,
-                                            uint32_t *const sn_bits,
-                                            size_t *const sn_bits_nr)
+static void c_save_snapshot(struct rohc_comp *const comp,
+                            const struct rohc_comp_ctxt *const context,
+                            const struct rohc_buf uncomp_packet,
+                            const size_t hdrs_len)
 {
-	const uint8_t *remain_data = feedback_data;
-
-	/* min length already checked in caller function */
-	assert(feedback_data_len >= 2);
+	struct rohc_comp_ctxt_snapshot *const saved =
+		&comp->ctxts_snapshots[context->cid];
 
-	if(context->profile->id == ROHC_PROFILE_TCP)
-	{
-		if(((*sn_bits) & 0xffffc000) != 0)
-		{
-			rohc_comp_warn(context, "malformed FEEDBACK-2: more than 16 bits "
-			               "used for SN of the TCP profile");
-#ifndef ROHC_RFC_STRICT_DECOMPRESSOR
-			rohc_comp_warn(context, "malformed FEEDBACK-2: truncate the MSB "
-			               "of the unexpected SN value");
-			(*sn_bits) &= 0x00003fff;
-#else
-			goto error;
-#endif
-		}
-		(*sn_bits) = ((*sn_bits) << 2) + ((remain_data[1] >> 6) & 0x03);
-		(*sn_bits_nr) += 2;
-	}
-	else if(context->profile->id == ROHC_PROFILE_ESP)
-	{
-		if(((*sn_bits) & 0xff000000) != 0)
-		{
-			rohc_comp_warn(context, "malformed FEEDBACK-2: more than 32 bits "
-			               "used for SN of the ESP profile");
-#ifndef ROHC_RFC_STRICT_DECOMPRESSOR
-			rohc_comp_warn(context, "malformed FEEDBACK-2: truncate the MSB "
-			               "of the unexpected SN value");
-			(*sn_bits) &= 0x00ffffff;
-#else
-			goto error;
-#endif
-		}
-		(*sn_bits) = ((*sn_bits) << 8) + (remain_data[1] & 0xff);
-		(*sn_bits_nr) += 8;
-	}
-	else /* non-TCP and non-ESP profiles */
+	/* the Uncompressed profile has nothing to save, and the headers shall
+	 * fit in the snapshot */
+	if(context->profile->id == ROHC_PROFILE_UNCOMPRESSED ||
+	   hdrs_len > ROHC_COMP_SNAPSHOT_HDRS_MAX || uncomp_packet.len > 0xffff)
 	{
-		if(((*sn_bits) & 0xffffff00) != 0)
-		{
-			rohc_comp_warn(context, "malformed FEEDBACK-2: more than 16 bits "
-			               "used for SN of the non-ESP profile");
-#ifndef ROHC_RFC_STRICT_DECOMPRESSOR
-			rohc_comp_warn(context, "malformed FEEDBACK-2: truncate the MSB "
-			               "of the unexpected SN value");
-			(*sn_bits) &= 0x000000ff;
-#else
-			goto error;
-#endif
-		}
-		(*sn_bits) = ((*sn_bits) << 8) + (remain_data[1] & 0xff);
-		(*sn_bits_nr) += 8;
+		saved->hdrs_len = 0;
+		comp->ctxts_dirty[context->cid / 8] |= 1 << (context->cid % 8);
+		return;
 	}
 
-	return true;
-
-#ifdef ROHC_RFC_STRICT_DECOMPRESSOR
-error:
-	return false;
-#endif
+	memcpy(saved->hdrs, rohc_buf_data(uncomp_packet), hdrs_len);
+	saved->hdrs_len = hdrs_len;
+	saved->pkt_len = uncomp_packet.len;
+	comp->ctxts_dirty[context->cid / 8] |= 1 << (context->cid % 8);
 }
 
 
 /**
- * @brief Check FEEDBACK-2 options
+ * @brief Record the packet compressed by the given context in the log of the
+ *        last packets
  *
- * sanity checks:
- *  - some profiles do not support all options
- *  - some options cannot be specified multiple times
- *  - some options cannot be specified without CRC
- *
- * @param context       The ROHC decompression context
- * @param opts_present  Whether options are present or not
- * @return              true if feedback options are valid,
- *                      false if feedback options are not valid
+ * @param comp         The ROHC compressor, with the log of packets enabled
+ * @param context      The compression context
+ * @param packet_type  The type of the ROHC packet
+ * @param status       The status of the compression of the packet
  */
-static bool rohc_comp_feedback_check_opts(const struct rohc_comp_ctxt *const context,
-                                          const size_t opts_present[ROHC_FEEDBACK_OPT_MAX])
+static void c_log_packet(struct rohc_comp *const comp,
+                         const struct rohc_comp_ctxt *const context,
+                         const rohc_packet_t packet_type,
+                         const rohc_status_t status)
 {
-	uint8_t opt_type;
-	assert(context->profile->id < ROHC_PROFILE_MAX);
+	rohc_pkt_log_record_t *const record = rohc_pkt_log_next(&comp->pkt_log);
+
+	record->packet_nr = comp->num_packets + 1;
+	record->sn = (context->profile->get_msn != NULL ?
+	              context->profile->get_msn(context) : 0);
+	record->cid = context->cid;
+	record->profile_id = context->profile->id;
+	record->packet_type = packet_type;
+	record->sn_bits_nr = context->sn_bits_nr;
+	record->status = status;
+	record->reserved = 0;
+}
 
-	for(opt_type = 0; opt_type < ROHC_FEEDBACK_OPT_MAX; opt_type++)
+
+/**
+ * @brief Compress a burst of uncompressed packets
+ *
+ * The ROHC packets are written either in one output buffer per packet, or
+ * back-to-back in one arena with the payloads left in the uncompressed
+ * packets.
+ *
+ * @param comp                The ROHC compressor
+ * @param uncomp_packets      The uncompressed packets to compress
+ * @param pkt_flags           The hints about every uncompressed packet,
+ *                            NULL if there is no hint for any packet
+ * @param packets_nr          The number of packets in the burst
+ * @param[out] rohc_packets   The ROHC packets, one empty buffer for every
+ *                            uncompressed packet; NULL if \e arena is used
+ * @param[in,out] arena       The arena where the ROHC headers are appended,
+ *                            NULL if \e rohc_packets is used
+ * @param[out] descs          The descriptors of the ROHC packets in the
+ *                            arena, NULL if \e rohc_packets is used
+ * @param[out] statuses       The status of the compression of every packet
+ * @return                    The number of packets of the burst that were
+ *                            handled (with success or not)
+ */
+static size_t c_compress_burst(struct rohc_comp *const comp,
+                               const struct rohc_buf *const uncomp_packets,
+                               const int *const pkt_flags,
+                               const size_t packets_nr,
+                               struct rohc_buf *const rohc_packets,
+                               struct rohc_buf *const arena,
+                               rohc_comp_burst_desc_t *const descs,
+                               rohc_status_t *const statuses)
+{
+	struct net_pkt *const ip_pkts = comp->burst_pkts;
+	const struct rohc_comp_profile *profiles[2];
+	rohc_ctxt_key_t flow_hashes[2];
+	bool is_prepared[2];
+	struct rohc_comp_ctxt *c = NULL;
+	struct rohc_buf arena_hdr;
+	size_t i;
+
+	assert(packets_nr > 0);
+	assert((rohc_packets != NULL) != (arena != NULL));
+	assert((arena != NULL) == (descs != NULL));
+
+	/* the ROHC headers are built after the data already in the arena */
+	if(arena != NULL)
 	{
-		if(opts_present[opt_type] > 0 &&
-		   !rohc_feedback_opt_charac[opt_type].unknown &&
-		   rohc_feedback_opt_charac[opt_type].supported)
+		arena_hdr = *arena;
+		rohc_buf_pull(&arena_hdr, arena->len);
+	}
+
+	/* handle the feedback received by other threads meanwhile */
+	c_deliver_queued_feedbacks(comp);
+
+	is_prepared[0] =
+		c_prepare_packet(comp, uncomp_packets[0],
+		                 (pkt_flags != NULL ? pkt_flags[0] : ROHC_COMP_PKT_NONE),
+		                 (arena != NULL ? &arena_hdr : &rohc_packets[0]),
+		                 &ip_pkts[0], &profiles[0], &flow_hashes[0]);
+
+	for(i = 0; i < packets_nr; i++)
+	{
+		const size_t cur = i % 2;
+		const size_t next = (i + 1) % 2;
+
+		/* the ROHC header of the packet shall fit in the arena */
+		if(arena != NULL &&
+		   (rohc_buf_avail_len(arena_hdr) - arena_hdr.len) <
+		   (uncomp_packets[i].len + ROHC_COMP_ARENA_EXTRA_LEN))
 		{
-			const size_t max_occurs =
-				rohc_feedback_opt_charac[opt_type].max_occurs[context->profile->id];
+			rohc_info(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+			          "stop burst before packet #%zu of %zu: arena is full",
+			          i + 1, packets_nr);
+			break;
+		}
 
-			/* is the option supported by the current compression profile? */
-			if(max_occurs == 0)
-			{
-				rohc_comp_warn(context, "malformed FEEDBACK-2: %s option (%u) is "
-				               "not defined for the compression profile '%s' (%d)",
-				               rohc_feedback_opt_charac[opt_type].name, opt_type,
-				               rohc_get_profile_descr(context->profile->id),
-				               context->profile->id);
-#ifdef ROHC_RFC_STRICT_DECOMPRESSOR
-				goto error;
-#endif
-			}
-			/* warn about multiple options */
-			else if(opts_present[opt_type] > max_occurs)
+		/* prepare the next packet, the index of contexts is fetched for it
+		 * while the current packet is compressed */
+		if((i + 1) < packets_nr)
+		{
+			is_prepared[next] =
+				c_prepare_packet(comp, uncomp_packets[i + 1],
+				                 (pkt_flags != NULL ? pkt_flags[i + 1] :
+				                  ROHC_COMP_PKT_NONE),
+				                 (arena != NULL ? &arena_hdr :
+				                  &rohc_packets[i + 1]),
+				                 &ip_pkts[next], &profiles[next],
+				                 &flow_hashes[next]);
+		}
+
+		if(!is_prepared[cur])
+		{
+			statuses[i] = ROHC_STATUS_ERROR;
+			continue;
+		}
+
+		/* the successive packets of one flow shall use the same context */
+		if(c != NULL && c->used && c->profile == profiles[cur] &&
+		   c->flow_hash == flow_hashes[cur] &&
+		   c->key == c_get_ctxt_key(c->profile, &ip_pkts[cur]) &&
+		   c->profile->check_context(c, &ip_pkts[cur]))
+		{
+			rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+			           "using context CID = %zu of previous packet", c->cid);
+			c->latest_used = uncomp_packets[i].time.sec;
+			c_recycle_list_touch(comp, c);
+		}
+		else
+		{
+			c = c_find_ctxt_for_flow(comp, profiles[cur], &ip_pkts[cur],
+			                         flow_hashes[cur], uncomp_packets[i].time);
+			if(c == NULL)
 			{
-				rohc_comp_warn(context, "malformed FEEDBACK-2: %s option (%u) is "
-				               "specified %zu times while compression profile '%s' "
-				               "(%d) allows only %zu times",
-				               rohc_feedback_opt_charac[opt_type].name, opt_type,
-				               opts_present[opt_type],
-				               rohc_get_profile_descr(context->profile->id),
-				               context->profile->id, max_occurs);
-				goto error;
+				rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+				             "failed to find a matching context or to create a "
+				             "new context");
+				statuses[i] = ROHC_STATUS_ERROR;
+				continue;
 			}
+		}
 
-			/* some options cannot be specified without CRC */
-			if(opts_present[ROHC_FEEDBACK_OPT_CRC] == 0)
+		if(arena != NULL)
+		{
+			struct rohc_buf payload;
+
+			/* append the ROHC header to the arena, reference the payload */
+			statuses[i] = c_compress_in_ctxt(comp, c, &ip_pkts[cur],
+			                                 uncomp_packets[i], &arena_hdr,
+			                                 &payload);
+			if(statuses[i] == ROHC_STATUS_OK)
 			{
-				switch(rohc_feedback_opt_charac[opt_type].crc_req)
-				{
-					case ROHC_FEEDBACK_OPT_CRC_REQUIRED:
-						rohc_comp_warn(context, "malformed FEEDBACK-2: %s option (%u) "
-						               "must be specified along with a CRC option",
-						               rohc_feedback_opt_charac[opt_type].name, opt_type);
-						goto error;
-					case ROHC_FEEDBACK_OPT_CRC_SUGGESTED:
-						rohc_comp_warn(context, "malformed FEEDBACK-2: %s option (%u) "
-						               "should be specified along with a CRC option",
-						               rohc_feedback_opt_charac[opt_type].name, opt_type);
-#ifdef ROHC_RFC_STRICT_DECOMPRESSOR
-						goto error;
-#else
-						break;
-#endif
-					case ROHC_FEEDBACK_OPT_CRC_NOT_REQUIRED:
-						break;
-					default:
-						assert(0);
-						goto error;
-				}
+				descs[i].hdr_offset = arena->len;
+				descs[i].hdr_len = arena_hdr.len;
+				descs[i].payload_offset = payload.offset - uncomp_packets[i].offset;
+				descs[i].payload_len = payload.len;
+				arena->len += arena_hdr.len;
 			}
+			arena_hdr = *arena;
+			rohc_buf_pull(&arena_hdr, arena->len);
+		}
+		else
+		{
+			statuses[i] = c_compress_in_ctxt(comp, c, &ip_pkts[cur],
+			                                 uncomp_packets[i], &rohc_packets[i],
+			                                 NULL);
 		}
+		if(statuses[i] == ROHC_STATUS_SEGMENT)
+		{
+			/* the RRU shall be retrieved before compressing another packet */
+			rohc_info(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+			          "stop burst after packet #%zu of %zu for segmentation",
+			          i + 1, packets_nr);
+			i++;
+			break;
+		}
+	}
+
+	return i;
+}
+
+
+
+
+/**
+ * @brief Prepare one packet of a burst for compression
+ *
+ * The packet is checked, parsed and classified, and the home bucket of its
+ * flow in the index of contexts is prefetched.
+ *
+ * @param comp             The ROHC compressor
+ * @param uncomp_packet    The uncompressed packet to prepare
+ * @param pkt_flags        The hints about the packet, see
+ *                         \ref rohc_comp_pkt_flags_t
+ * @param rohc_packet      The buffer for the compressed ROHC packet
+ * @param[out] ip_pkt      The parsed packet
+ * @param[out] profile     The profile to compress the packet with
+ * @param[out] flow_hash   The flow hash of the packet for the profile
+ * @return                 true if the packet may be compressed,
+ *                         false otherwise
+ */
+static bool c_prepare_packet(struct rohc_comp *const comp,
+                             const struct rohc_buf uncomp_packet,
+                             const int pkt_flags,
+                             const struct rohc_buf *const rohc_packet,
+                             struct net_pkt *const ip_pkt,
+                             const struct rohc_comp_profile **const profile,
+                             rohc_ctxt_key_t *const flow_hash)
+{
+	c_trace_sample(comp, false, 0);
+	if(!c_check_bufs(comp, uncomp_packet, rohc_packet))
+	{
+		goto error;
+	}
+	if(!c_parse_packet(comp, uncomp_packet, true, ip_pkt))
+	{
+		goto error;
+	}
+	ip_pkt->ip_csums_verified =
+		((pkt_flags & ROHC_COMP_PKT_IP_CSUM_VERIFIED) != 0);
+
+	*profile = c_get_profile_from_packet(comp, ip_pkt);
+	if((*profile) == NULL)
+	{
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		             "no profile found for packet, giving up");
+		goto error;
 	}
+	*flow_hash = c_get_flow_hash(*profile, ip_pkt);
+	__builtin_prefetch(&comp->ctxts_index[(*flow_hash) & comp->ctxts_index_mask]);
 
 	return true;
 
@@ -64,12 +64,45 @@ extern "C"
 
 struct rohc_comp;
 
+/** The ROHC compressors that share one ROHC channel */
+struct rohc_comp_group;
+
+/** The pipeline of compression stages of one ROHC compressor */
+struct rohc_comp_pipeline;
+
+/** The ROHC decompressor, see rohc_decomp.h */
+struct rohc_decomp;
+
+/** The local ROHC compressor and decompressor of one bidirectional link */
+struct rohc_couple;
+
+/** The manager of many ROHC channels run by a few worker threads */
+struct rohc_channels;
+
+/** The executor that compresses the packets of many channels by bursts */
+struct rohc_channels_exec;
+
 
 /*
  * Public structures and types
  */
 
 
+/**
+ * @brief The room (in bytes) reserved in the arena of
+ *        \ref rohc_compress_burst_arena over the uncompressed length of
+ *        the next packet
+ *
+ * A ROHC header is not expected to be larger than the uncompressed headers
+ * it replaces plus this extra room: the CID, the packet type, the profile,
+ * the CRC and the fields of the IR packets that are not in the uncompressed
+ * headers.
+ *
+ * @ingroup rohc_comp
+ */
+#define ROHC_COMP_ARENA_EXTRA_LEN  128U
+
+
 /**
  * @brief The different ROHC compressor states
  *
@@ -191,6 +224,12 @@ typedef struct
  * Supported versions:
  *  - major 0 and minor = 0 contains: version_major, version_minor,
  *    contexts_nr, packets_nr, uncomp_bytes_nr, and comp_bytes_nr.
+ *  - major 0 and minor = 1 added: packets_nr64, uncomp_bytes_nr64, and
+ *    comp_bytes_nr64.
+ *  - major 0 and minor = 2 added: reinit_pending_nr and reinit_total_nr.
+ *  - major 0 and minor = 3 added: ctxts_hits_nr, ctxts_misses_nr and
+ *    ctxts_recycled_nr.
+ *  - major 0 and minor = 4 added: ctxts_mru_hits_nr.
  *
  * @ingroup rohc_comp
  *
@@ -210,9 +249,108 @@ typedef struct
 	unsigned long uncomp_bytes_nr;
 	/** The number of compressed bytes produced by the compressor */
 	unsigned long comp_bytes_nr;
+
+	/* added in 0.1 */
+	/** The number of packets processed by the compressor (64-bit wide) */
+	uint64_t packets_nr64;
+	/** The number of uncompressed bytes received by the compressor
+	 *  (64-bit wide) */
+	uint64_t uncomp_bytes_nr64;
+	/** The number of compressed bytes produced by the compressor
+	 *  (64-bit wide) */
+	uint64_t comp_bytes_nr64;
+
+	/* added in 0.2 */
+	/** The number of contexts still waiting for their paced
+	 *  re-initialization */
+	size_t reinit_pending_nr;
+	/** The number of contexts to re-initialize when the last paced
+	 *  re-initialization started */
+	size_t reinit_total_nr;
+
+	/* added in 0.3 */
+	/** The number of packets that found their context in use */
+	uint64_t ctxts_hits_nr;
+	/** The number of packets that required a new context */
+	uint64_t ctxts_misses_nr;
+	/** The number of contexts recycled by the recycling policy */
+	uint64_t ctxts_recycled_nr;
+
+	/* added in 0.4 */
+	/** The number of packets that found their context in the cache of the
+	 *  most recently used contexts, among the \e ctxts_hits_nr ones */
+	uint64_t ctxts_mru_hits_nr;
 } __attribute__((packed)) rohc_comp_general_info_t;
 
 
+/**
+ * @brief The statistics of one compression context
+ *
+ * The structure is used by the \ref rohc_comp_get_ctxts_stats function to
+ * export the statistics of all the contexts in use. The counters are 64-bit
+ * wide, so they do not wrap around on long-lived contexts.
+ *
+ * @ingroup rohc_comp
+ *
+ * @see rohc_comp_get_ctxts_stats
+ */
+typedef struct
+{
+	/** The Context ID (CID) of the context */
+	size_t cid;
+	/** The ID of the profile of the context */
+	rohc_profile_t profile_id;
+	/** The operation mode of the context */
+	rohc_mode_t mode;
+	/** The operation state of the context */
+	rohc_comp_state_t state;
+	/** The type of the last ROHC packet created with the context */
+	rohc_packet_t packet_type;
+	/** The number of packets compressed with the context */
+	uint64_t packets_nr;
+	/** The number of uncompressed bytes received by the context */
+	uint64_t uncomp_bytes_nr;
+	/** The number of compressed bytes produced by the context */
+	uint64_t comp_bytes_nr;
+	/** The number of uncompressed header bytes received by the context */
+	uint64_t uncomp_hdr_bytes_nr;
+	/** The number of compressed header bytes produced by the context */
+	uint64_t comp_hdr_bytes_nr;
+} rohc_comp_ctxt_stats_t;
+
+
+/**
+ * @brief The description of one ROHC segment
+ *
+ * The structure is used by the \ref rohc_comp_segment_iov function to
+ * describe one ROHC segment without copying it: the segment is the segment
+ * type byte followed by the given parts of the ROHC header, of the payload
+ * and of the FCS-32 CRC of the Reconstructed Reception Unit (RRU), in that
+ * order. Every part but the segment type byte may be empty.
+ *
+ * @ingroup rohc_comp
+ *
+ * @see rohc_comp_segment_iov
+ */
+typedef struct
+{
+	/** The segment type byte, with the F bit set for the final segment */
+	uint8_t type;
+	/** The part of the ROHC header carried by the segment */
+	const uint8_t *rohc_hdr;
+	/** The length (in bytes) of the part of the ROHC header */
+	size_t rohc_hdr_len;
+	/** The part of the payload carried by the segment */
+	const uint8_t *payload;
+	/** The length (in bytes) of the part of the payload */
+	size_t payload_len;
+	/** The part of the FCS-32 CRC carried by the segment */
+	const uint8_t *crc;
+	/** The length (in bytes) of the part of the FCS-32 CRC */
+	size_t crc_len;
+} rohc_comp_segment_t;
+
+
 /**
  * @brief The different features of the ROHC compressor
  *
@@ -234,10 +372,186 @@ typedef enum
 	ROHC_COMP_FEATURE_NO_IP_CHECKSUMS = (1 << 2),
 	/** Dump content of packets in traces (beware: performance impact) */
 	ROHC_COMP_FEATURE_DUMP_PACKETS    = (1 << 3),
+	/** Measure the durations of the compression phases (the library shall
+	 *  be built with the --enable-rohc-timings configure option) */
+	ROHC_COMP_FEATURE_TIMINGS         = (1 << 4),
+	/** Let the W-LSB windows of the contexts that receive positive ACKs grow
+	 *  over the configured width while ACKs are late, and shrink back to the
+	 *  configured width once ACKs catch up */
+	ROHC_COMP_FEATURE_WLSB_VARIABLE_WIDTH = (1 << 5),
+	/** Save the uncompressed headers of the last packet of every context, so
+	 *  that the contexts may be exported with \ref rohc_comp_export_contexts
+	 *  and \ref rohc_comp_export_changes (beware: memory impact) */
+	ROHC_COMP_FEATURE_SNAPSHOTS       = (1 << 6),
+	/** Bound the work done for every packet: the W-LSB windows never grow
+	 *  over the configured width (not compatible with
+	 *  \ref ROHC_COMP_FEATURE_WLSB_VARIABLE_WIDTH), and the timers of the
+	 *  time-based periodic refreshes are moved forward by
+	 *  \ref rohc_comp_maintenance only */
+	ROHC_COMP_FEATURE_REALTIME        = (1 << 7),
 
 } rohc_comp_features_t;
 
 
+/**
+ * @brief The hints about one uncompressed packet given to the compressor
+ *
+ * The hints are given per packet with \ref rohc_compress_burst2, usually from
+ * the metadata that the network interface attached to the packet on
+ * reception. They let the compressor skip the verifications already done by
+ * the hardware for that packet only, the other packets are fully verified.
+ *
+ * @ingroup rohc_comp
+ *
+ * @see rohc_compress_burst2
+ */
+typedef enum
+{
+	/** No hint about the packet */
+	ROHC_COMP_PKT_NONE             = 0,
+	/** The checksums of all the IPv4 headers of the packet were verified,
+	 *  eg. by the network interface: the compressor does not verify them
+	 *  again, as with \ref ROHC_COMP_FEATURE_NO_IP_CHECKSUMS */
+	ROHC_COMP_PKT_IP_CSUM_VERIFIED = (1 << 0),
+
+} rohc_comp_pkt_flags_t;
+
+
+/**
+ * @brief The descriptor of one ROHC packet compressed in an arena
+ *
+ * The ROHC packet is the ROHC header stored in the arena given to
+ * \ref rohc_compress_burst_arena, followed by the payload that remains in
+ * the uncompressed packet. The descriptors are small so that the ones of a
+ * whole burst remain in a few cache lines while the transmit descriptors
+ * are gathered.
+ *
+ * @ingroup rohc_comp
+ *
+ * @see rohc_compress_burst_arena
+ */
+typedef struct
+{
+	/** The offset (in bytes) of the ROHC header in the arena */
+	uint32_t hdr_offset;
+	/** The length (in bytes) of the ROHC header */
+	uint32_t hdr_len;
+	/** The offset (in bytes) of the payload in the uncompressed packet */
+	uint32_t payload_offset;
+	/** The length (in bytes) of the payload */
+	uint32_t payload_len;
+
+} rohc_comp_burst_desc_t;
+
+
+/**
+ * @brief The handle of one compression context
+ *
+ * The handle is opaque: it is retrieved with \ref rohc_comp_get_last_ctxt_handle
+ * once the first packet of a flow was compressed, then given back to
+ * \ref rohc_compress_with_ctxt for the next packets of the same flow. The
+ * handle gets stale when the context is destroyed or given to another flow.
+ *
+ * @ingroup rohc_comp
+ *
+ * @see rohc_comp_get_last_ctxt_handle
+ * @see rohc_compress_with_ctxt
+ */
+typedef uint64_t rohc_comp_ctxt_handle_t;
+
+/** The handle that matches no compression context */
+#define ROHC_COMP_CTXT_HANDLE_NONE  ((rohc_comp_ctxt_handle_t) 0)
+
+
+/**
+ * @brief The phases of the compression of one packet
+ *
+ * The durations of the phases are measured if the feature
+ * \ref ROHC_COMP_FEATURE_TIMINGS is enabled. The parsing and context lookup
+ * phases are measured by \ref rohc_compress4 only.
+ *
+ * @ingroup rohc_comp
+ *
+ * @see rohc_comp_get_timings
+ * @see rohc_comp_get_profile_timings
+ */
+typedef enum
+{
+	/** Parse the uncompressed packet */
+	ROHC_COMP_PHASE_PARSE   = 0,
+	/** Find or create the compression context */
+	ROHC_COMP_PHASE_LOOKUP  = 1,
+	/** Encode the ROHC header, CRC excepted */
+	ROHC_COMP_PHASE_ENCODE   = 2,
+	/** Copy the payload, or build the RRU with its FCS-32 CRC */
+	ROHC_COMP_PHASE_PAYLOAD  = 3,
+	/** Compute the CRC of the ROHC header */
+	ROHC_COMP_PHASE_CRC      = 4,
+	/** Handle one feedback item received for a context, recorded per
+	 *  profile only */
+	ROHC_COMP_PHASE_FEEDBACK = 5,
+
+	ROHC_COMP_PHASE_MAX      = 6,
+
+} rohc_comp_phase_t;
+
+
+/**
+ * @brief The policies for recycling compression contexts
+ *
+ * When a packet of a new flow is compressed while all the CIDs are in use,
+ * the ROHC compressor recycles one of its contexts. The policy defines which
+ * context is recycled. It can be set with the function
+ * \ref rohc_comp_set_ctxts_recycling.
+ *
+ * @ingroup rohc_comp
+ *
+ * @see rohc_comp_set_ctxts_recycling
+ */
+typedef enum
+{
+	/** Recycle the Least Recently Used context (default) */
+	ROHC_COMP_RECYCLE_LRU    = 0,
+	/** Recycle the Least Frequently Used context, the least recently used
+	 *  one if several contexts were used equally */
+	ROHC_COMP_RECYCLE_LFU    = 1,
+	/** Recycle the context that was created first */
+	ROHC_COMP_RECYCLE_OLDEST = 2,
+	/** Segmented LRU: recycle the least recently used context among the
+	 *  contexts used once, the contexts used again are protected until they
+	 *  are the least recently used ones of a full protected segment */
+	ROHC_COMP_RECYCLE_SLRU   = 3,
+
+} rohc_comp_recycle_t;
+
+
+/**
+ * @brief The reordering that the ROHCv2 profiles shall tolerate
+ *
+ * The ROHCv2 profiles (RFC 5225) make the interpretation interval of the
+ * Master Sequence Number (MSN) cover values before the reference value, so
+ * that packets reordered on the channel are still decompressed correctly.
+ * The more reordering is tolerated, the more bits of MSN are transmitted.
+ * It can be set with the function \ref rohc_comp_set_reorder_ratio.
+ *
+ * @ingroup rohc_comp
+ *
+ * @see rohc_comp_set_reorder_ratio
+ */
+typedef enum
+{
+	/** No reordering is tolerated */
+	ROHC_REORDERING_NONE          = 0,
+	/** Reordering on 1/4 of the interpretation interval (default) */
+	ROHC_REORDERING_QUARTER       = 1,
+	/** Reordering on 1/2 of the interpretation interval */
+	ROHC_REORDERING_HALF          = 2,
+	/** Reordering on 3/4 of the interpretation interval */
+	ROHC_REORDERING_THREEQUARTERS = 3,
+
+} rohc_reordering_offset_t;
+
+
 /**
  * @brief The prototype of the RTP detection callback
  *
@@ -290,6 +604,87 @@ typedef int (*rohc_comp_random_cb_t) (const struct rohc_comp *const comp,
 	__attribute__((warn_unused_result));
 
 
+/** The events of the lifecycle of the compression contexts */
+typedef enum
+{
+	/** A new context was created for a new flow */
+	ROHC_COMP_EVENT_CTXT_CREATE   = 0,
+	/** A context was recycled to make room for a new flow, it is destroyed
+	 *  right after the event */
+	ROHC_COMP_EVENT_CTXT_RECYCLE  = 1,
+	/** The compression state of a context changed */
+	ROHC_COMP_EVENT_STATE_CHANGE  = 2,
+	/** The operation mode of a context changed */
+	ROHC_COMP_EVENT_MODE_CHANGE   = 3,
+} rohc_comp_event_t;
+
+
+/** The description of one event of the lifecycle of one compression context */
+typedef struct
+{
+	/** The event */
+	rohc_comp_event_t event;
+	/** The CID of the context */
+	rohc_cid_t cid;
+	/** The profile of the context */
+	rohc_profile_t profile_id;
+	/** The compression state of the context before the event */
+	rohc_comp_state_t old_state;
+	/** The compression state of the context after the event */
+	rohc_comp_state_t new_state;
+	/** The operation mode of the context before the event */
+	rohc_mode_t old_mode;
+	/** The operation mode of the context after the event */
+	rohc_mode_t new_mode;
+} rohc_comp_event_info_t;
+
+
+/**
+ * @brief The prototype of the callback for the events of the contexts
+ *
+ * User-defined function that is called by the ROHC library when one
+ * compression context is created, recycled, or changes of state or mode.
+ * The function is not called for the packets that change nothing, so that
+ * monitoring the contexts costs nothing on steady flows.
+ *
+ * The callback is called from within the compression of one packet: it
+ * shall not use the compressor.
+ *
+ * The user-defined function is set by calling the function
+ * \ref rohc_comp_set_event_cb
+ *
+ * @param priv_ctxt  An optional private context, may be NULL
+ * @param info       The description of the event
+ *
+ * @see rohc_comp_set_event_cb
+ * @ingroup rohc_comp
+ */
+typedef void (*rohc_comp_event_callback_t) (void *const priv_ctxt,
+                                            const rohc_comp_event_info_t *const info);
+
+
+/**
+ * @brief The attributes of a new ROHC compressor
+ *
+ * @see rohc_comp_new3
+ * @ingroup rohc_comp
+ */
+struct rohc_comp_attr
+{
+	/** The type of Context IDs (CID) the compressor uses */
+	rohc_cid_type_t cid_type;
+	/** The MAX_CID parameter of the compressor */
+	rohc_cid_t max_cid;
+	/** The callback for random numbers, shall not be NULL */
+	rohc_comp_random_cb_t rand_cb;
+	/** The private context given to the callback for random numbers */
+	void *rand_priv;
+	/** The NUMA node to allocate the memory of the compressor on,
+	 *  \ref ROHC_NUMA_NODE_ANY to let the system place it */
+	int numa_node;
+};
+
+
 /*
  * Prototypes of main public functions related to ROHC compression
  */
@@ -300,6 +695,9 @@ struct rohc_comp * ROHC_EXPORT rohc_comp_new2(const rohc_cid_type_t cid_type,
                                               void *const rand_priv)
 	__attribute__((warn_unused_result));
 
+struct rohc_comp * ROHC_EXPORT rohc_comp_new3(const struct rohc_comp_attr *const attr)
+	__attribute__((warn_unused_result));
+
 void ROHC_EXPORT rohc_comp_free(struct rohc_comp *const comp);
 
 bool ROHC_EXPORT rohc_comp_set_traces_cb2(struct rohc_comp *const comp,
@@ -307,18 +705,101 @@ bool ROHC_EXPORT rohc_comp_set_traces_cb2(struct rohc_comp *const comp,
                                           void *const priv_ctxt)
 	__attribute__((warn_unused_result));
 
+bool ROHC_EXPORT rohc_comp_set_trace_level(struct rohc_comp *const comp,
+                                           const rohc_trace_level_t level)
+	__attribute__((warn_unused_result));
+
+bool ROHC_EXPORT rohc_comp_set_trace_sampling(struct rohc_comp *const comp,
+                                              const size_t one_in_n,
+                                              const bool errors_only)
+	__attribute__((warn_unused_result));
+
+bool ROHC_EXPORT rohc_comp_set_trace_cids(struct rohc_comp *const comp,
+                                          const rohc_cid_t *const cids,
+                                          const size_t cids_nr)
+	__attribute__((warn_unused_result));
+
 rohc_status_t ROHC_EXPORT rohc_compress4(struct rohc_comp *const comp,
                                          const struct rohc_buf uncomp_packet,
                                          struct rohc_buf *const rohc_packet)
 	__attribute__((warn_unused_result));
 
+rohc_status_t ROHC_EXPORT rohc_compress_iov(struct rohc_comp *const comp,
+                                           const struct rohc_buf uncomp_packet,
+                                           struct rohc_buf *const rohc_hdr,
+                                           struct rohc_buf *const payload)
+	__attribute__((warn_unused_result));
+
+rohc_status_t ROHC_EXPORT rohc_compress_inplace(struct rohc_comp *const comp,
+                                               struct rohc_buf *const packet)
+	__attribute__((warn_unused_result));
+
+rohc_status_t ROHC_EXPORT rohc_compress_with_ctxt(struct rohc_comp *const comp,
+                                                 const rohc_comp_ctxt_handle_t handle,
+                                                 const struct rohc_buf uncomp_packet,
+                                                 struct rohc_buf *const rohc_packet)
+	__attribute__((warn_unused_result));
+
+bool ROHC_EXPORT rohc_compress_gso(struct rohc_comp *const comp,
+                                   const struct rohc_buf gso_packet,
+                                   const size_t mss,
+                                   struct rohc_buf *const rohc_hdrs,
+                                   struct rohc_buf *const payloads,
+                                   const size_t segs_max,
+                                   size_t *const segs_nr)
+	__attribute__((warn_unused_result));
+
+size_t ROHC_EXPORT rohc_compress_burst(struct rohc_comp *const comp,
+                                       const struct rohc_buf *const uncomp_packets,
+                                       struct rohc_buf *const rohc_packets,
+                                       const size_t packets_nr,
+                                       rohc_status_t *const statuses)
+	__attribute__((warn_unused_result));
+
+size_t ROHC_EXPORT rohc_compress_burst2(struct rohc_comp *const comp,
+                                        const struct rohc_buf *const uncomp_packets,
+                                        const int *const pkt_flags,
+                                        struct rohc_buf *const rohc_packets,
+                                        const size_t packets_nr,
+                                        rohc_status_t *const statuses)
+	__attribute__((warn_unused_result));
+
+size_t ROHC_EXPORT rohc_compress_burst_arena(struct rohc_comp *const comp,
+                                             const struct rohc_buf *const uncomp_packets,
+                                             const int *const pkt_flags,
+                                             const size_t packets_nr,
+                                             struct rohc_buf *const arena,
+                                             rohc_comp_burst_desc_t *const descs,
+                                             rohc_status_t *const statuses)
+	__attribute__((warn_unused_result));
+
 rohc_status_t ROHC_EXPORT rohc_comp_get_segment2(struct rohc_comp *const comp,
                                                  struct rohc_buf *const segment)
 	__attribute__((warn_unused_result));
 
+bool ROHC_EXPORT rohc_comp_get_segments(struct rohc_comp *const comp,
+                                        struct rohc_buf *const segments,
+                                        const size_t segments_max,
+                                        size_t *const segments_nr)
+	__attribute__((warn_unused_result));
+
+bool ROHC_EXPORT rohc_comp_segment_iov(struct rohc_comp *const comp,
+                                       const struct rohc_buf rohc_hdr,
+                                       const struct rohc_buf payload,
+                                       const size_t segment_max_len,
+                                       rohc_comp_segment_t *const segments,
+                                       const size_t segments_max,
+                                       size_t *const segments_nr)
+	__attribute__((warn_unused_result));
+
 bool ROHC_EXPORT rohc_comp_force_contexts_reinit(struct rohc_comp *const comp)
 	__attribute__((warn_unused_result));
 
+bool ROHC_EXPORT rohc_comp_force_contexts_reinit_paced(struct rohc_comp *const comp,
+                                                      const uint64_t duration,
+                                                      const size_t bytes_rate)
+	__attribute__((warn_unused_result));
+
 
 /*
  * Prototypes of public functions related to user interaction
@@ -349,10 +830,27 @@ bool ROHC_EXPORT rohc_comp_get_mrru(const struct rohc_comp *const comp,
                                     size_t *const mrru)
 	__attribute__((warn_unused_result));
 
+bool ROHC_EXPORT rohc_comp_set_memory_budget(struct rohc_comp *const comp,
+                                             const size_t budget)
+	__attribute__((warn_unused_result));
+
+bool ROHC_EXPORT rohc_comp_set_huge_pages(struct rohc_comp *const comp,
+                                          const bool enabled)
+	__attribute__((warn_unused_result));
+
+bool ROHC_EXPORT rohc_comp_reserve_contexts(struct rohc_comp *const comp,
+                                            const size_t contexts_nr)
+	__attribute__((warn_unused_result));
+
 bool ROHC_EXPORT rohc_comp_get_max_cid(const struct rohc_comp *const comp,
                                        size_t *const max_cid)
 	__attribute__((warn_unused_result));
 
+bool ROHC_EXPORT rohc_comp_set_cid_range(struct rohc_comp *const comp,
+                                         const size_t first_cid,
+                                         const size_t last_cid)
+	__attribute__((warn_unused_result));
+
 bool ROHC_EXPORT rohc_comp_get_cid_type(const struct rohc_comp *const comp,
                                         rohc_cid_type_t *const cid_type)
 	__attribute__((warn_unused_result));
@@ -362,14 +860,76 @@ bool ROHC_EXPORT rohc_comp_set_rtp_detection_cb(struct rohc_comp *const comp,
                                                 void *const rtp_private)
 	__attribute__((warn_unused_result));
 
+bool ROHC_EXPORT rohc_comp_add_rtp_port(struct rohc_comp *const comp,
+                                        const uint16_t port)
+	__attribute__((warn_unused_result));
+
+bool ROHC_EXPORT rohc_comp_remove_rtp_port(struct rohc_comp *const comp,
+                                           const uint16_t port)
+	__attribute__((warn_unused_result));
+
+bool ROHC_EXPORT rohc_comp_reset_rtp_ports(struct rohc_comp *const comp)
+	__attribute__((warn_unused_result));
+
+bool ROHC_EXPORT rohc_comp_set_rtp_payload_type(struct rohc_comp *const comp,
+                                                const uint8_t pt,
+                                                const bool accepted)
+	__attribute__((warn_unused_result));
+
+bool ROHC_EXPORT rohc_comp_set_event_cb(struct rohc_comp *const comp,
+                                        rohc_comp_event_callback_t callback,
+                                        void *const priv_ctxt)
+	__attribute__((warn_unused_result));
+
 bool ROHC_EXPORT rohc_comp_set_features(struct rohc_comp *const comp,
                                         const rohc_comp_features_t features)
 	__attribute__((warn_unused_result));
 
+bool ROHC_EXPORT rohc_comp_maintenance(struct rohc_comp *const comp,
+                                       const struct rohc_ts now)
+	__attribute__((warn_unused_result));
+
 bool ROHC_EXPORT rohc_comp_deliver_feedback2(struct rohc_comp *const comp,
                                              const struct rohc_buf feedback)
 	__attribute__((warn_unused_result));
 
+bool ROHC_EXPORT rohc_comp_deliver_feedback_burst(struct rohc_comp *const comp,
+                                                  const struct rohc_buf feedback)
+	__attribute__((warn_unused_result));
+
+bool ROHC_EXPORT rohc_comp_enqueue_feedback(struct rohc_comp *const comp,
+                                            const struct rohc_buf feedback)
+	__attribute__((warn_unused_result));
+
+bool ROHC_EXPORT rohc_comp_export_contexts(struct rohc_comp *const comp,
+                                          struct rohc_buf *const snapshot)
+	__attribute__((warn_unused_result));
+
+bool ROHC_EXPORT rohc_comp_import_contexts(struct rohc_comp *const comp,
+                                          const struct rohc_buf snapshot)
+	__attribute__((warn_unused_result));
+
+bool ROHC_EXPORT rohc_comp_export_changes(struct rohc_comp *const comp,
+                                         struct rohc_buf *const changes)
+	__attribute__((warn_unused_result));
+
+bool ROHC_EXPORT rohc_comp_import_changes(struct rohc_comp *const comp,
+                                         const struct rohc_buf changes)
+	__attribute__((warn_unused_result));
+
+bool ROHC_EXPORT rohc_comp_migrate_context(struct rohc_comp *const comp,
+                                          const rohc_cid_t cid,
+                                          struct rohc_comp *const new_comp,
+                                          rohc_cid_t *const new_cid)
+	__attribute__((warn_unused_result));
+
+bool ROHC_EXPORT rohc_comp_prewarm_context(struct rohc_comp *const comp,
+                                          const rohc_cid_t cid,
+                                          const rohc_profile_t profile_id,
+                                          const struct rohc_buf template_pkt,
+                                          struct rohc_buf *const rohc_ir)
+	__attribute__((warn_unused_result));
+
 
 /*
  * Prototypes of public functions that configure robustness to packet
@@ -380,15 +940,41 @@ bool ROHC_EXPORT rohc_comp_set_wlsb_window_width(struct rohc_comp *const comp,
                                                  const size_t width)
 	__attribute__((warn_unused_result));
 
+bool ROHC_EXPORT rohc_comp_set_reorder_ratio(struct rohc_comp *const comp,
+                                             const rohc_reordering_offset_t reorder_ratio)
+	__attribute__((warn_unused_result));
+
 bool ROHC_EXPORT rohc_comp_set_periodic_refreshes(struct rohc_comp *const comp,
                                                   const size_t ir_timeout,
                                                   const size_t fo_timeout)
 	__attribute__((warn_unused_result));
 
+bool ROHC_EXPORT rohc_comp_set_periodic_refreshes_time(struct rohc_comp *const comp,
+                                                       const uint64_t ir_timeout,
+                                                       const uint64_t fo_timeout)
+	__attribute__((warn_unused_result));
+
+bool ROHC_EXPORT rohc_comp_set_periodic_refreshes_rate(struct rohc_comp *const comp,
+                                                       const size_t bytes_rate)
+	__attribute__((warn_unused_result));
+
 bool ROHC_EXPORT rohc_comp_set_list_trans_nr(struct rohc_comp *const comp,
                                              const size_t list_trans_nr)
 	__attribute__((warn_unused_result));
 
+bool ROHC_EXPORT rohc_comp_set_ctxts_recycling(struct rohc_comp *const comp,
+                                               const rohc_comp_recycle_t policy)
+	__attribute__((warn_unused_result));
+
+bool ROHC_EXPORT rohc_comp_set_admission(struct rohc_comp *const comp,
+                                         const size_t packets_nr,
+                                         const size_t probation_max)
+	__attribute__((warn_unused_result));
+
+bool ROHC_EXPORT rohc_comp_set_pkt_log(struct rohc_comp *const comp,
+                                       const size_t records_nr)
+	__attribute__((warn_unused_result));
+
 
 /*
  * Prototypes of public functions related to ROHC compression statistics
@@ -398,14 +984,186 @@ bool ROHC_EXPORT rohc_comp_get_general_info(const struct rohc_comp *const comp,
                                             rohc_comp_general_info_t *const info)
 	__attribute__((warn_unused_result));
 
+bool ROHC_EXPORT rohc_comp_get_last_ctxt_handle(const struct rohc_comp *const comp,
+                                                rohc_comp_ctxt_handle_t *const handle)
+	__attribute__((warn_unused_result));
+
 bool ROHC_EXPORT rohc_comp_get_last_packet_info2(const struct rohc_comp *const comp,
                                                  rohc_comp_last_packet_info2_t *const info)
 	__attribute__((warn_unused_result));
 
+bool ROHC_EXPORT rohc_comp_get_ctxts_stats(const struct rohc_comp *const comp,
+                                           rohc_comp_ctxt_stats_t *const stats,
+                                           const size_t stats_max,
+                                           size_t *const stats_nr)
+	__attribute__((warn_unused_result));
+
+bool ROHC_EXPORT rohc_comp_get_timings(const struct rohc_comp *const comp,
+                                       const rohc_packet_t packet_type,
+                                       const rohc_comp_phase_t phase,
+                                       rohc_timings_histo_t *const histo)
+	__attribute__((warn_unused_result));
+
+bool ROHC_EXPORT rohc_comp_get_profile_timings(const struct rohc_comp *const comp,
+                                               const rohc_profile_t profile,
+                                               const rohc_comp_phase_t phase,
+                                               rohc_timings_histo_t *const histo)
+	__attribute__((warn_unused_result));
+
+bool ROHC_EXPORT rohc_comp_get_pkt_log(const struct rohc_comp *const comp,
+                                       rohc_pkt_log_record_t *const records,
+                                       const size_t records_max,
+                                       size_t *const records_nr)
+	__attribute__((warn_unused_result));
+
 const char * ROHC_EXPORT rohc_comp_get_state_descr(const rohc_comp_state_t state)
 	__attribute__((warn_unused_result, const));
 
 
+/*
+ * Prototypes of public functions related to groups of compressors that
+ * share one ROHC channel
+ */
+
+struct rohc_comp_group * ROHC_EXPORT rohc_comp_group_new(const rohc_cid_type_t cid_type,
+                                                         const rohc_cid_t max_cid,
+                                                         const size_t shards_nr,
+                                                         const size_t queue_len,
+                                                         const rohc_comp_random_cb_t rand_cb,
+                                                         void *const rand_priv)
+	__attribute__((warn_unused_result));
+
+void ROHC_EXPORT rohc_comp_group_free(struct rohc_comp_group *const group);
+
+struct rohc_comp * ROHC_EXPORT rohc_comp_group_get_shard(const struct rohc_comp_group *const group,
+                                                         const size_t shard)
+	__attribute__((warn_unused_result));
+
+bool ROHC_EXPORT rohc_comp_group_enqueue(struct rohc_comp_group *const group,
+                                         const struct rohc_buf packet,
+                                         size_t *const shard)
+	__attribute__((warn_unused_result));
+
+bool ROHC_EXPORT rohc_comp_group_dequeue(struct rohc_comp_group *const group,
+                                         const size_t shard,
+                                         struct rohc_buf *const packet)
+	__attribute__((warn_unused_result));
+
+bool ROHC_EXPORT rohc_comp_group_deliver_feedback(struct rohc_comp_group *const group,
+                                                  const struct rohc_buf feedback)
+	__attribute__((warn_unused_result));
+
+
+/*
+ * Prototypes of public functions related to pipelines of compression stages
+ */
+
+struct rohc_comp_pipeline * ROHC_EXPORT rohc_comp_pipeline_new(struct rohc_comp *const comp,
+                                                               const size_t queue_len)
+	__attribute__((warn_unused_result));
+
+void ROHC_EXPORT rohc_comp_pipeline_free(struct rohc_comp_pipeline *const pipeline);
+
+bool ROHC_EXPORT rohc_comp_pipeline_parse(struct rohc_comp_pipeline *const pipeline,
+                                          const struct rohc_buf uncomp_packet,
+                                          struct rohc_buf *const rohc_packet)
+	__attribute__((warn_unused_result));
+
+bool ROHC_EXPORT rohc_comp_pipeline_encode(struct rohc_comp_pipeline *const pipeline)
+	__attribute__((warn_unused_result));
+
+bool ROHC_EXPORT rohc_comp_pipeline_output(struct rohc_comp_pipeline *const pipeline,
+                                           struct rohc_buf **const rohc_packet,
+                                           rohc_status_t *const status)
+	__attribute__((warn_unused_result));
+
+
+/*
+ * Prototypes of public functions related to couples of compressor and
+ * decompressor of one bidirectional link
+ */
+
+struct rohc_couple * ROHC_EXPORT rohc_couple_new(struct rohc_comp *const comp,
+                                                 struct rohc_decomp *const decomp,
+                                                 const size_t feedback_budget)
+	__attribute__((warn_unused_result));
+
+void ROHC_EXPORT rohc_couple_free(struct rohc_couple *const couple);
+
+rohc_status_t ROHC_EXPORT rohc_couple_compress(struct rohc_couple *const couple,
+                                               const struct rohc_buf uncomp_packet,
+                                               struct rohc_buf *const rohc_packet)
+	__attribute__((warn_unused_result));
+
+rohc_status_t ROHC_EXPORT rohc_couple_decompress(struct rohc_couple *const couple,
+                                                 const struct rohc_buf rohc_packet,
+                                                 struct rohc_buf *const uncomp_packet)
+	__attribute__((warn_unused_result));
+
+bool ROHC_EXPORT rohc_couple_flush_feedback(struct rohc_couple *const couple,
+                                            struct rohc_buf *const feedback)
+	__attribute__((warn_unused_result));
+
+
+/*
+ * Prototypes of public functions related to managers of many ROHC channels
+ */
+
+struct rohc_channels * ROHC_EXPORT rohc_channels_new(const size_t channels_nr,
+                                                     const size_t workers_nr)
+	__attribute__((warn_unused_result));
+
+void ROHC_EXPORT rohc_channels_free(struct rohc_channels *const channels);
+
+bool ROHC_EXPORT rohc_channels_add(struct rohc_channels *const channels,
+                                   struct rohc_comp *const comp,
+                                   struct rohc_decomp *const decomp,
+                                   size_t *const channel)
+	__attribute__((warn_unused_result));
+
+bool ROHC_EXPORT rohc_channels_remove(struct rohc_channels *const channels,
+                                      const size_t channel)
+	__attribute__((warn_unused_result));
+
+bool ROHC_EXPORT rohc_channels_notify(struct rohc_channels *const channels,
+                                      const size_t channel)
+	__attribute__((warn_unused_result));
+
+bool ROHC_EXPORT rohc_channels_next(struct rohc_channels *const channels,
+                                    const size_t worker,
+                                    size_t *const channel,
+                                    struct rohc_comp **const comp,
+                                    struct rohc_decomp **const decomp)
+	__attribute__((warn_unused_result));
+
+bool ROHC_EXPORT rohc_channels_done(struct rohc_channels *const channels,
+                                    const size_t worker,
+                                    const size_t channel)
+	__attribute__((warn_unused_result));
+
+struct rohc_channels_exec * ROHC_EXPORT rohc_channels_exec_new(struct rohc_channels *const channels,
+                                                               const size_t queue_len,
+                                                               const size_t burst_max)
+	__attribute__((warn_unused_result));
+
+void ROHC_EXPORT rohc_channels_exec_free(struct rohc_channels_exec *const exec);
+
+bool ROHC_EXPORT rohc_channels_exec_submit(struct rohc_channels_exec *const exec,
+                                           const size_t channel,
+                                           const struct rohc_buf uncomp_packet,
+                                           struct rohc_buf *const rohc_packet)
+	__attribute__((warn_unused_result));
+
+size_t ROHC_EXPORT rohc_channels_exec_run(struct rohc_channels_exec *const exec,
+                                          const size_t worker);
+
+bool ROHC_EXPORT rohc_channels_exec_collect(struct rohc_channels_exec *const exec,
+                                            const size_t channel,
+                                            struct rohc_buf **const rohc_packet,
+                                            rohc_status_t *const status)
+	__attribute__((warn_unused_result));
+
+
 #undef ROHC_EXPORT /* do not pollute outside this header */
 
 #ifdef __cplusplus
@@ -0,0 +1,1097 @@
+/*
+ * Copyright 2016 Didier Barvaux
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/**
+ * @file   rohc_comp_channels.c
+ * @brief  Manager of many ROHC channels run by a few worker threads
+ * @author Didier Barvaux <didier@barvaux.org>
+ *
+ * Every ROHC channel (one radio bearer for example) is made of one compressor
+ * and/or one decompressor. The manager schedules the channels that have work
+ * to do on a fixed set of worker threads:
+ *  - a channel is notified when it has work to do, it is then queued in the
+ *    run queue of the worker that ran it last,
+ *  - a worker runs the channels of its own run queue first, and steals the
+ *    channels queued for the other workers when its run queue is empty, so
+ *    that the busy channels spread over the idle workers,
+ *  - a channel is run by one single worker at a time, a channel notified
+ *    while it runs is queued again once the worker is done with it.
+ *
+ * The run queues are bounded multi-producer/multi-consumer queues: every
+ * cell holds a sequence number that tells whether it is ready to be written
+ * or read, so that no lock is taken. One channel is queued at most once at
+ * any time, so the run queues are never full.
+ *
+ * The worker threads own the pools of memory blocks for the contexts of the
+ * channels they run: the freed blocks are kept once per worker, not once per
+ * compressor and decompressor.
+ *
+ * The optional executor runs the compression of the channels on top of the
+ * manager: the packets submitted for one channel are queued for it, and the
+ * worker that runs the channel compresses them by bursts.
+ */
+
+#include "rohc_comp_internals.h"
+#include "rohc_decomp_internals.h"
+#include "rohc_ctxt_pool.h"
+#include "rohc_debug.h"
+#include "rohc_alloc.h"
+
+#ifndef __KERNEL__
+#  include <string.h>
+#endif
+#include <assert.h>
+
+
+/** The channel is free for a new compressor/decompressor */
+#define ROHC_CHANNEL_FREE      0x01U
+/** The channel is being added or removed */
+#define ROHC_CHANNEL_CHANGING  0x02U
+/** The channel has work to do, it is queued or it will be queued again */
+#define ROHC_CHANNEL_NOTIFIED  0x04U
+/** The channel is run by one worker */
+#define ROHC_CHANNEL_RUNNING   0x08U
+/** The channel is idle: neither queued, nor run */
+#define ROHC_CHANNEL_IDLE      0x00U
+
+
+/** One ROHC channel */
+struct rohc_channel
+{
+	/** The state of the channel, a combination of the ROHC_CHANNEL_* flags */
+	unsigned int state;
+	/** The worker that ran the channel last, the channel is queued for it */
+	size_t worker;
+	/** The compressor of the channel, may be NULL */
+	struct rohc_comp *comp;
+	/** The decompressor of the channel, may be NULL */
+	struct rohc_decomp *decomp;
+};
+
+
+/** One cell of one run queue */
+struct rohc_channels_cell
+{
+	/** The sequence number of the cell: the cell may be written when it
+	 *  equals the position of the writer, read when it equals the position
+	 *  of the reader plus one */
+	size_t seq;
+	/** The queued channel */
+	size_t channel;
+};
+
+
+/** One worker thread with its run queue */
+struct rohc_channels_worker
+{
+	/** The position of the next channel to queue */
+	size_t enqueue_pos __attribute__((aligned(ROHC_CACHE_LINE_LEN)));
+	/** The position of the next channel to dequeue */
+	size_t dequeue_pos __attribute__((aligned(ROHC_CACHE_LINE_LEN)));
+	/** The cells of the run queue */
+	struct rohc_channels_cell *cells __attribute__((aligned(ROHC_CACHE_LINE_LEN)));
+	/** The memory blocks of the contexts destroyed by the worker, used by the
+	 *  worker thread only */
+	struct rohc_ctxt_pool ctxt_pool;
+};
+
+
+/** The manager of many ROHC channels run by a few worker threads */
+struct rohc_channels
+{
+	/** The number of cells of every run queue minus one, the number of cells
+	 *  is a power of 2 */
+	size_t mask;
+	/** The number of channels */
+	size_t channels_nr;
+	/** The channels */
+	struct rohc_channel *channels;
+	/** The number of worker threads */
+	size_t workers_nr;
+	/** The worker threads */
+	struct rohc_channels_worker *workers;
+};
+
+
+/** The maximum number of packets compressed at once by the executor */
+#define ROHC_CHANNELS_EXEC_BURST_MAX  32U
+
+
+/** One packet submitted to the executor */
+struct rohc_channels_exec_slot
+{
+	/** The uncompressed packet */
+	struct rohc_buf uncomp_packet;
+	/** The buffer of the ROHC packet, given by the user */
+	struct rohc_buf *rohc_packet;
+	/** The status of the compression of the packet */
+	rohc_status_t status;
+};
+
+
+/** The packets submitted to the executor for one channel */
+struct rohc_channels_exec_queue
+{
+	/** The index of the next slot to submit, written by the submitter only */
+	size_t submit_pos __attribute__((aligned(ROHC_CACHE_LINE_LEN)));
+	/** The index of the next slot to compress, written by the worker that
+	 *  runs the channel only */
+	size_t compress_pos __attribute__((aligned(ROHC_CACHE_LINE_LEN)));
+	/** The index of the next slot to collect, written by the collector only */
+	size_t collect_pos __attribute__((aligned(ROHC_CACHE_LINE_LEN)));
+	/** The submitted packets */
+	struct rohc_channels_exec_slot *slots __attribute__((aligned(ROHC_CACHE_LINE_LEN)));
+};
+
+
+/** The burst of packets compressed at once by one worker thread */
+struct rohc_channels_exec_burst
+{
+	/** The uncompressed packets of the burst */
+	struct rohc_buf uncomp_packets[ROHC_CHANNELS_EXEC_BURST_MAX];
+	/** The ROHC packets of the burst */
+	struct rohc_buf rohc_packets[ROHC_CHANNELS_EXEC_BURST_MAX];
+	/** The status of the compression of every packet of the burst */
+	rohc_status_t statuses[ROHC_CHANNELS_EXEC_BURST_MAX];
+} __attribute__((aligned(ROHC_CACHE_LINE_LEN)));
+
+
+/** The executor that compresses the packets of many channels by bursts */
+struct rohc_channels_exec
+{
+	/** The manager of the channels */
+	struct rohc_channels *channels;
+	/** The number of slots of every queue minus one, the number of slots is
+	 *  a power of 2 */
+	size_t mask;
+	/** The maximum number of packets compressed at once for one channel */
+	size_t burst_max;
+	/** The queues of submitted packets, one per channel */
+	struct rohc_channels_exec_queue *queues;
+	/** The bursts being compressed, one per worker thread, allocated once to
+	 *  keep them off the stack of the workers */
+	struct rohc_channels_exec_burst *bursts;
+};
+
+
+static void rohc_channels_push(const struct rohc_channels *const channels,
+                               struct rohc_channels_worker *const worker,
+                               const size_t channel)
+	__attribute__((nonnull(1, 2)));
+static bool rohc_channels_pop(const struct rohc_channels *const channels,
+                              struct rohc_channels_worker *const worker,
+                              size_t *const channel)
+	__attribute__((warn_unused_result, nonnull(1, 2, 3)));
+
+
+/*
+ * Definitions of public functions
+ */
+
+
+/**
+ * @brief Create a new manager of ROHC channels
+ *
+ * @param channels_nr  The maximum number of channels
+ * @param workers_nr   The number of worker threads that run the channels
+ * @return             The new manager if successful,
+ *                     NULL if parameters are invalid or in case of memory
+ *                     allocation failure
+ *
+ * @ingroup rohc_comp
+ *
+ * @see rohc_channels_free
+ * @see rohc_channels_add
+ */
+struct rohc_channels * rohc_channels_new(const size_t channels_nr,
+                                         const size_t workers_nr)
+{
+	struct rohc_channels *channels;
+	size_t cells_nr;
+	size_t i;
+
+	if(channels_nr == 0 || workers_nr == 0)
+	{
+		goto error;
+	}
+
+	channels = rohc_malloc(sizeof(struct rohc_channels));
+	if(channels == NULL)
+	{
+		goto error;
+	}
+	memset(channels, 0, sizeof(struct rohc_channels));
+
+	/* one channel is queued at most once at any time */
+	for(cells_nr = 1; cells_nr < channels_nr; cells_nr <<= 1)
+	{
+	}
+	channels->mask = cells_nr - 1;
+
+	channels->channels = rohc_calloc(channels_nr, sizeof(struct rohc_channel));
+	if(channels->channels == NULL)
+	{
+		goto free_channels;
+	}
+	channels->channels_nr = channels_nr;
+	for(i = 0; i < channels_nr; i++)
+	{
+		channels->channels[i].state = ROHC_CHANNEL_FREE;
+	}
+
+	channels->workers = rohc_calloc(workers_nr, sizeof(struct rohc_channels_worker));
+	if(channels->workers == NULL)
+	{
+		goto free_channels_array;
+	}
+	for(i = 0; i < workers_nr; i++)
+	{
+		struct rohc_channels_worker *const worker = &channels->workers[i];
+		size_t j;
+
+		rohc_ctxt_pool_init(&worker->ctxt_pool);
+		worker->cells = rohc_calloc(cells_nr, sizeof(struct rohc_channels_cell));
+		if(worker->cells == NULL)
+		{
+			goto free_workers;
+		}
+		for(j = 0; j < cells_nr; j++)
+		{
+			worker->cells[j].seq = j;
+		}
+		channels->workers_nr++;
+	}
+
+	return channels;
+
+free_workers:
+	for(i = 0; i < channels->workers_nr; i++)
+	{
+		rohc_free(channels->workers[i].cells);
+	}
+	zfree(channels->workers);
+free_channels_array:
+	zfree(channels->channels);
+free_channels:
+	zfree(channels);
+error:
+	return NULL;
+}
+
+
+/**
+ * @brief Destroy the given manager of ROHC channels
+ *
+ * No thread shall use the manager anymore. The compressors and the
+ * decompressors of the channels are not destroyed, they may be used again
+ * out of the manager.
+ *
+ * @param channels  The manager to destroy, may be NULL
+ *
+ * @ingroup rohc_comp
+ *
+ * @see rohc_channels_new
+ */
+void rohc_channels_free(struct rohc_channels *const channels)
+{
+	size_t i;
+
+	if(channels == NULL)
+	{
+		return;
+	}
+
+	for(i = 0; i < channels->workers_nr; i++)
+	{
+		rohc_ctxt_pool_free(&channels->workers[i].ctxt_pool);
+		rohc_free(channels->workers[i].cells);
+	}
+	rohc_free(channels->workers);
+	rohc_free(channels->channels);
+	rohc_free(channels);
+}
+
+
+/**
+ * @brief Add one channel to the manager
+ *
+ * Once added, the compressor and the decompressor shall be used only by the
+ * worker that runs the channel, see \ref rohc_channels_next, until the channel
+ * is removed. They shall not use a memory budget, huge pages nor a NUMA
+ * node.
+ *
+ * Channels may be added by any thread.
+ *
+ * @param channels      The manager of ROHC channels
+ * @param comp          The compressor of the channel, may be NULL
+ * @param decomp        The decompressor of the channel, may be NULL
+ * @param[out] channel  The ID of the new channel
+ * @return              true if the channel was added,
+ *                      false if the manager is full or if the parameters are
+ *                      invalid
+ *
+ * @ingroup rohc_comp
+ *
+ * @see rohc_channels_remove
+ */
+bool rohc_channels_add(struct rohc_channels *const channels,
+                       struct rohc_comp *const comp,
+                       struct rohc_decomp *const decomp,
+                       size_t *const channel)
+{
+	size_t i;
+
+	if(channels == NULL || channel == NULL)
+	{
+		goto error;
+	}
+	if(comp == NULL && decomp == NULL)
+	{
+		goto error;
+	}
+
+	/* the blocks carved from a memory budget, from huge pages or from the
+	 * memory of one NUMA node cannot move to the pools of the workers */
+	if(comp != NULL && rohc_ctxt_pool_owns_mem(&comp->ctxt_pool))
+	{
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		             "compressor with a memory budget, huge pages or a NUMA "
+		             "node cannot be run by a manager of channels");
+		goto error;
+	}
+	if(decomp != NULL && rohc_ctxt_pool_owns_mem(&decomp->ctxt_pool))
+	{
+		rohc_warning(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+		             "decompressor with a memory budget, huge pages or a NUMA "
+		             "node cannot be run by a manager of channels");
+		goto error;
+	}
+
+	for(i = 0; i < channels->channels_nr; i++)
+	{
+		struct rohc_channel *const chan = &channels->channels[i];
+		unsigned int state = ROHC_CHANNEL_FREE;
+
+		if(__atomic_compare_exchange_n(&chan->state, &state,
+		                               ROHC_CHANNEL_CHANGING, false,
+		                               __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+		{
+			chan->comp = comp;
+			chan->decomp = decomp;
+			__atomic_store_n(&chan->worker, i % channels->workers_nr,
+			                 __ATOMIC_RELAXED);
+			__atomic_store_n(&chan->state, ROHC_CHANNEL_IDLE, __ATOMIC_RELEASE);
+			*channel = i;
+			return true;
+		}
+	}
+
+error:
+	return false;
+}
+
+
+/**
+ * @brief Remove one channel from the manager
+ *
+ * Only an idle channel may be removed: the channel shall not be queued nor
+ * run. Its compressor and its decompressor may be used again out of the
+ * manager.
+ *
+ * Channels may be removed by any thread.
+ *
+ * @param channels  The manager of ROHC channels
+ * @param channel   The ID of the channel to remove
+ * @return          true if the channel was removed,
+ *                  false if the channel is not idle or if the parameters are
+ *                  invalid
+ *
+ * @ingroup rohc_comp
+ *
+ * @see rohc_channels_add
+ */
+bool rohc_channels_remove(struct rohc_channels *const channels,
+                          const size_t channel)
+{
+	struct rohc_channel *chan;
+	unsigned int state = ROHC_CHANNEL_IDLE;
+
+	if(channels == NULL || channel >= channels->channels_nr)
+	{
+		goto error;
+	}
+	chan = &channels->channels[channel];
+
+	if(!__atomic_compare_exchange_n(&chan->state, &state,
+	                                ROHC_CHANNEL_CHANGING, false,
+	                                __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+	{
+		goto error;
+	}
+	chan->comp = NULL;
+	chan->decomp = NULL;
+	__atomic_store_n(&chan->state, ROHC_CHANNEL_FREE, __ATOMIC_RELEASE);
+
+	return true;
+
+error:
+	return false;
+}
+
+
+/**
+ * @brief Notify the manager that one channel has work to do
+ *
+ * An idle channel is queued for the worker that ran it last. A queued channel
+ * is not queued twice. A channel notified while it runs is queued again when
+ * its worker is done with it, see \ref rohc_channels_done.
+ *
+ * The work (the packets to compress or decompress for example) shall be made
+ * available to the workers before the channel is notified. Channels may be
+ * notified by any thread.
+ *
+ * @param channels  The manager of ROHC channels
+ * @param channel   The ID of the channel that has work to do
+ * @return          true if the channel was notified,
+ *                  false if the parameters are invalid
+ *
+ * @ingroup rohc_comp
+ */
+bool rohc_channels_notify(struct rohc_channels *const channels,
+                          const size_t channel)
+{
+	struct rohc_channel *chan;
+	unsigned int state;
+
+	if(channels == NULL || channel >= channels->channels_nr)
+	{
+		goto error;
+	}
+	chan = &channels->channels[channel];
+
+	/* always write the state, even if the channel was already notified, so
+	 * that the worker that runs the channel next sees the work */
+	state = __atomic_load_n(&chan->state, __ATOMIC_RELAXED);
+	do
+	{
+		if((state & (ROHC_CHANNEL_FREE | ROHC_CHANNEL_CHANGING)) != 0)
+		{
+			goto error;
+		}
+	}
+	while(!__atomic_compare_exchange_n(&chan->state, &state,
+	                                   state | ROHC_CHANNEL_NOTIFIED, true,
+	                                   __ATOMIC_ACQ_REL, __ATOMIC_RELAXED));
+
+	if(state == ROHC_CHANNEL_IDLE)
+	{
+		const size_t worker = __atomic_load_n(&chan->worker, __ATOMIC_RELAXED);
+		rohc_channels_push(channels, &channels->workers[worker], channel);
+	}
+
+	return true;
+
+error:
+	return false;
+}
+
+
+/**
+ * @brief Get the next channel to run by one worker thread
+ *
+ * The channels queued for the worker are run first. When none is queued, one
+ * channel queued for another worker is stolen.
+ *
+ * The worker may use the compressor and the decompressor of the channel until
+ * it calls \ref rohc_channels_done. Every worker shall be run by one single
+ * thread at a time.
+ *
+ * @param channels      The manager of ROHC channels
+ * @param worker        The index of the worker thread, less than the number
+ *                      of workers given to \ref rohc_channels_new
+ * @param[out] channel  The ID of the channel to run
+ * @param[out] comp     The compressor of the channel, may be NULL
+ * @param[out] decomp   The decompressor of the channel, may be NULL
+ * @return              true if one channel shall be run,
+ *                      false if no channel is queued or if the parameters are
+ *                      invalid
+ *
+ * @ingroup rohc_comp
+ */
+bool rohc_channels_next(struct rohc_channels *const channels,
+                        const size_t worker,
+                        size_t *const channel,
+                        struct rohc_comp **const comp,
+                        struct rohc_decomp **const decomp)
+{
+	struct rohc_channels_worker *runner;
+	struct rohc_channel *chan;
+	size_t i;
+
+	if(channels == NULL || worker >= channels->workers_nr || channel == NULL ||
+	   comp == NULL || decomp == NULL)
+	{
+		goto error;
+	}
+	runner = &channels->workers[worker];
+
+	/* own run queue first, then steal from the next workers */
+	for(i = 0; i < channels->workers_nr; i++)
+	{
+		const size_t victim = (worker + i) % channels->workers_nr;
+
+		if(rohc_channels_pop(channels, &channels->workers[victim], channel))
+		{
+			break;
+		}
+	}
+	if(i == channels->workers_nr)
+	{
+		goto error;
+	}
+	chan = &channels->channels[*channel];
+
+	/* the work notified so far is going to be done */
+	__atomic_exchange_n(&chan->state, ROHC_CHANNEL_RUNNING, __ATOMIC_ACQ_REL);
+
+	if(chan->comp != NULL)
+	{
+		chan->comp->cur_ctxt_pool = &runner->ctxt_pool;
+	}
+	if(chan->decomp != NULL)
+	{
+		chan->decomp->cur_ctxt_pool = &runner->ctxt_pool;
+	}
+	*comp = chan->comp;
+	*decomp = chan->decomp;
+
+	return true;
+
+error:
+	return false;
+}
+
+
+/**
+ * @brief Tell the manager that one worker thread is done with one channel
+ *
+ * The channel becomes idle, or it is queued again for the worker if it was
+ * notified while it ran.
+ *
+ * @param channels  The manager of ROHC channels
+ * @param worker    The index of the worker thread that ran the channel
+ * @param channel   The ID of the channel given by \ref rohc_channels_next
+ * @return          true if the channel was released,
+ *                  false if the parameters are invalid
+ *
+ * @ingroup rohc_comp
+ */
+bool rohc_channels_done(struct rohc_channels *const channels,
+                        const size_t worker,
+                        const size_t channel)
+{
+	struct rohc_channel *chan;
+	unsigned int state = ROHC_CHANNEL_RUNNING;
+
+	if(channels == NULL || worker >= channels->workers_nr ||
+	   channel >= channels->channels_nr)
+	{
+		goto error;
+	}
+	chan = &channels->channels[channel];
+	if((__atomic_load_n(&chan->state, __ATOMIC_RELAXED) &
+	    ROHC_CHANNEL_RUNNING) == 0)
+	{
+		goto error;
+	}
+
+	if(chan->comp != NULL)
+	{
+		chan->comp->cur_ctxt_pool = &chan->comp->ctxt_pool;
+	}
+	if(chan->decomp != NULL)
+	{
+		chan->decomp->cur_ctxt_pool = &chan->decomp->ctxt_pool;
+	}
+	__atomic_store_n(&chan->worker, worker, __ATOMIC_RELAXED);
+
+	if(!__atomic_compare_exchange_n(&chan->state, &state, ROHC_CHANNEL_IDLE,
+	                                false, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED))
+	{
+		/* notified while running: run it again, this worker or another one
+		 * that steals it */
+		__atomic_exchange_n(&chan->state, ROHC_CHANNEL_NOTIFIED, __ATOMIC_ACQ_REL);
+		rohc_channels_push(channels, &channels->workers[worker], channel);
+	}
+
+	return true;
+
+error:
+	return false;
+}
+
+
+/**
+ * @brief Create a new executor of the compression of many channels
+ *
+ * The packets submitted for one channel are compressed by the workers of the
+ * manager, by bursts of \e burst_max packets at most so that one busy channel
+ * does not hold one worker for too long. Every worker thread shall call
+ * \ref rohc_channels_exec_run in loop.
+ *
+ * The compressors of the channels shall not use ROHC segmentation.
+ *
+ * @param channels   The manager of the channels to run
+ * @param queue_len  The number of packets that may be submitted for one
+ *                   channel and not collected yet, a power of 2
+ * @param burst_max  The maximum number of packets compressed at once for one
+ *                   channel, from 1 to 32
+ * @return           The new executor if successful,
+ *                   NULL if parameters are invalid or in case of memory
+ *                   allocation failure
+ *
+ * @ingroup rohc_comp
+ *
+ * @see rohc_channels_exec_free
+ */
+struct rohc_channels_exec * rohc_channels_exec_new(struct rohc_channels *const channels,
+                                                   const size_t queue_len,
+                                                   const size_t burst_max)
+{
+	struct rohc_channels_exec *exec;
+	size_t i;
+
+	if(channels == NULL)
+	{
+		goto error;
+	}
+	if(queue_len == 0 || (queue_len & (queue_len - 1)) != 0)
+	{
+		goto error;
+	}
+	if(burst_max == 0 || burst_max > ROHC_CHANNELS_EXEC_BURST_MAX)
+	{
+		goto error;
+	}
+
+	exec = rohc_malloc(sizeof(struct rohc_channels_exec));
+	if(exec == NULL)
+	{
+		goto error;
+	}
+	memset(exec, 0, sizeof(struct rohc_channels_exec));
+	exec->channels = channels;
+	exec->mask = queue_len - 1;
+	exec->burst_max = burst_max;
+
+	exec->queues = rohc_calloc(channels->channels_nr,
+	                      sizeof(struct rohc_channels_exec_queue));
+	if(exec->queues == NULL)
+	{
+		goto free_exec;
+	}
+	for(i = 0; i < channels->channels_nr; i++)
+	{
+		exec->queues[i].slots =
+			rohc_calloc(queue_len, sizeof(struct rohc_channels_exec_slot));
+		if(exec->queues[i].slots == NULL)
+		{
+			goto free_queues;
+		}
+	}
+
+	exec->bursts = rohc_calloc(channels->workers_nr,
+	                           sizeof(struct rohc_channels_exec_burst));
+	if(exec->bursts == NULL)
+	{
+		goto free_queues;
+	}
+
+	return exec;
+
+free_queues:
+	for(i = 0; i < channels->channels_nr; i++)
+	{
+		rohc_free(exec->queues[i].slots);
+	}
+	zfree(exec->queues);
+free_exec:
+	zfree(exec);
+error:
+	return NULL;
+}
+
+
+/**
+ * @brief Destroy the given executor
+ *
+ * No thread shall use the executor anymore. The packets that are still
+ * queued are dropped. The manager of the channels is not destroyed.
+ *
+ * @param exec  The executor to destroy, may be NULL
+ *
+ * @ingroup rohc_comp
+ *
+ * @see rohc_channels_exec_new
+ */
+void rohc_channels_exec_free(struct rohc_channels_exec *const exec)
+{
+	size_t i;
+
+	if(exec == NULL)
+	{
+		return;
+	}
+
+	for(i = 0; i < exec->channels->channels_nr; i++)
+	{
+		rohc_free(exec->queues[i].slots);
+	}
+	rohc_free(exec->queues);
+	rohc_free(exec->bursts);
+	rohc_free(exec);
+}
+
+
+/**
+ * @brief Submit one packet to compress on one channel
+ *
+ * The packet is queued for the channel, then the channel is notified. The
+ * packet data is not copied: the uncompressed packet shall remain valid until
+ * the ROHC packet is collected by \ref rohc_channels_exec_collect. The ROHC
+ * packet shall be an empty buffer.
+ *
+ * Only one thread at a time may submit packets for one channel.
+ *
+ * @param exec           The executor
+ * @param channel        The ID of the channel, its compressor compresses the
+ *                       packet
+ * @param uncomp_packet  The uncompressed packet to compress
+ * @param rohc_packet    The buffer for the resulting ROHC packet
+ * @return               true if the packet was submitted,
+ *                       false if the queue of the channel is full, if the
+ *                       channel has no compressor or if the parameters are
+ *                       invalid
+ *
+ * @ingroup rohc_comp
+ */
+bool rohc_channels_exec_submit(struct rohc_channels_exec *const exec,
+                               const size_t channel,
+                               const struct rohc_buf uncomp_packet,
+                               struct rohc_buf *const rohc_packet)
+{
+	struct rohc_channels_exec_queue *queue;
+	struct rohc_channels_exec_slot *slot;
+	size_t submit_pos;
+
+	if(exec == NULL || channel >= exec->channels->channels_nr ||
+	   rohc_packet == NULL)
+	{
+		goto error;
+	}
+	if(exec->channels->channels[channel].comp == NULL)
+	{
+		goto error;
+	}
+	queue = &exec->queues[channel];
+
+	/* the slot is free once its previous packet was collected */
+	submit_pos = __atomic_load_n(&queue->submit_pos, __ATOMIC_RELAXED);
+	if((submit_pos - __atomic_load_n(&queue->collect_pos, __ATOMIC_ACQUIRE)) >
+	   exec->mask)
+	{
+		goto error;
+	}
+	slot = &queue->slots[submit_pos & exec->mask];
+	slot->uncomp_packet = uncomp_packet;
+	slot->rohc_packet = rohc_packet;
+
+	__atomic_store_n(&queue->submit_pos, submit_pos + 1, __ATOMIC_RELEASE);
+
+	return rohc_channels_notify(exec->channels, channel);
+
+error:
+	return false;
+}
+
+
+/**
+ * @brief Run one channel on one worker thread
+ *
+ * The next channel of the worker, or one channel stolen from another worker,
+ * compresses one burst of its submitted packets. The channel is notified
+ * again if packets remain, so that the channels take turns on the workers.
+ *
+ * @param exec    The executor
+ * @param worker  The index of the worker thread, less than the number of
+ *                workers of the manager
+ * @return        The number of packets compressed (with success or not),
+ *                0 if no channel has packets to compress or if the parameters
+ *                are invalid
+ *
+ * @ingroup rohc_comp
+ */
+size_t rohc_channels_exec_run(struct rohc_channels_exec *const exec,
+                              const size_t worker)
+{
+	struct rohc_channels_exec_burst *burst;
+	struct rohc_channels_exec_queue *queue;
+	struct rohc_decomp *decomp;
+	struct rohc_comp *comp;
+	size_t compress_pos;
+	size_t packets_nr;
+	size_t handled_nr;
+	size_t channel;
+	size_t i;
+
+	if(exec == NULL)
+	{
+		goto error;
+	}
+	if(!rohc_channels_next(exec->channels, worker, &channel, &comp, &decomp))
+	{
+		goto error;
+	}
+	queue = &exec->queues[channel];
+	burst = &exec->bursts[worker];
+
+	compress_pos = __atomic_load_n(&queue->compress_pos, __ATOMIC_RELAXED);
+	packets_nr = __atomic_load_n(&queue->submit_pos, __ATOMIC_ACQUIRE) -
+	             compress_pos;
+	if(packets_nr > exec->burst_max)
+	{
+		packets_nr = exec->burst_max;
+	}
+
+	for(i = 0; i < packets_nr; i++)
+	{
+		const struct rohc_channels_exec_slot *const slot =
+			&queue->slots[(compress_pos + i) & exec->mask];
+
+		burst->uncomp_packets[i] = slot->uncomp_packet;
+		burst->rohc_packets[i] = *(slot->rohc_packet);
+	}
+
+	/* the burst stops after a packet that requires ROHC segmentation */
+	for(handled_nr = 0; handled_nr < packets_nr; )
+	{
+		size_t nr = 0;
+
+		if(comp != NULL)
+		{
+			nr = rohc_compress_burst(comp, burst->uncomp_packets + handled_nr,
+			                         burst->rohc_packets + handled_nr,
+			                         packets_nr - handled_nr,
+			                         burst->statuses + handled_nr);
+		}
+		if(nr == 0)
+		{
+			burst->statuses[handled_nr] = ROHC_STATUS_ERROR;
+			nr = 1;
+		}
+		handled_nr += nr;
+	}
+
+	for(i = 0; i < packets_nr; i++)
+	{
+		struct rohc_channels_exec_slot *const slot =
+			&queue->slots[(compress_pos + i) & exec->mask];
+
+		*(slot->rohc_packet) = burst->rohc_packets[i];
+		slot->status = burst->statuses[i];
+	}
+	__atomic_store_n(&queue->compress_pos, compress_pos + packets_nr,
+	                 __ATOMIC_RELEASE);
+
+	/* let the other channels run before the remaining packets */
+	if(__atomic_load_n(&queue->submit_pos, __ATOMIC_ACQUIRE) !=
+	   (compress_pos + packets_nr))
+	{
+		if(!rohc_channels_notify(exec->channels, channel))
+		{
+			/* the running channel cannot be removed */
+			assert(0);
+		}
+	}
+	if(!rohc_channels_done(exec->channels, worker, channel))
+	{
+		/* the channel was given by rohc_channels_next() */
+		assert(0);
+	}
+
+	return packets_nr;
+
+error:
+	return 0;
+}
+
+
+/**
+ * @brief Collect the oldest compressed packet of one channel
+ *
+ * The packets of one channel are collected in the order they were submitted.
+ *
+ * Only one thread at a time may collect packets for one channel.
+ *
+ * @param exec              The executor
+ * @param channel           The ID of the channel
+ * @param[out] rohc_packet  The buffer of the ROHC packet, as given to
+ *                          \ref rohc_channels_exec_submit
+ * @param[out] status       The status of the compression of the packet, see
+ *                          \ref rohc_compress4
+ * @return                  true if one packet was collected,
+ *                          false if no compressed packet is waiting or if the
+ *                          parameters are invalid
+ *
+ * @ingroup rohc_comp
+ */
+bool rohc_channels_exec_collect(struct rohc_channels_exec *const exec,
+                                const size_t channel,
+                                struct rohc_buf **const rohc_packet,
+                                rohc_status_t *const status)
+{
+	struct rohc_channels_exec_queue *queue;
+	struct rohc_channels_exec_slot *slot;
+	size_t collect_pos;
+
+	if(exec == NULL || channel >= exec->channels->channels_nr ||
+	   rohc_packet == NULL || status == NULL)
+	{
+		goto error;
+	}
+	queue = &exec->queues[channel];
+
+	collect_pos = __atomic_load_n(&queue->collect_pos, __ATOMIC_RELAXED);
+	if(collect_pos == __atomic_load_n(&queue->compress_pos, __ATOMIC_ACQUIRE))
+	{
+		goto error;
+	}
+	slot = &queue->slots[collect_pos & exec->mask];
+
+	*rohc_packet = slot->rohc_packet;
+	*status = slot->status;
+
+	__atomic_store_n(&queue->collect_pos, collect_pos + 1, __ATOMIC_RELEASE);
+
+	return true;
+
+error:
+	return false;
+}
+
+
+/*
+ * Definitions of private functions
+ */
+
+
+/**
+ * @brief Queue one channel in the run queue of one worker
+ *
+ * The run queue is never full since one channel is queued at most once.
+ *
+ * @param channels  The manager of ROHC channels
+ * @param worker    The worker to queue the channel for
+ * @param channel   The ID of the channel to queue
+ */
+static void rohc_channels_push(const struct rohc_channels *const channels,
+                               struct rohc_channels_worker *const worker,
+                               const size_t channel)
+{
+	struct rohc_channels_cell *cell;
+	size_t pos = __atomic_load_n(&worker->enqueue_pos, __ATOMIC_RELAXED);
+
+	for(;;)
+	{
+		size_t seq;
+
+		cell = &worker->cells[pos & channels->mask];
+		seq = __atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE);
+		if(seq == pos)
+		{
+			if(__atomic_compare_exchange_n(&worker->enqueue_pos, &pos, pos + 1,
+			                               true, __ATOMIC_RELAXED,
+			                               __ATOMIC_RELAXED))
+			{
+				break;
+			}
+		}
+		else
+		{
+			/* the cell is not read yet: another thread queued at the same
+			 * position first */
+			assert(((intptr_t) (seq - pos)) > 0);
+			pos = __atomic_load_n(&worker->enqueue_pos, __ATOMIC_RELAXED);
+		}
+	}
+
+	cell->channel = channel;
+	__atomic_store_n(&cell->seq, pos + 1, __ATOMIC_RELEASE);
+}
+
+
+/**
+ * @brief Dequeue one channel from the run queue of one worker
+ *
+ * @param channels      The manager of ROHC channels
+ * @param worker        The worker to dequeue the channel from
+ * @param[out] channel  The ID of the dequeued channel
+ * @return              true if one channel was dequeued,
+ *                      false if the run queue is empty
+ */
+static bool rohc_channels_pop(const struct rohc_channels *const channels,
+                              struct rohc_channels_worker *const worker,
+                              size_t *const channel)
+{
+	struct rohc_channels_cell *cell;
+	size_t pos = __atomic_load_n(&worker->dequeue_pos, __ATOMIC_RELAXED);
+
+	for(;;)
+	{
+		intptr_t diff;
+
+		cell = &worker->cells[pos & channels->mask];
+		diff = (intptr_t) (__atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE) -
+		                   (pos + 1));
+		if(diff == 0)
+		{
+			if(__atomic_compare_exchange_n(&worker->dequeue_pos, &pos, pos + 1,
+			                               true, __ATOMIC_RELAXED,
+			                               __ATOMIC_RELAXED))
+			{
+				break;
+			}
+		}
+		else if(diff < 0)
+		{
+			/* the cell is not written yet */
+			return false;
+		}
+		else
+		{
+			/* another thread dequeued at the same position first */
+			pos = __atomic_load_n(&worker->dequeue_pos, __ATOMIC_RELAXED);
+		}
+	}
+
+	*channel = cell->channel;
+	__atomic_store_n(&cell->seq, pos + channels->mask + 1, __ATOMIC_RELEASE);
+
+	return true;
+}
+
@@ -0,0 +1,407 @@
+/*
+ * Copyright 2016 Didier Barvaux
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/**
+ * @file   rohc_comp_couple.c
+ * @brief  Couple of one local compressor and one local decompressor
+ * @author Didier Barvaux <didier@barvaux.org>
+ *
+ * On a bidirectional link, the local decompressor receives the feedback for
+ * the local compressor, and it builds the feedback for the remote compressor
+ * that shall be piggybacked on the packets of the local compressor. The
+ * couple moves the feedback between them:
+ *  - the feedback received within the ROHC packets is delivered to the local
+ *    compressor straight from the ROHC packets,
+ *  - the feedback built by the local decompressor is built straight in the
+ *    pending feedback of the couple, then copied in front of the next ROHC
+ *    packets of the local compressor.
+ */
+
+#include "rohc_comp.h"
+#include "rohc_decomp.h"
+#include "feedback_parse.h"
+#include "rohc_alloc.h"
+
+#ifndef __KERNEL__
+#  include <string.h>
+#endif
+#include <assert.h>
+
+
+/** The maximum length (in bytes) of the feedback that waits for being
+ *  piggybacked */
+#define ROHC_COMP_COUPLE_FEEDBACK_MAX_LEN  2048U
+
+/** The padding octet of ROHC packets, see RFC 3095 §5.2 */
+#define ROHC_COMP_COUPLE_PADDING  0xe0
+
+
+/** One local compressor and one local decompressor of a bidirectional link */
+struct rohc_couple
+{
+	/** The local compressor */
+	struct rohc_comp *comp;
+	/** The local decompressor */
+	struct rohc_decomp *decomp;
+	/** The maximum length (in bytes) of the feedback piggybacked on one
+	 *  ROHC packet */
+	size_t feedback_budget;
+	/** The feedback for the remote compressor that waits for being
+	 *  piggybacked, a view of \e feedback_mem */
+	struct rohc_buf feedback;
+	/** The memory of the pending feedback */
+	uint8_t feedback_mem[ROHC_COMP_COUPLE_FEEDBACK_MAX_LEN];
+};
+
+
+static size_t rohc_couple_get_feedback_len(const struct rohc_couple *const couple,
+                                           const size_t max_len)
+	__attribute__((warn_unused_result, nonnull(1)));
+static void rohc_couple_consume_feedback(struct rohc_couple *const couple,
+                                         const size_t len)
+	__attribute__((nonnull(1)));
+
+
+/*
+ * Definitions of public functions
+ */
+
+
+/**
+ * @brief Create a new couple of ROHC compressor and decompressor
+ *
+ * The couple binds the local compressor and the local decompressor of one
+ * bidirectional link: the feedback received by the decompressor is delivered
+ * to the compressor, and the feedback built by the decompressor is
+ * piggybacked on the next packets of the compressor. Use
+ * \ref rohc_couple_compress and \ref rohc_couple_decompress instead of
+ * \ref rohc_compress4 and \ref rohc_decompress3.
+ *
+ * The couple does not own the compressor nor the decompressor: they shall
+ * be destroyed after the couple. The couple, its compressor and its
+ * decompressor shall be used by one thread at a time.
+ *
+ * @param comp             The local ROHC compressor
+ * @param decomp           The local ROHC decompressor
+ * @param feedback_budget  The maximum length (in bytes) of the feedback
+ *                         piggybacked on one ROHC packet, 0 to never
+ *                         piggyback feedback (see
+ *                         \ref rohc_couple_flush_feedback)
+ * @return                 The new couple if successful,
+ *                         NULL if parameters are invalid or in case of
+ *                         memory allocation failure
+ *
+ * @ingroup rohc_comp
+ *
+ * @see rohc_couple_free
+ */
+struct rohc_couple * rohc_couple_new(struct rohc_comp *const comp,
+                                     struct rohc_decomp *const decomp,
+                                     const size_t feedback_budget)
+{
+	struct rohc_couple *couple;
+
+	if(comp == NULL || decomp == NULL)
+	{
+		goto error;
+	}
+
+	couple = rohc_malloc(sizeof(struct rohc_couple));
+	if(couple == NULL)
+	{
+		goto error;
+	}
+	memset(couple, 0, sizeof(struct rohc_couple));
+	couple->comp = comp;
+	couple->decomp = decomp;
+	couple->feedback_budget = feedback_budget;
+	couple->feedback.time.sec = 0;
+	couple->feedback.time.nsec = 0;
+	couple->feedback.data = couple->feedback_mem;
+	couple->feedback.max_len = ROHC_COMP_COUPLE_FEEDBACK_MAX_LEN;
+	couple->feedback.offset = 0;
+	couple->feedback.len = 0;
+
+	return couple;
+
+error:
+	return NULL;
+}
+
+
+/**
+ * @brief Destroy the given couple of ROHC compressor and decompressor
+ *
+ * The compressor and the decompressor are not destroyed. The feedback that
+ * is still pending is lost.
+ *
+ * @param couple  The couple to destroy, may be NULL
+ *
+ * @ingroup rohc_comp
+ *
+ * @see rohc_couple_new
+ */
+void rohc_couple_free(struct rohc_couple *const couple)
+{
+	rohc_free(couple);
+}
+
+
+/**
+ * @brief Compress one packet with the compressor of the couple
+ *
+ * Compress the given uncompressed packet as \ref rohc_compress4 does. The
+ * pending feedback for the remote compressor is piggybacked in front of the
+ * ROHC packet, within the feedback budget of the couple: only whole feedback
+ * items are piggybacked, the oldest ones first. The output buffer shall be
+ * large enough for the ROHC packet and the piggybacked feedback.
+ *
+ * The feedback is piggybacked only if the packet is successfully compressed
+ * (\ref ROHC_STATUS_OK), it is kept pending otherwise.
+ *
+ * @param couple              The couple of compressor and decompressor
+ * @param uncomp_packet       The uncompressed packet to compress
+ * @param[out] rohc_packet    The resulting ROHC packet with its piggybacked
+ *                            feedback
+ * @return                    See \ref rohc_compress4
+ *
+ * @ingroup rohc_comp
+ *
+ * @see rohc_compress4
+ */
+rohc_status_t rohc_couple_compress(struct rohc_couple *const couple,
+                                   const struct rohc_buf uncomp_packet,
+                                   struct rohc_buf *const rohc_packet)
+{
+	size_t feedback_len = 0;
+	rohc_status_t status;
+
+	if(couple == NULL || rohc_packet == NULL)
+	{
+		goto error;
+	}
+
+	/* copy the oldest feedback items in front of the ROHC packet */
+	if(!rohc_buf_is_malformed(*rohc_packet) && rohc_buf_is_empty(*rohc_packet))
+	{
+		size_t max_len = couple->feedback_budget;
+
+		if(max_len > rohc_buf_avail_len(*rohc_packet))
+		{
+			max_len = rohc_buf_avail_len(*rohc_packet);
+		}
+		feedback_len = rohc_couple_get_feedback_len(couple, max_len);
+		if(feedback_len > 0)
+		{
+			rohc_buf_append(rohc_packet, rohc_buf_data(couple->feedback),
+			                feedback_len);
+			rohc_buf_pull(rohc_packet, feedback_len);
+		}
+	}
+
+	status = rohc_compress4(couple->comp, uncomp_packet, rohc_packet);
+
+	/* unhide the feedback if the packet is sent, keep it pending otherwise */
+	if(status == ROHC_STATUS_OK)
+	{
+		rohc_buf_push(rohc_packet, feedback_len);
+		rohc_couple_consume_feedback(couple, feedback_len);
+	}
+	else
+	{
+		rohc_packet->offset -= feedback_len;
+	}
+
+	return status;
+
+error:
+	return ROHC_STATUS_ERROR;
+}
+
+
+/**
+ * @brief Decompress one packet with the decompressor of the couple
+ *
+ * Decompress the given ROHC packet as \ref rohc_decompress3 does. The
+ * feedback piggybacked on the ROHC packet is delivered to the compressor of
+ * the couple, see \ref rohc_comp_deliver_feedback2. The feedback that the
+ * decompressor builds for the remote compressor is kept pending until it is
+ * piggybacked by \ref rohc_couple_compress or retrieved by
+ * \ref rohc_couple_flush_feedback. The new feedback is lost if the pending
+ * feedback already fills the room of the couple.
+ *
+ * @param couple              The couple of compressor and decompressor
+ * @param rohc_packet         The compressed packet to decompress
+ * @param[out] uncomp_packet  The resulting uncompressed packet
+ * @return                    See \ref rohc_decompress3
+ *
+ * @ingroup rohc_comp
+ *
+ * @see rohc_decompress3
+ */
+rohc_status_t rohc_couple_decompress(struct rohc_couple *const couple,
+                                     const struct rohc_buf rohc_packet,
+                                     struct rohc_buf *const uncomp_packet)
+{
+	struct rohc_buf rcvd_feedback = rohc_packet;
+	struct rohc_buf feedback_send;
+	rohc_status_t status;
+
+	if(couple == NULL || rohc_buf_is_malformed(rohc_packet))
+	{
+		goto error;
+	}
+
+	/* deliver the piggybacked feedback to the compressor straight from the
+	 * ROHC packet, the decompressor skips it */
+	while(rcvd_feedback.len > 0 &&
+	      rohc_buf_byte(rcvd_feedback) == ROHC_COMP_COUPLE_PADDING)
+	{
+		rohc_buf_pull(&rcvd_feedback, 1);
+	}
+	if(rcvd_feedback.len > 0 &&
+	   rohc_packet_is_feedback(rohc_buf_byte(rcvd_feedback)) &&
+	   !rohc_comp_deliver_feedback2(couple->comp, rcvd_feedback))
+	{
+		/* the compressor already traced the reason, the packet shall be
+		 * decompressed anyway */
+	}
+
+	/* build the new feedback just after the pending one */
+	if(couple->feedback.offset > 0)
+	{
+		memmove(couple->feedback_mem, rohc_buf_data(couple->feedback),
+		        couple->feedback.len);
+		couple->feedback.offset = 0;
+	}
+	feedback_send = couple->feedback;
+	rohc_buf_pull(&feedback_send, couple->feedback.len);
+
+	status = rohc_decompress3(couple->decomp, rohc_packet, uncomp_packet,
+	                          NULL, &feedback_send);
+	couple->feedback.len += feedback_send.len;
+
+	return status;
+
+error:
+	return ROHC_STATUS_ERROR;
+}
+
+
+/**
+ * @brief Retrieve the feedback that waits for being piggybacked
+ *
+ * The pending feedback items are appended to the given buffer, the oldest
+ * ones first, in order to be sent in one standalone feedback packet. This is
+ * useful when the local compressor has got no packet to send for a while.
+ * The feedback items that do not fit in the buffer stay pending.
+ *
+ * @param couple         The couple of compressor and decompressor
+ * @param[out] feedback  The buffer where to append the feedback
+ * @return               true if the feedback was retrieved (may be 0 byte),
+ *                       false if parameters are invalid
+ *
+ * @ingroup rohc_comp
+ */
+bool rohc_couple_flush_feedback(struct rohc_couple *const couple,
+                                struct rohc_buf *const feedback)
+{
+	size_t feedback_len;
+
+	if(couple == NULL || feedback == NULL || rohc_buf_is_malformed(*feedback))
+	{
+		goto error;
+	}
+
+	feedback_len = rohc_couple_get_feedback_len(couple,
+	                                            rohc_buf_avail_len(*feedback) -
+	                                            feedback->len);
+	rohc_buf_append(feedback, rohc_buf_data(couple->feedback), feedback_len);
+	rohc_couple_consume_feedback(couple, feedback_len);
+
+	return true;
+
+error:
+	return false;
+}
+
+
+/*
+ * Definitions of private functions
+ */
+
+
+/**
+ * @brief Get the length of the oldest pending feedback items that fit
+ *
+ * @param couple   The couple of compressor and decompressor
+ * @param max_len  The maximum length of the feedback items
+ * @return         The length of the oldest whole feedback items that fit in
+ *                 \e max_len bytes
+ */
+static size_t rohc_couple_get_feedback_len(const struct rohc_couple *const couple,
+                                           const size_t max_len)
+{
+	struct rohc_buf remain_data = couple->feedback;
+	size_t len = 0;
+
+	while(remain_data.len > 0)
+	{
+		size_t feedback_hdr_len;
+		size_t feedback_data_len;
+		size_t feedback_len;
+
+		/* the decompressor builds well-formed feedback items only */
+		if(!rohc_feedback_get_size(remain_data, &feedback_hdr_len,
+		                           &feedback_data_len))
+		{
+			assert(0);
+			break;
+		}
+		feedback_len = feedback_hdr_len + feedback_data_len;
+		if(feedback_len > remain_data.len || (len + feedback_len) > max_len)
+		{
+			break;
+		}
+		len += feedback_len;
+		rohc_buf_pull(&remain_data, feedback_len);
+	}
+
+	return len;
+}
+
+
+/**
+ * @brief Remove the oldest pending feedback items
+ *
+ * @param couple  The couple of compressor and decompressor
+ * @param len     The length of the feedback items to remove
+ */
+static void rohc_couple_consume_feedback(struct rohc_couple *const couple,
+                                         const size_t len)
+{
+	assert(len <= couple->feedback.len);
+	rohc_buf_pull(&couple->feedback, len);
+
+	/* most of the time, all the pending feedback is piggybacked at once */
+	if(rohc_buf_is_empty(couple->feedback))
+	{
+		couple->feedback.offset = 0;
+	}
+}
+
@@ -0,0 +1,184 @@
+/*
+ * Copyright 2016 Didier Barvaux
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/**
+ * @file   rohc_comp_feedback_queue.c
+ * @brief  Lock-free queue of the feedback delivered by other threads
+ * @author Didier Barvaux <didier@barvaux.org>
+ *
+ * Every slot holds a sequence number. A slot is free for the producer that
+ * reserved position P when its sequence number equals P, and it is full for
+ * the consumer at position P when its sequence number equals P + 1. The
+ * producers reserve positions with a compare-and-swap on the push position,
+ * then publish every slot by updating its sequence number. The consumer
+ * frees the slot for the next turn of the queue once the feedback item is
+ * copied.
+ */
+
+#include "rohc_comp_feedback_queue.h"
+
+#ifndef __KERNEL__
+#  include <string.h>
+#endif
+#include <assert.h>
+
+
+/** The mask of the slot index */
+#define ROHC_COMP_FEEDBACK_QUEUE_MASK  (ROHC_COMP_FEEDBACK_QUEUE_SLOTS - 1)
+
+
+/**
+ * @brief Initialize the feedback queue
+ *
+ * @param queue  The feedback queue to initialize
+ */
+void rohc_comp_feedback_queue_init(struct rohc_comp_feedback_queue *const queue)
+{
+	size_t i;
+
+	queue->push_pos = 0;
+	queue->pop_pos = 0;
+	for(i = 0; i < ROHC_COMP_FEEDBACK_QUEUE_SLOTS; i++)
+	{
+		queue->slots[i].seq = i;
+		queue->slots[i].len = 0;
+	}
+}
+
+
+/**
+ * @brief Reserve consecutive slots of the queue
+ *
+ * May be called by several threads at the same time. The slots are freed
+ * by the consumer in the order of their positions: if the last slot of the
+ * range is free, the previous ones are free too.
+ *
+ * @param queue     The feedback queue
+ * @param slots_nr  The number of slots to reserve
+ * @param[out] pos  The position of the first reserved slot
+ * @return          true if the slots were reserved,
+ *                  false if the queue has not enough free slots
+ */
+bool rohc_comp_feedback_queue_reserve(struct rohc_comp_feedback_queue *const queue,
+                                      const size_t slots_nr,
+                                      size_t *const pos)
+{
+	size_t first;
+
+	if(slots_nr == 0 || slots_nr > ROHC_COMP_FEEDBACK_QUEUE_SLOTS)
+	{
+		return false;
+	}
+
+	first = __atomic_load_n(&queue->push_pos, __ATOMIC_RELAXED);
+	while(1)
+	{
+		const size_t last = first + slots_nr - 1;
+		const size_t seq =
+			__atomic_load_n(&queue->slots[last & ROHC_COMP_FEEDBACK_QUEUE_MASK].seq,
+			                __ATOMIC_ACQUIRE);
+
+		if(seq == last)
+		{
+			/* the slots are free, try to reserve them */
+			if(__atomic_compare_exchange_n(&queue->push_pos, &first,
+			                               first + slots_nr, true,
+			                               __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+			{
+				break;
+			}
+		}
+		else if(((ptrdiff_t) (seq - last)) < 0)
+		{
+			/* the last slot was not popped yet since the previous turn */
+			return false;
+		}
+		else
+		{
+			/* another producer reserved the slots meanwhile */
+			first = __atomic_load_n(&queue->push_pos, __ATOMIC_RELAXED);
+		}
+	}
+	*pos = first;
+
+	return true;
+}
+
+
+/**
+ * @brief Fill one reserved slot with a feedback item and publish it
+ *
+ * @param queue  The feedback queue
+ * @param pos    The position of the reserved slot
+ * @param data   The feedback data
+ * @param len    The length of the feedback data
+ */
+void rohc_comp_feedback_queue_publish(struct rohc_comp_feedback_queue *const queue,
+                                      const size_t pos,
+                                      const uint8_t *const data,
+                                      const size_t len)
+{
+	struct rohc_comp_feedback_slot *const slot =
+		&queue->slots[pos & ROHC_COMP_FEEDBACK_QUEUE_MASK];
+
+	assert(len <= ROHC_COMP_FEEDBACK_QUEUE_DATA_MAX);
+	assert(__atomic_load_n(&slot->seq, __ATOMIC_RELAXED) == pos);
+
+	memcpy(slot->data, data, len);
+	slot->len = len;
+	__atomic_store_n(&slot->seq, pos + 1, __ATOMIC_RELEASE);
+}
+
+
+/**
+ * @brief Pop the oldest feedback item from the queue
+ *
+ * Shall be called by one thread at a time.
+ *
+ * @param queue      The feedback queue
+ * @param[out] data  The feedback data, at least
+ *                   \ref ROHC_COMP_FEEDBACK_QUEUE_DATA_MAX bytes
+ * @param[out] len   The length of the feedback data
+ * @return           true if one feedback item was popped,
+ *                   false if the queue is empty
+ */
+bool rohc_comp_feedback_queue_pop(struct rohc_comp_feedback_queue *const queue,
+                                  uint8_t *const data,
+                                  size_t *const len)
+{
+	const size_t pos = queue->pop_pos;
+	struct rohc_comp_feedback_slot *const slot =
+		&queue->slots[pos & ROHC_COMP_FEEDBACK_QUEUE_MASK];
+
+	/* the slot is not published yet if its producer is still filling it */
+	if(__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) != (pos + 1))
+	{
+		return false;
+	}
+
+	memcpy(data, slot->data, slot->len);
+	*len = slot->len;
+
+	/* free the slot for the next turn of the queue */
+	__atomic_store_n(&slot->seq, pos + ROHC_COMP_FEEDBACK_QUEUE_SLOTS,
+	                 __ATOMIC_RELEASE);
+	queue->pop_pos = pos + 1;
+
+	return true;
+}
+
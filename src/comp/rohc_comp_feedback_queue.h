@@ -0,0 +1,99 @@
+/*
+ * Copyright 2016 Didier Barvaux
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/**
+ * @file   rohc_comp_feedback_queue.h
+ * @brief  Lock-free queue of the feedback delivered by other threads
+ * @author Didier Barvaux <didier@barvaux.org>
+ */
+
+#ifndef ROHC_COMP_FEEDBACK_QUEUE_H
+#define ROHC_COMP_FEEDBACK_QUEUE_H
+
+#include "rohc_seqcount.h" /* for ROHC_CACHE_LINE_LEN */
+
+#include <stdint.h>
+#include <stddef.h>
+#ifdef __KERNEL__
+#  include <linux/types.h>
+#else
+#  include <stdbool.h>
+#endif
+
+
+/** The number of slots of the feedback queue (a power of 2) */
+#define ROHC_COMP_FEEDBACK_QUEUE_SLOTS  64U
+/** The maximum length of the data of one feedback item */
+#define ROHC_COMP_FEEDBACK_QUEUE_DATA_MAX  255U
+
+
+/** One slot of the feedback queue, that holds the data of one feedback item */
+struct rohc_comp_feedback_slot
+{
+	/** The sequence number of the slot: it tells whether the slot is free
+	 *  or full for the current turn of the queue */
+	size_t seq;
+	/** The length of the feedback data */
+	size_t len;
+	/** The feedback data */
+	uint8_t data[ROHC_COMP_FEEDBACK_QUEUE_DATA_MAX];
+};
+
+
+/**
+ * @brief The queue of the feedback delivered by other threads
+ *
+ * The queue is bounded and lock-free: several threads may push feedback
+ * items at the same time, and the thread of the compressor pops them. The
+ * position of the producers and the position of the consumer are kept on
+ * distinct cache lines.
+ */
+struct rohc_comp_feedback_queue
+{
+	/** The position where the next feedback item is pushed */
+	size_t push_pos;
+	/** Padding to keep the producers and the consumer apart */
+	uint8_t pad[ROHC_CACHE_LINE_LEN - sizeof(size_t)];
+	/** The position where the next feedback item is popped */
+	size_t pop_pos;
+	/** The slots of the queue */
+	struct rohc_comp_feedback_slot slots[ROHC_COMP_FEEDBACK_QUEUE_SLOTS];
+};
+
+
+void rohc_comp_feedback_queue_init(struct rohc_comp_feedback_queue *const queue)
+	__attribute__((nonnull(1)));
+
+bool rohc_comp_feedback_queue_reserve(struct rohc_comp_feedback_queue *const queue,
+                                      const size_t slots_nr,
+                                      size_t *const pos)
+	__attribute__((warn_unused_result, nonnull(1, 3)));
+
+void rohc_comp_feedback_queue_publish(struct rohc_comp_feedback_queue *const queue,
+                                      const size_t pos,
+                                      const uint8_t *const data,
+                                      const size_t len)
+	__attribute__((nonnull(1, 3)));
+
+bool rohc_comp_feedback_queue_pop(struct rohc_comp_feedback_queue *const queue,
+                                  uint8_t *const data,
+                                  size_t *const len)
+	__attribute__((warn_unused_result, nonnull(1, 2, 3)));
+
+#endif
+
@@ -0,0 +1,728 @@
+/*
+ * Copyright 2016 Didier Barvaux
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/**
+ * @file   rohc_comp_group.c
+ * @brief  Group of ROHC compressors that share one ROHC channel
+ * @author Didier Barvaux <didier@barvaux.org>
+ *
+ * One ROHC compressor shall be used by one thread at a time. A group of
+ * compressors splits the CIDs of one ROHC channel between several
+ * compressors, the shards, so that several threads compress the packets of
+ * the channel at the same time:
+ *  - the packets are dispatched to the shards by flow hash, so that all the
+ *    packets of one flow are compressed by the same shard, hence in the same
+ *    context,
+ *  - every shard owns one sub-range of the CIDs, so that the decompressor at
+ *    the other end of the channel sees one coherent CID namespace,
+ *  - the feedback is dispatched to the shard that owns its CID.
+ *
+ * Every shard has got two single-producer/single-consumer queues: one for
+ * the packets, one for the feedback. The dispatching thread (resp. the
+ * thread that receives the feedback) is the only producer for the packet
+ * (resp. feedback) queues, the thread of the shard is the only consumer of
+ * the queues of the shard. No lock is taken.
+ */
+
+#include "rohc_comp.h"
+#include "rohc_debug.h"
+#include "rohc_seqcount.h"
+#include "net_pkt.h"
+#include "protocols/ip_numbers.h"
+#include "feedback_parse.h"
+#include "rohc_add_cid.h"
+#include "sdvl.h"
+#include "rohc_alloc.h"
+
+#ifndef __KERNEL__
+#  include <string.h>
+#endif
+#include <assert.h>
+
+
+/** The maximum length (in bytes) of one feedback item: the code octet, the
+ *  size octet and up to 255 bytes of feedback data */
+#define ROHC_COMP_GROUP_FEEDBACK_MAX_LEN  (2U + 255U)
+
+
+/**
+ * @brief The indexes of one single-producer/single-consumer queue
+ *
+ * The indexes grow forever, the slot of one index is the index modulo the
+ * length of the queue. The producer and the consumer write their own index
+ * only, the two indexes are kept on different cache lines.
+ */
+struct rohc_comp_group_ring
+{
+	/** The index of the next slot to fill, written by the producer only */
+	size_t head __attribute__((aligned(ROHC_CACHE_LINE_LEN)));
+	/** The index of the next slot to empty, written by the consumer only */
+	size_t tail __attribute__((aligned(ROHC_CACHE_LINE_LEN)));
+	/** The length of the queue minus one, the length is a power of 2 */
+	size_t mask __attribute__((aligned(ROHC_CACHE_LINE_LEN)));
+};
+
+
+/** One feedback item copied in the feedback queue of one shard */
+struct rohc_comp_group_feedback
+{
+	size_t len;                                     /**< The item length */
+	uint8_t data[ROHC_COMP_GROUP_FEEDBACK_MAX_LEN]; /**< The item bytes */
+};
+
+
+/** One shard of a group of compressors */
+struct rohc_comp_group_shard
+{
+	/** The compressor of the shard */
+	struct rohc_comp *comp;
+	/** The first CID of the shard */
+	rohc_cid_t cid_first;
+	/** The last CID of the shard */
+	rohc_cid_t cid_last;
+
+	/** The queue of the packets to compress */
+	struct rohc_comp_group_ring packets;
+	/** The packets to compress */
+	struct rohc_buf *packets_slots;
+
+	/** The queue of the feedback to deliver */
+	struct rohc_comp_group_ring feedbacks;
+	/** The feedback to deliver */
+	struct rohc_comp_group_feedback *feedbacks_slots;
+};
+
+
+/** A group of compressors that share one ROHC channel */
+struct rohc_comp_group
+{
+	/** The type of CID of the channel */
+	rohc_cid_type_t cid_type;
+	/** The MAX_CID of the channel */
+	rohc_cid_t max_cid;
+	/** The seed of the flow hashes that dispatch the packets */
+	rohc_ctxt_key_t key_seed;
+
+	/** The number of shards */
+	size_t shards_nr;
+	/** The shards */
+	struct rohc_comp_group_shard *shards;
+};
+
+
+static bool rohc_comp_group_ring_reserve(const struct rohc_comp_group_ring *const ring,
+                                         size_t *const slot)
+	__attribute__((warn_unused_result, nonnull(1, 2)));
+static void rohc_comp_group_ring_commit(struct rohc_comp_group_ring *const ring)
+	__attribute__((nonnull(1)));
+static bool rohc_comp_group_ring_peek(const struct rohc_comp_group_ring *const ring,
+                                      size_t *const slot)
+	__attribute__((warn_unused_result, nonnull(1, 2)));
+static void rohc_comp_group_ring_release(struct rohc_comp_group_ring *const ring)
+	__attribute__((nonnull(1)));
+
+static size_t rohc_comp_group_get_flow_shard(const struct rohc_comp_group *const group,
+                                             const struct rohc_buf packet)
+	__attribute__((warn_unused_result, nonnull(1)));
+static size_t rohc_comp_group_get_cid_shard(const struct rohc_comp_group *const group,
+                                            const rohc_cid_t cid)
+	__attribute__((warn_unused_result, nonnull(1), pure));
+static bool rohc_comp_group_parse_cid(const struct rohc_comp_group *const group,
+                                      const uint8_t *const data,
+                                      const size_t data_len,
+                                      rohc_cid_t *const cid)
+	__attribute__((warn_unused_result, nonnull(1, 2, 4)));
+
+
+/*
+ * Definitions of public functions
+ */
+
+
+/**
+ * @brief Create a new group of ROHC compressors
+ *
+ * The CIDs of the channel, from 0 to \e max_cid, are split in \e shards_nr
+ * contiguous sub-ranges of the same size (give or take one CID), one for
+ * every compressor of the group. See \ref rohc_comp_set_cid_range.
+ *
+ * The compressors are created with all the compression profiles disabled,
+ * as \ref rohc_comp_new2 does. Use \ref rohc_comp_group_get_shard to
+ * configure them before the first packet is enqueued.
+ *
+ * The random callback may be called by all the shards at the same time, so
+ * it shall be thread-safe.
+ *
+ * @param cid_type   The type of CID of the channel
+ * @param max_cid    The MAX_CID of the channel, see \ref rohc_comp_new2
+ * @param shards_nr  The number of compressors in the group, in
+ *                   [1, max_cid + 1]
+ * @param queue_len  The number of packets (and of feedback items) that every
+ *                   shard may queue, a power of 2
+ * @param rand_cb    The random callback of the compressors, see
+ *                   \ref rohc_comp_new2
+ * @param rand_priv  The private context given to the random callback
+ * @return           The new group of compressors if successful,
+ *                   NULL if parameters are invalid or in case of memory
+ *                   allocation failure
+ *
+ * @ingroup rohc_comp
+ *
+ * @see rohc_comp_group_free
+ */
+struct rohc_comp_group * rohc_comp_group_new(const rohc_cid_type_t cid_type,
+                                             const rohc_cid_t max_cid,
+                                             const size_t shards_nr,
+                                             const size_t queue_len,
+                                             const rohc_comp_random_cb_t rand_cb,
+                                             void *const rand_priv)
+{
+	struct rohc_comp_group *group;
+	size_t cids_per_shard;
+	size_t cids_extra;
+	rohc_cid_t cid_next = 0;
+
+	/* check the parameters that rohc_comp_new2() does not check */
+	if(shards_nr == 0 || shards_nr > (max_cid + 1))
+	{
+		goto error;
+	}
+	if(queue_len == 0 || (queue_len & (queue_len - 1)) != 0)
+	{
+		goto error;
+	}
+
+	group = rohc_malloc(sizeof(struct rohc_comp_group));
+	if(group == NULL)
+	{
+		goto error;
+	}
+	memset(group, 0, sizeof(struct rohc_comp_group));
+	group->cid_type = cid_type;
+	group->max_cid = max_cid;
+	group->key_seed = net_pkt_key_final((uintptr_t) group);
+
+	group->shards = rohc_calloc(shards_nr, sizeof(struct rohc_comp_group_shard));
+	if(group->shards == NULL)
+	{
+		goto free_group;
+	}
+
+	/* the first shards get one more CID if the CIDs cannot be evenly split */
+	cids_per_shard = (max_cid + 1) / shards_nr;
+	cids_extra = (max_cid + 1) % shards_nr;
+	for(group->shards_nr = 0; group->shards_nr < shards_nr; group->shards_nr++)
+	{
+		struct rohc_comp_group_shard *const shard =
+			&group->shards[group->shards_nr];
+
+		shard->cid_first = cid_next;
+		shard->cid_last = cid_next + cids_per_shard - 1;
+		if(group->shards_nr < cids_extra)
+		{
+			shard->cid_last++;
+		}
+		cid_next = shard->cid_last + 1;
+
+		shard->packets.mask = queue_len - 1;
+		shard->feedbacks.mask = queue_len - 1;
+		shard->packets_slots = rohc_calloc(queue_len, sizeof(struct rohc_buf));
+		shard->feedbacks_slots =
+			rohc_calloc(queue_len, sizeof(struct rohc_comp_group_feedback));
+		shard->comp = rohc_comp_new2(cid_type, max_cid, rand_cb, rand_priv);
+		if(shard->packets_slots == NULL ||
+		   shard->feedbacks_slots == NULL ||
+		   shard->comp == NULL ||
+		   !rohc_comp_set_cid_range(shard->comp, shard->cid_first,
+		                            shard->cid_last))
+		{
+			/* count the partially-created shard for the cleanup */
+			group->shards_nr++;
+			goto free_shards;
+		}
+	}
+	assert(cid_next == (max_cid + 1));
+
+	return group;
+
+free_shards:
+	rohc_comp_group_free(group);
+	return NULL;
+free_group:
+	zfree(group);
+error:
+	return NULL;
+}
+
+
+/**
+ * @brief Destroy the given group of ROHC compressors
+ *
+ * No thread shall use the group anymore. The packets that are still queued
+ * are not compressed.
+ *
+ * @param group  The group of compressors to destroy, may be NULL
+ *
+ * @ingroup rohc_comp
+ *
+ * @see rohc_comp_group_new
+ */
+void rohc_comp_group_free(struct rohc_comp_group *const group)
+{
+	size_t i;
+
+	if(group == NULL)
+	{
+		return;
+	}
+
+	for(i = 0; i < group->shards_nr; i++)
+	{
+		rohc_comp_free(group->shards[i].comp);
+		rohc_free(group->shards[i].feedbacks_slots);
+		rohc_free(group->shards[i].packets_slots);
+	}
+	rohc_free(group->shards);
+	rohc_free(group);
+}
+
+
+/**
+ * @brief Get the compressor of one shard of the group
+ *
+ * The compressor may be configured (profiles, callbacks...) before the first
+ * packet is enqueued. Its CID type, MAX_CID and CID range shall not be
+ * changed. Once packets are enqueued, only the thread of the shard may use
+ * the compressor.
+ *
+ * @param group  The group of compressors
+ * @param shard  The index of the shard, in [0, shards_nr - 1]
+ * @return       The compressor of the shard,
+ *               NULL if the group or the shard index is invalid
+ *
+ * @ingroup rohc_comp
+ */
+struct rohc_comp * rohc_comp_group_get_shard(const struct rohc_comp_group *const group,
+                                             const size_t shard)
+{
+	if(group == NULL || shard >= group->shards_nr)
+	{
+		return NULL;
+	}
+
+	return group->shards[shard].comp;
+}
+
+
+/**
+ * @brief Enqueue one packet in the shard that compresses its flow
+ *
+ * The packets of one flow, ie. with the same IP addresses, transport
+ * protocol and ports (or SPI), are always enqueued in the same shard. The
+ * packets that cannot be parsed are enqueued in the first shard.
+ *
+ * The packet data is not copied: it shall remain valid until the packet is
+ * dequeued by \ref rohc_comp_group_dequeue.
+ *
+ * Only one thread at a time may enqueue packets in the group.
+ *
+ * @param group       The group of compressors
+ * @param packet      The uncompressed packet to enqueue
+ * @param[out] shard  The index of the shard the packet is enqueued in, or
+ *                    would have been enqueued in if its queue is full
+ * @return            true if the packet was enqueued,
+ *                    false if the queue of the shard is full or if the
+ *                    parameters are invalid
+ *
+ * @ingroup rohc_comp
+ */
+bool rohc_comp_group_enqueue(struct rohc_comp_group *const group,
+                             const struct rohc_buf packet,
+                             size_t *const shard)
+{
+	struct rohc_comp_group_shard *dest;
+	size_t slot;
+
+	if(group == NULL || shard == NULL || rohc_buf_is_malformed(packet))
+	{
+		goto error;
+	}
+
+	*shard = rohc_comp_group_get_flow_shard(group, packet);
+	dest = &group->shards[*shard];
+
+	if(!rohc_comp_group_ring_reserve(&dest->packets, &slot))
+	{
+		goto error;
+	}
+	dest->packets_slots[slot] = packet;
+	rohc_comp_group_ring_commit(&dest->packets);
+
+	return true;
+
+error:
+	return false;
+}
+
+
+/**
+ * @brief Dequeue the next packet to compress in one shard
+ *
+ * The feedback queued for the shard is delivered to the compressor of the
+ * shard first, so that it is taken into account before the next packet is
+ * compressed. The dequeued packet shall then be compressed with the
+ * compressor of the shard, see \ref rohc_comp_group_get_shard.
+ *
+ * Only the thread of the shard may dequeue packets from the shard.
+ *
+ * @param group        The group of compressors
+ * @param shard        The index of the shard
+ * @param[out] packet  The uncompressed packet to compress
+ * @return             true if one packet was dequeued,
+ *                     false if the queue of the shard is empty or if the
+ *                     parameters are invalid
+ *
+ * @ingroup rohc_comp
+ */
+bool rohc_comp_group_dequeue(struct rohc_comp_group *const group,
+                             const size_t shard,
+                             struct rohc_buf *const packet)
+{
+	struct rohc_comp_group_shard *src;
+	size_t slot;
+
+	if(group == NULL || shard >= group->shards_nr || packet == NULL)
+	{
+		goto error;
+	}
+	src = &group->shards[shard];
+
+	/* deliver all the feedback received so far, a feedback that cannot be
+	 * taken into account is ignored as rohc_comp_deliver_feedback2() does for
+	 * the other feedback items of one packet */
+	while(rohc_comp_group_ring_peek(&src->feedbacks, &slot))
+	{
+		struct rohc_comp_group_feedback *const item = &src->feedbacks_slots[slot];
+		const struct rohc_buf feedback = {
+			.time = { .sec = 0, .nsec = 0 },
+			.data = item->data,
+			.max_len = item->len,
+			.offset = 0,
+			.len = item->len,
+		};
+
+		if(!rohc_comp_deliver_feedback2(src->comp, feedback))
+		{
+			/* the compressor already traced the reason */
+		}
+		rohc_comp_group_ring_release(&src->feedbacks);
+	}
+
+	if(!rohc_comp_group_ring_peek(&src->packets, &slot))
+	{
+		goto error;
+	}
+	*packet = src->packets_slots[slot];
+	rohc_comp_group_ring_release(&src->packets);
+
+	return true;
+
+error:
+	return false;
+}
+
+
+/**
+ * @brief Dispatch feedback to the shards that own the CIDs of its items
+ *
+ * Every feedback item is copied in the feedback queue of the shard that owns
+ * its CID, it is delivered to the compressor of the shard when the thread of
+ * the shard dequeues its next packet.
+ *
+ * Only one thread at a time may deliver feedback to the group.
+ *
+ * @param group     The group of compressors
+ * @param feedback  The feedback data, one or more feedback items
+ * @return          true if all the feedback items were dispatched,
+ *                  false if at least one feedback item is malformed, for an
+ *                  unknown CID or if the queue of its shard is full
+ *
+ * @ingroup rohc_comp
+ *
+ * @see rohc_comp_deliver_feedback2
+ */
+bool rohc_comp_group_deliver_feedback(struct rohc_comp_group *const group,
+                                      const struct rohc_buf feedback)
+{
+	struct rohc_buf remain_data = feedback;
+	size_t nr_failures = 0;
+
+	if(group == NULL || rohc_buf_is_malformed(feedback))
+	{
+		goto error;
+	}
+
+	while(remain_data.len > 0 &&
+	      rohc_packet_is_feedback(rohc_buf_byte(remain_data)))
+	{
+		struct rohc_comp_group_shard *dest;
+		size_t feedback_hdr_len;
+		size_t feedback_data_len;
+		size_t feedback_len;
+		rohc_cid_t cid;
+		size_t slot;
+
+		if(!rohc_feedback_get_size(remain_data, &feedback_hdr_len,
+		                           &feedback_data_len))
+		{
+			goto error;
+		}
+		feedback_len = feedback_hdr_len + feedback_data_len;
+		if(remain_data.len < feedback_len)
+		{
+			goto error;
+		}
+		assert(feedback_len <= ROHC_COMP_GROUP_FEEDBACK_MAX_LEN);
+
+		/* copy the item in the queue of the shard that owns its CID */
+		if(!rohc_comp_group_parse_cid(group,
+		                              rohc_buf_data_at(remain_data, feedback_hdr_len),
+		                              feedback_data_len, &cid))
+		{
+			nr_failures++;
+		}
+		else
+		{
+			dest = &group->shards[rohc_comp_group_get_cid_shard(group, cid)];
+			if(!rohc_comp_group_ring_reserve(&dest->feedbacks, &slot))
+			{
+				nr_failures++;
+			}
+			else
+			{
+				dest->feedbacks_slots[slot].len = feedback_len;
+				memcpy(dest->feedbacks_slots[slot].data, rohc_buf_data(remain_data),
+				       feedback_len);
+				rohc_comp_group_ring_commit(&dest->feedbacks);
+			}
+		}
+
+		rohc_buf_pull(&remain_data, feedback_len);
+	}
+
+	return (nr_failures == 0);
+
+error:
+	return false;
+}
+
+
+/*
+ * Definitions of private functions
+ */
+
+
+/**
+ * @brief Get a free slot of the given queue, called by the producer
+ *
+ * @param ring       The queue
+ * @param[out] slot  The free slot
+ * @return           true if one slot is free, false if the queue is full
+ */
+static bool rohc_comp_group_ring_reserve(const struct rohc_comp_group_ring *const ring,
+                                         size_t *const slot)
+{
+	const size_t head = __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+	const size_t tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+
+	if((head - tail) > ring->mask)
+	{
+		return false;
+	}
+	*slot = head & ring->mask;
+
+	return true;
+}
+
+
+/**
+ * @brief Publish the slot got from \ref rohc_comp_group_ring_reserve to the
+ *        consumer
+ *
+ * @param ring  The queue
+ */
+static void rohc_comp_group_ring_commit(struct rohc_comp_group_ring *const ring)
+{
+	const size_t head = __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+	__atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+}
+
+
+/**
+ * @brief Get the oldest filled slot of the given queue, called by the
+ *        consumer
+ *
+ * @param ring       The queue
+ * @param[out] slot  The oldest filled slot
+ * @return           true if one slot is filled, false if the queue is empty
+ */
+static bool rohc_comp_group_ring_peek(const struct rohc_comp_group_ring *const ring,
+                                      size_t *const slot)
+{
+	const size_t tail = __atomic_load_n(&ring->tail, __ATOMIC_RELAXED);
+	const size_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+
+	if(tail == head)
+	{
+		return false;
+	}
+	*slot = tail & ring->mask;
+
+	return true;
+}
+
+
+/**
+ * @brief Give the slot got from \ref rohc_comp_group_ring_peek back to the
+ *        producer
+ *
+ * @param ring  The queue
+ */
+static void rohc_comp_group_ring_release(struct rohc_comp_group_ring *const ring)
+{
+	const size_t tail = __atomic_load_n(&ring->tail, __ATOMIC_RELAXED);
+	__atomic_store_n(&ring->tail, tail + 1, __ATOMIC_RELEASE);
+}
+
+
+/**
+ * @brief Get the shard that compresses the flow of the given packet
+ *
+ * The flow hash covers the IP headers as the packet key of the compressor
+ * does, and the first 32-bit word of the UDP, UDP-Lite, TCP or ESP header
+ * (ports or SPI) if any.
+ *
+ * @param group   The group of compressors
+ * @param packet  The uncompressed packet
+ * @return        The index of the shard
+ */
+static size_t rohc_comp_group_get_flow_shard(const struct rohc_comp_group *const group,
+                                             const struct rohc_buf packet)
+{
+	struct net_pkt ip_pkt;
+	rohc_ctxt_key_t hash;
+
+	if(!net_pkt_parse(&ip_pkt, packet, group->key_seed, true, NULL, NULL,
+	                  ROHC_TRACE_ERROR, NULL, ROHC_TRACE_COMP))
+	{
+		return 0;
+	}
+	hash = ip_pkt.key;
+
+	if((ip_pkt.transport->proto == ROHC_IPPROTO_UDP ||
+	    ip_pkt.transport->proto == ROHC_IPPROTO_UDPLITE ||
+	    ip_pkt.transport->proto == ROHC_IPPROTO_TCP ||
+	    ip_pkt.transport->proto == ROHC_IPPROTO_ESP) &&
+	   ip_pkt.transport->data != NULL &&
+	   ip_pkt.transport->len >= sizeof(uint32_t))
+	{
+		uint32_t first_word;
+		memcpy(&first_word, ip_pkt.transport->data, sizeof(uint32_t));
+		hash = net_pkt_key_final(net_pkt_key_mix(hash, first_word));
+	}
+
+	return (hash % group->shards_nr);
+}
+
+
+/**
+ * @brief Get the shard that owns the given CID
+ *
+ * @param group  The group of compressors
+ * @param cid    The CID, in [0, MAX_CID]
+ * @return       The index of the shard
+ */
+static size_t rohc_comp_group_get_cid_shard(const struct rohc_comp_group *const group,
+                                            const rohc_cid_t cid)
+{
+	const size_t cids_per_shard = (group->max_cid + 1) / group->shards_nr;
+	const size_t cids_extra = (group->max_cid + 1) % group->shards_nr;
+	const size_t cids_in_larger_shards = cids_extra * (cids_per_shard + 1);
+	size_t shard;
+
+	/* the first shards own one more CID than the others */
+	if(cid < cids_in_larger_shards)
+	{
+		shard = cid / (cids_per_shard + 1);
+	}
+	else
+	{
+		shard = cids_extra + (cid - cids_in_larger_shards) / cids_per_shard;
+	}
+	assert(shard < group->shards_nr);
+	assert(group->shards[shard].cid_first <= cid);
+	assert(cid <= group->shards[shard].cid_last);
+
+	return shard;
+}
+
+
+/**
+ * @brief Parse the CID of one feedback item
+ *
+ * @param group     The group of compressors
+ * @param data      The feedback data, after the feedback header
+ * @param data_len  The length of the feedback data
+ * @param[out] cid  The CID of the feedback item
+ * @return          true if the CID is in [0, MAX_CID],
+ *                  false if the CID is malformed or too large
+ */
+static bool rohc_comp_group_parse_cid(const struct rohc_comp_group *const group,
+                                      const uint8_t *const data,
+                                      const size_t data_len,
+                                      rohc_cid_t *const cid)
+{
+	if(group->cid_type == ROHC_LARGE_CID)
+	{
+		uint32_t large_cid;
+
+		/* SDVL-encoded large CID field */
+		if(sdvl_decode_large_cid(data, data_len, &large_cid) == 0)
+		{
+			goto error;
+		}
+		*cid = large_cid;
+	}
+	else
+	{
+		/* optional Add-CID octet, CID 0 if absent */
+		const uint8_t small_cid = rohc_add_cid_decode(data, data_len);
+		*cid = (small_cid == UINT8_MAX ? 0 : small_cid);
+	}
+
+	if((*cid) > group->max_cid)
+	{
+		goto error;
+	}
+
+	return true;
+
+error:
+	return false;
+}
+
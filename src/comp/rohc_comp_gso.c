@@ -0,0 +1,489 @@
+/*
+ * Copyright 2016 Didier Barvaux
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/**
+ * @file   rohc_comp_gso.c
+ * @brief  Compression of TCP GSO super-packets
+ * @author Didier Barvaux <didier@barvaux.org>
+ *
+ * A TCP GSO super-packet is one IP/TCP header followed by the payload of
+ * many TCP segments. It is segmented and compressed in one pass: the headers
+ * of every segment are derived from the headers of the super-packet as the
+ * segmentation offload of Linux does, then the segment is compressed with
+ * \ref rohc_compress_iov. The payload of the segments is never copied:
+ *  - the headers of one segment are written just before its payload in the
+ *    buffer of the super-packet, over the end of the previous segment, so
+ *    that the segment is contiguous for the compressor,
+ *  - the overwritten bytes are saved before and restored once the segment
+ *    is compressed, so the buffer of the super-packet is unchanged at the
+ *    end, and the payload of every ROHC packet is a slice of it.
+ * The TCP checksum of every segment is computed while its payload is hot in
+ * cache, just before it is compressed.
+ */
+
+#include "rohc_comp_internals.h"
+#include "rohc_traces_internal.h"
+#include "rohc_csum.h"
+#include "rohc_utils.h"
+#include "protocols/ip_numbers.h"
+#include "protocols/ipv4.h"
+#include "protocols/ipv6.h"
+#include "protocols/tcp.h"
+#include "ip.h"
+
+#ifndef __KERNEL__
+#  include <string.h>
+#endif
+#include <assert.h>
+
+
+/** The maximum length (in bytes) of the IP/TCP headers of a GSO packet: one
+ *  IPv4 header with options, then one TCP header with options */
+#define ROHC_GSO_HDRS_MAX_LEN  (60U + 60U)
+
+
+/** The headers of one GSO super-packet, the template of its segments */
+struct rohc_gso_tmpl
+{
+	uint8_t ip_version;   /**< The version of the IP header */
+	size_t ip_hdr_len;    /**< The length (in bytes) of the IP header */
+	size_t tcp_hdr_len;   /**< The length (in bytes) of the TCP header */
+	size_t hdrs_len;      /**< The length (in bytes) of all the headers */
+	size_t payload_len;   /**< The length (in bytes) of the whole payload */
+	uint16_t ip_id;       /**< The IPv4 ID of the first segment */
+	uint32_t seq_num;     /**< The TCP sequence number of the first segment */
+	uint8_t hdrs[ROHC_GSO_HDRS_MAX_LEN]; /**< The headers of the super-packet */
+};
+
+
+static bool rohc_gso_parse(const struct rohc_comp *const comp,
+                           const struct rohc_buf gso_packet,
+                           struct rohc_gso_tmpl *const tmpl)
+	__attribute__((warn_unused_result, nonnull(1, 3)));
+static void rohc_gso_build_hdrs(const struct rohc_gso_tmpl *const tmpl,
+                                uint8_t *const hdrs,
+                                const size_t seg_idx,
+                                const size_t payload_offset,
+                                const size_t seg_len,
+                                const bool is_last)
+	__attribute__((nonnull(1, 2)));
+static uint16_t rohc_gso_tcp_csum(const struct rohc_gso_tmpl *const tmpl,
+                                  const uint8_t *const hdrs,
+                                  const size_t seg_len)
+	__attribute__((warn_unused_result, nonnull(1, 2)));
+
+
+/**
+ * @brief Compress one TCP GSO super-packet into the ROHC packets of its
+ *        segments
+ *
+ * The super-packet is made of one IPv4 or IPv6 header (without extension
+ * headers), one TCP header, and the payload of all the segments. It is
+ * segmented in segments of \e mss bytes of payload, the last one may be
+ * shorter. The headers of every segment are derived from the headers of the
+ * super-packet, as the TCP segmentation offload of Linux does:
+ *  - the IPv4 Total Length or the IPv6 Payload Length is the one of the
+ *    segment,
+ *  - the IPv4 ID is incremented for every segment,
+ *  - the TCP sequence number is advanced by the payload of the previous
+ *    segments,
+ *  - the TCP CWR flag is kept on the first segment only, the TCP PSH and FIN
+ *    flags are kept on the last segment only,
+ *  - the IPv4 and TCP checksums are computed for every segment.
+ *
+ * Every segment is compressed as \ref rohc_compress_iov does: the ROHC header
+ * of segment \e i is written in \e rohc_hdrs[i], and \e payloads[i] is set to
+ * its payload within the memory of \e gso_packet, without any copy. The ROHC
+ * packet of segment \e i is \e rohc_hdrs[i] followed by \e payloads[i]. A
+ * segment compressed with the Uncompressed profile has its IP/TCP headers
+ * appended to its ROHC header, so that its payload is also the one of the
+ * segment.
+ *
+ * The buffer of the super-packet is modified while the segments are
+ * compressed, then restored: it shall be writable, and it shall not be read
+ * by another thread meanwhile. The payloads are valid as long as the
+ * super-packet is.
+ *
+ * @param comp            The ROHC compressor
+ * @param gso_packet      The TCP GSO super-packet to compress
+ * @param mss             The Maximum Segment Size (MSS) of the segments, that
+ *                        is the length (in bytes) of their TCP payload
+ * @param[out] rohc_hdrs  The resulting ROHC headers, one empty buffer for
+ *                        every segment
+ * @param[out] payloads   The payloads of the resulting ROHC packets, within
+ *                        the memory of the super-packet
+ * @param segs_max        The number of buffers in \e rohc_hdrs and
+ *                        \e payloads
+ * @param[out] segs_nr    The number of compressed segments: all of them on
+ *                        success, the ones compressed before the failure
+ *                        otherwise (they shall be transmitted anyway)
+ * @return                true if all the segments were compressed,
+ *                        false if an error occurred
+ *
+ * @ingroup rohc_comp
+ *
+ * @see rohc_compress_iov
+ */
+bool rohc_compress_gso(struct rohc_comp *const comp,
+                       const struct rohc_buf gso_packet,
+                       const size_t mss,
+                       struct rohc_buf *const rohc_hdrs,
+                       struct rohc_buf *const payloads,
+                       const size_t segs_max,
+                       size_t *const segs_nr)
+{
+	struct rohc_gso_tmpl tmpl;
+	uint8_t saved_bytes[ROHC_GSO_HDRS_MAX_LEN];
+	size_t segs_total;
+	size_t payload_offset = 0;
+	size_t i;
+
+	/* check inputs validity */
+	if(comp == NULL)
+	{
+		goto error;
+	}
+	if(rohc_hdrs == NULL || payloads == NULL || segs_nr == NULL)
+	{
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		             "given arrays of buffers or number of segments are NULL");
+		goto error;
+	}
+	*segs_nr = 0;
+	if(mss == 0)
+	{
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		             "given MSS is zero");
+		goto error;
+	}
+	if(rohc_buf_is_malformed(gso_packet) || rohc_buf_is_empty(gso_packet))
+	{
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		             "given GSO packet is malformed or empty");
+		goto error;
+	}
+	if(!rohc_gso_parse(comp, gso_packet, &tmpl))
+	{
+		goto error;
+	}
+
+	/* a GSO packet without payload is one segment */
+	segs_total = (tmpl.payload_len + mss - 1) / mss;
+	if(segs_total == 0)
+	{
+		segs_total = 1;
+	}
+	if(segs_total > segs_max)
+	{
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		             "GSO packet of %zu bytes of payload is %zu segments of "
+		             "%zu bytes, but only %zu buffers are given",
+		             tmpl.payload_len, segs_total, mss, segs_max);
+		goto error;
+	}
+
+	for(i = 0; i < segs_total; i++)
+	{
+		const size_t seg_len = rohc_min(mss, tmpl.payload_len - payload_offset);
+		/* the headers of the segment are written just before its payload */
+		const size_t hdrs_offset = gso_packet.offset + payload_offset;
+		uint8_t *const hdrs = gso_packet.data + hdrs_offset;
+		uint8_t *const seg_payload = hdrs + tmpl.hdrs_len;
+		const struct rohc_buf segment =
+		{
+			.time = gso_packet.time,
+			.data = gso_packet.data,
+			.max_len = gso_packet.max_len,
+			.offset = hdrs_offset,
+			.len = tmpl.hdrs_len + seg_len,
+		};
+		rohc_status_t status;
+
+		memcpy(saved_bytes, hdrs, tmpl.hdrs_len);
+		rohc_gso_build_hdrs(&tmpl, hdrs, i, payload_offset, seg_len,
+		                    (i + 1) == segs_total);
+
+		status = rohc_compress_iov(comp, segment, &rohc_hdrs[i], &payloads[i]);
+		if(status == ROHC_STATUS_OK &&
+		   rohc_buf_data(payloads[i]) < seg_payload)
+		{
+			/* the IP/TCP headers belong to the ROHC packet (Uncompressed
+			 * profile), they will be overwritten by the next segment */
+			const size_t hdrs_part_len = seg_payload - rohc_buf_data(payloads[i]);
+
+			if((rohc_buf_avail_len(rohc_hdrs[i]) - rohc_hdrs[i].len) <
+			   hdrs_part_len)
+			{
+				rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+				             "output buffer of segment #%zu is too small for the "
+				             "ROHC header and the %zu bytes of IP/TCP headers",
+				             i + 1, hdrs_part_len);
+				status = ROHC_STATUS_OUTPUT_TOO_SMALL;
+			}
+			else
+			{
+				rohc_buf_append(&rohc_hdrs[i], rohc_buf_data(payloads[i]),
+				                hdrs_part_len);
+				rohc_buf_pull(&payloads[i], hdrs_part_len);
+			}
+		}
+
+		/* restore the end of the previous segment, or the original headers */
+		memcpy(hdrs, saved_bytes, tmpl.hdrs_len);
+
+		if(status != ROHC_STATUS_OK)
+		{
+			rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+			             "failed to compress segment #%zu of %zu of GSO packet",
+			             i + 1, segs_total);
+			goto error;
+		}
+		(*segs_nr)++;
+		payload_offset += seg_len;
+	}
+
+	rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+	           "GSO packet of %zu bytes compressed into %zu segments",
+	           gso_packet.len, segs_total);
+
+	return true;
+
+error:
+	return false;
+}
+
+
+/**
+ * @brief Parse the headers of one GSO super-packet
+ *
+ * @param comp        The ROHC compressor
+ * @param gso_packet  The TCP GSO super-packet
+ * @param[out] tmpl   The headers of the super-packet
+ * @return            true if the super-packet may be segmented,
+ *                    false otherwise
+ */
+static bool rohc_gso_parse(const struct rohc_comp *const comp,
+                           const struct rohc_buf gso_packet,
+                           struct rohc_gso_tmpl *const tmpl)
+{
+	const uint8_t *const data = rohc_buf_data(gso_packet);
+	const struct tcphdr *tcp;
+	uint8_t protocol;
+
+	tmpl->ip_version = (data[0] >> 4) & 0x0f;
+	if(tmpl->ip_version == IPV4)
+	{
+		const struct ipv4_hdr *const ipv4 = (const struct ipv4_hdr *) data;
+
+		if(gso_packet.len < sizeof(struct ipv4_hdr) ||
+		   ipv4->ihl < 5 || gso_packet.len < (ipv4->ihl * sizeof(uint32_t)))
+		{
+			goto malformed;
+		}
+		if(rohc_ntoh16(ipv4->tot_len) != gso_packet.len)
+		{
+			rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+			             "IPv4 Total Length of GSO packet is %u while it shall "
+			             "be %zu", rohc_ntoh16(ipv4->tot_len), gso_packet.len);
+			goto error;
+		}
+		if(ipv4_is_fragment(ipv4))
+		{
+			rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+			             "GSO packet is an IPv4 fragment");
+			goto error;
+		}
+		tmpl->ip_hdr_len = ipv4->ihl * sizeof(uint32_t);
+		tmpl->ip_id = rohc_ntoh16(ipv4->id);
+		protocol = ipv4->protocol;
+	}
+	else if(tmpl->ip_version == IPV6)
+	{
+		const struct ipv6_hdr *const ipv6 = (const struct ipv6_hdr *) data;
+
+		if(gso_packet.len < sizeof(struct ipv6_hdr))
+		{
+			goto malformed;
+		}
+		if((rohc_ntoh16(ipv6->plen) + sizeof(struct ipv6_hdr)) != gso_packet.len)
+		{
+			rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+			             "IPv6 Payload Length of GSO packet is %u while it shall "
+			             "be %zu", rohc_ntoh16(ipv6->plen),
+			             gso_packet.len - sizeof(struct ipv6_hdr));
+			goto error;
+		}
+		tmpl->ip_hdr_len = sizeof(struct ipv6_hdr);
+		tmpl->ip_id = 0;
+		protocol = ipv6->nh;
+	}
+	else
+	{
+		goto malformed;
+	}
+	if(protocol != ROHC_IPPROTO_TCP)
+	{
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		             "GSO packet is not TCP (protocol %u, IPv6 extension "
+		             "headers are not supported)", protocol);
+		goto error;
+	}
+
+	if((gso_packet.len - tmpl->ip_hdr_len) < sizeof(struct tcphdr))
+	{
+		goto malformed;
+	}
+	tcp = (const struct tcphdr *) (data + tmpl->ip_hdr_len);
+	tmpl->tcp_hdr_len = tcp->data_offset * sizeof(uint32_t);
+	if(tmpl->tcp_hdr_len < sizeof(struct tcphdr) ||
+	   (gso_packet.len - tmpl->ip_hdr_len) < tmpl->tcp_hdr_len)
+	{
+		goto malformed;
+	}
+	/* only the data segments of an established connection are segmented */
+	if((tcp->rsf_flags & 0x06) != 0)
+	{
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		             "GSO packet has the TCP SYN or RST flag set");
+		goto error;
+	}
+	tmpl->seq_num = rohc_ntoh32(tcp->seq_num);
+
+	tmpl->hdrs_len = tmpl->ip_hdr_len + tmpl->tcp_hdr_len;
+	assert(tmpl->hdrs_len <= ROHC_GSO_HDRS_MAX_LEN);
+	tmpl->payload_len = gso_packet.len - tmpl->hdrs_len;
+	memcpy(tmpl->hdrs, data, tmpl->hdrs_len);
+
+	return true;
+
+malformed:
+	rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+	             "GSO packet of %zu bytes is malformed", gso_packet.len);
+error:
+	return false;
+}
+
+
+/**
+ * @brief Build the IP/TCP headers of one segment from the template
+ *
+ * The payload of the segment shall follow the headers in memory.
+ *
+ * @param tmpl            The headers of the super-packet
+ * @param hdrs            The memory for the headers of the segment
+ * @param seg_idx         The index of the segment in the super-packet
+ * @param payload_offset  The offset (in bytes) of the payload of the segment
+ *                        in the payload of the super-packet
+ * @param seg_len         The length (in bytes) of the payload of the segment
+ * @param is_last         Whether the segment is the last one of the
+ *                        super-packet
+ */
+static void rohc_gso_build_hdrs(const struct rohc_gso_tmpl *const tmpl,
+                                uint8_t *const hdrs,
+                                const size_t seg_idx,
+                                const size_t payload_offset,
+                                const size_t seg_len,
+                                const bool is_last)
+{
+	struct tcphdr *const tcp = (struct tcphdr *) (hdrs + tmpl->ip_hdr_len);
+
+	memcpy(hdrs, tmpl->hdrs, tmpl->hdrs_len);
+
+	if(tmpl->ip_version == IPV4)
+	{
+		struct ipv4_hdr *const ipv4 = (struct ipv4_hdr *) hdrs;
+
+		ipv4->tot_len = rohc_hton16((uint16_t) (tmpl->hdrs_len + seg_len));
+		ipv4->id = rohc_hton16((uint16_t) (tmpl->ip_id + seg_idx));
+		ipv4->check = 0;
+		ipv4->check = ip_fast_csum(hdrs, ipv4->ihl);
+	}
+	else
+	{
+		struct ipv6_hdr *const ipv6 = (struct ipv6_hdr *) hdrs;
+
+		ipv6->plen = rohc_hton16((uint16_t) (tmpl->tcp_hdr_len + seg_len));
+	}
+
+	tcp->seq_num = rohc_hton32(tmpl->seq_num + ((uint32_t) payload_offset));
+	if(seg_idx > 0)
+	{
+		tcp->ecn_flags &= 0x01; /* CWR */
+	}
+	if(!is_last)
+	{
+		tcp->psh_flag = 0;
+		tcp->rsf_flags &= 0x06; /* FIN */
+	}
+	tcp->checksum = 0;
+	tcp->checksum = rohc_gso_tcp_csum(tmpl, hdrs, seg_len);
+}
+
+
+/**
+ * @brief Compute the TCP checksum of one segment
+ *
+ * @param tmpl     The headers of the super-packet
+ * @param hdrs     The IP/TCP headers of the segment, with a zero TCP
+ *                 checksum, followed by the payload of the segment
+ * @param seg_len  The length (in bytes) of the payload of the segment
+ * @return         The TCP checksum of the segment
+ */
+static uint16_t rohc_gso_tcp_csum(const struct rohc_gso_tmpl *const tmpl,
+                                  const uint8_t *const hdrs,
+                                  const size_t seg_len)
+{
+	const size_t tcp_len = tmpl->tcp_hdr_len + seg_len;
+	uint8_t pseudo_hdr[2 * sizeof(struct ipv6_addr) + 2 * sizeof(uint32_t)];
+	size_t pseudo_hdr_len;
+	uint32_t sum;
+
+	if(tmpl->ip_version == IPV4)
+	{
+		const struct ipv4_hdr *const ipv4 = (const struct ipv4_hdr *) hdrs;
+
+		memcpy(pseudo_hdr, &ipv4->saddr, 2 * sizeof(uint32_t));
+		pseudo_hdr[8] = 0;
+		pseudo_hdr[9] = ROHC_IPPROTO_TCP;
+		pseudo_hdr[10] = (tcp_len >> 8) & 0xff;
+		pseudo_hdr[11] = tcp_len & 0xff;
+		pseudo_hdr_len = 12;
+	}
+	else
+	{
+		const struct ipv6_hdr *const ipv6 = (const struct ipv6_hdr *) hdrs;
+
+		memcpy(pseudo_hdr, &ipv6->saddr, 2 * sizeof(struct ipv6_addr));
+		pseudo_hdr[32] = (tcp_len >> 24) & 0xff;
+		pseudo_hdr[33] = (tcp_len >> 16) & 0xff;
+		pseudo_hdr[34] = (tcp_len >> 8) & 0xff;
+		pseudo_hdr[35] = tcp_len & 0xff;
+		pseudo_hdr[36] = 0;
+		pseudo_hdr[37] = 0;
+		pseudo_hdr[38] = 0;
+		pseudo_hdr[39] = ROHC_IPPROTO_TCP;
+		pseudo_hdr_len = 40;
+	}
+
+	/* the pseudo-header is made of 32-bit words, so its sum and the sum of
+	 * the TCP segment add up to the sum of the whole */
+	sum = rohc_csum_sum(pseudo_hdr, pseudo_hdr_len);
+	sum += rohc_csum_sum(hdrs + tmpl->ip_hdr_len, tcp_len);
+
+	return (uint16_t) ~rohc_csum_fold(sum);
+}
@@ -32,8 +32,18 @@
 #include "rohc_packets.h"
 #include "rohc_comp.h"
 #include "schemes/comp_wlsb.h"
+#include "schemes/cid.h"
 #include "net_pkt.h"
+#include "rohc_ctxt_pool.h"
+#include "rohc_pkt_log.h"
+#include "rohc_seqcount.h"
+#include "rohc_timings_internal.h"
+#include "rohc_profiles_config.h"
+#include "rohc_comp_wheel.h"
+#include "rohc_comp_feedback_queue.h"
 #include "feedback.h"
+#include "crc.h"
+#include "rohc_bitmap.h"
 
 #ifdef __KERNEL__
 #  include <linux/types.h>
@@ -47,7 +57,7 @@
  */
 
 /** The number of ROHC profiles ready to be used */
-#define C_NUM_PROFILES 7U
+#define C_NUM_PROFILES ROHC_PROFILES_BUILT_NR
 
 /** The default maximal number of packets sent in > IR states (= FO and SO
  *  states) before changing back the state to IR (periodic refreshes) */
@@ -77,6 +87,23 @@
  */
 #define ROHC_LIST_DEFAULT_L  5U
 
+/** The number of entries in the cache of profile classifications
+ *  (must be a power of 2) */
+#define ROHC_COMP_CLASSIF_CACHE_SIZE  256U
+
+/** The share of the CIDs for the protected segment of the segmented LRU
+ *  recycling policy (in percent) */
+#define ROHC_COMP_SLRU_PROTECTED_PERCENT  80U
+
+/** The number of consecutive CIDs in one chunk of compression contexts */
+#define ROHC_COMP_CTXTS_CHUNK_LEN  64U
+
+/** The number of UDP ports that may be dedicated to RTP streams */
+#define ROHC_COMP_RTP_PORTS_NR  65536U
+
+/** The number of RTP Payload Types */
+#define ROHC_COMP_RTP_PTS_NR  128U
+
 
 /** Print a warning trace for the given compression context */
 #define rohc_comp_warn(context, format, ...) \
@@ -93,7 +120,8 @@
 /** Dump a buffer for the given compression context */
 #define rohc_comp_dump_buf(context, descr, buf, buf_len) \
 	do { \
-		if(((context)->compressor->features & ROHC_COMP_FEATURE_DUMP_PACKETS) != 0) { \
+		if(rohc_trace_is_enabled((context)->compressor, ROHC_TRACE_DEBUG) && \
+		   ((context)->compressor->features & ROHC_COMP_FEATURE_DUMP_PACKETS) != 0) { \
 			rohc_dump_buf((context)->compressor->trace_callback, \
 			              (context)->compressor->trace_callback_priv, \
 			              ROHC_TRACE_COMP, ROHC_TRACE_DEBUG, \
@@ -108,6 +136,213 @@
  */
 
 struct rohc_comp_ctxt;
+struct rohc_comp_ctxts_chunk;
+struct rohc_comp_profile;
+
+
+/**
+ * @brief One group of contexts used with the same frequency
+ *
+ * The groups are used by the \ref ROHC_COMP_RECYCLE_LFU policy only. Every
+ * context in use belongs to one group. The contexts of one group are stored
+ * next to each other in the list of contexts ordered for recycling.
+ */
+struct rohc_comp_ctxt_freq
+{
+	/** The number of packets compressed by the contexts of the group */
+	size_t uses_nr;
+	/** The context of the group the closest to the head of the list of
+	 *  contexts ordered for recycling, ie. the most recently used one */
+	struct rohc_comp_ctxt *head;
+	/** The next unused group */
+	struct rohc_comp_ctxt_freq *next_unused;
+};
+
+
+/** The CID value that marks an empty bucket in the index of contexts */
+#define ROHC_COMP_CTXT_INDEX_EMPTY  0xffffffffU
+
+/** The number of contexts in the cache of the most recently used contexts,
+ *  so that the cache fits in one cache line */
+#define ROHC_COMP_CTXTS_MRU_NR  4U
+
+
+/**
+ * @brief One bucket of the index of compression contexts
+ *
+ * The index is an open-addressing hash table with linear probing. It maps
+ * the hash of the flow tuple of a packet to the CIDs of the contexts that
+ * may compress that packet.
+ */
+struct rohc_comp_ctxt_bucket
+{
+	/** The hash of the flow tuple of the indexed context */
+	rohc_ctxt_key_t hash;
+	/** The CID of the indexed context, \ref ROHC_COMP_CTXT_INDEX_EMPTY if
+	 *  the bucket is empty */
+	uint32_t cid;
+	/** The ID of the profile of the indexed context, so that the contexts
+	 *  of other profiles are skipped without being read */
+	uint16_t profile_id;
+};
+
+
+/** Whether the durations of the compression phases shall be measured */
+#define rohc_comp_timings_enabled(comp) \
+	(ROHC_TIMINGS_BUILT && ((comp)->features & ROHC_COMP_FEATURE_TIMINGS) != 0)
+
+/** Read the clock if the durations of the compression phases are measured */
+#define rohc_comp_ticks(comp) \
+	(rohc_comp_timings_enabled(comp) ? rohc_ticks_now() : 0)
+
+
+/**
+ * @brief The statistics of one compression context
+ *
+ * The statistics are not needed to compress packets, so they are stored
+ * apart from the contexts to keep the contexts dense. The statistics of one
+ * context fill their own cache lines and are protected by a sequence counter,
+ * so that they may be read by \ref rohc_comp_get_ctxts_stats while packets
+ * are compressed.
+ */
+struct rohc_comp_ctxt_stats
+{
+	/** The sequence counter, odd while the statistics are updated */
+	rohc_seqcount_t seq;
+
+	/** Whether the context is in use or not */
+	bool used;
+	/** The ID of the profile of the context */
+	rohc_profile_t profile_id;
+	/** The operation mode of the context */
+	rohc_mode_t mode;
+	/** The operation state of the context */
+	rohc_comp_state_t state;
+
+	/* The type of ROHC packet created for the last compressed packet */
+	rohc_packet_t packet_type;
+
+	/** The number of packets compressed with the context */
+	uint64_t packets_nr;
+	/** The cumulative size of the uncompressed packets */
+	uint64_t total_uncompressed_size;
+	/** The cumulative size of the compressed packets */
+	uint64_t total_compressed_size;
+	/** The cumulative size of the uncompressed headers */
+	uint64_t header_uncompressed_size;
+	/** The cumulative size of the compressed headers */
+	uint64_t header_compressed_size;
+
+	/** The total size of the last uncompressed packet */
+	int total_last_uncompressed_size;
+	/** The total size of the last compressed packet */
+	int total_last_compressed_size;
+	/** The header size of the last uncompressed packet */
+	int header_last_uncompressed_size;
+	/** The header size of the last compressed packet */
+	int header_last_compressed_size;
+} __attribute__((aligned(ROHC_CACHE_LINE_LEN)));
+
+
+/** The maximum length of the uncompressed headers saved for the snapshot of
+ *  one compression context */
+#define ROHC_COMP_SNAPSHOT_HDRS_MAX  256U
+
+
+/**
+ * @brief The headers of the last packet compressed by one context
+ *
+ * The headers are saved only if the \ref ROHC_COMP_FEATURE_SNAPSHOTS feature
+ * is enabled: they are needed to rebuild the context from its snapshot, see
+ * \ref rohc_comp_export_contexts.
+ */
+struct rohc_comp_ctxt_snapshot
+{
+	/** The length of the last uncompressed packet */
+	uint16_t pkt_len;
+	/** The length of the saved headers, 0 if the context cannot be saved */
+	uint16_t hdrs_len;
+	/** The uncompressed headers of the last packet */
+	uint8_t hdrs[ROHC_COMP_SNAPSHOT_HDRS_MAX];
+};
+
+
+/**
+ * @brief One entry of the cache of profile classifications
+ *
+ * The cache remembers which profile was selected for the last packets of
+ * one flow, so that the profiles before that one are not tried again for
+ * every packet of the flow.
+ */
+struct rohc_comp_classif
+{
+	/** The hash of the IP headers and of the first 32-bit word of the
+	 *  transport header of the packets of the flow */
+	rohc_ctxt_key_t hash;
+	/** The profile selected for the flow, NULL if the entry is unused */
+	const struct rohc_comp_profile *profile;
+};
+
+
+/**
+ * @brief A credit of bytes refilled at a constant rate
+ *
+ * The credit never goes over zero, so that a quiet period is not followed
+ * by a burst: one more expense is allowed once the previous ones are paid
+ * for.
+ */
+struct rohc_comp_credit
+{
+	/** The number of bytes refilled per second, 0 if not limited */
+	size_t bytes_rate;
+	/** The time of the last refill (in milliseconds) */
+	uint64_t last_refill;
+	/** The number of bytes that may still be spent, negative while the
+	 *  last expenses are not paid for */
+	int64_t bytes;
+};
+
+
+/**
+ * @brief The paced re-initialization of the compression contexts
+ *
+ * @see rohc_comp_force_contexts_reinit_paced
+ */
+struct rohc_comp_reinit
+{
+	/** The number of contexts still waiting for their re-initialization */
+	size_t pending_nr;
+	/** The number of contexts waiting when the re-initialization started */
+	size_t total_nr;
+	/** The maximal duration of the re-initialization (in milliseconds),
+	 *  0 if not limited in time */
+	uint64_t duration;
+	/** Whether the arrival time of the first packet was recorded */
+	bool is_started;
+	/** The arrival time of the first packet (in milliseconds) */
+	uint64_t start;
+	/** The credit of bytes for the ROHC headers of the re-initialized
+	 *  contexts */
+	struct rohc_comp_credit credit;
+};
+
+
+/** The max number of feedback items parsed at once by
+ *  \ref rohc_comp_deliver_feedback_burst */
+#define ROHC_COMP_FEEDBACK_BURST_MAX  64U
+
+
+/** One feedback item parsed by \ref rohc_comp_deliver_feedback_burst */
+struct rohc_comp_feedback_item
+{
+	const uint8_t *data;  /**< The feedback data, CID included */
+	size_t len;           /**< The length of the feedback data */
+	rohc_cid_t cid;       /**< The CID of the feedback */
+	size_t cid_len;       /**< The length of the CID in the feedback data */
+	bool is_ack;          /**< Whether the feedback is a positive ACK */
+	bool is_fb2;          /**< Whether the feedback is a FEEDBACK-2 */
+	bool skip;            /**< Whether the feedback shall not be delivered */
+};
 
 
 /*
@@ -126,23 +361,104 @@ struct rohc_comp
 	/** Enabled/disabled features for the compressor */
 	rohc_comp_features_t features;
 
-	/** The array of compression contexts that use the compressor */
-	struct rohc_comp_ctxt *contexts;
+	/** The chunks of compression contexts that use the compressor, one per
+	 *  \ref ROHC_COMP_CTXTS_CHUNK_LEN CIDs, NULL while no context of the
+	 *  chunk was ever needed */
+	struct rohc_comp_ctxts_chunk **ctxts_chunks;
+	/** The number of chunks of compression contexts allocated */
+	size_t ctxts_chunks_nr;
+	/** The bitmap of the CIDs in use, to walk the contexts in use only */
+	uint64_t *ctxts_used;
+	/** The headers saved for the snapshots of the compression contexts (one
+	 *  per context), NULL if the \ref ROHC_COMP_FEATURE_SNAPSHOTS feature is
+	 *  disabled */
+	struct rohc_comp_ctxt_snapshot *ctxts_snapshots;
+	/** The bitmap of the CIDs modified since the last export of the contexts
+	 *  (one bit per context), NULL if the \ref ROHC_COMP_FEATURE_SNAPSHOTS
+	 *  feature is disabled */
+	uint8_t *ctxts_dirty;
 	/** The number of compression contexts in use in the array */
 	size_t num_contexts_used;
+	/** The index of the compression contexts in use, hashed on flow tuples */
+	struct rohc_comp_ctxt_bucket *ctxts_index;
+	/** The mask to apply on a flow hash to get a bucket of the index
+	 *  (the number of buckets minus one, the number of buckets being a
+	 *  power of 2) */
+	size_t ctxts_index_mask;
+	/** The most recently used contexts, most recent first, looked up before
+	 *  the index of contexts so that a few interleaved flows are found
+	 *  without probing the index; the unused entries have the CID
+	 *  \ref ROHC_COMP_CTXT_INDEX_EMPTY */
+	struct rohc_comp_ctxt_bucket ctxts_mru[ROHC_COMP_CTXTS_MRU_NR];
+
+	/** The seed of the hash keys of packets, so that remote peers cannot
+	 *  easily craft flows that get the same key */
+	rohc_ctxt_key_t key_seed;
+
+	/** The policy used to recycle contexts when all CIDs are in use */
+	rohc_comp_recycle_t recycle_policy;
+	/** The first unused context, the destroyed contexts are chained together
+	 *  until they are used again */
+	struct rohc_comp_ctxt *ctxts_unused;
+	/** The next CID of the range to check for an unused context once no
+	 *  destroyed context is chained */
+	rohc_cid_t ctxts_unused_next;
+	/** The first CID the compressor assigns to new contexts */
+	rohc_cid_t cid_first;
+	/** The last CID the compressor assigns to new contexts */
+	rohc_cid_t cid_last;
+	/** The context in use that shall be kept the longest */
+	struct rohc_comp_ctxt *ctxts_recycle_head;
+	/** The context in use that shall be recycled first */
+	struct rohc_comp_ctxt *ctxts_recycle_tail;
+	/** The first unused frequency group for the LFU recycling policy, every
+	 *  chunk of contexts brings one group per context */
+	struct rohc_comp_ctxt_freq *ctxts_freqs_unused;
+	/** The first context of the unprotected segment of the list of contexts
+	 *  ordered for recycling (segmented LRU recycling policy only) */
+	struct rohc_comp_ctxt *ctxts_slru_unprotected;
+	/** The number of contexts in the protected segment of the list of
+	 *  contexts ordered for recycling (segmented LRU recycling policy only) */
+	size_t slru_protected_nr;
+	/** The number of packets that found their context in use */
+	uint64_t ctxts_hits_nr;
+	/** The number of packets that required a new context */
+	uint64_t ctxts_misses_nr;
+	/** The number of contexts recycled by the recycling policy */
+	uint64_t ctxts_recycled_nr;
+	/** The number of packets that found their context in the cache of the
+	 *  most recently used contexts */
+	uint64_t ctxts_mru_hits_nr;
+	/** The number of packets a new context shall compress before it is
+	 *  admitted in the list of contexts ordered for recycling, 0 if the
+	 *  admission control is disabled */
+	size_t admission_pkts_nr;
+	/** The number of contexts on probation that may replace admitted
+	 *  contexts when all CIDs are in use */
+	size_t probation_max;
+	/** The number of contexts on probation */
+	size_t probation_nr;
+	/** The context on probation that was used the most recently */
+	struct rohc_comp_ctxt *ctxts_probation_head;
+	/** The context on probation that was used the least recently */
+	struct rohc_comp_ctxt *ctxts_probation_tail;
 
 	/** Which profiles are enabled and with one are not? */
 	bool enabled_profiles[C_NUM_PROFILES];
-
-
-	/* CRC-related variables: */
-
-	/** The table to enable fast CRC-3 computation */
-	uint8_t crc_table_3[256];
-	/** The table to enable fast CRC-7 computation */
-	uint8_t crc_table_7[256];
-	/** The table to enable fast CRC-8 computation */
-	uint8_t crc_table_8[256];
+	/** The cache of profile classifications, indexed by flow hash */
+	struct rohc_comp_classif classif_cache[ROHC_COMP_CLASSIF_CACHE_SIZE];
+	/** The memory blocks of the destroyed contexts, kept for the new ones */
+	struct rohc_ctxt_pool ctxt_pool;
+	/** The pool the memory blocks of the contexts are got from and given
+	 *  back to: \e ctxt_pool, or the pool of the worker thread that runs the
+	 *  channel of the compressor, see \ref rohc_channels_next */
+	struct rohc_ctxt_pool *cur_ctxt_pool;
+	/** The slabs the chunks of contexts are carved from, unused without huge
+	 *  pages nor NUMA node, see \ref rohc_comp_set_huge_pages */
+	struct rohc_ctxt_pool ctxts_chunks_pool;
+	/** The NUMA node the memory of the compressor is bound to,
+	 *  ROHC_NUMA_NODE_ANY if none, see \ref rohc_comp_new3 */
+	int numa_node;
 
 
 	/* segment-related variables */
@@ -150,12 +466,16 @@ struct rohc_comp
 /** The maximal value for MRRU */
 #define ROHC_MAX_MRRU 65535
 	/** The remaining bytes of the Reconstructed Reception Unit (RRU) waiting
-	 *  to be split into segments */
-	uint8_t rru[ROHC_MAX_MRRU];
+	 *  to be split into segments, MRRU bytes allocated only when segmentation
+	 *  is enabled */
+	uint8_t *rru;
 	/** The offset of the remaining bytes in the RRU buffer */
 	size_t rru_off;
 	/** The number of the remaining bytes in the RRU buffer */
 	size_t rru_len;
+	/** The FCS-32 CRC of the last RRU described by \ref rohc_comp_segment_iov,
+	 *  referenced by the last segments */
+	uint8_t rru_iov_crc[CRC_FCS32_LEN];
 
 
 	/* variables related to RTP detection */
@@ -164,16 +484,49 @@ struct rohc_comp
 	rohc_rtp_detection_callback_t rtp_callback;
 	/** Pointer to an external memory area provided/used by the callback user */
 	void *rtp_private;
+	/** The bitmap of the UDP ports dedicated to RTP streams, NULL if none */
+	uint64_t *rtp_ports;
+	/** The number of UDP ports dedicated to RTP streams */
+	size_t rtp_ports_nr;
+	/** The bitmap of the RTP Payload Types accepted on the RTP ports */
+	uint64_t rtp_pts[ROHC_BITMAP_WORDS_NR(ROHC_COMP_RTP_PTS_NR)];
+
+
+	/* variables related to the events of the lifecycle of contexts */
+
+	/** The callback function called for the events of the contexts, NULL if
+	 *  none */
+	rohc_comp_event_callback_t event_cb;
+	/** The private context of the callback for the events of the contexts */
+	void *event_cb_priv;
+
+	/** The log of the last compressed packets, see rohc_comp_set_pkt_log() */
+	struct rohc_pkt_log pkt_log;
 
 
 	/* some statistics about the compression process: */
 
 	/** The number of sent packets */
-	int num_packets;
+	uint64_t num_packets;
 	/** The size of all the received uncompressed IP packets */
-	int total_uncompressed_size;
+	uint64_t total_uncompressed_size;
 	/** The size of all the sent compressed ROHC packets */
-	int total_compressed_size;
+	uint64_t total_compressed_size;
+
+#ifdef ROHC_TIMINGS
+	/** The histograms of the durations of the compression phases */
+	rohc_timings_histo_t timings[ROHC_PACKET_MAX][ROHC_COMP_PHASE_MAX];
+	/** The histograms of the durations of the compression phases, per
+	 *  profile (in the order of the profiles of the library) */
+	rohc_timings_histo_t
+		timings_profiles[C_NUM_PROFILES][ROHC_COMP_PHASE_MAX];
+	/** The durations of the parsing and lookup phases of the current packet */
+	rohc_ticks_t timings_pending[ROHC_COMP_PHASE_LOOKUP + 1];
+	/** Whether \e timings_pending shall be recorded with the current packet */
+	bool timings_are_pending;
+	/** The duration of the CRC computations of the current packet */
+	rohc_ticks_t timings_crc;
+#endif
 
 	/** The last context used by the compressor */
 	struct rohc_comp_ctxt *last_context;
@@ -191,12 +544,40 @@ struct rohc_comp
 
 	/** The width of the W-LSB sliding window */
 	size_t wlsb_window_width;
+	/** The reordering tolerated by the ROHCv2 profiles */
+	rohc_reordering_offset_t reorder_ratio;
 	/** The maximal number of packets sent in > IR states (= FO and SO
 	 *  states) before changing back the state to IR (periodic refreshes) */
 	size_t periodic_refreshes_ir_timeout;
 	/** The maximal number of packets sent in > FO states (= SO state)
 	 *  before changing back the state to FO (periodic refreshes) */
 	size_t periodic_refreshes_fo_timeout;
+	/** The maximal duration (in milliseconds) spent in > IR states (= FO and
+	 *  SO states) before changing back the state to IR (periodic refreshes),
+	 *  0 if time-based refreshes are disabled */
+	uint64_t periodic_refreshes_ir_timeout_time;
+	/** The maximal duration (in milliseconds) spent in > FO states (= SO
+	 *  state) before changing back the state to FO (periodic refreshes),
+	 *  0 if time-based refreshes are disabled */
+	uint64_t periodic_refreshes_fo_timeout_time;
+	/** The timer wheel for the time-based periodic refreshes of contexts */
+	struct rohc_comp_wheel refresh_wheel;
+	/** The credit of bytes for the ROHC headers of the periodic refreshes */
+	struct rohc_comp_credit refreshes_credit;
+	/** The number of packets of the periodic refresh that started with the
+	 *  packet being compressed, 0 if none */
+	size_t refresh_packets_nr;
+	/** The paced re-initialization of the contexts */
+	struct rohc_comp_reinit reinit;
+	/** The feedback enqueued by other threads, delivered at the beginning
+	 *  of the next compression */
+	struct rohc_comp_feedback_queue feedback_queue;
+	/** The batch of feedback items parsed by
+	 *  \ref rohc_comp_deliver_feedback_burst, kept off the stack */
+	struct rohc_comp_feedback_item feedback_burst[ROHC_COMP_FEEDBACK_BURST_MAX];
+	/** The packets parsed by the bursts of compression: the current one and
+	 *  the next one, kept off the stack */
+	struct net_pkt burst_pkts[2];
 	/** Maximum Reconstructed Reception Unit */
 	size_t mrru;
 	/** The connection type (currently not used) */
@@ -208,6 +589,16 @@ struct rohc_comp
 	rohc_trace_callback2_t trace_callback;
 	/** The private context of the callback function used to manage traces */
 	void *trace_callback_priv;
+	/** The minimum level of the traces given to the callback function */
+	rohc_trace_level_t trace_level;
+	/** The sampling of the traces */
+	struct rohc_trace_sampling trace_sampling;
+	/** The minimum level of the traces for the current packet, chosen by
+	 *  the trace sampling */
+	rohc_trace_level_t trace_sampled_level;
+	/** The minimum level of the traces for the current packet, points to
+	 *  \e trace_sampled_level */
+	const rohc_trace_level_t *trace_pkt_level;
 };
 
 
@@ -297,6 +688,28 @@ struct rohc_comp_profile
 	                 const uint8_t *const feedback_data,
 	                 const size_t feedback_data_len)
 		__attribute__((warn_unused_result, nonnull(1, 3, 5)));
+
+	/**
+	 * @brief The handler used to get the Master Sequence Number (MSN) of the
+	 *        last compressed packet, NULL if the profile has no MSN
+	 *
+	 * The MSN is saved in the snapshots of the contexts, see
+	 * \ref rohc_comp_export_contexts
+	 */
+	uint32_t (*get_msn)(const struct rohc_comp_ctxt *const context)
+		__attribute__((warn_unused_result, nonnull(1)));
+
+	/**
+	 * @brief The handler used to make the next compressed packet get the
+	 *        given Master Sequence Number (MSN), NULL if the profile has
+	 *        no MSN
+	 *
+	 * The MSN is restored from the snapshots of the contexts, see
+	 * \ref rohc_comp_import_contexts
+	 */
+	void (*set_next_msn)(struct rohc_comp_ctxt *const context,
+	                     const uint32_t msn)
+		__attribute__((nonnull(1)));
 };
 
 
@@ -305,78 +718,124 @@ struct rohc_comp_profile
  */
 struct rohc_comp_ctxt
 {
+	/* the fields read while looking for the context of a packet come first,
+	 * so that they share the first cache line of the context */
+
 	/** Whether the context is in use or not */
 	int used;
-	/** The time when the context was created (in seconds) */
-	uint64_t latest_used;
+	/** The generation of the context, changed every time the CID is given
+	 *  to a new flow so that the handles of the former flow get stale */
+	uint32_t gen;
+	/** The key to help finding the context associated with a packet */
+	rohc_ctxt_key_t key; /* may not be unique */
+	/** The hash of the flow tuple used to index the context */
+	rohc_ctxt_key_t flow_hash; /* may not be unique */
+	/** The associated profile */
+	const struct rohc_comp_profile *profile;
 	/** The time when the context was last used (in seconds) */
-	uint64_t first_used;
+	uint64_t latest_used;
 
 	/** The context unique ID (CID) */
 	rohc_cid_t cid;
+	/** The CID part of the ROHC packets, encoded once for all */
+	struct rohc_cid_code cid_code;
 
-	/** The key to help finding the context associated with a packet */
-	rohc_ctxt_key_t key; /* may not be unique */
-
-	/** The associated compressor */
-	struct rohc_comp *compressor;
-
-	/** The associated profile */
-	const struct rohc_comp_profile *profile;
 	/** Profile-specific data, defined by the profiles */
 	void *specific;
+	/** The flow fingerprint of the packet that created the context, compared
+	 *  by the check_context() handlers before any field-by-field walk */
+	struct net_pkt_fprint fprint;
+	/** The IP headers of the packet that created the context, compared by
+	 *  \ref rohc_compress_with_ctxt that does not compute the fingerprint,
+	 *  see \ref c_get_ip_layout */
+	uint32_t ip_layout;
 
 	/** The operation mode in which the context operates among:
 	 *  ROHC_U_MODE, ROHC_O_MODE, ROHC_R_MODE */
 	rohc_mode_t mode;
 	/** The operation state in which the context operates: IR, FO, SO */
 	rohc_comp_state_t state;
+	/** The number of SN bits that W-LSB encoding required for the last
+	 *  packet, recorded in the log of packets */
+	uint8_t sn_bits_nr;
 
-	/* below are some statistics */
+	/** The associated compressor */
+	struct rohc_comp *compressor;
 
-	/* The type of ROHC packet created for the last compressed packet */
-	rohc_packet_t packet_type;
+	/** The previous context in the list of contexts ordered for recycling
+	 *  (closer to the head = kept longer) */
+	struct rohc_comp_ctxt *recycle_prev;
+	/** The next context in the list of contexts ordered for recycling
+	 *  (closer to the tail = recycled sooner), or the next unused context
+	 *  if the context is not in use */
+	struct rohc_comp_ctxt *recycle_next;
+	/** The frequency group of the context (LFU recycling policy only) */
+	struct rohc_comp_ctxt_freq *freq;
+	/** Whether the context is in the protected segment of the list of
+	 *  contexts ordered for recycling (segmented LRU recycling policy only) */
+	bool slru_protected;
+	/** Whether the context is on probation or not: the context is then
+	 *  linked in the list of contexts on probation instead of the list of
+	 *  contexts ordered for recycling */
+	bool on_probation;
+
+	/** The time when the context was created (in seconds) */
+	uint64_t first_used;
 
 	/** The number of packets sent while in Initialization & Refresh (IR) state */
-	size_t ir_count;
+	rohc_ctxt_counter_t ir_count;
 	/** The number of packets sent while in First Order (FO) state */
-	size_t fo_count;
+	rohc_ctxt_counter_t fo_count;
 	/** The number of packets sent while in Second Order (SO) state */
-	size_t so_count;
+	rohc_ctxt_counter_t so_count;
 
 	/**
 	 * @brief The number of packet sent while in SO state, used for the periodic
 	 *        refreshes of the context
 	 * @see rohc_comp_periodic_down_transition
 	 */
-	size_t go_back_fo_count;
+	rohc_ctxt_counter_t go_back_fo_count;
 	/**
 	 * @brief The number of packet sent while in FO or SO state, used for the
 	 *        periodic refreshes of the context
 	 * @see rohc_comp_periodic_down_transition
 	 */
-	size_t go_back_ir_count;
+	rohc_ctxt_counter_t go_back_ir_count;
+	/** The timer for the time-based refreshes to FO state, armed when the
+	 *  context enters the SO state */
+	struct rohc_comp_timer go_back_fo_timer;
+	/** The timer for the time-based refreshes to IR state, armed when the
+	 *  context leaves the IR state */
+	struct rohc_comp_timer go_back_ir_timer;
+	/** Whether the context waits for its paced re-initialization */
+	bool reinit_pending;
 
-	/** The average size of the uncompressed packets */
-	int total_uncompressed_size;
-	/** The average size of the compressed packets */
-	int total_compressed_size;
-	/** The average size of the uncompressed headers */
-	int header_uncompressed_size;
-	/** The average size of the compressed headers */
-	int header_compressed_size;
+	/** The number of sent packets */
+	uint64_t num_sent_packets;
+};
 
-	/** The total size of the last uncompressed packet */
-	int total_last_uncompressed_size;
-	/** The total size of the last compressed packet */
-	int total_last_compressed_size;
-	/** The header size of the last uncompressed packet */
-	int header_last_uncompressed_size;
-	/** The header size of the last compressed packet */
-	int header_last_compressed_size;
 
-	/** The number of sent packets */
-	int num_sent_packets;
+/**
+ * @brief One chunk of compression contexts
+ *
+ * The contexts are allocated by chunks of \ref ROHC_COMP_CTXTS_CHUNK_LEN
+ * consecutive CIDs when the first context of the chunk is needed, so that a
+ * compressor with a large MAX_CID is cheap to create when few flows are
+ * expected, see \ref rohc_comp_reserve_contexts. The chunks are never moved
+ * nor freed before the compressor is destroyed, so the contexts may point to
+ * each other.
+ */
+struct rohc_comp_ctxts_chunk
+{
+	/** The statistics of the contexts of the chunk */
+	struct rohc_comp_ctxt_stats stats[ROHC_COMP_CTXTS_CHUNK_LEN];
+	/** The contexts of the chunk */
+	struct rohc_comp_ctxt ctxts[ROHC_COMP_CTXTS_CHUNK_LEN];
+	/** The frequency groups brought by the chunk for the LFU recycling
+	 *  policy, there are never more groups than contexts */
+	struct rohc_comp_ctxt_freq freqs[ROHC_COMP_CTXTS_CHUNK_LEN];
+	/** The memory allocated for the chunk, before cache line alignment */
+	void *mem;
 };
 
 
@@ -394,6 +853,18 @@ void rohc_comp_periodic_down_transition(struct rohc_comp_ctxt *const context)
 bool rohc_comp_reinit_context(struct rohc_comp_ctxt *const context)
 	__attribute__((warn_unused_result, nonnull(1)));
 
+bool rohc_comp_parse_packet(const struct rohc_comp *const comp,
+                            const struct rohc_buf uncomp_packet,
+                            struct net_pkt *const ip_pkt)
+	__attribute__((warn_unused_result, nonnull(1, 3)));
+
+rohc_status_t rohc_comp_compress_parsed(struct rohc_comp *const comp,
+                                        const struct net_pkt *const ip_pkt,
+                                        const struct rohc_buf uncomp_packet,
+                                        struct rohc_buf *const rohc_hdr,
+                                        struct rohc_buf *const payload)
+	__attribute__((warn_unused_result, nonnull(1, 2, 5)));
+
 bool rohc_comp_feedback_parse_opts(const struct rohc_comp_ctxt *const context,
                                    const uint8_t *const packet,
                                    const size_t packet_len,
@@ -406,5 +877,27 @@ bool rohc_comp_feedback_parse_opts(const struct rohc_comp_ctxt *const context,
                                    size_t crc_pos_from_end)
 	__attribute__((warn_unused_result, nonnull(1, 2, 4, 6, 7, 8)));
 
+
+/**
+ * @brief Account one CRC computation to the CRC phase of the current packet
+ *
+ * @param comp   The ROHC compressor
+ * @param start  The time the CRC computation started at, as given by
+ *               \ref rohc_comp_ticks
+ */
+static inline void rohc_comp_crc_ticks_add(struct rohc_comp *const comp,
+                                           const rohc_ticks_t start)
+{
+#ifdef ROHC_TIMINGS
+	if(rohc_comp_timings_enabled(comp))
+	{
+		comp->timings_crc += rohc_ticks_now() - start;
+	}
+#else
+	(void) comp;
+	(void) start;
+#endif
+}
+
 #endif
 
@@ -0,0 +1,359 @@
+/*
+ * Copyright 2016 Didier Barvaux
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/**
+ * @file   rohc_comp_pipeline.c
+ * @brief  Pipeline of compression stages that run on different threads
+ * @author Didier Barvaux <didier@barvaux.org>
+ *
+ * The packets of one ROHC channel cannot be dispatched to several
+ * compressors by CID when their order shall be kept, see the groups of
+ * compressors. The pipeline splits the compression of every packet in three
+ * stages that may run on three different threads instead:
+ *  - the parsing of the uncompressed packet, that only reads the
+ *    configuration of the compressor,
+ *  - the classification, the context lookup and the building of the ROHC
+ *    header, that update the compression contexts: only this stage shall
+ *    use the compressor,
+ *  - the copy of the payload after the ROHC header.
+ *
+ * The packets flow through one array of slots with three indexes, one for
+ * every stage: the slots between two indexes form one single-producer/
+ * single-consumer queue between two stages. Every stage writes its own index
+ * only, so the packets leave the pipeline in the order they entered it and
+ * no lock is taken.
+ */
+
+#include "rohc_comp_internals.h"
+#include "rohc_debug.h"
+#include "rohc_seqcount.h"
+#include "net_pkt.h"
+#include "rohc_alloc.h"
+
+#ifndef __KERNEL__
+#  include <string.h>
+#endif
+#include <assert.h>
+
+
+/** One packet in the pipeline of compression stages */
+struct rohc_comp_pipeline_slot
+{
+	/** The uncompressed packet */
+	struct rohc_buf uncomp_packet;
+	/** The buffer of the ROHC packet, given by the user */
+	struct rohc_buf *rohc_packet;
+	/** The parsed uncompressed packet */
+	struct net_pkt ip_pkt;
+	/** Whether the uncompressed packet was successfully parsed */
+	bool is_parsed;
+	/** The payload of the ROHC packet within the uncompressed packet */
+	struct rohc_buf payload;
+	/** The status of the compression of the packet */
+	rohc_status_t status;
+};
+
+
+/** The pipeline of compression stages of one ROHC compressor */
+struct rohc_comp_pipeline
+{
+	/** The index of the next slot to parse, written by the parsing stage
+	 *  only */
+	size_t parse_pos __attribute__((aligned(ROHC_CACHE_LINE_LEN)));
+	/** The index of the next slot to encode, written by the encoding stage
+	 *  only */
+	size_t encode_pos __attribute__((aligned(ROHC_CACHE_LINE_LEN)));
+	/** The index of the next slot to output, written by the output stage
+	 *  only */
+	size_t output_pos __attribute__((aligned(ROHC_CACHE_LINE_LEN)));
+	/** The number of slots minus one, the number of slots is a power of 2 */
+	size_t mask __attribute__((aligned(ROHC_CACHE_LINE_LEN)));
+	/** The compressor used by the encoding stage */
+	struct rohc_comp *comp;
+	/** The packets in the pipeline */
+	struct rohc_comp_pipeline_slot *slots;
+};
+
+
+/*
+ * Definitions of public functions
+ */
+
+
+/**
+ * @brief Create a new pipeline of compression stages
+ *
+ * Once packets are parsed, only the thread of the encoding stage may use the
+ * compressor, and the configuration of the compressor shall not be changed
+ * anymore. The trace callback of the compressor may be called by the threads
+ * of the parsing and encoding stages at the same time.
+ *
+ * @param comp       The ROHC compressor used by the encoding stage
+ * @param queue_len  The number of packets that may be in the pipeline at the
+ *                   same time, a power of 2
+ * @return           The new pipeline if successful,
+ *                   NULL if parameters are invalid or in case of memory
+ *                   allocation failure
+ *
+ * @ingroup rohc_comp
+ *
+ * @see rohc_comp_pipeline_free
+ */
+struct rohc_comp_pipeline * rohc_comp_pipeline_new(struct rohc_comp *const comp,
+                                                   const size_t queue_len)
+{
+	struct rohc_comp_pipeline *pipeline;
+
+	if(comp == NULL)
+	{
+		goto error;
+	}
+	if(queue_len == 0 || (queue_len & (queue_len - 1)) != 0)
+	{
+		goto error;
+	}
+
+	pipeline = rohc_malloc(sizeof(struct rohc_comp_pipeline));
+	if(pipeline == NULL)
+	{
+		goto error;
+	}
+	memset(pipeline, 0, sizeof(struct rohc_comp_pipeline));
+	pipeline->mask = queue_len - 1;
+	pipeline->comp = comp;
+
+	pipeline->slots = rohc_calloc(queue_len, sizeof(struct rohc_comp_pipeline_slot));
+	if(pipeline->slots == NULL)
+	{
+		goto free_pipeline;
+	}
+
+	return pipeline;
+
+free_pipeline:
+	zfree(pipeline);
+error:
+	return NULL;
+}
+
+
+/**
+ * @brief Destroy the given pipeline of compression stages
+ *
+ * No thread shall use the pipeline anymore. The packets that are still in
+ * the pipeline are dropped. The compressor is not destroyed.
+ *
+ * @param pipeline  The pipeline to destroy, may be NULL
+ *
+ * @ingroup rohc_comp
+ *
+ * @see rohc_comp_pipeline_new
+ */
+void rohc_comp_pipeline_free(struct rohc_comp_pipeline *const pipeline)
+{
+	if(pipeline == NULL)
+	{
+		return;
+	}
+
+	rohc_free(pipeline->slots);
+	rohc_free(pipeline);
+}
+
+
+/**
+ * @brief Parse one packet and push it in the pipeline, the first stage
+ *
+ * The uncompressed packet is parsed, then handed over to the encoding stage.
+ * A packet that cannot be parsed is handed over too, so that its failure is
+ * reported in order by \ref rohc_comp_pipeline_output.
+ *
+ * The packet data is not copied: the uncompressed packet shall remain valid
+ * until the ROHC packet is returned by \ref rohc_comp_pipeline_output. The
+ * ROHC packet shall be an empty buffer, it is filled by the next stages.
+ *
+ * Only one thread at a time may parse packets.
+ *
+ * @param pipeline       The pipeline of compression stages
+ * @param uncomp_packet  The uncompressed packet to compress
+ * @param rohc_packet    The buffer for the resulting ROHC packet
+ * @return               true if the packet entered the pipeline,
+ *                       false if the pipeline is full or if the parameters
+ *                       are invalid
+ *
+ * @ingroup rohc_comp
+ */
+bool rohc_comp_pipeline_parse(struct rohc_comp_pipeline *const pipeline,
+                              const struct rohc_buf uncomp_packet,
+                              struct rohc_buf *const rohc_packet)
+{
+	struct rohc_comp_pipeline_slot *slot;
+	size_t parse_pos;
+
+	if(pipeline == NULL || rohc_packet == NULL)
+	{
+		goto error;
+	}
+
+	/* the slot is free once its previous packet was output */
+	parse_pos = __atomic_load_n(&pipeline->parse_pos, __ATOMIC_RELAXED);
+	if((parse_pos - __atomic_load_n(&pipeline->output_pos, __ATOMIC_ACQUIRE)) >
+	   pipeline->mask)
+	{
+		goto error;
+	}
+	slot = &pipeline->slots[parse_pos & pipeline->mask];
+
+	slot->uncomp_packet = uncomp_packet;
+	slot->rohc_packet = rohc_packet;
+	slot->is_parsed = rohc_comp_parse_packet(pipeline->comp, uncomp_packet,
+	                                         &slot->ip_pkt);
+
+	__atomic_store_n(&pipeline->parse_pos, parse_pos + 1, __ATOMIC_RELEASE);
+
+	return true;
+
+error:
+	return false;
+}
+
+
+/**
+ * @brief Compress the ROHC header of the oldest parsed packet, the second
+ *        stage
+ *
+ * The parsed packet is classified, its context is found or created, then its
+ * ROHC header is built in the ROHC packet. The payload is not copied, the
+ * packet is handed over to the output stage.
+ *
+ * ROHC segmentation is not available, see \ref rohc_compress_iov.
+ *
+ * Only the thread that uses the compressor may encode packets.
+ *
+ * @param pipeline  The pipeline of compression stages
+ * @return          true if one packet was encoded (with success or not),
+ *                  false if no parsed packet is waiting or if the parameters
+ *                  are invalid
+ *
+ * @ingroup rohc_comp
+ */
+bool rohc_comp_pipeline_encode(struct rohc_comp_pipeline *const pipeline)
+{
+	struct rohc_comp_pipeline_slot *slot;
+	size_t encode_pos;
+
+	if(pipeline == NULL)
+	{
+		goto error;
+	}
+
+	encode_pos = __atomic_load_n(&pipeline->encode_pos, __ATOMIC_RELAXED);
+	if(encode_pos == __atomic_load_n(&pipeline->parse_pos, __ATOMIC_ACQUIRE))
+	{
+		goto error;
+	}
+	slot = &pipeline->slots[encode_pos & pipeline->mask];
+
+	if(!slot->is_parsed)
+	{
+		slot->status = ROHC_STATUS_ERROR;
+	}
+	else
+	{
+		slot->status =
+			rohc_comp_compress_parsed(pipeline->comp, &slot->ip_pkt,
+			                          slot->uncomp_packet, slot->rohc_packet,
+			                          &slot->payload);
+	}
+
+	__atomic_store_n(&pipeline->encode_pos, encode_pos + 1, __ATOMIC_RELEASE);
+
+	return true;
+
+error:
+	return false;
+}
+
+
+/**
+ * @brief Copy the payload of the oldest encoded packet and pop it from the
+ *        pipeline, the third stage
+ *
+ * The payload is copied after the ROHC header. The packets are output in the
+ * order they were parsed.
+ *
+ * Only one thread at a time may output packets.
+ *
+ * @param pipeline          The pipeline of compression stages
+ * @param[out] rohc_packet  The buffer of the ROHC packet, as given to
+ *                          \ref rohc_comp_pipeline_parse
+ * @param[out] status       The status of the compression of the packet:
+ *                          \li \ref ROHC_STATUS_OK if the ROHC packet is
+ *                              complete
+ *                          \li \ref ROHC_STATUS_OUTPUT_TOO_SMALL if the
+ *                              buffer is too small for the ROHC packet
+ *                          \li \ref ROHC_STATUS_ERROR if an error occurred
+ * @return                  true if one packet was output,
+ *                          false if no encoded packet is waiting or if the
+ *                          parameters are invalid
+ *
+ * @ingroup rohc_comp
+ */
+bool rohc_comp_pipeline_output(struct rohc_comp_pipeline *const pipeline,
+                               struct rohc_buf **const rohc_packet,
+                               rohc_status_t *const status)
+{
+	struct rohc_comp_pipeline_slot *slot;
+	size_t output_pos;
+
+	if(pipeline == NULL || rohc_packet == NULL || status == NULL)
+	{
+		goto error;
+	}
+
+	output_pos = __atomic_load_n(&pipeline->output_pos, __ATOMIC_RELAXED);
+	if(output_pos == __atomic_load_n(&pipeline->encode_pos, __ATOMIC_ACQUIRE))
+	{
+		goto error;
+	}
+	slot = &pipeline->slots[output_pos & pipeline->mask];
+
+	*rohc_packet = slot->rohc_packet;
+	*status = slot->status;
+	if((*status) == ROHC_STATUS_OK)
+	{
+		const size_t free_len =
+			rohc_buf_avail_len(*slot->rohc_packet) - slot->rohc_packet->len;
+
+		if(slot->payload.len > free_len)
+		{
+			*status = ROHC_STATUS_OUTPUT_TOO_SMALL;
+		}
+		else
+		{
+			rohc_buf_append_buf(slot->rohc_packet, slot->payload);
+		}
+	}
+
+	__atomic_store_n(&pipeline->output_pos, output_pos + 1, __ATOMIC_RELEASE);
+
+	return true;
+
+error:
+	return false;
+}
@@ -70,6 +70,85 @@
 /** A flag to indicate that an errror occurred */
 #define MOD_ERROR 0x0008
 
+/** The SN bits are checked against the 4-bit SN of the UO-1-ID base header */
+#define EXT_LIMITS_SN_LE_4        0x01
+/** No TS bit is needed or the TS is deducible from the SN */
+#define EXT_LIMITS_TS_DEDUCIBLE   0x02
+/** The RTP Marker bit must not be set */
+#define EXT_LIMITS_NO_MARKER      0x04
+/** Two IP headers are required */
+#define EXT_LIMITS_MULTIPLE_IP    0x08
+
+/** The number of extensions that are not EXT-3 */
+#define EXT_LIMITS_NR  4U
+
+/**
+ * @brief The maximum fields that the base header of one UO-1-ID/UOR-2*
+ *        packet may transmit with one extension
+ *
+ * The rows of one packet type are ordered from the smallest extension to the
+ * largest one: no extension, EXT-0, EXT-1 then EXT-2. The first row whose
+ * limits are met gives the extension, EXT-3 is used if no row matches. The
+ * first row thus tells how many bits the base header transmits alone.
+ */
+struct rfc3095_ext_limits
+{
+	rohc_ext_t ext;           /**< The extension the row stands for */
+	uint8_t sn_bits_max;      /**< The max number of SN bits */
+	uint8_t ts_bits_max;      /**< The max number of TS bits */
+	uint8_t ip_id_bits_min;   /**< The min number of innermost IP-ID bits */
+	uint8_t ip_id_bits_max;   /**< The max number of innermost IP-ID bits */
+	uint8_t ip_id2_bits_max;  /**< The max number of outermost IP-ID bits */
+	uint8_t flags;            /**< The EXT_LIMITS_xxx flags */
+};
+
+/** The extension limits for the UOR-2 packet (non-RTP profiles) */
+static const struct rfc3095_ext_limits c_ext_limits_uor2[EXT_LIMITS_NR] =
+{
+	{ ROHC_EXT_NONE, 5, 0, 0,  0,  0, 0 },
+	{ ROHC_EXT_0,    8, 0, 1,  3,  0, 0 },
+	{ ROHC_EXT_1,    8, 0, 1, 11,  0, 0 },
+	{ ROHC_EXT_2,    8, 0, 1,  8, 11, EXT_LIMITS_MULTIPLE_IP },
+};
+
+/** The extension limits for the UOR-2-RTP packet */
+static const struct rfc3095_ext_limits c_ext_limits_uor2rtp[EXT_LIMITS_NR] =
+{
+	{ ROHC_EXT_NONE, 6,  6, 0, 0, 0, 0 },
+	{ ROHC_EXT_0,    9,  9, 0, 0, 0, 0 },
+	{ ROHC_EXT_1,    9, 17, 0, 0, 0, 0 },
+	{ ROHC_EXT_2,    9, 25, 0, 0, 0, 0 },
+};
+
+/** The extension limits for the UOR-2-TS packet */
+static const struct rfc3095_ext_limits c_ext_limits_uor2ts[EXT_LIMITS_NR] =
+{
+	{ ROHC_EXT_NONE, 6,  5, 0, 0, 0, 0 },
+	{ ROHC_EXT_0,    9,  8, 0, 0, 0, 0 },
+	{ ROHC_EXT_1,    9,  8, 0, 8, 0, 0 },
+	{ ROHC_EXT_2,    9, 16, 0, 8, 0, 0 },
+};
+
+/** The extension limits for the UOR-2-ID packet */
+static const struct rfc3095_ext_limits c_ext_limits_uor2id[EXT_LIMITS_NR] =
+{
+	{ ROHC_EXT_NONE, 6, 0, 0,  5, 0, EXT_LIMITS_TS_DEDUCIBLE },
+	{ ROHC_EXT_0,    9, 0, 0,  8, 0, EXT_LIMITS_TS_DEDUCIBLE },
+	{ ROHC_EXT_1,    9, 8, 0,  8, 0, 0 },
+	{ ROHC_EXT_2,    9, 8, 0, 16, 0, 0 },
+};
+
+/** The extension limits for the UO-1-ID packet */
+static const struct rfc3095_ext_limits c_ext_limits_uo1id[EXT_LIMITS_NR] =
+{
+	{ ROHC_EXT_NONE, 4, 0, 0,  5, 0,
+	  EXT_LIMITS_SN_LE_4 | EXT_LIMITS_TS_DEDUCIBLE | EXT_LIMITS_NO_MARKER },
+	{ ROHC_EXT_0,    7, 0, 0,  8, 0,
+	  EXT_LIMITS_TS_DEDUCIBLE | EXT_LIMITS_NO_MARKER },
+	{ ROHC_EXT_1,    7, 8, 0,  8, 0, EXT_LIMITS_NO_MARKER },
+	{ ROHC_EXT_2,    7, 8, 0, 16, 0, EXT_LIMITS_NO_MARKER },
+};
+
 
 /*
  * Prototypes of main private functions
@@ -81,36 +160,26 @@ static bool ip_header_info_new(struct ip_header_info *const header_info,
                                const size_t wlsb_window_width,
                                rohc_trace_callback2_t trace_cb,
                                void *const trace_cb_priv,
+                               const rohc_trace_level_t trace_level,
+                               const rohc_trace_level_t *const trace_pkt_level,
                                const int profile_id)
 	__attribute__((warn_unused_result, nonnull(1, 2)));
 static void ip_header_info_free(struct ip_header_info *const header_info)
 	__attribute__((nonnull(1)));
+static size_t rohc_comp_rfc3095_exts_gen(const struct ip_header_info *const header_info)
+	__attribute__((warn_unused_result, nonnull(1), pure));
 
 static void c_init_tmp_variables(struct generic_tmp_vars *const tmp_vars);
 
 static rohc_packet_t decide_packet(struct rohc_comp_ctxt *const context)
 	__attribute__((warn_unused_result, nonnull(1)));
 
-static rohc_ext_t decide_extension_uor2(const struct rohc_comp_ctxt *const context,
-                                        const size_t nr_innermost_ip_id_bits,
-                                        const size_t nr_outermost_ip_id_bits)
-	__attribute__((warn_unused_result, nonnull(1)));
-static rohc_ext_t decide_extension_uor2rtp(const struct rohc_comp_ctxt *const context,
-                                           const size_t nr_innermost_ip_id_bits,
-                                           const size_t nr_outermost_ip_id_bits)
-	__attribute__((warn_unused_result, nonnull(1)));
-static rohc_ext_t decide_extension_uor2ts(const struct rohc_comp_ctxt *const context,
-                                          const size_t nr_innermost_ip_id_bits,
-                                          const size_t nr_outermost_ip_id_bits)
-	__attribute__((warn_unused_result, nonnull(1)));
-static rohc_ext_t decide_extension_uor2id(const struct rohc_comp_ctxt *const context,
-                                          const size_t nr_innermost_ip_id_bits,
-                                          const size_t nr_outermost_ip_id_bits)
-	__attribute__((warn_unused_result, nonnull(1)));
-static rohc_ext_t decide_extension_uo1id(const struct rohc_comp_ctxt *const context,
-                                         const size_t nr_innermost_ip_id_bits,
-                                         const size_t nr_outermost_ip_id_bits)
-	__attribute__((warn_unused_result, nonnull(1)));
+static const struct rfc3095_ext_limits *
+	rfc3095_get_ext_limits(const rohc_packet_t packet_type)
+	__attribute__((warn_unused_result, const));
+static bool rfc3095_sn_fits_ext(const struct generic_tmp_vars *const tmp,
+                                const struct rfc3095_ext_limits *const limits)
+	__attribute__((warn_unused_result, nonnull(1, 2), pure));
 
 static int code_packet(struct rohc_comp_ctxt *const context,
                        const struct net_pkt *const uncomp_pkt,
@@ -309,12 +378,16 @@ static int header_fields(const struct rohc_comp_ctxt *const context,
                          int counter)
 	__attribute__((warn_unused_result, nonnull(1, 2, 4, 7)));
 
-static uint8_t compute_uo_crc(const struct rohc_comp_rfc3095_ctxt *rfc3095_ctxt,
+static uint8_t compute_uo_crc(struct rohc_comp_ctxt *const context,
                               const struct net_pkt *const uncomp_pkt,
                               const rohc_crc_type_t crc_type,
-                              const uint8_t crc_init,
-                              const uint8_t *const crc_table)
-	__attribute__((warn_unused_result, nonnull(1, 2, 5)));
+                              const uint8_t crc_init)
+	__attribute__((warn_unused_result, nonnull(1, 2)));
+static uint8_t compute_uo_crc_fields(struct rohc_comp_rfc3095_ctxt *const rfc3095_ctxt,
+                                     const struct net_pkt *const uncomp_pkt,
+                                     const rohc_crc_type_t crc_type,
+                                     const uint8_t crc_init)
+	__attribute__((warn_unused_result, nonnull(1, 2)));
 
 static void update_context(struct rohc_comp_ctxt *const context,
                            const struct net_pkt *const uncomp_pkt)
@@ -323,6 +396,9 @@ static void update_context_ip_hdr(struct ip_header_info *const ip_flags,
                                   const struct ip_packet *const ip)
 	__attribute__((nonnull(1, 2)));
 
+static bool rohc_comp_rfc3095_is_steady(const struct rohc_comp_ctxt *const context,
+                                        const struct net_pkt *const uncomp_pkt)
+	__attribute__((warn_unused_result, nonnull(1, 2)));
 static bool rohc_comp_rfc3095_detect_changes(struct rohc_comp_ctxt *const context,
                                              const struct net_pkt *const uncomp_pkt)
 	__attribute__((warn_unused_result, nonnull(1, 2)));
@@ -424,6 +500,9 @@ static bool is_field_changed(const unsigned short changed_fields,
  *                           IP-ID (must be > 0)
  * @param trace_cb           The function to call for printing traces
  * @param trace_cb_priv      An optional private context, may be NULL
+ * @param trace_level        The minimum level of the traces to print
+ * @param trace_pkt_level    The minimum level of the traces for the current
+ *                           packet, NULL if not sampled
  * @param profile_id         The ID of the associated compression profile
  * @return                   true if successful, false otherwise
  */
@@ -433,6 +512,8 @@ static bool ip_header_info_new(struct ip_header_info *const header_info,
                                const size_t wlsb_window_width,
                                rohc_trace_callback2_t trace_cb,
                                void *const trace_cb_priv,
+                               const rohc_trace_level_t trace_level,
+                               const rohc_trace_level_t *const trace_pkt_level,
                                const int profile_id)
 {
 	assert(header_info != NULL);
@@ -450,15 +531,8 @@ static bool ip_header_info_new(struct ip_header_info *const header_info,
 	if(header_info->version == IPV4)
 	{
 		/* init the parameters to encode the IP-ID with W-LSB encoding */
-		header_info->info.v4.ip_id_window =
-			c_create_wlsb(16, wlsb_window_width, ROHC_LSB_SHIFT_IP_ID);
-		if(header_info->info.v4.ip_id_window == NULL)
-		{
-			__rohc_print(trace_cb, trace_cb_priv, ROHC_TRACE_ERROR,
-			             ROHC_TRACE_COMP, profile_id,
-			             "no memory to allocate W-LSB encoding for IP-ID");
-			goto error;
-		}
+		c_init_wlsb(&header_info->info.v4.ip_id_window, 16, wlsb_window_width,
+		            ROHC_LSB_SHIFT_IP_ID);
 
 		/* init the thresholds the counters must reach before launching
 		 * an action */
@@ -474,13 +548,11 @@ static bool ip_header_info_new(struct ip_header_info *const header_info,
 	{
 		/* init the compression context for IPv6 extension header list */
 		rohc_comp_list_ipv6_new(&header_info->info.v6.ext_comp, list_trans_nr,
-		                        trace_cb, trace_cb_priv, profile_id);
+		                        trace_cb, trace_cb_priv, trace_level,
+		                        trace_pkt_level, profile_id);
 	}
 
 	return true;
-
-error:
-	return false;
 }
 
 
@@ -491,12 +563,7 @@ error:
  */
 static void ip_header_info_free(struct ip_header_info *const header_info)
 {
-	if(header_info->version == IPV4)
-	{
-		/* IPv4: destroy the W-LSB context for the IP-ID offset */
-		c_destroy_wlsb(header_info->info.v4.ip_id_window);
-	}
-	else
+	if(header_info->version != IPV4)
 	{
 		/* IPv6: destroy the list of IPv6 extension headers */
 		rohc_comp_list_ipv6_free(&header_info->info.v6.ext_comp);
@@ -504,6 +571,20 @@ static void ip_header_info_free(struct ip_header_info *const header_info)
 }
 
 
+/**
+ * @brief Get the generation of the IPv6 extension headers of one IP header
+ *
+ * @param header_info  The IP header info
+ * @return             The generation of the list of IPv6 extension headers,
+ *                     0 for IPv4 headers
+ */
+static size_t rohc_comp_rfc3095_exts_gen(const struct ip_header_info *const header_info)
+{
+	return (header_info->version == IPV6 ?
+	        header_info->info.v6.ext_comp.pkt_list_gen : 0);
+}
+
+
 /**
  * @brief Initialize all temporary variables stored in the context.
  *
@@ -530,16 +611,27 @@ static void c_init_tmp_variables(struct generic_tmp_vars *const tmp_vars)
 /**
  * @brief Create a new context and initialize it thanks to the given IP packet.
  *
- * @param context   The compression context
- * @param sn_shift  The shift parameter (p) to use for encoding SN with W-LSB
- * @param packet    The packet given to initialize the new context
- * @return          bool if successful, false otherwise
+ * The generic part of the context and the profile-specific part are carved
+ * from one single memory block of the pool of the compressor. The
+ * profile-specific part is zeroed and available in the \e specific field
+ * of the generic part.
+ *
+ * @param context        The compression context
+ * @param sn_shift       The shift parameter (p) to use for encoding SN with
+ *                       W-LSB
+ * @param specific_size  The size of the profile-specific part of the context,
+ *                       0 if the profile has no specific part
+ * @param packet         The packet given to initialize the new context
+ * @return               bool if successful, false otherwise
  */
 bool rohc_comp_rfc3095_create(struct rohc_comp_ctxt *const context,
                               const rohc_lsb_shift_t sn_shift,
+                              const size_t specific_size,
                               const struct net_pkt *const packet)
 {
 	struct rohc_comp_rfc3095_ctxt *rfc3095_ctxt;
+	struct rohc_ctxt_arena arena;
+	void *specific = NULL;
 
 	assert(context != NULL);
 	assert(context->profile != NULL);
@@ -547,15 +639,24 @@ bool rohc_comp_rfc3095_create(struct rohc_comp_ctxt *const context,
 
 	rohc_comp_debug(context, "new generic context required for a new stream");
 
-	/* allocate memory for the generic part of the context */
-	rfc3095_ctxt = malloc(sizeof(struct rohc_comp_rfc3095_ctxt));
-	if(rfc3095_ctxt == NULL)
+	/* get one memory block for the generic and specific parts of the context */
+	if(rohc_ctxt_pool_get(context->compressor->cur_ctxt_pool,
+	                      rohc_ctxt_arena_size(sizeof(struct rohc_comp_rfc3095_ctxt)) +
+	                      rohc_ctxt_arena_size(specific_size), &arena) == NULL)
 	{
 		rohc_error(context->compressor, ROHC_TRACE_COMP, context->profile->id,
 		           "no memory for generic part of the profile context");
 		goto quit;
 	}
-	memset(rfc3095_ctxt, 0, sizeof(struct rohc_comp_rfc3095_ctxt));
+	/* the generic part comes first in the block, so that the block is given
+	 * back to the pool with it */
+	rfc3095_ctxt = rohc_ctxt_arena_alloc(&arena, sizeof(struct rohc_comp_rfc3095_ctxt));
+	assert(rfc3095_ctxt != NULL);
+	if(specific_size > 0)
+	{
+		specific = rohc_ctxt_arena_alloc(&arena, specific_size);
+		assert(specific != NULL);
+	}
 	context->specific = rfc3095_ctxt;
 
 	/* initialize some context variables:
@@ -569,14 +670,8 @@ bool rohc_comp_rfc3095_create(struct rohc_comp_ctxt *const context,
 	/* step 1 */
 	rohc_comp_debug(context, "use shift parameter %d for LSB-encoding of SN",
 	                sn_shift);
-	rfc3095_ctxt->sn_window =
-		c_create_wlsb(16, context->compressor->wlsb_window_width, sn_shift);
-	if(rfc3095_ctxt->sn_window == NULL)
-	{
-		rohc_error(context->compressor, ROHC_TRACE_COMP, context->profile->id,
-		           "no memory to allocate W-LSB encoding for SN");
-		goto free_generic_context;
-	}
+	c_init_wlsb(&rfc3095_ctxt->sn_window, 16,
+	            context->compressor->wlsb_window_width, sn_shift);
 
 	/* step 3 */
 	if(!ip_header_info_new(&rfc3095_ctxt->outer_ip_flags,
@@ -585,9 +680,11 @@ bool rohc_comp_rfc3095_create(struct rohc_comp_ctxt *const context,
 	                       context->compressor->wlsb_window_width,
 	                       context->compressor->trace_callback,
 	                       context->compressor->trace_callback_priv,
+	                       context->compressor->trace_level,
+	                       context->compressor->trace_pkt_level,
 	                       context->profile->id))
 	{
-		goto free_sn_window;
+		goto free_generic_context;
 	}
 	if(packet->ip_hdr_nr > 1)
 	{
@@ -597,6 +694,8 @@ bool rohc_comp_rfc3095_create(struct rohc_comp_ctxt *const context,
 		                       context->compressor->wlsb_window_width,
 		                       context->compressor->trace_callback,
 		                       context->compressor->trace_callback_priv,
+		                       context->compressor->trace_level,
+		                       context->compressor->trace_pkt_level,
 		                       context->profile->id))
 		{
 			goto free_header_info;
@@ -612,10 +711,11 @@ bool rohc_comp_rfc3095_create(struct rohc_comp_ctxt *const context,
 	c_init_tmp_variables(&rfc3095_ctxt->tmp);
 
 	/* step 5 */
-	rfc3095_ctxt->specific = NULL;
+	rfc3095_ctxt->specific = specific;
 	rfc3095_ctxt->next_header_proto = packet->transport->proto;
 	rfc3095_ctxt->next_header_len = 0;
 	rfc3095_ctxt->decide_state = rohc_comp_rfc3095_decide_state;
+	rfc3095_ctxt->is_next_header_steady = NULL;
 	rfc3095_ctxt->decide_FO_packet = NULL;
 	rfc3095_ctxt->decide_SO_packet = NULL;
 	rfc3095_ctxt->decide_extension = NULL;
@@ -627,15 +727,14 @@ bool rohc_comp_rfc3095_create(struct rohc_comp_ctxt *const context,
 	rfc3095_ctxt->code_uo_remainder = NULL;
 	rfc3095_ctxt->compute_crc_static = compute_crc_static;
 	rfc3095_ctxt->compute_crc_dynamic = compute_crc_dynamic;
+	rfc3095_ctxt->static_chain_len = 0;
 
 	return true;
 
 free_header_info:
 	ip_header_info_free(&rfc3095_ctxt->outer_ip_flags);
-free_sn_window:
-	c_destroy_wlsb(rfc3095_ctxt->sn_window);
 free_generic_context:
-	free(rfc3095_ctxt);
+	rohc_ctxt_pool_put(context->compressor->cur_ctxt_pool, rfc3095_ctxt);
 quit:
 	return false;
 }
@@ -659,10 +758,9 @@ void rohc_comp_rfc3095_destroy(struct rohc_comp_ctxt *const context)
 	{
 		ip_header_info_free(&rfc3095_ctxt->inner_ip_flags);
 	}
-	c_destroy_wlsb(rfc3095_ctxt->sn_window);
 
-	zfree(rfc3095_ctxt->specific);
-	free(rfc3095_ctxt);
+	/* the specific part of the context belongs to the same memory block */
+	rohc_ctxt_pool_put(context->compressor->cur_ctxt_pool, rfc3095_ctxt);
 }
 
 
@@ -730,6 +828,7 @@ bool rohc_comp_rfc3095_check_profile(const struct rohc_comp *const comp,
 	/* check if the checksum of the outer IP header is correct */
 	if(packet->outer_ip.version == IPV4 &&
 	   (comp->features & ROHC_COMP_FEATURE_NO_IP_CHECKSUMS) == 0 &&
+	   !packet->ip_csums_verified &&
 	   ip_fast_csum(packet->outer_ip.data,
 	                sizeof(struct ipv4_hdr) / sizeof(uint32_t)) != 0)
 	{
@@ -782,6 +881,7 @@ bool rohc_comp_rfc3095_check_profile(const struct rohc_comp *const comp,
 		/* check if the checksum of the inner IP header is correct */
 		if(packet->inner_ip.version == IPV4 &&
 		   (comp->features & ROHC_COMP_FEATURE_NO_IP_CHECKSUMS) == 0 &&
+		   !packet->ip_csums_verified &&
 		   ip_fast_csum(packet->inner_ip.data,
 		                sizeof(struct ipv4_hdr) / sizeof(uint32_t)) != 0)
 		{
@@ -840,16 +940,30 @@ int rohc_comp_rfc3095_encode(struct rohc_comp_ctxt *const context,
 	rfc3095_ctxt->tmp.nr_ip_id_bits2 = 0;
 	rfc3095_ctxt->tmp.packet_type = ROHC_PACKET_UNKNOWN;
 
-	/* detect changes between new uncompressed packet and context */
-	if(!rohc_comp_rfc3095_detect_changes(context, uncomp_pkt))
+	if(rohc_comp_rfc3095_is_steady(context, uncomp_pkt))
 	{
-		rohc_comp_warn(context, "failed to detect changes in uncompressed packet");
-		goto error;
+		/* steady flow in SO state: no field changed, the IP-ID behaviour and
+		 * the state stay the same, only the SN is required */
+		rfc3095_ctxt->sn = rfc3095_ctxt->get_next_sn(context, uncomp_pkt);
+		rfc3095_ctxt->tmp.changed_fields = 0;
+		rfc3095_ctxt->tmp.send_static = 0;
+		rfc3095_ctxt->tmp.send_dynamic = 0;
+		rohc_comp_debug(context, "SN = %u, steady flow, stay in SO state",
+		                rfc3095_ctxt->sn);
 	}
+	else
+	{
+		/* detect changes between new uncompressed packet and context */
+		if(!rohc_comp_rfc3095_detect_changes(context, uncomp_pkt))
+		{
+			rohc_comp_warn(context, "failed to detect changes in uncompressed packet");
+			goto error;
+		}
 
-	/* decide in which state to go */
-	assert(rfc3095_ctxt->decide_state != NULL);
-	rfc3095_ctxt->decide_state(context);
+		/* decide in which state to go */
+		assert(rfc3095_ctxt->decide_state != NULL);
+		rfc3095_ctxt->decide_state(context);
+	}
 	if(context->mode == ROHC_U_MODE)
 	{
 		rohc_comp_periodic_down_transition(context);
@@ -1133,6 +1247,8 @@ static void rohc_comp_rfc3095_feedback_ack(struct rohc_comp_ctxt *const context,
 	}
 	else if(context->mode == ROHC_R_MODE)
 	{
+		uint32_t acked_sn;
+
 		/* RFC 3095, §5.5.1.2:
 		 *  - valid positive ACKs of IR packets causes transition from IR to FO
 		 *    state
@@ -1146,16 +1262,23 @@ static void rohc_comp_rfc3095_feedback_ack(struct rohc_comp_ctxt *const context,
 
 		/* RFC 3095, §4.5.2: ack W-LSB values only in R-mode since U/O-mode uses
 		 * a sliding window with a limited maximum width */
-		/* acknowledge IP-ID and SN only if SN is considered as valid */
-		if(!sn_not_valid)
-		{
+		/* acknowledge IP-ID and SN only if SN is considered as valid and
+		 * matches one window entry: all the windows share the SNs of their
+		 * entries, so look for the acknowledged SN once, then ack all the
+		 * windows with the full SN */
+		if(!sn_not_valid &&
+		   wlsb_get_acked_sn(&rfc3095_ctxt->sn_window, sn_bits, sn_bits_nr,
+		                     &acked_sn))
+		{
+			const bool is_width_variable =
+				!!(context->compressor->features & ROHC_COMP_FEATURE_WLSB_VARIABLE_WIDTH);
 			size_t acked_nr;
 
 			/* ack outer IP-ID only if IPv4 */
 			if(rfc3095_ctxt->outer_ip_flags.version == IPV4)
 			{
-				acked_nr = wlsb_ack(rfc3095_ctxt->outer_ip_flags.info.v4.ip_id_window,
-				                    sn_bits, sn_bits_nr);
+				acked_nr = wlsb_ack(&rfc3095_ctxt->outer_ip_flags.info.v4.ip_id_window,
+				                    acked_sn, 32, is_width_variable);
 				rohc_comp_debug(context, "FEEDBACK-2: positive ACK removed %zu "
 				                "values from inner IP-ID W-LSB", acked_nr);
 			}
@@ -1163,13 +1286,14 @@ static void rohc_comp_rfc3095_feedback_ack(struct rohc_comp_ctxt *const context,
 			if(rfc3095_ctxt->ip_hdr_nr > 1 &&
 			   rfc3095_ctxt->inner_ip_flags.version == IPV4)
 			{
-				acked_nr = wlsb_ack(rfc3095_ctxt->inner_ip_flags.info.v4.ip_id_window,
-				                    sn_bits, sn_bits_nr);
+				acked_nr = wlsb_ack(&rfc3095_ctxt->inner_ip_flags.info.v4.ip_id_window,
+				                    acked_sn, 32, is_width_variable);
 				rohc_comp_debug(context, "FEEDBACK-2: positive ACK removed %zu "
 				                "values from outer IP-ID W-LSB", acked_nr);
 			}
 			/* always ack SN */
-			acked_nr = wlsb_ack(rfc3095_ctxt->sn_window, sn_bits, sn_bits_nr);
+			acked_nr = wlsb_ack(&rfc3095_ctxt->sn_window, acked_sn, 32,
+			                    is_width_variable);
 			rohc_comp_debug(context, "FEEDBACK-2: positive ACK removed %zu values "
 			                "from SN W-LSB", acked_nr);
 		}
@@ -1221,6 +1345,104 @@ static void rohc_comp_rfc3095_feedback_ack(struct rohc_comp_ctxt *const context,
 }
 
 
+/**
+ * @brief Whether the uncompressed packet belongs to a steady flow
+ *
+ * A flow is steady once the context reached the SO state and all the change
+ * counters are saturated. A packet of a steady flow changes none of the
+ * fields compared against the context: its IPv4 IP-ID increases by one in
+ * Network Byte Order, or its IPv6 header got no extension header as the
+ * reference list. The detection of changes and the decision of the state
+ * may then be skipped: they would not change the context.
+ *
+ * Only one IP header is handled, the profile shall check its next header.
+ *
+ * @param context     The compression context
+ * @param uncomp_pkt  The uncompressed packet
+ * @return            true if the detection of changes may be skipped,
+ *                    false if it is required
+ */
+static bool rohc_comp_rfc3095_is_steady(const struct rohc_comp_ctxt *const context,
+                                        const struct net_pkt *const uncomp_pkt)
+{
+	const struct rohc_comp_rfc3095_ctxt *const rfc3095_ctxt =
+		(struct rohc_comp_rfc3095_ctxt *) context->specific;
+	const struct ip_header_info *const ip_flags = &rfc3095_ctxt->outer_ip_flags;
+	const struct ip_packet *const ip = &uncomp_pkt->outer_ip;
+
+	if(rfc3095_ctxt->is_next_header_steady == NULL ||
+	   context->state != ROHC_COMP_STATE_SO ||
+	   uncomp_pkt->ip_hdr_nr != 1 || rfc3095_ctxt->ip_hdr_nr != 1 ||
+	   ip_flags->is_first_header || ip_get_version(ip) != ip_flags->version)
+	{
+		return false;
+	}
+
+	/* no field changed in the last few packets */
+	if(ip_flags->protocol_count < MAX_FO_COUNT ||
+	   ip_flags->tos_count < MAX_FO_COUNT ||
+	   ip_flags->ttl_count < MAX_FO_COUNT)
+	{
+		return false;
+	}
+
+	if(ip_flags->version == IPV4)
+	{
+		const struct ipv4_hdr *const old_ipv4 = &ip_flags->info.v4.old_ip;
+		const struct ipv4_hdr *const ipv4 = ipv4_get_header(ip);
+
+		/* IP-ID increasing in NBO, before and now */
+		if(ip_flags->info.v4.rnd != 0 || ip_flags->info.v4.old_rnd != 0 ||
+		   ip_flags->info.v4.nbo != 1 || ip_flags->info.v4.old_nbo != 1 ||
+		   ip_flags->info.v4.sid != 0 || ip_flags->info.v4.old_sid != 0)
+		{
+			return false;
+		}
+
+		/* no IPv4-specific field changed in the last few packets */
+		if(ip_flags->info.v4.df_count < MAX_FO_COUNT ||
+		   ip_flags->info.v4.rnd_count < MAX_FO_COUNT ||
+		   ip_flags->info.v4.nbo_count < MAX_FO_COUNT ||
+		   ip_flags->info.v4.sid_count < MAX_FO_COUNT)
+		{
+			return false;
+		}
+
+		/* no field changed in the current packet */
+		if(ipv4->tos != old_ipv4->tos ||
+		   ipv4->ttl != old_ipv4->ttl ||
+		   ipv4->protocol != old_ipv4->protocol ||
+		   ipv4->df != old_ipv4->df ||
+		   rohc_ntoh16(ipv4->id) != ((uint16_t) (rohc_ntoh16(old_ipv4->id) + 1)))
+		{
+			return false;
+		}
+	}
+	else
+	{
+		const struct ipv6_hdr *const old_ipv6 = &ip_flags->info.v6.old_ip;
+		uint8_t ext_type;
+
+		/* no extension header, now and in the reference list */
+		if(!ip_flags->info.v6.ext_comp.is_empty_ref ||
+		   ip_get_next_ext_from_ip(ip, &ext_type) != NULL)
+		{
+			return false;
+		}
+
+		/* no field changed in the current packet */
+		if(ip_get_tos(ip) != ipv6_get_tc(old_ipv6) ||
+		   ip_get_ttl(ip) != old_ipv6->hl ||
+		   ip_get_protocol(ip) != old_ipv6->nh)
+		{
+			return false;
+		}
+	}
+
+	return rfc3095_ctxt->is_next_header_steady(context);
+}
+
+
 /**
  * @brief Detect changes between packet and context
  *
@@ -1253,6 +1475,8 @@ static bool rohc_comp_rfc3095_detect_changes(struct rohc_comp_ctxt *const contex
 			                       context->compressor->wlsb_window_width,
 			                       context->compressor->trace_callback,
 			                       context->compressor->trace_callback_priv,
+			                       context->compressor->trace_level,
+			                       context->compressor->trace_pkt_level,
 			                       context->profile->id))
 			{
 				goto error;
@@ -1264,6 +1488,9 @@ static bool rohc_comp_rfc3095_detect_changes(struct rohc_comp_ctxt *const contex
 			ip_header_info_free(&rfc3095_ctxt->inner_ip_flags);
 		}
 		rfc3095_ctxt->ip_hdr_nr = uncomp_pkt->ip_hdr_nr;
+		rfc3095_ctxt->static_chain_len = 0;
+		/* the generations of the new list of extension headers restart */
+		rfc3095_ctxt->crc_static.ip_fields_len = 0;
 	}
 
 	/* check NBO and RND of the IP-ID of the IP headers (IPv4 only) */
@@ -1294,6 +1521,22 @@ static bool rohc_comp_rfc3095_detect_changes(struct rohc_comp_ctxt *const contex
 		}
 	}
 
+	/* the CRC-STATIC cached for the IP headers covers the IPv6 extension
+	 * headers as long as their lists keep the same generations */
+	rfc3095_ctxt->crc_static.exts_gens[0] =
+		rohc_comp_rfc3095_exts_gen(&rfc3095_ctxt->outer_ip_flags);
+	rfc3095_ctxt->crc_static.exts_gens[1] =
+		(uncomp_pkt->ip_hdr_nr > 1 ?
+		 rohc_comp_rfc3095_exts_gen(&rfc3095_ctxt->inner_ip_flags) : 0);
+
+	/* the cached static chain holds the Protocol / Next Header fields */
+	if(is_field_changed(rfc3095_ctxt->tmp.changed_fields, MOD_PROTOCOL) ||
+	   (uncomp_pkt->ip_hdr_nr > 1 &&
+	    is_field_changed(rfc3095_ctxt->tmp.changed_fields2, MOD_PROTOCOL)))
+	{
+		rfc3095_ctxt->static_chain_len = 0;
+	}
+
 	/* how many changed fields are static ones? */
 	rfc3095_ctxt->tmp.send_static = changed_static_both_hdr(context, uncomp_pkt);
 
@@ -1309,6 +1552,41 @@ error:
 }
 
 
+/**
+ * @brief Get the SN of the last packet compressed with the given context
+ *
+ * @param context  The compression context
+ * @return         The SN of the last compressed packet
+ */
+uint32_t rohc_comp_rfc3095_get_msn(const struct rohc_comp_ctxt *const context)
+{
+	const struct rohc_comp_rfc3095_ctxt *const rfc3095_ctxt =
+		(struct rohc_comp_rfc3095_ctxt *) context->specific;
+
+	return rfc3095_ctxt->sn;
+}
+
+
+/**
+ * @brief Make the next packet compressed with the given context get the
+ *        given SN
+ *
+ * Only the profiles with an internal 16-bit SN are affected: the other
+ * profiles take the SN from the packet.
+ *
+ * @param context  The compression context
+ * @param msn      The SN of the next compressed packet
+ */
+void rohc_comp_rfc3095_set_next_msn(struct rohc_comp_ctxt *const context,
+                                    const uint32_t msn)
+{
+	struct rohc_comp_rfc3095_ctxt *const rfc3095_ctxt =
+		(struct rohc_comp_rfc3095_ctxt *) context->specific;
+
+	rfc3095_ctxt->sn = (msn == 0 ? 0xffff : (msn - 1) & 0xffff);
+}
+
+
 /**
  * @brief Decide the state that should be used for the next packet.
  *
@@ -1334,7 +1612,7 @@ void rohc_comp_rfc3095_decide_state(struct rohc_comp_ctxt *const context)
 		{
 			rohc_comp_debug(context, "no enough packets transmitted in IR state "
 			                "for the moment (%zu/%u), so stay in IR state",
-			                context->ir_count, MAX_IR_COUNT);
+			                (size_t) context->ir_count, MAX_IR_COUNT);
 			next_state = ROHC_COMP_STATE_IR;
 		}
 		else if(rfc3095_ctxt->tmp.send_static)
@@ -1374,7 +1652,7 @@ void rohc_comp_rfc3095_decide_state(struct rohc_comp_ctxt *const context)
 		{
 			rohc_comp_debug(context, "no enough packets transmitted in FO state "
 			                "for the moment (%zu/%u), so stay in FO state",
-			                context->fo_count, MAX_FO_COUNT);
+			                (size_t) context->fo_count, MAX_FO_COUNT);
 			next_state = ROHC_COMP_STATE_FO;
 		}
 		else if(rfc3095_ctxt->tmp.send_static || rfc3095_ctxt->tmp.send_dynamic)
@@ -1672,6 +1950,7 @@ static int code_IR_packet(struct rohc_comp_ctxt *const context,
 	size_t counter;
 	size_t first_position;
 	int crc_position;
+	rohc_ticks_t crc_ticks;
 	int ret;
 
 	assert(rfc3095_ctxt->tmp.nr_sn_bits_more_than_4 <= 16);
@@ -1692,8 +1971,8 @@ static int code_IR_packet(struct rohc_comp_ctxt *const context,
 	 *  - part 2 will be placed at 'first_position'
 	 *  - part 4 will start at 'counter'
 	 */
-	ret = code_cid_values(context->compressor->medium.cid_type, context->cid,
-	                      rohc_pkt, rohc_pkt_max_len, &first_position);
+	ret = code_cid_values(&context->cid_code, rohc_pkt, rohc_pkt_max_len,
+	                      &first_position);
 	if(ret < 1)
 	{
 		rohc_comp_warn(context, "failed to encode %s CID %zu: maybe the "
@@ -1781,9 +2060,10 @@ static int code_IR_packet(struct rohc_comp_ctxt *const context,
 	}
 
 	/* part 5 */
+	crc_ticks = rohc_comp_ticks(context->compressor);
 	rohc_pkt[crc_position] = crc_calculate(ROHC_CRC_TYPE_8, rohc_pkt, counter,
-	                                       CRC_INIT_8,
-	                                       context->compressor->crc_table_8);
+	                                       CRC_INIT_8);
+	rohc_comp_crc_ticks_add(context->compressor, crc_ticks);
 	rohc_comp_debug(context, "CRC (header length = %zu, crc = 0x%x)",
 	                counter, rohc_pkt[crc_position]);
 
@@ -1844,6 +2124,7 @@ static int code_IR_DYN_packet(struct rohc_comp_ctxt *const context,
 	size_t counter;
 	size_t first_position;
 	int crc_position;
+	rohc_ticks_t crc_ticks;
 	int ret;
 
 	assert(context != NULL);
@@ -1859,8 +2140,8 @@ static int code_IR_DYN_packet(struct rohc_comp_ctxt *const context,
 	 *  - part 2 will be placed at 'first_position'
 	 *  - part 4 will start at 'counter'
 	 */
-	ret = code_cid_values(context->compressor->medium.cid_type, context->cid,
-	                      rohc_pkt, rohc_pkt_max_len, &first_position);
+	ret = code_cid_values(&context->cid_code, rohc_pkt, rohc_pkt_max_len,
+	                      &first_position);
 	if(ret < 1)
 	{
 		rohc_comp_warn(context, "failed to encode %s CID %zu: maybe the "
@@ -1925,9 +2206,10 @@ static int code_IR_DYN_packet(struct rohc_comp_ctxt *const context,
 	}
 
 	/* part 5 */
+	crc_ticks = rohc_comp_ticks(context->compressor);
 	rohc_pkt[crc_position] = crc_calculate(ROHC_CRC_TYPE_8, rohc_pkt, counter,
-	                                       CRC_INIT_8,
-	                                       context->compressor->crc_table_8);
+	                                       CRC_INIT_8);
+	rohc_comp_crc_ticks_add(context->compressor, crc_ticks);
 	rohc_comp_debug(context, "CRC (header length = %zu, crc = 0x%x)",
 	                counter, rohc_pkt[crc_position]);
 
@@ -1954,8 +2236,26 @@ static int rohc_code_static_part(const struct rohc_comp_ctxt *const context,
 {
 	struct rohc_comp_rfc3095_ctxt *const rfc3095_ctxt =
 		(struct rohc_comp_rfc3095_ctxt *) context->specific;
+	const int static_chain_start = counter;
 	int ret;
 
+	/* reuse the static chain of the previous IR packet if possible, the
+	 * counters of the Protocol / Next Header fields are updated as if the
+	 * fields were encoded again */
+	if(rfc3095_ctxt->static_chain_len > 0)
+	{
+		memcpy(rohc_pkt + counter, rfc3095_ctxt->static_chain,
+		       rfc3095_ctxt->static_chain_len);
+		rfc3095_ctxt->outer_ip_flags.protocol_count++;
+		if(uncomp_pkt->ip_hdr_nr > 1)
+		{
+			rfc3095_ctxt->inner_ip_flags.protocol_count++;
+		}
+		rohc_comp_debug(context, "reuse the %zu-byte static chain of the previous "
+		                "IR packet", rfc3095_ctxt->static_chain_len);
+		return counter + rfc3095_ctxt->static_chain_len;
+	}
+
 	/* static part of the outer IP header */
 	ret = rohc_code_static_ip_part(context, &rfc3095_ctxt->outer_ip_flags,
 	                               &uncomp_pkt->outer_ip, rohc_pkt, counter);
@@ -1990,6 +2290,14 @@ static int rohc_code_static_part(const struct rohc_comp_ctxt *const context,
 		counter = ret;
 	}
 
+	/* cache the static chain for the next IR packets */
+	if(((size_t) (counter - static_chain_start)) <= ROHC_COMP_RFC3095_STATIC_CHAIN_MAX_LEN)
+	{
+		rfc3095_ctxt->static_chain_len = counter - static_chain_start;
+		memcpy(rfc3095_ctxt->static_chain, rohc_pkt + static_chain_start,
+		       rfc3095_ctxt->static_chain_len);
+	}
+
 	return counter;
 
 error:
@@ -2633,8 +2941,8 @@ static int code_UO0_packet(struct rohc_comp_ctxt *const context,
 	 *  - part 2 will be placed at 'first_position'
 	 *  - part 4 will start at 'counter'
 	 */
-	ret = code_cid_values(context->compressor->medium.cid_type, context->cid,
-	                      rohc_pkt, rohc_pkt_max_len, &first_position);
+	ret = code_cid_values(&context->cid_code, rohc_pkt, rohc_pkt_max_len,
+	                      &first_position);
 	if(ret < 1)
 	{
 		rohc_comp_warn(context, "failed to encode %s CID %zu: maybe the "
@@ -2660,8 +2968,7 @@ static int code_UO0_packet(struct rohc_comp_ctxt *const context,
 	 * if the CRC-STATIC fields did not change */
 	assert(rfc3095_ctxt->tmp.nr_sn_bits_less_equal_than_4 <= 4);
 	f_byte = (rfc3095_ctxt->sn & 0x0f) << 3;
-	crc = compute_uo_crc(rfc3095_ctxt, uncomp_pkt, ROHC_CRC_TYPE_3, CRC_INIT_3,
-	                     context->compressor->crc_table_3);
+	crc = compute_uo_crc(context, uncomp_pkt, ROHC_CRC_TYPE_3, CRC_INIT_3);
 	f_byte |= crc;
 	rohc_comp_debug(context, "first byte = 0x%02x (CRC = 0x%x)", f_byte, crc);
 	rohc_pkt[first_position] = f_byte;
@@ -2769,8 +3076,8 @@ static int rohc_comp_rfc3095_build_uo1_pkt(struct rohc_comp_ctxt *const context,
 	/* parts 1 and 3:
 	 *  - part 2 will be placed at 'first_position'
 	 *  - part 4 will start at 'counter' */
-	ret = code_cid_values(context->compressor->medium.cid_type, context->cid,
-	                      rohc_pkt, rohc_pkt_max_len, &first_position);
+	ret = code_cid_values(&context->cid_code, rohc_pkt, rohc_pkt_max_len,
+	                      &first_position);
 	if(ret < 1)
 	{
 		rohc_comp_warn(context, "failed to encode %s CID %zu: maybe the "
@@ -2803,8 +3110,7 @@ static int rohc_comp_rfc3095_build_uo1_pkt(struct rohc_comp_ctxt *const context,
 		rohc_comp_warn(context, "ROHC packet is too small for SN/CRC byte");
 		goto error;
 	}
-	crc = compute_uo_crc(rfc3095_ctxt, uncomp_pkt, ROHC_CRC_TYPE_3, CRC_INIT_3,
-	                     context->compressor->crc_table_3);
+	crc = compute_uo_crc(context, uncomp_pkt, ROHC_CRC_TYPE_3, CRC_INIT_3);
 	rohc_pkt[counter] = ((rfc3095_ctxt->sn & 0x1f) << 3) | (crc & 0x07);
 	rohc_comp_debug(context, "SN (%d) + CRC (%x) = 0x%02x",
 	                rfc3095_ctxt->sn, crc, rohc_pkt[counter]);
@@ -2904,8 +3210,8 @@ static int rohc_comp_rfc3095_build_uo1rtp_pkt(struct rohc_comp_ctxt *const conte
 	/* parts 1 and 3:
 	 *  - part 2 will be placed at 'first_position'
 	 *  - part 4 will start at 'counter' */
-	ret = code_cid_values(context->compressor->medium.cid_type, context->cid,
-	                      rohc_pkt, rohc_pkt_max_len, &first_position);
+	ret = code_cid_values(&context->cid_code, rohc_pkt, rohc_pkt_max_len,
+	                      &first_position);
 	if(ret < 1)
 	{
 		rohc_comp_warn(context, "failed to encode %s CID %zu: maybe the "
@@ -2940,8 +3246,7 @@ static int rohc_comp_rfc3095_build_uo1rtp_pkt(struct rohc_comp_ctxt *const conte
 	}
 	rohc_pkt[counter] = ((!!rtp_context->tmp.is_marker_bit_set) & 0x01) << 7;
 	rohc_pkt[counter] |= (rfc3095_ctxt->sn & 0x0f) << 3;
-	crc = compute_uo_crc(rfc3095_ctxt, uncomp_pkt, ROHC_CRC_TYPE_3, CRC_INIT_3,
-	                     context->compressor->crc_table_3);
+	crc = compute_uo_crc(context, uncomp_pkt, ROHC_CRC_TYPE_3, CRC_INIT_3);
 	rohc_pkt[counter] |= crc & 0x07;
 	rohc_comp_debug(context, "M (%d) + SN (%d) + CRC (%x) = 0x%02x",
 	                !!rtp_context->tmp.is_marker_bit_set,
@@ -3053,8 +3358,8 @@ static int rohc_comp_rfc3095_build_uo1ts_pkt(struct rohc_comp_ctxt *const contex
 	/* parts 1 and 3:
 	 *  - part 2 will be placed at 'first_position'
 	 *  - part 4 will start at 'counter' */
-	ret = code_cid_values(context->compressor->medium.cid_type, context->cid,
-	                      rohc_pkt, rohc_pkt_max_len, &first_position);
+	ret = code_cid_values(&context->cid_code, rohc_pkt, rohc_pkt_max_len,
+	                      &first_position);
 	if(ret < 1)
 	{
 		rohc_comp_warn(context, "failed to encode %s CID %zu: maybe the "
@@ -3088,8 +3393,7 @@ static int rohc_comp_rfc3095_build_uo1ts_pkt(struct rohc_comp_ctxt *const contex
 		rohc_comp_warn(context, "ROHC packet is too small for SN/CRC byte");
 		goto error;
 	}
-	crc = compute_uo_crc(rfc3095_ctxt, uncomp_pkt, ROHC_CRC_TYPE_3, CRC_INIT_3,
-	                     context->compressor->crc_table_3);
+	crc = compute_uo_crc(context, uncomp_pkt, ROHC_CRC_TYPE_3, CRC_INIT_3);
 	rohc_pkt[counter] = ((!!rtp_context->tmp.is_marker_bit_set) & 0x01) << 7;
 	rohc_pkt[counter] |= (rfc3095_ctxt->sn & 0x0f) << 3;
 	rohc_pkt[counter] |= crc & 0x07;
@@ -3212,8 +3516,8 @@ static int rohc_comp_rfc3095_build_uo1id_pkt(struct rohc_comp_ctxt *const contex
 	/* parts 1 and 3:
 	 *  - part 2 will be placed at 'first_position'
 	 *  - part 4 will start at 'counter' */
-	ret = code_cid_values(context->compressor->medium.cid_type, context->cid,
-	                      rohc_pkt, rohc_pkt_max_len, &first_position);
+	ret = code_cid_values(&context->cid_code, rohc_pkt, rohc_pkt_max_len,
+	                      &first_position);
 	if(ret < 1)
 	{
 		rohc_comp_warn(context, "failed to encode %s CID %zu: maybe the "
@@ -3359,8 +3663,7 @@ static int rohc_comp_rfc3095_build_uo1id_pkt(struct rohc_comp_ctxt *const contex
 		rohc_comp_warn(context, "ROHC packet is too small for SN/CRC byte");
 		goto error;
 	}
-	crc = compute_uo_crc(rfc3095_ctxt, uncomp_pkt, ROHC_CRC_TYPE_3, CRC_INIT_3,
-	                     context->compressor->crc_table_3);
+	crc = compute_uo_crc(context, uncomp_pkt, ROHC_CRC_TYPE_3, CRC_INIT_3);
 	s_byte = crc & 0x07;
 	switch(extension)
 	{
@@ -3608,8 +3911,8 @@ static int code_UO2_packet(struct rohc_comp_ctxt *const context,
 	 *  - part 2 will be placed at 'first_position'
 	 *  - parts 4/5 will start at 'counter'
 	 */
-	ret = code_cid_values(context->compressor->medium.cid_type, context->cid,
-	                      rohc_pkt, rohc_pkt_max_len, &first_position);
+	ret = code_cid_values(&context->cid_code, rohc_pkt, rohc_pkt_max_len,
+	                      &first_position);
 	if(ret < 1)
 	{
 		rohc_comp_warn(context, "failed to encode %s CID %zu: maybe the "
@@ -3646,8 +3949,7 @@ static int code_UO2_packet(struct rohc_comp_ctxt *const context,
 	 *
 	 * TODO: The CRC should be computed only on the CRC-DYNAMIC fields
 	 * if the CRC-STATIC fields did not change */
-	t_byte = compute_uo_crc(rfc3095_ctxt, uncomp_pkt, ROHC_CRC_TYPE_7, CRC_INIT_7,
-	                        context->compressor->crc_table_7);
+	t_byte = compute_uo_crc(context, uncomp_pkt, ROHC_CRC_TYPE_7, CRC_INIT_7);
 	t_byte_position = counter;
 	counter++;
 
@@ -5163,6 +5465,7 @@ static int code_EXT3_rtp_packet(struct rohc_comp_ctxt *const context,
 	uint32_t ts_send; /* TS to send */
 	size_t nr_ts_bits; /* nr of TS bits needed */
 	size_t nr_ts_bits_ext3; /* nr of TS bits to place in the EXT3 header */
+	const struct rfc3095_ext_limits *base_limits;
 
 	rfc3095_ctxt = (struct rohc_comp_rfc3095_ctxt *) context->specific;
 	nr_of_ip_hdr = uncomp_pkt->ip_hdr_nr;
@@ -5177,6 +5480,10 @@ static int code_EXT3_rtp_packet(struct rohc_comp_ctxt *const context,
 	       packet_type == ROHC_PACKET_UOR_2_ID);
 	assert(is_rtp);
 
+	base_limits = rfc3095_get_ext_limits(packet_type);
+	assert(base_limits != NULL);
+	assert(base_limits->ext == ROHC_EXT_NONE);
+
 	rtp_context = (struct sc_rtp_context *) rfc3095_ctxt->specific;
 	ts_send = rtp_context->tmp.ts_send;
 	nr_ts_bits = rtp_context->tmp.nr_ts_bits_more_than_2;
@@ -5206,48 +5513,27 @@ static int code_EXT3_rtp_packet(struct rohc_comp_ctxt *const context,
 		outer_ip_changed_fields = rfc3095_ctxt->tmp.changed_fields;
 	}
 
-	/* S bit */
-	if(packet_type == ROHC_PACKET_UO_1_ID)
-	{
-		S = !(rfc3095_ctxt->tmp.nr_sn_bits_less_equal_than_4 <= 4);
-	}
-	else
-	{
-		S = (rfc3095_ctxt->tmp.nr_sn_bits_more_than_4 > 6);
-	}
+	/* S and R-TS bits: the SN and TS bits that the base header cannot
+	 * transmit alone, see the first row of the extension limits */
+	S = !rfc3095_sn_fits_ext(&rfc3095_ctxt->tmp, base_limits);
+	rts = (nr_ts_bits > base_limits->ts_bits_max);
 
-	/* R-TS bit */
-	switch(packet_type)
+	/* force sending some TS bits in extension 3 if TS is not scaled (Tsc = 0)
+	 * and the base header contains zero bit (UOR-2-ID and UO-1-ID) */
+	if(!rts && (base_limits->flags & EXT_LIMITS_TS_DEDUCIBLE) != 0 &&
+	   rtp_context->ts_sc.state != SEND_SCALED)
 	{
-		case ROHC_PACKET_UOR_2_RTP:
-			rts = (nr_ts_bits > 6);
-			break;
-		case ROHC_PACKET_UOR_2_TS:
-			rts = (nr_ts_bits > 5);
-			break;
-		case ROHC_PACKET_UOR_2_ID:
-		case ROHC_PACKET_UO_1_ID:
-			rts = (nr_ts_bits > 0);
-			/* force sending some TS bits in extension 3 if TS is not scaled
-			 * (Tsc = 0) and the base header contains zero bit */
-			if(!rts && rtp_context->ts_sc.state != SEND_SCALED)
-			{
-				rohc_comp_debug(context, "force R-TS = 1 because Tsc = 0 and "
-				                "base header contains no TS bit");
-				assert(nr_ts_bits_ext3 == 0);
-				rts = 1;
-				/* as field is SDVL-encoded, send as many bits as possible
-				 * in one byte */
-				nr_ts_bits_ext3 = ROHC_SDVL_MAX_BITS_IN_1_BYTE;
-				/* retrieve unscaled TS because we lost it when the UO* base
-				 * header was built */
-				ts_send = get_ts_unscaled(&rtp_context->ts_sc);
-				ts_send &= (1U << nr_ts_bits_ext3) - 1;
-			}
-			break;
-		default:
-			rohc_assert(context->compressor, ROHC_TRACE_COMP, context->profile->id,
-			            false, error, "bad packet type (%d)", packet_type);
+		rohc_comp_debug(context, "force R-TS = 1 because Tsc = 0 and base "
+		                "header contains no TS bit");
+		assert(nr_ts_bits_ext3 == 0);
+		rts = 1;
+		/* as field is SDVL-encoded, send as many bits as possible in one
+		 * byte */
+		nr_ts_bits_ext3 = ROHC_SDVL_MAX_BITS_IN_1_BYTE;
+		/* retrieve unscaled TS because we lost it when the UO* base header
+		 * was built */
+		ts_send = get_ts_unscaled(&rtp_context->ts_sc);
+		ts_send &= (1U << nr_ts_bits_ext3) - 1;
 	}
 
 	/* Tsc bit */
@@ -5518,8 +5804,9 @@ static int code_EXT3_nortp_packet(struct rohc_comp_ctxt *const context,
 		outer_ip_changed_fields = rfc3095_ctxt->tmp.changed_fields;
 	}
 
-	/* S bit */
-	S = (rfc3095_ctxt->tmp.nr_sn_bits_more_than_4 > 5);
+	/* S bit: the SN bits that the base header cannot transmit alone, see the
+	 * first row of the extension limits */
+	S = !rfc3095_sn_fits_ext(&rfc3095_ctxt->tmp, c_ext_limits_uor2);
 
 	/* ip2 bit (force ip2=1 if I2=1, otherwise I2 is not sent) */
 	if(nr_of_ip_hdr == 1)
@@ -5997,27 +6284,125 @@ static int header_fields(const struct rohc_comp_ctxt *const context,
 }
 
 
+/**
+ * @brief Define the computation of the CRC for UO* packets specialized for
+ *        one profile and one number of IP headers
+ *
+ * The CRC functions of the profile are called directly and the number of IP
+ * headers is known at build time: the common IP/transport combinations get
+ * no indirect call and no branch on the number of IP headers.
+ *
+ * @param name         The name of the function to define
+ * @param ip_hdr_nr    The number of IP headers (1 or 2)
+ * @param static_fn    The function that computes the CRC on CRC-STATIC fields
+ * @param dynamic_fn   The function that computes the CRC on CRC-DYNAMIC fields
+ */
+#define ROHC_COMP_RFC3095_UO_CRC(name, ip_hdr_nr, static_fn, dynamic_fn) \
+	static uint8_t name(struct rohc_comp_rfc3095_ctxt *const rfc3095_ctxt, \
+	                    const struct net_pkt *const uncomp_pkt, \
+	                    const rohc_crc_type_t crc_type, \
+	                    const uint8_t crc_init) \
+	{ \
+		const uint8_t *const outer_ip_hdr = ip_get_raw_data(&uncomp_pkt->outer_ip); \
+		const uint8_t *const inner_ip_hdr = \
+			((ip_hdr_nr) > 1 ? ip_get_raw_data(&uncomp_pkt->inner_ip) : NULL); \
+		const uint8_t *const next_header = uncomp_pkt->transport->data; \
+		uint8_t crc = crc_init; \
+		\
+		/* compute CRC on CRC-STATIC fields, the part on the IP headers is \
+		 * cached */ \
+		crc = static_fn(outer_ip_hdr, inner_ip_hdr, next_header, crc_type, crc, \
+		                &rfc3095_ctxt->crc_static); \
+		\
+		/* compute CRC on CRC-DYNAMIC fields */ \
+		crc = dynamic_fn(outer_ip_hdr, inner_ip_hdr, next_header, crc_type, crc); \
+		\
+		return crc; \
+	}
+
+ROHC_COMP_RFC3095_UO_CRC(compute_uo_crc_rtp_1hdr, 1,
+                         rtp_compute_crc_static, rtp_compute_crc_dynamic)
+ROHC_COMP_RFC3095_UO_CRC(compute_uo_crc_rtp_2hdrs, 2,
+                         rtp_compute_crc_static, rtp_compute_crc_dynamic)
+ROHC_COMP_RFC3095_UO_CRC(compute_uo_crc_udp_1hdr, 1,
+                         udp_compute_crc_static, udp_compute_crc_dynamic)
+ROHC_COMP_RFC3095_UO_CRC(compute_uo_crc_esp_1hdr, 1,
+                         esp_compute_crc_static, esp_compute_crc_dynamic)
+
+
 /**
  * @brief Compute the CRC for a UO* packet
  *
- * @param rfc3095_ctxt   The generic compression context
+ * The duration of the computation is accounted to the CRC phase of the
+ * packet if the compressor measures the durations of the compression phases.
+ *
+ * @param context     The compression context
  * @param uncomp_pkt  The uncompressed packet to encode
  * @param crc_type    The type of CRC to compute
  * @param crc_init    The initial value of the CRC
- * @param crc_table   The table of pre-computed CRC
  * @return            The computed CRC
  */
-static uint8_t compute_uo_crc(const struct rohc_comp_rfc3095_ctxt *rfc3095_ctxt,
+static uint8_t compute_uo_crc(struct rohc_comp_ctxt *const context,
                               const struct net_pkt *const uncomp_pkt,
                               const rohc_crc_type_t crc_type,
-                              const uint8_t crc_init,
-                              const uint8_t *const crc_table)
+                              const uint8_t crc_init)
+{
+	const rohc_ticks_t crc_ticks = rohc_comp_ticks(context->compressor);
+	uint8_t crc;
+
+	crc = compute_uo_crc_fields(context->specific, uncomp_pkt, crc_type,
+	                            crc_init);
+	rohc_comp_crc_ticks_add(context->compressor, crc_ticks);
+
+	return crc;
+}
+
+
+/**
+ * @brief Compute the CRC for a UO* packet on the fields of the headers
+ *
+ * The CRC functions of the profile are compared against the ones of the
+ * common IP/transport combinations to call a specialized computation.
+ * The other combinations use the CRC functions of the profile indirectly.
+ *
+ * @param rfc3095_ctxt   The generic compression context
+ * @param uncomp_pkt  The uncompressed packet to encode
+ * @param crc_type    The type of CRC to compute
+ * @param crc_init    The initial value of the CRC
+ * @return            The computed CRC
+ */
+static uint8_t compute_uo_crc_fields(struct rohc_comp_rfc3095_ctxt *const rfc3095_ctxt,
+                                     const struct net_pkt *const uncomp_pkt,
+                                     const rohc_crc_type_t crc_type,
+                                     const uint8_t crc_init)
 {
 	const uint8_t *outer_ip_hdr;
 	const uint8_t *inner_ip_hdr;
 	const uint8_t *next_header;
 	uint8_t crc = crc_init;
 
+	if(rfc3095_ctxt->compute_crc_dynamic == rtp_compute_crc_dynamic)
+	{
+		assert(rfc3095_ctxt->compute_crc_static == rtp_compute_crc_static);
+		if(uncomp_pkt->ip_hdr_nr == 1)
+		{
+			return compute_uo_crc_rtp_1hdr(rfc3095_ctxt, uncomp_pkt, crc_type, crc_init);
+		}
+		return compute_uo_crc_rtp_2hdrs(rfc3095_ctxt, uncomp_pkt, crc_type, crc_init);
+	}
+	else if(rfc3095_ctxt->compute_crc_dynamic == udp_compute_crc_dynamic &&
+	        uncomp_pkt->ip_hdr_nr == 1)
+	{
+		assert(rfc3095_ctxt->compute_crc_static == udp_compute_crc_static);
+		return compute_uo_crc_udp_1hdr(rfc3095_ctxt, uncomp_pkt, crc_type, crc_init);
+	}
+	else if(rfc3095_ctxt->compute_crc_dynamic == esp_compute_crc_dynamic &&
+	        uncomp_pkt->ip_hdr_nr == 1)
+	{
+		assert(rfc3095_ctxt->compute_crc_static == esp_compute_crc_static);
+		return compute_uo_crc_esp_1hdr(rfc3095_ctxt, uncomp_pkt, crc_type, crc_init);
+	}
+
 	outer_ip_hdr = ip_get_raw_data(&uncomp_pkt->outer_ip);
 	if(uncomp_pkt->ip_hdr_nr > 1)
 	{
@@ -6029,13 +6414,13 @@ static uint8_t compute_uo_crc(const struct rohc_comp_rfc3095_ctxt *rfc3095_ctxt,
 	}
 	next_header = uncomp_pkt->transport->data;
 
-	/* compute CRC on CRC-STATIC fields */
+	/* compute CRC on CRC-STATIC fields, the part on the IP headers is cached */
 	crc = rfc3095_ctxt->compute_crc_static(outer_ip_hdr, inner_ip_hdr, next_header,
-	                                       crc_type, crc, crc_table);
+	                                       crc_type, crc, &rfc3095_ctxt->crc_static);
 
 	/* compute CRC on CRC-DYNAMIC fields */
 	crc = rfc3095_ctxt->compute_crc_dynamic(outer_ip_hdr, inner_ip_hdr, next_header,
-	                                        crc_type, crc, crc_table);
+	                                        crc_type, crc);
 
 	return crc;
 }
@@ -6563,55 +6948,59 @@ static void detect_ip_id_behaviour(const struct rohc_comp_ctxt *const context,
 		/* we have seen at least one header before this one, so we can (try to)
 		 * detect IP-ID behaviour */
 
-		uint16_t old_id; /* the IP-ID of the previous IPv4 header */
-		uint16_t new_id; /* the IP-ID of the IPv4 header being compressed */
-
-		old_id = rohc_ntoh16(header_info->info.v4.old_ip.id);
-		new_id = rohc_ntoh16(ipv4_get_id(ip));
+		const uint16_t old_id = rohc_ntoh16(header_info->info.v4.old_ip.id);
+		const uint16_t new_id = rohc_ntoh16(ipv4_get_id(ip));
+		rohc_ip_id_behavior_t last_behavior;
 
-		rohc_comp_debug(context, "1) old_id = 0x%04x new_id = 0x%04x",
+		rohc_comp_debug(context, "old_id = 0x%04x new_id = 0x%04x",
 		                old_id, new_id);
 
-		if(new_id == old_id)
+		if(header_info->info.v4.rnd)
+		{
+			last_behavior = ROHC_IP_ID_RAND;
+		}
+		else if(header_info->info.v4.sid)
 		{
-			/* previous and current IP-ID values are equal: IP-ID is constant */
-			rohc_comp_debug(context, "IP-ID is constant (SID detected)");
-			header_info->info.v4.rnd = 0;
-			header_info->info.v4.nbo = 1;
-			header_info->info.v4.sid = 1;
+			last_behavior = ROHC_IP_ID_CONST;
 		}
-		else if(is_ip_id_increasing(old_id, new_id))
+		else if(header_info->info.v4.nbo)
 		{
-			/* IP-ID is increasing in NBO */
-			rohc_comp_debug(context, "IP-ID is increasing in NBO");
-			header_info->info.v4.rnd = 0;
-			header_info->info.v4.nbo = 1;
-			header_info->info.v4.sid = 0;
+			last_behavior = ROHC_IP_ID_SEQ;
 		}
 		else
 		{
-			/* change byte ordering and check behaviour again */
-			old_id = swab16(old_id);
-			new_id = swab16(new_id);
-
-			rohc_comp_debug(context, "2) old_id = 0x%04x new_id = 0x%04x",
-			                old_id, new_id);
+			last_behavior = ROHC_IP_ID_SEQ_SWAP;
+		}
 
-			if(is_ip_id_increasing(old_id, new_id))
-			{
-				/* IP-ID is increasing in Little Endian */
+		switch(rohc_ip_id_classify(last_behavior, old_id, new_id))
+		{
+			case ROHC_IP_ID_CONST:
+				/* previous and current IP-ID values are equal: IP-ID is constant */
+				rohc_comp_debug(context, "IP-ID is constant (SID detected)");
+				header_info->info.v4.rnd = 0;
+				header_info->info.v4.nbo = 1;
+				header_info->info.v4.sid = 1;
+				break;
+			case ROHC_IP_ID_SEQ:
+				rohc_comp_debug(context, "IP-ID is increasing in NBO");
+				header_info->info.v4.rnd = 0;
+				header_info->info.v4.nbo = 1;
+				header_info->info.v4.sid = 0;
+				break;
+			case ROHC_IP_ID_SEQ_SWAP:
 				rohc_comp_debug(context, "IP-ID is increasing in Little Endian");
 				header_info->info.v4.rnd = 0;
 				header_info->info.v4.nbo = 0;
 				header_info->info.v4.sid = 0;
-			}
-			else
-			{
+				break;
+			case ROHC_IP_ID_ZERO:
+			case ROHC_IP_ID_RAND:
+			default:
 				rohc_comp_debug(context, "IP-ID is random (RND detected)");
 				header_info->info.v4.rnd = 1;
 				header_info->info.v4.nbo = 1; /* do not change bit order if RND */
 				header_info->info.v4.sid = 0;
-			}
+				break;
 		}
 	}
 
@@ -6658,14 +7047,14 @@ static bool encode_uncomp_fields(struct rohc_comp_ctxt *const context,
 		   context->profile->id == ROHC_PROFILE_ESP)
 		{
 			rfc3095_ctxt->tmp.nr_sn_bits_more_than_4 =
-				wlsb_get_mink_32bits(rfc3095_ctxt->sn_window, rfc3095_ctxt->sn, 5);
+				wlsb_get_mink_32bits(&rfc3095_ctxt->sn_window, rfc3095_ctxt->sn, 5);
 			rfc3095_ctxt->tmp.nr_sn_bits_less_equal_than_4 =
-				wlsb_get_kp_32bits(rfc3095_ctxt->sn_window, rfc3095_ctxt->sn, 1);
+				wlsb_get_kp_32bits(&rfc3095_ctxt->sn_window, rfc3095_ctxt->sn, 1);
 		}
 		else
 		{
 			rfc3095_ctxt->tmp.nr_sn_bits_more_than_4 =
-				wlsb_get_k_32bits(rfc3095_ctxt->sn_window, rfc3095_ctxt->sn);
+				wlsb_get_k_32bits(&rfc3095_ctxt->sn_window, rfc3095_ctxt->sn);
 			rfc3095_ctxt->tmp.nr_sn_bits_less_equal_than_4 =
 				rfc3095_ctxt->tmp.nr_sn_bits_more_than_4;
 		}
@@ -6677,9 +7066,13 @@ static bool encode_uncomp_fields(struct rohc_comp_ctxt *const context,
 		                "strictly larger than 4 bits",
 		                (rfc3095_ctxt->tmp.nr_sn_bits_more_than_4 > 4 ? "" : "not"),
 		                rfc3095_ctxt->tmp.nr_sn_bits_more_than_4);
+		context->sn_bits_nr =
+			(rfc3095_ctxt->tmp.nr_sn_bits_less_equal_than_4 <= 4 ?
+			 rfc3095_ctxt->tmp.nr_sn_bits_less_equal_than_4 :
+			 rfc3095_ctxt->tmp.nr_sn_bits_more_than_4);
 
 		/* add the new SN to the W-LSB encoding object */
-		c_add_wlsb(rfc3095_ctxt->sn_window, rfc3095_ctxt->sn, rfc3095_ctxt->sn);
+		c_add_wlsb(&rfc3095_ctxt->sn_window, rfc3095_ctxt->sn, rfc3095_ctxt->sn);
 	}
 
 	/* update info related to the IP-ID of the outer header
@@ -6711,14 +7104,14 @@ static bool encode_uncomp_fields(struct rohc_comp_ctxt *const context,
 		{
 			/* send only required bits in FO or SO states */
 			rfc3095_ctxt->tmp.nr_ip_id_bits =
-				wlsb_get_k_16bits(rfc3095_ctxt->outer_ip_flags.info.v4.ip_id_window,
+				wlsb_get_k_16bits(&rfc3095_ctxt->outer_ip_flags.info.v4.ip_id_window,
 				                  rfc3095_ctxt->outer_ip_flags.info.v4.id_delta);
 		}
 		rohc_comp_debug(context, "%zd bits are required to encode new outer "
 		                "IP-ID delta", rfc3095_ctxt->tmp.nr_ip_id_bits);
 
 		/* add the new IP-ID / SN delta to the W-LSB encoding object */
-		c_add_wlsb(rfc3095_ctxt->outer_ip_flags.info.v4.ip_id_window, rfc3095_ctxt->sn,
+		c_add_wlsb(&rfc3095_ctxt->outer_ip_flags.info.v4.ip_id_window, rfc3095_ctxt->sn,
 		           rfc3095_ctxt->outer_ip_flags.info.v4.id_delta);
 	}
 	else /* IPV6 */
@@ -6757,14 +7150,14 @@ static bool encode_uncomp_fields(struct rohc_comp_ctxt *const context,
 		{
 			/* send only required bits in FO or SO states */
 			rfc3095_ctxt->tmp.nr_ip_id_bits2 =
-				wlsb_get_k_16bits(rfc3095_ctxt->inner_ip_flags.info.v4.ip_id_window,
+				wlsb_get_k_16bits(&rfc3095_ctxt->inner_ip_flags.info.v4.ip_id_window,
 				                  rfc3095_ctxt->inner_ip_flags.info.v4.id_delta);
 		}
 		rohc_comp_debug(context, "%zd bits are required to encode new inner "
 		                "IP-ID delta", rfc3095_ctxt->tmp.nr_ip_id_bits2);
 
 		/* add the new IP-ID / SN delta to the W-LSB encoding object */
-		c_add_wlsb(rfc3095_ctxt->inner_ip_flags.info.v4.ip_id_window, rfc3095_ctxt->sn,
+		c_add_wlsb(&rfc3095_ctxt->inner_ip_flags.info.v4.ip_id_window, rfc3095_ctxt->sn,
 		           rfc3095_ctxt->inner_ip_flags.info.v4.id_delta);
 	}
 	else if(uncomp_pkt->ip_hdr_nr > 1) /* IPV6 */
@@ -6791,7 +7184,9 @@ error:
 /**
  * @brief Decide what extension shall be used in the UO-1-ID/UOR-2 packet.
  *
- * Extensions 0, 1 & 2 are IPv4 only because of the IP-ID.
+ * Extensions 0, 1 & 2 are IPv4 only because of the IP-ID. The extension is
+ * the first one of the packet type whose limits are met, see
+ * \ref rfc3095_ext_limits.
  *
  * @param context The compression context
  * @return        The extension code among ROHC_EXT_NONE, ROHC_EXT_0,
@@ -6801,351 +7196,123 @@ error:
 rohc_ext_t decide_extension(const struct rohc_comp_ctxt *const context)
 {
 	const struct rohc_comp_rfc3095_ctxt *const rfc3095_ctxt = context->specific;
+	const struct rfc3095_ext_limits *limits;
 	size_t nr_innermost_ip_id_bits;
 	size_t nr_outermost_ip_id_bits;
+	size_t nr_ts_bits = 0;
+	bool is_ts_deducible = true;
+	bool is_marker_bit_set = false;
 	rohc_ext_t ext;
+	size_t i;
 
 	/* force extension type 3 if at least one static or dynamic field changed */
 	if(rfc3095_ctxt->tmp.send_static > 0 || rfc3095_ctxt->tmp.send_dynamic > 0)
 	{
 		rohc_comp_debug(context, "force EXT-3 because at least one static or "
 		                "dynamic field changed");
-		ext = ROHC_EXT_3;
+		return ROHC_EXT_3;
 	}
-	else
-	{
-		/* determine the number of IP-ID bits and the IP-ID offset of the
-		 * innermost IPv4 header with non-random IP-ID */
-		rohc_get_ipid_bits(context, &nr_innermost_ip_id_bits,
-		                   &nr_outermost_ip_id_bits);
-
-		switch(rfc3095_ctxt->tmp.packet_type)
-		{
-			case ROHC_PACKET_UOR_2:
-				ext = decide_extension_uor2(context, nr_innermost_ip_id_bits,
-				                            nr_outermost_ip_id_bits);
-				break;
-			case ROHC_PACKET_UOR_2_RTP:
-				ext = decide_extension_uor2rtp(context, nr_innermost_ip_id_bits,
-				                               nr_outermost_ip_id_bits);
-				break;
-			case ROHC_PACKET_UOR_2_TS:
-				ext = decide_extension_uor2ts(context, nr_innermost_ip_id_bits,
-				                              nr_outermost_ip_id_bits);
-				break;
-			case ROHC_PACKET_UOR_2_ID:
-				ext = decide_extension_uor2id(context, nr_innermost_ip_id_bits,
-				                              nr_outermost_ip_id_bits);
-				break;
-			case ROHC_PACKET_UO_1_ID:
-				ext = decide_extension_uo1id(context, nr_innermost_ip_id_bits,
-				                             nr_outermost_ip_id_bits);
-				break;
-			default:
-				rohc_assert(context->compressor, ROHC_TRACE_COMP, context->profile->id,
-				            false, error, "bad packet type (%d)",
-				            rfc3095_ctxt->tmp.packet_type);
-		}
-	}
-
-	return ext;
-
-error:
-	return ROHC_EXT_UNKNOWN;
-}
 
+	limits = rfc3095_get_ext_limits(rfc3095_ctxt->tmp.packet_type);
+	rohc_assert(context->compressor, ROHC_TRACE_COMP, context->profile->id,
+	            limits != NULL, error, "bad packet type (%d)",
+	            rfc3095_ctxt->tmp.packet_type);
 
-/**
- * @brief Decide what extension shall be used in the UOR-2 packet (non-RTP).
- *
- * Extensions 0, 1 & 2 are IPv4 only because of the IP-ID.
- *
- * @param context                  The compression context
- * @param nr_innermost_ip_id_bits  The number of IP-ID bits of the innermost
- *                                 IPv4 header
- * @param nr_outermost_ip_id_bits  The number of IP-ID bits of the outermost
- *                                 IPv4 header
- * @return                         The extension code among ROHC_EXT_NONE,
- *                                 ROHC_EXT_0, ROHC_EXT_1 and ROHC_EXT_3
- */
-static rohc_ext_t decide_extension_uor2(const struct rohc_comp_ctxt *const context,
-                                        const size_t nr_innermost_ip_id_bits,
-                                        const size_t nr_outermost_ip_id_bits)
-{
-	const struct rohc_comp_rfc3095_ctxt *const rfc3095_ctxt = context->specific;
-	rohc_ext_t ext;
+	/* determine the number of IP-ID bits and the IP-ID offset of the
+	 * innermost IPv4 header with non-random IP-ID */
+	rohc_get_ipid_bits(context, &nr_innermost_ip_id_bits,
+	                   &nr_outermost_ip_id_bits);
 
-	if(rfc3095_ctxt->tmp.nr_sn_bits_more_than_4 <= 5 &&
-	   nr_innermost_ip_id_bits == 0 &&
-	   nr_outermost_ip_id_bits == 0)
-	{
-		ext = ROHC_EXT_NONE;
-	}
-	else if(rfc3095_ctxt->tmp.nr_sn_bits_more_than_4 <= 8 &&
-	        nr_innermost_ip_id_bits != 0 && nr_innermost_ip_id_bits <= 3 &&
-	        nr_outermost_ip_id_bits == 0)
-	{
-		ext = ROHC_EXT_0;
-	}
-	else if(rfc3095_ctxt->tmp.nr_sn_bits_more_than_4 <= 8 &&
-	        nr_innermost_ip_id_bits != 0 && nr_innermost_ip_id_bits <= 11 &&
-	        nr_outermost_ip_id_bits == 0)
-	{
-		ext = ROHC_EXT_1;
-	}
-	else if(rfc3095_ctxt->ip_hdr_nr > 1 &&
-	        rfc3095_ctxt->tmp.nr_sn_bits_more_than_4 <= 8 &&
-	        nr_innermost_ip_id_bits != 0 && nr_innermost_ip_id_bits <= 8 &&
-	        nr_outermost_ip_id_bits <= 11)
-	{
-		ext = ROHC_EXT_2;
-	}
-	else
+	/* the RTP fields, only the UOR-2 packet is shared with other profiles */
+	if(rfc3095_ctxt->tmp.packet_type != ROHC_PACKET_UOR_2)
 	{
-		ext = ROHC_EXT_3;
+		const struct sc_rtp_context *const rtp_context = rfc3095_ctxt->specific;
+		nr_ts_bits = rtp_context->tmp.nr_ts_bits_more_than_2;
+		is_ts_deducible =
+			(nr_ts_bits == 0 || rohc_ts_sc_is_deducible(&rtp_context->ts_sc));
+		is_marker_bit_set = rtp_context->tmp.is_marker_bit_set;
 	}
 
-	return ext;
-}
-
-
-/**
- * @brief Decide what extension shall be used in the UOR-2 packet (RTP).
- *
- * Extensions 0, 1 & 2 are IPv4 only because of the IP-ID.
- *
- * @param context                  The compression context
- * @param nr_innermost_ip_id_bits  The number of IP-ID bits of the innermost
- *                                 IPv4 header
- * @param nr_outermost_ip_id_bits  The number of IP-ID bits of the outermost
- *                                 IPv4 header
- * @return                         The extension code among ROHC_EXT_NONE,
- *                                 ROHC_EXT_0, ROHC_EXT_1 and ROHC_EXT_3
- */
-static rohc_ext_t decide_extension_uor2rtp(const struct rohc_comp_ctxt *const context,
-                                           const size_t nr_innermost_ip_id_bits,
-                                           const size_t nr_outermost_ip_id_bits)
-{
-	const struct rohc_comp_rfc3095_ctxt *const rfc3095_ctxt = context->specific;
-	const struct sc_rtp_context *const rtp_context = rfc3095_ctxt->specific;
-	const size_t nr_ts_bits = rtp_context->tmp.nr_ts_bits_more_than_2;
-	rohc_ext_t ext;
-
-	if(rfc3095_ctxt->tmp.nr_sn_bits_more_than_4 <= 6 &&
-	   nr_ts_bits <= 6 &&
-	   nr_innermost_ip_id_bits == 0 &&
-	   nr_outermost_ip_id_bits == 0)
+	/* the first row whose limits are met gives the extension */
+	ext = ROHC_EXT_3;
+	for(i = 0; i < EXT_LIMITS_NR; i++)
 	{
-		ext = ROHC_EXT_NONE;
-	}
-	else if(rfc3095_ctxt->tmp.nr_sn_bits_more_than_4 <= 9 &&
-	        nr_ts_bits <= 9 &&
-	        nr_innermost_ip_id_bits == 0 &&
-	        nr_outermost_ip_id_bits == 0)
-	{
-		ext = ROHC_EXT_0;
-	}
-	else if(rfc3095_ctxt->tmp.nr_sn_bits_more_than_4 <= 9 &&
-	        nr_ts_bits <= 17 &&
-	        nr_innermost_ip_id_bits == 0 &&
-	        nr_outermost_ip_id_bits == 0)
-	{
-		ext = ROHC_EXT_1;
-	}
-	else if(rfc3095_ctxt->tmp.nr_sn_bits_more_than_4 <= 9 &&
-	        nr_ts_bits <= 25 &&
-	        nr_innermost_ip_id_bits == 0 &&
-	        nr_outermost_ip_id_bits == 0)
-	{
-		ext = ROHC_EXT_2;
-	}
-	else
-	{
-		ext = ROHC_EXT_3;
-	}
-
-	return ext;
-}
-
-
-/**
- * @brief Decide what extension shall be used in the UO-1-ID/UOR-2 packet.
- *
- * Extensions 0, 1 & 2 are IPv4 only because of the IP-ID.
- *
- * @param context                  The compression context
- * @param nr_innermost_ip_id_bits  The number of IP-ID bits of the innermost
- *                                 IPv4 header
- * @param nr_outermost_ip_id_bits  The number of IP-ID bits of the outermost
- *                                 IPv4 header
- * @return                         The extension code among ROHC_EXT_NONE,
- *                                 ROHC_EXT_0, ROHC_EXT_1 and ROHC_EXT_3
- */
-static rohc_ext_t decide_extension_uor2ts(const struct rohc_comp_ctxt *const context,
-                                          const size_t nr_innermost_ip_id_bits,
-                                          const size_t nr_outermost_ip_id_bits)
-{
-	const struct rohc_comp_rfc3095_ctxt *const rfc3095_ctxt = context->specific;
-	const struct sc_rtp_context *const rtp_context = rfc3095_ctxt->specific;
-	const size_t nr_ts_bits = rtp_context->tmp.nr_ts_bits_more_than_2;
-	rohc_ext_t ext;
+		const uint8_t flags = limits[i].flags;
 
-	if(rfc3095_ctxt->tmp.nr_sn_bits_more_than_4 <= 6 &&
-	   nr_ts_bits <= 5 &&
-	   nr_innermost_ip_id_bits == 0 &&
-	   nr_outermost_ip_id_bits == 0)
-	{
-		ext = ROHC_EXT_NONE;
-	}
-	else if(rfc3095_ctxt->tmp.nr_sn_bits_more_than_4 <= 9 &&
-	        nr_ts_bits <= 8 &&
-	        nr_innermost_ip_id_bits == 0 &&
-	        nr_outermost_ip_id_bits == 0)
-	{
-		ext = ROHC_EXT_0;
-	}
-	else if(rfc3095_ctxt->tmp.nr_sn_bits_more_than_4 <= 9 &&
-	        nr_ts_bits <= 8 &&
-	        nr_innermost_ip_id_bits <= 8 &&
-	        nr_outermost_ip_id_bits == 0)
-	{
-		ext = ROHC_EXT_1;
-	}
-	else if(rfc3095_ctxt->tmp.nr_sn_bits_more_than_4 <= 9 &&
-	        nr_ts_bits <= 16 &&
-	        nr_innermost_ip_id_bits <= 8 &&
-	        nr_outermost_ip_id_bits == 0)
-	{
-		ext = ROHC_EXT_2;
-	}
-	else
-	{
-		ext = ROHC_EXT_3;
+		if(rfc3095_sn_fits_ext(&rfc3095_ctxt->tmp, &limits[i]) &&
+		   ((flags & EXT_LIMITS_TS_DEDUCIBLE) != 0 ?
+		    is_ts_deducible : nr_ts_bits <= limits[i].ts_bits_max) &&
+		   nr_innermost_ip_id_bits >= limits[i].ip_id_bits_min &&
+		   nr_innermost_ip_id_bits <= limits[i].ip_id_bits_max &&
+		   nr_outermost_ip_id_bits <= limits[i].ip_id2_bits_max &&
+		   ((flags & EXT_LIMITS_NO_MARKER) == 0 || !is_marker_bit_set) &&
+		   ((flags & EXT_LIMITS_MULTIPLE_IP) == 0 || rfc3095_ctxt->ip_hdr_nr > 1))
+		{
+			ext = limits[i].ext;
+			break;
+		}
 	}
 
 	return ext;
+
+error:
+	return ROHC_EXT_UNKNOWN;
 }
 
 
 /**
- * @brief Decide what extension shall be used in the UOR-2-ID packet.
+ * @brief Get the extension limits of one UO-1-ID/UOR-2* packet type
  *
- * Extensions 0, 1 & 2 are IPv4 only because of the IP-ID.
- *
- * @param context                  The compression context
- * @param nr_innermost_ip_id_bits  The number of IP-ID bits of the innermost
- *                                 IPv4 header
- * @param nr_outermost_ip_id_bits  The number of IP-ID bits of the outermost
- *                                 IPv4 header
- * @return                         The extension code among ROHC_EXT_NONE,
- *                                 ROHC_EXT_0, ROHC_EXT_1 and ROHC_EXT_3
+ * @param packet_type  The type of ROHC packet
+ * @return             The \ref EXT_LIMITS_NR rows of extension limits,
+ *                     NULL if the packet type has no extension
  */
-static rohc_ext_t decide_extension_uor2id(const struct rohc_comp_ctxt *const context,
-                                          const size_t nr_innermost_ip_id_bits,
-                                          const size_t nr_outermost_ip_id_bits)
+static const struct rfc3095_ext_limits *
+	rfc3095_get_ext_limits(const rohc_packet_t packet_type)
 {
-	const struct rohc_comp_rfc3095_ctxt *const rfc3095_ctxt = context->specific;
-	const struct sc_rtp_context *const rtp_context = rfc3095_ctxt->specific;
-	const size_t nr_ts_bits = rtp_context->tmp.nr_ts_bits_more_than_2;
-	rohc_ext_t ext;
+	const struct rfc3095_ext_limits *limits;
 
-	if(rfc3095_ctxt->tmp.nr_sn_bits_more_than_4 <= 6 &&
-	   (nr_ts_bits == 0 || rohc_ts_sc_is_deducible(&rtp_context->ts_sc)) &&
-	   nr_innermost_ip_id_bits <= 5 &&
-	   nr_outermost_ip_id_bits == 0)
-	{
-		ext = ROHC_EXT_NONE;
-	}
-	else if(rfc3095_ctxt->tmp.nr_sn_bits_more_than_4 <= 9 &&
-	        (nr_ts_bits == 0 || rohc_ts_sc_is_deducible(&rtp_context->ts_sc)) &&
-	        nr_innermost_ip_id_bits <= 8 &&
-	        nr_outermost_ip_id_bits == 0)
-	{
-		ext = ROHC_EXT_0;
-	}
-	else if(rfc3095_ctxt->tmp.nr_sn_bits_more_than_4 <= 9 &&
-	        nr_ts_bits <= 8 &&
-	        nr_innermost_ip_id_bits <= 8 &&
-	        nr_outermost_ip_id_bits == 0)
-	{
-		ext = ROHC_EXT_1;
-	}
-	else if(rfc3095_ctxt->tmp.nr_sn_bits_more_than_4 <= 9 &&
-	        nr_ts_bits <= 8 &&
-	        nr_innermost_ip_id_bits <= 16 &&
-	        nr_outermost_ip_id_bits == 0)
-	{
-		ext = ROHC_EXT_2;
-	}
-	else
+	switch(packet_type)
 	{
-		ext = ROHC_EXT_3;
+		case ROHC_PACKET_UOR_2:
+			limits = c_ext_limits_uor2;
+			break;
+		case ROHC_PACKET_UOR_2_RTP:
+			limits = c_ext_limits_uor2rtp;
+			break;
+		case ROHC_PACKET_UOR_2_TS:
+			limits = c_ext_limits_uor2ts;
+			break;
+		case ROHC_PACKET_UOR_2_ID:
+			limits = c_ext_limits_uor2id;
+			break;
+		case ROHC_PACKET_UO_1_ID:
+			limits = c_ext_limits_uo1id;
+			break;
+		default:
+			limits = NULL;
+			break;
 	}
 
-	return ext;
+	return limits;
 }
 
 
 /**
- * @brief Decide what extension shall be used in the UO-1-ID packet.
+ * @brief Whether the SN bits fit in the given row of extension limits
  *
- * Extensions 0, 1 & 2 are IPv4 only because of the IP-ID.
- *
- * @param context                  The compression context
- * @param nr_innermost_ip_id_bits  The number of IP-ID bits of the innermost
- *                                 IPv4 header
- * @param nr_outermost_ip_id_bits  The number of IP-ID bits of the outermost
- *                                 IPv4 header
- * @return                         The extension code among ROHC_EXT_NONE,
- *                                 ROHC_EXT_0, ROHC_EXT_1 and ROHC_EXT_3
+ * @param tmp     The temporary variables of the packet being compressed
+ * @param limits  The row of extension limits
+ * @return        true if the SN bits fit, false otherwise
  */
-static rohc_ext_t decide_extension_uo1id(const struct rohc_comp_ctxt *const context,
-                                         const size_t nr_innermost_ip_id_bits,
-                                         const size_t nr_outermost_ip_id_bits)
+static bool rfc3095_sn_fits_ext(const struct generic_tmp_vars *const tmp,
+                                const struct rfc3095_ext_limits *const limits)
 {
-	const struct rohc_comp_rfc3095_ctxt *const rfc3095_ctxt = context->specific;
-	const struct sc_rtp_context *const rtp_context = rfc3095_ctxt->specific;
-	const size_t nr_ts_bits = rtp_context->tmp.nr_ts_bits_more_than_2;
-	rohc_ext_t ext;
-
-	if(rfc3095_ctxt->tmp.nr_sn_bits_less_equal_than_4 <= 4 &&
-	   (nr_ts_bits == 0 || rohc_ts_sc_is_deducible(&rtp_context->ts_sc)) &&
-	   nr_innermost_ip_id_bits <= 5 &&
-	   nr_outermost_ip_id_bits == 0 &&
-	   !rtp_context->tmp.is_marker_bit_set)
-	{
-		ext = ROHC_EXT_NONE;
-	}
-	else if(rfc3095_ctxt->tmp.nr_sn_bits_more_than_4 <= 7 &&
-	        (nr_ts_bits == 0 || rohc_ts_sc_is_deducible(&rtp_context->ts_sc)) &&
-	        nr_innermost_ip_id_bits <= 8 &&
-	        nr_outermost_ip_id_bits == 0 &&
-	        !rtp_context->tmp.is_marker_bit_set)
-	{
-		ext = ROHC_EXT_0;
-	}
-	else if(rfc3095_ctxt->tmp.nr_sn_bits_more_than_4 <= 7 &&
-	        nr_ts_bits <= 8 &&
-	        nr_innermost_ip_id_bits <= 8 &&
-	        nr_outermost_ip_id_bits == 0 &&
-	        !rtp_context->tmp.is_marker_bit_set)
-	{
-		ext = ROHC_EXT_1;
-	}
-	else if(rfc3095_ctxt->tmp.nr_sn_bits_more_than_4 <= 7 &&
-	        nr_ts_bits <= 8 &&
-	        nr_innermost_ip_id_bits <= 16 &&
-	        nr_outermost_ip_id_bits == 0 &&
-	        !rtp_context->tmp.is_marker_bit_set)
+	if((limits->flags & EXT_LIMITS_SN_LE_4) != 0)
 	{
-		ext = ROHC_EXT_2;
+		return (tmp->nr_sn_bits_less_equal_than_4 <= limits->sn_bits_max);
 	}
-	else
-	{
-		ext = ROHC_EXT_3;
-	}
-
-	return ext;
+	return (tmp->nr_sn_bits_more_than_4 <= limits->sn_bits_max);
 }
 
 
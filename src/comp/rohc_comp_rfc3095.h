@@ -32,12 +32,18 @@
 #include "rohc_comp_internals.h"
 #include "rohc_packets.h"
 #include "schemes/comp_list.h"
+#include "schemes/comp_wlsb.h"
 #include "ip.h"
 #include "crc.h"
 
 #include <stdlib.h>
 
 
+/** The max length of the static chain cached in every context: two IPv6
+ *  headers and the RTP static part */
+#define ROHC_COMP_RFC3095_STATIC_CHAIN_MAX_LEN  80U
+
+
 /**
  * @brief Store information about an IPv4 header between the different
  *        compressions of IP packets.
@@ -50,7 +56,7 @@
 struct ipv4_header_info
 {
 	/// A window to store the IP-ID
-	struct c_wlsb *ip_id_window;
+	struct c_wlsb ip_id_window;
 
 	/// The previous IP header
 	struct ipv4_hdr old_ip;
@@ -183,7 +189,7 @@ struct rohc_comp_rfc3095_ctxt
 	/// The Sequence Number (SN), may be 16-bit or 32-bit long
 	uint32_t sn;
 	/// A window used to encode the SN
-	struct c_wlsb *sn_window;
+	struct c_wlsb sn_window;
 
 	/** The number of IP headers */
 	size_t ip_hdr_nr;
@@ -195,6 +201,16 @@ struct rohc_comp_rfc3095_ctxt
 	/// Temporary variables that are used during one single compression of packet
 	struct generic_tmp_vars tmp;
 
+	/** The CRC-STATIC cached for the IP headers */
+	struct rohc_crc_static_cache crc_static;
+
+	/** The static chain of the last IR packet, reused by the next IR packets
+	 *  as long as the number of IP headers and their Protocol / Next Header
+	 *  fields do not change */
+	uint8_t static_chain[ROHC_COMP_RFC3095_STATIC_CHAIN_MAX_LEN];
+	/** The length of the cached static chain, 0 if not cached */
+	size_t static_chain_len;
+
 	/* below are some information and handlers to manage the next header
 	 * (if any) located just after the IP headers (1 or 2 IP headers) */
 
@@ -211,6 +227,11 @@ struct rohc_comp_rfc3095_ctxt
 	/// @brief The handler used to decide the state that should be used for the
 	///        next packet
 	void (*decide_state)(struct rohc_comp_ctxt *const context);
+	/** @brief The handler used to check whether the next header only moved
+	 *         along its steady pattern, NULL to never skip the detection of
+	 *         changes */
+	bool (*is_next_header_steady)(const struct rohc_comp_ctxt *const context)
+		__attribute__((warn_unused_result, nonnull(1)));
 	/** @brief The handler used to decide which packet to send in FO state */
 	rohc_packet_t (*decide_FO_packet)(const struct rohc_comp_ctxt *context);
 	/** @brief The handler used to decide which packet to send in SO state */
@@ -274,17 +295,16 @@ struct rohc_comp_rfc3095_ctxt
 	                              const uint8_t *const next_header,
 	                              const rohc_crc_type_t crc_type,
 	                              const uint8_t init_val,
-	                              const uint8_t *const crc_table)
-		__attribute__((nonnull(1, 3, 6), warn_unused_result));
+	                              struct rohc_crc_static_cache *const cache)
+		__attribute__((nonnull(1, 3), warn_unused_result));
 
 	/// @brief The handler used to compute the CRC-DYNAMIC value
 	uint8_t (*compute_crc_dynamic)(const uint8_t *const ip,
 	                               const uint8_t *const ip2,
 	                               const uint8_t *const next_header,
 	                               const rohc_crc_type_t crc_type,
-	                               const uint8_t init_val,
-	                               const uint8_t *const crc_table)
-		__attribute__((nonnull(1, 3, 6), warn_unused_result));
+	                               const uint8_t init_val)
+		__attribute__((nonnull(1, 3), warn_unused_result));
 
 	/// Profile-specific data
 	void *specific;
@@ -297,8 +317,9 @@ struct rohc_comp_rfc3095_ctxt
 
 bool rohc_comp_rfc3095_create(struct rohc_comp_ctxt *const context,
                               const rohc_lsb_shift_t sn_shift,
+                              const size_t specific_size,
                               const struct net_pkt *const packet)
-	__attribute__((warn_unused_result, nonnull(1, 3)));
+	__attribute__((warn_unused_result, nonnull(1, 4)));
 
 void rohc_comp_rfc3095_destroy(struct rohc_comp_ctxt *const context)
 	__attribute__((nonnull(1)));
@@ -326,6 +347,13 @@ bool rohc_comp_rfc3095_feedback(struct rohc_comp_ctxt *const context,
                                 const size_t feedback_data_len)
 	__attribute__((warn_unused_result, nonnull(1, 3, 5)));
 
+uint32_t rohc_comp_rfc3095_get_msn(const struct rohc_comp_ctxt *const context)
+	__attribute__((warn_unused_result, nonnull(1)));
+
+void rohc_comp_rfc3095_set_next_msn(struct rohc_comp_ctxt *const context,
+                                    const uint32_t msn)
+	__attribute__((nonnull(1)));
+
 void rohc_comp_rfc3095_decide_state(struct rohc_comp_ctxt *const context)
 	__attribute__((nonnull(1)));
 
@@ -0,0 +1,1926 @@
+/*
+ * Copyright 2016,2026 Didier Barvaux
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/**
+ * @file   rohc_comp_rfc5225.c
+ * @brief  Generic framework for RFC5225-based compression profiles such as
+ *         the ROHCv2 IP-only, UDP, ESP and RTP profiles
+ * @author Didier Barvaux <didier@barvaux.org>
+ *
+ * The framework compresses up to \ref ROHC_RFC5225_MAX_IP_HDRS IPv4 or IPv6
+ * headers without IP options nor IPv6 extension headers. The header that
+ * follows the IP headers is compressed by the profile-specific part of the
+ * context, if any (RFC5225 §6.8.2.4).
+ */
+
+#include "rohc_comp_rfc5225.h"
+#include "rohc_traces_internal.h"
+#include "rohc_utils.h"
+#include "net_pkt.h"
+#include "protocols/ip_numbers.h"
+#include "protocols/ipv4.h"
+#include "protocols/ipv6.h"
+#include "schemes/cid.h"
+#include "schemes/ip_id_offset.h"
+#include "crc.h"
+#include "rohc_bit_ops.h"
+
+#include <assert.h>
+#ifndef __KERNEL__
+#  include <string.h>
+#endif
+
+
+/*
+ * Prototypes of private functions
+ */
+
+/* encode uncompressed packets */
+static void rfc5225_detect_changes(struct rohc_comp_ctxt *const context,
+                                   const struct net_pkt *const uncomp_pkt)
+	__attribute__((nonnull(1, 2)));
+static void rfc5225_decide_state(struct rohc_comp_ctxt *const context)
+	__attribute__((nonnull(1)));
+static rohc_packet_t rfc5225_decide_pkt(struct rohc_comp_ctxt *const context)
+	__attribute__((warn_unused_result, nonnull(1)));
+static rohc_packet_t rfc5225_decide_FO_SO_pkt(const struct rohc_comp_ctxt *const context,
+                                              const bool crc7_only)
+	__attribute__((warn_unused_result, nonnull(1)));
+static void rfc5225_update_ctxt(struct rohc_comp_ctxt *const context,
+                                const struct net_pkt *const uncomp_pkt,
+                                const rohc_packet_t packet_type)
+	__attribute__((nonnull(1, 2)));
+
+/* IR packet */
+static int rfc5225_code_IR_pkt(const struct rohc_comp_ctxt *const context,
+                               const struct net_pkt *const uncomp_pkt,
+                               uint8_t *const rohc_pkt,
+                               const size_t rohc_pkt_max_len)
+	__attribute__((warn_unused_result, nonnull(1, 2, 3)));
+static int rfc5225_code_static_ip(const struct rohc_comp_ctxt *const context,
+                                  const uint8_t *const ip_data,
+                                  const bool is_innermost,
+                                  uint8_t *const rohc_data,
+                                  const size_t rohc_max_len)
+	__attribute__((warn_unused_result, nonnull(1, 2, 4)));
+static int rfc5225_code_dyn_ip(const struct rohc_comp_ctxt *const context,
+                               const uint8_t *const ip_data,
+                               const size_t ip_hdr_pos,
+                               uint8_t *const rohc_data,
+                               const size_t rohc_max_len)
+	__attribute__((warn_unused_result, nonnull(1, 2, 4)));
+
+/* CO packets */
+static int rfc5225_code_CO_pkt(const struct rohc_comp_ctxt *const context,
+                               const struct net_pkt *const uncomp_pkt,
+                               uint8_t *const rohc_pkt,
+                               const size_t rohc_pkt_max_len,
+                               const rohc_packet_t packet_type)
+	__attribute__((warn_unused_result, nonnull(1, 2, 3)));
+static size_t rfc5225_code_CO_base(const struct rohc_comp_ctxt *const context,
+                                   const struct net_pkt *const uncomp_pkt,
+                                   const rohc_packet_t packet_type,
+                                   const uint8_t crc,
+                                   uint8_t *const hdr)
+	__attribute__((warn_unused_result, nonnull(1, 2, 5)));
+static size_t rfc5225_code_irreg_chain(const struct rohc_comp_ctxt *const context,
+                                       const struct net_pkt *const uncomp_pkt,
+                                       const bool outer_ip_indicator,
+                                       uint8_t *const rohc_data)
+	__attribute__((warn_unused_result, nonnull(1, 2, 4)));
+
+/* deliver feedbacks */
+static bool c_rfc5225_feedback_2(struct rohc_comp_ctxt *const context,
+                                 const uint8_t *const packet,
+                                 const size_t packet_len,
+                                 const uint8_t *const feedback_data,
+                                 const size_t feedback_data_len)
+	__attribute__((warn_unused_result, nonnull(1, 2, 4)));
+static void c_rfc5225_feedback_ack(struct rohc_comp_ctxt *const context,
+                                   const uint32_t sn_bits,
+                                   const size_t sn_bits_nr,
+                                   const bool sn_not_valid)
+	__attribute__((nonnull(1)));
+
+
+
+/*
+ * Definitions of functions
+ */
+
+
+/**
+ * @brief Create a new ROHCv2 context and initialize it thanks to the given
+ *        IP packet
+ *
+ * The generic part of the context and the profile-specific part are carved
+ * from one single memory block of the pool of the compressor. The
+ * profile-specific part is zeroed and available in the \e specific field
+ * of the generic part. The handlers of the next header are left empty.
+ *
+ * @param context        The compression context
+ * @param specific_size  The size of the profile-specific part of the context,
+ *                       0 if the profile has no specific part
+ * @param packet         The packet given to initialize the new context
+ * @return               true if successful, false otherwise
+ */
+bool rohc_comp_rfc5225_create(struct rohc_comp_ctxt *const context,
+                              const size_t specific_size,
+                              const struct net_pkt *const packet)
+{
+	const struct rohc_comp *const comp = context->compressor;
+	struct rohc_comp_rfc5225_ctxt *rfc5225_ctxt;
+	struct rohc_ctxt_arena arena;
+	void *specific = NULL;
+	size_t hdr_pos;
+
+	/* get one memory block for the generic and specific parts of the context */
+	if(rohc_ctxt_pool_get(context->compressor->cur_ctxt_pool,
+	                      rohc_ctxt_arena_size(sizeof(struct rohc_comp_rfc5225_ctxt)) +
+	                      rohc_ctxt_arena_size(specific_size), &arena) == NULL)
+	{
+		rohc_error(context->compressor, ROHC_TRACE_COMP, context->profile->id,
+		           "no memory for the ROHCv2 part of the profile context");
+		goto error;
+	}
+	/* the generic part comes first in the block, so that the block is given
+	 * back to the pool with it */
+	rfc5225_ctxt = rohc_ctxt_arena_alloc(&arena, sizeof(struct rohc_comp_rfc5225_ctxt));
+	assert(rfc5225_ctxt != NULL);
+	if(specific_size > 0)
+	{
+		specific = rohc_ctxt_arena_alloc(&arena, specific_size);
+		assert(specific != NULL);
+	}
+	context->specific = rfc5225_ctxt;
+
+	/* create contexts for IP headers, the descriptor of the packet was
+	 * already checked while checking the profile */
+	rfc5225_ctxt->ip_ctxts_nr = 0;
+	for(hdr_pos = 0;
+	    hdr_pos < packet->hdrs_nr && rohc_is_tunneling(packet->hdrs[hdr_pos].proto);
+	    hdr_pos++)
+	{
+		const uint8_t *const ip_data = packet->data + packet->hdrs[hdr_pos].offset;
+		const struct ip_hdr *const ip = (struct ip_hdr *) ip_data;
+		struct rohc_comp_rfc5225_ip_ctxt *const ip_ctxt =
+			&(rfc5225_ctxt->ip_ctxts[hdr_pos]);
+
+		assert(hdr_pos < ROHC_RFC5225_MAX_IP_HDRS);
+
+		rohc_comp_debug(context, "found IPv%d", ip->version);
+		ip_ctxt->version = ip->version;
+
+		if(ip->version == IPV4)
+		{
+			const struct ipv4_hdr *const ipv4 = (struct ipv4_hdr *) ip_data;
+
+			ip_ctxt->next_proto = ipv4->protocol;
+			ip_ctxt->tos_tc = ipv4->tos;
+			ip_ctxt->ttl_hopl = ipv4->ttl;
+			ip_ctxt->df = ipv4->df;
+			ip_ctxt->ip_id = rohc_ntoh16(ipv4->id);
+			ip_ctxt->ip_id_behavior = ROHC_RFC5225_IP_ID_SEQ;
+			ip_ctxt->flow_label = 0;
+			ip_ctxt->v4.saddr = ipv4->saddr;
+			ip_ctxt->v4.daddr = ipv4->daddr;
+		}
+		else
+		{
+			const struct ipv6_hdr *const ipv6 = (struct ipv6_hdr *) ip_data;
+
+			assert(ip->version == IPV6);
+			ip_ctxt->next_proto = ipv6->nh;
+			ip_ctxt->tos_tc = ipv6_get_tc(ipv6);
+			ip_ctxt->ttl_hopl = ipv6->hl;
+			ip_ctxt->df = 0;
+			ip_ctxt->ip_id = 0;
+			ip_ctxt->ip_id_behavior = ROHC_RFC5225_IP_ID_RAND;
+			ip_ctxt->flow_label = ipv6_get_flow_label(ipv6);
+			memcpy(&ip_ctxt->v6.saddr, &ipv6->saddr, sizeof(struct ipv6_addr));
+			memcpy(&ip_ctxt->v6.daddr, &ipv6->daddr, sizeof(struct ipv6_addr));
+		}
+
+		rfc5225_ctxt->ip_ctxts_nr++;
+	}
+	assert(rfc5225_ctxt->ip_ctxts_nr > 0);
+
+	/* the reordering ratio is fixed for the whole life of the context */
+	rfc5225_ctxt->reorder_ratio = comp->reorder_ratio;
+
+	/* MSN */
+	c_init_wlsb(&rfc5225_ctxt->msn_wlsb, 16, comp->wlsb_window_width,
+	            rohc_interval_get_rfc5225_msn_p(rfc5225_ctxt->reorder_ratio));
+
+	/* innermost IP-ID offset */
+	c_init_wlsb(&rfc5225_ctxt->ip_id_wlsb, 16, comp->wlsb_window_width,
+	            ROHC_LSB_SHIFT_RFC5225_IP_ID);
+
+	/* no change to repeat yet */
+	rfc5225_ctxt->innermost_change_count = MAX_FO_COUNT;
+	rfc5225_ctxt->outer_change_count = MAX_FO_COUNT;
+
+	/* init the Master Sequence Number to a random value */
+	rfc5225_ctxt->msn = comp->random_cb(comp, comp->random_cb_ctxt) & 0xffff;
+	rohc_comp_debug(context, "MSN = 0x%04x / %u", rfc5225_ctxt->msn,
+	                rfc5225_ctxt->msn);
+
+	/* no next header and the packets of the IP-only profile by default */
+	rfc5225_ctxt->specific = specific;
+	rfc5225_ctxt->next_header_len = 0;
+	rfc5225_ctxt->get_next_msn = NULL;
+	rfc5225_ctxt->detect_next_hdr_changes = NULL;
+	rfc5225_ctxt->decide_FO_SO_pkt = rfc5225_decide_FO_SO_pkt;
+	rfc5225_ctxt->init_at_IR = NULL;
+	rfc5225_ctxt->code_static_next_hdr = NULL;
+	rfc5225_ctxt->code_dyn_next_hdr = NULL;
+	rfc5225_ctxt->code_CO_base = rfc5225_code_CO_base;
+	rfc5225_ctxt->code_irreg_next_hdr = NULL;
+	rfc5225_ctxt->update_next_hdr_ctxt = NULL;
+
+	return true;
+
+error:
+	return false;
+}
+
+
+/**
+ * @brief Destroy the ROHCv2 context
+ *
+ * The profile-specific part of the context is given back to the pool along
+ * with the generic part.
+ *
+ * @param context  The compression context
+ */
+void rohc_comp_rfc5225_destroy(struct rohc_comp_ctxt *const context)
+{
+	struct rohc_comp_rfc5225_ctxt *const rfc5225_ctxt = context->specific;
+
+	rohc_ctxt_pool_put(context->compressor->cur_ctxt_pool, rfc5225_ctxt);
+}
+
+
+/**
+ * @brief Check if the IP headers of the given packet correspond to one of
+ *        the ROHCv2 profiles
+ *
+ * Conditions are:
+ *  \li the packet starts with 1 or 2 IPv4 or IPv6 headers,
+ *  \li the IPv4 headers have no option, are not fragments, and their lengths
+ *      and checksums are correct,
+ *  \li the IPv6 headers have no extension header and their payload lengths
+ *      are correct.
+ *
+ * The profiles check the header that follows the IP headers, if any.
+ *
+ * @param comp    The ROHC compressor
+ * @param packet  The packet to check
+ * @return        Whether the IP packet corresponds to the profile:
+ *                  \li true if the IP packet corresponds to the profile,
+ *                  \li false if the IP packet does not correspond to
+ *                      the profile
+ */
+bool rohc_comp_rfc5225_check_profile(const struct rohc_comp *const comp,
+                                     const struct net_pkt *const packet)
+{
+	size_t hdr_pos;
+
+	if(packet->hdrs_nr == 0)
+	{
+		rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		           "IP header is truncated or not supported");
+		goto bad_profile;
+	}
+
+	for(hdr_pos = 0;
+	    hdr_pos < packet->hdrs_nr && rohc_is_tunneling(packet->hdrs[hdr_pos].proto);
+	    hdr_pos++)
+	{
+		const struct net_pkt_hdr *const ip_hdr = &(packet->hdrs[hdr_pos]);
+		const uint8_t *const ip_data = packet->data + ip_hdr->offset;
+		const size_t remain_len = packet->len - ip_hdr->offset;
+
+		/* profile cannot handle the packet if it bypasses internal limit of
+		 * IP headers */
+		if(hdr_pos >= ROHC_RFC5225_MAX_IP_HDRS)
+		{
+			rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+			           "too many IP headers for ROHCv2 profiles (%u "
+			           "headers max)", ROHC_RFC5225_MAX_IP_HDRS);
+			goto bad_profile;
+		}
+
+		if(ip_hdr->proto == ROHC_IPPROTO_IPIP)
+		{
+			const struct ipv4_hdr *const ipv4 = (struct ipv4_hdr *) ip_data;
+			const size_t ipv4_min_words_nr = sizeof(struct ipv4_hdr) / sizeof(uint32_t);
+
+			/* IPv4 options are not supported by the profile */
+			if(ip_hdr->len != sizeof(struct ipv4_hdr))
+			{
+				rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+				           "IP packet #%zu is not supported by the profile: "
+				           "IP options are not accepted", hdr_pos + 1);
+				goto bad_profile;
+			}
+
+			/* IPv4 total length shall be correct */
+			if(rohc_ntoh16(ipv4->tot_len) != remain_len)
+			{
+				rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+				           "IP packet #%zu is not supported by the profile: total "
+				           "length is %u while it shall be %zu", hdr_pos + 1,
+				           rohc_ntoh16(ipv4->tot_len), remain_len);
+				goto bad_profile;
+			}
+
+			/* check if the IPv4 header is a fragment */
+			if(ipv4_is_fragment(ipv4))
+			{
+				rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+				           "IP packet #%zu is fragmented", hdr_pos + 1);
+				goto bad_profile;
+			}
+
+			/* check if the checksum of the IPv4 header is correct */
+			if((comp->features & ROHC_COMP_FEATURE_NO_IP_CHECKSUMS) == 0 &&
+			   !packet->ip_csums_verified &&
+			   ip_fast_csum(ip_data, ipv4_min_words_nr) != 0)
+			{
+				rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+				           "IP packet #%zu is not correct (bad checksum)",
+				           hdr_pos + 1);
+				goto bad_profile;
+			}
+		}
+		else
+		{
+			const struct ipv6_hdr *const ipv6 = (struct ipv6_hdr *) ip_data;
+
+			assert(ip_hdr->proto == ROHC_IPPROTO_IPV6);
+
+			/* payload length shall be correct */
+			if(rohc_ntoh16(ipv6->plen) != (remain_len - sizeof(struct ipv6_hdr)))
+			{
+				rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+				           "IP packet #%zu is not supported by the profile: payload "
+				           "length is %u while it shall be %zu", hdr_pos + 1,
+				           rohc_ntoh16(ipv6->plen), remain_len - sizeof(struct ipv6_hdr));
+				goto bad_profile;
+			}
+
+			/* IPv6 extension headers are not supported by the profile */
+			if(rohc_is_ipv6_opt(ipv6->nh))
+			{
+				rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+				           "IP packet #%zu is not supported by the profile: IPv6 "
+				           "extension headers are not accepted", hdr_pos + 1);
+				goto bad_profile;
+			}
+		}
+	}
+
+	/* the last IP header shall not announce another IP header that the
+	 * descriptor failed to record */
+	{
+		const uint8_t *const ip_data =
+			packet->data + packet->hdrs[hdr_pos - 1].offset;
+		const uint8_t next_proto = ((ip_data[0] >> 4) == IPV4 ?
+		                            ((struct ipv4_hdr *) ip_data)->protocol :
+		                            ((struct ipv6_hdr *) ip_data)->nh);
+
+		if(rohc_is_tunneling(next_proto) && hdr_pos >= packet->hdrs_nr)
+		{
+			rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+			           "IP header #%zu is truncated or not supported",
+			           hdr_pos + 1);
+			goto bad_profile;
+		}
+	}
+
+	return true;
+
+bad_profile:
+	return false;
+}
+
+
+/**
+ * @brief Check if the IP headers of the packet belong to the ROHCv2 context
+ *
+ * Conditions are:
+ *  - the number of IP headers must be the same as in context,
+ *  - the versions, addresses, IPv6 Flow Labels and next protocols of the IP
+ *    headers must be the same as in context.
+ *
+ * The profiles check the header that follows the IP headers, if any.
+ *
+ * @param context  The compression context
+ * @param packet   The IP packet to check
+ * @return         true if the IP packet belongs to the context,
+ *                 false if it does not belong to the context
+ */
+bool rohc_comp_rfc5225_check_context(const struct rohc_comp_ctxt *const context,
+                                     const struct net_pkt *const packet)
+{
+	const struct rohc_comp_rfc5225_ctxt *const rfc5225_ctxt =
+		context->specific;
+	bool same_fprint;
+	size_t hdr_pos;
+
+	/* compare the flow fingerprints first, they cover all the IP headers
+	 * unless the innermost one in the fingerprint is followed by another */
+	if(net_pkt_fprint_cmp(&packet->fprint, &context->fprint, &same_fprint))
+	{
+		if(!same_fprint)
+		{
+			rohc_comp_debug(context, "  not same flow fingerprint");
+			goto bad_context;
+		}
+		if(!rohc_is_tunneling(packet->transport->proto))
+		{
+			rohc_comp_debug(context, "  same flow fingerprint");
+			return true;
+		}
+	}
+
+	/* compare the IP headers one by one */
+	for(hdr_pos = 0;
+	    hdr_pos < packet->hdrs_nr && rohc_is_tunneling(packet->hdrs[hdr_pos].proto);
+	    hdr_pos++)
+	{
+		const uint8_t *const ip_data = packet->data + packet->hdrs[hdr_pos].offset;
+		const struct ip_hdr *const ip = (struct ip_hdr *) ip_data;
+		const struct rohc_comp_rfc5225_ip_ctxt *const ip_ctxt =
+			&(rfc5225_ctxt->ip_ctxts[hdr_pos]);
+
+		if(hdr_pos >= rfc5225_ctxt->ip_ctxts_nr)
+		{
+			rohc_comp_debug(context, "  more IP headers than in context");
+			goto bad_context;
+		}
+		if(ip->version != ip_ctxt->version)
+		{
+			rohc_comp_debug(context, "  not same IP version");
+			goto bad_context;
+		}
+
+		if(ip->version == IPV4)
+		{
+			const struct ipv4_hdr *const ipv4 = (struct ipv4_hdr *) ip_data;
+
+			if(ipv4->saddr != ip_ctxt->v4.saddr ||
+			   ipv4->daddr != ip_ctxt->v4.daddr)
+			{
+				rohc_comp_debug(context, "  not same IPv4 addresses");
+				goto bad_context;
+			}
+			if(ipv4->protocol != ip_ctxt->next_proto)
+			{
+				rohc_comp_debug(context, "  IPv4 not same protocol");
+				goto bad_context;
+			}
+		}
+		else
+		{
+			const struct ipv6_hdr *const ipv6 = (struct ipv6_hdr *) ip_data;
+
+			if(memcmp(&ipv6->saddr, &ip_ctxt->v6.saddr, sizeof(struct ipv6_addr)) != 0 ||
+			   memcmp(&ipv6->daddr, &ip_ctxt->v6.daddr, sizeof(struct ipv6_addr)) != 0)
+			{
+				rohc_comp_debug(context, "  not same IPv6 addresses");
+				goto bad_context;
+			}
+			if(ipv6_get_flow_label(ipv6) != ip_ctxt->flow_label)
+			{
+				rohc_comp_debug(context, "  not same IPv6 flow label");
+				goto bad_context;
+			}
+			if(ipv6->nh != ip_ctxt->next_proto)
+			{
+				rohc_comp_debug(context, "  IPv6 not same next header");
+				goto bad_context;
+			}
+		}
+	}
+	if(hdr_pos != rfc5225_ctxt->ip_ctxts_nr)
+	{
+		rohc_comp_debug(context, "  less IP headers than in context");
+		goto bad_context;
+	}
+
+	return true;
+
+bad_context:
+	return false;
+}
+
+
+/**
+ * @brief Encode an IP packet according to one of the ROHCv2 profiles
+ *
+ * @param context           The compression context
+ * @param uncomp_pkt        The uncompressed packet to encode
+ * @param rohc_pkt          OUT: The ROHC packet
+ * @param rohc_pkt_max_len  The maximum length of the ROHC packet
+ * @param packet_type       OUT: The type of ROHC packet that is created
+ * @param payload_offset    OUT: The offset for the payload in the IP packet
+ * @return                  The length of the ROHC packet if successful,
+ *                          -1 otherwise
+ */
+int rohc_comp_rfc5225_encode(struct rohc_comp_ctxt *const context,
+                             const struct net_pkt *const uncomp_pkt,
+                             uint8_t *const rohc_pkt,
+                             const size_t rohc_pkt_max_len,
+                             rohc_packet_t *const packet_type,
+                             size_t *const payload_offset)
+{
+	struct rohc_comp_rfc5225_ctxt *const rfc5225_ctxt = context->specific;
+	int counter;
+
+	*packet_type = ROHC_PACKET_UNKNOWN;
+
+	/* detect changes between new uncompressed packet and context */
+	rfc5225_detect_changes(context, uncomp_pkt);
+
+	/* decide in which state to go */
+	if(rfc5225_ctxt->tmp.ir_needed)
+	{
+		rohc_comp_debug(context, "one field that only the IR packet transmits "
+		                "changed, go back to IR state");
+		rohc_comp_change_state(context, ROHC_COMP_STATE_IR);
+	}
+	rfc5225_decide_state(context);
+
+	/* compute how many bits are needed to send the MSN and IP-ID offset */
+	rfc5225_ctxt->tmp.msn_k =
+		wlsb_get_k_16bits(&rfc5225_ctxt->msn_wlsb, rfc5225_ctxt->msn);
+	rohc_comp_debug(context, "%zu bits are required to encode new MSN 0x%04x",
+	                rfc5225_ctxt->tmp.msn_k, rfc5225_ctxt->msn);
+	rfc5225_ctxt->tmp.ip_id_offset_k =
+		wlsb_get_k_16bits(&rfc5225_ctxt->ip_id_wlsb, rfc5225_ctxt->tmp.ip_id_offset);
+	rfc5225_ctxt->tmp.is_ip_id_offset_const =
+		!!(wlsb_get_kp_16bits(&rfc5225_ctxt->ip_id_wlsb,
+		                      rfc5225_ctxt->tmp.ip_id_offset,
+		                      ROHC_LSB_SHIFT_IP_ID) == 0);
+	rohc_comp_debug(context, "%zu bits are required to encode new innermost "
+	                "IP-ID offset 0x%04x (%s)", rfc5225_ctxt->tmp.ip_id_offset_k,
+	                rfc5225_ctxt->tmp.ip_id_offset,
+	                rfc5225_ctxt->tmp.is_ip_id_offset_const ?
+	                "unchanged" : "changed");
+
+	/* decide which packet to send */
+	*packet_type = rfc5225_decide_pkt(context);
+
+	/* code the chosen packet */
+	if((*packet_type) == ROHC_PACKET_IR)
+	{
+		if(rfc5225_ctxt->init_at_IR != NULL)
+		{
+			rfc5225_ctxt->init_at_IR(context, uncomp_pkt->transport->data);
+		}
+		counter = rfc5225_code_IR_pkt(context, uncomp_pkt, rohc_pkt,
+		                                      rohc_pkt_max_len);
+		if(counter < 0)
+		{
+			rohc_comp_warn(context, "failed to build IR packet");
+			goto error;
+		}
+	}
+	else
+	{
+		counter = rfc5225_code_CO_pkt(context, uncomp_pkt, rohc_pkt,
+		                                      rohc_pkt_max_len, *packet_type);
+		if(counter < 0)
+		{
+			rohc_comp_warn(context, "failed to build CO packet");
+			goto error;
+		}
+	}
+	rohc_comp_dump_buf(context, "current ROHC packet", rohc_pkt, counter);
+
+	*payload_offset = rfc5225_ctxt->tmp.payload_offset;
+	rohc_comp_debug(context, "payload_offset = %zu", *payload_offset);
+
+	/* update the context with the new headers */
+	rfc5225_update_ctxt(context, uncomp_pkt, *packet_type);
+
+	return counter;
+
+error:
+	return -1;
+}
+
+
+/**
+ * @brief Detect the changes between the uncompressed packet and the context
+ *
+ * @param context     The compression context
+ * @param uncomp_pkt  The uncompressed packet to encode
+ */
+static void rfc5225_detect_changes(struct rohc_comp_ctxt *const context,
+                                   const struct net_pkt *const uncomp_pkt)
+{
+	struct rohc_comp_rfc5225_ctxt *const rfc5225_ctxt = context->specific;
+	struct rohc_comp_rfc5225_tmp *const tmp = &rfc5225_ctxt->tmp;
+	size_t hdr_pos;
+
+	tmp->payload_offset = 0;
+	tmp->innermost_changed = false;
+	tmp->outer_changed = false;
+	tmp->ir_needed = false;
+	tmp->ip_id_offset = 0;
+
+	/* compute the new MSN */
+	if(rfc5225_ctxt->get_next_msn != NULL)
+	{
+		rfc5225_ctxt->msn =
+			rfc5225_ctxt->get_next_msn(context, uncomp_pkt->transport->data);
+	}
+	else
+	{
+		rfc5225_ctxt->msn = (rfc5225_ctxt->msn + 1) & 0xffff;
+	}
+	rohc_comp_debug(context, "MSN = 0x%04x / %u", rfc5225_ctxt->msn,
+	                rfc5225_ctxt->msn);
+
+	for(hdr_pos = 0; hdr_pos < rfc5225_ctxt->ip_ctxts_nr; hdr_pos++)
+	{
+		const uint8_t *const ip_data =
+			uncomp_pkt->data + uncomp_pkt->hdrs[hdr_pos].offset;
+		const struct rohc_comp_rfc5225_ip_ctxt *const ip_ctxt =
+			&(rfc5225_ctxt->ip_ctxts[hdr_pos]);
+		const bool is_innermost = !!(hdr_pos == (rfc5225_ctxt->ip_ctxts_nr - 1));
+		uint8_t tos_tc;
+		uint8_t ttl_hopl;
+		bool changed;
+
+		if(ip_ctxt->version == IPV4)
+		{
+			const struct ipv4_hdr *const ipv4 = (struct ipv4_hdr *) ip_data;
+			const uint16_t ip_id = rohc_ntoh16(ipv4->id);
+			rohc_rfc5225_ip_id_behavior_t behavior;
+
+			tos_tc = ipv4->tos;
+			ttl_hopl = ipv4->ttl;
+			tmp->payload_offset += sizeof(struct ipv4_hdr);
+
+			/* determine the IP-ID behavior: the innermost IP-ID may behave in
+			 * all the ways, the outer ones are either random or zero */
+			if(context->num_sent_packets == 0)
+			{
+				/* first packet, be optimistic: choose sequential behavior */
+				if(is_innermost)
+				{
+					behavior = ROHC_RFC5225_IP_ID_SEQ;
+				}
+				else if(ip_id == 0)
+				{
+					behavior = ROHC_RFC5225_IP_ID_ZERO;
+				}
+				else
+				{
+					behavior = ROHC_RFC5225_IP_ID_RAND;
+				}
+			}
+			else if(is_innermost)
+			{
+				/* the values of the SEQ, SEQ_SWAP, RAND and ZERO behaviors are
+				 * the same in RFC5225 and in the IP-ID classifier */
+				switch(rohc_ip_id_classify((rohc_ip_id_behavior_t) ip_ctxt->ip_id_behavior,
+				                           ip_ctxt->ip_id, ip_id))
+				{
+					case ROHC_IP_ID_SEQ:
+						behavior = ROHC_RFC5225_IP_ID_SEQ;
+						break;
+					case ROHC_IP_ID_SEQ_SWAP:
+						behavior = ROHC_RFC5225_IP_ID_SEQ_SWAP;
+						break;
+					case ROHC_IP_ID_ZERO:
+						behavior = ROHC_RFC5225_IP_ID_ZERO;
+						break;
+					case ROHC_IP_ID_CONST:
+						behavior = (ip_id == 0 ? ROHC_RFC5225_IP_ID_ZERO :
+						            ROHC_RFC5225_IP_ID_RAND);
+						break;
+					case ROHC_IP_ID_RAND:
+					default:
+						behavior = ROHC_RFC5225_IP_ID_RAND;
+						break;
+				}
+			}
+			else if(ip_ctxt->ip_id_behavior == ROHC_RFC5225_IP_ID_ZERO && ip_id == 0)
+			{
+				behavior = ROHC_RFC5225_IP_ID_ZERO;
+			}
+			else
+			{
+				behavior = ROHC_RFC5225_IP_ID_RAND;
+			}
+			rohc_comp_debug(context, "IP header #%zu: IP-ID 0x%04x -> 0x%04x, "
+			                "behavior %d -> %d", hdr_pos + 1, ip_ctxt->ip_id, ip_id,
+			                ip_ctxt->ip_id_behavior, behavior);
+			tmp->ip_ids[hdr_pos] = ip_id;
+			tmp->ip_id_behaviors[hdr_pos] = behavior;
+
+			/* the DF flag and the IP-ID behavior of the outer headers are
+			 * transmitted in the IR packet only */
+			changed = !!(ipv4->df != ip_ctxt->df ||
+			             behavior != ip_ctxt->ip_id_behavior);
+			if(changed && !is_innermost)
+			{
+				rohc_comp_debug(context, "IP header #%zu: DF or IP-ID behavior "
+				                "changed", hdr_pos + 1);
+				tmp->ir_needed = true;
+			}
+
+			/* the offset of the innermost IP-ID from the MSN */
+			if(is_innermost)
+			{
+				const uint16_t ip_id_seq =
+					(behavior == ROHC_RFC5225_IP_ID_SEQ_SWAP ? swab16(ip_id) : ip_id);
+				tmp->ip_id_offset = (ip_id_seq - rfc5225_ctxt->msn) & 0xffff;
+			}
+		}
+		else
+		{
+			const struct ipv6_hdr *const ipv6 = (struct ipv6_hdr *) ip_data;
+
+			tos_tc = ipv6_get_tc(ipv6);
+			ttl_hopl = ipv6->hl;
+			tmp->payload_offset += sizeof(struct ipv6_hdr);
+			tmp->ip_ids[hdr_pos] = 0;
+			tmp->ip_id_behaviors[hdr_pos] = ROHC_RFC5225_IP_ID_RAND;
+			changed = false;
+		}
+
+		changed = !!(changed || tos_tc != ip_ctxt->tos_tc ||
+		             ttl_hopl != ip_ctxt->ttl_hopl);
+		if(changed)
+		{
+			rohc_comp_debug(context, "IP header #%zu changed", hdr_pos + 1);
+			if(is_innermost)
+			{
+				tmp->innermost_changed = true;
+			}
+			else
+			{
+				tmp->outer_changed = true;
+			}
+		}
+	}
+	if(tmp->innermost_changed)
+	{
+		rfc5225_ctxt->innermost_change_count = 0;
+	}
+	if(tmp->outer_changed)
+	{
+		rfc5225_ctxt->outer_change_count = 0;
+	}
+
+	/* the next header, if any, is compressed along with the IP headers */
+	if(rfc5225_ctxt->next_header_len > 0)
+	{
+		tmp->payload_offset += rfc5225_ctxt->next_header_len;
+		rfc5225_ctxt->detect_next_hdr_changes(context, uncomp_pkt->transport->data);
+	}
+}
+
+
+/**
+ * @brief Decide the state that should be used for the next packet
+ *
+ * The three states are:\n
+ *  - Initialization and Refresh (IR),\n
+ *  - First Order (FO),\n
+ *  - Second Order (SO).
+ *
+ * @param context  The compression context
+ */
+static void rfc5225_decide_state(struct rohc_comp_ctxt *const context)
+{
+	const rohc_comp_state_t curr_state = context->state;
+	rohc_comp_state_t next_state;
+
+	if(curr_state == ROHC_COMP_STATE_IR)
+	{
+		if(context->ir_count < MAX_IR_COUNT)
+		{
+			rohc_comp_debug(context, "no enough packets transmitted in IR state "
+			                "for the moment (%zu/%u), so stay in IR state",
+			                (size_t) context->ir_count, MAX_IR_COUNT);
+			next_state = ROHC_COMP_STATE_IR;
+		}
+		else
+		{
+			rohc_comp_debug(context, "enough packets transmitted in IR state (%zu/%u), "
+			                "go to SO state", (size_t) context->ir_count, MAX_IR_COUNT);
+			next_state = ROHC_COMP_STATE_SO;
+		}
+	}
+	else if(curr_state == ROHC_COMP_STATE_FO)
+	{
+		if(context->fo_count < MAX_FO_COUNT)
+		{
+			rohc_comp_debug(context, "no enough packets transmitted in FO state "
+			                "for the moment (%zu/%u), so stay in FO state",
+			                (size_t) context->fo_count, MAX_FO_COUNT);
+			next_state = ROHC_COMP_STATE_FO;
+		}
+		else
+		{
+			rohc_comp_debug(context, "enough packets transmitted in FO state (%zu/%u), "
+			                "go to SO state", (size_t) context->fo_count, MAX_FO_COUNT);
+			next_state = ROHC_COMP_STATE_SO;
+		}
+	}
+	else
+	{
+		assert(curr_state == ROHC_COMP_STATE_SO);
+		rohc_comp_debug(context, "stay in SO state");
+		next_state = ROHC_COMP_STATE_SO;
+	}
+
+	rohc_comp_change_state(context, next_state);
+
+	/* periodic context refreshes (RFC5225, §5.1.1) */
+	if(context->mode == ROHC_U_MODE)
+	{
+		rohc_comp_periodic_down_transition(context);
+	}
+}
+
+
+/**
+ * @brief Decide which packet to send in the current state
+ *
+ * The profile may decide the CO packets itself.
+ *
+ * @param context  The compression context
+ * @return         The packet type among ROHC_PACKET_IR, ROHC_PACKET_CO_COMMON,
+ *                 ROHC_PACKET_PT_0_CRC3, ROHC_PACKET_PT_0_CRC7,
+ *                 ROHC_PACKET_PT_1_SEQ_ID and ROHC_PACKET_PT_2_SEQ_ID, or
+ *                 the CO packets decided by the profile
+ */
+static rohc_packet_t rfc5225_decide_pkt(struct rohc_comp_ctxt *const context)
+{
+	const struct rohc_comp_rfc5225_ctxt *const rfc5225_ctxt = context->specific;
+	rohc_packet_t packet_type;
+
+	switch(context->state)
+	{
+		case ROHC_COMP_STATE_IR:
+			rohc_comp_debug(context, "code IR packet");
+			packet_type = ROHC_PACKET_IR;
+			context->ir_count++;
+			break;
+		case ROHC_COMP_STATE_FO:
+			context->fo_count++;
+			packet_type = rfc5225_ctxt->decide_FO_SO_pkt(context, true);
+			break;
+		case ROHC_COMP_STATE_SO:
+		default:
+			assert(context->state == ROHC_COMP_STATE_SO);
+			context->so_count++;
+			packet_type = rfc5225_ctxt->decide_FO_SO_pkt(context, false);
+			break;
+	}
+
+	/* the IR packet is the last resort: the packet is then a context
+	 * refresh that the state machine shall know about */
+	if(packet_type == ROHC_PACKET_IR && context->state != ROHC_COMP_STATE_IR)
+	{
+		rohc_comp_debug(context, "no CO packet can transmit the changes, fall "
+		                "back to IR packet");
+		rohc_comp_change_state(context, ROHC_COMP_STATE_IR);
+		context->ir_count++;
+	}
+
+	return packet_type;
+}
+
+
+/**
+ * @brief Decide which packet to send in the FO or SO state
+ *
+ * @param context    The compression context
+ * @param crc7_only  Whether only the packets protected by a 7-bit CRC are
+ *                   allowed (FO state) or not (SO state)
+ * @return           The packet type
+ */
+static rohc_packet_t rfc5225_decide_FO_SO_pkt(const struct rohc_comp_ctxt *const context,
+                                              const bool crc7_only)
+{
+	const struct rohc_comp_rfc5225_ctxt *const rfc5225_ctxt =
+		context->specific;
+	const struct rohc_comp_rfc5225_tmp *const tmp = &rfc5225_ctxt->tmp;
+	const size_t innermost_pos = rfc5225_ctxt->ip_ctxts_nr - 1;
+	const bool is_ip_id_seq =
+		!!(rfc5225_ctxt->ip_ctxts[innermost_pos].version == IPV4 &&
+		   (tmp->ip_id_behaviors[innermost_pos] == ROHC_RFC5225_IP_ID_SEQ ||
+		    tmp->ip_id_behaviors[innermost_pos] == ROHC_RFC5225_IP_ID_SEQ_SWAP));
+	rohc_packet_t packet_type;
+
+	if(rfc5225_ctxt->innermost_change_count < MAX_FO_COUNT ||
+	   rfc5225_ctxt->outer_change_count < MAX_FO_COUNT)
+	{
+		/* the changes of the IP headers are repeated several times */
+		packet_type = ROHC_PACKET_CO_COMMON;
+	}
+	else if(is_ip_id_seq && !tmp->is_ip_id_offset_const)
+	{
+		/* sequential IP-ID with a new offset */
+		if(!crc7_only && tmp->ip_id_offset_k <= 4 && tmp->msn_k <= 5)
+		{
+			packet_type = ROHC_PACKET_PT_1_SEQ_ID;
+		}
+		else if(tmp->ip_id_offset_k <= 6 && tmp->msn_k <= 8)
+		{
+			packet_type = ROHC_PACKET_PT_2_SEQ_ID;
+		}
+		else
+		{
+			packet_type = ROHC_PACKET_CO_COMMON;
+		}
+	}
+	else if(!crc7_only && tmp->msn_k <= 4)
+	{
+		packet_type = ROHC_PACKET_PT_0_CRC3;
+	}
+	else if(tmp->msn_k <= 6)
+	{
+		packet_type = ROHC_PACKET_PT_0_CRC7;
+	}
+	else if(is_ip_id_seq && tmp->ip_id_offset_k <= 6 && tmp->msn_k <= 8)
+	{
+		packet_type = ROHC_PACKET_PT_2_SEQ_ID;
+	}
+	else
+	{
+		packet_type = ROHC_PACKET_CO_COMMON;
+	}
+
+	/* all the CO packets transmit 8 MSN bits at most */
+	if(tmp->msn_k > 8)
+	{
+		packet_type = ROHC_PACKET_IR;
+	}
+
+	return packet_type;
+}
+
+
+/**
+ * @brief Update the context with the packet that was just compressed
+ *
+ * @param context      The compression context
+ * @param uncomp_pkt   The uncompressed packet that was compressed
+ * @param packet_type  The type of the ROHC packet that was built
+ */
+static void rfc5225_update_ctxt(struct rohc_comp_ctxt *const context,
+                                const struct net_pkt *const uncomp_pkt,
+                                const rohc_packet_t packet_type)
+{
+	struct rohc_comp_rfc5225_ctxt *const rfc5225_ctxt = context->specific;
+	const struct rohc_comp_rfc5225_tmp *const tmp = &rfc5225_ctxt->tmp;
+	size_t hdr_pos;
+
+	for(hdr_pos = 0; hdr_pos < rfc5225_ctxt->ip_ctxts_nr; hdr_pos++)
+	{
+		const uint8_t *const ip_data =
+			uncomp_pkt->data + uncomp_pkt->hdrs[hdr_pos].offset;
+		struct rohc_comp_rfc5225_ip_ctxt *const ip_ctxt =
+			&(rfc5225_ctxt->ip_ctxts[hdr_pos]);
+
+		if(ip_ctxt->version == IPV4)
+		{
+			const struct ipv4_hdr *const ipv4 = (struct ipv4_hdr *) ip_data;
+
+			ip_ctxt->tos_tc = ipv4->tos;
+			ip_ctxt->ttl_hopl = ipv4->ttl;
+			ip_ctxt->df = ipv4->df;
+			ip_ctxt->ip_id = tmp->ip_ids[hdr_pos];
+			ip_ctxt->ip_id_behavior = tmp->ip_id_behaviors[hdr_pos];
+		}
+		else
+		{
+			const struct ipv6_hdr *const ipv6 = (struct ipv6_hdr *) ip_data;
+
+			ip_ctxt->tos_tc = ipv6_get_tc(ipv6);
+			ip_ctxt->ttl_hopl = ipv6->hl;
+		}
+	}
+
+	/* the changes were transmitted once more */
+	if(packet_type == ROHC_PACKET_IR || packet_type == ROHC_PACKET_CO_COMMON)
+	{
+		if(rfc5225_ctxt->innermost_change_count < MAX_FO_COUNT)
+		{
+			rfc5225_ctxt->innermost_change_count++;
+		}
+		if(rfc5225_ctxt->outer_change_count < MAX_FO_COUNT)
+		{
+			rfc5225_ctxt->outer_change_count++;
+		}
+	}
+
+	if(rfc5225_ctxt->next_header_len > 0)
+	{
+		rfc5225_ctxt->update_next_hdr_ctxt(context, uncomp_pkt->transport->data,
+		                                   packet_type);
+	}
+
+	c_add_wlsb(&rfc5225_ctxt->msn_wlsb, rfc5225_ctxt->msn, rfc5225_ctxt->msn);
+	c_add_wlsb(&rfc5225_ctxt->ip_id_wlsb, rfc5225_ctxt->msn, tmp->ip_id_offset);
+	context->sn_bits_nr = tmp->msn_bits_nr;
+}
+
+
+/**
+ * @brief Code the IR packet
+ *
+ * @param context           The compression context
+ * @param uncomp_pkt        The uncompressed packet to encode
+ * @param rohc_pkt          OUT: The ROHC packet
+ * @param rohc_pkt_max_len  The maximum length of the ROHC packet
+ * @return                  The length of the ROHC packet if successful,
+ *                          -1 otherwise
+ */
+static int rfc5225_code_IR_pkt(const struct rohc_comp_ctxt *const context,
+                               const struct net_pkt *const uncomp_pkt,
+                               uint8_t *const rohc_pkt,
+                               const size_t rohc_pkt_max_len)
+{
+	struct rohc_comp_rfc5225_ctxt *const rfc5225_ctxt = context->specific;
+	uint8_t *rohc_remain_data = rohc_pkt;
+	size_t rohc_remain_len = rohc_pkt_max_len;
+	size_t first_position;
+	size_t crc_position;
+	size_t rohc_hdr_len = 0;
+	rohc_ticks_t crc_ticks;
+	size_t hdr_pos;
+	int ret;
+
+	/* Add-CID or large CID */
+	ret = code_cid_values(&context->cid_code, rohc_remain_data, rohc_remain_len,
+	                      &first_position);
+	if(ret < 1)
+	{
+		rohc_comp_warn(context, "failed to encode %s CID %zu: maybe the %zu-byte "
+		               "ROHC buffer is too small",
+		               context->compressor->medium.cid_type == ROHC_SMALL_CID ?
+		               "small" : "large", context->cid, rohc_remain_len);
+		goto error;
+	}
+	rohc_remain_data += ret;
+	rohc_remain_len -= ret;
+	rohc_hdr_len += ret;
+
+	/* type of packet */
+	rohc_pkt[first_position] = ROHC_RFC5225_IR_DISC;
+
+	/* enough room for profile ID and CRC? */
+	if(rohc_remain_len < 2)
+	{
+		rohc_comp_warn(context, "ROHC buffer too small for IR packet: 2 bytes "
+		               "required for profile ID and CRC, but only %zu bytes "
+		               "available", rohc_remain_len);
+		goto error;
+	}
+
+	/* profile ID on 8 bits */
+	rohc_remain_data[0] = context->profile->id & 0xff;
+	rohc_remain_data++;
+	rohc_remain_len--;
+	rohc_hdr_len++;
+
+	/* the CRC is computed later since it must be computed over the whole packet
+	 * with an empty CRC field */
+	crc_position = rohc_hdr_len;
+	rohc_remain_data[0] = 0;
+	rohc_remain_data++;
+	rohc_remain_len--;
+	rohc_hdr_len++;
+
+	/* static chain */
+	for(hdr_pos = 0; hdr_pos < rfc5225_ctxt->ip_ctxts_nr; hdr_pos++)
+	{
+		const uint8_t *const ip_data =
+			uncomp_pkt->data + uncomp_pkt->hdrs[hdr_pos].offset;
+		const bool is_innermost = !!(hdr_pos == (rfc5225_ctxt->ip_ctxts_nr - 1));
+
+		ret = rfc5225_code_static_ip(context, ip_data, is_innermost,
+		                                     rohc_remain_data, rohc_remain_len);
+		if(ret < 0)
+		{
+			rohc_comp_warn(context, "failed to build the static part of IP "
+			               "header #%zu", hdr_pos + 1);
+			goto error;
+		}
+		rohc_remain_data += ret;
+		rohc_remain_len -= ret;
+		rohc_hdr_len += ret;
+	}
+	if(rfc5225_ctxt->next_header_len > 0)
+	{
+		ret = rfc5225_ctxt->code_static_next_hdr(context,
+		                                         uncomp_pkt->transport->data,
+		                                         rohc_remain_data, rohc_remain_len);
+		if(ret < 0)
+		{
+			rohc_comp_warn(context, "failed to build the static part of the "
+			               "next header");
+			goto error;
+		}
+		rohc_remain_data += ret;
+		rohc_remain_len -= ret;
+		rohc_hdr_len += ret;
+	}
+	rohc_comp_dump_buf(context, "current ROHC packet (with static part)",
+	                   rohc_pkt, rohc_hdr_len);
+
+	/* dynamic chain */
+	for(hdr_pos = 0; hdr_pos < rfc5225_ctxt->ip_ctxts_nr; hdr_pos++)
+	{
+		const uint8_t *const ip_data =
+			uncomp_pkt->data + uncomp_pkt->hdrs[hdr_pos].offset;
+
+		ret = rfc5225_code_dyn_ip(context, ip_data, hdr_pos,
+		                                  rohc_remain_data, rohc_remain_len);
+		if(ret < 0)
+		{
+			rohc_comp_warn(context, "failed to build the dynamic part of IP "
+			               "header #%zu", hdr_pos + 1);
+			goto error;
+		}
+		rohc_remain_data += ret;
+		rohc_remain_len -= ret;
+		rohc_hdr_len += ret;
+	}
+	if(rfc5225_ctxt->next_header_len > 0)
+	{
+		ret = rfc5225_ctxt->code_dyn_next_hdr(context, uncomp_pkt->transport->data,
+		                                      rohc_remain_data, rohc_remain_len);
+		if(ret < 0)
+		{
+			rohc_comp_warn(context, "failed to build the dynamic part of the "
+			               "next header");
+			goto error;
+		}
+		rohc_remain_data += ret;
+		rohc_remain_len -= ret;
+		rohc_hdr_len += ret;
+	}
+	rohc_comp_dump_buf(context, "current ROHC packet (with dynamic part)",
+	                   rohc_pkt, rohc_hdr_len);
+
+	/* IR header was successfully built, compute the CRC */
+	crc_ticks = rohc_comp_ticks(context->compressor);
+	rohc_pkt[crc_position] = crc_calculate(ROHC_CRC_TYPE_8, rohc_pkt,
+	                                       rohc_hdr_len, CRC_INIT_8);
+	rohc_comp_crc_ticks_add(context->compressor, crc_ticks);
+	rohc_comp_debug(context, "CRC (header length = %zu, crc = 0x%x)",
+	                rohc_hdr_len, rohc_pkt[crc_position]);
+
+	rfc5225_ctxt->tmp.msn_bits_nr = 16;
+
+	return rohc_hdr_len;
+
+error:
+	return -1;
+}
+
+
+/**
+ * @brief Code the static part of one IP header (RFC5225 §6.8.2.4)
+ *
+ * @param context       The compression context
+ * @param ip_data       The IP header to code
+ * @param is_innermost  Whether the IP header is the innermost one or not
+ * @param rohc_data     OUT: The ROHC packet
+ * @param rohc_max_len  The maximum length of the ROHC packet
+ * @return              The length of the static part if successful,
+ *                      -1 otherwise
+ */
+static int rfc5225_code_static_ip(const struct rohc_comp_ctxt *const context,
+                                  const uint8_t *const ip_data,
+                                  const bool is_innermost,
+                                  uint8_t *const rohc_data,
+                                  const size_t rohc_max_len)
+{
+	size_t static_len;
+
+	if((ip_data[0] >> 4) == IPV4)
+	{
+		const struct ipv4_hdr *const ipv4 = (struct ipv4_hdr *) ip_data;
+
+		static_len = ROHC_RFC5225_IPV4_STATIC_LEN;
+		if(rohc_max_len < static_len)
+		{
+			goto too_short;
+		}
+		rohc_data[0] = (is_innermost ? 1 : 0) << 6;
+		rohc_data[1] = ipv4->protocol;
+		memcpy(rohc_data + 2, &ipv4->saddr, sizeof(uint32_t));
+		memcpy(rohc_data + 6, &ipv4->daddr, sizeof(uint32_t));
+	}
+	else
+	{
+		const struct ipv6_hdr *const ipv6 = (struct ipv6_hdr *) ip_data;
+		const uint32_t flow_label = ipv6_get_flow_label(ipv6);
+		size_t pos;
+
+		static_len = (flow_label == 0 ? ROHC_RFC5225_IPV6_STATIC_LEN_NO_FL :
+		              ROHC_RFC5225_IPV6_STATIC_LEN);
+		if(rohc_max_len < static_len)
+		{
+			goto too_short;
+		}
+		rohc_data[0] = 0x80 | ((is_innermost ? 1 : 0) << 6);
+		pos = 1;
+		if(flow_label != 0)
+		{
+			rohc_data[0] |= 0x10 | ((flow_label >> 16) & 0x0f);
+			rohc_data[1] = (flow_label >> 8) & 0xff;
+			rohc_data[2] = flow_label & 0xff;
+			pos += 2;
+		}
+		rohc_data[pos] = ipv6->nh;
+		pos++;
+		memcpy(rohc_data + pos, &ipv6->saddr, sizeof(struct ipv6_addr));
+		pos += sizeof(struct ipv6_addr);
+		memcpy(rohc_data + pos, &ipv6->daddr, sizeof(struct ipv6_addr));
+	}
+
+	return static_len;
+
+too_short:
+	rohc_comp_warn(context, "ROHC buffer too small for the %zu-byte static "
+	               "part of the IP header", static_len);
+	return -1;
+}
+
+
+/**
+ * @brief Code the dynamic part of one IP header (RFC5225 §6.8.2.4)
+ *
+ * The dynamic part of the innermost IP header carries the reordering ratio
+ * and the MSN, unless the IP headers are followed by a next header whose
+ * dynamic part carries them.
+ *
+ * @param context       The compression context
+ * @param ip_data       The IP header to code
+ * @param ip_hdr_pos    The position of the IP header in the packet
+ * @param rohc_data     OUT: The ROHC packet
+ * @param rohc_max_len  The maximum length of the ROHC packet
+ * @return              The length of the dynamic part if successful,
+ *                      -1 otherwise
+ */
+static int rfc5225_code_dyn_ip(const struct rohc_comp_ctxt *const context,
+                               const uint8_t *const ip_data,
+                               const size_t ip_hdr_pos,
+                               uint8_t *const rohc_data,
+                               const size_t rohc_max_len)
+{
+	const struct rohc_comp_rfc5225_ctxt *const rfc5225_ctxt =
+		context->specific;
+	const bool is_innermost = !!(ip_hdr_pos == (rfc5225_ctxt->ip_ctxts_nr - 1));
+	const bool with_msn = !!(is_innermost && rfc5225_ctxt->next_header_len == 0);
+	size_t dyn_len = 0;
+
+	if((ip_data[0] >> 4) == IPV4)
+	{
+		const struct ipv4_hdr *const ipv4 = (struct ipv4_hdr *) ip_data;
+		const rohc_rfc5225_ip_id_behavior_t behavior =
+			rfc5225_ctxt->tmp.ip_id_behaviors[ip_hdr_pos];
+
+		if(rohc_max_len < 7)
+		{
+			goto too_short;
+		}
+		rohc_data[dyn_len] = (ipv4->df << 2) | (behavior & 0x03);
+		if(with_msn)
+		{
+			rohc_data[dyn_len] |= (rfc5225_ctxt->reorder_ratio & 0x03) << 3;
+		}
+		dyn_len++;
+		rohc_data[dyn_len++] = ipv4->tos;
+		rohc_data[dyn_len++] = ipv4->ttl;
+		if(behavior != ROHC_RFC5225_IP_ID_ZERO)
+		{
+			memcpy(rohc_data + dyn_len, &ipv4->id, sizeof(uint16_t));
+			dyn_len += sizeof(uint16_t);
+		}
+	}
+	else
+	{
+		const struct ipv6_hdr *const ipv6 = (struct ipv6_hdr *) ip_data;
+
+		if(rohc_max_len < 5)
+		{
+			goto too_short;
+		}
+		rohc_data[dyn_len++] = ipv6_get_tc(ipv6);
+		rohc_data[dyn_len++] = ipv6->hl;
+		if(with_msn)
+		{
+			rohc_data[dyn_len++] = rfc5225_ctxt->reorder_ratio & 0x03;
+		}
+	}
+
+	if(with_msn)
+	{
+		rohc_data[dyn_len++] = (rfc5225_ctxt->msn >> 8) & 0xff;
+		rohc_data[dyn_len++] = rfc5225_ctxt->msn & 0xff;
+	}
+
+	return dyn_len;
+
+too_short:
+	rohc_comp_warn(context, "ROHC buffer too small for the dynamic part of "
+	               "the IP header");
+	return -1;
+}
+
+
+/**
+ * @brief Code one CO packet
+ *
+ * @param context           The compression context
+ * @param uncomp_pkt        The uncompressed packet to encode
+ * @param rohc_pkt          OUT: The ROHC packet
+ * @param rohc_pkt_max_len  The maximum length of the ROHC packet
+ * @param packet_type       The type of CO packet to code
+ * @return                  The length of the ROHC packet if successful,
+ *                          -1 otherwise
+ */
+static int rfc5225_code_CO_pkt(const struct rohc_comp_ctxt *const context,
+                               const struct net_pkt *const uncomp_pkt,
+                               uint8_t *const rohc_pkt,
+                               const size_t rohc_pkt_max_len,
+                               const rohc_packet_t packet_type)
+{
+	struct rohc_comp_rfc5225_ctxt *const rfc5225_ctxt = context->specific;
+	uint8_t hdr[ROHC_COMP_RFC5225_CO_HDR_MAX_LEN];
+	size_t hdr_len;
+	size_t first_position;
+	bool outer_ip_indicator;
+	rohc_ticks_t crc_ticks;
+	uint8_t crc;
+	int ret;
+
+	/* the CRC covers the uncompressed IP headers and the next header */
+	crc_ticks = rohc_comp_ticks(context->compressor);
+	if(packet_type == ROHC_PACKET_PT_0_CRC3 ||
+	   packet_type == ROHC_PACKET_PT_1_SEQ_ID ||
+	   packet_type == ROHC_PACKET_PT_1_RND)
+	{
+		crc = crc_calculate(ROHC_CRC_TYPE_3, uncomp_pkt->data,
+		                    rfc5225_ctxt->tmp.payload_offset, CRC_INIT_3);
+	}
+	else
+	{
+		crc = crc_calculate(ROHC_CRC_TYPE_7, uncomp_pkt->data,
+		                    rfc5225_ctxt->tmp.payload_offset, CRC_INIT_7);
+	}
+	rohc_comp_crc_ticks_add(context->compressor, crc_ticks);
+	rohc_comp_debug(context, "CRC on %zu-byte uncompressed headers = 0x%x",
+	                rfc5225_ctxt->tmp.payload_offset, crc);
+
+	/* base header */
+	hdr_len = rfc5225_ctxt->code_CO_base(context, uncomp_pkt, packet_type, crc,
+	                                     hdr);
+	rohc_comp_debug(context, "%s packet with %zu-byte base header",
+	                rohc_get_packet_descr(packet_type), hdr_len);
+
+	/* irregular chain, the outer TOS/TTL are sent along co_common only */
+	outer_ip_indicator =
+		!!(packet_type == ROHC_PACKET_CO_COMMON &&
+		   rfc5225_ctxt->outer_change_count < MAX_FO_COUNT);
+	hdr_len += rfc5225_code_irreg_chain(context, uncomp_pkt,
+	                                    outer_ip_indicator, hdr + hdr_len);
+	if(rfc5225_ctxt->next_header_len > 0)
+	{
+		hdr_len += rfc5225_ctxt->code_irreg_next_hdr(context,
+		                                             uncomp_pkt->transport->data,
+		                                             hdr + hdr_len);
+	}
+	assert(hdr_len <= sizeof(hdr));
+
+	/* Add-CID or large CID: the first byte of the CO header is placed before
+	 * the large CID, the next bytes after it */
+	ret = code_cid_values(&context->cid_code, rohc_pkt, rohc_pkt_max_len,
+	                      &first_position);
+	if(ret < 1 || (rohc_pkt_max_len - ret) < (hdr_len - 1))
+	{
+		rohc_comp_warn(context, "ROHC buffer too small for the %zu-byte CO "
+		               "header and the %s CID %zu", hdr_len,
+		               context->compressor->medium.cid_type == ROHC_SMALL_CID ?
+		               "small" : "large", context->cid);
+		goto error;
+	}
+	rohc_pkt[first_position] = hdr[0];
+	memcpy(rohc_pkt + ret, hdr + 1, hdr_len - 1);
+
+	return (ret + hdr_len - 1);
+
+error:
+	return -1;
+}
+
+
+/**
+ * @brief Code the base header of one CO packet of the IP-only profile
+ *
+ * @param context      The compression context
+ * @param uncomp_pkt   The uncompressed packet to encode
+ * @param packet_type  The type of CO packet to code
+ * @param crc          The CRC over the uncompressed headers
+ * @param hdr          OUT: The base header
+ * @return             The length of the base header
+ */
+static size_t rfc5225_code_CO_base(const struct rohc_comp_ctxt *const context,
+                                   const struct net_pkt *const uncomp_pkt,
+                                   const rohc_packet_t packet_type,
+                                   const uint8_t crc,
+                                   uint8_t *const hdr)
+{
+	struct rohc_comp_rfc5225_ctxt *const rfc5225_ctxt = context->specific;
+	const uint16_t msn = rfc5225_ctxt->msn;
+	const uint16_t ip_id_offset = rfc5225_ctxt->tmp.ip_id_offset;
+	size_t hdr_len;
+
+	switch(packet_type)
+	{
+		case ROHC_PACKET_PT_0_CRC3:
+			hdr[0] = ROHC_RFC5225_PT_0_CRC3_DISC | ((msn & 0x0f) << 3) | crc;
+			hdr_len = 1;
+			rfc5225_ctxt->tmp.msn_bits_nr = 4;
+			break;
+		case ROHC_PACKET_PT_0_CRC7:
+			hdr[0] = ROHC_RFC5225_PT_0_CRC7_DISC | ((msn >> 1) & 0x1f);
+			hdr[1] = ((msn & 0x01) << 7) | crc;
+			hdr_len = 2;
+			rfc5225_ctxt->tmp.msn_bits_nr = 6;
+			break;
+		case ROHC_PACKET_PT_1_SEQ_ID:
+			hdr[0] = ROHC_RFC5225_PT_1_SEQ_ID_DISC | (ip_id_offset & 0x0f);
+			hdr[1] = (crc << 5) | (msn & 0x1f);
+			hdr_len = 2;
+			rfc5225_ctxt->tmp.msn_bits_nr = 5;
+			break;
+		case ROHC_PACKET_PT_2_SEQ_ID:
+			hdr[0] = ROHC_RFC5225_PT_2_SEQ_ID_DISC | ((ip_id_offset >> 1) & 0x1f);
+			hdr[1] = ((ip_id_offset & 0x01) << 7) | crc;
+			hdr[2] = msn & 0xff;
+			hdr_len = 3;
+			rfc5225_ctxt->tmp.msn_bits_nr = 8;
+			break;
+		case ROHC_PACKET_CO_COMMON:
+		default:
+			assert(packet_type == ROHC_PACKET_CO_COMMON);
+			hdr_len = rohc_comp_rfc5225_build_co_common(context, uncomp_pkt, crc, hdr);
+			rfc5225_ctxt->tmp.msn_bits_nr = 8;
+			break;
+	}
+
+	return hdr_len;
+}
+
+
+/**
+ * @brief Build the co_common base header
+ *
+ * While the changes of the IP headers are repeated, all the innermost
+ * fields are transmitted. The RTP profile appends its own fields to the
+ * header.
+ *
+ * @param context     The compression context
+ * @param uncomp_pkt  The uncompressed packet to encode
+ * @param crc7        The CRC-7 over the uncompressed headers
+ * @param hdr         OUT: The co_common header
+ * @return            The length of the co_common header
+ */
+size_t rohc_comp_rfc5225_build_co_common(const struct rohc_comp_ctxt *const context,
+                                         const struct net_pkt *const uncomp_pkt,
+                                         const uint8_t crc7,
+                                         uint8_t *const hdr)
+{
+	const struct rohc_comp_rfc5225_ctxt *const rfc5225_ctxt =
+		context->specific;
+	const struct rohc_comp_rfc5225_tmp *const tmp = &rfc5225_ctxt->tmp;
+	const size_t innermost_pos = rfc5225_ctxt->ip_ctxts_nr - 1;
+	const uint8_t *const ip_data =
+		uncomp_pkt->data + uncomp_pkt->hdrs[innermost_pos].offset;
+	const bool is_ipv4 = !!(rfc5225_ctxt->ip_ctxts[innermost_pos].version == IPV4);
+	const rohc_rfc5225_ip_id_behavior_t behavior =
+		tmp->ip_id_behaviors[innermost_pos];
+	const bool is_ip_id_seq =
+		!!(is_ipv4 && (behavior == ROHC_RFC5225_IP_ID_SEQ ||
+		               behavior == ROHC_RFC5225_IP_ID_SEQ_SWAP));
+	const bool innermost_ind =
+		!!(rfc5225_ctxt->innermost_change_count < MAX_FO_COUNT);
+	const bool outer_ind = !!(rfc5225_ctxt->outer_change_count < MAX_FO_COUNT);
+	const bool ip_id_ind = !!(is_ip_id_seq && tmp->ip_id_offset_k > 8);
+	uint8_t tos_tc;
+	uint8_t ttl_hopl;
+	uint8_t df;
+	size_t hdr_len = 0;
+
+	if(is_ipv4)
+	{
+		const struct ipv4_hdr *const ipv4 = (struct ipv4_hdr *) ip_data;
+		tos_tc = ipv4->tos;
+		ttl_hopl = ipv4->ttl;
+		df = ipv4->df;
+	}
+	else
+	{
+		const struct ipv6_hdr *const ipv6 = (struct ipv6_hdr *) ip_data;
+		tos_tc = ipv6_get_tc(ipv6);
+		ttl_hopl = ipv6->hl;
+		df = 0;
+	}
+
+	hdr[hdr_len++] = ROHC_RFC5225_CO_COMMON_DISC;
+	hdr[hdr_len++] = ((ip_id_ind ? 1 : 0) << 7) | (crc7 & 0x7f);
+	hdr[hdr_len++] = (((innermost_ind || outer_ind) ? 1 : 0) << 7) |
+	                 ((innermost_ind ? 1 : 0) << 6) |
+	                 ((innermost_ind ? 1 : 0) << 5) |
+	                 ((rfc5225_ctxt->reorder_ratio & 0x03) << 3) |
+	                 rohc_comp_rfc5225_ctrl_crc3(context);
+	if(innermost_ind || outer_ind)
+	{
+		hdr[hdr_len++] = ((outer_ind ? 1 : 0) << 7) |
+		                 (is_ipv4 ? ((df << 6) | ((behavior & 0x03) << 4)) : 0);
+	}
+	if(innermost_ind)
+	{
+		hdr[hdr_len++] = tos_tc;
+		hdr[hdr_len++] = ttl_hopl;
+	}
+	hdr[hdr_len++] = rfc5225_ctxt->msn & 0xff;
+	if(is_ip_id_seq)
+	{
+		if(ip_id_ind)
+		{
+			hdr[hdr_len++] = (tmp->ip_ids[innermost_pos] >> 8) & 0xff;
+			hdr[hdr_len++] = tmp->ip_ids[innermost_pos] & 0xff;
+		}
+		else
+		{
+			hdr[hdr_len++] = tmp->ip_id_offset & 0xff;
+		}
+	}
+
+	return hdr_len;
+}
+
+
+/**
+ * @brief Code the irregular chain of one CO packet (RFC5225 §6.8.2.4)
+ *
+ * The random IP-IDs of all the IPv4 headers are transmitted, as well as the
+ * TOS/TC and TTL/HL of the outer IP headers if the outer IP indicator is set.
+ *
+ * @param context             The compression context
+ * @param uncomp_pkt          The uncompressed packet to encode
+ * @param outer_ip_indicator  Whether the outer TOS/TC and TTL/HL are sent
+ * @param rohc_data           OUT: The irregular chain
+ * @return                    The length of the irregular chain
+ */
+static size_t rfc5225_code_irreg_chain(const struct rohc_comp_ctxt *const context,
+                                       const struct net_pkt *const uncomp_pkt,
+                                       const bool outer_ip_indicator,
+                                       uint8_t *const rohc_data)
+{
+	const struct rohc_comp_rfc5225_ctxt *const rfc5225_ctxt =
+		context->specific;
+	size_t irreg_len = 0;
+	size_t hdr_pos;
+
+	for(hdr_pos = 0; hdr_pos < rfc5225_ctxt->ip_ctxts_nr; hdr_pos++)
+	{
+		const uint8_t *const ip_data =
+			uncomp_pkt->data + uncomp_pkt->hdrs[hdr_pos].offset;
+		const bool is_innermost = !!(hdr_pos == (rfc5225_ctxt->ip_ctxts_nr - 1));
+
+		if((ip_data[0] >> 4) == IPV4)
+		{
+			const struct ipv4_hdr *const ipv4 = (struct ipv4_hdr *) ip_data;
+
+			if(rfc5225_ctxt->tmp.ip_id_behaviors[hdr_pos] == ROHC_RFC5225_IP_ID_RAND)
+			{
+				memcpy(rohc_data + irreg_len, &ipv4->id, sizeof(uint16_t));
+				irreg_len += sizeof(uint16_t);
+			}
+			if(!is_innermost && outer_ip_indicator)
+			{
+				rohc_data[irreg_len++] = ipv4->tos;
+				rohc_data[irreg_len++] = ipv4->ttl;
+			}
+		}
+		else if(!is_innermost && outer_ip_indicator)
+		{
+			const struct ipv6_hdr *const ipv6 = (struct ipv6_hdr *) ip_data;
+
+			rohc_data[irreg_len++] = ipv6_get_tc(ipv6);
+			rohc_data[irreg_len++] = ipv6->hl;
+		}
+	}
+
+	return irreg_len;
+}
+
+
+/**
+ * @brief Compute the control CRC-3 of the packet being compressed
+ *
+ * @param context  The compression context
+ * @return         The control CRC-3
+ */
+uint8_t rohc_comp_rfc5225_ctrl_crc3(const struct rohc_comp_ctxt *const context)
+{
+	const struct rohc_comp_rfc5225_ctxt *const rfc5225_ctxt =
+		context->specific;
+	uint8_t ip_id_behaviors[ROHC_RFC5225_MAX_IP_HDRS];
+	size_t ip_id_behaviors_nr = 0;
+	size_t hdr_pos;
+
+	for(hdr_pos = 0; hdr_pos < rfc5225_ctxt->ip_ctxts_nr; hdr_pos++)
+	{
+		if(rfc5225_ctxt->ip_ctxts[hdr_pos].version == IPV4)
+		{
+			ip_id_behaviors[ip_id_behaviors_nr] =
+				rfc5225_ctxt->tmp.ip_id_behaviors[hdr_pos];
+			ip_id_behaviors_nr++;
+		}
+	}
+
+	return rfc5225_compute_ctrl_crc3(rfc5225_ctxt->reorder_ratio,
+	                                 rfc5225_ctxt->msn, ip_id_behaviors,
+	                                 ip_id_behaviors_nr);
+}
+
+
+/**
+ * @brief Update the profile when feedback is received
+ *
+ * This function is one of the functions that must exist in one profile for
+ * the framework to work.
+ *
+ * @param context            The compression context
+ * @param feedback_type      The feedback type
+ * @param packet             The whole feedback packet with CID bits
+ * @param packet_len         The length of the whole feedback packet with CID bits
+ * @param feedback_data      The feedback data without the CID bits
+ * @param feedback_data_len  The length of the feedback data without the CID bits
+ * @return                   true if the feedback was successfully handled,
+ *                           false if the feedback could not be taken into account
+ */
+bool rohc_comp_rfc5225_feedback(struct rohc_comp_ctxt *const context,
+                                const enum rohc_feedback_type feedback_type,
+                                const uint8_t *const packet,
+                                const size_t packet_len,
+                                const uint8_t *const feedback_data,
+                                const size_t feedback_data_len)
+{
+	if(feedback_type == ROHC_FEEDBACK_1)
+	{
+		const bool sn_not_valid = false;
+		uint32_t sn_bits;
+		size_t sn_bits_nr;
+
+		rohc_comp_debug(context, "FEEDBACK-1 received");
+		assert(feedback_data_len == 1);
+
+		/* get the 8 LSB bits of the acknowledged MSN */
+		sn_bits = feedback_data[0] & 0xff;
+		sn_bits_nr = 8;
+
+		rohc_comp_debug(context, "ACK received (CID = %zu, %zu-bit MSN = 0x%02x)",
+		                context->cid, sn_bits_nr, sn_bits);
+
+		/* the compressor received a positive ACK */
+		c_rfc5225_feedback_ack(context, sn_bits, sn_bits_nr, sn_not_valid);
+	}
+	else if(feedback_type == ROHC_FEEDBACK_2)
+	{
+		rohc_comp_debug(context, "FEEDBACK-2 received");
+
+		if(!c_rfc5225_feedback_2(context, packet, packet_len,
+		                                 feedback_data, feedback_data_len))
+		{
+			rohc_comp_warn(context, "failed to handle FEEDBACK-2");
+			goto error;
+		}
+	}
+	else /* not FEEDBACK-1 nor FEEDBACK-2 */
+	{
+		rohc_comp_warn(context, "feedback type not implemented (%d)", feedback_type);
+		goto error;
+	}
+
+	return true;
+
+error:
+	return false;
+}
+
+
+/**
+ * @brief Update the profile when FEEDBACK-2 is received
+ *
+ * @param context            The compression context
+ * @param packet             The whole feedback packet with CID bits
+ * @param packet_len         The length of the whole feedback packet with CID bits
+ * @param feedback_data      The feedback data without the CID bits
+ * @param feedback_data_len  The length of the feedback data without the CID bits
+ * @return                   true if the feedback was successfully handled,
+ *                           false if the feedback could not be taken into account
+ */
+static bool c_rfc5225_feedback_2(struct rohc_comp_ctxt *const context,
+                                 const uint8_t *const packet,
+                                 const size_t packet_len,
+                                 const uint8_t *const feedback_data,
+                                 const size_t feedback_data_len)
+{
+	const struct rohc_feedback_2_rfc6846 *feedback2;
+	size_t opts_present[ROHC_FEEDBACK_OPT_MAX] = { 0 };
+	uint8_t crc_in_packet;
+	size_t crc_pos_from_end;
+	uint32_t sn_bits;
+	size_t sn_bits_nr;
+
+	/* retrieve acked MSN */
+	if(feedback_data_len < sizeof(struct rohc_feedback_2_rfc6846))
+	{
+		rohc_comp_warn(context, "malformed FEEDBACK-2: packet too short for the "
+		               "minimal %zu-byte header, only %zu bytes remaining",
+		               sizeof(struct rohc_feedback_2_rfc6846), feedback_data_len);
+		goto error;
+	}
+	feedback2 = (const struct rohc_feedback_2_rfc6846 *) feedback_data;
+	sn_bits = (feedback2->sn1 << 8) | feedback2->sn2;
+	sn_bits_nr = 6 + 8;
+	crc_in_packet = feedback2->crc;
+	crc_pos_from_end = feedback_data_len - 2;
+
+	/* parse FEEDBACK-2 options */
+	if(!rohc_comp_feedback_parse_opts(context, packet, packet_len,
+	                                  feedback_data + 3, feedback_data_len - 3,
+	                                  opts_present, &sn_bits, &sn_bits_nr,
+	                                  crc_in_packet, crc_pos_from_end))
+	{
+		rohc_comp_warn(context, "malformed FEEDBACK-2: failed to parse options");
+		goto error;
+	}
+
+	/* change from U- to O-mode once feedback channel is established */
+	rohc_comp_change_mode(context, ROHC_O_MODE);
+
+	/* act according to the type of feedback */
+	switch(feedback2->ack_type)
+	{
+		case ROHC_FEEDBACK_ACK:
+		{
+			const bool sn_not_valid =
+				!!(opts_present[ROHC_FEEDBACK_OPT_SN_NOT_VALID] > 0);
+
+			rohc_comp_debug(context, "ACK received (CID = %zu, %zu-bit MSN = 0x%x, "
+			                "SN-not-valid = %d)", context->cid, sn_bits_nr, sn_bits,
+			                GET_REAL(sn_not_valid));
+			c_rfc5225_feedback_ack(context, sn_bits, sn_bits_nr,
+			                               sn_not_valid);
+			break;
+		}
+		case ROHC_FEEDBACK_NACK:
+		{
+			/* RFC5225 §5.1.2: NACKs, downward transition to FO state */
+			rohc_info(context->compressor, ROHC_TRACE_COMP, context->profile->id,
+			          "NACK received for CID %zu", context->cid);
+			if(context->state == ROHC_COMP_STATE_SO)
+			{
+				rohc_comp_change_state(context, ROHC_COMP_STATE_FO);
+			}
+			break;
+		}
+		case ROHC_FEEDBACK_STATIC_NACK:
+		{
+			/* RFC5225 §5.1.2: STATIC-NACKs, downward transition to IR state */
+			rohc_info(context->compressor, ROHC_TRACE_COMP, context->profile->id,
+			          "STATIC-NACK received for CID %zu", context->cid);
+			rohc_comp_change_state(context, ROHC_COMP_STATE_IR);
+			break;
+		}
+		case ROHC_FEEDBACK_RESERVED:
+		{
+			rohc_comp_warn(context, "malformed FEEDBACK-2: reserved ACK type used");
+			goto error;
+		}
+		default:
+		{
+			/* impossible value */
+			rohc_comp_warn(context, "malformed FEEDBACK-2: unknown ACK type %u",
+			               feedback2->ack_type);
+			goto error;
+		}
+	}
+
+	return true;
+
+error:
+	return false;
+}
+
+
+/**
+ * @brief Perform the required actions after the reception of a positive ACK
+ *
+ * The acknowledged values are removed from the W-LSB windows.
+ *
+ * @param context       The compression context that received a positive ACK
+ * @param sn_bits       The LSB bits of the acknowledged MSN
+ * @param sn_bits_nr    The number of LSB bits of the acknowledged MSN
+ * @param sn_not_valid  Whether the received MSN may be considered as valid or not
+ */
+static void c_rfc5225_feedback_ack(struct rohc_comp_ctxt *const context,
+                                   const uint32_t sn_bits,
+                                   const size_t sn_bits_nr,
+                                   const bool sn_not_valid)
+{
+	struct rohc_comp_rfc5225_ctxt *const rfc5225_ctxt = context->specific;
+
+	if(!sn_not_valid)
+	{
+		const bool is_width_variable =
+			!!(context->compressor->features & ROHC_COMP_FEATURE_WLSB_VARIABLE_WIDTH);
+		uint32_t acked_sn;
+		size_t acked_nr;
+
+		if(!wlsb_get_acked_sn(&rfc5225_ctxt->msn_wlsb, sn_bits, sn_bits_nr,
+		                      &acked_sn))
+		{
+			rohc_comp_debug(context, "FEEDBACK-2: positive ACK for an unknown "
+			                "MSN, no value removed from the W-LSB windows");
+			return;
+		}
+
+		acked_nr = wlsb_ack(&rfc5225_ctxt->ip_id_wlsb, acked_sn, 32,
+		                    is_width_variable);
+		rohc_comp_debug(context, "FEEDBACK-2: positive ACK removed %zu values "
+		                "from innermost IP-ID W-LSB", acked_nr);
+		acked_nr = wlsb_ack(&rfc5225_ctxt->msn_wlsb, acked_sn, 32,
+		                    is_width_variable);
+		rohc_comp_debug(context, "FEEDBACK-2: positive ACK removed %zu values "
+		                "from MSN W-LSB", acked_nr);
+	}
+}
+
+
+/**
+ * @brief Get the MSN of the last packet compressed with the given context
+ *
+ * @param context  The compression context
+ * @return         The MSN of the last compressed packet
+ */
+uint32_t rohc_comp_rfc5225_get_msn(const struct rohc_comp_ctxt *const context)
+{
+	const struct rohc_comp_rfc5225_ctxt *const rfc5225_ctxt =
+		context->specific;
+
+	return rfc5225_ctxt->msn;
+}
+
+
+/**
+ * @brief Make the next packet compressed with the given context get the
+ *        given MSN
+ *
+ * @param context  The compression context
+ * @param msn      The MSN of the next compressed packet
+ */
+void rohc_comp_rfc5225_set_next_msn(struct rohc_comp_ctxt *const context,
+                                    const uint32_t msn)
+{
+	struct rohc_comp_rfc5225_ctxt *const rfc5225_ctxt = context->specific;
+
+	rfc5225_ctxt->msn = (msn - 1) & 0xffff;
+}
+
@@ -0,0 +1,262 @@
+/*
+ * Copyright 2016,2026 Didier Barvaux
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/**
+ * @file   rohc_comp_rfc5225.h
+ * @brief  Generic framework for RFC5225-based compression profiles such as
+ *         the ROHCv2 IP-only, UDP, ESP and RTP profiles
+ * @author Didier Barvaux <didier@barvaux.org>
+ */
+
+#ifndef ROHC_COMP_RFC5225_H
+#define ROHC_COMP_RFC5225_H
+
+#include "rohc_comp_internals.h"
+#include "rohc_packets.h"
+#include "schemes/comp_wlsb.h"
+#include "protocols/ip.h"
+#include "protocols/rfc5225.h"
+
+#include <stdlib.h>
+
+
+/**
+ * @brief The max length of the base header and the irregular chain of one
+ *        CO packet
+ *
+ * The largest CO header is the co_common header of the RTP profile with all
+ * its optional fields, followed by the IP-ID and TOS/TTL of every IP header
+ * and by the UDP checksum in the irregular chain.
+ */
+#define ROHC_COMP_RFC5225_CO_HDR_MAX_LEN  32U
+
+
+/** The compression context of one IP header of the ROHCv2 profiles */
+struct rohc_comp_rfc5225_ip_ctxt
+{
+	uint8_t version;      /**< The IP version */
+	uint8_t next_proto;   /**< The IPv4 Protocol or IPv6 Next Header */
+	uint8_t tos_tc;       /**< The IPv4 TOS or IPv6 Traffic Class */
+	uint8_t ttl_hopl;     /**< The IPv4 TTL or IPv6 Hop Limit */
+	uint8_t df;           /**< The IPv4 DF flag */
+	/** The behavior of the IPv4 Identification field */
+	rohc_rfc5225_ip_id_behavior_t ip_id_behavior;
+	uint16_t ip_id;       /**< The last IPv4 Identification (host byte order) */
+	uint32_t flow_label;  /**< The IPv6 Flow Label */
+
+	/** The source and destination addresses */
+	union
+	{
+		struct
+		{
+			uint32_t saddr;  /**< The IPv4 source address */
+			uint32_t daddr;  /**< The IPv4 destination address */
+		} v4;
+		struct
+		{
+			struct ipv6_addr saddr;  /**< The IPv6 source address */
+			struct ipv6_addr daddr;  /**< The IPv6 destination address */
+		} v6;
+	};
+};
+
+
+/** The temporary variables computed for one packet */
+struct rohc_comp_rfc5225_tmp
+{
+	/** The length of the IP headers and of the next header, ie. the offset of
+	 *  the payload */
+	size_t payload_offset;
+	/** The IP-ID of every IPv4 header (host byte order) */
+	uint16_t ip_ids[ROHC_RFC5225_MAX_IP_HDRS];
+	/** The IP-ID behavior of every IPv4 header */
+	rohc_rfc5225_ip_id_behavior_t ip_id_behaviors[ROHC_RFC5225_MAX_IP_HDRS];
+	/** Whether the TOS/TC, TTL/HL, DF or IP-ID behavior of the innermost IP
+	 *  header changed */
+	bool innermost_changed;
+	/** Whether the TOS/TC or TTL/HL of one outer IP header changed */
+	bool outer_changed;
+	/** Whether one field that only the IR packet transmits changed */
+	bool ir_needed;
+	/** The offset of the innermost IP-ID from the MSN */
+	uint16_t ip_id_offset;
+	/** Whether the innermost IP-ID offset is the same in the whole window */
+	bool is_ip_id_offset_const;
+	/** The number of bits required to transmit the IP-ID offset */
+	size_t ip_id_offset_k;
+	/** The number of bits required to transmit the MSN */
+	size_t msn_k;
+	/** The number of MSN bits sent in the packet */
+	size_t msn_bits_nr;
+};
+
+
+/**
+ * @brief The generic compression context of the RFC5225-based profiles
+ *
+ * The context handles the IP headers. The header that follows the IP
+ * headers, if any, is managed by the profile-specific part through the
+ * handlers of the context.
+ */
+struct rohc_comp_rfc5225_ctxt
+{
+	/** The contexts of the IP headers, from the outermost to the innermost */
+	struct rohc_comp_rfc5225_ip_ctxt ip_ctxts[ROHC_RFC5225_MAX_IP_HDRS];
+	/** The number of IP headers */
+	size_t ip_ctxts_nr;
+
+	/** The Master Sequence Number (MSN) */
+	uint16_t msn;
+	/** The W-LSB window of the MSN */
+	struct c_wlsb msn_wlsb;
+	/** The W-LSB window of the innermost IP-ID offset */
+	struct c_wlsb ip_id_wlsb;
+	/** The reordering ratio announced to the decompressor */
+	rohc_reordering_offset_t reorder_ratio;
+
+	/** The number of co_common or IR packets sent since the innermost IP
+	 *  header changed */
+	size_t innermost_change_count;
+	/** The number of co_common or IR packets sent since one outer IP header
+	 *  changed */
+	size_t outer_change_count;
+
+	/** The temporary variables computed for the current packet */
+	struct rohc_comp_rfc5225_tmp tmp;
+
+	/** The length of the header that follows the IP headers, 0 if the IP
+	 *  headers are directly followed by the payload */
+	size_t next_header_len;
+
+	/** @brief The handler used to determine the MSN of the next packet, NULL
+	 *         to increment the MSN by one for every packet */
+	uint16_t (*get_next_msn)(const struct rohc_comp_ctxt *const context,
+	                         const uint8_t *const next_header)
+		__attribute__((warn_unused_result, nonnull(1, 2)));
+
+	/** The handler used to detect the changes of the next header */
+	void (*detect_next_hdr_changes)(struct rohc_comp_ctxt *const context,
+	                                const uint8_t *const next_header)
+		__attribute__((nonnull(1, 2)));
+
+	/** @brief The handler used to decide which CO packet to send in FO and SO
+	 *         states, the packets of the IP-only profile by default */
+	rohc_packet_t (*decide_FO_SO_pkt)(const struct rohc_comp_ctxt *const context,
+	                                  const bool crc7_only)
+		__attribute__((warn_unused_result, nonnull(1)));
+
+	/** The handler used to initialize some data just before the IR packet build */
+	void (*init_at_IR)(struct rohc_comp_ctxt *const context,
+	                   const uint8_t *const next_header)
+		__attribute__((nonnull(1, 2)));
+
+	/** The handler used to code the static part of the next header */
+	int (*code_static_next_hdr)(const struct rohc_comp_ctxt *const context,
+	                            const uint8_t *const next_header,
+	                            uint8_t *const rohc_data,
+	                            const size_t rohc_max_len)
+		__attribute__((warn_unused_result, nonnull(1, 2, 3)));
+
+	/** @brief The handler used to code the dynamic part of the next header,
+	 *         along with the MSN and the reordering ratio */
+	int (*code_dyn_next_hdr)(const struct rohc_comp_ctxt *const context,
+	                         const uint8_t *const next_header,
+	                         uint8_t *const rohc_data,
+	                         const size_t rohc_max_len)
+		__attribute__((warn_unused_result, nonnull(1, 2, 3)));
+
+	/** @brief The handler used to code the base header of the CO packets,
+	 *         the packets of the IP-only profile by default */
+	size_t (*code_CO_base)(const struct rohc_comp_ctxt *const context,
+	                       const struct net_pkt *const uncomp_pkt,
+	                       const rohc_packet_t packet_type,
+	                       const uint8_t crc,
+	                       uint8_t *const hdr)
+		__attribute__((warn_unused_result, nonnull(1, 2, 5)));
+
+	/** The handler used to code the irregular part of the next header */
+	size_t (*code_irreg_next_hdr)(const struct rohc_comp_ctxt *const context,
+	                              const uint8_t *const next_header,
+	                              uint8_t *const rohc_data)
+		__attribute__((warn_unused_result, nonnull(1, 2, 3)));
+
+	/** The handler used to update the context with the next header */
+	void (*update_next_hdr_ctxt)(struct rohc_comp_ctxt *const context,
+	                             const uint8_t *const next_header,
+	                             const rohc_packet_t packet_type)
+		__attribute__((nonnull(1, 2)));
+
+	/** Profile-specific data */
+	void *specific;
+};
+
+
+/*
+ * Function prototypes.
+ */
+
+bool rohc_comp_rfc5225_create(struct rohc_comp_ctxt *const context,
+                              const size_t specific_size,
+                              const struct net_pkt *const packet)
+	__attribute__((warn_unused_result, nonnull(1, 3)));
+
+void rohc_comp_rfc5225_destroy(struct rohc_comp_ctxt *const context)
+	__attribute__((nonnull(1)));
+
+bool rohc_comp_rfc5225_check_profile(const struct rohc_comp *const comp,
+                                     const struct net_pkt *const packet)
+	__attribute__((warn_unused_result, nonnull(1, 2)));
+
+bool rohc_comp_rfc5225_check_context(const struct rohc_comp_ctxt *const context,
+                                     const struct net_pkt *const packet)
+	__attribute__((warn_unused_result, nonnull(1, 2)));
+
+int rohc_comp_rfc5225_encode(struct rohc_comp_ctxt *const context,
+                             const struct net_pkt *const uncomp_pkt,
+                             uint8_t *const rohc_pkt,
+                             const size_t rohc_pkt_max_len,
+                             rohc_packet_t *const packet_type,
+                             size_t *const payload_offset)
+	__attribute__((warn_unused_result, nonnull(1, 2, 3, 5, 6)));
+
+bool rohc_comp_rfc5225_feedback(struct rohc_comp_ctxt *const context,
+                                const enum rohc_feedback_type feedback_type,
+                                const uint8_t *const packet,
+                                const size_t packet_len,
+                                const uint8_t *const feedback_data,
+                                const size_t feedback_data_len)
+	__attribute__((warn_unused_result, nonnull(1, 3, 5)));
+
+uint32_t rohc_comp_rfc5225_get_msn(const struct rohc_comp_ctxt *const context)
+	__attribute__((warn_unused_result, nonnull(1)));
+
+void rohc_comp_rfc5225_set_next_msn(struct rohc_comp_ctxt *const context,
+                                    const uint32_t msn)
+	__attribute__((nonnull(1)));
+
+size_t rohc_comp_rfc5225_build_co_common(const struct rohc_comp_ctxt *const context,
+                                         const struct net_pkt *const uncomp_pkt,
+                                         const uint8_t crc7,
+                                         uint8_t *const hdr)
+	__attribute__((warn_unused_result, nonnull(1, 2, 4)));
+
+uint8_t rohc_comp_rfc5225_ctrl_crc3(const struct rohc_comp_ctxt *const context)
+	__attribute__((warn_unused_result, nonnull(1)));
+
+#endif
+
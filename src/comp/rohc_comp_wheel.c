@@ -0,0 +1,267 @@
+/*
+ * Copyright 2016 Didier Barvaux
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/**
+ * @file   rohc_comp_wheel.c
+ * @brief  Hierarchical timer wheel for the time-based periodic refreshes
+ * @author Didier Barvaux <didier@barvaux.org>
+ *
+ * The compressor gets no clock of its own: the wheel is moved forward with
+ * the arrival times of the packets. Arming and disarming a timer are O(1),
+ * moving the wheel forward costs one step per 64 milliseconds when no timer
+ * is about to expire, and one step per millisecond otherwise.
+ */
+
+#include "rohc_comp_wheel.h"
+
+#include <assert.h>
+
+
+/** The mask of the slot index in every level of the wheel */
+#define ROHC_COMP_WHEEL_SLOT_MASK  (ROHC_COMP_WHEEL_SLOTS - 1)
+
+
+static void rohc_comp_wheel_insert(struct rohc_comp_wheel *const wheel,
+                                   struct rohc_comp_timer *const timer)
+	__attribute__((nonnull(1, 2)));
+
+static void rohc_comp_wheel_unlink(struct rohc_comp_wheel *const wheel,
+                                   struct rohc_comp_timer *const timer)
+	__attribute__((nonnull(1, 2)));
+
+static void rohc_comp_wheel_cascade(struct rohc_comp_wheel *const wheel,
+                                    const size_t level)
+	__attribute__((nonnull(1)));
+
+
+/**
+ * @brief Initialize the timer wheel
+ *
+ * @param wheel  The timer wheel to initialize
+ */
+void rohc_comp_wheel_init(struct rohc_comp_wheel *const wheel)
+{
+	size_t level;
+	size_t slot;
+
+	wheel->now = 0;
+	for(level = 0; level < ROHC_COMP_WHEEL_LEVELS; level++)
+	{
+		wheel->timers_nr[level] = 0;
+		for(slot = 0; slot < ROHC_COMP_WHEEL_SLOTS; slot++)
+		{
+			wheel->slots[level][slot].prev = &wheel->slots[level][slot];
+			wheel->slots[level][slot].next = &wheel->slots[level][slot];
+		}
+	}
+}
+
+
+/**
+ * @brief Arm the given timer
+ *
+ * The timer is disarmed first if it was already armed. A timer with a null
+ * timeout expires immediately.
+ *
+ * @param wheel    The timer wheel
+ * @param timer    The timer to arm
+ * @param timeout  The delay before the timer expires (in milliseconds)
+ */
+void rohc_comp_wheel_arm(struct rohc_comp_wheel *const wheel,
+                         struct rohc_comp_timer *const timer,
+                         const uint64_t timeout)
+{
+	rohc_comp_wheel_disarm(wheel, timer);
+	timer->expiry = wheel->now + timeout;
+	timer->is_expired = false;
+	rohc_comp_wheel_insert(wheel, timer);
+}
+
+
+/**
+ * @brief Disarm the given timer
+ *
+ * The timer is removed from the wheel if it was armed. The timer is no
+ * longer considered as expired.
+ *
+ * @param wheel  The timer wheel
+ * @param timer  The timer to disarm
+ */
+void rohc_comp_wheel_disarm(struct rohc_comp_wheel *const wheel,
+                            struct rohc_comp_timer *const timer)
+{
+	if(timer->is_armed)
+	{
+		rohc_comp_wheel_unlink(wheel, timer);
+	}
+	timer->is_expired = false;
+}
+
+
+/**
+ * @brief Move the timer wheel forward up to the given time
+ *
+ * The timers that expire before or at the given time are marked as expired
+ * and removed from the wheel. The wheel never moves backward.
+ *
+ * @param wheel  The timer wheel
+ * @param now    The current time (in milliseconds)
+ */
+void rohc_comp_wheel_advance(struct rohc_comp_wheel *const wheel,
+                             const uint64_t now)
+{
+	while(wheel->now < now)
+	{
+		struct rohc_comp_timer *head;
+		size_t level;
+
+		/* no timer in the first level: skip to the next tick that empties one
+		 * slot of the upper levels, or to the given time */
+		if(wheel->timers_nr[0] == 0)
+		{
+			const uint64_t next_cascade = (wheel->now | ROHC_COMP_WHEEL_SLOT_MASK) + 1;
+			size_t timers_nr = 0;
+
+			for(level = 1; level < ROHC_COMP_WHEEL_LEVELS; level++)
+			{
+				timers_nr += wheel->timers_nr[level];
+			}
+			if(timers_nr == 0 || next_cascade > now)
+			{
+				wheel->now = now;
+				break;
+			}
+			wheel->now = next_cascade - 1;
+		}
+		wheel->now++;
+
+		/* every 64^L ticks, insert again the timers of one slot of level L
+		 * in the lower levels */
+		for(level = 1; level < ROHC_COMP_WHEEL_LEVELS; level++)
+		{
+			const size_t shift = ROHC_COMP_WHEEL_SLOT_BITS * level;
+			if((wheel->now & ((((uint64_t) 1) << shift) - 1)) != 0)
+			{
+				break;
+			}
+			rohc_comp_wheel_cascade(wheel, level);
+		}
+
+		/* the timers of the current slot of level 0 expire */
+		head = &wheel->slots[0][wheel->now & ROHC_COMP_WHEEL_SLOT_MASK];
+		while(head->next != head)
+		{
+			struct rohc_comp_timer *const timer = head->next;
+			assert(timer->expiry <= wheel->now);
+			rohc_comp_wheel_unlink(wheel, timer);
+			timer->is_expired = true;
+		}
+	}
+}
+
+
+/**
+ * @brief Insert the given timer in the slot that matches its expiry
+ *
+ * @param wheel  The timer wheel
+ * @param timer  The timer to insert
+ */
+static void rohc_comp_wheel_insert(struct rohc_comp_wheel *const wheel,
+                                   struct rohc_comp_timer *const timer)
+{
+	uint64_t expiry = timer->expiry;
+	uint64_t delay;
+	struct rohc_comp_timer *head;
+	size_t level;
+
+	if(expiry <= wheel->now)
+	{
+		timer->is_armed = false;
+		timer->is_expired = true;
+		return;
+	}
+	delay = expiry - wheel->now;
+
+	/* the level is the first one that spans the delay, the timers beyond the
+	 * last level are put in its farthest slot and inserted again later */
+	for(level = 0; level < (ROHC_COMP_WHEEL_LEVELS - 1); level++)
+	{
+		if((delay >> (ROHC_COMP_WHEEL_SLOT_BITS * (level + 1))) == 0)
+		{
+			break;
+		}
+	}
+	if((delay >> (ROHC_COMP_WHEEL_SLOT_BITS * ROHC_COMP_WHEEL_LEVELS)) != 0)
+	{
+		expiry = wheel->now +
+		         (((uint64_t) 1) << (ROHC_COMP_WHEEL_SLOT_BITS * ROHC_COMP_WHEEL_LEVELS)) - 1;
+	}
+
+	head = &wheel->slots[level][(expiry >> (ROHC_COMP_WHEEL_SLOT_BITS * level)) &
+	                            ROHC_COMP_WHEEL_SLOT_MASK];
+	timer->level = level;
+	timer->prev = head->prev;
+	timer->next = head;
+	head->prev->next = timer;
+	head->prev = timer;
+	timer->is_armed = true;
+	wheel->timers_nr[level]++;
+}
+
+
+/**
+ * @brief Remove the given armed timer from its slot
+ *
+ * @param wheel  The timer wheel
+ * @param timer  The timer to remove
+ */
+static void rohc_comp_wheel_unlink(struct rohc_comp_wheel *const wheel,
+                                   struct rohc_comp_timer *const timer)
+{
+	assert(timer->is_armed);
+	assert(wheel->timers_nr[timer->level] > 0);
+
+	timer->prev->next = timer->next;
+	timer->next->prev = timer->prev;
+	timer->prev = NULL;
+	timer->next = NULL;
+	timer->is_armed = false;
+	wheel->timers_nr[timer->level]--;
+}
+
+
+/**
+ * @brief Insert again the timers of the current slot of the given level
+ *
+ * @param wheel  The timer wheel
+ * @param level  The level of the slot to empty
+ */
+static void rohc_comp_wheel_cascade(struct rohc_comp_wheel *const wheel,
+                                    const size_t level)
+{
+	const size_t slot = (wheel->now >> (ROHC_COMP_WHEEL_SLOT_BITS * level)) &
+	                    ROHC_COMP_WHEEL_SLOT_MASK;
+	struct rohc_comp_timer *const head = &wheel->slots[level][slot];
+
+	while(head->next != head)
+	{
+		struct rohc_comp_timer *const timer = head->next;
+		rohc_comp_wheel_unlink(wheel, timer);
+		rohc_comp_wheel_insert(wheel, timer);
+	}
+}
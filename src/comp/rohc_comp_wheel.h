@@ -0,0 +1,94 @@
+/*
+ * Copyright 2016 Didier Barvaux
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/**
+ * @file   rohc_comp_wheel.h
+ * @brief  Hierarchical timer wheel for the time-based periodic refreshes
+ * @author Didier Barvaux <didier@barvaux.org>
+ */
+
+#ifndef ROHC_COMP_WHEEL_H
+#define ROHC_COMP_WHEEL_H
+
+#include <stdint.h>
+#include <stddef.h>
+#ifdef __KERNEL__
+#  include <linux/types.h>
+#else
+#  include <stdbool.h>
+#endif
+
+
+/** The number of bits of the slot index in every level of the wheel */
+#define ROHC_COMP_WHEEL_SLOT_BITS  6U
+/** The number of slots in every level of the wheel */
+#define ROHC_COMP_WHEEL_SLOTS      (1U << ROHC_COMP_WHEEL_SLOT_BITS)
+/** The number of levels of the wheel: with 1-millisecond ticks, the wheel
+ *  spans about 4.6 hours, later timers are re-inserted when they get close */
+#define ROHC_COMP_WHEEL_LEVELS     4U
+
+
+/** One timer of the timer wheel, embedded in the object it belongs to */
+struct rohc_comp_timer
+{
+	struct rohc_comp_timer *prev;  /**< The previous timer in the slot */
+	struct rohc_comp_timer *next;  /**< The next timer in the slot */
+	uint64_t expiry;               /**< The time of expiry (in milliseconds) */
+	uint8_t level;                 /**< The level of the slot of the timer */
+	bool is_armed;                 /**< Whether the timer is in the wheel */
+	bool is_expired;               /**< Whether the timer expired since it was
+	                                    last armed */
+};
+
+
+/**
+ * @brief The hierarchical timer wheel
+ *
+ * The slots of level L hold the timers that expire in less than 64^(L+1)
+ * ticks. Every 64^L ticks, one slot of level L is emptied and its timers are
+ * inserted again in the lower levels. The timers of the slot of level 0 that
+ * matches the current tick expire.
+ */
+struct rohc_comp_wheel
+{
+	/** The current time of the wheel (in milliseconds) */
+	uint64_t now;
+	/** The number of armed timers in every level */
+	size_t timers_nr[ROHC_COMP_WHEEL_LEVELS];
+	/** The heads of the lists of timers of every slot */
+	struct rohc_comp_timer slots[ROHC_COMP_WHEEL_LEVELS][ROHC_COMP_WHEEL_SLOTS];
+};
+
+
+void rohc_comp_wheel_init(struct rohc_comp_wheel *const wheel)
+	__attribute__((nonnull(1)));
+
+void rohc_comp_wheel_arm(struct rohc_comp_wheel *const wheel,
+                         struct rohc_comp_timer *const timer,
+                         const uint64_t timeout)
+	__attribute__((nonnull(1, 2)));
+
+void rohc_comp_wheel_disarm(struct rohc_comp_wheel *const wheel,
+                            struct rohc_comp_timer *const timer)
+	__attribute__((nonnull(1, 2)));
+
+void rohc_comp_wheel_advance(struct rohc_comp_wheel *const wheel,
+                             const uint64_t now)
+	__attribute__((nonnull(1)));
+
+#endif
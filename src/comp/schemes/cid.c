@@ -44,76 +44,51 @@ static uint8_t c_add_cid(const rohc_cid_t cid)
  */
 
 /**
- * @brief Build the CID part of the ROHC packets.
+ * @brief Encode the CID part of the ROHC packets of one compression context
  *
+ * @param[out] cid_code  The CID part to build
  * @param cid_type       The type of CID in use for the compression context:
  *                       ROHC_SMALL_CID or ROHC_LARGE_CID
  * @param cid            The value of the CID for the compression context
- * @param dest           The rohc-packet-under-build buffer
- * @param dest_size      The length of the rohc-packet-under-build buffer
- * @param first_position OUT: The position of the first byte to be completed
- *                       by other functions
- * @return               The position in the rohc-packet-under-build buffer
- *                       in case of success, -1 in case of error
  */
-int code_cid_values(const rohc_cid_type_t cid_type,
-                    const rohc_cid_t cid,
-                    uint8_t *const dest,
-                    const size_t dest_size,
-                    size_t *const first_position)
+void rohc_cid_code_init(struct rohc_cid_code *const cid_code,
+                        const rohc_cid_type_t cid_type,
+                        const rohc_cid_t cid)
 {
-	size_t counter = 0;
+	cid_code->bytes[0] = 0;
+	cid_code->bytes[1] = 0;
 
-	/* small CID */
 	if(cid_type == ROHC_SMALL_CID)
 	{
+		/* Add-CID before the first byte, except for CID 0 */
+		cid_code->bytes_pos = 0;
 		if(cid > 0)
 		{
-			/* Add-CID */
-			if(dest_size < 2)
-			{
-				goto error;
-			}
-			dest[counter] = c_add_cid(cid);
-			*first_position = 1;
-			counter = 2;
+			cid_code->bytes[0] = c_add_cid(cid);
+			cid_code->len = 1;
 		}
 		else
 		{
-			/* no Add-CID */
-			if(dest_size < 1)
-			{
-				goto error;
-			}
-			*first_position = 0;
-			counter = 1;
+			cid_code->len = 0;
 		}
+		cid_code->first_pos = cid_code->len;
 	}
 	else /* large CID */
 	{
 		size_t sdvl_len;
 
-		*first_position = 0;
-		counter++;
-
-		/* SDVL-encode the large CID */
-		if(!sdvl_encode_full(dest + counter, dest_size, &sdvl_len, cid))
-		{
-			/* failed to SDVL-encode the large CID */
-			goto error;
-		}
-		else if(sdvl_len != 1 && sdvl_len != 2)
+		/* SDVL-encoded large CID after the first byte, on 1 or 2 bytes */
+		assert(cid <= ROHC_LARGE_CID_MAX);
+		if(!sdvl_encode_full(cid_code->bytes, 2, &sdvl_len, cid))
 		{
-			/* SDVL-encoded large CID shall be 1 or 2 byte long */
-			goto error;
+			assert(0); /* large CIDs are never longer than 2 bytes */
+			sdvl_len = 0;
 		}
-		counter += sdvl_len;
+		assert(sdvl_len == 1 || sdvl_len == 2);
+		cid_code->len = sdvl_len;
+		cid_code->bytes_pos = 1;
+		cid_code->first_pos = 0;
 	}
-
-	return counter;
-
-error:
-	return -1;
 }
 
 
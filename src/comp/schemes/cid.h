@@ -29,18 +29,63 @@
 #include "rohc.h"
 
 #include <stdlib.h>
+#include <stdint.h>
+#ifndef __KERNEL__
+#  include <string.h>
+#endif
+
+
+/**
+ * @brief The CID part of the ROHC packets of one compression context
+ *
+ * The CID of a context never changes, so the add-CID octet or the
+ * SDVL-encoded large CID is computed once when the context is created,
+ * then copied in every ROHC packet.
+ */
+struct rohc_cid_code
+{
+	uint8_t bytes[2];   /**< The add-CID octet or the SDVL-encoded large CID */
+	uint8_t len;        /**< The length of the encoded CID: 0, 1 or 2 bytes */
+	uint8_t bytes_pos;  /**< The position of the encoded CID in the packet */
+	uint8_t first_pos;  /**< The position of the first byte of the packet */
+};
 
 
 /*
  * Prototypes of functions that may used by other ROHC modules
  */
 
-int code_cid_values(const rohc_cid_type_t cid_type,
-                    const rohc_cid_t cid,
-                    uint8_t *const dest,
-                    const size_t dest_size,
-                    size_t *const first_position)
-	__attribute__((warn_unused_result, nonnull(3, 5)));
+void rohc_cid_code_init(struct rohc_cid_code *const cid_code,
+                        const rohc_cid_type_t cid_type,
+                        const rohc_cid_t cid)
+	__attribute__((nonnull(1)));
+
+
+/**
+ * @brief Build the CID part of the ROHC packets.
+ *
+ * @param cid_code       The CID part encoded for the compression context
+ * @param dest           The rohc-packet-under-build buffer
+ * @param dest_size      The length of the rohc-packet-under-build buffer
+ * @param first_position OUT: The position of the first byte to be completed
+ *                       by other functions
+ * @return               The position in the rohc-packet-under-build buffer
+ *                       in case of success, -1 in case of error
+ */
+static inline int code_cid_values(const struct rohc_cid_code *const cid_code,
+                                  uint8_t *const dest,
+                                  const size_t dest_size,
+                                  size_t *const first_position)
+{
+	if(dest_size < (cid_code->len + 1U))
+	{
+		return -1;
+	}
+	memcpy(dest + cid_code->bytes_pos, cid_code->bytes, cid_code->len);
+	*first_position = cid_code->first_pos;
+
+	return (cid_code->len + 1);
+}
 
 
 #endif
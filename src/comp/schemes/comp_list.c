@@ -25,6 +25,7 @@
 
 #include "schemes/comp_list.h"
 #include "rohc_comp_internals.h"
+#include "rohc_alloc.h"
 
 #ifndef __KERNEL__
 #  include <string.h>
@@ -40,13 +41,22 @@
 
 static bool build_ipv6_ext_pkt_list(struct list_comp *const comp,
                                     const struct ip_packet *const ip,
-                                    struct rohc_list *const pkt_list)
-	__attribute__((warn_unused_result, nonnull(1, 2, 3)));
+                                    struct rohc_list *const pkt_list,
+                                    bool *const items_changed)
+	__attribute__((warn_unused_result, nonnull(1, 2, 3, 4)));
+
+static uint64_t rohc_list_get_key(const struct list_comp *const comp,
+                                  const struct rohc_list *const list)
+	__attribute__((warn_unused_result, nonnull(1, 2), pure));
 
 static unsigned int rohc_list_get_nearest_list(const struct list_comp *const comp,
-                                               const struct rohc_list *const pkt_list,
+                                               const uint64_t pkt_key,
                                                bool *const is_new_list)
-	__attribute__((warn_unused_result, nonnull(1, 2, 3)));
+	__attribute__((warn_unused_result, nonnull(1, 3)));
+
+static void rohc_list_use_recent(struct list_comp *const comp,
+                                 const unsigned int gen_id)
+	__attribute__((nonnull(1)));
 
 static int rohc_list_decide_type(struct list_comp *const comp)
 	__attribute__((warn_unused_result, nonnull(1)));
@@ -137,22 +147,80 @@ bool detect_ipv6_ext_changes(struct list_comp *const comp,
 {
 	unsigned int new_cur_id = ROHC_LIST_GEN_ID_NONE;
 	struct rohc_list pkt_list;
+	uint64_t pkt_key;
 	bool is_new_list = false;
+	bool items_changed;
+	uint8_t last_nh;
+	uint8_t ext_type;
+
+	/* fast path: no extension header in packet, and the empty list was
+	 * already established as the reference list */
+	if(comp->is_empty_ref && ip_get_next_ext_from_ip(ip, &ext_type) == NULL)
+	{
+		assert(comp->cur_id == comp->ref_id);
+		*list_struct_changed = false;
+		*list_content_changed = false;
+		return true;
+	}
+	comp->is_empty_ref = false;
+
+	/* allocate the lists with the first list of IPv6 extension headers */
+	if(comp->lists == NULL)
+	{
+		unsigned int gen_id;
+
+		comp->lists = rohc_malloc((ROHC_LIST_GEN_ID_ANON + 1) * sizeof(struct rohc_list));
+		if(comp->lists == NULL)
+		{
+			rohc_comp_list_warn(comp, "failed to allocate memory for the lists "
+			                    "of IPv6 extension headers");
+			goto error;
+		}
+		comp->lists_keys = rohc_calloc(ROHC_LIST_GEN_ID_ANON + 1, sizeof(uint64_t));
+		if(comp->lists_keys == NULL)
+		{
+			rohc_comp_list_warn(comp, "failed to allocate memory for the keys "
+			                    "of the lists of IPv6 extension headers");
+			rohc_free(comp->lists);
+			comp->lists = NULL;
+			goto error;
+		}
+		for(gen_id = 0; gen_id <= ROHC_LIST_GEN_ID_ANON; gen_id++)
+		{
+			rohc_list_reset(&comp->lists[gen_id]);
+			comp->lists[gen_id].id = gen_id;
+		}
+	}
 
 	/* parse all extension headers:
 	 *  - update the related entries in the translation table,
 	 *  - create the list for the packet */
-	if(!build_ipv6_ext_pkt_list(comp, ip, &pkt_list))
+	if(!build_ipv6_ext_pkt_list(comp, ip, &pkt_list, &items_changed))
 	{
 		rohc_comp_list_warn(comp, "failed to build the list of extension headers "
 		                    "for the current packet");
 		goto error;
 	}
 
+	/* start a new generation if the extension headers differ from the ones of
+	 * the previous packet: one item changed, the list is not the same, or the
+	 * Next Header byte of the last extension header changed (the items do not
+	 * compare it) */
+	last_nh = (pkt_list.items_nr > 0 ?
+	           ip->data[ip->exts[ip->exts_nr - 1].offset] : 0);
+	if(items_changed || comp->cur_id > ROHC_LIST_GEN_ID_ANON ||
+	   !rohc_list_equal(&pkt_list, &comp->lists[comp->cur_id]) ||
+	   last_nh != comp->pkt_list_last_nh)
+	{
+		comp->pkt_list_gen++;
+		comp->pkt_list_last_nh = last_nh;
+	}
+
 	/* now that translation table is updated and packet list is generated,
 	 * search for a context list with the same structure or use an anonymous
 	 * list */
-	new_cur_id = rohc_list_get_nearest_list(comp, &pkt_list, &is_new_list);
+	pkt_key = rohc_list_get_key(comp, &pkt_list);
+	new_cur_id = rohc_list_get_nearest_list(comp, pkt_key, &is_new_list);
 	if(is_new_list)
 	{
 		/* TODO: context should not be overwritten until compression is fully OK */
@@ -161,6 +229,11 @@ bool detect_ipv6_ext_changes(struct list_comp *const comp,
 		       ROHC_LIST_ITEMS_MAX * sizeof(struct rohc_list_item *));
 		comp->lists[new_cur_id].items_nr = pkt_list.items_nr;
 		comp->lists[new_cur_id].counter = 0;
+		comp->lists_keys[new_cur_id] = pkt_key;
+	}
+	if(new_cur_id != ROHC_LIST_GEN_ID_ANON)
+	{
+		rohc_list_use_recent(comp, new_cur_id);
 	}
 
 	/* do we need to send some bits of the compressed list? */
@@ -218,26 +291,28 @@ error:
  *  \li update the related entries in the translation table,
  *  \li create the list for the packet
  *
- * @param comp           The list compressor
- * @param ip             The IP packet to compress
- * @param[out] pkt_list  The list of extension headers for the current packet
- * @return               true if no error occurred,
- *                       false if one error occurred
+ * @param comp                The list compressor
+ * @param ip                  The IP packet to compress
+ * @param[out] pkt_list       The list of extension headers for the current
+ *                            packet
+ * @param[out] items_changed  Whether one entry of the translation table was
+ *                            updated
+ * @return                    true if no error occurred,
+ *                            false if one error occurred
  */
 static bool build_ipv6_ext_pkt_list(struct list_comp *const comp,
                                     const struct ip_packet *const ip,
-                                    struct rohc_list *const pkt_list)
+                                    struct rohc_list *const pkt_list,
+                                    bool *const items_changed)
 {
-	uint8_t ext_types_count[ROHC_IPPROTO_MAX + 1] = { 0 };
-	const uint8_t *ext;
-	uint8_t ext_type;
+	size_t i;
 
 	/* reset the list of the current packet */
 	rohc_list_reset(pkt_list);
+	*items_changed = false;
 
-	/* get the next known IP extension in packet */
-	ext = ip_get_next_ext_from_ip(ip, &ext_type);
-	if(ext == NULL)
+	/* the IPv6 extension headers were found when the packet was created */
+	if(ip->version != IPV6 || ip->exts_nr == 0)
 	{
 		/* there is no list of IPv6 extension headers in the current packet */
 		rc_list_debug(comp, "there is no IPv6 extension in packet");
@@ -247,26 +322,36 @@ static bool build_ipv6_ext_pkt_list(struct list_comp *const comp,
 	/* there is one extension or more */
 	rc_list_debug(comp, "there is at least one IPv6 extension in packet");
 
+	/* too many extensions in packet? */
+	if(ip->exts_nr > ROHC_LIST_ITEMS_MAX)
+	{
+		rc_list_debug(comp, "list of IPv6 extension headers too large for "
+		              "compressor internal limits");
+		goto error;
+	}
+
 	/* parse all extension headers:
 	 *  - update the related entries in the translation table,
 	 *  - create the list for the packet */
-	do
+	for(i = 0; i < ip->exts_nr; i++)
 	{
+		const struct ip_ext *const ip_ext = &(ip->exts[i]);
+		const uint8_t *const ext = ip->data + ip_ext->offset;
+		const uint8_t ext_type = ip_ext->type;
+		size_t ext_type_count = 1;
 		bool entry_changed = false;
 		int index_table;
 		int ret;
+		size_t j;
 
 		/* one more occurrence of this item */
-		if(ext_types_count[ext_type] >= 255)
+		for(j = 0; j < i; j++)
 		{
-			rohc_comp_list_warn(comp, "too many IPv6 extension header of type 0x%02x",
-			                    ext_type);
-			goto error;
+			ext_type_count += (ip->exts[j].type == ext_type);
 		}
-		ext_types_count[ext_type]++;
 
 		/* find the best item to encode the extension in translation table */
-		index_table = comp->get_index_table(ext_type, ext_types_count[ext_type]);
+		index_table = comp->get_index_table(ext_type, ext_type_count);
 		if(index_table < 0 || ((size_t) index_table) >= ROHC_LIST_MAX_ITEM)
 		{
 			rohc_comp_list_warn(comp, "failed to handle unknown IPv6 "
@@ -279,12 +364,12 @@ static bool build_ipv6_ext_pkt_list(struct list_comp *const comp,
 		/* TODO: put comp const in params once context is not overwritten any more */
 		ret = rohc_list_item_update_if_changed(comp->cmp_item,
 		                                       &(comp->trans_table[index_table]),
-		                                       ext_type, ext, comp->get_size(ext));
+		                                       ext_type, ext, ip_ext->len);
 		if(ret < 0)
 		{
 			rohc_comp_list_warn(comp, "failed to update entry #%d in translation "
 			                    "table with %u-byte extension", index_table,
-			                    comp->get_size(ext));
+			                    ip_ext->len);
 			goto error;
 		}
 		else if(ret == 1)
@@ -292,6 +377,7 @@ static bool build_ipv6_ext_pkt_list(struct list_comp *const comp,
 			rc_list_debug(comp, "  entry #%d updated in translation table",
 			              index_table);
 			entry_changed = true;
+			*items_changed = true;
 		}
 
 		/* update current list in context */
@@ -305,16 +391,6 @@ static bool build_ipv6_ext_pkt_list(struct list_comp *const comp,
 		              comp->trans_table[index_table].known ? "known" : "not-yet-known",
 		              comp->trans_table[index_table].counter, comp->list_trans_nr);
 	}
-	while((ext = ip_get_next_ext_from_ext(ext, &ext_type)) != NULL &&
-	      pkt_list->items_nr < ROHC_LIST_ITEMS_MAX);
-
-	/* too many extensions in packet? */
-	if(ext != NULL)
-	{
-		rc_list_debug(comp, "list of IPv6 extension headers too large for "
-		              "compressor internal limits");
-		goto error;
-	}
 
 skip:
 	return true;
@@ -342,6 +418,20 @@ int rohc_list_encode(struct list_comp *const comp,
 	assert(comp != NULL);
 	assert(dest != NULL);
 
+	/* fast path: the empty reference list is sent with encoding type 0, with
+	 * its gen_id and no XI */
+	if(comp->is_empty_ref)
+	{
+		assert(comp->cur_id <= ROHC_LIST_GEN_ID_MAX);
+		rc_list_debug(comp, "send the empty reference list with gen_id %u",
+		              comp->cur_id);
+		dest[counter] = 0x20; /* ET = 0, GP = 1, PS = 0, CC = 0 */
+		counter++;
+		dest[counter] = comp->cur_id;
+		counter++;
+		return counter;
+	}
+
 	/* determine which encoding type is required for the current list ? */
 	encoding_type = rohc_list_decide_type(comp);
 	assert(encoding_type >= 0 && encoding_type <= 3);
@@ -404,8 +494,9 @@ void rohc_list_update_context(struct list_comp *const comp)
 {
 	size_t i;
 
-	/* nothing to do if there is no list */
-	if(comp->cur_id == ROHC_LIST_GEN_ID_NONE)
+	/* nothing to do if there is no list or if the empty list is already
+	 * established as the reference list */
+	if(comp->cur_id == ROHC_LIST_GEN_ID_NONE || comp->is_empty_ref)
 	{
 		return;
 	}
@@ -450,6 +541,80 @@ void rohc_list_update_context(struct list_comp *const comp)
 			comp->ref_id = comp->cur_id;
 		}
 	}
+
+	/* skip list compression for the next packets without extension header
+	 * once the empty list is the reference list */
+	comp->is_empty_ref = (comp->cur_id == comp->ref_id &&
+	                      comp->lists[comp->cur_id].items_nr == 0);
+}
+
+
+/**
+ * @brief Get the key that identifies the structure of the given list
+ *
+ * The items of the list are entries of the translation table, so the
+ * structure of the list is fully described by the number of items and the
+ * indexes of the items in the translation table: 4 bits for the number of
+ * items and 4 bits for each of the 15 items make 64 bits. Two lists are
+ * equal (see \ref rohc_list_equal) if and only if their keys are equal.
+ *
+ * @param comp  The list compressor
+ * @param list  The list to get the key for
+ * @return      The key of the list
+ */
+static uint64_t rohc_list_get_key(const struct list_comp *const comp,
+                                  const struct rohc_list *const list)
+{
+#if ROHC_LIST_ITEMS_MAX > 15 || ROHC_LIST_MAX_ITEM > 16
+#  error "the key of the list does not fit in 64 bits"
+#endif
+	uint64_t key = list->items_nr;
+	size_t k;
+
+	for(k = 0; k < list->items_nr; k++)
+	{
+		const size_t index_table = list->items[k] - comp->trans_table;
+		assert(index_table < ROHC_LIST_MAX_ITEM);
+		key |= ((uint64_t) index_table) << (4 + 4 * k);
+	}
+
+	return key;
+}
+
+
+/**
+ * @brief Record the given identified list as the most recently used one
+ *
+ * @param comp    The list compressor
+ * @param gen_id  The gen_id of the identified list
+ */
+static void rohc_list_use_recent(struct list_comp *const comp,
+                                 const unsigned int gen_id)
+{
+	size_t i;
+
+	/* search for the gen_id, otherwise drop the least recent one */
+	for(i = 0; i < comp->recent_ids_nr && comp->recent_ids[i] != gen_id; i++)
+	{
+	}
+	if(i == comp->recent_ids_nr)
+	{
+		if(comp->recent_ids_nr < ROHC_LIST_RECENT_MAX)
+		{
+			comp->recent_ids_nr++;
+		}
+		else
+		{
+			i--;
+		}
+	}
+
+	/* move the gen_id to the front */
+	for(; i > 0; i--)
+	{
+		comp->recent_ids[i] = comp->recent_ids[i - 1];
+	}
+	comp->recent_ids[0] = gen_id;
 }
 
 
@@ -458,26 +623,31 @@ void rohc_list_update_context(struct list_comp *const comp)
  *
  * Search for a context list with the same structure:
  *  \li check the reference list first as it is probably the correct one,
+ *  \li then check the identified lists used recently,
  *  \li then check the other identified lists,
  *  \li finally, use an anonymous list or promote the repeated anonymous
  *      list to an identified list.
  *
+ * The lists are compared with their keys, see \ref rohc_list_get_key.
+ *
  * @param comp              The list compressor
- * @param pkt_list          The list of extension headers for the current packet
+ * @param pkt_key           The key of the list of extension headers for the
+ *                          current packet
  * @param[out] is_new_list  Whether the list is new or not
  * @return                  The list to use as a base to transmit the packet list
  */
 static unsigned int rohc_list_get_nearest_list(const struct list_comp *const comp,
-                                               const struct rohc_list *const pkt_list,
+                                               const uint64_t pkt_key,
                                                bool *const is_new_list)
 {
 	const size_t anon_thres = 2;
 	unsigned int new_cur_id = ROHC_LIST_GEN_ID_NONE;
 	unsigned int gen_id;
+	size_t i;
 
 	/* check the reference list first as it is probably the correct one */
 	if(comp->ref_id != ROHC_LIST_GEN_ID_NONE &&
-	   rohc_list_equal(pkt_list, &comp->lists[comp->ref_id]))
+	   comp->lists_keys[comp->ref_id] == pkt_key)
 	{
 		/* reference list matches, no need for a new list */
 		rc_list_debug(comp, "send reference list with gen_id = %u", comp->ref_id);
@@ -487,15 +657,27 @@ static unsigned int rohc_list_get_nearest_list(const struct list_comp *const com
 	rc_list_debug(comp, "current list do not match reference list with gen_id %u",
 	              comp->ref_id);
 
-	/* search for an identified list that matches the packet one, avoid the
-	 * reference list that we already checked, stop on first unused list */
+	/* search for an identified list used recently that matches the packet
+	 * one, then for any identified list that matches the packet one, avoid
+	 * the reference list that we already checked, stop on first unused list */
+	for(i = 0; new_cur_id == ROHC_LIST_GEN_ID_NONE && i < comp->recent_ids_nr; i++)
+	{
+		gen_id = comp->recent_ids[i];
+		if(gen_id != comp->ref_id &&
+		   comp->lists[gen_id].counter > 0 &&
+		   comp->lists_keys[gen_id] == pkt_key)
+		{
+			rc_list_debug(comp, "current list matches the recent list "
+			              "with gen_id %u", gen_id);
+			new_cur_id = gen_id;
+		}
+	}
 	for(gen_id = 0; new_cur_id == ROHC_LIST_GEN_ID_NONE &&
 	                gen_id <= ROHC_LIST_GEN_ID_MAX &&
 	                comp->lists[gen_id].counter > 0; gen_id++)
 	{
 		if(gen_id != comp->ref_id &&
-		   comp->lists[gen_id].counter > 0 &&
-		   rohc_list_equal(pkt_list, &comp->lists[gen_id]))
+		   comp->lists_keys[gen_id] == pkt_key)
 		{
 			rc_list_debug(comp, "current list matches the existing list "
 			              "with gen_id %u", gen_id);
@@ -530,7 +712,7 @@ static unsigned int rohc_list_get_nearest_list(const struct list_comp *const com
 
 	/* try to use an anonymous list */
 	if(comp->lists[ROHC_LIST_GEN_ID_ANON].counter == 0 ||
-	   !rohc_list_equal(pkt_list, &comp->lists[ROHC_LIST_GEN_ID_ANON]))
+	   comp->lists_keys[ROHC_LIST_GEN_ID_ANON] != pkt_key)
 	{
 		/* new or changed anonymous list */
 		rc_list_debug(comp, "send current list as anonymous list (transmitted "
@@ -41,17 +41,38 @@
  */
 struct list_comp
 {
-	/** The translation table */
+	/** The translation table, the data of the items is allocated when the
+	 *  items are first used */
 	struct rohc_list_item trans_table[ROHC_LIST_MAX_ITEM];
 
-	/* All the possible named lists, indexed by gen_id */
-	struct rohc_list lists[ROHC_LIST_GEN_ID_MAX + 2];
+	/** All the possible named lists, indexed by gen_id, allocated with the
+	 *  first list of IPv6 extension headers, NULL before */
+	struct rohc_list *lists;
+	/** The structures of the named lists, indexed by gen_id, allocated with
+	 *  the lists, see \ref rohc_list_get_key */
+	uint64_t *lists_keys;
+#define ROHC_LIST_RECENT_MAX  4U
+	/** The gen_ids of the identified lists used recently, most recent first */
+	unsigned int recent_ids[ROHC_LIST_RECENT_MAX];
+	/** The number of gen_ids of identified lists used recently */
+	size_t recent_ids_nr;
 
 	/** The ID of the reference list */
 	unsigned int ref_id;
 	/** The ID of the current list */
 	unsigned int cur_id; /* TODO: should not be overwritten until compression
 	                              is fully OK */
+	/** Whether the current list is the reference list and is empty: then
+	 *  the packets without extension headers skip list compression */
+	bool is_empty_ref;
+
+	/** The generation of the extension headers of the packets, increased
+	 *  every time they differ from the ones of the previous packet, see
+	 *  \ref rohc_crc_static_cache */
+	size_t pkt_list_gen;
+	/** The Next Header byte of the last extension header of the previous
+	 *  packet */
+	uint8_t pkt_list_last_nh;
 
 	/** The number of uncompressed transmissions for list compression (L) */
 	size_t list_trans_nr;
@@ -74,6 +95,11 @@ struct list_comp
 	rohc_trace_callback2_t trace_callback;
 	/** The private context of the callback function used to manage traces */
 	void *trace_callback_priv;
+	/** The minimum level of the traces given to the callback function */
+	rohc_trace_level_t trace_level;
+	/** The minimum level of the traces for the current packet, chosen by
+	 *  the trace sampling of the owner, NULL if not sampled */
+	const rohc_trace_level_t *trace_pkt_level;
 	/** The profile ID the compression list was created for */
 	int profile_id;
 };
@@ -24,6 +24,7 @@
  */
 
 #include "schemes/comp_list_ipv6.h"
+#include "rohc_alloc.h"
 
 #ifndef __KERNEL__
 #  include <string.h>
@@ -48,12 +49,17 @@ static bool cmp_ipv6_ext(const struct rohc_list_item *const item,
  * @param list_trans_nr   The number of uncompressed transmissions (L)
  * @param trace_cb        The function to call for printing traces
  * @param trace_cb_priv   An optional private context, may be NULL
+ * @param trace_level     The minimum level of the traces to print
+ * @param trace_pkt_level The minimum level of the traces for the current
+ *                        packet, NULL if not sampled
  * @param profile_id      The ID of the associated decompression profile
  */
 void rohc_comp_list_ipv6_new(struct list_comp *const comp,
                              const size_t list_trans_nr,
                              rohc_trace_callback2_t trace_cb,
                              void *const trace_cb_priv,
+                             const rohc_trace_level_t trace_level,
+                             const rohc_trace_level_t *const trace_pkt_level,
                              const int profile_id)
 {
 	size_t i;
@@ -62,12 +68,15 @@ void rohc_comp_list_ipv6_new(struct list_comp *const comp,
 
 	comp->ref_id = ROHC_LIST_GEN_ID_NONE;
 	comp->cur_id = ROHC_LIST_GEN_ID_NONE;
+	comp->is_empty_ref = false;
+	comp->pkt_list_gen = 1;
+	comp->pkt_list_last_nh = 0;
 
-	for(i = 0; i <= ROHC_LIST_GEN_ID_ANON; i++)
-	{
-		rohc_list_reset(&comp->lists[i]);
-		comp->lists[i].id = i;
-	}
+	/* the lists are allocated with the first list of IPv6 extension headers,
+	 * see \ref detect_ipv6_ext_changes */
+	comp->lists = NULL;
+	comp->lists_keys = NULL;
+	comp->recent_ids_nr = 0;
 
 	for(i = 0; i < ROHC_LIST_MAX_ITEM; i++)
 	{
@@ -84,6 +93,8 @@ void rohc_comp_list_ipv6_new(struct list_comp *const comp,
 	/* traces */
 	comp->trace_callback = trace_cb;
 	comp->trace_callback_priv = trace_cb_priv;
+	comp->trace_level = trace_level;
+	comp->trace_pkt_level = trace_pkt_level;
 	comp->profile_id = profile_id;
 }
 
@@ -95,6 +106,20 @@ void rohc_comp_list_ipv6_new(struct list_comp *const comp,
  */
 void rohc_comp_list_ipv6_free(struct list_comp *const comp)
 {
+	size_t i;
+
+	for(i = 0; i < ROHC_LIST_MAX_ITEM; i++)
+	{
+		rohc_list_item_free(&comp->trans_table[i]);
+	}
+	if(comp->lists != NULL)
+	{
+		rohc_free(comp->lists);
+	}
+	if(comp->lists_keys != NULL)
+	{
+		rohc_free(comp->lists_keys);
+	}
 	memset(comp, 0, sizeof(struct list_comp));
 }
 
@@ -39,6 +39,15 @@
 	           format, ##__VA_ARGS__)
 
 
+static void ts_sc_sync_unscaled(struct ts_sc_comp *const ts_sc,
+                                const uint32_t ts_stride,
+                                const uint32_t ts_offset)
+	__attribute__((nonnull(1)));
+
+static void ts_sc_compute_scaled(struct ts_sc_comp *const ts_sc)
+	__attribute__((nonnull(1)));
+
+
 /**
  * @brief Create the ts_sc_comp object
  *
@@ -48,12 +57,17 @@
  * @param trace_cb           The trace callback
  * @param trace_cb_priv      An optional private context for the trace
  *                           callback, may be NULL
+ * @param trace_level        The minimum level of the traces to print
+ * @param trace_pkt_level    The minimum level of the traces for the current
+ *                           packet, NULL if not sampled
  * @return                   true if creation is successful, false otherwise
  */
 bool c_create_sc(struct ts_sc_comp *const ts_sc,
                  const size_t wlsb_window_width,
                  rohc_trace_callback2_t trace_cb,
-                 void *const trace_cb_priv)
+                 void *const trace_cb_priv,
+                 const rohc_trace_level_t trace_level,
+                 const rohc_trace_level_t *const trace_pkt_level)
 {
 	assert(ts_sc != NULL);
 	assert(wlsb_window_width > 0);
@@ -70,51 +84,22 @@ bool c_create_sc(struct ts_sc_comp *const ts_sc,
 	ts_sc->state = INIT_TS;
 	ts_sc->are_old_val_init = false;
 	ts_sc->nr_init_stride_packets = 0;
+	ts_sc->nr_unscaled_missing = 0;
 
 	ts_sc->trace_callback = trace_cb;
 	ts_sc->trace_callback_priv = trace_cb_priv;
+	ts_sc->trace_level = trace_level;
+	ts_sc->trace_pkt_level = trace_pkt_level;
 
 	/* W-LSB context for TS_SCALED */
-	ts_sc->ts_scaled_wlsb = c_create_wlsb(32, wlsb_window_width,
-	                                      ROHC_LSB_SHIFT_RTP_TS);
-	if(ts_sc->ts_scaled_wlsb == NULL)
-	{
-		rohc_error(ts_sc, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-		           "cannot create a W-LSB window for TS_SCALED");
-		goto error;
-	}
+	c_init_wlsb(&ts_sc->ts_scaled_wlsb, 32, wlsb_window_width,
+	            ROHC_LSB_SHIFT_RTP_TS);
 
 	/* W-LSB context for unscaled TS */
-	ts_sc->ts_unscaled_wlsb = c_create_wlsb(32, wlsb_window_width,
-	                                        ROHC_LSB_SHIFT_RTP_TS);
-	if(ts_sc->ts_unscaled_wlsb == NULL)
-	{
-		rohc_error(ts_sc, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-		           "cannot create a W-LSB window for unscaled TS");
-		goto free_ts_scaled_wlsb;
-	}
+	c_init_wlsb(&ts_sc->ts_unscaled_wlsb, 32, wlsb_window_width,
+	            ROHC_LSB_SHIFT_RTP_TS);
 
 	return true;
-
-free_ts_scaled_wlsb:
-	c_destroy_wlsb(ts_sc->ts_scaled_wlsb);
-error:
-	return false;
-}
-
-
-/**
- * @brief Destroy the ts_sc_comp object
- *
- * @param ts_sc        The ts_sc_comp object to destroy
- */
-void c_destroy_sc(struct ts_sc_comp *const ts_sc)
-{
-	assert(ts_sc != NULL);
-	assert(ts_sc->ts_unscaled_wlsb != NULL);
-	assert(ts_sc->ts_scaled_wlsb != NULL);
-	c_destroy_wlsb(ts_sc->ts_unscaled_wlsb);
-	c_destroy_wlsb(ts_sc->ts_scaled_wlsb);
 }
 
 
@@ -183,6 +168,7 @@ void c_add_ts(struct ts_sc_comp *const ts_sc,
 	if(ts_sc->ts_delta == 0)
 	{
 		ts_debug(ts_sc, "TS is constant, go in INIT_TS state");
+		ts_sc_sync_unscaled(ts_sc, ts_sc->ts_stride, ts_sc->ts_offset);
 		ts_sc->state = INIT_TS;
 		return;
 	}
@@ -193,6 +179,7 @@ void c_add_ts(struct ts_sc_comp *const ts_sc,
 		/* TS_STRIDE is too large for SDVL encoding */
 		ts_debug(ts_sc, "TS_STRIDE is too large for SDVL encoding, "
 		         "go in INIT_TS state");
+		ts_sc_sync_unscaled(ts_sc, ts_sc->ts_stride, ts_sc->ts_offset);
 		ts_sc->state = INIT_TS;
 		return;
 	}
@@ -207,29 +194,28 @@ void c_add_ts(struct ts_sc_comp *const ts_sc,
 
 	if(ts_sc->state == INIT_STRIDE)
 	{
+		const uint32_t old_offset = ts_sc->ts_offset;
+		bool is_stride_changed = false;
+
 		/* TS is changing and TS_STRIDE can be computed but TS_STRIDE was
 		 * not transmitted enough times to the decompressor to be used */
 		ts_debug(ts_sc, "state INIT_STRIDE");
 
+		/* compute TS_STRIDE, TS_OFFSET and TS_SCALED */
+		if(ts_sc->ts_delta != ts_sc->ts_stride)
+		{
+			is_stride_changed = true;
+			ts_sc->ts_stride = ts_sc->ts_delta;
+		}
+		ts_debug(ts_sc, "TS_STRIDE = %u", ts_sc->ts_stride);
+		ts_sc_compute_scaled(ts_sc);
+
 		/* reset INIT_STRIDE counter if TS_STRIDE/TS_OFFSET changed */
-		if(ts_sc->ts_delta != ts_sc->ts_stride ||
-		   (ts_sc->ts % ts_sc->ts_delta) != ts_sc->ts_offset)
+		if(is_stride_changed || ts_sc->ts_offset != old_offset)
 		{
 			ts_debug(ts_sc, "TS_STRIDE and/or TS_OFFSET changed");
 			ts_sc->nr_init_stride_packets = 0;
 		}
-
-		/* compute TS_STRIDE, TS_OFFSET and TS_SCALED */
-		ts_sc->ts_stride = ts_sc->ts_delta;
-		ts_debug(ts_sc, "TS_STRIDE = %u", ts_sc->ts_stride);
-		assert(ts_sc->ts_stride != 0);
-		ts_sc->ts_offset = ts_sc->ts % ts_sc->ts_stride;
-		ts_debug(ts_sc, "TS_OFFSET = %u modulo %u = %u",
-		         ts_sc->ts, ts_sc->ts_stride, ts_sc->ts_offset);
-		assert(ts_sc->ts_stride != 0);
-		ts_sc->ts_scaled = (ts_sc->ts - ts_sc->ts_offset) / ts_sc->ts_stride;
-		ts_debug(ts_sc, "TS_SCALED = (%u - %u) / %u = %u", ts_sc->ts,
-		         ts_sc->ts_offset, ts_sc->ts_stride, ts_sc->ts_scaled);
 	}
 	else if(ts_sc->state == SEND_SCALED)
 	{
@@ -255,6 +241,7 @@ void c_add_ts(struct ts_sc_comp *const ts_sc,
 				         "of previous TS_STRIDE, so change TS_STRIDE and "
 				         "transmit it several times along all TS bits "
 				         "(probably a clock resync at source)");
+				ts_sc_sync_unscaled(ts_sc, ts_sc->ts_stride, old_offset);
 				ts_sc->state = INIT_STRIDE;
 				ts_sc->nr_init_stride_packets = 0;
 				ts_debug(ts_sc, "state -> INIT_STRIDE");
@@ -269,6 +256,7 @@ void c_add_ts(struct ts_sc_comp *const ts_sc,
 				         "previous TS_STRIDE, so do not change TS_STRIDE, but "
 				         "retransmit it several times along all TS bits "
 				         "(probably a RTP TS jump at source)");
+				ts_sc_sync_unscaled(ts_sc, ts_sc->ts_stride, old_offset);
 				ts_sc->state = INIT_STRIDE;
 				ts_sc->nr_init_stride_packets = 0;
 				ts_debug(ts_sc, "state -> INIT_STRIDE");
@@ -283,17 +271,8 @@ void c_add_ts(struct ts_sc_comp *const ts_sc,
 		}
 		ts_debug(ts_sc, "TS_STRIDE = %u", ts_sc->ts_stride);
 
-		/* update TS_OFFSET is needed */
-		assert(ts_sc->ts_stride != 0);
-		ts_sc->ts_offset = ts_sc->ts % ts_sc->ts_stride;
-		ts_debug(ts_sc, "TS_OFFSET = %u modulo %u = %u",
-		         ts_sc->ts, ts_sc->ts_stride, ts_sc->ts_offset);
-
-		/* compute TS_SCALED */
-		assert(ts_sc->ts_stride != 0);
-		ts_sc->ts_scaled = (ts_sc->ts - ts_sc->ts_offset) / ts_sc->ts_stride;
-		ts_debug(ts_sc, "TS_SCALED = (%u - %u) / %u = %u", ts_sc->ts,
-		         ts_sc->ts_offset, ts_sc->ts_stride, ts_sc->ts_scaled);
+		/* update TS_OFFSET if needed and compute TS_SCALED */
+		ts_sc_compute_scaled(ts_sc);
 
 		/* could TS_SCALED be deduced from SN? */
 		if(ts_sc->state != SEND_SCALED)
@@ -352,6 +331,7 @@ void c_add_ts(struct ts_sc_comp *const ts_sc,
 			if(old_offset != ts_sc->ts_offset)
 			{
 				ts_debug(ts_sc, "TS_OFFSET changed, re-initialize TS_STRIDE");
+				ts_sc_sync_unscaled(ts_sc, ts_sc->ts_stride, old_offset);
 				ts_sc->state = INIT_STRIDE;
 				ts_sc->nr_init_stride_packets = 0;
 			}
@@ -371,6 +351,87 @@ void c_add_ts(struct ts_sc_comp *const ts_sc,
 }
 
 
+/**
+ * @brief Initialize TS_STRIDE again, eg. after a transition back to IR state
+ *
+ * @param ts_sc  The ts_sc_comp object
+ */
+void c_ts_sc_reinit_stride(struct ts_sc_comp *const ts_sc)
+{
+	if(ts_sc->state == SEND_SCALED)
+	{
+		ts_sc_sync_unscaled(ts_sc, ts_sc->ts_stride, ts_sc->ts_offset);
+	}
+	ts_sc->state = INIT_STRIDE;
+	ts_sc->nr_init_stride_packets = 0;
+}
+
+
+/**
+ * @brief Compute TS_OFFSET and TS_SCALED from TS and TS_STRIDE
+ *
+ * Once TS_STRIDE is stable, TS moves forward by one TS_STRIDE at every
+ * packet: TS_OFFSET does not change and TS_SCALED is incremented. That
+ * guess is checked with one multiplication, the divisions are only required
+ * when it fails.
+ *
+ * @param ts_sc  The ts_sc_comp object
+ */
+static void ts_sc_compute_scaled(struct ts_sc_comp *const ts_sc)
+{
+	const uint32_t next_scaled = ts_sc->ts_scaled + 1;
+
+	assert(ts_sc->ts_stride != 0);
+
+	if(ts_sc->ts_offset < ts_sc->ts_stride &&
+	   (((uint64_t) next_scaled) * ts_sc->ts_stride + ts_sc->ts_offset) == ts_sc->ts)
+	{
+		ts_sc->ts_scaled = next_scaled;
+	}
+	else
+	{
+		ts_sc->ts_offset = ts_sc->ts % ts_sc->ts_stride;
+		ts_sc->ts_scaled = (ts_sc->ts - ts_sc->ts_offset) / ts_sc->ts_stride;
+	}
+	ts_debug(ts_sc, "TS_OFFSET = %u modulo %u = %u",
+	         ts_sc->ts, ts_sc->ts_stride, ts_sc->ts_offset);
+	ts_debug(ts_sc, "TS_SCALED = (%u - %u) / %u = %u", ts_sc->ts,
+	         ts_sc->ts_offset, ts_sc->ts_stride, ts_sc->ts_scaled);
+}
+
+
+/**
+ * @brief Add the missing unscaled TS values to the unscaled TS window
+ *
+ * In state SEND_SCALED, only the TS_SCALED window is used, so the unscaled
+ * TS values are not added to their window. They are computed back from the
+ * last TS_SCALED values when leaving state SEND_SCALED, as if they were
+ * added all along.
+ *
+ * @param ts_sc      The ts_sc_comp object
+ * @param ts_stride  The TS_STRIDE the TS_SCALED values were computed with
+ * @param ts_offset  The TS_OFFSET the TS_SCALED values were computed with
+ */
+static void ts_sc_sync_unscaled(struct ts_sc_comp *const ts_sc,
+                                const uint32_t ts_stride,
+                                const uint32_t ts_offset)
+{
+	const struct c_wlsb *const scaled_wlsb = &ts_sc->ts_scaled_wlsb;
+	size_t entry;
+
+	assert(ts_sc->nr_unscaled_missing <= scaled_wlsb->count);
+
+	entry = (scaled_wlsb->next - ts_sc->nr_unscaled_missing) & scaled_wlsb->window_mask;
+	for(; ts_sc->nr_unscaled_missing > 0; ts_sc->nr_unscaled_missing--)
+	{
+		const uint32_t ts_scaled = scaled_wlsb->window_values[entry];
+		c_add_wlsb(&ts_sc->ts_unscaled_wlsb, scaled_wlsb->window_sns[entry],
+		           ts_scaled * ts_stride + ts_offset);
+		entry = (entry + 1) & scaled_wlsb->window_mask;
+	}
+}
+
+
 /**
  * @brief Return the number of bits needed to encode unscaled TS
  *
@@ -387,9 +448,9 @@ void nb_bits_unscaled(const struct ts_sc_comp *const ts_sc,
                       size_t *const bits_nr_more_than_2)
 {
 	*bits_nr_less_equal_than_2 =
-		wlsb_get_kp_32bits(ts_sc->ts_unscaled_wlsb, ts_sc->ts, 0);
+		wlsb_get_kp_32bits(&ts_sc->ts_unscaled_wlsb, ts_sc->ts, 0);
 	*bits_nr_more_than_2 =
-		wlsb_get_mink_32bits(ts_sc->ts_unscaled_wlsb, ts_sc->ts, 3);
+		wlsb_get_mink_32bits(&ts_sc->ts_unscaled_wlsb, ts_sc->ts, 3);
 }
 
 
@@ -399,10 +460,10 @@ void nb_bits_unscaled(const struct ts_sc_comp *const ts_sc,
  * @param ts_sc  The ts_sc_comp object
  * @param sn     The Sequence Number
  */
-void add_unscaled(const struct ts_sc_comp *const ts_sc, const uint16_t sn)
+void add_unscaled(struct ts_sc_comp *const ts_sc, const uint16_t sn)
 {
 	assert(ts_sc != NULL);
-	c_add_wlsb(ts_sc->ts_unscaled_wlsb, sn, ts_sc->ts);
+	c_add_wlsb(&ts_sc->ts_unscaled_wlsb, sn, ts_sc->ts);
 }
 
 
@@ -422,9 +483,9 @@ void nb_bits_scaled(const struct ts_sc_comp *const ts_sc,
                     size_t *const bits_nr_more_than_2)
 {
 	*bits_nr_less_equal_than_2 =
-		wlsb_get_kp_32bits(ts_sc->ts_scaled_wlsb, ts_sc->ts_scaled, 0);
+		wlsb_get_kp_32bits(&ts_sc->ts_scaled_wlsb, ts_sc->ts_scaled, 0);
 	*bits_nr_more_than_2 =
-		wlsb_get_mink_32bits(ts_sc->ts_scaled_wlsb, ts_sc->ts_scaled, 3);
+		wlsb_get_mink_32bits(&ts_sc->ts_scaled_wlsb, ts_sc->ts_scaled, 3);
 
 	/* do not send 0 bit of TS if TS is not deducible, because decompressor
 	 * will interprets a 0-bit value as deducible */
@@ -448,10 +509,16 @@ void nb_bits_scaled(const struct ts_sc_comp *const ts_sc,
  * @param ts_sc        The ts_sc_comp object
  * @param sn           The Sequence Number
  */
-void add_scaled(const struct ts_sc_comp *const ts_sc, const uint16_t sn)
+void add_scaled(struct ts_sc_comp *const ts_sc, const uint16_t sn)
 {
 	assert(ts_sc != NULL);
-	c_add_wlsb(ts_sc->ts_scaled_wlsb, sn, ts_sc->ts_scaled);
+	c_add_wlsb(&ts_sc->ts_scaled_wlsb, sn, ts_sc->ts_scaled);
+
+	/* the unscaled TS value is added later if ever needed */
+	if(ts_sc->nr_unscaled_missing < ts_sc->ts_scaled_wlsb.window_width)
+	{
+		ts_sc->nr_unscaled_missing++;
+	}
 }
 
 
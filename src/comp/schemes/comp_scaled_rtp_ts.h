@@ -72,7 +72,7 @@ struct ts_sc_comp
 	/// The TS_SCALED value
 	uint32_t ts_scaled;
 	/** The W-LSB object used to encode the TS_SCALED value */
-	struct c_wlsb *ts_scaled_wlsb;
+	struct c_wlsb ts_scaled_wlsb;
 
 	/// The TS_OFFSET value
 	uint32_t ts_offset;
@@ -80,7 +80,7 @@ struct ts_sc_comp
 	/// The timestamp (TS)
 	uint32_t ts;
 	/** The W-LSB object used to encode the TS value */
-	struct c_wlsb *ts_unscaled_wlsb;
+	struct c_wlsb ts_unscaled_wlsb;
 	/// The previous timestamp
 	uint32_t old_ts;
 
@@ -98,6 +98,10 @@ struct ts_sc_comp
 	bool are_old_val_init;
 	/// The number of packets sent in state INIT_STRIDE
 	size_t nr_init_stride_packets;
+	/** The number of TS_SCALED values added while the unscaled TS values were
+	 *  not: they are added to the unscaled TS window when leaving state
+	 *  SEND_SCALED */
+	size_t nr_unscaled_missing;
 
 	/// The difference between old and current TS
 	uint32_t ts_delta;
@@ -106,6 +110,11 @@ struct ts_sc_comp
 	rohc_trace_callback2_t trace_callback;
 	/** The private context of the callback function used to manage traces */
 	void *trace_callback_priv;
+	/** The minimum level of the traces given to the callback function */
+	rohc_trace_level_t trace_level;
+	/** The minimum level of the traces for the current packet, chosen by
+	 *  the trace sampling of the owner, NULL if not sampled */
+	const rohc_trace_level_t *trace_pkt_level;
 };
 
 
@@ -117,25 +126,29 @@ struct ts_sc_comp
 bool c_create_sc(struct ts_sc_comp *const ts_sc,
                  const size_t wlsb_window_width,
                  rohc_trace_callback2_t trace_cb,
-                 void *const trace_cb_priv)
+                 void *const trace_cb_priv,
+                 const rohc_trace_level_t trace_level,
+                 const rohc_trace_level_t *const trace_pkt_level)
 	__attribute__((warn_unused_result));
-void c_destroy_sc(struct ts_sc_comp *const ts_sc);
 
 void c_add_ts(struct ts_sc_comp *const ts_sc,
               const uint32_t ts,
               const uint16_t sn);
 
+void c_ts_sc_reinit_stride(struct ts_sc_comp *const ts_sc)
+	__attribute__((nonnull(1)));
+
 void nb_bits_unscaled(const struct ts_sc_comp *const ts_sc,
                       size_t *const bits_nr_less_equal_than_2,
                       size_t *const bits_nr_more_than_2)
 	__attribute__((nonnull(1, 2, 3)));
-void add_unscaled(const struct ts_sc_comp *const ts_sc, const uint16_t sn);
+void add_unscaled(struct ts_sc_comp *const ts_sc, const uint16_t sn);
 
 void nb_bits_scaled(const struct ts_sc_comp *const ts_sc,
                     size_t *const bits_nr_less_equal_than_2,
                     size_t *const bits_nr_more_than_2)
 	__attribute__((nonnull(1, 2, 3)));
-void add_scaled(const struct ts_sc_comp *const ts_sc, const uint16_t sn);
+void add_scaled(struct ts_sc_comp *const ts_sc, const uint16_t sn);
 
 uint32_t get_ts_stride(const struct ts_sc_comp *const ts_sc)
 	__attribute__((nonnull(1), warn_unused_result, pure));
@@ -34,50 +34,6 @@
 #include <assert.h>
 
 
-/*
- * Private structures and types
- */
-
-/**
- * @brief Define a W-LSB window entry
- */
-struct c_window
-{
-	uint32_t sn;     /**< The Sequence Number (SN) associated with the entry
-	                      (used to acknowledge the entry) */
-	uint32_t value;  /**< The value stored in the window entry */
-};
-
-
-/**
- * @brief Defines a W-LSB encoding object
- */
-struct c_wlsb
-{
-	/// The width of the window
-	size_t window_width; /* TODO: R-mode needs a non-fixed window width */
-
-	/// The size of the window (power of 2) minus 1
-	size_t window_mask;
-
-	/// A pointer on the oldest entry in the window (change on acknowledgement)
-	size_t oldest;
-	/// A pointer on the current entry in the window  (change on add and ack)
-	size_t next;
-
-	/// Count of entries in the window
-	size_t count;
-
-	/// The maximal number of bits for representing the value
-	size_t bits;
-	/// Shift parameter (see 4.5.2 in the RFC 3095)
-	rohc_lsb_shift_t p;
-
-	/** The window in which previous values of the encoded value are stored */
-	struct c_window window[1];
-};
-
-
 /*
  * Private function prototypes:
  */
@@ -85,9 +41,25 @@ struct c_wlsb
 static size_t wlsb_get_next_older(const size_t entry, const size_t max)
 	__attribute__((warn_unused_result, const));
 
+static bool wlsb_find_sn(const struct c_wlsb *const wlsb,
+                         const uint32_t sn_bits,
+                         const size_t sn_bits_nr,
+                         size_t *const pos)
+	__attribute__((warn_unused_result, nonnull(1, 4)));
+
 static size_t wlsb_ack_remove(struct c_wlsb *const wlsb, const size_t pos)
 	__attribute__((warn_unused_result, nonnull(1)));
 
+static void wlsb_ack_shrink(struct c_wlsb *const wlsb)
+	__attribute__((nonnull(1)));
+
+static void wlsb_range_add(struct c_wlsb *const wlsb,
+                           const uint32_t value,
+                           const bool is_first)
+	__attribute__((nonnull(1)));
+static void wlsb_range_update(struct c_wlsb *const wlsb)
+	__attribute__((nonnull(1)));
+
 static size_t rohc_g_8bits(const uint8_t v_ref,
                            const uint8_t v,
                            const rohc_lsb_shift_t p,
@@ -114,54 +86,44 @@ static size_t rohc_g_32bits(const uint32_t v_ref,
  */
 
 /**
- * @brief Create a new Window-based Least Significant Bits (W-LSB) encoding
+ * @brief Initialize a Window-based Least Significant Bits (W-LSB) encoding
  *        object
  *
+ * The window starts with the given width. Once the decompressor acknowledged
+ * some of its entries, the window may grow up to \ref ROHC_WLSB_WIDTH_MAX
+ * entries instead of overwriting entries that were not acknowledged yet, and
+ * shrink back towards the given width when the acknowledgements catch up.
+ *
+ * @param wlsb         The W-LSB object to initialize
  * @param bits         The maximal number of bits for representing a value
  * @param window_width The number of entries in the window (power of 2)
  * @param p            Shift parameter (see 4.5.2 in the RFC 3095)
- * @return             The newly-created W-LSB encoding object
  */
-struct c_wlsb * c_create_wlsb(const size_t bits,
-                              const size_t window_width,
-                              const rohc_lsb_shift_t p)
+void c_init_wlsb(struct c_wlsb *const wlsb,
+                 const size_t bits,
+                 const size_t window_width,
+                 const rohc_lsb_shift_t p)
 {
-	struct c_wlsb *wlsb;
-
 	assert(bits > 0);
 	assert(window_width > 0);
+	assert(window_width <= ROHC_WLSB_WIDTH_MAX);
 	/* window_width must be a power of 2! */
 	assert(window_width != 0 && (window_width & (window_width - 1)) == 0);
 
-	wlsb = malloc(sizeof(struct c_wlsb) + (window_width - 1) * sizeof(struct c_window));
-	if(wlsb == NULL)
-	{
-		goto error;
-	}
-
 	wlsb->oldest = 0;
 	wlsb->next = 0;
 	wlsb->count = 0;
+	wlsb->sn_consecutive_nr = 0;
 	wlsb->window_width = window_width;
-	wlsb->window_mask = window_width - 1;
+	wlsb->window_width_min = window_width;
+	wlsb->is_acked = false;
+	wlsb->window_mask = ROHC_WLSB_WIDTH_MAX - 1;
 	wlsb->bits = bits;
 	wlsb->p = p;
-
-	return wlsb;
-
-error:
-	return NULL;
-}
-
-
-/**
- * @brief Destroy a Window-based LSB (W-LSB) encoding object
- *
- * @param wlsb  The W-LSB object to destroy
- */
-void c_destroy_wlsb(struct c_wlsb *const wlsb)
-{
-	free(wlsb);
+	wlsb->is_range_ok = false;
+	wlsb->range_min = 0;
+	wlsb->range_max = 0;
+	wlsb->range_width = 0;
 }
 
 
@@ -177,22 +139,66 @@ void c_add_wlsb(struct c_wlsb *const wlsb,
                 const uint32_t value)
 {
 	assert(wlsb != NULL);
-	assert(wlsb->window != NULL);
-	assert(wlsb->next < wlsb->window_width);
+	assert(wlsb->next <= wlsb->window_mask);
+	assert(wlsb->count <= wlsb->window_width);
+
+	/* if window is full and acknowledgements are received, grow the window
+	 * rather than overwrite an entry that the decompressor might still use as
+	 * reference: the acknowledgements will shrink it back later */
+	if(wlsb->count == wlsb->window_width && wlsb->is_acked &&
+	   wlsb->window_width < ROHC_WLSB_WIDTH_MAX)
+	{
+		wlsb->window_width *= 2;
+	}
+
+	/* count the newest entries with consecutive SNs */
+	if(wlsb->count > 0 &&
+	   sn == (wlsb->window_sns[(wlsb->next - 1) & wlsb->window_mask] + 1))
+	{
+		wlsb->sn_consecutive_nr++;
+	}
+	else
+	{
+		wlsb->sn_consecutive_nr = 1;
+	}
 
 	/* if window is full, an entry is overwritten */
 	if(wlsb->count == wlsb->window_width)
 	{
+		const uint32_t old_value = wlsb->window_values[wlsb->oldest];
+
 		wlsb->oldest = (wlsb->oldest + 1) & wlsb->window_mask;
+
+		wlsb->window_sns[wlsb->next] = sn;
+		wlsb->window_values[wlsb->next] = value;
+		wlsb->next = (wlsb->next + 1) & wlsb->window_mask;
+
+		/* compute the interval of window values again only if the overwritten
+		 * entry was one of its bounds */
+		if(!wlsb->is_range_ok || old_value == wlsb->range_min ||
+		   old_value == wlsb->range_max)
+		{
+			wlsb_range_update(wlsb);
+		}
+		else
+		{
+			wlsb_range_add(wlsb, value, false);
+		}
 	}
 	else
 	{
 		wlsb->count++;
-	}
 
-	wlsb->window[wlsb->next].sn = sn;
-	wlsb->window[wlsb->next].value = value;
-	wlsb->next = (wlsb->next + 1) & wlsb->window_mask;
+		wlsb->window_sns[wlsb->next] = sn;
+		wlsb->window_values[wlsb->next] = value;
+		wlsb->next = (wlsb->next + 1) & wlsb->window_mask;
+
+		wlsb_range_add(wlsb, value, wlsb->count == 1);
+	}
+	if(wlsb->sn_consecutive_nr > wlsb->count)
+	{
+		wlsb->sn_consecutive_nr = wlsb->count;
+	}
 }
 
 
@@ -234,6 +240,13 @@ size_t wlsb_get_kp_8bits(const struct c_wlsb *const wlsb,
 	{
 		bits_nr = wlsb->bits;
 	}
+	else if(wlsb->is_range_ok && wlsb->range_width <= 0x7f)
+	{
+		/* the bounds of the interval of window values require the most bits */
+		const size_t k_min = rohc_g_8bits(wlsb->range_min, value, p, wlsb->bits);
+		const size_t k_max = rohc_g_8bits(wlsb->range_max, value, p, wlsb->bits);
+		bits_nr = (k_min > k_max ? k_min : k_max);
+	}
 	else
 	{
 		size_t entry;
@@ -248,7 +261,7 @@ size_t wlsb_get_kp_8bits(const struct c_wlsb *const wlsb,
 		    i--, entry = (entry + 1) & wlsb->window_mask)
 		{
 			const size_t k =
-				rohc_g_8bits(wlsb->window[entry].value, value, p, wlsb->bits);
+				rohc_g_8bits(wlsb->window_values[entry], value, p, wlsb->bits);
 			if(k > bits_nr)
 			{
 				bits_nr = k;
@@ -341,6 +354,15 @@ size_t wlsb_get_minkp_16bits(const struct c_wlsb *const wlsb,
 	{
 		bits_nr = wlsb->bits;
 	}
+	else if(wlsb->is_range_ok && wlsb->range_width <= 0x7fff)
+	{
+		/* the bounds of the interval of window values require the most bits */
+		const size_t k_min =
+			rohc_g_16bits(wlsb->range_min, value, min_k, p, wlsb->bits);
+		const size_t k_max =
+			rohc_g_16bits(wlsb->range_max, value, min_k, p, wlsb->bits);
+		bits_nr = (k_min > k_max ? k_min : k_max);
+	}
 	else
 	{
 		size_t entry;
@@ -355,7 +377,7 @@ size_t wlsb_get_minkp_16bits(const struct c_wlsb *const wlsb,
 		    i--, entry = (entry + 1) & wlsb->window_mask)
 		{
 			const size_t k =
-				rohc_g_16bits(wlsb->window[entry].value, value, min_k, p, wlsb->bits);
+				rohc_g_16bits(wlsb->window_values[entry], value, min_k, p, wlsb->bits);
 			if(k > bits_nr)
 			{
 				bits_nr = k;
@@ -443,7 +465,6 @@ size_t wlsb_get_minkp_32bits(const struct c_wlsb *const wlsb,
 {
 	size_t bits_nr;
 
-	assert(wlsb->window != NULL);
 	assert(value <= 0xffffffff);
 
 	/* use all bits if the window contains no value */
@@ -451,6 +472,15 @@ size_t wlsb_get_minkp_32bits(const struct c_wlsb *const wlsb,
 	{
 		bits_nr = wlsb->bits;
 	}
+	else if(wlsb->is_range_ok)
+	{
+		/* the bounds of the interval of window values require the most bits */
+		const size_t k_min =
+			rohc_g_32bits(wlsb->range_min, value, min_k, p, wlsb->bits);
+		const size_t k_max =
+			rohc_g_32bits(wlsb->range_max, value, min_k, p, wlsb->bits);
+		bits_nr = (k_min > k_max ? k_min : k_max);
+	}
 	else
 	{
 		size_t entry;
@@ -465,7 +495,7 @@ size_t wlsb_get_minkp_32bits(const struct c_wlsb *const wlsb,
 		    i--, entry = (entry + 1) & wlsb->window_mask)
 		{
 			const size_t k =
-				rohc_g_32bits(wlsb->window[entry].value, value, min_k, p, wlsb->bits);
+				rohc_g_32bits(wlsb->window_values[entry], value, min_k, p, wlsb->bits);
 			if(k > bits_nr)
 			{
 				bits_nr = k;
@@ -478,23 +508,106 @@ size_t wlsb_get_minkp_32bits(const struct c_wlsb *const wlsb,
 }
 
 
+/**
+ * @brief Get the Sequence Number (SN) acknowledged by the given SN bits
+ *
+ * The acknowledged SN is the newest SN of the window that matches the given
+ * SN bits. All the windows of one context share the SNs of their entries: the
+ * full SN found once in the SN window may then be used to acknowledge all the
+ * other windows of the context with \ref wlsb_ack and 32 SN bits.
+ *
+ * @param wlsb        The W-LSB object
+ * @param sn_bits     The LSB of the SN to acknowledge
+ * @param sn_bits_nr  The number of LSB of the SN to acknowledge
+ * @param[out] sn     The full acknowledged SN
+ * @return            true if one window entry matches the SN bits,
+ *                    false otherwise
+ */
+bool wlsb_get_acked_sn(const struct c_wlsb *const wlsb,
+                       const uint32_t sn_bits,
+                       const size_t sn_bits_nr,
+                       uint32_t *const sn)
+{
+	size_t pos;
+
+	if(!wlsb_find_sn(wlsb, sn_bits, sn_bits_nr, &pos))
+	{
+		return false;
+	}
+	*sn = wlsb->window_sns[pos];
+
+	return true;
+}
+
+
 /**
  * @brief Acknowledge based on the Sequence Number (SN)
  *
  * Removes all window entries older (and including) than the one that matches
- * the given SN bits.
+ * the given SN bits. If the width of the window is variable, the window that
+ * grew because of late acknowledgements then shrinks back if few entries
+ * remain unacknowledged.
  *
  * @param wlsb        The W-LSB object
  * @param sn_bits     The LSB of the SN to acknowledge
  * @param sn_bits_nr  The number of LSB of the SN to acknowledge
+ * @param is_width_variable  Whether the width of the window may change with
+ *                           the acknowledgements
  * @return            The number of acked window entries
  */
 size_t wlsb_ack(struct c_wlsb *const wlsb,
                 const uint32_t sn_bits,
-                const size_t sn_bits_nr)
+                const size_t sn_bits_nr,
+                const bool is_width_variable)
 {
-	size_t entry = wlsb->next;
+	size_t acked_nr;
+	size_t pos;
+
+	if(!wlsb_find_sn(wlsb, sn_bits, sn_bits_nr, &pos))
+	{
+		return 0;
+	}
+
+	/* remove the window entry and all the older ones if found */
+	acked_nr = wlsb_ack_remove(wlsb, pos);
+	if(is_width_variable)
+	{
+		wlsb->is_acked = true;
+		wlsb_ack_shrink(wlsb);
+	}
+
+	return acked_nr;
+}
+
+
+/*
+ * Private functions
+ */
+
+
+/**
+ * @brief Find the newest window entry that matches the given SN bits
+ *
+ * The SNs of the window entries increase from the oldest entry to the newest
+ * one. Among the newest entries with consecutive SNs, the entry that matches
+ * the SN bits is located directly from its distance to the newest SN. The
+ * older entries are scanned one by one only if no such entry matches.
+ *
+ * @param wlsb        The W-LSB object
+ * @param sn_bits     The LSB of the SN to search for
+ * @param sn_bits_nr  The number of LSB of the SN to search for
+ * @param[out] pos    The position of the matching entry in the window
+ * @return            true if one window entry matches, false otherwise
+ */
+static bool wlsb_find_sn(const struct c_wlsb *const wlsb,
+                         const uint32_t sn_bits,
+                         const size_t sn_bits_nr,
+                         size_t *const pos)
+{
+	const size_t newest = (wlsb->next - 1) & wlsb->window_mask;
 	uint32_t sn_mask;
+	uint32_t sn_delta;
+	size_t entry;
 	size_t i;
 
 	if(sn_bits_nr < 32)
@@ -507,27 +620,41 @@ size_t wlsb_ack(struct c_wlsb *const wlsb,
 	}
 	assert((sn_bits & sn_mask) == sn_bits);
 
-	/* search for the window entry that matches the given SN LSB
-	 * starting from the one */
-	for(i = 0; i < wlsb->count; i++)
+	if(wlsb->count == 0)
+	{
+		return false;
+	}
+	assert(wlsb->sn_consecutive_nr > 0);
+	assert(wlsb->sn_consecutive_nr <= wlsb->count);
+
+	/* the newest entries with consecutive SNs are located directly: the
+	 * entry that is sn_delta entries older than the newest one has the SN
+	 * that matches, and no newer entry may match */
+	sn_delta = (wlsb->window_sns[newest] - sn_bits) & sn_mask;
+	if(sn_delta < wlsb->sn_consecutive_nr)
+	{
+		*pos = (newest - sn_delta) & wlsb->window_mask;
+		return true;
+	}
+
+	/* none of the newest entries with consecutive SNs matches, their SN
+	 * distances to the newest SN being lower than sn_delta: search for the
+	 * window entry that matches the given SN LSB among the older ones */
+	entry = (newest - wlsb->sn_consecutive_nr + 1) & wlsb->window_mask;
+	for(i = wlsb->sn_consecutive_nr; i < wlsb->count; i++)
 	{
 		entry = wlsb_get_next_older(entry, wlsb->window_mask);
-		if((wlsb->window[entry].sn & sn_mask) == sn_bits)
+		if((wlsb->window_sns[entry] & sn_mask) == sn_bits)
 		{
-			/* remove the window entry and all the older ones if found */
-			return wlsb_ack_remove(wlsb, entry);
+			*pos = entry;
+			return true;
 		}
 	}
 
-	return 0;
+	return false;
 }
 
 
-/*
- * Private functions
- */
-
-
 /**
  * @brief Get the next older entry
  *
@@ -560,10 +687,111 @@ static size_t wlsb_ack_remove(struct c_wlsb *const wlsb, const size_t pos)
 		acked_nr++;
 	}
 
+	if(wlsb->sn_consecutive_nr > wlsb->count)
+	{
+		wlsb->sn_consecutive_nr = wlsb->count;
+	}
+
+	/* the bounds of the interval of window values may have been removed */
+	if(acked_nr > 0)
+	{
+		wlsb_range_update(wlsb);
+	}
+
 	return acked_nr;
 }
 
 
+/**
+ * @brief Shrink the window once acknowledgements caught up
+ *
+ * The width is halved while at most one quarter of the window is still
+ * unacknowledged, so that a window does not oscillate between 2 widths. The
+ * window never shrinks below the width configured at init.
+ *
+ * @param wlsb  The W-LSB object
+ */
+static void wlsb_ack_shrink(struct c_wlsb *const wlsb)
+{
+	while(wlsb->window_width > wlsb->window_width_min &&
+	      wlsb->count <= (wlsb->window_width / 4))
+	{
+		wlsb->window_width /= 2;
+	}
+}
+
+
+/**
+ * @brief Extend the interval of window values with a new window value
+ *
+ * The interval is extended towards the new value on the side that keeps it
+ * the narrowest. The interval is computed for 32-bit values, its bounds
+ * truncated to 8 or 16 bits give the interval for the shorter fields. The
+ * interval is not used for a field once it covers half the field or more:
+ * the window values are then scanned one by one.
+ *
+ * @param wlsb      The W-LSB object
+ * @param value     The new window value
+ * @param is_first  Whether the value is the first one of the window
+ */
+static void wlsb_range_add(struct c_wlsb *const wlsb,
+                           const uint32_t value,
+                           const bool is_first)
+{
+	if(is_first)
+	{
+		wlsb->range_min = value;
+		wlsb->range_max = value;
+		wlsb->range_width = 0;
+		wlsb->is_range_ok = true;
+	}
+	else if(wlsb->is_range_ok)
+	{
+		const uint32_t above_min = value - wlsb->range_min;
+
+		if(above_min > wlsb->range_width)
+		{
+			/* the value is out of the interval: move the nearest bound */
+			const uint32_t width_up = above_min;
+			const uint32_t width_down =
+				wlsb->range_width + (wlsb->range_min - value);
+
+			if(width_up <= width_down)
+			{
+				wlsb->range_max = value;
+				wlsb->range_width = width_up;
+			}
+			else
+			{
+				wlsb->range_min = value;
+				wlsb->range_width = width_down;
+			}
+			wlsb->is_range_ok = (wlsb->range_width <= 0x7fffffffU);
+		}
+	}
+}
+
+
+/**
+ * @brief Compute the interval of window values from all the window entries
+ *
+ * @param wlsb  The W-LSB object
+ */
+static void wlsb_range_update(struct c_wlsb *const wlsb)
+{
+	size_t entry;
+	size_t i;
+
+	wlsb->is_range_ok = false;
+	for(i = 0, entry = wlsb->oldest;
+	    i < wlsb->count;
+	    i++, entry = (entry + 1) & wlsb->window_mask)
+	{
+		wlsb_range_add(wlsb, wlsb->window_values[entry], i == 0);
+	}
+}
+
+
 /**
  * @brief The g function as defined in LSB encoding for 8-bit fields
  *
@@ -587,25 +815,39 @@ static size_t rohc_g_8bits(const uint8_t v_ref,
 
 	assert(bits_nr <= 8);
 
-	for(k = 0; k < bits_nr; k++)
+	if(rohc_interval_is_p_const(p))
 	{
-		interval = rohc_f_8bits(v_ref, k, p);
-		if(interval.min <= interval.max)
+		/* all the intervals start at v_ref - p, so v belongs to f(v_ref, k) as
+		 * soon as its distance to v_ref - p fits in k bits */
+		const uint8_t dist = v - (uint8_t) (v_ref - p);
+		k = (dist == 0 ? 0 : 32 - __builtin_clz(dist));
+		if(k > bits_nr)
 		{
-			/* interpretation interval does not straddle field boundaries,
-			 * check if value is in [min, max] */
-			if(v >= interval.min && v <= interval.max)
-			{
-				break;
-			}
+			k = bits_nr;
 		}
-		else
+	}
+	else
+	{
+		for(k = 0; k < bits_nr; k++)
 		{
-			/* the interpretation interval does straddle the field boundaries,
-			 * check if value is in [min, 0xffff] or [0, max] */
-			if(v >= interval.min || v <= interval.max)
+			interval = rohc_f_8bits(v_ref, k, p);
+			if(interval.min <= interval.max)
+			{
+				/* interpretation interval does not straddle field boundaries,
+				 * check if value is in [min, max] */
+				if(v >= interval.min && v <= interval.max)
+				{
+					break;
+				}
+			}
+			else
 			{
-				break;
+				/* the interpretation interval does straddle the field boundaries,
+				 * check if value is in [min, 0xffff] or [0, max] */
+				if(v >= interval.min || v <= interval.max)
+				{
+					break;
+				}
 			}
 		}
 	}
@@ -640,25 +882,43 @@ static size_t rohc_g_16bits(const uint16_t v_ref,
 	assert(bits_nr <= 16);
 	assert(min_k <= bits_nr);
 
-	for(k = min_k; k < bits_nr; k++)
+	if(rohc_interval_is_p_const(p))
 	{
-		interval = rohc_f_16bits(v_ref, k, p);
-		if(interval.min <= interval.max)
+		/* all the intervals start at v_ref - p, so v belongs to f(v_ref, k) as
+		 * soon as its distance to v_ref - p fits in k bits */
+		const uint16_t dist = v - (uint16_t) (v_ref - p);
+		k = (dist == 0 ? 0 : 32 - __builtin_clz(dist));
+		if(k < min_k)
 		{
-			/* interpretation interval does not straddle field boundaries,
-			 * check if value is in [min, max] */
-			if(v >= interval.min && v <= interval.max)
-			{
-				break;
-			}
+			k = min_k;
 		}
-		else
+		if(k > bits_nr)
 		{
-			/* the interpretation interval does straddle the field boundaries,
-			 * check if value is in [min, 0xffff] or [0, max] */
-			if(v >= interval.min || v <= interval.max)
+			k = bits_nr;
+		}
+	}
+	else
+	{
+		for(k = min_k; k < bits_nr; k++)
+		{
+			interval = rohc_f_16bits(v_ref, k, p);
+			if(interval.min <= interval.max)
 			{
-				break;
+				/* interpretation interval does not straddle field boundaries,
+				 * check if value is in [min, max] */
+				if(v >= interval.min && v <= interval.max)
+				{
+					break;
+				}
+			}
+			else
+			{
+				/* the interpretation interval does straddle the field boundaries,
+				 * check if value is in [min, 0xffff] or [0, max] */
+				if(v >= interval.min || v <= interval.max)
+				{
+					break;
+				}
 			}
 		}
 	}
@@ -693,25 +953,43 @@ static size_t rohc_g_32bits(const uint32_t v_ref,
 	assert(bits_nr <= 32);
 	assert(min_k < bits_nr);
 
-	for(k = min_k; k < bits_nr; k++)
+	if(rohc_interval_is_p_const(p))
 	{
-		interval = rohc_f_32bits(v_ref, k, p);
-		if(interval.min <= interval.max)
+		/* all the intervals start at v_ref - p, so v belongs to f(v_ref, k) as
+		 * soon as its distance to v_ref - p fits in k bits */
+		const uint32_t dist = v - (uint32_t) (v_ref - p);
+		k = (dist == 0 ? 0 : 32 - __builtin_clz(dist));
+		if(k < min_k)
 		{
-			/* interpretation interval does not straddle field boundaries,
-			 * check if value is in [min, max] */
-			if(v >= interval.min && v <= interval.max)
-			{
-				break;
-			}
+			k = min_k;
 		}
-		else
+		if(k > bits_nr)
 		{
-			/* the interpretation interval does straddle the field boundaries,
-			 * check if value is in [min, 0xffff] or [0, max] */
-			if(v >= interval.min || v <= interval.max)
+			k = bits_nr;
+		}
+	}
+	else
+	{
+		for(k = min_k; k < bits_nr; k++)
+		{
+			interval = rohc_f_32bits(v_ref, k, p);
+			if(interval.min <= interval.max)
+			{
+				/* interpretation interval does not straddle field boundaries,
+				 * check if value is in [min, max] */
+				if(v >= interval.min && v <= interval.max)
+				{
+					break;
+				}
+			}
+			else
 			{
-				break;
+				/* the interpretation interval does straddle the field boundaries,
+				 * check if value is in [min, 0xffff] or [0, max] */
+				if(v >= interval.min || v <= interval.max)
+				{
+					break;
+				}
 			}
 		}
 	}
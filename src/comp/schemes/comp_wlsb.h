@@ -34,19 +34,77 @@
 #include <stdbool.h>
 
 
-/* The definition of the W-LSB encoding object is private */
-struct c_wlsb;
+/** The maximal width of the W-LSB window */
+#define ROHC_WLSB_WIDTH_MAX  64U
+
+
+/**
+ * @brief Defines a W-LSB encoding object
+ *
+ * The object is embedded in the profile contexts, so the window is sized for
+ * the largest window width.
+ */
+struct c_wlsb
+{
+	/** The current width of the window, ie. the number of entries kept before
+	 *  the oldest one is overwritten */
+	size_t window_width;
+	/** The width of the window configured at init, the window never shrinks
+	 *  below this width */
+	size_t window_width_min;
+	/** Whether the window entries were ever acknowledged by the decompressor
+	 *  with variable width enabled: only such windows may grow over the
+	 *  configured width */
+	bool is_acked;
+
+	/// The size of the storage of the window entries (power of 2) minus 1
+	size_t window_mask;
+
+	/// A pointer on the oldest entry in the window (change on acknowledgement)
+	size_t oldest;
+	/// A pointer on the current entry in the window  (change on add and ack)
+	size_t next;
+
+	/// Count of entries in the window
+	size_t count;
+	/** The number of the newest entries whose SNs are consecutive, the
+	 *  acknowledged entry is then located directly from the newest SN */
+	size_t sn_consecutive_nr;
+
+	/// The maximal number of bits for representing the value
+	size_t bits;
+	/// Shift parameter (see 4.5.2 in the RFC 3095)
+	rohc_lsb_shift_t p;
+
+	/** Whether all the window values are in [range_min, range_max], an
+	 *  interval narrower than half the 32-bit field that may straddle the
+	 *  field boundaries */
+	bool is_range_ok;
+	/// The lower bound of the interval, one of the window values
+	uint32_t range_min;
+	/// The upper bound of the interval, one of the window values
+	uint32_t range_max;
+	/// The width of the interval, ie. range_max - range_min
+	uint32_t range_width;
+
+	/** The Sequence Numbers (SN) associated with the window entries (used to
+	 *  acknowledge the entries) */
+	uint32_t window_sns[ROHC_WLSB_WIDTH_MAX];
+	/** The values stored in the window entries, stored apart from the SNs so
+	 *  that the window scans read contiguous memory */
+	uint32_t window_values[ROHC_WLSB_WIDTH_MAX];
+};
 
 
 /*
  * Public function prototypes:
  */
 
-struct c_wlsb * c_create_wlsb(const size_t bits,
-                              const size_t window_width,
-                              const rohc_lsb_shift_t p)
-	__attribute__((warn_unused_result));
-void c_destroy_wlsb(struct c_wlsb *s);
+void c_init_wlsb(struct c_wlsb *const wlsb,
+                 const size_t bits,
+                 const size_t window_width,
+                 const rohc_lsb_shift_t p)
+	__attribute__((nonnull(1)));
 
 void c_add_wlsb(struct c_wlsb *const wlsb,
                 const uint32_t sn,
@@ -94,9 +152,16 @@ size_t wlsb_get_minkp_32bits(const struct c_wlsb *const wlsb,
                              const rohc_lsb_shift_t p)
 	__attribute__((warn_unused_result, nonnull(1)));
 
+bool wlsb_get_acked_sn(const struct c_wlsb *const wlsb,
+                       const uint32_t sn_bits,
+                       const size_t sn_bits_nr,
+                       uint32_t *const sn)
+	__attribute__((warn_unused_result, nonnull(1, 4)));
+
 size_t wlsb_ack(struct c_wlsb *const wlsb,
                 const uint32_t sn_bits,
-                const size_t sn_bits_nr)
+                const size_t sn_bits_nr,
+                const bool is_width_variable)
 	__attribute__((warn_unused_result, nonnull(1)));
 
 #endif
@@ -23,6 +23,8 @@
  */
 
 #include "ip_id_offset.h"
+#include "ip.h" /* for swab16() */
+
 
 /**
  * @brief Whether the new IP-ID is increasing
@@ -63,3 +65,51 @@ bool is_ip_id_increasing(const uint16_t old_id, const uint16_t new_id)
 	return is_increasing;
 }
 
+
+/**
+ * @brief Classify the behaviour of the IP-ID field
+ *
+ * The IP-ID is classified in that order: constant, increasing in NBO,
+ * increasing in Little Endian, zero, random. The behaviour of the previous
+ * packet is checked first: a sequential IP-ID that keeps increasing is
+ * classified without the other checks.
+ *
+ * @param last_behavior  The behaviour of the IP-ID in the previous packet
+ * @param old_id         The IP-ID of the previous IPv4 header (in HBO)
+ * @param new_id         The IP-ID of the current IPv4 header (in HBO)
+ * @return               The behaviour of the IP-ID
+ */
+rohc_ip_id_behavior_t rohc_ip_id_classify(const rohc_ip_id_behavior_t last_behavior,
+                                          const uint16_t old_id,
+                                          const uint16_t new_id)
+{
+	rohc_ip_id_behavior_t behavior;
+
+	/* an increasing IP-ID is never constant */
+	if(last_behavior == ROHC_IP_ID_SEQ && is_ip_id_increasing(old_id, new_id))
+	{
+		behavior = ROHC_IP_ID_SEQ;
+	}
+	else if(new_id == old_id)
+	{
+		behavior = ROHC_IP_ID_CONST;
+	}
+	else if(is_ip_id_increasing(old_id, new_id))
+	{
+		behavior = ROHC_IP_ID_SEQ;
+	}
+	else if(is_ip_id_increasing(swab16(old_id), swab16(new_id)))
+	{
+		behavior = ROHC_IP_ID_SEQ_SWAP;
+	}
+	else if(new_id == 0)
+	{
+		behavior = ROHC_IP_ID_ZERO;
+	}
+	else
+	{
+		behavior = ROHC_IP_ID_RAND;
+	}
+
+	return behavior;
+}
@@ -33,8 +33,23 @@
 #  include <stdbool.h>
 #endif
 
+/** The behaviours of the IPv4 Identification (IP-ID) field */
+typedef enum
+{
+	ROHC_IP_ID_SEQ      = 0, /**< IP-ID increases in Network Byte Order */
+	ROHC_IP_ID_SEQ_SWAP = 1, /**< IP-ID increases in Little Endian */
+	ROHC_IP_ID_RAND     = 2, /**< IP-ID is random */
+	ROHC_IP_ID_ZERO     = 3, /**< IP-ID changed to zero */
+	ROHC_IP_ID_CONST    = 4, /**< IP-ID did not change */
+} rohc_ip_id_behavior_t;
+
 bool is_ip_id_increasing(const uint16_t old_id, const uint16_t new_id)
 	__attribute__((warn_unused_result, const));
 
+rohc_ip_id_behavior_t rohc_ip_id_classify(const rohc_ip_id_behavior_t last_behavior,
+                                          const uint16_t old_id,
+                                          const uint16_t new_id)
+	__attribute__((warn_unused_result, const));
+
 #endif
 
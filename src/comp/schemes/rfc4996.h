@@ -27,50 +27,22 @@
 #ifndef ROHC_COMP_SCHEMES_RFC4996_H
 #define ROHC_COMP_SCHEMES_RFC4996_H
 
+#include "protocols/tcp.h"
+
 #include <stdint.h>
 #include <stddef.h>
 #include <stdbool.h>
+#ifndef __KERNEL__
+#  include <string.h>
+#else
+#  include <linux/string.h>
+#endif
+#include <assert.h>
 
 
 struct rohc_comp_ctxt;
 
 
-/* static_or_irreg encoding for 8-bit and 16-bit values */
-int c_static_or_irreg8(const uint8_t context_value,
-                       const uint8_t packet_value,
-                       uint8_t *const rohc_data,
-                       const size_t rohc_max_len,
-                       int *const indicator)
-	__attribute__((warn_unused_result, nonnull(3, 5)));
-int c_static_or_irreg16(const uint16_t packet_value,
-                        const bool is_static,
-                        uint8_t *const rohc_data,
-                        const size_t rohc_max_len,
-                        int *const indicator)
-	__attribute__((warn_unused_result, nonnull(3, 5)));
-
-/* zero_or_irreg encoding for 16-bit and 32-bit values */
-int c_zero_or_irreg16(const uint16_t packet_value,
-                      uint8_t *const rohc_data,
-                      const size_t rohc_max_len,
-                      int *const indicator)
-	__attribute__((warn_unused_result, nonnull(2, 4)));
-int c_zero_or_irreg32(const uint32_t packet_value,
-                      uint8_t *const rohc_data,
-                      const size_t rohc_max_len,
-                      int *const indicator)
-	__attribute__((warn_unused_result, nonnull(2, 4)));
-
-/* variable_length_32_enc encoding method */
-int variable_length_32_enc(const uint32_t old_value,
-                           const uint32_t new_value,
-                           const size_t nr_bits_63,
-                           const size_t nr_bits_16383,
-                           uint8_t *const rohc_data,
-                           const size_t rohc_max_len,
-                           int *const indicator)
-	__attribute__((nonnull(5, 7), warn_unused_result));
-
 /* RFC4996 page 49 */
 void c_field_scaling(uint32_t *const scaled_value,
                      uint32_t *const residue_field,
@@ -78,29 +50,417 @@ void c_field_scaling(uint32_t *const scaled_value,
                      const uint32_t unscaled_value)
 	__attribute__((nonnull(1, 2)));
 
-// RFC4996 page 71
-bool rsf_index_enc_possible(const uint8_t rsf_flags)
-	__attribute__((warn_unused_result, const));
-unsigned int rsf_index_enc(const uint8_t rsf_flags)
-	__attribute__((warn_unused_result, const));
-
-/* optional_ip_id_lsb encoding method */
-int c_optional_ip_id_lsb(const int behavior,
-                         const uint16_t ip_id_nbo,
-                         const uint16_t ip_id_offset,
-                         const size_t nr_bits_wlsb,
-                         uint8_t *const rohc_data,
-                         const size_t rohc_max_len,
-                         int *const indicator)
-	__attribute__((warn_unused_result, nonnull(5, 7)));
-
-// RFC4996 page 75
-int dscp_encode(const uint8_t context_value,
-                const uint8_t packet_value,
-                uint8_t *const rohc_data,
-                const size_t rohc_max_len,
-                int *const indicator)
-	__attribute__((warn_unused_result, nonnull(3, 5)));
+
+/**
+ * @brief Compress the 8 bits given, depending of the context value.
+ *
+ * See RFC4996 page 46
+ *
+ * @param context_value    The context value
+ * @param packet_value     The packet value
+ * @param[out] rohc_data   The compressed value
+ * @param rohc_max_len     The max remaining length in the ROHC buffer
+ * @param[out] indicator   The indicator: 1 if present, 0 if not
+ * @return                 The number of ROHC bytes written,
+ *                         -1 if a problem occurs
+ */
+static inline int c_static_or_irreg8(const uint8_t context_value,
+                                     const uint8_t packet_value,
+                                     uint8_t *const rohc_data,
+                                     const size_t rohc_max_len,
+                                     int *const indicator)
+{
+	size_t length;
+
+	if(packet_value == context_value)
+	{
+		*indicator = 0;
+		length = 0;
+	}
+	else
+	{
+		if(rohc_max_len < 1)
+		{
+			goto error;
+		}
+		rohc_data[0] = packet_value;
+		*indicator = 1;
+		length = 1;
+	}
+
+	return length;
+
+error:
+	return -1;
+}
+
+
+/**
+ * @brief Compress the 16 bits given, depending of the context value.
+ *
+ * @param packet_value     The packet value
+ * @param is_static        Whether the value is static or not
+ * @param[out] rohc_data   The compressed value
+ * @param rohc_max_len     The max remaining length in the ROHC buffer
+ * @param[out] indicator   The indicator: 1 if present, 0 if not
+ * @return                 The number of ROHC bytes written,
+ *                         -1 if a problem occurs
+ */
+static inline int c_static_or_irreg16(const uint16_t packet_value,
+                                      const bool is_static,
+                                      uint8_t *const rohc_data,
+                                      const size_t rohc_max_len,
+                                      int *const indicator)
+{
+	size_t field_len;
+
+	if(is_static)
+	{
+		field_len = 0;
+		*indicator = 0;
+	}
+	else
+	{
+		field_len = sizeof(uint16_t);
+
+		if(rohc_max_len < field_len)
+		{
+			goto error;
+		}
+
+		memcpy(rohc_data, &packet_value, sizeof(uint16_t));
+		*indicator = 1;
+	}
+
+	return field_len;
+
+error:
+	return -1;
+}
+
+
+/**
+ * @brief Compress the 16 bits value, regarding if null or not
+ *
+ * @param packet_value     The packet value
+ * @param[out] rohc_data   The compressed value
+ * @param rohc_max_len     The max remaining length in the ROHC buffer
+ * @param[out] indicator   The indicator: 1 if present, 0 if not
+ * @return                 The number of ROHC bytes written,
+ *                         -1 if a problem occurs
+ */
+static inline int c_zero_or_irreg16(const uint16_t packet_value,
+                                    uint8_t *const rohc_data,
+                                    const size_t rohc_max_len,
+                                    int *const indicator)
+{
+	size_t field_len;
+
+	if(packet_value != 0)
+	{
+		field_len = sizeof(uint16_t);
+
+		if(rohc_max_len < field_len)
+		{
+			goto error;
+		}
+
+		memcpy(rohc_data, &packet_value, sizeof(uint16_t));
+		*indicator = 0;
+	}
+	else
+	{
+		field_len = 0;
+		*indicator = 1;
+	}
+
+	return field_len;
+
+error:
+	return -1;
+}
+
+
+/**
+ * @brief Compress the 32 bits value, regarding if null or not
+ *
+ * @param packet_value     The packet value
+ * @param[out] rohc_data   The compressed value
+ * @param rohc_max_len     The max remaining length in the ROHC buffer
+ * @param[out] indicator   The indicator: 1 if present, 0 if not
+ * @return                 The number of ROHC bytes written,
+ *                         -1 if a problem occurs
+ */
+static inline int c_zero_or_irreg32(const uint32_t packet_value,
+                                    uint8_t *const rohc_data,
+                                    const size_t rohc_max_len,
+                                    int *const indicator)
+{
+	size_t field_len;
+
+	if(packet_value != 0)
+	{
+		field_len = sizeof(uint32_t);
+
+		if(rohc_max_len < field_len)
+		{
+			goto error;
+		}
+
+		memcpy(rohc_data, &packet_value, field_len);
+		*indicator = 0;
+	}
+	else
+	{
+		field_len = 0;
+		*indicator = 1;
+	}
+
+	return field_len;
+
+error:
+	return -1;
+}
+
+
+/**
+ * @brief Compress the given 32-bit value
+ *
+ * See variable_length_32_enc in RFC4996 page 46.
+ *
+ * @param old_value       The previous 32-bit value
+ * @param new_value       The 32-bit value to compress
+ * @param nr_bits_63      The number of bits required for W-LSB encoding
+ *                        with p = 63
+ * @param nr_bits_16383   The number of bits required for W-LSB encoding
+ *                        with p = 16383
+ * @param[out] rohc_data  The compressed value
+ * @param rohc_max_len    The max remaining length in the ROHC buffer
+ * @param[out] indicator  The indicator for the compressed value
+ * @return                The number of ROHC bytes written in case of success,
+ *                        -1 in case of error
+ */
+static inline int variable_length_32_enc(const uint32_t old_value,
+                                         const uint32_t new_value,
+                                         const size_t nr_bits_63,
+                                         const size_t nr_bits_16383,
+                                         uint8_t *const rohc_data,
+                                         const size_t rohc_max_len,
+                                         int *const indicator)
+{
+	size_t encoded_len;
+
+	assert(nr_bits_63 <= 32);
+	assert(nr_bits_16383 <= 32);
+
+	if(new_value == old_value)
+	{
+		/* 0-byte value */
+		encoded_len = 0;
+		*indicator = 0;
+	}
+	else if(nr_bits_63 <= 8)
+	{
+		/* 1-byte value */
+		encoded_len = 1;
+		if(rohc_max_len < encoded_len)
+		{
+			goto error;
+		}
+		*indicator = 1;
+		rohc_data[0] = new_value & 0xff;
+	}
+	else if(nr_bits_16383 <= 16)
+	{
+		/* 2-byte value */
+		encoded_len = 2;
+		if(rohc_max_len < encoded_len)
+		{
+			goto error;
+		}
+		*indicator = 2;
+		rohc_data[0] = (new_value >> 8) & 0xff;
+		rohc_data[1] = new_value & 0xff;
+	}
+	else
+	{
+		/* 4-byte value */
+		encoded_len = 4;
+		if(rohc_max_len < encoded_len)
+		{
+			goto error;
+		}
+		*indicator = 3;
+		rohc_data[0] = (new_value >> 24) & 0xff;
+		rohc_data[1] = (new_value >> 16) & 0xff;
+		rohc_data[2] = (new_value >> 8) & 0xff;
+		rohc_data[3] = new_value & 0xff;
+	}
+
+	assert(encoded_len <= sizeof(uint32_t));
+	assert((*indicator) >= 0 && (*indicator) <= 3);
+
+	return encoded_len;
+
+error:
+	return -1;
+}
+
+
+/**
+ * @brief Is is possible to use the rsf_index_enc encoding?
+ *
+ * See RFC4996 page 71
+ *
+ * @param rsf_flags  The RSF flags
+ * @return           true if the rsf_index_enc may be used, false if it cannot
+ */
+static inline bool rsf_index_enc_possible(const uint8_t rsf_flags)
+{
+	/* the rsf_index_enc encoding is possible only if at most one of the RST,
+	 * SYN or FIN flag is set */
+	return ((rsf_flags & (rsf_flags - 1)) == 0);
+}
+
+
+/**
+ * @brief Calculate the rsf_index from the rsf flags
+ *
+ * See RFC4996 page 71
+ *
+ * @param rsf_flags  The RSF flags, at most one of them shall be set
+ * @return           The rsf index
+ */
+static inline unsigned int rsf_index_enc(const uint8_t rsf_flags)
+{
+	/* the rsf_index of every combination of the RST, SYN and FIN flags,
+	 * 0 for the combinations that cannot be encoded */
+	static const uint8_t rsf_indexes[8] =
+	{
+		[RSF_NONE]     = 0,
+		[RSF_FIN_ONLY] = 3,
+		[RSF_SYN_ONLY] = 2,
+		[RSF_RST_ONLY] = 1,
+	};
+
+	assert(rsf_index_enc_possible(rsf_flags));
+
+	return rsf_indexes[rsf_flags & 0x07];
+}
+
+
+/**
+ * @brief Compress or not the IP-ID
+ *
+ * See RFC4996 page 76
+ *
+ * @param behavior         The IP-ID behavior
+ * @param ip_id_nbo        The IP-ID value to compress (in NBO)
+ * @param ip_id_offset     The IP-ID offset value to compress (in HBO)
+ * @param nr_bits_wlsb     The number of IP-ID offset bits required for W-LSB
+ * @param[out] rohc_data   The compressed value
+ * @param rohc_max_len     The max remaining length in the ROHC buffer
+ * @param[out] indicator   The indicator: 0 if short, 1 if long
+ * @return                 The number of ROHC bytes written,
+ *                         -1 if a problem occurs
+ */
+static inline int c_optional_ip_id_lsb(const int behavior,
+                                       const uint16_t ip_id_nbo,
+                                       const uint16_t ip_id_offset,
+                                       const size_t nr_bits_wlsb,
+                                       uint8_t *const rohc_data,
+                                       const size_t rohc_max_len,
+                                       int *const indicator)
+{
+	size_t length = 0;
+
+	switch(behavior)
+	{
+		case IP_ID_BEHAVIOR_SEQ_SWAP:
+		case IP_ID_BEHAVIOR_SEQ:
+			if(nr_bits_wlsb <= 8)
+			{
+				if(rohc_max_len < 1)
+				{
+					goto error;
+				}
+				rohc_data[0] = ip_id_offset & 0xff;
+				*indicator = 0;
+				length++;
+			}
+			else
+			{
+				if(rohc_max_len < sizeof(uint16_t))
+				{
+					goto error;
+				}
+				memcpy(rohc_data, &ip_id_nbo, sizeof(uint16_t));
+				length += sizeof(uint16_t);
+				*indicator = 1;
+			}
+			break;
+		case IP_ID_BEHAVIOR_RAND:
+		case IP_ID_BEHAVIOR_ZERO:
+			*indicator = 0;
+			length = 0;
+			break;
+		default:
+			assert(0); /* should never happen */
+			*indicator = 0;
+			length = 0;
+			break;
+	}
+
+	return length;
+
+error:
+	return -1;
+}
+
+
+/**
+ * @brief Encode the DSCP field
+ *
+ * See RFC4996 page 75
+ *
+ * @param context_value    The DSCP value in the compression context
+ * @param packet_value     The DSCP value in the packet to compress
+ * @param[out] rohc_data   The compressed value
+ * @param rohc_max_len     The max remaining length in the ROHC buffer
+ * @param[out] indicator   The indicator: 1 if present, 1 if not
+ * @return                 The number of ROHC bytes written,
+ *                         -1 if a problem occurs
+ */
+static inline int dscp_encode(const uint8_t context_value,
+                              const uint8_t packet_value,
+                              uint8_t *const rohc_data,
+                              const size_t rohc_max_len,
+                              int *const indicator)
+{
+	size_t len;
+
+	if(packet_value == context_value)
+	{
+		*indicator = 0;
+		len = 0;
+	}
+	else
+	{
+		/* 6 bits + 2 bits padding */
+		if(rohc_max_len < 1)
+		{
+			goto error;
+		}
+		rohc_data[0] = ((packet_value & 0x3F) << 2);
+		*indicator = 1;
+		len = 1;
+	}
+
+	return len;
+
+error:
+	return -1;
+}
 
 #endif /* ROHC_COMP_RFC4996_ENCODING_H */
 
@@ -24,20 +24,31 @@
 
 #include "tcp_sack.h"
 
+#include <assert.h>
 
-static int c_tcp_sack_code_block(const struct rohc_comp_ctxt *const context,
-                                 const uint32_t reference,
-                                 const sack_block_t *const sack_block,
-                                 uint8_t *const rohc_data,
-                                 const size_t rohc_max_len)
-	__attribute__((warn_unused_result, nonnull(1, 3, 4)));
 
-static int c_tcp_sack_code_pure_lsb(const struct rohc_comp_ctxt *const context,
-                                    const uint32_t base,
-                                    const uint32_t field,
-                                    uint8_t *const rohc_data,
-                                    const size_t rohc_max_len)
-	__attribute__((warn_unused_result, nonnull(1, 4)));
+static inline uint8_t c_tcp_sack_field_len(const uint32_t sack_field)
+	__attribute__((warn_unused_result, const));
+
+static inline void c_tcp_sack_write_field(const uint32_t sack_field,
+                                          const uint8_t len,
+                                          uint8_t *const rohc_data)
+	__attribute__((nonnull(3)));
+
+
+/**
+ * The discriminator of the SACK field, indexed by the length of the field
+ * (discriminator included)
+ */
+static const uint8_t c_tcp_sack_discriminators[6] =
+	{ 0x00, 0x00, 0x00, 0x80, 0xc0, 0xff };
+
+/**
+ * The mask of the SACK field bits in the first byte of the SACK field,
+ * indexed by the length of the field (discriminator included)
+ */
+static const uint8_t c_tcp_sack_first_byte_masks[6] =
+	{ 0x00, 0x00, 0x7f, 0x3f, 0x1f, 0x00 };
 
 
 /**
@@ -67,10 +78,8 @@ int c_tcp_opt_sack_code(const struct rohc_comp_ctxt *const context,
 {
 	uint8_t * rohc_remain_data = rohc_data;
 	size_t rohc_remain_len = rohc_max_len;
-	const sack_block_t *block;
 	size_t blocks_nr;
 	size_t i;
-	int ret;
 
 	rohc_comp_debug(context, "%schanged TCP option SACK (reference ACK = 0x%08x)",
 	                (is_unchanged ? "un" : ""), ack_value);
@@ -93,35 +102,62 @@ int c_tcp_opt_sack_code(const struct rohc_comp_ctxt *const context,
 	}
 	else
 	{
+		uint32_t sack_fields[TCP_SACK_BLOCKS_MAX_NR * 2];
+		uint8_t sack_fields_lens[TCP_SACK_BLOCKS_MAX_NR * 2];
+		size_t sack_fields_len = 0;
 		uint32_t reference;
 
 		/* determine the number of SACK blocks
 		 * (integer division checked by \ref c_tcp_check_profile ) */
 		blocks_nr = length / sizeof(sack_block_t);
+		assert(blocks_nr <= TCP_SACK_BLOCKS_MAX_NR);
+
+		/* compute every SACK field, and decide its length upfront:
+		 *  - first block start uses ACK as reference
+		 *  - next block start uses previous block end as reference
+		 *  - block end uses block start as reference */
+		for(i = 0, reference = ack_value; i < blocks_nr; i++)
+		{
+			const uint32_t block_start = rohc_ntoh32(sack_blocks[i].block_start);
+			const uint32_t block_end = rohc_ntoh32(sack_blocks[i].block_end);
+
+			rohc_comp_debug(context, "block of SACK option: reference = 0x%08x, "
+			                "start = 0x%08x, end = 0x%08x", reference,
+			                block_start, block_end);
+
+			/* if reference can be >= field, overflow is expected */
+			sack_fields[i * 2] = block_start - reference;
+			sack_fields[i * 2 + 1] = block_end - block_start;
+			reference = block_end;
+		}
+		for(i = 0; i < (blocks_nr * 2); i++)
+		{
+			sack_fields_lens[i] = c_tcp_sack_field_len(sack_fields[i]);
+			sack_fields_len += sack_fields_lens[i];
+		}
+		if(rohc_remain_len < (1 + sack_fields_len))
+		{
+			rohc_comp_warn(context, "ROHC buffer too small for the %zu SACK "
+			               "blocks: %zu bytes required, but only %zu bytes "
+			               "available", blocks_nr, 1 + sack_fields_len,
+			               rohc_remain_len);
+			goto error;
+		}
+
 		rohc_remain_data[0] = blocks_nr;
 		rohc_remain_data++;
 		rohc_remain_len--;
 
-		/* compress every SACK block, one by one:
-		 *  - first block uses ACK as reference
-		 *  - next block uses current block end as reference */
-		for(i = 0, reference = ack_value, block = sack_blocks;
-		    i < blocks_nr;
-		    i++, reference = rohc_ntoh32(block->block_end), block++)
+		/* write all the SACK fields in one pass */
+		for(i = 0; i < (blocks_nr * 2); i++)
 		{
-			rohc_comp_debug(context, "block of SACK option: reference = 0x%08x, "
-			                "start = 0x%08x, end = 0x%08x", reference,
-			                rohc_ntoh32(block->block_start),
-			                rohc_ntoh32(block->block_end));
-			ret = c_tcp_sack_code_block(context, reference, block,
-			                            rohc_remain_data, rohc_remain_len);
-			if(ret < 0)
-			{
-				rohc_comp_warn(context, "failed to encode SACK block #%zu", i + 1);
-				goto error;
-			}
-			rohc_remain_data += ret;
-			rohc_remain_len -= ret;
+			c_tcp_sack_write_field(sack_fields[i], sack_fields_lens[i],
+			                       rohc_remain_data);
+			rohc_comp_debug(context, "sack_field = 0x%x encoded on %u bytes "
+			                "(discriminator included)", sack_fields[i],
+			                sack_fields_lens[i]);
+			rohc_remain_data += sack_fields_lens[i];
+			rohc_remain_len -= sack_fields_lens[i];
 		}
 	}
 
@@ -133,160 +169,50 @@ error:
 
 
 /**
- * @brief Compress one SACK block
+ * @brief Determine the length of one SACK field
  *
- * See RFC6846 page 68
- * (and RFC2018 for Selective Acknowledgement option)
+ * See RFC6846 page 67: the SACK field is encoded on 2, 3, 4, or 5 bytes
+ * depending on its value.
  *
- * @param context         The compression context
- * @param reference       The reference value
- * @param sack_block      The SACK block to compress
- * @param[out] rohc_data  The ROHC packet being built
- * @param rohc_max_len    The max remaining length in the ROHC buffer
- * @return                The length appended in the ROHC buffer if positive,
- *                        -1 in case of error
+ * @param sack_field  The SACK field to encode
+ * @return            The length (in bytes) of the SACK field once encoded,
+ *                    discriminator included
  */
-static int c_tcp_sack_code_block(const struct rohc_comp_ctxt *const context,
-                                 const uint32_t reference,
-                                 const sack_block_t *const sack_block,
-                                 uint8_t *const rohc_data,
-                                 const size_t rohc_max_len)
+static inline uint8_t c_tcp_sack_field_len(const uint32_t sack_field)
 {
-	uint8_t *rohc_remain_data = rohc_data;
-	size_t rohc_remain_len = rohc_max_len;
-	int ret;
-
-	rohc_comp_debug(context, "reference = 0x%x, block_start = 0x%x, block_end "
-	                "= 0x%x", reference, rohc_ntoh32(sack_block->block_start),
-	                rohc_ntoh32(sack_block->block_end));
-
-	/* block_start =:= sack_var_length_enc(reference) */
-	ret = c_tcp_sack_code_pure_lsb(context, reference,
-	                               rohc_ntoh32(sack_block->block_start),
-	                               rohc_remain_data, rohc_remain_len);
-	if(ret < 0)
-	{
-		rohc_comp_warn(context, "failed to encode the SACK block start");
-		goto error;
-	}
-	rohc_remain_data += ret;
-	rohc_remain_len -= ret;
-
-	/* block_end =:= sack_var_length_enc(block_start) */
-	ret = c_tcp_sack_code_pure_lsb(context, rohc_ntoh32(sack_block->block_start),
-	                               rohc_ntoh32(sack_block->block_end),
-	                               rohc_remain_data, rohc_remain_len);
-	if(ret < 0)
-	{
-		rohc_comp_warn(context, "failed to encode the SACK block end");
-		goto error;
-	}
-#ifndef __clang_analyzer__ /* silent warning about dead in/decrement */
-	rohc_remain_data += ret;
-#endif
-	rohc_remain_len -= ret;
-
-	return (rohc_max_len - rohc_remain_len);
-
-error:
-	return -1;
+	return (2 + (sack_field >= 0x8000) + (sack_field >= 0x400000) +
+	        (sack_field >= 0x20000000));
 }
 
 
 /**
- * @brief Compress one SACK field value
+ * @brief Write one SACK field
  *
  * See RFC6846 page 67
  * (and RFC2018 for Selective Acknowledgement option)
  *
- * @param context         The compression context
- * @param base            The base value
- * @param field           The value to compress
- * @param[out] rohc_data  The ROHC packet being built
- * @param rohc_max_len    The max remaining length in the ROHC buffer
- * @return                The length appended in the ROHC buffer if positive,
- *                        -1 in case of error
+ * @param sack_field      The SACK field to encode
+ * @param len             The length of the SACK field once encoded,
+ *                        see \ref c_tcp_sack_field_len
+ * @param[out] rohc_data  The ROHC packet being built, the available length
+ *                        shall have been checked before
  */
-static int c_tcp_sack_code_pure_lsb(const struct rohc_comp_ctxt *const context,
-                                    const uint32_t base,
-                                    const uint32_t field,
-                                    uint8_t *const rohc_data,
-                                    const size_t rohc_max_len)
+static inline void c_tcp_sack_write_field(const uint32_t sack_field,
+                                          const uint8_t len,
+                                          uint8_t *const rohc_data)
 {
-	/* if base can be >= field, overflow is expected */
-	const uint32_t sack_field = field - base;
-	size_t len;
+	uint32_t remain_bits = sack_field;
+	uint8_t i;
 
-	if(sack_field < 0x8000)
-	{
-		/* 2 bytes with discriminator '0' */
-		len = 2;
-		if(rohc_max_len < len)
-		{
-			rohc_comp_warn(context, "ROHC buffer too small for the SACK pure LSB: "
-			               "%zu bytes required, but only %zu bytes available",
-			               len, rohc_max_len);
-			goto error;
-		}
-		rohc_data[0] = (sack_field >> 8) & 0x7f;
-		rohc_data[1] = sack_field & 0xff;
-	}
-	else if(sack_field < 0x400000)
-	{
-		/* 3 bytes with discriminator '10' */
-		len = 3;
-		if(rohc_max_len < len)
-		{
-			rohc_comp_warn(context, "ROHC buffer too small for the SACK pure LSB: "
-			               "%zu bytes required, but only %zu bytes available",
-			               len, rohc_max_len);
-			goto error;
-		}
-		rohc_data[0] = 0x80 | ((sack_field >> 16) & 0x3f);
-		rohc_data[1] = (sack_field >> 8) & 0xff;
-		rohc_data[2] = sack_field & 0xff;
-	}
-	else if(sack_field < 0x20000000)
+	assert(len >= 2 && len <= 5);
+
+	/* the last bytes hold the LSB of the field, the 5-byte encoding transmits
+	 * the 32 bits of the field after the 1-byte discriminator */
+	for(i = len - 1; i > 0; i--)
 	{
-		/* 4 bytes with discriminator '110' */
-		len = 4;
-		if(rohc_max_len < len)
-		{
-			rohc_comp_warn(context, "ROHC buffer too small for the SACK pure LSB: "
-			               "%zu bytes required, but only %zu bytes available",
-			               len, rohc_max_len);
-			goto error;
-		}
-		rohc_data[0] = 0xc0 | ((sack_field >> 24) & 0x1f);
-		rohc_data[1] = (sack_field >> 16) & 0xff;
-		rohc_data[2] = (sack_field >> 8) & 0xff;
-		rohc_data[3] = sack_field & 0xff;
+		rohc_data[i] = remain_bits & 0xff;
+		remain_bits >>= 8;
 	}
-	else
-	{
-		/* 5 bytes with discriminator '11111111' */
-		len = 5;
-		if(rohc_max_len < len)
-		{
-			rohc_comp_warn(context, "ROHC buffer too small for the SACK pure LSB: "
-			               "%zu bytes required, but only %zu bytes available",
-			               len, rohc_max_len);
-			goto error;
-		}
-		rohc_data[0] = 0xff;
-		rohc_data[1] = (sack_field >> 24) & 0xff;
-		rohc_data[2] = (sack_field >> 16) & 0xff;
-		rohc_data[3] = (sack_field >> 8) & 0xff;
-		rohc_data[4] = sack_field & 0xff;
-	}
-
-	rohc_comp_debug(context, "sack_field = 0x%x (0x%x - 0x%x) encoded on %zu "
-	                "bytes (discriminator included)", sack_field, field,
-	                base, len);
-
-	return len;
-
-error:
-	return -1;
+	rohc_data[0] = c_tcp_sack_discriminators[len] |
+	               (remain_bits & c_tcp_sack_first_byte_masks[len]);
 }
-
@@ -0,0 +1,192 @@
+/*
+ * Copyright 2016 Didier Barvaux
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/**
+ * @file    /comp/schemes/test/test_wlsb_ack.c
+ * @brief   Test the acknowledgement of W-LSB window entries
+ * @author  Didier Barvaux <didier@barvaux.org>
+ */
+
+#include "comp_wlsb.h"
+
+#include <setjmp.h>
+#include <stddef.h>
+#include <stdarg.h>
+#include <cmocka.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "config.h" /* for HAVE_CMOCKA_RUN(_GROUP)?_TESTS */
+
+
+/**
+ * @brief Find the number of entries that an ACK removes by scanning the window
+ *
+ * The reference behaviour: the window is scanned from the newest entry to the
+ * oldest one, the first entry that matches the SN bits is acknowledged.
+ *
+ * @param wlsb        The W-LSB object
+ * @param sn_bits     The LSB of the SN to acknowledge
+ * @param sn_bits_nr  The number of LSB of the SN to acknowledge
+ * @return            The number of entries older than the acknowledged one,
+ *                    -1 if no entry matches
+ */
+static int test_wlsb_ack_ref(const struct c_wlsb *const wlsb,
+                             const uint32_t sn_bits,
+                             const size_t sn_bits_nr)
+{
+	const uint32_t sn_mask =
+		(sn_bits_nr < 32 ? ((1U << sn_bits_nr) - 1) : 0xffffffffU);
+	size_t i;
+
+	for(i = 0; i < wlsb->count; i++)
+	{
+		const size_t entry = (wlsb->next - 1 - i) & wlsb->window_mask;
+		if((wlsb->window_sns[entry] & sn_mask) == sn_bits)
+		{
+			return (int) (wlsb->count - 1 - i);
+		}
+	}
+
+	return -1;
+}
+
+
+/** Test \ref wlsb_ack with consecutive SNs */
+static void test_wlsb_ack_consecutive(void **state __attribute__((unused)))
+{
+	struct c_wlsb wlsb;
+	uint32_t acked_sn;
+	uint32_t sn;
+
+	c_init_wlsb(&wlsb, 16, 16, ROHC_LSB_SHIFT_SN);
+
+	/* nothing to acknowledge in an empty window */
+	assert_true(wlsb_get_acked_sn(&wlsb, 0, 16, &acked_sn) == false);
+	assert_int_equal(wlsb_ack(&wlsb, 0, 16, false), 0);
+
+	/* SNs that wrap around 16 bits */
+	for(sn = 0xfff8; sn < 0x10000; sn++)
+	{
+		c_add_wlsb(&wlsb, sn, sn);
+	}
+	for(sn = 0; sn < 8; sn++)
+	{
+		c_add_wlsb(&wlsb, sn, sn);
+	}
+	assert_int_equal(wlsb.count, 16);
+
+	/* 4 SN bits, the newest matching entry is acknowledged */
+	assert_true(wlsb_get_acked_sn(&wlsb, 0x3, 4, &acked_sn) == true);
+	assert_int_equal(acked_sn, 3);
+	assert_true(wlsb_get_acked_sn(&wlsb, 0xa, 4, &acked_sn) == true);
+	assert_int_equal(acked_sn, 0xfffa);
+
+	/* acknowledge with the full SN before and after the wrap around */
+	assert_int_equal(wlsb_ack(&wlsb, 0xfffa, 32, false), 2);
+	assert_int_equal(wlsb.count, 14);
+	assert_int_equal(wlsb_ack(&wlsb, 0xfffa, 32, false), 0);
+	assert_int_equal(wlsb_ack(&wlsb, 2, 32, false), 8);
+	assert_int_equal(wlsb.count, 6);
+	assert_int_equal(wlsb_ack(&wlsb, 0xfffb, 32, false), 0);
+	assert_int_equal(wlsb_ack(&wlsb, 7, 8, false), 5);
+	assert_int_equal(wlsb.count, 1);
+	assert_int_equal(wlsb_ack(&wlsb, 7, 16, false), 0);
+}
+
+
+/** Test \ref wlsb_ack against the scan of the window with random SN gaps */
+static void test_wlsb_ack_random(void **state __attribute__((unused)))
+{
+	const size_t sn_bits_nrs[] = { 4, 6, 8, 16, 32 };
+	struct c_wlsb wlsb;
+	uint32_t sn = rand();
+	size_t i;
+
+	c_init_wlsb(&wlsb, 32, 32, ROHC_LSB_SHIFT_SN);
+
+	for(i = 0; i < 100000; i++)
+	{
+		const size_t sn_bits_nr = sn_bits_nrs[rand() % 5];
+		const uint32_t sn_mask =
+			(sn_bits_nr < 32 ? ((1U << sn_bits_nr) - 1) : 0xffffffffU);
+		uint32_t sn_bits;
+		uint32_t acked_sn;
+		int expected_nr;
+
+		/* add one entry, most SNs are consecutive */
+		sn += ((rand() % 8) == 0 ? (uint32_t) (rand() % 40) : 1U);
+		c_add_wlsb(&wlsb, sn, sn);
+
+		/* acknowledge one of the recent SNs from time to time */
+		if((rand() % 4) != 0)
+		{
+			continue;
+		}
+		sn_bits = (sn - (uint32_t) (rand() % 48)) & sn_mask;
+		expected_nr = test_wlsb_ack_ref(&wlsb, sn_bits, sn_bits_nr);
+
+		if(expected_nr < 0)
+		{
+			assert_true(wlsb_get_acked_sn(&wlsb, sn_bits, sn_bits_nr,
+			                              &acked_sn) == false);
+			assert_int_equal(wlsb_ack(&wlsb, sn_bits, sn_bits_nr, false), 0);
+		}
+		else
+		{
+			assert_true(wlsb_get_acked_sn(&wlsb, sn_bits, sn_bits_nr,
+			                              &acked_sn) == true);
+			assert_int_equal(acked_sn & sn_mask, sn_bits);
+			assert_int_equal(wlsb_ack(&wlsb, sn_bits, sn_bits_nr, false),
+			                 expected_nr);
+			assert_int_equal(wlsb.window_sns[wlsb.oldest], acked_sn);
+		}
+	}
+}
+
+
+/**
+ * @brief Test the acknowledgement of W-LSB window entries
+ *
+ * @param argc  The number of command line arguments
+ * @param argv  The command line arguments
+ * @return      0 if test succeeds, non-zero if test fails
+ */
+int main(int argc __attribute__((unused)), char *argv[] __attribute__((unused)))
+{
+	srand(time(NULL));
+
+#if defined(HAVE_CMOCKA_RUN_GROUP_TESTS) && HAVE_CMOCKA_RUN_GROUP_TESTS == 1
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(test_wlsb_ack_consecutive),
+		cmocka_unit_test(test_wlsb_ack_random),
+	};
+	return cmocka_run_group_tests(tests, NULL, NULL);
+#elif defined(HAVE_CMOCKA_RUN_TESTS) && HAVE_CMOCKA_RUN_TESTS == 1
+	const UnitTest tests[] = {
+		unit_test(test_wlsb_ack_consecutive),
+		unit_test(test_wlsb_ack_random),
+	};
+	return run_tests(tests);
+#else
+#  error "no function found to run cmocka tests"
+#endif
+}
+
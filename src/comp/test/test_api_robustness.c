@@ -24,6 +24,7 @@
  */
 
 #include "rohc_comp.h"
+#include "rohc_decomp.h"
 
 #include <stdio.h>
 #include <stdbool.h>
@@ -48,10 +49,35 @@
 	} while(0)
 
 
+/** The events of the contexts seen by the test */
+struct test_events
+{
+	size_t nr[ROHC_COMP_EVENT_MODE_CHANGE + 1];  /**< The number of events */
+	rohc_comp_event_info_t last;  /**< The description of the last event */
+};
+
+
+/** The allocations done through the allocator of the test */
+struct test_allocs
+{
+	size_t allocs_nr;  /**< The number of allocations */
+	size_t frees_nr;   /**< The number of deallocations */
+};
+
+
 static int random_cb(const struct rohc_comp *const comp,
                      void *const user_context)
 	__attribute__((warn_unused_result));
 
+static void * test_malloc(const size_t size, void *const priv_ctxt)
+	__attribute__((warn_unused_result));
+
+static void test_free(void *const ptr, void *const priv_ctxt);
+
+static void event_cb(void *const priv_ctxt,
+                     const rohc_comp_event_info_t *const info)
+	__attribute__((nonnull(1, 2)));
+
 
 /**
  * @brief Test the robustness of the compression API
@@ -109,6 +135,46 @@ int main(int argc, char *argv[])
 	                     random_cb, NULL) == NULL);
 	CHECK(rohc_comp_new2(ROHC_LARGE_CID, ROHC_LARGE_CID_MAX,
 	                     NULL, NULL) == NULL);
+
+	/* rohc_comp_new3() */
+	{
+		struct rohc_comp_attr attr = {
+			.cid_type = ROHC_LARGE_CID,
+			.max_cid = ROHC_LARGE_CID_MAX,
+			.rand_cb = random_cb,
+			.rand_priv = NULL,
+			.numa_node = ROHC_NUMA_NODE_ANY,
+		};
+		struct rohc_comp *comp_numa;
+
+		CHECK(rohc_comp_new3(NULL) == NULL);
+		comp = rohc_comp_new3(&attr);
+		CHECK(comp != NULL);
+		rohc_comp_free(comp);
+		attr.max_cid = ROHC_LARGE_CID_MAX + 1;
+		CHECK(rohc_comp_new3(&attr) == NULL);
+		attr.max_cid = ROHC_LARGE_CID_MAX;
+		attr.rand_cb = NULL;
+		CHECK(rohc_comp_new3(&attr) == NULL);
+		attr.rand_cb = random_cb;
+		attr.numa_node = ROHC_NUMA_NODE_ANY - 1;
+		CHECK(rohc_comp_new3(&attr) == NULL);
+		attr.numa_node = 1024;
+		CHECK(rohc_comp_new3(&attr) == NULL);
+
+		/* node 0 exists on every NUMA system, but NUMA may be unsupported */
+		attr.numa_node = 0;
+		comp_numa = rohc_comp_new3(&attr);
+		if(comp_numa != NULL)
+		{
+			CHECK(rohc_comp_set_mrru(comp_numa, 500) == true);
+			CHECK(rohc_comp_set_mrru(comp_numa, 0) == true);
+			CHECK(rohc_comp_set_mrru(comp_numa, 1000) == true);
+			CHECK(rohc_comp_set_huge_pages(comp_numa, true) == true);
+			CHECK(rohc_comp_set_memory_budget(comp_numa, 100000) == true);
+			rohc_comp_free(comp_numa);
+		}
+	}
 	comp = rohc_comp_new2(ROHC_SMALL_CID, ROHC_SMALL_CID_MAX,
 	                      random_cb, NULL);
 	CHECK(comp != NULL);
@@ -121,6 +187,30 @@ int main(int argc, char *argv[])
 		CHECK(rohc_comp_set_traces_cb2(comp, fct, comp) == true);
 	}
 
+	/* rohc_comp_set_trace_level() */
+	CHECK(rohc_comp_set_trace_level(NULL, ROHC_TRACE_WARNING) == false);
+	CHECK(rohc_comp_set_trace_level(comp, ROHC_TRACE_LEVEL_MAX) == false);
+	CHECK(rohc_comp_set_trace_level(comp, ROHC_TRACE_ERROR) == true);
+	CHECK(rohc_comp_set_trace_level(comp, ROHC_TRACE_DEBUG) == true);
+
+	/* rohc_comp_set_trace_sampling() */
+	CHECK(rohc_comp_set_trace_sampling(NULL, 10, false) == false);
+	CHECK(rohc_comp_set_trace_sampling(comp, 10, true) == true);
+	CHECK(rohc_comp_set_trace_sampling(comp, 0, false) == true);
+
+	/* rohc_comp_set_trace_cids() */
+	{
+		rohc_cid_t cids[ROHC_TRACE_CIDS_MAX + 1] = { 0 };
+		CHECK(rohc_comp_set_trace_cids(NULL, cids, 1) == false);
+		CHECK(rohc_comp_set_trace_cids(comp, NULL, 1) == false);
+		CHECK(rohc_comp_set_trace_cids(comp, cids, ROHC_TRACE_CIDS_MAX + 1) == false);
+		cids[0] = ROHC_SMALL_CID_MAX + 1;
+		CHECK(rohc_comp_set_trace_cids(comp, cids, 1) == false);
+		cids[0] = ROHC_SMALL_CID_MAX;
+		CHECK(rohc_comp_set_trace_cids(comp, cids, ROHC_TRACE_CIDS_MAX) == true);
+		CHECK(rohc_comp_set_trace_cids(comp, NULL, 0) == true);
+	}
+
 	/* rohc_comp_profile_enabled() */
 	CHECK(rohc_comp_profile_enabled(NULL, ROHC_PROFILE_IP) == false);
 	CHECK(rohc_comp_profile_enabled(comp, ROHC_PROFILE_GENERAL) == false);
@@ -131,6 +221,9 @@ int main(int argc, char *argv[])
 	CHECK(rohc_comp_profile_enabled(comp, ROHC_PROFILE_IP) == false);
 	CHECK(rohc_comp_profile_enabled(comp, ROHC_PROFILE_TCP) == false);
 	CHECK(rohc_comp_profile_enabled(comp, ROHC_PROFILE_UDPLITE) == false);
+	CHECK(rohc_comp_profile_enabled(comp, ROHCv2_PROFILE_IP_UDP_RTP) == false);
+	CHECK(rohc_comp_profile_enabled(comp, ROHCv2_PROFILE_IP_UDP) == false);
+	CHECK(rohc_comp_profile_enabled(comp, ROHCv2_PROFILE_IP_ESP) == false);
 
 	/* rohc_comp_enable_profile() */
 	CHECK(rohc_comp_enable_profile(NULL, ROHC_PROFILE_IP) == false);
@@ -148,6 +241,12 @@ int main(int argc, char *argv[])
 	CHECK(rohc_comp_enable_profiles(comp, ROHC_PROFILE_IP, -1) == true);
 	CHECK(rohc_comp_enable_profiles(comp, ROHC_PROFILE_IP, ROHC_PROFILE_UDP,
 	                                ROHC_PROFILE_RTP, -1) == true);
+	CHECK(rohc_comp_enable_profile(comp, ROHCv2_PROFILE_IP) == false);
+	CHECK(rohc_comp_profile_enabled(comp, ROHCv2_PROFILE_IP) == false);
+	CHECK(rohc_comp_enable_profile(comp, ROHCv2_PROFILE_IP_UDP) == false);
+	CHECK(rohc_comp_profile_enabled(comp, ROHCv2_PROFILE_IP_UDP) == false);
+	CHECK(rohc_comp_enable_profile(comp, ROHCv2_PROFILE_IP_UDP_RTP) == false);
+	CHECK(rohc_comp_profile_enabled(comp, ROHCv2_PROFILE_IP_UDP_RTP) == false);
 
 	/* rohc_comp_disable_profiles() */
 	CHECK(rohc_comp_disable_profiles(NULL, ROHC_PROFILE_IP, -1) == false);
@@ -155,6 +254,12 @@ int main(int argc, char *argv[])
 	CHECK(rohc_comp_disable_profiles(comp, ROHC_PROFILE_UDP, -1) == true);
 	CHECK(rohc_comp_disable_profiles(comp, ROHC_PROFILE_UDP,
 	                                 ROHC_PROFILE_RTP, -1) == true);
+	CHECK(rohc_comp_enable_profile(comp, ROHCv2_PROFILE_IP_UDP) == true);
+	CHECK(rohc_comp_enable_profile(comp, ROHC_PROFILE_UDP) == false);
+	CHECK(rohc_comp_disable_profile(comp, ROHCv2_PROFILE_IP_UDP) == true);
+	CHECK(rohc_comp_enable_profile(comp, ROHCv2_PROFILE_IP_UDP_RTP) == true);
+	CHECK(rohc_comp_enable_profile(comp, ROHC_PROFILE_RTP) == false);
+	CHECK(rohc_comp_disable_profile(comp, ROHCv2_PROFILE_IP_UDP_RTP) == true);
 
 	/* rohc_comp_profile_enabled() */
 	CHECK(rohc_comp_profile_enabled(comp, ROHC_PROFILE_UNCOMPRESSED) == false);
@@ -185,6 +290,17 @@ int main(int argc, char *argv[])
 		CHECK(rohc_comp_get_segment2(comp, &pkt1) == ROHC_STATUS_ERROR);
 	}
 
+	/* rohc_comp_get_segments() */
+	{
+		uint8_t buf1[10];
+		struct rohc_buf pkts[1] = { rohc_buf_init_empty(buf1, 10) };
+		size_t pkts_nr;
+		CHECK(rohc_comp_get_segments(NULL, pkts, 1, &pkts_nr) == false);
+		CHECK(rohc_comp_get_segments(comp, NULL, 1, &pkts_nr) == false);
+		CHECK(rohc_comp_get_segments(comp, pkts, 1, NULL) == false);
+		CHECK(rohc_comp_get_segments(comp, pkts, 1, &pkts_nr) == false);
+	}
+
 	/* rohc_comp_force_contexts_reinit() */
 	CHECK(rohc_comp_force_contexts_reinit(NULL) == false);
 	CHECK(rohc_comp_force_contexts_reinit(comp) == true);
@@ -193,8 +309,15 @@ int main(int argc, char *argv[])
 	CHECK(rohc_comp_set_wlsb_window_width(NULL, 16) == false);
 	CHECK(rohc_comp_set_wlsb_window_width(comp, 0) == false);
 	CHECK(rohc_comp_set_wlsb_window_width(comp, 15) == false);
+	CHECK(rohc_comp_set_wlsb_window_width(comp, 128) == false);
 	CHECK(rohc_comp_set_wlsb_window_width(comp, 16) == true);
 
+	/* rohc_comp_set_reorder_ratio() */
+	CHECK(rohc_comp_set_reorder_ratio(NULL, ROHC_REORDERING_HALF) == false);
+	CHECK(rohc_comp_set_reorder_ratio(comp, ROHC_REORDERING_THREEQUARTERS + 1) == false);
+	CHECK(rohc_comp_set_reorder_ratio(comp, ROHC_REORDERING_NONE) == true);
+	CHECK(rohc_comp_set_reorder_ratio(comp, ROHC_REORDERING_QUARTER) == true);
+
 	/* rohc_comp_set_periodic_refreshes() */
 	CHECK(rohc_comp_set_periodic_refreshes(NULL, 1700, 700) == false);
 	CHECK(rohc_comp_set_periodic_refreshes(comp, 0, 700) == false);
@@ -202,12 +325,38 @@ int main(int argc, char *argv[])
 	CHECK(rohc_comp_set_periodic_refreshes(comp, 5, 10) == false);
 	CHECK(rohc_comp_set_periodic_refreshes(comp, 10, 5) == true);
 
+	/* rohc_comp_set_periodic_refreshes_time() */
+	CHECK(rohc_comp_set_periodic_refreshes_time(NULL, 1000, 500) == false);
+	CHECK(rohc_comp_set_periodic_refreshes_time(comp, 0, 500) == false);
+	CHECK(rohc_comp_set_periodic_refreshes_time(comp, 1000, 0) == false);
+	CHECK(rohc_comp_set_periodic_refreshes_time(comp, 500, 1000) == false);
+	CHECK(rohc_comp_set_periodic_refreshes_time(comp, 1000, 500) == true);
+	CHECK(rohc_comp_set_periodic_refreshes_time(comp, 0, 0) == true);
+
+	/* rohc_comp_set_periodic_refreshes_rate() */
+	CHECK(rohc_comp_set_periodic_refreshes_rate(NULL, 10000) == false);
+	CHECK(rohc_comp_set_periodic_refreshes_rate(comp, 10000) == true);
+	CHECK(rohc_comp_set_periodic_refreshes_rate(comp, 0) == true);
+
 	/* rohc_comp_set_list_trans_nr() */
 	CHECK(rohc_comp_set_list_trans_nr(NULL, 5) == false);
 	CHECK(rohc_comp_set_list_trans_nr(comp, 0) == false);
 	CHECK(rohc_comp_set_list_trans_nr(comp, 1) == true);
 	CHECK(rohc_comp_set_list_trans_nr(comp, 5) == true);
 
+	/* rohc_comp_set_ctxts_recycling() */
+	CHECK(rohc_comp_set_ctxts_recycling(NULL, ROHC_COMP_RECYCLE_LRU) == false);
+	CHECK(rohc_comp_set_ctxts_recycling(comp, ROHC_COMP_RECYCLE_SLRU + 1) == false);
+	CHECK(rohc_comp_set_ctxts_recycling(comp, ROHC_COMP_RECYCLE_LFU) == true);
+	CHECK(rohc_comp_set_ctxts_recycling(comp, ROHC_COMP_RECYCLE_OLDEST) == true);
+	CHECK(rohc_comp_set_ctxts_recycling(comp, ROHC_COMP_RECYCLE_SLRU) == true);
+	CHECK(rohc_comp_set_ctxts_recycling(comp, ROHC_COMP_RECYCLE_LRU) == true);
+
+	/* rohc_comp_set_admission() */
+	CHECK(rohc_comp_set_admission(NULL, 5, 1) == false);
+	CHECK(rohc_comp_set_admission(comp, 5, 1) == true);
+	CHECK(rohc_comp_set_admission(comp, 0, 0) == true);
+
 	/* rohc_comp_set_rtp_detection_cb() */
 	{
 		rohc_rtp_detection_callback_t fct =
@@ -216,10 +365,40 @@ int main(int argc, char *argv[])
 		CHECK(rohc_comp_set_rtp_detection_cb(comp, fct, NULL) == true);
 	}
 
+	/* rohc_comp_add_rtp_port() */
+	CHECK(rohc_comp_add_rtp_port(NULL, 1234) == false);
+	CHECK(rohc_comp_add_rtp_port(comp, 1234) == true);
+	CHECK(rohc_comp_add_rtp_port(comp, 1234) == true);
+	CHECK(rohc_comp_add_rtp_port(comp, 0) == true);
+	CHECK(rohc_comp_add_rtp_port(comp, 65535) == true);
+
+	/* rohc_comp_remove_rtp_port() */
+	CHECK(rohc_comp_remove_rtp_port(NULL, 1234) == false);
+	CHECK(rohc_comp_remove_rtp_port(comp, 1234) == true);
+	CHECK(rohc_comp_remove_rtp_port(comp, 1234) == false);
+	CHECK(rohc_comp_remove_rtp_port(comp, 4321) == false);
+
+	/* rohc_comp_reset_rtp_ports() */
+	CHECK(rohc_comp_reset_rtp_ports(NULL) == false);
+	CHECK(rohc_comp_reset_rtp_ports(comp) == true);
+	CHECK(rohc_comp_remove_rtp_port(comp, 65535) == false);
+	CHECK(rohc_comp_reset_rtp_ports(comp) == true);
+
+	/* rohc_comp_set_rtp_payload_type() */
+	CHECK(rohc_comp_set_rtp_payload_type(NULL, 0, false) == false);
+	CHECK(rohc_comp_set_rtp_payload_type(comp, 128, false) == false);
+	CHECK(rohc_comp_set_rtp_payload_type(comp, 0, false) == true);
+	CHECK(rohc_comp_set_rtp_payload_type(comp, 127, false) == true);
+	CHECK(rohc_comp_set_rtp_payload_type(comp, 0, true) == true);
+	CHECK(rohc_comp_set_rtp_payload_type(comp, 127, true) == true);
+
 	/* rohc_comp_set_mrru() */
 	CHECK(rohc_comp_set_mrru(NULL, 10) == false);
 	CHECK(rohc_comp_set_mrru(comp, 65535 + 1) == false);
 	CHECK(rohc_comp_set_mrru(comp, 0) == true);
+	CHECK(rohc_comp_set_mrru(comp, 500) == true);
+	CHECK(rohc_comp_set_mrru(comp, 500) == true);
+	CHECK(rohc_comp_set_mrru(comp, 0) == true);
 	CHECK(rohc_comp_set_mrru(comp, 65535) == true);
 
 	/* rohc_comp_get_mrru() */
@@ -233,6 +412,47 @@ int main(int argc, char *argv[])
 	/* disable MRRU for next tests */
 	CHECK(rohc_comp_set_mrru(comp, 0) == true);
 
+	/* rohc_comp_set_memory_budget() */
+	CHECK(rohc_comp_set_memory_budget(NULL, 10) == false);
+	CHECK(rohc_comp_set_memory_budget(comp, 1000) == true);
+	CHECK(rohc_comp_set_memory_budget(comp, 0) == true);
+	CHECK(rohc_comp_set_memory_budget(comp, 0) == true);
+	CHECK(rohc_comp_set_memory_budget(comp, 4 * 1024 * 1024) == true);
+
+	/* rohc_comp_set_huge_pages() */
+	CHECK(rohc_comp_set_huge_pages(NULL, true) == false);
+	/* the memory budget already allocated the contexts */
+	CHECK(rohc_comp_set_huge_pages(comp, true) == false);
+	{
+		struct rohc_comp *const comp_huge =
+			rohc_comp_new2(ROHC_LARGE_CID, ROHC_LARGE_CID_MAX, random_cb, NULL);
+		CHECK(comp_huge != NULL);
+		CHECK(rohc_comp_set_huge_pages(comp_huge, false) == true);
+		CHECK(rohc_comp_set_huge_pages(comp_huge, true) == true);
+		CHECK(rohc_comp_set_huge_pages(comp_huge, true) == true);
+		CHECK(rohc_comp_set_huge_pages(comp_huge, false) == true);
+		CHECK(rohc_comp_set_huge_pages(comp_huge, true) == true);
+		CHECK(rohc_comp_set_memory_budget(comp_huge, 4 * 1024 * 1024) == true);
+		CHECK(rohc_comp_set_huge_pages(comp_huge, false) == false);
+		rohc_comp_free(comp_huge);
+	}
+
+	/* rohc_comp_reserve_contexts() */
+	CHECK(rohc_comp_reserve_contexts(NULL, 1) == false);
+	CHECK(rohc_comp_reserve_contexts(comp, ROHC_SMALL_CID_MAX + 2) == false);
+	CHECK(rohc_comp_reserve_contexts(comp, 0) == true);
+	CHECK(rohc_comp_reserve_contexts(comp, 1) == true);
+	CHECK(rohc_comp_reserve_contexts(comp, ROHC_SMALL_CID_MAX + 1) == true);
+	{
+		struct rohc_comp *const comp_large =
+			rohc_comp_new2(ROHC_LARGE_CID, ROHC_LARGE_CID_MAX, random_cb, NULL);
+		CHECK(comp_large != NULL);
+		CHECK(rohc_comp_reserve_contexts(comp_large, 100) == true);
+		CHECK(rohc_comp_reserve_contexts(comp_large, ROHC_LARGE_CID_MAX + 2) == false);
+		CHECK(rohc_comp_reserve_contexts(comp_large, ROHC_LARGE_CID_MAX + 1) == true);
+		rohc_comp_free(comp_large);
+	}
+
 	/* rohc_comp_get_max_cid() */
 	{
 		size_t max_cid;
@@ -242,6 +462,13 @@ int main(int argc, char *argv[])
 		CHECK(max_cid == ROHC_SMALL_CID_MAX);
 	}
 
+	/* rohc_comp_set_cid_range() */
+	CHECK(rohc_comp_set_cid_range(NULL, 0, ROHC_SMALL_CID_MAX) == false);
+	CHECK(rohc_comp_set_cid_range(comp, 5, 4) == false);
+	CHECK(rohc_comp_set_cid_range(comp, 0, ROHC_SMALL_CID_MAX + 1) == false);
+	CHECK(rohc_comp_set_cid_range(comp, 4, 4) == true);
+	CHECK(rohc_comp_set_cid_range(comp, 0, ROHC_SMALL_CID_MAX) == true);
+
 	/* rohc_comp_get_cid_type() */
 	{
 		rohc_cid_type_t cid_type;
@@ -260,6 +487,12 @@ int main(int argc, char *argv[])
 		CHECK(rohc_comp_get_last_packet_info2(comp, &info) == false);
 	}
 
+	/* rohc_comp_get_last_ctxt_handle() before any compressed packet */
+	{
+		rohc_comp_ctxt_handle_t handle;
+		CHECK(rohc_comp_get_last_ctxt_handle(comp, &handle) == false);
+	}
+
 	/* rohc_compress4() */
 	{
 		const struct rohc_ts ts = { .sec = 0, .nsec = 0 };
@@ -304,6 +537,385 @@ int main(int argc, char *argv[])
 		CHECK(rohc_compress4(comp, pkt, &pkt2) == ROHC_STATUS_OK);
 	}
 
+	/* rohc_compress_burst() */
+	{
+		const struct rohc_ts ts = { .sec = 0, .nsec = 0 };
+		uint8_t buf1[1] = { 0x00 };
+		uint8_t buf[] =
+		{
+			0x45, 0x00, 0x00, 0x54,  0x00, 0x00, 0x40, 0x00,
+			0x40, 0x01, 0x93, 0x52,  0xc0, 0xa8, 0x13, 0x01,
+			0xc0, 0xa8, 0x13, 0x05,  0x08, 0x00, 0xe9, 0xc2,
+			0x9b, 0x42, 0x00, 0x01,  0x66, 0x15, 0xa6, 0x45,
+			0x77, 0x9b, 0x04, 0x00,  0x08, 0x09, 0x0a, 0x0b,
+			0x0c, 0x0d, 0x0e, 0x0f,  0x10, 0x11, 0x12, 0x13,
+			0x14, 0x15, 0x16, 0x17,  0x18, 0x19, 0x1a, 0x1b,
+			0x1c, 0x1d, 0x1e, 0x1f,  0x20, 0x21, 0x22, 0x23,
+			0x24, 0x25, 0x26, 0x27,  0x28, 0x29, 0x2a, 0x2b,
+			0x2c, 0x2d, 0x2e, 0x2f,  0x30, 0x31, 0x32, 0x33,
+			0x34, 0x35, 0x36, 0x37
+		};
+		struct rohc_buf pkts[3] =
+		{
+			rohc_buf_init_full(buf, sizeof(buf), ts),
+			rohc_buf_init_full(buf1, 1, ts),
+			rohc_buf_init_full(buf, sizeof(buf), ts),
+		};
+		uint8_t out_bufs[3][200];
+		struct rohc_buf outs[3] =
+		{
+			rohc_buf_init_empty(out_bufs[0], 200),
+			rohc_buf_init_empty(out_bufs[1], 200),
+			rohc_buf_init_empty(out_bufs[2], 200),
+		};
+		rohc_status_t statuses[3];
+
+		CHECK(rohc_compress_burst(NULL, pkts, outs, 3, statuses) == 0);
+		CHECK(rohc_compress_burst(comp, NULL, outs, 3, statuses) == 0);
+		CHECK(rohc_compress_burst(comp, pkts, NULL, 3, statuses) == 0);
+		CHECK(rohc_compress_burst(comp, pkts, outs, 3, NULL) == 0);
+		CHECK(rohc_compress_burst(comp, pkts, outs, 0, statuses) == 0);
+		CHECK(rohc_compress_burst(comp, pkts, outs, 3, statuses) == 3);
+		CHECK(statuses[0] == ROHC_STATUS_OK);
+		CHECK(statuses[1] == ROHC_STATUS_ERROR);
+		CHECK(statuses[2] == ROHC_STATUS_OK);
+	}
+
+	/* rohc_compress_burst2() */
+	{
+		const struct rohc_ts ts = { .sec = 0, .nsec = 0 };
+		/* the flow of the previous bursts, but the IPv4 checksum is wrong */
+		uint8_t buf[] =
+		{
+			0x45, 0x00, 0x00, 0x54,  0x00, 0x00, 0x40, 0x00,
+			0x40, 0x01, 0x00, 0x00,  0xc0, 0xa8, 0x13, 0x01,
+			0xc0, 0xa8, 0x13, 0x05,  0x08, 0x00, 0xe9, 0xc2,
+			0x9b, 0x42, 0x00, 0x01,  0x66, 0x15, 0xa6, 0x45,
+			0x77, 0x9b, 0x04, 0x00,  0x08, 0x09, 0x0a, 0x0b,
+			0x0c, 0x0d, 0x0e, 0x0f,  0x10, 0x11, 0x12, 0x13,
+			0x14, 0x15, 0x16, 0x17,  0x18, 0x19, 0x1a, 0x1b,
+			0x1c, 0x1d, 0x1e, 0x1f,  0x20, 0x21, 0x22, 0x23,
+			0x24, 0x25, 0x26, 0x27,  0x28, 0x29, 0x2a, 0x2b,
+			0x2c, 0x2d, 0x2e, 0x2f,  0x30, 0x31, 0x32, 0x33,
+			0x34, 0x35, 0x36, 0x37
+		};
+		const struct rohc_buf pkts[1] =
+		{
+			rohc_buf_init_full(buf, sizeof(buf), ts),
+		};
+		const int no_hint[1] = { ROHC_COMP_PKT_NONE };
+		const int csum_ok[1] = { ROHC_COMP_PKT_IP_CSUM_VERIFIED };
+		uint8_t out_buf[200];
+		struct rohc_buf outs[1] = { rohc_buf_init_empty(out_buf, 200) };
+		rohc_comp_last_packet_info2_t info;
+		rohc_status_t statuses[1];
+
+		memset(&info, 0, sizeof(rohc_comp_last_packet_info2_t));
+		CHECK(rohc_compress_burst2(NULL, pkts, NULL, outs, 1, statuses) == 0);
+		CHECK(rohc_compress_burst2(comp, NULL, NULL, outs, 1, statuses) == 0);
+
+		/* the packet is verified and rejected by the IP-only profile, the
+		 * only enabled one */
+		CHECK(rohc_compress_burst2(comp, pkts, no_hint, outs, 1, statuses) == 1);
+		CHECK(statuses[0] == ROHC_STATUS_ERROR);
+		CHECK(rohc_compress_burst2(comp, pkts, NULL, outs, 1, statuses) == 1);
+		CHECK(statuses[0] == ROHC_STATUS_ERROR);
+
+		/* the packet is trusted by the IP-only profile */
+		CHECK(rohc_compress_burst2(comp, pkts, csum_ok, outs, 1, statuses) == 1);
+		CHECK(statuses[0] == ROHC_STATUS_OK);
+		CHECK(rohc_comp_get_last_packet_info2(comp, &info) == true);
+		CHECK(info.profile_id == ROHC_PROFILE_IP);
+	}
+
+	/* rohc_compress_burst_arena() */
+	{
+		const struct rohc_ts ts = { .sec = 0, .nsec = 0 };
+		struct rohc_comp *comp2;
+		uint8_t buf1[1] = { 0x00 };
+		uint8_t buf[] =
+		{
+			0x45, 0x00, 0x00, 0x54,  0x00, 0x00, 0x40, 0x00,
+			0x40, 0x01, 0x93, 0x52,  0xc0, 0xa8, 0x13, 0x01,
+			0xc0, 0xa8, 0x13, 0x05,  0x08, 0x00, 0xe9, 0xc2,
+			0x9b, 0x42, 0x00, 0x01,  0x66, 0x15, 0xa6, 0x45,
+			0x77, 0x9b, 0x04, 0x00,  0x08, 0x09, 0x0a, 0x0b,
+			0x0c, 0x0d, 0x0e, 0x0f,  0x10, 0x11, 0x12, 0x13,
+			0x14, 0x15, 0x16, 0x17,  0x18, 0x19, 0x1a, 0x1b,
+			0x1c, 0x1d, 0x1e, 0x1f,  0x20, 0x21, 0x22, 0x23,
+			0x24, 0x25, 0x26, 0x27,  0x28, 0x29, 0x2a, 0x2b,
+			0x2c, 0x2d, 0x2e, 0x2f,  0x30, 0x31, 0x32, 0x33,
+			0x34, 0x35, 0x36, 0x37
+		};
+		const struct rohc_buf pkts[3] =
+		{
+			rohc_buf_init_full(buf, sizeof(buf), ts),
+			rohc_buf_init_full(buf1, 1, ts),
+			rohc_buf_init_full(buf, sizeof(buf), ts),
+		};
+		/* room for the ROHC headers of the first packets only */
+		uint8_t arena_buf[sizeof(buf) + ROHC_COMP_ARENA_EXTRA_LEN];
+		struct rohc_buf arena = rohc_buf_init_empty(arena_buf, sizeof(arena_buf));
+		struct rohc_buf malformed = rohc_buf_init_empty(NULL, 0);
+		rohc_comp_burst_desc_t descs[3];
+		rohc_status_t statuses[3];
+
+		comp2 = rohc_comp_new2(ROHC_SMALL_CID, 15, random_cb, NULL);
+		CHECK(comp2 != NULL);
+		CHECK(rohc_comp_enable_profile(comp2, ROHC_PROFILE_IP) == true);
+
+		CHECK(rohc_compress_burst_arena(NULL, pkts, NULL, 3, &arena, descs,
+		                                statuses) == 0);
+		CHECK(rohc_compress_burst_arena(comp2, NULL, NULL, 3, &arena, descs,
+		                                statuses) == 0);
+		CHECK(rohc_compress_burst_arena(comp2, pkts, NULL, 3, NULL, descs,
+		                                statuses) == 0);
+		CHECK(rohc_compress_burst_arena(comp2, pkts, NULL, 3, &malformed, descs,
+		                                statuses) == 0);
+		CHECK(rohc_compress_burst_arena(comp2, pkts, NULL, 3, &arena, NULL,
+		                                statuses) == 0);
+		CHECK(rohc_compress_burst_arena(comp2, pkts, NULL, 3, &arena, descs,
+		                                NULL) == 0);
+		CHECK(rohc_compress_burst_arena(comp2, pkts, NULL, 0, &arena, descs,
+		                                statuses) == 0);
+
+		/* the burst stops before the third packet, the arena is full */
+		CHECK(rohc_compress_burst_arena(comp2, pkts, NULL, 3, &arena, descs,
+		                                statuses) == 2);
+		CHECK(statuses[0] == ROHC_STATUS_OK);
+		CHECK(statuses[1] == ROHC_STATUS_ERROR);
+		CHECK(descs[0].hdr_offset == 0);
+		CHECK(descs[0].hdr_len > 0);
+		CHECK(arena.len == descs[0].hdr_len);
+		CHECK((descs[0].payload_offset + descs[0].payload_len) == sizeof(buf));
+
+		/* the next burst appends its ROHC headers to the arena */
+		CHECK(rohc_compress_burst_arena(comp2, pkts + 2, NULL, 1, &arena, descs,
+		                                statuses) == 0);
+		arena.len = 0;
+		CHECK(rohc_compress_burst_arena(comp2, pkts + 2, NULL, 1, &arena, descs,
+		                                statuses) == 1);
+		CHECK(statuses[0] == ROHC_STATUS_OK);
+		CHECK(descs[0].hdr_offset == 0);
+		CHECK(arena.len == descs[0].hdr_len);
+
+		rohc_comp_free(comp2);
+	}
+
+	/* rohc_compress_gso() */
+	{
+		const struct rohc_ts ts = { .sec = 0, .nsec = 0 };
+		struct rohc_comp *comp2;
+		/* IPv4/TCP GSO packet with 30 bytes of payload */
+		uint8_t buf[] =
+		{
+			0x45, 0x00, 0x00, 0x46,  0x00, 0x01, 0x40, 0x00,
+			0x40, 0x06, 0x00, 0x00,  0xc0, 0xa8, 0x13, 0x01,
+			0xc0, 0xa8, 0x13, 0x05,  0x04, 0xd2, 0x00, 0x50,
+			0x00, 0x00, 0x00, 0x01,  0x00, 0x00, 0x00, 0x01,
+			0x50, 0x18, 0xff, 0xff,  0x00, 0x00, 0x00, 0x00,
+			0x00, 0x01, 0x02, 0x03,  0x04, 0x05, 0x06, 0x07,
+			0x08, 0x09, 0x0a, 0x0b,  0x0c, 0x0d, 0x0e, 0x0f,
+			0x10, 0x11, 0x12, 0x13,  0x14, 0x15, 0x16, 0x17,
+			0x18, 0x19, 0x1a, 0x1b,  0x1c, 0x1d
+		};
+		uint8_t buf_copy[sizeof(buf)];
+		struct rohc_buf pkt = rohc_buf_init_full(buf, sizeof(buf), ts);
+		uint8_t hdrs_bufs[3][100];
+		struct rohc_buf hdrs[3] =
+		{
+			rohc_buf_init_empty(hdrs_bufs[0], 100),
+			rohc_buf_init_empty(hdrs_bufs[1], 100),
+			rohc_buf_init_empty(hdrs_bufs[2], 100),
+		};
+		struct rohc_buf payloads[3];
+		size_t segs_nr;
+		size_t i;
+
+		comp2 = rohc_comp_new2(ROHC_SMALL_CID, 15, random_cb, NULL);
+		CHECK(comp2 != NULL);
+		CHECK(rohc_comp_enable_profile(comp2, ROHC_PROFILE_TCP) == true);
+		memcpy(buf_copy, buf, sizeof(buf));
+
+		CHECK(rohc_compress_gso(NULL, pkt, 10, hdrs, payloads, 3, &segs_nr) == false);
+		CHECK(rohc_compress_gso(comp2, pkt, 10, NULL, payloads, 3, &segs_nr) == false);
+		CHECK(rohc_compress_gso(comp2, pkt, 10, hdrs, NULL, 3, &segs_nr) == false);
+		CHECK(rohc_compress_gso(comp2, pkt, 10, hdrs, payloads, 3, NULL) == false);
+		CHECK(rohc_compress_gso(comp2, pkt, 0, hdrs, payloads, 3, &segs_nr) == false);
+		CHECK(rohc_compress_gso(comp2, pkt, 10, hdrs, payloads, 2, &segs_nr) == false);
+		CHECK(segs_nr == 0);
+		pkt.len--;
+		CHECK(rohc_compress_gso(comp2, pkt, 10, hdrs, payloads, 3, &segs_nr) == false);
+		pkt.len++;
+		buf[9] = 0x11; /* UDP */
+		CHECK(rohc_compress_gso(comp2, pkt, 10, hdrs, payloads, 3, &segs_nr) == false);
+		buf[9] = 0x06;
+
+		/* 3 segments whose payloads are slices of the GSO packet */
+		CHECK(rohc_compress_gso(comp2, pkt, 10, hdrs, payloads, 3, &segs_nr) == true);
+		CHECK(segs_nr == 3);
+		for(i = 0; i < segs_nr; i++)
+		{
+			CHECK(hdrs[i].len > 0);
+			CHECK(rohc_buf_data(payloads[i]) == (buf + 40 + i * 10));
+			CHECK(payloads[i].len == 10);
+		}
+		CHECK(memcmp(buf, buf_copy, sizeof(buf)) == 0);
+
+		rohc_comp_free(comp2);
+	}
+
+	/* rohc_compress_iov() */
+	{
+		const struct rohc_ts ts = { .sec = 0, .nsec = 0 };
+		uint8_t buf2[100];
+		struct rohc_buf pkt2 = rohc_buf_init_empty(buf2, 100);
+		struct rohc_buf payload;
+		uint8_t buf[] =
+		{
+			0x45, 0x00, 0x00, 0x54,  0x00, 0x00, 0x40, 0x00,
+			0x40, 0x01, 0x93, 0x52,  0xc0, 0xa8, 0x13, 0x01,
+			0xc0, 0xa8, 0x13, 0x05,  0x08, 0x00, 0xe9, 0xc2,
+			0x9b, 0x42, 0x00, 0x01,  0x66, 0x15, 0xa6, 0x45,
+			0x77, 0x9b, 0x04, 0x00,  0x08, 0x09, 0x0a, 0x0b,
+			0x0c, 0x0d, 0x0e, 0x0f,  0x10, 0x11, 0x12, 0x13,
+			0x14, 0x15, 0x16, 0x17,  0x18, 0x19, 0x1a, 0x1b,
+			0x1c, 0x1d, 0x1e, 0x1f,  0x20, 0x21, 0x22, 0x23,
+			0x24, 0x25, 0x26, 0x27,  0x28, 0x29, 0x2a, 0x2b,
+			0x2c, 0x2d, 0x2e, 0x2f,  0x30, 0x31, 0x32, 0x33,
+			0x34, 0x35, 0x36, 0x37
+		};
+		struct rohc_buf pkt = rohc_buf_init_full(buf, sizeof(buf), ts);
+		CHECK(rohc_compress_iov(NULL, pkt, &pkt2, &payload) == ROHC_STATUS_ERROR);
+		CHECK(rohc_compress_iov(comp, pkt, NULL, &payload) == ROHC_STATUS_ERROR);
+		CHECK(rohc_compress_iov(comp, pkt, &pkt2, NULL) == ROHC_STATUS_ERROR);
+		pkt2.max_len = 1;
+		CHECK(rohc_compress_iov(comp, pkt, &pkt2, &payload) == ROHC_STATUS_ERROR);
+		pkt2.max_len = 100;
+		CHECK(rohc_compress_iov(comp, pkt, &pkt2, &payload) == ROHC_STATUS_OK);
+		CHECK(pkt2.len > 0);
+		CHECK(rohc_buf_data(payload) + payload.len == buf + sizeof(buf));
+		CHECK(payload.len < sizeof(buf));
+	}
+
+	/* rohc_compress_inplace() */
+	{
+		const struct rohc_ts ts = { .sec = 0, .nsec = 0 };
+		const uint8_t ip_pkt[] =
+		{
+			0x45, 0x00, 0x00, 0x54,  0x00, 0x00, 0x40, 0x00,
+			0x40, 0x01, 0x93, 0x52,  0xc0, 0xa8, 0x13, 0x01,
+			0xc0, 0xa8, 0x13, 0x05,  0x08, 0x00, 0xe9, 0xc2,
+			0x9b, 0x42, 0x00, 0x01,  0x66, 0x15, 0xa6, 0x45,
+			0x77, 0x9b, 0x04, 0x00,  0x08, 0x09, 0x0a, 0x0b,
+			0x0c, 0x0d, 0x0e, 0x0f,  0x10, 0x11, 0x12, 0x13,
+			0x14, 0x15, 0x16, 0x17,  0x18, 0x19, 0x1a, 0x1b,
+			0x1c, 0x1d, 0x1e, 0x1f,  0x20, 0x21, 0x22, 0x23,
+			0x24, 0x25, 0x26, 0x27,  0x28, 0x29, 0x2a, 0x2b,
+			0x2c, 0x2d, 0x2e, 0x2f,  0x30, 0x31, 0x32, 0x33,
+			0x34, 0x35, 0x36, 0x37
+		};
+		uint8_t buf[100 + sizeof(ip_pkt)];
+		struct rohc_buf pkt = rohc_buf_init_full(buf, sizeof(buf), ts);
+		CHECK(rohc_compress_inplace(NULL, &pkt) == ROHC_STATUS_ERROR);
+		CHECK(rohc_compress_inplace(comp, NULL) == ROHC_STATUS_ERROR);
+		memcpy(buf, ip_pkt, sizeof(ip_pkt));
+		pkt.offset = 0;
+		pkt.len = sizeof(ip_pkt);
+		CHECK(rohc_compress_inplace(comp, &pkt) == ROHC_STATUS_ERROR);
+		memcpy(buf + 100, ip_pkt, sizeof(ip_pkt));
+		pkt.offset = 100;
+		pkt.len = sizeof(ip_pkt);
+		CHECK(rohc_compress_inplace(comp, &pkt) == ROHC_STATUS_OK);
+		CHECK(pkt.offset + pkt.len == sizeof(buf));
+		CHECK(pkt.len > 0);
+		CHECK(memcmp(buf + sizeof(buf) - 8, ip_pkt + sizeof(ip_pkt) - 8, 8) == 0);
+	}
+
+	/* rohc_comp_get_last_ctxt_handle() and rohc_compress_with_ctxt() */
+	{
+		const struct rohc_ts ts = { .sec = 0, .nsec = 0 };
+		uint8_t buf1[1] = { 0x00 };
+		struct rohc_buf pkt1 = rohc_buf_init_full(buf1, 1, ts);
+		uint8_t buf[] =
+		{
+			0x45, 0x00, 0x00, 0x54,  0x00, 0x00, 0x40, 0x00,
+			0x40, 0x01, 0x93, 0x52,  0xc0, 0xa8, 0x13, 0x01,
+			0xc0, 0xa8, 0x13, 0x05,  0x08, 0x00, 0xe9, 0xc2,
+			0x9b, 0x42, 0x00, 0x01,  0x66, 0x15, 0xa6, 0x45,
+			0x77, 0x9b, 0x04, 0x00,  0x08, 0x09, 0x0a, 0x0b,
+			0x0c, 0x0d, 0x0e, 0x0f,  0x10, 0x11, 0x12, 0x13,
+			0x14, 0x15, 0x16, 0x17,  0x18, 0x19, 0x1a, 0x1b,
+			0x1c, 0x1d, 0x1e, 0x1f,  0x20, 0x21, 0x22, 0x23,
+			0x24, 0x25, 0x26, 0x27,  0x28, 0x29, 0x2a, 0x2b,
+			0x2c, 0x2d, 0x2e, 0x2f,  0x30, 0x31, 0x32, 0x33,
+			0x34, 0x35, 0x36, 0x37
+		};
+		struct rohc_buf pkt = rohc_buf_init_full(buf, sizeof(buf), ts);
+		uint8_t out_buf[200];
+		struct rohc_buf out = rohc_buf_init_empty(out_buf, 200);
+		rohc_comp_last_packet_info2_t info;
+		rohc_comp_ctxt_handle_t handle;
+		size_t cid;
+
+		CHECK(rohc_compress4(comp, pkt, &out) == ROHC_STATUS_OK);
+		CHECK(rohc_comp_get_last_ctxt_handle(NULL, &handle) == false);
+		CHECK(rohc_comp_get_last_ctxt_handle(comp, NULL) == false);
+		CHECK(rohc_comp_get_last_ctxt_handle(comp, &handle) == true);
+		CHECK(handle != ROHC_COMP_CTXT_HANDLE_NONE);
+		memset(&info, 0, sizeof(rohc_comp_last_packet_info2_t));
+		CHECK(rohc_comp_get_last_packet_info2(comp, &info) == true);
+		cid = info.context_id;
+
+		out.len = 0;
+		CHECK(rohc_compress_with_ctxt(NULL, handle, pkt, &out) == ROHC_STATUS_ERROR);
+		CHECK(rohc_compress_with_ctxt(comp, handle, pkt, NULL) == ROHC_STATUS_ERROR);
+		CHECK(rohc_compress_with_ctxt(comp, ROHC_COMP_CTXT_HANDLE_NONE, pkt,
+		                              &out) == ROHC_STATUS_NO_CONTEXT);
+		CHECK(rohc_compress_with_ctxt(comp, handle + (1ULL << 32), pkt,
+		                              &out) == ROHC_STATUS_NO_CONTEXT);
+		/* a non-IP packet does not match the IP-only context */
+		CHECK(rohc_compress_with_ctxt(comp, handle, pkt1,
+		                              &out) == ROHC_STATUS_NO_CONTEXT);
+		CHECK(rohc_compress_with_ctxt(comp, handle, pkt, &out) == ROHC_STATUS_OK);
+		CHECK(out.len > 0);
+		memset(&info, 0, sizeof(rohc_comp_last_packet_info2_t));
+		CHECK(rohc_comp_get_last_packet_info2(comp, &info) == true);
+		CHECK(info.context_id == cid);
+	}
+
+	/* rohc_comp_segment_iov() */
+	{
+		const struct rohc_ts ts = { .sec = 0, .nsec = 0 };
+		uint8_t hdr_buf[10] = { 0 };
+		uint8_t payload_buf[20] = { 0 };
+		const struct rohc_buf hdr = rohc_buf_init_full(hdr_buf, 10, ts);
+		const struct rohc_buf payload = rohc_buf_init_full(payload_buf, 20, ts);
+		rohc_comp_segment_t segs[4];
+		size_t segs_nr;
+		size_t len = 0;
+		size_t i;
+		CHECK(rohc_comp_segment_iov(NULL, hdr, payload, 10, segs, 4, &segs_nr) == false);
+		CHECK(rohc_comp_segment_iov(comp, hdr, payload, 10, NULL, 4, &segs_nr) == false);
+		CHECK(rohc_comp_segment_iov(comp, hdr, payload, 10, segs, 4, NULL) == false);
+		/* MRRU is disabled */
+		CHECK(rohc_comp_segment_iov(comp, hdr, payload, 10, segs, 4, &segs_nr) == false);
+		CHECK(rohc_comp_set_mrru(comp, 500) == true);
+		CHECK(rohc_comp_segment_iov(comp, hdr, payload, 1, segs, 4, &segs_nr) == false);
+		CHECK(rohc_comp_segment_iov(comp, hdr, payload, 10, segs, 3, &segs_nr) == false);
+		CHECK(rohc_comp_segment_iov(comp, hdr, payload, 10, segs, 4, &segs_nr) == true);
+		CHECK(segs_nr == 4);
+		for(i = 0; i < segs_nr; i++)
+		{
+			CHECK(segs[i].type == ((i + 1) == segs_nr ? 0xff : 0xfe));
+			len += segs[i].rohc_hdr_len + segs[i].payload_len + segs[i].crc_len;
+		}
+		CHECK(len == 10 + 20 + 4);
+		CHECK(segs[1].rohc_hdr_len == 1 && segs[1].payload_len == 8);
+		CHECK(segs[3].payload_len == 3 && segs[3].crc_len == 4);
+		CHECK(rohc_comp_set_mrru(comp, 0) == true);
+	}
+
 	/* rohc_comp_get_last_packet_info2() */
 	{
 		rohc_comp_last_packet_info2_t info;
@@ -332,6 +944,37 @@ int main(int argc, char *argv[])
 		CHECK(rohc_comp_get_general_info(comp, &info) == false);
 		info.version_minor = 0;
 		CHECK(rohc_comp_get_general_info(comp, &info) == true);
+		info.version_minor = 1;
+		CHECK(rohc_comp_get_general_info(comp, &info) == true);
+		CHECK(info.packets_nr64 == info.packets_nr);
+		CHECK(info.uncomp_bytes_nr64 == info.uncomp_bytes_nr);
+		CHECK(info.comp_bytes_nr64 == info.comp_bytes_nr);
+		info.version_minor = 2;
+		CHECK(rohc_comp_get_general_info(comp, &info) == true);
+		CHECK(info.reinit_pending_nr == 0);
+		CHECK(info.reinit_total_nr == 0);
+		info.version_minor = 3;
+		CHECK(rohc_comp_get_general_info(comp, &info) == true);
+		CHECK(info.ctxts_misses_nr >= info.ctxts_recycled_nr);
+		info.version_minor = 4;
+		CHECK(rohc_comp_get_general_info(comp, &info) == true);
+		CHECK(info.ctxts_mru_hits_nr <= info.ctxts_hits_nr);
+		info.version_minor = 5;
+		CHECK(rohc_comp_get_general_info(comp, &info) == false);
+	}
+
+	/* rohc_comp_get_ctxts_stats() */
+	{
+		rohc_comp_ctxt_stats_t stats[16];
+		size_t stats_nr;
+		CHECK(rohc_comp_get_ctxts_stats(NULL, stats, 16, &stats_nr) == false);
+		CHECK(rohc_comp_get_ctxts_stats(comp, NULL, 16, &stats_nr) == false);
+		CHECK(rohc_comp_get_ctxts_stats(comp, stats, 16, NULL) == false);
+		CHECK(rohc_comp_get_ctxts_stats(comp, stats, 0, &stats_nr) == false);
+		CHECK(rohc_comp_get_ctxts_stats(comp, stats, 16, &stats_nr) == true);
+		CHECK(stats_nr > 0);
+		CHECK(stats[0].packets_nr > 0);
+		CHECK(stats[0].comp_bytes_nr > 0);
 	}
 
 	/* rohc_comp_get_state_descr() */
@@ -343,10 +986,73 @@ int main(int argc, char *argv[])
 	/* rohc_comp_force_contexts_reinit() with some contexts init'ed */
 	CHECK(rohc_comp_force_contexts_reinit(comp) == true);
 
+	/* rohc_comp_force_contexts_reinit_paced() */
+	CHECK(rohc_comp_force_contexts_reinit_paced(NULL, 1000, 0) == false);
+	CHECK(rohc_comp_force_contexts_reinit_paced(comp, 0, 0) == true);
+	CHECK(rohc_comp_force_contexts_reinit_paced(comp, 1000, 0) == true);
+	CHECK(rohc_comp_force_contexts_reinit_paced(comp, 0, 10000) == true);
+	CHECK(rohc_comp_force_contexts_reinit_paced(comp, 1000, 10000) == true);
+
 	/* rohc_comp_set_features */
 	CHECK(rohc_comp_set_features(comp, ROHC_COMP_FEATURE_COMPAT_1_6_x) == false);
 	CHECK(rohc_comp_set_features(comp, ROHC_COMP_FEATURE_NO_IP_CHECKSUMS) == true);
+	CHECK(rohc_comp_set_features(comp, ROHC_COMP_FEATURE_REALTIME |
+	                                   ROHC_COMP_FEATURE_WLSB_VARIABLE_WIDTH) == false);
+	CHECK(rohc_comp_set_features(comp, ROHC_COMP_FEATURE_REALTIME) == true);
+	CHECK(rohc_comp_set_features(comp, ROHC_COMP_FEATURE_NONE) == true);
+
+	/* rohc_comp_maintenance */
+	{
+		const struct rohc_ts now = { .sec = 100, .nsec = 0 };
+		CHECK(rohc_comp_maintenance(NULL, now) == false);
+		CHECK(rohc_comp_maintenance(comp, now) == true);
+	}
+#ifdef ROHC_TIMINGS
+	CHECK(rohc_comp_set_features(comp, ROHC_COMP_FEATURE_TIMINGS) == true);
 	CHECK(rohc_comp_set_features(comp, ROHC_COMP_FEATURE_NONE) == true);
+#else
+	CHECK(rohc_comp_set_features(comp, ROHC_COMP_FEATURE_TIMINGS) == false);
+#endif
+
+	/* rohc_comp_get_timings() */
+	{
+		rohc_timings_histo_t histo;
+		CHECK(rohc_comp_get_timings(NULL, ROHC_PACKET_IR, ROHC_COMP_PHASE_PARSE,
+		                            &histo) == false);
+		CHECK(rohc_comp_get_timings(comp, ROHC_PACKET_MAX, ROHC_COMP_PHASE_PARSE,
+		                            &histo) == false);
+		CHECK(rohc_comp_get_timings(comp, ROHC_PACKET_IR, ROHC_COMP_PHASE_MAX,
+		                            &histo) == false);
+		CHECK(rohc_comp_get_timings(comp, ROHC_PACKET_IR, ROHC_COMP_PHASE_PARSE,
+		                            NULL) == false);
+#ifdef ROHC_TIMINGS
+		CHECK(rohc_comp_get_timings(comp, ROHC_PACKET_IR, ROHC_COMP_PHASE_PARSE,
+		                            &histo) == true);
+#else
+		CHECK(rohc_comp_get_timings(comp, ROHC_PACKET_IR, ROHC_COMP_PHASE_PARSE,
+		                            &histo) == false);
+#endif
+	}
+
+	/* rohc_comp_get_profile_timings() */
+	{
+		rohc_timings_histo_t histo;
+		CHECK(rohc_comp_get_profile_timings(NULL, ROHC_PROFILE_RTP,
+		                                    ROHC_COMP_PHASE_CRC, &histo) == false);
+		CHECK(rohc_comp_get_profile_timings(comp, ROHC_PROFILE_MAX,
+		                                    ROHC_COMP_PHASE_CRC, &histo) == false);
+		CHECK(rohc_comp_get_profile_timings(comp, ROHC_PROFILE_RTP,
+		                                    ROHC_COMP_PHASE_MAX, &histo) == false);
+		CHECK(rohc_comp_get_profile_timings(comp, ROHC_PROFILE_RTP,
+		                                    ROHC_COMP_PHASE_CRC, NULL) == false);
+#ifdef ROHC_TIMINGS
+		CHECK(rohc_comp_get_profile_timings(comp, ROHC_PROFILE_RTP,
+		                                    ROHC_COMP_PHASE_FEEDBACK, &histo) == true);
+#else
+		CHECK(rohc_comp_get_profile_timings(comp, ROHC_PROFILE_RTP,
+		                                    ROHC_COMP_PHASE_FEEDBACK, &histo) == false);
+#endif
+	}
 
 	/* rohc_comp_deliver_feedback2() */
 	{
@@ -363,16 +1069,847 @@ int main(int argc, char *argv[])
 		pkt.len = 5; CHECK(rohc_comp_deliver_feedback2(comp, pkt) == true);
 	}
 
+	/* rohc_comp_deliver_feedback_burst() */
+	{
+		const struct rohc_ts ts = { .sec = 0, .nsec = 0 };
+		uint8_t buf[] = {
+			0xf4, 0x20, 0x01, 0x11, 0x39,
+			0xf4, 0x20, 0x01, 0x11, 0x39,
+			0xf1, 0x01
+		};
+		struct rohc_buf pkt = rohc_buf_init_full(buf, 12, ts);
+
+		CHECK(rohc_comp_deliver_feedback_burst(NULL, pkt) == false);
+		pkt.len = 0; CHECK(rohc_comp_deliver_feedback_burst(comp, pkt) == true);
+		pkt.len = 1; CHECK(rohc_comp_deliver_feedback_burst(comp, pkt) == false);
+		pkt.len = 4; CHECK(rohc_comp_deliver_feedback_burst(comp, pkt) == false);
+		pkt.len = 5; CHECK(rohc_comp_deliver_feedback_burst(comp, pkt) == true);
+		pkt.len = 7; CHECK(rohc_comp_deliver_feedback_burst(comp, pkt) == false);
+		pkt.len = 10; CHECK(rohc_comp_deliver_feedback_burst(comp, pkt) == true);
+		pkt.len = 12; CHECK(rohc_comp_deliver_feedback_burst(comp, pkt) == true);
+	}
+
+	/* rohc_comp_enqueue_feedback() */
+	{
+		const struct rohc_ts ts = { .sec = 0, .nsec = 0 };
+		uint8_t buf[] = { 0xf4, 0x20, 0x01, 0x11, 0x39 };
+		struct rohc_buf pkt = rohc_buf_init_full(buf, 5, ts);
+		size_t i;
+
+		CHECK(rohc_comp_enqueue_feedback(NULL, pkt) == false);
+		pkt.len = 0; CHECK(rohc_comp_enqueue_feedback(comp, pkt) == true);
+		pkt.len = 1; CHECK(rohc_comp_enqueue_feedback(comp, pkt) == false);
+		pkt.len = 2; CHECK(rohc_comp_enqueue_feedback(comp, pkt) == false);
+		pkt.len = 3; CHECK(rohc_comp_enqueue_feedback(comp, pkt) == false);
+		pkt.len = 4; CHECK(rohc_comp_enqueue_feedback(comp, pkt) == false);
+		pkt.len = 5; CHECK(rohc_comp_enqueue_feedback(comp, pkt) == true);
+
+		/* the queue gets full, then the compressor empties it */
+		for(i = 1; i < 64; i++)
+		{
+			CHECK(rohc_comp_enqueue_feedback(comp, pkt) == true);
+		}
+		CHECK(rohc_comp_enqueue_feedback(comp, pkt) == false);
+		pkt.len = 0; CHECK(rohc_comp_deliver_feedback2(comp, pkt) == true);
+		pkt.len = 5; CHECK(rohc_comp_enqueue_feedback(comp, pkt) == true);
+		pkt.len = 0; CHECK(rohc_comp_deliver_feedback2(comp, pkt) == true);
+	}
+
+	/* rohc_comp_export_contexts() and rohc_comp_import_contexts() */
+	{
+		struct rohc_comp *comp2;
+		uint8_t buf[2048];
+		struct rohc_buf snapshot = rohc_buf_init_empty(buf, 2048);
+		size_t snapshot_len;
+
+		CHECK(rohc_comp_export_contexts(NULL, &snapshot) == false);
+		CHECK(rohc_comp_export_contexts(comp, &snapshot) == false);
+		CHECK(rohc_comp_set_features(comp, ROHC_COMP_FEATURE_SNAPSHOTS) == true);
+		CHECK(rohc_comp_export_contexts(comp, NULL) == false);
+		snapshot.max_len = 1;
+		CHECK(rohc_comp_export_contexts(comp, &snapshot) == false);
+		snapshot.max_len = 2048;
+		CHECK(rohc_comp_export_contexts(comp, &snapshot) == true);
+		snapshot_len = snapshot.len;
+
+		comp2 = rohc_comp_new2(ROHC_SMALL_CID, ROHC_SMALL_CID_MAX,
+		                       random_cb, NULL);
+		CHECK(comp2 != NULL);
+		CHECK(rohc_comp_enable_profile(comp2, ROHC_PROFILE_IP) == true);
+		CHECK(rohc_comp_import_contexts(NULL, snapshot) == false);
+		CHECK(rohc_comp_import_contexts(comp, snapshot) == false);
+		snapshot.len = 1;
+		CHECK(rohc_comp_import_contexts(comp2, snapshot) == false);
+		snapshot.len = snapshot_len;
+		buf[0] = 'X';
+		CHECK(rohc_comp_import_contexts(comp2, snapshot) == false);
+		buf[0] = 'R';
+		CHECK(rohc_comp_import_contexts(comp2, snapshot) == true);
+		rohc_comp_free(comp2);
+	}
+
+	/* rohc_comp_export_changes() and rohc_comp_import_changes() */
+	{
+		struct rohc_comp *comp2;
+		uint8_t buf[2048];
+		struct rohc_buf changes = rohc_buf_init_empty(buf, 2048);
+		size_t changes_len;
+
+		CHECK(rohc_comp_export_changes(NULL, &changes) == false);
+		CHECK(rohc_comp_export_changes(comp, NULL) == false);
+		changes.max_len = 1;
+		CHECK(rohc_comp_export_changes(comp, &changes) == false);
+		changes.max_len = 2048;
+		CHECK(rohc_comp_export_changes(comp, &changes) == true);
+		changes_len = changes.len;
+
+		comp2 = rohc_comp_new2(ROHC_SMALL_CID, ROHC_SMALL_CID_MAX,
+		                       random_cb, NULL);
+		CHECK(comp2 != NULL);
+		CHECK(rohc_comp_enable_profile(comp2, ROHC_PROFILE_IP) == true);
+		CHECK(rohc_comp_import_changes(NULL, changes) == false);
+		changes.len = 1;
+		CHECK(rohc_comp_import_changes(comp2, changes) == false);
+		changes.len = changes_len;
+		buf[0] = 'X';
+		CHECK(rohc_comp_import_changes(comp2, changes) == false);
+		buf[0] = 'R';
+		CHECK(rohc_comp_import_changes(comp2, changes) == true);
+		rohc_comp_free(comp2);
+
+		CHECK(rohc_comp_set_features(comp, ROHC_COMP_FEATURE_NONE) == true);
+		CHECK(rohc_comp_export_changes(comp, &changes) == false);
+	}
+
+	/* rohc_comp_migrate_context() */
+	{
+		struct rohc_comp *comp2;
+		rohc_cid_t new_cid;
+
+		comp2 = rohc_comp_new2(ROHC_SMALL_CID, ROHC_SMALL_CID_MAX,
+		                       random_cb, NULL);
+		CHECK(comp2 != NULL);
+		CHECK(rohc_comp_enable_profile(comp2, ROHC_PROFILE_IP) == true);
+		CHECK(rohc_comp_migrate_context(NULL, 0, comp2, &new_cid) == false);
+		CHECK(rohc_comp_migrate_context(comp, 0, NULL, &new_cid) == false);
+		CHECK(rohc_comp_migrate_context(comp, 0, comp, &new_cid) == false);
+		CHECK(rohc_comp_migrate_context(comp, 0, comp2, NULL) == false);
+		CHECK(rohc_comp_migrate_context(comp, ROHC_SMALL_CID_MAX + 1, comp2,
+		                                &new_cid) == false);
+		/* context is not saved without the SNAPSHOTS feature */
+		CHECK(rohc_comp_migrate_context(comp, 0, comp2, &new_cid) == false);
+		rohc_comp_free(comp2);
+	}
+
+	/* rohc_comp_prewarm_context() */
+	{
+		const struct rohc_ts ts = { .sec = 0, .nsec = 0 };
+		uint8_t template_buf[] =
+		{
+			0x45, 0x00, 0x00, 0x14,  0x00, 0x00, 0x40, 0x00,
+			0x40, 0x3b, 0x93, 0x58,  0xc0, 0xa8, 0x13, 0x01,
+			0xc0, 0xa8, 0x13, 0x05
+		};
+		struct rohc_buf template_pkt =
+			rohc_buf_init_full(template_buf, sizeof(template_buf), ts);
+		uint8_t ir_buf[100];
+		struct rohc_buf rohc_ir = rohc_buf_init_empty(ir_buf, 100);
+
+		CHECK(rohc_comp_prewarm_context(NULL, 1, ROHC_PROFILE_IP, template_pkt,
+		                                &rohc_ir) == false);
+		CHECK(rohc_comp_prewarm_context(comp, 1, ROHC_PROFILE_IP, template_pkt,
+		                                NULL) == false);
+		template_pkt.len = 0;
+		CHECK(rohc_comp_prewarm_context(comp, 1, ROHC_PROFILE_IP, template_pkt,
+		                                &rohc_ir) == false);
+		template_pkt.len = sizeof(template_buf);
+		CHECK(rohc_comp_prewarm_context(comp, ROHC_SMALL_CID_MAX + 1,
+		                                ROHC_PROFILE_IP, template_pkt,
+		                                &rohc_ir) == false);
+		CHECK(rohc_comp_prewarm_context(comp, 0, ROHC_PROFILE_IP, template_pkt,
+		                                &rohc_ir) == false);
+		CHECK(rohc_comp_prewarm_context(comp, 1, ROHC_PROFILE_UDP, template_pkt,
+		                                &rohc_ir) == false);
+		rohc_ir.max_len = 1;
+		CHECK(rohc_comp_prewarm_context(comp, 1, ROHC_PROFILE_IP, template_pkt,
+		                                &rohc_ir) == false);
+		rohc_ir.max_len = 100;
+		CHECK(rohc_comp_prewarm_context(comp, 1, ROHC_PROFILE_IP, template_pkt,
+		                                &rohc_ir) == true);
+		CHECK(rohc_ir.len > 0);
+		CHECK(rohc_comp_prewarm_context(comp, 1, ROHC_PROFILE_IP, template_pkt,
+		                                &rohc_ir) == false);
+	}
+
+	/* rohc_compress_with_ctxt() with packets that the TCP profile cannot
+	 * compress in the context of the handle */
+	{
+		const struct rohc_ts ts = { .sec = 0, .nsec = 0 };
+		uint8_t buf[] =
+		{
+			0x45, 0x00, 0x00, 0x30,  0x00, 0x01, 0x40, 0x00,
+			0x40, 0x06, 0x93, 0x70,  0xc0, 0xa8, 0x13, 0x01,
+			0xc0, 0xa8, 0x13, 0x05,  0x13, 0x88, 0x00, 0x50,
+			0x00, 0x00, 0x00, 0x01,  0x00, 0x00, 0x00, 0x00,
+			0x50, 0x10, 0x20, 0x00,  0x00, 0x00, 0x00, 0x00,
+			0x08, 0x09, 0x0a, 0x0b,  0x0c, 0x0d, 0x0e, 0x0f
+		};
+		struct rohc_buf pkt = rohc_buf_init_full(buf, sizeof(buf), ts);
+		/* IPv4 header followed by 10 bytes of the TCP header only */
+		uint8_t buf_trunc[] =
+		{
+			0x45, 0x00, 0x00, 0x1e,  0x00, 0x01, 0x40, 0x00,
+			0x40, 0x06, 0x93, 0x82,  0xc0, 0xa8, 0x13, 0x01,
+			0xc0, 0xa8, 0x13, 0x05,  0x13, 0x88, 0x00, 0x50,
+			0x00, 0x00, 0x00, 0x01,  0x00, 0x00
+		};
+		struct rohc_buf pkt_trunc =
+			rohc_buf_init_full(buf_trunc, sizeof(buf_trunc), ts);
+		/* the same IPv4/TCP packet in an IPv4 tunnel */
+		uint8_t buf_tunnel[] =
+		{
+			0x45, 0x00, 0x00, 0x44,  0x00, 0x02, 0x40, 0x00,
+			0x40, 0x04, 0x93, 0x5d,  0xc0, 0xa8, 0x13, 0x01,
+			0xc0, 0xa8, 0x13, 0x05,  0x45, 0x00, 0x00, 0x30,
+			0x00, 0x01, 0x40, 0x00,  0x40, 0x06, 0x93, 0x70,
+			0xc0, 0xa8, 0x13, 0x01,  0xc0, 0xa8, 0x13, 0x05,
+			0x13, 0x88, 0x00, 0x50,  0x00, 0x00, 0x00, 0x01,
+			0x00, 0x00, 0x00, 0x00,  0x50, 0x10, 0x20, 0x00,
+			0x00, 0x00, 0x00, 0x00,  0x08, 0x09, 0x0a, 0x0b,
+			0x0c, 0x0d, 0x0e, 0x0f
+		};
+		struct rohc_buf pkt_tunnel =
+			rohc_buf_init_full(buf_tunnel, sizeof(buf_tunnel), ts);
+		uint8_t out_buf[200];
+		struct rohc_buf out = rohc_buf_init_empty(out_buf, 200);
+		rohc_comp_last_packet_info2_t info;
+		rohc_comp_ctxt_handle_t handle;
+
+		CHECK(rohc_comp_enable_profile(comp, ROHC_PROFILE_TCP) == true);
+		CHECK(rohc_compress4(comp, pkt, &out) == ROHC_STATUS_OK);
+		memset(&info, 0, sizeof(rohc_comp_last_packet_info2_t));
+		CHECK(rohc_comp_get_last_packet_info2(comp, &info) == true);
+		CHECK(info.profile_id == ROHC_PROFILE_TCP);
+		CHECK(rohc_comp_get_last_ctxt_handle(comp, &handle) == true);
+
+		/* a truncated TCP header is not accepted by the TCP profile */
+		out.len = 0;
+		CHECK(rohc_compress_with_ctxt(comp, handle, pkt_trunc,
+		                              &out) == ROHC_STATUS_NO_CONTEXT);
+		/* one more IP header than the context */
+		CHECK(rohc_compress_with_ctxt(comp, handle, pkt_tunnel,
+		                              &out) == ROHC_STATUS_NO_CONTEXT);
+		CHECK(rohc_compress_with_ctxt(comp, handle, pkt, &out) == ROHC_STATUS_OK);
+		CHECK(out.len > 0);
+
+		CHECK(rohc_comp_disable_profile(comp, ROHC_PROFILE_TCP) == true);
+	}
+
 	/* several functions with some packets already compressed */
 	{
 		rohc_trace_callback2_t fct = (rohc_trace_callback2_t) NULL;
 		CHECK(rohc_comp_set_traces_cb2(comp, fct, comp) == false);
+		CHECK(rohc_comp_set_trace_level(comp, ROHC_TRACE_WARNING) == false);
+		CHECK(rohc_comp_set_trace_sampling(comp, 100, false) == true);
+		CHECK(rohc_comp_set_trace_sampling(comp, 0, false) == true);
 
 		CHECK(rohc_comp_set_wlsb_window_width(comp, 16) == false);
 
 		CHECK(rohc_comp_set_periodic_refreshes(comp, 10, 5) == false);
+		CHECK(rohc_comp_set_periodic_refreshes_time(comp, 1000, 500) == false);
 
 		CHECK(rohc_comp_set_list_trans_nr(comp, 5) == false);
+
+		CHECK(rohc_comp_set_ctxts_recycling(comp, ROHC_COMP_RECYCLE_LFU) == false);
+
+		CHECK(rohc_comp_set_admission(comp, 5, 1) == false);
+
+		CHECK(rohc_comp_set_cid_range(comp, 0, 7) == false);
+	}
+
+	/* rohc_comp_group_*() */
+	{
+		const struct rohc_ts ts = { .sec = 0, .nsec = 0 };
+		struct rohc_comp_group *group;
+		uint8_t buf[] =
+		{
+			0x45, 0x00, 0x00, 0x1e,  0x00, 0x00, 0x40, 0x00,
+			0x40, 0x11, 0x93, 0x78,  0xc0, 0xa8, 0x13, 0x01,
+			0xc0, 0xa8, 0x13, 0x05,  0x04, 0xd2, 0x16, 0x2e,
+			0x00, 0x0a, 0x00, 0x00,  0x01, 0x02
+		};
+		struct rohc_buf pkt = rohc_buf_init_full(buf, sizeof(buf), ts);
+		struct rohc_buf dequeued;
+		uint8_t rohc_buf[100];
+		struct rohc_buf rohc_pkt = rohc_buf_init_empty(rohc_buf, 100);
+		rohc_comp_last_packet_info2_t info;
+		uint8_t fb_buf[] = { 0xf2, 0xe0, 0x00 };
+		struct rohc_buf fb = rohc_buf_init_full(fb_buf, 3, ts);
+		size_t shard;
+		size_t other_shard;
+		size_t i;
+
+		CHECK(rohc_comp_group_new(ROHC_SMALL_CID, 15, 0, 8, random_cb, NULL) == NULL);
+		CHECK(rohc_comp_group_new(ROHC_SMALL_CID, 15, 17, 8, random_cb, NULL) == NULL);
+		CHECK(rohc_comp_group_new(ROHC_SMALL_CID, 15, 4, 0, random_cb, NULL) == NULL);
+		CHECK(rohc_comp_group_new(ROHC_SMALL_CID, 15, 4, 6, random_cb, NULL) == NULL);
+		CHECK(rohc_comp_group_new(ROHC_SMALL_CID, 16, 4, 8, random_cb, NULL) == NULL);
+		CHECK(rohc_comp_group_new(ROHC_SMALL_CID, 15, 4, 8, NULL, NULL) == NULL);
+		group = rohc_comp_group_new(ROHC_SMALL_CID, 15, 4, 8, random_cb, NULL);
+		CHECK(group != NULL);
+
+		/* rohc_comp_group_get_shard() */
+		CHECK(rohc_comp_group_get_shard(NULL, 0) == NULL);
+		CHECK(rohc_comp_group_get_shard(group, 4) == NULL);
+		for(i = 0; i < 4; i++)
+		{
+			CHECK(rohc_comp_group_get_shard(group, i) != NULL);
+			CHECK(rohc_comp_enable_profile(rohc_comp_group_get_shard(group, i),
+			                               ROHC_PROFILE_UDP) == true);
+		}
+
+		/* rohc_comp_group_enqueue() */
+		CHECK(rohc_comp_group_enqueue(NULL, pkt, &shard) == false);
+		CHECK(rohc_comp_group_enqueue(group, pkt, NULL) == false);
+		CHECK(rohc_comp_group_enqueue(group, pkt, &shard) == true);
+		CHECK(shard < 4);
+		other_shard = (shard + 1) % 4;
+
+		/* rohc_comp_group_dequeue() */
+		CHECK(rohc_comp_group_dequeue(NULL, shard, &dequeued) == false);
+		CHECK(rohc_comp_group_dequeue(group, 4, &dequeued) == false);
+		CHECK(rohc_comp_group_dequeue(group, shard, NULL) == false);
+		CHECK(rohc_comp_group_dequeue(group, other_shard, &dequeued) == false);
+		CHECK(rohc_comp_group_dequeue(group, shard, &dequeued) == true);
+		CHECK(rohc_buf_data(dequeued) == buf && dequeued.len == sizeof(buf));
+		CHECK(rohc_comp_group_dequeue(group, shard, &dequeued) == false);
+
+		/* the shard compresses the flow with the first CID of its range */
+		CHECK(rohc_compress4(rohc_comp_group_get_shard(group, shard), dequeued,
+		                     &rohc_pkt) == ROHC_STATUS_OK);
+		memset(&info, 0, sizeof(rohc_comp_last_packet_info2_t));
+		CHECK(rohc_comp_get_last_packet_info2(rohc_comp_group_get_shard(group, shard),
+		                                      &info) == true);
+		CHECK(info.context_id == (shard * 4));
+
+		/* the packets of one flow always go to the same shard */
+		for(i = 0; i < 8; i++)
+		{
+			CHECK(rohc_comp_group_enqueue(group, pkt, &other_shard) == true);
+			CHECK(other_shard == shard);
+		}
+		CHECK(rohc_comp_group_enqueue(group, pkt, &other_shard) == false);
+		CHECK(other_shard == shard);
+
+		/* rohc_comp_group_deliver_feedback() */
+		fb_buf[1] = 0xe0 | (shard * 4);
+		CHECK(rohc_comp_group_deliver_feedback(NULL, fb) == false);
+		fb.len = 0; CHECK(rohc_comp_group_deliver_feedback(group, fb) == true);
+		fb.len = 2; CHECK(rohc_comp_group_deliver_feedback(group, fb) == false);
+		fb.len = 3; CHECK(rohc_comp_group_deliver_feedback(group, fb) == true);
+		for(i = 0; i < 8; i++)
+		{
+			CHECK(rohc_comp_group_dequeue(group, shard, &dequeued) == true);
+		}
+		CHECK(rohc_comp_group_dequeue(group, shard, &dequeued) == false);
+
+		/* rohc_comp_group_free() */
+		rohc_comp_group_free(NULL);
+		rohc_comp_group_free(group);
+	}
+
+	/* rohc_comp_pipeline_*() */
+	{
+		const struct rohc_ts ts = { .sec = 0, .nsec = 0 };
+		struct rohc_comp *comp2;
+		struct rohc_comp_pipeline *pipeline;
+		uint8_t buf[] =
+		{
+			0x45, 0x00, 0x00, 0x1e,  0x00, 0x00, 0x40, 0x00,
+			0x40, 0x11, 0x93, 0x78,  0xc0, 0xa8, 0x13, 0x01,
+			0xc0, 0xa8, 0x13, 0x05,  0x04, 0xd2, 0x16, 0x2e,
+			0x00, 0x0a, 0x00, 0x00,  0x01, 0x02
+		};
+		struct rohc_buf pkt = rohc_buf_init_full(buf, sizeof(buf), ts);
+		uint8_t rohc_buf1[100];
+		struct rohc_buf rohc_pkt1 = rohc_buf_init_empty(rohc_buf1, 100);
+		uint8_t rohc_buf2[100];
+		struct rohc_buf rohc_pkt2 = rohc_buf_init_empty(rohc_buf2, 100);
+		struct rohc_buf *out;
+		rohc_status_t status;
+
+		comp2 = rohc_comp_new2(ROHC_SMALL_CID, 15, random_cb, NULL);
+		CHECK(comp2 != NULL);
+		CHECK(rohc_comp_enable_profile(comp2, ROHC_PROFILE_UDP) == true);
+
+		/* rohc_comp_pipeline_new() */
+		CHECK(rohc_comp_pipeline_new(NULL, 2) == NULL);
+		CHECK(rohc_comp_pipeline_new(comp2, 0) == NULL);
+		CHECK(rohc_comp_pipeline_new(comp2, 3) == NULL);
+		pipeline = rohc_comp_pipeline_new(comp2, 2);
+		CHECK(pipeline != NULL);
+
+		/* rohc_comp_pipeline_parse() */
+		CHECK(rohc_comp_pipeline_parse(NULL, pkt, &rohc_pkt1) == false);
+		CHECK(rohc_comp_pipeline_parse(pipeline, pkt, NULL) == false);
+		CHECK(rohc_comp_pipeline_parse(pipeline, pkt, &rohc_pkt1) == true);
+		pkt.len = 0;
+		CHECK(rohc_comp_pipeline_parse(pipeline, pkt, &rohc_pkt2) == true);
+		pkt.len = sizeof(buf);
+		CHECK(rohc_comp_pipeline_parse(pipeline, pkt, &rohc_pkt2) == false);
+
+		/* rohc_comp_pipeline_output() before rohc_comp_pipeline_encode() */
+		CHECK(rohc_comp_pipeline_output(pipeline, &out, &status) == false);
+
+		/* rohc_comp_pipeline_encode() */
+		CHECK(rohc_comp_pipeline_encode(NULL) == false);
+		CHECK(rohc_comp_pipeline_encode(pipeline) == true);
+		CHECK(rohc_comp_pipeline_encode(pipeline) == true);
+		CHECK(rohc_comp_pipeline_encode(pipeline) == false);
+
+		/* rohc_comp_pipeline_output() */
+		CHECK(rohc_comp_pipeline_output(NULL, &out, &status) == false);
+		CHECK(rohc_comp_pipeline_output(pipeline, NULL, &status) == false);
+		CHECK(rohc_comp_pipeline_output(pipeline, &out, NULL) == false);
+		CHECK(rohc_comp_pipeline_output(pipeline, &out, &status) == true);
+		CHECK(out == &rohc_pkt1 && status == ROHC_STATUS_OK);
+		CHECK(rohc_pkt1.len > 2 &&
+		      rohc_buf_byte_at(rohc_pkt1, rohc_pkt1.len - 2) == 0x01 &&
+		      rohc_buf_byte_at(rohc_pkt1, rohc_pkt1.len - 1) == 0x02);
+		CHECK(rohc_comp_pipeline_output(pipeline, &out, &status) == true);
+		CHECK(out == &rohc_pkt2 && status == ROHC_STATUS_ERROR);
+		CHECK(rohc_comp_pipeline_output(pipeline, &out, &status) == false);
+
+		/* the pipeline is empty again */
+		CHECK(rohc_comp_pipeline_parse(pipeline, pkt, &rohc_pkt2) == true);
+
+		/* rohc_comp_pipeline_free() */
+		rohc_comp_pipeline_free(NULL);
+		rohc_comp_pipeline_free(pipeline);
+		rohc_comp_free(comp2);
+	}
+
+	/* rohc_couple_*() */
+	{
+		const struct rohc_ts ts = { .sec = 0, .nsec = 0 };
+		struct rohc_comp *comp2;
+		struct rohc_decomp *decomp;
+		struct rohc_couple *couple;
+		uint8_t buf[] =
+		{
+			0x45, 0x00, 0x00, 0x1e,  0x00, 0x00, 0x40, 0x00,
+			0x40, 0x11, 0x93, 0x78,  0xc0, 0xa8, 0x13, 0x01,
+			0xc0, 0xa8, 0x13, 0x05,  0x04, 0xd2, 0x16, 0x2e,
+			0x00, 0x0a, 0x00, 0x00,  0x01, 0x02
+		};
+		struct rohc_buf pkt = rohc_buf_init_full(buf, sizeof(buf), ts);
+		uint8_t rohc_buf[100];
+		struct rohc_buf rohc_pkt = rohc_buf_init_empty(rohc_buf, 100);
+		uint8_t uncomp_buf[100];
+		struct rohc_buf uncomp_pkt = rohc_buf_init_empty(uncomp_buf, 100);
+		uint8_t fb_buf[100];
+		struct rohc_buf fb = rohc_buf_init_empty(fb_buf, 100);
+
+		comp2 = rohc_comp_new2(ROHC_SMALL_CID, 15, random_cb, NULL);
+		CHECK(comp2 != NULL);
+		CHECK(rohc_comp_enable_profile(comp2, ROHC_PROFILE_UDP) == true);
+		decomp = rohc_decomp_new2(ROHC_SMALL_CID, 15, ROHC_O_MODE);
+		CHECK(decomp != NULL);
+		CHECK(rohc_decomp_enable_profile(decomp, ROHC_PROFILE_UDP) == true);
+
+		/* rohc_couple_new() */
+		CHECK(rohc_couple_new(NULL, decomp, 64) == NULL);
+		CHECK(rohc_couple_new(comp2, NULL, 64) == NULL);
+		couple = rohc_couple_new(comp2, decomp, 64);
+		CHECK(couple != NULL);
+
+		/* rohc_couple_compress() */
+		CHECK(rohc_couple_compress(NULL, pkt, &rohc_pkt) == ROHC_STATUS_ERROR);
+		CHECK(rohc_couple_compress(couple, pkt, NULL) == ROHC_STATUS_ERROR);
+		CHECK(rohc_couple_compress(couple, pkt, &rohc_pkt) == ROHC_STATUS_OK);
+
+		/* rohc_couple_decompress(): the IR packet is acknowledged */
+		CHECK(rohc_couple_decompress(NULL, rohc_pkt, &uncomp_pkt) == ROHC_STATUS_ERROR);
+		CHECK(rohc_couple_decompress(couple, rohc_pkt, &uncomp_pkt) == ROHC_STATUS_OK);
+		CHECK(uncomp_pkt.len == sizeof(buf));
+
+		/* the ACK is piggybacked on the next packet */
+		rohc_buf_reset(&rohc_pkt);
+		CHECK(rohc_couple_compress(couple, pkt, &rohc_pkt) == ROHC_STATUS_OK);
+		CHECK((rohc_buf_byte(rohc_pkt) & 0xf8) == 0xf0);
+
+		/* rohc_couple_flush_feedback() */
+		CHECK(rohc_couple_flush_feedback(NULL, &fb) == false);
+		CHECK(rohc_couple_flush_feedback(couple, NULL) == false);
+		CHECK(rohc_couple_flush_feedback(couple, &fb) == true);
+		CHECK(fb.len == 0);
+
+		/* rohc_couple_free() */
+		rohc_couple_free(NULL);
+		rohc_couple_free(couple);
+		rohc_decomp_free(decomp);
+		rohc_comp_free(comp2);
+	}
+
+	/* rohc_channels_*() */
+	{
+		const struct rohc_ts ts = { .sec = 0, .nsec = 0 };
+		struct rohc_comp *comp2;
+		struct rohc_comp *comp3;
+		struct rohc_decomp *decomp2;
+		struct rohc_comp *run_comp;
+		struct rohc_decomp *run_decomp;
+		struct rohc_channels *channels;
+		size_t channel;
+		size_t channel2;
+		size_t run_channel;
+		uint8_t buf[] =
+		{
+			0x45, 0x00, 0x00, 0x1e,  0x00, 0x00, 0x40, 0x00,
+			0x40, 0x11, 0x93, 0x78,  0xc0, 0xa8, 0x13, 0x01,
+			0xc0, 0xa8, 0x13, 0x05,  0x04, 0xd2, 0x16, 0x2e,
+			0x00, 0x0a, 0x00, 0x00,  0x01, 0x02
+		};
+		struct rohc_buf pkt = rohc_buf_init_full(buf, sizeof(buf), ts);
+		uint8_t rohc_buf[100];
+		struct rohc_buf rohc_pkt = rohc_buf_init_empty(rohc_buf, 100);
+
+		comp2 = rohc_comp_new2(ROHC_SMALL_CID, 15, random_cb, NULL);
+		CHECK(comp2 != NULL);
+		CHECK(rohc_comp_enable_profile(comp2, ROHC_PROFILE_UDP) == true);
+		comp3 = rohc_comp_new2(ROHC_SMALL_CID, 15, random_cb, NULL);
+		CHECK(comp3 != NULL);
+		CHECK(rohc_comp_set_memory_budget(comp3, 100000) == true);
+		decomp2 = rohc_decomp_new2(ROHC_SMALL_CID, 15, ROHC_U_MODE);
+		CHECK(decomp2 != NULL);
+
+		/* rohc_channels_new() */
+		CHECK(rohc_channels_new(0, 2) == NULL);
+		CHECK(rohc_channels_new(2, 0) == NULL);
+		channels = rohc_channels_new(2, 2);
+		CHECK(channels != NULL);
+
+		/* rohc_channels_add(): no memory budget */
+		CHECK(rohc_channels_add(NULL, comp2, NULL, &channel) == false);
+		CHECK(rohc_channels_add(channels, NULL, NULL, &channel) == false);
+		CHECK(rohc_channels_add(channels, comp2, NULL, NULL) == false);
+		CHECK(rohc_channels_add(channels, comp3, NULL, &channel) == false);
+		CHECK(rohc_channels_add(channels, comp2, NULL, &channel) == true);
+		CHECK(rohc_channels_add(channels, NULL, decomp2, &channel2) == true);
+		CHECK(channel2 != channel);
+		CHECK(rohc_channels_add(channels, comp2, NULL, &channel2) == false);
+
+		/* rohc_channels_next(): nothing to run yet */
+		CHECK(rohc_channels_next(NULL, 0, &run_channel, &run_comp, &run_decomp) == false);
+		CHECK(rohc_channels_next(channels, 2, &run_channel, &run_comp, &run_decomp) == false);
+		CHECK(rohc_channels_next(channels, 0, NULL, &run_comp, &run_decomp) == false);
+		CHECK(rohc_channels_next(channels, 0, &run_channel, NULL, &run_decomp) == false);
+		CHECK(rohc_channels_next(channels, 0, &run_channel, &run_comp, NULL) == false);
+		CHECK(rohc_channels_next(channels, 0, &run_channel, &run_comp, &run_decomp) == false);
+
+		/* rohc_channels_notify() */
+		CHECK(rohc_channels_notify(NULL, channel) == false);
+		CHECK(rohc_channels_notify(channels, 2) == false);
+		CHECK(rohc_channels_notify(channels, channel) == true);
+		CHECK(rohc_channels_notify(channels, channel) == true);
+
+		/* rohc_channels_next(): the channel is stolen by the other worker, then
+		 * it runs only once */
+		CHECK(rohc_channels_next(channels, 1 - channel, &run_channel, &run_comp,
+		                         &run_decomp) == true);
+		CHECK(run_channel == channel);
+		CHECK(run_comp == comp2);
+		CHECK(run_decomp == NULL);
+		CHECK(rohc_compress4(run_comp, pkt, &rohc_pkt) == ROHC_STATUS_OK);
+		CHECK(rohc_channels_next(channels, channel, &run_channel, &run_comp,
+		                         &run_decomp) == false);
+
+		/* rohc_channels_remove(): only idle channels */
+		CHECK(rohc_channels_remove(NULL, channel) == false);
+		CHECK(rohc_channels_remove(channels, 2) == false);
+		CHECK(rohc_channels_remove(channels, channel) == false);
+
+		/* rohc_channels_done(): notified while running, so run again */
+		CHECK(rohc_channels_notify(channels, channel) == true);
+		CHECK(rohc_channels_done(NULL, 1 - channel, channel) == false);
+		CHECK(rohc_channels_done(channels, 2, channel) == false);
+		CHECK(rohc_channels_done(channels, 1 - channel, 2) == false);
+		CHECK(rohc_channels_done(channels, 1 - channel, channel2) == false);
+		CHECK(rohc_channels_done(channels, 1 - channel, channel) == true);
+		CHECK(rohc_channels_next(channels, 1 - channel, &run_channel, &run_comp,
+		                         &run_decomp) == true);
+		CHECK(run_channel == channel);
+		CHECK(rohc_channels_done(channels, 1 - channel, channel) == true);
+		CHECK(rohc_channels_next(channels, 0, &run_channel, &run_comp, &run_decomp) == false);
+
+		/* rohc_channels_remove() */
+		CHECK(rohc_channels_remove(channels, channel) == true);
+		CHECK(rohc_channels_remove(channels, channel) == false);
+		CHECK(rohc_channels_notify(channels, channel) == false);
+
+		/* rohc_channels_free() */
+		rohc_channels_free(NULL);
+		rohc_channels_free(channels);
+		rohc_decomp_free(decomp2);
+		rohc_comp_free(comp3);
+		rohc_comp_free(comp2);
+	}
+
+	/* rohc_channels_exec_*() */
+	{
+		const struct rohc_ts ts = { .sec = 0, .nsec = 0 };
+		struct rohc_comp *comp2;
+		struct rohc_decomp *decomp2;
+		struct rohc_channels *channels;
+		struct rohc_channels_exec *exec;
+		struct rohc_buf *collected;
+		rohc_status_t status;
+		size_t channel;
+		size_t channel2;
+		uint8_t buf[] =
+		{
+			0x45, 0x00, 0x00, 0x1e,  0x00, 0x00, 0x40, 0x00,
+			0x40, 0x11, 0x93, 0x78,  0xc0, 0xa8, 0x13, 0x01,
+			0xc0, 0xa8, 0x13, 0x05,  0x04, 0xd2, 0x16, 0x2e,
+			0x00, 0x0a, 0x00, 0x00,  0x01, 0x02
+		};
+		struct rohc_buf pkt = rohc_buf_init_full(buf, sizeof(buf), ts);
+		uint8_t rohc_buf1[100];
+		struct rohc_buf rohc_pkt1 = rohc_buf_init_empty(rohc_buf1, 100);
+		uint8_t rohc_buf2[100];
+		struct rohc_buf rohc_pkt2 = rohc_buf_init_empty(rohc_buf2, 100);
+		uint8_t rohc_buf3[100];
+		struct rohc_buf rohc_pkt3 = rohc_buf_init_empty(rohc_buf3, 100);
+
+		comp2 = rohc_comp_new2(ROHC_SMALL_CID, 15, random_cb, NULL);
+		CHECK(comp2 != NULL);
+		CHECK(rohc_comp_enable_profile(comp2, ROHC_PROFILE_UDP) == true);
+		decomp2 = rohc_decomp_new2(ROHC_SMALL_CID, 15, ROHC_U_MODE);
+		CHECK(decomp2 != NULL);
+		channels = rohc_channels_new(2, 1);
+		CHECK(channels != NULL);
+		CHECK(rohc_channels_add(channels, comp2, NULL, &channel) == true);
+		CHECK(rohc_channels_add(channels, NULL, decomp2, &channel2) == true);
+
+		/* rohc_channels_exec_new() */
+		CHECK(rohc_channels_exec_new(NULL, 2, 1) == NULL);
+		CHECK(rohc_channels_exec_new(channels, 0, 1) == NULL);
+		CHECK(rohc_channels_exec_new(channels, 3, 1) == NULL);
+		CHECK(rohc_channels_exec_new(channels, 2, 0) == NULL);
+		CHECK(rohc_channels_exec_new(channels, 2, 33) == NULL);
+		exec = rohc_channels_exec_new(channels, 2, 1);
+		CHECK(exec != NULL);
+
+		/* rohc_channels_exec_submit(): 2 packets at most */
+		CHECK(rohc_channels_exec_submit(NULL, channel, pkt, &rohc_pkt1) == false);
+		CHECK(rohc_channels_exec_submit(exec, 2, pkt, &rohc_pkt1) == false);
+		CHECK(rohc_channels_exec_submit(exec, channel2, pkt, &rohc_pkt1) == false);
+		CHECK(rohc_channels_exec_submit(exec, channel, pkt, NULL) == false);
+		CHECK(rohc_channels_exec_submit(exec, channel, pkt, &rohc_pkt1) == true);
+		CHECK(rohc_channels_exec_submit(exec, channel, pkt, &rohc_pkt2) == true);
+		CHECK(rohc_channels_exec_submit(exec, channel, pkt, &rohc_pkt3) == false);
+
+		/* rohc_channels_exec_collect(): nothing compressed yet */
+		CHECK(rohc_channels_exec_collect(exec, channel, &collected, &status) == false);
+
+		/* rohc_channels_exec_run(): bursts of 1 packet */
+		CHECK(rohc_channels_exec_run(NULL, 0) == 0);
+		CHECK(rohc_channels_exec_run(exec, 1) == 0);
+		CHECK(rohc_channels_exec_run(exec, 0) == 1);
+		CHECK(rohc_channels_exec_run(exec, 0) == 1);
+		CHECK(rohc_channels_exec_run(exec, 0) == 0);
+
+		/* rohc_channels_exec_collect() */
+		CHECK(rohc_channels_exec_collect(NULL, channel, &collected, &status) == false);
+		CHECK(rohc_channels_exec_collect(exec, 2, &collected, &status) == false);
+		CHECK(rohc_channels_exec_collect(exec, channel, NULL, &status) == false);
+		CHECK(rohc_channels_exec_collect(exec, channel, &collected, NULL) == false);
+		CHECK(rohc_channels_exec_collect(exec, channel, &collected, &status) == true);
+		CHECK(collected == &rohc_pkt1);
+		CHECK(status == ROHC_STATUS_OK);
+		CHECK(rohc_pkt1.len > 0);
+		CHECK(rohc_channels_exec_collect(exec, channel, &collected, &status) == true);
+		CHECK(collected == &rohc_pkt2);
+		CHECK(status == ROHC_STATUS_OK);
+		CHECK(rohc_pkt2.len > 0);
+		CHECK(rohc_channels_exec_collect(exec, channel, &collected, &status) == false);
+
+		/* rohc_channels_exec_free() */
+		rohc_channels_exec_free(NULL);
+		rohc_channels_exec_free(exec);
+		rohc_channels_free(channels);
+		rohc_decomp_free(decomp2);
+		rohc_comp_free(comp2);
+	}
+
+	/* rohc_comp_set_event_cb() */
+	{
+		const struct rohc_ts ts = { .sec = 0, .nsec = 0 };
+		struct test_events events;
+		struct rohc_comp *comp2;
+		uint8_t buf[] =
+		{
+			0x45, 0x00, 0x00, 0x1e,  0x00, 0x00, 0x40, 0x00,
+			0x40, 0x11, 0x93, 0x78,  0xc0, 0xa8, 0x13, 0x01,
+			0xc0, 0xa8, 0x13, 0x05,  0x04, 0xd2, 0x16, 0x2e,
+			0x00, 0x0a, 0x00, 0x00,  0x01, 0x02
+		};
+		struct rohc_buf pkt = rohc_buf_init_full(buf, sizeof(buf), ts);
+		uint8_t rohc_buf[100];
+		struct rohc_buf rohc_pkt = rohc_buf_init_empty(rohc_buf, 100);
+		size_t i;
+
+		memset(&events, 0, sizeof(struct test_events));
+		comp2 = rohc_comp_new2(ROHC_SMALL_CID, 0, random_cb, NULL);
+		CHECK(comp2 != NULL);
+		CHECK(rohc_comp_enable_profiles(comp2, ROHC_PROFILE_UDP,
+		                                ROHC_PROFILE_IP, -1) == true);
+
+		CHECK(rohc_comp_set_event_cb(NULL, event_cb, &events) == false);
+		CHECK(rohc_comp_set_event_cb(comp2, event_cb, &events) == true);
+
+		/* one context is created, then it leaves the IR state */
+		for(i = 0; i < 10; i++)
+		{
+			rohc_buf_reset(&rohc_pkt);
+			CHECK(rohc_compress4(comp2, pkt, &rohc_pkt) == ROHC_STATUS_OK);
+		}
+		CHECK(events.nr[ROHC_COMP_EVENT_CTXT_CREATE] == 1);
+		CHECK(events.nr[ROHC_COMP_EVENT_CTXT_RECYCLE] == 0);
+		CHECK(events.nr[ROHC_COMP_EVENT_STATE_CHANGE] >= 1);
+		CHECK(events.last.event == ROHC_COMP_EVENT_STATE_CHANGE);
+		CHECK(events.last.cid == 0);
+		CHECK(events.last.profile_id == ROHC_PROFILE_UDP);
+		CHECK(events.last.old_state != events.last.new_state);
+
+		/* the only context is recycled for another flow */
+		buf[9] = 0x06; /* TCP, compressed by the IP-only profile */
+		buf[11] = 0x83; /* the IP checksum changes too */
+		rohc_buf_reset(&rohc_pkt);
+		CHECK(rohc_compress4(comp2, pkt, &rohc_pkt) == ROHC_STATUS_OK);
+		CHECK(events.nr[ROHC_COMP_EVENT_CTXT_RECYCLE] == 1);
+		CHECK(events.nr[ROHC_COMP_EVENT_CTXT_CREATE] == 2);
+		CHECK(events.last.event == ROHC_COMP_EVENT_CTXT_CREATE);
+		CHECK(events.last.profile_id == ROHC_PROFILE_IP);
+		CHECK(events.last.new_state == ROHC_COMP_STATE_IR);
+
+		/* no event without callback */
+		CHECK(rohc_comp_set_event_cb(comp2, NULL, NULL) == true);
+		buf[9] = 0x11;
+		buf[11] = 0x78;
+		rohc_buf_reset(&rohc_pkt);
+		CHECK(rohc_compress4(comp2, pkt, &rohc_pkt) == ROHC_STATUS_OK);
+		CHECK(events.nr[ROHC_COMP_EVENT_CTXT_CREATE] == 2);
+
+		rohc_comp_free(comp2);
+	}
+
+	/* rohc_comp_set_pkt_log() and rohc_comp_get_pkt_log() */
+	{
+		const struct rohc_ts ts = { .sec = 0, .nsec = 0 };
+		struct rohc_comp *comp2;
+		uint8_t buf[] =
+		{
+			0x45, 0x00, 0x00, 0x1e,  0x00, 0x00, 0x40, 0x00,
+			0x40, 0x11, 0x93, 0x78,  0xc0, 0xa8, 0x13, 0x01,
+			0xc0, 0xa8, 0x13, 0x05,  0x04, 0xd2, 0x16, 0x2e,
+			0x00, 0x0a, 0x00, 0x00,  0x01, 0x02
+		};
+		struct rohc_buf pkt = rohc_buf_init_full(buf, sizeof(buf), ts);
+		uint8_t rohc_buf[100];
+		struct rohc_buf rohc_pkt = rohc_buf_init_empty(rohc_buf, 100);
+		rohc_pkt_log_record_t records[8];
+		size_t records_nr;
+		size_t i;
+
+		comp2 = rohc_comp_new2(ROHC_SMALL_CID, 0, random_cb, NULL);
+		CHECK(comp2 != NULL);
+		CHECK(rohc_comp_enable_profile(comp2, ROHC_PROFILE_UDP) == true);
+
+		CHECK(rohc_comp_set_pkt_log(NULL, 4) == false);
+		CHECK(rohc_comp_set_pkt_log(comp2, 3) == false);
+		CHECK(rohc_comp_get_pkt_log(NULL, records, 8, &records_nr) == false);
+		CHECK(rohc_comp_get_pkt_log(comp2, NULL, 8, &records_nr) == false);
+		CHECK(rohc_comp_get_pkt_log(comp2, records, 8, NULL) == false);
+
+		/* nothing is recorded while the log is disabled */
+		rohc_buf_reset(&rohc_pkt);
+		CHECK(rohc_compress4(comp2, pkt, &rohc_pkt) == ROHC_STATUS_OK);
+		CHECK(rohc_comp_get_pkt_log(comp2, records, 8, &records_nr) == true);
+		CHECK(records_nr == 0);
+
+		/* only the last 4 packets are kept, oldest first */
+		CHECK(rohc_comp_set_pkt_log(comp2, 4) == true);
+		for(i = 0; i < 6; i++)
+		{
+			rohc_buf_reset(&rohc_pkt);
+			CHECK(rohc_compress4(comp2, pkt, &rohc_pkt) == ROHC_STATUS_OK);
+		}
+		CHECK(rohc_comp_get_pkt_log(comp2, records, 8, &records_nr) == true);
+		CHECK(records_nr == 4);
+		CHECK(records[0].packet_nr == 4);
+		CHECK(records[3].packet_nr == 7);
+		CHECK(records[3].sn == records[0].sn + 3);
+		CHECK(records[3].cid == 0);
+		CHECK(records[3].profile_id == ROHC_PROFILE_UDP);
+		CHECK(records[3].packet_type < ROHC_PACKET_MAX);
+		CHECK(records[3].status == ROHC_STATUS_OK);
+		CHECK(rohc_comp_get_pkt_log(comp2, records, 2, &records_nr) == true);
+		CHECK(records_nr == 2);
+		CHECK(records[1].packet_nr == 7);
+
+		/* the records are dropped when the log is disabled */
+		CHECK(rohc_comp_set_pkt_log(comp2, 0) == true);
+		CHECK(rohc_comp_get_pkt_log(comp2, records, 8, &records_nr) == true);
+		CHECK(records_nr == 0);
+
+		rohc_comp_free(comp2);
+	}
+
+	/* rohc_set_allocator() */
+	{
+		const struct rohc_ts ts = { .sec = 0, .nsec = 0 };
+		struct test_allocs allocs = { .allocs_nr = 0, .frees_nr = 0 };
+		struct rohc_comp *comp2;
+		uint8_t buf[] =
+		{
+			0x45, 0x00, 0x00, 0x1e,  0x00, 0x00, 0x40, 0x00,
+			0x40, 0x11, 0x93, 0x78,  0xc0, 0xa8, 0x13, 0x01,
+			0xc0, 0xa8, 0x13, 0x05,  0x04, 0xd2, 0x16, 0x2e,
+			0x00, 0x0a, 0x00, 0x00,  0x01, 0x02
+		};
+		struct rohc_buf pkt = rohc_buf_init_full(buf, sizeof(buf), ts);
+		uint8_t rohc_buf[100];
+		struct rohc_buf rohc_pkt = rohc_buf_init_empty(rohc_buf, 100);
+		size_t allocs_nr;
+		size_t i;
+
+		CHECK(rohc_set_allocator(test_malloc, NULL, &allocs) == false);
+		CHECK(rohc_set_allocator(NULL, test_free, &allocs) == false);
+		CHECK(rohc_set_allocator(test_malloc, test_free, &allocs) == true);
+
+		/* the compressor and its contexts are allocated by the allocator */
+		comp2 = rohc_comp_new2(ROHC_SMALL_CID, 0, random_cb, NULL);
+		CHECK(comp2 != NULL);
+		CHECK(allocs.allocs_nr > 0);
+		CHECK(rohc_comp_enable_profile(comp2, ROHC_PROFILE_UDP) == true);
+		allocs_nr = allocs.allocs_nr;
+		CHECK(rohc_compress4(comp2, pkt, &rohc_pkt) == ROHC_STATUS_OK);
+		CHECK(allocs.allocs_nr > allocs_nr);
+
+		/* no allocation once the context is created */
+		allocs_nr = allocs.allocs_nr;
+		for(i = 0; i < 10; i++)
+		{
+			rohc_buf_reset(&rohc_pkt);
+			CHECK(rohc_compress4(comp2, pkt, &rohc_pkt) == ROHC_STATUS_OK);
+		}
+		CHECK(allocs.allocs_nr == allocs_nr);
+
+		/* all the memory is freed by the allocator */
+		rohc_comp_free(comp2);
+		CHECK(allocs.frees_nr == allocs.allocs_nr);
+		CHECK(rohc_set_allocator(NULL, NULL, NULL) == true);
 	}
 
 	/* rohc_comp_free() */
@@ -401,3 +1938,49 @@ static int random_cb(const struct rohc_comp *const comp __attribute__((unused)),
 	return 0; /* fake */
 }
 
+
+/**
+ * @brief Record the events of the contexts
+ *
+ * @param priv_ctxt  The events seen so far
+ * @param info       The description of the event
+ */
+static void event_cb(void *const priv_ctxt,
+                     const rohc_comp_event_info_t *const info)
+{
+	struct test_events *const events = priv_ctxt;
+
+	events->nr[info->event]++;
+	memcpy(&events->last, info, sizeof(rohc_comp_event_info_t));
+}
+
+
+/**
+ * @brief Allocate memory and count the allocation
+ *
+ * @param size       The number of bytes to allocate
+ * @param priv_ctxt  The allocations done so far
+ * @return           The allocated memory, NULL in case of failure
+ */
+static void * test_malloc(const size_t size, void *const priv_ctxt)
+{
+	struct test_allocs *const allocs = priv_ctxt;
+
+	allocs->allocs_nr++;
+	return malloc(size);
+}
+
+
+/**
+ * @brief Free memory and count the deallocation
+ *
+ * @param ptr        The memory to free
+ * @param priv_ctxt  The allocations done so far
+ */
+static void test_free(void *const ptr, void *const priv_ctxt)
+{
+	struct test_allocs *const allocs = priv_ctxt;
+
+	allocs->frees_nr++;
+	free(ptr);
+}
@@ -66,9 +66,10 @@ static bool d_esp_create(const struct rohc_decomp_ctxt *const context,
                          struct rohc_decomp_volat_ctxt *const volat_ctxt)
 	__attribute__((warn_unused_result, nonnull(1, 2, 3)));
 
-static void d_esp_destroy(struct rohc_decomp_rfc3095_ctxt *const rfc3095_ctxt,
+static void d_esp_destroy(const struct rohc_decomp_ctxt *const context,
+                          struct rohc_decomp_rfc3095_ctxt *const rfc3095_ctxt,
                           const struct rohc_decomp_volat_ctxt *const volat_ctxt)
-	__attribute__((nonnull(1, 2)));
+	__attribute__((nonnull(1, 2, 3)));
 
 static int esp_parse_static_esp(const struct rohc_decomp_ctxt *const context,
                                 const uint8_t *packet,
@@ -117,7 +118,6 @@ static bool d_esp_create(const struct rohc_decomp_ctxt *const context,
                          struct rohc_decomp_volat_ctxt *const volat_ctxt)
 {
 	struct rohc_decomp_rfc3095_ctxt *rfc3095_ctxt;
-	struct d_esp_context *esp_context;
 
 	assert(context != NULL);
 	assert(context->decompressor != NULL);
@@ -125,8 +125,11 @@ static bool d_esp_create(const struct rohc_decomp_ctxt *const context,
 
 	/* create the generic context */
 	if(!rohc_decomp_rfc3095_create(context, persist_ctxt, volat_ctxt,
+	                               sizeof(struct d_esp_context), sizeof(struct esphdr),
 	                               context->decompressor->trace_callback,
 	                               context->decompressor->trace_callback_priv,
+	                               context->decompressor->trace_level,
+	                               context->decompressor->trace_pkt_level,
 	                               context->profile->id))
 	{
 		rohc_error(context->decompressor, ROHC_TRACE_DECOMP, context->profile->id,
@@ -135,26 +138,12 @@ static bool d_esp_create(const struct rohc_decomp_ctxt *const context,
 	}
 	rfc3095_ctxt = *persist_ctxt;
 
-	/* create the ESP-specific part of the context */
-	esp_context = malloc(sizeof(struct d_esp_context));
-	if(esp_context == NULL)
-	{
-		rohc_error(context->decompressor, ROHC_TRACE_DECOMP, context->profile->id,
-		           "cannot allocate memory for the ESP-specific context");
-		goto destroy_context;
-	}
-	memset(esp_context, 0, sizeof(struct d_esp_context));
-	rfc3095_ctxt->specific = esp_context;
+	/* the ESP-specific part of the context (the SPI) was zeroed along with
+	 * the generic part */
 
-	/* create the LSB decoding context for SN (same shift value as RTP) */
+	/* init the LSB decoding context for SN (same shift value as RTP) */
 	rfc3095_ctxt->sn_lsb_p = ROHC_LSB_SHIFT_ESP_SN;
-	rfc3095_ctxt->sn_lsb_ctxt = rohc_lsb_new(32);
-	if(rfc3095_ctxt->sn_lsb_ctxt == NULL)
-	{
-		rohc_error(context->decompressor, ROHC_TRACE_DECOMP, context->profile->id,
-		           "failed to create the LSB decoding context for SN");
-		goto free_esp_context;
-	}
+	rohc_lsb_init(&rfc3095_ctxt->sn_lsb_ctxt, 32);
 
 	/* some ESP-specific values and functions */
 	rfc3095_ctxt->next_header_len = sizeof(struct esphdr);
@@ -168,42 +157,11 @@ static bool d_esp_create(const struct rohc_decomp_ctxt *const context,
 	rfc3095_ctxt->compute_crc_dynamic = esp_compute_crc_dynamic;
 	rfc3095_ctxt->update_context = esp_update_context;
 
-	/* create the ESP-specific part of the header changes */
-	rfc3095_ctxt->outer_ip_changes->next_header_len = sizeof(struct esphdr);
-	rfc3095_ctxt->outer_ip_changes->next_header = malloc(sizeof(struct esphdr));
-	if(rfc3095_ctxt->outer_ip_changes->next_header == NULL)
-	{
-		rohc_error(context->decompressor, ROHC_TRACE_DECOMP, context->profile->id,
-		           "cannot allocate memory for the ESP-specific part of the "
-		           "outer IP header changes");
-		goto free_lsb_sn;
-	}
-	memset(rfc3095_ctxt->outer_ip_changes->next_header, 0, sizeof(struct esphdr));
-
-	rfc3095_ctxt->inner_ip_changes->next_header_len = sizeof(struct esphdr);
-	rfc3095_ctxt->inner_ip_changes->next_header = malloc(sizeof(struct esphdr));
-	if(rfc3095_ctxt->inner_ip_changes->next_header == NULL)
-	{
-		rohc_error(context->decompressor, ROHC_TRACE_DECOMP, context->profile->id,
-		           "cannot allocate memory for the ESP-specific part of the "
-		           "inner IP header changes");
-		goto free_outer_ip_changes_next_header;
-	}
-	memset(rfc3095_ctxt->inner_ip_changes->next_header, 0, sizeof(struct esphdr));
-
 	/* set next header to ESP */
 	rfc3095_ctxt->next_header_proto = ROHC_IPPROTO_ESP;
 
 	return true;
 
-free_outer_ip_changes_next_header:
-	zfree(rfc3095_ctxt->outer_ip_changes->next_header);
-free_lsb_sn:
-	rohc_lsb_free(rfc3095_ctxt->sn_lsb_ctxt);
-free_esp_context:
-	zfree(esp_context);
-destroy_context:
-	rohc_decomp_rfc3095_destroy(rfc3095_ctxt, volat_ctxt);
 quit:
 	return false;
 }
@@ -215,23 +173,16 @@ quit:
  * This function is one of the functions that must exist in one profile for the
  * framework to work.
  *
+ * @param context       The decompression context
  * @param rfc3095_ctxt  The persistent decompression context for the RFC3095 profiles
  * @param volat_ctxt    The volatile decompression context
  */
-static void d_esp_destroy(struct rohc_decomp_rfc3095_ctxt *const rfc3095_ctxt,
+static void d_esp_destroy(const struct rohc_decomp_ctxt *const context,
+                          struct rohc_decomp_rfc3095_ctxt *const rfc3095_ctxt,
                           const struct rohc_decomp_volat_ctxt *const volat_ctxt)
 {
-	/* clean ESP-specific memory */
-	assert(rfc3095_ctxt->outer_ip_changes != NULL);
-	zfree(rfc3095_ctxt->outer_ip_changes->next_header);
-	assert(rfc3095_ctxt->inner_ip_changes != NULL);
-	zfree(rfc3095_ctxt->inner_ip_changes->next_header);
-
-	/* destroy the LSB decoding context for SN */
-	rohc_lsb_free(rfc3095_ctxt->sn_lsb_ctxt);
-
 	/* destroy the resources of the generic context */
-	rohc_decomp_rfc3095_destroy(rfc3095_ctxt, volat_ctxt);
+	rohc_decomp_rfc3095_destroy(context, rfc3095_ctxt, volat_ctxt);
 }
 
 
@@ -441,6 +392,10 @@ const struct rohc_decomp_profile d_esp_profile =
 {
 	.id              = ROHC_PROFILE_ESP, /* profile ID (RFC 3095, §8) */
 	.msn_max_bits    = 32,
+	.ctxt_block_len  = ROHC_DECOMP_RFC3095_BLOCK_LEN(sizeof(struct d_esp_context),
+	                                                 sizeof(struct esphdr)),
+	.extr_bits_len   = sizeof(struct rohc_extr_bits),
+	.decoded_len     = sizeof(struct rohc_decoded_values),
 	.new_context     = (rohc_decomp_new_context_t) d_esp_create,
 	.free_context    = (rohc_decomp_free_context_t) d_esp_destroy,
 	.detect_pkt_type = ip_detect_packet_type,
@@ -449,6 +404,7 @@ const struct rohc_decomp_profile d_esp_profile =
 	.build_hdrs      = (rohc_decomp_build_hdrs_t) rfc3095_decomp_build_hdrs,
 	.update_ctxt     = (rohc_decomp_update_ctxt_t) rfc3095_decomp_update_ctxt,
 	.attempt_repair  = (rohc_decomp_attempt_repair_t) rfc3095_decomp_attempt_repair,
+	.attempt_late    = (rohc_decomp_attempt_late_t) rfc3095_decomp_attempt_late,
 	.get_sn          = rohc_decomp_rfc3095_get_sn,
 };
 
@@ -45,9 +45,10 @@ static bool d_ip_create(const struct rohc_decomp_ctxt *const context,
                         struct rohc_decomp_volat_ctxt *const volat_ctxt)
 	__attribute__((warn_unused_result, nonnull(1, 2, 3)));
 
-static void d_ip_destroy(struct rohc_decomp_rfc3095_ctxt *const rfc3095_ctxt,
+static void d_ip_destroy(const struct rohc_decomp_ctxt *const context,
+                         struct rohc_decomp_rfc3095_ctxt *const rfc3095_ctxt,
                          const struct rohc_decomp_volat_ctxt *const volat_ctxt)
-	__attribute__((nonnull(1, 2)));
+	__attribute__((nonnull(1, 2, 3)));
 
 
 /**
@@ -74,8 +75,11 @@ static bool d_ip_create(const struct rohc_decomp_ctxt *const context,
 
 	/* create the generic context */
 	if(!rohc_decomp_rfc3095_create(context, persist_ctxt, volat_ctxt,
+	                               0, 0,
 	                               context->decompressor->trace_callback,
 	                               context->decompressor->trace_callback_priv,
+	                               context->decompressor->trace_level,
+	                               context->decompressor->trace_pkt_level,
 	                               context->profile->id))
 	{
 		rohc_error(context->decompressor, ROHC_TRACE_DECOMP, context->profile->id,
@@ -83,17 +87,10 @@ static bool d_ip_create(const struct rohc_decomp_ctxt *const context,
 		goto quit;
 	}
 	rfc3095_ctxt = *persist_ctxt;
-	rfc3095_ctxt->specific = NULL;
 
-	/* create the LSB decoding context for SN */
+	/* init the LSB decoding context for SN */
 	rfc3095_ctxt->sn_lsb_p = ROHC_LSB_SHIFT_SN;
-	rfc3095_ctxt->sn_lsb_ctxt = rohc_lsb_new(16);
-	if(rfc3095_ctxt->sn_lsb_ctxt == NULL)
-	{
-		rohc_error(context->decompressor, ROHC_TRACE_DECOMP, context->profile->id,
-		           "failed to create the LSB decoding context for SN");
-		goto free_context;
-	}
+	rohc_lsb_init(&rfc3095_ctxt->sn_lsb_ctxt, 16);
 
 	/* some IP-specific values and functions */
 	rfc3095_ctxt->parse_dyn_next_hdr = ip_parse_dynamic_ip;
@@ -101,8 +98,6 @@ static bool d_ip_create(const struct rohc_decomp_ctxt *const context,
 
 	return true;
 
-free_context:
-	zfree(rfc3095_ctxt);
 quit:
 	return false;
 }
@@ -114,14 +109,15 @@ quit:
  * This function is one of the functions that must exist in one profile for the
  * framework to work.
  *
+ * @param context       The decompression context
  * @param rfc3095_ctxt  The persistent decompression context for the RFC3095 profiles
  * @param volat_ctxt    The volatile decompression context
  */
-static void d_ip_destroy(struct rohc_decomp_rfc3095_ctxt *const rfc3095_ctxt,
+static void d_ip_destroy(const struct rohc_decomp_ctxt *const context,
+                         struct rohc_decomp_rfc3095_ctxt *const rfc3095_ctxt,
                          const struct rohc_decomp_volat_ctxt *const volat_ctxt)
 {
-	rohc_lsb_free(rfc3095_ctxt->sn_lsb_ctxt);
-	rohc_decomp_rfc3095_destroy(rfc3095_ctxt, volat_ctxt);
+	rohc_decomp_rfc3095_destroy(context, rfc3095_ctxt, volat_ctxt);
 }
 
 
@@ -148,37 +144,12 @@ rohc_packet_t ip_detect_packet_type(const struct rohc_decomp_ctxt *const context
 		goto error;
 	}
 
-	if(rohc_decomp_packet_is_uo0(rohc_packet, rohc_length))
-	{
-		/* UO-0 packet */
-		type = ROHC_PACKET_UO_0;
-	}
-	else if(rohc_decomp_packet_is_uo1(rohc_packet, rohc_length))
-	{
-		/* UO-1 packet */
-		type = ROHC_PACKET_UO_1;
-	}
-	else if(rohc_decomp_packet_is_uor2(rohc_packet, rohc_length))
-	{
-		/* UOR-2 packet */
-		type = ROHC_PACKET_UOR_2;
-	}
-	else if(rohc_decomp_packet_is_irdyn(rohc_packet, rohc_length))
-	{
-		/* IR-DYN packet */
-		type = ROHC_PACKET_IR_DYN;
-	}
-	else if(rohc_decomp_packet_is_ir(rohc_packet, rohc_length))
-	{
-		/* IR packet */
-		type = ROHC_PACKET_IR;
-	}
-	else
+	/* IR, IR-DYN, UO-0, UO-1, or UOR-2 packet */
+	type = rohc_decomp_rfc3095_pkt_type(rohc_packet[0]);
+	if(type == ROHC_PACKET_UNKNOWN)
 	{
-		/* unknown packet */
 		rohc_decomp_warn(context, "failed to recognize the packet type in byte "
 		                 "0x%02x", rohc_packet[0]);
-		type = ROHC_PACKET_UNKNOWN;
 	}
 
 	return type;
@@ -779,6 +750,9 @@ const struct rohc_decomp_profile d_ip_profile =
 {
 	.id              = ROHC_PROFILE_IP, /* profile ID (see 5 in RFC 3843) */
 	.msn_max_bits    = 16,
+	.ctxt_block_len  = ROHC_DECOMP_RFC3095_BLOCK_LEN(0, 0),
+	.extr_bits_len   = sizeof(struct rohc_extr_bits),
+	.decoded_len     = sizeof(struct rohc_decoded_values),
 	.new_context     = (rohc_decomp_new_context_t) d_ip_create,
 	.free_context    = (rohc_decomp_free_context_t) d_ip_destroy,
 	.detect_pkt_type = ip_detect_packet_type,
@@ -787,6 +761,7 @@ const struct rohc_decomp_profile d_ip_profile =
 	.build_hdrs      = (rohc_decomp_build_hdrs_t) rfc3095_decomp_build_hdrs,
 	.update_ctxt     = (rohc_decomp_update_ctxt_t) rfc3095_decomp_update_ctxt,
 	.attempt_repair  = (rohc_decomp_attempt_repair_t) rfc3095_decomp_attempt_repair,
+	.attempt_late    = (rohc_decomp_attempt_late_t) rfc3095_decomp_attempt_late,
 	.get_sn          = rohc_decomp_rfc3095_get_sn,
 };
 
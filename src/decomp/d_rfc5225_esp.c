@@ -0,0 +1,351 @@
+/*
+ * Copyright 2026 Didier Barvaux
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/**
+ * @file   d_rfc5225_esp.c
+ * @brief  ROHC decompression context for the ROHCv2 IP/ESP profile
+ * @author Didier Barvaux <didier@barvaux.org>
+ *
+ * The profile decompresses the IP headers as the ROHCv2 IP-only profile
+ * does, and the ESP header that follows them (RFC5225 §6.8.2.7). The MSN
+ * is the 16 least significant bits of the ESP Sequence Number.
+ */
+
+#include "rohc_decomp_rfc5225.h"
+#include "rohc_traces_internal.h"
+#include "rohc_utils.h"
+#include "protocols/ip_numbers.h"
+#include "protocols/esp.h"
+
+#ifndef __KERNEL__
+#  include <string.h>
+#endif
+
+
+
+
+/*
+ * Private structures and types
+ */
+
+/**
+ * @brief The ESP part of the ROHCv2 IP/ESP decompression context
+ *
+ * This object must be used with the generic part of the decompression
+ * context rohc_decomp_rfc5225_ctxt.
+ *
+ * @see rohc_decomp_rfc5225_ctxt
+ */
+struct d_rfc5225_esp_ctxt
+{
+	uint32_t spi;  /**< The ESP SPI (network byte order) */
+	uint32_t sn;   /**< The last ESP Sequence Number (host byte order) */
+};
+
+
+/*
+ * Private function prototypes.
+ */
+
+static bool d_rfc5225_esp_create(const struct rohc_decomp_ctxt *const context,
+                                 struct rohc_decomp_rfc5225_ctxt **const persist_ctxt,
+                                 struct rohc_decomp_volat_ctxt *const volat_ctxt)
+	__attribute__((warn_unused_result, nonnull(1, 2, 3)));
+
+static int d_rfc5225_esp_parse_static(const struct rohc_decomp_ctxt *const context,
+                                      const uint8_t *const rohc_data,
+                                      const size_t rohc_len,
+                                      struct rohc_rfc5225_extr_bits *const bits)
+	__attribute__((warn_unused_result, nonnull(1, 2, 4)));
+
+static int d_rfc5225_esp_parse_dyn(const struct rohc_decomp_ctxt *const context,
+                                   const uint8_t *const rohc_data,
+                                   const size_t rohc_len,
+                                   struct rohc_rfc5225_extr_bits *const bits)
+	__attribute__((warn_unused_result, nonnull(1, 2, 4)));
+
+static int d_rfc5225_esp_parse_irreg(const struct rohc_decomp_ctxt *const context,
+                                     const uint8_t *const rohc_data,
+                                     const size_t rohc_len,
+                                     struct rohc_rfc5225_extr_bits *const bits)
+	__attribute__((warn_unused_result, nonnull(1, 2, 4), const));
+
+static bool d_rfc5225_esp_decode(const struct rohc_decomp_ctxt *const context,
+                                 const struct rohc_rfc5225_extr_bits *const bits,
+                                 struct rohc_rfc5225_decoded *const decoded)
+	__attribute__((warn_unused_result, nonnull(1, 2, 3)));
+
+static void d_rfc5225_esp_build(const struct rohc_decomp_ctxt *const context,
+                                const struct rohc_rfc5225_decoded *const decoded,
+                                const size_t payload_len,
+                                uint8_t *const dest)
+	__attribute__((nonnull(1, 2, 4)));
+
+static void d_rfc5225_esp_update_ctxt(struct rohc_decomp_ctxt *const context,
+                                      const struct rohc_rfc5225_decoded *const decoded)
+	__attribute__((nonnull(1, 2)));
+
+
+/*
+ * Definitions of functions
+ */
+
+/**
+ * @brief Create the ROHCv2 IP/ESP decompression context
+ *
+ * This function is one of the functions that must exist in one profile for
+ * the framework to work.
+ *
+ * @param context            The decompression context
+ * @param[out] persist_ctxt  The persistent part of the decompression context
+ * @param[out] volat_ctxt    The volatile part of the decompression context
+ * @return                   true if the ROHCv2 IP/ESP context was
+ *                           successfully created, false if a problem occurred
+ */
+static bool d_rfc5225_esp_create(const struct rohc_decomp_ctxt *const context,
+                                 struct rohc_decomp_rfc5225_ctxt **const persist_ctxt,
+                                 struct rohc_decomp_volat_ctxt *const volat_ctxt)
+{
+	struct rohc_decomp_rfc5225_ctxt *rfc5225_ctxt;
+	struct d_rfc5225_esp_ctxt *esp_ctxt;
+
+	if(!rohc_decomp_rfc5225_create(context, persist_ctxt, volat_ctxt,
+	                               sizeof(struct d_rfc5225_esp_ctxt)))
+	{
+		goto error;
+	}
+	rfc5225_ctxt = *persist_ctxt;
+	esp_ctxt = rfc5225_ctxt->specific;
+
+	/* the SPI and the SN will be initialized with the IR packets */
+	esp_ctxt->spi = 0;
+	esp_ctxt->sn = 0;
+
+	rfc5225_ctxt->next_header_len = sizeof(struct esphdr);
+	rfc5225_ctxt->parse_static_next_hdr = d_rfc5225_esp_parse_static;
+	rfc5225_ctxt->parse_dyn_next_hdr = d_rfc5225_esp_parse_dyn;
+	rfc5225_ctxt->parse_irreg_next_hdr = d_rfc5225_esp_parse_irreg;
+	rfc5225_ctxt->decode_next_hdr = d_rfc5225_esp_decode;
+	rfc5225_ctxt->build_next_hdr = d_rfc5225_esp_build;
+	rfc5225_ctxt->update_next_hdr = d_rfc5225_esp_update_ctxt;
+
+	return true;
+
+error:
+	return false;
+}
+
+
+/**
+ * @brief Parse the static part of the ESP header (RFC5225 §6.8.2.7)
+ *
+ * @param context    The decompression context
+ * @param rohc_data  The remaining ROHC data
+ * @param rohc_len   The length of the remaining ROHC data
+ * @param[out] bits  The bits extracted from the ROHC packet
+ * @return           The length of the static part in case of success,
+ *                   -1 in case of failure
+ */
+static int d_rfc5225_esp_parse_static(const struct rohc_decomp_ctxt *const context,
+                                      const uint8_t *const rohc_data,
+                                      const size_t rohc_len,
+                                      struct rohc_rfc5225_extr_bits *const bits)
+{
+	if(bits->ip[bits->ip_nr - 1].vals.next_proto != ROHC_IPPROTO_ESP)
+	{
+		rohc_decomp_warn(context, "the innermost IP header is not followed by "
+		                 "an ESP header but by protocol %u",
+		                 bits->ip[bits->ip_nr - 1].vals.next_proto);
+		goto error;
+	}
+	if(rohc_len < 4)
+	{
+		rohc_decomp_warn(context, "malformed ROHC packet: too short for the "
+		                 "ESP static part");
+		goto error;
+	}
+	memcpy(&bits->esp_spi, rohc_data, sizeof(uint32_t));
+	rohc_decomp_debug(context, "ESP SPI = 0x%08x", rohc_ntoh32(bits->esp_spi));
+
+	return 4;
+
+error:
+	return -1;
+}
+
+
+/**
+ * @brief Parse the dynamic part of the ESP header (RFC5225 §6.8.2.7)
+ *
+ * The dynamic part carries the full ESP Sequence Number and the reordering
+ * ratio. The MSN is the 16 LSB of the ESP Sequence Number.
+ *
+ * @param context    The decompression context
+ * @param rohc_data  The remaining ROHC data
+ * @param rohc_len   The length of the remaining ROHC data
+ * @param[out] bits  The bits extracted from the ROHC packet
+ * @return           The length of the dynamic part in case of success,
+ *                   -1 in case of failure
+ */
+static int d_rfc5225_esp_parse_dyn(const struct rohc_decomp_ctxt *const context,
+                                   const uint8_t *const rohc_data,
+                                   const size_t rohc_len,
+                                   struct rohc_rfc5225_extr_bits *const bits)
+{
+	uint32_t sn;
+
+	if(rohc_len < 5)
+	{
+		rohc_decomp_warn(context, "malformed ROHC packet: too short for the "
+		                 "ESP dynamic part");
+		goto error;
+	}
+	memcpy(&sn, rohc_data, sizeof(uint32_t));
+	bits->esp_sn = rohc_ntoh32(sn);
+	bits->msn = bits->esp_sn & 0xffff;
+	bits->msn_nr = 16;
+	bits->reorder_ratio = rohc_data[4] & 0x03;
+	bits->reorder_present = true;
+	rohc_decomp_debug(context, "ESP SN = 0x%08x, reorder_ratio = %u",
+	                  bits->esp_sn, bits->reorder_ratio);
+
+	return 5;
+
+error:
+	return -1;
+}
+
+
+/**
+ * @brief Parse the irregular part of the ESP header (RFC5225 §6.8.2.7)
+ *
+ * The ESP header has no irregular part.
+ *
+ * @param context    The decompression context
+ * @param rohc_data  The remaining ROHC data
+ * @param rohc_len   The length of the remaining ROHC data
+ * @param[out] bits  The bits extracted from the ROHC packet
+ * @return           The length of the irregular part, always 0
+ */
+static int d_rfc5225_esp_parse_irreg(const struct rohc_decomp_ctxt *const context __attribute__((unused)),
+                                     const uint8_t *const rohc_data __attribute__((unused)),
+                                     const size_t rohc_len __attribute__((unused)),
+                                     struct rohc_rfc5225_extr_bits *const bits __attribute__((unused)))
+{
+	return 0;
+}
+
+
+/**
+ * @brief Decode the fields of the ESP header
+ *
+ * In CO packets, the ESP Sequence Number is deduced from the decoded MSN
+ * and from the ESP Sequence Number of the context.
+ *
+ * @param context       The decompression context
+ * @param bits          The bits extracted from the ROHC packet
+ * @param[out] decoded  The decoded values
+ * @return              true if decoding is successful, false otherwise
+ */
+static bool d_rfc5225_esp_decode(const struct rohc_decomp_ctxt *const context,
+                                 const struct rohc_rfc5225_extr_bits *const bits,
+                                 struct rohc_rfc5225_decoded *const decoded)
+{
+	const struct rohc_decomp_rfc5225_ctxt *const rfc5225_ctxt =
+		context->persist_ctxt;
+	const struct d_rfc5225_esp_ctxt *const esp_ctxt = rfc5225_ctxt->specific;
+
+	if(bits->is_ir)
+	{
+		decoded->esp_spi = bits->esp_spi;
+		decoded->esp_sn = bits->esp_sn;
+	}
+	else
+	{
+		const int16_t sn_delta =
+			(int16_t) (uint16_t) (decoded->msn - (esp_ctxt->sn & 0xffff));
+
+		decoded->esp_spi = esp_ctxt->spi;
+		decoded->esp_sn = esp_ctxt->sn + sn_delta;
+	}
+	rohc_decomp_debug(context, "decoded ESP SN = 0x%08x", decoded->esp_sn);
+
+	return true;
+}
+
+
+/**
+ * @brief Build the uncompressed ESP header
+ *
+ * @param context      The decompression context
+ * @param decoded      The decoded values
+ * @param payload_len  The length of the ESP payload
+ * @param dest         OUT: The ESP header
+ */
+static void d_rfc5225_esp_build(const struct rohc_decomp_ctxt *const context __attribute__((unused)),
+                                const struct rohc_rfc5225_decoded *const decoded,
+                                const size_t payload_len __attribute__((unused)),
+                                uint8_t *const dest)
+{
+	struct esphdr *const esp = (struct esphdr *) dest;
+
+	esp->spi = decoded->esp_spi;
+	esp->sn = rohc_hton32(decoded->esp_sn);
+}
+
+
+/**
+ * @brief Update the decompression context with the ESP header
+ *
+ * @param context  The decompression context
+ * @param decoded  The decoded values to update in the context
+ */
+static void d_rfc5225_esp_update_ctxt(struct rohc_decomp_ctxt *const context,
+                                      const struct rohc_rfc5225_decoded *const decoded)
+{
+	struct rohc_decomp_rfc5225_ctxt *const rfc5225_ctxt = context->persist_ctxt;
+	struct d_rfc5225_esp_ctxt *const esp_ctxt = rfc5225_ctxt->specific;
+
+	esp_ctxt->spi = decoded->esp_spi;
+	esp_ctxt->sn = decoded->esp_sn;
+}
+
+
+/**
+ * @brief Define the decompression part of the ROHCv2 IP/ESP profile as
+ *        described in the RFC 5225
+ */
+const struct rohc_decomp_profile d_rfc5225_esp_profile =
+{
+	.id              = ROHCv2_PROFILE_IP_ESP, /* profile ID (see 5 in RFC5225) */
+	.msn_max_bits    = 16,
+	.ctxt_block_len  = ROHC_DECOMP_RFC5225_BLOCK_LEN(sizeof(struct d_rfc5225_esp_ctxt)),
+	.extr_bits_len   = sizeof(struct rohc_rfc5225_extr_bits),
+	.decoded_len     = sizeof(struct rohc_rfc5225_decoded),
+	.new_context     = (rohc_decomp_new_context_t) d_rfc5225_esp_create,
+	.free_context    = (rohc_decomp_free_context_t) rohc_decomp_rfc5225_destroy,
+	.detect_pkt_type = rohc_decomp_rfc5225_detect_pkt_type,
+	.parse_pkt       = (rohc_decomp_parse_pkt_t) rohc_decomp_rfc5225_parse_pkt,
+	.decode_bits     = (rohc_decomp_decode_bits_t) rohc_decomp_rfc5225_decode_bits,
+	.build_hdrs      = (rohc_decomp_build_hdrs_t) rohc_decomp_rfc5225_build_hdrs,
+	.update_ctxt     = (rohc_decomp_update_ctxt_t) rohc_decomp_rfc5225_update_ctxt,
+	.attempt_repair  = (rohc_decomp_attempt_repair_t) rohc_decomp_rfc5225_attempt_repair,
+	.attempt_late    = (rohc_decomp_attempt_late_t) rohc_decomp_rfc5225_attempt_late,
+	.get_sn          = rohc_decomp_rfc5225_get_msn
+};
+
@@ -0,0 +1,89 @@
+/*
+ * Copyright 2016 Didier Barvaux
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/**
+ * @file   d_rfc5225_ip_only.c
+ * @brief  ROHC decompression context for the ROHCv2 IP-only profile
+ * @author Didier Barvaux <didier@barvaux.org>
+ *
+ * The profile decompresses up to \ref ROHC_RFC5225_MAX_IP_HDRS IPv4 or IPv6
+ * headers without IP options nor IPv6 extension headers (RFC5225 §6.8.2.4).
+ */
+
+#include "rohc_decomp_rfc5225.h"
+
+
+/*
+ * Private function prototypes.
+ */
+
+static bool d_rfc5225_ip_only_create(const struct rohc_decomp_ctxt *const context,
+                                     struct rohc_decomp_rfc5225_ctxt **const persist_ctxt,
+                                     struct rohc_decomp_volat_ctxt *const volat_ctxt)
+	__attribute__((warn_unused_result, nonnull(1, 2, 3)));
+
+
+/*
+ * Definitions of functions
+ */
+
+/**
+ * @brief Create the ROHCv2 IP-only decompression context
+ *
+ * This function is one of the functions that must exist in one profile for
+ * the framework to work.
+ *
+ * @param context            The decompression context
+ * @param[out] persist_ctxt  The persistent part of the decompression context
+ * @param[out] volat_ctxt    The volatile part of the decompression context
+ * @return                   true if the ROHCv2 IP-only context was
+ *                           successfully created, false if a problem occurred
+ */
+static bool d_rfc5225_ip_only_create(const struct rohc_decomp_ctxt *const context,
+                                     struct rohc_decomp_rfc5225_ctxt **const persist_ctxt,
+                                     struct rohc_decomp_volat_ctxt *const volat_ctxt)
+{
+	/* the IP-only profile has no specific part: the generic ROHCv2 context
+	 * handles all the IP headers */
+	return rohc_decomp_rfc5225_create(context, persist_ctxt, volat_ctxt, 0);
+}
+
+
+/**
+ * @brief Define the decompression part of the ROHCv2 IP-only profile as
+ *        described in the RFC 5225
+ */
+const struct rohc_decomp_profile d_rfc5225_ip_only_profile =
+{
+	.id              = ROHCv2_PROFILE_IP, /* profile ID (see 5 in RFC5225) */
+	.msn_max_bits    = 16,
+	.ctxt_block_len  = ROHC_DECOMP_RFC5225_BLOCK_LEN(0),
+	.extr_bits_len   = sizeof(struct rohc_rfc5225_extr_bits),
+	.decoded_len     = sizeof(struct rohc_rfc5225_decoded),
+	.new_context     = (rohc_decomp_new_context_t) d_rfc5225_ip_only_create,
+	.free_context    = (rohc_decomp_free_context_t) rohc_decomp_rfc5225_destroy,
+	.detect_pkt_type = rohc_decomp_rfc5225_detect_pkt_type,
+	.parse_pkt       = (rohc_decomp_parse_pkt_t) rohc_decomp_rfc5225_parse_pkt,
+	.decode_bits     = (rohc_decomp_decode_bits_t) rohc_decomp_rfc5225_decode_bits,
+	.build_hdrs      = (rohc_decomp_build_hdrs_t) rohc_decomp_rfc5225_build_hdrs,
+	.update_ctxt     = (rohc_decomp_update_ctxt_t) rohc_decomp_rfc5225_update_ctxt,
+	.attempt_repair  = (rohc_decomp_attempt_repair_t) rohc_decomp_rfc5225_attempt_repair,
+	.attempt_late    = (rohc_decomp_attempt_late_t) rohc_decomp_rfc5225_attempt_late,
+	.get_sn          = rohc_decomp_rfc5225_get_msn
+};
+
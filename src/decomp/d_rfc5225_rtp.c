@@ -0,0 +1,900 @@
+/*
+ * Copyright 2026 Didier Barvaux
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/**
+ * @file   d_rfc5225_rtp.c
+ * @brief  ROHC decompression context for the ROHCv2 IP/UDP/RTP profile
+ * @author Didier Barvaux <didier@barvaux.org>
+ *
+ * The profile decompresses the IP headers as the ROHCv2 IP-only profile
+ * does, and the UDP and RTP headers that follow them. The RTP Sequence
+ * Number is the MSN. The scaled RTP Timestamp is either deduced from the
+ * MSN or decoded from its LSB, then multiplied by the TS stride and shifted
+ * by the TS offset.
+ */
+
+#include "rohc_decomp_rfc5225.h"
+#include "rohc_bit_ops.h"
+#include "rohc_traces_internal.h"
+#include "rohc_utils.h"
+#include "protocols/ip_numbers.h"
+#include "protocols/udp.h"
+#include "protocols/rtp.h"
+
+#ifndef __KERNEL__
+#  include <string.h>
+#endif
+
+
+/*
+ * Private structures and types
+ */
+
+/**
+ * @brief The UDP/RTP part of the ROHCv2 IP/UDP/RTP decompression context
+ *
+ * This object must be used with the generic part of the decompression
+ * context rohc_decomp_rfc5225_ctxt.
+ *
+ * @see rohc_decomp_rfc5225_ctxt
+ */
+struct d_rfc5225_rtp_ctxt
+{
+	uint16_t sport;         /**< The UDP source port (network byte order) */
+	uint16_t dport;         /**< The UDP destination port (network byte order) */
+	bool is_checksum_used;  /**< Whether the UDP checksum is non-zero */
+
+	uint32_t ssrc;          /**< The RTP SSRC (network byte order) */
+	uint8_t pt;             /**< The RTP Payload Type */
+	uint8_t padding;        /**< The RTP Padding bit */
+	uint8_t extension;      /**< The RTP Extension bit */
+	uint32_t ts;            /**< The RTP Timestamp of the last packet */
+
+	uint32_t ts_stride;     /**< The stride of the RTP Timestamp, 0 if none */
+	uint32_t ts_offset;     /**< The offset of the TS, ie. TS modulo the stride */
+	/** The LSB decoding context of the scaled TS */
+	struct rohc_lsb_ref32 ts_scaled_lsb_ctxt;
+	/** The offset of the scaled TS from the MSN */
+	uint32_t ts_scaled_offset;
+};
+
+
+/*
+ * Private function prototypes.
+ */
+
+static bool d_rfc5225_rtp_create(const struct rohc_decomp_ctxt *const context,
+                                 struct rohc_decomp_rfc5225_ctxt **const persist_ctxt,
+                                 struct rohc_decomp_volat_ctxt *const volat_ctxt)
+	__attribute__((warn_unused_result, nonnull(1, 2, 3)));
+
+static rohc_packet_t d_rfc5225_rtp_detect_pkt_type(const struct rohc_decomp_ctxt *const context,
+                                                   const uint8_t *const rohc_packet,
+                                                   const size_t rohc_length,
+                                                   const size_t large_cid_len)
+	__attribute__((warn_unused_result, nonnull(1, 2)));
+
+static int d_rfc5225_rtp_parse_static(const struct rohc_decomp_ctxt *const context,
+                                      const uint8_t *const rohc_data,
+                                      const size_t rohc_len,
+                                      struct rohc_rfc5225_extr_bits *const bits)
+	__attribute__((warn_unused_result, nonnull(1, 2, 4)));
+
+static int d_rfc5225_rtp_parse_dyn(const struct rohc_decomp_ctxt *const context,
+                                   const uint8_t *const rohc_data,
+                                   const size_t rohc_len,
+                                   struct rohc_rfc5225_extr_bits *const bits)
+	__attribute__((warn_unused_result, nonnull(1, 2, 4)));
+
+static int d_rfc5225_rtp_parse_co_base(const struct rohc_decomp_ctxt *const context,
+                                       const uint8_t *const hdr,
+                                       const size_t hdr_len,
+                                       const rohc_packet_t packet_type,
+                                       struct rohc_decomp_crc *const extr_crc,
+                                       struct rohc_rfc5225_extr_bits *const bits,
+                                       bool *const outer_ip_indicator)
+	__attribute__((warn_unused_result, nonnull(1, 2, 5, 6, 7)));
+
+static int d_rfc5225_rtp_parse_co_common_rtp(const struct rohc_decomp_ctxt *const context,
+                                             const uint8_t *const rohc_data,
+                                             const size_t rohc_len,
+                                             struct rohc_rfc5225_extr_bits *const bits)
+	__attribute__((warn_unused_result, nonnull(1, 2, 4)));
+
+static int d_rfc5225_rtp_parse_irreg(const struct rohc_decomp_ctxt *const context,
+                                     const uint8_t *const rohc_data,
+                                     const size_t rohc_len,
+                                     struct rohc_rfc5225_extr_bits *const bits)
+	__attribute__((warn_unused_result, nonnull(1, 2, 4)));
+
+static bool d_rfc5225_rtp_decode(const struct rohc_decomp_ctxt *const context,
+                                 const struct rohc_rfc5225_extr_bits *const bits,
+                                 struct rohc_rfc5225_decoded *const decoded)
+	__attribute__((warn_unused_result, nonnull(1, 2, 3)));
+
+static bool d_rfc5225_rtp_decode_ts(const struct rohc_decomp_ctxt *const context,
+                                    const struct rohc_rfc5225_extr_bits *const bits,
+                                    struct rohc_rfc5225_decoded *const decoded)
+	__attribute__((warn_unused_result, nonnull(1, 2, 3)));
+
+static void d_rfc5225_rtp_build(const struct rohc_decomp_ctxt *const context,
+                                const struct rohc_rfc5225_decoded *const decoded,
+                                const size_t payload_len,
+                                uint8_t *const dest)
+	__attribute__((nonnull(1, 2, 4)));
+
+static void d_rfc5225_rtp_update_ctxt(struct rohc_decomp_ctxt *const context,
+                                      const struct rohc_rfc5225_decoded *const decoded)
+	__attribute__((nonnull(1, 2)));
+
+
+/*
+ * Definitions of functions
+ */
+
+/**
+ * @brief Create the ROHCv2 IP/UDP/RTP decompression context
+ *
+ * This function is one of the functions that must exist in one profile for
+ * the framework to work.
+ *
+ * @param context            The decompression context
+ * @param[out] persist_ctxt  The persistent part of the decompression context
+ * @param[out] volat_ctxt    The volatile part of the decompression context
+ * @return                   true if the ROHCv2 IP/UDP/RTP context was
+ *                           successfully created, false if a problem occurred
+ */
+static bool d_rfc5225_rtp_create(const struct rohc_decomp_ctxt *const context,
+                                 struct rohc_decomp_rfc5225_ctxt **const persist_ctxt,
+                                 struct rohc_decomp_volat_ctxt *const volat_ctxt)
+{
+	struct rohc_decomp_rfc5225_ctxt *rfc5225_ctxt;
+	struct d_rfc5225_rtp_ctxt *rtp_ctxt;
+
+	if(!rohc_decomp_rfc5225_create(context, persist_ctxt, volat_ctxt,
+	                               sizeof(struct d_rfc5225_rtp_ctxt)))
+	{
+		goto error;
+	}
+	rfc5225_ctxt = *persist_ctxt;
+	rtp_ctxt = rfc5225_ctxt->specific;
+
+	/* the UDP and RTP fields will be initialized with the IR packets */
+	memset(rtp_ctxt, 0, sizeof(struct d_rfc5225_rtp_ctxt));
+	rohc_lsb_ref32_init(&rtp_ctxt->ts_scaled_lsb_ctxt);
+
+	rfc5225_ctxt->next_header_len = sizeof(struct udphdr) + sizeof(struct rtphdr);
+	rfc5225_ctxt->parse_static_next_hdr = d_rfc5225_rtp_parse_static;
+	rfc5225_ctxt->parse_dyn_next_hdr = d_rfc5225_rtp_parse_dyn;
+	rfc5225_ctxt->parse_co_base = d_rfc5225_rtp_parse_co_base;
+	rfc5225_ctxt->parse_irreg_next_hdr = d_rfc5225_rtp_parse_irreg;
+	rfc5225_ctxt->decode_next_hdr = d_rfc5225_rtp_decode;
+	rfc5225_ctxt->build_next_hdr = d_rfc5225_rtp_build;
+	rfc5225_ctxt->update_next_hdr = d_rfc5225_rtp_update_ctxt;
+
+	return true;
+
+error:
+	return false;
+}
+
+
+/**
+ * @brief Detect the type of ROHC packet for the ROHCv2 IP/UDP/RTP profile
+ *
+ * @param context        The decompression context
+ * @param rohc_packet    The ROHC packet
+ * @param rohc_length    The length of the ROHC packet
+ * @param large_cid_len  The length of the optional large CID field
+ * @return               The packet type
+ */
+static rohc_packet_t d_rfc5225_rtp_detect_pkt_type(const struct rohc_decomp_ctxt *const context,
+                                                   const uint8_t *const rohc_packet,
+                                                   const size_t rohc_length,
+                                                   const size_t large_cid_len __attribute__((unused)))
+{
+	rohc_packet_t type;
+
+	if(rohc_length < 1)
+	{
+		rohc_decomp_warn(context, "ROHC packet too small to read the packet "
+		                 "type (len = %zu)", rohc_length);
+		goto error;
+	}
+
+	rohc_decomp_debug(context, "try to determine the header from first byte "
+	                  "0x%02x", rohc_packet[0]);
+
+	if(rohc_packet[0] == ROHC_RFC5225_IR_DISC)
+	{
+		type = ROHC_PACKET_IR;
+	}
+	else if(context->num_recv_packets == 0)
+	{
+		rohc_decomp_warn(context, "non IR packet received without initialized "
+		                 "context: cannot determine the packet type");
+		goto error;
+	}
+	else if(rohc_packet[0] == ROHC_RFC5225_CO_COMMON_DISC)
+	{
+		type = ROHC_PACKET_CO_COMMON;
+	}
+	else if((rohc_packet[0] & ROHC_RFC5225_PT_0_CRC3_MASK) ==
+	        ROHC_RFC5225_PT_0_CRC3_DISC)
+	{
+		type = ROHC_PACKET_PT_0_CRC3;
+	}
+	else if((rohc_packet[0] & ROHC_RFC5225_RTP_4BIT_DISC_MASK) ==
+	        ROHC_RFC5225_RTP_PT_0_CRC7_DISC)
+	{
+		type = ROHC_PACKET_PT_0_CRC7;
+	}
+	else if((rohc_packet[0] & ROHC_RFC5225_RTP_4BIT_DISC_MASK) ==
+	        ROHC_RFC5225_RTP_PT_1_SEQ_ID_DISC)
+	{
+		type = ROHC_PACKET_PT_1_SEQ_ID;
+	}
+	else if((rohc_packet[0] & ROHC_RFC5225_RTP_PT_1_RND_MASK) ==
+	        ROHC_RFC5225_RTP_PT_1_RND_DISC)
+	{
+		type = ROHC_PACKET_PT_1_RND;
+	}
+	else if((rohc_packet[0] & ROHC_RFC5225_RTP_4BIT_DISC_MASK) ==
+	        ROHC_RFC5225_RTP_PT_2_RND_DISC)
+	{
+		type = ROHC_PACKET_PT_2_RND;
+	}
+	else if((rohc_packet[0] & ROHC_RFC5225_RTP_4BIT_DISC_MASK) ==
+	        ROHC_RFC5225_RTP_PT_2_SEQ_ID_DISC)
+	{
+		type = ROHC_PACKET_PT_2_SEQ_ID;
+	}
+	else
+	{
+		rohc_decomp_warn(context, "unknown packet type with first byte 0x%02x",
+		                 rohc_packet[0]);
+		goto error;
+	}
+
+	return type;
+
+error:
+	return ROHC_PACKET_UNKNOWN;
+}
+
+
+/**
+ * @brief Parse the static part of the UDP and RTP headers
+ *
+ * The static part carries the UDP ports and the RTP SSRC.
+ *
+ * @param context    The decompression context
+ * @param rohc_data  The remaining ROHC data
+ * @param rohc_len   The length of the remaining ROHC data
+ * @param[out] bits  The bits extracted from the ROHC packet
+ * @return           The length of the static part in case of success,
+ *                   -1 in case of failure
+ */
+static int d_rfc5225_rtp_parse_static(const struct rohc_decomp_ctxt *const context,
+                                      const uint8_t *const rohc_data,
+                                      const size_t rohc_len,
+                                      struct rohc_rfc5225_extr_bits *const bits)
+{
+	if(bits->ip[bits->ip_nr - 1].vals.next_proto != ROHC_IPPROTO_UDP)
+	{
+		rohc_decomp_warn(context, "the innermost IP header is not followed by "
+		                 "a UDP header but by protocol %u",
+		                 bits->ip[bits->ip_nr - 1].vals.next_proto);
+		goto error;
+	}
+	if(rohc_len < 8)
+	{
+		rohc_decomp_warn(context, "malformed ROHC packet: too short for the "
+		                 "UDP/RTP static part");
+		goto error;
+	}
+	memcpy(&bits->udp_sport, rohc_data, sizeof(uint16_t));
+	memcpy(&bits->udp_dport, rohc_data + 2, sizeof(uint16_t));
+	memcpy(&bits->rtp_ssrc, rohc_data + 4, sizeof(uint32_t));
+	rohc_decomp_debug(context, "UDP source port = %u, destination port = %u, "
+	                  "RTP SSRC = 0x%08x", rohc_ntoh16(bits->udp_sport),
+	                  rohc_ntoh16(bits->udp_dport), rohc_ntoh32(bits->rtp_ssrc));
+
+	return 8;
+
+error:
+	return -1;
+}
+
+
+/**
+ * @brief Parse the dynamic part of the UDP and RTP headers
+ *
+ * The dynamic part carries the UDP checksum, the MSN, the reordering ratio,
+ * the Marker, Padding and Extension bits, the Payload Type, the TS and the
+ * TS stride.
+ *
+ * @param context    The decompression context
+ * @param rohc_data  The remaining ROHC data
+ * @param rohc_len   The length of the remaining ROHC data
+ * @param[out] bits  The bits extracted from the ROHC packet
+ * @return           The length of the dynamic part in case of success,
+ *                   -1 in case of failure
+ */
+static int d_rfc5225_rtp_parse_dyn(const struct rohc_decomp_ctxt *const context,
+                                   const uint8_t *const rohc_data,
+                                   const size_t rohc_len,
+                                   struct rohc_rfc5225_extr_bits *const bits)
+{
+	uint32_t ts;
+	uint32_t ts_stride;
+
+	if(rohc_len < 15)
+	{
+		rohc_decomp_warn(context, "malformed ROHC packet: too short for the "
+		                 "UDP/RTP dynamic part");
+		goto error;
+	}
+	memcpy(&bits->udp_check, rohc_data, sizeof(uint16_t));
+	bits->udp_check_present = true;
+	bits->msn = (rohc_data[2] << 8) | rohc_data[3];
+	bits->msn_nr = 16;
+	bits->reorder_ratio = rohc_data[4] & 0x03;
+	bits->reorder_present = true;
+	bits->rtp_m = GET_BIT_7(rohc_data + 5) >> 7;
+	bits->rtp_p = GET_BIT_6(rohc_data + 5) >> 6;
+	bits->rtp_x = GET_BIT_5(rohc_data + 5) >> 5;
+	bits->rtp_px_present = true;
+	bits->rtp_pt = GET_BIT_0_6(rohc_data + 6);
+	bits->rtp_pt_present = true;
+	memcpy(&ts, rohc_data + 7, sizeof(uint32_t));
+	bits->rtp_ts = rohc_ntoh32(ts);
+	bits->rtp_ts_present = true;
+	memcpy(&ts_stride, rohc_data + 11, sizeof(uint32_t));
+	bits->rtp_ts_stride = rohc_ntoh32(ts_stride);
+	bits->rtp_ts_stride_present = true;
+	rohc_decomp_debug(context, "UDP checksum = 0x%04x, reorder_ratio = %u, "
+	                  "MSN = 0x%04x, RTP M = %u, P = %u, X = %u, PT = %u, "
+	                  "TS = %u, TS stride = %u", rohc_ntoh16(bits->udp_check),
+	                  bits->reorder_ratio, bits->msn, bits->rtp_m, bits->rtp_p,
+	                  bits->rtp_x, bits->rtp_pt, bits->rtp_ts, bits->rtp_ts_stride);
+
+	return 15;
+
+error:
+	return -1;
+}
+
+
+/**
+ * @brief Parse the base header of one CO packet of the IP/UDP/RTP profile
+ *
+ * @param context                  The decompression context
+ * @param hdr                      The base header without large CID
+ * @param hdr_len                  The length of the available base header
+ * @param packet_type              The type of CO packet
+ * @param[out] extr_crc            The CRC bits extracted from the header
+ * @param[out] bits                The bits extracted from the header
+ * @param[out] outer_ip_indicator  Whether the irregular chain transmits the
+ *                                 outer TOS/TC and TTL/HL
+ * @return                         The length of the base header in case of
+ *                                 success, -1 in case of failure
+ */
+static int d_rfc5225_rtp_parse_co_base(const struct rohc_decomp_ctxt *const context,
+                                       const uint8_t *const hdr,
+                                       const size_t hdr_len,
+                                       const rohc_packet_t packet_type,
+                                       struct rohc_decomp_crc *const extr_crc,
+                                       struct rohc_rfc5225_extr_bits *const bits,
+                                       bool *const outer_ip_indicator)
+{
+	size_t base_len;
+
+	*outer_ip_indicator = false;
+
+	switch(packet_type)
+	{
+		case ROHC_PACKET_PT_0_CRC3:
+			extr_crc->type = ROHC_CRC_TYPE_3;
+			extr_crc->bits = GET_BIT_0_2(hdr);
+			extr_crc->bits_nr = 3;
+			bits->msn = GET_BIT_3_6(hdr);
+			bits->msn_nr = 4;
+			base_len = 1;
+			break;
+		case ROHC_PACKET_PT_0_CRC7:
+			if(hdr_len < 2)
+			{
+				goto too_short;
+			}
+			extr_crc->type = ROHC_CRC_TYPE_7;
+			extr_crc->bits = GET_BIT_0_6(hdr + 1);
+			extr_crc->bits_nr = 7;
+			bits->msn = (GET_BIT_0_3(hdr) << 1) | (GET_BIT_7(hdr + 1) >> 7);
+			bits->msn_nr = 5;
+			base_len = 2;
+			break;
+		case ROHC_PACKET_PT_1_SEQ_ID:
+			if(hdr_len < 2)
+			{
+				goto too_short;
+			}
+			bits->ip_id_offset = GET_BIT_0_3(hdr);
+			bits->ip_id_offset_nr = 4;
+			extr_crc->type = ROHC_CRC_TYPE_3;
+			extr_crc->bits = GET_BIT_5_7(hdr + 1);
+			extr_crc->bits_nr = 3;
+			bits->msn = GET_BIT_0_4(hdr + 1);
+			bits->msn_nr = 5;
+			base_len = 2;
+			break;
+		case ROHC_PACKET_PT_1_RND:
+			if(hdr_len < 2)
+			{
+				goto too_short;
+			}
+			bits->rtp_m = GET_BIT_4(hdr) >> 4;
+			bits->msn = GET_BIT_0_3(hdr);
+			bits->msn_nr = 4;
+			bits->rtp_ts_scaled = GET_BIT_3_7(hdr + 1);
+			bits->rtp_ts_scaled_nr = 5;
+			extr_crc->type = ROHC_CRC_TYPE_3;
+			extr_crc->bits = GET_BIT_0_2(hdr + 1);
+			extr_crc->bits_nr = 3;
+			base_len = 2;
+			break;
+		case ROHC_PACKET_PT_2_RND:
+			if(hdr_len < 3)
+			{
+				goto too_short;
+			}
+			bits->msn = (GET_BIT_0_3(hdr) << 3) | GET_BIT_5_7(hdr + 1);
+			bits->msn_nr = 7;
+			bits->rtp_ts_scaled = GET_BIT_0_4(hdr + 1);
+			bits->rtp_ts_scaled_nr = 5;
+			bits->rtp_m = GET_BIT_7(hdr + 2) >> 7;
+			extr_crc->type = ROHC_CRC_TYPE_7;
+			extr_crc->bits = GET_BIT_0_6(hdr + 2);
+			extr_crc->bits_nr = 7;
+			base_len = 3;
+			break;
+		case ROHC_PACKET_PT_2_SEQ_ID:
+			if(hdr_len < 3)
+			{
+				goto too_short;
+			}
+			bits->ip_id_offset = (GET_BIT_0_3(hdr) << 1) | (GET_BIT_7(hdr + 1) >> 7);
+			bits->ip_id_offset_nr = 5;
+			extr_crc->type = ROHC_CRC_TYPE_7;
+			extr_crc->bits = GET_BIT_0_6(hdr + 1);
+			extr_crc->bits_nr = 7;
+			bits->msn = hdr[2];
+			bits->msn_nr = 8;
+			base_len = 3;
+			break;
+		case ROHC_PACKET_CO_COMMON:
+		{
+			int ret;
+
+			ret = rohc_decomp_rfc5225_parse_co_common(context, hdr, hdr_len, extr_crc,
+			                                          bits, outer_ip_indicator);
+			if(ret < 0)
+			{
+				goto error;
+			}
+			base_len = ret;
+
+			ret = d_rfc5225_rtp_parse_co_common_rtp(context, hdr + base_len,
+			                                        hdr_len - base_len, bits);
+			if(ret < 0)
+			{
+				goto error;
+			}
+			base_len += ret;
+			break;
+		}
+		default:
+			rohc_decomp_warn(context, "unexpected packet type %d", packet_type);
+			goto error;
+	}
+
+	return base_len;
+
+too_short:
+	rohc_decomp_warn(context, "malformed ROHC packet: too short for the %s "
+	                 "packet", rohc_get_packet_descr(packet_type));
+error:
+	return -1;
+}
+
+
+/**
+ * @brief Parse the RTP fields of the co_common header
+ *
+ * The first byte holds the Marker, the TS indicator, the stride and Payload
+ * Type indicators, and the Padding and Extension bits. It is followed by
+ * the TS (8 LSB of the scaled TS or the whole TS), by the TS stride and by
+ * the Payload Type if their indicators are set.
+ *
+ * @param context    The decompression context
+ * @param rohc_data  The RTP fields of the co_common header
+ * @param rohc_len   The length of the available data
+ * @param[out] bits  The bits extracted from the header
+ * @return           The length of the RTP fields in case of success,
+ *                   -1 in case of failure
+ */
+static int d_rfc5225_rtp_parse_co_common_rtp(const struct rohc_decomp_ctxt *const context,
+                                             const uint8_t *const rohc_data,
+                                             const size_t rohc_len,
+                                             struct rohc_rfc5225_extr_bits *const bits)
+{
+	rohc_rfc5225_rtp_ts_ind_t ts_ind;
+	bool stride_ind;
+	bool pt_ind;
+	size_t len = 0;
+
+	if(rohc_len < 1)
+	{
+		goto too_short;
+	}
+	bits->rtp_m = GET_BIT_7(rohc_data) >> 7;
+	ts_ind = (rohc_data[0] >> 5) & 0x03;
+	stride_ind = !!(GET_BIT_4(rohc_data) != 0);
+	pt_ind = !!(GET_BIT_3(rohc_data) != 0);
+	bits->rtp_p = GET_BIT_2(rohc_data) >> 2;
+	bits->rtp_x = GET_BIT_1(rohc_data) >> 1;
+	bits->rtp_px_present = true;
+	len++;
+
+	if(ts_ind == ROHC_RFC5225_RTP_TS_SCALED)
+	{
+		if(rohc_len < (len + 1))
+		{
+			goto too_short;
+		}
+		bits->rtp_ts_scaled = rohc_data[len];
+		bits->rtp_ts_scaled_nr = 8;
+		len++;
+	}
+	else if(ts_ind == ROHC_RFC5225_RTP_TS_FULL)
+	{
+		uint32_t ts;
+
+		if(rohc_len < (len + sizeof(uint32_t)))
+		{
+			goto too_short;
+		}
+		memcpy(&ts, rohc_data + len, sizeof(uint32_t));
+		bits->rtp_ts = rohc_ntoh32(ts);
+		bits->rtp_ts_present = true;
+		len += sizeof(uint32_t);
+	}
+	else if(ts_ind != ROHC_RFC5225_RTP_TS_DEDUCED)
+	{
+		rohc_decomp_warn(context, "malformed ROHC packet: unknown TS indicator %d",
+		                 ts_ind);
+		goto error;
+	}
+
+	if(stride_ind)
+	{
+		uint32_t ts_stride;
+
+		/* the TS offset is computed from the whole TS */
+		if(ts_ind != ROHC_RFC5225_RTP_TS_FULL)
+		{
+			rohc_decomp_warn(context, "malformed ROHC packet: TS stride without "
+			                 "the whole TS");
+			goto error;
+		}
+		if(rohc_len < (len + sizeof(uint32_t)))
+		{
+			goto too_short;
+		}
+		memcpy(&ts_stride, rohc_data + len, sizeof(uint32_t));
+		bits->rtp_ts_stride = rohc_ntoh32(ts_stride);
+		bits->rtp_ts_stride_present = true;
+		len += sizeof(uint32_t);
+	}
+
+	if(pt_ind)
+	{
+		if(rohc_len < (len + 1))
+		{
+			goto too_short;
+		}
+		bits->rtp_pt = GET_BIT_0_6(rohc_data + len);
+		bits->rtp_pt_present = true;
+		len++;
+	}
+	rohc_decomp_debug(context, "co_common: RTP M = %u, P = %u, X = %u, TS "
+	                  "indicator %d, stride %s, PT %s", bits->rtp_m, bits->rtp_p,
+	                  bits->rtp_x, ts_ind, stride_ind ? "present" : "absent",
+	                  pt_ind ? "present" : "absent");
+
+	return len;
+
+too_short:
+	rohc_decomp_warn(context, "malformed ROHC packet: too short for the RTP "
+	                 "fields of the co_common packet");
+error:
+	return -1;
+}
+
+
+/**
+ * @brief Parse the irregular part of the UDP and RTP headers
+ *
+ * The UDP checksum is transmitted if it is used.
+ *
+ * @param context    The decompression context
+ * @param rohc_data  The remaining ROHC data
+ * @param rohc_len   The length of the remaining ROHC data
+ * @param[out] bits  The bits extracted from the ROHC packet
+ * @return           The length of the irregular part in case of success,
+ *                   -1 in case of failure
+ */
+static int d_rfc5225_rtp_parse_irreg(const struct rohc_decomp_ctxt *const context,
+                                     const uint8_t *const rohc_data,
+                                     const size_t rohc_len,
+                                     struct rohc_rfc5225_extr_bits *const bits)
+{
+	const struct rohc_decomp_rfc5225_ctxt *const rfc5225_ctxt =
+		context->persist_ctxt;
+	const struct d_rfc5225_rtp_ctxt *const rtp_ctxt = rfc5225_ctxt->specific;
+
+	if(!rtp_ctxt->is_checksum_used)
+	{
+		return 0;
+	}
+	if(rohc_len < 2)
+	{
+		rohc_decomp_warn(context, "malformed ROHC packet: too short for the "
+		                 "UDP checksum");
+		return -1;
+	}
+	memcpy(&bits->udp_check, rohc_data, sizeof(uint16_t));
+	bits->udp_check_present = true;
+
+	return 2;
+}
+
+
+/**
+ * @brief Decode the fields of the UDP and RTP headers
+ *
+ * @param context       The decompression context
+ * @param bits          The bits extracted from the ROHC packet
+ * @param[out] decoded  The decoded values
+ * @return              true if decoding is successful, false otherwise
+ */
+static bool d_rfc5225_rtp_decode(const struct rohc_decomp_ctxt *const context,
+                                 const struct rohc_rfc5225_extr_bits *const bits,
+                                 struct rohc_rfc5225_decoded *const decoded)
+{
+	const struct rohc_decomp_rfc5225_ctxt *const rfc5225_ctxt =
+		context->persist_ctxt;
+	const struct d_rfc5225_rtp_ctxt *const rtp_ctxt = rfc5225_ctxt->specific;
+
+	if(bits->is_ir)
+	{
+		decoded->udp_sport = bits->udp_sport;
+		decoded->udp_dport = bits->udp_dport;
+		decoded->rtp_ssrc = bits->rtp_ssrc;
+	}
+	else
+	{
+		decoded->udp_sport = rtp_ctxt->sport;
+		decoded->udp_dport = rtp_ctxt->dport;
+		decoded->rtp_ssrc = rtp_ctxt->ssrc;
+	}
+	decoded->udp_check = (bits->udp_check_present ? bits->udp_check : 0);
+
+	decoded->rtp_pt = (bits->rtp_pt_present ? bits->rtp_pt : rtp_ctxt->pt);
+	if(bits->rtp_px_present)
+	{
+		decoded->rtp_p = bits->rtp_p;
+		decoded->rtp_x = bits->rtp_x;
+	}
+	else
+	{
+		decoded->rtp_p = rtp_ctxt->padding;
+		decoded->rtp_x = rtp_ctxt->extension;
+	}
+	decoded->rtp_m = bits->rtp_m;
+
+	return d_rfc5225_rtp_decode_ts(context, bits, decoded);
+}
+
+
+/**
+ * @brief Decode the RTP Timestamp and its stride
+ *
+ * The whole TS is used as is. Otherwise, the scaled TS is decoded from its
+ * LSB or deduced from the MSN, then multiplied by the TS stride and shifted
+ * by the TS offset.
+ *
+ * @param context       The decompression context
+ * @param bits          The bits extracted from the ROHC packet
+ * @param[out] decoded  The decoded values
+ * @return              true if decoding is successful, false otherwise
+ */
+static bool d_rfc5225_rtp_decode_ts(const struct rohc_decomp_ctxt *const context,
+                                    const struct rohc_rfc5225_extr_bits *const bits,
+                                    struct rohc_rfc5225_decoded *const decoded)
+{
+	const struct rohc_decomp_rfc5225_ctxt *const rfc5225_ctxt =
+		context->persist_ctxt;
+	const struct d_rfc5225_rtp_ctxt *const rtp_ctxt = rfc5225_ctxt->specific;
+	uint32_t ts_scaled;
+
+	decoded->rtp_ts_stride =
+		(bits->rtp_ts_stride_present ? bits->rtp_ts_stride : rtp_ctxt->ts_stride);
+
+	if(bits->rtp_ts_present)
+	{
+		decoded->rtp_ts = bits->rtp_ts;
+		rohc_decomp_debug(context, "whole TS = %u", decoded->rtp_ts);
+		goto ok;
+	}
+
+	if(decoded->rtp_ts_stride == 0)
+	{
+		if(bits->rtp_ts_scaled_nr > 0)
+		{
+			rohc_decomp_warn(context, "scaled TS received but no TS stride "
+			                 "established");
+			goto error;
+		}
+		decoded->rtp_ts = rtp_ctxt->ts;
+		rohc_decomp_debug(context, "unscaled TS = %u unchanged", decoded->rtp_ts);
+		goto ok;
+	}
+
+	if(!rohc_lsb_ref32_is_ready(&rtp_ctxt->ts_scaled_lsb_ctxt))
+	{
+		rohc_decomp_warn(context, "no reference to decode the scaled TS");
+		goto error;
+	}
+	if(bits->rtp_ts_scaled_nr > 0)
+	{
+		const rohc_lsb_shift_t p =
+			rohc_interval_get_rfc5225_msn_p(decoded->reorder_ratio);
+
+		ts_scaled = rohc_lsb_ref32_decode(&rtp_ctxt->ts_scaled_lsb_ctxt,
+		                                  bits->rtp_ts_scaled,
+		                                  bits->rtp_ts_scaled_nr, p);
+		rohc_decomp_debug(context, "scaled TS = %u decoded from %zu bits 0x%x",
+		                  ts_scaled, bits->rtp_ts_scaled_nr, bits->rtp_ts_scaled);
+	}
+	else
+	{
+		ts_scaled = decoded->msn + rtp_ctxt->ts_scaled_offset;
+		rohc_decomp_debug(context, "scaled TS = %u deduced from MSN", ts_scaled);
+	}
+	decoded->rtp_ts = ts_scaled * decoded->rtp_ts_stride + rtp_ctxt->ts_offset;
+	rohc_decomp_debug(context, "TS = %u (stride %u, offset %u)", decoded->rtp_ts,
+	                  decoded->rtp_ts_stride, rtp_ctxt->ts_offset);
+
+ok:
+	return true;
+
+error:
+	return false;
+}
+
+
+/**
+ * @brief Build the uncompressed UDP and RTP headers
+ *
+ * The UDP Length is inferred from the length of the payload. The RTP
+ * header is version 2 without CSRC item.
+ *
+ * @param context      The decompression context
+ * @param decoded      The decoded values
+ * @param payload_len  The length of the RTP payload
+ * @param dest         OUT: The UDP header followed by the RTP header
+ */
+static void d_rfc5225_rtp_build(const struct rohc_decomp_ctxt *const context,
+                                const struct rohc_rfc5225_decoded *const decoded,
+                                const size_t payload_len,
+                                uint8_t *const dest)
+{
+	struct udphdr *const udp = (struct udphdr *) dest;
+	struct rtphdr *const rtp = (struct rtphdr *) (udp + 1);
+
+	udp->source = decoded->udp_sport;
+	udp->dest = decoded->udp_dport;
+	udp->len = rohc_hton16(sizeof(struct udphdr) + sizeof(struct rtphdr) +
+	                       payload_len);
+	udp->check = decoded->udp_check;
+
+	rtp->version = 2;
+	rtp->padding = decoded->rtp_p;
+	rtp->extension = decoded->rtp_x;
+	rtp->cc = 0;
+	rtp->m = decoded->rtp_m;
+	rtp->pt = decoded->rtp_pt;
+	rtp->sn = rohc_hton16(decoded->msn);
+	rtp->timestamp = rohc_hton32(decoded->rtp_ts);
+	rtp->ssrc = decoded->rtp_ssrc;
+	rohc_decomp_debug(context, "UDP length = %u, checksum = 0x%04x, RTP SN = "
+	                  "%u, TS = %u", rohc_ntoh16(udp->len),
+	                  rohc_ntoh16(udp->check), decoded->msn, decoded->rtp_ts);
+}
+
+
+/**
+ * @brief Update the decompression context with the UDP and RTP headers
+ *
+ * @param context  The decompression context
+ * @param decoded  The decoded values to update in the context
+ */
+static void d_rfc5225_rtp_update_ctxt(struct rohc_decomp_ctxt *const context,
+                                      const struct rohc_rfc5225_decoded *const decoded)
+{
+	struct rohc_decomp_rfc5225_ctxt *const rfc5225_ctxt = context->persist_ctxt;
+	struct d_rfc5225_rtp_ctxt *const rtp_ctxt = rfc5225_ctxt->specific;
+
+	rtp_ctxt->sport = decoded->udp_sport;
+	rtp_ctxt->dport = decoded->udp_dport;
+	rtp_ctxt->is_checksum_used = !!(decoded->udp_check != 0);
+
+	rtp_ctxt->ssrc = decoded->rtp_ssrc;
+	rtp_ctxt->pt = decoded->rtp_pt;
+	rtp_ctxt->padding = decoded->rtp_p;
+	rtp_ctxt->extension = decoded->rtp_x;
+	rtp_ctxt->ts = decoded->rtp_ts;
+	rtp_ctxt->ts_stride = decoded->rtp_ts_stride;
+	if(rtp_ctxt->ts_stride != 0)
+	{
+		const uint32_t ts_scaled = decoded->rtp_ts / rtp_ctxt->ts_stride;
+
+		rtp_ctxt->ts_offset = decoded->rtp_ts % rtp_ctxt->ts_stride;
+		rohc_lsb_ref32_set(&rtp_ctxt->ts_scaled_lsb_ctxt, ts_scaled);
+		rtp_ctxt->ts_scaled_offset = ts_scaled - decoded->msn;
+	}
+	else
+	{
+		rtp_ctxt->ts_offset = 0;
+	}
+}
+
+
+/**
+ * @brief Define the decompression part of the ROHCv2 IP/UDP/RTP profile as
+ *        described in the RFC 5225
+ */
+const struct rohc_decomp_profile d_rfc5225_rtp_profile =
+{
+	.id              = ROHCv2_PROFILE_IP_UDP_RTP, /* profile ID (see 5 in RFC5225) */
+	.msn_max_bits    = 16,
+	.ctxt_block_len  = ROHC_DECOMP_RFC5225_BLOCK_LEN(sizeof(struct d_rfc5225_rtp_ctxt)),
+	.extr_bits_len   = sizeof(struct rohc_rfc5225_extr_bits),
+	.decoded_len     = sizeof(struct rohc_rfc5225_decoded),
+	.new_context     = (rohc_decomp_new_context_t) d_rfc5225_rtp_create,
+	.free_context    = (rohc_decomp_free_context_t) rohc_decomp_rfc5225_destroy,
+	.detect_pkt_type = d_rfc5225_rtp_detect_pkt_type,
+	.parse_pkt       = (rohc_decomp_parse_pkt_t) rohc_decomp_rfc5225_parse_pkt,
+	.decode_bits     = (rohc_decomp_decode_bits_t) rohc_decomp_rfc5225_decode_bits,
+	.build_hdrs      = (rohc_decomp_build_hdrs_t) rohc_decomp_rfc5225_build_hdrs,
+	.update_ctxt     = (rohc_decomp_update_ctxt_t) rohc_decomp_rfc5225_update_ctxt,
+	.attempt_repair  = (rohc_decomp_attempt_repair_t) rohc_decomp_rfc5225_attempt_repair,
+	.attempt_late    = (rohc_decomp_attempt_late_t) rohc_decomp_rfc5225_attempt_late,
+	.get_sn          = rohc_decomp_rfc5225_get_msn
+};
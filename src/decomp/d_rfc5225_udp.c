@@ -0,0 +1,370 @@
+/*
+ * Copyright 2026 Didier Barvaux
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/**
+ * @file   d_rfc5225_udp.c
+ * @brief  ROHC decompression context for the ROHCv2 IP/UDP profile
+ * @author Didier Barvaux <didier@barvaux.org>
+ *
+ * The profile decompresses the IP headers as the ROHCv2 IP-only profile
+ * does, and the UDP header that follows them (RFC5225 §6.8.2.5).
+ */
+
+#include "rohc_decomp_rfc5225.h"
+#include "rohc_traces_internal.h"
+#include "rohc_utils.h"
+#include "protocols/ip_numbers.h"
+#include "protocols/udp.h"
+
+#ifndef __KERNEL__
+#  include <string.h>
+#endif
+
+
+/*
+ * Private structures and types
+ */
+
+/**
+ * @brief The UDP part of the ROHCv2 IP/UDP decompression context
+ *
+ * This object must be used with the generic part of the decompression
+ * context rohc_decomp_rfc5225_ctxt.
+ *
+ * @see rohc_decomp_rfc5225_ctxt
+ */
+struct d_rfc5225_udp_ctxt
+{
+	uint16_t sport;         /**< The UDP source port (network byte order) */
+	uint16_t dport;         /**< The UDP destination port (network byte order) */
+	bool is_checksum_used;  /**< Whether the UDP checksum is non-zero */
+};
+
+
+/*
+ * Private function prototypes.
+ */
+
+static bool d_rfc5225_udp_create(const struct rohc_decomp_ctxt *const context,
+                                 struct rohc_decomp_rfc5225_ctxt **const persist_ctxt,
+                                 struct rohc_decomp_volat_ctxt *const volat_ctxt)
+	__attribute__((warn_unused_result, nonnull(1, 2, 3)));
+
+static int d_rfc5225_udp_parse_static(const struct rohc_decomp_ctxt *const context,
+                                      const uint8_t *const rohc_data,
+                                      const size_t rohc_len,
+                                      struct rohc_rfc5225_extr_bits *const bits)
+	__attribute__((warn_unused_result, nonnull(1, 2, 4)));
+
+static int d_rfc5225_udp_parse_dyn(const struct rohc_decomp_ctxt *const context,
+                                   const uint8_t *const rohc_data,
+                                   const size_t rohc_len,
+                                   struct rohc_rfc5225_extr_bits *const bits)
+	__attribute__((warn_unused_result, nonnull(1, 2, 4)));
+
+static int d_rfc5225_udp_parse_irreg(const struct rohc_decomp_ctxt *const context,
+                                     const uint8_t *const rohc_data,
+                                     const size_t rohc_len,
+                                     struct rohc_rfc5225_extr_bits *const bits)
+	__attribute__((warn_unused_result, nonnull(1, 2, 4)));
+
+static bool d_rfc5225_udp_decode(const struct rohc_decomp_ctxt *const context,
+                                 const struct rohc_rfc5225_extr_bits *const bits,
+                                 struct rohc_rfc5225_decoded *const decoded)
+	__attribute__((warn_unused_result, nonnull(1, 2, 3)));
+
+static void d_rfc5225_udp_build(const struct rohc_decomp_ctxt *const context,
+                                const struct rohc_rfc5225_decoded *const decoded,
+                                const size_t payload_len,
+                                uint8_t *const dest)
+	__attribute__((nonnull(1, 2, 4)));
+
+static void d_rfc5225_udp_update_ctxt(struct rohc_decomp_ctxt *const context,
+                                      const struct rohc_rfc5225_decoded *const decoded)
+	__attribute__((nonnull(1, 2)));
+
+
+/*
+ * Definitions of functions
+ */
+
+/**
+ * @brief Create the ROHCv2 IP/UDP decompression context
+ *
+ * This function is one of the functions that must exist in one profile for
+ * the framework to work.
+ *
+ * @param context            The decompression context
+ * @param[out] persist_ctxt  The persistent part of the decompression context
+ * @param[out] volat_ctxt    The volatile part of the decompression context
+ * @return                   true if the ROHCv2 IP/UDP context was
+ *                           successfully created, false if a problem occurred
+ */
+static bool d_rfc5225_udp_create(const struct rohc_decomp_ctxt *const context,
+                                 struct rohc_decomp_rfc5225_ctxt **const persist_ctxt,
+                                 struct rohc_decomp_volat_ctxt *const volat_ctxt)
+{
+	struct rohc_decomp_rfc5225_ctxt *rfc5225_ctxt;
+	struct d_rfc5225_udp_ctxt *udp_ctxt;
+
+	if(!rohc_decomp_rfc5225_create(context, persist_ctxt, volat_ctxt,
+	                               sizeof(struct d_rfc5225_udp_ctxt)))
+	{
+		goto error;
+	}
+	rfc5225_ctxt = *persist_ctxt;
+	udp_ctxt = rfc5225_ctxt->specific;
+
+	/* the UDP ports will be initialized with the IR packets */
+	udp_ctxt->sport = 0;
+	udp_ctxt->dport = 0;
+	udp_ctxt->is_checksum_used = false;
+
+	rfc5225_ctxt->next_header_len = sizeof(struct udphdr);
+	rfc5225_ctxt->parse_static_next_hdr = d_rfc5225_udp_parse_static;
+	rfc5225_ctxt->parse_dyn_next_hdr = d_rfc5225_udp_parse_dyn;
+	rfc5225_ctxt->parse_irreg_next_hdr = d_rfc5225_udp_parse_irreg;
+	rfc5225_ctxt->decode_next_hdr = d_rfc5225_udp_decode;
+	rfc5225_ctxt->build_next_hdr = d_rfc5225_udp_build;
+	rfc5225_ctxt->update_next_hdr = d_rfc5225_udp_update_ctxt;
+
+	return true;
+
+error:
+	return false;
+}
+
+
+/**
+ * @brief Parse the static part of the UDP header (RFC5225 §6.8.2.5)
+ *
+ * @param context    The decompression context
+ * @param rohc_data  The remaining ROHC data
+ * @param rohc_len   The length of the remaining ROHC data
+ * @param[out] bits  The bits extracted from the ROHC packet
+ * @return           The length of the static part in case of success,
+ *                   -1 in case of failure
+ */
+static int d_rfc5225_udp_parse_static(const struct rohc_decomp_ctxt *const context,
+                                      const uint8_t *const rohc_data,
+                                      const size_t rohc_len,
+                                      struct rohc_rfc5225_extr_bits *const bits)
+{
+	if(bits->ip[bits->ip_nr - 1].vals.next_proto != ROHC_IPPROTO_UDP)
+	{
+		rohc_decomp_warn(context, "the innermost IP header is not followed by "
+		                 "a UDP header but by protocol %u",
+		                 bits->ip[bits->ip_nr - 1].vals.next_proto);
+		goto error;
+	}
+	if(rohc_len < 4)
+	{
+		rohc_decomp_warn(context, "malformed ROHC packet: too short for the "
+		                 "UDP static part");
+		goto error;
+	}
+	memcpy(&bits->udp_sport, rohc_data, sizeof(uint16_t));
+	memcpy(&bits->udp_dport, rohc_data + 2, sizeof(uint16_t));
+	rohc_decomp_debug(context, "UDP source port = %u, destination port = %u",
+	                  rohc_ntoh16(bits->udp_sport), rohc_ntoh16(bits->udp_dport));
+
+	return 4;
+
+error:
+	return -1;
+}
+
+
+/**
+ * @brief Parse the dynamic part of the UDP header (RFC5225 §6.8.2.5)
+ *
+ * The dynamic part carries the UDP checksum, the MSN and the reordering
+ * ratio.
+ *
+ * @param context    The decompression context
+ * @param rohc_data  The remaining ROHC data
+ * @param rohc_len   The length of the remaining ROHC data
+ * @param[out] bits  The bits extracted from the ROHC packet
+ * @return           The length of the dynamic part in case of success,
+ *                   -1 in case of failure
+ */
+static int d_rfc5225_udp_parse_dyn(const struct rohc_decomp_ctxt *const context,
+                                   const uint8_t *const rohc_data,
+                                   const size_t rohc_len,
+                                   struct rohc_rfc5225_extr_bits *const bits)
+{
+	if(rohc_len < 5)
+	{
+		rohc_decomp_warn(context, "malformed ROHC packet: too short for the "
+		                 "UDP dynamic part");
+		goto error;
+	}
+	memcpy(&bits->udp_check, rohc_data, sizeof(uint16_t));
+	bits->udp_check_present = true;
+	bits->msn = (rohc_data[2] << 8) | rohc_data[3];
+	bits->msn_nr = 16;
+	bits->reorder_ratio = rohc_data[4] & 0x03;
+	bits->reorder_present = true;
+	rohc_decomp_debug(context, "UDP checksum = 0x%04x, reorder_ratio = %u, "
+	                  "MSN = 0x%04x", rohc_ntoh16(bits->udp_check),
+	                  bits->reorder_ratio, bits->msn);
+
+	return 5;
+
+error:
+	return -1;
+}
+
+
+/**
+ * @brief Parse the irregular part of the UDP header (RFC5225 §6.8.2.5)
+ *
+ * The UDP checksum is transmitted if it is used.
+ *
+ * @param context    The decompression context
+ * @param rohc_data  The remaining ROHC data
+ * @param rohc_len   The length of the remaining ROHC data
+ * @param[out] bits  The bits extracted from the ROHC packet
+ * @return           The length of the irregular part in case of success,
+ *                   -1 in case of failure
+ */
+static int d_rfc5225_udp_parse_irreg(const struct rohc_decomp_ctxt *const context,
+                                     const uint8_t *const rohc_data,
+                                     const size_t rohc_len,
+                                     struct rohc_rfc5225_extr_bits *const bits)
+{
+	const struct rohc_decomp_rfc5225_ctxt *const rfc5225_ctxt =
+		context->persist_ctxt;
+	const struct d_rfc5225_udp_ctxt *const udp_ctxt = rfc5225_ctxt->specific;
+
+	if(!udp_ctxt->is_checksum_used)
+	{
+		return 0;
+	}
+	if(rohc_len < 2)
+	{
+		rohc_decomp_warn(context, "malformed ROHC packet: too short for the "
+		                 "UDP checksum");
+		return -1;
+	}
+	memcpy(&bits->udp_check, rohc_data, sizeof(uint16_t));
+	bits->udp_check_present = true;
+
+	return 2;
+}
+
+
+/**
+ * @brief Decode the fields of the UDP header
+ *
+ * @param context       The decompression context
+ * @param bits          The bits extracted from the ROHC packet
+ * @param[out] decoded  The decoded values
+ * @return              true if decoding is successful, false otherwise
+ */
+static bool d_rfc5225_udp_decode(const struct rohc_decomp_ctxt *const context,
+                                 const struct rohc_rfc5225_extr_bits *const bits,
+                                 struct rohc_rfc5225_decoded *const decoded)
+{
+	const struct rohc_decomp_rfc5225_ctxt *const rfc5225_ctxt =
+		context->persist_ctxt;
+	const struct d_rfc5225_udp_ctxt *const udp_ctxt = rfc5225_ctxt->specific;
+
+	if(bits->is_ir)
+	{
+		decoded->udp_sport = bits->udp_sport;
+		decoded->udp_dport = bits->udp_dport;
+	}
+	else
+	{
+		decoded->udp_sport = udp_ctxt->sport;
+		decoded->udp_dport = udp_ctxt->dport;
+	}
+	decoded->udp_check = (bits->udp_check_present ? bits->udp_check : 0);
+
+	return true;
+}
+
+
+/**
+ * @brief Build the uncompressed UDP header
+ *
+ * The UDP Length is inferred from the length of the payload.
+ *
+ * @param context      The decompression context
+ * @param decoded      The decoded values
+ * @param payload_len  The length of the UDP payload
+ * @param dest         OUT: The UDP header
+ */
+static void d_rfc5225_udp_build(const struct rohc_decomp_ctxt *const context,
+                                const struct rohc_rfc5225_decoded *const decoded,
+                                const size_t payload_len,
+                                uint8_t *const dest)
+{
+	struct udphdr *const udp = (struct udphdr *) dest;
+
+	udp->source = decoded->udp_sport;
+	udp->dest = decoded->udp_dport;
+	udp->len = rohc_hton16(sizeof(struct udphdr) + payload_len);
+	udp->check = decoded->udp_check;
+	rohc_decomp_debug(context, "UDP length = %u, checksum = 0x%04x",
+	                  rohc_ntoh16(udp->len), rohc_ntoh16(udp->check));
+}
+
+
+/**
+ * @brief Update the decompression context with the UDP header
+ *
+ * @param context  The decompression context
+ * @param decoded  The decoded values to update in the context
+ */
+static void d_rfc5225_udp_update_ctxt(struct rohc_decomp_ctxt *const context,
+                                      const struct rohc_rfc5225_decoded *const decoded)
+{
+	struct rohc_decomp_rfc5225_ctxt *const rfc5225_ctxt = context->persist_ctxt;
+	struct d_rfc5225_udp_ctxt *const udp_ctxt = rfc5225_ctxt->specific;
+
+	udp_ctxt->sport = decoded->udp_sport;
+	udp_ctxt->dport = decoded->udp_dport;
+	udp_ctxt->is_checksum_used = !!(decoded->udp_check != 0);
+}
+
+
+/**
+ * @brief Define the decompression part of the ROHCv2 IP/UDP profile as
+ *        described in the RFC 5225
+ */
+const struct rohc_decomp_profile d_rfc5225_udp_profile =
+{
+	.id              = ROHCv2_PROFILE_IP_UDP, /* profile ID (see 5 in RFC5225) */
+	.msn_max_bits    = 16,
+	.ctxt_block_len  = ROHC_DECOMP_RFC5225_BLOCK_LEN(sizeof(struct d_rfc5225_udp_ctxt)),
+	.extr_bits_len   = sizeof(struct rohc_rfc5225_extr_bits),
+	.decoded_len     = sizeof(struct rohc_rfc5225_decoded),
+	.new_context     = (rohc_decomp_new_context_t) d_rfc5225_udp_create,
+	.free_context    = (rohc_decomp_free_context_t) rohc_decomp_rfc5225_destroy,
+	.detect_pkt_type = rohc_decomp_rfc5225_detect_pkt_type,
+	.parse_pkt       = (rohc_decomp_parse_pkt_t) rohc_decomp_rfc5225_parse_pkt,
+	.decode_bits     = (rohc_decomp_decode_bits_t) rohc_decomp_rfc5225_decode_bits,
+	.build_hdrs      = (rohc_decomp_build_hdrs_t) rohc_decomp_rfc5225_build_hdrs,
+	.update_ctxt     = (rohc_decomp_update_ctxt_t) rohc_decomp_rfc5225_update_ctxt,
+	.attempt_repair  = (rohc_decomp_attempt_repair_t) rohc_decomp_rfc5225_attempt_repair,
+	.attempt_late    = (rohc_decomp_attempt_late_t) rohc_decomp_rfc5225_attempt_late,
+	.get_sn          = rohc_decomp_rfc5225_get_msn
+};
+
@@ -36,6 +36,7 @@
 #include "sdvl.h"
 #include "crc.h"
 #include "schemes/decomp_scaled_rtp_ts.h"
+#include "rohc_ctxt_pool.h"
 #include "rohc_decomp_detect_packet.h"
 #include "protocols/udp.h"
 #include "protocols/rtp.h"
@@ -60,10 +61,20 @@ struct d_rtp_context
 	uint32_t ssrc;
 	/** Whether the UDP checksum field is encoded in the ROHC packet or not */
 	rohc_tristate_t udp_check_present;
-	/** The scaled RTP Timestamp decoding context */
+	/** The scaled RTP Timestamp decoding context, carved along with the
+	 *  RTP-specific part of the context */
 	struct ts_sc_decomp *ts_scaled_ctxt;
 };
 
+/** The size of the RTP-specific part of the context, along with its scaled
+ *  RTP Timestamp decoding context */
+#define D_RTP_SPECIFIC_SIZE \
+	(ROHC_CTXT_ARENA_SIZE(sizeof(struct d_rtp_context)) + \
+	 sizeof(struct ts_sc_decomp))
+
+/** The length of the UDP and RTP headers next to the IP headers */
+#define D_RTP_NEXT_HDR_LEN  (sizeof(struct udphdr) + sizeof(struct rtphdr))
+
 
 /*
  * Private function prototypes.
@@ -74,9 +85,10 @@ static bool d_rtp_create(const struct rohc_decomp_ctxt *const context,
                          struct rohc_decomp_volat_ctxt *const volat_ctxt)
 	__attribute__((warn_unused_result, nonnull(1, 2, 3)));
 
-static void d_rtp_destroy(struct rohc_decomp_rfc3095_ctxt *const rfc3095_ctxt,
+static void d_rtp_destroy(const struct rohc_decomp_ctxt *const context,
+                          struct rohc_decomp_rfc3095_ctxt *const rfc3095_ctxt,
                           const struct rohc_decomp_volat_ctxt *const volat_ctxt)
-	__attribute__((nonnull(1, 2)));
+	__attribute__((nonnull(1, 2, 3)));
 
 static rohc_packet_t rtp_detect_packet_type(const struct rohc_decomp_ctxt *const context,
                                             const uint8_t *const rohc_packet,
@@ -175,7 +187,6 @@ static bool d_rtp_create(const struct rohc_decomp_ctxt *const context,
 {
 	struct rohc_decomp_rfc3095_ctxt *rfc3095_ctxt;
 	struct d_rtp_context *rtp_context;
-	const size_t nh_len = sizeof(struct udphdr) + sizeof(struct rtphdr);
 
 	assert(context != NULL);
 	assert(context->decompressor != NULL);
@@ -183,8 +194,11 @@ static bool d_rtp_create(const struct rohc_decomp_ctxt *const context,
 
 	/* create the generic context */
 	if(!rohc_decomp_rfc3095_create(context, persist_ctxt, volat_ctxt,
+	                               D_RTP_SPECIFIC_SIZE, D_RTP_NEXT_HDR_LEN,
 	                               context->decompressor->trace_callback,
 	                               context->decompressor->trace_callback_priv,
+	                               context->decompressor->trace_level,
+	                               context->decompressor->trace_pkt_level,
 	                               context->profile->id))
 	{
 		rohc_error(context->decompressor, ROHC_TRACE_DECOMP, context->profile->id,
@@ -193,33 +207,20 @@ static bool d_rtp_create(const struct rohc_decomp_ctxt *const context,
 	}
 	rfc3095_ctxt = *persist_ctxt;
 
-	/* create the RTP-specific part of the context */
-	rtp_context = malloc(sizeof(struct d_rtp_context));
-	if(rtp_context == NULL)
-	{
-		rohc_error(context->decompressor, ROHC_TRACE_DECOMP, context->profile->id,
-		           "cannot allocate memory for the RTP-specific context");
-		goto destroy_context;
-	}
-	memset(rtp_context, 0, sizeof(struct d_rtp_context));
-	rfc3095_ctxt->specific = rtp_context;
+	/* the RTP-specific part of the context was allocated along with the
+	 * generic part */
+	rtp_context = (struct d_rtp_context *) rfc3095_ctxt->specific;
 
-	/* create the LSB decoding context for SN */
+	/* init the LSB decoding context for SN */
 	rfc3095_ctxt->sn_lsb_p = ROHC_LSB_SHIFT_RTP_SN;
-	rfc3095_ctxt->sn_lsb_ctxt = rohc_lsb_new(16);
-	if(rfc3095_ctxt->sn_lsb_ctxt == NULL)
-	{
-		rohc_error(context->decompressor, ROHC_TRACE_DECOMP, context->profile->id,
-		           "failed to create the LSB decoding context for SN");
-		goto free_rtp_context;
-	}
+	rohc_lsb_init(&rfc3095_ctxt->sn_lsb_ctxt, 16);
 
 	/* the UDP checksum field present flag will be initialized
 	 * with the IR packets */
 	rtp_context->udp_check_present = ROHC_TRISTATE_NONE;
 
 	/* some RTP-specific values and functions */
-	rfc3095_ctxt->next_header_len = nh_len;
+	rfc3095_ctxt->next_header_len = D_RTP_NEXT_HDR_LEN;
 	rfc3095_ctxt->parse_static_next_hdr = rtp_parse_static_rtp;
 	rfc3095_ctxt->parse_dyn_next_hdr = rtp_parse_dynamic_rtp;
 	rfc3095_ctxt->parse_ext3 = rtp_parse_ext3;
@@ -230,55 +231,21 @@ static bool d_rtp_create(const struct rohc_decomp_ctxt *const context,
 	rfc3095_ctxt->compute_crc_dynamic = rtp_compute_crc_dynamic;
 	rfc3095_ctxt->update_context = rtp_update_context;
 
-	/* create the UDP-specific part of the header changes */
-	rfc3095_ctxt->outer_ip_changes->next_header_len = nh_len;
-	rfc3095_ctxt->outer_ip_changes->next_header = malloc(nh_len);
-	if(rfc3095_ctxt->outer_ip_changes->next_header == NULL)
-	{
-		rohc_error(context->decompressor, ROHC_TRACE_DECOMP, context->profile->id,
-		           "cannot allocate memory for the RTP-specific part of the "
-		           "outer IP header changes");
-		goto free_lsb_sn;
-	}
-	memset(rfc3095_ctxt->outer_ip_changes->next_header, 0, nh_len);
-
-	rfc3095_ctxt->inner_ip_changes->next_header_len = nh_len;
-	rfc3095_ctxt->inner_ip_changes->next_header = malloc(nh_len);
-	if(rfc3095_ctxt->inner_ip_changes->next_header == NULL)
-	{
-		rohc_error(context->decompressor, ROHC_TRACE_DECOMP, context->profile->id,
-		           "cannot allocate memory for the RTP-specific part of the "
-		           "inner IP header changes");
-		goto free_outer_ip_changes_next_header;
-	}
-	memset(rfc3095_ctxt->inner_ip_changes->next_header, 0, nh_len);
-
 	/* set next header to UDP */
 	rfc3095_ctxt->next_header_proto = ROHC_IPPROTO_UDP;
 
-	/* create the scaled RTP Timestamp decoding context */
-	rtp_context->ts_scaled_ctxt =
-		d_create_sc(context->decompressor->trace_callback,
-		            context->decompressor->trace_callback_priv);
-	if(rtp_context->ts_scaled_ctxt == NULL)
-	{
-		rohc_error(context->decompressor, ROHC_TRACE_DECOMP, context->profile->id,
-		           "cannot create the scaled RTP Timestamp decoding context");
-		goto free_inner_ip_changes_next_header;
-	}
+	/* init the scaled RTP Timestamp decoding context */
+	rtp_context->ts_scaled_ctxt = (struct ts_sc_decomp *)
+		(((uint8_t *) rtp_context) +
+		 rohc_ctxt_arena_size(sizeof(struct d_rtp_context)));
+	d_init_sc(rtp_context->ts_scaled_ctxt,
+	          context->decompressor->trace_callback,
+	          context->decompressor->trace_callback_priv,
+	          context->decompressor->trace_level,
+	          context->decompressor->trace_pkt_level);
 
 	return true;
 
-free_inner_ip_changes_next_header:
-	zfree(rfc3095_ctxt->inner_ip_changes->next_header);
-free_outer_ip_changes_next_header:
-	zfree(rfc3095_ctxt->outer_ip_changes->next_header);
-free_lsb_sn:
-	rohc_lsb_free(rfc3095_ctxt->sn_lsb_ctxt);
-free_rtp_context:
-	zfree(rtp_context);
-destroy_context:
-	rohc_decomp_rfc3095_destroy(rfc3095_ctxt, volat_ctxt);
 quit:
 	return false;
 }
@@ -290,29 +257,16 @@ quit:
  * This function is one of the functions that must exist in one profile for the
  * framework to work.
  *
+ * @param context       The decompression context
  * @param rfc3095_ctxt  The persistent decompression context for the RFC3095 profiles
  * @param volat_ctxt    The volatile decompression context
  */
-static void d_rtp_destroy(struct rohc_decomp_rfc3095_ctxt *const rfc3095_ctxt,
+static void d_rtp_destroy(const struct rohc_decomp_ctxt *const context,
+                          struct rohc_decomp_rfc3095_ctxt *const rfc3095_ctxt,
                           const struct rohc_decomp_volat_ctxt *const volat_ctxt)
 {
-	const struct d_rtp_context *const rtp_context =
-		(struct d_rtp_context *) rfc3095_ctxt->specific;
-
-	/* destroy the scaled RTP Timestamp decoding object */
-	rohc_ts_scaled_free(rtp_context->ts_scaled_ctxt);
-
-	/* clean UDP-specific memory */
-	assert(rfc3095_ctxt->outer_ip_changes != NULL);
-	zfree(rfc3095_ctxt->outer_ip_changes->next_header);
-	assert(rfc3095_ctxt->inner_ip_changes != NULL);
-	zfree(rfc3095_ctxt->inner_ip_changes->next_header);
-
-	/* destroy the LSB decoding context for SN */
-	rohc_lsb_free(rfc3095_ctxt->sn_lsb_ctxt);
-
 	/* destroy the resources of the generic context */
-	rohc_decomp_rfc3095_destroy(rfc3095_ctxt, volat_ctxt);
+	rohc_decomp_rfc3095_destroy(context, rfc3095_ctxt, volat_ctxt);
 }
 
 
@@ -339,38 +293,23 @@ static rohc_packet_t rtp_detect_packet_type(const struct rohc_decomp_ctxt *const
 		goto error;
 	}
 
-	if(rohc_decomp_packet_is_uo0(rohc_packet, rohc_length))
-	{
-		/* UO-0 packet */
-		type = ROHC_PACKET_UO_0;
-	}
-	else if(rohc_decomp_packet_is_uo1(rohc_packet, rohc_length))
+	/* IR, IR-DYN, UO-0, UO-1*, or UOR-2* packet */
+	type = rohc_decomp_rfc3095_pkt_type(rohc_packet[0]);
+	if(type == ROHC_PACKET_UO_1)
 	{
 		/* choose between the UO-1-RTP, UO-1-ID, and UO-1-TS variants */
 		type = rtp_choose_uo1_variant(context, rohc_packet, rohc_length);
 	}
-	else if(rohc_decomp_packet_is_uor2(rohc_packet, rohc_length))
+	else if(type == ROHC_PACKET_UOR_2)
 	{
 		/* choose between the UOR-2-RTP, UOR-2-ID, and UOR-2-TS variants */
 		type = rtp_choose_uor2_variant(context, rohc_packet, rohc_length,
 		                               large_cid_len);
 	}
-	else if(rohc_decomp_packet_is_irdyn(rohc_packet, rohc_length))
-	{
-		/* IR-DYN packet */
-		type = ROHC_PACKET_IR_DYN;
-	}
-	else if(rohc_decomp_packet_is_ir(rohc_packet, rohc_length))
-	{
-		/* IR packet */
-		type = ROHC_PACKET_IR;
-	}
-	else
+	else if(type == ROHC_PACKET_UNKNOWN)
 	{
-		/* unknown packet */
 		rohc_decomp_warn(context, "failed to recognize the packet type in byte "
 		                 "0x%02x", rohc_packet[0]);
-		type = ROHC_PACKET_UNKNOWN;
 	}
 
 	return type;
@@ -1958,6 +1897,10 @@ const struct rohc_decomp_profile d_rtp_profile =
 {
 	.id              = ROHC_PROFILE_RTP, /* profile ID (see 8 in RFC3095) */
 	.msn_max_bits    = 16,
+	.ctxt_block_len  = ROHC_DECOMP_RFC3095_BLOCK_LEN(D_RTP_SPECIFIC_SIZE,
+	                                                 D_RTP_NEXT_HDR_LEN),
+	.extr_bits_len   = sizeof(struct rohc_extr_bits),
+	.decoded_len     = sizeof(struct rohc_decoded_values),
 	.new_context     = (rohc_decomp_new_context_t) d_rtp_create,
 	.free_context    = (rohc_decomp_free_context_t) d_rtp_destroy,
 	.detect_pkt_type = rtp_detect_packet_type,
@@ -1966,6 +1909,7 @@ const struct rohc_decomp_profile d_rtp_profile =
 	.build_hdrs      = (rohc_decomp_build_hdrs_t) rfc3095_decomp_build_hdrs,
 	.update_ctxt     = (rohc_decomp_update_ctxt_t) rfc3095_decomp_update_ctxt,
 	.attempt_repair  = (rohc_decomp_attempt_repair_t) rfc3095_decomp_attempt_repair,
+	.attempt_late    = (rohc_decomp_attempt_late_t) rfc3095_decomp_attempt_late,
 	.get_sn          = rohc_decomp_rfc3095_get_sn,
 };
 
@@ -46,6 +46,7 @@
 #include "protocols/tcp.h"
 #include "protocols/ip_numbers.h"
 #include "crc.h"
+#include "rohc_csum.h"
 
 #include "config.h" /* for WORDS_BIGENDIAN and ROHC_RFC_STRICT_DECOMPRESSOR */
 
@@ -55,6 +56,121 @@
 #include <stdint.h>
 
 
+/**
+ * The maximum length (in bytes) of the base header of one CO packet: the
+ * co_common header with all its optional fields, the other base headers
+ * are shorter
+ */
+#define D_TCP_CO_BASE_HDR_MAX_LEN \
+	(sizeof(co_common_t) + 4U + 4U + 2U + 2U + 2U + 2U + 1U + 1U)
+
+/* short names for the packet types in the table below */
+#define IR  ROHC_PACKET_IR
+#define ID  ROHC_PACKET_IR_DYN
+#define CO  ROHC_PACKET_TCP_CO_COMMON
+#define R1  ROHC_PACKET_TCP_RND_1
+#define R2  ROHC_PACKET_TCP_RND_2
+#define R3  ROHC_PACKET_TCP_RND_3
+#define R4  ROHC_PACKET_TCP_RND_4
+#define R5  ROHC_PACKET_TCP_RND_5
+#define R6  ROHC_PACKET_TCP_RND_6
+#define R7  ROHC_PACKET_TCP_RND_7
+#define R8  ROHC_PACKET_TCP_RND_8
+#define S1  ROHC_PACKET_TCP_SEQ_1
+#define S2  ROHC_PACKET_TCP_SEQ_2
+#define S3  ROHC_PACKET_TCP_SEQ_3
+#define S4  ROHC_PACKET_TCP_SEQ_4
+#define S5  ROHC_PACKET_TCP_SEQ_5
+#define S6  ROHC_PACKET_TCP_SEQ_6
+#define S7  ROHC_PACKET_TCP_SEQ_7
+#define S8  ROHC_PACKET_TCP_SEQ_8
+#define XX  ROHC_PACKET_UNKNOWN
+
+/**
+ * The types of the TCP packets, indexed by whether the innermost IP-ID
+ * behavior is sequential or not, then by the first byte of the packet
+ * (see RFC 6846, §8.4):
+ *  - 0xxxxxxx is seq_4 or rnd_3,
+ *  - 1000xxxx is seq_5 or rnd_5,
+ *  - 1001xxxx is seq_3 or rnd_5,
+ *  - 1010xxxx is seq_1 or rnd_6,
+ *  - 1011xxxx is seq_8, or rnd_8 (10110xxx), rnd_1 (101110xx) and
+ *    rnd_7 (101111xx),
+ *  - 1100xxxx is seq_7 or rnd_2,
+ *  - 1101xxxx is seq_2 (11010xxx), seq_6 (11011xxx), or rnd_4,
+ *  - 1111101x is co_common,
+ *  - 11111000 is IR-DYN,
+ *  - 11111101 is IR.
+ */
+static const uint8_t d_tcp_pkt_types[2][256] =
+{
+	{
+		/* innermost IP-ID behavior random or zero */
+		R3, R3, R3, R3, R3, R3, R3, R3, R3, R3, R3, R3, R3, R3, R3, R3,
+		R3, R3, R3, R3, R3, R3, R3, R3, R3, R3, R3, R3, R3, R3, R3, R3,
+		R3, R3, R3, R3, R3, R3, R3, R3, R3, R3, R3, R3, R3, R3, R3, R3,
+		R3, R3, R3, R3, R3, R3, R3, R3, R3, R3, R3, R3, R3, R3, R3, R3,
+		R3, R3, R3, R3, R3, R3, R3, R3, R3, R3, R3, R3, R3, R3, R3, R3,
+		R3, R3, R3, R3, R3, R3, R3, R3, R3, R3, R3, R3, R3, R3, R3, R3,
+		R3, R3, R3, R3, R3, R3, R3, R3, R3, R3, R3, R3, R3, R3, R3, R3,
+		R3, R3, R3, R3, R3, R3, R3, R3, R3, R3, R3, R3, R3, R3, R3, R3,
+		R5, R5, R5, R5, R5, R5, R5, R5, R5, R5, R5, R5, R5, R5, R5, R5,
+		R5, R5, R5, R5, R5, R5, R5, R5, R5, R5, R5, R5, R5, R5, R5, R5,
+		R6, R6, R6, R6, R6, R6, R6, R6, R6, R6, R6, R6, R6, R6, R6, R6,
+		R8, R8, R8, R8, R8, R8, R8, R8, R1, R1, R1, R1, R7, R7, R7, R7,
+		R2, R2, R2, R2, R2, R2, R2, R2, R2, R2, R2, R2, R2, R2, R2, R2,
+		R4, R4, R4, R4, R4, R4, R4, R4, R4, R4, R4, R4, R4, R4, R4, R4,
+		XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,
+		XX, XX, XX, XX, XX, XX, XX, XX, ID, XX, CO, CO, XX, IR, XX, XX,
+	},
+	{
+		/* innermost IP-ID behavior sequential */
+		S4, S4, S4, S4, S4, S4, S4, S4, S4, S4, S4, S4, S4, S4, S4, S4,
+		S4, S4, S4, S4, S4, S4, S4, S4, S4, S4, S4, S4, S4, S4, S4, S4,
+		S4, S4, S4, S4, S4, S4, S4, S4, S4, S4, S4, S4, S4, S4, S4, S4,
+		S4, S4, S4, S4, S4, S4, S4, S4, S4, S4, S4, S4, S4, S4, S4, S4,
+		S4, S4, S4, S4, S4, S4, S4, S4, S4, S4, S4, S4, S4, S4, S4, S4,
+		S4, S4, S4, S4, S4, S4, S4, S4, S4, S4, S4, S4, S4, S4, S4, S4,
+		S4, S4, S4, S4, S4, S4, S4, S4, S4, S4, S4, S4, S4, S4, S4, S4,
+		S4, S4, S4, S4, S4, S4, S4, S4, S4, S4, S4, S4, S4, S4, S4, S4,
+		S5, S5, S5, S5, S5, S5, S5, S5, S5, S5, S5, S5, S5, S5, S5, S5,
+		S3, S3, S3, S3, S3, S3, S3, S3, S3, S3, S3, S3, S3, S3, S3, S3,
+		S1, S1, S1, S1, S1, S1, S1, S1, S1, S1, S1, S1, S1, S1, S1, S1,
+		S8, S8, S8, S8, S8, S8, S8, S8, S8, S8, S8, S8, S8, S8, S8, S8,
+		S7, S7, S7, S7, S7, S7, S7, S7, S7, S7, S7, S7, S7, S7, S7, S7,
+		S2, S2, S2, S2, S2, S2, S2, S2, S6, S6, S6, S6, S6, S6, S6, S6,
+		XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,
+		XX, XX, XX, XX, XX, XX, XX, XX, ID, XX, CO, CO, XX, IR, XX, XX,
+	},
+};
+
+#undef IR
+#undef ID
+#undef CO
+#undef R1
+#undef R2
+#undef R3
+#undef R4
+#undef R5
+#undef R6
+#undef R7
+#undef R8
+#undef S1
+#undef S2
+#undef S3
+#undef S4
+#undef S5
+#undef S6
+#undef S7
+#undef S8
+#undef XX
+
+/** The length of the memory block of one TCP context: the persistent part
+ *  only, the volatile part lives in the scratch memory of the decompressor */
+#define D_TCP_CTXT_BLOCK_LEN \
+	ROHC_CTXT_ARENA_SIZE(sizeof(struct d_tcp_context))
+
+
 /*
  * Private function prototypes.
  */
@@ -64,9 +180,10 @@ static bool d_tcp_create(const struct rohc_decomp_ctxt *const context,
                          struct rohc_decomp_volat_ctxt *const volat_ctxt)
 	__attribute__((warn_unused_result, nonnull(1, 2, 3)));
 
-static void d_tcp_destroy(struct d_tcp_context *const tcp_context,
+static void d_tcp_destroy(const struct rohc_decomp_ctxt *const context,
+                          struct d_tcp_context *const tcp_context,
                           const struct rohc_decomp_volat_ctxt *const volat_ctxt)
-	__attribute__((nonnull(1, 2)));
+	__attribute__((nonnull(1, 2, 3)));
 
 static rohc_packet_t tcp_detect_packet_type(const struct rohc_decomp_ctxt *const context,
                                             const uint8_t *const rohc_packet,
@@ -269,8 +386,9 @@ static bool d_tcp_decode_bits_ip_hdr(const struct rohc_decomp_ctxt *const contex
                                      const struct rohc_tcp_extr_ip_bits *const ip_bits,
                                      const ip_context_t *const ip_context,
                                      const uint16_t decoded_msn,
+                                     const bool use_hdrs_tmpl,
                                      struct rohc_tcp_decoded_ip_values *const ip_decoded)
-	__attribute__((warn_unused_result, nonnull(1, 2, 3, 5)));
+	__attribute__((warn_unused_result, nonnull(1, 2, 3, 6)));
 static bool d_tcp_decode_bits_tcp_hdr(const struct rohc_decomp_ctxt *const context,
                                       const struct rohc_tcp_extr_bits *const bits,
                                       const size_t payload_len,
@@ -286,7 +404,7 @@ static bool d_tcp_decode_bits_tcp_opts(const struct rohc_decomp_ctxt *const cont
 	__attribute__((warn_unused_result, nonnull(1, 2, 3)));
 static bool d_tcp_decode_opt_ts_field(const struct rohc_decomp_ctxt *const context,
                                       const char *const descr,
-                                      const struct rohc_lsb_decode *const lsb_ctxt,
+                                      const struct rohc_lsb_ref32 *const lsb_ctxt,
                                       const struct rohc_lsb_field32 ts,
                                       uint32_t *const ts_decoded)
 	__attribute__((warn_unused_result, nonnull(1, 2, 3, 5)));
@@ -296,21 +414,31 @@ static void d_tcp_decode_opt_sack(const struct rohc_decomp_ctxt *const context,
                                   struct d_tcp_opt_sack *const decoded)
 	__attribute__((nonnull(1, 4)));
 
+static void d_tcp_build_ipv4_static(struct ipv4_hdr *const ipv4,
+                                    const struct rohc_tcp_decoded_ip_values *const decoded)
+	__attribute__((nonnull(1, 2)));
+static void d_tcp_build_ipv6_static(struct ipv6_hdr *const ipv6,
+                                    const struct rohc_tcp_decoded_ip_values *const decoded)
+	__attribute__((nonnull(1, 2)));
 static bool d_tcp_build_ipv4_hdr(const struct rohc_decomp_ctxt *const context,
                                  const struct rohc_tcp_decoded_ip_values *const decoded,
+                                 const struct ipv4_hdr *const tmpl,
                                  struct rohc_buf *const uncomp_packet,
                                  size_t *const ip_hdr_len)
-	__attribute__((warn_unused_result, nonnull(1, 2, 3, 4)));
+	__attribute__((warn_unused_result, nonnull(1, 2, 4, 5)));
 static bool d_tcp_build_ipv6_hdr(const struct rohc_decomp_ctxt *const context,
                                  const struct rohc_tcp_decoded_ip_values *const decoded,
+                                 const struct ipv6_hdr *const tmpl,
                                  struct rohc_buf *const uncomp_packet,
                                  size_t *const ip_hdr_len)
-	__attribute__((warn_unused_result, nonnull(1, 2, 3, 4)));
+	__attribute__((warn_unused_result, nonnull(1, 2, 4, 5)));
 static bool d_tcp_build_ip_hdr(const struct rohc_decomp_ctxt *const context,
                                const struct rohc_tcp_decoded_ip_values *const decoded,
+                               const size_t ip_hdr_nr,
+                               const bool use_hdrs_tmpl,
                                struct rohc_buf *const uncomp_packet,
                                size_t *const ip_hdr_len)
-	__attribute__((warn_unused_result, nonnull(1, 2, 3, 4)));
+	__attribute__((warn_unused_result, nonnull(1, 2, 5, 6)));
 static bool d_tcp_build_ip_hdrs(const struct rohc_decomp_ctxt *const context,
                                 const struct rohc_tcp_decoded_values *const decoded,
                                 struct rohc_buf *const uncomp_packet,
@@ -330,12 +458,11 @@ static rohc_status_t d_tcp_build_hdrs(const struct rohc_decomp *const decomp,
                                       struct rohc_buf *const uncomp_hdrs,
                                       size_t *const uncomp_hdrs_len)
 	__attribute__((warn_unused_result, nonnull(1, 2, 4, 5, 7, 8)));
-static bool d_tcp_check_uncomp_crc(const struct rohc_decomp *const decomp,
-                                   const struct rohc_decomp_ctxt *const context,
-                                   struct rohc_buf *const uncomp_hdrs,
+static bool d_tcp_check_uncomp_crc(const struct rohc_decomp_ctxt *const context,
                                    const rohc_crc_type_t crc_type,
+                                   const uint8_t crc_computed,
                                    const uint8_t crc_packet)
-	__attribute__((warn_unused_result, nonnull(1, 2, 3)));
+	__attribute__((warn_unused_result, nonnull(1)));
 
 /* CRC repair */
 static bool d_tcp_attempt_repair(const struct rohc_decomp *const decomp,
@@ -344,6 +471,10 @@ static bool d_tcp_attempt_repair(const struct rohc_decomp *const decomp,
                                  struct rohc_decomp_crc_corr_ctxt *const crc_corr,
                                  struct rohc_tcp_extr_bits *const bits)
 	__attribute__((warn_unused_result, nonnull(1, 2, 4, 5)));
+static bool d_tcp_attempt_late(const struct rohc_decomp *const decomp,
+                               const struct rohc_decomp_ctxt *const context,
+                               struct rohc_tcp_extr_bits *const bits)
+	__attribute__((warn_unused_result, nonnull(1, 2, 3)));
 
 /* updating context */
 static void d_tcp_update_ctxt(struct rohc_decomp_ctxt *const context,
@@ -369,167 +500,63 @@ static bool d_tcp_create(const struct rohc_decomp_ctxt *const context,
                          struct rohc_decomp_volat_ctxt *const volat_ctxt)
 {
 	struct d_tcp_context *tcp_context;
+	struct rohc_ctxt_arena arena;
 
-	/* allocate memory for the context */
-	*persist_ctxt = malloc(sizeof(struct d_tcp_context));
-	if((*persist_ctxt) == NULL)
+	/* get one memory block for the persistent part of the context */
+	if(rohc_decomp_ctxt_block_get(context, D_TCP_CTXT_BLOCK_LEN,
+	                              &arena) == NULL)
 	{
 		rohc_error(context->decompressor, ROHC_TRACE_DECOMP, context->profile->id,
 		           "not enough memory for the TCP decompression context");
 		goto quit;
 	}
-	tcp_context = *persist_ctxt;
-	memset(tcp_context, 0, sizeof(struct d_tcp_context));
+	tcp_context = rohc_ctxt_arena_alloc(&arena, sizeof(struct d_tcp_context));
+	*persist_ctxt = tcp_context;
 
-	/* create the LSB decoding context for the MSN */
-	tcp_context->msn_lsb_ctxt = rohc_lsb_new(16);
-	if(tcp_context->msn_lsb_ctxt == NULL)
-	{
-		rohc_error(context->decompressor, ROHC_TRACE_DECOMP, context->profile->id,
-		           "failed to create the LSB decoding context for the MSN");
-		goto destroy_context;
-	}
+	/* init the LSB decoding context for the MSN */
+	rohc_lsb_ref16_init(&tcp_context->msn_lsb_ctxt);
 
-	/* create the LSB decoding context for the innermost IP-ID */
-	tcp_context->ip_id_lsb_ctxt = rohc_lsb_new(16);
-	if(tcp_context->ip_id_lsb_ctxt == NULL)
-	{
-		rohc_error(context->decompressor, ROHC_TRACE_DECOMP, context->profile->id,
-		           "failed to create the LSB decoding context for the innermost "
-		           "IP-ID");
-		goto free_lsb_msn;
-	}
+	/* init the LSB decoding context for the innermost IP-ID */
+	rohc_lsb_ref16_init(&tcp_context->ip_id_lsb_ctxt);
 
-	/* create the LSB decoding context for the innermost TTL/HL */
-	tcp_context->ttl_hl_lsb_ctxt = rohc_lsb_new(8);
-	if(tcp_context->ttl_hl_lsb_ctxt == NULL)
-	{
-		rohc_error(context->decompressor, ROHC_TRACE_DECOMP, context->profile->id,
-		           "failed to create the LSB decoding context for the innermost "
-		           "TTL/HL");
-		goto free_lsb_ip_id;
-	}
+	/* init the LSB decoding context for the innermost TTL/HL */
+	rohc_lsb_ref8_init(&tcp_context->ttl_hl_lsb_ctxt);
 
-	/* create the LSB decoding context for the TCP window */
-	tcp_context->window_lsb_ctxt = rohc_lsb_new(16);
-	if(tcp_context->window_lsb_ctxt == NULL)
-	{
-		rohc_error(context->decompressor, ROHC_TRACE_DECOMP, context->profile->id,
-		           "failed to create the LSB decoding context for the TCP window");
-		goto free_lsb_ttl_hl;
-	}
+	/* init the LSB decoding context for the TCP window */
+	rohc_lsb_ref16_init(&tcp_context->window_lsb_ctxt);
 
-	/* create the LSB decoding context for the sequence number */
-	tcp_context->seq_lsb_ctxt = rohc_lsb_new(32);
-	if(tcp_context->seq_lsb_ctxt == NULL)
-	{
-		rohc_error(context->decompressor, ROHC_TRACE_DECOMP, context->profile->id,
-		           "failed to create the LSB decoding context for the sequence "
-		           "number");
-		goto free_lsb_window;
-	}
+	/* init the LSB decoding context for the sequence number */
+	rohc_lsb_ref32_init(&tcp_context->seq_lsb_ctxt);
 
-	/* create the LSB decoding context for the scaled sequence number */
-	tcp_context->seq_scaled_lsb_ctxt = rohc_lsb_new(32);
-	if(tcp_context->seq_scaled_lsb_ctxt == NULL)
-	{
-		rohc_error(context->decompressor, ROHC_TRACE_DECOMP, context->profile->id,
-		           "failed to create the LSB decoding context for the scaled "
-		           "sequence number");
-		goto free_lsb_seq;
-	}
+	/* init the LSB decoding context for the scaled sequence number */
+	rohc_lsb_ref32_init(&tcp_context->seq_scaled_lsb_ctxt);
 
-	/* create the LSB decoding context for the ACK number */
-	tcp_context->ack_lsb_ctxt = rohc_lsb_new(32);
-	if(tcp_context->ack_lsb_ctxt == NULL)
-	{
-		rohc_error(context->decompressor, ROHC_TRACE_DECOMP, context->profile->id,
-		           "failed to create the LSB decoding context for the ACK "
-		           "number");
-		goto free_lsb_scaled_seq;
-	}
+	/* init the LSB decoding context for the ACK number */
+	rohc_lsb_ref32_init(&tcp_context->ack_lsb_ctxt);
 
-	/* create the LSB decoding context for the scaled acknowledgment number */
-	tcp_context->ack_scaled_lsb_ctxt = rohc_lsb_new(32);
-	if(tcp_context->ack_scaled_lsb_ctxt == NULL)
-	{
-		rohc_error(context->decompressor, ROHC_TRACE_DECOMP, context->profile->id,
-		           "failed to create the LSB decoding context for the scaled "
-		           "acknowledgment number");
-		goto free_lsb_ack;
-	}
+	/* init the LSB decoding context for the scaled acknowledgment number */
+	rohc_lsb_ref32_init(&tcp_context->ack_scaled_lsb_ctxt);
 
 	/* the TCP source and destination ports will be initialized
 	 * with the IR packets */
 	tcp_context->tcp_src_port = 0xFFFF;
 	tcp_context->tcp_dst_port = 0xFFFF;
 
-	/* create the LSB decoding context for the TCP option Timestamp echo
+	/* init the LSB decoding context for the TCP option Timestamp echo
 	 * request */
-	tcp_context->opt_ts_req_lsb_ctxt = rohc_lsb_new(32);
-	if(tcp_context->opt_ts_req_lsb_ctxt == NULL)
-	{
-		rohc_error(context->decompressor, ROHC_TRACE_DECOMP, context->profile->id,
-		           "failed to create the LSB decoding context for the TCP "
-		           "option Timestamp echo request");
-		goto free_lsb_scaled_ack;
-	}
+	rohc_lsb_ref32_init(&tcp_context->opt_ts_req_lsb_ctxt);
 
-	/* create the LSB decoding context for the TCP option Timestamp echo
+	/* init the LSB decoding context for the TCP option Timestamp echo
 	 * reply */
-	tcp_context->opt_ts_rep_lsb_ctxt = rohc_lsb_new(32);
-	if(tcp_context->opt_ts_rep_lsb_ctxt == NULL)
-	{
-		rohc_error(context->decompressor, ROHC_TRACE_DECOMP, context->profile->id,
-		           "failed to create the LSB decoding context for the TCP "
-		           "option Timestamp echo reply");
-		goto free_lsb_ts_opt_req;
-	}
+	rohc_lsb_ref32_init(&tcp_context->opt_ts_rep_lsb_ctxt);
 
-	/* volatile part of the decompression context */
+	/* volatile part of the decompression context, the extracted bits and
+	 * the decoded values are in the scratch memory of the decompressor */
 	volat_ctxt->crc.type = ROHC_CRC_TYPE_NONE;
 	volat_ctxt->crc.bits_nr = 0;
-	volat_ctxt->extr_bits = malloc(sizeof(struct rohc_tcp_extr_bits));
-	if(volat_ctxt->extr_bits == NULL)
-	{
-		rohc_decomp_warn(context, "failed to allocate memory for the volatile part "
-		                 "of one of the TCP decompression context");
-		goto free_lsb_ts_opt_rep;
-	}
-	volat_ctxt->decoded_values = malloc(sizeof(struct rohc_tcp_decoded_values));
-	if(volat_ctxt->decoded_values == NULL)
-	{
-		rohc_decomp_warn(context, "failed to allocate memory for the volatile part "
-		                 "of one of the TCP decompression context");
-		goto free_extr_bits;
-	}
 
 	return true;
 
-free_extr_bits:
-	zfree(volat_ctxt->extr_bits);
-free_lsb_ts_opt_rep:
-	rohc_lsb_free(tcp_context->opt_ts_rep_lsb_ctxt);
-free_lsb_ts_opt_req:
-	rohc_lsb_free(tcp_context->opt_ts_req_lsb_ctxt);
-free_lsb_scaled_ack:
-	rohc_lsb_free(tcp_context->ack_scaled_lsb_ctxt);
-free_lsb_ack:
-	rohc_lsb_free(tcp_context->ack_lsb_ctxt);
-free_lsb_scaled_seq:
-	rohc_lsb_free(tcp_context->seq_scaled_lsb_ctxt);
-free_lsb_seq:
-	rohc_lsb_free(tcp_context->seq_lsb_ctxt);
-free_lsb_window:
-	rohc_lsb_free(tcp_context->window_lsb_ctxt);
-free_lsb_ttl_hl:
-	rohc_lsb_free(tcp_context->ttl_hl_lsb_ctxt);
-free_lsb_ip_id:
-	rohc_lsb_free(tcp_context->ip_id_lsb_ctxt);
-free_lsb_msn:
-	rohc_lsb_free(tcp_context->msn_lsb_ctxt);
-destroy_context:
-	zfree(tcp_context);
 quit:
 	return false;
 }
@@ -541,41 +568,33 @@ quit:
  * This function is one of the functions that must exist in one profile for the
  * framework to work.
  *
+ * @param context      The decompression context
  * @param tcp_context  The persistent decompression context for the TCP profile
  * @param volat_ctxt   The volatile decompression context
  */
-static void d_tcp_destroy(struct d_tcp_context *const tcp_context,
-                          const struct rohc_decomp_volat_ctxt *const volat_ctxt)
+static void d_tcp_destroy(const struct rohc_decomp_ctxt *const context,
+                          struct d_tcp_context *const tcp_context,
+                          const struct rohc_decomp_volat_ctxt *const volat_ctxt __attribute__((unused)))
 {
-	/* destroy the LSB decoding context for the TCP option Timestamp echo
-	 * request */
-	rohc_lsb_free(tcp_context->opt_ts_req_lsb_ctxt);
-	/* destroy the LSB decoding context for the TCP option Timestamp echo
-	 * reply */
-	rohc_lsb_free(tcp_context->opt_ts_rep_lsb_ctxt);
-	/* destroy the LSB decoding context for the scaled acknowledgment number */
-	rohc_lsb_free(tcp_context->ack_scaled_lsb_ctxt);
-	/* destroy the LSB decoding context for the ACK number */
-	rohc_lsb_free(tcp_context->ack_lsb_ctxt);
-	/* destroy the LSB decoding context for the scaled sequence number */
-	rohc_lsb_free(tcp_context->seq_scaled_lsb_ctxt);
-	/* destroy the LSB decoding context for the sequence number */
-	rohc_lsb_free(tcp_context->seq_lsb_ctxt);
-	/* destroy the LSB decoding context for the TCP window */
-	rohc_lsb_free(tcp_context->window_lsb_ctxt);
-	/* destroy the LSB decoding context for the innermost TTL/HL */
-	rohc_lsb_free(tcp_context->ttl_hl_lsb_ctxt);
-	/* destroy the LSB decoding context for the innermost IP-ID */
-	rohc_lsb_free(tcp_context->ip_id_lsb_ctxt);
-	/* destroy the LSB decoding context for the MSN */
-	rohc_lsb_free(tcp_context->msn_lsb_ctxt);
-
-	/* free the TCP decompression context itself */
-	free(tcp_context);
-
-	/* free the volatile part of the decompression context */
-	free(volat_ctxt->decoded_values);
-	free(volat_ctxt->extr_bits);
+	size_t opt_index;
+
+	/* release the option data of the generic options stored for the context */
+	for(opt_index = TCP_INDEX_GENERIC7; opt_index <= MAX_TCP_OPTION_INDEX;
+	    opt_index++)
+	{
+		if(tcp_context->tcp_opts.bits[opt_index].used)
+		{
+			rohc_load_pool_put(&context->decompressor->loads_pool,
+			                   tcp_context->tcp_opts.bits[opt_index].data.generic.load_ref);
+		}
+	}
+
+	/* forget the static chain of the last IR packet */
+	rohc_decomp_static_chain_free(context, &tcp_context->static_chain);
+
+	/* give the memory block of the TCP decompression context back to the
+	 * pool */
+	rohc_decomp_ctxt_block_put(context, tcp_context);
 }
 
 
@@ -644,80 +663,8 @@ static rohc_packet_t tcp_detect_packet_type(const struct rohc_decomp_ctxt *const
 		                  "0x%02x and innermost IP-ID behavior %s", rohc_packet[0],
 		                  tcp_ip_id_behavior_get_descr(innermost_ip_id_behavior));
 
-		if(rohc_packet[0] & 0x80)
-		{
-			switch(rohc_packet[0] & 0xf0)
-			{
-				case 0x80: /* 1000 = seq_5 / rnd_5 */
-					type = (is_ip_id_seq ? ROHC_PACKET_TCP_SEQ_5 : ROHC_PACKET_TCP_RND_5);
-					break;
-				case 0x90: /* 1001 = seq_3 / rnd_5 */
-					type = (is_ip_id_seq ? ROHC_PACKET_TCP_SEQ_3 : ROHC_PACKET_TCP_RND_5);
-					break;
-				case 0xa0: /* 1010 = seq_1 / rnd_6 */
-					type = (is_ip_id_seq ? ROHC_PACKET_TCP_SEQ_1 : ROHC_PACKET_TCP_RND_6);
-					break;
-				case 0xb0: /* 1011 = seq_8 / rnd_1 / rnd_7 / rnd_8 */
-					if(is_ip_id_seq)
-					{
-						type = ROHC_PACKET_TCP_SEQ_8;
-					}
-					else if(rohc_packet[0] & 0x08)
-					{
-						if(rohc_packet[0] & 0x04)
-						{
-							type = ROHC_PACKET_TCP_RND_7;
-						}
-						else
-						{
-							type = ROHC_PACKET_TCP_RND_1;
-						}
-					}
-					else
-					{
-						type = ROHC_PACKET_TCP_RND_8;
-					}
-					break;
-				case 0xc0: /* 1100 = seq_7 / rnd_2 */
-					type = (is_ip_id_seq ? ROHC_PACKET_TCP_SEQ_7 : ROHC_PACKET_TCP_RND_2);
-					break;
-				case 0xd0: /* 1101 = seq_2 / seq_6 / rnd_4 */
-					if(is_ip_id_seq)
-					{
-						if(rohc_packet[0] & 0x08)
-						{
-							type = ROHC_PACKET_TCP_SEQ_6;
-						}
-						else
-						{
-							type = ROHC_PACKET_TCP_SEQ_2;
-						}
-					}
-					else
-					{
-						type = ROHC_PACKET_TCP_RND_4;
-					}
-					break;
-				case 0xf0: /* 1111 = common */
-					if((rohc_packet[0] & 0xfe) == 0xfa)
-					{
-						type = ROHC_PACKET_TCP_CO_COMMON;
-					}
-					else
-					{
-						type = ROHC_PACKET_UNKNOWN;
-					}
-					break;
-				default:
-					type = ROHC_PACKET_UNKNOWN;
-					break;
-			}
-		}
-		else
-		{
-			/* seq_4 / rnd_3 */
-			type = (is_ip_id_seq ? ROHC_PACKET_TCP_SEQ_4 : ROHC_PACKET_TCP_RND_3);
-		}
+		/* seq_* or rnd_* packet depending on the IP-ID behavior, or co_common */
+		type = d_tcp_pkt_types[is_ip_id_seq][rohc_packet[0]];
 	}
 
 	return type;
@@ -804,6 +751,7 @@ static bool d_tcp_parse_ir(const struct rohc_decomp_ctxt *const context,
                            struct rohc_tcp_extr_bits *const bits,
                            size_t *const rohc_hdr_len)
 {
+	const struct d_tcp_context *const tcp_context = context->persist_ctxt;
 	const uint8_t *remain_data;
 	size_t remain_len;
 	size_t static_chain_len;
@@ -837,12 +785,25 @@ static bool d_tcp_parse_ir(const struct rohc_decomp_ctxt *const context,
 	remain_data++;
 	remain_len--;
 
-	/* parse static chain */
-	if(!tcp_parse_static_chain(context, remain_data, remain_len,
-	                           bits, &static_chain_len))
+	/* skip the static chain if it is the one kept by the context, the static
+	 * fields are then taken from the context as for IR-DYN packets */
+	if(rohc_decomp_static_chain_match(context, &tcp_context->static_chain,
+	                                  remain_data, remain_len))
 	{
-		rohc_decomp_warn(context, "failed to parse the static chain");
-		goto error;
+		rohc_decomp_debug(context, "%zu-byte static chain is the one of the "
+		                  "context", tcp_context->static_chain.len);
+		static_chain_len = tcp_context->static_chain.len;
+	}
+	else
+	{
+		if(!tcp_parse_static_chain(context, remain_data, remain_len,
+		                           bits, &static_chain_len))
+		{
+			rohc_decomp_warn(context, "failed to parse the static chain");
+			goto error;
+		}
+		bits->static_chain = remain_data;
+		bits->static_chain_len = static_chain_len;
 	}
 	remain_data += static_chain_len;
 	remain_len -= static_chain_len;
@@ -981,8 +942,6 @@ error:
  * @param[out] rohc_hdr_len  The length of the ROHC header (in bytes)
  * @return                   true if parsing was successful,
  *                           false if packet was malformed
- *
- * @todo TODO: avoid malloc/free of packed_rohc_packet
  */
 static bool d_tcp_parse_CO(const struct rohc_decomp_ctxt *const context,
                            const uint8_t *const rohc_packet,
@@ -993,9 +952,10 @@ static bool d_tcp_parse_CO(const struct rohc_decomp_ctxt *const context,
                            struct rohc_tcp_extr_bits *const bits,
                            size_t *const rohc_hdr_len)
 {
-	const size_t packed_rohc_packet_max_len = 0xffff + 100;
-	uint8_t *packed_rohc_packet = malloc(packed_rohc_packet_max_len); // TODO: change that
 	const struct d_tcp_context *const tcp_context = context->persist_ctxt;
+	uint8_t base_hdr_copy[D_TCP_CO_BASE_HDR_MAX_LEN];
+	const uint8_t *base_hdr;
+	size_t base_hdr_max_len;
 	int ret;
 
 	/* remaining ROHC data not parsed yet */
@@ -1042,18 +1002,27 @@ static bool d_tcp_parse_CO(const struct rohc_decomp_ctxt *const context,
 		goto error;
 	}
 
-	/* copy the first byte of header over the last byte of the large CID field
-	 * to be able to map packet strutures to the ROHC bytes */
-	if((rohc_remain_len - large_cid_len) > packed_rohc_packet_max_len)
+	/* the base header is made of the first byte of the packet and of the
+	 * bytes after the large CID field: parse it in place if there is no large
+	 * CID field, otherwise copy its few bytes to map packet structures on
+	 * them; the rest of the packet is always parsed in place */
+	if(large_cid_len == 0)
 	{
-		rohc_decomp_warn(context, "internal problem: internal buffer too small");
-		goto error;
+		base_hdr = rohc_packet;
+		base_hdr_max_len = rohc_remain_len;
+	}
+	else
+	{
+		base_hdr_max_len = rohc_remain_len - large_cid_len;
+		if(base_hdr_max_len > D_TCP_CO_BASE_HDR_MAX_LEN)
+		{
+			base_hdr_max_len = D_TCP_CO_BASE_HDR_MAX_LEN;
+		}
+		base_hdr_copy[0] = rohc_packet[0];
+		memcpy(base_hdr_copy + 1, rohc_packet + 1 + large_cid_len,
+		       base_hdr_max_len - 1);
+		base_hdr = base_hdr_copy;
 	}
-	packed_rohc_packet[0] = rohc_packet[0];
-	memcpy(packed_rohc_packet + 1, rohc_packet + 1 + large_cid_len,
-	       rohc_remain_len - 1 - large_cid_len);
-	rohc_remain_data = packed_rohc_packet;
-	rohc_remain_len -= large_cid_len;
 	*rohc_hdr_len = 0;
 
 	/* parse the packet type we detected earlier */
@@ -1118,19 +1087,20 @@ static bool d_tcp_parse_CO(const struct rohc_decomp_ctxt *const context,
 	}
 	{
 		size_t co_pkt_len;
-		if(!parse_co_pkt(context, rohc_remain_data, rohc_remain_len,
+		if(!parse_co_pkt(context, base_hdr, base_hdr_max_len,
 		                 extr_crc, bits, &co_pkt_len, &has_opts_list))
 		{
 			rohc_decomp_warn(context, "failed to parse %s packet (type %d)",
 			                 rohc_get_packet_descr(packet_type), packet_type);
 			goto error;
 		}
-		rohc_remain_data += co_pkt_len;
-		rohc_remain_len -= co_pkt_len;
+		assert(co_pkt_len > 0);
+		assert(co_pkt_len <= base_hdr_max_len);
+		rohc_remain_data = rohc_packet + large_cid_len + co_pkt_len;
+		rohc_remain_len -= large_cid_len + co_pkt_len;
 		(*rohc_hdr_len) += co_pkt_len;
 	}
-	rohc_decomp_dump_buf(context, "ROHC base header", packed_rohc_packet,
-	                     *rohc_hdr_len);
+	rohc_decomp_dump_buf(context, "ROHC base header", base_hdr, *rohc_hdr_len);
 
 	/* innermost IP-ID behavior */
 	if(inner_ip_bits->id_behavior_nr > 0)
@@ -1157,7 +1127,7 @@ static bool d_tcp_parse_CO(const struct rohc_decomp_ctxt *const context,
 		                  "after the ROHC base header");
 		/* same list as in previous packets, but reset the 'present' flags ; the
 		 * list might be updated by irregular chain later */
-		memcpy(&bits->tcp_opts, &tcp_context->tcp_opts, sizeof(struct d_tcp_opts_ctxt));
+		d_tcp_opts_ctxt_copy(&bits->tcp_opts, &tcp_context->tcp_opts);
 		for(i = 0; i < ROHC_TCP_OPTS_MAX; i++)
 		{
 			bits->tcp_opts.expected_dynamic[i] = false;
@@ -1205,11 +1175,9 @@ static bool d_tcp_parse_CO(const struct rohc_decomp_ctxt *const context,
 	*rohc_hdr_len += large_cid_len;
 	assert((*rohc_hdr_len) <= rohc_length);
 
-	free(packed_rohc_packet);
 	return true;
 
 error:
-	free(packed_rohc_packet);
 	return false;
 }
 
@@ -2490,8 +2458,32 @@ static void d_tcp_reset_extr_bits(const struct rohc_decomp_ctxt *const context,
 	const struct d_tcp_context *const tcp_context = context->persist_ctxt;
 	size_t i;
 
-	/* set every bits and sizes to 0 */
-	memset(bits, 0, sizeof(struct rohc_tcp_extr_bits));
+	/* set every bits and sizes to 0: the large arrays of IPv6 extension
+	 * headers and of TCP options are only reset where the previous packet
+	 * touched them */
+	for(i = 0; i < ROHC_TCP_MAX_IP_HDRS; i++)
+	{
+		struct rohc_tcp_extr_ip_bits *const ip_bits = &(bits->ip[i]);
+		size_t opts_dirty_nr = ip_bits->opts_ctxt_nr;
+
+		/* the static chain may fail after touching one more extension header */
+		if((ip_bits->opts_nr + 1) > opts_dirty_nr)
+		{
+			opts_dirty_nr = ip_bits->opts_nr + 1;
+		}
+		if(opts_dirty_nr > ROHC_TCP_MAX_IP_EXT_HDRS)
+		{
+			opts_dirty_nr = ROHC_TCP_MAX_IP_EXT_HDRS;
+		}
+		memset(ip_bits, 0, offsetof(struct rohc_tcp_extr_ip_bits, opts));
+		memset(ip_bits->opts, 0, opts_dirty_nr * sizeof(ip_option_context_t));
+		ip_bits->opts_nr = 0;
+		ip_bits->opts_len = 0;
+		ip_bits->opts_ctxt_nr = 0;
+	}
+	memset(((uint8_t *) bits) + offsetof(struct rohc_tcp_extr_bits, ip_nr), 0,
+	       offsetof(struct rohc_tcp_extr_bits, tcp_opts) -
+	       offsetof(struct rohc_tcp_extr_bits, ip_nr));
 
 	/* if context handled at least one packet, init the list of IP headers */
 	if(context->num_recv_packets >= 1)
@@ -2507,6 +2499,7 @@ static void d_tcp_reset_extr_bits(const struct rohc_decomp_ctxt *const context,
 
 				bits->ip[i].opts_nr = tcp_context->ip_contexts[i].opts_nr;
 				bits->ip[i].opts_len = tcp_context->ip_contexts[i].opts_len;
+				bits->ip[i].opts_ctxt_nr = bits->ip[i].opts_nr;
 				for(j = 0; j < bits->ip[i].opts_nr; j++)
 				{
 					bits->ip[i].opts[j].len = tcp_context->ip_contexts[i].opts[j].len;
@@ -2533,14 +2526,7 @@ static void d_tcp_reset_extr_bits(const struct rohc_decomp_ctxt *const context,
 	}
 
 	/* no parsed TCP options at the beginning */
-	bits->tcp_opts.nr = 0;
-	memset(bits->tcp_opts.bits, 0,
-	       (MAX_TCP_OPTION_INDEX + 1) * sizeof(struct d_tcp_opt_ctxt));
-	for(i = 0; i < ROHC_TCP_OPTS_MAX; i++)
-	{
-		bits->tcp_opts.expected_dynamic[i] = false;
-		bits->tcp_opts.found[i] = false;
-	}
+	d_tcp_opts_ctxt_reset(&bits->tcp_opts);
 }
 
 
@@ -2569,19 +2555,11 @@ static bool d_tcp_decode_bits(const struct rohc_decomp_ctxt *const context,
 	}
 	else
 	{
-		uint32_t msn_decoded32;
-
 		assert(bits->msn.bits_nr > 0); /* all packets contain some MSN bits */
 
-		if(!rohc_lsb_decode(tcp_context->msn_lsb_ctxt, ROHC_LSB_REF_0, 0,
-		                    bits->msn.bits, bits->msn.bits_nr, bits->msn.p,
-		                    &msn_decoded32))
-		{
-			rohc_decomp_warn(context, "failed to decode %zu MSN bits 0x%x",
-			                 bits->msn.bits_nr, bits->msn.bits);
-			goto error;
-		}
-		decoded->msn = (uint16_t) (msn_decoded32 & 0xffff);
+		decoded->msn = rohc_lsb_ref16_decode(&tcp_context->msn_lsb_ctxt,
+		                                     bits->msn.bits, bits->msn.bits_nr,
+		                                     bits->msn.p);
 		rohc_decomp_debug(context, "decoded MSN = 0x%04x (%zu bits 0x%x)",
 		                  decoded->msn, bits->msn.bits_nr, bits->msn.bits);
 	}
@@ -2591,6 +2569,12 @@ static bool d_tcp_decode_bits(const struct rohc_decomp_ctxt *const context,
 	decoded->ttl_dyn_chain_flag = bits->ttl_dyn_chain_flag;
 	decoded->ttl_irreg_chain_flag = bits->ttl_irreg_chain_flag;
 
+	/* without static chain, the static part of the uncompressed headers is the
+	 * one of the context that was rendered in the header templates */
+	decoded->use_hdrs_tmpl = (tcp_context->hdrs_tmpl_valid && bits->src_port_nr == 0);
+	decoded->static_chain = bits->static_chain;
+	decoded->static_chain_len = bits->static_chain_len;
+
 	/* decode IP headers */
 	if(!d_tcp_decode_bits_ip_hdrs(context, bits, decoded))
 	{
@@ -2638,7 +2622,7 @@ static bool d_tcp_decode_bits_ip_hdrs(const struct rohc_decomp_ctxt *const conte
 		rohc_decomp_debug(context, "decode fields of IP header #%zu", ip_hdr_nr + 1);
 
 		if(!d_tcp_decode_bits_ip_hdr(context, ip_bits, ip_context, decoded->msn,
-		                             ip_decoded))
+		                             decoded->use_hdrs_tmpl, ip_decoded))
 		{
 			rohc_decomp_warn(context, "failed to decode received bits for IP "
 			                 "header #%zu", ip_hdr_nr + 1);
@@ -2661,6 +2645,9 @@ error:
  * @param ip_bits          The IP bits extracted from the ROHC packet
  * @param ip_context       The IP values recorded in context
  * @param decoded_msn      The decoded Master Sequence Number (MSN)
+ * @param use_hdrs_tmpl    Whether the uncompressed header will be built from
+ *                         the header template of the context, so that the
+ *                         addresses do not need to be decoded
  * @param[out] ip_decoded  The corresponding decoded IP values
  * @return                 true if decoding is successful, false otherwise
  */
@@ -2668,6 +2655,7 @@ static bool d_tcp_decode_bits_ip_hdr(const struct rohc_decomp_ctxt *const contex
                                      const struct rohc_tcp_extr_ip_bits *const ip_bits,
                                      const ip_context_t *const ip_context,
                                      const uint16_t decoded_msn,
+                                     const bool use_hdrs_tmpl,
                                      struct rohc_tcp_decoded_ip_values *const ip_decoded)
 {
 	const struct d_tcp_context *const tcp_context = context->persist_ctxt;
@@ -2736,7 +2724,7 @@ static bool d_tcp_decode_bits_ip_hdr(const struct rohc_decomp_ctxt *const contex
 			}
 
 			/* decode IP-ID from packet bits and context */
-			if(!d_ip_id_lsb(context, tcp_context->ip_id_lsb_ctxt, decoded_msn,
+			if(!d_ip_id_lsb(context, &tcp_context->ip_id_lsb_ctxt, decoded_msn,
 			                ip_bits->id.bits, ip_bits->id.bits_nr, ip_bits->id.p,
 			                &ip_decoded->id))
 			{
@@ -2778,17 +2766,10 @@ static bool d_tcp_decode_bits_ip_hdr(const struct rohc_decomp_ctxt *const contex
 	}
 	else if(ip_bits->ttl_hl.bits_nr > 0)
 	{
-		uint32_t decoded32;
-
-		if(!rohc_lsb_decode(tcp_context->ttl_hl_lsb_ctxt, ROHC_LSB_REF_0, 0,
-		                    ip_bits->ttl_hl.bits, ip_bits->ttl_hl.bits_nr,
-		                    ROHC_LSB_SHIFT_TCP_TTL, &decoded32))
-		{
-			rohc_decomp_warn(context, "failed to decode %zu TTL/HL bits 0x%x",
-			                 ip_bits->ttl_hl.bits_nr, ip_bits->ttl_hl.bits);
-			goto error;
-		}
-		ip_decoded->ttl = (uint8_t) (decoded32 & 0xff);
+		ip_decoded->ttl = rohc_lsb_ref8_decode(&tcp_context->ttl_hl_lsb_ctxt,
+		                                       ip_bits->ttl_hl.bits,
+		                                       ip_bits->ttl_hl.bits_nr,
+		                                       ROHC_LSB_SHIFT_TCP_TTL);
 		rohc_decomp_debug(context, "  decoded TTL/HL = 0x%02x (%zu bits 0x%x)",
 		                  ip_decoded->ttl, ip_bits->ttl_hl.bits_nr,
 		                  ip_bits->ttl_hl.bits);
@@ -2869,6 +2850,10 @@ static bool d_tcp_decode_bits_ip_hdr(const struct rohc_decomp_ctxt *const contex
 		rohc_decomp_debug(context, "  %zu-byte source address (packet)",
 		                  ip_bits->saddr_nr / 8);
 	}
+	else if(use_hdrs_tmpl)
+	{
+		rohc_decomp_debug(context, "  source address (header template)");
+	}
 	else if(ip_decoded->version == IPV4)
 	{
 		memcpy(ip_decoded->saddr, &ip_context->ctxt.v4.src_addr, 4);
@@ -2887,6 +2872,10 @@ static bool d_tcp_decode_bits_ip_hdr(const struct rohc_decomp_ctxt *const contex
 		rohc_decomp_debug(context, "  %zu-byte destination address (packet)",
 		                  ip_bits->daddr_nr / 8);
 	}
+	else if(use_hdrs_tmpl)
+	{
+		rohc_decomp_debug(context, "  destination address (header template)");
+	}
 	else if(ip_decoded->version == IPV4)
 	{
 		memcpy(ip_decoded->daddr, &ip_context->ctxt.v4.dst_addr, 4);
@@ -2902,21 +2891,40 @@ static bool d_tcp_decode_bits_ip_hdr(const struct rohc_decomp_ctxt *const contex
 	assert(ip_bits->opts_nr <= ROHC_TCP_MAX_IP_EXT_HDRS);
 	ip_decoded->opts_nr = ip_bits->opts_nr;
 	ip_decoded->opts_len = ip_bits->opts_len;
+	ip_decoded->opts_sent = 0;
 	if(ip_bits->version == IPV6)
 	{
 		size_t ext_pos;
 
 		for(ext_pos = 0; ext_pos < ip_decoded->opts_nr; ext_pos++)
 		{
-			switch(ip_bits->opts[ext_pos].proto)
+			const ip_option_context_t *const ext_bits = &(ip_bits->opts[ext_pos]);
+			ip_option_context_t *const ext_decoded = &(ip_decoded->opts[ext_pos]);
+
+			switch(ext_bits->proto)
 			{
 				case ROHC_IPPROTO_HOPOPTS:
 				case ROHC_IPPROTO_DSTOPTS:
 				case ROHC_IPPROTO_ROUTING:
-					if(ip_bits->opts[ext_pos].generic.data_len > 0)
+					if(ext_bits->generic.data_len > 0)
 					{
-						memcpy(&(ip_decoded->opts[ext_pos]), &(ip_bits->opts[ext_pos]),
-						       sizeof(ip_option_context_t));
+						memcpy(ext_decoded, ext_bits, sizeof(ip_option_context_t));
+						ip_decoded->opts_sent |= (1U << ext_pos);
+					}
+					else
+					{
+						/* not transmitted, the data of the extension header is the
+						 * one of the context: the decoded values are shared by all
+						 * the contexts of the profile, so copy the data again */
+						const ip_option_context_t *const ext_ctxt =
+							&(ip_context->opts[ext_pos]);
+
+						ext_decoded->len = ext_bits->len;
+						ext_decoded->proto = ext_bits->proto;
+						ext_decoded->nh_proto = ext_bits->nh_proto;
+						ext_decoded->generic.data_len = ext_ctxt->generic.data_len;
+						memcpy(ext_decoded->generic.data, ext_ctxt->generic.data,
+						       ext_ctxt->generic.data_len);
 					}
 					break;
 				default:
@@ -2988,22 +2996,17 @@ static bool d_tcp_decode_bits_tcp_hdr(const struct rohc_decomp_ctxt *const conte
 	if(bits->seq_scaled.bits_nr > 0)
 	{
 		/* decode scaled sequence number from packet bits and context */
-		if(!rohc_lsb_is_ready(tcp_context->seq_scaled_lsb_ctxt))
+		if(!rohc_lsb_ref32_is_ready(&tcp_context->seq_scaled_lsb_ctxt))
 		{
 			rohc_decomp_warn(context, "failed to decode %zu scaled sequence number "
 			                 "bits 0x%x: scaled sequence number not initialized yet",
 			                 bits->seq_scaled.bits_nr, bits->seq_scaled.bits);
 			goto error;
 		}
-		if(!rohc_lsb_decode(tcp_context->seq_scaled_lsb_ctxt, ROHC_LSB_REF_0, 0,
-		                    bits->seq_scaled.bits, bits->seq_scaled.bits_nr,
-		                    bits->seq_scaled.p, &decoded->seq_num_scaled))
-		{
-			rohc_decomp_warn(context, "failed to decode %zu scaled sequence "
-			                 "number bits 0x%x with p = %d", bits->seq_scaled.bits_nr,
-			                 bits->seq_scaled.bits, bits->seq_scaled.p);
-			goto error;
-		}
+		decoded->seq_num_scaled =
+			rohc_lsb_ref32_decode(&tcp_context->seq_scaled_lsb_ctxt,
+			                      bits->seq_scaled.bits, bits->seq_scaled.bits_nr,
+			                      bits->seq_scaled.p);
 		rohc_decomp_debug(context, "  decoded scaled sequence number = 0x%08x "
 		                  "(%zu bits 0x%x with p = %d)", decoded->seq_num_scaled,
 		                  bits->seq_scaled.bits_nr, bits->seq_scaled.bits,
@@ -3035,15 +3038,9 @@ static bool d_tcp_decode_bits_tcp_hdr(const struct rohc_decomp_ctxt *const conte
 		else if(bits->seq.bits_nr > 0)
 		{
 			/* decode unscaled sequence number from packet bits and context */
-			if(!rohc_lsb_decode(tcp_context->seq_lsb_ctxt, ROHC_LSB_REF_0, 0,
-			                    bits->seq.bits, bits->seq.bits_nr, bits->seq.p,
-			                    &decoded->seq_num))
-			{
-				rohc_decomp_warn(context, "failed to decode TCP sequence number from "
-				                 "%zu-bit 0x%x with p = %d", bits->seq.bits_nr,
-				                 bits->seq.bits, bits->seq.p);
-				goto error;
-			}
+			decoded->seq_num =
+				rohc_lsb_ref32_decode(&tcp_context->seq_lsb_ctxt, bits->seq.bits,
+				                      bits->seq.bits_nr, bits->seq.p);
 			rohc_decomp_debug(context, "  TCP sequence number = 0x%08x (decoded from "
 			                  "%zu-bit 0x%x with p = %d)", decoded->seq_num,
 			                  bits->seq.bits_nr, bits->seq.bits, bits->seq.p);
@@ -3051,7 +3048,7 @@ static bool d_tcp_decode_bits_tcp_hdr(const struct rohc_decomp_ctxt *const conte
 		else
 		{
 			const uint32_t old_seq =
-				rohc_lsb_get_ref(tcp_context->seq_lsb_ctxt, ROHC_LSB_REF_0);
+				rohc_lsb_ref32_get(&tcp_context->seq_lsb_ctxt);
 			rohc_decomp_debug(context, "  TCP sequence number = 0x%08x (re-used from "
 			                  "previous packet)", old_seq);
 			decoded->seq_num = old_seq;
@@ -3080,15 +3077,10 @@ static bool d_tcp_decode_bits_tcp_hdr(const struct rohc_decomp_ctxt *const conte
 		assert(bits->ack_stride.bits_nr == 0);
 
 		/* decode scaled acknowledgement number from packet bits and context */
-		if(!rohc_lsb_decode(tcp_context->ack_scaled_lsb_ctxt, ROHC_LSB_REF_0, 0,
-		                    bits->ack_scaled.bits, bits->ack_scaled.bits_nr,
-		                    bits->ack_scaled.p, &decoded->ack_num_scaled))
-		{
-			rohc_decomp_warn(context, "failed to decode %zu scaled acknowledgement "
-			                 "number bits 0x%x with p = %d", bits->ack_scaled.bits_nr,
-			                 bits->ack_scaled.bits, bits->ack_scaled.p);
-			goto error;
-		}
+		decoded->ack_num_scaled =
+			rohc_lsb_ref32_decode(&tcp_context->ack_scaled_lsb_ctxt,
+			                      bits->ack_scaled.bits, bits->ack_scaled.bits_nr,
+			                      bits->ack_scaled.p);
 		rohc_decomp_debug(context, "  decoded scaled acknowledgement number = 0x%08x "
 		                  "(%zu bits 0x%x with p = %d)", decoded->ack_num_scaled,
 		                  bits->ack_scaled.bits_nr, bits->ack_scaled.bits,
@@ -3125,15 +3117,9 @@ static bool d_tcp_decode_bits_tcp_hdr(const struct rohc_decomp_ctxt *const conte
 		else if(bits->ack.bits_nr > 0)
 		{
 			/* decode unscaled acknowledgement number from packet bits and context */
-			if(!rohc_lsb_decode(tcp_context->ack_lsb_ctxt, ROHC_LSB_REF_0, 0,
-			                    bits->ack.bits, bits->ack.bits_nr, bits->ack.p,
-			                    &decoded->ack_num))
-			{
-				rohc_decomp_warn(context, "failed to decode TCP acknowledgement number "
-				                 "from %zu-bit 0x%x with p = %d", bits->ack.bits_nr,
-				                 bits->ack.bits, bits->ack.p);
-				goto error;
-			}
+			decoded->ack_num =
+				rohc_lsb_ref32_decode(&tcp_context->ack_lsb_ctxt, bits->ack.bits,
+				                      bits->ack.bits_nr, bits->ack.p);
 			rohc_decomp_debug(context, "  TCP ACK number = 0x%08x (decoded from "
 			                  "%zu-bit 0x%x with p = %d)", decoded->ack_num,
 			                  bits->ack.bits_nr, bits->ack.bits, bits->ack.p);
@@ -3141,7 +3127,7 @@ static bool d_tcp_decode_bits_tcp_hdr(const struct rohc_decomp_ctxt *const conte
 		else
 		{
 			const uint32_t old_ack =
-				rohc_lsb_get_ref(tcp_context->ack_lsb_ctxt, ROHC_LSB_REF_0);
+				rohc_lsb_ref32_get(&tcp_context->ack_lsb_ctxt);
 			rohc_decomp_debug(context, "  TCP ACK number = 0x%08x (re-used from "
 			                  "previous packet)", old_ack);
 			decoded->ack_num = old_ack;
@@ -3193,25 +3179,18 @@ static bool d_tcp_decode_bits_tcp_hdr(const struct rohc_decomp_ctxt *const conte
 	}
 	else if(bits->window.bits_nr > 0)
 	{
-		uint32_t win_decoded32;
-
 		/* decode TCP window from packet bits and context */
-		if(!rohc_lsb_decode(tcp_context->window_lsb_ctxt, ROHC_LSB_REF_0, 0,
-		                    bits->window.bits, bits->window.bits_nr, bits->window.p,
-		                    &win_decoded32))
-		{
-			rohc_decomp_warn(context, "failed to decode TCP window from %zu-bit "
-			                 "0x%x", bits->window.bits_nr, bits->window.bits);
-			goto error;
-		}
-		decoded->window = (uint16_t) (win_decoded32 & 0xffff);
+		decoded->window = rohc_lsb_ref16_decode(&tcp_context->window_lsb_ctxt,
+		                                        bits->window.bits,
+		                                        bits->window.bits_nr,
+		                                        bits->window.p);
 		rohc_decomp_debug(context, "  TCP window = 0x%04x (%zu-bit 0x%x)",
 		                  decoded->window, bits->window.bits_nr, bits->window.bits);
 	}
 	else
 	{
 		const uint16_t old_win =
-			rohc_lsb_get_ref(tcp_context->window_lsb_ctxt, ROHC_LSB_REF_0);
+			rohc_lsb_ref16_get(&tcp_context->window_lsb_ctxt);
 		rohc_decomp_debug(context, "  TCP window = 0x%04x (re-used from previous "
 		                  "packet)", old_win);
 		decoded->window = old_win;
@@ -3368,7 +3347,7 @@ static bool d_tcp_decode_bits_tcp_opts(const struct rohc_decomp_ctxt *const cont
 	rohc_decomp_debug(context, "decode TCP options");
 
 	/* copy the informations collected on TCP options */
-	memcpy(&decoded->tcp_opts, &bits->tcp_opts, sizeof(struct d_tcp_opts_ctxt));
+	d_tcp_opts_ctxt_copy(&decoded->tcp_opts, &bits->tcp_opts);
 
 	for(tcp_opt_id = 0; tcp_opt_id < decoded->tcp_opts.nr; tcp_opt_id++)
 	{
@@ -3410,7 +3389,7 @@ static bool d_tcp_decode_bits_tcp_opts(const struct rohc_decomp_ctxt *const cont
 		{
 			/* decode TS request field */
 			if(!d_tcp_decode_opt_ts_field(context, "request",
-			                              tcp_context->opt_ts_req_lsb_ctxt,
+			                              &tcp_context->opt_ts_req_lsb_ctxt,
 			                              bits->tcp_opts.bits[TCP_INDEX_TS].data.ts.req,
 			                              &decoded->opt_ts_req))
 			{
@@ -3423,7 +3402,7 @@ static bool d_tcp_decode_bits_tcp_opts(const struct rohc_decomp_ctxt *const cont
 
 			/* decode TS reply field */
 			if(!d_tcp_decode_opt_ts_field(context, "reply",
-			                              tcp_context->opt_ts_rep_lsb_ctxt,
+			                              &tcp_context->opt_ts_rep_lsb_ctxt,
 			                              bits->tcp_opts.bits[TCP_INDEX_TS].data.ts.rep,
 			                              &decoded->opt_ts_rep))
 			{
@@ -3442,16 +3421,50 @@ static bool d_tcp_decode_bits_tcp_opts(const struct rohc_decomp_ctxt *const cont
 		}
 		else if(opt_index >= TCP_INDEX_GENERIC7)
 		{
-			/* generic option: in case of static or stable encoding, retrieve option
-			 * data from the context */
+			/* generic option: in case of static or stable encoding, refer to the
+			 * option data stored for the context, without copying it */
 			if(bits->tcp_opts.bits[opt_index].data.generic.type == TCP_GENERIC_OPT_STATIC ||
 			   bits->tcp_opts.bits[opt_index].data.generic.type == TCP_GENERIC_OPT_STABLE)
 			{
-				opt_bits->data.generic.load_len =
-					tcp_context->tcp_opts.bits[opt_index].data.generic.load_len;
-				memcpy(opt_bits->data.generic.load,
-				       tcp_context->tcp_opts.bits[opt_index].data.generic.load,
-				       opt_bits->data.generic.load_len);
+				const struct d_tcp_opt_ctxt *const opt_ctxt =
+					&(tcp_context->tcp_opts.bits[opt_index]);
+
+				opt_bits->data.generic.load_len = opt_ctxt->data.generic.load_len;
+				opt_bits->data.generic.load = NULL;
+				opt_bits->data.generic.load_ref = opt_ctxt->data.generic.load_ref;
+			}
+		}
+	}
+
+	/* the option data of the generic options transmitted in the packet will
+	 * be stored for the context once the packet is accepted: make sure that
+	 * the pool of the decompressor has enough free slots for them */
+	{
+		size_t loads_nr[ROHC_LOAD_POOL_CLASSES_NR] = { 0 };
+		size_t opt_index;
+		size_t i;
+
+		for(opt_index = TCP_INDEX_GENERIC7; opt_index <= MAX_TCP_OPTION_INDEX;
+		    opt_index++)
+		{
+			const struct d_tcp_opt_ctxt *const opt_bits =
+				&(decoded->tcp_opts.bits[opt_index]);
+
+			if((decoded->tcp_opts.bits_dirty & (1U << opt_index)) != 0 &&
+			   opt_bits->used && opt_bits->data.generic.load != NULL &&
+			   opt_bits->data.generic.load_len > 0)
+			{
+				loads_nr[rohc_load_pool_class(opt_bits->data.generic.load_len)]++;
+			}
+		}
+		for(i = 0; i < ROHC_LOAD_POOL_CLASSES_NR; i++)
+		{
+			if(!rohc_load_pool_reserve(&context->decompressor->loads_pool, i,
+			                           loads_nr[i]))
+			{
+				rohc_decomp_warn(context, "failed to reserve memory for the data "
+				                 "of the TCP generic options");
+				goto error;
 			}
 		}
 	}
@@ -3479,7 +3492,7 @@ error:
  */
 static bool d_tcp_decode_opt_ts_field(const struct rohc_decomp_ctxt *const context,
                                       const char *const descr,
-                                      const struct rohc_lsb_decode *const lsb_ctxt,
+                                      const struct rohc_lsb_ref32 *const lsb_ctxt,
                                       const struct rohc_lsb_field32 ts,
                                       uint32_t *const ts_decoded)
 {
@@ -3491,7 +3504,7 @@ static bool d_tcp_decode_opt_ts_field(const struct rohc_decomp_ctxt *const conte
 	{
 		/* we cannot decode TS field if decompressor never received an uncompressed
 		 * value */
-		if(!rohc_lsb_is_ready(lsb_ctxt))
+		if(!rohc_lsb_ref32_is_ready(lsb_ctxt))
 		{
 			rohc_decomp_warn(context, "compressor sent a compressed TCP Timestamp "
 			                 "option, but uncompressed value was not received yet");
@@ -3499,17 +3512,11 @@ static bool d_tcp_decode_opt_ts_field(const struct rohc_decomp_ctxt *const conte
 		}
 
 		/* decode TS field from packet bits and context */
-		if(!rohc_lsb_decode(lsb_ctxt, ROHC_LSB_REF_0, 0, ts.bits, ts.bits_nr, ts.p,
-		                    ts_decoded))
-		{
-			rohc_decomp_warn(context, "failed to decode %zu TimeStamp option %s bits "
-			                 "0x%x with p = %u", ts.bits_nr, descr, ts.bits, ts.p);
-			goto error;
-		}
+		*ts_decoded = rohc_lsb_ref32_decode(lsb_ctxt, ts.bits, ts.bits_nr, ts.p);
 		rohc_decomp_debug(context, "decoded TimeStamp option %s = 0x%08x (%zu bits "
 		                  "0x%x with ref 0x%08x and p = %d)", descr, *ts_decoded,
 		                  ts.bits_nr, ts.bits,
-		                  rohc_lsb_get_ref(lsb_ctxt, ROHC_LSB_REF_0), ts.p);
+		                  rohc_lsb_ref32_get(lsb_ctxt), ts.p);
 	}
 
 	return true;
@@ -3595,7 +3602,8 @@ static bool d_tcp_build_ip_hdrs(const struct rohc_decomp_ctxt *const context,
 
 	assert(decoded->ip_nr > 0);
 
-	rohc_decomp_debug(context, "build the %zu IP headers", decoded->ip_nr);
+	rohc_decomp_debug(context, "build the %zu IP headers%s", decoded->ip_nr,
+	                  decoded->use_hdrs_tmpl ? " from the header templates" : "");
 
 	*ip_hdrs_len = 0;
 	for(ip_hdr_nr = 0; ip_hdr_nr < decoded->ip_nr; ip_hdr_nr++)
@@ -3604,7 +3612,8 @@ static bool d_tcp_build_ip_hdrs(const struct rohc_decomp_ctxt *const context,
 			&(decoded->ip[ip_hdr_nr]);
 		size_t ip_hdr_len = 0;
 
-		if(!d_tcp_build_ip_hdr(context, ip_decoded, uncomp_packet, &ip_hdr_len))
+		if(!d_tcp_build_ip_hdr(context, ip_decoded, ip_hdr_nr, decoded->use_hdrs_tmpl,
+		                       uncomp_packet, &ip_hdr_len))
 		{
 			rohc_decomp_warn(context, "failed to build uncompressed IP header #%zu",
 			                 ip_hdr_nr + 1);
@@ -3628,6 +3637,9 @@ error:
  *
  * @param context             The decompression context
  * @param decoded             The values decoded from the ROHC packet
+ * @param ip_hdr_nr           The index of the IP header
+ * @param use_hdrs_tmpl       Whether to start from the header template of
+ *                            the context or not
  * @param[out] uncomp_packet  The uncompressed packet being built
  * @param[out] ip_hdr_len     The length of the IP header (in bytes)
  * @return                    true if IP header was successfully built,
@@ -3636,12 +3648,19 @@ error:
  */
 static bool d_tcp_build_ip_hdr(const struct rohc_decomp_ctxt *const context,
                                const struct rohc_tcp_decoded_ip_values *const decoded,
+                               const size_t ip_hdr_nr,
+                               const bool use_hdrs_tmpl,
                                struct rohc_buf *const uncomp_packet,
                                size_t *const ip_hdr_len)
 {
+	const struct d_tcp_context *const tcp_context = context->persist_ctxt;
+
 	if(decoded->version == IPV4)
 	{
-		if(!d_tcp_build_ipv4_hdr(context, decoded, uncomp_packet, ip_hdr_len))
+		const struct ipv4_hdr *const tmpl =
+			(use_hdrs_tmpl ? &(tcp_context->ip_hdrs_tmpl[ip_hdr_nr].v4) : NULL);
+
+		if(!d_tcp_build_ipv4_hdr(context, decoded, tmpl, uncomp_packet, ip_hdr_len))
 		{
 			rohc_decomp_warn(context, "failed to build uncompressed IPv4 header");
 			goto error;
@@ -3649,7 +3668,10 @@ static bool d_tcp_build_ip_hdr(const struct rohc_decomp_ctxt *const context,
 	}
 	else
 	{
-		if(!d_tcp_build_ipv6_hdr(context, decoded, uncomp_packet, ip_hdr_len))
+		const struct ipv6_hdr *const tmpl =
+			(use_hdrs_tmpl ? &(tcp_context->ip_hdrs_tmpl[ip_hdr_nr].v6) : NULL);
+
+		if(!d_tcp_build_ipv6_hdr(context, decoded, tmpl, uncomp_packet, ip_hdr_len))
 		{
 			rohc_decomp_warn(context, "failed to build uncompressed IPv6 header");
 			goto error;
@@ -3663,14 +3685,34 @@ error:
 }
 
 
+/**
+ * @brief Build the static part of one uncompressed IPv4 header
+ *
+ * @param[out] ipv4  The IPv4 header being built
+ * @param decoded    The values decoded from the ROHC packet
+ */
+static void d_tcp_build_ipv4_static(struct ipv4_hdr *const ipv4,
+                                    const struct rohc_tcp_decoded_ip_values *const decoded)
+{
+	ipv4->version = decoded->version;
+	ipv4->ihl = sizeof(struct ipv4_hdr) / sizeof(uint32_t);
+	ipv4->protocol = decoded->proto;
+	memcpy(&ipv4->saddr, decoded->saddr, 4);
+	memcpy(&ipv4->daddr, decoded->daddr, 4);
+}
+
+
 /**
  * @brief Build one single uncompressed IPv4 header
  *
  * Build one single uncompressed IPv4 header from the context and packet
- * informations.
+ * informations. The static part is copied from the header template if any,
+ * only the dynamic fields are then written.
  *
  * @param context             The decompression context
  * @param decoded             The values decoded from the ROHC packet
+ * @param tmpl                The header template of the context,
+ *                            NULL to build the static part from \e decoded
  * @param[out] uncomp_packet  The uncompressed packet being built
  * @param[out] ip_hdr_len     The length of the IPv4 header (in bytes)
  * @return                    true if IPv4 header was successfully built,
@@ -3679,6 +3721,7 @@ error:
  */
 static bool d_tcp_build_ipv4_hdr(const struct rohc_decomp_ctxt *const context,
                                  const struct rohc_tcp_decoded_ip_values *const decoded,
+                                 const struct ipv4_hdr *const tmpl,
                                  struct rohc_buf *const uncomp_packet,
                                  size_t *const ip_hdr_len)
 {
@@ -3695,13 +3738,16 @@ static bool d_tcp_build_ipv4_hdr(const struct rohc_decomp_ctxt *const context,
 	}
 
 	/* static part */
-	ipv4->version = decoded->version;
+	if(tmpl != NULL)
+	{
+		memcpy(ipv4, tmpl, hdr_len);
+	}
+	else
+	{
+		d_tcp_build_ipv4_static(ipv4, decoded);
+	}
 	rohc_decomp_debug(context, "    version = %u", ipv4->version);
-	ipv4->ihl = hdr_len / sizeof(uint32_t);
 	rohc_decomp_debug(context, "    ihl = %u", ipv4->ihl);
-	ipv4->protocol = decoded->proto;
-	memcpy(&ipv4->saddr, decoded->saddr, 4);
-	memcpy(&ipv4->daddr, decoded->daddr, 4);
 
 	/* dynamic part */
 	ipv4->frag_off = 0;
@@ -3731,14 +3777,37 @@ error:
 }
 
 
+/**
+ * @brief Build the static part of one uncompressed IPv6 header
+ *
+ * The IPv6 extension headers are not part of it.
+ *
+ * @param[out] ipv6  The IPv6 header being built
+ * @param decoded    The values decoded from the ROHC packet
+ */
+static void d_tcp_build_ipv6_static(struct ipv6_hdr *const ipv6,
+                                    const struct rohc_tcp_decoded_ip_values *const decoded)
+{
+	ipv6->version = decoded->version;
+	ipv6_set_flow_label(ipv6, decoded->flowid);
+	ipv6->nh = decoded->proto;
+	memcpy(&ipv6->saddr, decoded->saddr, sizeof(struct ipv6_addr));
+	memcpy(&ipv6->daddr, decoded->daddr, sizeof(struct ipv6_addr));
+}
+
+
 /**
  * @brief Build one single uncompressed IPv6 header
  *
  * Build one single uncompressed IPv6 header - including IPv6 extension
- * headers - from the context and packet informations.
+ * headers - from the context and packet informations. The static part is
+ * copied from the header template if any, only the dynamic fields and the
+ * extension headers are then written.
  *
  * @param context             The decompression context
  * @param decoded             The values decoded from the ROHC packet
+ * @param tmpl                The header template of the context,
+ *                            NULL to build the static part from \e decoded
  * @param[out] uncomp_packet  The uncompressed packet being built
  * @param[out] ip_hdr_len     The length of the IPv6 header (in bytes)
  * @return                    true if IPv6 header was successfully built,
@@ -3747,6 +3816,7 @@ error:
  */
 static bool d_tcp_build_ipv6_hdr(const struct rohc_decomp_ctxt *const context,
                                  const struct rohc_tcp_decoded_ip_values *const decoded,
+                                 const struct ipv6_hdr *const tmpl,
                                  struct rohc_buf *const uncomp_packet,
                                  size_t *const ip_hdr_len)
 {
@@ -3769,14 +3839,17 @@ static bool d_tcp_build_ipv6_hdr(const struct rohc_decomp_ctxt *const context,
 	}
 
 	/* static part */
-	ipv6->version = decoded->version;
+	if(tmpl != NULL)
+	{
+		memcpy(ipv6, tmpl, hdr_len);
+	}
+	else
+	{
+		d_tcp_build_ipv6_static(ipv6, decoded);
+	}
 	rohc_decomp_debug(context, "    version = %u", ipv6->version);
-	ipv6_set_flow_label(ipv6, decoded->flowid);
 	rohc_decomp_debug(context, "    flow label = 0x%01x%04x",
 	                  ipv6->flow1, rohc_ntoh16(ipv6->flow2));
-	ipv6->nh = decoded->proto;
-	memcpy(&ipv6->saddr, decoded->saddr, sizeof(struct ipv6_addr));
-	memcpy(&ipv6->daddr, decoded->daddr, sizeof(struct ipv6_addr));
 
 	/* dynamic part */
 	ipv6_set_dscp_ecn(ipv6, decoded->dscp, decoded->ecn_flags);
@@ -3851,8 +3924,16 @@ static bool d_tcp_build_tcp_hdr(const struct rohc_decomp_ctxt *const context,
 	rohc_decomp_debug(context, "build %zu-byte TCP header", tcp_hdr_len);
 
 	/* TCP source & destination ports */
-	tcp->src_port = rohc_hton16(decoded->src_port);
-	tcp->dst_port = rohc_hton16(decoded->dst_port);
+	if(decoded->use_hdrs_tmpl)
+	{
+		const struct d_tcp_context *const tcp_context = context->persist_ctxt;
+		memcpy(tcp, &tcp_context->tcp_hdr_tmpl, tcp_hdr_len);
+	}
+	else
+	{
+		tcp->src_port = rohc_hton16(decoded->src_port);
+		tcp->dst_port = rohc_hton16(decoded->dst_port);
+	}
 	/* TCP sequence & acknowledgement numbers */
 	tcp->seq_num = rohc_hton32(decoded->seq_num);
 	tcp->ack_num = rohc_hton32(decoded->ack_num);
@@ -3928,12 +4009,27 @@ static rohc_status_t d_tcp_build_hdrs(const struct rohc_decomp *const decomp,
                                       struct rohc_buf *const uncomp_hdrs,
                                       size_t *const uncomp_hdrs_len)
 {
+	const struct d_tcp_context *const tcp_context = context->persist_ctxt;
+	const bool do_check_crc = (extr_crc->type != ROHC_CRC_TYPE_NONE);
+	uint8_t crc_computed;
 	size_t ip_hdrs_len = 0;
 	size_t tcp_hdr_len = 0;
 	size_t ip_hdr_nr;
 
 	rohc_decomp_debug(context, "build IP/TCP headers");
 
+	/* the CRC on uncompressed headers is accumulated header by header, as soon
+	 * as every header is complete and while it is still hot in cache, instead
+	 * of reading all the headers once more after they are built */
+	if(extr_crc->type == ROHC_CRC_TYPE_3)
+	{
+		crc_computed = CRC_INIT_3;
+	}
+	else
+	{
+		crc_computed = CRC_INIT_7;
+	}
+
 	*uncomp_hdrs_len = 0;
 
 	/* build IP headers */
@@ -3974,10 +4070,27 @@ static rohc_status_t d_tcp_build_hdrs(const struct rohc_decomp *const decomp,
 			rohc_decomp_debug(context, "    IP total length = 0x%04x (%u)",
 			                  ipv4_tot_len, ipv4_tot_len);
 			ipv4->check = 0;
-			ipv4->check =
-				ip_fast_csum(rohc_buf_data(*uncomp_hdrs), ipv4->ihl);
+			if(decoded->use_hdrs_tmpl)
+			{
+				/* only the dynamic fields differ from the header template */
+				ipv4->check =
+					rohc_csum_replace(tcp_context->ip_hdrs_tmpl_csum[ip_hdr_nr],
+					                  (const uint8_t *) &(tcp_context->ip_hdrs_tmpl[ip_hdr_nr]),
+					                  rohc_buf_data(*uncomp_hdrs),
+					                  offsetof(struct ipv4_hdr, check));
+			}
+			else
+			{
+				ipv4->check =
+					ip_fast_csum(rohc_buf_data(*uncomp_hdrs), ipv4->ihl);
+			}
 			rohc_decomp_debug(context, "    IP checksum = 0x%04x on %zu bytes",
 			                  rohc_ntoh16(ipv4->check), ipv4->ihl * sizeof(uint32_t));
+			if(do_check_crc)
+			{
+				crc_computed = crc_calculate(extr_crc->type, rohc_buf_data(*uncomp_hdrs),
+				                             ipv4->ihl * sizeof(uint32_t), crc_computed);
+			}
 			rohc_buf_pull(uncomp_hdrs, ipv4->ihl * sizeof(uint32_t));
 		}
 		else
@@ -3987,17 +4100,29 @@ static rohc_status_t d_tcp_build_hdrs(const struct rohc_decomp *const decomp,
 			ipv6->plen = rohc_hton16(uncomp_hdrs->len + payload_len);
 			rohc_decomp_debug(context, "    IPv6 payload length = %u",
 			                  rohc_ntoh16(ipv6->plen));
+			if(do_check_crc)
+			{
+				crc_computed = crc_calculate(extr_crc->type, (uint8_t *) ipv6,
+				                             sizeof(struct ipv6_hdr) + ip_decoded->opts_len,
+				                             crc_computed);
+			}
 			rohc_buf_pull(uncomp_hdrs, ip_decoded->opts_len);
 		}
 	}
+	/* the TCP header is complete since it was built */
+	if(do_check_crc)
+	{
+		crc_computed = crc_calculate(extr_crc->type, rohc_buf_data(*uncomp_hdrs),
+		                             uncomp_hdrs->len, crc_computed);
+	}
 	/* unhide the IP headers */
 	rohc_buf_push(uncomp_hdrs, ip_hdrs_len);
 
-	/* compute CRC on uncompressed headers if asked */
-	if(extr_crc->type != ROHC_CRC_TYPE_NONE)
+	/* check the CRC on uncompressed headers if asked */
+	if(do_check_crc)
 	{
-		const bool crc_ok = d_tcp_check_uncomp_crc(decomp, context, uncomp_hdrs,
-		                                           extr_crc->type, extr_crc->bits);
+		const bool crc_ok = d_tcp_check_uncomp_crc(context, extr_crc->type,
+		                                           crc_computed, extr_crc->bits);
 		if(!crc_ok)
 		{
 			rohc_decomp_warn(context, "CRC detected a decompression failure for "
@@ -4005,7 +4130,8 @@ static rohc_status_t d_tcp_build_hdrs(const struct rohc_decomp *const decomp,
 			                 rohc_get_packet_descr(packet_type),
 			                 rohc_decomp_get_state_descr(context->state),
 			                 rohc_get_mode_descr(context->mode));
-			if((decomp->features & ROHC_DECOMP_FEATURE_DUMP_PACKETS) != 0)
+			if(rohc_trace_is_enabled(decomp, ROHC_TRACE_WARNING) &&
+			   (decomp->features & ROHC_DECOMP_FEATURE_DUMP_PACKETS) != 0)
 			{
 				rohc_dump_packet(decomp->trace_callback, decomp->trace_callback_priv,
 				                 ROHC_TRACE_DECOMP, ROHC_TRACE_WARNING,
@@ -4015,7 +4141,8 @@ static rohc_status_t d_tcp_build_hdrs(const struct rohc_decomp *const decomp,
 		}
 	}
 
-	if((decomp->features & ROHC_DECOMP_FEATURE_DUMP_PACKETS) != 0)
+	if(rohc_trace_is_enabled(decomp, ROHC_TRACE_DEBUG) &&
+	   (decomp->features & ROHC_DECOMP_FEATURE_DUMP_PACKETS) != 0)
 	{
 		rohc_dump_packet(decomp->trace_callback, decomp->trace_callback_priv,
 		                 ROHC_TRACE_DECOMP, ROHC_TRACE_DEBUG,
@@ -4034,48 +4161,24 @@ error_output_too_small:
 /**
  * @brief Check whether the CRC on uncompressed header is correct or not
  *
- * @param decomp       The ROHC decompressor
- * @param context      The decompression context
- * @param uncomp_hdrs  The uncompressed headers
- * @param crc_type     The type of CRC
- * @param crc_packet   The CRC extracted from the ROHC header
- * @return             true if the CRC is correct, false otherwise
+ * @param context       The decompression context
+ * @param crc_type      The type of CRC
+ * @param crc_computed  The CRC computed on the built uncompressed headers
+ * @param crc_packet    The CRC extracted from the ROHC header
+ * @return              true if the CRC is correct, false otherwise
  */
-static bool d_tcp_check_uncomp_crc(const struct rohc_decomp *const decomp,
-                                   const struct rohc_decomp_ctxt *const context,
-                                   struct rohc_buf *const uncomp_hdrs,
+static bool d_tcp_check_uncomp_crc(const struct rohc_decomp_ctxt *const context,
                                    const rohc_crc_type_t crc_type,
+                                   const uint8_t crc_computed,
                                    const uint8_t crc_packet)
 {
-	const uint8_t *crc_table;
-	uint8_t crc_computed;
-
-	/* determine the initial value and the pre-computed table for the CRC */
-	switch(crc_type)
+	/* only 3-bit and 7-bit CRCs are used by the TCP profile */
+	if(crc_type != ROHC_CRC_TYPE_3 && crc_type != ROHC_CRC_TYPE_7)
 	{
-		case ROHC_CRC_TYPE_3:
-			crc_computed = CRC_INIT_3;
-			crc_table = decomp->crc_table_3;
-			break;
-		case ROHC_CRC_TYPE_7:
-			crc_computed = CRC_INIT_7;
-			crc_table = decomp->crc_table_7;
-			break;
-		case ROHC_CRC_TYPE_8:
-			rohc_decomp_warn(context, "unexpected CRC type %d", crc_type);
-			assert(0);
-			goto error;
-		case ROHC_CRC_TYPE_NONE:
-		default:
-			rohc_decomp_warn(context, "unknown CRC type %d", crc_type);
-			assert(0);
-			goto error;
+		rohc_decomp_warn(context, "unexpected CRC type %d", crc_type);
+		assert(0);
+		goto error;
 	}
-
-	/* compute the CRC from built uncompressed headers */
-	crc_computed =
-		crc_calculate(crc_type, rohc_buf_data(*uncomp_hdrs), uncomp_hdrs->len,
-		              crc_computed, crc_table);
 	rohc_decomp_debug(context, "CRC-%d on uncompressed header = 0x%x",
 	                  crc_type, crc_computed);
 
@@ -4117,6 +4220,24 @@ static bool d_tcp_attempt_repair(const struct rohc_decomp *const decomp __attrib
 }
 
 
+/**
+ * @brief Attempt to decode a late packet against a previous reference
+ *
+ * @param decomp        The ROHC decompressor
+ * @param context       The decompression context
+ * @param[in,out] bits  The bits extracted from the ROHC header
+ * @return              true if a new decoding attempt is possible,
+ *                      false if not
+ */
+static bool d_tcp_attempt_late(const struct rohc_decomp *const decomp __attribute__((unused)),
+                               const struct rohc_decomp_ctxt *const context __attribute__((unused)),
+                               struct rohc_tcp_extr_bits *const bits __attribute__((unused)))
+{
+	/* the TCP profile does not keep previous references */
+	return false;
+}
+
+
 /**
  * @brief Update the decompression context with the infos of current packet
  *
@@ -4140,7 +4261,7 @@ static void d_tcp_update_ctxt(struct rohc_decomp_ctxt *const context,
 	*do_change_mode = false;
 
 	/* MSN */
-	rohc_lsb_set_ref(tcp_context->msn_lsb_ctxt, msn, false);
+	rohc_lsb_ref16_set(&tcp_context->msn_lsb_ctxt, msn);
 	rohc_decomp_debug(context, "MSN 0x%04x / %u is the new reference", msn, msn);
 
 	/* update context for IP headers */
@@ -4171,7 +4292,7 @@ static void d_tcp_update_ctxt(struct rohc_decomp_ctxt *const context,
 			ip_context->ctxt.vx.ttl_hopl = ip_decoded->ttl;
 			if(is_inner)
 			{
-				rohc_lsb_set_ref(tcp_context->ttl_hl_lsb_ctxt, ip_decoded->ttl, false);
+				rohc_lsb_ref8_set(&tcp_context->ttl_hl_lsb_ctxt, ip_decoded->ttl);
 			}
 		}
 		ip_context->ctxt.vx.ip_id_behavior = ip_decoded->id_behavior;
@@ -4180,8 +4301,17 @@ static void d_tcp_update_ctxt(struct rohc_decomp_ctxt *const context,
 		{
 			ip_context->ctxt.v4.df = ip_decoded->df;
 			ip_context->ctxt.v4.ip_id = ip_decoded->id;
-			memcpy(&ip_context->ctxt.v4.src_addr, ip_decoded->saddr, 4);
-			memcpy(&ip_context->ctxt.v4.dst_addr, ip_decoded->daddr, 4);
+			if(!decoded->use_hdrs_tmpl)
+			{
+				struct ipv4_hdr *const tmpl = &(tcp_context->ip_hdrs_tmpl[ip_hdr_nr].v4);
+
+				memcpy(&ip_context->ctxt.v4.src_addr, ip_decoded->saddr, 4);
+				memcpy(&ip_context->ctxt.v4.dst_addr, ip_decoded->daddr, 4);
+				memset(tmpl, 0, sizeof(tcp_context->ip_hdrs_tmpl[ip_hdr_nr]));
+				d_tcp_build_ipv4_static(tmpl, ip_decoded);
+				tcp_context->ip_hdrs_tmpl_csum[ip_hdr_nr] =
+					ip_fast_csum((uint8_t *) tmpl, tmpl->ihl);
+			}
 
 			if(is_inner)
 			{
@@ -4194,7 +4324,7 @@ static void d_tcp_update_ctxt(struct rohc_decomp_ctxt *const context,
 				{
 					ip_id_offset = ip_context->ctxt.v4.ip_id - msn;
 				}
-				rohc_lsb_set_ref(tcp_context->ip_id_lsb_ctxt, ip_id_offset, false);
+				rohc_lsb_ref16_set(&tcp_context->ip_id_lsb_ctxt, ip_id_offset);
 				rohc_decomp_debug(context, "innermost IP-ID offset 0x%04x is the new "
 				                  "reference", ip_id_offset);
 			}
@@ -4211,10 +4341,18 @@ static void d_tcp_update_ctxt(struct rohc_decomp_ctxt *const context,
 
 			assert((ip_decoded->flowid & 0xfffff) == ip_decoded->flowid);
 			ip_context->ctxt.v6.flow_label = ip_decoded->flowid;
-			memcpy(&ip_context->ctxt.v6.src_addr, ip_decoded->saddr, 16);
-			memcpy(&ip_context->ctxt.v6.dest_addr, ip_decoded->daddr, 16);
+			if(!decoded->use_hdrs_tmpl)
+			{
+				memcpy(&ip_context->ctxt.v6.src_addr, ip_decoded->saddr, 16);
+				memcpy(&ip_context->ctxt.v6.dest_addr, ip_decoded->daddr, 16);
+				memset(&(tcp_context->ip_hdrs_tmpl[ip_hdr_nr]), 0,
+				       sizeof(tcp_context->ip_hdrs_tmpl[ip_hdr_nr]));
+				d_tcp_build_ipv6_static(&(tcp_context->ip_hdrs_tmpl[ip_hdr_nr].v6),
+				                        ip_decoded);
+			}
 
-			/* remember the extension headers */
+			/* remember the extension headers, only the ones transmitted in the
+			 * packet may differ from the context */
 			ip_context->opts_nr = ip_decoded->opts_nr;
 			ip_context->opts_len = ip_decoded->opts_len;
 			for(ext_pos = 0; ext_pos < ip_context->opts_nr; ext_pos++)
@@ -4222,6 +4360,10 @@ static void d_tcp_update_ctxt(struct rohc_decomp_ctxt *const context,
 				const size_t ext_len = ip_decoded->opts[ext_pos].len;
 				const uint8_t ext_proto = ip_decoded->opts[ext_pos].proto;
 
+				if((ip_decoded->opts_sent & (1U << ext_pos)) == 0)
+				{
+					continue;
+				}
 				rohc_decomp_debug(context, "  update context for the %zu-byte '%s' (%u) "
 				                  "extension header #%zu", ext_len,
 				                  rohc_get_ip_proto_descr(ext_proto), ext_proto,
@@ -4236,15 +4378,23 @@ static void d_tcp_update_ctxt(struct rohc_decomp_ctxt *const context,
 	/* TCP source & destination ports */
 	tcp_context->tcp_src_port = decoded->src_port;
 	tcp_context->tcp_dst_port = decoded->dst_port;
+	if(!decoded->use_hdrs_tmpl)
+	{
+		tcp_context->tcp_hdr_tmpl.src_port = rohc_hton16(decoded->src_port);
+		tcp_context->tcp_hdr_tmpl.dst_port = rohc_hton16(decoded->dst_port);
+		tcp_context->hdrs_tmpl_valid = true;
+		rohc_decomp_debug(context, "header templates rendered with the static "
+		                  "part of the %zu IP headers", decoded->ip_nr);
+	}
 
 	/* TCP (scaled) sequence number */
-	rohc_lsb_set_ref(tcp_context->seq_lsb_ctxt, decoded->seq_num, false);
+	rohc_lsb_ref32_set(&tcp_context->seq_lsb_ctxt, decoded->seq_num);
 	rohc_decomp_debug(context, "sequence number 0x%08x is the new reference",
 	                  decoded->seq_num);
 	if(payload_len != 0)
 	{
-		rohc_lsb_set_ref(tcp_context->seq_scaled_lsb_ctxt,
-		                 decoded->seq_num_scaled, false);
+		rohc_lsb_ref32_set(&tcp_context->seq_scaled_lsb_ctxt,
+		                   decoded->seq_num_scaled);
 		rohc_decomp_debug(context, "scaled sequence number 0x%08x is the new "
 		                  "reference", decoded->seq_num_scaled);
 		tcp_context->seq_num_residue = decoded->seq_num_residue;
@@ -4253,13 +4403,13 @@ static void d_tcp_update_ctxt(struct rohc_decomp_ctxt *const context,
 	}
 
 	/* TCP (scaled) acknowledgment number */
-	rohc_lsb_set_ref(tcp_context->ack_lsb_ctxt, decoded->ack_num, false);
+	rohc_lsb_ref32_set(&tcp_context->ack_lsb_ctxt, decoded->ack_num);
 	rohc_decomp_debug(context, "ACK number 0x%08x is the new reference",
 	                  decoded->ack_num);
 	if(decoded->ack_stride != 0)
 	{
-		rohc_lsb_set_ref(tcp_context->ack_scaled_lsb_ctxt,
-		                 decoded->ack_num_scaled, false);
+		rohc_lsb_ref32_set(&tcp_context->ack_scaled_lsb_ctxt,
+		                   decoded->ack_num_scaled);
 		rohc_decomp_debug(context, "scaled acknowledgment number 0x%08x is the new "
 		                  "reference", decoded->ack_num_scaled);
 		tcp_context->ack_stride = decoded->ack_stride;
@@ -4280,7 +4430,7 @@ static void d_tcp_update_ctxt(struct rohc_decomp_ctxt *const context,
 	tcp_context->ecn_used = decoded->ecn_used;
 
 	/* TCP window */
-	rohc_lsb_set_ref(tcp_context->window_lsb_ctxt, decoded->window, false);
+	rohc_lsb_ref16_set(&tcp_context->window_lsb_ctxt, decoded->window);
 	rohc_decomp_debug(context, "window 0x%04x is the new reference",
 	                  decoded->window);
 
@@ -4290,20 +4440,47 @@ static void d_tcp_update_ctxt(struct rohc_decomp_ctxt *const context,
 	/* TCP checksum is sent every time, nothing to update in context */
 	/* TCP Urgent pointer is sent every time, nothing to update in context */
 
-	/* copy the informations collected on TCP options */
-	tcp_context->tcp_opts.nr = decoded->tcp_opts.nr;
-	memcpy(&tcp_context->tcp_opts.structure, &decoded->tcp_opts.structure,
-	       sizeof(uint8_t) * ROHC_TCP_OPTS_MAX);
-	memcpy(&tcp_context->tcp_opts.expected_dynamic, &decoded->tcp_opts.expected_dynamic,
-	       sizeof(bool) * ROHC_TCP_OPTS_MAX);
-	memcpy(&tcp_context->tcp_opts.found, &decoded->tcp_opts.found,
-	       sizeof(bool) * ROHC_TCP_OPTS_MAX);
+	/* copy the informations collected on TCP options: the structure of the
+	 * list only changes when the list is transmitted, the per-packet flags
+	 * expected_dynamic and found are never read back from the context */
+	if(decoded->tcp_opts.structure_sent)
+	{
+		tcp_context->tcp_opts.nr = decoded->tcp_opts.nr;
+		memcpy(&tcp_context->tcp_opts.structure, &decoded->tcp_opts.structure,
+		       sizeof(uint8_t) * decoded->tcp_opts.nr);
+	}
 	for(i = 0; i <= MAX_TCP_OPTION_INDEX; i++)
 	{
-		if(decoded->tcp_opts.bits[i].used)
+		/* the options in use were touched by the packet */
+		if((decoded->tcp_opts.bits_dirty & (1U << i)) != 0 &&
+		   decoded->tcp_opts.bits[i].used)
 		{
-			memcpy(&tcp_context->tcp_opts.bits[i], &decoded->tcp_opts.bits[i],
-			       sizeof(struct d_tcp_opt_ctxt));
+			struct d_tcp_opt_ctxt *const opt_ctxt = &(tcp_context->tcp_opts.bits[i]);
+
+			if(i >= TCP_INDEX_GENERIC7)
+			{
+				/* the option data of generic options is stored in the pool of the
+				 * decompressor, in the slot already reserved while decoding */
+				const struct d_tcp_opt_ctxt *const opt_decoded =
+					&(decoded->tcp_opts.bits[i]);
+				rohc_load_ref_t load_ref = opt_ctxt->data.generic.load_ref;
+
+				if(opt_decoded->data.generic.load != NULL)
+				{
+					rohc_load_pool_store(&context->decompressor->loads_pool, &load_ref,
+					                     opt_decoded->data.generic.load,
+					                     opt_decoded->data.generic.load_len);
+				}
+				memcpy(opt_ctxt, opt_decoded, sizeof(struct d_tcp_opt_ctxt));
+				opt_ctxt->data.generic.load = NULL;
+				opt_ctxt->data.generic.load_ref = load_ref;
+			}
+			else
+			{
+				memcpy(opt_ctxt, &decoded->tcp_opts.bits[i],
+				       sizeof(struct d_tcp_opt_ctxt));
+			}
+			tcp_context->tcp_opts.bits_dirty |= (1U << i);
 		}
 	}
 	for(i = 0; i < decoded->tcp_opts.nr; i++)
@@ -4319,15 +4496,26 @@ static void d_tcp_update_ctxt(struct rohc_decomp_ctxt *const context,
 		/* specific actions for some TCP options */
 		if(opt_index == TCP_INDEX_TS)
 		{
-			rohc_lsb_set_ref(tcp_context->opt_ts_req_lsb_ctxt, decoded->opt_ts_req, false);
-			rohc_lsb_set_ref(tcp_context->opt_ts_rep_lsb_ctxt, decoded->opt_ts_rep, false);
+			rohc_lsb_ref32_set(&tcp_context->opt_ts_req_lsb_ctxt, decoded->opt_ts_req);
+			rohc_lsb_ref32_set(&tcp_context->opt_ts_rep_lsb_ctxt, decoded->opt_ts_rep);
 		}
-		else if(opt_index == TCP_INDEX_SACK)
+		else if(opt_index == TCP_INDEX_SACK &&
+		        decoded->tcp_opts.bits[opt_index].data.sack.blocks_nr > 0)
 		{
+			/* SACK blocks not transmitted were taken from the context */
 			memcpy(&tcp_context->opt_sack_blocks, &decoded->opt_sack_blocks,
 			       sizeof(struct d_tcp_opt_sack));
 		}
 	}
+
+	/* keep the new static chain to skip it in the next IR packets, the pool
+	 * slots reserved for the TCP options were taken above */
+	if(decoded->static_chain != NULL)
+	{
+		rohc_decomp_static_chain_store(context, &tcp_context->static_chain,
+		                               decoded->static_chain,
+		                               decoded->static_chain_len);
+	}
 }
 
 
@@ -4343,7 +4531,7 @@ static void d_tcp_update_ctxt(struct rohc_decomp_ctxt *const context,
 static uint32_t d_tcp_get_msn(const struct rohc_decomp_ctxt *const context)
 {
 	const struct d_tcp_context *const tcp_context = context->persist_ctxt;
-	const uint16_t msn = rohc_lsb_get_ref(tcp_context->msn_lsb_ctxt, ROHC_LSB_REF_0);
+	const uint16_t msn = rohc_lsb_ref16_get(&tcp_context->msn_lsb_ctxt);
 	rohc_decomp_debug(context, "MSN = %u (0x%x)", msn, msn);
 	return msn;
 }
@@ -4357,6 +4545,9 @@ const struct rohc_decomp_profile d_tcp_profile =
 {
 	.id              = ROHC_PROFILE_TCP, /* profile ID (see 8 in RFC3095) */
 	.msn_max_bits    = 16,
+	.ctxt_block_len  = D_TCP_CTXT_BLOCK_LEN,
+	.extr_bits_len   = sizeof(struct rohc_tcp_extr_bits),
+	.decoded_len     = sizeof(struct rohc_tcp_decoded_values),
 	.new_context     = (rohc_decomp_new_context_t) d_tcp_create,
 	.free_context    = (rohc_decomp_free_context_t) d_tcp_destroy,
 	.detect_pkt_type = tcp_detect_packet_type,
@@ -4365,6 +4556,7 @@ const struct rohc_decomp_profile d_tcp_profile =
 	.build_hdrs      = (rohc_decomp_build_hdrs_t) d_tcp_build_hdrs,
 	.update_ctxt     = (rohc_decomp_update_ctxt_t) d_tcp_update_ctxt,
 	.attempt_repair  = (rohc_decomp_attempt_repair_t) d_tcp_attempt_repair,
+	.attempt_late    = (rohc_decomp_attempt_late_t) d_tcp_attempt_late,
 	.get_sn          = d_tcp_get_msn
 };
 
@@ -31,6 +31,8 @@
 
 #include "ip.h"
 #include "interval.h"
+#include "rohc_load_pool.h"
+#include "rohc_decomp_internals.h"
 #include "protocols/tcp.h"
 #include "schemes/decomp_wlsb.h"
 #include "schemes/tcp_ts.h"
@@ -42,7 +44,7 @@
  * @brief Define the IPv6 option context for Destination, Hop-by-Hop
  *        and Routing option
  */
-typedef struct __attribute__((packed))
+typedef struct
 {
 	size_t data_len;
 	uint8_t data[IPV6_OPT_CTXT_LEN_MAX];
@@ -53,7 +55,7 @@ typedef struct __attribute__((packed))
 /**
  * @brief Define the IPv6 option context for GRE option
  */
-typedef struct __attribute__((packed)) ipv6_gre_option_context
+typedef struct ipv6_gre_option_context
 {
 	uint8_t c_flag:1;
 	uint8_t k_flag:1;
@@ -70,7 +72,7 @@ typedef struct __attribute__((packed)) ipv6_gre_option_context
 /**
  * @brief Define the IPv6 option context for MIME option
  */
-typedef struct __attribute__((packed)) ipv6_mime_option_context
+typedef struct ipv6_mime_option_context
 {
 	uint8_t s_bit:1;
 	uint8_t res_bits:7;
@@ -83,7 +85,7 @@ typedef struct __attribute__((packed)) ipv6_mime_option_context
 /**
  * @brief Define the IPv6 option context for AH option
  */
-typedef struct __attribute__((packed)) ipv6_ah_option_context
+typedef struct ipv6_ah_option_context
 {
 	uint32_t spi;
 	uint32_t sequence_number;
@@ -112,7 +114,7 @@ typedef struct
 /**
  * @brief Define the common IP header context to IPv4 and IPv6.
  */
-typedef struct __attribute__((packed)) ipvx_context
+typedef struct ipvx_context
 {
 	uint8_t version:4;
 	uint8_t unused:4;
@@ -132,7 +134,7 @@ typedef struct __attribute__((packed)) ipvx_context
 /**
  * @brief Define the IPv4 header context.
  */
-typedef struct __attribute__((packed)) ipv4_context
+typedef struct ipv4_context
 {
 	uint8_t version:4;
 	uint8_t df:1;
@@ -157,7 +159,7 @@ typedef struct __attribute__((packed)) ipv4_context
 /**
  * @brief Define the IPv6 header context.
  */
-typedef struct __attribute__((packed)) ipv6_context
+typedef struct ipv6_context
 {
 	uint8_t version:4;
 	uint8_t unused:4;
@@ -237,10 +239,12 @@ struct d_tcp_opt_ctxt /* TODO: doxygen */
 			} type;
 			uint8_t load_len;
 #define ROHC_TCP_OPT_HDR_LEN 2U
-#define ROHC_TCP_OPT_MAX_LEN 0xffU
-#define ROHC_TCP_OPT_GENERIC_DATA_MAX_LEN \
-	(ROHC_TCP_OPT_MAX_LEN - ROHC_TCP_OPT_HDR_LEN)
-			uint8_t load[ROHC_TCP_OPT_GENERIC_DATA_MAX_LEN];
+			/** The payload in the ROHC packet being decoded, NULL if the
+			 *  payload is the one stored for the context */
+			const uint8_t *load;
+			/** The payload stored for the context in the pool of the
+			 *  decompressor, \ref ROHC_LOAD_REF_NONE if empty */
+			rohc_load_ref_t load_ref;
 		} generic;
 	} data;
 };
@@ -258,10 +262,15 @@ struct d_tcp_opts_ctxt
 	bool expected_dynamic[ROHC_TCP_OPTS_MAX];
 	/** The TCP options that were found or not */
 	bool found[ROHC_TCP_OPTS_MAX];
+	/** Whether the structure of the list was transmitted in the packet */
+	bool structure_sent;
 
 	/** The bits of TCP options extracted from the dynamic chain, the tail of
 	 * co_common/seq_8/rnd_8 packets, or the irregular chain */
 	struct d_tcp_opt_ctxt bits[MAX_TCP_OPTION_INDEX + 1];
+	/** The indexes of the elements of \e bits that may not be all zeroes,
+	 *  one bit per index: the other elements are neither reset nor copied */
+	uint16_t bits_dirty;
 };
 
 
@@ -269,25 +278,25 @@ struct d_tcp_opts_ctxt
 struct d_tcp_context
 {
 	/** The LSB decoding context of MSN */
-	struct rohc_lsb_decode *msn_lsb_ctxt;
+	struct rohc_lsb_ref16 msn_lsb_ctxt;
 
 	/** The LSB decoding context of innermost IP-ID */
-	struct rohc_lsb_decode *ip_id_lsb_ctxt;
+	struct rohc_lsb_ref16 ip_id_lsb_ctxt;
 	/** The LSB decoding context of innermost TTL/HL */
-	struct rohc_lsb_decode *ttl_hl_lsb_ctxt;
+	struct rohc_lsb_ref8 ttl_hl_lsb_ctxt;
 
 	/* TCP static part */
 	uint16_t tcp_src_port; /**< The TCP source port */
 	uint16_t tcp_dst_port; /**< The TCP dest port */
 
 	uint32_t seq_num_residue;
-	struct rohc_lsb_decode *seq_lsb_ctxt;
-	struct rohc_lsb_decode *seq_scaled_lsb_ctxt;
+	struct rohc_lsb_ref32 seq_lsb_ctxt;
+	struct rohc_lsb_ref32 seq_scaled_lsb_ctxt;
 
 	uint16_t ack_stride;
 	uint16_t ack_num_residue;
-	struct rohc_lsb_decode *ack_lsb_ctxt;
-	struct rohc_lsb_decode *ack_scaled_lsb_ctxt;
+	struct rohc_lsb_ref32 ack_lsb_ctxt;
+	struct rohc_lsb_ref32 ack_scaled_lsb_ctxt;
 
 	/* TCP flags */
 	uint8_t res_flags:4;  /**< The TCP reserved flags */
@@ -298,7 +307,7 @@ struct d_tcp_context
 	uint8_t rsf_flags:3;  /**< The TCP RSF flag */
 
 	/** The LSB decoding context of TCP window */
-	struct rohc_lsb_decode *window_lsb_ctxt;
+	struct rohc_lsb_ref16 window_lsb_ctxt;
 
 	/** The URG pointer */
 	uint16_t urg_ptr;
@@ -306,13 +315,31 @@ struct d_tcp_context
 	/** The decoded values of TCP options */
 	struct d_tcp_opts_ctxt tcp_opts;
 	/* TCP TS option */
-	struct rohc_lsb_decode *opt_ts_req_lsb_ctxt;
-	struct rohc_lsb_decode *opt_ts_rep_lsb_ctxt;
+	struct rohc_lsb_ref32 opt_ts_req_lsb_ctxt;
+	struct rohc_lsb_ref32 opt_ts_rep_lsb_ctxt;
 	/* TCP SACK option */
 	struct d_tcp_opt_sack opt_sack_blocks;  /**< The TCP SACK blocks */
 
 	size_t ip_contexts_nr;
 	ip_context_t ip_contexts[ROHC_TCP_MAX_IP_HDRS];
+
+	/** Whether the templates of the uncompressed headers were rendered */
+	bool hdrs_tmpl_valid;
+	/** The templates of the uncompressed IP headers, rendered with the static
+	 *  part of the context after every IR packet, the dynamic fields are
+	 *  patched in a copy for every CO packet */
+	union
+	{
+		struct ipv4_hdr v4;
+		struct ipv6_hdr v6;
+	} ip_hdrs_tmpl[ROHC_TCP_MAX_IP_HDRS];
+	/** The checksums of the IPv4 header templates */
+	uint16_t ip_hdrs_tmpl_csum[ROHC_TCP_MAX_IP_HDRS];
+	/** The template of the uncompressed TCP header, see \e ip_hdrs_tmpl */
+	struct tcphdr tcp_hdr_tmpl;
+
+	/** The static chain of the last IR packet */
+	struct rohc_decomp_static_chain static_chain;
 };
 
 
@@ -355,6 +382,9 @@ struct rohc_tcp_extr_ip_bits
 	ip_option_context_t opts[ROHC_TCP_MAX_IP_EXT_HDRS];
 	size_t opts_nr;  /**< The number of parsed IP extension headers */
 	size_t opts_len; /**< The length of the parsed IP extension headers */
+	/** The number of elements of \e opts that were initialized from the
+	 *  context, so that they are reset for the next packet */
+	size_t opts_ctxt_nr;
 };
 
 
@@ -378,6 +408,13 @@ struct rohc_tcp_extr_bits
 	size_t src_port_nr;   /**< The number of TCP source port bits */
 	uint16_t dst_port;    /**< The TCP destination port bits in static chain */
 	size_t dst_port_nr;   /**< The number of TCP destination port bits */
+
+	/** The static chain of the IR packet, NULL if the packet got no static
+	 *  chain or if it is the static chain kept by the context */
+	const uint8_t *static_chain;
+	/** The length of the static chain of the IR packet */
+	size_t static_chain_len;
+
 	struct rohc_lsb_field32 seq;         /**< The TCP sequence number bits */
 	struct rohc_lsb_field32 seq_scaled;  /**< The TCP scaled sequence number bits */
 	struct rohc_lsb_field32 ack;         /**< The TCP acknowledgment number bits */
@@ -428,6 +465,9 @@ struct rohc_tcp_decoded_ip_values
 
 	/** The decoded IP extension headers */
 	ip_option_context_t opts[ROHC_TCP_MAX_IP_EXT_HDRS];
+	/** The IP extension headers transmitted in the packet, one bit per header:
+	 *  the other ones are equal to the context */
+	uint32_t opts_sent;
 	size_t opts_nr;  /**< The number of decoded IP extension headers */
 	size_t opts_len; /**< The length of the decoded IP extension headers */
 };
@@ -448,6 +488,16 @@ struct rohc_tcp_decoded_values
 	/** Whether TTL/HL of outer IP headers is included in the irregular chain */
 	bool ttl_irreg_chain_flag;
 
+	/** Whether the static part of the headers is the one of the context, so
+	 *  that the uncompressed headers may be built from the templates */
+	bool use_hdrs_tmpl;
+
+	/** The static chain of the IR packet to keep in the context, NULL if
+	 *  none, see \ref rohc_decomp_static_chain */
+	const uint8_t *static_chain;
+	/** The length of the static chain of the IR packet */
+	size_t static_chain_len;
+
 	/* TCP source & destination ports */
 	uint16_t src_port;        /**< The TCP source port */
 	uint16_t dst_port;        /**< The TCP destination port */
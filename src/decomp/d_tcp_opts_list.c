@@ -254,6 +254,10 @@ static bool d_tcp_build_generic(const struct rohc_decomp_ctxt *const context,
                                 size_t *const opt_len)
 	__attribute__((warn_unused_result, nonnull(1, 2, 3, 4, 5)));
 
+static const uint8_t * d_tcp_opt_generic_load(const struct rohc_decomp_ctxt *const context,
+                                              const struct d_tcp_opt_ctxt *const opt_ctxt)
+	__attribute__((warn_unused_result, nonnull(1, 2), pure));
+
 
 /* TODO */
 static struct d_tcp_opt d_tcp_opts[MAX_TCP_OPTION_INDEX + 1] =
@@ -368,6 +372,9 @@ int d_tcp_parse_tcp_opts_list_item(const struct rohc_decomp_ctxt *const context,
 	remain_data++;
 	remain_len--;
 
+	/* the list replaces the one of the context, even if empty */
+	tcp_opts->structure_sent = true;
+
 	/* if TCP option list compression present */
 	if(m == 0)
 	{
@@ -589,6 +596,7 @@ static int d_tcp_opt_list_parse_items(const struct rohc_decomp_ctxt *const conte
 	{
 		/* parse one list item */
 		rohc_decomp_debug(context, "  TCP options list: XI #%u:", i);
+		tcp_opts->bits_dirty |= (1U << opt_indexes[i].index);
 		ret = d_tcp_opt_list_parse_item(context, is_dynamic_chain, opt_indexes[i],
 		                                remain_data, remain_len, tcp_opts->bits);
 		if(ret < 0)
@@ -1291,7 +1299,9 @@ static int d_tcp_parse_generic_list_item(const struct rohc_decomp_ctxt *const co
 			goto error;
 		}
 		if(opt_load_len != opt_ctxt->data.generic.load_len || /* TODO */
-		   memcmp(data + opt_hdr_len, opt_ctxt->data.generic.load, opt_load_len) != 0)
+		   (opt_load_len > 0 &&
+		    memcmp(data + opt_hdr_len, d_tcp_opt_generic_load(context, opt_ctxt),
+		           opt_load_len) != 0))
 		{
 			rohc_decomp_warn(context, "malformed TCP options list: malformed TCP "
 			                 "option items: payload of TCP generic option changed");
@@ -1302,7 +1312,7 @@ static int d_tcp_parse_generic_list_item(const struct rohc_decomp_ctxt *const co
 	/* save the option type and payload */
 	opt_ctxt->type = opt_type;
 	opt_ctxt->data.generic.load_len = opt_load_len;
-	memcpy(opt_ctxt->data.generic.load, data + opt_hdr_len, opt_load_len);
+	opt_ctxt->data.generic.load = data + opt_hdr_len;
 	rohc_decomp_debug(context, "    TCP option payload = %u bytes", opt_load_len);
 
 	return opt_len;
@@ -1378,7 +1388,7 @@ static int d_tcp_parse_generic_irreg(const struct rohc_decomp_ctxt *const contex
 			}
 			opt_ctxt->data.generic.type = TCP_GENERIC_OPT_FULL;
 			opt_ctxt->data.generic.load_len = opt_load_len;
-			memcpy(opt_ctxt->data.generic.load, data + read, opt_load_len);
+			opt_ctxt->data.generic.load = data + read;
 			read += opt_load_len;
 			rohc_decomp_debug(context, "TCP generic option payload = %zu bytes",
 			                  opt_load_len);
@@ -1421,7 +1431,11 @@ static bool d_tcp_build_generic(const struct rohc_decomp_ctxt *const context,
 	rohc_buf_byte_at(*uncomp_packet, 0) = opt_type;
 	rohc_buf_byte_at(*uncomp_packet, 1) = generic_len;
 	uncomp_packet->len += 2;
-	rohc_buf_append(uncomp_packet, tcp_opt->data.generic.load, load_len);
+	if(load_len > 0)
+	{
+		rohc_buf_append(uncomp_packet, d_tcp_opt_generic_load(context, tcp_opt),
+		                load_len);
+	}
 	*opt_len = generic_len;
 
 	return true;
@@ -1431,6 +1445,102 @@ error:
 }
 
 
+/**
+ * @brief Get the payload of one TCP generic option
+ *
+ * The payload is either in the ROHC packet being decoded if it was
+ * transmitted, or in the pool of the decompressor if it is the one of the
+ * context.
+ *
+ * @param context   The decompression context
+ * @param opt_ctxt  The TCP generic option with a non-empty payload
+ * @return          The payload of the TCP generic option
+ */
+static const uint8_t * d_tcp_opt_generic_load(const struct rohc_decomp_ctxt *const context,
+                                              const struct d_tcp_opt_ctxt *const opt_ctxt)
+{
+	const uint8_t *load = opt_ctxt->data.generic.load;
+
+	if(load == NULL)
+	{
+		assert(opt_ctxt->data.generic.load_ref != ROHC_LOAD_REF_NONE);
+		load = rohc_load_pool_get(&context->decompressor->loads_pool,
+		                          opt_ctxt->data.generic.load_ref);
+	}
+
+	return load;
+}
+
+
+/**
+ * @brief Reset the TCP options extracted from one ROHC packet
+ *
+ * Only the elements of the option bits that were touched since the last
+ * reset are zeroed.
+ *
+ * @param[out] tcp_opts  The TCP options to reset
+ */
+void d_tcp_opts_ctxt_reset(struct d_tcp_opts_ctxt *const tcp_opts)
+{
+	uint8_t opt_index;
+
+	tcp_opts->nr = 0;
+	memset(tcp_opts->structure, 0, sizeof(uint8_t) * ROHC_TCP_OPTS_MAX);
+	memset(tcp_opts->expected_dynamic, 0, sizeof(bool) * ROHC_TCP_OPTS_MAX);
+	memset(tcp_opts->found, 0, sizeof(bool) * ROHC_TCP_OPTS_MAX);
+	tcp_opts->structure_sent = false;
+
+	for(opt_index = 0; opt_index <= MAX_TCP_OPTION_INDEX; opt_index++)
+	{
+		if((tcp_opts->bits_dirty & (1U << opt_index)) != 0)
+		{
+			memset(&tcp_opts->bits[opt_index], 0, sizeof(struct d_tcp_opt_ctxt));
+		}
+	}
+	tcp_opts->bits_dirty = 0;
+}
+
+
+/**
+ * @brief Copy TCP options
+ *
+ * The destination is made equal to the source, but only the elements of the
+ * option bits that are touched in the source or in the destination are
+ * written.
+ *
+ * @param[out] dst  The TCP options to overwrite
+ * @param src       The TCP options to copy
+ */
+void d_tcp_opts_ctxt_copy(struct d_tcp_opts_ctxt *const dst,
+                          const struct d_tcp_opts_ctxt *const src)
+{
+	uint8_t opt_index;
+
+	dst->nr = src->nr;
+	memcpy(dst->structure, src->structure, sizeof(uint8_t) * ROHC_TCP_OPTS_MAX);
+	memcpy(dst->expected_dynamic, src->expected_dynamic,
+	       sizeof(bool) * ROHC_TCP_OPTS_MAX);
+	memcpy(dst->found, src->found, sizeof(bool) * ROHC_TCP_OPTS_MAX);
+	dst->structure_sent = src->structure_sent;
+
+	for(opt_index = 0; opt_index <= MAX_TCP_OPTION_INDEX; opt_index++)
+	{
+		const uint16_t opt_mask = (1U << opt_index);
+
+		if((src->bits_dirty & opt_mask) != 0)
+		{
+			memcpy(&dst->bits[opt_index], &src->bits[opt_index],
+			       sizeof(struct d_tcp_opt_ctxt));
+		}
+		else if((dst->bits_dirty & opt_mask) != 0)
+		{
+			memset(&dst->bits[opt_index], 0, sizeof(struct d_tcp_opt_ctxt));
+		}
+	}
+	dst->bits_dirty = src->bits_dirty;
+}
+
+
 /* TODO */
 bool d_tcp_build_tcp_opts(const struct rohc_decomp_ctxt *const context,
                           const struct rohc_tcp_decoded_values *const decoded,
@@ -49,6 +49,13 @@ int d_tcp_parse_tcp_opts_irreg(const struct rohc_decomp_ctxt *const context,
                                struct d_tcp_opts_ctxt *const tcp_opts)
 	__attribute__((warn_unused_result, nonnull(1, 2, 4)));
 
+void d_tcp_opts_ctxt_reset(struct d_tcp_opts_ctxt *const tcp_opts)
+	__attribute__((nonnull(1)));
+
+void d_tcp_opts_ctxt_copy(struct d_tcp_opts_ctxt *const dst,
+                          const struct d_tcp_opts_ctxt *const src)
+	__attribute__((nonnull(1, 2)));
+
 bool d_tcp_build_tcp_opts(const struct rohc_decomp_ctxt *const context,
                           const struct rohc_tcp_decoded_values *const decoded,
                           struct rohc_buf *const uncomp_packet,
@@ -65,9 +65,10 @@ static bool d_udp_create(const struct rohc_decomp_ctxt *const context,
                          struct rohc_decomp_volat_ctxt *const volat_ctxt)
 	__attribute__((warn_unused_result, nonnull(1, 2, 3)));
 
-static void d_udp_destroy(struct rohc_decomp_rfc3095_ctxt *const rfc3095_ctxt,
+static void d_udp_destroy(const struct rohc_decomp_ctxt *const context,
+                          struct rohc_decomp_rfc3095_ctxt *const rfc3095_ctxt,
                           const struct rohc_decomp_volat_ctxt *const volat_ctxt)
-	__attribute__((nonnull(1, 2)));
+	__attribute__((nonnull(1, 2, 3)));
 
 static int udp_parse_dynamic_udp(const struct rohc_decomp_ctxt *const context,
                                  const uint8_t *packet,
@@ -119,8 +120,11 @@ static bool d_udp_create(const struct rohc_decomp_ctxt *const context,
 
 	/* create the generic context */
 	if(!rohc_decomp_rfc3095_create(context, persist_ctxt, volat_ctxt,
+	                               sizeof(struct d_udp_context), sizeof(struct udphdr),
 	                               context->decompressor->trace_callback,
 	                               context->decompressor->trace_callback_priv,
+	                               context->decompressor->trace_level,
+	                               context->decompressor->trace_pkt_level,
 	                               context->profile->id))
 	{
 		rohc_error(context->decompressor, ROHC_TRACE_DECOMP, context->profile->id,
@@ -129,26 +133,13 @@ static bool d_udp_create(const struct rohc_decomp_ctxt *const context,
 	}
 	rfc3095_ctxt = *persist_ctxt;
 
-	/* create the UDP-specific part of the context */
-	udp_context = malloc(sizeof(struct d_udp_context));
-	if(udp_context == NULL)
-	{
-		rohc_error(context->decompressor, ROHC_TRACE_DECOMP, context->profile->id,
-		           "cannot allocate memory for the UDP-specific context");
-		goto destroy_context;
-	}
-	memset(udp_context, 0, sizeof(struct d_udp_context));
-	rfc3095_ctxt->specific = udp_context;
+	/* the UDP-specific part of the context was allocated along with the
+	 * generic part */
+	udp_context = (struct d_udp_context *) rfc3095_ctxt->specific;
 
-	/* create the LSB decoding context for SN */
+	/* init the LSB decoding context for SN */
 	rfc3095_ctxt->sn_lsb_p = ROHC_LSB_SHIFT_SN;
-	rfc3095_ctxt->sn_lsb_ctxt = rohc_lsb_new(16);
-	if(rfc3095_ctxt->sn_lsb_ctxt == NULL)
-	{
-		rohc_error(context->decompressor, ROHC_TRACE_DECOMP, context->profile->id,
-		           "failed to create the LSB decoding context for SN");
-		goto free_udp_context;
-	}
+	rohc_lsb_init(&rfc3095_ctxt->sn_lsb_ctxt, 16);
 
 	/* the UDP checksum field present flag will be initialized
 	 * with the IR packets */
@@ -166,42 +157,11 @@ static bool d_udp_create(const struct rohc_decomp_ctxt *const context,
 	rfc3095_ctxt->compute_crc_dynamic = udp_compute_crc_dynamic;
 	rfc3095_ctxt->update_context = udp_update_context;
 
-	/* create the UDP-specific part of the header changes */
-	rfc3095_ctxt->outer_ip_changes->next_header_len = sizeof(struct udphdr);
-	rfc3095_ctxt->outer_ip_changes->next_header = malloc(sizeof(struct udphdr));
-	if(rfc3095_ctxt->outer_ip_changes->next_header == NULL)
-	{
-		rohc_error(context->decompressor, ROHC_TRACE_DECOMP, context->profile->id,
-		           "cannot allocate memory for the UDP-specific part of the "
-		           "outer IP header changes");
-		goto free_lsb_sn;
-	}
-	memset(rfc3095_ctxt->outer_ip_changes->next_header, 0, sizeof(struct udphdr));
-
-	rfc3095_ctxt->inner_ip_changes->next_header_len = sizeof(struct udphdr);
-	rfc3095_ctxt->inner_ip_changes->next_header = malloc(sizeof(struct udphdr));
-	if(rfc3095_ctxt->inner_ip_changes->next_header == NULL)
-	{
-		rohc_error(context->decompressor, ROHC_TRACE_DECOMP, context->profile->id,
-		           "cannot allocate memory for the UDP-specific part of the "
-		           "inner IP header changes");
-		goto free_outer_ip_changes_next_header;
-	}
-	memset(rfc3095_ctxt->inner_ip_changes->next_header, 0, sizeof(struct udphdr));
-
 	/* set next header to UDP */
 	rfc3095_ctxt->next_header_proto = ROHC_IPPROTO_UDP;
 
 	return true;
 
-free_outer_ip_changes_next_header:
-	zfree(rfc3095_ctxt->outer_ip_changes->next_header);
-free_lsb_sn:
-	rohc_lsb_free(rfc3095_ctxt->sn_lsb_ctxt);
-free_udp_context:
-	zfree(udp_context);
-destroy_context:
-	rohc_decomp_rfc3095_destroy(rfc3095_ctxt, volat_ctxt);
 quit:
 	return false;
 }
@@ -213,23 +173,16 @@ quit:
  * This function is one of the functions that must exist in one profile for the
  * framework to work.
  *
+ * @param context       The decompression context
  * @param rfc3095_ctxt  The persistent decompression context for the RFC3095 profiles
  * @param volat_ctxt    The volatile decompression context
  */
-static void d_udp_destroy(struct rohc_decomp_rfc3095_ctxt *const rfc3095_ctxt,
+static void d_udp_destroy(const struct rohc_decomp_ctxt *const context,
+                          struct rohc_decomp_rfc3095_ctxt *const rfc3095_ctxt,
                           const struct rohc_decomp_volat_ctxt *const volat_ctxt)
 {
-	/* clean UDP-specific memory */
-	assert(rfc3095_ctxt->outer_ip_changes != NULL);
-	zfree(rfc3095_ctxt->outer_ip_changes->next_header);
-	assert(rfc3095_ctxt->inner_ip_changes != NULL);
-	zfree(rfc3095_ctxt->inner_ip_changes->next_header);
-
-	/* destroy the LSB decoding context for SN */
-	rohc_lsb_free(rfc3095_ctxt->sn_lsb_ctxt);
-
 	/* destroy the resources of the generic context */
-	rohc_decomp_rfc3095_destroy(rfc3095_ctxt, volat_ctxt);
+	rohc_decomp_rfc3095_destroy(context, rfc3095_ctxt, volat_ctxt);
 }
 
 
@@ -605,6 +558,10 @@ const struct rohc_decomp_profile d_udp_profile =
 {
 	.id              = ROHC_PROFILE_UDP, /* profile ID (see 8 in RFC3095) */
 	.msn_max_bits    = 16,
+	.ctxt_block_len  = ROHC_DECOMP_RFC3095_BLOCK_LEN(sizeof(struct d_udp_context),
+	                                                 sizeof(struct udphdr)),
+	.extr_bits_len   = sizeof(struct rohc_extr_bits),
+	.decoded_len     = sizeof(struct rohc_decoded_values),
 	.new_context     = (rohc_decomp_new_context_t) d_udp_create,
 	.free_context    = (rohc_decomp_free_context_t) d_udp_destroy,
 	.detect_pkt_type = ip_detect_packet_type,
@@ -613,6 +570,7 @@ const struct rohc_decomp_profile d_udp_profile =
 	.build_hdrs      = (rohc_decomp_build_hdrs_t) rfc3095_decomp_build_hdrs,
 	.update_ctxt     = (rohc_decomp_update_ctxt_t) rfc3095_decomp_update_ctxt,
 	.attempt_repair  = (rohc_decomp_attempt_repair_t) rfc3095_decomp_attempt_repair,
+	.attempt_late    = (rohc_decomp_attempt_late_t) rfc3095_decomp_attempt_late,
 	.get_sn          = rohc_decomp_rfc3095_get_sn,
 };
 
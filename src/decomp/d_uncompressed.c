@@ -65,9 +65,10 @@ static bool uncomp_new_context(const struct rohc_decomp_ctxt *const context,
                                struct rohc_decomp_volat_ctxt *const volat_ctxt)
 	__attribute__((warn_unused_result, nonnull(1, 2, 3)));
 
-static void uncomp_free_context(void *const persist_ctxt,
+static void uncomp_free_context(const struct rohc_decomp_ctxt *const context,
+                                void *const persist_ctxt,
                                 const struct rohc_decomp_volat_ctxt *const volat_ctxt)
-	__attribute__((nonnull(2)));
+	__attribute__((nonnull(1, 3)));
 
 static rohc_packet_t uncomp_detect_pkt_type(const struct rohc_decomp_ctxt *const context,
                                             const uint8_t *const rohc_packet,
@@ -129,6 +130,11 @@ static bool uncomp_attempt_repair(const struct rohc_decomp *const decomp,
                                   struct rohc_uncomp_extr_bits *const extr_bits)
 	__attribute__((warn_unused_result, nonnull(1, 2, 4, 5)));
 
+static bool uncomp_attempt_late(const struct rohc_decomp *const decomp,
+                                const struct rohc_decomp_ctxt *const context,
+                                struct rohc_uncomp_extr_bits *const extr_bits)
+	__attribute__((warn_unused_result, nonnull(1, 2, 3)));
+
 static uint32_t uncomp_get_sn(const struct rohc_decomp_ctxt *const context)
 	__attribute__((warn_unused_result, nonnull(1), pure));
 
@@ -158,30 +164,12 @@ static bool uncomp_new_context(const struct rohc_decomp_ctxt *const context,
 	/* persistent part */
 	*persist_ctxt = NULL;
 
-	/* volatile part */
+	/* volatile part, the extracted bits and the decoded values are in the
+	 * scratch memory of the decompressor */
 	volat_ctxt->crc.type = ROHC_CRC_TYPE_NONE;
 	volat_ctxt->crc.bits_nr = 0;
-	volat_ctxt->extr_bits = malloc(sizeof(struct rohc_uncomp_extr_bits));
-	if(volat_ctxt->extr_bits == NULL)
-	{
-		rohc_decomp_warn(context, "failed to allocate memory for the volatile part "
-		                 "of the Uncompressed decompression profile");
-		goto error;
-	}
-	volat_ctxt->decoded_values = malloc(sizeof(struct rohc_uncomp_decoded));
-	if(volat_ctxt->decoded_values == NULL)
-	{
-		rohc_decomp_warn(context, "failed to allocate memory for the volatile part "
-		                 "of the Uncompressed decompression profile");
-		goto free_extr_bits;
-	}
 
 	return true;
-
-free_extr_bits:
-	free(volat_ctxt->extr_bits);
-error:
-	return false;
 }
 
 
@@ -192,15 +180,15 @@ error:
  * This function is one of the functions that must exist in one profile for the
  * framework to work.
  *
+ * @param context       The decompression context
  * @param persist_ctxt  The persistent part of the decompression context
  * @param volat_ctxt    The volatile part of the decompression context
  */
-static void uncomp_free_context(void *const persist_ctxt,
-                                const struct rohc_decomp_volat_ctxt *const volat_ctxt)
+static void uncomp_free_context(const struct rohc_decomp_ctxt *const context __attribute__((unused)),
+                                void *const persist_ctxt,
+                                const struct rohc_decomp_volat_ctxt *const volat_ctxt __attribute__((unused)))
 {
 	assert(persist_ctxt == NULL);
-	free(volat_ctxt->extr_bits);
-	free(volat_ctxt->decoded_values);
 }
 
 
@@ -530,6 +518,29 @@ static bool uncomp_attempt_repair(const struct rohc_decomp *const decomp __attri
 }
 
 
+/**
+ * @brief Attempt to decode a late packet against a previous reference
+ *
+ * This function is one of the functions that must exist in one profile for the
+ * framework to work.
+ *
+ * @param decomp             The ROHC decompressor
+ * @param context            The decompression context
+ * @param[in,out] extr_bits  The bits extracted from the ROHC header
+ * @return                   true if a new decoding attempt is possible,
+ *                           false if not
+ */
+static bool uncomp_attempt_late(const struct rohc_decomp *const decomp __attribute__((unused)),
+                                const struct rohc_decomp_ctxt *const context __attribute__((unused)),
+                                struct rohc_uncomp_extr_bits *const extr_bits __attribute__((unused)))
+{
+	/* CRC failure cannot happen with Uncompressed profile since Normal packets
+	 * do not have a CRC */
+	assert(0);
+	return false;
+}
+
+
 /**
  * @brief Get the reference SN value of the context. Always return 0 for the
  *        uncompressed profile.
@@ -554,6 +565,9 @@ const struct rohc_decomp_profile d_uncomp_profile =
 {
 	.id              = ROHC_PROFILE_UNCOMPRESSED, /* profile ID (RFC3095 §8) */
 	.msn_max_bits    = 0, /* no MSN */
+	.ctxt_block_len  = 0, /* no persistent part */
+	.extr_bits_len   = sizeof(struct rohc_uncomp_extr_bits),
+	.decoded_len     = sizeof(struct rohc_uncomp_decoded),
 	.new_context     = uncomp_new_context,
 	.free_context    = uncomp_free_context,
 	.detect_pkt_type = uncomp_detect_pkt_type,
@@ -562,6 +576,7 @@ const struct rohc_decomp_profile d_uncomp_profile =
 	.build_hdrs      = (rohc_decomp_build_hdrs_t) uncomp_build_hdrs,
 	.update_ctxt     = (rohc_decomp_update_ctxt_t) uncomp_update_ctxt,
 	.attempt_repair  = (rohc_decomp_attempt_repair_t) uncomp_attempt_repair,
+	.attempt_late    = (rohc_decomp_attempt_late_t) uncomp_attempt_late,
 	.get_sn          = uncomp_get_sn,
 };
 
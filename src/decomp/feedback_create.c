@@ -29,6 +29,7 @@
 #include "rohc_debug.h"
 #include "rohc_bit_ops.h"
 #include "sdvl.h"
+#include "rohc_alloc.h"
 
 #ifdef ROHC_FEEDBACK_DEBUG
 #  include <stdio.h>
@@ -115,7 +116,7 @@ bool f_feedback2(const rohc_profile_t profile_id,
 		assert(0);
 		goto error;
 	}
-	else if(profile_id == ROHC_PROFILE_TCP)
+	else if(rohc_feedback_is_rfc6846(profile_id))
 	{
 		feedback->data[feedback->size] = (ack_type & 0x3) << 6;
 		sn_bits_on_first_byte = 6;
@@ -172,8 +173,8 @@ bool f_feedback2(const rohc_profile_t profile_id,
 #endif
 	feedback->size++;
 
-	/* base header: CRC for TCP profile */
-	if(profile_id == ROHC_PROFILE_TCP)
+	/* base header: CRC for TCP and ROHCv2 profiles */
+	if(rohc_feedback_is_rfc6846(profile_id))
 	{
 		feedback->data[feedback->size] = 0x00; /* zeroed for computation */
 		feedback->size++;
@@ -397,7 +398,6 @@ static bool f_append_cid(struct d_feedback *const feedback,
  * @param cid               The Context ID (CID) to append
  * @param cid_type          The type of CID used for the feedback
  * @param protect_with_crc  Whether the CRC option must be added or not
- * @param crc_table         The pre-computed table for fast CRC computation
  * @param final_size        OUT: The final size of the feedback packet
  * @return                  The feedback packet if successful, NULL otherwise
  */
@@ -405,7 +405,6 @@ uint8_t * f_wrap_feedback(struct d_feedback *const feedback,
                           const uint16_t cid,
                           const rohc_cid_type_t cid_type,
                           const rohc_feedback_crc_t protect_with_crc,
-                          const uint8_t *const crc_table,
                           size_t *const final_size)
 {
 	uint8_t *feedback_packet;
@@ -450,7 +449,7 @@ uint8_t * f_wrap_feedback(struct d_feedback *const feedback,
 	}
 
 	/* allocate memory for the feedback packet */
-	feedback_packet = (uint8_t *) malloc(feedback->size);
+	feedback_packet = (uint8_t *) rohc_malloc(feedback->size);
 	if(feedback_packet == NULL)
 	{
 		goto error;
@@ -463,7 +462,7 @@ uint8_t * f_wrap_feedback(struct d_feedback *const feedback,
 	if(protect_with_crc != ROHC_FEEDBACK_WITH_NO_CRC)
 	{
 		crc = crc_calculate(ROHC_CRC_TYPE_8, feedback_packet, feedback->size,
-		                    CRC_INIT_8, crc_table);
+		                    CRC_INIT_8);
 		feedback_packet[crc_pos] = crc & 0xff;
 	}
 
@@ -43,6 +43,7 @@
 #include "rohc_time_internal.h"
 #include "rohc_utils.h"
 #include "rohc_bit_ops.h"
+#include "rohc_bitmap.h"
 #include "rohc_debug.h"
 #include "feedback_create.h"
 #include "feedback_parse.h"
@@ -50,6 +51,9 @@
 #include "rohc_add_cid.h"
 #include "rohc_decomp_detect_packet.h"
 #include "crc.h"
+#include "rohc_alloc.h"
+#include "rohc_numa.h"
+#include "rohc_probes_internal.h"
 
 #ifndef __KERNEL__
 #  include <string.h>
@@ -58,27 +62,147 @@
 #include <assert.h>
 
 
-extern const struct rohc_decomp_profile d_uncomp_profile,
-                                        d_udp_profile,
-                                        d_ip_profile,
-                                        d_udplite_profile,
-                                        d_esp_profile,
-                                        d_rtp_profile,
-                                        d_tcp_profile;
+extern const struct rohc_decomp_profile d_uncomp_profile;
+#if ROHC_PROFILE_UDP_BUILT
+extern const struct rohc_decomp_profile d_udp_profile;
+#endif
+#if ROHC_PROFILE_IP_BUILT
+extern const struct rohc_decomp_profile d_ip_profile;
+#endif
+#if ROHC_PROFILE_UDPLITE_BUILT
+extern const struct rohc_decomp_profile d_udplite_profile;
+#endif
+#if ROHC_PROFILE_ESP_BUILT
+extern const struct rohc_decomp_profile d_esp_profile;
+#endif
+#if ROHC_PROFILE_RTP_BUILT
+extern const struct rohc_decomp_profile d_rtp_profile;
+#endif
+#if ROHC_PROFILE_TCP_BUILT
+extern const struct rohc_decomp_profile d_tcp_profile;
+#endif
+#if ROHCv2_PROFILE_IP_BUILT
+extern const struct rohc_decomp_profile d_rfc5225_ip_only_profile;
+#endif
+#if ROHCv2_PROFILE_IP_UDP_BUILT
+extern const struct rohc_decomp_profile d_rfc5225_udp_profile;
+#endif
+#if ROHCv2_PROFILE_IP_ESP_BUILT
+extern const struct rohc_decomp_profile d_rfc5225_esp_profile;
+#endif
+#if ROHCv2_PROFILE_IP_UDP_RTP_BUILT
+extern const struct rohc_decomp_profile d_rfc5225_rtp_profile;
+#endif
 
 
 /**
  * @brief The decompression parts of the ROHC profiles.
+ *
+ * The profiles left out of the build (see rohc_profiles_config.h) are not
+ * declared at all.
  */
 static const struct rohc_decomp_profile *const rohc_decomp_profiles[D_NUM_PROFILES] =
 {
 	&d_uncomp_profile,
+#if ROHC_PROFILE_RTP_BUILT
 	&d_rtp_profile,
+#endif
+#if ROHC_PROFILE_UDP_BUILT
 	&d_udp_profile,
+#endif
+#if ROHC_PROFILE_ESP_BUILT
 	&d_esp_profile,
+#endif
+#if ROHC_PROFILE_IP_BUILT
 	&d_ip_profile,
+#endif
+#if ROHC_PROFILE_TCP_BUILT
 	&d_tcp_profile,
+#endif
+#if ROHC_PROFILE_UDPLITE_BUILT
 	&d_udplite_profile,
+#endif
+#if ROHCv2_PROFILE_IP_BUILT
+	&d_rfc5225_ip_only_profile,
+#endif
+#if ROHCv2_PROFILE_IP_UDP_BUILT
+	&d_rfc5225_udp_profile,
+#endif
+#if ROHCv2_PROFILE_IP_ESP_BUILT
+	&d_rfc5225_esp_profile,
+#endif
+#if ROHCv2_PROFILE_IP_UDP_RTP_BUILT
+	&d_rfc5225_rtp_profile,
+#endif
+};
+
+
+/* the locations of the profiles in \ref rohc_decomp_profiles */
+#define D_PROFILE_IDX_UNCOMP   0U
+#define D_PROFILE_IDX_RTP      (D_PROFILE_IDX_UNCOMP + 1U)
+#define D_PROFILE_IDX_UDP      (D_PROFILE_IDX_RTP + ROHC_PROFILE_RTP_BUILT)
+#define D_PROFILE_IDX_ESP      (D_PROFILE_IDX_UDP + ROHC_PROFILE_UDP_BUILT)
+#define D_PROFILE_IDX_IP       (D_PROFILE_IDX_ESP + ROHC_PROFILE_ESP_BUILT)
+#define D_PROFILE_IDX_TCP      (D_PROFILE_IDX_IP + ROHC_PROFILE_IP_BUILT)
+#define D_PROFILE_IDX_UDPLITE  (D_PROFILE_IDX_TCP + ROHC_PROFILE_TCP_BUILT)
+#define D_PROFILE_IDX_V2IP     (D_PROFILE_IDX_UDPLITE + ROHC_PROFILE_UDPLITE_BUILT)
+#define D_PROFILE_IDX_V2UDP    (D_PROFILE_IDX_V2IP + ROHCv2_PROFILE_IP_BUILT)
+#define D_PROFILE_IDX_V2ESP    (D_PROFILE_IDX_V2UDP + ROHCv2_PROFILE_IP_UDP_BUILT)
+#define D_PROFILE_IDX_V2RTP    (D_PROFILE_IDX_V2ESP + ROHCv2_PROFILE_IP_ESP_BUILT)
+
+/**
+ * @brief The locations of the profiles in \ref rohc_decomp_profiles, indexed
+ *        by ROHC version then by the 8 LSB of the profile ID
+ *
+ * D_NUM_PROFILES stands for the profiles that the library does not
+ * implement or that were left out of the build.
+ */
+static const uint8_t rohc_decomp_profiles_idx[2][ROHC_PROFILE_UDPLITE + 1] =
+{
+	/* ROHCv1 profiles */
+	{
+		[ROHC_PROFILE_UNCOMPRESSED] = D_PROFILE_IDX_UNCOMP,
+		[ROHC_PROFILE_RTP]          =
+			ROHC_PROFILE_LOC(ROHC_PROFILE_RTP_BUILT, D_PROFILE_IDX_RTP,
+			                 D_NUM_PROFILES),
+		[ROHC_PROFILE_UDP]          =
+			ROHC_PROFILE_LOC(ROHC_PROFILE_UDP_BUILT, D_PROFILE_IDX_UDP,
+			                 D_NUM_PROFILES),
+		[ROHC_PROFILE_ESP]          =
+			ROHC_PROFILE_LOC(ROHC_PROFILE_ESP_BUILT, D_PROFILE_IDX_ESP,
+			                 D_NUM_PROFILES),
+		[ROHC_PROFILE_IP]           =
+			ROHC_PROFILE_LOC(ROHC_PROFILE_IP_BUILT, D_PROFILE_IDX_IP,
+			                 D_NUM_PROFILES),
+		[ROHC_PROFILE_RTP_LLA]      = D_NUM_PROFILES,
+		[ROHC_PROFILE_TCP]          =
+			ROHC_PROFILE_LOC(ROHC_PROFILE_TCP_BUILT, D_PROFILE_IDX_TCP,
+			                 D_NUM_PROFILES),
+		[ROHC_PROFILE_UDPLITE_RTP]  = D_NUM_PROFILES,
+		[ROHC_PROFILE_UDPLITE]      =
+			ROHC_PROFILE_LOC(ROHC_PROFILE_UDPLITE_BUILT, D_PROFILE_IDX_UDPLITE,
+			                 D_NUM_PROFILES),
+	},
+	/* ROHCv2 profiles */
+	{
+		[0x00]                      = D_NUM_PROFILES,
+		[ROHCv2_PROFILE_IP_UDP_RTP & 0xff] =
+			ROHC_PROFILE_LOC(ROHCv2_PROFILE_IP_UDP_RTP_BUILT, D_PROFILE_IDX_V2RTP,
+			                 D_NUM_PROFILES),
+		[ROHCv2_PROFILE_IP_UDP & 0xff] =
+			ROHC_PROFILE_LOC(ROHCv2_PROFILE_IP_UDP_BUILT, D_PROFILE_IDX_V2UDP,
+			                 D_NUM_PROFILES),
+		[ROHCv2_PROFILE_IP_ESP & 0xff] =
+			ROHC_PROFILE_LOC(ROHCv2_PROFILE_IP_ESP_BUILT, D_PROFILE_IDX_V2ESP,
+			                 D_NUM_PROFILES),
+		[ROHCv2_PROFILE_IP & 0xff]  =
+			ROHC_PROFILE_LOC(ROHCv2_PROFILE_IP_BUILT, D_PROFILE_IDX_V2IP,
+			                 D_NUM_PROFILES),
+		[0x05]                      = D_NUM_PROFILES,
+		[0x06]                      = D_NUM_PROFILES,
+		[0x07]                      = D_NUM_PROFILES,
+		[0x08]                      = D_NUM_PROFILES,
+	},
 };
 
 
@@ -112,6 +236,7 @@ struct rohc_decomp_stream
 	                                if not identified) */
 	rohc_mode_t mode;          /**< The context mode (if context found) */
 	bool do_change_mode;       /**< The context mode shall be advertised */
+	bool is_mode_transition;   /**< The context just moved to another mode */
 	rohc_decomp_state_t state; /**< The context state (if context found) */
 	uint32_t sn_bits;          /**< The SN LSB bits (if context found) */
 	size_t sn_bits_nr;         /**< The number of SN LSB bits (if context found) */
@@ -127,6 +252,26 @@ struct rohc_decomp_stream
 static bool rohc_decomp_create_contexts(struct rohc_decomp *const decomp,
                                         const rohc_cid_t max_cid)
 	__attribute__((nonnull(1), warn_unused_result));
+static void rohc_decomp_destroy_ctxts_chunks(struct rohc_decomp *const decomp)
+	__attribute__((nonnull(1)));
+static void rohc_decomp_free_dense_ctxts(struct rohc_decomp *const decomp)
+	__attribute__((nonnull(1)));
+static bool rohc_decomp_alloc_ctxts_chunks(struct rohc_decomp *const decomp,
+                                           const rohc_cid_t cid_first,
+                                           const rohc_cid_t cid_last)
+	__attribute__((nonnull(1), warn_unused_result));
+static struct rohc_decomp_ctxt_stats *
+	rohc_decomp_ctxt_stats_at(const struct rohc_decomp *const decomp,
+	                          const rohc_cid_t cid)
+	__attribute__((nonnull(1), warn_unused_result, pure));
+
+static size_t rohc_decomp_profile_idx(const rohc_profile_t profile_id)
+	__attribute__((warn_unused_result, const));
+
+static void d_trace_sample(struct rohc_decomp *const decomp,
+                           const bool cid_known,
+                           const rohc_cid_t cid)
+	__attribute__((nonnull(1)));
 
 static const struct rohc_decomp_profile *
 	find_profile(const struct rohc_decomp *const decomp,
@@ -142,6 +287,33 @@ static struct rohc_decomp_ctxt * find_context(const struct rohc_decomp *const de
 	__attribute__((nonnull(1), warn_unused_result));
 static void context_free(struct rohc_decomp_ctxt *const context)
 	__attribute__((nonnull(1)));
+static void rohc_decomp_notify_ctxt_event(const struct rohc_decomp_ctxt *const context,
+                                          const rohc_decomp_event_t event,
+                                          const rohc_decomp_state_t old_state,
+                                          const rohc_mode_t old_mode)
+	__attribute__((nonnull(1)));
+
+static void rohc_decomp_log_packet(struct rohc_decomp *const decomp,
+                                   const struct rohc_decomp_stream *const stream,
+                                   const rohc_status_t status)
+	__attribute__((nonnull(1, 2)));
+static void rohc_decomp_volat_ctxt_init(const struct rohc_decomp *const decomp,
+                                        const struct rohc_decomp_profile *const profile,
+                                        struct rohc_decomp_volat_ctxt *const volat_ctxt)
+	__attribute__((nonnull(1, 2, 3)));
+static void * rohc_decomp_ctxt_mem_get(struct rohc_decomp *const decomp,
+                                       const rohc_cid_t cid)
+	__attribute__((nonnull(1), warn_unused_result));
+static void rohc_decomp_ctxt_mem_put(struct rohc_decomp *const decomp,
+                                     struct rohc_decomp_ctxt *const context)
+	__attribute__((nonnull(1, 2)));
+static bool rohc_decomp_is_dense(const struct rohc_decomp *const decomp,
+                                 const void *const mem)
+	__attribute__((nonnull(1, 2), warn_unused_result, pure));
+static inline struct rohc_decomp_ctxt *
+	rohc_decomp_dense_slot(const struct rohc_decomp *const decomp,
+	                       const size_t slot)
+	__attribute__((nonnull(1), warn_unused_result, pure));
 
 static rohc_status_t d_decode_header(struct rohc_decomp *decomp,
                                      const struct rohc_buf rohc_packet,
@@ -162,6 +334,31 @@ static void rohc_decomp_parse_padding(const struct rohc_decomp *const decomp,
                                       struct rohc_buf *const packet)
 	__attribute__((nonnull(1, 2)));
 
+static bool rohc_decomp_skip_fb_prefix(struct rohc_buf *const packet,
+                                       size_t *const padding_len)
+	__attribute__((warn_unused_result, nonnull(1, 2)));
+
+static bool rohc_decomp_check_bufs(const struct rohc_decomp *const decomp,
+                                   const struct rohc_buf rohc_packet,
+                                   const struct rohc_buf *const uncomp_packet,
+                                   const struct rohc_buf *const rcvd_feedback,
+                                   const struct rohc_buf *const feedback_send)
+	__attribute__((warn_unused_result, nonnull(1)));
+
+static rohc_status_t rohc_decomp_decompress_one(struct rohc_decomp *const decomp,
+                                                const struct rohc_buf rohc_packet,
+                                                struct rohc_buf *const uncomp_packet,
+                                                struct rohc_buf *const rcvd_feedback,
+                                                struct rohc_buf *const feedback_send)
+	__attribute__((warn_unused_result, nonnull(1, 3)));
+
+static void rohc_decomp_rru_copy(const struct rohc_buf *const segments,
+                                 const size_t segments_nr,
+                                 const size_t rru_off,
+                                 const size_t len,
+                                 uint8_t *const dst)
+	__attribute__((nonnull(1, 5)));
+
 static rohc_status_t rohc_decomp_find_context(struct rohc_decomp *const decomp,
                                               const uint8_t *const packet,
                                               const size_t packet_len,
@@ -196,6 +393,36 @@ static void rohc_decomp_stats_add_success(struct rohc_decomp_ctxt *const context
                                           const size_t comp_hdr_len,
                                           const size_t uncomp_hdr_len)
 	__attribute__((nonnull(1)));
+static void rohc_decomp_publish_ctxt_stats(struct rohc_decomp *const decomp,
+                                           const struct rohc_decomp_ctxt *const context)
+	__attribute__((nonnull(1, 2)));
+
+static void rohc_decomp_timings_reset(struct rohc_decomp *const decomp)
+	__attribute__((nonnull(1)));
+static void rohc_decomp_timings_set_lookup(struct rohc_decomp *const decomp,
+                                           const rohc_ticks_t lookup_ticks)
+	__attribute__((nonnull(1)));
+static void rohc_decomp_timings_add_feedback(struct rohc_decomp *const decomp,
+                                             const rohc_ticks_t feedback_ticks)
+	__attribute__((nonnull(1)));
+static void rohc_decomp_timings_step(rohc_ticks_t *const last,
+                                     rohc_ticks_t *const phase_ticks)
+	__attribute__((nonnull(1, 2)));
+static void rohc_decomp_timings_set_pending(struct rohc_decomp *const decomp,
+                                            const rohc_ticks_t phases_ticks[])
+	__attribute__((nonnull(1, 2)));
+static void rohc_decomp_timings_record(struct rohc_decomp *const decomp,
+                                       const rohc_packet_t packet_type,
+                                       const rohc_profile_t profile)
+	__attribute__((nonnull(1)));
+
+static bool rohc_decomp_crc_repair_allowed(struct rohc_decomp *const decomp,
+                                           struct rohc_decomp_ctxt *const context,
+                                           const struct rohc_ts arrival_time)
+	__attribute__((nonnull(1, 2), warn_unused_result));
+static bool rohc_decomp_rt_capped(const struct rohc_decomp *const decomp,
+                                  const size_t attempts_nr)
+	__attribute__((nonnull(1), warn_unused_result, pure));
 
 static void rohc_decomp_update_context(struct rohc_decomp_ctxt *const context,
                                        const void *const decoded_values,
@@ -216,6 +443,14 @@ static bool rohc_decomp_parse_feedback(struct rohc_decomp *const decomp,
 	__attribute__((warn_unused_result, nonnull(1, 2, 4)));
 
 /* function related to the transmission of feedback to the remote ROHC compressor */
+static void rohc_decomp_fb_hist_push(struct rohc_decomp_fb_hist *const hist,
+                                     const bool is_error)
+	__attribute__((nonnull(1)));
+static inline void rohc_decomp_fb_hist_skip(struct rohc_decomp_fb_hist *const hist)
+	__attribute__((nonnull(1)));
+static rohc_mode_t rohc_decomp_ctxt_target_mode(const struct rohc_decomp *const decomp,
+                                                const struct rohc_decomp_ctxt *const context)
+	__attribute__((warn_unused_result, nonnull(1, 2)));
 static bool rohc_decomp_feedback_ack(struct rohc_decomp *const decomp,
                                      const struct rohc_decomp_stream *const stream,
                                      struct rohc_buf *const feedback)
@@ -224,6 +459,36 @@ static bool rohc_decomp_feedback_nack(struct rohc_decomp *const decomp,
                                       const struct rohc_decomp_stream *const stream,
                                       struct rohc_buf *const feedback)
 	__attribute__((warn_unused_result, nonnull(1, 2)));
+static bool rohc_decomp_build_ack(const struct rohc_decomp *const decomp,
+                                  const rohc_profile_t profile_id,
+                                  const rohc_cid_t cid,
+                                  const rohc_cid_type_t cid_type,
+                                  const rohc_mode_t mode,
+                                  const uint32_t sn_bits,
+                                  const size_t sn_bits_nr,
+                                  const bool do_change_mode,
+                                  struct rohc_buf *const feedback)
+	__attribute__((warn_unused_result, nonnull(1, 9)));
+static bool rohc_decomp_delay_ack(struct rohc_decomp *const decomp,
+                                  const struct rohc_decomp_stream *const infos,
+                                  struct rohc_buf *const feedback)
+	__attribute__((warn_unused_result, nonnull(1, 2, 3)));
+static void rohc_decomp_drop_ack(struct rohc_decomp *const decomp,
+                                 const rohc_cid_t cid)
+	__attribute__((nonnull(1)));
+static size_t rohc_decomp_reclaim_idle(struct rohc_decomp *const decomp,
+                                       const struct rohc_ts now,
+                                       const size_t cids_nr)
+	__attribute__((nonnull(1)));
+static rohc_cid_t rohc_decomp_next_used_cid(const struct rohc_decomp *const decomp,
+                                            const rohc_cid_t from)
+	__attribute__((warn_unused_result, nonnull(1)));
+static bool rohc_decomp_flush_acks(struct rohc_decomp *const decomp,
+                                   struct rohc_buf *const feedback)
+	__attribute__((warn_unused_result, nonnull(1, 2)));
+static bool rohc_decomp_age_acks(struct rohc_decomp *const decomp,
+                                 struct rohc_buf *const feedback)
+	__attribute__((warn_unused_result, nonnull(1, 2)));
 
 /* statistics-related functions */
 static void rohc_decomp_reset_stats(struct rohc_decomp *const decomp)
@@ -260,7 +525,7 @@ static struct rohc_decomp_ctxt * find_context(const struct rohc_decomp *const de
 /**
  * @brief Create one new decompression context with profile specific data.
  *
- * @param decomp        The ROHC decompressor
+ * @param decomp       The ROHC decompressor
  * @param cid           The CID of the new context
  * @param profile       The profile to be assigned with the new context
  * @param arrival_time  The time at which packet was received (0 if unknown,
@@ -278,8 +543,15 @@ static struct rohc_decomp_ctxt * context_create(struct rohc_decomp *decomp,
 	assert(cid <= ROHC_LARGE_CID_MAX);
 	assert(profile != NULL);
 
-	/* allocate memory for the decompression context */
-	context = (struct rohc_decomp_ctxt *) malloc(sizeof(struct rohc_decomp_ctxt));
+	/* the statistics of the CID are allocated with the first context */
+	if(!rohc_decomp_alloc_ctxts_chunks(decomp, cid, cid))
+	{
+		goto error;
+	}
+
+	/* get memory for the decompression context from the dense array or from
+	 * the pool of the decompressor */
+	context = rohc_decomp_ctxt_mem_get(decomp, cid);
 	if(context == NULL)
 	{
 		rohc_warning(decomp, ROHC_TRACE_DECOMP, profile->id,
@@ -301,13 +573,7 @@ static struct rohc_decomp_ctxt * context_create(struct rohc_decomp *decomp,
 	context->state = ROHC_DECOMP_STATE_NC;
 
 	/* counters and thresholds for feedbacks and downward state transitions */
-	context->last_pkts_errors = 0;
-	context->last_pkt_feedbacks[ROHC_FEEDBACK_ACK].needed = 0;
-	context->last_pkt_feedbacks[ROHC_FEEDBACK_ACK].sent = 0;
-	context->last_pkt_feedbacks[ROHC_FEEDBACK_NACK].needed = 0;
-	context->last_pkt_feedbacks[ROHC_FEEDBACK_NACK].sent = 0;
-	context->last_pkt_feedbacks[ROHC_FEEDBACK_STATIC_NACK].needed = 0;
-	context->last_pkt_feedbacks[ROHC_FEEDBACK_STATIC_NACK].sent = 0;
+	memset(&context->fb_hist, 0, sizeof(struct rohc_decomp_fb_hist));
 
 	/* init the context for packet/context corrections upon CRC failures */
 	/* at the beginning, no attempt to correct CRC failure */
@@ -318,6 +584,9 @@ static struct rohc_decomp_ctxt * context_create(struct rohc_decomp *decomp,
 	       sizeof(struct rohc_ts) * ROHC_MAX_ARRIVAL_TIMES);
 	context->crc_corr.arrival_times_nr = 0;
 	context->crc_corr.arrival_times_index = 0;
+	/* no repair attempted yet */
+	context->crc_corr.budget_sec = 0;
+	context->crc_corr.budget_used = 0;
 
 	/* init some statistics */
 	context->num_recv_packets = 0;
@@ -328,6 +597,9 @@ static struct rohc_decomp_ctxt * context_create(struct rohc_decomp *decomp,
 	context->corrected_crc_failures = 0;
 	context->corrected_sn_wraparounds = 0;
 	context->corrected_wrong_sn_updates = 0;
+	context->crc_repair_attempts = 0;
+	context->crc_repair_skipped = 0;
+	context->late_pkts_decoded = 0;
 	context->nr_lost_packets = 0;
 	context->nr_misordered_packets = 0;
 	context->is_duplicated = 0;
@@ -335,6 +607,10 @@ static struct rohc_decomp_ctxt * context_create(struct rohc_decomp *decomp,
 	context->first_used = arrival_time.sec;
 	context->latest_used = arrival_time.sec;
 
+	/* the volatile part of the context decodes its packets in the scratch
+	 * memory of the profile */
+	rohc_decomp_volat_ctxt_init(decomp, profile, &context->volat_ctxt);
+
 	/* create the profile-specific parts of the decompression context (performed
 	 * at the every end so that everything is initialized in context first) */
 	if(!profile->new_context(context, &context->persist_ctxt, &context->volat_ctxt))
@@ -349,11 +625,12 @@ static struct rohc_decomp_ctxt * context_create(struct rohc_decomp *decomp,
 	 * might have MAX_CID + 2 contexts) */
 	assert(decomp->num_contexts_used <= (decomp->medium.max_cid + 1));
 	decomp->num_contexts_used++;
+	ROHC_PROBE2(decomp_ctxt_create, cid, profile->id);
 
 	return context;
 
 destroy_context:
-	zfree(context);
+	rohc_decomp_ctxt_mem_put(decomp, context);
 error:
 	return NULL;
 }
@@ -374,14 +651,418 @@ static void context_free(struct rohc_decomp_ctxt *const context)
 	           "free context with CID %zu", context->cid);
 
 	/* destroy the profile-specific data */
-	context->profile->free_context(context->persist_ctxt, &context->volat_ctxt);
+	context->profile->free_context(context, context->persist_ctxt,
+	                               &context->volat_ctxt);
 
 	/* decompressor got one more context */
 	assert(context->decompressor->num_contexts_used > 0);
 	context->decompressor->num_contexts_used--;
 
-	/* destroy the context itself */
-	free(context);
+	/* give the memory of the context itself back to the dense array or to
+	 * the pool */
+	rohc_decomp_ctxt_mem_put(context->decompressor, context);
+}
+
+
+/**
+ * @brief Call the callback of the user for one event of one context
+ *
+ * The state and the mode of the context after the event are the current
+ * state and mode of the context.
+ *
+ * @param context    The decompression context
+ * @param event      The event
+ * @param old_state  The state of the context before the event
+ * @param old_mode   The mode of the context before the event
+ */
+static void rohc_decomp_notify_ctxt_event(const struct rohc_decomp_ctxt *const context,
+                                          const rohc_decomp_event_t event,
+                                          const rohc_decomp_state_t old_state,
+                                          const rohc_mode_t old_mode)
+{
+	const struct rohc_decomp *const decomp = context->decompressor;
+	rohc_decomp_event_info_t info;
+
+	if(decomp->event_cb == NULL)
+	{
+		return;
+	}
+
+	info.event = event;
+	info.cid = context->cid;
+	info.profile_id = context->profile->id;
+	info.old_state = old_state;
+	info.new_state = context->state;
+	info.old_mode = old_mode;
+	info.new_mode = context->mode;
+	info.status = ROHC_STATUS_OK;
+	decomp->event_cb(decomp->event_cb_priv, &info);
+}
+
+
+/**
+ * @brief Record one packet in the log of the last packets
+ *
+ * @param decomp  The ROHC decompressor, with the log of packets enabled
+ * @param stream  The information collected while decompressing the packet
+ * @param status  The status of the decompression of the packet
+ */
+static void rohc_decomp_log_packet(struct rohc_decomp *const decomp,
+                                   const struct rohc_decomp_stream *const stream,
+                                   const rohc_status_t status)
+{
+	rohc_pkt_log_record_t *const record = rohc_pkt_log_next(&decomp->pkt_log);
+
+	record->packet_nr = decomp->stats.received;
+	record->sn = stream->sn_bits;
+	record->cid = stream->cid;
+	record->profile_id = stream->profile_id;
+	record->packet_type = stream->packet_type;
+	record->sn_bits_nr = 0;
+	record->status = status;
+	record->reserved = 0;
+}
+
+
+/**
+ * @brief Destroy the decompression contexts that are idle for too long
+ *
+ * The given number of CIDs are checked, starting with the CID after the one
+ * checked last. The statistics of the destroyed contexts are kept.
+ *
+ * @param decomp   The ROHC decompressor
+ * @param now      The current time
+ * @param cids_nr  The number of CIDs to check
+ * @return         The number of destroyed contexts
+ */
+static size_t rohc_decomp_reclaim_idle(struct rohc_decomp *const decomp,
+                                       const struct rohc_ts now,
+                                       const size_t cids_nr)
+{
+	size_t reclaimed_nr = 0;
+	size_t i;
+
+	for(i = 0; i < cids_nr; i++)
+	{
+		const rohc_cid_t cid = decomp->idle_sweep_cid;
+		struct rohc_decomp_ctxt *const context = decomp->contexts[cid];
+
+		decomp->idle_sweep_cid = (cid >= decomp->medium.max_cid ? 0 : cid + 1);
+
+		if(context != NULL &&
+		   now.sec >= context->latest_used &&
+		   (now.sec - context->latest_used) >= decomp->ctxts_idle_timeout)
+		{
+			struct rohc_decomp_ctxt_stats *const stats =
+				rohc_decomp_ctxt_stats_at(decomp, cid);
+
+			rohc_debug(decomp, ROHC_TRACE_DECOMP, context->profile->id,
+			           "context with CID %zu is unused for %lu seconds, "
+			           "destroy it", cid,
+			           (unsigned long) (now.sec - context->latest_used));
+			rohc_decomp_drop_ack(decomp, cid);
+			if(decomp->last_context == context)
+			{
+				decomp->last_context = NULL;
+			}
+			rohc_decomp_notify_ctxt_event(context, ROHC_DECOMP_EVENT_CTXT_DESTROY,
+			                              context->state, context->mode);
+			context_free(context);
+			decomp->contexts[cid] = NULL;
+			rohc_bitmap_clear(decomp->ctxts_used, cid);
+			rohc_seqcount_write_begin(&stats->seq);
+			stats->used = false;
+			rohc_seqcount_write_end(&stats->seq);
+			reclaimed_nr++;
+		}
+	}
+
+	return reclaimed_nr;
+}
+
+
+/**
+ * @brief Get the CID of the next decompression context in use
+ *
+ * @param decomp  The ROHC decompressor
+ * @param from    The first CID to check
+ * @return        The first CID in use at or after \e from,
+ *                MAX_CID + 1 if there is none
+ */
+static rohc_cid_t rohc_decomp_next_used_cid(const struct rohc_decomp *const decomp,
+                                            const rohc_cid_t from)
+{
+	return rohc_bitmap_next(decomp->ctxts_used, decomp->medium.max_cid + 1, from);
+}
+
+
+/**
+ * @brief Point the volatile part of one context to the scratch memory of its
+ *        profile
+ *
+ * The extracted bits come first in the scratch memory, then the decoded
+ * values.
+ *
+ * @param decomp           The ROHC decompressor
+ * @param profile          The profile of the context
+ * @param[out] volat_ctxt  The volatile part of the context
+ */
+static void rohc_decomp_volat_ctxt_init(const struct rohc_decomp *const decomp,
+                                        const struct rohc_decomp_profile *const profile,
+                                        struct rohc_decomp_volat_ctxt *const volat_ctxt)
+{
+	uint8_t *scratch;
+	size_t i;
+
+	i = rohc_decomp_profile_idx(profile->id);
+	assert(i < D_NUM_PROFILES);
+
+	/* the scratch memory was allocated when the profile was enabled */
+	scratch = decomp->volat_scratch[i];
+	assert(scratch != NULL);
+
+	volat_ctxt->extr_bits = scratch;
+	volat_ctxt->decoded_values =
+		scratch + ROHC_CTXT_ARENA_SIZE(profile->extr_bits_len);
+}
+
+
+/**
+ * @brief Get the memory for one new decompression context
+ *
+ * With a dense array of contexts, the context takes the slot of its CID. If
+ * the slot is used by the context that the new one replaces, the new context
+ * takes the slot that was freed last, or any free slot. Without dense array,
+ * the memory is got from the pool of the decompressor.
+ *
+ * @param decomp  The ROHC decompressor
+ * @param cid     The CID of the new context
+ * @return        The zeroed memory for the context, NULL if none is available
+ */
+static void * rohc_decomp_ctxt_mem_get(struct rohc_decomp *const decomp,
+                                       const rohc_cid_t cid)
+{
+	struct rohc_decomp_ctxt *context;
+	size_t slot;
+
+	if(decomp->dense_ctxts == NULL)
+	{
+		return rohc_ctxt_pool_get(decomp->cur_ctxt_pool,
+		                          sizeof(struct rohc_decomp_ctxt), NULL);
+	}
+
+	/* the slots of the contexts in use are recognized by their profile */
+	slot = cid;
+	if(rohc_decomp_dense_slot(decomp, slot)->profile != NULL)
+	{
+		/* the slot of the CID is used by the context that the new context
+		 * replaces, one free slot remains for the new one */
+		slot = decomp->dense_free_hint;
+		if(rohc_decomp_dense_slot(decomp, slot)->profile != NULL)
+		{
+			for(slot = 0; slot < decomp->dense_slots_nr &&
+			    rohc_decomp_dense_slot(decomp, slot)->profile != NULL; slot++)
+			{
+			}
+			if(slot >= decomp->dense_slots_nr)
+			{
+				return NULL;
+			}
+		}
+	}
+	context = rohc_decomp_dense_slot(decomp, slot);
+	memset(context, 0, sizeof(struct rohc_decomp_ctxt));
+
+	return context;
+}
+
+
+/**
+ * @brief Get one slot of the dense array of contexts
+ *
+ * @param decomp  The ROHC decompressor
+ * @param slot    The index of the slot
+ * @return        The context stored in the slot
+ */
+static inline struct rohc_decomp_ctxt *
+	rohc_decomp_dense_slot(const struct rohc_decomp *const decomp,
+	                       const size_t slot)
+{
+	return (struct rohc_decomp_ctxt *)
+		(decomp->dense_ctxts + slot * decomp->dense_slot_len);
+}
+
+
+/**
+ * @brief Give the memory of one decompression context back
+ *
+ * @param decomp   The ROHC decompressor
+ * @param context  The context, its profile-specific parts are already freed
+ */
+static void rohc_decomp_ctxt_mem_put(struct rohc_decomp *const decomp,
+                                     struct rohc_decomp_ctxt *const context)
+{
+	if(rohc_decomp_is_dense(decomp, context))
+	{
+		/* mark the slot as free */
+		context->profile = NULL;
+		decomp->dense_free_hint =
+			(((uint8_t *) context) - decomp->dense_ctxts) / decomp->dense_slot_len;
+	}
+	else
+	{
+		rohc_ctxt_pool_put(decomp->cur_ctxt_pool, context);
+	}
+}
+
+
+/**
+ * @brief Does the given memory belong to the dense array of contexts?
+ *
+ * @param decomp  The ROHC decompressor
+ * @param mem     The memory of a context or of its profile-specific parts
+ * @return        true if the memory is part of one slot of the dense array,
+ *                false if it was got from the pool
+ */
+static bool rohc_decomp_is_dense(const struct rohc_decomp *const decomp,
+                                 const void *const mem)
+{
+	const uint8_t *const bytes = mem;
+
+	return (decomp->dense_ctxts != NULL &&
+	        bytes >= decomp->dense_ctxts &&
+	        bytes < (decomp->dense_ctxts +
+	                 decomp->dense_slots_nr * decomp->dense_slot_len));
+}
+
+
+/**
+ * @brief Get the memory block for the profile-specific parts of one context
+ *
+ * With a dense array of contexts, the block is the end of the slot of the
+ * context, right after the context itself: the decompression of one packet
+ * reads contiguous memory. Otherwise the block is got from the pool of the
+ * decompressor, see \ref rohc_ctxt_pool_get.
+ *
+ * The profile shall get one single block per context, no longer than the
+ * \e ctxt_block_len of the profile.
+ *
+ * @param context     The decompression context
+ * @param size        The size of the block
+ * @param[out] arena  The bump arena to carve the parts of the context from,
+ *                    NULL if the block is used as a whole
+ * @return            The zeroed block, NULL if no memory is available
+ */
+void * rohc_decomp_ctxt_block_get(const struct rohc_decomp_ctxt *const context,
+                                  const size_t size,
+                                  struct rohc_ctxt_arena *const arena)
+{
+	struct rohc_decomp *const decomp = context->decompressor;
+	const size_t ctxt_len = ROHC_CTXT_ARENA_SIZE(sizeof(struct rohc_decomp_ctxt));
+	uint8_t *block;
+
+	assert(size <= context->profile->ctxt_block_len);
+
+	if(!rohc_decomp_is_dense(decomp, context) ||
+	   rohc_ctxt_arena_size(size) > (decomp->dense_slot_len - ctxt_len))
+	{
+		return rohc_ctxt_pool_get(decomp->cur_ctxt_pool, size, arena);
+	}
+
+	block = ((uint8_t *) context) + ctxt_len;
+	memset(block, 0, size);
+	if(arena != NULL)
+	{
+		arena->next = block;
+		arena->len = rohc_ctxt_arena_size(size);
+	}
+
+	return block;
+}
+
+
+/**
+ * @brief Give the memory block of the profile-specific parts of one context
+ *        back
+ *
+ * @param context  The decompression context
+ * @param block    The block got from \ref rohc_decomp_ctxt_block_get,
+ *                 may be NULL
+ */
+void rohc_decomp_ctxt_block_put(const struct rohc_decomp_ctxt *const context,
+                                void *const block)
+{
+	if(block != NULL && !rohc_decomp_is_dense(context->decompressor, block))
+	{
+		rohc_ctxt_pool_put(context->decompressor->cur_ctxt_pool, block);
+	}
+}
+
+
+/**
+ * @brief Is the static chain of one IR packet the one kept by the context?
+ *
+ * @param context   The decompression context
+ * @param chain     The static chain kept by the context
+ * @param data      The static chain of the IR packet, and the data after it
+ * @param data_len  The length of \e data
+ * @return          true if \e data starts with the static chain of the
+ *                  context, false if not or if the context got none
+ */
+bool rohc_decomp_static_chain_match(const struct rohc_decomp_ctxt *const context,
+                                    const struct rohc_decomp_static_chain *const chain,
+                                    const uint8_t *const data,
+                                    const size_t data_len)
+{
+	return (chain->len > 0 && chain->len <= data_len &&
+	        memcmp(rohc_load_pool_get(&context->decompressor->loads_pool,
+	                                  chain->ref), data, chain->len) == 0);
+}
+
+
+/**
+ * @brief Keep the static chain of one IR packet in the context
+ *
+ * The static chains longer than \ref ROHC_LOAD_POOL_MAX_LEN are not kept, nor
+ * the ones there is no memory for: the next IR packets are then fully parsed.
+ *
+ * @param context  The decompression context
+ * @param chain    The static chain kept by the context
+ * @param data     The static chain of the IR packet
+ * @param len      The length of the static chain of the IR packet
+ */
+void rohc_decomp_static_chain_store(const struct rohc_decomp_ctxt *const context,
+                                    struct rohc_decomp_static_chain *const chain,
+                                    const uint8_t *const data,
+                                    const size_t len)
+{
+	struct rohc_load_pool *const pool = &context->decompressor->loads_pool;
+
+	if(len == 0 || len > ROHC_LOAD_POOL_MAX_LEN ||
+	   !rohc_load_pool_reserve(pool, rohc_load_pool_class(len), 1))
+	{
+		rohc_decomp_static_chain_free(context, chain);
+	}
+	else
+	{
+		rohc_load_pool_store(pool, &chain->ref, data, len);
+		chain->len = len;
+	}
+}
+
+
+/**
+ * @brief Forget the static chain kept by the context
+ *
+ * @param context  The decompression context
+ * @param chain    The static chain kept by the context
+ */
+void rohc_decomp_static_chain_free(const struct rohc_decomp_ctxt *const context,
+                                   struct rohc_decomp_static_chain *const chain)
+{
+	rohc_load_pool_put(&context->decompressor->loads_pool, chain->ref);
+	chain->ref = ROHC_LOAD_REF_NONE;
+	chain->len = 0;
 }
 
 
@@ -446,24 +1127,68 @@ struct rohc_decomp * rohc_decomp_new2(const rohc_cid_type_t cid_type,
                                       const rohc_cid_t max_cid,
                                       const rohc_mode_t mode)
 {
+	const struct rohc_decomp_attr attr = {
+		.cid_type = cid_type,
+		.max_cid = max_cid,
+		.mode = mode,
+		.numa_node = ROHC_NUMA_NODE_ANY,
+	};
+
+	return rohc_decomp_new3(&attr);
+}
+
 
+/**
+ * @brief Create a new ROHC decompressor with the given attributes
+ *
+ * Create a new ROHC decompressor like \ref rohc_decomp_new2 does, with the
+ * attributes given in one structure.
+ *
+ * The NUMA node attribute places all the memory of the decompressor on one
+ * NUMA node: the decompressor itself, its contexts, the memory budget, the
+ * dense array of contexts and the RRU buffer. The decompressor is often
+ * created by one control thread, but driven by one worker thread that runs
+ * on another NUMA node: the worker then accesses its contexts without paying
+ * the latency of the remote memory. The kernel falls back on another node if
+ * the given node has no free memory left. NUMA nodes are not supported in
+ * the Linux kernel module.
+ *
+ * A decompressor placed on a NUMA node owns the memory of its contexts, so it
+ * cannot be added to a set of channels, see \ref rohc_channels_add.
+ *
+ * @param attr  The attributes of the new decompressor
+ * @return      The created decompressor if successful,
+ *              NULL if creation failed, if the NUMA node does not exist or
+ *              if NUMA nodes are not supported
+ *
+ * @ingroup rohc_decomp
+ *
+ * @see rohc_decomp_new2
+ * @see rohc_decomp_free
+ */
+struct rohc_decomp * rohc_decomp_new3(const struct rohc_decomp_attr *const attr)
+{
 	struct rohc_decomp *decomp;
 	bool is_fine;
 	size_t i;
 
 	/* check input parameters */
-	if(cid_type == ROHC_SMALL_CID)
+	if(attr == NULL)
+	{
+		goto error;
+	}
+	if(attr->cid_type == ROHC_SMALL_CID)
 	{
 		/* use small CIDs in range [0, ROHC_SMALL_CID_MAX] */
-		if(max_cid > ROHC_SMALL_CID_MAX)
+		if(attr->max_cid > ROHC_SMALL_CID_MAX)
 		{
 			goto error;
 		}
 	}
-	else if(cid_type == ROHC_LARGE_CID)
+	else if(attr->cid_type == ROHC_LARGE_CID)
 	{
 		/* use large CIDs in range [0, ROHC_LARGE_CID_MAX] */
-		if(max_cid > ROHC_LARGE_CID_MAX)
+		if(attr->max_cid > ROHC_LARGE_CID_MAX)
 		{
 			goto error;
 		}
@@ -473,43 +1198,61 @@ struct rohc_decomp * rohc_decomp_new2(const rohc_cid_type_t cid_type,
 		/* unexpected CID type */
 		goto error;
 	}
-	if(mode != ROHC_U_MODE && mode != ROHC_O_MODE && mode != ROHC_R_MODE)
+	if(attr->mode != ROHC_U_MODE && attr->mode != ROHC_O_MODE &&
+	   attr->mode != ROHC_R_MODE)
 	{
 		/* unexpected operational mode */
 		goto error;
 	}
-	else if(mode == ROHC_R_MODE)
+	else if(attr->mode == ROHC_R_MODE)
 	{
 		/* R-mode is not supported yet */
 		goto error;
 	}
+	if(attr->numa_node < ROHC_NUMA_NODE_ANY)
+	{
+		goto error;
+	}
 
-	/* allocate memory for the decompressor */
-	decomp = (struct rohc_decomp *) malloc(sizeof(struct rohc_decomp));
+	/* allocate memory for the decompressor on the NUMA node */
+	decomp = (struct rohc_decomp *)
+		rohc_numa_alloc(sizeof(struct rohc_decomp), attr->numa_node);
 	if(decomp == NULL)
 	{
 		goto error;
 	}
+	decomp->numa_node = attr->numa_node;
 
 	/* no trace callback during decompressor creation */
 	decomp->trace_callback = NULL;
 	decomp->trace_callback_priv = NULL;
+	decomp->trace_level = ROHC_TRACE_DEBUG;
+	decomp->trace_sampling.one_in_n = 0; /* every packet by default */
+	decomp->trace_sampling.errors_only = false;
+	decomp->trace_sampling.cids_nr = 0;
+	decomp->trace_sampled_level = ROHC_TRACE_DEBUG;
+	decomp->trace_pkt_level = &decomp->trace_sampled_level;
+
+	/* no callback for the events of the contexts by default */
+	decomp->event_cb = NULL;
+	decomp->event_cb_priv = NULL;
 
 	/* default feature set (empty for the moment) */
 	decomp->features = ROHC_DECOMP_FEATURE_NONE;
 
 	/* init decompressor medium */
-	decomp->medium.cid_type = cid_type;
-	decomp->medium.max_cid = max_cid;
+	decomp->medium.cid_type = attr->cid_type;
+	decomp->medium.max_cid = attr->max_cid;
 
 	/* all decompression profiles are disabled by default */
 	for(i = 0; i < D_NUM_PROFILES; i++)
 	{
 		decomp->enabled_profiles[i] = false;
+		decomp->volat_scratch[i] = NULL;
 	}
 
 	/* the operational mode the decompressor shall target for all its contexts */
-	decomp->target_mode = mode;
+	decomp->target_mode = attr->mode;
 
 	/* initialize the array of decompression contexts to its minimal value */
 	decomp->contexts = NULL;
@@ -530,46 +1273,75 @@ struct rohc_decomp * rohc_decomp_new2(const rohc_cid_type_t cid_type,
 		assert(is_fine);
 		is_fine = rohc_decomp_set_rate_limits(decomp, 1, prtt, 30, 100, 30, 100);
 		assert(is_fine);
-		decomp->last_pkts_errors = 0;
-		decomp->last_pkt_feedbacks[ROHC_FEEDBACK_ACK].needed = 0;
-		decomp->last_pkt_feedbacks[ROHC_FEEDBACK_ACK].sent = 0;
-		decomp->last_pkt_feedbacks[ROHC_FEEDBACK_NACK].needed = 0;
-		decomp->last_pkt_feedbacks[ROHC_FEEDBACK_NACK].sent = 0;
-		decomp->last_pkt_feedbacks[ROHC_FEEDBACK_STATIC_NACK].needed = 0;
-		decomp->last_pkt_feedbacks[ROHC_FEEDBACK_STATIC_NACK].sent = 0;
+		memset(&decomp->fb_hist, 0, sizeof(struct rohc_decomp_fb_hist));
 	}
 
-	/* no Reconstructed Reception Unit (RRU) at the moment */
+	/* positive ACKs are not delayed by default */
+	decomp->ack_coalescing_window = 0;
+	decomp->ack_coalescing_clock = 0;
+	decomp->pending_acks_nr = 0;
+
+	/* no limit on CRC repairs by default */
+	decomp->crc_repair_ctxt_budget = 0;
+	decomp->crc_repair_global_budget = 0;
+	decomp->crc_repair_global_sec = 0;
+	decomp->crc_repair_global_used = 0;
+
+	/* late packets are not decoded against previous references by default */
+	decomp->reorder_window = 0;
+
+	/* all contexts target the mode given by the user by default, the adaptive
+	 * policy moves a context to O-mode once 1 packet out of 32 fails */
+	is_fine = rohc_decomp_set_mode_policy(decomp, ROHC_DECOMP_MODE_FIXED, 1, 32);
+	assert(is_fine);
+
+	/* no Reconstructed Reception Unit (RRU) at the moment */
+	decomp->rru = NULL;
 	decomp->rru_len = 0;
+	decomp->rru_crc = CRC_INIT_FCS32;
+	decomp->rru_crc_len = 0;
+	decomp->rru_segs = NULL;
+	decomp->rru_segs_nr = 0;
+	decomp->rru_tail_off = 0;
+	decomp->rru_tail_len = 0;
+	decomp->payload_ref = NULL;
+	decomp->rcvd_feedback_ref = false;
+	/* no ring for the feedbacks to send by default */
+	decomp->fb_ring = NULL;
+	decomp->fb_ring_mask = 0;
+	decomp->fb_ring_slot_len = 0;
+	decomp->fb_ring_next = 0;
 	/* no segmentation by default */
 	decomp->mrru = 0;
 
-	/* init the tables for fast CRC computation */
-	is_fine = rohc_crc_init_table(decomp->crc_table_3, ROHC_CRC_TYPE_3);
-	if(is_fine != true)
-	{
-		goto destroy_contexts;
-	}
-	is_fine = rohc_crc_init_table(decomp->crc_table_7, ROHC_CRC_TYPE_7);
-	if(is_fine != true)
-	{
-		goto destroy_contexts;
-	}
-	is_fine = rohc_crc_init_table(decomp->crc_table_8, ROHC_CRC_TYPE_8);
-	if(is_fine != true)
-	{
-		goto destroy_contexts;
-	}
+	/* no memory block kept for the contexts yet */
+	rohc_ctxt_pool_init(&decomp->ctxt_pool);
+	rohc_ctxt_pool_set_numa_node(&decomp->ctxt_pool, decomp->numa_node);
+	decomp->cur_ctxt_pool = &decomp->ctxt_pool;
+	rohc_ctxt_pool_init(&decomp->ctxts_chunks_pool);
+	rohc_ctxt_pool_set_numa_node(&decomp->ctxts_chunks_pool,
+	                             decomp->numa_node);
+	/* no payload stored for the contexts yet */
+	rohc_load_pool_init(&decomp->loads_pool);
+	/* no log of the last packets by default */
+	rohc_pkt_log_init(&decomp->pkt_log);
+	/* no dense array of contexts by default */
+	decomp->dense_ctxts = NULL;
+	decomp->dense_ctxts_mem = NULL;
+	decomp->dense_slot_len = 0;
+	decomp->dense_slots_nr = 0;
+	decomp->dense_free_hint = 0;
+	/* keep idle contexts by default */
+	decomp->ctxts_idle_timeout = 0;
+	decomp->idle_sweep_cid = 0;
 
 	/* reset the decompressor statistics */
 	rohc_decomp_reset_stats(decomp);
 
 	return decomp;
 
-destroy_contexts:
-	free(decomp->contexts);
 destroy_decomp:
-	free(decomp);
+	rohc_numa_free(decomp, sizeof(struct rohc_decomp), attr->numa_node);
 error:
 	return NULL;
 }
@@ -614,18 +1386,41 @@ void rohc_decomp_free(struct rohc_decomp *const decomp)
 	           "free ROHC decompressor");
 
 	/* destroy all the contexts owned by the decompressor */
-	for(i = 0; i <= decomp->medium.max_cid; i++)
+	for(i = rohc_decomp_next_used_cid(decomp, 0); i <= decomp->medium.max_cid;
+	    i = rohc_decomp_next_used_cid(decomp, i + 1))
 	{
-		if(decomp->contexts[i] != NULL)
-		{
-			context_free(decomp->contexts[i]);
-		}
+		context_free(decomp->contexts[i]);
 	}
 	zfree(decomp->contexts);
+	zfree(decomp->ctxts_used);
+	rohc_decomp_destroy_ctxts_chunks(decomp);
 	assert(decomp->num_contexts_used == 0);
 
+	/* destroy the memory blocks kept for the contexts */
+	rohc_ctxt_pool_free(&decomp->ctxt_pool);
+	rohc_decomp_free_dense_ctxts(decomp);
+	rohc_ctxt_pool_free(&decomp->ctxts_chunks_pool);
+
+	/* destroy the payloads stored for the contexts */
+	rohc_load_pool_free(&decomp->loads_pool);
+
+	/* destroy the scratch memory of the profiles */
+	for(i = 0; i < D_NUM_PROFILES; i++)
+	{
+		rohc_free(decomp->volat_scratch[i]);
+	}
+
+	/* destroy the log of the last packets */
+	rohc_pkt_log_free(&decomp->pkt_log);
+
+	/* destroy the ring of the feedbacks to send */
+	rohc_free(decomp->fb_ring);
+
+	/* destroy the RRU buffer */
+	rohc_numa_free(decomp->rru, decomp->mrru, decomp->numa_node);
+
 	/* destroy the decompressor itself */
-	free(decomp);
+	rohc_numa_free(decomp, sizeof(struct rohc_decomp), decomp->numa_node);
 
 error:
 	return;
@@ -705,1025 +1500,4099 @@ rohc_status_t rohc_decompress3(struct rohc_decomp *const decomp,
                                struct rohc_buf *const rcvd_feedback,
                                struct rohc_buf *const feedback_send)
 {
-	rohc_status_t status = ROHC_STATUS_ERROR; /* error status by default */
-	struct rohc_decomp_stream stream;
+	rohc_status_t status;
 
 	/* check inputs validity */
 	if(decomp == NULL)
 	{
 		goto error;
 	}
-	if(rohc_buf_is_malformed(rohc_packet))
+	if(!rohc_decomp_check_bufs(decomp, rohc_packet, uncomp_packet,
+	                           rcvd_feedback, feedback_send))
 	{
-		rohc_warning(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
-		             "given rohc_packet is malformed");
 		goto error;
 	}
-	if(rohc_buf_is_empty(rohc_packet))
+	ROHC_PROBE2(decomp_start, decomp, rohc_packet.len);
+
+	status = rohc_decomp_decompress_one(decomp, rohc_packet, uncomp_packet,
+	                                    rcvd_feedback, feedback_send);
+	ROHC_PROBE3(decomp_done, decomp, status, uncomp_packet->len);
+
+	return status;
+
+error:
+	return ROHC_STATUS_ERROR;
+}
+
+
+/**
+ * @brief Decompress a burst of ROHC packets into uncompressed packets
+ *
+ * Decompress the given ROHC packets into uncompressed packets, as successive
+ * calls to \ref rohc_decompress3 would do, but with less overhead per
+ * packet:
+ *  \li the decompressor is checked once for the whole burst,
+ *  \li the CIDs of the packets are decoded up front, so that the matching
+ *      decompression contexts are prefetched before the packets are
+ *      decompressed.
+ *
+ * The status of the decompression of every packet is stored in the array
+ * \e statuses, see \ref rohc_decompress3 for the possible values. The
+ * decompression of one packet may fail without stopping the decompression
+ * of the next packets.
+ *
+ * The feedback received for the same-side associated compressor and the
+ * feedback to be transmitted to the remote compressor are aggregated for the
+ * whole burst: the feedback items of every packet are appended to
+ * \e rcvd_feedback or \e feedback_send. Feedback items that do not fit in
+ * the buffers are dropped.
+ *
+ * @param decomp               The ROHC decompressor
+ * @param rohc_packets         The compressed packets to decompress
+ * @param[out] uncomp_packets  The resulting uncompressed packets, one empty
+ *                             buffer for every ROHC packet
+ * @param packets_nr           The number of packets in the burst
+ * @param[out] rcvd_feedback   The feedback received from the remote peer for
+ *                             the same-side associated ROHC compressor, may
+ *                             be NULL to ignore the received feedback data
+ * @param[out] feedback_send   The feedback to be transmitted to the remote
+ *                             compressor, may be NULL to disable the
+ *                             generation of feedback
+ * @param[out] statuses        The status of the decompression of every packet
+ * @return                     The number of packets of the burst that were
+ *                             handled (with success or not), 0 if the
+ *                             parameters are invalid
+ *
+ * @ingroup rohc_decomp
+ *
+ * @see rohc_decompress3
+ */
+size_t rohc_decompress_burst(struct rohc_decomp *const decomp,
+                             const struct rohc_buf *const rohc_packets,
+                             struct rohc_buf *const uncomp_packets,
+                             const size_t packets_nr,
+                             struct rohc_buf *const rcvd_feedback,
+                             struct rohc_buf *const feedback_send,
+                             rohc_status_t *const statuses)
+{
+	rohc_cid_t cids[ROHC_DECOMP_BURST_PREFETCH_NR];
+	size_t first;
+
+	/* check inputs validity */
+	if(decomp == NULL)
 	{
-		rohc_warning(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
-		             "given rohc_packet is empty");
 		goto error;
 	}
-	if(uncomp_packet == NULL)
+	if(rohc_packets == NULL || uncomp_packets == NULL || statuses == NULL)
 	{
 		rohc_warning(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
-		             "given uncomp_packet is NULL");
+		             "given arrays of packets or statuses are NULL");
 		goto error;
 	}
-	if(rohc_buf_is_malformed(*uncomp_packet))
+	if(packets_nr == 0)
 	{
-		rohc_warning(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
-		             "given uncomp_packet is malformed");
 		goto error;
 	}
-	if(!rohc_buf_is_empty(*uncomp_packet))
+	if(rcvd_feedback != NULL &&
+	   (rohc_buf_is_malformed(*rcvd_feedback) ||
+	    !rohc_buf_is_empty(*rcvd_feedback)))
 	{
 		rohc_warning(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
-		             "given uncomp_packet is not empty");
+		             "given rcvd_feedback is malformed or not empty");
 		goto error;
 	}
-	if(rcvd_feedback != NULL)
-	{
-		if(rohc_buf_is_malformed(*rcvd_feedback))
-		{
-			rohc_warning(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
-			             "given rcvd_feedback is malformed");
-			goto error;
-		}
-		if(!rohc_buf_is_empty(*rcvd_feedback))
-		{
-			rohc_warning(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
-			             "given rcvd_feedback is not empty");
-			goto error;
-		}
-	}
-	if(feedback_send != NULL)
+	if(feedback_send != NULL &&
+	   (rohc_buf_is_malformed(*feedback_send) ||
+	    !rohc_buf_is_empty(*feedback_send)))
 	{
-		if(rohc_buf_is_malformed(*feedback_send))
-		{
-			rohc_warning(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
-			             "given feedback_send is malformed");
-			goto error;
-		}
-		if(!rohc_buf_is_empty(*feedback_send))
-		{
-			rohc_warning(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
-			             "given feedback_send is not empty");
-			goto error;
-		}
+		rohc_warning(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+		             "given feedback_send is malformed or not empty");
+		goto error;
 	}
 
-	decomp->stats.received++;
-	rohc_debug(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
-	           "decompress the %zu-byte packet #%lu", rohc_packet.len,
-	           decomp->stats.received);
-
-	/* print compressed bytes */
-	if((decomp->features & ROHC_DECOMP_FEATURE_DUMP_PACKETS) != 0)
+	for(first = 0; first < packets_nr; first += ROHC_DECOMP_BURST_PREFETCH_NR)
 	{
-		rohc_dump_packet(decomp->trace_callback, decomp->trace_callback_priv,
-		                 ROHC_TRACE_DECOMP, ROHC_TRACE_DEBUG,
-		                 "compressed data, max 100 bytes", rohc_packet);
-	}
+		const size_t nr = rohc_min(packets_nr - first,
+		                           ROHC_DECOMP_BURST_PREFETCH_NR);
+		size_t i;
 
-	/* decode ROHC header */
-	status = d_decode_header(decomp, rohc_packet, uncomp_packet, rcvd_feedback,
-	                         &stream);
-	assert(status != ROHC_STATUS_SEGMENT);
+		/* decode the CIDs of the packets up front, and prefetch the
+		 * locations of their contexts */
+		for(i = 0; i < nr; i++)
+		{
+			if(!rohc_decomp_peek_cid(decomp, rohc_packets[first + i], &cids[i]) ||
+			   cids[i] > decomp->medium.max_cid)
+			{
+				cids[i] = SIZE_MAX;
+			}
+			else
+			{
+				__builtin_prefetch(&decomp->contexts[cids[i]]);
+			}
+		}
 
-	/* handle mode transitions if context was found and it is still valid */
-	if(stream.context != NULL)
-	{
-		if(stream.context->mode == ROHC_U_MODE)
+		for(i = 0; i < nr; i++)
 		{
-			if(decomp->target_mode == ROHC_U_MODE)
+			struct rohc_buf *const uncomp_packet = &uncomp_packets[first + i];
+			struct rohc_buf rcvd_feedback_pkt;
+			struct rohc_buf feedback_send_pkt;
+			struct rohc_buf *rcvd_feedback_ptr = NULL;
+			struct rohc_buf *feedback_send_ptr = NULL;
+
+			/* prefetch the context of the next packet */
+			if((i + 1) < nr && cids[i + 1] != SIZE_MAX &&
+			   decomp->contexts[cids[i + 1]] != NULL)
 			{
-				rohc_debug(decomp, ROHC_TRACE_DECOMP, stream.profile_id,
-				           "stay in U-mode as requested by user");
+				__builtin_prefetch(decomp->contexts[cids[i + 1]]);
 			}
-			else if(decomp->target_mode == ROHC_O_MODE)
+
+			/* the feedback items of the packet are appended to the ones of the
+			 * previous packets of the burst */
+			if(rcvd_feedback != NULL)
 			{
-				rohc_debug(decomp, ROHC_TRACE_DECOMP, stream.profile_id,
-				           "transit from U-mode to O-mode as requested by user");
-				stream.context->mode = ROHC_O_MODE;
-				/* ACK(O), NACK(O) or STATIC-NACK(O) will transmit the mode
-				 * transition to the remote compressor */
-				stream.mode = ROHC_O_MODE;
-				stream.do_change_mode = true;
+				rcvd_feedback_pkt = *rcvd_feedback;
+				rohc_buf_pull(&rcvd_feedback_pkt, rcvd_feedback->len);
+				rcvd_feedback_ptr = &rcvd_feedback_pkt;
 			}
-			else /* R-mode */
+			if(feedback_send != NULL)
 			{
-				assert(0); /* TODO: R-mode not supported yet */
-				status = ROHC_STATUS_ERROR;
-				goto error;
+				feedback_send_pkt = *feedback_send;
+				rohc_buf_pull(&feedback_send_pkt, feedback_send->len);
+				feedback_send_ptr = &feedback_send_pkt;
 			}
-		}
-		else if(stream.context->mode == ROHC_O_MODE)
-		{
-			if(decomp->target_mode == ROHC_U_MODE)
+
+			if(!rohc_decomp_check_bufs(decomp, rohc_packets[first + i],
+			                           uncomp_packet, rcvd_feedback_ptr,
+			                           feedback_send_ptr))
 			{
-				assert(0); /* TODO: O- to U-mode transition not supported yet */
-				status = ROHC_STATUS_ERROR;
-				goto error;
+				statuses[first + i] = ROHC_STATUS_ERROR;
+				continue;
 			}
-			else if(decomp->target_mode == ROHC_O_MODE)
+			statuses[first + i] =
+				rohc_decomp_decompress_one(decomp, rohc_packets[first + i],
+				                           uncomp_packet, rcvd_feedback_ptr,
+				                           feedback_send_ptr);
+
+			if(rcvd_feedback != NULL)
 			{
-				rohc_debug(decomp, ROHC_TRACE_DECOMP, stream.profile_id,
-				           "stay in O-mode as requested by user");
+				rcvd_feedback->len += rcvd_feedback_pkt.len;
 			}
-			else /* R-mode */
+			if(feedback_send != NULL)
 			{
-				assert(0); /* TODO: R-mode not supported yet */
-				status = ROHC_STATUS_ERROR;
-				goto error;
+				feedback_send->len += feedback_send_pkt.len;
 			}
 		}
-		else /* R-mode */
-		{
-			assert(0); /* TODO: R-mode not supported yet */
-			status = ROHC_STATUS_ERROR;
-			goto error;
-		}
 	}
 
-	/* update statistics and send feedback if needed */
-	if(status == ROHC_STATUS_OK)
-	{
-		/* print a trace to report success (the context may be NULL if packet
-		 * was a feedback-only packet) */
-		rohc_debug(decomp, ROHC_TRACE_DECOMP, stream.profile_id,
-		           "packet decompression succeeded");
+	return packets_nr;
 
-		/* do not update statistics and build positive feedback for feedback-only
-		 * packets */
-		if(uncomp_packet->len > 0)
-		{
-			/* update statistics */
-			rohc_debug(decomp, ROHC_TRACE_DECOMP, stream.profile_id,
-			           "update decompressor and context statistics");
-			assert(stream.context != NULL);
-			stream.context->num_recv_packets++;
-			stream.context->packet_type = stream.packet_type;
-			stream.context->total_uncompressed_size += uncomp_packet->len;
-			stream.context->total_compressed_size += rohc_packet.len;
-			decomp->stats.total_uncompressed_size += uncomp_packet->len;
-			decomp->stats.total_compressed_size += rohc_packet.len;
+error:
+	return 0;
+}
 
-			/* build positive feedback if asked by user and if needed by decompressor */
-			if(!rohc_decomp_feedback_ack(decomp, &stream, feedback_send))
-			{
-				rohc_warning(decomp, ROHC_TRACE_DECOMP, stream.profile_id,
-				             "failed to build positive feedback");
-				status = ROHC_STATUS_ERROR;
-				goto error;
-			}
-		}
+
+/**
+ * @brief Decompress one ROHC packet given as a scatter list of segments
+ *
+ * Reassemble the Reconstructed Reception Unit (RRU) from the given ROHC
+ * segments, check its FCS-32 CRC and decompress it, as successive calls to
+ * \ref rohc_decompress3 with the segments would do, but without copying the
+ * segments into the staging RRU of the decompressor:
+ *  \li the FCS-32 CRC is computed segment after segment,
+ *  \li the ROHC header is parsed in place in the first segment, only the
+ *      first bytes of the RRU (at most \ref ROHC_DECOMP_RRU_HDR_MAX bytes)
+ *      are linearized if the first segment is too short to hold the ROHC
+ *      header,
+ *  \li the payload is copied straight from the segments to the uncompressed
+ *      packet.
+ *
+ * The segments shall be given in order, from the first one to the final
+ * one. Every segment shall start with its segment type byte: padding and
+ * feedback items are not allowed before it. The segments are not referenced
+ * anymore once the function returns.
+ *
+ * Segmentation shall be enabled with \ref rohc_decomp_set_mrru. Segments
+ * may not be given to the function while a RRU is being reassembled with
+ * \ref rohc_decompress3: the two reassemblies are independent.
+ *
+ * @param decomp               The ROHC decompressor
+ * @param segments             The ROHC segments of the RRU
+ * @param segments_nr          The number of ROHC segments
+ * @param[out] uncomp_packet   The resulting uncompressed packet
+ * @param[out] rcvd_feedback   Reserved for the feedback received from the
+ *                             remote peer, may be NULL
+ * @param[out] feedback_send   The feedback to be transmitted to the remote
+ *                             compressor, may be NULL to disable the
+ *                             generation of feedback
+ * @return                     The decompression status, see
+ *                             \ref rohc_decompress3
+ *
+ * @ingroup rohc_decomp
+ *
+ * @see rohc_decompress3
+ * @see rohc_decomp_set_mrru
+ * @see rohc_comp_segment_iov
+ */
+rohc_status_t rohc_decompress_segments(struct rohc_decomp *const decomp,
+                                       const struct rohc_buf *const segments,
+                                       const size_t segments_nr,
+                                       struct rohc_buf *const uncomp_packet,
+                                       struct rohc_buf *const rcvd_feedback,
+                                       struct rohc_buf *const feedback_send)
+{
+	struct rohc_buf rru_hdr;
+	uint32_t crc_computed = CRC_INIT_FCS32;
+	uint32_t crc_packet;
+	size_t rru_len = 0;
+	size_t crc_len;
+	rohc_status_t status;
+	size_t i;
+
+	/* check inputs validity */
+	if(decomp == NULL)
+	{
+		goto error;
 	}
-	else /* packet failed to be decompressed */
+	if(segments == NULL || segments_nr == 0)
 	{
-		/* in case of failure, users shall get an empty decompressed packet */
-		uncomp_packet->len = 0;
+		rohc_warning(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+		             "given segments are NULL or empty");
+		goto error;
+	}
+	if(!rohc_decomp_check_bufs(decomp, segments[0], uncomp_packet,
+	                           rcvd_feedback, feedback_send))
+	{
+		goto error;
+	}
+	if(decomp->mrru == 0)
+	{
+		rohc_warning(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+		             "segmentation is disabled: MRRU is 0");
+		goto error;
+	}
 
-		rohc_warning(decomp, ROHC_TRACE_DECOMP, stream.profile_id,
-		             "packet decompression failed: %s (%d)",
-		             rohc_strerror(status), status);
+	/* check the segments, compute the length of the RRU */
+	for(i = 0; i < segments_nr; i++)
+	{
+		const bool must_be_final = !!((i + 1) == segments_nr);
 
-		/* update statistics */
-		if(stream.context != NULL)
-		{
-			stream.context->num_recv_packets++;
-		}
-		switch(status)
+		if(rohc_buf_is_malformed(segments[i]) || segments[i].len < 2 ||
+		   !rohc_decomp_packet_is_segment(rohc_buf_data(segments[i])) ||
+		   (!!GET_REAL(GET_BIT_0(rohc_buf_data(segments[i])))) != must_be_final)
 		{
-			case ROHC_STATUS_MALFORMED:
-			case ROHC_STATUS_OUTPUT_TOO_SMALL:
-			case ROHC_STATUS_ERROR:
-				decomp->stats.failed_decomp++;
-				break;
-			case ROHC_STATUS_NO_CONTEXT:
-				decomp->stats.failed_no_context++;
-				break;
-			case ROHC_STATUS_BAD_CRC:
-				decomp->stats.failed_crc++;
-				break;
-			case ROHC_STATUS_OK: /* success codes shall not happen */
-			case ROHC_STATUS_SEGMENT:
-			default:
-				assert(0);
-				status = ROHC_STATUS_ERROR;
-				goto error;
+			rohc_warning(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+			             "segment #%zu is not a valid %s segment", i + 1,
+			             must_be_final ? "final" : "non-final");
+			goto error_malformed;
 		}
+		rru_len += segments[i].len - 1;
+	}
+	if(rru_len > decomp->mrru || rru_len <= CRC_FCS32_LEN)
+	{
+		rohc_warning(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+		             "invalid %zu-byte RRU: should be more than %u-byte long "
+		             "and not exceed the %zu-byte MRRU", rru_len, CRC_FCS32_LEN,
+		             decomp->mrru);
+		goto error_malformed;
+	}
+	rru_len -= CRC_FCS32_LEN;
 
-		/* build negative feedback if asked by user and if needed by decompressor */
-		if(!rohc_decomp_feedback_nack(decomp, &stream, feedback_send))
-		{
-			rohc_warning(decomp, ROHC_TRACE_DECOMP, stream.profile_id,
-			             "failed to build negative feedback");
-			status = ROHC_STATUS_ERROR;
-			goto error;
-		}
+	/* compute the CRC of the RRU segment after segment */
+	crc_len = 0;
+	for(i = 0; i < segments_nr && crc_len < rru_len; i++)
+	{
+		const size_t seg_crc_len = rohc_min(segments[i].len - 1, rru_len - crc_len);
+		crc_computed = crc_calc_fcs32(rohc_buf_data(segments[i]) + 1, seg_crc_len,
+		                              crc_computed);
+		crc_len += seg_crc_len;
+	}
+	rohc_decomp_rru_copy(segments, segments_nr, rru_len, CRC_FCS32_LEN,
+	                     (uint8_t *) &crc_packet);
+	if(crc_computed != crc_packet)
+	{
+		rohc_warning(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+		             "invalid %zu-byte RRU: bad CRC (packet = 0x%08x, "
+		             "computed = 0x%08x)", rru_len, rohc_ntoh32(crc_packet),
+		             rohc_ntoh32(crc_computed));
+		decomp->stats.received++;
+		decomp->stats.failed_crc++;
+		goto error_crc;
 	}
 
-error:
+	/* parse the ROHC header in place in the first segment if it is large
+	 * enough, linearize the first bytes of the RRU otherwise */
+	if((segments[0].len - 1) >= rohc_min(rru_len, ROHC_DECOMP_RRU_HDR_MAX))
+	{
+		rru_hdr = segments[0];
+		rohc_buf_pull(&rru_hdr, 1);
+		rru_hdr.len = rohc_min(rru_hdr.len, rru_len);
+	}
+	else
+	{
+		const size_t rru_hdr_len = rohc_min(rru_len, ROHC_DECOMP_RRU_HDR_MAX);
+		rohc_decomp_rru_copy(segments, segments_nr, 0, rru_hdr_len,
+		                     decomp->rru_hdr);
+		rru_hdr.time = segments[0].time;
+		rru_hdr.data = decomp->rru_hdr;
+		rru_hdr.max_len = rru_hdr_len;
+		rru_hdr.offset = 0;
+		rru_hdr.len = rru_hdr_len;
+	}
+	rohc_debug(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+	           "decode the %zu-byte RRU from %zu segments (%zu bytes parsed "
+	           "in place)", rru_len, segments_nr, rru_hdr.len);
+
+	/* decompress the RRU, the end of the payload is read from the segments */
+	decomp->rru_segs = segments;
+	decomp->rru_segs_nr = segments_nr;
+	decomp->rru_tail_off = rru_hdr.len;
+	decomp->rru_tail_len = rru_len - rru_hdr.len;
+	status = rohc_decomp_decompress_one(decomp, rru_hdr, uncomp_packet,
+	                                    rcvd_feedback, feedback_send);
+	decomp->rru_segs = NULL;
+	decomp->rru_segs_nr = 0;
+	decomp->rru_tail_off = 0;
+	decomp->rru_tail_len = 0;
+
 	return status;
+
+error:
+	return ROHC_STATUS_ERROR;
+
+error_crc:
+	return ROHC_STATUS_BAD_CRC;
+
+error_malformed:
+	decomp->stats.received++;
+	decomp->stats.failed_decomp++;
+	return ROHC_STATUS_MALFORMED;
 }
 
 
 /**
- * @brief Decompress the compressed headers.
+ * @brief Decompress the given ROHC packet into uncompressed headers and a
+ *        reference to the payload
+ *
+ * Decompress the given ROHC packet as \ref rohc_decompress3 does, but
+ * without copying the payload: only the uncompressed headers are written in
+ * the output buffer \e uncomp_hdrs, and \e payload is set to the part of the
+ * ROHC packet that follows the ROHC header. The uncompressed packet is the
+ * uncompressed headers followed by the payload, so that the network layer
+ * may deliver it without any copy.
+ *
+ * The end of the payload may be stored outside of \e rohc_packet, eg. in the
+ * paged fragments of a Linux sk_buff: \e payload_tail_len gives its length.
+ * The ROHC header shall be entirely part of \e rohc_packet, otherwise the
+ * packet is considered as malformed. The payload tail is never read.
+ *
+ * The payload references the memory of \e rohc_packet: it is valid as long
+ * as the ROHC packet is. It is followed by the payload tail, if any. The
+ * offset of the payload in the ROHC packet is the difference between the
+ * \e offset fields of \e payload and \e rohc_packet.
+ *
+ * The amount of work does not depend on the length of the payload: a probe
+ * that only inspects the uncompressed headers, eg. a DPI middlebox, may give
+ * the captured beginning of the ROHC packet in \e rohc_packet and the length
+ * of the part that was not captured in \e payload_tail_len. The lengths of
+ * the uncompressed headers are still computed from the full payload length.
+ *
+ * ROHC segments are not supported, use \ref rohc_decompress3 for them.
  *
  * @param decomp              The ROHC decompressor
- * @param rohc_packet         The ROHC packet to decode
- * @param[out] uncomp_packet  The uncompressed packet
+ * @param rohc_packet         The compressed packet to decompress, ROHC
+ *                            header and beginning of the payload
+ * @param payload_tail_len    The length of the end of the payload that is
+ *                            not part of \e rohc_packet
+ * @param[out] uncomp_hdrs    The resulting uncompressed headers
+ * @param[out] payload        The part of the payload within the memory of the
+ *                            ROHC packet
  * @param[out] rcvd_feedback  The feedback received from the remote peer for
- *                            the same-side associated ROHC compressor through
- *                            the feedback channel:
- *                            \li If NULL, ignore the received feedback data
- *                            \li If not NULL, store the received feedback in
- *                                at the given address
- * @param[out] stream         The informations about the decompressed stream,
- *                            required for sending feedback to compressor
- * @return                    Possible return values:
- *                            \li ROHC_STATUS_OK if packet is successfully
- *                                decoded,
- *                            \li ROHC_STATUS_NO_CONTEXT if no matching
- *                                context was found and packet cannot create
- *                                a new context (or failed to do so),
- *                            \li ROHC_STATUS_MALFORMED if packet is
- *                                malformed,
- *                            \li ROHC_STATUS_BAD_CRC if a CRC error occurs,
- *                            \li ROHC_STATUS_ERROR if another error occurs
+ *                            the same-side associated ROHC compressor, may be
+ *                            NULL to ignore the received feedback data
+ * @param[out] feedback_send  The feedback to be transmitted to the remote
+ *                            compressor, may be NULL to disable the generation
+ *                            of feedback
+ * @return                    The same values as \ref rohc_decompress3
+ *
+ * @ingroup rohc_decomp
+ *
+ * @see rohc_decompress3
+ * @see rohc_compress_iov
  */
-static rohc_status_t d_decode_header(struct rohc_decomp *decomp,
-                                     const struct rohc_buf rohc_packet,
-                                     struct rohc_buf *const uncomp_packet,
-                                     struct rohc_buf *const rcvd_feedback,
-                                     struct rohc_decomp_stream *const stream)
+rohc_status_t rohc_decompress_iov(struct rohc_decomp *const decomp,
+                                  const struct rohc_buf rohc_packet,
+                                  const size_t payload_tail_len,
+                                  struct rohc_buf *const uncomp_hdrs,
+                                  struct rohc_buf *const payload,
+                                  struct rohc_buf *const rcvd_feedback,
+                                  struct rohc_buf *const feedback_send)
 {
-	const struct rohc_decomp_profile *profile;
-	bool is_new_context = false;
-	size_t sn_feedback_min_bits;
-	size_t add_cid_len;
-	size_t large_cid_len;
-
-	struct rohc_buf remain_rohc_data = rohc_packet;
-	const uint8_t *walk;
-	size_t remain_len;
-
 	rohc_status_t status;
 
-	/* at the beginning, context is not found yet but channel CID type is known */
-	stream->profile_id = ROHC_PROFILE_GENERAL;
-	stream->cid_type = decomp->medium.cid_type;
-	stream->cid_found = false;
-	stream->cid = SIZE_MAX;
-	stream->context_found = false;
-	stream->context = NULL;
-	stream->mode = ROHC_UNKNOWN_MODE;
-	stream->state = ROHC_DECOMP_STATE_UNKNOWN;
-	stream->do_change_mode = false;
-	stream->sn_bits = 0; /* must be set to 0 until we get some bits */
-	stream->sn_bits_nr = 0;
-	stream->packet_type = ROHC_PACKET_UNKNOWN;
-	stream->crc_failed = false;
-
-	/* empty ROHC packets are not considered as valid */
-	if(remain_rohc_data.len < 1)
+	/* check inputs validity */
+	if(decomp == NULL)
+	{
+		goto error;
+	}
+	if(payload == NULL)
 	{
 		rohc_warning(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
-		             "ROHC packet too small (len = %zu, at least 1 byte "
-		             "required)", remain_rohc_data.len);
-		goto error_malformed;
+		             "given payload is NULL");
+		goto error;
+	}
+	if(!rohc_decomp_check_bufs(decomp, rohc_packet, uncomp_hdrs,
+	                           rcvd_feedback, feedback_send))
+	{
+		goto error;
 	}
 
-	/* skip padding bits if some are present */
-	rohc_decomp_parse_padding(decomp, &remain_rohc_data);
+	/* the payload is empty until the packet is successfully decompressed */
+	*payload = rohc_packet;
+	payload->len = 0;
 
-	/* padding-only packets are not allowed according to RFC 3095, §5.2:
-	 *   Padding is any number (zero or more) of padding octets.  Either of
-	 *   Feedback or Header must be present. */
-	if(remain_rohc_data.len == 0)
+	/* decompress the packet, the payload is referenced instead of copied */
+	decomp->payload_ref = payload;
+	decomp->rru_tail_len = payload_tail_len;
+	status = rohc_decomp_decompress_one(decomp, rohc_packet, uncomp_hdrs,
+	                                    rcvd_feedback, feedback_send);
+	decomp->payload_ref = NULL;
+	decomp->rru_tail_len = 0;
+
+	if(status != ROHC_STATUS_OK)
 	{
-		rohc_debug(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
-		           "padding-only packet is not allowed");
-		goto error_malformed;
+		payload->len = 0;
 	}
 
-	/* extract feedback items if present */
-	if(!rohc_decomp_parse_feedbacks(decomp, &remain_rohc_data, rcvd_feedback))
+	return status;
+
+error:
+	return ROHC_STATUS_ERROR;
+}
+
+
+/**
+ * @brief Decompress one ROHC packet, the feedbacks being returned as views
+ *
+ * Decompress the given ROHC packet as \ref rohc_decompress3 does, but do not
+ * copy the feedbacks:
+ *  \li \e rcvd_feedback is set to the part of \e rohc_packet that contains
+ *      the feedback items received for the same-side associated compressor:
+ *      it is valid as long as the ROHC packet is ;
+ *  \li \e feedback_send is set to the feedback to be transmitted to the
+ *      remote compressor, built in the next slot of the ring of the
+ *      decompressor, see \ref rohc_decomp_set_feedback_ring: it is valid
+ *      until the next \e slots_nr - 1 non-empty feedbacks are returned.
+ *
+ * The feedback items that do not fit in one slot of the ring are dropped.
+ * The views are empty if there is no feedback.
+ *
+ * @param decomp              The ROHC decompressor
+ * @param rohc_packet         The compressed packet to decompress
+ * @param[out] uncomp_packet  The resulting uncompressed packet, see
+ *                            \ref rohc_decompress3
+ * @param[out] rcvd_feedback  The view on the feedback received from the
+ *                            remote peer for the same-side associated ROHC
+ *                            compressor, may be NULL to ignore the received
+ *                            feedback data
+ * @param[out] feedback_send  The view on the feedback to be transmitted to
+ *                            the remote compressor, may be NULL to disable
+ *                            the generation of feedback
+ * @return                    The same values as \ref rohc_decompress3, and
+ *                            \ref ROHC_STATUS_ERROR if \e feedback_send is
+ *                            given while the ring of the decompressor is
+ *                            disabled
+ *
+ * @ingroup rohc_decomp
+ *
+ * @see rohc_decompress3
+ * @see rohc_decomp_set_feedback_ring
+ */
+rohc_status_t rohc_decompress_fb_views(struct rohc_decomp *const decomp,
+                                       const struct rohc_buf rohc_packet,
+                                       struct rohc_buf *const uncomp_packet,
+                                       struct rohc_buf *const rcvd_feedback,
+                                       struct rohc_buf *const feedback_send)
+{
+	struct rohc_buf *feedback_send_slot = NULL;
+	struct rohc_buf slot;
+	rohc_status_t status;
+
+	/* check inputs validity */
+	if(decomp == NULL)
 	{
-		rohc_warning(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
-		             "failed to decode feedback items at the beginning of the "
-		             "ROHC packet");
-		goto error_malformed;
+		goto error;
 	}
-	if(rcvd_feedback != NULL)
+	if(!rohc_decomp_check_bufs(decomp, rohc_packet, uncomp_packet, NULL, NULL))
 	{
-		rohc_debug(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
-		           "decompressor received %zu bytes of feedback for the "
-		           "same-side associated compressor", rcvd_feedback->len);
+		goto error;
 	}
-	walk = rohc_buf_data(remain_rohc_data);
-	remain_len = remain_rohc_data.len;
-
-	/* is there some data after feedback? */
-	if(remain_rohc_data.len == 0)
+	if(rcvd_feedback != NULL)
 	{
-		rohc_debug(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
-		           "feedback-only packet, stop decompression");
-		goto skip;
+		*rcvd_feedback = rohc_packet;
+		rcvd_feedback->len = 0;
 	}
-
-	/* ROHC segment? */
-	if(rohc_decomp_packet_is_segment(walk))
+	if(feedback_send != NULL)
 	{
-		const bool is_final = !!GET_REAL(GET_BIT_0(walk));
-		uint32_t crc_computed;
-
-		/* skip the segment type byte */
-		walk++;
-		remain_len--;
-		rohc_buf_pull(&remain_rohc_data, 1);
-
-		rohc_debug(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
-		           "ROHC packet is a %zu-byte %s segment", remain_len,
-		           is_final ? "final" : "non-final");
-
-		/* store all the remaining ROHC data in RRU */
-		if((decomp->rru_len + remain_len) > decomp->mrru)
+		if(decomp->fb_ring == NULL)
 		{
 			rohc_warning(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
-			             "invalid RRU: received segment is too large for MRRU "
-			             "(%zu bytes already received, %zu bytes received, "
-			             "MRRU = %zu bytes", decomp->rru_len, remain_len,
-			             decomp->mrru);
-			/* dicard RRU */
-			decomp->rru_len = 0;
-			goto error_malformed;
+			             "no ring for the feedbacks to send, see "
+			             "rohc_decomp_set_feedback_ring()");
+			goto error;
 		}
-		rohc_debug(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
-		           "append new segment to the %zd bytes we already received",
-		           decomp->rru_len);
-		memcpy(decomp->rru + decomp->rru_len, walk, remain_len);
-		decomp->rru_len += remain_len;
+		slot.time = rohc_packet.time;
+		slot.data = decomp->fb_ring + decomp->fb_ring_slot_len *
+		            (decomp->fb_ring_next & decomp->fb_ring_mask);
+		slot.max_len = decomp->fb_ring_slot_len;
+		slot.offset = 0;
+		slot.len = 0;
+		feedback_send_slot = &slot;
+	}
+
+	/* decompress the packet, the received feedback is referenced instead of
+	 * copied, the feedback to send is built in place in the ring */
+	decomp->rcvd_feedback_ref = true;
+	status = rohc_decomp_decompress_one(decomp, rohc_packet, uncomp_packet,
+	                                    rcvd_feedback, feedback_send_slot);
+	decomp->rcvd_feedback_ref = false;
 
-		/* stop decoding here is not final segment */
-		if(!is_final)
+	if(feedback_send != NULL)
+	{
+		*feedback_send = slot;
+		if(slot.len > 0)
 		{
-			rohc_debug(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
-			           "%zd bytes of RRU already received, wait for more "
-			           "segments before decompressing RRU", decomp->rru_len);
-			goto skip;
+			decomp->fb_ring_next++;
 		}
+	}
 
-		/* final segment received, let's check CRC */
-		if(decomp->rru_len <= 4)
-		{
-			rohc_warning(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
-			             "invalid %zd-byte RRU: should be more than 4-byte long",
-			             decomp->rru_len);
-			/* discard RRU */
-			decomp->rru_len = 0;
-			goto error_malformed;
-		}
-		decomp->rru_len -= 4;
-		rohc_debug(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
-		           "final segment received, check the 4-byte CRC of the "
-		           "%zd-byte RRU", decomp->rru_len);
-		crc_computed = crc_calc_fcs32(decomp->rru, decomp->rru_len,
-		                              CRC_INIT_FCS32);
-		if(memcmp(&crc_computed, decomp->rru + decomp->rru_len, 4) != 0)
-		{
-			uint32_t crc_packet;
-			memcpy(&crc_packet, decomp->rru + decomp->rru_len, 4);
-			rohc_warning(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
-			             "invalid %zd-byte RRU: bad CRC (packet = 0x%08x, "
-			             "computed = 0x%08x)", decomp->rru_len,
-			             rohc_ntoh32(crc_packet), rohc_ntoh32(crc_computed));
-			/* discard RRU */
-			decomp->rru_len = 0;
-			goto error_crc;
-		}
+	return status;
 
-		/* CRC of segment is OK, let's decode RRU */
-		rohc_debug(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
-		           "final segment received, decode the %zd-byte RRU",
-		           decomp->rru_len);
-		walk = decomp->rru;
-		remain_len = decomp->rru_len;
-		remain_rohc_data.offset = 0;
-		remain_rohc_data.data = decomp->rru;
-		remain_rohc_data.len = decomp->rru_len;
-		remain_rohc_data.max_len = decomp->rru_len;
+error:
+	return ROHC_STATUS_ERROR;
+}
 
-		/* reset context for next RRU */
-		decomp->rru_len = 0;
-	}
 
-	/* decode small or large CID */
-	if(!rohc_decomp_decode_cid(decomp, walk, remain_len, &stream->cid,
-	                           &add_cid_len, &large_cid_len))
-	{
-		rohc_warning(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
-		             "failed to decode small or large CID in packet");
-		goto error_malformed;
-	}
-	stream->cid_found = true;
+/**
+ * @brief Extract the feedback of a feedback-only ROHC packet
+ *
+ * On a reverse channel, many ROHC packets carry feedback items only. This
+ * function is a fast path for them: the padding and the feedback items are
+ * parsed the way \ref rohc_decompress3 parses them, and the feedback items
+ * are referenced in the ROHC packet instead of being copied, ready to be
+ * delivered to the same-side associated compressor with
+ * \ref rohc_comp_deliver_feedback2.
+ *
+ * The packet is not decompressed: the decompressor is not changed, no
+ * statistics are updated, and no feedback is built for the remote
+ * compressor. The function may thus be called from any thread.
+ *
+ * If the ROHC packet is not a feedback-only packet or if it is malformed, the
+ * function returns false, and the packet shall be given to
+ * \ref rohc_decompress3 as usual.
+ *
+ * @param decomp              The ROHC decompressor
+ * @param rohc_packet         The ROHC packet to parse
+ * @param[out] rcvd_feedback  The view on the feedback items of the ROHC
+ *                            packet, empty if the packet is not a
+ *                            feedback-only packet
+ * @return                    true if the ROHC packet is a feedback-only
+ *                            packet, false if it is not, if it is malformed,
+ *                            or if a parameter is invalid
+ *
+ * @ingroup rohc_decomp
+ *
+ * @see rohc_decompress3
+ * @see rohc_comp_deliver_feedback2
+ */
+bool rohc_decomp_parse_feedback_only(const struct rohc_decomp *const decomp,
+                                     const struct rohc_buf rohc_packet,
+                                     struct rohc_buf *const rcvd_feedback)
+{
+	struct rohc_buf remain = rohc_packet;
+	size_t padding_len;
 
-	/* check whether the decoded CID is allowed by the decompressor */
-	if(stream->cid > decomp->medium.max_cid)
+	if(decomp == NULL || rcvd_feedback == NULL)
 	{
-		rohc_warning(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
-		             "unexpected CID %zu received: MAX_CID was set to %zu",
-		             stream->cid, decomp->medium.max_cid);
-		goto error_no_context;
+		goto error;
 	}
-
-	/* skip add-CID if present */
-	walk += add_cid_len;
-	remain_len -= add_cid_len;
-	rohc_buf_pull(&remain_rohc_data, add_cid_len);
-
-	/* find the context according to the CID found in CID,
-	 * create it if needed (and possible) */
-	status = rohc_decomp_find_context(decomp, walk, remain_len, stream->cid,
-	                                  large_cid_len, rohc_packet.time,
-	                                  &stream->profile_id, &stream->context,
-	                                  &is_new_context);
-	if(status == ROHC_STATUS_MALFORMED)
+	*rcvd_feedback = rohc_packet;
+	rcvd_feedback->len = 0;
+	if(rohc_buf_is_malformed(rohc_packet))
 	{
-		/* no additional feedback information to collect */
-		goto error_malformed;
+		goto error;
 	}
-	else if(status == ROHC_STATUS_NO_CONTEXT)
+
+	/* skip padding and feedback items, nothing shall remain */
+	if(!rohc_decomp_skip_fb_prefix(&remain, &padding_len) || remain.len > 0)
 	{
-		/* even if the context was not found/created, the profile ID might be available */
-		goto error_no_context;
+		goto error;
 	}
-	assert(status == ROHC_STATUS_OK);
-	profile = stream->context->profile;
-	decomp->last_context = stream->context;
-	sn_feedback_min_bits = rohc_min(decomp->sn_feedback_min_bits,
-	                                profile->msn_max_bits);
 
-	/* collect information for sending feedback to decompressor */
-	stream->context_found = true;
-	stream->mode = stream->context->mode;
-	stream->state = stream->context->state;
-	if(!is_new_context)
+	/* reference the feedback items after the padding */
+	rohc_buf_pull(rcvd_feedback, padding_len);
+	rcvd_feedback->len = rohc_packet.len - padding_len;
+
+	return true;
+
+error:
+	return false;
+}
+
+
+/**
+ * @brief Create one decompression context from the IR packet of a known flow
+ *
+ * The context of a known, long-lived flow is created before the first
+ * packet of the flow, for example at startup from an out-of-band
+ * configuration. The IR packet is the one built by the remote compressor
+ * with \ref rohc_comp_prewarm_context. It is decompressed as usual, but the
+ * decompressed packet is dropped and no feedback is generated.
+ *
+ * @param decomp   The ROHC decompressor
+ * @param rohc_ir  The IR packet that describes the context
+ * @return         true if the context was created, false otherwise
+ *
+ * @ingroup rohc_decomp
+ *
+ * @see rohc_comp_prewarm_context
+ */
+bool rohc_decomp_prewarm_context(struct rohc_decomp *const decomp,
+                                 const struct rohc_buf rohc_ir)
+{
+	uint8_t *const uncomp_mem = rohc_malloc(0xffff);
+	struct rohc_buf uncomp_packet = rohc_buf_init_empty(uncomp_mem, 0xffff);
+	rohc_status_t status;
+
+	/* check inputs validity */
+	if(decomp == NULL)
 	{
-		stream->sn_bits = profile->get_sn(stream->context);
-		stream->sn_bits_nr = sn_feedback_min_bits;
-		rohc_decomp_debug(stream->context, "%zu bits required for SN in feedback "
-		                  "(%zu bits required for RTT, %zu max)",
-		                  sn_feedback_min_bits, decomp->sn_feedback_min_bits,
-		                  profile->msn_max_bits);
+		goto error;
+	}
+	if(rohc_buf_is_malformed(rohc_ir) || rohc_buf_is_empty(rohc_ir))
+	{
+		rohc_warning(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+		             "failed to prewarm context: given IR packet is malformed");
+		goto error;
 	}
 
-	/* detect the type of the ROHC packet */
-	stream->packet_type = profile->detect_pkt_type(stream->context, walk, remain_len,
-	                                               large_cid_len);
-	if(stream->packet_type == ROHC_PACKET_UNKNOWN)
+	if(uncomp_mem == NULL)
 	{
-		rohc_warning(decomp, ROHC_TRACE_DECOMP, profile->id,
-		             "failed to detect ROHC packet type");
-		if(is_new_context)
-		{
-			context_free(stream->context);
-			stream->context = NULL;
-			decomp->last_context = NULL;
-		}
-		goto error_malformed;
+		rohc_error(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+		           "failed to prewarm context: no memory for packet");
+		goto error;
 	}
-	rohc_decomp_debug(stream->context, "decode packet as '%s'",
-	                  rohc_get_packet_descr(stream->packet_type));
 
-	/* only packets that carry static informations can be received in the
-	 * No Context state, other cannot */
-	if(stream->state == ROHC_DECOMP_STATE_NC &&
-	   !rohc_decomp_packet_carry_static_info(stream->packet_type))
+	/* decompress the IR packet, then drop the decompressed packet */
+	status = rohc_decomp_decompress_one(decomp, rohc_ir, &uncomp_packet,
+	                                    NULL, NULL);
+	if(status != ROHC_STATUS_OK)
 	{
-		rohc_warning(decomp, ROHC_TRACE_DECOMP, profile->id,
-		             "packet '%s' (%d) does not carry static information, it cannot "
-		             "be received in No Context state",
-		             rohc_get_packet_descr(stream->packet_type),
-		             stream->packet_type);
-		if(is_new_context)
-		{
-			context_free(stream->context);
-			stream->context = NULL;
-			decomp->last_context = NULL;
-		}
-		goto error_malformed;
+		rohc_warning(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+		             "failed to prewarm context: failed to decompress the IR "
+		             "packet (%s)", rohc_strerror(status));
+		goto error;
 	}
-	/* only packets carrying CRC-7 or CRC-8 can be received in the Static Context
-	 * state, other cannot */
-	else if(stream->state == ROHC_DECOMP_STATE_SC &&
-	        !rohc_decomp_packet_carry_crc_7_or_8(stream->packet_type))
+	if(decomp->last_context == NULL ||
+	   decomp->last_context->packet_type != ROHC_PACKET_IR)
 	{
-		rohc_warning(decomp, ROHC_TRACE_DECOMP, profile->id,
-		             "packet '%s' (%d) does not carry 7- or 8-bit CRC, it cannot "
-		             "be received in Static Context state",
-		             rohc_get_packet_descr(stream->packet_type),
-		             stream->packet_type);
-		if(is_new_context)
-		{
-			context_free(stream->context);
-			stream->context = NULL;
-			decomp->last_context = NULL;
-		}
-		goto error_malformed;
+		rohc_warning(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+		             "failed to prewarm context: the packet is not an IR "
+		             "packet");
+		goto error;
 	}
-	/* all packet types are allowed in Full Context state */
 
-	/* only IR packet can create a new context */
-	assert(stream->packet_type == ROHC_PACKET_IR || !is_new_context);
+	rohc_info(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+	          "context with CID %zu prewarmed with profile 0x%04x",
+	          decomp->last_context->cid, decomp->last_context->profile->id);
+	rohc_free(uncomp_mem);
+	return true;
 
-	/* decode the packet thanks to the profile-specific routines
-	 * (may change the initial assumption about the packet type) */
-	status = rohc_decomp_decode_pkt(decomp, stream->context, remain_rohc_data,
-	                                add_cid_len, large_cid_len, uncomp_packet,
-	                                &stream->packet_type, &stream->do_change_mode);
-	if(status != ROHC_STATUS_OK)
+error:
+	rohc_free(uncomp_mem);
+	return false;
+}
+
+
+/**
+ * @brief Find the CID, the class and the header offsets of one ROHC packet
+ *
+ * The padding, the feedback items and the small or large CID of the ROHC
+ * packet are parsed the way \ref rohc_decompress3 parses them, but the
+ * packet is not decompressed: no context is created, used nor updated, no
+ * feedback is delivered, and no segment is reassembled. The function does
+ * not change the decompressor, so it may be called from any thread, for
+ * example to steer the ROHC packets to the decompressor or the thread that
+ * handles their CID.
+ *
+ * The CID is not checked against the MAX_CID of the decompressor, and the
+ * context of the CID may not exist: \ref rohc_decompress3 reports those
+ * errors.
+ *
+ * @param decomp       The ROHC decompressor
+ * @param rohc_packet  The ROHC packet to demultiplex
+ * @param[out] demux   The demultiplexing information of the ROHC packet
+ * @return             true if the ROHC packet was demultiplexed,
+ *                     false if the packet is malformed or if a parameter is
+ *                     invalid
+ *
+ * @ingroup rohc_decomp
+ *
+ * @see rohc_decomp_demux_burst
+ */
+bool rohc_decomp_demux(const struct rohc_decomp *const decomp,
+                       const struct rohc_buf rohc_packet,
+                       rohc_decomp_demux_t *const demux)
+{
+	struct rohc_buf remain = rohc_packet;
+	const uint8_t *type_byte;
+
+	if(decomp == NULL || demux == NULL)
+	{
+		goto error;
+	}
+	memset(demux, 0, sizeof(rohc_decomp_demux_t));
+	demux->pkt_class = ROHC_DECOMP_DEMUX_MALFORMED;
+	if(rohc_buf_is_malformed(remain))
 	{
-		/* decompression failed, free ressources if necessary */
-		rohc_warning(decomp, ROHC_TRACE_DECOMP, profile->id,
-		             "failed to decompress packet (code = %d)", status);
-		if(is_new_context)
-		{
-			context_free(stream->context);
-			stream->context = NULL;
-			decomp->last_context = NULL;
-		}
 		goto error;
 	}
 
-	/* decompression was successful, replace the existing context with the
-	 * new one if necessary */
-	if(is_new_context)
+	/* skip padding and feedback items */
+	if(!rohc_decomp_skip_fb_prefix(&remain, &demux->padding_len))
 	{
-		if(decomp->contexts[stream->cid] != NULL)
-		{
-			context_free(decomp->contexts[stream->cid]);
-		}
-		decomp->contexts[stream->cid] = stream->context;
+		goto error;
+	}
+	demux->hdr_offset = remain.offset - rohc_packet.offset;
+	demux->feedbacks_len = demux->hdr_offset - demux->padding_len;
+	demux->type_offset = demux->hdr_offset;
+	if(remain.len == 0)
+	{
+		demux->pkt_class = ROHC_DECOMP_DEMUX_FEEDBACK;
+		return true;
 	}
 
-	/* get the SN of the latest packet successfully decompressed */
-	stream->sn_bits = profile->get_sn(stream->context);
-	stream->sn_bits_nr = sn_feedback_min_bits;
-	rohc_decomp_debug(stream->context, "%zu bits required for SN in feedback "
-	                  "(%zu bits required for RTT, %zu max)",
-	                  sn_feedback_min_bits, decomp->sn_feedback_min_bits,
-	                  profile->msn_max_bits);
+	/* the CID of a segment is in the RRU */
+	if(rohc_decomp_packet_is_segment(rohc_buf_data(remain)))
+	{
+		demux->pkt_class = ROHC_DECOMP_DEMUX_SEGMENT;
+		return true;
+	}
 
-skip:
-	return ROHC_STATUS_OK;
+	/* small or large CID */
+	if(decomp->medium.cid_type == ROHC_SMALL_CID)
+	{
+		demux->cid = rohc_add_cid_decode(rohc_buf_data(remain), remain.len);
+		if(demux->cid == UINT8_MAX)
+		{
+			demux->cid = 0;
+		}
+		else
+		{
+			rohc_buf_pull(&remain, 1);
+			demux->type_offset++;
+			if(remain.len == 0)
+			{
+				goto error;
+			}
+		}
+	}
+	else
+	{
+		uint32_t large_cid;
 
-error:
-	stream->crc_failed = !!(status == ROHC_STATUS_BAD_CRC);
-	decomp->last_context = NULL;
-	return status;
+		/* the large CID follows the first byte of the packet */
+		if(remain.len < 2)
+		{
+			goto error;
+		}
+		demux->large_cid_len =
+			sdvl_decode_large_cid(rohc_buf_data(remain) + 1, remain.len - 1,
+			                      &large_cid);
+		if(demux->large_cid_len == 0)
+		{
+			goto error;
+		}
+		demux->cid = large_cid & 0xffff;
+	}
 
-error_crc:
-	stream->crc_failed = true;
-	decomp->last_context = NULL;
-	return ROHC_STATUS_BAD_CRC;
+	/* the packet type */
+	type_byte = rohc_buf_data(remain);
+	if(rohc_decomp_packet_is_ir(type_byte, remain.len))
+	{
+		demux->pkt_class = ROHC_DECOMP_DEMUX_IR;
+	}
+	else if(rohc_decomp_packet_is_irdyn(type_byte, remain.len))
+	{
+		demux->pkt_class = ROHC_DECOMP_DEMUX_IR_DYN;
+	}
+	else
+	{
+		demux->pkt_class = ROHC_DECOMP_DEMUX_CO;
+	}
 
-error_malformed:
-	decomp->last_context = NULL;
-	return ROHC_STATUS_MALFORMED;
+	return true;
 
-error_no_context:
-	decomp->last_context = NULL;
-	return ROHC_STATUS_NO_CONTEXT;
+error:
+	return false;
 }
 
 
 /**
- * @brief Decode one ROHC packet
+ * @brief Find the CIDs, the classes and the header offsets of ROHC packets
  *
- * Steps:
- *  \li A. Parse the ROHC header
- *  \li B. For IR and IR-DYN packet, check for correct compressed header (CRC)
- *  \li C. Decode extracted bits
- *  \li D. Build uncompressed headers (and check for correct decompression
- *         for UO* packets)
- *  \li E. Copy the payload (if any)
- *  \li F. Update the compression context
+ * Demultiplex every packet of the burst as \ref rohc_decomp_demux does. A
+ * malformed packet does not stop the burst, its class is
+ * \ref ROHC_DECOMP_DEMUX_MALFORMED.
  *
- * Steps C and D may be repeated if packet or context repair is attempted
- * upon CRC failure.
+ * @param decomp       The ROHC decompressor
+ * @param rohc_packets  The ROHC packets to demultiplex
+ * @param packets_nr    The number of ROHC packets
+ * @param[out] demuxes  The demultiplexing information of every ROHC packet
+ * @return              true if the burst was demultiplexed,
+ *                      false if a parameter is invalid
  *
- * @param decomp               The ROHC decompressor
- * @param context              The decompression context
- * @param rohc_packet          The ROHC packet to decode
- * @param add_cid_len          The length of the optional Add-CID field
- * @param large_cid_len        The length of the optional large CID field
- * @param[out] uncomp_packet   The uncompressed packet
- * @param[in,out] packet_type  IN:  The type of the ROHC packet to parse
- *                             OUT: The type of the parsed ROHC packet
- * @param[out] do_change_mode  Whether the profile context wants to change
- *                             its operational mode or not
- * @return                     ROHC_STATUS_OK if packet is successfully decoded,
- *                             ROHC_STATUS_MALFORMED if packet is malformed,
- *                             ROHC_STATUS_BAD_CRC if a CRC error occurs,
- *                             ROHC_STATUS_ERROR if an error occurs
+ * @ingroup rohc_decomp
+ *
+ * @see rohc_decomp_demux
  */
-static rohc_status_t rohc_decomp_decode_pkt(struct rohc_decomp *const decomp,
-                                            struct rohc_decomp_ctxt *const context,
-                                            const struct rohc_buf rohc_packet,
-                                            const size_t add_cid_len,
-                                            const size_t large_cid_len,
-                                            struct rohc_buf *const uncomp_packet,
-                                            rohc_packet_t *const packet_type,
-                                            bool *const do_change_mode)
+bool rohc_decomp_demux_burst(const struct rohc_decomp *const decomp,
+                             const struct rohc_buf *const rohc_packets,
+                             const size_t packets_nr,
+                             rohc_decomp_demux_t *const demuxes)
 {
-	const struct rohc_decomp_profile *const profile = context->profile;
-	struct rohc_decomp_crc *const extr_crc_bits = &context->volat_ctxt.crc;
-	void *const extr_bits = context->volat_ctxt.extr_bits;
-	void *const decoded_values = context->volat_ctxt.decoded_values;
+	size_t i;
 
-	/* length of the parsed ROHC header and of the uncompressed headers */
-	size_t rohc_hdr_len;
-	size_t uncomp_hdr_len;
+	if(decomp == NULL || rohc_packets == NULL || demuxes == NULL)
+	{
+		goto error;
+	}
 
-	/* ROHC and uncompressed payloads (they are the same) */
-	const uint8_t *payload_data;
-	size_t payload_len;
+	for(i = 0; i < packets_nr; i++)
+	{
+		/* the class of a malformed packet tells the failure */
+		if(!rohc_decomp_demux(decomp, rohc_packets[i], &demuxes[i]))
+		{
+			demuxes[i].pkt_class = ROHC_DECOMP_DEMUX_MALFORMED;
+		}
+	}
 
-	/* Whether to attempt packet correction or not */
-	bool try_decoding_again;
-
-	/* helper variables for values returned by functions */
-	bool parsing_ok;
-	bool decode_ok;
-	rohc_status_t build_ret;
-
-	assert(add_cid_len == 0 || add_cid_len == 1);
-	assert(large_cid_len <= 2);
-	assert((*packet_type) != ROHC_PACKET_UNKNOWN);
+	return true;
 
-	/* A. Parse the ROHC header */
+error:
+	return false;
+}
 
-	rohc_decomp_debug(context, "parse packet type '%s' (%d)",
-	                  rohc_get_packet_descr(*packet_type), *packet_type);
 
-	/* let's parse the packet! */
-	parsing_ok = profile->parse_pkt(context, rohc_packet, large_cid_len,
-	                                packet_type, extr_crc_bits, extr_bits,
-	                                &rohc_hdr_len);
-	if(!parsing_ok)
+/**
+ * @brief Check the buffers given to decompress one packet
+ *
+ * @param decomp         The ROHC decompressor
+ * @param rohc_packet    The compressed packet to decompress
+ * @param uncomp_packet  The buffer for the uncompressed packet
+ * @param rcvd_feedback  The buffer for the received feedback, may be NULL
+ * @param feedback_send  The buffer for the feedback to send, may be NULL
+ * @return               true if buffers are valid, false otherwise
+ */
+static bool rohc_decomp_check_bufs(const struct rohc_decomp *const decomp,
+                                   const struct rohc_buf rohc_packet,
+                                   const struct rohc_buf *const uncomp_packet,
+                                   const struct rohc_buf *const rcvd_feedback,
+                                   const struct rohc_buf *const feedback_send)
+{
+	if(rohc_buf_is_malformed(rohc_packet))
 	{
-		rohc_decomp_warn(context, "failed to parse the %s header",
-		                 rohc_get_packet_descr(*packet_type));
-		goto error_malformed;
+		rohc_warning(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+		             "given rohc_packet is malformed");
+		return false;
+	}
+	if(rohc_buf_is_empty(rohc_packet))
+	{
+		rohc_warning(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+		             "given rohc_packet is empty");
+		return false;
+	}
+	if(uncomp_packet == NULL)
+	{
+		rohc_warning(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+		             "given uncomp_packet is NULL");
+		return false;
+	}
+	if(rohc_buf_is_malformed(*uncomp_packet))
+	{
+		rohc_warning(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+		             "given uncomp_packet is malformed");
+		return false;
+	}
+	if(!rohc_buf_is_empty(*uncomp_packet))
+	{
+		rohc_warning(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+		             "given uncomp_packet is not empty");
+		return false;
+	}
+	if(rcvd_feedback != NULL)
+	{
+		if(rohc_buf_is_malformed(*rcvd_feedback))
+		{
+			rohc_warning(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+			             "given rcvd_feedback is malformed");
+			return false;
+		}
+		if(!rohc_buf_is_empty(*rcvd_feedback))
+		{
+			rohc_warning(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+			             "given rcvd_feedback is not empty");
+			return false;
+		}
+	}
+	if(feedback_send != NULL)
+	{
+		if(rohc_buf_is_malformed(*feedback_send))
+		{
+			rohc_warning(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+			             "given feedback_send is malformed");
+			return false;
+		}
+		if(!rohc_buf_is_empty(*feedback_send))
+		{
+			rohc_warning(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+			             "given feedback_send is not empty");
+			return false;
+		}
 	}
 
-	/* ROHC base header and its optional extension is now fully parsed,
-	 * remaining data is the payload */
-	payload_data = rohc_buf_data(rohc_packet) + rohc_hdr_len;
-	payload_len = rohc_packet.len - rohc_hdr_len;
-	rohc_decomp_debug(context, "ROHC payload (length = %zu bytes) starts at "
-	                  "offset %zu", payload_len, rohc_hdr_len);
+	return true;
+}
 
 
-	/*
-	 * B. Check for correct compressed header (CRC)
-	 *
-	 * Use the CRC on compressed headers to check whether IR header was
-	 * correctly received. The optional Add-CID is part of the CRC.
-	 */
+/**
+ * @brief Decompress one ROHC packet given with valid buffers
+ *
+ * @param decomp              The ROHC decompressor
+ * @param rohc_packet         The compressed packet to decompress
+ * @param[out] uncomp_packet  The resulting uncompressed packet
+ * @param[out] rcvd_feedback  The feedback received from the remote peer,
+ *                            may be NULL
+ * @param[out] feedback_send  The feedback to be transmitted to the remote
+ *                            compressor, may be NULL
+ * @return                    The decompression status, see
+ *                            \ref rohc_decompress3
+ */
+static rohc_status_t rohc_decomp_decompress_one(struct rohc_decomp *const decomp,
+                                                const struct rohc_buf rohc_packet,
+                                                struct rohc_buf *const uncomp_packet,
+                                                struct rohc_buf *const rcvd_feedback,
+                                                struct rohc_buf *const feedback_send)
+{
+	rohc_status_t status = ROHC_STATUS_ERROR; /* error status by default */
+	struct rohc_decomp_stream stream;
+	rohc_ticks_t feedback_ticks;
 
-	if((*packet_type) == ROHC_PACKET_IR || (*packet_type) == ROHC_PACKET_IR_DYN)
+	decomp->stats.received++;
+	d_trace_sample(decomp, false, 0);
+	if(rohc_decomp_timings_enabled(decomp))
 	{
-		bool crc_ok;
-
-		assert(extr_crc_bits->type == ROHC_CRC_TYPE_NONE);
-		assert(extr_crc_bits->bits_nr == 8);
-
-		crc_ok = rohc_decomp_check_ir_crc(decomp, context,
-		                                  rohc_buf_data(rohc_packet) - add_cid_len,
-		                                  add_cid_len + rohc_hdr_len, large_cid_len,
-		                                  add_cid_len, extr_crc_bits->bits);
-		if(!crc_ok)
-		{
-			rohc_decomp_warn(context, "CRC detected a transmission failure for "
-			                 "%s packet", rohc_get_packet_descr(*packet_type));
-			if((decomp->features & ROHC_DECOMP_FEATURE_DUMP_PACKETS) != 0)
-			{
-				rohc_dump_buf(decomp->trace_callback, decomp->trace_callback_priv,
-				              ROHC_TRACE_DECOMP, ROHC_TRACE_WARNING, "ROHC header",
-				              rohc_buf_data(rohc_packet) - add_cid_len,
-				              rohc_hdr_len + add_cid_len);
-			}
-#ifndef ROHC_NO_IR_CRC_CHECK
-			goto error_crc;
-#endif
-		}
-
-		/* reset the correction attempt */
-		context->crc_corr.counter = 0;
+		rohc_decomp_timings_reset(decomp);
 	}
+	rohc_debug(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+	           "decompress the %zu-byte packet #%lu", rohc_packet.len,
+	           (unsigned long) decomp->stats.received);
 
-
-	try_decoding_again = false;
-	do
+	/* print compressed bytes */
+	if(rohc_trace_is_enabled(decomp, ROHC_TRACE_DEBUG) &&
+	   (decomp->features & ROHC_DECOMP_FEATURE_DUMP_PACKETS) != 0)
 	{
-		if(try_decoding_again)
-		{
-			rohc_decomp_warn(context, "CID %zu: CRC repair: try decoding packet "
-			                 "again with new assumptions", context->cid);
-		}
+		rohc_dump_packet(decomp->trace_callback, decomp->trace_callback_priv,
+		                 ROHC_TRACE_DECOMP, ROHC_TRACE_DEBUG,
+		                 "compressed data, max 100 bytes", rohc_packet);
+	}
 
+	/* decode ROHC header */
+	status = d_decode_header(decomp, rohc_packet, uncomp_packet, rcvd_feedback,
+	                         &stream);
+	assert(status != ROHC_STATUS_SEGMENT);
 
-		/* C. Decode extracted bits
-		 *
-		 * All bits are now extracted from the packet, let's decode them.
-		 */
+	/* handle mode transitions if context was found and it is still valid */
+	if(stream.context != NULL)
+	{
+		const rohc_mode_t old_mode = stream.context->mode;
+		const rohc_mode_t target_mode =
+			rohc_decomp_ctxt_target_mode(decomp, stream.context);
 
-		decode_ok = profile->decode_bits(context, extr_bits, payload_len,
-		                                 decoded_values);
-		if(!decode_ok)
+		if(old_mode == ROHC_R_MODE || target_mode == ROHC_R_MODE)
 		{
-			rohc_decomp_warn(context, "failed to decode values from bits "
-			                 "extracted from ROHC header");
+			assert(0); /* TODO: R-mode not supported yet */
+			status = ROHC_STATUS_ERROR;
 			goto error;
 		}
+		else if(target_mode == old_mode)
+		{
+			rohc_debug(decomp, ROHC_TRACE_DECOMP, stream.profile_id,
+			           "stay in %s", rohc_get_mode_descr(old_mode));
+		}
+		else
+		{
+			rohc_debug(decomp, ROHC_TRACE_DECOMP, stream.profile_id,
+			           "transit from %s to %s", rohc_get_mode_descr(old_mode),
+			           rohc_get_mode_descr(target_mode));
+			stream.context->mode = target_mode;
+			/* ACK, NACK or STATIC-NACK will transmit the mode transition to the
+			 * remote compressor */
+			stream.mode = target_mode;
+			stream.do_change_mode = true;
+			stream.is_mode_transition = true;
+			rohc_decomp_notify_ctxt_event(stream.context,
+			                              ROHC_DECOMP_EVENT_MODE_CHANGE,
+			                              stream.context->state, old_mode);
+		}
+	}
 
+	/* update statistics and send feedback if needed */
+	if(status == ROHC_STATUS_OK)
+	{
+		/* print a trace to report success (the context may be NULL if packet
+		 * was a feedback-only packet) */
+		rohc_debug(decomp, ROHC_TRACE_DECOMP, stream.profile_id,
+		           "packet decompression succeeded");
 
-		/* D. Build uncompressed headers & check for correct decompression
-		 *
-		 * All fields are now decoded, let's build the uncompressed headers.
-		 *
-		 * Use the CRC on decompressed headers to check whether decompression was
-		 * correct.
-		 */
-
-		/* build the uncompressed headers */
-		build_ret = profile->build_hdrs(decomp, context, *packet_type, extr_crc_bits,
-		                                decoded_values, payload_len,
-		                                uncomp_packet, &uncomp_hdr_len);
-		if(build_ret == ROHC_STATUS_OK)
+		/* do not update statistics and build positive feedback for feedback-only
+		 * packets */
+		if(uncomp_packet->len > 0)
 		{
-			/* uncompressed headers successfully built and CRC is correct,
-			 * no need to try decoding with different values */
-			rohc_buf_pull(uncomp_packet, uncomp_hdr_len);
+			/* the payload is not part of the packets if it is referenced */
+			const size_t ref_len = (decomp->payload_ref == NULL ? 0 :
+			                        decomp->payload_ref->len + decomp->rru_tail_len);
 
-			if(context->crc_corr.algo == ROHC_DECOMP_CRC_CORR_SN_NONE)
+			/* update statistics */
+			rohc_debug(decomp, ROHC_TRACE_DECOMP, stream.profile_id,
+			           "update decompressor and context statistics");
+			assert(stream.context != NULL);
+			stream.context->num_recv_packets++;
+			stream.context->packet_type = stream.packet_type;
+			stream.context->latest_used = rohc_packet.time.sec;
+			stream.context->total_uncompressed_size += uncomp_packet->len + ref_len;
+			stream.context->total_compressed_size += rohc_packet.len;
+			decomp->stats.total_uncompressed_size += uncomp_packet->len + ref_len;
+			decomp->stats.total_compressed_size += rohc_packet.len;
+			rohc_decomp_publish_ctxt_stats(decomp, stream.context);
+			ROHC_PROBE5(decomp_packet, stream.cid, stream.profile_id,
+			            stream.packet_type, rohc_packet.len,
+			            uncomp_packet->len + ref_len);
+			if(rohc_pkt_log_enabled(&decomp->pkt_log))
 			{
-				rohc_decomp_debug(context, "CRC is correct");
+				rohc_decomp_log_packet(decomp, &stream, status);
 			}
-			else if((*packet_type) == ROHC_PACKET_IR)
+
+			/* build positive feedback if asked by user and if needed by decompressor */
+			feedback_ticks = rohc_decomp_ticks(decomp);
+			if(!rohc_decomp_feedback_ack(decomp, &stream, feedback_send))
 			{
-				rohc_decomp_debug(context, "CRC is correct, stop CRC repair");
-				context->crc_corr.algo = ROHC_DECOMP_CRC_CORR_SN_NONE;
-				context->crc_corr.counter = 0;
+				rohc_warning(decomp, ROHC_TRACE_DECOMP, stream.profile_id,
+				             "failed to build positive feedback");
+				status = ROHC_STATUS_ERROR;
+				goto error;
 			}
-			else
+			if(rohc_decomp_timings_enabled(decomp))
 			{
-				rohc_decomp_debug(context, "CID %zu: CRC repair: CRC is correct",
-				                  context->cid);
-				try_decoding_again = false;
+				rohc_decomp_timings_add_feedback(decomp,
+				                                 rohc_ticks_now() - feedback_ticks);
+				rohc_decomp_timings_record(decomp, stream.packet_type,
+				                           stream.context->profile->id);
 			}
 		}
-		else if(build_ret == ROHC_STATUS_OUTPUT_TOO_SMALL)
-		{
-			rohc_decomp_warn(context, "CID %zu: failed to build uncompressed "
-			                 "headers: output buffer too small", context->cid);
-			goto error_output_too_small;
-		}
-		else if(build_ret != ROHC_STATUS_BAD_CRC)
+	}
+	else /* packet failed to be decompressed */
+	{
+		/* in case of failure, users shall get an empty decompressed packet */
+		uncomp_packet->len = 0;
+
+		rohc_warning(decomp, ROHC_TRACE_DECOMP, stream.profile_id,
+		             "packet decompression failed: %s (%d)",
+		             rohc_strerror(status), status);
+
+		/* update statistics */
+		if(stream.context != NULL)
 		{
-			/* uncompressed headers cannot be built, stop decoding */
-			rohc_decomp_warn(context, "CID %zu: failed to build uncompressed "
-			                 "headers", context->cid);
-			if((decomp->features & ROHC_DECOMP_FEATURE_DUMP_PACKETS) != 0)
-			{
-				rohc_dump_packet(decomp->trace_callback, decomp->trace_callback_priv,
-				                 ROHC_TRACE_DECOMP, ROHC_TRACE_WARNING,
-				                 "compressed headers", rohc_packet);
-			}
-			goto error;
+			stream.context->num_recv_packets++;
+			rohc_decomp_publish_ctxt_stats(decomp, stream.context);
 		}
-		else
+		switch(status)
 		{
-			/* uncompressed headers successfully built but CRC is incorrect,
+			case ROHC_STATUS_MALFORMED:
+			case ROHC_STATUS_OUTPUT_TOO_SMALL:
+			case ROHC_STATUS_ERROR:
+				decomp->stats.failed_decomp++;
+				break;
+			case ROHC_STATUS_NO_CONTEXT:
+				decomp->stats.failed_no_context++;
+				break;
+			case ROHC_STATUS_BAD_CRC:
+				decomp->stats.failed_crc++;
+				ROHC_PROBE3(decomp_crc_failure, stream.cid, stream.profile_id,
+				            stream.packet_type);
+				break;
+			case ROHC_STATUS_OK: /* success codes shall not happen */
+			case ROHC_STATUS_SEGMENT:
+			default:
+				assert(0);
+				status = ROHC_STATUS_ERROR;
+				goto error;
+		}
+		/* record the packet before the callback, so that it may dump the log */
+		if(rohc_pkt_log_enabled(&decomp->pkt_log))
+		{
+			rohc_decomp_log_packet(decomp, &stream, status);
+		}
+		if(decomp->event_cb != NULL)
+		{
+			rohc_decomp_event_info_t event_info;
+
+			event_info.event = ROHC_DECOMP_EVENT_FAILURE;
+			event_info.cid = stream.cid;
+			event_info.profile_id = stream.profile_id;
+			event_info.new_state = (stream.context != NULL ?
+			                        stream.context->state : ROHC_DECOMP_STATE_UNKNOWN);
+			event_info.old_state = event_info.new_state;
+			event_info.new_mode = (stream.context != NULL ?
+			                       stream.context->mode : ROHC_UNKNOWN_MODE);
+			event_info.old_mode = event_info.new_mode;
+			event_info.status = status;
+			decomp->event_cb(decomp->event_cb_priv, &event_info);
+		}
+
+		/* build negative feedback if asked by user and if needed by decompressor */
+		if(!rohc_decomp_feedback_nack(decomp, &stream, feedback_send))
+		{
+			rohc_warning(decomp, ROHC_TRACE_DECOMP, stream.profile_id,
+			             "failed to build negative feedback");
+			status = ROHC_STATUS_ERROR;
+			goto error;
+		}
+	}
+
+	/* destroy the contexts of the flows that stopped a while ago, a few CIDs
+	 * at a time, or in rohc_decomp_maintenance() only in real-time mode */
+	if(decomp->ctxts_idle_timeout > 0 &&
+	   (decomp->features & ROHC_DECOMP_FEATURE_REALTIME) == 0)
+	{
+		rohc_decomp_reclaim_idle(decomp, rohc_packet.time,
+		                         ROHC_DECOMP_IDLE_SWEEP_NR);
+	}
+
+	/* build the delayed positive ACKs if they waited long enough */
+	if(feedback_send != NULL && !rohc_decomp_age_acks(decomp, feedback_send))
+	{
+		rohc_warning(decomp, ROHC_TRACE_DECOMP, stream.profile_id,
+		             "failed to build the delayed positive feedbacks");
+		status = ROHC_STATUS_ERROR;
+		goto error;
+	}
+
+error:
+	return status;
+}
+
+
+/**
+ * @brief Decompress the compressed headers.
+ *
+ * @param decomp              The ROHC decompressor
+ * @param rohc_packet         The ROHC packet to decode
+ * @param[out] uncomp_packet  The uncompressed packet
+ * @param[out] rcvd_feedback  The feedback received from the remote peer for
+ *                            the same-side associated ROHC compressor through
+ *                            the feedback channel:
+ *                            \li If NULL, ignore the received feedback data
+ *                            \li If not NULL, store the received feedback in
+ *                                at the given address
+ * @param[out] stream         The informations about the decompressed stream,
+ *                            required for sending feedback to compressor
+ * @return                    Possible return values:
+ *                            \li ROHC_STATUS_OK if packet is successfully
+ *                                decoded,
+ *                            \li ROHC_STATUS_NO_CONTEXT if no matching
+ *                                context was found and packet cannot create
+ *                                a new context (or failed to do so),
+ *                            \li ROHC_STATUS_MALFORMED if packet is
+ *                                malformed,
+ *                            \li ROHC_STATUS_BAD_CRC if a CRC error occurs,
+ *                            \li ROHC_STATUS_ERROR if another error occurs
+ */
+static rohc_status_t d_decode_header(struct rohc_decomp *decomp,
+                                     const struct rohc_buf rohc_packet,
+                                     struct rohc_buf *const uncomp_packet,
+                                     struct rohc_buf *const rcvd_feedback,
+                                     struct rohc_decomp_stream *const stream)
+{
+	const struct rohc_decomp_profile *profile;
+	bool is_new_context = false;
+	size_t sn_feedback_min_bits;
+	size_t add_cid_len;
+	size_t large_cid_len;
+
+	struct rohc_buf remain_rohc_data = rohc_packet;
+	const uint8_t *walk;
+	size_t remain_len;
+	rohc_ticks_t feedback_ticks;
+	rohc_ticks_t lookup_ticks;
+
+	rohc_status_t status;
+
+	/* at the beginning, context is not found yet but channel CID type is known */
+	stream->profile_id = ROHC_PROFILE_GENERAL;
+	stream->cid_type = decomp->medium.cid_type;
+	stream->cid_found = false;
+	stream->cid = SIZE_MAX;
+	stream->context_found = false;
+	stream->context = NULL;
+	stream->mode = ROHC_UNKNOWN_MODE;
+	stream->state = ROHC_DECOMP_STATE_UNKNOWN;
+	stream->do_change_mode = false;
+	stream->is_mode_transition = false;
+	stream->sn_bits = 0; /* must be set to 0 until we get some bits */
+	stream->sn_bits_nr = 0;
+	stream->packet_type = ROHC_PACKET_UNKNOWN;
+	stream->crc_failed = false;
+
+	/* empty ROHC packets are not considered as valid */
+	if(remain_rohc_data.len < 1)
+	{
+		rohc_warning(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+		             "ROHC packet too small (len = %zu, at least 1 byte "
+		             "required)", remain_rohc_data.len);
+		goto error_malformed;
+	}
+
+	/* the RRU given by rohc_decompress_segments() is already reassembled and
+	 * checked, it contains neither padding, nor feedback, nor segment */
+	if(decomp->rru_segs != NULL)
+	{
+		walk = rohc_buf_data(remain_rohc_data);
+		remain_len = remain_rohc_data.len;
+		goto decode_cid;
+	}
+
+	/* skip padding bits if some are present */
+	rohc_decomp_parse_padding(decomp, &remain_rohc_data);
+
+	/* padding-only packets are not allowed according to RFC 3095, §5.2:
+	 *   Padding is any number (zero or more) of padding octets.  Either of
+	 *   Feedback or Header must be present. */
+	if(remain_rohc_data.len == 0)
+	{
+		rohc_debug(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+		           "padding-only packet is not allowed");
+		goto error_malformed;
+	}
+
+	/* extract feedback items if present */
+	feedback_ticks = rohc_decomp_ticks(decomp);
+	if(!rohc_decomp_parse_feedbacks(decomp, &remain_rohc_data, rcvd_feedback))
+	{
+		rohc_warning(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+		             "failed to decode feedback items at the beginning of the "
+		             "ROHC packet");
+		goto error_malformed;
+	}
+	if(rohc_decomp_timings_enabled(decomp))
+	{
+		rohc_decomp_timings_add_feedback(decomp,
+		                                 rohc_ticks_now() - feedback_ticks);
+	}
+	if(rcvd_feedback != NULL)
+	{
+		rohc_debug(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+		           "decompressor received %zu bytes of feedback for the "
+		           "same-side associated compressor", rcvd_feedback->len);
+	}
+	walk = rohc_buf_data(remain_rohc_data);
+	remain_len = remain_rohc_data.len;
+
+	/* is there some data after feedback? */
+	if(remain_rohc_data.len == 0)
+	{
+		rohc_debug(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+		           "feedback-only packet, stop decompression");
+		goto skip;
+	}
+
+	/* ROHC segment? */
+	if(rohc_decomp_packet_is_segment(walk))
+	{
+		const bool is_final = !!GET_REAL(GET_BIT_0(walk));
+		uint32_t crc_computed;
+
+		/* segments are reassembled in the RRU, they cannot be decompressed
+		 * without copying their payload */
+		if(decomp->payload_ref != NULL)
+		{
+			rohc_warning(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+			             "ROHC segments cannot be decompressed without copying "
+			             "their payload");
+			goto error_malformed;
+		}
+
+		/* skip the segment type byte */
+		walk++;
+		remain_len--;
+		rohc_buf_pull(&remain_rohc_data, 1);
+
+		rohc_debug(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+		           "ROHC packet is a %zu-byte %s segment", remain_len,
+		           is_final ? "final" : "non-final");
+
+		/* store all the remaining ROHC data in RRU */
+		if(decomp->rru == NULL || (decomp->rru_len + remain_len) > decomp->mrru)
+		{
+			rohc_warning(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+			             "invalid RRU: received segment is too large for MRRU "
+			             "(%zu bytes already received, %zu bytes received, "
+			             "MRRU = %zu bytes", decomp->rru_len, remain_len,
+			             decomp->mrru);
+			/* dicard RRU */
+			decomp->rru_len = 0;
+			goto error_malformed;
+		}
+		rohc_debug(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+		           "append new segment to the %zd bytes we already received",
+		           decomp->rru_len);
+		if(decomp->rru_len == 0)
+		{
+			decomp->rru_crc = CRC_INIT_FCS32;
+			decomp->rru_crc_len = 0;
+		}
+		memcpy(decomp->rru + decomp->rru_len, walk, remain_len);
+		decomp->rru_len += remain_len;
+
+		/* update the CRC with the new bytes as they arrive, except for the
+		 * last 4 bytes that might be the CRC of the RRU */
+		if(decomp->rru_len > (decomp->rru_crc_len + CRC_FCS32_LEN))
+		{
+			const size_t crc_new_len =
+				decomp->rru_len - CRC_FCS32_LEN - decomp->rru_crc_len;
+			decomp->rru_crc = crc_calc_fcs32(decomp->rru + decomp->rru_crc_len,
+			                                 crc_new_len, decomp->rru_crc);
+			decomp->rru_crc_len += crc_new_len;
+		}
+
+		/* stop decoding here is not final segment */
+		if(!is_final)
+		{
+			rohc_debug(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+			           "%zd bytes of RRU already received, wait for more "
+			           "segments before decompressing RRU", decomp->rru_len);
+			goto skip;
+		}
+
+		/* final segment received, let's check CRC */
+		if(decomp->rru_len <= 4)
+		{
+			rohc_warning(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+			             "invalid %zd-byte RRU: should be more than 4-byte long",
+			             decomp->rru_len);
+			/* discard RRU */
+			decomp->rru_len = 0;
+			goto error_malformed;
+		}
+		decomp->rru_len -= 4;
+		rohc_debug(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+		           "final segment received, check the 4-byte CRC of the "
+		           "%zd-byte RRU", decomp->rru_len);
+		assert(decomp->rru_crc_len == decomp->rru_len);
+		crc_computed = decomp->rru_crc;
+		if(memcmp(&crc_computed, decomp->rru + decomp->rru_len, 4) != 0)
+		{
+			uint32_t crc_packet;
+			memcpy(&crc_packet, decomp->rru + decomp->rru_len, 4);
+			rohc_warning(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+			             "invalid %zd-byte RRU: bad CRC (packet = 0x%08x, "
+			             "computed = 0x%08x)", decomp->rru_len,
+			             rohc_ntoh32(crc_packet), rohc_ntoh32(crc_computed));
+			/* discard RRU */
+			decomp->rru_len = 0;
+			goto error_crc;
+		}
+
+		/* CRC of segment is OK, let's decode RRU */
+		rohc_debug(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+		           "final segment received, decode the %zd-byte RRU",
+		           decomp->rru_len);
+		walk = decomp->rru;
+		remain_len = decomp->rru_len;
+		remain_rohc_data.offset = 0;
+		remain_rohc_data.data = decomp->rru;
+		remain_rohc_data.len = decomp->rru_len;
+		remain_rohc_data.max_len = decomp->rru_len;
+
+		/* reset context for next RRU */
+		decomp->rru_len = 0;
+	}
+
+decode_cid:
+	/* decode small or large CID */
+	if(!rohc_decomp_decode_cid(decomp, walk, remain_len, &stream->cid,
+	                           &add_cid_len, &large_cid_len))
+	{
+		rohc_warning(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+		             "failed to decode small or large CID in packet");
+		goto error_malformed;
+	}
+	stream->cid_found = true;
+	d_trace_sample(decomp, true, stream->cid);
+
+	/* check whether the decoded CID is allowed by the decompressor */
+	if(stream->cid > decomp->medium.max_cid)
+	{
+		rohc_warning(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+		             "unexpected CID %zu received: MAX_CID was set to %zu",
+		             stream->cid, decomp->medium.max_cid);
+		goto error_no_context;
+	}
+
+	/* skip add-CID if present */
+	walk += add_cid_len;
+	remain_len -= add_cid_len;
+	rohc_buf_pull(&remain_rohc_data, add_cid_len);
+
+	/* find the context according to the CID found in CID,
+	 * create it if needed (and possible) */
+	lookup_ticks = rohc_decomp_ticks(decomp);
+	status = rohc_decomp_find_context(decomp, walk, remain_len, stream->cid,
+	                                  large_cid_len, rohc_packet.time,
+	                                  &stream->profile_id, &stream->context,
+	                                  &is_new_context);
+	if(rohc_decomp_timings_enabled(decomp))
+	{
+		rohc_decomp_timings_set_lookup(decomp, rohc_ticks_now() - lookup_ticks);
+	}
+	if(status == ROHC_STATUS_MALFORMED)
+	{
+		/* no additional feedback information to collect */
+		goto error_malformed;
+	}
+	else if(status == ROHC_STATUS_NO_CONTEXT)
+	{
+		/* even if the context was not found/created, the profile ID might be available */
+		goto error_no_context;
+	}
+	assert(status == ROHC_STATUS_OK);
+	profile = stream->context->profile;
+	decomp->last_context = stream->context;
+	sn_feedback_min_bits = rohc_min(decomp->sn_feedback_min_bits,
+	                                profile->msn_max_bits);
+
+	/* collect information for sending feedback to decompressor */
+	stream->context_found = true;
+	stream->mode = stream->context->mode;
+	stream->state = stream->context->state;
+	if(!is_new_context)
+	{
+		stream->sn_bits = profile->get_sn(stream->context);
+		stream->sn_bits_nr = sn_feedback_min_bits;
+		rohc_decomp_debug(stream->context, "%zu bits required for SN in feedback "
+		                  "(%zu bits required for RTT, %zu max)",
+		                  sn_feedback_min_bits, decomp->sn_feedback_min_bits,
+		                  profile->msn_max_bits);
+	}
+
+	/* detect the type of the ROHC packet */
+	stream->packet_type = profile->detect_pkt_type(stream->context, walk, remain_len,
+	                                               large_cid_len);
+	if(stream->packet_type == ROHC_PACKET_UNKNOWN)
+	{
+		rohc_warning(decomp, ROHC_TRACE_DECOMP, profile->id,
+		             "failed to detect ROHC packet type");
+		if(is_new_context)
+		{
+			context_free(stream->context);
+			stream->context = NULL;
+			decomp->last_context = NULL;
+		}
+		goto error_malformed;
+	}
+	rohc_decomp_debug(stream->context, "decode packet as '%s'",
+	                  rohc_get_packet_descr(stream->packet_type));
+
+	/* only packets that carry static informations can be received in the
+	 * No Context state, other cannot */
+	if(stream->state == ROHC_DECOMP_STATE_NC &&
+	   !rohc_decomp_packet_carry_static_info(stream->packet_type))
+	{
+		rohc_warning(decomp, ROHC_TRACE_DECOMP, profile->id,
+		             "packet '%s' (%d) does not carry static information, it cannot "
+		             "be received in No Context state",
+		             rohc_get_packet_descr(stream->packet_type),
+		             stream->packet_type);
+		if(is_new_context)
+		{
+			context_free(stream->context);
+			stream->context = NULL;
+			decomp->last_context = NULL;
+		}
+		goto error_malformed;
+	}
+	/* only packets carrying CRC-7 or CRC-8 can be received in the Static Context
+	 * state, other cannot */
+	else if(stream->state == ROHC_DECOMP_STATE_SC &&
+	        !rohc_decomp_packet_carry_crc_7_or_8(stream->packet_type))
+	{
+		rohc_warning(decomp, ROHC_TRACE_DECOMP, profile->id,
+		             "packet '%s' (%d) does not carry 7- or 8-bit CRC, it cannot "
+		             "be received in Static Context state",
+		             rohc_get_packet_descr(stream->packet_type),
+		             stream->packet_type);
+		if(is_new_context)
+		{
+			context_free(stream->context);
+			stream->context = NULL;
+			decomp->last_context = NULL;
+		}
+		goto error_malformed;
+	}
+	/* all packet types are allowed in Full Context state */
+
+	/* only IR packet can create a new context */
+	assert(stream->packet_type == ROHC_PACKET_IR || !is_new_context);
+
+	/* decode the packet thanks to the profile-specific routines
+	 * (may change the initial assumption about the packet type) */
+	status = rohc_decomp_decode_pkt(decomp, stream->context, remain_rohc_data,
+	                                add_cid_len, large_cid_len, uncomp_packet,
+	                                &stream->packet_type, &stream->do_change_mode);
+	if(status != ROHC_STATUS_OK)
+	{
+		/* decompression failed, free ressources if necessary */
+		rohc_warning(decomp, ROHC_TRACE_DECOMP, profile->id,
+		             "failed to decompress packet (code = %d)", status);
+		if(is_new_context)
+		{
+			context_free(stream->context);
+			stream->context = NULL;
+			decomp->last_context = NULL;
+		}
+		goto error;
+	}
+
+	/* decompression was successful, replace the existing context with the
+	 * new one if necessary */
+	if(is_new_context)
+	{
+		if(decomp->contexts[stream->cid] != NULL)
+		{
+			/* the ACK delayed for the replaced context shall not acknowledge
+			 * the new one */
+			rohc_decomp_drop_ack(decomp, stream->cid);
+			rohc_decomp_notify_ctxt_event(decomp->contexts[stream->cid],
+			                              ROHC_DECOMP_EVENT_CTXT_DESTROY,
+			                              decomp->contexts[stream->cid]->state,
+			                              decomp->contexts[stream->cid]->mode);
+			context_free(decomp->contexts[stream->cid]);
+		}
+		decomp->contexts[stream->cid] = stream->context;
+		rohc_bitmap_set(decomp->ctxts_used, stream->cid);
+		rohc_decomp_notify_ctxt_event(stream->context, ROHC_DECOMP_EVENT_CTXT_CREATE,
+		                              stream->context->state,
+		                              stream->context->mode);
+	}
+
+	/* get the SN of the latest packet successfully decompressed */
+	stream->sn_bits = profile->get_sn(stream->context);
+	stream->sn_bits_nr = sn_feedback_min_bits;
+	rohc_decomp_debug(stream->context, "%zu bits required for SN in feedback "
+	                  "(%zu bits required for RTT, %zu max)",
+	                  sn_feedback_min_bits, decomp->sn_feedback_min_bits,
+	                  profile->msn_max_bits);
+
+skip:
+	return ROHC_STATUS_OK;
+
+error:
+	stream->crc_failed = !!(status == ROHC_STATUS_BAD_CRC);
+	decomp->last_context = NULL;
+	return status;
+
+error_crc:
+	stream->crc_failed = true;
+	decomp->last_context = NULL;
+	return ROHC_STATUS_BAD_CRC;
+
+error_malformed:
+	decomp->last_context = NULL;
+	return ROHC_STATUS_MALFORMED;
+
+error_no_context:
+	decomp->last_context = NULL;
+	return ROHC_STATUS_NO_CONTEXT;
+}
+
+
+/**
+ * @brief Decode one ROHC packet
+ *
+ * Steps:
+ *  \li A. Parse the ROHC header
+ *  \li B. For IR and IR-DYN packet, check for correct compressed header (CRC)
+ *  \li C. Decode extracted bits
+ *  \li D. Build uncompressed headers (and check for correct decompression
+ *         for UO* packets)
+ *  \li E. Copy the payload (if any)
+ *  \li F. Update the compression context
+ *
+ * Steps C and D may be repeated if packet or context repair is attempted
+ * upon CRC failure.
+ *
+ * @param decomp               The ROHC decompressor
+ * @param context              The decompression context
+ * @param rohc_packet          The ROHC packet to decode
+ * @param add_cid_len          The length of the optional Add-CID field
+ * @param large_cid_len        The length of the optional large CID field
+ * @param[out] uncomp_packet   The uncompressed packet
+ * @param[in,out] packet_type  IN:  The type of the ROHC packet to parse
+ *                             OUT: The type of the parsed ROHC packet
+ * @param[out] do_change_mode  Whether the profile context wants to change
+ *                             its operational mode or not
+ * @return                     ROHC_STATUS_OK if packet is successfully decoded,
+ *                             ROHC_STATUS_MALFORMED if packet is malformed,
+ *                             ROHC_STATUS_BAD_CRC if a CRC error occurs,
+ *                             ROHC_STATUS_ERROR if an error occurs
+ */
+static rohc_status_t rohc_decomp_decode_pkt(struct rohc_decomp *const decomp,
+                                            struct rohc_decomp_ctxt *const context,
+                                            const struct rohc_buf rohc_packet,
+                                            const size_t add_cid_len,
+                                            const size_t large_cid_len,
+                                            struct rohc_buf *const uncomp_packet,
+                                            rohc_packet_t *const packet_type,
+                                            bool *const do_change_mode)
+{
+	const struct rohc_decomp_profile *const profile = context->profile;
+	struct rohc_decomp_crc *const extr_crc_bits = &context->volat_ctxt.crc;
+	void *const extr_bits = context->volat_ctxt.extr_bits;
+	void *const decoded_values = context->volat_ctxt.decoded_values;
+
+	/* length of the parsed ROHC header and of the uncompressed headers */
+	size_t rohc_hdr_len;
+	size_t uncomp_hdr_len;
+
+	/* ROHC and uncompressed payloads (they are the same) */
+	const uint8_t *payload_data;
+	size_t payload_len;
+
+	/* Whether to attempt packet correction or not */
+	bool try_decoding_again;
+	/* Whether the packet is decoded against a previous SN reference */
+	bool is_late_ref;
+	/* The number of decoding attempts after the first one */
+	size_t attempts_nr = 0;
+
+	/* helper variables for values returned by functions */
+	bool parsing_ok;
+	bool decode_ok;
+	rohc_status_t build_ret;
+
+	/* the durations of the decompression phases */
+	rohc_ticks_t phases_ticks[ROHC_DECOMP_PHASE_MAX] = { 0 };
+	rohc_ticks_t last_ticks = rohc_decomp_ticks(decomp);
+
+	assert(add_cid_len == 0 || add_cid_len == 1);
+	assert(large_cid_len <= 2);
+	assert((*packet_type) != ROHC_PACKET_UNKNOWN);
+
+	/* A. Parse the ROHC header */
+
+	rohc_decomp_debug(context, "parse packet type '%s' (%d)",
+	                  rohc_get_packet_descr(*packet_type), *packet_type);
+
+	/* let's parse the packet! */
+	parsing_ok = profile->parse_pkt(context, rohc_packet, large_cid_len,
+	                                packet_type, extr_crc_bits, extr_bits,
+	                                &rohc_hdr_len);
+	if(!parsing_ok)
+	{
+		rohc_decomp_warn(context, "failed to parse the %s header",
+		                 rohc_get_packet_descr(*packet_type));
+		goto error_malformed;
+	}
+	if(rohc_decomp_timings_enabled(decomp))
+	{
+		rohc_decomp_timings_step(&last_ticks,
+		                         &phases_ticks[ROHC_DECOMP_PHASE_PARSE]);
+	}
+
+	/* ROHC base header and its optional extension is now fully parsed,
+	 * remaining data is the payload (the end of the payload is still in the
+	 * segments if the RRU was given as a scatter list) */
+	payload_data = rohc_buf_data(rohc_packet) + rohc_hdr_len;
+	payload_len = rohc_packet.len - rohc_hdr_len + decomp->rru_tail_len;
+	rohc_decomp_debug(context, "ROHC payload (length = %zu bytes) starts at "
+	                  "offset %zu", payload_len, rohc_hdr_len);
+
+
+	/*
+	 * B. Check for correct compressed header (CRC)
+	 *
+	 * Use the CRC on compressed headers to check whether IR header was
+	 * correctly received. The optional Add-CID is part of the CRC.
+	 */
+
+	if((*packet_type) == ROHC_PACKET_IR || (*packet_type) == ROHC_PACKET_IR_DYN)
+	{
+		bool crc_ok;
+
+		assert(extr_crc_bits->type == ROHC_CRC_TYPE_NONE);
+		assert(extr_crc_bits->bits_nr == 8);
+
+		crc_ok = rohc_decomp_check_ir_crc(decomp, context,
+		                                  rohc_buf_data(rohc_packet) - add_cid_len,
+		                                  add_cid_len + rohc_hdr_len, large_cid_len,
+		                                  add_cid_len, extr_crc_bits->bits);
+		if(!crc_ok)
+		{
+			rohc_decomp_warn(context, "CRC detected a transmission failure for "
+			                 "%s packet", rohc_get_packet_descr(*packet_type));
+			if(rohc_trace_is_enabled(decomp, ROHC_TRACE_WARNING) &&
+			   (decomp->features & ROHC_DECOMP_FEATURE_DUMP_PACKETS) != 0)
+			{
+				rohc_dump_buf(decomp->trace_callback, decomp->trace_callback_priv,
+				              ROHC_TRACE_DECOMP, ROHC_TRACE_WARNING, "ROHC header",
+				              rohc_buf_data(rohc_packet) - add_cid_len,
+				              rohc_hdr_len + add_cid_len);
+			}
+#ifndef ROHC_NO_IR_CRC_CHECK
+			goto error_crc;
+#endif
+		}
+
+		/* reset the correction attempt */
+		context->crc_corr.counter = 0;
+
+		if(rohc_decomp_timings_enabled(decomp))
+		{
+			rohc_decomp_timings_step(&last_ticks,
+			                         &phases_ticks[ROHC_DECOMP_PHASE_CRC]);
+		}
+	}
+
+
+	try_decoding_again = false;
+	is_late_ref = false;
+	do
+	{
+		if(try_decoding_again)
+		{
+			rohc_decomp_warn(context, "CID %zu: CRC repair: try decoding packet "
+			                 "again with new assumptions", context->cid);
+		}
+
+
+		/* C. Decode extracted bits
+		 *
+		 * All bits are now extracted from the packet, let's decode them.
+		 */
+
+		decode_ok = profile->decode_bits(context, extr_bits, payload_len,
+		                                 decoded_values);
+		if(!decode_ok)
+		{
+			rohc_decomp_warn(context, "failed to decode values from bits "
+			                 "extracted from ROHC header");
+			goto error;
+		}
+		if(rohc_decomp_timings_enabled(decomp))
+		{
+			rohc_decomp_timings_step(&last_ticks,
+			                         &phases_ticks[ROHC_DECOMP_PHASE_DECODE]);
+		}
+
+
+		/* D. Build uncompressed headers & check for correct decompression
+		 *
+		 * All fields are now decoded, let's build the uncompressed headers.
+		 *
+		 * Use the CRC on decompressed headers to check whether decompression was
+		 * correct.
+		 */
+
+		/* build the uncompressed headers */
+		build_ret = profile->build_hdrs(decomp, context, *packet_type, extr_crc_bits,
+		                                decoded_values, payload_len,
+		                                uncomp_packet, &uncomp_hdr_len);
+		if(rohc_decomp_timings_enabled(decomp))
+		{
+			rohc_decomp_timings_step(&last_ticks,
+			                         &phases_ticks[ROHC_DECOMP_PHASE_CRC]);
+		}
+		if(build_ret == ROHC_STATUS_OK)
+		{
+			/* uncompressed headers successfully built and CRC is correct,
+			 * no need to try decoding with different values */
+			rohc_buf_pull(uncomp_packet, uncomp_hdr_len);
+
+			if(context->crc_corr.algo == ROHC_DECOMP_CRC_CORR_SN_NONE)
+			{
+				if(is_late_ref)
+				{
+					rohc_decomp_debug(context, "CRC is correct, late packet decoded "
+					                  "against a previous SN reference");
+				}
+				else
+				{
+					rohc_decomp_debug(context, "CRC is correct");
+				}
+				try_decoding_again = false;
+			}
+			else if((*packet_type) == ROHC_PACKET_IR)
+			{
+				rohc_decomp_debug(context, "CRC is correct, stop CRC repair");
+				context->crc_corr.algo = ROHC_DECOMP_CRC_CORR_SN_NONE;
+				context->crc_corr.counter = 0;
+			}
+			else
+			{
+				rohc_decomp_debug(context, "CID %zu: CRC repair: CRC is correct",
+				                  context->cid);
+				try_decoding_again = false;
+			}
+		}
+		else if(build_ret == ROHC_STATUS_OUTPUT_TOO_SMALL)
+		{
+			rohc_decomp_warn(context, "CID %zu: failed to build uncompressed "
+			                 "headers: output buffer too small", context->cid);
+			goto error_output_too_small;
+		}
+		else if(build_ret != ROHC_STATUS_BAD_CRC)
+		{
+			/* uncompressed headers cannot be built, stop decoding */
+			rohc_decomp_warn(context, "CID %zu: failed to build uncompressed "
+			                 "headers", context->cid);
+			if(rohc_trace_is_enabled(decomp, ROHC_TRACE_WARNING) &&
+			   (decomp->features & ROHC_DECOMP_FEATURE_DUMP_PACKETS) != 0)
+			{
+				rohc_dump_packet(decomp->trace_callback, decomp->trace_callback_priv,
+				                 ROHC_TRACE_DECOMP, ROHC_TRACE_WARNING,
+				                 "compressed headers", rohc_packet);
+			}
+			goto error;
+		}
+		else
+		{
+			/* uncompressed headers successfully built but CRC is incorrect,
 			 * try decoding with different values (repair) */
 
-			/* CRC for IR and IR-DYN packets checked before, so cannot fail here */
-			assert((*packet_type) != ROHC_PACKET_IR);
-			assert((*packet_type) != ROHC_PACKET_IR_DYN);
+			/* CRC for IR and IR-DYN packets checked before, so cannot fail here */
+			assert((*packet_type) != ROHC_PACKET_IR);
+			assert((*packet_type) != ROHC_PACKET_IR_DYN);
+
+			rohc_decomp_warn(context, "CID %zu: failed to build uncompressed "
+			                 "headers (CRC failure)", context->cid);
+
+			/* the packet may be a late packet: decode it against the previous
+			 * SN references of the reorder window before any repair */
+			is_late_ref = false;
+			if(decomp->reorder_window > 0 &&
+			   context->crc_corr.algo == ROHC_DECOMP_CRC_CORR_SN_NONE &&
+			   !rohc_decomp_rt_capped(decomp, attempts_nr))
+			{
+				is_late_ref = profile->attempt_late(decomp, context, extr_bits);
+			}
+
+			/* attempt a context/packet repair if the budgets allow it */
+			if(is_late_ref)
+			{
+				try_decoding_again = true;
+			}
+			else if(rohc_decomp_rt_capped(decomp, attempts_nr))
+			{
+				rohc_decomp_warn(context, "CID %zu: real-time mode: no more "
+				                 "decoding attempt for the packet", context->cid);
+				decomp->stats.rt_attempts_capped++;
+				try_decoding_again = false;
+			}
+			else if(context->crc_corr.algo == ROHC_DECOMP_CRC_CORR_SN_NONE &&
+			        (decomp->features & ROHC_DECOMP_FEATURE_CRC_REPAIR) != 0 &&
+			        !rohc_decomp_crc_repair_allowed(decomp, context, rohc_packet.time))
+			{
+				rohc_decomp_warn(context, "CID %zu: CRC repair: repair budget is "
+				                 "exhausted", context->cid);
+				context->crc_repair_skipped++;
+				decomp->stats.crc_repair_skipped++;
+				try_decoding_again = false;
+			}
+			else
+			{
+				try_decoding_again =
+					profile->attempt_repair(decomp, context, rohc_packet.time,
+					                        &context->crc_corr, extr_bits);
+				if(try_decoding_again)
+				{
+					ROHC_PROBE3(decomp_crc_repair, context->cid, profile->id,
+					            context->crc_corr.algo);
+					context->crc_corr.budget_used++;
+					decomp->crc_repair_global_used++;
+					context->crc_repair_attempts++;
+					decomp->stats.crc_repair_attempts++;
+				}
+			}
+			if(try_decoding_again)
+			{
+				attempts_nr++;
+			}
+
+			/* report CRC failure if attempt is not possible */
+			if(!try_decoding_again)
+			{
+				/* uncompressed headers successfully built, CRC is incorrect, repair
+				 * was disabled or attempted without any success, so give up */
+				rohc_decomp_warn(context, "CID %zu: failed to build uncompressed "
+				                 "headers (CRC failure)", context->cid);
+				if(rohc_trace_is_enabled(decomp, ROHC_TRACE_WARNING) &&
+				   (decomp->features & ROHC_DECOMP_FEATURE_DUMP_PACKETS) != 0)
+				{
+					rohc_dump_packet(decomp->trace_callback, decomp->trace_callback_priv,
+					                 ROHC_TRACE_DECOMP, ROHC_TRACE_WARNING,
+					                 "compressed headers", rohc_packet);
+				}
+				goto error_crc;
+			}
+		}
+	}
+	while(try_decoding_again);
+
+	/* after CRC failure, if the SN value seems to be correctly guessed, we must
+	 * wait for 3 CRC-valid packets before the correction is approved. Two
+	 * packets are therefore thrown away. */
+	if(context->crc_corr.algo != ROHC_DECOMP_CRC_CORR_SN_NONE)
+	{
+		if(context->crc_corr.counter > 1)
+		{
+			/* update context with decoded values even if we drop the packet */
+			rohc_decomp_update_context(context, decoded_values, payload_len,
+			                           rohc_packet.time, do_change_mode);
+
+			context->crc_corr.counter--;
+			rohc_decomp_warn(context, "CID %zu: CRC repair: throw away packet, "
+			                 "still %zu CRC-valid packets required",
+			                 context->cid, context->crc_corr.counter);
+
+			goto error_crc;
+		}
+		else if(context->crc_corr.counter == 1)
+		{
+			rohc_decomp_warn(context, "CID %zu: CRC repair: correction is "
+			                 "successful, keep packet", context->cid);
+			ROHC_PROBE3(decomp_crc_repaired, context->cid, context->profile->id,
+			            context->crc_corr.algo);
+			context->corrected_crc_failures++;
+			decomp->stats.corrected_crc_failures++;
+			switch(context->crc_corr.algo)
+			{
+				case ROHC_DECOMP_CRC_CORR_SN_WRAP:
+					context->corrected_sn_wraparounds++;
+					decomp->stats.corrected_sn_wraparounds++;
+					break;
+				case ROHC_DECOMP_CRC_CORR_SN_UPDATES:
+					context->corrected_wrong_sn_updates++;
+					decomp->stats.corrected_wrong_sn_updates++;
+					break;
+				case ROHC_DECOMP_CRC_CORR_SN_NONE:
+				default:
+					rohc_error(decomp, ROHC_TRACE_DECOMP, context->profile->id,
+					           "CID %zu: CRC repair: unsupported repair algorithm %d",
+					           context->cid, context->crc_corr.algo);
+					assert(0);
+					goto error;
+			}
+			context->crc_corr.algo = ROHC_DECOMP_CRC_CORR_SN_NONE;
+			context->crc_corr.counter--;
+		}
+	}
+	else if(is_late_ref)
+	{
+		context->late_pkts_decoded++;
+		decomp->stats.late_pkts_decoded++;
+	}
+
+
+	/* E. Copy the payload (if any) */
+
+	if((rohc_hdr_len + payload_len) != (rohc_packet.len + decomp->rru_tail_len))
+	{
+		rohc_decomp_warn(context, "ROHC %s header (%zu bytes) and payload "
+		                 "(%zu bytes) do not match the full ROHC packet "
+		                 "(%zu bytes)", rohc_get_packet_descr(*packet_type),
+		                 rohc_hdr_len, payload_len,
+		                 rohc_packet.len + decomp->rru_tail_len);
+		goto error;
+	}
+	if(decomp->payload_ref != NULL)
+	{
+		/* reference the payload instead of copying it, the payload tail
+		 * follows the ROHC packet */
+		*(decomp->payload_ref) = rohc_packet;
+		rohc_buf_pull(decomp->payload_ref, rohc_hdr_len);
+	}
+	else if(rohc_buf_avail_len(*uncomp_packet) < payload_len)
+	{
+		rohc_decomp_warn(context, "uncompressed packet too small (%zu bytes "
+		                 "max) for the %zu-byte payload",
+		                 rohc_buf_avail_len(*uncomp_packet), payload_len);
+		goto error_output_too_small;
+	}
+	else if(payload_len != 0)
+	{
+		const size_t payload_tail_len = decomp->rru_tail_len;
+
+		rohc_buf_append(uncomp_packet, payload_data, payload_len - payload_tail_len);
+		if(payload_tail_len > 0)
+		{
+			/* copy the end of the payload straight from the segments */
+			rohc_decomp_rru_copy(decomp->rru_segs, decomp->rru_segs_nr,
+			                     decomp->rru_tail_off, payload_tail_len,
+			                     rohc_buf_data(*uncomp_packet) +
+			                     payload_len - payload_tail_len);
+			uncomp_packet->len += payload_tail_len;
+		}
+		rohc_buf_pull(uncomp_packet, payload_len);
+	}
+	/* unhide the uncompressed headers and payload */
+	if(decomp->payload_ref != NULL)
+	{
+		rohc_buf_push(uncomp_packet, uncomp_hdr_len);
+	}
+	else
+	{
+		rohc_buf_push(uncomp_packet, uncomp_hdr_len + payload_len);
+	}
+	rohc_decomp_debug(context, "uncompressed packet length = %zu bytes",
+	                  uncomp_packet->len);
+	if(rohc_decomp_timings_enabled(decomp))
+	{
+		rohc_decomp_timings_step(&last_ticks,
+		                         &phases_ticks[ROHC_DECOMP_PHASE_PAYLOAD]);
+		rohc_decomp_timings_set_pending(decomp, phases_ticks);
+	}
+
+
+	/* F. Update the compression context
+	 *
+	 * Once CRC check is done, update the compression context with the values
+	 * that were decoded earlier.
+	 *
+	 * TODO: check what fields shall be updated in the context
+	 */
+
+	/* we are either already in full context state or we can transit
+	 * through it */
+	if(context->state != ROHC_DECOMP_STATE_FC)
+	{
+		const rohc_decomp_state_t old_state = context->state;
+
+		rohc_decomp_debug(context, "change from state %d to state %d",
+		                  context->state, ROHC_DECOMP_STATE_FC);
+		context->state = ROHC_DECOMP_STATE_FC;
+
+		/* the new contexts are notified once they replace the former ones */
+		if(decomp->contexts[context->cid] == context)
+		{
+			rohc_decomp_notify_ctxt_event(context, ROHC_DECOMP_EVENT_STATE_CHANGE,
+			                              old_state, context->mode);
+		}
+	}
+
+	/* update context with decoded values */
+	rohc_decomp_update_context(context, decoded_values, payload_len,
+	                           rohc_packet.time, do_change_mode);
+
+	/* update statistics */
+	rohc_decomp_stats_add_success(context, rohc_hdr_len, uncomp_hdr_len);
+
+	/* decompression is successful */
+	return ROHC_STATUS_OK;
+
+error:
+	return ROHC_STATUS_ERROR;
+error_output_too_small:
+	return ROHC_STATUS_OUTPUT_TOO_SMALL;
+error_crc:
+	return ROHC_STATUS_BAD_CRC;
+error_malformed:
+	return ROHC_STATUS_MALFORMED;
+}
+
+
+/**
+ * @brief Check whether the CRC on IR or IR-DYN header is correct or not
+ *
+ * The CRC for IR/IR-DYN headers is always CRC-8. It is computed on the
+ * whole compressed header (payload excluded, but any CID bits included).
+ *
+ * @param decomp          The ROHC decompressor
+ * @param context         The decompression context
+ * @param rohc_hdr        The compressed IR or IR-DYN header
+ * @param rohc_hdr_len    The length (in bytes) of the compressed header
+ * @param add_cid_len     The length of the optional Add-CID field
+ * @param large_cid_len   The length of the optional large CID field
+ * @param crc_packet      The CRC extracted from the ROHC header
+ * @return                true if the CRC is correct, false otherwise
+ */
+static bool rohc_decomp_check_ir_crc(const struct rohc_decomp *const decomp,
+                                     const struct rohc_decomp_ctxt *const context,
+                                     const uint8_t *const rohc_hdr,
+                                     const size_t rohc_hdr_len,
+                                     const size_t add_cid_len,
+                                     const size_t large_cid_len,
+                                     const uint8_t crc_packet)
+{
+	const size_t rohc_hdr_full_len = add_cid_len + large_cid_len + rohc_hdr_len;
+	const rohc_crc_type_t crc_type = ROHC_CRC_TYPE_8;
+	const uint8_t crc_zero[] = { 0x00 };
+	unsigned int crc_comp; /* computed CRC */
+
+	assert(decomp != NULL);
+	assert(rohc_hdr != NULL);
+	assert(rohc_hdr_len >= (add_cid_len + 2 + large_cid_len + 1));
+
+	/* ROHC header before CRC field:
+	 * optional Add-CID + IR type + Profile ID + optional large CID */
+	crc_comp = crc_calculate(crc_type, rohc_hdr,
+	                         add_cid_len + 2 + large_cid_len,
+	                         CRC_INIT_8);
+
+	/* all profiles but the Uncompressed profile compute their CRC through the
+	 * zeroed CRC field and the rest of the ROHC header */
+	if(context->profile->id != ROHC_PROFILE_UNCOMPRESSED)
+	{
+		/* zeroed CRC field */
+		crc_comp = crc_calculate(crc_type, crc_zero, 1, crc_comp);
+
+		/* ROHC header after CRC field */
+		crc_comp = crc_calculate(crc_type,
+		                         rohc_hdr + add_cid_len + 2 + large_cid_len + 1,
+		                         rohc_hdr_len - add_cid_len - 2 - large_cid_len - 1,
+		                         crc_comp);
+	}
+
+	rohc_decomp_debug(context, "CRC-%d on compressed %zu-byte ROHC header = "
+	                  "0x%x", crc_type, rohc_hdr_full_len, crc_comp);
+
+	/* does the computed CRC match the one in packet? */
+	if(crc_comp != crc_packet)
+	{
+		rohc_decomp_warn(context, "CRC failure (computed = 0x%02x, packet = "
+		                 "0x%02x)", crc_comp, crc_packet);
+		goto error;
+	}
+
+	/* computed CRC matches the one in packet */
+	return true;
+
+error:
+	return false;
+}
+
+
+/**
+ * @brief Whether the repair budgets allow one more repair upon CRC failure
+ *
+ * The budgets of the context and of the decompressor are refilled every
+ * second of packet arrival time.
+ *
+ * @param decomp       The ROHC decompressor
+ * @param context       The decompression context
+ * @param arrival_time  The arrival time of the packet that failed the CRC
+ * @return              true if one more repair may be attempted,
+ *                      false if one of the budgets is exhausted
+ */
+static bool rohc_decomp_crc_repair_allowed(struct rohc_decomp *const decomp,
+                                           struct rohc_decomp_ctxt *const context,
+                                           const struct rohc_ts arrival_time)
+{
+	struct rohc_decomp_crc_corr_ctxt *const crc_corr = &context->crc_corr;
+
+	/* refill the budgets if a new second began */
+	if(crc_corr->budget_sec != arrival_time.sec)
+	{
+		crc_corr->budget_sec = arrival_time.sec;
+		crc_corr->budget_used = 0;
+	}
+	if(decomp->crc_repair_global_sec != arrival_time.sec)
+	{
+		decomp->crc_repair_global_sec = arrival_time.sec;
+		decomp->crc_repair_global_used = 0;
+	}
+
+	if(decomp->crc_repair_ctxt_budget != 0 &&
+	   crc_corr->budget_used >= decomp->crc_repair_ctxt_budget)
+	{
+		return false;
+	}
+	if(decomp->crc_repair_global_budget != 0 &&
+	   decomp->crc_repair_global_used >= decomp->crc_repair_global_budget)
+	{
+		return false;
+	}
+
+	return true;
+}
+
+
+/**
+ * @brief Whether the real-time mode forbids one more decoding attempt
+ *
+ * In real-time mode, one CRC failure is followed by one decoding attempt at
+ * most, whatever the reorder window and the repair algorithms, so that the
+ * packet costs at most two decodings.
+ *
+ * @param decomp       The ROHC decompressor
+ * @param attempts_nr  The number of decoding attempts already made for the
+ *                     packet after the first decoding
+ * @return             true if no more decoding attempt is allowed
+ */
+static bool rohc_decomp_rt_capped(const struct rohc_decomp *const decomp,
+                                  const size_t attempts_nr)
+{
+	return ((decomp->features & ROHC_DECOMP_FEATURE_REALTIME) != 0 &&
+	        attempts_nr > 0);
+}
+
+
+/**
+ * @brief Update context with decoded values
+ *
+ * @param context              The decompression context
+ * @param decoded              The decoded values to update in the context
+ * @param payload_len          The length of the packet payload
+ * @param pkt_arrival_time     The arrival time of the decoded ROHC packet
+ * @param[out] do_change_mode  Whether the context wants to change its
+ *                             operational mode or not
+ */
+static void rohc_decomp_update_context(struct rohc_decomp_ctxt *const context,
+                                       const void *const decoded,
+                                       const size_t payload_len,
+                                       const struct rohc_ts pkt_arrival_time,
+                                       bool *const do_change_mode)
+{
+	struct rohc_decomp_crc_corr_ctxt *const crc_corr = &context->crc_corr;
+
+	/* call the profile-specific callback */
+	context->profile->update_ctxt(context, decoded, payload_len, do_change_mode);
+
+	/* update arrival time */
+	crc_corr->arrival_times[crc_corr->arrival_times_index] = pkt_arrival_time;
+	crc_corr->arrival_times_index =
+		(crc_corr->arrival_times_index + 1) % ROHC_MAX_ARRIVAL_TIMES;
+	crc_corr->arrival_times_nr =
+		rohc_min(crc_corr->arrival_times_nr + 1, ROHC_MAX_ARRIVAL_TIMES);
+}
+
+
+/**
+ * @brief Push one packet in the history of the last packets
+ *
+ * The packets that were only counted by \ref rohc_decomp_fb_hist_skip are
+ * pushed at the same time, all at once.
+ *
+ * @param hist      The history of the last packets
+ * @param is_error  Whether the packet failed to be decompressed or not
+ */
+static void rohc_decomp_fb_hist_push(struct rohc_decomp_fb_hist *const hist,
+                                     const bool is_error)
+{
+	const size_t shift = hist->unpushed_nr + 1;
+	size_t i;
+
+	if(shift >= ROHC_DECOMP_FB_HIST_LEN)
+	{
+		hist->errors = 0;
+		for(i = 0; i < ROHC_FEEDBACK_RESERVED; i++)
+		{
+			hist->feedbacks[i].needed = 0;
+			hist->feedbacks[i].sent = 0;
+		}
+	}
+	else
+	{
+		hist->errors <<= shift;
+		for(i = 0; i < ROHC_FEEDBACK_RESERVED; i++)
+		{
+			hist->feedbacks[i].needed <<= shift;
+			hist->feedbacks[i].sent <<= shift;
+		}
+	}
+	hist->errors |= (is_error ? 1U : 0U);
+	hist->unpushed_nr = 0;
+	hist->clean_nr = (is_error ? 0 : (hist->clean_nr + 1));
+}
+
+
+/**
+ * @brief Count one packet that needs no feedback in the history
+ *
+ * The packet is pushed later, the next time \ref rohc_decomp_fb_hist_push
+ * is called.
+ *
+ * @param hist  The history of the last packets
+ */
+static inline void rohc_decomp_fb_hist_skip(struct rohc_decomp_fb_hist *const hist)
+{
+	if(hist->unpushed_nr < ROHC_DECOMP_FB_HIST_LEN)
+	{
+		hist->unpushed_nr++;
+	}
+	hist->clean_nr++;
+}
+
+
+/**
+ * @brief Get the operational mode one context shall target
+ *
+ * With the fixed policy, all the contexts target the mode given by the user
+ * at decompressor creation.
+ *
+ * With the adaptive policy, a context in U-mode moves to O-mode as soon as
+ * its error rate over the last 32 packets reaches the configured k/n ratio:
+ * the NACKs then repair the context, instead of waiting for the periodic
+ * refreshes of the compressor. A context in O-mode moves back to U-mode
+ * once it decompressed 32 packets and 2 RTTs of packets in a row without
+ * any error: feedback is then useless. The profiles which feedback cannot
+ * carry the mode (Uncompressed, TCP and ROHCv2) always target the mode
+ * given by the user.
+ *
+ * @param decomp   The ROHC decompressor
+ * @param context  The decompression context
+ * @return         The operational mode the context shall target
+ */
+static rohc_mode_t rohc_decomp_ctxt_target_mode(const struct rohc_decomp *const decomp,
+                                                const struct rohc_decomp_ctxt *const context)
+{
+	const rohc_profile_t profile_id = context->profile->id;
+	const struct rohc_decomp_fb_hist *const hist = &context->fb_hist;
+	rohc_mode_t target_mode;
+
+	if(decomp->mode_policy == ROHC_DECOMP_MODE_FIXED ||
+	   profile_id == ROHC_PROFILE_UNCOMPRESSED ||
+	   rohc_feedback_is_rfc6846(profile_id))
+	{
+		target_mode = decomp->target_mode;
+	}
+	else if(context->mode == ROHC_U_MODE)
+	{
+		size_t errors_nr = 0;
+
+		/* the packets not pushed in the history yet are successes */
+		if(hist->unpushed_nr < ROHC_DECOMP_FB_HIST_LEN)
+		{
+			errors_nr = __builtin_popcount(hist->errors << hist->unpushed_nr);
+		}
+		if(errors_nr > 0 && errors_nr >= decomp->mode_errors.pkts_nr)
+		{
+			target_mode = ROHC_O_MODE;
+		}
+		else
+		{
+			target_mode = ROHC_U_MODE;
+		}
+	}
+	else
+	{
+		const size_t clean_min = rohc_max(ROHC_DECOMP_FB_HIST_LEN, 2 * decomp->prtt);
+
+		if(hist->clean_nr >= clean_min)
+		{
+			target_mode = ROHC_U_MODE;
+		}
+		else
+		{
+			target_mode = context->mode;
+		}
+	}
+
+	return target_mode;
+}
+
+
+/**
+ * @brief Build a positive ACK feedback
+ *
+ * @param decomp         The ROHC decompressor
+ * @param infos          The information collected on the successfully
+ *                       decompressed packet
+ * @param[out] feedback  The feedback to be transmitted to the remote
+ *                       compressor through the feedback channel
+ * @return               true if the ACK feedback was successfully built
+ *                       (may be 0 byte), false if a problem occurred
+ */
+static bool rohc_decomp_feedback_ack(struct rohc_decomp *const decomp,
+                                     const struct rohc_decomp_stream *const infos,
+                                     struct rohc_buf *const feedback)
+{
+	bool do_build_ack = false;
+	size_t sent_nr;
+	size_t k;
+
+	assert(infos->cid_found);
+	assert(infos->context_found);
+
+	rohc_debug(decomp, ROHC_TRACE_DECOMP, infos->profile_id,
+	           "CID %zu: %s: %s state: %s packet successfully decompressed",
+	           infos->cid, rohc_get_mode_descr(infos->mode),
+	           rohc_decomp_get_state_descr(infos->state),
+	           rohc_get_packet_descr(infos->packet_type));
+
+	/* force sending an ACK if compressor/decompressor modes mismatch or
+	 * if decompressor just changed its operational mode */
+	if(infos->do_change_mode)
+	{
+		rohc_debug(decomp, ROHC_TRACE_DECOMP, infos->profile_id,
+		           "force positive ACK because mode changed or compressor "
+		           "reported a different mode");
+		do_build_ack = true;
+	}
+	/* check if the decompressor shall build a positive feedback */
+	else if(infos->mode == ROHC_U_MODE)
+	{
+		/* send ACK(U) with rate-limiting as stated in RFC 3095, §5.3.1.3:
+		 *   To improve performance for the Unidirectional mode over a link that
+		 *   does have a feedback channel, the decompressor MAY send an
+		 *   acknowledgment when decompression succeeds.  Setting the mode
+		 *   parameter in the ACK packet to U indicates that the compressor is to
+		 *   stay in Unidirectional mode. [...] If IR packets continue to arrive,
+		 *   the decompressor MAY repeat the ACK(U), but it SHOULD NOT repeat the
+		 *   ACK(U) continuously.
+		 * ACK(U) are optional, do not bother with them if there is no feedback
+		 * channel at all */
+		do_build_ack = !!(feedback != NULL);
+	}
+	else if(infos->mode == ROHC_O_MODE)
+	{
+		/* feedback logic for O-mode is described in RFC 3095, §5.4.2.2 */
+
+		/* all states: when an IR packet is correctly decompressed, send an ACK(O) */
+		if(infos->packet_type == ROHC_PACKET_IR)
+		{
+			do_build_ack = true;
+		}
+		/* SC state:
+		 *  - when a type 2 or an IR-DYN packet is correctly decompressed,
+		 *    optionally send an ACK(O)
+		 * FC state:
+		 *  - when a type 2 or an IR-DYN packet is correctly decompressed,
+		 *    optionally send an ACK(O)
+		 *  - when a type 0 or 1 packet is correctly decompressed, no
+		 *    feedback is sent */
+		else if(infos->state != ROHC_DECOMP_STATE_NC &&
+		        rohc_decomp_packet_carry_crc_7_or_8(infos->packet_type))
+		{
+			do_build_ack = true;
+		}
+	}
+	else /* R-mode */
+	{
+		assert(0); /* TODO: R-mode not implemented yet */
+		goto error;
+	}
+
+	/* stop now if no ACK is required: the packet is only counted, it will be
+	 * pushed in the feedback histories the next time they are needed */
+	if(!do_build_ack)
+	{
+		rohc_debug(decomp, ROHC_TRACE_DECOMP, infos->profile_id,
+		           "no need to send a positive ACK");
+		rohc_decomp_fb_hist_skip(&decomp->fb_hist);
+		rohc_decomp_fb_hist_skip(&infos->context->fb_hist);
+		goto skip;
+	}
+
+	/* rate-limit the ACKs, except the one that carries a mode transition of
+	 * the context: the compressor would not learn it otherwise */
+	rohc_decomp_fb_hist_push(&decomp->fb_hist, false);
+	rohc_decomp_fb_hist_push(&infos->context->fb_hist, false);
+	decomp->fb_hist.feedbacks[ROHC_FEEDBACK_ACK].needed |= 1;
+	infos->context->fb_hist.feedbacks[ROHC_FEEDBACK_ACK].needed |= 1;
+	sent_nr = __builtin_popcount(infos->context->fb_hist.feedbacks[ROHC_FEEDBACK_ACK].sent);
+	k = sent_nr * 100;
+	if(!infos->is_mode_transition &&
+	   sent_nr >= decomp->ack_rate_limits.speed.pkts_nr)
+	{
+		rohc_debug(decomp, ROHC_TRACE_DECOMP, infos->profile_id,
+		           "do not send a positive ACK because of rate-limiting (%zu of 3200 "
+		           "with threshold %zu)", k, decomp->ack_rate_limits.speed.threshold);
+		goto skip;
+	}
+	rohc_debug(decomp, ROHC_TRACE_DECOMP, infos->profile_id,
+	           "should send a positive ACK now (CID = %zu, current mode = %d, "
+	           "target mode = %d, at least %zu bits of SN 0x%x, rate-limiting = "
+	           "%zu of 3200 with threshold %zu)", infos->cid, infos->mode,
+	           decomp->target_mode, infos->sn_bits_nr, infos->sn_bits,
+	           k, decomp->ack_rate_limits.speed.threshold);
+	decomp->fb_hist.feedbacks[ROHC_FEEDBACK_ACK].sent |= 1;
+	infos->context->fb_hist.feedbacks[ROHC_FEEDBACK_ACK].sent |= 1;
+
+	/* prepare feedback packet if asked by user */
+	if(feedback == NULL)
+	{
+		rohc_debug(decomp, ROHC_TRACE_DECOMP, infos->profile_id,
+		           "user choose not to use a feedback channel, do not build any "
+		           "feedback packet");
+	}
+	else if(decomp->ack_coalescing_window > 0 && !infos->do_change_mode)
+	{
+		/* delay the ACK to coalesce it with the next ACKs, the ACKs that
+		 * advertise a mode change are never delayed */
+		if(!rohc_decomp_delay_ack(decomp, infos, feedback))
+		{
+			goto error;
+		}
+	}
+	else
+	{
+		/* the ACK supersedes the delayed ACK of the same context if any */
+		rohc_decomp_drop_ack(decomp, infos->cid);
+
+		if(!rohc_decomp_build_ack(decomp, infos->profile_id, infos->cid,
+		                          infos->cid_type, infos->mode, infos->sn_bits,
+		                          infos->sn_bits_nr, infos->do_change_mode,
+		                          feedback))
+		{
+			goto error;
+		}
+
+		/* piggyback the delayed ACKs of the other contexts */
+		if(!rohc_decomp_flush_acks(decomp, feedback))
+		{
+			goto error;
+		}
+	}
+
+skip:
+	return true;
+
+error:
+	return false;
+}
+
+
+/**
+ * @brief Build one positive ACK feedback
+ *
+ * The feedback is appended to the feedback buffer if there is enough room
+ * left in it, otherwise the feedback is silently discarded.
+ *
+ * @param decomp          The ROHC decompressor
+ * @param profile_id      The profile of the acknowledged context
+ * @param cid             The CID of the acknowledged context
+ * @param cid_type        The CID type of the channel
+ * @param mode            The mode of the acknowledged context
+ * @param sn_bits         The SN LSB bits of the acknowledged packet
+ * @param sn_bits_nr      The number of SN LSB bits
+ * @param do_change_mode  Whether the context mode shall be advertised
+ * @param[out] feedback   The feedback to be transmitted to the remote
+ *                        compressor through the feedback channel
+ * @return                true if the ACK feedback was successfully built
+ *                        (may be 0 byte), false if a problem occurred
+ */
+static bool rohc_decomp_build_ack(const struct rohc_decomp *const decomp,
+                                  const rohc_profile_t profile_id,
+                                  const rohc_cid_t cid,
+                                  const rohc_cid_type_t cid_type,
+                                  const rohc_mode_t mode,
+                                  const uint32_t sn_bits,
+                                  const size_t sn_bits_nr,
+                                  const bool do_change_mode,
+                                  struct rohc_buf *const feedback)
+{
+	const char mode_short[ROHC_R_MODE + 1] = { '?', 'U', 'O', 'R' };
+	rohc_feedback_crc_t crc_present;
+	struct d_feedback sfeedback;
+	uint8_t *feedbackp;
+	size_t feedbacksize;
+	size_t feedback_hdr_len;
+
+	/* FEEDBACK-1 or FEEDBACK-2 ? */
+	if(profile_id == ROHC_PROFILE_UNCOMPRESSED ||
+	   (!do_change_mode && sn_bits_nr != 0 && sn_bits_nr <= 8))
+	{
+		rohc_debug(decomp, ROHC_TRACE_DECOMP, profile_id,
+		           "use FEEDBACK-1 as positive feedback");
+		f_feedback1(sn_bits, &sfeedback);
+		crc_present = ROHC_FEEDBACK_WITH_NO_CRC;
+	}
+	else
+	{
+		rohc_debug(decomp, ROHC_TRACE_DECOMP, profile_id,
+		           "use FEEDBACK-2 as positive ACK(%c) feedback",
+		           mode_short[mode]);
+		if(!f_feedback2(profile_id, ROHC_FEEDBACK_ACK, mode, sn_bits, sn_bits_nr,
+		                &sfeedback))
+		{
+			rohc_warning(decomp, ROHC_TRACE_DECOMP, profile_id,
+			             "failed to build the ACK feedback");
+			goto error;
+		}
+
+		/* use CRC option if mode change requested */
+		if(rohc_feedback_is_rfc6846(profile_id))
+		{
+			crc_present = ROHC_FEEDBACK_WITH_CRC_BASE;
+		}
+		else if(do_change_mode)
+		{
+			crc_present = ROHC_FEEDBACK_WITH_CRC_OPT;
+		}
+		else
+		{
+			crc_present = ROHC_FEEDBACK_WITH_NO_CRC;
+		}
+	}
+
+	/* build the feedback packet */
+	feedbackp = f_wrap_feedback(&sfeedback, cid, cid_type, crc_present,
+	                            &feedbacksize);
+	if(feedbackp == NULL)
+	{
+		rohc_warning(decomp, ROHC_TRACE_DECOMP, profile_id,
+		             "failed to wrap the ACK feedback");
+		goto error;
+	}
+
+	/* copy the feedback to the buffer provided by the user */
+	/* TODO: build feedback directly into the provided buffer */
+	feedback_hdr_len = 1 + (feedbacksize < 8 ? 0 : 1);
+	if((feedback_hdr_len + feedbacksize) <= rohc_buf_avail_len(*feedback))
+	{
+		if(feedbacksize < 8)
+		{
+			rohc_buf_byte(*feedback) = 0xf0 | feedbacksize;
+		}
+		else
+		{
+			rohc_buf_byte(*feedback) = 0xf0;
+			rohc_buf_byte_at(*feedback, 1) = feedbacksize;
+		}
+		feedback->len += feedback_hdr_len;
+		rohc_buf_append(feedback, feedbackp, feedbacksize);
+	}
+
+	if(feedback->len > 0)
+	{
+		rohc_debug(decomp, ROHC_TRACE_DECOMP, profile_id,
+		           "decompressor built a %zu-byte positive feedback",
+		           feedback->len);
+	}
+
+	/* destroy the temporary feedback buffer */
+	rohc_free(feedbackp);
+
+	return true;
+
+error:
+	return false;
+}
+
+
+/**
+ * @brief Delay one positive ACK to coalesce it with the next ACKs
+ *
+ * If an ACK is already delayed for the same context, the new ACK replaces it:
+ * only the SN of the latest packet is acknowledged. The ACK stays delayed
+ * since the first of the coalesced ACKs, so that no ACK is delayed for more
+ * than the coalescing window.
+ *
+ * If too many ACKs are delayed, all of them are built before the new one is
+ * delayed.
+ *
+ * @param decomp         The ROHC decompressor
+ * @param infos          The information collected on the successfully
+ *                       decompressed packet
+ * @param[out] feedback  The feedback to be transmitted to the remote
+ *                       compressor through the feedback channel
+ * @return               true if the ACK was successfully delayed,
+ *                       false if a problem occurred
+ */
+static bool rohc_decomp_delay_ack(struct rohc_decomp *const decomp,
+                                  const struct rohc_decomp_stream *const infos,
+                                  struct rohc_buf *const feedback)
+{
+	struct rohc_decomp_pending_ack *pending_ack;
+	size_t i;
+
+	for(i = 0; i < decomp->pending_acks_nr &&
+	           decomp->pending_acks[i].cid != infos->cid; i++)
+	{
+	}
+
+	if(i < decomp->pending_acks_nr)
+	{
+		rohc_debug(decomp, ROHC_TRACE_DECOMP, infos->profile_id,
+		           "coalesce the positive ACK with the one delayed for CID %zu",
+		           infos->cid);
+		pending_ack = &(decomp->pending_acks[i]);
+	}
+	else
+	{
+		if(decomp->pending_acks_nr >= ROHC_DECOMP_PENDING_ACKS_MAX)
+		{
+			rohc_debug(decomp, ROHC_TRACE_DECOMP, infos->profile_id,
+			           "too many positive ACKs delayed, build them now");
+			if(!rohc_decomp_flush_acks(decomp, feedback))
+			{
+				goto error;
+			}
+			if(decomp->pending_acks_nr >= ROHC_DECOMP_PENDING_ACKS_MAX)
+			{
+				/* not enough room in the feedback buffer: give up the oldest
+				 * ACK, the next ACKs of its context will acknowledge it */
+				rohc_decomp_drop_ack(decomp, decomp->pending_acks[0].cid);
+			}
+		}
+		rohc_debug(decomp, ROHC_TRACE_DECOMP, infos->profile_id,
+		           "delay the positive ACK for CID %zu", infos->cid);
+		pending_ack = &(decomp->pending_acks[decomp->pending_acks_nr]);
+		pending_ack->cid = infos->cid;
+		pending_ack->delayed_since = decomp->ack_coalescing_clock;
+		decomp->pending_acks_nr++;
+	}
+	pending_ack->profile_id = infos->profile_id;
+	pending_ack->mode = infos->mode;
+	pending_ack->sn_bits = infos->sn_bits;
+	pending_ack->sn_bits_nr = infos->sn_bits_nr;
+
+	return true;
+
+error:
+	return false;
+}
+
+
+/**
+ * @brief Forget the positive ACK delayed for one context, if any
+ *
+ * @param decomp  The ROHC decompressor
+ * @param cid     The CID of the context
+ */
+static void rohc_decomp_drop_ack(struct rohc_decomp *const decomp,
+                                 const rohc_cid_t cid)
+{
+	size_t i;
+
+	for(i = 0; i < decomp->pending_acks_nr; i++)
+	{
+		if(decomp->pending_acks[i].cid == cid)
+		{
+			decomp->pending_acks_nr--;
+			memmove(&(decomp->pending_acks[i]), &(decomp->pending_acks[i + 1]),
+			        (decomp->pending_acks_nr - i) *
+			        sizeof(struct rohc_decomp_pending_ack));
+			break;
+		}
+	}
+}
+
+
+/**
+ * @brief Build all the delayed positive ACKs
+ *
+ * The ACKs are appended one after the other in the feedback buffer, so that
+ * they are transmitted together. The ACKs that do not fit in the feedback
+ * buffer stay delayed.
+ *
+ * @param decomp         The ROHC decompressor
+ * @param[out] feedback  The feedback to be transmitted to the remote
+ *                       compressor through the feedback channel
+ * @return               true if the ACKs were successfully built,
+ *                       false if a problem occurred
+ */
+static bool rohc_decomp_flush_acks(struct rohc_decomp *const decomp,
+                                   struct rohc_buf *const feedback)
+{
+	size_t built_nr;
+
+	for(built_nr = 0; built_nr < decomp->pending_acks_nr; built_nr++)
+	{
+		const struct rohc_decomp_pending_ack *const pending_ack =
+			&(decomp->pending_acks[built_nr]);
+		const size_t feedback_len = feedback->len;
+
+		if(!rohc_decomp_build_ack(decomp, pending_ack->profile_id,
+		                          pending_ack->cid, decomp->medium.cid_type,
+		                          pending_ack->mode, pending_ack->sn_bits,
+		                          pending_ack->sn_bits_nr, false, feedback))
+		{
+			goto error;
+		}
+		if(feedback->len == feedback_len)
+		{
+			rohc_debug(decomp, ROHC_TRACE_DECOMP, pending_ack->profile_id,
+			           "no more room in the feedback buffer, keep %zu positive "
+			           "ACKs delayed", decomp->pending_acks_nr - built_nr);
+			break;
+		}
+	}
+
+	/* the ACKs that were not built are now the oldest ones */
+	decomp->pending_acks_nr -= built_nr;
+	memmove(decomp->pending_acks, &(decomp->pending_acks[built_nr]),
+	        decomp->pending_acks_nr * sizeof(struct rohc_decomp_pending_ack));
+
+	return true;
+
+error:
+	return false;
+}
+
+
+/**
+ * @brief Age the delayed positive ACKs by one packet
+ *
+ * All the delayed ACKs are built together as soon as the oldest one was
+ * delayed for the whole coalescing window.
+ *
+ * @param decomp         The ROHC decompressor
+ * @param[out] feedback  The feedback to be transmitted to the remote
+ *                       compressor through the feedback channel
+ * @return               true if the ACKs were successfully aged,
+ *                       false if a problem occurred
+ */
+static bool rohc_decomp_age_acks(struct rohc_decomp *const decomp,
+                                 struct rohc_buf *const feedback)
+{
+	decomp->ack_coalescing_clock++;
+
+	if(decomp->pending_acks_nr > 0 &&
+	   (decomp->ack_coalescing_clock - decomp->pending_acks[0].delayed_since) >=
+	   decomp->ack_coalescing_window)
+	{
+		rohc_debug(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+		           "coalescing window elapsed, build the %zu delayed positive "
+		           "ACKs", decomp->pending_acks_nr);
+		return rohc_decomp_flush_acks(decomp, feedback);
+	}
+
+	return true;
+}
+
+
+/**
+ * @brief Build a negative ACK feedback
+ *
+ * There are two types of negative feedback: NACK and STATIC-NACK.
+ *
+ * @param decomp         The ROHC decompressor
+ * @param infos          The information collected on the failed
+ *                       decompressed packet
+ * @param[out] feedback  The feedback to be transmitted to the remote
+ *                       compressor through the feedback channel (may be NULL)
+ * @return               true if the ACK feedback was successfully built
+ *                       (may be 0 byte), false if a problem occurred
+ */
+static bool rohc_decomp_feedback_nack(struct rohc_decomp *const decomp,
+                                      const struct rohc_decomp_stream *const infos,
+                                      struct rohc_buf *const feedback)
+{
+	bool do_downward_transition = false;
+	bool do_build_ack = false;
+	enum rohc_feedback_ack_type ack_type;
+	const struct rohc_decomp_fb_hist *hist;
+	size_t threshold_too_quickly;
+	size_t pkts_nr_too_quickly;
+	size_t errors_nr;
+	size_t sent_nr;
+	size_t k_too_quickly;
+	size_t k_too_many;
+
+	/* update all the stats about the feedbacks */
+	rohc_decomp_fb_hist_push(&decomp->fb_hist, true);
+	if(infos->context != NULL)
+	{
+		rohc_decomp_fb_hist_push(&infos->context->fb_hist, true);
+	}
+
+	/* the decompressor cannot warn the compressor if the CID is not identified
+	 * (this happens only if packet is malformed) */
+	if(!infos->cid_found)
+	{
+		rohc_debug(decomp, ROHC_TRACE_DECOMP, infos->profile_id,
+		           "do not perform downward state transition nor send negative "
+		           "feedback to compressor since CID was not identified");
+		goto skip;
+	}
+
+	if(infos->context_found)
+	{
+		rohc_debug(decomp, ROHC_TRACE_DECOMP, infos->profile_id,
+		           "CID %zu: %s: %s state: %s packet %s", infos->cid,
+		           rohc_get_mode_descr(infos->mode),
+		           rohc_decomp_get_state_descr(infos->state),
+		           rohc_get_packet_descr(infos->packet_type),
+		           infos->crc_failed ? "failed the CRC check" : "received");
+	}
+	else
+	{
+		rohc_debug(decomp, ROHC_TRACE_DECOMP, infos->profile_id,
+		           "CID %zu: packet failed to be parsed", infos->cid);
+	}
+
+	/* check if the decompressor shall build a negative feedback */
+	if(infos->profile_id == ROHC_PROFILE_UNCOMPRESSED)
+	{
+		/* the Uncompressed profile does not use negative feedback nor FEEDBACK-2 */
+		rohc_debug(decomp, ROHC_TRACE_DECOMP, infos->profile_id,
+		           "do not perform downward state transition nor send negative "
+		           "feedback for the Uncompressed profile");
+		goto skip;
+	}
+	else if(!infos->context_found)
+	{
+		/* RFC says nothing about negative feedbacks for malformed packets, but
+		 * it seems useful to tell the compressor to got back to lower states
+		 * if a packet failed to be parsed */
+		ack_type = ROHC_FEEDBACK_STATIC_NACK;
+		do_downward_transition = false; /* impossible w/o context */
+		do_build_ack = !!(decomp->target_mode > ROHC_U_MODE);
+	}
+	else if(infos->mode == ROHC_U_MODE)
+	{
+		/* U-mode does not use negative feedback, except to tell the
+		 * compressor that the decompressor just moved back to U-mode */
+		ack_type = ROHC_FEEDBACK_NACK;
+		do_downward_transition = true;
+		do_build_ack = infos->is_mode_transition;
+	}
+	else if(infos->mode == ROHC_O_MODE)
+	{
+		/* feedback logic for O-mode is described in RFC 3095, §5.4.2.2 */
+
+		/* NC state: when receiving a type 0, 1, 2 or IR-DYN packet, or an IR
+		 * packet has failed the CRC check, send a STATIC-NACK(O), subject to the
+		 * considerations at the beginning of section 5.7.6 */
+		if(infos->state == ROHC_DECOMP_STATE_NC)
+		{
+			ack_type = ROHC_FEEDBACK_STATIC_NACK;
+			do_downward_transition = true;
+			do_build_ack = true;
+		}
+		/* SC state:
+		 *  - when a type 0 or 1 packet is received, treat it as a mismatching
+		 *    CRC and use the logic of section 5.3.2.2.3 to decide if a NACK(O)
+		 *    should be sent
+		 *  - when decompression of a type 2 packet, an IR-DYN packet or an
+		 *    IR packet has failed, use the logic of section 5.3.2.2.3 to
+		 *    decide if a STATIC-NACK(O) should be sent */
+		else if(infos->state == ROHC_DECOMP_STATE_SC)
+		{
+			if(!rohc_decomp_packet_carry_crc_7_or_8(infos->packet_type))
+			{
+				ack_type = ROHC_FEEDBACK_NACK;
+				do_downward_transition = true;
+				do_build_ack = true;
+			}
+			else
+			{
+				ack_type = ROHC_FEEDBACK_STATIC_NACK;
+				do_downward_transition = true;
+				do_build_ack = true;
+			}
+		}
+		/* FC state: when any packet fails the CRC check, use the logic of
+		 * 5.3.2.2.3 to decide if a NACK(O) should be sent */
+		else
+		{
+			ack_type = ROHC_FEEDBACK_NACK;
+			do_downward_transition = true;
+			do_build_ack = true;
+		}
+	}
+	else /* R-mode */
+	{
+		assert(0); /* TODO: R-mode not implemented yet */
+		goto error;
+	}
+
+	/* stop now if no downward state transition nor NACK is required */
+	if(!do_build_ack && !do_downward_transition)
+	{
+		rohc_debug(decomp, ROHC_TRACE_DECOMP, infos->profile_id,
+		           "no need to perform a downward state transition nor send a "
+		           "negative ACK");
+		goto skip;
+	}
+	assert(ack_type == ROHC_FEEDBACK_NACK || ack_type == ROHC_FEEDBACK_STATIC_NACK);
+
+	/* rate-limit the downward state transitions and NACKs */
+	decomp->fb_hist.feedbacks[ack_type].needed |= 1;
+	if(infos->context != NULL)
+	{
+		infos->context->fb_hist.feedbacks[ack_type].needed |= 1;
+		hist = &infos->context->fb_hist;
+	}
+	else
+	{
+		hist = &decomp->fb_hist;
+	}
+	errors_nr = __builtin_popcount(hist->errors);
+	sent_nr = __builtin_popcount(hist->feedbacks[ack_type].sent);
+	k_too_quickly = errors_nr * 100;
+	k_too_many = sent_nr * 100;
+	if(ack_type == ROHC_FEEDBACK_NACK)
+	{
+		threshold_too_quickly = decomp->ack_rate_limits.nack.threshold;
+		pkts_nr_too_quickly = decomp->ack_rate_limits.nack.pkts_nr;
+	}
+	else
+	{
+		threshold_too_quickly = decomp->ack_rate_limits.static_nack.threshold;
+		pkts_nr_too_quickly = decomp->ack_rate_limits.static_nack.pkts_nr;
+	}
+	if(errors_nr < pkts_nr_too_quickly)
+	{
+		rohc_debug(decomp, ROHC_TRACE_DECOMP, infos->profile_id,
+		           "avoid sending feedback too quickly (%zu of 3200 with threshold %zu)",
+		           k_too_quickly, threshold_too_quickly);
+
+		/* force sending a negative ACK if compressor/decompressor modes mismatch
+		 * or if decompressor just changed its operational mode */
+		if(do_build_ack && infos->do_change_mode)
+		{
+			rohc_debug(decomp, ROHC_TRACE_DECOMP, infos->profile_id,
+			           "force negative ACK because mode changed or compressor "
+			           "reported a different mode");
+			do_build_ack = true;
+		}
+		else
+		{
+			do_build_ack = false;
+		}
+		do_downward_transition = false;
+	}
+	else if(errors_nr >= (pkts_nr_too_quickly + 1) &&
+	        sent_nr >= decomp->ack_rate_limits.speed.pkts_nr)
+	{
+		rohc_debug(decomp, ROHC_TRACE_DECOMP, infos->profile_id,
+		           "rate-limiting successive feedbacks (%zu of 3200 with threshold "
+		           "%zu)", k_too_many, decomp->ack_rate_limits.speed.threshold);
+
+		/* force sending a negative ACK if compressor/decompressor modes mismatch
+		 * or if decompressor just changed its operational mode */
+		if(do_build_ack && infos->do_change_mode)
+		{
+			rohc_debug(decomp, ROHC_TRACE_DECOMP, infos->profile_id,
+			           "force negative ACK because mode changed or compressor "
+			           "reported a different mode");
+			do_build_ack = true;
+		}
+		else
+		{
+			do_build_ack = false;
+		}
+		do_downward_transition = false;
+	}
+
+	/* update informations if feedback is sent or downward transition taken */
+	if(do_build_ack || do_downward_transition)
+	{
+		decomp->fb_hist.feedbacks[ack_type].sent |= 1;
+		if(infos->context != NULL)
+		{
+			infos->context->fb_hist.feedbacks[ack_type].sent |= 1;
+		}
+	}
+
+	/* prepare feedback packet if needed and asked by user */
+	if(!do_build_ack)
+	{
+		rohc_debug(decomp, ROHC_TRACE_DECOMP, infos->profile_id,
+		           "do not send a negative ACK");
+	}
+	else if(feedback == NULL)
+	{
+		rohc_debug(decomp, ROHC_TRACE_DECOMP, infos->profile_id,
+		           "user choose not to use a feedback channel, do not build any "
+		           "feedback packet");
+	}
+	else
+	{
+		rohc_feedback_crc_t crc_present;
+		struct d_feedback sfeedback;
+		uint8_t *feedbackp;
+		size_t feedbacksize;
+		size_t feedback_hdr_len;
+
+		rohc_debug(decomp, ROHC_TRACE_DECOMP, infos->profile_id,
+		           "should send a negative ACK (CID = %zu, NACK type = %d, current "
+		           "mode = %d, target mode = %d, at least %zu bits of SN 0x%x, "
+		           "rate-limiting = %zu of 3200 with threshold %zu and %zu of 3200 "
+		           "with threshold %zu)", infos->cid, ack_type, infos->mode,
+		           decomp->target_mode, infos->sn_bits_nr, infos->sn_bits,
+		           k_too_quickly, threshold_too_quickly,
+		           k_too_many, decomp->ack_rate_limits.speed.threshold);
+
+		/* the negative ACK supersedes the delayed positive ACK of the same
+		 * context if any */
+		rohc_decomp_drop_ack(decomp, infos->cid);
+
+		/* prepare FEEDBACK-2 */
+		if(!f_feedback2(infos->profile_id, ack_type, infos->mode, infos->sn_bits,
+		                infos->sn_bits_nr, &sfeedback))
+		{
+			rohc_warning(decomp, ROHC_TRACE_DECOMP, infos->profile_id,
+			             "failed to build the (STATIC-)NACK feedback");
+			goto error;
+		}
+
+		/* use CRC option if mode change requested */
+		if(rohc_feedback_is_rfc6846(infos->profile_id))
+		{
+			crc_present = ROHC_FEEDBACK_WITH_CRC_BASE;
+		}
+		else if(infos->do_change_mode)
+		{
+			crc_present = ROHC_FEEDBACK_WITH_CRC_OPT;
+		}
+		else
+		{
+			crc_present = ROHC_FEEDBACK_WITH_NO_CRC;
+		}
+
+		/* build the feedback packet */
+		feedbackp = f_wrap_feedback(&sfeedback, infos->cid, infos->cid_type,
+		                            crc_present, &feedbacksize);
+		if(feedbackp == NULL)
+		{
+			rohc_warning(decomp, ROHC_TRACE_DECOMP, infos->profile_id,
+			             "failed to wrap the (STATIC-)NACK feedback");
+			goto error;
+		}
+
+		/* copy the feedback to the buffer provided by the user */
+		/* TODO: build feedback directly into the provided buffer */
+		feedback_hdr_len = 1 + (feedbacksize < 8 ? 0 : 1);
+		if((feedback_hdr_len + feedbacksize) <= rohc_buf_avail_len(*feedback))
+		{
+			if(feedbacksize < 8)
+			{
+				rohc_buf_byte(*feedback) = 0xf0 | feedbacksize;
+			}
+			else
+			{
+				rohc_buf_byte(*feedback) = 0xf0;
+				rohc_buf_byte_at(*feedback, 1) = feedbacksize;
+			}
+			feedback->len += feedback_hdr_len;
+			rohc_buf_append(feedback, feedbackp, feedbacksize);
+		}
+
+		if(feedback->len > 0)
+		{
+			rohc_debug(decomp, ROHC_TRACE_DECOMP, infos->profile_id,
+			           "decompressor built a %zu-byte negative feedback",
+			           feedback->len);
+		}
+
+		/* destroy the temporary feedback buffer */
+		rohc_free(feedbackp);
+
+		/* piggyback the delayed positive ACKs of the other contexts */
+		if(!rohc_decomp_flush_acks(decomp, feedback))
+		{
+			goto error;
+		}
+	}
+
+	/* upon decompression failure, perform downward transitions if context is
+	 * still available (new contexts are destroyed upon decompression error) */
+	if(!do_downward_transition || infos->context == NULL)
+	{
+		rohc_debug(decomp, ROHC_TRACE_DECOMP, infos->profile_id,
+		           "do not perform a downward state transition");
+	}
+	else
+	{
+		rohc_debug(decomp, ROHC_TRACE_DECOMP, infos->profile_id,
+		           "perform a downward state transition now (CID = %zu, NACK "
+		           "type = %d, current mode = %d, target mode = %d, rate-limiting "
+		           "= %zu of 3200 with threshold %zu and %zu of 3200 with "
+		           "threshold %zu)", infos->cid, ack_type, infos->mode,
+		           decomp->target_mode, k_too_quickly, threshold_too_quickly,
+		           k_too_many, decomp->ack_rate_limits.speed.threshold);
+
+		if(infos->state == ROHC_DECOMP_STATE_SC)
+		{
+			rohc_info(decomp, ROHC_TRACE_DECOMP, infos->profile_id,
+			          "change from state %d to state %d because of error(s)",
+			          infos->state, ROHC_DECOMP_STATE_NC);
+			infos->context->state = ROHC_DECOMP_STATE_NC;
+			rohc_decomp_notify_ctxt_event(infos->context,
+			                              ROHC_DECOMP_EVENT_STATE_CHANGE,
+			                              infos->state, infos->context->mode);
+		}
+		else if(infos->state == ROHC_DECOMP_STATE_FC)
+		{
+			rohc_info(decomp, ROHC_TRACE_DECOMP, infos->profile_id,
+			          "change from state %d to state %d because of error(s)",
+			          infos->state, ROHC_DECOMP_STATE_SC);
+			infos->context->state = ROHC_DECOMP_STATE_SC;
+			rohc_decomp_notify_ctxt_event(infos->context,
+			                              ROHC_DECOMP_EVENT_STATE_CHANGE,
+			                              infos->state, infos->context->mode);
+		}
+		else
+		{
+			rohc_debug(decomp, ROHC_TRACE_DECOMP, infos->profile_id,
+			           "stay in state %d because of error(s)", infos->context->state);
+		}
+	}
+
+skip:
+	return true;
+
+error:
+	return false;
+}
+
+
+/**
+ * @brief Update statistics upon successful decompression
+ *
+ * @param context         The decompression context
+ * @param comp_hdr_len    The length (in bytes) of the compressed header
+ * @param uncomp_hdr_len  The length (in bytes) of the uncompressed header
+ */
+static void rohc_decomp_stats_add_success(struct rohc_decomp_ctxt *const context,
+                                          const size_t comp_hdr_len,
+                                          const size_t uncomp_hdr_len)
+{
+	context->header_compressed_size += comp_hdr_len;
+	context->header_uncompressed_size += uncomp_hdr_len;
+}
+
+
+/**
+ * @brief Publish the statistics of a context for \ref rohc_decomp_get_ctxts_stats
+ *
+ * @param decomp   The ROHC decompressor
+ * @param context  The decompression context in use for its CID
+ */
+static void rohc_decomp_publish_ctxt_stats(struct rohc_decomp *const decomp,
+                                           const struct rohc_decomp_ctxt *const context)
+{
+	struct rohc_decomp_ctxt_stats *const stats =
+		rohc_decomp_ctxt_stats_at(decomp, context->cid);
+
+	rohc_seqcount_write_begin(&stats->seq);
+	stats->used = true;
+	stats->profile_id = context->profile->id;
+	stats->mode = context->mode;
+	stats->state = context->state;
+	stats->packet_type = context->packet_type;
+	stats->packets_nr = context->num_recv_packets;
+	stats->comp_bytes_nr = context->total_compressed_size;
+	stats->uncomp_bytes_nr = context->total_uncompressed_size;
+	stats->comp_hdr_bytes_nr = context->header_compressed_size;
+	stats->uncomp_hdr_bytes_nr = context->header_uncompressed_size;
+	stats->corrected_crc_failures = context->corrected_crc_failures;
+	stats->corrected_sn_wraparounds = context->corrected_sn_wraparounds;
+	stats->corrected_wrong_sn_updates = context->corrected_wrong_sn_updates;
+	stats->nr_lost_packets = context->nr_lost_packets;
+	stats->nr_misordered_packets = context->nr_misordered_packets;
+	stats->crc_repair_attempts = context->crc_repair_attempts;
+	stats->crc_repair_skipped = context->crc_repair_skipped;
+	stats->late_pkts_decoded = context->late_pkts_decoded;
+	rohc_seqcount_write_end(&stats->seq);
+}
+
+
+/**
+ * @brief Reset all the statistics of the given ROHC decompressor
+ *
+ * @param decomp The ROHC decompressor
+ */
+static void rohc_decomp_reset_stats(struct rohc_decomp *const decomp)
+{
+	assert(decomp != NULL);
+	decomp->stats.received = 0;
+	decomp->stats.failed_crc = 0;
+	decomp->stats.failed_no_context = 0;
+	decomp->stats.failed_decomp = 0;
+	decomp->stats.total_compressed_size = 0;
+	decomp->stats.total_uncompressed_size = 0;
+	decomp->stats.corrected_crc_failures = 0;
+	decomp->stats.corrected_sn_wraparounds = 0;
+	decomp->stats.corrected_wrong_sn_updates = 0;
+	decomp->stats.crc_repair_attempts = 0;
+	decomp->stats.crc_repair_skipped = 0;
+	decomp->stats.late_pkts_decoded = 0;
+	decomp->stats.rt_attempts_capped = 0;
+#ifdef ROHC_TIMINGS
+	memset(decomp->timings, 0, sizeof(decomp->timings));
+	memset(decomp->timings_profiles, 0, sizeof(decomp->timings_profiles));
+	rohc_decomp_timings_reset(decomp);
+#endif
+}
+
+
+/**
+ * @brief Forget the durations of the phases of the previous packet
+ *
+ * @param decomp  The ROHC decompressor
+ */
+static void rohc_decomp_timings_reset(struct rohc_decomp *const decomp)
+{
+#ifdef ROHC_TIMINGS
+	memset(decomp->timings_pending, 0, sizeof(decomp->timings_pending));
+	decomp->timings_are_pending = false;
+#else
+	(void) decomp;
+#endif
+}
+
+
+/**
+ * @brief Keep the duration of the context lookup until the packet type is known
+ *
+ * @param decomp       The ROHC decompressor
+ * @param lookup_ticks  The duration of the context lookup phase
+ */
+static void rohc_decomp_timings_set_lookup(struct rohc_decomp *const decomp,
+                                           const rohc_ticks_t lookup_ticks)
+{
+#ifdef ROHC_TIMINGS
+	decomp->timings_pending[ROHC_DECOMP_PHASE_LOOKUP] = lookup_ticks;
+#else
+	(void) decomp;
+	(void) lookup_ticks;
+#endif
+}
+
+
+/**
+ * @brief Account some feedback work to the feedback phase of the packet
+ *
+ * @param decomp          The ROHC decompressor
+ * @param feedback_ticks  The duration of the feedback work
+ */
+static void rohc_decomp_timings_add_feedback(struct rohc_decomp *const decomp,
+                                             const rohc_ticks_t feedback_ticks)
+{
+#ifdef ROHC_TIMINGS
+	decomp->timings_pending[ROHC_DECOMP_PHASE_FEEDBACK] += feedback_ticks;
+#else
+	(void) decomp;
+	(void) feedback_ticks;
+#endif
+}
+
+
+/**
+ * @brief Account the time elapsed since the last measure to one phase
+ *
+ * @param[in,out] last         The time of the last measure
+ * @param[in,out] phase_ticks  The duration of the phase to update
+ */
+static void rohc_decomp_timings_step(rohc_ticks_t *const last,
+                                     rohc_ticks_t *const phase_ticks)
+{
+	const rohc_ticks_t now = rohc_ticks_now();
+
+	*phase_ticks += now - (*last);
+	*last = now;
+}
+
+
+/**
+ * @brief Keep the durations of the phases of one decoded packet
+ *
+ * The durations are recorded once the feedback for the packet is built.
+ *
+ * @param decomp       The ROHC decompressor
+ * @param phases_ticks  The durations of the phases, the durations of the
+ *                      context lookup and feedback phases excepted
+ */
+static void rohc_decomp_timings_set_pending(struct rohc_decomp *const decomp,
+                                            const rohc_ticks_t phases_ticks[])
+{
+#ifdef ROHC_TIMINGS
+	int phase;
+
+	for(phase = 0; phase < ROHC_DECOMP_PHASE_MAX; phase++)
+	{
+		if(phase != ROHC_DECOMP_PHASE_LOOKUP &&
+		   phase != ROHC_DECOMP_PHASE_FEEDBACK)
+		{
+			decomp->timings_pending[phase] = phases_ticks[phase];
+		}
+	}
+	decomp->timings_are_pending = true;
+#else
+	(void) decomp;
+	(void) phases_ticks;
+#endif
+}
+
+
+/**
+ * @brief Record the durations of the phases of one decompressed packet
+ *
+ * The durations are recorded twice: once for the type of the ROHC packet,
+ * once for the profile of the context.
+ *
+ * @param decomp       The ROHC decompressor
+ * @param packet_type  The type of the ROHC packet
+ * @param profile      The profile of the decompression context
+ */
+static void rohc_decomp_timings_record(struct rohc_decomp *const decomp,
+                                       const rohc_packet_t packet_type,
+                                       const rohc_profile_t profile)
+{
+#ifdef ROHC_TIMINGS
+	rohc_timings_histo_t *const type_histos = decomp->timings[packet_type];
+	rohc_timings_histo_t *const profile_histos =
+		decomp->timings_profiles[rohc_decomp_profile_idx(profile)];
+	int phase;
+
+	if(!decomp->timings_are_pending)
+	{
+		return;
+	}
+	assert(packet_type < ROHC_PACKET_MAX);
+	assert(rohc_decomp_profile_idx(profile) < D_NUM_PROFILES);
+	for(phase = 0; phase < ROHC_DECOMP_PHASE_MAX; phase++)
+	{
+		const rohc_ticks_t ticks = decomp->timings_pending[phase];
+
+		rohc_timings_histo_add(&type_histos[phase], ticks);
+		rohc_timings_histo_add(&profile_histos[phase], ticks);
+	}
+	decomp->timings_are_pending = false;
+#else
+	(void) decomp;
+	(void) packet_type;
+	(void) profile;
+#endif
+}
+
+
+/**
+ * @brief Give a description for the given ROHC decompression context state
+ *
+ * Give a description for the given ROHC decompression context state.
+ *
+ * The descriptions are not part of the API. They may change between
+ * releases without any warning. Do NOT use them for other means that
+ * providing to users a textual description of decompression context states
+ * used by the library. If unsure, ask on the mailing list.
+ *
+ * @param state  The decompression context state to get a description for
+ * @return       A string that describes the given decompression context state
+ *
+ * @ingroup rohc_decomp
+ */
+const char * rohc_decomp_get_state_descr(const rohc_decomp_state_t state)
+{
+	switch(state)
+	{
+		case ROHC_DECOMP_STATE_NC:
+			return "No Context";
+		case ROHC_DECOMP_STATE_SC:
+			return "Static Context";
+		case ROHC_DECOMP_STATE_FC:
+			return "Full Context";
+		case ROHC_DECOMP_STATE_UNKNOWN:
+		default:
+			return "no description";
+	}
+}
+
+
+/**
+ * @brief Get some information about the last decompressed packet
+ *
+ * Get some information about the last decompressed packet.
+ *
+ * To use the function, call it with a pointer on a pre-allocated
+ * \ref rohc_decomp_last_packet_info_t structure with the \e version_major
+ * and \e version_minor fields set to one of the following supported
+ * versions:
+ *  - Major 0, minor 0
+ *  - Major 0, minor 1
+ *
+ * See \ref rohc_decomp_last_packet_info_t for details about fields that
+ * are supported in the above versions.
+ *
+ * @param decomp       The ROHC decompressor to get information from
+ * @param[in,out] info  The structure where information will be stored
+ * @return              true in case of success, false otherwise
+ *
+ * @ingroup rohc_decomp
+ *
+ * @see rohc_decomp_last_packet_info_t
+ */
+bool rohc_decomp_get_last_packet_info(const struct rohc_decomp *const decomp,
+                                      rohc_decomp_last_packet_info_t *const info)
+{
+	if(decomp == NULL)
+	{
+		goto error;
+	}
+
+	if(decomp->last_context == NULL)
+	{
+		rohc_error(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+		           "last context found in decompressor is not valid");
+		goto error;
+	}
+
+	if(info == NULL)
+	{
+		rohc_error(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+		           "structure for last packet information is not valid");
+		goto error;
+	}
+
+	/* check compatibility version */
+	if(info->version_major == 0)
+	{
+		/* base fields for major version 0 */
+		info->context_mode = decomp->last_context->mode;
+		info->context_state = decomp->last_context->state;
+		info->profile_id = decomp->last_context->profile->id;
+		info->nr_lost_packets = decomp->last_context->nr_lost_packets;
+		info->nr_misordered_packets = decomp->last_context->nr_misordered_packets;
+		info->is_duplicated = decomp->last_context->is_duplicated;
+
+		/* new fields added by minor versions */
+		switch(info->version_minor)
+		{
+			case 0:
+				/* nothing to add */
+				break;
+			case 1:
+				/* new fields in 0.1 */
+				info->corrected_crc_failures =
+					decomp->last_context->corrected_crc_failures;
+				info->corrected_sn_wraparounds =
+					decomp->last_context->corrected_sn_wraparounds;
+				info->corrected_wrong_sn_updates =
+					decomp->last_context->corrected_wrong_sn_updates;
+				info->packet_type = decomp->last_context->packet_type;
+				break;
+			default:
+				rohc_error(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+				           "unsupported minor version (%u) of the structure for "
+				           "last packet information", info->version_minor);
+				goto error;
+		}
+	}
+	else
+	{
+		rohc_error(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+		           "unsupported major version (%u) of the structure for last "
+		           "packet information", info->version_major);
+		goto error;
+	}
+
+	return true;
+
+error:
+	return false;
+}
+
+
+/**
+ * @brief Get the histogram of the durations of one decompression phase
+ *
+ * Get the histogram of the durations of one phase of the decompression of
+ * the packets of the given type. The durations are measured only if the
+ * library was built with the --enable-rohc-timings configure option and if
+ * the feature \ref ROHC_DECOMP_FEATURE_TIMINGS is enabled.
+ *
+ * @param decomp       The ROHC decompressor to get timings from
+ * @param packet_type  The type of ROHC packets to get timings for
+ * @param phase        The decompression phase to get timings for
+ * @param[out] histo   The histogram of the durations
+ * @return             true if the histogram was copied,
+ *                     false if the library was built without timings (the
+ *                     histogram is then emptied) or if an error occurs
+ *
+ * @ingroup rohc_decomp
+ *
+ * @see rohc_decomp_set_features
+ */
+bool rohc_decomp_get_timings(const struct rohc_decomp *const decomp,
+                             const rohc_packet_t packet_type,
+                             const rohc_decomp_phase_t phase,
+                             rohc_timings_histo_t *const histo)
+{
+	if(decomp == NULL)
+	{
+		goto error;
+	}
+	if(packet_type >= ROHC_PACKET_MAX || phase >= ROHC_DECOMP_PHASE_MAX)
+	{
+		rohc_warning(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+		             "packet type %d or decompression phase %d is not valid",
+		             packet_type, phase);
+		goto error;
+	}
+	if(histo == NULL)
+	{
+		rohc_warning(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+		             "given histogram is NULL");
+		goto error;
+	}
+
+#ifdef ROHC_TIMINGS
+	*histo = decomp->timings[packet_type][phase];
+	return true;
+#else
+	/* no duration was measured */
+	memset(histo, 0, sizeof(rohc_timings_histo_t));
+	rohc_warning(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+	             "library was built without support for timings");
+#endif
 
-			rohc_decomp_warn(context, "CID %zu: failed to build uncompressed "
-			                 "headers (CRC failure)", context->cid);
+error:
+	return false;
+}
 
-			/* attempt a context/packet repair */
-			try_decoding_again =
-				profile->attempt_repair(decomp, context, rohc_packet.time,
-				                        &context->crc_corr, extr_bits);
 
-			/* report CRC failure if attempt is not possible */
-			if(!try_decoding_again)
-			{
-				/* uncompressed headers successfully built, CRC is incorrect, repair
-				 * was disabled or attempted without any success, so give up */
-				rohc_decomp_warn(context, "CID %zu: failed to build uncompressed "
-				                 "headers (CRC failure)", context->cid);
-				if((decomp->features & ROHC_DECOMP_FEATURE_DUMP_PACKETS) != 0)
-				{
-					rohc_dump_packet(decomp->trace_callback, decomp->trace_callback_priv,
-					                 ROHC_TRACE_DECOMP, ROHC_TRACE_WARNING,
-					                 "compressed headers", rohc_packet);
-				}
-				goto error_crc;
-			}
+/**
+ * @brief Get the histogram of the durations of one decompression phase per
+ *        profile
+ *
+ * Get the histogram of the durations of one phase of the decompression of
+ * the packets decompressed by the contexts of the given profile. The
+ * durations are measured only if the library was built with the
+ * --enable-rohc-timings configure option and if the feature
+ * \ref ROHC_DECOMP_FEATURE_TIMINGS is enabled.
+ *
+ * @param decomp      The ROHC decompressor to get timings from
+ * @param profile     The profile to get timings for
+ * @param phase       The decompression phase to get timings for
+ * @param[out] histo  The histogram of the durations
+ * @return            true if the histogram was copied,
+ *                    false if the library was built without timings (the
+ *                    histogram is then emptied) or if an error occurs
+ *
+ * @ingroup rohc_decomp
+ *
+ * @see rohc_decomp_set_features
+ */
+bool rohc_decomp_get_profile_timings(const struct rohc_decomp *const decomp,
+                                     const rohc_profile_t profile,
+                                     const rohc_decomp_phase_t phase,
+                                     rohc_timings_histo_t *const histo)
+{
+	if(decomp == NULL)
+	{
+		goto error;
+	}
+	if(profile >= ROHC_PROFILE_MAX || phase >= ROHC_DECOMP_PHASE_MAX)
+	{
+		rohc_warning(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+		             "profile 0x%04x or decompression phase %d is not valid",
+		             profile, phase);
+		goto error;
+	}
+	if(histo == NULL)
+	{
+		rohc_warning(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+		             "given histogram is NULL");
+		goto error;
+	}
+
+#ifdef ROHC_TIMINGS
+	{
+		/* the profiles the library does not implement never measure anything */
+		const size_t i = rohc_decomp_profile_idx(profile);
+
+		if(i >= D_NUM_PROFILES)
+		{
+			memset(histo, 0, sizeof(rohc_timings_histo_t));
+		}
+		else
+		{
+			*histo = decomp->timings_profiles[i][phase];
 		}
 	}
-	while(try_decoding_again);
+	return true;
+#else
+	/* no duration was measured */
+	memset(histo, 0, sizeof(rohc_timings_histo_t));
+	rohc_warning(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+	             "library was built without support for timings");
+#endif
 
-	/* after CRC failure, if the SN value seems to be correctly guessed, we must
-	 * wait for 3 CRC-valid packets before the correction is approved. Two
-	 * packets are therefore thrown away. */
-	if(context->crc_corr.algo != ROHC_DECOMP_CRC_CORR_SN_NONE)
+error:
+	return false;
+}
+
+
+/**
+ * @brief Get the last records of the log of the decompressed packets
+ *
+ * Copy the newest records of the log into the given array, oldest first.
+ * At most \e records_max records are copied, and no record is copied if the
+ * log is disabled.
+ *
+ * The function shall not be called while another thread decompresses
+ * packets with the decompressor.
+ *
+ * @param decomp           The ROHC decompressor
+ * @param[out] records     The array where to copy the records
+ * @param records_max      The max number of records in the array
+ * @param[out] records_nr  The number of records copied in the array
+ * @return                 true if the records were copied,
+ *                         false if an error occurs
+ *
+ * @ingroup rohc_decomp
+ *
+ * @see rohc_decomp_set_pkt_log
+ */
+bool rohc_decomp_get_pkt_log(const struct rohc_decomp *const decomp,
+                             rohc_pkt_log_record_t *const records,
+                             const size_t records_max,
+                             size_t *const records_nr)
+{
+	if(decomp == NULL || records == NULL || records_nr == NULL)
 	{
-		if(context->crc_corr.counter > 1)
+		goto error;
+	}
+
+	rohc_pkt_log_copy(&decomp->pkt_log, records, records_max, records_nr);
+
+	return true;
+
+error:
+	return false;
+}
+
+
+/**
+ * @brief Get the statistics of all the decompression contexts in use
+ *
+ * Copy the statistics of all the decompression contexts in use into the
+ * given array, in the order of their Context IDs (CID). The statistics of a
+ * context are those after the last packet it received.
+ *
+ * The function does not take any lock and does not emit any trace, so it may
+ * be called by one monitoring thread while another thread decompresses
+ * packets with the decompressor: the statistics of every context are
+ * consistent, but the contexts are not all copied at the same instant. The
+ * decompressor shall not be destroyed during the call.
+ *
+ * @param decomp         The ROHC decompressor to get statistics from
+ * @param[out] stats     The array where to store the statistics
+ * @param stats_max      The max number of entries in the array
+ * @param[out] stats_nr  The number of entries written in the array
+ * @return               true if the statistics of all the contexts in use
+ *                       were copied,
+ *                       false if the array is too small or if an error occurs
+ *
+ * @ingroup rohc_decomp
+ *
+ * @see rohc_decomp_ctxt_stats_t
+ */
+bool rohc_decomp_get_ctxts_stats(const struct rohc_decomp *const decomp,
+                                 rohc_decomp_ctxt_stats_t *const stats,
+                                 const size_t stats_max,
+                                 size_t *const stats_nr)
+{
+	rohc_cid_t cid;
+
+	if(decomp == NULL || stats == NULL || stats_nr == NULL)
+	{
+		goto error;
+	}
+	*stats_nr = 0;
+
+	/* the contexts destroyed meanwhile are skipped below */
+	for(cid = rohc_decomp_next_used_cid(decomp, 0);
+	    cid <= decomp->medium.max_cid;
+	    cid = rohc_decomp_next_used_cid(decomp, cid + 1))
+	{
+		/* the chunk of the context is published before the context is used */
+		const struct rohc_decomp_ctxts_chunk *const chunk =
+			__atomic_load_n(&decomp->ctxts_chunks[cid / ROHC_DECOMP_CTXTS_CHUNK_LEN],
+			                __ATOMIC_ACQUIRE);
+		const struct rohc_decomp_ctxt_stats *ctxt_stats;
+		rohc_decomp_ctxt_stats_t copy;
+		rohc_seqcount_t seq;
+		bool used;
+
+		if(chunk == NULL)
 		{
-			/* update context with decoded values even if we drop the packet */
-			rohc_decomp_update_context(context, decoded_values, payload_len,
-			                           rohc_packet.time, do_change_mode);
+			continue;
+		}
+		ctxt_stats = &chunk->stats[cid % ROHC_DECOMP_CTXTS_CHUNK_LEN];
 
-			context->crc_corr.counter--;
-			rohc_decomp_warn(context, "CID %zu: CRC repair: throw away packet, "
-			                 "still %zu CRC-valid packets required",
-			                 context->cid, context->crc_corr.counter);
+		do
+		{
+			seq = rohc_seqcount_read_begin(&ctxt_stats->seq);
+			used = ctxt_stats->used;
+			copy.cid = cid;
+			copy.profile_id = ctxt_stats->profile_id;
+			copy.mode = ctxt_stats->mode;
+			copy.state = ctxt_stats->state;
+			copy.packet_type = ctxt_stats->packet_type;
+			copy.packets_nr = ctxt_stats->packets_nr;
+			copy.comp_bytes_nr = ctxt_stats->comp_bytes_nr;
+			copy.uncomp_bytes_nr = ctxt_stats->uncomp_bytes_nr;
+			copy.comp_hdr_bytes_nr = ctxt_stats->comp_hdr_bytes_nr;
+			copy.uncomp_hdr_bytes_nr = ctxt_stats->uncomp_hdr_bytes_nr;
+			copy.corrected_crc_failures = ctxt_stats->corrected_crc_failures;
+			copy.corrected_sn_wraparounds = ctxt_stats->corrected_sn_wraparounds;
+			copy.corrected_wrong_sn_updates =
+				ctxt_stats->corrected_wrong_sn_updates;
+			copy.nr_lost_packets = ctxt_stats->nr_lost_packets;
+			copy.nr_misordered_packets = ctxt_stats->nr_misordered_packets;
+			copy.crc_repair_attempts = ctxt_stats->crc_repair_attempts;
+			copy.crc_repair_skipped = ctxt_stats->crc_repair_skipped;
+			copy.late_pkts_decoded = ctxt_stats->late_pkts_decoded;
+		}
+		while(rohc_seqcount_read_retry(&ctxt_stats->seq, seq));
 
-			goto error_crc;
+		if(!used)
+		{
+			continue;
 		}
-		else if(context->crc_corr.counter == 1)
+		if((*stats_nr) >= stats_max)
 		{
-			rohc_decomp_warn(context, "CID %zu: CRC repair: correction is "
-			                 "successful, keep packet", context->cid);
-			context->corrected_crc_failures++;
-			decomp->stats.corrected_crc_failures++;
-			switch(context->crc_corr.algo)
-			{
-				case ROHC_DECOMP_CRC_CORR_SN_WRAP:
-					context->corrected_sn_wraparounds++;
-					decomp->stats.corrected_sn_wraparounds++;
-					break;
-				case ROHC_DECOMP_CRC_CORR_SN_UPDATES:
-					context->corrected_wrong_sn_updates++;
-					decomp->stats.corrected_wrong_sn_updates++;
-					break;
-				case ROHC_DECOMP_CRC_CORR_SN_NONE:
-				default:
-					rohc_error(decomp, ROHC_TRACE_DECOMP, context->profile->id,
-					           "CID %zu: CRC repair: unsupported repair algorithm %d",
-					           context->cid, context->crc_corr.algo);
-					assert(0);
-					goto error;
-			}
-			context->crc_corr.algo = ROHC_DECOMP_CRC_CORR_SN_NONE;
-			context->crc_corr.counter--;
+			goto error;
 		}
+		stats[*stats_nr] = copy;
+		(*stats_nr)++;
 	}
 
+	return true;
+
+error:
+	return false;
+}
 
-	/* E. Copy the payload (if any) */
 
-	if((rohc_hdr_len + payload_len) != rohc_packet.len)
+/**
+ * @brief Get some information about the given decompression context
+ *
+ * Get some information about the given decompression context.
+ *
+ * To use the function, call it with a pointer on a pre-allocated
+ * \ref rohc_decomp_context_info_t structure with the \e version_major
+ * and \e version_minor fields set to one of the following supported
+ * versions:
+ *  - Major 0, minor 0
+ *  - Major 0, minor 1
+ *
+ * See \ref rohc_decomp_context_info_t for details about fields that
+ * are supported in the above versions.
+ *
+ * @param decomp       The ROHC decompressor to get information from
+ * @param cid           The Context ID to get information for
+ * @param[in,out] info  The structure where information will be stored
+ * @return              true in case of success, false otherwise
+ *
+ * @ingroup rohc_decomp
+ *
+ * @see rohc_decomp_context_info_t
+ */
+bool rohc_decomp_get_context_info(const struct rohc_decomp *const decomp,
+                                  const rohc_cid_t cid,
+                                  rohc_decomp_context_info_t *const info)
+{
+	if(decomp == NULL)
 	{
-		rohc_decomp_warn(context, "ROHC %s header (%zu bytes) and payload "
-		                 "(%zu bytes) do not match the full ROHC packet "
-		                 "(%zu bytes)", rohc_get_packet_descr(*packet_type),
-		                 rohc_hdr_len, payload_len, rohc_packet.len);
 		goto error;
 	}
-	if(rohc_buf_avail_len(*uncomp_packet) < payload_len)
+
+	if(cid > decomp->medium.max_cid)
 	{
-		rohc_decomp_warn(context, "uncompressed packet too small (%zu bytes "
-		                 "max) for the %zu-byte payload",
-		                 rohc_buf_avail_len(*uncomp_packet), payload_len);
-		goto error_output_too_small;
+		rohc_error(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+		           "decompressor does not handle CID %zu since MAX_CID is %zu",
+		           cid, decomp->medium.max_cid);
+		goto error;
 	}
-	if(payload_len != 0)
+
+	if(info == NULL)
 	{
-		rohc_buf_append(uncomp_packet, payload_data, payload_len);
-		rohc_buf_pull(uncomp_packet, payload_len);
+		rohc_error(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+		           "structure for context information is not valid");
+		goto error;
 	}
-	/* unhide the uncompressed headers and payload */
-	rohc_buf_push(uncomp_packet, uncomp_hdr_len + payload_len);
-	rohc_decomp_debug(context, "uncompressed packet length = %zu bytes",
-	                  uncomp_packet->len);
-
 
-	/* F. Update the compression context
-	 *
-	 * Once CRC check is done, update the compression context with the values
-	 * that were decoded earlier.
-	 *
-	 * TODO: check what fields shall be updated in the context
-	 */
+	/* check compatibility version */
+	if(info->version_major == 0)
+	{
+		/* base fields for major version 0 */
+		if(decomp->contexts[cid] == NULL)
+		{
+			info->packets_nr = 0;
+			info->comp_bytes_nr = 0;
+			info->uncomp_bytes_nr = 0;
+			info->corrected_crc_failures = 0;
+			info->corrected_sn_wraparounds = 0;
+			info->corrected_wrong_sn_updates = 0;
+		}
+		else
+		{
+			info->packets_nr = decomp->contexts[cid]->num_recv_packets;
+			info->comp_bytes_nr = decomp->contexts[cid]->total_compressed_size;
+			info->uncomp_bytes_nr = decomp->contexts[cid]->total_uncompressed_size;
+			info->corrected_crc_failures =
+				decomp->contexts[cid]->corrected_crc_failures;
+			info->corrected_sn_wraparounds =
+				decomp->contexts[cid]->corrected_sn_wraparounds;
+			info->corrected_wrong_sn_updates =
+				decomp->contexts[cid]->corrected_wrong_sn_updates;
+		}
 
-	/* we are either already in full context state or we can transit
-	 * through it */
-	if(context->state != ROHC_DECOMP_STATE_FC)
+		/* new fields added by minor versions */
+		switch(info->version_minor)
+		{
+			case 0:
+				/* nothing to add */
+				break;
+			case 1:
+				/* new fields in 0.1 */
+				if(decomp->contexts[cid] == NULL)
+				{
+					info->packets_nr64 = 0;
+					info->comp_bytes_nr64 = 0;
+					info->uncomp_bytes_nr64 = 0;
+				}
+				else
+				{
+					info->packets_nr64 = decomp->contexts[cid]->num_recv_packets;
+					info->comp_bytes_nr64 =
+						decomp->contexts[cid]->total_compressed_size;
+					info->uncomp_bytes_nr64 =
+						decomp->contexts[cid]->total_uncompressed_size;
+				}
+				break;
+			default:
+				rohc_error(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+				           "unsupported minor version (%u) of the structure for "
+				           "context information", info->version_minor);
+				goto error;
+		}
+	}
+	else
 	{
-		rohc_decomp_debug(context, "change from state %d to state %d",
-		                  context->state, ROHC_DECOMP_STATE_FC);
-		context->state = ROHC_DECOMP_STATE_FC;
+		rohc_error(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+		           "unsupported major version (%u) of the structure for context"
+		           "information", info->version_major);
+		goto error;
 	}
 
-	/* update context with decoded values */
-	rohc_decomp_update_context(context, decoded_values, payload_len,
-	                           rohc_packet.time, do_change_mode);
-
-	/* update statistics */
-	rohc_decomp_stats_add_success(context, rohc_hdr_len, uncomp_hdr_len);
-
-	/* decompression is successful */
-	return ROHC_STATUS_OK;
+	return true;
 
 error:
-	return ROHC_STATUS_ERROR;
-error_output_too_small:
-	return ROHC_STATUS_OUTPUT_TOO_SMALL;
-error_crc:
-	return ROHC_STATUS_BAD_CRC;
-error_malformed:
-	return ROHC_STATUS_MALFORMED;
+	return false;
 }
 
 
 /**
- * @brief Check whether the CRC on IR or IR-DYN header is correct or not
+ * @brief Get some general information about the decompressor
  *
- * The CRC for IR/IR-DYN headers is always CRC-8. It is computed on the
- * whole compressed header (payload excluded, but any CID bits included).
+ * Get some general information about the decompressor.
  *
- * @param decomp          The ROHC decompressor
- * @param context         The decompression context
- * @param rohc_hdr        The compressed IR or IR-DYN header
- * @param rohc_hdr_len    The length (in bytes) of the compressed header
- * @param add_cid_len     The length of the optional Add-CID field
- * @param large_cid_len   The length of the optional large CID field
- * @param crc_packet      The CRC extracted from the ROHC header
- * @return                true if the CRC is correct, false otherwise
+ * To use the function, call it with a pointer on a pre-allocated
+ * \ref rohc_decomp_general_info_t structure with the \e version_major and
+ * \e version_minor fields set to one of the following supported versions:
+ *  - Major 0, minor 0
+ *  - Major 0, minor 1
+ *  - Major 0, minor 2
+ *  - Major 0, minor 3
+ *  - Major 0, minor 4
+ *
+ * See the \ref rohc_decomp_general_info_t structure for details about fields
+ * that are supported in the above versions.
+ *
+ * @param decomp       The ROHC decompressor to get information from
+ * @param[in,out] info  The structure where information will be stored
+ * @return              true in case of success, false otherwise
+ *
+ * @ingroup rohc_decomp
+ *
+ * @see rohc_decomp_general_info_t
  */
-static bool rohc_decomp_check_ir_crc(const struct rohc_decomp *const decomp,
-                                     const struct rohc_decomp_ctxt *const context,
-                                     const uint8_t *const rohc_hdr,
-                                     const size_t rohc_hdr_len,
-                                     const size_t add_cid_len,
-                                     const size_t large_cid_len,
-                                     const uint8_t crc_packet)
+bool rohc_decomp_get_general_info(const struct rohc_decomp *const decomp,
+                                  rohc_decomp_general_info_t *const info)
 {
-	const size_t rohc_hdr_full_len = add_cid_len + large_cid_len + rohc_hdr_len;
-	const uint8_t *crc_table;
-	const rohc_crc_type_t crc_type = ROHC_CRC_TYPE_8;
-	const uint8_t crc_zero[] = { 0x00 };
-	unsigned int crc_comp; /* computed CRC */
-
-	assert(decomp != NULL);
-	assert(rohc_hdr != NULL);
-	assert(rohc_hdr_len >= (add_cid_len + 2 + large_cid_len + 1));
-
-	crc_table = decomp->crc_table_8;
-
-	/* ROHC header before CRC field:
-	 * optional Add-CID + IR type + Profile ID + optional large CID */
-	crc_comp = crc_calculate(crc_type, rohc_hdr,
-	                         add_cid_len + 2 + large_cid_len,
-	                         CRC_INIT_8, crc_table);
-
-	/* all profiles but the Uncompressed profile compute their CRC through the
-	 * zeroed CRC field and the rest of the ROHC header */
-	if(context->profile->id != ROHC_PROFILE_UNCOMPRESSED)
+	if(decomp == NULL)
 	{
-		/* zeroed CRC field */
-		crc_comp = crc_calculate(crc_type, crc_zero, 1, crc_comp, crc_table);
+		goto error;
+	}
 
-		/* ROHC header after CRC field */
-		crc_comp = crc_calculate(crc_type,
-		                         rohc_hdr + add_cid_len + 2 + large_cid_len + 1,
-		                         rohc_hdr_len - add_cid_len - 2 - large_cid_len - 1,
-		                         crc_comp, crc_table);
+	if(info == NULL)
+	{
+		rohc_error(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+		           "structure for general information is not valid");
+		goto error;
 	}
 
-	rohc_decomp_debug(context, "CRC-%d on compressed %zu-byte ROHC header = "
-	                  "0x%x", crc_type, rohc_hdr_full_len, crc_comp);
+	/* check compatibility version */
+	if(info->version_major == 0)
+	{
+		/* base fields for major version 0 */
+		info->contexts_nr = decomp->num_contexts_used;
+		info->packets_nr = decomp->stats.received;
+		info->comp_bytes_nr = decomp->stats.total_compressed_size;
+		info->uncomp_bytes_nr = decomp->stats.total_uncompressed_size;
 
-	/* does the computed CRC match the one in packet? */
-	if(crc_comp != crc_packet)
+		/* new fields added by minor versions */
+		switch(info->version_minor)
+		{
+			case 0:
+				/* nothing to add */
+				break;
+			case 1:
+			case 2:
+			case 3:
+			case 4:
+			case 5:
+				/* new fields in 0.1 */
+				info->corrected_crc_failures = decomp->stats.corrected_crc_failures;
+				info->corrected_sn_wraparounds =
+					decomp->stats.corrected_sn_wraparounds;
+				info->corrected_wrong_sn_updates =
+					decomp->stats.corrected_wrong_sn_updates;
+				if(info->version_minor >= 2)
+				{
+					/* new fields in 0.2 */
+					info->packets_nr64 = decomp->stats.received;
+					info->comp_bytes_nr64 = decomp->stats.total_compressed_size;
+					info->uncomp_bytes_nr64 = decomp->stats.total_uncompressed_size;
+				}
+				if(info->version_minor >= 3)
+				{
+					/* new fields in 0.3 */
+					info->crc_repair_attempts = decomp->stats.crc_repair_attempts;
+					info->crc_repair_skipped = decomp->stats.crc_repair_skipped;
+				}
+				if(info->version_minor >= 4)
+				{
+					/* new fields in 0.4 */
+					info->late_pkts_decoded = decomp->stats.late_pkts_decoded;
+				}
+				if(info->version_minor >= 5)
+				{
+					/* new fields in 0.5 */
+					info->rt_attempts_capped = decomp->stats.rt_attempts_capped;
+				}
+				break;
+			default:
+				rohc_error(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+				           "unsupported minor version (%u) of the structure for "
+				           "general information", info->version_minor);
+				goto error;
+		}
+	}
+	else
 	{
-		rohc_decomp_warn(context, "CRC failure (computed = 0x%02x, packet = "
-		                 "0x%02x)", crc_comp, crc_packet);
+		rohc_error(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+		           "unsupported major version (%u) of the structure for "
+		           "general information", info->version_major);
 		goto error;
 	}
 
-	/* computed CRC matches the one in packet */
 	return true;
 
 error:
@@ -1732,250 +5601,171 @@ error:
 
 
 /**
- * @brief Update context with decoded values
+ * @brief Get the CID type that the decompressor uses
  *
- * @param context              The decompression context
- * @param decoded              The decoded values to update in the context
- * @param payload_len          The length of the packet payload
- * @param pkt_arrival_time     The arrival time of the decoded ROHC packet
- * @param[out] do_change_mode  Whether the context wants to change its
- *                             operational mode or not
- */
-static void rohc_decomp_update_context(struct rohc_decomp_ctxt *const context,
-                                       const void *const decoded,
-                                       const size_t payload_len,
-                                       const struct rohc_ts pkt_arrival_time,
-                                       bool *const do_change_mode)
-{
-	struct rohc_decomp_crc_corr_ctxt *const crc_corr = &context->crc_corr;
-
-	/* call the profile-specific callback */
-	context->profile->update_ctxt(context, decoded, payload_len, do_change_mode);
-
-	/* update arrival time */
-	crc_corr->arrival_times[crc_corr->arrival_times_index] = pkt_arrival_time;
-	crc_corr->arrival_times_index =
-		(crc_corr->arrival_times_index + 1) % ROHC_MAX_ARRIVAL_TIMES;
-	crc_corr->arrival_times_nr =
-		rohc_min(crc_corr->arrival_times_nr + 1, ROHC_MAX_ARRIVAL_TIMES);
-}
-
-
-/**
- * @brief Build a positive ACK feedback
+ * Get the CID type that the decompressor currently uses.
  *
  * @param decomp         The ROHC decompressor
- * @param infos          The information collected on the successfully
- *                       decompressed packet
- * @param[out] feedback  The feedback to be transmitted to the remote
- *                       compressor through the feedback channel
- * @return               true if the ACK feedback was successfully built
- *                       (may be 0 byte), false if a problem occurred
+ * @param[out] cid_type  The current CID type among \ref ROHC_SMALL_CID and
+ *                       \ref ROHC_LARGE_CID
+ * @return               true if the CID type was successfully retrieved,
+ *                       false otherwise
+ *
+ * @ingroup rohc_decomp
  */
-static bool rohc_decomp_feedback_ack(struct rohc_decomp *const decomp,
-                                     const struct rohc_decomp_stream *const infos,
-                                     struct rohc_buf *const feedback)
-{
-	const char mode_short[ROHC_R_MODE + 1] = { '?', 'U', 'O', 'R' };
-	bool do_build_ack = false;
-	size_t k;
-
-	assert(infos->cid_found);
-	assert(infos->context_found);
-
-	rohc_debug(decomp, ROHC_TRACE_DECOMP, infos->profile_id,
-	           "CID %zu: %s: %s state: %s packet successfully decompressed",
-	           infos->cid, rohc_get_mode_descr(infos->mode),
-	           rohc_decomp_get_state_descr(infos->state),
-	           rohc_get_packet_descr(infos->packet_type));
-
-	/* update all the stats about the feedbacks */
-	decomp->last_pkts_errors <<= 1;
-	decomp->last_pkt_feedbacks[ROHC_FEEDBACK_ACK].needed <<= 1;
-	decomp->last_pkt_feedbacks[ROHC_FEEDBACK_ACK].sent <<= 1;
-	decomp->last_pkt_feedbacks[ROHC_FEEDBACK_NACK].needed <<= 1;
-	decomp->last_pkt_feedbacks[ROHC_FEEDBACK_NACK].sent <<= 1;
-	decomp->last_pkt_feedbacks[ROHC_FEEDBACK_STATIC_NACK].needed <<= 1;
-	decomp->last_pkt_feedbacks[ROHC_FEEDBACK_STATIC_NACK].sent <<= 1;
-	infos->context->last_pkts_errors <<= 1;
-	infos->context->last_pkt_feedbacks[ROHC_FEEDBACK_ACK].needed <<= 1;
-	infos->context->last_pkt_feedbacks[ROHC_FEEDBACK_ACK].sent <<= 1;
-	infos->context->last_pkt_feedbacks[ROHC_FEEDBACK_NACK].needed <<= 1;
-	infos->context->last_pkt_feedbacks[ROHC_FEEDBACK_NACK].sent <<= 1;
-	infos->context->last_pkt_feedbacks[ROHC_FEEDBACK_STATIC_NACK].needed <<= 1;
-	infos->context->last_pkt_feedbacks[ROHC_FEEDBACK_STATIC_NACK].sent <<= 1;
-
-	/* force sending an ACK if compressor/decompressor modes mismatch or
-	 * if decompressor just changed its operational mode */
-	if(infos->do_change_mode)
-	{
-		rohc_debug(decomp, ROHC_TRACE_DECOMP, infos->profile_id,
-		           "force positive ACK because mode changed or compressor "
-		           "reported a different mode");
-		do_build_ack = true;
-	}
-	/* check if the decompressor shall build a positive feedback */
-	else if(infos->mode == ROHC_U_MODE)
-	{
-		/* send ACK(U) with rate-limiting as stated in RFC 3095, §5.3.1.3:
-		 *   To improve performance for the Unidirectional mode over a link that
-		 *   does have a feedback channel, the decompressor MAY send an
-		 *   acknowledgment when decompression succeeds.  Setting the mode
-		 *   parameter in the ACK packet to U indicates that the compressor is to
-		 *   stay in Unidirectional mode. [...] If IR packets continue to arrive,
-		 *   the decompressor MAY repeat the ACK(U), but it SHOULD NOT repeat the
-		 *   ACK(U) continuously.*/
-		do_build_ack = true;
-	}
-	else if(infos->mode == ROHC_O_MODE)
-	{
-		/* feedback logic for O-mode is described in RFC 3095, §5.4.2.2 */
-
-		/* all states: when an IR packet is correctly decompressed, send an ACK(O) */
-		if(infos->packet_type == ROHC_PACKET_IR)
-		{
-			do_build_ack = true;
-		}
-		/* SC state:
-		 *  - when a type 2 or an IR-DYN packet is correctly decompressed,
-		 *    optionally send an ACK(O)
-		 * FC state:
-		 *  - when a type 2 or an IR-DYN packet is correctly decompressed,
-		 *    optionally send an ACK(O)
-		 *  - when a type 0 or 1 packet is correctly decompressed, no
-		 *    feedback is sent */
-		else if(infos->state != ROHC_DECOMP_STATE_NC &&
-		        rohc_decomp_packet_carry_crc_7_or_8(infos->packet_type))
-		{
-			do_build_ack = true;
-		}
-	}
-	else /* R-mode */
+bool rohc_decomp_get_cid_type(const struct rohc_decomp *const decomp,
+                              rohc_cid_type_t *const cid_type)
+{
+	if(decomp == NULL || cid_type == NULL)
 	{
-		assert(0); /* TODO: R-mode not implemented yet */
 		goto error;
 	}
 
-	/* stop now if no ACK is required */
-	if(!do_build_ack)
+	*cid_type = decomp->medium.cid_type;
+	return true;
+
+error:
+	return false;
+}
+
+
+/**
+ * @brief Get the maximal CID value the decompressor uses
+ *
+ * Get the maximal CID value the decompressor uses, ie. the \e MAX_CID
+ * parameter defined in RFC 3095.
+ *
+ * @param decomp       The ROHC decompressor
+ * @param[out] max_cid  The current maximal CID value
+ * @return              true if MAX_CID was successfully retrieved,
+ *                      false otherwise
+ *
+ * @ingroup rohc_decomp
+ */
+bool rohc_decomp_get_max_cid(const struct rohc_decomp *const decomp,
+                             size_t *const max_cid)
+{
+	if(decomp == NULL || max_cid == NULL)
 	{
-		rohc_debug(decomp, ROHC_TRACE_DECOMP, infos->profile_id,
-		           "no need to send a positive ACK");
-		goto skip;
+		goto error;
 	}
 
-	/* rate-limit the ACKs */
-	decomp->last_pkt_feedbacks[ROHC_FEEDBACK_ACK].needed |= 1;
-	infos->context->last_pkt_feedbacks[ROHC_FEEDBACK_ACK].needed |= 1;
-	k = __builtin_popcount(infos->context->last_pkt_feedbacks[ROHC_FEEDBACK_ACK].sent) * 100;
-	if(k >= decomp->ack_rate_limits.speed.threshold)
+	*max_cid = decomp->medium.max_cid;
+	return true;
+
+error:
+	return false;
+}
+
+
+/**
+ * @brief Set the Maximum Reconstructed Reception Unit (MRRU).
+ *
+ * Set the Maximum Reconstructed Reception Unit (MRRU).
+ *
+ * The MRRU is the largest cumulative length (in bytes) of the ROHC segments
+ * that are parts of the same ROHC packet. In short, the ROHC decompressor
+ * does not expect to reassemble ROHC segments whose total length is larger
+ * than MRRU. So, the ROHC compressor shall not segment ROHC packets greater
+ * than the MRRU.
+ *
+ * The MRRU value must be in range [0 ; \ref ROHC_MAX_MRRU]. Remember that the
+ * MRRU includes the 32-bit CRC that protects it.
+ * If set to 0, segmentation is disabled as no segment headers are allowed
+ * on the channel. Every received segment will be dropped.
+ *
+ * If segmentation is enabled and used by the compressor, the function
+ * \ref rohc_decompress3 will return ROHC_OK and one empty uncompressed packet
+ * upon decompression until the last segment is received (or a non-segment is
+ * received). Decompressed data will be returned at that time.
+ *
+ * The buffer that stores the RRU is MRRU bytes long. It is allocated when
+ * segmentation is enabled, and freed when segmentation is disabled.
+ *
+ * @warning Changing the MRRU value while library is used may lead to
+ *          destruction of the current RRU.
+ *
+ * @param decomp  The ROHC decompressor
+ * @param mrru    The new MRRU value (in bytes)
+ * @return        true if the MRRU was successfully set, false otherwise
+ *
+ * @ingroup rohc_decomp
+ *
+ * \par Example:
+ * \snippet test_segment.c define ROHC decompressor
+ * \code
+        size_t mrru = 500;
+        ...
+\endcode
+ * \snippet test_segment.c create ROHC decompressor
+ * \code
+        ...
+\endcode
+ * \snippet test_segment.c set decompressor MRRU
+ * \code
+        ...
+\endcode
+ *
+ * @see rohc_decomp_get_mrru
+ * @see rohc_decompress3
+ * @see rohc_comp_set_mrru
+ * @see rohc_comp_get_mrru
+ */
+bool rohc_decomp_set_mrru(struct rohc_decomp *const decomp,
+                          const size_t mrru)
+{
+	/* decompressor must be valid */
+	if(decomp == NULL)
 	{
-		rohc_debug(decomp, ROHC_TRACE_DECOMP, infos->profile_id,
-		           "do not send a positive ACK because of rate-limiting (%zu of 3200 "
-		           "with threshold %zu)", k, decomp->ack_rate_limits.speed.threshold);
-		goto skip;
+		/* cannot print a trace without a valid decompressor */
+		goto error;
 	}
-	rohc_debug(decomp, ROHC_TRACE_DECOMP, infos->profile_id,
-	           "should send a positive ACK now (CID = %zu, current mode = %d, "
-	           "target mode = %d, at least %zu bits of SN 0x%x, rate-limiting = "
-	           "%zu of 3200 with threshold %zu)", infos->cid, infos->mode,
-	           decomp->target_mode, infos->sn_bits_nr, infos->sn_bits,
-	           k, decomp->ack_rate_limits.speed.threshold);
-	decomp->last_pkt_feedbacks[ROHC_FEEDBACK_ACK].sent |= 1;
-	infos->context->last_pkt_feedbacks[ROHC_FEEDBACK_ACK].sent |= 1;
 
-	/* prepare feedback packet if asked by user */
-	if(feedback == NULL)
+	/* new MRRU value must be in range [0, ROHC_MAX_MRRU] */
+	if(mrru > ROHC_MAX_MRRU)
 	{
-		rohc_debug(decomp, ROHC_TRACE_DECOMP, infos->profile_id,
-		           "user choose not to use a feedback channel, do not build any "
-		           "feedback packet");
+		rohc_warning(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+		             "unexpected MRRU value: must be in range [0, %d]",
+		             ROHC_MAX_MRRU);
+		goto error;
 	}
-	else
+
+	/* resize the RRU buffer, keep the segments already received if they fit
+	 * in the new MRRU */
+	if(mrru != decomp->mrru)
 	{
-		rohc_feedback_crc_t crc_present;
-		struct d_feedback sfeedback;
-		uint8_t *feedbackp;
-		size_t feedbacksize;
-		size_t feedback_hdr_len;
+		uint8_t *new_rru = NULL;
 
-		/* FEEDBACK-1 or FEEDBACK-2 ? */
-		if(infos->profile_id == ROHC_PROFILE_UNCOMPRESSED ||
-		   (!infos->do_change_mode && infos->sn_bits_nr != 0 && infos->sn_bits_nr <= 8))
-		{
-			rohc_debug(decomp, ROHC_TRACE_DECOMP, infos->profile_id,
-			           "use FEEDBACK-1 as positive feedback");
-			f_feedback1(infos->sn_bits, &sfeedback);
-			crc_present = ROHC_FEEDBACK_WITH_NO_CRC;
-		}
-		else
+		if(mrru > 0)
 		{
-			rohc_debug(decomp, ROHC_TRACE_DECOMP, infos->profile_id,
-			           "use FEEDBACK-2 as positive ACK(%c) feedback",
-			           mode_short[infos->mode]);
-			if(!f_feedback2(infos->profile_id, ROHC_FEEDBACK_ACK, infos->mode,
-			                infos->sn_bits, infos->sn_bits_nr, &sfeedback))
+			new_rru = rohc_numa_alloc(mrru, decomp->numa_node);
+			if(new_rru == NULL)
 			{
-				rohc_warning(decomp, ROHC_TRACE_DECOMP, infos->profile_id,
-				             "failed to build the ACK feedback");
+				rohc_error(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+				           "no memory for the %zu-byte RRU", mrru);
 				goto error;
 			}
-
-			/* use CRC option if mode change requested */
-			if(infos->profile_id == ROHC_PROFILE_TCP)
-			{
-				crc_present = ROHC_FEEDBACK_WITH_CRC_BASE;
-			}
-			else if(infos->do_change_mode)
-			{
-				crc_present = ROHC_FEEDBACK_WITH_CRC_OPT;
-			}
-			else
-			{
-				crc_present = ROHC_FEEDBACK_WITH_NO_CRC;
-			}
 		}
-
-		/* build the feedback packet */
-		feedbackp = f_wrap_feedback(&sfeedback, infos->cid, infos->cid_type,
-		                            crc_present, decomp->crc_table_8, &feedbacksize);
-		if(feedbackp == NULL)
-		{
-			rohc_warning(decomp, ROHC_TRACE_DECOMP, infos->profile_id,
-			             "failed to wrap the ACK feedback");
-			goto error;
-		}
-
-		/* copy the feedback to the buffer provided by the user */
-		/* TODO: build feedback directly into the provided buffer */
-		feedback_hdr_len = 1 + (feedbacksize < 8 ? 0 : 1);
-		if((feedback_hdr_len + feedbacksize) <= rohc_buf_avail_len(*feedback))
+		if(decomp->rru_len > mrru)
 		{
-			if(feedbacksize < 8)
-			{
-				rohc_buf_byte(*feedback) = 0xf0 | feedbacksize;
-			}
-			else
-			{
-				rohc_buf_byte(*feedback) = 0xf0;
-				rohc_buf_byte_at(*feedback, 1) = feedbacksize;
-			}
-			feedback->len += feedback_hdr_len;
-			rohc_buf_append(feedback, feedbackp, feedbacksize);
+			rohc_warning(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+			             "discard the %zu-byte RRU that does not fit in the new "
+			             "%zu-byte MRRU", decomp->rru_len, mrru);
+			decomp->rru_len = 0;
 		}
-
-		if(feedback->len > 0)
+		else if(decomp->rru_len > 0)
 		{
-			rohc_debug(decomp, ROHC_TRACE_DECOMP, infos->profile_id,
-			           "decompressor built a %zu-byte positive feedback",
-			           feedback->len);
+			memcpy(new_rru, decomp->rru, decomp->rru_len);
 		}
-
-		/* destroy the temporary feedback buffer */
-		free(feedbackp);
+		rohc_numa_free(decomp->rru, decomp->mrru, decomp->numa_node);
+		decomp->rru = new_rru;
 	}
 
-skip:
+	/* set new MRRU */
+	decomp->mrru = mrru;
+	rohc_debug(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+	           "MRRU is now set to %zd", decomp->mrru);
+
 	return true;
 
 error:
@@ -1984,366 +5774,481 @@ error:
 
 
 /**
- * @brief Build a negative ACK feedback
+ * @brief Get the Maximum Reconstructed Reception Unit (MRRU).
  *
- * There are two types of negative feedback: NACK and STATIC-NACK.
+ * Get the current Maximum Reconstructed Reception Unit (MRRU).
  *
- * @param decomp         The ROHC decompressor
- * @param infos          The information collected on the failed
- *                       decompressed packet
- * @param[out] feedback  The feedback to be transmitted to the remote
- *                       compressor through the feedback channel (may be NULL)
- * @return               true if the ACK feedback was successfully built
- *                       (may be 0 byte), false if a problem occurred
+ * The MRRU is the largest cumulative length (in bytes) of the ROHC segments
+ * that are parts of the same ROHC packet. In short, the ROHC decompressor
+ * does not expect to reassemble ROHC segments whose total length is larger
+ * than MRRU. So, the ROHC compressor shall not segment ROHC packets greater
+ * than the MRRU.
+ *
+ * The MRRU value must be in range [0 ; \ref ROHC_MAX_MRRU]. Remember that the
+ * MRRU includes the 32-bit CRC that protects it.
+ * If MRRU value is 0, segmentation is disabled.
+ *
+ * If segmentation is enabled and used by the compressor, the function
+ * \ref rohc_decompress3 will return ROHC_OK and one empty uncompressed packet
+ * upon decompression until the last segment is received (or a non-segment is
+ * received). Decompressed data will be returned at that time.
+ *
+ * @param decomp     The ROHC decompressor
+ * @param[out] mrru  The current MRRU value (in bytes)
+ * @return           true if MRRU was successfully retrieved, false otherwise
+ *
+ * @ingroup rohc_decomp
+ *
+ * @see rohc_decomp_set_mrru
+ * @see rohc_decompress3
+ * @see rohc_comp_set_mrru
+ * @see rohc_comp_get_mrru
  */
-static bool rohc_decomp_feedback_nack(struct rohc_decomp *const decomp,
-                                      const struct rohc_decomp_stream *const infos,
-                                      struct rohc_buf *const feedback)
+bool rohc_decomp_get_mrru(const struct rohc_decomp *const decomp,
+                          size_t *const mrru)
 {
-	bool do_downward_transition = false;
-	bool do_build_ack = false;
-	enum rohc_feedback_ack_type ack_type;
-	size_t threshold_too_quickly;
-	size_t k_too_quickly;
-	size_t k_too_many;
-
-	/* update all the stats about the feedbacks */
-	decomp->last_pkts_errors <<= 1;
-	decomp->last_pkts_errors |= 1;
-	decomp->last_pkt_feedbacks[ROHC_FEEDBACK_ACK].needed <<= 1;
-	decomp->last_pkt_feedbacks[ROHC_FEEDBACK_ACK].sent <<= 1;
-	decomp->last_pkt_feedbacks[ROHC_FEEDBACK_NACK].needed <<= 1;
-	decomp->last_pkt_feedbacks[ROHC_FEEDBACK_NACK].sent <<= 1;
-	decomp->last_pkt_feedbacks[ROHC_FEEDBACK_STATIC_NACK].needed <<= 1;
-	decomp->last_pkt_feedbacks[ROHC_FEEDBACK_STATIC_NACK].sent <<= 1;
-	if(infos->context != NULL)
+	if(decomp == NULL || mrru == NULL)
 	{
-		infos->context->last_pkts_errors <<= 1;
-		infos->context->last_pkts_errors |= 1;
-		infos->context->last_pkt_feedbacks[ROHC_FEEDBACK_ACK].needed <<= 1;
-		infos->context->last_pkt_feedbacks[ROHC_FEEDBACK_ACK].sent <<= 1;
-		infos->context->last_pkt_feedbacks[ROHC_FEEDBACK_NACK].needed <<= 1;
-		infos->context->last_pkt_feedbacks[ROHC_FEEDBACK_NACK].sent <<= 1;
-		infos->context->last_pkt_feedbacks[ROHC_FEEDBACK_STATIC_NACK].needed <<= 1;
-		infos->context->last_pkt_feedbacks[ROHC_FEEDBACK_STATIC_NACK].sent <<= 1;
+		goto error;
 	}
 
-	/* the decompressor cannot warn the compressor if the CID is not identified
-	 * (this happens only if packet is malformed) */
-	if(!infos->cid_found)
+	*mrru = decomp->mrru;
+	return true;
+
+error:
+	return false;
+}
+
+/**
+ * @brief Set the memory budget for the contexts of the ROHC decompressor
+ *
+ * Set the size (in bytes) of the memory budget that the ROHC decompressor may use
+ * for its decompression contexts. The memory budget is preallocated at once, then
+ * the memory of the contexts is taken from it: no memory is allocated any
+ * more when new decompression contexts are created, and the creation of new
+ * contexts fails once the memory budget is exhausted. The memory of the
+ * destroyed contexts is reused for the new contexts.
+ *
+ * If the memory budget is 0, the memory of the contexts is allocated on
+ * demand. This is the default behaviour.
+ *
+ * The memory budget cannot be changed while decompression contexts are in use.
+ *
+ * @param decomp  The ROHC decompressor
+ * @param budget  The size (in bytes) of the memory budget, 0 for no budget
+ * @return        true if the memory budget was successfully set,
+ *                false otherwise
+ *
+ * @ingroup rohc_decomp
+ *
+ * @see rohc_comp_set_memory_budget
+ */
+bool rohc_decomp_set_memory_budget(struct rohc_decomp *const decomp,
+                                   const size_t budget)
+{
+	/* decompressor must be valid */
+	if(decomp == NULL)
 	{
-		rohc_debug(decomp, ROHC_TRACE_DECOMP, infos->profile_id,
-		           "do not perform downward state transition nor send negative "
-		           "feedback to compressor since CID was not identified");
-		goto skip;
+		/* cannot print a trace without a valid decompressor */
+		goto error;
 	}
 
-	if(infos->context_found)
-	{
-		rohc_debug(decomp, ROHC_TRACE_DECOMP, infos->profile_id,
-		           "CID %zu: %s: %s state: %s packet %s", infos->cid,
-		           rohc_get_mode_descr(infos->mode),
-		           rohc_decomp_get_state_descr(infos->state),
-		           rohc_get_packet_descr(infos->packet_type),
-		           infos->crc_failed ? "failed the CRC check" : "received");
-	}
-	else
+	/* the memory of the contexts in use cannot be moved */
+	if(decomp->num_contexts_used > 0)
 	{
-		rohc_debug(decomp, ROHC_TRACE_DECOMP, infos->profile_id,
-		           "CID %zu: packet failed to be parsed", infos->cid);
+		rohc_warning(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+		             "failed to set the memory budget to %zu bytes: %zu "
+		             "contexts are in use", budget, decomp->num_contexts_used);
+		goto error;
 	}
 
-	/* check if the decompressor shall build a negative feedback */
-	if(infos->profile_id == ROHC_PROFILE_UNCOMPRESSED)
-	{
-		/* the Uncompressed profile does not use negative feedback nor FEEDBACK-2 */
-		rohc_debug(decomp, ROHC_TRACE_DECOMP, infos->profile_id,
-		           "do not perform downward state transition nor send negative "
-		           "feedback for the Uncompressed profile");
-		goto skip;
-	}
-	else if(!infos->context_found)
-	{
-		/* RFC says nothing about negative feedbacks for malformed packets, but
-		 * it seems useful to tell the compressor to got back to lower states
-		 * if a packet failed to be parsed */
-		ack_type = ROHC_FEEDBACK_STATIC_NACK;
-		do_downward_transition = false; /* impossible w/o context */
-		do_build_ack = !!(decomp->target_mode > ROHC_U_MODE);
-	}
-	else if(infos->mode == ROHC_U_MODE)
+	if(!rohc_ctxt_pool_set_budget(&decomp->ctxt_pool, budget))
 	{
-		/* U-mode does not use negative feedback */
-		ack_type = ROHC_FEEDBACK_NACK;
-		do_downward_transition = true;
-		do_build_ack = false;
+		rohc_error(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+		           "no memory for the %zu-byte memory budget", budget);
+		goto error;
 	}
-	else if(infos->mode == ROHC_O_MODE)
-	{
-		/* feedback logic for O-mode is described in RFC 3095, §5.4.2.2 */
 
-		/* NC state: when receiving a type 0, 1, 2 or IR-DYN packet, or an IR
-		 * packet has failed the CRC check, send a STATIC-NACK(O), subject to the
-		 * considerations at the beginning of section 5.7.6 */
-		if(infos->state == ROHC_DECOMP_STATE_NC)
-		{
-			ack_type = ROHC_FEEDBACK_STATIC_NACK;
-			do_downward_transition = true;
-			do_build_ack = true;
-		}
-		/* SC state:
-		 *  - when a type 0 or 1 packet is received, treat it as a mismatching
-		 *    CRC and use the logic of section 5.3.2.2.3 to decide if a NACK(O)
-		 *    should be sent
-		 *  - when decompression of a type 2 packet, an IR-DYN packet or an
-		 *    IR packet has failed, use the logic of section 5.3.2.2.3 to
-		 *    decide if a STATIC-NACK(O) should be sent */
-		else if(infos->state == ROHC_DECOMP_STATE_SC)
-		{
-			if(!rohc_decomp_packet_carry_crc_7_or_8(infos->packet_type))
-			{
-				ack_type = ROHC_FEEDBACK_NACK;
-				do_downward_transition = true;
-				do_build_ack = true;
-			}
-			else
-			{
-				ack_type = ROHC_FEEDBACK_STATIC_NACK;
-				do_downward_transition = true;
-				do_build_ack = true;
-			}
-		}
-		/* FC state: when any packet fails the CRC check, use the logic of
-		 * 5.3.2.2.3 to decide if a NACK(O) should be sent */
-		else
-		{
-			ack_type = ROHC_FEEDBACK_NACK;
-			do_downward_transition = true;
-			do_build_ack = true;
-		}
-	}
-	else /* R-mode */
+	/* no memory shall be allocated any more for new contexts, whatever their
+	 * CIDs */
+	if(budget > 0 &&
+	   !rohc_decomp_alloc_ctxts_chunks(decomp, 0, decomp->medium.max_cid))
 	{
-		assert(0); /* TODO: R-mode not implemented yet */
 		goto error;
 	}
+	rohc_debug(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+	           "memory budget is now set to %zu bytes", budget);
 
-	/* stop now if no downward state transition nor NACK is required */
-	if(!do_build_ack && !do_downward_transition)
+	return true;
+
+error:
+	return false;
+}
+
+
+/**
+ * @brief Back the memory of the decompression contexts with huge pages
+ *
+ * With many contexts, the contexts and their profile-specific parts spread
+ * over many memory pages, and the TLB misses slow the decompression down.
+ * With huge pages, the contexts, their profile-specific parts and their
+ * statistics are carved from a few memory areas mapped with 2 MiB huge pages.
+ * Explicit huge pages (MAP_HUGETLB) are used if the system has enough of them
+ * reserved, transparent huge pages are used otherwise.
+ *
+ * The memory budget, see \ref rohc_decomp_set_memory_budget, and the dense
+ * array of contexts, see \ref rohc_decomp_set_dense_contexts, are mapped
+ * with huge pages too: enable the huge pages first.
+ *
+ * The huge pages are mapped directly, not with the memory allocator of the
+ * application, see \ref rohc_set_allocator. They are not available in the
+ * Linux kernel nor on systems without mmap(2).
+ *
+ * Huge pages are disabled by default. They cannot be enabled or disabled
+ * once the memory of contexts was allocated or the dense array of contexts
+ * enabled, neither when a decompressor is run by a manager of channels.
+ *
+ * @param decomp   The ROHC decompressor
+ * @param enabled  Whether to back the memory of contexts with huge pages
+ * @return         true if huge pages were successfully enabled or disabled,
+ *                 false otherwise
+ *
+ * @ingroup rohc_decomp
+ *
+ * @see rohc_decomp_set_memory_budget
+ * @see rohc_decomp_set_dense_contexts
+ * @see rohc_comp_set_huge_pages
+ */
+bool rohc_decomp_set_huge_pages(struct rohc_decomp *const decomp,
+                                const bool enabled)
+{
+	/* decompressor must be valid */
+	if(decomp == NULL)
 	{
-		rohc_debug(decomp, ROHC_TRACE_DECOMP, infos->profile_id,
-		           "no need to perform a downward state transition nor send a "
-		           "negative ACK");
-		goto skip;
+		/* cannot print a trace without a valid decompressor */
+		goto error;
 	}
-	assert(ack_type == ROHC_FEEDBACK_NACK || ack_type == ROHC_FEEDBACK_STATIC_NACK);
 
-	/* rate-limit the downward state transitions and NACKs */
-	if(infos->context != NULL)
+	/* the memory of the contexts already allocated cannot be moved */
+	if(decomp->num_contexts_used > 0 || decomp->ctxts_chunks_nr > 0 ||
+	   decomp->dense_ctxts != NULL)
 	{
-		decomp->last_pkt_feedbacks[ack_type].needed |= 1;
-		infos->context->last_pkt_feedbacks[ack_type].needed |= 1;
-		k_too_quickly = __builtin_popcount(infos->context->last_pkts_errors) * 100;
-		k_too_many = __builtin_popcount(infos->context->last_pkt_feedbacks[ack_type].sent) * 100;
+		rohc_warning(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+		             "failed to %s huge pages: the memory of contexts is "
+		             "already allocated", enabled ? "enable" : "disable");
+		goto error;
 	}
-	else
+	if(decomp->cur_ctxt_pool != &decomp->ctxt_pool)
 	{
-		decomp->last_pkt_feedbacks[ack_type].needed |= 1;
-		k_too_quickly = __builtin_popcount(decomp->last_pkts_errors) * 100;
-		k_too_many = __builtin_popcount(decomp->last_pkt_feedbacks[ack_type].sent) * 100;
+		rohc_warning(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+		             "failed to %s huge pages: the decompressor is run by a "
+		             "manager of channels", enabled ? "enable" : "disable");
+		goto error;
 	}
-	if(ack_type == ROHC_FEEDBACK_NACK)
+
+	if(!rohc_ctxt_pool_set_huge_pages(&decomp->ctxts_chunks_pool, enabled))
 	{
-		threshold_too_quickly = decomp->ack_rate_limits.nack.threshold;
+		rohc_warning(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+		             "failed to map huge pages for the statistics of contexts");
+		goto error;
 	}
-	else
+	if(!rohc_ctxt_pool_set_huge_pages(&decomp->ctxt_pool, enabled))
 	{
-		threshold_too_quickly = decomp->ack_rate_limits.static_nack.threshold;
+		rohc_warning(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+		             "failed to map huge pages for the contexts");
+		/* no chunk was carved yet, the pool may be reset */
+		rohc_ctxt_pool_free(&decomp->ctxts_chunks_pool);
+		rohc_ctxt_pool_init(&decomp->ctxts_chunks_pool);
+		rohc_ctxt_pool_set_numa_node(&decomp->ctxts_chunks_pool,
+		                             decomp->numa_node);
+		goto error;
 	}
-	if(k_too_quickly < threshold_too_quickly)
-	{
-		rohc_debug(decomp, ROHC_TRACE_DECOMP, infos->profile_id,
-		           "avoid sending feedback too quickly (%zu of 3200 with threshold %zu)",
-		           k_too_quickly, threshold_too_quickly);
+	rohc_debug(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+	           "huge pages are now %s for contexts (%zu memory areas backed "
+	           "by explicit huge pages)", enabled ? "enabled" : "disabled",
+	           decomp->ctxts_chunks_pool.huge_areas_nr +
+	           decomp->ctxt_pool.huge_areas_nr);
 
-		/* force sending a negative ACK if compressor/decompressor modes mismatch
-		 * or if decompressor just changed its operational mode */
-		if(do_build_ack && infos->do_change_mode)
-		{
-			rohc_debug(decomp, ROHC_TRACE_DECOMP, infos->profile_id,
-			           "force negative ACK because mode changed or compressor "
-			           "reported a different mode");
-			do_build_ack = true;
-		}
-		else
-		{
-			do_build_ack = false;
-		}
-		do_downward_transition = false;
-	}
-	else if(k_too_quickly >= (threshold_too_quickly + 100) &&
-	        k_too_many >= decomp->ack_rate_limits.speed.threshold)
-	{
-		rohc_debug(decomp, ROHC_TRACE_DECOMP, infos->profile_id,
-		           "rate-limiting successive feedbacks (%zu of 3200 with threshold "
-		           "%zu)", k_too_many, decomp->ack_rate_limits.speed.threshold);
+	return true;
 
-		/* force sending a negative ACK if compressor/decompressor modes mismatch
-		 * or if decompressor just changed its operational mode */
-		if(do_build_ack && infos->do_change_mode)
-		{
-			rohc_debug(decomp, ROHC_TRACE_DECOMP, infos->profile_id,
-			           "force negative ACK because mode changed or compressor "
-			           "reported a different mode");
-			do_build_ack = true;
-		}
-		else
-		{
-			do_build_ack = false;
-		}
-		do_downward_transition = false;
-	}
+error:
+	return false;
+}
 
-	/* update informations if feedback is sent or downward transition taken */
-	if(do_build_ack || do_downward_transition)
+
+/**
+ * @brief Reserve the memory for the given number of decompression contexts
+ *
+ * The statistics of the decompression contexts are allocated by chunks of
+ * consecutive CIDs when the first context of the chunk is created, so that a
+ * decompressor with a large MAX_CID is cheap to create, and its memory grows
+ * with the number of flows. The first packet of a flow may thus allocate
+ * memory for the statistics of its context.
+ *
+ * Reserve the memory for the contexts of the CIDs from 0 to
+ * \e contexts_nr - 1, ie. the first CIDs that a compressor gives to its
+ * contexts by default. Once reserved, no memory is allocated for the
+ * statistics of the contexts of these CIDs any more. The memory of the
+ * contexts themselves is allocated when they are created, see
+ * \ref rohc_decomp_set_memory_budget to preallocate it.
+ *
+ * The memory is kept until the decompressor is destroyed.
+ *
+ * @param decomp       The ROHC decompressor
+ * @param contexts_nr  The number of contexts to reserve memory for, at most
+ *                     MAX_CID + 1
+ * @return             true if the memory was reserved,
+ *                     false otherwise
+ *
+ * @ingroup rohc_decomp
+ *
+ * @see rohc_decomp_set_memory_budget
+ * @see rohc_comp_reserve_contexts
+ */
+bool rohc_decomp_reserve_contexts(struct rohc_decomp *const decomp,
+                                  const size_t contexts_nr)
+{
+	/* decompressor must be valid */
+	if(decomp == NULL)
 	{
-		decomp->last_pkt_feedbacks[ack_type].sent |= 1;
-		if(infos->context != NULL)
-		{
-			infos->context->last_pkt_feedbacks[ack_type].sent |= 1;
-		}
+		/* cannot print a trace without a valid decompressor */
+		goto error;
 	}
 
-	/* prepare feedback packet if needed and asked by user */
-	if(!do_build_ack)
+	if(contexts_nr > (decomp->medium.max_cid + 1))
 	{
-		rohc_debug(decomp, ROHC_TRACE_DECOMP, infos->profile_id,
-		           "do not send a negative ACK");
+		rohc_warning(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+		             "failed to reserve %zu contexts: MAX_CID is %zu",
+		             contexts_nr, decomp->medium.max_cid);
+		goto error;
 	}
-	else if(feedback == NULL)
+
+	if(contexts_nr > 0 &&
+	   !rohc_decomp_alloc_ctxts_chunks(decomp, 0, contexts_nr - 1))
 	{
-		rohc_debug(decomp, ROHC_TRACE_DECOMP, infos->profile_id,
-		           "user choose not to use a feedback channel, do not build any "
-		           "feedback packet");
+		goto error;
 	}
-	else
-	{
-		rohc_feedback_crc_t crc_present;
-		struct d_feedback sfeedback;
-		uint8_t *feedbackp;
-		size_t feedbacksize;
-		size_t feedback_hdr_len;
+	rohc_debug(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+	           "memory reserved for %zu contexts (%zu chunks of %u contexts "
+	           "allocated)", contexts_nr, decomp->ctxts_chunks_nr,
+	           ROHC_DECOMP_CTXTS_CHUNK_LEN);
 
-		rohc_debug(decomp, ROHC_TRACE_DECOMP, infos->profile_id,
-		           "should send a negative ACK (CID = %zu, NACK type = %d, current "
-		           "mode = %d, target mode = %d, at least %zu bits of SN 0x%x, "
-		           "rate-limiting = %zu of 3200 with threshold %zu and %zu of 3200 "
-		           "with threshold %zu)", infos->cid, ack_type, infos->mode,
-		           decomp->target_mode, infos->sn_bits_nr, infos->sn_bits,
-		           k_too_quickly, threshold_too_quickly,
-		           k_too_many, decomp->ack_rate_limits.speed.threshold);
+	return true;
 
-		/* prepare FEEDBACK-2 */
-		if(!f_feedback2(infos->profile_id, ack_type, infos->mode, infos->sn_bits,
-		                infos->sn_bits_nr, &sfeedback))
-		{
-			rohc_warning(decomp, ROHC_TRACE_DECOMP, infos->profile_id,
-			             "failed to build the (STATIC-)NACK feedback");
-			goto error;
-		}
+error:
+	return false;
+}
+
+
+
+/**
+ * @brief Keep the decompression contexts in one dense array
+ *
+ * Allocate at once one slot per CID for the decompression contexts, plus one
+ * slot for the context that replaces an existing one while its IR packet is
+ * decompressed. Every slot holds one context followed by its profile-specific
+ * parts: the decompression of one packet then reads one contiguous memory
+ * area instead of several memory blocks allocated separately, and no memory
+ * is allocated any more when new decompression contexts are created.
+ *
+ * The slots are sized for the most demanding of the profiles enabled when
+ * the function is called: enable the decompression profiles first. The
+ * contexts of the profiles enabled later get their profile-specific parts
+ * from the memory pool as without dense array.
+ *
+ * The dense array takes (MAX_CID + 2) slots in memory, whatever the number of
+ * contexts actually used: enable it for small CIDs or for a MAX_CID that fits
+ * the expected number of flows.
+ *
+ * The dense array is disabled by default. It cannot be enabled or disabled
+ * while decompression contexts are in use.
+ *
+ * @param decomp   The ROHC decompressor
+ * @param enabled  Whether to keep the contexts in one dense array or not
+ * @return         true if the dense array was successfully enabled or
+ *                 disabled, false otherwise
+ *
+ * @ingroup rohc_decomp
+ *
+ * @see rohc_decomp_set_memory_budget
+ */
+bool rohc_decomp_set_dense_contexts(struct rohc_decomp *const decomp,
+                                    const bool enabled)
+{
+	void *dense_ctxts_mem = NULL;
+	size_t slot_len = 0;
+	size_t slots_nr = 0;
+
+	/* decompressor must be valid */
+	if(decomp == NULL)
+	{
+		/* cannot print a trace without a valid decompressor */
+		goto error;
+	}
 
-		/* use CRC option if mode change requested */
-		if(infos->profile_id == ROHC_PROFILE_TCP)
-		{
-			crc_present = ROHC_FEEDBACK_WITH_CRC_BASE;
-		}
-		else if(infos->do_change_mode)
-		{
-			crc_present = ROHC_FEEDBACK_WITH_CRC_OPT;
-		}
-		else
-		{
-			crc_present = ROHC_FEEDBACK_WITH_NO_CRC;
-		}
+	/* the memory of the contexts in use cannot be moved */
+	if(decomp->num_contexts_used > 0)
+	{
+		rohc_warning(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+		             "failed to %s the dense array of contexts: %zu contexts "
+		             "are in use", enabled ? "enable" : "disable",
+		             decomp->num_contexts_used);
+		goto error;
+	}
 
-		/* build the feedback packet */
-		feedbackp = f_wrap_feedback(&sfeedback, infos->cid, infos->cid_type,
-		                            crc_present, decomp->crc_table_8, &feedbacksize);
-		if(feedbackp == NULL)
-		{
-			rohc_warning(decomp, ROHC_TRACE_DECOMP, infos->profile_id,
-			             "failed to wrap the (STATIC-)NACK feedback");
-			goto error;
-		}
+	if(enabled)
+	{
+		size_t block_len = 0;
+		size_t i;
 
-		/* copy the feedback to the buffer provided by the user */
-		/* TODO: build feedback directly into the provided buffer */
-		feedback_hdr_len = 1 + (feedbacksize < 8 ? 0 : 1);
-		if((feedback_hdr_len + feedbacksize) <= rohc_buf_avail_len(*feedback))
+		/* every slot is large enough for the context and for the parts of the
+		 * most demanding profile enabled, and fills full cache lines */
+		for(i = 0; i < D_NUM_PROFILES; i++)
 		{
-			if(feedbacksize < 8)
-			{
-				rohc_buf_byte(*feedback) = 0xf0 | feedbacksize;
-			}
-			else
+			if(decomp->enabled_profiles[i])
 			{
-				rohc_buf_byte(*feedback) = 0xf0;
-				rohc_buf_byte_at(*feedback, 1) = feedbacksize;
+				block_len = rohc_max(block_len,
+				                     rohc_decomp_profiles[i]->ctxt_block_len);
 			}
-			feedback->len += feedback_hdr_len;
-			rohc_buf_append(feedback, feedbackp, feedbacksize);
 		}
-
-		if(feedback->len > 0)
+		slot_len = ROHC_CTXT_ARENA_SIZE(sizeof(struct rohc_decomp_ctxt)) +
+		           ROHC_CTXT_ARENA_SIZE(block_len);
+		slot_len = (slot_len + ROHC_CACHE_LINE_LEN - 1) &
+		           ~((size_t) ROHC_CACHE_LINE_LEN - 1);
+		slots_nr = decomp->medium.max_cid + 2;
+
+		/* one more slot to align the slots on cache lines */
+		dense_ctxts_mem =
+			rohc_ctxt_pool_alloc_area(&decomp->ctxts_chunks_pool,
+			                          (slots_nr + 1) * slot_len);
+		if(dense_ctxts_mem == NULL)
 		{
-			rohc_debug(decomp, ROHC_TRACE_DECOMP, infos->profile_id,
-			           "decompressor built a %zu-byte negative feedback",
-			           feedback->len);
+			rohc_error(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+			           "no memory for the dense array of %zu %zu-byte context "
+			           "slots", slots_nr, slot_len);
+			goto error;
 		}
+	}
 
-		/* destroy the temporary feedback buffer */
-		free(feedbackp);
+	rohc_decomp_free_dense_ctxts(decomp);
+	decomp->dense_ctxts_mem = dense_ctxts_mem;
+	decomp->dense_ctxts =
+		(dense_ctxts_mem == NULL ? NULL : rohc_cache_line_align(dense_ctxts_mem));
+	decomp->dense_slot_len = slot_len;
+	decomp->dense_slots_nr = slots_nr;
+	decomp->dense_free_hint = 0;
+	rohc_debug(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+	           "dense array of contexts is now %s (%zu slots of %zu bytes)",
+	           enabled ? "enabled" : "disabled", slots_nr, slot_len);
+
+	return true;
+
+error:
+	return false;
+}
+
+
+/**
+ * @brief Set the time after which an unused decompression context is
+ *        destroyed
+ *
+ * A decompression context is otherwise kept until a new context replaces it
+ * on the same CID: the contexts of the flows that stopped keep their memory
+ * forever. With the timeout, the memory of the contexts follows the number
+ * of active flows instead of the largest number of flows ever seen.
+ *
+ * A context is unused since the arrival time of the last packet it
+ * successfully decompressed. A few CIDs are checked after every packet, see
+ * also \ref rohc_decomp_reclaim_idle_contexts to check all the CIDs at once
+ * when no packet is received. The timeout requires the arrival times of the
+ * ROHC packets.
+ *
+ * The statistics of a destroyed context are kept until a new context uses
+ * its CID. The next packets of the flow are received without context: the
+ * decompressor asks for an IR packet in O-mode, the compressor sends one
+ * with its periodic refreshes in U-mode.
+ *
+ * The memory of a context from the dense array, see
+ * \ref rohc_decomp_set_dense_contexts, is not freed but given back to the
+ * dense array.
+ *
+ * Idle contexts are kept by default.
+ *
+ * @param decomp   The ROHC decompressor
+ * @param timeout  The time after which an unused context is destroyed
+ *                 (in seconds), 0 to keep idle contexts
+ * @return         true if the timeout was successfully set, false otherwise
+ *
+ * @ingroup rohc_decomp
+ *
+ * @see rohc_decomp_reclaim_idle_contexts
+ */
+bool rohc_decomp_set_ctxts_idle_timeout(struct rohc_decomp *const decomp,
+                                        const uint64_t timeout)
+{
+	/* decompressor must be valid */
+	if(decomp == NULL)
+	{
+		/* cannot print a trace without a valid decompressor */
+		goto error;
 	}
 
-	/* upon decompression failure, perform downward transitions if context is
-	 * still available (new contexts are destroyed upon decompression error) */
-	if(!do_downward_transition || infos->context == NULL)
+	decomp->ctxts_idle_timeout = timeout;
+	rohc_debug(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+	           "idle contexts are now destroyed after %lu seconds (0 = never)",
+	           (unsigned long) timeout);
+
+	return true;
+
+error:
+	return false;
+}
+
+
+/**
+ * @brief Destroy all the decompression contexts that are idle for too long
+ *
+ * Check all the CIDs for contexts unused for the time set with
+ * \ref rohc_decomp_set_ctxts_idle_timeout, for example periodically when
+ * the channel receives no packet.
+ *
+ * @param decomp            The ROHC decompressor
+ * @param now               The current time
+ * @param[out] reclaimed_nr The number of destroyed contexts, may be NULL
+ * @return                  true if the contexts were checked,
+ *                          false if the timeout is not set
+ *
+ * @ingroup rohc_decomp
+ *
+ * @see rohc_decomp_set_ctxts_idle_timeout
+ */
+bool rohc_decomp_reclaim_idle_contexts(struct rohc_decomp *const decomp,
+                                       const struct rohc_ts now,
+                                       size_t *const reclaimed_nr)
+{
+	size_t nr;
+
+	/* decompressor must be valid */
+	if(decomp == NULL)
 	{
-		rohc_debug(decomp, ROHC_TRACE_DECOMP, infos->profile_id,
-		           "do not perform a downward state transition");
+		/* cannot print a trace without a valid decompressor */
+		goto error;
 	}
-	else
+	if(decomp->ctxts_idle_timeout == 0)
 	{
-		rohc_debug(decomp, ROHC_TRACE_DECOMP, infos->profile_id,
-		           "perform a downward state transition now (CID = %zu, NACK "
-		           "type = %d, current mode = %d, target mode = %d, rate-limiting "
-		           "= %zu of 3200 with threshold %zu and %zu of 3200 with "
-		           "threshold %zu)", infos->cid, ack_type, infos->mode,
-		           decomp->target_mode, k_too_quickly, threshold_too_quickly,
-		           k_too_many, decomp->ack_rate_limits.speed.threshold);
+		rohc_warning(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+		             "failed to reclaim idle contexts: no timeout set");
+		goto error;
+	}
 
-		if(infos->state == ROHC_DECOMP_STATE_SC)
-		{
-			rohc_info(decomp, ROHC_TRACE_DECOMP, infos->profile_id,
-			          "change from state %d to state %d because of error(s)",
-			          infos->state, ROHC_DECOMP_STATE_NC);
-			infos->context->state = ROHC_DECOMP_STATE_NC;
-		}
-		else if(infos->state == ROHC_DECOMP_STATE_FC)
-		{
-			rohc_info(decomp, ROHC_TRACE_DECOMP, infos->profile_id,
-			          "change from state %d to state %d because of error(s)",
-			          infos->state, ROHC_DECOMP_STATE_SC);
-			infos->context->state = ROHC_DECOMP_STATE_SC;
-		}
-		else
-		{
-			rohc_debug(decomp, ROHC_TRACE_DECOMP, infos->profile_id,
-			           "stay in state %d because of error(s)", infos->context->state);
-		}
+	nr = rohc_decomp_reclaim_idle(decomp, now, decomp->medium.max_cid + 1);
+	rohc_debug(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+	           "%zu idle contexts destroyed", nr);
+	if(reclaimed_nr != NULL)
+	{
+		*reclaimed_nr = nr;
 	}
 
-skip:
 	return true;
 
 error:
@@ -2352,160 +6257,374 @@ error:
 
 
 /**
- * @brief Update statistics upon successful decompression
+ * @brief Do the work that the real-time mode removes from the datapath
  *
- * @param context         The decompression context
- * @param comp_hdr_len    The length (in bytes) of the compressed header
- * @param uncomp_hdr_len  The length (in bytes) of the uncompressed header
+ * With the feature \ref ROHC_DECOMP_FEATURE_REALTIME, the decompression of
+ * one packet does not scan the contexts: call this function periodically
+ * outside the datapath, for example from a low-priority thread that takes
+ * the same lock as the datapath, to destroy the contexts that are idle for
+ * the time set with \ref rohc_decomp_set_ctxts_idle_timeout. All the CIDs
+ * are checked at every call.
+ *
+ * Without the real-time mode, the datapath already does this work a few
+ * CIDs at a time, but the function may be called too.
+ *
+ * @param decomp  The ROHC decompressor
+ * @param now     The current time
+ * @return        true if the maintenance was done,
+ *                false if the decompressor is invalid
+ *
+ * @ingroup rohc_decomp
+ *
+ * @see rohc_decomp_set_features
+ * @see rohc_decomp_reclaim_idle_contexts
  */
-static void rohc_decomp_stats_add_success(struct rohc_decomp_ctxt *const context,
-                                          const size_t comp_hdr_len,
-                                          const size_t uncomp_hdr_len)
+bool rohc_decomp_maintenance(struct rohc_decomp *const decomp,
+                             const struct rohc_ts now)
 {
-	context->header_compressed_size += comp_hdr_len;
-	context->header_uncompressed_size += uncomp_hdr_len;
+	size_t nr = 0;
+
+	/* decompressor must be valid */
+	if(decomp == NULL)
+	{
+		/* cannot print a trace without a valid decompressor */
+		goto error;
+	}
+
+	if(decomp->ctxts_idle_timeout > 0)
+	{
+		nr = rohc_decomp_reclaim_idle(decomp, now, decomp->medium.max_cid + 1);
+	}
+	rohc_debug(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+	           "maintenance: %zu idle contexts destroyed", nr);
+
+	return true;
+
+error:
+	return false;
 }
 
 
 /**
- * @brief Reset all the statistics of the given ROHC decompressor
+ * @brief Set the number of packets sent during one Round-Trip Time (RTT).
  *
- * @param decomp The ROHC decompressor
+ * Set the maximum number of packets sent in worst case by the remote ROHC
+ * compressor for one given stream (ie. one compression/decompression context)
+ * during one Round-Trip Time (RTT).
+ *
+ * The number of packets sent by the remote ROHC compressor is used to estimate
+ * how many SN bits those feedbacks shall transmit to avoid any ambiguity at
+ * compressor about the ROHC packet that is (n)acknowledged by the decompressor.
+ *
+ * The pRTT value must be in range [0 ; SIZE_MAX/2[. If set to 0, all SN bits
+ * are always transmitted.
+ *
+ * The default value is 50 packets / RTT, ie. a RTT of 1 second with one packet
+ * transmitted every 20 milliseconds (classic VoIP stream). If your network
+ * streams and conditions differ, change the default value.
+ *
+ * @param decomp  The ROHC decompressor
+ * @param prtt    The number of packets sent during one RTT
+ * @return        true if the new value was successfully set, false otherwise
+ *
+ * @ingroup rohc_decomp
+ *
+ * \par Example:
+ * \snippet test_feedback2.c define ROHC decompressor
+ * \code
+        rohc_cid_type_t cid_type = ROHC_SMALL_CID;
+        rohc_cid_t max_cid = ROHC_SMALL_CID_MAX;
+        ...
+\endcode
+ * \snippet test_feedback2.c create ROHC decompressor
+ * \code
+        ...
+\endcode
+ * \snippet test_feedback2.c set decompressor pRTT
+ * \code
+        ...
+\endcode
+ *
+ * @see rohc_decomp_get_prtt
+ * @see rohc_decompress3
  */
-static void rohc_decomp_reset_stats(struct rohc_decomp *const decomp)
+bool rohc_decomp_set_prtt(struct rohc_decomp *const decomp,
+                          const size_t prtt)
 {
-	assert(decomp != NULL);
-	decomp->stats.received = 0;
-	decomp->stats.failed_crc = 0;
-	decomp->stats.failed_no_context = 0;
-	decomp->stats.failed_decomp = 0;
-	decomp->stats.total_compressed_size = 0;
-	decomp->stats.total_uncompressed_size = 0;
-	decomp->stats.corrected_crc_failures = 0;
-	decomp->stats.corrected_sn_wraparounds = 0;
-	decomp->stats.corrected_wrong_sn_updates = 0;
+	/* decompressor must be valid */
+	if(decomp == NULL)
+	{
+		/* cannot print a trace without a valid decompressor */
+		goto error;
+	}
+
+	/* new pRTT must be in range [0, SIZE_MAX] */
+	if(prtt >= (SIZE_MAX / 2))
+	{
+		rohc_warning(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+		             "unexpected pRTT value: must be in range [0, %zu]",
+		             SIZE_MAX);
+		goto error;
+	}
+
+	/* set new pRTT */
+	decomp->prtt = prtt;
+	rohc_debug(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+	           "pRTT is now set to %zu", decomp->prtt);
+
+	/* compute the minimum number of SN bits to transmit to the remote
+	 * compressor in the positive or negative feedbacks in order to avoid
+	 * any ambiguity at compressor about the ROHC packet that is
+	 * (n)acknowledged by the decompressor */
+	decomp->sn_feedback_min_bits = sizeof(uint32_t) * 8;
+	if(decomp->prtt != 0)
+	{
+		decomp->sn_feedback_min_bits -= __builtin_clz(decomp->prtt);
+	}
+
+	return true;
+
+error:
+	return false;
 }
 
 
 /**
- * @brief Give a description for the given ROHC decompression context state
+ * @brief Get the number of packets sent during one Round-Trip Time (RTT).
  *
- * Give a description for the given ROHC decompression context state.
+ * Get the maximum number of packets sent in worst case by the remote ROHC
+ * compressor for one given stream (ie. one compression/decompression context)
+ * during one Round-Trip Time (RTT).
  *
- * The descriptions are not part of the API. They may change between
- * releases without any warning. Do NOT use them for other means that
- * providing to users a textual description of decompression context states
- * used by the library. If unsure, ask on the mailing list.
+ * The number of packets sent by the remote ROHC compressor is used to estimate
+ * how many SN bits those feedbacks shall transmit to avoid any ambiguity at
+ * compressor about the ROHC packet that is (n)acknowledged by the decompressor.
  *
- * @param state  The decompression context state to get a description for
- * @return       A string that describes the given decompression context state
+ * The pRTT value must be in range [0 ; SIZE_MAX/2[. If set to 0, all SN bits
+ * are always transmitted.
+ *
+ * The default value is 50 packets / RTT, ie. a RTT of 1 second with one packet
+ * transmitted every 20 milliseconds (classic VoIP stream). If your network
+ * streams and conditions differ, change the default value.
+ *
+ * @param decomp     The ROHC decompressor
+ * @param[out] prtt  The number of packets sent during one RTT
+ * @return           true if pRTT was successfully retrieved, false otherwise
  *
  * @ingroup rohc_decomp
+ *
+ * @see rohc_decomp_set_prtt
+ * @see rohc_decompress3
  */
-const char * rohc_decomp_get_state_descr(const rohc_decomp_state_t state)
+bool rohc_decomp_get_prtt(const struct rohc_decomp *const decomp,
+                          size_t *const prtt)
 {
-	switch(state)
+	if(decomp == NULL || prtt == NULL)
 	{
-		case ROHC_DECOMP_STATE_NC:
-			return "No Context";
-		case ROHC_DECOMP_STATE_SC:
-			return "Static Context";
-		case ROHC_DECOMP_STATE_FC:
-			return "Full Context";
-		case ROHC_DECOMP_STATE_UNKNOWN:
-		default:
-			return "no description";
+		goto error;
 	}
+
+	*prtt = decomp->prtt;
+	return true;
+
+error:
+	return false;
 }
 
 
 /**
- * @brief Get some information about the last decompressed packet
+ * @brief Set the rate limits for feedbacks
  *
- * Get some information about the last decompressed packet.
+ * Set the rate limits for positive feedbacks (ACK) and negative feedbacks (NACK
+ * and STATIC-NACK).
  *
- * To use the function, call it with a pointer on a pre-allocated
- * \ref rohc_decomp_last_packet_info_t structure with the \e version_major
- * and \e version_minor fields set to one of the following supported
- * versions:
- *  - Major 0, minor 0
- *  - Major 0, minor 1
+ * There are 3 different rate limits:
+ *  \li the rate limit to avoid sending the same type of feedback too often:
+ *      it applies to all feedback types (ACK, NACK, STATIC-NACK) and it is
+ *      specified by the parameters \e k and \e n ;
+ *  \li the rate limit to avoid sending NACKs too quickly after a sporadic CRC
+ *      failure: it is specified by the parameters \e k_1 and \e n_1 ;
+ *  \li the rate limit to avoid sending STATIC-NACKs too quickly after a sporadic
+ *      CRC failure: it is specified by the parameters \e k_2 and \e n_2 ;
  *
- * See \ref rohc_decomp_last_packet_info_t for details about fields that
- * are supported in the above versions.
+ * In all 3 cases above, the \e k/k_1/k_2 and \e n/n_1/n_2 parameters define
+ * 3 ratios of packets:
+ *  \li a feedback is sent every \e k packets out of \e n packets that cause
+ *      the same feedback type to be sent ;
+ *  \li a NACK is not sent before \e k_1 packets out of \e n_1 packets failed
+ *      because of a CRC failure in the Full Context state ;
+ *  \li a STATIC-NACK is not sent before \e k_1 packets out of \e n_1 packets
+ *      failed because of a CRC failure in the Static Context state ;
  *
- * @param decomp        The ROHC decompressor to get information from
- * @param[in,out] info  The structure where information will be stored
- * @return              true in case of success, false otherwise
+ * The default values are:
+ *  \li k   =  1 and n   = default pRTT (see rohc_decomp_set_prtt for details)
+ *  \li k_1 = 30 and n_1 = 100, ie. 30%
+ *  \li k_2 = 30 and n_2 = 100, ie. 30%
+ *
+ * If your network streams and conditions differ, change the default value.
+ *
+ * The n/n_1/n_2 values shall not be zero.
+ *
+ * @param decomp  The ROHC decompressor
+ * @param k       The k rate-limit parameter to avoid sending feedback too often
+ * @param n       The n rate-limit parameter to avoid sending feedback too often
+ * @param k_1     The k_1 rate-limit parameter to avoid sending NACKs too quickly
+ * @param n_1     The n_1 rate-limit parameter to avoid sending NACKs too quickly
+ * @param k_2     The k_2 rate-limit parameter to avoid sending STATIC-NACKs too quickly
+ * @param n_2     The n_2 rate-limit parameter to avoid sending STATIC-NACKs too quickly
+ * @return        true if the new values were successfully set, false otherwise
  *
  * @ingroup rohc_decomp
  *
- * @see rohc_decomp_last_packet_info_t
+ * \par Example:
+ * \snippet test_lost_packet.c define ROHC decompressor
+ * \code
+        ...
+\endcode
+ * \snippet test_lost_packet.c create ROHC decompressor
+ * \code
+        ...
+\endcode
+ * \snippet test_lost_packet.c set decompressor rate limits
+ * \code
+        ...
+\endcode
+ *
+ * @see rohc_decomp_get_rate_limits
+ * @see rohc_decomp_set_prtt
+ * @see rohc_decomp_get_prtt
+ * @see rohc_decompress3
  */
-bool rohc_decomp_get_last_packet_info(const struct rohc_decomp *const decomp,
-                                      rohc_decomp_last_packet_info_t *const info)
+bool rohc_decomp_set_rate_limits(struct rohc_decomp *const decomp,
+                                 const size_t k, const size_t n,
+                                 const size_t k_1, const size_t n_1,
+                                 const size_t k_2, const size_t n_2)
 {
+	/* decompressor must be valid */
 	if(decomp == NULL)
 	{
+		/* cannot print a trace without a valid decompressor */
 		goto error;
 	}
 
-	if(decomp->last_context == NULL)
+	/* n values are used as divisors */
+	if(n == 0 || n_1 == 0 || n_2 == 0)
 	{
-		rohc_error(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
-		           "last context found in decompressor is not valid");
+		rohc_warning(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+		             "rate-limits n/n_1/n_2 shall not be 0");
 		goto error;
 	}
 
-	if(info == NULL)
-	{
-		rohc_error(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
-		           "structure for last packet information is not valid");
-		goto error;
-	}
+	/* set new rate-limits */
+	decomp->ack_rate_limits.speed.k = k;
+	decomp->ack_rate_limits.speed.n = n;
+	decomp->ack_rate_limits.nack.k = k_1;
+	decomp->ack_rate_limits.nack.n = n_1;
+	decomp->ack_rate_limits.static_nack.k = k_2;
+	decomp->ack_rate_limits.static_nack.n = n_2;
 
-	/* check compatibility version */
-	if(info->version_major == 0)
-	{
-		/* base fields for major version 0 */
-		info->context_mode = decomp->last_context->mode;
-		info->context_state = decomp->last_context->state;
-		info->profile_id = decomp->last_context->profile->id;
-		info->nr_lost_packets = decomp->last_context->nr_lost_packets;
-		info->nr_misordered_packets = decomp->last_context->nr_misordered_packets;
-		info->is_duplicated = decomp->last_context->is_duplicated;
+	/* compute the rate-limit thresholds */
+	decomp->ack_rate_limits.speed.threshold =
+		decomp->ack_rate_limits.speed.k * 32 * 100 / decomp->ack_rate_limits.speed.n;
+	decomp->ack_rate_limits.nack.threshold =
+		decomp->ack_rate_limits.nack.k * 32 * 100 / decomp->ack_rate_limits.nack.n;
+	decomp->ack_rate_limits.static_nack.threshold =
+		decomp->ack_rate_limits.static_nack.k * 32 * 100 /
+		decomp->ack_rate_limits.static_nack.n;
 
-		/* new fields added by minor versions */
-		switch(info->version_minor)
-		{
-			case 0:
-				/* nothing to add */
-				break;
-			case 1:
-				/* new fields in 0.1 */
-				info->corrected_crc_failures =
-					decomp->last_context->corrected_crc_failures;
-				info->corrected_sn_wraparounds =
-					decomp->last_context->corrected_sn_wraparounds;
-				info->corrected_wrong_sn_updates =
-					decomp->last_context->corrected_wrong_sn_updates;
-				info->packet_type = decomp->last_context->packet_type;
-				break;
-			default:
-				rohc_error(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
-				           "unsupported minor version (%u) of the structure for "
-				           "last packet information", info->version_minor);
-				goto error;
-		}
-	}
-	else
+	/* convert the thresholds in numbers of packets once for all, so that the
+	 * population counts of the history bitmaps are compared directly with them:
+	 * (popcount * 100 >= threshold) is (popcount >= ceil(threshold / 100)) */
+	decomp->ack_rate_limits.speed.pkts_nr =
+		(decomp->ack_rate_limits.speed.threshold + 99) / 100;
+	decomp->ack_rate_limits.nack.pkts_nr =
+		(decomp->ack_rate_limits.nack.threshold + 99) / 100;
+	decomp->ack_rate_limits.static_nack.pkts_nr =
+		(decomp->ack_rate_limits.static_nack.threshold + 99) / 100;
+
+	rohc_debug(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+	           "rate-limits are now set to: %zu/%zu (all), %zu/%zu (NACK), "
+	           "%zu/%zu (STATIC-NACK)",
+	           decomp->ack_rate_limits.speed.k, decomp->ack_rate_limits.speed.n,
+	           decomp->ack_rate_limits.nack.k, decomp->ack_rate_limits.nack.n,
+	           decomp->ack_rate_limits.static_nack.k,
+	           decomp->ack_rate_limits.static_nack.n);
+
+	return true;
+
+error:
+	return false;
+}
+
+
+/**
+ * @brief Get the rate limits for feedbacks currently configured
+ *
+ * Get the rate limits for positive feedbacks (ACK) and negative feedbacks (NACK
+ * and STATIC-NACK).
+ *
+ * There are 3 different rate limits:
+ *  \li the rate limit to avoid sending the same type of feedback too often:
+ *      it applies to all feedback types (ACK, NACK, STATIC-NACK) and it is
+ *      specified by the parameters \e k and \e n ;
+ *  \li the rate limit to avoid sending NACKs too quickly after a sporadic CRC
+ *      failure: it is specified by the parameters \e k_1 and \e n_1 ;
+ *  \li the rate limit to avoid sending STATIC-NACKs too quickly after a sporadic
+ *      CRC failure: it is specified by the parameters \e k_2 and \e n_2 ;
+ *
+ * In all 3 cases above, the \e k/k_1/k_2 and \e n/n_1/n_2 parameters define
+ * 3 ratios of packets:
+ *  \li a feedback is sent every \e k packets out of \e n packets that cause
+ *      the same feedback type to be sent ;
+ *  \li a NACK is not sent before \e k_1 packets out of \e n_1 packets failed
+ *      because of a CRC failure in the Full Context state ;
+ *  \li a STATIC-NACK is not sent before \e k_1 packets out of \e n_1 packets
+ *      failed because of a CRC failure in the Static Context state ;
+ *
+ * The default values are:
+ *  \li k   =  1 and n   = default pRTT (see rohc_decomp_set_prtt for details)
+ *  \li k_1 = 30 and n_1 = 100, ie. 30%
+ *  \li k_2 = 30 and n_2 = 100, ie. 30%
+ *
+ * If your network streams and conditions differ, change the default value.
+ *
+ * @param decomp   The ROHC decompressor
+ * @param[out] k    The k rate-limit parameter to avoid sending feedback too often
+ * @param[out] n    The n rate-limit parameter to avoid sending feedback too often
+ * @param[out] k_1  The k_1 rate-limit param. to avoid sending NACKs too quickly
+ * @param[out] n_1  The n_1 rate-limit param. to avoid sending NACKs too quickly
+ * @param[out] k_2  The k_2 rate-limit param. to avoid sending STATIC-NACKs too quickly
+ * @param[out] n_2  The n_2 rate-limit param. to avoid sending STATIC-NACKs too quickly
+ * @return          true if rate-limits were successfully retrieved,
+ *                  false otherwise
+ *
+ * @ingroup rohc_decomp
+ *
+ * @see rohc_decomp_set_rate_limits
+ * @see rohc_decomp_set_prtt
+ * @see rohc_decomp_get_prtt
+ * @see rohc_decompress3
+ */
+bool rohc_decomp_get_rate_limits(const struct rohc_decomp *const decomp,
+                                 size_t *const k, size_t *const n,
+                                 size_t *const k_1, size_t *const n_1,
+                                 size_t *const k_2, size_t *const n_2)
+{
+	if(decomp == NULL ||
+	   k == NULL || n == NULL ||
+	   k_1 == NULL || n_1 == NULL ||
+	   k_2 == NULL || n_2 == NULL)
 	{
-		rohc_error(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
-		           "unsupported major version (%u) of the structure for last "
-		           "packet information", info->version_major);
 		goto error;
 	}
 
+	*k = decomp->ack_rate_limits.speed.k;
+	*n = decomp->ack_rate_limits.speed.n;
+	*k_1 = decomp->ack_rate_limits.nack.k;
+	*n_1 = decomp->ack_rate_limits.nack.n;
+	*n_2 = decomp->ack_rate_limits.static_nack.n;
+	*k_2 = decomp->ack_rate_limits.static_nack.k;
+
 	return true;
 
 error:
@@ -2514,94 +6633,54 @@ error:
 
 
 /**
- * @brief Get some information about the given decompression context
+ * @brief Set the coalescing window of the positive feedbacks
  *
- * Get some information about the given decompression context.
+ * In O-mode and U-mode, the decompressor may send one positive ACK for
+ * many of the packets it decompresses successfully. To save bandwidth on
+ * the feedback channel, the positive ACKs may be delayed for up to
+ * \e window packets:
+ *  \li the ACKs delayed for the same context are coalesced into one single
+ *      ACK for the SN of the latest packet ;
+ *  \li the ACKs delayed for different contexts are built together in the
+ *      same feedback buffer, as soon as the oldest one waited for \e window
+ *      packets, or as soon as another feedback is sent.
  *
- * To use the function, call it with a pointer on a pre-allocated
- * \ref rohc_decomp_context_info_t structure with the \e version_major
- * and \e version_minor fields set to one of the following supported
- * versions:
- *  - Major 0, minor 0
+ * The negative ACKs (NACK and STATIC-NACK) and the ACKs that advertise a
+ * mode change are never delayed. They supersede the positive ACK delayed
+ * for the same context.
  *
- * See \ref rohc_decomp_context_info_t for details about fields that
- * are supported in the above versions.
+ * The delayed ACKs are built in the \e feedback_send buffer given to
+ * \ref rohc_decompress3. Use \ref rohc_decomp_flush_feedbacks to build
+ * them before the window elapses, for example when the traffic stops.
  *
- * @param decomp        The ROHC decompressor to get information from
- * @param cid           The Context ID to get information for
- * @param[in,out] info  The structure where information will be stored
- * @return              true in case of success, false otherwise
+ * The coalescing window is 0 by default: positive ACKs are not delayed.
+ *
+ * @param decomp  The ROHC decompressor
+ * @param window  The max number of packets a positive ACK may be delayed,
+ *                0 to send positive ACKs immediately
+ * @return        true if the window was successfully set,
+ *                false otherwise
  *
  * @ingroup rohc_decomp
  *
- * @see rohc_decomp_context_info_t
+ * @see rohc_decomp_get_feedback_coalescing
+ * @see rohc_decomp_flush_feedbacks
+ * @see rohc_decomp_set_rate_limits
  */
-bool rohc_decomp_get_context_info(const struct rohc_decomp *const decomp,
-                                  const rohc_cid_t cid,
-                                  rohc_decomp_context_info_t *const info)
+bool rohc_decomp_set_feedback_coalescing(struct rohc_decomp *const decomp,
+                                         const size_t window)
 {
+	/* decompressor must be valid */
 	if(decomp == NULL)
 	{
+		/* cannot print a trace without a valid decompressor */
 		goto error;
 	}
 
-	if(cid > decomp->medium.max_cid)
-	{
-		rohc_error(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
-		           "decompressor does not handle CID %zu since MAX_CID is %zu",
-		           cid, decomp->medium.max_cid);
-		goto error;
-	}
-
-	if(info == NULL)
-	{
-		rohc_error(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
-		           "structure for context information is not valid");
-		goto error;
-	}
-
-	/* check compatibility version */
-	if(info->version_major == 0)
-	{
-		/* base fields for major version 0 */
-		if(decomp->contexts[cid] == NULL)
-		{
-			info->packets_nr = 0;
-			info->comp_bytes_nr = 0;
-			info->uncomp_bytes_nr = 0;
-			info->corrected_crc_failures = 0;
-			info->corrected_sn_wraparounds = 0;
-			info->corrected_wrong_sn_updates = 0;
-		}
-		else
-		{
-			info->packets_nr = decomp->contexts[cid]->num_recv_packets;
-			info->comp_bytes_nr = decomp->contexts[cid]->total_compressed_size;
-			info->uncomp_bytes_nr = decomp->contexts[cid]->total_uncompressed_size;
-			info->corrected_crc_failures =
-				decomp->contexts[cid]->corrected_crc_failures;
-			info->corrected_sn_wraparounds =
-				decomp->contexts[cid]->corrected_sn_wraparounds;
-			info->corrected_wrong_sn_updates =
-				decomp->contexts[cid]->corrected_wrong_sn_updates;
-		}
-
-		/* new fields added by minor versions */
-		if(info->version_minor > 0)
-		{
-			rohc_error(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
-			           "unsupported minor version (%u) of the structure for "
-			           "context information", info->version_minor);
-			goto error;
-		}
-	}
-	else
-	{
-		rohc_error(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
-		           "unsupported major version (%u) of the structure for context"
-		           "information", info->version_major);
-		goto error;
-	}
+	decomp->ack_coalescing_window = window;
+	rohc_debug(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+	           "positive ACKs are now delayed for up to %zu packets",
+	           decomp->ack_coalescing_window);
 
 	return true;
 
@@ -2611,78 +6690,29 @@ error:
 
 
 /**
- * @brief Get some general information about the decompressor
+ * @brief Get the coalescing window of the positive feedbacks
  *
- * Get some general information about the decompressor.
- *
- * To use the function, call it with a pointer on a pre-allocated
- * \ref rohc_decomp_general_info_t structure with the \e version_major and
- * \e version_minor fields set to one of the following supported versions:
- *  - Major 0, minor 0
- *
- * See the \ref rohc_decomp_general_info_t structure for details about fields
- * that are supported in the above versions.
+ * See \ref rohc_decomp_set_feedback_coalescing for details.
  *
- * @param decomp        The ROHC decompressor to get information from
- * @param[in,out] info  The structure where information will be stored
- * @return              true in case of success, false otherwise
+ * @param decomp       The ROHC decompressor
+ * @param[out] window  The max number of packets a positive ACK may be
+ *                     delayed, 0 if positive ACKs are sent immediately
+ * @return             true if the window was successfully retrieved,
+ *                     false otherwise
  *
  * @ingroup rohc_decomp
  *
- * @see rohc_decomp_general_info_t
+ * @see rohc_decomp_set_feedback_coalescing
  */
-bool rohc_decomp_get_general_info(const struct rohc_decomp *const decomp,
-                                  rohc_decomp_general_info_t *const info)
+bool rohc_decomp_get_feedback_coalescing(const struct rohc_decomp *const decomp,
+                                         size_t *const window)
 {
-	if(decomp == NULL)
+	if(decomp == NULL || window == NULL)
 	{
 		goto error;
 	}
 
-	if(info == NULL)
-	{
-		rohc_error(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
-		           "structure for general information is not valid");
-		goto error;
-	}
-
-	/* check compatibility version */
-	if(info->version_major == 0)
-	{
-		/* base fields for major version 0 */
-		info->contexts_nr = decomp->num_contexts_used;
-		info->packets_nr = decomp->stats.received;
-		info->comp_bytes_nr = decomp->stats.total_compressed_size;
-		info->uncomp_bytes_nr = decomp->stats.total_uncompressed_size;
-
-		/* new fields added by minor versions */
-		switch(info->version_minor)
-		{
-			case 0:
-				/* nothing to add */
-				break;
-			case 1:
-				/* new fields in 0.1 */
-				info->corrected_crc_failures = decomp->stats.corrected_crc_failures;
-				info->corrected_sn_wraparounds =
-					decomp->stats.corrected_sn_wraparounds;
-				info->corrected_wrong_sn_updates =
-					decomp->stats.corrected_wrong_sn_updates;
-				break;
-			default:
-				rohc_error(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
-				           "unsupported minor version (%u) of the structure for "
-				           "general information", info->version_minor);
-				goto error;
-		}
-	}
-	else
-	{
-		rohc_error(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
-		           "unsupported major version (%u) of the structure for "
-		           "general information", info->version_major);
-		goto error;
-	}
+	*window = decomp->ack_coalescing_window;
 
 	return true;
 
@@ -2692,28 +6722,31 @@ error:
 
 
 /**
- * @brief Get the CID type that the decompressor uses
+ * @brief Build the delayed positive feedbacks now
  *
- * Get the CID type that the decompressor currently uses.
+ * Build all the positive ACKs that the decompressor delayed because of the
+ * coalescing window, see \ref rohc_decomp_set_feedback_coalescing. The ACKs
+ * are appended to the given feedback buffer. The ACKs that do not fit in the
+ * buffer stay delayed.
  *
- * @param decomp         The ROHC decompressor
- * @param[out] cid_type  The current CID type among \ref ROHC_SMALL_CID and
- *                       \ref ROHC_LARGE_CID
- * @return               true if the CID type was successfully retrieved,
- *                       false otherwise
+ * @param decomp              The ROHC decompressor
+ * @param[out] feedback_send  The buffer where to store the feedbacks
+ * @return                    true if the feedbacks were successfully built
+ *                            (may be 0 byte), false otherwise
  *
  * @ingroup rohc_decomp
+ *
+ * @see rohc_decomp_set_feedback_coalescing
  */
-bool rohc_decomp_get_cid_type(const struct rohc_decomp *const decomp,
-                              rohc_cid_type_t *const cid_type)
+bool rohc_decomp_flush_feedbacks(struct rohc_decomp *const decomp,
+                                 struct rohc_buf *const feedback_send)
 {
-	if(decomp == NULL || cid_type == NULL)
+	if(decomp == NULL || feedback_send == NULL)
 	{
 		goto error;
 	}
 
-	*cid_type = decomp->medium.cid_type;
-	return true;
+	return rohc_decomp_flush_acks(decomp, feedback_send);
 
 error:
 	return false;
@@ -2721,27 +6754,70 @@ error:
 
 
 /**
- * @brief Get the maximal CID value the decompressor uses
+ * @brief Enable, resize or disable the ring of the feedbacks to send
  *
- * Get the maximal CID value the decompressor uses, ie. the \e MAX_CID
- * parameter defined in RFC 3095.
+ * The ring is owned by the decompressor. It holds the feedbacks to send
+ * returned as views by \ref rohc_decompress_fb_views, so that they are
+ * built in place instead of being copied into a buffer of the user. Every
+ * non-empty feedback takes one slot of the ring: it remains valid until the
+ * next \e slots_nr - 1 non-empty feedbacks are returned. The feedbacks
+ * returned before are dropped.
  *
- * @param decomp        The ROHC decompressor
- * @param[out] max_cid  The current maximal CID value
- * @return              true if MAX_CID was successfully retrieved,
- *                      false otherwise
+ * The ring is disabled by default.
+ *
+ * @param decomp   The ROHC decompressor
+ * @param slots_nr  The number of slots of the ring, a power of 2, or 0 to
+ *                  disable the ring
+ * @param slot_len  The length (in bytes) of one slot, the feedback items
+ *                  that do not fit in one slot are dropped
+ * @return          true if the ring was enabled, resized or disabled,
+ *                  false if the parameters are invalid or in case of memory
+ *                  allocation failure
  *
  * @ingroup rohc_decomp
+ *
+ * @see rohc_decompress_fb_views
  */
-bool rohc_decomp_get_max_cid(const struct rohc_decomp *const decomp,
-                             size_t *const max_cid)
+bool rohc_decomp_set_feedback_ring(struct rohc_decomp *const decomp,
+                                   const size_t slots_nr,
+                                   const size_t slot_len)
 {
-	if(decomp == NULL || max_cid == NULL)
+	uint8_t *ring = NULL;
+
+	if(decomp == NULL)
 	{
 		goto error;
 	}
+	if(slots_nr > 0)
+	{
+		if((slots_nr & (slots_nr - 1)) != 0 || slot_len == 0 ||
+		   slot_len > (SIZE_MAX / slots_nr))
+		{
+			rohc_warning(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+			             "invalid ring of %zu slots of %zu bytes: the number "
+			             "of slots shall be a power of 2", slots_nr, slot_len);
+			goto error;
+		}
+		ring = rohc_malloc(slots_nr * slot_len);
+		if(ring == NULL)
+		{
+			rohc_warning(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+			             "failed to allocate a ring of %zu slots of %zu bytes",
+			             slots_nr, slot_len);
+			goto error;
+		}
+	}
+
+	rohc_free(decomp->fb_ring);
+	decomp->fb_ring = ring;
+	decomp->fb_ring_mask = (slots_nr > 0 ? slots_nr - 1 : 0);
+	decomp->fb_ring_slot_len = (slots_nr > 0 ? slot_len : 0);
+	decomp->fb_ring_next = 0;
+
+	rohc_debug(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+	           "ring of %zu slots of %zu bytes for the feedbacks to send",
+	           slots_nr, slot_len);
 
-	*max_cid = decomp->medium.max_cid;
 	return true;
 
 error:
@@ -2750,78 +6826,56 @@ error:
 
 
 /**
- * @brief Set the Maximum Reconstructed Reception Unit (MRRU).
- *
- * Set the Maximum Reconstructed Reception Unit (MRRU).
- *
- * The MRRU is the largest cumulative length (in bytes) of the ROHC segments
- * that are parts of the same ROHC packet. In short, the ROHC decompressor
- * does not expect to reassemble ROHC segments whose total length is larger
- * than MRRU. So, the ROHC compressor shall not segment ROHC packets greater
- * than the MRRU.
- *
- * The MRRU value must be in range [0 ; \ref ROHC_MAX_MRRU]. Remember that the
- * MRRU includes the 32-bit CRC that protects it.
- * If set to 0, segmentation is disabled as no segment headers are allowed
- * on the channel. Every received segment will be dropped.
- *
- * If segmentation is enabled and used by the compressor, the function
- * \ref rohc_decompress3 will return ROHC_OK and one empty uncompressed packet
- * upon decompression until the last segment is received (or a non-segment is
- * received). Decompressed data will be returned at that time.
- *
- * @warning Changing the MRRU value while library is used may lead to
- *          destruction of the current RRU.
+ * @brief Set the budgets of repairs upon CRC failure
+ *
+ * When the \ref ROHC_DECOMP_FEATURE_CRC_REPAIR feature is enabled, every
+ * CRC failure of an UO packet may cause the decompressor to decode and to
+ * build the packet once more with other assumptions on the SN. Limit the
+ * number of those repairs, so that a flow of corrupted packets does not
+ * double the decompression cost:
+ *  \li \e ctxt_budget is the maximum number of repairs attempted by one
+ *      decompression context during one second ;
+ *  \li \e global_budget is the maximum number of repairs attempted by all
+ *      the decompression contexts during one second.
+ *
+ * The seconds are those of the arrival times of the ROHC packets given to
+ * \ref rohc_decompress3. If no arrival time is given, the budgets are never
+ * refilled. The CRC failures that are not repaired because a budget is
+ * exhausted are counted in the \e crc_repair_skipped statistics.
+ *
+ * If a budget is 0, the number of repairs is not limited. This is the
+ * default behaviour.
  *
- * @param decomp  The ROHC decompressor
- * @param mrru    The new MRRU value (in bytes)
- * @return        true if the MRRU was successfully set, false otherwise
+ * @param decomp         The ROHC decompressor
+ * @param ctxt_budget    The max number of repairs per context and per second,
+ *                       0 for no limit
+ * @param global_budget  The max number of repairs per second for all
+ *                       contexts, 0 for no limit
+ * @return               true if the budgets were successfully set,
+ *                       false otherwise
  *
  * @ingroup rohc_decomp
  *
- * \par Example:
- * \snippet test_segment.c define ROHC decompressor
- * \code
-        size_t mrru = 500;
-        ...
-\endcode
- * \snippet test_segment.c create ROHC decompressor
- * \code
-        ...
-\endcode
- * \snippet test_segment.c set decompressor MRRU
- * \code
-        ...
-\endcode
- *
- * @see rohc_decomp_get_mrru
- * @see rohc_decompress3
- * @see rohc_comp_set_mrru
- * @see rohc_comp_get_mrru
+ * @see rohc_decomp_get_crc_repair_budget
+ * @see rohc_decomp_set_features
  */
-bool rohc_decomp_set_mrru(struct rohc_decomp *const decomp,
-                          const size_t mrru)
+bool rohc_decomp_set_crc_repair_budget(struct rohc_decomp *const decomp,
+                                       const size_t ctxt_budget,
+                                       const size_t global_budget)
 {
-	/* decompressor must be valid */
-	if(decomp == NULL)
-	{
-		/* cannot print a trace without a valid decompressor */
-		goto error;
-	}
-
-	/* new MRRU value must be in range [0, ROHC_MAX_MRRU] */
-	if(mrru > ROHC_MAX_MRRU)
+	/* decompressor must be valid */
+	if(decomp == NULL)
 	{
-		rohc_warning(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
-		             "unexpected MRRU value: must be in range [0, %d]",
-		             ROHC_MAX_MRRU);
+		/* cannot print a trace without a valid decompressor */
 		goto error;
 	}
 
-	/* set new MRRU */
-	decomp->mrru = mrru;
+	decomp->crc_repair_ctxt_budget = ctxt_budget;
+	decomp->crc_repair_global_budget = global_budget;
 	rohc_debug(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
-	           "MRRU is now set to %zd", decomp->mrru);
+	           "CRC repair budgets are now set to %zu repairs per context and "
+	           "%zu repairs for all contexts per second (0 for no limit)",
+	           decomp->crc_repair_ctxt_budget, decomp->crc_repair_global_budget);
 
 	return true;
 
@@ -2831,45 +6885,34 @@ error:
 
 
 /**
- * @brief Get the Maximum Reconstructed Reception Unit (MRRU).
- *
- * Get the current Maximum Reconstructed Reception Unit (MRRU).
- *
- * The MRRU is the largest cumulative length (in bytes) of the ROHC segments
- * that are parts of the same ROHC packet. In short, the ROHC decompressor
- * does not expect to reassemble ROHC segments whose total length is larger
- * than MRRU. So, the ROHC compressor shall not segment ROHC packets greater
- * than the MRRU.
- *
- * The MRRU value must be in range [0 ; \ref ROHC_MAX_MRRU]. Remember that the
- * MRRU includes the 32-bit CRC that protects it.
- * If MRRU value is 0, segmentation is disabled.
+ * @brief Get the budgets of repairs upon CRC failure
  *
- * If segmentation is enabled and used by the compressor, the function
- * \ref rohc_decompress3 will return ROHC_OK and one empty uncompressed packet
- * upon decompression until the last segment is received (or a non-segment is
- * received). Decompressed data will be returned at that time.
+ * See \ref rohc_decomp_set_crc_repair_budget for details.
  *
- * @param decomp     The ROHC decompressor
- * @param[out] mrru  The current MRRU value (in bytes)
- * @return           true if MRRU was successfully retrieved, false otherwise
+ * @param decomp              The ROHC decompressor
+ * @param[out] ctxt_budget    The max number of repairs per context and per
+ *                            second, 0 for no limit
+ * @param[out] global_budget  The max number of repairs per second for all
+ *                            contexts, 0 for no limit
+ * @return                    true if the budgets were successfully retrieved,
+ *                            false otherwise
  *
  * @ingroup rohc_decomp
  *
- * @see rohc_decomp_set_mrru
- * @see rohc_decompress3
- * @see rohc_comp_set_mrru
- * @see rohc_comp_get_mrru
+ * @see rohc_decomp_set_crc_repair_budget
  */
-bool rohc_decomp_get_mrru(const struct rohc_decomp *const decomp,
-                          size_t *const mrru)
+bool rohc_decomp_get_crc_repair_budget(const struct rohc_decomp *const decomp,
+                                       size_t *const ctxt_budget,
+                                       size_t *const global_budget)
 {
-	if(decomp == NULL || mrru == NULL)
+	if(decomp == NULL || ctxt_budget == NULL || global_budget == NULL)
 	{
 		goto error;
 	}
 
-	*mrru = decomp->mrru;
+	*ctxt_budget = decomp->crc_repair_ctxt_budget;
+	*global_budget = decomp->crc_repair_global_budget;
+
 	return true;
 
 error:
@@ -2878,50 +6921,39 @@ error:
 
 
 /**
- * @brief Set the number of packets sent during one Round-Trip Time (RTT).
- *
- * Set the maximum number of packets sent in worst case by the remote ROHC
- * compressor for one given stream (ie. one compression/decompression context)
- * during one Round-Trip Time (RTT).
- *
- * The number of packets sent by the remote ROHC compressor is used to estimate
- * how many SN bits those feedbacks shall transmit to avoid any ambiguity at
- * compressor about the ROHC packet that is (n)acknowledged by the decompressor.
+ * @brief Set the reorder window of the decompression contexts
+ *
+ * On links that reorder packets, a late UO packet may carry too few SN bits
+ * to be decoded against the SN of the latest packet: the decoded SN is
+ * wrong, the CRC check fails, and the packet is lost or the CRC repair is
+ * attempted.
+ *
+ * With a reorder window, every decompression context keeps the
+ * \e refs_nr previous references of the SN. Upon CRC failure, the packet
+ * is decoded again against those previous references, the most recent
+ * first, before any CRC repair is attempted. Only the packets protected by
+ * a 7-bit or 8-bit CRC are decoded again, and only to a SN newer than the
+ * oldest reference that was never received. A late packet decoded this
+ * way does not change the references of the context. It is counted in the
+ * \e late_pkts_decoded statistics.
+ *
+ * The window applies to the contexts of the IP-only, UDP, UDP-Lite, RTP
+ * and ESP profiles. The window is 0 by default: the late packets are
+ * decoded against the latest SN only.
  *
- * The pRTT value must be in range [0 ; SIZE_MAX/2[. If set to 0, all SN bits
- * are always transmitted.
- *
- * The default value is 50 packets / RTT, ie. a RTT of 1 second with one packet
- * transmitted every 20 milliseconds (classic VoIP stream). If your network
- * streams and conditions differ, change the default value.
- *
- * @param decomp  The ROHC decompressor
- * @param prtt    The number of packets sent during one RTT
- * @return        true if the new value was successfully set, false otherwise
+ * @param decomp   The ROHC decompressor
+ * @param refs_nr  The number of previous SN references to keep, 0 to
+ *                 disable the window, at most 8
+ * @return         true if the window was successfully set,
+ *                 false otherwise
  *
  * @ingroup rohc_decomp
  *
- * \par Example:
- * \snippet test_feedback2.c define ROHC decompressor
- * \code
-        rohc_cid_type_t cid_type = ROHC_SMALL_CID;
-        rohc_cid_t max_cid = ROHC_SMALL_CID_MAX;
-        ...
-\endcode
- * \snippet test_feedback2.c create ROHC decompressor
- * \code
-        ...
-\endcode
- * \snippet test_feedback2.c set decompressor pRTT
- * \code
-        ...
-\endcode
- *
- * @see rohc_decomp_get_prtt
- * @see rohc_decompress3
+ * @see rohc_decomp_get_reorder_window
+ * @see rohc_decomp_set_crc_repair_budget
  */
-bool rohc_decomp_set_prtt(struct rohc_decomp *const decomp,
-                          const size_t prtt)
+bool rohc_decomp_set_reorder_window(struct rohc_decomp *const decomp,
+                                    const size_t refs_nr)
 {
 	/* decompressor must be valid */
 	if(decomp == NULL)
@@ -2930,29 +6962,19 @@ bool rohc_decomp_set_prtt(struct rohc_decomp *const decomp,
 		goto error;
 	}
 
-	/* new pRTT must be in range [0, SIZE_MAX] */
-	if(prtt >= (SIZE_MAX / 2))
+	if(refs_nr > ROHC_DECOMP_REORDER_WINDOW_MAX)
 	{
-		rohc_warning(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
-		             "unexpected pRTT value: must be in range [0, %zu]",
-		             SIZE_MAX);
+		rohc_error(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+		           "failed to set reorder window: %zu previous references "
+		           "requested, %u at most", refs_nr,
+		           ROHC_DECOMP_REORDER_WINDOW_MAX);
 		goto error;
 	}
 
-	/* set new pRTT */
-	decomp->prtt = prtt;
+	decomp->reorder_window = refs_nr;
 	rohc_debug(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
-	           "pRTT is now set to %zu", decomp->prtt);
-
-	/* compute the minimum number of SN bits to transmit to the remote
-	 * compressor in the positive or negative feedbacks in order to avoid
-	 * any ambiguity at compressor about the ROHC packet that is
-	 * (n)acknowledged by the decompressor */
-	decomp->sn_feedback_min_bits = sizeof(uint32_t) * 8;
-	if(decomp->prtt != 0)
-	{
-		decomp->sn_feedback_min_bits -= __builtin_clz(decomp->prtt);
-	}
+	           "late packets are now decoded against up to %zu previous SN "
+	           "references", decomp->reorder_window);
 
 	return true;
 
@@ -2962,41 +6984,30 @@ error:
 
 
 /**
- * @brief Get the number of packets sent during one Round-Trip Time (RTT).
- *
- * Get the maximum number of packets sent in worst case by the remote ROHC
- * compressor for one given stream (ie. one compression/decompression context)
- * during one Round-Trip Time (RTT).
- *
- * The number of packets sent by the remote ROHC compressor is used to estimate
- * how many SN bits those feedbacks shall transmit to avoid any ambiguity at
- * compressor about the ROHC packet that is (n)acknowledged by the decompressor.
- *
- * The pRTT value must be in range [0 ; SIZE_MAX/2[. If set to 0, all SN bits
- * are always transmitted.
+ * @brief Get the reorder window of the decompression contexts
  *
- * The default value is 50 packets / RTT, ie. a RTT of 1 second with one packet
- * transmitted every 20 milliseconds (classic VoIP stream). If your network
- * streams and conditions differ, change the default value.
+ * See \ref rohc_decomp_set_reorder_window for details.
  *
- * @param decomp     The ROHC decompressor
- * @param[out] prtt  The number of packets sent during one RTT
- * @return           true if pRTT was successfully retrieved, false otherwise
+ * @param decomp       The ROHC decompressor
+ * @param[out] refs_nr  The number of previous SN references kept, 0 if the
+ *                      window is disabled
+ * @return              true if the window was successfully retrieved,
+ *                      false otherwise
  *
  * @ingroup rohc_decomp
  *
- * @see rohc_decomp_set_prtt
- * @see rohc_decompress3
+ * @see rohc_decomp_set_reorder_window
  */
-bool rohc_decomp_get_prtt(const struct rohc_decomp *const decomp,
-                          size_t *const prtt)
+bool rohc_decomp_get_reorder_window(const struct rohc_decomp *const decomp,
+                                    size_t *const refs_nr)
 {
-	if(decomp == NULL || prtt == NULL)
+	if(decomp == NULL || refs_nr == NULL)
 	{
 		goto error;
 	}
 
-	*prtt = decomp->prtt;
+	*refs_nr = decomp->reorder_window;
+
 	return true;
 
 error:
@@ -3005,72 +7016,42 @@ error:
 
 
 /**
- * @brief Set the rate limits for feedbacks
- *
- * Set the rate limits for positive feedbacks (ACK) and negative feedbacks (NACK
- * and STATIC-NACK).
- *
- * There are 3 different rate limits:
- *  \li the rate limit to avoid sending the same type of feedback too often:
- *      it applies to all feedback types (ACK, NACK, STATIC-NACK) and it is
- *      specified by the parameters \e k and \e n ;
- *  \li the rate limit to avoid sending NACKs too quickly after a sporadic CRC
- *      failure: it is specified by the parameters \e k_1 and \e n_1 ;
- *  \li the rate limit to avoid sending STATIC-NACKs too quickly after a sporadic
- *      CRC failure: it is specified by the parameters \e k_2 and \e n_2 ;
- *
- * In all 3 cases above, the \e k/k_1/k_2 and \e n/n_1/n_2 parameters define
- * 3 ratios of packets:
- *  \li a feedback is sent every \e k packets out of \e n packets that cause
- *      the same feedback type to be sent ;
- *  \li a NACK is not sent before \e k_1 packets out of \e n_1 packets failed
- *      because of a CRC failure in the Full Context state ;
- *  \li a STATIC-NACK is not sent before \e k_1 packets out of \e n_1 packets
- *      failed because of a CRC failure in the Static Context state ;
- *
- * The default values are:
- *  \li k   =  1 and n   = default pRTT (see rohc_decomp_set_prtt for details)
- *  \li k_1 = 30 and n_1 = 100, ie. 30%
- *  \li k_2 = 30 and n_2 = 100, ie. 30%
- *
- * If your network streams and conditions differ, change the default value.
- *
- * The n/n_1/n_2 values shall not be zero.
+ * @brief Set the policy to choose the operational mode of the contexts
+ *
+ * With the \ref ROHC_DECOMP_MODE_FIXED policy, all the contexts target the
+ * mode given at decompressor creation. This is the default policy.
+ *
+ * With the \ref ROHC_DECOMP_MODE_ADAPTIVE policy, every context picks its
+ * own mode from the packets it measured, without any help from the user:
+ *  \li a context in U-mode moves to O-mode as soon as at least k packets
+ *      out of n failed to be decompressed (the ratio is evaluated over the
+ *      last 32 packets of the context), so that NACKs repair the context
+ *      instead of the periodic refreshes of the compressor,
+ *  \li a context in O-mode moves back to U-mode once it decompressed both
+ *      32 packets and 2 pRTTs of packets in a row without any error, so
+ *      that a clean link does not pay for feedback.
+ *
+ * The mode transitions are sent to the compressor within the feedbacks. The
+ * adaptive policy applies to the contexts of the IP-only, UDP, UDP-Lite, RTP
+ * and ESP profiles: the feedbacks of the other profiles cannot carry the
+ * mode, their contexts keep the mode given at decompressor creation.
  *
  * @param decomp  The ROHC decompressor
- * @param k       The k rate-limit parameter to avoid sending feedback too often
- * @param n       The n rate-limit parameter to avoid sending feedback too often
- * @param k_1     The k_1 rate-limit parameter to avoid sending NACKs too quickly
- * @param n_1     The n_1 rate-limit parameter to avoid sending NACKs too quickly
- * @param k_2     The k_2 rate-limit parameter to avoid sending STATIC-NACKs too quickly
- * @param n_2     The n_2 rate-limit parameter to avoid sending STATIC-NACKs too quickly
- * @return        true if the new values were successfully set, false otherwise
+ * @param policy  The policy to choose the operational mode of the contexts
+ * @param k       The k parameter of the error rate that moves one context
+ *                to O-mode with the adaptive policy
+ * @param n       The n parameter of the error rate that moves one context
+ *                to O-mode with the adaptive policy, shall not be 0
+ * @return        true if the policy was successfully set, false otherwise
  *
  * @ingroup rohc_decomp
  *
- * \par Example:
- * \snippet test_lost_packet.c define ROHC decompressor
- * \code
-        ...
-\endcode
- * \snippet test_lost_packet.c create ROHC decompressor
- * \code
-        ...
-\endcode
- * \snippet test_lost_packet.c set decompressor rate limits
- * \code
-        ...
-\endcode
- *
- * @see rohc_decomp_get_rate_limits
+ * @see rohc_decomp_get_mode_policy
  * @see rohc_decomp_set_prtt
- * @see rohc_decomp_get_prtt
- * @see rohc_decompress3
  */
-bool rohc_decomp_set_rate_limits(struct rohc_decomp *const decomp,
-                                 const size_t k, const size_t n,
-                                 const size_t k_1, const size_t n_1,
-                                 const size_t k_2, const size_t n_2)
+bool rohc_decomp_set_mode_policy(struct rohc_decomp *const decomp,
+                                 const rohc_decomp_mode_policy_t policy,
+                                 const size_t k, const size_t n)
 {
 	/* decompressor must be valid */
 	if(decomp == NULL)
@@ -3079,38 +7060,31 @@ bool rohc_decomp_set_rate_limits(struct rohc_decomp *const decomp,
 		goto error;
 	}
 
-	/* n values are used as divisors */
-	if(n == 0 || n_1 == 0 || n_2 == 0)
+	if(policy != ROHC_DECOMP_MODE_FIXED && policy != ROHC_DECOMP_MODE_ADAPTIVE)
 	{
 		rohc_warning(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
-		             "rate-limits n/n_1/n_2 shall not be 0");
+		             "unknown policy of operational modes %d", policy);
 		goto error;
 	}
 
-	/* set new rate-limits */
-	decomp->ack_rate_limits.speed.k = k;
-	decomp->ack_rate_limits.speed.n = n;
-	decomp->ack_rate_limits.nack.k = k_1;
-	decomp->ack_rate_limits.nack.n = n_1;
-	decomp->ack_rate_limits.static_nack.k = k_2;
-	decomp->ack_rate_limits.static_nack.n = n_2;
+	/* n is used as divisor */
+	if(n == 0)
+	{
+		rohc_warning(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+		             "error rate n shall not be 0");
+		goto error;
+	}
 
-	/* compute the rate-limit thresholds */
-	decomp->ack_rate_limits.speed.threshold =
-		decomp->ack_rate_limits.speed.k * 32 * 100 / decomp->ack_rate_limits.speed.n;
-	decomp->ack_rate_limits.nack.threshold =
-		decomp->ack_rate_limits.nack.k * 32 * 100 / decomp->ack_rate_limits.nack.n;
-	decomp->ack_rate_limits.static_nack.threshold =
-		decomp->ack_rate_limits.static_nack.k * 32 * 100 /
-		decomp->ack_rate_limits.static_nack.n;
+	decomp->mode_policy = policy;
+	decomp->mode_errors.k = k;
+	decomp->mode_errors.n = n;
+	decomp->mode_errors.threshold = k * 32 * 100 / n;
+	decomp->mode_errors.pkts_nr = (decomp->mode_errors.threshold + 99) / 100;
 
 	rohc_debug(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
-	           "rate-limits are now set to: %zu/%zu (all), %zu/%zu (NACK), "
-	           "%zu/%zu (STATIC-NACK)",
-	           decomp->ack_rate_limits.speed.k, decomp->ack_rate_limits.speed.n,
-	           decomp->ack_rate_limits.nack.k, decomp->ack_rate_limits.nack.n,
-	           decomp->ack_rate_limits.static_nack.k,
-	           decomp->ack_rate_limits.static_nack.n);
+	           "operational modes are now %s (O-mode from %zu/%zu errors)",
+	           policy == ROHC_DECOMP_MODE_FIXED ? "fixed" : "adaptive",
+	           decomp->mode_errors.k, decomp->mode_errors.n);
 
 	return true;
 
@@ -3120,72 +7094,36 @@ error:
 
 
 /**
- * @brief Get the rate limits for feedbacks currently configured
- *
- * Get the rate limits for positive feedbacks (ACK) and negative feedbacks (NACK
- * and STATIC-NACK).
- *
- * There are 3 different rate limits:
- *  \li the rate limit to avoid sending the same type of feedback too often:
- *      it applies to all feedback types (ACK, NACK, STATIC-NACK) and it is
- *      specified by the parameters \e k and \e n ;
- *  \li the rate limit to avoid sending NACKs too quickly after a sporadic CRC
- *      failure: it is specified by the parameters \e k_1 and \e n_1 ;
- *  \li the rate limit to avoid sending STATIC-NACKs too quickly after a sporadic
- *      CRC failure: it is specified by the parameters \e k_2 and \e n_2 ;
- *
- * In all 3 cases above, the \e k/k_1/k_2 and \e n/n_1/n_2 parameters define
- * 3 ratios of packets:
- *  \li a feedback is sent every \e k packets out of \e n packets that cause
- *      the same feedback type to be sent ;
- *  \li a NACK is not sent before \e k_1 packets out of \e n_1 packets failed
- *      because of a CRC failure in the Full Context state ;
- *  \li a STATIC-NACK is not sent before \e k_1 packets out of \e n_1 packets
- *      failed because of a CRC failure in the Static Context state ;
- *
- * The default values are:
- *  \li k   =  1 and n   = default pRTT (see rohc_decomp_set_prtt for details)
- *  \li k_1 = 30 and n_1 = 100, ie. 30%
- *  \li k_2 = 30 and n_2 = 100, ie. 30%
- *
- * If your network streams and conditions differ, change the default value.
- *
- * @param decomp    The ROHC decompressor
- * @param[out] k    The k rate-limit parameter to avoid sending feedback too often
- * @param[out] n    The n rate-limit parameter to avoid sending feedback too often
- * @param[out] k_1  The k_1 rate-limit param. to avoid sending NACKs too quickly
- * @param[out] n_1  The n_1 rate-limit param. to avoid sending NACKs too quickly
- * @param[out] k_2  The k_2 rate-limit param. to avoid sending STATIC-NACKs too quickly
- * @param[out] n_2  The n_2 rate-limit param. to avoid sending STATIC-NACKs too quickly
- * @return          true if rate-limits were successfully retrieved,
- *                  false otherwise
+ * @brief Get the policy to choose the operational mode of the contexts
  *
- * @ingroup rohc_decomp
+ * See \ref rohc_decomp_set_mode_policy for details.
  *
- * @see rohc_decomp_set_rate_limits
- * @see rohc_decomp_set_prtt
- * @see rohc_decomp_get_prtt
- * @see rohc_decompress3
+ * @param decomp       The ROHC decompressor
+ * @param[out] policy  The policy to choose the operational mode of the
+ *                     contexts
+ * @param[out] k       The k parameter of the error rate that moves one
+ *                     context to O-mode with the adaptive policy
+ * @param[out] n       The n parameter of the error rate that moves one
+ *                     context to O-mode with the adaptive policy
+ * @return             true if the policy was successfully retrieved,
+ *                     false otherwise
+ *
+ * @ingroup rohc_decomp
+ *
+ * @see rohc_decomp_set_mode_policy
  */
-bool rohc_decomp_get_rate_limits(const struct rohc_decomp *const decomp,
-                                 size_t *const k, size_t *const n,
-                                 size_t *const k_1, size_t *const n_1,
-                                 size_t *const k_2, size_t *const n_2)
+bool rohc_decomp_get_mode_policy(const struct rohc_decomp *const decomp,
+                                 rohc_decomp_mode_policy_t *const policy,
+                                 size_t *const k, size_t *const n)
 {
-	if(decomp == NULL ||
-	   k == NULL || n == NULL ||
-	   k_1 == NULL || n_1 == NULL ||
-	   k_2 == NULL || n_2 == NULL)
+	if(decomp == NULL || policy == NULL || k == NULL || n == NULL)
 	{
 		goto error;
 	}
 
-	*k = decomp->ack_rate_limits.speed.k;
-	*n = decomp->ack_rate_limits.speed.n;
-	*k_1 = decomp->ack_rate_limits.nack.k;
-	*n_1 = decomp->ack_rate_limits.nack.n;
-	*n_2 = decomp->ack_rate_limits.static_nack.n;
-	*k_2 = decomp->ack_rate_limits.static_nack.k;
+	*policy = decomp->mode_policy;
+	*k = decomp->mode_errors.k;
+	*n = decomp->mode_errors.n;
 
 	return true;
 
@@ -3203,9 +7141,18 @@ error:
  * Available features are listed by \ref rohc_decomp_features_t. They may be
  * combined by XOR'ing them together.
  *
+ * With \ref ROHC_DECOMP_FEATURE_REALTIME, the worst-case cost of one packet
+ * is the parsing of its header, two decodings of the extracted bits and two
+ * builds of the uncompressed headers with their CRC, and the copy of the
+ * payload. The lists of IPv6 extension headers, CSRC items and TCP options
+ * hold 15 items at most, so their decoding is bounded too. The worst case
+ * may be measured with the histograms of \ref rohc_decomp_get_timings, the
+ * CRC failures that were not decoded again are counted in the
+ * \e rt_attempts_capped general information.
+ *
  * @warning Changing the feature set while library is used is not supported
  *
- * @param decomp    The ROHC decompressor
+ * @param decomp   The ROHC decompressor
  * @param features  The feature set to enable/disable
  * @return          true if the feature set was successfully enabled/disabled,
  *                  false if a problem occurred
@@ -3219,6 +7166,10 @@ bool rohc_decomp_set_features(struct rohc_decomp *const decomp,
 {
 	const rohc_decomp_features_t all_features =
 		ROHC_DECOMP_FEATURE_CRC_REPAIR |
+#ifdef ROHC_TIMINGS
+		ROHC_DECOMP_FEATURE_TIMINGS |
+#endif
+		ROHC_DECOMP_FEATURE_REALTIME |
 		ROHC_DECOMP_FEATURE_DUMP_PACKETS;
 
 	/* decompressor must be valid */
@@ -3247,6 +7198,98 @@ error:
 }
 
 
+/**
+ * @brief Set the callback for the events of the lifecycle of the contexts
+ *
+ * The callback is called when one decompression context is created,
+ * destroyed, changes of state or mode, or when one packet fails to be
+ * decompressed, see \ref rohc_decomp_event_t. It is called only when the
+ * events happen: the packets that change nothing do not pay for it, unlike
+ * the polling of \ref rohc_decomp_get_last_packet_info after every packet.
+ *
+ * @param decomp     The ROHC decompressor
+ * @param callback   The callback for the events, NULL to disable it
+ * @param priv_ctxt  An optional private context given to the callback,
+ *                   may be NULL
+ * @return           true on success, false if the decompressor is invalid
+ *
+ * @ingroup rohc_decomp
+ *
+ * @see rohc_decomp_event_callback_t
+ */
+bool rohc_decomp_set_event_cb(struct rohc_decomp *const decomp,
+                              rohc_decomp_event_callback_t callback,
+                              void *const priv_ctxt)
+{
+	if(decomp == NULL)
+	{
+		goto error;
+	}
+
+	decomp->event_cb = callback;
+	decomp->event_cb_priv = priv_ctxt;
+
+	return true;
+
+error:
+	return false;
+}
+
+
+/**
+ * @brief Enable, resize or disable the log of the last decompressed packets
+ *
+ * Once enabled, the decompressor writes one compact binary record for every
+ * packet it decompresses or fails to decompress: the CID, the profile, the
+ * ROHC packet type, the SN of the last packet decompressed in the context
+ * and the decompression status, that tells the packets that failed the CRC
+ * check. The log is a ring of \e records_nr records: the oldest records are
+ * overwritten by the newest ones. Writing one record costs a few stores, so
+ * the log may be left enabled when the traces are not. The log may be
+ * retrieved with \ref rohc_decomp_get_pkt_log on demand, or on error from
+ * the callback of the \ref ROHC_DECOMP_EVENT_FAILURE events, that is called
+ * once the failed packet is recorded.
+ *
+ * The records already in the log are dropped. The log is disabled by
+ * default.
+ *
+ * @param decomp      The ROHC decompressor
+ * @param records_nr  The number of records of the log, a power of 2, or 0 to
+ *                    disable the log
+ * @return            true if the log was enabled, resized or disabled,
+ *                    false if the number of records is not a power of 2 or
+ *                    if an error occurs
+ *
+ * @ingroup rohc_decomp
+ *
+ * @see rohc_decomp_get_pkt_log
+ */
+bool rohc_decomp_set_pkt_log(struct rohc_decomp *const decomp,
+                             const size_t records_nr)
+{
+	if(decomp == NULL)
+	{
+		goto error;
+	}
+
+	if(!rohc_pkt_log_set_size(&decomp->pkt_log, records_nr))
+	{
+		rohc_warning(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+		             "failed to set a log of %zu packets: the number of "
+		             "records shall be a power of 2", records_nr);
+		goto error;
+	}
+
+	rohc_info(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+	          "log of the last %zu packets", records_nr);
+
+	return true;
+
+error:
+	return false;
+}
+
+
 /**
  * @brief Is the given decompression profile enabled for a decompressor?
  *
@@ -3277,14 +7320,7 @@ bool rohc_decomp_profile_enabled(const struct rohc_decomp *const decomp,
 	}
 
 	/* search the profile location */
-	for(i = 0; i < D_NUM_PROFILES; i++)
-	{
-		if(rohc_decomp_profiles[i]->id == profile)
-		{
-			/* found */
-			break;
-		}
-	}
+	i = rohc_decomp_profile_idx(profile);
 
 	if(i == D_NUM_PROFILES)
 	{
@@ -3313,10 +7349,19 @@ error:
  * If the profile is already enabled, nothing is performed and success is
  * reported.
  *
+ * The first time a profile is enabled, the decompressor allocates the scratch
+ * memory that all the contexts of the profile use to decode their packets.
+ *
+ * The ROHCv1 and ROHCv2 variants of one profile cannot be enabled at the
+ * same time: the IR packets carry the 8 LSB of the profile ID only, so the
+ * decompressor could not tell them apart.
+ *
  * @param decomp   The ROHC decompressor
  * @param profile  The profile to enable
  * @return         true if the profile exists,
- *                 false if the profile does not exist
+ *                 false if the profile does not exist, if the other variant
+ *                 of the profile is already enabled or in case of memory
+ *                 allocation failure
  *
  * @ingroup rohc_decomp
  *
@@ -3337,6 +7382,7 @@ error:
 bool rohc_decomp_enable_profile(struct rohc_decomp *const decomp,
                                 const rohc_profile_t profile)
 {
+	size_t other_i;
 	size_t i;
 
 	if(decomp == NULL)
@@ -3345,14 +7391,7 @@ bool rohc_decomp_enable_profile(struct rohc_decomp *const decomp,
 	}
 
 	/* search the profile location */
-	for(i = 0; i < D_NUM_PROFILES; i++)
-	{
-		if(rohc_decomp_profiles[i]->id == profile)
-		{
-			/* found */
-			break;
-		}
-	}
+	i = rohc_decomp_profile_idx(profile);
 
 	if(i == D_NUM_PROFILES)
 	{
@@ -3361,6 +7400,34 @@ bool rohc_decomp_enable_profile(struct rohc_decomp *const decomp,
 		goto error;
 	}
 
+	/* the other ROHC version of the profile shall not be enabled */
+	other_i = rohc_decomp_profile_idx(profile ^ 0x0100);
+	if(other_i < D_NUM_PROFILES && decomp->enabled_profiles[other_i])
+	{
+		rohc_warning(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+		             "ROHC decompression profile (ID = %d) cannot be enabled "
+		             "along with profile (ID = %d)", profile, profile ^ 0x0100);
+		goto error;
+	}
+
+	/* allocate the scratch memory of the profile, zeroed so that the profile
+	 * finds nothing to reset for the very first packet */
+	if(decomp->volat_scratch[i] == NULL)
+	{
+		const struct rohc_decomp_profile *const p = rohc_decomp_profiles[i];
+
+		decomp->volat_scratch[i] =
+			rohc_calloc(1, ROHC_CTXT_ARENA_SIZE(p->extr_bits_len) +
+			          ROHC_CTXT_ARENA_SIZE(p->decoded_len));
+		if(decomp->volat_scratch[i] == NULL)
+		{
+			rohc_warning(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+			             "failed to allocate the scratch memory of the ROHC "
+			             "decompression profile (ID = %d)", profile);
+			goto error;
+		}
+	}
+
 	/* mark the profile as enabled */
 	decomp->enabled_profiles[i] = true;
 	rohc_info(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
@@ -3407,14 +7474,7 @@ bool rohc_decomp_disable_profile(struct rohc_decomp *const decomp,
 	}
 
 	/* search the profile location */
-	for(i = 0; i < D_NUM_PROFILES; i++)
-	{
-		if(rohc_decomp_profiles[i]->id == profile)
-		{
-			/* found */
-			break;
-		}
-	}
+	i = rohc_decomp_profile_idx(profile);
 
 	if(i == D_NUM_PROFILES)
 	{
@@ -3487,16 +7547,186 @@ bool rohc_decomp_enable_profiles(struct rohc_decomp *const decomp,
 
 	while((profile_id = va_arg(profiles, int)) >= 0)
 	{
-		is_ok = rohc_decomp_enable_profile(decomp, profile_id);
-		if(!is_ok)
-		{
-			err_nr++;
-		}
+		is_ok = rohc_decomp_enable_profile(decomp, profile_id);
+		if(!is_ok)
+		{
+			err_nr++;
+		}
+	}
+
+	va_end(profiles);
+
+	return (err_nr == 0);
+
+error:
+	return false;
+}
+
+
+/**
+ * @brief Disable several decompression profiles for a decompressor
+ *
+ * Disable several decompression profiles for a decompressor. The list of
+ * profiles to disable shall stop with -1.
+ *
+ * The ROHC decompressor does not use the decompression profiles that were
+ * disabled. Thus disabling a profile might cause the decompressor to reject
+ * streams. Decompression will always fail if no profile at all is enabled.
+ *
+ * If one or more of the profiles are already disabled, nothing is performed
+ * and success is reported.
+ *
+ * @param decomp  The ROHC decompressor
+ * @param ...     The sequence of decompression profiles to disable, the
+ *                sequence shall be terminated by -1
+ * @return        true if all of the profiles exist,
+ *                false if at least one of the profiles does not exist
+ *
+ * @ingroup rohc_decomp
+ *
+ * @see rohc_decomp_enable_profile
+ * @see rohc_decomp_enable_profiles
+ * @see rohc_decomp_disable_profile
+ */
+bool rohc_decomp_disable_profiles(struct rohc_decomp *const decomp,
+                                  ...)
+{
+	va_list profiles;
+	int profile_id;
+	size_t err_nr = 0;
+	bool is_ok;
+
+	if(decomp == NULL)
+	{
+		goto error;
+	}
+
+	va_start(profiles, decomp);
+
+	while((profile_id = va_arg(profiles, int)) >= 0)
+	{
+		is_ok = rohc_decomp_disable_profile(decomp, profile_id);
+		if(!is_ok)
+		{
+			err_nr++;
+		}
+	}
+
+	va_end(profiles);
+
+	return (err_nr == 0);
+
+error:
+	return false;
+}
+
+
+/**
+ * @brief Set the callback function used to manage traces in decompressor
+ *
+ * Set the user-defined callback function used to manage traces in the
+ * decompressor.
+ *
+ * The function will be called by the ROHC library every time it wants to
+ * print something related to decompression, from errors to debug. User may
+ * thus decide what traces are interesting (filter on \e level, source
+ * \e entity, or \e profile) and what to do with them (print on console,
+ * storage in file, syslog...).
+ *
+ * @warning The callback can not be modified after library initialization
+ *
+ * @param decomp     The ROHC decompressor
+ * @param callback   Two possible cases:
+ *                     \li The callback function used to manage traces
+ *                     \li NULL to remove the previous callback
+ * @param priv_ctxt  An optional private context, may be NULL
+ * @return           true on success, false otherwise
+ *
+ * @ingroup rohc_decomp
+ */
+bool rohc_decomp_set_traces_cb2(struct rohc_decomp *decomp,
+                                rohc_trace_callback2_t callback,
+                                void *const priv_ctxt)
+{
+	/* check decompressor validity */
+	if(decomp == NULL)
+	{
+		/* cannot print a trace without a valid decompressor */
+		goto error;
+	}
+
+	/* refuse to set a new trace callback if decompressor is in use */
+	if(decomp->stats.received > 0)
+	{
+		rohc_error(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL, "unable to "
+		           "modify the trace callback after initialization");
+		goto error;
+	}
+
+	/* replace current trace callback by the new one */
+	decomp->trace_callback = callback;
+	decomp->trace_callback_priv = priv_ctxt;
+
+	return true;
+
+error:
+	return false;
+}
+
+
+/**
+ * @brief Set the minimum level of the traces of the decompressor
+ *
+ * Set the minimum level of the traces that the decompressor gives to the
+ * callback set with \ref rohc_decomp_set_traces_cb2. The traces below the
+ * given level are skipped before their arguments are formatted, the packet
+ * dumps of lower levels are skipped entirely.
+ *
+ * All traces are given to the callback by default.
+ *
+ * The traces removed at build time (see the --enable-rohc-trace-level
+ * configure option) are never given to the callback, whatever the level
+ * set with this function.
+ *
+ * @warning The level can not be modified after library initialization
+ *
+ * @param decomp  The ROHC decompressor
+ * @param level   The minimum level of the traces to give to the callback
+ * @return        true on success, false otherwise
+ *
+ * @ingroup rohc_decomp
+ *
+ * @see rohc_decomp_set_traces_cb2
+ */
+bool rohc_decomp_set_trace_level(struct rohc_decomp *const decomp,
+                                 const rohc_trace_level_t level)
+{
+	/* check decompressor validity */
+	if(decomp == NULL)
+	{
+		goto error;
+	}
+
+	/* check the trace level */
+	if(level >= ROHC_TRACE_LEVEL_MAX)
+	{
+		rohc_warning(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+		             "unexpected trace level %d", level);
+		goto error;
+	}
+
+	/* refuse to set a new trace level if decompressor is in use */
+	if(decomp->stats.received > 0)
+	{
+		rohc_error(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL, "unable to "
+		           "modify the trace level after initialization");
+		goto error;
 	}
 
-	va_end(profiles);
+	decomp->trace_level = level;
+	decomp->trace_sampled_level = level;
 
-	return (err_nr == 0);
+	return true;
 
 error:
 	return false;
@@ -3504,57 +7734,46 @@ error:
 
 
 /**
- * @brief Disable several decompression profiles for a decompressor
+ * @brief Trace one packet every N packets only
  *
- * Disable several decompression profiles for a decompressor. The list of
- * profiles to disable shall stop with -1.
+ * Restrict the traces of the decompressor to one packet every \e one_in_n
+ * packets, or to the warnings and errors only, so that the traces may be
+ * enabled on a loaded system without collapsing the throughput. The traces
+ * of the packets that are not sampled are skipped before their arguments
+ * are formatted, and so are their packet dumps.
  *
- * The ROHC decompressor does not use the decompression profiles that were
- * disabled. Thus disabling a profile might cause the decompressor to reject
- * streams. Decompression will always fail if no profile at all is enabled.
+ * The warnings and errors are mostly emitted by the packets that end in
+ * error, \e errors_only thus traces the failing packets without the debug
+ * traces of all the other packets.
  *
- * If one or more of the profiles are already disabled, nothing is performed
- * and success is reported.
+ * Every packet is traced by default. Unlike the trace level, the sampling
+ * may be changed at any time, but not while packets are being processed by
+ * another thread.
  *
- * @param decomp  The ROHC decompressor
- * @param ...     The sequence of decompression profiles to disable, the
- *                sequence shall be terminated by -1
- * @return        true if all of the profiles exist,
- *                false if at least one of the profiles does not exist
+ * @param decomp       The ROHC decompressor
+ * @param one_in_n     Trace 1 packet every \e one_in_n packets, 0 or 1 to
+ *                     trace every packet
+ * @param errors_only  Whether to trace the warnings and errors only
+ * @return             true on success, false otherwise
  *
  * @ingroup rohc_decomp
  *
- * @see rohc_decomp_enable_profile
- * @see rohc_decomp_enable_profiles
- * @see rohc_decomp_disable_profile
+ * @see rohc_decomp_set_trace_cids
+ * @see rohc_decomp_set_trace_level
  */
-bool rohc_decomp_disable_profiles(struct rohc_decomp *const decomp,
-                                  ...)
+bool rohc_decomp_set_trace_sampling(struct rohc_decomp *const decomp,
+                                    const size_t one_in_n,
+                                    const bool errors_only)
 {
-	va_list profiles;
-	int profile_id;
-	size_t err_nr = 0;
-	bool is_ok;
-
 	if(decomp == NULL)
 	{
 		goto error;
 	}
 
-	va_start(profiles, decomp);
-
-	while((profile_id = va_arg(profiles, int)) >= 0)
-	{
-		is_ok = rohc_decomp_disable_profile(decomp, profile_id);
-		if(!is_ok)
-		{
-			err_nr++;
-		}
-	}
-
-	va_end(profiles);
+	decomp->trace_sampling.one_in_n = one_in_n;
+	decomp->trace_sampling.errors_only = errors_only;
 
-	return (err_nr == 0);
+	return true;
 
 error:
 	return false;
@@ -3562,50 +7781,65 @@ error:
 
 
 /**
- * @brief Set the callback function used to manage traces in decompressor
- *
- * Set the user-defined callback function used to manage traces in the
- * decompressor.
+ * @brief Trace the packets of the given CIDs only
  *
- * The function will be called by the ROHC library every time it wants to
- * print something related to decompression, from errors to debug. User may
- * thus decide what traces are interesting (filter on \e level, source
- * \e entity, or \e profile) and what to do with them (print on console,
- * storage in file, syslog...).
+ * Restrict the traces of the decompressor to the packets of the given CIDs, so
+ * that the flows under investigation may be traced on a loaded system
+ * without collapsing the throughput. The traces of the other packets, and
+ * the traces emitted before the CID of a packet is known, are skipped before
+ * their arguments are formatted.
  *
- * @warning The callback can not be modified after library initialization
+ * The packets of all CIDs are traced by default. Unlike the trace level, the
+ * CIDs may be changed at any time, but not while packets are being processed
+ * by another thread.
  *
- * @param decomp     The ROHC decompressor
- * @param callback   Two possible cases:
- *                     \li The callback function used to manage traces
- *                     \li NULL to remove the previous callback
- * @param priv_ctxt  An optional private context, may be NULL
- * @return           true on success, false otherwise
+ * @param decomp   The ROHC decompressor
+ * @param cids     The CIDs to trace, at most \ref ROHC_TRACE_CIDS_MAX
+ * @param cids_nr  The number of CIDs, 0 to trace the packets of all CIDs
+ * @return         true on success, false otherwise
  *
  * @ingroup rohc_decomp
+ *
+ * @see rohc_decomp_set_trace_sampling
  */
-bool rohc_decomp_set_traces_cb2(struct rohc_decomp *decomp,
-                                rohc_trace_callback2_t callback,
-                                void *const priv_ctxt)
+bool rohc_decomp_set_trace_cids(struct rohc_decomp *const decomp,
+                                const rohc_cid_t *const cids,
+                                const size_t cids_nr)
 {
-	/* check decompressor validity */
+	size_t i;
+
 	if(decomp == NULL)
 	{
-		/* cannot print a trace without a valid decompressor */
 		goto error;
 	}
-
-	/* refuse to set a new trace callback if decompressor is in use */
-	if(decomp->stats.received > 0)
+	if(cids_nr > ROHC_TRACE_CIDS_MAX)
 	{
-		rohc_error(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL, "unable to "
-		           "modify the trace callback after initialization");
+		rohc_warning(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+		             "unable to trace more than %u CIDs", ROHC_TRACE_CIDS_MAX);
+		goto error;
+	}
+	if(cids_nr > 0 && cids == NULL)
+	{
+		rohc_warning(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+		             "no CID given");
 		goto error;
 	}
+	for(i = 0; i < cids_nr; i++)
+	{
+		if(cids[i] > decomp->medium.max_cid)
+		{
+			rohc_warning(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+			             "unable to trace CID %zu: MAX_CID is %zu", cids[i],
+			             decomp->medium.max_cid);
+			goto error;
+		}
+	}
 
-	/* replace current trace callback by the new one */
-	decomp->trace_callback = callback;
-	decomp->trace_callback_priv = priv_ctxt;
+	for(i = 0; i < cids_nr; i++)
+	{
+		decomp->trace_sampling.cids[i] = cids[i];
+	}
+	decomp->trace_sampling.cids_nr = cids_nr;
 
 	return true;
 
@@ -3630,17 +7864,10 @@ error:
 static const struct rohc_decomp_profile * find_profile(const struct rohc_decomp *const decomp,
                                                        const rohc_profile_t profile_id)
 {
-	size_t i;
+	const size_t i = rohc_decomp_profile_idx(profile_id);
 
 	assert(decomp != NULL);
 
-	/* search for the profile within the enabled profiles */
-	for(i = 0;
-	    i < D_NUM_PROFILES && rohc_decomp_profiles[i]->id != profile_id;
-	    i++)
-	{
-	}
-
 	if(i >= D_NUM_PROFILES)
 	{
 		rohc_warning(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
@@ -3661,6 +7888,44 @@ static const struct rohc_decomp_profile * find_profile(const struct rohc_decomp
 }
 
 
+/**
+ * @brief Find the location of the ROHC profile with the given profile ID
+ *
+ * @param profile_id  The profile ID to search for
+ * @return            The location of the profile in
+ *                    \ref rohc_decomp_profiles, D_NUM_PROFILES if the
+ *                    profile is unknown
+ */
+static size_t rohc_decomp_profile_idx(const rohc_profile_t profile_id)
+{
+	const unsigned int version = ((unsigned int) profile_id) >> 8;
+	const unsigned int octet = ((unsigned int) profile_id) & 0xff;
+
+	if(version > 1 || octet > ROHC_PROFILE_UDPLITE)
+	{
+		return D_NUM_PROFILES;
+	}
+	return rohc_decomp_profiles_idx[version][octet];
+}
+
+
+/**
+ * @brief Choose the minimum level of the traces for the current packet
+ *
+ * @param decomp     The ROHC decompressor
+ * @param cid_known  Whether the CID of the packet is already known or not
+ * @param cid        The CID of the packet if known
+ */
+static void d_trace_sample(struct rohc_decomp *const decomp,
+                           const bool cid_known,
+                           const rohc_cid_t cid)
+{
+	decomp->trace_sampled_level =
+		rohc_trace_sample(&decomp->trace_sampling, decomp->trace_level,
+		                  decomp->stats.received - 1, cid_known, cid);
+}
+
+
 /**
  * @brief Decode the CID of a packet
  *
@@ -3713,7 +7978,6 @@ static bool rohc_decomp_decode_cid(struct rohc_decomp *decomp,
 	else if(decomp->medium.cid_type == ROHC_LARGE_CID)
 	{
 		uint32_t large_cid;
-		size_t large_cid_bits_nr;
 
 		/* large CID */
 		*add_cid_len = 0;
@@ -3724,8 +7988,8 @@ static bool rohc_decomp_decode_cid(struct rohc_decomp *decomp,
 
 		/* decode SDVL-encoded large CID
 		 * (only 1-byte and 2-byte SDVL fields are allowed) */
-		*large_cid_len = sdvl_decode(packet, len, &large_cid, &large_cid_bits_nr);
-		if((*large_cid_len) != 1 && (*large_cid_len) != 2)
+		*large_cid_len = sdvl_decode_large_cid(packet, len, &large_cid);
+		if((*large_cid_len) == 0)
 		{
 			rohc_warning(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
 			             "failed to decode SDVL-encoded large CID field");
@@ -3751,6 +8015,78 @@ error:
 }
 
 
+/**
+ * @brief Decode the CID of the given ROHC packet without decompressing it
+ *
+ * Padding and feedback items are skipped. The CID of ROHC segments is not
+ * known before the RRU is reassembled.
+ *
+ * @param decomp       The ROHC decompressor
+ * @param rohc_packet  The ROHC packet to get the CID from
+ * @param[out] cid     The CID of the ROHC packet
+ * @return             true if the CID was decoded, false otherwise
+ */
+bool rohc_decomp_peek_cid(const struct rohc_decomp *const decomp,
+                          const struct rohc_buf rohc_packet,
+                          rohc_cid_t *const cid)
+{
+	rohc_decomp_demux_t demux;
+
+	if(!rohc_decomp_demux(decomp, rohc_packet, &demux) ||
+	   demux.pkt_class == ROHC_DECOMP_DEMUX_FEEDBACK ||
+	   demux.pkt_class == ROHC_DECOMP_DEMUX_SEGMENT)
+	{
+		return false;
+	}
+	*cid = demux.cid;
+
+	return true;
+}
+
+
+/**
+ * @brief Copy bytes of a RRU given as a scatter list of segments
+ *
+ * The segment type byte of every segment is not part of the RRU.
+ *
+ * @param segments     The ROHC segments of the RRU
+ * @param segments_nr  The number of ROHC segments
+ * @param rru_off      The offset in the RRU of the first byte to copy
+ * @param len          The number of bytes to copy
+ * @param[out] dst     The memory where to copy the bytes
+ */
+static void rohc_decomp_rru_copy(const struct rohc_buf *const segments,
+                                 const size_t segments_nr,
+                                 const size_t rru_off,
+                                 const size_t len,
+                                 uint8_t *const dst)
+{
+	size_t seg_off = rru_off;
+	size_t copied_len = 0;
+	size_t i;
+
+	for(i = 0; i < segments_nr && copied_len < len; i++)
+	{
+		const size_t seg_len = segments[i].len - 1;
+
+		if(seg_off >= seg_len)
+		{
+			/* the bytes to copy are in the next segments */
+			seg_off -= seg_len;
+		}
+		else
+		{
+			const size_t seg_copy_len = rohc_min(seg_len - seg_off, len - copied_len);
+			memcpy(dst + copied_len, rohc_buf_data(segments[i]) + 1 + seg_off,
+			       seg_copy_len);
+			copied_len += seg_copy_len;
+			seg_off = 0;
+		}
+	}
+	assert(copied_len == len);
+}
+
+
 /**
  * @brief Parse padding bits if some are present
  *
@@ -3774,6 +8110,53 @@ static void rohc_decomp_parse_padding(const struct rohc_decomp *const decomp,
 }
 
 
+/**
+ * @brief Skip the padding and the feedback items at the beginning of a packet
+ *
+ * @param[in,out] packet    The ROHC packet, pulled beyond the padding and the
+ *                          feedback items
+ * @param[out] padding_len  The length of the padding
+ * @return                  true if the padding and the feedback items were
+ *                          skipped, false if the packet contains padding only
+ *                          or if one feedback item is malformed
+ */
+static bool rohc_decomp_skip_fb_prefix(struct rohc_buf *const packet,
+                                       size_t *const padding_len)
+{
+	const size_t offset = packet->offset;
+
+	/* skip padding, padding-only packets are not allowed */
+	while(packet->len > 0 && rohc_decomp_packet_is_padding(rohc_buf_data(*packet)))
+	{
+		rohc_buf_pull(packet, 1);
+	}
+	*padding_len = packet->offset - offset;
+	if(packet->len == 0)
+	{
+		goto error;
+	}
+
+	/* skip feedback items */
+	while(packet->len > 0 && rohc_packet_is_feedback(rohc_buf_byte(*packet)))
+	{
+		size_t feedback_hdr_len;
+		size_t feedback_data_len;
+
+		if(!rohc_feedback_get_size(*packet, &feedback_hdr_len, &feedback_data_len) ||
+		   (feedback_hdr_len + feedback_data_len) > packet->len)
+		{
+			goto error;
+		}
+		rohc_buf_pull(packet, feedback_hdr_len + feedback_data_len);
+	}
+
+	return true;
+
+error:
+	return false;
+}
+
+
 /**
  * @brief Find the context for the given ROHC packet
  *
@@ -3835,6 +8218,7 @@ static rohc_status_t rohc_decomp_find_context(struct rohc_decomp *const decomp,
 	is_packet_ir_dyn = rohc_decomp_packet_is_irdyn(remain_data, remain_len);
 	if(is_packet_ir || is_packet_ir_dyn)
 	{
+		size_t v2_profile_idx;
 		uint8_t pkt_profile_id;
 
 		rohc_debug(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
@@ -3857,7 +8241,19 @@ static rohc_status_t rohc_decomp_find_context(struct rohc_decomp *const decomp,
 			goto error_malformed;
 		}
 		pkt_profile_id = remain_data[0];
-		*profile_id = pkt_profile_id; /* TODO: ROHCv2 profiles not handled yet */
+		/* the IR packets carry the 8 LSB of the profile ID only: the ROHCv1
+		 * and ROHCv2 variants of one profile are never enabled together, so
+		 * the enabled one is the right one */
+		v2_profile_idx = rohc_decomp_profile_idx(0x0100 | pkt_profile_id);
+		if(v2_profile_idx < D_NUM_PROFILES &&
+		   decomp->enabled_profiles[v2_profile_idx])
+		{
+			*profile_id = 0x0100 | pkt_profile_id;
+		}
+		else
+		{
+			*profile_id = pkt_profile_id;
+		}
 		remain_data++;
 		remain_len--;
 		rohc_debug(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
@@ -3969,6 +8365,9 @@ static bool rohc_decomp_parse_feedbacks(struct rohc_decomp *const decomp,
                                         struct rohc_buf *const rohc_data,
                                         struct rohc_buf *const feedbacks)
 {
+	const struct rohc_buf all_data = *rohc_data;
+	struct rohc_buf *const feedbacks_copy =
+		(decomp->rcvd_feedback_ref ? NULL : feedbacks);
 	size_t feedbacks_nr = 0;
 	size_t feedbacks_full_len = 0; /* full feedbacks length */
 	size_t feedbacks_len = 0;      /* maybe truncated feedbacks length */
@@ -3988,7 +8387,8 @@ static bool rohc_decomp_parse_feedbacks(struct rohc_decomp *const decomp,
 		rohc_debug(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
 		           "parse feedback item #%zu at offset %zu in ROHC packet",
 		           feedbacks_nr, feedbacks_full_len);
-		if(!rohc_decomp_parse_feedback(decomp, rohc_data, feedbacks, &feedback_len))
+		if(!rohc_decomp_parse_feedback(decomp, rohc_data, feedbacks_copy,
+		                               &feedback_len))
 		{
 			rohc_warning(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
 			             "failed to parse feedback item #%zu at offset %zu in "
@@ -3998,17 +8398,24 @@ static bool rohc_decomp_parse_feedbacks(struct rohc_decomp *const decomp,
 		feedbacks_full_len += feedback_len;
 
 		/* hide the feedback */
-		if(feedbacks != NULL)
+		if(feedbacks_copy != NULL)
 		{
-			feedbacks_len += feedbacks->len;
-			rohc_buf_pull(feedbacks, feedbacks->len);
+			feedbacks_len += feedbacks_copy->len;
+			rohc_buf_pull(feedbacks_copy, feedbacks_copy->len);
 		}
 	}
 
-	/* unhide all feedbacks */
-	if(feedbacks != NULL)
+	if(feedbacks_copy != NULL)
+	{
+		/* unhide all feedbacks */
+		rohc_buf_push(feedbacks_copy, feedbacks_len);
+	}
+	else if(feedbacks != NULL)
 	{
-		rohc_buf_push(feedbacks, feedbacks_len);
+		/* the feedback items are contiguous at the beginning of the ROHC
+		 * data: reference them */
+		*feedbacks = all_data;
+		feedbacks->len = feedbacks_full_len;
 	}
 
 	return true;
@@ -4092,7 +8499,9 @@ error:
 /**
  * @brief Create the array of decompression contexts
  *
- * The maximum size of the array is \ref ROHC_LARGE_CID_MAX + 1.
+ * The maximum size of the array is \ref ROHC_LARGE_CID_MAX + 1. Only the
+ * table of the chunks of statistics is created, the chunks are allocated
+ * when their first context is created.
  *
  * @param decomp   The ROHC decompressor
  * @param max_cid  The MAX_CID value to used
@@ -4105,13 +8514,35 @@ static bool rohc_decomp_create_contexts(struct rohc_decomp *const decomp,
 	assert(max_cid <= ROHC_LARGE_CID_MAX);
 
 	/* allocate memory for the new context array */
-	decomp->contexts = calloc(max_cid + 1, sizeof(struct rohc_decomp_ctxt *));
+	decomp->contexts = rohc_calloc(max_cid + 1, sizeof(struct rohc_decomp_ctxt *));
 	if(decomp->contexts == NULL)
 	{
 		rohc_warning(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
 		             "cannot allocate memory for the contexts");
 		return false;
 	}
+
+	decomp->ctxts_chunks =
+		rohc_calloc(max_cid / ROHC_DECOMP_CTXTS_CHUNK_LEN + 1,
+		            sizeof(struct rohc_decomp_ctxts_chunk *));
+	if(decomp->ctxts_chunks == NULL)
+	{
+		rohc_warning(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+		             "cannot allocate memory for the statistics of contexts");
+		zfree(decomp->contexts);
+		return false;
+	}
+	decomp->ctxts_chunks_nr = 0;
+	decomp->ctxts_used = rohc_calloc(ROHC_BITMAP_WORDS_NR(max_cid + 1),
+	                            sizeof(uint64_t));
+	if(decomp->ctxts_used == NULL)
+	{
+		rohc_warning(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+		             "cannot allocate memory for the bitmap of contexts in use");
+		zfree(decomp->ctxts_chunks);
+		zfree(decomp->contexts);
+		return false;
+	}
 	rohc_debug(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
 	           "room for %zu decompression contexts created", max_cid + 1);
 
@@ -4119,6 +8550,135 @@ static bool rohc_decomp_create_contexts(struct rohc_decomp *const decomp,
 }
 
 
+/**
+ * @brief Destroy the chunks of statistics of the decompression contexts
+ *
+ * @param decomp  The ROHC decompressor
+ */
+static void rohc_decomp_destroy_ctxts_chunks(struct rohc_decomp *const decomp)
+{
+	size_t i;
+
+	for(i = 0; i <= (decomp->medium.max_cid / ROHC_DECOMP_CTXTS_CHUNK_LEN); i++)
+	{
+		if(decomp->ctxts_chunks[i] == NULL)
+		{
+			continue;
+		}
+		if(rohc_ctxt_pool_has_slabs(&decomp->ctxts_chunks_pool))
+		{
+			rohc_ctxt_pool_put(&decomp->ctxts_chunks_pool,
+			                   decomp->ctxts_chunks[i]->mem);
+		}
+		else
+		{
+			rohc_free(decomp->ctxts_chunks[i]->mem);
+		}
+	}
+	zfree(decomp->ctxts_chunks);
+	decomp->ctxts_chunks_nr = 0;
+}
+
+
+/**
+ * @brief Free the memory of the dense array of decompression contexts
+ *
+ * @param decomp  The ROHC decompressor
+ */
+static void rohc_decomp_free_dense_ctxts(struct rohc_decomp *const decomp)
+{
+	rohc_ctxt_pool_free_area(&decomp->ctxts_chunks_pool,
+	                         decomp->dense_ctxts_mem,
+	                         (decomp->dense_slots_nr + 1) *
+	                         decomp->dense_slot_len);
+	decomp->dense_ctxts_mem = NULL;
+}
+
+
+/**
+ * @brief Allocate the chunks of statistics of decompression contexts for
+ *        the given CIDs
+ *
+ * The chunks already allocated are kept.
+ *
+ * @param decomp     The ROHC decompressor
+ * @param cid_first  The first CID to allocate the statistics of
+ * @param cid_last   The last CID to allocate the statistics of
+ * @return           true if the chunks are allocated, false otherwise
+ */
+static bool rohc_decomp_alloc_ctxts_chunks(struct rohc_decomp *const decomp,
+                                           const rohc_cid_t cid_first,
+                                           const rohc_cid_t cid_last)
+{
+	size_t chunk_idx;
+
+	assert(cid_first <= cid_last);
+	assert(cid_last <= decomp->medium.max_cid);
+
+	for(chunk_idx = cid_first / ROHC_DECOMP_CTXTS_CHUNK_LEN;
+	    chunk_idx <= cid_last / ROHC_DECOMP_CTXTS_CHUNK_LEN; chunk_idx++)
+	{
+		struct rohc_decomp_ctxts_chunk *chunk;
+		void *mem;
+
+		if(decomp->ctxts_chunks[chunk_idx] != NULL)
+		{
+			continue;
+		}
+
+		/* one more cache line to align the statistics on cache lines */
+		if(rohc_ctxt_pool_has_slabs(&decomp->ctxts_chunks_pool))
+		{
+			mem = rohc_ctxt_pool_get(&decomp->ctxts_chunks_pool,
+			                         sizeof(struct rohc_decomp_ctxts_chunk) +
+			                         ROHC_CACHE_LINE_LEN, NULL);
+		}
+		else
+		{
+			mem = rohc_calloc(1, sizeof(struct rohc_decomp_ctxts_chunk) +
+			                  ROHC_CACHE_LINE_LEN);
+		}
+		if(mem == NULL)
+		{
+			rohc_warning(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+			             "cannot allocate memory for the statistics of the "
+			             "contexts with CIDs %zu to %zu",
+			             chunk_idx * ROHC_DECOMP_CTXTS_CHUNK_LEN,
+			             (chunk_idx + 1) * ROHC_DECOMP_CTXTS_CHUNK_LEN - 1);
+			return false;
+		}
+		chunk = rohc_cache_line_align(mem);
+		chunk->mem = mem;
+
+		/* publish the chunk for rohc_decomp_get_ctxts_stats() */
+		__atomic_store_n(&decomp->ctxts_chunks[chunk_idx], chunk,
+		                 __ATOMIC_RELEASE);
+		decomp->ctxts_chunks_nr++;
+	}
+
+	return true;
+}
+
+
+/**
+ * @brief Get the statistics of the decompression context with the given CID
+ *
+ * @param decomp  The ROHC decompressor
+ * @param cid     The CID of the context, its chunk shall be allocated
+ * @return        The statistics of the decompression context
+ */
+static struct rohc_decomp_ctxt_stats *
+	rohc_decomp_ctxt_stats_at(const struct rohc_decomp *const decomp,
+	                          const rohc_cid_t cid)
+{
+	struct rohc_decomp_ctxts_chunk *const chunk =
+		decomp->ctxts_chunks[cid / ROHC_DECOMP_CTXTS_CHUNK_LEN];
+
+	assert(chunk != NULL);
+	return &chunk->stats[cid % ROHC_DECOMP_CTXTS_CHUNK_LEN];
+}
+
+
 /**
  * @brief Does packet type carry static information?
  *
@@ -4154,6 +8714,10 @@ static bool rohc_decomp_packet_carry_crc_7_or_8(const rohc_packet_t packet_type)
 		case ROHC_PACKET_TCP_CO_COMMON:
 		case ROHC_PACKET_TCP_SEQ_8:
 		case ROHC_PACKET_TCP_RND_8:
+		case ROHC_PACKET_PT_0_CRC7:
+		case ROHC_PACKET_PT_2_SEQ_ID:
+		case ROHC_PACKET_PT_2_RND:
+		case ROHC_PACKET_CO_COMMON:
 			carry_crc_7_or_8 = true;
 			break;
 		case ROHC_PACKET_UO_0:
@@ -4176,6 +8740,9 @@ static bool rohc_decomp_packet_carry_crc_7_or_8(const rohc_packet_t packet_type)
 		case ROHC_PACKET_TCP_RND_5:
 		case ROHC_PACKET_TCP_RND_6:
 		case ROHC_PACKET_TCP_RND_7:
+		case ROHC_PACKET_PT_0_CRC3:
+		case ROHC_PACKET_PT_1_SEQ_ID:
+		case ROHC_PACKET_PT_1_RND:
 			carry_crc_7_or_8 = false;
 			break;
 		case ROHC_PACKET_UNKNOWN:
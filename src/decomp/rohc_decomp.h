@@ -54,6 +54,9 @@ extern "C"
 
 struct rohc_decomp;
 
+/** The ROHC decompressors that share one ROHC channel */
+struct rohc_decomp_group;
+
 
 
 /*
@@ -182,6 +185,8 @@ typedef struct
  *  - Major 0 / Minor 0 contains: version_major, version_minor, packets_nr,
  *    comp_bytes_nr, uncomp_bytes_nr, corrected_crc_failures,
  *    corrected_sn_wraparounds, and corrected_wrong_sn_updates.
+ *  - Major 0 / Minor = 1 added: packets_nr64, comp_bytes_nr64, and
+ *    uncomp_bytes_nr64.
  *
  * @ingroup rohc_decomp
  *
@@ -207,6 +212,15 @@ typedef struct
 	 *  failure */
 	unsigned long corrected_wrong_sn_updates;
 
+	/* added in 0.1 */
+	/** The number of packets processed by the context (64-bit wide) */
+	uint64_t packets_nr64;
+	/** The number of compressed bytes received by the context (64-bit wide) */
+	uint64_t comp_bytes_nr64;
+	/** The number of uncompressed bytes produced by the context
+	 *  (64-bit wide) */
+	uint64_t uncomp_bytes_nr64;
+
 } __attribute__((packed)) rohc_decomp_context_info_t;
 
 
@@ -238,6 +252,14 @@ typedef struct
  * Supported versions:
  *  - major 0 and minor = 0 contains: version_major, version_minor,
  *    contexts_nr, packets_nr, comp_bytes_nr, and uncomp_bytes_nr.
+ *  - major 0 and minor = 1 added: corrected_crc_failures,
+ *    corrected_sn_wraparounds, and corrected_wrong_sn_updates.
+ *  - major 0 and minor = 2 added: packets_nr64, comp_bytes_nr64, and
+ *    uncomp_bytes_nr64.
+ *  - major 0 and minor = 3 added: crc_repair_attempts and
+ *    crc_repair_skipped.
+ *  - major 0 and minor = 4 added: late_pkts_decoded.
+ *  - major 0 and minor = 5 added: rt_attempts_capped.
  *
  * @ingroup rohc_decomp
  *
@@ -268,9 +290,92 @@ typedef struct
 	 *  upon CRC failure */
 	unsigned long corrected_wrong_sn_updates;
 
+	/* added in 0.2 */
+	/** The number of packets processed by the decompressor (64-bit wide) */
+	uint64_t packets_nr64;
+	/** The number of compressed bytes received by the decompressor
+	 *  (64-bit wide) */
+	uint64_t comp_bytes_nr64;
+	/** The number of uncompressed bytes produced by the decompressor
+	 *  (64-bit wide) */
+	uint64_t uncomp_bytes_nr64;
+
+	/* added in 0.3 */
+	/** The cumulative number of repairs attempted upon CRC failure */
+	uint64_t crc_repair_attempts;
+	/** The cumulative number of repairs not attempted upon CRC failure
+	 *  because the repair budget was exhausted */
+	uint64_t crc_repair_skipped;
+
+	/* added in 0.4 */
+	/** The cumulative number of late packets decoded against a previous SN
+	 *  reference of the reorder window */
+	uint64_t late_pkts_decoded;
+
+	/* added in 0.5 */
+	/** The cumulative number of CRC failures that were not decoded again
+	 *  because the real-time mode already made one more decoding attempt */
+	uint64_t rt_attempts_capped;
+
 } __attribute__((packed)) rohc_decomp_general_info_t;
 
 
+/**
+ * @brief The statistics of one decompression context
+ *
+ * The structure is used by the \ref rohc_decomp_get_ctxts_stats function to
+ * export the statistics of all the contexts in use. The counters are 64-bit
+ * wide, so they do not wrap around on long-lived contexts.
+ *
+ * @ingroup rohc_decomp
+ *
+ * @see rohc_decomp_get_ctxts_stats
+ */
+typedef struct
+{
+	/** The Context ID (CID) of the context */
+	rohc_cid_t cid;
+	/** The ID of the profile of the context */
+	rohc_profile_t profile_id;
+	/** The operation mode of the context */
+	rohc_mode_t mode;
+	/** The operation state of the context */
+	rohc_decomp_state_t state;
+	/** The type of the last ROHC packet received by the context */
+	rohc_packet_t packet_type;
+	/** The number of packets received by the context */
+	uint64_t packets_nr;
+	/** The number of compressed bytes received by the context */
+	uint64_t comp_bytes_nr;
+	/** The number of uncompressed bytes produced by the context */
+	uint64_t uncomp_bytes_nr;
+	/** The number of compressed header bytes received by the context */
+	uint64_t comp_hdr_bytes_nr;
+	/** The number of uncompressed header bytes produced by the context */
+	uint64_t uncomp_hdr_bytes_nr;
+	/** The number of successful corrections upon CRC failure */
+	uint64_t corrected_crc_failures;
+	/** The number of successful corrections of SN wraparound upon CRC
+	 *  failure */
+	uint64_t corrected_sn_wraparounds;
+	/** The number of successful corrections of incorrect SN updates upon CRC
+	 *  failure */
+	uint64_t corrected_wrong_sn_updates;
+	/** The number of (possible) lost packet(s) before the last packet */
+	uint64_t nr_lost_packets;
+	/** The number of packet(s) before the last packet if late */
+	uint64_t nr_misordered_packets;
+	/** The number of repairs attempted upon CRC failure */
+	uint64_t crc_repair_attempts;
+	/** The number of repairs not attempted upon CRC failure because the
+	 *  repair budget was exhausted */
+	uint64_t crc_repair_skipped;
+	/** The number of late packets decoded against a previous SN reference
+	 *  of the reorder window */
+	uint64_t late_pkts_decoded;
+} rohc_decomp_ctxt_stats_t;
+
+
 /**
  * @brief The different features of the ROHC decompressor
  *
@@ -292,10 +397,249 @@ typedef enum
 	ROHC_DECOMP_FEATURE_COMPAT_1_6_x = (1 << 1),
 	/** Dump content of packets in traces (beware: performance impact) */
 	ROHC_DECOMP_FEATURE_DUMP_PACKETS = (1 << 3),
+	/** Measure the durations of the decompression phases (the library shall
+	 *  be built with the --enable-rohc-timings configure option) */
+	ROHC_DECOMP_FEATURE_TIMINGS      = (1 << 4),
+	/** Bound the work done for every packet: one CRC failure is followed by
+	 *  one decoding attempt at most (late packet or repair), and the idle
+	 *  contexts are reclaimed by \ref rohc_decomp_maintenance only */
+	ROHC_DECOMP_FEATURE_REALTIME     = (1 << 5),
 
 } rohc_decomp_features_t;
 
 
+/**
+ * @brief The phases of the decompression of one packet
+ *
+ * The durations of the phases are measured for the packets successfully
+ * decompressed if the feature \ref ROHC_DECOMP_FEATURE_TIMINGS is enabled.
+ *
+ * @ingroup rohc_decomp
+ *
+ * @see rohc_decomp_get_timings
+ * @see rohc_decomp_get_profile_timings
+ */
+typedef enum
+{
+	/** Parse the ROHC header */
+	ROHC_DECOMP_PHASE_PARSE   = 0,
+	/** Find or create the decompression context */
+	ROHC_DECOMP_PHASE_LOOKUP  = 1,
+	/** Decode the fields of the ROHC header */
+	ROHC_DECOMP_PHASE_DECODE  = 2,
+	/** Build the uncompressed headers and check their CRC */
+	ROHC_DECOMP_PHASE_CRC     = 3,
+	/** Copy the payload */
+	ROHC_DECOMP_PHASE_PAYLOAD  = 4,
+	/** Parse the feedback items piggybacked in the ROHC packet and build the
+	 *  feedback to send to the remote compressor */
+	ROHC_DECOMP_PHASE_FEEDBACK = 5,
+
+	ROHC_DECOMP_PHASE_MAX      = 6,
+
+} rohc_decomp_phase_t;
+
+
+/**
+ * @brief The order of the packets output by a group of decompressors
+ *
+ * @ingroup rohc_decomp
+ *
+ * @see rohc_decomp_group_new
+ * @see rohc_decomp_group_output
+ */
+typedef enum
+{
+	/** The packets are output in the order they were received */
+	ROHC_DECOMP_GROUP_ARRIVAL_ORDER = 0,
+	/** The packets of one CID are output in the order they were received,
+	 *  the packets of different CIDs may be output in another order */
+	ROHC_DECOMP_GROUP_CID_ORDER     = 1,
+
+} rohc_decomp_group_order_t;
+
+
+/**
+ * @brief The policies to choose the operational mode of the contexts
+ *
+ * @ingroup rohc_decomp
+ *
+ * @see rohc_decomp_set_mode_policy
+ */
+typedef enum
+{
+	/** All the contexts target the mode given at decompressor creation */
+	ROHC_DECOMP_MODE_FIXED    = 0,
+	/** Every context picks U-mode or O-mode from its measured error rate */
+	ROHC_DECOMP_MODE_ADAPTIVE = 1,
+
+} rohc_decomp_mode_policy_t;
+
+
+/**
+ * @brief Some information about one packet output by \ref rohc_decompress_gro
+ *
+ * @ingroup rohc_decomp
+ *
+ * @see rohc_decompress_gro
+ */
+typedef struct
+{
+	/** The number of TCP segments coalesced in the packet, 1 if the packet
+	 *  was not coalesced */
+	size_t segs_nr;
+	/** The length (in bytes) of the TCP payload of the first segment, that
+	 *  is the length of all the segments except the last one, 0 if the
+	 *  packet is not a TCP segment */
+	size_t seg_len;
+
+} rohc_decomp_gro_info_t;
+
+
+/**
+ * @brief The classes of ROHC packets found by \ref rohc_decomp_demux
+ *
+ * @ingroup rohc_decomp
+ *
+ * @see rohc_decomp_demux
+ */
+typedef enum
+{
+	/** The ROHC packet is malformed, its CID is unknown */
+	ROHC_DECOMP_DEMUX_MALFORMED = 0,
+	/** The ROHC packet contains feedback items only */
+	ROHC_DECOMP_DEMUX_FEEDBACK  = 1,
+	/** The ROHC packet is a segment, its CID is unknown until the RRU is
+	 *  reassembled */
+	ROHC_DECOMP_DEMUX_SEGMENT   = 2,
+	/** The ROHC packet is an IR packet, it may create a context */
+	ROHC_DECOMP_DEMUX_IR        = 3,
+	/** The ROHC packet is an IR-DYN packet */
+	ROHC_DECOMP_DEMUX_IR_DYN    = 4,
+	/** The ROHC packet is a compressed packet, it requires a context */
+	ROHC_DECOMP_DEMUX_CO        = 5,
+
+} rohc_decomp_demux_class_t;
+
+
+/**
+ * @brief The demultiplexing information of one ROHC packet
+ *
+ * The offsets are given from the beginning of the ROHC packet.
+ *
+ * @ingroup rohc_decomp
+ *
+ * @see rohc_decomp_demux
+ */
+typedef struct
+{
+	/** The class of the ROHC packet */
+	rohc_decomp_demux_class_t pkt_class;
+	/** The CID of the ROHC packet, valid for IR, IR-DYN and CO packets */
+	rohc_cid_t cid;
+	/** The length (in bytes) of the padding, the feedback items start
+	 *  right after */
+	size_t padding_len;
+	/** The length (in bytes) of all the feedback items */
+	size_t feedbacks_len;
+	/** The offset of the ROHC header, Add-CID included */
+	size_t hdr_offset;
+	/** The offset of the first byte of the ROHC header after the Add-CID,
+	 *  that is the byte that gives the packet type */
+	size_t type_offset;
+	/** The length (in bytes) of the large CID that follows the first byte
+	 *  of the ROHC header, 0 for small CIDs */
+	size_t large_cid_len;
+
+} rohc_decomp_demux_t;
+
+
+/** The events of the lifecycle of the decompression contexts */
+typedef enum
+{
+	/** A new context was created by an IR packet */
+	ROHC_DECOMP_EVENT_CTXT_CREATE   = 0,
+	/** A context was destroyed, replaced by a new context or unused for too
+	 *  long */
+	ROHC_DECOMP_EVENT_CTXT_DESTROY  = 1,
+	/** The decompression state of a context changed */
+	ROHC_DECOMP_EVENT_STATE_CHANGE  = 2,
+	/** The operation mode of a context changed */
+	ROHC_DECOMP_EVENT_MODE_CHANGE   = 3,
+	/** One packet failed to be decompressed */
+	ROHC_DECOMP_EVENT_FAILURE       = 4,
+} rohc_decomp_event_t;
+
+
+/** The description of one event of the lifecycle of one decompression
+ *  context */
+typedef struct
+{
+	/** The event */
+	rohc_decomp_event_t event;
+	/** The CID of the context, SIZE_MAX if the CID of a packet that failed
+	 *  to be decompressed is unknown */
+	rohc_cid_t cid;
+	/** The profile of the context */
+	rohc_profile_t profile_id;
+	/** The decompression state of the context before the event */
+	rohc_decomp_state_t old_state;
+	/** The decompression state of the context after the event */
+	rohc_decomp_state_t new_state;
+	/** The operation mode of the context before the event */
+	rohc_mode_t old_mode;
+	/** The operation mode of the context after the event */
+	rohc_mode_t new_mode;
+	/** The status of the decompression of the packet, for failures only */
+	rohc_status_t status;
+} rohc_decomp_event_info_t;
+
+
+/**
+ * @brief The prototype of the callback for the events of the contexts
+ *
+ * User-defined function that is called by the ROHC library when one
+ * decompression context is created, destroyed, changes of state or mode,
+ * or when one packet fails to be decompressed. The function is not called
+ * for the packets that change nothing, so that monitoring the contexts costs
+ * nothing on steady flows.
+ *
+ * The callback is called from within the decompression of one packet: it
+ * shall not use the decompressor.
+ *
+ * The user-defined function is set by calling the function
+ * \ref rohc_decomp_set_event_cb
+ *
+ * @param priv_ctxt  An optional private context, may be NULL
+ * @param info       The description of the event
+ *
+ * @see rohc_decomp_set_event_cb
+ * @ingroup rohc_decomp
+ */
+typedef void (*rohc_decomp_event_callback_t) (void *const priv_ctxt,
+                                              const rohc_decomp_event_info_t *const info);
+
+
+/**
+ * @brief The attributes of a new ROHC decompressor
+ *
+ * @see rohc_decomp_new3
+ * @ingroup rohc_decomp
+ */
+struct rohc_decomp_attr
+{
+	/** The type of Context IDs (CID) the decompressor uses */
+	rohc_cid_type_t cid_type;
+	/** The MAX_CID parameter of the decompressor */
+	rohc_cid_t max_cid;
+	/** The operational mode the decompressor shall target */
+	rohc_mode_t mode;
+	/** The NUMA node to allocate the memory of the decompressor on,
+	 *  \ref ROHC_NUMA_NODE_ANY to let the system place it */
+	int numa_node;
+};
+
+
 
 /*
  * Functions related to decompressor:
@@ -306,6 +650,9 @@ struct rohc_decomp * ROHC_EXPORT rohc_decomp_new2(const rohc_cid_type_t cid_type
                                                   const rohc_mode_t mode)
 	__attribute__((warn_unused_result));
 
+struct rohc_decomp * ROHC_EXPORT rohc_decomp_new3(const struct rohc_decomp_attr *const attr)
+	__attribute__((warn_unused_result));
+
 void ROHC_EXPORT rohc_decomp_free(struct rohc_decomp *const decomp);
 
 rohc_status_t ROHC_EXPORT rohc_decompress3(struct rohc_decomp *const decomp,
@@ -315,6 +662,69 @@ rohc_status_t ROHC_EXPORT rohc_decompress3(struct rohc_decomp *const decomp,
                                            struct rohc_buf *const feedback_send)
 	__attribute__((warn_unused_result));
 
+size_t ROHC_EXPORT rohc_decompress_burst(struct rohc_decomp *const decomp,
+                                         const struct rohc_buf *const rohc_packets,
+                                         struct rohc_buf *const uncomp_packets,
+                                         const size_t packets_nr,
+                                         struct rohc_buf *const rcvd_feedback,
+                                         struct rohc_buf *const feedback_send,
+                                         rohc_status_t *const statuses)
+	__attribute__((warn_unused_result));
+
+bool ROHC_EXPORT rohc_decompress_gro(struct rohc_decomp *const decomp,
+                                     const struct rohc_buf *const rohc_packets,
+                                     const size_t packets_nr,
+                                     struct rohc_buf *const uncomp_packets,
+                                     rohc_decomp_gro_info_t *const infos,
+                                     size_t *const uncomp_nr,
+                                     struct rohc_buf *const rcvd_feedback,
+                                     struct rohc_buf *const feedback_send,
+                                     rohc_status_t *const statuses)
+	__attribute__((warn_unused_result));
+
+rohc_status_t ROHC_EXPORT rohc_decompress_segments(struct rohc_decomp *const decomp,
+                                                   const struct rohc_buf *const segments,
+                                                   const size_t segments_nr,
+                                                   struct rohc_buf *const uncomp_packet,
+                                                   struct rohc_buf *const rcvd_feedback,
+                                                   struct rohc_buf *const feedback_send)
+	__attribute__((warn_unused_result));
+
+rohc_status_t ROHC_EXPORT rohc_decompress_iov(struct rohc_decomp *const decomp,
+                                              const struct rohc_buf rohc_packet,
+                                              const size_t payload_tail_len,
+                                              struct rohc_buf *const uncomp_hdrs,
+                                              struct rohc_buf *const payload,
+                                              struct rohc_buf *const rcvd_feedback,
+                                              struct rohc_buf *const feedback_send)
+	__attribute__((warn_unused_result));
+
+rohc_status_t ROHC_EXPORT rohc_decompress_fb_views(struct rohc_decomp *const decomp,
+                                                   const struct rohc_buf rohc_packet,
+                                                   struct rohc_buf *const uncomp_packet,
+                                                   struct rohc_buf *const rcvd_feedback,
+                                                   struct rohc_buf *const feedback_send)
+	__attribute__((warn_unused_result));
+
+bool ROHC_EXPORT rohc_decomp_parse_feedback_only(const struct rohc_decomp *const decomp,
+                                                 const struct rohc_buf rohc_packet,
+                                                 struct rohc_buf *const rcvd_feedback)
+	__attribute__((warn_unused_result));
+
+bool ROHC_EXPORT rohc_decomp_prewarm_context(struct rohc_decomp *const decomp,
+                                             const struct rohc_buf rohc_ir)
+	__attribute__((warn_unused_result));
+
+bool ROHC_EXPORT rohc_decomp_demux(const struct rohc_decomp *const decomp,
+                                   const struct rohc_buf rohc_packet,
+                                   rohc_decomp_demux_t *const demux)
+	__attribute__((warn_unused_result));
+
+bool ROHC_EXPORT rohc_decomp_demux_burst(const struct rohc_decomp *const decomp,
+                                         const struct rohc_buf *const rohc_packets,
+                                         const size_t packets_nr,
+                                         rohc_decomp_demux_t *const demuxes)
+	__attribute__((warn_unused_result));
 
 
 /*
@@ -337,6 +747,30 @@ bool ROHC_EXPORT rohc_decomp_get_last_packet_info(const struct rohc_decomp *cons
                                                   rohc_decomp_last_packet_info_t *const info)
 	__attribute__((warn_unused_result));
 
+bool ROHC_EXPORT rohc_decomp_get_ctxts_stats(const struct rohc_decomp *const decomp,
+                                             rohc_decomp_ctxt_stats_t *const stats,
+                                             const size_t stats_max,
+                                             size_t *const stats_nr)
+	__attribute__((warn_unused_result));
+
+bool ROHC_EXPORT rohc_decomp_get_timings(const struct rohc_decomp *const decomp,
+                                         const rohc_packet_t packet_type,
+                                         const rohc_decomp_phase_t phase,
+                                         rohc_timings_histo_t *const histo)
+	__attribute__((warn_unused_result));
+
+bool ROHC_EXPORT rohc_decomp_get_profile_timings(const struct rohc_decomp *const decomp,
+                                                 const rohc_profile_t profile,
+                                                 const rohc_decomp_phase_t phase,
+                                                 rohc_timings_histo_t *const histo)
+	__attribute__((warn_unused_result));
+
+bool ROHC_EXPORT rohc_decomp_get_pkt_log(const struct rohc_decomp *const decomp,
+                                         rohc_pkt_log_record_t *const records,
+                                         const size_t records_max,
+                                         size_t *const records_nr)
+	__attribute__((warn_unused_result));
+
 
 /*
  * Functions related to user parameters
@@ -362,6 +796,37 @@ bool ROHC_EXPORT rohc_decomp_get_mrru(const struct rohc_decomp *const decomp,
                                       size_t *const mrru)
 	__attribute__((warn_unused_result));
 
+/* memory budget */
+
+bool ROHC_EXPORT rohc_decomp_set_memory_budget(struct rohc_decomp *const decomp,
+                                               const size_t budget)
+	__attribute__((warn_unused_result));
+
+bool ROHC_EXPORT rohc_decomp_set_huge_pages(struct rohc_decomp *const decomp,
+                                            const bool enabled)
+	__attribute__((warn_unused_result));
+
+bool ROHC_EXPORT rohc_decomp_reserve_contexts(struct rohc_decomp *const decomp,
+                                              const size_t contexts_nr)
+	__attribute__((warn_unused_result));
+
+bool ROHC_EXPORT rohc_decomp_set_dense_contexts(struct rohc_decomp *const decomp,
+                                                const bool enabled)
+	__attribute__((warn_unused_result));
+
+bool ROHC_EXPORT rohc_decomp_set_ctxts_idle_timeout(struct rohc_decomp *const decomp,
+                                                    const uint64_t timeout)
+	__attribute__((warn_unused_result));
+
+bool ROHC_EXPORT rohc_decomp_reclaim_idle_contexts(struct rohc_decomp *const decomp,
+                                                   const struct rohc_ts now,
+                                                   size_t *const reclaimed_nr)
+	__attribute__((warn_unused_result));
+
+bool ROHC_EXPORT rohc_decomp_maintenance(struct rohc_decomp *const decomp,
+                                         const struct rohc_ts now)
+	__attribute__((warn_unused_result));
+
 /* pRTT */
 
 bool ROHC_EXPORT rohc_decomp_set_prtt(struct rohc_decomp *const decomp,
@@ -386,12 +851,80 @@ bool ROHC_EXPORT rohc_decomp_get_rate_limits(const struct rohc_decomp *const dec
                                              size_t *const k_2, size_t *const n_2)
 	__attribute__((warn_unused_result));
 
+/* feedback coalescing */
+
+bool ROHC_EXPORT rohc_decomp_set_feedback_coalescing(struct rohc_decomp *const decomp,
+                                                     const size_t window)
+	__attribute__((warn_unused_result));
+
+bool ROHC_EXPORT rohc_decomp_get_feedback_coalescing(const struct rohc_decomp *const decomp,
+                                                     size_t *const window)
+	__attribute__((warn_unused_result));
+
+bool ROHC_EXPORT rohc_decomp_flush_feedbacks(struct rohc_decomp *const decomp,
+                                             struct rohc_buf *const feedback_send)
+	__attribute__((warn_unused_result));
+
+/* ring of the feedbacks to send */
+
+bool ROHC_EXPORT rohc_decomp_set_feedback_ring(struct rohc_decomp *const decomp,
+                                               const size_t slots_nr,
+                                               const size_t slot_len)
+	__attribute__((warn_unused_result));
+
+/* CRC repair budget */
+
+bool ROHC_EXPORT rohc_decomp_set_crc_repair_budget(struct rohc_decomp *const decomp,
+                                                   const size_t ctxt_budget,
+                                                   const size_t global_budget)
+	__attribute__((warn_unused_result));
+
+bool ROHC_EXPORT rohc_decomp_get_crc_repair_budget(const struct rohc_decomp *const decomp,
+                                                   size_t *const ctxt_budget,
+                                                   size_t *const global_budget)
+	__attribute__((warn_unused_result));
+
+/* reorder window */
+
+bool ROHC_EXPORT rohc_decomp_set_reorder_window(struct rohc_decomp *const decomp,
+                                                const size_t refs_nr)
+	__attribute__((warn_unused_result));
+
+bool ROHC_EXPORT rohc_decomp_get_reorder_window(const struct rohc_decomp *const decomp,
+                                                size_t *const refs_nr)
+	__attribute__((warn_unused_result));
+
+/* policy of operational modes */
+
+bool ROHC_EXPORT rohc_decomp_set_mode_policy(struct rohc_decomp *const decomp,
+                                             const rohc_decomp_mode_policy_t policy,
+                                             const size_t k, const size_t n)
+	__attribute__((warn_unused_result));
+
+bool ROHC_EXPORT rohc_decomp_get_mode_policy(const struct rohc_decomp *const decomp,
+                                             rohc_decomp_mode_policy_t *const policy,
+                                             size_t *const k, size_t *const n)
+	__attribute__((warn_unused_result));
+
 /* decompression library features */
 
 bool ROHC_EXPORT rohc_decomp_set_features(struct rohc_decomp *const decomp,
                                           const rohc_decomp_features_t features)
 	__attribute__((warn_unused_result));
 
+/* events of the lifecycle of contexts */
+
+bool ROHC_EXPORT rohc_decomp_set_event_cb(struct rohc_decomp *const decomp,
+                                          rohc_decomp_event_callback_t callback,
+                                          void *const priv_ctxt)
+	__attribute__((warn_unused_result));
+
+/* log of the last packets */
+
+bool ROHC_EXPORT rohc_decomp_set_pkt_log(struct rohc_decomp *const decomp,
+                                         const size_t records_nr)
+	__attribute__((warn_unused_result));
+
 
 /*
  * Functions related to decompression profiles
@@ -418,6 +951,44 @@ bool ROHC_EXPORT rohc_decomp_disable_profiles(struct rohc_decomp *const decomp,
 	__attribute__((warn_unused_result));
 
 
+/*
+ * Functions related to groups of decompressors that share one ROHC channel
+ */
+
+struct rohc_decomp_group * ROHC_EXPORT rohc_decomp_group_new(const rohc_cid_type_t cid_type,
+                                                             const rohc_cid_t max_cid,
+                                                             const rohc_mode_t mode,
+                                                             const size_t shards_nr,
+                                                             const size_t queue_len,
+                                                             const rohc_decomp_group_order_t order)
+	__attribute__((warn_unused_result));
+
+void ROHC_EXPORT rohc_decomp_group_free(struct rohc_decomp_group *const group);
+
+struct rohc_decomp * ROHC_EXPORT rohc_decomp_group_get_shard(const struct rohc_decomp_group *const group,
+                                                             const size_t shard)
+	__attribute__((warn_unused_result));
+
+bool ROHC_EXPORT rohc_decomp_group_enqueue(struct rohc_decomp_group *const group,
+                                           const struct rohc_buf rohc_packet,
+                                           struct rohc_buf *const uncomp_packet,
+                                           size_t *const shard)
+	__attribute__((warn_unused_result));
+
+bool ROHC_EXPORT rohc_decomp_group_decompress(struct rohc_decomp_group *const group,
+                                              const size_t shard)
+	__attribute__((warn_unused_result));
+
+bool ROHC_EXPORT rohc_decomp_group_output(struct rohc_decomp_group *const group,
+                                          struct rohc_buf **const uncomp_packet,
+                                          rohc_status_t *const status)
+	__attribute__((warn_unused_result));
+
+bool ROHC_EXPORT rohc_decomp_group_get_general_info(const struct rohc_decomp_group *const group,
+                                                    rohc_decomp_general_info_t *const info)
+	__attribute__((warn_unused_result));
+
+
 /*
  * Functions related to traces
  */
@@ -427,6 +998,20 @@ bool ROHC_EXPORT rohc_decomp_set_traces_cb2(struct rohc_decomp *const decomp,
                                             void *const priv_ctxt)
 	__attribute__((warn_unused_result));
 
+bool ROHC_EXPORT rohc_decomp_set_trace_level(struct rohc_decomp *const decomp,
+                                             const rohc_trace_level_t level)
+	__attribute__((warn_unused_result));
+
+bool ROHC_EXPORT rohc_decomp_set_trace_sampling(struct rohc_decomp *const decomp,
+                                                const size_t one_in_n,
+                                                const bool errors_only)
+	__attribute__((warn_unused_result));
+
+bool ROHC_EXPORT rohc_decomp_set_trace_cids(struct rohc_decomp *const decomp,
+                                            const rohc_cid_t *const cids,
+                                            const size_t cids_nr)
+	__attribute__((warn_unused_result));
+
 
 #undef ROHC_EXPORT /* do not pollute outside this header */
 
@@ -41,6 +41,54 @@
 #define D_IR_DYN_PACKET  0xf8
 
 
+/* short names for the packet types in the table below */
+#define IR  ROHC_PACKET_IR
+#define ID  ROHC_PACKET_IR_DYN
+#define U0  ROHC_PACKET_UO_0
+#define U1  ROHC_PACKET_UO_1
+#define U2  ROHC_PACKET_UOR_2
+#define XX  ROHC_PACKET_UNKNOWN
+
+/**
+ * The types of the packets of the RFC3095-based profiles, indexed by the
+ * first byte of the packet:
+ *  - 0xxxxxxx is UO-0,
+ *  - 10xxxxxx is UO-1*,
+ *  - 110xxxxx is UOR-2*,
+ *  - 11111000 is IR-DYN,
+ *  - 1111110x is IR.
+ *
+ * Padding, feedback and segment bytes never reach the profiles, so they are
+ * unknown packet types here.
+ */
+const uint8_t rohc_decomp_rfc3095_pkt_types[256] =
+{
+	U0, U0, U0, U0, U0, U0, U0, U0, U0, U0, U0, U0, U0, U0, U0, U0,
+	U0, U0, U0, U0, U0, U0, U0, U0, U0, U0, U0, U0, U0, U0, U0, U0,
+	U0, U0, U0, U0, U0, U0, U0, U0, U0, U0, U0, U0, U0, U0, U0, U0,
+	U0, U0, U0, U0, U0, U0, U0, U0, U0, U0, U0, U0, U0, U0, U0, U0,
+	U0, U0, U0, U0, U0, U0, U0, U0, U0, U0, U0, U0, U0, U0, U0, U0,
+	U0, U0, U0, U0, U0, U0, U0, U0, U0, U0, U0, U0, U0, U0, U0, U0,
+	U0, U0, U0, U0, U0, U0, U0, U0, U0, U0, U0, U0, U0, U0, U0, U0,
+	U0, U0, U0, U0, U0, U0, U0, U0, U0, U0, U0, U0, U0, U0, U0, U0,
+	U1, U1, U1, U1, U1, U1, U1, U1, U1, U1, U1, U1, U1, U1, U1, U1,
+	U1, U1, U1, U1, U1, U1, U1, U1, U1, U1, U1, U1, U1, U1, U1, U1,
+	U1, U1, U1, U1, U1, U1, U1, U1, U1, U1, U1, U1, U1, U1, U1, U1,
+	U1, U1, U1, U1, U1, U1, U1, U1, U1, U1, U1, U1, U1, U1, U1, U1,
+	U2, U2, U2, U2, U2, U2, U2, U2, U2, U2, U2, U2, U2, U2, U2, U2,
+	U2, U2, U2, U2, U2, U2, U2, U2, U2, U2, U2, U2, U2, U2, U2, U2,
+	XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,
+	XX, XX, XX, XX, XX, XX, XX, XX, ID, XX, XX, XX, IR, IR, XX, XX,
+};
+
+#undef IR
+#undef ID
+#undef U0
+#undef U1
+#undef U2
+#undef XX
+
+
 /**
  * @brief Find out whether the field is a segment field or not
  *
@@ -91,32 +139,6 @@ bool rohc_decomp_packet_is_irdyn(const uint8_t *const data, const size_t len)
 }
 
 
-/**
- * @brief Find out whether a ROHC packet is an UO-0 packet or not
- *
- * @param data  The ROHC packet to analyze
- * @param len   The length of the ROHC packet
- * @return      Whether the ROHC packet is an UO-0 packet or not
- */
-bool rohc_decomp_packet_is_uo0(const uint8_t *const data, const size_t len)
-{
-	return (len > 0 && GET_BIT_7(data) == 0);
-}
-
-
-/**
- * @brief Find out whether a ROHC packet is an UO-1* packet or not
- *
- * @param data  The ROHC packet to analyze
- * @param len   The length of the ROHC packet
- * @return      Whether the ROHC packet is an UO-1* packet or not
- */
-bool rohc_decomp_packet_is_uo1(const uint8_t *const data, const size_t len)
-{
-	return (len > 0 && GET_BIT_6_7(data) == 0x02);
-}
-
-
 /**
  * @brief Find out whether a ROHC packet is an UO-1-TS packet or not
  *
@@ -132,19 +154,6 @@ bool rohc_decomp_packet_is_uo1_ts(const uint8_t *const data, const size_t len)
 }
 
 
-/**
- * @brief Find out whether a ROHC packet is an UOR-2* packet or not
- *
- * @param data  The ROHC packet to analyze
- * @param len   The length of the ROHC packet
- * @return      Whether the ROHC packet is an UOR-2* packet or not
- */
-bool rohc_decomp_packet_is_uor2(const uint8_t *const data, const size_t len)
-{
-	return (len > 0 && GET_BIT_5_7(data) == 0x06);
-}
-
-
 /**
  * @brief Find out whether a ROHC packet is an UOR-2-TS packet or not
  *
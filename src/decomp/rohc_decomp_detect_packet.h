@@ -27,6 +27,8 @@
 #ifndef ROHC_DECOMP_DETECT_PACKET_H
 #define ROHC_DECOMP_DETECT_PACKET_H
 
+#include "rohc_packets.h"
+
 #include <stddef.h>
 #include <stdint.h>
 #ifdef __KERNEL__
@@ -36,6 +38,11 @@
 #endif
 
 
+/** The types of the packets of the RFC3095-based profiles, indexed by the
+ *  first byte of the packet */
+extern const uint8_t rohc_decomp_rfc3095_pkt_types[256];
+
+
 /*
  * Function prototypes.
  */
@@ -54,23 +61,33 @@ bool rohc_decomp_packet_is_ir(const uint8_t *const data, const size_t len)
 bool rohc_decomp_packet_is_irdyn(const uint8_t *const data, const size_t len)
 	__attribute__((warn_unused_result, nonnull(1), pure));
 
-/* UO-0 packet */
-bool rohc_decomp_packet_is_uo0(const uint8_t *const data, const size_t len)
-	__attribute__((warn_unused_result, nonnull(1), pure));
-
 /* UO-1* packets */
-bool rohc_decomp_packet_is_uo1(const uint8_t *const data, const size_t len)
-	__attribute__((warn_unused_result, nonnull(1), pure));
 bool rohc_decomp_packet_is_uo1_ts(const uint8_t *const data, const size_t len)
 	__attribute__((warn_unused_result, nonnull(1), pure));
 
 /* UOR-2* packets */
-bool rohc_decomp_packet_is_uor2(const uint8_t *const data, const size_t len)
-	__attribute__((warn_unused_result, nonnull(1), pure));
 bool rohc_decomp_packet_is_uor2_ts(const uint8_t *const data,
                                    const size_t data_len,
                                    const size_t large_cid_len)
 	__attribute__((warn_unused_result, nonnull(1), pure));
 
+
+/**
+ * @brief Get the type of one packet of the RFC3095-based profiles
+ *
+ * Only one table lookup is required for all the packet types. The UO-1* and
+ * UOR-2* packet types of the RTP profile are not distinguished, the profile
+ * shall choose the variant from its context.
+ *
+ * @param first_byte  The first byte of the ROHC packet (after the optional
+ *                    Add-CID octet)
+ * @return            The packet type among IR, IR-DYN, UO-0, UO-1, and UOR-2,
+ *                    ROHC_PACKET_UNKNOWN if the byte matches none of them
+ */
+static inline rohc_packet_t rohc_decomp_rfc3095_pkt_type(const uint8_t first_byte)
+{
+	return (rohc_packet_t) rohc_decomp_rfc3095_pkt_types[first_byte];
+}
+
 #endif
 
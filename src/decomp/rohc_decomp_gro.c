@@ -0,0 +1,642 @@
+/*
+ * Copyright 2016 Didier Barvaux
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/**
+ * @file   rohc_decomp_gro.c
+ * @brief  Coalescing of the TCP segments output by the decompressor
+ * @author Didier Barvaux <didier@barvaux.org>
+ *
+ * The consecutive TCP segments of one decompression context are coalesced
+ * into one large packet, as the generic receive offload of Linux does. The
+ * decompression context does most of the work: two segments may only be
+ * coalesced if they were decompressed with the same TCP context, so the
+ * headers of a segment are compared with the headers of the large packet
+ * only if the CID of the segments matches.
+ *
+ * The TCP checksum of the large packet is derived from the checksums of its
+ * segments, the payload is never read again: the checksum of a valid segment
+ * sums up to zero, so the sum of its payload is the opposite of the sum of
+ * its pseudo-header and TCP header. A segment with a wrong TCP checksum makes
+ * the checksum of the large packet wrong, so that the TCP stack of the
+ * receiver still detects it.
+ */
+
+#include "rohc_decomp_internals.h"
+#include "rohc_traces_internal.h"
+#include "rohc_csum.h"
+#include "rohc_utils.h"
+#include "protocols/ip_numbers.h"
+#include "protocols/ipv4.h"
+#include "protocols/ipv6.h"
+#include "protocols/tcp.h"
+#include "ip.h"
+
+#ifndef __KERNEL__
+#  include <string.h>
+#endif
+#include <assert.h>
+
+
+/** The maximum length (in bytes) of one coalesced packet, the maximum IPv4
+ *  Total Length */
+#define ROHC_GRO_PKT_MAX_LEN  0xffffU
+
+/** The TCP flags in the 14th byte of the TCP header */
+#define ROHC_GRO_TCP_FIN  0x01U
+#define ROHC_GRO_TCP_SYN  0x02U
+#define ROHC_GRO_TCP_RST  0x04U
+#define ROHC_GRO_TCP_PSH  0x08U
+#define ROHC_GRO_TCP_URG  0x20U
+#define ROHC_GRO_TCP_CWR  0x80U
+
+
+/** The headers of one decompressed TCP segment */
+struct rohc_gro_seg
+{
+	uint8_t *data;        /**< The first byte of the IP header */
+	uint8_t ip_version;   /**< The version of the IP header */
+	size_t ip_hdr_len;    /**< The length (in bytes) of the IP header */
+	size_t hdrs_len;      /**< The length (in bytes) of the IP/TCP headers */
+	size_t payload_len;   /**< The length (in bytes) of the TCP payload */
+	uint32_t seq_num;     /**< The TCP sequence number */
+	uint16_t ip_id;       /**< The IPv4 ID, 0 for IPv6 */
+	uint8_t tcp_flags;    /**< The TCP flags */
+};
+
+
+/** The large packet being coalesced */
+struct rohc_gro_pkt
+{
+	struct rohc_buf *pkt;   /**< The large packet */
+	rohc_decomp_gro_info_t *info; /**< The information about the large
+	                                   packet, may be NULL */
+	rohc_cid_t cid;         /**< The CID of the segments */
+	struct rohc_gro_seg head; /**< The headers of the first segment */
+	size_t segs_nr;         /**< The number of coalesced segments */
+	size_t payload_len;     /**< The length (in bytes) of the whole payload */
+	uint32_t next_seq_num;  /**< The expected sequence number of the next
+	                             segment */
+	uint16_t last_ip_id;    /**< The IPv4 ID of the last segment */
+	uint8_t last_flags;     /**< The PSH and FIN flags of the last segment */
+	uint32_t payload_sum;   /**< The one's complement sum of the payload */
+};
+
+
+static bool rohc_gro_parse(const struct rohc_buf packet,
+                           struct rohc_gro_seg *const seg)
+	__attribute__((warn_unused_result, nonnull(2)));
+static bool rohc_gro_may_merge(const struct rohc_gro_pkt *const gro,
+                               const struct rohc_gro_seg *const seg)
+	__attribute__((warn_unused_result, nonnull(1, 2), pure));
+static void rohc_gro_open(struct rohc_gro_pkt *const gro,
+                          struct rohc_buf *const pkt,
+                          rohc_decomp_gro_info_t *const info,
+                          const rohc_cid_t cid,
+                          const struct rohc_gro_seg *const seg)
+	__attribute__((nonnull(1, 2, 5)));
+static void rohc_gro_merge(struct rohc_gro_pkt *const gro,
+                           const struct rohc_gro_seg *const seg)
+	__attribute__((nonnull(1, 2)));
+static void rohc_gro_close(struct rohc_gro_pkt *const gro)
+	__attribute__((nonnull(1)));
+static uint16_t rohc_gro_pseudo_hdr_sum(const struct rohc_gro_seg *const seg,
+                                        const size_t payload_len)
+	__attribute__((warn_unused_result, nonnull(1), pure));
+
+
+/**
+ * @brief Decompress a burst of ROHC packets, and coalesce the consecutive
+ *        TCP segments of the same context
+ *
+ * Decompress the given ROHC packets as \ref rohc_decompress_burst does, then
+ * coalesce the consecutive TCP segments of the burst that belong to the same
+ * TCP stream into one large packet, as the generic receive offload (GRO) of
+ * Linux does. The large packet is made of the IP/TCP headers of the first
+ * segment followed by the payloads of all the segments:
+ *  - the IPv4 Total Length or the IPv6 Payload Length is the one of the
+ *    large packet,
+ *  - the TCP PSH and FIN flags are the ones of the last segment,
+ *  - the IPv4 and TCP checksums are updated.
+ *
+ * One segment is coalesced with the previous one if:
+ *  - it was decompressed with the same TCP context, just after it,
+ *  - it is the next segment of the stream, in sequence,
+ *  - its IP and TCP headers are the same, except the lengths, the IPv4 ID
+ *    that is incremented or constant with the DF flag set, the checksums,
+ *    and the TCP PSH and FIN flags,
+ *  - its payload is not larger than the payload of the first segment,
+ *  - the large packet fits in its buffer, and is not larger than 65535 bytes.
+ * A segment with the TCP PSH or FIN flag set or with a payload shorter than
+ * the one of the first segment is the last one of a large packet. Segments
+ * with the TCP SYN, RST, URG or CWR flag set, IPv4 segments with options
+ * and IPv6 segments with extension headers are never coalesced.
+ *
+ * The uncompressed packets are output in \e uncomp_packets in the order of
+ * the ROHC packets. Packets that failed to be decompressed and packets that
+ * only transport feedback are not output. The buffers of \e uncomp_packets
+ * after the last output packet are left empty.
+ *
+ * The status of the decompression of every ROHC packet is stored in the
+ * array \e statuses, see \ref rohc_decompress3 for the possible values. The
+ * feedback is aggregated as \ref rohc_decompress_burst does.
+ *
+ * @param decomp               The ROHC decompressor
+ * @param rohc_packets         The compressed packets to decompress
+ * @param packets_nr           The number of packets in the burst
+ * @param[out] uncomp_packets  The resulting uncompressed packets, one empty
+ *                             buffer for every ROHC packet
+ * @param[out] infos           The number of segments and the length of their
+ *                             payload for every uncompressed packet, may be
+ *                             NULL
+ * @param[out] uncomp_nr       The number of uncompressed packets
+ * @param[out] rcvd_feedback   The feedback received from the remote peer for
+ *                             the same-side associated ROHC compressor, may
+ *                             be NULL to ignore the received feedback data
+ * @param[out] feedback_send   The feedback to be transmitted to the remote
+ *                             compressor, may be NULL to disable the
+ *                             generation of feedback
+ * @param[out] statuses        The status of the decompression of every ROHC
+ *                             packet
+ * @return                     true if the burst was handled (every ROHC
+ *                             packet with success or not),
+ *                             false if the parameters are invalid
+ *
+ * @ingroup rohc_decomp
+ *
+ * @see rohc_decompress_burst
+ */
+bool rohc_decompress_gro(struct rohc_decomp *const decomp,
+                         const struct rohc_buf *const rohc_packets,
+                         const size_t packets_nr,
+                         struct rohc_buf *const uncomp_packets,
+                         rohc_decomp_gro_info_t *const infos,
+                         size_t *const uncomp_nr,
+                         struct rohc_buf *const rcvd_feedback,
+                         struct rohc_buf *const feedback_send,
+                         rohc_status_t *const statuses)
+{
+	struct rohc_gro_pkt gro = { .pkt = NULL };
+	size_t i;
+
+	/* check inputs validity */
+	if(decomp == NULL)
+	{
+		goto error;
+	}
+	if(rohc_packets == NULL || uncomp_packets == NULL || uncomp_nr == NULL ||
+	   statuses == NULL)
+	{
+		rohc_warning(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+		             "given arrays of packets or statuses, or number of "
+		             "packets are NULL");
+		goto error;
+	}
+	if(packets_nr == 0)
+	{
+		goto error;
+	}
+	if(rcvd_feedback != NULL &&
+	   (rohc_buf_is_malformed(*rcvd_feedback) ||
+	    !rohc_buf_is_empty(*rcvd_feedback)))
+	{
+		rohc_warning(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+		             "given rcvd_feedback is malformed or not empty");
+		goto error;
+	}
+	if(feedback_send != NULL &&
+	   (rohc_buf_is_malformed(*feedback_send) ||
+	    !rohc_buf_is_empty(*feedback_send)))
+	{
+		rohc_warning(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+		             "given feedback_send is malformed or not empty");
+		goto error;
+	}
+	*uncomp_nr = 0;
+
+	for(i = 0; i < packets_nr; i++)
+	{
+		/* every packet is decompressed in the first unused buffer */
+		struct rohc_buf *const uncomp_packet = &uncomp_packets[*uncomp_nr];
+		struct rohc_buf rcvd_feedback_pkt;
+		struct rohc_buf feedback_send_pkt;
+		struct rohc_buf *rcvd_feedback_ptr = NULL;
+		struct rohc_buf *feedback_send_ptr = NULL;
+		struct rohc_gro_seg seg;
+		rohc_cid_t cid;
+		bool is_tcp;
+
+		/* the feedback items of the packet are appended to the ones of the
+		 * previous packets of the burst */
+		if(rcvd_feedback != NULL)
+		{
+			rcvd_feedback_pkt = *rcvd_feedback;
+			rohc_buf_pull(&rcvd_feedback_pkt, rcvd_feedback->len);
+			rcvd_feedback_ptr = &rcvd_feedback_pkt;
+		}
+		if(feedback_send != NULL)
+		{
+			feedback_send_pkt = *feedback_send;
+			rohc_buf_pull(&feedback_send_pkt, feedback_send->len);
+			feedback_send_ptr = &feedback_send_pkt;
+		}
+
+		statuses[i] = rohc_decompress3(decomp, rohc_packets[i], uncomp_packet,
+		                               rcvd_feedback_ptr, feedback_send_ptr);
+
+		if(rcvd_feedback != NULL)
+		{
+			rcvd_feedback->len += rcvd_feedback_pkt.len;
+		}
+		if(feedback_send != NULL)
+		{
+			feedback_send->len += feedback_send_pkt.len;
+		}
+
+		if(statuses[i] != ROHC_STATUS_OK || rohc_buf_is_empty(*uncomp_packet))
+		{
+			/* nothing to output */
+			uncomp_packet->len = 0;
+			continue;
+		}
+
+		/* the decompression context tells whether the packet is a TCP segment
+		 * and to which stream it belongs */
+		assert(decomp->last_context != NULL);
+		cid = decomp->last_context->cid;
+		is_tcp = (decomp->last_context->profile->id == ROHC_PROFILE_TCP &&
+		          rohc_gro_parse(*uncomp_packet, &seg));
+
+		if(gro.pkt != NULL && is_tcp && gro.cid == cid &&
+		   rohc_gro_may_merge(&gro, &seg) &&
+		   (rohc_buf_avail_len(*gro.pkt) - gro.pkt->len) >= seg.payload_len &&
+		   (gro.pkt->len + seg.payload_len) <= ROHC_GRO_PKT_MAX_LEN)
+		{
+			rohc_gro_merge(&gro, &seg);
+			uncomp_packet->len = 0;
+
+			/* the PSH or FIN flag or a short segment ends the large packet */
+			if(gro.last_flags != 0 || seg.payload_len < gro.head.payload_len)
+			{
+				rohc_gro_close(&gro);
+			}
+			continue;
+		}
+
+		/* the packet is not coalesced with the previous ones */
+		if(gro.pkt != NULL)
+		{
+			rohc_gro_close(&gro);
+		}
+		if(infos != NULL)
+		{
+			infos[*uncomp_nr].segs_nr = 1;
+			infos[*uncomp_nr].seg_len = (is_tcp ? seg.payload_len : 0);
+		}
+
+		/* the next segments may be coalesced with the packet if it is a
+		 * TCP data segment */
+		if(is_tcp && seg.payload_len > 0 &&
+		   (seg.tcp_flags & (ROHC_GRO_TCP_SYN | ROHC_GRO_TCP_RST |
+		                     ROHC_GRO_TCP_URG | ROHC_GRO_TCP_PSH |
+		                     ROHC_GRO_TCP_FIN)) == 0)
+		{
+			rohc_gro_open(&gro, uncomp_packet,
+			              (infos != NULL ? &infos[*uncomp_nr] : NULL), cid, &seg);
+		}
+		(*uncomp_nr)++;
+	}
+	if(gro.pkt != NULL)
+	{
+		rohc_gro_close(&gro);
+	}
+
+	rohc_debug(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+	           "%zu ROHC packets decompressed and coalesced into %zu packets",
+	           packets_nr, *uncomp_nr);
+
+	return true;
+
+error:
+	return false;
+}
+
+
+/**
+ * @brief Parse the IP/TCP headers of one decompressed packet
+ *
+ * @param packet    The decompressed packet
+ * @param[out] seg  The headers of the TCP segment
+ * @return          true if the packet is a TCP segment that may be
+ *                  coalesced, false otherwise
+ */
+static bool rohc_gro_parse(const struct rohc_buf packet,
+                           struct rohc_gro_seg *const seg)
+{
+	const struct tcphdr *tcp;
+	size_t tcp_hdr_len;
+
+	seg->data = rohc_buf_data(packet);
+	seg->ip_version = (seg->data[0] >> 4) & 0x0f;
+	if(seg->ip_version == IPV4)
+	{
+		const struct ipv4_hdr *const ipv4 = (const struct ipv4_hdr *) seg->data;
+
+		/* IPv4 options and fragments are not coalesced */
+		if(packet.len < sizeof(struct ipv4_hdr) ||
+		   ipv4->ihl != (sizeof(struct ipv4_hdr) / sizeof(uint32_t)) ||
+		   rohc_ntoh16(ipv4->tot_len) != packet.len ||
+		   ipv4_is_fragment(ipv4) || ipv4->protocol != ROHC_IPPROTO_TCP)
+		{
+			goto error;
+		}
+		seg->ip_hdr_len = sizeof(struct ipv4_hdr);
+		seg->ip_id = rohc_ntoh16(ipv4->id);
+	}
+	else if(seg->ip_version == IPV6)
+	{
+		const struct ipv6_hdr *const ipv6 = (const struct ipv6_hdr *) seg->data;
+
+		/* IPv6 extension headers are not coalesced */
+		if(packet.len < sizeof(struct ipv6_hdr) ||
+		   (rohc_ntoh16(ipv6->plen) + sizeof(struct ipv6_hdr)) != packet.len ||
+		   ipv6->nh != ROHC_IPPROTO_TCP)
+		{
+			goto error;
+		}
+		seg->ip_hdr_len = sizeof(struct ipv6_hdr);
+		seg->ip_id = 0;
+	}
+	else
+	{
+		goto error;
+	}
+
+	if((packet.len - seg->ip_hdr_len) < sizeof(struct tcphdr))
+	{
+		goto error;
+	}
+	tcp = (const struct tcphdr *) (seg->data + seg->ip_hdr_len);
+	tcp_hdr_len = tcp->data_offset * sizeof(uint32_t);
+	if(tcp_hdr_len < sizeof(struct tcphdr) ||
+	   (packet.len - seg->ip_hdr_len) < tcp_hdr_len)
+	{
+		goto error;
+	}
+	seg->hdrs_len = seg->ip_hdr_len + tcp_hdr_len;
+	seg->payload_len = packet.len - seg->hdrs_len;
+	seg->seq_num = rohc_ntoh32(tcp->seq_num);
+	seg->tcp_flags = seg->data[seg->ip_hdr_len + 13];
+
+	return true;
+
+error:
+	return false;
+}
+
+
+/**
+ * @brief Whether one TCP segment may be coalesced with the large packet
+ *
+ * @param gro  The large packet being coalesced
+ * @param seg  The headers of the TCP segment
+ * @return     true if the segment is the next one of the large packet,
+ *             false otherwise
+ */
+static bool rohc_gro_may_merge(const struct rohc_gro_pkt *const gro,
+                               const struct rohc_gro_seg *const seg)
+{
+	const struct rohc_gro_seg *const head = &gro->head;
+	const uint8_t *const head_tcp = head->data + head->ip_hdr_len;
+	const uint8_t *const seg_tcp = seg->data + seg->ip_hdr_len;
+
+	if(seg->ip_version != head->ip_version ||
+	   seg->hdrs_len != head->hdrs_len ||
+	   seg->seq_num != gro->next_seq_num ||
+	   seg->payload_len == 0 ||
+	   seg->payload_len > head->payload_len)
+	{
+		return false;
+	}
+
+	/* the IP headers are the same except the lengths, the IPv4 ID and the
+	 * IPv4 checksum */
+	if(seg->ip_version == IPV4)
+	{
+		const struct ipv4_hdr *const ipv4 = (const struct ipv4_hdr *) seg->data;
+		const bool is_df = ((rohc_ntoh16(ipv4->frag_off) & 0x4000) != 0);
+
+		if(memcmp(seg->data, head->data, 2) != 0 ||
+		   memcmp(seg->data + 6, head->data + 6, 4) != 0 ||
+		   memcmp(seg->data + 12, head->data + 12, 8) != 0)
+		{
+			return false;
+		}
+		if(seg->ip_id != ((uint16_t) (gro->last_ip_id + 1)) &&
+		   (!is_df || seg->ip_id != gro->last_ip_id))
+		{
+			return false;
+		}
+	}
+	else
+	{
+		if(memcmp(seg->data, head->data, 4) != 0 ||
+		   memcmp(seg->data + 6, head->data + 6, 34) != 0)
+		{
+			return false;
+		}
+	}
+
+	/* the TCP headers are the same except the sequence number, the checksum,
+	 * the PSH and FIN flags, and the CWR flag of the first segment */
+	if(memcmp(seg_tcp, head_tcp, 4) != 0 ||
+	   memcmp(seg_tcp + 8, head_tcp + 8, 5) != 0 ||
+	   ((seg->tcp_flags ^ head->tcp_flags) &
+	    ~(ROHC_GRO_TCP_CWR | ROHC_GRO_TCP_PSH | ROHC_GRO_TCP_FIN)) != 0 ||
+	   (seg->tcp_flags & ROHC_GRO_TCP_CWR) != 0 ||
+	   memcmp(seg_tcp + 14, head_tcp + 14, 2) != 0 ||
+	   memcmp(seg_tcp + 18, head_tcp + 18,
+	          head->hdrs_len - head->ip_hdr_len - 18) != 0)
+	{
+		return false;
+	}
+
+	return true;
+}
+
+
+/**
+ * @brief Start one large packet with one TCP segment
+ *
+ * @param[out] gro  The large packet being coalesced
+ * @param pkt       The TCP segment, the buffer of the large packet
+ * @param info      The information about the large packet, may be NULL
+ * @param cid       The CID of the decompression context of the segment
+ * @param seg       The headers of the TCP segment
+ */
+static void rohc_gro_open(struct rohc_gro_pkt *const gro,
+                          struct rohc_buf *const pkt,
+                          rohc_decomp_gro_info_t *const info,
+                          const rohc_cid_t cid,
+                          const struct rohc_gro_seg *const seg)
+{
+	const uint8_t *const tcp = seg->data + seg->ip_hdr_len;
+	const size_t tcp_hdr_len = seg->hdrs_len - seg->ip_hdr_len;
+	uint32_t hdrs_sum;
+
+	gro->pkt = pkt;
+	gro->info = info;
+	gro->cid = cid;
+	memcpy(&gro->head, seg, sizeof(struct rohc_gro_seg));
+	gro->segs_nr = 1;
+	gro->payload_len = seg->payload_len;
+	gro->next_seq_num = seg->seq_num + ((uint32_t) seg->payload_len);
+	gro->last_ip_id = seg->ip_id;
+	gro->last_flags = 0;
+
+	/* the pseudo-header, the TCP header and the payload of a valid segment
+	 * sum up to zero: the sum of the payload is the opposite of the others */
+	hdrs_sum = rohc_gro_pseudo_hdr_sum(seg, seg->payload_len);
+	hdrs_sum += rohc_csum_sum(tcp, tcp_hdr_len);
+	gro->payload_sum = (uint16_t) ~rohc_csum_fold(hdrs_sum);
+}
+
+
+/**
+ * @brief Append the payload of one TCP segment to the large packet
+ *
+ * @param gro  The large packet being coalesced
+ * @param seg  The headers of the TCP segment
+ */
+static void rohc_gro_merge(struct rohc_gro_pkt *const gro,
+                           const struct rohc_gro_seg *const seg)
+{
+	const uint8_t *const tcp = seg->data + seg->ip_hdr_len;
+	const size_t tcp_hdr_len = seg->hdrs_len - seg->ip_hdr_len;
+	uint32_t hdrs_sum;
+	uint16_t payload_sum;
+
+	rohc_buf_append(gro->pkt, seg->data + seg->hdrs_len, seg->payload_len);
+
+	/* the payload sum of the segment is derived from its TCP checksum, it is
+	 * byte-swapped if the segment starts at an odd offset of the payload */
+	hdrs_sum = rohc_gro_pseudo_hdr_sum(seg, seg->payload_len);
+	hdrs_sum += rohc_csum_sum(tcp, tcp_hdr_len);
+	payload_sum = (uint16_t) ~rohc_csum_fold(hdrs_sum);
+	if((gro->payload_len % 2) != 0)
+	{
+		payload_sum = (uint16_t) ((payload_sum << 8) | (payload_sum >> 8));
+	}
+	gro->payload_sum += payload_sum;
+
+	gro->segs_nr++;
+	gro->payload_len += seg->payload_len;
+	gro->next_seq_num += (uint32_t) seg->payload_len;
+	gro->last_ip_id = seg->ip_id;
+	gro->last_flags = seg->tcp_flags & (ROHC_GRO_TCP_PSH | ROHC_GRO_TCP_FIN);
+}
+
+
+/**
+ * @brief Write the headers of the large packet once complete
+ *
+ * @param gro  The large packet being coalesced
+ */
+static void rohc_gro_close(struct rohc_gro_pkt *const gro)
+{
+	uint8_t *const hdrs = rohc_buf_data(*gro->pkt);
+	struct tcphdr *const tcp = (struct tcphdr *) (hdrs + gro->head.ip_hdr_len);
+	const size_t tcp_hdr_len = gro->head.hdrs_len - gro->head.ip_hdr_len;
+	uint32_t sum;
+
+	if(gro->segs_nr > 1)
+	{
+		if(gro->head.ip_version == IPV4)
+		{
+			struct ipv4_hdr *const ipv4 = (struct ipv4_hdr *) hdrs;
+
+			ipv4->tot_len = rohc_hton16((uint16_t) gro->pkt->len);
+			ipv4->check = 0;
+			ipv4->check = ip_fast_csum(hdrs, ipv4->ihl);
+		}
+		else
+		{
+			struct ipv6_hdr *const ipv6 = (struct ipv6_hdr *) hdrs;
+
+			ipv6->plen =
+				rohc_hton16((uint16_t) (gro->pkt->len - sizeof(struct ipv6_hdr)));
+		}
+
+		hdrs[gro->head.ip_hdr_len + 13] |= gro->last_flags;
+		tcp->checksum = 0;
+		sum = rohc_gro_pseudo_hdr_sum(&gro->head, gro->payload_len);
+		sum += rohc_csum_sum((uint8_t *) tcp, tcp_hdr_len);
+		sum += gro->payload_sum;
+		tcp->checksum = (uint16_t) ~rohc_csum_fold(sum);
+
+		if(gro->info != NULL)
+		{
+			gro->info->segs_nr = gro->segs_nr;
+		}
+	}
+	gro->pkt = NULL;
+}
+
+
+/**
+ * @brief Compute the one's complement sum of the TCP pseudo-header
+ *
+ * @param seg          The headers of the TCP segment
+ * @param payload_len  The length (in bytes) of the TCP payload
+ * @return             The sum of the pseudo-header, in memory order
+ */
+static uint16_t rohc_gro_pseudo_hdr_sum(const struct rohc_gro_seg *const seg,
+                                        const size_t payload_len)
+{
+	const size_t tcp_len = seg->hdrs_len - seg->ip_hdr_len + payload_len;
+	uint8_t pseudo_hdr[2 * sizeof(struct ipv6_addr) + 2 * sizeof(uint32_t)];
+	size_t pseudo_hdr_len;
+
+	if(seg->ip_version == IPV4)
+	{
+		const struct ipv4_hdr *const ipv4 = (const struct ipv4_hdr *) seg->data;
+
+		memcpy(pseudo_hdr, &ipv4->saddr, 2 * sizeof(uint32_t));
+		pseudo_hdr[8] = 0;
+		pseudo_hdr[9] = ROHC_IPPROTO_TCP;
+		pseudo_hdr[10] = (tcp_len >> 8) & 0xff;
+		pseudo_hdr[11] = tcp_len & 0xff;
+		pseudo_hdr_len = 12;
+	}
+	else
+	{
+		const struct ipv6_hdr *const ipv6 = (const struct ipv6_hdr *) seg->data;
+
+		memcpy(pseudo_hdr, &ipv6->saddr, 2 * sizeof(struct ipv6_addr));
+		pseudo_hdr[32] = (tcp_len >> 24) & 0xff;
+		pseudo_hdr[33] = (tcp_len >> 16) & 0xff;
+		pseudo_hdr[34] = (tcp_len >> 8) & 0xff;
+		pseudo_hdr[35] = tcp_len & 0xff;
+		pseudo_hdr[36] = 0;
+		pseudo_hdr[37] = 0;
+		pseudo_hdr[38] = 0;
+		pseudo_hdr[39] = ROHC_IPPROTO_TCP;
+		pseudo_hdr_len = 40;
+	}
+
+	return rohc_csum_sum(pseudo_hdr, pseudo_hdr_len);
+}
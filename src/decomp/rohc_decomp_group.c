@@ -0,0 +1,655 @@
+/*
+ * Copyright 2016 Didier Barvaux
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/**
+ * @file   rohc_decomp_group.c
+ * @brief  Group of ROHC decompressors that share one ROHC channel
+ * @author Didier Barvaux <didier@barvaux.org>
+ *
+ * One ROHC decompressor shall be used by one thread at a time. The contexts
+ * of different CIDs are independent, so a group of decompressors splits the
+ * CIDs of one ROHC channel between several decompressors, the shards, that
+ * several threads run at the same time:
+ *  - the packets are dispatched to the shards by CID, so that all the packets
+ *    of one CID are decompressed by the same shard, in the order they were
+ *    received,
+ *  - the decompressed packets are output by one thread, either in the order
+ *    the packets were received on the channel, or in the order they were
+ *    decompressed as long as the order of every CID is kept,
+ *  - every shard publishes its statistics after every packet, the statistics
+ *    of the group are the sum of them.
+ *
+ * The packets of one shard flow through one array of slots with three
+ * indexes: one for the dispatching thread, one for the thread of the shard,
+ * and one for the output thread. Every thread writes its own index only. The
+ * order of arrival is kept in one more single-producer/single-consumer queue
+ * of shard indexes, from the dispatching thread to the output thread. No lock
+ * is taken.
+ */
+
+#include "rohc_decomp_internals.h"
+#include "rohc_debug.h"
+#include "rohc_seqcount.h"
+#include "rohc_alloc.h"
+
+#ifndef __KERNEL__
+#  include <string.h>
+#endif
+#include <assert.h>
+
+
+/** One packet in the queue of one shard */
+struct rohc_decomp_group_slot
+{
+	/** The ROHC packet */
+	struct rohc_buf rohc_packet;
+	/** The buffer of the decompressed packet, given by the user */
+	struct rohc_buf *uncomp_packet;
+	/** The status of the decompression of the packet */
+	rohc_status_t status;
+};
+
+
+/** One shard of a group of decompressors */
+struct rohc_decomp_group_shard
+{
+	/** The index of the next slot to fill, written by the dispatching thread
+	 *  only */
+	size_t enqueue_pos __attribute__((aligned(ROHC_CACHE_LINE_LEN)));
+	/** The index of the next slot to decompress, written by the thread of
+	 *  the shard only */
+	size_t decomp_pos __attribute__((aligned(ROHC_CACHE_LINE_LEN)));
+	/** The index of the next slot to output, written by the output thread
+	 *  only */
+	size_t output_pos __attribute__((aligned(ROHC_CACHE_LINE_LEN)));
+
+	/** The decompressor of the shard */
+	struct rohc_decomp *decomp __attribute__((aligned(ROHC_CACHE_LINE_LEN)));
+	/** The packets of the shard */
+	struct rohc_decomp_group_slot *slots;
+
+	/** The sequence counter of the statistics of the shard */
+	rohc_seqcount_t stats_seq;
+	/** The statistics of the shard, published after every packet */
+	rohc_decomp_general_info_t stats;
+};
+
+
+/** A group of decompressors that share one ROHC channel */
+struct rohc_decomp_group
+{
+	/** The index of the next arrival to record, written by the dispatching
+	 *  thread only */
+	size_t arrivals_head __attribute__((aligned(ROHC_CACHE_LINE_LEN)));
+	/** The index of the next arrival to output, written by the output thread
+	 *  only */
+	size_t arrivals_tail __attribute__((aligned(ROHC_CACHE_LINE_LEN)));
+
+	/** The order of the output packets */
+	rohc_decomp_group_order_t order __attribute__((aligned(ROHC_CACHE_LINE_LEN)));
+	/** The shard whose packets are output first in the CID order, used by
+	 *  the output thread only */
+	size_t next_shard;
+
+	/** The length of the queue of every shard minus one */
+	size_t mask;
+	/** The length of the queue of arrivals minus one */
+	size_t arrivals_mask;
+	/** The shard of every received packet, in the order of arrival */
+	size_t *arrivals;
+
+	/** The number of shards */
+	size_t shards_nr;
+	/** The shards */
+	struct rohc_decomp_group_shard *shards;
+};
+
+
+static bool rohc_decomp_group_output_shard(struct rohc_decomp_group_shard *const shard,
+                                           const size_t mask,
+                                           struct rohc_buf **const uncomp_packet,
+                                           rohc_status_t *const status)
+	__attribute__((warn_unused_result, nonnull(1, 3, 4)));
+
+
+/*
+ * Definitions of public functions
+ */
+
+
+/**
+ * @brief Create a new group of ROHC decompressors
+ *
+ * The packets of one CID are decompressed by the shard CID modulo
+ * \e shards_nr. The decompressors are created as \ref rohc_decomp_new2 does,
+ * with all the decompression profiles disabled. Use
+ * \ref rohc_decomp_group_get_shard to configure them before the first packet
+ * is enqueued.
+ *
+ * The feedback piggybacked on the ROHC packets is not returned, and no
+ * feedback is built for the remote compressor: the group suits the channels
+ * without feedback channel, ie. in Unidirectional mode.
+ *
+ * @param cid_type   The type of CID of the channel
+ * @param max_cid    The MAX_CID of the channel, see \ref rohc_decomp_new2
+ * @param mode       The operational mode of the decompressors, see
+ *                   \ref rohc_decomp_new2
+ * @param shards_nr  The number of decompressors in the group, in
+ *                   [1, max_cid + 1]
+ * @param queue_len  The number of packets that every shard may queue,
+ *                   a power of 2
+ * @param order      The order of the packets output by
+ *                   \ref rohc_decomp_group_output
+ * @return           The new group of decompressors if successful,
+ *                   NULL if parameters are invalid or in case of memory
+ *                   allocation failure
+ *
+ * @ingroup rohc_decomp
+ *
+ * @see rohc_decomp_group_free
+ */
+struct rohc_decomp_group * rohc_decomp_group_new(const rohc_cid_type_t cid_type,
+                                                 const rohc_cid_t max_cid,
+                                                 const rohc_mode_t mode,
+                                                 const size_t shards_nr,
+                                                 const size_t queue_len,
+                                                 const rohc_decomp_group_order_t order)
+{
+	struct rohc_decomp_group *group;
+	size_t arrivals_len;
+
+	/* check the parameters that rohc_decomp_new2() does not check */
+	if(shards_nr == 0 || shards_nr > (max_cid + 1))
+	{
+		goto error;
+	}
+	if(queue_len == 0 || (queue_len & (queue_len - 1)) != 0)
+	{
+		goto error;
+	}
+	if(order != ROHC_DECOMP_GROUP_ARRIVAL_ORDER &&
+	   order != ROHC_DECOMP_GROUP_CID_ORDER)
+	{
+		goto error;
+	}
+
+	group = rohc_malloc(sizeof(struct rohc_decomp_group));
+	if(group == NULL)
+	{
+		goto error;
+	}
+	memset(group, 0, sizeof(struct rohc_decomp_group));
+	group->order = order;
+	group->mask = queue_len - 1;
+
+	/* all the queues of the shards may be full at the same time */
+	for(arrivals_len = queue_len; arrivals_len < (queue_len * shards_nr);
+	    arrivals_len *= 2)
+	{
+	}
+	group->arrivals_mask = arrivals_len - 1;
+	group->arrivals = rohc_calloc(arrivals_len, sizeof(size_t));
+	if(group->arrivals == NULL)
+	{
+		goto free_group;
+	}
+
+	group->shards = rohc_calloc(shards_nr, sizeof(struct rohc_decomp_group_shard));
+	if(group->shards == NULL)
+	{
+		goto free_arrivals;
+	}
+	for(group->shards_nr = 0; group->shards_nr < shards_nr; group->shards_nr++)
+	{
+		struct rohc_decomp_group_shard *const shard =
+			&group->shards[group->shards_nr];
+
+		shard->slots = rohc_calloc(queue_len, sizeof(struct rohc_decomp_group_slot));
+		shard->decomp = rohc_decomp_new2(cid_type, max_cid, mode);
+		shard->stats.version_major = 0;
+		shard->stats.version_minor = 5;
+		if(shard->slots == NULL ||
+		   shard->decomp == NULL ||
+		   !rohc_decomp_get_general_info(shard->decomp, &shard->stats))
+		{
+			/* count the partially-created shard for the cleanup */
+			group->shards_nr++;
+			goto free_shards;
+		}
+	}
+
+	return group;
+
+free_shards:
+	rohc_decomp_group_free(group);
+	return NULL;
+free_arrivals:
+	zfree(group->arrivals);
+free_group:
+	zfree(group);
+error:
+	return NULL;
+}
+
+
+/**
+ * @brief Destroy the given group of ROHC decompressors
+ *
+ * No thread shall use the group anymore. The packets that are still queued
+ * are dropped.
+ *
+ * @param group  The group of decompressors to destroy, may be NULL
+ *
+ * @ingroup rohc_decomp
+ *
+ * @see rohc_decomp_group_new
+ */
+void rohc_decomp_group_free(struct rohc_decomp_group *const group)
+{
+	size_t i;
+
+	if(group == NULL)
+	{
+		return;
+	}
+
+	for(i = 0; i < group->shards_nr; i++)
+	{
+		rohc_decomp_free(group->shards[i].decomp);
+		rohc_free(group->shards[i].slots);
+	}
+	rohc_free(group->shards);
+	rohc_free(group->arrivals);
+	rohc_free(group);
+}
+
+
+/**
+ * @brief Get the decompressor of one shard of the group
+ *
+ * The decompressor may be configured (profiles, MRRU, callbacks...) before
+ * the first packet is enqueued. Once packets are enqueued, only the thread of
+ * the shard may use the decompressor.
+ *
+ * @param group  The group of decompressors
+ * @param shard  The index of the shard, in [0, shards_nr - 1]
+ * @return       The decompressor of the shard,
+ *               NULL if the group or the shard index is invalid
+ *
+ * @ingroup rohc_decomp
+ */
+struct rohc_decomp * rohc_decomp_group_get_shard(const struct rohc_decomp_group *const group,
+                                                 const size_t shard)
+{
+	if(group == NULL || shard >= group->shards_nr)
+	{
+		return NULL;
+	}
+
+	return group->shards[shard].decomp;
+}
+
+
+/**
+ * @brief Enqueue one ROHC packet in the shard that owns its CID
+ *
+ * The packets which CID cannot be decoded, ie. the malformed packets, the
+ * packets with feedback only, and the ROHC segments, are enqueued in the
+ * first shard. ROHC segmentation is thus available only if the contexts of
+ * the segmented packets belong to the first shard.
+ *
+ * The packet data is not copied: it shall remain valid until the packet is
+ * output by \ref rohc_decomp_group_output. The decompressed packet shall be
+ * an empty buffer.
+ *
+ * Only one thread at a time may enqueue packets in the group.
+ *
+ * @param group          The group of decompressors
+ * @param rohc_packet    The ROHC packet to decompress
+ * @param uncomp_packet  The buffer for the decompressed packet
+ * @param[out] shard     The index of the shard the packet is enqueued in, or
+ *                       would have been enqueued in if its queue is full
+ * @return               true if the packet was enqueued,
+ *                       false if the queue of the shard is full or if the
+ *                       parameters are invalid
+ *
+ * @ingroup rohc_decomp
+ */
+bool rohc_decomp_group_enqueue(struct rohc_decomp_group *const group,
+                               const struct rohc_buf rohc_packet,
+                               struct rohc_buf *const uncomp_packet,
+                               size_t *const shard)
+{
+	struct rohc_decomp_group_shard *dest;
+	struct rohc_decomp_group_slot *slot;
+	size_t enqueue_pos;
+	rohc_cid_t cid;
+
+	if(group == NULL || uncomp_packet == NULL || shard == NULL ||
+	   rohc_buf_is_malformed(rohc_packet))
+	{
+		goto error;
+	}
+
+	/* the CID type of the decompressors never changes, so reading it from
+	 * the decompressor of the first shard is safe */
+	if(!rohc_decomp_peek_cid(group->shards[0].decomp, rohc_packet, &cid))
+	{
+		cid = 0;
+	}
+	*shard = cid % group->shards_nr;
+	dest = &group->shards[*shard];
+
+	enqueue_pos = __atomic_load_n(&dest->enqueue_pos, __ATOMIC_RELAXED);
+	if((enqueue_pos - __atomic_load_n(&dest->output_pos, __ATOMIC_ACQUIRE)) >
+	   group->mask)
+	{
+		goto error;
+	}
+	slot = &dest->slots[enqueue_pos & group->mask];
+	slot->rohc_packet = rohc_packet;
+	slot->uncomp_packet = uncomp_packet;
+	__atomic_store_n(&dest->enqueue_pos, enqueue_pos + 1, __ATOMIC_RELEASE);
+
+	/* record the order of arrival, there is always room for it since every
+	 * packet in the queue of arrivals is also in the queue of one shard */
+	if(group->order == ROHC_DECOMP_GROUP_ARRIVAL_ORDER)
+	{
+		const size_t head =
+			__atomic_load_n(&group->arrivals_head, __ATOMIC_RELAXED);
+
+		assert((head - __atomic_load_n(&group->arrivals_tail, __ATOMIC_ACQUIRE)) <=
+		       group->arrivals_mask);
+		group->arrivals[head & group->arrivals_mask] = *shard;
+		__atomic_store_n(&group->arrivals_head, head + 1, __ATOMIC_RELEASE);
+	}
+
+	return true;
+
+error:
+	return false;
+}
+
+
+/**
+ * @brief Decompress the oldest packet enqueued in one shard
+ *
+ * The packet is decompressed with the decompressor of the shard, then the
+ * statistics of the shard are published.
+ *
+ * Only the thread of the shard may decompress the packets of the shard.
+ *
+ * @param group  The group of decompressors
+ * @param shard  The index of the shard
+ * @return       true if one packet was decompressed (with success or not),
+ *               false if the queue of the shard is empty or if the
+ *               parameters are invalid
+ *
+ * @ingroup rohc_decomp
+ */
+bool rohc_decomp_group_decompress(struct rohc_decomp_group *const group,
+                                  const size_t shard)
+{
+	struct rohc_decomp_group_shard *src;
+	struct rohc_decomp_group_slot *slot;
+	size_t decomp_pos;
+
+	if(group == NULL || shard >= group->shards_nr)
+	{
+		goto error;
+	}
+	src = &group->shards[shard];
+
+	decomp_pos = __atomic_load_n(&src->decomp_pos, __ATOMIC_RELAXED);
+	if(decomp_pos == __atomic_load_n(&src->enqueue_pos, __ATOMIC_ACQUIRE))
+	{
+		goto error;
+	}
+	slot = &src->slots[decomp_pos & group->mask];
+
+	slot->status = rohc_decompress3(src->decomp, slot->rohc_packet,
+	                                slot->uncomp_packet, NULL, NULL);
+
+	rohc_seqcount_write_begin(&src->stats_seq);
+	if(!rohc_decomp_get_general_info(src->decomp, &src->stats))
+	{
+		/* version 0.4 of the structure is always supported */
+	}
+	rohc_seqcount_write_end(&src->stats_seq);
+
+	__atomic_store_n(&src->decomp_pos, decomp_pos + 1, __ATOMIC_RELEASE);
+
+	return true;
+
+error:
+	return false;
+}
+
+
+/**
+ * @brief Output the next decompressed packet of the group
+ *
+ * In the \ref ROHC_DECOMP_GROUP_ARRIVAL_ORDER order, the next packet is the
+ * oldest packet enqueued in the group: no packet is output until it is
+ * decompressed. In the \ref ROHC_DECOMP_GROUP_CID_ORDER order, the next
+ * packet is the oldest decompressed packet of the next shard that has got
+ * one, the shards being tried in turn.
+ *
+ * Only one thread at a time may output packets.
+ *
+ * @param group               The group of decompressors
+ * @param[out] uncomp_packet  The buffer of the decompressed packet, as given
+ *                            to \ref rohc_decomp_group_enqueue
+ * @param[out] status         The status of the decompression of the packet,
+ *                            see \ref rohc_decompress3
+ * @return                    true if one packet was output,
+ *                            false if the next packet is not decompressed
+ *                            yet or if the parameters are invalid
+ *
+ * @ingroup rohc_decomp
+ */
+bool rohc_decomp_group_output(struct rohc_decomp_group *const group,
+                              struct rohc_buf **const uncomp_packet,
+                              rohc_status_t *const status)
+{
+	if(group == NULL || uncomp_packet == NULL || status == NULL)
+	{
+		goto error;
+	}
+
+	if(group->order == ROHC_DECOMP_GROUP_ARRIVAL_ORDER)
+	{
+		const size_t tail =
+			__atomic_load_n(&group->arrivals_tail, __ATOMIC_RELAXED);
+
+		if(tail == __atomic_load_n(&group->arrivals_head, __ATOMIC_ACQUIRE))
+		{
+			goto error;
+		}
+		if(!rohc_decomp_group_output_shard(&group->shards[group->arrivals[tail & group->arrivals_mask]],
+		                                   group->mask, uncomp_packet, status))
+		{
+			goto error;
+		}
+		__atomic_store_n(&group->arrivals_tail, tail + 1, __ATOMIC_RELEASE);
+	}
+	else
+	{
+		size_t i;
+
+		for(i = 0; i < group->shards_nr; i++)
+		{
+			const size_t shard = (group->next_shard + i) % group->shards_nr;
+
+			if(rohc_decomp_group_output_shard(&group->shards[shard], group->mask,
+			                                  uncomp_packet, status))
+			{
+				group->next_shard = (shard + 1) % group->shards_nr;
+				break;
+			}
+		}
+		if(i == group->shards_nr)
+		{
+			goto error;
+		}
+	}
+
+	return true;
+
+error:
+	return false;
+}
+
+
+/**
+ * @brief Get some general information about the group of decompressors
+ *
+ * The information is the sum of the information of all the decompressors of
+ * the group, see \ref rohc_decomp_get_general_info for the supported versions
+ * of the structure. It may be called by any thread, while the shards
+ * decompress packets: the information of every shard is the one published
+ * after its last decompressed packet.
+ *
+ * @param group         The group of decompressors
+ * @param[in,out] info  The structure where information will be stored
+ * @return              true in case of success, false otherwise
+ *
+ * @ingroup rohc_decomp
+ *
+ * @see rohc_decomp_get_general_info
+ */
+bool rohc_decomp_group_get_general_info(const struct rohc_decomp_group *const group,
+                                        rohc_decomp_general_info_t *const info)
+{
+	rohc_decomp_general_info_t sum;
+	size_t i;
+
+	if(group == NULL || info == NULL)
+	{
+		goto error;
+	}
+	if(info->version_major != 0 || info->version_minor > 5)
+	{
+		goto error;
+	}
+
+	memset(&sum, 0, sizeof(rohc_decomp_general_info_t));
+	for(i = 0; i < group->shards_nr; i++)
+	{
+		const struct rohc_decomp_group_shard *const shard = &group->shards[i];
+		rohc_decomp_general_info_t stats;
+		rohc_seqcount_t seq;
+
+		do
+		{
+			seq = rohc_seqcount_read_begin(&shard->stats_seq);
+			memcpy(&stats, &shard->stats, sizeof(rohc_decomp_general_info_t));
+		}
+		while(rohc_seqcount_read_retry(&shard->stats_seq, seq));
+
+		sum.contexts_nr += stats.contexts_nr;
+		sum.corrected_crc_failures += stats.corrected_crc_failures;
+		sum.corrected_sn_wraparounds += stats.corrected_sn_wraparounds;
+		sum.corrected_wrong_sn_updates += stats.corrected_wrong_sn_updates;
+		sum.packets_nr64 += stats.packets_nr64;
+		sum.comp_bytes_nr64 += stats.comp_bytes_nr64;
+		sum.uncomp_bytes_nr64 += stats.uncomp_bytes_nr64;
+		sum.crc_repair_attempts += stats.crc_repair_attempts;
+		sum.crc_repair_skipped += stats.crc_repair_skipped;
+		sum.late_pkts_decoded += stats.late_pkts_decoded;
+		sum.rt_attempts_capped += stats.rt_attempts_capped;
+	}
+
+	/* base fields for major version 0 */
+	info->contexts_nr = sum.contexts_nr;
+	info->packets_nr = sum.packets_nr64;
+	info->comp_bytes_nr = sum.comp_bytes_nr64;
+	info->uncomp_bytes_nr = sum.uncomp_bytes_nr64;
+	if(info->version_minor >= 1)
+	{
+		/* new fields in 0.1 */
+		info->corrected_crc_failures = sum.corrected_crc_failures;
+		info->corrected_sn_wraparounds = sum.corrected_sn_wraparounds;
+		info->corrected_wrong_sn_updates = sum.corrected_wrong_sn_updates;
+	}
+	if(info->version_minor >= 2)
+	{
+		/* new fields in 0.2 */
+		info->packets_nr64 = sum.packets_nr64;
+		info->comp_bytes_nr64 = sum.comp_bytes_nr64;
+		info->uncomp_bytes_nr64 = sum.uncomp_bytes_nr64;
+	}
+	if(info->version_minor >= 3)
+	{
+		/* new fields in 0.3 */
+		info->crc_repair_attempts = sum.crc_repair_attempts;
+		info->crc_repair_skipped = sum.crc_repair_skipped;
+	}
+	if(info->version_minor >= 4)
+	{
+		/* new fields in 0.4 */
+		info->late_pkts_decoded = sum.late_pkts_decoded;
+	}
+	if(info->version_minor >= 5)
+	{
+		/* new fields in 0.5 */
+		info->rt_attempts_capped = sum.rt_attempts_capped;
+	}
+
+	return true;
+
+error:
+	return false;
+}
+
+
+/*
+ * Definitions of private functions
+ */
+
+
+/**
+ * @brief Output the oldest decompressed packet of one shard, called by the
+ *        output thread
+ *
+ * @param shard               The shard
+ * @param mask                The length of the queue of the shard minus one
+ * @param[out] uncomp_packet  The buffer of the decompressed packet
+ * @param[out] status         The status of the decompression of the packet
+ * @return                    true if one packet was output,
+ *                            false if no packet is decompressed yet
+ */
+static bool rohc_decomp_group_output_shard(struct rohc_decomp_group_shard *const shard,
+                                           const size_t mask,
+                                           struct rohc_buf **const uncomp_packet,
+                                           rohc_status_t *const status)
+{
+	const size_t output_pos = __atomic_load_n(&shard->output_pos, __ATOMIC_RELAXED);
+	const struct rohc_decomp_group_slot *slot;
+
+	if(output_pos == __atomic_load_n(&shard->decomp_pos, __ATOMIC_ACQUIRE))
+	{
+		return false;
+	}
+	slot = &shard->slots[output_pos & mask];
+	*uncomp_packet = slot->uncomp_packet;
+	*status = slot->status;
+	__atomic_store_n(&shard->output_pos, output_pos + 1, __ATOMIC_RELEASE);
+
+	return true;
+}
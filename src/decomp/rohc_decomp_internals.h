@@ -32,6 +32,12 @@
 #include "rohc_traces_internal.h"
 #include "feedback_create.h"
 #include "crc.h"
+#include "rohc_ctxt_pool.h"
+#include "rohc_load_pool.h"
+#include "rohc_pkt_log.h"
+#include "rohc_seqcount.h"
+#include "rohc_timings_internal.h"
+#include "rohc_profiles_config.h"
 
 
 /*
@@ -40,7 +46,18 @@
 
 
 /** The number of ROHC profiles ready to be used */
-#define D_NUM_PROFILES 7U
+#define D_NUM_PROFILES ROHC_PROFILES_BUILT_NR
+
+/** The number of packets of a burst whose CIDs are decoded up front to
+ *  prefetch the decompression contexts */
+#define ROHC_DECOMP_BURST_PREFETCH_NR 32U
+
+/** The number of CIDs checked for idle contexts after every packet */
+#define ROHC_DECOMP_IDLE_SWEEP_NR 2U
+
+/** The number of consecutive CIDs in one chunk of statistics of
+ *  decompression contexts */
+#define ROHC_DECOMP_CTXTS_CHUNK_LEN 64U
 
 
 /** Print a warning trace for the given decompression context */
@@ -58,7 +75,8 @@
 /** Dump a buffer for the given compression context */
 #define rohc_decomp_dump_buf(context, descr, buf, buf_len) \
 	do { \
-		if(((context)->decompressor->features & ROHC_DECOMP_FEATURE_DUMP_PACKETS) != 0) { \
+		if(rohc_trace_is_enabled((context)->decompressor, ROHC_TRACE_DEBUG) && \
+		   ((context)->decompressor->features & ROHC_DECOMP_FEATURE_DUMP_PACKETS) != 0) { \
 			rohc_dump_buf((context)->decompressor->trace_callback, \
 			              (context)->decompressor->trace_callback_priv, \
 			              ROHC_TRACE_DECOMP, ROHC_TRACE_DEBUG, \
@@ -78,27 +96,119 @@
 struct d_statistics
 {
 	/* The number of received packets */
-	unsigned long received;
+	uint64_t received;
 	/* The number of bad decompressions due to wrong CRC */
-	unsigned long failed_crc;
+	uint64_t failed_crc;
 	/* The number of bad decompressions due to being in the No Context state */
-	unsigned long failed_no_context;
+	uint64_t failed_no_context;
 	/* The number of bad decompressions */
-	unsigned long failed_decomp;
+	uint64_t failed_decomp;
 
 	/** The cumulative size of the compressed packets */
-	unsigned long total_compressed_size;
+	uint64_t total_compressed_size;
 	/** The cumulative size of the uncompressed packets */
-	unsigned long total_uncompressed_size;
+	uint64_t total_uncompressed_size;
 
 	/** The cumulative number of successful corrections upon CRC failure */
-	unsigned long corrected_crc_failures;
+	uint64_t corrected_crc_failures;
 	/** The cumulative number of successful corrections of SN wraparound
 	 *  upon CRC failure */
-	unsigned long corrected_sn_wraparounds;
+	uint64_t corrected_sn_wraparounds;
 	/** The cumulative number of successful corrections of incorrect SN updates
 	 *  upon CRC failure */
-	unsigned long corrected_wrong_sn_updates;
+	uint64_t corrected_wrong_sn_updates;
+	/** The cumulative number of repairs attempted upon CRC failure */
+	uint64_t crc_repair_attempts;
+	/** The cumulative number of repairs not attempted upon CRC failure
+	 *  because the repair budget was exhausted */
+	uint64_t crc_repair_skipped;
+	/** The cumulative number of late packets decoded against a previous SN
+	 *  reference */
+	uint64_t late_pkts_decoded;
+	/** The cumulative number of CRC failures not decoded again because of
+	 *  the real-time mode */
+	uint64_t rt_attempts_capped;
+};
+
+
+/** Whether the durations of the decompression phases shall be measured */
+#define rohc_decomp_timings_enabled(decomp) \
+	(ROHC_TIMINGS_BUILT && \
+	 ((decomp)->features & ROHC_DECOMP_FEATURE_TIMINGS) != 0)
+
+/** Read the clock if the durations of the decompression phases are measured */
+#define rohc_decomp_ticks(decomp) \
+	(rohc_decomp_timings_enabled(decomp) ? rohc_ticks_now() : 0)
+
+
+/**
+ * @brief The statistics of one decompression context
+ *
+ * The statistics are copied from the context after every packet, so that
+ * they may be read by \ref rohc_decomp_get_ctxts_stats while packets are
+ * decompressed. The statistics of one context fill their own cache lines and
+ * are protected by a sequence counter.
+ */
+struct rohc_decomp_ctxt_stats
+{
+	/** The sequence counter, odd while the statistics are updated */
+	rohc_seqcount_t seq;
+
+	/** Whether the context is in use or not */
+	bool used;
+	/** The ID of the profile of the context */
+	rohc_profile_t profile_id;
+	/** The operation mode of the context */
+	rohc_mode_t mode;
+	/** The operation state of the context */
+	rohc_decomp_state_t state;
+	/** The type of the last decompressed ROHC packet */
+	rohc_packet_t packet_type;
+
+	/** The number of packets received by the context */
+	uint64_t packets_nr;
+	/** The cumulative size of the compressed packets */
+	uint64_t comp_bytes_nr;
+	/** The cumulative size of the uncompressed packets */
+	uint64_t uncomp_bytes_nr;
+	/** The cumulative size of the compressed headers */
+	uint64_t comp_hdr_bytes_nr;
+	/** The cumulative size of the uncompressed headers */
+	uint64_t uncomp_hdr_bytes_nr;
+	/** The number of successful corrections upon CRC failure */
+	uint64_t corrected_crc_failures;
+	/** The number of successful corrections of SN wraparound */
+	uint64_t corrected_sn_wraparounds;
+	/** The number of successful corrections of incorrect SN updates */
+	uint64_t corrected_wrong_sn_updates;
+	/** The number of (possible) lost packet(s) before the last packet */
+	uint64_t nr_lost_packets;
+	/** The number of packet(s) before the last packet if late */
+	uint64_t nr_misordered_packets;
+	/** The number of repairs attempted upon CRC failure */
+	uint64_t crc_repair_attempts;
+	/** The number of repairs skipped because of the repair budget */
+	uint64_t crc_repair_skipped;
+	/** The number of late packets decoded against a previous SN reference */
+	uint64_t late_pkts_decoded;
+} __attribute__((aligned(ROHC_CACHE_LINE_LEN)));
+
+
+/**
+ * @brief One chunk of statistics of decompression contexts
+ *
+ * The statistics are allocated by chunks of \ref ROHC_DECOMP_CTXTS_CHUNK_LEN
+ * consecutive CIDs when the first context of the chunk is created, so that a
+ * decompressor with a large MAX_CID is cheap to create when few flows are
+ * expected, see \ref rohc_decomp_reserve_contexts. The chunks are never
+ * freed before the decompressor is destroyed.
+ */
+struct rohc_decomp_ctxts_chunk
+{
+	/** The statistics of the contexts of the chunk */
+	struct rohc_decomp_ctxt_stats stats[ROHC_DECOMP_CTXTS_CHUNK_LEN];
+	/** The memory allocated for the chunk, before cache line alignment */
+	void *mem;
 };
 
 
@@ -113,6 +223,9 @@ struct rohc_ack_rate_limit
 	size_t k;          /**< The k rate-limit parameter */
 	size_t n;          /**< The n rate-limit parameter */
 	size_t threshold;  /**< The computed k/n ratio */
+	/** The k/n ratio as a number of packets out of the last 32 packets, to be
+	 *  compared directly with the population count of a history bitmap */
+	size_t pkts_nr;
 };
 
 
@@ -136,6 +249,51 @@ struct rohc_ack_stats
 };
 
 
+/** The number of packets recorded by the feedback history bitmaps */
+#define ROHC_DECOMP_FB_HIST_LEN  32U
+
+/**
+ * @brief The history of the last packets for feedback rate-limiting
+ *
+ * The packets that neither failed nor required any feedback are not pushed
+ * in the bitmaps one by one: they are only counted, and the bitmaps are
+ * shifted all at once the next time they are needed. This keeps the
+ * bookkeeping of the U-mode streams, that seldom need any feedback, cheap.
+ */
+struct rohc_decomp_fb_hist
+{
+	/** Whether the last decompressed packets failed or not */
+	uint32_t errors;
+	/** The needed/sent feedbacks over the last packets */
+	struct rohc_ack_stats feedbacks[ROHC_FEEDBACK_RESERVED];
+	/** The number of packets not pushed in the bitmaps yet */
+	size_t unpushed_nr;
+	/** The number of packets decompressed in a row without any error */
+	size_t clean_nr;
+};
+
+
+/** The max number of previous SN references kept by the reorder window */
+#define ROHC_DECOMP_REORDER_WINDOW_MAX  8U
+
+/** The number of SNs recorded as received to decode every late packet once */
+#define ROHC_DECOMP_SN_RCVD_SPAN  64U
+
+/** The max number of contexts with a delayed positive ACK */
+#define ROHC_DECOMP_PENDING_ACKS_MAX  16U
+
+/** One positive ACK delayed to be coalesced with the next ACKs */
+struct rohc_decomp_pending_ack
+{
+	rohc_cid_t cid;            /**< The CID of the acknowledged context */
+	rohc_profile_t profile_id; /**< The profile of the acknowledged context */
+	rohc_mode_t mode;          /**< The mode of the acknowledged context */
+	uint32_t sn_bits;          /**< The SN LSB bits of the last ACKed packet */
+	size_t sn_bits_nr;         /**< The number of SN LSB bits */
+	uint64_t delayed_since;    /**< The packet clock when the ACK was delayed */
+};
+
+
 /**
  * @brief The ROHC decompressor
  */
@@ -155,10 +313,57 @@ struct rohc_decomp
 
 	/** The array of decompression contexts that use the decompressor */
 	struct rohc_decomp_ctxt **contexts;
+	/** The chunks of statistics of the decompression contexts, one per
+	 *  \ref ROHC_DECOMP_CTXTS_CHUNK_LEN CIDs, NULL while no context of the
+	 *  chunk was ever created */
+	struct rohc_decomp_ctxts_chunk **ctxts_chunks;
+	/** The number of chunks of statistics allocated */
+	size_t ctxts_chunks_nr;
+	/** The bitmap of the CIDs in use, to walk the contexts in use only */
+	uint64_t *ctxts_used;
 	/** The number of decompression contexts in use */
 	size_t num_contexts_used;
 	/** The last decompression context used by the decompressor */
 	struct rohc_decomp_ctxt *last_context;
+	/** The memory blocks of the destroyed contexts, kept for the new ones */
+	struct rohc_ctxt_pool ctxt_pool;
+	/** The pool the memory blocks of the contexts are got from and given
+	 *  back to: \e ctxt_pool, or the pool of the worker thread that runs the
+	 *  channel of the decompressor, see \ref rohc_channels_next */
+	struct rohc_ctxt_pool *cur_ctxt_pool;
+	/** The slabs the chunks of statistics are carved from, unused without
+	 *  huge pages nor NUMA node, see \ref rohc_decomp_set_huge_pages */
+	struct rohc_ctxt_pool ctxts_chunks_pool;
+	/** The payloads of variable lengths remembered by the contexts, eg. the
+	 *  TCP generic options, shared by all the contexts */
+	struct rohc_load_pool loads_pool;
+	/** The NUMA node the memory of the decompressor is bound to,
+	 *  ROHC_NUMA_NODE_ANY if none, see \ref rohc_decomp_new3 */
+	int numa_node;
+	/** The dense array of context slots, NULL if the contexts are allocated
+	 *  from the pool, see \ref rohc_decomp_set_dense_contexts */
+	uint8_t *dense_ctxts;
+	/** The memory allocated for the dense array, before cache line
+	 *  alignment, in the same memory as \e ctxts_chunks_pool */
+	void *dense_ctxts_mem;
+	/** The length of one slot: the context, then its profile-specific parts */
+	size_t dense_slot_len;
+	/** The number of slots: one per CID, plus one for the context that
+	 *  replaces an existing one until the replacement is done */
+	size_t dense_slots_nr;
+	/** The slot freed last, the first one tried when the slot of the CID
+	 *  is in use */
+	size_t dense_free_hint;
+	/** The scratch memory for the volatile part of the contexts, one per
+	 *  enabled profile: one packet is decoded at a time, so the contexts of
+	 *  one profile share it, see \ref rohc_decomp_volat_ctxt */
+	void *volat_scratch[D_NUM_PROFILES];
+	/** The time after which an unused context is destroyed (in seconds),
+	 *  0 if idle contexts are kept, see
+	 *  \ref rohc_decomp_set_ctxts_idle_timeout */
+	uint64_t ctxts_idle_timeout;
+	/** The next CID to check for an idle context */
+	rohc_cid_t idle_sweep_cid;
 
 
 	/* feedback-related variables */
@@ -169,41 +374,140 @@ struct rohc_decomp
 	size_t sn_feedback_min_bits;
 	/** The configuration for feedback rate-limiting */
 	struct rohc_ack_rate_limits ack_rate_limits;
-	/** Whether the last decompressed packets failed or not */
-	uint32_t last_pkts_errors;
-	/** The informations for feedback rate-limiting */
-	struct rohc_ack_stats last_pkt_feedbacks[ROHC_FEEDBACK_RESERVED];
+	/** The history of the last packets for feedback rate-limiting */
+	struct rohc_decomp_fb_hist fb_hist;
+	/** The max number of packets a positive ACK may be delayed to be
+	 *  coalesced with the next ones, 0 if ACKs are not delayed, see
+	 *  \ref rohc_decomp_set_feedback_coalescing */
+	size_t ack_coalescing_window;
+	/** The number of packets handled by the decompressor, to age the
+	 *  delayed ACKs */
+	uint64_t ack_coalescing_clock;
+	/** The delayed positive ACKs, at most one per CID, the oldest first */
+	struct rohc_decomp_pending_ack pending_acks[ROHC_DECOMP_PENDING_ACKS_MAX];
+	/** The number of delayed positive ACKs */
+	size_t pending_acks_nr;
+
+
+	/* CRC repair-related variables */
+
+	/** The max number of repairs per context and per second, 0 for no limit */
+	size_t crc_repair_ctxt_budget;
+	/** The max number of repairs for all contexts per second, 0 for no limit */
+	size_t crc_repair_global_budget;
+	/** The second of packet arrival time that \e crc_repair_global_used
+	 *  counts the repairs for */
+	uint64_t crc_repair_global_sec;
+	/** The number of repairs attempted for all contexts during the second
+	 *  \e crc_repair_global_sec */
+	size_t crc_repair_global_used;
+
+	/** The number of previous SN references every context keeps to decode
+	 *  the late packets, 0 to disable, see \ref rohc_decomp_set_reorder_window */
+	size_t reorder_window;
+
+	/** The policy to choose the operational mode of the contexts, see
+	 *  \ref rohc_decomp_set_mode_policy */
+	rohc_decomp_mode_policy_t mode_policy;
+	/** The error rate that moves one context to O-mode with the adaptive
+	 *  policy of operational modes */
+	struct rohc_ack_rate_limit mode_errors;
 
 
 	/* segment-related variables */
 
 /** The maximal value for MRRU */
 #define ROHC_MAX_MRRU 65535
-	/** The Reconstructed Reception Unit */
-	uint8_t rru[ROHC_MAX_MRRU];
+	/** The Reconstructed Reception Unit, MRRU bytes allocated only when
+	 *  segmentation is enabled */
+	uint8_t *rru;
 	/** The length (in bytes) of the Reconstructed Reception Unit */
 	size_t rru_len;
 	/** The Maximum Reconstructed Reception Unit (MRRU) */
 	size_t mrru;
-
-
-	/* CRC-related variables: */
-
-	/** The table to enable fast CRC-3 computation */
-	uint8_t crc_table_3[256];
-	/** The table to enable fast CRC-7 computation */
-	uint8_t crc_table_7[256];
-	/** The table to enable fast CRC-8 computation */
-	uint8_t crc_table_8[256];
+	/** The FCS-32 CRC of the first bytes of the RRU, computed as the
+	 *  segments arrive */
+	uint32_t rru_crc;
+	/** The number of bytes of the RRU already covered by \e rru_crc */
+	size_t rru_crc_len;
+
+/** The max length of the RRU prefix linearized to parse the ROHC header of
+ *  an RRU given as a scatter list of segments */
+#define ROHC_DECOMP_RRU_HDR_MAX  1024U
+	/** The segments of the RRU decoded by \ref rohc_decompress_segments,
+	 *  NULL otherwise */
+	const struct rohc_buf *rru_segs;
+	/** The number of segments in \e rru_segs */
+	size_t rru_segs_nr;
+	/** The offset in the RRU of the payload bytes that are not part of the
+	 *  parsed RRU prefix */
+	size_t rru_tail_off;
+	/** The number of payload bytes that are not part of the parsed RRU
+	 *  prefix, or that follow the ROHC packet given to
+	 *  \ref rohc_decompress_iov */
+	size_t rru_tail_len;
+	/** The payload of the packet decoded by \ref rohc_decompress_iov, NULL if
+	 *  the payload shall be copied in the uncompressed packet */
+	struct rohc_buf *payload_ref;
+	/** Whether the received feedback shall reference the ROHC packet instead
+	 *  of being copied, see \ref rohc_decompress_fb_views */
+	bool rcvd_feedback_ref;
+
+	/** The ring of the feedbacks to send returned as views by
+	 *  \ref rohc_decompress_fb_views, NULL if disabled */
+	uint8_t *fb_ring;
+	/** The number of slots of the ring minus one, the number of slots is a
+	 *  power of 2 */
+	size_t fb_ring_mask;
+	/** The length (in bytes) of one slot of the ring */
+	size_t fb_ring_slot_len;
+	/** The number of slots of the ring ever filled, the next slot to fill is
+	 *  at index (fb_ring_next & fb_ring_mask) */
+	size_t fb_ring_next;
+	/** The RRU prefix linearized when the first segment is too short */
+	uint8_t rru_hdr[ROHC_DECOMP_RRU_HDR_MAX];
 
 
 	/** Some statistics about the decompression processes */
 	struct d_statistics stats;
 
+#ifdef ROHC_TIMINGS
+	/** The histograms of the durations of the decompression phases */
+	rohc_timings_histo_t timings[ROHC_PACKET_MAX][ROHC_DECOMP_PHASE_MAX];
+	/** The histograms of the durations of the decompression phases, per
+	 *  profile (in the order of the profiles of the library) */
+	rohc_timings_histo_t
+		timings_profiles[D_NUM_PROFILES][ROHC_DECOMP_PHASE_MAX];
+	/** The durations of the phases of the current packet */
+	rohc_ticks_t timings_pending[ROHC_DECOMP_PHASE_MAX];
+	/** Whether \e timings_pending shall be recorded with the current packet */
+	bool timings_are_pending;
+#endif
+
 	/** The callback function used to manage traces */
 	rohc_trace_callback2_t trace_callback;
 	/** The private context of the callback function used to manage traces */
 	void *trace_callback_priv;
+	/** The minimum level of the traces given to the callback function */
+	rohc_trace_level_t trace_level;
+	/** The sampling of the traces */
+	struct rohc_trace_sampling trace_sampling;
+	/** The minimum level of the traces for the current packet, chosen by
+	 *  the trace sampling */
+	rohc_trace_level_t trace_sampled_level;
+	/** The minimum level of the traces for the current packet, points to
+	 *  \e trace_sampled_level */
+	const rohc_trace_level_t *trace_pkt_level;
+
+	/** The callback function called for the events of the contexts, NULL if
+	 *  none */
+	rohc_decomp_event_callback_t event_cb;
+	/** The private context of the callback for the events of the contexts */
+	void *event_cb_priv;
+
+	/** The log of the last decompressed packets, see
+	 *  rohc_decomp_set_pkt_log() */
+	struct rohc_pkt_log pkt_log;
 };
 
 
@@ -234,6 +538,11 @@ struct rohc_decomp_crc_corr_ctxt
 	size_t arrival_times_nr;
 	/** The index for the arrival time of the next packet */
 	size_t arrival_times_index;
+	/** The second of packet arrival time that \e budget_used counts the
+	 *  repairs for */
+	uint64_t budget_sec;
+	/** The number of repairs attempted during the second \e budget_sec */
+	size_t budget_used;
 };
 
 
@@ -252,6 +561,12 @@ struct rohc_decomp_crc
  * The volatile part of the ROHC decompression context lasts only one single
  * packet. Between two ROHC packets, the volatile part of the context is
  * erased.
+ *
+ * The extracted bits and the decoded values are not allocated with the
+ * context: they point to the scratch memory that the decompressor keeps for
+ * the profile of the context. The scratch memory of one profile is shared by
+ * all its contexts and by the successive packets, so the profiles shall not
+ * expect it to be untouched between two packets of the same context.
  */
 struct rohc_decomp_volat_ctxt
 {
@@ -259,11 +574,12 @@ struct rohc_decomp_volat_ctxt
 	struct rohc_decomp_crc crc;
 
 	/** The profile-specific data for bits extracted from the ROHC packet,
-	 * defined by the profiles */
+	 * defined by the profiles, in the scratch memory of the decompressor */
 	void *extr_bits;
 
 	/** The profile-specific data for values decoded from persistent context
-	 * and bits extracted from the ROHC packet, defined by the profiles */
+	 * and bits extracted from the ROHC packet, defined by the profiles, in the
+	 * scratch memory of the decompressor */
 	void *decoded_values;
 };
 
@@ -273,18 +589,17 @@ struct rohc_decomp_volat_ctxt
  */
 struct rohc_decomp_ctxt
 {
-	/** The Context IDentifier (CID) */
-	rohc_cid_t cid;
-
-	/** The associated decompressor */
-	struct rohc_decomp *decompressor;
+	/* the fields read for every ROHC packet come first, so that they share
+	 * the first cache line of the context */
 
 	/** The associated profile */
 	const struct rohc_decomp_profile *profile;
 	/** The persistent profile-specific data, defined by the profiles */
 	void *persist_ctxt;
-	/** The volatile data, erased between two ROHC packets */
-	struct rohc_decomp_volat_ctxt volat_ctxt;
+	/** The associated decompressor */
+	struct rohc_decomp *decompressor;
+	/** The Context IDentifier (CID) */
+	rohc_cid_t cid;
 
 	/** The operation mode in which the context operates */
 	rohc_mode_t mode;
@@ -296,44 +611,51 @@ struct rohc_decomp_ctxt
 	/** Usage timestamp */
 	unsigned int first_used;
 
-	/** Whether the last decompressed packets failed or not */
-	uint32_t last_pkts_errors;
-	/** The informations for feedback rate-limiting */
-	struct rohc_ack_stats last_pkt_feedbacks[ROHC_FEEDBACK_RESERVED];
+	/** The history of the last packets for feedback rate-limiting */
+	struct rohc_decomp_fb_hist fb_hist;
+
+	/** The type of the last decompressed ROHC packet */
+	rohc_packet_t packet_type;
+	/** Is last packet a (possible) duplicated packet? */
+	bool is_duplicated;
+
+	/** The volatile data, erased between two ROHC packets */
+	struct rohc_decomp_volat_ctxt volat_ctxt;
 
 	/** The context for corrections upon CRC failure */
 	struct rohc_decomp_crc_corr_ctxt crc_corr;
 
 	/* below are some statistics */
 
-	/** The type of the last decompressed ROHC packet */
-	rohc_packet_t packet_type;
-
 	/** The average size of the uncompressed packets */
-	unsigned long total_uncompressed_size;
+	uint64_t total_uncompressed_size;
 	/** The average size of the compressed packets */
-	unsigned long total_compressed_size;
+	uint64_t total_compressed_size;
 	/** The average size of the uncompressed headers */
-	unsigned long header_uncompressed_size;
+	uint64_t header_uncompressed_size;
 	/** The average size of the compressed headers */
-	unsigned long header_compressed_size;
+	uint64_t header_compressed_size;
 
 	/* The number of received packets */
-	unsigned long num_recv_packets;
+	uint64_t num_recv_packets;
 	/** The number of successful corrections upon CRC failure */
-	unsigned long corrected_crc_failures;
+	uint64_t corrected_crc_failures;
 	/** The number of successful corrections of SN wraparound upon CRC failure */
-	unsigned long corrected_sn_wraparounds;
+	uint64_t corrected_sn_wraparounds;
 	/** The number of successful corrections of incorrect SN updates upon CRC
 	 *  failure */
-	unsigned long corrected_wrong_sn_updates;
+	uint64_t corrected_wrong_sn_updates;
+	/** The number of repairs attempted upon CRC failure */
+	uint64_t crc_repair_attempts;
+	/** The number of repairs skipped because of the repair budget */
+	uint64_t crc_repair_skipped;
+	/** The number of late packets decoded against a previous SN reference */
+	uint64_t late_pkts_decoded;
 
 	/** The number of (possible) lost packet(s) before last packet */
-	unsigned long nr_lost_packets;
+	rohc_ctxt_counter_t nr_lost_packets;
 	/** The number of packet(s) before the last packet if late */
-	unsigned long nr_misordered_packets;
-	/** Is last packet a (possible) duplicated packet? */
-	bool is_duplicated;
+	rohc_ctxt_counter_t nr_misordered_packets;
 };
 
 
@@ -342,9 +664,10 @@ typedef bool (*rohc_decomp_new_context_t)(const struct rohc_decomp_ctxt *const c
                                           struct rohc_decomp_volat_ctxt *const volat_ctxt)
 	__attribute__((warn_unused_result, nonnull(1, 2, 3)));
 
-typedef void (*rohc_decomp_free_context_t)(void *const persist_ctxt,
+typedef void (*rohc_decomp_free_context_t)(const struct rohc_decomp_ctxt *const context,
+                                           void *const persist_ctxt,
                                            const struct rohc_decomp_volat_ctxt *const volat_ctxt)
-	__attribute__((nonnull(2)));
+	__attribute__((nonnull(1, 3)));
 
 typedef rohc_packet_t (*rohc_decomp_detect_pkt_type_t) (const struct rohc_decomp_ctxt *const context,
                                                         const uint8_t *const rohc_packet,
@@ -390,6 +713,11 @@ typedef bool (*rohc_decomp_attempt_repair_t)(const struct rohc_decomp *const dec
                                              void *const extr_bits)
 	__attribute__((warn_unused_result, nonnull(1, 2, 4, 5)));
 
+typedef bool (*rohc_decomp_attempt_late_t)(const struct rohc_decomp *const decomp,
+                                           const struct rohc_decomp_ctxt *const context,
+                                           void *const extr_bits)
+	__attribute__((warn_unused_result, nonnull(1, 2, 3)));
+
 typedef uint32_t (*rohc_decomp_get_sn_t)(const struct rohc_decomp_ctxt *const context)
 	__attribute__((warn_unused_result, nonnull(1)));
 
@@ -408,6 +736,15 @@ struct rohc_decomp_profile
 	/** The maximum number of bits of the Master Sequence Number (MSN) */
 	const size_t msn_max_bits;
 
+	/** The max length of the memory block that the profile-specific parts
+	 *  of one context are carved from */
+	const size_t ctxt_block_len;
+
+	/** The length of the bits extracted from one ROHC packet */
+	const size_t extr_bits_len;
+	/** The length of the values decoded for one ROHC packet */
+	const size_t decoded_len;
+
 	/** @brief The handler used to create the profile-specific part of the
 	 *         decompression context */
 	rohc_decomp_new_context_t new_context;
@@ -434,9 +771,68 @@ struct rohc_decomp_profile
 	/* The handler used to attempt packet/context correction upon CRC failure */
 	rohc_decomp_attempt_repair_t attempt_repair;
 
+	/* The handler used to decode a late packet against a previous reference
+	 * upon CRC failure */
+	rohc_decomp_attempt_late_t attempt_late;
+
 	/* The handler used to retrieve the Sequence Number (SN) */
 	rohc_decomp_get_sn_t get_sn;
 };
 
+
+/**
+ * @brief The static chain of the last IR packet of one context
+ *
+ * Most IR packets of one flow are periodic refreshes that repeat the static
+ * chain of the previous IR packet byte for byte. The static chain is thus
+ * kept by the context, and the static chain of the next IR packets is skipped
+ * if it is the same: the static fields are then taken from the context, as
+ * for the IR-DYN packets.
+ *
+ * @see rohc_decomp_static_chain_match
+ */
+struct rohc_decomp_static_chain
+{
+	/** The bytes of the static chain in the pool of the decompressor */
+	rohc_load_ref_t ref;
+	/** The length of the static chain, 0 if there is none */
+	size_t len;
+};
+
+
+/*
+ * Prototypes of library-private functions
+ */
+
+void * rohc_decomp_ctxt_block_get(const struct rohc_decomp_ctxt *const context,
+                                  const size_t size,
+                                  struct rohc_ctxt_arena *const arena)
+	__attribute__((warn_unused_result, nonnull(1)));
+
+void rohc_decomp_ctxt_block_put(const struct rohc_decomp_ctxt *const context,
+                                void *const block)
+	__attribute__((nonnull(1)));
+
+bool rohc_decomp_static_chain_match(const struct rohc_decomp_ctxt *const context,
+                                    const struct rohc_decomp_static_chain *const chain,
+                                    const uint8_t *const data,
+                                    const size_t data_len)
+	__attribute__((warn_unused_result, nonnull(1, 2, 3), pure));
+
+void rohc_decomp_static_chain_store(const struct rohc_decomp_ctxt *const context,
+                                    struct rohc_decomp_static_chain *const chain,
+                                    const uint8_t *const data,
+                                    const size_t len)
+	__attribute__((nonnull(1, 2, 3)));
+
+void rohc_decomp_static_chain_free(const struct rohc_decomp_ctxt *const context,
+                                   struct rohc_decomp_static_chain *const chain)
+	__attribute__((nonnull(1, 2)));
+
+bool rohc_decomp_peek_cid(const struct rohc_decomp *const decomp,
+                          const struct rohc_buf rohc_packet,
+                          rohc_cid_t *const cid)
+	__attribute__((warn_unused_result, nonnull(1, 3)));
+
 #endif
 
@@ -34,12 +34,14 @@
 #include "rohc_packets.h"
 #include "rohc_utils.h"
 #include "rohc_bit_ops.h"
+#include "rohc_cursor.h"
 #include "rohc_decomp_internals.h"
 #include "rohc_decomp_detect_packet.h"
 #include "schemes/decomp_wlsb.h"
 #include "schemes/decomp_list_ipv6.h"
 #include "sdvl.h"
 #include "crc.h"
+#include "rohc_csum.h"
 
 #include "config.h" /* for WORDS_BIGENDIAN definition */
 
@@ -103,6 +105,11 @@ static bool parse_ir(const struct rohc_decomp_ctxt *const context,
                      size_t *const rohc_hdr_len)
 	__attribute__((warn_unused_result, nonnull(1, 2, 5, 6, 7, 8)));
 
+static int parse_static_chain(const struct rohc_decomp_ctxt *const context,
+                              const uint8_t *const rohc_packet,
+                              const size_t rohc_length,
+                              struct rohc_extr_bits *const bits)
+	__attribute__((warn_unused_result, nonnull(1, 2, 4)));
 static bool parse_irdyn(const struct rohc_decomp_ctxt *const context,
                         const uint8_t *const rohc_packet,
                         const size_t rohc_length,
@@ -276,26 +283,31 @@ static int parse_extension2(const struct rohc_decomp_ctxt *const context,
 
 static bool build_uncomp_ip(const struct rohc_decomp_ctxt *const context,
                             const struct rohc_decoded_ip_values decoded,
+                            const struct rohc_decomp_rfc3095_changes *const ip_changes,
                             uint8_t *const dest,
                             const size_t uncomp_hdrs_max_len,
                             size_t *const uncomp_hdrs_len,
                             const size_t payload_size,
-                            const struct list_decomp *const list_decomp)
-	__attribute__((warn_unused_result, nonnull(1, 3, 5)));
+                            struct list_decomp *const list_decomp)
+	__attribute__((warn_unused_result, nonnull(1, 3, 4, 6)));
 static bool build_uncomp_ipv4(const struct rohc_decomp_ctxt *const context,
                               const struct rohc_decoded_ip_values decoded,
+                              const struct rohc_decomp_rfc3095_changes *const ip_changes,
                               uint8_t *const dest,
                               const size_t uncomp_hdrs_max_len,
                               size_t *const uncomp_hdrs_len,
                               const size_t payload_size)
-	__attribute__((warn_unused_result, nonnull(1, 3, 5)));
+	__attribute__((warn_unused_result, nonnull(1, 3, 4, 6)));
+static void rfc3095_decomp_update_ipv4_tmpl(struct rohc_decomp_rfc3095_changes *const ip_changes,
+                                            const struct rohc_decoded_ip_values *const decoded)
+	__attribute__((nonnull(1, 2)));
 static bool build_uncomp_ipv6(const struct rohc_decomp_ctxt *const context,
                               const struct rohc_decoded_ip_values decoded,
                               uint8_t *const dest,
                               const size_t uncomp_hdrs_max_len,
                               size_t *const uncomp_hdrs_len,
                               const size_t payload_size,
-                              const struct list_decomp *const list_decomp)
+                              struct list_decomp *const list_decomp)
 	__attribute__((warn_unused_result, nonnull(1, 3, 5, 7)));
 
 
@@ -349,14 +361,27 @@ static void reset_extr_bits(const struct rohc_decomp_rfc3095_ctxt *const rfc3095
 /**
  * @brief Create the RFC3095 volatile and persistent parts of the context
  *
+ * The persistent part of the context, the profile-specific part, and the
+ * header changes are carved from one single memory block of the pool of the
+ * decompressor. The profile-specific part and the next headers of the header
+ * changes are zeroed. The volatile part of the context lives in the scratch
+ * memory of the decompressor.
+ *
  * This function is one of the functions that must exist in one profile for the
  * framework to work.
  *
  * @param context            The decompression context
  * @param[out] persist_ctxt  The persistent part of the decompression context
  * @param[out] volat_ctxt    The volatile part of the decompression context
+ * @param specific_size      The size of the profile-specific part of the
+ *                           context, 0 if the profile has no specific part
+ * @param next_header_len    The length of the next header stored in the
+ *                           header changes, 0 if there is no next header
  * @param trace_cb           The function to call for printing traces
  * @param trace_cb_priv      An optional private context, may be NULL
+ * @param trace_level        The minimum level of the traces to print
+ * @param trace_pkt_level    The minimum level of the traces for the current
+ *                           packet, NULL if not sampled
  * @param profile_id         The ID of the associated decompression profile
  * @return                   true if the Uncompressed context was successfully
  *                           created, false if a problem occurred
@@ -364,67 +389,76 @@ static void reset_extr_bits(const struct rohc_decomp_rfc3095_ctxt *const rfc3095
 bool rohc_decomp_rfc3095_create(const struct rohc_decomp_ctxt *const context,
                                 struct rohc_decomp_rfc3095_ctxt **const persist_ctxt,
                                 struct rohc_decomp_volat_ctxt *const volat_ctxt,
+                                const size_t specific_size,
+                                const size_t next_header_len,
                                 rohc_trace_callback2_t trace_cb,
                                 void *const trace_cb_priv,
+                                const rohc_trace_level_t trace_level,
+                                const rohc_trace_level_t *const trace_pkt_level,
                                 const int profile_id)
 {
 	struct rohc_decomp_rfc3095_ctxt *rfc3095_ctxt;
+	struct rohc_ctxt_arena arena;
+	size_t block_size;
 
-	/* allocate memory for the generic context */
-	*persist_ctxt = malloc(sizeof(struct rohc_decomp_rfc3095_ctxt));
-	if((*persist_ctxt) == NULL)
+	/* get one memory block for the persistent parts of the context, the
+	 * persistent part comes first in the block, so that the block is given
+	 * back to the pool with it */
+	block_size = ROHC_DECOMP_RFC3095_BLOCK_LEN(specific_size, next_header_len);
+	if(rohc_decomp_ctxt_block_get(context, block_size, &arena) == NULL)
 	{
 		rohc_error(context->decompressor, ROHC_TRACE_DECOMP, context->profile->id,
 		           "no memory for the generic decompression context");
 		goto quit;
 	}
-	rfc3095_ctxt = *persist_ctxt;
-	memset(rfc3095_ctxt, 0, sizeof(struct rohc_decomp_rfc3095_ctxt));
+	rfc3095_ctxt =
+		rohc_ctxt_arena_alloc(&arena, sizeof(struct rohc_decomp_rfc3095_ctxt));
+	*persist_ctxt = rfc3095_ctxt;
 
-	/* create the Offset IP-ID decoding context for outer IP header */
-	rfc3095_ctxt->outer_ip_id_offset_ctxt = ip_id_offset_new();
-	if(rfc3095_ctxt->outer_ip_id_offset_ctxt == NULL)
+	/* the header changes for the outer and inner IP headers, with their next
+	 * headers */
+	rfc3095_ctxt->outer_ip_changes =
+		rohc_ctxt_arena_alloc(&arena, sizeof(struct rohc_decomp_rfc3095_changes));
+	rfc3095_ctxt->inner_ip_changes =
+		rohc_ctxt_arena_alloc(&arena, sizeof(struct rohc_decomp_rfc3095_changes));
+	if(next_header_len > 0)
 	{
-		rohc_error(context->decompressor, ROHC_TRACE_DECOMP, context->profile->id,
-		           "failed to create the Offset IP-ID decoding context for "
-		           "outer IP header");
-		goto free_context;
+		rfc3095_ctxt->outer_ip_changes->next_header =
+			rohc_ctxt_arena_alloc(&arena, next_header_len);
+		rfc3095_ctxt->outer_ip_changes->next_header_len = next_header_len;
+		rfc3095_ctxt->inner_ip_changes->next_header =
+			rohc_ctxt_arena_alloc(&arena, next_header_len);
+		rfc3095_ctxt->inner_ip_changes->next_header_len = next_header_len;
 	}
 
-	/* create the Offset IP-ID decoding context for inner IP header */
-	rfc3095_ctxt->inner_ip_id_offset_ctxt = ip_id_offset_new();
-	if(rfc3095_ctxt->inner_ip_id_offset_ctxt == NULL)
+	/* the profile-specific part */
+	if(specific_size > 0)
 	{
-		rohc_error(context->decompressor, ROHC_TRACE_DECOMP, context->profile->id,
-		           "failed to create the Offset IP-ID decoding context for "
-		           "inner IP header");
-		goto free_outer_ip_id_offset_ctxt;
+		rfc3095_ctxt->specific = rohc_ctxt_arena_alloc(&arena, specific_size);
 	}
-
-	rfc3095_ctxt->outer_ip_changes = malloc(sizeof(struct rohc_decomp_rfc3095_changes));
-	if(rfc3095_ctxt->outer_ip_changes == NULL)
+	else
 	{
-		rohc_error(context->decompressor, ROHC_TRACE_DECOMP, context->profile->id,
-		           "cannot allocate memory for the outer IP header changes");
-		goto free_inner_ip_id_offset_ctxt;
+		rfc3095_ctxt->specific = NULL;
 	}
-	memset(rfc3095_ctxt->outer_ip_changes, 0, sizeof(struct rohc_decomp_rfc3095_changes));
 
-	rfc3095_ctxt->inner_ip_changes = malloc(sizeof(struct rohc_decomp_rfc3095_changes));
-	if(rfc3095_ctxt->inner_ip_changes == NULL)
-	{
-		rohc_error(context->decompressor, ROHC_TRACE_DECOMP, context->profile->id,
-		           "cannot allocate memory for the inner IP header changes");
-		goto free_outer_ip_changes;
-	}
-	memset(rfc3095_ctxt->inner_ip_changes, 0, sizeof(struct rohc_decomp_rfc3095_changes));
+	/* no previous SN reference for the late packets yet */
+	rfc3095_ctxt->sn_prev_refs_nr = 0;
+	rfc3095_ctxt->sn_rcvd_bitmap = 0;
+
+	/* init the Offset IP-ID decoding context for outer IP header */
+	ip_id_offset_init(&rfc3095_ctxt->outer_ip_id_offset_ctxt);
+
+	/* init the Offset IP-ID decoding context for inner IP header */
+	ip_id_offset_init(&rfc3095_ctxt->inner_ip_id_offset_ctxt);
 
 	/* init the context used to compress the list of IPv6 extension headers
 	 * for the outer and inner IP headers */
 	rohc_decomp_list_ipv6_new(&rfc3095_ctxt->list_decomp1,
-	                          trace_cb, trace_cb_priv, profile_id);
+	                          trace_cb, trace_cb_priv, trace_level,
+	                          trace_pkt_level, profile_id);
 	rohc_decomp_list_ipv6_new(&rfc3095_ctxt->list_decomp2,
-	                          trace_cb, trace_cb_priv, profile_id);
+	                          trace_cb, trace_cb_priv, trace_level,
+	                          trace_pkt_level, profile_id);
 
 	/* no default next header */
 	rfc3095_ctxt->next_header_proto = 0;
@@ -433,38 +467,13 @@ bool rohc_decomp_rfc3095_create(const struct rohc_decomp_ctxt *const context,
 	rfc3095_ctxt->compute_crc_static = compute_crc_static;
 	rfc3095_ctxt->compute_crc_dynamic = compute_crc_dynamic;
 
-	/* volatile part of the decompression context */
+	/* volatile part of the decompression context, the extracted bits and
+	 * the decoded values are in the scratch memory of the decompressor */
 	volat_ctxt->crc.type = ROHC_CRC_TYPE_NONE;
 	volat_ctxt->crc.bits_nr = 0;
-	volat_ctxt->extr_bits = malloc(sizeof(struct rohc_extr_bits));
-	if(volat_ctxt->extr_bits == NULL)
-	{
-		rohc_decomp_warn(context, "failed to allocate memory for the volatile part "
-		                 "of one of the RFC3095 decompression context");
-		goto free_inner_ip_changes;
-	}
-	volat_ctxt->decoded_values = malloc(sizeof(struct rohc_decoded_values));
-	if(volat_ctxt->decoded_values == NULL)
-	{
-		rohc_decomp_warn(context, "failed to allocate memory for the volatile part "
-		                 "of one of the RFC3095 decompression context");
-		goto free_extr_bits;
-	}
 
 	return rfc3095_ctxt;
 
-free_extr_bits:
-	zfree(volat_ctxt->extr_bits);
-free_inner_ip_changes:
-	zfree(rfc3095_ctxt->inner_ip_changes);
-free_outer_ip_changes:
-	zfree(rfc3095_ctxt->outer_ip_changes);
-free_inner_ip_id_offset_ctxt:
-	ip_id_offset_free(rfc3095_ctxt->inner_ip_id_offset_ctxt);
-free_outer_ip_id_offset_ctxt:
-	ip_id_offset_free(rfc3095_ctxt->outer_ip_id_offset_ctxt);
-free_context:
-	zfree(rfc3095_ctxt);
 quit:
 	return NULL;
 }
@@ -476,34 +485,26 @@ quit:
  * This function is one of the functions that must exist in one profile for the
  * framework to work.
  *
+ * @param context       The decompression context
  * @param rfc3095_ctxt  The generic decompression context
  * @param volat_ctxt    The volatile part of the decompression context
  */
-void rohc_decomp_rfc3095_destroy(struct rohc_decomp_rfc3095_ctxt *const rfc3095_ctxt,
-                                 const struct rohc_decomp_volat_ctxt *const volat_ctxt)
+void rohc_decomp_rfc3095_destroy(const struct rohc_decomp_ctxt *const context,
+                                 struct rohc_decomp_rfc3095_ctxt *const rfc3095_ctxt,
+                                 const struct rohc_decomp_volat_ctxt *const volat_ctxt __attribute__((unused)))
 {
-	/* free the volatile part of the decompression context */
-	free(volat_ctxt->decoded_values);
-	free(volat_ctxt->extr_bits);
-
-	/* destroy Offset IP-ID decoding contexts */
-	ip_id_offset_free(rfc3095_ctxt->outer_ip_id_offset_ctxt);
-	ip_id_offset_free(rfc3095_ctxt->inner_ip_id_offset_ctxt);
-
-	/* destroy the information about the IP headers */
-	zfree(rfc3095_ctxt->outer_ip_changes);
-	zfree(rfc3095_ctxt->inner_ip_changes);
-
 	/* destroy contexts used to decompress the lists of IPv6 extension headers
 	 * for outer and inner IP headers */
 	rohc_decomp_list_ipv6_free(&rfc3095_ctxt->list_decomp1);
 	rohc_decomp_list_ipv6_free(&rfc3095_ctxt->list_decomp2);
 
-	/* destroy profile-specific part */
-	zfree(rfc3095_ctxt->specific);
+	/* forget the static chain of the last IR packet */
+	rohc_decomp_static_chain_free(context, &rfc3095_ctxt->static_chain);
 
-	/* destroy generic context itself */
-	free(rfc3095_ctxt);
+	/* give the memory block of the context back to the pool: the header
+	 * changes and the profile-specific part of the context belong to the
+	 * same block */
+	rohc_decomp_ctxt_block_put(context, rfc3095_ctxt);
 }
 
 
@@ -767,6 +768,119 @@ static bool parse_ir(const struct rohc_decomp_ctxt *const context,
 	rohc_remain_len--;
 	(*rohc_hdr_len)++;
 
+	/* skip the static chain if it is the one kept by the context, the static
+	 * fields are then taken from the context as for IR-DYN packets */
+	if(rohc_decomp_static_chain_match(context, &rfc3095_ctxt->static_chain,
+	                                  rohc_remain_data, rohc_remain_len))
+	{
+		rohc_decomp_debug(context, "%zu-byte static chain is the one of the "
+		                  "context", rfc3095_ctxt->static_chain.len);
+		size = rfc3095_ctxt->static_chain.len;
+	}
+	else
+	{
+		size = parse_static_chain(context, rohc_remain_data, rohc_remain_len,
+		                          bits);
+		if(size == -1)
+		{
+			goto error;
+		}
+		bits->static_chain = rohc_remain_data;
+		bits->static_chain_len = size;
+	}
+	rohc_remain_data += size;
+	rohc_remain_len -= size;
+	*rohc_hdr_len += size;
+
+	/* decode the dynamic part of the ROHC packet */
+	if(dynamic_present)
+	{
+		/* decode the dynamic part of the outer IP header */
+		size = parse_dynamic_part_ip(context, rohc_remain_data, rohc_remain_len,
+		                             &bits->outer_ip, &rfc3095_ctxt->list_decomp1);
+		if(size == -1)
+		{
+			rohc_decomp_warn(context, "cannot parse outer IP dynamic part");
+			goto error;
+		}
+		rohc_remain_data += size;
+		rohc_remain_len -= size;
+		*rohc_hdr_len += size;
+
+		/* decode the dynamic part of the inner IP header */
+		if(bits->multiple_ip)
+		{
+			size = parse_dynamic_part_ip(context, rohc_remain_data, rohc_remain_len,
+			                             &bits->inner_ip, &rfc3095_ctxt->list_decomp2);
+			if(size == -1)
+			{
+				rohc_decomp_warn(context, "cannot parse inner IP dynamic part");
+				goto error;
+			}
+			rohc_remain_data += size;
+			rohc_remain_len -= size;
+			*rohc_hdr_len += size;
+		}
+
+		/* parse the dynamic part of the next header header if necessary */
+		if(rfc3095_ctxt->parse_dyn_next_hdr != NULL)
+		{
+			size = rfc3095_ctxt->parse_dyn_next_hdr(context, rohc_remain_data,
+			                                        rohc_remain_len, bits);
+			if(size == -1)
+			{
+				rohc_decomp_warn(context, "cannot parse next header dynamic part");
+				goto error;
+			}
+#ifndef __clang_analyzer__ /* silent warning about dead increment */
+			rohc_remain_data += size;
+			rohc_remain_len -= size;
+#endif
+			*rohc_hdr_len += size;
+		}
+	}
+	else if(context->state != ROHC_DECOMP_STATE_FC)
+	{
+		/* in 'Static Context' or 'No Context' state and the packet does not
+		 * contain a dynamic part */
+		rohc_decomp_warn(context, "receive IR packet without a dynamic part, "
+		                 "but not in Full Context state");
+		goto error;
+	}
+
+	/* sanity checks */
+	assert((*rohc_hdr_len) <= rohc_length);
+
+	/* IR packet was successfully parsed */
+	return true;
+
+error:
+	return false;
+}
+
+
+/**
+ * @brief Parse the static chain of one IR packet
+ *
+ * @param context      The decompression context
+ * @param rohc_packet  The static chain of the ROHC packet to parse
+ * @param rohc_length  The remaining length of the ROHC packet
+ * @param[out] bits    The bits extracted from the static chain
+ * @return             The length of the static chain,
+ *                     -1 if the ROHC packet is malformed
+ */
+static int parse_static_chain(const struct rohc_decomp_ctxt *const context,
+                              const uint8_t *const rohc_packet,
+                              const size_t rohc_length,
+                              struct rohc_extr_bits *const bits)
+{
+	const struct rohc_decomp_rfc3095_ctxt *const rfc3095_ctxt =
+		context->persist_ctxt;
+	const uint8_t *rohc_remain_data = rohc_packet;
+	size_t rohc_remain_len = rohc_length;
+	int parsed_len = 0;
+	int size;
+
 	/* decode the static part of the outer header */
 	size = parse_static_part_ip(context, rohc_remain_data, rohc_remain_len,
 	                            &bits->outer_ip);
@@ -777,7 +891,7 @@ static bool parse_ir(const struct rohc_decomp_ctxt *const context,
 	}
 	rohc_remain_data += size;
 	rohc_remain_len -= size;
-	*rohc_hdr_len += size;
+	parsed_len += size;
 
 	/* check for IP version switch during context re-use */
 	if(context->num_recv_packets >= 1 &&
@@ -832,7 +946,7 @@ static bool parse_ir(const struct rohc_decomp_ctxt *const context,
 		}
 		rohc_remain_data += size;
 		rohc_remain_len -= size;
-		*rohc_hdr_len += size;
+		parsed_len += size;
 
 		/* check for IP version switch during context re-use */
 		if(context->num_recv_packets >= 1 &&
@@ -856,75 +970,17 @@ static bool parse_ir(const struct rohc_decomp_ctxt *const context,
 			rohc_decomp_warn(context, "cannot parse next header static part");
 			goto error;
 		}
+#ifndef __clang_analyzer__ /* silent warning about dead increment */
 		rohc_remain_data += size;
 		rohc_remain_len -= size;
-		*rohc_hdr_len += size;
-	}
-
-	/* decode the dynamic part of the ROHC packet */
-	if(dynamic_present)
-	{
-		/* decode the dynamic part of the outer IP header */
-		size = parse_dynamic_part_ip(context, rohc_remain_data, rohc_remain_len,
-		                             &bits->outer_ip, &rfc3095_ctxt->list_decomp1);
-		if(size == -1)
-		{
-			rohc_decomp_warn(context, "cannot parse outer IP dynamic part");
-			goto error;
-		}
-		rohc_remain_data += size;
-		rohc_remain_len -= size;
-		*rohc_hdr_len += size;
-
-		/* decode the dynamic part of the inner IP header */
-		if(bits->multiple_ip)
-		{
-			size = parse_dynamic_part_ip(context, rohc_remain_data, rohc_remain_len,
-			                             &bits->inner_ip, &rfc3095_ctxt->list_decomp2);
-			if(size == -1)
-			{
-				rohc_decomp_warn(context, "cannot parse inner IP dynamic part");
-				goto error;
-			}
-			rohc_remain_data += size;
-			rohc_remain_len -= size;
-			*rohc_hdr_len += size;
-		}
-
-		/* parse the dynamic part of the next header header if necessary */
-		if(rfc3095_ctxt->parse_dyn_next_hdr != NULL)
-		{
-			size = rfc3095_ctxt->parse_dyn_next_hdr(context, rohc_remain_data,
-			                                        rohc_remain_len, bits);
-			if(size == -1)
-			{
-				rohc_decomp_warn(context, "cannot parse next header dynamic part");
-				goto error;
-			}
-#ifndef __clang_analyzer__ /* silent warning about dead increment */
-			rohc_remain_data += size;
-			rohc_remain_len -= size;
 #endif
-			*rohc_hdr_len += size;
-		}
+		parsed_len += size;
 	}
-	else if(context->state != ROHC_DECOMP_STATE_FC)
-	{
-		/* in 'Static Context' or 'No Context' state and the packet does not
-		 * contain a dynamic part */
-		rohc_decomp_warn(context, "receive IR packet without a dynamic part, "
-		                 "but not in Full Context state");
-		goto error;
-	}
-
-	/* sanity checks */
-	assert((*rohc_hdr_len) <= rohc_length);
 
-	/* IR packet was successfully parsed */
-	return true;
+	return parsed_len;
 
 error:
-	return false;
+	return -1;
 }
 
 
@@ -1354,7 +1410,7 @@ error:
 uint32_t rohc_decomp_rfc3095_get_sn(const struct rohc_decomp_ctxt *const context)
 {
 	const struct rohc_decomp_rfc3095_ctxt *const rfc3095_ctxt = context->persist_ctxt;
-	return rohc_lsb_get_ref(rfc3095_ctxt->sn_lsb_ctxt, ROHC_LSB_REF_0);
+	return rohc_lsb_get_ref(&rfc3095_ctxt->sn_lsb_ctxt, ROHC_LSB_REF_0);
 }
 
 
@@ -1623,10 +1679,9 @@ static bool parse_uo1(const struct rohc_decomp_ctxt *const context,
 	struct rohc_decomp_rfc3095_ctxt *rfc3095_ctxt;
 	size_t rohc_remainder_len;
 
-	/* remaining ROHC data not parsed yet and the length of the ROHC headers
-	   (will be computed during parsing) */
-	const uint8_t *rohc_remain_data;
-	size_t rohc_remain_len;
+	/* remaining ROHC data not parsed yet */
+	struct rohc_cursor remain;
+	uint8_t byte;
 
 	/* which IP header is the innermost IPv4 header with non-random IP-ID ? */
 	ip_header_pos_t innermost_ipv4_non_rnd;
@@ -1639,9 +1694,7 @@ static bool parse_uo1(const struct rohc_decomp_ctxt *const context,
 	assert(bits != NULL);
 	assert(rohc_hdr_len != NULL);
 
-	rohc_remain_data = rohc_packet;
-	rohc_remain_len = rohc_length;
-	*rohc_hdr_len = 0;
+	rohc_cursor_init(&remain, rohc_packet, rohc_length);
 
 	/* reset all extracted bits */
 	reset_extr_bits(rfc3095_ctxt, bits);
@@ -1679,19 +1732,21 @@ static bool parse_uo1(const struct rohc_decomp_ctxt *const context,
 		goto error;
 	}
 
-	/* check if the rohc packet is large enough to parse parts 2, 3 and 4 */
-	if(rohc_remain_len <= (1 + large_cid_len))
+	/* check once if the ROHC packet is large enough to parse parts 2, 3
+	 * and 4 */
+	if(!rohc_cursor_has(&remain, 1 + large_cid_len + 1))
 	{
 		rohc_decomp_warn(context, "ROHC packet too small (len = %zu)",
-		                 rohc_remain_len);
+		                 rohc_length);
 		goto error;
 	}
 
 	/* part 2: 2-bit "10" + 6-bit IP-ID */
-	assert(GET_BIT_6_7(rohc_remain_data) == 0x02);
+	byte = rohc_cursor_get8(&remain);
+	assert(GET_BIT_6_7(&byte) == 0x02);
 	if(innermost_ipv4_non_rnd == ROHC_IP_HDR_FIRST)
 	{
-		bits->outer_ip.id = GET_BIT_0_5(rohc_remain_data);
+		bits->outer_ip.id = GET_BIT_0_5(&byte);
 		bits->outer_ip.id_nr = 6;
 		bits->outer_ip.is_id_enc = true;
 		rohc_decomp_debug(context, "%zd IP-ID bits for IP header #%u = 0x%x",
@@ -1700,50 +1755,41 @@ static bool parse_uo1(const struct rohc_decomp_ctxt *const context,
 	}
 	else
 	{
-		bits->inner_ip.id = GET_BIT_0_5(rohc_remain_data);
+		bits->inner_ip.id = GET_BIT_0_5(&byte);
 		bits->inner_ip.id_nr = 6;
 		bits->inner_ip.is_id_enc = true;
 		rohc_decomp_debug(context, "%zd IP-ID bits for IP header #%u = 0x%x",
 		                  bits->inner_ip.id_nr, innermost_ipv4_non_rnd,
 		                  bits->inner_ip.id);
 	}
-	rohc_remain_data++;
-	rohc_remain_len--;
-	(*rohc_hdr_len)++;
 
 	/* part 3: skip large CID (handled elsewhere) */
-	rohc_remain_data += large_cid_len;
-	rohc_remain_len -= large_cid_len;
-	*rohc_hdr_len += large_cid_len;
+	rohc_cursor_skip(&remain, large_cid_len);
 
 	/* part 4: 5-bit SN + 3-bit CRC */
-	bits->sn = GET_BIT_3_7(rohc_remain_data);
+	byte = rohc_cursor_get8(&remain);
+	bits->sn = GET_BIT_3_7(&byte);
 	bits->sn_nr = 5;
 	bits->is_sn_enc = true;
 	rohc_decomp_debug(context, "%zd SN bits = 0x%x", bits->sn_nr, bits->sn);
 	extr_crc->type = ROHC_CRC_TYPE_3;
-	extr_crc->bits = GET_BIT_0_2(rohc_remain_data);
+	extr_crc->bits = GET_BIT_0_2(&byte);
 	extr_crc->bits_nr = 3;
 	rohc_decomp_debug(context, "CRC-%zd found in packet = 0x%02x",
 	                  extr_crc->bits_nr, extr_crc->bits);
-	rohc_remain_data++;
-	rohc_remain_len--;
-	(*rohc_hdr_len)++;
 
 	/* part 5: extension only for UO-1-ID packet */
 
 	/* parts 6, 9, and 13: UO* remainder */
-	if(!parse_uo_remainder(context, rohc_remain_data, rohc_remain_len, bits,
+	if(!parse_uo_remainder(context, remain.data, remain.len, bits,
 	                       &rohc_remainder_len))
 	{
 		rohc_decomp_warn(context, "failed to parse UO-1 remainder");
 		goto error;
 	}
-#ifndef __clang_analyzer__ /* silent warning about dead in/decrement */
-	rohc_remain_data += rohc_remainder_len;
-	rohc_remain_len -= rohc_remainder_len;
-#endif
-	*rohc_hdr_len += rohc_remainder_len;
+	rohc_cursor_skip(&remain, rohc_remainder_len);
+
+	*rohc_hdr_len = rohc_cursor_offset(&remain);
 
 	/* sanity checks */
 	assert((*rohc_hdr_len) <= rohc_length);
@@ -2576,10 +2622,9 @@ static bool parse_uor2(const struct rohc_decomp_ctxt *const context,
 	const struct rohc_decomp_rfc3095_ctxt *const rfc3095_ctxt = context->persist_ctxt;
 	size_t rohc_remainder_len;
 
-	/* remaining ROHC data not parsed yet and the length of the ROHC headers
-	   (will be computed during parsing) */
-	const uint8_t *rohc_remain_data = rohc_packet;
-	size_t rohc_remain_len = rohc_length;
+	/* remaining ROHC data not parsed yet */
+	struct rohc_cursor remain;
+	uint8_t byte;
 
 	/* which IP header is the innermost IPv4 header with non-random IP-ID ? */
 	ip_header_pos_t innermost_ipv4_non_rnd;
@@ -2589,7 +2634,7 @@ static bool parse_uor2(const struct rohc_decomp_ctxt *const context,
 	assert(bits != NULL);
 	assert(rohc_hdr_len != NULL);
 
-	*rohc_hdr_len = 0;
+	rohc_cursor_init(&remain, rohc_packet, rohc_length);
 
 	/* reset all extracted bits */
 	reset_extr_bits(rfc3095_ctxt, bits);
@@ -2621,40 +2666,35 @@ static bool parse_uor2(const struct rohc_decomp_ctxt *const context,
 		goto error;
 	}
 
-	/* check if the ROHC packet is large enough to parse parts 2, 3 and 4 */
-	if(rohc_remain_len < (1 + large_cid_len + 1))
+	/* check once if the ROHC packet is large enough to parse parts 2, 3
+	 * and 4 */
+	if(!rohc_cursor_has(&remain, 1 + large_cid_len + 1))
 	{
 		rohc_decomp_warn(context, "ROHC packet too small (len = %zu)",
-		                 rohc_remain_len);
+		                 rohc_length);
 		goto error;
 	}
 
 	/* part 2: 3-bit "110" + 5-bit SN */
-	assert(GET_BIT_5_7(rohc_remain_data) == 0x06);
-	bits->sn = GET_BIT_0_4(rohc_remain_data);
+	byte = rohc_cursor_get8(&remain);
+	assert(GET_BIT_5_7(&byte) == 0x06);
+	bits->sn = GET_BIT_0_4(&byte);
 	bits->sn_nr = 5;
 	bits->is_sn_enc = true;
 	rohc_decomp_debug(context, "%zd SN bits = 0x%x", bits->sn_nr, bits->sn);
-	rohc_remain_data++;
-	rohc_remain_len--;
-	(*rohc_hdr_len)++;
 
 	/* part 3: skip large CID (handled elsewhere) */
-	rohc_remain_data += large_cid_len;
-	rohc_remain_len -= large_cid_len;
-	*rohc_hdr_len += large_cid_len;
+	rohc_cursor_skip(&remain, large_cid_len);
 
 	/* part 4: 1-bit X (extension) flag + 7-bit CRC */
-	bits->ext_flag = GET_REAL(GET_BIT_7(rohc_remain_data));
+	byte = rohc_cursor_get8(&remain);
+	bits->ext_flag = GET_REAL(GET_BIT_7(&byte));
 	rohc_decomp_debug(context, "extension is present = %u", bits->ext_flag);
 	extr_crc->type = ROHC_CRC_TYPE_7;
-	extr_crc->bits = GET_BIT_0_6(rohc_remain_data);
+	extr_crc->bits = GET_BIT_0_6(&byte);
 	extr_crc->bits_nr = 7;
 	rohc_decomp_debug(context, "CRC-%zd found in packet = 0x%02x",
 	                  extr_crc->bits_nr, extr_crc->bits);
-	rohc_remain_data++;
-	rohc_remain_len--;
-	(*rohc_hdr_len)++;
 
 	/* part 5: Extension */
 	if(bits->ext_flag == 0)
@@ -2668,17 +2708,17 @@ static bool parse_uor2(const struct rohc_decomp_ctxt *const context,
 		int ext_size;
 
 		/* check if the ROHC packet is large enough to read extension type */
-		if(rohc_remain_len < 1)
+		if(!rohc_cursor_has(&remain, 1))
 		{
 			rohc_decomp_warn(context, "ROHC packet too small for extension "
-			                 "(len = %zu)", rohc_remain_len);
+			                 "(len = %zu)", remain.len);
 			goto error;
 		}
 
 		/* decode extension */
 		rohc_decomp_debug(context, "first byte of extension = 0x%02x",
-		                  GET_BIT_0_7(rohc_remain_data));
-		ext_type = parse_extension_type(rohc_remain_data);
+		                  rohc_cursor_peek8(&remain));
+		ext_type = parse_extension_type(remain.data);
 		switch(ext_type)
 		{
 			case ROHC_EXT_NONE:
@@ -2701,8 +2741,8 @@ static bool parse_uor2(const struct rohc_decomp_ctxt *const context,
 				}
 
 				/* decode extension 0 */
-				ext_size = parse_extension0(context, rohc_remain_data,
-				                            rohc_remain_len, ROHC_PACKET_UOR_2,
+				ext_size = parse_extension0(context, remain.data,
+				                            remain.len, ROHC_PACKET_UOR_2,
 				                            innermost_ipv4_non_rnd, bits);
 
 				break;
@@ -2720,8 +2760,8 @@ static bool parse_uor2(const struct rohc_decomp_ctxt *const context,
 				}
 
 				/* decode extension 1 */
-				ext_size = parse_extension1(context, rohc_remain_data,
-				                            rohc_remain_len, ROHC_PACKET_UOR_2,
+				ext_size = parse_extension1(context, remain.data,
+				                            remain.len, ROHC_PACKET_UOR_2,
 				                            innermost_ipv4_non_rnd, bits);
 
 				break;
@@ -2747,8 +2787,8 @@ static bool parse_uor2(const struct rohc_decomp_ctxt *const context,
 				}
 
 				/* decode extension 2 */
-				ext_size = parse_extension2(context, rohc_remain_data,
-				                            rohc_remain_len, ROHC_PACKET_UOR_2,
+				ext_size = parse_extension2(context, remain.data,
+				                            remain.len, ROHC_PACKET_UOR_2,
 				                            innermost_ipv4_non_rnd, bits);
 
 				break;
@@ -2757,8 +2797,8 @@ static bool parse_uor2(const struct rohc_decomp_ctxt *const context,
 			case ROHC_EXT_3:
 			{
 				/* decode the extension */
-				ext_size = rfc3095_ctxt->parse_ext3(context, rohc_remain_data,
-				                                    rohc_remain_len, *packet_type,
+				ext_size = rfc3095_ctxt->parse_ext3(context, remain.data,
+				                                    remain.len, *packet_type,
 				                                    bits);
 				break;
 			}
@@ -2781,23 +2821,19 @@ static bool parse_uor2(const struct rohc_decomp_ctxt *const context,
 		}
 
 		/* now, skip the extension in the ROHC header */
-		rohc_remain_data += ext_size;
-		rohc_remain_len -= ext_size;
-		*rohc_hdr_len += ext_size;
+		rohc_cursor_skip(&remain, ext_size);
 	}
 
 	/* parts 6, 9, and 13: UO* remainder */
-	if(!parse_uo_remainder(context, rohc_remain_data, rohc_remain_len, bits,
+	if(!parse_uo_remainder(context, remain.data, remain.len, bits,
 	                       &rohc_remainder_len))
 	{
 		rohc_decomp_warn(context, "failed to parse UO* remainder");
 		goto error;
 	}
-#ifndef __clang_analyzer__ /* silent warning about dead in/decrement */
-	rohc_remain_data += rohc_remainder_len;
-	rohc_remain_len -= rohc_remainder_len;
-#endif
-	*rohc_hdr_len += rohc_remainder_len;
+	rohc_cursor_skip(&remain, rohc_remainder_len);
+
+	*rohc_hdr_len = rohc_cursor_offset(&remain);
 
 	/* sanity checks */
 	assert((*rohc_hdr_len) <= rohc_length);
@@ -4285,34 +4321,35 @@ static bool parse_uo_remainder(const struct rohc_decomp_ctxt *const context,
                                size_t *const rohc_hdr_len)
 {
 	const struct rohc_decomp_rfc3095_ctxt *const rfc3095_ctxt = context->persist_ctxt;
+	const bool is_outer_ip_id_rnd = is_ipv4_rnd_pkt(&bits->outer_ip);
+	const bool is_inner_ip_id_rnd =
+		(bits->multiple_ip && is_ipv4_rnd_pkt(&bits->inner_ip));
 
-	/* remaining ROHC data not parsed yet and the length of the ROHC headers
-	   (will be computed during parsing) */
-	const uint8_t *rohc_remain_data;
-	size_t rohc_remain_len;
+	/* remaining ROHC data not parsed yet */
+	struct rohc_cursor remain;
 
 	assert(rohc_packet != NULL);
 	assert(bits != NULL);
 	assert(rohc_hdr_len != NULL);
 
-	rohc_remain_data = rohc_packet;
-	rohc_remain_len = rohc_length;
-	*rohc_hdr_len = 0;
+	rohc_cursor_init(&remain, rohc_packet, rohc_length);
+
+	/* check once if the ROHC packet is large enough to read the random outer
+	 * and inner IP-IDs */
+	if(!rohc_cursor_has(&remain, (is_outer_ip_id_rnd ? 2 : 0) +
+	                             (is_inner_ip_id_rnd ? 2 : 0)))
+	{
+		rohc_decomp_warn(context, "ROHC packet too small for random outer "
+		                 "and/or inner IP-ID bits (len = %zu)", rohc_length);
+		goto error;
+	}
 
 	/* part 6: extract 16 outer IP-ID bits in case the outer IP-ID is random */
-	if(is_ipv4_rnd_pkt(&bits->outer_ip))
+	if(is_outer_ip_id_rnd)
 	{
 		/* outer IP-ID is random, read its full 16-bit value and ignore any
 		   previous bits we may have read (they should be filled with zeroes) */
 
-		/* check if the ROHC packet is large enough to read the outer IP-ID */
-		if(rohc_remain_len < 2)
-		{
-			rohc_decomp_warn(context, "ROHC packet too small for random outer "
-			                 "IP-ID bits (len = %zu)", rohc_remain_len);
-			goto error;
-		}
-
 		/* sanity check: all bits that are above 16 bits should be zero */
 		if(bits->outer_ip.id_nr > 0 && bits->outer_ip.id != 0)
 		{
@@ -4322,7 +4359,7 @@ static bool parse_uo_remainder(const struct rohc_decomp_ctxt *const context,
 		}
 
 		/* retrieve the full outer IP-ID value */
-		bits->outer_ip.id = rohc_ntoh16(GET_NEXT_16_BITS(rohc_remain_data));
+		bits->outer_ip.id = rohc_cursor_get16(&remain);
 		bits->outer_ip.id_nr = 16;
 		bits->outer_ip.is_id_enc = true;
 
@@ -4330,28 +4367,16 @@ static bool parse_uo_remainder(const struct rohc_decomp_ctxt *const context,
 		                  "with the ones found at the end of the UO* packet "
 		                  "(0x%x on %zd bits)", bits->outer_ip.id,
 		                  bits->outer_ip.id_nr);
-
-		rohc_remain_data += 2;
-		rohc_remain_len -= 2;
-		*rohc_hdr_len += 2;
 	}
 
 	/* parts 7 and 8: not supported */
 
 	/* part 9: extract 16 inner IP-ID bits in case the inner IP-ID is random */
-	if(bits->multiple_ip && is_ipv4_rnd_pkt(&bits->inner_ip))
+	if(is_inner_ip_id_rnd)
 	{
 		/* inner IP-ID is random, read its full 16-bit value and ignore any
 		   previous bits we may have read (they should be filled with zeroes) */
 
-		/* check if the ROHC packet is large enough to read the inner IP-ID */
-		if(rohc_remain_len < 2)
-		{
-			rohc_decomp_warn(context, "ROHC packet too small for random inner "
-			                 "IP-ID bits (len = %zu)", rohc_remain_len);
-			goto error;
-		}
-
 		/* sanity check: all bits that are above 16 bits should be zero */
 		if(bits->inner_ip.id_nr > 0 && bits->inner_ip.id != 0)
 		{
@@ -4361,7 +4386,7 @@ static bool parse_uo_remainder(const struct rohc_decomp_ctxt *const context,
 		}
 
 		/* retrieve the full inner IP-ID value */
-		bits->inner_ip.id = rohc_ntoh16(GET_NEXT_16_BITS(rohc_remain_data));
+		bits->inner_ip.id = rohc_cursor_get16(&remain);
 		bits->inner_ip.id_nr = 16;
 		bits->inner_ip.is_id_enc = true;
 
@@ -4369,10 +4394,6 @@ static bool parse_uo_remainder(const struct rohc_decomp_ctxt *const context,
 		                  "with the ones found at the end of the UO* packet "
 		                  "(0x%x on %zd bits)", bits->inner_ip.id,
 		                  bits->inner_ip.id_nr);
-
-		rohc_remain_data += 2;
-		rohc_remain_len -= 2;
-		*rohc_hdr_len += 2;
 	}
 
 	/* parts 10, 11 and 12: not supported */
@@ -4382,20 +4403,18 @@ static bool parse_uo_remainder(const struct rohc_decomp_ctxt *const context,
 	{
 		int size;
 
-		size = rfc3095_ctxt->parse_uo_remainder(context, rohc_remain_data,
-		                                        rohc_remain_len, bits);
+		size = rfc3095_ctxt->parse_uo_remainder(context, remain.data,
+		                                        remain.len, bits);
 		if(size < 0)
 		{
 			rohc_decomp_warn(context, "cannot decode the remainder of UO* packet");
 			goto error;
 		}
-#ifndef __clang_analyzer__ /* silent warning about dead in/decrement */
-		rohc_remain_data += size;
-		rohc_remain_len -= size;
-#endif
-		*rohc_hdr_len += size;
+		rohc_cursor_skip(&remain, size);
 	}
 
+	*rohc_hdr_len = rohc_cursor_offset(&remain);
+
 	/* sanity checks */
 	assert((*rohc_hdr_len) <= rohc_length);
 
@@ -4998,17 +5017,8 @@ rohc_status_t rfc3095_decomp_build_hdrs(const struct rohc_decomp *const decomp,
 		ip_payload_len += inner_ip_hdr_len;
 
 		/* determine the length of extension headers of the inner IP header */
-		inner_ip_ext_hdrs_len = 0;
-		if(rfc3095_ctxt->list_decomp2.pkt_list.id != ROHC_LIST_GEN_ID_NONE)
-		{
-			size_t i;
-
-			for(i = 0; i < rfc3095_ctxt->list_decomp2.pkt_list.items_nr; i++)
-			{
-				inner_ip_ext_hdrs_len +=
-					rfc3095_ctxt->list_decomp2.pkt_list.items[i]->length;
-			}
-		}
+		inner_ip_ext_hdrs_len =
+			rohc_list_get_uncomp_len(&rfc3095_ctxt->list_decomp2);
 		rohc_decomp_debug(context, "length of extension headers for inner IP "
 		                  "header = %zd bytes", inner_ip_ext_hdrs_len);
 		ip_payload_len += inner_ip_ext_hdrs_len;
@@ -5019,7 +5029,8 @@ rohc_status_t rfc3095_decomp_build_hdrs(const struct rohc_decomp *const decomp,
 		ip_payload_len += payload_len;
 
 		/* build the outer IP header */
-		if(!build_uncomp_ip(context, decoded->outer_ip, uncomp_hdrs_data,
+		if(!build_uncomp_ip(context, decoded->outer_ip,
+		                    rfc3095_ctxt->outer_ip_changes, uncomp_hdrs_data,
 		                    uncomp_hdrs_max_len, &outer_ip_hdr_len,
 		                    ip_payload_len, &rfc3095_ctxt->list_decomp1))
 		{
@@ -5034,7 +5045,8 @@ rohc_status_t rfc3095_decomp_build_hdrs(const struct rohc_decomp *const decomp,
 
 		/* build the inner IP header */
 		ip_payload_len -= inner_ip_hdr_len + inner_ip_ext_hdrs_len;
-		if(!build_uncomp_ip(context, decoded->inner_ip, uncomp_hdrs_data,
+		if(!build_uncomp_ip(context, decoded->inner_ip,
+		                    rfc3095_ctxt->inner_ip_changes, uncomp_hdrs_data,
 		                    uncomp_hdrs_max_len, &inner_ip_hdr_len,
 		                    ip_payload_len, &rfc3095_ctxt->list_decomp2))
 		{
@@ -5059,7 +5071,8 @@ rohc_status_t rfc3095_decomp_build_hdrs(const struct rohc_decomp *const decomp,
 		ip_payload_len += payload_len;
 
 		/* build the single IP header */
-		if(!build_uncomp_ip(context, decoded->outer_ip, uncomp_hdrs_data,
+		if(!build_uncomp_ip(context, decoded->outer_ip,
+		                    rfc3095_ctxt->outer_ip_changes, uncomp_hdrs_data,
 		                    uncomp_hdrs_max_len, &ip_hdr_len, ip_payload_len,
 		                    &rfc3095_ctxt->list_decomp1))
 		{
@@ -5109,7 +5122,8 @@ rohc_status_t rfc3095_decomp_build_hdrs(const struct rohc_decomp *const decomp,
 			                 rohc_get_packet_descr(packet_type),
 			                 rohc_decomp_get_state_descr(context->state),
 			                 rohc_get_mode_descr(context->mode));
-			if((decomp->features & ROHC_DECOMP_FEATURE_DUMP_PACKETS) != 0)
+			if(rohc_trace_is_enabled(decomp, ROHC_TRACE_WARNING) &&
+			   (decomp->features & ROHC_DECOMP_FEATURE_DUMP_PACKETS) != 0)
 			{
 				rohc_dump_buf(decomp->trace_callback, decomp->trace_callback_priv,
 				              ROHC_TRACE_DECOMP, ROHC_TRACE_WARNING,
@@ -5122,6 +5136,9 @@ rohc_status_t rfc3095_decomp_build_hdrs(const struct rohc_decomp *const decomp,
 	return ROHC_STATUS_OK;
 
 error_crc:
+	/* forget the headers, they are built again if the decoding is attempted
+	 * once more with other assumptions */
+	uncomp_hdrs->len -= *uncomp_hdrs_len;
 	return ROHC_STATUS_BAD_CRC;
 error_output_too_small:
 	return ROHC_STATUS_OUTPUT_TOO_SMALL;
@@ -5133,6 +5150,7 @@ error_output_too_small:
  *
  * @param context               The decompression context
  * @param decoded               The decoded IPv4 fields
+ * @param ip_changes            The context of the IP header
  * @param dest                  The buffer to store the IP header
  * @param uncomp_hdrs_max_len   The max length of the IP header
  * @param[out] uncomp_hdrs_len  The length of the IPv4 header
@@ -5143,18 +5161,19 @@ error_output_too_small:
  */
 static bool build_uncomp_ip(const struct rohc_decomp_ctxt *const context,
                             const struct rohc_decoded_ip_values decoded,
+                            const struct rohc_decomp_rfc3095_changes *const ip_changes,
                             uint8_t *const dest,
                             const size_t uncomp_hdrs_max_len,
                             size_t *const uncomp_hdrs_len,
                             const size_t payload_size,
-                            const struct list_decomp *const list_decomp)
+                            struct list_decomp *const list_decomp)
 {
 	bool is_ok;
 
 	if(decoded.version == IPV4)
 	{
-		is_ok = build_uncomp_ipv4(context, decoded, dest, uncomp_hdrs_max_len,
-		                          uncomp_hdrs_len, payload_size);
+		is_ok = build_uncomp_ipv4(context, decoded, ip_changes, dest,
+		                          uncomp_hdrs_max_len, uncomp_hdrs_len, payload_size);
 	}
 	else
 	{
@@ -5169,8 +5188,13 @@ static bool build_uncomp_ip(const struct rohc_decomp_ctxt *const context,
 /**
  * @brief Build an uncompressed IPv4 header.
  *
+ * The static fields are copied from the header template of the context when
+ * they did not change, the checksum of the template is then updated with the
+ * dynamic fields only.
+ *
  * @param context               The decompression context
  * @param decoded               The decoded IPv4 fields
+ * @param ip_changes            The context of the IPv4 header
  * @param dest                  The buffer to store the IPv4 header
  * @param uncomp_hdrs_max_len   The max length of the IPv4 header
  * @param[out] uncomp_hdrs_len  The length of the IPv4 header
@@ -5180,6 +5204,7 @@ static bool build_uncomp_ip(const struct rohc_decomp_ctxt *const context,
  */
 static bool build_uncomp_ipv4(const struct rohc_decomp_ctxt *const context,
                               const struct rohc_decoded_ip_values decoded,
+                              const struct rohc_decomp_rfc3095_changes *const ip_changes,
                               uint8_t *const dest,
                               const size_t uncomp_hdrs_max_len,
                               size_t *const uncomp_hdrs_len,
@@ -5194,14 +5219,22 @@ static bool build_uncomp_ipv4(const struct rohc_decomp_ctxt *const context,
 		goto error;
 	}
 
-	/* static-known fields */
-	ip->ihl = 5;
+	if(decoded.use_tmpl)
+	{
+		/* static-known and static fields from the header template */
+		memcpy(ip, &ip_changes->ipv4_tmpl, sizeof(struct ipv4_hdr));
+	}
+	else
+	{
+		/* static-known fields */
+		ip->ihl = 5;
 
-	/* static fields */
-	ip->version = decoded.version;
-	ip->protocol = decoded.proto;
-	memcpy(&ip->saddr, decoded.saddr, 4);
-	memcpy(&ip->daddr, decoded.daddr, 4);
+		/* static fields */
+		ip->version = decoded.version;
+		ip->protocol = decoded.proto;
+		memcpy(&ip->saddr, decoded.saddr, 4);
+		memcpy(&ip->daddr, decoded.daddr, 4);
+	}
 
 	/* dynamic fields */
 	ip->tos = decoded.tos;
@@ -5219,7 +5252,17 @@ static bool build_uncomp_ipv4(const struct rohc_decomp_ctxt *const context,
 	rohc_decomp_debug(context, "Total Length = 0x%04x (IHL * 4 + %zu)",
 	                  rohc_ntoh16(ip->tot_len), payload_size);
 	ip->check = 0;
-	ip->check = ip_fast_csum(dest, ip->ihl);
+	if(decoded.use_tmpl)
+	{
+		ip->check =
+			rohc_csum_replace(ip_changes->ipv4_tmpl_csum,
+			                  (const uint8_t *) &ip_changes->ipv4_tmpl, dest,
+			                  offsetof(struct ipv4_hdr, check));
+	}
+	else
+	{
+		ip->check = ip_fast_csum(dest, ip->ihl);
+	}
 	rohc_decomp_debug(context, "IP checksum = 0x%04x",
 	                  rohc_ntoh16(ip->check));
 
@@ -5250,7 +5293,7 @@ static bool build_uncomp_ipv6(const struct rohc_decomp_ctxt *const context,
                               const size_t uncomp_hdrs_max_len,
                               size_t *const uncomp_hdrs_len,
                               const size_t payload_size,
-                              const struct list_decomp *const list_decomp)
+                              struct list_decomp *const list_decomp)
 {
 	struct ipv6_hdr *const ip = (struct ipv6_hdr *) dest;
 	size_t ext_size;
@@ -5287,8 +5330,8 @@ static bool build_uncomp_ipv6(const struct rohc_decomp_ctxt *const context,
 	if(list_decomp->pkt_list.id != ROHC_LIST_GEN_ID_NONE)
 	{
 		/* TODO: check dest max size */
-		ext_size = list_decomp->build_uncomp_item(list_decomp, decoded.proto,
-		                                          dest + sizeof(struct ipv6_hdr));
+		ext_size = rohc_list_build_uncomp(list_decomp, decoded.proto,
+		                                  dest + sizeof(struct ipv6_hdr));
 	}
 	else
 	{
@@ -5334,7 +5377,6 @@ static bool check_uncomp_crc(const struct rohc_decomp *const decomp,
                              const uint8_t crc_packet)
 {
 	struct rohc_decomp_rfc3095_ctxt *rfc3095_ctxt;
-	const uint8_t *crc_table;
 	uint8_t crc_computed;
 
 	assert(decomp != NULL);
@@ -5345,20 +5387,17 @@ static bool check_uncomp_crc(const struct rohc_decomp *const decomp,
 	assert(next_header != NULL);
 	assert(crc_type != ROHC_CRC_TYPE_NONE);
 
-	/* determine the initial value and the pre-computed table for the CRC */
+	/* determine the initial value for the CRC */
 	switch(crc_type)
 	{
 		case ROHC_CRC_TYPE_3:
 			crc_computed = CRC_INIT_3;
-			crc_table = decomp->crc_table_3;
 			break;
 		case ROHC_CRC_TYPE_7:
 			crc_computed = CRC_INIT_7;
-			crc_table = decomp->crc_table_7;
 			break;
 		case ROHC_CRC_TYPE_8:
 			crc_computed = CRC_INIT_8;
-			crc_table = decomp->crc_table_8;
 			break;
 		case ROHC_CRC_TYPE_NONE:
 		default:
@@ -5367,13 +5406,18 @@ static bool check_uncomp_crc(const struct rohc_decomp *const decomp,
 			goto error;
 	}
 
-	/* compute the CRC from built uncompressed headers */
+	/* compute the CRC from built uncompressed headers, the part of the
+	 * CRC-STATIC on the IP headers is cached, their IPv6 extension headers
+	 * included as long as the lists are not rendered again */
+	rfc3095_ctxt->crc_static.exts_gens[0] = rfc3095_ctxt->list_decomp1.rendered_gen;
+	rfc3095_ctxt->crc_static.exts_gens[1] = rfc3095_ctxt->list_decomp2.rendered_gen;
 	crc_computed = rfc3095_ctxt->compute_crc_static(outer_ip_hdr, inner_ip_hdr,
 	                                                next_header, crc_type,
-	                                                crc_computed, crc_table);
+	                                                crc_computed,
+	                                                &rfc3095_ctxt->crc_static);
 	crc_computed = rfc3095_ctxt->compute_crc_dynamic(outer_ip_hdr, inner_ip_hdr,
 	                                                 next_header, crc_type,
-	                                                 crc_computed, crc_table);
+	                                                 crc_computed);
 	rohc_decomp_debug(context, "CRC-%d on uncompressed header = 0x%x",
 	                  crc_type, crc_computed);
 
@@ -5411,10 +5455,12 @@ bool rfc3095_decomp_attempt_repair(const struct rohc_decomp *const decomp,
                                    struct rohc_extr_bits *const extr_bits)
 {
 	struct rohc_decomp_rfc3095_ctxt *const rfc3095_ctxt = context->persist_ctxt;
-	const uint32_t sn_ref_0 = rohc_lsb_get_ref(rfc3095_ctxt->sn_lsb_ctxt,
+	const uint32_t sn_ref_0 = rohc_lsb_get_ref(&rfc3095_ctxt->sn_lsb_ctxt,
 	                                           ROHC_LSB_REF_0);
-	const uint32_t sn_ref_minus_1 = rohc_lsb_get_ref(rfc3095_ctxt->sn_lsb_ctxt,
+	const uint32_t sn_ref_minus_1 = rohc_lsb_get_ref(&rfc3095_ctxt->sn_lsb_ctxt,
 	                                                 ROHC_LSB_REF_MINUS_1);
+	uint32_t sn_curr1;
+	uint32_t sn_curr2;
 	bool verdict = false;
 
 	/* do not try to repair packet/context if feature is disabled */
@@ -5436,6 +5482,16 @@ bool rfc3095_decomp_attempt_repair(const struct rohc_decomp *const decomp,
 	/* no correction attempt shall be already running */
 	assert(crc_corr->counter == 0);
 
+	/* the repairs only change the SN decoded from its LSB: if the SN is
+	 * transmitted uncompressed or deduced, any new attempt would build the
+	 * very same headers and fail the CRC again */
+	if(!extr_bits->is_sn_enc)
+	{
+		rohc_decomp_warn(context, "CID %zu: CRC repair: repair is not useful "
+		                 "since SN is not LSB-encoded", context->cid);
+		goto skip;
+	}
+
 	/* try to guess the correct SN value in case of failure */
 	rohc_decomp_warn(context, "CID %zu: CRC repair: attempt to correct SN",
 	                 context->cid);
@@ -5467,7 +5523,14 @@ bool rfc3095_decomp_attempt_repair(const struct rohc_decomp *const decomp,
 		                 "= %u to reference SN (ref 0 = %u)", context->cid,
 		                 extr_bits->sn_nr, extr_bits->sn_ref_offset, sn_ref_0);
 	}
-	else if(sn_ref_0 != sn_ref_minus_1)
+	else if(sn_ref_0 != sn_ref_minus_1 &&
+	        rohc_lsb_decode(&rfc3095_ctxt->sn_lsb_ctxt, ROHC_LSB_REF_0, 0,
+	                        extr_bits->sn, extr_bits->sn_nr,
+	                        rfc3095_ctxt->sn_lsb_p, &sn_curr1) &&
+	        rohc_lsb_decode(&rfc3095_ctxt->sn_lsb_ctxt, ROHC_LSB_REF_MINUS_1, 0,
+	                        extr_bits->sn, extr_bits->sn_nr,
+	                        rfc3095_ctxt->sn_lsb_p, &sn_curr2) &&
+	        sn_curr1 != sn_curr2)
 	{
 		rohc_decomp_warn(context, "CID %zu: CRC repair: CRC failure seems to "
 		                 "be caused by an incorrect SN update", context->cid);
@@ -5489,7 +5552,9 @@ bool rfc3095_decomp_attempt_repair(const struct rohc_decomp *const decomp,
 		/* step e of RFC3095, §5.3.2.2.5. Repair of incorrect SN updates:
 		 *   If the decompressed header generated in b. does not pass the CRC
 		 *   test and SN curr2 is the same as SN curr1, an additional
-		 *   decompression attempt is not useful and is not attempted. */
+		 *   decompression attempt is not useful and is not attempted.
+		 * SN curr1 and SN curr2 are computed from the SN LSB only, so the
+		 * useless attempt is detected before the headers are built again */
 		rohc_decomp_warn(context, "CID %zu: CRC repair: repair is not useful",
 		                 context->cid);
 		goto skip;
@@ -5505,6 +5570,113 @@ skip:
 }
 
 
+/**
+ * @brief Attempt to decode a late packet against a previous SN reference
+ *
+ * Upon CRC failure, the SN LSB of a late packet may be decoded again against
+ * the previous SN references kept by the reorder window, the most recent
+ * first. Only the references that decode the SN LSB to a SN different from
+ * the SN of the previous attempt, newer than the oldest reference and never
+ * received yet are tried.
+ *
+ * A 3-bit CRC matches one wrong SN out of 8: only the packets protected by
+ * a 7-bit or 8-bit CRC are decoded against the previous references.
+ *
+ * @param decomp             The ROHC decompressor
+ * @param context            The decompression context
+ * @param[in,out] extr_bits  The bits extracted from the ROHC header
+ * @return                   true if a new decoding attempt is possible,
+ *                           false if all previous references were tried
+ */
+bool rfc3095_decomp_attempt_late(const struct rohc_decomp *const decomp,
+                                 const struct rohc_decomp_ctxt *const context,
+                                 struct rohc_extr_bits *const extr_bits)
+{
+	const struct rohc_decomp_rfc3095_ctxt *const rfc3095_ctxt =
+		context->persist_ctxt;
+	const uint32_t sn_mask =
+		(uint32_t) ((UINT64_C(1) << context->profile->msn_max_bits) - 1);
+	size_t refs_nr = rfc3095_ctxt->sn_prev_refs_nr;
+	uint32_t sn_ref_0;
+	uint32_t sn_window;
+	uint32_t sn_tried_ref;
+	uint32_t sn_tried;
+	size_t i;
+
+	if(refs_nr > decomp->reorder_window)
+	{
+		refs_nr = decomp->reorder_window;
+	}
+
+	/* only the SN decoded from its LSB depends on the reference */
+	if(!extr_bits->is_sn_enc || extr_bits->sn_prev_ref >= refs_nr)
+	{
+		goto skip;
+	}
+
+	/* a 3-bit CRC is too weak to tell a late packet from a damaged one */
+	if(context->volat_ctxt.crc.type != ROHC_CRC_TYPE_7 &&
+	   context->volat_ctxt.crc.type != ROHC_CRC_TYPE_8)
+	{
+		goto skip;
+	}
+
+	/* the late SN shall be newer than the oldest reference and recorded in
+	 * the received SNs */
+	sn_ref_0 = rohc_lsb_get_ref(&rfc3095_ctxt->sn_lsb_ctxt, ROHC_LSB_REF_0);
+	sn_window = (sn_ref_0 - rfc3095_ctxt->sn_prev_refs[refs_nr - 1]) & sn_mask;
+	if(sn_window > ROHC_DECOMP_SN_RCVD_SPAN)
+	{
+		sn_window = ROHC_DECOMP_SN_RCVD_SPAN;
+	}
+
+	/* the SN decoded by the previous attempt */
+	if(extr_bits->sn_prev_ref == 0)
+	{
+		sn_tried_ref = sn_ref_0;
+	}
+	else
+	{
+		sn_tried_ref = rfc3095_ctxt->sn_prev_refs[extr_bits->sn_prev_ref - 1];
+	}
+	if(!rohc_lsb_decode(&rfc3095_ctxt->sn_lsb_ctxt, ROHC_LSB_REF_0,
+	                    sn_tried_ref - sn_ref_0, extr_bits->sn, extr_bits->sn_nr,
+	                    rfc3095_ctxt->sn_lsb_p, &sn_tried))
+	{
+		goto skip;
+	}
+
+	for(i = extr_bits->sn_prev_ref; i < refs_nr; i++)
+	{
+		const uint32_t sn_prev_ref = rfc3095_ctxt->sn_prev_refs[i];
+		uint32_t sn_late;
+		uint32_t sn_dist;
+
+		if(!rohc_lsb_decode(&rfc3095_ctxt->sn_lsb_ctxt, ROHC_LSB_REF_0,
+		                    sn_prev_ref - sn_ref_0, extr_bits->sn, extr_bits->sn_nr,
+		                    rfc3095_ctxt->sn_lsb_p, &sn_late))
+		{
+			continue;
+		}
+		sn_dist = (sn_ref_0 - sn_late) & sn_mask;
+		if(sn_late != sn_tried && sn_dist != 0 && sn_dist < sn_window &&
+		   (rfc3095_ctxt->sn_rcvd_bitmap & (UINT64_C(1) << sn_dist)) == 0)
+		{
+			rohc_decomp_warn(context, "CID %zu: late packet: try previous SN "
+			                 "reference #%zu (%u) instead of ref 0 (%u)",
+			                 context->cid, i + 1, sn_prev_ref, sn_ref_0);
+			extr_bits->sn_prev_ref = i + 1;
+			return true;
+		}
+	}
+
+skip:
+	/* decode the SN against ref 0 again for the repairs */
+	extr_bits->sn_prev_ref = 0;
+	return false;
+}
+
+
 /**
  * @brief Is SN wraparound possible?
  *
@@ -5610,6 +5782,8 @@ bool rfc3095_decomp_decode_bits(const struct rohc_decomp_ctxt *const context,
 	bool decode_ok;
 
 	decoded->is_context_reused = bits->is_context_reused;
+	decoded->static_chain = bits->static_chain;
+	decoded->static_chain_len = bits->static_chain_len;
 
 	/* decode context mode */
 	if(bits->mode_nr > 0 && bits->mode != 0)
@@ -5643,10 +5817,30 @@ bool rfc3095_decomp_decode_bits(const struct rohc_decomp_ctxt *const context,
 			goto error;
 		}
 	}
+	else if(bits->sn_prev_ref > 0)
+	{
+		/* decode SN from packet bits and one previous SN reference of the
+		 * reorder window (late packet) */
+		const uint32_t sn_ref_0 = rohc_lsb_get_ref(&rfc3095_ctxt->sn_lsb_ctxt,
+		                                           ROHC_LSB_REF_0);
+		const uint32_t sn_prev_ref =
+			rfc3095_ctxt->sn_prev_refs[bits->sn_prev_ref - 1];
+
+		assert(bits->sn_prev_ref <= rfc3095_ctxt->sn_prev_refs_nr);
+		decode_ok = rohc_lsb_decode(&rfc3095_ctxt->sn_lsb_ctxt, ROHC_LSB_REF_0,
+		                            sn_prev_ref - sn_ref_0, bits->sn, bits->sn_nr,
+		                            rfc3095_ctxt->sn_lsb_p, &decoded->sn);
+		if(!decode_ok)
+		{
+			rohc_decomp_warn(context, "failed to decode %zu SN bits 0x%x",
+			                 bits->sn_nr, bits->sn);
+			goto error;
+		}
+	}
 	else
 	{
 		/* decode SN from packet bits and context */
-		decode_ok = rohc_lsb_decode(rfc3095_ctxt->sn_lsb_ctxt, bits->lsb_ref_type,
+		decode_ok = rohc_lsb_decode(&rfc3095_ctxt->sn_lsb_ctxt, bits->lsb_ref_type,
 		                            bits->sn_ref_offset, bits->sn, bits->sn_nr,
 		                            rfc3095_ctxt->sn_lsb_p, &decoded->sn);
 		if(!decode_ok)
@@ -5656,6 +5850,7 @@ bool rfc3095_decomp_decode_bits(const struct rohc_decomp_ctxt *const context,
 			goto error;
 		}
 	}
+	decoded->is_sn_late = (bits->sn_prev_ref > 0);
 	rohc_decomp_debug(context, "decoded SN = %u / 0x%x (nr bits = %zd, "
 	                  "bits = %u / 0x%x)", decoded->sn, decoded->sn,
 	                  bits->sn_nr, bits->sn, bits->sn);
@@ -5665,7 +5860,7 @@ bool rfc3095_decomp_decode_bits(const struct rohc_decomp_ctxt *const context,
 
 	/* decode fields related to the outer IP header */
 	decode_ok = decode_ip_values_from_bits(context, rfc3095_ctxt->outer_ip_changes,
-	                                       rfc3095_ctxt->outer_ip_id_offset_ctxt,
+	                                       &rfc3095_ctxt->outer_ip_id_offset_ctxt,
 	                                       decoded->sn, bits->lsb_ref_type,
 	                                       &bits->outer_ip, "outer", 1,
 	                                       &decoded->outer_ip);
@@ -5681,7 +5876,7 @@ bool rfc3095_decomp_decode_bits(const struct rohc_decomp_ctxt *const context,
 	{
 		decode_ok = decode_ip_values_from_bits(context,
 		                                       rfc3095_ctxt->inner_ip_changes,
-		                                       rfc3095_ctxt->inner_ip_id_offset_ctxt,
+		                                       &rfc3095_ctxt->inner_ip_id_offset_ctxt,
 		                                       decoded->sn, bits->lsb_ref_type,
 		                                       &bits->inner_ip, "inner", 2,
 		                                       &decoded->inner_ip);
@@ -6082,6 +6277,13 @@ static bool decode_ip_values_from_bits(const struct rohc_decomp_ctxt *const cont
 		                  descr, IPV6_ADDR_RAW(decoded->daddr));
 	}
 
+	/* the IPv4 header template of the context may be used if no static field
+	 * was transmitted */
+	decoded->use_tmpl = (ctxt->ipv4_tmpl_valid && decoded->version == IPV4 &&
+	                     !new_inner_ip_hdr && !ip_6to4_switch &&
+	                     bits->proto_nr == 0 && bits->saddr_nr == 0 &&
+	                     bits->daddr_nr == 0);
+
 	return true;
 
 error:
@@ -6113,6 +6315,8 @@ void rfc3095_decomp_update_ctxt(struct rohc_decomp_ctxt *const context,
                                 bool *const do_change_mode)
 {
 	struct rohc_decomp_rfc3095_ctxt *const rfc3095_ctxt = context->persist_ctxt;
+	const uint32_t sn_mask =
+		(uint32_t) ((UINT64_C(1) << context->profile->msn_max_bits) - 1);
 	bool keep_ref_minus_1; /* for action upon CRC failure */
 
 	/* action upon CRC failure: in case of incorrect SN updates, ref-1 shall not
@@ -6228,8 +6432,98 @@ void rfc3095_decomp_update_ctxt(struct rohc_decomp_ctxt *const context,
 		context->is_duplicated = false;
 	}
 
+	/* a late packet decoded against a previous SN reference of the reorder
+	 * window is older than the context: keep the references of the latest
+	 * packets */
+	if(decoded->is_sn_late)
+	{
+		const uint32_t sn_dist =
+			(rohc_lsb_get_ref(&rfc3095_ctxt->sn_lsb_ctxt, ROHC_LSB_REF_0) -
+			 decoded->sn) & sn_mask;
+
+		/* never decode the late packet twice */
+		if(sn_dist < ROHC_DECOMP_SN_RCVD_SPAN)
+		{
+			rfc3095_ctxt->sn_rcvd_bitmap |= (UINT64_C(1) << sn_dist);
+		}
+		rohc_decomp_debug(context, "late packet: do not update the context");
+		return;
+	}
+
+	/* keep the new static chain to skip it in the next IR packets */
+	if(decoded->static_chain != NULL)
+	{
+		rohc_decomp_static_chain_store(context, &rfc3095_ctxt->static_chain,
+		                               decoded->static_chain,
+		                               decoded->static_chain_len);
+	}
+
+	/* record the SN among the received SNs, relatively to the new ref 0 */
+	if(decoded->is_context_reused ||
+	   !rohc_lsb_is_ready(&rfc3095_ctxt->sn_lsb_ctxt))
+	{
+		rfc3095_ctxt->sn_rcvd_bitmap = 1;
+	}
+	else
+	{
+		const uint32_t sn_ref_0 = rohc_lsb_get_ref(&rfc3095_ctxt->sn_lsb_ctxt,
+		                                           ROHC_LSB_REF_0);
+		const uint32_t sn_delta = (decoded->sn - sn_ref_0) & sn_mask;
+		const uint32_t sn_dist = (sn_ref_0 - decoded->sn) & sn_mask;
+
+		if(sn_delta <= (sn_mask >> 1))
+		{
+			/* newer SN or duplicate */
+			if(sn_delta >= ROHC_DECOMP_SN_RCVD_SPAN)
+			{
+				rfc3095_ctxt->sn_rcvd_bitmap = 1;
+			}
+			else
+			{
+				rfc3095_ctxt->sn_rcvd_bitmap =
+					(rfc3095_ctxt->sn_rcvd_bitmap << sn_delta) | 1;
+			}
+		}
+		else if(sn_dist >= ROHC_DECOMP_SN_RCVD_SPAN)
+		{
+			rfc3095_ctxt->sn_rcvd_bitmap = 1;
+		}
+		else
+		{
+			/* older SN */
+			rfc3095_ctxt->sn_rcvd_bitmap =
+				(rfc3095_ctxt->sn_rcvd_bitmap >> sn_dist) | 1;
+		}
+	}
+
+	/* keep the SN reference being replaced to decode the late packets */
+	if(decoded->is_context_reused)
+	{
+		rfc3095_ctxt->sn_prev_refs_nr = 0;
+	}
+	else if(context->decompressor->reorder_window > 0 &&
+	        rohc_lsb_is_ready(&rfc3095_ctxt->sn_lsb_ctxt))
+	{
+		const uint32_t sn_ref_0 = rohc_lsb_get_ref(&rfc3095_ctxt->sn_lsb_ctxt,
+		                                           ROHC_LSB_REF_0);
+
+		if(decoded->sn != sn_ref_0)
+		{
+			size_t refs_nr = rfc3095_ctxt->sn_prev_refs_nr + 1;
+
+			if(refs_nr > context->decompressor->reorder_window)
+			{
+				refs_nr = context->decompressor->reorder_window;
+			}
+			memmove(rfc3095_ctxt->sn_prev_refs + 1, rfc3095_ctxt->sn_prev_refs,
+			        (refs_nr - 1) * sizeof(uint32_t));
+			rfc3095_ctxt->sn_prev_refs[0] = sn_ref_0;
+			rfc3095_ctxt->sn_prev_refs_nr = refs_nr;
+		}
+	}
+
 	/* update SN */
-	rohc_lsb_set_ref(rfc3095_ctxt->sn_lsb_ctxt, decoded->sn, keep_ref_minus_1);
+	rohc_lsb_set_ref(&rfc3095_ctxt->sn_lsb_ctxt, decoded->sn, keep_ref_minus_1);
 
 	/* maybe current packet changed the number of IP headers */
 	rfc3095_ctxt->multiple_ip = decoded->multiple_ip;
@@ -6244,7 +6538,7 @@ void rfc3095_decomp_update_ctxt(struct rohc_decomp_ctxt *const context,
 	if(decoded->outer_ip.version == IPV4)
 	{
 		ipv4_set_id(&rfc3095_ctxt->outer_ip_changes->ip, decoded->outer_ip.id);
-		ip_id_offset_set_ref(rfc3095_ctxt->outer_ip_id_offset_ctxt,
+		ip_id_offset_set_ref(&rfc3095_ctxt->outer_ip_id_offset_ctxt,
 		                     decoded->outer_ip.id, decoded->sn, keep_ref_minus_1);
 		ipv4_set_df(&rfc3095_ctxt->outer_ip_changes->ip, decoded->outer_ip.df);
 		rfc3095_ctxt->outer_ip_changes->nbo = decoded->outer_ip.nbo;
@@ -6255,6 +6549,8 @@ void rfc3095_decomp_update_ctxt(struct rohc_decomp_ctxt *const context,
 	{
 		ip_set_flow_label(&rfc3095_ctxt->outer_ip_changes->ip, decoded->outer_ip.flowid);
 	}
+	rfc3095_decomp_update_ipv4_tmpl(rfc3095_ctxt->outer_ip_changes,
+	                                &decoded->outer_ip);
 
 	/* update fields related to the inner IP header (if any) */
 	if(rfc3095_ctxt->multiple_ip)
@@ -6268,7 +6564,7 @@ void rfc3095_decomp_update_ctxt(struct rohc_decomp_ctxt *const context,
 		if(decoded->inner_ip.version == IPV4)
 		{
 			ipv4_set_id(&rfc3095_ctxt->inner_ip_changes->ip, decoded->inner_ip.id);
-			ip_id_offset_set_ref(rfc3095_ctxt->inner_ip_id_offset_ctxt,
+			ip_id_offset_set_ref(&rfc3095_ctxt->inner_ip_id_offset_ctxt,
 			                     decoded->inner_ip.id, decoded->sn, keep_ref_minus_1);
 			ipv4_set_df(&rfc3095_ctxt->inner_ip_changes->ip, decoded->inner_ip.df);
 			rfc3095_ctxt->inner_ip_changes->nbo = decoded->inner_ip.nbo;
@@ -6280,6 +6576,8 @@ void rfc3095_decomp_update_ctxt(struct rohc_decomp_ctxt *const context,
 			ip_set_flow_label(&rfc3095_ctxt->inner_ip_changes->ip, decoded->inner_ip.flowid);
 		}
 		rfc3095_ctxt->inner_ip_changes->ip.nl.proto = decoded->inner_ip.proto;
+		rfc3095_decomp_update_ipv4_tmpl(rfc3095_ctxt->inner_ip_changes,
+		                                &decoded->inner_ip);
 	}
 
 	/* update context with decoded fields for next header if required */
@@ -6290,6 +6588,42 @@ void rfc3095_decomp_update_ctxt(struct rohc_decomp_ctxt *const context,
 }
 
 
+/**
+ * @brief Render the IPv4 header template of one IP header if needed
+ *
+ * The template is rendered again only when one static field of the IPv4
+ * header changed, it is dropped for IPv6 headers.
+ *
+ * @param ip_changes  The context of the IP header
+ * @param decoded     The decoded values of the IP header
+ */
+static void rfc3095_decomp_update_ipv4_tmpl(struct rohc_decomp_rfc3095_changes *const ip_changes,
+                                            const struct rohc_decoded_ip_values *const decoded)
+{
+	struct ipv4_hdr *const tmpl = &ip_changes->ipv4_tmpl;
+
+	if(decoded->version != IPV4)
+	{
+		ip_changes->ipv4_tmpl_valid = false;
+		return;
+	}
+	if(decoded->use_tmpl)
+	{
+		return;
+	}
+
+	memset(tmpl, 0, sizeof(struct ipv4_hdr));
+	tmpl->version = IPV4;
+	tmpl->ihl = 5;
+	tmpl->protocol = decoded->proto;
+	memcpy(&tmpl->saddr, decoded->saddr, 4);
+	memcpy(&tmpl->daddr, decoded->daddr, 4);
+
+	ip_changes->ipv4_tmpl_csum = ip_fast_csum((uint8_t *) tmpl, tmpl->ihl);
+	ip_changes->ipv4_tmpl_valid = true;
+}
+
+
 /**
  * @brief Reset the extracted bits for next parsing
  *
@@ -6319,6 +6653,7 @@ static void reset_extr_bits(const struct rohc_decomp_rfc3095_ctxt *const rfc3095
 	/* by default, do not apply any offset on reference SN (it will be applied
 	 * only for correction upon CRC failure) */
 	bits->sn_ref_offset = 0;
+	bits->sn_prev_ref = 0;
 
 	/* by default context is not re-used */
 	bits->is_context_reused = false;
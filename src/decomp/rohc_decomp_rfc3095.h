@@ -114,6 +114,12 @@ struct rohc_extr_bits
 {
 	bool is_context_reused; /**< Whether the context is re-used or not */
 
+	/** The static chain of the IR packet, NULL if the packet got no static
+	 *  chain or if it is the static chain kept by the context */
+	const uint8_t *static_chain;
+	/** The length of the static chain of the IR packet */
+	size_t static_chain_len;
+
 	/* SN */
 	uint32_t sn;         /**< The SN bits found in ROHC header */
 	size_t sn_nr;        /**< The number of SN bits found in ROHC header */
@@ -122,6 +128,8 @@ struct rohc_extr_bits
 	                                  (used for context repair after CRC failure) */
 	bool sn_ref_offset;         /**< Optional offset to add to the reference SN
 	                                 (used for context repair after CRC failure) */
+	size_t sn_prev_ref;  /**< The previous SN reference of the reorder window
+	                          to decode the SN against, 0 for ref 0 */
 
 	/** Whether there are multiple IP headers or only one single IP header */
 	bool multiple_ip;
@@ -244,6 +252,8 @@ struct rohc_decoded_ip_values
 	uint32_t flowid:20;  /**< The decoded flow ID field (IPv6 only) */
 	uint8_t saddr[16];   /**< The decoded source address field */
 	uint8_t daddr[16];   /**< The decoded destination address field */
+	bool use_tmpl;       /**< Whether the static fields are the ones of the
+	                          IPv4 header template (IPv4 only) */
 };
 
 
@@ -257,7 +267,15 @@ struct rohc_decoded_values
 {
 	bool is_context_reused; /**< Whether the context is re-used or not */
 
+	/** The static chain of the IR packet to keep in the context, NULL if
+	 *  none, see \ref rohc_decomp_static_chain */
+	const uint8_t *static_chain;
+	/** The length of the static chain of the IR packet */
+	size_t static_chain_len;
+
 	uint32_t sn;  /**< The decoded SN value */
+	bool is_sn_late; /**< Whether the SN was decoded against a previous
+	                      SN reference of the reorder window */
 
 	rohc_mode_t mode;  /**< The operation mode asked by compressor */
 
@@ -324,6 +342,14 @@ struct rohc_decomp_rfc3095_changes
 	void *next_header;
 	/// The length of the next header
 	unsigned int next_header_len;
+
+	/** Whether \e ipv4_tmpl holds the static fields of the IPv4 header */
+	bool ipv4_tmpl_valid;
+	/** The IPv4 header pre-rendered with its static fields, the dynamic
+	 *  fields are written in a copy for every packet */
+	struct ipv4_hdr ipv4_tmpl;
+	/** The checksum of \e ipv4_tmpl */
+	uint16_t ipv4_tmpl_csum;
 };
 
 
@@ -344,11 +370,19 @@ struct rohc_decomp_rfc3095_ctxt
 	/** The LSB shift parameter for the Sequence Number (SN) */
 	rohc_lsb_shift_t sn_lsb_p;
 	/// The LSB decoding context for the Sequence Number (SN)
-	struct rohc_lsb_decode *sn_lsb_ctxt;
+	struct rohc_lsb_decode sn_lsb_ctxt;
+	/** The previous references of the SN to decode the late packets, the
+	 *  most recent first, see \ref rohc_decomp_set_reorder_window */
+	uint32_t sn_prev_refs[ROHC_DECOMP_REORDER_WINDOW_MAX];
+	/** The number of previous references of the SN */
+	size_t sn_prev_refs_nr;
+	/** The SNs received before SN ref 0: bit i is set if SN ref 0 - i was
+	 *  received, so that a late packet is never decoded twice */
+	uint64_t sn_rcvd_bitmap;
 	/// The IP-ID of the outer IP header
-	struct ip_id_offset_decode *outer_ip_id_offset_ctxt;
+	struct ip_id_offset_decode outer_ip_id_offset_ctxt;
 	/// The IP-ID of the inner IP header
-	struct ip_id_offset_decode *inner_ip_id_offset_ctxt;
+	struct ip_id_offset_decode inner_ip_id_offset_ctxt;
 
 	/// The list decompressor of the outer IP header
 	struct list_decomp list_decomp1;
@@ -358,6 +392,12 @@ struct rohc_decomp_rfc3095_ctxt
 	/// Whether the decompressed packet contains a 2nd IP header
 	int multiple_ip;
 
+	/** The CRC-STATIC cached for the IP headers */
+	struct rohc_crc_static_cache crc_static;
+
+	/** The static chain of the last IR packet */
+	struct rohc_decomp_static_chain static_chain;
+
 	/* below are some information and handlers to manage the next header
 	 * (if any) located just after the IP headers (1 or 2 IP headers) */
 
@@ -425,15 +465,14 @@ struct rohc_decomp_rfc3095_ctxt
 	                              const uint8_t *const next_header,
 	                              const rohc_crc_type_t crc_type,
 	                              const uint8_t init_val,
-	                              const uint8_t *const crc_table);
+	                              struct rohc_crc_static_cache *const cache);
 
 	/// @brief The handler used to compute the CRC-DYNAMIC value
 	uint8_t (*compute_crc_dynamic)(const uint8_t *const ip,
 	                               const uint8_t *const ip2,
 	                               const uint8_t *const next_header,
 	                               const rohc_crc_type_t crc_type,
-	                               const uint8_t init_val,
-	                               const uint8_t *const crc_table);
+	                               const uint8_t init_val);
 
 	/** The handler used to update context with decoded next header fields */
 	void (*update_context)(struct rohc_decomp_ctxt *const context,
@@ -445,6 +484,24 @@ struct rohc_decomp_rfc3095_ctxt
 };
 
 
+/**
+ * @brief The length of the memory block of one RFC3095-based context
+ *
+ * The block holds the persistent part, the header changes of the outer and
+ * inner IP headers with their next headers, and the profile-specific part of
+ * the context. The volatile part lives in the scratch memory of the
+ * decompressor.
+ *
+ * @param specific_size    The size of the profile-specific part
+ * @param next_header_len  The length of the next header, 0 if none
+ */
+#define ROHC_DECOMP_RFC3095_BLOCK_LEN(specific_size, next_header_len) \
+	(ROHC_CTXT_ARENA_SIZE(sizeof(struct rohc_decomp_rfc3095_ctxt)) + \
+	 ROHC_CTXT_ARENA_SIZE(sizeof(struct rohc_decomp_rfc3095_changes)) * 2 + \
+	 ROHC_CTXT_ARENA_SIZE(next_header_len) * 2 + \
+	 ROHC_CTXT_ARENA_SIZE(specific_size))
+
+
 /*
  * Public function prototypes.
  */
@@ -452,14 +509,19 @@ struct rohc_decomp_rfc3095_ctxt
 bool rohc_decomp_rfc3095_create(const struct rohc_decomp_ctxt *const context,
                                 struct rohc_decomp_rfc3095_ctxt **const persist_ctxt,
                                 struct rohc_decomp_volat_ctxt *const volat_ctxt,
+                                const size_t specific_size,
+                                const size_t next_header_len,
                                 rohc_trace_callback2_t trace_cb,
                                 void *const trace_cb_priv,
+                                const rohc_trace_level_t trace_level,
+                                const rohc_trace_level_t *const trace_pkt_level,
                                 const int profile_id)
 	__attribute__((warn_unused_result, nonnull(1, 2, 3)));
 
-void rohc_decomp_rfc3095_destroy(struct rohc_decomp_rfc3095_ctxt *const rfc3095_ctxt,
+void rohc_decomp_rfc3095_destroy(const struct rohc_decomp_ctxt *const context,
+                                 struct rohc_decomp_rfc3095_ctxt *const rfc3095_ctxt,
                                  const struct rohc_decomp_volat_ctxt *const volat_ctxt)
-	__attribute__((nonnull(1, 2)));
+	__attribute__((nonnull(1, 2, 3)));
 
 bool rfc3095_decomp_parse_pkt(const struct rohc_decomp_ctxt *const context,
                               const struct rohc_buf rohc_packet,
@@ -499,6 +561,11 @@ bool rfc3095_decomp_attempt_repair(const struct rohc_decomp *const decomp,
                                    struct rohc_extr_bits *const extr_bits)
 	__attribute__((warn_unused_result, nonnull(1, 2, 4, 5)));
 
+bool rfc3095_decomp_attempt_late(const struct rohc_decomp *const decomp,
+                                 const struct rohc_decomp_ctxt *const context,
+                                 struct rohc_extr_bits *const extr_bits)
+	__attribute__((warn_unused_result, nonnull(1, 2, 3)));
+
 uint32_t rohc_decomp_rfc3095_get_sn(const struct rohc_decomp_ctxt *const context)
 	__attribute__((warn_unused_result, nonnull(1)));
 
@@ -0,0 +1,1484 @@
+/*
+ * Copyright 2016 Didier Barvaux
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/**
+ * @file   rohc_decomp_rfc5225.c
+ * @brief  Generic framework for RFC5225-based decompression profiles such as
+ *         the ROHCv2 IP-only, UDP, ESP and RTP profiles
+ * @author Didier Barvaux <didier@barvaux.org>
+ *
+ * The framework decompresses up to \ref ROHC_RFC5225_MAX_IP_HDRS IPv4 or
+ * IPv6 headers without IP options nor IPv6 extension headers. The header
+ * that follows the IP headers is decompressed by the profile-specific part
+ * of the context, if any (RFC5225 §6.8.2.4).
+ */
+
+#include "rohc_decomp_rfc5225.h"
+#include "rohc_decomp.h"
+#include "rohc_bit_ops.h"
+#include "rohc_traces_internal.h"
+#include "rohc_utils.h"
+#include "rohc_debug.h"
+#include "protocols/ip_numbers.h"
+#include "protocols/ipv4.h"
+#include "protocols/ipv6.h"
+#include "ip.h"
+#include "crc.h"
+
+#ifndef __KERNEL__
+#  include <string.h>
+#endif
+
+
+/*
+ * Private function prototypes.
+ */
+
+/* parsing */
+static bool rfc5225_parse_ir(const struct rohc_decomp_ctxt *const context,
+                             const uint8_t *const rohc_packet,
+                             const size_t rohc_length,
+                             const size_t large_cid_len,
+                             struct rohc_decomp_crc *const extr_crc,
+                             struct rohc_rfc5225_extr_bits *const bits,
+                             size_t *const rohc_hdr_len)
+	__attribute__((warn_unused_result, nonnull(1, 2, 5, 6, 7)));
+static int rfc5225_parse_static_ip(const struct rohc_decomp_ctxt *const context,
+                                   const uint8_t *const rohc_data,
+                                   const size_t rohc_len,
+                                   struct rohc_rfc5225_ip_extr_bits *const ip_bits,
+                                   bool *const is_innermost)
+	__attribute__((warn_unused_result, nonnull(1, 2, 4, 5)));
+static int rfc5225_parse_dyn_ip(const struct rohc_decomp_ctxt *const context,
+                                const uint8_t *const rohc_data,
+                                const size_t rohc_len,
+                                const bool is_innermost,
+                                struct rohc_rfc5225_extr_bits *const bits,
+                                struct rohc_rfc5225_ip_extr_bits *const ip_bits)
+	__attribute__((warn_unused_result, nonnull(1, 2, 5, 6)));
+static bool rfc5225_parse_co(const struct rohc_decomp_ctxt *const context,
+                             const uint8_t *const rohc_packet,
+                             const size_t rohc_length,
+                             const size_t large_cid_len,
+                             const rohc_packet_t packet_type,
+                             struct rohc_decomp_crc *const extr_crc,
+                             struct rohc_rfc5225_extr_bits *const bits,
+                             size_t *const rohc_hdr_len)
+	__attribute__((warn_unused_result, nonnull(1, 2, 6, 7, 8)));
+static int rfc5225_parse_co_base(const struct rohc_decomp_ctxt *const context,
+                                 const uint8_t *const hdr,
+                                 const size_t hdr_len,
+                                 const rohc_packet_t packet_type,
+                                 struct rohc_decomp_crc *const extr_crc,
+                                 struct rohc_rfc5225_extr_bits *const bits,
+                                 bool *const outer_ip_indicator)
+	__attribute__((warn_unused_result, nonnull(1, 2, 5, 6, 7)));
+
+/* building */
+static uint8_t rfc5225_ctrl_crc3(const struct rohc_rfc5225_decoded *const decoded)
+	__attribute__((warn_unused_result, nonnull(1), pure));
+
+
+/*
+ * Definitions of functions
+ */
+
+/**
+ * @brief Create the generic part of one ROHCv2 decompression context
+ *
+ * The generic part of the context and the profile-specific part are carved
+ * from one single memory block, see \ref ROHC_DECOMP_RFC5225_BLOCK_LEN. The
+ * profile-specific part is available in the \e specific field of the
+ * generic part. The handlers of the next header are left empty.
+ *
+ * @param context            The decompression context
+ * @param[out] persist_ctxt  The persistent part of the decompression context
+ * @param[out] volat_ctxt    The volatile part of the decompression context
+ * @param specific_size      The size of the profile-specific part of the
+ *                           context, 0 if the profile has no specific part
+ * @return                   true if the ROHCv2 context was successfully
+ *                           created, false if a problem occurred
+ */
+bool rohc_decomp_rfc5225_create(const struct rohc_decomp_ctxt *const context,
+                                struct rohc_decomp_rfc5225_ctxt **const persist_ctxt,
+                                struct rohc_decomp_volat_ctxt *const volat_ctxt,
+                                const size_t specific_size)
+{
+	struct rohc_decomp_rfc5225_ctxt *rfc5225_ctxt;
+	struct rohc_ctxt_arena arena;
+
+	/* get one memory block for the persistent parts of the context, the
+	 * generic part comes first in the block, so that the block is given back
+	 * to the pool with it */
+	if(rohc_decomp_ctxt_block_get(context,
+	                              ROHC_DECOMP_RFC5225_BLOCK_LEN(specific_size),
+	                              &arena) == NULL)
+	{
+		rohc_error(context->decompressor, ROHC_TRACE_DECOMP, context->profile->id,
+		           "not enough memory for the ROHCv2 decompression context");
+		goto quit;
+	}
+	rfc5225_ctxt =
+		rohc_ctxt_arena_alloc(&arena, sizeof(struct rohc_decomp_rfc5225_ctxt));
+	*persist_ctxt = rfc5225_ctxt;
+
+	/* the profile-specific part */
+	if(specific_size > 0)
+	{
+		rfc5225_ctxt->specific = rohc_ctxt_arena_alloc(&arena, specific_size);
+		assert(rfc5225_ctxt->specific != NULL);
+	}
+	else
+	{
+		rfc5225_ctxt->specific = NULL;
+	}
+
+	/* the IP headers will be initialized with the IR packets */
+	rfc5225_ctxt->ip_nr = 0;
+	rfc5225_ctxt->reorder_ratio = 0; /* no reordering */
+
+	/* init the LSB decoding context for the MSN */
+	rohc_lsb_ref16_init(&rfc5225_ctxt->msn_lsb_ctxt);
+
+	/* init the LSB decoding context for the innermost IP-ID offset */
+	rohc_lsb_ref16_init(&rfc5225_ctxt->ip_id_offset_lsb_ctxt);
+
+	/* no next header and the packets of the IP-only profile by default */
+	rfc5225_ctxt->next_header_len = 0;
+	rfc5225_ctxt->parse_static_next_hdr = NULL;
+	rfc5225_ctxt->parse_dyn_next_hdr = NULL;
+	rfc5225_ctxt->parse_co_base = rfc5225_parse_co_base;
+	rfc5225_ctxt->parse_irreg_next_hdr = NULL;
+	rfc5225_ctxt->decode_next_hdr = NULL;
+	rfc5225_ctxt->build_next_hdr = NULL;
+	rfc5225_ctxt->update_next_hdr = NULL;
+
+	/* volatile part of the decompression context, the extracted bits and
+	 * the decoded values are in the scratch memory of the decompressor */
+	volat_ctxt->crc.type = ROHC_CRC_TYPE_NONE;
+	volat_ctxt->crc.bits_nr = 0;
+
+	return true;
+
+quit:
+	return false;
+}
+
+
+/**
+ * @brief Destroy the ROHCv2 decompression context
+ *
+ * The profile-specific part of the context is given back to the pool along
+ * with the generic part.
+ *
+ * @param context       The decompression context
+ * @param rfc5225_ctxt  The persistent decompression context of the profile
+ * @param volat_ctxt    The volatile decompression context
+ */
+void rohc_decomp_rfc5225_destroy(const struct rohc_decomp_ctxt *const context,
+                                 struct rohc_decomp_rfc5225_ctxt *const rfc5225_ctxt,
+                                 const struct rohc_decomp_volat_ctxt *const volat_ctxt __attribute__((unused)))
+{
+	/* give the memory block of the context back to the pool */
+	rohc_decomp_ctxt_block_put(context, rfc5225_ctxt);
+}
+
+
+/**
+ * @brief Detect the type of ROHC packet for the ROHCv2 profiles that share
+ *        the packet formats of the IP-only profile
+ *
+ * @param context        The decompression context
+ * @param rohc_packet    The ROHC packet
+ * @param rohc_length    The length of the ROHC packet
+ * @param large_cid_len  The length of the optional large CID field
+ * @return               The packet type
+ */
+rohc_packet_t rohc_decomp_rfc5225_detect_pkt_type(const struct rohc_decomp_ctxt *const context,
+                                                  const uint8_t *const rohc_packet,
+                                                  const size_t rohc_length,
+                                                  const size_t large_cid_len __attribute__((unused)))
+{
+	rohc_packet_t type;
+
+	if(rohc_length < 1)
+	{
+		rohc_decomp_warn(context, "ROHC packet too small to read the packet "
+		                 "type (len = %zu)", rohc_length);
+		goto error;
+	}
+
+	rohc_decomp_debug(context, "try to determine the header from first byte "
+	                  "0x%02x", rohc_packet[0]);
+
+	if(rohc_packet[0] == ROHC_RFC5225_IR_DISC)
+	{
+		type = ROHC_PACKET_IR;
+	}
+	else if(context->num_recv_packets == 0)
+	{
+		rohc_decomp_warn(context, "non IR packet received without initialized "
+		                 "context: cannot determine the packet type");
+		goto error;
+	}
+	else if(rohc_packet[0] == ROHC_RFC5225_CO_COMMON_DISC)
+	{
+		type = ROHC_PACKET_CO_COMMON;
+	}
+	else if((rohc_packet[0] & ROHC_RFC5225_PT_0_CRC3_MASK) ==
+	        ROHC_RFC5225_PT_0_CRC3_DISC)
+	{
+		type = ROHC_PACKET_PT_0_CRC3;
+	}
+	else if((rohc_packet[0] & ROHC_RFC5225_PT_0_CRC7_MASK) ==
+	        ROHC_RFC5225_PT_0_CRC7_DISC)
+	{
+		type = ROHC_PACKET_PT_0_CRC7;
+	}
+	else if((rohc_packet[0] & ROHC_RFC5225_PT_1_SEQ_ID_MASK) ==
+	        ROHC_RFC5225_PT_1_SEQ_ID_DISC)
+	{
+		type = ROHC_PACKET_PT_1_SEQ_ID;
+	}
+	else if((rohc_packet[0] & ROHC_RFC5225_PT_2_SEQ_ID_MASK) ==
+	        ROHC_RFC5225_PT_2_SEQ_ID_DISC)
+	{
+		type = ROHC_PACKET_PT_2_SEQ_ID;
+	}
+	else
+	{
+		rohc_decomp_warn(context, "unknown packet type with first byte 0x%02x",
+		                 rohc_packet[0]);
+		goto error;
+	}
+
+	return type;
+
+error:
+	return ROHC_PACKET_UNKNOWN;
+}
+
+
+/**
+ * @brief Parse the given ROHC packet for one of the ROHCv2 profiles
+ *
+ * @param context              The decompression context
+ * @param rohc_packet          The ROHC packet to parse
+ * @param large_cid_len        The length of the optional large CID field
+ * @param[in,out] packet_type  IN:  The type of the ROHC packet to parse
+ *                             OUT: The type of the parsed ROHC packet
+ * @param[out] extr_crc        The CRC bits extracted from the ROHC packet
+ * @param[out] bits            The bits extracted from the ROHC packet
+ * @param[out] rohc_hdr_len    The length of the ROHC header (in bytes)
+ * @return                     true if parsing was successful,
+ *                             false if packet was malformed
+ */
+bool rohc_decomp_rfc5225_parse_pkt(const struct rohc_decomp_ctxt *const context,
+                                   const struct rohc_buf rohc_packet,
+                                   const size_t large_cid_len,
+                                   rohc_packet_t *const packet_type,
+                                   struct rohc_decomp_crc *const extr_crc,
+                                   struct rohc_rfc5225_extr_bits *const bits,
+                                   size_t *const rohc_hdr_len)
+{
+	const struct rohc_decomp_rfc5225_ctxt *const rfc5225_ctxt =
+		context->persist_ctxt;
+	size_t ip_hdr_nr;
+
+	/* reset all extracted bits */
+	memset(bits, 0, sizeof(struct rohc_rfc5225_extr_bits));
+	for(ip_hdr_nr = 0; ip_hdr_nr < rfc5225_ctxt->ip_nr; ip_hdr_nr++)
+	{
+		bits->ip[ip_hdr_nr].vals = rfc5225_ctxt->ip[ip_hdr_nr];
+	}
+	bits->ip_nr = rfc5225_ctxt->ip_nr;
+
+	if((*packet_type) == ROHC_PACKET_IR)
+	{
+		return rfc5225_parse_ir(context, rohc_buf_data(rohc_packet),
+		                                  rohc_packet.len, large_cid_len,
+		                                  extr_crc, bits, rohc_hdr_len);
+	}
+
+	return rfc5225_parse_co(context, rohc_buf_data(rohc_packet),
+	                                  rohc_packet.len, large_cid_len,
+	                                  *packet_type, extr_crc, bits, rohc_hdr_len);
+}
+
+
+/**
+ * @brief Parse the given IR packet for one of the ROHCv2 profiles
+ *
+ * @param context            The decompression context
+ * @param rohc_packet        The ROHC packet to decode
+ * @param rohc_length        The length of the ROHC packet to decode
+ * @param large_cid_len      The length of the large CID field
+ * @param[out] extr_crc      The CRC bits extracted from the ROHC packet
+ * @param[out] bits          The bits extracted from the IR packet
+ * @param[out] rohc_hdr_len  The length of the ROHC header (in bytes)
+ * @return                   true if parsing was successful,
+ *                           false if packet was malformed
+ */
+static bool rfc5225_parse_ir(const struct rohc_decomp_ctxt *const context,
+                             const uint8_t *const rohc_packet,
+                             const size_t rohc_length,
+                             const size_t large_cid_len,
+                             struct rohc_decomp_crc *const extr_crc,
+                             struct rohc_rfc5225_extr_bits *const bits,
+                             size_t *const rohc_hdr_len)
+{
+	const struct rohc_decomp_rfc5225_ctxt *const rfc5225_ctxt =
+		context->persist_ctxt;
+	const uint8_t *remain_data = rohc_packet;
+	size_t remain_len = rohc_length;
+	bool is_innermost = false;
+	size_t ip_hdr_nr;
+	int ret;
+
+	/* skip the first byte of the ROHC packet, the large CID and the Profile
+	 * byte */
+	if(remain_len < (1 + large_cid_len + 1))
+	{
+		rohc_decomp_warn(context, "malformed ROHC packet: too short for first "
+		                 "byte, large CID bytes, and profile byte");
+		goto error;
+	}
+	remain_data += 1 + large_cid_len + 1;
+	remain_len -= 1 + large_cid_len + 1;
+
+	/* parse CRC */
+	if(remain_len < 1)
+	{
+		rohc_decomp_warn(context, "malformed ROHC packet: too short for the "
+		                 "CRC byte");
+		goto error;
+	}
+	extr_crc->type = ROHC_CRC_TYPE_NONE;
+	extr_crc->bits = remain_data[0];
+	extr_crc->bits_nr = 8;
+	remain_data++;
+	remain_len--;
+
+	/* parse static chain, the innermost IP header ends it */
+	bits->is_ir = true;
+	bits->ip_nr = 0;
+	while(!is_innermost)
+	{
+		if(bits->ip_nr >= ROHC_RFC5225_MAX_IP_HDRS)
+		{
+			rohc_decomp_warn(context, "too many IP headers in the static chain: "
+			                 "only %u headers are supported",
+			                 ROHC_RFC5225_MAX_IP_HDRS);
+			goto error;
+		}
+		ret = rfc5225_parse_static_ip(context, remain_data, remain_len,
+		                                        &(bits->ip[bits->ip_nr]),
+		                                        &is_innermost);
+		if(ret < 0)
+		{
+			rohc_decomp_warn(context, "malformed ROHC packet: malformed static "
+			                 "part of IP header #%zu", bits->ip_nr + 1);
+			goto error;
+		}
+		remain_data += ret;
+		remain_len -= ret;
+		bits->ip_nr++;
+	}
+	if(rfc5225_ctxt->next_header_len > 0)
+	{
+		ret = rfc5225_ctxt->parse_static_next_hdr(context, remain_data, remain_len,
+		                                          bits);
+		if(ret < 0)
+		{
+			rohc_decomp_warn(context, "malformed ROHC packet: malformed static "
+			                 "part of the next header");
+			goto error;
+		}
+		remain_data += ret;
+		remain_len -= ret;
+	}
+
+	/* parse dynamic chain */
+	for(ip_hdr_nr = 0; ip_hdr_nr < bits->ip_nr; ip_hdr_nr++)
+	{
+		ret = rfc5225_parse_dyn_ip(context, remain_data, remain_len,
+		                                     !!(ip_hdr_nr == (bits->ip_nr - 1)),
+		                                     bits, &(bits->ip[ip_hdr_nr]));
+		if(ret < 0)
+		{
+			rohc_decomp_warn(context, "malformed ROHC packet: malformed dynamic "
+			                 "part of IP header #%zu", ip_hdr_nr + 1);
+			goto error;
+		}
+		remain_data += ret;
+		remain_len -= ret;
+	}
+	if(rfc5225_ctxt->next_header_len > 0)
+	{
+		ret = rfc5225_ctxt->parse_dyn_next_hdr(context, remain_data, remain_len,
+		                                       bits);
+		if(ret < 0)
+		{
+			rohc_decomp_warn(context, "malformed ROHC packet: malformed dynamic "
+			                 "part of the next header");
+			goto error;
+		}
+		remain_data += ret;
+		remain_len -= ret;
+	}
+
+	*rohc_hdr_len = remain_data - rohc_packet;
+	return true;
+
+error:
+	return false;
+}
+
+
+/**
+ * @brief Parse the static part of one IP header (RFC5225 §6.8.2.4)
+ *
+ * @param context             The decompression context
+ * @param rohc_data           The remaining ROHC data
+ * @param rohc_len            The length of the remaining ROHC data
+ * @param[out] ip_bits        The bits extracted for the IP header
+ * @param[out] is_innermost   Whether the IP header is the innermost one
+ * @return                    The length of the static part in case of
+ *                            success, -1 in case of failure
+ */
+static int rfc5225_parse_static_ip(const struct rohc_decomp_ctxt *const context,
+                                   const uint8_t *const rohc_data,
+                                   const size_t rohc_len,
+                                   struct rohc_rfc5225_ip_extr_bits *const ip_bits,
+                                   bool *const is_innermost)
+{
+	struct rohc_rfc5225_ip_values *const vals = &(ip_bits->vals);
+	size_t static_len;
+
+	if(rohc_len < 1)
+	{
+		goto too_short;
+	}
+	*is_innermost = !!(GET_BIT_6(rohc_data) != 0);
+
+	if(GET_BIT_7(rohc_data) == 0)
+	{
+		static_len = ROHC_RFC5225_IPV4_STATIC_LEN;
+		if(rohc_len < static_len)
+		{
+			goto too_short;
+		}
+		vals->version = IPV4;
+		vals->next_proto = rohc_data[1];
+		vals->flow_label = 0;
+		memcpy(vals->saddr, rohc_data + 2, 4);
+		memcpy(vals->daddr, rohc_data + 6, 4);
+		rohc_decomp_debug(context, "IPv4 static part: protocol = %u, innermost "
+		                  "= %d", vals->next_proto, *is_innermost);
+	}
+	else
+	{
+		const bool is_fl_present = !!(GET_BIT_4(rohc_data) != 0);
+		size_t pos = 1;
+
+		static_len = (is_fl_present ? ROHC_RFC5225_IPV6_STATIC_LEN :
+		              ROHC_RFC5225_IPV6_STATIC_LEN_NO_FL);
+		if(rohc_len < static_len)
+		{
+			goto too_short;
+		}
+		vals->version = IPV6;
+		vals->flow_label = 0;
+		if(is_fl_present)
+		{
+			vals->flow_label = (GET_BIT_0_3(rohc_data) << 16) |
+			                   (rohc_data[1] << 8) | rohc_data[2];
+			pos += 2;
+		}
+		vals->next_proto = rohc_data[pos];
+		pos++;
+		memcpy(vals->saddr, rohc_data + pos, sizeof(struct ipv6_addr));
+		pos += sizeof(struct ipv6_addr);
+		memcpy(vals->daddr, rohc_data + pos, sizeof(struct ipv6_addr));
+		rohc_decomp_debug(context, "IPv6 static part: flow label = 0x%05x, "
+		                  "next header = %u, innermost = %d", vals->flow_label,
+		                  vals->next_proto, *is_innermost);
+	}
+
+	/* the ROHCv2 profiles do not compress the IPv6 extension headers, only
+	 * the innermost IP header may be followed by another protocol */
+	if(!(*is_innermost) && !rohc_is_tunneling(vals->next_proto))
+	{
+		rohc_decomp_warn(context, "malformed static chain: protocol %u of one "
+		                 "outer IP header is not a tunneling protocol",
+		                 vals->next_proto);
+		goto error;
+	}
+
+	return static_len;
+
+too_short:
+	rohc_decomp_warn(context, "malformed ROHC packet: too short for the static "
+	                 "part of the IP header");
+error:
+	return -1;
+}
+
+
+/**
+ * @brief Parse the dynamic part of one IP header (RFC5225 §6.8.2.4)
+ *
+ * The dynamic part of the innermost IP header carries the reordering ratio
+ * and the MSN, unless the IP headers are followed by a next header whose
+ * dynamic part carries them.
+ *
+ * @param context        The decompression context
+ * @param rohc_data      The remaining ROHC data
+ * @param rohc_len       The length of the remaining ROHC data
+ * @param is_innermost   Whether the IP header is the innermost one
+ * @param[out] bits      The bits extracted from the ROHC packet
+ * @param[out] ip_bits   The bits extracted for the IP header
+ * @return               The length of the dynamic part in case of success,
+ *                       -1 in case of failure
+ */
+static int rfc5225_parse_dyn_ip(const struct rohc_decomp_ctxt *const context,
+                                const uint8_t *const rohc_data,
+                                const size_t rohc_len,
+                                const bool is_innermost,
+                                struct rohc_rfc5225_extr_bits *const bits,
+                                struct rohc_rfc5225_ip_extr_bits *const ip_bits)
+{
+	const struct rohc_decomp_rfc5225_ctxt *const rfc5225_ctxt =
+		context->persist_ctxt;
+	const bool with_msn = !!(is_innermost && rfc5225_ctxt->next_header_len == 0);
+	struct rohc_rfc5225_ip_values *const vals = &(ip_bits->vals);
+	size_t dyn_len = 0;
+
+	if(vals->version == IPV4)
+	{
+		if(rohc_len < 3)
+		{
+			goto too_short;
+		}
+		vals->df = GET_REAL(GET_BIT_2(rohc_data));
+		vals->ip_id_behavior = rohc_data[0] & 0x03;
+		if(with_msn)
+		{
+			bits->reorder_ratio = GET_BIT_3_4(rohc_data);
+			bits->reorder_present = true;
+		}
+		else if(!is_innermost &&
+		        vals->ip_id_behavior != ROHC_RFC5225_IP_ID_RAND &&
+		        vals->ip_id_behavior != ROHC_RFC5225_IP_ID_ZERO)
+		{
+			rohc_decomp_warn(context, "unsupported IP-ID behavior %d for one "
+			                 "outer IP header", vals->ip_id_behavior);
+			goto error;
+		}
+		dyn_len++;
+		vals->tos_tc = rohc_data[dyn_len++];
+		vals->ttl_hopl = rohc_data[dyn_len++];
+		ip_bits->df_present = true;
+		ip_bits->behavior_present = true;
+		ip_bits->tos_tc_present = true;
+		ip_bits->ttl_hopl_present = true;
+
+		vals->ip_id = 0;
+		if(vals->ip_id_behavior != ROHC_RFC5225_IP_ID_ZERO)
+		{
+			if(rohc_len < (dyn_len + 2))
+			{
+				goto too_short;
+			}
+			vals->ip_id = (rohc_data[dyn_len] << 8) | rohc_data[dyn_len + 1];
+			dyn_len += 2;
+		}
+		ip_bits->ip_id_present = true;
+		rohc_decomp_debug(context, "IPv4 dynamic part: TOS = 0x%02x, TTL = %u, "
+		                  "DF = %u, IP-ID behavior = %d, IP-ID = 0x%04x",
+		                  vals->tos_tc, vals->ttl_hopl, vals->df,
+		                  vals->ip_id_behavior, vals->ip_id);
+	}
+	else
+	{
+		if(rohc_len < 2)
+		{
+			goto too_short;
+		}
+		vals->tos_tc = rohc_data[dyn_len++];
+		vals->ttl_hopl = rohc_data[dyn_len++];
+		ip_bits->tos_tc_present = true;
+		ip_bits->ttl_hopl_present = true;
+		if(with_msn)
+		{
+			if(rohc_len < (dyn_len + 1))
+			{
+				goto too_short;
+			}
+			bits->reorder_ratio = rohc_data[dyn_len] & 0x03;
+			bits->reorder_present = true;
+			dyn_len++;
+		}
+		rohc_decomp_debug(context, "IPv6 dynamic part: TC = 0x%02x, HL = %u",
+		                  vals->tos_tc, vals->ttl_hopl);
+	}
+
+	if(with_msn)
+	{
+		if(rohc_len < (dyn_len + 2))
+		{
+			goto too_short;
+		}
+		bits->msn = (rohc_data[dyn_len] << 8) | rohc_data[dyn_len + 1];
+		bits->msn_nr = 16;
+		dyn_len += 2;
+		rohc_decomp_debug(context, "reorder_ratio = %u, MSN = 0x%04x",
+		                  bits->reorder_ratio, bits->msn);
+	}
+
+	return dyn_len;
+
+too_short:
+	rohc_decomp_warn(context, "malformed ROHC packet: too short for the dynamic "
+	                 "part of the IP header");
+error:
+	return -1;
+}
+
+
+/**
+ * @brief Parse the given CO packet for one of the ROHCv2 profiles
+ *
+ * The first byte of the CO header is placed before the large CID, the next
+ * bytes after it. The irregular chain follows the CO header.
+ *
+ * @param context            The decompression context
+ * @param rohc_packet        The ROHC packet to decode
+ * @param rohc_length        The length of the ROHC packet to decode
+ * @param large_cid_len      The length of the large CID field
+ * @param packet_type        The type of CO packet
+ * @param[out] extr_crc      The CRC bits extracted from the ROHC packet
+ * @param[out] bits          The bits extracted from the CO packet
+ * @param[out] rohc_hdr_len  The length of the ROHC header (in bytes)
+ * @return                   true if parsing was successful,
+ *                           false if packet was malformed
+ */
+static bool rfc5225_parse_co(const struct rohc_decomp_ctxt *const context,
+                             const uint8_t *const rohc_packet,
+                             const size_t rohc_length,
+                             const size_t large_cid_len,
+                             const rohc_packet_t packet_type,
+                             struct rohc_decomp_crc *const extr_crc,
+                             struct rohc_rfc5225_extr_bits *const bits,
+                             size_t *const rohc_hdr_len)
+{
+	const struct rohc_decomp_rfc5225_ctxt *const rfc5225_ctxt =
+		context->persist_ctxt;
+	/* the CO base header without the large CID */
+	uint8_t hdr[ROHC_DECOMP_RFC5225_CO_BASE_MAX_LEN];
+	const uint8_t *remain_data;
+	size_t remain_len;
+	size_t hdr_len;
+	bool outer_ip_indicator = false;
+	size_t ip_hdr_nr;
+	int ret;
+
+	assert(bits->ip_nr > 0);
+
+	/* gather the first byte and the next bytes of the CO base header */
+	if(rohc_length < (1 + large_cid_len))
+	{
+		rohc_decomp_warn(context, "malformed ROHC packet: too short for first "
+		                 "byte and large CID bytes");
+		goto error;
+	}
+	hdr[0] = rohc_packet[0];
+	hdr_len = rohc_min(sizeof(hdr), rohc_length - large_cid_len);
+	memcpy(hdr + 1, rohc_packet + 1 + large_cid_len, hdr_len - 1);
+
+	/* base header */
+	ret = rfc5225_ctxt->parse_co_base(context, hdr, hdr_len, packet_type,
+	                                  extr_crc, bits, &outer_ip_indicator);
+	if(ret < 0)
+	{
+		goto error;
+	}
+	hdr_len = ret;
+	rohc_decomp_debug(context, "%s packet with %zu-byte base header: %zu MSN "
+	                  "bits 0x%x, %zu IP-ID offset bits 0x%x, CRC-%zu 0x%x",
+	                  rohc_get_packet_descr(packet_type), hdr_len, bits->msn_nr,
+	                  bits->msn, bits->ip_id_offset_nr, bits->ip_id_offset,
+	                  extr_crc->bits_nr, extr_crc->bits);
+
+	/* skip the base header */
+	remain_data = rohc_packet + 1 + large_cid_len + hdr_len - 1;
+	remain_len = rohc_length - 1 - large_cid_len - (hdr_len - 1);
+
+	/* irregular chain: the random IP-IDs and the outer TOS/TTL */
+	for(ip_hdr_nr = 0; ip_hdr_nr < bits->ip_nr; ip_hdr_nr++)
+	{
+		struct rohc_rfc5225_ip_extr_bits *const ip_bits = &(bits->ip[ip_hdr_nr]);
+		const bool is_innermost = !!(ip_hdr_nr == (bits->ip_nr - 1));
+
+		if(ip_bits->vals.version == IPV4 &&
+		   ip_bits->vals.ip_id_behavior == ROHC_RFC5225_IP_ID_RAND)
+		{
+			if(remain_len < 2)
+			{
+				goto too_short;
+			}
+			ip_bits->vals.ip_id = (remain_data[0] << 8) | remain_data[1];
+			ip_bits->ip_id_present = true;
+			remain_data += 2;
+			remain_len -= 2;
+		}
+		if(!is_innermost && outer_ip_indicator)
+		{
+			if(remain_len < 2)
+			{
+				goto too_short;
+			}
+			ip_bits->vals.tos_tc = remain_data[0];
+			ip_bits->vals.ttl_hopl = remain_data[1];
+			ip_bits->tos_tc_present = true;
+			ip_bits->ttl_hopl_present = true;
+			remain_data += 2;
+			remain_len -= 2;
+		}
+	}
+	if(rfc5225_ctxt->next_header_len > 0)
+	{
+		ret = rfc5225_ctxt->parse_irreg_next_hdr(context, remain_data, remain_len,
+		                                         bits);
+		if(ret < 0)
+		{
+			rohc_decomp_warn(context, "malformed ROHC packet: malformed irregular "
+			                 "part of the next header");
+			goto error;
+		}
+		remain_data += ret;
+		remain_len -= ret;
+	}
+
+	*rohc_hdr_len = remain_data - rohc_packet;
+	return true;
+
+too_short:
+	rohc_decomp_warn(context, "malformed ROHC packet: too short for the %s "
+	                 "packet", rohc_get_packet_descr(packet_type));
+error:
+	return false;
+}
+
+
+/**
+ * @brief Parse the base header of one CO packet of the IP-only profile
+ *
+ * @param context                  The decompression context
+ * @param hdr                      The base header without large CID
+ * @param hdr_len                  The length of the available base header
+ * @param packet_type              The type of CO packet
+ * @param[out] extr_crc            The CRC bits extracted from the header
+ * @param[out] bits                The bits extracted from the header
+ * @param[out] outer_ip_indicator  Whether the irregular chain transmits the
+ *                                 outer TOS/TC and TTL/HL
+ * @return                         The length of the base header in case of
+ *                                 success, -1 in case of failure
+ */
+static int rfc5225_parse_co_base(const struct rohc_decomp_ctxt *const context,
+                                 const uint8_t *const hdr,
+                                 const size_t hdr_len,
+                                 const rohc_packet_t packet_type,
+                                 struct rohc_decomp_crc *const extr_crc,
+                                 struct rohc_rfc5225_extr_bits *const bits,
+                                 bool *const outer_ip_indicator)
+{
+	size_t base_len;
+
+	*outer_ip_indicator = false;
+
+	switch(packet_type)
+	{
+		case ROHC_PACKET_PT_0_CRC3:
+			extr_crc->type = ROHC_CRC_TYPE_3;
+			extr_crc->bits = GET_BIT_0_2(hdr);
+			extr_crc->bits_nr = 3;
+			bits->msn = GET_BIT_3_6(hdr);
+			bits->msn_nr = 4;
+			base_len = 1;
+			break;
+		case ROHC_PACKET_PT_0_CRC7:
+			if(hdr_len < 2)
+			{
+				goto too_short;
+			}
+			extr_crc->type = ROHC_CRC_TYPE_7;
+			extr_crc->bits = GET_BIT_0_6(hdr + 1);
+			extr_crc->bits_nr = 7;
+			bits->msn = (GET_BIT_0_4(hdr) << 1) | (GET_BIT_7(hdr + 1) >> 7);
+			bits->msn_nr = 6;
+			base_len = 2;
+			break;
+		case ROHC_PACKET_PT_1_SEQ_ID:
+			if(hdr_len < 2)
+			{
+				goto too_short;
+			}
+			bits->ip_id_offset = GET_BIT_0_3(hdr);
+			bits->ip_id_offset_nr = 4;
+			extr_crc->type = ROHC_CRC_TYPE_3;
+			extr_crc->bits = GET_BIT_5_7(hdr + 1);
+			extr_crc->bits_nr = 3;
+			bits->msn = GET_BIT_0_4(hdr + 1);
+			bits->msn_nr = 5;
+			base_len = 2;
+			break;
+		case ROHC_PACKET_PT_2_SEQ_ID:
+			if(hdr_len < 3)
+			{
+				goto too_short;
+			}
+			bits->ip_id_offset = (GET_BIT_0_4(hdr) << 1) | (GET_BIT_7(hdr + 1) >> 7);
+			bits->ip_id_offset_nr = 6;
+			extr_crc->type = ROHC_CRC_TYPE_7;
+			extr_crc->bits = GET_BIT_0_6(hdr + 1);
+			extr_crc->bits_nr = 7;
+			bits->msn = hdr[2];
+			bits->msn_nr = 8;
+			base_len = 3;
+			break;
+		case ROHC_PACKET_CO_COMMON:
+		{
+			const int ret =
+				rohc_decomp_rfc5225_parse_co_common(context, hdr, hdr_len, extr_crc,
+				                                    bits, outer_ip_indicator);
+			if(ret < 0)
+			{
+				goto error;
+			}
+			base_len = ret;
+			break;
+		}
+		default:
+			rohc_decomp_warn(context, "unexpected packet type %d", packet_type);
+			goto error;
+	}
+
+	return base_len;
+
+too_short:
+	rohc_decomp_warn(context, "malformed ROHC packet: too short for the %s "
+	                 "packet", rohc_get_packet_descr(packet_type));
+error:
+	return -1;
+}
+
+
+/**
+ * @brief Parse the co_common base header (RFC5225 §6.8.2.4)
+ *
+ * The RTP profile parses its own fields after the header.
+ *
+ * @param context                  The decompression context
+ * @param rohc_data                The co_common header without large CID
+ * @param rohc_len                 The length of the co_common header
+ * @param[out] extr_crc            The CRC bits extracted from the header
+ * @param[out] bits                The bits extracted from the header
+ * @param[out] outer_ip_indicator  Whether the irregular chain transmits the
+ *                                 outer TOS/TC and TTL/HL
+ * @return                         The length of the co_common header in case
+ *                                 of success, -1 in case of failure
+ */
+int rohc_decomp_rfc5225_parse_co_common(const struct rohc_decomp_ctxt *const context,
+                                        const uint8_t *const rohc_data,
+                                        const size_t rohc_len,
+                                        struct rohc_decomp_crc *const extr_crc,
+                                        struct rohc_rfc5225_extr_bits *const bits,
+                                        bool *const outer_ip_indicator)
+{
+	struct rohc_rfc5225_ip_extr_bits *const inner_bits =
+		&(bits->ip[bits->ip_nr - 1]);
+	struct rohc_rfc5225_ip_values *const inner_vals = &(inner_bits->vals);
+	bool ip_id_indicator;
+	bool flags_indicator;
+	bool ttl_indicator;
+	bool tos_indicator;
+	size_t hdr_len = 0;
+
+	if(rohc_len < 3)
+	{
+		goto too_short;
+	}
+	hdr_len++; /* discriminator */
+
+	ip_id_indicator = !!(GET_BIT_7(rohc_data + hdr_len) != 0);
+	extr_crc->type = ROHC_CRC_TYPE_7;
+	extr_crc->bits = GET_BIT_0_6(rohc_data + hdr_len);
+	extr_crc->bits_nr = 7;
+	hdr_len++;
+
+	flags_indicator = !!(GET_BIT_7(rohc_data + hdr_len) != 0);
+	ttl_indicator = !!(GET_BIT_6(rohc_data + hdr_len) != 0);
+	tos_indicator = !!(GET_BIT_5(rohc_data + hdr_len) != 0);
+	bits->reorder_ratio = GET_BIT_3_4(rohc_data + hdr_len);
+	bits->reorder_present = true;
+	bits->ctrl_crc = GET_BIT_0_2(rohc_data + hdr_len);
+	bits->ctrl_crc_present = true;
+	hdr_len++;
+
+	*outer_ip_indicator = false;
+	if(flags_indicator)
+	{
+		if(rohc_len < (hdr_len + 1))
+		{
+			goto too_short;
+		}
+		*outer_ip_indicator = !!(GET_BIT_7(rohc_data + hdr_len) != 0);
+		if(inner_vals->version == IPV4)
+		{
+			inner_vals->df = GET_REAL(GET_BIT_6(rohc_data + hdr_len));
+			inner_vals->ip_id_behavior = (rohc_data[hdr_len] >> 4) & 0x03;
+			inner_bits->df_present = true;
+			inner_bits->behavior_present = true;
+		}
+		hdr_len++;
+	}
+	if(tos_indicator)
+	{
+		if(rohc_len < (hdr_len + 1))
+		{
+			goto too_short;
+		}
+		inner_vals->tos_tc = rohc_data[hdr_len];
+		inner_bits->tos_tc_present = true;
+		hdr_len++;
+	}
+	if(ttl_indicator)
+	{
+		if(rohc_len < (hdr_len + 1))
+		{
+			goto too_short;
+		}
+		inner_vals->ttl_hopl = rohc_data[hdr_len];
+		inner_bits->ttl_hopl_present = true;
+		hdr_len++;
+	}
+
+	if(rohc_len < (hdr_len + 1))
+	{
+		goto too_short;
+	}
+	bits->msn = rohc_data[hdr_len];
+	bits->msn_nr = 8;
+	hdr_len++;
+
+	/* the innermost sequential IP-ID is sent either as an 8-bit offset or
+	 * in full */
+	if(inner_vals->version == IPV4 &&
+	   (inner_vals->ip_id_behavior == ROHC_RFC5225_IP_ID_SEQ ||
+	    inner_vals->ip_id_behavior == ROHC_RFC5225_IP_ID_SEQ_SWAP))
+	{
+		if(ip_id_indicator)
+		{
+			if(rohc_len < (hdr_len + 2))
+			{
+				goto too_short;
+			}
+			inner_vals->ip_id = (rohc_data[hdr_len] << 8) | rohc_data[hdr_len + 1];
+			inner_bits->ip_id_present = true;
+			hdr_len += 2;
+		}
+		else
+		{
+			if(rohc_len < (hdr_len + 1))
+			{
+				goto too_short;
+			}
+			bits->ip_id_offset = rohc_data[hdr_len];
+			bits->ip_id_offset_nr = 8;
+			hdr_len++;
+		}
+	}
+
+	return hdr_len;
+
+too_short:
+	rohc_decomp_warn(context, "malformed ROHC packet: too short for the "
+	                 "co_common header");
+	return -1;
+}
+
+
+/**
+ * @brief Decode the values from the bits extracted from the ROHC packet
+ *
+ * @param context      The decompression context
+ * @param bits         The bits extracted from the ROHC packet
+ * @param payload_len  The length of the packet payload (in bytes)
+ * @param[out] decoded The corresponding decoded values
+ * @return             true if decoding is successful, false otherwise
+ */
+bool rohc_decomp_rfc5225_decode_bits(const struct rohc_decomp_ctxt *const context,
+                                     const struct rohc_rfc5225_extr_bits *const bits,
+                                     const size_t payload_len __attribute__((unused)),
+                                     struct rohc_rfc5225_decoded *const decoded)
+{
+	const struct rohc_decomp_rfc5225_ctxt *const rfc5225_ctxt =
+		context->persist_ctxt;
+	size_t ip_hdr_nr;
+
+	assert(bits->ip_nr > 0);
+	decoded->ip_nr = bits->ip_nr;
+
+	/* reordering ratio */
+	decoded->reorder_ratio =
+		(bits->reorder_present ? bits->reorder_ratio : rfc5225_ctxt->reorder_ratio);
+
+	/* MSN */
+	if(bits->msn_nr == 16)
+	{
+		decoded->msn = bits->msn;
+	}
+	else
+	{
+		const rohc_lsb_shift_t p =
+			rohc_interval_get_rfc5225_msn_p(decoded->reorder_ratio);
+
+		if(!rohc_lsb_ref16_is_ready(&rfc5225_ctxt->msn_lsb_ctxt))
+		{
+			rohc_decomp_warn(context, "no reference to decode the %zu MSN bits",
+			                 bits->msn_nr);
+			goto error;
+		}
+		decoded->msn = rohc_lsb_ref16_decode(&rfc5225_ctxt->msn_lsb_ctxt,
+		                                     bits->msn, bits->msn_nr, p);
+	}
+	rohc_decomp_debug(context, "decoded MSN = 0x%04x (%zu bits 0x%x)",
+	                  decoded->msn, bits->msn_nr, bits->msn);
+
+	/* IP headers: the extracted bits were initialized with the context */
+	for(ip_hdr_nr = 0; ip_hdr_nr < bits->ip_nr; ip_hdr_nr++)
+	{
+		const struct rohc_rfc5225_ip_extr_bits *const ip_bits =
+			&(bits->ip[ip_hdr_nr]);
+		struct rohc_rfc5225_ip_values *const ip_decoded = &(decoded->ip[ip_hdr_nr]);
+		const bool is_innermost = !!(ip_hdr_nr == (bits->ip_nr - 1));
+
+		*ip_decoded = ip_bits->vals;
+		if(ip_decoded->version != IPV4)
+		{
+			continue;
+		}
+
+		if(ip_decoded->ip_id_behavior == ROHC_RFC5225_IP_ID_ZERO)
+		{
+			ip_decoded->ip_id = 0;
+		}
+		else if(ip_bits->ip_id_present)
+		{
+			/* IP-ID transmitted in full */
+		}
+		else if(is_innermost &&
+		        (ip_decoded->ip_id_behavior == ROHC_RFC5225_IP_ID_SEQ ||
+		         ip_decoded->ip_id_behavior == ROHC_RFC5225_IP_ID_SEQ_SWAP))
+		{
+			uint16_t ip_id_offset;
+			uint16_t ip_id_seq;
+
+			if(!rohc_lsb_ref16_is_ready(&rfc5225_ctxt->ip_id_offset_lsb_ctxt))
+			{
+				rohc_decomp_warn(context, "no reference to decode the innermost "
+				                 "IP-ID offset");
+				goto error;
+			}
+			if(bits->ip_id_offset_nr > 0)
+			{
+				ip_id_offset =
+					rohc_lsb_ref16_decode(&rfc5225_ctxt->ip_id_offset_lsb_ctxt,
+					                      bits->ip_id_offset, bits->ip_id_offset_nr,
+					                      ROHC_LSB_SHIFT_RFC5225_IP_ID);
+			}
+			else
+			{
+				ip_id_offset = rohc_lsb_ref16_get(&rfc5225_ctxt->ip_id_offset_lsb_ctxt);
+			}
+			ip_id_seq = (ip_id_offset + decoded->msn) & 0xffff;
+			ip_decoded->ip_id =
+				(ip_decoded->ip_id_behavior == ROHC_RFC5225_IP_ID_SEQ_SWAP ?
+				 swab16(ip_id_seq) : ip_id_seq);
+			rohc_decomp_debug(context, "decoded IP-ID offset = 0x%04x (%zu bits "
+			                  "0x%x)", ip_id_offset, bits->ip_id_offset_nr,
+			                  bits->ip_id_offset);
+		}
+		else
+		{
+			rohc_decomp_warn(context, "IP-ID of IP header #%zu with behavior %d "
+			                 "was not transmitted", ip_hdr_nr + 1,
+			                 ip_decoded->ip_id_behavior);
+			goto error;
+		}
+		rohc_decomp_debug(context, "IP header #%zu: decoded IP-ID = 0x%04x",
+		                  ip_hdr_nr + 1, ip_decoded->ip_id);
+	}
+
+	/* the header that follows the IP headers */
+	if(rfc5225_ctxt->next_header_len > 0 &&
+	   !rfc5225_ctxt->decode_next_hdr(context, bits, decoded))
+	{
+		rohc_decomp_warn(context, "failed to decode the fields of the next "
+		                 "header");
+		goto error;
+	}
+
+	/* the control CRC is checked once the headers are built */
+	decoded->ctrl_crc = bits->ctrl_crc;
+	decoded->ctrl_crc_present = bits->ctrl_crc_present;
+
+	return true;
+
+error:
+	return false;
+}
+
+
+/**
+ * @brief Build the uncompressed headers for one of the ROHCv2 profiles
+ *
+ * @param decomp                The ROHC decompressor
+ * @param context               The decompression context
+ * @param packet_type           The type of ROHC packet
+ * @param extr_crc              The CRC bits extracted from the ROHC header
+ * @param decoded               The values decoded from ROHC header
+ * @param payload_len           The length of the packet payload (in bytes)
+ * @param[out] uncomp_hdrs      The uncompressed headers being built
+ * @param[out] uncomp_hdrs_len  The length of the uncompressed headers written
+ *                              into the buffer
+ * @return                      Possible values:
+ *                               \li ROHC_STATUS_OK if headers are built
+ *                                   successfully,
+ *                               \li ROHC_STATUS_BAD_CRC if headers do not
+ *                                   match CRC,
+ *                               \li ROHC_STATUS_OUTPUT_TOO_SMALL if
+ *                                   \e uncomp_hdrs is too small
+ */
+rohc_status_t rohc_decomp_rfc5225_build_hdrs(const struct rohc_decomp *const decomp,
+                                             const struct rohc_decomp_ctxt *const context,
+                                             const rohc_packet_t packet_type,
+                                             const struct rohc_decomp_crc *const extr_crc,
+                                             const struct rohc_rfc5225_decoded *const decoded,
+                                             const size_t payload_len,
+                                             struct rohc_buf *const uncomp_hdrs,
+                                             size_t *const uncomp_hdrs_len)
+{
+	const struct rohc_decomp_rfc5225_ctxt *const rfc5225_ctxt =
+		context->persist_ctxt;
+	size_t remain_hdrs_len;
+	size_t ip_hdr_nr;
+
+	rohc_decomp_debug(context, "build %zu IP headers", decoded->ip_nr);
+
+	/* compute the length of the headers first, every IP header announces
+	 * the length of the headers that follow it */
+	*uncomp_hdrs_len = rfc5225_ctxt->next_header_len;
+	for(ip_hdr_nr = 0; ip_hdr_nr < decoded->ip_nr; ip_hdr_nr++)
+	{
+		if(decoded->ip[ip_hdr_nr].version == IPV4)
+		{
+			*uncomp_hdrs_len += sizeof(struct ipv4_hdr);
+		}
+		else
+		{
+			*uncomp_hdrs_len += sizeof(struct ipv6_hdr);
+		}
+	}
+	if(rohc_buf_avail_len(*uncomp_hdrs) < (*uncomp_hdrs_len))
+	{
+		rohc_decomp_warn(context, "output buffer too small for the %zu-byte "
+		                 "uncompressed headers", *uncomp_hdrs_len);
+		goto error_output_too_small;
+	}
+
+	/* build the IP headers */
+	remain_hdrs_len = *uncomp_hdrs_len;
+	for(ip_hdr_nr = 0; ip_hdr_nr < decoded->ip_nr; ip_hdr_nr++)
+	{
+		const struct rohc_rfc5225_ip_values *const ip_decoded =
+			&(decoded->ip[ip_hdr_nr]);
+
+		if(ip_decoded->version == IPV4)
+		{
+			struct ipv4_hdr *const ipv4 =
+				(struct ipv4_hdr *) rohc_buf_data(*uncomp_hdrs);
+
+			ipv4->version = IPV4;
+			ipv4->ihl = sizeof(struct ipv4_hdr) / sizeof(uint32_t);
+			ipv4->tos = ip_decoded->tos_tc;
+			ipv4->id = rohc_hton16(ip_decoded->ip_id);
+			ipv4->frag_off = 0;
+			ipv4->df = ip_decoded->df;
+			ipv4->ttl = ip_decoded->ttl_hopl;
+			ipv4->protocol = ip_decoded->next_proto;
+			memcpy(&ipv4->saddr, ip_decoded->saddr, 4);
+			memcpy(&ipv4->daddr, ip_decoded->daddr, 4);
+			ipv4->tot_len = rohc_hton16(remain_hdrs_len + payload_len);
+			ipv4->check = 0;
+			ipv4->check = ip_fast_csum((uint8_t *) ipv4, ipv4->ihl);
+			rohc_decomp_debug(context, "IPv4 header #%zu: total length = %u, "
+			                  "IP-ID = 0x%04x, checksum = 0x%04x", ip_hdr_nr + 1,
+			                  rohc_ntoh16(ipv4->tot_len), ip_decoded->ip_id,
+			                  rohc_ntoh16(ipv4->check));
+			uncomp_hdrs->len += sizeof(struct ipv4_hdr);
+			rohc_buf_pull(uncomp_hdrs, sizeof(struct ipv4_hdr));
+			remain_hdrs_len -= sizeof(struct ipv4_hdr);
+		}
+		else
+		{
+			struct ipv6_hdr *const ipv6 =
+				(struct ipv6_hdr *) rohc_buf_data(*uncomp_hdrs);
+
+			ipv6->version_tc_flow = 0;
+			ipv6->version = IPV6;
+			ipv6_set_tc(ipv6, ip_decoded->tos_tc);
+			ipv6_set_flow_label(ipv6, ip_decoded->flow_label);
+			ipv6->nh = ip_decoded->next_proto;
+			ipv6->hl = ip_decoded->ttl_hopl;
+			memcpy(&ipv6->saddr, ip_decoded->saddr, sizeof(struct ipv6_addr));
+			memcpy(&ipv6->daddr, ip_decoded->daddr, sizeof(struct ipv6_addr));
+			remain_hdrs_len -= sizeof(struct ipv6_hdr);
+			ipv6->plen = rohc_hton16(remain_hdrs_len + payload_len);
+			rohc_decomp_debug(context, "IPv6 header #%zu: payload length = %u",
+			                  ip_hdr_nr + 1, rohc_ntoh16(ipv6->plen));
+			uncomp_hdrs->len += sizeof(struct ipv6_hdr);
+			rohc_buf_pull(uncomp_hdrs, sizeof(struct ipv6_hdr));
+		}
+	}
+
+	/* build the header that follows the IP headers */
+	if(rfc5225_ctxt->next_header_len > 0)
+	{
+		rfc5225_ctxt->build_next_hdr(context, decoded, payload_len,
+		                             rohc_buf_data(*uncomp_hdrs));
+		uncomp_hdrs->len += rfc5225_ctxt->next_header_len;
+		rohc_buf_pull(uncomp_hdrs, rfc5225_ctxt->next_header_len);
+	}
+
+	/* unhide the uncompressed headers */
+	rohc_buf_push(uncomp_hdrs, *uncomp_hdrs_len);
+
+	/* compute CRC on uncompressed headers if asked */
+	if(extr_crc->type != ROHC_CRC_TYPE_NONE)
+	{
+		const uint8_t crc_init =
+			(extr_crc->type == ROHC_CRC_TYPE_3 ? CRC_INIT_3 : CRC_INIT_7);
+		const uint8_t crc_computed =
+			crc_calculate(extr_crc->type, rohc_buf_data(*uncomp_hdrs),
+			              *uncomp_hdrs_len, crc_init);
+
+		rohc_decomp_debug(context, "CRC-%d on uncompressed headers = 0x%x",
+		                  extr_crc->type, crc_computed);
+		if(crc_computed != extr_crc->bits)
+		{
+			rohc_decomp_warn(context, "CRC failure (computed = 0x%02x, packet = "
+			                 "0x%02x) for packet of type %s in state %s and mode %s",
+			                 crc_computed, extr_crc->bits,
+			                 rohc_get_packet_descr(packet_type),
+			                 rohc_decomp_get_state_descr(context->state),
+			                 rohc_get_mode_descr(context->mode));
+			if(rohc_trace_is_enabled(decomp, ROHC_TRACE_WARNING) &&
+			   (decomp->features & ROHC_DECOMP_FEATURE_DUMP_PACKETS) != 0)
+			{
+				rohc_dump_packet(decomp->trace_callback, decomp->trace_callback_priv,
+				                 ROHC_TRACE_DECOMP, ROHC_TRACE_WARNING,
+				                 "uncompressed headers", *uncomp_hdrs);
+			}
+			goto error_crc;
+		}
+	}
+
+	/* the control CRC protects the fields that are not in the headers */
+	if(decoded->ctrl_crc_present)
+	{
+		const uint8_t ctrl_crc = rfc5225_ctrl_crc3(decoded);
+
+		if(ctrl_crc != decoded->ctrl_crc)
+		{
+			rohc_decomp_warn(context, "control CRC failure (computed = 0x%x, "
+			                 "packet = 0x%x)", ctrl_crc, decoded->ctrl_crc);
+			goto error_crc;
+		}
+	}
+
+	if(rohc_trace_is_enabled(decomp, ROHC_TRACE_DEBUG) &&
+	   (decomp->features & ROHC_DECOMP_FEATURE_DUMP_PACKETS) != 0)
+	{
+		rohc_dump_packet(decomp->trace_callback, decomp->trace_callback_priv,
+		                 ROHC_TRACE_DECOMP, ROHC_TRACE_DEBUG,
+		                 "uncompressed headers", *uncomp_hdrs);
+	}
+
+	return ROHC_STATUS_OK;
+
+error_crc:
+	return ROHC_STATUS_BAD_CRC;
+error_output_too_small:
+	return ROHC_STATUS_OUTPUT_TOO_SMALL;
+}
+
+
+/**
+ * @brief Compute the control CRC-3 of the decoded values
+ *
+ * @param decoded  The values decoded from the ROHC packet
+ * @return         The control CRC-3
+ */
+static uint8_t rfc5225_ctrl_crc3(const struct rohc_rfc5225_decoded *const decoded)
+{
+	uint8_t ip_id_behaviors[ROHC_RFC5225_MAX_IP_HDRS];
+	size_t ip_id_behaviors_nr = 0;
+	size_t ip_hdr_nr;
+
+	for(ip_hdr_nr = 0; ip_hdr_nr < decoded->ip_nr; ip_hdr_nr++)
+	{
+		if(decoded->ip[ip_hdr_nr].version == IPV4)
+		{
+			ip_id_behaviors[ip_id_behaviors_nr] =
+				decoded->ip[ip_hdr_nr].ip_id_behavior;
+			ip_id_behaviors_nr++;
+		}
+	}
+
+	return rfc5225_compute_ctrl_crc3(decoded->reorder_ratio, decoded->msn,
+	                                 ip_id_behaviors, ip_id_behaviors_nr);
+}
+
+
+/**
+ * @brief Update the decompression context with the infos of current packet
+ *
+ * @param context              The decompression context
+ * @param decoded              The decoded values to update in the context
+ * @param payload_len          The length of the packet payload (in bytes)
+ * @param[out] do_change_mode  Whether the profile context wants to change
+ *                             its operational mode or not
+ */
+void rohc_decomp_rfc5225_update_ctxt(struct rohc_decomp_ctxt *const context,
+                                     const struct rohc_rfc5225_decoded *const decoded,
+                                     const size_t payload_len __attribute__((unused)),
+                                     bool *const do_change_mode)
+{
+	struct rohc_decomp_rfc5225_ctxt *const rfc5225_ctxt = context->persist_ctxt;
+	const struct rohc_rfc5225_ip_values *const inner_ip =
+		&(decoded->ip[decoded->ip_nr - 1]);
+	size_t ip_hdr_nr;
+
+	/* mode did not change */
+	*do_change_mode = false;
+
+	/* IP headers */
+	for(ip_hdr_nr = 0; ip_hdr_nr < decoded->ip_nr; ip_hdr_nr++)
+	{
+		rfc5225_ctxt->ip[ip_hdr_nr] = decoded->ip[ip_hdr_nr];
+	}
+	rfc5225_ctxt->ip_nr = decoded->ip_nr;
+	rfc5225_ctxt->reorder_ratio = decoded->reorder_ratio;
+
+	/* MSN */
+	rohc_lsb_ref16_set(&rfc5225_ctxt->msn_lsb_ctxt, decoded->msn);
+	rohc_decomp_debug(context, "MSN 0x%04x / %u is the new reference",
+	                  decoded->msn, decoded->msn);
+
+	/* the offset of the innermost IP-ID from the MSN, whatever its behavior
+	 * as the compressor does */
+	if(inner_ip->version == IPV4)
+	{
+		const uint16_t ip_id_seq =
+			(inner_ip->ip_id_behavior == ROHC_RFC5225_IP_ID_SEQ_SWAP ?
+			 swab16(inner_ip->ip_id) : inner_ip->ip_id);
+		const uint16_t ip_id_offset = (ip_id_seq - decoded->msn) & 0xffff;
+
+		rohc_lsb_ref16_set(&rfc5225_ctxt->ip_id_offset_lsb_ctxt, ip_id_offset);
+		rohc_decomp_debug(context, "innermost IP-ID offset 0x%04x is the new "
+		                  "reference", ip_id_offset);
+	}
+
+	/* the header that follows the IP headers */
+	if(rfc5225_ctxt->next_header_len > 0)
+	{
+		rfc5225_ctxt->update_next_hdr(context, decoded);
+	}
+}
+
+
+/**
+ * @brief Attempt a packet/context repair upon CRC failure
+ *
+ * @param decomp            The ROHC decompressor
+ * @param context           The decompression context
+ * @param pkt_arrival_time  The arrival time of the ROHC packet that caused the CRC
+ *                          failure
+ * @param[in,out] crc_corr  The context for corrections upon CRC failures
+ * @param[in,out] bits      The bits extracted from the ROHC header
+ * @return                  true if repair is possible, false if not
+ */
+bool rohc_decomp_rfc5225_attempt_repair(const struct rohc_decomp *const decomp __attribute__((unused)),
+                                        const struct rohc_decomp_ctxt *const context __attribute__((unused)),
+                                        const struct rohc_ts pkt_arrival_time __attribute__((unused)),
+                                        struct rohc_decomp_crc_corr_ctxt *const crc_corr __attribute__((unused)),
+                                        struct rohc_rfc5225_extr_bits *const bits __attribute__((unused)))
+{
+	rohc_decomp_debug(context, "will not attempt packet/context repair");
+	return false;
+}
+
+
+/**
+ * @brief Attempt to decode a late packet against a previous reference
+ *
+ * @param decomp        The ROHC decompressor
+ * @param context       The decompression context
+ * @param[in,out] bits  The bits extracted from the ROHC header
+ * @return              true if a new decoding attempt is possible,
+ *                      false if not
+ */
+bool rohc_decomp_rfc5225_attempt_late(const struct rohc_decomp *const decomp __attribute__((unused)),
+                                      const struct rohc_decomp_ctxt *const context __attribute__((unused)),
+                                      struct rohc_rfc5225_extr_bits *const bits __attribute__((unused)))
+{
+	/* the late packets are handled by the interpretation interval of the MSN
+	 * that the reordering ratio of the compressor shifts, no previous
+	 * reference is kept */
+	return false;
+}
+
+
+/**
+ * @brief Get the reference MSN value of the context
+ *
+ * This function is one of the functions that must exist in one profile for
+ * the framework to work.
+ *
+ * @param context  The decompression context
+ * @return         The reference MSN value
+ */
+uint32_t rohc_decomp_rfc5225_get_msn(const struct rohc_decomp_ctxt *const context)
+{
+	const struct rohc_decomp_rfc5225_ctxt *const rfc5225_ctxt =
+		context->persist_ctxt;
+	return rohc_lsb_ref16_get(&rfc5225_ctxt->msn_lsb_ctxt);
+}
+
@@ -0,0 +1,327 @@
+/*
+ * Copyright 2016,2026 Didier Barvaux
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/**
+ * @file   rohc_decomp_rfc5225.h
+ * @brief  Generic framework for RFC5225-based decompression profiles such as
+ *         the ROHCv2 IP-only, UDP, ESP and RTP profiles
+ * @author Didier Barvaux <didier@barvaux.org>
+ */
+
+#ifndef ROHC_DECOMP_RFC5225_H
+#define ROHC_DECOMP_RFC5225_H
+
+#include "rohc_decomp_internals.h"
+#include "rohc_packets.h"
+#include "schemes/decomp_wlsb.h"
+#include "protocols/rfc5225.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+
+
+/**
+ * @brief The max length of the base header of one CO packet
+ *
+ * The largest base header is the co_common header of the RTP profile with
+ * all its optional fields.
+ */
+#define ROHC_DECOMP_RFC5225_CO_BASE_MAX_LEN  19U
+
+
+/** The values of one IP header of the ROHCv2 profiles */
+struct rohc_rfc5225_ip_values
+{
+	uint8_t version;      /**< The IP version */
+	uint8_t next_proto;   /**< The IPv4 Protocol or IPv6 Next Header */
+	uint8_t tos_tc;       /**< The IPv4 TOS or IPv6 Traffic Class */
+	uint8_t ttl_hopl;     /**< The IPv4 TTL or IPv6 Hop Limit */
+	uint8_t df;           /**< The IPv4 DF flag */
+	/** The behavior of the IPv4 Identification field */
+	rohc_rfc5225_ip_id_behavior_t ip_id_behavior;
+	uint16_t ip_id;       /**< The IPv4 Identification (host byte order) */
+	uint32_t flow_label;  /**< The IPv6 Flow Label */
+	uint8_t saddr[16];    /**< The source address */
+	uint8_t daddr[16];    /**< The destination address */
+};
+
+
+/** The bits of one IP header extracted from one ROHCv2 packet */
+struct rohc_rfc5225_ip_extr_bits
+{
+	struct rohc_rfc5225_ip_values vals; /**< The values of the IP header */
+	bool tos_tc_present;     /**< Whether the TOS/TC was transmitted */
+	bool ttl_hopl_present;   /**< Whether the TTL/HL was transmitted */
+	bool df_present;         /**< Whether the DF flag was transmitted */
+	bool behavior_present;   /**< Whether the IP-ID behavior was transmitted */
+	bool ip_id_present;      /**< Whether the full IP-ID was transmitted */
+};
+
+
+/** The bits extracted from one ROHCv2 packet */
+struct rohc_rfc5225_extr_bits
+{
+	/** The bits of the IP headers, from the outermost to the innermost */
+	struct rohc_rfc5225_ip_extr_bits ip[ROHC_RFC5225_MAX_IP_HDRS];
+	/** The number of IP headers (IR packet only) */
+	size_t ip_nr;
+	/** Whether the static chain was transmitted */
+	bool is_ir;
+
+	uint8_t reorder_ratio;    /**< The reordering ratio */
+	bool reorder_present;     /**< Whether the reordering ratio was transmitted */
+
+	uint16_t msn;             /**< The LSB bits of the MSN */
+	size_t msn_nr;            /**< The number of LSB bits of the MSN */
+
+	uint16_t ip_id_offset;    /**< The LSB bits of the innermost IP-ID offset */
+	size_t ip_id_offset_nr;   /**< The number of bits of the IP-ID offset */
+
+	uint8_t ctrl_crc;         /**< The control CRC-3 of the co_common packet */
+	bool ctrl_crc_present;    /**< Whether the control CRC-3 was transmitted */
+
+	/* bits extracted for the UDP header (IP/UDP profile) */
+	uint16_t udp_sport;       /**< The UDP source port (network byte order) */
+	uint16_t udp_dport;       /**< The UDP destination port (network byte order) */
+	uint16_t udp_check;       /**< The UDP checksum (network byte order) */
+	bool udp_check_present;   /**< Whether the UDP checksum was transmitted */
+
+	/* bits extracted for the ESP header (IP/ESP profile) */
+	uint32_t esp_spi;         /**< The ESP SPI (network byte order) */
+	uint32_t esp_sn;          /**< The ESP Sequence Number (IR packet only) */
+
+	/* bits extracted for the RTP header (IP/UDP/RTP profile) */
+	uint32_t rtp_ssrc;        /**< The RTP SSRC (network byte order) */
+	uint8_t rtp_pt;           /**< The RTP Payload Type */
+	bool rtp_pt_present;      /**< Whether the Payload Type was transmitted */
+	uint8_t rtp_p;            /**< The RTP Padding bit */
+	uint8_t rtp_x;            /**< The RTP Extension bit */
+	bool rtp_px_present;      /**< Whether the Padding and Extension were transmitted */
+	uint8_t rtp_m;            /**< The RTP Marker bit, 0 if not transmitted */
+	uint32_t rtp_ts;          /**< The whole RTP Timestamp (host byte order) */
+	bool rtp_ts_present;      /**< Whether the whole TS was transmitted */
+	uint32_t rtp_ts_scaled;   /**< The LSB bits of the scaled TS */
+	size_t rtp_ts_scaled_nr;  /**< The number of LSB bits of the scaled TS */
+	uint32_t rtp_ts_stride;   /**< The TS stride (host byte order) */
+	bool rtp_ts_stride_present; /**< Whether the TS stride was transmitted */
+};
+
+
+/** The values decoded from one ROHCv2 packet */
+struct rohc_rfc5225_decoded
+{
+	/** The values of the IP headers, from the outermost to the innermost */
+	struct rohc_rfc5225_ip_values ip[ROHC_RFC5225_MAX_IP_HDRS];
+	/** The number of IP headers */
+	size_t ip_nr;
+	uint8_t reorder_ratio;    /**< The reordering ratio */
+	uint16_t msn;             /**< The Master Sequence Number (MSN) */
+	uint8_t ctrl_crc;         /**< The control CRC-3 of the co_common packet */
+	bool ctrl_crc_present;    /**< Whether the control CRC-3 shall be checked */
+
+	/* values decoded for the UDP header (IP/UDP profile) */
+	uint16_t udp_sport;       /**< The UDP source port (network byte order) */
+	uint16_t udp_dport;       /**< The UDP destination port (network byte order) */
+	uint16_t udp_check;       /**< The UDP checksum (network byte order) */
+
+	/* values decoded for the ESP header (IP/ESP profile) */
+	uint32_t esp_spi;         /**< The ESP SPI (network byte order) */
+	uint32_t esp_sn;          /**< The ESP Sequence Number (host byte order) */
+
+	/* values decoded for the RTP header (IP/UDP/RTP profile) */
+	uint32_t rtp_ssrc;        /**< The RTP SSRC (network byte order) */
+	uint8_t rtp_pt;           /**< The RTP Payload Type */
+	uint8_t rtp_p;            /**< The RTP Padding bit */
+	uint8_t rtp_x;            /**< The RTP Extension bit */
+	uint8_t rtp_m;            /**< The RTP Marker bit */
+	uint32_t rtp_ts;          /**< The RTP Timestamp (host byte order) */
+	uint32_t rtp_ts_stride;   /**< The TS stride (host byte order) */
+};
+
+
+/**
+ * @brief The generic decompression context of the RFC5225-based profiles
+ *
+ * The context handles the IP headers. The header that follows the IP
+ * headers, if any, is managed by the profile-specific part through the
+ * handlers of the context.
+ */
+struct rohc_decomp_rfc5225_ctxt
+{
+	/** The values of the IP headers, from the outermost to the innermost */
+	struct rohc_rfc5225_ip_values ip[ROHC_RFC5225_MAX_IP_HDRS];
+	/** The number of IP headers */
+	size_t ip_nr;
+	/** The reordering ratio announced by the compressor */
+	uint8_t reorder_ratio;
+	/** The LSB decoding context of the MSN */
+	struct rohc_lsb_ref16 msn_lsb_ctxt;
+	/** The LSB decoding context of the innermost IP-ID offset */
+	struct rohc_lsb_ref16 ip_id_offset_lsb_ctxt;
+
+	/** The length of the header that follows the IP headers, 0 if the IP
+	 *  headers are directly followed by the payload */
+	size_t next_header_len;
+
+	/** The handler used to parse the static part of the next header */
+	int (*parse_static_next_hdr)(const struct rohc_decomp_ctxt *const context,
+	                             const uint8_t *const rohc_data,
+	                             const size_t rohc_len,
+	                             struct rohc_rfc5225_extr_bits *const bits)
+		__attribute__((warn_unused_result, nonnull(1, 2, 4)));
+
+	/** @brief The handler used to parse the dynamic part of the next header,
+	 *         along with the MSN and the reordering ratio */
+	int (*parse_dyn_next_hdr)(const struct rohc_decomp_ctxt *const context,
+	                          const uint8_t *const rohc_data,
+	                          const size_t rohc_len,
+	                          struct rohc_rfc5225_extr_bits *const bits)
+		__attribute__((warn_unused_result, nonnull(1, 2, 4)));
+
+	/** @brief The handler used to parse the base header of the CO packets,
+	 *         the packets of the IP-only profile by default */
+	int (*parse_co_base)(const struct rohc_decomp_ctxt *const context,
+	                     const uint8_t *const hdr,
+	                     const size_t hdr_len,
+	                     const rohc_packet_t packet_type,
+	                     struct rohc_decomp_crc *const extr_crc,
+	                     struct rohc_rfc5225_extr_bits *const bits,
+	                     bool *const outer_ip_indicator)
+		__attribute__((warn_unused_result, nonnull(1, 2, 5, 6, 7)));
+
+	/** The handler used to parse the irregular part of the next header */
+	int (*parse_irreg_next_hdr)(const struct rohc_decomp_ctxt *const context,
+	                            const uint8_t *const rohc_data,
+	                            const size_t rohc_len,
+	                            struct rohc_rfc5225_extr_bits *const bits)
+		__attribute__((warn_unused_result, nonnull(1, 2, 4)));
+
+	/** The handler used to decode the fields of the next header */
+	bool (*decode_next_hdr)(const struct rohc_decomp_ctxt *const context,
+	                        const struct rohc_rfc5225_extr_bits *const bits,
+	                        struct rohc_rfc5225_decoded *const decoded)
+		__attribute__((warn_unused_result, nonnull(1, 2, 3)));
+
+	/** The handler used to build the uncompressed next header */
+	void (*build_next_hdr)(const struct rohc_decomp_ctxt *const context,
+	                       const struct rohc_rfc5225_decoded *const decoded,
+	                       const size_t payload_len,
+	                       uint8_t *const dest)
+		__attribute__((nonnull(1, 2, 4)));
+
+	/** The handler used to update the context with the next header */
+	void (*update_next_hdr)(struct rohc_decomp_ctxt *const context,
+	                        const struct rohc_rfc5225_decoded *const decoded)
+		__attribute__((nonnull(1, 2)));
+
+	/** Profile-specific data */
+	void *specific;
+};
+
+
+/**
+ * @brief The length of the memory block of one RFC5225-based context
+ *
+ * The block holds the persistent part and the profile-specific part of the
+ * context. The volatile part lives in the scratch memory of the
+ * decompressor.
+ *
+ * @param specific_size  The size of the profile-specific part
+ */
+#define ROHC_DECOMP_RFC5225_BLOCK_LEN(specific_size) \
+	(ROHC_CTXT_ARENA_SIZE(sizeof(struct rohc_decomp_rfc5225_ctxt)) + \
+	 ROHC_CTXT_ARENA_SIZE(specific_size))
+
+
+/*
+ * Public function prototypes.
+ */
+
+bool rohc_decomp_rfc5225_create(const struct rohc_decomp_ctxt *const context,
+                                struct rohc_decomp_rfc5225_ctxt **const persist_ctxt,
+                                struct rohc_decomp_volat_ctxt *const volat_ctxt,
+                                const size_t specific_size)
+	__attribute__((warn_unused_result, nonnull(1, 2, 3)));
+
+void rohc_decomp_rfc5225_destroy(const struct rohc_decomp_ctxt *const context,
+                                 struct rohc_decomp_rfc5225_ctxt *const rfc5225_ctxt,
+                                 const struct rohc_decomp_volat_ctxt *const volat_ctxt)
+	__attribute__((nonnull(1, 2, 3)));
+
+rohc_packet_t rohc_decomp_rfc5225_detect_pkt_type(const struct rohc_decomp_ctxt *const context,
+                                                  const uint8_t *const rohc_packet,
+                                                  const size_t rohc_length,
+                                                  const size_t large_cid_len)
+	__attribute__((warn_unused_result, nonnull(1, 2)));
+
+bool rohc_decomp_rfc5225_parse_pkt(const struct rohc_decomp_ctxt *const context,
+                                   const struct rohc_buf rohc_packet,
+                                   const size_t large_cid_len,
+                                   rohc_packet_t *const packet_type,
+                                   struct rohc_decomp_crc *const extr_crc,
+                                   struct rohc_rfc5225_extr_bits *const bits,
+                                   size_t *const rohc_hdr_len)
+	__attribute__((warn_unused_result, nonnull(1, 4, 5, 6, 7)));
+
+int rohc_decomp_rfc5225_parse_co_common(const struct rohc_decomp_ctxt *const context,
+                                        const uint8_t *const rohc_data,
+                                        const size_t rohc_len,
+                                        struct rohc_decomp_crc *const extr_crc,
+                                        struct rohc_rfc5225_extr_bits *const bits,
+                                        bool *const outer_ip_indicator)
+	__attribute__((warn_unused_result, nonnull(1, 2, 4, 5, 6)));
+
+bool rohc_decomp_rfc5225_decode_bits(const struct rohc_decomp_ctxt *const context,
+                                     const struct rohc_rfc5225_extr_bits *const bits,
+                                     const size_t payload_len,
+                                     struct rohc_rfc5225_decoded *const decoded)
+	__attribute__((warn_unused_result, nonnull(1, 2, 4)));
+
+rohc_status_t rohc_decomp_rfc5225_build_hdrs(const struct rohc_decomp *const decomp,
+                                             const struct rohc_decomp_ctxt *const context,
+                                             const rohc_packet_t packet_type,
+                                             const struct rohc_decomp_crc *const extr_crc,
+                                             const struct rohc_rfc5225_decoded *const decoded,
+                                             const size_t payload_len,
+                                             struct rohc_buf *const uncomp_hdrs,
+                                             size_t *const uncomp_hdrs_len)
+	__attribute__((warn_unused_result, nonnull(1, 2, 4, 5, 7, 8)));
+
+void rohc_decomp_rfc5225_update_ctxt(struct rohc_decomp_ctxt *const context,
+                                     const struct rohc_rfc5225_decoded *const decoded,
+                                     const size_t payload_len,
+                                     bool *const do_change_mode)
+	__attribute__((nonnull(1, 2, 4)));
+
+bool rohc_decomp_rfc5225_attempt_repair(const struct rohc_decomp *const decomp,
+                                        const struct rohc_decomp_ctxt *const context,
+                                        const struct rohc_ts pkt_arrival_time,
+                                        struct rohc_decomp_crc_corr_ctxt *const crc_corr,
+                                        struct rohc_rfc5225_extr_bits *const bits)
+	__attribute__((warn_unused_result, nonnull(1, 2, 4, 5)));
+
+bool rohc_decomp_rfc5225_attempt_late(const struct rohc_decomp *const decomp,
+                                      const struct rohc_decomp_ctxt *const context,
+                                      struct rohc_rfc5225_extr_bits *const bits)
+	__attribute__((warn_unused_result, nonnull(1, 2, 3), const));
+
+uint32_t rohc_decomp_rfc5225_get_msn(const struct rohc_decomp_ctxt *const context)
+	__attribute__((warn_unused_result, nonnull(1), pure));
+
+#endif
+
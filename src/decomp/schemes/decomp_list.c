@@ -24,6 +24,7 @@
  */
 
 #include "schemes/decomp_list.h"
+#include "rohc_alloc.h"
 
 #include "rohc_bit_ops.h"
 
@@ -41,6 +42,15 @@ static int rohc_list_decode(struct list_decomp *decomp,
 	__attribute__((warn_unused_result, nonnull(1, 2)));
 
 
+static int rohc_list_decode_unchanged(struct list_decomp *const decomp,
+                                      const uint8_t *const packet,
+                                      const size_t packet_len,
+                                      const unsigned int gen_id,
+                                      const int ps,
+                                      const uint8_t m)
+	__attribute__((warn_unused_result, nonnull(1, 2)));
+
+
 /* decode the 4 types of compressed lists */
 
 static int rohc_list_decode_type_0(struct list_decomp *const decomp,
@@ -211,8 +221,16 @@ static int rohc_list_decode(struct list_decomp *decomp,
 	                        ROHC_LIST_GEN_ID_ANON otherwise */
 	int ret;
 
-	/* reset the list of the current packet */
-	rohc_list_reset(&decomp->pkt_list);
+	/* allocate the lists with the first compressed list */
+	if(decomp->lists == NULL)
+	{
+		decomp->lists = rohc_calloc(ROHC_LIST_GEN_ID_MAX + 1, sizeof(struct rohc_list));
+		if(decomp->lists == NULL)
+		{
+			rd_list_warn(decomp, "failed to allocate memory for the lists");
+			goto error;
+		}
+	}
 
 	/* is there enough data in packet for the ET, PS, m/XI1 and gen_id
 	 * fields? */
@@ -223,6 +241,25 @@ static int rohc_list_decode(struct list_decomp *decomp,
 		goto error;
 	}
 
+	/* the list of the packet is often the known list of its gen_id, as is:
+	 * reuse the known list without the generic parsing, and keep the list
+	 * rendered for the previous packet if the list did not change */
+	if(GET_BIT_6_7(packet) == 0 && GET_BIT_5(packet) != 0 &&
+	   decomp->lists[packet[1]].counter > 0)
+	{
+		ret = rohc_list_decode_unchanged(decomp, packet + 2, packet_len - 2,
+		                                 packet[1], GET_REAL(GET_BIT_4(packet)),
+		                                 GET_BIT_0_3(packet));
+		if(ret >= 0)
+		{
+			return 2 + ret;
+		}
+	}
+
+	/* reset the list of the current packet */
+	rohc_list_reset(&decomp->pkt_list);
+	decomp->is_rendered = false;
+
 	/* parse ET, GP, PS, and m/XI1 fields */
 	et = GET_BIT_6_7(packet);
 	gp = !!GET_BIT_5(packet);
@@ -335,6 +372,147 @@ error:
 }
 
 
+/**
+ * @brief Decode a type 0 compressed list that repeats a known list
+ *
+ * The list is decoded only if it references the very same items as the list
+ * already known for its gen_id, without any item transmitted.
+ *
+ * @param decomp      The list decompressor
+ * @param packet      The XI list of the compressed list
+ * @param packet_len  The length (in bytes) of the packet to decompress
+ * @param gen_id      The known gen_id of the list
+ * @param ps          The ps field
+ * @param m           The m field
+ * @return            The length (in bytes) of the XI list if the list is the
+ *                    known one, -1 otherwise
+ */
+static int rohc_list_decode_unchanged(struct list_decomp *const decomp,
+                                      const uint8_t *const packet,
+                                      const size_t packet_len,
+                                      const unsigned int gen_id,
+                                      const int ps,
+                                      const uint8_t m)
+{
+	struct rohc_list *const known_list = &decomp->lists[gen_id];
+	const size_t xi_len = (ps ? m : ((m + 1) / 2));
+	size_t xi_index;
+
+	if(m != known_list->items_nr || packet_len < xi_len)
+	{
+		goto not_same;
+	}
+	for(xi_index = 0; xi_index < m; xi_index++)
+	{
+		bool is_item_present;
+		const uint8_t xi_value =
+			rohc_list_get_xi_type_0(ps, xi_index, packet, &is_item_present);
+
+		if(is_item_present || xi_value >= ROHC_LIST_MAX_ITEM ||
+		   !decomp->trans_table[xi_value].known ||
+		   known_list->items[xi_index] != &decomp->trans_table[xi_value])
+		{
+			goto not_same;
+		}
+	}
+	/* let the generic decoding complain about non-zero padding */
+	if(!ps && (m % 2) != 0 && GET_BIT_0_3(packet + xi_len - 1) != 0)
+	{
+		goto not_same;
+	}
+
+	/* the rendered list is still valid if the list of the previous packet was
+	 * the same */
+	if(decomp->pkt_list.id != gen_id ||
+	   !rohc_list_equal(&decomp->pkt_list, known_list))
+	{
+		decomp->is_rendered = false;
+	}
+	memcpy(decomp->pkt_list.items, known_list->items,
+	       ROHC_LIST_ITEMS_MAX * sizeof(struct rohc_list_item *));
+	decomp->pkt_list.items_nr = known_list->items_nr;
+	decomp->pkt_list.id = gen_id;
+	known_list->counter++;
+	rd_list_debug(decomp, "list with gen_id %u is the known one (received for "
+	              "the #%zu times)", gen_id, known_list->counter);
+
+	return xi_len;
+
+not_same:
+	return -1;
+}
+
+
+/**
+ * @brief Get the length of the uncompressed list of the current packet
+ *
+ * The length of the list rendered for the previous packet is reused if the
+ * list did not change since then.
+ *
+ * @param decomp  The list decompressor
+ * @return        The length (in bytes) of the uncompressed list
+ */
+size_t rohc_list_get_uncomp_len(const struct list_decomp *const decomp)
+{
+	size_t len = 0;
+	size_t i;
+
+	if(decomp->pkt_list.id == ROHC_LIST_GEN_ID_NONE)
+	{
+		return 0;
+	}
+	if(decomp->is_rendered)
+	{
+		return decomp->rendered_len;
+	}
+
+	for(i = 0; i < decomp->pkt_list.items_nr; i++)
+	{
+		len += decomp->pkt_list.items[i]->length;
+	}
+
+	return len;
+}
+
+
+/**
+ * @brief Build the uncompressed list of the current packet
+ *
+ * The list rendered for the previous packet is copied again if the list did
+ * not change since then. Otherwise, the list is rendered again with a new
+ * generation.
+ *
+ * @param decomp      The list decompressor
+ * @param ip_nh_type  The Next Header value of the base IP header
+ * @param dest        The buffer to store the uncompressed list
+ * @return            The length (in bytes) of the uncompressed list
+ */
+size_t rohc_list_build_uncomp(struct list_decomp *const decomp,
+                              const uint8_t ip_nh_type,
+                              uint8_t *const dest)
+{
+	size_t size;
+
+	if(decomp->is_rendered && decomp->rendered_nh_type == ip_nh_type)
+	{
+		memcpy(dest, decomp->rendered, decomp->rendered_len);
+		return decomp->rendered_len;
+	}
+
+	size = decomp->build_uncomp_item(decomp, ip_nh_type, dest);
+	decomp->rendered_gen++;
+	if(size <= ROHC_LIST_RENDERED_MAX)
+	{
+		memcpy(decomp->rendered, dest, size);
+		decomp->rendered_len = size;
+		decomp->rendered_nh_type = ip_nh_type;
+		decomp->is_rendered = true;
+	}
+
+	return size;
+}
+
+
 /**
  * @brief Create a list item from a XI item
  *
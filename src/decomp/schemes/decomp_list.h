@@ -35,6 +35,10 @@
 	rohc_warning(decomp_list, ROHC_TRACE_DECOMP, (decomp_list)->profile_id, \
 	             format, ##__VA_ARGS__)
 
+/** The max length (in bytes) of the rendered list kept in cache */
+#define ROHC_LIST_RENDERED_MAX  256U
+
+
 /** Print a debug trace for the given decompression list */
 #define rd_list_debug(decomp_list, format, ...) \
 	rohc_debug(decomp_list, ROHC_TRACE_DECOMP, (decomp_list)->profile_id, \
@@ -50,15 +54,30 @@
  */
 struct list_decomp
 {
-	/** The translation table */
+	/** The translation table, the data of the items is allocated when the
+	 *  items are first received */
 	struct rohc_list_item trans_table[ROHC_LIST_MAX_ITEM];
 
-	/** All the possible named lists, indexed by gen_id */
-	struct rohc_list lists[ROHC_LIST_GEN_ID_MAX + 1];
+	/** All the possible named lists, indexed by gen_id, allocated with the
+	 *  first compressed list received, NULL before */
+	struct rohc_list *lists;
 
 	/** The temporary packet list (not persistent across packets) */
 	struct rohc_list pkt_list;
 
+	/** The uncompressed bytes last rendered for \e pkt_list, kept as long as
+	 *  the list of the packets does not change */
+	uint8_t rendered[ROHC_LIST_RENDERED_MAX];
+	/** The length (in bytes) of the rendered list */
+	size_t rendered_len;
+	/** The Next Header type the list was rendered with */
+	uint8_t rendered_nh_type;
+	/** Whether \e rendered holds the rendered \e pkt_list or not */
+	bool is_rendered;
+	/** The generation of the rendered list, increased every time the list
+	 *  is rendered again, see \ref rohc_crc_static_cache */
+	size_t rendered_gen;
+
 
 	/* Functions for handling the data to decompress */
 
@@ -90,6 +109,11 @@ struct list_decomp
 	rohc_trace_callback2_t trace_callback;
 	/** The private context of the callback function used to manage traces */
 	void *trace_callback_priv;
+	/** The minimum level of the traces given to the callback function */
+	rohc_trace_level_t trace_level;
+	/** The minimum level of the traces for the current packet, chosen by
+	 *  the trace sampling of the owner, NULL if not sampled */
+	const rohc_trace_level_t *trace_pkt_level;
 	/** The profile ID the decompression list was created for */
 	int profile_id;
 };
@@ -113,5 +137,13 @@ bool rohc_decomp_list_create_item(struct list_decomp *const decomp,
                                   size_t *const item_length)
 	__attribute__((warn_unused_result, nonnull(1, 4, 6)));
 
+size_t rohc_list_get_uncomp_len(const struct list_decomp *const decomp)
+	__attribute__((warn_unused_result, nonnull(1), pure));
+
+size_t rohc_list_build_uncomp(struct list_decomp *const decomp,
+                              const uint8_t ip_nh_type,
+                              uint8_t *const dest)
+	__attribute__((warn_unused_result, nonnull(1, 3)));
+
 #endif
 
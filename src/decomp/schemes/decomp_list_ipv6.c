@@ -24,6 +24,7 @@
  */
 
 #include "schemes/decomp_list_ipv6.h"
+#include "rohc_alloc.h"
 
 #include "rohc_traces_internal.h"
 
@@ -65,14 +66,20 @@ static size_t rohc_build_ip6_extension(const struct list_decomp *const decomp,
  * @param decomp         The context to create
  * @param trace_cb       The function to call for printing traces
  * @param trace_cb_priv  An optional private context, may be NULL
+ * @param trace_level    The minimum level of the traces to print
+ * @param trace_pkt_level The minimum level of the traces for the current
+ *                        packet, NULL if not sampled
  * @param profile_id     The ID of the associated decompression profile
  */
 void rohc_decomp_list_ipv6_new(struct list_decomp *const decomp,
                                rohc_trace_callback2_t trace_cb,
                                void *const trace_cb_priv,
+                               const rohc_trace_level_t trace_level,
+                               const rohc_trace_level_t *const trace_pkt_level,
                                const int profile_id)
 {
 	memset(decomp, 0, sizeof(struct list_decomp));
+	decomp->rendered_gen = 1;
 
 	/* specific callbacks for IPv6 extension headers */
 	decomp->check_item = check_ip6_item;
@@ -84,6 +91,8 @@ void rohc_decomp_list_ipv6_new(struct list_decomp *const decomp,
 	/* traces */
 	decomp->trace_callback = trace_cb;
 	decomp->trace_callback_priv = trace_cb_priv;
+	decomp->trace_level = trace_level;
+	decomp->trace_pkt_level = trace_pkt_level;
 	decomp->profile_id = profile_id;
 }
 
@@ -95,6 +104,16 @@ void rohc_decomp_list_ipv6_new(struct list_decomp *const decomp,
  */
 void rohc_decomp_list_ipv6_free(struct list_decomp *const decomp)
 {
+	size_t i;
+
+	for(i = 0; i < ROHC_LIST_MAX_ITEM; i++)
+	{
+		rohc_list_item_free(&decomp->trans_table[i]);
+	}
+	if(decomp->lists != NULL)
+	{
+		rohc_free(decomp->lists);
+	}
 	memset(decomp, 0, sizeof(struct list_decomp));
 }
 
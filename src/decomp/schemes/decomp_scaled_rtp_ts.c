@@ -39,83 +39,26 @@
 	           format, ##__VA_ARGS__)
 
 
-/*
- * Structure and types
- */
-
-/**
- * @brief The scaled RTP Timestamp decoding context
- *
- * See section 4.5.3 of RFC 3095 for details about Scaled RTP Timestamp
- * decoding.
- */
-struct ts_sc_decomp
-{
-	/// The last computed or received TS_STRIDE value (validated by CRC)
-	uint32_t ts_stride;
-
-	/// The last computed or received TS_SCALED value (validated by CRC)
-	uint32_t ts_scaled;
-	/// The LSB-encoded TS_SCALED value
-	struct rohc_lsb_decode *lsb_ts_scaled;
-
-	/// The last computed or received TS_OFFSET value (validated by CRC)
-	uint32_t ts_offset;
-
-	/** The last timestamp (TS) value */
-	uint32_t ts;
-	/** The LSB-encoded unscaled timestamp (TS) value */
-	struct rohc_lsb_decode *lsb_ts_unscaled;
-	/// The previous timestamp value
-	uint32_t old_ts;
-
-	/// The sequence number (SN)
-	uint16_t sn;
-	/// The previous sequence number
-	uint16_t old_sn;
-
-
-	/* the attributes below are new TS_* values computed by not yet validated
-	   by CRC check */
-
-	/// The last computed or received TS_STRIDE value (not validated by CRC)
-	uint32_t new_ts_stride;
-	/// The last computed or received TS_SCALED value (not validated by CRC)
-	uint32_t new_ts_scaled;
-	/// The last computed or received TS_OFFSET value (not validated by CRC)
-	uint32_t new_ts_offset;
-
-	/** The callback function used to manage traces */
-	rohc_trace_callback2_t trace_callback;
-	/** The private context of the callback function used to manage traces */
-	void *trace_callback_priv;
-};
-
-
-
 /*
  * Public functions
  */
 
 /**
- * @brief Create the scaled RTP Timestamp decoding context
+ * @brief Initialize the scaled RTP Timestamp decoding context
  *
+ * @param ts_sc          The scaled RTP Timestamp decoding context
  * @param trace_cb       The trace callback
  * @param trace_cb_priv  An optional private context for the trace
- * @return               The scaled RTP Timestamp decoding context in case of
- *                       success, NULL otherwise
+ * @param trace_level    The minimum level of the traces to print
+ * @param trace_pkt_level The minimum level of the traces for the current
+ *                        packet, NULL if not sampled
  */
-struct ts_sc_decomp * d_create_sc(rohc_trace_callback2_t trace_cb,
-                                  void *const trace_cb_priv)
+void d_init_sc(struct ts_sc_decomp *const ts_sc,
+               rohc_trace_callback2_t trace_cb,
+               void *const trace_cb_priv,
+               const rohc_trace_level_t trace_level,
+               const rohc_trace_level_t *const trace_pkt_level)
 {
-	struct ts_sc_decomp *ts_sc;
-
-	ts_sc = malloc(sizeof(struct ts_sc_decomp));
-	if(ts_sc == NULL)
-	{
-		goto error;
-	}
-
 	ts_sc->ts_stride = 0;
 	ts_sc->ts_scaled = 0;
 	ts_sc->ts_offset = 0;
@@ -129,42 +72,16 @@ struct ts_sc_decomp * d_create_sc(rohc_trace_callback2_t trace_cb,
 	ts_sc->new_ts_scaled = 0;
 	ts_sc->new_ts_offset = 0;
 
-	ts_sc->lsb_ts_scaled = rohc_lsb_new(32);
-	if(ts_sc->lsb_ts_scaled == NULL)
-	{
-		goto free_context;
-	}
+	ts_sc->is_ts_scaled_exact = false;
+	ts_sc->ts_stride_multiples_nr = 0;
 
-	ts_sc->lsb_ts_unscaled = rohc_lsb_new(32);
-	if(ts_sc->lsb_ts_unscaled == NULL)
-	{
-		goto free_lsb_ts_scaled;
-	}
+	rohc_lsb_ref32_init(&ts_sc->lsb_ts_scaled);
+	rohc_lsb_ref32_init(&ts_sc->lsb_ts_unscaled);
 
 	ts_sc->trace_callback = trace_cb;
 	ts_sc->trace_callback_priv = trace_cb_priv;
-
-	return ts_sc;
-
-free_lsb_ts_scaled:
-	rohc_lsb_free(ts_sc->lsb_ts_scaled);
-free_context:
-	free(ts_sc);
-error:
-	return NULL;
-}
-
-
-/**
- * @brief Destroy the given ts_sc_decomp object
- *
- * @param ts_sc  The ts_sc_decomp object to destroy
- */
-void rohc_ts_scaled_free(struct ts_sc_decomp *const ts_sc)
-{
-	rohc_lsb_free(ts_sc->lsb_ts_unscaled);
-	rohc_lsb_free(ts_sc->lsb_ts_scaled);
-	free(ts_sc);
+	ts_sc->trace_level = trace_level;
+	ts_sc->trace_pkt_level = trace_pkt_level;
 }
 
 
@@ -201,9 +118,25 @@ void ts_update_context(struct ts_sc_decomp *const ts_sc,
 	}
 	if(ts_sc->new_ts_stride != ts_sc->ts_stride)
 	{
+		uint64_t multiple = 0;
+
 		ts_debug(ts_sc, "old TS_STRIDE %u replaced by new TS_STRIDE %u",
 		         ts_sc->ts_stride, ts_sc->new_ts_stride);
 		ts_sc->ts_stride = ts_sc->new_ts_stride;
+
+		/* cache the first multiples of the new TS_STRIDE */
+		ts_sc->ts_stride_multiples_nr = 0;
+		while(ts_sc->ts_stride != 0 &&
+		      ts_sc->ts_stride_multiples_nr < ROHC_TS_STRIDE_MULTIPLES_MAX)
+		{
+			multiple += ts_sc->ts_stride;
+			if(multiple > UINT32_MAX)
+			{
+				break;
+			}
+			ts_sc->ts_stride_multiples[ts_sc->ts_stride_multiples_nr] = multiple;
+			ts_sc->ts_stride_multiples_nr++;
+		}
 	}
 	else
 	{
@@ -226,8 +159,14 @@ void ts_update_context(struct ts_sc_decomp *const ts_sc,
 	ts_sc->new_ts_offset = 0;
 
 	/* update the LSB objects for unscaled TS and TS_SCALED */
-	rohc_lsb_set_ref(ts_sc->lsb_ts_unscaled, ts_sc->ts, false);
-	rohc_lsb_set_ref(ts_sc->lsb_ts_scaled, ts_sc->ts_scaled, false);
+	rohc_lsb_ref32_set(&ts_sc->lsb_ts_unscaled, ts_sc->ts);
+	rohc_lsb_ref32_set(&ts_sc->lsb_ts_scaled, ts_sc->ts_scaled);
+
+	/* may the next TS be decoded without any division? */
+	ts_sc->is_ts_scaled_exact =
+		(ts_sc->ts_stride != 0 && ts_sc->ts_offset < ts_sc->ts_stride &&
+		 ((uint64_t) ts_sc->ts_scaled) * ts_sc->ts_stride + ts_sc->ts_offset ==
+		 ts_sc->ts);
 }
 
 
@@ -266,7 +205,6 @@ bool ts_decode_unscaled_bits(struct ts_sc_decomp *const ts_sc,
 	uint32_t effective_ts_stride;
 	uint32_t new_ts_offset;
 	uint32_t new_ts_scaled;
-	bool lsb_decode_ok;
 
 	assert(ts_sc != NULL);
 	assert(decoded_ts != NULL);
@@ -298,21 +236,45 @@ bool ts_decode_unscaled_bits(struct ts_sc_decomp *const ts_sc,
 	{
 		ts_debug(ts_sc, "decode %zd-bit unscaled TS %u (reference = %u)",
 		         ts_unscaled_bits_nr, ts_unscaled_bits,
-		         rohc_lsb_get_ref(ts_sc->lsb_ts_unscaled, ROHC_LSB_REF_0));
-		lsb_decode_ok = rohc_lsb_decode(ts_sc->lsb_ts_unscaled, ROHC_LSB_REF_0, 0,
-		                                ts_unscaled_bits, ts_unscaled_bits_nr,
-		                                ROHC_LSB_SHIFT_RTP_TS, decoded_ts);
-		if(!lsb_decode_ok)
-		{
-			rohc_error(ts_sc, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
-			           "failed to decode %zd-bit unscaled TS %u",
-			           ts_unscaled_bits_nr, ts_unscaled_bits);
-			goto error;
-		}
+		         rohc_lsb_ref32_get(&ts_sc->lsb_ts_unscaled));
+		*decoded_ts = rohc_lsb_ref32_decode(&ts_sc->lsb_ts_unscaled,
+		                                    ts_unscaled_bits, ts_unscaled_bits_nr,
+		                                    ROHC_LSB_SHIFT_RTP_TS);
 		ts_debug(ts_sc, "unscaled TS decoded = %u / 0x%x with %zd bits",
 		         *decoded_ts, *decoded_ts, ts_unscaled_bits_nr);
 	}
 
+	if(effective_ts_stride != 0 && effective_ts_stride == ts_sc->ts_stride &&
+	   ts_sc->is_ts_scaled_exact && (*decoded_ts) >= ts_sc->ts)
+	{
+		/* steady state: the new TS is likely the context TS plus a small
+		 * multiple of the unchanged TS_STRIDE, TS_OFFSET is then unchanged and
+		 * TS_SCALED increases by the same small number, no division needed */
+		const uint32_t ts_delta = (*decoded_ts) - ts_sc->ts;
+		size_t i;
+
+		if(ts_delta == 0)
+		{
+			ts_sc->new_ts_scaled = ts_sc->ts_scaled;
+			ts_sc->new_ts_stride = effective_ts_stride;
+			ts_sc->new_ts_offset = ts_sc->ts_offset;
+			return true;
+		}
+		for(i = 0; i < ts_sc->ts_stride_multiples_nr; i++)
+		{
+			if(ts_delta == ts_sc->ts_stride_multiples[i])
+			{
+				ts_sc->new_ts_scaled = ts_sc->ts_scaled + i + 1;
+				ts_sc->new_ts_stride = effective_ts_stride;
+				ts_sc->new_ts_offset = ts_sc->ts_offset;
+				ts_debug(ts_sc, "TS_SCALED = %u + %zu = %u (TS_OFFSET = %u "
+				         "unchanged)", ts_sc->ts_scaled, i + 1,
+				         ts_sc->new_ts_scaled, ts_sc->new_ts_offset);
+				return true;
+			}
+		}
+	}
+
 	if(effective_ts_stride != 0)
 	{
 		/* compute the new TS_OFFSET value */
@@ -332,9 +294,6 @@ bool ts_decode_unscaled_bits(struct ts_sc_decomp *const ts_sc,
 	}
 
 	return true;
-
-error:
-	return false;
 }
 
 
@@ -357,7 +316,6 @@ bool ts_decode_scaled_bits(struct ts_sc_decomp *const ts_sc,
 {
 	uint32_t effective_ts_stride;
 	uint32_t ts_scaled_decoded;
-	bool lsb_decode_ok;
 
 	assert(ts_sc != NULL);
 	assert(decoded_ts != NULL);
@@ -386,20 +344,32 @@ bool ts_decode_scaled_bits(struct ts_sc_decomp *const ts_sc,
 		goto error;
 	}
 
+	/* steady state: TS_SCALED increases by one with unchanged TS_STRIDE and
+	 * TS_OFFSET, TS then increases by TS_STRIDE: decode TS_SCALED and TS at
+	 * once, without the interpretation interval nor the multiplication (the
+	 * value ref + 1 always belongs to the interpretation interval of RTP TS
+	 * for 1 to 31 bits) */
+	if(effective_ts_stride == ts_sc->ts_stride && ts_sc->is_ts_scaled_exact &&
+	   ts_scaled_bits_nr > 0 && ts_scaled_bits_nr < 32 &&
+	   ts_scaled_bits == ((ts_sc->ts_scaled + 1) &
+	                      ((1U << ts_scaled_bits_nr) - 1)))
+	{
+		ts_scaled_decoded = ts_sc->ts_scaled + 1;
+		*decoded_ts = ts_sc->ts + effective_ts_stride;
+		ts_debug(ts_sc, "TS_SCALED decoded = %u / 0x%x with %zd bits, TS = %u "
+		         "(TS_STRIDE = %u, TS_OFFSET = %u)", ts_scaled_decoded,
+		         ts_scaled_decoded, ts_scaled_bits_nr, *decoded_ts,
+		         effective_ts_stride, ts_sc->ts_offset);
+		goto store;
+	}
+
 	/* update TS_SCALED in context */
 	ts_debug(ts_sc, "decode %zd-bit TS_SCALED %u (reference = %u)",
 	         ts_scaled_bits_nr, ts_scaled_bits,
-	         rohc_lsb_get_ref(ts_sc->lsb_ts_scaled, ROHC_LSB_REF_0));
-	lsb_decode_ok = rohc_lsb_decode(ts_sc->lsb_ts_scaled, ROHC_LSB_REF_0, 0,
-	                                ts_scaled_bits, ts_scaled_bits_nr,
-	                                ROHC_LSB_SHIFT_RTP_TS, &ts_scaled_decoded);
-	if(!lsb_decode_ok)
-	{
-		rohc_error(ts_sc, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
-		           "failed to decode %zd-bit TS_SCALED %u",
-		           ts_scaled_bits_nr, ts_scaled_bits);
-		goto error;
-	}
+	         rohc_lsb_ref32_get(&ts_sc->lsb_ts_scaled));
+	ts_scaled_decoded = rohc_lsb_ref32_decode(&ts_sc->lsb_ts_scaled,
+	                                          ts_scaled_bits, ts_scaled_bits_nr,
+	                                          ROHC_LSB_SHIFT_RTP_TS);
 	ts_debug(ts_sc, "TS_SCALED decoded = %u / 0x%x with %zd bits",
 	         ts_scaled_decoded, ts_scaled_decoded, ts_scaled_bits_nr);
 
@@ -409,6 +379,7 @@ bool ts_decode_scaled_bits(struct ts_sc_decomp *const ts_sc,
 	ts_debug(ts_sc, "TS = %u (TS_STRIDE = %u, TS_OFFSET = %u)", *decoded_ts,
 	         effective_ts_stride, ts_sc->ts_offset);
 
+store:
 	/* store the updated TS_* values in context */
 	ts_sc->new_ts_scaled = ts_scaled_decoded;
 	ts_sc->new_ts_stride = effective_ts_stride;
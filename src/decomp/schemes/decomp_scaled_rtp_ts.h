@@ -30,6 +30,7 @@
 #define ROHC_DECOMP_SCHEMES_SCALED_RTP_TS_H
 
 #include "rohc_traces.h"
+#include "decomp_wlsb.h"
 
 #include <stdlib.h>
 #include <stdint.h>
@@ -40,18 +41,82 @@
 #endif
 
 
-/* The definition of the scaled RTP Timestamp decoding context is private */
-struct ts_sc_decomp;
+/** The number of multiples of TS_STRIDE cached for the steady state */
+#define ROHC_TS_STRIDE_MULTIPLES_MAX  4U
+
+
+/**
+ * @brief The scaled RTP Timestamp decoding context
+ *
+ * See section 4.5.3 of RFC 3095 for details about Scaled RTP Timestamp
+ * decoding. The context is embedded in the decompression contexts.
+ */
+struct ts_sc_decomp
+{
+	/// The last computed or received TS_STRIDE value (validated by CRC)
+	uint32_t ts_stride;
+
+	/// The last computed or received TS_SCALED value (validated by CRC)
+	uint32_t ts_scaled;
+	/// The LSB-encoded TS_SCALED value
+	struct rohc_lsb_ref32 lsb_ts_scaled;
+
+	/// The last computed or received TS_OFFSET value (validated by CRC)
+	uint32_t ts_offset;
+
+	/** The last timestamp (TS) value */
+	uint32_t ts;
+	/** The LSB-encoded unscaled timestamp (TS) value */
+	struct rohc_lsb_ref32 lsb_ts_unscaled;
+	/// The previous timestamp value
+	uint32_t old_ts;
+
+	/// The sequence number (SN)
+	uint16_t sn;
+	/// The previous sequence number
+	uint16_t old_sn;
+
+	/** Whether TS is exactly TS_SCALED * TS_STRIDE + TS_OFFSET (without any
+	 *  wraparound) with TS_OFFSET < TS_STRIDE: the next TS may then be decoded
+	 *  from the cached multiples of TS_STRIDE, without any division */
+	bool is_ts_scaled_exact;
+	/** The multiples 1 to N of TS_STRIDE that do not overflow 32 bits */
+	uint32_t ts_stride_multiples[ROHC_TS_STRIDE_MULTIPLES_MAX];
+	/** The number of cached multiples of TS_STRIDE */
+	size_t ts_stride_multiples_nr;
+
+
+	/* the attributes below are new TS_* values computed by not yet validated
+	   by CRC check */
+
+	/// The last computed or received TS_STRIDE value (not validated by CRC)
+	uint32_t new_ts_stride;
+	/// The last computed or received TS_SCALED value (not validated by CRC)
+	uint32_t new_ts_scaled;
+	/// The last computed or received TS_OFFSET value (not validated by CRC)
+	uint32_t new_ts_offset;
+
+	/** The callback function used to manage traces */
+	rohc_trace_callback2_t trace_callback;
+	/** The private context of the callback function used to manage traces */
+	void *trace_callback_priv;
+	/** The minimum level of the traces given to the callback function */
+	rohc_trace_level_t trace_level;
+	/** The minimum level of the traces for the current packet, chosen by
+	 *  the trace sampling of the owner, NULL if not sampled */
+	const rohc_trace_level_t *trace_pkt_level;
+};
 
 
 /*
  * Function prototypes
  */
 
-struct ts_sc_decomp * d_create_sc(rohc_trace_callback2_t trace_cb,
-                                  void *const trace_cb_priv)
-	__attribute__((warn_unused_result));
-void rohc_ts_scaled_free(struct ts_sc_decomp *const ts_scaled)
+void d_init_sc(struct ts_sc_decomp *const ts_sc,
+               rohc_trace_callback2_t trace_cb,
+               void *const trace_cb_priv,
+               const rohc_trace_level_t trace_level,
+               const rohc_trace_level_t *const trace_pkt_level)
 	__attribute__((nonnull(1)));
 
 void ts_update_context(struct ts_sc_decomp *const ts_sc,
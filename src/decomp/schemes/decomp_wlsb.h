@@ -32,6 +32,7 @@
 #include <stdlib.h>
 #include <stdint.h>
 #include <stddef.h>
+#include <assert.h>
 #ifdef __KERNEL__
 #  include <linux/types.h>
 #else
@@ -39,10 +40,6 @@
 #endif
 
 
-/* The definition of the Least Significant Bits decoding object is private */
-struct rohc_lsb_decode;
-
-
 /** The different reference values for LSB decoding */
 typedef enum
 {
@@ -53,6 +50,21 @@ typedef enum
 } rohc_lsb_ref_t;
 
 
+/**
+ * @brief The Least Significant Bits (LSB) decoding object
+ *
+ * The object is embedded in the decompression contexts. See RFC 3095, §4.5.1
+ */
+struct rohc_lsb_decode
+{
+	bool is_init;         /**< Whether the reference value was initialized */
+	size_t max_len;       /**< The max length (in bits) of the uncomp. field */
+
+	/** The reference values (ref -1 and ref 0) */
+	uint32_t v_ref_d[ROHC_LSB_REF_MAX];
+};
+
+
 /** The context to parse and decode one LSB-encoded 32-bit field */
 struct rohc_lsb_field32
 {
@@ -80,36 +92,426 @@ struct rohc_lsb_field8
 };
 
 
-/*
- * Function prototypes
+/**
+ * @brief The LSB decoding object of one 32-bit field without context repair
+ *
+ * Unlike \ref rohc_lsb_decode, the width of the field is known at build time
+ * and only the 'ref 0' reference value is kept: decoding the field is a few
+ * inline arithmetic operations, without any choice at runtime.
  */
+struct rohc_lsb_ref32
+{
+	uint32_t v_ref_d;     /**< The reference value (ref 0) */
+	bool is_init;         /**< Whether the reference value was initialized */
+};
+
 
-struct rohc_lsb_decode * rohc_lsb_new(const size_t max_len)
-	__attribute__((warn_unused_result));
+/** The LSB decoding object of one 16-bit field without context repair */
+struct rohc_lsb_ref16
+{
+	uint16_t v_ref_d;     /**< The reference value (ref 0) */
+	bool is_init;         /**< Whether the reference value was initialized */
+};
 
-void rohc_lsb_free(struct rohc_lsb_decode *const lsb)
-	__attribute__((nonnull(1)));
 
-bool rohc_lsb_is_ready(const struct rohc_lsb_decode *const lsb)
-	__attribute__((warn_unused_result, nonnull(1), pure));
+/** The LSB decoding object of one 8-bit field without context repair */
+struct rohc_lsb_ref8
+{
+	uint8_t v_ref_d;      /**< The reference value (ref 0) */
+	bool is_init;         /**< Whether the reference value was initialized */
+};
 
-bool rohc_lsb_decode(const struct rohc_lsb_decode *const lsb,
-                     const rohc_lsb_ref_t ref_type,
-                     const uint32_t v_ref_d_offset,
-                     const uint32_t m,
-                     const size_t k,
-                     const rohc_lsb_shift_t p,
-                     uint32_t *const decoded)
-	__attribute__((warn_unused_result, nonnull(1, 7)));
 
-void rohc_lsb_set_ref(struct rohc_lsb_decode *const lsb,
-                      const uint32_t v_ref_d,
-                      const bool keep_ref_minus_1)
-	__attribute__((nonnull(1)));
+/**
+ * @brief Decode a 32-bit LSB-encoded value
+ *
+ * The interpretation interval f(v_ref, k) contains exactly 2^k consecutive
+ * values, so exactly one of them has the k LSB bits m: it is the value at
+ * distance ((m - min) mod 2^k) from the lower bound of the interval. See 4.5.1
+ * in the RFC 3095 for details about LSB encoding.
+ *
+ * @param v_ref  The reference value
+ * @param m      The LSB value to decode
+ * @param k      The length of the LSB value to decode
+ * @param p      The shift value p used to efficiently encode/decode the values
+ * @return       The decoded value
+ */
+static inline uint32_t rohc_lsb_decode32(const uint32_t v_ref,
+                                         const uint32_t m,
+                                         const size_t k,
+                                         const rohc_lsb_shift_t p)
+{
+	const uint32_t mask = (uint32_t) ((UINT64_C(1) << k) - 1);
+	const uint32_t min = v_ref - rohc_interval_compute_p(k, p);
+
+	assert(k <= 32);
+	assert((m & mask) == m);
+
+	return (min + ((m - min) & mask));
+}
+
+
+/**
+ * @brief Decode a 16-bit LSB-encoded value
+ *
+ * See \ref rohc_lsb_decode32 for details.
+ *
+ * @param v_ref  The reference value
+ * @param m      The LSB value to decode
+ * @param k      The length of the LSB value to decode
+ * @param p      The shift value p used to efficiently encode/decode the values
+ * @return       The decoded value
+ */
+static inline uint16_t rohc_lsb_decode16(const uint16_t v_ref,
+                                         const uint16_t m,
+                                         const size_t k,
+                                         const rohc_lsb_shift_t p)
+{
+	const uint16_t mask = (1U << k) - 1;
+	const uint16_t min = v_ref - rohc_interval_compute_p(k, p);
+
+	assert(k <= 16);
+	assert((m & mask) == m);
+
+	return (min + ((m - min) & mask));
+}
+
+
+/**
+ * @brief Decode a 8-bit LSB-encoded value
+ *
+ * See \ref rohc_lsb_decode32 for details.
+ *
+ * @param v_ref  The reference value
+ * @param m      The LSB value to decode
+ * @param k      The length of the LSB value to decode
+ * @param p      The shift value p used to efficiently encode/decode the values
+ * @return       The decoded value
+ */
+static inline uint8_t rohc_lsb_decode8(const uint8_t v_ref,
+                                       const uint8_t m,
+                                       const size_t k,
+                                       const rohc_lsb_shift_t p)
+{
+	const uint8_t mask = (1U << k) - 1;
+	const uint8_t min = v_ref - rohc_interval_compute_p(k, p);
+
+	assert(k <= 8);
+	assert((m & mask) == m);
+
+	return (min + ((m - min) & mask));
+}
+
+
+/**
+ * @brief Initialize a Least Significant Bits (LSB) decoding context
+ *
+ * See 4.5.1 in the RFC 3095 for details about LSB encoding.
+ *
+ * @param lsb      The LSB decoding context to initialize
+ * @param max_len  The max length (in bits) of the non-compressed field
+ */
+static inline void rohc_lsb_init(struct rohc_lsb_decode *const lsb,
+                                 const size_t max_len)
+{
+	assert(max_len == 8 || max_len == 16 || max_len == 32);
+
+	lsb->max_len = max_len;
+	lsb->is_init = false;
+}
+
+
+/**
+ * @brief Is the LSB decoding context ready to decode a compressed value
+ *
+ * @param lsb  The LSB object used to decode
+ * @return     Whether the LSB decoding context is ready to decode a value
+ */
+static inline bool rohc_lsb_is_ready(const struct rohc_lsb_decode *const lsb)
+{
+	return lsb->is_init;
+}
+
+
+/**
+ * @brief Update the LSB reference value
+ *
+ * This function is called after a CRC success to update the last decoded
+ * value (for example, the SN value). See 4.5.1 in the RFC 3095 for details
+ * about LSB encoding.
+ *
+ * @param lsb               The LSB object
+ * @param v_ref_d           The new reference value
+ * @param keep_ref_minus_1  Keep ref -1 unchanged (used for SN context repair
+ *                          after CRC failure, see RFC3095 §5.3.2.2.5)
+ */
+static inline void rohc_lsb_set_ref(struct rohc_lsb_decode *const lsb,
+                                    const uint32_t v_ref_d,
+                                    const bool keep_ref_minus_1)
+{
+	/* replace ref -1 by ref 0 if not doing context repair */
+	if(!keep_ref_minus_1)
+	{
+		lsb->v_ref_d[ROHC_LSB_REF_MINUS_1] = lsb->v_ref_d[ROHC_LSB_REF_0];
+	}
+
+	/* always replace ref 0 by new value */
+	lsb->v_ref_d[ROHC_LSB_REF_0] = v_ref_d;
+
+	lsb->is_init = true;
+}
+
+
+/**
+ * @brief Get the current LSB reference value (ref 0)
+ *
+ * @param lsb       The LSB object
+ * @param ref_type  The reference value to retrieve
+ * @return          The current reference value
+ */
+static inline uint32_t rohc_lsb_get_ref(const struct rohc_lsb_decode *const lsb,
+                                        const rohc_lsb_ref_t ref_type)
+{
+	assert(lsb->is_init == true);
+	assert(ref_type == ROHC_LSB_REF_MINUS_1 || ref_type == ROHC_LSB_REF_0);
+	return lsb->v_ref_d[ref_type];
+}
+
+
+/**
+ * @brief Decode a LSB-encoded value
+ *
+ * See 4.5.1 in the RFC 3095 for details about LSB encoding.
+ *
+ * @param lsb             The LSB object used to decode
+ * @param ref_type        The reference value to use to decode
+ *                        (used for context repair upon CRC failure)
+ * @param v_ref_d_offset  The offset to apply on v_ref_d
+ *                        (used for context repair upon CRC failure)
+ * @param m               The LSB value to decode
+ * @param k               The length of the LSB value to decode
+ * @param p               The shift value p used to efficiently encode/decode
+ *                        the values
+ * @param decoded         OUT: The decoded value
+ * @return                true in case of success, false otherwise
+ */
+static inline bool rohc_lsb_decode(const struct rohc_lsb_decode *const lsb,
+                                   const rohc_lsb_ref_t ref_type,
+                                   const uint32_t v_ref_d_offset,
+                                   const uint32_t m,
+                                   const size_t k,
+                                   const rohc_lsb_shift_t p,
+                                   uint32_t *const decoded)
+{
+	const uint32_t v_ref = lsb->v_ref_d[ref_type] + v_ref_d_offset;
 
-uint32_t rohc_lsb_get_ref(const struct rohc_lsb_decode *const lsb,
-                          const rohc_lsb_ref_t ref_type)
-	__attribute__((nonnull(1), warn_unused_result));
+	assert(lsb->is_init == true);
+	assert(ref_type == ROHC_LSB_REF_MINUS_1 || ref_type == ROHC_LSB_REF_0);
+	assert(k <= lsb->max_len);
+
+	if(lsb->max_len == 8)
+	{
+		*decoded = rohc_lsb_decode8(v_ref, m, k, p);
+	}
+	else if(lsb->max_len == 16)
+	{
+		*decoded = rohc_lsb_decode16(v_ref, m, k, p);
+	}
+	else /* 32-bit value */
+	{
+		assert(lsb->max_len == 32);
+		*decoded = rohc_lsb_decode32(v_ref, m, k, p);
+	}
+
+	/* the interpretation interval always contains one value with the given
+	 * LSB bits */
+	return true;
+}
+
+
+/**
+ * @brief Initialize the LSB decoding object of one 32-bit field
+ *
+ * @param lsb  The LSB decoding object to initialize
+ */
+static inline void rohc_lsb_ref32_init(struct rohc_lsb_ref32 *const lsb)
+{
+	lsb->v_ref_d = 0;
+	lsb->is_init = false;
+}
+
+
+/**
+ * @brief Is the LSB decoding object of one 32-bit field ready to decode
+ *
+ * @param lsb  The LSB decoding object
+ * @return     Whether the reference value was initialized
+ */
+static inline bool rohc_lsb_ref32_is_ready(const struct rohc_lsb_ref32 *const lsb)
+{
+	return lsb->is_init;
+}
+
+
+/**
+ * @brief Update the reference value of one 32-bit field
+ *
+ * @param lsb      The LSB decoding object
+ * @param v_ref_d  The new reference value
+ */
+static inline void rohc_lsb_ref32_set(struct rohc_lsb_ref32 *const lsb,
+                                      const uint32_t v_ref_d)
+{
+	lsb->v_ref_d = v_ref_d;
+	lsb->is_init = true;
+}
+
+
+/**
+ * @brief Get the reference value of one 32-bit field
+ *
+ * @param lsb  The LSB decoding object
+ * @return     The reference value
+ */
+static inline uint32_t rohc_lsb_ref32_get(const struct rohc_lsb_ref32 *const lsb)
+{
+	assert(lsb->is_init);
+	return lsb->v_ref_d;
+}
+
+
+/**
+ * @brief Decode one LSB-encoded 32-bit field against its reference value
+ *
+ * @param lsb  The LSB decoding object
+ * @param m    The LSB value to decode
+ * @param k    The length of the LSB value to decode
+ * @param p    The shift value p used to efficiently encode/decode the values
+ * @return     The decoded value
+ */
+static inline uint32_t rohc_lsb_ref32_decode(const struct rohc_lsb_ref32 *const lsb,
+                                             const uint32_t m,
+                                             const size_t k,
+                                             const rohc_lsb_shift_t p)
+{
+	assert(lsb->is_init);
+	return rohc_lsb_decode32(lsb->v_ref_d, m, k, p);
+}
+
+
+/**
+ * @brief Initialize the LSB decoding object of one 16-bit field
+ *
+ * @param lsb  The LSB decoding object to initialize
+ */
+static inline void rohc_lsb_ref16_init(struct rohc_lsb_ref16 *const lsb)
+{
+	lsb->v_ref_d = 0;
+	lsb->is_init = false;
+}
+
+
+/**
+ * @brief Is the LSB decoding object of one 16-bit field ready to decode
+ *
+ * @param lsb  The LSB decoding object
+ * @return     Whether the reference value was initialized
+ */
+static inline bool rohc_lsb_ref16_is_ready(const struct rohc_lsb_ref16 *const lsb)
+{
+	return lsb->is_init;
+}
+
+
+/**
+ * @brief Update the reference value of one 16-bit field
+ *
+ * @param lsb      The LSB decoding object
+ * @param v_ref_d  The new reference value
+ */
+static inline void rohc_lsb_ref16_set(struct rohc_lsb_ref16 *const lsb,
+                                      const uint16_t v_ref_d)
+{
+	lsb->v_ref_d = v_ref_d;
+	lsb->is_init = true;
+}
+
+
+/**
+ * @brief Get the reference value of one 16-bit field
+ *
+ * @param lsb  The LSB decoding object
+ * @return     The reference value
+ */
+static inline uint16_t rohc_lsb_ref16_get(const struct rohc_lsb_ref16 *const lsb)
+{
+	assert(lsb->is_init);
+	return lsb->v_ref_d;
+}
+
+
+/**
+ * @brief Decode one LSB-encoded 16-bit field against its reference value
+ *
+ * @param lsb  The LSB decoding object
+ * @param m    The LSB value to decode
+ * @param k    The length of the LSB value to decode
+ * @param p    The shift value p used to efficiently encode/decode the values
+ * @return     The decoded value
+ */
+static inline uint16_t rohc_lsb_ref16_decode(const struct rohc_lsb_ref16 *const lsb,
+                                             const uint16_t m,
+                                             const size_t k,
+                                             const rohc_lsb_shift_t p)
+{
+	assert(lsb->is_init);
+	return rohc_lsb_decode16(lsb->v_ref_d, m, k, p);
+}
+
+
+/**
+ * @brief Initialize the LSB decoding object of one 8-bit field
+ *
+ * @param lsb  The LSB decoding object to initialize
+ */
+static inline void rohc_lsb_ref8_init(struct rohc_lsb_ref8 *const lsb)
+{
+	lsb->v_ref_d = 0;
+	lsb->is_init = false;
+}
+
+
+/**
+ * @brief Update the reference value of one 8-bit field
+ *
+ * @param lsb      The LSB decoding object
+ * @param v_ref_d  The new reference value
+ */
+static inline void rohc_lsb_ref8_set(struct rohc_lsb_ref8 *const lsb,
+                                     const uint8_t v_ref_d)
+{
+	lsb->v_ref_d = v_ref_d;
+	lsb->is_init = true;
+}
+
+
+/**
+ * @brief Decode one LSB-encoded 8-bit field against its reference value
+ *
+ * @param lsb  The LSB decoding object
+ * @param m    The LSB value to decode
+ * @param k    The length of the LSB value to decode
+ * @param p    The shift value p used to efficiently encode/decode the values
+ * @return     The decoded value
+ */
+static inline uint8_t rohc_lsb_ref8_decode(const struct rohc_lsb_ref8 *const lsb,
+                                           const uint8_t m,
+                                           const size_t k,
+                                           const rohc_lsb_shift_t p)
+{
+	assert(lsb->is_init);
+	return rohc_lsb_decode8(lsb->v_ref_d, m, k, p);
+}
 
 #endif
 
@@ -235,30 +235,21 @@ unsigned int rsf_index_dec(const unsigned int rsf_index)
  * @todo TODO: could be merged with decomp/schemes/ip_id_offset.[ch] module
  */
 bool d_ip_id_lsb(const struct rohc_decomp_ctxt *const context,
-                 const struct rohc_lsb_decode *const ip_id_lsb_ctxt,
+                 const struct rohc_lsb_ref16 *const ip_id_lsb_ctxt,
                  const uint16_t msn,
                  const uint32_t ip_id_bits,
                  const size_t ip_id_bits_nr,
                  const rohc_lsb_shift_t p,
                  uint16_t *const ip_id)
 {
-	bool decode_ok;
-	uint32_t ip_id_offset32;
 	uint16_t ip_id_offset;
 
 	assert(context != NULL);
 	assert(ip_id_lsb_ctxt != NULL);
 	assert(ip_id != NULL);
 
-	decode_ok = rohc_lsb_decode(ip_id_lsb_ctxt, ROHC_LSB_REF_0, 0,
-	                            ip_id_bits, ip_id_bits_nr, p, &ip_id_offset32);
-	if(!decode_ok)
-	{
-		rohc_decomp_warn(context, "failed to decode %zu innermost IP-ID offset "
-		                 "bits 0x%x with p = %u", ip_id_bits_nr, ip_id_bits, p);
-		goto error;
-	}
-	ip_id_offset = (uint16_t) (ip_id_offset32 & 0xffff);
+	ip_id_offset = rohc_lsb_ref16_decode(ip_id_lsb_ctxt, ip_id_bits,
+	                                     ip_id_bits_nr, p);
 	rohc_decomp_debug(context, "decoded IP-ID offset = 0x%x (%zu bits 0x%x with "
 	                  "p = %d)", ip_id_offset, ip_id_bits_nr, ip_id_bits, p);
 
@@ -267,9 +258,6 @@ bool d_ip_id_lsb(const struct rohc_decomp_ctxt *const context,
 	rohc_decomp_debug(context, "decoded IP-ID = 0x%04x (MSN = 0x%04x)", *ip_id, msn);
 
 	return true;
-
-error:
-	return false;
 }
 
 
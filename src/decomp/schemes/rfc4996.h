@@ -59,7 +59,7 @@ unsigned int rsf_index_dec(const unsigned int rsf_index)
 
 // RFC4996 page 75
 bool d_ip_id_lsb(const struct rohc_decomp_ctxt *const context,
-                 const struct rohc_lsb_decode *const ip_id_lsb_ctxt,
+                 const struct rohc_lsb_ref16 *const ip_id_lsb_ctxt,
                  const uint16_t msn,
                  const uint32_t ip_id_bits,
                  const size_t ip_id_bits_nr,
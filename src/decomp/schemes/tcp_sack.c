@@ -30,12 +30,6 @@
 
 #include "rohc_utils.h"
 
-static int d_tcp_sack_block(const struct rohc_decomp_ctxt *const context,
-                            const uint8_t *const data,
-                            const size_t data_len,
-                            sack_block_t *const sack_block)
-	__attribute__((warn_unused_result, nonnull(1, 2, 4)));
-
 static int d_tcp_sack_pure_lsb(const struct rohc_decomp_ctxt *const context,
                                const uint8_t *const data,
                                const size_t data_len,
@@ -43,6 +37,20 @@ static int d_tcp_sack_pure_lsb(const struct rohc_decomp_ctxt *const context,
 	__attribute__((warn_unused_result, nonnull(1, 2, 4)));
 
 
+/**
+ * The length of the SACK field (discriminator included), indexed by the 3 most
+ * significant bits of its first byte
+ */
+static const uint8_t d_tcp_sack_field_lens[8] = { 2, 2, 2, 2, 3, 3, 4, 5 };
+
+/**
+ * The mask of the SACK field bits in the first byte of the SACK field,
+ * indexed by the length of the field (discriminator included)
+ */
+static const uint8_t d_tcp_sack_first_byte_masks[6] =
+	{ 0x00, 0x00, 0x7f, 0x3f, 0x1f, 0x00 };
+
+
 /**
  * @brief Parse the SACK TCP option
  *
@@ -61,6 +69,7 @@ int d_tcp_sack_parse(const struct rohc_decomp_ctxt *const context,
                      const size_t data_len,
                      struct d_tcp_opt_sack *const opt_sack)
 {
+	uint32_t sack_fields[TCP_SACK_BLOCKS_MAX_NR * 2];
 	const uint8_t *remain_data;
 	size_t remain_data_len;
 	uint8_t discriminator;
@@ -90,22 +99,27 @@ int d_tcp_sack_parse(const struct rohc_decomp_ctxt *const context,
 		goto error;
 	}
 
-	/* parse up to 4 SACK blocks */
-	for(i = 0; i < discriminator; i++)
+	/* parse the 2 SACK fields of up to 4 SACK blocks in one pass */
+	for(i = 0; i < (discriminator * 2); i++)
 	{
-		const int ret = d_tcp_sack_block(context, remain_data, remain_data_len,
-		                                 &(opt_sack->blocks[i]));
+		const int ret = d_tcp_sack_pure_lsb(context, remain_data, remain_data_len,
+		                                    &sack_fields[i]);
 		if(ret < 0)
 		{
 			rohc_decomp_warn(context, "failed to parse block #%d of SACK "
-			                 "option", i + 1);
+			                 "option", i / 2 + 1);
 			goto error;
 		}
 		remain_data += ret;
 		remain_data_len -= ret;
+	}
+	for(i = 0; i < discriminator; i++)
+	{
+		opt_sack->blocks[i].block_start = sack_fields[i * 2];
+		opt_sack->blocks[i].block_end = sack_fields[i * 2 + 1];
 		rohc_decomp_debug(context, "block #%d of SACK option: start bits = 0x%08x, "
-		                  "end bits = 0x%08x", i + 1, opt_sack->blocks[i].block_start,
-		                  opt_sack->blocks[i].block_end);
+		                  "end bits = 0x%08x", i + 1, sack_fields[i * 2],
+		                  sack_fields[i * 2 + 1]);
 	}
 	opt_sack->blocks_nr = discriminator;
 
@@ -116,57 +130,6 @@ error:
 }
 
 
-/**
- * @brief Parse a SACK block of the TCP SACK option
- *
- * See RFC6846 page 68
- * (and RFC2018 for Selective Acknowledgement option)
- *
- * @param context          The decompression context
- * @param data             The data to parse
- * @param data_len         The length of the data to parse
- * @param[out] sack_block  The SACK block bits extracted from ROHC packet
- * @return                 The number of data bytes parsed,
- *                         -1 if data is malformed
- */
-static int d_tcp_sack_block(const struct rohc_decomp_ctxt *const context,
-                            const uint8_t *const data,
-                            const size_t data_len,
-                            sack_block_t *const sack_block)
-{
-	const uint8_t *remain_data = data;
-	size_t remain_len = data_len;
-	int ret;
-
-	/* parse block start */
-	ret = d_tcp_sack_pure_lsb(context, remain_data, remain_len,
-	                          &sack_block->block_start);
-	if(ret < 0)
-	{
-		goto error;
-	}
-	remain_data += ret;
-	remain_len -= ret;
-
-	/* parse block end */
-	ret = d_tcp_sack_pure_lsb(context, remain_data, remain_len,
-	                          &sack_block->block_end);
-	if(ret < 0)
-	{
-		goto error;
-	}
-#ifndef __clang_analyzer__ /* silent warning about dead in/decrement */
-	remain_data += ret;
-#endif
-	remain_len -= ret;
-
-	return (data_len - remain_len);
-
-error:
-	return -1;
-}
-
-
 /**
  * @brief Parse a SACK field of a SACK block of the TCP SACK option
  *
@@ -185,99 +148,48 @@ static int d_tcp_sack_pure_lsb(const struct rohc_decomp_ctxt *const context,
                                const size_t data_len,
                                uint32_t *const sack_field)
 {
-	const uint8_t *remain_data = data;
-	size_t remain_len = data_len;
+	uint8_t field_len;
+	uint8_t i;
 
-	if(remain_len < 2)
+	if(data_len < 2)
 	{
 		rohc_warning(context->decompressor, ROHC_TRACE_DECOMP, ROHC_PROFILE_TCP,
 		             "packet too short for the discriminator of the TCP pure "
 		             "field: only %zu bytes available while at least 2 bytes "
-		             "required", remain_len);
+		             "required", data_len);
 		goto error;
 	}
 
-	if((remain_data[0] & 0x80) == 0)
-	{
-		/* discriminator '0' */
-		rohc_decomp_debug(context, "SACK block is 2-byte long");
-		(*sack_field) = *(remain_data++) & 0x7f;
-		(*sack_field) <<= 8;
-		(*sack_field) |= *(remain_data++);
-		remain_len -= 2;
-	}
-	else if((remain_data[0] & 0x40) == 0)
-	{
-		/* discriminator '10' */
-		rohc_decomp_debug(context, "SACK block is 3-byte long");
-		if(remain_len < 3)
-		{
-			rohc_warning(context->decompressor, ROHC_TRACE_DECOMP, ROHC_PROFILE_TCP,
-			             "packet too short for the discriminator of the TCP pure "
-			             "field: only %zu bytes available while at least 3 bytes "
-			             "required", remain_len);
-			goto error;
-		}
-		(*sack_field) = *(remain_data++) & 0x3f;
-		(*sack_field) <<= 8;
-		(*sack_field) |= *(remain_data++);
-		(*sack_field) <<= 8;
-		(*sack_field) |= *(remain_data++);
-		remain_len -= 3;
-	}
-	else if((remain_data[0] & 0x20) == 0)
+	/* the discriminator gives the length of the field: '0' for 2 bytes, '10'
+	 * for 3 bytes, '110' for 4 bytes, and '11111111' for 5 bytes */
+	field_len = d_tcp_sack_field_lens[data[0] >> 5];
+	if(field_len == 5 && data[0] != 0xff)
 	{
-		/* discriminator '110' */
-		rohc_decomp_debug(context, "SACK block is 4-byte long");
-		if(remain_len < 4)
-		{
-			rohc_warning(context->decompressor, ROHC_TRACE_DECOMP, ROHC_PROFILE_TCP,
-			             "packet too short for the discriminator of the TCP pure "
-			             "field: only %zu bytes available while at least 4 bytes "
-			             "required", remain_len);
-			goto error;
-		}
-		(*sack_field) = *(remain_data++) & 0x1f;
-		(*sack_field) <<= 8;
-		(*sack_field) |= *(remain_data++);
-		(*sack_field) <<= 8;
-		(*sack_field) |= *(remain_data++);
-		(*sack_field) <<= 8;
-		(*sack_field) |= *(remain_data++);
-		remain_len -= 4;
+		rohc_decomp_warn(context, "malformed SACK block: unexpected "
+		                 "discriminator 0x%02x", data[0]);
+		goto error;
 	}
-	else if(remain_data[0] == 0xff)
+	rohc_decomp_debug(context, "SACK block is %u-byte long", field_len);
+	if(data_len < field_len)
 	{
-		/* discriminator '11111111' */
-		rohc_decomp_debug(context, "SACK block is 5-byte long");
-		if(remain_len < 5)
-		{
-			rohc_warning(context->decompressor, ROHC_TRACE_DECOMP, ROHC_PROFILE_TCP,
-			             "packet too short for the discriminator of the TCP pure "
-			             "field: only %zu bytes available while at least 5 bytes "
-			             "required", remain_len);
-			goto error;
-		}
-		remain_data++; /* skip discriminator */
-		(*sack_field) = *(remain_data++);
-		(*sack_field) <<= 8;
-		(*sack_field) |= *(remain_data++);
-		(*sack_field) <<= 8;
-		(*sack_field) |= *(remain_data++);
-		(*sack_field) <<= 8;
-		(*sack_field) |= *(remain_data++);
-		remain_len -= 5;
+		rohc_warning(context->decompressor, ROHC_TRACE_DECOMP, ROHC_PROFILE_TCP,
+		             "packet too short for the discriminator of the TCP pure "
+		             "field: only %zu bytes available while at least %u bytes "
+		             "required", data_len, field_len);
+		goto error;
 	}
-	else
+
+	/* the 5-byte encoding transmits the 32 bits of the field after the 1-byte
+	 * discriminator, the other encodings transmit the MSB of the field in the
+	 * bits of the first byte that follow the discriminator */
+	(*sack_field) = data[0] & d_tcp_sack_first_byte_masks[field_len];
+	for(i = 1; i < field_len; i++)
 	{
-		rohc_decomp_warn(context, "malformed SACK block: unexpected "
-		                 "discriminator 0x%02x", remain_data[0]);
-		goto error;
+		(*sack_field) = ((*sack_field) << 8) | data[i];
 	}
 
-	return (data_len - remain_len);
+	return field_len;
 
 error:
 	return -1;
 }
-
@@ -36,48 +36,25 @@
 #include "config.h" /* for HAVE_CMOCKA_RUN(_GROUP)?_TESTS */
 
 
-/** Stub for \ref rohc_f_32bits */
-struct rohc_interval32 __wrap_rohc_f_32bits(const uint32_t v_ref,
-                                            const size_t k,
-                                            const rohc_lsb_shift_t p)
+/** Test \ref test_lsb_init */
+static void test_lsb_init(void **state)
 {
-	struct rohc_interval32 interval;
-
-	check_expected(v_ref);
-	check_expected(k);
-	check_expected(p);
-
-	interval.min = mock_type(uint32_t);
-	interval.max = mock_type(uint32_t);
-
-	return interval;
-}
-
-
-/** Test \ref test_lsb_new */
-static void test_lsb_new(void **state)
-{
-	struct rohc_lsb_decode *lsb;
+	struct rohc_lsb_decode lsb;
 
 	/* 32-bit LSB */
-	lsb = rohc_lsb_new(32);
-	assert_true(lsb != NULL);
-	rohc_lsb_free(lsb);
+	rohc_lsb_init(&lsb, 32);
+	assert_true(lsb.max_len == 32);
+	assert_false(rohc_lsb_is_ready(&lsb));
 
 	/* 16-bit LSB */
-	lsb = rohc_lsb_new(16);
-	assert_true(lsb != NULL);
-	rohc_lsb_free(lsb);
+	rohc_lsb_init(&lsb, 16);
+	assert_true(lsb.max_len == 16);
+	assert_false(rohc_lsb_is_ready(&lsb));
 
 	/* 8-bit LSB */
-	lsb = rohc_lsb_new(8);
-	assert_true(lsb != NULL);
-	rohc_lsb_free(lsb);
-
-#if 0 /* TODO: enable this when all assert() of the library are replaced */
-	lsb = rohc_lsb_new(0);
-	assert_true(lsb == NULL);
-#endif
+	rohc_lsb_init(&lsb, 8);
+	assert_true(lsb.max_len == 8);
+	assert_false(rohc_lsb_is_ready(&lsb));
 }
 
 
@@ -87,79 +64,101 @@ static void test_lsb_decode(void **state)
 	const struct
 	{
 		bool used;
-		uint32_t min;
-		uint32_t max;
+		size_t max_len;
+		uint32_t v_ref;
+		rohc_lsb_shift_t p;
 		uint32_t m;
 		size_t k;
-		bool exp_status;
 		uint32_t exp_value;
 	} tests[] = {
-		/* used          min          max            m   k   exp_status    exp_value */
-		/* full interval + limits of the interval */
-		{  true,         0x0,  0xffffffff,         0x0,  5,        true,         0x0 },
-		{  true,         0x0,  0xffffffff,  0xffffffff, 32,        true,  0xffffffff },
-		/* full interval + small/medium/large values */
-		{  true,         0x0,  0xffffffff,         0x2,  5,        true,         0x2 },
-		{  true,         0x0,  0xffffffff,  0x7fffffff, 31,        true,  0x7fffffff },
-		{  true,         0x0,  0xffffffff,  0xfffffffd, 32,        true,  0xfffffffd },
-		/* zero interval */
-		{  true,      0x4242,      0x4242,         0x0,  0,        true,      0x4242 },
-		{  true,      0x4242,      0x4242,         0x0,  1,        true,      0x4242 },
-		{  true,      0x4242,      0x4242,  0x00004242, 32,        true,      0x4242 },
-		{  true,      0x4242,      0x4242,         0x1,  1,       false,         0x0 },
+		/* used len       v_ref                         p            m   k    exp_value */
+		/* interval starting at 0 + limits of the interval */
+		{  true, 32,        0x0,        ROHC_LSB_SHIFT_IP_ID,         0x0,  5,         0x0 },
+		{  true, 32,        0x0,        ROHC_LSB_SHIFT_IP_ID,  0xffffffff, 32,  0xffffffff },
+		/* interval starting at 0 + small/medium/large values */
+		{  true, 32,        0x0,        ROHC_LSB_SHIFT_IP_ID,         0x2,  5,         0x2 },
+		{  true, 32,        0x0,        ROHC_LSB_SHIFT_IP_ID,  0x7fffffff, 31,  0x7fffffff },
+		{  true, 32,        0x0,        ROHC_LSB_SHIFT_IP_ID,  0xfffffffd, 32,  0xfffffffd },
+		/* zero-bit interval */
+		{  true, 32,     0x4242,        ROHC_LSB_SHIFT_IP_ID,         0x0,  0,      0x4242 },
 		/* small interval (no wraparound) */
-		{  true,      0x4242,      0x42ff,         0x0,  0,        true,      0x4242 },
-		{  true,      0x4242,      0x42ff,         0x0,  1,        true,      0x4242 },
-		{  true,      0x4242,      0x42ff,         0x1,  1,        true,      0x4243 },
-		{  true,      0x4242,      0x42ff,         0xf,  4,        true,      0x424f },
-		{  true,      0x4242,      0x42ff,        0xff,  8,        true,      0x42ff },
-		{  true,      0x4242,      0x4341,        0x41,  8,        true,      0x4341 },
-		{  true,      0x4242,      0x42ff,        0x41,  8,       false,         0x0 },
+		{  true, 32,     0x4242,        ROHC_LSB_SHIFT_IP_ID,         0x0,  1,      0x4242 },
+		{  true, 32,     0x4242,        ROHC_LSB_SHIFT_IP_ID,         0x1,  1,      0x4243 },
+		{  true, 32,     0x4242,        ROHC_LSB_SHIFT_IP_ID,         0xf,  4,      0x424f },
+		{  true, 32,     0x4242,        ROHC_LSB_SHIFT_IP_ID,        0x41,  8,      0x4341 },
+		{  true, 32,     0x1000,       ROHC_LSB_SHIFT_RTP_TS,         0x0,  8,      0x1000 },
+		{  true, 32,     0x1000,       ROHC_LSB_SHIFT_RTP_TS,        0xc0,  8,      0x10c0 },
+		{  true, 32,     0x1000,       ROHC_LSB_SHIFT_RTP_TS,        0xc1,  8,       0xfc1 },
 		/* small interval (wraparound) */
-		{  true,  0xfffffffd,        0xff,         0x0,  0,        true,  0xfffffffd },
-		{  true,  0xfffffffd,        0xff,         0x1,  1,        true,  0xfffffffd },
-		{  true,  0xfffffffd,        0xff,         0x0,  1,        true,  0xfffffffe },
-		{  true,  0xfffffffd,        0xff,         0xf,  4,        true,  0xffffffff },
-		{  true,  0xfffffffd,        0xff,        0xff,  8,        true,  0xffffffff },
-		{  true,  0xfffffffd,        0xff,        0x41,  8,        true,        0x41 },
-		{  true,  0xfffffffd,        0x40,        0x41,  8,       false,         0x0 },
+		{  true, 32, 0xfffffffe,          ROHC_LSB_SHIFT_SN,         0x1,  1,  0xffffffff },
+		{  true, 32, 0xfffffffe,          ROHC_LSB_SHIFT_SN,         0x0,  1,         0x0 },
+		{  true, 32, 0xfffffffe,          ROHC_LSB_SHIFT_SN,         0xf,  4,  0xffffffff },
+		{  true, 32, 0xfffffffe,          ROHC_LSB_SHIFT_SN,        0x41,  8,        0x41 },
+		/* 16-bit and 8-bit fields */
+		{  true, 16,     0xfffe,          ROHC_LSB_SHIFT_SN,         0x3,  4,      0x0003 },
+		{  true, 16,     0x4242,      ROHC_LSB_SHIFT_RTP_SN,         0x0,  4,      0x4250 },
+		{  true,  8,       0xf0,     ROHC_LSB_SHIFT_TCP_TTL,         0x2,  4,        0xf2 },
+		{  true,  8,       0x01,     ROHC_LSB_SHIFT_TCP_TTL,         0xe,  4,        0xfe },
 		/* end of tests */
-		{ false,         0x0,         0x0,         0x0,  0,       false,         0x0 },
+		{ false,  0,        0x0,        ROHC_LSB_SHIFT_IP_ID,         0x0,  0,         0x0 },
 	};
-	struct rohc_lsb_decode *lsb;
 	size_t test_num;
 
-	lsb = rohc_lsb_new(32);
-	assert_true(lsb != NULL);
-
-	rohc_lsb_set_ref(lsb, 0, false);
-
 	for(test_num = 0; tests[test_num].used; test_num++)
 	{
+		struct rohc_lsb_decode lsb;
 		uint32_t decoded;
 		bool ret;
 
-		printf("decode %zu-bit m 0x%08x in interval [0x%08x ; 0x%08x] (expected %s)\n",
-		       tests[test_num].k, tests[test_num].m, tests[test_num].min,
-		       tests[test_num].max, tests[test_num].exp_status ? "success" : "failure");
-
-		expect_value(__wrap_rohc_f_32bits, v_ref, 0);
-		expect_value(__wrap_rohc_f_32bits, k, tests[test_num].k);
-		expect_value(__wrap_rohc_f_32bits, p, ROHC_LSB_SHIFT_RTP_TS);
-		will_return(__wrap_rohc_f_32bits, tests[test_num].min);
-		will_return(__wrap_rohc_f_32bits, tests[test_num].max);
-		ret = rohc_lsb_decode(lsb, ROHC_LSB_REF_0, 0, tests[test_num].m,
-		                      tests[test_num].k, ROHC_LSB_SHIFT_RTP_TS,
-		                      &decoded);
-		assert_true(ret == tests[test_num].exp_status);
-		if(ret)
+		printf("decode %zu-bit m 0x%08x with %zu-bit ref 0x%08x and p %d "
+		       "(expected 0x%08x)\n", tests[test_num].k, tests[test_num].m,
+		       tests[test_num].max_len, tests[test_num].v_ref,
+		       tests[test_num].p, tests[test_num].exp_value);
+
+		rohc_lsb_init(&lsb, tests[test_num].max_len);
+		rohc_lsb_set_ref(&lsb, tests[test_num].v_ref, false);
+		ret = rohc_lsb_decode(&lsb, ROHC_LSB_REF_0, 0, tests[test_num].m,
+		                      tests[test_num].k, tests[test_num].p, &decoded);
+		assert_true(ret);
+		assert_true(decoded == tests[test_num].exp_value);
+
+		/* the fixed-width LSB objects decode the same values */
+		if(tests[test_num].max_len == 32)
+		{
+			struct rohc_lsb_ref32 lsb32;
+			rohc_lsb_ref32_init(&lsb32);
+			assert_false(rohc_lsb_ref32_is_ready(&lsb32));
+			rohc_lsb_ref32_set(&lsb32, tests[test_num].v_ref);
+			assert_true(rohc_lsb_ref32_is_ready(&lsb32));
+			assert_true(rohc_lsb_ref32_get(&lsb32) == tests[test_num].v_ref);
+			assert_true(rohc_lsb_ref32_decode(&lsb32, tests[test_num].m,
+			                                  tests[test_num].k, tests[test_num].p) ==
+			            tests[test_num].exp_value);
+		}
+		else if(tests[test_num].max_len == 16)
 		{
-			assert_true(decoded == tests[test_num].exp_value);
+			struct rohc_lsb_ref16 lsb16;
+			rohc_lsb_ref16_init(&lsb16);
+			assert_false(rohc_lsb_ref16_is_ready(&lsb16));
+			rohc_lsb_ref16_set(&lsb16, tests[test_num].v_ref);
+			assert_true(rohc_lsb_ref16_is_ready(&lsb16));
+			assert_true(rohc_lsb_ref16_get(&lsb16) == tests[test_num].v_ref);
+			assert_true(rohc_lsb_ref16_decode(&lsb16, tests[test_num].m,
+			                                  tests[test_num].k, tests[test_num].p) ==
+			            tests[test_num].exp_value);
 		}
+		else
+		{
+			struct rohc_lsb_ref8 lsb8;
+			rohc_lsb_ref8_init(&lsb8);
+			rohc_lsb_ref8_set(&lsb8, tests[test_num].v_ref);
+			assert_true(rohc_lsb_ref8_decode(&lsb8, tests[test_num].m,
+			                                 tests[test_num].k, tests[test_num].p) ==
+			            tests[test_num].exp_value);
+		}
+
 		printf("\n");
 	}
-
-	rohc_lsb_free(lsb);
 }
 
 
@@ -174,13 +173,13 @@ int main(int argc, char *argv[])
 {
 #if defined(HAVE_CMOCKA_RUN_GROUP_TESTS) && HAVE_CMOCKA_RUN_GROUP_TESTS == 1
 	const struct CMUnitTest tests[] = {
-		cmocka_unit_test(test_lsb_new),
+		cmocka_unit_test(test_lsb_init),
 		cmocka_unit_test(test_lsb_decode),
 	};
 	return cmocka_run_group_tests(tests, NULL, NULL);
 #elif defined(HAVE_CMOCKA_RUN_TESTS) && HAVE_CMOCKA_RUN_TESTS == 1
 	const UnitTest tests[] = {
-		unit_test(test_lsb_new),
+		unit_test(test_lsb_init),
 		unit_test(test_lsb_decode),
 	};
 	return run_tests(tests);
@@ -47,6 +47,32 @@
 	} while(0)
 
 
+/** The events of the contexts seen by the test */
+struct test_events
+{
+	size_t nr[ROHC_DECOMP_EVENT_FAILURE + 1];  /**< The number of events */
+	rohc_decomp_event_info_t last;  /**< The description of the last event */
+};
+
+
+/** The allocations done through the allocator of the test */
+struct test_allocs
+{
+	size_t allocs_nr;  /**< The number of allocations */
+	size_t frees_nr;   /**< The number of deallocations */
+};
+
+
+static void event_cb(void *const priv_ctxt,
+                     const rohc_decomp_event_info_t *const info)
+	__attribute__((nonnull(1, 2)));
+
+static void * test_malloc(const size_t size, void *const priv_ctxt)
+	__attribute__((warn_unused_result));
+
+static void test_free(void *const ptr, void *const priv_ctxt);
+
+
 /**
  * @brief Test the robustness of the decompression API
  *
@@ -100,6 +126,46 @@ int main(int argc, char *argv[])
 	CHECK(decomp != NULL);
 	rohc_decomp_free(decomp);
 
+	/* rohc_decomp_new3() */
+	{
+		struct rohc_decomp_attr attr = {
+			.cid_type = ROHC_LARGE_CID,
+			.max_cid = ROHC_LARGE_CID_MAX,
+			.mode = ROHC_O_MODE,
+			.numa_node = ROHC_NUMA_NODE_ANY,
+		};
+		struct rohc_decomp *decomp_numa;
+
+		CHECK(rohc_decomp_new3(NULL) == NULL);
+		decomp = rohc_decomp_new3(&attr);
+		CHECK(decomp != NULL);
+		rohc_decomp_free(decomp);
+		attr.max_cid = ROHC_LARGE_CID_MAX + 1;
+		CHECK(rohc_decomp_new3(&attr) == NULL);
+		attr.max_cid = ROHC_LARGE_CID_MAX;
+		attr.mode = ROHC_R_MODE;
+		CHECK(rohc_decomp_new3(&attr) == NULL);
+		attr.mode = ROHC_O_MODE;
+		attr.numa_node = ROHC_NUMA_NODE_ANY - 1;
+		CHECK(rohc_decomp_new3(&attr) == NULL);
+		attr.numa_node = 1024;
+		CHECK(rohc_decomp_new3(&attr) == NULL);
+
+		/* node 0 exists on every NUMA system, but NUMA may be unsupported */
+		attr.numa_node = 0;
+		decomp_numa = rohc_decomp_new3(&attr);
+		if(decomp_numa != NULL)
+		{
+			CHECK(rohc_decomp_set_mrru(decomp_numa, 500) == true);
+			CHECK(rohc_decomp_set_mrru(decomp_numa, 0) == true);
+			CHECK(rohc_decomp_set_mrru(decomp_numa, 1000) == true);
+			CHECK(rohc_decomp_enable_profile(decomp_numa,
+			                                 ROHC_PROFILE_UDP) == true);
+			CHECK(rohc_decomp_set_dense_contexts(decomp_numa, true) == true);
+			rohc_decomp_free(decomp_numa);
+		}
+	}
+
 	decomp = rohc_decomp_new2(ROHC_LARGE_CID, ROHC_SMALL_CID_MAX, ROHC_O_MODE);
 	CHECK(decomp != NULL);
 
@@ -111,6 +177,30 @@ int main(int argc, char *argv[])
 		CHECK(rohc_decomp_set_traces_cb2(decomp, fct, decomp) == true);
 	}
 
+	/* rohc_decomp_set_trace_level() */
+	CHECK(rohc_decomp_set_trace_level(NULL, ROHC_TRACE_WARNING) == false);
+	CHECK(rohc_decomp_set_trace_level(decomp, ROHC_TRACE_LEVEL_MAX) == false);
+	CHECK(rohc_decomp_set_trace_level(decomp, ROHC_TRACE_ERROR) == true);
+	CHECK(rohc_decomp_set_trace_level(decomp, ROHC_TRACE_DEBUG) == true);
+
+	/* rohc_decomp_set_trace_sampling() */
+	CHECK(rohc_decomp_set_trace_sampling(NULL, 10, false) == false);
+	CHECK(rohc_decomp_set_trace_sampling(decomp, 10, true) == true);
+	CHECK(rohc_decomp_set_trace_sampling(decomp, 0, false) == true);
+
+	/* rohc_decomp_set_trace_cids() */
+	{
+		rohc_cid_t cids[ROHC_TRACE_CIDS_MAX + 1] = { 0 };
+		CHECK(rohc_decomp_set_trace_cids(NULL, cids, 1) == false);
+		CHECK(rohc_decomp_set_trace_cids(decomp, NULL, 1) == false);
+		CHECK(rohc_decomp_set_trace_cids(decomp, cids, ROHC_TRACE_CIDS_MAX + 1) == false);
+		cids[0] = ROHC_SMALL_CID_MAX + 1;
+		CHECK(rohc_decomp_set_trace_cids(decomp, cids, 1) == false);
+		cids[0] = ROHC_SMALL_CID_MAX;
+		CHECK(rohc_decomp_set_trace_cids(decomp, cids, ROHC_TRACE_CIDS_MAX) == true);
+		CHECK(rohc_decomp_set_trace_cids(decomp, NULL, 0) == true);
+	}
+
 	/* rohc_decomp_profile_enabled() */
 	CHECK(rohc_decomp_profile_enabled(NULL, ROHC_PROFILE_IP) == false);
 	CHECK(rohc_decomp_profile_enabled(decomp, ROHC_PROFILE_GENERAL) == false);
@@ -121,6 +211,9 @@ int main(int argc, char *argv[])
 	CHECK(rohc_decomp_profile_enabled(decomp, ROHC_PROFILE_IP) == false);
 	CHECK(rohc_decomp_profile_enabled(decomp, ROHC_PROFILE_TCP) == false);
 	CHECK(rohc_decomp_profile_enabled(decomp, ROHC_PROFILE_UDPLITE) == false);
+	CHECK(rohc_decomp_profile_enabled(decomp, ROHCv2_PROFILE_IP_UDP_RTP) == false);
+	CHECK(rohc_decomp_profile_enabled(decomp, ROHCv2_PROFILE_IP_UDP) == false);
+	CHECK(rohc_decomp_profile_enabled(decomp, ROHCv2_PROFILE_IP_ESP) == false);
 
 	/* rohc_decomp_enable_profile() */
 	CHECK(rohc_decomp_enable_profile(NULL, ROHC_PROFILE_IP) == false);
@@ -138,6 +231,12 @@ int main(int argc, char *argv[])
 	CHECK(rohc_decomp_enable_profiles(decomp, ROHC_PROFILE_IP, -1) == true);
 	CHECK(rohc_decomp_enable_profiles(decomp, ROHC_PROFILE_IP, ROHC_PROFILE_UDP,
 	                                  ROHC_PROFILE_RTP, -1) == true);
+	CHECK(rohc_decomp_enable_profile(decomp, ROHCv2_PROFILE_IP) == false);
+	CHECK(rohc_decomp_profile_enabled(decomp, ROHCv2_PROFILE_IP) == false);
+	CHECK(rohc_decomp_enable_profile(decomp, ROHCv2_PROFILE_IP_UDP) == false);
+	CHECK(rohc_decomp_profile_enabled(decomp, ROHCv2_PROFILE_IP_UDP) == false);
+	CHECK(rohc_decomp_enable_profile(decomp, ROHCv2_PROFILE_IP_UDP_RTP) == false);
+	CHECK(rohc_decomp_profile_enabled(decomp, ROHCv2_PROFILE_IP_UDP_RTP) == false);
 
 	/* rohc_decomp_disable_profiles() */
 	CHECK(rohc_decomp_disable_profiles(NULL, ROHC_PROFILE_IP, -1) == false);
@@ -145,6 +244,12 @@ int main(int argc, char *argv[])
 	CHECK(rohc_decomp_disable_profiles(decomp, ROHC_PROFILE_UDP, -1) == true);
 	CHECK(rohc_decomp_disable_profiles(decomp, ROHC_PROFILE_UDP,
 	                                   ROHC_PROFILE_RTP, -1) == true);
+	CHECK(rohc_decomp_enable_profile(decomp, ROHCv2_PROFILE_IP_UDP) == true);
+	CHECK(rohc_decomp_enable_profile(decomp, ROHC_PROFILE_UDP) == false);
+	CHECK(rohc_decomp_disable_profile(decomp, ROHCv2_PROFILE_IP_UDP) == true);
+	CHECK(rohc_decomp_enable_profile(decomp, ROHCv2_PROFILE_IP_UDP_RTP) == true);
+	CHECK(rohc_decomp_enable_profile(decomp, ROHC_PROFILE_RTP) == false);
+	CHECK(rohc_decomp_disable_profile(decomp, ROHCv2_PROFILE_IP_UDP_RTP) == true);
 
 	/* rohc_decomp_profile_enabled() */
 	CHECK(rohc_decomp_profile_enabled(decomp, ROHC_PROFILE_UNCOMPRESSED) == false);
@@ -159,6 +264,9 @@ int main(int argc, char *argv[])
 	CHECK(rohc_decomp_set_mrru(NULL, 10) == false);
 	CHECK(rohc_decomp_set_mrru(decomp, 65535 + 1) == false);
 	CHECK(rohc_decomp_set_mrru(decomp, 0) == true);
+	CHECK(rohc_decomp_set_mrru(decomp, 500) == true);
+	CHECK(rohc_decomp_set_mrru(decomp, 500) == true);
+	CHECK(rohc_decomp_set_mrru(decomp, 0) == true);
 	CHECK(rohc_decomp_set_mrru(decomp, 65535) == true);
 
 	/* rohc_decomp_get_mrru() */
@@ -170,6 +278,196 @@ int main(int argc, char *argv[])
 		CHECK(mrru == 65535);
 	}
 
+	/* rohc_decomp_set_memory_budget() */
+	CHECK(rohc_decomp_set_memory_budget(NULL, 10) == false);
+	CHECK(rohc_decomp_set_memory_budget(decomp, 1000) == true);
+	CHECK(rohc_decomp_set_memory_budget(decomp, 0) == true);
+	CHECK(rohc_decomp_set_memory_budget(decomp, 0) == true);
+	CHECK(rohc_decomp_set_memory_budget(decomp, 4 * 1024 * 1024) == true);
+
+	/* rohc_decomp_reserve_contexts() */
+	CHECK(rohc_decomp_reserve_contexts(NULL, 1) == false);
+	CHECK(rohc_decomp_reserve_contexts(decomp, ROHC_SMALL_CID_MAX + 2) == false);
+	CHECK(rohc_decomp_reserve_contexts(decomp, 0) == true);
+	CHECK(rohc_decomp_reserve_contexts(decomp, 1) == true);
+	CHECK(rohc_decomp_reserve_contexts(decomp, ROHC_SMALL_CID_MAX + 1) == true);
+	{
+		struct rohc_decomp *const decomp_large =
+			rohc_decomp_new2(ROHC_LARGE_CID, ROHC_LARGE_CID_MAX, ROHC_U_MODE);
+		CHECK(decomp_large != NULL);
+		CHECK(rohc_decomp_reserve_contexts(decomp_large, 100) == true);
+		CHECK(rohc_decomp_reserve_contexts(decomp_large, ROHC_LARGE_CID_MAX + 2) == false);
+		CHECK(rohc_decomp_reserve_contexts(decomp_large, ROHC_LARGE_CID_MAX + 1) == true);
+		rohc_decomp_free(decomp_large);
+	}
+
+	/* rohc_decomp_set_huge_pages() */
+	CHECK(rohc_decomp_set_huge_pages(NULL, true) == false);
+	/* the memory budget already allocated the contexts */
+	CHECK(rohc_decomp_set_huge_pages(decomp, true) == false);
+	{
+		struct rohc_decomp *const decomp_huge =
+			rohc_decomp_new2(ROHC_LARGE_CID, ROHC_LARGE_CID_MAX, ROHC_O_MODE);
+		CHECK(decomp_huge != NULL);
+		CHECK(rohc_decomp_set_huge_pages(decomp_huge, false) == true);
+		CHECK(rohc_decomp_set_huge_pages(decomp_huge, true) == true);
+		CHECK(rohc_decomp_set_huge_pages(decomp_huge, true) == true);
+		CHECK(rohc_decomp_set_huge_pages(decomp_huge, false) == true);
+		CHECK(rohc_decomp_set_huge_pages(decomp_huge, true) == true);
+		CHECK(rohc_decomp_set_dense_contexts(decomp_huge, true) == true);
+		CHECK(rohc_decomp_set_huge_pages(decomp_huge, false) == false);
+		CHECK(rohc_decomp_set_dense_contexts(decomp_huge, false) == true);
+		CHECK(rohc_decomp_set_memory_budget(decomp_huge, 4096 * 1024) == true);
+		CHECK(rohc_decomp_set_huge_pages(decomp_huge, false) == false);
+		rohc_decomp_free(decomp_huge);
+	}
+
+	/* rohc_decomp_set_dense_contexts() */
+	CHECK(rohc_decomp_set_dense_contexts(NULL, true) == false);
+	CHECK(rohc_decomp_set_dense_contexts(decomp, true) == true);
+	CHECK(rohc_decomp_set_dense_contexts(decomp, false) == true);
+	CHECK(rohc_decomp_set_dense_contexts(decomp, false) == true);
+	CHECK(rohc_decomp_set_dense_contexts(decomp, true) == true);
+
+	/* rohc_decomp_prewarm_context() */
+	{
+		const struct rohc_ts ts = { .sec = 0, .nsec = 0 };
+		uint8_t buf[] = { 0xf0, 0x00 };
+		struct rohc_buf rohc_ir = rohc_buf_init_full(buf, sizeof(buf), ts);
+
+		CHECK(rohc_decomp_prewarm_context(NULL, rohc_ir) == false);
+		rohc_ir.len = 0;
+		CHECK(rohc_decomp_prewarm_context(decomp, rohc_ir) == false);
+		rohc_ir.len = sizeof(buf);
+		CHECK(rohc_decomp_prewarm_context(decomp, rohc_ir) == false);
+	}
+
+	/* rohc_decomp_demux() and rohc_decomp_demux_burst() */
+	{
+		const struct rohc_ts ts = { .sec = 0, .nsec = 0 };
+		struct rohc_decomp *const decomp_small =
+			rohc_decomp_new2(ROHC_SMALL_CID, ROHC_SMALL_CID_MAX, ROHC_U_MODE);
+		uint8_t pad_only[] = { 0xe0, 0xe0 };
+		uint8_t fb_only[] = { 0xe0, 0xf1, 0x00 };
+		uint8_t ir[] = { 0xe0, 0xf1, 0x00, 0xe3, 0xfd, 0x04 };
+		uint8_t irdyn[] = { 0xf8, 0x04 };
+		uint8_t co[] = { 0xe5, 0x00 };
+		uint8_t seg[] = { 0xfe, 0x00 };
+		uint8_t large_ir[] = { 0xfd, 0x85, 0x00, 0x04 };
+		struct rohc_buf pkts[] = {
+			rohc_buf_init_full(pad_only, sizeof(pad_only), ts),
+			rohc_buf_init_full(fb_only, sizeof(fb_only), ts),
+			rohc_buf_init_full(ir, sizeof(ir), ts),
+			rohc_buf_init_full(irdyn, sizeof(irdyn), ts),
+			rohc_buf_init_full(co, sizeof(co), ts),
+			rohc_buf_init_full(seg, sizeof(seg), ts),
+		};
+		const struct rohc_buf large_pkt =
+			rohc_buf_init_full(large_ir, sizeof(large_ir), ts);
+		rohc_decomp_demux_t demuxes[6];
+
+		CHECK(decomp_small != NULL);
+		CHECK(rohc_decomp_demux(NULL, pkts[2], &demuxes[0]) == false);
+		CHECK(rohc_decomp_demux(decomp_small, pkts[2], NULL) == false);
+		CHECK(rohc_decomp_demux(decomp_small, pkts[0], &demuxes[0]) == false);
+		CHECK(demuxes[0].pkt_class == ROHC_DECOMP_DEMUX_MALFORMED);
+		CHECK(rohc_decomp_demux(decomp_small, pkts[2], &demuxes[0]) == true);
+		CHECK(demuxes[0].pkt_class == ROHC_DECOMP_DEMUX_IR);
+		CHECK(demuxes[0].cid == 3);
+		CHECK(demuxes[0].padding_len == 1);
+		CHECK(demuxes[0].feedbacks_len == 2);
+		CHECK(demuxes[0].hdr_offset == 3);
+		CHECK(demuxes[0].type_offset == 4);
+		CHECK(demuxes[0].large_cid_len == 0);
+
+		CHECK(rohc_decomp_demux_burst(NULL, pkts, 6, demuxes) == false);
+		CHECK(rohc_decomp_demux_burst(decomp_small, NULL, 6, demuxes) == false);
+		CHECK(rohc_decomp_demux_burst(decomp_small, pkts, 6, NULL) == false);
+		CHECK(rohc_decomp_demux_burst(decomp_small, pkts, 0, demuxes) == true);
+		CHECK(rohc_decomp_demux_burst(decomp_small, pkts, 6, demuxes) == true);
+		CHECK(demuxes[0].pkt_class == ROHC_DECOMP_DEMUX_MALFORMED);
+		CHECK(demuxes[1].pkt_class == ROHC_DECOMP_DEMUX_FEEDBACK);
+		CHECK(demuxes[1].feedbacks_len == 2);
+		CHECK(demuxes[2].pkt_class == ROHC_DECOMP_DEMUX_IR);
+		CHECK(demuxes[3].pkt_class == ROHC_DECOMP_DEMUX_IR_DYN);
+		CHECK(demuxes[3].cid == 0);
+		CHECK(demuxes[4].pkt_class == ROHC_DECOMP_DEMUX_CO);
+		CHECK(demuxes[4].cid == 5);
+		CHECK(demuxes[4].type_offset == 1);
+		CHECK(demuxes[5].pkt_class == ROHC_DECOMP_DEMUX_SEGMENT);
+
+		/* large CIDs */
+		CHECK(rohc_decomp_demux(decomp, large_pkt, &demuxes[0]) == true);
+		CHECK(demuxes[0].pkt_class == ROHC_DECOMP_DEMUX_IR);
+		CHECK(demuxes[0].cid == 0x500);
+		CHECK(demuxes[0].large_cid_len == 2);
+		CHECK(demuxes[0].type_offset == 0);
+		pkts[3].len = 1;
+		CHECK(rohc_decomp_demux(decomp, pkts[3], &demuxes[0]) == false);
+
+		rohc_decomp_free(decomp_small);
+	}
+
+	/* rohc_decomp_parse_feedback_only() */
+	{
+		const struct rohc_ts ts = { .sec = 0, .nsec = 0 };
+		uint8_t pad_only[] = { 0xe0, 0xe0 };
+		uint8_t fb_only[] = { 0xe0, 0xf1, 0x00, 0xf2, 0x20, 0x00 };
+		uint8_t fb_bad[] = { 0xf3, 0x00 };
+		uint8_t fb_ir[] = { 0xf1, 0x00, 0xfd, 0x04 };
+		struct rohc_buf pkts[] = {
+			rohc_buf_init_full(fb_only, sizeof(fb_only), ts),
+			rohc_buf_init_full(pad_only, sizeof(pad_only), ts),
+			rohc_buf_init_full(fb_bad, sizeof(fb_bad), ts),
+			rohc_buf_init_full(fb_ir, sizeof(fb_ir), ts),
+		};
+		struct rohc_buf fb;
+		size_t i;
+
+		CHECK(rohc_decomp_parse_feedback_only(NULL, pkts[0], &fb) == false);
+		CHECK(rohc_decomp_parse_feedback_only(decomp, pkts[0], NULL) == false);
+		CHECK(rohc_decomp_parse_feedback_only(decomp, pkts[0], &fb) == true);
+		CHECK(fb.data == fb_only);
+		CHECK(fb.offset == 1);
+		CHECK(fb.len == 5);
+		CHECK(rohc_buf_byte(fb) == 0xf1);
+
+		for(i = 1; i < 4; i++)
+		{
+			CHECK(rohc_decomp_parse_feedback_only(decomp, pkts[i], &fb) == false);
+			CHECK(fb.len == 0);
+		}
+		pkts[0].len = 0;
+		CHECK(rohc_decomp_parse_feedback_only(decomp, pkts[0], &fb) == false);
+	}
+
+	/* rohc_decomp_set_ctxts_idle_timeout() */
+	CHECK(rohc_decomp_set_ctxts_idle_timeout(NULL, 10) == false);
+	CHECK(rohc_decomp_set_ctxts_idle_timeout(decomp, 0) == true);
+
+	/* rohc_decomp_reclaim_idle_contexts() */
+	{
+		const struct rohc_ts now = { .sec = 100, .nsec = 0 };
+		size_t reclaimed_nr;
+		CHECK(rohc_decomp_reclaim_idle_contexts(NULL, now, &reclaimed_nr) == false);
+		CHECK(rohc_decomp_reclaim_idle_contexts(decomp, now, &reclaimed_nr) == false);
+		CHECK(rohc_decomp_set_ctxts_idle_timeout(decomp, 10) == true);
+		CHECK(rohc_decomp_reclaim_idle_contexts(decomp, now, NULL) == true);
+		CHECK(rohc_decomp_reclaim_idle_contexts(decomp, now, &reclaimed_nr) == true);
+		CHECK(reclaimed_nr == 0);
+		CHECK(rohc_decomp_set_ctxts_idle_timeout(decomp, 0) == true);
+	}
+
+	/* rohc_decomp_maintenance() */
+	{
+		const struct rohc_ts now = { .sec = 100, .nsec = 0 };
+		CHECK(rohc_decomp_maintenance(NULL, now) == false);
+		CHECK(rohc_decomp_maintenance(decomp, now) == true);
+		CHECK(rohc_decomp_set_ctxts_idle_timeout(decomp, 10) == true);
+		CHECK(rohc_decomp_maintenance(decomp, now) == true);
+		CHECK(rohc_decomp_set_ctxts_idle_timeout(decomp, 0) == true);
+	}
+
 	/* rohc_decomp_get_max_cid() */
 	{
 		size_t max_cid;
@@ -232,10 +530,156 @@ int main(int argc, char *argv[])
 		CHECK(n_2 == 102);
 	}
 
+	/* rohc_decomp_set_feedback_coalescing() */
+	CHECK(rohc_decomp_set_feedback_coalescing(NULL, 10) == false);
+	CHECK(rohc_decomp_set_feedback_coalescing(decomp, 0) == true);
+	CHECK(rohc_decomp_set_feedback_coalescing(decomp, 10) == true);
+
+	/* rohc_decomp_get_feedback_coalescing() */
+	{
+		size_t window;
+		CHECK(rohc_decomp_get_feedback_coalescing(NULL, &window) == false);
+		CHECK(rohc_decomp_get_feedback_coalescing(decomp, NULL) == false);
+		CHECK(rohc_decomp_get_feedback_coalescing(decomp, &window) == true);
+		CHECK(window == 10);
+	}
+
+	/* rohc_decomp_flush_feedbacks() */
+	{
+		uint8_t buf[100];
+		struct rohc_buf feedback = rohc_buf_init_empty(buf, 100);
+		CHECK(rohc_decomp_flush_feedbacks(NULL, &feedback) == false);
+		CHECK(rohc_decomp_flush_feedbacks(decomp, NULL) == false);
+		CHECK(rohc_decomp_flush_feedbacks(decomp, &feedback) == true);
+		CHECK(feedback.len == 0);
+	}
+	CHECK(rohc_decomp_set_feedback_coalescing(decomp, 0) == true);
+
+	/* rohc_decomp_set_crc_repair_budget() */
+	CHECK(rohc_decomp_set_crc_repair_budget(NULL, 10, 100) == false);
+	CHECK(rohc_decomp_set_crc_repair_budget(decomp, 0, 0) == true);
+	CHECK(rohc_decomp_set_crc_repair_budget(decomp, 10, 100) == true);
+
+	/* rohc_decomp_get_crc_repair_budget() */
+	{
+		size_t ctxt_budget;
+		size_t global_budget;
+		CHECK(rohc_decomp_get_crc_repair_budget(NULL, &ctxt_budget,
+		                                        &global_budget) == false);
+		CHECK(rohc_decomp_get_crc_repair_budget(decomp, NULL,
+		                                        &global_budget) == false);
+		CHECK(rohc_decomp_get_crc_repair_budget(decomp, &ctxt_budget,
+		                                        NULL) == false);
+		CHECK(rohc_decomp_get_crc_repair_budget(decomp, &ctxt_budget,
+		                                        &global_budget) == true);
+		CHECK(ctxt_budget == 10);
+		CHECK(global_budget == 100);
+	}
+
+	/* rohc_decomp_set_reorder_window() */
+	CHECK(rohc_decomp_set_reorder_window(NULL, 4) == false);
+	CHECK(rohc_decomp_set_reorder_window(decomp, 9) == false);
+	CHECK(rohc_decomp_set_reorder_window(decomp, 0) == true);
+	CHECK(rohc_decomp_set_reorder_window(decomp, 8) == true);
+	CHECK(rohc_decomp_set_reorder_window(decomp, 4) == true);
+
+	/* rohc_decomp_get_reorder_window() */
+	{
+		size_t refs_nr;
+		CHECK(rohc_decomp_get_reorder_window(NULL, &refs_nr) == false);
+		CHECK(rohc_decomp_get_reorder_window(decomp, NULL) == false);
+		CHECK(rohc_decomp_get_reorder_window(decomp, &refs_nr) == true);
+		CHECK(refs_nr == 4);
+	}
+
+	/* rohc_decomp_get_mode_policy() with default values */
+	{
+		rohc_decomp_mode_policy_t policy;
+		size_t k;
+		size_t n;
+		CHECK(rohc_decomp_get_mode_policy(decomp, &policy, &k, &n) == true);
+		CHECK(policy == ROHC_DECOMP_MODE_FIXED);
+		CHECK(k == 1);
+		CHECK(n == 32);
+	}
+
+	/* rohc_decomp_set_mode_policy() */
+	CHECK(rohc_decomp_set_mode_policy(NULL, ROHC_DECOMP_MODE_ADAPTIVE, 1, 32) == false);
+	CHECK(rohc_decomp_set_mode_policy(decomp, ROHC_DECOMP_MODE_ADAPTIVE + 1, 1, 32) == false);
+	CHECK(rohc_decomp_set_mode_policy(decomp, ROHC_DECOMP_MODE_ADAPTIVE, 1, 0) == false);
+	CHECK(rohc_decomp_set_mode_policy(decomp, ROHC_DECOMP_MODE_FIXED, 0, 1) == true);
+	CHECK(rohc_decomp_set_mode_policy(decomp, ROHC_DECOMP_MODE_ADAPTIVE, 3, 100) == true);
+
+	/* rohc_decomp_get_mode_policy() */
+	{
+		rohc_decomp_mode_policy_t policy;
+		size_t k;
+		size_t n;
+		CHECK(rohc_decomp_get_mode_policy(NULL, &policy, &k, &n) == false);
+		CHECK(rohc_decomp_get_mode_policy(decomp, NULL, &k, &n) == false);
+		CHECK(rohc_decomp_get_mode_policy(decomp, &policy, NULL, &n) == false);
+		CHECK(rohc_decomp_get_mode_policy(decomp, &policy, &k, NULL) == false);
+		CHECK(rohc_decomp_get_mode_policy(decomp, &policy, &k, &n) == true);
+		CHECK(policy == ROHC_DECOMP_MODE_ADAPTIVE);
+		CHECK(k == 3);
+		CHECK(n == 100);
+	}
+	CHECK(rohc_decomp_set_mode_policy(decomp, ROHC_DECOMP_MODE_FIXED, 1, 32) == true);
+
 	/* rohc_decomp_set_features */
 	CHECK(rohc_decomp_set_features(decomp, ROHC_DECOMP_FEATURE_COMPAT_1_6_x) == false);
 	CHECK(rohc_decomp_set_features(decomp, ROHC_DECOMP_FEATURE_CRC_REPAIR) == true);
+	CHECK(rohc_decomp_set_features(decomp, ROHC_DECOMP_FEATURE_CRC_REPAIR |
+	                                       ROHC_DECOMP_FEATURE_REALTIME) == true);
 	CHECK(rohc_decomp_set_features(decomp, ROHC_DECOMP_FEATURE_NONE) == true);
+#ifdef ROHC_TIMINGS
+	CHECK(rohc_decomp_set_features(decomp, ROHC_DECOMP_FEATURE_TIMINGS) == true);
+	CHECK(rohc_decomp_set_features(decomp, ROHC_DECOMP_FEATURE_NONE) == true);
+#else
+	CHECK(rohc_decomp_set_features(decomp, ROHC_DECOMP_FEATURE_TIMINGS) == false);
+#endif
+
+	/* rohc_decomp_get_timings() */
+	{
+		rohc_timings_histo_t histo;
+		CHECK(rohc_decomp_get_timings(NULL, ROHC_PACKET_IR, ROHC_DECOMP_PHASE_PARSE,
+		                              &histo) == false);
+		CHECK(rohc_decomp_get_timings(decomp, ROHC_PACKET_MAX, ROHC_DECOMP_PHASE_PARSE,
+		                              &histo) == false);
+		CHECK(rohc_decomp_get_timings(decomp, ROHC_PACKET_IR, ROHC_DECOMP_PHASE_MAX,
+		                              &histo) == false);
+		CHECK(rohc_decomp_get_timings(decomp, ROHC_PACKET_IR, ROHC_DECOMP_PHASE_PARSE,
+		                              NULL) == false);
+#ifdef ROHC_TIMINGS
+		CHECK(rohc_decomp_get_timings(decomp, ROHC_PACKET_IR, ROHC_DECOMP_PHASE_PARSE,
+		                              &histo) == true);
+#else
+		CHECK(rohc_decomp_get_timings(decomp, ROHC_PACKET_IR, ROHC_DECOMP_PHASE_PARSE,
+		                              &histo) == false);
+#endif
+	}
+
+	/* rohc_decomp_get_profile_timings() */
+	{
+		rohc_timings_histo_t histo;
+		CHECK(rohc_decomp_get_profile_timings(NULL, ROHC_PROFILE_RTP,
+		                                      ROHC_DECOMP_PHASE_CRC, &histo) == false);
+		CHECK(rohc_decomp_get_profile_timings(decomp, ROHC_PROFILE_MAX,
+		                                      ROHC_DECOMP_PHASE_CRC, &histo) == false);
+		CHECK(rohc_decomp_get_profile_timings(decomp, ROHC_PROFILE_RTP,
+		                                      ROHC_DECOMP_PHASE_MAX, &histo) == false);
+		CHECK(rohc_decomp_get_profile_timings(decomp, ROHC_PROFILE_RTP,
+		                                      ROHC_DECOMP_PHASE_CRC, NULL) == false);
+#ifdef ROHC_TIMINGS
+		CHECK(rohc_decomp_get_profile_timings(decomp, ROHC_PROFILE_RTP,
+		                                      ROHC_DECOMP_PHASE_FEEDBACK,
+		                                      &histo) == true);
+#else
+		CHECK(rohc_decomp_get_profile_timings(decomp, ROHC_PROFILE_RTP,
+		                                      ROHC_DECOMP_PHASE_FEEDBACK,
+		                                      &histo) == false);
+#endif
+	}
 
 	/* rohc_decompress3() */
 	{
@@ -308,6 +752,123 @@ int main(int argc, char *argv[])
 			CHECK(rohc_decompress3(decomp, pkt, &pkt2, NULL, &pkt_malformed) == ROHC_STATUS_ERROR);
 			CHECK(rohc_decompress3(decomp, pkt, &pkt2, NULL, &pkt_full) == ROHC_STATUS_ERROR);
 		}
+
+		/* rohc_decompress_burst() */
+		{
+			uint8_t buf_full[100];
+			struct rohc_buf pkt_full = rohc_buf_init_full(buf_full, 100, ts);
+			const struct rohc_buf pkts[2] = { pkt1, pkt };
+			uint8_t out_bufs[2][100];
+			struct rohc_buf outs[2] =
+			{
+				rohc_buf_init_empty(out_bufs[0], 100),
+				rohc_buf_init_empty(out_bufs[1], 100),
+			};
+			uint8_t buf_feedback[100];
+			struct rohc_buf feedback = rohc_buf_init_empty(buf_feedback, 100);
+			rohc_status_t statuses[2];
+
+			CHECK(rohc_decompress_burst(NULL, pkts, outs, 2, NULL, NULL, statuses) == 0);
+			CHECK(rohc_decompress_burst(decomp, NULL, outs, 2, NULL, NULL, statuses) == 0);
+			CHECK(rohc_decompress_burst(decomp, pkts, NULL, 2, NULL, NULL, statuses) == 0);
+			CHECK(rohc_decompress_burst(decomp, pkts, outs, 2, NULL, NULL, NULL) == 0);
+			CHECK(rohc_decompress_burst(decomp, pkts, outs, 0, NULL, NULL, statuses) == 0);
+			CHECK(rohc_decompress_burst(decomp, pkts, outs, 2, &pkt_full, NULL, statuses) == 0);
+			CHECK(rohc_decompress_burst(decomp, pkts, outs, 2, NULL, &pkt_full, statuses) == 0);
+			CHECK(rohc_decompress_burst(decomp, pkts, outs, 2, NULL, &feedback, statuses) == 2);
+			CHECK(statuses[0] != ROHC_STATUS_OK);
+			CHECK(outs[0].len == 0);
+			CHECK(statuses[1] == ROHC_STATUS_OK);
+			CHECK(outs[1].len > 0);
+		}
+
+		/* rohc_decompress_gro() */
+		{
+			uint8_t buf_full[100];
+			struct rohc_buf pkt_full = rohc_buf_init_full(buf_full, 100, ts);
+			const struct rohc_buf pkts[2] = { pkt1, pkt };
+			uint8_t out_bufs[2][100];
+			struct rohc_buf outs[2] =
+			{
+				rohc_buf_init_empty(out_bufs[0], 100),
+				rohc_buf_init_empty(out_bufs[1], 100),
+			};
+			rohc_decomp_gro_info_t infos[2];
+			rohc_status_t statuses[2];
+			size_t outs_nr;
+
+			CHECK(rohc_decompress_gro(NULL, pkts, 2, outs, infos, &outs_nr, NULL, NULL, statuses) == false);
+			CHECK(rohc_decompress_gro(decomp, NULL, 2, outs, infos, &outs_nr, NULL, NULL, statuses) == false);
+			CHECK(rohc_decompress_gro(decomp, pkts, 0, outs, infos, &outs_nr, NULL, NULL, statuses) == false);
+			CHECK(rohc_decompress_gro(decomp, pkts, 2, NULL, infos, &outs_nr, NULL, NULL, statuses) == false);
+			CHECK(rohc_decompress_gro(decomp, pkts, 2, outs, infos, NULL, NULL, NULL, statuses) == false);
+			CHECK(rohc_decompress_gro(decomp, pkts, 2, outs, infos, &outs_nr, NULL, NULL, NULL) == false);
+			CHECK(rohc_decompress_gro(decomp, pkts, 2, outs, infos, &outs_nr, &pkt_full, NULL, statuses) == false);
+			CHECK(rohc_decompress_gro(decomp, pkts, 2, outs, infos, &outs_nr, NULL, &pkt_full, statuses) == false);
+			/* the packet that failed is not output */
+			CHECK(rohc_decompress_gro(decomp, pkts, 2, outs, infos, &outs_nr, NULL, NULL, statuses) == true);
+			CHECK(statuses[0] != ROHC_STATUS_OK);
+			CHECK(statuses[1] == ROHC_STATUS_OK);
+			CHECK(outs_nr == 1);
+			CHECK(outs[0].len > 0);
+			CHECK(outs[1].len == 0);
+			CHECK(infos[0].segs_nr == 1);
+		}
+
+		/* rohc_decompress_segments() */
+		{
+			uint8_t seg_bufs[2][10] =
+			{
+				{ 0xfe, 0, 1, 2, 3, 4, 5, 6, 7, 8 },
+				{ 0xff, 9, 10, 11, 12, 13, 14, 15, 16, 17 },
+			};
+			const struct rohc_buf segs[2] =
+			{
+				rohc_buf_init_full(seg_bufs[0], 10, ts),
+				rohc_buf_init_full(seg_bufs[1], 10, ts),
+			};
+			uint8_t out_buf[100];
+			struct rohc_buf out = rohc_buf_init_empty(out_buf, 100);
+
+			CHECK(rohc_decompress_segments(NULL, segs, 2, &out, NULL, NULL) == ROHC_STATUS_ERROR);
+			CHECK(rohc_decompress_segments(decomp, NULL, 2, &out, NULL, NULL) == ROHC_STATUS_ERROR);
+			CHECK(rohc_decompress_segments(decomp, segs, 0, &out, NULL, NULL) == ROHC_STATUS_ERROR);
+			CHECK(rohc_decompress_segments(decomp, segs, 2, NULL, NULL, NULL) == ROHC_STATUS_ERROR);
+			/* the final segment is not the last one */
+			CHECK(rohc_decompress_segments(decomp, segs, 1, &out, NULL, NULL) == ROHC_STATUS_MALFORMED);
+			/* bad CRC */
+			CHECK(rohc_decompress_segments(decomp, segs, 2, &out, NULL, NULL) == ROHC_STATUS_BAD_CRC);
+			CHECK(out.len == 0);
+		}
+
+		/* rohc_decompress_iov() */
+		{
+			const size_t tail_len = 10;
+			struct rohc_buf head = pkt;
+			uint8_t hdrs_buf[100];
+			struct rohc_buf hdrs = rohc_buf_init_empty(hdrs_buf, 100);
+			uint8_t full_buf[100];
+			struct rohc_buf full = rohc_buf_init_empty(full_buf, 100);
+			struct rohc_buf payload;
+
+			CHECK(rohc_decompress3(decomp, pkt, &full, NULL, NULL) == ROHC_STATUS_OK);
+			head.len -= tail_len;
+			CHECK(rohc_decompress_iov(NULL, head, tail_len, &hdrs, &payload, NULL, NULL) == ROHC_STATUS_ERROR);
+			CHECK(rohc_decompress_iov(decomp, head, tail_len, NULL, &payload, NULL, NULL) == ROHC_STATUS_ERROR);
+			CHECK(rohc_decompress_iov(decomp, head, tail_len, &hdrs, NULL, NULL, NULL) == ROHC_STATUS_ERROR);
+			CHECK(rohc_decompress_iov(decomp, pkt1, 0, &hdrs, &payload, NULL, NULL) != ROHC_STATUS_OK);
+			CHECK(payload.len == 0);
+			/* the payload is referenced in the ROHC packet, not copied */
+			CHECK(rohc_decompress_iov(decomp, head, tail_len, &hdrs, &payload, NULL, NULL) == ROHC_STATUS_OK);
+			CHECK(hdrs.len > 0);
+			CHECK((hdrs.len + payload.len + tail_len) == full.len);
+			CHECK(rohc_buf_data(payload) > buf);
+			CHECK((rohc_buf_data(payload) + payload.len) == (buf + head.len));
+			CHECK((payload.offset - head.offset) == (head.len - payload.len));
+			CHECK(memcmp(rohc_buf_data(hdrs), rohc_buf_data(full), hdrs.len) == 0);
+			CHECK(memcmp(rohc_buf_data(payload), rohc_buf_data(full) + hdrs.len,
+			             payload.len) == 0);
+		}
 	}
 
 	/* rohc_decomp_get_last_packet_info() */
@@ -342,6 +903,36 @@ int main(int argc, char *argv[])
 		CHECK(rohc_decomp_get_general_info(decomp, &info) == true);
 		info.version_minor = 1;
 		CHECK(rohc_decomp_get_general_info(decomp, &info) == true);
+		info.version_minor = 2;
+		CHECK(rohc_decomp_get_general_info(decomp, &info) == true);
+		CHECK(info.packets_nr64 == info.packets_nr);
+		CHECK(info.comp_bytes_nr64 == info.comp_bytes_nr);
+		CHECK(info.uncomp_bytes_nr64 == info.uncomp_bytes_nr);
+		info.version_minor = 3;
+		CHECK(rohc_decomp_get_general_info(decomp, &info) == true);
+		CHECK(info.crc_repair_attempts == 0);
+		CHECK(info.crc_repair_skipped == 0);
+		info.version_minor = 4;
+		CHECK(rohc_decomp_get_general_info(decomp, &info) == true);
+		CHECK(info.late_pkts_decoded == 0);
+		info.version_minor = 5;
+		CHECK(rohc_decomp_get_general_info(decomp, &info) == true);
+		CHECK(info.rt_attempts_capped == 0);
+		info.version_minor = 6;
+		CHECK(rohc_decomp_get_general_info(decomp, &info) == false);
+	}
+
+	/* rohc_decomp_get_ctxts_stats() */
+	{
+		rohc_decomp_ctxt_stats_t stats[16];
+		size_t stats_nr;
+		CHECK(rohc_decomp_get_ctxts_stats(NULL, stats, 16, &stats_nr) == false);
+		CHECK(rohc_decomp_get_ctxts_stats(decomp, NULL, 16, &stats_nr) == false);
+		CHECK(rohc_decomp_get_ctxts_stats(decomp, stats, 16, NULL) == false);
+		CHECK(rohc_decomp_get_ctxts_stats(decomp, stats, 0, &stats_nr) == false);
+		CHECK(rohc_decomp_get_ctxts_stats(decomp, stats, 16, &stats_nr) == true);
+		CHECK(stats_nr > 0);
+		CHECK(stats[0].packets_nr > 0);
 	}
 
 	/* rohc_decomp_get_state_descr() */
@@ -354,6 +945,376 @@ int main(int argc, char *argv[])
 	{
 		rohc_trace_callback2_t fct = (rohc_trace_callback2_t) NULL;
 		CHECK(rohc_decomp_set_traces_cb2(decomp, fct, decomp) == false);
+		CHECK(rohc_decomp_set_trace_level(decomp, ROHC_TRACE_WARNING) == false);
+		CHECK(rohc_decomp_set_trace_sampling(decomp, 100, false) == true);
+		CHECK(rohc_decomp_set_trace_sampling(decomp, 0, false) == true);
+	}
+
+	/* rohc_decomp_group_*() */
+	{
+		const struct rohc_ts ts = { .sec = 0, .nsec = 0 };
+		struct rohc_decomp_group *group;
+		uint8_t buf[] =
+		{
+			0xfd, 0x00, 0x04, 0xce,  0x40, 0x01, 0xc0, 0xa8,
+			0x13, 0x01, 0xc0, 0xa8,  0x13, 0x05, 0x00, 0x40,
+			0x00, 0x00, 0xa0, 0x00,  0x00, 0x01, 0x08, 0x00,
+			0xe9, 0xc2, 0x9b, 0x42,  0x00, 0x01, 0x66, 0x15,
+			0xa6, 0x45, 0x77, 0x9b,  0x04, 0x00, 0x08, 0x09,
+			0x0a, 0x0b, 0x0c, 0x0d,  0x0e, 0x0f, 0x10, 0x11,
+			0x12, 0x13, 0x14, 0x15,  0x16, 0x17, 0x18, 0x19,
+			0x1a, 0x1b, 0x1c, 0x1d,  0x1e, 0x1f, 0x20, 0x21,
+			0x22, 0x23, 0x24, 0x25,  0x26, 0x27, 0x28, 0x29,
+			0x2a, 0x2b, 0x2c, 0x2d,  0x2e, 0x2f, 0x30, 0x31,
+			0x32, 0x33, 0x34, 0x35,  0x36, 0x37
+		};
+		struct rohc_buf pkt = rohc_buf_init_full(buf, sizeof(buf), ts);
+		uint8_t bad_buf[] = { 0xfd, 0x01, 0x00 };
+		struct rohc_buf bad_pkt = rohc_buf_init_full(bad_buf, 3, ts);
+		uint8_t out_buf[3][100];
+		struct rohc_buf outs[3] = {
+			rohc_buf_init_empty(out_buf[0], 100),
+			rohc_buf_init_empty(out_buf[1], 100),
+			rohc_buf_init_empty(out_buf[2], 100),
+		};
+		rohc_decomp_general_info_t info;
+		struct rohc_buf *out;
+		rohc_status_t status;
+		size_t shard;
+
+		/* rohc_decomp_group_new() */
+		CHECK(rohc_decomp_group_new(ROHC_LARGE_CID, 15, ROHC_U_MODE, 0, 2,
+		                            ROHC_DECOMP_GROUP_ARRIVAL_ORDER) == NULL);
+		CHECK(rohc_decomp_group_new(ROHC_LARGE_CID, 15, ROHC_U_MODE, 17, 2,
+		                            ROHC_DECOMP_GROUP_ARRIVAL_ORDER) == NULL);
+		CHECK(rohc_decomp_group_new(ROHC_LARGE_CID, 15, ROHC_U_MODE, 2, 3,
+		                            ROHC_DECOMP_GROUP_ARRIVAL_ORDER) == NULL);
+		CHECK(rohc_decomp_group_new(ROHC_LARGE_CID, 15, ROHC_U_MODE, 2, 2,
+		                            ROHC_DECOMP_GROUP_CID_ORDER + 1) == NULL);
+		CHECK(rohc_decomp_group_new(ROHC_SMALL_CID, 16, ROHC_U_MODE, 2, 2,
+		                            ROHC_DECOMP_GROUP_ARRIVAL_ORDER) == NULL);
+		group = rohc_decomp_group_new(ROHC_LARGE_CID, 15, ROHC_U_MODE, 2, 2,
+		                              ROHC_DECOMP_GROUP_ARRIVAL_ORDER);
+		CHECK(group != NULL);
+
+		/* rohc_decomp_group_get_shard() */
+		CHECK(rohc_decomp_group_get_shard(NULL, 0) == NULL);
+		CHECK(rohc_decomp_group_get_shard(group, 2) == NULL);
+		CHECK(rohc_decomp_enable_profile(rohc_decomp_group_get_shard(group, 0),
+		                                 ROHC_PROFILE_IP) == true);
+		CHECK(rohc_decomp_enable_profile(rohc_decomp_group_get_shard(group, 1),
+		                                 ROHC_PROFILE_IP) == true);
+
+		/* rohc_decomp_group_enqueue() */
+		CHECK(rohc_decomp_group_enqueue(NULL, pkt, &outs[0], &shard) == false);
+		CHECK(rohc_decomp_group_enqueue(group, pkt, NULL, &shard) == false);
+		CHECK(rohc_decomp_group_enqueue(group, pkt, &outs[0], NULL) == false);
+		CHECK(rohc_decomp_group_enqueue(group, pkt, &outs[0], &shard) == true);
+		CHECK(shard == 0);
+		CHECK(rohc_decomp_group_enqueue(group, bad_pkt, &outs[1], &shard) == true);
+		CHECK(shard == 1);
+		CHECK(rohc_decomp_group_enqueue(group, pkt, &outs[2], &shard) == true);
+		CHECK(shard == 0);
+		CHECK(rohc_decomp_group_enqueue(group, pkt, &outs[2], &shard) == false);
+		CHECK(shard == 0);
+
+		/* rohc_decomp_group_decompress() and rohc_decomp_group_output():
+		 * the packets are output in the order of arrival */
+		CHECK(rohc_decomp_group_output(NULL, &out, &status) == false);
+		CHECK(rohc_decomp_group_output(group, NULL, &status) == false);
+		CHECK(rohc_decomp_group_output(group, &out, NULL) == false);
+		CHECK(rohc_decomp_group_output(group, &out, &status) == false);
+		CHECK(rohc_decomp_group_decompress(NULL, 1) == false);
+		CHECK(rohc_decomp_group_decompress(group, 2) == false);
+		CHECK(rohc_decomp_group_decompress(group, 1) == true);
+		CHECK(rohc_decomp_group_decompress(group, 1) == false);
+		CHECK(rohc_decomp_group_output(group, &out, &status) == false);
+		CHECK(rohc_decomp_group_decompress(group, 0) == true);
+		CHECK(rohc_decomp_group_output(group, &out, &status) == true);
+		CHECK(out == &outs[0] && status == ROHC_STATUS_OK && outs[0].len > 0);
+		CHECK(rohc_decomp_group_output(group, &out, &status) == true);
+		CHECK(out == &outs[1] && status != ROHC_STATUS_OK);
+		CHECK(rohc_decomp_group_output(group, &out, &status) == false);
+		CHECK(rohc_decomp_group_decompress(group, 0) == true);
+		CHECK(rohc_decomp_group_output(group, &out, &status) == true);
+		CHECK(out == &outs[2] && status == ROHC_STATUS_OK && outs[2].len > 0);
+
+		/* rohc_decomp_group_get_general_info() */
+		info.version_major = 0;
+		info.version_minor = 3;
+		CHECK(rohc_decomp_group_get_general_info(NULL, &info) == false);
+		CHECK(rohc_decomp_group_get_general_info(group, NULL) == false);
+		CHECK(rohc_decomp_group_get_general_info(group, &info) == true);
+		CHECK(info.contexts_nr == 1);
+		CHECK(info.packets_nr64 == 3);
+		info.version_minor = 4;
+		CHECK(rohc_decomp_group_get_general_info(group, &info) == true);
+		CHECK(info.late_pkts_decoded == 0);
+		info.version_minor = 5;
+		CHECK(rohc_decomp_group_get_general_info(group, &info) == true);
+		CHECK(info.rt_attempts_capped == 0);
+		info.version_minor = 6;
+		CHECK(rohc_decomp_group_get_general_info(group, &info) == false);
+
+		/* rohc_decomp_group_free() */
+		rohc_decomp_group_free(NULL);
+		rohc_decomp_group_free(group);
+
+		/* the packets of one CID are output in order, the packets of the other
+		 * CIDs may be output before */
+		group = rohc_decomp_group_new(ROHC_LARGE_CID, 15, ROHC_U_MODE, 2, 2,
+		                              ROHC_DECOMP_GROUP_CID_ORDER);
+		CHECK(group != NULL);
+		outs[0].len = 0;
+		CHECK(rohc_decomp_group_enqueue(group, pkt, &outs[0], &shard) == true);
+		CHECK(rohc_decomp_group_enqueue(group, bad_pkt, &outs[1], &shard) == true);
+		CHECK(rohc_decomp_group_decompress(group, 1) == true);
+		CHECK(rohc_decomp_group_output(group, &out, &status) == true);
+		CHECK(out == &outs[1] && status != ROHC_STATUS_OK);
+		CHECK(rohc_decomp_group_output(group, &out, &status) == false);
+		CHECK(rohc_decomp_group_decompress(group, 0) == true);
+		CHECK(rohc_decomp_group_output(group, &out, &status) == true);
+		CHECK(out == &outs[0]);
+		rohc_decomp_group_free(group);
+	}
+
+	/* rohc_decomp_set_event_cb() */
+	{
+		const struct rohc_ts ts = { .sec = 0, .nsec = 0 };
+		struct rohc_decomp *decomp2;
+		struct test_events events;
+		uint8_t buf[] =
+		{
+			0xfd, 0x00, 0x04, 0xce,  0x40, 0x01, 0xc0, 0xa8,
+			0x13, 0x01, 0xc0, 0xa8,  0x13, 0x05, 0x00, 0x40,
+			0x00, 0x00, 0xa0, 0x00,  0x00, 0x01, 0x08, 0x00,
+			0xe9, 0xc2, 0x9b, 0x42,  0x00, 0x01, 0x66, 0x15,
+			0xa6, 0x45, 0x77, 0x9b,  0x04, 0x00, 0x08, 0x09,
+			0x0a, 0x0b, 0x0c, 0x0d,  0x0e, 0x0f, 0x10, 0x11,
+			0x12, 0x13, 0x14, 0x15,  0x16, 0x17, 0x18, 0x19,
+			0x1a, 0x1b, 0x1c, 0x1d,  0x1e, 0x1f, 0x20, 0x21,
+			0x22, 0x23, 0x24, 0x25,  0x26, 0x27, 0x28, 0x29,
+			0x2a, 0x2b, 0x2c, 0x2d,  0x2e, 0x2f, 0x30, 0x31,
+			0x32, 0x33, 0x34, 0x35,  0x36, 0x37
+		};
+		struct rohc_buf pkt = rohc_buf_init_full(buf, sizeof(buf), ts);
+		uint8_t bad_buf[] = { 0xfd, 0x01, 0x00 };
+		struct rohc_buf bad_pkt = rohc_buf_init_full(bad_buf, 3, ts);
+		uint8_t out_buf[100];
+		struct rohc_buf out = rohc_buf_init_empty(out_buf, 100);
+
+		memset(&events, 0, sizeof(struct test_events));
+		decomp2 = rohc_decomp_new2(ROHC_LARGE_CID, 15, ROHC_U_MODE);
+		CHECK(decomp2 != NULL);
+		CHECK(rohc_decomp_enable_profile(decomp2, ROHC_PROFILE_IP) == true);
+
+		CHECK(rohc_decomp_set_event_cb(NULL, event_cb, &events) == false);
+		CHECK(rohc_decomp_set_event_cb(decomp2, event_cb, &events) == true);
+
+		/* the IR packet creates one context in Full Context state */
+		CHECK(rohc_decompress3(decomp2, pkt, &out, NULL, NULL) == ROHC_STATUS_OK);
+		CHECK(events.nr[ROHC_DECOMP_EVENT_CTXT_CREATE] == 1);
+		CHECK(events.nr[ROHC_DECOMP_EVENT_STATE_CHANGE] == 0);
+		CHECK(events.last.event == ROHC_DECOMP_EVENT_CTXT_CREATE);
+		CHECK(events.last.cid == 0);
+		CHECK(events.last.profile_id == ROHC_PROFILE_IP);
+		CHECK(events.last.new_state == ROHC_DECOMP_STATE_FC);
+
+		/* the same IR packet updates the context without event */
+		rohc_buf_reset(&out);
+		CHECK(rohc_decompress3(decomp2, pkt, &out, NULL, NULL) == ROHC_STATUS_OK);
+		CHECK(events.nr[ROHC_DECOMP_EVENT_CTXT_DESTROY] == 0);
+		CHECK(events.nr[ROHC_DECOMP_EVENT_CTXT_CREATE] == 1);
+		CHECK(events.nr[ROHC_DECOMP_EVENT_STATE_CHANGE] == 0);
+
+		/* the failures are notified */
+		rohc_buf_reset(&out);
+		CHECK(rohc_decompress3(decomp2, bad_pkt, &out, NULL, NULL) != ROHC_STATUS_OK);
+		CHECK(events.nr[ROHC_DECOMP_EVENT_FAILURE] == 1);
+		CHECK(events.last.event == ROHC_DECOMP_EVENT_FAILURE);
+		CHECK(events.last.status != ROHC_STATUS_OK);
+
+		rohc_decomp_free(decomp2);
+	}
+
+	/* rohc_decomp_set_feedback_ring() and rohc_decompress_fb_views() */
+	{
+		const struct rohc_ts ts = { .sec = 0, .nsec = 0 };
+		struct rohc_decomp *decomp2;
+		uint8_t buf[] =
+		{
+			0xf2, 0x20, 0x01,
+			0xfd, 0x00, 0x04, 0xce,  0x40, 0x01, 0xc0, 0xa8,
+			0x13, 0x01, 0xc0, 0xa8,  0x13, 0x05, 0x00, 0x40,
+			0x00, 0x00, 0xa0, 0x00,  0x00, 0x01, 0x08, 0x00,
+			0xe9, 0xc2, 0x9b, 0x42,  0x00, 0x01, 0x66, 0x15,
+			0xa6, 0x45, 0x77, 0x9b,  0x04, 0x00, 0x08, 0x09,
+			0x0a, 0x0b, 0x0c, 0x0d,  0x0e, 0x0f, 0x10, 0x11,
+			0x12, 0x13, 0x14, 0x15,  0x16, 0x17, 0x18, 0x19,
+			0x1a, 0x1b, 0x1c, 0x1d,  0x1e, 0x1f, 0x20, 0x21,
+			0x22, 0x23, 0x24, 0x25,  0x26, 0x27, 0x28, 0x29,
+			0x2a, 0x2b, 0x2c, 0x2d,  0x2e, 0x2f, 0x30, 0x31,
+			0x32, 0x33, 0x34, 0x35,  0x36, 0x37
+		};
+		struct rohc_buf pkt = rohc_buf_init_full(buf, sizeof(buf), ts);
+		uint8_t out_buf[100];
+		struct rohc_buf out = rohc_buf_init_empty(out_buf, 100);
+		struct rohc_buf rcvd_feedback;
+		struct rohc_buf feedback_send;
+		const uint8_t *first_slot;
+
+		decomp2 = rohc_decomp_new2(ROHC_LARGE_CID, 15, ROHC_O_MODE);
+		CHECK(decomp2 != NULL);
+		CHECK(rohc_decomp_enable_profile(decomp2, ROHC_PROFILE_IP) == true);
+
+		CHECK(rohc_decomp_set_feedback_ring(NULL, 2, 64) == false);
+		CHECK(rohc_decomp_set_feedback_ring(decomp2, 3, 64) == false);
+		CHECK(rohc_decomp_set_feedback_ring(decomp2, 2, 0) == false);
+		CHECK(rohc_decomp_set_feedback_ring(decomp2, 0, 0) == true);
+
+		CHECK(rohc_decompress_fb_views(NULL, pkt, &out, &rcvd_feedback,
+		                               NULL) == ROHC_STATUS_ERROR);
+		CHECK(rohc_decompress_fb_views(decomp2, pkt, NULL, &rcvd_feedback,
+		                               NULL) == ROHC_STATUS_ERROR);
+		/* no ring for the feedback to send */
+		CHECK(rohc_decompress_fb_views(decomp2, pkt, &out, &rcvd_feedback,
+		                               &feedback_send) == ROHC_STATUS_ERROR);
+
+		/* the received feedback references the ROHC packet, the feedback to
+		 * send is built in the ring */
+		CHECK(rohc_decomp_set_feedback_ring(decomp2, 2, 64) == true);
+		CHECK(rohc_decompress_fb_views(decomp2, pkt, &out, &rcvd_feedback,
+		                               &feedback_send) == ROHC_STATUS_OK);
+		CHECK(out.len > 0);
+		CHECK(rcvd_feedback.len == 3);
+		CHECK(rohc_buf_data(rcvd_feedback) == buf);
+		CHECK(feedback_send.len > 0);
+		CHECK(rohc_buf_avail_len(feedback_send) == 64);
+		first_slot = rohc_buf_data(feedback_send);
+
+		/* the next feedback takes the next slot */
+		rohc_buf_reset(&out);
+		rohc_buf_pull(&pkt, 3);
+		CHECK(rohc_decompress_fb_views(decomp2, pkt, &out, &rcvd_feedback,
+		                               &feedback_send) == ROHC_STATUS_OK);
+		CHECK(rcvd_feedback.len == 0);
+		if(feedback_send.len > 0)
+		{
+			CHECK(rohc_buf_data(feedback_send) != first_slot);
+		}
+
+		rohc_decomp_free(decomp2);
+	}
+
+	/* rohc_decomp_set_pkt_log() and rohc_decomp_get_pkt_log() */
+	{
+		const struct rohc_ts ts = { .sec = 0, .nsec = 0 };
+		struct rohc_decomp *decomp2;
+		uint8_t buf[] =
+		{
+			0xfd, 0x00, 0x04, 0xce,  0x40, 0x01, 0xc0, 0xa8,
+			0x13, 0x01, 0xc0, 0xa8,  0x13, 0x05, 0x00, 0x40,
+			0x00, 0x00, 0xa0, 0x00,  0x00, 0x01, 0x08, 0x00,
+			0xe9, 0xc2, 0x9b, 0x42,  0x00, 0x01, 0x66, 0x15,
+			0xa6, 0x45, 0x77, 0x9b,  0x04, 0x00, 0x08, 0x09,
+			0x0a, 0x0b, 0x0c, 0x0d,  0x0e, 0x0f, 0x10, 0x11,
+			0x12, 0x13, 0x14, 0x15,  0x16, 0x17, 0x18, 0x19,
+			0x1a, 0x1b, 0x1c, 0x1d,  0x1e, 0x1f, 0x20, 0x21,
+			0x22, 0x23, 0x24, 0x25,  0x26, 0x27, 0x28, 0x29,
+			0x2a, 0x2b, 0x2c, 0x2d,  0x2e, 0x2f, 0x30, 0x31,
+			0x32, 0x33, 0x34, 0x35,  0x36, 0x37
+		};
+		struct rohc_buf pkt = rohc_buf_init_full(buf, sizeof(buf), ts);
+		uint8_t bad_buf[] = { 0xfd, 0x01, 0x00 };
+		struct rohc_buf bad_pkt = rohc_buf_init_full(bad_buf, 3, ts);
+		uint8_t out_buf[100];
+		struct rohc_buf out = rohc_buf_init_empty(out_buf, 100);
+		rohc_pkt_log_record_t records[4];
+		size_t records_nr;
+
+		decomp2 = rohc_decomp_new2(ROHC_LARGE_CID, 15, ROHC_U_MODE);
+		CHECK(decomp2 != NULL);
+		CHECK(rohc_decomp_enable_profile(decomp2, ROHC_PROFILE_IP) == true);
+
+		CHECK(rohc_decomp_set_pkt_log(NULL, 2) == false);
+		CHECK(rohc_decomp_set_pkt_log(decomp2, 6) == false);
+		CHECK(rohc_decomp_get_pkt_log(NULL, records, 4, &records_nr) == false);
+		CHECK(rohc_decomp_get_pkt_log(decomp2, NULL, 4, &records_nr) == false);
+		CHECK(rohc_decomp_get_pkt_log(decomp2, records, 4, NULL) == false);
+		CHECK(rohc_decomp_get_pkt_log(decomp2, records, 4, &records_nr) == true);
+		CHECK(records_nr == 0);
+
+		/* both the decompressed and the failed packets are recorded */
+		CHECK(rohc_decomp_set_pkt_log(decomp2, 2) == true);
+		CHECK(rohc_decompress3(decomp2, pkt, &out, NULL, NULL) == ROHC_STATUS_OK);
+		rohc_buf_reset(&out);
+		CHECK(rohc_decompress3(decomp2, bad_pkt, &out, NULL, NULL) != ROHC_STATUS_OK);
+		CHECK(rohc_decomp_get_pkt_log(decomp2, records, 4, &records_nr) == true);
+		CHECK(records_nr == 2);
+		CHECK(records[0].packet_nr == 1);
+		CHECK(records[0].cid == 0);
+		CHECK(records[0].profile_id == ROHC_PROFILE_IP);
+		CHECK(records[0].packet_type == ROHC_PACKET_IR);
+		CHECK(records[0].status == ROHC_STATUS_OK);
+		CHECK(records[1].packet_nr == 2);
+		CHECK(records[1].status != ROHC_STATUS_OK);
+
+		/* the oldest record is overwritten */
+		rohc_buf_reset(&out);
+		CHECK(rohc_decompress3(decomp2, pkt, &out, NULL, NULL) == ROHC_STATUS_OK);
+		CHECK(rohc_decomp_get_pkt_log(decomp2, records, 4, &records_nr) == true);
+		CHECK(records_nr == 2);
+		CHECK(records[0].packet_nr == 2);
+		CHECK(records[1].packet_nr == 3);
+
+		CHECK(rohc_decomp_set_pkt_log(decomp2, 0) == true);
+		CHECK(rohc_decomp_get_pkt_log(decomp2, records, 4, &records_nr) == true);
+		CHECK(records_nr == 0);
+
+		rohc_decomp_free(decomp2);
+	}
+
+	/* rohc_set_allocator() */
+	{
+		const struct rohc_ts ts = { .sec = 0, .nsec = 0 };
+		struct test_allocs allocs = { .allocs_nr = 0, .frees_nr = 0 };
+		struct rohc_decomp *decomp2;
+		uint8_t buf[] =
+		{
+			0xfd, 0x00, 0x04, 0xce,  0x40, 0x01, 0xc0, 0xa8,
+			0x13, 0x01, 0xc0, 0xa8,  0x13, 0x05, 0x00, 0x40,
+			0x00, 0x00, 0xa0, 0x00,  0x00, 0x01, 0x08, 0x00,
+			0xe9, 0xc2, 0x9b, 0x42,  0x00, 0x01, 0x66, 0x15,
+			0xa6, 0x45, 0x77, 0x9b,  0x04, 0x00, 0x08, 0x09,
+			0x0a, 0x0b, 0x0c, 0x0d,  0x0e, 0x0f, 0x10, 0x11,
+			0x12, 0x13, 0x14, 0x15,  0x16, 0x17, 0x18, 0x19,
+			0x1a, 0x1b, 0x1c, 0x1d,  0x1e, 0x1f, 0x20, 0x21,
+			0x22, 0x23, 0x24, 0x25,  0x26, 0x27, 0x28, 0x29,
+			0x2a, 0x2b, 0x2c, 0x2d,  0x2e, 0x2f, 0x30, 0x31,
+			0x32, 0x33, 0x34, 0x35,  0x36, 0x37
+		};
+		struct rohc_buf pkt = rohc_buf_init_full(buf, sizeof(buf), ts);
+		uint8_t out_buf[100];
+		struct rohc_buf out = rohc_buf_init_empty(out_buf, 100);
+		size_t allocs_nr;
+
+		CHECK(rohc_set_allocator(test_malloc, NULL, &allocs) == false);
+		CHECK(rohc_set_allocator(NULL, test_free, &allocs) == false);
+		CHECK(rohc_set_allocator(test_malloc, test_free, &allocs) == true);
+
+		/* the decompressor and its contexts are allocated by the allocator */
+		decomp2 = rohc_decomp_new2(ROHC_LARGE_CID, 15, ROHC_U_MODE);
+		CHECK(decomp2 != NULL);
+		CHECK(allocs.allocs_nr > 0);
+		CHECK(rohc_decomp_enable_profile(decomp2, ROHC_PROFILE_IP) == true);
+		allocs_nr = allocs.allocs_nr;
+		CHECK(rohc_decompress3(decomp2, pkt, &out, NULL, NULL) == ROHC_STATUS_OK);
+		CHECK(allocs.allocs_nr > allocs_nr);
+
+		/* all the memory is freed by the allocator */
+		rohc_decomp_free(decomp2);
+		CHECK(allocs.frees_nr == allocs.allocs_nr);
+		CHECK(rohc_set_allocator(NULL, NULL, NULL) == true);
 	}
 
 	/* rohc_decomp_free() */
@@ -368,3 +1329,49 @@ error:
 	return is_failure;
 }
 
+
+/**
+ * @brief Record the events of the contexts
+ *
+ * @param priv_ctxt  The events seen so far
+ * @param info       The description of the event
+ */
+static void event_cb(void *const priv_ctxt,
+                     const rohc_decomp_event_info_t *const info)
+{
+	struct test_events *const events = priv_ctxt;
+
+	events->nr[info->event]++;
+	memcpy(&events->last, info, sizeof(rohc_decomp_event_info_t));
+}
+
+
+/**
+ * @brief Allocate memory and count the allocation
+ *
+ * @param size       The number of bytes to allocate
+ * @param priv_ctxt  The allocations done so far
+ * @return           The allocated memory, NULL in case of failure
+ */
+static void * test_malloc(const size_t size, void *const priv_ctxt)
+{
+	struct test_allocs *const allocs = priv_ctxt;
+
+	allocs->allocs_nr++;
+	return malloc(size);
+}
+
+
+/**
+ * @brief Free memory and count the deallocation
+ *
+ * @param ptr        The memory to free
+ * @param priv_ctxt  The allocations done so far
+ */
+static void test_free(void *const ptr, void *const priv_ctxt)
+{
+	struct test_allocs *const allocs = priv_ctxt;
+
+	allocs->frees_nr++;
+	free(ptr);
+}
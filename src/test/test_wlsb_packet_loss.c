@@ -195,22 +195,24 @@ static bool run_test8_with_shift_param(bool be_verbose,
 	assert(win_size > 0);
 
 	/* create the W-LSB encoding context */
-	wlsb = c_create_wlsb(8, win_size, p);
+	wlsb = malloc(sizeof(struct c_wlsb));
 	if(wlsb == NULL)
 	{
 		fprintf(stderr, "no memory to allocate W-LSB encoding context\n");
 		goto error;
 	}
+	c_init_wlsb(wlsb, 8, win_size, p);
 
 	/* init the LSB decoding context with value 0 */
 	value8 = 0;
 	trace(be_verbose, "\tinitialize with 8 bits of value 0x%02x ...\n", value8);
-	lsb = rohc_lsb_new(8);
+	lsb = malloc(sizeof(struct rohc_lsb_decode));
 	if(lsb == NULL)
 	{
 		fprintf(stderr, "no memory to allocate LSB decoding context\n");
 		goto destroy_wlsb;
 	}
+	rohc_lsb_init(lsb, 8);
 	rohc_lsb_set_ref(lsb, value8, false);
 
 	/* initialize the W-LSB encoding context */
@@ -309,9 +311,9 @@ static bool run_test8_with_shift_param(bool be_verbose,
 	is_success = true;
 
 destroy_lsb:
-	rohc_lsb_free(lsb);
+	free(lsb);
 destroy_wlsb:
-	c_destroy_wlsb(wlsb);
+	free(wlsb);
 error:
 	return is_success;
 }
@@ -345,22 +347,24 @@ static bool run_test16_with_shift_param(bool be_verbose,
 	assert(win_size > 0);
 
 	/* create the W-LSB encoding context */
-	wlsb = c_create_wlsb(16, win_size, p);
+	wlsb = malloc(sizeof(struct c_wlsb));
 	if(wlsb == NULL)
 	{
 		fprintf(stderr, "no memory to allocate W-LSB encoding context\n");
 		goto error;
 	}
+	c_init_wlsb(wlsb, 16, win_size, p);
 
 	/* init the LSB decoding context with value 0 */
 	value16 = 0;
 	trace(be_verbose, "\tinitialize with 16 bits of value 0x%04x ...\n", value16);
-	lsb = rohc_lsb_new(16);
+	lsb = malloc(sizeof(struct rohc_lsb_decode));
 	if(lsb == NULL)
 	{
 		fprintf(stderr, "no memory to allocate LSB decoding context\n");
 		goto destroy_wlsb;
 	}
+	rohc_lsb_init(lsb, 16);
 	rohc_lsb_set_ref(lsb, value16, false);
 
 	/* initialize the W-LSB encoding context */
@@ -459,9 +463,9 @@ static bool run_test16_with_shift_param(bool be_verbose,
 	is_success = true;
 
 destroy_lsb:
-	rohc_lsb_free(lsb);
+	free(lsb);
 destroy_wlsb:
-	c_destroy_wlsb(wlsb);
+	free(wlsb);
 error:
 	return is_success;
 }
@@ -495,22 +499,24 @@ static bool run_test32_with_shift_param(bool be_verbose,
 	assert(win_size > 0);
 
 	/* create the W-LSB encoding context */
-	wlsb = c_create_wlsb(32, ROHC_WLSB_WINDOW_WIDTH, p);
+	wlsb = malloc(sizeof(struct c_wlsb));
 	if(wlsb == NULL)
 	{
 		fprintf(stderr, "no memory to allocate W-LSB encoding context\n");
 		goto error;
 	}
+	c_init_wlsb(wlsb, 32, ROHC_WLSB_WINDOW_WIDTH, p);
 
 	/* init the LSB decoding context with value 0 */
 	value32 = 0;
 	trace(be_verbose, "\tinitialize with 32 bits of value 0x%08x ...\n", value32);
-	lsb = rohc_lsb_new(32);
+	lsb = malloc(sizeof(struct rohc_lsb_decode));
 	if(lsb == NULL)
 	{
 		fprintf(stderr, "no memory to allocate LSB decoding context\n");
 		goto destroy_wlsb;
 	}
+	rohc_lsb_init(lsb, 32);
 	rohc_lsb_set_ref(lsb, value32, false);
 
 	/* initialize the W-LSB encoding context */
@@ -605,9 +611,9 @@ static bool run_test32_with_shift_param(bool be_verbose,
 	is_success = true;
 
 destroy_lsb:
-	rohc_lsb_free(lsb);
+	free(lsb);
 destroy_wlsb:
-	c_destroy_wlsb(wlsb);
+	free(wlsb);
 error:
 	return is_success;
 }
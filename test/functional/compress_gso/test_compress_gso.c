@@ -0,0 +1,557 @@
+/*
+ * Copyright 2016 Didier Barvaux
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/**
+ * @file   test_compress_gso.c
+ * @brief  Check that the segments of TCP GSO super-packets are decompressed
+ *         as Linux would have segmented them
+ * @author Didier Barvaux <didier@barvaux.org>
+ *
+ * The application builds TCP GSO super-packets over IPv4 and IPv6, and
+ * compresses them with \ref rohc_compress_gso. The ROHC header and the
+ * payload of every segment are put together, then decompressed. Every
+ * decompressed segment shall be the segment that the TCP segmentation
+ * offload of Linux builds, byte for byte: the test builds those segments on
+ * its own, checksums included. The super-packets shall be unchanged once
+ * compressed.
+ */
+
+#include "test.h"
+#include "config.h" /* for HAVE_*_H */
+
+/* system includes */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <stdarg.h>
+
+/* ROHC includes */
+#include <rohc.h>
+#include <rohc_comp.h>
+#include <rohc_decomp.h>
+
+
+/** The number of GSO super-packets per stream */
+#define TEST_GSO_PKTS_NR  10U
+
+/** The Maximum Segment Size of the super-packets */
+#define TEST_MSS  1000U
+
+/** The max number of segments per super-packet */
+#define TEST_SEGS_MAX  8U
+
+/** The max length of the payload of one super-packet */
+#define TEST_GSO_PAYLOAD_MAX_LEN  (TEST_MSS * TEST_SEGS_MAX)
+
+/** The length of the TCP header with the NOP, NOP and Timestamp options */
+#define TEST_TCP_HDR_LEN  32U
+
+/** The max length of the IP/TCP headers */
+#define TEST_HDRS_MAX_LEN  (40U + TEST_TCP_HDR_LEN)
+
+/** The max length of one ROHC header */
+#define TEST_ROHC_HDR_MAX_LEN  (TEST_HDRS_MAX_LEN * 2)
+
+/** The max length of one segment */
+#define TEST_SEG_MAX_LEN  (TEST_HDRS_MAX_LEN + TEST_MSS)
+
+/** The TCP flags used by the test */
+#define TEST_TCP_PSH  0x08U
+#define TEST_TCP_ACK  0x10U
+
+
+/* prototypes of private functions */
+static void usage(void);
+static int test_gso(const bool is_ipv6);
+static size_t gen_tcp_packet(const bool is_ipv6,
+                             const uint16_t ip_id,
+                             const uint32_t seq_num,
+                             const uint8_t tcp_flags,
+                             const uint32_t ts,
+                             const size_t payload_offset,
+                             const size_t payload_len,
+                             uint8_t *const pkt);
+static uint32_t csum_sum(const uint8_t *const data, const size_t len);
+static uint16_t csum_fold(uint32_t sum)
+	__attribute__((warn_unused_result, const));
+static void print_rohc_traces(void *const priv_ctxt,
+                              const rohc_trace_level_t level,
+                              const rohc_trace_entity_t entity,
+                              const int profile,
+                              const char *const format,
+                              ...)
+	__attribute__((format(printf, 5, 6), nonnull(5)));
+static int gen_random_num(const struct rohc_comp *const comp,
+                          void *const user_context)
+	__attribute__((nonnull(1)));
+
+
+/**
+ * @brief Check that the segments of TCP GSO super-packets are decompressed
+ *        as Linux would have segmented them
+ *
+ * @param argc The number of program arguments
+ * @param argv The program arguments
+ * @return     The unix return code:
+ *              \li 0 in case of success,
+ *              \li 1 in case of failure
+ */
+int main(int argc, char *argv[])
+{
+	int status = 1;
+
+	/* parse program arguments, print the help message in case of failure */
+	if(argc != 1)
+	{
+		usage();
+		goto error;
+	}
+
+	/* initialize the random generator with the same number to ease debugging */
+	srand(4 /* chosen by fair dice roll, guaranteed to be random */);
+
+	if(test_gso(false) != 0 || test_gso(true) != 0)
+	{
+		goto error;
+	}
+
+	status = 0;
+
+error:
+	return status;
+}
+
+
+/**
+ * @brief Print usage of the application
+ */
+static void usage(void)
+{
+	fprintf(stderr,
+	        "Check that the segments of TCP GSO super-packets are decompressed\n"
+	        "as Linux would have segmented them\n"
+	        "\n"
+	        "usage: test_compress_gso [OPTIONS]\n"
+	        "\n"
+	        "options:\n"
+	        "  -h           Print this usage and exit\n");
+}
+
+
+/**
+ * @brief Compress and decompress one stream of TCP GSO super-packets
+ *
+ * @param is_ipv6  Whether the IP header is IPv6 or IPv4
+ * @return         0 in case of success,
+ *                 1 in case of failure
+ */
+static int test_gso(const bool is_ipv6)
+{
+	const struct rohc_ts arrival_time = { .sec = 0, .nsec = 0 };
+	struct rohc_comp *comp;
+	struct rohc_decomp *decomp;
+	uint16_t ip_id = 0x1000;
+	uint32_t seq_num = 0xfffff000; /* wraps around in the stream */
+	size_t stream_offset = 0;
+	size_t segs_total = 0;
+	int is_failure = 1;
+	size_t i;
+
+	fprintf(stderr, "test TCP GSO super-packets over %s\n",
+	        is_ipv6 ? "IPv6" : "IPv4");
+
+	/* create the ROHC compressor with small CID */
+	comp = rohc_comp_new2(ROHC_SMALL_CID, ROHC_SMALL_CID_MAX,
+	                      gen_random_num, NULL);
+	if(comp == NULL)
+	{
+		fprintf(stderr, "failed to create the ROHC compressor\n");
+		goto error;
+	}
+	if(!rohc_comp_set_traces_cb2(comp, print_rohc_traces, NULL))
+	{
+		fprintf(stderr, "failed to set the callback for traces on "
+		        "compressor\n");
+		goto destroy_comp;
+	}
+	if(!rohc_comp_enable_profiles(comp, ROHC_PROFILE_UNCOMPRESSED,
+	                              ROHC_PROFILE_TCP, -1))
+	{
+		fprintf(stderr, "failed to enable the compression profiles\n");
+		goto destroy_comp;
+	}
+
+	/* create the ROHC decompressor in bi-directional mode */
+	decomp = rohc_decomp_new2(ROHC_SMALL_CID, ROHC_SMALL_CID_MAX, ROHC_O_MODE);
+	if(decomp == NULL)
+	{
+		fprintf(stderr, "failed to create the ROHC decompressor\n");
+		goto destroy_comp;
+	}
+	if(!rohc_decomp_set_traces_cb2(decomp, print_rohc_traces, NULL))
+	{
+		fprintf(stderr, "failed to set the callback for traces on "
+		        "decompressor\n");
+		goto destroy_decomp;
+	}
+	if(!rohc_decomp_enable_profiles(decomp, ROHC_PROFILE_UNCOMPRESSED,
+	                                ROHC_PROFILE_TCP, -1))
+	{
+		fprintf(stderr, "failed to enable the decompression profiles\n");
+		goto destroy_decomp;
+	}
+
+	for(i = 0; i < TEST_GSO_PKTS_NR; i++)
+	{
+		/* segments of MSS bytes, the last one is shorter one time out of two */
+		const size_t payload_len =
+			TEST_MSS * (2 + (i % (TEST_SEGS_MAX - 2))) + ((i % 2) * 321);
+		const size_t segs_nr_expected = (payload_len + TEST_MSS - 1) / TEST_MSS;
+		const uint32_t ts = 0x01020304 + i;
+		uint8_t gso_buffer[TEST_HDRS_MAX_LEN + TEST_GSO_PAYLOAD_MAX_LEN];
+		uint8_t gso_copy[TEST_HDRS_MAX_LEN + TEST_GSO_PAYLOAD_MAX_LEN];
+		struct rohc_buf gso_packet =
+			rohc_buf_init_empty(gso_buffer, sizeof(gso_buffer));
+		uint8_t rohc_hdrs_buffers[TEST_SEGS_MAX][TEST_ROHC_HDR_MAX_LEN];
+		struct rohc_buf rohc_hdrs[TEST_SEGS_MAX];
+		struct rohc_buf payloads[TEST_SEGS_MAX];
+		size_t payload_offset = 0;
+		size_t segs_nr;
+		size_t j;
+
+		assert(segs_nr_expected <= TEST_SEGS_MAX);
+
+		/* build the super-packet with the PSH flag */
+		gso_packet.time = arrival_time;
+		gso_packet.len =
+			gen_tcp_packet(is_ipv6, ip_id, seq_num, TEST_TCP_ACK | TEST_TCP_PSH,
+			               ts, stream_offset, payload_len, gso_buffer);
+		memcpy(gso_copy, gso_buffer, gso_packet.len);
+
+		/* segment and compress the super-packet */
+		for(j = 0; j < TEST_SEGS_MAX; j++)
+		{
+			memset(&rohc_hdrs[j], 0, sizeof(struct rohc_buf));
+			rohc_hdrs[j].data = rohc_hdrs_buffers[j];
+			rohc_hdrs[j].max_len = TEST_ROHC_HDR_MAX_LEN;
+		}
+		if(!rohc_compress_gso(comp, gso_packet, TEST_MSS, rohc_hdrs, payloads,
+		                      TEST_SEGS_MAX, &segs_nr))
+		{
+			fprintf(stderr, "\tfailed to compress GSO packet #%zu\n", i + 1);
+			goto destroy_decomp;
+		}
+		if(segs_nr != segs_nr_expected)
+		{
+			fprintf(stderr, "\tGSO packet #%zu of %zu bytes of payload was "
+			        "compressed into %zu segments instead of %zu\n", i + 1,
+			        payload_len, segs_nr, segs_nr_expected);
+			goto destroy_decomp;
+		}
+		if(memcmp(gso_buffer, gso_copy, gso_packet.len) != 0)
+		{
+			fprintf(stderr, "\tGSO packet #%zu was changed by the compression\n",
+			        i + 1);
+			goto destroy_decomp;
+		}
+
+		/* decompress every segment and compare with the segment Linux builds */
+		for(j = 0; j < segs_nr; j++)
+		{
+			const size_t seg_len = (j + 1 < segs_nr ? TEST_MSS :
+			                        payload_len - payload_offset);
+			const uint8_t tcp_flags =
+				TEST_TCP_ACK | ((j + 1) == segs_nr ? TEST_TCP_PSH : 0);
+			uint8_t seg_buffer[TEST_SEG_MAX_LEN];
+			size_t seg_pkt_len;
+			uint8_t rohc_buffer[TEST_ROHC_HDR_MAX_LEN + TEST_MSS];
+			struct rohc_buf rohc_packet =
+				rohc_buf_init_empty(rohc_buffer, sizeof(rohc_buffer));
+			uint8_t uncomp_buffer[TEST_SEG_MAX_LEN];
+			struct rohc_buf uncomp_packet =
+				rohc_buf_init_empty(uncomp_buffer, TEST_SEG_MAX_LEN);
+			rohc_status_t status;
+
+			/* the payload of the ROHC packet is a slice of the super-packet */
+			if(rohc_buf_data(payloads[j]) !=
+			   (gso_buffer + gso_packet.len - payload_len + payload_offset) ||
+			   payloads[j].len != seg_len)
+			{
+				fprintf(stderr, "\tpayload of segment #%zu of GSO packet #%zu is "
+				        "not a slice of the GSO packet\n", j + 1, i + 1);
+				goto destroy_decomp;
+			}
+
+			seg_pkt_len =
+				gen_tcp_packet(is_ipv6, ip_id + j, seq_num + payload_offset,
+				               tcp_flags, ts, stream_offset + payload_offset,
+				               seg_len, seg_buffer);
+
+			rohc_packet.time = arrival_time;
+			rohc_buf_append_buf(&rohc_packet, rohc_hdrs[j]);
+			rohc_buf_append_buf(&rohc_packet, payloads[j]);
+			status = rohc_decompress3(decomp, rohc_packet, &uncomp_packet,
+			                          NULL, NULL);
+			if(status != ROHC_STATUS_OK)
+			{
+				fprintf(stderr, "\tfailed to decompress segment #%zu of GSO "
+				        "packet #%zu\n", j + 1, i + 1);
+				goto destroy_decomp;
+			}
+			if(uncomp_packet.len != seg_pkt_len ||
+			   memcmp(rohc_buf_data(uncomp_packet), seg_buffer, seg_pkt_len) != 0)
+			{
+				fprintf(stderr, "\tdecompressed segment #%zu of GSO packet #%zu "
+				        "does not match the segment built by Linux\n", j + 1,
+				        i + 1);
+				goto destroy_decomp;
+			}
+			payload_offset += seg_len;
+		}
+
+		segs_total += segs_nr;
+		ip_id += segs_nr;
+		seq_num += payload_len;
+		stream_offset += payload_len;
+	}
+
+	fprintf(stderr, "\t%u GSO packets compressed into %zu segments\n",
+	        TEST_GSO_PKTS_NR, segs_total);
+	is_failure = 0;
+
+destroy_decomp:
+	rohc_decomp_free(decomp);
+destroy_comp:
+	rohc_comp_free(comp);
+error:
+	return is_failure;
+}
+
+
+/**
+ * @brief Generate one IP/TCP packet of the stream
+ *
+ * The IP addresses, the TCP ports, the TCP ACK number and window are
+ * constant. The TCP header holds the NOP, NOP and Timestamp options. The
+ * payload is a slice of the byte stream of the connection. The IPv4 and TCP
+ * checksums are computed.
+ *
+ * @param is_ipv6         Whether the IP header is IPv6 or IPv4
+ * @param ip_id           The IPv4 ID, ignored for IPv6
+ * @param seq_num         The TCP sequence number
+ * @param tcp_flags       The TCP flags
+ * @param ts              The TCP timestamp value
+ * @param payload_offset  The offset of the payload in the byte stream
+ * @param payload_len     The length of the payload
+ * @param pkt             OUT: The generated IP packet
+ * @return                The length of the generated IP packet
+ */
+static size_t gen_tcp_packet(const bool is_ipv6,
+                             const uint16_t ip_id,
+                             const uint32_t seq_num,
+                             const uint8_t tcp_flags,
+                             const uint32_t ts,
+                             const size_t payload_offset,
+                             const size_t payload_len,
+                             uint8_t *const pkt)
+{
+	const size_t tcp_len = TEST_TCP_HDR_LEN + payload_len;
+	uint8_t pseudo_hdr[40];
+	size_t pseudo_hdr_len;
+	size_t ip_hdr_len;
+	uint8_t *tcp;
+	uint32_t sum;
+	size_t i;
+
+	if(is_ipv6)
+	{
+		ip_hdr_len = 40;
+		memset(pkt, 0, ip_hdr_len);
+		pkt[0] = 0x60; /* version 6 */
+		pkt[4] = (tcp_len >> 8) & 0xff;
+		pkt[5] = tcp_len & 0xff;
+		pkt[6] = 6; /* TCP */
+		pkt[7] = 64;
+		pkt[8] = 0x20;
+		pkt[9] = 0x01;
+		pkt[23] = 0x01;
+		pkt[24] = 0x20;
+		pkt[25] = 0x01;
+		pkt[39] = 0x02;
+
+		memcpy(pseudo_hdr, pkt + 8, 32);
+		pseudo_hdr[32] = 0;
+		pseudo_hdr[33] = 0;
+		pseudo_hdr[34] = (tcp_len >> 8) & 0xff;
+		pseudo_hdr[35] = tcp_len & 0xff;
+		pseudo_hdr[36] = 0;
+		pseudo_hdr[37] = 0;
+		pseudo_hdr[38] = 0;
+		pseudo_hdr[39] = 6; /* TCP */
+		pseudo_hdr_len = 40;
+	}
+	else
+	{
+		uint16_t ip_csum;
+
+		ip_hdr_len = 20;
+		memset(pkt, 0, ip_hdr_len);
+		pkt[0] = 0x45; /* version 4, no option */
+		pkt[2] = ((ip_hdr_len + tcp_len) >> 8) & 0xff;
+		pkt[3] = (ip_hdr_len + tcp_len) & 0xff;
+		pkt[4] = (ip_id >> 8) & 0xff;
+		pkt[5] = ip_id & 0xff;
+		pkt[6] = 0x40; /* DF */
+		pkt[8] = 64;
+		pkt[9] = 6; /* TCP */
+		pkt[12] = 10;
+		pkt[15] = 1;
+		pkt[16] = 10;
+		pkt[19] = 2;
+		ip_csum = ~csum_fold(csum_sum(pkt, ip_hdr_len));
+		pkt[10] = (ip_csum >> 8) & 0xff;
+		pkt[11] = ip_csum & 0xff;
+
+		memcpy(pseudo_hdr, pkt + 12, 8);
+		pseudo_hdr[8] = 0;
+		pseudo_hdr[9] = 6; /* TCP */
+		pseudo_hdr[10] = (tcp_len >> 8) & 0xff;
+		pseudo_hdr[11] = tcp_len & 0xff;
+		pseudo_hdr_len = 12;
+	}
+
+	tcp = pkt + ip_hdr_len;
+	memset(tcp, 0, TEST_TCP_HDR_LEN);
+	tcp[0] = 0x13; /* source port 5000 */
+	tcp[1] = 0x88;
+	tcp[3] = 80; /* destination port 80 */
+	tcp[4] = (seq_num >> 24) & 0xff;
+	tcp[5] = (seq_num >> 16) & 0xff;
+	tcp[6] = (seq_num >> 8) & 0xff;
+	tcp[7] = seq_num & 0xff;
+	tcp[9] = 0x01; /* ACK number 0x00010000 */
+	tcp[12] = (TEST_TCP_HDR_LEN / 4) << 4;
+	tcp[13] = tcp_flags;
+	tcp[14] = 0x20; /* window 0x2000 */
+	tcp[20] = 0x01; /* NOP */
+	tcp[21] = 0x01; /* NOP */
+	tcp[22] = 0x08; /* Timestamp */
+	tcp[23] = 10;
+	tcp[24] = (ts >> 24) & 0xff;
+	tcp[25] = (ts >> 16) & 0xff;
+	tcp[26] = (ts >> 8) & 0xff;
+	tcp[27] = ts & 0xff;
+	tcp[31] = 0x01; /* echo reply 1 */
+
+	for(i = 0; i < payload_len; i++)
+	{
+		tcp[TEST_TCP_HDR_LEN + i] = ((payload_offset + i) * 7) & 0xff;
+	}
+
+	sum = csum_sum(pseudo_hdr, pseudo_hdr_len) + csum_sum(tcp, tcp_len);
+	sum = (uint16_t) ~csum_fold(sum);
+	tcp[16] = (sum >> 8) & 0xff;
+	tcp[17] = sum & 0xff;
+
+	return ip_hdr_len + tcp_len;
+}
+
+
+/**
+ * @brief Compute the one's complement sum of the given data, not folded
+ *
+ * @param data  The data to sum
+ * @param len   The length of the data
+ * @return      The sum of the 16-bit big-endian words of the data
+ */
+static uint32_t csum_sum(const uint8_t *const data, const size_t len)
+{
+	uint32_t sum = 0;
+	size_t i;
+
+	for(i = 0; (i + 1) < len; i += 2)
+	{
+		sum += (data[i] << 8) | data[i + 1];
+	}
+	if((len % 2) != 0)
+	{
+		sum += data[len - 1] << 8;
+	}
+
+	return sum;
+}
+
+
+/**
+ * @brief Fold a 32-bit one's complement sum into 16 bits
+ *
+ * @param sum  The 32-bit sum
+ * @return     The 16-bit sum
+ */
+static uint16_t csum_fold(uint32_t sum)
+{
+	while((sum >> 16) != 0)
+	{
+		sum = (sum & 0xffff) + (sum >> 16);
+	}
+	return sum;
+}
+
+
+/**
+ * @brief Callback to print traces of the ROHC library
+ *
+ * @param priv_ctxt  An optional private context, may be NULL
+ * @param level      The priority level of the trace
+ * @param entity     The entity that emitted the trace among:
+ *                    \li ROHC_TRACE_COMP
+ *                    \li ROHC_TRACE_DECOMP
+ * @param profile    The ID of the ROHC compression/decompression profile
+ *                   the trace is related to
+ * @param format     The format string of the trace
+ */
+static void print_rohc_traces(void *const priv_ctxt,
+                              const rohc_trace_level_t level,
+                              const rohc_trace_entity_t entity,
+                              const int profile,
+                              const char *const format,
+                              ...)
+{
+	va_list args;
+
+	va_start(args, format);
+	vfprintf(stdout, format, args);
+	va_end(args);
+}
+
+
+/**
+ * @brief Generate a random number
+ *
+ * @param comp          The ROHC compressor
+ * @param user_context  Should always be NULL
+ * @return              A random number
+ */
+static int gen_random_num(const struct rohc_comp *const comp,
+                          void *const user_context)
+{
+	assert(comp != NULL);
+	assert(user_context == NULL);
+	return rand();
+}
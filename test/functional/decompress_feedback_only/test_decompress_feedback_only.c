@@ -122,6 +122,7 @@ static int test_decomp(const struct rohc_buf rohc_feedback)
 	uint8_t feedback_buffer[MAX_ROHC_SIZE];
 	struct rohc_buf feedback_packet =
 		rohc_buf_init_empty(feedback_buffer, MAX_ROHC_SIZE);
+	struct rohc_buf feedback_view;
 
 	int is_failure = 1;
 	rohc_status_t status;
@@ -159,6 +160,24 @@ static int test_decomp(const struct rohc_buf rohc_feedback)
 	}
 	fprintf(stderr, "decompression is successful\n");
 
+	/* the fast path for feedback-only packets shall extract the same
+	 * feedback */
+	if(!rohc_decomp_parse_feedback_only(decomp, rohc_feedback, &feedback_view))
+	{
+		fprintf(stderr, "ROHC packet was not detected as a feedback-only "
+		        "packet\n");
+		goto destroy_decomp;
+	}
+	if(feedback_view.len != feedback_packet.len ||
+	   memcmp(rohc_buf_data(feedback_view), rohc_buf_data(feedback_packet),
+	          feedback_packet.len) != 0)
+	{
+		fprintf(stderr, "the fast path extracted other feedback data than "
+		        "the decompression\n");
+		goto destroy_decomp;
+	}
+	fprintf(stderr, "feedback extraction is successful\n");
+
 	/* everything went fine */
 	is_failure = 0;
 
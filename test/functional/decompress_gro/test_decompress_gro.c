@@ -0,0 +1,594 @@
+/*
+ * Copyright 2016 Didier Barvaux
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/**
+ * @file   test_decompress_gro.c
+ * @brief  Check that the TCP segments are decompressed and coalesced as
+ *         Linux would have coalesced them
+ * @author Didier Barvaux <didier@barvaux.org>
+ *
+ * The application compresses the TCP segments of one stream over IPv4 and
+ * IPv6, then decompresses them in bursts with \ref rohc_decompress_gro. Every
+ * burst transports two messages of the sender, the last segment of every
+ * message is shorter or has the PSH flag set. Every message shall be output
+ * as one large packet, that is the packet that the generic receive offload
+ * of Linux builds, byte for byte: the test builds those large packets on its
+ * own, checksums included.
+ */
+
+#include "test.h"
+#include "config.h" /* for HAVE_*_H */
+
+/* system includes */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <stdarg.h>
+
+/* ROHC includes */
+#include <rohc.h>
+#include <rohc_comp.h>
+#include <rohc_decomp.h>
+
+
+/** The number of bursts per stream */
+#define TEST_BURSTS_NR  10U
+
+/** The number of messages per burst */
+#define TEST_MSGS_NR  2U
+
+/** The Maximum Segment Size of the stream */
+#define TEST_MSS  1000U
+
+/** The max number of segments per message */
+#define TEST_SEGS_MAX  6U
+
+/** The max number of segments per burst */
+#define TEST_BURST_MAX  (TEST_SEGS_MAX * TEST_MSGS_NR)
+
+/** The max length of the payload of one message */
+#define TEST_MSG_PAYLOAD_MAX_LEN  (TEST_MSS * TEST_SEGS_MAX)
+
+/** The length of the TCP header with the NOP, NOP and Timestamp options */
+#define TEST_TCP_HDR_LEN  32U
+
+/** The max length of the IP/TCP headers */
+#define TEST_HDRS_MAX_LEN  (40U + TEST_TCP_HDR_LEN)
+
+/** The max length of one segment */
+#define TEST_SEG_MAX_LEN  (TEST_HDRS_MAX_LEN + TEST_MSS)
+
+/** The max length of one ROHC packet */
+#define TEST_ROHC_MAX_LEN  (TEST_SEG_MAX_LEN * 2)
+
+/** The max length of one large packet */
+#define TEST_MSG_MAX_LEN  (TEST_HDRS_MAX_LEN + TEST_MSG_PAYLOAD_MAX_LEN)
+
+/** The TCP flags used by the test */
+#define TEST_TCP_PSH  0x08U
+#define TEST_TCP_ACK  0x10U
+
+
+/* prototypes of private functions */
+static void usage(void);
+static int test_gro(const bool is_ipv6);
+static size_t gen_tcp_packet(const bool is_ipv6,
+                             const uint16_t ip_id,
+                             const uint32_t seq_num,
+                             const uint8_t tcp_flags,
+                             const uint32_t ts,
+                             const size_t payload_offset,
+                             const size_t payload_len,
+                             uint8_t *const pkt);
+static uint32_t csum_sum(const uint8_t *const data, const size_t len);
+static uint16_t csum_fold(uint32_t sum)
+	__attribute__((warn_unused_result, const));
+static void print_rohc_traces(void *const priv_ctxt,
+                              const rohc_trace_level_t level,
+                              const rohc_trace_entity_t entity,
+                              const int profile,
+                              const char *const format,
+                              ...)
+	__attribute__((format(printf, 5, 6), nonnull(5)));
+static int gen_random_num(const struct rohc_comp *const comp,
+                          void *const user_context)
+	__attribute__((nonnull(1)));
+
+
+/** The ROHC packets of one burst */
+static uint8_t rohc_buffers[TEST_BURST_MAX][TEST_ROHC_MAX_LEN];
+
+/** The decompressed packets of one burst, large enough for one message */
+static uint8_t uncomp_buffers[TEST_BURST_MAX][TEST_MSG_MAX_LEN];
+
+
+/**
+ * @brief Check that the TCP segments are decompressed and coalesced as Linux
+ *        would have coalesced them
+ *
+ * @param argc The number of program arguments
+ * @param argv The program arguments
+ * @return     The unix return code:
+ *              \li 0 in case of success,
+ *              \li 1 in case of failure
+ */
+int main(int argc, char *argv[])
+{
+	int status = 1;
+
+	/* parse program arguments, print the help message in case of failure */
+	if(argc != 1)
+	{
+		usage();
+		goto error;
+	}
+
+	/* initialize the random generator with the same number to ease debugging */
+	srand(4 /* chosen by fair dice roll, guaranteed to be random */);
+
+	if(test_gro(false) != 0 || test_gro(true) != 0)
+	{
+		goto error;
+	}
+
+	status = 0;
+
+error:
+	return status;
+}
+
+
+/**
+ * @brief Print usage of the application
+ */
+static void usage(void)
+{
+	fprintf(stderr,
+	        "Check that the TCP segments are decompressed and coalesced as\n"
+	        "Linux would have coalesced them\n"
+	        "\n"
+	        "usage: test_decompress_gro [OPTIONS]\n"
+	        "\n"
+	        "options:\n"
+	        "  -h           Print this usage and exit\n");
+}
+
+
+/**
+ * @brief Compress one TCP stream, then decompress and coalesce it in bursts
+ *
+ * @param is_ipv6  Whether the IP header is IPv6 or IPv4
+ * @return         0 in case of success,
+ *                 1 in case of failure
+ */
+static int test_gro(const bool is_ipv6)
+{
+	const struct rohc_ts arrival_time = { .sec = 0, .nsec = 0 };
+	struct rohc_comp *comp;
+	struct rohc_decomp *decomp;
+	uint16_t ip_id = 0x1000;
+	uint32_t seq_num = 0xfffff000; /* wraps around in the stream */
+	size_t stream_offset = 0;
+	size_t segs_total = 0;
+	int is_failure = 1;
+	size_t i;
+
+	fprintf(stderr, "test TCP GRO over %s\n", is_ipv6 ? "IPv6" : "IPv4");
+
+	/* create the ROHC compressor with small CID */
+	comp = rohc_comp_new2(ROHC_SMALL_CID, ROHC_SMALL_CID_MAX,
+	                      gen_random_num, NULL);
+	if(comp == NULL)
+	{
+		fprintf(stderr, "failed to create the ROHC compressor\n");
+		goto error;
+	}
+	if(!rohc_comp_set_traces_cb2(comp, print_rohc_traces, NULL))
+	{
+		fprintf(stderr, "failed to set the callback for traces on "
+		        "compressor\n");
+		goto destroy_comp;
+	}
+	if(!rohc_comp_enable_profiles(comp, ROHC_PROFILE_UNCOMPRESSED,
+	                              ROHC_PROFILE_TCP, -1))
+	{
+		fprintf(stderr, "failed to enable the compression profiles\n");
+		goto destroy_comp;
+	}
+
+	/* create the ROHC decompressor in bi-directional mode */
+	decomp = rohc_decomp_new2(ROHC_SMALL_CID, ROHC_SMALL_CID_MAX, ROHC_O_MODE);
+	if(decomp == NULL)
+	{
+		fprintf(stderr, "failed to create the ROHC decompressor\n");
+		goto destroy_comp;
+	}
+	if(!rohc_decomp_set_traces_cb2(decomp, print_rohc_traces, NULL))
+	{
+		fprintf(stderr, "failed to set the callback for traces on "
+		        "decompressor\n");
+		goto destroy_decomp;
+	}
+	if(!rohc_decomp_enable_profiles(decomp, ROHC_PROFILE_UNCOMPRESSED,
+	                                ROHC_PROFILE_TCP, -1))
+	{
+		fprintf(stderr, "failed to enable the decompression profiles\n");
+		goto destroy_decomp;
+	}
+
+	for(i = 0; i < TEST_BURSTS_NR; i++)
+	{
+		struct rohc_buf rohc_packets[TEST_BURST_MAX];
+		struct rohc_buf uncomp_packets[TEST_BURST_MAX];
+		rohc_decomp_gro_info_t infos[TEST_BURST_MAX];
+		rohc_status_t statuses[TEST_BURST_MAX];
+		size_t msgs_payload_len[TEST_MSGS_NR];
+		size_t msgs_segs_nr[TEST_MSGS_NR];
+		uint16_t msg_ip_id = ip_id;
+		uint32_t msg_seq_num = seq_num;
+		size_t msg_offset = stream_offset;
+		size_t packets_nr = 0;
+		size_t uncomp_nr;
+		size_t msg;
+		size_t j;
+
+		/* compress the segments of the messages of the burst: segments of MSS
+		 * bytes, the last one is shorter one time out of two and always has
+		 * the PSH flag set */
+		for(msg = 0; msg < TEST_MSGS_NR; msg++)
+		{
+			const size_t msg_id = i * TEST_MSGS_NR + msg;
+			const size_t payload_len = TEST_MSS * (1 + (msg_id % TEST_SEGS_MAX)) -
+			                           ((msg_id % 2) * 321);
+			size_t payload_offset = 0;
+
+			msgs_payload_len[msg] = payload_len;
+			msgs_segs_nr[msg] = (payload_len + TEST_MSS - 1) / TEST_MSS;
+			assert(msgs_segs_nr[msg] <= TEST_SEGS_MAX);
+
+			for(j = 0; j < msgs_segs_nr[msg]; j++)
+			{
+				const size_t seg_len = (j + 1 < msgs_segs_nr[msg] ? TEST_MSS :
+				                        payload_len - payload_offset);
+				const uint8_t tcp_flags =
+					TEST_TCP_ACK | ((j + 1) == msgs_segs_nr[msg] ? TEST_TCP_PSH : 0);
+				uint8_t seg_buffer[TEST_SEG_MAX_LEN];
+				struct rohc_buf seg = rohc_buf_init_empty(seg_buffer,
+				                                          TEST_SEG_MAX_LEN);
+				rohc_status_t status;
+
+				seg.time = arrival_time;
+				seg.len = gen_tcp_packet(is_ipv6, ip_id + j, seq_num + payload_offset,
+				                         tcp_flags, 0x01020304 + msg_id,
+				                         stream_offset + payload_offset, seg_len,
+				                         seg_buffer);
+
+				memset(&rohc_packets[packets_nr], 0, sizeof(struct rohc_buf));
+				rohc_packets[packets_nr].data = rohc_buffers[packets_nr];
+				rohc_packets[packets_nr].max_len = TEST_ROHC_MAX_LEN;
+				rohc_packets[packets_nr].time = arrival_time;
+				status = rohc_compress4(comp, seg, &rohc_packets[packets_nr]);
+				if(status != ROHC_STATUS_OK)
+				{
+					fprintf(stderr, "\tfailed to compress segment #%zu of message "
+					        "#%zu\n", j + 1, msg_id + 1);
+					goto destroy_decomp;
+				}
+				packets_nr++;
+				payload_offset += seg_len;
+			}
+
+			ip_id += msgs_segs_nr[msg];
+			seq_num += payload_len;
+			stream_offset += payload_len;
+		}
+
+		/* decompress and coalesce the burst */
+		for(j = 0; j < packets_nr; j++)
+		{
+			memset(&uncomp_packets[j], 0, sizeof(struct rohc_buf));
+			uncomp_packets[j].data = uncomp_buffers[j];
+			uncomp_packets[j].max_len = TEST_MSG_MAX_LEN;
+		}
+		if(!rohc_decompress_gro(decomp, rohc_packets, packets_nr, uncomp_packets,
+		                        infos, &uncomp_nr, NULL, NULL, statuses))
+		{
+			fprintf(stderr, "\tfailed to decompress burst #%zu\n", i + 1);
+			goto destroy_decomp;
+		}
+		for(j = 0; j < packets_nr; j++)
+		{
+			if(statuses[j] != ROHC_STATUS_OK)
+			{
+				fprintf(stderr, "\tfailed to decompress packet #%zu of burst "
+				        "#%zu\n", j + 1, i + 1);
+				goto destroy_decomp;
+			}
+		}
+		if(uncomp_nr != TEST_MSGS_NR)
+		{
+			fprintf(stderr, "\tthe %zu segments of burst #%zu were coalesced "
+			        "into %zu packets instead of %u\n", packets_nr, i + 1,
+			        uncomp_nr, TEST_MSGS_NR);
+			goto destroy_decomp;
+		}
+
+		/* every message is one large packet, the one Linux builds */
+		for(msg = 0; msg < TEST_MSGS_NR; msg++)
+		{
+			const size_t msg_id = i * TEST_MSGS_NR + msg;
+			const size_t seg_len = (msgs_segs_nr[msg] > 1 ? TEST_MSS :
+			                        msgs_payload_len[msg]);
+			uint8_t msg_buffer[TEST_MSG_MAX_LEN];
+			size_t msg_len;
+
+			msg_len = gen_tcp_packet(is_ipv6, msg_ip_id, msg_seq_num,
+			                         TEST_TCP_ACK | TEST_TCP_PSH,
+			                         0x01020304 + msg_id, msg_offset,
+			                         msgs_payload_len[msg], msg_buffer);
+			if(uncomp_packets[msg].len != msg_len ||
+			   memcmp(rohc_buf_data(uncomp_packets[msg]), msg_buffer,
+			          msg_len) != 0)
+			{
+				fprintf(stderr, "\tlarge packet #%zu of burst #%zu does not "
+				        "match the packet built by Linux\n", msg + 1, i + 1);
+				goto destroy_decomp;
+			}
+			if(infos[msg].segs_nr != msgs_segs_nr[msg] ||
+			   infos[msg].seg_len != seg_len)
+			{
+				fprintf(stderr, "\tlarge packet #%zu of burst #%zu is made of "
+				        "%zu segments of %zu bytes instead of %zu segments of "
+				        "%zu bytes\n", msg + 1, i + 1, infos[msg].segs_nr,
+				        infos[msg].seg_len, msgs_segs_nr[msg], seg_len);
+				goto destroy_decomp;
+			}
+
+			msg_ip_id += msgs_segs_nr[msg];
+			msg_seq_num += msgs_payload_len[msg];
+			msg_offset += msgs_payload_len[msg];
+		}
+
+		segs_total += packets_nr;
+	}
+
+	fprintf(stderr, "\t%zu segments decompressed and coalesced into %u "
+	        "packets\n", segs_total, TEST_BURSTS_NR * TEST_MSGS_NR);
+	is_failure = 0;
+
+destroy_decomp:
+	rohc_decomp_free(decomp);
+destroy_comp:
+	rohc_comp_free(comp);
+error:
+	return is_failure;
+}
+
+
+/**
+ * @brief Generate one IP/TCP packet of the stream
+ *
+ * The IP addresses, the TCP ports, the TCP ACK number and window are
+ * constant. The TCP header holds the NOP, NOP and Timestamp options. The
+ * payload is a slice of the byte stream of the connection. The IPv4 and TCP
+ * checksums are computed.
+ *
+ * @param is_ipv6         Whether the IP header is IPv6 or IPv4
+ * @param ip_id           The IPv4 ID, ignored for IPv6
+ * @param seq_num         The TCP sequence number
+ * @param tcp_flags       The TCP flags
+ * @param ts              The TCP timestamp value
+ * @param payload_offset  The offset of the payload in the byte stream
+ * @param payload_len     The length of the payload
+ * @param pkt             OUT: The generated IP packet
+ * @return                The length of the generated IP packet
+ */
+static size_t gen_tcp_packet(const bool is_ipv6,
+                             const uint16_t ip_id,
+                             const uint32_t seq_num,
+                             const uint8_t tcp_flags,
+                             const uint32_t ts,
+                             const size_t payload_offset,
+                             const size_t payload_len,
+                             uint8_t *const pkt)
+{
+	const size_t tcp_len = TEST_TCP_HDR_LEN + payload_len;
+	uint8_t pseudo_hdr[40];
+	size_t pseudo_hdr_len;
+	size_t ip_hdr_len;
+	uint8_t *tcp;
+	uint32_t sum;
+	size_t i;
+
+	if(is_ipv6)
+	{
+		ip_hdr_len = 40;
+		memset(pkt, 0, ip_hdr_len);
+		pkt[0] = 0x60; /* version 6 */
+		pkt[4] = (tcp_len >> 8) & 0xff;
+		pkt[5] = tcp_len & 0xff;
+		pkt[6] = 6; /* TCP */
+		pkt[7] = 64;
+		pkt[8] = 0x20;
+		pkt[9] = 0x01;
+		pkt[23] = 0x01;
+		pkt[24] = 0x20;
+		pkt[25] = 0x01;
+		pkt[39] = 0x02;
+
+		memcpy(pseudo_hdr, pkt + 8, 32);
+		pseudo_hdr[32] = 0;
+		pseudo_hdr[33] = 0;
+		pseudo_hdr[34] = (tcp_len >> 8) & 0xff;
+		pseudo_hdr[35] = tcp_len & 0xff;
+		pseudo_hdr[36] = 0;
+		pseudo_hdr[37] = 0;
+		pseudo_hdr[38] = 0;
+		pseudo_hdr[39] = 6; /* TCP */
+		pseudo_hdr_len = 40;
+	}
+	else
+	{
+		uint16_t ip_csum;
+
+		ip_hdr_len = 20;
+		memset(pkt, 0, ip_hdr_len);
+		pkt[0] = 0x45; /* version 4, no option */
+		pkt[2] = ((ip_hdr_len + tcp_len) >> 8) & 0xff;
+		pkt[3] = (ip_hdr_len + tcp_len) & 0xff;
+		pkt[4] = (ip_id >> 8) & 0xff;
+		pkt[5] = ip_id & 0xff;
+		pkt[6] = 0x40; /* DF */
+		pkt[8] = 64;
+		pkt[9] = 6; /* TCP */
+		pkt[12] = 10;
+		pkt[15] = 1;
+		pkt[16] = 10;
+		pkt[19] = 2;
+		ip_csum = ~csum_fold(csum_sum(pkt, ip_hdr_len));
+		pkt[10] = (ip_csum >> 8) & 0xff;
+		pkt[11] = ip_csum & 0xff;
+
+		memcpy(pseudo_hdr, pkt + 12, 8);
+		pseudo_hdr[8] = 0;
+		pseudo_hdr[9] = 6; /* TCP */
+		pseudo_hdr[10] = (tcp_len >> 8) & 0xff;
+		pseudo_hdr[11] = tcp_len & 0xff;
+		pseudo_hdr_len = 12;
+	}
+
+	tcp = pkt + ip_hdr_len;
+	memset(tcp, 0, TEST_TCP_HDR_LEN);
+	tcp[0] = 0x13; /* source port 5000 */
+	tcp[1] = 0x88;
+	tcp[3] = 80; /* destination port 80 */
+	tcp[4] = (seq_num >> 24) & 0xff;
+	tcp[5] = (seq_num >> 16) & 0xff;
+	tcp[6] = (seq_num >> 8) & 0xff;
+	tcp[7] = seq_num & 0xff;
+	tcp[9] = 0x01; /* ACK number 0x00010000 */
+	tcp[12] = (TEST_TCP_HDR_LEN / 4) << 4;
+	tcp[13] = tcp_flags;
+	tcp[14] = 0x20; /* window 0x2000 */
+	tcp[20] = 0x01; /* NOP */
+	tcp[21] = 0x01; /* NOP */
+	tcp[22] = 0x08; /* Timestamp */
+	tcp[23] = 10;
+	tcp[24] = (ts >> 24) & 0xff;
+	tcp[25] = (ts >> 16) & 0xff;
+	tcp[26] = (ts >> 8) & 0xff;
+	tcp[27] = ts & 0xff;
+	tcp[31] = 0x01; /* echo reply 1 */
+
+	for(i = 0; i < payload_len; i++)
+	{
+		tcp[TEST_TCP_HDR_LEN + i] = ((payload_offset + i) * 7) & 0xff;
+	}
+
+	sum = csum_sum(pseudo_hdr, pseudo_hdr_len) + csum_sum(tcp, tcp_len);
+	sum = (uint16_t) ~csum_fold(sum);
+	tcp[16] = (sum >> 8) & 0xff;
+	tcp[17] = sum & 0xff;
+
+	return ip_hdr_len + tcp_len;
+}
+
+
+/**
+ * @brief Compute the one's complement sum of the given data, not folded
+ *
+ * @param data  The data to sum
+ * @param len   The length of the data
+ * @return      The sum of the 16-bit big-endian words of the data
+ */
+static uint32_t csum_sum(const uint8_t *const data, const size_t len)
+{
+	uint32_t sum = 0;
+	size_t i;
+
+	for(i = 0; (i + 1) < len; i += 2)
+	{
+		sum += (data[i] << 8) | data[i + 1];
+	}
+	if((len % 2) != 0)
+	{
+		sum += data[len - 1] << 8;
+	}
+
+	return sum;
+}
+
+
+/**
+ * @brief Fold a 32-bit one's complement sum into 16 bits
+ *
+ * @param sum  The 32-bit sum
+ * @return     The 16-bit sum
+ */
+static uint16_t csum_fold(uint32_t sum)
+{
+	while((sum >> 16) != 0)
+	{
+		sum = (sum & 0xffff) + (sum >> 16);
+	}
+	return sum;
+}
+
+
+/**
+ * @brief Callback to print traces of the ROHC library
+ *
+ * @param priv_ctxt  An optional private context, may be NULL
+ * @param level      The priority level of the trace
+ * @param entity     The entity that emitted the trace among:
+ *                    \li ROHC_TRACE_COMP
+ *                    \li ROHC_TRACE_DECOMP
+ * @param profile    The ID of the ROHC compression/decompression profile
+ *                   the trace is related to
+ * @param format     The format string of the trace
+ */
+static void print_rohc_traces(void *const priv_ctxt,
+                              const rohc_trace_level_t level,
+                              const rohc_trace_entity_t entity,
+                              const int profile,
+                              const char *const format,
+                              ...)
+{
+	va_list args;
+
+	va_start(args, format);
+	vfprintf(stdout, format, args);
+	va_end(args);
+}
+
+
+/**
+ * @brief Generate a random number
+ *
+ * @param comp          The ROHC compressor
+ * @param user_context  Should always be NULL
+ * @return              A random number
+ */
+static int gen_random_num(const struct rohc_comp *const comp,
+                          void *const user_context)
+{
+	assert(comp != NULL);
+	assert(user_context == NULL);
+	return rand();
+}
@@ -0,0 +1,603 @@
+/*
+ * Copyright 2026 Didier Barvaux
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/**
+ * @file   test_ir_refresh.c
+ * @brief  Check that the IR refreshes are decompressed right, whether their
+ *         static chain is the one of the context or not
+ * @author Didier Barvaux <didier@barvaux.org>
+ *
+ * The decompressor skips the static chain of the IR packets that repeat the
+ * static chain of the previous IR packet of the context. The application
+ * compresses flows with frequent periodic IR refreshes, and checks that
+ * every decompressed packet is the original one, byte for byte:
+ *  - with the same static chain in all the IR packets of a context, for the
+ *    IP/UDP and the TCP profiles,
+ *  - with a static chain that changes because the only context is given to
+ *    another flow,
+ *  - with a static chain longer than 128 bytes, that the decompressor does
+ *    not keep.
+ *
+ * When the library is built with the debug traces, the application also
+ * checks that the static chain was skipped in every IR refresh that repeats
+ * the previous static chain of the context and that is not longer than
+ * 128 bytes, and in no other IR packet.
+ */
+
+#include "test.h"
+#include "config.h" /* for HAVE_*_H */
+
+/* system includes */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <stdarg.h>
+
+/* ROHC includes */
+#include <rohc.h>
+#include <rohc_comp.h>
+#include <rohc_decomp.h>
+
+
+/** The number of IPv6 headers of the tunneled flows */
+#define TEST_IPV6_TUNNELS_NR  4U
+
+/** The length of the payload of the packets */
+#define TEST_PAYLOAD_LEN  20U
+
+/** The max length of the packets */
+#define TEST_PKT_MAX_LEN  (TEST_IPV6_TUNNELS_NR * 40U + 20U + TEST_PAYLOAD_LEN)
+
+/** The max length of the ROHC packets */
+#define TEST_ROHC_MAX_LEN  (TEST_PKT_MAX_LEN * 2)
+
+/** The max number of steps of a scenario */
+#define TEST_STEPS_MAX  6U
+
+
+/** The types of the flows of the test */
+typedef enum
+{
+	TEST_FLOW_UDP_IPV4,          /**< IPv4/UDP, the IP/UDP profile */
+	TEST_FLOW_TCP_IPV4,          /**< IPv4/TCP, the TCP profile */
+	TEST_FLOW_TCP_IPV6_TUNNELS,  /**< IPv6 tunnels/TCP, static chain > 128 */
+} test_flow_t;
+
+
+/** Some packets of one flow */
+struct test_step
+{
+	test_flow_t flow;  /**< The type of the flow */
+	uint16_t port;     /**< The source port, that identifies the flow */
+	size_t pkts_nr;    /**< The number of packets of the flow */
+};
+
+
+/** One scenario of the test */
+struct test_scenario
+{
+	const char *descr;                      /**< The description */
+	rohc_cid_t max_cid;                     /**< The largest CID */
+	size_t steps_nr;                        /**< The number of steps */
+	struct test_step steps[TEST_STEPS_MAX]; /**< The steps */
+};
+
+
+/** The traces of the decompressor that the test counts */
+struct test_traces
+{
+	size_t debug_nr;  /**< The number of debug traces */
+	size_t skips_nr;  /**< The number of static chains skipped */
+};
+
+
+/* prototypes of private functions */
+static void usage(void);
+static int test_scenario(const struct test_scenario *const scenario);
+static size_t gen_packet(const test_flow_t flow,
+                         const uint16_t port,
+                         const uint32_t sn,
+                         uint8_t *const pkt);
+static void print_rohc_traces(void *const priv_ctxt,
+                              const rohc_trace_level_t level,
+                              const rohc_trace_entity_t entity,
+                              const int profile,
+                              const char *const format,
+                              ...)
+	__attribute__((format(printf, 5, 6), nonnull(5)));
+static void count_decomp_traces(void *const priv_ctxt,
+                                const rohc_trace_level_t level,
+                                const rohc_trace_entity_t entity,
+                                const int profile,
+                                const char *const format,
+                                ...)
+	__attribute__((format(printf, 5, 6), nonnull(1, 5)));
+static int gen_random_num(const struct rohc_comp *const comp,
+                          void *const user_context)
+	__attribute__((nonnull(1)));
+
+
+/** The scenarios of the test */
+static const struct test_scenario test_scenarios[] =
+{
+	{
+		.descr = "same static chain in all the IR packets",
+		.max_cid = ROHC_SMALL_CID_MAX,
+		.steps_nr = 2,
+		.steps = {
+			{ .flow = TEST_FLOW_UDP_IPV4, .port = 1000, .pkts_nr = 30 },
+			{ .flow = TEST_FLOW_TCP_IPV4, .port = 1000, .pkts_nr = 30 },
+		},
+	},
+	{
+		.descr = "static chain changed by the flows that share one context",
+		.max_cid = 0,
+		.steps_nr = 6,
+		.steps = {
+			{ .flow = TEST_FLOW_UDP_IPV4, .port = 1000, .pkts_nr = 10 },
+			{ .flow = TEST_FLOW_UDP_IPV4, .port = 2000, .pkts_nr = 10 },
+			{ .flow = TEST_FLOW_UDP_IPV4, .port = 1000, .pkts_nr = 10 },
+			{ .flow = TEST_FLOW_TCP_IPV4, .port = 1000, .pkts_nr = 10 },
+			{ .flow = TEST_FLOW_TCP_IPV4, .port = 2000, .pkts_nr = 10 },
+			{ .flow = TEST_FLOW_TCP_IPV4, .port = 1000, .pkts_nr = 10 },
+		},
+	},
+	{
+		.descr = "static chain longer than 128 bytes",
+		.max_cid = ROHC_SMALL_CID_MAX,
+		.steps_nr = 1,
+		.steps = {
+			{ .flow = TEST_FLOW_TCP_IPV6_TUNNELS, .port = 1000, .pkts_nr = 30 },
+		},
+	},
+};
+
+
+/**
+ * @brief Check that the IR refreshes are decompressed right, whether their
+ *        static chain is the one of the context or not
+ *
+ * @param argc The number of program arguments
+ * @param argv The program arguments
+ * @return     The unix return code:
+ *              \li 0 in case of success,
+ *              \li 1 in case of failure
+ */
+int main(int argc, char *argv[])
+{
+	int status = 1;
+	size_t i;
+
+	/* parse program arguments, print the help message in case of failure */
+	if(argc != 1)
+	{
+		usage();
+		goto error;
+	}
+
+	/* initialize the random generator with the same number to ease debugging */
+	srand(4 /* chosen by fair dice roll, guaranteed to be random */);
+
+	for(i = 0; i < (sizeof(test_scenarios) / sizeof(struct test_scenario)); i++)
+	{
+		if(test_scenario(&test_scenarios[i]) != 0)
+		{
+			goto error;
+		}
+	}
+
+	status = 0;
+
+error:
+	return status;
+}
+
+
+/**
+ * @brief Print usage of the application
+ */
+static void usage(void)
+{
+	fprintf(stderr,
+	        "Check that the IR refreshes are decompressed right, whether their\n"
+	        "static chain is the one of the context or not\n"
+	        "\n"
+	        "usage: test_ir_refresh [OPTIONS]\n"
+	        "\n"
+	        "options:\n"
+	        "  -h           Print this usage and exit\n");
+}
+
+
+/**
+ * @brief Compress and decompress the flows of one scenario
+ *
+ * @param scenario  The scenario
+ * @return          0 in case of success,
+ *                  1 in case of failure
+ */
+static int test_scenario(const struct test_scenario *const scenario)
+{
+	const struct rohc_ts arrival_time = { .sec = 0, .nsec = 0 };
+	struct test_traces traces = { .debug_nr = 0, .skips_nr = 0 };
+	struct rohc_comp *comp;
+	struct rohc_decomp *decomp;
+	size_t irs_nr = 0;
+	size_t skips_expected_nr = 0;
+	uint32_t sn = 0;
+	int is_failure = 1;
+	size_t i;
+
+	fprintf(stderr, "test %s\n", scenario->descr);
+
+	/* create the ROHC compressor with small CID, with frequent IR refreshes */
+	comp = rohc_comp_new2(ROHC_SMALL_CID, scenario->max_cid,
+	                      gen_random_num, NULL);
+	if(comp == NULL)
+	{
+		fprintf(stderr, "failed to create the ROHC compressor\n");
+		goto error;
+	}
+	if(!rohc_comp_set_traces_cb2(comp, print_rohc_traces, NULL))
+	{
+		fprintf(stderr, "failed to set the callback for traces on "
+		        "compressor\n");
+		goto destroy_comp;
+	}
+	if(!rohc_comp_enable_profiles(comp, ROHC_PROFILE_UNCOMPRESSED,
+	                              ROHC_PROFILE_UDP, ROHC_PROFILE_IP,
+	                              ROHC_PROFILE_TCP, -1))
+	{
+		fprintf(stderr, "failed to enable the compression profiles\n");
+		goto destroy_comp;
+	}
+	if(!rohc_comp_set_periodic_refreshes(comp, 4, 2))
+	{
+		fprintf(stderr, "failed to set the periodic refreshes\n");
+		goto destroy_comp;
+	}
+
+	/* create the ROHC decompressor in unidirectional mode */
+	decomp = rohc_decomp_new2(ROHC_SMALL_CID, scenario->max_cid, ROHC_U_MODE);
+	if(decomp == NULL)
+	{
+		fprintf(stderr, "failed to create the ROHC decompressor\n");
+		goto destroy_comp;
+	}
+	if(!rohc_decomp_set_traces_cb2(decomp, count_decomp_traces, &traces))
+	{
+		fprintf(stderr, "failed to set the callback for traces on "
+		        "decompressor\n");
+		goto destroy_decomp;
+	}
+	if(!rohc_decomp_enable_profiles(decomp, ROHC_PROFILE_UNCOMPRESSED,
+	                                ROHC_PROFILE_UDP, ROHC_PROFILE_IP,
+	                                ROHC_PROFILE_TCP, -1))
+	{
+		fprintf(stderr, "failed to enable the decompression profiles\n");
+		goto destroy_decomp;
+	}
+
+	for(i = 0; i < scenario->steps_nr; i++)
+	{
+		const struct test_step *const step = &scenario->steps[i];
+		size_t j;
+
+		for(j = 0; j < step->pkts_nr; j++)
+		{
+			uint8_t ip_buffer[TEST_PKT_MAX_LEN];
+			struct rohc_buf ip_packet =
+				rohc_buf_init_empty(ip_buffer, TEST_PKT_MAX_LEN);
+			uint8_t rohc_buffer[TEST_ROHC_MAX_LEN];
+			struct rohc_buf rohc_packet =
+				rohc_buf_init_empty(rohc_buffer, TEST_ROHC_MAX_LEN);
+			uint8_t uncomp_buffer[TEST_PKT_MAX_LEN];
+			struct rohc_buf uncomp_packet =
+				rohc_buf_init_empty(uncomp_buffer, TEST_PKT_MAX_LEN);
+			rohc_comp_last_packet_info2_t info;
+			rohc_status_t status;
+
+			ip_packet.time = arrival_time;
+			ip_packet.len = gen_packet(step->flow, step->port, sn, ip_buffer);
+			sn++;
+
+			/* compress the packet */
+			status = rohc_compress4(comp, ip_packet, &rohc_packet);
+			if(status != ROHC_STATUS_OK)
+			{
+				fprintf(stderr, "\tfailed to compress packet #%zu of step #%zu\n",
+				        j + 1, i + 1);
+				goto destroy_decomp;
+			}
+			memset(&info, 0, sizeof(rohc_comp_last_packet_info2_t));
+			info.version_major = 0;
+			info.version_minor = 0;
+			if(!rohc_comp_get_last_packet_info2(comp, &info))
+			{
+				fprintf(stderr, "\tfailed to get information about packet #%zu "
+				        "of step #%zu\n", j + 1, i + 1);
+				goto destroy_decomp;
+			}
+
+			/* the static chain of an IR packet is skipped if it repeats the
+			 * previous one of the context, and if it is short enough to be
+			 * kept by the decompressor */
+			if(info.packet_type == ROHC_PACKET_IR)
+			{
+				irs_nr++;
+				if(!info.is_context_init &&
+				   step->flow != TEST_FLOW_TCP_IPV6_TUNNELS)
+				{
+					skips_expected_nr++;
+				}
+			}
+
+			/* decompress the ROHC packet, it shall be the original packet */
+			rohc_packet.time = arrival_time;
+			status = rohc_decompress3(decomp, rohc_packet, &uncomp_packet,
+			                          NULL, NULL);
+			if(status != ROHC_STATUS_OK)
+			{
+				fprintf(stderr, "\tfailed to decompress packet #%zu of step "
+				        "#%zu\n", j + 1, i + 1);
+				goto destroy_decomp;
+			}
+			if(uncomp_packet.len != ip_packet.len ||
+			   memcmp(rohc_buf_data(uncomp_packet), ip_buffer,
+			          ip_packet.len) != 0)
+			{
+				fprintf(stderr, "\tpacket #%zu of step #%zu was not decompressed "
+				        "right\n", j + 1, i + 1);
+				goto destroy_decomp;
+			}
+		}
+	}
+
+	fprintf(stderr, "\t%u packets with %zu IR packets decompressed right\n",
+	        sn, irs_nr);
+	if(irs_nr <= scenario->steps_nr)
+	{
+		fprintf(stderr, "\tno IR refresh was sent\n");
+		goto destroy_decomp;
+	}
+
+	/* the fast path of the decompressor is observed with debug traces only */
+	if(traces.debug_nr == 0)
+	{
+		fprintf(stderr, "\tlibrary built without debug traces, skipped IR "
+		        "static chains not checked\n");
+	}
+	else if(traces.skips_nr != skips_expected_nr)
+	{
+		fprintf(stderr, "\tstatic chain skipped in %zu IR packets instead of "
+		        "%zu\n", traces.skips_nr, skips_expected_nr);
+		goto destroy_decomp;
+	}
+	else
+	{
+		fprintf(stderr, "\tstatic chain skipped in %zu IR packets as "
+		        "expected\n", traces.skips_nr);
+	}
+
+	is_failure = 0;
+
+destroy_decomp:
+	rohc_decomp_free(decomp);
+destroy_comp:
+	rohc_comp_free(comp);
+error:
+	return is_failure;
+}
+
+
+/**
+ * @brief Generate one packet of a flow
+ *
+ * The IP addresses, the ports but the source port, the IPv6 Flow Labels and
+ * the TCP ACK number and window are constant. The IPv4 ID, the TCP sequence
+ * number and the payload change with the sequence number of the packet.
+ *
+ * @param flow  The type of the flow
+ * @param port  The source port of the flow
+ * @param sn    The sequence number of the packet
+ * @param pkt   OUT: The generated IP packet
+ * @return      The length of the generated IP packet
+ */
+static size_t gen_packet(const test_flow_t flow,
+                         const uint16_t port,
+                         const uint32_t sn,
+                         uint8_t *const pkt)
+{
+	const size_t l4_hdr_len = (flow == TEST_FLOW_UDP_IPV4 ? 8 : 20);
+	const size_t ip_hdrs_len =
+		(flow == TEST_FLOW_TCP_IPV6_TUNNELS ? TEST_IPV6_TUNNELS_NR * 40 : 20);
+	const size_t pkt_len = ip_hdrs_len + l4_hdr_len + TEST_PAYLOAD_LEN;
+	uint8_t *const l4 = pkt + ip_hdrs_len;
+	size_t i;
+
+	memset(pkt, 0, pkt_len);
+
+	if(flow == TEST_FLOW_TCP_IPV6_TUNNELS)
+	{
+		for(i = 0; i < TEST_IPV6_TUNNELS_NR; i++)
+		{
+			uint8_t *const ipv6 = pkt + i * 40;
+			const size_t plen = pkt_len - (i + 1) * 40;
+
+			ipv6[0] = 0x60; /* version 6 */
+			ipv6[4] = (plen >> 8) & 0xff;
+			ipv6[5] = plen & 0xff;
+			ipv6[6] = ((i + 1) < TEST_IPV6_TUNNELS_NR ? 41 /* IPv6 */ : 6 /* TCP */);
+			ipv6[7] = 64;
+			ipv6[8] = 0x20; /* source 2001:db8::<tunnel>:1 */
+			ipv6[9] = 0x01;
+			ipv6[10] = 0x0d;
+			ipv6[11] = 0xb8;
+			ipv6[21] = i;
+			ipv6[23] = 1;
+			ipv6[24] = 0x20; /* destination 2001:db8::<tunnel>:2 */
+			ipv6[25] = 0x01;
+			ipv6[26] = 0x0d;
+			ipv6[27] = 0xb8;
+			ipv6[37] = i;
+			ipv6[39] = 2;
+		}
+	}
+	else
+	{
+		uint32_t sum = 0;
+
+		pkt[0] = 0x45; /* version 4, no option */
+		pkt[2] = (pkt_len >> 8) & 0xff;
+		pkt[3] = pkt_len & 0xff;
+		pkt[4] = (sn >> 8) & 0xff;
+		pkt[5] = sn & 0xff;
+		pkt[6] = 0x40; /* DF */
+		pkt[8] = 64;
+		pkt[9] = (flow == TEST_FLOW_UDP_IPV4 ? 17 /* UDP */ : 6 /* TCP */);
+		pkt[12] = 192;
+		pkt[13] = 168;
+		pkt[15] = 1;
+		pkt[16] = 192;
+		pkt[17] = 168;
+		pkt[19] = 2;
+		for(i = 0; i < 20; i += 2)
+		{
+			sum += (pkt[i] << 8) | pkt[i + 1];
+		}
+		while((sum >> 16) != 0)
+		{
+			sum = (sum & 0xffff) + (sum >> 16);
+		}
+		pkt[10] = (~sum >> 8) & 0xff;
+		pkt[11] = ~sum & 0xff;
+	}
+
+	l4[0] = (port >> 8) & 0xff;
+	l4[1] = port & 0xff;
+	if(flow == TEST_FLOW_UDP_IPV4)
+	{
+		/* UDP header without checksum */
+		l4[3] = 53;
+		l4[4] = ((l4_hdr_len + TEST_PAYLOAD_LEN) >> 8) & 0xff;
+		l4[5] = (l4_hdr_len + TEST_PAYLOAD_LEN) & 0xff;
+	}
+	else
+	{
+		const uint32_t seq_num = 0x10000 + sn * TEST_PAYLOAD_LEN;
+
+		/* TCP header, the checksum is transmitted as it is */
+		l4[3] = 80;
+		l4[4] = (seq_num >> 24) & 0xff;
+		l4[5] = (seq_num >> 16) & 0xff;
+		l4[6] = (seq_num >> 8) & 0xff;
+		l4[7] = seq_num & 0xff;
+		l4[10] = 0x01; /* ACK number 0x00000100 */
+		l4[12] = (l4_hdr_len / 4) << 4;
+		l4[13] = 0x10; /* ACK */
+		l4[14] = 0x20; /* window 0x2000 */
+		l4[16] = (sn >> 8) & 0xff;
+		l4[17] = sn & 0xff;
+	}
+
+	for(i = 0; i < TEST_PAYLOAD_LEN; i++)
+	{
+		l4[l4_hdr_len + i] = (sn + i) & 0xff;
+	}
+
+	return pkt_len;
+}
+
+
+/**
+ * @brief Callback to print traces of the ROHC library
+ *
+ * @param priv_ctxt  An optional private context, may be NULL
+ * @param level      The priority level of the trace
+ * @param entity     The entity that emitted the trace among:
+ *                    \li ROHC_TRACE_COMP
+ *                    \li ROHC_TRACE_DECOMP
+ * @param profile    The ID of the ROHC compression/decompression profile
+ *                   the trace is related to
+ * @param format     The format string of the trace
+ */
+static void print_rohc_traces(void *const priv_ctxt,
+                              const rohc_trace_level_t level,
+                              const rohc_trace_entity_t entity,
+                              const int profile,
+                              const char *const format,
+                              ...)
+{
+	va_list args;
+
+	va_start(args, format);
+	vfprintf(stdout, format, args);
+	va_end(args);
+}
+
+
+/**
+ * @brief Callback to print and count the traces of the decompressor
+ *
+ * @param priv_ctxt  The traces counted by the test
+ * @param level      The priority level of the trace
+ * @param entity     The entity that emitted the trace
+ * @param profile    The ID of the ROHC decompression profile the trace is
+ *                   related to
+ * @param format     The format string of the trace
+ */
+static void count_decomp_traces(void *const priv_ctxt,
+                                const rohc_trace_level_t level,
+                                const rohc_trace_entity_t entity,
+                                const int profile,
+                                const char *const format,
+                                ...)
+{
+	struct test_traces *const traces = priv_ctxt;
+	va_list args;
+
+	if(level == ROHC_TRACE_DEBUG)
+	{
+		traces->debug_nr++;
+	}
+	if(strstr(format, "static chain is the one of the context") != NULL)
+	{
+		traces->skips_nr++;
+	}
+
+	va_start(args, format);
+	vfprintf(stdout, format, args);
+	va_end(args);
+}
+
+
+/**
+ * @brief Generate a random number
+ *
+ * @param comp          The ROHC compressor
+ * @param user_context  Should always be NULL
+ * @return              A random number
+ */
+static int gen_random_num(const struct rohc_comp *const comp,
+                          void *const user_context)
+{
+	assert(comp != NULL);
+	assert(user_context == NULL);
+	return rand();
+}
@@ -0,0 +1,86 @@
+#!/bin/sh
+#
+# Copyright 2026 Didier Barvaux
+#
+# This library is free software; you can redistribute it and/or
+# modify it under the terms of the GNU Lesser General Public
+# License as published by the Free Software Foundation; either
+# version 2.1 of the License, or (at your option) any later version.
+#
+# This library is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+# Lesser General Public License for more details.
+#
+# You should have received a copy of the GNU Lesser General Public
+# License along with this library; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+#
+
+#
+# file:        test_ir_refresh.sh
+# description: Check that the IR refreshes are decompressed right, whether
+#              their static chain is the one of the context or not
+# author:      Didier Barvaux <didier@barvaux.org>
+#
+# Script arguments:
+#    test_ir_refresh.sh [verbose [verbose]]
+# where:
+#   verbose          prints the traces of test application
+#   verbose          prints the traces of test application and the ones of
+#                    the ROHC library
+#
+
+# skip test in case of cross-compilation
+if [ "${CROSS_COMPILATION}" = "yes" ] && \
+   [ -z "${CROSS_COMPILATION_EMULATOR}" ] ; then
+	exit 77
+fi
+
+test -z "${SED}" && SED="`which sed`"
+test -z "${GREP}" && GREP="`which grep`"
+test -z "${AWK}" && AWK="`which gawk`"
+test -z "${AWK}" && AWK="`which awk`"
+
+# parse arguments
+SCRIPT="$0"
+VERBOSE="$1"
+VERY_VERBOSE="$2"
+if [ "x$MAKELEVEL" != "x" ] ; then
+	BASEDIR="${srcdir}"
+	APP="./test_ir_refresh${CROSS_COMPILATION_EXEEXT}"
+else
+	BASEDIR=$( dirname "${SCRIPT}" )
+	APP="${BASEDIR}/test_ir_refresh${CROSS_COMPILATION_EXEEXT}"
+fi
+
+# no argument
+CMD="${CROSS_COMPILATION_EMULATOR} ${APP}"
+
+# source valgrind-related functions
+. ${BASEDIR}/../../valgrind.sh
+
+# run without valgrind in verbose mode or quiet mode
+if [ "${VERBOSE}" = "verbose" ] ; then
+	if [ "${VERY_VERBOSE}" = "verbose" ] ; then
+		run_test_without_valgrind ${CMD} || exit $?
+	else
+		run_test_without_valgrind ${CMD} > /dev/null || exit $?
+	fi
+else
+	run_test_without_valgrind ${CMD} > /dev/null 2>&1 || exit $?
+fi
+
+[ "${USE_VALGRIND}" != "yes" ] && exit 0
+
+# run with valgrind in verbose mode or quiet mode
+if [ "${VERBOSE}" = "verbose" ] ; then
+	if [ "${VERY_VERBOSE}" = "verbose" ] ; then
+		run_test_with_valgrind ${BASEDIR}/../../valgrind.xsl ${CMD} || exit $?
+	else
+		run_test_with_valgrind ${BASEDIR}/../../valgrind.xsl ${CMD} >/dev/null || exit $?
+	fi
+else
+	run_test_with_valgrind ${BASEDIR}/../../valgrind.xsl ${CMD} > /dev/null 2>&1 || exit $?
+fi
+
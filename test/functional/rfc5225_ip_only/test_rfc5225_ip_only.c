@@ -0,0 +1,447 @@
+/*
+ * Copyright 2016 Didier Barvaux
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/**
+ * @file   test_rfc5225_ip_only.c
+ * @brief  Check that the ROHCv2 IP-only profile decompresses what it compresses
+ * @author Didier Barvaux <didier@barvaux.org>
+ *
+ * The application compresses streams of IPv4 and IPv6 packets with the
+ * ROHCv2 IP-only profile, decompresses them in U-mode, and checks that the
+ * decompressed packets are the original ones, byte for byte. The streams are
+ * chosen so that every packet type of the profile is used at least once:
+ * large WLSB windows require more MSN bits, IP-ID jumps require the IP-ID
+ * offset, and some ROHC packets are lost before the decompressor.
+ */
+
+#include "test.h"
+#include "config.h" /* for HAVE_*_H */
+
+/* system includes */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <stdarg.h>
+
+/* ROHC includes */
+#include <rohc.h>
+#include <rohc_comp.h>
+#include <rohc_decomp.h>
+
+
+/** The number of packets in every stream */
+#define TEST_PKTS_NR  400U
+
+/** The length of the generated IP packets */
+#define TEST_IP_PKT_LEN  80U
+
+/** The max length of the ROHC and decompressed packets */
+#define TEST_MAX_PKT_LEN  (TEST_IP_PKT_LEN * 2)
+
+
+/** One stream of IP packets to compress and decompress */
+struct test_stream
+{
+	bool is_ipv6;        /**< Whether the IP header is IPv6 or IPv4 */
+	size_t wlsb_width;   /**< The width of the WLSB windows of the compressor */
+	uint16_t ip_id_jump; /**< The increase of the IPv4 ID every 37 packets */
+	size_t loss_period;  /**< Lose one ROHC packet every N packets, 0 for none */
+};
+
+
+/* prototypes of private functions */
+static void usage(void);
+static int test_comp_and_decomp(const struct test_stream *const stream,
+                                size_t pkt_types_nr[ROHC_PACKET_MAX]);
+static size_t gen_ip_packet(const struct test_stream *const stream,
+                            const size_t pkt_num,
+                            uint16_t *const ip_id,
+                            uint8_t *const ip_pkt);
+static void print_rohc_traces(void *const priv_ctxt,
+                              const rohc_trace_level_t level,
+                              const rohc_trace_entity_t entity,
+                              const int profile,
+                              const char *const format,
+                              ...)
+	__attribute__((format(printf, 5, 6), nonnull(5)));
+static int gen_random_num(const struct rohc_comp *const comp,
+                          void *const user_context)
+	__attribute__((nonnull(1)));
+
+
+/**
+ * @brief Check that the ROHCv2 IP-only profile decompresses all its packet
+ *        types as expected
+ *
+ * @param argc The number of program arguments
+ * @param argv The program arguments
+ * @return     The unix return code:
+ *              \li 0 in case of success,
+ *              \li 1 in case of failure
+ */
+int main(int argc, char *argv[])
+{
+	const struct test_stream streams[] =
+	{
+		/* small window, sequential IP-ID: pt_0_crc3 */
+		{ .is_ipv6 = false, .wlsb_width = 4, .ip_id_jump = 1, .loss_period = 0 },
+		/* small window, IP-ID jumps and losses: pt_1_seq_id */
+		{ .is_ipv6 = false, .wlsb_width = 4, .ip_id_jump = 5, .loss_period = 2 },
+		/* medium window: pt_0_crc7 */
+		{ .is_ipv6 = false, .wlsb_width = 16, .ip_id_jump = 3, .loss_period = 0 },
+		/* large window, large IP-ID jumps: pt_2_seq_id and co_common */
+		{ .is_ipv6 = false, .wlsb_width = 64, .ip_id_jump = 40, .loss_period = 3 },
+		/* IPv6 without IP-ID */
+		{ .is_ipv6 = true, .wlsb_width = 4, .ip_id_jump = 0, .loss_period = 0 },
+		{ .is_ipv6 = true, .wlsb_width = 64, .ip_id_jump = 0, .loss_period = 3 },
+	};
+	const rohc_packet_t expected_pkt_types[] =
+	{
+		ROHC_PACKET_IR,
+		ROHC_PACKET_PT_0_CRC3,
+		ROHC_PACKET_PT_0_CRC7,
+		ROHC_PACKET_PT_1_SEQ_ID,
+		ROHC_PACKET_PT_2_SEQ_ID,
+		ROHC_PACKET_CO_COMMON,
+	};
+	size_t pkt_types_nr[ROHC_PACKET_MAX] = { 0 };
+	int status = 1;
+	size_t i;
+
+	/* parse program arguments, print the help message in case of failure */
+	if(argc != 1)
+	{
+		usage();
+		goto error;
+	}
+
+	/* initialize the random generator with the same number to ease debugging */
+	srand(4 /* chosen by fair dice roll, guaranteed to be random */);
+
+	for(i = 0; i < (sizeof(streams) / sizeof(streams[0])); i++)
+	{
+		if(test_comp_and_decomp(&streams[i], pkt_types_nr) != 0)
+		{
+			goto error;
+		}
+	}
+
+	/* check that every packet type of the profile was tested */
+	for(i = 0; i < (sizeof(expected_pkt_types) / sizeof(expected_pkt_types[0])); i++)
+	{
+		const rohc_packet_t pkt_type = expected_pkt_types[i];
+
+		fprintf(stderr, "%zu %s packets compressed and decompressed\n",
+		        pkt_types_nr[pkt_type], rohc_get_packet_descr(pkt_type));
+		if(pkt_types_nr[pkt_type] == 0)
+		{
+			fprintf(stderr, "no %s packet was tested\n",
+			        rohc_get_packet_descr(pkt_type));
+			goto error;
+		}
+	}
+
+	status = 0;
+
+error:
+	return status;
+}
+
+
+/**
+ * @brief Print usage of the application
+ */
+static void usage(void)
+{
+	fprintf(stderr,
+	        "Check that the ROHCv2 IP-only profile decompresses what it "
+	        "compresses\n"
+	        "\n"
+	        "usage: test_rfc5225_ip_only [OPTIONS]\n"
+	        "\n"
+	        "options:\n"
+	        "  -h           Print this usage and exit\n");
+}
+
+
+/**
+ * @brief Compress and decompress one stream of IP packets
+ *
+ * @param stream        The stream of IP packets to test
+ * @param pkt_types_nr  IN/OUT: The number of ROHC packets per packet type
+ * @return              0 in case of success,
+ *                      1 in case of failure
+ */
+static int test_comp_and_decomp(const struct test_stream *const stream,
+                                size_t pkt_types_nr[ROHC_PACKET_MAX])
+{
+	const struct rohc_ts arrival_time = { .sec = 0, .nsec = 0 };
+	struct rohc_comp *comp;
+	struct rohc_decomp *decomp;
+	uint16_t ip_id = 0x1000;
+	int is_failure = 1;
+	size_t i;
+
+	fprintf(stderr, "test %s stream with %zu-wide WLSB windows, IP-ID jumps "
+	        "of %u and one loss every %zu packets\n",
+	        stream->is_ipv6 ? "IPv6" : "IPv4", stream->wlsb_width,
+	        stream->ip_id_jump, stream->loss_period);
+
+	/* create the ROHC compressor with small CID */
+	comp = rohc_comp_new2(ROHC_SMALL_CID, ROHC_SMALL_CID_MAX,
+	                      gen_random_num, NULL);
+	if(comp == NULL)
+	{
+		fprintf(stderr, "failed to create the ROHC compressor\n");
+		goto error;
+	}
+	if(!rohc_comp_set_traces_cb2(comp, print_rohc_traces, NULL))
+	{
+		fprintf(stderr, "failed to set the callback for traces on "
+		        "compressor\n");
+		goto destroy_comp;
+	}
+	if(!rohc_comp_enable_profiles(comp, ROHC_PROFILE_UNCOMPRESSED,
+	                              ROHCv2_PROFILE_IP, -1))
+	{
+		fprintf(stderr, "failed to enable the compression profiles\n");
+		goto destroy_comp;
+	}
+	if(!rohc_comp_set_wlsb_window_width(comp, stream->wlsb_width))
+	{
+		fprintf(stderr, "failed to set the width of the WLSB windows\n");
+		goto destroy_comp;
+	}
+
+	/* create the ROHC decompressor in uni-directional mode */
+	decomp = rohc_decomp_new2(ROHC_SMALL_CID, ROHC_SMALL_CID_MAX, ROHC_U_MODE);
+	if(decomp == NULL)
+	{
+		fprintf(stderr, "failed to create the ROHC decompressor\n");
+		goto destroy_comp;
+	}
+	if(!rohc_decomp_set_traces_cb2(decomp, print_rohc_traces, NULL))
+	{
+		fprintf(stderr, "failed to set the callback for traces on "
+		        "decompressor\n");
+		goto destroy_decomp;
+	}
+	if(!rohc_decomp_enable_profiles(decomp, ROHC_PROFILE_UNCOMPRESSED,
+	                                ROHCv2_PROFILE_IP, -1))
+	{
+		fprintf(stderr, "failed to enable the decompression profiles\n");
+		goto destroy_decomp;
+	}
+
+	for(i = 0; i < TEST_PKTS_NR; i++)
+	{
+		uint8_t ip_buffer[TEST_MAX_PKT_LEN];
+		struct rohc_buf ip_packet =
+			rohc_buf_init_empty(ip_buffer, TEST_MAX_PKT_LEN);
+		uint8_t rohc_buffer[TEST_MAX_PKT_LEN];
+		struct rohc_buf rohc_packet =
+			rohc_buf_init_empty(rohc_buffer, TEST_MAX_PKT_LEN);
+		uint8_t uncomp_buffer[TEST_MAX_PKT_LEN];
+		struct rohc_buf uncomp_packet =
+			rohc_buf_init_empty(uncomp_buffer, TEST_MAX_PKT_LEN);
+		rohc_comp_last_packet_info2_t last_pkt_info;
+		rohc_status_t status;
+
+		ip_packet.time = arrival_time;
+		ip_packet.len = gen_ip_packet(stream, i, &ip_id, ip_buffer);
+
+		/* compress the IP packet with the ROHCv2 IP-only profile */
+		status = rohc_compress4(comp, ip_packet, &rohc_packet);
+		if(status != ROHC_STATUS_OK)
+		{
+			fprintf(stderr, "\tfailed to compress IP packet #%zu\n", i + 1);
+			goto destroy_decomp;
+		}
+		memset(&last_pkt_info, 0, sizeof(rohc_comp_last_packet_info2_t));
+		last_pkt_info.version_major = 0;
+		last_pkt_info.version_minor = 0;
+		if(!rohc_comp_get_last_packet_info2(comp, &last_pkt_info))
+		{
+			fprintf(stderr, "\tfailed to get information on packet #%zu\n",
+			        i + 1);
+			goto destroy_decomp;
+		}
+		if(last_pkt_info.profile_id != ROHCv2_PROFILE_IP)
+		{
+			fprintf(stderr, "\tIP packet #%zu was compressed with profile "
+			        "0x%04x instead of the ROHCv2 IP-only profile\n", i + 1,
+			        last_pkt_info.profile_id);
+			goto destroy_decomp;
+		}
+		assert(last_pkt_info.packet_type < ROHC_PACKET_MAX);
+
+		/* lose some ROHC packets once the context is established */
+		if(stream->loss_period > 0 && i > 10 && (i % stream->loss_period) == 0)
+		{
+			continue;
+		}
+
+		/* decompress the ROHC packet and compare with the IP packet */
+		status = rohc_decompress3(decomp, rohc_packet, &uncomp_packet,
+		                          NULL, NULL);
+		if(status != ROHC_STATUS_OK)
+		{
+			fprintf(stderr, "\tfailed to decompress %s packet #%zu\n",
+			        rohc_get_packet_descr(last_pkt_info.packet_type), i + 1);
+			goto destroy_decomp;
+		}
+		if(uncomp_packet.len != ip_packet.len ||
+		   memcmp(rohc_buf_data(uncomp_packet), rohc_buf_data(ip_packet),
+		          ip_packet.len) != 0)
+		{
+			fprintf(stderr, "\tdecompressed %s packet #%zu does not match the "
+			        "original IP packet\n",
+			        rohc_get_packet_descr(last_pkt_info.packet_type), i + 1);
+			goto destroy_decomp;
+		}
+		pkt_types_nr[last_pkt_info.packet_type]++;
+	}
+
+	is_failure = 0;
+
+destroy_decomp:
+	rohc_decomp_free(decomp);
+destroy_comp:
+	rohc_comp_free(comp);
+error:
+	return is_failure;
+}
+
+
+/**
+ * @brief Generate one IP packet of the stream
+ *
+ * The IPv4 ID is sequential and jumps every 37 packets. The payload changes
+ * with every packet.
+ *
+ * @param stream   The stream of IP packets to test
+ * @param pkt_num  The number of the packet in the stream
+ * @param ip_id    IN/OUT: The IPv4 ID of the previous packet
+ * @param ip_pkt   OUT: The generated IP packet
+ * @return         The length of the generated IP packet
+ */
+static size_t gen_ip_packet(const struct test_stream *const stream,
+                            const size_t pkt_num,
+                            uint16_t *const ip_id,
+                            uint8_t *const ip_pkt)
+{
+	size_t hdr_len;
+	size_t i;
+
+	memset(ip_pkt, 0, TEST_IP_PKT_LEN);
+
+	if(stream->is_ipv6)
+	{
+		hdr_len = 40;
+		ip_pkt[0] = 0x60; /* version 6 */
+		ip_pkt[4] = (TEST_IP_PKT_LEN - hdr_len) >> 8;
+		ip_pkt[5] = (TEST_IP_PKT_LEN - hdr_len) & 0xff;
+		ip_pkt[6] = 134; /* unassigned number according to /etc/protocols */
+		ip_pkt[7] = 64;
+		ip_pkt[8] = 0x20;
+		ip_pkt[23] = 0x01;
+		ip_pkt[24] = 0x20;
+		ip_pkt[39] = 0x02;
+	}
+	else
+	{
+		uint32_t sum = 0;
+
+		hdr_len = 20;
+		*ip_id += ((pkt_num % 37) == 36 ? stream->ip_id_jump : 1);
+		ip_pkt[0] = 0x45; /* version 4, no option */
+		ip_pkt[2] = TEST_IP_PKT_LEN >> 8;
+		ip_pkt[3] = TEST_IP_PKT_LEN & 0xff;
+		ip_pkt[4] = (*ip_id) >> 8;
+		ip_pkt[5] = (*ip_id) & 0xff;
+		ip_pkt[6] = 0x40; /* DF */
+		ip_pkt[8] = 64;
+		ip_pkt[9] = 134; /* unassigned number according to /etc/protocols */
+		ip_pkt[12] = 0x01;
+		ip_pkt[19] = 0x02;
+
+		/* compute the IPv4 checksum */
+		for(i = 0; i < hdr_len; i += 2)
+		{
+			sum += (ip_pkt[i] << 8) | ip_pkt[i + 1];
+		}
+		while((sum >> 16) != 0)
+		{
+			sum = (sum & 0xffff) + (sum >> 16);
+		}
+		sum = ~sum;
+		ip_pkt[10] = (sum >> 8) & 0xff;
+		ip_pkt[11] = sum & 0xff;
+	}
+
+	for(i = hdr_len; i < TEST_IP_PKT_LEN; i++)
+	{
+		ip_pkt[i] = (pkt_num + i) & 0xff;
+	}
+
+	return TEST_IP_PKT_LEN;
+}
+
+
+/**
+ * @brief Callback to print traces of the ROHC library
+ *
+ * @param priv_ctxt  An optional private context, may be NULL
+ * @param level      The priority level of the trace
+ * @param entity     The entity that emitted the trace among:
+ *                    \li ROHC_TRACE_COMP
+ *                    \li ROHC_TRACE_DECOMP
+ * @param profile    The ID of the ROHC compression/decompression profile
+ *                   the trace is related to
+ * @param format     The format string of the trace
+ */
+static void print_rohc_traces(void *const priv_ctxt,
+                              const rohc_trace_level_t level,
+                              const rohc_trace_entity_t entity,
+                              const int profile,
+                              const char *const format,
+                              ...)
+{
+	va_list args;
+
+	va_start(args, format);
+	vfprintf(stdout, format, args);
+	va_end(args);
+}
+
+
+/**
+ * @brief Generate a random number
+ *
+ * @param comp          The ROHC compressor
+ * @param user_context  Should always be NULL
+ * @return              A random number
+ */
+static int gen_random_num(const struct rohc_comp *const comp,
+                          void *const user_context)
+{
+	assert(comp != NULL);
+	assert(user_context == NULL);
+	return rand();
+}
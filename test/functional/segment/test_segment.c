@@ -57,6 +57,9 @@
 /** The max size */
 #define TEST_MAX_ROHC_SIZE  (5U * 1024U)
 
+/** The max number of segments given as a scatter list to the decompressor */
+#define TEST_MAX_SCATTER_NR  200U
+
 
 /* prototypes of private functions */
 static void usage(void);
@@ -64,6 +67,11 @@ static int test_comp_and_decomp(const size_t ip_packet_len,
                                 const size_t mrru,
                                 const bool is_comp_expected_ok,
                                 const size_t expected_segments_nr);
+static int test_decomp_scattered(struct rohc_decomp *const decomp,
+                                 const uint8_t *const rru,
+                                 const size_t rru_len,
+                                 const size_t segment_max_len,
+                                 const struct rohc_buf ip_packet);
 static void print_rohc_traces(void *const priv_ctxt,
                               const rohc_trace_level_t level,
                               const rohc_trace_entity_t entity,
@@ -200,6 +208,10 @@ static int test_comp_and_decomp(const size_t ip_packet_len,
 	struct rohc_buf uncomp_packet =
 		rohc_buf_init_empty(uncomp_buffer, TEST_MAX_ROHC_SIZE * 3);
 
+	/* the RRU rebuilt from the segments, without the segment type bytes */
+	uint8_t rru[TEST_MAX_ROHC_SIZE * 3];
+	size_t rru_len = 0;
+
 	size_t segments_nr;
 
 	int is_failure = 1;
@@ -349,6 +361,9 @@ static int test_comp_and_decomp(const size_t ip_packet_len,
 			fprintf(stderr, "\t%zu-byte ROHC segment generated\n",
 			        rohc_packet.len);
 			segments_nr++;
+			memcpy(rru + rru_len, rohc_buf_data(rohc_packet) + 1,
+			       rohc_packet.len - 1);
+			rru_len += rohc_packet.len - 1;
 
 			/* decompress segment */
 			status = rohc_decompress3(decomp, rohc_packet, &uncomp_packet,
@@ -378,6 +393,9 @@ static int test_comp_and_decomp(const size_t ip_packet_len,
 		fprintf(stderr, "\t%zu-byte final ROHC segment generated\n",
 		        rohc_packet.len);
 		segments_nr++;
+		memcpy(rru + rru_len, rohc_buf_data(rohc_packet) + 1,
+		       rohc_packet.len - 1);
+		rru_len += rohc_packet.len - 1;
 
 		/* decompress last segment */
 		status = rohc_decompress3(decomp, rohc_packet, &uncomp_packet,
@@ -456,6 +474,18 @@ static int test_comp_and_decomp(const size_t ip_packet_len,
 		        "original IP packet\n");
 	}
 
+	/* decompress the RRU again, given as a scatter list of segments: large
+	 * segments that hold the whole ROHC header, then small segments */
+	if(segments_nr > 0)
+	{
+		if(test_decomp_scattered(decomp, rru, rru_len, TEST_MAX_ROHC_SIZE,
+		                         ip_packet) != 0 ||
+		   test_decomp_scattered(decomp, rru, rru_len, 100, ip_packet) != 0)
+		{
+			goto destroy_decomp;
+		}
+	}
+
 	/* everything went fine */
 	fprintf(stderr, "\n");
 	is_failure = 0;
@@ -469,6 +499,79 @@ error:
 }
 
 
+/**
+ * @brief Decompress one RRU given as a scatter list of segments
+ *
+ * @param decomp           The ROHC decompressor
+ * @param rru              The RRU to split into segments
+ * @param rru_len          The length of the RRU
+ * @param segment_max_len  The max length of the segments
+ * @param ip_packet        The IP packet expected after decompression
+ * @return                 0 in case of success, 1 in case of failure
+ */
+static int test_decomp_scattered(struct rohc_decomp *const decomp,
+                                 const uint8_t *const rru,
+                                 const size_t rru_len,
+                                 const size_t segment_max_len,
+                                 const struct rohc_buf ip_packet)
+{
+	uint8_t segments_buffer[TEST_MAX_ROHC_SIZE * 4];
+	struct rohc_buf segments[TEST_MAX_SCATTER_NR];
+	size_t segments_nr = 0;
+
+	uint8_t uncomp_buffer[TEST_MAX_ROHC_SIZE * 3];
+	struct rohc_buf uncomp_packet =
+		rohc_buf_init_empty(uncomp_buffer, TEST_MAX_ROHC_SIZE * 3);
+
+	uint8_t *walk = segments_buffer;
+	size_t rru_off;
+	rohc_status_t status;
+
+	/* split the RRU into segments of the given max length */
+	for(rru_off = 0; rru_off < rru_len; rru_off += segment_max_len - 1)
+	{
+		const size_t data_len = (rru_len - rru_off) < (segment_max_len - 1) ?
+		                        (rru_len - rru_off) : (segment_max_len - 1);
+
+		assert(segments_nr < TEST_MAX_SCATTER_NR);
+		assert((walk + 1 + data_len) <= (segments_buffer + sizeof(segments_buffer)));
+		walk[0] = 0xfe | ((rru_off + data_len) == rru_len);
+		memcpy(walk + 1, rru + rru_off, data_len);
+		segments[segments_nr].time.sec = 0;
+		segments[segments_nr].time.nsec = 0;
+		segments[segments_nr].data = walk;
+		segments[segments_nr].max_len = 1 + data_len;
+		segments[segments_nr].offset = 0;
+		segments[segments_nr].len = 1 + data_len;
+		segments_nr++;
+		walk += 1 + data_len;
+	}
+	fprintf(stderr, "\tdecompress the %zu-byte RRU given as a scatter list of "
+	        "%zu segments\n", rru_len, segments_nr);
+
+	status = rohc_decompress_segments(decomp, segments, segments_nr,
+	                                  &uncomp_packet, NULL, NULL);
+	if(status != ROHC_STATUS_OK)
+	{
+		fprintf(stderr, "\tfailed to decompress the scattered ROHC segments\n");
+		return 1;
+	}
+	if(ip_packet.len != uncomp_packet.len ||
+	   memcmp(rohc_buf_data(ip_packet), rohc_buf_data(uncomp_packet),
+	          ip_packet.len) != 0)
+	{
+		fprintf(stderr, "\t%zu-byte decompressed packet does not match "
+		        "original %zu-byte IP packet\n", uncomp_packet.len,
+		        ip_packet.len);
+		return 1;
+	}
+	fprintf(stderr, "\tdecompressed scattered ROHC segments match the "
+	        "original IP packet\n");
+
+	return 0;
+}
+
+
 /**
  * @brief Callback to print traces of the ROHC library
  *
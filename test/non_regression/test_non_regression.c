@@ -80,6 +80,15 @@
  * comparison and shutdown).
  *
  * The program optionally outputs the ROHC packets in a PCAP packet.
+ *
+ * Parallel replay
+ * ---------------
+ *
+ * With the --scenarios option, the program runs many scenarios listed in one
+ * file instead of one. Every PCAP capture is loaded in memory only once, then
+ * the scenarios are run concurrently by a pool of threads, every scenario
+ * with its own compressor/decompressor pairs. The results of all scenarios
+ * are reported in one summary.
  */
 
 #include "test.h"
@@ -99,6 +108,7 @@
 #include <errno.h>
 #include <assert.h>
 #include <stdarg.h>
+#include <pthread.h>
 
 /* includes for network headers */
 #include <protocols/ipv4.h>
@@ -123,6 +133,9 @@ for ./configure ? If yes, check configure output and config.log"
 /** The maximum number of source PCAP dump files */
 #define SRC_FILENAMES_MAX_NR  2U
 
+/** The maximum number of threads that run scenarios concurrently */
+#define JOBS_MAX_NR  256U
+
 /** print text on console if not in quiet mode */
 #define trace(format, ...) \
 	do { \
@@ -131,6 +144,49 @@ for ./configure ? If yes, check configure output and config.log"
 		} \
 	} while(0)
 
+
+/** One packet of a capture loaded in memory */
+struct test_packet
+{
+	struct pcap_pkthdr header;  /**< The PCAP header of the packet */
+	size_t link_len;            /**< The length of the link layer header */
+	uint8_t *data;              /**< The packet, link layer header included */
+};
+
+
+/** One capture loaded in memory, made of one or several PCAP dump files */
+struct test_capture
+{
+	char *name;                   /**< The name of the first PCAP dump file */
+	struct test_packet *packets;  /**< The packets of the capture */
+	size_t packets_nr;            /**< The number of packets */
+};
+
+
+/** One test scenario: one flow through two compressor/decompressor pairs */
+struct test_scenario
+{
+	rohc_cid_type_t cid_type;  /**< The type of CIDs */
+	size_t wlsb_width;         /**< The width of the WLSB window */
+	size_t max_contexts;       /**< The maximum number of ROHC contexts */
+	bool no_comparison;        /**< Whether the comparison is optional */
+	bool ignore_malformed;     /**< Whether malformed packets are ignored */
+	const struct test_capture *src;  /**< The IP packets */
+	const struct test_capture *cmp;  /**< The reference ROHC packets, or NULL */
+	int status;                /**< The result: 0, 1 or 77 for skipped */
+};
+
+
+/** The scenarios run concurrently by a pool of threads */
+struct test_scenarios
+{
+	struct test_scenario *scenarios;  /**< The scenarios */
+	size_t scenarios_nr;              /**< The number of scenarios */
+	size_t next_scenario;             /**< The next scenario to run */
+	pthread_mutex_t lock;             /**< The lock on next_scenario */
+};
+
+
 /* prototypes of private functions */
 static void usage(void);
 static int test_comp_and_decomp(const rohc_cid_type_t cid_type,
@@ -143,6 +199,17 @@ static int test_comp_and_decomp(const rohc_cid_type_t cid_type,
                                 char *ofilename,
                                 char *cmp_filename,
                                 const char *rohc_size_ofilename);
+static int test_scenarios(const char *const scenarios_filename,
+                          const size_t jobs_nr,
+                          const bool no_comparison,
+                          const bool ignore_malformed)
+	__attribute__((nonnull(1), warn_unused_result));
+static void * run_scenarios(void *const arg)
+	__attribute__((nonnull(1)));
+static int run_scenario(const struct test_scenario *const scenario,
+                        pcap_dumper_t *const dumper,
+                        FILE *const size_output_file)
+	__attribute__((nonnull(1), warn_unused_result));
 static int compress_decompress(struct rohc_comp *comp,
                                struct rohc_decomp *decomp,
                                struct rohc_comp *const comp_associated,
@@ -190,14 +257,12 @@ static bool rohc_comp_rtp_cb(const unsigned char *const ip,
 
 static pcap_t * open_pcap_file(const char *const filename, size_t *const link_len)
 	__attribute__((nonnull(1, 2), warn_unused_result));
-static bool get_next_packet(pcap_t **const pcap_handle,
-                            const char *const src_filenames[],
-                            const size_t src_filenames_nr,
-                            size_t *const src_filenames_id,
-                            struct pcap_pkthdr *const header,
-                            size_t *const link_len,
-                            const uint8_t **const packet)
-	__attribute__((nonnull(1, 2, 4, 5, 6, 7), warn_unused_result));
+static bool load_capture(const char *const filenames[],
+                         const size_t filenames_nr,
+                         struct test_capture *const capture)
+	__attribute__((nonnull(1, 3), warn_unused_result));
+static void free_capture(struct test_capture *const capture)
+	__attribute__((nonnull(1)));
 
 static void show_rohc_stats(struct rohc_comp *comp1, struct rohc_decomp *decomp1,
                             struct rohc_comp *comp2, struct rohc_decomp *decomp2);
@@ -229,6 +294,15 @@ static enum
 /** The number of warnings emitted by the ROHC library */
 static size_t nr_rohc_warnings = 0;
 
+/** The IP-only profile to enable, ROHCv1 by default */
+static rohc_profile_t ip_only_profile = ROHC_PROFILE_IP;
+/** The IP/UDP profile to enable, ROHCv1 by default */
+static rohc_profile_t udp_profile = ROHC_PROFILE_UDP;
+/** The IP/UDP/RTP profile to enable, ROHCv1 by default */
+static rohc_profile_t rtp_profile = ROHC_PROFILE_RTP;
+/** The IP/ESP profile to enable, ROHCv1 by default */
+static rohc_profile_t esp_profile = ROHC_PROFILE_ESP;
+
 
 /**
  * @brief Main function for the ROHC test program
@@ -248,6 +322,8 @@ int main(int argc, char *argv[])
 	char *src_filenames[SRC_FILENAMES_MAX_NR] = { NULL };
 	char *ofilename = NULL;
 	char *cmp_filename = NULL;
+	char *scenarios_filename = NULL;
+	int jobs_nr = 1;
 	int max_contexts = ROHC_SMALL_CID_MAX + 1;
 	int wlsb_width = 4;
 	bool no_comparison = false;
@@ -321,6 +397,19 @@ int main(int argc, char *argv[])
 			cmp_filename = argv[1];
 			args_used++;
 		}
+		else if(!strcmp(*argv, "--rohcv2-ip"))
+		{
+			/* compress IP-only flows with the ROHCv2 profile */
+			ip_only_profile = ROHCv2_PROFILE_IP;
+		}
+		else if(!strcmp(*argv, "--rohcv2"))
+		{
+			/* compress IP-only, UDP, RTP and ESP flows with the ROHCv2 profiles */
+			ip_only_profile = ROHCv2_PROFILE_IP;
+			udp_profile = ROHCv2_PROFILE_IP_UDP;
+			rtp_profile = ROHCv2_PROFILE_IP_UDP_RTP;
+			esp_profile = ROHCv2_PROFILE_IP_ESP;
+		}
 		else if(!strcmp(*argv, "--no-comparison"))
 		{
 			/* do not exit with error code if comparison is not possible */
@@ -372,6 +461,30 @@ int main(int argc, char *argv[])
 			wlsb_width = atoi(argv[1]);
 			args_used++;
 		}
+		else if(!strcmp(*argv, "--scenarios"))
+		{
+			/* get the name of the file that lists the scenarios to run */
+			if(argc <= 1)
+			{
+				fprintf(stderr, "option --scenarios takes one argument\n\n");
+				usage();
+				goto error;
+			}
+			scenarios_filename = argv[1];
+			args_used++;
+		}
+		else if(!strcmp(*argv, "--jobs"))
+		{
+			/* get the number of scenarios to run concurrently */
+			if(argc <= 1)
+			{
+				fprintf(stderr, "option --jobs takes one argument\n\n");
+				usage();
+				goto error;
+			}
+			jobs_nr = atoi(argv[1]);
+			args_used++;
+		}
 		else if(cid_type_name == NULL)
 		{
 			/* get the type of CID to use within the ROHC library */
@@ -399,6 +512,29 @@ int main(int argc, char *argv[])
 		}
 	}
 
+	/* run the scenarios concurrently if asked */
+	if(scenarios_filename != NULL)
+	{
+		if(jobs_nr < 1 || ((unsigned int) jobs_nr) > JOBS_MAX_NR)
+		{
+			fprintf(stderr, "the number of jobs should be between 1 and %u\n\n",
+			        JOBS_MAX_NR);
+			usage();
+			goto error;
+		}
+		if(cid_type_name != NULL || ofilename != NULL || cmp_filename != NULL ||
+		   rohc_size_ofilename != NULL)
+		{
+			fprintf(stderr, "option --scenarios is not compatible with CID_TYPE, "
+			        "FLOW, -o, -c and --rohc-size-output\n\n");
+			usage();
+			goto error;
+		}
+		status = test_scenarios(scenarios_filename, jobs_nr, no_comparison,
+		                        ignore_malformed);
+		goto check_status;
+	}
+
 	/* check CID type */
 	if(cid_type_name == NULL)
 	{
@@ -471,6 +607,7 @@ int main(int argc, char *argv[])
 
 	trace("=== exit test with code %d\n", status);
 
+check_status:
 	if(assert_on_error)
 	{
 		assert(status == 0 || status == 77);
@@ -491,6 +628,7 @@ static void usage(void)
 	        "                          of IP packets\n"
 	        "\n"
 	        "usage: test_non_regression [OPTIONS] CID_TYPE FLOW [FLOW]\n"
+	        "       test_non_regression [OPTIONS] --scenarios FILE [--jobs NUM]\n"
 	        "\n"
 	        "with:\n"
 	        "  CID_TYPE                The type of CID to use among 'smallcid'\n"
@@ -509,6 +647,15 @@ static void usage(void)
 	        "  --max-contexts NUM      The maximum number of ROHC contexts to\n"
 	        "                          simultaneously use during the test\n"
 	        "  --wlsb-width NUM        The width of the WLSB window to use\n"
+	        "  --scenarios FILE        Run the scenarios listed in FILE, one per\n"
+	        "                          line: CID_TYPE MAX_CONTEXTS WLSB_WIDTH FLOW\n"
+	        "                          ROHC_FLOW (MAX_CONTEXTS 0 for the maximum)\n"
+	        "  --jobs NUM              The number of scenarios to run concurrently\n"
+	        "                          (default 1)\n"
+	        "  --rohcv2-ip             Enable the ROHCv2 IP-only profile instead\n"
+	        "                          of the ROHCv1 one\n"
+	        "  --rohcv2                Enable the ROHCv2 IP-only, IP/UDP, IP/UDP/RTP\n"
+	        "                          and IP/ESP profiles instead of the ROHCv1 ones\n"
 	        "  --no-comparison         Is comparison with ROHC reference optional for test\n"
 	        "  --ignore-malformed      Ignore malformed packets for test\n"
 	        "  --assert-on-error       Stop the test after the very first encountered error\n"
@@ -615,10 +762,10 @@ static bool show_rohc_comp_stats(const struct rohc_comp *const comp,
 	/* profiles */
 	trace("===\tprofiles:\n");
 	show_rohc_comp_profile(comp, ROHC_PROFILE_UNCOMPRESSED);
-	show_rohc_comp_profile(comp, ROHC_PROFILE_RTP);
-	show_rohc_comp_profile(comp, ROHC_PROFILE_UDP);
-	show_rohc_comp_profile(comp, ROHC_PROFILE_ESP);
-	show_rohc_comp_profile(comp, ROHC_PROFILE_IP);
+	show_rohc_comp_profile(comp, rtp_profile);
+	show_rohc_comp_profile(comp, udp_profile);
+	show_rohc_comp_profile(comp, esp_profile);
+	show_rohc_comp_profile(comp, ip_only_profile);
 	show_rohc_comp_profile(comp, ROHC_PROFILE_TCP);
 	show_rohc_comp_profile(comp, ROHC_PROFILE_UDPLITE);
 
@@ -718,10 +865,10 @@ static bool show_rohc_decomp_stats(const struct rohc_decomp *const decomp,
 	/* profiles */
 	trace("===\tprofiles:\n");
 	show_rohc_decomp_profile(decomp, ROHC_PROFILE_UNCOMPRESSED);
-	show_rohc_decomp_profile(decomp, ROHC_PROFILE_RTP);
-	show_rohc_decomp_profile(decomp, ROHC_PROFILE_UDP);
-	show_rohc_decomp_profile(decomp, ROHC_PROFILE_ESP);
-	show_rohc_decomp_profile(decomp, ROHC_PROFILE_IP);
+	show_rohc_decomp_profile(decomp, rtp_profile);
+	show_rohc_decomp_profile(decomp, udp_profile);
+	show_rohc_decomp_profile(decomp, esp_profile);
+	show_rohc_decomp_profile(decomp, ip_only_profile);
 	show_rohc_decomp_profile(decomp, ROHC_PROFILE_TCP);
 	show_rohc_decomp_profile(decomp, ROHC_PROFILE_UDPLITE);
 
@@ -1080,6 +1227,8 @@ exit:
  * @param ignore_malformed     Whether to handle malformed packets as fatal for test
  * @param src_filenames        The names of the PCAP files that contain the
  *                             IP packets
+ * @param src_filenames_nr     The number of PCAP files that contain the IP
+ *                             packets
  * @param ofilename            The name of the PCAP file to output the ROHC
  *                             packets
  * @param cmp_filename         The name of the PCAP file that contains the
@@ -1101,61 +1250,51 @@ static int test_comp_and_decomp(const rohc_cid_type_t cid_type,
                                 char *cmp_filename,
                                 const char *rohc_size_ofilename)
 {
-	char errbuf[PCAP_ERRBUF_SIZE];
-	size_t src_filenames_id = 0;
-	pcap_t *handle;
-	pcap_t *cmp_handle;
+	struct test_capture src_capture;
+	struct test_capture cmp_capture;
+	struct test_scenario scenario =
+	{
+		.cid_type = cid_type,
+		.wlsb_width = wlsb_width,
+		.max_contexts = max_contexts,
+		.no_comparison = no_comparison,
+		.ignore_malformed = ignore_malformed,
+		.src = &src_capture,
+		.cmp = NULL,
+	};
 	pcap_dumper_t *dumper;
-	size_t link_len_src = 0;
-	size_t link_len_cmp = 0;
-	struct pcap_pkthdr header;
-	struct pcap_pkthdr cmp_header;
-
 	FILE *rohc_size_output_file;
-
-	const uint8_t *packet;
-	unsigned char *cmp_packet;
-
-	int counter;
-
-	struct rohc_comp *comp1;
-	struct rohc_comp *comp2;
-
-	struct rohc_decomp *decomp1;
-	struct rohc_decomp *decomp2;
-
-	/* the buffer that will contain the feedback packet of #1 */
-	uint8_t feedback1_buffer[MAX_ROHC_SIZE];
-	struct rohc_buf feedback1_data =
-		rohc_buf_init_empty(feedback1_buffer, MAX_ROHC_SIZE);
-	/* the buffer that will contain the feedback packet of #2 */
-	uint8_t feedback2_buffer[MAX_ROHC_SIZE];
-	struct rohc_buf feedback2_data =
-		rohc_buf_init_empty(feedback2_buffer, MAX_ROHC_SIZE);
-
-	int ret;
-	int nb_bad = 0, nb_ok = 0, err_comp = 0, err_decomp = 0, nb_ref = 0;
 	int status = 1;
 
 	trace("=== initialization:\n");
 
-	/* open the source dump file */
-	handle = open_pcap_file(src_filenames[0], &link_len_src);
-	if(handle == NULL)
+	/* load the source dump files */
+	if(!load_capture(src_filenames, src_filenames_nr, &src_capture))
 	{
 		status = 77; /* skip test */
 		goto error;
 	}
 
-	/* open the network dump file for ROHC storage if asked */
+	/* open the network dump file for ROHC storage if asked, with the link
+	 * layer of the source dump file */
 	if(ofilename != NULL)
 	{
+		size_t link_len_src;
+		pcap_t *handle;
+
+		handle = open_pcap_file(src_filenames[0], &link_len_src);
+		if(handle == NULL)
+		{
+			status = 77; /* skip test */
+			goto free_input;
+		}
 		dumper = pcap_dump_open(handle, ofilename);
+		pcap_close(handle);
 		if(dumper == NULL)
 		{
-			trace("failed to open dump file: %s\n", errbuf);
+			trace("failed to open dump file '%s'\n", ofilename);
 			status = 77; /* skip test */
-			goto close_input;
+			goto free_input;
 		}
 	}
 	else
@@ -1163,19 +1302,17 @@ static int test_comp_and_decomp(const rohc_cid_type_t cid_type,
 		dumper = NULL;
 	}
 
-	/* open the ROHC comparison dump file if asked */
+	/* load the ROHC comparison dump file if asked */
 	if(cmp_filename != NULL)
 	{
-		cmp_handle = open_pcap_file(cmp_filename, &link_len_cmp);
-		if(cmp_handle == NULL)
+		const char *const cmp_filenames[1] = { cmp_filename };
+
+		if(!load_capture(cmp_filenames, 1, &cmp_capture))
 		{
 			status = 77; /* skip test */
 			goto close_output;
 		}
-	}
-	else
-	{
-		cmp_handle = NULL;
+		scenario.cmp = &cmp_capture;
 	}
 
 	/* open the file in which to write the sizes of the ROHC packets if asked */
@@ -1187,7 +1324,7 @@ static int test_comp_and_decomp(const rohc_cid_type_t cid_type,
 			trace("failed to open file '%s' to output the sizes of ROHC packets: "
 			      "%s (%d)\n", rohc_size_ofilename, strerror(errno), errno);
 			status = 77; /* skip test */
-			goto close_comparison;
+			goto free_comparison;
 		}
 	}
 	else
@@ -1195,16 +1332,390 @@ static int test_comp_and_decomp(const rohc_cid_type_t cid_type,
 		rohc_size_output_file = NULL;
 	}
 
+	status = run_scenario(&scenario, dumper, rohc_size_output_file);
+
+	if(rohc_size_output_file != NULL)
+	{
+		fclose(rohc_size_output_file);
+	}
+free_comparison:
+	if(scenario.cmp != NULL)
+	{
+		free_capture(&cmp_capture);
+	}
+close_output:
+	if(dumper != NULL)
+	{
+		pcap_dump_close(dumper);
+	}
+free_input:
+	free_capture(&src_capture);
+error:
+	return status;
+}
+
+
+/**
+ * @brief Run the scenarios listed in one file concurrently
+ *
+ * Every line of the file is one scenario made of 5 fields separated by
+ * spaces: the CID type, the maximum number of contexts, the width of the
+ * WLSB window, the PCAP file of the IP packets, and the PCAP file of the
+ * reference ROHC packets. Empty lines and lines that start with '#' are
+ * ignored.
+ *
+ * All the PCAP files are loaded in memory once, even if they are shared by
+ * several scenarios. The scenarios are then run by a pool of threads, every
+ * scenario with its own compressor/decompressor pairs. The result of every
+ * scenario and a summary are printed once all the scenarios are run.
+ *
+ * @param scenarios_filename  The name of the file that lists the scenarios
+ * @param jobs_nr             The number of threads that run the scenarios
+ * @param no_comparison       Whether to handle comparison as fatal for test
+ * @param ignore_malformed    Whether to handle malformed packets as fatal for
+ *                            test
+ * @return                    0 if all the scenarios succeeded or were skipped,
+ *                            1 otherwise
+ */
+static int test_scenarios(const char *const scenarios_filename,
+                          const size_t jobs_nr,
+                          const bool no_comparison,
+                          const bool ignore_malformed)
+{
+	const bool print_all_results = (verbosity != VERBOSITY_NONE);
+	struct test_scenarios scenarios =
+	{
+		.scenarios = NULL,
+		.scenarios_nr = 0,
+		.next_scenario = 0,
+	};
+	struct test_capture **captures = NULL;
+	size_t captures_nr = 0;
+	pthread_t threads[JOBS_MAX_NR];
+	size_t threads_nr;
+	size_t nr_ok = 0;
+	size_t nr_failed = 0;
+	size_t nr_skipped = 0;
+	FILE *scenarios_file;
+	char line[1024];
+	size_t i;
+	int status = 1;
+
+	scenarios_file = fopen(scenarios_filename, "r");
+	if(scenarios_file == NULL)
+	{
+		fprintf(stderr, "failed to open file '%s' of scenarios: %s (%d)\n",
+		        scenarios_filename, strerror(errno), errno);
+		goto error;
+	}
+
+	/* parse the scenarios, load every capture once */
+	while(fgets(line, sizeof(line), scenarios_file) != NULL)
+	{
+		char cid_type_name[16];
+		int max_contexts;
+		int wlsb_width;
+		char filenames[2][sizeof(line)];
+		struct test_scenario *new_scenarios;
+		struct test_scenario *scenario;
+		size_t file_id;
+
+		if(line[0] == '#' || line[0] == '\n')
+		{
+			continue;
+		}
+		if(sscanf(line, "%15s %d %d %1023s %1023s", cid_type_name, &max_contexts,
+		          &wlsb_width, filenames[0], filenames[1]) != 5)
+		{
+			fprintf(stderr, "malformed scenario: %s", line);
+			goto free_scenarios;
+		}
+
+		new_scenarios = realloc(scenarios.scenarios, sizeof(struct test_scenario) *
+		                        (scenarios.scenarios_nr + 1));
+		if(new_scenarios == NULL)
+		{
+			fprintf(stderr, "failed to allocate memory for scenarios\n");
+			goto free_scenarios;
+		}
+		scenarios.scenarios = new_scenarios;
+		scenario = &scenarios.scenarios[scenarios.scenarios_nr];
+		scenarios.scenarios_nr++;
+
+		memset(scenario, 0, sizeof(struct test_scenario));
+		if(!strcmp(cid_type_name, "smallcid"))
+		{
+			scenario->cid_type = ROHC_SMALL_CID;
+			if(max_contexts == 0)
+			{
+				max_contexts = ROHC_SMALL_CID_MAX + 1;
+			}
+		}
+		else if(!strcmp(cid_type_name, "largecid"))
+		{
+			scenario->cid_type = ROHC_LARGE_CID;
+			if(max_contexts == 0)
+			{
+				max_contexts = ROHC_LARGE_CID_MAX + 1;
+			}
+		}
+		else
+		{
+			fprintf(stderr, "invalid CID type '%s' in scenario: %s",
+			        cid_type_name, line);
+			goto free_scenarios;
+		}
+		if(max_contexts < 1 || wlsb_width <= 0 ||
+		   (wlsb_width & (wlsb_width - 1)) != 0)
+		{
+			fprintf(stderr, "invalid number of contexts or WLSB width in "
+			        "scenario: %s", line);
+			goto free_scenarios;
+		}
+		scenario->max_contexts = max_contexts;
+		scenario->wlsb_width = wlsb_width;
+		scenario->no_comparison = no_comparison;
+		scenario->ignore_malformed = ignore_malformed;
+		scenario->status = 77;
+
+		for(file_id = 0; file_id < 2; file_id++)
+		{
+			const char *const filename = filenames[file_id];
+			struct test_capture *capture = NULL;
+
+			for(i = 0; i < captures_nr && capture == NULL; i++)
+			{
+				if(!strcmp(captures[i]->name, filename))
+				{
+					capture = captures[i];
+				}
+			}
+			if(capture == NULL)
+			{
+				struct test_capture **const new_captures =
+					realloc(captures, sizeof(struct test_capture *) * (captures_nr + 1));
+
+				if(new_captures == NULL)
+				{
+					fprintf(stderr, "failed to allocate memory for captures\n");
+					goto free_scenarios;
+				}
+				captures = new_captures;
+				capture = malloc(sizeof(struct test_capture));
+				if(capture == NULL)
+				{
+					fprintf(stderr, "failed to allocate memory for captures\n");
+					goto free_scenarios;
+				}
+				if(!load_capture(&filename, 1, capture))
+				{
+					/* the scenarios of the capture will be skipped */
+					capture->name = strdup(filename);
+					if(capture->name == NULL)
+					{
+						fprintf(stderr, "failed to allocate memory for captures\n");
+						free(capture);
+						goto free_scenarios;
+					}
+				}
+				captures[captures_nr] = capture;
+				captures_nr++;
+			}
+			if(file_id == 0)
+			{
+				scenario->src = capture;
+			}
+			else
+			{
+				scenario->cmp = capture;
+			}
+		}
+	}
+
+	/* run the scenarios, without any trace since the scenarios would mix
+	 * their outputs */
+	verbosity = VERBOSITY_NONE;
+	if(pthread_mutex_init(&scenarios.lock, NULL) != 0)
+	{
+		fprintf(stderr, "failed to initialize the lock on scenarios\n");
+		goto free_scenarios;
+	}
+	for(threads_nr = 0; threads_nr < jobs_nr; threads_nr++)
+	{
+		if(pthread_create(&threads[threads_nr], NULL, run_scenarios,
+		                  &scenarios) != 0)
+		{
+			fprintf(stderr, "failed to create thread #%zu\n", threads_nr + 1);
+			break;
+		}
+	}
+	if(threads_nr == 0)
+	{
+		goto destroy_lock;
+	}
+	for(i = 0; i < threads_nr; i++)
+	{
+		pthread_join(threads[i], NULL);
+	}
+
+	/* report the results */
+	for(i = 0; i < scenarios.scenarios_nr; i++)
+	{
+		const struct test_scenario *const scenario = &scenarios.scenarios[i];
+		const char *result;
+
+		if(scenario->status == 0)
+		{
+			result = "PASS";
+			nr_ok++;
+		}
+		else if(scenario->status == 77)
+		{
+			result = "SKIP";
+			nr_skipped++;
+		}
+		else
+		{
+			result = "FAIL";
+			nr_failed++;
+		}
+		if(print_all_results || scenario->status == 1)
+		{
+			printf("%s: %s\n", result, scenario->cmp->name);
+		}
+	}
+	printf("=== %zu scenarios run by %zu threads: %zu passed, %zu failed, "
+	       "%zu skipped\n", scenarios.scenarios_nr, threads_nr, nr_ok,
+	       nr_failed, nr_skipped);
+	if(nr_failed == 0)
+	{
+		status = 0;
+	}
+
+destroy_lock:
+	pthread_mutex_destroy(&scenarios.lock);
+free_scenarios:
+	free(scenarios.scenarios);
+	for(i = 0; i < captures_nr; i++)
+	{
+		free_capture(captures[i]);
+		free(captures[i]);
+	}
+	free(captures);
+	fclose(scenarios_file);
+error:
+	return status;
+}
+
+
+/**
+ * @brief Run scenarios until none is left
+ *
+ * @param arg  The scenarios to run
+ * @return     Always NULL
+ */
+static void * run_scenarios(void *const arg)
+{
+	struct test_scenarios *const scenarios = arg;
+
+	while(true)
+	{
+		struct test_scenario *scenario;
+
+		pthread_mutex_lock(&scenarios->lock);
+		if(scenarios->next_scenario >= scenarios->scenarios_nr)
+		{
+			pthread_mutex_unlock(&scenarios->lock);
+			break;
+		}
+		scenario = &scenarios->scenarios[scenarios->next_scenario];
+		scenarios->next_scenario++;
+		pthread_mutex_unlock(&scenarios->lock);
+
+		/* scenarios with missing captures are skipped */
+		if(scenario->src->packets_nr > 0 && scenario->cmp->packets_nr > 0)
+		{
+			scenario->status = run_scenario(scenario, NULL, NULL);
+		}
+	}
+
+	return NULL;
+}
+
+
+/**
+ * @brief Run one scenario: test the ROHC library with a flow of IP packets
+ *        going through two compressor/decompressor pairs
+ *
+ * The captures of the scenario are not modified, so that several scenarios
+ * may share them at the same time.
+ *
+ * @param scenario          The scenario
+ * @param dumper            The PCAP file to output the ROHC packets, may be
+ *                          NULL
+ * @param size_output_file  The text file to output the sizes of the ROHC
+ *                          packets, may be NULL
+ * @return                  0 in case of success,
+ *                          1 in case of failure
+ */
+static int run_scenario(const struct test_scenario *const scenario,
+                        pcap_dumper_t *const dumper,
+                        FILE *const size_output_file)
+{
+	const struct test_capture *const src = scenario->src;
+	const struct test_capture *const cmp = scenario->cmp;
+	size_t cmp_packet_id = 0;
+
+	/* the packet being tested, copied from the capture */
+	uint8_t *packet;
+	size_t packet_max_len = 0;
+
+	int counter;
+
+	struct rohc_comp *comp1;
+	struct rohc_comp *comp2;
+
+	struct rohc_decomp *decomp1;
+	struct rohc_decomp *decomp2;
+
+	/* the buffer that will contain the feedback packet of #1 */
+	uint8_t feedback1_buffer[MAX_ROHC_SIZE];
+	struct rohc_buf feedback1_data =
+		rohc_buf_init_empty(feedback1_buffer, MAX_ROHC_SIZE);
+	/* the buffer that will contain the feedback packet of #2 */
+	uint8_t feedback2_buffer[MAX_ROHC_SIZE];
+	struct rohc_buf feedback2_data =
+		rohc_buf_init_empty(feedback2_buffer, MAX_ROHC_SIZE);
+
+	int ret;
+	int nb_bad = 0, nb_ok = 0, err_comp = 0, err_decomp = 0, nb_ref = 0;
+	int status = 1;
+	size_t i;
+
+	/* the packets are fixed before compression, so they are copied */
+	for(i = 0; i < src->packets_nr; i++)
+	{
+		packet_max_len = max(packet_max_len, src->packets[i].header.caplen);
+	}
+	packet = malloc(max(packet_max_len, 1));
+	if(packet == NULL)
+	{
+		trace("failed to allocate memory for packets\n");
+		goto error;
+	}
+
 	/* create the compressor 1 */
-	comp1 = create_compressor(cid_type, wlsb_width, max_contexts);
+	comp1 = create_compressor(scenario->cid_type, scenario->wlsb_width,
+	                          scenario->max_contexts);
 	if(comp1 == NULL)
 	{
 		trace("failed to create the compressor 1\n");
-		goto close_output_size;
+		goto free_packet;
 	}
 
 	/* create the compressor 2 */
-	comp2 = create_compressor(cid_type, wlsb_width, max_contexts);
+	comp2 = create_compressor(scenario->cid_type, scenario->wlsb_width,
+	                          scenario->max_contexts);
 	if(comp2 == NULL)
 	{
 		trace("failed to create the compressor 2\n");
@@ -1212,7 +1723,7 @@ static int test_comp_and_decomp(const rohc_cid_type_t cid_type,
 	}
 
 	/* create the decompressor 1 */
-	decomp1 = create_decompressor(cid_type, max_contexts);
+	decomp1 = create_decompressor(scenario->cid_type, scenario->max_contexts);
 	if(decomp1 == NULL)
 	{
 		trace("failed to create the decompressor 1\n");
@@ -1220,7 +1731,7 @@ static int test_comp_and_decomp(const rohc_cid_type_t cid_type,
 	}
 
 	/* create the decompressor 2 */
-	decomp2 = create_decompressor(cid_type, max_contexts);
+	decomp2 = create_decompressor(scenario->cid_type, scenario->max_contexts);
 	if(decomp2 == NULL)
 	{
 		trace("failed to create the decompressor 2\n");
@@ -1230,30 +1741,34 @@ static int test_comp_and_decomp(const rohc_cid_type_t cid_type,
 	trace("\n");
 
 	/* for each packet in the dump */
-	counter = 0;
-	while(get_next_packet(&handle, src_filenames, src_filenames_nr,
-	                      &src_filenames_id, &header, &link_len_src, &packet))
+	for(counter = 0; counter < src->packets_nr; counter++)
 	{
-		counter++;
+		const struct test_packet *const src_packet = &src->packets[counter];
+		const struct test_packet *cmp_packet;
+
+		memcpy(packet, src_packet->data, src_packet->header.caplen);
 
 		/* get next ROHC packet from the comparison dump file if asked */
-		if(cmp_handle != NULL)
+		if(cmp != NULL && cmp_packet_id < cmp->packets_nr)
 		{
-			cmp_packet = (unsigned char *) pcap_next(cmp_handle, &cmp_header);
+			cmp_packet = &cmp->packets[cmp_packet_id];
+			cmp_packet_id++;
 		}
 		else
 		{
 			cmp_packet = NULL;
-			cmp_header.caplen = 0;
 		}
 
 		/* compress & decompress from compressor 1 to decompressor 1 */
-		ret = compress_decompress(comp1, decomp1, comp2, 1, counter,
-		                          header, packet, link_len_src,
-		                          no_comparison, ignore_malformed,
+		ret = compress_decompress(comp1, decomp1, comp2, 1, counter + 1,
+		                          src_packet->header, packet, src_packet->link_len,
+		                          scenario->no_comparison,
+		                          scenario->ignore_malformed,
 		                          dumper,
-		                          cmp_packet, cmp_header.caplen, link_len_cmp,
-		                          rohc_size_output_file,
+		                          cmp_packet != NULL ? cmp_packet->data : NULL,
+		                          cmp_packet != NULL ? cmp_packet->header.caplen : 0,
+		                          cmp_packet != NULL ? cmp_packet->link_len : 0,
+		                          size_output_file,
 		                          feedback2_data, &feedback1_data);
 		if(ret == -1)
 		{
@@ -1281,23 +1796,26 @@ static int test_comp_and_decomp(const rohc_cid_type_t cid_type,
 		rohc_buf_reset(&feedback2_data);
 
 		/* get next ROHC packet from the comparison dump file if asked */
-		if(cmp_handle != NULL)
+		if(cmp != NULL && cmp_packet_id < cmp->packets_nr)
 		{
-			cmp_packet = (unsigned char *) pcap_next(cmp_handle, &cmp_header);
+			cmp_packet = &cmp->packets[cmp_packet_id];
+			cmp_packet_id++;
 		}
 		else
 		{
 			cmp_packet = NULL;
-			cmp_header.caplen = 0;
 		}
 
 		/* compress & decompress from compressor 2 to decompressor 2 */
-		ret = compress_decompress(comp2, decomp2, comp1, 2, counter,
-		                          header, packet, link_len_src,
-		                          no_comparison, ignore_malformed,
+		ret = compress_decompress(comp2, decomp2, comp1, 2, counter + 1,
+		                          src_packet->header, packet, src_packet->link_len,
+		                          scenario->no_comparison,
+		                          scenario->ignore_malformed,
 		                          dumper,
-		                          cmp_packet, cmp_header.caplen, link_len_cmp,
-		                          rohc_size_output_file,
+		                          cmp_packet != NULL ? cmp_packet->data : NULL,
+		                          cmp_packet != NULL ? cmp_packet->header.caplen : 0,
+		                          cmp_packet != NULL ? cmp_packet->link_len : 0,
+		                          size_output_file,
 		                          feedback1_data, &feedback2_data);
 		if(ret == -1)
 		{
@@ -1324,6 +1842,11 @@ static int test_comp_and_decomp(const rohc_cid_type_t cid_type,
 		/* reset feedback for comp/decomp #1 since it was just piggybacked */
 		rohc_buf_reset(&feedback1_data);
 	}
+	if(counter < src->packets_nr)
+	{
+		/* count the packet that stopped the test as processed */
+		counter++;
+	}
 
 	/* show the compression/decompression results */
 	trace("=== summary:\n");
@@ -1341,7 +1864,7 @@ static int test_comp_and_decomp(const rohc_cid_type_t cid_type,
 	/* destroy the compressors and decompressors */
 	trace("=== shutdown:\n");
 	if(err_comp == 0 && err_decomp == 0 &&
-	   (ignore_malformed || nb_bad == 0) && nb_ref == 0 &&
+	   (scenario->ignore_malformed || nb_bad == 0) && nb_ref == 0 &&
 	   (nb_ok + nb_bad) == (counter * 2))
 	{
 		/* test is successful */
@@ -1355,26 +1878,8 @@ destroy_comp2:
 	rohc_comp_free(comp2);
 destroy_comp1:
 	rohc_comp_free(comp1);
-close_output_size:
-	if(rohc_size_output_file != NULL)
-	{
-		fclose(rohc_size_output_file);
-	}
-close_comparison:
-	if(cmp_handle != NULL)
-	{
-		pcap_close(cmp_handle);
-	}
-close_output:
-	if(dumper != NULL)
-	{
-		pcap_dump_close(dumper);
-	}
-close_input:
-	if(handle != NULL)
-	{
-		pcap_close(handle);
-	}
+free_packet:
+	free(packet);
 error:
 	return status;
 }
@@ -1423,9 +1928,9 @@ static struct rohc_comp * create_compressor(const rohc_cid_type_t cid_type,
 
 	/* enable profiles */
 	if(!rohc_comp_enable_profiles(comp, ROHC_PROFILE_UNCOMPRESSED,
-	                              ROHC_PROFILE_UDP, ROHC_PROFILE_IP,
-	                              ROHC_PROFILE_UDPLITE, ROHC_PROFILE_RTP,
-	                              ROHC_PROFILE_ESP, ROHC_PROFILE_TCP, -1))
+	                              udp_profile, ip_only_profile,
+	                              ROHC_PROFILE_UDPLITE, rtp_profile,
+	                              esp_profile, ROHC_PROFILE_TCP, -1))
 	{
 		trace("failed to enable the compression profiles\n");
 		goto destroy_comp;
@@ -1494,9 +1999,9 @@ static struct rohc_decomp * create_decompressor(const rohc_cid_type_t cid_type,
 
 	/* enable decompression profiles */
 	if(!rohc_decomp_enable_profiles(decomp, ROHC_PROFILE_UNCOMPRESSED,
-	                                ROHC_PROFILE_UDP, ROHC_PROFILE_IP,
-	                                ROHC_PROFILE_UDPLITE, ROHC_PROFILE_RTP,
-	                                ROHC_PROFILE_ESP, ROHC_PROFILE_TCP, -1))
+	                                udp_profile, ip_only_profile,
+	                                ROHC_PROFILE_UDPLITE, rtp_profile,
+	                                esp_profile, ROHC_PROFILE_TCP, -1))
 	{
 		trace("failed to enable the decompression profiles\n");
 		goto destroy_decomp;
@@ -1668,59 +2173,112 @@ error:
 
 
 /**
- * @brief Get the next packet from source captures
+ * @brief Load the packets of one or several PCAP captures in memory
  *
+ * @param filenames         The names of the PCAP files
+ * @param filenames_nr      The number of PCAP files
+ * @param[out] capture      The packets of the PCAP files
+ * @return                  true if the captures were loaded,
+ *                          false if a problem occurred
  */
-static bool get_next_packet(pcap_t **const pcap_handle,
-                            const char *const src_filenames[],
-                            const size_t src_filenames_nr,
-                            size_t *const src_filenames_id,
-                            struct pcap_pkthdr *const header,
-                            size_t *const link_len,
-                            const uint8_t **const packet)
+static bool load_capture(const char *const filenames[],
+                         const size_t filenames_nr,
+                         struct test_capture *const capture)
 {
-	assert((*pcap_handle) != NULL);
+	size_t packets_max_nr = 0;
+	size_t i;
 
-	/* get the next packet in the current PCAP dump */
-	*packet = (const uint8_t *) pcap_next(*pcap_handle, header);
+	capture->name = strdup(filenames[0]);
+	capture->packets = NULL;
+	capture->packets_nr = 0;
+	if(capture->name == NULL)
+	{
+		trace("failed to allocate memory for capture '%s'\n", filenames[0]);
+		goto error;
+	}
 
-	/* if there is no more packet in the current PCAP dump file, try next one */
-	if((*packet) == NULL)
+	for(i = 0; i < filenames_nr; i++)
 	{
-		/* close current PCAP dump file */
-		pcap_close(*pcap_handle);
-		*pcap_handle = NULL;
+		struct pcap_pkthdr header;
+		const uint8_t *packet;
+		size_t link_len;
+		pcap_t *handle;
 
-		/* is there another PCAP dump file? */
-		(*src_filenames_id)++;
-		if((*src_filenames_id) >= src_filenames_nr)
+		handle = open_pcap_file(filenames[i], &link_len);
+		if(handle == NULL)
 		{
-			goto no_more_packet;
+			goto free_capture;
 		}
 
-		/* open next PCAP dump file */
-		*pcap_handle = open_pcap_file(src_filenames[*src_filenames_id], link_len);
-		if((*pcap_handle) == NULL)
+		while((packet = (const uint8_t *) pcap_next(handle, &header)) != NULL)
 		{
-			goto error;
-		}
+			struct test_packet *test_packet;
 
-		/* get the next packet in the current PCAP dump */
-		*packet = (const uint8_t *) pcap_next(*pcap_handle, header);
-		if((*packet) == NULL)
-		{
-			goto no_more_packet;
+			if(capture->packets_nr >= packets_max_nr)
+			{
+				const size_t new_max_nr = max(packets_max_nr * 2, 64);
+				struct test_packet *const new_packets =
+					realloc(capture->packets, sizeof(struct test_packet) * new_max_nr);
+
+				if(new_packets == NULL)
+				{
+					trace("failed to allocate memory for capture '%s'\n",
+					      filenames[i]);
+					pcap_close(handle);
+					goto free_capture;
+				}
+				capture->packets = new_packets;
+				packets_max_nr = new_max_nr;
+			}
+
+			test_packet = &capture->packets[capture->packets_nr];
+			test_packet->header = header;
+			test_packet->link_len = link_len;
+			test_packet->data = malloc(max(header.caplen, 1));
+			if(test_packet->data == NULL)
+			{
+				trace("failed to allocate memory for capture '%s'\n",
+				      filenames[i]);
+				pcap_close(handle);
+				goto free_capture;
+			}
+			memcpy(test_packet->data, packet, header.caplen);
+			capture->packets_nr++;
 		}
+
+		pcap_close(handle);
 	}
 
 	return true;
 
-no_more_packet:
+free_capture:
+	free_capture(capture);
 error:
 	return false;
 }
 
 
+/**
+ * @brief Release the packets of one capture loaded in memory
+ *
+ * @param capture  The capture to release
+ */
+static void free_capture(struct test_capture *const capture)
+{
+	size_t i;
+
+	for(i = 0; i < capture->packets_nr; i++)
+	{
+		free(capture->packets[i].data);
+	}
+	free(capture->packets);
+	capture->packets = NULL;
+	capture->packets_nr = 0;
+	free(capture->name);
+	capture->name = NULL;
+}
+
+
 /**
  * @brief Compare two network packets and print differences if any
  *
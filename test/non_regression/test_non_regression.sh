@@ -42,6 +42,10 @@
 #    USE_VALGRIND=yes|no   run the tests within Valgrind or not
 #    USE_PYTHON=<version>  run the tests of the Python binding or not
 #
+# The options of the test application listed in the file
+# test_non_regression.params next to the link are given to all the tests of
+# the directory, eg. to enable the ROHCv2 profiles.
+#
 
 # skip test in case of cross-compilation
 if [ "${CROSS_COMPILATION}" = "yes" ] && \
@@ -78,6 +82,12 @@ CAPTURE_SOURCE="${BASEDIR}/inputs/${STREAM}/source.pcap"
 CAPTURE_COMPARE="${BASEDIR}/inputs/${STREAM}/rohc_maxcontexts${MAX_CONTEXTS}_wlsb${WLSB_WIDTH}_${CID_TYPE}.pcap"
 SIZE_COMPARE="${BASEDIR}/inputs/${STREAM}/rohc_maxcontexts${MAX_CONTEXTS}_wlsb${WLSB_WIDTH}_${CID_TYPE}.sizes"
 
+# the options of the test application shared by the tests of the directory
+DIR_PARAMS=""
+if [ -f "${BASEDIR}/test_non_regression.params" ] ; then
+	DIR_PARAMS=$( cat "${BASEDIR}/test_non_regression.params" )
+fi
+
 # check that capture names are not empty
 if [ -z "${CAPTURE_SOURCE}" ] ; then
 	echo "empty source capture name, please do not run $0 directly!"
@@ -112,6 +122,8 @@ fi
 APP="${CROSS_COMPILATION_EMULATOR} ${APP}"
 CMD_PYTHON="${APP_PYTHON}"
 if [ -n "${KERNEL_SUFFIX}" ] ; then
+	# the kernel application does not handle the options of the directory
+	[ -n "${DIR_PARAMS}" ] && exit 77
 	# normal mode for kernel: compare with existing ROHC output captures
 	CMD="${APP} -c ${CAPTURE_COMPARE} ${CAPTURE_SOURCE}"
 elif [ "${VERBOSE}" = "generate" ] ; then
@@ -119,12 +131,12 @@ elif [ "${VERBOSE}" = "generate" ] ; then
 	CMD="${APP} -o ${CAPTURE_COMPARE} --rohc-size-output ${SIZE_COMPARE}"
 	CMD="${CMD} --wlsb-width ${WLSB_WIDTH}"
 	CMD="${CMD} --max-contexts ${MAX_CONTEXTS}"
-	CMD="${CMD} ${CID_TYPE} ${CAPTURE_SOURCE}"
+	CMD="${CMD} ${DIR_PARAMS} ${CID_TYPE} ${CAPTURE_SOURCE}"
 else
 	# normal mode: compare with existing ROHC output captures
 	CMD_PARAMS="${CMD_PARAMS} --wlsb-width ${WLSB_WIDTH}"
 	CMD_PARAMS="${CMD_PARAMS} --max-contexts ${MAX_CONTEXTS}"
-	CMD_PARAMS="${CMD_PARAMS} ${CID_TYPE} ${CAPTURE_SOURCE}"
+	CMD_PARAMS="${CMD_PARAMS} ${DIR_PARAMS} ${CID_TYPE} ${CAPTURE_SOURCE}"
 	if [ "${VERBOSE}" = "verbose" ] ; then
 		CMD_PARAMS="${CMD_PARAMS} --verbose"
 	fi
@@ -159,6 +171,8 @@ else
 	[ -n "${KERNEL_SUFFIX}" ] && exit 77
 	# generation is not possible with Python tests
 	[ "${VERBOSE}" = "generate" ] && exit 77
+	# the Python binding does not handle the options of the directory
+	[ -n "${DIR_PARAMS}" ] && exit 77
 
 	# run python bindings without valgrind
 	root_dir="${BASEDIR}/../../../"
@@ -0,0 +1,81 @@
+#!/bin/sh
+#
+# Copyright 2016 Didier Barvaux
+#
+# This library is free software; you can redistribute it and/or
+# modify it under the terms of the GNU Lesser General Public
+# License as published by the Free Software Foundation; either
+# version 2.1 of the License, or (at your option) any later version.
+#
+# This library is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+# Lesser General Public License for more details.
+#
+# You should have received a copy of the GNU Lesser General Public
+# License along with this library; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+#
+
+#
+# file:        test_non_regression_parallel.sh
+# description: Run all the scenarios of the non-regression tests in one
+#              single process, several scenarios at the same time.
+# authors:     Didier Barvaux <didier@barvaux.org>
+#
+# The scenarios are extracted from the names of the scripts of the
+# non-regression tests, the same way as test_non_regression.sh does. They
+# are then given to test_non_regression with the --scenarios option, so that
+# every capture is loaded only once and the scenarios are run by a pool of
+# threads.
+#
+# Script arguments:
+#    test_non_regression_parallel.sh [JOBS] [verbose]
+# where:
+#   JOBS             the number of scenarios run at the same time
+#                    (default: the number of CPUs)
+#   verbose          prints the result of every scenario
+#
+# Environment variables:
+#    NR_APP=<path>   the test_non_regression application
+#
+
+test -z "${SED}" && SED="`which sed`"
+test -z "${AWK}" && AWK="`which gawk`"
+test -z "${AWK}" && AWK="`which awk`"
+
+# parse arguments
+BASEDIR=$( dirname "$0" )
+JOBS="$1"
+VERBOSE="$2"
+test -z "${JOBS}" && JOBS=$( getconf _NPROCESSORS_ONLN 2>/dev/null )
+test -z "${JOBS}" && JOBS=1
+test -z "${NR_APP}" && NR_APP="${BASEDIR}/test_non_regression"
+if [ ! -x "${NR_APP}" ] ; then
+	echo "non-regression application '${NR_APP}' not found" >&2
+	exit 1
+fi
+APP_OPTS="--quiet"
+if [ "${VERBOSE}" = "verbose" ] ; then
+	APP_OPTS=""
+fi
+
+SCENARIOS=$( mktemp ) || exit 1
+trap 'rm -f "${SCENARIOS}"' EXIT INT TERM
+
+# list all the scenarios of the non-regression tests
+for SCRIPT in ${BASEDIR}/rfc3095/test_non_regression_*.sh \
+              ${BASEDIR}/rfc6846/test_non_regression_*.sh ; do
+	RFC_DIR=$( dirname "${SCRIPT}" )
+	PARAMS=$( echo "${SCRIPT}" | \
+	          ${SED} -e 's#^.*/test_non_regression_##' -e 's#\.sh$##' )
+	MAX_CONTEXTS=$( echo "${PARAMS}" | ${AWK} -F'_' '{ print $(NF-2) }' | sed -e 's/maxcontexts//' )
+	WLSB_WIDTH=$( echo "${PARAMS}" | ${AWK} -F'_' '{ print $(NF-1) }' | sed -e 's/wlsb//' )
+	CID_TYPE=$( echo "${PARAMS}" | ${AWK} -F'_' '{ print $(NF) }' )
+	STREAM=$( echo "${PARAMS}" | ${AWK} -F'_' '{ OFS="/" ; $(NF-2)="" ; $(NF-1)="" ; $(NF)="" ; print $0 }' )
+	CAPTURE_SOURCE="${RFC_DIR}/inputs/${STREAM}/source.pcap"
+	CAPTURE_COMPARE="${RFC_DIR}/inputs/${STREAM}/rohc_maxcontexts${MAX_CONTEXTS}_wlsb${WLSB_WIDTH}_${CID_TYPE}.pcap"
+	echo "${CID_TYPE} ${MAX_CONTEXTS} ${WLSB_WIDTH} ${CAPTURE_SOURCE} ${CAPTURE_COMPARE}"
+done > "${SCENARIOS}"
+
+${NR_APP} ${APP_OPTS} --scenarios "${SCENARIOS}" --jobs ${JOBS}
@@ -0,0 +1,205 @@
+#!/bin/sh
+#
+# Copyright 2016 Didier Barvaux
+#
+# This library is free software; you can redistribute it and/or
+# modify it under the terms of the GNU Lesser General Public
+# License as published by the Free Software Foundation; either
+# version 2.1 of the License, or (at your option) any later version.
+#
+# This library is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+# Lesser General Public License for more details.
+#
+# You should have received a copy of the GNU Lesser General Public
+# License along with this library; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+#
+
+#
+# file:        test_non_regression_perf.sh
+# description: Measure the throughput of the ROHC library on the scenarios of
+#              the non-regression tests, and detect the scenarios that became
+#              slower than in a baseline.
+# authors:     Didier Barvaux <didier@barvaux.org>
+#
+# Every scenario of the non-regression tests (stream, max contexts, W-LSB
+# width and CID type) is run twice with rohc_test_performance: the source
+# capture is compressed, then the reference ROHC capture is decompressed.
+# The packets per second, and the CPU cycles per packet if requested, are
+# recorded for every scenario.
+#
+# Script arguments:
+#    test_non_regression_perf.sh record BASELINE
+#    test_non_regression_perf.sh compare BASELINE [THRESHOLD]
+# where:
+#   record     measures all the scenarios and writes the results in the
+#              BASELINE file
+#   compare    measures all the scenarios and reports the ones that are more
+#              than THRESHOLD percents slower than in the BASELINE file
+#              (default: 10 percents), fails if there is at least one
+#
+# Environment variables:
+#    PERF_APP=<path>      the rohc_test_performance application
+#    PERF_REPEAT=<num>    the number of times every capture is (de)compressed
+#                         in a row (default: 1000)
+#    PERF_RUNS=<num>      the number of runs of every measure, the best one
+#                         is kept to reduce noise (default: 3)
+#    PERF_COUNTERS=yes    record the CPU cycles per packet too (Linux only)
+#    PERF_FILTER=<regex>  run only the scenarios whose names match the regex
+#
+
+test -z "${SED}" && SED="`which sed`"
+test -z "${GREP}" && GREP="`which grep`"
+test -z "${AWK}" && AWK="`which gawk`"
+test -z "${AWK}" && AWK="`which awk`"
+
+usage()
+{
+	echo "test_non_regression_perf.sh record BASELINE"
+	echo "test_non_regression_perf.sh compare BASELINE [THRESHOLD]"
+}
+
+# parse arguments
+BASEDIR=$( dirname "$0" )
+ACTION="$1"
+BASELINE="$2"
+THRESHOLD="$3"
+if [ -z "${ACTION}" ] || [ -z "${BASELINE}" ] ; then
+	usage
+	exit 1
+fi
+if [ "${ACTION}" != "record" ] && [ "${ACTION}" != "compare" ] ; then
+	usage
+	exit 1
+fi
+if [ "${ACTION}" = "compare" ] && [ ! -r "${BASELINE}" ] ; then
+	echo "baseline '${BASELINE}' not found or not readable" >&2
+	exit 1
+fi
+test -z "${THRESHOLD}" && THRESHOLD=10
+
+test -z "${PERF_APP}" && \
+	PERF_APP="${BASEDIR}/../../app/performance/rohc_test_performance"
+if [ ! -x "${PERF_APP}" ] ; then
+	echo "performance application '${PERF_APP}' not found" >&2
+	exit 1
+fi
+test -z "${PERF_REPEAT}" && PERF_REPEAT=1000
+test -z "${PERF_RUNS}" && PERF_RUNS=3
+PERF_OPTS="--repeat ${PERF_REPEAT}"
+if [ "${PERF_COUNTERS}" = "yes" ] ; then
+	PERF_OPTS="${PERF_OPTS} --perf-counters"
+fi
+
+# (De)compress one capture several times, then print the best packets per
+# second and CPU cycles per packet ('-' if not measured) of all the runs
+#  param #1  comp or decomp
+#  param #2  the capture to (de)compress
+#  param #3  the parameters of the scenario
+measure()
+{
+	run=0
+	while [ ${run} -lt ${PERF_RUNS} ] ; do
+		${PERF_APP} ${PERF_OPTS} $3 $1 ${CID_TYPE} $2 2>/dev/null || break
+		run=$(( run + 1 ))
+	done | \
+		${AWK} 'BEGIN { pps = 0; cpp = "-" }
+		        /^(de)?compression: [0-9]+ packets in / {
+		        	if($5 > 0 && $2 / $5 > pps) { pps = $2 / $5 }
+		        }
+		        $1 == "cycles" && $3 ~ /^\(/ {
+		        	if(cpp == "-" || substr($3, 2) + 0 < cpp + 0) {
+		        		cpp = substr($3, 2)
+		        	}
+		        }
+		        END { if(pps > 0) { printf("%.0f %s\n", pps, cpp) } }'
+}
+
+RESULTS=$( mktemp ) || exit 1
+trap 'rm -f "${RESULTS}"' EXIT INT TERM
+
+# measure all the scenarios of the non-regression tests
+for SCRIPT in ${BASEDIR}/rfc3095/test_non_regression_*.sh \
+              ${BASEDIR}/rfc6846/test_non_regression_*.sh ; do
+
+	# extract the scenario from the name of the script, the same way as
+	# test_non_regression.sh does
+	RFC=$( basename $( dirname "${SCRIPT}" ) )
+	PARAMS=$( echo "${SCRIPT}" | \
+	          ${SED} -e 's#^.*/test_non_regression_##' -e 's#\.sh$##' )
+	SCENARIO="${RFC}/${PARAMS}"
+	if [ -n "${PERF_FILTER}" ] && \
+	   ! echo "${SCENARIO}" | ${GREP} -qE "${PERF_FILTER}" ; then
+		continue
+	fi
+	MAX_CONTEXTS=$( echo "${PARAMS}" | ${AWK} -F'_' '{ print $(NF-2) }' | sed -e 's/maxcontexts//' )
+	WLSB_WIDTH=$( echo "${PARAMS}" | ${AWK} -F'_' '{ print $(NF-1) }' | sed -e 's/wlsb//' )
+	CID_TYPE=$( echo "${PARAMS}" | ${AWK} -F'_' '{ print $(NF) }' )
+	STREAM=$( echo "${PARAMS}" | ${AWK} -F'_' '{ OFS="/" ; $(NF-2)="" ; $(NF-1)="" ; $(NF)="" ; print $0 }' )
+	CAPTURE_SOURCE="${BASEDIR}/${RFC}/inputs/${STREAM}/source.pcap"
+	CAPTURE_COMPARE="${BASEDIR}/${RFC}/inputs/${STREAM}/rohc_maxcontexts${MAX_CONTEXTS}_wlsb${WLSB_WIDTH}_${CID_TYPE}.pcap"
+	if [ ${MAX_CONTEXTS} -eq 0 ] ; then
+		if [ "${CID_TYPE}" = "smallcid" ] ; then
+			MAX_CONTEXTS=16
+		else
+			MAX_CONTEXTS=16384
+		fi
+	fi
+	SCENARIO_OPTS="--wlsb-width ${WLSB_WIDTH} --max-contexts ${MAX_CONTEXTS}"
+
+	# the scenarios that the performance application cannot run (malformed
+	# or unknown packets for example) are skipped
+	for TEST in comp decomp ; do
+		if [ "${TEST}" = "comp" ] ; then
+			CAPTURE="${CAPTURE_SOURCE}"
+		else
+			CAPTURE="${CAPTURE_COMPARE}"
+		fi
+		[ -f "${CAPTURE}" ] || continue
+		RESULT=$( measure ${TEST} "${CAPTURE}" "${SCENARIO_OPTS}" )
+		if [ -z "${RESULT}" ] ; then
+			echo "${SCENARIO} ${TEST}: skipped" >&2
+			continue
+		fi
+		echo "${SCENARIO} ${TEST} ${RESULT}" >> "${RESULTS}"
+	done
+done
+
+if [ "${ACTION}" = "record" ] ; then
+	( echo "# scenario action packets/s cycles/packet"
+	  cat "${RESULTS}" ) > "${BASELINE}" || exit 1
+	echo "$( wc -l < "${RESULTS}" ) measures recorded in '${BASELINE}'"
+	exit 0
+fi
+
+# report the scenarios that are slower than in the baseline
+${AWK} -v threshold="${THRESHOLD}" '
+	FNR == NR {
+		if($1 !~ /^#/) { base_pps[$1 " " $2] = $3 ; base_cpp[$1 " " $2] = $4 }
+		next
+	}
+	{
+		key = $1 " " $2
+		if(!(key in base_pps)) { next }
+		compared++
+		slower = 0
+		if(base_pps[key] > 0 && $3 < base_pps[key] * (1 - threshold / 100)) {
+			slower = 1
+		}
+		if(base_cpp[key] != "-" && $4 != "-" &&
+		   $4 > base_cpp[key] * (1 + threshold / 100)) {
+			slower = 1
+		}
+		if(slower) {
+			printf("SLOWER %s: %s -> %s packets/s, %s -> %s cycles/packet\n",
+			       key, base_pps[key], $3, base_cpp[key], $4)
+			slowdowns++
+		}
+	}
+	END {
+		printf("%d measures compared, %d slower by more than %s %%\n",
+		       compared, slowdowns, threshold)
+		exit (slowdowns > 0 ? 1 : 0)
+	}' "${BASELINE}" "${RESULTS}"
@@ -0,0 +1,128 @@
+#!/bin/sh
+#
+# Copyright 2016 Didier Barvaux
+#
+# This library is free software; you can redistribute it and/or
+# modify it under the terms of the GNU Lesser General Public
+# License as published by the Free Software Foundation; either
+# version 2.1 of the License, or (at your option) any later version.
+#
+# This library is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+# Lesser General Public License for more details.
+#
+# You should have received a copy of the GNU Lesser General Public
+# License along with this library; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+#
+
+#
+# file:        test_non_regression_stats.sh
+# description: Report the compression efficiency of the ROHC library on the
+#              scenarios of the non-regression tests.
+# authors:     Didier Barvaux <didier@barvaux.org>
+#
+# The source capture of every scenario of the non-regression tests (stream,
+# max contexts, W-LSB width and CID type) is compressed by rohc_stats with
+# the --summary option. The per-profile, per-packet-type, per-state and total
+# statistics (header bytes saved, average compressed header size, share of
+# the packets...) are written in the report, one line per scenario and kind
+# of statistics. The random numbers are seeded with a constant, so the
+# reports of two builds of the library may be compared with diff(1).
+#
+# Script arguments:
+#    test_non_regression_stats.sh REPORT
+# where:
+#   REPORT     the file to write the report in
+#
+# Environment variables:
+#    STATS_APP=<path>           the rohc_stats application
+#    STATS_LIST_TRANS_NR=<nums> the numbers of transmissions of the compressed
+#                               lists to report, separated by spaces
+#                               (default: the default of the library)
+#    STATS_FILTER=<regex>       report only the scenarios whose names match
+#                               the regex
+#
+
+test -z "${SED}" && SED="`which sed`"
+test -z "${GREP}" && GREP="`which grep`"
+test -z "${AWK}" && AWK="`which gawk`"
+test -z "${AWK}" && AWK="`which awk`"
+
+# parse arguments
+BASEDIR=$( dirname "$0" )
+REPORT="$1"
+if [ -z "${REPORT}" ] ; then
+	echo "test_non_regression_stats.sh REPORT"
+	exit 1
+fi
+
+test -z "${STATS_APP}" && \
+	STATS_APP="${BASEDIR}/../../app/stats/rohc_stats"
+if [ ! -x "${STATS_APP}" ] ; then
+	echo "statistics application '${STATS_APP}' not found" >&2
+	exit 1
+fi
+test -z "${STATS_LIST_TRANS_NR}" && STATS_LIST_TRANS_NR="default"
+
+echo -n > "${REPORT}" || exit 1
+echo "# scenario list_trans_nr kind ID name packets uncomp_bytes" \
+     "comp_bytes ratio uncomp_hdr_bytes comp_hdr_bytes hdr_ratio" \
+     "saved_hdr_bytes avg_comp_hdr_size packets_share" >> "${REPORT}"
+
+# compress the source capture of all the scenarios of the non-regression tests
+for SCRIPT in ${BASEDIR}/rfc3095/test_non_regression_*.sh \
+              ${BASEDIR}/rfc6846/test_non_regression_*.sh ; do
+
+	# extract the scenario from the name of the script, the same way as
+	# test_non_regression.sh does
+	RFC=$( basename $( dirname "${SCRIPT}" ) )
+	PARAMS=$( echo "${SCRIPT}" | \
+	          ${SED} -e 's#^.*/test_non_regression_##' -e 's#\.sh$##' )
+	SCENARIO="${RFC}/${PARAMS}"
+	if [ -n "${STATS_FILTER}" ] && \
+	   ! echo "${SCENARIO}" | ${GREP} -qE "${STATS_FILTER}" ; then
+		continue
+	fi
+	MAX_CONTEXTS=$( echo "${PARAMS}" | ${AWK} -F'_' '{ print $(NF-2) }' | sed -e 's/maxcontexts//' )
+	WLSB_WIDTH=$( echo "${PARAMS}" | ${AWK} -F'_' '{ print $(NF-1) }' | sed -e 's/wlsb//' )
+	CID_TYPE=$( echo "${PARAMS}" | ${AWK} -F'_' '{ print $(NF) }' )
+	STREAM=$( echo "${PARAMS}" | ${AWK} -F'_' '{ OFS="/" ; $(NF-2)="" ; $(NF-1)="" ; $(NF)="" ; print $0 }' )
+	CAPTURE_SOURCE="${BASEDIR}/${RFC}/inputs/${STREAM}/source.pcap"
+	if [ ${MAX_CONTEXTS} -eq 0 ] ; then
+		if [ "${CID_TYPE}" = "smallcid" ] ; then
+			MAX_CONTEXTS=16
+		else
+			MAX_CONTEXTS=16384
+		fi
+	fi
+
+	for LIST_TRANS_NR in ${STATS_LIST_TRANS_NR} ; do
+		STATS_OPTS="--summary --seed 1"
+		STATS_OPTS="${STATS_OPTS} --wlsb-width ${WLSB_WIDTH}"
+		STATS_OPTS="${STATS_OPTS} --max-contexts ${MAX_CONTEXTS}"
+		if [ "${LIST_TRANS_NR}" != "default" ] ; then
+			STATS_OPTS="${STATS_OPTS} --list-trans-nr ${LIST_TRANS_NR}"
+		fi
+
+		# the scenarios that cannot be compressed (malformed packets for
+		# example) are reported as such
+		OUTPUT=$( ${STATS_APP} ${STATS_OPTS} ${CID_TYPE} "${CAPTURE_SOURCE}" \
+		          2>/dev/null )
+		if [ $? -ne 0 ] ; then
+			echo "${SCENARIO} ${LIST_TRANS_NR} FAILED" >> "${REPORT}"
+			continue
+		fi
+
+		# keep the per-profile, per-packet-type, per-state and total lines,
+		# but not their headers
+		echo "${OUTPUT}" | \
+			${AWK} -F'\t' -v scenario="${SCENARIO}" -v trans="${LIST_TRANS_NR}" \
+			       '$1 ~ /^(PROFILE|PACKET_TYPE|STATE|TOTAL)$/ && $2 !~ /^"/ {
+			        	$1 = $1 ; print scenario " " trans " " $0
+			        }' >> "${REPORT}"
+	done
+done
+
+echo "$( ${GREP} -c -v '^#' "${REPORT}" ) lines reported in '${REPORT}'"
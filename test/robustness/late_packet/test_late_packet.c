@@ -0,0 +1,520 @@
+/*
+ * Copyright 2016 Didier Barvaux
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/**
+ * @file   test_late_packet.c
+ * @brief  Check that the decompressor decodes the late packets of its reorder
+ *         window once and right
+ * @author Didier Barvaux <didier@barvaux.org>
+ *
+ * The application compresses one stream of IPv4 packets with the IP-only
+ * profile in U-mode. The ROHC packets are then reordered: one packet every
+ * 25 packets is delayed by a few packets, and it is received a second time
+ * right after. The decompressor is configured with a reorder window.
+ *
+ * When the TTL changes with every packet, the ROHC packets are protected by
+ * a 7-bit CRC: every packet shall be decompressed once, byte for byte, the
+ * late packets being decoded against a previous SN reference, and their
+ * duplicates shall be rejected. When the TTL does not change, the ROHC
+ * packets are protected by a 3-bit CRC only: the reorder window shall not be
+ * used, and the decompressed packets shall be the same as the ones of a
+ * decompressor without reorder window, byte for byte.
+ */
+
+#include "test.h"
+#include "config.h" /* for HAVE_*_H */
+
+/* system includes */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <stdarg.h>
+
+/* ROHC includes */
+#include <rohc.h>
+#include <rohc_comp.h>
+#include <rohc_decomp.h>
+
+
+/** The number of packets in the stream */
+#define TEST_PKTS_NR  300U
+
+/** The length of the generated IP packets */
+#define TEST_IP_PKT_LEN  60U
+
+/** The max length of the ROHC and decompressed packets */
+#define TEST_MAX_PKT_LEN  (TEST_IP_PKT_LEN * 2)
+
+/** Delay one packet every N packets */
+#define TEST_LATE_PERIOD  25U
+
+/** The number of packets received before the late packet */
+#define TEST_LATE_DELAY  5U
+
+/** The reorder window of the decompressor */
+#define TEST_REORDER_WINDOW  8U
+
+
+/* prototypes of private functions */
+static void usage(void);
+static int test_late_packets(const bool ttl_changes);
+static struct rohc_decomp * create_decompressor(const size_t reorder_window)
+	__attribute__((warn_unused_result));
+static size_t gen_ip_packet(const bool ttl_changes,
+                            const size_t pkt_num,
+                            uint8_t *const ip_pkt);
+static void print_rohc_traces(void *const priv_ctxt,
+                              const rohc_trace_level_t level,
+                              const rohc_trace_entity_t entity,
+                              const int profile,
+                              const char *const format,
+                              ...)
+	__attribute__((format(printf, 5, 6), nonnull(5)));
+static int gen_random_num(const struct rohc_comp *const comp,
+                          void *const user_context)
+	__attribute__((nonnull(1)));
+
+
+/** The original IP packets */
+static uint8_t ip_pkts[TEST_PKTS_NR][TEST_MAX_PKT_LEN];
+/** The lengths of the original IP packets */
+static size_t ip_pkts_len[TEST_PKTS_NR];
+/** The ROHC packets */
+static uint8_t rohc_pkts[TEST_PKTS_NR][TEST_MAX_PKT_LEN];
+/** The lengths of the ROHC packets */
+static size_t rohc_pkts_len[TEST_PKTS_NR];
+
+
+/**
+ * @brief Check that the decompressor decodes the late packets of its reorder
+ *        window once and right
+ *
+ * @param argc The number of program arguments
+ * @param argv The program arguments
+ * @return     The unix return code:
+ *              \li 0 in case of success,
+ *              \li 1 in case of failure
+ */
+int main(int argc, char *argv[])
+{
+	int status = 1;
+
+	/* parse program arguments, print the help message in case of failure */
+	if(argc != 1)
+	{
+		usage();
+		goto error;
+	}
+
+	/* initialize the random generator with the same number to ease debugging */
+	srand(4 /* chosen by fair dice roll, guaranteed to be random */);
+
+	/* late packets protected by a 7-bit CRC */
+	if(test_late_packets(true) != 0)
+	{
+		goto error;
+	}
+
+	/* late packets protected by a 3-bit CRC */
+	if(test_late_packets(false) != 0)
+	{
+		goto error;
+	}
+
+	status = 0;
+
+error:
+	return status;
+}
+
+
+/**
+ * @brief Print usage of the application
+ */
+static void usage(void)
+{
+	fprintf(stderr,
+	        "Check that the decompressor decodes the late packets of its\n"
+	        "reorder window once and right\n"
+	        "\n"
+	        "usage: test_late_packet [OPTIONS]\n"
+	        "\n"
+	        "options:\n"
+	        "  -h           Print this usage and exit\n");
+}
+
+
+/**
+ * @brief Compress one stream, then decompress it with late and duplicated
+ *        packets
+ *
+ * @param ttl_changes  Whether the TTL changes with every packet, so that the
+ *                     ROHC packets are protected by a 7-bit CRC
+ * @return             0 in case of success,
+ *                     1 in case of failure
+ */
+static int test_late_packets(const bool ttl_changes)
+{
+	const struct rohc_ts arrival_time = { .sec = 0, .nsec = 0 };
+	struct rohc_comp *comp;
+	struct rohc_decomp *decomp;
+	struct rohc_decomp *decomp_ref;
+	rohc_decomp_general_info_t decomp_info;
+	size_t rcvd_order[TEST_PKTS_NR * 2];
+	size_t rcvd_nr = 0;
+	size_t late_nr = 0;
+	bool decoded[TEST_PKTS_NR];
+	int is_failure = 1;
+	size_t i;
+
+	fprintf(stderr, "test late packets with %s TTL\n",
+	        ttl_changes ? "changing" : "constant");
+
+	/* create the ROHC compressor with small CID */
+	comp = rohc_comp_new2(ROHC_SMALL_CID, ROHC_SMALL_CID_MAX,
+	                      gen_random_num, NULL);
+	if(comp == NULL)
+	{
+		fprintf(stderr, "failed to create the ROHC compressor\n");
+		goto error;
+	}
+	if(!rohc_comp_set_traces_cb2(comp, print_rohc_traces, NULL))
+	{
+		fprintf(stderr, "failed to set the callback for traces on "
+		        "compressor\n");
+		goto destroy_comp;
+	}
+	if(!rohc_comp_enable_profiles(comp, ROHC_PROFILE_UNCOMPRESSED,
+	                              ROHC_PROFILE_IP, -1))
+	{
+		fprintf(stderr, "failed to enable the compression profiles\n");
+		goto destroy_comp;
+	}
+
+	/* create the ROHC decompressor with the reorder window, and the
+	 * reference decompressor without it */
+	decomp = create_decompressor(TEST_REORDER_WINDOW);
+	if(decomp == NULL)
+	{
+		goto destroy_comp;
+	}
+	decomp_ref = create_decompressor(0);
+	if(decomp_ref == NULL)
+	{
+		goto destroy_decomp;
+	}
+
+	/* compress all the IP packets in order */
+	for(i = 0; i < TEST_PKTS_NR; i++)
+	{
+		struct rohc_buf ip_packet =
+			rohc_buf_init_empty(ip_pkts[i], TEST_MAX_PKT_LEN);
+		struct rohc_buf rohc_packet =
+			rohc_buf_init_empty(rohc_pkts[i], TEST_MAX_PKT_LEN);
+		rohc_status_t status;
+
+		ip_packet.time = arrival_time;
+		ip_packet.len = gen_ip_packet(ttl_changes, i, ip_pkts[i]);
+		ip_pkts_len[i] = ip_packet.len;
+
+		status = rohc_compress4(comp, ip_packet, &rohc_packet);
+		if(status != ROHC_STATUS_OK)
+		{
+			fprintf(stderr, "\tfailed to compress IP packet #%zu\n", i + 1);
+			goto destroy_decomp_ref;
+		}
+		assert(rohc_packet.offset == 0);
+		rohc_pkts_len[i] = rohc_packet.len;
+		decoded[i] = false;
+	}
+
+	/* reorder the ROHC packets once the context is established: delay one
+	 * packet every TEST_LATE_PERIOD packets, then duplicate it */
+	for(i = 0; i < TEST_PKTS_NR; i++)
+	{
+		if(i > TEST_LATE_PERIOD && (i % TEST_LATE_PERIOD) == 0 &&
+		   (i + TEST_LATE_DELAY) < TEST_PKTS_NR)
+		{
+			size_t j;
+
+			for(j = 1; j <= TEST_LATE_DELAY; j++)
+			{
+				rcvd_order[rcvd_nr] = i + j;
+				rcvd_nr++;
+			}
+			rcvd_order[rcvd_nr] = i;
+			rcvd_nr++;
+			rcvd_order[rcvd_nr] = i;
+			rcvd_nr++;
+			i += TEST_LATE_DELAY;
+			late_nr++;
+		}
+		else
+		{
+			rcvd_order[rcvd_nr] = i;
+			rcvd_nr++;
+		}
+	}
+	assert(rcvd_nr <= (TEST_PKTS_NR * 2));
+
+	/* decompress the ROHC packets and compare with the IP packets */
+	for(i = 0; i < rcvd_nr; i++)
+	{
+		const size_t pkt_num = rcvd_order[i];
+		const struct rohc_buf rohc_packet =
+			rohc_buf_init_full(rohc_pkts[pkt_num], rohc_pkts_len[pkt_num],
+			                   arrival_time);
+		uint8_t uncomp_buffer[TEST_MAX_PKT_LEN];
+		struct rohc_buf uncomp_packet =
+			rohc_buf_init_empty(uncomp_buffer, TEST_MAX_PKT_LEN);
+		uint8_t ref_buffer[TEST_MAX_PKT_LEN];
+		struct rohc_buf ref_packet =
+			rohc_buf_init_empty(ref_buffer, TEST_MAX_PKT_LEN);
+		rohc_status_t status;
+		rohc_status_t ref_status;
+
+		status = rohc_decompress3(decomp, rohc_packet, &uncomp_packet,
+		                          NULL, NULL);
+		ref_status = rohc_decompress3(decomp_ref, rohc_packet, &ref_packet,
+		                              NULL, NULL);
+
+		if(!ttl_changes)
+		{
+			/* a 3-bit CRC shall not enable the reorder window */
+			if(status != ref_status ||
+			   uncomp_packet.len != ref_packet.len ||
+			   memcmp(rohc_buf_data(uncomp_packet), rohc_buf_data(ref_packet),
+			          ref_packet.len) != 0)
+			{
+				fprintf(stderr, "\tROHC packet #%zu was not decompressed as "
+				        "without reorder window\n", pkt_num + 1);
+				goto destroy_decomp_ref;
+			}
+			continue;
+		}
+
+		if(status != ROHC_STATUS_OK)
+		{
+			fprintf(stderr, "\tfailed to decompress ROHC packet #%zu\n",
+			        pkt_num + 1);
+			continue;
+		}
+		if(uncomp_packet.len != ip_pkts_len[pkt_num] ||
+		   memcmp(rohc_buf_data(uncomp_packet), ip_pkts[pkt_num],
+		          ip_pkts_len[pkt_num]) != 0)
+		{
+			fprintf(stderr, "\tdecompressed packet #%zu does not match the "
+			        "original IP packet\n", pkt_num + 1);
+			goto destroy_decomp_ref;
+		}
+		if(decoded[pkt_num])
+		{
+			fprintf(stderr, "\tduplicated packet #%zu was decompressed twice\n",
+			        pkt_num + 1);
+			goto destroy_decomp_ref;
+		}
+		decoded[pkt_num] = true;
+	}
+
+	/* check the number of late packets decoded against previous references */
+	memset(&decomp_info, 0, sizeof(rohc_decomp_general_info_t));
+	decomp_info.version_major = 0;
+	decomp_info.version_minor = 4;
+	if(!rohc_decomp_get_general_info(decomp, &decomp_info))
+	{
+		fprintf(stderr, "failed to get general information on decompressor\n");
+		goto destroy_decomp_ref;
+	}
+	fprintf(stderr, "\t%zu packets delayed, %llu late packets decoded\n",
+	        late_nr, (unsigned long long) decomp_info.late_pkts_decoded);
+	if(ttl_changes)
+	{
+		if(decomp_info.late_pkts_decoded != late_nr)
+		{
+			fprintf(stderr, "\tall the late packets shall be decoded once\n");
+			goto destroy_decomp_ref;
+		}
+		for(i = 0; i < TEST_PKTS_NR; i++)
+		{
+			if(!decoded[i])
+			{
+				fprintf(stderr, "\tpacket #%zu was not decompressed\n", i + 1);
+				goto destroy_decomp_ref;
+			}
+		}
+	}
+	else if(decomp_info.late_pkts_decoded != 0)
+	{
+		fprintf(stderr, "\tno late packet protected by a 3-bit CRC shall be "
+		        "decoded against a previous SN reference\n");
+		goto destroy_decomp_ref;
+	}
+
+	is_failure = 0;
+
+destroy_decomp_ref:
+	rohc_decomp_free(decomp_ref);
+destroy_decomp:
+	rohc_decomp_free(decomp);
+destroy_comp:
+	rohc_comp_free(comp);
+error:
+	return is_failure;
+}
+
+
+/**
+ * @brief Create one ROHC decompressor in uni-directional mode
+ *
+ * @param reorder_window  The reorder window of the decompressor
+ * @return                The new decompressor, NULL in case of failure
+ */
+static struct rohc_decomp * create_decompressor(const size_t reorder_window)
+{
+	struct rohc_decomp *decomp;
+
+	decomp = rohc_decomp_new2(ROHC_SMALL_CID, ROHC_SMALL_CID_MAX, ROHC_U_MODE);
+	if(decomp == NULL)
+	{
+		fprintf(stderr, "failed to create the ROHC decompressor\n");
+		goto error;
+	}
+	if(!rohc_decomp_set_traces_cb2(decomp, print_rohc_traces, NULL))
+	{
+		fprintf(stderr, "failed to set the callback for traces on "
+		        "decompressor\n");
+		goto destroy_decomp;
+	}
+	if(!rohc_decomp_enable_profiles(decomp, ROHC_PROFILE_UNCOMPRESSED,
+	                                ROHC_PROFILE_IP, -1))
+	{
+		fprintf(stderr, "failed to enable the decompression profiles\n");
+		goto destroy_decomp;
+	}
+	if(!rohc_decomp_set_reorder_window(decomp, reorder_window))
+	{
+		fprintf(stderr, "failed to set the reorder window\n");
+		goto destroy_decomp;
+	}
+
+	return decomp;
+
+destroy_decomp:
+	rohc_decomp_free(decomp);
+error:
+	return NULL;
+}
+
+
+/**
+ * @brief Generate one IPv4 packet of the stream
+ *
+ * The IPv4 ID is sequential. The TTL may change with every packet. The
+ * payload changes with every packet.
+ *
+ * @param ttl_changes  Whether the TTL changes with every packet
+ * @param pkt_num      The number of the packet in the stream
+ * @param ip_pkt       OUT: The generated IP packet
+ * @return             The length of the generated IP packet
+ */
+static size_t gen_ip_packet(const bool ttl_changes,
+                            const size_t pkt_num,
+                            uint8_t *const ip_pkt)
+{
+	const uint16_t ip_id = 0x1000 + pkt_num;
+	const size_t hdr_len = 20;
+	uint32_t sum = 0;
+	size_t i;
+
+	memset(ip_pkt, 0, TEST_IP_PKT_LEN);
+
+	ip_pkt[0] = 0x45; /* version 4, no option */
+	ip_pkt[2] = TEST_IP_PKT_LEN >> 8;
+	ip_pkt[3] = TEST_IP_PKT_LEN & 0xff;
+	ip_pkt[4] = ip_id >> 8;
+	ip_pkt[5] = ip_id & 0xff;
+	ip_pkt[6] = 0x40; /* DF */
+	ip_pkt[8] = 64 + (ttl_changes ? (pkt_num % 2) : 0);
+	ip_pkt[9] = 134; /* unassigned number according to /etc/protocols */
+	ip_pkt[12] = 0x01;
+	ip_pkt[19] = 0x02;
+
+	/* compute the IPv4 checksum */
+	for(i = 0; i < hdr_len; i += 2)
+	{
+		sum += (ip_pkt[i] << 8) | ip_pkt[i + 1];
+	}
+	while((sum >> 16) != 0)
+	{
+		sum = (sum & 0xffff) + (sum >> 16);
+	}
+	sum = ~sum;
+	ip_pkt[10] = (sum >> 8) & 0xff;
+	ip_pkt[11] = sum & 0xff;
+
+	for(i = hdr_len; i < TEST_IP_PKT_LEN; i++)
+	{
+		ip_pkt[i] = (pkt_num + i) & 0xff;
+	}
+
+	return TEST_IP_PKT_LEN;
+}
+
+
+/**
+ * @brief Callback to print traces of the ROHC library
+ *
+ * @param priv_ctxt  An optional private context, may be NULL
+ * @param level      The priority level of the trace
+ * @param entity     The entity that emitted the trace among:
+ *                    \li ROHC_TRACE_COMP
+ *                    \li ROHC_TRACE_DECOMP
+ * @param profile    The ID of the ROHC compression/decompression profile
+ *                   the trace is related to
+ * @param format     The format string of the trace
+ */
+static void print_rohc_traces(void *const priv_ctxt,
+                              const rohc_trace_level_t level,
+                              const rohc_trace_entity_t entity,
+                              const int profile,
+                              const char *const format,
+                              ...)
+{
+	va_list args;
+
+	va_start(args, format);
+	vfprintf(stdout, format, args);
+	va_end(args);
+}
+
+
+/**
+ * @brief Generate a random number
+ *
+ * @param comp          The ROHC compressor
+ * @param user_context  Should always be NULL
+ * @return              A random number
+ */
+static int gen_random_num(const struct rohc_comp *const comp,
+                          void *const user_context)
+{
+	assert(comp != NULL);
+	assert(user_context == NULL);
+	return rand();
+}